@@ -0,0 +1,88 @@
+# Optional optimization profiles of the collector and in-tree plugins
+#
+# ENABLE_LTO  - Link-time optimization of each binary (the collector, plugins, tools)
+# PGO_MODE    - Profile-guided optimization:
+#               OFF      - disabled
+#               GENERATE - build instrumented binaries, training runs write profiles
+#                          into PGO_PROFILE_DIR (see "make pgo-train" of performance tests)
+#               USE      - optimize binaries using the profiles in PGO_PROFILE_DIR
+#
+# Only optimization flags are added, i.e. visibility of symbols, calling conventions and
+# structure layouts stay the same. Therefore, plugins built with any profile are compatible
+# with the collector built with any other profile.
+
+option(ENABLE_LTO "Enable link-time optimization" OFF)
+set(PGO_MODE "OFF" CACHE STRING "Profile-guided optimization (OFF, GENERATE, USE)")
+set_property(CACHE PGO_MODE PROPERTY STRINGS "OFF" "GENERATE" "USE")
+set(PGO_PROFILE_DIR "${CMAKE_BINARY_DIR}/pgo-profile" CACHE PATH
+    "Directory with profiles of profile-guided optimization")
+
+set(PROFILE_FLAGS "")
+
+if (NOT CMAKE_C_COMPILER_ID MATCHES "GNU|Clang" AND (ENABLE_LTO OR NOT PGO_MODE STREQUAL "OFF"))
+    message(FATAL_ERROR "LTO and PGO profiles are supported only by GCC and Clang")
+endif()
+
+# Link-time optimization
+if (ENABLE_LTO)
+    if (CMAKE_C_COMPILER_ID STREQUAL "GNU")
+        # Parallel LTO (GCC >= 10), otherwise the default number of jobs
+        CHECK_C_COMPILER_FLAG(-flto=auto COMPILER_SUPPORT_LTO_AUTO)
+        if (COMPILER_SUPPORT_LTO_AUTO)
+            set(PROFILE_FLAGS "${PROFILE_FLAGS} -flto=auto")
+        else()
+            set(PROFILE_FLAGS "${PROFILE_FLAGS} -flto")
+        endif()
+        # Static libraries (e.g. ipfixcol2base) must be created by the LTO aware archiver
+        find_program(LTO_AR NAMES "gcc-ar-${CMAKE_C_COMPILER_VERSION}" gcc-ar)
+        find_program(LTO_RANLIB NAMES "gcc-ranlib-${CMAKE_C_COMPILER_VERSION}" gcc-ranlib)
+    else()
+        set(PROFILE_FLAGS "${PROFILE_FLAGS} -flto=thin")
+        find_program(LTO_AR NAMES llvm-ar)
+        find_program(LTO_RANLIB NAMES llvm-ranlib)
+    endif()
+
+    if (NOT LTO_AR OR NOT LTO_RANLIB)
+        message(FATAL_ERROR "LTO aware archiver (gcc-ar/llvm-ar) not found")
+    endif()
+    set(CMAKE_AR "${LTO_AR}")
+    set(CMAKE_RANLIB "${LTO_RANLIB}")
+endif()
+
+# Profile-guided optimization
+if (PGO_MODE STREQUAL "GENERATE")
+    set(PROFILE_FLAGS "${PROFILE_FLAGS} -fprofile-generate=${PGO_PROFILE_DIR}")
+    # Atomic updates of counters, the collector is multi-threaded
+    CHECK_C_COMPILER_FLAG(-fprofile-update=atomic COMPILER_SUPPORT_PROFILE_ATOMIC)
+    if (COMPILER_SUPPORT_PROFILE_ATOMIC)
+        set(PROFILE_FLAGS "${PROFILE_FLAGS} -fprofile-update=atomic")
+    endif()
+elseif (PGO_MODE STREQUAL "USE")
+    if (CMAKE_C_COMPILER_ID STREQUAL "GNU")
+        set(PROFILE_FLAGS "${PROFILE_FLAGS} -fprofile-use=${PGO_PROFILE_DIR} -fprofile-correction")
+        # Code not executed by training runs (e.g. unused plugins) has no profile
+        CHECK_C_COMPILER_FLAG(-Wno-missing-profile COMPILER_SUPPORT_NO_MISSING_PROFILE)
+        if (COMPILER_SUPPORT_NO_MISSING_PROFILE)
+            set(PROFILE_FLAGS "${PROFILE_FLAGS} -Wno-missing-profile")
+        endif()
+    else()
+        # Raw profiles are merged by "make pgo-train"
+        set(PROFILE_FLAGS "${PROFILE_FLAGS} -fprofile-use=${PGO_PROFILE_DIR}/default.profdata")
+        set(PROFILE_FLAGS "${PROFILE_FLAGS} -Wno-profile-instr-unprofiled")
+    endif()
+
+    if (NOT EXISTS "${PGO_PROFILE_DIR}")
+        message(WARNING "Directory with PGO profiles '${PGO_PROFILE_DIR}' doesn't exist")
+    endif()
+elseif (NOT PGO_MODE STREQUAL "OFF")
+    message(FATAL_ERROR "Invalid PGO_MODE '${PGO_MODE}' (OFF, GENERATE or USE expected)")
+endif()
+
+# Flags are used by both compiler and linker
+if (PROFILE_FLAGS)
+    set(CMAKE_C_FLAGS             "${CMAKE_C_FLAGS}${PROFILE_FLAGS}")
+    set(CMAKE_CXX_FLAGS           "${CMAKE_CXX_FLAGS}${PROFILE_FLAGS}")
+    set(CMAKE_EXE_LINKER_FLAGS    "${CMAKE_EXE_LINKER_FLAGS}${PROFILE_FLAGS}")
+    set(CMAKE_SHARED_LINKER_FLAGS "${CMAKE_SHARED_LINKER_FLAGS}${PROFILE_FLAGS}")
+    set(CMAKE_MODULE_LINKER_FLAGS "${CMAKE_MODULE_LINKER_FLAGS}${PROFILE_FLAGS}")
+endif()
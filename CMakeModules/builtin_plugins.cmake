@@ -0,0 +1,147 @@
+# Plugins built into the collector
+#
+# BUILTIN_PLUGINS - List of in-tree plugins (names of their targets, e.g. "udp-input;dummy-output")
+#                   linked statically into the collector. The plugins are still built as
+#                   shared objects too, but the built-in version is always preferred.
+#
+# Objects of each plugin are linked into one relocatable object, symbols not visible outside
+# of the plugin are localized (i.e. plugins cannot clash) and its entry points (ipx_plugin_*)
+# are renamed to ipx_builtin_<plugin>_*. A table of the built-in plugins is generated and
+# linked into the collector, see src/core/plugin_builtin.h.
+
+set(BUILTIN_PLUGINS "" CACHE STRING
+    "List of in-tree plugins built into the collector (e.g. udp-input;dummy-output)")
+
+if (BUILTIN_PLUGINS AND CMAKE_VERSION VERSION_LESS 3.13)
+    message(FATAL_ERROR "BUILTIN_PLUGINS requires CMake 3.13 or newer")
+endif()
+
+# Policies are recorded by the function below (visibility of objects, libraries of plugins
+# are linked to the collector defined in another directory)
+foreach(POLICY_ID CMP0063 CMP0079)
+    if (POLICY ${POLICY_ID})
+        cmake_policy(SET ${POLICY_ID} NEW)
+    endif()
+endforeach()
+
+# Entry points of a plugin (see include/ipfixcol2/plugins.h)
+set(BUILTIN_SYMBOLS info init destroy get process session_close)
+
+# Add the built-in plugins to the collector (must be called after all plugins are defined)
+function(builtin_plugins_add COLLECTOR)
+    if (NOT BUILTIN_PLUGINS)
+        return()
+    endif()
+
+    if (NOT CMAKE_OBJCOPY)
+        message(FATAL_ERROR "BUILTIN_PLUGINS requires objcopy")
+    endif()
+
+    # Relocatable objects must contain machine code (i.e. not LTO bytecode)
+    string(TOUPPER "${CMAKE_BUILD_TYPE}" BUILD_TYPE_UPPER)
+    separate_arguments(PARTIAL_FLAGS UNIX_COMMAND
+        "${CMAKE_C_FLAGS} ${CMAKE_C_FLAGS_${BUILD_TYPE_UPPER}}")
+    set(OBJECT_FLAGS "")
+    if (ENABLE_LTO AND CMAKE_C_COMPILER_ID STREQUAL "GNU")
+        # Optimize the whole plugin during the partial link
+        list(APPEND PARTIAL_FLAGS -flinker-output=nolto-rel)
+    elseif (ENABLE_LTO)
+        set(OBJECT_FLAGS -fno-lto)
+        list(APPEND PARTIAL_FLAGS -fno-lto)
+    endif()
+
+    set(BUILTIN_DECLS "")
+    set(BUILTIN_ITEMS "")
+    set(BUILTIN_OBJECTS "")
+
+    foreach(PLUGIN ${BUILTIN_PLUGINS})
+        if (NOT TARGET ${PLUGIN})
+            message(FATAL_ERROR "Built-in plugin '${PLUGIN}' is not an in-tree plugin (target)")
+        endif()
+
+        get_target_property(PLUGIN_DIR     ${PLUGIN} SOURCE_DIR)
+        get_target_property(PLUGIN_SOURCES ${PLUGIN} SOURCES)
+        get_target_property(PLUGIN_INCS    ${PLUGIN} INCLUDE_DIRECTORIES)
+        get_target_property(PLUGIN_DEFS    ${PLUGIN} COMPILE_DEFINITIONS)
+        get_target_property(PLUGIN_OPTS    ${PLUGIN} COMPILE_OPTIONS)
+        get_target_property(PLUGIN_LIBS    ${PLUGIN} LINK_LIBRARIES)
+        get_directory_property(DIR_DEFS DIRECTORY ${PLUGIN_DIR} COMPILE_DEFINITIONS)
+
+        # Sources of the plugin (objects of shared OBJECT libraries are linked as they are)
+        set(SOURCES "")
+        set(EXTRA_OBJECTS "")
+        foreach(SRC ${PLUGIN_SOURCES})
+            if (SRC MATCHES "^\\$<TARGET_OBJECTS:")
+                list(APPEND EXTRA_OBJECTS ${SRC})
+            elseif (IS_ABSOLUTE ${SRC})
+                list(APPEND SOURCES ${SRC})
+            else()
+                list(APPEND SOURCES "${PLUGIN_DIR}/${SRC}")
+            endif()
+        endforeach()
+
+        # Compile the plugin again, the same way as the shared object
+        set(OBJ_TARGET "${PLUGIN}-builtin")
+        add_library(${OBJ_TARGET} OBJECT ${SOURCES})
+        set_target_properties(${OBJ_TARGET} PROPERTIES
+            C_VISIBILITY_PRESET hidden
+            CXX_VISIBILITY_PRESET hidden
+            POSITION_INDEPENDENT_CODE ON
+        )
+        foreach(PROP PLUGIN_INCS PLUGIN_DEFS PLUGIN_OPTS DIR_DEFS)
+            if (NOT ${PROP})
+                set(${PROP} "")
+            endif()
+        endforeach()
+        target_include_directories(${OBJ_TARGET} PRIVATE ${PLUGIN_INCS})
+        target_compile_definitions(${OBJ_TARGET} PRIVATE ${DIR_DEFS} ${PLUGIN_DEFS})
+        target_compile_options(${OBJ_TARGET} PRIVATE ${PLUGIN_OPTS} ${OBJECT_FLAGS})
+
+        # Link the plugin into one object, hide its internals and rename its entry points
+        string(MAKE_C_IDENTIFIER "${PLUGIN}" PLUGIN_ID)
+        set(PLUGIN_OBJ "${CMAKE_CURRENT_BINARY_DIR}/${OBJ_TARGET}.o")
+        set(RENAME_ARGS "")
+        foreach(SYM ${BUILTIN_SYMBOLS})
+            list(APPEND RENAME_ARGS --redefine-sym ipx_plugin_${SYM}=ipx_builtin_${PLUGIN_ID}_${SYM})
+        endforeach()
+
+        add_custom_command(OUTPUT ${PLUGIN_OBJ}
+            COMMAND ${CMAKE_C_COMPILER} ${PARTIAL_FLAGS} -r -nostdlib -o ${PLUGIN_OBJ}.tmp
+                $<TARGET_OBJECTS:${OBJ_TARGET}> ${EXTRA_OBJECTS}
+            COMMAND ${CMAKE_OBJCOPY} --localize-hidden ${RENAME_ARGS} ${PLUGIN_OBJ}.tmp ${PLUGIN_OBJ}
+            COMMAND ${CMAKE_COMMAND} -E remove ${PLUGIN_OBJ}.tmp
+            DEPENDS ${OBJ_TARGET} $<TARGET_OBJECTS:${OBJ_TARGET}> ${EXTRA_OBJECTS}
+            COMMENT "Linking built-in plugin ${PLUGIN}"
+            COMMAND_EXPAND_LISTS
+            VERBATIM
+        )
+        set_source_files_properties(${PLUGIN_OBJ} PROPERTIES EXTERNAL_OBJECT TRUE GENERATED TRUE)
+        list(APPEND BUILTIN_OBJECTS ${PLUGIN_OBJ})
+        if (PLUGIN_LIBS)
+            target_link_libraries(${COLLECTOR} ${PLUGIN_LIBS})
+        endif()
+
+        # Record of the table (optional and type specific callbacks are weak)
+        set(PREFIX "ipx_builtin_${PLUGIN_ID}")
+        string(CONCAT BUILTIN_DECLS "${BUILTIN_DECLS}"
+            "extern struct ipx_plugin_info ${PREFIX}_info;\n"
+            "extern int ${PREFIX}_init(ipx_ctx_t *, const char *);\n"
+            "extern void ${PREFIX}_destroy(ipx_ctx_t *, void *);\n"
+            "extern int ${PREFIX}_get(ipx_ctx_t *, void *) WEAK;\n"
+            "extern int ${PREFIX}_process(ipx_ctx_t *, void *, ipx_msg_t *) WEAK;\n"
+            "extern void ${PREFIX}_session_close(ipx_ctx_t *, void *, const struct ipx_session *) WEAK;\n"
+        )
+        string(CONCAT BUILTIN_ITEMS "${BUILTIN_ITEMS}"
+            "    {&${PREFIX}_info, ${PREFIX}_init, ${PREFIX}_destroy,\n"
+            "        ${PREFIX}_get, ${PREFIX}_process, ${PREFIX}_session_close},\n"
+        )
+    endforeach()
+
+    # Table of the built-in plugins and the plugins (the table is referenced by a weak symbol)
+    set(TABLE_FILE "${CMAKE_CURRENT_BINARY_DIR}/plugin_builtin.c")
+    configure_file("${PROJECT_SOURCE_DIR}/src/core/plugin_builtin.c.in" "${TABLE_FILE}" @ONLY)
+    add_library(builtin-plugins STATIC ${TABLE_FILE} ${BUILTIN_OBJECTS})
+    target_include_directories(builtin-plugins PRIVATE "${PROJECT_SOURCE_DIR}/src/core")
+    target_link_libraries(${COLLECTOR}
+        -Wl,--whole-archive builtin-plugins -Wl,--no-whole-archive)
+endfunction()
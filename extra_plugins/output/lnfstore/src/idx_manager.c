@@ -41,11 +41,18 @@
 // Bloomfilter index library API
 #include <bf_index.h>
 #include <assert.h>
+#include <pthread.h>
 #include <stdint.h>
+#include <stdlib.h>
 #include "idx_manager.h"
 
 #include <string.h> // strdup
 
+/** Number of entries of the cache of recently added addresses (must be a power of 2) */
+#define IDX_CACHE_SIZE (4096U)
+/** Length of an address in the cache */
+#define IDX_CACHE_ADDR (16U)
+
 #define BF_TOL_COEFF(x) ((x > 10000000) ? 1.1 : (x > 100000) ? 1.2 : \
     (x > 30000) ? 1.5 : (x > 5000) ? 2 : \
     (x > 500) ? 3 : 10)
@@ -81,11 +88,19 @@ enum IDX_MGR_STATE {
     IDX_MGR_S_ERROR            /**< An index or output file is not ready.     */
 };
 
+/** \brief Bloom filter index with its parameters */
+struct idx_mgr_index {
+    bfi_index_ptr_t ptr;    /**< Instance of a Bloom filter index (or NULL)   */
+    uint64_t est_items;     /**< Estimated item count used for initialization */
+};
+
 /** \brief Internal structure of the manager */
 struct idx_mgr_s {
     ipx_ctx_t *ctx;             /**< Instance context (only for logs!)        */
-    bfi_index_ptr_t idx_ptr;    /**< Instance of a Bloom filter index         */
+    struct idx_mgr_index idx;   /**< Index of the current window              */
+    struct idx_mgr_index spare; /**< Unused index (returned by the saver)     */
     char *idx_filename;     /**< Filename of current index file               */
+    uint64_t last_cnt;      /**< Item count of the last saved window          */
 
     struct {
         uint64_t est_items; /**< Estimated item count in a Bloom filter       */
@@ -96,8 +111,84 @@ struct idx_mgr_s {
         bool  en_autosize;        /**< Enable auto-size (on/off)              */
         enum IDX_MGR_STATE state; /**< State of the manager                   */
     } cfg_mgr;             /**< Configuration of the manager                  */
+
+    /**
+     * Cache of recently added addresses. Adding an address, which is already in the Bloom
+     * filter, doesn't change the filter, so repeated addresses (e.g. popular servers) are
+     * filtered out before the (expensive) insertion to the index.
+     */
+    struct {
+        uint8_t addrs[IDX_CACHE_SIZE][IDX_CACHE_ADDR]; /**< Addresses        */
+        bool valid[IDX_CACHE_SIZE];                     /**< Valid entries    */
+    } cache;
+
+    /** Background saver of closed windows */
+    struct {
+        pthread_t thread;          /**< Thread                                */
+        pthread_mutex_t mutex;     /**< Synchronization of the saver          */
+        pthread_cond_t cond_job;   /**< Notification about a new job          */
+        pthread_cond_t cond_done;  /**< Notification about a finished job     */
+        struct idx_mgr_index idx;  /**< Index to save/saved index             */
+        char *filename;            /**< Output file of the index              */
+        bool busy;                 /**< The thread is saving the index        */
+        bool stop;                 /**< Request to stop the thread            */
+    } saver;
 };
 
+/**
+ * \brief Main function of the background saver
+ * \param[in] arg Pointer to the manager
+ * \return Always NULL
+ */
+static void *
+idx_mgr_saver_main(void *arg)
+{
+    idx_mgr_t *mgr = (idx_mgr_t *) arg;
+
+    pthread_mutex_lock(&mgr->saver.mutex);
+    while (true) {
+        while (!mgr->saver.busy && !mgr->saver.stop) {
+            pthread_cond_wait(&mgr->saver.cond_job, &mgr->saver.mutex);
+        }
+
+        if (!mgr->saver.busy) {
+            // Stop request
+            break;
+        }
+
+        bfi_index_ptr_t idx_ptr = mgr->saver.idx.ptr;
+        char *filename = mgr->saver.filename;
+        pthread_mutex_unlock(&mgr->saver.mutex);
+
+        bfi_ecode_t ret = bfi_store_index(idx_ptr, filename);
+        if (ret != BFI_E_OK) {
+            IPX_CTX_ERROR(mgr->ctx, "Failed to store a BF index: %s", bfi_get_error_msg(ret));
+        }
+        free(filename);
+
+        pthread_mutex_lock(&mgr->saver.mutex);
+        mgr->saver.filename = NULL;
+        mgr->saver.busy = false;
+        pthread_cond_signal(&mgr->saver.cond_done);
+    }
+    pthread_mutex_unlock(&mgr->saver.mutex);
+
+    return NULL;
+}
+
+/**
+ * \brief Wait until the background saver is idle
+ * \param[in] mgr Pointer to the manager
+ */
+static void
+idx_mgr_saver_wait(idx_mgr_t *mgr)
+{
+    pthread_mutex_lock(&mgr->saver.mutex);
+    while (mgr->saver.busy) {
+        pthread_cond_wait(&mgr->saver.cond_done, &mgr->saver.mutex);
+    }
+    pthread_mutex_unlock(&mgr->saver.mutex);
+}
 
 idx_mgr_t *
 idx_mgr_create(ipx_ctx_t *ctx, double prob, uint64_t item_cnt, bool autosize)
@@ -116,15 +207,53 @@ idx_mgr_create(ipx_ctx_t *ctx, double prob, uint64_t item_cnt, bool autosize)
         return NULL;
     }
 
+    // Start the background saver
+    if (pthread_mutex_init(&mgr->saver.mutex, NULL) != 0) {
+        IPX_CTX_ERROR(ctx, "Index manager error (failed to initialize a mutex).", '\0');
+        free(mgr);
+        return NULL;
+    }
+
+    if (pthread_cond_init(&mgr->saver.cond_job, NULL) != 0
+            || pthread_cond_init(&mgr->saver.cond_done, NULL) != 0) {
+        IPX_CTX_ERROR(ctx, "Index manager error (failed to initialize a condition variable).",
+            '\0');
+        pthread_mutex_destroy(&mgr->saver.mutex);
+        free(mgr);
+        return NULL;
+    }
+
+    mgr->ctx = ctx;
+    if (pthread_create(&mgr->saver.thread, NULL, &idx_mgr_saver_main, mgr) != 0) {
+        IPX_CTX_ERROR(ctx, "Index manager error (failed to start a thread).", '\0');
+        pthread_cond_destroy(&mgr->saver.cond_done);
+        pthread_cond_destroy(&mgr->saver.cond_job);
+        pthread_mutex_destroy(&mgr->saver.mutex);
+        free(mgr);
+        return NULL;
+    }
+
     // Save parameters
     mgr->cfg_bloom.est_items = item_cnt;
     mgr->cfg_bloom.fp_prob = prob;
     mgr->cfg_mgr.en_autosize = autosize;
     mgr->cfg_mgr.state = IDX_MGR_S_INIT;
-    mgr->ctx = ctx;
     return mgr;
 }
 
+/**
+ * \brief Destroy an index (if exists)
+ * \param[in,out] idx Index
+ */
+static void
+idx_mgr_index_destroy(struct idx_mgr_index *idx)
+{
+    if (idx->ptr != NULL) {
+        bfi_destroy_index(&idx->ptr);
+        idx->ptr = NULL;
+    }
+}
+
 void
 idx_mgr_destroy(idx_mgr_t *mgr)
 {
@@ -133,10 +262,21 @@ idx_mgr_destroy(idx_mgr_t *mgr)
     }
 
     idx_mgr_save_index(mgr);
-    if (mgr->idx_ptr) {
-        bfi_destroy_index(&(mgr->idx_ptr));
-    }
 
+    // Wait until the last window is saved and stop the thread
+    pthread_mutex_lock(&mgr->saver.mutex);
+    mgr->saver.stop = true;
+    pthread_cond_signal(&mgr->saver.cond_job);
+    pthread_mutex_unlock(&mgr->saver.mutex);
+    pthread_join(mgr->saver.thread, NULL);
+
+    pthread_cond_destroy(&mgr->saver.cond_done);
+    pthread_cond_destroy(&mgr->saver.cond_job);
+    pthread_mutex_destroy(&mgr->saver.mutex);
+
+    idx_mgr_index_destroy(&mgr->idx);
+    idx_mgr_index_destroy(&mgr->spare);
+    idx_mgr_index_destroy(&mgr->saver.idx);
     free(mgr->idx_filename);
     free(mgr);
 }
@@ -163,30 +303,44 @@ idx_mgr_unset_curr_file(idx_mgr_t *mgr)
 }
 
 int
-idx_mgr_save_index(const idx_mgr_t *mgr)
+idx_mgr_save_index(idx_mgr_t *mgr)
 {
-    bfi_ecode_t ret;
-
     if (mgr->cfg_mgr.state != IDX_MGR_S_WINDOW_FULL &&
             mgr->cfg_mgr.state != IDX_MGR_S_WINDOW_FIRST_PARTIAL) {
         // Index file is broken or doesn't exist, don't save.
         return 0;
     }
 
-    ret = bfi_store_index(mgr->idx_ptr, mgr->idx_filename);
-    if (ret != BFI_E_OK) {
-        IPX_CTX_ERROR(mgr->ctx, "Failed to store a BF index: %s", bfi_get_error_msg(ret));
-        return 1;
+    if (!mgr->idx_filename || !mgr->idx.ptr) {
+        // Already saved
+        return 0;
     }
 
+    // The previous window must be saved to reuse its index
+    idx_mgr_saver_wait(mgr);
+    assert(mgr->spare.ptr == NULL);
+    mgr->spare = mgr->saver.idx;
+
+    // Pass the index and the filename to the saver
+    mgr->last_cnt = bfi_stored_item_cnt(mgr->idx.ptr);
+    pthread_mutex_lock(&mgr->saver.mutex);
+    mgr->saver.idx = mgr->idx;
+    mgr->saver.filename = mgr->idx_filename;
+    mgr->saver.busy = true;
+    pthread_cond_signal(&mgr->saver.cond_job);
+    pthread_mutex_unlock(&mgr->saver.mutex);
+
+    mgr->idx.ptr = NULL;
+    mgr->idx_filename = NULL;
     return 0;
 }
 
 /**
  * \brief Prepare the Bloom filter index
  *
- * Create & initialize a new Bloom filter index. If previous one still exists,
- * it is destroyed first.
+ * If the unused index has the same parameters, it is cleared and reused. Otherwise, a new
+ * Bloom filter index is created and initialized. If previous one still exists, it is
+ * destroyed first.
  * \param[in,out] mgr Pointer to an index manager
  * \return On success returns 0. Otherwise returns a non-zero value.
  */
@@ -195,11 +349,25 @@ idx_mgr_index_prepare(idx_mgr_t *mgr)
 {
     bfi_ecode_t ret;
 
-    if (mgr->idx_ptr != NULL) {
-        // Destroy previous instance
-        bfi_destroy_index(&(mgr->idx_ptr));
+    if (mgr->idx.ptr == NULL) {
+        // The index of the previous window has been passed to the saver
+        mgr->idx = mgr->spare;
+        mgr->spare.ptr = NULL;
+    }
+
+    if (mgr->idx.ptr != NULL && mgr->idx.est_items == mgr->cfg_bloom.est_items) {
+        // Only clear the current index (parameters are the same)
+        ret = bfi_clear_index(mgr->idx.ptr);
+        if (ret != BFI_E_OK) {
+            IPX_CTX_ERROR(mgr->ctx, "Failed to clean a BF index: %s", bfi_get_error_msg(ret));
+            return 1;
+        }
+        return 0;
     }
 
+    // Destroy previous instance
+    idx_mgr_index_destroy(&mgr->idx);
+
     bfi_index_ptr_t new_index;
     ret = bfi_init_index(&new_index, mgr->cfg_bloom.est_items,
                             mgr->cfg_bloom.fp_prob);
@@ -208,7 +376,8 @@ idx_mgr_index_prepare(idx_mgr_t *mgr)
         return 1;
     }
 
-    mgr->idx_ptr = new_index;
+    mgr->idx.ptr = new_index;
+    mgr->idx.est_items = mgr->cfg_bloom.est_items;
     return 0;
 }
 
@@ -216,8 +385,9 @@ int
 idx_mgr_window_new(idx_mgr_t *mgr, char *index_filename)
 {
     bool reinit = false;
-    bfi_ecode_t ret;
 
+    // Store the previous window (if not already done)
+    idx_mgr_save_index(mgr);
     idx_mgr_unset_curr_file(mgr);
 
     // Check indexing state
@@ -229,9 +399,9 @@ idx_mgr_window_new(idx_mgr_t *mgr, char *index_filename)
     if (!reinit && mgr->cfg_mgr.en_autosize) {
         /*
          * Calculate minimal & maximal expected estimate (item count in Bloom
-         * filter index) based on number of elements in the current window.
+         * filter index) based on number of elements in the previous window.
          */
-        uint64_t act_cnt = bfi_stored_item_cnt(mgr->idx_ptr);
+        uint64_t act_cnt = mgr->last_cnt;
         double coeff = BF_TOL_COEFF(act_cnt);
 
         double est_low = BF_LOWER_TOLERANCE(act_cnt, coeff);
@@ -244,34 +414,23 @@ idx_mgr_window_new(idx_mgr_t *mgr, char *index_filename)
         if (est_high > mgr->cfg_bloom.est_items) {
             // Higher act_cnt = make bigger bloom filter
             mgr->cfg_bloom.est_items = act_cnt * coeff;
-            reinit = true;
         } else if (est_low < mgr->cfg_bloom.est_items && act_cnt > 0 &&
                 mgr->cfg_mgr.state == IDX_MGR_S_WINDOW_FULL) {
             // Lower act_cnt -> save space, make smaller bloom filter
             // Note: allow size reduction only based on the FULL previous window
             mgr->cfg_bloom.est_items = act_cnt * coeff;
-            reinit = true;
         }
     }
 
-    // Prepare index
-    if (reinit) {
-        // Destroy & create a new index (new parameters)
-        if (idx_mgr_index_prepare(mgr) != 0) {
-            // Something went wrong
-            idx_mgr_invalidate(mgr);
-            return 1;
-        }
-    } else {
-        // Only clear the current index (parameters are the same)
-        ret = bfi_clear_index(mgr->idx_ptr);
-        if (ret != BFI_E_OK){
-            IPX_CTX_ERROR(mgr->ctx, "Failed to clean a BF index: %s", bfi_get_error_msg(ret));
-            idx_mgr_invalidate(mgr);
-            return 1;
-        }
+    // Prepare index (reused if the parameters are the same)
+    if (idx_mgr_index_prepare(mgr) != 0) {
+        // Something went wrong
+        idx_mgr_invalidate(mgr);
+        return 1;
     }
 
+    memset(mgr->cache.valid, 0, sizeof(mgr->cache.valid));
+
     if (idx_mgr_set_curr_file(mgr, index_filename) != 0){
         // Something went wrong
         idx_mgr_invalidate(mgr);
@@ -309,6 +468,31 @@ idx_mgr_invalidate(idx_mgr_t *mgr)
     mgr->cfg_mgr.state = IDX_MGR_S_ERROR;
 }
 
+/**
+ * \brief Check and update the cache of recently added addresses
+ * \param[in,out] mgr    Pointer to a manager
+ * \param[in]     buffer Address
+ * \return True if the address has been recently added. Otherwise returns false and the address
+ *   is put into the cache.
+ */
+static inline bool
+idx_mgr_cache_hit(idx_mgr_t *mgr, const unsigned char *buffer)
+{
+    uint64_t words[2];
+    memcpy(words, buffer, sizeof(words));
+    const uint64_t hash = (words[0] ^ (words[1] * UINT64_C(0x9E3779B97F4A7C15)))
+        * UINT64_C(0xFF51AFD7ED558CCD);
+    const size_t slot = (size_t) (hash >> 40) & (IDX_CACHE_SIZE - 1U);
+
+    if (mgr->cache.valid[slot] && memcmp(mgr->cache.addrs[slot], buffer, IDX_CACHE_ADDR) == 0) {
+        return true;
+    }
+
+    memcpy(mgr->cache.addrs[slot], buffer, IDX_CACHE_ADDR);
+    mgr->cache.valid[slot] = true;
+    return false;
+}
+
 int
 idx_mgr_add(idx_mgr_t *mgr, const unsigned char *buffer, const size_t len)
 {
@@ -319,7 +503,17 @@ idx_mgr_add(idx_mgr_t *mgr, const unsigned char *buffer, const size_t len)
         return 1;
     }
 
-    ret = bfi_add_addr_index(mgr->idx_ptr, buffer, len);
+    if (!mgr->idx.ptr) {
+        // The window has been already saved
+        return 1;
+    }
+
+    if (len == IDX_CACHE_ADDR && idx_mgr_cache_hit(mgr, buffer)) {
+        // Already in the index
+        return 0;
+    }
+
+    ret = bfi_add_addr_index(mgr->idx.ptr, buffer, len);
     if (ret != BFI_E_OK) {
         IPX_CTX_ERROR(mgr->ctx, "Failed to add a record to a BF index: %s", bfi_get_error_msg(ret));
         idx_mgr_invalidate(mgr);
@@ -328,4 +522,3 @@ idx_mgr_add(idx_mgr_t *mgr, const unsigned char *buffer, const size_t len)
 
     return 0;
 }
-
@@ -106,13 +106,17 @@ idx_mgr_unset_curr_file(idx_mgr_t *mgr);
 /**
  * \brief Store/flush an Bloom filter index to an output file
  *
- * \param[in] mgr Pointer to a manager
+ * The index is written by a background thread, therefore, the function doesn't wait until
+ * the file is written (unless the previous index is still being written). Failures of the
+ * thread are reported to the log. After the call, addition of new IP addresses is not
+ * allowed until a new window is created.
+ * \param[in,out] mgr Pointer to a manager
  * \return If save was successful or should not be done because of indexing
  *   state (i.e. "nothing to save" in the error or initial state" 0 is returned.
  *   Otherwise returns a non-zero value.
  */
 int
-idx_mgr_save_index(const idx_mgr_t *mgr);
+idx_mgr_save_index(idx_mgr_t *mgr);
 
 /**
  * \brief Create a new window
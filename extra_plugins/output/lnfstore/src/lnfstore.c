@@ -60,6 +60,49 @@ IPX_API struct ipx_plugin_info ipx_plugin_info = {
     .ipx_min = "2.0.0"
 };
 
+/**
+ * \brief Pass the current batch of records (if any) to the storage
+ * \param[in] conf Plugin instance
+ */
+static void
+lnfstore_batch_flush(struct conf_lnfstore *conf)
+{
+    stg_batch_t *batch = conf->record.batch;
+    if (!batch) {
+        return;
+    }
+
+    if (stg_batch_cnt(batch) > 0) {
+        stg_basic_store(conf->storage.basic, batch);
+    }
+
+    stg_batch_unref(batch);
+    conf->record.batch = NULL;
+}
+
+/**
+ * \brief Add the converted LNF record to the current batch of records
+ *
+ * Full batches are passed to the storage.
+ * \param[in] ctx  Instance context
+ * \param[in] conf Plugin instance
+ */
+static void
+lnfstore_batch_add(ipx_ctx_t *ctx, struct conf_lnfstore *conf)
+{
+    if (!conf->record.batch) {
+        conf->record.batch = stg_pool_get(conf->record.pool);
+    }
+
+    if (stg_batch_add(conf->record.batch, conf->record.rec_ptr) != 0) {
+        IPX_CTX_WARNING(ctx, "Failed to copy a LNF record to a batch of records.", '\0');
+    }
+
+    if (stg_batch_full(conf->record.batch)) {
+        lnfstore_batch_flush(conf);
+    }
+}
+
 // Storage plugin initialization function.
 int
 ipx_plugin_init(ipx_ctx_t *ctx, const char *params) {
@@ -98,6 +141,16 @@ ipx_plugin_init(ipx_ctx_t *ctx, const char *params) {
         return IPX_ERR_DENIED;
     }
 
+    conf->record.pool = stg_pool_create(ctx, STG_POOL_BATCHES, STG_BATCH_RECORDS);
+    if (!conf->record.pool) {
+        IPX_CTX_ERROR(ctx, "Failed to initialize a pool of record batches.", '\0');
+        translator_destroy(conf->record.translator);
+        lnf_rec_free(conf->record.rec_ptr);
+        configuration_free(parsed_params);
+        free(conf);
+        return IPX_ERR_DENIED;
+    }
+
     // Init basic/profile file storage
     //if (conf->params->profiles.en) {
     //    conf->storage.profiles = stg_profiles_create(parsed_params);
@@ -107,10 +160,12 @@ ipx_plugin_init(ipx_ctx_t *ctx, const char *params) {
 
     if (!conf->storage.basic/* && !conf->storage.profiles*/) {
         IPX_CTX_ERROR(ctx, "Failed to initialize an internal structure for file storage(s).", '\0');
+        stg_pool_destroy(conf->record.pool);
         translator_destroy(conf->record.translator);
         lnf_rec_free(conf->record.rec_ptr);
         configuration_free(parsed_params);
         free(conf);
+        return IPX_ERR_DENIED;
     }
 
     // Save the configuration
@@ -122,7 +177,6 @@ ipx_plugin_init(ipx_ctx_t *ctx, const char *params) {
 int
 ipx_plugin_process(ipx_ctx_t *ctx, void *cfg, ipx_msg_t *msg)
 {
-    (void) ctx;
     struct conf_lnfstore *conf = (struct conf_lnfstore *) cfg;
 
     // Decide whether close files and create new time window
@@ -138,7 +192,8 @@ ipx_plugin_process(ipx_ctx_t *ctx, void *cfg, ipx_msg_t *msg)
 
         conf->window_start = new_time;
 
-        // Update storage files
+        // Update storage files (after all records of the previous window)
+        lnfstore_batch_flush(conf);
         stg_basic_new_window(conf->storage.basic, new_time);
     }
 
@@ -157,7 +212,7 @@ ipx_plugin_process(ipx_ctx_t *ctx, void *cfg, ipx_msg_t *msg)
             continue;
         }
 
-        stg_basic_store(conf->storage.basic, lnf_rec);
+        lnfstore_batch_add(ctx, conf);
 
         // Is it biflow? Store the reverse direction
         if (!biflow) {
@@ -170,7 +225,7 @@ ipx_plugin_process(ipx_ctx_t *ctx, void *cfg, ipx_msg_t *msg)
             continue;
         }
 
-        stg_basic_store(conf->storage.basic, lnf_rec);
+        lnfstore_batch_add(ctx, conf);
     }
 
     return 0;
@@ -183,6 +238,9 @@ ipx_plugin_destroy(ipx_ctx_t *ctx, void *cfg)
     (void) ctx;
     struct conf_lnfstore *conf = (struct conf_lnfstore *) cfg;
 
+    // Pass remaining records to the storage
+    lnfstore_batch_flush(conf);
+
     // Destroy mode resources
     //if (conf->params->profiles.en) {
     //    stg_profiles_destroy(conf->storage.profiles);
@@ -190,7 +248,8 @@ ipx_plugin_destroy(ipx_ctx_t *ctx, void *cfg)
         stg_basic_destroy(conf->storage.basic);
     //}
 
-    // Destroy a translator and a record
+    // Destroy a translator and records (all batches have been returned by the storage)
+    stg_pool_destroy(conf->record.pool);
     translator_destroy(conf->record.translator);
     lnf_rec_free(conf->record.rec_ptr);
 
@@ -48,6 +48,7 @@
 
 #include "configuration.h"
 #include "storage_basic.h"
+#include "storage_worker.h"
 #include "translator.h"
 
 extern const char *msg_module;
@@ -70,6 +71,8 @@ struct conf_lnfstore {
     struct {
         lnf_rec_t *rec_ptr;       /**< LNF record (converted IPFIX record)   */
         translator_t *translator; /**< IPFIX to LNF translator               */
+        stg_pool_t *pool;         /**< Pool of batches for storage workers   */
+        stg_batch_t *batch;       /**< Batch being filled (NULL == none)     */
     } record; /**< Record conversion */
 };
 
@@ -42,6 +42,7 @@
 #include "storage_basic.h"
 #include "storage_common.h"
 #include "configuration.h"
+#include "storage_worker.h"
 
 /** \brief Basic storage structure */
 struct stg_basic_s {
@@ -49,9 +50,54 @@ struct stg_basic_s {
     ipx_ctx_t *ctx;
     /** Pointer to the plugin configuration */
     const struct conf_params *params;
-    files_mgr_t *mgr; /**< Output files     */
+    files_mgr_t *mgr; /**< Output files (accessed only by the worker) */
+    stg_worker_t *worker; /**< Background writer */
 };
 
+/**
+ * \brief Store a LNF record to output files (called by the worker)
+ * \param[in] priv Storage
+ * \param[in] rec  LNF record
+ * \return On success returns 0. Otherwise returns a non-zero value.
+ */
+static int
+stg_basic_store_cb(void *priv, lnf_rec_t *rec)
+{
+    stg_basic_t *storage = (stg_basic_t *) priv;
+    return files_mgr_add_record(storage->mgr, rec);
+}
+
+/**
+ * \brief Create a new time window (called by the worker)
+ * \param[in] priv   Storage
+ * \param[in] window Identification time of new window (UTC)
+ * \return On success returns 0. Otherwise returns a non-zero value.
+ */
+static int
+stg_basic_window_cb(void *priv, time_t window)
+{
+    stg_basic_t *storage = (stg_basic_t *) priv;
+
+    // Check if the output directory already exists
+    const char *dir_path = storage->params->files.path;
+    if (stg_common_dir_exists(dir_path)) {
+        files_mgr_invalidate(storage->mgr);
+        IPX_CTX_ERROR(storage->ctx, "Failed to create a new time window. All data will be lost "
+            "(output directory '%s' doesn't exists or search permission is denied for one or more "
+            "directories in the path).", dir_path);
+        return 1;
+    }
+
+    int ret = files_mgr_new_window(storage->mgr, &window);
+    if (ret) {
+        IPX_CTX_WARNING(storage->ctx, "New time window is not properly created.", '\0');
+        return 1;
+    } else {
+        IPX_CTX_INFO(storage->ctx, "New time window successfully created.", '\0');
+        return 0;
+    }
+}
+
 
 stg_basic_t *
 stg_basic_create(ipx_ctx_t *ctx, const struct conf_params *params)
@@ -75,44 +121,40 @@ stg_basic_create(ipx_ctx_t *ctx, const struct conf_params *params)
     instance->params = params;
     instance->mgr = mgr;
     instance->ctx = ctx;
+
+    // Start a background writer
+    const struct stg_worker_cb cb = {
+        .store = stg_basic_store_cb,
+        .new_window = stg_basic_window_cb
+    };
+    instance->worker = stg_worker_create(ctx, &cb, instance);
+    if (!instance->worker) {
+        IPX_CTX_ERROR(ctx, "Failed to create a background writer.", '\0');
+        files_mgr_destroy(mgr);
+        free(instance);
+        return NULL;
+    }
+
     return instance;
 }
 
 void
 stg_basic_destroy(stg_basic_t *storage)
 {
+    // Remaining records are written before the worker is stopped
+    stg_worker_destroy(storage->worker);
     files_mgr_destroy(storage->mgr);
     free(storage);
 }
 
-int
-stg_basic_store(stg_basic_t *storage, lnf_rec_t *rec)
+void
+stg_basic_store(stg_basic_t *storage, stg_batch_t *batch)
 {
-    return files_mgr_add_record(storage->mgr, rec);
+    stg_worker_push(storage->worker, batch);
 }
 
-int
+void
 stg_basic_new_window(stg_basic_t *storage, time_t window)
 {
-    // Check if the output directory already exists
-    const char *dir_path = storage->params->files.path;
-    if (stg_common_dir_exists(dir_path)) {
-        files_mgr_invalidate(storage->mgr);
-        IPX_CTX_ERROR(storage->ctx, "Failed to create a new time window. All data will be lost "
-            "(output directory '%s' doesn't exists or search permission is denied for one or more "
-            "directories in the path).", dir_path);
-        return 1;
-    }
-
-    int ret = files_mgr_new_window(storage->mgr, &window);
-    if (ret) {
-        IPX_CTX_WARNING(storage->ctx, "New time window is not properly created.", '\0');
-        return 1;
-    } else {
-        IPX_CTX_INFO(storage->ctx, "New time window successfully created.", '\0');
-        return 0;
-    }
+    stg_worker_window(storage->worker, window);
 }
-
-
-
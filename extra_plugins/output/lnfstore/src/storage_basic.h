@@ -41,6 +41,7 @@
 #define LS_STORAGE_BASIC_H
 
 #include "configuration.h"
+#include "storage_worker.h"
 #include <libnf.h>
 #include <ipfixcol2.h>
 
@@ -68,24 +69,25 @@ void
 stg_basic_destroy(stg_basic_t *storage);
 
 /**
- * \brief Store a LNF record to a storage
+ * \brief Store a batch of LNF records to a storage
+ *
+ * Records are written to output files by a background worker of the storage, which holds
+ * its own reference to the batch. Failures are reported by the worker.
  * \param[in,out] storage Storage
- * \param[in]     rec     LNF record
- * \return On success returns 0. Otherwise (failed to write to any of output
- *   files) returns a non-zero value.
+ * \param[in]     batch   Batch of LNF records
  */
-int
-stg_basic_store(stg_basic_t *storage, lnf_rec_t *rec);
+void
+stg_basic_store(stg_basic_t *storage, stg_batch_t *batch);
 
 /**
  * \brief Create a new time window
  *
- * Current output file(s) will be closed and new ones will be opened
+ * Current output file(s) will be closed and new ones will be opened by the background worker
+ * after all previously stored records are written. Failures are reported by the worker.
  * \param[in,out] storage Storage
  * \param[in]     window  Identification time of new window (UTC)
- * \return On success returns 0. Otherwise returns a non-zero value.
  */
-int
+void
 stg_basic_new_window(stg_basic_t *storage, time_t window);
 
 #endif //LS_STORAGE_BASIC_H
@@ -0,0 +1,428 @@
+/**
+ * \file storage_worker.c
+ * \author agent <agent@local>
+ * \brief Background workers of storages (source file)
+ *
+ *
+ * Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is, and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#include <pthread.h>
+#include <stdlib.h>
+
+#include "storage_worker.h"
+
+/** Capacity of a queue of a worker */
+#define STG_QUEUE_SIZE (2U * STG_POOL_BATCHES)
+
+/** \brief Batch of LNF records */
+struct stg_batch_s {
+    /** Pool of the batch                  */
+    stg_pool_t *pool;
+    /** Number of references               */
+    unsigned int refcnt;
+    /** Number of valid records            */
+    size_t cnt;
+    /** Number of allocated records        */
+    size_t size;
+    /** Records                            */
+    lnf_rec_t **recs;
+};
+
+/** \brief Pool of batches */
+struct stg_pool_s {
+    /** Instance context (only for logs!)  */
+    ipx_ctx_t *ctx;
+    /** Synchronization of the pool        */
+    pthread_mutex_t mutex;
+    /** Notification about a returned batch */
+    pthread_cond_t cond;
+    /** Number of batches                  */
+    size_t size;
+    /** Number of unused batches           */
+    size_t free_cnt;
+    /** Unused batches                     */
+    stg_batch_t **free;
+    /** All batches                        */
+    stg_batch_t *batches;
+};
+
+/** \brief Job of a worker */
+struct stg_job {
+    /** Batch of records (NULL == window change) */
+    stg_batch_t *batch;
+    /** Identification time of new window        */
+    time_t window;
+};
+
+/** \brief Worker of a storage */
+struct stg_worker_s {
+    /** Instance context (only for logs!)  */
+    ipx_ctx_t *ctx;
+    /** Callbacks of the storage           */
+    struct stg_worker_cb cb;
+    /** Private data of the storage        */
+    void *priv;
+
+    /** Thread                             */
+    pthread_t thread;
+    /** Synchronization of the queue       */
+    pthread_mutex_t mutex;
+    /** Notification about a new job       */
+    pthread_cond_t cond_job;
+    /** Notification about free space      */
+    pthread_cond_t cond_space;
+    /** Queue of jobs (ring buffer)        */
+    struct stg_job queue[STG_QUEUE_SIZE];
+    /** Index of the first job             */
+    size_t head;
+    /** Number of jobs in the queue        */
+    size_t cnt;
+    /** Request to stop the thread         */
+    bool stop;
+};
+
+stg_pool_t *
+stg_pool_create(ipx_ctx_t *ctx, size_t batches, size_t recs)
+{
+    stg_pool_t *pool = calloc(1, sizeof(*pool));
+    if (!pool) {
+        IPX_CTX_ERROR(ctx, "Unable to allocate memory (%s:%d)", __FILE__, __LINE__);
+        return NULL;
+    }
+
+    if (pthread_mutex_init(&pool->mutex, NULL) != 0) {
+        IPX_CTX_ERROR(ctx, "Failed to initialize a mutex of a pool.", '\0');
+        free(pool);
+        return NULL;
+    }
+
+    if (pthread_cond_init(&pool->cond, NULL) != 0) {
+        IPX_CTX_ERROR(ctx, "Failed to initialize a condition variable of a pool.", '\0');
+        pthread_mutex_destroy(&pool->mutex);
+        free(pool);
+        return NULL;
+    }
+
+    pool->ctx = ctx;
+    pool->batches = calloc(batches, sizeof(*pool->batches));
+    pool->free = calloc(batches, sizeof(*pool->free));
+    if (!pool->batches || !pool->free) {
+        IPX_CTX_ERROR(ctx, "Unable to allocate memory (%s:%d)", __FILE__, __LINE__);
+        stg_pool_destroy(pool);
+        return NULL;
+    }
+
+    pool->size = batches;
+    for (size_t i = 0; i < batches; ++i) {
+        stg_batch_t *batch = &pool->batches[i];
+        batch->pool = pool;
+        batch->recs = calloc(recs, sizeof(*batch->recs));
+        if (!batch->recs) {
+            IPX_CTX_ERROR(ctx, "Unable to allocate memory (%s:%d)", __FILE__, __LINE__);
+            stg_pool_destroy(pool);
+            return NULL;
+        }
+
+        for (size_t j = 0; j < recs; ++j) {
+            if (lnf_rec_init(&batch->recs[j]) != LNF_OK) {
+                IPX_CTX_ERROR(ctx, "Failed to initialize a LNF record of a batch.", '\0');
+                stg_pool_destroy(pool);
+                return NULL;
+            }
+            batch->size++;
+        }
+
+        pool->free[pool->free_cnt++] = batch;
+    }
+
+    return pool;
+}
+
+void
+stg_pool_destroy(stg_pool_t *pool)
+{
+    if (pool->batches) {
+        for (size_t i = 0; i < pool->size; ++i) {
+            stg_batch_t *batch = &pool->batches[i];
+            for (size_t j = 0; j < batch->size; ++j) {
+                lnf_rec_free(batch->recs[j]);
+            }
+            free(batch->recs);
+        }
+    }
+
+    pthread_cond_destroy(&pool->cond);
+    pthread_mutex_destroy(&pool->mutex);
+    free(pool->batches);
+    free(pool->free);
+    free(pool);
+}
+
+stg_batch_t *
+stg_pool_get(stg_pool_t *pool)
+{
+    pthread_mutex_lock(&pool->mutex);
+    while (pool->free_cnt == 0) {
+        pthread_cond_wait(&pool->cond, &pool->mutex);
+    }
+
+    stg_batch_t *batch = pool->free[--pool->free_cnt];
+    pthread_mutex_unlock(&pool->mutex);
+
+    batch->cnt = 0;
+    batch->refcnt = 1;
+    return batch;
+}
+
+int
+stg_batch_add(stg_batch_t *batch, lnf_rec_t *rec)
+{
+    if (batch->cnt >= batch->size) {
+        return 1;
+    }
+
+    lnf_rec_t *dst = batch->recs[batch->cnt];
+    lnf_rec_clear(dst);
+    if (lnf_rec_copy(dst, rec) != LNF_OK) {
+        return 1;
+    }
+
+    batch->cnt++;
+    return 0;
+}
+
+size_t
+stg_batch_cnt(const stg_batch_t *batch)
+{
+    return batch->cnt;
+}
+
+bool
+stg_batch_full(const stg_batch_t *batch)
+{
+    return batch->cnt >= batch->size;
+}
+
+/**
+ * \brief Add a reference to a batch
+ * \param[in] batch Batch
+ */
+static inline void
+stg_batch_ref(stg_batch_t *batch)
+{
+    __atomic_add_fetch(&batch->refcnt, 1, __ATOMIC_RELAXED);
+}
+
+void
+stg_batch_unref(stg_batch_t *batch)
+{
+    if (__atomic_sub_fetch(&batch->refcnt, 1, __ATOMIC_ACQ_REL) != 0) {
+        return;
+    }
+
+    stg_pool_t *pool = batch->pool;
+    pthread_mutex_lock(&pool->mutex);
+    pool->free[pool->free_cnt++] = batch;
+    pthread_cond_signal(&pool->cond);
+    pthread_mutex_unlock(&pool->mutex);
+}
+
+/**
+ * \brief Process a job of a worker (called by the thread)
+ * \param[in] worker Worker
+ * \param[in] job    Job
+ */
+static void
+stg_worker_process(stg_worker_t *worker, const struct stg_job *job)
+{
+    if (!job->batch) {
+        worker->cb.new_window(worker->priv, job->window);
+        return;
+    }
+
+    stg_batch_t *batch = job->batch;
+    size_t failed = 0;
+    for (size_t i = 0; i < batch->cnt; ++i) {
+        if (worker->cb.store(worker->priv, batch->recs[i]) != 0) {
+            failed++;
+        }
+    }
+
+    if (failed > 0) {
+        IPX_CTX_WARNING(worker->ctx, "Failed to store %zu of %zu records.", failed, batch->cnt);
+    }
+
+    stg_batch_unref(batch);
+}
+
+/**
+ * \brief Main function of the thread of a worker
+ * \param[in] arg Worker
+ * \return Always NULL
+ */
+static void *
+stg_worker_main(void *arg)
+{
+    stg_worker_t *worker = (stg_worker_t *) arg;
+
+    pthread_mutex_lock(&worker->mutex);
+    while (true) {
+        while (worker->cnt == 0 && !worker->stop) {
+            pthread_cond_wait(&worker->cond_job, &worker->mutex);
+        }
+
+        if (worker->cnt == 0) {
+            // Stop request and no remaining jobs
+            break;
+        }
+
+        struct stg_job job = worker->queue[worker->head];
+        worker->head = (worker->head + 1) % STG_QUEUE_SIZE;
+        worker->cnt--;
+        pthread_cond_signal(&worker->cond_space);
+        pthread_mutex_unlock(&worker->mutex);
+
+        stg_worker_process(worker, &job);
+
+        pthread_mutex_lock(&worker->mutex);
+    }
+    pthread_mutex_unlock(&worker->mutex);
+
+    return NULL;
+}
+
+stg_worker_t *
+stg_worker_create(ipx_ctx_t *ctx, const struct stg_worker_cb *cb, void *priv)
+{
+    stg_worker_t *worker = calloc(1, sizeof(*worker));
+    if (!worker) {
+        IPX_CTX_ERROR(ctx, "Unable to allocate memory (%s:%d)", __FILE__, __LINE__);
+        return NULL;
+    }
+
+    worker->ctx = ctx;
+    worker->cb = *cb;
+    worker->priv = priv;
+
+    if (pthread_mutex_init(&worker->mutex, NULL) != 0) {
+        IPX_CTX_ERROR(ctx, "Failed to initialize a mutex of a worker.", '\0');
+        free(worker);
+        return NULL;
+    }
+
+    if (pthread_cond_init(&worker->cond_job, NULL) != 0) {
+        IPX_CTX_ERROR(ctx, "Failed to initialize a condition variable of a worker.", '\0');
+        pthread_mutex_destroy(&worker->mutex);
+        free(worker);
+        return NULL;
+    }
+
+    if (pthread_cond_init(&worker->cond_space, NULL) != 0) {
+        IPX_CTX_ERROR(ctx, "Failed to initialize a condition variable of a worker.", '\0');
+        pthread_cond_destroy(&worker->cond_job);
+        pthread_mutex_destroy(&worker->mutex);
+        free(worker);
+        return NULL;
+    }
+
+    int rc = pthread_create(&worker->thread, NULL, &stg_worker_main, worker);
+    if (rc != 0) {
+        IPX_CTX_ERROR(ctx, "Failed to start a thread of a worker (pthread_create() returned "
+            "%d).", rc);
+        pthread_cond_destroy(&worker->cond_space);
+        pthread_cond_destroy(&worker->cond_job);
+        pthread_mutex_destroy(&worker->mutex);
+        free(worker);
+        return NULL;
+    }
+
+    return worker;
+}
+
+void
+stg_worker_destroy(stg_worker_t *worker)
+{
+    pthread_mutex_lock(&worker->mutex);
+    worker->stop = true;
+    pthread_cond_signal(&worker->cond_job);
+    pthread_mutex_unlock(&worker->mutex);
+    pthread_join(worker->thread, NULL);
+
+    pthread_cond_destroy(&worker->cond_space);
+    pthread_cond_destroy(&worker->cond_job);
+    pthread_mutex_destroy(&worker->mutex);
+    free(worker);
+}
+
+/**
+ * \brief Append a job to the queue of a worker
+ *
+ * If the queue is full, wait until there is free space.
+ * \param[in] worker Worker
+ * \param[in] job    Job
+ */
+static void
+stg_worker_enqueue(stg_worker_t *worker, const struct stg_job *job)
+{
+    pthread_mutex_lock(&worker->mutex);
+    while (worker->cnt == STG_QUEUE_SIZE) {
+        pthread_cond_wait(&worker->cond_space, &worker->mutex);
+    }
+
+    worker->queue[(worker->head + worker->cnt) % STG_QUEUE_SIZE] = *job;
+    worker->cnt++;
+    pthread_cond_signal(&worker->cond_job);
+    pthread_mutex_unlock(&worker->mutex);
+}
+
+void
+stg_worker_push(stg_worker_t *worker, stg_batch_t *batch)
+{
+    stg_batch_ref(batch);
+
+    struct stg_job job;
+    job.batch = batch;
+    job.window = 0;
+    stg_worker_enqueue(worker, &job);
+}
+
+void
+stg_worker_window(stg_worker_t *worker, time_t window)
+{
+    struct stg_job job;
+    job.batch = NULL;
+    job.window = window;
+    stg_worker_enqueue(worker, &job);
+}
@@ -0,0 +1,198 @@
+/**
+ * \file storage_worker.h
+ * \author agent <agent@local>
+ * \brief Background workers of storages (header file)
+ *
+ *
+ * Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is, and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#ifndef LS_STORAGE_WORKER_H
+#define LS_STORAGE_WORKER_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <time.h>
+#include <libnf.h>
+#include <ipfixcol2.h>
+
+/** Number of batches in a pool      */
+#define STG_POOL_BATCHES   (8U)
+/** Number of records in a batch     */
+#define STG_BATCH_RECORDS  (1024U)
+
+/**
+ * \brief Batch of LNF records
+ *
+ * The batch is reference counted so the same batch can be passed to multiple workers (e.g.
+ * storages of channels). When the last reference is released, the batch is cleared and
+ * returned to the pool it belongs to.
+ */
+typedef struct stg_batch_s stg_batch_t;
+
+/**
+ * \brief Pool of preallocated batches
+ */
+typedef struct stg_pool_s stg_pool_t;
+
+/**
+ * \brief Worker (i.e. a thread and a queue) of a storage
+ */
+typedef struct stg_worker_s stg_worker_t;
+
+/**
+ * \brief Callbacks of a storage called by its worker
+ *
+ * All callbacks are called only by the thread of the worker.
+ */
+struct stg_worker_cb {
+    /**
+     * \brief Store a LNF record
+     * \param[in] priv Private data of the storage
+     * \param[in] rec  LNF record
+     * \return On success returns 0. Otherwise returns a non-zero value.
+     */
+    int (*store)(void *priv, lnf_rec_t *rec);
+    /**
+     * \brief Create a new time window
+     * \param[in] priv   Private data of the storage
+     * \param[in] window Identification time of new window (UTC)
+     * \return On success returns 0. Otherwise returns a non-zero value.
+     */
+    int (*new_window)(void *priv, time_t window);
+};
+
+/**
+ * \brief Create a pool of batches
+ * \param[in] ctx     Instance context (only for logs!)
+ * \param[in] batches Number of batches
+ * \param[in] recs    Number of records per batch
+ * \return On success returns a pointer to the pool. Otherwise returns NULL.
+ */
+stg_pool_t *
+stg_pool_create(ipx_ctx_t *ctx, size_t batches, size_t recs);
+
+/**
+ * \brief Destroy a pool of batches
+ * \warning All batches must be returned to the pool, i.e. all workers must be destroyed.
+ * \param[in] pool Pool
+ */
+void
+stg_pool_destroy(stg_pool_t *pool);
+
+/**
+ * \brief Get an empty batch from a pool
+ *
+ * If all batches are in use, the function waits until one of them is returned.
+ * \param[in] pool Pool
+ * \return Batch with one reference (owned by the caller)
+ */
+stg_batch_t *
+stg_pool_get(stg_pool_t *pool);
+
+/**
+ * \brief Add a copy of a LNF record to a batch
+ * \warning The batch must not be passed to any worker yet and it must not be full.
+ * \param[in] batch Batch
+ * \param[in] rec   LNF record
+ * \return On success returns 0. Otherwise returns a non-zero value.
+ */
+int
+stg_batch_add(stg_batch_t *batch, lnf_rec_t *rec);
+
+/**
+ * \brief Get the number of records in a batch
+ * \param[in] batch Batch
+ */
+size_t
+stg_batch_cnt(const stg_batch_t *batch);
+
+/**
+ * \brief Check whether a batch is full
+ * \param[in] batch Batch
+ */
+bool
+stg_batch_full(const stg_batch_t *batch);
+
+/**
+ * \brief Release a reference to a batch
+ *
+ * After the last reference is released, the batch is returned to its pool.
+ * \param[in] batch Batch
+ */
+void
+stg_batch_unref(stg_batch_t *batch);
+
+/**
+ * \brief Create a worker of a storage
+ *
+ * The worker starts a thread that processes batches and window changes in the same order
+ * as they were passed to the worker.
+ * \param[in] ctx  Instance context (only for logs!)
+ * \param[in] cb   Callbacks of the storage
+ * \param[in] priv Private data of the storage (passed to the callbacks)
+ * \return On success returns a pointer to the worker. Otherwise returns NULL.
+ */
+stg_worker_t *
+stg_worker_create(ipx_ctx_t *ctx, const struct stg_worker_cb *cb, void *priv);
+
+/**
+ * \brief Destroy a worker
+ *
+ * All previously passed batches and window changes are processed before the thread is stopped.
+ * \param[in] worker Worker
+ */
+void
+stg_worker_destroy(stg_worker_t *worker);
+
+/**
+ * \brief Pass a batch of records to a worker
+ *
+ * The worker holds its own reference to the batch until all records are stored. If the queue
+ * of the worker is full, the function waits until there is free space.
+ * \param[in] worker Worker
+ * \param[in] batch  Batch
+ */
+void
+stg_worker_push(stg_worker_t *worker, stg_batch_t *batch);
+
+/**
+ * \brief Pass a request to create a new time window to a worker
+ * \param[in] worker Worker
+ * \param[in] window Identification time of new window (UTC)
+ */
+void
+stg_worker_window(stg_worker_t *worker, time_t window);
+
+#endif //LS_STORAGE_WORKER_H
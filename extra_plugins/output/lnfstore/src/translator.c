@@ -408,6 +408,49 @@ translate_time(const struct fds_drec_field *field,
 #define TRANSLATOR_TABLE_SIZE \
     (sizeof(translator_table_global) / sizeof(translator_table_global[0]))
 
+/** Number of cached conversion programs (must be a power of 2) */
+#define TRANSLATOR_PROGS 64U
+
+/**
+ * \brief Conversion step of a field at a fixed position
+ */
+struct translator_step {
+    /** Index of the field in the template (see translator_prog_fields()) */
+    uint16_t field_idx;
+    /** Offset of the field from the beginning of a record                */
+    uint16_t offset;
+    /** Conversion definition                                              */
+    const struct translator_table_rec *def;
+};
+
+/**
+ * \brief Conversion program of records of one template
+ *
+ * Conversion definitions of fields are resolved only once per template (and flags of the
+ * record iterator). If the template doesn't contain variable-length fields, records are
+ * converted by a linear pass over the steps, i.e. without the record iterator.
+ */
+struct translator_prog {
+    /** Template of the program (NULL == unused)                  */
+    const struct fds_template *tmplt;
+    /** Template snapshot in which the program was last validated */
+    const fds_tsnapshot_t *snap;
+    /** Flags of the record iterator                              */
+    uint16_t flags;
+    /** Copy of the raw template (to detect a reused address)    */
+    uint8_t *raw;
+    /** Size of the raw template                                  */
+    uint16_t raw_len;
+    /** All fields are at fixed positions                         */
+    bool fixed;
+    /** Steps of the fixed program                                */
+    struct translator_step *steps;
+    /** Number of steps                                           */
+    uint16_t steps_cnt;
+    /** Conversion definitions indexed by fields of the template  */
+    const struct translator_table_rec **defs;
+};
+
 struct translator_s {
     /** Instance context (only for log!) */
     ipx_ctx_t *ctx;
@@ -415,6 +458,8 @@ struct translator_s {
     struct translator_table_rec table[TRANSLATOR_TABLE_SIZE];
     /** Record conversion buffer         */
     uint8_t rec_buffer[REC_BUFF_SIZE];
+    /** Cached conversion programs       */
+    struct translator_prog progs[TRANSLATOR_PROGS];
 };
 
 /**
@@ -442,6 +487,175 @@ transtator_cmp(const void *p1, const void *p2)
     }
 }
 
+/**
+ * \brief Find a conversion definition of an IPFIX field
+ * \param[in] trans Translator instance
+ * \param[in] info  Template field
+ * \return Pointer to the definition or NULL
+ */
+static const struct translator_table_rec *
+translator_find(const translator_t *trans, const struct fds_tfield *info)
+{
+    struct translator_table_rec key;
+    key.ipfix.ie = info->id;
+    key.ipfix.pen = info->en;
+
+    return bsearch(&key, trans->table, TRANSLATOR_TABLE_SIZE, sizeof(trans->table[0]),
+        transtator_cmp);
+}
+
+/**
+ * \brief Get fields of a template in the order used by the record iterator
+ * \param[in] tmplt Template
+ * \param[in] flags Flags of the record iterator
+ * \return Array of fields
+ */
+static inline const struct fds_tfield *
+translator_prog_fields(const struct fds_template *tmplt, uint16_t flags)
+{
+    if ((flags & FDS_DREC_BIFLOW_REV) != 0 && tmplt->fields_rev != NULL) {
+        return tmplt->fields_rev;
+    }
+
+    return tmplt->fields;
+}
+
+/**
+ * \brief Free resources of a conversion program and mark it as unused
+ * \param[in] prog Conversion program
+ */
+static void
+translator_prog_clear(struct translator_prog *prog)
+{
+    free(prog->raw);
+    free(prog->steps);
+    free(prog->defs);
+    memset(prog, 0, sizeof(*prog));
+}
+
+/**
+ * \brief Build a conversion program of the template of a record
+ * \param[in]  trans Translator instance
+ * \param[out] prog  Conversion program to fill (previous content is freed)
+ * \param[in]  rec   IPFIX record
+ * \param[in]  flags Flags of the record iterator
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_NOMEM on memory allocation error (the program is unused)
+ */
+static int
+translator_prog_build(translator_t *trans, struct translator_prog *prog, struct fds_drec *rec,
+    uint16_t flags)
+{
+    const struct fds_template *tmplt = rec->tmplt;
+    const uint16_t fields_cnt = tmplt->fields_cnt_total;
+
+    translator_prog_clear(prog);
+    prog->raw = malloc(tmplt->raw.length);
+    prog->steps = malloc(fields_cnt * sizeof(*prog->steps));
+    prog->defs = calloc(fields_cnt, sizeof(*prog->defs));
+    if (!prog->raw || (fields_cnt > 0 && (!prog->steps || !prog->defs))) {
+        IPX_CTX_ERROR(trans->ctx, "Unable to allocate memory (%s:%d)", __FILE__, __LINE__);
+        translator_prog_clear(prog);
+        return IPX_ERR_NOMEM;
+    }
+
+    memcpy(prog->raw, tmplt->raw.data, tmplt->raw.length);
+    prog->raw_len = tmplt->raw.length;
+    prog->fixed = (tmplt->flags & FDS_TEMPLATE_DYNAMIC) == 0;
+
+    const struct fds_tfield *fields = translator_prog_fields(tmplt, flags);
+    struct fds_drec_iter it;
+    fds_drec_iter_init(&it, rec, flags);
+
+    while (fds_drec_iter_next(&it) != FDS_EOC) {
+        const uint16_t field_idx = (uint16_t) (it.field.info - fields);
+        const struct translator_table_rec *def = translator_find(trans, it.field.info);
+        prog->defs[field_idx] = def;
+        if (!def) {
+            continue;
+        }
+
+        struct translator_step *step = &prog->steps[prog->steps_cnt++];
+        step->field_idx = field_idx;
+        step->offset = (uint16_t) (it.field.data - rec->data);
+        step->def = def;
+    }
+
+    prog->tmplt = tmplt;
+    prog->snap = rec->snap;
+    prog->flags = flags;
+    return IPX_OK;
+}
+
+/**
+ * \brief Get a conversion program of the template of a record
+ *
+ * Programs are cached by the address of the template. If the template snapshot of the record
+ * has changed since the last use, the template is compared with the copy in the program, as the
+ * template might have been freed and another one allocated at the same address.
+ * \param[in] trans Translator instance
+ * \param[in] rec   IPFIX record
+ * \param[in] flags Flags of the record iterator
+ * \return Pointer to the program or NULL (memory allocation error)
+ */
+static const struct translator_prog *
+translator_prog_get(translator_t *trans, struct fds_drec *rec, uint16_t flags)
+{
+    const struct fds_template *tmplt = rec->tmplt;
+    const size_t idx = (((uintptr_t) tmplt >> 6) + flags) & (TRANSLATOR_PROGS - 1U);
+    struct translator_prog *prog = &trans->progs[idx];
+
+    if (prog->tmplt == tmplt && prog->flags == flags) {
+        if (prog->snap == rec->snap) {
+            return prog;
+        }
+
+        if (prog->raw_len == tmplt->raw.length
+                && memcmp(prog->raw, tmplt->raw.data, prog->raw_len) == 0) {
+            prog->snap = rec->snap;
+            return prog;
+        }
+    }
+
+    if (translator_prog_build(trans, prog, rec, flags) != IPX_OK) {
+        return NULL;
+    }
+
+    return prog;
+}
+
+/**
+ * \brief Convert an IPFIX field and store it to a LNF record
+ * \param[in]     trans   Translator instance
+ * \param[in]     def     Conversion definition
+ * \param[in]     field   IPFIX field
+ * \param[in,out] lnf_rec LNF record
+ * \return Number of converted fields (i.e. 0 or 1)
+ */
+static inline int
+translator_convert(translator_t *trans, const struct translator_table_rec *def,
+    const struct fds_drec_field *field, lnf_rec_t *lnf_rec)
+{
+    const struct fds_tfield *info = field->info;
+    uint8_t * const buffer_ptr = trans->rec_buffer;
+
+    if (def->func(field, def, buffer_ptr) != 0) {
+        // Conversion function failed
+        IPX_CTX_WARNING(trans->ctx, "Failed to converter a IPFIX IE field  (ID: %" PRIu16 ", "
+            "PEN: %" PRIu32 ") to LNF field.", info->id, info->en);
+        return 0;
+    }
+
+    if (lnf_rec_fset(lnf_rec, def->lnf.id, buffer_ptr) != LNF_OK) {
+        // Setter failed
+        IPX_CTX_WARNING(trans->ctx, "Failed to store a IPFIX IE field (ID: %" PRIu16 ", "
+            "PEN: %" PRIu32 ") to a LNF record.", info->id, info->en);
+        return 0;
+    }
+
+    return 1;
+}
+
 translator_t *
 translator_init(ipx_ctx_t *ctx)
 {
@@ -491,6 +705,10 @@ translator_init(ipx_ctx_t *ctx)
 void
 translator_destroy(translator_t *trans)
 {
+    for (size_t i = 0; i < TRANSLATOR_PROGS; ++i) {
+        translator_prog_clear(&trans->progs[i]);
+    }
+
     free(trans);
 }
 
@@ -500,48 +718,41 @@ translator_translate(translator_t *trans, struct fds_drec *ipfix_rec, lnf_rec_t
 {
     lnf_rec_clear(lnf_rec);
 
+    // Without a program (memory allocation error), each field is searched in the table
+    const struct translator_prog *prog = translator_prog_get(trans, ipfix_rec, flags);
+    const struct fds_tfield *fields = translator_prog_fields(ipfix_rec->tmplt, flags);
+    int converted_fields = 0;
+
+    if (prog && prog->fixed) {
+        // Linear pass over fields at fixed positions
+        for (uint16_t i = 0; i < prog->steps_cnt; ++i) {
+            const struct translator_step *step = &prog->steps[i];
+            struct fds_drec_field field;
+            field.info = &fields[step->field_idx];
+            field.data = ipfix_rec->data + step->offset;
+            field.size = field.info->length;
+            converted_fields += translator_convert(trans, step->def, &field, lnf_rec);
+        }
+
+        return converted_fields;
+    }
+
     // Initialize a record iterator
     struct fds_drec_iter it;
     fds_drec_iter_init(&it, ipfix_rec, flags);
 
     // Try to convert all IPFIX fields
-    struct translator_table_rec key;
-    struct translator_table_rec *def;
-    int converted_fields = 0;
-
-    const size_t table_rec_cnt = TRANSLATOR_TABLE_SIZE;
-    const size_t table_rec_size = sizeof(trans->table[0]);
-    uint8_t * const buffer_ptr = trans->rec_buffer;
-
     while (fds_drec_iter_next(&it) != FDS_EOC) {
-        // Find a conversion function
         const struct fds_tfield *info = it.field.info;
-
-        key.ipfix.ie = info->id;
-        key.ipfix.pen = info->en;
-
-        def = bsearch(&key, trans->table, table_rec_cnt, table_rec_size, transtator_cmp);
+        const struct translator_table_rec *def = (prog)
+            ? prog->defs[info - fields] : translator_find(trans, info);
         if (!def) {
             // Conversion definition not found
             continue;
         }
 
-        if (def->func(&it.field, def, buffer_ptr) != 0) {
-            // Conversion function failed
-            IPX_CTX_WARNING(trans->ctx, "Failed to converter a IPFIX IE field  (ID: %" PRIu16 ", "
-                "PEN: %" PRIu32 ") to LNF field.", info->id, info->en);
-            continue;
-        }
-
-        if (lnf_rec_fset(lnf_rec, def->lnf.id, buffer_ptr) != LNF_OK) {
-            // Setter failed
-            IPX_CTX_WARNING(trans->ctx, "Failed to store a IPFIX IE field (ID: %" PRIu16 ", "
-                "PEN: %" PRIu32 ") to a LNF record.", info->id, info->en);
-            continue;
-        }
-        converted_fields++;
+        converted_fields += translator_convert(trans, def, &it.field, lnf_rec);
     }
 
-    // Cleanup
     return converted_fields;
 }
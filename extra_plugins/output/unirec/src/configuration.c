@@ -74,6 +74,17 @@ enum cfg_timeout_mode {
 /** Default autoflush interval (in microseconds)                */
 #define DEF_IFC_AUTOFLUSH   500000
 
+/** Maximal number of TRAP output interfaces (i.e. UniRec formats) */
+#define MAX_OUTPUTS 32
+
+/** Parsed TRAP interface specifications (without common parameters) */
+struct ifc_list {
+    /** Specifications of interfaces               */
+    char *specs[MAX_OUTPUTS];
+    /** Number of interfaces                       */
+    size_t cnt;
+};
+
 /** Parsed common TRAP parameters                  */
 struct ifc_common {
     /** Automatic flush (0 == disabled)            */
@@ -88,6 +99,7 @@ struct ifc_common {
  *  <params>
  *      <mappingFile>/etc/ipfixcol2/unirec-elements.txt</mappingFile>
  *      <uniRecFormat>DST_IP,SRC_IP,BYTES,DST_PORT,?TCP_FLAGS,SRC_PORT,PROTOCOL</uniRecFormat>
+ *      <uniRecFormat>...</uniRecFormat>                                          <!-- optional -->
  *      <splitBiflow>true</splitBiflow>
  *      <trapIfcCommon>                                                           <!-- optional -->
  *          <timeout>NO_WAIT</timeout>                                            <!-- optional -->
@@ -119,6 +131,9 @@ struct ifc_common {
  *          </file>
  *      </trapIfcSpec>
  *  </params>
+ *
+ *  Multiple UniRec formats and TRAP interfaces can be specified. The N-th format is sent via
+ *  the N-th interface, therefore, the number of formats and interfaces must be the same.
  */
 
 /** XML nodes */
@@ -192,10 +207,10 @@ static const struct fds_xml_args args_ifc_file[] = {
 
 /** Definition of \<trapIfcSpec\> node */
 static const struct fds_xml_args args_trap_spec[] = {
-    FDS_OPTS_NESTED(SPEC_TCP,     "tcp",     args_ifc_tcp,     FDS_OPTS_P_OPT),
-    FDS_OPTS_NESTED(SPEC_TCP_TLS, "tcp-tls", args_ifc_tcp_tls, FDS_OPTS_P_OPT),
-    FDS_OPTS_NESTED(SPEC_UNIX,    "unix",    args_ifc_unix,    FDS_OPTS_P_OPT),
-    FDS_OPTS_NESTED(SPEC_FILE,    "file",    args_ifc_file,    FDS_OPTS_P_OPT),
+    FDS_OPTS_NESTED(SPEC_TCP,     "tcp",     args_ifc_tcp,     FDS_OPTS_P_OPT | FDS_OPTS_P_MULTI),
+    FDS_OPTS_NESTED(SPEC_TCP_TLS, "tcp-tls", args_ifc_tcp_tls, FDS_OPTS_P_OPT | FDS_OPTS_P_MULTI),
+    FDS_OPTS_NESTED(SPEC_UNIX,    "unix",    args_ifc_unix,    FDS_OPTS_P_OPT | FDS_OPTS_P_MULTI),
+    FDS_OPTS_NESTED(SPEC_FILE,    "file",    args_ifc_file,    FDS_OPTS_P_OPT | FDS_OPTS_P_MULTI),
     FDS_OPTS_END
 };
 
@@ -210,7 +225,7 @@ static const struct fds_xml_args args_trap_common[] = {
 /** Definition of the \<params\> node  */
 static const struct fds_xml_args args_params[] = {
     FDS_OPTS_ROOT("params"),
-    FDS_OPTS_ELEM(NODE_UNIREC_FMT,     "uniRecFormat",  FDS_OPTS_T_STRING, 0),
+    FDS_OPTS_ELEM(NODE_UNIREC_FMT,     "uniRecFormat",  FDS_OPTS_T_STRING, FDS_OPTS_P_MULTI),
     FDS_OPTS_ELEM(NODE_BIFLOW_SPLIT,   "splitBiflow",   FDS_OPTS_T_BOOL,   FDS_OPTS_P_OPT),
     FDS_OPTS_ELEM(NODE_MAPPING_FILE,   "mappingFile",   FDS_OPTS_T_STRING, FDS_OPTS_P_OPT),
     FDS_OPTS_NESTED(NODE_TRAP_COMMON,  "trapIfcCommon", args_trap_common,  FDS_OPTS_P_OPT),
@@ -415,13 +430,13 @@ cfg_parse_common(ipx_ctx_t *ctx, fds_xml_ctx_t *root, struct ifc_common *common)
  * \brief Process \<tcp\> or \<tcp-tls\> node
  * \param[in] ctx  Instance context (just for log)
  * \param[in] root XML context to process
- * \param[in] cfg  Parsed configuration (will be updated)
+ * \param[out] spec TRAP interface specification
  * \param[in] type Type of the node (::SPEC_TCP or ::SPEC_TCP_TLS)
  * \return #IPX_OK on success
  * \return #IPX_ERR_FORMAT or #IPX_ERR_NOMEM in case of failure
  */
 static int
-cfg_parse_tcp(ipx_ctx_t *ctx, fds_xml_ctx_t *root, struct conf_params *cfg, enum params_xml_nodes type)
+cfg_parse_tcp(ipx_ctx_t *ctx, fds_xml_ctx_t *root, char **spec, enum params_xml_nodes type)
 {
     assert(type == SPEC_TCP || type == SPEC_TCP_TLS);
 
@@ -496,7 +511,7 @@ cfg_parse_tcp(ipx_ctx_t *ctx, fds_xml_ctx_t *root, struct conf_params *cfg, enum
     }
 
     free(file_ca); free(file_cert); free(file_key);
-    cfg->trap_ifc_spec = res;
+    *spec = res;
     return IPX_OK;
 }
 
@@ -504,12 +519,12 @@ cfg_parse_tcp(ipx_ctx_t *ctx, fds_xml_ctx_t *root, struct conf_params *cfg, enum
  * \brief Process \<unix\> node
  * \param[in] ctx  Instance context (just for log)
  * \param[in] root XML context to process
- * \param[in] cfg  Parsed configuration (will be updated)
+ * \param[out] spec TRAP interface specification
  * \return #IPX_OK on success
  * \return #IPX_ERR_FORMAT or #IPX_ERR_NOMEM in case of failure
  */
 static int
-cfg_parse_unix(ipx_ctx_t *ctx, fds_xml_ctx_t *root, struct conf_params *cfg)
+cfg_parse_unix(ipx_ctx_t *ctx, fds_xml_ctx_t *root, char **spec)
 {
     // Default parameters
     char *name = NULL;
@@ -557,7 +572,7 @@ cfg_parse_unix(ipx_ctx_t *ctx, fds_xml_ctx_t *root, struct conf_params *cfg)
     }
 
     free(name);
-    cfg->trap_ifc_spec = res;
+    *spec = res;
     return IPX_OK;
 }
 
@@ -565,12 +580,12 @@ cfg_parse_unix(ipx_ctx_t *ctx, fds_xml_ctx_t *root, struct conf_params *cfg)
  * \brief Process \<file\> node
  * \param[in] ctx  Instance context (just for log)
  * \param[in] root XML context to process
- * \param[in] cfg  Parsed configuration (will be updated)
+ * \param[out] spec TRAP interface specification
  * \return #IPX_OK on success
  * \return #IPX_ERR_FORMAT or #IPX_ERR_NOMEM in case of failure
  */
 static int
-cfg_parse_file(ipx_ctx_t *ctx, fds_xml_ctx_t *root, struct conf_params *cfg)
+cfg_parse_file(ipx_ctx_t *ctx, fds_xml_ctx_t *root, char **spec)
 {
     // Default parameters
     char *name = NULL;
@@ -645,65 +660,64 @@ cfg_parse_file(ipx_ctx_t *ctx, fds_xml_ctx_t *root, struct conf_params *cfg)
     }
 
     free(name);
-    cfg->trap_ifc_spec = res;
+    *spec = res;
     return IPX_OK;
 }
 
 /**
  * \brief Process \<trapIfcSpec\> node
  *
- * The function processes the particular XML node and defined TRAP interface specification.
+ * The function processes the particular XML node and adds defined TRAP interface
+ * specifications to the list.
  * \param[in] ctx  Instance context (just for log)
  * \param[in] root XML context to process
- * \param[in] cfg  Parsed configuration (will be updated)
+ * \param[in] ifcs List of interfaces (will be updated)
  * \return #IPX_OK on success
  * \return #IPX_ERR_FORMAT or #IPX_ERR_NOMEM in case of failure
  */
 static int
-cfg_parse_spec(ipx_ctx_t *ctx, fds_xml_ctx_t *root, struct conf_params *cfg)
+cfg_parse_spec(ipx_ctx_t *ctx, fds_xml_ctx_t *root, struct ifc_list *ifcs)
 {
-    int cnt = 0;
+    const size_t cnt_orig = ifcs->cnt;
 
     const struct fds_xml_cont *content;
     while (fds_xml_next(root, &content) != FDS_EOC) {
         int rc;
-        if (cnt > 0) {
-            IPX_CTX_ERROR(ctx, "Multiple TRAP outputs are not supported!", '\0');
+        if (ifcs->cnt == MAX_OUTPUTS) {
+            IPX_CTX_ERROR(ctx, "Too many TRAP outputs (max. %d)!", MAX_OUTPUTS);
             return IPX_ERR_FORMAT;
         }
 
+        char **spec = &ifcs->specs[ifcs->cnt];
+        assert(content->type == FDS_OPTS_T_CONTEXT);
         switch (content->id) {
         case SPEC_TCP:
         case SPEC_TCP_TLS:
             // TCP or TCP-TLS interface
-            assert(content->type == FDS_OPTS_T_CONTEXT);
-            if ((rc = cfg_parse_tcp(ctx, content->ptr_ctx, cfg, content->id)) != IPX_OK) {
-                return rc;
-            }
+            rc = cfg_parse_tcp(ctx, content->ptr_ctx, spec, content->id);
             break;
         case SPEC_UNIX:
             // UNIX
-            assert(content->type == FDS_OPTS_T_CONTEXT);
-            if ((rc = cfg_parse_unix(ctx, content->ptr_ctx, cfg)) != IPX_OK) {
-                return rc;
-            }
+            rc = cfg_parse_unix(ctx, content->ptr_ctx, spec);
             break;
         case SPEC_FILE:
             // File
-            assert(content->type == FDS_OPTS_T_CONTEXT);
-            if ((rc = cfg_parse_file(ctx, content->ptr_ctx, cfg)) != IPX_OK) {
-                return rc;
-            }
+            rc = cfg_parse_file(ctx, content->ptr_ctx, spec);
             break;
         default:
             // Internal error
             assert(false);
+            rc = IPX_ERR_FORMAT;
         }
 
-        cnt++;
+        if (rc != IPX_OK) {
+            return rc;
+        }
+
+        ifcs->cnt++;
     }
 
-    if (cnt == 0) {
+    if (ifcs->cnt == cnt_orig) {
         IPX_CTX_ERROR(ctx, "TRAP interface is not specified!", '\0');
         return IPX_ERR_FORMAT;
     }
@@ -712,20 +726,18 @@ cfg_parse_spec(ipx_ctx_t *ctx, fds_xml_ctx_t *root, struct conf_params *cfg)
 }
 
 /**
- * \brief Add common TRAP parameters to the TRAP interface specification
+ * \brief Add common TRAP parameters to a TRAP interface specification
  *
- * \warning The interface string MUST be already specified!
- * \param[in] ctx    Instance context (just for log)
- * \param[in] cfg    Parsed configuration (will be updated)
- * \param[in] common Common TRAP parameters
+ * \param[in]     ctx    Instance context (just for log)
+ * \param[in,out] ptr    Interface specification (will be updated)
+ * \param[in]     common Common TRAP parameters
  * \return #IPX_OK on success
  * \return #IPX_ERR_NOMEM in case of failure
  */
 static int
-cfg_add_ifc_common(ipx_ctx_t *ctx, struct conf_params *cfg, const struct ifc_common *common)
+cfg_add_ifc_common(ipx_ctx_t *ctx, char **ptr, const struct ifc_common *common)
 {
     int rc;
-    char **ptr = &cfg->trap_ifc_spec;
     assert((*ptr) != NULL);
 
     // Add buffer parameter
@@ -769,6 +781,67 @@ cfg_add_ifc_common(ipx_ctx_t *ctx, struct conf_params *cfg, const struct ifc_com
     return IPX_OK;
 }
 
+/**
+ * \brief Create the TRAP interface specification string of all interfaces
+ *
+ * Common TRAP parameters are added to each interface and the interfaces are separated by commas.
+ * \param[in] ctx    Instance context (just for log)
+ * \param[in] cfg    Parsed configuration (will be updated)
+ * \param[in] ifcs   List of interfaces
+ * \param[in] common Common TRAP parameters
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_NOMEM in case of failure
+ */
+static int
+cfg_build_ifc_spec(ipx_ctx_t *ctx, struct conf_params *cfg, struct ifc_list *ifcs,
+    const struct ifc_common *common)
+{
+    int rc;
+
+    for (size_t i = 0; i < ifcs->cnt; ++i) {
+        if ((rc = cfg_add_ifc_common(ctx, &ifcs->specs[i], common)) != IPX_OK) {
+            return rc;
+        }
+
+        if (cfg_str_append(&cfg->trap_ifc_spec, "%s%s", (i > 0) ? "," : "", ifcs->specs[i])
+                != IPX_OK) {
+            IPX_CTX_ERROR(ctx, "Unable to allocate memory (%s:%d)", __FILE__, __LINE__);
+            return IPX_ERR_NOMEM;
+        }
+    }
+
+    cfg->trap_ifc_cnt = ifcs->cnt;
+    return IPX_OK;
+}
+
+/**
+ * \brief Add a UniRec template
+ * \param[in] ctx  Instance context (just for log)
+ * \param[in] cfg  Parsed configuration (will be updated)
+ * \param[in] raw  UniRec template specification (with question marks)
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_FORMAT or #IPX_ERR_NOMEM in case of failure
+ */
+static int
+cfg_add_unirec(ipx_ctx_t *ctx, struct conf_params *cfg, const char *raw)
+{
+    if (cfg->unirec_cnt == MAX_OUTPUTS) {
+        IPX_CTX_ERROR(ctx, "Too many UniRec formats (max. %d)!", MAX_OUTPUTS);
+        return IPX_ERR_FORMAT;
+    }
+
+    const size_t idx = cfg->unirec_cnt;
+    cfg->unirec_fmt[idx] = cfg_ur_tmplt_sanitize(raw);
+    cfg->unirec_spec[idx] = cfg_str_sanitize(raw);
+    cfg->unirec_cnt++;
+    if (cfg->unirec_fmt[idx] == NULL || cfg->unirec_spec[idx] == NULL) {
+        IPX_CTX_ERROR(ctx, "Unable to allocate memory (%s:%d)", __FILE__, __LINE__);
+        return IPX_ERR_NOMEM;
+    }
+
+    return IPX_OK;
+}
+
 /**
  * \brief Process \<params\> node
  *
@@ -794,6 +867,18 @@ cfg_parse_params(ipx_ctx_t *ctx, fds_xml_ctx_t *root, struct conf_params *cfg)
         return rc;
     }
 
+    // Storage of UniRec formats
+    cfg->unirec_fmt = calloc(MAX_OUTPUTS, sizeof(*cfg->unirec_fmt));
+    cfg->unirec_spec = calloc(MAX_OUTPUTS, sizeof(*cfg->unirec_spec));
+    if (!cfg->unirec_fmt || !cfg->unirec_spec) {
+        IPX_CTX_ERROR(ctx, "Unable to allocate memory (%s:%d)", __FILE__, __LINE__);
+        return IPX_ERR_NOMEM;
+    }
+
+    // Specifications of TRAP interfaces (common parameters are added at the end)
+    struct ifc_list ifcs;
+    ifcs.cnt = 0;
+
     // Set default TRAP common parameters
     struct ifc_common common;
     common.autoflush = DEF_IFC_AUTOFLUSH;
@@ -801,18 +886,14 @@ cfg_parse_params(ipx_ctx_t *ctx, fds_xml_ctx_t *root, struct conf_params *cfg)
     common.timeout =   DEF_IFC_TIMEOUT;
 
     // Parse configuration
+    rc = IPX_OK;
     const struct fds_xml_cont *content;
-    while (fds_xml_next(root, &content) != FDS_EOC) {
+    while (rc == IPX_OK && fds_xml_next(root, &content) != FDS_EOC) {
         switch (content->id) {
         case NODE_UNIREC_FMT:
             // UniRec output format
             assert(content->type == FDS_OPTS_T_STRING);
-            cfg->unirec_fmt = cfg_ur_tmplt_sanitize(content->ptr_string);
-            cfg->unirec_spec = cfg_str_sanitize(content->ptr_string);
-            if (cfg->unirec_fmt == NULL || cfg->unirec_spec == NULL) {
-                IPX_CTX_ERROR(ctx, "Unable to allocate memory (%s:%d)", __FILE__, __LINE__);
-                return IPX_ERR_NOMEM;
-            }
+            rc = cfg_add_unirec(ctx, cfg, content->ptr_string);
             break;
         case NODE_BIFLOW_SPLIT:
             // Split biflow
@@ -826,22 +907,18 @@ cfg_parse_params(ipx_ctx_t *ctx, fds_xml_ctx_t *root, struct conf_params *cfg)
             cfg->mapping_file = strdup(content->ptr_string);
             if (cfg->mapping_file == NULL) {
                 IPX_CTX_ERROR(ctx, "Unable to allocate memory (%s:%d)", __FILE__, __LINE__);
-                return IPX_ERR_NOMEM;
+                rc = IPX_ERR_NOMEM;
             }
             break;
         case NODE_TRAP_SPEC:
             // TRAP output interface specifier
             assert(content->type == FDS_OPTS_T_CONTEXT);
-            if ((rc = cfg_parse_spec(ctx, content->ptr_ctx, cfg)) != IPX_OK) {
-                return rc;
-            }
+            rc = cfg_parse_spec(ctx, content->ptr_ctx, &ifcs);
             break;
         case NODE_TRAP_COMMON:
             // TRAP common interface parameters
             assert(content->type == FDS_OPTS_T_CONTEXT);
-            if ((rc = cfg_parse_common(ctx, content->ptr_ctx, &common)) != IPX_OK) {
-                return rc;
-            }
+            rc = cfg_parse_common(ctx, content->ptr_ctx, &common);
             break;
         default:
             // Internal error
@@ -849,12 +926,16 @@ cfg_parse_params(ipx_ctx_t *ctx, fds_xml_ctx_t *root, struct conf_params *cfg)
         }
     }
 
-    // Add TRAP common parameters
-    if ((rc = cfg_add_ifc_common(ctx, cfg, &common)) != IPX_OK) {
-        return rc;
+    // Add TRAP common parameters and join the interfaces
+    if (rc == IPX_OK) {
+        rc = cfg_build_ifc_spec(ctx, cfg, &ifcs, &common);
     }
 
-    return IPX_OK;
+    for (size_t i = 0; i < ifcs.cnt; ++i) {
+        free(ifcs.specs[i]);
+    }
+
+    return rc;
 }
 
 /**
@@ -874,12 +955,25 @@ cfg_validate(ipx_ctx_t *ctx, const struct conf_params *cfg)
         rc = IPX_ERR_FORMAT;
     }
 
-    if (!cfg->unirec_fmt || strlen(cfg->unirec_fmt) == 0
-        || !cfg->unirec_spec || strlen(cfg->unirec_spec) == 0) {
+    if (cfg->unirec_cnt == 0) {
         IPX_CTX_ERROR(ctx, "UniRec template is not specified!", '\0');
         rc = IPX_ERR_FORMAT;
     }
 
+    for (size_t i = 0; i < cfg->unirec_cnt; ++i) {
+        if (strlen(cfg->unirec_fmt[i]) == 0 || strlen(cfg->unirec_spec[i]) == 0) {
+            IPX_CTX_ERROR(ctx, "UniRec template is not specified!", '\0');
+            rc = IPX_ERR_FORMAT;
+            break;
+        }
+    }
+
+    if (rc == IPX_OK && cfg->unirec_cnt != cfg->trap_ifc_cnt) {
+        IPX_CTX_ERROR(ctx, "The number of UniRec templates (%zu) and TRAP interfaces (%zu) "
+            "must be the same!", cfg->unirec_cnt, cfg->trap_ifc_cnt);
+        rc = IPX_ERR_FORMAT;
+    }
+
     return rc;
 }
 
@@ -944,6 +1038,10 @@ configuration_free(struct conf_params *cfg)
 
     free(cfg->mapping_file);
     free(cfg->trap_ifc_spec);
+    for (size_t i = 0; i < cfg->unirec_cnt; ++i) {
+        free(cfg->unirec_fmt[i]);
+        free(cfg->unirec_spec[i]);
+    }
     free(cfg->unirec_fmt);
     free(cfg->unirec_spec);
     free(cfg);
@@ -48,19 +48,23 @@
 struct conf_params {
     /** Path to IPFIX-to-UniRec mapping file                                                 */
     char *mapping_file;
-    /** Prepared TRAP interface specification string                                         */
+    /** Prepared TRAP interface specification string (interfaces are separated by commas)    */
     char *trap_ifc_spec;
+    /** Number of TRAP output interfaces                                                     */
+    size_t trap_ifc_cnt;
     /**
-     * TRAP interface UniRec template
+     * TRAP interface UniRec templates (the N-th template belongs to the N-th interface)
      *
      * Elements marked with '?' are optional and might not be filled (e.g. TCP_FLAGS)
      * For example, "DST_IP,SRC_IP,BYTES,DST_PORT,?TCP_FLAGS,SRC_PORT,PROTOCOL".
      * All fields must be contained in unirec-elements.txt
      * \note All whitespaces have been removed
      */
-    char *unirec_spec;
+    char **unirec_spec;
     /** The same as \ref conf_params.unirec_spec, however, question marks have been removed  */
-    char *unirec_fmt;
+    char **unirec_fmt;
+    /** Number of UniRec templates                                                           */
+    size_t unirec_cnt;
     /** Split biflow record to 2 unidirectional flows                                        */
     bool biflow_split;
 };
@@ -0,0 +1,352 @@
+/**
+ * \file sender.c
+ * \author agent <agent@local>
+ * \brief Background sender of UniRec records (source file)
+ */
+
+
+/* Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is, and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "sender.h"
+
+/** Number of batches (must be a power of 2)                             */
+#define SENDER_BATCHES    (8U)
+/** Size of a batch (must be able to hold at least one record)           */
+#define SENDER_BATCH_SIZE (256U * 1024U)
+/** Maximal time of sleeping of an idle thread (in milliseconds)         */
+#define SENDER_SLEEP_MS   (100U)
+
+/** Batch of UniRec records (each record is prefixed by its size)        */
+struct sender_batch {
+    /** Number of used bytes                                             */
+    size_t used;
+    /** Records                                                          */
+    uint8_t data[SENDER_BATCH_SIZE];
+};
+
+/**
+ * \brief Single-producer single-consumer queue of batches
+ *
+ * Positions only grow, the index of a batch is the position modulo #SENDER_BATCHES.
+ */
+struct sender_queue {
+    /** Position of the next batch to take (changed only by the consumer) */
+    _Atomic size_t head;
+    /** Position of the next batch to put (changed only by the producer)  */
+    _Atomic size_t tail;
+    /** Batches                                                           */
+    struct sender_batch *items[SENDER_BATCHES];
+};
+
+struct sender_s {
+    /** Plugin instance context (only for log!)                          */
+    ipx_ctx_t *ctx;
+    /** TRAP context                                                     */
+    trap_ctx_t *trap_ctx;
+    /** Index of the TRAP output interface                               */
+    unsigned int ifc;
+
+    /** Filled batches (producer: plugin, consumer: thread)              */
+    struct sender_queue full;
+    /** Empty batches (producer: thread, consumer: plugin)               */
+    struct sender_queue empty;
+    /** Batch being filled (NULL == none)                                */
+    struct sender_batch *current;
+    /** All batches                                                      */
+    struct sender_batch *batches;
+
+    /** Thread                                                           */
+    pthread_t thread;
+    /** Mutex for sleeping of the threads (not used on the fast path)    */
+    pthread_mutex_t mutex;
+    /** Notification about a new filled batch                            */
+    pthread_cond_t cond_full;
+    /** Notification about a new empty batch                             */
+    pthread_cond_t cond_empty;
+    /** The thread is waiting for a filled batch                         */
+    atomic_bool wait_full;
+    /** The plugin is waiting for an empty batch                         */
+    atomic_bool wait_empty;
+    /** Request to stop the thread                                       */
+    atomic_bool stop;
+};
+
+/**
+ * \brief Put a batch into a queue
+ * \note The queue can never be full as it has capacity for all batches.
+ */
+static inline void
+queue_put(struct sender_queue *queue, struct sender_batch *batch)
+{
+    const size_t tail = atomic_load_explicit(&queue->tail, memory_order_relaxed);
+    queue->items[tail % SENDER_BATCHES] = batch;
+    atomic_store_explicit(&queue->tail, tail + 1, memory_order_release);
+}
+
+/**
+ * \brief Take a batch from a queue
+ * \return Pointer to the batch or NULL (the queue is empty)
+ */
+static inline struct sender_batch *
+queue_take(struct sender_queue *queue)
+{
+    const size_t head = atomic_load_explicit(&queue->head, memory_order_relaxed);
+    if (head == atomic_load_explicit(&queue->tail, memory_order_acquire)) {
+        return NULL;
+    }
+
+    struct sender_batch *batch = queue->items[head % SENDER_BATCHES];
+    atomic_store_explicit(&queue->head, head + 1, memory_order_release);
+    return batch;
+}
+
+/**
+ * \brief Put a batch into a queue and wake up its consumer (if sleeping)
+ */
+static void
+sender_put(sender_t *snd, struct sender_queue *queue, struct sender_batch *batch,
+    atomic_bool *waiting, pthread_cond_t *cond)
+{
+    queue_put(queue, batch);
+    // The flag must be read after the batch is visible (see sender_take())
+    atomic_thread_fence(memory_order_seq_cst);
+    if (atomic_load(waiting)) {
+        pthread_mutex_lock(&snd->mutex);
+        pthread_cond_signal(cond);
+        pthread_mutex_unlock(&snd->mutex);
+    }
+}
+
+/**
+ * \brief Take a batch from a queue or sleep until it's available
+ *
+ * Sleeping is bounded by #SENDER_SLEEP_MS, therefore, the function can return NULL.
+ */
+static struct sender_batch *
+sender_take(sender_t *snd, struct sender_queue *queue, atomic_bool *waiting,
+    pthread_cond_t *cond)
+{
+    struct sender_batch *batch = queue_take(queue);
+    if (batch) {
+        return batch;
+    }
+
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    ts.tv_nsec += SENDER_SLEEP_MS * 1000000L;
+    if (ts.tv_nsec >= 1000000000L) {
+        ts.tv_sec++;
+        ts.tv_nsec -= 1000000000L;
+    }
+
+    pthread_mutex_lock(&snd->mutex);
+    atomic_store(waiting, true);
+    atomic_thread_fence(memory_order_seq_cst);
+    // Check again (the producer might not see the flag yet)
+    batch = queue_take(queue);
+    if (!batch && !atomic_load(&snd->stop)) {
+        pthread_cond_timedwait(cond, &snd->mutex, &ts);
+        batch = queue_take(queue);
+    }
+    atomic_store(waiting, false);
+    pthread_mutex_unlock(&snd->mutex);
+    return batch;
+}
+
+/**
+ * \brief Send all records of a batch
+ */
+static void
+sender_send(sender_t *snd, struct sender_batch *batch)
+{
+    const uint8_t *pos = batch->data;
+    const uint8_t *end = pos + batch->used;
+
+    while (pos < end) {
+        uint16_t size;
+        memcpy(&size, pos, sizeof(size));
+        pos += sizeof(size);
+
+        IPX_CTX_DEBUG(snd->ctx, "Send via TRAP IFC.");
+        trap_ctx_send(snd->trap_ctx, snd->ifc, pos, size);
+        pos += size;
+    }
+
+    batch->used = 0;
+}
+
+/**
+ * \brief Main function of the thread
+ */
+static void *
+sender_main(void *arg)
+{
+    sender_t *snd = (sender_t *) arg;
+
+    while (true) {
+        // The stop flag must be read before the last check of the queue
+        const bool stop = atomic_load(&snd->stop);
+        struct sender_batch *batch = sender_take(snd, &snd->full, &snd->wait_full,
+            &snd->cond_full);
+        if (!batch) {
+            if (stop) {
+                break;
+            }
+            continue;
+        }
+
+        sender_send(snd, batch);
+        sender_put(snd, &snd->empty, batch, &snd->wait_empty, &snd->cond_empty);
+    }
+
+    return NULL;
+}
+
+sender_t *
+sender_init(ipx_ctx_t *ctx, trap_ctx_t *trap_ctx, unsigned int ifc)
+{
+    sender_t *snd = calloc(1, sizeof(*snd));
+    if (!snd) {
+        IPX_CTX_ERROR(ctx, "Unable to allocate memory (%s:%d)", __FILE__, __LINE__);
+        return NULL;
+    }
+
+    snd->batches = malloc(SENDER_BATCHES * sizeof(*snd->batches));
+    if (!snd->batches) {
+        IPX_CTX_ERROR(ctx, "Unable to allocate memory (%s:%d)", __FILE__, __LINE__);
+        free(snd);
+        return NULL;
+    }
+
+    snd->ctx = ctx;
+    snd->trap_ctx = trap_ctx;
+    snd->ifc = ifc;
+    atomic_init(&snd->full.head, 0);
+    atomic_init(&snd->full.tail, 0);
+    atomic_init(&snd->empty.head, 0);
+    atomic_init(&snd->empty.tail, 0);
+    atomic_init(&snd->wait_full, false);
+    atomic_init(&snd->wait_empty, false);
+    atomic_init(&snd->stop, false);
+    for (size_t i = 0; i < SENDER_BATCHES; ++i) {
+        snd->batches[i].used = 0;
+        queue_put(&snd->empty, &snd->batches[i]);
+    }
+
+    if (pthread_mutex_init(&snd->mutex, NULL) != 0) {
+        IPX_CTX_ERROR(ctx, "Failed to initialize a mutex of the sender.", '\0');
+        free(snd->batches);
+        free(snd);
+        return NULL;
+    }
+
+    if (pthread_cond_init(&snd->cond_full, NULL) != 0
+            || pthread_cond_init(&snd->cond_empty, NULL) != 0) {
+        IPX_CTX_ERROR(ctx, "Failed to initialize a condition variable of the sender.", '\0');
+        pthread_mutex_destroy(&snd->mutex);
+        free(snd->batches);
+        free(snd);
+        return NULL;
+    }
+
+    int rc = pthread_create(&snd->thread, NULL, &sender_main, snd);
+    if (rc != 0) {
+        IPX_CTX_ERROR(ctx, "Failed to start a thread of the sender (pthread_create() returned "
+            "%d).", rc);
+        pthread_cond_destroy(&snd->cond_empty);
+        pthread_cond_destroy(&snd->cond_full);
+        pthread_mutex_destroy(&snd->mutex);
+        free(snd->batches);
+        free(snd);
+        return NULL;
+    }
+
+    return snd;
+}
+
+void
+sender_destroy(sender_t *snd)
+{
+    sender_flush(snd);
+
+    pthread_mutex_lock(&snd->mutex);
+    atomic_store(&snd->stop, true);
+    pthread_cond_signal(&snd->cond_full);
+    pthread_mutex_unlock(&snd->mutex);
+    pthread_join(snd->thread, NULL);
+
+    pthread_cond_destroy(&snd->cond_empty);
+    pthread_cond_destroy(&snd->cond_full);
+    pthread_mutex_destroy(&snd->mutex);
+    free(snd->batches);
+    free(snd);
+}
+
+void
+sender_flush(sender_t *snd)
+{
+    if (!snd->current || snd->current->used == 0) {
+        return;
+    }
+
+    sender_put(snd, &snd->full, snd->current, &snd->wait_full, &snd->cond_full);
+    snd->current = NULL;
+}
+
+void
+sender_add(sender_t *snd, const void *data, uint16_t size)
+{
+    const size_t rec_size = sizeof(size) + size;
+    if (snd->current && snd->current->used + rec_size > SENDER_BATCH_SIZE) {
+        sender_flush(snd);
+    }
+
+    while (!snd->current) {
+        // Wait until the thread returns a batch
+        snd->current = sender_take(snd, &snd->empty, &snd->wait_empty, &snd->cond_empty);
+    }
+
+    struct sender_batch *batch = snd->current;
+    memcpy(&batch->data[batch->used], &size, sizeof(size));
+    memcpy(&batch->data[batch->used + sizeof(size)], data, size);
+    batch->used += rec_size;
+}
@@ -0,0 +1,96 @@
+/**
+ * \file sender.h
+ * \author agent <agent@local>
+ * \brief Background sender of UniRec records (header file)
+ */
+
+
+/* Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is, and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#ifndef UR_SENDER_H
+#define UR_SENDER_H
+
+#include <stdint.h>
+#include <ipfixcol2.h>
+#include <libtrap/trap.h>
+
+/** Internal sender structure */
+typedef struct sender_s sender_t;
+
+/**
+ * \brief Create a sender of UniRec records
+ *
+ * Translated records are copied into batches that are passed to a background thread over
+ * a lock-free queue. The thread sends records via the TRAP output interface, therefore,
+ * translation of records can overlap with sending and a slow receiver doesn't block the
+ * translation (until all batches are full).
+ * \note The TRAP context MUST exist until the sender is destroyed.
+ * \param[in] ctx      Plugin instance context (only for log!)
+ * \param[in] trap_ctx TRAP context
+ * \param[in] ifc      Index of the TRAP output interface
+ * \return Pointer to the sender or NULL (an error has occurred)
+ */
+sender_t *
+sender_init(ipx_ctx_t *ctx, trap_ctx_t *trap_ctx, unsigned int ifc);
+
+/**
+ * \brief Destroy a sender
+ *
+ * All records that have been added are sent before the thread is stopped.
+ * \param[in] snd Sender
+ */
+void
+sender_destroy(sender_t *snd);
+
+/**
+ * \brief Add a UniRec record to send
+ *
+ * The record is copied into the current batch. Full batches are passed to the thread
+ * automatically. If all batches are in use, the function waits until one of them is sent.
+ * \param[in] snd  Sender
+ * \param[in] data UniRec record
+ * \param[in] size Size of the record
+ */
+void
+sender_add(sender_t *snd, const void *data, uint16_t size);
+
+/**
+ * \brief Pass the current batch (if not empty) to the thread
+ * \param[in] snd Sender
+ */
+void
+sender_flush(sender_t *snd);
+
+#endif // UR_SENDER_H
@@ -97,6 +97,62 @@ struct translator_rec {
     translator_func func;
 };
 
+/** Number of cached translation plans (must be a power of two)         */
+#define TRANSLATOR_PLANS 64U
+
+/** Conversion of an IPFIX field at a fixed position in records         */
+struct translator_step {
+    /** Index of the field in the template (see translator_plan_fields()) */
+    uint16_t field_idx;
+    /** Offset of the field in the record                               */
+    uint16_t offset;
+    /** Size of the field                                               */
+    uint16_t size;
+    /** Conversion definition                                           */
+    const struct translator_rec *def;
+};
+
+/**
+ * \brief Translation plan of an IPFIX (Options) Template
+ *
+ * The plan describes conversions of all fields of records of the template (iterated with
+ * the given flags), therefore, the conversion table doesn't have to be searched for each field
+ * of each record.
+ */
+struct translator_plan {
+    /** IPFIX (Options) Template (NULL, if the plan is not valid)       */
+    const struct fds_template *tmplt;
+    /** Flags of the record iterator                                    */
+    uint16_t flags;
+    /**
+     * Copy of the raw template
+     * \note The template can be freed and another one can be allocated at the same address.
+     *   Therefore, the template is compared once per IPFIX Message before the plan is used.
+     */
+    uint8_t *raw;
+    /** Size of the raw template                                        */
+    uint16_t raw_len;
+    /** IPFIX Message in which the template has been compared           */
+    uint64_t checked;
+
+    /** All fields are at fixed positions (i.e. only steps are used)    */
+    bool fixed;
+    /**
+     * Records of the template can never be translated, i.e. a required UniRec field is not
+     * filled by any field of the template (known only for templates without basicLists)
+     */
+    bool reject;
+    /** Conversions of fields at fixed positions (only if fixed)        */
+    struct translator_step *steps;
+    /** Number of steps                                                 */
+    uint16_t steps_cnt;
+    /**
+     * Conversion definitions of fields indexed by position in the template (NULL, if the field
+     * is not converted or it's a basicList, whose definition depends on the record)
+     */
+    const struct translator_rec **defs;
+};
+
 /** Internal structure of IPFIX to Unirec translator                    */
 struct translator_s {
     /** Instance context (only for log!)                                */
@@ -139,8 +195,13 @@ struct translator_s {
     struct {
         /** IPFIX Message header                                        */
         const struct fds_ipfix_msg_hdr *hdr;
+        /** Number of processed IPFIX Messages                          */
+        uint64_t cnt;
     } msg_context; /**< IPFIX context of the record to translate        */
 
+    /** Cache of translation plans (indexed by hash of the template)    */
+    struct translator_plan plans[TRANSLATOR_PLANS];
+
     struct {
         /* Following structures contains converters that takes data
          * from an IPFIX Message header (i.e. not from a record!)
@@ -1601,6 +1662,237 @@ translator_call_internals(translator_t *trans)
     return converted_fields;
 }
 
+/**
+ * \brief Find a conversion definition of an IPFIX field
+ * \param[in] trans Internal translator structure
+ * \param[in] field IPFIX field
+ * \return Pointer to the definition or NULL (not converted or malformed basicList)
+ */
+static const struct translator_rec *
+translator_find(const translator_t *trans, const struct fds_drec_field *field)
+{
+    const struct fds_tfield *info = field->info;
+    struct translator_rec key;
+    struct tr_ipfix_s ipx_list_elem;
+
+    key.ipfix.id = info->id;
+    key.ipfix.pen = info->en;
+    key.ipfix.next = NULL;
+
+    if (info->def && info->def->data_type == FDS_ET_BASIC_LIST) {
+        struct fds_blist_iter list_it;
+
+        fds_blist_iter_init(&list_it, (struct fds_drec_field *) field, NULL);
+        if (fds_blist_iter_next(&list_it) == FDS_ERR_FORMAT) {
+            return NULL;
+        }
+        const struct fds_tfield *tmp = list_it.field.info;
+        ipx_list_elem.id = tmp->id;
+        ipx_list_elem.pen = tmp->en;
+        ipx_list_elem.next = NULL;
+
+        key.ipfix.next = &ipx_list_elem;
+    }
+
+    return bsearch(&key, trans->table.recs, trans->table.size, sizeof(*trans->table.recs),
+        translator_cmp);
+}
+
+/**
+ * \brief Convert an IPFIX field to a UniRec field
+ * \param[in] trans Internal translator structure
+ * \param[in] def   Conversion definition
+ * \param[in] field IPFIX field
+ * \return Number of filled UniRec fields (i.e. 0 or 1)
+ */
+static inline int
+translator_convert(translator_t *trans, const struct translator_rec *def,
+    const struct fds_drec_field *field)
+{
+    int field_idx = def->unirec.req_idx;
+    if (def->func(trans, def, field) != 0) {
+        IPX_CTX_WARNING(trans->ctx, "Failed to convert an IPFIX IE (PEN: %" PRIu32 ", "
+            "ID: %" PRIu16 ") to UniRec field '%s'",
+            field->info->en, field->info->id, trans->progress.req_names[field_idx]);
+        return 0;
+    }
+
+    trans->progress.req_fields[field_idx] = 0; // Clear the "flag"
+    return 1;
+}
+
+/**
+ * \brief Get fields of a template in the order used by the record iterator
+ * \param[in] tmplt IPFIX (Options) Template
+ * \param[in] flags Flags of the record iterator
+ * \return Array of fields
+ */
+static inline const struct fds_tfield *
+translator_plan_fields(const struct fds_template *tmplt, uint16_t flags)
+{
+    if ((flags & FDS_DREC_BIFLOW_REV) != 0 && tmplt->fields_rev != NULL) {
+        return tmplt->fields_rev;
+    }
+
+    return tmplt->fields;
+}
+
+/**
+ * \brief Invalidate a translation plan and free its resources
+ * \param[in] plan Translation plan
+ */
+static void
+translator_plan_clear(struct translator_plan *plan)
+{
+    free(plan->raw);
+    free(plan->steps);
+    free(plan->defs);
+    memset(plan, 0, sizeof(*plan));
+}
+
+/**
+ * \brief Check whether all required UniRec fields can be filled by a translation plan
+ * \param[in] trans      Internal translator structure
+ * \param[in] plan       Translation plan (without basicLists)
+ * \param[in] fields_cnt Number of fields of the template
+ * \return True or false
+ */
+static bool
+translator_plan_complete(const translator_t *trans, const struct translator_plan *plan,
+    uint16_t fields_cnt)
+{
+    for (size_t i = 0; i < trans->progress.size; ++i) {
+        if (trans->progress.req_tmplt[i] == 0) {
+            // Optional field
+            continue;
+        }
+
+        if (trans->extra_conv.lbf.en && trans->extra_conv.lbf.req_idx == (int) i) {
+            // Filled by an internal converter
+            continue;
+        }
+
+        bool found = false;
+        for (uint16_t idx = 0; idx < fields_cnt && !found; ++idx) {
+            found = plan->defs[idx] && plan->defs[idx]->unirec.req_idx == (int) i;
+        }
+
+        if (!found) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * \brief Build a translation plan of the template of a record
+ *
+ * The record is iterated with the given flags (the same way as during translation of records
+ * without a plan) and the conversion definition of each field is searched only once. If all
+ * fields have fixed length, the plan consists only of steps with positions of the fields.
+ * \param[in]  trans Internal translator structure
+ * \param[out] plan  Translation plan to fill (previous content is freed)
+ * \param[in]  rec   IPFIX record
+ * \param[in]  flags Flags of the record iterator
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_NOMEM on memory allocation error (the plan is not valid)
+ */
+static int
+translator_plan_build(translator_t *trans, struct translator_plan *plan, struct fds_drec *rec,
+    uint16_t flags)
+{
+    const struct fds_template *tmplt = rec->tmplt;
+    const uint16_t fields_cnt = tmplt->fields_cnt_total;
+
+    translator_plan_clear(plan);
+    plan->raw = malloc(tmplt->raw.length);
+    plan->steps = malloc(fields_cnt * sizeof(*plan->steps));
+    plan->defs = calloc(fields_cnt, sizeof(*plan->defs));
+    if (!plan->raw || (fields_cnt > 0 && (!plan->steps || !plan->defs))) {
+        IPX_CTX_ERROR(trans->ctx, "Unable to allocate memory (%s:%d)", __FILE__, __LINE__);
+        translator_plan_clear(plan);
+        return IPX_ERR_NOMEM;
+    }
+
+    memcpy(plan->raw, tmplt->raw.data, tmplt->raw.length);
+    plan->raw_len = tmplt->raw.length;
+    plan->fixed = (tmplt->flags & FDS_TEMPLATE_DYNAMIC) == 0;
+
+    const struct fds_tfield *fields = translator_plan_fields(tmplt, flags);
+    bool has_list = false;
+    struct fds_drec_iter it;
+    fds_drec_iter_init(&it, rec, flags);
+
+    while (fds_drec_iter_next(&it) != FDS_EOC) {
+        const struct fds_tfield *info = it.field.info;
+        const uint16_t field_idx = (uint16_t) (info - fields);
+        assert(field_idx < fields_cnt);
+
+        if (info->def && info->def->data_type == FDS_ET_BASIC_LIST) {
+            // The definition depends on the content of the list
+            plan->fixed = false;
+            has_list = true;
+            continue;
+        }
+
+        const struct translator_rec *def = translator_find(trans, &it.field);
+        plan->defs[field_idx] = def;
+        if (!def) {
+            continue;
+        }
+
+        struct translator_step *step = &plan->steps[plan->steps_cnt++];
+        step->field_idx = field_idx;
+        step->offset = (uint16_t) (it.field.data - rec->data);
+        step->size = it.field.size;
+        step->def = def;
+    }
+
+    plan->reject = !has_list && !translator_plan_complete(trans, plan, fields_cnt);
+    plan->tmplt = tmplt;
+    plan->flags = flags;
+    plan->checked = trans->msg_context.cnt;
+    return IPX_OK;
+}
+
+/**
+ * \brief Get a translation plan of the template of a record
+ *
+ * Plans are cached by the address of the template. As the template can be freed and another one
+ * can be allocated at the same address, the template is compared to the copy in the plan once
+ * per IPFIX Message (i.e. while the template is referenced by the Message, it cannot be freed).
+ * \param[in] trans Internal translator structure
+ * \param[in] rec   IPFIX record
+ * \param[in] flags Flags of the record iterator
+ * \return Pointer to the plan or NULL (memory allocation error)
+ */
+static const struct translator_plan *
+translator_plan_get(translator_t *trans, struct fds_drec *rec, uint16_t flags)
+{
+    const struct fds_template *tmplt = rec->tmplt;
+    const size_t idx = (((uintptr_t) tmplt >> 6) + flags) & (TRANSLATOR_PLANS - 1U);
+    struct translator_plan *plan = &trans->plans[idx];
+
+    if (plan->tmplt == tmplt && plan->flags == flags) {
+        if (plan->checked == trans->msg_context.cnt) {
+            return plan;
+        }
+
+        if (plan->raw_len == tmplt->raw.length
+                && memcmp(plan->raw, tmplt->raw.data, plan->raw_len) == 0) {
+            plan->checked = trans->msg_context.cnt;
+            return plan;
+        }
+    }
+
+    if (translator_plan_build(trans, plan, rec, flags) != IPX_OK) {
+        return NULL;
+    }
+
+    return plan;
+}
+
 translator_t *
 translator_init(ipx_ctx_t *ctx, const map_t *map, const ur_template_t *tmplt, const char *tmplt_spec)
 {
@@ -1628,15 +1920,27 @@ translator_init(ipx_ctx_t *ctx, const map_t *map, const ur_template_t *tmplt, co
 void
 translator_destroy(translator_t *trans)
 {
+    for (size_t i = 0; i < TRANSLATOR_PLANS; ++i) {
+        translator_plan_clear(&trans->plans[i]);
+    }
+
     translator_destroy_table(trans);
     translator_destroy_record(trans);
     free(trans);
 }
 
+bool
+translator_accepts(translator_t *trans, struct fds_drec *ipfix_rec, uint16_t flags)
+{
+    const struct translator_plan *plan = translator_plan_get(trans, ipfix_rec, flags);
+    return !plan || !plan->reject;
+}
+
 void
 translator_set_context(translator_t *trans, const struct fds_ipfix_msg_hdr *hdr)
 {
     trans->msg_context.hdr = hdr;
+    trans->msg_context.cnt++;
 }
 
 const void *
@@ -1651,58 +1955,46 @@ translator_translate(translator_t *trans, struct fds_drec *ipfix_rec, uint16_t f
     const size_t req_fields_size = trans->progress.size * sizeof(*trans->progress.req_fields);
     memcpy(trans->progress.req_fields, trans->progress.req_tmplt, req_fields_size);
 
-    // Initialize a record iterator
-    struct fds_drec_iter it;
-    fds_drec_iter_init(&it, ipfix_rec, flags);
-
-    struct translator_rec key;
-    const struct translator_rec *def;
-    const size_t table_rec_cnt = trans->table.size;
-    const size_t table_rec_size = sizeof(*trans->table.recs);
+    // Without a plan (memory allocation error), the conversion table is searched for each field
+    const struct translator_plan *plan = translator_plan_get(trans, ipfix_rec, flags);
+    if (plan && plan->reject) {
+        IPX_CTX_INFO(trans->ctx, "Record conversion failed: required UniRec fields cannot be "
+            "filled by fields of the IPFIX template!", '\0');
+        return NULL;
+    }
 
     // First, call special internal conversion functions, if enabled
     int converted_fields = translator_call_internals(trans);
 
-    struct tr_ipfix_s ipx_list_elem;
-    // Try to convert all IPFIX fields
-    while (fds_drec_iter_next(&it) != FDS_EOC) {
-        // Find the conversion function
-        const struct fds_tfield *info = it.field.info;
-        key.ipfix.id = info->id;
-        key.ipfix.pen = info->en;
-        key.ipfix.next = NULL;
-
-        if (info->def && info->def->data_type == FDS_ET_BASIC_LIST) {
-            struct fds_blist_iter list_it;
-
-            fds_blist_iter_init(&list_it, &it.field, NULL);
-            if (fds_blist_iter_next(&list_it) == FDS_ERR_FORMAT) {
-               continue;
-            }
-            const struct fds_tfield *tmp = list_it.field.info;
-            ipx_list_elem.id = tmp->id;
-            ipx_list_elem.pen = tmp->en;
-            ipx_list_elem.next = NULL;
-
-            key.ipfix.next = &ipx_list_elem;
-        }
-
-        def = bsearch(&key, trans->table.recs, table_rec_cnt, table_rec_size, translator_cmp);
-        if (!def) {
-            // Conversion definition not found
-            continue;
+    if (plan && plan->fixed) {
+        // Single pass over fields at fixed positions
+        const struct fds_tfield *fields = translator_plan_fields(ipfix_rec->tmplt, flags);
+        for (uint16_t i = 0; i < plan->steps_cnt; ++i) {
+            const struct translator_step *step = &plan->steps[i];
+            struct fds_drec_field field;
+            field.data = ipfix_rec->data + step->offset;
+            field.size = step->size;
+            field.info = &fields[step->field_idx];
+            converted_fields += translator_convert(trans, step->def, &field);
         }
+    } else {
+        // Variable-length fields must be iterated, but definitions are known in advance
+        const struct fds_tfield *fields = translator_plan_fields(ipfix_rec->tmplt, flags);
+        struct fds_drec_iter it;
+        fds_drec_iter_init(&it, ipfix_rec, flags);
+
+        while (fds_drec_iter_next(&it) != FDS_EOC) {
+            const struct fds_tfield *info = it.field.info;
+            const bool is_list = info->def && info->def->data_type == FDS_ET_BASIC_LIST;
+            const struct translator_rec *def = (plan && !is_list)
+                ? plan->defs[info - fields] : translator_find(trans, &it.field);
+            if (!def) {
+                // Conversion definition not found
+                continue;
+            }
 
-        int field_idx = def->unirec.req_idx;
-        if (def->func(trans, def, &it.field) != 0) {
-            IPX_CTX_WARNING(trans->ctx, "Failed to convert an IPFIX IE (PEN: %" PRIu32 ", "
-                "ID: %" PRIu16 ") to UniRec field '%s'",
-                info->en, info->id, trans->progress.req_names[field_idx]);
-            continue;
+            converted_fields += translator_convert(trans, def, &it.field);
         }
-
-        trans->progress.req_fields[field_idx] = 0; // Clear the "flag"
-        converted_fields++;
     }
 
     if (converted_fields == 0) {
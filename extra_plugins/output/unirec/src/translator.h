@@ -83,6 +83,22 @@ translator_destroy(translator_t *trans);
 void
 translator_set_context(translator_t *trans, const struct fds_ipfix_msg_hdr *hdr);
 
+/**
+ * \brief Check whether records of the template of an IPFIX record can be translated
+ *
+ * Records are rejected if a required UniRec field is not filled by any field of the template.
+ * The result is based on the cached translation plan of the template, therefore, it's
+ * determined only once per template.
+ * \note If the template contains a basicList, the result is always true as the conversion
+ *   depends on the content of the record.
+ * \param[in] trans     Translator instance
+ * \param[in] ipfix_rec IPFIX record (read only!)
+ * \param[in] flags     Flags for iterator over the IPFIX record
+ * \return False, if the translation will always fail. True otherwise.
+ */
+bool
+translator_accepts(translator_t *trans, struct fds_drec *ipfix_rec, uint16_t flags);
+
 /**
  * \brief Convert a IPFIX record to an UniRec message
  * \param[in]  trans     Translator instance
@@ -47,11 +47,14 @@
 #include "translator.h"
 #include "configuration.h"
 #include "map.h"
+#include "sender.h"
 
 /** Name of TRAP context that belongs to the plugin            */
 #define PLUGIN_TRAP_NAME "IPFIXcol2-UniRec"
 /** Description of the TRAP context that belongs to the plugin */
 #define PLUGIN_TRAP_DSC  "UniRec output plugin for IPFIXcol2."
+/** Number of cached routes (must be a power of 2)              */
+#define PLUGIN_ROUTES    256U
 
 /** GLOBAL mutex shared across all plugin instances  */
 static pthread_mutex_t urp_mutex = PTHREAD_MUTEX_INITIALIZER;
@@ -81,6 +84,32 @@ IPX_API struct ipx_plugin_info ipx_plugin_info = {
     .ipx_min = "2.0.0"
 };
 
+/**
+ * \brief UniRec output (i.e. TRAP output interface with its UniRec template)
+ */
+struct conf_output {
+    /** UniRec template                      */
+    ur_template_t *ur_tmplt;
+    /** IPFIX to UniRec translator           */
+    translator_t *trans;
+    /** Background sender of UniRec records  */
+    sender_t *sender;
+};
+
+/**
+ * \brief Cached route of records of an IPFIX template
+ */
+struct conf_route {
+    /** IPFIX template (NULL == unused)      */
+    const struct fds_template *tmplt;
+    /** Template snapshot of the template    */
+    const fds_tsnapshot_t *snap;
+    /** Flags of the record iterator         */
+    uint16_t flags;
+    /** Index of the output (-1 == rejected) */
+    int output;
+};
+
 /**
  * \brief Plugin instance structure
  */
@@ -89,10 +118,12 @@ struct conf_unirec {
     struct conf_params *params;
     /** TRAP context                         */
     trap_ctx_t *trap_ctx;
-    /** UniRec template                      */
-    ur_template_t *ur_tmplt;
-    /** IPFIX to UniRec translator           */
-    translator_t *trans;
+    /** UniRec outputs                       */
+    struct conf_output *outputs;
+    /** Number of UniRec outputs             */
+    size_t outputs_cnt;
+    /** Cache of routes (indexed by hash of the template) */
+    struct conf_route routes[PLUGIN_ROUTES];
 };
 
 /**
@@ -154,10 +185,12 @@ core_initialize_inter(ipx_ctx_t *ctx, struct conf_unirec *cfg, const map_t *map)
 
     // Create a TRAP interface
     const char *ifc_spec = cfg->params->trap_ifc_spec;
+    const size_t ifc_cnt = cfg->params->trap_ifc_cnt;
     IPX_CTX_INFO(ctx, "Initialization of TRAP with IFCSPEC: '%s'.", ifc_spec);
 
     const char *instance_name = ipx_ctx_name_get(ctx);
-    cfg->trap_ctx = trap_ctx_init3(PLUGIN_TRAP_NAME, PLUGIN_TRAP_DSC, 0, 1, ifc_spec, instance_name);
+    cfg->trap_ctx = trap_ctx_init3(PLUGIN_TRAP_NAME, PLUGIN_TRAP_DSC, 0, ifc_cnt, ifc_spec,
+        instance_name);
     if (!cfg->trap_ctx) {
         IPX_CTX_ERROR(ctx, "Failed to initialize TRAP (%s:%d)", __FILE__, __LINE__);
         return IPX_ERR_NOMEM;
@@ -170,31 +203,61 @@ core_initialize_inter(ipx_ctx_t *ctx, struct conf_unirec *cfg, const map_t *map)
         return IPX_ERR_DENIED;
     }
 
-    // Create a UniRec template and set it as TRAP output template
-    const char *tmplt_str = cfg->params->unirec_fmt;
-    IPX_CTX_INFO(ctx, "Initialization of UniRec template: '%s'", tmplt_str);
-    char *err_str = NULL;
-    cfg->ur_tmplt = ur_ctx_create_output_template(cfg->trap_ctx, 0, tmplt_str, &err_str);
-    if (!cfg->ur_tmplt) {
-        IPX_CTX_ERROR(ctx, "Failed to create UniRec template '%s': '%s'", tmplt_str, err_str);
+    cfg->outputs = calloc(ifc_cnt, sizeof(*cfg->outputs));
+    if (!cfg->outputs) {
+        IPX_CTX_ERROR(ctx, "Unable to allocate memory (%s:%d)", __FILE__, __LINE__);
         trap_ctx_finalize(&cfg->trap_ctx);
-        free(err_str);
-        return IPX_ERR_DENIED;
+        return IPX_ERR_NOMEM;
     }
 
-    char *ur_tmplt_str = ur_template_string_delimiter(cfg->ur_tmplt, ',');
-    IPX_CTX_INFO(ctx, "Using the following created UniRec template: '%s'", ur_tmplt_str);
-    free(ur_tmplt_str);
+    int ret_code = IPX_OK;
+    for (size_t i = 0; i < ifc_cnt; ++i) {
+        struct conf_output *out = &cfg->outputs[i];
+
+        // Create a UniRec template and set it as TRAP output template
+        const char *tmplt_str = cfg->params->unirec_fmt[i];
+        IPX_CTX_INFO(ctx, "Initialization of UniRec template: '%s'", tmplt_str);
+        char *err_str = NULL;
+        out->ur_tmplt = ur_ctx_create_output_template(cfg->trap_ctx, i, tmplt_str, &err_str);
+        if (!out->ur_tmplt) {
+            IPX_CTX_ERROR(ctx, "Failed to create UniRec template '%s': '%s'", tmplt_str, err_str);
+            free(err_str);
+            ret_code = IPX_ERR_DENIED;
+            break;
+        }
+
+        char *ur_tmplt_str = ur_template_string_delimiter(out->ur_tmplt, ',');
+        IPX_CTX_INFO(ctx, "Using the following created UniRec template: '%s'", ur_tmplt_str);
+        free(ur_tmplt_str);
+
+        // Prepare a translator
+        const char *tmplt_spec = cfg->params->unirec_spec[i];
+        IPX_CTX_INFO(ctx, "Initialization of IPFIX to UniRec translator: '%s'", tmplt_spec );
+        out->trans = translator_init(ctx, map, out->ur_tmplt, tmplt_spec);
+        if (!out->trans) {
+            IPX_CTX_ERROR(ctx, "Failed to initialize IPFIX to UniRec translator.", '\0');
+            ret_code = IPX_ERR_DENIED;
+            break;
+        }
+
+        cfg->outputs_cnt++;
+    }
 
-    // Prepare a translator
-    const char *tmplt_spec = cfg->params->unirec_spec;
-    IPX_CTX_INFO(ctx, "Initialization of IPFIX to UniRec translator: '%s'", tmplt_spec );
-    cfg->trans = translator_init(ctx, map, cfg->ur_tmplt, tmplt_spec);
-    if (!cfg->trans) {
-        IPX_CTX_ERROR(ctx, "Failed to initialize IPFIX to UniRec translator.", '\0');
+    if (ret_code != IPX_OK) {
+        // Output templates MUST be destroyed after the TRAP ifc!
         trap_ctx_finalize(&cfg->trap_ctx);
-        ur_free_template(cfg->ur_tmplt); // Template MUST be destroyed after the TRAP ifc!
-        return IPX_ERR_DENIED;
+        for (size_t i = 0; i < ifc_cnt; ++i) {
+            if (cfg->outputs[i].trans) {
+                translator_destroy(cfg->outputs[i].trans);
+            }
+            if (cfg->outputs[i].ur_tmplt) {
+                ur_free_template(cfg->outputs[i].ur_tmplt);
+            }
+        }
+        free(cfg->outputs);
+        cfg->outputs = NULL;
+        cfg->outputs_cnt = 0;
+        return ret_code;
     }
 
     return IPX_OK;
@@ -261,9 +324,13 @@ core_destroy(ipx_ctx_t *ctx, struct conf_unirec *cfg)
     IPX_CTX_INFO(ctx, "Destructor of core components called!", '\0');
     instance_cnt--;
 
-    translator_destroy(cfg->trans);
+    for (size_t i = 0; i < cfg->outputs_cnt; ++i) {
+        translator_destroy(cfg->outputs[i].trans);
+    }
     trap_ctx_finalize(&cfg->trap_ctx);
-    ur_free_template(cfg->ur_tmplt); // Template MUST be destroyed after the TRAP ifc!
+    for (size_t i = 0; i < cfg->outputs_cnt; ++i) {
+        ur_free_template(cfg->outputs[i].ur_tmplt); // Template MUST be destroyed after the TRAP ifc!
+    }
     if (instance_cnt == 0) {
         IPX_CTX_INFO(ctx, "Removing all defined UniRec fields", '\0');
         ur_finalize();
@@ -274,9 +341,10 @@ core_destroy(ipx_ctx_t *ctx, struct conf_unirec *cfg)
             tmp,  __FILE__, __LINE__);
     }
 
-    cfg->ur_tmplt = NULL;
+    free(cfg->outputs);
+    cfg->outputs = NULL;
+    cfg->outputs_cnt = 0;
     cfg->trap_ctx = NULL;
-    cfg->trans = NULL;
 }
 
 // Output plugin initialization function
@@ -315,6 +383,23 @@ ipx_plugin_init(ipx_ctx_t *ctx, const char *params)
         return IPX_ERR_DENIED;
     }
 
+    // Start sending in the background
+    for (size_t i = 0; i < conf->outputs_cnt; ++i) {
+        conf->outputs[i].sender = sender_init(ctx, conf->trap_ctx, i);
+        if (conf->outputs[i].sender) {
+            continue;
+        }
+
+        for (size_t j = 0; j < i; ++j) {
+            sender_destroy(conf->outputs[j].sender);
+        }
+        core_destroy(ctx, conf);
+        map_destroy(conv_db);
+        configuration_free(parsed_params);
+        free(conf);
+        return IPX_ERR_DENIED;
+    }
+
     // Success
     map_destroy(conv_db); // Destroy the mapping database (we don't need it anymore)
     ipx_ctx_private_set(ctx, conf);
@@ -326,11 +411,75 @@ void
 ipx_plugin_destroy(ipx_ctx_t *ctx, void *cfg)
 {
     struct conf_unirec *conf = (struct conf_unirec *) cfg;
+    for (size_t i = 0; i < conf->outputs_cnt; ++i) {
+        // Remaining records are sent before the TRAP ifc is destroyed
+        sender_destroy(conf->outputs[i].sender);
+    }
     core_destroy(ctx, conf);
     configuration_free(conf->params);
     free(conf);
 }
 
+/**
+ * \brief Find the UniRec output of records of an IPFIX template
+ *
+ * Records are passed to the first output whose translator accepts the template (see
+ * translator_accepts()). The decision is cached per template, therefore, records of templates
+ * that cannot be translated to any output are rejected without a translation attempt.
+ * \param[in] conf  Plugin instance
+ * \param[in] rec   IPFIX record
+ * \param[in] flags Flags for iterator over the IPFIX record
+ * \return Index of the output or -1 (no output accepts the record)
+ */
+static int
+route_get(struct conf_unirec *conf, struct fds_drec *rec, uint16_t flags)
+{
+    const size_t idx = (((uintptr_t) rec->tmplt >> 6) + flags) & (PLUGIN_ROUTES - 1U);
+    struct conf_route *route = &conf->routes[idx];
+    if (route->tmplt == rec->tmplt && route->snap == rec->snap && route->flags == flags) {
+        return route->output;
+    }
+
+    route->tmplt = rec->tmplt;
+    route->snap = rec->snap;
+    route->flags = flags;
+    route->output = -1;
+    for (size_t i = 0; i < conf->outputs_cnt; ++i) {
+        if (translator_accepts(conf->outputs[i].trans, rec, flags)) {
+            route->output = (int) i;
+            break;
+        }
+    }
+
+    return route->output;
+}
+
+/**
+ * \brief Translate an IPFIX record and pass it to its UniRec output
+ * \param[in] conf  Plugin instance
+ * \param[in] rec   IPFIX record
+ * \param[in] flags Flags for iterator over the IPFIX record
+ */
+static void
+route_record(struct conf_unirec *conf, struct fds_drec *rec, uint16_t flags)
+{
+    const int output = route_get(conf, rec, flags);
+    if (output < 0) {
+        // Nothing to send
+        return;
+    }
+
+    struct conf_output *out = &conf->outputs[output];
+    uint16_t msg_size = 0;
+    const void *msg_data = translator_translate(out->trans, rec, flags, &msg_size);
+    if (!msg_data) {
+        // Nothing to send
+        return;
+    }
+
+    sender_add(out->sender, msg_data, msg_size);
+}
+
 // Pass IPFIX data with supplemental structures into the storage plugin.
 int
 ipx_plugin_process(ipx_ctx_t *ctx, void *cfg, ipx_msg_t *msg)
@@ -340,12 +489,12 @@ ipx_plugin_process(ipx_ctx_t *ctx, void *cfg, ipx_msg_t *msg)
     const bool split_enabled = conf->params->biflow_split;
     IPX_CTX_DEBUG(ctx, "Received a new message to process.");
 
-    uint16_t msg_size = 0;
-    const void *msg_data = NULL;
-
     ipx_msg_ipfix_t *ipfix = ipx_msg_base2ipfix(msg);
     const uint8_t *ipfix_raw_msg = ipx_msg_ipfix_get_packet(ipfix);
-    translator_set_context(conf->trans, (const struct fds_ipfix_msg_hdr *) ipfix_raw_msg);
+    for (size_t i = 0; i < conf->outputs_cnt; ++i) {
+        translator_set_context(conf->outputs[i].trans,
+            (const struct fds_ipfix_msg_hdr *) ipfix_raw_msg);
+    }
 
     const uint32_t rec_cnt = ipx_msg_ipfix_get_drec_cnt(ipfix);
     for (uint32_t i = 0; i < rec_cnt; i++) {
@@ -356,14 +505,7 @@ ipx_plugin_process(ipx_ctx_t *ctx, void *cfg, ipx_msg_t *msg)
 
         // Fill record (Note: in case of biflow split, forward fields only)
         uint16_t flags = biflow_split ? (FDS_DREC_BIFLOW_FWD | FDS_DREC_REVERSE_SKIP) : 0;
-        msg_data = translator_translate(conf->trans, &ipfix_rec->rec, flags, &msg_size);
-        if (!msg_data) {
-            // Nothing to send
-            continue;
-        }
-
-        IPX_CTX_DEBUG(ctx, "Send via TRAP IFC.");
-        trap_ctx_send(conf->trap_ctx, 0, msg_data, msg_size);
+        route_record(conf, &ipfix_rec->rec, flags);
 
         // Is it biflow and split is enabled? Send the reverse direction
         if (!biflow_split) {
@@ -371,16 +513,13 @@ ipx_plugin_process(ipx_ctx_t *ctx, void *cfg, ipx_msg_t *msg)
         }
 
         flags = FDS_DREC_BIFLOW_REV | FDS_DREC_REVERSE_SKIP;
-        msg_data = translator_translate(conf->trans, &ipfix_rec->rec, flags, &msg_size);
-        if (!msg_data) {
-            // Nothing to send
-            continue;
-        }
+        route_record(conf, &ipfix_rec->rec, flags);
+    }
 
-        IPX_CTX_DEBUG(ctx, "Send via TRAP IFC.");
-        trap_ctx_send(conf->trap_ctx, 0, msg_data, msg_size);
+    // Records of the message are sent in the background
+    for (size_t i = 0; i < conf->outputs_cnt; ++i) {
+        sender_flush(conf->outputs[i].sender);
     }
 
     return 0;
 }
-
@@ -77,6 +77,8 @@ enum ipx_msg_type {
     IPX_MSG_TERMINATE = (1 << 3),
     // An internal configuration message (only for internal usage)
     //IPX_MSG_CONFIG  = (1 << 4)
+    /** A batch of IPFIX messages (only for plugins with #IPX_PF_BATCH flag)         */
+    IPX_MSG_BATCH     = (1 << 5),
 };
 
 /** The data type of the base message                                               */
@@ -107,6 +109,7 @@ ipx_msg_destroy(ipx_msg_t *msg);
 #include <ipfixcol2/message_ipfix.h>
 #include <ipfixcol2/message_garbage.h>
 #include <ipfixcol2/message_session.h>
+#include <ipfixcol2/message_batch.h>
 
 /**
  * \brief Cast from a base message to a session message
@@ -147,6 +150,19 @@ ipx_msg_base2ipfix(ipx_msg_t *msg)
     return (ipx_msg_ipfix_t *) msg;
 }
 
+/**
+ * \brief Cast from a base message to a batch of IPFIX messages
+ * \param[in] msg Pointer to the base message
+ * \warning If the base message is not a batch message, the result is undefined!
+ * \return Pointer to the batch message
+ */
+static inline ipx_msg_batch_t *
+ipx_msg_base2batch(ipx_msg_t *msg)
+{
+    assert(ipx_msg_get_type(msg) == IPX_MSG_BATCH);
+    return (ipx_msg_batch_t *) msg;
+}
+
 /**@}*/
 
 #ifdef __cplusplus
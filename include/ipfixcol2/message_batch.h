@@ -0,0 +1,114 @@
+/**
+ * \file include/ipfixcol2/message_batch.h
+ * \author agent <agent@local>
+ * \brief Batch of IPFIX messages (header file)
+ * \date 2026
+ */
+
+/* Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is'', and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#ifndef IPX_MESSAGE_BATCH_H
+#define IPX_MESSAGE_BATCH_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * \defgroup ipxBatchMessage Batch of IPFIX messages
+ * \ingroup ipxGeneralMessage
+ *
+ * \brief Container of multiple IPFIX messages
+ *
+ * Multiple consecutive IPFIX messages can be passed through the pipeline at once in a single
+ * container. The container is treated as a single message, i.e. it occupies only one place in
+ * ring buffers and has only one reference counter. IPFIX messages in the batch are in the order
+ * in which they have been passed by the producer.
+ *
+ * The batch is delivered only to plugins with #IPX_PF_BATCH flag. For other plugins, the batch
+ * is automatically unpacked and its IPFIX messages are processed one by one.
+ *
+ * \remark Identification type of this message is #IPX_MSG_BATCH.
+ *
+ * @{
+ */
+
+/** \brief The type of batch message                                          */
+typedef struct ipx_msg_batch ipx_msg_batch_t;
+
+#include <ipfixcol2/message.h>
+
+/**
+ * \brief Get the number of IPFIX messages in a batch
+ * \param[in] msg Batch message
+ * \return Number of messages
+ */
+IPX_API uint32_t
+ipx_msg_batch_get_cnt(const ipx_msg_batch_t *msg);
+
+/**
+ * \brief Get an IPFIX message from a batch
+ * \warning The message is still owned by the batch, i.e. do NOT destroy it or pass it!
+ * \param[in] msg Batch message
+ * \param[in] idx Index of the IPFIX message (starts from 0)
+ * \return Pointer to the IPFIX message or NULL (the index is out of range)
+ */
+IPX_API ipx_msg_ipfix_t *
+ipx_msg_batch_get(ipx_msg_batch_t *msg, uint32_t idx);
+
+/**
+ * \brief Destroy a batch message including all its IPFIX messages
+ * \param[in] msg Batch message
+ */
+IPX_API void
+ipx_msg_batch_destroy(ipx_msg_batch_t *msg);
+
+/**
+ * \brief Cast from a batch message to a base message
+ * \param[in] msg Pointer to the batch message
+ * \return Pointer to the base message
+ */
+static inline ipx_msg_t *
+ipx_msg_batch2base(ipx_msg_batch_t *msg)
+{
+    return (ipx_msg_t *) msg;
+}
+
+/**@}*/
+
+#ifdef __cplusplus
+}
+#endif
+#endif // IPX_MESSAGE_BATCH_H
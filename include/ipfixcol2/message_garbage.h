@@ -157,6 +157,19 @@ ipx_gc_release(ipx_gc_t *gc);
 IPX_API int
 ipx_gc_add(ipx_gc_t *gc, void *data, ipx_msg_garbage_cb cb);
 
+/**
+ * \brief Move garbage of a garbage message to a container
+ *
+ * The garbage of the message is added to the container and the message itself is freed
+ * (without destroying the garbage). There are no changes in case of error.
+ * \param[in] gc  Container
+ * \param[in] msg Garbage message
+ * \return #IPX_OK on success (the message doesn't exist anymore)
+ * \return #IPX_ERR_NOMEM if a memory allocation has occurred
+ */
+IPX_API int
+ipx_gc_add_msg(ipx_gc_t *gc, ipx_msg_garbage_t *msg);
+
 /**
  * \brief Request that a container capacity be at least enough to contain N elements
  *
@@ -78,6 +78,24 @@ struct ipx_msg_ctx {
      *   For other session the value MUST be set to 0.
      */
     ipx_stream_t stream;
+    /**
+     * \brief Monotonic timestamp of reception of the message (in nanoseconds)
+     * \note
+     *   The value is set by ipx_msg_ipfix_create() if measurement of latency is enabled.
+     *   Otherwise it's always 0. Input plugins can replace a non-zero value with the time of
+     *   reception of the message by the kernel, if available (see ipx_latency_from_realtime()).
+     */
+    uint64_t ingress_ts;
+    /**
+     * \brief Generation of the Template snapshot (set by the parser)
+     * \note
+     *   The value is incremented every time the Template snapshot of the combination of
+     *   the Transport Session and ODID changes and it represents the snapshot of the last Data
+     *   Set in the message. If two consecutive messages of the same combination have the same
+     *   value, all their Data Records refer to the same Template snapshot and plugins don't
+     *   have to check for changes of (Options) Templates.
+     */
+    uint32_t snap_gen;
 };
 
 /**
@@ -90,6 +108,18 @@ struct ipx_ipfix_set {
 	 * i.e. \code{.c} uint16_t real_len = ntohs(ptr->length); \endcode
 	 */
     struct fds_ipfix_set_hdr *ptr;
+    /**
+     * Template snapshot used to parse Data Records of the Set
+     * (NULL, if the Set doesn't contain any parsed Data Records)
+     */
+    const fds_tsnapshot_t *snap;
+    /**
+     * Number of parsed Data Records in the Set
+     * \note Zero for (Options) Template Sets and Data Sets with unknown Templates.
+     * \note The number is available even if references to Data Records are not
+     *   (i.e. the collector runs in relay mode, see ipx_ctx_relay_set()).
+     */
+    uint32_t drec_cnt;
 
     // New parameters could be added here...
 };
@@ -107,6 +137,38 @@ struct ipx_ipfix_record {
     uint8_t ext[1];
 };
 
+/**
+ * \brief Strided view of a field across consecutive Data Records
+ *
+ * The view describes values of one Information Element in a run of consecutive Data Records
+ * (see ipx_msg_ipfix_get_drec()) that share the same Template and are stored back-to-back in
+ * the raw packet. The value of the i-th record of the run starts at
+ * \code{.c} col.data + i * col.stride \endcode and is \p size bytes long (network byte order).
+ *
+ * The structure also caches the position of the field in the last used Template. Therefore,
+ * it should be zeroed before the first use and reused for all records of the message (or even
+ * subsequent messages) to avoid a lookup of the field in each record.
+ */
+struct ipx_ipfix_column {
+    /** Value of the field in the first record of the run (NULL, if not available)    */
+    const uint8_t *data;
+    /** Distance between values of consecutive records of the run                     */
+    size_t stride;
+    /** Size of the value                                                               */
+    uint16_t size;
+    /** Number of records in the run                                                    */
+    uint32_t cnt;
+
+    /** Template of the cached field position (private)                                 */
+    const struct fds_template *tmplt;
+    /** Field description in the Template (private, NULL if the field is not present)  */
+    const struct fds_tfield *field;
+    /** Enterprise Number of the cached field (private)                                 */
+    uint32_t en;
+    /** Information Element ID of the cached field (private)                            */
+    uint16_t id;
+};
+
 #include "plugins.h"
 
 /**
@@ -117,6 +179,8 @@ struct ipx_ipfix_record {
  * parser. In case of NetFlow, the parser transforms message to IPFIX.
  *
  * \warning User MUST make sure that \p msg_data represents valid Message header
+ * \note The \p msg_data is released by ipx_utils_buf_free() when the wrapper is destroyed,
+ *   therefore, it should be allocated by ipx_utils_buf_alloc() (preferred) or malloc().
  * \param[in] plugin_ctx Context of the plugin
  * \param[in] msg_ctx    Message context (info about Transport Session, ODID, etc.)
  * \param[in] msg_data   Pointer to the IPFIX (or NetFlow) Message header
@@ -140,7 +204,8 @@ ipx_msg_ipfix_destroy(ipx_msg_ipfix_t *msg);
  * \warning
  * This function allow to directly access and modify the wrapped massage. It is recommended to
  * use the raw packet only read-only, because inappropriate modifications (e.g. removing/adding
- * sets/records/fields) can cause undefined behavior of API functions.
+ * sets/records/fields) can cause undefined behavior of API functions. Before any modification,
+ * ipx_msg_ipfix_writable() MUST be called.
  *
  * \note Size of the message is stored directly in the header (network byte
  *   order) i.e. \code{.c} uint16_t real_len = ntohs(header->length); \endcode
@@ -190,6 +255,251 @@ ipx_msg_ipfix_get_drec_cnt(const ipx_msg_ipfix_t *msg);
 IPX_API struct ipx_ipfix_record *
 ipx_msg_ipfix_get_drec(ipx_msg_ipfix_t *msg, uint32_t idx);
 
+/**
+ * \brief Remove references to selected Data Records from the message
+ *
+ * References to the remaining Data Records (including their extensions) are moved to the
+ * front of the array in the original order and numbers of Data Records of IPFIX Sets are
+ * updated. The raw IPFIX Message is not modified, i.e. records are only invisible to
+ * plugins that access them via ipx_msg_ipfix_get_drec().
+ * \warning Pointers to Data Records obtained before the call are not valid anymore.
+ * \param[in] msg  Message
+ * \param[in] keep Array of flags (non-zero == keep the record) of all Data Records of the message
+ *   (see ipx_msg_ipfix_get_drec_cnt())
+ * \return Number of remaining Data Records
+ */
+IPX_API uint32_t
+ipx_msg_ipfix_drec_compact(ipx_msg_ipfix_t *msg, const uint8_t *keep);
+
+/**
+ * \brief Reusable array of flags of Data Records (see ipx_msg_ipfix_drec_flags())
+ *
+ * The structure should be zeroed before the first use and released by
+ * ipx_msg_ipfix_drec_flags_free().
+ */
+struct ipx_drec_flags {
+    /** Array of flags (NULL, if not allocated yet)                                        */
+    uint8_t *data;
+    /** Number of allocated flags                                                           */
+    uint32_t alloc;
+};
+
+/**
+ * \brief Get an array of flags of all Data Records of a message
+ *
+ * Plugins that drop Data Records (e.g. filters) typically evaluate all records of the message
+ * first, store the results into the array and remove them at once by
+ * ipx_msg_ipfix_drec_compact(). The array is enlarged only if it's smaller than the number of
+ * records, i.e. it is usually reused for all messages without any allocation.
+ * \code{.c}
+ * uint8_t *keep = ipx_msg_ipfix_drec_flags(msg, &data->keep);
+ * if (!keep) {
+ *     // Memory allocation error
+ * }
+ * for (uint32_t i = 0; i < rec_cnt; ++i) {
+ *     keep[i] = ...;
+ * }
+ * ipx_msg_ipfix_drec_compact(msg, keep);
+ * \endcode
+ * \param[in]     msg   Message
+ * \param[in,out] flags Reusable array
+ * \return Pointer to the array (the content is undefined) or NULL (memory allocation error)
+ */
+IPX_API uint8_t *
+ipx_msg_ipfix_drec_flags(const ipx_msg_ipfix_t *msg, struct ipx_drec_flags *flags);
+
+/**
+ * \brief Release a reusable array of flags of Data Records
+ * \param[in] flags Array (the structure is zeroed)
+ */
+IPX_API void
+ipx_msg_ipfix_drec_flags_free(struct ipx_drec_flags *flags);
+
+/**
+ * \brief Get a strided view of a field in a run of Data Records starting at the given record
+ *
+ * The run consists of the record \p idx and all following records that share the same
+ * Template, have the same size and immediately follow each other in the raw packet (typically,
+ * records of a Data Set with a fixed-length Template). Plugins can process the whole run by
+ * a tight loop (or a vectorized kernel) instead of calling fds_drec_find() for each record.
+ * \code{.c}
+ * struct ipx_ipfix_column col = {0};
+ * for (uint32_t i = 0; i < rec_cnt; i += col.cnt) {
+ *     if (ipx_msg_ipfix_column_view(msg, i, 0, 8, &col) != IPX_OK) {
+ *         continue; // Not present or not at a fixed offset (use fds_drec_find() instead)
+ *     }
+ *     for (uint32_t j = 0; j < col.cnt; ++j) {
+ *         const uint8_t *value = col.data + j * col.stride;
+ *         ...
+ *     }
+ * }
+ * \endcode
+ * \param[in]     msg Message
+ * \param[in]     idx Index of the first record of the run
+ * \param[in]     en  Enterprise Number of the Information Element
+ * \param[in]     id  ID of the Information Element
+ * \param[in,out] col View (the cache of the field position is updated)
+ * \return #IPX_OK on success (all members of the view are filled)
+ * \return #IPX_ERR_NOTFOUND if the field is not present in the Template, it is a variable-length
+ *   field, or it follows a variable-length field (i.e. its offset is not fixed). Only the number
+ *   of records in the run is filled, so the caller can skip them.
+ * \return #IPX_ERR_ARG if the index is out of range
+ */
+IPX_API int
+ipx_msg_ipfix_column_view(ipx_msg_ipfix_t *msg, uint32_t idx, uint32_t en, uint16_t id,
+    struct ipx_ipfix_column *col);
+
+/**
+ * \brief Gather values of a field of multiple Data Records into a dense array
+ *
+ * Values of the field (in network byte order) of records \p idx ... \p idx + \p cnt - 1 are
+ * copied into the \p out array, where each value occupies exactly \p size bytes. Records that
+ * don't contain the field (or contain it with a different size) are filled with zeros.
+ * Fixed-position fields are copied using ipx_msg_ipfix_column_view(), other fields are found
+ * by fds_drec_find().
+ * \param[in]  msg     Message
+ * \param[in]  idx     Index of the first record
+ * \param[in]  cnt     Number of records (records out of range are ignored)
+ * \param[in]  en      Enterprise Number of the Information Element
+ * \param[in]  id      ID of the Information Element
+ * \param[in]  size    Size of the field
+ * \param[out] out     Array of at least \p cnt * \p size bytes
+ * \param[out] present Array of at least \p cnt flags, non-zero if the field is present
+ *   in the record (can be NULL)
+ * \return Number of records with the field
+ */
+IPX_API uint32_t
+ipx_msg_ipfix_column_gather(ipx_msg_ipfix_t *msg, uint32_t idx, uint32_t cnt, uint32_t en,
+    uint16_t id, uint16_t size, void *out, uint8_t *present);
+
+/**
+ * \brief Create a wrapper around an IPFIX Message built by a plugin and describe its content
+ *
+ * Unlike ipx_msg_ipfix_create(), references to all Sets and Data Records of the message are
+ * filled (as the parser does), so the message can be passed to other plugins immediately.
+ * (Options) Template Sets are described without a snapshot. Templates of Data Sets are looked up
+ * in the given snapshot, which must contain all of them and must stay valid as long as the
+ * message exists (e.g. it belongs to a Template manager that is destroyed using a garbage
+ * message). Generation of the snapshot (see ipx_msg_ctx::snap_gen) is not filled.
+ * \note The \p msg_data is released by ipx_utils_buf_free() when the wrapper is destroyed.
+ *   However, it's NOT released if the function fails.
+ * \param[in] plugin_ctx Context of the plugin
+ * \param[in] msg_ctx    Message context (info about Transport Session, ODID, etc.)
+ * \param[in] msg_data   Pointer to a valid IPFIX Message (the size is read from its header)
+ * \param[in] snap       Template snapshot of Data Sets in the message
+ * \return Pointer or NULL (memory allocation error, malformed Set or unknown Template)
+ */
+IPX_API ipx_msg_ipfix_t *
+ipx_msg_ipfix_wrap(const ipx_ctx_t *plugin_ctx, const struct ipx_msg_ctx *msg_ctx,
+    uint8_t *msg_data, const fds_tsnapshot_t *snap);
+
+/** Cache of plugin-specific information about Templates (see ipx_tcache_create())         */
+typedef struct ipx_tcache ipx_tcache_t;
+
+/**
+ * \brief Create a cache of plugin-specific information about Templates
+ *
+ * Plugins usually find positions of fields they are interested in only once per Template and
+ * reuse them for all Data Records of the same Template. Templates are identified by pointers,
+ * which are valid only while a message that refers to them exists. Therefore, the cache MUST be
+ * cleared by ipx_tcache_clear() at the start of each message.
+ * \param[in] rec_size Size of information stored per Template
+ * \param[in] max      Maximum number of cached Templates (0 = unlimited)
+ * \return Pointer or NULL (memory allocation error)
+ */
+IPX_API ipx_tcache_t *
+ipx_tcache_create(size_t rec_size, uint32_t max);
+
+/**
+ * \brief Destroy a cache of Templates
+ * \param[in] cache Cache
+ */
+IPX_API void
+ipx_tcache_destroy(ipx_tcache_t *cache);
+
+/**
+ * \brief Remove all Templates from the cache
+ * \param[in] cache Cache
+ */
+IPX_API void
+ipx_tcache_clear(ipx_tcache_t *cache);
+
+/**
+ * \brief Find information about a Template in the cache
+ * \param[in] cache Cache
+ * \param[in] tmplt Template
+ * \return Pointer to the information or NULL (not cached)
+ */
+IPX_API void *
+ipx_tcache_find(const ipx_tcache_t *cache, const struct fds_template *tmplt);
+
+/**
+ * \brief Add a Template to the cache
+ *
+ * The information is zeroed and the caller is expected to fill it.
+ * \warning Pointers previously returned by ipx_tcache_find() or ipx_tcache_add() are valid only
+ *   until the next call of this function.
+ * \param[in] cache Cache
+ * \param[in] tmplt Template (MUST NOT be already cached)
+ * \return Pointer to the information or NULL (the cache is full or memory allocation error)
+ */
+IPX_API void *
+ipx_tcache_add(ipx_tcache_t *cache, const struct fds_template *tmplt);
+
+/**
+ * \brief Get the branch of the pipeline the message belongs to
+ *
+ * IPFIX Messages created by input plugins (and most of intermediate plugins) belong to the main
+ * branch (0). Other branches are created by ipx_msg_ipfix_branch_create(), e.g. by the branch
+ * intermediate plugin, so the same parsed message can be processed differently for different
+ * output instances. Intermediate and output instances can be restricted to a single branch.
+ * \param[in] msg Message
+ * \return Identification of the branch
+ */
+IPX_API uint16_t
+ipx_msg_ipfix_branch_get(const ipx_msg_ipfix_t *msg);
+
+/**
+ * \brief Change the branch of the pipeline the message belongs to
+ *
+ * Intermediate plugins which create new IPFIX Messages from received ones should keep
+ * the branch of the original messages.
+ * \param[in] msg    Message
+ * \param[in] branch Identification of the branch
+ */
+IPX_API void
+ipx_msg_ipfix_branch_set(ipx_msg_ipfix_t *msg, uint16_t branch);
+
+/**
+ * \brief Create a copy-on-write branch of an IPFIX Message
+ *
+ * The new message shares the raw packet with the original message, i.e. only the description
+ * of Sets and Data Records (including extensions) is copied. Both messages can be passed and
+ * processed independently. Plugins that want to modify the raw packet (e.g. Data Records) of
+ * a message MUST call ipx_msg_ipfix_writable() first.
+ * \param[in] msg    Original message (the raw packet becomes shared)
+ * \param[in] branch Branch of the new message
+ * \return Pointer to the new message or NULL (memory allocation error)
+ */
+IPX_API ipx_msg_ipfix_t *
+ipx_msg_ipfix_branch_create(ipx_msg_ipfix_t *msg, uint16_t branch);
+
+/**
+ * \brief Make the raw packet of the message modifiable
+ *
+ * If the raw packet is shared with another branch of the message (see
+ * ipx_msg_ipfix_branch_create()), it is copied and references to Sets and Data Records are
+ * moved to the copy. Otherwise, nothing happens. Plugins that modify the raw packet (or Data
+ * Records) in place MUST call this function before the first modification.
+ * \warning Pointers to the raw packet, Sets and Data Records obtained before the call are not
+ *   valid anymore.
+ * \param[in] msg Message
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_NOMEM in case of a memory allocation error (the packet is still shared)
+ */
+IPX_API int
+ipx_msg_ipfix_writable(ipx_msg_ipfix_t *msg);
+
 /**
  * \brief Cast from a source session message to a base message
  * \param[in] msg Pointer to the session message
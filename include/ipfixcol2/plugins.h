@@ -150,6 +150,36 @@ typedef struct ipx_ctx_ext ipx_ctx_ext_t;
  */
 #define IPX_PF_DEEPBIND 1U
 
+/**
+ * \def IPX_PF_BATCH
+ * \brief The plugin is able to process batches of IPFIX Messages at once
+ *
+ * Multiple consecutive IPFIX Messages can be passed through the pipeline in a single container
+ * (see ::IPX_MSG_BATCH) which reduces overhead of ring buffers and reference counting. If this
+ * flag is set, the processing callback of an intermediate or an output plugin subscribed to
+ * IPFIX Messages might also receive batches. Batches are always unpacked for plugins without
+ * this flag, i.e. they keep getting single IPFIX Messages.
+ *
+ * \note An intermediate plugin MUST either pass the batch or destroy it (including all its
+ *   IPFIX Messages), see ipx_msg_batch_destroy().
+ */
+#define IPX_PF_BATCH 2U
+
+/**
+ * \def IPX_PF_RAW
+ * \brief The plugin doesn't need references to Data Records
+ *
+ * The plugin processes IPFIX Messages only as raw data (e.g. it forwards or stores Sets as they
+ * are) and it never calls ipx_msg_ipfix_get_drec(). It is a static alternative of
+ * ipx_ctx_relay_set() for plugins which don't need Data Records regardless of the configuration.
+ * If all intermediate and output instances declare it, parsers don't build references to Data
+ * Records at all (relay mode).
+ *
+ * \note Only the Template snapshot and the number of Data Records of each Set are available
+ *   in relay mode (see ::ipx_ipfix_set).
+ */
+#define IPX_PF_RAW 4U
+
 /**
  * \brief Identification of a plugin
  *
@@ -350,6 +380,191 @@ ipx_ctx_verb_get(const ipx_ctx_t *ctx);
 IPX_API const char *
 ipx_ctx_name_get(const ipx_ctx_t *ctx);
 
+/**
+ * \brief Callback providing runtime statistics of the instance
+ *
+ * The callback formats plugin specific statistics as one or more lines of text separated by
+ * the newline character. The output is printed together with runtime statistics of the collector
+ * (see the "-s" option of the collector and the SIGUSR1 signal).
+ * \warning The callback is called by another thread while the instance is running. Therefore,
+ *   it MUST NOT modify the instance and it can read only data that are updated atomically.
+ * \param[in]  data   Private data of the callback
+ * \param[out] buffer Output buffer
+ * \param[in]  size   Size of the output buffer
+ * \return Number of characters (excluding the terminating null byte) which would have been
+ *   written if the buffer had been large enough (i.e. the same as snprintf())
+ */
+typedef int (*ipx_ctx_stats_cb)(void *data, char *buffer, size_t size);
+
+/**
+ * \brief Set a callback providing runtime statistics of the instance
+ *
+ * \note The callback is automatically removed before ipx_plugin_destroy() is called.
+ * \param[in] ctx  Current plugin context
+ * \param[in] cb   Callback (can be NULL, i.e. remove the previous callback)
+ * \param[in] data Private data of the callback (typically private data of the instance)
+ */
+IPX_API void
+ipx_ctx_stats_cb_set(ipx_ctx_t *ctx, ipx_ctx_stats_cb cb, void *data);
+
+/** Size of storage of a runtime metric (i.e. the size of a cache line)                          */
+#define IPX_METRIC_SIZE (64U)
+
+/** Type of a runtime metric                                                                     */
+enum ipx_metric_type {
+    /** Monotonically increasing value (e.g. the number of received messages)                   */
+    IPX_METRIC_COUNTER,
+    /** Value that can go up and down (e.g. the current length of a queue)                      */
+    IPX_METRIC_GAUGE
+};
+
+/**
+ * \brief Storage of a runtime metric
+ *
+ * Each storage has its own cache line and exactly one writer thread, therefore, an update is
+ * just a plain (relaxed) store without any locks or read-modify-write operations. A plugin
+ * with multiple threads registers the same metric once per thread, the collector sums values
+ * of all storages of the same metric and instance when they are exported.
+ */
+struct ipx_metric {
+    /** Current value (see ipx_metric_add() and ipx_metric_set())                                */
+    uint64_t value;
+    /** Padding to the size of a cache line (prevents false sharing)                             */
+    uint8_t reserved[IPX_METRIC_SIZE - sizeof(uint64_t)];
+};
+
+/**
+ * \brief Register a runtime metric of the instance
+ *
+ * Metrics of all instances are exported over HTTP in the Prometheus text format (see the "-m"
+ * option of the collector) as "ipfixcol2_<name>{instance="<name of the instance>"}". Counters
+ * should be named with the "_total" suffix and with the unit (e.g. "dropped_bytes_total").
+ *
+ * The same metric can be registered multiple times (e.g. by each thread of the plugin), but
+ * always with the same type. The storage is initialized to zero and it is valid until the
+ * plugin context is destroyed (i.e. even in ipx_plugin_destroy()).
+ *
+ * \note The function can be called by any thread of the instance (typically in
+ *   ipx_plugin_init()).
+ * \param[in] ctx  Current plugin context
+ * \param[in] type Type of the metric
+ * \param[in] name Name of the metric (letters, digits, underscores and colons, not starting
+ *   with a digit)
+ * \param[in] help Short description of the metric
+ * \return Pointer to the storage of the metric
+ * \return NULL if the name is not valid, the metric has been already registered with a different
+ *   type or a memory allocation error has occurred
+ */
+IPX_API struct ipx_metric *
+ipx_ctx_metric_register(ipx_ctx_t *ctx, enum ipx_metric_type type, const char *name,
+    const char *help);
+
+/**
+ * \brief Increment a runtime metric
+ * \warning Only a single thread can update the metric (see ::ipx_metric).
+ * \param[in] metric Metric
+ * \param[in] value  Value to add
+ */
+static inline void
+ipx_metric_add(struct ipx_metric *metric, uint64_t value)
+{
+    __atomic_store_n(&metric->value, __atomic_load_n(&metric->value, __ATOMIC_RELAXED) + value,
+        __ATOMIC_RELAXED);
+}
+
+/**
+ * \brief Set a runtime metric
+ * \warning Only a single thread can update the metric (see ::ipx_metric).
+ * \param[in] metric Metric
+ * \param[in] value  New value
+ */
+static inline void
+ipx_metric_set(struct ipx_metric *metric, uint64_t value)
+{
+    __atomic_store_n(&metric->value, value, __ATOMIC_RELAXED);
+}
+
+/**
+ * \brief Account memory allocated by the instance
+ *
+ * If memory accounting is enabled (see the "-M" option of the collector), current and peak
+ * numbers of bytes of each instance are reported with runtime statistics and metrics. Plugins
+ * should report large buffers allocated by themselves or by external libraries (e.g. queues
+ * of records) or allocate them by ipx_ctx_malloc() and related functions. Otherwise, the
+ * function does nothing.
+ * \note Can be called by any thread.
+ * \param[in] ctx  Current plugin context
+ * \param[in] size Number of allocated bytes
+ */
+IPX_API void
+ipx_ctx_mem_add(const ipx_ctx_t *ctx, size_t size);
+
+/**
+ * \brief Account memory freed by the instance
+ * \note Can be called by any thread.
+ * \param[in] ctx  Current plugin context
+ * \param[in] size Number of freed bytes (previously accounted by ipx_ctx_mem_add())
+ */
+IPX_API void
+ipx_ctx_mem_sub(const ipx_ctx_t *ctx, size_t size);
+
+/**
+ * \brief Allocate memory accounted to the instance (see ipx_ctx_mem_add())
+ *
+ * The memory MUST be freed by ipx_ctx_free() with the same context.
+ * \param[in] ctx  Current plugin context
+ * \param[in] size Number of bytes
+ * \return Pointer (aligned as by malloc()) or NULL (memory allocation error)
+ */
+IPX_API void *
+ipx_ctx_malloc(const ipx_ctx_t *ctx, size_t size);
+
+/**
+ * \brief Allocate zeroed memory accounted to the instance (see ipx_ctx_malloc())
+ * \param[in] ctx   Current plugin context
+ * \param[in] nmemb Number of elements
+ * \param[in] size  Size of an element
+ * \return Pointer or NULL (memory allocation error)
+ */
+IPX_API void *
+ipx_ctx_calloc(const ipx_ctx_t *ctx, size_t nmemb, size_t size);
+
+/**
+ * \brief Change the size of memory allocated by ipx_ctx_malloc()
+ * \param[in] ctx  Current plugin context
+ * \param[in] ptr  Pointer to the memory (can be NULL, i.e. the same as ipx_ctx_malloc())
+ * \param[in] size New number of bytes
+ * \return Pointer or NULL (memory allocation error, the original memory is untouched)
+ */
+IPX_API void *
+ipx_ctx_realloc(const ipx_ctx_t *ctx, void *ptr, size_t size);
+
+/**
+ * \brief Free memory allocated by ipx_ctx_malloc(), ipx_ctx_calloc() or ipx_ctx_realloc()
+ * \param[in] ctx Current plugin context
+ * \param[in] ptr Pointer to the memory (can be NULL)
+ */
+IPX_API void
+ipx_ctx_free(const ipx_ctx_t *ctx, void *ptr);
+
+/**
+ * \brief Declare whether the instance needs references to Data Records (disabled by default)
+ *
+ * If enabled, the instance processes IPFIX Messages only as raw data (e.g. it forwards Sets
+ * as they are) and it doesn't use references to Data Records (see ipx_msg_ipfix_get_drec()).
+ * If all output instances declare it (or #IPX_PF_RAW) and all intermediate instances declare
+ * #IPX_PF_RAW, the collector runs in relay mode, i.e. parsers only process (Options) Templates
+ * and count Data Records. In that case, IPFIX Messages don't contain any references to Data
+ * Records and only the number of Data Records and the Template snapshot of each Set are
+ * available (see ::ipx_ipfix_set).
+ *
+ * \warning This function can be called only within ipx_plugin_init() of an Output plugin.
+ * \param[in] ctx Current plugin context
+ * \param[in] en  Enable/disable
+ */
+IPX_API void
+ipx_ctx_relay_set(ipx_ctx_t *ctx, bool en);
+
 /**
  * \brief Pass a message to a successor of the plugin (only Input and Intermediate plugins ONLY!)
  *
@@ -382,6 +597,11 @@ ipx_ctx_msg_pass(ipx_ctx_t *ctx, ipx_msg_t *msg);
  * - ::IPX_MSG_IPFIX (IPFIX Message)
  * - ::IPX_MSG_SESSION (Transport Session Message)
  *
+ * Intermediate plugins can also subscribe to ::IPX_MSG_GARBAGE (Garbage Message). This is useful
+ * only for plugins that hold IPFIX Messages for a while (e.g. to merge them), because a garbage
+ * message can destroy (Options) Templates and snapshots the held messages refer to. Such plugin
+ * MUST pass the garbage message after all held messages that might refer to it.
+ *
  * If \p mask_new is non-NULL, the new subscription mask is installed from \p mask_new.
  * If \p mask_old is non-NULL, the previous mask is saved in \p mask_old.
  *
@@ -451,6 +671,39 @@ IPX_API int
 ipx_ctx_ext_producer(ipx_ctx_t *ctx, const char *type, const char *name, size_t size,
     ipx_ctx_ext_t **ext);
 
+/**
+ * \brief Register a columnar extension of Data Records (Intermediate plugins ONLY!)
+ *
+ * Same as ipx_ctx_ext_producer(), but the extension is not stored inside each Data Record.
+ * Instead, each IPFIX Message holds one contiguous array (i.e. column) of the extension, where
+ * the value of the N-th Data Record is at offset (N * size). The size of Data Records is not
+ * affected by the extension, therefore, plugins that don't use it are not slowed down by
+ * a lower cache density of records, and consumers scan a dense column.
+ *
+ * The column is accessible only via ipx_ctx_ext_column_get(). The producer is RESPONSIBLE for
+ * filling values of ALL Data Records in the message and, after that, it must call
+ * ipx_ctx_ext_column_set_filled(). Otherwise, consumers are not able to get its content.
+ * Consumers register dependency using the common ipx_ctx_ext_consumer().
+ *
+ * \warning
+ *   This function can be called only during ipx_plugin_init() of Intermediate plugins.
+ * \param[in]  ctx  Plugin context
+ * \param[in]  type Identification of the extension type (e.g. "profiles-v1")
+ * \param[in]  name Identification of the extension name (e.g. "main_profiles")
+ * \param[in]  size Non-zero size of the extension value of a single Data Record (in bytes)
+ * \param[out] ext  Internal description of the extension
+ *
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_ARG if the \p type or \p name are not valid (i.e. empty or NULL) or \p size
+ *   is zero.
+ * \return #IPX_ERR_DENIED if the plugin doesn't have permission to register extension
+ * \return #IPX_ERR_EXISTS if the extension or dependency has been already registered by this plugin
+ * \return #IPX_ERR_NOMEM if a memory allocation failure has occurred
+ */
+IPX_API int
+ipx_ctx_ext_producer_columnar(ipx_ctx_t *ctx, const char *type, const char *name, size_t size,
+    ipx_ctx_ext_t **ext);
+
 /**
  * @brief Add dependency on an extension of Data Records (Intermediate and Output plugins ONLY!)
  *
@@ -496,6 +749,7 @@ ipx_ctx_ext_consumer(ipx_ctx_t *ctx, const char *type, const char *name, ipx_ctx
  * \param[out] size Size of the extensions (bytes)
  * \return #IPX_OK on success
  * \return #IPX_ERR_NOTFOUND if the extension hasn't been filled by its producer
+ * \return #IPX_ERR_ARG if the extension is columnar (see ipx_ctx_ext_column_get())
  */
 IPX_API int
 ipx_ctx_ext_get(ipx_ctx_ext_t *ext, struct ipx_ipfix_record *drec, void **data, size_t *size);
@@ -509,6 +763,39 @@ ipx_ctx_ext_get(ipx_ctx_ext_t *ext, struct ipx_ipfix_record *drec, void **data,
 IPX_API void
 ipx_ctx_ext_set_filled(ipx_ctx_ext_t *ext, struct ipx_ipfix_record *drec);
 
+/**
+ * \brief Get a column of a columnar extension
+ *
+ * The column contains values of all Data Records of the IPFIX Message (in the order of the
+ * records). The value of the N-th Data Record is at offset (N * size).
+ *
+ * In case of a producer of the extension, the column is allocated (uninitialized) on the first
+ * call for the message and the function always returns #IPX_OK (unless the allocation fails).
+ * After all values are filled, the producer must call ipx_ctx_ext_column_set_filled().
+ * Otherwise, consumers will not be able to get its content.
+ *
+ * \param[in]  ext  Internal description of the extension
+ * \param[in]  msg  IPFIX Message with parsed Data Records
+ * \param[out] data Pointer to the column
+ * \param[out] size Size of the extension value of a single Data Record (bytes)
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_NOTFOUND if the column hasn't been filled by its producer
+ * \return #IPX_ERR_ARG if the extension is not columnar (see ipx_ctx_ext_get())
+ * \return #IPX_ERR_NOMEM if a memory allocation failure has occurred (producer only)
+ */
+IPX_API int
+ipx_ctx_ext_column_get(ipx_ctx_ext_t *ext, ipx_msg_ipfix_t *msg, void **data, size_t *size);
+
+/**
+ * \brief Set the column of a columnar extension as filled (ONLY for the producer of the extension)
+ *
+ * \warning Data Records must not be added to the message after the column has been allocated.
+ * \param[in] ext Internal description of the extension
+ * \param[in] msg IPFIX Message with the column
+ */
+IPX_API void
+ipx_ctx_ext_column_set_filled(ipx_ctx_ext_t *ext, ipx_msg_ipfix_t *msg);
+
 /**
  * @}
  * @}
@@ -0,0 +1,208 @@
+/**
+ * \file include/ipfixcol2/uring.h
+ * \author agent <agent@local>
+ * \brief Asynchronous socket I/O based on io_uring (header file)
+ * \date 2026
+ */
+
+/* Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is'', and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#ifndef IPX_URING_H
+#define IPX_URING_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/socket.h>
+#include <ipfixcol2/api.h>
+
+/**
+ * \defgroup ipxUring Asynchronous socket I/O
+ * \ingroup publicAPIs
+ * \brief Event loop based on the io_uring interface of the Linux kernel
+ *
+ * The interface is an optional replacement of an epoll loop with one read/write system call per
+ * event. Requests (receive, read, send) are queued and submitted together with waiting for
+ * completed requests, i.e. a single system call per iteration of the loop.
+ *
+ * Datagrams are received by multishot requests into a ring of buffers registered with the kernel.
+ * One armed request produces an event per received datagram until it's cancelled or the kernel
+ * runs out of free buffers.
+ *
+ * \note The support is detected when the collector is built. Moreover, the interface can be
+ *   disabled by the running kernel (e.g. kernel.io_uring_disabled or a seccomp filter).
+ *   Therefore, a plugin MUST be always ready to fall back to its standard event loop if
+ *   ipx_uring_create() fails.
+ * \warning An instance is not thread-safe. It should be used only by the plugin thread.
+ * @{
+ */
+
+/** \brief Internal structure of an instance                                */
+typedef struct ipx_uring ipx_uring_t;
+
+/** \brief Completion of a request                                          */
+struct ipx_uring_event {
+    /** User data of the request                                            */
+    uint64_t user_data;
+    /** Result of the request (number of bytes or negative errno code)      */
+    int res;
+    /** A multishot request remains armed (if false, it must be rearmed)    */
+    bool more;
+
+    /**
+     * Received datagram (only multishot receive requests with non-negative result, otherwise
+     * NULL). The data are valid only until the next call of ipx_uring_wait().
+     */
+    const uint8_t *data;
+    /** Size of the received data (in bytes)                                 */
+    size_t size;
+    /** The datagram has been truncated (too small buffers)                  */
+    bool truncated;
+    /** Source address of the datagram                                       */
+    struct sockaddr_storage addr;
+};
+
+/**
+ * \brief Check if the collector has been built with io_uring support
+ * \return True or false
+ */
+IPX_API bool
+ipx_uring_supported();
+
+/**
+ * \brief Create an instance
+ *
+ * \note Number of buffers is rounded up to the nearest power of two.
+ * \param[in] depth    Expected maximum number of requests submitted at once
+ * \param[in] buf_cnt  Number of receive buffers (can be 0, if no receive requests are used)
+ * \param[in] buf_size Size of each receive buffer (in bytes)
+ * \return Pointer or NULL (not supported by the collector or the kernel, memory allocation
+ *   error, etc.) and errno is set appropriately.
+ */
+IPX_API ipx_uring_t *
+ipx_uring_create(unsigned int depth, unsigned int buf_cnt, size_t buf_size);
+
+/**
+ * \brief Destroy an instance
+ *
+ * All unfinished requests are cancelled.
+ * \param[in] ring Instance
+ */
+IPX_API void
+ipx_uring_destroy(ipx_uring_t *ring);
+
+/**
+ * \brief Queue a multishot request to receive datagrams from a socket
+ *
+ * Each received datagram (together with its source address) generates an event.
+ * \warning The instance MUST be created with receive buffers.
+ * \param[in] ring      Instance
+ * \param[in] fd        Socket descriptor
+ * \param[in] user_data User data of generated events
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_ARG if receive buffers are not available
+ * \return #IPX_ERR_DENIED if the request cannot be queued
+ */
+IPX_API int
+ipx_uring_recv_multishot(ipx_uring_t *ring, int fd, uint64_t user_data);
+
+/**
+ * \brief Queue a request to read data from a file descriptor (e.g. a timer)
+ * \warning The buffer MUST be valid until the event of the request is returned!
+ * \param[in] ring      Instance
+ * \param[in] fd        File descriptor
+ * \param[in] buffer    Output buffer
+ * \param[in] size      Size of the buffer
+ * \param[in] user_data User data of the event
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_DENIED if the request cannot be queued
+ */
+IPX_API int
+ipx_uring_read(ipx_uring_t *ring, int fd, void *buffer, size_t size, uint64_t user_data);
+
+/**
+ * \brief Queue a request to send data to a connected socket
+ *
+ * The request is submitted together with other queued requests (see ipx_uring_submit() and
+ * ipx_uring_wait()). Result of the request is returned as an event with the number of sent
+ * bytes, which can be less than \p size.
+ * \warning The data MUST be valid until the event of the request is returned!
+ * \param[in] ring      Instance
+ * \param[in] fd        Socket descriptor
+ * \param[in] data      Data to send
+ * \param[in] size      Size of the data
+ * \param[in] flags     Flags of send() (e.g. MSG_NOSIGNAL)
+ * \param[in] user_data User data of the event
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_DENIED if the request cannot be queued
+ */
+IPX_API int
+ipx_uring_send(ipx_uring_t *ring, int fd, const void *data, size_t size, int flags,
+    uint64_t user_data);
+
+/**
+ * \brief Submit all queued requests to the kernel
+ * \note Requests are also submitted automatically by ipx_uring_wait() or if the queue is full.
+ * \param[in] ring Instance
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_DENIED on failure (errno is set appropriately)
+ */
+IPX_API int
+ipx_uring_submit(ipx_uring_t *ring);
+
+/**
+ * \brief Submit queued requests and wait for completed requests
+ *
+ * Receive buffers of datagrams returned by the previous call are given back to the kernel.
+ * \param[in]  ring    Instance
+ * \param[out] events  Array of events
+ * \param[in]  max     Size of the array
+ * \param[in]  timeout Timeout (in milliseconds)
+ * \return Number of filled events (0 on timeout or on interruption by a signal)
+ * \return #IPX_ERR_DENIED on failure (errno is set appropriately)
+ */
+IPX_API int
+ipx_uring_wait(ipx_uring_t *ring, struct ipx_uring_event *events, unsigned int max, int timeout);
+
+/**@}*/
+
+#ifdef __cplusplus
+}
+#endif
+#endif // IPX_URING_H
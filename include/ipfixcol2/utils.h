@@ -16,6 +16,7 @@ extern "C" {
 #endif
 
 #include <ipfixcol2/api.h>
+#include <stdint.h>
 #include <sys/stat.h> // mkdir file permissions
 
 /**
@@ -62,6 +63,204 @@ extern "C" {
 IPX_API int
 ipx_utils_mkdir(const char *path, mode_t mode);
 
+/**
+ * @brief Allocate a buffer for a raw NetFlow/IPFIX Message
+ *
+ * Buffers are recycled in a process-wide pool shared by all threads. Free lists
+ * are kept per size class and NUMA node, so a buffer is usually reused on the node
+ * where it was allocated and the hot path doesn't call the system allocator.
+ * If the pool is not available (or the size is too large), the buffer is allocated
+ * by malloc().
+ *
+ * @note The buffer MUST be released by ipx_utils_buf_free(). The buffer of a raw
+ *   message passed to ipx_msg_ipfix_create() is released automatically, when the
+ *   wrapper is destroyed.
+ * @param[in] size Size of the buffer (in bytes)
+ * @return Pointer to the buffer or NULL (memory allocation error)
+ */
+IPX_API void *
+ipx_utils_buf_alloc(size_t size);
+
+/**
+ * @brief Change the size of a buffer
+ *
+ * Content of the buffer is preserved up to the smaller of the old and new sizes.
+ * @note The @p ptr can be NULL, a buffer allocated by ipx_utils_buf_alloc() or
+ *   a memory allocated by malloc().
+ * @param[in] ptr  Buffer to resize
+ * @param[in] size New size of the buffer (in bytes)
+ * @return Pointer to the buffer or NULL (memory allocation error, the original buffer
+ *   is left untouched)
+ */
+IPX_API void *
+ipx_utils_buf_realloc(void *ptr, size_t size);
+
+/**
+ * @brief Release a buffer
+ *
+ * The buffer can be released by any thread.
+ * @note The @p ptr can be NULL, a buffer allocated by ipx_utils_buf_alloc() or
+ *   a memory allocated by malloc().
+ * @param[in] ptr Buffer to release
+ */
+IPX_API void
+ipx_utils_buf_free(void *ptr);
+
+/**
+ * @brief Callback releasing a buffer of a registered region
+ * @param[in] ptr Buffer to release
+ * @param[in] arg User data of the region
+ */
+typedef void (*ipx_utils_buf_release_cb)(void *ptr, void *arg);
+
+/**
+ * @brief Register memory of another owner as a region of buffers
+ *
+ * Buffers in the region (e.g. frames of a packet capture interface) can be used as raw
+ * messages without copying. If a buffer of the region is released by ipx_utils_buf_free(),
+ * the callback is called instead, so the owner can recycle it. If the buffer is resized by
+ * ipx_utils_buf_realloc(), its content is moved into a pooled buffer and the original buffer is
+ * released by the callback too.
+ * @note The callback can be called by any thread (i.e. also concurrently).
+ * @param[in] base Start of the region
+ * @param[in] size Size of the region (in bytes)
+ * @param[in] cb   Callback releasing buffers of the region
+ * @param[in] arg  User data passed to the callback
+ * @return #IPX_OK on success
+ * @return #IPX_ERR_ARG if the region is empty or the callback is not defined
+ * @return #IPX_ERR_LIMIT if the maximum number of regions has been reached
+ */
+IPX_API int
+ipx_utils_buf_region_add(void *base, size_t size, ipx_utils_buf_release_cb cb, void *arg);
+
+/**
+ * @brief Unregister a region of buffers
+ * @warning All buffers of the region MUST be released before the call.
+ * @param[in] base Start of the region
+ */
+IPX_API void
+ipx_utils_buf_region_remove(void *base);
+
+/** @brief Internal structure of a set of reference counted chunks */
+typedef struct ipx_utils_chunks ipx_utils_chunks_t;
+
+/**
+ * @brief Create a set of reference counted chunks
+ *
+ * Chunks are large buffers (e.g. for reading of a stream) that are registered as a region of
+ * buffers (see ipx_utils_buf_region_add()). Any part of a chunk (i.e. a slice) can be used
+ * as a raw message without copying. The chunk is reused after its owner and all its slices
+ * are released by ipx_utils_buf_free().
+ * @param[in] chunk_size Size of a chunk (in bytes)
+ * @param[in] chunk_cnt  Number of chunks
+ * @return Pointer to the set or NULL (memory allocation error or no free slot for the region)
+ */
+IPX_API ipx_utils_chunks_t *
+ipx_utils_chunks_create(size_t chunk_size, size_t chunk_cnt);
+
+/**
+ * @brief Destroy a set of chunks
+ *
+ * The memory is released after the last chunk (or its slice) in use is released, therefore,
+ * the function can be called even if some messages still refer to chunks.
+ * @param[in] chunks Set of chunks
+ */
+IPX_API void
+ipx_utils_chunks_destroy(ipx_utils_chunks_t *chunks);
+
+/**
+ * @brief Take a free chunk
+ *
+ * The caller becomes the owner of the chunk and MUST release it by ipx_utils_buf_free().
+ * @note The function is thread-safe.
+ * @param[in] chunks Set of chunks
+ * @return Pointer to the chunk or NULL (all chunks are in use)
+ */
+IPX_API void *
+ipx_utils_chunks_take(ipx_utils_chunks_t *chunks);
+
+/**
+ * @brief Get a slice of a chunk
+ *
+ * A reference to the chunk is added, therefore, the slice MUST be released by
+ * ipx_utils_buf_free(). The slice can be released by any thread.
+ * @warning The chunk of the slice MUST be still referenced by the caller.
+ * @param[in] chunks Set of chunks
+ * @param[in] ptr    Start of the slice (pointer into a chunk of the set)
+ * @return The pointer of the slice
+ */
+IPX_API void *
+ipx_utils_chunks_slice(ipx_utils_chunks_t *chunks, void *ptr);
+
+/** @brief Internal structure of a reference counted file mapping */
+typedef struct ipx_utils_fmap ipx_utils_fmap_t;
+
+/**
+ * @brief Map a file into memory
+ *
+ * The file is mapped privately (i.e. modifications are not written to the file) and advised
+ * for sequential access. The mapping is registered as a region of buffers (see
+ * ipx_utils_buf_region_add()), therefore, any part of the file (i.e. a slice) can be used as
+ * a raw message without copying.
+ * @note The file descriptor can be closed after the call.
+ * @param[in]  fd   File descriptor (opened for reading)
+ * @param[out] size Size of the mapping i.e. the file (in bytes)
+ * @return Pointer to the mapping or NULL (empty file, mapping error or no free slot for the
+ *   region) and errno is set appropriately.
+ */
+IPX_API ipx_utils_fmap_t *
+ipx_utils_fmap_create(int fd, size_t *size);
+
+/**
+ * @brief Destroy a file mapping
+ *
+ * The memory is unmapped after the last slice is released, therefore, the function can be
+ * called even if some messages still refer to the file.
+ * @param[in] map File mapping
+ */
+IPX_API void
+ipx_utils_fmap_destroy(ipx_utils_fmap_t *map);
+
+/**
+ * @brief Get the start of the mapped file
+ * @param[in] map File mapping
+ * @return Pointer to the first byte of the file
+ */
+IPX_API const uint8_t *
+ipx_utils_fmap_data(const ipx_utils_fmap_t *map);
+
+/**
+ * @brief Get a slice of a mapped file
+ *
+ * A reference to the mapping is added, therefore, the slice MUST be released by
+ * ipx_utils_buf_free(). The slice can be released by any thread.
+ * @param[in] map File mapping
+ * @param[in] ptr Start of the slice (pointer into the mapping)
+ * @return The pointer of the slice
+ */
+IPX_API void *
+ipx_utils_fmap_slice(ipx_utils_fmap_t *map, const uint8_t *ptr);
+
+/**
+ * @brief Final mixing of a 64-bit hash (SplitMix64 finalizer)
+ *
+ * All bits of the input affect all bits of the result, so the result can be used as a bucket
+ * index (or compared with a threshold) even if the input is a weak hash (e.g. FNV-1a) or
+ * a sum of hashes.
+ * @param[in] hash Hash
+ * @return Mixed hash
+ */
+static inline uint64_t
+ipx_utils_hash_mix(uint64_t hash)
+{
+    hash ^= hash >> 30;
+    hash *= 0xbf58476d1ce4e5b9ULL;
+    hash ^= hash >> 27;
+    hash *= 0x94d049bb133111ebULL;
+    hash ^= hash >> 31;
+    return hash;
+}
+
 /**@}*/
 
 #ifdef __cplusplus
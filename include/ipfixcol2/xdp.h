@@ -0,0 +1,174 @@
+/**
+ * \file include/ipfixcol2/xdp.h
+ * \author agent <agent@local>
+ * \brief Zero-copy receiving of UDP datagrams based on AF_XDP (header file)
+ * \date 2026
+ */
+
+/* Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is'', and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#ifndef IPX_XDP_H
+#define IPX_XDP_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/socket.h>
+#include <ipfixcol2/api.h>
+
+/**
+ * \defgroup ipxXdp Zero-copy receiving of UDP datagrams
+ * \ingroup publicAPIs
+ * \brief Receiving of UDP datagrams by AF_XDP sockets of the Linux kernel
+ *
+ * An XDP program attached to a network interface redirects UDP datagrams with selected
+ * destination ports from receive queues of the interface directly into memory shared with the
+ * collector (i.e. the kernel network stack is bypassed). Other packets (e.g. fragments, IPv4
+ * packets with options, other protocols and ports) are passed to the kernel network stack.
+ *
+ * Payload of each datagram is returned as a pointer into a frame of the shared memory, which
+ * can be used directly as a raw message (see ipx_msg_ipfix_create()). When the payload is
+ * released by ipx_utils_buf_free() (by any thread), the frame is given back to the kernel.
+ * Therefore, the number of frames limits the number of messages in the pipeline at the same
+ * time. If no frame is available, the interface drops datagrams.
+ *
+ * \note The support is detected when the collector is built. Moreover, the running kernel
+ *   (5.9 or newer), the driver of the interface and permissions of the collector (CAP_NET_ADMIN,
+ *   CAP_NET_RAW and CAP_BPF or CAP_SYS_ADMIN) must allow it. Therefore, a plugin MUST be always ready to
+ *   fall back to regular sockets if ipx_xdp_create() fails.
+ * \note The checksum of datagrams is not verified and only one XDP program can be attached to
+ *   an interface.
+ * \warning An instance is not thread-safe (except for releasing of payloads). It should be
+ *   used only by the plugin thread.
+ * @{
+ */
+
+/** \brief Internal structure of an instance                                */
+typedef struct ipx_xdp ipx_xdp_t;
+
+/** \brief Received UDP datagram                                            */
+struct ipx_xdp_packet {
+    /**
+     * Payload of the datagram (i.e. a pointer into a frame of the shared memory), which MUST be
+     * released by ipx_utils_buf_free().
+     */
+    uint8_t *data;
+    /** Size of the payload (in bytes)                                      */
+    size_t size;
+    /** Source IP address and port of the datagram                          */
+    struct sockaddr_storage src;
+    /** Destination IP address and port of the datagram                     */
+    struct sockaddr_storage dst;
+};
+
+/**
+ * \brief Check if the collector has been built with AF_XDP support
+ * \return True or false
+ */
+IPX_API bool
+ipx_xdp_supported();
+
+/**
+ * \brief Create an instance
+ *
+ * An AF_XDP socket is bound to each receive queue [0, \p queues) of the interface and
+ * an XDP program which redirects UDP datagrams with any of given destination ports to the
+ * sockets is attached to the interface. Zero-copy mode is used, if supported by the driver.
+ * \note Number of frames is rounded up to the nearest power of two. Each frame has 4 KiB,
+ *   therefore, it's not possible to receive larger packets (e.g. jumbo frames).
+ * \param[in] ifname    Name of the network interface
+ * \param[in] queues    Number of receive queues of the interface
+ * \param[in] ports     Array of destination UDP ports
+ * \param[in] ports_cnt Number of ports
+ * \param[in] frames    Number of frames per receive queue
+ * \return Pointer or NULL (not supported by the collector or the kernel, unknown interface,
+ *   insufficient permissions, memory allocation error, etc.) and errno is set appropriately.
+ */
+IPX_API ipx_xdp_t *
+ipx_xdp_create(const char *ifname, unsigned int queues, const uint16_t *ports, size_t ports_cnt,
+    unsigned int frames);
+
+/**
+ * \brief Destroy an instance
+ *
+ * The XDP program is detached and sockets are closed. The shared memory is released after
+ * all payloads of received datagrams have been released.
+ * \param[in] xdp Instance
+ */
+IPX_API void
+ipx_xdp_destroy(ipx_xdp_t *xdp);
+
+/**
+ * \brief Check if datagrams are received without copying by the kernel (zero-copy mode)
+ * \param[in] xdp Instance
+ * \return True or false (datagrams are copied by the kernel into the shared memory)
+ */
+IPX_API bool
+ipx_xdp_zerocopy(const ipx_xdp_t *xdp);
+
+/**
+ * \brief Get a file descriptor of the socket of a receive queue
+ *
+ * The descriptor can be used by poll() or epoll to wait for received datagrams.
+ * \param[in] xdp   Instance
+ * \param[in] queue Index of the receive queue
+ * \return File descriptor or -1 (invalid queue)
+ */
+IPX_API int
+ipx_xdp_fd(const ipx_xdp_t *xdp, unsigned int queue);
+
+/**
+ * \brief Get received datagrams of a receive queue (non-blocking)
+ *
+ * Frames of previously released payloads are given back to the kernel first.
+ * \param[in]  xdp   Instance
+ * \param[in]  queue Index of the receive queue
+ * \param[out] pkts  Array of datagrams
+ * \param[in]  max   Size of the array
+ * \return Number of filled datagrams (0, if there are no datagrams or the queue is invalid)
+ */
+IPX_API unsigned int
+ipx_xdp_recv(ipx_xdp_t *xdp, unsigned int queue, struct ipx_xdp_packet *pkts, unsigned int max);
+
+/**@}*/
+
+#ifdef __cplusplus
+}
+#endif
+#endif // IPX_XDP_H
@@ -0,0 +1,674 @@
+/**
+ * \file src/core/buffer_pool.c
+ * \author agent <agent@local>
+ * \brief Pool of buffers for raw NetFlow/IPFIX Messages (source file)
+ * \date 2026
+ */
+
+/* Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is'', and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#define _GNU_SOURCE
+#include <errno.h>
+#include <ipfixcol2.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+/*
+ * All pooled buffers are carved out of a single reserved region of the virtual address space.
+ * This makes it possible to distinguish pooled buffers from memory allocated by malloc() and
+ * to address blocks by 32-bit indexes, so a head of a free list together with a modification
+ * tag fits into a single 64-bit word (i.e. lock-free lists without the ABA problem).
+ * Physical pages of the region are allocated by the kernel on the first touch, therefore,
+ * blocks of a node are usually backed by memory of the node.
+ */
+
+/** Size of the reserved region                                                     */
+#define BUF_REGION_SIZE ((sizeof(void *) >= 8) ? (1UL << 30) : (64UL << 20))
+/** Number of size classes (capacity of BUF_CLASS_MIN * 2^idx bytes)                */
+#define BUF_CLASSES (8U)
+/** Capacity of the smallest size class                                             */
+#define BUF_CLASS_MIN (512U)
+/** Maximum number of supported NUMA nodes (others are mapped to them)             */
+#define BUF_NODES (8U)
+/** Number of allocations after which the NUMA node of a thread is checked again    */
+#define BUF_NODE_REFRESH (1024U)
+/** Size of a cache line                                                            */
+#define BUF_CACHE_LINE (64U)
+/** Granularity of block indexes                                                    */
+#define BUF_UNIT (16U)
+/** Maximum number of regions of other owners                                       */
+#define BUF_EXT_REGIONS (16U)
+
+/** Header of a block (followed by the buffer)                                      */
+struct buf_block {
+    /** Index of the next free block (valid only in a free list, atomic)            */
+    uint32_t next;
+    /** Size class                                                                  */
+    uint8_t cls;
+    /** NUMA node of the free list                                                  */
+    uint8_t node;
+} __attribute__((aligned(BUF_UNIT)));
+
+/** Region of buffers of another owner (see ipx_utils_buf_region_add())            */
+struct buf_ext_region {
+    /** Start of the region (NULL, if the slot is not used, atomic)                 */
+    uint8_t *base;
+    /** Size of the region                                                          */
+    size_t size;
+    /** Callback releasing buffers                                                  */
+    ipx_utils_buf_release_cb cb;
+    /** User data of the callback                                                   */
+    void *arg;
+};
+
+/** Free list (lower 32 bits: index of the first block, upper 32 bits: tag)         */
+struct buf_list {
+    /** Head of the list (atomic)                                                   */
+    uint64_t head;
+} __attribute__((aligned(BUF_CACHE_LINE)));
+
+/** Global pool                                                                     */
+static struct {
+    /** Initialization guard                                                        */
+    pthread_once_t once;
+    /** Start of the reserved region (NULL, if not available)                      */
+    uint8_t *base;
+    /** Number of bytes already carved out of the region (atomic)                  */
+    size_t used;
+    /** Free lists                                                                  */
+    struct buf_list lists[BUF_NODES][BUF_CLASSES];
+    /** Number of registered regions of other owners (atomic)                       */
+    unsigned int ext_cnt;
+    /** Protection of registration of regions of other owners                      */
+    pthread_mutex_t ext_lock;
+    /** Regions of other owners                                                     */
+    struct buf_ext_region ext[BUF_EXT_REGIONS];
+} buf_pool = {PTHREAD_ONCE_INIT, NULL, 0, {{{0}}}, 0, PTHREAD_MUTEX_INITIALIZER, {{0}}};
+
+/** NUMA node of the current thread                                                 */
+static __thread struct {
+    /** Node index                                                                  */
+    unsigned int node;
+    /** Allocations till the next check of the node                                 */
+    unsigned int refresh;
+} buf_tls = {0, 0};
+
+/** \brief Reserve the region (called only once) */
+static void
+buf_pool_init()
+{
+    void *ptr = mmap(NULL, BUF_REGION_SIZE, PROT_READ | PROT_WRITE,
+        MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    buf_pool.base = (ptr != MAP_FAILED) ? ptr : NULL;
+}
+
+/**
+ * \brief Get the NUMA node of the current thread
+ * \return Index of the node
+ */
+static inline unsigned int
+buf_node_get()
+{
+    if (buf_tls.refresh-- == 0) {
+        // Threads are migrated rarely, so the (relatively expensive) check is not always done
+        unsigned int cpu, node;
+        buf_tls.node = (syscall(SYS_getcpu, &cpu, &node, NULL) == 0) ? (node % BUF_NODES) : 0;
+        buf_tls.refresh = BUF_NODE_REFRESH;
+    }
+    return buf_tls.node;
+}
+
+/**
+ * \brief Get capacity of a size class
+ * \param[in] idx Index of the class
+ * \return Capacity (in bytes)
+ */
+static inline size_t
+buf_class_cap(unsigned int idx)
+{
+    return ((size_t) BUF_CLASS_MIN) << idx;
+}
+
+/**
+ * \brief Check if a pointer belongs to a pooled buffer
+ * \param[in] ptr Pointer
+ * \return True or false
+ */
+static inline bool
+buf_is_pooled(const void *ptr)
+{
+    const uint8_t *base = buf_pool.base;
+    return base != NULL && (const uint8_t *) ptr >= base
+        && (const uint8_t *) ptr < base + BUF_REGION_SIZE;
+}
+
+/**
+ * \brief Find a region of another owner of a buffer
+ * \param[in] ptr Pointer to the buffer
+ * \return Pointer to the region or NULL (not a buffer of a registered region)
+ */
+static inline const struct buf_ext_region *
+buf_ext_find(const void *ptr)
+{
+    if (__atomic_load_n(&buf_pool.ext_cnt, __ATOMIC_RELAXED) == 0) {
+        return NULL;
+    }
+
+    for (unsigned int i = 0; i < BUF_EXT_REGIONS; ++i) {
+        const struct buf_ext_region *region = &buf_pool.ext[i];
+        const uint8_t *base = __atomic_load_n(&region->base, __ATOMIC_ACQUIRE);
+        if (base != NULL && (const uint8_t *) ptr >= base
+                && (const uint8_t *) ptr < base + region->size) {
+            return region;
+        }
+    }
+
+    return NULL;
+}
+
+/** \brief Convert an index to a block */
+static inline struct buf_block *
+buf_idx2block(uint32_t idx)
+{
+    return (struct buf_block *) (buf_pool.base + ((size_t) (idx - 1) * BUF_UNIT));
+}
+
+/** \brief Convert a block to an index (0 is reserved for an empty list) */
+static inline uint32_t
+buf_block2idx(const struct buf_block *block)
+{
+    return (uint32_t) (((const uint8_t *) block - buf_pool.base) / BUF_UNIT) + 1;
+}
+
+/**
+ * \brief Take a block from a free list
+ * \param[in] list Free list
+ * \return Pointer to the block or NULL (the list is empty)
+ */
+static struct buf_block *
+buf_list_pop(struct buf_list *list)
+{
+    uint64_t head = __atomic_load_n(&list->head, __ATOMIC_ACQUIRE);
+    while ((uint32_t) head != 0) {
+        // The block is never unmapped, so it is safe to read it even if it's already taken
+        struct buf_block *block = buf_idx2block((uint32_t) head);
+        uint32_t next = __atomic_load_n(&block->next, __ATOMIC_RELAXED);
+        uint64_t new_head = (((head >> 32) + 1) << 32) | next;
+        if (__atomic_compare_exchange_n(&list->head, &head, new_head, true,
+                __ATOMIC_ACQUIRE, __ATOMIC_ACQUIRE)) {
+            return block;
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * \brief Put a block into a free list
+ * \param[in] list  Free list
+ * \param[in] block Block
+ */
+static void
+buf_list_push(struct buf_list *list, struct buf_block *block)
+{
+    const uint32_t idx = buf_block2idx(block);
+    uint64_t head = __atomic_load_n(&list->head, __ATOMIC_RELAXED);
+    uint64_t new_head;
+    do {
+        __atomic_store_n(&block->next, (uint32_t) head, __ATOMIC_RELAXED);
+        new_head = (((head >> 32) + 1) << 32) | idx;
+    } while (!__atomic_compare_exchange_n(&list->head, &head, new_head, true,
+        __ATOMIC_RELEASE, __ATOMIC_RELAXED));
+}
+
+/**
+ * \brief Carve a new block out of the region
+ * \param[in] size Size of the block (including the header)
+ * \return Pointer to the block or NULL (the region is exhausted)
+ */
+static struct buf_block *
+buf_region_take(size_t size)
+{
+    size_t used = __atomic_load_n(&buf_pool.used, __ATOMIC_RELAXED);
+    do {
+        if (used + size > BUF_REGION_SIZE) {
+            return NULL;
+        }
+    } while (!__atomic_compare_exchange_n(&buf_pool.used, &used, used + size, true,
+        __ATOMIC_RELAXED, __ATOMIC_RELAXED));
+
+    return (struct buf_block *) (buf_pool.base + used);
+}
+
+void *
+ipx_utils_buf_alloc(size_t size)
+{
+    pthread_once(&buf_pool.once, buf_pool_init);
+    if (buf_pool.base == NULL || size > buf_class_cap(BUF_CLASSES - 1)) {
+        return malloc(size);
+    }
+
+    unsigned int cls = 0;
+    while (buf_class_cap(cls) < size) {
+        cls++;
+    }
+
+    const unsigned int node = buf_node_get();
+    struct buf_block *block = buf_list_pop(&buf_pool.lists[node][cls]);
+    if (block == NULL) {
+        block = buf_region_take(sizeof(struct buf_block) + buf_class_cap(cls));
+        if (block == NULL) {
+            // The region is exhausted, use the system allocator
+            return malloc(size);
+        }
+
+        block->cls = (uint8_t) cls;
+        block->node = (uint8_t) node;
+    }
+
+    return block + 1;
+}
+
+void *
+ipx_utils_buf_realloc(void *ptr, size_t size)
+{
+    if (ptr == NULL) {
+        return ipx_utils_buf_alloc(size);
+    }
+
+    if (!buf_is_pooled(ptr)) {
+        const struct buf_ext_region *region = buf_ext_find(ptr);
+        if (region == NULL) {
+            return realloc(ptr, size);
+        }
+
+        // Move the content into a pooled buffer (the size of the original one is unknown)
+        void *new_ptr = ipx_utils_buf_alloc(size);
+        if (!new_ptr) {
+            return NULL;
+        }
+
+        const size_t avail = (size_t) (region->base + region->size - (uint8_t *) ptr);
+        memcpy(new_ptr, ptr, (size < avail) ? size : avail);
+        region->cb(ptr, region->arg);
+        return new_ptr;
+    }
+
+    const struct buf_block *block = ((const struct buf_block *) ptr) - 1;
+    const size_t cap = buf_class_cap(block->cls);
+    if (size <= cap) {
+        // Still fits
+        return ptr;
+    }
+
+    void *new_ptr = ipx_utils_buf_alloc(size);
+    if (!new_ptr) {
+        return NULL;
+    }
+
+    memcpy(new_ptr, ptr, cap);
+    ipx_utils_buf_free(ptr);
+    return new_ptr;
+}
+
+void
+ipx_utils_buf_free(void *ptr)
+{
+    if (!buf_is_pooled(ptr)) {
+        const struct buf_ext_region *region = (ptr != NULL) ? buf_ext_find(ptr) : NULL;
+        if (region != NULL) {
+            region->cb(ptr, region->arg);
+        } else {
+            free(ptr);
+        }
+        return;
+    }
+
+    // Return the block to the list of its original node
+    struct buf_block *block = ((struct buf_block *) ptr) - 1;
+    buf_list_push(&buf_pool.lists[block->node][block->cls], block);
+}
+
+int
+ipx_utils_buf_region_add(void *base, size_t size, ipx_utils_buf_release_cb cb, void *arg)
+{
+    if (base == NULL || size == 0 || cb == NULL) {
+        return IPX_ERR_ARG;
+    }
+
+    int ret = IPX_ERR_LIMIT;
+    pthread_mutex_lock(&buf_pool.ext_lock);
+    for (unsigned int i = 0; i < BUF_EXT_REGIONS; ++i) {
+        struct buf_ext_region *region = &buf_pool.ext[i];
+        if (region->base != NULL) {
+            continue;
+        }
+
+        region->size = size;
+        region->cb = cb;
+        region->arg = arg;
+        // Publish the region after its parameters
+        __atomic_store_n(&region->base, (uint8_t *) base, __ATOMIC_RELEASE);
+        __atomic_add_fetch(&buf_pool.ext_cnt, 1U, __ATOMIC_RELEASE);
+        ret = IPX_OK;
+        break;
+    }
+    pthread_mutex_unlock(&buf_pool.ext_lock);
+    return ret;
+}
+
+void
+ipx_utils_buf_region_remove(void *base)
+{
+    pthread_mutex_lock(&buf_pool.ext_lock);
+    for (unsigned int i = 0; i < BUF_EXT_REGIONS; ++i) {
+        struct buf_ext_region *region = &buf_pool.ext[i];
+        if (base == NULL || region->base != base) {
+            continue;
+        }
+
+        __atomic_store_n(&region->base, NULL, __ATOMIC_RELEASE);
+        __atomic_sub_fetch(&buf_pool.ext_cnt, 1U, __ATOMIC_RELEASE);
+        break;
+    }
+    pthread_mutex_unlock(&buf_pool.ext_lock);
+}
+
+/** Index of a chunk that doesn't exist (i.e. the end of a list)                   */
+#define BUF_CHUNK_NONE (UINT32_MAX)
+
+/** Set of reference counted chunks                                                 */
+struct ipx_utils_chunks {
+    /** Memory of chunks                                                            */
+    uint8_t *mem;
+    /** Size of the memory                                                          */
+    size_t mem_size;
+    /** Size of a chunk                                                             */
+    size_t chunk_size;
+    /** Number of references of chunks (atomic)                                     */
+    uint32_t *chunk_refs;
+    /** Index of the next chunk in a list (atomic)                                  */
+    uint32_t *next;
+
+    /** List of free chunks (protected by the lock)                                 */
+    uint32_t free;
+    /** Protection of taking of chunks                                              */
+    pthread_mutex_t lock;
+    /** List of chunks released by any thread (atomic)                              */
+    uint32_t released;
+    /** References of the set (the creator and chunks in use, atomic)               */
+    uint32_t refs;
+};
+
+/**
+ * \brief Release the memory of a set of chunks (called by the last reference)
+ * \param[in] chunks Set of chunks
+ */
+static void
+buf_chunks_free(ipx_utils_chunks_t *chunks)
+{
+    ipx_utils_buf_region_remove(chunks->mem);
+    munmap(chunks->mem, chunks->mem_size);
+    pthread_mutex_destroy(&chunks->lock);
+    free(chunks->chunk_refs);
+    free(chunks->next);
+    free(chunks);
+}
+
+/**
+ * \brief Release a reference of a chunk (see ipx_utils_buf_region_add())
+ *
+ * If the chunk is not referenced anymore, it is added to the list of released chunks.
+ * \param[in] ptr Pointer into the chunk
+ * \param[in] arg Set of chunks
+ */
+static void
+buf_chunks_release(void *ptr, void *arg)
+{
+    ipx_utils_chunks_t *chunks = arg;
+    const uint32_t idx = (uint32_t) (((uint8_t *) ptr - chunks->mem) / chunks->chunk_size);
+    if (__atomic_sub_fetch(&chunks->chunk_refs[idx], 1U, __ATOMIC_ACQ_REL) != 0) {
+        return;
+    }
+
+    uint32_t head = __atomic_load_n(&chunks->released, __ATOMIC_RELAXED);
+    do {
+        __atomic_store_n(&chunks->next[idx], head, __ATOMIC_RELAXED);
+    } while (!__atomic_compare_exchange_n(&chunks->released, &head, idx, true,
+        __ATOMIC_RELEASE, __ATOMIC_RELAXED));
+
+    // The set could have been already destroyed (the last reference releases the memory)
+    if (__atomic_sub_fetch(&chunks->refs, 1U, __ATOMIC_ACQ_REL) == 0) {
+        buf_chunks_free(chunks);
+    }
+}
+
+ipx_utils_chunks_t *
+ipx_utils_chunks_create(size_t chunk_size, size_t chunk_cnt)
+{
+    if (chunk_size == 0 || chunk_cnt == 0 || chunk_cnt >= BUF_CHUNK_NONE) {
+        return NULL;
+    }
+
+    ipx_utils_chunks_t *chunks = calloc(1, sizeof(*chunks));
+    if (!chunks) {
+        return NULL;
+    }
+
+    chunks->chunk_size = chunk_size;
+    chunks->mem_size = chunk_size * chunk_cnt;
+    chunks->chunk_refs = calloc(chunk_cnt, sizeof(*chunks->chunk_refs));
+    chunks->next = malloc(chunk_cnt * sizeof(*chunks->next));
+    // Physical pages are allocated on the first touch
+    void *mem = mmap(NULL, chunks->mem_size, PROT_READ | PROT_WRITE,
+        MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if (!chunks->chunk_refs || !chunks->next || mem == MAP_FAILED) {
+        if (mem != MAP_FAILED) {
+            munmap(mem, chunks->mem_size);
+        }
+        free(chunks->chunk_refs);
+        free(chunks->next);
+        free(chunks);
+        return NULL;
+    }
+
+    chunks->mem = mem;
+    for (size_t i = 0; i < chunk_cnt; ++i) {
+        chunks->next[i] = (i + 1 < chunk_cnt) ? (uint32_t) (i + 1) : BUF_CHUNK_NONE;
+    }
+    chunks->free = 0;
+    chunks->released = BUF_CHUNK_NONE;
+    chunks->refs = 1;
+    pthread_mutex_init(&chunks->lock, NULL);
+
+    if (ipx_utils_buf_region_add(chunks->mem, chunks->mem_size, &buf_chunks_release, chunks)
+            != IPX_OK) {
+        munmap(chunks->mem, chunks->mem_size);
+        pthread_mutex_destroy(&chunks->lock);
+        free(chunks->chunk_refs);
+        free(chunks->next);
+        free(chunks);
+        return NULL;
+    }
+
+    return chunks;
+}
+
+void
+ipx_utils_chunks_destroy(ipx_utils_chunks_t *chunks)
+{
+    if (chunks != NULL && __atomic_sub_fetch(&chunks->refs, 1U, __ATOMIC_ACQ_REL) == 0) {
+        buf_chunks_free(chunks);
+    }
+}
+
+void *
+ipx_utils_chunks_take(ipx_utils_chunks_t *chunks)
+{
+    pthread_mutex_lock(&chunks->lock);
+    if (chunks->free == BUF_CHUNK_NONE) {
+        // Take all released chunks at once (no ABA problem as they are never taken one by one)
+        chunks->free = __atomic_exchange_n(&chunks->released, BUF_CHUNK_NONE, __ATOMIC_ACQUIRE);
+    }
+
+    const uint32_t idx = chunks->free;
+    if (idx != BUF_CHUNK_NONE) {
+        chunks->free = __atomic_load_n(&chunks->next[idx], __ATOMIC_RELAXED);
+    }
+    pthread_mutex_unlock(&chunks->lock);
+
+    if (idx == BUF_CHUNK_NONE) {
+        return NULL;
+    }
+
+    __atomic_store_n(&chunks->chunk_refs[idx], 1U, __ATOMIC_RELAXED);
+    __atomic_add_fetch(&chunks->refs, 1U, __ATOMIC_RELAXED);
+    return chunks->mem + (size_t) idx * chunks->chunk_size;
+}
+
+void *
+ipx_utils_chunks_slice(ipx_utils_chunks_t *chunks, void *ptr)
+{
+    const uint32_t idx = (uint32_t) (((uint8_t *) ptr - chunks->mem) / chunks->chunk_size);
+    __atomic_add_fetch(&chunks->chunk_refs[idx], 1U, __ATOMIC_RELAXED);
+    return ptr;
+}
+
+/** Reference counted file mapping                                                  */
+struct ipx_utils_fmap {
+    /** Start of the mapping                                                        */
+    uint8_t *mem;
+    /** Size of the mapping                                                         */
+    size_t mem_size;
+    /** References of the mapping (the creator and slices in use, atomic)           */
+    uint32_t refs;
+};
+
+/**
+ * \brief Release the memory of a file mapping (called by the last reference)
+ * \param[in] map File mapping
+ */
+static void
+buf_fmap_free(ipx_utils_fmap_t *map)
+{
+    ipx_utils_buf_region_remove(map->mem);
+    munmap(map->mem, map->mem_size);
+    free(map);
+}
+
+/**
+ * \brief Release a slice of a file mapping (see ipx_utils_buf_region_add())
+ * \param[in] ptr Pointer into the mapping
+ * \param[in] arg File mapping
+ */
+static void
+buf_fmap_release(void *ptr, void *arg)
+{
+    ipx_utils_fmap_t *map = arg;
+    (void) ptr;
+
+    if (__atomic_sub_fetch(&map->refs, 1U, __ATOMIC_ACQ_REL) == 0) {
+        buf_fmap_free(map);
+    }
+}
+
+ipx_utils_fmap_t *
+ipx_utils_fmap_create(int fd, size_t *size)
+{
+    struct stat info;
+    if (fstat(fd, &info) != 0) {
+        return NULL;
+    }
+
+    if (info.st_size <= 0) {
+        errno = EINVAL;
+        return NULL;
+    }
+
+    ipx_utils_fmap_t *map = calloc(1, sizeof(*map));
+    if (!map) {
+        return NULL;
+    }
+
+    // Writable, so that plugins can modify messages in place (copy-on-write)
+    map->mem_size = (size_t) info.st_size;
+    void *mem = mmap(NULL, map->mem_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    if (mem == MAP_FAILED) {
+        free(map);
+        return NULL;
+    }
+
+    map->mem = mem;
+    map->refs = 1;
+    (void) madvise(map->mem, map->mem_size, MADV_SEQUENTIAL);
+
+    if (ipx_utils_buf_region_add(map->mem, map->mem_size, &buf_fmap_release, map) != IPX_OK) {
+        munmap(map->mem, map->mem_size);
+        free(map);
+        errno = ENOSPC;
+        return NULL;
+    }
+
+    *size = map->mem_size;
+    return map;
+}
+
+void
+ipx_utils_fmap_destroy(ipx_utils_fmap_t *map)
+{
+    if (map != NULL && __atomic_sub_fetch(&map->refs, 1U, __ATOMIC_ACQ_REL) == 0) {
+        buf_fmap_free(map);
+    }
+}
+
+const uint8_t *
+ipx_utils_fmap_data(const ipx_utils_fmap_t *map)
+{
+    return map->mem;
+}
+
+void *
+ipx_utils_fmap_slice(ipx_utils_fmap_t *map, const uint8_t *ptr)
+{
+    __atomic_add_fetch(&map->refs, 1U, __ATOMIC_RELAXED);
+    return (void *) ptr;
+}
@@ -44,14 +44,21 @@
 #include <iostream>
 #include <string>
 #include <cstdlib>
+#include <cctype>
+#include <cinttypes>
+#include <fstream>
+#include <algorithm>
+#include <chrono>
 #include <dlfcn.h>
 #include <signal.h>
+#include <sched.h> // CPU_SETSIZE
 
 #include "configurator.hpp"
 #include "extensions.hpp"
 
 extern "C" {
 #include "../message_terminate.h"
+#include "../plugin_fork.h"
 #include "../plugin_parser.h"
 #include "../plugin_output_mgr.h"
 #include "../verbose.h"
@@ -62,6 +69,19 @@ extern "C" {
 /** Component identification (for log) */
 static const char *comp_str = "Configurator";
 
+/** Description of the internal branch point (see branch_points())                               */
+static const struct ipx_ctx_callbacks fork_callbacks = {
+    // Static plugin, no library handles
+    nullptr,
+    &ipx_plugin_fork_info,
+    // Only basic functions
+    &ipx_plugin_fork_init,
+    &ipx_plugin_fork_destroy,
+    nullptr, // No getter
+    &ipx_plugin_fork_process,
+    nullptr  // No feedback
+};
+
 /**
  * @brief Terminating signal handler
  * @param[in] sig Signal
@@ -97,10 +117,51 @@ termination_handler(int sig)
     errno = errno_backup;
 }
 
+/**
+ * @brief Reconfiguration signal handler
+ * @param[in] sig Signal
+ */
+static void
+reconf_handler(int sig)
+{
+    (void) sig;
+
+    // In case we change 'errno' (e.g. write())
+    int errno_backup = errno;
+    if (ipx_cpipe_send_reconf(IPX_CPIPE_TYPE_RECONF_START) != IPX_OK) {
+        static const char *msg = "ERROR: Signal handler: failed to send a reconfiguration request";
+        write(STDOUT_FILENO, msg, strlen(msg));
+    }
+
+    errno = errno_backup;
+}
+
+/**
+ * @brief Statistics signal handler
+ * @param[in] sig Signal
+ */
+static void
+stats_handler(int sig)
+{
+    (void) sig;
+
+    // In case we change 'errno' (e.g. write())
+    int errno_backup = errno;
+    if (ipx_cpipe_send_stats() != IPX_OK) {
+        static const char *msg = "ERROR: Signal handler: failed to send a statistics request";
+        write(STDOUT_FILENO, msg, strlen(msg));
+    }
+
+    errno = errno_backup;
+}
+
 ipx_configurator::ipx_configurator()
 {
     m_iemgr = nullptr;
     m_ring_size = RING_DEF_SIZE;
+    m_ring_max = 0;
+    m_stats_interval = 0;
+    m_output_bcast = false;
 
     // Create a configuration pipe
     if (ipx_cpipe_init() != IPX_OK) {
@@ -118,6 +179,16 @@ ipx_configurator::ipx_configurator()
     if (sigaction(SIGTERM, &sa, NULL) == -1 || sigaction(SIGINT, &sa, NULL) == -1) {
         throw std::runtime_error("Failed to register termination signal handlers!");
     }
+
+    sa.sa_handler = reconf_handler;
+    if (sigaction(SIGHUP, &sa, NULL) == -1) {
+        throw std::runtime_error("Failed to register a reconfiguration signal handler!");
+    }
+
+    sa.sa_handler = stats_handler;
+    if (sigaction(SIGUSR1, &sa, NULL) == -1) {
+        throw std::runtime_error("Failed to register a statistics signal handler!");
+    }
 }
 
 ipx_configurator::~ipx_configurator()
@@ -134,6 +205,8 @@ ipx_configurator::~ipx_configurator()
     sa.sa_handler = SIG_DFL;
     sigaction(SIGTERM, &sa, NULL);
     sigaction(SIGINT, &sa, NULL);
+    sigaction(SIGHUP, &sa, NULL);
+    sigaction(SIGUSR1, &sa, NULL);
 
     // Destroy the configuration pipe
     ipx_cpipe_destroy();
@@ -219,6 +292,258 @@ ipx_configurator::verbosity_str2level(const std::string &verb)
     }
 }
 
+/**
+ * \brief Convert a string to corresponding type of a ring buffer
+ * \param[in] type String
+ * \return Type of the ring buffer
+ */
+enum ipx_ring_type
+ipx_configurator::ring_str2type(const std::string &type)
+{
+    if (type.empty() || strcasecmp(type.c_str(), "default") == 0
+            || strcasecmp(type.c_str(), "block") == 0) {
+        return IPX_RING_TYPE_BLOCK;
+    } else if (strcasecmp(type.c_str(), "lockfree") == 0) {
+        return IPX_RING_TYPE_LOCKFREE;
+    } else {
+        throw std::invalid_argument("Invalid type of a ring buffer!");
+    }
+}
+
+/**
+ * \brief Convert a string to corresponding waiting strategy of a ring buffer
+ * \param[in] wait String
+ * \return Waiting strategy of the ring buffer
+ */
+enum ipx_ring_wait
+ipx_configurator::ring_str2wait(const std::string &wait)
+{
+    if (wait.empty() || strcasecmp(wait.c_str(), "default") == 0) {
+        return IPX_RING_WAIT_DEFAULT;
+    } else if (strcasecmp(wait.c_str(), "park") == 0) {
+        return IPX_RING_WAIT_PARK;
+    } else if (strcasecmp(wait.c_str(), "adaptive") == 0) {
+        return IPX_RING_WAIT_ADAPTIVE;
+    } else if (strcasecmp(wait.c_str(), "spin") == 0) {
+        return IPX_RING_WAIT_SPIN;
+    } else {
+        throw std::invalid_argument("Invalid waiting strategy of a ring buffer!");
+    }
+}
+
+/**
+ * \brief Convert a string to corresponding operation mode of a pool of IPFIX Messages
+ * \param[in] mode String
+ * \return Operation mode of the pool
+ */
+enum ipx_msg_pool_mode
+ipx_configurator::pool_str2mode(const std::string &mode)
+{
+    if (mode.empty() || strcasecmp(mode.c_str(), "default") == 0
+            || strcasecmp(mode.c_str(), "fixed") == 0) {
+        return IPX_MSG_POOL_FIXED;
+    } else if (strcasecmp(mode.c_str(), "adaptive") == 0) {
+        return IPX_MSG_POOL_ADAPTIVE;
+    } else if (strcasecmp(mode.c_str(), "disabled") == 0) {
+        return IPX_MSG_POOL_DISABLED;
+    } else {
+        throw std::invalid_argument("Invalid mode of a message pool!");
+    }
+}
+
+/**
+ * \brief Convert a string to corresponding overflow policy of an output instance
+ * \param[in] policy String
+ * \return Overflow policy
+ */
+enum ipx_output_mgr_overflow
+ipx_configurator::overflow_str2policy(const std::string &policy)
+{
+    if (policy.empty() || strcasecmp(policy.c_str(), "default") == 0
+            || strcasecmp(policy.c_str(), "block") == 0) {
+        return IPX_OUTPUT_MGR_OVERFLOW_BLOCK;
+    } else if (strcasecmp(policy.c_str(), "drop-newest") == 0) {
+        return IPX_OUTPUT_MGR_OVERFLOW_DROP;
+    } else if (strcasecmp(policy.c_str(), "spill") == 0) {
+        return IPX_OUTPUT_MGR_OVERFLOW_SPILL;
+    } else {
+        throw std::invalid_argument("Invalid overflow policy of an output instance!");
+    }
+}
+
+/**
+ * \brief Convert a string to corresponding identification of a branch of the pipeline
+ *
+ * The branch is either a number or a name of a branch defined by branch_points().
+ * \param[in] branch String
+ * \param[in] def    Default value (if the string is empty)
+ * \return Identification of the branch
+ * \throw invalid_argument if the number is out of range or the name is not defined
+ */
+int
+ipx_configurator::branch_str2id(const std::string &branch, int def)
+{
+    if (branch.empty()) {
+        return def;
+    }
+
+    if (std::all_of(branch.begin(), branch.end(), ::isdigit)) {
+        if (branch.size() > 5 || std::stoul(branch) > UINT16_MAX) {
+            throw std::invalid_argument("Branch '" + branch + "' is out of range!");
+        }
+        return static_cast<int>(std::stoul(branch));
+    }
+
+    auto it = m_branches.find(branch);
+    if (it == m_branches.end()) {
+        throw std::invalid_argument("Branch '" + branch + "' is not defined (new branches "
+            "cannot be added during runtime reconfiguration)!");
+    }
+
+    return it->second;
+}
+
+/**
+ * \brief Assign identifications to named branches of the pipeline and find their branch points
+ *
+ * Each named branch forks from the main branch right before the first intermediate instance
+ * restricted to the branch (i.e. intermediate instances before it don't affect the branch) or
+ * before the output manager, if only output instances are restricted to the branch. Named
+ * branches get identifications from the top of the range (65535, 65534, ...) so they don't
+ * collide with small numbers used by the branch plugin.
+ * \param[in] model Configuration model
+ * \return Position of each branch point (index of the following intermediate instance) and
+ *   name of the branch
+ */
+std::multimap<size_t, std::string>
+ipx_configurator::branch_points(const ipx_config_model &model)
+{
+    std::multimap<size_t, std::string> result;
+    m_branches.clear();
+
+    auto add = [&](const std::string &branch, size_t pos) {
+        if (branch.empty() || std::all_of(branch.begin(), branch.end(), ::isdigit)
+                || m_branches.count(branch) != 0) {
+            return;
+        }
+
+        uint16_t id = static_cast<uint16_t>(UINT16_MAX - m_branches.size());
+        m_branches.emplace(branch, id);
+        result.emplace(pos, branch);
+
+        const std::string next = (pos < model.inters.size())
+            ? "the intermediate instance '" + model.inters[pos].name + "'"
+            : "the output manager";
+        IPX_INFO(comp_str, "Branch '%s' (id %" PRIu16 ") forks from the main branch before %s.",
+            branch.c_str(), id, next.c_str());
+    };
+
+    for (size_t i = 0; i < model.inters.size(); ++i) {
+        add(model.inters[i].branch, i);
+    }
+    for (const auto &output : model.outputs) {
+        add(output.branch, model.inters.size());
+    }
+
+    return result;
+}
+
+/**
+ * \brief Parse a list of CPUs (e.g. "0-3,8")
+ * \param[in]  list List of CPUs
+ * \param[out] cpus Sorted CPU indexes without duplicates
+ * \return True on success, false if the list is malformed
+ */
+static bool
+cpu_list_parse(const std::string &list, std::vector<uint16_t> &cpus)
+{
+    cpus.clear();
+    std::size_t pos = 0;
+    while (pos < list.size()) {
+        std::size_t end = list.find(',', pos);
+        if (end == std::string::npos) {
+            end = list.size();
+        }
+
+        std::string item = list.substr(pos, end - pos);
+        item.erase(0, item.find_first_not_of(" \t\n"));
+        item.erase(item.find_last_not_of(" \t\n") + 1);
+        pos = end + 1;
+
+        unsigned long first, last;
+        char *ptr;
+        if (item.empty() || !isdigit(item[0])) {
+            return false;
+        }
+        first = strtoul(item.c_str(), &ptr, 10);
+        last = first;
+        if (*ptr == '-') {
+            if (!isdigit(ptr[1])) {
+                return false;
+            }
+            last = strtoul(ptr + 1, &ptr, 10);
+        }
+        if (*ptr != '\0' || first > last || last >= CPU_SETSIZE) {
+            return false;
+        }
+
+        for (unsigned long cpu = first; cpu <= last; ++cpu) {
+            cpus.push_back(static_cast<uint16_t>(cpu));
+        }
+    }
+
+    std::sort(cpus.begin(), cpus.end());
+    cpus.erase(std::unique(cpus.begin(), cpus.end()), cpus.end());
+    return !cpus.empty();
+}
+
+/**
+ * \brief Convert CPU affinity and NUMA node of an instance to a list of allowed CPUs
+ *
+ * If both parameters are defined, only CPUs of the list that belong to the NUMA node are
+ * allowed.
+ * \param[in] list List of CPUs (if empty, not restricted)
+ * \param[in] node NUMA node (if negative, not restricted)
+ * \return Allowed CPUs (empty, if not restricted)
+ * \throw invalid_argument if the list is malformed, the node doesn't exist or no CPU is allowed
+ */
+std::vector<uint16_t>
+ipx_configurator::affinity_str2cpus(const std::string &list, int node)
+{
+    std::vector<uint16_t> cpus;
+    if (!list.empty() && !cpu_list_parse(list, cpus)) {
+        throw std::invalid_argument("Invalid list of CPUs '" + list + "'!");
+    }
+
+    if (node < 0) {
+        return cpus;
+    }
+
+    // CPUs of the NUMA node
+    const std::string path = "/sys/devices/system/node/node" + std::to_string(node) + "/cpulist";
+    std::ifstream file(path);
+    std::string node_list;
+    std::vector<uint16_t> node_cpus;
+    if (!file || !std::getline(file, node_list) || !cpu_list_parse(node_list, node_cpus)) {
+        throw std::invalid_argument("Unable to get CPUs of the NUMA node "
+            + std::to_string(node) + " (failed to read '" + path + "')!");
+    }
+
+    if (list.empty()) {
+        return node_cpus;
+    }
+
+    std::vector<uint16_t> result;
+    std::set_intersection(cpus.begin(), cpus.end(), node_cpus.begin(), node_cpus.end(),
+        std::back_inserter(result));
+    if (result.empty()) {
+        throw std::invalid_argument("None of CPUs '" + list + "' belongs to the NUMA node "
+            + std::to_string(node) + "!");
+    }
+
+    return result;
+}
+
 void
 ipx_configurator::iemgr_set_dir(const std::string &path)
 {
@@ -226,14 +551,62 @@ ipx_configurator::iemgr_set_dir(const std::string &path)
 }
 
 void
-ipx_configurator::set_buffer_size(uint32_t size)
+ipx_configurator::set_buffer_size(uint32_t size, uint32_t max)
 {
     if (size < RING_MIN_SIZE) {
         throw std::invalid_argument("Size of ring buffers must be at least "
             + std::to_string(RING_MIN_SIZE) + " records.");
     }
 
+    if (max != 0 && max < size) {
+        throw std::invalid_argument("Maximal size of ring buffers must be at least their "
+            "initial size.");
+    }
+
     m_ring_size = size;
+    m_ring_max = (max > size) ? max : 0;
+}
+
+void
+ipx_configurator::set_stats_interval(uint32_t sec)
+{
+    m_stats_interval = sec;
+}
+
+void
+ipx_configurator::set_output_broadcast(bool en)
+{
+    m_output_bcast = en;
+}
+
+void
+ipx_configurator::set_latency(bool en)
+{
+    ipx_latency_enable(en);
+}
+
+void
+ipx_configurator::set_memory(bool en)
+{
+    ipx_mem_enable(en);
+}
+
+/**
+ * \brief Print runtime statistics of all running instances
+ * \param[in] interval Time elapsed since the previous call (in seconds)
+ */
+void
+ipx_configurator::stats_print(double interval)
+{
+    for (auto &it : m_running_inputs) {
+        it->stats_print(interval);
+    }
+    for (auto &it : m_running_inter) {
+        it->stats_print(interval);
+    }
+    for (auto &it : m_running_outputs) {
+        it->stats_print(interval);
+    }
 }
 
 void
@@ -250,27 +623,83 @@ ipx_configurator::startup(const ipx_config_model &model)
     std::vector<std::unique_ptr<ipx_instance_output> > outputs;
     std::vector<std::unique_ptr<ipx_instance_intermediate> > inters;
     std::vector<std::unique_ptr<ipx_instance_input> > inputs;
+    // Parameters of intermediate instances (branch points are described only by the branch)
+    std::vector<std::pair<const ipx_plugin_inter *, uint16_t> > inters_cfg;
+    // Named branches of the pipeline (must be known before instances are restricted to them)
+    std::multimap<size_t, std::string> forks = branch_points(model);
+
+    auto fork_add = [&](size_t pos) {
+        auto range = forks.equal_range(pos);
+        for (auto it = range.first; it != range.second; ++it) {
+            std::string name = "Branch point '" + it->second + "'";
+            inters.emplace_back(new ipx_instance_intermediate(name, &fork_callbacks, m_ring_size));
+            inters.back()->set_branch(0); // Copy only messages of the main branch
+            inters_cfg.emplace_back(nullptr, m_branches.at(it->second));
+        }
+    };
 
     // Phase 1. Create all instances (i.e. find plugins)
     for (const auto &output : model.outputs) {
         ipx_plugin_mgr::plugin_ref *ref = plugins.plugin_get(IPX_PT_OUTPUT, output.plugin);
-        outputs.emplace_back(new ipx_instance_output(output.name, ref, m_ring_size));
+        enum ipx_ring_type rtype = ring_str2type(output.ring_type);
+        enum ipx_ring_wait rwait = ring_str2wait(output.ring_wait);
+        outputs.emplace_back(new ipx_instance_output(output.name, ref, m_ring_size, rtype, rwait));
+        outputs.back()->set_affinity(affinity_str2cpus(output.cpu_affinity, output.numa_node),
+            output.numa_node);
+        outputs.back()->set_branch(static_cast<uint16_t>(branch_str2id(output.branch, 0)));
     }
 
-    for (const auto &inter : model.inters) {
-        ipx_plugin_mgr::plugin_ref *ref = plugins.plugin_get(IPX_PT_INTERMEDIATE, inter.plugin);
-        inters.emplace_back(new ipx_instance_intermediate(inter.name, ref, m_ring_size));
+    for (size_t i = 0; i < model.inters.size(); ++i) {
+        const auto &inter = model.inters[i];
+        fork_add(i);
+
+        enum ipx_ring_type rtype = ring_str2type(inter.ring_type);
+        enum ipx_ring_wait rwait = ring_str2wait(inter.ring_wait);
+        if (inter.threads > 1) {
+            // Multiple replicas of the instance behind a dispatcher
+            inters.emplace_back(new ipx_instance_sharded(inter.name, plugins, inter.plugin,
+                inter.threads, m_ring_size, rtype, rwait));
+        } else {
+            ipx_plugin_mgr::plugin_ref *ref = plugins.plugin_get(IPX_PT_INTERMEDIATE, inter.plugin);
+            inters.emplace_back(new ipx_instance_intermediate(inter.name, ref, m_ring_size, rtype,
+                rwait));
+        }
+
+        inters.back()->set_affinity(affinity_str2cpus(inter.cpu_affinity, inter.numa_node),
+            inter.numa_node);
+        inters.back()->set_branch(branch_str2id(inter.branch, -1));
+        inters_cfg.emplace_back(&inter, 0);
     }
+    fork_add(model.inters.size());
 
     for (const auto &input : model.inputs) {
         ipx_plugin_mgr::plugin_ref *ref = plugins.plugin_get(IPX_PT_INPUT, input.plugin);
-        inputs.emplace_back(new ipx_instance_input(input.name, ref, m_ring_size));
+        enum ipx_ring_type rtype = ring_str2type(input.ring_type);
+        enum ipx_ring_wait rwait = ring_str2wait(input.ring_wait);
+        inputs.emplace_back(new ipx_instance_input(input.name, ref, m_ring_size, rtype, rwait,
+            input.parser_threads));
+        inputs.back()->set_msg_pool(pool_str2mode(input.msg_pool));
+        inputs.back()->set_parser_limit(input.parser_max_sources);
+        inputs.back()->set_parser_state(input.parser_state_file, input.parser_state_interval);
+        inputs.back()->set_parser_pending(input.parser_pending_size, input.parser_pending_timeout);
+        inputs.back()->set_affinity(affinity_str2cpus(input.cpu_affinity, input.numa_node),
+            input.numa_node);
     }
 
     // Insert the output manager as the last intermediate plugin
     ipx_instance_outmgr *output_manager = new ipx_instance_outmgr(m_ring_size);
     inters.emplace_back(output_manager);
 
+    if (m_ring_max != 0) {
+        // Input buffers of intermediate and output instances adapt their capacity
+        for (auto &inter : inters) {
+            inter->set_buffer_max(m_ring_max);
+        }
+        for (auto &output : outputs) {
+            output->set_buffer_max(m_ring_max);
+        }
+    }
+
     IPX_DEBUG(comp_str, "All plugins have been successfully loaded.", '\0');
 
     // Phase 2. Connect instances (input -> inter -> ... -> inter -> output manager -> output)
@@ -285,6 +714,12 @@ ipx_configurator::startup(const ipx_config_model &model)
         from->connect_to(*to);
     }
 
+    if (m_output_bcast || outputs.size() > IPX_OUTPUT_MGR_MAX_DEST) {
+        // Write messages for all output instances only once
+        IPX_INFO(comp_str, "Output instances are connected using a broadcast ring buffer.", '\0');
+        output_manager->set_broadcast(m_ring_size);
+    }
+
     for (size_t i = 0; i < model.outputs.size(); ++i) {
         // First initialize ODID filter, if necessary
         ipx_instance_output *instance = outputs[i].get();
@@ -294,7 +729,23 @@ ipx_configurator::startup(const ipx_config_model &model)
         }
 
         // Connect the output manager and the output instance
-        output_manager->connect_to(*instance);
+        output_manager->connect_to(*instance, overflow_str2policy(cfg.overflow_policy));
+    }
+
+    // Pack IPFIX Messages for the output manager, if any output instance can process batches
+    bool batching = false;
+    for (auto &output : outputs) {
+        batching |= output->accepts_batch();
+    }
+
+    if (batching && inters.size() > 1) {
+        // The last intermediate instance before the output manager
+        inters[inters.size() - 2]->set_batching(true);
+    } else if (batching) {
+        // No intermediate instances, the output manager is connected directly to parsers
+        for (auto &input : inputs) {
+            input->set_parser_batching(true);
+        }
     }
 
     // Phase 3. Initialize all instances (call constructors)
@@ -305,10 +756,33 @@ ipx_configurator::startup(const ipx_config_model &model)
     }
 
     output_manager->init(m_iemgr, ipx_verb_level_get());
-    for (size_t i = 0; i < model.inters.size(); ++i) {
+
+    // Relay mode, if no instance needs references to Data Records (declared by plugin info flags
+    // or by output instances during init)
+    bool relay = true;
+    for (auto &inter : inters) {
+        relay &= inter->accepts_relay();
+    }
+    for (auto &output : outputs) {
+        relay &= output->accepts_relay();
+    }
+
+    if (relay) {
+        IPX_INFO(comp_str, "Parsers only count Data Records (relay mode).", '\0');
+        for (auto &input : inputs) {
+            input->set_parser_relay(true);
+        }
+    }
+
+    for (size_t i = 0; i < inters_cfg.size(); ++i) {
         ipx_instance_intermediate *instance = inters[i].get();
-        const ipx_plugin_inter &cfg = model.inters[i];
-        instance->init(cfg.params, m_iemgr, verbosity_str2level(cfg.verbosity));
+        const ipx_plugin_inter *cfg = inters_cfg[i].first;
+        if (!cfg) {
+            // Branch point (the identification of the branch is passed as parameters)
+            instance->init(std::to_string(inters_cfg[i].second), m_iemgr, ipx_verb_level_get());
+            continue;
+        }
+        instance->init(cfg->params, m_iemgr, verbosity_str2level(cfg->verbosity));
     }
 
     for (size_t i = 0; i < model.inputs.size(); ++i) {
@@ -360,6 +834,9 @@ ipx_configurator::startup(const ipx_config_model &model)
     m_running_inputs = std::move(inputs);
     m_running_inter = std::move(inters);
     m_running_outputs = std::move(outputs);
+    m_output_mgr = output_manager;
+    m_relay = relay;
+    m_model = model;
 }
 
 void ipx_configurator::cleanup()
@@ -368,6 +845,9 @@ void ipx_configurator::cleanup()
     m_running_inputs.clear();
     m_running_inter.clear();
     m_running_outputs.clear();
+    m_reconf.added.clear();
+    m_output_mgr = nullptr;
+    m_relay = false;
 
     IPX_DEBUG(comp_str, "Cleanup complete!", '\0');
 }
@@ -377,6 +857,12 @@ ipx_configurator::termination_handle(const struct ipx_cpipe_req &req, ipx_contro
 {
     // First of all, check if termination process has been completed
     if (req.type == IPX_CPIPE_TYPE_TERM_DONE) {
+        if (m_detach_sent > 0) {
+            // An output instance disconnected during a reconfiguration has been terminated
+            m_detach_sent--;
+            return false;
+        }
+
         if (m_state != STATUS::STOP_SLOW && m_state != STATUS::STOP_FAST) {
             IPX_ERROR(comp_str, "[internal] Got a termination done notification, but the "
                 "termination process is not in progress!", '\0');
@@ -432,6 +918,8 @@ ipx_configurator::termination_handle(const struct ipx_cpipe_req &req, ipx_contro
     /* Send a termination message (if it hasn't been send yet) and stop processing Data and Session
      * request by selected instances (if any) */
     switch (m_state) {
+    case STATUS::RECONF:
+        // The pending reconfiguration will be finished, new output instances get the message too
     case STATUS::RUNNING:
         /* The first request to stop the collector...
          * A termination message must be delivered to all input plugins and some plugins must
@@ -530,7 +1018,7 @@ ipx_configurator::termination_stop_partly(const ipx_ctx_t *ctx)
     // Stop intermediate plugins
     for (auto &it : m_running_inter) {
         it->set_processing(false);
-        if (it->get_ctx() == ctx) {
+        if (it->owns_ctx(ctx)) {
             return;
         }
     }
@@ -568,6 +1056,236 @@ ipx_configurator::termination_send_msg()
     m_term_sent = m_running_inputs.size();
 }
 
+/**
+ * \brief Start a runtime reconfiguration
+ *
+ * Get a new configuration model from the controller and, if only output instances have been
+ * changed, prepare and start new output instances and send a reconfiguration message to
+ * the pipeline. If anything fails, the collector keeps running with the previous configuration.
+ * \param[in] ctrl Configuration controller
+ */
+void
+ipx_configurator::reconf_start(ipx_controller *ctrl)
+{
+    if (m_state != STATUS::RUNNING) {
+        IPX_WARNING(comp_str, "Reconfiguration request ignored (another reconfiguration or "
+            "termination is in progress).", '\0');
+        return;
+    }
+
+    IPX_INFO(comp_str, "Reconfiguration request has been received.", '\0');
+    try {
+        ipx_config_model model = ctrl->model_get();
+        reconf_prepare(model);
+    } catch (const std::exception &ex) {
+        ctrl->reconf_after(ipx_controller::OP_STATUS::FAILED, ex.what());
+        return;
+    }
+
+    if (m_reconf.origin.empty()) {
+        // Nothing to do
+        ctrl->reconf_after(ipx_controller::OP_STATUS::SUCCESS, "No changes");
+        return;
+    }
+
+    // Send the reconfiguration message through the pipeline (only once is enough)
+    ipx_msg_terminate_t *msg = ipx_msg_terminate_create(IPX_MSG_TERMINATE_RECONF);
+    if (!msg) {
+        IPX_ERROR(comp_str, "Failed to create a reconfiguration message. The collector cannot "
+            "be reconfigured! (%s:%d)", __FILE__, __LINE__);
+        abort();
+    }
+
+    ipx_fpipe_write(m_running_inputs.front()->get_feedback(), ipx_msg_terminate2base(msg));
+    IPX_DEBUG(comp_str, "Reconfiguration message sent! Waiting for instances to apply it.", '\0');
+    m_state = STATUS::RECONF;
+}
+
+/**
+ * \brief Prepare a runtime reconfiguration
+ *
+ * Only output instances can be changed, i.e. all input and intermediate instances (including
+ * parsers and their template state) are kept untouched. Output instances with unchanged
+ * configuration are kept running, new and modified output instances are created, initialized
+ * and started. Finally, a new list of destinations is prepared for the output manager.
+ * \note If the model is the same as the current one, nothing is prepared.
+ * \param[in] model New configuration model
+ * \throw runtime_error if the model cannot be applied (no changes are made)
+ */
+void
+ipx_configurator::reconf_prepare(const ipx_config_model &model)
+{
+    model_check(model);
+    if (!(model.inputs == m_model.inputs) || !(model.inters == m_model.inters)) {
+        throw std::runtime_error("Only output instances can be changed at runtime, restart "
+            "the collector to change input or intermediate instances!");
+    }
+
+    if (m_output_mgr->is_broadcast()) {
+        throw std::runtime_error("Output instances connected using a broadcast ring buffer "
+            "cannot be changed at runtime!");
+    }
+
+    if (model.outputs.size() > IPX_OUTPUT_MGR_MAX_DEST) {
+        throw std::runtime_error("Too many output instances, restart the collector to use "
+            "a broadcast ring buffer!");
+    }
+
+    if (model.outputs == m_model.outputs) {
+        // Nothing has changed
+        return;
+    }
+
+    // Find output instances that are kept running
+    std::vector<int> origin;
+    for (const auto &output : model.outputs) {
+        int idx = -1;
+        for (size_t i = 0; i < m_model.outputs.size(); ++i) {
+            if (m_model.outputs[i] == output) {
+                idx = static_cast<int>(i);
+                break;
+            }
+        }
+        origin.push_back(idx);
+    }
+
+    // Create and initialize new output instances (not started yet, they can be safely destroyed)
+    std::vector<std::unique_ptr<ipx_instance_output> > added;
+    for (size_t i = 0; i < model.outputs.size(); ++i) {
+        if (origin[i] >= 0) {
+            continue;
+        }
+
+        const ipx_plugin_output &cfg = model.outputs[i];
+        ipx_plugin_mgr::plugin_ref *ref = plugins.plugin_get(IPX_PT_OUTPUT, cfg.plugin);
+        enum ipx_ring_type rtype = ring_str2type(cfg.ring_type);
+        enum ipx_ring_wait rwait = ring_str2wait(cfg.ring_wait);
+        added.emplace_back(new ipx_instance_output(cfg.name, ref, m_ring_size, rtype, rwait));
+        ipx_instance_output *instance = added.back().get();
+        instance->set_affinity(affinity_str2cpus(cfg.cpu_affinity, cfg.numa_node),
+            cfg.numa_node);
+        if (m_ring_max != 0) {
+            instance->set_buffer_max(m_ring_max);
+        }
+        instance->set_branch(static_cast<uint16_t>(branch_str2id(cfg.branch, 0)));
+        if (cfg.odid_type != IPX_ODID_FILTER_NONE) {
+            instance->set_filter(cfg.odid_type, cfg.odid_expression);
+        }
+        instance->init(cfg.params, m_iemgr, verbosity_str2level(cfg.verbosity));
+        if (m_relay && !instance->accepts_relay()) {
+            throw std::runtime_error("Output instance '" + cfg.name + "' requires Data Records "
+                "which are not available in relay mode, restart the collector to add it!");
+        }
+    }
+
+    // Data Record extensions of running instances cannot change
+    ipx_cfg_extensions ext_mgr;
+    size_t pos = 0; // Position of an instance in the collector pipeline
+    for (auto &input : m_running_inputs) {
+        input->extensions_register(&ext_mgr, pos);
+    }
+
+    pos++;
+    for (auto &inter : m_running_inter) {
+        inter->extensions_register(&ext_mgr, pos);
+        pos++;
+    }
+
+    size_t added_idx = 0;
+    std::vector<std::pair<ipx_instance_output *, enum ipx_output_mgr_overflow> > dests;
+    for (size_t i = 0; i < model.outputs.size(); ++i) {
+        ipx_instance_output *instance = (origin[i] >= 0)
+            ? m_running_outputs[origin[i]].get() : added[added_idx++].get();
+        instance->extensions_register(&ext_mgr, pos);
+        dests.emplace_back(instance, overflow_str2policy(model.outputs[i].overflow_policy));
+    }
+
+    ext_mgr.resolve();
+
+    // Start new output instances
+    for (size_t i = 0; i < added.size(); ++i) {
+        try {
+            added[i]->extensions_resolve(&ext_mgr);
+            added[i]->start();
+        } catch (...) {
+            // Already running instances must be stopped before they are destroyed
+            for (size_t j = 0; j < i; ++j) {
+                added[j]->terminate();
+                m_detach_sent++;
+            }
+            throw;
+        }
+    }
+
+    try {
+        m_output_mgr->reconf_prepare(dests);
+    } catch (...) {
+        for (auto &instance : added) {
+            instance->terminate();
+            m_detach_sent++;
+        }
+        throw;
+    }
+
+    m_reconf.model = model;
+    m_reconf.added = std::move(added);
+    m_reconf.origin = std::move(origin);
+}
+
+/**
+ * \brief Finish a runtime reconfiguration
+ *
+ * The output manager has already switched to the new output instances, therefore, disconnected
+ * output instances are terminated and destroyed.
+ * \param[in] ctrl Configuration controller
+ */
+void
+ipx_configurator::reconf_finish(ipx_controller *ctrl)
+{
+    if (m_reconf.origin.empty()) {
+        IPX_ERROR(comp_str, "[internal] Got a reconfiguration done notification, but "
+            "the reconfiguration process is not in progress!", '\0');
+        return;
+    }
+
+    m_output_mgr->reconf_finish();
+
+    // Sort output instances by the new model
+    std::vector<std::unique_ptr<ipx_instance_output> > outputs;
+    size_t added_idx = 0;
+    for (int idx : m_reconf.origin) {
+        if (idx >= 0) {
+            outputs.push_back(std::move(m_running_outputs[idx]));
+        } else {
+            outputs.push_back(std::move(m_reconf.added[added_idx++]));
+        }
+    }
+
+    // Stop disconnected instances (the destructor waits until the messages are processed)
+    for (auto &instance : m_running_outputs) {
+        if (!instance) {
+            continue; // Moved
+        }
+
+        IPX_INFO(comp_str, "Stopping the output instance '%s'...", instance->get_name().c_str());
+        instance->terminate();
+        m_detach_sent++;
+        instance.reset();
+    }
+
+    m_running_outputs = std::move(outputs);
+    m_model = std::move(m_reconf.model);
+    m_reconf.model = ipx_config_model();
+    m_reconf.added.clear();
+    m_reconf.origin.clear();
+
+    if (m_state == STATUS::RECONF) {
+        m_state = STATUS::RUNNING;
+    }
+
+    ctrl->reconf_after(ipx_controller::OP_STATUS::SUCCESS, "Success");
+}
+
 int
 ipx_configurator::run(ipx_controller *ctrl)
 {
@@ -595,9 +1313,36 @@ ipx_configurator::run(ipx_controller *ctrl)
     // Collector is running -> process termination/reconfiguration requests
     m_state = STATUS::RUNNING;
     bool terminate = false;
+    const auto stats_interval = std::chrono::seconds(m_stats_interval);
+    auto stats_last = std::chrono::steady_clock::now();
+
     while (!terminate) {
         struct ipx_cpipe_req req;
-        if (ipx_cpipe_receive(&req) != IPX_OK) {
+        int rc;
+
+        if (m_stats_interval == 0) {
+            rc = ipx_cpipe_receive(&req);
+        } else {
+            // Wait for a request until it's time to print statistics
+            auto now = std::chrono::steady_clock::now();
+            auto remaining = stats_interval - (now - stats_last);
+            long timeout = std::chrono::duration_cast<std::chrono::milliseconds>(remaining).count();
+            rc = (timeout > 0) ? ipx_cpipe_receive_timed(&req, static_cast<int>(timeout))
+                : IPX_ERR_NOTFOUND;
+
+            now = std::chrono::steady_clock::now();
+            if (now - stats_last >= stats_interval) {
+                std::chrono::duration<double> elapsed = now - stats_last;
+                stats_print(elapsed.count());
+                stats_last = now;
+            }
+
+            if (rc == IPX_ERR_NOTFOUND) {
+                continue;
+            }
+        }
+
+        if (rc != IPX_OK) {
             // This is really bad -> we cannot even safely terminate the collector
             IPX_ERROR(comp_str, "Configuration pipe is broken. Terminating...", '\0');
             abort();
@@ -609,6 +1354,20 @@ ipx_configurator::run(ipx_controller *ctrl)
         case IPX_CPIPE_TYPE_TERM_DONE:
             terminate = termination_handle(req, ctrl);
             break;
+        case IPX_CPIPE_TYPE_RECONF_START:
+            reconf_start(ctrl);
+            break;
+        case IPX_CPIPE_TYPE_RECONF_DONE:
+            reconf_finish(ctrl);
+            break;
+        case IPX_CPIPE_TYPE_STATS: {
+            // Print on demand, the next periodic print covers only the rest of the interval
+            auto now = std::chrono::steady_clock::now();
+            std::chrono::duration<double> elapsed = now - stats_last;
+            stats_print(elapsed.count());
+            stats_last = now;
+            }
+            break;
         default:
             IPX_ERROR(comp_str, "Ignoring unknown configuration request!", '\0');
             continue;
@@ -43,12 +43,14 @@
 #define IPFIXCOL_CONFIGURATOR_H
 
 #include <stdint.h>
+#include <map>
 #include <vector>
 #include <memory>
 
 #include "model.hpp"
 #include "instance_input.hpp"
 #include "instance_intermediate.hpp"
+#include "instance_sharded.hpp"
 #include "instance_outmgr.hpp"
 #include "instance_output.hpp"
 #include "plugin_mgr.hpp"
@@ -87,10 +89,50 @@ public:
      iemgr_set_dir(const std::string &path);
      /**
       * @brief Define a size of ring buffers
-      * @param[in] size Size
+      *
+      * If the maximal size is greater than the size, input buffers of intermediate and output
+      * instances adapt their capacity to the load within these bounds (see
+      * ipx_ring_adaptive_set()).
+      * @param[in] size Size (initial size of adaptive buffers)
+      * @param[in] max  Maximal size of adaptive buffers (0 = adaptation disabled)
+      * @throw invalid_argument if the size or the maximal size is out of range
+      */
+     void
+     set_buffer_size(uint32_t size, uint32_t max = 0);
+     /**
+      * @brief Define an interval of printing runtime statistics of all instances
+      * @param[in] sec Interval in seconds (0 = disabled)
+      */
+     void
+     set_stats_interval(uint32_t sec);
+     /**
+      * @brief Pass messages to output instances using a single broadcast ring buffer
+      *
+      * @note The broadcast ring buffer is always used if the number of output instances
+      *   is greater than the maximum number of destinations of the output manager.
+      * @param[in] en Enable/disable (disabled by default)
+      */
+     void
+     set_output_broadcast(bool en);
+     /**
+      * @brief Measure latency of IPFIX Messages in each instance
+      *
+      * Percentiles of the latency are printed together with runtime statistics.
+      * @warning Must be called before the collector is started.
+      * @param[in] en Enable/disable (disabled by default)
       */
      void
-     set_buffer_size(uint32_t size);
+     set_latency(bool en);
+     /**
+      * @brief Account memory allocated on behalf of each instance
+      *
+      * Current and peak numbers of bytes are printed with runtime statistics and exported
+      * as metrics.
+      * @warning Must be called before the collector is started.
+      * @param[in] en Enable/disable (disabled by default)
+      */
+     void
+     set_memory(bool en);
 
      /**
       * @brief Run the collector based on a configuration from the controller
@@ -114,10 +156,17 @@ private:
         RUNNING,    ///< No configuration change in progress
         STOP_SLOW,  ///< Stop stop in progress
         STOP_FAST,  ///< Fast stop in progress
+        RECONF,     ///< Runtime reconfiguration in progress
     } m_state; ///< Configuration state
 
     /** Size of ring buffers                                                                   */
     uint32_t m_ring_size;
+    /** Maximal size of adaptive ring buffers (0 = adaptation disabled)                        */
+    uint32_t m_ring_max;
+    /** Interval of printing runtime statistics in seconds (0 = disabled)                      */
+    uint32_t m_stats_interval;
+    /** Pass messages to output instances using a broadcast ring buffer                        */
+    bool m_output_bcast;
     /** Directory with definitions of Information Elements                                     */
     std::string m_iemgr_dir;
 
@@ -131,6 +180,29 @@ private:
     std::vector<std::unique_ptr<ipx_instance_output> > m_running_outputs;
     /** Number of sent termination messages */
     size_t m_term_sent = 0;
+    /** Number of termination messages sent directly to disconnected output instances          */
+    size_t m_detach_sent = 0;
+    /** Output manager (the last running intermediate instance)                                */
+    ipx_instance_outmgr *m_output_mgr = nullptr;
+    /** Parsers only count Data Records (see ipx_ctx_relay_set())                              */
+    bool m_relay = false;
+    /** Configuration model of the running instances                                           */
+    ipx_config_model m_model;
+    /** Identifications of named branches of the pipeline (see branch_str2id())                */
+    std::map<std::string, uint16_t> m_branches;
+
+    /** Runtime reconfiguration in progress                                                    */
+    struct {
+        /** Configuration model to apply                                                       */
+        ipx_config_model model;
+        /** New (already running) output instances                                           */
+        std::vector<std::unique_ptr<ipx_instance_output> > added;
+        /**
+         * Origin of each output instance of the new model (index to the currently running
+         * output instances or -1, if the instance is the next one from the #added)
+         */
+        std::vector<int> origin;
+    } m_reconf;
 
     // Internal functions
     void
@@ -139,17 +211,41 @@ private:
     iemgr_load(const std::string dir);
     enum ipx_verb_level
     verbosity_str2level(const std::string &verb);
+    enum ipx_ring_type
+    ring_str2type(const std::string &type);
+    enum ipx_ring_wait
+    ring_str2wait(const std::string &wait);
+    enum ipx_msg_pool_mode
+    pool_str2mode(const std::string &mode);
+    enum ipx_output_mgr_overflow
+    overflow_str2policy(const std::string &policy);
+    std::vector<uint16_t>
+    affinity_str2cpus(const std::string &list, int node);
+    int
+    branch_str2id(const std::string &branch, int def);
+    std::multimap<size_t, std::string>
+    branch_points(const ipx_config_model &model);
 
     void
     startup(const ipx_config_model &model);
     void
     cleanup();
 
+    void
+    stats_print(double interval);
+
     bool
     termination_handle(const struct ipx_cpipe_req &req, ipx_controller *ctrl);
     void
     termination_send_msg();
 
+    void
+    reconf_start(ipx_controller *ctrl);
+    void
+    reconf_prepare(const ipx_config_model &model);
+    void
+    reconf_finish(ipx_controller *ctrl);
+
     void
     termination_stop_all();
     void
@@ -116,6 +116,28 @@ public:
         IPX_INFO(m_name, "Received a termination request (%s)!", msg.c_str());
     };
 
+    /**
+     * @brief Function called after a runtime reconfiguration
+     *
+     * The new configuration model is obtained using model_get(). If the reconfiguration fails,
+     * the collector keeps running with the previous configuration.
+     * @note The function should not throw any exception!
+     * @param[in] status Operation status (success/failure)
+     * @param[in] msg    Human readable result (usually a description of what went wrong)
+     */
+    virtual void
+    reconf_after(OP_STATUS status, std::string msg)
+    {
+        switch (status) {
+        case OP_STATUS::SUCCESS:
+            IPX_INFO(m_name, "Collector reconfigured successfully!", '\0');
+            break;
+        case OP_STATUS::FAILED:
+            IPX_ERROR(m_name, "Collector failed to reconfigure (no changes): %s", msg.c_str());
+            break;
+        }
+    };
+
     /**
      * @brief Function called after termination
      *
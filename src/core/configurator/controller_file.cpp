@@ -12,6 +12,7 @@
 #include <climits>    // realpath
 #include <cstdlib>    // realpath
 #include <cstdio>     // fread, fseek
+#include <cstdint>    // UINT16_MAX
 #include <sys/stat.h> // stat
 
 #include "controller_file.hpp"
@@ -31,11 +32,28 @@ enum file_xml_nodes {
     IN_PLUGIN_PLUGIN,
     IN_PLUGIN_PARAMS,
     IN_PLUGIN_VERBOSITY,
+    IN_PLUGIN_RING_TYPE,
+    IN_PLUGIN_RING_WAIT,
+    IN_PLUGIN_PARSER_THREADS,
+    IN_PLUGIN_MSG_POOL,
+    IN_PLUGIN_PARSER_MAX_SOURCES,
+    IN_PLUGIN_PARSER_STATE_FILE,
+    IN_PLUGIN_PARSER_STATE_INTERVAL,
+    IN_PLUGIN_PARSER_PENDING_SIZE,
+    IN_PLUGIN_PARSER_PENDING_TIMEOUT,
+    IN_PLUGIN_CPU_AFFINITY,
+    IN_PLUGIN_NUMA_NODE,
     // Intermediate plugin parameters
     INTER_PLUGIN_NAME,
     INTER_PLUGIN_PLUGIN,
     INTER_PLUGIN_PARAMS,
     INTER_PLUGIN_VERBOSITY,
+    INTER_PLUGIN_RING_TYPE,
+    INTER_PLUGIN_RING_WAIT,
+    INTER_PLUGIN_THREADS,
+    INTER_PLUGIN_CPU_AFFINITY,
+    INTER_PLUGIN_NUMA_NODE,
+    INTER_PLUGIN_BRANCH,
     // Output plugin parameters
     OUT_PLUGIN_NAME,
     OUT_PLUGIN_PLUGIN,
@@ -43,6 +61,12 @@ enum file_xml_nodes {
     OUT_PLUGIN_VERBOSITY,
     OUT_PLUGIN_ODID_ONLY,
     OUT_PLUGIN_ODID_EXCEPT,
+    OUT_PLUGIN_RING_TYPE,
+    OUT_PLUGIN_RING_WAIT,
+    OUT_PLUGIN_CPU_AFFINITY,
+    OUT_PLUGIN_NUMA_NODE,
+    OUT_PLUGIN_OVERFLOW,
+    OUT_PLUGIN_BRANCH,
 };
 
 /**
@@ -53,6 +77,20 @@ static const struct fds_xml_args args_instance_input[] = {
     FDS_OPTS_ELEM(IN_PLUGIN_NAME,      "name",       FDS_OPTS_T_STRING, FDS_OPTS_P_OPT),
     FDS_OPTS_ELEM(IN_PLUGIN_PLUGIN,    "plugin",     FDS_OPTS_T_STRING, FDS_OPTS_P_OPT),
     FDS_OPTS_ELEM(IN_PLUGIN_VERBOSITY, "verbosity",  FDS_OPTS_T_STRING, FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM(IN_PLUGIN_RING_TYPE, "ringType",   FDS_OPTS_T_STRING, FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM(IN_PLUGIN_RING_WAIT, "ringWait",   FDS_OPTS_T_STRING, FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM(IN_PLUGIN_PARSER_THREADS, "parserThreads", FDS_OPTS_T_UINT, FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM(IN_PLUGIN_MSG_POOL,  "msgPool",    FDS_OPTS_T_STRING, FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM(IN_PLUGIN_PARSER_MAX_SOURCES, "parserMaxSources", FDS_OPTS_T_UINT, FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM(IN_PLUGIN_PARSER_STATE_FILE, "parserStateFile", FDS_OPTS_T_STRING, FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM(IN_PLUGIN_PARSER_STATE_INTERVAL, "parserStateInterval", FDS_OPTS_T_UINT,
+        FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM(IN_PLUGIN_PARSER_PENDING_SIZE, "parserPendingSize", FDS_OPTS_T_UINT,
+        FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM(IN_PLUGIN_PARSER_PENDING_TIMEOUT, "parserPendingTimeout", FDS_OPTS_T_UINT,
+        FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM(IN_PLUGIN_CPU_AFFINITY, "cpuAffinity", FDS_OPTS_T_STRING, FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM(IN_PLUGIN_NUMA_NODE, "numaNode",   FDS_OPTS_T_UINT,   FDS_OPTS_P_OPT),
     FDS_OPTS_RAW( IN_PLUGIN_PARAMS,    "params",                        FDS_OPTS_P_OPT),
     FDS_OPTS_END
 };
@@ -74,6 +112,12 @@ static const struct fds_xml_args args_instance_inter[] = {
     FDS_OPTS_ELEM(INTER_PLUGIN_NAME,      "name",       FDS_OPTS_T_STRING, FDS_OPTS_P_OPT),
     FDS_OPTS_ELEM(INTER_PLUGIN_PLUGIN,    "plugin",     FDS_OPTS_T_STRING, FDS_OPTS_P_OPT),
     FDS_OPTS_ELEM(INTER_PLUGIN_VERBOSITY, "verbosity",  FDS_OPTS_T_STRING, FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM(INTER_PLUGIN_RING_TYPE, "ringType",   FDS_OPTS_T_STRING, FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM(INTER_PLUGIN_RING_WAIT, "ringWait",   FDS_OPTS_T_STRING, FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM(INTER_PLUGIN_THREADS,   "threads",    FDS_OPTS_T_UINT,   FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM(INTER_PLUGIN_CPU_AFFINITY, "cpuAffinity", FDS_OPTS_T_STRING, FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM(INTER_PLUGIN_NUMA_NODE, "numaNode",   FDS_OPTS_T_UINT,   FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM(INTER_PLUGIN_BRANCH,    "branch",     FDS_OPTS_T_STRING,   FDS_OPTS_P_OPT),
     FDS_OPTS_RAW( INTER_PLUGIN_PARAMS,    "params",                        FDS_OPTS_P_OPT),
     FDS_OPTS_END
 };
@@ -94,6 +138,12 @@ static const struct fds_xml_args args_instance_output[] = {
     FDS_OPTS_ELEM(OUT_PLUGIN_VERBOSITY,   "verbosity",  FDS_OPTS_T_STRING, FDS_OPTS_P_OPT),
     FDS_OPTS_ELEM(OUT_PLUGIN_ODID_EXCEPT, "odidExcept", FDS_OPTS_T_STRING, FDS_OPTS_P_OPT),
     FDS_OPTS_ELEM(OUT_PLUGIN_ODID_ONLY,   "odidOnly",   FDS_OPTS_T_STRING, FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM(OUT_PLUGIN_RING_TYPE,   "ringType",   FDS_OPTS_T_STRING, FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM(OUT_PLUGIN_RING_WAIT,   "ringWait",   FDS_OPTS_T_STRING, FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM(OUT_PLUGIN_CPU_AFFINITY, "cpuAffinity", FDS_OPTS_T_STRING, FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM(OUT_PLUGIN_NUMA_NODE,   "numaNode",   FDS_OPTS_T_UINT,   FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM(OUT_PLUGIN_OVERFLOW,    "overflowPolicy", FDS_OPTS_T_STRING, FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM(OUT_PLUGIN_BRANCH,      "branch",     FDS_OPTS_T_STRING,   FDS_OPTS_P_OPT),
     FDS_OPTS_RAW( OUT_PLUGIN_PARAMS,      "params",                        FDS_OPTS_P_OPT),
     FDS_OPTS_END
 };
@@ -314,6 +364,63 @@ ipx_controller_file::parse_instance_input(fds_xml_ctx_t *ctx, ipx_config_model &
         case IN_PLUGIN_PARAMS:
             input.params = content->ptr_string;
             break;
+        case IN_PLUGIN_RING_TYPE:
+            input.ring_type = content->ptr_string;
+            break;
+        case IN_PLUGIN_RING_WAIT:
+            input.ring_wait = content->ptr_string;
+            break;
+        case IN_PLUGIN_CPU_AFFINITY:
+            input.cpu_affinity = content->ptr_string;
+            break;
+        case IN_PLUGIN_NUMA_NODE:
+            if (content->val_uint > UINT16_MAX) {
+                throw std::invalid_argument("NUMA node ('<numaNode>') of an input instance is out "
+                    "of range!");
+            }
+            input.numa_node = static_cast<int>(content->val_uint);
+            break;
+        case IN_PLUGIN_PARSER_THREADS:
+            if (content->val_uint > UINT16_MAX) {
+                throw std::invalid_argument("Number of parser threads ('<parserThreads>') of an "
+                    "input instance is out of range!");
+            }
+            input.parser_threads = static_cast<unsigned int>(content->val_uint);
+            break;
+        case IN_PLUGIN_MSG_POOL:
+            input.msg_pool = content->ptr_string;
+            break;
+        case IN_PLUGIN_PARSER_MAX_SOURCES:
+            if (content->val_uint > UINT32_MAX) {
+                throw std::invalid_argument("Maximum number of sources of the parser "
+                    "('<parserMaxSources>') of an input instance is out of range!");
+            }
+            input.parser_max_sources = static_cast<unsigned int>(content->val_uint);
+            break;
+        case IN_PLUGIN_PARSER_STATE_FILE:
+            input.parser_state_file = content->ptr_string;
+            break;
+        case IN_PLUGIN_PARSER_STATE_INTERVAL:
+            if (content->val_uint > UINT32_MAX) {
+                throw std::invalid_argument("Interval of saving the parser state "
+                    "('<parserStateInterval>') of an input instance is out of range!");
+            }
+            input.parser_state_interval = static_cast<unsigned int>(content->val_uint);
+            break;
+        case IN_PLUGIN_PARSER_PENDING_SIZE:
+            if (content->val_uint > INT32_MAX) {
+                throw std::invalid_argument("Size of the buffer of Data Sets with unknown "
+                    "templates ('<parserPendingSize>') of an input instance is out of range!");
+            }
+            input.parser_pending_size = static_cast<long>(content->val_uint);
+            break;
+        case IN_PLUGIN_PARSER_PENDING_TIMEOUT:
+            if (content->val_uint > UINT32_MAX) {
+                throw std::invalid_argument("Timeout of Data Sets with unknown templates "
+                    "('<parserPendingTimeout>') of an input instance is out of range!");
+            }
+            input.parser_pending_timeout = static_cast<long>(content->val_uint);
+            break;
         default:
             // Unexpected XML node within <input>!
             assert(false);
@@ -350,6 +457,32 @@ ipx_controller_file::parse_instance_inter(fds_xml_ctx_t *ctx, ipx_config_model &
         case INTER_PLUGIN_PARAMS:
             inter.params = content->ptr_string;
             break;
+        case INTER_PLUGIN_RING_TYPE:
+            inter.ring_type = content->ptr_string;
+            break;
+        case INTER_PLUGIN_RING_WAIT:
+            inter.ring_wait = content->ptr_string;
+            break;
+        case INTER_PLUGIN_CPU_AFFINITY:
+            inter.cpu_affinity = content->ptr_string;
+            break;
+        case INTER_PLUGIN_NUMA_NODE:
+            if (content->val_uint > UINT16_MAX) {
+                throw std::invalid_argument("NUMA node ('<numaNode>') of an intermediate instance is out "
+                    "of range!");
+            }
+            inter.numa_node = static_cast<int>(content->val_uint);
+            break;
+        case INTER_PLUGIN_THREADS:
+            if (content->val_uint > UINT16_MAX) {
+                throw std::invalid_argument("Number of threads ('<threads>') of an intermediate "
+                    "instance is out of range!");
+            }
+            inter.threads = static_cast<unsigned int>(content->val_uint);
+            break;
+        case INTER_PLUGIN_BRANCH:
+            inter.branch = content->ptr_string;
+            break;
         default:
             // "Unexpected XML node within <intermediate>!"
             assert(false);
@@ -387,6 +520,28 @@ ipx_controller_file::parse_instance_output(fds_xml_ctx_t *ctx, ipx_config_model
         case OUT_PLUGIN_PARAMS:
             output.params = content->ptr_string;
             break;
+        case OUT_PLUGIN_RING_TYPE:
+            output.ring_type = content->ptr_string;
+            break;
+        case OUT_PLUGIN_RING_WAIT:
+            output.ring_wait = content->ptr_string;
+            break;
+        case OUT_PLUGIN_CPU_AFFINITY:
+            output.cpu_affinity = content->ptr_string;
+            break;
+        case OUT_PLUGIN_NUMA_NODE:
+            if (content->val_uint > UINT16_MAX) {
+                throw std::invalid_argument("NUMA node ('<numaNode>') of an output instance is out "
+                    "of range!");
+            }
+            output.numa_node = static_cast<int>(content->val_uint);
+            break;
+        case OUT_PLUGIN_OVERFLOW:
+            output.overflow_policy = content->ptr_string;
+            break;
+        case OUT_PLUGIN_BRANCH:
+            output.branch = content->ptr_string;
+            break;
         case OUT_PLUGIN_ODID_EXCEPT:
             if (!odid_set) {
                 output.odid_type = IPX_ODID_FILTER_EXCEPT;
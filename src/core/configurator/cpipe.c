@@ -11,6 +11,7 @@
 
 #include <unistd.h>
 #include <fcntl.h>
+#include <poll.h>
 #include <errno.h>
 #include <limits.h> // PIPE_BUF
 
@@ -112,19 +113,46 @@ ipx_cpipe_receive(struct ipx_cpipe_req *msg)
 }
 
 int
-ipx_cpipe_send_term(ipx_ctx_t *ctx, enum ipx_cpipe_type type)
+ipx_cpipe_receive_timed(struct ipx_cpipe_req *msg, int timeout)
+{
+    struct pollfd pfd;
+    pfd.fd = cpipe_fd[0];
+    pfd.events = POLLIN;
+    pfd.revents = 0;
+
+    int rc = poll(&pfd, 1, timeout);
+    if (rc == 0 || (rc == -1 && errno == EINTR)) {
+        // Timeout expired (or interrupted)
+        return IPX_ERR_NOTFOUND;
+    }
+
+    if (rc == -1) {
+        const char *err_str;
+        ipx_strerror(errno, err_str);
+        IPX_ERROR(module, "poll() failed: %s", err_str);
+        return IPX_ERR_DENIED;
+    }
+
+    // A request (or its part) is ready, the rest is always written at once
+    return ipx_cpipe_receive(msg);
+}
+
+/**
+ * @brief Send a request to the configurator
+ * @note The function is safe to be called from a signal handler!
+ * @param[in] ctx  Plugin context (which is sending request) or NULL
+ * @param[in] type Type of the request
+ * @return #IPX_OK on success
+ * @return #IPX_ERR_DENIED if the request failed to be sent
+ */
+static int
+cpipe_send(ipx_ctx_t *ctx, enum ipx_cpipe_type type)
 {
     // WARNING: Keep on mind that this function can be called from signal handler!
 
     // In case we change 'errno' (e.g. write())
     int errno_backup = errno;
 
-    if (type != IPX_CPIPE_TYPE_TERM_SLOW
-            && type != IPX_CPIPE_TYPE_TERM_FAST
-            && type != IPX_CPIPE_TYPE_TERM_DONE) {
-        return IPX_ERR_ARG;
-    }
-
     // Prepare a request
     struct ipx_cpipe_req req;
     memset(&req, 0, sizeof(req));
@@ -140,3 +168,31 @@ ipx_cpipe_send_term(ipx_ctx_t *ctx, enum ipx_cpipe_type type)
     return (rc == -1) ? IPX_ERR_DENIED : IPX_OK;
 }
 
+int
+ipx_cpipe_send_term(ipx_ctx_t *ctx, enum ipx_cpipe_type type)
+{
+    if (type != IPX_CPIPE_TYPE_TERM_SLOW
+            && type != IPX_CPIPE_TYPE_TERM_FAST
+            && type != IPX_CPIPE_TYPE_TERM_DONE) {
+        return IPX_ERR_ARG;
+    }
+
+    return cpipe_send(ctx, type);
+}
+
+int
+ipx_cpipe_send_reconf(enum ipx_cpipe_type type)
+{
+    if (type != IPX_CPIPE_TYPE_RECONF_START && type != IPX_CPIPE_TYPE_RECONF_DONE) {
+        return IPX_ERR_ARG;
+    }
+
+    return cpipe_send(NULL, type);
+}
+
+int
+ipx_cpipe_send_stats()
+{
+    return cpipe_send(NULL, IPX_CPIPE_TYPE_STATS);
+}
+
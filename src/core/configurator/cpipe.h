@@ -83,11 +83,34 @@ enum ipx_cpipe_type {
      *
      * Sending this request before termination of all plugin instances is considered as fatal.
      */
-    IPX_CPIPE_TYPE_TERM_DONE        ///< Terminate request - complete
-
-    // Proposed types for the future runtime reconfiguration
-    // IPX_CPIPE_TYPE_RECONF_START,
-    // IPX_CPIPE_TYPE_RECONF_DONE
+    IPX_CPIPE_TYPE_TERM_DONE,       ///< Terminate request - complete
+    /**
+     * @brief Reconfiguration request
+     *
+     * Request to load a new configuration from the controller and apply it without stopping
+     * the collector. Usually this request is sent by the signal handler (SIGHUP).
+     *
+     * As a reaction to this request the configurator will prepare new instances and send
+     * a reconfiguration message (type #IPX_MSG_TERMINATE_RECONF) to the processing pipeline.
+     */
+    IPX_CPIPE_TYPE_RECONF_START,
+    /**
+     * @brief Reconfiguration complete notification (internal only!)
+     *
+     * The request is automatically sent when a reconfiguration message, which was sent by
+     * the configurator to the processing pipeline as a response to a previous
+     * #IPX_CPIPE_TYPE_RECONF_START request, is destroyed, i.e. the new configuration has been
+     * applied by all instances.
+     */
+    IPX_CPIPE_TYPE_RECONF_DONE,
+    /**
+     * @brief Print runtime statistics request
+     *
+     * The configurator prints runtime statistics of all instances (see "-s" option), i.e. the
+     * statistics since the previous print are also available without waiting for the periodic
+     * print or if the periodic print is disabled.
+     */
+    IPX_CPIPE_TYPE_STATS
 };
 
 /// Configuration request
@@ -136,6 +159,24 @@ ipx_cpipe_destroy();
 int
 ipx_cpipe_receive(struct ipx_cpipe_req *msg);
 
+/**
+ * @brief Get a request from the configuration pipe (with timeout)
+ *
+ * Same as ipx_cpipe_receive(), however, the function waits for a request at most @p timeout
+ * milliseconds. If the waiting is interrupted (for example, by a signal handler), the function
+ * returns as if the timeout has expired.
+ *
+ * @warning
+ *   The function MUST be called only from the configurator! (as reading is not atomic operation)
+ * @param[out] msg     Received message
+ * @param[in]  timeout Maximum time to wait (in milliseconds)
+ * @return #IPX_OK on success and @p msg is filled
+ * @return #IPX_ERR_NOTFOUND if no request has been received before the timeout expired
+ * @return #IPX_ERR_DENIED on a fatal error and the content of @p msg is undefined
+ */
+int
+ipx_cpipe_receive_timed(struct ipx_cpipe_req *msg, int timeout);
+
 /**
  * @brief Send a new termination request
  *
@@ -154,6 +195,33 @@ ipx_cpipe_receive(struct ipx_cpipe_req *msg);
 int
 ipx_cpipe_send_term(ipx_ctx_t *ctx, enum ipx_cpipe_type type);
 
+/**
+ * @brief Send a new reconfiguration request
+ *
+ * See the description of #IPX_CPIPE_TYPE_RECONF_START and #IPX_CPIPE_TYPE_RECONF_DONE requests
+ * for more details.
+ *
+ * @note The function is safe to be called from a signal handler!
+ * @param[in] type Type of reconfiguration request
+ * @return #IPX_OK on success
+ * @return #IPX_ERR_ARG if the @p type is not reconfiguration request i.e. IPX_CPIPE_TYPE_RECONF_*
+ * @return #IPX_ERR_DENIED if the request failed to be sent
+ */
+int
+ipx_cpipe_send_reconf(enum ipx_cpipe_type type);
+
+/**
+ * @brief Send a request to print runtime statistics
+ *
+ * See the description of #IPX_CPIPE_TYPE_STATS request for more details.
+ *
+ * @note The function is safe to be called from a signal handler!
+ * @return #IPX_OK on success
+ * @return #IPX_ERR_DENIED if the request failed to be sent
+ */
+int
+ipx_cpipe_send_stats();
+
 #ifdef __cplusplus
 }
 #endif
@@ -151,6 +151,7 @@ ipx_cfg_extensions::resolve()
 {
     size_t offset = 0;
     uint64_t mask = 1U;
+    size_t column = 0;
 
     if (m_resolved) {
         return;
@@ -162,17 +163,32 @@ ipx_cfg_extensions::resolve()
             struct ext_rec &ext = ext_name.second;
             std::string ident = "'" + ext_type.first + "/" + ext_name.first + "'";
 
-            if (!mask) {
-                // No more bits in the mask!
-                throw std::runtime_error("Maximum number of Data Record extensions has been reached!");
-            }
-
             // Check the extension
             check_dependencies(ident, ext);
             assert(ext.producers.size() == 1 && "Exactly one producer");
 
-            // Determine size, offset and bitset mask
             ext.size = ext.producers[0].rec->size;
+            ext.columnar = ext.producers[0].rec->columnar;
+            ext.offset = 0;
+            ext.mask = 0;
+            ext.column = 0;
+
+            if (ext.columnar) {
+                // Columns are not part of Data Records
+                if (column == IPX_MSG_IPFIX_COLS_MAX) {
+                    throw std::runtime_error("Maximum number of columnar Data Record extensions "
+                        "has been reached!");
+                }
+                ext.column = column++;
+                continue;
+            }
+
+            if (!mask) {
+                // No more bits in the mask!
+                throw std::runtime_error("Maximum number of Data Record extensions has been reached!");
+            }
+
+            // Determine offset and bitset mask
             ext.offset = offset;
             ext.mask = mask;
 
@@ -210,6 +226,8 @@ ipx_cfg_extensions::update_instance(ipx_ctx_t *ctx)
         ext->mask = ext_def.mask;
         ext->offset = ext_def.offset;
         ext->size = ext_def.size;
+        ext->columnar = ext_def.columnar;
+        ext->column = ext_def.column;
     }
 
     // Update size of the Data Record in the plugin context
@@ -233,6 +251,12 @@ ipx_cfg_extensions::list_extensions()
             struct ext_rec &ext = ext_name.second;
             std::string ident = "'" + ext_type.first + "/" + ext_name.first + "'";
 
+            if (ext.columnar) {
+                IPX_DEBUG(comp_str, "Data Record extension %s (size: %zu, column: %zu, "
+                    "consumers: %zu)", ident.c_str(), ext.size, ext.column, ext.consumers.size());
+                continue;
+            }
+
             IPX_DEBUG(comp_str, "Data Record extension %s (size: %zu, offset: %zu, consumers: %zu)",
                 ident.c_str(), ext.size, ext.offset, ext.consumers.size());
         }
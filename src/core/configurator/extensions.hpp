@@ -77,8 +77,10 @@ private:
         std::vector<plugin_rec> consumers; ///< Extension consumers
 
         size_t size;                       ///< Size of the extension in each Data Record
+        bool columnar;                     ///< Stored in a column of each IPFIX Message
         size_t offset;                     ///< Offset of the extension in each Data Record
         uint64_t mask;                     ///< Bitsets mask (indication if ext. value is set)
+        size_t column;                     ///< Index of the column (only columnar)
     };
 
     /// All extensions are resolved
@@ -122,7 +124,7 @@ public:
     /**
      * @brief Update extension definitions of a plugin instance
      *
-     * Size, offset and mask of each Data Record extension is updated. Moreover, the size of
+     * Size, offset and mask (or column) of each Data Record extension is updated. Moreover, the size of
      * a Data Record of IPFIX Messages is also updated.
      *
      * @throw runtime_error if the extensions/dependencies hasn't been resolved yet
@@ -0,0 +1,192 @@
+/**
+ * \file src/core/configurator/instance.cpp
+ * \author agent <agent@local>
+ * \brief Pipeline instance wrappers (source file)
+ * \date 2026
+ */
+
+/* Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is'', and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#include <algorithm>
+#include <cinttypes>
+#include <string>
+#include "instance.hpp"
+
+extern "C" {
+#include "../verbose.h"
+}
+
+/** Identification of this component (for log) */
+static const char *comp_str = "Statistics";
+
+/**
+ * \brief Convert a difference of nanosecond counters to milliseconds
+ * \param[in] now  Current value
+ * \param[in] prev Previous value
+ */
+static inline double
+stats_diff_ms(uint64_t now, uint64_t prev)
+{
+    return static_cast<double>(now - prev) / 1000000.0;
+}
+
+/**
+ * \brief Print current and peak memory accounted to an instance (if accounting is enabled)
+ * \param[in] ctx  Plugin context
+ * \param[in] name Name of the context
+ */
+static void
+stats_print_memory(const ipx_ctx_t *ctx, const char *name)
+{
+    const struct ipx_mem_tag *mem = ipx_ctx_mem_get(ctx);
+    if (mem == nullptr) {
+        return;
+    }
+
+    const double mib = 1024.0 * 1024.0;
+    const uint64_t current = __atomic_load_n(&mem->current, __ATOMIC_RELAXED);
+    const uint64_t peak = __atomic_load_n(&mem->peak, __ATOMIC_RELAXED);
+    IPX_INFO(comp_str, "%s: memory %.1f MiB (peak %.1f MiB)", name,
+        static_cast<double>(current) / mib, static_cast<double>(peak) / mib);
+}
+
+/**
+ * \brief Print percentiles of latency recorded since the previous snapshot
+ * \param[in]     name Name of the context
+ * \param[in]     now  Current snapshot of the histogram
+ * \param[in,out] prev Previous snapshot of the histogram (will be replaced with the current one)
+ */
+static void
+stats_print_latency(const char *name, const struct ipx_latency_hist &now,
+    struct ipx_latency_hist &prev)
+{
+    // Previous snapshot is not needed anymore, so it's reused for the difference
+    struct ipx_latency_hist &diff = prev;
+    for (unsigned int i = 0; i < IPX_LATENCY_BUCKETS; ++i) {
+        diff.buckets[i] = now.buckets[i] - prev.buckets[i];
+    }
+    diff.cnt = now.cnt - prev.cnt;
+
+    IPX_INFO(comp_str, "%s: latency since ingress p50 %.1f us, p90 %.1f us, p99 %.1f us, "
+        "p99.9 %.1f us, max %.1f us (%" PRIu64 " msgs)", name,
+        ipx_latency_percentile(&diff, 50.0) / 1000.0,
+        ipx_latency_percentile(&diff, 90.0) / 1000.0,
+        ipx_latency_percentile(&diff, 99.0) / 1000.0,
+        ipx_latency_percentile(&diff, 99.9) / 1000.0,
+        ipx_latency_percentile(&diff, 100.0) / 1000.0,
+        diff.cnt);
+    prev = now;
+}
+
+/**
+ * \brief Print statistics provided by the plugin of the context (if any)
+ *
+ * Each line of the output of the plugin is printed as a separate message.
+ * \param[in] ctx  Plugin context
+ * \param[in] name Name of the context
+ */
+static void
+stats_print_plugin(const ipx_ctx_t *ctx, const char *name)
+{
+    std::string buffer(512, '\0');
+    int len = ipx_ctx_stats_plugin(ctx, &buffer[0], buffer.size());
+    if (len >= 0 && static_cast<size_t>(len) >= buffer.size()) {
+        // Too long, try again with a large enough buffer
+        buffer.resize(static_cast<size_t>(len) + 1U);
+        len = ipx_ctx_stats_plugin(ctx, &buffer[0], buffer.size());
+    }
+    if (len <= 0) {
+        return;
+    }
+
+    buffer.resize(std::min(static_cast<size_t>(len), buffer.size() - 1U));
+    size_t pos = 0;
+    while (pos < buffer.size()) {
+        size_t end = buffer.find('\n', pos);
+        if (end == std::string::npos) {
+            end = buffer.size();
+        }
+        if (end > pos) {
+            IPX_INFO(comp_str, "%s: %s", name, buffer.substr(pos, end - pos).c_str());
+        }
+        pos = end + 1;
+    }
+}
+
+void
+ipx_instance::stats_print_ctx(const ipx_ctx_t *ctx, const ipx_ring_t *ring, stats_snapshot &prev,
+    double interval)
+{
+    stats_snapshot now;
+    ipx_ctx_stats_get(ctx, &now.ctx);
+    const struct ipx_latency_hist *latency = ipx_ctx_latency_get(ctx);
+    if (interval <= 0.0) {
+        interval = 1.0;
+    }
+
+    const char *name = ipx_ctx_name_get(ctx);
+    const double rate_recv = static_cast<double>(now.ctx.msg_recv - prev.ctx.msg_recv) / interval;
+    const double rate_pass = static_cast<double>(now.ctx.msg_pass - prev.ctx.msg_pass) / interval;
+
+    if (ring == nullptr) {
+        IPX_INFO(comp_str, "%s: passed %" PRIu64 " msgs (%.0f msgs/s)", name, now.ctx.msg_pass,
+            rate_pass);
+        if (latency != nullptr) {
+            ipx_latency_snapshot(latency, &now.latency);
+            stats_print_latency(name, now.latency, prev.latency);
+        }
+        stats_print_memory(ctx, name);
+        stats_print_plugin(ctx, name);
+        prev.ctx = now.ctx;
+        return;
+    }
+
+    ipx_ring_stats_get(ring, &now.ring);
+    IPX_INFO(comp_str, "%s: received %" PRIu64 " msgs (%.0f msgs/s), passed %" PRIu64 " msgs "
+        "(%.0f msgs/s), input ring %" PRIu32 "/%" PRIu32 " (max. %" PRIu32 "), waited on empty "
+        "%.1f ms, writers waited on full %.1f ms", name,
+        now.ctx.msg_recv, rate_recv, now.ctx.msg_pass, rate_pass,
+        now.ring.usage, now.ring.size, now.ring.high_water,
+        stats_diff_ms(now.ring.wait_empty, prev.ring.wait_empty),
+        stats_diff_ms(now.ring.wait_full, prev.ring.wait_full));
+    if (latency != nullptr) {
+        ipx_latency_snapshot(latency, &now.latency);
+        stats_print_latency(name, now.latency, prev.latency);
+    }
+    stats_print_memory(ctx, name);
+    stats_print_plugin(ctx, name);
+    prev.ctx = now.ctx;
+    prev.ring = now.ring;
+}
@@ -44,6 +44,7 @@
 
 #include <tuple>
 #include <string>
+#include <vector>
 #include <stdexcept>
 #include <memory>
 #include "plugin_mgr.hpp"
@@ -51,6 +52,7 @@
 
 extern "C" {
 #include <ipfixcol2.h>
+#include "../context.h"
 #include "../ring.h"
 }
 
@@ -88,6 +90,34 @@ protected:
     /** Reference to the plugin description and callbacks (can be nullptr)                       */
     ipx_plugin_mgr::plugin_ref *_plugin_ref;
 
+    /** Snapshot of runtime statistics of a context and its input ring buffer                    */
+    struct stats_snapshot {
+        /** Statistics of the context                                                            */
+        struct ipx_ctx_stats ctx;
+        /** Statistics of the input ring buffer (unused if the context doesn't have any)         */
+        struct ipx_ring_stats ring;
+        /** Latency histogram of the context (unused if latency is not measured)                 */
+        struct ipx_latency_hist latency;
+    };
+
+    /** Statistics of the context from the previous call of stats_print()                        */
+    stats_snapshot _stats_prev;
+
+    /**
+     * \brief Print runtime statistics of a context and its input ring buffer
+     *
+     * Message rates and waiting times are computed from the difference between the current
+     * statistics and the previous snapshot, which is updated afterwards. If the context measures
+     * latency of IPFIX Messages, percentiles of the latency within the interval are printed too.
+     * \param[in]     ctx      Plugin context
+     * \param[in]     ring     Input ring buffer of the context (can be nullptr)
+     * \param[in,out] prev     Snapshot from the previous call
+     * \param[in]     interval Time elapsed since the previous call (in seconds)
+     */
+    static void
+    stats_print_ctx(const ipx_ctx_t *ctx, const ipx_ring_t *ring, stats_snapshot &prev,
+        double interval);
+
     /**
      * \brief Base constructor of an instance
      *
@@ -99,7 +129,7 @@ protected:
      * \param[in] ref  Reference to the plugin (will be automatically delete on destroy)
      */
     ipx_instance(const std::string &name, ipx_plugin_mgr::plugin_ref *ref)
-        : _state(state::NEW), _name(name), _ctx(nullptr), _plugin_ref(ref) {};
+        : _state(state::NEW), _name(name), _ctx(nullptr), _plugin_ref(ref), _stats_prev() {};
     /**
      * \brief Base destructor of an instance
      *
@@ -157,6 +187,44 @@ public:
     set_processing(bool en) {
         ipx_ctx_processing_set(_ctx, en);
     }
+
+    /**
+     * \brief Set CPU affinity of threads and NUMA placement of input buffers of the instance
+     * \note Only configuration of an uninitialized instance can be changed.
+     * \see ipx_ctx_affinity_set() and ipx_ring_node_set() for more details
+     * \param[in] cpus Allowed CPUs (if empty, not restricted)
+     * \param[in] node Preferred NUMA node of input buffers (if negative, not changed)
+     * \throw runtime_error if the affinity cannot be set
+     */
+    virtual void
+    set_affinity(const std::vector<uint16_t> &cpus, int node) {
+        (void) node; // The base instance has no input buffer
+        if (ipx_ctx_affinity_set(_ctx, cpus.data(), cpus.size()) != IPX_OK) {
+            throw std::runtime_error("Failed to set CPU affinity of the instance '" + _name + "'!");
+        }
+    }
+
+    /**
+     * \brief Enable adaptive capacity of input buffers of the instance
+     * \note Only configuration of an uninitialized instance can be changed. Buffers that don't
+     *   support adaptive capacity keep their size.
+     * \see ipx_ring_adaptive_set() for more details
+     * \param[in] max Maximal capacity of input buffers
+     */
+    virtual void
+    set_buffer_max(uint32_t max) {
+        (void) max; // The base instance has no input buffer
+    }
+
+    /**
+     * \brief Print runtime statistics of the instance (message rates, ring buffer occupancy)
+     * \note Statistics are printed as informational messages of the configurator.
+     * \param[in] interval Time elapsed since the previous call (in seconds)
+     */
+    virtual void
+    stats_print(double interval) {
+        stats_print_ctx(_ctx, nullptr, _stats_prev, interval);
+    }
 };
 
 #endif //IPFIXCOL_INSTANCE_H
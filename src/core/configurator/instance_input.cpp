@@ -41,6 +41,7 @@
 
 #include "instance_input.hpp"
 #include "instance_intermediate.hpp"
+#include "instance_sharded.hpp"
 
 extern "C" {
 #include "../plugin_parser.h"
@@ -60,7 +61,10 @@ static const struct ipx_ctx_callbacks parser_callbacks = {
 };
 
 ipx_instance_input::ipx_instance_input(const std::string &name, ipx_plugin_mgr::plugin_ref *ref,
-    uint32_t bsize) : ipx_instance(name, ref)
+    uint32_t bsize, enum ipx_ring_type btype, enum ipx_ring_wait bwait, unsigned int pthreads)
+    : ipx_instance(name, ref), _parser_buffer(nullptr), _parser_ctx(nullptr), _parser_stats_prev(),
+    _parser_threads(pthreads), _parser_max_sources(0), _parser_state_interval(0),
+    _parser_pending_size(-1), _parser_pending_timeout(-1)
 {
     // Get the plugin callbacks
     const ipx_plugin_mgr::plugin *plugin = _plugin_ref->get_plugin();
@@ -70,15 +74,35 @@ ipx_instance_input::ipx_instance_input(const std::string &name, ipx_plugin_mgr::
     // Create all components
     std::string pname = name + " (parser)";
     unique_fpipe feedback(ipx_fpipe_create(), &ipx_fpipe_destroy);
-    unique_ring  ring_wrap(ipx_ring_init(bsize, false), &ipx_ring_destroy);
     unique_ctx   input_wrap(ipx_ctx_create(name.c_str(), cbs), &ipx_ctx_destroy);
+    if (!feedback || !input_wrap) {
+        throw std::runtime_error("Failed to create components of an input instance!");
+    }
+
+    ipx_ctx_fpipe_set(input_wrap.get(), feedback.get());
+    if (pthreads > 1) {
+        // Parsers behind a dispatcher, each parser holds only its own Transport Sessions
+        _parser_sharded.reset(new ipx_instance_sharded(pname, &parser_callbacks, pthreads,
+            IPX_DISPATCHER_KEY_SESSION, bsize, btype, bwait));
+        ipx_ctx_ring_dst_set(input_wrap.get(), _parser_sharded->get_input());
+
+        if (cbs->ts_close != nullptr) {
+            _parser_sharded->set_feedback(feedback.get());
+        }
+
+        _ctx = input_wrap.release();
+        _input_feedback = feedback.release();
+        return;
+    }
+
+    unique_ring  ring_wrap(ipx_ring_init_type(bsize, false, btype), &ipx_ring_destroy);
     unique_ctx   parser_wrap(ipx_ctx_create(pname.c_str(), &parser_callbacks), &ipx_ctx_destroy);
-    if (!feedback || !ring_wrap || !parser_wrap || !input_wrap) {
+    if (!ring_wrap || !parser_wrap) {
         throw std::runtime_error("Failed to create components of an input instance!");
     }
 
     // Configure the components (connect them)
-    ipx_ctx_fpipe_set(input_wrap.get(), feedback.get());
+    ipx_ring_wait_set(ring_wrap.get(), bwait);
     ipx_ctx_ring_dst_set(input_wrap.get(), ring_wrap.get());
     ipx_ctx_ring_src_set(parser_wrap.get(), ring_wrap.get());
 
@@ -99,11 +123,17 @@ ipx_instance_input::~ipx_instance_input()
 {
     // Destroy context (if running, wait for termination of threads)
     ipx_ctx_destroy(_ctx);
-    ipx_ctx_destroy(_parser_ctx);
+    if (_parser_sharded) {
+        _parser_sharded.reset();
+    } else {
+        ipx_ctx_destroy(_parser_ctx);
+    }
 
     // Now we can destroy buffers
     ipx_fpipe_destroy(_input_feedback);
-    ipx_ring_destroy(_parser_buffer);
+    if (_parser_buffer != nullptr) {
+        ipx_ring_destroy(_parser_buffer);
+    }
 }
 
 void
@@ -115,12 +145,17 @@ ipx_instance_input::init(const std::string &params, const fds_iemgr_t *iemgr, ip
     // Configure
     ipx_ctx_verb_set(_ctx, level);
     ipx_ctx_iemgr_set(_ctx, iemgr);
-    ipx_ctx_verb_set(_parser_ctx, level);
-    ipx_ctx_iemgr_set(_parser_ctx, iemgr);
 
     // Initialize
-    if (ipx_ctx_init(_parser_ctx, nullptr) != IPX_OK) {
-        throw std::runtime_error("Failed to initialize the parser of IPFIX Messages!");
+    if (_parser_sharded) {
+        auto params_fn = [this](unsigned int idx) { return parser_params(idx); };
+        _parser_sharded->init_each(params_fn, iemgr, level);
+    } else {
+        ipx_ctx_verb_set(_parser_ctx, level);
+        ipx_ctx_iemgr_set(_parser_ctx, iemgr);
+        if (ipx_ctx_init(_parser_ctx, parser_params(0).c_str()) != IPX_OK) {
+            throw std::runtime_error("Failed to initialize the parser of IPFIX Messages!");
+        }
     }
 
     if (ipx_ctx_init(_ctx, params.c_str()) != IPX_OK) {
@@ -137,7 +172,13 @@ ipx_instance_input::start()
 
     /* FIXME: if the parser has stared but input plugin fails to start, stop the parser
      *        (probably by sending a termination message)                              */
-    if (ipx_ctx_run(_parser_ctx) != IPX_OK || ipx_ctx_run(_ctx) != IPX_OK) {
+    if (_parser_sharded) {
+        _parser_sharded->start();
+    } else if (ipx_ctx_run(_parser_ctx) != IPX_OK) {
+        throw std::runtime_error("Failed to start a thread of the input instance.");
+    }
+
+    if (ipx_ctx_run(_ctx) != IPX_OK) {
         throw std::runtime_error("Failed to start a thread of the input instance.");
     }
 
@@ -155,7 +196,12 @@ ipx_instance_input::connect_to(ipx_instance_intermediate &intermediate)
 {
     // Only configuration of uninitialized instances can be changed!
     assert(_state == state::NEW && intermediate._state == state::NEW);
-    ipx_ctx_ring_dst_set(_parser_ctx, intermediate.get_input());
+    if (_parser_sharded) {
+        // Also enables multi-writer mode of the intermediate instance
+        _parser_sharded->connect_to(intermediate);
+    } else {
+        ipx_ctx_ring_dst_set(_parser_ctx, intermediate.get_input());
+    }
 
     intermediate._inputs_cnt++;
     if (intermediate._inputs_cnt > 1) {
@@ -169,14 +215,22 @@ void
 ipx_instance_input::extensions_register(ipx_cfg_extensions *ext_mgr, size_t pos)
 {
     ext_mgr->register_instance(_ctx, pos);
-    ext_mgr->register_instance(_parser_ctx, pos);
+    if (_parser_sharded) {
+        _parser_sharded->extensions_register(ext_mgr, pos);
+    } else {
+        ext_mgr->register_instance(_parser_ctx, pos);
+    }
 }
 
 void
 ipx_instance_input::extensions_resolve(ipx_cfg_extensions *ext_mgr)
 {
     ext_mgr->update_instance(_ctx);
-    ext_mgr->update_instance(_parser_ctx);
+    if (_parser_sharded) {
+        _parser_sharded->extensions_resolve(ext_mgr);
+    } else {
+        ext_mgr->update_instance(_parser_ctx);
+    }
 }
 
 void
@@ -189,5 +243,154 @@ ipx_instance_input::set_processing(bool en)
 void
 ipx_instance_input::set_parser_processing(bool en)
 {
-    ipx_ctx_processing_set(_parser_ctx, en);
-}
\ No newline at end of file
+    if (_parser_sharded) {
+        _parser_sharded->set_processing(en);
+    } else {
+        ipx_ctx_processing_set(_parser_ctx, en);
+    }
+}
+
+void
+ipx_instance_input::set_parser_batching(bool en)
+{
+    assert(_state == state::NEW); // Only configuration of an uninitialized instance can be changed!
+    if (_parser_sharded) {
+        _parser_sharded->set_batching(en);
+    } else {
+        ipx_ctx_batch_set(_parser_ctx, en);
+    }
+}
+
+void
+ipx_instance_input::set_parser_relay(bool en)
+{
+    assert(_state == state::NEW); // Only configuration of an uninitialized instance can be changed!
+    if (_parser_sharded) {
+        _parser_sharded->set_relay(en);
+    } else {
+        ipx_ctx_relay_set(_parser_ctx, en);
+    }
+}
+
+void
+ipx_instance_input::set_msg_pool(enum ipx_msg_pool_mode mode)
+{
+    assert(_state == state::NEW); // Only configuration of an uninitialized instance can be changed!
+    ipx_ctx_msg_pool_set(_ctx, mode);
+}
+
+void
+ipx_instance_input::set_parser_limit(unsigned int max)
+{
+    assert(_state == state::NEW); // Only configuration of an uninitialized instance can be changed!
+    _parser_max_sources = max;
+}
+
+void
+ipx_instance_input::set_parser_state(const std::string &file, unsigned int interval)
+{
+    assert(_state == state::NEW); // Only configuration of an uninitialized instance can be changed!
+    _parser_state_file = file;
+    _parser_state_interval = interval;
+}
+
+void
+ipx_instance_input::set_parser_pending(long size, long timeout)
+{
+    assert(_state == state::NEW); // Only configuration of an uninitialized instance can be changed!
+    _parser_pending_size = size;
+    _parser_pending_timeout = timeout;
+}
+
+/**
+ * \brief Escape special characters of a text to be placed into an XML element
+ * \param[in] text Text
+ * \return Escaped text
+ */
+static std::string
+xml_escape(const std::string &text)
+{
+    std::string result;
+    for (char c : text) {
+        switch (c) {
+        case '&': result += "&amp;"; break;
+        case '<': result += "&lt;"; break;
+        case '>': result += "&gt;"; break;
+        default:  result += c; break;
+        }
+    }
+
+    return result;
+}
+
+std::string
+ipx_instance_input::parser_params(unsigned int idx) const
+{
+    std::string params;
+    if (_parser_max_sources != 0) {
+        params += "<maxSources>" + std::to_string(_parser_max_sources) + "</maxSources>";
+    }
+
+    if (!_parser_state_file.empty()) {
+        const std::string file = xml_escape(_parser_state_file);
+        if (_parser_threads <= 1) {
+            params += "<stateFile>" + file + "</stateFile>";
+            params += "<stateRestore>" + file + "</stateRestore>";
+        } else {
+            // Sessions might be assigned to different threads after restart -> load all files
+            params += "<stateFile>" + file + "." + std::to_string(idx + 1) + "</stateFile>";
+            for (unsigned int i = 1; i <= _parser_threads; ++i) {
+                params += "<stateRestore>" + file + "." + std::to_string(i) + "</stateRestore>";
+            }
+        }
+
+        params += "<stateInterval>" + std::to_string(_parser_state_interval) + "</stateInterval>";
+    }
+
+    if (_parser_pending_size >= 0) {
+        params += "<pendingSize>" + std::to_string(_parser_pending_size) + "</pendingSize>";
+    }
+
+    if (_parser_pending_timeout >= 0) {
+        params += "<pendingTimeout>" + std::to_string(_parser_pending_timeout)
+            + "</pendingTimeout>";
+    }
+
+    if (params.empty()) {
+        return params;
+    }
+
+    return "<params>" + params + "</params>";
+}
+
+void
+ipx_instance_input::set_affinity(const std::vector<uint16_t> &cpus, int node)
+{
+    assert(_state == state::NEW); // Only configuration of an uninitialized instance can be changed!
+    ipx_instance::set_affinity(cpus, node);
+    if (_parser_sharded) {
+        _parser_sharded->set_affinity(cpus, node);
+        return;
+    }
+
+    if (ipx_ctx_affinity_set(_parser_ctx, cpus.data(), cpus.size()) != IPX_OK) {
+        throw std::runtime_error("Failed to set CPU affinity of the parser of the instance '"
+            + _name + "'!");
+    }
+
+    if (node >= 0) {
+        // Failure is not fatal (a warning is printed)
+        ipx_ring_node_set(_parser_buffer, static_cast<unsigned int>(node));
+    }
+}
+
+void
+ipx_instance_input::stats_print(double interval)
+{
+    stats_print_ctx(_ctx, nullptr, _stats_prev, interval);
+    if (_parser_sharded) {
+        _parser_sharded->stats_print(interval);
+    } else {
+        stats_print_ctx(_parser_ctx, _parser_buffer, _parser_stats_prev, interval);
+    }
+}
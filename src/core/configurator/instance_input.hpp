@@ -52,6 +52,8 @@ extern "C" {
 /** Unique pointer type of a feedback pipe     */
 using unique_fpipe = std::unique_ptr<ipx_fpipe_t, decltype(&ipx_fpipe_destroy)>;
 
+class ipx_instance_sharded;
+
 /**
  * \brief Instance of an input plugin
  *
@@ -67,6 +69,9 @@ using unique_fpipe = std::unique_ptr<ipx_fpipe_t, decltype(&ipx_fpipe_destroy)>;
  *   can be initialized!
  * \note The IPFIX parser is connected to the input feedback pipe only if the input plugin
  *   implements the interface for processing request to close a Transport Session
+ * \note If multiple parser threads are requested, the parser is replaced by a sharded instance
+ *   of the parser (see ipx_instance_sharded), which distributes messages among the parsers by
+ *   their Transport Session. Each parser holds templates only of its own sessions.
  *
  * \verbatim
  *                   (optional feedback)
@@ -87,8 +92,32 @@ protected:
 
     /** Ring buffer between the instance of an input plugin and instance of the parser           */
     ipx_ring_t  *_parser_buffer;
-    /** Instance of the parser plugin (internal)                                                 */
+    /** Instance of the parser plugin (internal, NULL if the parser is sharded)                  */
     ipx_ctx_t   *_parser_ctx;
+    /** Parallel instances of the parser plugin (internal, NULL if the parser is not sharded)   */
+    std::unique_ptr<ipx_instance_sharded> _parser_sharded;
+    /** Statistics of the parser from the previous call of stats_print()                         */
+    stats_snapshot _parser_stats_prev;
+    /** Number of parser threads                                                                  */
+    unsigned int _parser_threads;
+    /** Maximum number of combinations of Transport Sessions and ODIDs per parser (0 = unlimited) */
+    unsigned int _parser_max_sources;
+    /** Path to the state file of parser templates (empty, if disabled)                         */
+    std::string _parser_state_file;
+    /** Interval between periodic saves of the state file (0 = only on exit)                     */
+    unsigned int _parser_state_interval;
+    /** Maximum size of buffered Data Sets with unknown templates per source (negative = default) */
+    long _parser_pending_size;
+    /** Maximum age of buffered Data Sets with unknown templates (negative = default)            */
+    long _parser_pending_timeout;
+
+    /**
+     * \brief Get XML parameters of the parser plugin
+     * \param[in] idx Index of the parser thread
+     * \return Parameters (empty, if defaults are used)
+     */
+    std::string
+    parser_params(unsigned int idx) const;
 
     // Disable copy constructors
     ipx_instance_input(const ipx_instance_input &) = delete;
@@ -105,8 +134,13 @@ public:
      * \param[in] name   Name of the instance
      * \param[in] ref    Reference to the plugin (will be automatically delete on destroy)
      * \param[in] bsize  Size of the ring buffer between the input instance and the parser instance
+     * \param[in] btype  Type of the ring buffer between the input instance and the parser instance
+     * \param[in] bwait  Waiting strategy of the ring buffer between the instances
+     * \param[in] pthreads Number of parser threads
      */
-    ipx_instance_input(const std::string &name, ipx_plugin_mgr::plugin_ref *ref, uint32_t bsize);
+    ipx_instance_input(const std::string &name, ipx_plugin_mgr::plugin_ref *ref, uint32_t bsize,
+        enum ipx_ring_type btype = IPX_RING_TYPE_BLOCK,
+        enum ipx_ring_wait bwait = IPX_RING_WAIT_DEFAULT, unsigned int pthreads = 1);
     /**
      * \brief Destroy the instance
      * \note
@@ -182,6 +216,86 @@ public:
      */
     void
     set_parser_processing(bool en);
+
+    /**
+     * \brief Enable/disable packing of IPFIX Messages passed by the parser into batches
+     * \see ipx_ctx_batch_set() for more details
+     * \param[in] en Enable/disable packing
+     */
+    void
+    set_parser_batching(bool en);
+
+    /**
+     * \brief Enable/disable relay mode of the parser (Data Records are only counted)
+     * \see ipx_ctx_relay_set() for more details
+     * \param[in] en Enable/disable relay mode
+     */
+    void
+    set_parser_relay(bool en);
+
+    /**
+     * \brief Set operation mode of the pool of IPFIX Messages created by the input instance
+     * \see ipx_ctx_msg_pool_set() for more details
+     * \param[in] mode Operation mode
+     */
+    void
+    set_msg_pool(enum ipx_msg_pool_mode mode);
+
+    /**
+     * \brief Set the maximum number of combinations of Transport Sessions and ODIDs per parser
+     *
+     * If the limit is reached, the least recently used combination is evicted.
+     * \note In case of the sharded parser, the limit is applied to each parser thread separately.
+     * \see ipx_parser_limit_set() for more details
+     * \param[in] max Maximum number of combinations (0 = unlimited)
+     */
+    void
+    set_parser_limit(unsigned int max);
+
+    /**
+     * \brief Save templates of the parser into a state file and restore them on startup
+     *
+     * Templates of IPFIX flow sources over UDP are saved on exit (and optionally periodically)
+     * and restored when the flow sources appear after restart.
+     * \note In case of the sharded parser, each parser thread saves its own file (the path with
+     *   a suffix of the thread index, e.g. "state.1") and loads files of all threads, because
+     *   the distribution of Transport Sessions among the threads is not preserved after restart.
+     * \see ipx_parser_state_save() for more details
+     * \param[in] file     Path to the state file (if empty, disabled)
+     * \param[in] interval Interval between periodic saves in seconds (0 = only on exit)
+     */
+    void
+    set_parser_state(const std::string &file, unsigned int interval);
+
+    /**
+     * \brief Configure buffering of Data Sets with unknown (Options) Templates
+     * \see ipx_parser_pending_set() for more details
+     * \param[in] size    Maximum size of buffered Sets per source in bytes (0 = disabled,
+     *   negative = default)
+     * \param[in] timeout Maximum age of buffered Sets in seconds (negative = default)
+     */
+    void
+    set_parser_pending(long size, long timeout);
+
+    /**
+     * \brief Set CPU affinity of threads of the input instance and the parser(s)
+     *
+     * The ring buffer between the input instance and the parser is placed on the NUMA node.
+     * Pool of IPFIX Messages is allocated by the thread of the input instance, therefore,
+     * it's placed on the node of the allowed CPUs too.
+     * \param[in] cpus Allowed CPUs (if empty, not restricted)
+     * \param[in] node Preferred NUMA node of the ring buffer (if negative, not changed)
+     * \throw runtime_error if the affinity cannot be set
+     */
+    void
+    set_affinity(const std::vector<uint16_t> &cpus, int node) override;
+
+    /**
+     * \brief Print runtime statistics of the input instance and the parser
+     * \param[in] interval Time elapsed since the previous call (in seconds)
+     */
+    void
+    stats_print(double interval) override;
 };
 
 #endif //IPFIXCOL_INSTANCE_INPUT_HPP
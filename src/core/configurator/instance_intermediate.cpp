@@ -47,18 +47,22 @@
  * The function prepares plugin context and input ring buffer to be prepared for start.
  * \param[in] cbs   Callback function
  * \param[in] bsize Size of the input ring buffer
+ * \param[in] btype Type of the input ring buffer
+ * \param[in] bwait Waiting strategy of the input ring buffer
  * \throw runtime_error if any component fails to initialize
  */
 void
-ipx_instance_intermediate::internals_init(const struct ipx_ctx_callbacks *cbs, uint32_t bsize)
+ipx_instance_intermediate::internals_init(const struct ipx_ctx_callbacks *cbs, uint32_t bsize,
+    enum ipx_ring_type btype, enum ipx_ring_wait bwait)
 {
-    unique_ring ring_wrap(ipx_ring_init(bsize, false), &ipx_ring_destroy);
+    unique_ring ring_wrap(ipx_ring_init_type(bsize, false, btype), &ipx_ring_destroy);
     unique_ctx  inter_wrap(ipx_ctx_create(_name.c_str(), cbs), &ipx_ctx_destroy);
     if (!ring_wrap || !inter_wrap) {
         throw std::runtime_error("Failed to create components of an intermediate instance!");
     }
 
     // Configure the components (connect them)
+    ipx_ring_wait_set(ring_wrap.get(), bwait);
     ipx_ctx_ring_src_set(inter_wrap.get(), ring_wrap.get());
     _instance_buffer = ring_wrap.release();
     _ctx = inter_wrap.release();
@@ -66,22 +70,24 @@ ipx_instance_intermediate::internals_init(const struct ipx_ctx_callbacks *cbs, u
 }
 
 ipx_instance_intermediate::ipx_instance_intermediate(const std::string &name,
-    ipx_plugin_mgr::plugin_ref *ref, uint32_t bsize)
+    ipx_plugin_mgr::plugin_ref *ref, uint32_t bsize, enum ipx_ring_type btype,
+    enum ipx_ring_wait bwait)
     : ipx_instance(name, ref) // The base class takes care of the plugin reference
 {
     // Get the plugin callbacks
     const ipx_plugin_mgr::plugin *plugin = _plugin_ref->get_plugin();
     const struct ipx_ctx_callbacks *cbs = plugin->get_callbacks();
     assert(cbs != nullptr && plugin->get_type() == IPX_PT_INTERMEDIATE);
-    internals_init(cbs, bsize);
+    internals_init(cbs, bsize, btype, bwait);
 }
 
 ipx_instance_intermediate::ipx_instance_intermediate(const std::string &name,
-    const ipx_ctx_callbacks *cbs, uint32_t bsize)
+    const ipx_ctx_callbacks *cbs, uint32_t bsize, enum ipx_ring_type btype,
+    enum ipx_ring_wait bwait)
     : ipx_instance(name, nullptr) // No plugin reference is passed to the base class
 {
     // Pass user defined callbacks
-    internals_init(cbs, bsize);
+    internals_init(cbs, bsize, btype, bwait);
 }
 
 ipx_instance_intermediate::~ipx_instance_intermediate()
@@ -129,9 +135,73 @@ ipx_instance_intermediate::get_input()
     return _instance_buffer;
 }
 
+void
+ipx_instance_intermediate::stats_print(double interval)
+{
+    stats_print_ctx(_ctx, _instance_buffer, _stats_prev, interval);
+}
+
 void
 ipx_instance_intermediate::connect_to(ipx_instance_intermediate &intermediate)
 {
     assert(_state == state::NEW); // Only configuration of an uninitialized instance can be changed!
     ipx_ctx_ring_dst_set(_ctx, intermediate.get_input());
-}
\ No newline at end of file
+}
+
+void
+ipx_instance_intermediate::set_batching(bool en)
+{
+    assert(_state == state::NEW); // Only configuration of an uninitialized instance can be changed!
+    ipx_ctx_batch_set(_ctx, en);
+}
+
+void
+ipx_instance_intermediate::set_relay(bool en)
+{
+    assert(_state == state::NEW); // Only configuration of an uninitialized instance can be changed!
+    ipx_ctx_relay_set(_ctx, en);
+}
+
+void
+ipx_instance_intermediate::set_branch(int branch)
+{
+    assert(_state == state::NEW); // Only configuration of an uninitialized instance can be changed!
+    ipx_ctx_branch_set(_ctx, branch);
+}
+
+bool
+ipx_instance_intermediate::accepts_relay()
+{
+    if (!_plugin_ref) {
+        // Internal instances (e.g. the output manager) don't access Data Records
+        return true;
+    }
+
+    const struct ipx_plugin_info *info = _plugin_ref->get_plugin()->get_callbacks()->info;
+    return (info->flags & IPX_PF_RAW) != 0;
+}
+
+void
+ipx_instance_intermediate::set_affinity(const std::vector<uint16_t> &cpus, int node)
+{
+    assert(_state == state::NEW); // Only configuration of an uninitialized instance can be changed!
+    ipx_instance::set_affinity(cpus, node);
+    if (node >= 0) {
+        // Failure is not fatal (a warning is printed)
+        ipx_ring_node_set(_instance_buffer, static_cast<unsigned int>(node));
+    }
+}
+
+void
+ipx_instance_intermediate::set_buffer_max(uint32_t max)
+{
+    assert(_state == state::NEW); // Only configuration of an uninitialized instance can be changed!
+    if (ipx_ring_type_get(_instance_buffer) != IPX_RING_TYPE_BLOCK) {
+        return;
+    }
+
+    if (ipx_ring_adaptive_set(_instance_buffer, max) != IPX_OK) {
+        throw std::runtime_error("Failed to enable adaptive capacity of the input buffer of the "
+            "instance '" + _name + "'!");
+    }
+}
@@ -69,10 +69,13 @@
  */
 class ipx_instance_intermediate : public ipx_instance {
 private:
-    void internals_init(const struct ipx_ctx_callbacks *cbs, uint32_t bsize);
+    void internals_init(const struct ipx_ctx_callbacks *cbs, uint32_t bsize,
+        enum ipx_ring_type btype, enum ipx_ring_wait bwait);
 protected:
     /** Allow connector to enable multi-write mode                                               */
     friend void ipx_instance_input::connect_to(ipx_instance_intermediate &intermediate);
+    /** Allow sharded instances to configure their replicas                                     */
+    friend class ipx_instance_sharded;
 
     /** Input ring buffer                                                                        */
     ipx_ring_t *_instance_buffer;
@@ -89,9 +92,12 @@ public:
      * \param[in] name  Name of the instance
      * \param[in] ref   Reference to the plugin (will be automatically delete on destroy)
      * \param[in] bsize Size of the input ring buffer
+     * \param[in] btype Type of the input ring buffer
+     * \param[in] bwait Waiting strategy of the input ring buffer
      */
     ipx_instance_intermediate(const std::string &name, ipx_plugin_mgr::plugin_ref *ref,
-        uint32_t bsize);
+        uint32_t bsize, enum ipx_ring_type btype = IPX_RING_TYPE_BLOCK,
+        enum ipx_ring_wait bwait = IPX_RING_WAIT_DEFAULT);
 
     /**
      * \brief Create an instance of an intermediate plugin (static internal plugins only)
@@ -102,9 +108,12 @@ public:
      * \param[in] name  Name of the instance
      * \param[in] cbs   Plugin callbacks
      * \param[in] bsize Size of the input ring buffer
+     * \param[in] btype Type of the input ring buffer
+     * \param[in] bwait Waiting strategy of the input ring buffer
      */
     ipx_instance_intermediate(const std::string &name, const ipx_ctx_callbacks *cbs,
-        uint32_t bsize);
+        uint32_t bsize, enum ipx_ring_type btype = IPX_RING_TYPE_BLOCK,
+        enum ipx_ring_wait bwait = IPX_RING_WAIT_DEFAULT);
 
     /**
      * \brief Destroy the instance
@@ -153,6 +162,55 @@ public:
      */
     virtual void connect_to(ipx_instance_intermediate &intermediate);
 
+    /**
+     * \brief Enable/disable packing of passed IPFIX Messages into batches
+     * \see ipx_ctx_batch_set() for more details
+     * \param[in] en Enable/disable packing
+     */
+    virtual void
+    set_batching(bool en);
+
+    /**
+     * \brief Enable/disable relay mode (only counting of Data Records by parsers)
+     * \see ipx_ctx_relay_set() for more details
+     * \param[in] en Enable/disable relay mode
+     */
+    virtual void
+    set_relay(bool en);
+
+    /**
+     * \brief Restrict the instance to IPFIX Messages of a branch (all branches by default)
+     * \see ipx_ctx_branch_set() for more details
+     * \param[in] branch Identification of the branch (negative value == all branches)
+     */
+    virtual void
+    set_branch(int branch);
+
+    /**
+     * \brief Has the plugin declared that it doesn't need references to Data Records?
+     * \see #IPX_PF_RAW
+     * \return True or false
+     */
+    virtual bool
+    accepts_relay();
+
+    /**
+     * \brief Set CPU affinity of the thread and NUMA placement of the input ring buffer
+     * \param[in] cpus Allowed CPUs (if empty, not restricted)
+     * \param[in] node Preferred NUMA node of the input ring buffer (if negative, not changed)
+     * \throw runtime_error if the affinity cannot be set
+     */
+    void
+    set_affinity(const std::vector<uint16_t> &cpus, int node) override;
+
+    /**
+     * \brief Enable adaptive capacity of the input ring buffer
+     * \note Ignored if the type of the buffer doesn't support adaptive capacity.
+     * \param[in] max Maximal capacity of the input ring buffer
+     */
+    void
+    set_buffer_max(uint32_t max) override;
+
     /**
      * \brief Get the plugin context (read only)
      */
@@ -160,6 +218,23 @@ public:
     get_ctx() {
         return _ctx;
     }
+
+    /**
+     * \brief Does the instance own the plugin context?
+     * \param[in] ctx Plugin context
+     * \return True or false
+     */
+    virtual bool
+    owns_ctx(const ipx_ctx_t *ctx) {
+        return _ctx == ctx;
+    }
+
+    /**
+     * \brief Print runtime statistics of the instance and its input ring buffer
+     * \param[in] interval Time elapsed since the previous call (in seconds)
+     */
+    void
+    stats_print(double interval) override;
 };
 
 #endif //IPFIXCOL_INSTANCE_INTERMEDIATE_HPP
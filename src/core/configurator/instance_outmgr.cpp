@@ -39,10 +39,12 @@
  *
  */
 
+#include <cinttypes>
 #include "instance_outmgr.hpp"
 
 extern "C" {
 #include "../plugin_output_mgr.h"
+#include "../verbose.h"
 }
 
 /** Description of the internal output manager                                                   */
@@ -76,6 +78,9 @@ ipx_instance_outmgr::~ipx_instance_outmgr()
 
     // Now we can destroy its private data
     ipx_output_mgr_list_destroy(_list);
+    if (_list_prev != nullptr) {
+        ipx_output_mgr_list_destroy(_list_prev);
+    }
 }
 
 void ipx_instance_outmgr::init(const fds_iemgr_t *iemgr,
@@ -100,16 +105,128 @@ ipx_instance_outmgr::connect_to(ipx_instance_intermediate &intermediate)
 }
 
 void
-ipx_instance_outmgr::connect_to(ipx_instance_output &output)
+ipx_instance_outmgr::set_broadcast(uint32_t bsize)
+{
+    assert(_state == state::NEW); // Only configuration of an uninitialized instance can be changed!
+    assert(ipx_output_mgr_list_empty(_list) && "No output instances can be connected yet!");
+
+    std::shared_ptr<ipx_ring_t> ring(ipx_ring_init_type(bsize, false, IPX_RING_TYPE_BROADCAST),
+        &ipx_ring_destroy);
+    if (!ring || ipx_output_mgr_list_bcast_set(_list, ring.get()) != IPX_OK) {
+        throw std::runtime_error("Failed to create a broadcast ring buffer of the output manager!");
+    }
+
+    _bcast_ring = ring;
+}
+
+void
+ipx_instance_outmgr::connect_to(ipx_instance_output &output, enum ipx_output_mgr_overflow overflow)
 {
     assert(_state == state::NEW); // Only configuration of an uninitialized instance can be changed!
+    if (_bcast_ring && overflow != IPX_OUTPUT_MGR_OVERFLOW_BLOCK) {
+        throw std::runtime_error("Overflow policy of the output instance '" + output.get_name()
+            + "' is not supported if output instances share a broadcast ring buffer!");
+    }
+
+    if (_bcast_ring) {
+        // Replace the input ring buffer of the instance with a view of the broadcast ring
+        output.connect_bcast(_bcast_ring);
+    }
+
     auto connection = output.get_input();
 
     ipx_ring_t *ring = std::get<0>(connection);
     enum ipx_odid_filter_type filter_type = std::get<1>(connection);
     const ipx_orange_t *filter = std::get<2>(connection);
+    uint16_t branch = std::get<3>(connection);
 
-    if (ipx_output_mgr_list_add(_list, ring, filter_type, filter) != IPX_OK) {
+    if (ipx_output_mgr_list_add(_list, ring, filter_type, filter, branch, overflow) != IPX_OK) {
         throw std::runtime_error("Failed to connect an output instance to the output manager!");
     }
+
+    if (overflow != IPX_OUTPUT_MGR_OVERFLOW_BLOCK) {
+        _overflow_dests.emplace_back(_dests_cnt, output.get_name());
+    }
+    _dests_cnt++;
+}
+
+void
+ipx_instance_outmgr::reconf_prepare(const std::vector<std::pair<ipx_instance_output *,
+    enum ipx_output_mgr_overflow> > &outputs)
+{
+    assert(_state == state::RUNNING);
+    if (_bcast_ring) {
+        throw std::runtime_error("Output instances connected using a broadcast ring buffer cannot "
+            "be changed at runtime!");
+    }
+
+    if (_list_prev != nullptr) {
+        throw std::runtime_error("Another reconfiguration of output instances is in progress!");
+    }
+
+    std::unique_ptr<ipx_output_mgr_list_t, decltype(&ipx_output_mgr_list_destroy)> list(
+        ipx_output_mgr_list_create(), &ipx_output_mgr_list_destroy);
+    if (!list) {
+        throw std::runtime_error("Failed to initialize a list of output destinations!");
+    }
+
+    std::vector<std::pair<size_t, std::string> > overflow_dests;
+    for (size_t i = 0; i < outputs.size(); ++i) {
+        auto connection = outputs[i].first->get_input();
+        ipx_ring_t *ring = std::get<0>(connection);
+        enum ipx_odid_filter_type filter_type = std::get<1>(connection);
+        const ipx_orange_t *filter = std::get<2>(connection);
+        uint16_t branch = std::get<3>(connection);
+        enum ipx_output_mgr_overflow overflow = outputs[i].second;
+
+        if (ipx_output_mgr_list_add(list.get(), ring, filter_type, filter, branch, overflow)
+                != IPX_OK) {
+            throw std::runtime_error("Failed to connect an output instance to the output "
+                "manager!");
+        }
+
+        if (overflow != IPX_OUTPUT_MGR_OVERFLOW_BLOCK) {
+            overflow_dests.emplace_back(i, outputs[i].first->get_name());
+        }
+    }
+
+    if (ipx_output_mgr_list_replace(_list, list.get()) != IPX_OK) {
+        throw std::runtime_error("Failed to replace the list of output destinations!");
+    }
+
+    // The output manager will swap the content of both lists
+    _list_prev = list.release();
+    _overflow_dests_next = std::move(overflow_dests);
+}
+
+void
+ipx_instance_outmgr::reconf_finish()
+{
+    assert(_list_prev != nullptr && "No reconfiguration in progress!");
+    ipx_output_mgr_list_destroy(_list_prev);
+    _list_prev = nullptr;
+
+    _overflow_dests = std::move(_overflow_dests_next);
+    _overflow_dests_next.clear();
+}
+
+void
+ipx_instance_outmgr::stats_print(double interval)
+{
+    ipx_instance_intermediate::stats_print(interval);
+    if (_list_prev != nullptr) {
+        // The list of destinations might be replaced right now
+        return;
+    }
+
+    for (const auto &dest : _overflow_dests) {
+        struct ipx_output_mgr_stats stats;
+        if (ipx_output_mgr_list_stats_get(_list, dest.first, &stats) != IPX_OK) {
+            continue;
+        }
+
+        IPX_INFO("Statistics", "Output manager -> %s: dropped %" PRIu64 " msgs, delayed %" PRIu64
+            " msgs, backlog %" PRIu32 " msgs", dest.second.c_str(), stats.dropped, stats.spilled,
+            stats.backlog);
+    }
 }
\ No newline at end of file
@@ -42,6 +42,8 @@
 #ifndef IPFIXCOL_INSTANCE_OUTMGR_HPP
 #define IPFIXCOL_INSTANCE_OUTMGR_HPP
 
+#include <vector>
+#include <utility>
 #include "instance_intermediate.hpp"
 #include "instance_output.hpp"
 
@@ -60,6 +62,9 @@ extern "C" {
  * \note
  *   The output manager must be connected to at least one output instance before it can be
  *   initialized!
+ * \note
+ *   In the broadcast mode (see set_broadcast()), output instances read messages from a shared
+ *   broadcast ring buffer instead of their own input ring buffers.
  *
  * \verbatim
  *                +--------+
@@ -73,6 +78,17 @@ class ipx_instance_outmgr : public ipx_instance_intermediate {
 private:
     /** List of output plugins                                                                   */
     ipx_output_mgr_list_t *_list;
+    /** Broadcast ring buffer shared with output instances (nullptr, if not used)               */
+    std::shared_ptr<ipx_ring_t> _bcast_ring;
+    /** Names of connected output instances with a non-blocking overflow policy (and indexes)   */
+    std::vector<std::pair<size_t, std::string> > _overflow_dests;
+    /** Number of connected output instances                                                    */
+    size_t _dests_cnt = 0;
+
+    /** Previous list of destinations (only during a runtime reconfiguration)                   */
+    ipx_output_mgr_list_t *_list_prev = nullptr;
+    /** Output instances with a non-blocking overflow policy after the reconfiguration         */
+    std::vector<std::pair<size_t, std::string> > _overflow_dests_next;
     /**
      * \brief Output plugin cannot be connected to any other instance
      * \param[in] intermediate Intermediate plugin
@@ -108,12 +124,72 @@ public:
      */
     void init(const fds_iemgr_t *iemgr, ipx_verb_level level);
 
+    /**
+     * \brief Pass messages to output instances using a single broadcast ring buffer
+     *
+     * Each message is written only once and the number of output instances is not limited.
+     * \note MUST be called before any output instance is connected!
+     * \see ipx_output_mgr_list_bcast_set() for more details
+     * \param[in] bsize Size of the broadcast ring buffer
+     * \throw runtime_error if the ring buffer cannot be created
+     */
+    void set_broadcast(uint32_t bsize);
+
     /**
      * \brief Connect the the output manager to an instance of an output plugin
-     * \param[in] output Output plugin to receive our messages
-     * \throw runtime_error if creating of the connection fails
+     * \param[in] output   Output plugin to receive our messages
+     * \param[in] overflow Policy applied when the input ring buffer of the output is full
+     * \throw runtime_error if creating of the connection fails or if the overflow policy is not
+     *   supported in the broadcast mode
+     */
+    void connect_to(ipx_instance_output &output,
+        enum ipx_output_mgr_overflow overflow = IPX_OUTPUT_MGR_OVERFLOW_BLOCK);
+
+    /**
+     * \brief Is the broadcast mode enabled?
+     * \return True or false
+     */
+    bool
+    is_broadcast() const {
+        return static_cast<bool>(_bcast_ring);
+    }
+
+    /**
+     * \brief Prepare a new list of output instances of the running output manager
+     *
+     * The list is applied when the output manager receives a reconfiguration message
+     * (#IPX_MSG_TERMINATE_RECONF). All new output instances must be already running and
+     * output instances that are present in both lists must use the same overflow policy to keep
+     * their backlogs. See ipx_output_mgr_list_replace() for more details.
+     * \note The broadcast mode is not supported.
+     * \param[in] outputs Output instances and their overflow policies
+     * \throw runtime_error if the list cannot be prepared or another reconfiguration hasn't
+     *   been finished yet
+     */
+    void
+    reconf_prepare(const std::vector<std::pair<ipx_instance_output *,
+        enum ipx_output_mgr_overflow> > &outputs);
+
+    /**
+     * \brief Finish the runtime reconfiguration
+     *
+     * The previous list of output instances is destroyed. From now on, the output manager doesn't
+     * write to output instances that are not in the new list.
+     * \warning MUST be called only after the reconfiguration message has been processed by all
+     *   new output instances (i.e. after #IPX_CPIPE_TYPE_RECONF_DONE notification)!
+     */
+    void
+    reconf_finish();
+
+    /**
+     * \brief Print runtime statistics of the output manager
+     *
+     * Number of dropped and delayed messages is printed for each output instance with
+     * a non-blocking overflow policy.
+     * \param[in] interval Time elapsed since the previous call (in seconds)
      */
-    void connect_to(ipx_instance_output &output);
+    void
+    stats_print(double interval) override;
 };
 
 #endif //IPFIXCOL_INSTANCE_OUTMGR_HPP
@@ -41,22 +41,29 @@
 
 #include "instance_output.hpp"
 
+extern "C" {
+#include "../message_base.h"
+#include "../message_terminate.h"
+}
+
 
 ipx_instance_output::ipx_instance_output(const std::string &name,
-    ipx_plugin_mgr::plugin_ref *ref, uint32_t bsize) : ipx_instance(name, ref)
+    ipx_plugin_mgr::plugin_ref *ref, uint32_t bsize, enum ipx_ring_type btype,
+    enum ipx_ring_wait bwait) : ipx_instance(name, ref)
 {
     // Get the plugin callbacks
     const ipx_plugin_mgr::plugin *plugin = _plugin_ref->get_plugin();
     const struct ipx_ctx_callbacks *cbs = plugin->get_callbacks();
     assert(cbs != nullptr && plugin->get_type() == IPX_PT_OUTPUT);
 
-    unique_ring ring_wrap(ipx_ring_init(bsize, false), &ipx_ring_destroy);
+    unique_ring ring_wrap(ipx_ring_init_type(bsize, false, btype), &ipx_ring_destroy);
     unique_ctx  output_wrap(ipx_ctx_create(name.c_str(), cbs), &ipx_ctx_destroy);
     if (!ring_wrap || !output_wrap) {
         throw std::runtime_error("Failed to create components of an output instance!");
     }
 
     // Configure the components (connect them)
+    ipx_ring_wait_set(ring_wrap.get(), bwait);
     ipx_ctx_ring_src_set(output_wrap.get(), ring_wrap.get());
     _instance_buffer = ring_wrap.release();
     _ctx = output_wrap.release();
@@ -64,14 +71,17 @@ ipx_instance_output::ipx_instance_output(const std::string &name,
     // Default parameters
     _type = IPX_ODID_FILTER_NONE;
     _filter = nullptr;
+    _branch = 0;
 }
 
 ipx_instance_output::~ipx_instance_output()
 {
     // Destroy context (if running, wait for termination of threads)
     ipx_ctx_destroy(_ctx);
-    // Now we can destroy buffers
-    ipx_ring_destroy(_instance_buffer);
+    // Now we can destroy buffers (views of the broadcast ring are owned by the ring)
+    if (!_bcast_ring) {
+        ipx_ring_destroy(_instance_buffer);
+    }
 
     if (_filter == nullptr) {
         return;
@@ -109,6 +119,13 @@ ipx_instance_output::set_filter(ipx_odid_filter_type type, const std::string &ex
     _filter = filter_wrap.release();
 }
 
+void
+ipx_instance_output::set_branch(uint16_t branch)
+{
+    assert(_state == state::NEW); // Only configuration of an uninitialized instance can be changed!
+    _branch = branch;
+}
+
 void ipx_instance_output::init(const std::string &params, const fds_iemgr_t *iemgr,
     ipx_verb_level level)
 {
@@ -136,8 +153,92 @@ ipx_instance_output::start()
     _state = state::RUNNING;
 }
 
-std::tuple<ipx_ring_t *, enum ipx_odid_filter_type, const ipx_orange_t *>
+std::tuple<ipx_ring_t *, enum ipx_odid_filter_type, const ipx_orange_t *, uint16_t>
 ipx_instance_output::get_input()
 {
-    return std::make_tuple(_instance_buffer, _type, _filter);
+    return std::make_tuple(_instance_buffer, _type, _filter, _branch);
+}
+
+void
+ipx_instance_output::connect_bcast(const std::shared_ptr<ipx_ring_t> &ring)
+{
+    assert(_state == state::NEW); // Only configuration of an uninitialized instance can be changed!
+    assert(!_bcast_ring && "The instance is already connected to a broadcast ring!");
+
+    ipx_ring_t *view = ipx_ring_bcast_reader_add(ring.get());
+    if (!view) {
+        throw std::runtime_error("Failed to connect an output instance to a broadcast ring!");
+    }
+
+    // Keep the waiting strategy of the original input ring buffer
+    ipx_ring_wait_set(view, ipx_ring_wait_get(_instance_buffer));
+    ipx_ctx_ring_src_set(_ctx, view);
+    ipx_ctx_odid_filter_set(_ctx, _type, _filter);
+    ipx_ctx_branch_set(_ctx, _branch);
+
+    ipx_ring_destroy(_instance_buffer);
+    _instance_buffer = view;
+    _bcast_ring = ring;
+}
+
+void
+ipx_instance_output::terminate()
+{
+    assert(_state == state::RUNNING); // Only running instances can be stopped
+    assert(!_bcast_ring && "Views of a broadcast ring buffer cannot be written!");
+
+    ipx_msg_terminate_t *msg = ipx_msg_terminate_create(IPX_MSG_TERMINATE_INSTANCE);
+    if (!msg) {
+        throw std::runtime_error("Failed to create a termination message of the output instance!");
+    }
+
+    // The instance is the only user of the message
+    ipx_msg_header_cnt_set(ipx_msg_terminate2base(msg), 1);
+    ipx_ring_push(_instance_buffer, ipx_msg_terminate2base(msg));
+}
+
+bool
+ipx_instance_output::accepts_batch()
+{
+    const struct ipx_plugin_info *info = _plugin_ref->get_plugin()->get_callbacks()->info;
+    return (info->flags & IPX_PF_BATCH) != 0;
+}
+
+bool
+ipx_instance_output::accepts_relay()
+{
+    assert(_state != state::NEW);
+    const struct ipx_plugin_info *info = _plugin_ref->get_plugin()->get_callbacks()->info;
+    return (info->flags & IPX_PF_RAW) != 0 || ipx_ctx_relay_get(_ctx);
+}
+
+void
+ipx_instance_output::set_affinity(const std::vector<uint16_t> &cpus, int node)
+{
+    assert(_state == state::NEW); // Only configuration of an uninitialized instance can be changed!
+    ipx_instance::set_affinity(cpus, node);
+    if (node >= 0) {
+        // Failure is not fatal (a warning is printed)
+        ipx_ring_node_set(_instance_buffer, static_cast<unsigned int>(node));
+    }
+}
+
+void
+ipx_instance_output::set_buffer_max(uint32_t max)
+{
+    assert(_state == state::NEW); // Only configuration of an uninitialized instance can be changed!
+    if (ipx_ring_type_get(_instance_buffer) != IPX_RING_TYPE_BLOCK) {
+        return;
+    }
+
+    if (ipx_ring_adaptive_set(_instance_buffer, max) != IPX_OK) {
+        throw std::runtime_error("Failed to enable adaptive capacity of the input buffer of the "
+            "instance '" + _name + "'!");
+    }
+}
+
+void
+ipx_instance_output::stats_print(double interval)
+{
+    stats_print_ctx(_ctx, _instance_buffer, _stats_prev, interval);
 }
\ No newline at end of file
@@ -77,6 +77,10 @@ protected:
     enum ipx_odid_filter_type _type;
     /** ODID filter (nullptr, if type == IPX_ODID_FILTER_NONE                                    */
     ipx_orange_t *_filter;
+    /** Branch of received IPFIX Messages                                                        */
+    uint16_t _branch;
+    /** Broadcast ring buffer shared with the output manager (nullptr, if not used)             */
+    std::shared_ptr<ipx_ring_t> _bcast_ring;
 public:
     /**
      * \brief Create an instance of an output plugin
@@ -88,9 +92,12 @@ public:
      * \param[in] name   Name of the instance
      * \param[in] ref    Reference to the plugin (will be automatically delete on destroy)
      * \param[in] bsize  Size of the input ring buffer
+     * \param[in] btype  Type of the input ring buffer
+     * \param[in] bwait  Waiting strategy of the input ring buffer
      */
     ipx_instance_output(const std::string &name, ipx_plugin_mgr::plugin_ref *ref,
-        uint32_t bsize);
+        uint32_t bsize, enum ipx_ring_type btype = IPX_RING_TYPE_BLOCK,
+        enum ipx_ring_wait bwait = IPX_RING_WAIT_DEFAULT);
     /**
      * \brief Destroy the instance
      * \note
@@ -110,6 +117,13 @@ public:
      */
     void set_filter(ipx_odid_filter_type type, const std::string &expr);
 
+    /**
+     * \brief Set the branch of received IPFIX Messages (the main branch by default)
+     * \see ipx_msg_ipfix_branch_get()
+     * \param[in] branch Identification of the branch
+     */
+    void set_branch(uint16_t branch);
+
     /**
      * \brief Initialize the instance
      *
@@ -133,10 +147,77 @@ public:
      * \brief Get the input ring buffer (for writing only)
      * \warning
      *   Do NOT use if there is already another active writer.
-     * \return Pointer to the ring buffer and the ODID filter.
+     * \return Pointer to the ring buffer, the ODID filter and the branch.
      */
-    std::tuple<ipx_ring_t *, enum ipx_odid_filter_type, const ipx_orange_t *>
+    std::tuple<ipx_ring_t *, enum ipx_odid_filter_type, const ipx_orange_t *, uint16_t>
     get_input();
+
+    /**
+     * \brief Read messages from a broadcast ring buffer instead of the input ring buffer
+     *
+     * The input ring buffer is replaced by a new reader view of the broadcast ring buffer
+     * (see get_input()). Since the writer doesn't filter messages, the ODID filter and the branch
+     * are applied by the instance itself.
+     * \note The ODID filter and the branch MUST be set before calling this function!
+     * \param[in] ring Broadcast ring buffer
+     * \throw runtime_error if the view cannot be created
+     */
+    void
+    connect_bcast(const std::shared_ptr<ipx_ring_t> &ring);
+
+    /**
+     * \brief Send a termination message directly to the input ring buffer of the instance
+     *
+     * Used to stop an instance that has been disconnected from the output manager during
+     * a runtime reconfiguration. All messages in the ring buffer are processed before the
+     * instance is stopped. The configurator is notified by #IPX_CPIPE_TYPE_TERM_DONE request
+     * when the message is destroyed.
+     * \warning There MUST NOT be any other active writer of the input ring buffer!
+     * \throw runtime_error if the message cannot be created
+     */
+    void
+    terminate();
+
+    /**
+     * \brief Is the plugin able to process batches of IPFIX Messages?
+     * \see #IPX_PF_BATCH
+     * \return True or false
+     */
+    bool
+    accepts_batch();
+
+    /**
+     * \brief Has the instance declared that it doesn't need references to Data Records?
+     * \see ipx_ctx_relay_set() and #IPX_PF_RAW
+     * \warning The instance MUST be already initialized.
+     * \return True or false
+     */
+    bool
+    accepts_relay();
+
+    /**
+     * \brief Set CPU affinity of the thread and NUMA placement of the input ring buffer
+     * \param[in] cpus Allowed CPUs (if empty, not restricted)
+     * \param[in] node Preferred NUMA node of the input ring buffer (if negative, not changed)
+     * \throw runtime_error if the affinity cannot be set
+     */
+    void
+    set_affinity(const std::vector<uint16_t> &cpus, int node) override;
+
+    /**
+     * \brief Enable adaptive capacity of the input ring buffer
+     * \note Ignored if the type of the buffer doesn't support adaptive capacity.
+     * \param[in] max Maximal capacity of the input ring buffer
+     */
+    void
+    set_buffer_max(uint32_t max) override;
+
+    /**
+     * \brief Print runtime statistics of the instance and its input ring buffer
+     * \param[in] interval Time elapsed since the previous call (in seconds)
+     */
+    void
+    stats_print(double interval) override;
 };
 
 #endif //IPFIXCOL_INSTANCE_OUTPUT_HPP
@@ -0,0 +1,295 @@
+/**
+ * \file src/core/configurator/instance_sharded.cpp
+ * \author agent <agent@local>
+ * \brief Sharded intermediate instance wrapper (source file)
+ * \date 2026
+ */
+
+/* Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is'', and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#include "instance_sharded.hpp"
+
+/** Description of the internal dispatcher                                                       */
+static const struct ipx_ctx_callbacks dispatcher_callbacks = {
+    // Static plugin, no library handles
+    nullptr,
+    &ipx_plugin_dispatcher_info,
+    // Only basic functions
+    &ipx_plugin_dispatcher_init,
+    &ipx_plugin_dispatcher_destroy,
+    nullptr, // No getter
+    &ipx_plugin_dispatcher_process,
+    nullptr  // No feedback
+};
+
+/**
+ * \brief Create an empty list of replicas of the dispatcher
+ * \param[in] key Distribution of messages among the replicas
+ * \throw runtime_error if a memory allocation fails
+ */
+void
+ipx_instance_sharded::list_init(enum ipx_dispatcher_key key)
+{
+    _list = ipx_dispatcher_list_create(key);
+    if (!_list) {
+        throw std::runtime_error("Failed to initialize a list of replicas!");
+    }
+}
+
+/**
+ * \brief Take ownership of a new replica and connect it to the dispatcher
+ * \param[in] replica Replica
+ * \throw runtime_error if the replica cannot be connected
+ */
+void
+ipx_instance_sharded::replica_add(ipx_instance_intermediate *replica)
+{
+    _replicas.emplace_back(replica);
+    ipx_ctx_merge_set(replica->_ctx, true);
+    if (ipx_dispatcher_list_add(_list, replica->get_input()) != IPX_OK) {
+        throw std::runtime_error("Failed to connect a replica to the dispatcher!");
+    }
+}
+
+ipx_instance_sharded::ipx_instance_sharded(const std::string &name, ipx_plugin_mgr &plugins,
+    const std::string &plugin, unsigned int threads, uint32_t bsize, enum ipx_ring_type btype,
+    enum ipx_ring_wait bwait)
+    : ipx_instance_intermediate(name + " (dispatcher)", &dispatcher_callbacks, bsize, btype, bwait)
+{
+    assert(threads > 0);
+    list_init(IPX_DISPATCHER_KEY_ODID);
+
+    try {
+        for (unsigned int i = 0; i < threads; ++i) {
+            std::string rname = name + " (" + std::to_string(i + 1) + ")";
+            ipx_plugin_mgr::plugin_ref *ref = plugins.plugin_get(IPX_PT_INTERMEDIATE, plugin);
+            replica_add(new ipx_instance_intermediate(rname, ref, bsize, btype, bwait));
+        }
+    } catch (...) {
+        _replicas.clear();
+        ipx_dispatcher_list_destroy(_list);
+        throw;
+    }
+}
+
+ipx_instance_sharded::ipx_instance_sharded(const std::string &name, const ipx_ctx_callbacks *cbs,
+    unsigned int threads, enum ipx_dispatcher_key key, uint32_t bsize, enum ipx_ring_type btype,
+    enum ipx_ring_wait bwait)
+    : ipx_instance_intermediate(name + " (dispatcher)", &dispatcher_callbacks, bsize, btype, bwait)
+{
+    assert(threads > 0);
+    list_init(key);
+
+    try {
+        for (unsigned int i = 0; i < threads; ++i) {
+            std::string rname = name + " (" + std::to_string(i + 1) + ")";
+            replica_add(new ipx_instance_intermediate(rname, cbs, bsize, btype, bwait));
+        }
+    } catch (...) {
+        _replicas.clear();
+        ipx_dispatcher_list_destroy(_list);
+        throw;
+    }
+}
+
+ipx_instance_sharded::~ipx_instance_sharded()
+{
+    // The dispatcher must be terminated first
+    ipx_ctx_destroy(_ctx);
+    _ctx = nullptr;
+
+    // Now we can destroy its private data (replicas are destroyed later)
+    ipx_dispatcher_list_destroy(_list);
+}
+
+void
+ipx_instance_sharded::init(const std::string &params, const fds_iemgr_t *iemgr,
+    ipx_verb_level level)
+{
+    assert(_state == state::NEW); // Only not initialized instance can be initialized
+    for (auto &replica : _replicas) {
+        replica->init(params, iemgr, level);
+    }
+
+    // Pass the list of replicas
+    ipx_ctx_private_set(_ctx, _list);
+    ipx_instance_intermediate::init("", iemgr, level);
+}
+
+void
+ipx_instance_sharded::init_each(const std::function<std::string(unsigned int)> &params,
+    const fds_iemgr_t *iemgr, ipx_verb_level level)
+{
+    assert(_state == state::NEW); // Only not initialized instance can be initialized
+    for (size_t idx = 0; idx < _replicas.size(); ++idx) {
+        _replicas[idx]->init(params(static_cast<unsigned int>(idx)), iemgr, level);
+    }
+
+    // Pass the list of replicas
+    ipx_ctx_private_set(_ctx, _list);
+    ipx_instance_intermediate::init("", iemgr, level);
+}
+
+void
+ipx_instance_sharded::start()
+{
+    assert(_state == state::INITIALIZED); // Only initialized instances can start
+    for (auto &replica : _replicas) {
+        replica->start();
+    }
+
+    ipx_instance_intermediate::start();
+}
+
+void
+ipx_instance_sharded::set_feedback(ipx_fpipe_t *feedback)
+{
+    assert(_state == state::NEW); // Only configuration of an uninitialized instance can be changed!
+    for (auto &replica : _replicas) {
+        ipx_ctx_fpipe_set(replica->_ctx, feedback);
+    }
+}
+
+void
+ipx_instance_sharded::connect_to(ipx_instance_intermediate &intermediate)
+{
+    assert(_state == state::NEW); // Only configuration of an uninitialized instance can be changed!
+    for (auto &replica : _replicas) {
+        replica->connect_to(intermediate);
+    }
+
+    if (_replicas.size() > 1) {
+        // Multiple writers (broadcast messages are passed only once, see ipx_ctx_merge_set())
+        ipx_ring_mw_mode(intermediate.get_input(), true);
+    }
+}
+
+bool
+ipx_instance_sharded::owns_ctx(const ipx_ctx_t *ctx)
+{
+    if (_ctx == ctx) {
+        return true;
+    }
+
+    for (auto &replica : _replicas) {
+        if (replica->owns_ctx(ctx)) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void
+ipx_instance_sharded::extensions_register(ipx_cfg_extensions *ext_mgr, size_t pos)
+{
+    ext_mgr->register_instance(_ctx, pos);
+    _replicas.front()->extensions_register(ext_mgr, pos);
+}
+
+void
+ipx_instance_sharded::extensions_resolve(ipx_cfg_extensions *ext_mgr)
+{
+    ext_mgr->update_instance(_ctx);
+    for (auto &replica : _replicas) {
+        replica->extensions_resolve(ext_mgr);
+    }
+}
+
+void
+ipx_instance_sharded::set_batching(bool en)
+{
+    // The dispatcher doesn't pass messages to the successor
+    for (auto &replica : _replicas) {
+        replica->set_batching(en);
+    }
+}
+
+void
+ipx_instance_sharded::set_relay(bool en)
+{
+    // The dispatcher doesn't parse messages
+    for (auto &replica : _replicas) {
+        replica->set_relay(en);
+    }
+}
+
+void
+ipx_instance_sharded::set_branch(int branch)
+{
+    // The dispatcher must distribute messages of all branches
+    for (auto &replica : _replicas) {
+        replica->set_branch(branch);
+    }
+}
+
+bool
+ipx_instance_sharded::accepts_relay()
+{
+    for (auto &replica : _replicas) {
+        if (!replica->accepts_relay()) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void
+ipx_instance_sharded::set_affinity(const std::vector<uint16_t> &cpus, int node)
+{
+    ipx_instance_intermediate::set_affinity(cpus, node);
+    for (auto &replica : _replicas) {
+        replica->set_affinity(cpus, node);
+    }
+}
+
+void
+ipx_instance_sharded::set_processing(bool en)
+{
+    ipx_ctx_processing_set(_ctx, en);
+    for (auto &replica : _replicas) {
+        replica->set_processing(en);
+    }
+}
+
+void
+ipx_instance_sharded::stats_print(double interval)
+{
+    ipx_instance_intermediate::stats_print(interval);
+    for (auto &replica : _replicas) {
+        replica->stats_print(interval);
+    }
+}
@@ -0,0 +1,262 @@
+/**
+ * \file src/core/configurator/instance_sharded.hpp
+ * \author agent <agent@local>
+ * \brief Sharded intermediate instance wrapper (header file)
+ * \date 2026
+ */
+
+/* Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is'', and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+
+#ifndef IPFIXCOL_INSTANCE_SHARDED_HPP
+#define IPFIXCOL_INSTANCE_SHARDED_HPP
+
+#include <functional>
+#include <memory>
+#include <vector>
+#include "instance_intermediate.hpp"
+#include "plugin_mgr.hpp"
+
+extern "C" {
+#include "../plugin_dispatcher.h"
+}
+
+/**
+ * \brief Sharded instance of an intermediate plugin
+ *
+ * The class takes care of (i.e. initialize, configure and destroy):
+ * - a plugin context of the dispatcher (implemented as an internal plugin)
+ * - an input ring buffer of the dispatcher (inherited from the base class)
+ * - replicas of the intermediate plugin (each with its own context and input ring buffer)
+ *
+ * IPFIX Messages are distributed among the replicas by a hash of their Transport Session and
+ * ODID, therefore, all messages of the same stream are processed by the same replica in the
+ * original order. Other messages are broadcast to all replicas and only the last replica that
+ * processed them passes them to the successor (see ipx_ctx_merge_set()).
+ *
+ * \note
+ *   The output ring buffer is not defined and MUST be connected before the plugin instances
+ *   can be initialized!
+ *
+ * \verbatim
+ *                               +---------+
+ *                            +--> Inter 1 +--+
+ *                +--------+  |  +---------+  |
+ *         +------> Dispa- +--+      ...      +----->
+ *          ring  | tcher  |  |  +---------+  |  (output not set yet)
+ *                +--------+  +--> Inter N +--+
+ *                               +---------+
+ * \endverbatim
+ */
+class ipx_instance_sharded : public ipx_instance_intermediate {
+private:
+    /** List of input ring buffers of the replicas                                               */
+    ipx_dispatcher_list_t *_list;
+    /** Replicas of the intermediate plugin                                                      */
+    std::vector<std::unique_ptr<ipx_instance_intermediate> > _replicas;
+
+    void list_init(enum ipx_dispatcher_key key);
+    void replica_add(ipx_instance_intermediate *replica);
+
+public:
+    /**
+     * \brief Create a sharded instance of an intermediate plugin
+     *
+     * \param[in] name    Name of the instance
+     * \param[in] plugins Plugin manager (the plugin is referenced once per each replica)
+     * \param[in] plugin  Identification name of the intermediate plugin
+     * \param[in] threads Number of replicas (at least 1)
+     * \param[in] bsize   Size of the input ring buffers
+     * \param[in] btype   Type of the input ring buffers
+     * \param[in] bwait   Waiting strategy of the input ring buffers
+     * \throw runtime_error if any component fails to initialize
+     */
+    ipx_instance_sharded(const std::string &name, ipx_plugin_mgr &plugins,
+        const std::string &plugin, unsigned int threads, uint32_t bsize,
+        enum ipx_ring_type btype = IPX_RING_TYPE_BLOCK,
+        enum ipx_ring_wait bwait = IPX_RING_WAIT_DEFAULT);
+    /**
+     * \brief Create a sharded instance of an intermediate plugin (static internal plugins only)
+     *
+     * \note This constructor is required by input instances for parallel parsing of IPFIX
+     *   Messages. Instead of accepting a plugin name, the constructor takes directly plugin
+     *   callbacks.
+     * \param[in] name    Name of the instance
+     * \param[in] cbs     Plugin callbacks
+     * \param[in] threads Number of replicas (at least 1)
+     * \param[in] key     Distribution of messages among the replicas
+     * \param[in] bsize   Size of the input ring buffers
+     * \param[in] btype   Type of the input ring buffers
+     * \param[in] bwait   Waiting strategy of the input ring buffers
+     * \throw runtime_error if any component fails to initialize
+     */
+    ipx_instance_sharded(const std::string &name, const ipx_ctx_callbacks *cbs,
+        unsigned int threads, enum ipx_dispatcher_key key, uint32_t bsize,
+        enum ipx_ring_type btype = IPX_RING_TYPE_BLOCK,
+        enum ipx_ring_wait bwait = IPX_RING_WAIT_DEFAULT);
+    /**
+     * \brief Destroy the instance
+     * \note
+     *   If the threads are running (start() has been called), the function blocks until the
+     *   threads are exited.
+     */
+    ~ipx_instance_sharded();
+
+    // Disable copy constructors
+    ipx_instance_sharded(const ipx_instance_sharded &) = delete;
+    ipx_instance_sharded & operator=(const ipx_instance_sharded &) = delete;
+
+    /**
+     * \brief Initialize the instance
+     *
+     * Initialize all replicas with the same parameters and the dispatcher.
+     * \param[in] params XML parameters of the instance
+     * \param[in] iemgr  Reference to the manager of Information Elements
+     * \param[in] level  Verbosity level
+     * \throw runtime_error if the function fails to initialize all components or if an output
+     *   plugin is not connected
+     */
+    void init(const std::string &params, const fds_iemgr_t *iemgr, ipx_verb_level level) override;
+
+    /**
+     * \brief Initialize the instance with different parameters of each replica
+     *
+     * Same as init(), however, XML parameters of each replica are provided by a function.
+     * \param[in] params Function returning XML parameters of the replica with the given index
+     *   (starting from 0)
+     * \param[in] iemgr  Reference to the manager of Information Elements
+     * \param[in] level  Verbosity level
+     * \throw runtime_error if the function fails to initialize all components or if an output
+     *   plugin is not connected
+     */
+    void init_each(const std::function<std::string(unsigned int)> &params,
+        const fds_iemgr_t *iemgr, ipx_verb_level level);
+
+    /**
+     * \brief Start threads of the replicas and the dispatcher
+     * \throw runtime_error if a thread fails to the start
+     */
+    void start() override;
+
+    /**
+     * \brief Connect all replicas to a feedback pipe of an input instance
+     * \param[in] feedback Feedback pipe (for writing only)
+     */
+    void set_feedback(ipx_fpipe_t *feedback);
+
+    /**
+     * \brief Connect all replicas to another instance of an intermediate plugin
+     * \param[in] intermediate Intermediate plugin to receive our messages
+     */
+    void connect_to(ipx_instance_intermediate &intermediate) override;
+
+    /**
+     * \brief Does any context of the instance match the given context?
+     * \param[in] ctx Plugin context
+     */
+    bool owns_ctx(const ipx_ctx_t *ctx) override;
+
+    /**
+     * \brief Registered extensions and dependencies
+     *
+     * \note Replicas are identical, therefore, only the first one is registered to avoid
+     *   conflicts of multiple producers of the same extension.
+     * \param[in] ext_mgr Extension manager
+     * \param[in] pos     Position of the instance in the collector pipeline
+     */
+    void
+    extensions_register(ipx_cfg_extensions *ext_mgr, size_t pos) override;
+
+    /**
+     * \brief Resolve definition of the extension/dependency definitions of all replicas
+     * \param[in] ext_mgr Extension manager
+     */
+    void
+    extensions_resolve(ipx_cfg_extensions *ext_mgr) override;
+
+    /**
+     * \brief Enable/disable packing of passed IPFIX Messages into batches by all replicas
+     * \param[in] en Enable/disable packing
+     */
+    void
+    set_batching(bool en) override;
+
+    /**
+     * \brief Enable/disable relay mode of all replicas
+     * \param[in] en Enable/disable relay mode
+     */
+    void
+    set_relay(bool en) override;
+
+    /**
+     * \brief Restrict all replicas to IPFIX Messages of a branch
+     * \param[in] branch Identification of the branch (negative value == all branches)
+     */
+    void
+    set_branch(int branch) override;
+
+    /**
+     * \brief Have all replicas declared that they don't need references to Data Records?
+     * \return True or false
+     */
+    bool
+    accepts_relay() override;
+
+    /**
+     * \brief Set CPU affinity of threads and NUMA placement of ring buffers of the dispatcher
+     *   and all replicas
+     * \param[in] cpus Allowed CPUs (if empty, not restricted)
+     * \param[in] node Preferred NUMA node of ring buffers (if negative, not changed)
+     * \throw runtime_error if the affinity cannot be set
+     */
+    void
+    set_affinity(const std::vector<uint16_t> &cpus, int node) override;
+
+    /**
+     * \brief Enable/disable processing of data messages by the dispatcher and all replicas
+     * \param[in] en Enable/disable processing
+     */
+    void
+    set_processing(bool en) override;
+
+    /**
+     * \brief Print runtime statistics of the dispatcher and all replicas
+     * \param[in] interval Time elapsed since the previous call (in seconds)
+     */
+    void
+    stats_print(double interval) override;
+};
+
+#endif //IPFIXCOL_INSTANCE_SHARDED_HPP
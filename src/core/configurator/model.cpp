@@ -52,6 +52,41 @@ extern "C" {
  * \brief Check common parameters of an instance
  * \param[in] base Plugin instance
  */
+bool
+ipx_plugin_base::operator==(const ipx_plugin_base &other) const
+{
+    return plugin == other.plugin && name == other.name && params == other.params
+        && verbosity == other.verbosity && ring_type == other.ring_type
+        && ring_wait == other.ring_wait && cpu_affinity == other.cpu_affinity
+        && numa_node == other.numa_node;
+}
+
+bool
+ipx_plugin_input::operator==(const ipx_plugin_input &other) const
+{
+    return ipx_plugin_base::operator==(other) && parser_threads == other.parser_threads
+        && msg_pool == other.msg_pool && parser_max_sources == other.parser_max_sources
+        && parser_state_file == other.parser_state_file
+        && parser_state_interval == other.parser_state_interval
+        && parser_pending_size == other.parser_pending_size
+        && parser_pending_timeout == other.parser_pending_timeout;
+}
+
+bool
+ipx_plugin_inter::operator==(const ipx_plugin_inter &other) const
+{
+    return ipx_plugin_base::operator==(other) && threads == other.threads
+        && branch == other.branch;
+}
+
+bool
+ipx_plugin_output::operator==(const ipx_plugin_output &other) const
+{
+    return ipx_plugin_base::operator==(other) && odid_type == other.odid_type
+        && odid_expression == other.odid_expression && overflow_policy == other.overflow_policy
+        && branch == other.branch;
+}
+
 void
 ipx_config_model::check_common(struct ipx_plugin_base *base)
 {
@@ -86,6 +121,23 @@ ipx_config_model::check_common(struct ipx_plugin_base *base)
         throw std::invalid_argument("Verbosity level '" + base->verbosity + "' of the instance '"
             + base->name + "' is not valid type!");
     }
+
+    if (!base->ring_type.empty()
+        && strcasecmp(base->ring_type.c_str(), "block") != 0
+        && strcasecmp(base->ring_type.c_str(), "lockfree") != 0
+        && strcasecmp(base->ring_type.c_str(), "default") != 0) {
+        throw std::invalid_argument("Ring buffer type '" + base->ring_type + "' of the instance '"
+            + base->name + "' is not valid type!");
+    }
+
+    if (!base->ring_wait.empty()
+        && strcasecmp(base->ring_wait.c_str(), "park") != 0
+        && strcasecmp(base->ring_wait.c_str(), "adaptive") != 0
+        && strcasecmp(base->ring_wait.c_str(), "spin") != 0
+        && strcasecmp(base->ring_wait.c_str(), "default") != 0) {
+        throw std::invalid_argument("Ring buffer waiting strategy '" + base->ring_wait + "' of the "
+            "instance '" + base->name + "' is not valid strategy!");
+    }
 }
 
 void
@@ -93,6 +145,20 @@ ipx_config_model::add_instance(struct ipx_plugin_input &instance)
 {
     // Check parameters and name collisions
     check_common(&instance);
+    if (instance.parser_threads == 0) {
+        throw std::invalid_argument("Number of parser threads ('<parserThreads>') of the instance '"
+            + instance.name + "' must be greater than zero!");
+    }
+
+    if (!instance.msg_pool.empty()
+        && strcasecmp(instance.msg_pool.c_str(), "disabled") != 0
+        && strcasecmp(instance.msg_pool.c_str(), "fixed") != 0
+        && strcasecmp(instance.msg_pool.c_str(), "adaptive") != 0
+        && strcasecmp(instance.msg_pool.c_str(), "default") != 0) {
+        throw std::invalid_argument("Mode of the message pool '" + instance.msg_pool + "' of the "
+            "instance '" + instance.name + "' is not valid mode!");
+    }
+
     for (struct ipx_plugin_input &input : inputs) {
         if (instance.name != input.name) {
             continue;
@@ -110,6 +176,11 @@ ipx_config_model::add_instance(struct ipx_plugin_inter &instance)
 {
     // Check parameters and name collisions
     check_common(&instance);
+    if (instance.threads == 0) {
+        throw std::invalid_argument("Number of threads ('<threads>') of the instance '"
+            + instance.name + "' must be greater than zero!");
+    }
+
     for (struct ipx_plugin_inter &inter : inters) {
         if (instance.name != inter.name) {
             continue;
@@ -142,6 +213,15 @@ ipx_config_model::add_instance(struct ipx_plugin_output &instance)
             "output instance '" + instance.name + "' cannot be empty!");
     }
 
+    if (!instance.overflow_policy.empty()
+        && strcasecmp(instance.overflow_policy.c_str(), "block") != 0
+        && strcasecmp(instance.overflow_policy.c_str(), "drop-newest") != 0
+        && strcasecmp(instance.overflow_policy.c_str(), "spill") != 0
+        && strcasecmp(instance.overflow_policy.c_str(), "default") != 0) {
+        throw std::invalid_argument("Overflow policy '" + instance.overflow_policy + "' of the "
+            "output instance '" + instance.name + "' is not valid policy!");
+    }
+
     outputs.push_back(instance);
 }
 
@@ -163,7 +243,11 @@ ipx_config_model::dump()
     // Intermediate plugins
     std::cout << "Intermediate plugins:\n";
     for (auto &inter : inters) {
-        std::cout << "\t- " << inter.plugin << " / " << inter.name << "\n";
+        std::cout << "\t- " << inter.plugin << " / " << inter.name;
+        if (!inter.branch.empty()) {
+            std::cout << " (branch: " << inter.branch << ")";
+        }
+        std::cout << "\n";
     }
 
     if (inters.empty()) {
@@ -175,7 +259,11 @@ ipx_config_model::dump()
     // Output plugins
     std::cout << "Output plugins:\n";
     for (auto &out : outputs) {
-        std::cout << "\t- " << out.plugin << " / " << out.name << "\n";
+        std::cout << "\t- " << out.plugin << " / " << out.name;
+        if (!out.branch.empty()) {
+            std::cout << " (branch: " << out.branch << ")";
+        }
+        std::cout << "\n";
     }
 
     if (outputs.empty()) {
@@ -59,13 +59,50 @@ struct ipx_plugin_base {
     std::string params;
     /** Verbosity mode (if empty, use default)                              */
     std::string verbosity;
+    /** Type of the input ring buffer (if empty, use default)               */
+    std::string ring_type;
+    /** Waiting strategy of the input ring buffer (if empty, use default)   */
+    std::string ring_wait;
+    /** List of allowed CPUs e.g. "0-3,8" (if empty, not restricted)        */
+    std::string cpu_affinity;
+    /** Preferred NUMA node (if negative, not restricted)                   */
+    int numa_node = -1;
+
+    /** \brief Compare all parameters                                       */
+    bool operator==(const ipx_plugin_base &other) const;
 };
 
 /** Configuration of an input plugin                                          */
-struct ipx_plugin_input  : ipx_plugin_base {};
+struct ipx_plugin_input  : ipx_plugin_base {
+    /** Number of threads of the NetFlow/IPFIX Message parser                 */
+    unsigned int parser_threads = 1;
+    /** Mode of the pool of IPFIX Messages (if empty, use default)            */
+    std::string msg_pool;
+    /** Maximum number of Transport Sessions and ODIDs per parser (0 = unlimited) */
+    unsigned int parser_max_sources = 0;
+    /** Path to the state file of parser templates (if empty, disabled)          */
+    std::string parser_state_file;
+    /** Interval between periodic saves of the state file (0 = only on exit)     */
+    unsigned int parser_state_interval = 0;
+    /** Maximum size of buffered Data Sets with unknown templates (if negative, use default) */
+    long parser_pending_size = -1;
+    /** Maximum age of buffered Data Sets with unknown templates (if negative, default) */
+    long parser_pending_timeout = -1;
+
+    /** \brief Compare all parameters                                         */
+    bool operator==(const ipx_plugin_input &other) const;
+};
 
 /** Configuration of an intermediate plugin                                   */
-struct ipx_plugin_inter  : ipx_plugin_base {};
+struct ipx_plugin_inter  : ipx_plugin_base {
+    /** Number of threads (i.e. replicas of the instance)                     */
+    unsigned int threads = 1;
+    /** Branch of processed IPFIX Messages (number or name, if empty, all branches) */
+    std::string branch;
+
+    /** \brief Compare all parameters                                         */
+    bool operator==(const ipx_plugin_inter &other) const;
+};
 
 /** Configuration of an output plugin                                         */
 struct ipx_plugin_output : ipx_plugin_base {
@@ -73,6 +110,13 @@ struct ipx_plugin_output : ipx_plugin_base {
     enum ipx_odid_filter_type odid_type;
     /** ODID filter expression                                                */
     std::string odid_expression;
+    /** Policy applied when the input ring buffer is full (if empty, use default) */
+    std::string overflow_policy;
+    /** Branch of received IPFIX Messages (number or name, if empty, the main branch) */
+    std::string branch;
+
+    /** \brief Compare all parameters                                         */
+    bool operator==(const ipx_plugin_output &other) const;
 };
 
 /** Parsed configuration of the collector                                      */
@@ -39,9 +39,14 @@
  *
  */
 
+#include <atomic>
+#include <cstdio>       // rename
+#include <fstream>
 #include <functional>
 #include <memory>
 #include <sstream>
+#include <system_error>
+#include <thread>
 
 #include <cstdlib>      // realpath
 #include <sys/types.h>  // stat
@@ -109,16 +114,37 @@ ipx_plugin_mgr::plugin_unload_unused()
     loaded.erase(std::remove_if(loaded.begin(), loaded.end(), func), loaded.end());
 }
 
+/** Header of the plugin index file */
+static const char *INDEX_HEADER = "ipfixcol2-plugin-index 1";
+/** Maximum number of threads used to open plugins */
+static const unsigned int SCAN_THREADS_MAX = 8;
+
+/**
+ * \brief Get the modification time of a file in nanoseconds
+ * \param[in] info Information about the file
+ * \return Timestamp
+ */
+static int64_t
+file_mtime(const struct stat &info)
+{
+    return static_cast<int64_t>(info.st_mtim.tv_sec) * 1000000000LL + info.st_mtim.tv_nsec;
+}
+
 /**
  * \brief Reload plugin cache
  *
  * The function tries to find all available plugins in paths specified by user. Information
  * about a type, a name and a path to each plugin is stored into the cache.
+ *
+ * If the plugin index is enabled, files with an up-to-date index entry are not opened at all.
+ * Other files are opened in parallel and the index is updated.
  */
 void ipx_plugin_mgr::cache_reload()
 {
     cache.clear();
 
+    // Find all candidate files (in the order of the search paths)
+    std::vector<struct scan_entry> files;
     for (const std::string &path : paths) {
         // Get the absolute path and information about a directory/file
         struct stat file_info;
@@ -132,10 +158,10 @@ void ipx_plugin_mgr::cache_reload()
 
         switch (file_info.st_mode & S_IFMT) {
         case S_IFDIR:
-            cache_add_dir(abs_path.get());
+            cache_add_dir(abs_path.get(), files);
             break;
         case S_IFREG:
-            cache_add_file(abs_path.get());
+            cache_add_file(abs_path.get(), files);
             break;
         default:
             IPX_WARNING(comp_str, "Unable to access to plugin(s) in '%s': Not a file or directory",
@@ -144,15 +170,86 @@ void ipx_plugin_mgr::cache_reload()
         }
     }
 
-    IPX_INFO(comp_str, "%zu plugins found", cache.size());
+    // Use the index to skip files that haven't been changed
+    std::map<std::string, struct index_entry> index;
+    index_load(index);
+
+    std::vector<struct scan_entry *> to_probe;
+    for (struct scan_entry &file : files) {
+        auto it = index.find(file.path);
+        if (it != index.end() && it->second.mtime == file.mtime && it->second.size == file.size) {
+            file.type = it->second.type;
+            file.name = it->second.name;
+            continue;
+        }
+
+        file.probe = true;
+        to_probe.push_back(&file);
+    }
+
+    // Open other files in parallel
+    if (!to_probe.empty()) {
+        std::atomic<size_t> next(0);
+        auto worker = [&to_probe, &next]() {
+            size_t idx;
+            while ((idx = next.fetch_add(1)) < to_probe.size()) {
+                cache_probe(*to_probe[idx]);
+            }
+        };
+
+        unsigned int threads_cnt = std::max(1U, std::thread::hardware_concurrency());
+        threads_cnt = std::min<size_t>({threads_cnt, SCAN_THREADS_MAX, to_probe.size()});
+        std::vector<std::thread> threads;
+        try {
+            for (unsigned int i = 1; i < threads_cnt; ++i) {
+                threads.emplace_back(worker);
+            }
+        } catch (const std::system_error &ex) {
+            // Not critical, remaining files are opened by this thread
+            IPX_DEBUG(comp_str, "Failed to start a plugin scanning thread: %s", ex.what());
+        }
+
+        worker();
+        for (std::thread &thread : threads) {
+            thread.join();
+        }
+    }
+
+    // Fill the cache and update the index (in the order of files)
+    bool index_changed = false;
+    for (const struct scan_entry &file : files) {
+        if (file.probe) {
+            if (!file.warning.empty()) {
+                IPX_WARNING(comp_str, "%s", file.warning.c_str());
+            }
+
+            if (file.type != 0) {
+                index[file.path] = {file.mtime, file.size, file.type, file.name};
+            } else {
+                index.erase(file.path);
+            }
+            index_changed = true;
+        }
+
+        if (file.type != 0) {
+            cache.push_back({file.type, file.name, file.path});
+        }
+    }
+
+    if (index_changed) {
+        index_save(index);
+    }
+
+    IPX_INFO(comp_str, "%zu plugins found (%zu opened)", cache.size(), to_probe.size());
 }
 
 /**
- * \brief Add plugins in a directory to the plugin cache (auxiliary function)
- * \param[in] path Plugin directory
+ * \brief Add plugins in a directory to the list of candidate files (auxiliary function)
+ * \param[in]  path  Plugin directory
+ * \param[out] files List of candidate files
  */
 void
-ipx_plugin_mgr::cache_add_dir(const char *path)
+ipx_plugin_mgr::cache_add_dir(const char *path, std::vector<struct scan_entry> &files)
 {
     auto delete_fn = [](DIR *dir) {closedir(dir);};
     std::unique_ptr<DIR, std::function<void(DIR*)>> dir_stream(opendir(path), delete_fn);
@@ -192,52 +289,158 @@ ipx_plugin_mgr::cache_add_dir(const char *path)
             continue;
         }
 
-        cache_add_file(abs_path.get());
+        cache_add_file(abs_path.get(), files);
     }
 }
 
 /**
- * \brief Add a plugin to the plugin cache (auxiliary function)
- * \param[in] path Absolute plugin path
+ * \brief Add a file to the list of candidate files (auxiliary function)
+ * \param[in]  path  Absolute plugin path
+ * \param[out] files List of candidate files
  */
 void
-ipx_plugin_mgr::cache_add_file(const char *path)
+ipx_plugin_mgr::cache_add_file(const char *path, std::vector<struct scan_entry> &files)
 {
-    // Clear previous errors
-    dlerror();
+    struct stat file_info;
+    if (stat(path, &file_info) == -1) {
+        const char *err_str;
+        ipx_strerror(errno, err_str);
+        IPX_WARNING(comp_str, "Unable to access to a plugin in '%s': %s", path, err_str);
+        return;
+    }
+
+    struct scan_entry entry;
+    entry.path = path;
+    entry.mtime = file_mtime(file_info);
+    entry.size = static_cast<int64_t>(file_info.st_size);
+    entry.probe = false;
+    entry.type = 0;
+    files.push_back(std::move(entry));
+}
+
+/**
+ * \brief Open a file and get a description of the plugin (auxiliary function)
+ *
+ * The function can be called by multiple threads at the same time (for different files).
+ * Instead of printing warnings, the warning message is stored in the entry.
+ * \param[in,out] file Candidate file (the type and name are filled on success)
+ */
+void
+ipx_plugin_mgr::cache_probe(struct scan_entry &file)
+{
+    const char *path = file.path.c_str();
 
     // Try to load the plugin (and unload it automatically)
     const int flags = RTLD_LAZY | RTLD_LOCAL;
     auto delete_fn = [](void *handle) {dlclose(handle);};
     std::unique_ptr<void, std::function<void(void*)>> handle(dlopen(path, flags), delete_fn);
     if (!handle) {
-        IPX_WARNING(comp_str, "Failed to open file '%s' as plugin: %s", path, dlerror());
+        const char *err_str = dlerror();
+        file.warning = "Failed to open file '" + file.path + "' as plugin: "
+            + std::string(err_str ? err_str : "unknown error");
         return;
     }
 
     // Find a description and check it
-    dlerror();
     void *sym = dlsym(handle.get(), "ipx_plugin_info");
     if (!sym) {
-        IPX_WARNING(comp_str, "Unable to get a plugin description of '%s': %s", path, dlerror());
+        file.warning = "Unable to get a plugin description of '" + file.path + "'";
         return;
     }
 
     struct ipx_plugin_info *info = reinterpret_cast<struct ipx_plugin_info *>(sym);
     if (!info->name || !info->dsc || !info->ipx_min || !info->version) {
-        IPX_WARNING(comp_str, "Description of a plugin in the file '%s' is not valid!", path);
+        file.warning = "Description of a plugin in the file '" + file.path + "' is not valid!";
         return;
     }
 
     uint16_t type = info->type;
     if (type != IPX_PT_INPUT && type != IPX_PT_INTERMEDIATE && type != IPX_PT_OUTPUT) {
-        IPX_WARNING(comp_str, "Plugin type of a plugin in the file '%s' is not valid!", path);
+        file.warning = "Plugin type of a plugin in the file '" + file.path + "' is not valid!";
         return;
     }
 
-    // Add the plugin to cache
-    struct cache_entry entry = {type, info->name, path};
-    cache.push_back(entry);
+    file.type = type;
+    file.name = info->name;
+}
+
+/**
+ * \brief Load the plugin index file (if enabled)
+ *
+ * Each line of the file (except the header) describes one plugin file: the path, the
+ * modification time, the size, the type and the name of the plugin (separated by tabs).
+ * Invalid or missing file is not an error, the index is just empty.
+ * \param[out] index Entries of the index
+ */
+void
+ipx_plugin_mgr::index_load(std::map<std::string, struct index_entry> &index)
+{
+    index.clear();
+    if (index_path.empty()) {
+        return;
+    }
+
+    std::ifstream stream(index_path);
+    std::string line;
+    if (!stream || !std::getline(stream, line) || line != INDEX_HEADER) {
+        IPX_DEBUG(comp_str, "Plugin index file '%s' is not available or not valid.",
+            index_path.c_str());
+        return;
+    }
+
+    while (std::getline(stream, line)) {
+        std::istringstream ss(line);
+        std::string path;
+        struct index_entry entry;
+        if (!std::getline(ss, path, '\t') || !(ss >> entry.mtime >> entry.size >> entry.type)
+                || ss.get() != '\t' || !std::getline(ss, entry.name) || entry.name.empty()) {
+            IPX_DEBUG(comp_str, "Plugin index file '%s' is not valid.", index_path.c_str());
+            index.clear();
+            return;
+        }
+
+        index[path] = entry;
+    }
+}
+
+/**
+ * \brief Save the plugin index file (if enabled)
+ *
+ * The file is replaced atomically, therefore, other collectors that share the file always
+ * read a complete index. Failures are not critical.
+ * \param[in] index Entries of the index
+ */
+void
+ipx_plugin_mgr::index_save(const std::map<std::string, struct index_entry> &index)
+{
+    if (index_path.empty()) {
+        return;
+    }
+
+    const std::string tmp_path = index_path + "." + std::to_string(getpid()) + ".tmp";
+    {
+        std::ofstream stream(tmp_path, std::ios::trunc);
+        stream << INDEX_HEADER << "\n";
+        for (const auto &it : index) {
+            stream << it.first << "\t" << it.second.mtime << " " << it.second.size << " "
+                << it.second.type << "\t" << it.second.name << "\n";
+        }
+
+        stream.flush();
+        if (!stream) {
+            IPX_WARNING(comp_str, "Failed to write plugin index file '%s'.", tmp_path.c_str());
+            std::remove(tmp_path.c_str());
+            return;
+        }
+    }
+
+    if (std::rename(tmp_path.c_str(), index_path.c_str()) != 0) {
+        const char *err_str;
+        ipx_strerror(errno, err_str);
+        IPX_WARNING(comp_str, "Failed to replace plugin index file '%s': %s",
+            index_path.c_str(), err_str);
+        std::remove(tmp_path.c_str());
+    }
 }
 
 ipx_plugin_mgr::plugin_ref *
@@ -252,6 +455,14 @@ ipx_plugin_mgr::plugin_get(uint16_t type, const std::string &name)
         return new ipx_plugin_mgr::plugin_ref(plugin);
     }
 
+    // Try to find a built-in plugin
+    const struct ipx_plugin_builtin *builtin = builtin_find(type, name);
+    if (builtin != nullptr) {
+        ipx_plugin_mgr::plugin *new_plugin = new plugin(*builtin);
+        loaded.push_back(new_plugin);
+        return new plugin_ref(new_plugin);
+    }
+
     //  Try to find the plugin in the cache
     if (cache.empty()) {
         cache_reload();
@@ -296,6 +507,28 @@ ipx_plugin_mgr::plugin_list()
     std::vector<struct list_entry> plugins_inter;
     std::vector<struct list_entry> plugins_output;
 
+    // Built-in plugins first, plugins in the cache with the same name are ignored
+    for (const struct ipx_plugin_builtin *builtin = ipx_plugin_builtins;
+            builtin != nullptr && builtin->info != nullptr; ++builtin) {
+        const struct ipx_plugin_info *info = builtin->info;
+        struct list_entry plugin_entry;
+        plugin_entry.type = info->type;
+        plugin_entry.name = info->name;
+        plugin_entry.description = info->dsc;
+        plugin_entry.version = info->version;
+        plugin_entry.path = "(built-in)";
+
+        switch (info->type) {
+        case IPX_PT_INPUT:        plugins_input.emplace_back(plugin_entry);  break;
+        case IPX_PT_INTERMEDIATE: plugins_inter.emplace_back(plugin_entry);  break;
+        case IPX_PT_OUTPUT:       plugins_output.emplace_back(plugin_entry); break;
+        default:
+            IPX_WARNING(comp_str, "Unexpected type of the built-in plugin '%s'. Skipping.",
+                info->name);
+            break;
+        }
+    }
+
     // Prepare descriptions of all plugins in the cache
     for (const cache_entry &cache_entry : cache) {
         // Copy basic parameters of plugins
@@ -503,6 +736,26 @@ ipx_plugin_mgr::version_check(const std::string &min_version)
     return true;
 }
 
+/**
+ * \brief Find a plugin built into the collector
+ * \param[in] type Plugin type
+ * \param[in] name Plugin name
+ * \return Pointer to the description of the plugin or nullptr (not found)
+ */
+const struct ipx_plugin_builtin *
+ipx_plugin_mgr::builtin_find(uint16_t type, const std::string &name)
+{
+    // The table is a weak symbol, i.e. it's not available if no plugin is built-in
+    for (const struct ipx_plugin_builtin *builtin = ipx_plugin_builtins;
+            builtin != nullptr && builtin->info != nullptr; ++builtin) {
+        if (builtin->info->type == type && name == builtin->info->name) {
+            return builtin;
+        }
+    }
+
+    return nullptr;
+}
+
 // -------------------------------------------------------------------------------------------------
 
 /**
@@ -571,6 +824,44 @@ ipx_plugin_mgr::plugin::plugin(const std::string &path, bool auto_unload)
         path.c_str());
 }
 
+/**
+ * \brief Class constructor (built-in plugin)
+ *
+ * Callbacks of the plugin are linked into the collector, so only their presence is checked.
+ * The plugin is never unloaded.
+ * \param[in] builtin Description of the built-in plugin
+ * \throw ipx_plugin_mgr::error if a required callback is missing
+ */
+ipx_plugin_mgr::plugin::plugin(const struct ipx_plugin_builtin &builtin)
+    : unload(false)
+{
+    ref_cnt = 0;
+    std::memset(&cbs, 0, sizeof(cbs));
+    cbs.handle = nullptr;
+    cbs.info = builtin.info;
+    cbs.init = builtin.init;
+    cbs.destroy = builtin.destroy;
+
+    // Only callbacks of the plugin type are used (consistent with dynamically loaded plugins)
+    const ipx_plugin_info *p_info = cbs.info;
+    if (p_info->type == IPX_PT_INPUT) {
+        cbs.get = builtin.get;
+        cbs.ts_close = builtin.ts_close;
+    } else {
+        cbs.process = builtin.process;
+    }
+
+    if (!cbs.init || !cbs.destroy || (p_info->type == IPX_PT_INPUT && !cbs.get)
+            || (p_info->type != IPX_PT_INPUT && !cbs.process)) {
+        throw ipx_plugin_mgr::error("Built-in plugin '" + std::string(p_info->name)
+            + "' doesn't provide all required callbacks");
+    }
+
+    name = p_info->name;
+    type = p_info->type;
+    IPX_DEBUG(comp_str, "Plugin '%s' is built into the collector.", name.c_str());
+}
+
 /**
  * \brief Class destructor
  */
@@ -581,7 +872,7 @@ ipx_plugin_mgr::plugin::~plugin()
             name.c_str());
     }
 
-    if (unload) {
+    if (unload && cbs.handle != nullptr) {
         dlclose(cbs.handle);
 
         const char *type_str;
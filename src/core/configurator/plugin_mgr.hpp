@@ -42,12 +42,14 @@
 #ifndef IPX_PLUGIN_MGR
 #define IPX_PLUGIN_MGR
 
+#include <map>
 #include <string>
 #include <vector>
 #include <stdexcept>
 
 extern "C" {
 #include "../context.h"
+#include "../plugin_builtin.h"
 }
 
 /**
@@ -72,6 +74,36 @@ private:
         std::string path;
     };
 
+    /** Plugin index entry (metadata of a plugin file from the last scan)              */
+    struct index_entry {
+        /** Modification time of the file (nanoseconds since the Epoch)                */
+        int64_t mtime;
+        /** Size of the file                                                           */
+        int64_t size;
+        /** Plugin type (one of #IPX_PT_INPUT, #IPX_PT_INTERMEDIATE, #IPX_PT_OUTPUT)   */
+        uint16_t type;
+        /** Plugin name                                                                */
+        std::string name;
+    };
+
+    /** Candidate plugin file found during a scan                                      */
+    struct scan_entry {
+        /** Absolute path to the file                                                  */
+        std::string path;
+        /** Modification time of the file (nanoseconds since the Epoch)                */
+        int64_t mtime;
+        /** Size of the file                                                           */
+        int64_t size;
+        /** The file must be opened to get its description (i.e. not indexed)         */
+        bool probe;
+        /** Plugin type (0 == not a valid plugin)                                      */
+        uint16_t type;
+        /** Plugin name                                                                */
+        std::string name;
+        /** Warning message of a failed probe                                          */
+        std::string warning;
+    };
+
     /** Description of a plugin (for output)                                           */
     struct list_entry {
         /** Plugin type (one of #IPX_PT_INPUT, #IPX_PT_INTERMEDIATE, #IPX_PT_OUTPUT)   */
@@ -98,12 +130,18 @@ private:
     std::vector<ipx_plugin_mgr::plugin *> loaded;
     /** Plugin cache (list of available plugins)                                       */
     std::vector<struct cache_entry> cache;
+    /** Path to the plugin index file (empty == disabled)                              */
+    std::string index_path;
 
     // Internal functions
     void cache_reload();
-    void cache_add_dir(const char *path);
-    void cache_add_file(const char *path);
+    void cache_add_dir(const char *path, std::vector<struct scan_entry> &files);
+    void cache_add_file(const char *path, std::vector<struct scan_entry> &files);
+    static void cache_probe(struct scan_entry &file);
+    void index_load(std::map<std::string, struct index_entry> &index);
+    void index_save(const std::map<std::string, struct index_entry> &index);
     static bool version_check(const std::string &min_version);
+    static const struct ipx_plugin_builtin *builtin_find(uint16_t type, const std::string &name);
     void plugin_load(const char *path, int type, const std::string name);
     void plugin_list_print(const std::string &name, const std::vector<struct list_entry> &list);
 
@@ -135,6 +173,8 @@ public:
      *   to automatically release plugins that are not required anymore.
      * \note On the first call, an internal plugin cache is build i.e. names and locations
      *   of all available plugins is stored.
+     * \note Plugins built into the collector (see ipx_plugin_builtins) take precedence over
+     *   plugins in the search paths, therefore, the cache is not required for them.
      *
      * \param[in]  name Name of the plugin
      * \param[in]  type Plugin type (one of #IPX_PT_INPUT, #IPX_PT_INTERMEDIATE, #IPX_PT_OUTPUT)
@@ -184,6 +224,20 @@ public:
     void
     path_add(const std::string &pathname);
 
+    /**
+     * \brief Set a path to the plugin index file
+     *
+     * The index file stores metadata (i.e. type and name) of plugins found during the last
+     * build of the plugin cache. Entries are identified by the path, modification time and size
+     * of each file. Only files without an up-to-date entry have to be opened during the next
+     * cache build. Therefore, libraries that are not used by the configuration are not loaded
+     * at all. The file is created (or updated) automatically.
+     * \note By default, the index is not used.
+     * \param[in] path Path to the file
+     */
+    void
+    index_set(const std::string &path) {index_path = path;};
+
     /**
      * \brief Enable/disable automatically unload of all plugins on destroy
      *
@@ -234,8 +288,9 @@ private:
     /** Reference counter (number of active instances)           */
     int ref_cnt;
 
-    // Private constructor and destructor accessible only from the manager
+    // Private constructors and destructor accessible only from the manager
     plugin(const std::string &path, bool auto_unload = true);
+    plugin(const struct ipx_plugin_builtin &builtin);
     virtual ~plugin();
 
     // Disable copy and move constructors
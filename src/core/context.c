@@ -39,8 +39,13 @@
  *
  */
 
+// Get GNU specific CPU affinity functions
+#define _GNU_SOURCE
+#include <assert.h>
+#include <stddef.h>
 #include <stdlib.h>
 #include <stdbool.h>
+#include <string.h>
 #include <inttypes.h>
 #include <pthread.h>
 #include <errno.h>
@@ -54,11 +59,19 @@
 #include "fpipe.h"
 #include "ring.h"
 #include "message_ipfix.h"
+#include "message_pool.h"
+#include "memory.h"
+#include "message_batch.h"
+#include "metrics.h"
+#include "trace.h"
 #include "configurator/cpipe.h"
 
 /** Identification of this component (for log) */
 const char *comp_str = "Context";
 
+/** Maximum number of messages received or passed by an instance thread at once */
+#define CTX_BATCH_SIZE (64U)
+
 /** List of permissions */
 enum ipx_ctx_permissions {
     /** Permission to pass a message              */
@@ -83,7 +96,8 @@ enum ipx_ctx_state {
 struct ipx_ctx {
     /** Instance identification name (usually from startup configuration)                        */
     char *name;
-    /** Plugin type (#IPX_PT_INPUT, #IPX_PT_INTERMEDIATE, #IPX_PT_OUTPUT or #IPX_PT_OUTPUT_MGR)  */
+    /** Plugin type (#IPX_PT_INPUT, #IPX_PT_INTERMEDIATE, #IPX_PT_OUTPUT, #IPX_PT_OUTPUT_MGR or
+     *  #IPX_PT_DISPATCHER)                                                                     */
     uint16_t type;
     /** Permission flags (see #ipx_ctx_permissions)                                              */
     uint32_t permissions;
@@ -120,6 +134,17 @@ struct ipx_ctx {
          * \note NULL for output plugins
          */
         ipx_ring_t *dst;
+        /**
+         * Messages waiting to be pushed into the destination ring buffer
+         * \note Used only by the instance thread (i.e. state == #IPX_CS_RUNNING). The thread
+         *   pushes all waiting messages to the ring at once before it waits for new messages.
+         */
+        struct {
+            /** Array of messages                                                                */
+            ipx_msg_t *msgs[CTX_BATCH_SIZE];
+            /** Number of valid messages in the array                                            */
+            uint32_t cnt;
+        } dst_batch;
     } pipeline; /**< Connection to internal communication pipeline                               */
 
     struct {
@@ -154,6 +179,24 @@ struct ipx_ctx {
          * the input plugins MUST have the value corresponding to the number of input instances.
          */
         unsigned int term_msg_cnt;
+        /** Merge non-IPFIX messages broadcast to replicas (see ipx_ctx_merge_set())             */
+        bool merge;
+        /** Pack passed IPFIX Messages into batches (see ipx_ctx_batch_set())                    */
+        bool batch;
+        /** References to Data Records are not needed/added (see ipx_ctx_relay_set())           */
+        bool relay;
+        /** Operation mode of the pool of IPFIX Messages (input plugins only)                    */
+        enum ipx_msg_pool_mode msg_pool;
+        /** Restrict the thread to the CPUs in the set (see ipx_ctx_affinity_set())              */
+        bool affinity;
+        /** Set of allowed CPUs (valid only if the affinity is enabled)                          */
+        cpu_set_t cpus;
+        /** ODID filter type of received IPFIX Messages (output plugins only)                    */
+        enum ipx_odid_filter_type odid_type;
+        /** ODID filter (NULL, if type == IPX_ODID_FILTER_NONE)                                  */
+        const ipx_orange_t *odid_filter;
+        /** Branch of processed IPFIX Messages (negative, if all branches)                      */
+        int branch;
     } cfg_system; /**< System configuration                                                      */
 
     struct {
@@ -162,6 +205,30 @@ struct ipx_ctx {
         /** Size of extension definitions in the array                                           */
         size_t items_cnt;
     } cfg_extension; /**< Extension configuration                                                */
+
+    /**
+     * Runtime statistics of the instance
+     * \warning Can be read by other threads! Therefore, modification MUST be always atomic.
+     */
+    struct ipx_ctx_stats stats;
+    struct {
+        /** Protection of the callback (it's called by other threads)                           */
+        pthread_mutex_t lock;
+        /** Callback providing statistics of the plugin (NULL, if not provided)                  */
+        ipx_ctx_stats_cb cb;
+        /** Private data of the callback                                                         */
+        void *data;
+    } stats_plugin; /**< Runtime statistics provided by the plugin                               */
+    /**
+     * Latency of IPFIX Messages processed by the instance (NULL, if not measured)
+     * \warning Can be read by other threads! See ipx_latency_record().
+     */
+    struct ipx_latency_hist *latency;
+    /**
+     * Memory accounting tag of the instance (NULL, if not accounted)
+     * \warning Can be updated by other threads! See ipx_mem_tag_add().
+     */
+    struct ipx_mem_tag *mem;
 };
 
 ipx_ctx_t *
@@ -189,9 +256,23 @@ ipx_ctx_create(const char *name, const struct ipx_ctx_callbacks *callbacks)
     ctx->cfg_system.msg_mask_selected = 0; // No messages to process selected
     ctx->cfg_system.msg_mask_allowed = IPX_MSG_IPFIX | IPX_MSG_SESSION;
     ctx->cfg_system.term_msg_cnt = 1; // By default, wait for 1 termination message
+    ctx->cfg_system.merge = false;
+    ctx->cfg_system.batch = false;
+    ctx->cfg_system.relay = false;
+    ctx->cfg_system.msg_pool = IPX_MSG_POOL_DISABLED;
+    ctx->cfg_system.affinity = false;
+    ctx->cfg_system.odid_type = IPX_ODID_FILTER_NONE;
+    ctx->cfg_system.odid_filter = NULL;
+    ctx->cfg_system.branch = -1;
 
     ctx->cfg_extension.items = NULL;
     ctx->cfg_extension.items_cnt = 0;
+    pthread_mutex_init(&ctx->stats_plugin.lock, NULL);
+
+    // Plugins allocate memory already during initialization
+    if (ipx_mem_enabled()) {
+        ctx->mem = ipx_mem_tag_create(); // If it fails, memory is just not accounted
+    }
 
     if (callbacks == NULL) {
         // Dummy context for testing
@@ -227,6 +308,7 @@ ipx_ctx_destroy(ipx_ctx_t *ctx)
         const char *plugin_name = ctx->plugin_cbs->info->name;
         IPX_CTX_DEBUG(ctx, "Calling instance destructor of the plugin '%s'", plugin_name);
 
+        ipx_ctx_stats_cb_set(ctx, NULL, NULL);
         ctx->plugin_cbs->destroy(ctx, ctx->cfg_plugin.private);
         ctx->pipeline.dst = tmp;
     }
@@ -238,6 +320,12 @@ ipx_ctx_destroy(ipx_ctx_t *ctx)
     }
     free(ctx->cfg_extension.items);
 
+    // No thread of the instance can update its metrics anymore
+    ipx_metrics_remove(ctx);
+
+    pthread_mutex_destroy(&ctx->stats_plugin.lock);
+    free(ctx->latency);
+    ipx_mem_tag_unref(ctx->mem); // Pools of messages might keep the tag
     free(ctx->name);
     free(ctx);
 }
@@ -287,6 +375,96 @@ ipx_ctx_term_cnt_set(ipx_ctx_t *ctx, unsigned int cnt)
     return IPX_OK;
 }
 
+void
+ipx_ctx_merge_set(ipx_ctx_t *ctx, bool en)
+{
+    ctx->cfg_system.merge = en;
+}
+
+void
+ipx_ctx_batch_set(ipx_ctx_t *ctx, bool en)
+{
+    ctx->cfg_system.batch = en;
+}
+
+void
+ipx_ctx_relay_set(ipx_ctx_t *ctx, bool en)
+{
+    ctx->cfg_system.relay = en;
+}
+
+bool
+ipx_ctx_relay_get(const ipx_ctx_t *ctx)
+{
+    return ctx->cfg_system.relay;
+}
+
+/**
+ * \brief Pool of IPFIX Messages of the input instance running in the current thread
+ * \note Set only by the thread of an input instance
+ */
+static __thread struct {
+    /** Context of the instance                                                              */
+    const ipx_ctx_t *ctx;
+    /** Pool (can be NULL)                                                                   */
+    ipx_msg_pool_t *pool;
+} ctx_msg_pool_tls = {NULL, NULL};
+
+void
+ipx_ctx_msg_pool_set(ipx_ctx_t *ctx, enum ipx_msg_pool_mode mode)
+{
+    ctx->cfg_system.msg_pool = mode;
+}
+
+void
+ipx_ctx_odid_filter_set(ipx_ctx_t *ctx, enum ipx_odid_filter_type type,
+    const ipx_orange_t *filter)
+{
+    ctx->cfg_system.odid_type = (filter != NULL) ? type : IPX_ODID_FILTER_NONE;
+    ctx->cfg_system.odid_filter = filter;
+}
+
+void
+ipx_ctx_branch_set(ipx_ctx_t *ctx, int branch)
+{
+    ctx->cfg_system.branch = (branch >= 0) ? branch : -1;
+}
+
+int
+ipx_ctx_affinity_set(ipx_ctx_t *ctx, const uint16_t *cpus, size_t cnt)
+{
+    if (ctx->state != IPX_CS_NEW && ctx->state != IPX_CS_INIT) {
+        IPX_CTX_ERROR(ctx, "Unable to change CPU affinity of a running instance!");
+        return IPX_ERR_DENIED;
+    }
+
+    if (cnt == 0) {
+        ctx->cfg_system.affinity = false;
+        return IPX_OK;
+    }
+
+    CPU_ZERO(&ctx->cfg_system.cpus);
+    for (size_t i = 0; i < cnt; ++i) {
+        if (cpus[i] >= CPU_SETSIZE) {
+            IPX_CTX_ERROR(ctx, "Unable to set CPU affinity (CPU %" PRIu16 " is out of range)!",
+                cpus[i]);
+            ctx->cfg_system.affinity = false;
+            return IPX_ERR_ARG;
+        }
+        CPU_SET(cpus[i], &ctx->cfg_system.cpus);
+    }
+
+    ctx->cfg_system.affinity = true;
+    return IPX_OK;
+}
+
+ipx_msg_pool_t *
+ipx_ctx_msg_pool_get(const ipx_ctx_t *ctx)
+{
+    // Only the thread of the instance is the owner of the pool
+    return (ctx_msg_pool_tls.ctx == ctx) ? ctx_msg_pool_tls.pool : NULL;
+}
+
 int
 ipx_ctx_subscribe(ipx_ctx_t *ctx, const ipx_msg_mask_t *mask_new, ipx_msg_mask_t *mask_old)
 {
@@ -303,7 +481,7 @@ ipx_ctx_subscribe(ipx_ctx_t *ctx, const ipx_msg_mask_t *mask_new, ipx_msg_mask_t
         return IPX_OK;
     }
 
-    // Plugin can receive only IPFIX and Transport Session Messages
+    // Plugin can receive only IPFIX and Transport Session Messages (and garbage, see above)
     if (((*mask_new) & ~ctx->cfg_system.msg_mask_allowed) != 0) {
         // Mask includes prohibited types
         return IPX_ERR_FORMAT;
@@ -313,6 +491,315 @@ ipx_ctx_subscribe(ipx_ctx_t *ctx, const ipx_msg_mask_t *mask_new, ipx_msg_mask_t
     return IPX_OK;
 }
 
+/**
+ * \brief Increment a statistics counter of the instance
+ * \param[in] counter Counter
+ * \param[in] value   Value to add
+ */
+static inline void
+ctx_stats_add(uint64_t *counter, uint64_t value)
+{
+    __atomic_store_n(counter, __atomic_load_n(counter, __ATOMIC_RELAXED) + value,
+        __ATOMIC_RELAXED);
+}
+
+/**
+ * \brief Record latency of an IPFIX Message or of all IPFIX Messages in a batch
+ * \param[in] ctx Plugin context (with allocated histogram)
+ * \param[in] msg Message (other types are ignored)
+ * \param[in] now Current monotonic timestamp (see ipx_latency_now())
+ */
+static void
+ctx_latency_msg(ipx_ctx_t *ctx, ipx_msg_t *msg, uint64_t now)
+{
+    switch (ipx_msg_get_type(msg)) {
+    case IPX_MSG_IPFIX: {
+        const uint64_t ts = ipx_msg_ipfix_get_ctx(ipx_msg_base2ipfix(msg))->ingress_ts;
+        if (ts != 0 && ts <= now) {
+            ipx_latency_record(ctx->latency, now - ts);
+        }
+        } break;
+    case IPX_MSG_BATCH: {
+        ipx_msg_batch_t *batch = ipx_msg_base2batch(msg);
+        const uint32_t cnt = ipx_msg_batch_get_cnt(batch);
+        for (uint32_t i = 0; i < cnt; ++i) {
+            ctx_latency_msg(ctx, ipx_msg_ipfix2base(ipx_msg_batch_get(batch, i)), now);
+        }
+        } break;
+    default:
+        break;
+    }
+}
+
+/**
+ * \brief Is the plugin type an internal distributor of messages?
+ *
+ * The output manager and dispatchers are implemented as intermediate plugins, however, they
+ * don't use the standard output ring buffer and pass all types of messages on their own.
+ * \param[in] type Plugin type
+ * \return True or false
+ */
+static inline bool
+ctx_type_distributor(uint16_t type)
+{
+    return (type == IPX_PT_OUTPUT_MGR || type == IPX_PT_DISPATCHER);
+}
+
+/**
+ * \brief Does the plugin accept batches of IPFIX Messages?
+ * \param[in] ctx Plugin context
+ * \return True or false
+ */
+static inline bool
+ctx_batch_accepted(const ipx_ctx_t *ctx)
+{
+    return (ctx->plugin_cbs->info->flags & IPX_PF_BATCH) != 0;
+}
+
+/**
+ * \brief Does an IPFIX Message belong to the branch of the instance?
+ * \param[in] ctx Plugin context
+ * \param[in] msg IPFIX Message
+ * \return True or false
+ */
+static inline bool
+ctx_branch_accepted(const ipx_ctx_t *ctx, const ipx_msg_ipfix_t *msg)
+{
+    return ctx->cfg_system.branch < 0
+        || ctx->cfg_system.branch == (int) ipx_msg_ipfix_branch_get(msg);
+}
+
+/**
+ * \brief Do all IPFIX Messages of a batch belong to the branch of the instance?
+ * \param[in] ctx   Plugin context
+ * \param[in] batch Batch of IPFIX Messages
+ * \return True or false
+ */
+static inline bool
+ctx_branch_batch_accepted(const ipx_ctx_t *ctx, ipx_msg_batch_t *batch)
+{
+    if (ctx->cfg_system.branch < 0) {
+        return true;
+    }
+
+    const uint32_t cnt = ipx_msg_batch_get_cnt(batch);
+    for (uint32_t i = 0; i < cnt; ++i) {
+        if (!ctx_branch_accepted(ctx, ipx_msg_batch_get(batch, i))) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * \brief Does an IPFIX Message pass the ODID filter and the branch of the instance?
+ * \param[in] ctx Plugin context
+ * \param[in] msg IPFIX Message
+ * \return True or false
+ */
+static inline bool
+ctx_odid_accepted(const ipx_ctx_t *ctx, ipx_msg_ipfix_t *msg)
+{
+    if (!ctx_branch_accepted(ctx, msg)) {
+        return false;
+    }
+
+    switch (ctx->cfg_system.odid_type) {
+    case IPX_ODID_FILTER_ONLY:
+        return ipx_orange_in(ctx->cfg_system.odid_filter, ipx_msg_ipfix_get_ctx(msg)->odid);
+    case IPX_ODID_FILTER_EXCEPT:
+        return !ipx_orange_in(ctx->cfg_system.odid_filter, ipx_msg_ipfix_get_ctx(msg)->odid);
+    default:
+        return true;
+    }
+}
+
+/**
+ * \brief Do all IPFIX Messages of a batch pass the ODID filter and the branch of the instance?
+ * \param[in] ctx   Plugin context
+ * \param[in] batch Batch of IPFIX Messages
+ * \return True or false
+ */
+static inline bool
+ctx_odid_batch_accepted(const ipx_ctx_t *ctx, ipx_msg_batch_t *batch)
+{
+    if (ctx->cfg_system.odid_type == IPX_ODID_FILTER_NONE) {
+        return ctx_branch_batch_accepted(ctx, batch);
+    }
+
+    const uint32_t cnt = ipx_msg_batch_get_cnt(batch);
+    for (uint32_t i = 0; i < cnt; ++i) {
+        if (!ctx_odid_accepted(ctx, ipx_msg_batch_get(batch, i))) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * \brief Is the plugin subscribed to a type of message?
+ * \note Batches are considered to be IPFIX Messages
+ * \param[in] ctx  Plugin context
+ * \param[in] type Type of the message
+ * \return True or false
+ */
+static inline bool
+ctx_msg_subscribed(const ipx_ctx_t *ctx, enum ipx_msg_type type)
+{
+    ipx_msg_mask_t mask = (type == IPX_MSG_BATCH) ? IPX_MSG_IPFIX : type;
+    return (mask & ctx->cfg_system.msg_mask_selected) != 0;
+}
+
+/**
+ * \brief Pack consecutive IPFIX Messages waiting for the destination ring buffer into batches
+ *
+ * If a batch cannot be created (memory allocation error), messages are left as they are.
+ * \param[in] ctx Plugin context
+ */
+static void
+ctx_dst_pack(ipx_ctx_t *ctx)
+{
+    ipx_msg_t **msgs = ctx->pipeline.dst_batch.msgs;
+    const uint32_t cnt = ctx->pipeline.dst_batch.cnt;
+    uint32_t idx = 0;
+    uint32_t out = 0;
+
+    while (idx < cnt) {
+        uint32_t end = idx;
+        while (end < cnt && ipx_msg_get_type(msgs[end]) == IPX_MSG_IPFIX) {
+            end++;
+        }
+
+        ipx_msg_batch_t *batch;
+        if (end - idx > 1 && (batch = ipx_msg_batch_create(&msgs[idx], end - idx)) != NULL) {
+            msgs[out++] = ipx_msg_batch2base(batch);
+            idx = end;
+            continue;
+        }
+
+        // A single or non-IPFIX message
+        if (end == idx) {
+            end++;
+        }
+        while (idx < end) {
+            msgs[out++] = msgs[idx++];
+        }
+    }
+
+    ctx->pipeline.dst_batch.cnt = out;
+}
+
+/**
+ * \brief Push all waiting messages into the destination ring buffer
+ * \param[in] ctx Plugin context
+ */
+static inline void
+ctx_dst_flush(ipx_ctx_t *ctx)
+{
+    if (ctx->pipeline.dst_batch.cnt == 0) {
+        return;
+    }
+
+    if (ctx->cfg_system.batch) {
+        ctx_dst_pack(ctx);
+    }
+
+    if (ctx->latency != NULL) {
+        // Processing of the messages by this instance is done
+        const uint64_t now = ipx_latency_now();
+        for (uint32_t i = 0; i < ctx->pipeline.dst_batch.cnt; ++i) {
+            ctx_latency_msg(ctx, ctx->pipeline.dst_batch.msgs[i], now);
+        }
+    }
+
+    ipx_ring_push_bulk(ctx->pipeline.dst, ctx->pipeline.dst_batch.msgs,
+        ctx->pipeline.dst_batch.cnt);
+    ctx_stats_add(&ctx->stats.msg_pass, ctx->pipeline.dst_batch.cnt);
+    ctx->pipeline.dst_batch.cnt = 0;
+}
+
+/**
+ * \brief Merge a message broadcast by a dispatcher to all replicas
+ *
+ * If the context is a replica (see ipx_ctx_merge_set()) and the message has been broadcast,
+ * all messages waiting in the batch are pushed first and the reference counter of the message
+ * is decremented.
+ * \param[in] ctx Plugin context
+ * \param[in] msg Message to pass or destroy
+ * \return True if the caller is the owner of the message (i.e. it should pass or destroy it)
+ * \return False if the message is owned by another replica
+ */
+static inline bool
+ctx_msg_merge(ipx_ctx_t *ctx, ipx_msg_t *msg)
+{
+    enum ipx_msg_type type = ipx_msg_get_type(msg);
+    if (!ctx->cfg_system.merge || type == IPX_MSG_IPFIX || type == IPX_MSG_BATCH
+            || __atomic_load_n(&msg->ref_cnt, __ATOMIC_RELAXED) == 0) {
+        return true;
+    }
+
+    // The message must not overtake messages of this replica
+    ctx_dst_flush(ctx);
+    return ipx_msg_header_cnt_dec(msg);
+}
+
+/**
+ * \brief Add a message to the batch of messages for the destination ring buffer
+ *
+ * \warning Can be used only by the instance thread! If the batch is full, all messages are
+ *   immediately pushed into the ring buffer.
+ * \param[in] ctx Plugin context
+ * \param[in] msg Message to pass
+ */
+static inline void
+ctx_dst_push(ipx_ctx_t *ctx, ipx_msg_t *msg)
+{
+    if (!ctx_msg_merge(ctx, msg)) {
+        // Another replica will pass the message
+        return;
+    }
+
+    ctx->pipeline.dst_batch.msgs[ctx->pipeline.dst_batch.cnt++] = msg;
+    if (ctx->pipeline.dst_batch.cnt == CTX_BATCH_SIZE) {
+        ctx_dst_flush(ctx);
+    }
+}
+
+/**
+ * \brief Move IPFIX Messages of the main branch to the branch of the instance
+ * \param[in] ctx Plugin context
+ * \param[in] msg IPFIX Message or a batch (other messages are ignored)
+ */
+static void
+ctx_branch_tag(ipx_ctx_t *ctx, ipx_msg_t *msg)
+{
+    const uint16_t branch = (uint16_t) ctx->cfg_system.branch;
+    enum ipx_msg_type msg_type = ipx_msg_get_type(msg);
+
+    if (msg_type == IPX_MSG_IPFIX) {
+        ipx_msg_ipfix_t *ipfix_msg = ipx_msg_base2ipfix(msg);
+        if (ipx_msg_ipfix_branch_get(ipfix_msg) == 0) {
+            ipx_msg_ipfix_branch_set(ipfix_msg, branch);
+        }
+        return;
+    }
+
+    if (msg_type != IPX_MSG_BATCH) {
+        return;
+    }
+
+    ipx_msg_batch_t *batch = ipx_msg_base2batch(msg);
+    const uint32_t cnt = ipx_msg_batch_get_cnt(batch);
+    for (uint32_t i = 0; i < cnt; ++i) {
+        ipx_msg_ipfix_t *ipfix_msg = ipx_msg_batch_get(batch, i);
+        if (ipx_msg_ipfix_branch_get(ipfix_msg) == 0) {
+            ipx_msg_ipfix_branch_set(ipfix_msg, branch);
+        }
+    }
+}
+
 int
 ipx_ctx_msg_pass(ipx_ctx_t *ctx, ipx_msg_t *msg)
 {
@@ -323,6 +810,12 @@ ipx_ctx_msg_pass(ipx_ctx_t *ctx, ipx_msg_t *msg)
         return IPX_ERR_ARG;
     }
 
+    IPX_TRACE2(ctx_msg_pass, ctx->name, msg);
+    if (ctx->cfg_system.branch > 0) {
+        // New IPFIX Messages of the plugin belong to the branch of the instance
+        ctx_branch_tag(ctx, msg);
+    }
+
     if (!ctx->pipeline.dst) {
         /* Plugin has permission but the successor is not connected. This can happen only if
          * the destructor is called immediately after initialization without prepared pipeline ->
@@ -332,7 +825,14 @@ ipx_ctx_msg_pass(ipx_ctx_t *ctx, ipx_msg_t *msg)
         return IPX_OK;
     }
 
-    ipx_ring_push(ctx->pipeline.dst, msg);
+    if (ctx->state != IPX_CS_RUNNING) {
+        // Not called by the instance thread (e.g. a dummy context for testing)
+        ipx_ring_push(ctx->pipeline.dst, msg);
+        ctx_stats_add(&ctx->stats.msg_pass, 1U);
+        return IPX_OK;
+    }
+
+    ctx_dst_push(ctx, msg);
     return IPX_OK;
 }
 
@@ -462,9 +962,19 @@ ipx_ctx_ext_create(ipx_ctx_t *ctx, const char *type, const char *name)
     return IPX_OK;
 }
 
-int
-ipx_ctx_ext_producer(ipx_ctx_t *ctx, const char *type, const char *name, size_t size,
-    ipx_ctx_ext_t **ext)
+/**
+ * \brief Register an extension producer (common for both storage types)
+ * \param[in]  ctx      Plugin context
+ * \param[in]  type     Identification of the extension type
+ * \param[in]  name     Identification of the extension name
+ * \param[in]  size     Size of the extension
+ * \param[in]  columnar Columnar storage of the extension
+ * \param[out] ext      Internal description of the extension
+ * \return #IPX_OK on success or an error code (see ipx_ctx_ext_producer())
+ */
+static int
+ipx_ctx_ext_producer_add(ipx_ctx_t *ctx, const char *type, const char *name, size_t size,
+    bool columnar, ipx_ctx_ext_t **ext)
 {
     struct ipx_ctx_ext *rec = NULL;
     int rc = IPX_OK;
@@ -479,16 +989,32 @@ ipx_ctx_ext_producer(ipx_ctx_t *ctx, const char *type, const char *name, size_t
     }
 
     rec = &ctx->cfg_extension.items[ctx->cfg_extension.items_cnt - 1];
-    if ((rc = ipx_ctx_ext_init(rec, IPX_EXTENSION_PRODUCER, type, name, size)) != IPX_OK) {
+    rc = ipx_ctx_ext_init(rec, IPX_EXTENSION_PRODUCER, type, name, size, columnar);
+    if (rc != IPX_OK) {
         ctx->cfg_extension.items_cnt--; // The added extension is not valid!
         return rc;
     }
 
-    IPX_CTX_DEBUG(ctx, "Data Record extension '%s/%s' has been registered.", type, name);
+    IPX_CTX_DEBUG(ctx, "Data Record extension '%s/%s' has been registered%s.", type, name,
+        columnar ? " (columnar)" : "");
     *ext = rec;
     return IPX_OK;
 }
 
+int
+ipx_ctx_ext_producer(ipx_ctx_t *ctx, const char *type, const char *name, size_t size,
+    ipx_ctx_ext_t **ext)
+{
+    return ipx_ctx_ext_producer_add(ctx, type, name, size, false, ext);
+}
+
+int
+ipx_ctx_ext_producer_columnar(ipx_ctx_t *ctx, const char *type, const char *name, size_t size,
+    ipx_ctx_ext_t **ext)
+{
+    return ipx_ctx_ext_producer_add(ctx, type, name, size, true, ext);
+}
+
 int
 ipx_ctx_ext_consumer(ipx_ctx_t *ctx, const char *type, const char *name, ipx_ctx_ext_t **ext)
 {
@@ -506,7 +1032,7 @@ ipx_ctx_ext_consumer(ipx_ctx_t *ctx, const char *type, const char *name, ipx_ctx
     }
 
     rec = &ctx->cfg_extension.items[ctx->cfg_extension.items_cnt - 1];
-    if ((rc = ipx_ctx_ext_init(rec, IPX_EXTENSION_CONSUMER, type, name, 0)) != IPX_OK) {
+    if ((rc = ipx_ctx_ext_init(rec, IPX_EXTENSION_CONSUMER, type, name, 0, false)) != IPX_OK) {
         ctx->cfg_extension.items_cnt--; // The added extension is not valid!
         return rc;
     }
@@ -522,6 +1048,132 @@ ipx_ctx_plugininfo_get(const ipx_ctx_t *ctx)
     return ctx->plugin_cbs->info;
 }
 
+void
+ipx_ctx_stats_get(const ipx_ctx_t *ctx, struct ipx_ctx_stats *stats)
+{
+    stats->msg_recv = __atomic_load_n(&ctx->stats.msg_recv, __ATOMIC_RELAXED);
+    stats->msg_pass = __atomic_load_n(&ctx->stats.msg_pass, __ATOMIC_RELAXED);
+}
+
+void
+ipx_ctx_stats_cb_set(ipx_ctx_t *ctx, ipx_ctx_stats_cb cb, void *data)
+{
+    pthread_mutex_lock(&ctx->stats_plugin.lock);
+    ctx->stats_plugin.cb = cb;
+    ctx->stats_plugin.data = data;
+    pthread_mutex_unlock(&ctx->stats_plugin.lock);
+}
+
+int
+ipx_ctx_stats_plugin(const ipx_ctx_t *ctx, char *buffer, size_t size)
+{
+    // The lock doesn't change the context from the point of view of the caller
+    pthread_mutex_t *lock = (pthread_mutex_t *) &ctx->stats_plugin.lock;
+    int ret = -1;
+
+    pthread_mutex_lock(lock);
+    if (ctx->stats_plugin.cb != NULL) {
+        ret = ctx->stats_plugin.cb(ctx->stats_plugin.data, buffer, size);
+    }
+    pthread_mutex_unlock(lock);
+    return ret;
+}
+
+const struct ipx_latency_hist *
+ipx_ctx_latency_get(const ipx_ctx_t *ctx)
+{
+    return ctx->latency;
+}
+
+const struct ipx_mem_tag *
+ipx_ctx_mem_get(const ipx_ctx_t *ctx)
+{
+    return ctx->mem;
+}
+
+/** Size of the header of blocks allocated by ipx_ctx_malloc() (keeps the alignment of malloc()) */
+#define CTX_MEM_HDR_SIZE (_Alignof(max_align_t))
+static_assert(CTX_MEM_HDR_SIZE >= sizeof(size_t), "Header must be able to hold the size");
+
+void
+ipx_ctx_mem_add(const ipx_ctx_t *ctx, size_t size)
+{
+    ipx_mem_tag_add(ctx->mem, size);
+}
+
+void
+ipx_ctx_mem_sub(const ipx_ctx_t *ctx, size_t size)
+{
+    ipx_mem_tag_sub(ctx->mem, size);
+}
+
+void *
+ipx_ctx_malloc(const ipx_ctx_t *ctx, size_t size)
+{
+    if (size > SIZE_MAX - CTX_MEM_HDR_SIZE) {
+        return NULL;
+    }
+
+    uint8_t *block = malloc(CTX_MEM_HDR_SIZE + size);
+    if (!block) {
+        return NULL;
+    }
+
+    *(size_t *) block = size;
+    ipx_mem_tag_add(ctx->mem, size);
+    return block + CTX_MEM_HDR_SIZE;
+}
+
+void *
+ipx_ctx_calloc(const ipx_ctx_t *ctx, size_t nmemb, size_t size)
+{
+    if (size != 0 && nmemb > SIZE_MAX / size) {
+        return NULL;
+    }
+
+    void *result = ipx_ctx_malloc(ctx, nmemb * size);
+    if (result != NULL) {
+        memset(result, 0, nmemb * size);
+    }
+    return result;
+}
+
+void *
+ipx_ctx_realloc(const ipx_ctx_t *ctx, void *ptr, size_t size)
+{
+    if (!ptr) {
+        return ipx_ctx_malloc(ctx, size);
+    }
+
+    if (size > SIZE_MAX - CTX_MEM_HDR_SIZE) {
+        return NULL;
+    }
+
+    uint8_t *block = ((uint8_t *) ptr) - CTX_MEM_HDR_SIZE;
+    const size_t size_old = *(size_t *) block;
+    block = realloc(block, CTX_MEM_HDR_SIZE + size);
+    if (!block) {
+        return NULL;
+    }
+
+    *(size_t *) block = size;
+    ipx_mem_tag_sub(ctx->mem, size_old);
+    ipx_mem_tag_add(ctx->mem, size);
+    return block + CTX_MEM_HDR_SIZE;
+}
+
+void
+ipx_ctx_free(const ipx_ctx_t *ctx, void *ptr)
+{
+    if (!ptr) {
+        return;
+    }
+
+    uint8_t *block = ((uint8_t *) ptr) - CTX_MEM_HDR_SIZE;
+    ipx_mem_tag_sub(ctx->mem, *(size_t *) block);
+    free(block);
+}
+
 // -------------------------------------------------------------------------------------------------
 
 /**
@@ -563,10 +1215,10 @@ init_check_intermediate(const ipx_ctx_t *ctx)
         return IPX_ERR_ARG;
     }
 
-    /* Although the output manager is implemented as an intermediate plugin, it doesn't use
-     * a standard output ring buffer.
+    /* Although the output manager and dispatchers are implemented as intermediate plugins,
+     * they don't use a standard output ring buffer.
      */
-    if (ctx->pipeline.dst == NULL && ctx->plugin_cbs->info->type != IPX_PT_OUTPUT_MGR) {
+    if (ctx->pipeline.dst == NULL && !ctx_type_distributor(ctx->plugin_cbs->info->type)) {
         IPX_CTX_ERROR(ctx, "Output ring buffer is not defined!", '\0');
         return IPX_ERR_ARG;
     }
@@ -689,6 +1341,7 @@ ipx_ctx_init(ipx_ctx_t *ctx, const char *params)
         break;
     case IPX_PT_INTERMEDIATE:
     case IPX_PT_OUTPUT_MGR:    // Output manager is implemented as an intermediate plugin
+    case IPX_PT_DISPATCHER:    // Dispatcher is implemented as an intermediate plugin
         rc = init_check_intermediate(ctx);
         break;
     case IPX_PT_OUTPUT:
@@ -717,13 +1370,16 @@ ipx_ctx_init(ipx_ctx_t *ctx, const char *params)
         break;
     case IPX_PT_INTERMEDIATE:
         ctx->cfg_system.msg_mask_selected = IPX_MSG_IPFIX;
+        // Instances holding IPFIX Messages must pass garbage after them
+        ctx->cfg_system.msg_mask_allowed |= IPX_MSG_GARBAGE;
         ctx->permissions = IPX_CP_MSG_PASS | IPX_CP_MSG_SUB;
         break;
     case IPX_PT_OUTPUT_MGR:
+    case IPX_PT_DISPATCHER:
         /* By default, only ::IPX_MSG_IPFIX (IPFIX Message) and ::IPX_MSG_SESSION (Transport
          * Session Message) types can be passed to plugin instance for processing. However,
-         * implementation of the output manager (as an intermediate plugin) requires processing of
-         * almost all types of messages.
+         * implementation of the output manager and dispatchers (as intermediate plugins) requires
+         * processing of almost all types of messages.
          */
         ctx->cfg_system.msg_mask_selected = IPX_MSG_MASK_ALL;
         ctx->cfg_system.msg_mask_allowed = IPX_MSG_MASK_ALL; // overwrite
@@ -763,6 +1419,7 @@ ipx_ctx_init(ipx_ctx_t *ctx, const char *params)
     if (rc != IPX_OK) {
         IPX_CTX_ERROR(ctx, "Initialization function of the instance failed!", '\0');
         // Restore default default parameters
+        ipx_ctx_stats_cb_set(ctx, NULL, NULL);
         ctx->type = 0;
         ctx->permissions = 0;
         ctx->cfg_system.msg_mask_selected = 0;
@@ -820,6 +1477,37 @@ thread_handle_rc(struct ipx_ctx *ctx, int rc)
     }
 }
 
+/**
+ * \brief Get new data by an input instance (i.e. call ipx_plugin_get() of the plugin)
+ * \param[in] ctx Instance context
+ * \return Return code of the plugin function
+ */
+static inline int
+thread_plugin_get(struct ipx_ctx *ctx)
+{
+    IPX_TRACE1(plugin_get_entry, ctx->name);
+    int rc = ctx->plugin_cbs->get(ctx, ctx->cfg_plugin.private);
+    IPX_TRACE2(plugin_get_return, ctx->name, rc);
+    return rc;
+}
+
+/**
+ * \brief Process a message by an instance (i.e. call ipx_plugin_process() of the plugin)
+ * \warning The message must not be accessed after the call (it might be already destroyed)
+ * \param[in] ctx      Instance context
+ * \param[in] msg      Message
+ * \param[in] msg_type Type of the message
+ * \return Return code of the plugin function
+ */
+static inline int
+thread_plugin_process(struct ipx_ctx *ctx, ipx_msg_t *msg, enum ipx_msg_type msg_type)
+{
+    IPX_TRACE3(plugin_process_entry, ctx->name, msg, msg_type);
+    int rc = ctx->plugin_cbs->process(ctx, ctx->cfg_plugin.private, msg);
+    IPX_TRACE3(plugin_process_return, ctx->name, msg, rc);
+    return rc;
+}
+
 /**
  * \brief Try to receive a request from the feedback pipe and process it
  *
@@ -864,19 +1552,29 @@ thread_input_process_pipe(struct ipx_ctx *ctx)
         return IPX_OK;
     }
 
+    if (msg_type == IPX_MSG_TERMINATE && ipx_msg_terminate_get_type(
+            ipx_msg_base2terminate(msg_ptr)) != IPX_MSG_TERMINATE_INSTANCE) {
+        // Not a request to stop the instance (e.g. reconfiguration) -> just pass it
+        ctx_dst_push(ctx, msg_ptr);
+        ctx_dst_flush(ctx);
+        return IPX_OK;
+    }
+
     if (msg_type == IPX_MSG_TERMINATE) {
         // Destroy the instance (usually produce garbage messages, etc)
         const char *plugin_name = ctx->plugin_cbs->info->name;
         IPX_CTX_DEBUG(ctx, "Calling instance destructor of the input plugin '%s'", plugin_name);
+        ipx_ctx_stats_cb_set(ctx, NULL, NULL);
         ctx->plugin_cbs->destroy(ctx, ctx->cfg_plugin.private);
         // Pass the termination message
-        ipx_ring_push(ctx->pipeline.dst, msg_ptr);
+        ctx_dst_push(ctx, msg_ptr);
+        ctx_dst_flush(ctx);
         return IPX_ERR_EOF;
     }
 
     IPX_CTX_ERROR(ctx, "Received unexpected message from the feedback pipe (type %d). "
         "It will be passed on to an IPFIX parser.", msg_type);
-    ipx_ring_push(ctx->pipeline.dst, msg_ptr);
+    ctx_dst_push(ctx, msg_ptr);
     return IPX_OK;
 }
 
@@ -897,6 +1595,19 @@ thread_input(void *arg)
     const char *plugin_name = ctx->plugin_cbs->info->name;
     IPX_CTX_DEBUG(ctx, "Instance thread of the input plugin '%s' has started!", plugin_name);
 
+    if (ctx->cfg_system.msg_pool != IPX_MSG_POOL_DISABLED) {
+        // Size of records is already known (extensions are resolved before start)
+        size_t hdr_size = offsetof(struct ipx_msg_ipfix, recs);
+        ipx_msg_pool_t *pool = ipx_msg_pool_create(hdr_size, ctx->cfg_system.rec_size,
+            ctx->cfg_system.msg_pool, ctx->mem);
+        if (!pool) {
+            IPX_CTX_WARNING(ctx, "Failed to create a pool of IPFIX Messages. Messages will be "
+                "allocated without the pool.", '\0');
+        }
+        ctx_msg_pool_tls.ctx = ctx;
+        ctx_msg_pool_tls.pool = pool;
+    }
+
     bool terminate = false;
     while (!terminate) {
         int rc = thread_input_process_pipe(ctx);
@@ -908,12 +1619,22 @@ thread_input(void *arg)
 
         if (!ipx_ctx_processing_get(ctx)) {
             // Processing is disabled -> wait for message from the feedback pipe
+            ctx_dst_flush(ctx);
             continue;
         }
 
         // Try to get a new IPFIX message
-        rc = ctx->plugin_cbs->get(ctx, ctx->cfg_plugin.private);
+        rc = thread_plugin_get(ctx);
         thread_handle_rc(ctx, rc);
+        // Pass all messages generated by the plugin
+        ctx_dst_flush(ctx);
+    }
+
+    if (ctx_msg_pool_tls.pool != NULL) {
+        // Messages still in the pipeline will return their memory to the pool later
+        ipx_msg_pool_release(ctx_msg_pool_tls.pool);
+        ctx_msg_pool_tls.pool = NULL;
+        ctx_msg_pool_tls.ctx = NULL;
     }
 
     IPX_CTX_DEBUG(ctx, "Instance thread of the input plugin '%s' has been terminated!",
@@ -921,6 +1642,66 @@ thread_input(void *arg)
     pthread_exit(NULL);
 }
 
+/**
+ * \brief Process a message by an intermediate instance
+ *
+ * If data processing is disabled, IPFIX, batch and Transport Session messages are dropped.
+ * \param[in] ctx      Instance context
+ * \param[in] msg      Message
+ * \param[in] msg_type Type of the message
+ * \return True if the message has been consumed (i.e. processed or dropped)
+ * \return False if the message hasn't been processed and should be passed
+ */
+static bool
+thread_intermediate_process(struct ipx_ctx *ctx, ipx_msg_t *msg, enum ipx_msg_type msg_type)
+{
+    if (!ipx_ctx_processing_get(ctx)
+            && (msg_type == IPX_MSG_IPFIX || msg_type == IPX_MSG_SESSION
+                || msg_type == IPX_MSG_BATCH)) {
+        // Data processing is disabled -> drop IPFIX and Session messages
+        if (ctx_msg_merge(ctx, msg)) {
+            ipx_msg_destroy(msg);
+        }
+        return true;
+    }
+
+    bool msg_for_plugin = ctx_msg_subscribed(ctx, msg_type);
+    if (msg_type == IPX_MSG_IPFIX && !ctx_branch_accepted(ctx, ipx_msg_base2ipfix(msg))) {
+        // The message belongs to another branch -> pass it
+        msg_for_plugin = false;
+    }
+
+    if ((ipx_ctx_processing_get(ctx) || ctx_type_distributor(ctx->type)) && msg_for_plugin) {
+        // Pass data to the plugin
+        int rc = thread_plugin_process(ctx, msg, msg_type);
+        thread_handle_rc(ctx, rc);
+        return true;
+    }
+
+    return false;
+}
+
+/**
+ * \brief Process IPFIX Messages of a batch one by one by an intermediate instance
+ *
+ * Messages that are not processed by the plugin are passed. The batch itself is destroyed.
+ * \param[in] ctx   Instance context
+ * \param[in] batch Batch message
+ */
+static void
+thread_intermediate_unpack(struct ipx_ctx *ctx, ipx_msg_batch_t *batch)
+{
+    const uint32_t cnt = ipx_msg_batch_get_cnt(batch);
+    for (uint32_t i = 0; i < cnt; ++i) {
+        ipx_msg_t *msg = ipx_msg_ipfix2base(ipx_msg_batch_get(batch, i));
+        if (!thread_intermediate_process(ctx, msg, IPX_MSG_IPFIX)) {
+            ctx_dst_push(ctx, msg);
+        }
+    }
+
+    ipx_msg_batch_release(batch);
+}
+
 /**
  * \brief Intermediate instance control thread
  *
@@ -933,7 +1714,7 @@ static void *
 thread_intermediate(void *arg)
 {
     struct ipx_ctx *ctx = (struct ipx_ctx *) arg;
-    assert(ctx->type == IPX_PT_INTERMEDIATE || ctx->type == IPX_PT_OUTPUT_MGR);
+    assert(ctx->type == IPX_PT_INTERMEDIATE || ctx_type_distributor(ctx->type));
     thread_set_name(ctx->name);
 
     const char *plugin_name = ctx->plugin_cbs->info->name;
@@ -942,12 +1723,23 @@ thread_intermediate(void *arg)
     ipx_msg_t *msg_ptr;
     enum ipx_msg_type msg_type;
 
+    ipx_msg_t *batch[CTX_BATCH_SIZE];
+    uint32_t batch_cnt = 0;
+    uint32_t batch_idx = 0;
+
     bool terminate = false;
     while (!terminate) {
+        if (batch_idx == batch_cnt) {
+            // All received messages processed -> pass the results and get new messages
+            ctx_dst_flush(ctx);
+            batch_cnt = ipx_ring_pop_bulk(ctx->pipeline.src, batch, CTX_BATCH_SIZE);
+            batch_idx = 0;
+            ctx_stats_add(&ctx->stats.msg_recv, batch_cnt);
+        }
+
         // Get a new message for the buffer
-        msg_ptr = ipx_ring_pop(ctx->pipeline.src);
+        msg_ptr = batch[batch_idx++];
         msg_type = ipx_msg_get_type(msg_ptr);
-        bool processed = false; // only not processed messages are automatically passed
 
         if (msg_type == IPX_MSG_TERMINATE) {
             ipx_msg_terminate_t *terminate_msg = ipx_msg_base2terminate(msg_ptr);
@@ -966,46 +1758,76 @@ thread_intermediate(void *arg)
             }
         }
 
-        if (!ipx_ctx_processing_get(ctx)
-                && (msg_type == IPX_MSG_IPFIX || msg_type == IPX_MSG_SESSION)) {
-            // Data processing is disabled -> drop IPFIX and Session messages
-            ipx_msg_destroy(msg_ptr);
+        if (msg_type == IPX_MSG_BATCH && (!ctx_batch_accepted(ctx)
+                || !ctx_branch_batch_accepted(ctx, ipx_msg_base2batch(msg_ptr)))) {
+            // The plugin doesn't support batches or some messages belong to another branch
+            // -> process IPFIX Messages one by one
+            thread_intermediate_unpack(ctx, ipx_msg_base2batch(msg_ptr));
             continue;
         }
 
-        bool msg_for_plugin = (msg_type & ctx->cfg_system.msg_mask_selected) != 0;
-        if ((ipx_ctx_processing_get(ctx) || ctx->type == IPX_PT_OUTPUT_MGR) && msg_for_plugin) {
-            // Pass data to the plugin
-            int rc = ctx->plugin_cbs->process(ctx, ctx->cfg_plugin.private, msg_ptr);
-            thread_handle_rc(ctx, rc);
-            processed = true;
-        }
-
-        // The message hasn't been processed by the plugin
+        // Only messages not processed by the plugin are automatically passed
+        bool processed = thread_intermediate_process(ctx, msg_ptr, msg_type);
         if (!processed && terminate != true) {
             /* Not processed by the instance, pass the message.
              * Note: Termination message is passed after intermediate instance destructor! */
-            assert(ctx->type != IPX_PT_OUTPUT_MGR);
-            ipx_ring_push(ctx->pipeline.dst, msg_ptr);
+            assert(!ctx_type_distributor(ctx->type));
+            ctx_dst_push(ctx, msg_ptr);
         }
     }
 
+    if (batch_idx != batch_cnt) {
+        IPX_CTX_WARNING(ctx, "%" PRIu32 " message(s) received after the termination message "
+            "will not be processed!", batch_cnt - batch_idx);
+    }
+
     // Destroy the instance (usually produce garbage messages)
     IPX_CTX_DEBUG(ctx, "Calling instance destructor of the intermediate plugin '%s'", plugin_name);
+    ipx_ctx_stats_cb_set(ctx, NULL, NULL);
     ctx->plugin_cbs->destroy(ctx, ctx->cfg_plugin.private);
 
     // Pass the termination message as the last message to the buffer
     assert(msg_type == IPX_MSG_TERMINATE);
-    if (ctx->type != IPX_PT_OUTPUT_MGR) {
-        // All intermediate plugins (except the output manager) have to pass the message here
-        ipx_ring_push(ctx->pipeline.dst, msg_ptr);
+    if (!ctx_type_distributor(ctx->type)) {
+        // All intermediate plugins (except the output manager and dispatchers) have to pass it
+        ctx_dst_push(ctx, msg_ptr);
     }
+    ctx_dst_flush(ctx);
 
     IPX_CTX_DEBUG(ctx, "Instance thread of the intermediate plugin '%s' has been terminated!",
         plugin_name);
     pthread_exit(NULL);
 }
 
+/**
+ * \brief Process IPFIX Messages of a batch one by one by an output instance
+ * \note Messages that don't pass the ODID filter of the instance are skipped.
+ * \note The batch is not destroyed, it's up to the caller.
+ * \param[in] ctx   Instance context
+ * \param[in] batch Batch message
+ */
+static void
+thread_output_unpack(struct ipx_ctx *ctx, ipx_msg_batch_t *batch)
+{
+    if (!ipx_ctx_processing_get(ctx) || !ctx_msg_subscribed(ctx, IPX_MSG_IPFIX)) {
+        return;
+    }
+
+    const uint32_t cnt = ipx_msg_batch_get_cnt(batch);
+    for (uint32_t i = 0; i < cnt; ++i) {
+        ipx_msg_ipfix_t *msg = ipx_msg_batch_get(batch, i);
+        if (!ctx_odid_accepted(ctx, msg)) {
+            continue;
+        }
+
+        int rc = thread_plugin_process(ctx, ipx_msg_ipfix2base(msg), IPX_MSG_IPFIX);
+        thread_handle_rc(ctx, rc);
+        if (ctx->latency != NULL) {
+            ctx_latency_msg(ctx, ipx_msg_ipfix2base(msg), ipx_latency_now());
+        }
+    }
+}
+
 /**
  * \brief Output instance control thread
  *
@@ -1023,17 +1845,39 @@ thread_output(void *arg)
     const char *plugin_name = ctx->plugin_cbs->info->name;
     IPX_CTX_DEBUG(ctx, "Instance thread of the output plugin '%s' has started!", plugin_name);
 
+    ipx_msg_t *batch[CTX_BATCH_SIZE];
+    uint32_t batch_cnt = 0;
+    uint32_t batch_idx = 0;
+
     bool terminate = false;
     while (!terminate) {
+        if (batch_idx == batch_cnt) {
+            // All received messages processed -> get new messages
+            batch_cnt = ipx_ring_pop_bulk(ctx->pipeline.src, batch, CTX_BATCH_SIZE);
+            batch_idx = 0;
+            ctx_stats_add(&ctx->stats.msg_recv, batch_cnt);
+        }
+
         // Get a new message for the buffer
-        ipx_msg_t *msg_ptr = ipx_ring_pop(ctx->pipeline.src);
+        ipx_msg_t *msg_ptr = batch[batch_idx++];
         enum ipx_msg_type msg_type = ipx_msg_get_type(msg_ptr);
-        bool msg_for_plugin = (msg_type & ctx->cfg_system.msg_mask_selected) != 0;
-
-        if (ipx_ctx_processing_get(ctx) && msg_for_plugin) {
+        bool msg_for_plugin = ctx_msg_subscribed(ctx, msg_type);
+
+        if (msg_type == IPX_MSG_BATCH && (!ctx_batch_accepted(ctx)
+                || !ctx_odid_batch_accepted(ctx, ipx_msg_base2batch(msg_ptr)))) {
+            // The plugin doesn't support batches or some messages are filtered out
+            // -> process IPFIX Messages one by one
+            thread_output_unpack(ctx, ipx_msg_base2batch(msg_ptr));
+        } else if (msg_type == IPX_MSG_IPFIX
+                && !ctx_odid_accepted(ctx, ipx_msg_base2ipfix(msg_ptr))) {
+            // Filtered out by the ODID filter -> only release the reference
+        } else if (ipx_ctx_processing_get(ctx) && msg_for_plugin) {
             // Process the message by the plugin
-            int rc = ctx->plugin_cbs->process(ctx, ctx->cfg_plugin.private, msg_ptr);
+            int rc = thread_plugin_process(ctx, msg_ptr, msg_type);
             thread_handle_rc(ctx, rc);
+            if (ctx->latency != NULL) {
+                ctx_latency_msg(ctx, msg_ptr, ipx_latency_now());
+            }
         }
 
         if (msg_type == IPX_MSG_TERMINATE) {
@@ -1052,8 +1896,14 @@ thread_output(void *arg)
         }
     }
 
+    if (batch_idx != batch_cnt) {
+        IPX_CTX_WARNING(ctx, "%" PRIu32 " message(s) received after the termination message "
+            "will not be processed!", batch_cnt - batch_idx);
+    }
+
     // Destroy the instance
     IPX_CTX_DEBUG(ctx, "Calling instance destructor of the output plugin '%s'", plugin_name);
+    ipx_ctx_stats_cb_set(ctx, NULL, NULL);
     ctx->plugin_cbs->destroy(ctx, ctx->cfg_plugin.private);
 
     IPX_CTX_DEBUG(ctx, "Instance thread of the output plugin '%s' has been terminated!",
@@ -1061,6 +1911,149 @@ thread_output(void *arg)
     pthread_exit(NULL);
 }
 
+/**
+ * \brief Read a counter of the instance (callback of ipx_metrics_add_cb())
+ * \param[in] data Pointer to the counter
+ * \return Value
+ */
+static uint64_t
+ctx_metrics_counter(const void *data)
+{
+    return __atomic_load_n((const uint64_t *) data, __ATOMIC_RELAXED);
+}
+
+/**
+ * \brief Read the number of messages in a ring buffer (callback of ipx_metrics_add_cb())
+ * \param[in] data Ring buffer
+ * \return Value
+ */
+static uint64_t
+ctx_metrics_ring_usage(const void *data)
+{
+    struct ipx_ring_stats stats;
+    ipx_ring_stats_get((const ipx_ring_t *) data, &stats);
+    return stats.usage;
+}
+
+/**
+ * \brief Read the capacity of a ring buffer (callback of ipx_metrics_add_cb())
+ * \param[in] data Ring buffer
+ * \return Value
+ */
+static uint64_t
+ctx_metrics_ring_size(const void *data)
+{
+    struct ipx_ring_stats stats;
+    ipx_ring_stats_get((const ipx_ring_t *) data, &stats);
+    return stats.size;
+}
+
+/**
+ * \brief Read the maximum usage of a ring buffer (callback of ipx_metrics_add_cb())
+ * \param[in] data Ring buffer
+ * \return Value
+ */
+static uint64_t
+ctx_metrics_ring_high_water(const void *data)
+{
+    struct ipx_ring_stats stats;
+    ipx_ring_stats_get((const ipx_ring_t *) data, &stats);
+    return stats.high_water;
+}
+
+/**
+ * \brief Read the waiting time of writers of a ring buffer (callback of ipx_metrics_add_cb())
+ * \param[in] data Ring buffer
+ * \return Value
+ */
+static uint64_t
+ctx_metrics_ring_wait_full(const void *data)
+{
+    struct ipx_ring_stats stats;
+    ipx_ring_stats_get((const ipx_ring_t *) data, &stats);
+    return stats.wait_full;
+}
+
+/**
+ * \brief Read the waiting time of the reader of a ring buffer (callback of ipx_metrics_add_cb())
+ * \param[in] data Ring buffer
+ * \return Value
+ */
+static uint64_t
+ctx_metrics_ring_wait_empty(const void *data)
+{
+    struct ipx_ring_stats stats;
+    ipx_ring_stats_get((const ipx_ring_t *) data, &stats);
+    return stats.wait_empty;
+}
+
+/**
+ * \brief Read the number of capacity changes of a ring buffer (callback of ipx_metrics_add_cb())
+ * \param[in] data Ring buffer
+ * \return Value
+ */
+static uint64_t
+ctx_metrics_ring_resizes(const void *data)
+{
+    struct ipx_ring_stats stats;
+    ipx_ring_stats_get((const ipx_ring_t *) data, &stats);
+    return stats.resizes;
+}
+
+/**
+ * \brief Register runtime metrics of the instance provided by the collector
+ *
+ * Counters of received and passed messages and statistics of the input ring buffer. Failures
+ * are not fatal, the metrics are just not available.
+ * \param[in] ctx Instance context
+ */
+static void
+ctx_metrics_register(ipx_ctx_t *ctx)
+{
+    int rc = IPX_OK;
+    if (ctx->pipeline.dst != NULL) {
+        rc |= ipx_metrics_add_cb(ctx, IPX_METRIC_COUNTER, "messages_passed_total",
+            "Number of messages passed to the next instance", &ctx_metrics_counter,
+            &ctx->stats.msg_pass);
+    }
+
+    const ipx_ring_t *ring = ctx->pipeline.src;
+    if (ring != NULL) {
+        rc |= ipx_metrics_add_cb(ctx, IPX_METRIC_COUNTER, "messages_received_total",
+            "Number of messages received from the input ring buffer", &ctx_metrics_counter,
+            &ctx->stats.msg_recv);
+        rc |= ipx_metrics_add_cb(ctx, IPX_METRIC_GAUGE, "ring_usage_messages",
+            "Number of messages in the input ring buffer", &ctx_metrics_ring_usage, ring);
+        rc |= ipx_metrics_add_cb(ctx, IPX_METRIC_GAUGE, "ring_size_messages",
+            "Capacity of the input ring buffer", &ctx_metrics_ring_size, ring);
+        rc |= ipx_metrics_add_cb(ctx, IPX_METRIC_GAUGE, "ring_high_water_messages",
+            "Maximum observed number of messages in the input ring buffer",
+            &ctx_metrics_ring_high_water, ring);
+        rc |= ipx_metrics_add_cb(ctx, IPX_METRIC_COUNTER, "ring_wait_full_nanoseconds_total",
+            "Time spent by writers waiting on the full input ring buffer",
+            &ctx_metrics_ring_wait_full, ring);
+        rc |= ipx_metrics_add_cb(ctx, IPX_METRIC_COUNTER, "ring_wait_empty_nanoseconds_total",
+            "Time spent by the instance waiting on the empty input ring buffer",
+            &ctx_metrics_ring_wait_empty, ring);
+        rc |= ipx_metrics_add_cb(ctx, IPX_METRIC_COUNTER, "ring_resizes_total",
+            "Number of changes of the capacity of the input ring buffer",
+            &ctx_metrics_ring_resizes, ring);
+    }
+
+    if (ctx->mem != NULL) {
+        rc |= ipx_metrics_add_cb(ctx, IPX_METRIC_GAUGE, "memory_bytes",
+            "Number of bytes allocated on behalf of the instance", &ctx_metrics_counter,
+            &ctx->mem->current);
+        rc |= ipx_metrics_add_cb(ctx, IPX_METRIC_GAUGE, "memory_peak_bytes",
+            "Maximum number of bytes allocated on behalf of the instance", &ctx_metrics_counter,
+            &ctx->mem->peak);
+    }
+
+    if (rc != IPX_OK) {
+        IPX_CTX_WARNING(ctx, "Failed to register runtime metrics of the instance.", '\0');
+    }
+}
+
 int
 ipx_ctx_run(ipx_ctx_t *ctx)
 {
@@ -1077,6 +2070,7 @@ ipx_ctx_run(ipx_ctx_t *ctx)
         break;
     case IPX_PT_INTERMEDIATE:
     case IPX_PT_OUTPUT_MGR:  // Output manager is implemented as intermediate plugin
+    case IPX_PT_DISPATCHER:  // Dispatcher is implemented as intermediate plugin
         thread_func = &thread_intermediate;
         break;
     case IPX_PT_OUTPUT:
@@ -1088,6 +2082,34 @@ ipx_ctx_run(ipx_ctx_t *ctx)
         return IPX_ERR_DENIED;
     }
 
+    ctx_metrics_register(ctx);
+
+    // Input instances only create messages and distributors only dispatch them
+    if (ipx_latency_enabled() && ctx->latency == NULL && ctx->type != IPX_PT_INPUT
+            && !ctx_type_distributor(ctx->type)) {
+        ctx->latency = calloc(1, sizeof(*ctx->latency));
+        if (!ctx->latency) {
+            IPX_CTX_WARNING(ctx, "Failed to allocate a latency histogram. Latency of the "
+                "instance will not be measured.", '\0');
+        }
+    }
+
+    // Place the thread on the allowed CPUs before it touches any memory
+    pthread_attr_t attr;
+    int rc = pthread_attr_init(&attr);
+    if (rc == 0 && ctx->cfg_system.affinity) {
+        rc = pthread_attr_setaffinity_np(&attr, sizeof(ctx->cfg_system.cpus),
+            &ctx->cfg_system.cpus);
+    }
+
+    if (rc != 0) {
+        const char *err_str;
+        ipx_strerror(rc, err_str);
+        IPX_CTX_ERROR(ctx, "Failed to configure attributes of an instance thread: %s", err_str);
+        pthread_attr_destroy(&attr);
+        return IPX_ERR_DENIED;
+    }
+
     // Block processing all signals
     sigset_t set_new, set_old;
     sigfillset(&set_new);
@@ -1095,10 +2117,11 @@ ipx_ctx_run(ipx_ctx_t *ctx)
     ctx->state = IPX_CS_RUNNING;
 
     // Start the thread
-    int rc = pthread_create(&ctx->thread_id, NULL, thread_func, ctx);
+    rc = pthread_create(&ctx->thread_id, &attr, thread_func, ctx);
 
     // Restore the previous signal mask
     pthread_sigmask(SIG_SETMASK, &set_old, NULL);
+    pthread_attr_destroy(&attr);
 
     if (rc != 0) {
         const char *err_str;
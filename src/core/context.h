@@ -45,7 +45,11 @@
 #include <ipfixcol2.h>
 #include <libfds.h>
 #include "fpipe.h"
+#include "latency.h"
+#include "memory.h"
 #include "ring.h"
+#include "message_pool.h"
+#include "odid_range.h"
 
 /** List of plugin callbacks  */
 struct ipx_ctx_callbacks {
@@ -69,6 +73,8 @@ struct ipx_ctx_callbacks {
 
 /** Identification number of output manager plugin */
 #define IPX_PT_OUTPUT_MGR 255
+/** Identification number of dispatcher plugin (in front of replicas of an intermediate plugin) */
+#define IPX_PT_DISPATCHER 254
 
 /**
  * \brief Create a context
@@ -264,6 +270,126 @@ ipx_ctx_verb_set(ipx_ctx_t *ctx, enum ipx_verb_level verb);
 IPX_API int
 ipx_ctx_term_cnt_set(ipx_ctx_t *ctx, unsigned int cnt);
 
+/**
+ * \brief Enable/disable merging of broadcast messages (replicas of an intermediate instance)
+ *
+ * Replicas of a sharded intermediate instance receive non-IPFIX messages (Transport Session,
+ * garbage and termination messages) from the dispatcher in all replicas at once. The reference
+ * counter of such messages is set by the dispatcher to the number of replicas. If the merging
+ * is enabled, the context decrements the counter instead of passing the message and only the
+ * last replica passes the message to the successor. Before that, all messages waiting for
+ * the successor are pushed, therefore, the message cannot overtake data of the replica.
+ *
+ * \note
+ *   Messages with zero reference counter (i.e. created by the replica itself) and IPFIX
+ *   Messages are always passed as usual.
+ * \warning
+ *   Replicas MUST pass all broadcast messages (i.e. must not destroy them) otherwise the
+ *   messages are never passed to the successor.
+ * \param[in] ctx Plugin context
+ * \param[in] en  Enable/disable merging
+ */
+IPX_API void
+ipx_ctx_merge_set(ipx_ctx_t *ctx, bool en);
+
+/**
+ * \brief Enable/disable packing of IPFIX Messages into batches (disabled by default)
+ *
+ * If enabled, consecutive IPFIX Messages passed by the instance are packed into batches
+ * (see ::IPX_MSG_BATCH) before they are pushed into the destination ring buffer. Batches are
+ * unpacked by successors that don't support them (see #IPX_PF_BATCH).
+ * \param[in] ctx Plugin context
+ * \param[in] en  Enable/disable packing
+ */
+IPX_API void
+ipx_ctx_batch_set(ipx_ctx_t *ctx, bool en);
+
+/**
+ * \brief Does the instance run in relay mode?
+ *
+ * For output instances, the value represents a declaration of the plugin that it doesn't need
+ * references to Data Records. For parsers, Data Records are only counted if enabled.
+ * \see ipx_ctx_relay_set()
+ * \param[in] ctx Plugin context
+ * \return True or false
+ */
+IPX_API bool
+ipx_ctx_relay_get(const ipx_ctx_t *ctx);
+
+/**
+ * \brief Set operation mode of the pool of IPFIX Messages
+ *
+ * If enabled, the thread of an input instance allocates wrappers of IPFIX Messages
+ * (see ipx_msg_ipfix_create()) from its own pool and the wrappers are returned to the pool
+ * when destroyed (usually by another thread). In the adaptive mode, the initial capacity of
+ * Data Records of new wrappers is derived from the observed number of records per message.
+ *
+ * \note
+ *   By default, the pool is disabled. Affects only input plugins and must be configured before
+ *   the thread is started.
+ * \param[in] ctx  Plugin context
+ * \param[in] mode Operation mode
+ */
+IPX_API void
+ipx_ctx_msg_pool_set(ipx_ctx_t *ctx, enum ipx_msg_pool_mode mode);
+
+/**
+ * \brief Set ODID filter of IPFIX Messages received by the instance (output plugins only)
+ *
+ * IPFIX Messages (also inside batches) that don't pass the filter are not processed by
+ * the plugin. This is useful only if the output manager doesn't filter messages by itself
+ * (see ipx_output_mgr_list_bcast_set()).
+ * \note By default, the filter is disabled. The filter is NOT freed by the context.
+ * \param[in] ctx    Plugin context
+ * \param[in] type   Filter type
+ * \param[in] filter ODID filter (should be NULL, if type == IPX_ODID_FILTER_NONE)
+ */
+IPX_API void
+ipx_ctx_odid_filter_set(ipx_ctx_t *ctx, enum ipx_odid_filter_type type,
+    const ipx_orange_t *filter);
+
+/**
+ * \brief Set the branch of IPFIX Messages processed by the instance
+ *
+ * For intermediate instances, IPFIX Messages (also inside batches) of other branches are passed
+ * to the successor without processing. New IPFIX Messages passed by the plugin (i.e. messages of
+ * the main branch) are moved to the branch of the instance (see ipx_msg_ipfix_branch_get()).
+ * For output instances, IPFIX Messages of other branches are not processed. This is useful only
+ * if the output manager doesn't filter messages by itself (see ipx_output_mgr_list_bcast_set()).
+ * \note By default, messages of all branches are processed.
+ * \param[in] ctx    Plugin context
+ * \param[in] branch Identification of the branch (negative value == all branches)
+ */
+IPX_API void
+ipx_ctx_branch_set(ipx_ctx_t *ctx, int branch);
+
+/**
+ * \brief Set CPU affinity of the thread of the instance
+ *
+ * The thread is started (see ipx_ctx_run()) with the affinity already applied, therefore,
+ * memory first touched by the instance (e.g. its pool of IPFIX Messages) is allocated on the
+ * NUMA node of the selected CPUs.
+ * \note By default, CPU affinity is inherited from the main thread. Empty list (\p cnt == 0)
+ *   restores the default behaviour.
+ * \param[in] ctx  Plugin context
+ * \param[in] cpus Array of CPU indexes
+ * \param[in] cnt  Number of CPUs in the array
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_ARG if any CPU index is out of range
+ * \return #IPX_ERR_DENIED if the thread of the instance is already running
+ */
+IPX_API int
+ipx_ctx_affinity_set(ipx_ctx_t *ctx, const uint16_t *cpus, size_t cnt);
+
+/**
+ * \brief Get the pool of IPFIX Messages of the instance
+ * \note The pool is available only to the thread of the instance.
+ * \param[in] ctx Plugin context
+ * \return Pointer to the pool or NULL (not used or called by another thread)
+ */
+IPX_API ipx_msg_pool_t *
+ipx_ctx_msg_pool_get(const ipx_ctx_t *ctx);
+
 /**
  * \brief Enable/disable data processing
  *
@@ -305,4 +431,61 @@ ipx_ctx_ext_defs(ipx_ctx_t *ctx, struct ipx_ctx_ext **arr, size_t *arr_size);
 IPX_API const struct ipx_plugin_info *
 ipx_ctx_plugininfo_get(const ipx_ctx_t *ctx);
 
+/** Runtime statistics of a plugin context                                                      */
+struct ipx_ctx_stats {
+    /** Number of messages received from the input ring buffer (always 0 for input plugins)   */
+    uint64_t msg_recv;
+    /** Number of messages passed to the output ring buffer (always 0 for output plugins)     */
+    uint64_t msg_pass;
+};
+
+/**
+ * \brief Get runtime statistics of the plugin context
+ *
+ * \note The function can be called by any thread at any time (counters are updated atomically).
+ * \param[in]  ctx   Plugin context
+ * \param[out] stats Statistics
+ */
+IPX_API void
+ipx_ctx_stats_get(const ipx_ctx_t *ctx, struct ipx_ctx_stats *stats);
+
+/**
+ * \brief Get runtime statistics provided by the plugin
+ *
+ * Statistics are formatted by the callback of the plugin (see ipx_ctx_stats_cb_set()).
+ * \note The function can be called by any thread at any time.
+ * \param[in]  ctx    Plugin context
+ * \param[out] buffer Output buffer
+ * \param[in]  size   Size of the output buffer
+ * \return Same as snprintf() (i.e. the length of the whole output)
+ * \return Negative value if the plugin doesn't provide any statistics
+ */
+IPX_API int
+ipx_ctx_stats_plugin(const ipx_ctx_t *ctx, char *buffer, size_t size);
+
+/**
+ * \brief Get a histogram of latency of IPFIX Messages processed by the instance
+ *
+ * The histogram contains time elapsed since reception of each message by an input instance
+ * until the instance finished its processing. It's available only if measurement of latency
+ * is enabled (see ipx_latency_enable()) and the instance is running. Input instances and
+ * internal distributors (the output manager, dispatchers) don't have any histogram.
+ * \note The histogram can be read by any thread at any time (see ipx_latency_snapshot()).
+ * \param[in] ctx Plugin context
+ * \return Pointer to the histogram or NULL
+ */
+IPX_API const struct ipx_latency_hist *
+ipx_ctx_latency_get(const ipx_ctx_t *ctx);
+
+/**
+ * \brief Get the memory accounting tag of the instance
+ *
+ * It's available only if memory accounting is enabled (see ipx_mem_enable()).
+ * \note The tag can be read by any thread at any time (counters are updated atomically).
+ * \param[in] ctx Plugin context
+ * \return Pointer to the tag or NULL
+ */
+IPX_API const struct ipx_mem_tag *
+ipx_ctx_mem_get(const ipx_ctx_t *ctx);
+
 #endif // IPFIXCOL_CONTEXT_INTERNAL_H
@@ -40,13 +40,19 @@
  */
 
 #include "extension.h"
+#include "message_ipfix.h"
 #include <ipfixcol2/plugins.h>
+#include <assert.h>
 #include <stdlib.h>
 #include <string.h>
 
 int
 ipx_ctx_ext_get(ipx_ctx_ext_t *ext, struct ipx_ipfix_record *drec, void **data, size_t *size)
 {
+    if (ext->columnar) {
+        // The extension is not stored in the Data Record
+        return IPX_ERR_ARG;
+    }
     if (ext->etype == IPX_EXTENSION_CONSUMER && (drec->ext_mask & ext->mask) == 0) {
         // The extension hasn't been filled by the producer
         return IPX_ERR_NOTFOUND;
@@ -67,9 +73,59 @@ ipx_ctx_ext_set_filled(ipx_ctx_ext_t *ext, struct ipx_ipfix_record *drec)
     drec->ext_mask |= ext->mask;
 }
 
+int
+ipx_ctx_ext_column_get(ipx_ctx_ext_t *ext, ipx_msg_ipfix_t *msg, void **data, size_t *size)
+{
+    if (!ext->columnar) {
+        return IPX_ERR_ARG;
+    }
+
+    const size_t idx = ext->column;
+    assert(idx < IPX_MSG_IPFIX_COLS_MAX);
+
+    if (ext->etype == IPX_EXTENSION_CONSUMER) {
+        if ((msg->ext_cols.filled & (1U << idx)) == 0) {
+            // The extension hasn't been filled by the producer
+            return IPX_ERR_NOTFOUND;
+        }
+    } else if (msg->ext_cols.data[idx] == NULL) {
+        // Allocate the column for all Data Records of the message
+        const uint32_t rows = msg->rec_info.cnt_valid;
+        uint8_t *column = malloc(((rows > 0) ? rows : 1U) * ext->size);
+        if (!column) {
+            return IPX_ERR_NOMEM;
+        }
+
+        msg->ext_cols.data[idx] = column;
+        msg->ext_cols.rows[idx] = rows;
+        msg->ext_cols.sizes[idx] = (uint32_t) ext->size;
+    }
+
+    *data = msg->ext_cols.data[idx];
+    *size = ext->size;
+    return IPX_OK;
+}
+
+void
+ipx_ctx_ext_column_set_filled(ipx_ctx_ext_t *ext, ipx_msg_ipfix_t *msg)
+{
+    if (ext->etype != IPX_EXTENSION_PRODUCER || !ext->columnar) {
+        return; // Not allowed!
+    }
+
+    const size_t idx = ext->column;
+    assert(idx < IPX_MSG_IPFIX_COLS_MAX);
+    if (msg->ext_cols.data[idx] == NULL) {
+        return; // The column hasn't been allocated by ipx_ctx_ext_column_get()
+    }
+
+    assert(msg->ext_cols.rows[idx] == msg->rec_info.cnt_valid && "Records have been added");
+    msg->ext_cols.filled |= (1U << idx);
+}
+
 int
 ipx_ctx_ext_init(struct ipx_ctx_ext *ext, enum ipx_extension etype, const char *data_type,
-    const char *data_name, size_t size)
+    const char *data_name, size_t size, bool columnar)
 {
     // Check parameters
     if (!data_name || !data_type || strlen(data_type) == 0 || strlen(data_name) == 0) {
@@ -84,6 +140,7 @@ ipx_ctx_ext_init(struct ipx_ctx_ext *ext, enum ipx_extension etype, const char *
 
     ext->etype = etype;
     ext->size = (etype == IPX_EXTENSION_PRODUCER) ? size : 0;
+    ext->columnar = (etype == IPX_EXTENSION_PRODUCER) ? columnar : false;
     ext->data_type = strdup(data_type);
     ext->data_name = strdup(data_name);
     if (!ext->data_type || !ext->data_name) {
@@ -94,6 +151,7 @@ ipx_ctx_ext_init(struct ipx_ctx_ext *ext, enum ipx_extension etype, const char *
 
     ext->offset = 0;
     ext->mask = 0;
+    ext->column = 0;
     return IPX_OK;
 }
 
@@ -42,6 +42,7 @@
 #ifndef IPX_CTX_EXTENSION_H
 #define IPX_CTX_EXTENSION_H
 
+#include <stdbool.h>
 #include <stddef.h>
 #include <ipfixcol2/plugins.h>
 
@@ -61,12 +62,16 @@ struct ipx_ctx_ext {
     char *data_name;
     /// Size of the extension
     size_t size;
+    /// Extension is stored in a column per IPFIX Message instead of inside each Data Record
+    bool columnar;
 
     // -- Following fields are later filled by the configurator --
-    /// Offset of the extension data (\ref ipx_ipfix_record.ext)
+    /// Offset of the extension data (\ref ipx_ipfix_record.ext, only for non-columnar)
     size_t offset;
-    /// Extension bitset mask (signalizes if the value is set)
+    /// Extension bitset mask (signalizes if the value is set, only for non-columnar)
     uint64_t mask;
+    /// Index of the column in IPFIX Messages (only for columnar)
+    size_t column;
 };
 
 /**
@@ -78,13 +83,14 @@ struct ipx_ctx_ext {
  * @param[in] data_type Extension data type
  * @param[in] data_name Extension name
  * @param[in] size      Producer: Size of the extension in bytes / Consumer: ignored
+ * @param[in] columnar  Producer: Columnar storage of the extension / Consumer: ignored
  * @return #IPX_OK on success
  * @return #IPX_ERR_NOMEM if a memory allocation failure has occurred
  * @return #IPX_ERR_ARG if parameters are not valid
  */
 int
 ipx_ctx_ext_init(struct ipx_ctx_ext *ext, enum ipx_extension etype, const char *data_type,
-    const char *data_name, size_t size);
+    const char *data_name, size_t size, bool columnar);
 
 /**
  * @brief Destroy internal extension record
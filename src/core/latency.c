@@ -0,0 +1,153 @@
+/**
+ * \file src/core/latency.c
+ * \author agent <agent@local>
+ * \brief Latency histograms of IPFIX Messages (source file)
+ * \date 2026
+ */
+
+/* Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is'', and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#include <time.h>
+#include "latency.h"
+
+/** Measurement enabled (read-only after startup)                                                */
+static bool latency_en = false;
+
+void
+ipx_latency_enable(bool en)
+{
+    latency_en = en;
+}
+
+bool
+ipx_latency_enabled()
+{
+    return latency_en;
+}
+
+uint64_t
+ipx_latency_now()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t) ts.tv_sec * 1000000000ULL + (uint64_t) ts.tv_nsec;
+}
+
+uint64_t
+ipx_latency_from_realtime(const struct timespec *ts)
+{
+    struct timespec real;
+    clock_gettime(CLOCK_REALTIME, &real);
+    const uint64_t now = ipx_latency_now();
+
+    const int64_t age = (int64_t) (real.tv_sec - ts->tv_sec) * 1000000000LL
+        + (int64_t) (real.tv_nsec - ts->tv_nsec);
+    if (age <= 0 || (uint64_t) age >= now) {
+        // In the future (e.g. the clock has been adjusted) or older than the monotonic clock
+        return now;
+    }
+
+    return now - (uint64_t) age;
+}
+
+/**
+ * \brief Get the highest value of a bucket
+ * \param[in] idx Index of the bucket
+ * \return Value
+ */
+static uint64_t
+latency_bucket_max(unsigned int idx)
+{
+    if (idx < IPX_LATENCY_SUB_CNT) {
+        return idx;
+    }
+
+    const unsigned int shift = (idx >> IPX_LATENCY_SUB_BITS) - 1U;
+    const uint64_t sub = (idx & (IPX_LATENCY_SUB_CNT - 1U)) | IPX_LATENCY_SUB_CNT;
+    const uint64_t low = sub << shift;
+    return low + ((1ULL << shift) - 1U);
+}
+
+void
+ipx_latency_snapshot(const struct ipx_latency_hist *hist, struct ipx_latency_hist *out)
+{
+    out->cnt = 0;
+    for (unsigned int i = 0; i < IPX_LATENCY_BUCKETS; ++i) {
+        out->buckets[i] = __atomic_load_n(&hist->buckets[i], __ATOMIC_RELAXED);
+        // The total is computed from buckets, so it's always consistent with them
+        out->cnt += out->buckets[i];
+    }
+}
+
+void
+ipx_latency_sub(struct ipx_latency_hist *hist, const struct ipx_latency_hist *prev)
+{
+    hist->cnt -= prev->cnt;
+    for (unsigned int i = 0; i < IPX_LATENCY_BUCKETS; ++i) {
+        hist->buckets[i] -= prev->buckets[i];
+    }
+}
+
+uint64_t
+ipx_latency_percentile(const struct ipx_latency_hist *hist, double pct)
+{
+    if (hist->cnt == 0) {
+        return 0;
+    }
+
+    if (pct < 0.0) {
+        pct = 0.0;
+    } else if (pct > 100.0) {
+        pct = 100.0;
+    }
+
+    // Rank of the value (at least the first one)
+    uint64_t rank = (uint64_t) ((pct / 100.0) * (double) hist->cnt + 0.5);
+    if (rank == 0) {
+        rank = 1;
+    } else if (rank > hist->cnt) {
+        rank = hist->cnt;
+    }
+
+    uint64_t sum = 0;
+    for (unsigned int i = 0; i < IPX_LATENCY_BUCKETS; ++i) {
+        sum += hist->buckets[i];
+        if (sum >= rank) {
+            return latency_bucket_max(i);
+        }
+    }
+
+    return latency_bucket_max(IPX_LATENCY_BUCKETS - 1);
+}
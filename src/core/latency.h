@@ -0,0 +1,191 @@
+/**
+ * \file src/core/latency.h
+ * \author agent <agent@local>
+ * \brief Latency histograms of IPFIX Messages (header file)
+ * \date 2026
+ */
+
+/* Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is'', and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#ifndef IPX_LATENCY_H
+#define IPX_LATENCY_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <ipfixcol2.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <time.h>
+
+/**
+ * \defgroup ipx_latency Latency histograms
+ *
+ * \brief Measurement of time spent by IPFIX Messages in the pipeline
+ *
+ * If enabled, each IPFIX Message gets a monotonic timestamp when it's created by an input
+ * instance (see ipx_msg_ctx::ingress_ts). Each instance records the time elapsed since the
+ * ingress when it has finished processing of the message (i.e. when the message is passed to
+ * the next instance or released by an output instance). Input plugins can replace the timestamp
+ * with the time of reception of the message by the kernel (see ipx_latency_from_realtime()).
+ *
+ * Values are stored in log-linear histograms (similar to HdrHistogram), i.e. each power of two
+ * is split into #IPX_LATENCY_SUB_CNT linear buckets. The relative error of a value is lower than
+ * 1 / #IPX_LATENCY_SUB_CNT.
+ *
+ * @{
+ */
+
+/** Number of bits of linear sub-buckets of each power of two                                    */
+#define IPX_LATENCY_SUB_BITS (4U)
+/** Number of linear sub-buckets of each power of two                                            */
+#define IPX_LATENCY_SUB_CNT  (1U << IPX_LATENCY_SUB_BITS)
+/** Total number of buckets (covers all 64-bit values)                                           */
+#define IPX_LATENCY_BUCKETS  ((64U - IPX_LATENCY_SUB_BITS + 1U) * IPX_LATENCY_SUB_CNT)
+
+/**
+ * \brief Latency histogram (values in nanoseconds)
+ * \warning The histogram can be updated only by a single thread, but it can be read by any
+ *   thread at any time (counters are updated atomically).
+ */
+struct ipx_latency_hist {
+    /** Number of recorded values                                                                */
+    uint64_t cnt;
+    /** Counters of buckets                                                                      */
+    uint64_t buckets[IPX_LATENCY_BUCKETS];
+};
+
+/**
+ * \brief Enable/disable measurement of latency
+ * \warning The function must be called before any plugin context is created.
+ * \param[in] en Enable/disable
+ */
+IPX_API void
+ipx_latency_enable(bool en);
+
+/**
+ * \brief Is measurement of latency enabled?
+ * \return True or false
+ */
+IPX_API bool
+ipx_latency_enabled();
+
+/**
+ * \brief Get the current monotonic timestamp
+ * \return Timestamp in nanoseconds
+ */
+IPX_API uint64_t
+ipx_latency_now();
+
+/**
+ * \brief Convert a realtime timestamp to the monotonic timestamp
+ *
+ * Kernel receive timestamps (e.g. SO_TIMESTAMPNS) are based on the realtime clock, so they're
+ * shifted by the current difference between the clocks. Timestamps in the future are replaced
+ * by the current time.
+ * \param[in] ts Realtime timestamp
+ * \return Monotonic timestamp in nanoseconds (see ipx_latency_now())
+ */
+IPX_API uint64_t
+ipx_latency_from_realtime(const struct timespec *ts);
+
+/**
+ * \brief Get an index of the bucket of a value
+ * \param[in] value Value
+ * \return Index
+ */
+static inline unsigned int
+ipx_latency_bucket(uint64_t value)
+{
+    if (value < IPX_LATENCY_SUB_CNT) {
+        return (unsigned int) value;
+    }
+
+    const unsigned int msb = 63U - (unsigned int) __builtin_clzll(value);
+    const unsigned int shift = msb - IPX_LATENCY_SUB_BITS;
+    const unsigned int sub = (unsigned int) (value >> shift) & (IPX_LATENCY_SUB_CNT - 1U);
+    return ((shift + 1U) << IPX_LATENCY_SUB_BITS) | sub;
+}
+
+/**
+ * \brief Record a value
+ * \param[in] hist  Histogram
+ * \param[in] value Value (in nanoseconds)
+ */
+static inline void
+ipx_latency_record(struct ipx_latency_hist *hist, uint64_t value)
+{
+    // Single writer (the instance thread) -> no read-modify-write operations required
+    uint64_t *bucket = &hist->buckets[ipx_latency_bucket(value)];
+    __atomic_store_n(bucket, __atomic_load_n(bucket, __ATOMIC_RELAXED) + 1, __ATOMIC_RELAXED);
+    __atomic_store_n(&hist->cnt, __atomic_load_n(&hist->cnt, __ATOMIC_RELAXED) + 1,
+        __ATOMIC_RELAXED);
+}
+
+/**
+ * \brief Get a copy of a histogram
+ * \note The function can be called by any thread.
+ * \param[in]  hist Histogram
+ * \param[out] out  Copy
+ */
+IPX_API void
+ipx_latency_snapshot(const struct ipx_latency_hist *hist, struct ipx_latency_hist *out);
+
+/**
+ * \brief Subtract a previous snapshot from a histogram (i.e. values recorded in the meantime)
+ * \param[in,out] hist Histogram
+ * \param[in]     prev Previous snapshot of the same histogram
+ */
+IPX_API void
+ipx_latency_sub(struct ipx_latency_hist *hist, const struct ipx_latency_hist *prev);
+
+/**
+ * \brief Get a value at a percentile
+ *
+ * The value is the highest value of the bucket that contains the percentile.
+ * \param[in] hist Histogram
+ * \param[in] pct  Percentile (0 - 100)
+ * \return Value (0, if the histogram is empty)
+ */
+IPX_API uint64_t
+ipx_latency_percentile(const struct ipx_latency_hist *hist, double pct);
+
+/**@}*/
+
+#ifdef __cplusplus
+}
+#endif
+#endif // IPX_LATENCY_H
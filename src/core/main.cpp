@@ -54,6 +54,7 @@
 #include "configurator/controller_file.hpp"
 
 extern "C" {
+#include "metrics.h"
 #include "verbose.h"
 #include <build_config.h>
 }
@@ -84,16 +85,33 @@ print_help()
 {
     std::cout
         << "IPFIX Collector daemon\n"
-        << "Usage: ipfixcol2 [-c FILE] [-p PATH] [-e DIR] [-P FILE] [-r SIZE] [-vVhLdu]\n"
+        << "Usage: ipfixcol2 [-c FILE] [-p PATH] [-C FILE] [-e DIR] [-P FILE] [-r SIZE[:MAX]]\n"
+        << "                 [-s SEC] [-m ADDR] [-vVhLdablu]\n"
         << "  -c FILE   Path to the startup configuration file\n"
         << "            (default: " << IPX_DEFAULT_STARTUP_CONFIG << ")\n"
         << "  -p PATH   Add path to a directory with plugins or to a file\n"
         << "            (default: " << IPX_DEFAULT_PLUGINS_DIR << ")\n"
+        << "  -C FILE   Path to a plugin index file (metadata of plugins found in previous runs,\n"
+        << "            unchanged plugins are not opened, default: disabled)\n"
         << "  -e DIR    Path to a directory with definitions of IPFIX Information Elements\n"
         << "            (default: " << fds_api_cfg_dir() << ")\n"
         << "  -P FILE   Path to a PID file (without this option, no PID file is created)\n"
         << "  -d        Run as a standalone daemon process\n"
-        << "  -r SIZE   Ring buffer size (default: " << ipx_configurator::RING_DEF_SIZE << ")\n"
+        << "  -a        Write messages asynchronously by a background thread\n"
+        << "  -r SIZE[:MAX]\n"
+        << "            Ring buffer size (default: " << ipx_configurator::RING_DEF_SIZE << ")\n"
+        << "            With MAX, input buffers of intermediate and output instances grow up\n"
+        << "            to MAX messages under load and shrink back to SIZE when idle\n"
+        << "  -s SEC    Print runtime statistics of all instances every SEC seconds\n"
+        << "            (printed as informational messages, default: disabled)\n"
+        << "  -m ADDR   Serve runtime metrics of all instances over HTTP, ADDR is [HOST:]PORT\n"
+        << "            (Prometheus text format at /metrics, default: disabled)\n"
+        << "  -b        Pass messages to all output instances using a single shared ring buffer\n"
+        << "            (always used if there are more than 64 output instances)\n"
+        << "  -l        Measure latency of IPFIX Messages in each instance\n"
+        << "            (printed with runtime statistics, also on SIGUSR1)\n"
+        << "  -M        Account memory allocated on behalf of each instance\n"
+        << "            (current and peak bytes printed with runtime statistics and metrics)\n"
         << "  -h        Show this help message and exit\n"
         << "  -V        Show version information and exit\n"
         << "  -L        List all available plugins and exit\n"
@@ -163,7 +181,7 @@ pid_remove(const char *file)
 /**
  * \brief Change size of ring buffers
  * \param[in] conf     IPFIXcol configurator
- * \param[in] new_size New size (from command line)
+ * \param[in] new_size New size (from command line, SIZE or SIZE:MAX)
  * \return #IPX_OK on success
  * \return #IPX_ERR_FORMAT if the \p new_size is not valid size
  */
@@ -173,6 +191,15 @@ ring_size_change(ipx_configurator &conf, const char *new_size)
     char *end_ptr = nullptr;
     errno = 0;
     unsigned int size = std::strtoul(new_size, &end_ptr, 10);
+    unsigned int max = 0;
+    if (errno == 0 && end_ptr != nullptr && (*end_ptr) == ':') {
+        // Maximal size of adaptive ring buffers
+        const char *max_str = end_ptr + 1;
+        max = std::strtoul(max_str, &end_ptr, 10);
+        if (end_ptr == max_str) {
+            errno = EINVAL;
+        }
+    }
     if (errno != 0 || (end_ptr != nullptr && (*end_ptr) != '\0')) {
         IPX_ERROR(module, "Size '%s' of the ring buffers is not a valid number!", new_size);
         return IPX_ERR_FORMAT;
@@ -185,8 +212,40 @@ ring_size_change(ipx_configurator &conf, const char *new_size)
         return IPX_ERR_FORMAT;
     }
 
-    conf.set_buffer_size(size);
-    IPX_INFO(module, "Ring buffer size set to %u messages", size);
+    if (max != 0 && max < size) {
+        IPX_ERROR(module, "Maximal size of the ring buffers must be at least %u messages.", size);
+        return IPX_ERR_FORMAT;
+    }
+
+    conf.set_buffer_size(size, max);
+    if (max > size) {
+        IPX_INFO(module, "Ring buffer size set to %u messages (adaptive up to %u messages)",
+            size, max);
+    } else {
+        IPX_INFO(module, "Ring buffer size set to %u messages", size);
+    }
+    return IPX_OK;
+}
+
+/**
+ * \brief Change interval of printing runtime statistics
+ * \param[in] conf     IPFIXcol configurator
+ * \param[in] interval New interval in seconds (from command line)
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_FORMAT if the \p interval is not valid number
+ */
+static int
+stats_interval_change(ipx_configurator &conf, const char *interval)
+{
+    char *end_ptr = nullptr;
+    errno = 0;
+    unsigned long sec = std::strtoul(interval, &end_ptr, 10);
+    if (errno != 0 || (end_ptr != nullptr && (*end_ptr) != '\0') || sec > UINT32_MAX) {
+        IPX_ERROR(module, "Interval '%s' of statistics is not a valid number!", interval);
+        return IPX_ERR_FORMAT;
+    }
+
+    conf.set_stats_interval(static_cast<uint32_t>(sec));
     return IPX_OK;
 }
 
@@ -202,14 +261,17 @@ int main(int argc, char *argv[])
     const char *cfg_iedir = nullptr;
     const char *pid_file = nullptr;
     const char *ring_size = nullptr;
+    const char *stats_interval = nullptr;
+    const char *metrics_addr = nullptr;
     bool daemon_en = false;
+    bool async_log = false;
     bool list_only = false;
     ipx_configurator configurator;
 
     // Parse configuration
     int opt;
     opterr = 0; // Disable default error messages
-    while ((opt = getopt(argc, argv, "c:vVhLdp:e:P:r:u")) != -1) {
+    while ((opt = getopt(argc, argv, "c:vVhLdap:C:e:P:r:s:m:blMu")) != -1) {
         switch (opt) {
         case 'c': // Configuration file
             cfg_startup = optarg;
@@ -229,9 +291,15 @@ int main(int argc, char *argv[])
         case 'd': // Run as a standalone process (daemon)
             daemon_en = true;
             break;
+        case 'a': // Asynchronous logging
+            async_log = true;
+            break;
         case 'p': // Plugin search path
             configurator.plugins.path_add(std::string(optarg));
             break;
+        case 'C': // Plugin index file
+            configurator.plugins.index_set(std::string(optarg));
+            break;
         case 'e': // Redefine path to Information Elements definition
             cfg_iedir = optarg;
             break;
@@ -241,6 +309,21 @@ int main(int argc, char *argv[])
         case 'r': // Change ring size
             ring_size = optarg;
             break;
+        case 's': // Print statistics
+            stats_interval = optarg;
+            break;
+        case 'm': // Metrics exporter
+            metrics_addr = optarg;
+            break;
+        case 'b': // Broadcast ring buffer of output instances
+            configurator.set_output_broadcast(true);
+            break;
+        case 'l': // Latency of IPFIX Messages
+            configurator.set_latency(true);
+            break;
+        case 'M': // Memory accounting
+            configurator.set_memory(true);
+            break;
         case 'u': // Disable automatic plugin unload
             configurator.plugins.auto_unload(false);
             break;
@@ -280,11 +363,31 @@ int main(int argc, char *argv[])
         }
     }
 
+    // The writer thread must be started after the process is daemonized
+    if (async_log) {
+        if (ipx_verb_async(true) != IPX_OK) {
+            IPX_WARNING(module, "Failed to start the logging thread. Messages will be written "
+                "synchronously.", '\0');
+        } else {
+            // Write remaining messages on exit (i.e. after all instances are terminated)
+            atexit([]() {ipx_verb_async(false);});
+        }
+    }
+
     if (ring_size != nullptr && ring_size_change(configurator, ring_size) != IPX_OK) {
         // Failed to set the size
         return EXIT_FAILURE;
     }
 
+    if (stats_interval != nullptr && stats_interval_change(configurator, stats_interval) != IPX_OK) {
+        return EXIT_FAILURE;
+    }
+
+    // The exporter thread must be started after the process is daemonized
+    if (metrics_addr != nullptr && ipx_metrics_server_start(metrics_addr) != IPX_OK) {
+        return EXIT_FAILURE;
+    }
+
     // Create a PID file
     if (pid_file != nullptr && pid_create(pid_file) != IPX_OK) {
         pid_file = nullptr; // Prevent removing the file
@@ -303,6 +406,8 @@ int main(int argc, char *argv[])
         return EXIT_FAILURE;
     }
 
+    ipx_metrics_server_stop();
+
     // Destroy a PID file
     if (pid_file != nullptr) {
         pid_remove(pid_file);
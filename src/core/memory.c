@@ -0,0 +1,87 @@
+/**
+ * \file src/core/memory.c
+ * \author agent <agent@local>
+ * \brief Memory accounting of instances (source file)
+ * \date 2026
+ */
+
+
+/* Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is'', and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#include <stdlib.h>
+#include "memory.h"
+
+/** Accounting enabled (read-only after startup)                                                 */
+static bool mem_en = false;
+
+void
+ipx_mem_enable(bool en)
+{
+    mem_en = en;
+}
+
+bool
+ipx_mem_enabled()
+{
+    return mem_en;
+}
+
+struct ipx_mem_tag *
+ipx_mem_tag_create()
+{
+    struct ipx_mem_tag *tag = calloc(1, sizeof(*tag));
+    if (!tag) {
+        return NULL;
+    }
+
+    tag->refs = 1;
+    return tag;
+}
+
+void
+ipx_mem_tag_ref(struct ipx_mem_tag *tag)
+{
+    __atomic_add_fetch(&tag->refs, 1U, __ATOMIC_RELAXED);
+}
+
+void
+ipx_mem_tag_unref(struct ipx_mem_tag *tag)
+{
+    if (!tag || __atomic_sub_fetch(&tag->refs, 1U, __ATOMIC_ACQ_REL) != 0) {
+        return;
+    }
+
+    free(tag);
+}
@@ -0,0 +1,163 @@
+/**
+ * \file src/core/memory.h
+ * \author agent <agent@local>
+ * \brief Memory accounting of instances (header file)
+ * \date 2026
+ */
+
+
+/* Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is'', and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#ifndef IPX_MEMORY_H
+#define IPX_MEMORY_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <ipfixcol2.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/**
+ * \defgroup ipx_memory Memory accounting
+ *
+ * \brief Current and peak number of bytes allocated on behalf of instances
+ *
+ * If enabled, each plugin context has a tag which accumulates sizes of memory allocated by
+ * helpers of the collector (see ipx_ctx_malloc()) or reported by the plugin itself (see
+ * ipx_ctx_mem_add()). Memory blocks of the pool of IPFIX Messages of an input instance are
+ * accounted to the instance, i.e. its current value also reflects messages waiting in ring
+ * buffers of other instances.
+ *
+ * Memory allocated by external libraries (e.g. templates managed by libfds) is not accounted
+ * unless the plugin reports it. Therefore, the values are lower bounds of the real usage.
+ *
+ * @{
+ */
+
+/**
+ * \brief Memory accounting tag
+ * \note Counters can be updated and read by any thread (all operations are atomic).
+ */
+struct ipx_mem_tag {
+    /** Number of currently allocated bytes                                                      */
+    uint64_t current;
+    /** Maximum observed number of allocated bytes                                              */
+    uint64_t peak;
+    /** Number of references (the context + pools of messages, etc.)                            */
+    uint32_t refs;
+};
+
+/**
+ * \brief Enable/disable memory accounting
+ * \warning The function must be called before any plugin context is created.
+ * \param[in] en Enable/disable
+ */
+IPX_API void
+ipx_mem_enable(bool en);
+
+/**
+ * \brief Is memory accounting enabled?
+ * \return True or false
+ */
+IPX_API bool
+ipx_mem_enabled();
+
+/**
+ * \brief Create a new tag (with a single reference)
+ * \return Pointer or NULL (memory allocation error)
+ */
+struct ipx_mem_tag *
+ipx_mem_tag_create();
+
+/**
+ * \brief Add a reference to a tag
+ * \param[in] tag Tag
+ */
+void
+ipx_mem_tag_ref(struct ipx_mem_tag *tag);
+
+/**
+ * \brief Remove a reference to a tag and destroy the tag if it was the last one
+ * \param[in] tag Tag (can be NULL)
+ */
+void
+ipx_mem_tag_unref(struct ipx_mem_tag *tag);
+
+/**
+ * \brief Account allocated memory
+ * \param[in] tag  Tag (can be NULL, i.e. accounting is disabled)
+ * \param[in] size Number of bytes
+ */
+static inline void
+ipx_mem_tag_add(struct ipx_mem_tag *tag, size_t size)
+{
+    if (!tag) {
+        return;
+    }
+
+    uint64_t now = __atomic_add_fetch(&tag->current, size, __ATOMIC_RELAXED);
+    uint64_t peak = __atomic_load_n(&tag->peak, __ATOMIC_RELAXED);
+    while (now > peak && !__atomic_compare_exchange_n(&tag->peak, &peak, now, true,
+            __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+        // peak has been updated, try again
+    }
+}
+
+/**
+ * \brief Account freed memory
+ * \param[in] tag  Tag (can be NULL, i.e. accounting is disabled)
+ * \param[in] size Number of bytes
+ */
+static inline void
+ipx_mem_tag_sub(struct ipx_mem_tag *tag, size_t size)
+{
+    if (!tag) {
+        return;
+    }
+
+    __atomic_sub_fetch(&tag->current, size, __ATOMIC_RELAXED);
+}
+
+/**
+ * @}
+ */
+
+#ifdef __cplusplus
+}
+#endif
+#endif // IPX_MEMORY_H
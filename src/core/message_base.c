@@ -41,6 +41,7 @@
 
 #include <ipfixcol2.h>
 #include "message_base.h"
+#include "message_batch.h"
 #include "message_terminate.h"
 
 // Get the type of a message for the collector pipeline
@@ -67,5 +68,8 @@ ipx_msg_destroy(ipx_msg_t *msg)
     case IPX_MSG_TERMINATE:
         ipx_msg_terminate_destroy(ipx_msg_base2terminate(msg));
         break;
+    case IPX_MSG_BATCH:
+        ipx_msg_batch_destroy(ipx_msg_base2batch(msg));
+        break;
     }
 }
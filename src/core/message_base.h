@@ -66,7 +66,8 @@
 struct ipx_msg {
     /** Type of the message                                                           */
     enum ipx_msg_type type;
-    /** Reference counter (set by the output manager, decremented by output plugins)  */
+    /** Reference counter (set by the output manager or a dispatcher, decremented by
+     *  output plugins or replicas of an intermediate plugin)                         */
     unsigned int ref_cnt;
 }; // TODO: 64 bytes alignment
 
@@ -83,6 +84,7 @@ static inline void
 ipx_msg_header_init(struct ipx_msg *header, enum ipx_msg_type type)
 {
     header->type = type;
+    header->ref_cnt = 0;
 }
 
 /**
@@ -98,7 +100,7 @@ ipx_msg_header_destroy(struct ipx_msg *header)
 }
 
 /**
- * \brief Set the reference counter (only for the output manager)
+ * \brief Set the reference counter (only for the output manager and dispatchers)
  * \param[in] header Pointer to the header of the message
  * \param[in] cnt    Initial value
  */
@@ -109,7 +111,7 @@ ipx_msg_header_cnt_set(struct ipx_msg *header, unsigned int cnt)
 }
 
 /**
- * \brief Decrement the reference counter (only for output plugins)
+ * \brief Decrement the reference counter (only for output plugins and replicas)
  * \param[in] header Pointer to the header of the message
  * \return True if this is the last reference and the message should be freed
  * \return False otherwise
@@ -0,0 +1,113 @@
+/**
+ * \file src/core/message_batch.c
+ * \author agent <agent@local>
+ * \brief Batch of IPFIX messages (source file)
+ * \date 2026
+ */
+
+/* Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is'', and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+#include <ipfixcol2.h>
+#include "message_base.h"
+#include "message_batch.h"
+
+/** Structure of a batch message */
+struct ipx_msg_batch {
+    /**
+     * Identification of this message.
+     * \warning This MUST be always first in this structure and the "type" MUST be #IPX_MSG_BATCH.
+     */
+    struct ipx_msg msg_header;
+
+    /** Number of IPFIX messages     */
+    uint32_t cnt;
+    /** Array of IPFIX messages      */
+    ipx_msg_t *msgs[];
+};
+
+static_assert(offsetof(struct ipx_msg_batch, msg_header.type) == 0,
+    "Message header must be the first element of each IPFIXcol message.");
+
+ipx_msg_batch_t *
+ipx_msg_batch_create(ipx_msg_t **msgs, uint32_t cnt)
+{
+    struct ipx_msg_batch *msg = malloc(sizeof(*msg) + cnt * sizeof(msg->msgs[0]));
+    if (!msg) {
+        return NULL;
+    }
+
+    ipx_msg_header_init(&msg->msg_header, IPX_MSG_BATCH);
+    msg->cnt = cnt;
+    memcpy(msg->msgs, msgs, cnt * sizeof(msg->msgs[0]));
+    return msg;
+}
+
+void
+ipx_msg_batch_release(ipx_msg_batch_t *msg)
+{
+    ipx_msg_header_destroy((ipx_msg_t *) msg);
+    free(msg);
+}
+
+void
+ipx_msg_batch_destroy(ipx_msg_batch_t *msg)
+{
+    for (uint32_t i = 0; i < msg->cnt; ++i) {
+        ipx_msg_ipfix_destroy(ipx_msg_base2ipfix(msg->msgs[i]));
+    }
+
+    ipx_msg_batch_release(msg);
+}
+
+uint32_t
+ipx_msg_batch_get_cnt(const ipx_msg_batch_t *msg)
+{
+    return msg->cnt;
+}
+
+ipx_msg_ipfix_t *
+ipx_msg_batch_get(ipx_msg_batch_t *msg, uint32_t idx)
+{
+    if (idx >= msg->cnt) {
+        return NULL;
+    }
+
+    return ipx_msg_base2ipfix(msg->msgs[idx]);
+}
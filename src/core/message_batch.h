@@ -0,0 +1,76 @@
+/**
+ * \file src/core/message_batch.h
+ * \author agent <agent@local>
+ * \brief Batch of IPFIX messages (internal header file)
+ * \date 2026
+ */
+
+/* Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is'', and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#ifndef IPFIXCOL_MESSAGE_BATCH_H
+#define IPFIXCOL_MESSAGE_BATCH_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <ipfixcol2.h>
+
+/**
+ * \brief Create a batch of IPFIX messages
+ *
+ * The batch takes ownership of all messages, i.e. they MUST NOT be used by the caller anymore.
+ * \param[in] msgs Array of IPFIX messages
+ * \param[in] cnt  Number of messages in the array
+ * \return Pointer to the batch or NULL (memory allocation error, the ownership of messages is
+ *   not changed)
+ */
+ipx_msg_batch_t *
+ipx_msg_batch_create(ipx_msg_t **msgs, uint32_t cnt);
+
+/**
+ * \brief Destroy a batch message without its IPFIX messages
+ *
+ * The ownership of all IPFIX messages in the batch is transferred to the caller, therefore,
+ * the messages must be retrieved before the batch is released.
+ * \param[in] msg Batch message
+ */
+void
+ipx_msg_batch_release(ipx_msg_batch_t *msg);
+
+#ifdef __cplusplus
+}
+#endif
+#endif // IPFIXCOL_MESSAGE_BATCH_H
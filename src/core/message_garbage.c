@@ -187,6 +187,20 @@ ipx_gc_add(ipx_gc_t *gc, void *data, ipx_msg_garbage_cb cb)
     return IPX_OK;
 }
 
+int
+ipx_gc_add_msg(ipx_gc_t *gc, ipx_msg_garbage_t *msg)
+{
+    int rc = ipx_gc_add(gc, msg->object_ptr, msg->object_destructor);
+    if (rc != IPX_OK) {
+        return rc;
+    }
+
+    // Destroy the message only (the garbage is owned by the container now)
+    ipx_msg_header_destroy((ipx_msg_t *) msg);
+    free(msg);
+    return IPX_OK;
+}
+
 int
 ipx_gc_reserve(ipx_gc_t *gc, size_t n)
 {
@@ -44,9 +44,20 @@
 #include "message_base.h"
 #include "message_ipfix.h"
 #include "context.h"
+#include "latency.h"
 
-#include <stddef.h> // offsetof
+#include <arpa/inet.h> // ntohs
+#include <stddef.h> // offsetof, max_align_t
 #include <stdlib.h> // free
+#include <string.h> // memcpy, memset
+
+/** Raw IPFIX packet shared by branches of a message (see ipx_msg_ipfix_branch_create())   */
+struct ipx_msg_ipfix_share {
+    /** Raw IPFIX packet                                                                    */
+    uint8_t *pkt;
+    /** Number of messages referencing the packet                                           */
+    uint32_t refs;
+};
 
 // Check correctness of structure implementation
 static_assert(offsetof(struct ipx_msg_ipfix, msg_header.type) == 0,
@@ -63,34 +74,81 @@ ipx_msg_ipfix_create(const ipx_ctx_t *plugin_ctx, const struct ipx_msg_ctx *msg_
     uint8_t *msg_data, uint16_t msg_size)
 {
     const size_t rec_size = ipx_ctx_recsize_get(plugin_ctx);
-    const size_t new_size = ipx_msg_ipfix_size(REC_DEF_CNT, rec_size);
-    struct ipx_msg_ipfix *wrapper = calloc(1, new_size);
-    if (!wrapper) {
-        return NULL;
+    ipx_msg_pool_t *pool = ipx_ctx_msg_pool_get(plugin_ctx);
+    uint32_t rec_cnt = REC_DEF_CNT;
+    struct ipx_msg_ipfix *wrapper;
+
+    if (pool != NULL) {
+        // Only the header must be cleared, records are initialized when added
+        wrapper = ipx_msg_pool_alloc(pool, &rec_cnt);
+        if (!wrapper) {
+            return NULL;
+        }
+        memset(wrapper, 0, offsetof(struct ipx_msg_ipfix, recs));
+    } else {
+        wrapper = calloc(1, ipx_msg_ipfix_size(rec_cnt, rec_size));
+        if (!wrapper) {
+            return NULL;
+        }
     }
 
     ipx_msg_header_init(&wrapper->msg_header, IPX_MSG_IPFIX);
     wrapper->ctx = *msg_ctx;
+    wrapper->ctx.ingress_ts = ipx_latency_enabled() ? ipx_latency_now() : 0;
+    wrapper->ctx.snap_gen = 0;
     wrapper->raw_pkt = msg_data;
     wrapper->raw_size = msg_size;
+    wrapper->pool = pool;
     wrapper->sets.cnt_alloc = SET_DEF_CNT;
-    wrapper->rec_info.cnt_alloc = REC_DEF_CNT;
+    wrapper->rec_info.cnt_alloc = rec_cnt;
     wrapper->rec_info.rec_size = rec_size;
     return wrapper;
 }
 
+/**
+ * \brief Release a reference to the shared raw packet of a message
+ *
+ * The packet is freed only if there are no other references.
+ * \param[in] msg IPFIX Message with a shared raw packet
+ */
+static void
+msg_share_release(struct ipx_msg_ipfix *msg)
+{
+    struct ipx_msg_ipfix_share *share = msg->share;
+    msg->share = NULL;
+
+    // Branches might be destroyed by different threads
+    if (__atomic_sub_fetch(&share->refs, 1U, __ATOMIC_ACQ_REL) != 0) {
+        return;
+    }
+
+    ipx_utils_buf_free(share->pkt);
+    free(share);
+}
+
 void
 ipx_msg_ipfix_destroy(ipx_msg_ipfix_t *msg)
 {
-    // Destroy the IPFIX packet
-    free(msg->raw_pkt);
+    // Destroy the IPFIX packet (unless it's still used by another branch)
+    if (msg->share != NULL) {
+        msg_share_release(msg);
+    } else {
+        ipx_utils_buf_free(msg->raw_pkt);
+    }
 
     // Destroy the wrapper
     if (msg->sets.extended) {
         free(msg->sets.extended);
     }
+    for (size_t i = 0; i < IPX_MSG_IPFIX_COLS_MAX; ++i) {
+        free(msg->ext_cols.data[i]);
+    }
     ipx_msg_header_destroy((ipx_msg_t *) msg);
-    free(msg);
+    if (msg->pool != NULL) {
+        ipx_msg_pool_free(msg->pool, msg, msg->rec_info.cnt_alloc, msg->rec_info.cnt_valid);
+    } else {
+        free(msg);
+    }
 }
 
 uint8_t *
@@ -140,6 +198,509 @@ ipx_msg_ipfix_get_drec(ipx_msg_ipfix_t *msg, uint32_t idx)
     return (struct ipx_ipfix_record *) rec_start;
 }
 
+uint32_t
+ipx_msg_ipfix_drec_compact(ipx_msg_ipfix_t *msg, const uint8_t *keep)
+{
+    const uint32_t rec_cnt = msg->rec_info.cnt_valid;
+    const size_t rec_size = msg->rec_info.rec_size;
+    uint8_t *recs = (uint8_t *) msg->recs;
+    uint32_t idx_out = 0;
+
+    // Records with extensions are moved as a whole, values of columns separately
+    for (uint32_t idx_in = 0; idx_in < rec_cnt; ++idx_in) {
+        if (!keep[idx_in]) {
+            continue;
+        }
+
+        if (idx_in != idx_out) {
+            memcpy(recs + (idx_out * rec_size), recs + (idx_in * rec_size), rec_size);
+            for (size_t col = 0; col < IPX_MSG_IPFIX_COLS_MAX; ++col) {
+                uint8_t *column = msg->ext_cols.data[col];
+                const size_t size = msg->ext_cols.sizes[col];
+                if (column == NULL) {
+                    continue;
+                }
+
+                memcpy(column + (idx_out * size), column + (idx_in * size), size);
+            }
+        }
+
+        idx_out++;
+    }
+
+    msg->rec_info.cnt_valid = idx_out;
+    for (size_t col = 0; col < IPX_MSG_IPFIX_COLS_MAX; ++col) {
+        if (msg->ext_cols.data[col] != NULL) {
+            msg->ext_cols.rows[col] = idx_out;
+        }
+    }
+
+    // Records are stored in the order of their Sets
+    struct ipx_ipfix_set *sets;
+    size_t set_cnt;
+    uint32_t idx_in = 0;
+
+    ipx_msg_ipfix_get_sets(msg, &sets, &set_cnt);
+    for (size_t i = 0; i < set_cnt; ++i) {
+        const uint32_t set_recs = sets[i].drec_cnt;
+        if (set_recs == 0 || idx_in + set_recs > rec_cnt) {
+            // Not a Data Set or references are not available (relay mode)
+            continue;
+        }
+
+        uint32_t kept = 0;
+        for (uint32_t j = 0; j < set_recs; ++j) {
+            kept += (keep[idx_in + j] != 0);
+        }
+
+        sets[i].drec_cnt = kept;
+        idx_in += set_recs;
+    }
+
+    return idx_out;
+}
+
+/** Minimal number of allocated flags of Data Records (see ipx_msg_ipfix_drec_flags())   */
+#define DREC_FLAGS_DEF (256U)
+
+uint8_t *
+ipx_msg_ipfix_drec_flags(const ipx_msg_ipfix_t *msg, struct ipx_drec_flags *flags)
+{
+    const uint32_t rec_cnt = msg->rec_info.cnt_valid;
+    if (flags->data != NULL && rec_cnt <= flags->alloc) {
+        return flags->data;
+    }
+
+    uint32_t alloc_new = (flags->alloc > 0) ? flags->alloc : DREC_FLAGS_DEF;
+    while (alloc_new < rec_cnt) {
+        alloc_new *= 2U;
+    }
+
+    uint8_t *data_new = realloc(flags->data, alloc_new * sizeof(*data_new));
+    if (!data_new) {
+        return NULL;
+    }
+
+    flags->data = data_new;
+    flags->alloc = alloc_new;
+    return data_new;
+}
+
+void
+ipx_msg_ipfix_drec_flags_free(struct ipx_drec_flags *flags)
+{
+    free(flags->data);
+    flags->data = NULL;
+    flags->alloc = 0;
+}
+
+int
+ipx_msg_ipfix_column_view(ipx_msg_ipfix_t *msg, uint32_t idx, uint32_t en, uint16_t id,
+    struct ipx_ipfix_column *col)
+{
+    const uint32_t rec_cnt = msg->rec_info.cnt_valid;
+    if (idx >= rec_cnt) {
+        return IPX_ERR_ARG;
+    }
+
+    const size_t rec_size = msg->rec_info.rec_size;
+    const uint8_t *rec_start = ((const uint8_t *) msg->recs) + idx * rec_size;
+    const struct fds_drec *first = &((const struct ipx_ipfix_record *) rec_start)->rec;
+    const struct fds_template *tmplt = first->tmplt;
+
+    // Update the cached position of the field (if the Template has changed)
+    if (col->tmplt != tmplt || col->en != en || col->id != id) {
+        col->tmplt = tmplt;
+        col->field = fds_template_cfind(tmplt, en, id);
+        col->en = en;
+        col->id = id;
+    }
+
+    // Find the run of records stored back-to-back
+    const uint16_t stride = first->size;
+    uint32_t run = 1;
+    for (uint32_t i = idx + 1; i < rec_cnt; ++i, ++run) {
+        rec_start += rec_size;
+        const struct fds_drec *rec = &((const struct ipx_ipfix_record *) rec_start)->rec;
+        if (rec->tmplt != tmplt || rec->size != stride
+                || rec->data != first->data + (size_t) run * stride) {
+            break;
+        }
+    }
+
+    col->cnt = run;
+    col->stride = stride;
+
+    const struct fds_tfield *field = col->field;
+    if (!field || field->offset == FDS_IPFIX_VAR_IE_LEN || field->length == FDS_IPFIX_VAR_IE_LEN) {
+        col->data = NULL;
+        col->size = 0;
+        return IPX_ERR_NOTFOUND;
+    }
+
+    col->data = first->data + field->offset;
+    col->size = field->length;
+    return IPX_OK;
+}
+
+uint32_t
+ipx_msg_ipfix_column_gather(ipx_msg_ipfix_t *msg, uint32_t idx, uint32_t cnt, uint32_t en,
+    uint16_t id, uint16_t size, void *out, uint8_t *present)
+{
+    uint8_t *out_ptr = out;
+    uint32_t found = 0;
+    uint32_t end = msg->rec_info.cnt_valid;
+    if (idx >= end) {
+        return 0;
+    }
+    if (cnt < end - idx) {
+        end = idx + cnt;
+    }
+
+    struct ipx_ipfix_column col = {0};
+    for (uint32_t i = idx; i < end; i += col.cnt) {
+        int rc = ipx_msg_ipfix_column_view(msg, i, en, id, &col);
+        if (col.cnt > end - i) {
+            col.cnt = end - i;
+        }
+
+        const size_t pos = i - idx;
+        if (rc == IPX_OK) {
+            // Fixed position of the field
+            const bool valid = (col.size == size);
+            for (uint32_t j = 0; j < col.cnt; ++j) {
+                if (valid) {
+                    memcpy(out_ptr + (pos + j) * size, col.data + j * col.stride, size);
+                } else {
+                    memset(out_ptr + (pos + j) * size, 0, size);
+                }
+            }
+            if (present) {
+                memset(present + pos, valid ? 1 : 0, col.cnt);
+            }
+            found += valid ? col.cnt : 0;
+            continue;
+        }
+
+        // Variable position (or missing field) - search each record
+        for (uint32_t j = 0; j < col.cnt; ++j) {
+            struct ipx_ipfix_record *rec = ipx_msg_ipfix_get_drec(msg, i + j);
+            struct fds_drec_field field;
+            bool valid = (col.field != NULL && fds_drec_find(&rec->rec, en, id, &field) != FDS_EOC
+                && field.size == size);
+            if (valid) {
+                memcpy(out_ptr + (pos + j) * size, field.data, size);
+                found++;
+            } else {
+                memset(out_ptr + (pos + j) * size, 0, size);
+            }
+            if (present) {
+                present[pos + j] = valid ? 1 : 0;
+            }
+        }
+    }
+
+    return found;
+}
+
+ipx_msg_ipfix_t *
+ipx_msg_ipfix_wrap(const ipx_ctx_t *plugin_ctx, const struct ipx_msg_ctx *msg_ctx,
+    uint8_t *msg_data, const fds_tsnapshot_t *snap)
+{
+    struct fds_ipfix_msg_hdr *hdr = (struct fds_ipfix_msg_hdr *) msg_data;
+    ipx_msg_ipfix_t *msg = ipx_msg_ipfix_create(plugin_ctx, msg_ctx, msg_data, ntohs(hdr->length));
+    if (!msg) {
+        return NULL;
+    }
+
+    struct fds_sets_iter sets_it;
+    fds_sets_iter_init(&sets_it, hdr);
+
+    int rc;
+    while ((rc = fds_sets_iter_next(&sets_it)) == FDS_OK) {
+        struct fds_ipfix_set_hdr *set = sets_it.set;
+        const uint16_t set_id = ntohs(set->flowset_id);
+        struct ipx_ipfix_set *set_ref = ipx_msg_ipfix_add_set_ref(msg);
+        if (!set_ref) {
+            break;
+        }
+
+        set_ref->ptr = set;
+        set_ref->snap = NULL;
+        set_ref->drec_cnt = 0;
+        if (set_id < FDS_IPFIX_SET_MIN_DSET) {
+            // (Options) Template Set
+            continue;
+        }
+
+        const struct fds_template *tmplt = fds_tsnapshot_template_get(snap, set_id);
+        if (!tmplt) {
+            break;
+        }
+
+        // The description of Sets is reallocated together with the message
+        const size_t set_idx = msg->sets.cnt_valid - 1;
+        uint32_t drec_cnt = 0;
+        struct fds_dset_iter rec_it;
+        fds_dset_iter_init(&rec_it, set, tmplt);
+
+        while ((rc = fds_dset_iter_next(&rec_it)) == FDS_OK) {
+            struct ipx_ipfix_record *rec_ref = ipx_msg_ipfix_add_drec_ref(&msg);
+            if (!rec_ref) {
+                break;
+            }
+
+            rec_ref->rec.data = rec_it.rec;
+            rec_ref->rec.size = rec_it.size;
+            rec_ref->rec.tmplt = tmplt;
+            rec_ref->rec.snap = snap;
+            drec_cnt++;
+        }
+        if (rc != FDS_EOC) {
+            break;
+        }
+
+        struct ipx_ipfix_set *sets;
+        ipx_msg_ipfix_get_sets(msg, &sets, NULL);
+        sets[set_idx].snap = snap;
+        sets[set_idx].drec_cnt = drec_cnt;
+    }
+
+    if (rc != FDS_EOC) {
+        // The raw message is still owned by the caller
+        msg->raw_pkt = NULL;
+        ipx_msg_ipfix_destroy(msg);
+        return NULL;
+    }
+
+    return msg;
+}
+
+/** Alignment of information about Templates in a cache (the same as malloc())            */
+#define TCACHE_ALIGN (sizeof(max_align_t))
+/** Default number of allocated records of a cache                                          */
+#define TCACHE_DEF_CNT (16U)
+
+/** Cache of plugin-specific information about Templates                                  */
+struct ipx_tcache {
+    /** Cached Templates                                                                    */
+    const struct fds_template **tmplts;
+    /** Information about Templates (the same order as Templates)                          */
+    uint8_t *recs;
+    /** Size of information about a Template (aligned)                                      */
+    size_t rec_size;
+    /** Number of cached Templates                                                          */
+    uint32_t cnt;
+    /** Number of allocated records                                                         */
+    uint32_t alloc;
+    /** Maximum number of cached Templates (0 = unlimited)                                  */
+    uint32_t max;
+};
+
+ipx_tcache_t *
+ipx_tcache_create(size_t rec_size, uint32_t max)
+{
+    struct ipx_tcache *cache = calloc(1, sizeof(*cache));
+    if (!cache) {
+        return NULL;
+    }
+
+    cache->rec_size = (rec_size + TCACHE_ALIGN - 1) / TCACHE_ALIGN * TCACHE_ALIGN;
+    cache->max = max;
+    return cache;
+}
+
+void
+ipx_tcache_destroy(ipx_tcache_t *cache)
+{
+    if (!cache) {
+        return;
+    }
+
+    free(cache->tmplts);
+    free(cache->recs);
+    free(cache);
+}
+
+void
+ipx_tcache_clear(ipx_tcache_t *cache)
+{
+    cache->cnt = 0;
+}
+
+void *
+ipx_tcache_find(const ipx_tcache_t *cache, const struct fds_template *tmplt)
+{
+    for (uint32_t i = 0; i < cache->cnt; ++i) {
+        if (cache->tmplts[i] == tmplt) {
+            return cache->recs + i * cache->rec_size;
+        }
+    }
+
+    return NULL;
+}
+
+void *
+ipx_tcache_add(ipx_tcache_t *cache, const struct fds_template *tmplt)
+{
+    if (cache->max != 0 && cache->cnt == cache->max) {
+        return NULL;
+    }
+
+    if (cache->cnt == cache->alloc) {
+        uint32_t alloc_new = (cache->alloc > 0) ? 2U * cache->alloc : TCACHE_DEF_CNT;
+        if (cache->max != 0 && alloc_new > cache->max) {
+            alloc_new = cache->max;
+        }
+
+        const struct fds_template **tmplts_new = realloc(cache->tmplts,
+            alloc_new * sizeof(*tmplts_new));
+        if (!tmplts_new) {
+            return NULL;
+        }
+        cache->tmplts = tmplts_new;
+
+        uint8_t *recs_new = realloc(cache->recs, alloc_new * cache->rec_size);
+        if (!recs_new) {
+            return NULL;
+        }
+        cache->recs = recs_new;
+        cache->alloc = alloc_new;
+    }
+
+    uint8_t *rec = cache->recs + cache->cnt * cache->rec_size;
+    memset(rec, 0, cache->rec_size);
+    cache->tmplts[cache->cnt++] = tmplt;
+    return rec;
+}
+
+uint16_t
+ipx_msg_ipfix_branch_get(const ipx_msg_ipfix_t *msg)
+{
+    return msg->branch;
+}
+
+void
+ipx_msg_ipfix_branch_set(ipx_msg_ipfix_t *msg, uint16_t branch)
+{
+    msg->branch = branch;
+}
+
+ipx_msg_ipfix_t *
+ipx_msg_ipfix_branch_create(ipx_msg_ipfix_t *msg, uint16_t branch)
+{
+    const uint32_t rec_cnt = msg->rec_info.cnt_valid;
+    const uint32_t rec_alloc = (rec_cnt > REC_DEF_CNT) ? rec_cnt : REC_DEF_CNT;
+    const size_t rec_size = msg->rec_info.rec_size;
+
+    struct ipx_msg_ipfix *copy = malloc(ipx_msg_ipfix_size(rec_alloc, rec_size));
+    if (!copy) {
+        return NULL;
+    }
+
+    // Copy the description of the message (i.e. context, Sets and Data Records)
+    memcpy(copy, msg, ipx_msg_ipfix_size(rec_cnt, rec_size));
+    ipx_msg_header_init(&copy->msg_header, IPX_MSG_IPFIX);
+    copy->pool = NULL;
+    copy->branch = branch;
+    copy->rec_info.cnt_alloc = rec_alloc;
+    copy->sets.extended = NULL;
+    memset(copy->ext_cols.data, 0, sizeof(copy->ext_cols.data));
+
+    bool failed = false;
+    if (msg->sets.extended != NULL) {
+        const size_t size = msg->sets.cnt_alloc * sizeof(struct ipx_ipfix_set);
+        copy->sets.extended = malloc(size);
+        failed |= (copy->sets.extended == NULL);
+        if (copy->sets.extended != NULL) {
+            memcpy(copy->sets.extended, msg->sets.extended, size);
+        }
+    }
+
+    for (size_t col = 0; col < IPX_MSG_IPFIX_COLS_MAX && !failed; ++col) {
+        if (msg->ext_cols.data[col] == NULL) {
+            continue;
+        }
+
+        const size_t size = (size_t) msg->ext_cols.rows[col] * msg->ext_cols.sizes[col];
+        copy->ext_cols.data[col] = malloc(size);
+        failed |= (copy->ext_cols.data[col] == NULL);
+        if (copy->ext_cols.data[col] != NULL) {
+            memcpy(copy->ext_cols.data[col], msg->ext_cols.data[col], size);
+        }
+    }
+
+    if (!failed && msg->share == NULL) {
+        // The first branch of the message -> the packet is not exclusively owned anymore
+        msg->share = malloc(sizeof(*msg->share));
+        failed |= (msg->share == NULL);
+        if (msg->share != NULL) {
+            msg->share->pkt = msg->raw_pkt;
+            msg->share->refs = 1;
+        }
+    }
+
+    if (failed) {
+        free(copy->sets.extended);
+        for (size_t col = 0; col < IPX_MSG_IPFIX_COLS_MAX; ++col) {
+            free(copy->ext_cols.data[col]);
+        }
+        free(copy);
+        return NULL;
+    }
+
+    __atomic_add_fetch(&msg->share->refs, 1U, __ATOMIC_RELAXED);
+    copy->share = msg->share;
+    return copy;
+}
+
+int
+ipx_msg_ipfix_writable(ipx_msg_ipfix_t *msg)
+{
+    if (msg->share == NULL) {
+        // The packet is exclusively owned
+        return IPX_OK;
+    }
+
+    if (__atomic_load_n(&msg->share->refs, __ATOMIC_ACQUIRE) == 1) {
+        // Other branches have been already destroyed -> take the ownership
+        free(msg->share);
+        msg->share = NULL;
+        return IPX_OK;
+    }
+
+    uint8_t *pkt = ipx_utils_buf_alloc(msg->raw_size);
+    if (!pkt) {
+        return IPX_ERR_NOMEM;
+    }
+
+    // Copy the packet and move references to Sets and Data Records
+    memcpy(pkt, msg->raw_pkt, msg->raw_size);
+    const uint8_t *pkt_old = msg->raw_pkt;
+
+    struct ipx_ipfix_set *sets;
+    size_t sets_cnt;
+    ipx_msg_ipfix_get_sets(msg, &sets, &sets_cnt);
+    for (size_t i = 0; i < sets_cnt; ++i) {
+        const size_t offset = ((const uint8_t *) sets[i].ptr) - pkt_old;
+        sets[i].ptr = (struct fds_ipfix_set_hdr *) (pkt + offset);
+    }
+
+    for (uint32_t i = 0; i < msg->rec_info.cnt_valid; ++i) {
+        struct fds_drec *rec = &ipx_msg_ipfix_get_drec(msg, i)->rec;
+        if (rec->data < pkt_old || rec->data >= pkt_old + msg->raw_size) {
+            // The record has been replaced by a previous plugin (not a part of the packet)
+            continue;
+        }
+
+        rec->data = pkt + (rec->data - pkt_old);
+    }
+
+    msg_share_release(msg);
+    msg->raw_pkt = pkt;
+    return IPX_OK;
+}
+
 struct ipx_ipfix_set *
 ipx_msg_ipfix_add_set_ref(struct ipx_msg_ipfix *msg)
 {
@@ -170,24 +731,44 @@ ipx_msg_ipfix_add_set_ref(struct ipx_msg_ipfix *msg)
 
 struct ipx_ipfix_record *
 ipx_msg_ipfix_add_drec_ref(struct ipx_msg_ipfix **msg_ref)
+{
+    return ipx_msg_ipfix_add_drec_refs(msg_ref, 1);
+}
+
+struct ipx_ipfix_record *
+ipx_msg_ipfix_add_drec_refs(struct ipx_msg_ipfix **msg_ref, uint32_t cnt)
 {
     struct ipx_msg_ipfix *msg = *msg_ref;
-    if (msg->rec_info.cnt_valid == msg->rec_info.cnt_alloc) {
+    const uint32_t cnt_new = msg->rec_info.cnt_valid + cnt;
+    if (cnt_new > msg->rec_info.cnt_alloc) {
         // Reallocation of the message is necessary
-        const uint32_t alloc_new = 2U * msg->rec_info.cnt_valid;
+        uint32_t alloc_new = (msg->rec_info.cnt_alloc > 0) ? msg->rec_info.cnt_alloc : REC_DEF_CNT;
+        while (alloc_new < cnt_new) {
+            alloc_new *= 2U;
+        }
+
         const size_t alloc_size = ipx_msg_ipfix_size(alloc_new, msg->rec_info.rec_size);
         struct ipx_msg_ipfix *msg_new = realloc(msg, alloc_size);
         if (!msg_new) {
             return NULL;
         }
 
+        if (msg_new->pool != NULL) {
+            ipx_msg_pool_resize(msg_new->pool, msg_new->rec_info.cnt_alloc, alloc_new);
+        }
         msg_new->rec_info.cnt_alloc = alloc_new;
         msg = msg_new;
         *msg_ref = msg_new;
     }
 
-    assert(msg->rec_info.cnt_valid < msg->rec_info.cnt_alloc);
-    const size_t offset = msg->rec_info.cnt_valid * msg->rec_info.rec_size;
-    msg->rec_info.cnt_valid++;
-    return ((struct ipx_ipfix_record *) (((uint8_t *) msg->recs) + offset));
+    assert(cnt_new <= msg->rec_info.cnt_alloc);
+    const size_t rec_size = msg->rec_info.rec_size;
+    uint8_t *first = ((uint8_t *) msg->recs) + (msg->rec_info.cnt_valid * rec_size);
+    msg->rec_info.cnt_valid = cnt_new;
+
+    // Memory of the records might be reused (or reallocated), no extensions are filled yet
+    for (uint32_t i = 0; i < cnt; ++i) {
+        ((struct ipx_ipfix_record *) (first + (i * rec_size)))->ext_mask = 0;
+    }
+    return (struct ipx_ipfix_record *) first;
 }
\ No newline at end of file
@@ -46,11 +46,14 @@
 #include <ipfixcol2.h>
 #include <stdlib.h>
 #include "message_base.h"
+#include "message_pool.h"
 
 /** Default number of pre-allocated structures for parser IPFIX Sets         */
 #define SET_DEF_CNT (32)
 /** Default number of pre-allocated structures for parser IPFIX Data Records */
 #define REC_DEF_CNT (64)
+/** Maximum number of columnar extensions of Data Records                    */
+#define IPX_MSG_IPFIX_COLS_MAX (8)
 
 /**
  * \brief Structure for a parsed IPFIX Message
@@ -69,6 +72,12 @@ struct ipx_msg_ipfix {
     uint8_t *raw_pkt;
     /** Size of raw message                                                  */
     uint16_t raw_size;
+    /** Pool of the wrapper (NULL, if allocated without a pool)              */
+    ipx_msg_pool_t *pool;
+    /** Raw packet shared with other branches (NULL, if owned exclusively)   */
+    struct ipx_msg_ipfix_share *share;
+    /** Branch of the pipeline (0 = the main branch)                         */
+    uint16_t branch;
 
     struct {
         /** Array of sets (valid only when #cnt_valid <= SET_DEF_CNT)       */
@@ -82,6 +91,17 @@ struct ipx_msg_ipfix {
         uint32_t cnt_alloc;
     } sets; /**< Parsed IPFIX (Data/Template/Options Template) Sets          */
 
+    struct {
+        /** Columns (NULL == not allocated), indexed by the extension column */
+        uint8_t *data[IPX_MSG_IPFIX_COLS_MAX];
+        /** Number of values (i.e. Data Records) in each column              */
+        uint32_t rows[IPX_MSG_IPFIX_COLS_MAX];
+        /** Size of a value of each column                                   */
+        uint32_t sizes[IPX_MSG_IPFIX_COLS_MAX];
+        /** Bit mask of filled columns (set by producers)                    */
+        uint32_t filled;
+    } ext_cols; /**< Columnar extensions of Data Records                    */
+
     struct {
         /** Size of a single record (depends on registered extensions)       */
         size_t rec_size;
@@ -116,4 +136,17 @@ struct ipx_msg_ipfix {
 size_t
 ipx_msg_ipfix_size(uint32_t rec_cnt, size_t rec_size);
 
+/**
+ * \brief Add multiple consecutive references to Data Records at once
+ *
+ * Same as ipx_msg_ipfix_add_drec_ref(), but the wrapper is reallocated (if necessary) only once.
+ * The distance between two added records is the size of a record (see ipx_msg_ipfix::rec_info).
+ * \warning The wrapper can be reallocated, therefore, the original pointer \p msg_ref is updated.
+ * \param[in,out] msg_ref IPFIX Message wrapper
+ * \param[in]     cnt     Number of references to add (must be at least 1)
+ * \return Pointer to the first added reference or NULL (memory allocation error)
+ */
+struct ipx_ipfix_record *
+ipx_msg_ipfix_add_drec_refs(struct ipx_msg_ipfix **msg_ref, uint32_t cnt);
+
 #endif // IPFIXCOL_MESSAGE_IPFIX_INTERNAL_H
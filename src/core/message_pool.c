@@ -0,0 +1,291 @@
+/**
+ * \file src/core/message_pool.c
+ * \author agent <agent@local>
+ * \brief Pool of IPFIX Message wrappers (source file)
+ * \date 2026
+ */
+
+/* Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is'', and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#include <stdlib.h>
+#include "message_pool.h"
+#include "message_ipfix.h"
+
+/** Number of size classes (capacity of REC_DEF_CNT * 2^idx Data Records)           */
+#define MSG_POOL_CLASSES (8U)
+/** Maximum number of cached blocks per size class                                  */
+#define MSG_POOL_CACHE_MAX (256U)
+/** Weight of new samples of the number of Data Records (as a power of two)         */
+#define MSG_POOL_HINT_SHIFT (3U)
+/** Size of a cache line                                                            */
+#define MSG_POOL_CACHE_LINE (64U)
+
+/** Cached memory block (the original content is overwritten)                       */
+struct msg_pool_block {
+    /** Next block in the list                                                      */
+    struct msg_pool_block *next;
+};
+
+/** Free list of a size class that can be accessed by any thread                    */
+struct msg_pool_shared {
+    /** Head of the list (atomic)                                                   */
+    struct msg_pool_block *head;
+    /** Approximate number of blocks (atomic)                                       */
+    uint32_t cnt;
+} __attribute__((aligned(MSG_POOL_CACHE_LINE)));
+
+/** Free list of a size class owned by the owner of the pool                        */
+struct msg_pool_local {
+    /** Head of the list                                                            */
+    struct msg_pool_block *head;
+    /** Number of blocks                                                            */
+    uint32_t cnt;
+};
+
+struct ipx_msg_pool {
+    /** Size of a block without Data Records                                        */
+    size_t hdr_size;
+    /** Size of a single Data Record                                                */
+    size_t rec_size;
+    /** Operation mode                                                              */
+    enum ipx_msg_pool_mode mode;
+
+    /** Blocks available only to the owner                                          */
+    struct msg_pool_local local[MSG_POOL_CLASSES];
+    /** Blocks returned by other threads                                            */
+    struct msg_pool_shared shared[MSG_POOL_CLASSES];
+
+    /**
+     * Observed number of Data Records per message (fixed point, atomic)
+     * \note Updated by multiple threads without synchronization, i.e. only approximate
+     */
+    uint32_t rec_hint __attribute__((aligned(MSG_POOL_CACHE_LINE)));
+    /** Number of references (the owner + blocks taken from the pool, atomic)      */
+    uint32_t refs;
+    /** Memory accounting tag (NULL, if disabled)                                   */
+    struct ipx_mem_tag *tag;
+};
+
+/**
+ * \brief Get capacity of Data Records of a size class
+ * \param[in] idx Index of the class
+ * \return Capacity
+ */
+static inline uint32_t
+msg_pool_class_cap(unsigned int idx)
+{
+    return REC_DEF_CNT << idx;
+}
+
+/**
+ * \brief Get the smallest size class that is able to hold given number of Data Records
+ * \param[in] rec_cnt Number of Data Records
+ * \return Index of the class (the largest class if the number is too large)
+ */
+static inline unsigned int
+msg_pool_class_find(uint32_t rec_cnt)
+{
+    unsigned int idx = 0;
+    while (idx < MSG_POOL_CLASSES - 1 && msg_pool_class_cap(idx) < rec_cnt) {
+        idx++;
+    }
+    return idx;
+}
+
+/**
+ * \brief Get the size of a memory block
+ * \param[in] pool    Pool
+ * \param[in] rec_cnt Capacity of Data Records of the block
+ * \return Size in bytes
+ */
+static inline size_t
+msg_pool_block_size(const struct ipx_msg_pool *pool, uint32_t rec_cnt)
+{
+    return pool->hdr_size + rec_cnt * pool->rec_size;
+}
+
+/**
+ * \brief Free all blocks in a list
+ * \param[in] pool Pool
+ * \param[in] head Head of the list
+ * \param[in] idx  Index of the size class of the blocks
+ */
+static void
+msg_pool_list_free(struct ipx_msg_pool *pool, struct msg_pool_block *head, unsigned int idx)
+{
+    while (head != NULL) {
+        struct msg_pool_block *next = head->next;
+        free(head);
+        ipx_mem_tag_sub(pool->tag, msg_pool_block_size(pool, msg_pool_class_cap(idx)));
+        head = next;
+    }
+}
+
+/**
+ * \brief Remove a reference to the pool and destroy the pool if it was the last one
+ * \param[in] pool Pool
+ */
+static void
+msg_pool_unref(struct ipx_msg_pool *pool)
+{
+    if (__atomic_sub_fetch(&pool->refs, 1U, __ATOMIC_ACQ_REL) != 0) {
+        return;
+    }
+
+    for (unsigned int i = 0; i < MSG_POOL_CLASSES; ++i) {
+        msg_pool_list_free(pool, pool->local[i].head, i);
+        msg_pool_list_free(pool, pool->shared[i].head, i);
+    }
+    ipx_mem_tag_unref(pool->tag);
+    free(pool);
+}
+
+ipx_msg_pool_t *
+ipx_msg_pool_create(size_t hdr_size, size_t rec_size, enum ipx_msg_pool_mode mode,
+    struct ipx_mem_tag *tag)
+{
+    struct ipx_msg_pool *pool;
+    if (posix_memalign((void **) &pool, MSG_POOL_CACHE_LINE, sizeof(*pool)) != 0) {
+        return NULL;
+    }
+
+    for (unsigned int i = 0; i < MSG_POOL_CLASSES; ++i) {
+        pool->local[i].head = NULL;
+        pool->local[i].cnt = 0;
+        pool->shared[i].head = NULL;
+        pool->shared[i].cnt = 0;
+    }
+
+    pool->hdr_size = hdr_size;
+    pool->rec_size = rec_size;
+    pool->mode = mode;
+    pool->rec_hint = REC_DEF_CNT << MSG_POOL_HINT_SHIFT;
+    pool->refs = 1; // The owner
+    pool->tag = tag;
+    if (tag != NULL) {
+        ipx_mem_tag_ref(tag);
+    }
+    return pool;
+}
+
+void
+ipx_msg_pool_release(ipx_msg_pool_t *pool)
+{
+    msg_pool_unref(pool);
+}
+
+void *
+ipx_msg_pool_alloc(ipx_msg_pool_t *pool, uint32_t *rec_cnt)
+{
+    unsigned int idx = 0;
+    if (pool->mode == IPX_MSG_POOL_ADAPTIVE) {
+        uint32_t hint = __atomic_load_n(&pool->rec_hint, __ATOMIC_RELAXED) >> MSG_POOL_HINT_SHIFT;
+        idx = msg_pool_class_find(hint);
+    }
+
+    struct msg_pool_local *local = &pool->local[idx];
+    if (local->head == NULL && __atomic_load_n(&pool->shared[idx].head, __ATOMIC_RELAXED)) {
+        // Take all blocks returned by other threads at once
+        struct msg_pool_shared *shared = &pool->shared[idx];
+        local->head = __atomic_exchange_n(&shared->head, NULL, __ATOMIC_ACQUIRE);
+        uint32_t cnt = 0;
+        for (struct msg_pool_block *it = local->head; it != NULL; it = it->next) {
+            cnt++;
+        }
+        __atomic_sub_fetch(&shared->cnt, cnt, __ATOMIC_RELAXED);
+        local->cnt = cnt;
+    }
+
+    void *result;
+    if (local->head != NULL) {
+        struct msg_pool_block *block = local->head;
+        local->head = block->next;
+        local->cnt--;
+        result = block;
+    } else {
+        const size_t size = msg_pool_block_size(pool, msg_pool_class_cap(idx));
+        result = malloc(size);
+        if (!result) {
+            return NULL;
+        }
+        ipx_mem_tag_add(pool->tag, size);
+    }
+
+    __atomic_add_fetch(&pool->refs, 1U, __ATOMIC_RELAXED);
+    *rec_cnt = msg_pool_class_cap(idx);
+    return result;
+}
+
+void
+ipx_msg_pool_free(ipx_msg_pool_t *pool, void *block, uint32_t rec_cnt, uint32_t rec_used)
+{
+    if (pool->mode == IPX_MSG_POOL_ADAPTIVE) {
+        // Exponential moving average of the number of records (lost updates don't matter)
+        uint32_t hint = __atomic_load_n(&pool->rec_hint, __ATOMIC_RELAXED);
+        hint = hint - (hint >> MSG_POOL_HINT_SHIFT) + rec_used;
+        __atomic_store_n(&pool->rec_hint, hint, __ATOMIC_RELAXED);
+    }
+
+    unsigned int idx = msg_pool_class_find(rec_cnt);
+    struct msg_pool_shared *shared = &pool->shared[idx];
+    if (msg_pool_class_cap(idx) != rec_cnt
+            || __atomic_load_n(&shared->cnt, __ATOMIC_RELAXED) >= MSG_POOL_CACHE_MAX) {
+        // Not suitable for any size class or the class is full
+        free(block);
+        ipx_mem_tag_sub(pool->tag, msg_pool_block_size(pool, rec_cnt));
+        msg_pool_unref(pool);
+        return;
+    }
+
+    // Increment the counter first, so the owner never subtracts more than was added
+    __atomic_add_fetch(&shared->cnt, 1U, __ATOMIC_RELAXED);
+    struct msg_pool_block *item = (struct msg_pool_block *) block;
+    item->next = __atomic_load_n(&shared->head, __ATOMIC_RELAXED);
+    while (!__atomic_compare_exchange_n(&shared->head, &item->next, item, true,
+            __ATOMIC_RELEASE, __ATOMIC_RELAXED)) {
+        // item->next has been updated, try again
+    }
+    msg_pool_unref(pool);
+}
+
+void
+ipx_msg_pool_resize(ipx_msg_pool_t *pool, uint32_t cnt_old, uint32_t cnt_new)
+{
+    if (cnt_new > cnt_old) {
+        ipx_mem_tag_add(pool->tag, (cnt_new - cnt_old) * pool->rec_size);
+    } else {
+        ipx_mem_tag_sub(pool->tag, (cnt_old - cnt_new) * pool->rec_size);
+    }
+}
@@ -0,0 +1,139 @@
+/**
+ * \file src/core/message_pool.h
+ * \author agent <agent@local>
+ * \brief Pool of IPFIX Message wrappers (header file)
+ * \date 2026
+ */
+
+/* Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is'', and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#ifndef IPFIXCOL_MESSAGE_POOL_H
+#define IPFIXCOL_MESSAGE_POOL_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "memory.h"
+
+/**
+ * \defgroup ipxMsgPool Pool of IPFIX Message wrappers
+ * \brief Recycling of memory blocks of IPFIX Message wrappers
+ *
+ * IPFIX Message wrappers are created by an input instance but usually destroyed by another
+ * thread (e.g. the last output instance). The pool keeps released wrappers in size classes
+ * (by the capacity of Data Records, i.e. #REC_DEF_CNT times a power of two) so the hot path
+ * doesn't call the allocator. Memory blocks can be returned by any thread, however, only the
+ * owner (i.e. the thread of the input instance) can take blocks from the pool.
+ *
+ * The pool is reference counted. Each block taken from the pool holds a reference, therefore,
+ * the pool is freed only after its owner releases the pool and all blocks are returned.
+ *
+ * If a memory accounting tag is given, all blocks allocated by the pool (i.e. blocks in use
+ * and cached blocks) are accounted to it.
+ * @{
+ */
+
+/** Internal type of the pool */
+typedef struct ipx_msg_pool ipx_msg_pool_t;
+
+/** Operation mode of a pool */
+enum ipx_msg_pool_mode {
+    /** The pool is not used                                                                  */
+    IPX_MSG_POOL_DISABLED,
+    /** Wrappers are always prepared for the default number of Data Records                   */
+    IPX_MSG_POOL_FIXED,
+    /** Capacity of wrappers is derived from the observed number of Data Records per message  */
+    IPX_MSG_POOL_ADAPTIVE
+};
+
+/**
+ * \brief Create a new pool
+ * \param[in] hdr_size Size of a block without Data Records
+ * \param[in] rec_size Size of a single Data Record
+ * \param[in] mode     Operation mode (#IPX_MSG_POOL_FIXED or #IPX_MSG_POOL_ADAPTIVE)
+ * \param[in] tag      Memory accounting tag (can be NULL, a reference is added)
+ * \return Pointer or NULL (memory allocation error)
+ */
+ipx_msg_pool_t *
+ipx_msg_pool_create(size_t hdr_size, size_t rec_size, enum ipx_msg_pool_mode mode,
+    struct ipx_mem_tag *tag);
+
+/**
+ * \brief Release the pool by its owner
+ *
+ * The pool is destroyed as soon as all blocks taken from the pool are returned.
+ * \warning The owner MUST NOT use the pool anymore!
+ * \param[in] pool Pool
+ */
+void
+ipx_msg_pool_release(ipx_msg_pool_t *pool);
+
+/**
+ * \brief Get a memory block from the pool
+ *
+ * \warning Can be called only by the owner of the pool! Content of the block is undefined.
+ * \param[in]  pool    Pool
+ * \param[out] rec_cnt Capacity of Data Records of the block
+ * \return Pointer or NULL (memory allocation error)
+ */
+void *
+ipx_msg_pool_alloc(ipx_msg_pool_t *pool, uint32_t *rec_cnt);
+
+/**
+ * \brief Return a memory block to the pool
+ *
+ * \note Can be called by any thread. If the capacity doesn't correspond to any size class or
+ *   the class is full, the block is freed.
+ * \param[in] pool     Pool
+ * \param[in] block    Memory block (possibly reallocated by realloc())
+ * \param[in] rec_cnt  Capacity of Data Records of the block
+ * \param[in] rec_used Number of valid Data Records in the block (for adaptive sizing)
+ */
+void
+ipx_msg_pool_free(ipx_msg_pool_t *pool, void *block, uint32_t rec_cnt, uint32_t rec_used);
+
+/**
+ * \brief Account reallocation of a memory block taken from the pool
+ *
+ * \note Can be called by any thread. The block is still returned by ipx_msg_pool_free().
+ * \param[in] pool    Pool
+ * \param[in] cnt_old Previous capacity of Data Records of the block
+ * \param[in] cnt_new New capacity of Data Records of the block
+ */
+void
+ipx_msg_pool_resize(ipx_msg_pool_t *pool, uint32_t cnt_old, uint32_t cnt_new);
+
+/**@}*/
+#endif // IPFIXCOL_MESSAGE_POOL_H
@@ -76,7 +76,11 @@ void
 ipx_msg_terminate_destroy(ipx_msg_terminate_t *msg)
 {
     ipx_msg_header_destroy((ipx_msg_t *) msg);
-    ipx_cpipe_send_term(NULL, IPX_CPIPE_TYPE_TERM_DONE);
+    if (msg->type == IPX_MSG_TERMINATE_RECONF) {
+        ipx_cpipe_send_reconf(IPX_CPIPE_TYPE_RECONF_DONE);
+    } else {
+        ipx_cpipe_send_term(NULL, IPX_CPIPE_TYPE_TERM_DONE);
+    }
     free(msg);
 }
 
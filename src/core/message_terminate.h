@@ -59,7 +59,15 @@ enum ipx_msg_terminate_type {
      * After receiving this message, a context MUST call plugin destructor on its instance and
      * terminate thread of the context.
      */
-    IPX_MSG_TERMINATE_INSTANCE
+    IPX_MSG_TERMINATE_INSTANCE,
+    /**
+     * \brief Apply a runtime reconfiguration
+     *
+     * Instances pass the message as any other control message. When the output manager receives
+     * it, the manager replaces its list of output destinations by the prepared one (see
+     * ipx_output_mgr_list_replace()) and passes the message only to the new destinations.
+     */
+    IPX_MSG_TERMINATE_RECONF
 };
 
 /**
@@ -76,6 +84,9 @@ ipx_msg_terminate_create(enum ipx_msg_terminate_type type);
 
 /**
  * \brief Destroy a termination message
+ *
+ * The configurator is notified that the message has been processed by all instances, i.e.
+ * #IPX_CPIPE_TYPE_TERM_DONE or #IPX_CPIPE_TYPE_RECONF_DONE request is sent (based on the type).
  * \param[in] msg Pointer to the message
  */
 IPX_API void
@@ -0,0 +1,800 @@
+/**
+ * \file src/core/metrics.c
+ * \author agent <agent@local>
+ * \brief Runtime metrics of instances and their HTTP exporter (source file)
+ * \date 2026
+ */
+
+
+/* Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is'', and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#define _GNU_SOURCE
+#include <errno.h>
+#include <fcntl.h>
+#include <inttypes.h>
+#include <netdb.h>
+#include <poll.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <netinet/in.h>
+#include <sys/prctl.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+
+#include "metrics.h"
+#include "verbose.h"
+#include "utils.h"
+
+/** Identification of this component (for log) */
+static const char *module = "Metrics";
+
+/** Prefix of names of all exported metrics                                                      */
+#define METRICS_PREFIX "ipfixcol2_"
+/** Maximum size of an HTTP request                                                              */
+#define METRICS_REQ_SIZE (4096U)
+/** Timeout of communication with a client (in seconds)                                          */
+#define METRICS_TIMEOUT (5)
+
+/** Registered metric                                                                            */
+struct metrics_entry {
+    /** Plugin context (owner of the metric)                                                     */
+    const ipx_ctx_t *owner;
+    /** Type of the metric                                                                       */
+    enum ipx_metric_type type;
+    /** Name of the metric (without the prefix)                                                  */
+    char *name;
+    /** Short description of the metric                                                          */
+    char *help;
+    /** Storage of the metric (NULL, if provided by the callback)                                */
+    struct ipx_metric *storage;
+    /** Callback providing the value (NULL, if stored in the storage)                            */
+    ipx_metrics_read_cb cb;
+    /** Private data of the callback                                                             */
+    const void *cb_data;
+};
+
+/** Registry of all metrics                                                                      */
+static struct {
+    /** Protection of the registry (metrics are added, removed and read by different threads)   */
+    pthread_mutex_t lock;
+    /** Array of metrics                                                                         */
+    struct metrics_entry *items;
+    /** Number of valid metrics in the array                                                     */
+    size_t cnt;
+    /** Number of allocated metrics in the array                                                 */
+    size_t alloc;
+} registry = {PTHREAD_MUTEX_INITIALIZER, NULL, 0, 0};
+
+/** HTTP exporter                                                                                */
+static struct {
+    /** The exporter is running                                                                  */
+    bool running;
+    /** Thread of the exporter                                                                   */
+    pthread_t thread;
+    /** Listening socket                                                                         */
+    int fd_listen;
+    /** Pipe used to stop the thread (read end, write end)                                       */
+    int fd_stop[2];
+} server = {false, 0, -1, {-1, -1}};
+
+/** Output buffer                                                                                */
+struct metrics_buffer {
+    /** Data (always null terminated, if allocated)                                              */
+    char *data;
+    /** Length of the data                                                                       */
+    size_t len;
+    /** Allocated size                                                                           */
+    size_t alloc;
+    /** A memory allocation error has occurred                                                   */
+    bool error;
+};
+
+/**
+ * \brief Check if the name of a metric is valid
+ *
+ * The name must match "[a-zA-Z_:][a-zA-Z0-9_:]*".
+ * \param[in] name Name
+ * \return True or false
+ */
+static bool
+metrics_name_valid(const char *name)
+{
+    if (name == NULL || name[0] == '\0' || (name[0] >= '0' && name[0] <= '9')) {
+        return false;
+    }
+
+    for (const char *pos = name; *pos != '\0'; ++pos) {
+        const char c = *pos;
+        if ((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9')
+                || c == '_' || c == ':') {
+            continue;
+        }
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * \brief Add a metric to the registry
+ * \param[in] entry Description of the metric (strings are copied)
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_FORMAT if the name is not valid or the metric has a different type
+ * \return #IPX_ERR_NOMEM in case of a memory allocation error
+ */
+static int
+metrics_add(const struct metrics_entry *entry)
+{
+    if (!metrics_name_valid(entry->name)) {
+        IPX_ERROR(module, "Invalid name of a metric '%s'!",
+            (entry->name != NULL) ? entry->name : "");
+        return IPX_ERR_FORMAT;
+    }
+
+    int rc = IPX_OK;
+    pthread_mutex_lock(&registry.lock);
+
+    for (size_t i = 0; i < registry.cnt; ++i) {
+        const struct metrics_entry *item = &registry.items[i];
+        if (item->type != entry->type && strcmp(item->name, entry->name) == 0) {
+            IPX_ERROR(module, "Metric '%s' has been already registered with a different type!",
+                entry->name);
+            rc = IPX_ERR_FORMAT;
+            goto end;
+        }
+    }
+
+    if (registry.cnt == registry.alloc) {
+        const size_t alloc_new = (registry.alloc > 0) ? (2 * registry.alloc) : 32U;
+        struct metrics_entry *items_new = realloc(registry.items, alloc_new * sizeof(*items_new));
+        if (!items_new) {
+            rc = IPX_ERR_NOMEM;
+            goto end;
+        }
+        registry.items = items_new;
+        registry.alloc = alloc_new;
+    }
+
+    struct metrics_entry *item = &registry.items[registry.cnt];
+    *item = *entry;
+    item->name = strdup(entry->name);
+    item->help = strdup((entry->help != NULL) ? entry->help : "");
+    if (!item->name || !item->help) {
+        free(item->name);
+        free(item->help);
+        rc = IPX_ERR_NOMEM;
+        goto end;
+    }
+    registry.cnt++;
+
+end:
+    pthread_mutex_unlock(&registry.lock);
+    return rc;
+}
+
+struct ipx_metric *
+ipx_ctx_metric_register(ipx_ctx_t *ctx, enum ipx_metric_type type, const char *name,
+    const char *help)
+{
+    struct ipx_metric *storage;
+    if (posix_memalign((void **) &storage, IPX_METRIC_SIZE, sizeof(*storage)) != 0) {
+        IPX_CTX_ERROR(ctx, "Memory allocation failed! (%s:%d)", __FILE__, __LINE__);
+        return NULL;
+    }
+    memset(storage, 0, sizeof(*storage));
+
+    struct metrics_entry entry = {ctx, type, (char *) name, (char *) help, storage, NULL, NULL};
+    if (metrics_add(&entry) != IPX_OK) {
+        IPX_CTX_ERROR(ctx, "Failed to register metric '%s'!", (name != NULL) ? name : "");
+        free(storage);
+        return NULL;
+    }
+
+    return storage;
+}
+
+int
+ipx_metrics_add_cb(const ipx_ctx_t *ctx, enum ipx_metric_type type, const char *name,
+    const char *help, ipx_metrics_read_cb cb, const void *data)
+{
+    struct metrics_entry entry = {ctx, type, (char *) name, (char *) help, NULL, cb, data};
+    return metrics_add(&entry);
+}
+
+void
+ipx_metrics_remove(const ipx_ctx_t *ctx)
+{
+    pthread_mutex_lock(&registry.lock);
+
+    size_t idx_out = 0;
+    for (size_t idx_in = 0; idx_in < registry.cnt; ++idx_in) {
+        struct metrics_entry *item = &registry.items[idx_in];
+        if (item->owner != ctx) {
+            registry.items[idx_out++] = *item;
+            continue;
+        }
+
+        free(item->storage);
+        free(item->name);
+        free(item->help);
+    }
+    registry.cnt = idx_out;
+
+    if (registry.cnt == 0) {
+        free(registry.items);
+        registry.items = NULL;
+        registry.alloc = 0;
+    }
+
+    pthread_mutex_unlock(&registry.lock);
+}
+
+/**
+ * \brief Append a formatted string to a buffer
+ * \param[in] buffer Buffer
+ * \param[in] fmt    Format string (see printf())
+ */
+static void
+buffer_printf(struct metrics_buffer *buffer, const char *fmt, ...)
+{
+    if (buffer->error) {
+        return;
+    }
+
+    while (true) {
+        const size_t free_size = buffer->alloc - buffer->len;
+        va_list args;
+        va_start(args, fmt);
+        int ret = vsnprintf(buffer->data + buffer->len, free_size, fmt, args);
+        va_end(args);
+
+        if (ret < 0) {
+            buffer->error = true;
+            return;
+        }
+        if ((size_t) ret < free_size) {
+            buffer->len += (size_t) ret;
+            return;
+        }
+
+        size_t alloc_new = (buffer->alloc > 0) ? buffer->alloc : 4096U;
+        while (alloc_new - buffer->len <= (size_t) ret) {
+            alloc_new *= 2;
+        }
+        char *data_new = realloc(buffer->data, alloc_new);
+        if (!data_new) {
+            buffer->error = true;
+            return;
+        }
+        buffer->data = data_new;
+        buffer->alloc = alloc_new;
+    }
+}
+
+/**
+ * \brief Append a string with escaped special characters to a buffer
+ *
+ * Backslashes and newlines are always escaped, double quotes only in label values.
+ * \param[in] buffer Buffer
+ * \param[in] str    String
+ * \param[in] label  The string is a label value
+ */
+static void
+buffer_escape(struct metrics_buffer *buffer, const char *str, bool label)
+{
+    const char *pos = str;
+    while (*pos != '\0') {
+        size_t len = strcspn(pos, label ? "\\\n\"" : "\\\n");
+        if (len > 0) {
+            buffer_printf(buffer, "%.*s", (int) len, pos);
+            pos += len;
+        }
+
+        switch (*pos) {
+        case '\\':
+            buffer_printf(buffer, "\\\\");
+            break;
+        case '\n':
+            buffer_printf(buffer, "\\n");
+            break;
+        case '"':
+            buffer_printf(buffer, "\\\"");
+            break;
+        default:
+            continue; // End of the string
+        }
+        pos++;
+    }
+}
+
+/**
+ * \brief Compare metrics by name and instance (for qsort())
+ */
+static int
+metrics_cmp(const void *lhs, const void *rhs)
+{
+    const struct metrics_entry *l = *(const struct metrics_entry * const *) lhs;
+    const struct metrics_entry *r = *(const struct metrics_entry * const *) rhs;
+    int ret = strcmp(l->name, r->name);
+    if (ret != 0) {
+        return ret;
+    }
+    return strcmp(ipx_ctx_name_get(l->owner), ipx_ctx_name_get(r->owner));
+}
+
+/**
+ * \brief Get the current value of a metric
+ * \param[in] entry Metric
+ * \return Value
+ */
+static inline uint64_t
+metrics_value(const struct metrics_entry *entry)
+{
+    if (entry->storage != NULL) {
+        return __atomic_load_n(&entry->storage->value, __ATOMIC_RELAXED);
+    }
+    return entry->cb(entry->cb_data);
+}
+
+char *
+ipx_metrics_format(size_t *size)
+{
+    struct metrics_buffer buffer = {NULL, 0, 0, false};
+    buffer_printf(&buffer, "%s", "");
+
+    pthread_mutex_lock(&registry.lock);
+    const struct metrics_entry **sorted = NULL;
+    if (registry.cnt > 0) {
+        sorted = malloc(registry.cnt * sizeof(*sorted));
+        if (!sorted) {
+            buffer.error = true;
+        }
+    }
+
+    if (sorted != NULL) {
+        for (size_t i = 0; i < registry.cnt; ++i) {
+            sorted[i] = &registry.items[i];
+        }
+        qsort(sorted, registry.cnt, sizeof(*sorted), &metrics_cmp);
+
+        const struct metrics_entry *prev = NULL;
+        for (size_t i = 0; i < registry.cnt; ++i) {
+            const struct metrics_entry *entry = sorted[i];
+            if (prev == NULL || strcmp(prev->name, entry->name) != 0) {
+                // The first sample of the metric
+                buffer_printf(&buffer, "# HELP " METRICS_PREFIX "%s ", entry->name);
+                buffer_escape(&buffer, entry->help, false);
+                buffer_printf(&buffer, "\n# TYPE " METRICS_PREFIX "%s %s\n", entry->name,
+                    (entry->type == IPX_METRIC_COUNTER) ? "counter" : "gauge");
+            }
+
+            // Sum values of all storages of the same metric and instance
+            uint64_t value = metrics_value(entry);
+            while (i + 1 < registry.cnt && metrics_cmp(&sorted[i], &sorted[i + 1]) == 0) {
+                value += metrics_value(sorted[++i]);
+            }
+
+            buffer_printf(&buffer, METRICS_PREFIX "%s{instance=\"", entry->name);
+            buffer_escape(&buffer, ipx_ctx_name_get(entry->owner), true);
+            buffer_printf(&buffer, "\"} %" PRIu64 "\n", value);
+            prev = entry;
+        }
+    }
+
+    pthread_mutex_unlock(&registry.lock);
+    free(sorted);
+
+    if (buffer.error) {
+        free(buffer.data);
+        return NULL;
+    }
+
+    *size = buffer.len;
+    return buffer.data;
+}
+
+/**
+ * \brief Send all data to a client
+ * \param[in] fd   Socket
+ * \param[in] data Data
+ * \param[in] len  Length of the data
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_DENIED if the connection has failed
+ */
+static int
+server_send(int fd, const char *data, size_t len)
+{
+    while (len > 0) {
+        ssize_t ret = send(fd, data, len, MSG_NOSIGNAL);
+        if (ret == -1 && errno == EINTR) {
+            continue;
+        }
+        if (ret <= 0) {
+            return IPX_ERR_DENIED;
+        }
+        data += ret;
+        len -= (size_t) ret;
+    }
+    return IPX_OK;
+}
+
+/**
+ * \brief Send an HTTP response to a client
+ * \param[in] fd     Socket
+ * \param[in] status Status line (e.g. "200 OK")
+ * \param[in] body   Body of the response
+ * \param[in] len    Length of the body
+ * \param[in] head   Send only headers (i.e. response to a HEAD request)
+ */
+static void
+server_respond(int fd, const char *status, const char *body, size_t len, bool head)
+{
+    char hdr[256];
+    int hdr_len = snprintf(hdr, sizeof(hdr), "HTTP/1.1 %s\r\n"
+        "Content-Type: text/plain; version=0.0.4; charset=utf-8\r\n"
+        "Content-Length: %zu\r\n"
+        "Connection: close\r\n\r\n", status, len);
+    if (hdr_len < 0 || (size_t) hdr_len >= sizeof(hdr)) {
+        return;
+    }
+
+    if (server_send(fd, hdr, (size_t) hdr_len) != IPX_OK || head) {
+        return;
+    }
+    server_send(fd, body, len);
+}
+
+/**
+ * \brief Process a request of a client
+ *
+ * Only "GET /metrics" (and "HEAD /metrics") requests are supported. The connection is closed
+ * after the response.
+ * \param[in] fd Socket of the client
+ */
+static void
+server_client(int fd)
+{
+    const struct timeval timeout = {METRICS_TIMEOUT, 0};
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+
+    // Receive the request headers (the body of the request is ignored)
+    char req[METRICS_REQ_SIZE];
+    size_t req_len = 0;
+    while (true) {
+        ssize_t ret = recv(fd, req + req_len, sizeof(req) - 1 - req_len, 0);
+        if (ret == -1 && errno == EINTR) {
+            continue;
+        }
+        if (ret <= 0) {
+            return;
+        }
+
+        req_len += (size_t) ret;
+        req[req_len] = '\0';
+        if (strstr(req, "\r\n\r\n") != NULL || strstr(req, "\n\n") != NULL) {
+            break;
+        }
+        if (req_len == sizeof(req) - 1) {
+            static const char msg[] = "Request is too long\n";
+            server_respond(fd, "431 Request Header Fields Too Large", msg, sizeof(msg) - 1,
+                false);
+            return;
+        }
+    }
+
+    // Parse the request line
+    char method[8];
+    char path[256];
+    if (sscanf(req, "%7s %255s", method, path) != 2) {
+        static const char msg[] = "Malformed request\n";
+        server_respond(fd, "400 Bad Request", msg, sizeof(msg) - 1, false);
+        return;
+    }
+
+    const bool head = (strcmp(method, "HEAD") == 0);
+    if (strcmp(method, "GET") != 0 && !head) {
+        static const char msg[] = "Method not allowed\n";
+        server_respond(fd, "405 Method Not Allowed", msg, sizeof(msg) - 1, false);
+        return;
+    }
+
+    const size_t path_len = strcspn(path, "?");
+    if (path_len != strlen("/metrics") || strncmp(path, "/metrics", path_len) != 0) {
+        static const char msg[] = "Metrics are available at /metrics\n";
+        server_respond(fd, "404 Not Found", msg, sizeof(msg) - 1, head);
+        return;
+    }
+
+    size_t body_len;
+    char *body = ipx_metrics_format(&body_len);
+    if (!body) {
+        static const char msg[] = "Memory allocation failed\n";
+        IPX_ERROR(module, "Memory allocation failed! (%s:%d)", __FILE__, __LINE__);
+        server_respond(fd, "500 Internal Server Error", msg, sizeof(msg) - 1, head);
+        return;
+    }
+
+    server_respond(fd, "200 OK", body, body_len, head);
+    free(body);
+}
+
+/**
+ * \brief Thread of the HTTP exporter
+ *
+ * Clients are served one by one until the thread is stopped (see ipx_metrics_server_stop()).
+ * \param[in] arg Unused
+ * \return Always NULL
+ */
+static void *
+server_thread(void *arg)
+{
+    (void) arg;
+    prctl(PR_SET_NAME, "metrics", 0, 0, 0);
+
+    struct pollfd fds[2] = {
+        {server.fd_listen, POLLIN, 0},
+        {server.fd_stop[0], POLLIN, 0}
+    };
+
+    while (true) {
+        int ret = poll(fds, 2, -1);
+        if (ret == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+
+            const char *err_str;
+            ipx_strerror(errno, err_str);
+            IPX_ERROR(module, "poll() failed: %s. The exporter has been stopped!", err_str);
+            break;
+        }
+
+        if (fds[1].revents != 0) {
+            // Stop request
+            break;
+        }
+        if ((fds[0].revents & POLLIN) == 0) {
+            continue;
+        }
+
+        int fd = accept4(server.fd_listen, NULL, NULL, SOCK_CLOEXEC);
+        if (fd == -1) {
+            const char *err_str;
+            ipx_strerror(errno, err_str);
+            IPX_WARNING(module, "Failed to accept a connection: %s", err_str);
+            continue;
+        }
+
+        server_client(fd);
+        close(fd);
+    }
+
+    return NULL;
+}
+
+/**
+ * \brief Parse an address of the exporter
+ * \param[in]  addr Address in the form "[ADDR:]PORT"
+ * \param[out] host Host part (empty, if not specified)
+ * \param[in]  size Size of the host buffer
+ * \param[out] port Port part
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_FORMAT if the address is not valid
+ */
+static int
+server_addr_parse(const char *addr, char *host, size_t size, uint16_t *port)
+{
+    const char *port_str = addr;
+    const char *host_end = NULL;
+    host[0] = '\0';
+
+    if (addr[0] == '[') {
+        // IPv6 address in square brackets
+        host_end = strchr(addr, ']');
+        if (!host_end || host_end[1] != ':') {
+            return IPX_ERR_FORMAT;
+        }
+        addr++;
+        port_str = host_end + 2;
+    } else if ((host_end = strchr(addr, ':')) != NULL) {
+        if (strchr(host_end + 1, ':') != NULL) {
+            // Multiple colons, i.e. an IPv6 address without brackets
+            return IPX_ERR_FORMAT;
+        }
+        port_str = host_end + 1;
+    }
+
+    if (host_end != NULL) {
+        const size_t host_len = (size_t) (host_end - addr);
+        if (host_len == 0 || host_len >= size) {
+            return IPX_ERR_FORMAT;
+        }
+        memcpy(host, addr, host_len);
+        host[host_len] = '\0';
+    }
+
+    char *end;
+    errno = 0;
+    unsigned long value = strtoul(port_str, &end, 10);
+    if (port_str[0] == '\0' || *end != '\0' || errno != 0 || value == 0 || value > UINT16_MAX) {
+        return IPX_ERR_FORMAT;
+    }
+
+    *port = (uint16_t) value;
+    return IPX_OK;
+}
+
+/**
+ * \brief Create a listening socket
+ * \param[in] host Host
+ * \param[in] port Port
+ * \param[in] dual Accept also IPv4 connections on an IPv6 socket
+ * \return Socket or -1 on failure
+ */
+static int
+server_listen(const char *host, uint16_t port, bool dual)
+{
+    char port_str[8];
+    snprintf(port_str, sizeof(port_str), "%" PRIu16, port);
+
+    struct addrinfo hints;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    hints.ai_flags = AI_PASSIVE;
+
+    struct addrinfo *res;
+    int rc = getaddrinfo(host, port_str, &hints, &res);
+    if (rc != 0) {
+        IPX_ERROR(module, "Failed to resolve address '%s': %s", host, gai_strerror(rc));
+        return -1;
+    }
+
+    int fd = -1;
+    for (struct addrinfo *ai = res; ai != NULL && fd == -1; ai = ai->ai_next) {
+        fd = socket(ai->ai_family, ai->ai_socktype | SOCK_CLOEXEC, ai->ai_protocol);
+        if (fd == -1) {
+            continue;
+        }
+
+        const int yes = 1;
+        const int no = 0;
+        setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &yes, sizeof(yes));
+        if (dual && ai->ai_family == AF_INET6) {
+            setsockopt(fd, IPPROTO_IPV6, IPV6_V6ONLY, &no, sizeof(no));
+        }
+
+        if (bind(fd, ai->ai_addr, ai->ai_addrlen) != 0 || listen(fd, 16) != 0) {
+            const char *err_str;
+            ipx_strerror(errno, err_str);
+            IPX_DEBUG(module, "Failed to listen on %s port %" PRIu16 ": %s", host, port,
+                err_str);
+            close(fd);
+            fd = -1;
+        }
+    }
+
+    freeaddrinfo(res);
+    return fd;
+}
+
+int
+ipx_metrics_server_start(const char *addr)
+{
+    if (server.running) {
+        IPX_ERROR(module, "The exporter is already running!", '\0');
+        return IPX_ERR_DENIED;
+    }
+
+    char host[256];
+    uint16_t port;
+    if (server_addr_parse(addr, host, sizeof(host), &port) != IPX_OK) {
+        IPX_ERROR(module, "Invalid address of the exporter '%s' (expected [ADDR:]PORT)!", addr);
+        return IPX_ERR_FORMAT;
+    }
+
+    if (host[0] != '\0') {
+        server.fd_listen = server_listen(host, port, false);
+    } else {
+        // All addresses (IPv4 only, if IPv6 is not available)
+        server.fd_listen = server_listen("::", port, true);
+        if (server.fd_listen == -1) {
+            server.fd_listen = server_listen("0.0.0.0", port, false);
+        }
+    }
+
+    if (server.fd_listen == -1) {
+        IPX_ERROR(module, "Failed to listen on '%s'!", addr);
+        return IPX_ERR_DENIED;
+    }
+
+    if (pipe2(server.fd_stop, O_CLOEXEC) != 0) {
+        const char *err_str;
+        ipx_strerror(errno, err_str);
+        IPX_ERROR(module, "pipe() failed: %s", err_str);
+        close(server.fd_listen);
+        server.fd_listen = -1;
+        return IPX_ERR_DENIED;
+    }
+
+    // The thread must not handle any signals
+    sigset_t set_new, set_old;
+    sigfillset(&set_new);
+    pthread_sigmask(SIG_SETMASK, &set_new, &set_old);
+    int rc = pthread_create(&server.thread, NULL, &server_thread, NULL);
+    pthread_sigmask(SIG_SETMASK, &set_old, NULL);
+
+    if (rc != 0) {
+        const char *err_str;
+        ipx_strerror(rc, err_str);
+        IPX_ERROR(module, "Failed to start the thread of the exporter: %s", err_str);
+        close(server.fd_stop[0]);
+        close(server.fd_stop[1]);
+        close(server.fd_listen);
+        server.fd_listen = -1;
+        return IPX_ERR_DENIED;
+    }
+
+    server.running = true;
+    IPX_INFO(module, "Metrics are available at http://%s%s%s:%" PRIu16 "/metrics",
+        (strchr(host, ':') != NULL) ? "[" : "", (host[0] != '\0') ? host : "*",
+        (strchr(host, ':') != NULL) ? "]" : "", port);
+    return IPX_OK;
+}
+
+void
+ipx_metrics_server_stop()
+{
+    if (!server.running) {
+        return;
+    }
+
+    const char stop = 'x';
+    while (write(server.fd_stop[1], &stop, 1) == -1 && errno == EINTR) {}
+    pthread_join(server.thread, NULL);
+
+    close(server.fd_stop[0]);
+    close(server.fd_stop[1]);
+    close(server.fd_listen);
+    server.fd_listen = -1;
+    server.running = false;
+}
@@ -0,0 +1,141 @@
+/**
+ * \file src/core/metrics.h
+ * \author agent <agent@local>
+ * \brief Runtime metrics of instances and their HTTP exporter (header file)
+ * \date 2026
+ */
+
+
+/* Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is'', and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#ifndef IPX_METRICS_H
+#define IPX_METRICS_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <ipfixcol2.h>
+#include <stdint.h>
+
+/**
+ * \defgroup ipx_metrics Runtime metrics
+ *
+ * \brief Registry of runtime metrics of instances and their export over HTTP
+ *
+ * Metrics are registered by plugins (see ipx_ctx_metric_register()) or by the collector itself
+ * (e.g. counters of messages and statistics of ring buffers). Each metric belongs to a plugin
+ * context and it is removed when the context is destroyed (see ipx_metrics_remove()).
+ *
+ * Values are read only when metrics are exported, i.e. when a scraper (e.g. Prometheus) asks
+ * for them. The exporter serves the Prometheus text format (version 0.0.4), which is also
+ * accepted by OpenMetrics scrapers.
+ *
+ * @{
+ */
+
+/**
+ * \brief Callback providing the current value of a metric
+ * \param[in] data Private data of the callback
+ * \return Value
+ */
+typedef uint64_t (*ipx_metrics_read_cb)(const void *data);
+
+/**
+ * \brief Register a metric with a value provided by a callback
+ *
+ * Intended for metrics of the collector with values stored elsewhere (e.g. in a ring buffer).
+ * The callback might be called by any thread until the metrics of the context are removed.
+ * \param[in] ctx  Plugin context (owner of the metric)
+ * \param[in] type Type of the metric
+ * \param[in] name Name of the metric
+ * \param[in] help Short description of the metric
+ * \param[in] cb   Callback providing the value
+ * \param[in] data Private data of the callback
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_FORMAT if the name is not valid or the metric has a different type
+ * \return #IPX_ERR_NOMEM in case of a memory allocation error
+ */
+IPX_API int
+ipx_metrics_add_cb(const ipx_ctx_t *ctx, enum ipx_metric_type type, const char *name,
+    const char *help, ipx_metrics_read_cb cb, const void *data);
+
+/**
+ * \brief Remove all metrics of a plugin context
+ *
+ * Storages of metrics registered by the plugin are freed.
+ * \warning Must be called when no thread of the instance can update the metrics anymore.
+ * \param[in] ctx Plugin context
+ */
+IPX_API void
+ipx_metrics_remove(const ipx_ctx_t *ctx);
+
+/**
+ * \brief Format all registered metrics in the Prometheus text format
+ *
+ * Values of the same metric and instance are summed.
+ * \param[out] size Length of the output (excluding the terminating null byte)
+ * \return Pointer to the output (must be freed by free()) or NULL (memory allocation error)
+ */
+IPX_API char *
+ipx_metrics_format(size_t *size);
+
+/**
+ * \brief Start the HTTP exporter of metrics
+ *
+ * The exporter runs in its own thread and serves "GET /metrics" requests.
+ * \param[in] addr Address to listen on in the form "[ADDR:]PORT" (IPv6 addresses must be
+ *   in square brackets, all addresses are used if ADDR is not specified)
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_FORMAT if the address is not valid
+ * \return #IPX_ERR_DENIED if the exporter cannot be started
+ */
+IPX_API int
+ipx_metrics_server_start(const char *addr);
+
+/**
+ * \brief Stop the HTTP exporter of metrics (if running)
+ */
+IPX_API void
+ipx_metrics_server_stop();
+
+/**
+ * @}
+ */
+
+#ifdef __cplusplus
+}
+#endif
+#endif // IPX_METRICS_H
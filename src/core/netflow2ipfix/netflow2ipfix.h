@@ -1,7 +1,7 @@
 /**
  * @file src/core/netflow2ipfix/netflow2ipfix.h
  * @author Lukas Hutak <lukas.hutak@cesnet.cz>
- * @brief Main NetFlow v5/v9 to IPFIX converter functions (header file)
+ * @brief Main NetFlow v5/v9 and sFlow v5 to IPFIX converter functions (header file)
  * @date 2018-2019
  *
  * Copyright(c) 2019 CESNET z.s.p.o.
@@ -11,6 +11,7 @@
 #ifndef IPFIXCOL2_NETFLOW2IPFIX_H
 #define IPFIXCOL2_NETFLOW2IPFIX_H
 
+#include <stdbool.h>
 #include <stdint.h>
 #include <stddef.h>
 #include <ipfixcol2.h>
@@ -93,6 +94,19 @@ ipx_nf5_conv_process(ipx_nf5_conv_t *conv, ipx_msg_ipfix_t *wrapper);
 void
 ipx_nf5_conv_verb(ipx_nf5_conv_t *conv, enum ipx_verb_level v_new);
 
+/**
+ * @brief Enable/disable conversion of Data records using SIMD instructions
+ *
+ * By default, SIMD instructions (AVX2) are used, if they are supported by the CPU. The result
+ * of the conversion is always the same, therefore, the function is useful only for testing and
+ * benchmarking.
+ * @param[in] conv   Message converter
+ * @param[in] enable Enable/disable
+ * @return True, if SIMD instructions are used. False, if they are disabled or not supported.
+ */
+bool
+ipx_nf5_conv_simd(ipx_nf5_conv_t *conv, bool enable);
+
 /**
  * @}
  */
@@ -178,6 +192,90 @@ ipx_nf9_conv_process(ipx_nf9_conv_t *conv, ipx_msg_ipfix_t *wrapper);
 void
 ipx_nf9_conv_verb(ipx_nf9_conv_t *conv, enum ipx_verb_level v_new);
 
+/**
+ * @}
+ */
+
+/**
+ * @defgroup sflow_to_ipfix sFlow v5 to IPFIX
+ * @brief Conversion from sFlow v5 Datagrams to IPFIX Messages
+ *
+ * The converter helps to convert a stream of sFlow Datagrams from combination of an sFlow
+ * agent and a sub-agent to stream of IPFIX Messages. Datagrams are processed individually and
+ * should be passed to the converter in the order send by the agent. If it is necessary to convert
+ * streams of multiple agents at time, you MUST create an independent instance for each stream.
+ *
+ * Each (expanded) flow sample is converted to a single IPFIX Data Record based on one of two
+ * predefined IPFIX Templates (IPv4 or IPv6 flow). Packet and octet counters are multiplied by the
+ * sampling rate and the sampling rate is also stored in the record. Flow samples without an IPv4
+ * or IPv6 packet and counter samples are ignored.
+ *
+ * @note
+ *   Since sFlow Datagrams don't contain absolute timestamps, the time of conversion is used as
+ *   Export Time of IPFIX Messages and as start and end timestamps of all converted flows.
+ *   Template refresh interval refers to the same time.
+ * @note
+ *   In the context of IPFIX protocol, the sub-agent ID is referred as Observation Domain ID (ODID)
+ *
+ * @{
+ */
+
+/// Auxiliary definition of sFlow v5 to IPFIX converter internals
+typedef struct ipx_sflow_conv ipx_sflow_conv_t;
+
+/**
+ * @brief Initialize sFlow v5 to IPFIX converter
+ *
+ * @param[in] ident         Instance identification (only for log messages!)
+ * @param[in] vlevel        Verbosity level of the converter (i.e. amount of log messages)
+ * @param[in] tmplt_refresh Template refresh interval (seconds, 0 == disabled)
+ * @param[in] odid          Observation Domain ID of IPFIX Messages (e.g. 0)
+ * @return Pointer to the converter or NULL (memory allocation error)
+ */
+ipx_sflow_conv_t *
+ipx_sflow_conv_init(const char *ident, enum ipx_verb_level vlevel, uint32_t tmplt_refresh,
+    uint32_t odid);
+
+/**
+ * @brief Destroy sFlow v5 to IPFIX converter
+ * @param[in] conv Converter to destroy
+ */
+void
+ipx_sflow_conv_destroy(ipx_sflow_conv_t *conv);
+
+/**
+ * @brief Convert sFlow v5 Datagram to IPFIX Message
+ *
+ * The function accepts a message wrapper @p wrapper that should hold an sFlow v5 Datagram.
+ * If the Datagram is successfully converted, a content of the wrapper is replaced with the IPFIX
+ * Message and the original Datagram is not accessible anymore and it is freed.
+ *
+ * @note
+ *   In case of an error (i.e. return code different from #IPX_OK) the original Datagram
+ *   in the wrapper is untouched.
+ * @note
+ *   Sequence numbers of IPFIX Messages are incremented independently on sFlow Datagrams to
+ *   convert and starts from 0. In other words, missing or reordered sFlow Datagrams don't
+ *   affect correctness of the IPFIX stream.
+ *
+ * @param[in] conv    Message converter
+ * @param[in] wrapper Message wrapper
+ * @return #IPX_OK on success
+ * @return #IPX_ERR_FORMAT in case of invalid sFlow Datagram format
+ * @return #IPX_ERR_NOMEM in case of a memory allocation error
+ */
+int
+ipx_sflow_conv_process(ipx_sflow_conv_t *conv, ipx_msg_ipfix_t *wrapper);
+
+/**
+ * @brief Change verbosity level
+ *
+ * @param[in] conv   Message converter
+ * @param[in] v_new  New verbosity level
+ */
+void
+ipx_sflow_conv_verb(ipx_sflow_conv_t *conv, enum ipx_verb_level v_new);
+
 /**
  * @}
  */
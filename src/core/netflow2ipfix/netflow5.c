@@ -23,6 +23,12 @@
 #include "../message_ipfix.h"
 #include "../verbose.h"
 
+#if defined(__x86_64__) && defined(__GNUC__)
+#include <immintrin.h>
+/// Conversion of Data records using AVX2 instructions is available (selected at runtime)
+#define NF5_CONV_AVX2 1
+#endif
+
 // Simple static asserts to prevent unexpected structure modifications!
 static_assert(IPX_NF5_MSG_HDR_LEN == 24U, "NetFlow v5 header size is not valid!");
 static_assert(IPX_NF5_MSG_REC_LEN == 48U, "NetFlow v5 record size is not valid!");
@@ -135,6 +141,27 @@ static_assert(PART2_LEN ==
     offsetof(struct new_ipx_rec, sampling_alg) - offsetof(struct new_ipx_rec, port_src),
     "Different Part 2 size");
 
+/// Sampling information of the new IPFIX Data Record (the same for all records of a message)
+struct __attribute__((__packed__)) nf5_sampling_info {
+    uint8_t alg;       ///< Sampling algorithm
+    uint8_t _pad;      ///< Padding
+    uint32_t interval; ///< Sampling interval
+};
+
+static_assert(sizeof(struct nf5_sampling_info) == sizeof(struct new_ipx_rec) - IPX_SAMPLING_OFFSET,
+    "Different sampling size");
+
+/**
+ * @brief Function converting NetFlow v5 Data records to IPFIX Data Records
+ * @param[out] ipx_rec Pointer to the first new IPFIX Data Record
+ * @param[in]  nf_rec  Pointer to the first NetFlow v5 Data Record
+ * @param[in]  rec_cnt Number of records to convert
+ * @param[in]  ts_base Base of relative timestamps (absolute exporter time minus SysUpTime)
+ * @param[in]  sinfo   Sampling information of all records
+ */
+typedef void (*nf5_conv_recs_fn)(uint8_t *ipx_rec, const uint8_t *nf_rec, uint16_t rec_cnt,
+    uint64_t ts_base, const struct nf5_sampling_info *sinfo);
+
 /**
  * @def CONV_ERROR
  * @brief Macro for printing an error message of a converter
@@ -224,8 +251,101 @@ struct ipx_nf5_conv {
         /// Size of converted data record
         size_t drec_size;
     } tmplt; ///< Template information
+
+    /// Converter of Data records (scalar or SIMD, see ipx_nf5_conv_simd())
+    nf5_conv_recs_fn recs_fn;
 };
 
+/**
+ * @brief Convert NetFlow v5 Data records to IPFIX Data Records (portable version)
+ * @see ::nf5_conv_recs_fn
+ */
+static void
+conv_recs_scalar(uint8_t *ipx_rec, const uint8_t *nf_rec, uint16_t rec_cnt, uint64_t ts_base,
+    const struct nf5_sampling_info *sinfo)
+{
+    for (uint16_t i = 0; i < rec_cnt; ++i) {
+        const struct ipx_nf5_rec *rec = (const struct ipx_nf5_rec *) nf_rec;
+        // New timestamps (in milliseconds)
+        uint64_t ts_start = htobe64(ts_base + ntohl(rec->ts_first));
+        uint64_t ts_end =   htobe64(ts_base + ntohl(rec->ts_last));
+
+        // Copy and extend the message record
+        memcpy(PART1_IPX_POS(ipx_rec), PART1_NF_POS(rec), PART1_LEN);
+        memcpy(ipx_rec + IPX_FIRST_OFFSET, &ts_start, sizeof(ts_start));
+        memcpy(ipx_rec + IPX_LAST_OFFSET, &ts_end, sizeof(ts_end));
+        memcpy(PART2_IPX_POS(ipx_rec), PART2_NF_POS(rec), PART2_LEN);
+        memcpy(ipx_rec + IPX_SAMPLING_OFFSET, sinfo, sizeof(*sinfo));
+
+        nf_rec += IPX_NF5_MSG_REC_LEN;
+        ipx_rec += sizeof(struct new_ipx_rec);
+    }
+}
+
+#ifdef NF5_CONV_AVX2
+/**
+ * @brief Convert NetFlow v5 Data records to IPFIX Data Records (AVX2 version)
+ *
+ * Each record is converted by a few unaligned loads and stores. Both timestamps are converted
+ * at once, i.e. byte swapped and zero extended by a single shuffle, rebased by a single addition
+ * and swapped back to network byte order. Fields that don't require any conversion are copied
+ * by wider stores which are partly overwritten later, therefore, stores must be performed in
+ * this order and they never exceed the new record.
+ * @see ::nf5_conv_recs_fn
+ */
+__attribute__((target("avx2")))
+static void
+conv_recs_avx2(uint8_t *ipx_rec, const uint8_t *nf_rec, uint16_t rec_cnt, uint64_t ts_base,
+    const struct nf5_sampling_info *sinfo)
+{
+    // 2x 32b timestamp (network byte order) -> 2x 64b (host byte order)
+    const __m128i ts_load = _mm_setr_epi8(3, 2, 1, 0, -1, -1, -1, -1, 7, 6, 5, 4, -1, -1, -1, -1);
+    // 2x 64b (host byte order) -> 2x 64b (network byte order)
+    const __m128i ts_store = _mm_setr_epi8(7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8);
+    const __m128i ts_add = _mm_set1_epi64x((long long) ts_base);
+
+    static_assert(IPX_FIRST_OFFSET == PART1_LEN, "Unexpected position of timestamps");
+    static_assert(IPX_LAST_OFFSET == IPX_FIRST_OFFSET + 8U, "Unexpected position of timestamps");
+    static_assert(PART1_LEN + 8U <= 32U, "Part 1 and timestamps must fit into 32 bytes");
+    static_assert(offsetof(struct new_ipx_rec, port_src) + 16U <= IPX_SAMPLING_OFFSET
+        + sizeof(struct nf5_sampling_info), "Part 2 must be followed by sampling info");
+
+    for (uint16_t i = 0; i < rec_cnt; ++i) {
+        // Part 1 (and timestamps which are overwritten)
+        __m256i part1 = _mm256_loadu_si256((const __m256i *) PART1_NF_POS(nf_rec));
+        _mm256_storeu_si256((__m256i *) PART1_IPX_POS(ipx_rec), part1);
+
+        // Timestamps
+        __m128i ts = _mm_loadl_epi64((const __m128i *) (nf_rec + PART1_LEN));
+        ts = _mm_add_epi64(_mm_shuffle_epi8(ts, ts_load), ts_add);
+        _mm_storeu_si128((__m128i *) (ipx_rec + IPX_FIRST_OFFSET), _mm_shuffle_epi8(ts, ts_store));
+
+        // Part 2 (and the tailing padding which is overwritten)
+        __m128i part2 = _mm_loadu_si128((const __m128i *) PART2_NF_POS(nf_rec));
+        _mm_storeu_si128((__m128i *) PART2_IPX_POS(ipx_rec), part2);
+        memcpy(ipx_rec + IPX_SAMPLING_OFFSET, sinfo, sizeof(*sinfo));
+
+        nf_rec += IPX_NF5_MSG_REC_LEN;
+        ipx_rec += sizeof(struct new_ipx_rec);
+    }
+}
+#endif
+
+bool
+ipx_nf5_conv_simd(ipx_nf5_conv_t *conv, bool enable)
+{
+    conv->recs_fn = &conv_recs_scalar;
+#ifdef NF5_CONV_AVX2
+    if (enable && __builtin_cpu_supports("avx2")) {
+        conv->recs_fn = &conv_recs_avx2;
+        return true;
+    }
+#else
+    (void) enable;
+#endif
+    return false;
+}
+
 
 ipx_nf5_conv_t *
 ipx_nf5_conv_init(const char *ident, enum ipx_verb_level vlevel, uint32_t tmplt_refresh,
@@ -278,6 +398,7 @@ ipx_nf5_conv_init(const char *ident, enum ipx_verb_level vlevel, uint32_t tmplt_
     res->conf.refresh = tmplt_refresh;
     res->conf.odid = odid;
     res->conf.vlevel = vlevel;
+    ipx_nf5_conv_simd(res, true);
     return res;
 }
 
@@ -416,12 +537,7 @@ conv_add_dset(const ipx_nf5_conv_t *conv, const uint8_t *nf_msg, uint8_t *ipx_da
     }
 
     // Prepare sampling information
-    struct __attribute__((__packed__)) sampling_info {
-        uint8_t alg;       ///< Sampling algorithm
-        uint8_t _pad;      ///< Padding
-        uint32_t interval; ///< Sampling interval
-    } sinfo;
-
+    struct nf5_sampling_info sinfo;
     const uint16_t sampling = ntohs(nf_hdr->sampling_interval);
     sinfo.alg = sampling >> 14U; // Only first 2 bits
     sinfo._pad = 0;
@@ -434,24 +550,9 @@ conv_add_dset(const ipx_nf5_conv_t *conv, const uint8_t *nf_msg, uint8_t *ipx_da
     ipx_dset->header.length = htons((uint16_t) dset_len);
 
     // Add all data records
-    uint8_t *ipx_rec = &ipx_dset->records[0];
-    for (uint16_t i = 0; i < rec_cnt; ++i, ipx_rec += conv->tmplt.drec_size) {
-        const struct ipx_nf5_rec *nf_rec = (const struct ipx_nf5_rec *)
-            (nf_msg + IPX_NF5_MSG_HDR_LEN + (i * IPX_NF5_MSG_REC_LEN));
-        // New timestamps (in milliseconds)
-        uint64_t ts_start = hdr_exp_time - (hdr_sys_time - ntohl(nf_rec->ts_first));
-        uint64_t ts_end =   hdr_exp_time - (hdr_sys_time - ntohl(nf_rec->ts_last));
-        uint64_t *ptr_first = (uint64_t *) (ipx_rec + IPX_FIRST_OFFSET);
-        uint64_t *ptr_last  = (uint64_t *) (ipx_rec + IPX_LAST_OFFSET);
-        struct sampling_info *ptr_sampling = (struct sampling_info *) (ipx_rec + IPX_SAMPLING_OFFSET);
-
-        // Copy and extend the message record
-        memcpy(PART1_IPX_POS(ipx_rec), PART1_NF_POS(nf_rec), PART1_LEN);
-        *ptr_first = htobe64(ts_start);
-        *ptr_last  = htobe64(ts_end);
-        memcpy(PART2_IPX_POS(ipx_rec), PART2_NF_POS(nf_rec), PART2_LEN);
-        *ptr_sampling = sinfo;
-    }
+    assert(conv->tmplt.drec_size == sizeof(struct new_ipx_rec));
+    const uint64_t ts_base = hdr_exp_time - hdr_sys_time;
+    conv->recs_fn(&ipx_dset->records[0], nf_msg + IPX_NF5_MSG_HDR_LEN, rec_cnt, ts_base, &sinfo);
 
     return (ipx_data + dset_len);
 }
@@ -521,7 +622,7 @@ ipx_nf5_conv_process(ipx_nf5_conv_t *conv, ipx_msg_ipfix_t *wrapper)
     }
 
     const uint8_t *nf5_msg = wrapper->raw_pkt;
-    uint8_t *ipx_msg = malloc(ipx_size * sizeof(uint8_t));
+    uint8_t *ipx_msg = ipx_utils_buf_alloc(ipx_size * sizeof(uint8_t));
     if (!ipx_msg) {
         CONV_ERROR(conv, "A memory allocation failed (%s:%d).", __FILE__, __LINE__);
         return IPX_ERR_NOMEM;
@@ -542,7 +643,7 @@ ipx_nf5_conv_process(ipx_nf5_conv_t *conv, ipx_msg_ipfix_t *wrapper)
 
     // Finally, replace the converted NetFlow Message with the new IPFIX Message
     assert(next_set == (ipx_msg + ipx_size));
-    free(wrapper->raw_pkt);
+    ipx_utils_buf_free(wrapper->raw_pkt);
     wrapper->raw_pkt = ipx_msg;
     wrapper->raw_size = (uint16_t) ipx_size;
     return IPX_OK;
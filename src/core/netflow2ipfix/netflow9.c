@@ -37,6 +37,12 @@
  *   The length represents maximum IPFIX Message size without IPFIX Message header and
  *   IPFIX Set header size
  */
+/// Number of converted messages after which the estimation of their size is refreshed
+#define SIZE_EST_WINDOW (64U)
+/// Default ratio of sizes of a converted and an original message (fixed point, 8 fractional bits)
+#define SIZE_EST_RATIO_DEF (384U)
+/// Maximum ratio of sizes of a converted and an original message (fixed point, 8 fractional bits)
+#define SIZE_EST_RATIO_MAX (1024U)
 #define MAX_SET_CONTENT_LEN \
     (UINT16_MAX - FDS_IPFIX_MSG_HDR_LEN - FDS_IPFIX_SET_HDR_LEN)
 
@@ -108,9 +114,9 @@ struct nf2ipx_data {
  */
 static const struct nf2ipx_data nf2ipx_data_table[] = {
     // Conversion from relative to absolute TS: "LAST_SWITCHED"  -> iana:flowEndMilliseconds
-    {{IPX_NF9_IE_LAST_SWITCHED,  4U}, {153U, 0U, 8U}, {NF2IPX_ITYPE_TS, 8U}},
+    {{IPX_NF9_IE_LAST_SWITCHED,  4U}, {153U, 0U, 8U}, {NF2IPX_ITYPE_TS, 8U, 0U, 0U}},
     // Conversion from relative to absolute TS: "FIRST_SWITCHED" -> iana:flowStartMilliseconds
-    {{IPX_NF9_IE_FIRST_SWITCHED, 4U}, {152U, 0U, 8U}, {NF2IPX_ITYPE_TS, 8U}}
+    {{IPX_NF9_IE_FIRST_SWITCHED, 4U}, {152U, 0U, 8U}, {NF2IPX_ITYPE_TS, 8U, 0U, 0U}}
 };
 
 /// Number of record the the Data conversion table */
@@ -147,6 +153,15 @@ struct ipx_nf9_conv {
         uint16_t drecs_converted;
     } data; ///< Data of currently converted messages
 
+    struct {
+        /// The highest ratio of sizes in the current window (fixed point, 8 fractional bits)
+        uint32_t ratio_now;
+        /// The highest ratio of sizes in the previous window (fixed point, 8 fractional bits)
+        uint32_t ratio_prev;
+        /// Number of messages in the current window
+        uint32_t cnt;
+    } size_est; ///< Estimation of the size of converted messages
+
     /// Template lookup table - 2-level table  (256 x 256)
     struct tmplts_l1_table l1_table;
 };
@@ -224,6 +239,7 @@ ipx_nf9_conv_init(const char *ident, enum ipx_verb_level vlevel)
     }
 
     res->vlevel = vlevel;
+    res->size_est.ratio_prev = SIZE_EST_RATIO_DEF;
     return res;
 }
 
@@ -258,7 +274,7 @@ conv_mem_init(ipx_nf9_conv_t *conv)
 static inline void
 conv_mem_destroy(ipx_nf9_conv_t *conv)
 {
-    free(conv->data.ipx_msg);
+    ipx_utils_buf_free(conv->data.ipx_msg);
     conv->data.ipx_msg = NULL;
 }
 
@@ -297,12 +313,15 @@ conv_mem_reserve(ipx_nf9_conv_t *conv, size_t size)
         return IPX_OK;
     }
 
-    // Reallocate - use multiples of 1024 to avoid too many reallocations
+    // Reallocate - at least double the size and use multiples of 1024 to avoid too many reallocations
     size_t new_alloc = conv->data.ipx_size_used + size;
+    if (new_alloc < 2 * conv->data.ipx_size_alloc) {
+        new_alloc = 2 * conv->data.ipx_size_alloc;
+    }
     new_alloc /= 1024U;
     new_alloc += 1U;
     new_alloc *= 1024U;
-    uint8_t *new_msg = realloc(conv->data.ipx_msg, new_alloc * sizeof(uint8_t));
+    uint8_t *new_msg = ipx_utils_buf_realloc(conv->data.ipx_msg, new_alloc * sizeof(uint8_t));
     if (!new_msg) {
         return IPX_ERR_NOMEM;
     }
@@ -395,6 +414,55 @@ conv_mem_pos_set(ipx_nf9_conv_t *conv, size_t offset)
     assert(conv->data.ipx_size_used <= conv->data.ipx_size_alloc);
 }
 
+/**
+ * @brief Estimate the size of an IPFIX Message converted from a NetFlow Message
+ *
+ * The estimation is based on the highest ratio of sizes of converted and original messages
+ * observed in the current and the previous window of messages. Therefore, the buffer of the
+ * new IPFIX Message is usually allocated only once and never reallocated during conversion.
+ * @param[in] conv    Converter internals
+ * @param[in] nf_size Size of the NetFlow Message
+ * @return Estimated size
+ */
+static inline size_t
+conv_size_estimate(const ipx_nf9_conv_t *conv, uint16_t nf_size)
+{
+    uint32_t ratio = conv->size_est.ratio_prev;
+    if (ratio < conv->size_est.ratio_now) {
+        ratio = conv->size_est.ratio_now;
+    }
+
+    return (((size_t) nf_size * ratio) >> 8) + FDS_IPFIX_SET_HDR_LEN;
+}
+
+/**
+ * @brief Update the estimation of the size of converted IPFIX Messages
+ * @param[in] conv     Converter internals
+ * @param[in] nf_size  Size of the NetFlow Message
+ * @param[in] ipx_size Size of the converted IPFIX Message
+ */
+static inline void
+conv_size_update(ipx_nf9_conv_t *conv, uint16_t nf_size, size_t ipx_size)
+{
+    uint32_t ratio = (uint32_t) ((ipx_size << 8) / nf_size) + 1U;
+    if (ratio > SIZE_EST_RATIO_MAX) {
+        ratio = SIZE_EST_RATIO_MAX;
+    }
+
+    if (conv->size_est.ratio_now < ratio) {
+        conv->size_est.ratio_now = ratio;
+    }
+
+    if (++conv->size_est.cnt < SIZE_EST_WINDOW) {
+        return;
+    }
+
+    // Start a new window (the old one is used until the new one is complete)
+    conv->size_est.ratio_prev = conv->size_est.ratio_now;
+    conv->size_est.ratio_now = 0;
+    conv->size_est.cnt = 0;
+}
+
 // -----------------------------------------------------------------------------------------
 
 /**
@@ -787,6 +855,9 @@ conv_tmplt_from_data(ipx_nf9_conv_t *conv, const struct ipx_nf9_tset_iter *it, u
         return IPX_ERR_DENIED;
     }
 
+    // Prepare conversion instructions of Data records
+    nf9_trec_compile(template);
+
     // Insert the template to the internal table
     if (nf9_tmplts_insert(&conv->l1_table, tid, template) != IPX_OK) {
         CONV_ERROR(conv, "A memory allocation failed (%s:%d).", __FILE__, __LINE__);
@@ -923,72 +994,92 @@ conv_process_tset(ipx_nf9_conv_t *conv, const struct ipx_nf9_set_hdr *flowset_hd
 }
 
 /**
- * @brief Convert (NetFlow) relative timestamp to absolute timestamp
- * @param[in] hdr   NetFlow Message header (required for an exporter timestamps)
- * @param[in] nf_ts Relative NetFlow timestamp stored in a Data record (in Network byte order)
- * @return Converted absolute timestamp (Unix timestamp in milliseconds) (in Host byte order)
+ * @brief Get a base of (NetFlow) relative timestamps of a NetFlow Message
+ *
+ * Absolute timestamp (Unix timestamp in milliseconds) is the sum of the base and a relative
+ * timestamp stored in a Data record.
+ * @param[in] hdr NetFlow Message header (required for an exporter timestamps)
+ * @return Base of relative timestamps (in Host byte order)
  */
 static inline uint64_t
-conv_ts_rel2abs(const struct ipx_nf9_msg_hdr *hdr, const uint32_t *nf_ts)
+conv_ts_base(const struct ipx_nf9_msg_hdr *hdr)
 {
     const uint64_t hdr_exp = ntohl(hdr->unix_sec) * 1000ULL;
     const uint64_t hdr_sys = ntohl(hdr->sys_uptime);
-    const uint64_t rec_sys = ntohl(*nf_ts);
-    return (hdr_exp - hdr_sys) + rec_sys;
+    return hdr_exp - hdr_sys;
 }
 
 /**
- * @brief Convert a NetFlow data record to IPFIX Data record
+ * @brief Convert NetFlow data records to IPFIX Data records
  *
  * The function executes instructions described in the internal Template record to perform Data
- * record conversion. After conversion the IPFIX Data record is appended to the new IPFIX Message.
+ * record conversion. After conversion the IPFIX Data records are appended to the new IPFIX
+ * Message. Memory for all records is reserved at once and if the records don't require any
+ * conversion (see nf9_trec_compile()), they are copied at once too.
  * @param[in] conv    Converter internals
  * @param[in] nf9_msg NetFlow Message header (necessary for timestamp conversion)
- * @param[in] nf9_rec NetFlow Data record to convert
+ * @param[in] nf9_rec The first NetFlow Data record to convert (others follow immediately)
+ * @param[in] rec_cnt Number of NetFlow Data records to convert
  * @param[in] tmplt   Internal template record with conversion instructions
  * @return #IPX_OK on success
  * @return #IPX_ERR_NOMEM in case of a memory allocation error
  */
 static inline int
-conv_process_drec(ipx_nf9_conv_t *conv, const struct ipx_nf9_msg_hdr *nf9_msg,
-    const uint8_t *nf9_rec, const struct nf9_trec *tmplt)
+conv_process_drecs(ipx_nf9_conv_t *conv, const struct ipx_nf9_msg_hdr *nf9_msg,
+    const uint8_t *nf9_rec, uint16_t rec_cnt, const struct nf9_trec *tmplt)
 {
     assert(tmplt->action == REC_ACT_CONVERT);
     assert(tmplt->instr_size > 0);
 
-    // Reserve enough memory for converted IPFIX record
-    if (conv_mem_reserve(conv, tmplt->ipx_drec_len) != IPX_OK) {
+    // Reserve enough memory for converted IPFIX records
+    const size_t ipx_size = (size_t) rec_cnt * tmplt->ipx_drec_len;
+    if (conv_mem_reserve(conv, ipx_size) != IPX_OK) {
         CONV_ERROR(conv, "A memory allocation failed (%s:%d).", __FILE__, __LINE__);
         return IPX_ERR_NOMEM;
     }
 
+    uint8_t *ipx_rec = conv_mem_ptr_now(conv);
+    if (tmplt->plain_copy) {
+        // Records are the same in NetFlow and IPFIX
+        memcpy(ipx_rec, nf9_rec, ipx_size);
+        conv_mem_commit(conv, ipx_size);
+        return IPX_OK;
+    }
+
     // Execute conversion instructions
-    const uint8_t *nf9_pos = nf9_rec;
-    uint8_t *ipx_pos = conv_mem_ptr_now(conv);
-
-    for (size_t i = 0; i < tmplt->instr_size; ++i) {
-        const struct nf2ipx_instr *instr = &tmplt->instr_data[i];
-        switch (instr->itype) {
-        case NF2IPX_ITYPE_CPY:
-            // Just copy memory
-            memcpy(ipx_pos, nf9_pos, instr->size);
-            nf9_pos += instr->size;
-            ipx_pos += instr->size;
-            break;
-        case NF2IPX_ITYPE_TS:
-            // Convert relative timestamp to absolute timestamp
-            *((uint64_t *) ipx_pos) = htobe64(conv_ts_rel2abs(nf9_msg, (uint32_t *) nf9_pos));
-            nf9_pos += 4U; // NetFlow TS (FIRST_SWITCHED/LAST_SWITCHED)
-            ipx_pos += 8U; // IPFIX TS (iana:flowStartMilliseconds/flowEndMilliseconds)
-            break;
-        default:
-            CONV_ERROR(conv, "(internal) Invalid NetFlow-to-IPFIX conversion instruction", '\0');
-            return IPX_ERR_NOMEM; // This will start component termination
+    const uint64_t ts_base = conv_ts_base(nf9_msg);
+    for (uint16_t rec = 0; rec < rec_cnt; ++rec) {
+        for (size_t i = 0; i < tmplt->instr_size; ++i) {
+            const struct nf2ipx_instr *instr = &tmplt->instr_data[i];
+            const uint8_t *nf9_pos = nf9_rec + instr->nf9_offset;
+            uint8_t *ipx_pos = ipx_rec + instr->ipx_offset;
+            uint32_t ts_rel;
+            uint64_t ts_abs;
+
+            switch (instr->itype) {
+            case NF2IPX_ITYPE_CPY:
+                // Just copy memory
+                memcpy(ipx_pos, nf9_pos, instr->size);
+                break;
+            case NF2IPX_ITYPE_TS:
+                // Convert relative timestamp to absolute timestamp
+                memcpy(&ts_rel, nf9_pos, sizeof(ts_rel));
+                ts_abs = htobe64(ts_base + ntohl(ts_rel));
+                memcpy(ipx_pos, &ts_abs, sizeof(ts_abs));
+                break;
+            default:
+                CONV_ERROR(conv, "(internal) Invalid NetFlow-to-IPFIX conversion instruction",
+                    '\0');
+                return IPX_ERR_NOMEM; // This will start component termination
+            }
         }
+
+        nf9_rec += tmplt->nf9_drec_len;
+        ipx_rec += tmplt->ipx_drec_len;
     }
 
     // Commit written memory
-    conv_mem_commit(conv, tmplt->ipx_drec_len);
+    conv_mem_commit(conv, ipx_size);
     return IPX_OK;
 }
 
@@ -1041,28 +1132,23 @@ conv_process_dset(ipx_nf9_conv_t *conv, const struct ipx_nf9_set_hdr *flowset_hd
     size_t hdr_offset = conv_mem_pos_get(conv);
     conv_mem_commit(conv, FDS_IPFIX_SET_HDR_LEN);
 
-    // Convert all records in the Data Set
-    uint16_t rec_processed = 0;
+    // Check the Data Set and convert all its records (the rest is padding)
     struct ipx_nf9_dset_iter it;
     ipx_nf9_dset_iter_init(&it, flowset_hdr, tmplt->nf9_drec_len);
-    int rc_conv = IPX_OK;
-    int rc_iter;
-
-    while (rc_conv == IPX_OK && (rc_iter = ipx_nf9_dset_iter_next(&it)) == IPX_OK) {
-        rec_processed++;
-        rc_conv = conv_process_drec(conv, nf9_hdr, it.rec, tmplt);
+    int rc_iter = ipx_nf9_dset_iter_next(&it);
+    if (rc_iter != IPX_OK) {
+        CONV_ERROR(conv, "%s", ipx_nf9_dset_iter_err(&it));
+        return rc_iter;
     }
 
+    uint16_t data_size = ntohs(flowset_hdr->length) - IPX_NF9_SET_HDR_LEN;
+    uint16_t rec_processed = data_size / tmplt->nf9_drec_len;
+    int rc_conv = conv_process_drecs(conv, nf9_hdr, it.rec, rec_processed, tmplt);
     if (rc_conv != IPX_OK) {
         // Converter failed (a proper error message has been already printed)
         return rc_conv;
     }
 
-    if (rc_iter != IPX_EOC) {
-        CONV_ERROR(conv, "%s", ipx_nf9_dset_iter_err(&it));
-        return rc_iter;
-    }
-
     // Update number of processed records
     conv->data.recs_processed += rec_processed;
     conv->data.drecs_converted += rec_processed;
@@ -1229,6 +1315,12 @@ ipx_nf9_conv_process(ipx_nf9_conv_t *conv, ipx_msg_ipfix_t *wrapper)
         ++conv->nf9_seq_next;
     }
 
+    // Allocate the new IPFIX Message at once (based on sizes of previously converted messages)
+    if (conv_mem_reserve(conv, conv_size_estimate(conv, nf9_size)) != IPX_OK) {
+        CONV_ERROR(conv, "A memory allocation failed (%s:%d).", __FILE__, __LINE__);
+        return IPX_ERR_NOMEM;
+    }
+
     // Convert the message
     rc = conv_process_msg(conv, nf9_hdr, nf9_size);
     if (rc != IPX_OK) {
@@ -1262,9 +1354,10 @@ ipx_nf9_conv_process(ipx_nf9_conv_t *conv, ipx_msg_ipfix_t *wrapper)
     ipx_ptr->odid = nf9_hdr->source_id;
     // Update sequence number of the new IPFIX Message
     conv->ipx_seq_next += conv->data.drecs_converted;
+    conv_size_update(conv, nf9_size, ipx_size);
 
     // Finally, replace the converted NetFlow Message with the new IPFIX Message
-    free(wrapper->raw_pkt);
+    ipx_utils_buf_free(wrapper->raw_pkt);
     wrapper->raw_pkt = conv_mem_release(conv);
     wrapper->raw_size = (uint16_t) ipx_size;
     return IPX_OK;
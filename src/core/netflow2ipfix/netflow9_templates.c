@@ -8,6 +8,7 @@
  * SPDX-License-Identifier: BSD-3-Clause
  */
 
+#include <assert.h>
 #include <stddef.h> // offsetof
 #include <stdlib.h>
 
@@ -152,4 +153,35 @@ nf9_trec_instr_add(struct nf9_trec **ptr, struct nf2ipx_instr instr)
 
     rec->instr_data[rec->instr_size++] = instr;
     return IPX_OK;
+}
+
+void
+nf9_trec_compile(struct nf9_trec *rec)
+{
+    size_t nf9_offset = 0;
+    size_t ipx_offset = 0;
+
+    for (size_t i = 0; i < rec->instr_size; ++i) {
+        struct nf2ipx_instr *instr = &rec->instr_data[i];
+        instr->nf9_offset = (uint16_t) nf9_offset;
+        instr->ipx_offset = (uint16_t) ipx_offset;
+
+        switch (instr->itype) {
+        case NF2IPX_ITYPE_CPY:
+            nf9_offset += instr->size;
+            ipx_offset += instr->size;
+            break;
+        case NF2IPX_ITYPE_TS:
+            nf9_offset += 4U; // NetFlow TS (FIRST_SWITCHED/LAST_SWITCHED)
+            ipx_offset += 8U; // IPFIX TS (iana:flowStartMilliseconds/flowEndMilliseconds)
+            break;
+        default:
+            assert(false && "Invalid NetFlow-to-IPFIX conversion instruction");
+            break;
+        }
+    }
+
+    assert(nf9_offset == rec->nf9_drec_len);
+    assert(ipx_offset == rec->ipx_drec_len);
+    rec->plain_copy = (rec->instr_size == 1 && rec->instr_data[0].itype == NF2IPX_ITYPE_CPY);
 }
\ No newline at end of file
@@ -11,6 +11,7 @@
 #ifndef IPFIXCOL2_NETFLOW9_TEMPLATES_H
 #define IPFIXCOL2_NETFLOW9_TEMPLATES_H
 
+#include <stdbool.h>
 #include <stdint.h>
 #include <stddef.h>
 
@@ -34,6 +35,12 @@ struct nf2ipx_instr {
     enum NF2IPX_ITYPE itype;
     /// Size of used memory after conversion (in bytes)
     size_t size;
+
+    // --- Note: following fields are filled by nf9_trec_compile() ---
+    /// Offset of the input in the original NetFlow record
+    uint16_t nf9_offset;
+    /// Offset of the output in the converted IPFIX record
+    uint16_t ipx_offset;
 };
 
 /// Template record action
@@ -88,6 +95,11 @@ struct nf9_trec {
     uint16_t ipx_drec_len;
 
     // --- Note: following fields are filled automatically  ---
+    /**
+     * Data records can be converted by a single copy (i.e. only one ::NF2IPX_ITYPE_CPY
+     * instruction) and consecutive records can be copied at once (see nf9_trec_compile())
+     */
+    bool plain_copy;
     /// Number of pre-allocated instructions
     size_t instr_alloc;
     /// Number of valid instructions
@@ -191,4 +203,15 @@ nf9_trec_destroy(struct nf9_trec *rec);
 int
 nf9_trec_instr_add(struct nf9_trec **ptr, struct nf2ipx_instr instr);
 
+/**
+ * @brief Prepare conversion instructions of a Template record for execution
+ *
+ * Offsets of inputs and outputs of all instructions within NetFlow and IPFIX records are
+ * precomputed, so they can be executed in any order and don't depend on each other.
+ * @note Call the function after all instructions have been added.
+ * @param[in] rec Template record
+ */
+void
+nf9_trec_compile(struct nf9_trec *rec);
+
 #endif //IPFIXCOL2_NETFLOW9_TEMPLATES_H
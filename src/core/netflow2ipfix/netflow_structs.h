@@ -1,7 +1,7 @@
 /**
  * @file src/core/netflow2ipfix/netflow_structs.h
  * @author Lukas Hutak <lukas.hutak@cesnet.cz>
- * @brief NetFlow v5/v9 structures
+ * @brief NetFlow v5/v9 and sFlow v5 structures
  * @date 2018-2019
  *
  * Copyright(c) 2019 CESNET z.s.p.o.
@@ -508,6 +508,75 @@ struct __attribute__((__packed__)) ipx_nf9_dset {
 /// Layer 2 packet section data.
 #define IPX_NF9_IE_L2_PACKET_SECTION_DATA 104U
 
+// ------------------------------------------------------------------------------------------------
+
+/*
+ * sFlow v5 Datagram structures (see https://sflow.org/sflow_version_5.txt)
+ *
+ * All structures are encoded using XDR (i.e. all values are aligned to 4 bytes and stored in
+ * Network Byte Order). Since the Datagram header contains an address of variable length and
+ * all samples and flow records are of variable length too, only identifiers and sizes of
+ * fixed parts are defined here.
+ */
+
+/// sFlow version number (the version is encoded as a 32-bit value!)
+#define IPX_SFLOW_VERSION 0x5
+/// Minimal size of sFlow v5 Datagram header (with an IPv4 agent address)
+#define IPX_SFLOW_MSG_HDR_LEN_MIN 28U
+/// Size of sFlow v5 Datagram header (with an IPv6 agent address)
+#define IPX_SFLOW_MSG_HDR_LEN_MAX 40U
+
+/// Type of an agent address
+enum ipx_sflow_addr_type {
+    IPX_SFLOW_ADDR_UNKNOWN = 0, ///< Unknown address (no address)
+    IPX_SFLOW_ADDR_IPV4    = 1, ///< IPv4 address
+    IPX_SFLOW_ADDR_IPV6    = 2  ///< IPv6 address
+};
+
+/// Get enterprise number of a data format of samples and flow records
+#define IPX_SFLOW_FMT_EN(fmt) ((fmt) >> 12)
+/// Get format number of a data format of samples and flow records
+#define IPX_SFLOW_FMT_ID(fmt) ((fmt) & 0xFFFU)
+
+/// Standard sample formats (enterprise 0)
+enum ipx_sflow_sample_fmt {
+    IPX_SFLOW_SAMPLE_FLOW       = 1, ///< Flow sample
+    IPX_SFLOW_SAMPLE_CNTR       = 2, ///< Counter sample
+    IPX_SFLOW_SAMPLE_FLOW_EXP   = 3, ///< Expanded flow sample
+    IPX_SFLOW_SAMPLE_CNTR_EXP   = 4  ///< Expanded counter sample
+};
+
+/// Standard flow record formats (enterprise 0)
+enum ipx_sflow_flow_fmt {
+    IPX_SFLOW_FLOW_HEADER       = 1,   ///< Raw packet header
+    IPX_SFLOW_FLOW_ETHERNET     = 2,   ///< Ethernet frame data
+    IPX_SFLOW_FLOW_IPV4         = 3,   ///< IPv4 data
+    IPX_SFLOW_FLOW_IPV6         = 4,   ///< IPv6 data
+    IPX_SFLOW_FLOW_EXT_SWITCH   = 1001 ///< Extended switch data
+};
+
+/// Header protocols of the raw packet header
+enum ipx_sflow_hdr_proto {
+    IPX_SFLOW_HDR_ETHERNET      = 1,  ///< Ethernet (ISO 8802-3)
+    IPX_SFLOW_HDR_IPV4          = 11, ///< IPv4
+    IPX_SFLOW_HDR_IPV6          = 12  ///< IPv6
+};
+
+/// Size of the fixed part of a flow sample (up to the number of flow records)
+#define IPX_SFLOW_FLOW_LEN 32U
+/// Size of the fixed part of an expanded flow sample (up to the number of flow records)
+#define IPX_SFLOW_FLOW_EXP_LEN 44U
+/// Size of the fixed part of a raw packet header record (without the header)
+#define IPX_SFLOW_HEADER_LEN 16U
+/// Size of the Ethernet frame data record
+#define IPX_SFLOW_ETHERNET_LEN 24U
+/// Size of the IPv4 data record
+#define IPX_SFLOW_IPV4_LEN 32U
+/// Size of the IPv6 data record
+#define IPX_SFLOW_IPV6_LEN 56U
+/// Size of the extended switch data record
+#define IPX_SFLOW_EXT_SWITCH_LEN 16U
+
 #ifdef __cplusplus
 }
 #endif
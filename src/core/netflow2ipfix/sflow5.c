@@ -0,0 +1,965 @@
+/**
+ * @file src/core/netflow2ipfix/sflow5.c
+ * @author agent <agent@local>
+ * @brief Converter from sFlow v5 Datagram to IPFIX Message (source code)
+ * @date 2026
+ *
+ * Copyright(c) 2026 CESNET z.s.p.o.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <endian.h>
+#include <arpa/inet.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <assert.h>
+#include <inttypes.h>
+
+#include <ipfixcol2.h>
+#include <libfds.h>
+#include "netflow_structs.h"
+#include "netflow2ipfix.h"
+#include "../message_ipfix.h"
+#include "../verbose.h"
+
+/// Auxiliary definition to represent size of 1 byte
+#define BYTES_1 (1U)
+/// Auxiliary definition to represent size of 2 bytes
+#define BYTES_2 (2U)
+/// Auxiliary definition to represent size of 4 bytes
+#define BYTES_4 (4U)
+/// Auxiliary definition to represent size of 6 bytes
+#define BYTES_6 (6U)
+/// Auxiliary definition to represent size of 8 bytes
+#define BYTES_8 (8U)
+/// Auxiliary definition to represent size of 16 bytes
+#define BYTES_16 (16U)
+
+/// Template ID of converted IPv4 flows
+#define SFLOW_TID_IPV4 (FDS_IPFIX_SET_MIN_DSET)
+/// Template ID of converted IPv6 flows
+#define SFLOW_TID_IPV6 (FDS_IPFIX_SET_MIN_DSET + 1U)
+/// Number of fields in each Template
+#define SFLOW_FIELD_CNT (18U)
+/// Value of iana:samplingAlgorithm (random sampling)
+#define SFLOW_SAMPLING_RANDOM (2U)
+
+/// Ethernet type of IPv4
+#define ETH_TYPE_IPV4 (0x0800U)
+/// Ethernet type of IPv6
+#define ETH_TYPE_IPV6 (0x86DDU)
+/// Ethernet type of IEEE 802.1Q VLAN tag
+#define ETH_TYPE_VLAN (0x8100U)
+/// Ethernet type of IEEE 802.1ad VLAN tag
+#define ETH_TYPE_QINQ (0x88A8U)
+
+/**
+ * @brief IPFIX Template Set of converted sFlow flow samples
+ *
+ * The set consists of Template Set header and two Template definitions (IPv4 and IPv6 flows)
+ * which differ only in IP addresses.
+ * @note
+ *   All values are in "host byte order" and MUST be converted to "network byte order" before
+ *   they can be used!
+ */
+static const uint16_t sflow_tmpl_set[] = {
+    // IPFIX Set header (size will be filled later)
+    FDS_IPFIX_SET_TMPLT, 0,
+    // IPFIX Template header (IPv4 flows)
+    SFLOW_TID_IPV4, SFLOW_FIELD_CNT,
+    8U,   BYTES_4,  // iana:sourceIPv4Address
+    12U,  BYTES_4,  // iana:destinationIPv4Address
+    10U,  BYTES_4,  // iana:ingressInterface
+    14U,  BYTES_4,  // iana:egressInterface
+    2U,   BYTES_8,  // iana:packetDeltaCount
+    1U,   BYTES_8,  // iana:octetDeltaCount
+    152U, BYTES_8,  // iana:flowStartMilliseconds
+    153U, BYTES_8,  // iana:flowEndMilliseconds
+    7U,   BYTES_2,  // iana:sourceTransportPort
+    11U,  BYTES_2,  // iana:destinationTransportPort
+    6U,   BYTES_1,  // iana:tcpControlBits
+    4U,   BYTES_1,  // iana:protocolIdentifier
+    5U,   BYTES_1,  // iana:ipClassOfService
+    35U,  BYTES_1,  // iana:samplingAlgorithm
+    56U,  BYTES_6,  // iana:sourceMacAddress
+    80U,  BYTES_6,  // iana:destinationMacAddress
+    58U,  BYTES_2,  // iana:vlanId
+    34U,  BYTES_4,  // iana:samplingInterval
+    // IPFIX Template header (IPv6 flows)
+    SFLOW_TID_IPV6, SFLOW_FIELD_CNT,
+    27U,  BYTES_16, // iana:sourceIPv6Address
+    28U,  BYTES_16, // iana:destinationIPv6Address
+    10U,  BYTES_4,  // iana:ingressInterface
+    14U,  BYTES_4,  // iana:egressInterface
+    2U,   BYTES_8,  // iana:packetDeltaCount
+    1U,   BYTES_8,  // iana:octetDeltaCount
+    152U, BYTES_8,  // iana:flowStartMilliseconds
+    153U, BYTES_8,  // iana:flowEndMilliseconds
+    7U,   BYTES_2,  // iana:sourceTransportPort
+    11U,  BYTES_2,  // iana:destinationTransportPort
+    6U,   BYTES_1,  // iana:tcpControlBits
+    4U,   BYTES_1,  // iana:protocolIdentifier
+    5U,   BYTES_1,  // iana:ipClassOfService
+    35U,  BYTES_1,  // iana:samplingAlgorithm
+    56U,  BYTES_6,  // iana:sourceMacAddress
+    80U,  BYTES_6,  // iana:destinationMacAddress
+    58U,  BYTES_2,  // iana:vlanId
+    34U,  BYTES_4   // iana:samplingInterval
+};
+
+/// Number of items (including headers) in the Template Set
+#define SFLOW_TSET_ITEMS (sizeof(sflow_tmpl_set) / sizeof(sflow_tmpl_set[0]))
+static_assert(SFLOW_TSET_ITEMS == 2U + 2U * (2U + 2U * SFLOW_FIELD_CNT),
+    "Unexpected number of fields in the Template Set!");
+
+/**
+ * @brief Common part of a converted flow sample (i.e. all fields after IP addresses)
+ * @note The structure MUST match IPFIX Templates in ::sflow_tmpl_set
+ */
+struct __attribute__((__packed__)) new_ipx_common {
+    uint32_t if_in;         ///< SNMP index of input interface
+    uint32_t if_out;        ///< SNMP index of output interface
+    uint64_t delta_pkts;    ///< Packets (i.e. sampling rate)
+    uint64_t delta_octets;  ///< Layer 3 bytes of the sampled packet multiplied by sampling rate
+    uint64_t ts_first;      ///< Absolute timestamp of the sample (in milliseconds)
+    uint64_t ts_last;       ///< Absolute timestamp of the sample (in milliseconds)
+    uint16_t port_src;      ///< TCP/UDP source port number or equivalent
+    uint16_t port_dst;      ///< TCP/UDP destination port number or ICMP type and code
+    uint8_t  tcp_flags;     ///< TCP flags
+    uint8_t  proto;         ///< IP protocol type (for example, TCP = 6; UDP = 17)
+    uint8_t  tos;           ///< IP type of service (ToS)
+    uint8_t  sampling_alg;  ///< Sampling algorithm
+    uint8_t  mac_src[6];    ///< Source MAC address
+    uint8_t  mac_dst[6];    ///< Destination MAC address
+    uint16_t vlan;          ///< VLAN ID
+    uint32_t sampling_int;  ///< Sampling interval
+};
+
+/// Converted IPv4 flow sample (must match IPFIX Template ::SFLOW_TID_IPV4)
+struct __attribute__((__packed__)) new_ipx_rec4 {
+    uint32_t addr_src;            ///< Source IPv4 address
+    uint32_t addr_dst;            ///< Destination IPv4 address
+    struct new_ipx_common common; ///< Remaining fields
+};
+
+/// Converted IPv6 flow sample (must match IPFIX Template ::SFLOW_TID_IPV6)
+struct __attribute__((__packed__)) new_ipx_rec6 {
+    uint8_t addr_src[16];         ///< Source IPv6 address
+    uint8_t addr_dst[16];         ///< Destination IPv6 address
+    struct new_ipx_common common; ///< Remaining fields
+};
+
+/// Decoded flow sample
+struct sflow_flow {
+    /// IP version of the sampled packet (0 = unknown, 4 or 6)
+    uint8_t ip_ver;
+    /// Source IP address (IPv4 address occupies the first 4 bytes)
+    uint8_t addr_src[16];
+    /// Destination IP address (IPv4 address occupies the first 4 bytes)
+    uint8_t addr_dst[16];
+    /// Layer 3 size of the sampled packet (0 = unknown)
+    uint32_t ip_len;
+    /// Size of the sampled frame (0 = unknown)
+    uint32_t frame_len;
+    /// Fields of the new IPFIX Data Record (in "network byte order")
+    struct new_ipx_common common;
+};
+
+/**
+ * @def CONV_ERROR
+ * @brief Macro for printing an error message of a converter
+ * @param[in] conv    Converter
+ * @param[in] fmt     Format string (see manual page for "printf" family)
+ * @param[in] ...     Variable number of arguments for the format string
+ */
+#define CONV_ERROR(conv, fmt, ...)                                                \
+    if ((conv)->conf.vlevel >= IPX_VERB_ERROR) {                                  \
+        ipx_verb_print(IPX_VERB_ERROR, "ERROR: %s: [%s] " fmt "\n",               \
+            (conv)->conf.ident, (conv)->msg_ctx->session->ident, ## __VA_ARGS__); \
+    }
+
+/**
+ * @def CONV_WARNING
+ * @brief Macro for printing a warning message of a converter
+ * @param[in] conv    Converter
+ * @param[in] fmt     Format string (see manual page for "printf" family)
+ * @param[in] ...     Variable number of arguments for the format string
+ */
+#define CONV_WARNING(conv, fmt, ...)                                              \
+    if ((conv)->conf.vlevel >= IPX_VERB_WARNING) {                                \
+        ipx_verb_print(IPX_VERB_WARNING, "WARNING: %s: [%s] " fmt "\n",           \
+            (conv)->conf.ident, (conv)->msg_ctx->session->ident, ## __VA_ARGS__); \
+    }
+
+/**
+ * @def CONV_DEBUG
+ * @brief Macro for printing a debug message of a converter
+ * @param[in] conv    Converter
+ * @param[in] fmt     Format string (see manual page for "printf" family)
+ * @param[in] ...     Variable number of arguments for the format string
+ */
+#define CONV_DEBUG(conv, fmt, ...)                                                \
+    if ((conv)->conf.vlevel >= IPX_VERB_DEBUG) {                                  \
+        ipx_verb_print(IPX_VERB_DEBUG, "DEBUG: %s: [%s] " fmt "\n",               \
+            (conv)->conf.ident, (conv)->msg_ctx->session->ident, ## __VA_ARGS__); \
+    }
+
+/// Internal converter structure
+struct ipx_sflow_conv {
+    /// Message context of an sFlow Datagram that is converted
+    const struct ipx_msg_ctx *msg_ctx;
+
+    struct {
+        /// Expected sequence number of the next sFlow Datagram
+        uint32_t next_sflow;
+        /// Is the expected sequence number valid (i.e. at least one Datagram processed)
+        bool valid;
+        /// Next sequence number of the next IPFIX Message
+        uint32_t next_ipx;
+    } seq; ///< Sequence numbers
+
+    struct {
+        /// Instance identification (only for log!)
+        char *ident;
+        /// Verbosity level
+        enum ipx_verb_level vlevel;
+        /// Template refresh interval (in seconds)
+        uint32_t refresh;
+        /// Observation Domain ID of IPFIX message
+        uint32_t odid;
+    } conf; ///< Configuration parameters
+
+    struct {
+        /// Have the templates been already sent?
+        bool added;
+        /** Timestamp of the next template refresh (must be enabled in conf.)
+         *  If the "added" is false, this value is undefined! */
+        uint32_t next_refresh;
+
+        /// Template Set data (in "network byte order")
+        uint16_t *tset_data;
+        /// Template Set size
+        size_t tset_size;
+    } tmplt; ///< Template information
+
+    struct {
+        /// Decoded flow samples of the Datagram
+        struct sflow_flow *data;
+        /// Number of valid flow samples
+        size_t cnt;
+        /// Number of allocated flow samples
+        size_t alloc;
+        /// Number of IPv4 flow samples
+        uint16_t cnt4;
+        /// Number of IPv6 flow samples
+        uint16_t cnt6;
+    } flows; ///< Flow samples (reused by all Datagrams)
+};
+
+/// Reader of XDR encoded data
+struct xdr_reader {
+    /// Position of the next value
+    const uint8_t *pos;
+    /// End of the data
+    const uint8_t *end;
+};
+
+/**
+ * @brief Read an unsigned 32-bit value
+ * @param[in]  rd    Reader
+ * @param[out] value Value (in "host byte order")
+ * @return True on success, false if the end of data has been reached
+ */
+static inline bool
+xdr_u32(struct xdr_reader *rd, uint32_t *value)
+{
+    if ((size_t) (rd->end - rd->pos) < sizeof(uint32_t)) {
+        return false;
+    }
+
+    uint32_t tmp;
+    memcpy(&tmp, rd->pos, sizeof(tmp));
+    *value = ntohl(tmp);
+    rd->pos += sizeof(uint32_t);
+    return true;
+}
+
+/**
+ * @brief Get an opaque value of a given size and skip it (including padding)
+ * @param[in]  rd   Reader
+ * @param[in]  size Size of the value
+ * @param[out] data Pointer to the value (can be NULL)
+ * @return True on success, false if the end of data has been reached
+ */
+static inline bool
+xdr_opaque(struct xdr_reader *rd, uint32_t size, const uint8_t **data)
+{
+    const size_t padded = ((size_t) size + 3U) & ~((size_t) 3U);
+    if ((size_t) (rd->end - rd->pos) < padded) {
+        return false;
+    }
+
+    if (data != NULL) {
+        *data = rd->pos;
+    }
+    rd->pos += padded;
+    return true;
+}
+
+/**
+ * @brief Read an unsigned 16-bit value in "network byte order" from a packet header
+ * @param[in] data Pointer to the value
+ * @return Value in "host byte order"
+ */
+static inline uint16_t
+pkt_u16(const uint8_t *data)
+{
+    return (uint16_t) ((data[0] << 8) | data[1]);
+}
+
+/**
+ * @brief Parse transport layer header of a sampled packet
+ * @param[out] flow  Flow sample to fill
+ * @param[in]  proto IP protocol
+ * @param[in]  data  Transport layer header
+ * @param[in]  size  Size of the header
+ */
+static void
+sflow_pkt_l4(struct sflow_flow *flow, uint8_t proto, const uint8_t *data, size_t size)
+{
+    switch (proto) {
+    case 6: // TCP
+        if (size >= 14U) {
+            flow->common.tcp_flags = data[13];
+        }
+        // fall through
+    case 17:  // UDP
+    case 132: // SCTP
+        if (size >= 4U) {
+            memcpy(&flow->common.port_src, &data[0], sizeof(uint16_t));
+            memcpy(&flow->common.port_dst, &data[2], sizeof(uint16_t));
+        }
+        break;
+    case 1:  // ICMP
+    case 58: // ICMPv6
+        // ICMP type and code are stored as the destination port (the same way as NetFlow v5)
+        if (size >= 2U) {
+            memcpy(&flow->common.port_dst, &data[0], sizeof(uint16_t));
+        }
+        break;
+    default:
+        break;
+    }
+}
+
+/**
+ * @brief Parse a raw header of a sampled packet
+ *
+ * Only Ethernet (including VLAN tags), IPv4, IPv6 and common transport layer headers are
+ * supported. Other headers are ignored.
+ * @param[out] flow  Flow sample to fill
+ * @param[in]  proto Header protocol (see ::ipx_sflow_hdr_proto)
+ * @param[in]  data  Header of the packet
+ * @param[in]  size  Size of the header
+ */
+static void
+sflow_pkt_parse(struct sflow_flow *flow, uint32_t proto, const uint8_t *data, size_t size)
+{
+    uint16_t eth_type;
+
+    switch (proto) {
+    case IPX_SFLOW_HDR_ETHERNET:
+        if (size < 14U) {
+            return;
+        }
+
+        memcpy(flow->common.mac_dst, &data[0], 6U);
+        memcpy(flow->common.mac_src, &data[6], 6U);
+        eth_type = pkt_u16(&data[12]);
+        data += 14U;
+        size -= 14U;
+
+        // Skip VLAN tags (only the outer VLAN ID is stored)
+        while ((eth_type == ETH_TYPE_VLAN || eth_type == ETH_TYPE_QINQ) && size >= 4U) {
+            if (flow->common.vlan == 0) {
+                flow->common.vlan = htons(pkt_u16(&data[0]) & 0x0FFFU);
+            }
+            eth_type = pkt_u16(&data[2]);
+            data += 4U;
+            size -= 4U;
+        }
+        break;
+    case IPX_SFLOW_HDR_IPV4:
+        eth_type = ETH_TYPE_IPV4;
+        break;
+    case IPX_SFLOW_HDR_IPV6:
+        eth_type = ETH_TYPE_IPV6;
+        break;
+    default:
+        return;
+    }
+
+    if (eth_type == ETH_TYPE_IPV4) {
+        if (size < 20U || (data[0] >> 4) != 4U) {
+            return;
+        }
+
+        const size_t ihl = (data[0] & 0x0FU) * 4U;
+        flow->ip_ver = 4;
+        flow->ip_len = pkt_u16(&data[2]);
+        flow->common.tos = data[1];
+        flow->common.proto = data[9];
+        memcpy(flow->addr_src, &data[12], 4U);
+        memcpy(flow->addr_dst, &data[16], 4U);
+
+        // Transport layer header is available only in the first fragment
+        if (ihl >= 20U && size >= ihl && (pkt_u16(&data[6]) & 0x1FFFU) == 0) {
+            sflow_pkt_l4(flow, data[9], data + ihl, size - ihl);
+        }
+    } else if (eth_type == ETH_TYPE_IPV6) {
+        if (size < 40U || (data[0] >> 4) != 6U) {
+            return;
+        }
+
+        // Extension headers are not supported
+        flow->ip_ver = 6;
+        flow->ip_len = pkt_u16(&data[4]) + 40U;
+        flow->common.tos = (uint8_t) ((data[0] << 4) | (data[1] >> 4));
+        flow->common.proto = data[6];
+        memcpy(flow->addr_src, &data[8], 16U);
+        memcpy(flow->addr_dst, &data[24], 16U);
+        sflow_pkt_l4(flow, data[6], data + 40U, size - 40U);
+    }
+}
+
+/**
+ * @brief Decode a flow record of a flow sample
+ *
+ * Unknown and unsupported flow records are ignored.
+ * @param[out] flow   Flow sample to fill
+ * @param[in]  format Data format of the record
+ * @param[in]  data   Content of the record
+ * @param[in]  size   Size of the record
+ * @return True on success, false if the record is malformed
+ */
+static bool
+sflow_flow_rec(struct sflow_flow *flow, uint32_t format, const uint8_t *data, uint32_t size)
+{
+    struct xdr_reader rd = {data, data + size};
+    uint32_t values[4];
+
+    if (IPX_SFLOW_FMT_EN(format) != 0) {
+        // Enterprise specific record
+        return true;
+    }
+
+    switch (IPX_SFLOW_FMT_ID(format)) {
+    case IPX_SFLOW_FLOW_HEADER: {
+        // Protocol, frame length, stripped bytes, header length
+        const uint8_t *hdr;
+        if (size < IPX_SFLOW_HEADER_LEN) {
+            return false;
+        }
+        for (size_t i = 0; i < 4U; ++i) {
+            xdr_u32(&rd, &values[i]);
+        }
+        if (!xdr_opaque(&rd, values[3], &hdr)) {
+            return false;
+        }
+
+        flow->frame_len = (values[1] > values[2]) ? values[1] - values[2] : values[1];
+        if (flow->ip_ver == 0) {
+            sflow_pkt_parse(flow, values[0], hdr, values[3]);
+        }
+        }
+        break;
+    case IPX_SFLOW_FLOW_ETHERNET:
+        if (size < IPX_SFLOW_ETHERNET_LEN) {
+            return false;
+        }
+        memcpy(flow->common.mac_src, &data[4], 6U);
+        memcpy(flow->common.mac_dst, &data[12], 6U);
+        break;
+    case IPX_SFLOW_FLOW_IPV4:
+        // Length, protocol, addresses, ports, TCP flags and ToS (preferred over the raw header)
+        if (size < IPX_SFLOW_IPV4_LEN) {
+            return false;
+        }
+        flow->ip_ver = 4;
+        xdr_u32(&rd, &flow->ip_len);
+        xdr_u32(&rd, &values[0]);
+        flow->common.proto = (uint8_t) values[0];
+        memcpy(flow->addr_src, &data[8], 4U);
+        memcpy(flow->addr_dst, &data[12], 4U);
+        rd.pos = &data[16];
+        for (size_t i = 0; i < 4U; ++i) {
+            xdr_u32(&rd, &values[i]);
+        }
+        flow->common.port_src = htons((uint16_t) values[0]);
+        flow->common.port_dst = htons((uint16_t) values[1]);
+        flow->common.tcp_flags = (uint8_t) values[2];
+        flow->common.tos = (uint8_t) values[3];
+        break;
+    case IPX_SFLOW_FLOW_IPV6:
+        // Length, protocol, addresses, ports, TCP flags and priority (preferred over the raw header)
+        if (size < IPX_SFLOW_IPV6_LEN) {
+            return false;
+        }
+        flow->ip_ver = 6;
+        xdr_u32(&rd, &flow->ip_len);
+        xdr_u32(&rd, &values[0]);
+        flow->common.proto = (uint8_t) values[0];
+        memcpy(flow->addr_src, &data[8], 16U);
+        memcpy(flow->addr_dst, &data[24], 16U);
+        rd.pos = &data[40];
+        for (size_t i = 0; i < 4U; ++i) {
+            xdr_u32(&rd, &values[i]);
+        }
+        flow->common.port_src = htons((uint16_t) values[0]);
+        flow->common.port_dst = htons((uint16_t) values[1]);
+        flow->common.tcp_flags = (uint8_t) values[2];
+        flow->common.tos = (uint8_t) values[3];
+        break;
+    case IPX_SFLOW_FLOW_EXT_SWITCH:
+        // Source VLAN, source priority, destination VLAN, destination priority
+        if (size < IPX_SFLOW_EXT_SWITCH_LEN) {
+            return false;
+        }
+        xdr_u32(&rd, &values[0]);
+        flow->common.vlan = htons((uint16_t) (values[0] & 0x0FFFU));
+        break;
+    default:
+        break;
+    }
+
+    return true;
+}
+
+/**
+ * @brief Get a free flow sample in the internal array
+ * @param[in] conv Converter internals
+ * @return Pointer to the zeroed flow sample or NULL (memory allocation error)
+ */
+static struct sflow_flow *
+sflow_flow_next(ipx_sflow_conv_t *conv)
+{
+    if (conv->flows.cnt == conv->flows.alloc) {
+        const size_t new_alloc = (conv->flows.alloc == 0) ? 16U : 2U * conv->flows.alloc;
+        struct sflow_flow *new_data = realloc(conv->flows.data, new_alloc * sizeof(*new_data));
+        if (!new_data) {
+            return NULL;
+        }
+
+        conv->flows.data = new_data;
+        conv->flows.alloc = new_alloc;
+    }
+
+    struct sflow_flow *flow = &conv->flows.data[conv->flows.cnt];
+    memset(flow, 0, sizeof(*flow));
+    return flow;
+}
+
+/**
+ * @brief Decode a (expanded) flow sample
+ *
+ * If the sample describes an IPv4 or IPv6 packet, it is added to the internal array of flow
+ * samples. Otherwise, it is ignored.
+ * @param[in] conv     Converter internals
+ * @param[in] expanded Expanded flow sample
+ * @param[in] data     Content of the sample
+ * @param[in] size     Size of the sample
+ * @return #IPX_OK on success
+ * @return #IPX_ERR_FORMAT if the sample is malformed
+ * @return #IPX_ERR_NOMEM in case of a memory allocation error
+ */
+static int
+sflow_sample_flow(ipx_sflow_conv_t *conv, bool expanded, const uint8_t *data, uint32_t size)
+{
+    struct xdr_reader rd = {data, data + size};
+    uint32_t values[11];
+    uint32_t rate, if_in, if_out, rec_cnt;
+
+    if (expanded) {
+        // seq, source type, source index, rate, pool, drops, in format, in, out format, out, cnt
+        if (size < IPX_SFLOW_FLOW_EXP_LEN) {
+            return IPX_ERR_FORMAT;
+        }
+        for (size_t i = 0; i < 11U; ++i) {
+            xdr_u32(&rd, &values[i]);
+        }
+        rate = values[3];
+        if_in = (values[6] == 0) ? values[7] : 0;
+        if_out = (values[8] == 0) ? values[9] : 0;
+        rec_cnt = values[10];
+    } else {
+        // seq, source, rate, pool, drops, in, out, cnt (interfaces: 2b format + 30b value)
+        if (size < IPX_SFLOW_FLOW_LEN) {
+            return IPX_ERR_FORMAT;
+        }
+        for (size_t i = 0; i < 8U; ++i) {
+            xdr_u32(&rd, &values[i]);
+        }
+        rate = values[2];
+        if_in = ((values[5] >> 30) == 0) ? (values[5] & 0x3FFFFFFFU) : 0;
+        if_out = ((values[6] >> 30) == 0) ? (values[6] & 0x3FFFFFFFU) : 0;
+        rec_cnt = values[7];
+    }
+
+    struct sflow_flow *flow = sflow_flow_next(conv);
+    if (!flow) {
+        CONV_ERROR(conv, "A memory allocation failed (%s:%d).", __FILE__, __LINE__);
+        return IPX_ERR_NOMEM;
+    }
+
+    for (uint32_t i = 0; i < rec_cnt; ++i) {
+        uint32_t rec_fmt, rec_size;
+        const uint8_t *rec_data;
+        if (!xdr_u32(&rd, &rec_fmt) || !xdr_u32(&rd, &rec_size)
+                || !xdr_opaque(&rd, rec_size, &rec_data)) {
+            CONV_ERROR(conv, "Unexpected end of a flow record in a flow sample.", '\0');
+            return IPX_ERR_FORMAT;
+        }
+
+        if (!sflow_flow_rec(flow, rec_fmt, rec_data, rec_size)) {
+            CONV_ERROR(conv, "Malformed flow record (format %" PRIu32 ":%" PRIu32 ") in a flow "
+                "sample.", IPX_SFLOW_FMT_EN(rec_fmt), IPX_SFLOW_FMT_ID(rec_fmt));
+            return IPX_ERR_FORMAT;
+        }
+    }
+
+    if (flow->ip_ver == 0) {
+        CONV_DEBUG(conv, "Ignoring a flow sample without an IPv4/IPv6 packet.", '\0');
+        return IPX_OK;
+    }
+
+    // Packet and octet counters are estimated from the sampling rate
+    const uint64_t pkts = (rate != 0) ? rate : 1U;
+    const uint64_t octets = (flow->ip_len != 0) ? flow->ip_len : flow->frame_len;
+    flow->common.if_in = htonl(if_in);
+    flow->common.if_out = htonl(if_out);
+    flow->common.delta_pkts = htobe64(pkts);
+    flow->common.delta_octets = htobe64(octets * pkts);
+    flow->common.sampling_alg = SFLOW_SAMPLING_RANDOM;
+    flow->common.sampling_int = htonl(rate);
+
+    if (flow->ip_ver == 4) {
+        conv->flows.cnt4++;
+    } else {
+        conv->flows.cnt6++;
+    }
+    conv->flows.cnt++;
+    return IPX_OK;
+}
+
+/**
+ * @brief Decode all samples of an sFlow Datagram
+ * @param[in] conv    Converter internals
+ * @param[in] rd      Reader (positioned at the first sample)
+ * @param[in] smp_cnt Number of samples in the Datagram
+ * @return #IPX_OK on success
+ * @return #IPX_ERR_FORMAT if the Datagram is malformed
+ * @return #IPX_ERR_NOMEM in case of a memory allocation error
+ */
+static int
+sflow_samples(ipx_sflow_conv_t *conv, struct xdr_reader *rd, uint32_t smp_cnt)
+{
+    conv->flows.cnt = 0;
+    conv->flows.cnt4 = 0;
+    conv->flows.cnt6 = 0;
+
+    for (uint32_t i = 0; i < smp_cnt; ++i) {
+        uint32_t smp_fmt, smp_size;
+        const uint8_t *smp_data;
+        if (!xdr_u32(rd, &smp_fmt) || !xdr_u32(rd, &smp_size)
+                || !xdr_opaque(rd, smp_size, &smp_data)) {
+            CONV_ERROR(conv, "Unexpected end of a sample in an sFlow Datagram (sample %" PRIu32
+                " of %" PRIu32 ").", i + 1, smp_cnt);
+            return IPX_ERR_FORMAT;
+        }
+
+        if (IPX_SFLOW_FMT_EN(smp_fmt) != 0) {
+            // Enterprise specific sample
+            continue;
+        }
+
+        int rc;
+        switch (IPX_SFLOW_FMT_ID(smp_fmt)) {
+        case IPX_SFLOW_SAMPLE_FLOW:
+            rc = sflow_sample_flow(conv, false, smp_data, smp_size);
+            break;
+        case IPX_SFLOW_SAMPLE_FLOW_EXP:
+            rc = sflow_sample_flow(conv, true, smp_data, smp_size);
+            break;
+        default:
+            // Counter samples and unknown samples are ignored
+            rc = IPX_OK;
+            break;
+        }
+
+        if (rc != IPX_OK) {
+            return rc;
+        }
+    }
+
+    if (rd->pos != rd->end) {
+        CONV_WARNING(conv, "sFlow Datagram contains unexpected data after the last sample.", '\0');
+    }
+    return IPX_OK;
+}
+
+ipx_sflow_conv_t *
+ipx_sflow_conv_init(const char *ident, enum ipx_verb_level vlevel, uint32_t tmplt_refresh,
+    uint32_t odid)
+{
+    struct ipx_sflow_conv *res = calloc(1, sizeof(*res));
+    if (!res) {
+        return NULL;
+    }
+
+    res->conf.ident = strdup(ident);
+    if (!res->conf.ident) {
+        free(res);
+        return NULL;
+    }
+
+    // Prepare Template Set
+    size_t tset_size = sizeof(sflow_tmpl_set);
+    uint16_t *tset_data = malloc(tset_size);
+    if (!tset_data) {
+        free(res->conf.ident);
+        free(res);
+        return NULL;
+    }
+
+    uint16_t drec_size = 0;
+    for (size_t i = 0; i < SFLOW_TSET_ITEMS; ++i) {
+        // Convert fields from "host byte order" to "network byte order"
+        tset_data[i] = htons(sflow_tmpl_set[i]);
+
+        if (i >= 4 && i < 4 + 2 * SFLOW_FIELD_CNT && i % 2 == 1) {
+            drec_size += sflow_tmpl_set[i];
+        }
+    }
+    assert(drec_size == sizeof(struct new_ipx_rec4));
+    (void) drec_size;
+
+    struct fds_ipfix_set_hdr *tset_hdr = (struct fds_ipfix_set_hdr *) tset_data;
+    tset_hdr->length = htons((uint16_t) tset_size);
+
+    res->tmplt.tset_data = tset_data;
+    res->tmplt.tset_size = tset_size;
+    res->tmplt.added = false;
+
+    res->conf.refresh = tmplt_refresh;
+    res->conf.odid = odid;
+    res->conf.vlevel = vlevel;
+    return res;
+}
+
+void
+ipx_sflow_conv_destroy(ipx_sflow_conv_t *conv)
+{
+    free(conv->flows.data);
+    free(conv->conf.ident);
+    free(conv->tmplt.tset_data);
+    free(conv);
+}
+
+/**
+ * @brief Compare timestamps or sequence numbers (with wraparound support)
+ * @param[in] t1 First value
+ * @param[in] t2 Second value
+ * @return  The  function  returns an integer less than, equal to, or greater than zero if the
+ *   first value \p t1 is found, respectively, to be less than, to match, or be greater than
+ *   the second value.
+ */
+static inline int
+conv_time_cmp(uint32_t t1, uint32_t t2)
+{
+    if (t1 == t2) {
+        return 0;
+    }
+
+    if ((t1 - t2) & 0x80000000) { // test the "sign" bit
+        return (-1);
+    } else {
+        return 1;
+    }
+}
+
+/**
+ * @brief Add an IPFIX Data Set with converted flow samples of the given IP version
+ *
+ * @param[in] conv     Converter internals
+ * @param[in] ip_ver   IP version of flow samples (4 or 6)
+ * @param[in] ts       Timestamp of all flow samples (milliseconds, "network byte order")
+ * @param[in] ipx_data Pointer to the place where the new IPFIX Data Set will be placed
+ * @return Pointer to the memory right behind the added Data Set
+ */
+static uint8_t *
+conv_add_dset(const ipx_sflow_conv_t *conv, uint8_t ip_ver, uint64_t ts, uint8_t *ipx_data)
+{
+    const uint16_t rec_cnt = (ip_ver == 4) ? conv->flows.cnt4 : conv->flows.cnt6;
+    const size_t rec_size = (ip_ver == 4)
+        ? sizeof(struct new_ipx_rec4) : sizeof(struct new_ipx_rec6);
+    if (rec_cnt == 0) {
+        // Nothing to add
+        return ipx_data;
+    }
+
+    struct fds_ipfix_dset *ipx_dset = (struct fds_ipfix_dset *) ipx_data;
+    const size_t dset_len = FDS_IPFIX_SET_HDR_LEN + (rec_cnt * rec_size);
+    ipx_dset->header.flowset_id = htons((ip_ver == 4) ? SFLOW_TID_IPV4 : SFLOW_TID_IPV6);
+    ipx_dset->header.length = htons((uint16_t) dset_len);
+
+    uint8_t *ipx_rec = &ipx_dset->records[0];
+    for (size_t i = 0; i < conv->flows.cnt; ++i) {
+        const struct sflow_flow *flow = &conv->flows.data[i];
+        if (flow->ip_ver != ip_ver) {
+            continue;
+        }
+
+        struct new_ipx_common common = flow->common;
+        common.ts_first = ts;
+        common.ts_last = ts;
+
+        if (ip_ver == 4) {
+            struct new_ipx_rec4 *rec = (struct new_ipx_rec4 *) ipx_rec;
+            memcpy(&rec->addr_src, flow->addr_src, 4U);
+            memcpy(&rec->addr_dst, flow->addr_dst, 4U);
+            memcpy(&rec->common, &common, sizeof(common));
+        } else {
+            struct new_ipx_rec6 *rec = (struct new_ipx_rec6 *) ipx_rec;
+            memcpy(rec->addr_src, flow->addr_src, 16U);
+            memcpy(rec->addr_dst, flow->addr_dst, 16U);
+            memcpy(&rec->common, &common, sizeof(common));
+        }
+        ipx_rec += rec_size;
+    }
+
+    assert(ipx_rec == ipx_data + dset_len);
+    return (ipx_data + dset_len);
+}
+
+int
+ipx_sflow_conv_process(ipx_sflow_conv_t *conv, ipx_msg_ipfix_t *wrapper)
+{
+    const uint8_t *sflow_msg = wrapper->raw_pkt;
+    const size_t sflow_size = wrapper->raw_size;
+    struct xdr_reader rd = {sflow_msg, sflow_msg + sflow_size};
+    uint32_t version, addr_type, sub_agent, seq_num, uptime, smp_cnt;
+    conv->msg_ctx = &wrapper->ctx;
+
+    // Check the header
+    if (sflow_size < IPX_SFLOW_MSG_HDR_LEN_MIN) {
+        CONV_ERROR(conv, "Length of sFlow v5 Datagram is smaller than its header size!", '\0');
+        return IPX_ERR_FORMAT;
+    }
+
+    xdr_u32(&rd, &version);
+    if (version != IPX_SFLOW_VERSION) {
+        CONV_ERROR(conv, "Invalid version number of sFlow Datagram (expected 5)", '\0');
+        return IPX_ERR_FORMAT;
+    }
+
+    xdr_u32(&rd, &addr_type);
+    const uint32_t addr_size = (addr_type == IPX_SFLOW_ADDR_IPV4) ? 4U
+        : ((addr_type == IPX_SFLOW_ADDR_IPV6) ? 16U : 0U);
+    if (!xdr_opaque(&rd, addr_size, NULL) || !xdr_u32(&rd, &sub_agent)
+            || !xdr_u32(&rd, &seq_num) || !xdr_u32(&rd, &uptime) || !xdr_u32(&rd, &smp_cnt)) {
+        CONV_ERROR(conv, "Length of sFlow v5 Datagram is smaller than its header size!", '\0');
+        return IPX_ERR_FORMAT;
+    }
+
+    CONV_DEBUG(conv, "Converting an sFlow Datagram v5 (seq. num. %" PRIu32 ") to an IPFIX "
+        "Message (new seq. num. %" PRIu32 ")", seq_num, conv->seq.next_ipx);
+
+    // Check sequence numbers (incremented by one for each Datagram)
+    if (conv->seq.valid && conv->seq.next_sflow != seq_num) {
+        CONV_WARNING(conv, "Unexpected Sequence number (expected: %" PRIu32 ", got: %" PRIu32 ")",
+            conv->seq.next_sflow, seq_num);
+        if (conv_time_cmp(seq_num, conv->seq.next_sflow) > 0) {
+            conv->seq.next_sflow = seq_num + 1;
+        }
+    } else {
+        conv->seq.next_sflow = seq_num + 1;
+    }
+    conv->seq.valid = true;
+
+    // Decode all samples
+    int rc = sflow_samples(conv, &rd, smp_cnt);
+    if (rc != IPX_OK) {
+        return rc;
+    }
+
+    struct timespec ts_now;
+    clock_gettime(CLOCK_REALTIME, &ts_now);
+    const uint32_t exp_time = (uint32_t) ts_now.tv_sec;
+    const uint64_t ts_msec = ((uint64_t) ts_now.tv_sec * 1000U) + (ts_now.tv_nsec / 1000000U);
+
+    // Calculate size of the new IPFIX Message
+    const bool add_tset = !conv->tmplt.added
+        || (conv->conf.refresh != 0 && conv_time_cmp(exp_time, conv->tmplt.next_refresh) >= 0);
+    size_t ipx_size = FDS_IPFIX_MSG_HDR_LEN;
+    if (add_tset) {
+        ipx_size += conv->tmplt.tset_size;
+    }
+    if (conv->flows.cnt4 > 0) {
+        ipx_size += FDS_IPFIX_SET_HDR_LEN + conv->flows.cnt4 * sizeof(struct new_ipx_rec4);
+    }
+    if (conv->flows.cnt6 > 0) {
+        ipx_size += FDS_IPFIX_SET_HDR_LEN + conv->flows.cnt6 * sizeof(struct new_ipx_rec6);
+    }
+
+    if (ipx_size > UINT16_MAX) {
+        CONV_ERROR(conv, "Unable to convert sFlow v5 to IPFIX. Size of the converted message "
+            "exceeds the maximum size of an IPFIX Message! (before: %zu B, after: %zu B, "
+            "limit: 65535)", sflow_size, ipx_size);
+        return IPX_ERR_FORMAT;
+    }
+
+    uint8_t *ipx_msg = ipx_utils_buf_alloc(ipx_size * sizeof(uint8_t));
+    if (!ipx_msg) {
+        CONV_ERROR(conv, "A memory allocation failed (%s:%d).", __FILE__, __LINE__);
+        return IPX_ERR_NOMEM;
+    }
+
+    // Fill the IPFIX Message
+    struct fds_ipfix_msg_hdr *ipx_hdr = (struct fds_ipfix_msg_hdr *) ipx_msg;
+    ipx_hdr->version = htons(FDS_IPFIX_VERSION);
+    ipx_hdr->length = htons((uint16_t) ipx_size);
+    ipx_hdr->export_time = htonl(exp_time);
+    ipx_hdr->seq_num = htonl(conv->seq.next_ipx);
+    ipx_hdr->odid = htonl(conv->conf.odid);
+    uint8_t *next_set = ipx_msg + FDS_IPFIX_MSG_HDR_LEN;
+
+    if (add_tset) {
+        CONV_DEBUG(conv, "Adding a Template Set into the converted sFlow Datagram.", '\0');
+        memcpy(next_set, conv->tmplt.tset_data, conv->tmplt.tset_size);
+        next_set += conv->tmplt.tset_size;
+        conv->tmplt.added = true;
+        conv->tmplt.next_refresh = exp_time + conv->conf.refresh;
+    }
+
+    const uint64_t ts_be = htobe64(ts_msec);
+    next_set = conv_add_dset(conv, 4, ts_be, next_set);
+    next_set = conv_add_dset(conv, 6, ts_be, next_set);
+    conv->seq.next_ipx += (uint32_t) conv->flows.cnt;
+
+    // Finally, replace the converted sFlow Datagram with the new IPFIX Message
+    assert(next_set == (ipx_msg + ipx_size));
+    (void) next_set;
+    ipx_utils_buf_free(wrapper->raw_pkt);
+    wrapper->raw_pkt = ipx_msg;
+    wrapper->raw_size = (uint16_t) ipx_size;
+    return IPX_OK;
+}
+
+void
+ipx_sflow_conv_verb(ipx_sflow_conv_t *conv, enum ipx_verb_level v_new)
+{
+    conv->conf.vlevel = v_new;
+}
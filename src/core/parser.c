@@ -39,8 +39,15 @@
  *
  */
 
+#include <errno.h>
+#include <stddef.h>
+#include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <inttypes.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/stat.h>
 #include <libfds.h>
 #include <ipfixcol2.h>
 
@@ -49,6 +56,7 @@
 #include "parser.h"
 #include "verbose.h"
 #include "fpipe.h"
+#include "trace.h"
 #include "netflow2ipfix/netflow2ipfix.h"
 #include "netflow2ipfix/netflow_structs.h"
 
@@ -56,6 +64,23 @@
 #define PARSER_DEF_RECS 8
 /** Default record of the stream structure */
 #define STREAM_DEF_RECS 1
+/** Maximum number of variable-length fields of a Template for the record boundary pre-pass */
+#define PARSER_VAR_SEGS 32
+/**
+ * Maximum distance (in Data Records) of a message older than expected to be considered as
+ * reordered. Older messages are considered as a reset of the Sequence Number.
+ */
+#define PARSER_SEQ_RESET_WINDOW (1U << 20)
+/** Number of slots of the cache of parsed (Options) Templates (must be a power of two) */
+#define PARSER_TCACHE_SLOTS (256U)
+/** Empty slot of the hash index of parser records */
+#define PARSER_INDEX_EMPTY SIZE_MAX
+/** Identification of a state file with (Options) Templates ("IPXT")  */
+#define PARSER_STATE_MAGIC (0x49505854U)
+/** Version of the layout of the state file                           */
+#define PARSER_STATE_VERSION (1U)
+/** Maximum number of flow sources waiting for their first message (the oldest are dropped) */
+#define PARSER_STATE_MAX (4096U)
 
 /** Auxiliary flags specific to each Stream ID within a Stream context */
 enum stream_info_flags {
@@ -77,6 +102,8 @@ struct stream_info {
 enum stream_ctx_flags {
     /** Ignore all IPFIX messages                                      */
     SCF_BLOCK = (1 << 0),
+    /** Templates from a state file might be available (see ipx_parser_state_load()) */
+    SCF_RESTORE = (1 << 1),
 };
 
 /** Type of source data                                                */
@@ -88,7 +115,21 @@ enum source_type {
     /// NetFlow v5 Messages
     ST_NETFLOW5,
     /// NetFlow v9 Messages
-    ST_NETFLOW9
+    ST_NETFLOW9,
+    /// sFlow v5 Datagrams
+    ST_SFLOW5
+};
+
+/** Data Set waiting for its (Options) Template                        */
+struct pending_set {
+    /** Export Time of the IPFIX Message of the Set (for expiration)   */
+    uint32_t export_time;
+    /** Size of the Set (including the header)                         */
+    uint16_t size;
+    /** The Set will be attached to the current message                */
+    bool attach;
+    /** Copy of the Set (including the header)                         */
+    uint8_t *data;
 };
 
 /**
@@ -109,8 +150,32 @@ struct stream_ctx {
         ipx_nf5_conv_t *nf5;
         /** Converter from NetFlow v9 to IPFIX    */
         ipx_nf9_conv_t *nf9;
+        /** Converter from sFlow v5 to IPFIX      */
+        ipx_sflow_conv_t *sflow;
     } converter;
 
+    /**
+     * Last Template snapshot used for parsing Data Sets (might be already freed, do NOT
+     * dereference!)
+     */
+    const fds_tsnapshot_t *snap;
+    /** Generation of the snapshot (incremented on every change of the snapshot) */
+    uint32_t snap_gen;
+
+    /** Sequence number statistics (cumulative)   */
+    struct ipx_parser_seq_stats seq_stats;
+    /** Sequence number statistics at the time of the previous report */
+    struct ipx_parser_seq_stats seq_reported;
+
+    /** Data Sets waiting for their (Options) Templates (see ipx_parser_pending_set()) */
+    struct pending_set *pending;
+    /** Number of waiting Data Sets               */
+    uint32_t pending_cnt;
+    /** Number of pre-allocated waiting Data Sets */
+    uint32_t pending_alloc;
+    /** Total size of waiting Data Sets           */
+    size_t pending_size;
+
     /** Number of pre-allocated stream records    */
     size_t infos_alloc;
     /** Number of valid stream records            */
@@ -128,11 +193,79 @@ struct parser_rec {
     const struct ipx_session *session;
     /** Observation Domain ID                     */
     uint32_t odid;
+    /** Value of the parser clock when the record has been used for the last time */
+    uint64_t last_used;
 
     /** Context common for all streams            */
     struct stream_ctx *ctx;
 };
 
+/** Slot of the cache of parsed (Options) Template definitions */
+struct parser_tcache_slot {
+    /** Hash of the raw definition                */
+    uint64_t hash;
+    /** Type of the template                      */
+    enum fds_template_type type;
+    /** Size of the raw definition                */
+    uint16_t size;
+    /** Copy of the raw definition (NULL, if the slot is empty) */
+    uint8_t *raw;
+    /** Parsed template (without definitions of Information Elements) */
+    struct fds_template *tmplt;
+};
+
+/** Header of a state file (host byte order)  */
+struct parser_state_file {
+    /** Identification of the file (#PARSER_STATE_MAGIC) */
+    uint32_t magic;
+    /** Version of the layout (#PARSER_STATE_VERSION)    */
+    uint32_t version;
+};
+
+/**
+ * \brief Header of a flow source in a state file (host byte order)
+ *
+ * The header is followed by \p tmplt_cnt (Options) Templates. Each of them consists of its type
+ * (uint16_t, see #fds_template_type), length (uint16_t) and the raw definition.
+ */
+struct parser_state_hdr {
+    /** Observation Domain ID                     */
+    uint32_t odid;
+    /** Source port                               */
+    uint16_t port_src;
+    /** Destination port                          */
+    uint16_t port_dst;
+    /** Version of IP addresses (AF_INET or AF_INET6) */
+    uint8_t l3_proto;
+    /** Reserved (zero)                           */
+    uint8_t reserved[3];
+    /** Source IP address (IPv4 addresses occupy the first 4 bytes) */
+    uint8_t addr_src[16];
+    /** Destination IP address (IPv4 addresses occupy the first 4 bytes) */
+    uint8_t addr_dst[16];
+    /** Number of (Options) Templates             */
+    uint32_t tmplt_cnt;
+};
+
+/** Size of the part of struct parser_state_hdr identifying a flow source */
+#define PARSER_STATE_KEY_SIZE offsetof(struct parser_state_hdr, tmplt_cnt)
+
+/** Flow source waiting for its first message (see ipx_parser_state_load())  */
+struct parser_state_entry {
+    /** Identification of the flow source and number of templates */
+    struct parser_state_hdr hdr;
+    /** (Options) Templates (in the format of the state file) */
+    uint8_t *data;
+    /** Size of the templates                    */
+    size_t size;
+    /** Monotonic time (in seconds) when the templates were known to be valid */
+    uint64_t since;
+    /** Template lifetime in seconds (0 = unlimited or unknown, i.e. loaded from a file) */
+    uint32_t lifetime;
+    /** The flow source has been removed from the parser, i.e. it must be saved again */
+    bool removed;
+};
+
 /** Main structure of IPFIX message parser         */
 struct ipx_parser {
     /** Plugin identification (for logs)           */
@@ -147,8 +280,71 @@ struct ipx_parser {
     size_t recs_alloc;
     /** Number of valid records                    */
     size_t recs_valid;
-    /** Array of records                           */
+    /** Array of records (sorted primary by Transport Session) */
     struct parser_rec *recs;
+    /** Maximum number of records (0 = unlimited, see ipx_parser_limit_set()) */
+    size_t recs_max;
+    /** Only count Data Records, i.e. don't add references (see ipx_parser_relay_set()) */
+    bool relay;
+
+    /** Clock incremented by every processed message (for LRU eviction of records) */
+    uint64_t clock;
+    /** Number of records evicted so far          */
+    uint64_t evictions;
+    /** Sequence number statistics of all records (including removed and evicted ones) */
+    struct ipx_parser_seq_stats seq_total;
+    /** Garbage of evicted records waiting to be returned (NULL, if none) */
+    ipx_gc_t *evicted;
+    /** Number of garbage objects in the container of evicted records */
+    size_t evicted_cnt;
+
+    /**
+     * Hash index of the records (open addressing with linear probing)
+     * \note Each slot contains an index to the array of records or #PARSER_INDEX_EMPTY. The size
+     *   of the index is always a power of two and twice the number of pre-allocated records.
+     */
+    size_t *index;
+    /** Number of slots of the hash index          */
+    size_t index_size;
+
+    /**
+     * Cache of parsed (Options) Template definitions shared by all Transport Sessions
+     * (NULL, if not allocated yet)
+     */
+    struct parser_tcache_slot *tcache;
+
+    /**
+     * Flow sources loaded from state files or removed (see ipx_parser_state_keep())
+     * \note Sorted by the identification of flow sources (see parser_state_find()).
+     */
+    struct parser_state_entry *state;
+    /** Number of valid waiting flow sources     */
+    size_t state_cnt;
+    /** Number of pre-allocated waiting flow sources */
+    size_t state_alloc;
+    /** Keep templates of removed flow sources (see ipx_parser_state_keep()) */
+    bool state_keep;
+
+    /** Data Sets waiting for their (Options) Templates (see ipx_parser_pending_set()) */
+    struct {
+        /** Maximum total size of waiting Data Sets per flow source (0 = disabled) */
+        size_t size_max;
+        /** Maximum age of waiting Data Sets (in seconds of Export Time) */
+        uint32_t timeout;
+        /** Statistics of all flow sources    */
+        struct ipx_parser_pending_stats stats;
+    } pending;
+
+    /** The last found combination of Transport Session, ODID and Stream ID */
+    struct {
+        const struct ipx_session *session;
+        uint32_t odid;
+        ipx_stream_t stream;
+        /** Parser record (NULL, if the cache is not valid) */
+        struct parser_rec *rec;
+        /** Stream information within the record */
+        struct stream_info *info;
+    } last;
 };
 
 /**
@@ -175,7 +371,8 @@ struct ipx_parser {
  */
 #define PARSER_WARNING(parser, msg_ctx, fmt, ...) \
     if ((parser)->vlevel >= IPX_VERB_WARNING) {                                                  \
-        ipx_verb_print(IPX_VERB_WARNING, "WARNING: %s: [%s, ODID: %" PRIu32 "] " fmt "\n",       \
+        ipx_verb_print_rl(IPX_VERB_WARNING, (parser)->ident,                                   \
+            "WARNING: %s: [%s, ODID: %" PRIu32 "] " fmt "\n",                                    \
             (parser)->ident, (msg_ctx)->session->ident, (msg_ctx)->odid, ## __VA_ARGS__);        \
     }
 
@@ -273,6 +470,15 @@ stream_ctx_destroy(struct stream_ctx *ctx)
     if (ctx->type == ST_NETFLOW9 && ctx->converter.nf9 != NULL) {
         ipx_nf9_conv_destroy(ctx->converter.nf9);
     }
+    if (ctx->type == ST_SFLOW5 && ctx->converter.sflow != NULL) {
+        ipx_sflow_conv_destroy(ctx->converter.sflow);
+    }
+
+    // Destroy Data Sets waiting for their templates
+    for (uint32_t idx = 0; idx < ctx->pending_cnt; ++idx) {
+        free(ctx->pending[idx].data);
+    }
+    free(ctx->pending);
 
     free(ctx);
 }
@@ -408,15 +614,50 @@ parser_rec_cmp(const void *rec1, const void *rec2)
 }
 
 /**
- * \brief Sort an array of parser records
- * \param parser Parser structure
+ * \brief Compute a hash of a combination of Transport Session and Observation Domain ID
+ * \param[in] session Transport Session
+ * \param[in] odid    Observation Domain ID
+ * \return Hash value
+ */
+static inline size_t
+parser_rec_hash(const struct ipx_session *session, uint32_t odid)
+{
+    // Mix bits of the pointer and the ODID (finalizer of SplitMix64)
+    uint64_t key = (uint64_t) (uintptr_t) session ^ ((uint64_t) odid * 0x9E3779B97F4A7C15ULL);
+    key = (key ^ (key >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    key = (key ^ (key >> 27)) * 0x94D049BB133111EBULL;
+    return (size_t) (key ^ (key >> 31));
+}
+
+/**
+ * \brief Rebuild the hash index of parser records
+ *
+ * Must be called every time positions of the records change. The cache of the last found
+ * record is invalidated too.
+ * \param[in] parser Parser structure
  */
 static void
-parser_rec_sort(struct ipx_parser *parser)
+parser_index_rebuild(struct ipx_parser *parser)
 {
-    const size_t rec_cnt = parser->recs_valid;
-    const size_t rec_size = sizeof(*parser->recs);
-    qsort(parser->recs, rec_cnt, rec_size, &parser_rec_cmp);
+    const size_t mask = parser->index_size - 1;
+    assert(parser->recs_valid < parser->index_size);
+
+    for (size_t slot = 0; slot < parser->index_size; ++slot) {
+        parser->index[slot] = PARSER_INDEX_EMPTY;
+    }
+
+    for (size_t idx = 0; idx < parser->recs_valid; ++idx) {
+        const struct parser_rec *rec = &parser->recs[idx];
+        size_t slot = parser_rec_hash(rec->session, rec->odid) & mask;
+        while (parser->index[slot] != PARSER_INDEX_EMPTY) {
+            slot = (slot + 1) & mask;
+        }
+
+        parser->index[slot] = idx;
+    }
+
+    parser->last.rec = NULL;
+    parser->last.info = NULL;
 }
 
 /**
@@ -430,63 +671,46 @@ parser_rec_sort(struct ipx_parser *parser)
 static struct parser_rec *
 parser_rec_find(struct ipx_parser *parser, const struct ipx_msg_ctx *ctx)
 {
-    const size_t rec_cnt = parser->recs_valid;
-    const size_t rec_size = sizeof(*parser->recs);
-    struct parser_rec key;
-    key.session = ctx->session;
-    key.odid = ctx->odid;
+    const size_t mask = parser->index_size - 1;
+    size_t slot = parser_rec_hash(ctx->session, ctx->odid) & mask;
+    size_t idx;
 
-    return bsearch(&key, parser->recs, rec_cnt, rec_size, &parser_rec_cmp);
+    // The index is never full, therefore, an empty slot always terminates the search
+    while ((idx = parser->index[slot]) != PARSER_INDEX_EMPTY) {
+        struct parser_rec *rec = &parser->recs[idx];
+        if (rec->session == ctx->session && rec->odid == ctx->odid) {
+            return rec;
+        }
+
+        slot = (slot + 1) & mask;
+    }
+
+    return NULL;
 }
 
 /**
- * \brief Get a parser record defined by Transport Session and Observation Domain ID within
- *   a parser
- *
- * The function will try to find and return the required record. If the record doesn't exist
- * a new one will be created.
+ * \brief Get a position of the first record which is not less than a combination of Transport
+ *   Session and Observation Domain ID
  * \param[in] parser Parser structure
- * \param[in] ctx    IPFIX Message context (info about Transport Session, ODID)
- * \return Pointer or NULL (memory allocation error)
+ * \param[in] key    Key to compare (only the Transport Session and ODID are used)
+ * \return Index to the array of records (might be equal to the number of valid records)
  */
-static struct parser_rec *
-parser_rec_get(struct ipx_parser *parser, const struct ipx_msg_ctx *ctx)
+static size_t
+parser_rec_lower_bound(const struct ipx_parser *parser, const struct parser_rec *key)
 {
-    // Try to find a record first
-    struct parser_rec *rec = parser_rec_find(parser, ctx);
-    if (rec != NULL) {
-        return rec;
-    }
+    size_t low = 0;
+    size_t high = parser->recs_valid;
 
-    if (parser->recs_valid == parser->recs_alloc) {
-        const size_t alloc_new = 2 * parser->recs_alloc;
-        const size_t alloc_size = alloc_new * sizeof(*parser->recs);
-        struct parser_rec *recs_new = realloc(parser->recs, alloc_size);
-        if (!recs_new) {
-            return NULL;
+    while (low < high) {
+        const size_t mid = low + (high - low) / 2;
+        if (parser_rec_cmp(&parser->recs[mid], key) < 0) {
+            low = mid + 1;
+        } else {
+            high = mid;
         }
-
-        parser->recs = recs_new;
-        parser->recs_alloc = alloc_new;
-    }
-
-    // Add a new record, sort and return it
-    rec = &parser->recs[parser->recs_valid];
-    rec->session = ctx->session;
-    rec->odid = ctx->odid;
-    rec->ctx = stream_ctx_create(parser, ctx->session);
-    if (!rec->ctx) {
-        return NULL;
     }
 
-    PARSER_INFO(parser, ctx, "New connection detected!", '\0');
-
-    parser->recs_valid++;
-    parser_rec_sort(parser);
-    // Position has been changes... find it again
-    rec = parser_rec_find(parser, ctx);
-    assert(rec != NULL);
-    return rec;
+    return low;
 }
 
 /** Auxiliary structure for garbage after Transport Session removal */
@@ -561,6 +785,213 @@ parser_rec_to_garbage(struct ipx_parser *parser, size_t begin, size_t end)
     return msg;
 }
 
+/**
+ * \brief Report gaps in sequence numbers of a parser record since the previous report
+ * \param[in] parser Parser
+ * \param[in] rec    Parser record
+ */
+static void
+parser_seq_report_rec(struct ipx_parser *parser, struct parser_rec *rec)
+{
+    struct ipx_parser_seq_stats *now = &rec->ctx->seq_stats;
+    struct ipx_parser_seq_stats *prev = &rec->ctx->seq_reported;
+
+    const uint64_t expected = now->recs_expected - prev->recs_expected;
+    const uint64_t received = now->recs_received - prev->recs_received;
+    const uint64_t lost = (expected > received) ? (expected - received) : 0;
+    const uint64_t reorders = now->reorders - prev->reorders;
+    const uint64_t resets = now->resets - prev->resets;
+    *prev = *now;
+
+    if (lost == 0 && reorders == 0 && resets == 0) {
+        return;
+    }
+
+    if (parser->vlevel >= IPX_VERB_WARNING) {
+        // Not rate-limited, the report is already aggregated
+        ipx_verb_print(IPX_VERB_WARNING, "WARNING: %s: [%s, ODID: %" PRIu32 "] Unexpected "
+            "Sequence numbers since the last report (lost Data Records: %" PRIu64 " of %" PRIu64
+            " expected, reordered messages: %" PRIu64 ", resets: %" PRIu64 ").\n",
+            parser->ident, rec->session->ident, rec->odid, lost, expected, reorders, resets);
+    }
+}
+
+/**
+ * \brief Evict the least recently used parser record
+ *
+ * The record is removed from the parser and its stream context is moved into the garbage
+ * container of evicted records, which is returned together with garbage of the next successfully
+ * processed message (see parser_evicted_merge()). Records of blocked Transport Sessions are never
+ * evicted, otherwise the Sessions would be unblocked.
+ * \note The records are not ordered by use, i.e. all records are scanned. However, it happens only
+ *   if a new record is about to be added and the limit of records has been reached.
+ * \param[in] parser Parser
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_NOTFOUND if there is no record that can be evicted
+ * \return #IPX_ERR_NOMEM if a memory allocation has failed (nothing has been evicted)
+ */
+static int
+parser_rec_evict(struct ipx_parser *parser)
+{
+    size_t lru = parser->recs_valid;
+    for (size_t idx = 0; idx < parser->recs_valid; ++idx) {
+        const struct parser_rec *rec = &parser->recs[idx];
+        if ((rec->ctx->flags & SCF_BLOCK) != 0) {
+            continue;
+        }
+
+        if (lru == parser->recs_valid || rec->last_used < parser->recs[lru].last_used) {
+            lru = idx;
+        }
+    }
+
+    if (lru == parser->recs_valid) {
+        return IPX_ERR_NOTFOUND;
+    }
+
+    // Make sure that the garbage can be always added to the container
+    if (parser->evicted == NULL && (parser->evicted = ipx_gc_create()) == NULL) {
+        return IPX_ERR_NOMEM;
+    }
+    if (ipx_gc_reserve(parser->evicted, parser->evicted_cnt + 1) != IPX_OK) {
+        return IPX_ERR_NOMEM;
+    }
+
+    ipx_msg_garbage_t *msg = parser_rec_to_garbage(parser, lru, lru + 1);
+    if (!msg) {
+        return IPX_ERR_NOMEM;
+    }
+
+    int rc = ipx_gc_add_msg(parser->evicted, msg);
+    assert(rc == IPX_OK && "The container should have enough space!");
+    (void) rc;
+    parser->evicted_cnt++;
+    parser->evictions++;
+
+    struct ipx_msg_ctx key;
+    key.session = parser->recs[lru].session;
+    key.odid = parser->recs[lru].odid;
+    parser_seq_report_rec(parser, &parser->recs[lru]);
+    PARSER_WARNING(parser, &key, "The limit of %zu combinations of Transport Sessions and ODIDs "
+        "has been reached. Templates of the least recently used combination have been removed "
+        "(evictions so far: %" PRIu64 ").", parser->recs_max, parser->evictions);
+
+    // Remove the record (the order of the others remains the same)
+    memmove(&parser->recs[lru], &parser->recs[lru + 1],
+        (parser->recs_valid - lru - 1) * sizeof(*parser->recs));
+    parser->recs_valid--;
+    parser_index_rebuild(parser);
+    return IPX_OK;
+}
+
+/**
+ * \brief Merge garbage with garbage of evicted records (if any)
+ *
+ * \note If the garbage cannot be merged, the original garbage is returned and the garbage of
+ *   evicted records is preserved for the next call.
+ * \param[in] parser  Parser
+ * \param[in] garbage Garbage message to merge (can be NULL)
+ * \return Pointer to the merged garbage message or NULL (no garbage available)
+ */
+static ipx_msg_garbage_t *
+parser_evicted_merge(struct ipx_parser *parser, ipx_msg_garbage_t *garbage)
+{
+    if (parser->evicted == NULL) {
+        return garbage;
+    }
+
+    if (garbage != NULL) {
+        if (ipx_gc_add_msg(parser->evicted, garbage) != IPX_OK) {
+            return garbage;
+        }
+        parser->evicted_cnt++;
+    }
+
+    ipx_msg_garbage_t *msg = ipx_gc_to_msg(parser->evicted);
+    if (!msg) {
+        // The garbage remains in the container, try it again later
+        return NULL;
+    }
+
+    parser->evicted = NULL;
+    parser->evicted_cnt = 0;
+    return msg;
+}
+
+/**
+ * \brief Get a parser record defined by Transport Session and Observation Domain ID within
+ *   a parser
+ *
+ * The function will try to find and return the required record. If the record doesn't exist
+ * a new one will be created. If the maximum number of records has been reached, the least
+ * recently used record is evicted first (see parser_rec_evict()).
+ * \param[in] parser Parser structure
+ * \param[in] ctx    IPFIX Message context (info about Transport Session, ODID)
+ * \return Pointer or NULL (memory allocation error)
+ */
+static struct parser_rec *
+parser_rec_get(struct ipx_parser *parser, const struct ipx_msg_ctx *ctx)
+{
+    // Try to find a record first
+    struct parser_rec *rec = parser_rec_find(parser, ctx);
+    if (rec != NULL) {
+        return rec;
+    }
+
+    if (parser->recs_max != 0 && parser->recs_valid >= parser->recs_max) {
+        // Make space for the new record (if it isn't possible, the limit is exceeded)
+        parser_rec_evict(parser);
+    }
+
+    if (parser->recs_valid == parser->recs_alloc) {
+        const size_t alloc_new = 2 * parser->recs_alloc;
+        const size_t alloc_size = alloc_new * sizeof(*parser->recs);
+        struct parser_rec *recs_new = realloc(parser->recs, alloc_size);
+        if (!recs_new) {
+            return NULL;
+        }
+
+        // Positions of the records haven't changed, but the cache could point to old memory
+        parser->recs = recs_new;
+        parser->last.rec = NULL;
+        parser->last.info = NULL;
+
+        size_t *index_new = realloc(parser->index, 2 * alloc_new * sizeof(*parser->index));
+        if (!index_new) {
+            return NULL;
+        }
+
+        parser->index = index_new;
+        parser->index_size = 2 * alloc_new;
+        parser->recs_alloc = alloc_new;
+    }
+
+    struct parser_rec key;
+    key.session = ctx->session;
+    key.odid = ctx->odid;
+    key.last_used = parser->clock;
+    key.ctx = stream_ctx_create(parser, ctx->session);
+    if (!key.ctx) {
+        return NULL;
+    }
+
+    if (parser->state_cnt > 0 && ctx->session->type == FDS_SESSION_UDP) {
+        // Templates will be restored when the type of the flow source is known
+        key.ctx->flags |= SCF_RESTORE;
+    }
+
+    PARSER_INFO(parser, ctx, "New connection detected!", '\0');
+
+    // Insert the record at its position (the array remains sorted) and update the index
+    const size_t pos = parser_rec_lower_bound(parser, &key);
+    rec = &parser->recs[pos];
+    memmove(rec + 1, rec, (parser->recs_valid - pos) * sizeof(*rec));
+    *rec = key;
+    parser->recs_valid++;
+    parser_index_rebuild(parser);
+    return rec;
+}
+
 /**
  * \brief Compare sequence numbers (with wraparound support)
  * \param t1 First number
@@ -591,9 +1022,17 @@ struct ipx_parser_data {
     struct ipx_msg_ipfix *ipfix_msg;
     /** Template manager                                */
     fds_tmgr_t *tmgr;
+    /** Stream context (owner of the Template manager)  */
+    struct stream_ctx *sctx;
+    /** Current Template snapshot (NULL, if must be obtained from the manager) */
+    const fds_tsnapshot_t *snap;
 
     /** Number of parser data records                   */
     uint16_t data_recs;
+    /** Number of parser data records of recovered Data Sets (see parser_pending_attach()) */
+    uint16_t recovered_recs;
+    /** Start of recovered Data Sets in the message (NULL, if none) */
+    const uint8_t *recovered;
     /** Templates added/removed                         */
     bool tmplt_changes;
 };
@@ -628,6 +1067,10 @@ parser_parse_withdrawal(struct ipx_parser_data *pdata, struct fds_ipfix_wdrl_tre
         return IPX_OK;
     }
 
+    // Templates will be changed
+    pdata->tmplt_changes = true;
+    pdata->snap = NULL;
+
     int rc;
     if (tid >= FDS_IPFIX_SET_MIN_DSET) {
         // (Options) Template Withdrawal
@@ -647,6 +1090,7 @@ parser_parse_withdrawal(struct ipx_parser_data *pdata, struct fds_ipfix_wdrl_tre
 
     if (rc == FDS_OK) {
         // Success
+        IPX_TRACE4(template_withdraw, pdata->parser, msg_ctx->odid, tid, type);
         if (tid >= FDS_IPFIX_SET_MIN_DSET) {
             PARSER_INFO(pdata->parser, msg_ctx, "A definition of the %s ID %" PRIu16 " has been "
                 "withdrawn.", (type == FDS_TYPE_TEMPLATE) ? "Template" : "Options Template", tid);
@@ -667,6 +1111,7 @@ parser_parse_withdrawal(struct ipx_parser_data *pdata, struct fds_ipfix_wdrl_tre
 
         rc = fds_tmgr_template_withdraw(pdata->tmgr, tid, FDS_TYPE_TEMPLATE_UNDEF);
         if (rc == FDS_OK) {
+            IPX_TRACE4(template_withdraw, pdata->parser, msg_ctx->odid, tid, type);
             PARSER_INFO(pdata->parser, msg_ctx, "A definition of the %s ID %" PRIu16 " has been "
                 "withdrawn.", (type == FDS_TYPE_TEMPLATE) ? "Template" : "Options Template", tid);
             return IPX_OK;
@@ -697,6 +1142,98 @@ parser_parse_withdrawal(struct ipx_parser_data *pdata, struct fds_ipfix_wdrl_tre
     }
 }
 
+/**
+ * \brief Compute a hash of a raw (Options) Template definition (FNV-1a)
+ * \param[in] raw  Raw definition
+ * \param[in] size Size of the definition
+ * \param[in] type Type of the template
+ * \return Hash value
+ */
+static inline uint64_t
+parser_tcache_hash(const uint8_t *raw, uint16_t size, enum fds_template_type type)
+{
+    uint64_t hash = 14695981039346656037ULL ^ (uint64_t) type;
+    for (uint16_t i = 0; i < size; ++i) {
+        hash ^= raw[i];
+        hash *= 1099511628211ULL;
+    }
+
+    return hash;
+}
+
+/**
+ * \brief Parse an (Options) Template definition using the cache of parsed definitions
+ *
+ * Exporters of the same type usually send byte-identical definitions and each exporter also
+ * periodically refreshes its definitions. If the same definition has been already parsed, the
+ * parsed template is just copied. Otherwise the definition is parsed and (if possible) stored
+ * into the cache, where it replaces the previous definition with the same hash slot.
+ * \note Templates are owned by Template managers, therefore, each one still gets its own copy.
+ * \param[in]     parser Parser
+ * \param[in]     type   Type of the template
+ * \param[in]     rec    Raw definition
+ * \param[in,out] size   Size of the definition (see fds_template_parse())
+ * \param[out]    tmplt  Parsed template
+ * \return Same as fds_template_parse()
+ */
+static int
+parser_tcache_parse(struct ipx_parser *parser, enum fds_template_type type, void *rec,
+    uint16_t *size, struct fds_template **tmplt)
+{
+    if (!parser->tcache) {
+        parser->tcache = calloc(PARSER_TCACHE_SLOTS, sizeof(*parser->tcache));
+        if (!parser->tcache) {
+            // The cache is optional
+            return fds_template_parse(type, rec, size, tmplt);
+        }
+    }
+
+    const uint8_t *raw = rec;
+    const uint16_t raw_size = *size;
+    const uint64_t hash = parser_tcache_hash(raw, raw_size, type);
+    struct parser_tcache_slot *slot = &parser->tcache[hash & (PARSER_TCACHE_SLOTS - 1)];
+
+    if (slot->raw != NULL && slot->hash == hash && slot->type == type && slot->size == raw_size
+            && memcmp(slot->raw, raw, raw_size) == 0) {
+        // Already parsed
+        struct fds_template *copy = fds_template_copy(slot->tmplt);
+        if (!copy) {
+            return FDS_ERR_NOMEM;
+        }
+
+        *tmplt = copy;
+        return FDS_OK;
+    }
+
+    int rc = fds_template_parse(type, rec, size, tmplt);
+    if (rc != FDS_OK) {
+        return rc;
+    }
+
+    // Store the definition into the cache (failure is not fatal)
+    struct fds_template *proto = fds_template_copy(*tmplt);
+    uint8_t *raw_copy = (proto != NULL) ? malloc(raw_size) : NULL;
+    if (!raw_copy) {
+        if (proto != NULL) {
+            fds_template_destroy(proto);
+        }
+        return FDS_OK;
+    }
+
+    memcpy(raw_copy, raw, raw_size);
+    if (slot->raw != NULL) {
+        free(slot->raw);
+        fds_template_destroy(slot->tmplt);
+    }
+
+    slot->hash = hash;
+    slot->type = type;
+    slot->size = raw_size;
+    slot->raw = raw_copy;
+    slot->tmplt = proto;
+    return FDS_OK;
+}
+
 /**
  * \brief Process an (Options) Template definition
  *
@@ -722,8 +1259,26 @@ parser_parse_def(struct ipx_parser_data *pdata, void *rec, enum fds_template_typ
     PARSER_DEBUG(pdata->parser, msg_ctx, "Processing a definition of %s ID %" PRIu16 " ...",
         (type == FDS_TYPE_TEMPLATE) ? "Template" : "Options Template", tid);
 
-    // Parse the (Options) Template
-    if ((rc = fds_template_parse(type, rec, &size, &tmplt)) != FDS_OK) {
+    // Is it just a refresh of the current definition?
+    const struct fds_template *tmplt_old;
+    if (fds_tmgr_template_get(pdata->tmgr, tid, &tmplt_old) == FDS_OK && tmplt_old->type == type
+            && tmplt_old->raw.length == size && memcmp(tmplt_old->raw.data, rec, size) == 0) {
+        if (msg_ctx->session->type != FDS_SESSION_UDP) {
+            // Nothing to do, other session types don't have timeouts of templates
+            PARSER_DEBUG(pdata->parser, msg_ctx, "The definition of the %s ID %" PRIu16 " has "
+                "been refreshed (unchanged).", (type == FDS_TYPE_TEMPLATE)
+                ? "Template" : "Options Template", tid);
+            return IPX_OK;
+        }
+
+        // Only the timeout must be refreshed, i.e. the definition doesn't have to be parsed
+        tmplt = fds_template_copy(tmplt_old);
+        if (!tmplt) {
+            PARSER_ERROR(pdata->parser, msg_ctx, "A memory allocation failed (%s:%d).",
+                __FILE__, __LINE__);
+            return IPX_ERR_NOMEM;
+        }
+    } else if ((rc = parser_tcache_parse(pdata->parser, type, rec, &size, &tmplt)) != FDS_OK) {
         // Something bad happened
         switch (rc) {
         case FDS_ERR_FORMAT:
@@ -745,6 +1300,8 @@ parser_parse_def(struct ipx_parser_data *pdata, void *rec, enum fds_template_typ
     }
 
     // Add (Options) Template
+    pdata->tmplt_changes = true;
+    pdata->snap = NULL;
     if ((rc = fds_tmgr_template_add(pdata->tmgr, tmplt)) != FDS_OK) {
         // Something bad happened
         fds_template_destroy(tmplt);
@@ -768,6 +1325,7 @@ parser_parse_def(struct ipx_parser_data *pdata, void *rec, enum fds_template_typ
         }
     }
 
+    IPX_TRACE4(template_add, pdata->parser, msg_ctx->odid, tid, type);
     PARSER_INFO(pdata->parser, msg_ctx, "A definition of the %s ID %" PRIu16 " has been accepted.",
         (type == FDS_TYPE_TEMPLATE) ? "Template" : "Options Template", tid);
 
@@ -788,9 +1346,6 @@ parser_parse_def(struct ipx_parser_data *pdata, void *rec, enum fds_template_typ
 static inline int
 parser_parse_tset(struct ipx_parser_data *pdata, struct fds_ipfix_set_hdr *tset)
 {
-    // Processing templates
-    pdata->tmplt_changes = true;
-
     uint16_t set_id = ntohs(tset->flowset_id);
     assert(set_id == FDS_IPFIX_SET_TMPLT || set_id == FDS_IPFIX_SET_OPTS_TMPLT);
     // Get type of the templates
@@ -834,28 +1389,194 @@ parser_parse_tset(struct ipx_parser_data *pdata, struct fds_ipfix_set_hdr *tset)
 }
 
 /**
- * \brief Parser Data Records in an IPFIX Set
+ * \brief Parse Data Records of a fixed-length (Options) Template in an IPFIX Set
  *
- * First, find an (Options) Template necessary to decode structure of records in this Set and
- * then detect the start position of each Data Record and mark it.
+ * All records have the same length, therefore, the number of records is given by the length of
+ * the Set and the records are split by a simple stride (positions of fields within each record
+ * are already precomputed by the Template, see fds_tfield::offset). Remaining bytes shorter than
+ * a record are considered as padding (the same as fds_dset_iter_next()).
  * \param[in,out] pdata Parser internal data (Message context, Template manager, etc.)
  * \param[in]     dset  Pointer to the Set header
- * \return #IPX_OK on success (all records successfully processed)
- * \return #IPX_ERR_FORMAT if an unexpected formatting error has been detected
- * \return #IPX_ERR_ARG in case of an internal error
+ * \param[in]     tmplt Fixed-length (Options) Template of the records
+ * \param[in]     snap  Template snapshot
+ * \return #IPX_OK on success
  * \return #IPX_ERR_NOMEM if a memory allocation error has occurred
  */
 static inline int
-parser_parse_dset(struct ipx_parser_data *pdata, struct fds_ipfix_set_hdr *dset)
+parser_parse_dset_fixed(struct ipx_parser_data *pdata, struct fds_ipfix_set_hdr *dset,
+    const struct fds_template *tmplt, const fds_tsnapshot_t *snap)
 {
-    uint16_t set_id = ntohs(dset->flowset_id);
-    assert(set_id >= FDS_IPFIX_SET_MIN_DSET);
+    // Length of the Set has been already checked by the Set iterator
+    const uint16_t rec_len = tmplt->data_length;
+    const uint16_t set_len = ntohs(dset->length);
+    assert(rec_len > 0 && set_len >= FDS_IPFIX_SET_HDR_LEN);
+    const uint32_t rec_cnt = (uint32_t) (set_len - FDS_IPFIX_SET_HDR_LEN) / rec_len;
+    if (rec_cnt == 0) {
+        return IPX_OK;
+    }
 
-    // Find a Snapshot
-    int rc;
-    const fds_tsnapshot_t *snap;
-    if ((rc = fds_tmgr_snapshot_get(pdata->tmgr, &snap)) != FDS_OK) {
-        // Something bad happened
+    if (pdata->parser->relay) {
+        pdata->data_recs += rec_cnt;
+        return IPX_OK;
+    }
+
+    struct ipx_ipfix_record *first = ipx_msg_ipfix_add_drec_refs(&pdata->ipfix_msg, rec_cnt);
+    if (!first) {
+        const struct ipx_msg_ctx *msg_ctx = &pdata->ipfix_msg->ctx;
+        PARSER_ERROR(pdata->parser, msg_ctx, "Memory allocation failed (%s:%d).",
+            __FILE__, __LINE__);
+        return IPX_ERR_NOMEM;
+    }
+
+    const size_t ref_size = pdata->ipfix_msg->rec_info.rec_size;
+    uint8_t *ref_ptr = (uint8_t *) first;
+    uint8_t *rec_ptr = ((uint8_t *) dset) + FDS_IPFIX_SET_HDR_LEN;
+    for (uint32_t i = 0; i < rec_cnt; ++i, ref_ptr += ref_size, rec_ptr += rec_len) {
+        struct fds_drec *rec = &((struct ipx_ipfix_record *) ref_ptr)->rec;
+        rec->data = rec_ptr;
+        rec->size = rec_len;
+        rec->tmplt = tmplt;
+        rec->snap = snap;
+    }
+
+    pdata->data_recs += rec_cnt;
+    return IPX_OK;
+}
+
+/**
+ * \brief Parse Data Records of a variable-length (Options) Template in an IPFIX Set
+ *
+ * Only the length prefixes of variable-length fields are needed to find the boundaries of
+ * records. Therefore, the Template is converted (once per Set) into a list of segments where each
+ * one consists of a run of fixed-length fields (skipped at once) followed by a variable-length
+ * field. Remaining bytes shorter than the minimal length of a record are considered as padding
+ * (the same as fds_dset_iter_next()).
+ *
+ * If the Set is malformed, all references added by this function are removed and the caller
+ * should use the generic iterator to report the failure.
+ * \param[in,out] pdata Parser internal data (Message context, Template manager, etc.)
+ * \param[in]     dset  Pointer to the Set header
+ * \param[in]     tmplt Variable-length (Options) Template of the records
+ * \param[in]     snap  Template snapshot
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_FORMAT if the Set is malformed
+ * \return #IPX_ERR_NOTFOUND if the Template has too many variable-length fields (not processed)
+ * \return #IPX_ERR_NOMEM if a memory allocation error has occurred
+ */
+static inline int
+parser_parse_dset_var(struct ipx_parser_data *pdata, struct fds_ipfix_set_hdr *dset,
+    const struct fds_template *tmplt, const fds_tsnapshot_t *snap)
+{
+    // Length of fixed-length fields before each variable-length field (+ trailing fields)
+    uint32_t segs[PARSER_VAR_SEGS + 1];
+    uint32_t seg_cnt = 0;
+    uint32_t rec_min = 0;
+
+    segs[0] = 0;
+    for (uint16_t i = 0; i < tmplt->fields_cnt_total; ++i) {
+        const uint16_t field_len = tmplt->fields[i].length;
+        if (field_len != FDS_IPFIX_VAR_IE_LEN) {
+            segs[seg_cnt] += field_len;
+            rec_min += field_len;
+            continue;
+        }
+
+        if (seg_cnt == PARSER_VAR_SEGS) {
+            return IPX_ERR_NOTFOUND;
+        }
+
+        segs[++seg_cnt] = 0;
+        rec_min += 1U; // At least the length prefix
+    }
+
+    assert(rec_min > 0);
+    const uint8_t *rec_ptr = ((const uint8_t *) dset) + FDS_IPFIX_SET_HDR_LEN;
+    const uint8_t *set_end = ((const uint8_t *) dset) + ntohs(dset->length);
+    const bool relay = pdata->parser->relay;
+    uint32_t rec_cnt = 0;
+
+    while ((uint32_t) (set_end - rec_ptr) >= rec_min) {
+        const uint8_t *ptr = rec_ptr;
+        for (uint32_t seg = 0; seg < seg_cnt; ++seg) {
+            ptr += segs[seg];
+            if (ptr >= set_end) {
+                goto malformed;
+            }
+
+            uint32_t field_len = *ptr++;
+            if (field_len == 255U) {
+                // Long variable-length prefix (3 bytes in total)
+                if (set_end - ptr < 2) {
+                    goto malformed;
+                }
+                field_len = ((uint32_t) ptr[0] << 8) | ptr[1];
+                ptr += 2;
+            }
+
+            if ((uint32_t) (set_end - ptr) < field_len) {
+                goto malformed;
+            }
+            ptr += field_len;
+        }
+
+        if ((uint32_t) (set_end - ptr) < segs[seg_cnt]) {
+            goto malformed;
+        }
+        ptr += segs[seg_cnt];
+
+        if (!relay) {
+            struct ipx_ipfix_record *added_ref = ipx_msg_ipfix_add_drec_ref(&pdata->ipfix_msg);
+            if (!added_ref) {
+                const struct ipx_msg_ctx *msg_ctx = &pdata->ipfix_msg->ctx;
+                PARSER_ERROR(pdata->parser, msg_ctx, "Memory allocation failed (%s:%d).",
+                    __FILE__, __LINE__);
+                return IPX_ERR_NOMEM;
+            }
+
+            added_ref->rec.data = (uint8_t *) rec_ptr;
+            added_ref->rec.size = (uint16_t) (ptr - rec_ptr);
+            added_ref->rec.tmplt = tmplt;
+            added_ref->rec.snap = snap;
+        }
+        rec_cnt++;
+        rec_ptr = ptr;
+    }
+
+    pdata->data_recs += rec_cnt;
+    return IPX_OK;
+
+malformed:
+    // Remove already added records of the Set
+    if (!relay) {
+        pdata->ipfix_msg->rec_info.cnt_valid -= rec_cnt;
+    }
+    return IPX_ERR_FORMAT;
+}
+
+/**
+ * \brief Get the current Template snapshot
+ *
+ * The snapshot is obtained from the Template manager only once per IPFIX Message unless
+ * (Options) Templates have been changed in the meantime. If the snapshot differs from the one
+ * previously used within the Stream context, the generation of the snapshot is incremented.
+ * \param[in,out] pdata Parser internal data (Message context, Template manager, etc.)
+ * \param[out]    snap  Template snapshot
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_ARG in case of an internal error
+ * \return #IPX_ERR_NOMEM if a memory allocation error has occurred
+ */
+static inline int
+parser_snapshot_get(struct ipx_parser_data *pdata, const fds_tsnapshot_t **snap)
+{
+    if (pdata->snap != NULL) {
+        *snap = pdata->snap;
+        return IPX_OK;
+    }
+
+    int rc;
+    const fds_tsnapshot_t *snap_new;
+    if ((rc = fds_tmgr_snapshot_get(pdata->tmgr, &snap_new)) != FDS_OK) {
+        // Something bad happened
         const struct ipx_msg_ctx *msg_ctx = &pdata->ipfix_msg->ctx;
         if (rc == FDS_ERR_NOMEM) {
             // Memory allocation failure
@@ -870,24 +1591,143 @@ parser_parse_dset(struct ipx_parser_data *pdata, struct fds_ipfix_set_hdr *dset)
         }
     }
 
+    if (pdata->sctx->snap != snap_new) {
+        pdata->sctx->snap = snap_new;
+        pdata->sctx->snap_gen++;
+    }
+
+    pdata->snap = snap_new;
+    *snap = snap_new;
+    return IPX_OK;
+}
+
+/**
+ * \brief Buffer a Data Set with an unknown (Options) Template
+ *
+ * A copy of the Set is kept in the stream context until its template is received (see
+ * parser_pending_attach()) or it expires. Only Sets of UDP Transport Sessions are buffered.
+ * \param[in] pdata Parser internal data (Message context, Stream context, etc.)
+ * \param[in] dset  Pointer to the Set header
+ * \return #IPX_OK if the Set has been buffered
+ * \return #IPX_ERR_DENIED if buffering is disabled, the limit has been reached or the Set has
+ *   been already recovered once
+ * \return #IPX_ERR_NOMEM if a memory allocation error has occurred
+ */
+static int
+parser_pending_add(struct ipx_parser_data *pdata, const struct fds_ipfix_set_hdr *dset)
+{
+    struct ipx_parser *parser = pdata->parser;
+    struct stream_ctx *sctx = pdata->sctx;
+    const struct ipx_msg_ipfix *msg = pdata->ipfix_msg;
+
+    if (parser->pending.size_max == 0 || msg->ctx.session->type != FDS_SESSION_UDP) {
+        return IPX_ERR_DENIED;
+    }
+
+    const uint16_t size = ntohs(dset->length);
+    if ((pdata->recovered != NULL && (const uint8_t *) dset >= pdata->recovered)
+            || sctx->pending_size + size > parser->pending.size_max) {
+        // The template is still missing or too many Sets are waiting
+        parser->pending.stats.expired++;
+        return IPX_ERR_DENIED;
+    }
+
+    if (sctx->pending_cnt == sctx->pending_alloc) {
+        const uint32_t alloc_new = (sctx->pending_alloc == 0) ? 4U : 2U * sctx->pending_alloc;
+        struct pending_set *pending_new = realloc(sctx->pending, alloc_new * sizeof(*pending_new));
+        if (!pending_new) {
+            return IPX_ERR_NOMEM;
+        }
+
+        sctx->pending = pending_new;
+        sctx->pending_alloc = alloc_new;
+    }
+
+    uint8_t *data = malloc(size);
+    if (!data) {
+        return IPX_ERR_NOMEM;
+    }
+
+    memcpy(data, dset, size);
+    const struct fds_ipfix_msg_hdr *msg_hdr = (const struct fds_ipfix_msg_hdr *) msg->raw_pkt;
+    struct pending_set *pending = &sctx->pending[sctx->pending_cnt++];
+    pending->export_time = ntohl(msg_hdr->export_time);
+    pending->size = size;
+    pending->attach = false;
+    pending->data = data;
+    sctx->pending_size += size;
+    parser->pending.stats.buffered++;
+    return IPX_OK;
+}
+
+/**
+ * \brief Parser Data Records in an IPFIX Set
+ *
+ * First, find an (Options) Template necessary to decode structure of records in this Set and
+ * then detect the start position of each Data Record and mark it.
+ * \param[in,out] pdata Parser internal data (Message context, Template manager, etc.)
+ * \param[in]     dset  Pointer to the Set header
+ * \return #IPX_OK on success (all records successfully processed)
+ * \return #IPX_ERR_FORMAT if an unexpected formatting error has been detected
+ * \return #IPX_ERR_ARG in case of an internal error
+ * \return #IPX_ERR_NOMEM if a memory allocation error has occurred
+ */
+static inline int
+parser_parse_dset(struct ipx_parser_data *pdata, struct fds_ipfix_set_hdr *dset)
+{
+    uint16_t set_id = ntohs(dset->flowset_id);
+    assert(set_id >= FDS_IPFIX_SET_MIN_DSET);
+
+    // Find a Snapshot
+    int rc;
+    const fds_tsnapshot_t *snap;
+    if ((rc = parser_snapshot_get(pdata, &snap)) != IPX_OK) {
+        return rc;
+    }
+
     // Find an (Options) Template
     const struct fds_template *tmplt = fds_tsnapshot_template_get(snap, set_id);
     if (!tmplt) {
         const struct ipx_msg_ctx *msg_ctx = &pdata->ipfix_msg->ctx;
+        if (parser_pending_add(pdata, dset) == IPX_OK) {
+            PARSER_DEBUG(pdata->parser, msg_ctx, "IPFIX Data Set %" PRIu16 " has been buffered "
+                "until its (Options) Template is received.", set_id);
+            return IPX_OK;
+        }
+
         PARSER_WARNING(pdata->parser, msg_ctx, "Unable to parse IPFIX Data Set %" PRIu16 " "
             "due to missing (Options) Template.", set_id);
         return IPX_OK;
     }
 
+    if ((tmplt->flags & FDS_TEMPLATE_DYNAMIC) == 0 && tmplt->data_length > 0) {
+        // Fast path, all records have the same length
+        return parser_parse_dset_fixed(pdata, dset, tmplt, snap);
+    }
+
+    if ((tmplt->flags & FDS_TEMPLATE_DYNAMIC) != 0) {
+        // Only length prefixes of variable-length fields are read
+        rc = parser_parse_dset_var(pdata, dset, tmplt, snap);
+        if (rc != IPX_ERR_FORMAT && rc != IPX_ERR_NOTFOUND) {
+            return rc;
+        }
+        // Otherwise use the generic iterator (e.g. to describe what's wrong with the Set)
+    }
+
     struct fds_drec rec;
     rec.tmplt = tmplt;
     rec.snap = snap;
 
-    // Parse Data Records in the Set
+    // Parse Data Records in the Set (variable-length fields must be walked through)
     struct fds_dset_iter it;
     fds_dset_iter_init(&it, dset, tmplt);
 
     while ((rc = fds_dset_iter_next(&it)) == FDS_OK) {
+        if (pdata->parser->relay) {
+            pdata->data_recs++;
+            continue;
+        }
+
         // Add a new record
         rec.data = it.rec;
         rec.size = it.size;
@@ -916,6 +1756,7 @@ parser_parse_dset(struct ipx_parser_data *pdata, struct fds_ipfix_set_hdr *dset)
         "%" PRIu16 " (%s).", set_id, fds_dset_iter_err(&it));
 
     // Try to remove the Template definition
+    pdata->snap = NULL;
     rc = fds_tmgr_template_remove(pdata->tmgr, set_id, FDS_TYPE_TEMPLATE_UNDEF);
     switch (rc) {
     case FDS_OK:
@@ -941,7 +1782,9 @@ parser_parse_dset(struct ipx_parser_data *pdata, struct fds_ipfix_set_hdr *dset)
  *
  * Iterate over each IPFIX Set and process records. Based on content of the Message, (Options)
  * Templates can be added/removed to the Template manager. Positions of Data records in the Message
- * and references to their Templates will be marked in the wrapper.
+ * and references to their Templates will be marked in the wrapper (unless only counted, see
+ * ipx_parser_relay_set()). References to the Sets hold the number of their Data Records and
+ * the Template snapshot used to find them.
  *
  * \param[in,out] pdata Parser internal data (Message context, Template manager, etc.)
  * \return #IPX_OK on success
@@ -963,6 +1806,7 @@ parser_parse_message(struct ipx_parser_data *pdata)
     // Iterate over all Sets in the IPFIX Message
     while (rc_parse == IPX_OK && (rc_iter = fds_sets_iter_next(&it)) == FDS_OK) {
         uint16_t set_id = ntohs(it.set->flowset_id);
+        const uint16_t recs_before = pdata->data_recs;
 
         if (set_id >= FDS_IPFIX_SET_MIN_DSET) {
             // Data Set
@@ -988,6 +1832,11 @@ parser_parse_message(struct ipx_parser_data *pdata)
         }
 
         set_ref->ptr = it.set;
+        set_ref->drec_cnt = (uint16_t) (pdata->data_recs - recs_before);
+        set_ref->snap = (set_ref->drec_cnt > 0) ? pdata->snap : NULL;
+        if (pdata->recovered != NULL && (const uint8_t *) it.set >= pdata->recovered) {
+            pdata->recovered_recs += set_ref->drec_cnt;
+        }
     }
 
     if (rc_parse != IPX_OK) {
@@ -1019,6 +1868,9 @@ parser_session_block_all(ipx_parser_t *parser)
         struct stream_ctx *ctx = parser->recs[idx].ctx;
         ctx->flags |= SCF_BLOCK;
     }
+
+    parser->last.rec = NULL;
+    parser->last.info = NULL;
 }
 
 /**
@@ -1050,9 +1902,29 @@ parser_convert(ipx_parser_t *parser, struct parser_rec *rec, ipx_msg_ipfix_t *ms
 
     // Determine the version of flow message
     const uint16_t version = ntohs(*(uint16_t *) msg_data);
+    // sFlow has a 32-bit version number (i.e. the first 16 bits are always zero)
+    const bool is_sflow = (version == 0 && msg_size >= sizeof(uint32_t)
+        && ntohl(*(uint32_t *) msg_data) == IPX_SFLOW_VERSION);
 
     enum source_type type = rec->ctx->type;
-    if (type == ST_UNKNOWN) {
+    if (type == ST_UNKNOWN && is_sflow) {
+        // sFlow v5 (+ initialize converter)
+        rec->ctx->type = ST_SFLOW5;
+
+        // Determine suitable Template refresh interval
+        uint32_t tmplt_refresh = 0; // disabled
+        if (rec->session->type == FDS_SESSION_UDP) {
+            // Lifetime should be at least 3x higher than refresh interval
+            tmplt_refresh = rec->session->udp.lifetime.tmplts / 3U;
+        }
+
+        rec->ctx->converter.sflow = ipx_sflow_conv_init(parser->ident, parser->vlevel,
+            tmplt_refresh, rec->odid);
+        if (!rec->ctx->converter.sflow) {
+            PARSER_ERROR(parser, msg_ctx, "Failed to initialize sFlow v5 converter!", '\0');
+            return IPX_ERR_NOMEM;
+        }
+    } else if (type == ST_UNKNOWN) {
         // This is the first message that we received for processing
         switch (version) {
         case FDS_IPFIX_VERSION:
@@ -1089,7 +1961,7 @@ parser_convert(ipx_parser_t *parser, struct parser_rec *rec, ipx_msg_ipfix_t *ms
             break;
         default:
             PARSER_ERROR(parser, msg_ctx, "Unexpected NetFlow/IPFIX message version (expected: "
-                "5,9 or 10, got: %" PRIu16 ")", version);
+                "5,9 or 10 or sFlow 5, got: %" PRIu16 ")", version);
             return IPX_ERR_DENIED;
         }
     }
@@ -1130,6 +2002,16 @@ parser_convert(ipx_parser_t *parser, struct parser_rec *rec, ipx_msg_ipfix_t *ms
 
         conv_status = ipx_nf5_conv_process(rec->ctx->converter.nf5, msg);
         break;
+    case ST_SFLOW5:
+        // sFlow v5 -> convert to IPFIX
+        if (!is_sflow) {
+            PARSER_ERROR(parser, msg_ctx, "Expected sFlow v5 Datagram but non-sFlow data has "
+                "been received (got version: %" PRIu16 ")", version);
+            return IPX_ERR_FORMAT;
+        }
+
+        conv_status = ipx_sflow_conv_process(rec->ctx->converter.sflow, msg);
+        break;
     default:
         PARSER_ERROR(parser, msg_ctx, "Unimplemented support for message format conversion!", '\0');
         return IPX_ERR_DENIED;
@@ -1157,8 +2039,17 @@ ipx_parser_create(const char *ident, enum ipx_verb_level vlevel)
         return NULL;
     }
 
+    parser->index_size = 2 * PARSER_DEF_RECS;
+    parser->index = malloc(parser->index_size * sizeof(*parser->index));
+    if (!parser->index) {
+        free(parser->recs);
+        free(parser);
+        return NULL;
+    }
+
     parser->ident = strdup(ident);
     if (!parser->ident) {
+        free(parser->index);
         free(parser->recs);
         free(parser);
         return NULL;
@@ -1167,18 +2058,41 @@ ipx_parser_create(const char *ident, enum ipx_verb_level vlevel)
     parser->vlevel = vlevel;
     parser->recs_alloc = PARSER_DEF_RECS;
     parser->ie_mgr = NULL;
+    parser_index_rebuild(parser);
     return parser;
 }
 
 void
 ipx_parser_destroy(ipx_parser_t *parser)
 {
-    // Destroy all stream contexts
+    // Destroy all stream contexts (including evicted ones)
+    ipx_gc_destroy(parser->evicted);
     for (size_t idx = 0; idx < parser->recs_valid; ++idx) {
         stream_ctx_destroy(parser->recs[idx].ctx);
     }
 
+    // Destroy the cache of parsed templates
+    if (parser->tcache != NULL) {
+        for (size_t idx = 0; idx < PARSER_TCACHE_SLOTS; ++idx) {
+            struct parser_tcache_slot *slot = &parser->tcache[idx];
+            if (slot->raw == NULL) {
+                continue;
+            }
+
+            free(slot->raw);
+            fds_template_destroy(slot->tmplt);
+        }
+        free(parser->tcache);
+    }
+
+    // Destroy waiting flow sources (loaded from state files or removed)
+    for (size_t idx = 0; idx < parser->state_cnt; ++idx) {
+        free(parser->state[idx].data);
+    }
+    free(parser->state);
+
     free(parser->ident);
+    free(parser->index);
     free(parser->recs);
     free(parser);
 }
@@ -1203,92 +2117,637 @@ ipx_parser_verb(ipx_parser_t *parser, enum ipx_verb_level *v_new, enum ipx_verb_
             if (ctx->type == ST_NETFLOW9 && ctx->converter.nf9 != NULL) {
                 ipx_nf9_conv_verb(ctx->converter.nf9, *v_new);
             }
+            if (ctx->type == ST_SFLOW5 && ctx->converter.sflow != NULL) {
+                ipx_sflow_conv_verb(ctx->converter.sflow, *v_new);
+            }
         }
     }
 }
 
-int
-ipx_parser_process(ipx_parser_t *parser, ipx_msg_ipfix_t **ipfix, ipx_msg_garbage_t **garbage)
+/**
+ * \brief Get identification of a flow source in a state file
+ * \param[in]  session Transport Session (must be UDP)
+ * \param[in]  odid    Observation Domain ID
+ * \param[out] hdr     Header of the flow source (the number of templates is set to zero)
+ */
+static void
+parser_state_key(const struct ipx_session *session, uint32_t odid, struct parser_state_hdr *hdr)
 {
-    *garbage = NULL;
-    const struct ipx_msg_ctx *msg_ctx = &(*ipfix)->ctx;
-
-    // Find a Stream Info
-    struct parser_rec *rec;   // Combination of Transport Session, ODID
-    struct stream_info *info; // Combination of Transport Session, ODID and Stream ID
-    if ((rec = parser_rec_get(parser, msg_ctx)) == NULL) {
-        PARSER_ERROR(parser, msg_ctx, "A memory allocation failed (%s:%d).", __FILE__, __LINE__);
-        return IPX_ERR_NOMEM;
+    const struct ipx_session_net *net = &session->udp.net;
+    memset(hdr, 0, sizeof(*hdr));
+    hdr->odid = odid;
+    hdr->port_src = net->port_src;
+    hdr->port_dst = net->port_dst;
+    hdr->l3_proto = net->l3_proto;
+
+    if (net->l3_proto == AF_INET) {
+        memcpy(hdr->addr_src, &net->addr_src.ipv4, sizeof(net->addr_src.ipv4));
+        memcpy(hdr->addr_dst, &net->addr_dst.ipv4, sizeof(net->addr_dst.ipv4));
+    } else {
+        memcpy(hdr->addr_src, &net->addr_src.ipv6, sizeof(net->addr_src.ipv6));
+        memcpy(hdr->addr_dst, &net->addr_dst.ipv6, sizeof(net->addr_dst.ipv6));
     }
+}
 
-    if ((rec->ctx->flags & SCF_BLOCK) != 0) {
-        // This Transport Session has been blocked due to previous invalid behaviour
-        return IPX_ERR_DENIED;
+/**
+ * \brief Get the current monotonic time of waiting flow sources
+ * \return Number of seconds
+ */
+static uint64_t
+parser_state_now()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC_COARSE, &ts);
+    return (uint64_t) ts.tv_sec;
+}
+
+/**
+ * \brief Get the lifetime of (Options) Templates of a Transport Session
+ * \param[in] session Transport Session (must be UDP)
+ * \return Longer of Template and Options Template lifetimes in seconds (0 = unlimited)
+ */
+static uint32_t
+parser_state_lifetime(const struct ipx_session *session)
+{
+    const uint16_t tmplts = session->udp.lifetime.tmplts;
+    const uint16_t opts_tmplts = session->udp.lifetime.opts_tmplts;
+    if (tmplts == 0 || opts_tmplts == 0) {
+        // Templates of the Transport Session never expire
+        return 0;
     }
+    return (tmplts > opts_tmplts) ? tmplts : opts_tmplts;
+}
 
-    if ((info = stream_ctx_rec_get(&rec->ctx, msg_ctx->stream)) == NULL) {
-        PARSER_ERROR(parser, msg_ctx, "A memory allocation failed (%s:%d).", __FILE__, __LINE__);
-        return IPX_ERR_NOMEM;
+/**
+ * \brief Find a flow source waiting for its first message (binary search)
+ * \param[in]  parser Parser
+ * \param[in]  key    Identification of the flow source
+ * \param[out] idx    Index of the flow source or the position where it should be inserted
+ * \return True, if the flow source has been found. False otherwise.
+ */
+static bool
+parser_state_find(const struct ipx_parser *parser, const struct parser_state_hdr *key,
+    size_t *idx)
+{
+    size_t low = 0;
+    size_t high = parser->state_cnt;
+
+    while (low < high) {
+        const size_t mid = low + (high - low) / 2;
+        const int cmp = memcmp(&parser->state[mid].hdr, key, PARSER_STATE_KEY_SIZE);
+        if (cmp == 0) {
+            *idx = mid;
+            return true;
+        }
+
+        if (cmp < 0) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
     }
-    assert(rec->session == msg_ctx->session);
-    assert(rec->odid == msg_ctx->odid);
-    assert(info->id == msg_ctx->stream);
 
-    // Check if the message must be converted to IPFIX
-    int conv_status = parser_convert(parser, rec, *ipfix);
-    if (conv_status != IPX_OK) {
-        // Note: An appropriate error message has been printed in the converter
-        if (conv_status != FDS_ERR_NOMEM) {
-            return FDS_ERR_FORMAT;
+    *idx = low;
+    return false;
+}
+
+/**
+ * \brief Remove a flow source waiting for its first message
+ * \param[in] parser Parser
+ * \param[in] idx    Index of the flow source
+ */
+static void
+parser_state_remove(struct ipx_parser *parser, size_t idx)
+{
+    struct parser_state_entry *entry = &parser->state[idx];
+    free(entry->data);
+    memmove(entry, entry + 1, (--parser->state_cnt - idx) * sizeof(*entry));
+}
+
+/**
+ * \brief Remove flow sources with expired (Options) Templates
+ *
+ * Only flow sources with limited template lifetime removed from the parser are checked.
+ * Flow sources loaded from state files are checked when they are seen again.
+ * \param[in] parser Parser
+ * \param[in] now    Current monotonic time (see parser_state_now())
+ */
+static void
+parser_state_expire(struct ipx_parser *parser, uint64_t now)
+{
+    size_t cnt = 0;
+    for (size_t idx = 0; idx < parser->state_cnt; ++idx) {
+        struct parser_state_entry *entry = &parser->state[idx];
+        if (entry->lifetime != 0 && now - entry->since > entry->lifetime) {
+            free(entry->data);
+            continue;
         }
 
-        return FDS_ERR_NOMEM;
+        parser->state[cnt++] = *entry;
     }
 
-    // Check IPFIX Message header and its sequence number
-    const struct fds_ipfix_msg_hdr *msg_data = (struct fds_ipfix_msg_hdr *)(*ipfix)->raw_pkt;
-    assert(ntohs(msg_data->version) == FDS_IPFIX_VERSION && "Message to parse must be IPFIX!");
+    if (cnt != parser->state_cnt) {
+        IPX_DEBUG(parser->ident, "Templates of %zu removed flow source(s) have expired.",
+            parser->state_cnt - cnt);
+    }
+    parser->state_cnt = cnt;
+}
 
-    if (ntohs(msg_data->length) < FDS_IPFIX_MSG_HDR_LEN) {
-        PARSER_ERROR(parser, msg_ctx, "IPFIX Message Header size (%" PRIu16 ") is invalid "
-            "(total length of the message is smaller than the IPFIX Message Header structure).",
-            ntohs(msg_data->length));
-        return IPX_ERR_FORMAT;
+/**
+ * \brief Add a flow source waiting for its first message
+ *
+ * If the flow source is already present, it is replaced. Expired flow sources are removed
+ * and if the maximum number of flow sources (#PARSER_STATE_MAX) is reached, the oldest one
+ * is dropped.
+ * \param[in] parser Parser
+ * \param[in] entry  Flow source (the parser takes responsibility for its data, even on failure)
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_NOMEM if a memory allocation error has occurred
+ */
+static int
+parser_state_add(struct ipx_parser *parser, const struct parser_state_entry *entry)
+{
+    size_t idx;
+    if (parser_state_find(parser, &entry->hdr, &idx)) {
+        free(parser->state[idx].data);
+        parser->state[idx] = *entry;
+        return IPX_OK;
     }
 
-    // Sequence number check
-    uint32_t msg_seq = ntohl(msg_data->seq_num);
-    PARSER_DEBUG(parser, msg_ctx, "Processing an IPFIX Message (Seq. number %" PRIu32 ")",
-        msg_seq);
+    if (parser->state_cnt == PARSER_STATE_MAX) {
+        parser_state_expire(parser, parser_state_now());
+    }
 
-    bool old_oos = false;  // Old out of sequence message
-    if (info->seq_num != msg_seq) {
-        if ((info->flags & SIF_SEEN) == 0) {
-            // The first message from this combination of the TS, ODID and Stream ID
-            info->flags |= SIF_SEEN;
-            info->seq_num = msg_seq;
-        } else {
-            // Out of sequence message
-            PARSER_WARNING(parser, msg_ctx, "Unexpected Sequence number (expected: "
-                "%" PRIu32 ", got: %" PRIu32 ").", info->seq_num, msg_seq);
-            if (parser_seq_num_cmp(msg_seq, info->seq_num) > 0) {
-                info->seq_num = msg_seq; // Newer than expected
-            } else {
-                old_oos = true; // Older than expected
+    if (parser->state_cnt == PARSER_STATE_MAX) {
+        size_t oldest = 0;
+        for (size_t i = 1; i < parser->state_cnt; ++i) {
+            if (parser->state[i].since < parser->state[oldest].since) {
+                oldest = i;
             }
         }
+
+        IPX_WARNING(parser->ident, "Maximum number of flow sources waiting for their templates "
+            "(%u) has been reached. Templates of the oldest one have been dropped.",
+            PARSER_STATE_MAX);
+        parser_state_remove(parser, oldest);
+        if (oldest < idx) {
+            idx--;
+        }
     }
-    info->flags |= SIF_SEEN;
 
-    // Configure a template manager
-    fds_tmgr_t *tmgr = rec->ctx->mgr;
-    int rc;
-    if ((rc = fds_tmgr_set_time(tmgr, ntohl(msg_data->export_time))) != FDS_OK) {
-        switch (rc) {
-        case FDS_ERR_DENIED:
-            // Failed to set Export Time
-            PARSER_ERROR(parser, msg_ctx, "Setting Export Time in history is not allowed for "
-                "this type of Transport Session.", 0);
+    if (parser->state_cnt == parser->state_alloc) {
+        const size_t alloc_new = (parser->state_alloc == 0)
+            ? PARSER_DEF_RECS : 2 * parser->state_alloc;
+        struct parser_state_entry *state_new = realloc(parser->state,
+            alloc_new * sizeof(*state_new));
+        if (!state_new) {
+            free(entry->data);
+            return IPX_ERR_NOMEM;
+        }
+
+        parser->state = state_new;
+        parser->state_alloc = alloc_new;
+    }
+
+    // Insert the flow source at its position (the array remains sorted)
+    struct parser_state_entry *pos = &parser->state[idx];
+    memmove(pos + 1, pos, (parser->state_cnt - idx) * sizeof(*pos));
+    *pos = *entry;
+    parser->state_cnt++;
+    return IPX_OK;
+}
+
+/** Auxiliary buffer for serialization of (Options) Templates of a snapshot */
+struct parser_state_buffer {
+    /** Serialized templates                     */
+    uint8_t *data;
+    /** Size of serialized templates             */
+    size_t size;
+    /** Allocated size of the buffer             */
+    size_t alloc;
+    /** Number of serialized templates           */
+    uint32_t cnt;
+    /** A memory allocation failed               */
+    bool failed;
+};
+
+/**
+ * \brief Serialize an (Options) Template (callback of fds_tsnapshot_for())
+ * \param[in] tmplt Template
+ * \param[in] data  Auxiliary buffer (struct parser_state_buffer)
+ * \return False, if a memory allocation failed and the iteration should be stopped.
+ */
+static bool
+parser_state_serialize_cb(const struct fds_template *tmplt, void *data)
+{
+    struct parser_state_buffer *buffer = data;
+    const uint16_t tmplt_info[2] = {(uint16_t) tmplt->type, tmplt->raw.length};
+    const size_t size_new = buffer->size + sizeof(tmplt_info) + tmplt->raw.length;
+
+    if (size_new > buffer->alloc) {
+        size_t alloc_new = (buffer->alloc == 0) ? 1024U : 2 * buffer->alloc;
+        while (alloc_new < size_new) {
+            alloc_new *= 2;
+        }
+
+        uint8_t *data_new = realloc(buffer->data, alloc_new);
+        if (!data_new) {
+            buffer->failed = true;
+            return false;
+        }
+
+        buffer->data = data_new;
+        buffer->alloc = alloc_new;
+    }
+
+    memcpy(buffer->data + buffer->size, tmplt_info, sizeof(tmplt_info));
+    memcpy(buffer->data + buffer->size + sizeof(tmplt_info), tmplt->raw.data, tmplt->raw.length);
+    buffer->size = size_new;
+    buffer->cnt++;
+    return true;
+}
+
+/**
+ * \brief Serialize (Options) Templates of a flow source into the format of a state file
+ *
+ * Only IPFIX flow sources over UDP are supported (see ipx_parser_state_save()).
+ * \param[in]  rec   Parser record of the flow source
+ * \param[out] entry Serialized flow source (the data must be freed by the caller)
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_NOTFOUND if the flow source is not supported or doesn't have any templates
+ * \return #IPX_ERR_NOMEM if a memory allocation error has occurred
+ */
+static int
+parser_state_serialize(const struct parser_rec *rec, struct parser_state_entry *entry)
+{
+    if (rec->session->type != FDS_SESSION_UDP || rec->ctx->type != ST_IPFIX
+            || (rec->ctx->flags & SCF_BLOCK) != 0) {
+        return IPX_ERR_NOTFOUND;
+    }
+
+    const fds_tsnapshot_t *snap;
+    if (fds_tmgr_snapshot_get(rec->ctx->mgr, &snap) != FDS_OK) {
+        return IPX_ERR_NOTFOUND;
+    }
+
+    struct parser_state_buffer buffer = {NULL, 0, 0, 0, false};
+    fds_tsnapshot_for(snap, &parser_state_serialize_cb, &buffer);
+    if (buffer.failed) {
+        free(buffer.data);
+        return IPX_ERR_NOMEM;
+    }
+
+    if (buffer.cnt == 0) {
+        free(buffer.data);
+        return IPX_ERR_NOTFOUND;
+    }
+
+    parser_state_key(rec->session, rec->odid, &entry->hdr);
+    entry->hdr.tmplt_cnt = buffer.cnt;
+    entry->data = buffer.data;
+    entry->size = buffer.size;
+    entry->removed = false;
+    return IPX_OK;
+}
+
+/**
+ * \brief Keep (Options) Templates of a flow source which is going to be removed from the parser
+ * \param[in] parser Parser
+ * \param[in] rec    Parser record of the flow source
+ */
+static void
+parser_state_stash(struct ipx_parser *parser, const struct parser_rec *rec)
+{
+    struct parser_state_entry entry;
+    int rc = parser_state_serialize(rec, &entry);
+    if (rc == IPX_ERR_NOTFOUND) {
+        return;
+    }
+
+    entry.since = parser_state_now();
+    entry.lifetime = parser_state_lifetime(rec->session);
+    entry.removed = true;
+    if (rc != IPX_OK || parser_state_add(parser, &entry) != IPX_OK) {
+        IPX_WARNING(parser->ident, "A memory allocation failed (%s:%d). Templates of a removed "
+            "flow source will not be saved.", __FILE__, __LINE__);
+    }
+}
+
+/**
+ * \brief Restore (Options) Templates of a flow source loaded from a state file
+ *
+ * If the flow source has been loaded, its templates are added into its Template manager and
+ * the loaded flow source is removed. Invalid templates are skipped. Templates older than
+ * the template lifetime of the Transport Session are dropped instead.
+ * \param[in] parser  Parser
+ * \param[in] rec     Parser record of the flow source (must be a UDP Transport Session)
+ * \param[in] msg_ctx IPFIX Message context (for log messages)
+ * \return True, if at least one template has been added. False otherwise.
+ */
+static bool
+parser_state_restore(struct ipx_parser *parser, struct parser_rec *rec,
+    const struct ipx_msg_ctx *msg_ctx)
+{
+    struct parser_state_hdr key;
+    parser_state_key(rec->session, rec->odid, &key);
+    size_t idx;
+    if (!parser_state_find(parser, &key, &idx)) {
+        return false;
+    }
+
+    struct parser_state_entry *entry = &parser->state[idx];
+    const uint32_t lifetime = parser_state_lifetime(rec->session);
+    if (lifetime != 0 && parser_state_now() - entry->since > lifetime) {
+        PARSER_INFO(parser, msg_ctx, "(Options) Templates from a state file have expired and "
+            "will not be restored.", '\0');
+        parser_state_remove(parser, idx);
+        return false;
+    }
+
+    uint8_t *pos = entry->data;
+    uint32_t restored = 0;
+
+    for (uint32_t i = 0; i < entry->hdr.tmplt_cnt; ++i) {
+        // Format has been checked during loading
+        uint16_t type, size;
+        memcpy(&type, pos, sizeof(type));
+        memcpy(&size, pos + sizeof(type), sizeof(size));
+        uint8_t *raw = pos + sizeof(type) + sizeof(size);
+        pos = raw + size;
+
+        struct fds_template *tmplt;
+        if (parser_tcache_parse(parser, (enum fds_template_type) type, raw, &size, &tmplt)
+                != FDS_OK) {
+            continue;
+        }
+
+        if (fds_tmgr_template_add(rec->ctx->mgr, tmplt) != FDS_OK) {
+            fds_template_destroy(tmplt);
+            continue;
+        }
+
+        restored++;
+    }
+
+    PARSER_INFO(parser, msg_ctx, "%" PRIu32 " of %" PRIu32 " (Options) Template(s) have been "
+        "restored.", restored, entry->hdr.tmplt_cnt);
+
+    parser_state_remove(parser, idx);
+    return restored > 0;
+}
+
+/**
+ * \brief Mark (Options) Templates defined in an IPFIX Message
+ *
+ * Withdrawals are ignored. Malformed Sets are silently skipped (they are reported later by the
+ * parser).
+ * \param[in]  msg     IPFIX Message (header and Sets)
+ * \param[out] defined Bitmap of Template IDs (65536 bits)
+ */
+static void
+parser_pending_defined(struct fds_ipfix_msg_hdr *msg, uint64_t *defined)
+{
+    struct fds_sets_iter it;
+    fds_sets_iter_init(&it, msg);
+
+    while (fds_sets_iter_next(&it) == FDS_OK) {
+        const uint16_t set_id = ntohs(it.set->flowset_id);
+        if (set_id != FDS_IPFIX_SET_TMPLT && set_id != FDS_IPFIX_SET_OPTS_TMPLT) {
+            continue;
+        }
+
+        struct fds_tset_iter tit;
+        fds_tset_iter_init(&tit, it.set);
+        while (fds_tset_iter_next(&tit) == FDS_OK) {
+            if (tit.field_cnt > 0) {
+                const uint16_t tid = ntohs(tit.ptr.trec->template_id);
+                defined[tid / 64U] |= (UINT64_C(1) << (tid % 64U));
+            }
+        }
+    }
+}
+
+/**
+ * \brief Attach waiting Data Sets with known (Options) Templates to an IPFIX Message
+ *
+ * Expired Sets are removed first. Sets whose templates are already known or defined in the
+ * message are appended (in the original order) after the Sets of the message, i.e. they are
+ * parsed after the templates. The raw message is replaced by a new one. Sets that don't fit
+ * into the maximum size of an IPFIX Message remain waiting.
+ * \param[in]  parser    Parser
+ * \param[in]  sctx      Stream context with waiting Data Sets
+ * \param[in]  msg       IPFIX Message
+ * \param[out] recovered Start of attached Sets in the new message (NULL, if none)
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_NOMEM if a memory allocation error has occurred (the message is unchanged)
+ */
+static int
+parser_pending_attach(struct ipx_parser *parser, struct stream_ctx *sctx,
+    struct ipx_msg_ipfix *msg, const uint8_t **recovered)
+{
+    struct fds_ipfix_msg_hdr *msg_hdr = (struct fds_ipfix_msg_hdr *) msg->raw_pkt;
+    const uint32_t export_time = ntohl(msg_hdr->export_time);
+    const uint16_t msg_size = ntohs(msg_hdr->length);
+    *recovered = NULL;
+
+    if (msg->raw_size < msg_size) {
+        // Malformed message (reported later by the parser)
+        return IPX_OK;
+    }
+
+    const fds_tsnapshot_t *snap;
+    if (fds_tmgr_snapshot_get(sctx->mgr, &snap) != FDS_OK) {
+        snap = NULL;
+    }
+
+    uint64_t defined[UINT16_MAX / 64U + 1U];
+    bool defined_valid = false;
+    size_t extra = 0;
+    uint32_t idx_new = 0;
+
+    for (uint32_t idx = 0; idx < sctx->pending_cnt; ++idx) {
+        struct pending_set *pending = &sctx->pending[idx];
+        const int32_t age = (int32_t) (export_time - pending->export_time);
+        if (age > 0 && (uint32_t) age > parser->pending.timeout) {
+            sctx->pending_size -= pending->size;
+            parser->pending.stats.expired++;
+            free(pending->data);
+            continue;
+        }
+
+        const uint16_t set_id = ntohs(((struct fds_ipfix_set_hdr *) pending->data)->flowset_id);
+        bool known = (snap != NULL && fds_tsnapshot_template_get(snap, set_id) != NULL);
+        if (!known) {
+            if (!defined_valid) {
+                memset(defined, 0, sizeof(defined));
+                parser_pending_defined(msg_hdr, defined);
+                defined_valid = true;
+            }
+            known = (defined[set_id / 64U] & (UINT64_C(1) << (set_id % 64U))) != 0;
+        }
+
+        pending->attach = known && msg_size + extra + pending->size <= UINT16_MAX;
+        if (pending->attach) {
+            extra += pending->size;
+        }
+        sctx->pending[idx_new++] = *pending;
+    }
+    sctx->pending_cnt = idx_new;
+
+    if (extra == 0) {
+        return IPX_OK;
+    }
+
+    uint8_t *msg_new = ipx_utils_buf_alloc(msg_size + extra);
+    if (!msg_new) {
+        return IPX_ERR_NOMEM;
+    }
+
+    memcpy(msg_new, msg->raw_pkt, msg_size);
+    size_t pos = msg_size;
+    uint32_t attached = 0;
+    idx_new = 0;
+
+    for (uint32_t idx = 0; idx < sctx->pending_cnt; ++idx) {
+        struct pending_set *pending = &sctx->pending[idx];
+        if (!pending->attach) {
+            sctx->pending[idx_new++] = *pending;
+            continue;
+        }
+
+        memcpy(msg_new + pos, pending->data, pending->size);
+        pos += pending->size;
+        sctx->pending_size -= pending->size;
+        free(pending->data);
+        attached++;
+    }
+    sctx->pending_cnt = idx_new;
+    parser->pending.stats.recovered += attached;
+
+    ((struct fds_ipfix_msg_hdr *) msg_new)->length = htons((uint16_t) pos);
+    ipx_utils_buf_free(msg->raw_pkt);
+    msg->raw_pkt = msg_new;
+    msg->raw_size = (uint16_t) pos;
+    *recovered = msg_new + msg_size;
+
+    PARSER_DEBUG(parser, &msg->ctx, "%" PRIu32 " buffered IPFIX Data Set(s) have been attached "
+        "to the message.", attached);
+    return IPX_OK;
+}
+
+/**
+ * \brief Process an IPFIX Message (see ipx_parser_process() for details)
+ */
+static int
+parser_process(ipx_parser_t *parser, ipx_msg_ipfix_t **ipfix, ipx_msg_garbage_t **garbage)
+{
+    *garbage = NULL;
+    const struct ipx_msg_ctx *msg_ctx = &(*ipfix)->ctx;
+
+    // Find a Stream Info
+    struct parser_rec *rec;   // Combination of Transport Session, ODID
+    struct stream_info *info; // Combination of Transport Session, ODID and Stream ID
+    if (parser->last.rec != NULL && parser->last.session == msg_ctx->session
+            && parser->last.odid == msg_ctx->odid && parser->last.stream == msg_ctx->stream) {
+        // Usually, consecutive messages belong to the same stream (never blocked, see below)
+        rec = parser->last.rec;
+        info = parser->last.info;
+    } else {
+        if ((rec = parser_rec_get(parser, msg_ctx)) == NULL) {
+            PARSER_ERROR(parser, msg_ctx, "A memory allocation failed (%s:%d).", __FILE__,
+                __LINE__);
+            return IPX_ERR_NOMEM;
+        }
+
+        if ((rec->ctx->flags & SCF_BLOCK) != 0) {
+            // This Transport Session has been blocked due to previous invalid behaviour
+            return IPX_ERR_DENIED;
+        }
+
+        if ((info = stream_ctx_rec_get(&rec->ctx, msg_ctx->stream)) == NULL) {
+            PARSER_ERROR(parser, msg_ctx, "A memory allocation failed (%s:%d).", __FILE__,
+                __LINE__);
+            return IPX_ERR_NOMEM;
+        }
+
+        parser->last.session = msg_ctx->session;
+        parser->last.odid = msg_ctx->odid;
+        parser->last.stream = msg_ctx->stream;
+        parser->last.rec = rec;
+        parser->last.info = info;
+    }
+    assert(rec->session == msg_ctx->session);
+    assert(rec->odid == msg_ctx->odid);
+    assert(info->id == msg_ctx->stream);
+    rec->last_used = ++parser->clock;
+
+    // Check if the message must be converted to IPFIX
+    int conv_status = parser_convert(parser, rec, *ipfix);
+    if (conv_status != IPX_OK) {
+        // Note: An appropriate error message has been printed in the converter
+        if (conv_status != FDS_ERR_NOMEM) {
+            return FDS_ERR_FORMAT;
+        }
+
+        return FDS_ERR_NOMEM;
+    }
+
+    // Check IPFIX Message header and its sequence number
+    const struct fds_ipfix_msg_hdr *msg_data = (struct fds_ipfix_msg_hdr *)(*ipfix)->raw_pkt;
+    assert(ntohs(msg_data->version) == FDS_IPFIX_VERSION && "Message to parse must be IPFIX!");
+
+    if (ntohs(msg_data->length) < FDS_IPFIX_MSG_HDR_LEN) {
+        PARSER_ERROR(parser, msg_ctx, "IPFIX Message Header size (%" PRIu16 ") is invalid "
+            "(total length of the message is smaller than the IPFIX Message Header structure).",
+            ntohs(msg_data->length));
+        return IPX_ERR_FORMAT;
+    }
+
+    // Sequence number check
+    uint32_t msg_seq = ntohl(msg_data->seq_num);
+    PARSER_DEBUG(parser, msg_ctx, "Processing an IPFIX Message (Seq. number %" PRIu32 ")",
+        msg_seq);
+
+    bool old_oos = false;  // Old out of sequence message
+    struct ipx_parser_seq_stats *seq_stats = &rec->ctx->seq_stats;
+    if (info->seq_num != msg_seq) {
+        if ((info->flags & SIF_SEEN) == 0) {
+            // The first message from this combination of the TS, ODID and Stream ID
+            info->flags |= SIF_SEEN;
+            info->seq_num = msg_seq;
+        } else {
+            // Out of sequence message (only counted, see ipx_parser_seq_report())
+            PARSER_DEBUG(parser, msg_ctx, "Unexpected Sequence number (expected: "
+                "%" PRIu32 ", got: %" PRIu32 ").", info->seq_num, msg_seq);
+            if (parser_seq_num_cmp(msg_seq, info->seq_num) > 0) {
+                // Newer than expected (i.e. records in between have been lost)
+                seq_stats->recs_expected += (uint32_t) (msg_seq - info->seq_num);
+                parser->seq_total.recs_expected += (uint32_t) (msg_seq - info->seq_num);
+                info->seq_num = msg_seq;
+            } else if ((uint32_t) (info->seq_num - msg_seq) > PARSER_SEQ_RESET_WINDOW) {
+                // Too old to be just delayed (e.g. the exporter has been restarted)
+                seq_stats->resets++;
+                parser->seq_total.resets++;
+                info->seq_num = msg_seq;
+            } else {
+                // Older than expected
+                seq_stats->reorders++;
+                parser->seq_total.reorders++;
+                old_oos = true;
+            }
+        }
+    }
+    info->flags |= SIF_SEEN;
+
+    // Configure a template manager
+    fds_tmgr_t *tmgr = rec->ctx->mgr;
+    int rc;
+    if ((rc = fds_tmgr_set_time(tmgr, ntohl(msg_data->export_time))) != FDS_OK) {
+        switch (rc) {
+        case FDS_ERR_DENIED:
+            // Failed to set Export Time
+            PARSER_ERROR(parser, msg_ctx, "Setting Export Time in history is not allowed for "
+                "this type of Transport Session.", 0);
             return IPX_ERR_FORMAT;
         case FDS_ERR_NOTFOUND:
             // Unable to find a corresponding snapshot
@@ -1309,13 +2768,34 @@ ipx_parser_process(ipx_parser_t *parser, ipx_msg_ipfix_t **ipfix, ipx_msg_garbag
         }
     }
 
+    bool restored = false;
+    if ((rec->ctx->flags & SCF_RESTORE) != 0) {
+        // The first message of the flow source, templates from a state file might be available
+        rec->ctx->flags &= ~SCF_RESTORE;
+        if (rec->ctx->type == ST_IPFIX) {
+            restored = parser_state_restore(parser, rec, msg_ctx);
+        }
+    }
+
+    // Attach buffered Data Sets whose templates are available now
+    const uint8_t *recovered = NULL;
+    if (rec->ctx->pending_cnt > 0
+            && parser_pending_attach(parser, rec->ctx, *ipfix, &recovered) != IPX_OK) {
+        PARSER_ERROR(parser, msg_ctx, "A memory allocation failed (%s:%d).", __FILE__, __LINE__);
+        return IPX_ERR_NOMEM;
+    }
+
     // Parse IPFIX Sets
     struct ipx_parser_data parser_data = {
         .parser = parser,
         .ipfix_msg = *ipfix,
         .tmgr = tmgr,
+        .sctx = rec->ctx,
+        .snap = NULL,
         .data_recs = 0,
-        .tmplt_changes = false
+        .recovered_recs = 0,
+        .recovered = recovered,
+        .tmplt_changes = restored
     };
     rc = parser_parse_message(&parser_data);
 
@@ -1334,10 +2814,20 @@ ipx_parser_process(ipx_parser_t *parser, ipx_msg_ipfix_t **ipfix, ipx_msg_garbag
         return rc;
     }
 
-    // Update expected Sequence number of the next message
+    /* Update expected Sequence number of the next message
+     * Note: Records of recovered Data Sets belong to previous messages, i.e. they have been
+     *   already counted as expected (but not received).
+     */
     if (!old_oos) {
-        info->seq_num += parser_data.data_recs;
+        const uint16_t recs_new = parser_data.data_recs - parser_data.recovered_recs;
+        info->seq_num += recs_new;
+        seq_stats->recs_expected += recs_new;
+        parser->seq_total.recs_expected += recs_new;
     }
+    seq_stats->recs_received += parser_data.data_recs;
+    parser->seq_total.recs_received += parser_data.data_recs;
+
+    (*ipfix)->ctx.snap_gen = rec->ctx->snap_gen;
 
     ipx_msg_garbage_t *garbage_msg = NULL;
     if (parser_data.tmplt_changes) {
@@ -1346,13 +2836,24 @@ ipx_parser_process(ipx_parser_t *parser, ipx_msg_ipfix_t **ipfix, ipx_msg_garbag
         if (fds_tmgr_garbage_get(tmgr, &fds_garbage) == FDS_OK && fds_garbage != NULL) {
             ipx_msg_garbage_cb cb = (ipx_msg_garbage_cb) &fds_tmgr_garbage_destroy;
             garbage_msg = ipx_msg_garbage_create(fds_garbage, cb);
+            // Old snapshots will be freed, i.e. their addresses can be reused by new ones
+            rec->ctx->snap = NULL;
         }
     }
 
-    *garbage = garbage_msg;
+    *garbage = parser_evicted_merge(parser, garbage_msg);
     return IPX_OK;
 }
 
+int
+ipx_parser_process(ipx_parser_t *parser, ipx_msg_ipfix_t **ipfix, ipx_msg_garbage_t **garbage)
+{
+    IPX_TRACE3(parser_process_entry, parser, *ipfix, (*ipfix)->ctx.odid);
+    int rc = parser_process(parser, ipfix, garbage);
+    IPX_TRACE3(parser_process_return, parser, *ipfix, rc);
+    return rc;
+}
+
 int
 ipx_parser_ie_source(ipx_parser_t *parser, const fds_iemgr_t *iemgr, ipx_msg_garbage_t **garbage)
 {
@@ -1399,6 +2900,8 @@ ipx_parser_ie_source(ipx_parser_t *parser, const fds_iemgr_t *iemgr, ipx_msg_gar
             continue;
         }
 
+        // Old snapshots will be freed, i.e. their addresses can be reused by new ones
+        ctx->snap = NULL;
         ipx_msg_garbage_cb cb = (ipx_msg_garbage_cb) &fds_tmgr_garbage_destroy;
         if (ipx_gc_add(gc, fds_garbage, cb) != IPX_OK) {
             // Garbage lost (memory leak)
@@ -1425,6 +2928,68 @@ ipx_parser_ie_source(ipx_parser_t *parser, const fds_iemgr_t *iemgr, ipx_msg_gar
     return IPX_OK;
 }
 
+void
+ipx_parser_limit_set(ipx_parser_t *parser, size_t max)
+{
+    parser->recs_max = max;
+}
+
+void
+ipx_parser_pending_set(ipx_parser_t *parser, size_t size, uint32_t timeout)
+{
+    parser->pending.size_max = size;
+    parser->pending.timeout = timeout;
+}
+
+void
+ipx_parser_pending_stats_get(const ipx_parser_t *parser, struct ipx_parser_pending_stats *stats)
+{
+    *stats = parser->pending.stats;
+}
+
+void
+ipx_parser_relay_set(ipx_parser_t *parser, bool en)
+{
+    parser->relay = en;
+}
+
+uint64_t
+ipx_parser_evictions(const ipx_parser_t *parser)
+{
+    return parser->evictions;
+}
+
+void
+ipx_parser_seq_total(const ipx_parser_t *parser, struct ipx_parser_seq_stats *stats)
+{
+    *stats = parser->seq_total;
+}
+
+void
+ipx_parser_seq_report(ipx_parser_t *parser)
+{
+    for (size_t idx = 0; idx < parser->recs_valid; ++idx) {
+        parser_seq_report_rec(parser, &parser->recs[idx]);
+    }
+}
+
+int
+ipx_parser_seq_stats_get(ipx_parser_t *parser, const struct ipx_session *session, uint32_t odid,
+    struct ipx_parser_seq_stats *stats)
+{
+    struct ipx_msg_ctx key;
+    key.session = session;
+    key.odid = odid;
+
+    struct parser_rec *rec = parser_rec_find(parser, &key);
+    if (!rec) {
+        return IPX_ERR_NOTFOUND;
+    }
+
+    *stats = rec->ctx->seq_stats;
+    return IPX_OK;
+}
+
 int
 ipx_parser_session_remove(ipx_parser_t *parser, const struct ipx_session *session,
     ipx_msg_garbage_t **garbage)
@@ -1450,6 +3015,14 @@ ipx_parser_session_remove(ipx_parser_t *parser, const struct ipx_session *sessio
         }
     }
 
+    // Report the rest of sequence number statistics (and keep templates for state files)
+    for (size_t idx = idx_start; idx < idx_end; ++idx) {
+        parser_seq_report_rec(parser, &parser->recs[idx]);
+        if (parser->state_keep) {
+            parser_state_stash(parser, &parser->recs[idx]);
+        }
+    }
+
     // Move session data into garbage
     ipx_msg_garbage_t *garbage_msg = parser_rec_to_garbage(parser, idx_start, idx_end);
     /* Note: If the garbage message is NULL, allocation of the memory failed and information about
@@ -1464,7 +3037,8 @@ ipx_parser_session_remove(ipx_parser_t *parser, const struct ipx_session *sessio
 
     // Update number of valid records
     parser->recs_valid = idx_start;
-    *garbage = garbage_msg;
+    parser_index_rebuild(parser);
+    *garbage = parser_evicted_merge(parser, garbage_msg);
     return IPX_OK;
 }
 
@@ -1496,6 +3070,9 @@ ipx_parser_session_block(ipx_parser_t *parser, const struct ipx_session *session
         parser->recs[idx].ctx->flags |= SCF_BLOCK;
     }
 
+    // Blocked records must not be returned from the cache
+    parser->last.rec = NULL;
+    parser->last.info = NULL;
     return IPX_OK;
 }
 
@@ -1520,3 +3097,251 @@ ipx_parser_session_for(ipx_parser_t *parser, ipx_parser_for_cb cb, void *data)
         cb(parser, now, data); // Number of valid records can be changed here!
     }
 }
+
+void
+ipx_parser_state_keep(ipx_parser_t *parser, bool en)
+{
+    parser->state_keep = en;
+}
+
+int
+ipx_parser_state_save(ipx_parser_t *parser, const char *path)
+{
+    const size_t tmp_size = strlen(path) + sizeof(".tmp");
+    char *tmp_path = malloc(tmp_size);
+    if (!tmp_path) {
+        IPX_ERROR(parser->ident, "A memory allocation failed (%s:%d).", __FILE__, __LINE__);
+        return IPX_ERR_DENIED;
+    }
+    snprintf(tmp_path, tmp_size, "%s.tmp", path);
+
+    FILE *file = fopen(tmp_path, "wb");
+    if (!file) {
+        const char *err_str;
+        ipx_strerror(errno, err_str);
+        IPX_ERROR(parser->ident, "Failed to create a state file '%s': %s", tmp_path, err_str);
+        free(tmp_path);
+        return IPX_ERR_DENIED;
+    }
+
+    const struct parser_state_file file_hdr = {PARSER_STATE_MAGIC, PARSER_STATE_VERSION};
+    bool failed = (fwrite(&file_hdr, sizeof(file_hdr), 1, file) != 1);
+    int err_code = errno;
+    size_t sources = 0;
+
+    // Active flow sources
+    for (size_t idx = 0; !failed && idx < parser->recs_valid; ++idx) {
+        struct parser_state_entry entry;
+        int rc = parser_state_serialize(&parser->recs[idx], &entry);
+        if (rc == IPX_ERR_NOTFOUND) {
+            continue;
+        } else if (rc != IPX_OK) {
+            err_code = ENOMEM;
+            failed = true;
+            break;
+        }
+
+        failed = fwrite(&entry.hdr, sizeof(entry.hdr), 1, file) != 1
+            || fwrite(entry.data, entry.size, 1, file) != 1;
+        err_code = errno;
+        free(entry.data);
+        sources++;
+    }
+
+    /* Removed flow sources (without expired ones)
+     * Note: Flow sources loaded from state files, which haven't been seen yet, are not saved
+     *   again. Replicas of a parser load state files of all replicas, i.e. they would be
+     *   multiplied by each save.
+     */
+    parser_state_expire(parser, parser_state_now());
+    for (size_t idx = 0; !failed && idx < parser->state_cnt; ++idx) {
+        const struct parser_state_entry *entry = &parser->state[idx];
+        if (!entry->removed) {
+            continue;
+        }
+
+        failed = fwrite(&entry->hdr, sizeof(entry->hdr), 1, file) != 1
+            || fwrite(entry->data, entry->size, 1, file) != 1;
+        err_code = errno;
+        sources++;
+    }
+
+    // Make sure that the content is on the disk before the original file is replaced
+    if (!failed && (fflush(file) != 0 || fsync(fileno(file)) != 0)) {
+        err_code = errno;
+        failed = true;
+    }
+
+    if (fclose(file) != 0 && !failed) {
+        err_code = errno;
+        failed = true;
+    }
+
+    if (!failed && rename(tmp_path, path) != 0) {
+        err_code = errno;
+        failed = true;
+    }
+
+    if (failed) {
+        const char *err_str;
+        ipx_strerror(err_code, err_str);
+        IPX_ERROR(parser->ident, "Failed to write a state file '%s': %s", path, err_str);
+        unlink(tmp_path);
+        free(tmp_path);
+        return IPX_ERR_DENIED;
+    }
+
+    IPX_DEBUG(parser->ident, "Templates of %zu flow source(s) have been saved into a state file "
+        "'%s'.", sources, path);
+    free(tmp_path);
+    return IPX_OK;
+}
+
+/**
+ * \brief Read (Options) Templates of a flow source from a state file
+ *
+ * Type and minimal length of each template are checked.
+ * \param[in]     file  State file (positioned after the header of the flow source)
+ * \param[in,out] entry Flow source with the filled header (data are filled on success)
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_FORMAT if the content is malformed or truncated
+ * \return #IPX_ERR_NOMEM if a memory allocation error has occurred
+ */
+static int
+parser_state_entry_read(FILE *file, struct parser_state_entry *entry)
+{
+    uint8_t *data = NULL;
+    size_t data_size = 0;
+
+    for (uint32_t i = 0; i < entry->hdr.tmplt_cnt; ++i) {
+        uint16_t tmplt_info[2];
+        if (fread(tmplt_info, sizeof(tmplt_info), 1, file) != 1) {
+            free(data);
+            return IPX_ERR_FORMAT;
+        }
+
+        const uint16_t type = tmplt_info[0];
+        const uint16_t length = tmplt_info[1];
+        if ((type != FDS_TYPE_TEMPLATE && type != FDS_TYPE_TEMPLATE_OPTS)
+                || length < sizeof(struct fds_ipfix_trec)) {
+            free(data);
+            return IPX_ERR_FORMAT;
+        }
+
+        uint8_t *data_new = realloc(data, data_size + sizeof(tmplt_info) + length);
+        if (!data_new) {
+            free(data);
+            return IPX_ERR_NOMEM;
+        }
+
+        data = data_new;
+        memcpy(data + data_size, tmplt_info, sizeof(tmplt_info));
+        data_size += sizeof(tmplt_info);
+        if (fread(data + data_size, length, 1, file) != 1) {
+            free(data);
+            return IPX_ERR_FORMAT;
+        }
+        data_size += length;
+    }
+
+    entry->data = data;
+    entry->size = data_size;
+    entry->lifetime = 0;
+    entry->removed = false;
+    return IPX_OK;
+}
+
+int
+ipx_parser_state_load(ipx_parser_t *parser, const char *path)
+{
+    FILE *file = fopen(path, "rb");
+    if (!file) {
+        if (errno == ENOENT) {
+            IPX_INFO(parser->ident, "State file '%s' doesn't exist, no templates will be "
+                "restored from it.", path);
+            return IPX_OK;
+        }
+
+        const char *err_str;
+        ipx_strerror(errno, err_str);
+        IPX_ERROR(parser->ident, "Failed to open a state file '%s': %s", path, err_str);
+        return IPX_ERR_DENIED;
+    }
+
+    // Flow sources are added only if the whole file is valid
+    struct parser_state_entry *entries = NULL;
+    size_t entries_cnt = 0;
+    struct parser_state_file file_hdr;
+    int rc = IPX_OK;
+
+    /* Templates were valid when the file was written, i.e. its age is subtracted from
+     * the current time (the lifetime is checked when the flow source is seen again) */
+    const uint64_t now = parser_state_now();
+    uint64_t since = now;
+    struct stat file_stat;
+    if (fstat(fileno(file), &file_stat) == 0) {
+        const time_t age = time(NULL) - file_stat.st_mtime;
+        if (age > 0) {
+            since = ((uint64_t) age < now) ? now - (uint64_t) age : 0;
+        }
+    }
+
+    if (fread(&file_hdr, sizeof(file_hdr), 1, file) != 1 || file_hdr.magic != PARSER_STATE_MAGIC
+            || file_hdr.version != PARSER_STATE_VERSION) {
+        rc = IPX_ERR_FORMAT;
+    }
+
+    while (rc == IPX_OK) {
+        struct parser_state_entry entry;
+        const size_t hdr_size = fread(&entry.hdr, 1, sizeof(entry.hdr), file);
+        if (hdr_size == 0 && feof(file)) {
+            // End of file
+            break;
+        } else if (hdr_size != sizeof(entry.hdr)) {
+            rc = IPX_ERR_FORMAT;
+            break;
+        }
+
+        memset(entry.hdr.reserved, 0, sizeof(entry.hdr.reserved));
+        if ((rc = parser_state_entry_read(file, &entry)) != IPX_OK) {
+            break;
+        }
+        entry.since = since;
+
+        struct parser_state_entry *entries_new = realloc(entries,
+            (entries_cnt + 1) * sizeof(*entries));
+        if (!entries_new) {
+            free(entry.data);
+            rc = IPX_ERR_NOMEM;
+            break;
+        }
+
+        entries = entries_new;
+        entries[entries_cnt++] = entry;
+    }
+
+    fclose(file);
+    for (size_t idx = 0; idx < entries_cnt; ++idx) {
+        if (rc != IPX_OK) {
+            free(entries[idx].data);
+        } else if (parser_state_add(parser, &entries[idx]) != IPX_OK) {
+            rc = IPX_ERR_NOMEM;
+        }
+    }
+    free(entries);
+
+    switch (rc) {
+    case IPX_OK:
+        IPX_INFO(parser->ident, "Templates of %zu flow source(s) have been loaded from a state "
+            "file '%s'.", entries_cnt, path);
+        break;
+    case IPX_ERR_FORMAT:
+        IPX_ERROR(parser->ident, "State file '%s' is malformed and has been ignored.", path);
+        break;
+    default:
+        IPX_ERROR(parser->ident, "A memory allocation failed (%s:%d).", __FILE__, __LINE__);
+        break;
+    }
+
+    return rc;
+}
@@ -64,6 +64,37 @@
 /** Internal data type of parser                                                                 */
 typedef struct ipx_parser ipx_parser_t;
 
+/**
+ * \brief Sequence number statistics of a combination of a Transport Session and an ODID
+ *
+ * All counters are cumulative since the first message of the combination. The number of lost
+ * Data Records can be estimated as the difference between expected and received records (late
+ * messages are counted as received, but they don't increase the number of expected records).
+ */
+struct ipx_parser_seq_stats {
+    /** Number of Data Records expected based on Sequence Numbers of in-order messages          */
+    uint64_t recs_expected;
+    /** Number of received Data Records                                                         */
+    uint64_t recs_received;
+    /** Number of messages older than expected (i.e. reordered or duplicated)                   */
+    uint64_t reorders;
+    /** Number of resets of the Sequence Number (e.g. a restart of the exporter)                */
+    uint64_t resets;
+};
+
+/**
+ * \brief Statistics of Data Sets waiting for their (Options) Templates
+ * \see ipx_parser_pending_set()
+ */
+struct ipx_parser_pending_stats {
+    /** Number of buffered Data Sets                                                            */
+    uint64_t buffered;
+    /** Number of buffered Data Sets parsed after their templates had been received             */
+    uint64_t recovered;
+    /** Number of Data Sets dropped (timeout, size limit or the template is still missing)      */
+    uint64_t expired;
+};
+
 /**
  * \brief Create a IPFIX parser
  *
@@ -214,6 +245,160 @@ typedef void (*ipx_parser_for_cb)(ipx_parser_t *parser, const struct ipx_session
 IPX_API void
 ipx_parser_session_for(ipx_parser_t *parser, ipx_parser_for_cb cb, void *data);
 
+/**
+ * \brief Get sequence number statistics of a combination of a Transport Session and an ODID
+ *
+ * \param[in]  parser  Parser
+ * \param[in]  session Transport Session
+ * \param[in]  odid    Observation Domain ID
+ * \param[out] stats   Statistics
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_NOTFOUND if the combination is not present in the parser
+ */
+IPX_API int
+ipx_parser_seq_stats_get(ipx_parser_t *parser, const struct ipx_session *session, uint32_t odid,
+    struct ipx_parser_seq_stats *stats);
+
+/**
+ * \brief Set the maximum number of combinations of Transport Sessions and ODIDs
+ *
+ * Each combination holds its own Template manager and Streams information. If the limit is
+ * reached and a message of a new combination is processed, the least recently used combination
+ * is evicted from the parser, i.e. its (Options) Templates are forgotten and its Data Records
+ * cannot be interpreted until the Templates are received again. Evicted combinations are
+ * returned as a part of garbage of the next successfully processed message (see
+ * ipx_parser_process()) or removed Transport Session (see ipx_parser_session_remove()).
+ * \note Combinations of blocked Transport Sessions (see ipx_parser_session_block()) are never
+ *   evicted. Therefore, the limit might be temporarily exceeded.
+ * \param[in] parser Parser
+ * \param[in] max    Maximum number of combinations (0 = unlimited, default)
+ */
+IPX_API void
+ipx_parser_limit_set(ipx_parser_t *parser, size_t max);
+
+/**
+ * \brief Configure buffering of Data Sets with unknown (Options) Templates (disabled by default)
+ *
+ * UDP exporters often send Data Sets before their templates (e.g. after start). If enabled,
+ * such Data Sets are copied into a buffer of their combination of a Transport Session and an
+ * ODID. When a message with the missing templates (or any later message) of the combination is
+ * processed, the buffered Sets are appended to the message after its own Sets, i.e. the raw
+ * message is replaced and its Data Records are parsed as usual. Sets older than the timeout
+ * (based on Export Time) are dropped. Sets of other Transport Session types are never buffered.
+ * \note Records of recovered Sets are counted as received, but they don't affect expected
+ *   Sequence Numbers (i.e. they are counted as lost until recovered).
+ * \param[in] parser  Parser
+ * \param[in] size    Maximum total size of buffered Sets per combination in bytes (0 = disabled)
+ * \param[in] timeout Maximum age of buffered Sets in seconds
+ */
+IPX_API void
+ipx_parser_pending_set(ipx_parser_t *parser, size_t size, uint32_t timeout);
+
+/**
+ * \brief Get statistics of Data Sets with unknown (Options) Templates
+ * \see ipx_parser_pending_set()
+ * \param[in]  parser Parser
+ * \param[out] stats  Statistics of all combinations since the parser has been created
+ */
+IPX_API void
+ipx_parser_pending_stats_get(const ipx_parser_t *parser, struct ipx_parser_pending_stats *stats);
+
+/**
+ * \brief Enable/disable relay mode (disabled by default)
+ *
+ * In relay mode, (Options) Templates are processed as usual and Data Records are only counted
+ * (for sequence number checks), i.e. no references to Data Records are added to wrappers of
+ * IPFIX Messages (see ipx_msg_ipfix_get_drec_cnt()). Only references to Sets with the number
+ * of their Data Records and the Template snapshot are available (see ::ipx_ipfix_set).
+ * Useful if all successors forward IPFIX Messages as they are.
+ * \param[in] parser Parser
+ * \param[in] en     Enable/disable
+ */
+IPX_API void
+ipx_parser_relay_set(ipx_parser_t *parser, bool en);
+
+/**
+ * \brief Get the number of evicted combinations of Transport Sessions and ODIDs
+ * \see ipx_parser_limit_set()
+ * \param[in] parser Parser
+ * \return Total number of evictions since the parser has been created
+ */
+IPX_API uint64_t
+ipx_parser_evictions(const ipx_parser_t *parser);
+
+/**
+ * \brief Get sequence number statistics of all combinations of Transport Sessions and ODIDs
+ *
+ * Unlike ipx_parser_seq_stats_get(), counters of removed and evicted combinations are included.
+ * \param[in]  parser Parser
+ * \param[out] stats  Statistics
+ */
+IPX_API void
+ipx_parser_seq_total(const ipx_parser_t *parser, struct ipx_parser_seq_stats *stats);
+
+/**
+ * \brief Report gaps in sequence numbers since the previous report
+ *
+ * Instead of a warning about each out-of-sequence message, the parser only updates counters
+ * (see ::ipx_parser_seq_stats). The function prints a single aggregated warning for each
+ * combination of a Transport Session and an ODID with lost, reordered or reset messages since
+ * the previous report. It is supposed to be called periodically.
+ * \param[in] parser Parser
+ */
+IPX_API void
+ipx_parser_seq_report(ipx_parser_t *parser);
+
+/**
+ * \brief Keep (Options) Templates of removed flow sources for state files (disabled by default)
+ *
+ * If enabled, templates of IPFIX flow sources over UDP are kept when their Transport Session
+ * is removed (see ipx_parser_session_remove()). They are saved by ipx_parser_state_save() and
+ * restored if the Transport Session appears again. Useful because Transport Sessions are usually
+ * removed before the parser is destroyed. Templates of a removed flow source are dropped after
+ * the template lifetime of its Transport Session and the number of kept flow sources is limited
+ * (the oldest ones are dropped).
+ * \param[in] parser Parser
+ * \param[in] en     Enable/disable
+ */
+IPX_API void
+ipx_parser_state_keep(ipx_parser_t *parser, bool en);
+
+/**
+ * \brief Save (Options) Templates of all flow sources into a state file
+ *
+ * Only (Options) Templates of IPFIX flow sources over UDP are saved, i.e. sources of other
+ * Transport Sessions (e.g. TCP, SCTP) are expected to send their templates again after
+ * reconnection and NetFlow v9 converters keep their own state of templates. Templates of
+ * removed flow sources are included (see ipx_parser_state_keep()), however, loaded flow sources
+ * which haven't been seen yet are not. The file is written atomically, i.e. the content is
+ * written into a temporary file first and then it replaces the original file (if any).
+ * \param[in] parser Parser
+ * \param[in] path   Path to the state file
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_DENIED if the file cannot be written (an error message is printed)
+ */
+IPX_API int
+ipx_parser_state_save(ipx_parser_t *parser, const char *path);
+
+/**
+ * \brief Load (Options) Templates of flow sources from a state file
+ *
+ * Templates are not used immediately. When the first IPFIX Message of a UDP Transport Session
+ * with matching addresses, ports and ODID is processed, its Template manager is pre-filled with
+ * the loaded templates, i.e. its Data Records can be interpreted before the templates are
+ * retransmitted by the exporter. The function can be called multiple times to load multiple
+ * files. Sequence numbers are not restored. Templates older than the template lifetime of
+ * the Transport Session (the age of the file is taken into account) are not restored.
+ * \param[in] parser Parser
+ * \param[in] path   Path to the state file
+ * \return #IPX_OK on success (including a non-existing file)
+ * \return #IPX_ERR_FORMAT if the file is malformed (no templates are loaded from it)
+ * \return #IPX_ERR_DENIED if the file cannot be read
+ * \return #IPX_ERR_NOMEM if a memory allocation error has occurred
+ */
+IPX_API int
+ipx_parser_state_load(ipx_parser_t *parser, const char *path);
+
 /**
  * @}
  */
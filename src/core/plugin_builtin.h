@@ -0,0 +1,87 @@
+/**
+ * \file src/core/plugin_builtin.h
+ * \author agent <agent@local>
+ * \brief Plugins built into the collector (internal header file)
+ * \date 2026
+ */
+
+/* Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is'', and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#ifndef IPFIXCOL_PLUGIN_BUILTIN_H
+#define IPFIXCOL_PLUGIN_BUILTIN_H
+
+#include <ipfixcol2.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * \brief Description of a plugin built into the collector
+ *
+ * In-tree plugins selected by the BUILTIN_PLUGINS build option are linked statically into
+ * the collector (instead of a shared object loaded by dlopen). Symbols of the plugin are
+ * renamed during the build, so the plugin is described by direct pointers to its callbacks.
+ * Optional (or type specific) callbacks are NULL if not defined by the plugin.
+ */
+struct ipx_plugin_builtin {
+    /** Description of the plugin                                               */
+    const struct ipx_plugin_info *info;
+    /** Plugin constructor                                                      */
+    int  (*init)    (ipx_ctx_t *, const char *);
+    /** Plugin destructor                                                       */
+    void (*destroy) (ipx_ctx_t *, void *);
+    /** Getter function (INPUT plugins only)                                    */
+    int  (*get)     (ipx_ctx_t *, void *);
+    /** Process function (INTERMEDIATE and OUTPUT plugins only)                 */
+    int  (*process) (ipx_ctx_t *, void *, ipx_msg_t *);
+    /** Close session request (INPUT plugins only, can be NULL)                 */
+    void (*ts_close)(ipx_ctx_t *, void *, const struct ipx_session *);
+};
+
+/**
+ * \brief Table of built-in plugins
+ *
+ * The table is generated during the build and terminated by a record with NULL description.
+ * The symbol is weak, i.e. it's NULL if the table is not linked (for example, the collector
+ * without built-in plugins or unit tests of the core library).
+ */
+extern const struct ipx_plugin_builtin ipx_plugin_builtins[] __attribute__((weak));
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // IPFIXCOL_PLUGIN_BUILTIN_H
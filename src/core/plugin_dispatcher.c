@@ -0,0 +1,193 @@
+/**
+ * \file src/core/plugin_dispatcher.c
+ * \author agent <agent@local>
+ * \brief Internal dispatcher of sharded intermediate instances (source file)
+ * \date 2026
+ */
+
+/* Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is'', and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#include <stdlib.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "plugin_dispatcher.h"
+#include "message_base.h"
+#include "message_ipfix.h"
+#include "context.h"
+
+/** List of replicas */
+struct ipx_dispatcher_list {
+    /** Distribution of messages among replicas            */
+    enum ipx_dispatcher_key key;
+    /** Number of replicas                                 */
+    size_t size;
+    /** Array of input ring buffers of replicas (writer)   */
+    ipx_ring_t **rings;
+};
+
+ipx_dispatcher_list_t *
+ipx_dispatcher_list_create(enum ipx_dispatcher_key key)
+{
+    struct ipx_dispatcher_list *result = calloc(1, sizeof(*result));
+    if (!result) {
+        return NULL;
+    }
+
+    result->key = key;
+    result->size = 0;
+    result->rings = NULL;
+    return result;
+}
+
+void
+ipx_dispatcher_list_destroy(ipx_dispatcher_list_t *list)
+{
+    free(list->rings);
+    free(list);
+}
+
+bool
+ipx_dispatcher_list_empty(const ipx_dispatcher_list_t *list)
+{
+    return (list->size == 0);
+}
+
+int
+ipx_dispatcher_list_add(ipx_dispatcher_list_t *list, ipx_ring_t *ring)
+{
+    if (list == NULL || ring == NULL) {
+        return IPX_ERR_ARG;
+    }
+
+    size_t new_size = list->size + 1;
+    ipx_ring_t **new_rings = realloc(list->rings, new_size * sizeof(*new_rings));
+    if (!new_rings) {
+        return IPX_ERR_NOMEM;
+    }
+
+    new_rings[new_size - 1] = ring;
+    list->size = new_size;
+    list->rings = new_rings;
+    return IPX_OK;
+}
+
+/**
+ * \brief Get index of the replica responsible for a stream
+ * \param[in] list    Dispatcher list
+ * \param[in] session Transport Session
+ * \param[in] odid    Observation Domain ID (ignored if the list is keyed by sessions only)
+ * \return Index
+ */
+static inline size_t
+dispatcher_select(const struct ipx_dispatcher_list *list, const struct ipx_session *session,
+    uint32_t odid)
+{
+    uint64_t key = (uint64_t) (uintptr_t) session;
+    if (list->key == IPX_DISPATCHER_KEY_ODID) {
+        key ^= ((uint64_t) odid) << 32;
+    }
+
+    // Fibonacci hashing (pointers are aligned, i.e. lower bits are useless)
+    key *= UINT64_C(11400714819323198485);
+    return (size_t) ((key >> 32) % list->size);
+}
+
+// ------------------------------------------------------------------------------------------------
+
+const struct ipx_plugin_info ipx_plugin_dispatcher_info = {
+    .name    = "Dispatcher",
+    .dsc     = "Internal IPFIXcol plugin for passing messages to replicas of an intermediate plugin.",
+    .type    = IPX_PT_DISPATCHER,
+    .flags   = 0,
+    .version = "1.0.0",
+    .ipx_min = "2.0.0"
+};
+
+int
+ipx_plugin_dispatcher_init(ipx_ctx_t *ctx, const char *params)
+{
+    (void) params;
+
+    // Check that all message types are subscribed
+    ipx_msg_mask_t mask = IPX_MSG_MASK_ALL;
+    if (ipx_ctx_subscribe(ctx, &mask, NULL) != IPX_OK) {
+        IPX_CTX_ERROR(ctx, "Unable to subscribe to all message types!", '\0');
+        return IPX_ERR_DENIED;
+    }
+
+    return IPX_OK;
+}
+
+void
+ipx_plugin_dispatcher_destroy(ipx_ctx_t *ctx, void *cfg)
+{
+    // Do nothing, private data should be freed by the configurator
+    (void) ctx;
+    (void) cfg;
+}
+
+int
+ipx_plugin_dispatcher_process(ipx_ctx_t *ctx, void *cfg, ipx_msg_t *msg)
+{
+    (void) ctx;
+    // List of replicas is prepared by the configurator
+    struct ipx_dispatcher_list *list = (struct ipx_dispatcher_list *) cfg;
+    assert(list != NULL && list->size > 0);
+
+    enum ipx_msg_type msg_type = ipx_msg_get_type(msg);
+    if (msg_type == IPX_MSG_IPFIX) {
+        // Keep the order of messages of the same stream
+        const struct ipx_msg_ctx *msg_ctx = ipx_msg_ipfix_get_ctx(ipx_msg_base2ipfix(msg));
+        size_t idx = dispatcher_select(list, msg_ctx->session, msg_ctx->odid);
+        ipx_ring_push(list->rings[idx], msg);
+        return IPX_OK;
+    }
+
+    if (msg_type == IPX_MSG_SESSION && list->key == IPX_DISPATCHER_KEY_SESSION) {
+        // The session is known only to the replica that processes its IPFIX Messages
+        ipx_msg_session_t *msg_session = ipx_msg_base2session(msg);
+        size_t idx = dispatcher_select(list, ipx_msg_session_get_session(msg_session), 0);
+        ipx_ring_push(list->rings[idx], msg);
+        return IPX_OK;
+    }
+
+    // Set the number of references and pass the message to all replicas
+    ipx_msg_header_cnt_set(msg, (unsigned int) list->size);
+    for (size_t i = 0; i < list->size; ++i) {
+        ipx_ring_push(list->rings[i], msg);
+    }
+
+    return IPX_OK;
+}
@@ -0,0 +1,137 @@
+/**
+ * \file src/core/plugin_dispatcher.h
+ * \author agent <agent@local>
+ * \brief Internal dispatcher of sharded intermediate instances (header file)
+ * \date 2026
+ */
+
+/* Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is'', and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#ifndef IPFIXCOL_PLUGIN_DISPATCHER_H
+#define IPFIXCOL_PLUGIN_DISPATCHER_H
+
+#include <ipfixcol2.h>
+#include "ring.h"
+
+/** Internal type of list of replicas */
+typedef struct ipx_dispatcher_list ipx_dispatcher_list_t;
+
+/** Distribution of messages among replicas */
+enum ipx_dispatcher_key {
+    /** IPFIX Messages by Transport Session and ODID, other messages are broadcast            */
+    IPX_DISPATCHER_KEY_ODID,
+    /** IPFIX and Transport Session Messages by Transport Session, others are broadcast       */
+    IPX_DISPATCHER_KEY_SESSION
+};
+
+/**
+ * \brief Create a new dispatcher list
+ *
+ * After initialization the list is empty
+ * \param[in] key Distribution of messages among replicas
+ * \return Pointer or NULL (memory allocation error)
+ */
+ipx_dispatcher_list_t *
+ipx_dispatcher_list_create(enum ipx_dispatcher_key key);
+
+/**
+ * \brief Is the list empty?
+ * \param[in] list Dispatcher list
+ * \return True or false
+ */
+bool
+ipx_dispatcher_list_empty(const ipx_dispatcher_list_t *list);
+
+/**
+ * \brief Destroy the list
+ *
+ * \note Ring buffers are NOT freed by this function!
+ * \param[in] list Dispatcher list
+ */
+void
+ipx_dispatcher_list_destroy(ipx_dispatcher_list_t *list);
+
+/**
+ * \brief Add a new replica to the list
+ * \param[in] list Dispatcher list
+ * \param[in] ring Input ring buffer of the replica (for a writer)
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_ARG in case of invalid arguments
+ * \return #IPX_ERR_NOMEM if a memory allocation error has occurred
+ */
+int
+ipx_dispatcher_list_add(ipx_dispatcher_list_t *list, ipx_ring_t *ring);
+
+// ------------------------------------------------------------------------------------------------
+
+/** Description of the dispatcher plugin */
+extern const struct ipx_plugin_info ipx_plugin_dispatcher_info;
+
+/**
+ * \brief Initialize a dispatcher
+ * \param[in] ctx    Plugin context
+ * \param[in] params Ignored (should be NULL)
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_DENIED in case of a fatal error
+ */
+int
+ipx_plugin_dispatcher_init(ipx_ctx_t *ctx, const char *params);
+
+/**
+ * \brief Destroy a dispatcher
+ * \param[in] ctx Plugin context
+ * \param[in] cfg Private instance data
+ */
+void
+ipx_plugin_dispatcher_destroy(ipx_ctx_t *ctx, void *cfg);
+
+/**
+ * \brief Pass messages to replicas of an intermediate plugin
+ *
+ * IPFIX Messages are passed to a single replica selected by a hash of their Transport Session
+ * (and ODID, see #ipx_dispatcher_key), therefore, all messages of the same stream are always
+ * processed by the same replica in the original order. If the list is keyed by Transport
+ * Sessions only, Transport Session Messages are passed to the same replica as IPFIX Messages
+ * of the session. Other types of messages are broadcast to all replicas with the reference
+ * counter set to the number of replicas (see ipx_ctx_merge_set()).
+ * \param[in] ctx Plugin context
+ * \param[in] cfg Private instance data
+ * \param[in] msg Message to process
+ * \return #IPX_OK on success
+ */
+int
+ipx_plugin_dispatcher_process(ipx_ctx_t *ctx, void *cfg, ipx_msg_t *msg);
+
+#endif //IPFIXCOL_PLUGIN_DISPATCHER_H
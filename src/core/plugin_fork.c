@@ -0,0 +1,121 @@
+/**
+ * \file src/core/plugin_fork.c
+ * \author agent <agent@local>
+ * \brief Internal branch point of the pipeline (source file)
+ * \date 2026
+ */
+
+
+/* Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is'', and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <errno.h>
+#include <inttypes.h>
+#include "plugin_fork.h"
+#include "message_ipfix.h"
+#include "context.h"
+
+/** Private data of the fork */
+struct fork_data {
+    /** Identification of the new branch   */
+    uint16_t branch;
+    /** Number of messages that haven't been copied due to memory allocation errors */
+    uint64_t failed;
+};
+
+const struct ipx_plugin_info ipx_plugin_fork_info = {
+    .name    = "Fork",
+    .dsc     = "Internal IPFIXcol plugin for copying messages into a branch of the pipeline.",
+    .type    = IPX_PT_INTERMEDIATE,
+    .flags   = 0,
+    .version = "1.0.0",
+    .ipx_min = "2.0.0"
+};
+
+int
+ipx_plugin_fork_init(ipx_ctx_t *ctx, const char *params)
+{
+    char *end;
+    errno = 0;
+    unsigned long branch = strtoul(params, &end, 10);
+    if (errno != 0 || *end != '\0' || branch == 0 || branch > UINT16_MAX) {
+        IPX_CTX_ERROR(ctx, "Invalid identification of a branch '%s'!", params);
+        return IPX_ERR_DENIED;
+    }
+
+    struct fork_data *data = calloc(1, sizeof(*data));
+    if (!data) {
+        IPX_CTX_ERROR(ctx, "Memory allocation failed! (%s:%d)", __FILE__, __LINE__);
+        return IPX_ERR_DENIED;
+    }
+
+    data->branch = (uint16_t) branch;
+    ipx_ctx_private_set(ctx, data);
+    return IPX_OK;
+}
+
+void
+ipx_plugin_fork_destroy(ipx_ctx_t *ctx, void *cfg)
+{
+    struct fork_data *data = (struct fork_data *) cfg;
+    if (data->failed > 0) {
+        IPX_CTX_WARNING(ctx, "%" PRIu64 " IPFIX Messages have not been copied into the branch due "
+            "to memory allocation errors", data->failed);
+    }
+
+    free(data);
+}
+
+int
+ipx_plugin_fork_process(ipx_ctx_t *ctx, void *cfg, ipx_msg_t *msg)
+{
+    struct fork_data *data = (struct fork_data *) cfg;
+    ipx_msg_ipfix_t *ipfix_msg = ipx_msg_base2ipfix(msg);
+
+    // The copy must be created before the original is passed (i.e. possibly freed)
+    ipx_msg_ipfix_t *copy = ipx_msg_ipfix_branch_create(ipfix_msg, data->branch);
+    ipx_ctx_msg_pass(ctx, msg);
+
+    if (!copy) {
+        // The main branch is not affected
+        IPX_CTX_ERROR(ctx, "Memory allocation failed! (%s:%d)", __FILE__, __LINE__);
+        data->failed++;
+        return IPX_OK;
+    }
+
+    ipx_ctx_msg_pass(ctx, ipx_msg_ipfix2base(copy));
+    return IPX_OK;
+}
@@ -41,9 +41,12 @@
 
 #include <stdlib.h>
 #include <stddef.h>
+#include <assert.h>
 #include "plugin_output_mgr.h"
 #include "message_base.h"
 #include "context.h"
+#include "message_batch.h"
+#include "message_terminate.h"
 
 /** Definition of a connection with an output instance      */
 struct ipx_output_mgr_rec {
@@ -53,6 +56,51 @@ struct ipx_output_mgr_rec {
     enum ipx_odid_filter_type type;
     /** ODID filter (NULL if #type == IPX_ODID_FILTER_NONE) */
     const ipx_orange_t *odid_filter;
+    /** Branch of passed IPFIX Messages                     */
+    uint16_t branch;
+    /** Policy applied when the ring buffer is full         */
+    enum ipx_output_mgr_overflow overflow;
+
+    /** Backlog of messages (circular FIFO, only for #IPX_OUTPUT_MGR_OVERFLOW_SPILL) */
+    struct {
+        /** Array of messages (NULL, if not used)           */
+        ipx_msg_t **msgs;
+        /** Capacity of the backlog                         */
+        uint32_t size;
+        /** Index of the oldest message                     */
+        uint32_t head;
+        /** Number of messages in the backlog               */
+        uint32_t cnt;
+    } backlog;
+
+    /** Statistics (updated only by the output manager, read by anyone) */
+    struct {
+        /** Total number of dropped messages                */
+        uint64_t dropped;
+        /** Total number of messages stored into the backlog */
+        uint64_t spilled;
+        /** Number of messages in the backlog               */
+        uint32_t backlog;
+    } stats;
+};
+
+/** Initial number of slots of the cache of destinations (must be a power of two) */
+#define OUTPUT_MGR_CACHE_INIT (64U)
+/** Maximum number of slots of the cache of destinations (must be a power of two) */
+#define OUTPUT_MGR_CACHE_MAX  (65536U)
+
+/** Cached destinations of IPFIX Messages with the same ODID and branch */
+struct ipx_output_mgr_cache_rec {
+    /** Observation Domain ID                                */
+    uint32_t odid;
+    /** Branch of the pipeline                               */
+    uint16_t branch;
+    /** Number of selected destinations                      */
+    unsigned int dest_cnt;
+    /** Bit mask of selected destinations                    */
+    uint64_t dest_mask;
+    /** The slot is used                                     */
+    bool used;
 };
 
 /** List of output destinations */
@@ -61,6 +109,25 @@ struct ipx_output_mgr_list {
     size_t size;
     /** Array of records           */
     struct ipx_output_mgr_rec *recs;
+    /** Number of records with an ODID filter or a branch other than the main branch */
+    size_t filters;
+
+    /**
+     * Cache of destinations per ODID and branch (open addressing, linear probing)
+     * \note Filled lazily by the output manager and flushed when the list is modified.
+     */
+    struct {
+        /** Array of slots (NULL, if not allocated yet)  */
+        struct ipx_output_mgr_cache_rec *slots;
+        /** Number of slots (power of two)               */
+        uint32_t size;
+        /** Number of used slots                         */
+        uint32_t used;
+    } cache;
+    /** Broadcast ring buffer (NULL, if the broadcast mode is disabled) */
+    ipx_ring_t *bcast;
+    /** Prepared list of destinations (NULL, if there is no pending replacement)  */
+    struct ipx_output_mgr_list *pending;
 };
 
 ipx_output_mgr_list_t *
@@ -73,12 +140,43 @@ ipx_output_mgr_list_create()
 
     result->size = 0;
     result->recs = NULL;
+    result->filters = 0;
+    result->bcast = NULL;
+    result->pending = NULL;
+    result->cache.slots = NULL;
+    result->cache.size = 0;
+    result->cache.used = 0;
     return result;
 }
 
+/**
+ * \brief Remove all cached destinations
+ * \param[in] list List of output destinations
+ */
+static void
+output_mgr_cache_flush(struct ipx_output_mgr_list *list)
+{
+    free(list->cache.slots);
+    list->cache.slots = NULL;
+    list->cache.size = 0;
+    list->cache.used = 0;
+}
+
 void
 ipx_output_mgr_list_destroy(ipx_output_mgr_list_t *list)
 {
+    output_mgr_cache_flush(list);
+    for (size_t i = 0; i < list->size; ++i) {
+        struct ipx_output_mgr_rec *rec = &list->recs[i];
+        // Messages left in the backlog are not referenced by anyone else
+        for (uint32_t j = 0; j < rec->backlog.cnt; ++j) {
+            ipx_msg_t *msg = rec->backlog.msgs[(rec->backlog.head + j) % rec->backlog.size];
+            if (ipx_msg_header_cnt_dec(msg)) {
+                ipx_msg_destroy(msg);
+            }
+        }
+        free(rec->backlog.msgs);
+    }
     free(list->recs);
     free(list);
 }
@@ -91,23 +189,47 @@ ipx_output_mgr_list_empty(const ipx_output_mgr_list_t *list)
 
 int
 ipx_output_mgr_list_add(ipx_output_mgr_list_t *list, ipx_ring_t *ring,
-    enum ipx_odid_filter_type odid_type, const ipx_orange_t *odid_filter)
+    enum ipx_odid_filter_type odid_type, const ipx_orange_t *odid_filter, uint16_t branch,
+    enum ipx_output_mgr_overflow overflow)
 {
     // Check arguments
     if (list == NULL || ring == NULL) {
         return IPX_ERR_ARG;
     }
 
+    if (list->bcast != NULL && overflow != IPX_OUTPUT_MGR_OVERFLOW_BLOCK) {
+        // All destinations share the same ring buffer
+        return IPX_ERR_ARG;
+    }
+
     if (odid_type != IPX_ODID_FILTER_NONE && odid_filter == NULL) {
         // The ODID filter is missing
         return IPX_ERR_ARG;
     }
 
+    if (list->bcast == NULL && list->size == IPX_OUTPUT_MGR_MAX_DEST) {
+        // Destinations are represented by a 64-bit mask
+        return IPX_ERR_DENIED;
+    }
+
+    ipx_msg_t **backlog = NULL;
+    uint32_t backlog_size = 0;
+    if (overflow == IPX_OUTPUT_MGR_OVERFLOW_SPILL) {
+        struct ipx_ring_stats ring_stats;
+        ipx_ring_stats_get(ring, &ring_stats);
+        backlog_size = ring_stats.size * IPX_OUTPUT_MGR_SPILL_FACTOR;
+        backlog = malloc(backlog_size * sizeof(*backlog));
+        if (!backlog) {
+            return IPX_ERR_NOMEM;
+        }
+    }
+
     // Add a new record
     size_t new_size = list->size + 1;
     size_t recs_size = new_size * sizeof(struct ipx_output_mgr_rec);
     struct ipx_output_mgr_rec *new_recs = realloc(list->recs, recs_size);
     if (!new_recs) {
+        free(backlog);
         return IPX_ERR_NOMEM;
     }
 
@@ -118,6 +240,59 @@ ipx_output_mgr_list_add(ipx_output_mgr_list_t *list, ipx_ring_t *ring,
     rec->ring = ring;
     rec->type = odid_type;
     rec->odid_filter = odid_filter;
+    rec->branch = branch;
+    rec->overflow = overflow;
+    rec->backlog.msgs = backlog;
+    rec->backlog.size = backlog_size;
+    rec->backlog.head = 0;
+    rec->backlog.cnt = 0;
+    rec->stats.dropped = 0;
+    rec->stats.spilled = 0;
+    rec->stats.backlog = 0;
+    if (odid_type != IPX_ODID_FILTER_NONE || branch != 0) {
+        list->filters++;
+    }
+
+    // Cached destinations are not valid anymore
+    output_mgr_cache_flush(list);
+    return IPX_OK;
+}
+
+int
+ipx_output_mgr_list_bcast_set(ipx_output_mgr_list_t *list, ipx_ring_t *ring)
+{
+    if (list == NULL || ring == NULL || ipx_ring_type_get(ring) != IPX_RING_TYPE_BROADCAST) {
+        return IPX_ERR_ARG;
+    }
+
+    list->bcast = ring;
+    return IPX_OK;
+}
+
+int
+ipx_output_mgr_list_stats_get(const ipx_output_mgr_list_t *list, size_t idx,
+    struct ipx_output_mgr_stats *stats)
+{
+    if (list == NULL || idx >= list->size) {
+        return IPX_ERR_ARG;
+    }
+
+    const struct ipx_output_mgr_rec *rec = &list->recs[idx];
+    stats->dropped = __atomic_load_n(&rec->stats.dropped, __ATOMIC_RELAXED);
+    stats->spilled = __atomic_load_n(&rec->stats.spilled, __ATOMIC_RELAXED);
+    stats->backlog = __atomic_load_n(&rec->stats.backlog, __ATOMIC_RELAXED);
+    return IPX_OK;
+}
+
+int
+ipx_output_mgr_list_replace(ipx_output_mgr_list_t *list, ipx_output_mgr_list_t *new_list)
+{
+    if (list == NULL || new_list == NULL || list->bcast != NULL || new_list->bcast != NULL
+            || new_list->size == 0) {
+        return IPX_ERR_ARG;
+    }
+
+    __atomic_store_n(&list->pending, new_list, __ATOMIC_RELEASE);
     return IPX_OK;
 }
 
@@ -127,7 +302,7 @@ const struct ipx_plugin_info ipx_plugin_output_mgr_info = {
     .name    = "Output manager",
     .dsc     = "Internal IPFIXcol plugin for passing messages to output plugins.",
     .type    = IPX_PT_OUTPUT_MGR,
-    .flags   = 0,
+    .flags   = IPX_PF_BATCH,
     .version = "1.0.0",
     .ipx_min = "2.0.0"
 };
@@ -155,34 +330,27 @@ ipx_plugin_output_mgr_destroy(ipx_ctx_t *ctx, void *cfg)
     (void) cfg;
 }
 
-int
-ipx_plugin_output_mgr_process(ipx_ctx_t *ctx, void *cfg, ipx_msg_t *msg)
+/**
+ * \brief Evaluate ODID filters and branches of all output instances
+ * \param[in]  list     List of output destinations
+ * \param[in]  odid     Observation Domain ID
+ * \param[in]  branch   Branch of the pipeline
+ * \param[out] dest_cnt Number of selected destinations
+ * \return Bit mask of selected destinations
+ */
+static uint64_t
+output_mgr_dest_eval(const struct ipx_output_mgr_list *list, uint32_t odid, uint16_t branch,
+    unsigned int *dest_cnt)
 {
-    (void) ctx;
-    // List of output destination is prepared by the configurator
-    struct ipx_output_mgr_list *list = (struct ipx_output_mgr_list *) cfg;
-    assert(list != NULL);
-
-    // Only IPFIX messages are filtered
-    enum ipx_msg_type msg_type = ipx_msg_get_type(msg);
-    if (msg_type != IPX_MSG_IPFIX) {
-        // Set the number of references and pass the message to all output instances
-        ipx_msg_header_cnt_set(msg, (unsigned int) list->size);
-
-        for (size_t i = 0; i < list->size; ++i) {
-            ipx_ring_push(list->recs[i].ring, msg);
-        }
-
-        return IPX_OK;
-    }
-
-    // First, get number of destinations...
     uint64_t dest_mask = 0;
-    unsigned int dest_cnt = 0;
-    uint32_t odid = ipx_msg_ipfix_get_ctx(ipx_msg_base2ipfix(msg))->odid;
+    unsigned int cnt = 0;
 
     for (size_t i = 0; i < list->size; ++i) {
-        struct ipx_output_mgr_rec *rec = &list->recs[i];
+        const struct ipx_output_mgr_rec *rec = &list->recs[i];
+        if (rec->branch != branch) {
+            continue;
+        }
+
         switch (rec->type) {
         case IPX_ODID_FILTER_NONE:
             // Add to the destinations
@@ -202,13 +370,274 @@ ipx_plugin_output_mgr_process(ipx_ctx_t *ctx, void *cfg, ipx_msg_t *msg)
         }
 
         dest_mask |= (1ULL << i);
-        dest_cnt++;
+        cnt++;
+    }
+
+    *dest_cnt = cnt;
+    return dest_mask;
+}
+
+/**
+ * \brief Get a slot of the cache of destinations
+ * \param[in] slots  Array of slots
+ * \param[in] size   Number of slots (power of two)
+ * \param[in] odid   Observation Domain ID
+ * \param[in] branch Branch of the pipeline
+ * \return Slot with the ODID and branch or an unused slot where they should be stored
+ */
+static inline struct ipx_output_mgr_cache_rec *
+output_mgr_cache_slot(struct ipx_output_mgr_cache_rec *slots, uint32_t size, uint32_t odid,
+    uint16_t branch)
+{
+    // Multiplicative hashing (sequential ODIDs are spread over the whole table)
+    uint32_t idx = ((odid ^ ((uint32_t) branch << 16)) * 2654435761U) & (size - 1);
+    while (slots[idx].used && (slots[idx].odid != odid || slots[idx].branch != branch)) {
+        idx = (idx + 1) & (size - 1);
+    }
+
+    return &slots[idx];
+}
+
+/**
+ * \brief Make space in the cache of destinations for a new ODID
+ *
+ * If the cache is too occupied, its size is doubled. If the maximum size has been reached,
+ * all cached destinations are removed.
+ * \param[in] list List of output destinations
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_NOMEM in case of a memory allocation error (the cache is not usable)
+ */
+static int
+output_mgr_cache_reserve(struct ipx_output_mgr_list *list)
+{
+    // Keep the load factor under 1/2
+    if (list->cache.slots != NULL && 2 * (list->cache.used + 1) <= list->cache.size) {
+        return IPX_OK;
+    }
+
+    uint32_t new_size = (list->cache.size == 0) ? OUTPUT_MGR_CACHE_INIT : 2 * list->cache.size;
+    if (new_size > OUTPUT_MGR_CACHE_MAX) {
+        // Too many different ODIDs -> start again
+        new_size = OUTPUT_MGR_CACHE_INIT;
+        output_mgr_cache_flush(list);
+    }
+
+    struct ipx_output_mgr_cache_rec *new_slots = calloc(new_size, sizeof(*new_slots));
+    if (!new_slots) {
+        return IPX_ERR_NOMEM;
+    }
+
+    // Move all cached destinations
+    for (uint32_t i = 0; i < list->cache.size; ++i) {
+        const struct ipx_output_mgr_cache_rec *rec = &list->cache.slots[i];
+        if (!rec->used) {
+            continue;
+        }
+
+        *output_mgr_cache_slot(new_slots, new_size, rec->odid, rec->branch) = *rec;
+    }
+
+    free(list->cache.slots);
+    list->cache.slots = new_slots;
+    list->cache.size = new_size;
+    return IPX_OK;
+}
+
+/**
+ * \brief Get output instances that should receive an IPFIX Message (based on ODID filters and
+ *   branches)
+ *
+ * Destinations of each combination of ODID and branch are evaluated only once and stored in
+ * a cache.
+ * \param[in]  list     List of output destinations
+ * \param[in]  msg      IPFIX Message
+ * \param[out] dest_cnt Number of selected destinations
+ * \return Bit mask of selected destinations
+ */
+static uint64_t
+output_mgr_dest_mask(struct ipx_output_mgr_list *list, ipx_msg_ipfix_t *msg,
+    unsigned int *dest_cnt)
+{
+    const uint16_t branch = ipx_msg_ipfix_branch_get(msg);
+    if (list->filters == 0) {
+        if (branch != 0) {
+            // All destinations belong to the main branch
+            *dest_cnt = 0;
+            return 0;
+        }
+
+        // All destinations, no filters to evaluate
+        *dest_cnt = (unsigned int) list->size;
+        return (list->size == IPX_OUTPUT_MGR_MAX_DEST) ? UINT64_MAX : (1ULL << list->size) - 1;
+    }
+
+    uint32_t odid = ipx_msg_ipfix_get_ctx(msg)->odid;
+    if (list->cache.slots != NULL) {
+        struct ipx_output_mgr_cache_rec *rec;
+        rec = output_mgr_cache_slot(list->cache.slots, list->cache.size, odid, branch);
+        if (rec->used) {
+            *dest_cnt = rec->dest_cnt;
+            return rec->dest_mask;
+        }
+    }
+
+    uint64_t dest_mask = output_mgr_dest_eval(list, odid, branch, dest_cnt);
+    if (output_mgr_cache_reserve(list) != IPX_OK) {
+        // Failed to extend the cache, but the result is still valid
+        return dest_mask;
+    }
+
+    struct ipx_output_mgr_cache_rec *rec;
+    rec = output_mgr_cache_slot(list->cache.slots, list->cache.size, odid, branch);
+    rec->odid = odid;
+    rec->branch = branch;
+    rec->dest_cnt = *dest_cnt;
+    rec->dest_mask = dest_mask;
+    rec->used = true;
+    list->cache.used++;
+    return dest_mask;
+}
+
+/**
+ * \brief Pass messages from the backlog of a destination to its ring buffer
+ * \param[in] rec   Destination
+ * \param[in] block Wait until all messages are passed
+ */
+static void
+output_mgr_backlog_flush(struct ipx_output_mgr_rec *rec, bool block)
+{
+    while (rec->backlog.cnt > 0) {
+        ipx_msg_t *msg = rec->backlog.msgs[rec->backlog.head];
+        if (block) {
+            ipx_ring_push(rec->ring, msg);
+        } else if (!ipx_ring_try_push(rec->ring, msg)) {
+            break;
+        }
+
+        rec->backlog.head = (rec->backlog.head + 1) % rec->backlog.size;
+        rec->backlog.cnt--;
+    }
+
+    __atomic_store_n(&rec->stats.backlog, rec->backlog.cnt, __ATOMIC_RELAXED);
+}
+
+/**
+ * \brief Pass a message to a destination (the overflow policy is applied)
+ *
+ * Control messages (i.e. other than IPFIX Messages and their batches) are never dropped nor
+ * delayed in the backlog, therefore, they cannot overtake older IPFIX Messages.
+ * \warning The reference counter of the message MUST be already set!
+ * \param[in] rec  Destination
+ * \param[in] msg  Message to pass
+ * \param[in] data The message is an IPFIX Message or a batch
+ */
+static void
+output_mgr_push(struct ipx_output_mgr_rec *rec, ipx_msg_t *msg, bool data)
+{
+    if (!data || rec->overflow == IPX_OUTPUT_MGR_OVERFLOW_BLOCK) {
+        output_mgr_backlog_flush(rec, true);
+        ipx_ring_push(rec->ring, msg);
+        return;
+    }
+
+    if (rec->overflow == IPX_OUTPUT_MGR_OVERFLOW_DROP) {
+        if (ipx_ring_try_push(rec->ring, msg)) {
+            return;
+        }
+
+        __atomic_store_n(&rec->stats.dropped, rec->stats.dropped + 1, __ATOMIC_RELAXED);
+        if (ipx_msg_header_cnt_dec(msg)) {
+            // Other destinations have already processed the message
+            ipx_msg_destroy(msg);
+        }
+        return;
+    }
+
+    // IPX_OUTPUT_MGR_OVERFLOW_SPILL
+    output_mgr_backlog_flush(rec, false);
+    if (rec->backlog.cnt == 0 && ipx_ring_try_push(rec->ring, msg)) {
+        return;
+    }
+
+    if (rec->backlog.cnt == rec->backlog.size) {
+        // The backlog is full -> wait for the oldest message
+        ipx_ring_push(rec->ring, rec->backlog.msgs[rec->backlog.head]);
+        rec->backlog.head = (rec->backlog.head + 1) % rec->backlog.size;
+        rec->backlog.cnt--;
+    }
+
+    uint32_t idx = (rec->backlog.head + rec->backlog.cnt) % rec->backlog.size;
+    rec->backlog.msgs[idx] = msg;
+    rec->backlog.cnt++;
+    __atomic_store_n(&rec->stats.spilled, rec->stats.spilled + 1, __ATOMIC_RELAXED);
+    __atomic_store_n(&rec->stats.backlog, rec->backlog.cnt, __ATOMIC_RELAXED);
+}
+
+/**
+ * \brief Apply a pending replacement of the list of destinations
+ *
+ * Destinations with the same ring buffer in both lists keep their backlogs and statistics.
+ * Backlogs of the removed destinations are passed before the replacement (blocking).
+ * \param[in] list List of output destinations (used by the output manager)
+ */
+static void
+output_mgr_list_apply(struct ipx_output_mgr_list *list)
+{
+    struct ipx_output_mgr_list *pending = __atomic_exchange_n(&list->pending, NULL,
+        __ATOMIC_ACQUIRE);
+    if (pending == NULL) {
+        // Nothing to replace
+        return;
+    }
+
+    for (size_t i = 0; i < list->size; ++i) {
+        struct ipx_output_mgr_rec *rec_old = &list->recs[i];
+        struct ipx_output_mgr_rec *rec_new = NULL;
+        for (size_t j = 0; j < pending->size && rec_new == NULL; ++j) {
+            if (pending->recs[j].ring == rec_old->ring) {
+                rec_new = &pending->recs[j];
+            }
+        }
+
+        if (rec_new == NULL || rec_new->overflow != rec_old->overflow) {
+            // The destination has been removed (or its policy has changed)
+            output_mgr_backlog_flush(rec_old, true);
+            continue;
+        }
+
+        // Keep the backlog and statistics of the destination
+        struct ipx_output_mgr_rec tmp = *rec_new;
+        rec_new->backlog = rec_old->backlog;
+        rec_new->stats = rec_old->stats;
+        rec_old->backlog = tmp.backlog;
+        rec_old->stats = tmp.stats;
     }
 
+    // Swap the content of the lists, the previous one is freed by the configurator
+    struct ipx_output_mgr_list tmp = *list;
+    *list = *pending;
+    *pending = tmp;
+    list->pending = NULL;
+    pending->pending = NULL;
+}
+
+/**
+ * \brief Pass a message to selected output instances
+ *
+ * If there are no destinations, the message is destroyed.
+ * \param[in] list      List of output destinations
+ * \param[in] msg       IPFIX or batch message
+ * \param[in] dest_mask Bit mask of selected destinations
+ * \param[in] dest_cnt  Number of selected destinations
+ */
+static void
+output_mgr_send(struct ipx_output_mgr_list *list, ipx_msg_t *msg, uint64_t dest_mask,
+    unsigned int dest_cnt)
+{
     if (dest_cnt == 0) {
         // No-one wants the message -> destroy
-        ipx_msg_ipfix_destroy(ipx_msg_base2ipfix(msg));
-        return IPX_OK;
+        ipx_msg_destroy(msg);
+        return;
     }
 
     // Set the number of references and send to all selected destinations
@@ -219,9 +648,86 @@ ipx_plugin_output_mgr_process(ipx_ctx_t *ctx, void *cfg, ipx_msg_t *msg)
             continue;
         }
 
-        struct ipx_output_mgr_rec *rec = &list->recs[dest_idx];
-        ipx_ring_push(rec->ring, msg);
+        output_mgr_push(&list->recs[dest_idx], msg, true);
     }
+}
 
+/**
+ * \brief Pass a batch of IPFIX Messages to output instances
+ *
+ * If all IPFIX Messages in the batch are selected for the same output instances, the batch is
+ * passed as a whole. Otherwise, the batch is unpacked and its IPFIX Messages are passed
+ * individually.
+ * \param[in] list  List of output destinations
+ * \param[in] batch Batch message
+ */
+static void
+output_mgr_send_batch(struct ipx_output_mgr_list *list, ipx_msg_batch_t *batch)
+{
+    const uint32_t cnt = ipx_msg_batch_get_cnt(batch);
+    unsigned int dest_cnt;
+    uint64_t dest_mask = output_mgr_dest_mask(list, ipx_msg_batch_get(batch, 0), &dest_cnt);
+    bool unique = true;
+
+    for (uint32_t i = 1; i < cnt && unique; ++i) {
+        unsigned int tmp_cnt;
+        unique = (output_mgr_dest_mask(list, ipx_msg_batch_get(batch, i), &tmp_cnt) == dest_mask);
+    }
+
+    if (unique) {
+        output_mgr_send(list, ipx_msg_batch2base(batch), dest_mask, dest_cnt);
+        return;
+    }
+
+    for (uint32_t i = 0; i < cnt; ++i) {
+        ipx_msg_ipfix_t *msg = ipx_msg_batch_get(batch, i);
+        dest_mask = output_mgr_dest_mask(list, msg, &dest_cnt);
+        output_mgr_send(list, ipx_msg_ipfix2base(msg), dest_mask, dest_cnt);
+    }
+    ipx_msg_batch_release(batch);
+}
+
+int
+ipx_plugin_output_mgr_process(ipx_ctx_t *ctx, void *cfg, ipx_msg_t *msg)
+{
+    (void) ctx;
+    // List of output destination is prepared by the configurator
+    struct ipx_output_mgr_list *list = (struct ipx_output_mgr_list *) cfg;
+    assert(list != NULL);
+
+    enum ipx_msg_type msg_type = ipx_msg_get_type(msg);
+    if (msg_type == IPX_MSG_TERMINATE && ipx_msg_terminate_get_type(
+            ipx_msg_base2terminate(msg)) == IPX_MSG_TERMINATE_RECONF) {
+        // Switch to the new destinations, the message is passed only to them
+        output_mgr_list_apply(list);
+    }
+
+    if (list->bcast != NULL) {
+        // Write the message only once, output instances apply their filters by themselves
+        ipx_msg_header_cnt_set(msg, (unsigned int) list->size);
+        ipx_ring_push(list->bcast, msg);
+        return IPX_OK;
+    }
+
+    // Only IPFIX messages (and their batches) are filtered
+    if (msg_type == IPX_MSG_BATCH) {
+        output_mgr_send_batch(list, ipx_msg_base2batch(msg));
+        return IPX_OK;
+    }
+
+    if (msg_type != IPX_MSG_IPFIX) {
+        // Set the number of references and pass the message to all output instances
+        ipx_msg_header_cnt_set(msg, (unsigned int) list->size);
+
+        for (size_t i = 0; i < list->size; ++i) {
+            output_mgr_push(&list->recs[i], msg, false);
+        }
+
+        return IPX_OK;
+    }
+
+    unsigned int dest_cnt;
+    uint64_t dest_mask = output_mgr_dest_mask(list, ipx_msg_base2ipfix(msg), &dest_cnt);
+    output_mgr_send(list, msg, dest_mask, dest_cnt);
     return IPX_OK;
-}
\ No newline at end of file
+}
@@ -75,19 +75,113 @@ ipx_output_mgr_list_empty(const ipx_output_mgr_list_t *list);
 void
 ipx_output_mgr_list_destroy(ipx_output_mgr_list_t *list);
 
+/** Maximum number of destinations, if the broadcast ring buffer is not used */
+#define IPX_OUTPUT_MGR_MAX_DEST (64U)
+
+/** Policy applied when the ring buffer of a destination is full */
+enum ipx_output_mgr_overflow {
+    /** Wait until the destination reads some messages (default)                                */
+    IPX_OUTPUT_MGR_OVERFLOW_BLOCK,
+    /** Drop the new IPFIX Message (control messages are never dropped)                         */
+    IPX_OUTPUT_MGR_OVERFLOW_DROP,
+    /**
+     * Store the IPFIX Message into a backlog of the destination and pass it as soon as the ring
+     * buffer has free space. The backlog can hold up to #IPX_OUTPUT_MGR_SPILL_FACTOR times of
+     * the size of the ring buffer. If the backlog is full, wait as in case of
+     * #IPX_OUTPUT_MGR_OVERFLOW_BLOCK.
+     */
+    IPX_OUTPUT_MGR_OVERFLOW_SPILL
+};
+
+/** Size of the backlog of #IPX_OUTPUT_MGR_OVERFLOW_SPILL (multiple of the ring buffer size) */
+#define IPX_OUTPUT_MGR_SPILL_FACTOR (8U)
+
+/** Statistics of a destination */
+struct ipx_output_mgr_stats {
+    /** Total number of dropped IPFIX Messages (and batches)                                    */
+    uint64_t dropped;
+    /** Total number of IPFIX Messages (and batches) stored into the backlog                    */
+    uint64_t spilled;
+    /** Number of messages currently in the backlog                                             */
+    uint32_t backlog;
+};
+
 /**
  * \brief Add a new destination to the list
+ *
+ * \note In the broadcast mode (see ipx_output_mgr_list_bcast_set()), the \p ring should be
+ *   a reader view of the broadcast ring buffer and the ODID filter is only informative.
  * \param[in] list        Output manager list
  * \param[in] ring        Output plugin connection  (for a writer)
  * \param[in] odid_type   ODID filter type
  * \param[in] odid_filter ODID filter (should be NULL, if odid_type == IPX_ODID_FILTER_NONE)
+ * \param[in] branch      Branch of IPFIX Messages passed to the destination (0 = main branch)
+ * \param[in] overflow    Policy applied when the ring buffer is full (in the broadcast mode,
+ *   only #IPX_OUTPUT_MGR_OVERFLOW_BLOCK is supported)
  * \return #IPX_OK on success
  * \return #IPX_ERR_ARG in case of invalid combination of arguments
+ * \return #IPX_ERR_DENIED if the broadcast mode is disabled and the list already contains
+ *   #IPX_OUTPUT_MGR_MAX_DEST destinations
  * \return #IPX_ERR_NOMEM if a memory allocation error has occurred
  */
 int
 ipx_output_mgr_list_add(ipx_output_mgr_list_t *list, ipx_ring_t *ring,
-    enum ipx_odid_filter_type odid_type, const ipx_orange_t *odid_filter);
+    enum ipx_odid_filter_type odid_type, const ipx_orange_t *odid_filter, uint16_t branch,
+    enum ipx_output_mgr_overflow overflow);
+
+/**
+ * \brief Get statistics of a destination
+ *
+ * \note Can be called from any thread while the output manager is running.
+ * \param[in]  list  Output manager list
+ * \param[in]  idx   Index of the destination (in order of addition)
+ * \param[out] stats Statistics
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_ARG if the destination doesn't exist
+ */
+int
+ipx_output_mgr_list_stats_get(const ipx_output_mgr_list_t *list, size_t idx,
+    struct ipx_output_mgr_stats *stats);
+
+/**
+ * \brief Enable the broadcast mode
+ *
+ * All messages are written only once into the broadcast ring buffer (see
+ * #IPX_RING_TYPE_BROADCAST) and each destination reads them using its own view of the buffer.
+ * The number of destinations is not limited. However, the output manager doesn't apply ODID
+ * filters, therefore, output instances must filter IPFIX Messages by themselves (see
+ * ipx_ctx_odid_filter_set()).
+ * \note The ring buffer is NOT freed by ipx_output_mgr_list_destroy()!
+ * \param[in] list Output manager list
+ * \param[in] ring Broadcast ring buffer (for the writer)
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_ARG if the ring buffer is not a broadcast ring buffer
+ */
+int
+ipx_output_mgr_list_bcast_set(ipx_output_mgr_list_t *list, ipx_ring_t *ring);
+
+/**
+ * \brief Replace destinations of a running output manager
+ *
+ * The replacement is not immediate. The output manager swaps the content of the lists when it
+ * receives a reconfiguration message (#IPX_MSG_TERMINATE_RECONF), therefore, all messages
+ * received before the reconfiguration message are passed to the previous destinations and all
+ * messages after it (including the message) are passed to the new destinations.
+ *
+ * Destinations of both lists with the same ring buffer keep their backlogs and statistics.
+ * Backlogs of the removed destinations are passed to them before the replacement.
+ *
+ * \note After the reconfiguration message has been destroyed (i.e. processed by all new
+ *   destinations), the \p new_list holds the previous destinations, which are not used by
+ *   the output manager anymore, and it should be destroyed by the caller.
+ * \warning The broadcast mode is not supported.
+ * \param[in] list     Output manager list (used by the output manager)
+ * \param[in] new_list New list of destinations
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_ARG if any of lists uses the broadcast mode or the \p new_list is empty
+ */
+int
+ipx_output_mgr_list_replace(ipx_output_mgr_list_t *list, ipx_output_mgr_list_t *new_list);
 
 // ------------------------------------------------------------------------------------------------
 
@@ -39,11 +39,94 @@
  *
  */
 
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
 #include "fpipe.h"
 #include "context.h"
 #include "plugin_parser.h"
 #include "parser.h"
 
+/** Maximum number of garbage objects collected before they are passed as a single message     */
+#define PARSER_GC_MAX_CNT (64U)
+/** Maximum time of holding collected garbage objects (in milliseconds)                         */
+#define PARSER_GC_MAX_AGE (1000U)
+/** Interval between reports of unexpected sequence numbers (in seconds)                        */
+#define PARSER_SEQ_REPORT_INTERVAL (60)
+/** Default maximum size of buffered Data Sets with unknown templates per source (in bytes)    */
+#define PARSER_PENDING_SIZE (32768U)
+/** Default maximum age of buffered Data Sets with unknown templates (in seconds)               */
+#define PARSER_PENDING_TIMEOUT (10U)
+
+/** Private data of the parser plugin */
+struct parser_plugin {
+    /** Parser of IPFIX Messages                                                 */
+    ipx_parser_t *parser;
+    /** Collected garbage waiting to be passed (NULL, if not available)          */
+    ipx_gc_t *gc;
+    /** Number of garbage objects in the container                               */
+    unsigned int gc_cnt;
+    /** Time when the oldest garbage object has been collected                   */
+    struct timespec gc_since;
+    /** Time of the previous report of unexpected sequence numbers               */
+    struct timespec seq_since;
+    /** Path to the state file with templates (NULL, if disabled)                */
+    char *state_file;
+    /** Interval between periodic saves of the state file (0 = only on exit)     */
+    uint64_t state_interval;
+    /** Time of the previous save of the state file                              */
+    struct timespec state_since;
+    /** Runtime metrics are available                                            */
+    bool metrics_en;
+    /** Runtime metrics (see ipx_ctx_metric_register())                          */
+    struct {
+        struct ipx_metric *recs_expected; /**< Expected Data Records              */
+        struct ipx_metric *recs_received; /**< Received Data Records              */
+        struct ipx_metric *reorders;      /**< Reordered or duplicated messages   */
+        struct ipx_metric *resets;        /**< Resets of Sequence Numbers         */
+        struct ipx_metric *evictions;     /**< Evicted sources                    */
+        struct ipx_metric *dropped;       /**< Dropped messages                   */
+        struct ipx_metric *pending_buffered;  /**< Buffered Data Sets             */
+        struct ipx_metric *pending_recovered; /**< Recovered Data Sets            */
+        struct ipx_metric *pending_expired;   /**< Expired Data Sets              */
+    } metrics;
+};
+
+/*
+ * <params>
+ *  <maxSources>...</maxSources>         <!-- optional, 0 = unlimited -->
+ *  <stateFile>...</stateFile>           <!-- optional, save templates into the file -->
+ *  <stateInterval>...</stateInterval>   <!-- optional, 0 = only on exit -->
+ *  <stateRestore>...</stateRestore>     <!-- optional, multiple, load templates -->
+ *  <pendingSize>...</pendingSize>       <!-- optional, bytes per source, 0 = disabled -->
+ *  <pendingTimeout>...</pendingTimeout> <!-- optional, seconds -->
+ * </params>
+ */
+
+/** XML nodes of the parameters */
+enum parser_params_xml_nodes {
+    PARSER_NODE_MAX_SOURCES = 1,
+    PARSER_NODE_STATE_FILE,
+    PARSER_NODE_STATE_INTERVAL,
+    PARSER_NODE_STATE_RESTORE,
+    PARSER_NODE_PENDING_SIZE,
+    PARSER_NODE_PENDING_TIMEOUT
+};
+
+/** Definition of the \<params\> node  */
+static const struct fds_xml_args parser_args_params[] = {
+    FDS_OPTS_ROOT("params"),
+    FDS_OPTS_ELEM(PARSER_NODE_MAX_SOURCES, "maxSources", FDS_OPTS_T_UINT, FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM(PARSER_NODE_STATE_FILE, "stateFile", FDS_OPTS_T_STRING, FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM(PARSER_NODE_STATE_INTERVAL, "stateInterval", FDS_OPTS_T_UINT, FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM(PARSER_NODE_STATE_RESTORE, "stateRestore", FDS_OPTS_T_STRING,
+        FDS_OPTS_P_OPT | FDS_OPTS_P_MULTI),
+    FDS_OPTS_ELEM(PARSER_NODE_PENDING_SIZE, "pendingSize", FDS_OPTS_T_UINT, FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM(PARSER_NODE_PENDING_TIMEOUT, "pendingTimeout", FDS_OPTS_T_UINT, FDS_OPTS_P_OPT),
+    FDS_OPTS_END
+};
+
 const struct ipx_plugin_info ipx_plugin_parser_info = {
     .name    = "IPFIX Parser",
     .dsc     = "Internal IPFIXcol plugin for parsing IPFIX and NetFlow Messages",
@@ -53,11 +136,181 @@ const struct ipx_plugin_info ipx_plugin_parser_info = {
     .ipx_min = "2.0.0"
 };
 
+/**
+ * \brief Parse parameters of the parser and configure it
+ *
+ * Templates from state files are loaded immediately, however, a malformed or unreadable file
+ * is not considered as a failure.
+ * \param[in] ctx    Plugin context
+ * \param[in] data   Private data of the plugin (with the parser to configure)
+ * \param[in] params XML parameters
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_FORMAT in case of failure
+ */
+static int
+parser_plugin_params(ipx_ctx_t *ctx, struct parser_plugin *data, const char *params)
+{
+    ipx_parser_t *parser = data->parser;
+    fds_xml_t *xml = fds_xml_create();
+    if (!xml) {
+        IPX_CTX_ERROR(ctx, "Memory allocation error (%s:%d)", __FILE__, __LINE__);
+        return IPX_ERR_FORMAT;
+    }
+
+    if (fds_xml_set_args(xml, parser_args_params) != FDS_OK) {
+        IPX_CTX_ERROR(ctx, "Failed to parse the description of an XML document!", '\0');
+        fds_xml_destroy(xml);
+        return IPX_ERR_FORMAT;
+    }
+
+    fds_xml_ctx_t *root = fds_xml_parse_mem(xml, params, true);
+    if (root == NULL) {
+        IPX_CTX_ERROR(ctx, "Failed to parse the configuration: %s", fds_xml_last_err(xml));
+        fds_xml_destroy(xml);
+        return IPX_ERR_FORMAT;
+    }
+
+    size_t pending_size = PARSER_PENDING_SIZE;
+    uint32_t pending_timeout = PARSER_PENDING_TIMEOUT;
+
+    const struct fds_xml_cont *content;
+    while (fds_xml_next(root, &content) != FDS_EOC) {
+        switch (content->id) {
+        case PARSER_NODE_MAX_SOURCES:
+            assert(content->type == FDS_OPTS_T_UINT);
+            ipx_parser_limit_set(parser, (size_t) content->val_uint);
+            break;
+        case PARSER_NODE_STATE_FILE:
+            assert(content->type == FDS_OPTS_T_STRING);
+            if (content->ptr_string[0] == '\0') {
+                break;
+            }
+
+            free(data->state_file);
+            data->state_file = strdup(content->ptr_string);
+            if (!data->state_file) {
+                IPX_CTX_ERROR(ctx, "Memory allocation error (%s:%d)", __FILE__, __LINE__);
+                fds_xml_destroy(xml);
+                return IPX_ERR_FORMAT;
+            }
+            break;
+        case PARSER_NODE_STATE_INTERVAL:
+            assert(content->type == FDS_OPTS_T_UINT);
+            data->state_interval = content->val_uint;
+            break;
+        case PARSER_NODE_STATE_RESTORE:
+            assert(content->type == FDS_OPTS_T_STRING);
+            if (ipx_parser_state_load(parser, content->ptr_string) == IPX_ERR_NOMEM) {
+                fds_xml_destroy(xml);
+                return IPX_ERR_FORMAT;
+            }
+            break;
+        case PARSER_NODE_PENDING_SIZE:
+            assert(content->type == FDS_OPTS_T_UINT);
+            pending_size = (size_t) content->val_uint;
+            break;
+        case PARSER_NODE_PENDING_TIMEOUT:
+            assert(content->type == FDS_OPTS_T_UINT);
+            if (content->val_uint > UINT32_MAX) {
+                IPX_CTX_ERROR(ctx, "Timeout of buffered Data Sets is out of range!", '\0');
+                fds_xml_destroy(xml);
+                return IPX_ERR_FORMAT;
+            }
+            pending_timeout = (uint32_t) content->val_uint;
+            break;
+        default:
+            // Internal error
+            assert(false);
+        }
+    }
+
+    ipx_parser_pending_set(parser, pending_size, pending_timeout);
+    fds_xml_destroy(xml);
+    return IPX_OK;
+}
+
+/**
+ * \brief Register runtime metrics of the parser
+ *
+ * If any metric cannot be registered, runtime metrics are disabled.
+ * \param[in] ctx  Plugin context
+ * \param[in] data Private data of the plugin
+ */
+static void
+parser_plugin_metrics_register(ipx_ctx_t *ctx, struct parser_plugin *data)
+{
+    data->metrics.recs_expected = ipx_ctx_metric_register(ctx, IPX_METRIC_COUNTER,
+        "parser_records_expected_total",
+        "Number of Data Records expected based on Sequence Numbers (see received records)");
+    data->metrics.recs_received = ipx_ctx_metric_register(ctx, IPX_METRIC_COUNTER,
+        "parser_records_received_total", "Number of received Data Records");
+    data->metrics.reorders = ipx_ctx_metric_register(ctx, IPX_METRIC_COUNTER,
+        "parser_reorders_total", "Number of IPFIX Messages older than expected");
+    data->metrics.resets = ipx_ctx_metric_register(ctx, IPX_METRIC_COUNTER,
+        "parser_seq_resets_total", "Number of resets of Sequence Numbers");
+    data->metrics.evictions = ipx_ctx_metric_register(ctx, IPX_METRIC_COUNTER,
+        "parser_evictions_total", "Number of sources evicted due to the limit of sources");
+    data->metrics.dropped = ipx_ctx_metric_register(ctx, IPX_METRIC_COUNTER,
+        "parser_dropped_messages_total", "Number of malformed or blocked messages dropped");
+    data->metrics.pending_buffered = ipx_ctx_metric_register(ctx, IPX_METRIC_COUNTER,
+        "parser_pending_buffered_total", "Number of Data Sets buffered due to unknown templates");
+    data->metrics.pending_recovered = ipx_ctx_metric_register(ctx, IPX_METRIC_COUNTER,
+        "parser_pending_recovered_total", "Number of buffered Data Sets parsed later");
+    data->metrics.pending_expired = ipx_ctx_metric_register(ctx, IPX_METRIC_COUNTER,
+        "parser_pending_expired_total", "Number of Data Sets dropped due to unknown templates "
+        "after buffering or without space in the buffer");
+
+    data->metrics_en = data->metrics.recs_expected != NULL && data->metrics.recs_received != NULL
+        && data->metrics.reorders != NULL && data->metrics.resets != NULL
+        && data->metrics.evictions != NULL && data->metrics.dropped != NULL
+        && data->metrics.pending_buffered != NULL && data->metrics.pending_recovered != NULL
+        && data->metrics.pending_expired != NULL;
+    if (!data->metrics_en) {
+        IPX_CTX_WARNING(ctx, "Runtime metrics of the parser are not available.", '\0');
+    }
+}
+
+/**
+ * \brief Update runtime metrics of the parser after processing of an IPFIX Message
+ * \param[in] data Private data of the plugin
+ */
+static inline void
+parser_plugin_metrics_update(struct parser_plugin *data)
+{
+    if (!data->metrics_en) {
+        return;
+    }
+
+    struct ipx_parser_seq_stats total;
+    ipx_parser_seq_total(data->parser, &total);
+    ipx_metric_set(data->metrics.recs_expected, total.recs_expected);
+    ipx_metric_set(data->metrics.recs_received, total.recs_received);
+    ipx_metric_set(data->metrics.reorders, total.reorders);
+    ipx_metric_set(data->metrics.resets, total.resets);
+    ipx_metric_set(data->metrics.evictions, ipx_parser_evictions(data->parser));
+
+    struct ipx_parser_pending_stats pending;
+    ipx_parser_pending_stats_get(data->parser, &pending);
+    ipx_metric_set(data->metrics.pending_buffered, pending.buffered);
+    ipx_metric_set(data->metrics.pending_recovered, pending.recovered);
+    ipx_metric_set(data->metrics.pending_expired, pending.expired);
+}
+
+/**
+ * \brief Count a dropped message in runtime metrics of the parser
+ * \param[in] data Private data of the plugin
+ */
+static inline void
+parser_plugin_metrics_drop(struct parser_plugin *data)
+{
+    if (data->metrics_en) {
+        ipx_metric_add(data->metrics.dropped, 1);
+    }
+}
+
 int
 ipx_plugin_parser_init(ipx_ctx_t *ctx, const char *params)
 {
-    (void) params; // Not used
-
     // Subscribe to receive IPFIX and Session messages
     const uint16_t mask = IPX_MSG_IPFIX | IPX_MSG_SESSION;
     if (ipx_ctx_subscribe(ctx, &mask, NULL) != IPX_OK) {
@@ -70,9 +323,14 @@ ipx_plugin_parser_init(ipx_ctx_t *ctx, const char *params)
     enum ipx_verb_level plugin_vlevel = ipx_ctx_verb_get(ctx);
 
     // Create a parser
+    struct parser_plugin *data = calloc(1, sizeof(*data));
     ipx_parser_t *parser = ipx_parser_create(plugin_name, plugin_vlevel);
-    if (!parser) {
+    if (!data || !parser) {
         IPX_CTX_ERROR(ctx, "Failed to create a parser of IPFIX Messages!", '\0');
+        if (parser != NULL) {
+            ipx_parser_destroy(parser);
+        }
+        free(data);
         return IPX_ERR_DENIED;
     }
 
@@ -80,6 +338,7 @@ ipx_plugin_parser_init(ipx_ctx_t *ctx, const char *params)
     if (ipx_parser_ie_source(parser, ipx_ctx_iemgr_get(ctx), &garbage) != IPX_OK) {
         IPX_CTX_ERROR(ctx, "Failed to create set a source of Information Elements!", '\0');
         ipx_parser_destroy(parser);
+        free(data);
         return IPX_ERR_DENIED;
     }
 
@@ -88,17 +347,180 @@ ipx_plugin_parser_init(ipx_ctx_t *ctx, const char *params)
         ipx_msg_garbage_destroy(garbage);
     }
 
-    ipx_ctx_private_set(ctx, parser);
+    // Parameters are optional
+    data->parser = parser;
+    ipx_parser_pending_set(parser, PARSER_PENDING_SIZE, PARSER_PENDING_TIMEOUT);
+    if (params != NULL && params[0] != '\0'
+            && parser_plugin_params(ctx, data, params) != IPX_OK) {
+        ipx_parser_destroy(parser);
+        free(data->state_file);
+        free(data);
+        return IPX_ERR_FORMAT;
+    }
+
+    // Templates of closed Transport Sessions must be also saved
+    ipx_parser_state_keep(parser, data->state_file != NULL);
+
+    // Data Records are only counted, if no successor needs them
+    ipx_parser_relay_set(parser, ipx_ctx_relay_get(ctx));
+
+    // Garbage container is optional (without it, garbage is passed immediately)
+    data->gc = ipx_gc_create();
+    data->gc_cnt = 0;
+    clock_gettime(CLOCK_MONOTONIC_COARSE, &data->seq_since);
+    data->state_since = data->seq_since;
+    parser_plugin_metrics_register(ctx, data);
+    ipx_ctx_private_set(ctx, data);
     return IPX_OK;
 }
 
+/**
+ * \brief Pass all collected garbage as a single garbage message
+ * \param[in] ctx  Plugin context
+ * \param[in] data Private data of the plugin
+ */
+static void
+parser_plugin_gc_flush(ipx_ctx_t *ctx, struct parser_plugin *data)
+{
+    if (data->gc == NULL || data->gc_cnt == 0) {
+        return;
+    }
+
+    ipx_msg_garbage_t *msg = ipx_gc_to_msg(data->gc);
+    if (!msg) {
+        // Try it again later
+        IPX_CTX_WARNING(ctx, "A memory allocation failed (%s:%d).", __FILE__, __LINE__);
+        return;
+    }
+
+    ipx_ctx_msg_pass(ctx, ipx_msg_garbage2base(msg));
+    data->gc = ipx_gc_create();
+    data->gc_cnt = 0;
+}
+
+/**
+ * \brief Collect garbage of a garbage message
+ *
+ * Instead of passing each garbage message through the whole pipeline, garbage objects are
+ * collected and passed as a single message, when their number or age exceeds a limit.
+ * Since the garbage is passed later than it would be passed otherwise, it's still guaranteed
+ * that the garbage is destroyed after all messages that can reference it.
+ * \note If the garbage cannot be collected, the message is passed immediately.
+ * \param[in] ctx  Plugin context
+ * \param[in] data Private data of the plugin
+ * \param[in] msg  Garbage message
+ */
+static void
+parser_plugin_gc_add(ipx_ctx_t *ctx, struct parser_plugin *data, ipx_msg_garbage_t *msg)
+{
+    if (data->gc == NULL || ipx_gc_add_msg(data->gc, msg) != IPX_OK) {
+        ipx_ctx_msg_pass(ctx, ipx_msg_garbage2base(msg));
+        return;
+    }
+
+    if (data->gc_cnt++ == 0) {
+        clock_gettime(CLOCK_MONOTONIC_COARSE, &data->gc_since);
+    }
+
+    if (data->gc_cnt >= PARSER_GC_MAX_CNT) {
+        parser_plugin_gc_flush(ctx, data);
+    }
+}
+
+/**
+ * \brief Pass collected garbage, if the oldest object has been held for too long
+ * \param[in] ctx  Plugin context
+ * \param[in] data Private data of the plugin
+ */
+static inline void
+parser_plugin_gc_check(ipx_ctx_t *ctx, struct parser_plugin *data)
+{
+    if (data->gc_cnt == 0) {
+        return;
+    }
+
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC_COARSE, &now);
+    uint64_t age = (uint64_t) (now.tv_sec - data->gc_since.tv_sec) * 1000U
+        + (now.tv_nsec - data->gc_since.tv_nsec) / 1000000;
+    if (age >= PARSER_GC_MAX_AGE) {
+        parser_plugin_gc_flush(ctx, data);
+    }
+}
+
+/**
+ * \brief Periodically report unexpected sequence numbers (aggregated per Transport Session)
+ * \param[in] data Private data of the plugin
+ */
+static inline void
+parser_plugin_seq_check(struct parser_plugin *data)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC_COARSE, &now);
+    if (now.tv_sec - data->seq_since.tv_sec < PARSER_SEQ_REPORT_INTERVAL) {
+        return;
+    }
+
+    ipx_parser_seq_report(data->parser);
+    data->seq_since = now;
+}
+
+/**
+ * \brief Periodically save templates into the state file (if enabled)
+ * \param[in] data Private data of the plugin
+ */
+static inline void
+parser_plugin_state_check(struct parser_plugin *data)
+{
+    if (data->state_file == NULL || data->state_interval == 0) {
+        return;
+    }
+
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC_COARSE, &now);
+    if ((uint64_t) (now.tv_sec - data->state_since.tv_sec) < data->state_interval) {
+        return;
+    }
+
+    // Note: Failure is not fatal (an error message has been printed)
+    ipx_parser_state_save(data->parser, data->state_file);
+    data->state_since = now;
+}
+
 void
 ipx_plugin_parser_destroy(ipx_ctx_t *ctx, void *cfg)
 {
-    ipx_parser_t *parser = (ipx_parser_t *) cfg;
+    struct parser_plugin *data = (struct parser_plugin *) cfg;
+    ipx_parser_t *parser = data->parser;
+    ipx_msg_garbage_cb cb = (ipx_msg_garbage_cb) &ipx_parser_destroy;
+
+    if (data->state_file != NULL) {
+        ipx_parser_state_save(parser, data->state_file);
+        free(data->state_file);
+    }
+
+    // The parser MUST be destroyed after the collected garbage (i.e. in the same message)
+    if (data->gc != NULL && ipx_gc_add(data->gc, parser, cb) == IPX_OK) {
+        data->gc_cnt++;
+        parser = NULL;
+    }
+
+    parser_plugin_gc_flush(ctx, data);
+    if (data->gc_cnt != 0) {
+        /* Failed to create a message
+         * Unfortunately, we can't destroy the garbage (incl. the parser) because its (Options)
+         * Templates can be still referenced by earlier IPFIX Messages -> memory leak
+         */
+        ipx_gc_release(data->gc);
+    }
+
+    ipx_gc_destroy(data->gc);
+    free(data);
+    if (!parser) {
+        return;
+    }
 
     // Create a garbage message
-    ipx_msg_garbage_cb cb = (ipx_msg_garbage_cb) &ipx_parser_destroy;
     ipx_msg_garbage_t *garbage = ipx_msg_garbage_create(parser, cb);
     if (!garbage) {
         /* Failed to create a message
@@ -119,12 +541,13 @@ ipx_plugin_parser_destroy(ipx_ctx_t *ctx, void *cfg)
  * If the event is of close type, information about the particular Transport Session will be
  * removed, i.e. all template managers and counters of sequence numbers.
  * \param[in] ctx         Plugin context
- * \param[in] parser      IPFIX Message parser
+ * \param[in] data        Private data of the plugin
  * \param[in] msg_session Transport Session message
  * \return Always #IPX_OK
  */
 static inline int
-parser_plugin_process_session(ipx_ctx_t *ctx, ipx_parser_t *parser, ipx_msg_session_t *msg_session)
+parser_plugin_process_session(ipx_ctx_t *ctx, struct parser_plugin *data,
+    ipx_msg_session_t *msg_session)
 {
     if (ipx_msg_session_get_event(msg_session) != IPX_MSG_SESSION_CLOSE) {
         // Ignore non-close events
@@ -136,7 +559,7 @@ parser_plugin_process_session(ipx_ctx_t *ctx, ipx_parser_t *parser, ipx_msg_sess
     const struct ipx_session *session = ipx_msg_session_get_session(msg_session);
 
     ipx_msg_garbage_t *msg_garbage;
-    if ((rc = ipx_parser_session_remove(parser, session, &msg_garbage)) == IPX_OK) {
+    if ((rc = ipx_parser_session_remove(data->parser, session, &msg_garbage)) == IPX_OK) {
         // Everything is fine, pass the message(s)
         ipx_ctx_msg_pass(ctx, ipx_msg_session2base(msg_session));
 
@@ -150,7 +573,7 @@ parser_plugin_process_session(ipx_ctx_t *ctx, ipx_parser_t *parser, ipx_msg_sess
             return IPX_OK;
         }
 
-        ipx_ctx_msg_pass(ctx, ipx_msg_garbage2base(msg_garbage));
+        parser_plugin_gc_add(ctx, data, msg_garbage);
         return IPX_OK;
     }
 
@@ -181,14 +604,16 @@ parser_plugin_process_session(ipx_ctx_t *ctx, ipx_parser_t *parser, ipx_msg_sess
  *
  * \warning Plugin context MUST be able to pass messages!
  * \param[in] ctx    Plugin context
- * \param[in] parser Parser
+ * \param[in] data   Private data of the plugin
  * \param[in] ts     Transport Session to remove
  * \return #IPX_OK on success
  * \return #IPX_ERR_ARG in case of fatal internal error
  */
 static inline int
-parser_plugin_remove_session(ipx_ctx_t *ctx, ipx_parser_t *parser, const struct ipx_session *ts)
+parser_plugin_remove_session(ipx_ctx_t *ctx, struct parser_plugin *data,
+    const struct ipx_session *ts)
 {
+    ipx_parser_t *parser = data->parser;
     ipx_msg_garbage_t *garbage;
 
     // Try to send request to close the Transport Session
@@ -201,7 +626,7 @@ parser_plugin_remove_session(ipx_ctx_t *ctx, ipx_parser_t *parser, const struct
 
         int rc = ipx_parser_session_remove(parser, ts, &garbage);
         if (rc == IPX_OK && garbage != NULL) {
-            ipx_ctx_msg_pass(ctx, ipx_msg_garbage2base(garbage));
+            parser_plugin_gc_add(ctx, data, garbage);
         }
 
         return IPX_OK;
@@ -215,7 +640,7 @@ parser_plugin_remove_session(ipx_ctx_t *ctx, ipx_parser_t *parser, const struct
 
         int rc = ipx_parser_session_remove(parser, ts, &garbage);
         if (rc == IPX_OK && garbage != NULL) {
-            ipx_ctx_msg_pass(ctx, ipx_msg_garbage2base(garbage));
+            parser_plugin_gc_add(ctx, data, garbage);
         }
         return IPX_OK;
     }
@@ -239,26 +664,27 @@ parser_plugin_remove_session(ipx_ctx_t *ctx, ipx_parser_t *parser, const struct
  * caused parsing errors, etc.
  *
  * \param[in] ctx    Plugin context
- * \param[in] parser IPFIX Message parser
+ * \param[in] data   Private data of the plugin
  * \param[in] ipfix  IPFIX Message
  * \return #IPX_OK on success or on non-fatal failure
  * \return #IPX_ERR_ARG on a fatal failure
  */
 static inline int
-parser_plugin_process_ipfix(ipx_ctx_t *ctx, ipx_parser_t *parser, ipx_msg_ipfix_t *ipfix)
+parser_plugin_process_ipfix(ipx_ctx_t *ctx, struct parser_plugin *data, ipx_msg_ipfix_t *ipfix)
 {
     int rc;
     ipx_msg_garbage_t *garbage;
 
-    if ((rc = ipx_parser_process(parser, &ipfix, &garbage)) == IPX_OK) {
+    if ((rc = ipx_parser_process(data->parser, &ipfix, &garbage)) == IPX_OK) {
         // Everything is fine, pass the message(s)
         ipx_ctx_msg_pass(ctx, ipx_msg_ipfix2base(ipfix));
+        parser_plugin_metrics_update(data);
 
         if (garbage != NULL) {
             /* Garbage MUST be send after the IPFIX Message because the message can have
              * references to templates in this garbage message!
              */
-            ipx_ctx_msg_pass(ctx, ipx_msg_garbage2base(garbage));
+            parser_plugin_gc_add(ctx, data, garbage);
         }
         return IPX_OK;
     }
@@ -266,6 +692,7 @@ parser_plugin_process_ipfix(ipx_ctx_t *ctx, ipx_parser_t *parser, ipx_msg_ipfix_
     if (rc == IPX_ERR_DENIED) {
         // Due to previous failures, connection to the session is blocked
         ipx_msg_ipfix_destroy(ipfix);
+        parser_plugin_metrics_drop(data);
         return IPX_OK;
     }
 
@@ -274,12 +701,14 @@ parser_plugin_process_ipfix(ipx_ctx_t *ctx, ipx_parser_t *parser, ipx_msg_ipfix_
     if (rc == IPX_ERR_FORMAT && msg_ctx->session->type == FDS_SESSION_UDP) {
         // In case of UDP and malformed message, just drop the message
         ipx_msg_ipfix_destroy(ipfix);
+        parser_plugin_metrics_drop(data);
         return IPX_OK;
     }
 
     // Try to send request to close the Transport Session or remove it
-    rc = parser_plugin_remove_session(ctx, parser, msg_ctx->session);
+    rc = parser_plugin_remove_session(ctx, data, msg_ctx->session);
     ipx_msg_ipfix_destroy(ipfix); // Note: msg_ctx is not available anymore!
+    parser_plugin_metrics_drop(data);
     return rc;
 }
 
@@ -287,16 +716,16 @@ int
 ipx_plugin_parser_process(ipx_ctx_t *ctx, void *cfg, ipx_msg_t *msg)
 {
     int rc;
-    ipx_parser_t *parser = (ipx_parser_t *) cfg;
+    struct parser_plugin *data = (struct parser_plugin *) cfg;
 
     switch (ipx_msg_get_type(msg)) {
     case IPX_MSG_IPFIX:
         // Process IPFIX Message
-        rc = parser_plugin_process_ipfix(ctx, parser, ipx_msg_base2ipfix(msg));
+        rc = parser_plugin_process_ipfix(ctx, data, ipx_msg_base2ipfix(msg));
         break;
     case IPX_MSG_SESSION:
         // Process Transport Session
-        rc = parser_plugin_process_session(ctx, parser, ipx_msg_base2session(msg));
+        rc = parser_plugin_process_session(ctx, data, ipx_msg_base2session(msg));
         break;
     default:
         // Unexpected type of the message
@@ -306,6 +735,11 @@ ipx_plugin_parser_process(ipx_ctx_t *ctx, void *cfg, ipx_msg_t *msg)
         break;
     }
 
+    // Do not hold collected garbage for too long (e.g. on a low traffic)
+    parser_plugin_gc_check(ctx, data);
+    parser_plugin_seq_check(data);
+    parser_plugin_state_check(data);
+
     if (rc != IPX_OK) {
         // Unrecoverable error
         return IPX_ERR_DENIED;
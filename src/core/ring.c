@@ -40,12 +40,19 @@
  */
 
 #include <stdlib.h> // aligned_malloc
-//#include <unistd.h>
+#include <string.h> // memcpy
+#include <unistd.h>
+#include <limits.h>
 #include <pthread.h>
+#include <sched.h>
 #include <time.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+#include <linux/mempolicy.h>
 
 #include "ring.h"
 #include "verbose.h"
+#include "trace.h"
 
 
 // START TODO: move into header files
@@ -67,6 +74,47 @@
 /** Internal identification of the ring buffer */
 static const char *module = "Ring buffer";
 
+/** Number of busy-wait iterations before a waiting reader/writer yields the CPU */
+#define RING_WAIT_SPIN_CNT (128U)
+/** Number of CPU yields before a waiting reader/writer goes to sleep            */
+#define RING_WAIT_YIELD_CNT (16U)
+/** Maximum sleep time of a lock-free reader/writer (in milliseconds)          */
+#define RING_LF_SLEEP_MS (10L)
+/** Number of single message reads between updates of the high-water mark       */
+#define RING_STATS_HWM_RATE (64U)
+/** Number of waits on a full buffer within a period that grow an adaptive buffer */
+#define RING_ADAPT_GROW_CNT (4U)
+/** Period of counting of waits on a full buffer (in nanoseconds)                */
+#define RING_ADAPT_GROW_PERIOD (1000000000ULL)
+/** Duration of low occupancy that shrinks an adaptive buffer (in nanoseconds)   */
+#define RING_ADAPT_SHRINK_PERIOD (30000000000ULL)
+/** Occupancy is low if at most this fraction (1/N) of the capacity is used      */
+#define RING_ADAPT_LOW_DIV (4U)
+
+/**
+ * \brief Segment of memory of a ring buffer with block synchronization
+ *
+ * A buffer with adaptive capacity replaces its segment by a new one of a different size.
+ * Messages written before the change remain in the old segment, which is released by
+ * the reader after it reads all of them.
+ */
+struct ring_seg {
+    /** \brief Ring data (array of pointers)                                            */
+    ipx_msg_t **data;
+    /** \brief Size of the segment (number of pointers)                                 */
+    uint32_t size;
+    /**
+     * \brief Writer index of the first message stored into the next segment
+     * \note Valid only if #next is not NULL.
+     */
+    uint32_t next_idx;
+    /**
+     * \brief Next segment (NULL if writers still use this one)
+     * \warning Can be read by a reader! Therefore, modification MUST be always atomic.
+     */
+    struct ring_seg *next;
+};
+
 /** \brief Data structure for a reader only */
 struct ring_reader {
     /**
@@ -99,8 +147,15 @@ struct ring_reader {
      */
     uint32_t div_block;
 
-    /** Previously read messages - only 0 or 1 */
+    /** Number of previously read messages (not confirmed yet) */
     uint32_t last;
+
+    /** \brief Segment of the next read operation                                     */
+    struct ring_seg *seg;
+    /** \brief Ring data of the segment (array of pointers)                            */
+    ipx_msg_t **data;
+    /** \brief Writers can replace the segment (see ipx_ring_adaptive_set())           */
+    bool adaptive;
 };
 
 /** \brief Data structure for writers only */
@@ -135,6 +190,28 @@ struct ring_writer {
      * \note After writing at least this amount of data, update synchronization structure.
      */
     uint32_t div_block;
+
+    /** \brief Segment of the next write operation                                    */
+    struct ring_seg *seg;
+    /** \brief Ring data of the segment (array of pointers)                           */
+    ipx_msg_t **data;
+};
+
+/**
+ * \brief Adaptive capacity of a ring buffer with block synchronization (writers only)
+ * \note Modified only by a writer holding the synchronization mutex.
+ */
+struct ring_adapt {
+    /** \brief Minimal capacity (number of pointers)                                  */
+    uint32_t min;
+    /** \brief Maximal capacity (number of pointers, 0 == adaptation disabled)        */
+    uint32_t max;
+    /** \brief Number of waits on a full buffer in the current period                 */
+    uint32_t waits;
+    /** \brief Start of the current period of counting of waits (in nanoseconds)      */
+    uint64_t waits_since;
+    /** \brief Start of the current period of low occupancy (in nanoseconds)          */
+    uint64_t low_since;
 };
 
 /** \brief Exchange data structure for reader and writers */
@@ -160,27 +237,423 @@ struct ring_sync {
     pthread_cond_t     cond_writer;
 };
 
+/** \brief Slot of a lock-free ring buffer */
+struct ring_lf_slot {
+    /**
+     * \brief Sequence number of the slot
+     * \note If equal to the ticket of a writer, the slot is empty and the writer can fill it.
+     *   If equal to the ticket + 1, the slot is full and the reader can read it.
+     * \note Value range [0..UINT32_MAX]. Overflow is expected behavior.
+     */
+    uint32_t seq;
+    /** \brief Message stored in the slot */
+    ipx_msg_t *msg;
+};
+
+/** \brief Data structure for a reader only (lock-free ring buffer) */
+struct ring_lf_reader {
+    /**
+     * \brief Ticket of the next slot to read
+     * \note Value range [0..UINT32_MAX]. Overflow is expected behavior.
+     */
+    uint32_t tail;
+    /** \brief Mask for conversion of a ticket to an index of the slot (size - 1)      */
+    uint32_t mask;
+    /** \brief Size of the ring buffer (always power of two)                         */
+    uint32_t size;
+};
+
+/** \brief Data structure for writers only (lock-free ring buffer) */
+struct ring_lf_writer {
+    /**
+     * \brief Ticket of the next slot to write
+     * \warning Shared by all writers. Modification MUST be always atomic.
+     * \note Value range [0..UINT32_MAX]. Overflow is expected behavior.
+     */
+    uint32_t head;
+    /** \brief Mask for conversion of a ticket to an index of the slot (size - 1)      */
+    uint32_t mask;
+};
+
+/** \brief Exchange data structure for reader and writers (lock-free ring buffer) */
+struct ring_lf_sync {
+    /** \brief The reader is (or is about to be) sleeping on an empty slot (0 or 1)   */
+    uint32_t reader_sleeping;
+    /** \brief Number of writers sleeping (or about to sleep) on a full slot           */
+    uint32_t writers_sleeping;
+};
+
+/** \brief Part of a broadcast ring buffer shared by the writer and all readers */
+struct ring_bc {
+    /** \brief Published writer head (readers can read up to here, exclusive)         */
+    uint32_t head             __ipx_cache_aligned;
+    /** \brief Number of readers sleeping (or about to sleep) on an empty buffer      */
+    uint32_t readers_sleeping __ipx_cache_aligned;
+    /** \brief The writer is (or is about to be) sleeping on a full buffer (0 or 1)   */
+    uint32_t writer_sleeping  __ipx_cache_aligned;
+
+    /** \brief Last known tail of the slowest reader (writer only)                     */
+    uint32_t min_tail         __ipx_cache_aligned;
+    /** \brief Mask for conversion of a ticket to an index of the slot (size - 1)      */
+    uint32_t mask;
+    /** \brief Total size of the ring buffer (number of pointers, power of two)        */
+    uint32_t size;
+    /** \brief Ring data (array of pointers)                                            */
+    ipx_msg_t **slots;
+    /** \brief The writer view (i.e. the owner of this structure)                       */
+    const struct ipx_ring *writer;
+    /** \brief Array of reader views                                                    */
+    struct ipx_ring **readers;
+    /** \brief Number of reader views                                                   */
+    uint32_t readers_cnt;
+};
+
+/**
+ * \brief Statistics updated by writers
+ * \warning Can be read by other threads! Therefore, modification MUST be always atomic.
+ */
+struct ring_stats_writer {
+    /** \brief Total number of pushed messages                                         */
+    uint64_t pushes;
+    /** \brief Total time spent by waiting on a full buffer (in nanoseconds)           */
+    uint64_t wait_full;
+    /** \brief Total number of changes of the capacity                                 */
+    uint64_t resizes;
+    /** \brief Current capacity (block synchronization only)                           */
+    uint32_t size;
+};
+
+/**
+ * \brief Statistics updated by the reader
+ * \warning Can be read by other threads! Therefore, modification MUST be always atomic.
+ */
+struct ring_stats_reader {
+    /** \brief Total number of popped messages                                         */
+    uint64_t pops;
+    /** \brief Total time spent by waiting on an empty buffer (in nanoseconds)         */
+    uint64_t wait_empty;
+    /** \brief Maximum observed number of messages in the buffer                       */
+    uint32_t high_water;
+};
+
 /** \brief Ring buffer */
 struct ipx_ring {
     /** A Reader only structure (cache aligned)         */
     struct ring_reader reader      __ipx_cache_aligned;
     /** Writers only structure (cache aligned)          */
     struct ring_writer writer      __ipx_cache_aligned;
+    /** Adaptive capacity (writers only)                */
+    struct ring_adapt  adapt;
     /** Writer lock                                     */
     pthread_spinlock_t writer_lock __ipx_cache_aligned;
     /** Synchronization structure (cache-aligned)       */
     struct ring_sync   sync        __ipx_cache_aligned;
     /** Multiple writers mode                           */
     bool               mw_mode;
-    /** Ring data (array of pointers)                   */
-    ipx_msg_t        **data;
+    /** Synchronization algorithm                       */
+    enum ipx_ring_type type;
+    /** Waiting strategy (never #IPX_RING_WAIT_DEFAULT) */
+    enum ipx_ring_wait wait;
+    /** Preferred NUMA node of new segments (-1 == any) */
+    int                node;
+
+    /** A lock-free reader only structure (cache aligned)           */
+    struct ring_lf_reader lf_reader __ipx_cache_aligned;
+    /** Lock-free writers only structure (cache aligned)            */
+    struct ring_lf_writer lf_writer __ipx_cache_aligned;
+    /** Lock-free synchronization structure (cache aligned)         */
+    struct ring_lf_sync   lf_sync   __ipx_cache_aligned;
+    /** Lock-free ring data (array of slots)                        */
+    struct ring_lf_slot  *lf_slots;
+
+    /**
+     * Shared part of a broadcast ring buffer (NULL for other types)
+     * \note A reader view uses only the lock-free reader structure as its own read cursor.
+     */
+    struct ring_bc       *bc;
+    /** The ring is a reader view of a broadcast ring buffer         */
+    bool                  bc_reader;
+
+    /** Statistics of writers (cache aligned)                       */
+    struct ring_stats_writer stats_writer __ipx_cache_aligned;
+    /** Statistics of the reader (cache aligned)                    */
+    struct ring_stats_reader stats_reader __ipx_cache_aligned;
 };
 
+/**
+ * \brief Round up a size to the nearest power of two
+ * \param[in] size Size (must be non-zero and at most 2^31)
+ * \return Rounded size
+ */
+static inline uint32_t
+ring_lf_size(uint32_t size)
+{
+    uint32_t result = 1;
+    while (result < size) {
+        result <<= 1;
+    }
+    return result;
+}
+
+/**
+ * \brief Allocate a page aligned memory block
+ *
+ * Page alignment allows to change NUMA placement of the block later (see ipx_ring_node_set()).
+ * \param[in] size Size of the block
+ * \return Pointer to the block or NULL
+ */
+static void *
+ring_alloc_pages(size_t size)
+{
+    const size_t page = (size_t) sysconf(_SC_PAGESIZE);
+    return aligned_alloc(page, ((size + page - 1) / page) * page);
+}
+
+/**
+ * \brief Bind a page aligned memory block to a NUMA node
+ * \param[in] addr Address of the block (can be NULL)
+ * \param[in] size Size of the block
+ * \param[in] node NUMA node
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_DENIED if the kernel refused the request
+ */
+static int
+ring_mem_bind(void *addr, size_t size, unsigned int node)
+{
+    if (addr == NULL || size == 0) {
+        return IPX_OK;
+    }
+
+    const size_t page = (size_t) sysconf(_SC_PAGESIZE);
+    const size_t word_bits = sizeof(unsigned long) * CHAR_BIT;
+    unsigned long nodemask[(node / word_bits) + 1];
+    memset(nodemask, 0, sizeof(nodemask));
+    nodemask[node / word_bits] = 1UL << (node % word_bits);
+
+    // Already touched pages are moved to the node too
+    size = ((size + page - 1) / page) * page;
+    long rc = syscall(SYS_mbind, addr, size, MPOL_PREFERRED, nodemask,
+        (unsigned long) (sizeof(nodemask) * CHAR_BIT), MPOL_MF_MOVE);
+    return (rc == 0) ? IPX_OK : IPX_ERR_DENIED;
+}
+
+/**
+ * \brief Create a segment of a ring buffer with block synchronization
+ * \param[in] size Size of the segment (number of pointers)
+ * \param[in] node Preferred NUMA node (-1 == any)
+ * \return Pointer to the segment or NULL (memory allocation error)
+ */
+static struct ring_seg *
+ring_seg_create(uint32_t size, int node)
+{
+    struct ring_seg *seg = malloc(sizeof(*seg));
+    if (!seg) {
+        return NULL;
+    }
+
+    seg->data = ring_alloc_pages(sizeof(*seg->data) * size);
+    if (!seg->data) {
+        free(seg);
+        return NULL;
+    }
+
+    seg->size = size;
+    seg->next_idx = 0;
+    seg->next = NULL;
+    if (node >= 0) {
+        // Failure is not fatal
+        ring_mem_bind(seg->data, sizeof(*seg->data) * size, (unsigned int) node);
+    }
+    return seg;
+}
+
+/**
+ * \brief Destroy a segment and all following segments
+ * \param[in] seg Segment (can be NULL)
+ */
+static void
+ring_seg_destroy(struct ring_seg *seg)
+{
+    while (seg != NULL) {
+        struct ring_seg *next = seg->next;
+        free(seg->data);
+        free(seg);
+        seg = next;
+    }
+}
+
+/**
+ * \brief Initialize broadcast part of the ring buffer
+ * \param[in] ring Ring buffer
+ * \param[in] size Required size of the buffer
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_NOMEM in case of a memory allocation error
+ */
+static int
+ring_bc_init(ipx_ring_t *ring, uint32_t size)
+{
+    const uint32_t bc_size = ring_lf_size(size);
+    struct ring_bc *bc = aligned_alloc(alignof(struct ring_bc), sizeof(*bc));
+    if (!bc) {
+        IPX_ERROR(module, "aligned_alloc() failed! (%s:%d)", __FILE__, __LINE__);
+        return IPX_ERR_NOMEM;
+    }
+
+    memset(bc, 0, sizeof(*bc));
+    bc->slots = ring_alloc_pages(sizeof(*bc->slots) * bc_size);
+    if (!bc->slots) {
+        IPX_ERROR(module, "aligned_alloc() failed! (%s:%d)", __FILE__, __LINE__);
+        free(bc);
+        return IPX_ERR_NOMEM;
+    }
+
+    if (bc_size != size) {
+        IPX_DEBUG(module, "Size of a broadcast ring buffer rounded up from %" PRIu32 " to %"
+            PRIu32 " messages.", size, bc_size);
+    }
+
+    bc->head = 0;
+    bc->min_tail = 0;
+    bc->size = bc_size;
+    bc->mask = bc_size - 1;
+    bc->writer = ring;
+    bc->readers = NULL;
+    bc->readers_cnt = 0;
+    ring->bc = bc;
+    ring->lf_writer.head = 0;
+    ring->lf_writer.mask = bc->mask;
+    return IPX_OK;
+}
+
+/**
+ * \brief Destroy broadcast part of the ring buffer (including all reader views)
+ * \param[in] ring Ring buffer (the writer view)
+ */
+static void
+ring_bc_destroy(ipx_ring_t *ring)
+{
+    struct ring_bc *bc = ring->bc;
+    if (!bc) {
+        return;
+    }
+
+    for (uint32_t i = 0; i < bc->readers_cnt; ++i) {
+        uint32_t cnt = bc->head - bc->readers[i]->lf_reader.tail;
+        if (cnt != 0) {
+            IPX_WARNING(module, "Destroying of a broadcast ring buffer that still contains %"
+                PRIu32 " message(s) unprocessed by the reader %" PRIu32 "!", cnt, i);
+        }
+        free(bc->readers[i]);
+    }
+
+    free(bc->readers);
+    free(bc->slots);
+    free(bc);
+    ring->bc = NULL;
+}
+
+ipx_ring_t *
+ipx_ring_bcast_reader_add(ipx_ring_t *ring)
+{
+    if (ring->type != IPX_RING_TYPE_BROADCAST || ring->bc_reader) {
+        IPX_ERROR(module, "Unable to add a reader of a ring buffer that is not a broadcast ring "
+            "buffer!", '\0');
+        return NULL;
+    }
+
+    struct ring_bc *bc = ring->bc;
+    struct ipx_ring **readers = realloc(bc->readers, (bc->readers_cnt + 1) * sizeof(*readers));
+    if (!readers) {
+        IPX_ERROR(module, "realloc() failed! (%s:%d)", __FILE__, __LINE__);
+        return NULL;
+    }
+    bc->readers = readers;
+
+    ipx_ring_t *view = aligned_alloc(alignof(struct ipx_ring), sizeof(struct ipx_ring));
+    if (!view) {
+        IPX_ERROR(module, "aligned_alloc() failed! (%s:%d)", __FILE__, __LINE__);
+        return NULL;
+    }
+
+    // The view has only its own read cursor, statistics and waiting strategy
+    memset(view, 0, sizeof(*view));
+    view->type = IPX_RING_TYPE_BROADCAST;
+    view->bc = bc;
+    view->bc_reader = true;
+    view->lf_reader.tail = bc->head;
+    view->lf_reader.mask = bc->mask;
+    view->lf_reader.size = bc->size;
+    ipx_ring_wait_set(view, IPX_RING_WAIT_DEFAULT);
+
+    bc->readers[bc->readers_cnt++] = view;
+    return view;
+}
+
+/**
+ * \brief Initialize lock-free part of the ring buffer
+ * \param[in] ring Ring buffer
+ * \param[in] size Required size of the buffer
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_NOMEM in case of a memory allocation error
+ */
+static int
+ring_lf_init(ipx_ring_t *ring, uint32_t size)
+{
+    const uint32_t lf_size = ring_lf_size(size);
+    ring->lf_slots = ring_alloc_pages(sizeof(*ring->lf_slots) * lf_size);
+    if (!ring->lf_slots) {
+        IPX_ERROR(module, "aligned_alloc() failed! (%s:%d)", __FILE__, __LINE__);
+        return IPX_ERR_NOMEM;
+    }
+
+    // Slot "i" is empty and waits for a writer with ticket "i"
+    for (uint32_t i = 0; i < lf_size; ++i) {
+        ring->lf_slots[i].seq = i;
+        ring->lf_slots[i].msg = NULL;
+    }
+
+    if (lf_size != size) {
+        IPX_DEBUG(module, "Size of a lock-free ring buffer rounded up from %" PRIu32 " to %"
+            PRIu32 " messages.", size, lf_size);
+    }
+
+    ring->lf_reader.tail = 0;
+    ring->lf_reader.mask = lf_size - 1;
+    ring->lf_reader.size = lf_size;
+    ring->lf_writer.head = 0;
+    ring->lf_writer.mask = lf_size - 1;
+    ring->lf_sync.reader_sleeping = 0;
+    ring->lf_sync.writers_sleeping = 0;
+    return IPX_OK;
+}
+
+/**
+ * \brief Get current monotonic time (in nanoseconds)
+ */
+static inline uint64_t
+ring_time_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((uint64_t) ts.tv_sec * 1000000000ULL) + (uint64_t) ts.tv_nsec;
+}
+
 ipx_ring_t *
 ipx_ring_init(uint32_t size, bool mw_mode)
+{
+    return ipx_ring_init_type(size, mw_mode, IPX_RING_TYPE_BLOCK);
+}
+
+ipx_ring_t *
+ipx_ring_init_type(uint32_t size, bool mw_mode, enum ipx_ring_type type)
 {
     ipx_ring_t *ring;
 
+    if (size == 0 || size > (UINT32_MAX / 2U) + 1U) {
+        IPX_ERROR(module, "Invalid size of a ring buffer (%" PRIu32 ")!", size);
+        return NULL;
+    }
+
     // Prepare data structures
     ring = aligned_alloc(alignof(struct ipx_ring), sizeof(struct ipx_ring));
     if (!ring) {
@@ -188,10 +661,32 @@ ipx_ring_init(uint32_t size, bool mw_mode)
         return NULL;
     }
 
-    ring->data = aligned_alloc(alignof(*ring->data), sizeof(*ring->data) * size);
-    if (!ring->data) {
-        IPX_ERROR(module, "aligned_alloc() failed! (%s:%d)", __FILE__, __LINE__);
-        goto exit_A;
+    ring->type = type;
+    ipx_ring_wait_set(ring, IPX_RING_WAIT_DEFAULT);
+    memset(&ring->stats_writer, 0, sizeof(ring->stats_writer));
+    memset(&ring->stats_reader, 0, sizeof(ring->stats_reader));
+    memset(&ring->adapt, 0, sizeof(ring->adapt));
+    ring->stats_writer.size = size;
+    ring->node = -1;
+    ring->reader.seg = NULL;
+    ring->lf_slots = NULL;
+    ring->bc = NULL;
+    ring->bc_reader = false;
+
+    if (type == IPX_RING_TYPE_LOCKFREE) {
+        if (ring_lf_init(ring, size) != IPX_OK) {
+            goto exit_A;
+        }
+    } else if (type == IPX_RING_TYPE_BROADCAST) {
+        if (ring_bc_init(ring, size) != IPX_OK) {
+            goto exit_A;
+        }
+    } else {
+        ring->reader.seg = ring_seg_create(size, ring->node);
+        if (!ring->reader.seg) {
+            IPX_ERROR(module, "aligned_alloc() failed! (%s:%d)", __FILE__, __LINE__);
+            goto exit_A;
+        }
     }
 
     // Initialize writers' spin lock
@@ -239,6 +734,8 @@ ipx_ring_init(uint32_t size, bool mw_mode)
     ring->reader.exchange_idx = 0;
     ring->reader.read_commit_idx = 0;
     ring->reader.last = 0;
+    ring->reader.data = (ring->reader.seg) ? ring->reader.seg->data : NULL;
+    ring->reader.adaptive = false;
 
     ring->writer.size = size;
     ring->writer.div_block = size / 8;
@@ -246,6 +743,8 @@ ipx_ring_init(uint32_t size, bool mw_mode)
     ring->writer.exchange_idx = size; // Amount of empty memory
     ring->writer.write_idx = 0;
     ring->writer.write_commit_idx = 0;
+    ring->writer.seg = ring->reader.seg;
+    ring->writer.data = ring->reader.data;
 
     ring->sync.read_idx = 0;
     ring->sync.write_idx = size;
@@ -263,7 +762,9 @@ exit_D:
 exit_C:
     pthread_spin_destroy(&ring->writer_lock);
 exit_B:
-    free(ring->data);
+    ring_bc_destroy(ring);
+    free(ring->lf_slots);
+    ring_seg_destroy(ring->reader.seg);
 exit_A:
     free(ring);
     return NULL;
@@ -272,8 +773,22 @@ exit_A:
 void
 ipx_ring_destroy(ipx_ring_t *ring)
 {
-    // The last read message is not confirmed by the reader, it is 1 index behind -> "+ 1"
-    if (ring->reader.read_idx + 1 != ring->writer.write_idx) {
+    if (ring->bc_reader) {
+        // Reader views are owned by the broadcast ring buffer
+        assert(false && "Reader view of a broadcast ring buffer cannot be destroyed!");
+        return;
+    }
+
+    if (ring->type == IPX_RING_TYPE_BROADCAST) {
+        ring_bc_destroy(ring);
+    } else if (ring->type == IPX_RING_TYPE_LOCKFREE) {
+        uint32_t cnt = ring->lf_writer.head - ring->lf_reader.tail;
+        if (cnt != 0) {
+            IPX_WARNING(module, "Destroying of a ring buffer that still contains %" PRIu32
+                " unprocessed message(s)!", cnt);
+        }
+    } else if (ring->reader.read_idx + 1 != ring->writer.write_idx) {
+        // The last read message is not confirmed by the reader, it is 1 index behind -> "+ 1"
         uint32_t cnt = ring->writer.write_idx - ring->reader.read_idx + 1;
         IPX_WARNING(module, "Destroying of a ring buffer that still contains %" PRIu32
             " unprocessed message(s)!", cnt);
@@ -283,10 +798,162 @@ ipx_ring_destroy(ipx_ring_t *ring)
     pthread_cond_destroy(&ring->sync.cond_reader);
     pthread_mutex_destroy(&ring->sync.mutex);
     pthread_spin_destroy(&ring->writer_lock);
-    free(ring->data);
+    free(ring->lf_slots);
+    ring_seg_destroy(ring->reader.seg);
     free(ring);
 }
 
+enum ipx_ring_type
+ipx_ring_type_get(const ipx_ring_t *ring)
+{
+    return ring->type;
+}
+
+void
+ipx_ring_wait_set(ipx_ring_t *ring, enum ipx_ring_wait wait)
+{
+    if (wait == IPX_RING_WAIT_DEFAULT) {
+        wait = (ring->type == IPX_RING_TYPE_BLOCK) ? IPX_RING_WAIT_PARK : IPX_RING_WAIT_ADAPTIVE;
+    }
+
+    ring->wait = wait;
+}
+
+int
+ipx_ring_node_set(ipx_ring_t *ring, unsigned int node)
+{
+    int rc;
+    if (ring->bc_reader) {
+        // Slots are shared by all readers, only the writer view can place them
+        return IPX_OK;
+    } else if (ring->type == IPX_RING_TYPE_BROADCAST) {
+        rc = ring_mem_bind(ring->bc->slots, sizeof(*ring->bc->slots) * ring->bc->size, node);
+    } else if (ring->type == IPX_RING_TYPE_LOCKFREE) {
+        rc = ring_mem_bind(ring->lf_slots, sizeof(*ring->lf_slots) * ring->lf_reader.size, node);
+    } else {
+        // New segments of an adaptive buffer are placed on the same node
+        ring->node = (int) node;
+        rc = ring_mem_bind(ring->writer.data, sizeof(*ring->writer.data) * ring->writer.size,
+            node);
+    }
+
+    if (rc != IPX_OK) {
+        IPX_WARNING(module, "Unable to place a ring buffer on the NUMA node %u (mbind() failed)",
+            node);
+    }
+
+    return rc;
+}
+
+int
+ipx_ring_adaptive_set(ipx_ring_t *ring, uint32_t max)
+{
+    if (ring->type != IPX_RING_TYPE_BLOCK) {
+        IPX_WARNING(module, "Adaptive capacity is supported only by ring buffers with block "
+            "synchronization!", '\0');
+        return IPX_ERR_ARG;
+    }
+
+    const uint32_t size = ring->writer.size;
+    if (max < size || max > (UINT32_MAX / 2U) + 1U) {
+        IPX_ERROR(module, "Invalid maximal capacity of a ring buffer (%" PRIu32 ")!", max);
+        return IPX_ERR_ARG;
+    }
+
+    ring->adapt.min = size;
+    ring->adapt.max = (max > size) ? max : 0;
+    ring->adapt.waits = 0;
+    ring->adapt.waits_since = ring->adapt.low_since = ring_time_ns();
+    ring->reader.adaptive = (ring->adapt.max != 0);
+    return IPX_OK;
+}
+
+enum ipx_ring_wait
+ipx_ring_wait_get(const ipx_ring_t *ring)
+{
+    return ring->wait;
+}
+
+/**
+ * \brief Atomically increment a statistics counter
+ * \param[in] counter Counter
+ * \param[in] value   Value to add
+ */
+static inline void
+ring_stats_add(uint64_t *counter, uint64_t value)
+{
+    __atomic_fetch_add(counter, value, __ATOMIC_RELAXED);
+}
+
+/**
+ * \brief Update the high-water mark of the buffer (reader only)
+ * \param[in] ring Ring buffer
+ * \param[in] pops Number of popped messages before the last read operation
+ */
+static inline void
+ring_stats_hwm_update(ipx_ring_t *ring, uint64_t pops)
+{
+    // Readers of a broadcast ring buffer share statistics of the writer
+    const struct ipx_ring *writer = (ring->bc_reader) ? ring->bc->writer : ring;
+    uint64_t pushes = __atomic_load_n(&writer->stats_writer.pushes, __ATOMIC_RELAXED);
+    if (pushes <= pops) {
+        return;
+    }
+
+    uint64_t usage = pushes - pops;
+    if (usage > ring->stats_reader.high_water) {
+        __atomic_store_n(&ring->stats_reader.high_water, (uint32_t) usage, __ATOMIC_RELAXED);
+    }
+}
+
+/**
+ * \brief Hint the CPU that the caller is busy-waiting
+ */
+static inline void
+ring_cpu_relax(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__)
+    __asm__ __volatile__("yield" ::: "memory");
+#else
+    __asm__ __volatile__("" ::: "memory");
+#endif
+}
+
+/**
+ * \brief Perform one step of the waiting strategy before the caller goes to sleep
+ *
+ * The caller is supposed to check its condition after each step and call the function again
+ * while the function returns true.
+ * \param[in]     wait Waiting strategy
+ * \param[in,out] iter Counter of performed steps (MUST be zero before the first call)
+ * \return True if the caller should check its condition again without sleeping.
+ * \return False if the caller should go to sleep.
+ */
+static inline bool
+ring_wait_step(enum ipx_ring_wait wait, uint32_t *iter)
+{
+    if (wait == IPX_RING_WAIT_PARK) {
+        return false;
+    }
+
+    if (*iter < RING_WAIT_SPIN_CNT) {
+        (*iter)++;
+        ring_cpu_relax();
+        return true;
+    }
+
+    if (wait == IPX_RING_WAIT_SPIN || *iter < RING_WAIT_SPIN_CNT + RING_WAIT_YIELD_CNT) {
+        // Let a preempted thread on the same CPU finish its work
+        (*iter)++;
+        sched_yield();
+        return true;
+    }
+
+    return false;
+}
+
 /**
  * \brief Wrapper around condition wait
  * \param[in] cond  Condition variable
@@ -309,52 +976,186 @@ ring_cond_timedwait(pthread_cond_t *restrict cond, pthread_mutex_t *restrict mut
 }
 
 /**
- * \brief Get a new empty field
+ * \brief Replace the segment of writers by a new one of a different size (writers only)
  *
- * \note The function blocks until a required memory is ready. Before the next call of this
- *   function, the function ipx_ring_commit() MUST be called first, to commit performed
- *   modifications.
+ * Messages already written into the old segment are left there for the reader. The new size
+ * MUST be large enough to hold all messages that have not been released by the reader yet.
+ * \warning The caller MUST hold the synchronization mutex.
  * \param[in] ring Ring buffer
- * \return Pointer to a unused place in the buffer
+ * \param[in] size New size of the buffer (number of pointers)
  */
-static inline ipx_msg_t **
-ipx_ring_begin(ipx_ring_t *ring)
+static void
+ring_block_resize(ipx_ring_t *ring, uint32_t size)
 {
-    // Prepare the next pointer to write
-    ipx_msg_t **msg = &ring->data[ring->writer.data_idx];
-
-    // Is there enough space?
-    if (ring->writer.exchange_idx - ring->writer.write_idx > 0) {
-        return msg;
+    const uint32_t old_size = ring->writer.size;
+    struct ring_seg *seg = ring_seg_create(size, ring->node);
+    if (!seg) {
+        // Not fatal, the current segment is still usable
+        IPX_WARNING(module, "Unable to change capacity of a ring buffer (memory allocation "
+            "error)!", '\0');
+        return;
     }
 
-    // Get an empty space -> reader-writer synchronization
-    pthread_mutex_lock(&ring->sync.mutex);
+    // Publish the new segment, the reader switches to it at the current position of writers
+    struct ring_seg *old = ring->writer.seg;
+    old->next_idx = ring->writer.write_idx;
+    __atomic_store_n(&old->next, seg, __ATOMIC_RELEASE);
+
+    ring->writer.seg = seg;
+    ring->writer.data = seg->data;
+    ring->writer.data_idx = 0;
+    ring->writer.size = size;
+    ring->writer.div_block = size / 8;
+
+    // Change the amount of memory available to writers (overflow is expected behavior)
+    ring->sync.write_idx += size - old_size;
     ring->writer.exchange_idx = ring->sync.write_idx;
-    while (ring->writer.exchange_idx - ring->writer.write_idx == 0) {
-        // After sync the buffer is still full, try again later
-        pthread_cond_signal(&ring->sync.cond_reader);
-        ring_cond_timedwait(&ring->sync.cond_writer, &ring->sync.mutex, 10);
-        ring->writer.exchange_idx = ring->sync.write_idx;
-    }
-    pthread_cond_signal(&ring->sync.cond_reader);
-    pthread_mutex_unlock(&ring->sync.mutex);
 
-    assert(ring->writer.exchange_idx - ring->writer.write_idx > 0);
-    return msg;
+    __atomic_store_n(&ring->stats_writer.size, size, __ATOMIC_RELAXED);
+    ring_stats_add(&ring->stats_writer.resizes, 1U);
+    IPX_INFO(module, "Capacity of a ring buffer changed from %" PRIu32 " to %" PRIu32
+        " messages.", old_size, size);
 }
 
 /**
- * \brief Commit modifications of memory
- * \param[in] ring Ring buffer
+ * \brief Record a wait of a writer on a full buffer and grow the buffer if it happens often
+ *
+ * \warning The caller MUST hold the synchronization mutex.
+ * \param[in] ring Ring buffer (with enabled adaptive capacity)
  */
-static inline void
-ipx_ring_commit(ipx_ring_t *ring)
+static void
+ring_adapt_full(ipx_ring_t *ring)
 {
-    register uint32_t new_idx = 1;
-    ring->writer.data_idx++;
+    struct ring_adapt *adapt = &ring->adapt;
+    const uint64_t now = ring_time_ns();
 
-    if (ring->writer.size == ring->writer.data_idx) {
+    adapt->low_since = now;
+    if (now - adapt->waits_since > RING_ADAPT_GROW_PERIOD) {
+        adapt->waits_since = now;
+        adapt->waits = 0;
+    }
+
+    if (++adapt->waits < RING_ADAPT_GROW_CNT || ring->writer.size >= adapt->max) {
+        return;
+    }
+
+    const uint32_t size = ring->writer.size;
+    ring_block_resize(ring, (size > adapt->max / 2U) ? adapt->max : size * 2U);
+    adapt->waits_since = now;
+    adapt->waits = 0;
+}
+
+/**
+ * \brief Shrink the buffer after a long period of low occupancy
+ *
+ * \warning The caller MUST hold the synchronization mutex.
+ * \param[in] ring Ring buffer (with enabled adaptive capacity)
+ */
+static void
+ring_adapt_check(ipx_ring_t *ring)
+{
+    struct ring_adapt *adapt = &ring->adapt;
+    const uint64_t now = ring_time_ns();
+    const uint32_t size = ring->writer.size;
+    // Messages not released by the reader yet (the reader releases whole blocks)
+    const uint32_t used = ring->writer.write_idx - (ring->sync.write_idx - size);
+
+    if (used > size / RING_ADAPT_LOW_DIV) {
+        adapt->low_since = now;
+        return;
+    }
+
+    if (size <= adapt->min || now - adapt->low_since < RING_ADAPT_SHRINK_PERIOD) {
+        return;
+    }
+
+    // Note: the new size is always at least twice the number of used fields
+    ring_block_resize(ring, (size / 2U < adapt->min) ? adapt->min : size / 2U);
+    adapt->low_since = now;
+}
+
+/**
+ * \brief Get a new empty field
+ *
+ * \note The function blocks until a required memory is ready. Before the next call of this
+ *   function, the function ipx_ring_commit() MUST be called first, to commit performed
+ *   modifications.
+ * \param[in] ring Ring buffer
+ * \return Pointer to a unused place in the buffer
+ */
+static inline ipx_msg_t **
+ipx_ring_begin(ipx_ring_t *ring)
+{
+    // Is there enough space?
+    if (ring->writer.exchange_idx - ring->writer.write_idx > 0) {
+        return &ring->writer.data[ring->writer.data_idx];
+    }
+
+    // Wait until the reader releases a block of the buffer (if allowed by the waiting strategy)
+    uint64_t wait_start = ring_time_ns();
+    uint32_t iter = 0;
+    while (__atomic_load_n(&ring->sync.write_idx, __ATOMIC_ACQUIRE) == ring->writer.write_idx
+            && ring_wait_step(ring->wait, &iter)) {
+        // Nothing to do
+    }
+
+    // Get an empty space -> reader-writer synchronization
+    pthread_mutex_lock(&ring->sync.mutex);
+    ring->writer.exchange_idx = ring->sync.write_idx;
+    if (ring->writer.exchange_idx - ring->writer.write_idx == 0 && ring->adapt.max != 0) {
+        // The writer is about to wait, consider increasing the capacity (can change the segment)
+        ring_adapt_full(ring);
+    }
+    while (ring->writer.exchange_idx - ring->writer.write_idx == 0) {
+        // After sync the buffer is still full, try again later
+        pthread_cond_signal(&ring->sync.cond_reader);
+        ring_cond_timedwait(&ring->sync.cond_writer, &ring->sync.mutex, 10);
+        ring->writer.exchange_idx = ring->sync.write_idx;
+    }
+    pthread_cond_signal(&ring->sync.cond_reader);
+    pthread_mutex_unlock(&ring->sync.mutex);
+    ring_stats_add(&ring->stats_writer.wait_full, ring_time_ns() - wait_start);
+
+    assert(ring->writer.exchange_idx - ring->writer.write_idx > 0);
+    return &ring->writer.data[ring->writer.data_idx];
+}
+
+/**
+ * \brief Get the number of empty fields that can be filled at once
+ *
+ * \note The function blocks until at least one field is empty (see ipx_ring_begin()). The fields
+ *   are always continuous i.e. the result is limited by the end of the buffer.
+ * \param[in] ring Ring buffer
+ * \param[in] max  Maximum number of required fields (must be non-zero)
+ * \param[out] cnt Number of available fields (at least 1 and at most \p max)
+ * \return Pointer to the first unused place in the buffer
+ */
+static inline ipx_msg_t **
+ipx_ring_begin_n(ipx_ring_t *ring, uint32_t max, uint32_t *cnt)
+{
+    ipx_msg_t **msg = ipx_ring_begin(ring);
+    uint32_t free_cnt = ring->writer.exchange_idx - ring->writer.write_idx;
+    uint32_t cont_cnt = ring->writer.size - ring->writer.data_idx;
+
+    if (free_cnt > cont_cnt) {
+        free_cnt = cont_cnt;
+    }
+    *cnt = (free_cnt < max) ? free_cnt : max;
+    return msg;
+}
+
+/**
+ * \brief Commit modifications of memory
+ * \param[in] ring Ring buffer
+ * \param[in] cnt  Number of filled fields (see ipx_ring_begin_n())
+ */
+static inline void
+ipx_ring_commit(ipx_ring_t *ring, uint32_t cnt)
+{
+    register uint32_t new_idx = cnt;
+    ring->writer.data_idx += cnt;
+
+    if (ring->writer.size == ring->writer.data_idx) {
         // End of the ring buffer has been reached -> skip to the beginning
         ring->writer.data_idx = 0;
     }
@@ -368,61 +1169,418 @@ ipx_ring_commit(ipx_ring_t *ring)
         ring->sync.read_idx = new_idx;
         ring->writer.exchange_idx = ring->sync.write_idx;
         ring->writer.write_commit_idx = new_idx;
+        if (ring->adapt.max != 0) {
+            ring_adapt_check(ring);
+        }
         pthread_cond_signal(&ring->sync.cond_reader);
         pthread_mutex_unlock(&ring->sync.mutex);
     }
 }
 
-void
-ipx_ring_push(ipx_ring_t *ring, ipx_msg_t *msg)
+/**
+ * \brief Sleep until a value on the address changes or a timeout expires
+ *
+ * \note The thread doesn't go to sleep at all if the value doesn't match \p expected value.
+ *   Spurious wake-ups are possible, therefore, the caller MUST check the condition again.
+ * \param[in] addr     Address of a 32-bit value
+ * \param[in] expected Expected value
+ * \param[in] msec     Maximum time to wait (in milliseconds)
+ */
+static inline void
+ring_futex_wait(uint32_t *addr, uint32_t expected, long msec)
 {
-    ipx_msg_t **msg_space;
+    struct timespec ts;
+    ts.tv_sec = msec / 1000;
+    ts.tv_nsec = (msec % 1000) * 1000000;
+    syscall(SYS_futex, addr, FUTEX_WAIT_PRIVATE, expected, &ts, NULL, 0);
+}
 
-    if (ring->mw_mode) {
-        pthread_spin_lock(&ring->writer_lock);
+/**
+ * \brief Wake up all threads sleeping on the address
+ * \param[in] addr Address of a 32-bit value
+ */
+static inline void
+ring_futex_wake(uint32_t *addr)
+{
+    syscall(SYS_futex, addr, FUTEX_WAKE_PRIVATE, INT_MAX, NULL, NULL, 0);
+}
+
+/**
+ * \brief Wait until a slot in a lock-free ring buffer reaches the expected sequence number
+ *
+ * Depending on the waiting strategy, busy-wait and yield the CPU for a while (see
+ * ring_wait_step()). If the slot is still not ready, go to sleep and let the opposite side to
+ * wake up the thread.
+ * \param[in] slot     Slot to wait for
+ * \param[in] expected Expected sequence number
+ * \param[in] sleeping Counter of sleeping threads (shared with the opposite side)
+ * \param[in] wait     Waiting strategy
+ * \param[in] time     Statistics counter of the total waiting time (in nanoseconds)
+ */
+static void
+ring_lf_wait(struct ring_lf_slot *slot, uint32_t expected, uint32_t *sleeping,
+    enum ipx_ring_wait wait, uint64_t *time)
+{
+    uint64_t wait_start = ring_time_ns();
+    uint32_t iter = 0;
+    uint32_t seq;
+
+    while ((seq = __atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE)) != expected) {
+        if (ring_wait_step(wait, &iter)) {
+            continue;
+        }
+
+        /* Announce the intention to sleep and check the slot again. The opposite side always
+         * updates the slot first and checks the counter after that (both operations are
+         * sequentially consistent), therefore, at least one side sees the update of the other. */
+        __atomic_add_fetch(sleeping, 1U, __ATOMIC_SEQ_CST);
+        seq = __atomic_load_n(&slot->seq, __ATOMIC_SEQ_CST);
+        if (seq != expected) {
+            ring_futex_wait(&slot->seq, seq, RING_LF_SLEEP_MS);
+        }
+        __atomic_sub_fetch(sleeping, 1U, __ATOMIC_RELAXED);
     }
 
-    msg_space = ipx_ring_begin(ring);
-    *msg_space = msg;
-    ipx_ring_commit(ring);
+    ring_stats_add(time, ring_time_ns() - wait_start);
+}
 
-    if (ring->mw_mode) {
-        pthread_spin_unlock(&ring->writer_lock);
+/**
+ * \brief Add a message into a lock-free ring buffer
+ * \param[in] ring Ring buffer
+ * \param[in] msg  Message to be added into the ring buffer
+ */
+static inline void
+ring_lf_push(ipx_ring_t *ring, ipx_msg_t *msg)
+{
+    // Get a ticket i.e. reserve a slot
+    uint32_t ticket = __atomic_fetch_add(&ring->lf_writer.head, 1U, __ATOMIC_RELAXED);
+    struct ring_lf_slot *slot = &ring->lf_slots[ticket & ring->lf_writer.mask];
+
+    if (__atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE) != ticket) {
+        // The slot still holds a message from the previous round (the buffer is full)
+        ring_lf_wait(slot, ticket, &ring->lf_sync.writers_sleeping, ring->wait,
+            &ring->stats_writer.wait_full);
+    }
+
+    slot->msg = msg;
+    __atomic_store_n(&slot->seq, ticket + 1U, __ATOMIC_SEQ_CST);
+
+    if (__atomic_load_n(&ring->lf_sync.reader_sleeping, __ATOMIC_SEQ_CST) != 0) {
+        ring_futex_wake(&slot->seq);
     }
 }
 
+/**
+ * \brief Get a message from a lock-free ring buffer
+ * \param[in] ring Ring buffer
+ * \return Pointer to the message
+ */
+static inline ipx_msg_t *
+ring_lf_pop(ipx_ring_t *ring)
+{
+    uint32_t ticket = ring->lf_reader.tail;
+    struct ring_lf_slot *slot = &ring->lf_slots[ticket & ring->lf_reader.mask];
 
-ipx_msg_t *
-ipx_ring_pop(ipx_ring_t *ring)
+    if (__atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE) != ticket + 1U) {
+        // The slot hasn't been filled yet (the buffer is empty)
+        ring_lf_wait(slot, ticket + 1U, &ring->lf_sync.reader_sleeping, ring->wait,
+            &ring->stats_reader.wait_empty);
+    }
+
+    ipx_msg_t *msg = slot->msg;
+    ring->lf_reader.tail = ticket + 1U;
+    // Release the slot for a writer in the next round
+    __atomic_store_n(&slot->seq, ticket + ring->lf_reader.size, __ATOMIC_SEQ_CST);
+
+    if (__atomic_load_n(&ring->lf_sync.writers_sleeping, __ATOMIC_SEQ_CST) != 0) {
+        ring_futex_wake(&slot->seq);
+    }
+
+    return msg;
+}
+
+/**
+ * \brief Add multiple messages into a lock-free ring buffer
+ * \param[in] ring Ring buffer
+ * \param[in] msgs Array of messages to be added
+ * \param[in] cnt  Number of messages in the array
+ */
+static inline void
+ring_lf_push_bulk(ipx_ring_t *ring, ipx_msg_t * const *msgs, uint32_t cnt)
 {
-    // Consider previous memory block as processed
-    ring->reader.data_idx += ring->reader.last;
-    ring->reader.read_idx += ring->reader.last;
-    ring->reader.last = 0;
+    // Reserve all slots at once
+    uint32_t ticket = __atomic_fetch_add(&ring->lf_writer.head, cnt, __ATOMIC_RELAXED);
 
-    if (ring->reader.size == ring->reader.data_idx) {
-        // The end of the ring buffer has been reached -> skip to the beginning
-        ring->reader.data_idx = 0;
+    for (uint32_t i = 0; i < cnt; ++i, ++ticket) {
+        struct ring_lf_slot *slot = &ring->lf_slots[ticket & ring->lf_writer.mask];
+
+        if (__atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE) != ticket) {
+            ring_lf_wait(slot, ticket, &ring->lf_sync.writers_sleeping, ring->wait,
+                &ring->stats_writer.wait_full);
+        }
+
+        slot->msg = msgs[i];
+        __atomic_store_n(&slot->seq, ticket + 1U, __ATOMIC_SEQ_CST);
+
+        if (__atomic_load_n(&ring->lf_sync.reader_sleeping, __ATOMIC_SEQ_CST) != 0) {
+            ring_futex_wake(&slot->seq);
+        }
     }
+}
 
-    // Prepare the next pointer to read
-    ipx_msg_t **msg = &ring->data[ring->reader.data_idx];
+/**
+ * \brief Get multiple messages from a lock-free ring buffer
+ *
+ * The function blocks until at least one message is ready.
+ * \param[in]  ring Ring buffer
+ * \param[out] msgs Array for the messages
+ * \param[in]  max  Maximum number of messages (i.e. size of the array, must be non-zero)
+ * \return Number of messages stored into the array
+ */
+static inline uint32_t
+ring_lf_pop_bulk(ipx_ring_t *ring, ipx_msg_t **msgs, uint32_t max)
+{
+    uint32_t ticket = ring->lf_reader.tail;
+    uint32_t cnt = 0;
+    struct ring_lf_slot *slot = &ring->lf_slots[ticket & ring->lf_reader.mask];
 
-    // Sync positions with writers, if necessary
-    if (ring->reader.read_idx - ring->reader.read_commit_idx >= ring->reader.div_block) {
+    if (__atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE) != ticket + 1U) {
+        ring_lf_wait(slot, ticket + 1U, &ring->lf_sync.reader_sleeping, ring->wait,
+            &ring->stats_reader.wait_empty);
+    }
+
+    // Take all consecutive full slots
+    do {
+        msgs[cnt++] = slot->msg;
+        __builtin_prefetch(slot->msg);
+        ticket++;
+        slot = &ring->lf_slots[ticket & ring->lf_reader.mask];
+    } while (cnt < max && __atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE) == ticket + 1U);
+
+    // Release the slots for writers in the next round
+    const uint32_t first = ring->lf_reader.tail;
+    for (uint32_t i = first; i != ticket; ++i) {
+        slot = &ring->lf_slots[i & ring->lf_reader.mask];
+        __atomic_store_n(&slot->seq, i + ring->lf_reader.size, __ATOMIC_RELEASE);
+    }
+    ring->lf_reader.tail = ticket;
+
+    // Make the releases visible before checking for sleeping writers
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&ring->lf_sync.writers_sleeping, __ATOMIC_RELAXED) != 0) {
+        for (uint32_t i = first; i != ticket; ++i) {
+            ring_futex_wake(&ring->lf_slots[i & ring->lf_reader.mask].seq);
+        }
+    }
+
+    return cnt;
+}
+
+/**
+ * \brief Get the read cursor of the slowest reader of a broadcast ring buffer
+ * \param[in]  ring    Ring buffer (the writer view)
+ * \param[in]  head    Current writer head
+ * \param[out] slowest Reader view of the slowest reader (NULL if there are no readers)
+ * \return Tail of the slowest reader (\p head, if there are no readers)
+ */
+static inline uint32_t
+ring_bc_min_tail(const ipx_ring_t *ring, uint32_t head, ipx_ring_t **slowest)
+{
+    const struct ring_bc *bc = ring->bc;
+    uint32_t result = head;
+    uint32_t max_used = 0;
+
+    *slowest = NULL;
+    for (uint32_t i = 0; i < bc->readers_cnt; ++i) {
+        uint32_t tail = __atomic_load_n(&bc->readers[i]->lf_reader.tail, __ATOMIC_ACQUIRE);
+        if (*slowest == NULL || head - tail > max_used) {
+            max_used = head - tail;
+            result = tail;
+            *slowest = bc->readers[i];
+        }
+    }
+
+    return result;
+}
+
+/**
+ * \brief Wait until a broadcast ring buffer has at least one empty slot (writer only)
+ *
+ * The writer waits for the slowest reader. Depending on the waiting strategy, busy-wait and yield
+ * the CPU for a while (see ring_wait_step()). If the buffer is still full, go to sleep and let
+ * the slowest reader to wake up the writer.
+ * \param[in] ring Ring buffer (the writer view)
+ * \return Number of empty slots
+ */
+static uint32_t
+ring_bc_wait_writer(ipx_ring_t *ring)
+{
+    struct ring_bc *bc = ring->bc;
+    const uint32_t head = ring->lf_writer.head;
+    uint32_t free_cnt = bc->size - (head - bc->min_tail);
+    if (free_cnt > 0) {
+        return free_cnt;
+    }
+
+    // The cached cursor is out of date -> find the slowest reader
+    ipx_ring_t *slowest;
+    bc->min_tail = ring_bc_min_tail(ring, head, &slowest);
+    free_cnt = bc->size - (head - bc->min_tail);
+    if (free_cnt > 0) {
+        return free_cnt;
+    }
+
+    uint64_t wait_start = ring_time_ns();
+    uint32_t iter = 0;
+    while (free_cnt == 0) {
+        if (!ring_wait_step(ring->wait, &iter)) {
+            // Announce the intention to sleep and check the cursor again (see ring_lf_wait())
+            __atomic_store_n(&bc->writer_sleeping, 1U, __ATOMIC_SEQ_CST);
+            uint32_t tail = __atomic_load_n(&slowest->lf_reader.tail, __ATOMIC_SEQ_CST);
+            if (head - tail >= bc->size) {
+                ring_futex_wait(&slowest->lf_reader.tail, tail, RING_LF_SLEEP_MS);
+            }
+            __atomic_store_n(&bc->writer_sleeping, 0U, __ATOMIC_RELAXED);
+        }
+
+        bc->min_tail = ring_bc_min_tail(ring, head, &slowest);
+        free_cnt = bc->size - (head - bc->min_tail);
+    }
+
+    ring_stats_add(&ring->stats_writer.wait_full, ring_time_ns() - wait_start);
+    return free_cnt;
+}
+
+/**
+ * \brief Add multiple messages into a broadcast ring buffer
+ *
+ * Each message is written only once, regardless of the number of readers.
+ * \param[in] ring Ring buffer (the writer view)
+ * \param[in] msgs Array of messages to be added
+ * \param[in] cnt  Number of messages in the array
+ */
+static inline void
+ring_bc_push_bulk(ipx_ring_t *ring, ipx_msg_t * const *msgs, uint32_t cnt)
+{
+    struct ring_bc *bc = ring->bc;
+
+    while (cnt > 0) {
+        uint32_t free_cnt = ring_bc_wait_writer(ring);
+        uint32_t n = (free_cnt < cnt) ? free_cnt : cnt;
+        uint32_t head = ring->lf_writer.head;
+
+        for (uint32_t i = 0; i < n; ++i) {
+            bc->slots[(head + i) & bc->mask] = msgs[i];
+        }
+
+        // Publish all messages at once
+        head += n;
+        ring->lf_writer.head = head;
+        __atomic_store_n(&bc->head, head, __ATOMIC_SEQ_CST);
+        if (__atomic_load_n(&bc->readers_sleeping, __ATOMIC_SEQ_CST) != 0) {
+            ring_futex_wake(&bc->head);
+        }
+
+        msgs += n;
+        cnt -= n;
+    }
+}
+
+/**
+ * \brief Wait until a writer publishes new messages into a broadcast ring buffer (reader only)
+ * \param[in] ring Ring buffer (the reader view)
+ */
+static void
+ring_bc_wait_reader(ipx_ring_t *ring)
+{
+    struct ring_bc *bc = ring->bc;
+    const uint32_t tail = ring->lf_reader.tail;
+    uint64_t wait_start = ring_time_ns();
+    uint32_t iter = 0;
+    uint32_t head;
+
+    while ((head = __atomic_load_n(&bc->head, __ATOMIC_ACQUIRE)) == tail) {
+        if (ring_wait_step(ring->wait, &iter)) {
+            continue;
+        }
+
+        // Announce the intention to sleep and check the head again (see ring_lf_wait())
+        __atomic_add_fetch(&bc->readers_sleeping, 1U, __ATOMIC_SEQ_CST);
+        head = __atomic_load_n(&bc->head, __ATOMIC_SEQ_CST);
+        if (head == tail) {
+            ring_futex_wait(&bc->head, head, RING_LF_SLEEP_MS);
+        }
+        __atomic_sub_fetch(&bc->readers_sleeping, 1U, __ATOMIC_RELAXED);
+    }
+
+    ring_stats_add(&ring->stats_reader.wait_empty, ring_time_ns() - wait_start);
+}
+
+/**
+ * \brief Get multiple messages from a broadcast ring buffer
+ *
+ * The function blocks until at least one message is ready.
+ * \param[in]  ring Ring buffer (the reader view)
+ * \param[out] msgs Array for the messages
+ * \param[in]  max  Maximum number of messages (i.e. size of the array, must be non-zero)
+ * \return Number of messages stored into the array
+ */
+static inline uint32_t
+ring_bc_pop_bulk(ipx_ring_t *ring, ipx_msg_t **msgs, uint32_t max)
+{
+    struct ring_bc *bc = ring->bc;
+    const uint32_t tail = ring->lf_reader.tail;
+    uint32_t head = __atomic_load_n(&bc->head, __ATOMIC_ACQUIRE);
+
+    if (head == tail) {
+        ring_bc_wait_reader(ring);
+        head = __atomic_load_n(&bc->head, __ATOMIC_ACQUIRE);
+    }
+
+    uint32_t cnt = head - tail;
+    if (cnt > max) {
+        cnt = max;
+    }
+
+    for (uint32_t i = 0; i < cnt; ++i) {
+        msgs[i] = bc->slots[(tail + i) & bc->mask];
+        __builtin_prefetch(msgs[i]);
+    }
+
+    // Release the slots (the writer waits only for the slowest reader)
+    __atomic_store_n(&ring->lf_reader.tail, tail + cnt, __ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&bc->writer_sleeping, __ATOMIC_SEQ_CST) != 0) {
+        ring_futex_wake(&ring->lf_reader.tail);
+    }
+
+    return cnt;
+}
+
+/**
+ * \brief Wait until a writer commits new messages (block synchronization)
+ *
+ * The function returns only if the reader owns at least one message.
+ * \param[in] ring Ring buffer
+ */
+static void
+ring_block_wait_reader(ipx_ring_t *ring)
+{
+    // Wait for a writer to commit new messages (if allowed by the waiting strategy)
+    uint32_t iter = 0;
+    while (__atomic_load_n(&ring->writer.write_idx, __ATOMIC_ACQUIRE) == ring->reader.read_idx
+            && ring_wait_step(ring->wait, &iter)) {
+        // Nothing to do
+    }
+
+    if (ring->wait != IPX_RING_WAIT_PARK) {
+        // Don't wait for a writer to perform sync -> steal all committed messages immediately
         pthread_mutex_lock(&ring->sync.mutex);
-        ring->sync.write_idx += ring->reader.read_idx - ring->reader.read_commit_idx;
-        ring->reader.exchange_idx = ring->sync.read_idx;
-        ring->reader.read_commit_idx = ring->reader.read_idx;
-        pthread_cond_signal(&ring->sync.cond_writer);
+        ring->sync.read_idx = ring->reader.exchange_idx = __sync_fetch_and_add(&ring->writer.write_idx, 0);
         pthread_mutex_unlock(&ring->sync.mutex);
-    }
 
-    if (ring->reader.exchange_idx - ring->reader.read_idx > 0) {
-        // Ok, the reader owns this part of the buffer
-        // TODO: prefetch
-        ring->reader.last = 1;
-        return *msg; // Now, we can dereference the pointer
+        if (ring->reader.exchange_idx - ring->reader.read_idx > 0) {
+            return;
+        }
     }
 
     while (1) {
@@ -435,9 +1593,7 @@ ipx_ring_pop(ipx_ring_t *ring)
         pthread_mutex_unlock(&ring->sync.mutex);
 
         if (ring->reader.exchange_idx - ring->reader.read_idx > 0) {
-            // TODO: prefetch
-            ring->reader.last = 1;
-            return *msg; // Now, we can dereference the pointer
+            return;
         }
 
         // Writer still didn't perform sync -> try to steal all committed messages from writer
@@ -446,11 +1602,395 @@ ipx_ring_pop(ipx_ring_t *ring)
         pthread_mutex_unlock(&ring->sync.mutex);
 
         if (ring->reader.exchange_idx - ring->reader.read_idx > 0) {
-            // TODO: prefetch
-            ring->reader.last = 1;
-            return *msg; // Now, we can dereference the pointer
+            return;
+        }
+    }
+}
+
+/**
+ * \brief Move the reader to the next segment(s) if it has read all messages of the current one
+ *
+ * Released segments are destroyed.
+ * \param[in] ring Ring buffer (with enabled adaptive capacity)
+ */
+static void
+ring_block_seg_next(ipx_ring_t *ring)
+{
+    struct ring_seg *seg = ring->reader.seg;
+    struct ring_seg *next;
+
+    while ((next = __atomic_load_n(&seg->next, __ATOMIC_ACQUIRE)) != NULL
+            && seg->next_idx == ring->reader.read_idx) {
+        seg->next = NULL;
+        ring_seg_destroy(seg);
+        seg = next;
+
+        ring->reader.seg = seg;
+        ring->reader.data = seg->data;
+        ring->reader.data_idx = 0;
+        ring->reader.size = seg->size;
+        ring->reader.div_block = seg->size / 8;
+    }
+}
+
+/**
+ * \brief Get a message from the ring buffer (block synchronization)
+ * \param[in] ring Ring buffer
+ * \return Pointer to the message
+ */
+static inline ipx_msg_t *
+ring_block_pop(ipx_ring_t *ring)
+{
+    // Consider previous memory block as processed
+    ring->reader.data_idx += ring->reader.last;
+    ring->reader.read_idx += ring->reader.last;
+    ring->reader.last = 0;
+
+    if (ring->reader.data_idx >= ring->reader.size) {
+        // The end of the ring buffer has been reached -> skip to the beginning
+        ring->reader.data_idx -= ring->reader.size;
+    }
+
+    // Sync positions with writers, if necessary
+    if (ring->reader.read_idx - ring->reader.read_commit_idx >= ring->reader.div_block) {
+        pthread_mutex_lock(&ring->sync.mutex);
+        ring->sync.write_idx += ring->reader.read_idx - ring->reader.read_commit_idx;
+        ring->reader.exchange_idx = ring->sync.read_idx;
+        ring->reader.read_commit_idx = ring->reader.read_idx;
+        pthread_cond_signal(&ring->sync.cond_writer);
+        pthread_mutex_unlock(&ring->sync.mutex);
+    }
+
+    if (ring->reader.exchange_idx - ring->reader.read_idx == 0) {
+        // The reader doesn't own any message -> wait
+        uint64_t wait_start = ring_time_ns();
+        ring_block_wait_reader(ring);
+        ring_stats_add(&ring->stats_reader.wait_empty, ring_time_ns() - wait_start);
+    }
+
+    if (ring->reader.adaptive) {
+        // The message might have been written into a new segment
+        ring_block_seg_next(ring);
+    }
+
+    // Ok, the reader owns this part of the buffer
+    ring->reader.last = 1;
+    return ring->reader.data[ring->reader.data_idx];
+}
+
+void
+ipx_ring_push(ipx_ring_t *ring, ipx_msg_t *msg)
+{
+    ipx_msg_t **msg_space;
+
+    IPX_TRACE2(ring_push, ring, msg);
+    if (ring->type == IPX_RING_TYPE_LOCKFREE) {
+        ring_lf_push(ring, msg);
+        ring_stats_add(&ring->stats_writer.pushes, 1U);
+        return;
+    }
+
+    if (ring->type == IPX_RING_TYPE_BROADCAST) {
+        ipx_ring_push_bulk(ring, &msg, 1);
+        return;
+    }
+
+    if (ring->mw_mode) {
+        pthread_spin_lock(&ring->writer_lock);
+    }
+
+    msg_space = ipx_ring_begin(ring);
+    *msg_space = msg;
+    ipx_ring_commit(ring, 1);
+
+    if (ring->mw_mode) {
+        pthread_spin_unlock(&ring->writer_lock);
+    }
+
+    ring_stats_add(&ring->stats_writer.pushes, 1U);
+}
+
+
+/**
+ * \brief Try to add a message into a lock-free ring buffer without waiting
+ * \param[in] ring Ring buffer
+ * \param[in] msg  Message to be added into the ring buffer
+ * \return True on success, false if the buffer is full
+ */
+static inline bool
+ring_lf_try_push(ipx_ring_t *ring, ipx_msg_t *msg)
+{
+    uint32_t ticket = __atomic_load_n(&ring->lf_writer.head, __ATOMIC_RELAXED);
+    struct ring_lf_slot *slot;
+
+    // Reserve a slot only if it's empty (a ticket cannot be returned)
+    do {
+        slot = &ring->lf_slots[ticket & ring->lf_writer.mask];
+        uint32_t seq = __atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE);
+        if ((int32_t) (seq - ticket) < 0) {
+            // The slot still holds a message from the previous round
+            return false;
+        }
+
+        if (seq != ticket) {
+            // Another writer has already taken the ticket
+            ticket = __atomic_load_n(&ring->lf_writer.head, __ATOMIC_RELAXED);
+            continue;
         }
+
+        if (__atomic_compare_exchange_n(&ring->lf_writer.head, &ticket, ticket + 1U, true,
+                __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+            break;
+        }
+    } while (true);
+
+    slot->msg = msg;
+    __atomic_store_n(&slot->seq, ticket + 1U, __ATOMIC_SEQ_CST);
+
+    if (__atomic_load_n(&ring->lf_sync.reader_sleeping, __ATOMIC_SEQ_CST) != 0) {
+        ring_futex_wake(&slot->seq);
+    }
+
+    return true;
+}
+
+/**
+ * \brief Check if the writer of a block ring buffer owns at least one empty field
+ *
+ * If the writer doesn't own any empty field, sync positions with the reader (without waiting).
+ * \param[in] ring Ring buffer
+ * \return True or false
+ */
+static inline bool
+ring_block_try_begin(ipx_ring_t *ring)
+{
+    if (ring->writer.exchange_idx - ring->writer.write_idx > 0) {
+        return true;
+    }
+
+    pthread_mutex_lock(&ring->sync.mutex);
+    ring->writer.exchange_idx = ring->sync.write_idx;
+    if (ring->writer.exchange_idx - ring->writer.write_idx == 0 && ring->adapt.max != 0) {
+        // The writer would have to wait, consider increasing the capacity
+        ring_adapt_full(ring);
+    }
+    pthread_cond_signal(&ring->sync.cond_reader);
+    pthread_mutex_unlock(&ring->sync.mutex);
+    return (ring->writer.exchange_idx - ring->writer.write_idx > 0);
+}
+
+bool
+ipx_ring_try_push(ipx_ring_t *ring, ipx_msg_t *msg)
+{
+    bool added = false;
+
+    if (ring->type == IPX_RING_TYPE_LOCKFREE) {
+        added = ring_lf_try_push(ring, msg);
+        if (added) {
+            ring_stats_add(&ring->stats_writer.pushes, 1U);
+        }
+        return added;
+    }
+
+    if (ring->mw_mode) {
+        pthread_spin_lock(&ring->writer_lock);
+    }
+
+    if (ring->type == IPX_RING_TYPE_BROADCAST) {
+        assert(!ring->bc_reader && "A reader view of a broadcast ring buffer cannot be written!");
+        struct ring_bc *bc = ring->bc;
+        ipx_ring_t *slowest;
+        if (bc->size - (ring->lf_writer.head - bc->min_tail) == 0) {
+            bc->min_tail = ring_bc_min_tail(ring, ring->lf_writer.head, &slowest);
+        }
+
+        if (bc->size - (ring->lf_writer.head - bc->min_tail) > 0) {
+            ring_bc_push_bulk(ring, &msg, 1);
+            added = true;
+        }
+    } else if (ring_block_try_begin(ring)) {
+        ring->writer.data[ring->writer.data_idx] = msg;
+        ipx_ring_commit(ring, 1);
+        added = true;
+    }
+
+    if (ring->mw_mode) {
+        pthread_spin_unlock(&ring->writer_lock);
+    }
+
+    if (added) {
+        ring_stats_add(&ring->stats_writer.pushes, 1U);
+    }
+    return added;
+}
+
+ipx_msg_t *
+ipx_ring_pop(ipx_ring_t *ring)
+{
+    ipx_msg_t *msg;
+
+    if (ring->type == IPX_RING_TYPE_LOCKFREE) {
+        msg = ring_lf_pop(ring);
+    } else if (ring->type == IPX_RING_TYPE_BROADCAST) {
+        assert(ring->bc_reader && "Only a reader view of a broadcast ring buffer can be read!");
+        ring_bc_pop_bulk(ring, &msg, 1);
+    } else {
+        msg = ring_block_pop(ring);
+    }
+
+    uint64_t pops = __atomic_load_n(&ring->stats_reader.pops, __ATOMIC_RELAXED);
+    __atomic_store_n(&ring->stats_reader.pops, pops + 1U, __ATOMIC_RELAXED);
+    if (pops % RING_STATS_HWM_RATE == 0) {
+        ring_stats_hwm_update(ring, pops);
+    }
+
+    IPX_TRACE2(ring_pop, ring, msg);
+    return msg;
+}
+
+void
+ipx_ring_push_bulk(ipx_ring_t *ring, ipx_msg_t * const *msgs, uint32_t cnt)
+{
+    if (cnt == 0) {
+        return;
+    }
+
+    IPX_TRACE3(ring_push_bulk, ring, msgs, cnt);
+    if (ring->type == IPX_RING_TYPE_LOCKFREE) {
+        ring_lf_push_bulk(ring, msgs, cnt);
+        ring_stats_add(&ring->stats_writer.pushes, cnt);
+        return;
+    }
+
+    const uint32_t total = cnt;
+    if (ring->mw_mode) {
+        pthread_spin_lock(&ring->writer_lock);
+    }
+
+    if (ring->type == IPX_RING_TYPE_BROADCAST) {
+        assert(!ring->bc_reader && "A reader view of a broadcast ring buffer cannot be written!");
+        ring_bc_push_bulk(ring, msgs, cnt);
+        cnt = 0;
+    }
+
+    while (cnt > 0) {
+        uint32_t space_cnt;
+        ipx_msg_t **msg_space = ipx_ring_begin_n(ring, cnt, &space_cnt);
+        memcpy(msg_space, msgs, space_cnt * sizeof(*msgs));
+        ipx_ring_commit(ring, space_cnt);
+
+        msgs += space_cnt;
+        cnt -= space_cnt;
     }
+
+    if (ring->mw_mode) {
+        pthread_spin_unlock(&ring->writer_lock);
+    }
+
+    ring_stats_add(&ring->stats_writer.pushes, total);
+}
+
+/**
+ * \brief Get multiple messages from the ring buffer (block synchronization)
+ * \param[in]  ring Ring buffer
+ * \param[out] msgs Array for the messages
+ * \param[in]  max  Maximum number of messages (i.e. size of the array, must be non-zero)
+ * \return Number of messages stored into the array
+ */
+static inline uint32_t
+ring_block_pop_bulk(ipx_ring_t *ring, ipx_msg_t **msgs, uint32_t max)
+{
+    // Wait for the first message (also confirms previously read messages)
+    msgs[0] = ring_block_pop(ring);
+
+    // Take all other messages that already belong to the reader, without synchronization
+    uint32_t avail = ring->reader.exchange_idx - ring->reader.read_idx - 1U;
+    if (avail > max - 1U) {
+        avail = max - 1U;
+    }
+
+    if (ring->reader.adaptive
+            && __atomic_load_n(&ring->reader.seg->next, __ATOMIC_ACQUIRE) != NULL) {
+        // Don't cross the end of the current segment (the rest is in the next one)
+        uint32_t seg_avail = ring->reader.seg->next_idx - ring->reader.read_idx - 1U;
+        if (avail > seg_avail) {
+            avail = seg_avail;
+        }
+    }
+
+    uint32_t idx = ring->reader.data_idx;
+    for (uint32_t i = 1; i <= avail; ++i) {
+        if (++idx == ring->reader.size) {
+            idx = 0;
+        }
+        msgs[i] = ring->reader.data[idx];
+        __builtin_prefetch(msgs[i]);
+    }
+
+    ring->reader.last += avail;
+    return avail + 1U;
+}
+
+uint32_t
+ipx_ring_pop_bulk(ipx_ring_t *ring, ipx_msg_t **msgs, uint32_t max)
+{
+    uint32_t cnt;
+
+    assert(max > 0);
+    if (ring->type == IPX_RING_TYPE_LOCKFREE) {
+        cnt = ring_lf_pop_bulk(ring, msgs, max);
+    } else if (ring->type == IPX_RING_TYPE_BROADCAST) {
+        assert(ring->bc_reader && "Only a reader view of a broadcast ring buffer can be read!");
+        cnt = ring_bc_pop_bulk(ring, msgs, max);
+    } else {
+        cnt = ring_block_pop_bulk(ring, msgs, max);
+    }
+
+    // Occupancy before the messages have been taken
+    uint64_t pops = __atomic_load_n(&ring->stats_reader.pops, __ATOMIC_RELAXED);
+    ring_stats_hwm_update(ring, pops);
+    __atomic_store_n(&ring->stats_reader.pops, pops + cnt, __ATOMIC_RELAXED);
+    IPX_TRACE3(ring_pop_bulk, ring, msgs, cnt);
+    return cnt;
+}
+
+void
+ipx_ring_stats_get(const ipx_ring_t *ring, struct ipx_ring_stats *stats)
+{
+    // Readers of a broadcast ring buffer share statistics of the writer
+    const struct ipx_ring *writer = (ring->bc_reader) ? ring->bc->writer : ring;
+
+    // Read the reader's counter first, so the number of pushes is always greater or equal
+    stats->pops = __atomic_load_n(&ring->stats_reader.pops, __ATOMIC_RELAXED);
+    stats->wait_empty = __atomic_load_n(&ring->stats_reader.wait_empty, __ATOMIC_RELAXED);
+    stats->high_water = __atomic_load_n(&ring->stats_reader.high_water, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    stats->pushes = __atomic_load_n(&writer->stats_writer.pushes, __ATOMIC_RELAXED);
+    stats->wait_full = __atomic_load_n(&writer->stats_writer.wait_full, __ATOMIC_RELAXED);
+    stats->resizes = __atomic_load_n(&writer->stats_writer.resizes, __ATOMIC_RELAXED);
+
+    switch (ring->type) {
+    case IPX_RING_TYPE_LOCKFREE:
+        stats->size = ring->lf_reader.size;
+        break;
+    case IPX_RING_TYPE_BROADCAST:
+        stats->size = ring->bc->size;
+        if (!ring->bc_reader) {
+            // The writer view doesn't read anything -> describe the slowest reader
+            ipx_ring_t *slowest;
+            uint32_t head = __atomic_load_n(&ring->bc->head, __ATOMIC_ACQUIRE);
+            uint32_t used = head - ring_bc_min_tail(ring, head, &slowest);
+            stats->pops = (stats->pushes > used) ? stats->pushes - used : 0;
+        }
+        break;
+    default:
+        // The capacity of an adaptive buffer can be changed by writers
+        stats->size = __atomic_load_n(&ring->stats_writer.size, __ATOMIC_RELAXED);
+        break;
+    }
+
+    uint64_t usage = (stats->pushes > stats->pops) ? stats->pushes - stats->pops : 0;
+    stats->usage = (usage > stats->size) ? stats->size : (uint32_t) usage;
 }
 
 void
@@ -65,6 +65,54 @@ extern "C" {
 /** Internal ring buffer type  */
 typedef struct ipx_ring ipx_ring_t;
 
+/** Synchronization algorithm of the ring buffer */
+enum ipx_ring_type {
+    /**
+     * Block synchronization (default)
+     *
+     * Readers and writers exchange ownership of blocks of the buffer under a mutex and wake up
+     * each other using condition variables. Multi-writer mode is protected by a spin lock.
+     */
+    IPX_RING_TYPE_BLOCK,
+    /**
+     * Lock-free synchronization
+     *
+     * Writers reserve slots using atomic tickets and each slot has its own sequence number
+     * that marks it as empty or full. Multiple writers never serialize on a lock and the reader
+     * sleeps on a futex only when the buffer is empty. The size of the buffer is always rounded
+     * up to the nearest power of two.
+     */
+    IPX_RING_TYPE_LOCKFREE,
+    /**
+     * Broadcast (single writer, multiple readers)
+     *
+     * Each message is written only once and it is delivered to all readers. Every reader has its
+     * own view of the buffer (see ipx_ring_bcast_reader_add()) with its own read cursor and
+     * the slowest reader gates the writer. The size of the buffer is always rounded up to
+     * the nearest power of two.
+     */
+    IPX_RING_TYPE_BROADCAST
+};
+
+/**
+ * \brief Waiting strategy of the ring buffer
+ *
+ * Behaviour of a reader (empty buffer) or a writer (full buffer) that cannot continue.
+ * \note In case of #IPX_RING_TYPE_BLOCK, a sleeping reader is woken up by a writer only after
+ *   a block of messages is committed, or after a timeout (10 ms). Therefore, strategies that
+ *   don't go to sleep immediately can significantly reduce latency of sparse messages.
+ */
+enum ipx_ring_wait {
+    /** Default strategy of the synchronization algorithm (see ipx_ring_wait_set())          */
+    IPX_RING_WAIT_DEFAULT,
+    /** Go to sleep immediately (no extra CPU consumption, highest latency)                  */
+    IPX_RING_WAIT_PARK,
+    /** Busy-wait for a short time, then yield the CPU a few times and go to sleep            */
+    IPX_RING_WAIT_ADAPTIVE,
+    /** Busy-wait and yield the CPU, never go to sleep (lowest latency, always consumes CPU)  */
+    IPX_RING_WAIT_SPIN
+};
+
 /**
  * \brief Create a new ring buffer
  *
@@ -79,6 +127,120 @@ typedef struct ipx_ring ipx_ring_t;
 IPX_API ipx_ring_t *
 ipx_ring_init(uint32_t size, bool mw_mode);
 
+/**
+ * \brief Create a new ring buffer with a specific synchronization algorithm
+ *
+ * Same as ipx_ring_init(), however, the caller can select the synchronization algorithm.
+ * \note In case of #IPX_RING_TYPE_LOCKFREE the multi-writer mode has no effect i.e. multiple
+ *   writers are always supported without any performance penalty.
+ * \param[in] size    Size of the ring buffer (number of pointers)
+ * \param[in] mw_mode Multi-writer mode (multiple writers can writer into the buffer)
+ * \param[in] type    Synchronization algorithm
+ * \return A pointer to the buffer or NULL (in case of an error).
+ */
+IPX_API ipx_ring_t *
+ipx_ring_init_type(uint32_t size, bool mw_mode, enum ipx_ring_type type);
+
+/**
+ * \brief Add a new reader of a broadcast ring buffer
+ *
+ * The returned view of the buffer can be used only for reading i.e. ipx_ring_pop(),
+ * ipx_ring_pop_bulk() and ipx_ring_stats_get(). The reader receives all messages written after
+ * this call. The view is owned by the buffer and it is destroyed together with the buffer
+ * (never call ipx_ring_destroy() on the view).
+ * \warning
+ *   During this function call, the user MUST make sure that nobody is using the buffer.
+ * \param[in] ring Broadcast ring buffer (see #IPX_RING_TYPE_BROADCAST)
+ * \return A pointer to the view or NULL (in case of a memory allocation error or if the buffer
+ *   is not a broadcast ring buffer)
+ */
+IPX_API ipx_ring_t *
+ipx_ring_bcast_reader_add(ipx_ring_t *ring);
+
+/**
+ * \brief Get synchronization algorithm of the ring buffer
+ * \param[in] ring Ring buffer
+ * \return Type
+ */
+IPX_API enum ipx_ring_type
+ipx_ring_type_get(const ipx_ring_t *ring);
+
+/** Runtime statistics of the ring buffer */
+struct ipx_ring_stats {
+    /** Total number of pushed messages                                                      */
+    uint64_t pushes;
+    /** Total number of popped messages                                                      */
+    uint64_t pops;
+    /** Total time spent by all writers waiting on a full buffer (in nanoseconds)            */
+    uint64_t wait_full;
+    /** Total time spent by the reader waiting on an empty buffer (in nanoseconds)           */
+    uint64_t wait_empty;
+    /** Capacity of the buffer (number of messages)                                          */
+    uint32_t size;
+    /** Number of messages currently in the buffer (approximation)                           */
+    uint32_t usage;
+    /** Maximum observed number of messages in the buffer (sampled by the reader)            */
+    uint32_t high_water;
+    /** Total number of changes of the capacity (see ipx_ring_adaptive_set())                */
+    uint64_t resizes;
+};
+
+/**
+ * \brief Change waiting strategy of the ring buffer
+ *
+ * By default, #IPX_RING_TYPE_BLOCK uses #IPX_RING_WAIT_PARK and #IPX_RING_TYPE_LOCKFREE uses
+ * #IPX_RING_WAIT_ADAPTIVE. The same strategy is used by the reader and all writers.
+ * \warning
+ *   During this function call, the user MUST make sure that nobody is using the buffer.
+ * \param[in] ring Ring buffer
+ * \param[in] wait New waiting strategy (#IPX_RING_WAIT_DEFAULT to use the default one)
+ */
+IPX_API void
+ipx_ring_wait_set(ipx_ring_t *ring, enum ipx_ring_wait wait);
+
+/**
+ * \brief Place memory of the ring buffer on a NUMA node
+ *
+ * Memory of the ring buffer (i.e. slots of messages) is preferably allocated on the given node
+ * and already allocated pages are moved there. It should be the node of the reader.
+ * \note Failure is not fatal, the buffer is still usable.
+ * \warning
+ *   During this function call, the user MUST make sure that nobody is using the buffer.
+ * \param[in] ring Ring buffer
+ * \param[in] node NUMA node
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_DENIED if the memory cannot be placed on the node
+ */
+IPX_API int
+ipx_ring_node_set(ipx_ring_t *ring, unsigned int node);
+
+/**
+ * \brief Enable adaptive capacity of the ring buffer
+ *
+ * The capacity starts at the size given to ipx_ring_init() and it is doubled (up to \p max)
+ * when writers repeatedly have to wait on a full buffer within a short period. After a long
+ * period of low occupancy, the capacity is halved again (down to the initial size). The current
+ * capacity is reported by ipx_ring_stats_get().
+ * \note Supported only by #IPX_RING_TYPE_BLOCK. Changes of the capacity are performed by
+ *   writers, the reader switches to the new memory after it reads all older messages.
+ * \warning
+ *   During this function call, the user MUST make sure that nobody is using the buffer.
+ * \param[in] ring Ring buffer
+ * \param[in] max  Maximum capacity (equal to the initial size to disable adaptation)
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_ARG if the type of the buffer is not supported or \p max is out of range
+ */
+IPX_API int
+ipx_ring_adaptive_set(ipx_ring_t *ring, uint32_t max);
+
+/**
+ * \brief Get waiting strategy of the ring buffer
+ * \param[in] ring Ring buffer
+ * \return Strategy (never #IPX_RING_WAIT_DEFAULT)
+ */
+IPX_API enum ipx_ring_wait
+ipx_ring_wait_get(const ipx_ring_t *ring);
+
 /**
  * \brief A ring buffer to destroy
  * \param[in] ring
@@ -99,6 +261,20 @@ ipx_ring_destroy(ipx_ring_t *ring);
 IPX_API void
 ipx_ring_push(ipx_ring_t *ring, ipx_msg_t *msg);
 
+/**
+ * \brief Try to add a message into the ring buffer without waiting
+ *
+ * Same as ipx_ring_push(), however, if the buffer is full, the function returns immediately.
+ * \note In case of #IPX_RING_TYPE_BLOCK, the buffer might be considered as full even if the
+ *   reader has already processed some messages, but it hasn't released the block of the buffer
+ *   yet.
+ * \param[in] ring Ring buffer
+ * \param[in] msg  Message to be added into the ring buffer
+ * \return True if the message has been added, false if the buffer is full.
+ */
+IPX_API bool
+ipx_ring_try_push(ipx_ring_t *ring, ipx_msg_t *msg);
+
 /**
  * \brief Get a message from the ring buffer
  *
@@ -110,6 +286,54 @@ ipx_ring_push(ipx_ring_t *ring, ipx_msg_t *msg);
 IPX_API ipx_msg_t *
 ipx_ring_pop(ipx_ring_t *ring);
 
+/**
+ * \brief Add multiple messages into the ring buffer
+ *
+ * The messages are added in the same order as they are stored in the array. Compared to
+ * repeated calls of ipx_ring_push(), synchronization with the reader is performed only once
+ * per continuous block of empty space in the buffer.
+ * \note The function blocks until all messages are added.
+ * \note If the multi-writer mode is enabled, messages from other writers are never interleaved
+ *   with messages of the array in case of #IPX_RING_TYPE_BLOCK. In case of
+ *   #IPX_RING_TYPE_LOCKFREE, order of the messages is also preserved because all slots are
+ *   reserved at once.
+ * \param[in] ring Ring buffer
+ * \param[in] msgs Array of messages to be added into the ring buffer
+ * \param[in] cnt  Number of messages in the array
+ */
+IPX_API void
+ipx_ring_push_bulk(ipx_ring_t *ring, ipx_msg_t * const *msgs, uint32_t cnt);
+
+/**
+ * \brief Get multiple messages from the ring buffer
+ *
+ * The function returns all messages that are immediately available (up to \p max), so
+ * the reader doesn't have to synchronize with writers for every message. Headers of the returned
+ * messages are prefetched into the CPU cache.
+ * \note The function blocks until at least one message is ready.
+ * \warning Cannot be used concurrently by multiple threads at the same time. Moreover, the
+ *   returned messages are considered as processed by the next call of ipx_ring_pop() or
+ *   ipx_ring_pop_bulk().
+ * \param[in]  ring Ring buffer
+ * \param[out] msgs Array to be filled with pointers to the messages
+ * \param[in]  max  Size of the array (must be non-zero)
+ * \return Number of messages stored into the array (always at least 1)
+ */
+IPX_API uint32_t
+ipx_ring_pop_bulk(ipx_ring_t *ring, ipx_msg_t **msgs, uint32_t max);
+
+/**
+ * \brief Get runtime statistics of the ring buffer
+ *
+ * Counters are updated by the reader and writers using relaxed atomic operations, therefore,
+ * the function can be called by any thread at any time. However, values of different counters
+ * are not guaranteed to be consistent with each other.
+ * \param[in]  ring  Ring buffer
+ * \param[out] stats Statistics
+ */
+IPX_API void
+ipx_ring_stats_get(const ipx_ring_t *ring, struct ipx_ring_stats *stats);
+
 /**
  * \brief Change (i.e. disable/enable) multi-writer mode
  *
@@ -0,0 +1,117 @@
+/**
+ * \file src/core/trace.h
+ * \author agent <agent@local>
+ * \brief Static tracepoints (USDT probes) of the collector core (header file)
+ * \date 2026
+ */
+
+
+/* Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is'', and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#ifndef IPX_TRACE_H
+#define IPX_TRACE_H
+
+#include <build_config.h>
+
+/**
+ * \defgroup ipxTrace Static tracepoints
+ * \brief User-level statically defined tracepoints (USDT) for live debugging
+ *
+ * If the collector is built with \<sys/sdt.h\> (SystemTap SDT headers), each tracepoint is
+ * compiled as a single "nop" instruction and a note in the binary. Tools such as bpftrace,
+ * perf or SystemTap can attach to it at runtime without rebuilding the collector, e.g.
+ * \code{.sh}
+ * bpftrace -e 'usdt:/usr/bin/ipfixcol2:ipfixcol2:ring_push { @[arg0] = count(); }'
+ * \endcode
+ * Otherwise, tracepoints are removed entirely. Arguments must be integers or pointers and
+ * should be cheap to evaluate because they are evaluated even if no tool is attached.
+ *
+ * All tracepoints belong to the "ipfixcol2" provider:
+ *
+ * | Name                  | Arguments                                                |
+ * |-----------------------|----------------------------------------------------------|
+ * | ring_push             | ring, message                                            |
+ * | ring_push_bulk        | ring, array of messages, number of messages              |
+ * | ring_pop              | ring, message                                            |
+ * | ring_pop_bulk         | ring, array of messages, number of messages              |
+ * | parser_process_entry  | parser, IPFIX Message, ODID                              |
+ * | parser_process_return | parser, IPFIX Message (might be reallocated), status code |
+ * | template_add          | parser, ODID, Template ID, template type                 |
+ * | template_withdraw     | parser, ODID, Template ID, template type                 |
+ * | ctx_msg_pass          | instance name, message                                   |
+ * | plugin_get_entry      | instance name                                            |
+ * | plugin_get_return     | instance name, status code                               |
+ * | plugin_process_entry  | instance name, message, message type                     |
+ * | plugin_process_return | instance name, message, status code                      |
+ *
+ * A message pushed by ipx_ring_push() into a broadcast ring buffer also fires ring_push_bulk.
+ * Withdrawal of all (Options) Templates is reported with the Template ID of the Set
+ * (i.e. 2 or 3).
+ * @{
+ */
+
+#ifdef HAVE_SYS_SDT_H
+#include <sys/sdt.h>
+
+/** Tracepoint with 1 argument  */
+#define IPX_TRACE1(name, a1) \
+    DTRACE_PROBE1(ipfixcol2, name, a1)
+/** Tracepoint with 2 arguments */
+#define IPX_TRACE2(name, a1, a2) \
+    DTRACE_PROBE2(ipfixcol2, name, a1, a2)
+/** Tracepoint with 3 arguments */
+#define IPX_TRACE3(name, a1, a2, a3) \
+    DTRACE_PROBE3(ipfixcol2, name, a1, a2, a3)
+/** Tracepoint with 4 arguments */
+#define IPX_TRACE4(name, a1, a2, a3, a4) \
+    DTRACE_PROBE4(ipfixcol2, name, a1, a2, a3, a4)
+
+#else
+
+// Arguments are never evaluated, sizeof only prevents "unused" warnings
+#define IPX_TRACE1(name, a1) \
+    do { (void) sizeof(a1); } while (0)
+#define IPX_TRACE2(name, a1, a2) \
+    do { (void) sizeof(a1); (void) sizeof(a2); } while (0)
+#define IPX_TRACE3(name, a1, a2, a3) \
+    do { (void) sizeof(a1); (void) sizeof(a2); (void) sizeof(a3); } while (0)
+#define IPX_TRACE4(name, a1, a2, a3, a4) \
+    do { (void) sizeof(a1); (void) sizeof(a2); (void) sizeof(a3); (void) sizeof(a4); } while (0)
+
+#endif // HAVE_SYS_SDT_H
+
+/**@}*/
+
+#endif // IPX_TRACE_H
@@ -0,0 +1,645 @@
+/**
+ * \file src/core/uring.c
+ * \author agent <agent@local>
+ * \brief Asynchronous socket I/O based on io_uring (source file)
+ * \date 2026
+ */
+
+/* Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is'', and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#define _GNU_SOURCE
+#include <ipfixcol2.h>
+#include <build_config.h>
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef HAVE_IO_URING
+#include <linux/io_uring.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+/** Identification of the group of receive buffers                                               */
+#define URING_BGID        (0)
+/** Maximum number of receive buffers (limited by the size of a buffer ID)                       */
+#define URING_BUF_MAX     (32768U)
+
+/** Internal structure of an instance                                                            */
+struct ipx_uring {
+    /** File descriptor of the io_uring instance                                                 */
+    int fd;
+    /** Memory mapped submission and completion queue rings                                      */
+    void *ring_ptr;
+    /** Size of the mapped rings                                                                 */
+    size_t ring_size;
+
+    struct {
+        /** Head (consumed by the kernel)                                                        */
+        unsigned int *head;
+        /** Tail (produced by us)                                                                */
+        unsigned int *tail;
+        /** Index mask                                                                           */
+        unsigned int mask;
+        /** Number of entries                                                                    */
+        unsigned int entries;
+        /** Array of submission entries                                                          */
+        struct io_uring_sqe *sqes;
+        /** Size of the array (in bytes)                                                         */
+        size_t sqes_size;
+        /** Local copy of the tail                                                               */
+        unsigned int local_tail;
+        /** Number of entries not submitted yet                                                  */
+        unsigned int pending;
+    } sq; /**< Submission queue                                                                  */
+
+    struct {
+        /** Head (consumed by us)                                                                */
+        unsigned int *head;
+        /** Tail (produced by the kernel)                                                        */
+        unsigned int *tail;
+        /** Index mask                                                                           */
+        unsigned int mask;
+        /** Array of completion entries                                                          */
+        struct io_uring_cqe *cqes;
+    } cq; /**< Completion queue                                                                  */
+
+    struct {
+        /** Ring of buffers shared with the kernel (NULL, if not available)                      */
+        struct io_uring_buf_ring *ring;
+        /** Size of the ring (in bytes)                                                          */
+        size_t ring_size;
+        /** Memory of all buffers                                                                */
+        uint8_t *mem;
+        /** Size of the memory (in bytes)                                                        */
+        size_t mem_size;
+        /** Size of a buffer                                                                     */
+        size_t size;
+        /** Number of buffers                                                                    */
+        unsigned int cnt;
+        /** Local copy of the tail                                                               */
+        uint16_t tail;
+        /** Buffers to give back to the kernel (used by the previous call of ipx_uring_wait())   */
+        uint16_t *used;
+        /** Number of buffers to give back                                                       */
+        unsigned int used_cnt;
+    } buf; /**< Receive buffers                                                                  */
+
+    /** Template of multishot receive requests                                                   */
+    struct msghdr msg;
+};
+
+/**
+ * \brief Add a buffer to the ring of receive buffers
+ * \note The buffer is available to the kernel after the tail is published.
+ * \param[in] ring Instance
+ * \param[in] bid  Buffer ID
+ */
+static inline void
+uring_buf_add(ipx_uring_t *ring, uint16_t bid)
+{
+    struct io_uring_buf *buf = &ring->buf.ring->bufs[ring->buf.tail & (ring->buf.cnt - 1)];
+    buf->addr = (uintptr_t) (ring->buf.mem + (size_t) bid * ring->buf.size);
+    buf->len = (uint32_t) ring->buf.size;
+    buf->bid = bid;
+    ring->buf.tail++;
+}
+
+/**
+ * \brief Publish the tail of the ring of receive buffers
+ * \param[in] ring Instance
+ */
+static inline void
+uring_buf_publish(ipx_uring_t *ring)
+{
+    __atomic_store_n(&ring->buf.ring->tail, ring->buf.tail, __ATOMIC_RELEASE);
+}
+
+/**
+ * \brief Register receive buffers with the kernel
+ * \param[in] ring     Instance
+ * \param[in] cnt      Number of buffers (power of two)
+ * \param[in] size     Size of each buffer
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_DENIED on failure (errno is set appropriately)
+ */
+static int
+uring_buf_init(ipx_uring_t *ring, unsigned int cnt, size_t size)
+{
+    ring->buf.cnt = cnt;
+    ring->buf.size = size;
+    ring->buf.ring_size = cnt * sizeof(struct io_uring_buf);
+    ring->buf.mem_size = cnt * size;
+
+    // The ring must be page aligned
+    void *ptr = mmap(NULL, ring->buf.ring_size, PROT_READ | PROT_WRITE,
+        MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (ptr == MAP_FAILED) {
+        return IPX_ERR_DENIED;
+    }
+    ring->buf.ring = ptr;
+
+    ptr = mmap(NULL, ring->buf.mem_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS,
+        -1, 0);
+    ring->buf.used = malloc(cnt * sizeof(*ring->buf.used));
+    if (ptr == MAP_FAILED || !ring->buf.used) {
+        if (ptr != MAP_FAILED) {
+            munmap(ptr, ring->buf.mem_size);
+        }
+        munmap(ring->buf.ring, ring->buf.ring_size);
+        ring->buf.ring = NULL;
+        free(ring->buf.used);
+        errno = ENOMEM;
+        return IPX_ERR_DENIED;
+    }
+    ring->buf.mem = ptr;
+
+    struct io_uring_buf_reg reg;
+    memset(&reg, 0, sizeof(reg));
+    reg.ring_addr = (uintptr_t) ring->buf.ring;
+    reg.ring_entries = cnt;
+    reg.bgid = URING_BGID;
+    if (syscall(__NR_io_uring_register, ring->fd, IORING_REGISTER_PBUF_RING, &reg, 1) != 0) {
+        int err = errno;
+        munmap(ring->buf.mem, ring->buf.mem_size);
+        munmap(ring->buf.ring, ring->buf.ring_size);
+        ring->buf.ring = NULL;
+        free(ring->buf.used);
+        errno = err;
+        return IPX_ERR_DENIED;
+    }
+
+    for (unsigned int i = 0; i < cnt; ++i) {
+        uring_buf_add(ring, (uint16_t) i);
+    }
+    uring_buf_publish(ring);
+    return IPX_OK;
+}
+
+/**
+ * \brief Submit pending requests and optionally wait for completions
+ * \param[in] ring    Instance
+ * \param[in] wait    Wait for at least one completion
+ * \param[in] timeout Timeout of waiting (in milliseconds)
+ * \return #IPX_OK on success (incl. timeout and interruption by a signal)
+ * \return #IPX_ERR_DENIED on failure (errno is set appropriately)
+ */
+static int
+uring_enter(ipx_uring_t *ring, bool wait, int timeout)
+{
+    unsigned int flags = 0;
+    struct __kernel_timespec ts;
+    struct io_uring_getevents_arg arg;
+    memset(&arg, 0, sizeof(arg));
+
+    if (wait) {
+        ts.tv_sec = timeout / 1000;
+        ts.tv_nsec = (timeout % 1000) * 1000000LL;
+        arg.sigmask_sz = _NSIG / 8;
+        arg.ts = (uintptr_t) &ts;
+        flags |= IORING_ENTER_GETEVENTS | IORING_ENTER_EXT_ARG;
+    } else if (ring->sq.pending == 0) {
+        return IPX_OK;
+    }
+
+    long ret = syscall(__NR_io_uring_enter, ring->fd, ring->sq.pending, wait ? 1 : 0, flags,
+        wait ? &arg : NULL, wait ? sizeof(arg) : 0);
+    if (ret < 0) {
+        if (errno == ETIME || errno == EINTR) {
+            return IPX_OK;
+        }
+        return IPX_ERR_DENIED;
+    }
+
+    ring->sq.pending -= (unsigned int) ret;
+    return IPX_OK;
+}
+
+/**
+ * \brief Get a free submission entry
+ *
+ * If the queue is full, pending requests are submitted first.
+ * \param[in] ring Instance
+ * \return Pointer to a cleared entry or NULL
+ */
+static struct io_uring_sqe *
+uring_sqe_get(ipx_uring_t *ring)
+{
+    unsigned int head = __atomic_load_n(ring->sq.head, __ATOMIC_ACQUIRE);
+    if (ring->sq.local_tail - head >= ring->sq.entries) {
+        if (uring_enter(ring, false, 0) != IPX_OK) {
+            return NULL;
+        }
+
+        head = __atomic_load_n(ring->sq.head, __ATOMIC_ACQUIRE);
+        if (ring->sq.local_tail - head >= ring->sq.entries) {
+            errno = EBUSY;
+            return NULL;
+        }
+    }
+
+    struct io_uring_sqe *sqe = &ring->sq.sqes[ring->sq.local_tail & ring->sq.mask];
+    memset(sqe, 0, sizeof(*sqe));
+    return sqe;
+}
+
+/**
+ * \brief Make the last entry returned by uring_sqe_get() visible to the kernel
+ * \param[in] ring Instance
+ */
+static inline void
+uring_sqe_push(ipx_uring_t *ring)
+{
+    ring->sq.local_tail++;
+    ring->sq.pending++;
+    __atomic_store_n(ring->sq.tail, ring->sq.local_tail, __ATOMIC_RELEASE);
+}
+
+/**
+ * \brief Fill an event from a completion entry
+ * \param[in]  ring  Instance
+ * \param[in]  cqe   Completion entry
+ * \param[out] event Event
+ */
+static void
+uring_event_fill(ipx_uring_t *ring, const struct io_uring_cqe *cqe, struct ipx_uring_event *event)
+{
+    event->user_data = cqe->user_data;
+    event->res = cqe->res;
+    event->more = (cqe->flags & IORING_CQE_F_MORE) != 0;
+    event->data = NULL;
+    event->size = 0;
+    event->truncated = false;
+
+    if ((cqe->flags & IORING_CQE_F_BUFFER) == 0) {
+        return;
+    }
+
+    // Remember the buffer so it can be given back by the next call
+    uint16_t bid = (uint16_t) (cqe->flags >> IORING_CQE_BUFFER_SHIFT);
+    ring->buf.used[ring->buf.used_cnt++] = bid;
+    if (cqe->res < 0) {
+        return;
+    }
+
+    /* Layout of the buffer: header, source address (of the size of the template),
+     * control data (not used) and the payload */
+    const uint8_t *buf = ring->buf.mem + (size_t) bid * ring->buf.size;
+    const struct io_uring_recvmsg_out *out = (const struct io_uring_recvmsg_out *) buf;
+    size_t hdr_size = sizeof(*out) + ring->msg.msg_namelen + ring->msg.msg_controllen;
+    if ((size_t) cqe->res < hdr_size) {
+        event->res = -EFAULT;
+        return;
+    }
+
+    size_t addr_len = out->namelen;
+    if (addr_len > ring->msg.msg_namelen) {
+        addr_len = ring->msg.msg_namelen;
+    }
+    memset(&event->addr, 0, sizeof(event->addr));
+    memcpy(&event->addr, buf + sizeof(*out), addr_len);
+
+    event->data = buf + hdr_size;
+    event->size = (size_t) cqe->res - hdr_size;
+    event->truncated = (out->flags & MSG_TRUNC) != 0 || out->payloadlen > event->size;
+}
+
+bool
+ipx_uring_supported()
+{
+    return true;
+}
+
+ipx_uring_t *
+ipx_uring_create(unsigned int depth, unsigned int buf_cnt, size_t buf_size)
+{
+    if (depth == 0 || buf_cnt > URING_BUF_MAX || (buf_cnt > 0 && buf_size == 0)
+            || buf_size > UINT32_MAX) {
+        errno = EINVAL;
+        return NULL;
+    }
+
+    ipx_uring_t *ring = calloc(1, sizeof(*ring));
+    if (!ring) {
+        return NULL;
+    }
+
+    // Each receive buffer can produce one completion
+    struct io_uring_params params;
+    memset(&params, 0, sizeof(params));
+    params.flags = IORING_SETUP_CQSIZE;
+    params.cq_entries = 2 * ((depth > buf_cnt) ? depth : buf_cnt);
+
+    ring->fd = (int) syscall(__NR_io_uring_setup, depth, &params);
+    if (ring->fd < 0) {
+        free(ring);
+        return NULL;
+    }
+
+    const uint32_t features = IORING_FEAT_SINGLE_MMAP | IORING_FEAT_NODROP | IORING_FEAT_EXT_ARG;
+    if ((params.features & features) != features) {
+        // Too old kernel
+        close(ring->fd);
+        free(ring);
+        errno = ENOSYS;
+        return NULL;
+    }
+
+    // Map the submission and completion queues (a single mapping)
+    size_t sq_size = params.sq_off.array + params.sq_entries * sizeof(unsigned int);
+    size_t cq_size = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+    ring->ring_size = (sq_size > cq_size) ? sq_size : cq_size;
+    ring->ring_ptr = mmap(NULL, ring->ring_size, PROT_READ | PROT_WRITE,
+        MAP_SHARED | MAP_POPULATE, ring->fd, IORING_OFF_SQ_RING);
+    ring->sq.sqes_size = params.sq_entries * sizeof(struct io_uring_sqe);
+    void *sqes = mmap(NULL, ring->sq.sqes_size, PROT_READ | PROT_WRITE,
+        MAP_SHARED | MAP_POPULATE, ring->fd, IORING_OFF_SQES);
+    if (ring->ring_ptr == MAP_FAILED || sqes == MAP_FAILED) {
+        int err = errno;
+        if (ring->ring_ptr != MAP_FAILED) {
+            munmap(ring->ring_ptr, ring->ring_size);
+        }
+        if (sqes != MAP_FAILED) {
+            munmap(sqes, ring->sq.sqes_size);
+        }
+        close(ring->fd);
+        free(ring);
+        errno = err;
+        return NULL;
+    }
+
+    uint8_t *ptr = ring->ring_ptr;
+    ring->sq.head = (unsigned int *) (ptr + params.sq_off.head);
+    ring->sq.tail = (unsigned int *) (ptr + params.sq_off.tail);
+    ring->sq.mask = *(unsigned int *) (ptr + params.sq_off.ring_mask);
+    ring->sq.entries = *(unsigned int *) (ptr + params.sq_off.ring_entries);
+    ring->sq.sqes = sqes;
+    ring->sq.local_tail = *ring->sq.tail;
+    ring->sq.pending = 0;
+    ring->cq.head = (unsigned int *) (ptr + params.cq_off.head);
+    ring->cq.tail = (unsigned int *) (ptr + params.cq_off.tail);
+    ring->cq.mask = *(unsigned int *) (ptr + params.cq_off.ring_mask);
+    ring->cq.cqes = (struct io_uring_cqe *) (ptr + params.cq_off.cqes);
+
+    // Submission entries are always used in order
+    unsigned int *array = (unsigned int *) (ptr + params.sq_off.array);
+    for (unsigned int i = 0; i < ring->sq.entries; ++i) {
+        array[i] = i;
+    }
+
+    // Template of receive requests (only sizes are used by the kernel)
+    ring->msg.msg_namelen = sizeof(struct sockaddr_storage);
+    ring->msg.msg_controllen = 0;
+
+    if (buf_cnt > 0) {
+        // Round up to a power of two
+        unsigned int cnt = 1;
+        while (cnt < buf_cnt) {
+            cnt <<= 1;
+        }
+
+        size_t hdr_size = sizeof(struct io_uring_recvmsg_out) + ring->msg.msg_namelen;
+        if (uring_buf_init(ring, cnt, buf_size + hdr_size) != IPX_OK) {
+            int err = errno;
+            ipx_uring_destroy(ring);
+            errno = err;
+            return NULL;
+        }
+    }
+
+    return ring;
+}
+
+void
+ipx_uring_destroy(ipx_uring_t *ring)
+{
+    if (!ring) {
+        return;
+    }
+
+    // Closing of the instance cancels all requests (buffers are unregistered by the kernel)
+    close(ring->fd);
+    munmap(ring->sq.sqes, ring->sq.sqes_size);
+    munmap(ring->ring_ptr, ring->ring_size);
+    if (ring->buf.ring != NULL) {
+        munmap(ring->buf.mem, ring->buf.mem_size);
+        munmap(ring->buf.ring, ring->buf.ring_size);
+        free(ring->buf.used);
+    }
+    free(ring);
+}
+
+int
+ipx_uring_recv_multishot(ipx_uring_t *ring, int fd, uint64_t user_data)
+{
+    if (ring->buf.ring == NULL) {
+        return IPX_ERR_ARG;
+    }
+
+    struct io_uring_sqe *sqe = uring_sqe_get(ring);
+    if (!sqe) {
+        return IPX_ERR_DENIED;
+    }
+
+    sqe->opcode = IORING_OP_RECVMSG;
+    sqe->fd = fd;
+    sqe->addr = (uintptr_t) &ring->msg;
+    sqe->len = 1;
+    sqe->ioprio = IORING_RECV_MULTISHOT;
+    sqe->flags = IOSQE_BUFFER_SELECT;
+    sqe->buf_group = URING_BGID;
+    sqe->user_data = user_data;
+    uring_sqe_push(ring);
+    return IPX_OK;
+}
+
+int
+ipx_uring_read(ipx_uring_t *ring, int fd, void *buffer, size_t size, uint64_t user_data)
+{
+    struct io_uring_sqe *sqe = uring_sqe_get(ring);
+    if (!sqe) {
+        return IPX_ERR_DENIED;
+    }
+
+    sqe->opcode = IORING_OP_READ;
+    sqe->fd = fd;
+    sqe->addr = (uintptr_t) buffer;
+    sqe->len = (uint32_t) size;
+    sqe->off = (uint64_t) -1; // Current file position
+    sqe->user_data = user_data;
+    uring_sqe_push(ring);
+    return IPX_OK;
+}
+
+int
+ipx_uring_send(ipx_uring_t *ring, int fd, const void *data, size_t size, int flags,
+    uint64_t user_data)
+{
+    struct io_uring_sqe *sqe = uring_sqe_get(ring);
+    if (!sqe) {
+        return IPX_ERR_DENIED;
+    }
+
+    sqe->opcode = IORING_OP_SEND;
+    sqe->fd = fd;
+    sqe->addr = (uintptr_t) data;
+    sqe->len = (uint32_t) size;
+    sqe->msg_flags = (uint32_t) flags;
+    sqe->user_data = user_data;
+    uring_sqe_push(ring);
+    return IPX_OK;
+}
+
+int
+ipx_uring_submit(ipx_uring_t *ring)
+{
+    return uring_enter(ring, false, 0);
+}
+
+int
+ipx_uring_wait(ipx_uring_t *ring, struct ipx_uring_event *events, unsigned int max, int timeout)
+{
+    // Give back buffers of the previous call
+    if (ring->buf.used_cnt > 0) {
+        for (unsigned int i = 0; i < ring->buf.used_cnt; ++i) {
+            uring_buf_add(ring, ring->buf.used[i]);
+        }
+        ring->buf.used_cnt = 0;
+        uring_buf_publish(ring);
+    }
+
+    unsigned int head = *ring->cq.head;
+    unsigned int tail = __atomic_load_n(ring->cq.tail, __ATOMIC_ACQUIRE);
+    if (head == tail) {
+        // Nothing completed yet, submit and wait
+        if (uring_enter(ring, true, timeout) != IPX_OK) {
+            return IPX_ERR_DENIED;
+        }
+        tail = __atomic_load_n(ring->cq.tail, __ATOMIC_ACQUIRE);
+    } else if (uring_enter(ring, false, 0) != IPX_OK) {
+        return IPX_ERR_DENIED;
+    }
+
+    unsigned int cnt = 0;
+    while (head != tail && cnt < max) {
+        uring_event_fill(ring, &ring->cq.cqes[head & ring->cq.mask], &events[cnt]);
+        head++;
+        cnt++;
+    }
+
+    __atomic_store_n(ring->cq.head, head, __ATOMIC_RELEASE);
+    return (int) cnt;
+}
+
+#else
+/* The collector has been built without io_uring support */
+
+bool
+ipx_uring_supported()
+{
+    return false;
+}
+
+ipx_uring_t *
+ipx_uring_create(unsigned int depth, unsigned int buf_cnt, size_t buf_size)
+{
+    (void) depth;
+    (void) buf_cnt;
+    (void) buf_size;
+    errno = ENOSYS;
+    return NULL;
+}
+
+void
+ipx_uring_destroy(ipx_uring_t *ring)
+{
+    (void) ring;
+}
+
+int
+ipx_uring_recv_multishot(ipx_uring_t *ring, int fd, uint64_t user_data)
+{
+    (void) ring;
+    (void) fd;
+    (void) user_data;
+    return IPX_ERR_DENIED;
+}
+
+int
+ipx_uring_read(ipx_uring_t *ring, int fd, void *buffer, size_t size, uint64_t user_data)
+{
+    (void) ring;
+    (void) fd;
+    (void) buffer;
+    (void) size;
+    (void) user_data;
+    return IPX_ERR_DENIED;
+}
+
+int
+ipx_uring_send(ipx_uring_t *ring, int fd, const void *data, size_t size, int flags,
+    uint64_t user_data)
+{
+    (void) ring;
+    (void) fd;
+    (void) data;
+    (void) size;
+    (void) flags;
+    (void) user_data;
+    return IPX_ERR_DENIED;
+}
+
+int
+ipx_uring_submit(ipx_uring_t *ring)
+{
+    (void) ring;
+    errno = ENOSYS;
+    return IPX_ERR_DENIED;
+}
+
+int
+ipx_uring_wait(ipx_uring_t *ring, struct ipx_uring_event *events, unsigned int max, int timeout)
+{
+    (void) ring;
+    (void) events;
+    (void) max;
+    (void) timeout;
+    errno = ENOSYS;
+    return IPX_ERR_DENIED;
+}
+
+#endif // HAVE_IO_URING
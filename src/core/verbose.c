@@ -41,8 +41,15 @@
 
 #include <stdio.h>
 #include <stdarg.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
 #include <syslog.h>
 #include <stdbool.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <pthread.h>
+#include <time.h>
 
 #include <ipfixcol2.h>
 #include "build_config.h"
@@ -55,6 +62,87 @@ static enum ipx_verb_level vlevel = IPX_VERB_ERROR;
 /** Do not use syslog unless specified otherwise */
 static bool use_syslog = false;
 
+/** Number of tracked origins of rate-limited messages per thread (must be a power of two) */
+#define VERB_RL_SLOTS (64U)
+
+/** Rate limiting state of an origin of messages */
+struct verb_rl_slot {
+    /** Identification of the origin (NULL, if the slot is unused) */
+    const char *name;
+    /** Format string of the messages               */
+    const char *fmt;
+    /** Start of the current interval (in seconds)  */
+    time_t since;
+    /** Number of printed messages in the interval  */
+    unsigned int printed;
+    /** Number of suppressed messages               */
+    uint64_t suppressed;
+};
+
+/** Rate limiting state (each thread has its own, therefore, no locking is required) */
+static __thread struct verb_rl_slot verb_rl_slots[VERB_RL_SLOTS];
+
+/** Number of messages in a queue of a thread (must be a power of two)    */
+#define VERB_QUEUE_SIZE (256U)
+/** Maximum length of a message in a queue (longer messages are truncated) */
+#define VERB_MSG_SIZE (496U)
+/** Sleep interval of the writer thread if there are no messages (ns)      */
+#define VERB_WRITER_SLEEP (10000000L)
+
+/** Formatted message */
+struct verb_msg {
+    /** Verbosity level (for syslog severity)   */
+    enum ipx_verb_level level;
+    /** Length of the message                   */
+    uint32_t len;
+    /** Message                                 */
+    char text[VERB_MSG_SIZE];
+};
+
+/**
+ * \brief Queue of messages of a thread
+ *
+ * Single-producer single-consumer ring. The producer is the thread that owns the queue, the
+ * consumer is the writer thread. Neither of them is ever blocked by the other one.
+ */
+struct verb_queue {
+    /** Next queue in the list of all queues    */
+    struct verb_queue *next;
+    /** Index of the next message to write (producer only)   */
+    _Atomic uint32_t head;
+    /** Index of the next message to read (consumer only)    */
+    _Atomic uint32_t tail;
+    /** Number of dropped messages (full queue)              */
+    _Atomic uint64_t dropped;
+    /** The owner thread has terminated (i.e. free when empty) */
+    _Atomic bool closed;
+    /** Messages                                */
+    struct verb_msg msgs[VERB_QUEUE_SIZE];
+};
+
+/** Asynchronous logging backend */
+static struct {
+    /** Enabled (i.e. messages are passed to the writer thread) */
+    _Atomic bool enabled;
+    /** Generation of queues (increased whenever all queues are destroyed)  */
+    _Atomic unsigned int gen;
+    /** Request to stop the writer thread       */
+    _Atomic bool stop;
+    /** Writer thread                           */
+    pthread_t thread;
+    /** Key of a thread-specific queue (for notification about thread termination) */
+    pthread_key_t key;
+    /** Mutex protecting the list of queues (only registration and removal) */
+    pthread_mutex_t mutex;
+    /** List of all queues                      */
+    struct verb_queue *queues;
+} verb_async = {.mutex = PTHREAD_MUTEX_INITIALIZER};
+
+/** Queue of the current thread (NULL, if not allocated yet) */
+static __thread struct verb_queue *verb_queue_tls = NULL;
+/** Generation of the queue of the current thread            */
+static __thread unsigned int verb_queue_tls_gen = 0;
+
 // Get verbosity level of the collector
 enum ipx_verb_level
 ipx_verb_level_get()
@@ -112,6 +200,312 @@ ipx_verb_level2syslog(const enum ipx_verb_level level)
     return LOG_ERR;
 }
 
+/**
+ * \brief Callback on termination of a thread with a queue
+ * \param[in] arg Queue of the thread
+ */
+static void
+verb_queue_close(void *arg)
+{
+    struct verb_queue *queue = (struct verb_queue *) arg;
+    atomic_store_explicit(&queue->closed, true, memory_order_release);
+}
+
+/**
+ * \brief Get the queue of the current thread (allocate, if necessary)
+ * \return Pointer to the queue or NULL (memory allocation error)
+ */
+static struct verb_queue *
+verb_queue_get()
+{
+    const unsigned int gen = atomic_load_explicit(&verb_async.gen, memory_order_acquire);
+    if (verb_queue_tls != NULL && verb_queue_tls_gen == gen) {
+        return verb_queue_tls;
+    }
+
+    struct verb_queue *queue = calloc(1, sizeof(*queue));
+    if (!queue) {
+        return NULL;
+    }
+
+    pthread_mutex_lock(&verb_async.mutex);
+    queue->next = verb_async.queues;
+    verb_async.queues = queue;
+    pthread_setspecific(verb_async.key, queue);
+    pthread_mutex_unlock(&verb_async.mutex);
+
+    verb_queue_tls = queue;
+    verb_queue_tls_gen = gen;
+    return queue;
+}
+
+/**
+ * \brief Pass a message to the writer thread
+ *
+ * The message is formatted by the calling thread and stored in its queue. If the queue is full,
+ * the message is dropped (and counted).
+ * \param[in] level Verbosity level of the message
+ * \param[in] fmt   Format string
+ * \param[in] ap    Arguments of the format string
+ * \return True, if the message has been processed (i.e. stored or dropped). False, if the
+ *   message should be printed synchronously.
+ */
+static bool
+verb_async_push(enum ipx_verb_level level, const char *fmt, va_list ap)
+{
+    struct verb_queue *queue = verb_queue_get();
+    if (!queue) {
+        return false;
+    }
+
+    const uint32_t head = atomic_load_explicit(&queue->head, memory_order_relaxed);
+    const uint32_t tail = atomic_load_explicit(&queue->tail, memory_order_acquire);
+    if (head - tail >= VERB_QUEUE_SIZE) {
+        atomic_fetch_add_explicit(&queue->dropped, 1, memory_order_relaxed);
+        return true;
+    }
+
+    struct verb_msg *msg = &queue->msgs[head & (VERB_QUEUE_SIZE - 1)];
+    int rv = vsnprintf(msg->text, VERB_MSG_SIZE, fmt, ap);
+    if (rv < 0) {
+        return false;
+    }
+
+    if ((size_t) rv >= VERB_MSG_SIZE) {
+        // Truncated, but always terminated by a new line
+        static const char trunc_str[] = "...\n";
+        memcpy(&msg->text[VERB_MSG_SIZE - sizeof(trunc_str)], trunc_str, sizeof(trunc_str));
+        rv = VERB_MSG_SIZE - 1;
+    }
+
+    msg->level = level;
+    msg->len = (uint32_t) rv;
+    atomic_store_explicit(&queue->head, head + 1, memory_order_release);
+    return true;
+}
+
+/**
+ * \brief Write all messages of a queue (writer thread only)
+ * \param[in] queue Queue
+ * \return Number of written messages
+ */
+static size_t
+verb_queue_flush(struct verb_queue *queue)
+{
+    const uint32_t head = atomic_load_explicit(&queue->head, memory_order_acquire);
+    uint32_t tail = atomic_load_explicit(&queue->tail, memory_order_relaxed);
+    const size_t cnt = head - tail;
+
+    for (; tail != head; ++tail) {
+        const struct verb_msg *msg = &queue->msgs[tail & (VERB_QUEUE_SIZE - 1)];
+        fwrite(msg->text, 1, msg->len, stdout);
+        if (use_syslog) {
+            syslog(ipx_verb_level2syslog(msg->level), "%s", msg->text);
+        }
+        atomic_store_explicit(&queue->tail, tail + 1, memory_order_release);
+    }
+
+    const uint64_t dropped = atomic_exchange_explicit(&queue->dropped, 0, memory_order_relaxed);
+    if (dropped > 0) {
+        static const char *fmt = "WARNING: Logger: %" PRIu64 " messages have been dropped "
+            "(too many messages)\n";
+        printf(fmt, dropped);
+        if (use_syslog) {
+            syslog(LOG_WARNING, fmt, dropped);
+        }
+    }
+
+    return cnt;
+}
+
+/**
+ * \brief Write messages of all queues and remove queues of terminated threads (writer only)
+ * \return Number of written messages
+ */
+static size_t
+verb_queues_flush()
+{
+    size_t cnt = 0;
+
+    pthread_mutex_lock(&verb_async.mutex);
+    struct verb_queue **ptr = &verb_async.queues;
+    while (*ptr != NULL) {
+        struct verb_queue *queue = *ptr;
+        // Check if closed before flushing, so the last messages are never lost
+        const bool closed = atomic_load_explicit(&queue->closed, memory_order_acquire);
+        cnt += verb_queue_flush(queue);
+        if (closed) {
+            *ptr = queue->next;
+            free(queue);
+            continue;
+        }
+        ptr = &queue->next;
+    }
+    pthread_mutex_unlock(&verb_async.mutex);
+
+    if (cnt > 0) {
+        fflush(stdout);
+    }
+    return cnt;
+}
+
+/**
+ * \brief Main function of the writer thread
+ * \param[in] arg Unused
+ * \return NULL
+ */
+static void *
+verb_writer(void *arg)
+{
+    (void) arg;
+    const struct timespec delay = {0, VERB_WRITER_SLEEP};
+
+    while (!atomic_load_explicit(&verb_async.stop, memory_order_acquire)) {
+        if (verb_queues_flush() == 0) {
+            nanosleep(&delay, NULL);
+        }
+    }
+
+    // Write remaining messages
+    verb_queues_flush();
+    return NULL;
+}
+
+// Enable/disable the asynchronous logging backend
+int
+ipx_verb_async(bool enable)
+{
+    if (enable == atomic_load(&verb_async.enabled)) {
+        // Nothing to do...
+        return IPX_OK;
+    }
+
+    if (enable) {
+        if (pthread_key_create(&verb_async.key, &verb_queue_close) != 0) {
+            return IPX_ERR_DENIED;
+        }
+
+        atomic_store(&verb_async.stop, false);
+        if (pthread_create(&verb_async.thread, NULL, &verb_writer, NULL) != 0) {
+            pthread_key_delete(verb_async.key);
+            return IPX_ERR_DENIED;
+        }
+
+        atomic_store(&verb_async.enabled, true);
+        return IPX_OK;
+    }
+
+    // Disable and write all remaining messages
+    atomic_store(&verb_async.enabled, false);
+    atomic_store(&verb_async.stop, true);
+    pthread_join(verb_async.thread, NULL);
+    pthread_key_delete(verb_async.key);
+
+    // Destroy all queues (threads will allocate new ones, if enabled again)
+    pthread_mutex_lock(&verb_async.mutex);
+    while (verb_async.queues != NULL) {
+        struct verb_queue *next = verb_async.queues->next;
+        free(verb_async.queues);
+        verb_async.queues = next;
+    }
+    pthread_mutex_unlock(&verb_async.mutex);
+    atomic_fetch_add(&verb_async.gen, 1);
+    return IPX_OK;
+}
+
+/**
+ * \brief Print a message (synchronously or by the writer thread)
+ * \param[in] level Verbosity level of the message
+ * \param[in] fmt   Format string
+ * \param[in] ap    Arguments of the format string
+ */
+static void
+verb_vprint(enum ipx_verb_level level, const char *fmt, va_list ap)
+{
+    if (atomic_load_explicit(&verb_async.enabled, memory_order_relaxed)) {
+        va_list ap_async;
+        va_copy(ap_async, ap);
+        const bool done = verb_async_push(level, fmt, ap_async);
+        va_end(ap_async);
+        if (done) {
+            return;
+        }
+    }
+
+    va_list ap_syslog;
+    va_copy(ap_syslog, ap);
+    vprintf(fmt, ap);
+    if (use_syslog) {
+        vsyslog(ipx_verb_level2syslog(level), fmt, ap_syslog);
+    }
+    va_end(ap_syslog);
+}
+
+/**
+ * \brief Check if a message of the given origin can be printed (rate limiting)
+ * \param[in]  name       Identification of the origin
+ * \param[in]  fmt        Format string of the message
+ * \param[out] suppressed Number of messages suppressed since the last printed message
+ * \return True, if the message should be printed. False otherwise.
+ */
+static bool
+verb_rl_allow(const char *name, const char *fmt, uint64_t *suppressed)
+{
+    uintptr_t key = (uintptr_t) name ^ ((uintptr_t) fmt >> 3);
+    key ^= key >> 7;
+    key ^= key >> 17;
+    struct verb_rl_slot *slot = &verb_rl_slots[key & (VERB_RL_SLOTS - 1)];
+
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC_COARSE, &ts);
+    *suppressed = 0;
+
+    if (slot->name != name || slot->fmt != fmt) {
+        // New origin (the state of the previous one is lost)
+        slot->name = name;
+        slot->fmt = fmt;
+        slot->since = ts.tv_sec;
+        slot->printed = 1;
+        slot->suppressed = 0;
+        return true;
+    }
+
+    if (ts.tv_sec - slot->since >= IPX_VERB_RL_INTERVAL) {
+        // New interval
+        slot->since = ts.tv_sec;
+        slot->printed = 0;
+    }
+
+    if (slot->printed >= IPX_VERB_RL_BURST) {
+        slot->suppressed++;
+        return false;
+    }
+
+    slot->printed++;
+    *suppressed = slot->suppressed;
+    slot->suppressed = 0;
+    return true;
+}
+
+/**
+ * \brief Print the number of suppressed messages
+ * \param[in] level      Verbosity level of the messages
+ * \param[in] name       Identification of the origin
+ * \param[in] suppressed Number of suppressed messages
+ */
+static void
+verb_rl_notice(enum ipx_verb_level level, const char *name, uint64_t suppressed)
+{
+    static const char *fmt_pattern[] = {
+        [IPX_VERB_ERROR]   = "ERROR: %s: %" PRIu64 " similar messages have been suppressed\n",
+        [IPX_VERB_WARNING] = "WARNING: %s: %" PRIu64 " similar messages have been suppressed\n",
+        [IPX_VERB_INFO]    = "INFO: %s: %" PRIu64 " similar messages have been suppressed\n",
+        [IPX_VERB_DEBUG]   = "DEBUG: %s: %" PRIu64 " similar messages have been suppressed\n"
+    };
+
+    ipx_verb_print(level, fmt_pattern[level], name, suppressed);
+}
+
 void
 ipx_verb_ctx_print(enum ipx_verb_level level, const ipx_ctx_t *ctx, const char *fmt, ...)
 {
@@ -127,45 +521,53 @@ ipx_verb_ctx_print(enum ipx_verb_level level, const ipx_ctx_t *ctx, const char *
     const size_t fmt_size = 512;
     char fmt_buffer[fmt_size];
 
+    if (level <= IPX_VERB_WARNING) {
+        // Repeated errors and warnings (e.g. about each received message) can flood the output
+        uint64_t suppressed;
+        if (!verb_rl_allow(plugin, fmt, &suppressed)) {
+            return;
+        }
+        if (suppressed > 0) {
+            verb_rl_notice(level, plugin, suppressed);
+        }
+    }
+
     // Create a new format message
     int rv = snprintf(fmt_buffer, fmt_size, fmt_pattern[level], plugin, fmt);
     if (rv < 0 || ((size_t) rv) >= fmt_size) {
         // Error
-        printf(fmt_pattern[level], plugin, err_inter);
-    } else {
-        va_list ap;
-        va_start(ap, fmt);
-        vprintf(fmt_buffer, ap);
-        va_end(ap);
+        ipx_verb_print(level, fmt_pattern[level], plugin, err_inter);
+        return;
     }
 
-    if (use_syslog) {
-        int prio = ipx_verb_level2syslog(level);
-        if (rv < 0 || ((size_t) rv) >= fmt_size) {
-            // Error
-            syslog(prio, fmt_pattern[level], plugin, err_inter);
-        } else {
-            va_list ap;
-            va_start(ap, fmt);
-            vsyslog(prio, fmt_buffer, ap);
-            va_end(ap);
-        }
-    }
+    va_list ap;
+    va_start(ap, fmt);
+    verb_vprint(level, fmt_buffer, ap);
+    va_end(ap);
 }
 
 void
 ipx_verb_print(enum ipx_verb_level level, const char *fmt, ...)
 {
     va_list ap;
-
     va_start(ap, fmt);
-    vprintf(fmt, ap);
+    verb_vprint(level, fmt, ap);
     va_end(ap);
+}
 
-    if (use_syslog) {
-        int prio = ipx_verb_level2syslog(level);
-        va_start(ap, fmt);
-        vsyslog(prio, fmt, ap);
-        va_end(ap);
+void
+ipx_verb_print_rl(enum ipx_verb_level level, const char *name, const char *fmt, ...)
+{
+    uint64_t suppressed;
+    if (!verb_rl_allow(name, fmt, &suppressed)) {
+        return;
+    }
+    if (suppressed > 0) {
+        verb_rl_notice(level, name, suppressed);
     }
+
+    va_list ap;
+    va_start(ap, fmt);
+    verb_vprint(level, fmt, ap);
+    va_end(ap);
 }
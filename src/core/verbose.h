@@ -111,6 +111,25 @@ extern "C" {
 IPX_API void
 ipx_verb_syslog(bool enable);
 
+/**
+ * \brief Enable/disable the asynchronous logging backend
+ *
+ * If enabled, messages are formatted by the calling thread and stored into its lock-free queue.
+ * A single writer thread writes messages of all queues to the standard output (and the system
+ * log, if enabled). Therefore, threads are never blocked by the output. If a queue is full, new
+ * messages of the thread are dropped and their number is reported by the writer.
+ * \note Messages of different threads are not necessarily written in the chronological order.
+ * \warning If the backend is enabled, the process must not fork (e.g. daemonize) until it is
+ *   disabled again. Before it's disabled, all other threads that may print a message must be
+ *   terminated.
+ * \remark By default, the backend is disabled. Remaining messages are written when it's disabled.
+ * \param[in] enable Enable/disable
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_DENIED if the writer thread cannot be started
+ */
+IPX_API int
+ipx_verb_async(bool enable);
+
 /**
  * \brief Get default verbosity level of the collector
  * \return Current verbosity level
@@ -135,6 +154,28 @@ ipx_verb_level_set(enum ipx_verb_level level);
 IPX_API void
 ipx_verb_print(enum ipx_verb_level level, const char *fmt, ...);
 
+/** Maximum number of messages of the same origin printed within a rate limiting interval  */
+#define IPX_VERB_RL_BURST (10U)
+/** Length of the rate limiting interval (in seconds)                                       */
+#define IPX_VERB_RL_INTERVAL (5)
+
+/**
+ * \brief Internal rate-limited printing function
+ *
+ * Same as ipx_verb_print(), however, at most #IPX_VERB_RL_BURST messages of the same origin are
+ * printed within #IPX_VERB_RL_INTERVAL seconds. The origin is given by the \p name and the
+ * (address of the) format string, i.e. the place where the message is generated. Other messages
+ * are suppressed and only their number is reported before the next printed message.
+ * \note Up to 64 origins per thread are tracked. If an origin is replaced by another one, the
+ *   number of its suppressed messages is not reported.
+ * \param[in] level  Verbosity level of the message (for syslog severity)
+ * \param[in] name   Identification of the origin (e.g. name of a plugin instance)
+ * \param[in] fmt    Format string (see manual page for "printf" family)
+ * \param[in] ...    Variable number of arguments for the format string
+ */
+IPX_API void
+ipx_verb_print_rl(enum ipx_verb_level level, const char *name, const char *fmt, ...);
+
 /**@}*/
 #ifdef __cplusplus
 }
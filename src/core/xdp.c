@@ -0,0 +1,863 @@
+/**
+ * \file src/core/xdp.c
+ * \author agent <agent@local>
+ * \brief Zero-copy receiving of UDP datagrams based on AF_XDP (source file)
+ * \date 2026
+ */
+
+/* Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is'', and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#define _GNU_SOURCE
+#include <ipfixcol2.h>
+#include <build_config.h>
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef HAVE_AF_XDP
+#include <arpa/inet.h>
+#include <linux/bpf.h>
+#include <linux/if_ether.h>
+#include <linux/if_xdp.h>
+#include <net/if.h>
+#include <netinet/in.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#ifndef AF_XDP
+#define AF_XDP            (44)
+#endif
+#ifndef SOL_XDP
+#define SOL_XDP           (283)
+#endif
+
+/** Size of a frame of the shared memory (one frame per packet)                                  */
+#define XDP_FRAME_SIZE    (4096U)
+/** Identification of an empty list of released frames                                           */
+#define XDP_FRAME_NONE    (UINT32_MAX)
+/** Size of the completion ring (not used, but required by the kernel)                           */
+#define XDP_COMP_SIZE     (64U)
+/** Maximum number of instructions of the XDP program                                            */
+#define XDP_PROG_MAX      (64U)
+/** Maximum number of destination ports filtered by the XDP program                              */
+#define XDP_PORTS_MAX     (24U)
+/** Maximum number of attempts to bind a socket to a busy queue                                  */
+#define XDP_BIND_RETRY    (50U)
+/** Delay between attempts to bind a socket to a busy queue (in microseconds)                    */
+#define XDP_BIND_DELAY    (10000U)
+/** Length of an IPv4 header without options                                                     */
+#define XDP_IPV4_LEN      (20U)
+/** Length of an IPv6 header                                                                     */
+#define XDP_IPV6_LEN      (40U)
+/** Length of an UDP header                                                                      */
+#define XDP_UDP_LEN       (8U)
+
+/** Ring shared with the kernel                                                                  */
+struct xdp_ring {
+    /** Producer index                                                                           */
+    uint32_t *producer;
+    /** Consumer index                                                                           */
+    uint32_t *consumer;
+    /** Flags (e.g. XDP_RING_NEED_WAKEUP)                                                        */
+    uint32_t *flags;
+    /** Array of descriptors                                                                     */
+    void *descs;
+    /** Index mask                                                                               */
+    uint32_t mask;
+    /** Mapped memory                                                                            */
+    void *map;
+    /** Size of the mapped memory                                                                */
+    size_t map_size;
+};
+
+/** Receive queue of the interface                                                               */
+struct xdp_queue {
+    /** AF_XDP socket                                                                            */
+    int fd;
+    /** Shared memory of the queue (registered to the socket)                                    */
+    uint8_t *umem;
+    /** Fill ring (frames given to the kernel)                                                   */
+    struct xdp_ring fill;
+    /** Receive ring (frames with received packets)                                              */
+    struct xdp_ring rx;
+    /** Head of the list of released frames (filled by any thread, atomic)                       */
+    uint32_t released;
+};
+
+/** Internal structure of an instance                                                            */
+struct ipx_xdp {
+    /** Index of the interface                                                                   */
+    unsigned int ifindex;
+    /** Map of AF_XDP sockets (indexed by receive queues)                                        */
+    int map_fd;
+    /** XDP program                                                                              */
+    int prog_fd;
+    /** Attachment of the program to the interface                                               */
+    int link_fd;
+    /** Zero-copy mode                                                                           */
+    bool zerocopy;
+
+    /** Number of frames per queue                                                               */
+    uint32_t frames;
+    /** Shared memory of all queues                                                              */
+    uint8_t *mem;
+    /** Size of the shared memory                                                                */
+    size_t mem_size;
+    /** Next frame in a list of released frames (one per frame of the shared memory, atomic)     */
+    uint32_t *next;
+    /**
+     * Number of references (the instance and each payload not released yet, atomic). The shared
+     * memory is released by the last reference.
+     */
+    uint32_t refs;
+
+    /** Number of receive queues                                                                 */
+    unsigned int cnt;
+    /** Array of receive queues                                                                  */
+    struct xdp_queue *queues;
+};
+
+/**
+ * \brief Call the bpf() system call
+ * \param[in] cmd  Command
+ * \param[in] attr Attributes of the command
+ * \return Result of the system call
+ */
+static inline int
+xdp_bpf(int cmd, union bpf_attr *attr)
+{
+    return (int) syscall(__NR_bpf, cmd, attr, sizeof(*attr));
+}
+
+/**
+ * \brief Create an instruction of a BPF program
+ * \param[in] code Operation code
+ * \param[in] dst  Destination register
+ * \param[in] src  Source register
+ * \param[in] off  Offset
+ * \param[in] imm  Immediate value
+ * \return Instruction
+ */
+static inline struct bpf_insn
+xdp_insn(uint8_t code, uint8_t dst, uint8_t src, int16_t off, int32_t imm)
+{
+    struct bpf_insn insn;
+    memset(&insn, 0, sizeof(insn));
+    insn.code = code;
+    insn.dst_reg = dst;
+    insn.src_reg = src;
+    insn.off = off;
+    insn.imm = imm;
+    return insn;
+}
+
+/**
+ * \brief Load the XDP program
+ *
+ * The program redirects UDP datagrams with any of given destination ports to the AF_XDP socket
+ * of the receive queue (if there is any) and passes all other packets to the network stack.
+ * Fragmented IPv4 packets and IPv4 packets with options are also passed.
+ * \param[in] map_fd    Map of AF_XDP sockets
+ * \param[in] ports     Array of destination ports
+ * \param[in] ports_cnt Number of ports
+ * \return File descriptor of the program or -1 (errno is set)
+ */
+static int
+xdp_prog_load(int map_fd, const uint16_t *ports, size_t ports_cnt)
+{
+    struct bpf_insn prog[XDP_PROG_MAX];
+    unsigned int cnt = 0;
+    // Indexes of conditional jumps to the "pass" label (the offset is set later)
+    unsigned int to_pass[XDP_PROG_MAX];
+    unsigned int to_pass_cnt = 0;
+    const int32_t eth_len = ETH_HLEN;
+
+    if (ports_cnt == 0 || ports_cnt > XDP_PORTS_MAX) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    // r6 = ctx, r2 = data, r3 = data_end
+    prog[cnt++] = xdp_insn(BPF_ALU64 | BPF_MOV | BPF_X, BPF_REG_6, BPF_REG_1, 0, 0);
+    prog[cnt++] = xdp_insn(BPF_LDX | BPF_W | BPF_MEM, BPF_REG_2, BPF_REG_1,
+        offsetof(struct xdp_md, data), 0);
+    prog[cnt++] = xdp_insn(BPF_LDX | BPF_W | BPF_MEM, BPF_REG_3, BPF_REG_1,
+        offsetof(struct xdp_md, data_end), 0);
+    // Ethernet header: r5 = EtherType
+    prog[cnt++] = xdp_insn(BPF_ALU64 | BPF_MOV | BPF_X, BPF_REG_4, BPF_REG_2, 0, 0);
+    prog[cnt++] = xdp_insn(BPF_ALU64 | BPF_ADD | BPF_K, BPF_REG_4, 0, 0, eth_len);
+    to_pass[to_pass_cnt++] = cnt;
+    prog[cnt++] = xdp_insn(BPF_JMP | BPF_JGT | BPF_X, BPF_REG_4, BPF_REG_3, 0, 0);
+    prog[cnt++] = xdp_insn(BPF_LDX | BPF_H | BPF_MEM, BPF_REG_5, BPF_REG_2, 12, 0);
+    const unsigned int jmp_ipv4 = cnt;
+    prog[cnt++] = xdp_insn(BPF_JMP | BPF_JEQ | BPF_K, BPF_REG_5, 0, 0, htons(ETH_P_IP));
+    to_pass[to_pass_cnt++] = cnt;
+    prog[cnt++] = xdp_insn(BPF_JMP | BPF_JNE | BPF_K, BPF_REG_5, 0, 0, htons(ETH_P_IPV6));
+
+    // IPv6: r5 = destination port
+    prog[cnt++] = xdp_insn(BPF_ALU64 | BPF_MOV | BPF_X, BPF_REG_4, BPF_REG_2, 0, 0);
+    prog[cnt++] = xdp_insn(BPF_ALU64 | BPF_ADD | BPF_K, BPF_REG_4, 0, 0,
+        eth_len + XDP_IPV6_LEN + XDP_UDP_LEN);
+    to_pass[to_pass_cnt++] = cnt;
+    prog[cnt++] = xdp_insn(BPF_JMP | BPF_JGT | BPF_X, BPF_REG_4, BPF_REG_3, 0, 0);
+    prog[cnt++] = xdp_insn(BPF_LDX | BPF_B | BPF_MEM, BPF_REG_5, BPF_REG_2, eth_len + 6, 0);
+    to_pass[to_pass_cnt++] = cnt;
+    prog[cnt++] = xdp_insn(BPF_JMP | BPF_JNE | BPF_K, BPF_REG_5, 0, 0, IPPROTO_UDP);
+    prog[cnt++] = xdp_insn(BPF_LDX | BPF_H | BPF_MEM, BPF_REG_5, BPF_REG_2,
+        eth_len + XDP_IPV6_LEN + 2, 0);
+    const unsigned int jmp_ports = cnt;
+    prog[cnt++] = xdp_insn(BPF_JMP | BPF_JA, 0, 0, 0, 0);
+
+    // IPv4 (without options): r5 = destination port
+    prog[jmp_ipv4].off = (int16_t) (cnt - jmp_ipv4 - 1);
+    prog[cnt++] = xdp_insn(BPF_ALU64 | BPF_MOV | BPF_X, BPF_REG_4, BPF_REG_2, 0, 0);
+    prog[cnt++] = xdp_insn(BPF_ALU64 | BPF_ADD | BPF_K, BPF_REG_4, 0, 0,
+        eth_len + XDP_IPV4_LEN + XDP_UDP_LEN);
+    to_pass[to_pass_cnt++] = cnt;
+    prog[cnt++] = xdp_insn(BPF_JMP | BPF_JGT | BPF_X, BPF_REG_4, BPF_REG_3, 0, 0);
+    prog[cnt++] = xdp_insn(BPF_LDX | BPF_B | BPF_MEM, BPF_REG_5, BPF_REG_2, eth_len, 0);
+    to_pass[to_pass_cnt++] = cnt;
+    prog[cnt++] = xdp_insn(BPF_JMP | BPF_JNE | BPF_K, BPF_REG_5, 0, 0, 0x45);
+    prog[cnt++] = xdp_insn(BPF_LDX | BPF_B | BPF_MEM, BPF_REG_5, BPF_REG_2, eth_len + 9, 0);
+    to_pass[to_pass_cnt++] = cnt;
+    prog[cnt++] = xdp_insn(BPF_JMP | BPF_JNE | BPF_K, BPF_REG_5, 0, 0, IPPROTO_UDP);
+    prog[cnt++] = xdp_insn(BPF_LDX | BPF_H | BPF_MEM, BPF_REG_5, BPF_REG_2, eth_len + 6, 0);
+    prog[cnt++] = xdp_insn(BPF_ALU64 | BPF_AND | BPF_K, BPF_REG_5, 0, 0, htons(0x3FFF));
+    to_pass[to_pass_cnt++] = cnt;
+    prog[cnt++] = xdp_insn(BPF_JMP | BPF_JNE | BPF_K, BPF_REG_5, 0, 0, 0); // Fragment
+    prog[cnt++] = xdp_insn(BPF_LDX | BPF_H | BPF_MEM, BPF_REG_5, BPF_REG_2,
+        eth_len + XDP_IPV4_LEN + 2, 0);
+
+    // Compare the destination port
+    prog[jmp_ports].off = (int16_t) (cnt - jmp_ports - 1);
+    for (size_t i = 0; i < ports_cnt; ++i) {
+        // Jump over the remaining comparisons and the jump to the "pass" label
+        const int16_t off = (int16_t) (ports_cnt - i);
+        prog[cnt++] = xdp_insn(BPF_JMP | BPF_JEQ | BPF_K, BPF_REG_5, 0, off, htons(ports[i]));
+    }
+    to_pass[to_pass_cnt++] = cnt;
+    prog[cnt++] = xdp_insn(BPF_JMP | BPF_JA, 0, 0, 0, 0);
+
+    // Redirect to the socket of the receive queue (if not defined, pass the packet)
+    prog[cnt++] = xdp_insn(BPF_LDX | BPF_W | BPF_MEM, BPF_REG_2, BPF_REG_6,
+        offsetof(struct xdp_md, rx_queue_index), 0);
+    prog[cnt++] = xdp_insn(BPF_LD | BPF_DW | BPF_IMM, BPF_REG_1, BPF_PSEUDO_MAP_FD, 0, map_fd);
+    prog[cnt++] = xdp_insn(0, 0, 0, 0, 0);
+    prog[cnt++] = xdp_insn(BPF_ALU64 | BPF_MOV | BPF_K, BPF_REG_3, 0, 0, XDP_PASS);
+    prog[cnt++] = xdp_insn(BPF_JMP | BPF_CALL, 0, 0, 0, BPF_FUNC_redirect_map);
+    prog[cnt++] = xdp_insn(BPF_JMP | BPF_EXIT, 0, 0, 0, 0);
+
+    // The "pass" label
+    for (unsigned int i = 0; i < to_pass_cnt; ++i) {
+        prog[to_pass[i]].off = (int16_t) (cnt - to_pass[i] - 1);
+    }
+    prog[cnt++] = xdp_insn(BPF_ALU64 | BPF_MOV | BPF_K, BPF_REG_0, 0, 0, XDP_PASS);
+    prog[cnt++] = xdp_insn(BPF_JMP | BPF_EXIT, 0, 0, 0, 0);
+
+    union bpf_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.prog_type = BPF_PROG_TYPE_XDP;
+    attr.insns = (uintptr_t) prog;
+    attr.insn_cnt = cnt;
+    attr.license = (uintptr_t) "Dual BSD/GPL";
+    return xdp_bpf(BPF_PROG_LOAD, &attr);
+}
+
+/**
+ * \brief Map a ring shared with the kernel
+ * \param[out] ring      Ring
+ * \param[in]  fd        AF_XDP socket
+ * \param[in]  off       Offsets of the ring
+ * \param[in]  size      Number of descriptors
+ * \param[in]  desc_size Size of a descriptor
+ * \param[in]  pgoff     Page offset of the ring
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_DENIED on failure (errno is set)
+ */
+static int
+xdp_ring_map(struct xdp_ring *ring, int fd, const struct xdp_ring_offset *off, uint32_t size,
+    size_t desc_size, off_t pgoff)
+{
+    ring->map_size = off->desc + size * desc_size;
+    ring->map = mmap(NULL, ring->map_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+        fd, pgoff);
+    if (ring->map == MAP_FAILED) {
+        ring->map = NULL;
+        return IPX_ERR_DENIED;
+    }
+
+    uint8_t *ptr = ring->map;
+    ring->producer = (uint32_t *) (ptr + off->producer);
+    ring->consumer = (uint32_t *) (ptr + off->consumer);
+    ring->flags = (uint32_t *) (ptr + off->flags);
+    ring->descs = ptr + off->desc;
+    ring->mask = size - 1;
+    return IPX_OK;
+}
+
+/**
+ * \brief Unmap a ring shared with the kernel
+ * \param[in] ring Ring
+ */
+static void
+xdp_ring_unmap(struct xdp_ring *ring)
+{
+    if (ring->map != NULL) {
+        munmap(ring->map, ring->map_size);
+        ring->map = NULL;
+    }
+}
+
+/**
+ * \brief Give frames of released payloads of a queue back to the kernel
+ * \param[in] xdp   Instance
+ * \param[in] queue Receive queue
+ */
+static void
+xdp_queue_refill(ipx_xdp_t *xdp, struct xdp_queue *queue)
+{
+    // Take all released frames at once (no ABA problem as frames are never taken one by one)
+    uint32_t idx = __atomic_exchange_n(&queue->released, XDP_FRAME_NONE, __ATOMIC_ACQUIRE);
+    if (idx == XDP_FRAME_NONE) {
+        return;
+    }
+
+    const uint32_t first = (uint32_t) ((queue->umem - xdp->mem) / XDP_FRAME_SIZE);
+    uint64_t *descs = queue->fill.descs;
+    uint32_t prod = *queue->fill.producer;
+
+    // The fill ring is large enough for all frames of the queue
+    while (idx != XDP_FRAME_NONE) {
+        descs[prod++ & queue->fill.mask] = (uint64_t) (idx - first) * XDP_FRAME_SIZE;
+        idx = __atomic_load_n(&xdp->next[idx], __ATOMIC_RELAXED);
+    }
+
+    __atomic_store_n(queue->fill.producer, prod, __ATOMIC_RELEASE);
+}
+
+/**
+ * \brief Release the shared memory (called by the last reference)
+ * \param[in] xdp Instance
+ */
+static void
+xdp_free(ipx_xdp_t *xdp)
+{
+    ipx_utils_buf_region_remove(xdp->mem);
+    munmap(xdp->mem, xdp->mem_size);
+    free(xdp->next);
+    free(xdp->queues);
+    free(xdp);
+}
+
+/**
+ * \brief Release a payload of a received datagram (see ipx_utils_buf_region_add())
+ *
+ * The frame is added to the list of released frames of its queue and given back to the kernel
+ * by the plugin thread (the fill ring has only one producer).
+ * \param[in] ptr Pointer to the payload
+ * \param[in] arg Instance
+ */
+static void
+xdp_frame_release(void *ptr, void *arg)
+{
+    ipx_xdp_t *xdp = arg;
+    const uint32_t idx = (uint32_t) (((uint8_t *) ptr - xdp->mem) / XDP_FRAME_SIZE);
+    struct xdp_queue *queue = &xdp->queues[idx / xdp->frames];
+
+    uint32_t head = __atomic_load_n(&queue->released, __ATOMIC_RELAXED);
+    do {
+        __atomic_store_n(&xdp->next[idx], head, __ATOMIC_RELAXED);
+    } while (!__atomic_compare_exchange_n(&queue->released, &head, idx, true,
+        __ATOMIC_RELEASE, __ATOMIC_RELAXED));
+
+    // The instance could have been already destroyed (the last reference releases the memory)
+    if (__atomic_sub_fetch(&xdp->refs, 1U, __ATOMIC_ACQ_REL) == 0) {
+        xdp_free(xdp);
+    }
+}
+
+/**
+ * \brief Give a frame back to the kernel immediately (only the plugin thread)
+ * \param[in] queue Receive queue
+ * \param[in] addr  Address of the frame (relative to the shared memory of the queue)
+ */
+static inline void
+xdp_fill_put(struct xdp_queue *queue, uint64_t addr)
+{
+    uint64_t *descs = queue->fill.descs;
+    uint32_t prod = *queue->fill.producer;
+    descs[prod & queue->fill.mask] = addr - (addr % XDP_FRAME_SIZE);
+    __atomic_store_n(queue->fill.producer, prod + 1, __ATOMIC_RELEASE);
+}
+
+/**
+ * \brief Parse a received packet
+ *
+ * The packet is expected to be an Ethernet frame with an IPv4 or IPv6 packet with an UDP
+ * datagram (guaranteed by the XDP program).
+ * \param[in]  frame Start of the packet
+ * \param[in]  len   Length of the packet
+ * \param[out] pkt   Description of the datagram
+ * \return True on success
+ * \return False if the packet is malformed
+ */
+static bool
+xdp_pkt_parse(uint8_t *frame, uint32_t len, struct ipx_xdp_packet *pkt)
+{
+    if (len < ETH_HLEN) {
+        return false;
+    }
+
+    uint16_t eth_type;
+    memcpy(&eth_type, &frame[12], sizeof(eth_type));
+    uint8_t *l3 = &frame[ETH_HLEN];
+    const size_t l3_len = len - ETH_HLEN;
+    size_t hdr_len;
+
+    memset(&pkt->src, 0, sizeof(pkt->src));
+    memset(&pkt->dst, 0, sizeof(pkt->dst));
+
+    if (eth_type == htons(ETH_P_IP)) {
+        hdr_len = (l3_len > 0) ? (size_t) (l3[0] & 0x0F) * 4U : 0;
+        if (hdr_len < XDP_IPV4_LEN || l3_len < hdr_len + XDP_UDP_LEN || l3[9] != IPPROTO_UDP) {
+            return false;
+        }
+
+        struct sockaddr_in *src = (struct sockaddr_in *) &pkt->src;
+        struct sockaddr_in *dst = (struct sockaddr_in *) &pkt->dst;
+        src->sin_family = AF_INET;
+        dst->sin_family = AF_INET;
+        memcpy(&src->sin_addr, &l3[12], sizeof(src->sin_addr));
+        memcpy(&dst->sin_addr, &l3[16], sizeof(dst->sin_addr));
+        memcpy(&src->sin_port, &l3[hdr_len], sizeof(src->sin_port));
+        memcpy(&dst->sin_port, &l3[hdr_len + 2], sizeof(dst->sin_port));
+    } else if (eth_type == htons(ETH_P_IPV6)) {
+        hdr_len = XDP_IPV6_LEN;
+        if (l3_len < hdr_len + XDP_UDP_LEN || l3[6] != IPPROTO_UDP) {
+            return false;
+        }
+
+        struct sockaddr_in6 *src = (struct sockaddr_in6 *) &pkt->src;
+        struct sockaddr_in6 *dst = (struct sockaddr_in6 *) &pkt->dst;
+        src->sin6_family = AF_INET6;
+        dst->sin6_family = AF_INET6;
+        memcpy(&src->sin6_addr, &l3[8], sizeof(src->sin6_addr));
+        memcpy(&dst->sin6_addr, &l3[24], sizeof(dst->sin6_addr));
+        memcpy(&src->sin6_port, &l3[hdr_len], sizeof(src->sin6_port));
+        memcpy(&dst->sin6_port, &l3[hdr_len + 2], sizeof(dst->sin6_port));
+    } else {
+        return false;
+    }
+
+    // The length of the datagram (the Ethernet frame can be padded)
+    uint16_t udp_len;
+    memcpy(&udp_len, &l3[hdr_len + 4], sizeof(udp_len));
+    udp_len = ntohs(udp_len);
+    if (udp_len < XDP_UDP_LEN || udp_len > l3_len - hdr_len) {
+        return false;
+    }
+
+    pkt->data = &l3[hdr_len + XDP_UDP_LEN];
+    pkt->size = udp_len - XDP_UDP_LEN;
+    return true;
+}
+
+/**
+ * \brief Bind an AF_XDP socket to a receive queue
+ *
+ * The kernel releases a previous socket of the queue asynchronously, therefore, the queue can
+ * be busy for a while after the socket is closed (e.g. the collector is restarted).
+ * \param[in] xdp   Instance
+ * \param[in] fd    AF_XDP socket
+ * \param[in] id    Index of the receive queue
+ * \param[in] mode  XDP_ZEROCOPY or XDP_COPY
+ * \return Same as bind()
+ */
+static int
+xdp_queue_bind(const ipx_xdp_t *xdp, int fd, unsigned int id, uint16_t mode)
+{
+    struct sockaddr_xdp addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sxdp_family = AF_XDP;
+    addr.sxdp_ifindex = xdp->ifindex;
+    addr.sxdp_queue_id = id;
+    addr.sxdp_flags = mode | XDP_USE_NEED_WAKEUP;
+
+    int ret;
+    for (unsigned int i = 0; i < XDP_BIND_RETRY; ++i) {
+        ret = bind(fd, (struct sockaddr *) &addr, sizeof(addr));
+        if (ret == 0 || errno != EBUSY) {
+            break;
+        }
+        usleep(XDP_BIND_DELAY);
+    }
+
+    return ret;
+}
+
+/**
+ * \brief Create an AF_XDP socket of a receive queue and give all its frames to the kernel
+ * \param[in] xdp Instance
+ * \param[in] id  Index of the receive queue
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_DENIED on failure (errno is set)
+ */
+static int
+xdp_queue_init(ipx_xdp_t *xdp, unsigned int id)
+{
+    struct xdp_queue *queue = &xdp->queues[id];
+    const size_t umem_size = (size_t) xdp->frames * XDP_FRAME_SIZE;
+    queue->umem = xdp->mem + id * umem_size;
+    queue->released = XDP_FRAME_NONE;
+    queue->fd = socket(AF_XDP, SOCK_RAW, 0);
+    if (queue->fd < 0) {
+        return IPX_ERR_DENIED;
+    }
+
+    struct xdp_umem_reg reg;
+    memset(&reg, 0, sizeof(reg));
+    reg.addr = (uintptr_t) queue->umem;
+    reg.len = umem_size;
+    reg.chunk_size = XDP_FRAME_SIZE;
+    reg.headroom = 0;
+
+    const uint32_t ring_size = xdp->frames;
+    const uint32_t comp_size = XDP_COMP_SIZE;
+    struct xdp_mmap_offsets off;
+    socklen_t off_len = sizeof(off);
+
+    if (setsockopt(queue->fd, SOL_XDP, XDP_UMEM_REG, &reg, sizeof(reg)) != 0
+            || setsockopt(queue->fd, SOL_XDP, XDP_UMEM_FILL_RING, &ring_size, sizeof(ring_size))
+            || setsockopt(queue->fd, SOL_XDP, XDP_UMEM_COMPLETION_RING, &comp_size,
+                sizeof(comp_size))
+            || setsockopt(queue->fd, SOL_XDP, XDP_RX_RING, &ring_size, sizeof(ring_size))
+            || getsockopt(queue->fd, SOL_XDP, XDP_MMAP_OFFSETS, &off, &off_len) != 0
+            || xdp_ring_map(&queue->fill, queue->fd, &off.fr, ring_size, sizeof(uint64_t),
+                XDP_UMEM_PGOFF_FILL_RING) != IPX_OK
+            || xdp_ring_map(&queue->rx, queue->fd, &off.rx, ring_size, sizeof(struct xdp_desc),
+                XDP_PGOFF_RX_RING) != IPX_OK) {
+        goto error;
+    }
+
+    // Give all frames to the kernel (the completion ring isn't used as nothing is transmitted)
+    uint64_t *descs = queue->fill.descs;
+    uint32_t prod = *queue->fill.producer;
+    for (uint32_t i = 0; i < xdp->frames; ++i) {
+        descs[prod++ & queue->fill.mask] = (uint64_t) i * XDP_FRAME_SIZE;
+    }
+    __atomic_store_n(queue->fill.producer, prod, __ATOMIC_RELEASE);
+
+    // Prefer zero-copy mode
+    if (xdp_queue_bind(xdp, queue->fd, id, XDP_ZEROCOPY) != 0) {
+        if (xdp_queue_bind(xdp, queue->fd, id, XDP_COPY) != 0) {
+            goto error;
+        }
+        xdp->zerocopy = false;
+    }
+
+    // Register the socket, so the XDP program can redirect packets to it
+    union bpf_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.map_fd = (uint32_t) xdp->map_fd;
+    attr.key = (uintptr_t) &id;
+    attr.value = (uintptr_t) &queue->fd;
+    attr.flags = BPF_ANY;
+    if (xdp_bpf(BPF_MAP_UPDATE_ELEM, &attr) != 0) {
+        goto error;
+    }
+
+    return IPX_OK;
+
+error:
+    {
+        int err = errno;
+        xdp_ring_unmap(&queue->rx);
+        xdp_ring_unmap(&queue->fill);
+        close(queue->fd);
+        queue->fd = -1;
+        errno = err;
+    }
+    return IPX_ERR_DENIED;
+}
+
+/**
+ * \brief Detach the XDP program and close all sockets of an instance
+ * \note The shared memory is left untouched.
+ * \param[in] xdp Instance
+ */
+static void
+xdp_close(ipx_xdp_t *xdp)
+{
+    // Detach the program first, so packets are not redirected anymore
+    if (xdp->link_fd >= 0) {
+        close(xdp->link_fd);
+    }
+    if (xdp->prog_fd >= 0) {
+        close(xdp->prog_fd);
+    }
+
+    for (unsigned int i = 0; i < xdp->cnt; ++i) {
+        struct xdp_queue *queue = &xdp->queues[i];
+        xdp_ring_unmap(&queue->rx);
+        xdp_ring_unmap(&queue->fill);
+        close(queue->fd);
+        queue->fd = -1;
+    }
+
+    if (xdp->map_fd >= 0) {
+        close(xdp->map_fd);
+    }
+
+    xdp->link_fd = xdp->prog_fd = xdp->map_fd = -1;
+    xdp->cnt = 0;
+}
+
+bool
+ipx_xdp_supported()
+{
+    return true;
+}
+
+ipx_xdp_t *
+ipx_xdp_create(const char *ifname, unsigned int queues, const uint16_t *ports, size_t ports_cnt,
+    unsigned int frames)
+{
+    if (ifname == NULL || queues == 0 || ports == NULL || ports_cnt == 0
+            || ports_cnt > XDP_PORTS_MAX || frames == 0 || frames > (1U << 20)) {
+        errno = EINVAL;
+        return NULL;
+    }
+
+    const unsigned int ifindex = if_nametoindex(ifname);
+    if (ifindex == 0) {
+        return NULL;
+    }
+
+    uint32_t frames_pow2 = 1;
+    while (frames_pow2 < frames) {
+        frames_pow2 <<= 1;
+    }
+
+    const size_t frames_total = (size_t) queues * frames_pow2;
+    ipx_xdp_t *xdp = calloc(1, sizeof(*xdp));
+    if (!xdp) {
+        return NULL;
+    }
+
+    xdp->ifindex = ifindex;
+    xdp->map_fd = xdp->prog_fd = xdp->link_fd = -1;
+    xdp->zerocopy = true;
+    xdp->frames = frames_pow2;
+    xdp->refs = 1;
+    xdp->mem_size = frames_total * XDP_FRAME_SIZE;
+    xdp->mem = mmap(NULL, xdp->mem_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS,
+        -1, 0);
+    xdp->next = malloc(frames_total * sizeof(*xdp->next));
+    xdp->queues = calloc(queues, sizeof(*xdp->queues));
+    if (xdp->mem == MAP_FAILED || !xdp->next || !xdp->queues) {
+        int err = (xdp->mem == MAP_FAILED) ? errno : ENOMEM;
+        if (xdp->mem != MAP_FAILED) {
+            munmap(xdp->mem, xdp->mem_size);
+        }
+        free(xdp->next);
+        free(xdp->queues);
+        free(xdp);
+        errno = err;
+        return NULL;
+    }
+
+    // Map of sockets and the program
+    union bpf_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.map_type = BPF_MAP_TYPE_XSKMAP;
+    attr.key_size = sizeof(uint32_t);
+    attr.value_size = sizeof(int);
+    attr.max_entries = queues;
+    xdp->map_fd = xdp_bpf(BPF_MAP_CREATE, &attr);
+    if (xdp->map_fd < 0 || (xdp->prog_fd = xdp_prog_load(xdp->map_fd, ports, ports_cnt)) < 0) {
+        goto error;
+    }
+
+    for (unsigned int i = 0; i < queues; ++i) {
+        if (xdp_queue_init(xdp, i) != IPX_OK) {
+            goto error;
+        }
+        xdp->cnt++;
+    }
+
+    if (ipx_utils_buf_region_add(xdp->mem, xdp->mem_size, &xdp_frame_release, xdp) != IPX_OK) {
+        errno = ENOSPC;
+        goto error;
+    }
+
+    // Attach the program to the interface (the driver mode is preferred by the kernel)
+    memset(&attr, 0, sizeof(attr));
+    attr.link_create.prog_fd = (uint32_t) xdp->prog_fd;
+    attr.link_create.target_ifindex = ifindex;
+    attr.link_create.attach_type = BPF_XDP;
+    xdp->link_fd = xdp_bpf(BPF_LINK_CREATE, &attr);
+    if (xdp->link_fd < 0) {
+        goto error;
+    }
+
+    return xdp;
+
+error:
+    {
+        int err = errno;
+        xdp_close(xdp);
+        xdp_free(xdp);
+        errno = err;
+    }
+    return NULL;
+}
+
+void
+ipx_xdp_destroy(ipx_xdp_t *xdp)
+{
+    if (!xdp) {
+        return;
+    }
+
+    xdp_close(xdp);
+    if (__atomic_sub_fetch(&xdp->refs, 1U, __ATOMIC_ACQ_REL) == 0) {
+        xdp_free(xdp);
+    }
+}
+
+bool
+ipx_xdp_zerocopy(const ipx_xdp_t *xdp)
+{
+    return xdp->zerocopy;
+}
+
+int
+ipx_xdp_fd(const ipx_xdp_t *xdp, unsigned int queue)
+{
+    return (queue < xdp->cnt) ? xdp->queues[queue].fd : -1;
+}
+
+unsigned int
+ipx_xdp_recv(ipx_xdp_t *xdp, unsigned int queue_id, struct ipx_xdp_packet *pkts, unsigned int max)
+{
+    if (queue_id >= xdp->cnt) {
+        return 0;
+    }
+
+    struct xdp_queue *queue = &xdp->queues[queue_id];
+    xdp_queue_refill(xdp, queue);
+
+    const struct xdp_desc *descs = queue->rx.descs;
+    uint32_t cons = *queue->rx.consumer;
+    const uint32_t prod = __atomic_load_n(queue->rx.producer, __ATOMIC_ACQUIRE);
+    unsigned int cnt = 0;
+
+    while (cons != prod && cnt < max) {
+        const struct xdp_desc *desc = &descs[cons++ & queue->rx.mask];
+        if (!xdp_pkt_parse(queue->umem + desc->addr, desc->len, &pkts[cnt])) {
+            // Malformed packet
+            xdp_fill_put(queue, desc->addr);
+            continue;
+        }
+        cnt++;
+    }
+
+    __atomic_store_n(queue->rx.consumer, cons, __ATOMIC_RELEASE);
+    // Each payload holds a reference until it's released
+    __atomic_add_fetch(&xdp->refs, cnt, __ATOMIC_RELAXED);
+
+    // The kernel stops receiving, if it runs out of free frames, and must be woken up
+    if ((__atomic_load_n(queue->fill.flags, __ATOMIC_RELAXED) & XDP_RING_NEED_WAKEUP) != 0) {
+        recvfrom(queue->fd, NULL, 0, MSG_DONTWAIT, NULL, NULL);
+    }
+
+    return cnt;
+}
+
+#else
+/* The collector has been built without AF_XDP support */
+
+bool
+ipx_xdp_supported()
+{
+    return false;
+}
+
+ipx_xdp_t *
+ipx_xdp_create(const char *ifname, unsigned int queues, const uint16_t *ports, size_t ports_cnt,
+    unsigned int frames)
+{
+    (void) ifname;
+    (void) queues;
+    (void) ports;
+    (void) ports_cnt;
+    (void) frames;
+    errno = ENOSYS;
+    return NULL;
+}
+
+void
+ipx_xdp_destroy(ipx_xdp_t *xdp)
+{
+    (void) xdp;
+}
+
+bool
+ipx_xdp_zerocopy(const ipx_xdp_t *xdp)
+{
+    (void) xdp;
+    return false;
+}
+
+int
+ipx_xdp_fd(const ipx_xdp_t *xdp, unsigned int queue)
+{
+    (void) xdp;
+    (void) queue;
+    return -1;
+}
+
+unsigned int
+ipx_xdp_recv(ipx_xdp_t *xdp, unsigned int queue, struct ipx_xdp_packet *pkts, unsigned int max)
+{
+    (void) xdp;
+    (void) queue;
+    (void) pkts;
+    (void) max;
+    return 0;
+}
+
+#endif // HAVE_AF_XDP
@@ -43,24 +43,53 @@
 #include <limits.h>
 #include "config.h"
 
+/** Maximal number of records per message (IPv6 records must fit into 65535 bytes) */
+#define GEN_RECORDS_MAX 900
+/** Maximal number of Transport Sessions and ODIDs per Transport Session            */
+#define GEN_STREAMS_MAX 1024
+
 /*
  * <params>
  *  <odid>...</odid>            <!-- optional        -->
- *  <delay>...</delay>          <!-- in microseconds -->
+ *  <delay>...</delay>          <!-- optional, in microseconds -->
+ *  <rate>...</rate>            <!-- optional, messages per second -->
+ *  <records>...</records>      <!-- optional, records per message -->
+ *  <sessions>...</sessions>    <!-- optional        -->
+ *  <odids>...</odids>          <!-- optional        -->
+ *  <mixIPv4>...</mixIPv4>      <!-- optional        -->
+ *  <mixIPv6>...</mixIPv6>      <!-- optional        -->
+ *  <cardAddr>...</cardAddr>    <!-- optional        -->
+ *  <cardPort>...</cardPort>    <!-- optional        -->
  * </params>
  */
 
 /** XML nodes */
 enum params_xml_nodes {
     NODE_ODID = 1,
-    NODE_DELAY
+    NODE_DELAY,
+    NODE_RATE,
+    NODE_RECORDS,
+    NODE_SESSIONS,
+    NODE_ODIDS,
+    NODE_MIX_IPV4,
+    NODE_MIX_IPV6,
+    NODE_CARD_ADDR,
+    NODE_CARD_PORT
 };
 
 /** Definition of the \<params\> node  */
 static const struct fds_xml_args args_params[] = {
     FDS_OPTS_ROOT("params"),
-    FDS_OPTS_ELEM(NODE_ODID,  "odid",  FDS_OPTS_T_UINT, FDS_OPTS_P_OPT),
-    FDS_OPTS_ELEM(NODE_DELAY, "delay", FDS_OPTS_T_UINT, 0),
+    FDS_OPTS_ELEM(NODE_ODID,      "odid",     FDS_OPTS_T_UINT, FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM(NODE_DELAY,     "delay",    FDS_OPTS_T_UINT, FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM(NODE_RATE,      "rate",     FDS_OPTS_T_UINT, FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM(NODE_RECORDS,   "records",  FDS_OPTS_T_UINT, FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM(NODE_SESSIONS,  "sessions", FDS_OPTS_T_UINT, FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM(NODE_ODIDS,     "odids",    FDS_OPTS_T_UINT, FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM(NODE_MIX_IPV4,  "mixIPv4",  FDS_OPTS_T_UINT, FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM(NODE_MIX_IPV6,  "mixIPv6",  FDS_OPTS_T_UINT, FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM(NODE_CARD_ADDR, "cardAddr", FDS_OPTS_T_UINT, FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM(NODE_CARD_PORT, "cardPort", FDS_OPTS_T_UINT, FDS_OPTS_P_OPT),
     FDS_OPTS_END
 };
 
@@ -93,12 +122,82 @@ config_parser_root(ipx_ctx_t *ctx, fds_xml_ctx_t *root, struct instance_config *
             cfg->sleep_time.tv_nsec = (content->val_uint % 1000000LL) * 1000LL;
             cfg->sleep_time.tv_sec  = content->val_uint / 1000000LL;
             break;
+        case NODE_RATE:
+            // Messages per second
+            assert(content->type == FDS_OPTS_T_UINT);
+            cfg->rate = content->val_uint;
+            break;
+        case NODE_RECORDS:
+            // Data Records per message
+            assert(content->type == FDS_OPTS_T_UINT);
+            if (content->val_uint > GEN_RECORDS_MAX) {
+                IPX_CTX_ERROR(ctx, "The number of records per message must be between 0 .. %d",
+                    GEN_RECORDS_MAX);
+                return IPX_ERR_FORMAT;
+            }
+            cfg->gen_records = (uint16_t) content->val_uint;
+            break;
+        case NODE_SESSIONS:
+        case NODE_ODIDS:
+            // Number of Transport Sessions and ODIDs per Transport Session
+            assert(content->type == FDS_OPTS_T_UINT);
+            if (content->val_uint == 0 || content->val_uint > GEN_STREAMS_MAX) {
+                IPX_CTX_ERROR(ctx, "The number of sessions/ODIDs must be between 1 .. %d",
+                    GEN_STREAMS_MAX);
+                return IPX_ERR_FORMAT;
+            }
+            if (content->id == NODE_SESSIONS) {
+                cfg->gen_sessions = (uint32_t) content->val_uint;
+            } else {
+                cfg->gen_odids = (uint32_t) content->val_uint;
+            }
+            break;
+        case NODE_MIX_IPV4:
+        case NODE_MIX_IPV6:
+            // Weights of Templates
+            assert(content->type == FDS_OPTS_T_UINT);
+            if (content->val_uint > UINT16_MAX) {
+                IPX_CTX_ERROR(ctx, "The weight of a Template must be between 0 .. %d",
+                    UINT16_MAX);
+                return IPX_ERR_FORMAT;
+            }
+            if (content->id == NODE_MIX_IPV4) {
+                cfg->gen_mix_ipv4 = (uint32_t) content->val_uint;
+            } else {
+                cfg->gen_mix_ipv6 = (uint32_t) content->val_uint;
+            }
+            break;
+        case NODE_CARD_ADDR:
+            // Number of different IP addresses
+            assert(content->type == FDS_OPTS_T_UINT);
+            if (content->val_uint == 0 || content->val_uint > 0x00FFFFFEU) {
+                IPX_CTX_ERROR(ctx, "The number of addresses must be between 1 .. %d",
+                    0x00FFFFFE);
+                return IPX_ERR_FORMAT;
+            }
+            cfg->gen_card_addr = (uint32_t) content->val_uint;
+            break;
+        case NODE_CARD_PORT:
+            // Number of different ports
+            assert(content->type == FDS_OPTS_T_UINT);
+            if (content->val_uint == 0 || content->val_uint > UINT16_MAX - 1024U) {
+                IPX_CTX_ERROR(ctx, "The number of ports must be between 1 .. %d",
+                    UINT16_MAX - 1024);
+                return IPX_ERR_FORMAT;
+            }
+            cfg->gen_card_port = (uint16_t) content->val_uint;
+            break;
         default:
             // Internal error
             assert(false);
         }
     }
 
+    if (cfg->gen_records > 0 && cfg->gen_mix_ipv4 == 0 && cfg->gen_mix_ipv6 == 0) {
+        IPX_CTX_ERROR(ctx, "At least one Template must have a non-zero weight!", '\0');
+        return IPX_ERR_FORMAT;
+    }
+
     return IPX_OK;
 }
 
@@ -112,6 +211,15 @@ config_default_set(struct instance_config *cfg)
     cfg->sleep_time.tv_sec = 0;
     cfg->sleep_time.tv_nsec = 100000000LL; // 100ms between messages
     cfg->odid = 1;
+    cfg->rate = 0;
+
+    cfg->gen_records = 0; // i.e. empty messages
+    cfg->gen_sessions = 1;
+    cfg->gen_odids = 1;
+    cfg->gen_mix_ipv4 = 1;
+    cfg->gen_mix_ipv6 = 0;
+    cfg->gen_card_addr = 65536;
+    cfg->gen_card_port = 1024;
 }
 
 struct instance_config *
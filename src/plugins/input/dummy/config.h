@@ -51,6 +51,23 @@ struct instance_config {
     uint32_t odid;
     /** Sleep time                                       */
     struct timespec sleep_time;
+    /** Messages per second (0 == use the sleep time)    */
+    uint64_t rate;
+
+    /** Number of Data Records per message (0 == generate empty messages) */
+    uint16_t gen_records;
+    /** Number of Transport Sessions                     */
+    uint32_t gen_sessions;
+    /** Number of ODIDs per Transport Session            */
+    uint32_t gen_odids;
+    /** Weight of the IPv4 Template in the mix           */
+    uint32_t gen_mix_ipv4;
+    /** Weight of the IPv6 Template in the mix           */
+    uint32_t gen_mix_ipv6;
+    /** Number of different IP addresses                 */
+    uint32_t gen_card_addr;
+    /** Number of different ports                        */
+    uint16_t gen_card_port;
 };
 
 /**
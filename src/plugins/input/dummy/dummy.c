@@ -41,8 +41,10 @@
 
 #include <ipfixcol2.h>
 #include <stdlib.h>
+#include <time.h>
 #include <unistd.h>
 #include "config.h"
+#include "generator.h"
 
 /** Plugin description */
 IPX_API struct ipx_plugin_info ipx_plugin_info = {
@@ -66,6 +68,10 @@ struct instance_data {
     struct instance_config *config;
     /** Information about the source of flows */
     struct ipx_session     *session;
+    /** Generator of synthetic traffic (NULL == empty messages) */
+    generator_t            *gen;
+    /** Deadline of the next message (only if the rate is limited) */
+    struct timespec         deadline;
 };
 
 /**
@@ -82,6 +88,53 @@ dummy_sleep(const struct timespec *delay)
     nanosleep(delay, NULL);
 }
 
+/**
+ * \brief Wait until the next message should be sent (rate limit)
+ *
+ * The deadline is moved by a fixed step after each message, therefore, short delays
+ * caused by the pipeline are compensated. The plugin sleeps only if it's ahead of the schedule
+ * by at least 100 microseconds.
+ * \param[in] data Instance data
+ */
+static void
+dummy_pace(struct instance_data *data)
+{
+    const uint64_t step = 1000000000ULL / data->config->rate;
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    if (data->deadline.tv_sec == 0 && data->deadline.tv_nsec == 0) {
+        data->deadline = now;
+    }
+
+    const int64_t ahead = (int64_t) (data->deadline.tv_sec - now.tv_sec) * 1000000000LL
+        + (data->deadline.tv_nsec - now.tv_nsec);
+    if (ahead >= 100000LL) {
+        clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &data->deadline, NULL);
+    } else if (ahead < -1000000000LL) {
+        // Too far behind the schedule (e.g. a slow pipeline), don't try to catch up
+        data->deadline = now;
+    }
+
+    uint64_t nsec = (uint64_t) data->deadline.tv_nsec + step;
+    data->deadline.tv_sec += (time_t) (nsec / 1000000000ULL);
+    data->deadline.tv_nsec = (long) (nsec % 1000000000ULL);
+}
+
+/**
+ * \brief Wait before the next message (according to the configuration)
+ * \param[in] data Instance data
+ */
+static void
+dummy_wait(struct instance_data *data)
+{
+    if (data->config->rate > 0) {
+        dummy_pace(data);
+    } else {
+        dummy_wait(data);
+    }
+}
+
 int
 ipx_plugin_init(ipx_ctx_t *ctx, const char *params)
 {
@@ -97,6 +150,16 @@ ipx_plugin_init(ipx_ctx_t *ctx, const char *params)
         return IPX_ERR_DENIED;
     }
 
+    if (data->config->gen_records > 0) {
+        // Prepare synthetic traffic
+        data->gen = generator_create(ctx, data->config);
+        if (!data->gen) {
+            config_destroy(data->config);
+            free(data);
+            return IPX_ERR_DENIED;
+        }
+    }
+
     // Store the instance data
     ipx_ctx_private_set(ctx, data);
     return IPX_OK;
@@ -107,6 +170,10 @@ ipx_plugin_destroy(ipx_ctx_t *ctx, void *cfg)
 {
     struct instance_data *data = (struct instance_data *) cfg;
 
+    if (data->gen != NULL) {
+        generator_destroy(data->gen);
+    }
+
     if (data->session != NULL) {
         // Inform other plugins that the Transport Session is closed
         ipx_msg_session_t *close_event = ipx_msg_session_create(data->session, IPX_MSG_SESSION_CLOSE);
@@ -129,6 +196,12 @@ ipx_plugin_get(ipx_ctx_t *ctx, void *cfg)
 {
     struct instance_data *data = (struct instance_data *) cfg;
 
+    if (data->gen != NULL) {
+        // Synthetic traffic
+        dummy_wait(data);
+        return generator_next(data->gen);
+    }
+
     if (data->session == NULL) {
         // Create a info about a Transport Session (only once!)
         struct ipx_session_net net_cfg;
@@ -165,7 +238,7 @@ ipx_plugin_get(ipx_ctx_t *ctx, void *cfg)
     if (!ipfix_hdr) {
         // Allocation failed, but this is not a fatal error - just skip the message
         IPX_CTX_ERROR(ctx, "Memory allocation failed! (%s:%d)", __FILE__, __LINE__);
-        dummy_sleep(&data->config->sleep_time);
+        dummy_wait(data);
         return IPX_OK;
     }
 
@@ -181,13 +254,13 @@ ipx_plugin_get(ipx_ctx_t *ctx, void *cfg)
     if (!msg2send) {
         // Allocation failed, but this is not a fatal error - just skip the message
         IPX_CTX_ERROR(ctx, "Memory allocation failed! (%s:%d)", __FILE__, __LINE__);
-        dummy_sleep(&data->config->sleep_time);
+        dummy_wait(data);
         return IPX_OK;
     }
 
     // Pass the message
     ipx_ctx_msg_pass(ctx, ipx_msg_ipfix2base(msg2send));
 
-    dummy_sleep(&data->config->sleep_time);
+    dummy_wait(data);
     return IPX_OK;
 }
\ No newline at end of file
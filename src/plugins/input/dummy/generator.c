@@ -0,0 +1,582 @@
+/**
+ * \file src/plugins/input/dummy/generator.c
+ * \author agent <agent@local>
+ * \brief Generator of synthetic IPFIX traffic (source file)
+ * \date 2026
+ */
+/* Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is'', and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#include <arpa/inet.h>
+#include <assert.h>
+#include <endian.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "generator.h"
+
+/** Number of prebuilt IPFIX Messages with Data Records of each Template */
+#define GEN_POOL_SIZE 64U
+/** Template ID of the first Template                                    */
+#define GEN_TID_FIRST 256U
+
+/** Type of a generated value */
+enum gen_value {
+    GEN_SRC_ADDR,
+    GEN_DST_ADDR,
+    GEN_SRC_PORT,
+    GEN_DST_PORT,
+    GEN_PROTO,
+    GEN_TCP_FLAGS,
+    GEN_BYTES,
+    GEN_PKTS,
+    GEN_TS_START,
+    GEN_TS_END
+};
+
+/** Field of a Template (IANA Information Element) */
+struct gen_field {
+    /** Information Element ID  */
+    uint16_t id;
+    /** Size of the field       */
+    uint16_t size;
+    /** Type of the value       */
+    enum gen_value value;
+};
+
+/** Fields of the IPv4 Template */
+static const struct gen_field fields_ipv4[] = {
+    {8,   4, GEN_SRC_ADDR},  // sourceIPv4Address
+    {12,  4, GEN_DST_ADDR},  // destinationIPv4Address
+    {7,   2, GEN_SRC_PORT},  // sourceTransportPort
+    {11,  2, GEN_DST_PORT},  // destinationTransportPort
+    {4,   1, GEN_PROTO},     // protocolIdentifier
+    {6,   2, GEN_TCP_FLAGS}, // tcpControlBits
+    {1,   8, GEN_BYTES},     // octetDeltaCount
+    {2,   8, GEN_PKTS},      // packetDeltaCount
+    {152, 8, GEN_TS_START},  // flowStartMilliseconds
+    {153, 8, GEN_TS_END}     // flowEndMilliseconds
+};
+
+/** Fields of the IPv6 Template */
+static const struct gen_field fields_ipv6[] = {
+    {27, 16, GEN_SRC_ADDR},  // sourceIPv6Address
+    {28, 16, GEN_DST_ADDR},  // destinationIPv6Address
+    {7,   2, GEN_SRC_PORT},  // sourceTransportPort
+    {11,  2, GEN_DST_PORT},  // destinationTransportPort
+    {4,   1, GEN_PROTO},     // protocolIdentifier
+    {6,   2, GEN_TCP_FLAGS}, // tcpControlBits
+    {1,   8, GEN_BYTES},     // octetDeltaCount
+    {2,   8, GEN_PKTS},      // packetDeltaCount
+    {152, 8, GEN_TS_START},  // flowStartMilliseconds
+    {153, 8, GEN_TS_END}     // flowEndMilliseconds
+};
+
+/** Description of a Template and its prebuilt messages */
+struct gen_tmplt {
+    /** Fields of the Template                       */
+    const struct gen_field *fields;
+    /** Number of fields                             */
+    uint16_t fields_cnt;
+    /** Template ID                                  */
+    uint16_t tid;
+    /** Size of a Data Record                        */
+    uint16_t rec_size;
+    /** Weight of the Template in the mix            */
+    uint32_t weight;
+
+    /** Prebuilt IPFIX Messages with Data Records    */
+    uint8_t *pool[GEN_POOL_SIZE];
+    /** Size of each prebuilt message                */
+    uint16_t pool_msg_size;
+    /** Index of the next message to use             */
+    size_t pool_next;
+};
+
+/** Stream of messages (i.e. a combination of a Transport Session and ODID) */
+struct gen_stream {
+    /** Transport Session (shared by streams)         */
+    struct ipx_session *session;
+    /** Observation Domain ID                         */
+    uint32_t odid;
+    /** Sequence number (i.e. number of sent Data Records) */
+    uint32_t seq_num;
+    /** Templates have been sent                      */
+    bool tmplts_sent;
+};
+
+struct generator {
+    /** Plugin context                               */
+    ipx_ctx_t *ctx;
+    /** Number of Data Records per message           */
+    uint16_t records;
+
+    /** Templates (only with non-zero weight)        */
+    struct gen_tmplt tmplts[2];
+    /** Number of Templates                          */
+    size_t tmplts_cnt;
+    /** Sum of weights of all Templates              */
+    uint32_t weight_sum;
+    /** Position in the template mix                 */
+    uint32_t weight_pos;
+
+    /** Prebuilt IPFIX Message with all Templates    */
+    uint8_t *tmplt_msg;
+    /** Size of the message                          */
+    uint16_t tmplt_msg_size;
+
+    /** Transport Sessions                           */
+    struct ipx_session **sessions;
+    /** Number of Transport Sessions                 */
+    uint32_t sessions_cnt;
+    /** Streams                                      */
+    struct gen_stream *streams;
+    /** Number of streams                            */
+    size_t streams_cnt;
+    /** Index of the next stream                     */
+    size_t streams_next;
+
+    /** State of the pseudo-random number generator  */
+    uint64_t rand_state;
+};
+
+/**
+ * \brief Get a pseudo-random number (xorshift64*)
+ * \param[in] gen Generator
+ * \return Number
+ */
+static inline uint64_t
+gen_rand(struct generator *gen)
+{
+    uint64_t x = gen->rand_state;
+    x ^= x >> 12;
+    x ^= x << 25;
+    x ^= x >> 27;
+    gen->rand_state = x;
+    return x * UINT64_C(2685821657736338717);
+}
+
+/**
+ * \brief Fill a field of a Data Record with a random value
+ * \param[in]  gen   Generator
+ * \param[in]  cfg   Configuration of the plugin
+ * \param[in]  field Description of the field
+ * \param[in]  now   Current time (milliseconds since the Epoch)
+ * \param[out] ptr   Pointer to the field
+ * \param[in,out] proto Protocol of the record (updated by GEN_PROTO)
+ * \param[in,out] ts    Start timestamp of the record (updated by GEN_TS_START)
+ */
+static void
+gen_field_fill(struct generator *gen, const struct instance_config *cfg,
+    const struct gen_field *field, uint64_t now, uint8_t *ptr, uint8_t *proto, uint64_t *ts)
+{
+    uint64_t value;
+    uint16_t value16;
+    uint32_t value32;
+
+    switch (field->value) {
+    case GEN_SRC_ADDR:
+    case GEN_DST_ADDR:
+        // 10.0.0.0/8 or 2001:db8::/32 (i.e. private and documentation prefixes)
+        value32 = (uint32_t) (gen_rand(gen) % cfg->gen_card_addr) + 1U;
+        if (field->size == 4U) {
+            value32 = htonl(0x0A000000U | (value32 & 0x00FFFFFFU));
+            memcpy(ptr, &value32, 4U);
+        } else {
+            static const uint8_t prefix[4] = {0x20, 0x01, 0x0D, 0xB8};
+            value32 = htonl(value32);
+            memset(ptr, 0, field->size);
+            memcpy(ptr, prefix, sizeof(prefix));
+            memcpy(ptr + field->size - 4U, &value32, 4U);
+        }
+        break;
+    case GEN_SRC_PORT:
+    case GEN_DST_PORT:
+        value16 = htons((uint16_t) (1024U + gen_rand(gen) % cfg->gen_card_port));
+        memcpy(ptr, &value16, 2U);
+        break;
+    case GEN_PROTO:
+        // Approximately 80% TCP and 20% UDP
+        *proto = ((gen_rand(gen) % 5U) == 0) ? 17U : 6U;
+        *ptr = *proto;
+        break;
+    case GEN_TCP_FLAGS:
+        value16 = htons((*proto == 6U) ? (uint16_t) (gen_rand(gen) & 0x3FU) : 0U);
+        memcpy(ptr, &value16, 2U);
+        break;
+    case GEN_PKTS:
+        value = htobe64(1U + gen_rand(gen) % 100U);
+        memcpy(ptr, &value, 8U);
+        break;
+    case GEN_BYTES:
+        value = htobe64(40U + gen_rand(gen) % 150000U);
+        memcpy(ptr, &value, 8U);
+        break;
+    case GEN_TS_START:
+        // Flows have started within the last 2 minutes
+        *ts = now - 60000U - gen_rand(gen) % 60000U;
+        value = htobe64(*ts);
+        memcpy(ptr, &value, 8U);
+        break;
+    case GEN_TS_END:
+        value = htobe64(*ts + gen_rand(gen) % 60000U);
+        memcpy(ptr, &value, 8U);
+        break;
+    }
+}
+
+/**
+ * \brief Fill the header of an IPFIX Message
+ * \param[in] ptr  Message
+ * \param[in] size Size of the message
+ */
+static void
+gen_hdr_fill(uint8_t *ptr, uint16_t size)
+{
+    struct fds_ipfix_msg_hdr *hdr = (struct fds_ipfix_msg_hdr *) ptr;
+    hdr->version = htons(FDS_IPFIX_VERSION);
+    hdr->length = htons(size);
+    hdr->export_time = 0; // Rewritten before the message is sent
+    hdr->seq_num = 0;
+    hdr->odid = 0;
+}
+
+/**
+ * \brief Build the IPFIX Message with all Templates
+ * \param[in] gen Generator
+ * \return #IPX_OK or #IPX_ERR_NOMEM
+ */
+static int
+gen_build_tmplts(struct generator *gen)
+{
+    size_t size = FDS_IPFIX_MSG_HDR_LEN + FDS_IPFIX_SET_HDR_LEN;
+    for (size_t i = 0; i < gen->tmplts_cnt; ++i) {
+        // Template Record header and field specifiers (4 bytes each)
+        size += 4U + 4U * gen->tmplts[i].fields_cnt;
+    }
+
+    uint8_t *msg = malloc(size);
+    if (!msg) {
+        return IPX_ERR_NOMEM;
+    }
+
+    gen_hdr_fill(msg, (uint16_t) size);
+    struct fds_ipfix_set_hdr *set_hdr = (struct fds_ipfix_set_hdr *) (msg + FDS_IPFIX_MSG_HDR_LEN);
+    set_hdr->flowset_id = htons(FDS_IPFIX_SET_TMPLT);
+    set_hdr->length = htons((uint16_t) (size - FDS_IPFIX_MSG_HDR_LEN));
+
+    uint8_t *pos = msg + FDS_IPFIX_MSG_HDR_LEN + FDS_IPFIX_SET_HDR_LEN;
+    for (size_t i = 0; i < gen->tmplts_cnt; ++i) {
+        const struct gen_tmplt *tmplt = &gen->tmplts[i];
+        const uint16_t rec_hdr[2] = {htons(tmplt->tid), htons(tmplt->fields_cnt)};
+        memcpy(pos, rec_hdr, sizeof(rec_hdr));
+        pos += sizeof(rec_hdr);
+
+        for (uint16_t f = 0; f < tmplt->fields_cnt; ++f) {
+            const uint16_t field[2] = {htons(tmplt->fields[f].id), htons(tmplt->fields[f].size)};
+            memcpy(pos, field, sizeof(field));
+            pos += sizeof(field);
+        }
+    }
+
+    gen->tmplt_msg = msg;
+    gen->tmplt_msg_size = (uint16_t) size;
+    return IPX_OK;
+}
+
+/**
+ * \brief Build the pool of IPFIX Messages with Data Records of a Template
+ * \param[in] gen   Generator
+ * \param[in] cfg   Configuration of the plugin
+ * \param[in] tmplt Template
+ * \return #IPX_OK or #IPX_ERR_NOMEM
+ */
+static int
+gen_build_pool(struct generator *gen, const struct instance_config *cfg, struct gen_tmplt *tmplt)
+{
+    const size_t size = FDS_IPFIX_MSG_HDR_LEN + FDS_IPFIX_SET_HDR_LEN
+        + (size_t) gen->records * tmplt->rec_size;
+    assert(size <= UINT16_MAX && "Too many records per message");
+
+    struct timespec ts_now;
+    clock_gettime(CLOCK_REALTIME, &ts_now);
+    const uint64_t now = (uint64_t) ts_now.tv_sec * 1000U + (uint64_t) ts_now.tv_nsec / 1000000U;
+
+    for (size_t i = 0; i < GEN_POOL_SIZE; ++i) {
+        uint8_t *msg = malloc(size);
+        if (!msg) {
+            return IPX_ERR_NOMEM;
+        }
+
+        tmplt->pool[i] = msg;
+        gen_hdr_fill(msg, (uint16_t) size);
+        struct fds_ipfix_set_hdr *set_hdr = (struct fds_ipfix_set_hdr *)
+            (msg + FDS_IPFIX_MSG_HDR_LEN);
+        set_hdr->flowset_id = htons(tmplt->tid);
+        set_hdr->length = htons((uint16_t) (size - FDS_IPFIX_MSG_HDR_LEN));
+
+        uint8_t *pos = msg + FDS_IPFIX_MSG_HDR_LEN + FDS_IPFIX_SET_HDR_LEN;
+        for (uint16_t r = 0; r < gen->records; ++r) {
+            uint8_t proto = 0;
+            uint64_t ts = now;
+
+            for (uint16_t f = 0; f < tmplt->fields_cnt; ++f) {
+                gen_field_fill(gen, cfg, &tmplt->fields[f], now, pos, &proto, &ts);
+                pos += tmplt->fields[f].size;
+            }
+        }
+    }
+
+    tmplt->pool_msg_size = (uint16_t) size;
+    return IPX_OK;
+}
+
+/**
+ * \brief Add a Template to the generator
+ * \param[in] gen        Generator
+ * \param[in] fields     Fields of the Template
+ * \param[in] fields_cnt Number of fields
+ * \param[in] weight     Weight of the Template in the mix (0 == ignore)
+ */
+static void
+gen_add_tmplt(struct generator *gen, const struct gen_field *fields, uint16_t fields_cnt,
+    uint32_t weight)
+{
+    if (weight == 0) {
+        return;
+    }
+
+    struct gen_tmplt *tmplt = &gen->tmplts[gen->tmplts_cnt];
+    tmplt->fields = fields;
+    tmplt->fields_cnt = fields_cnt;
+    tmplt->tid = (uint16_t) (GEN_TID_FIRST + gen->tmplts_cnt);
+    tmplt->weight = weight;
+    tmplt->rec_size = 0;
+    for (uint16_t i = 0; i < fields_cnt; ++i) {
+        tmplt->rec_size += fields[i].size;
+    }
+
+    gen->tmplts_cnt++;
+    gen->weight_sum += weight;
+}
+
+/**
+ * \brief Create Transport Sessions and streams
+ * \param[in] gen Generator
+ * \param[in] cfg Configuration of the plugin
+ * \return #IPX_OK or #IPX_ERR_NOMEM
+ */
+static int
+gen_build_streams(struct generator *gen, const struct instance_config *cfg)
+{
+    gen->sessions = calloc(cfg->gen_sessions, sizeof(*gen->sessions));
+    gen->streams = calloc((size_t) cfg->gen_sessions * cfg->gen_odids, sizeof(*gen->streams));
+    if (!gen->sessions || !gen->streams) {
+        return IPX_ERR_NOMEM;
+    }
+
+    for (uint32_t i = 0; i < cfg->gen_sessions; ++i) {
+        // Each session has a unique source address (127.0.0.0/8) and port
+        struct ipx_session_net net_cfg;
+        memset(&net_cfg, 0, sizeof(net_cfg));
+        net_cfg.l3_proto = AF_INET;
+        net_cfg.port_src = (uint16_t) (10000U + i % 50000U);
+        net_cfg.port_dst = 4739;
+        net_cfg.addr_src.ipv4.s_addr = htonl(0x7F000001U + (i % 0xFFFFFEU));
+        net_cfg.addr_dst.ipv4.s_addr = htonl(0x7F000001U);
+
+        struct ipx_session *session = ipx_session_new_tcp(&net_cfg);
+        if (!session) {
+            return IPX_ERR_NOMEM;
+        }
+        gen->sessions[gen->sessions_cnt++] = session;
+
+        // Inform other plugins about the new Transport Session
+        ipx_msg_session_t *msg = ipx_msg_session_create(session, IPX_MSG_SESSION_OPEN);
+        if (!msg) {
+            return IPX_ERR_NOMEM;
+        }
+        ipx_ctx_msg_pass(gen->ctx, ipx_msg_session2base(msg));
+
+        for (uint32_t j = 0; j < cfg->gen_odids; ++j) {
+            struct gen_stream *stream = &gen->streams[gen->streams_cnt++];
+            stream->session = session;
+            stream->odid = cfg->odid + j;
+        }
+    }
+
+    return IPX_OK;
+}
+
+generator_t *
+generator_create(ipx_ctx_t *ctx, const struct instance_config *cfg)
+{
+    struct generator *gen = calloc(1, sizeof(*gen));
+    if (!gen) {
+        IPX_CTX_ERROR(ctx, "Memory allocation failed! (%s:%d)", __FILE__, __LINE__);
+        return NULL;
+    }
+
+    gen->ctx = ctx;
+    gen->records = cfg->gen_records;
+    gen->rand_state = UINT64_C(0x9E3779B97F4A7C15); // Reproducible output
+    gen_add_tmplt(gen, fields_ipv4, sizeof(fields_ipv4) / sizeof(fields_ipv4[0]),
+        cfg->gen_mix_ipv4);
+    gen_add_tmplt(gen, fields_ipv6, sizeof(fields_ipv6) / sizeof(fields_ipv6[0]),
+        cfg->gen_mix_ipv6);
+    assert(gen->tmplts_cnt > 0 && "At least one Template must be enabled");
+
+    int rc = gen_build_tmplts(gen);
+    for (size_t i = 0; rc == IPX_OK && i < gen->tmplts_cnt; ++i) {
+        rc = gen_build_pool(gen, cfg, &gen->tmplts[i]);
+    }
+    if (rc == IPX_OK) {
+        rc = gen_build_streams(gen, cfg);
+    }
+
+    if (rc != IPX_OK) {
+        IPX_CTX_ERROR(ctx, "Memory allocation failed! (%s:%d)", __FILE__, __LINE__);
+        generator_destroy(gen);
+        return NULL;
+    }
+
+    return gen;
+}
+
+void
+generator_destroy(generator_t *gen)
+{
+    for (uint32_t i = 0; i < gen->sessions_cnt; ++i) {
+        // Inform other plugins that the Transport Session is closed
+        struct ipx_session *session = gen->sessions[i];
+        ipx_msg_session_t *close_event = ipx_msg_session_create(session, IPX_MSG_SESSION_CLOSE);
+        ipx_ctx_msg_pass(gen->ctx, ipx_msg_session2base(close_event));
+
+        /* The session cannot be freed because other plugin still have access to it.
+         * Send it as a garbage message after the Transport Session close event.
+         */
+        ipx_msg_garbage_cb cb = (ipx_msg_garbage_cb) &ipx_session_destroy;
+        ipx_msg_garbage_t *garbage = ipx_msg_garbage_create(session, cb);
+        ipx_ctx_msg_pass(gen->ctx, ipx_msg_garbage2base(garbage));
+    }
+
+    for (size_t i = 0; i < gen->tmplts_cnt; ++i) {
+        for (size_t j = 0; j < GEN_POOL_SIZE; ++j) {
+            free(gen->tmplts[i].pool[j]);
+        }
+    }
+
+    free(gen->tmplt_msg);
+    free(gen->streams);
+    free(gen->sessions);
+    free(gen);
+}
+
+/**
+ * \brief Select the next Template according to the template mix
+ * \param[in] gen Generator
+ * \return Template
+ */
+static struct gen_tmplt *
+gen_select_tmplt(struct generator *gen)
+{
+    uint32_t pos = gen->weight_pos;
+    gen->weight_pos = (gen->weight_pos + 1U) % gen->weight_sum;
+
+    for (size_t i = 0; i < gen->tmplts_cnt; ++i) {
+        if (pos < gen->tmplts[i].weight) {
+            return &gen->tmplts[i];
+        }
+        pos -= gen->tmplts[i].weight;
+    }
+
+    return &gen->tmplts[gen->tmplts_cnt - 1];
+}
+
+int
+generator_next(generator_t *gen)
+{
+    struct gen_stream *stream = &gen->streams[gen->streams_next];
+    gen->streams_next = (gen->streams_next + 1U) % gen->streams_cnt;
+
+    // Select a prebuilt message
+    const uint8_t *src;
+    uint16_t size;
+    uint32_t rec_cnt = 0;
+
+    if (!stream->tmplts_sent) {
+        src = gen->tmplt_msg;
+        size = gen->tmplt_msg_size;
+        stream->tmplts_sent = true;
+    } else {
+        struct gen_tmplt *tmplt = gen_select_tmplt(gen);
+        src = tmplt->pool[tmplt->pool_next];
+        size = tmplt->pool_msg_size;
+        tmplt->pool_next = (tmplt->pool_next + 1U) % GEN_POOL_SIZE;
+        rec_cnt = gen->records;
+    }
+
+    uint8_t *msg = ipx_utils_buf_alloc(size);
+    if (!msg) {
+        // Allocation failed, but this is not a fatal error - just skip the message
+        IPX_CTX_ERROR(gen->ctx, "Memory allocation failed! (%s:%d)", __FILE__, __LINE__);
+        return IPX_OK;
+    }
+
+    // Copy the message and rewrite its header
+    memcpy(msg, src, size);
+    struct fds_ipfix_msg_hdr *hdr = (struct fds_ipfix_msg_hdr *) msg;
+    hdr->export_time = htonl((uint32_t) time(NULL));
+    hdr->seq_num = htonl(stream->seq_num);
+    hdr->odid = htonl(stream->odid);
+    stream->seq_num += rec_cnt;
+
+    struct ipx_msg_ctx msg_ctx = {
+        .session = stream->session,
+        .odid = stream->odid,
+        .stream = 0
+    };
+
+    ipx_msg_ipfix_t *msg2send = ipx_msg_ipfix_create(gen->ctx, &msg_ctx, msg, size);
+    if (!msg2send) {
+        // Allocation failed, but this is not a fatal error - just skip the message
+        IPX_CTX_ERROR(gen->ctx, "Memory allocation failed! (%s:%d)", __FILE__, __LINE__);
+        ipx_utils_buf_free(msg);
+        return IPX_OK;
+    }
+
+    ipx_ctx_msg_pass(gen->ctx, ipx_msg_ipfix2base(msg2send));
+    return IPX_OK;
+}
@@ -0,0 +1,84 @@
+/**
+ * \file src/plugins/input/dummy/generator.h
+ * \author agent <agent@local>
+ * \brief Generator of synthetic IPFIX traffic (header file)
+ * \date 2026
+ */
+/* Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is'', and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#ifndef DUMMY_GENERATOR_H
+#define DUMMY_GENERATOR_H
+
+#include <ipfixcol2.h>
+#include "config.h"
+
+/** Internal generator structure */
+typedef struct generator generator_t;
+
+/**
+ * \brief Create a generator of synthetic IPFIX traffic
+ *
+ * All IPFIX Messages (i.e. Template Sets and a pool of Data Sets for each configured Template)
+ * are built in advance. Later, the messages are only copied and their headers are rewritten.
+ * Records are generated from random values with the configured cardinality, therefore,
+ * the number of different records is limited by the size of the pool.
+ * \param[in] ctx Plugin context
+ * \param[in] cfg Configuration of the plugin
+ * \return Pointer to the generator or NULL (memory allocation error)
+ */
+generator_t *
+generator_create(ipx_ctx_t *ctx, const struct instance_config *cfg);
+
+/**
+ * \brief Close all Transport Sessions and destroy the generator
+ * \param[in] gen Generator
+ */
+void
+generator_destroy(generator_t *gen);
+
+/**
+ * \brief Generate and pass the next IPFIX Message
+ *
+ * Streams (i.e. combinations of Transport Sessions and ODIDs) are used in round-robin fashion.
+ * The first message of each stream contains only Template Sets. Other messages contain a single
+ * Data Set of a Template selected according to the configured template mix.
+ * \param[in] gen Generator
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_DENIED on a fatal failure
+ */
+int
+generator_next(generator_t *gen);
+
+#endif // DUMMY_GENERATOR_H
@@ -20,7 +20,7 @@ Builder::Builder(uint16_t size)
         throw FDS_exception("[internal] Invalid size of a message to generate!");
     }
 
-    m_msg.reset((uint8_t *) malloc(size));
+    m_msg.reset((uint8_t *) ipx_utils_buf_alloc(size));
     if (!m_msg) {
         throw FDS_exception("Memory allocation error " + std::string(__PRETTY_FUNCTION__));
     }
@@ -42,12 +42,12 @@ Builder::Builder(uint16_t size)
 void
 Builder::resize(uint16_t size)
 {
-    uint8_t *new_ptr = (uint8_t *) realloc(m_msg.get(), size);
+    uint8_t *new_ptr = (uint8_t *) ipx_utils_buf_realloc(m_msg.get(), size);
     if (!new_ptr) {
         throw FDS_exception("Memory allocation error " + std::string(__PRETTY_FUNCTION__));
     }
 
-    m_msg.release(); // To avoid calling free()
+    m_msg.release(); // To avoid calling ipx_utils_buf_free()
     m_msg.reset(new_ptr);
     m_msg_alloc = size;
 
@@ -209,6 +209,19 @@ Builder::add_template(const struct fds_template *tmplt)
 bool
 Builder::add_record(const struct fds_drec *rec)
 {
+    if (m_set_offset != 0 && rec->tmplt->id == m_set_id) {
+        /* Fast path: consecutive records of a data block usually share the same Template,
+         * therefore, they are just appended to the current Data Set. */
+        if (rec->size > m_msg_alloc - m_msg_valid) {
+            return false;
+        }
+
+        memcpy(&m_msg.get()[m_msg_valid], rec->data, rec->size);
+        m_msg_valid += rec->size;
+        m_set_size += rec->size;
+        return true;
+    }
+
     uint16_t size_req = rec->size;
     if (m_set_offset == 0 || rec->tmplt->id != m_set_id) {
         // New Data Set must be created
@@ -10,13 +10,14 @@
 
 #include <cstdlib>
 #include <memory>
+#include <ipfixcol2.h>
 #include <libfds.h>
 
 /// IPFIX Message builder
 class Builder {
 private:
-    /// Memory of IPFIX Message to generate (can be nullptr)
-    std::unique_ptr<uint8_t, decltype(&free)> m_msg = {nullptr, &free};
+    /// Memory of IPFIX Message to generate (can be nullptr, allocated by the buffer pool)
+    std::unique_ptr<uint8_t, decltype(&ipx_utils_buf_free)> m_msg = {nullptr, &ipx_utils_buf_free};
     /// Allocated size (bytes)
     uint16_t m_msg_alloc;
     /// Filled size (bytes)
@@ -48,8 +48,8 @@
 #include "Reader.hpp"
 
 
-Reader::Reader(ipx_ctx_t *ctx, const fds_config *cfg, const char *path)
-    : m_ctx(ctx), m_cfg(cfg)
+Reader::Reader(ipx_ctx_t *ctx, const fds_config *cfg, const char *path, msg_pass_cb pass)
+    : m_ctx(ctx), m_cfg(cfg), m_pass(std::move(pass))
 {
     uint32_t flags = FDS_FILE_READ;
     flags |= (m_cfg->async) ? 0 : FDS_FILE_NOASYNC;
@@ -62,6 +62,22 @@ Reader::Reader(ipx_ctx_t *ctx, const fds_config *cfg, const char *path)
     if (fds_file_open(m_file.get(), path, flags) != FDS_OK) {
         throw FDS_exception("Unable to open file '" + std::string(path));
     }
+
+    if (m_cfg->filter.odids_cnt > 0 && !odid_match()) {
+        // Skip the whole file
+        IPX_CTX_INFO(m_ctx, "File '%s' doesn't contain any selected ODID and it's skipped.", path);
+        m_skip = true;
+        return;
+    }
+
+    /* Only Data Blocks of selected ODIDs are read (other blocks are skipped by the library
+     * without decompression) */
+    for (size_t i = 0; i < m_cfg->filter.odids_cnt; ++i) {
+        if (fds_file_read_sfilter(m_file.get(), nullptr, &m_cfg->filter.odids[i]) != FDS_OK) {
+            throw FDS_exception("Unable to set a filter of ODIDs: "
+                + std::string(fds_file_error(m_file.get())));
+        }
+    }
 }
 
 Reader::~Reader()
@@ -73,6 +89,48 @@ Reader::~Reader()
     }
 }
 
+/**
+ * @brief Check if the file contains records of any selected ODID
+ *
+ * The decision is based on the list of Transport Sessions and their ODIDs stored in the
+ * file, therefore, no Data Block is read.
+ * @return True or false
+ * @throw FDS_exception in case of a failure
+ */
+bool
+Reader::odid_match()
+{
+    fds_file_sid_t *sids = nullptr;
+    size_t sids_cnt = 0;
+
+    if (fds_file_session_list(m_file.get(), &sids, &sids_cnt) != FDS_OK) {
+        throw FDS_exception("Unable to get the list of Transport Sessions: "
+            + std::string(fds_file_error(m_file.get())));
+    }
+    std::unique_ptr<fds_file_sid_t, decltype(&free)> sids_wrap(sids, &free);
+
+    for (size_t i = 0; i < sids_cnt; ++i) {
+        uint32_t *odids = nullptr;
+        size_t odids_cnt = 0;
+
+        if (fds_file_session_odids(m_file.get(), sids[i], &odids, &odids_cnt) != FDS_OK) {
+            throw FDS_exception("Unable to get the list of ODIDs: "
+                + std::string(fds_file_error(m_file.get())));
+        }
+        std::unique_ptr<uint32_t, decltype(&free)> odids_wrap(odids, &free);
+
+        for (size_t j = 0; j < odids_cnt; ++j) {
+            for (size_t k = 0; k < m_cfg->filter.odids_cnt; ++k) {
+                if (odids[j] == m_cfg->filter.odids[k]) {
+                    return true;
+                }
+            }
+        }
+    }
+
+    return false;
+}
+
 /**
  * @brief Get a Transport Session description given by FDS (Transport) Session ID
  *
@@ -150,7 +208,7 @@ Reader::session_open(struct ipx_session *ts)
         throw FDS_exception("Failed to create a Transport Session notification");
     }
 
-    if (ipx_ctx_msg_pass(m_ctx, ipx_msg_session2base(msg)) != IPX_OK) {
+    if (msg_pass(ipx_msg_session2base(msg)) != IPX_OK) {
         ipx_msg_session_destroy(msg);
         throw  FDS_exception("Failed to pass a Transport Session notification");
     }
@@ -177,7 +235,7 @@ Reader::session_close(struct ipx_session *ts)
         throw FDS_exception("Failed to create a Transport Session notification");
     }
 
-    if (ipx_ctx_msg_pass(m_ctx, ipx_msg_session2base(msg_session)) != IPX_OK) {
+    if (msg_pass(ipx_msg_session2base(msg_session)) != IPX_OK) {
         ipx_msg_session_destroy(msg_session);
         throw FDS_exception("Failed to pass a Transport Session notification");
     }
@@ -189,7 +247,7 @@ Reader::session_close(struct ipx_session *ts)
         throw FDS_exception("Failed to create a garbage message with a Transport Session");
     }
 
-    if (ipx_ctx_msg_pass(m_ctx, ipx_msg_garbage2base(msg_garbage)) != IPX_OK) {
+    if (msg_pass(ipx_msg_garbage2base(msg_garbage)) != IPX_OK) {
         /* Memory leak... We cannot destroy the message as it also destroys
          * the session structure. */
         throw FDS_exception("Failed to pass a garbage message with a Transport Session");
@@ -321,23 +379,46 @@ Reader::send_ipfix(uint8_t *msg, const struct ipx_session *ts, uint32_t odid)
     ipx_msg_ipfix_t *msg_ptr;
     struct ipx_msg_ctx msg_ctx;
 
+    if (m_pass) {
+        // The wrapper will be created by the thread of the instance
+        m_pass(ReaderMsg{nullptr, msg, ts, odid});
+        return;
+    }
+
     msg_ctx.session = ts;
     msg_ctx.odid = odid;
     msg_ctx.stream = 0; // stream is not stored in the file
 
     msg_ptr = ipx_msg_ipfix_create(m_ctx, &msg_ctx, msg, msg_size);
     if (!msg_ptr) {
-        free(msg);
+        ipx_utils_buf_free(msg);
         throw FDS_exception("Failed to allocate an IPFIX Message!");
     }
 
     // Send it to the pipeline
-    if (ipx_ctx_msg_pass(m_ctx, ipx_msg_ipfix2base(msg_ptr)) != IPX_OK) {
+    if (msg_pass(ipx_msg_ipfix2base(msg_ptr)) != IPX_OK) {
         ipx_msg_ipfix_destroy(msg_ptr);
         throw FDS_exception("Failed to pass an IPFIX Message!");
     }
 }
 
+/**
+ * @brief Pass a message to the pipeline (or to the callback of the reader, if defined)
+ * @param[in] msg Message to pass
+ * @return #IPX_OK on success (the message has been taken)
+ * @return Other codes on failure (the caller is still responsible for the message)
+ */
+int
+Reader::msg_pass(ipx_msg_t *msg)
+{
+    if (m_pass) {
+        m_pass(ReaderMsg{msg, nullptr, nullptr, 0});
+        return IPX_OK;
+    }
+
+    return ipx_ctx_msg_pass(m_ctx, msg);
+}
+
 /**
  * @brief Get the next Data Record to process
  *
@@ -361,15 +442,23 @@ Reader::record_get(const struct fds_drec **rec, const struct fds_file_read_ctx *
         return IPX_OK;
     }
 
-    ret = fds_file_read_rec(m_file.get(), &m_unproc_data, &m_unproc_ctx);
-    switch (ret) {
-    case FDS_OK:  // Success
-        break;
-    case FDS_EOC: // End of file
-        return IPX_ERR_EOF;
-    default:
-        throw FDS_exception("fds_file_read_rec() failed: "
-            + std::string(fds_file_error(m_file.get())));
+    while (true) {
+        ret = fds_file_read_rec(m_file.get(), &m_unproc_data, &m_unproc_ctx);
+        switch (ret) {
+        case FDS_OK:  // Success
+            break;
+        case FDS_EOC: // End of file
+            return IPX_ERR_EOF;
+        default:
+            throw FDS_exception("fds_file_read_rec() failed: "
+                + std::string(fds_file_error(m_file.get())));
+        }
+
+        // Skip records out of the time range (the Export Time is shared by the whole block)
+        if (m_unproc_ctx.exp_time >= m_cfg->filter.time_from
+                && m_unproc_ctx.exp_time <= m_cfg->filter.time_to) {
+            break;
+        }
     }
 
     *rec = &m_unproc_data;
@@ -394,6 +483,11 @@ Reader::send_batch()
     const struct fds_drec *drec;
     const struct fds_file_read_ctx *dctx;
 
+    if (m_skip) {
+        // The file doesn't contain any records of interest
+        return IPX_ERR_EOF;
+    }
+
     // Get the first Data Record
     switch (record_get(&drec, &dctx)) {
     case IPX_OK:
@@ -42,6 +42,7 @@
 #ifndef FDS_READER_HPP
 #define FDS_READER_HPP
 
+#include <functional>
 #include <glob.h>
 #include <map>
 #include <memory>
@@ -72,6 +73,26 @@ struct Session {
     Session() : info(nullptr) {}
 };
 
+/// Message generated by the reader
+struct ReaderMsg {
+    /// Message for the pipeline (Session or Garbage Message) or nullptr (raw IPFIX Message)
+    ipx_msg_t *msg;
+    /// Raw IPFIX Message (only if @p msg is not defined)
+    uint8_t *raw;
+    /// Transport Session of the raw IPFIX Message
+    const struct ipx_session *session;
+    /// Observation Domain ID of the raw IPFIX Message
+    uint32_t odid;
+};
+
+/**
+ * @brief Callback taking messages generated by the reader
+ *
+ * The callback always takes responsibility for the message. Raw IPFIX Messages are not
+ * wrapped, because the wrapper can be created only by the instance thread.
+ */
+using msg_pass_cb = std::function<void(const ReaderMsg &)>;
+
 /// FDS File reader
 class Reader {
 public:
@@ -82,9 +103,11 @@ public:
      * @param[in] ctx  Plugin context (for log and message passing)
      * @param[in] cfg  Parsed plugin configuration
      * @param[in] path File to read
+     * @param[in] pass Callback passing generated messages (if not defined, messages are passed
+     *   directly by ipx_ctx_msg_pass() i.e. the reader MUST be used by the instance thread)
      * @throw FDS_exception in case of failure (e.g. invalid file)
      */
-    Reader(ipx_ctx_t *ctx, const fds_config *cfg, const char *path);
+    Reader(ipx_ctx_t *ctx, const fds_config *cfg, const char *path, msg_pass_cb pass = nullptr);
     /**
      * @brief Instance destructor
      * @note Close the file and send "close" notifications of all Transport Sessions
@@ -117,11 +140,15 @@ private:
     ipx_ctx_t *m_ctx;
     /// Plugin configuration
     const fds_config *m_cfg;
+    /// Callback passing generated messages (optional)
+    msg_pass_cb m_pass;
     /// File handler (of the file current file)
     std::unique_ptr<fds_file_t, decltype(&fds_file_close)> m_file = {nullptr, &fds_file_close};
     /// Transport Sessions (from the current file)
     std::map<fds_file_sid_t, Session> m_sessions;
 
+    /// The file doesn't contain any records of interest (see the filter of the configuration)
+    bool m_skip = false;
     /// Signalization of an unprocessed Data Record
     bool m_unproc = false;
     /// Content of the unprocessed Data Record
@@ -129,6 +156,8 @@ private:
     /// Context of the unprocessed Data Record
     struct fds_file_read_ctx m_unproc_ctx;
 
+    bool
+    odid_match();
     struct ipx_session *
     session_from_sid(fds_file_sid_t sid);
     void
@@ -142,6 +171,8 @@ private:
     void
     send_ipfix(uint8_t *msg, const struct ipx_session *ts, uint32_t odid);
 
+    int
+    msg_pass(ipx_msg_t *msg);
     int
     record_get(const struct fds_drec **rec, const struct fds_file_read_ctx **ctx);
 };
@@ -0,0 +1,442 @@
+/**
+ * \file src/plugins/input/fds/Replay.cpp
+ * \author agent <agent@local>
+ * \brief Parallel replay of multiple FDS files
+ * \date 2026
+ */
+
+/* Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is'', and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#include <algorithm>
+#include <arpa/inet.h>
+#include <chrono>
+#include <system_error>
+
+#include "Exception.hpp"
+#include "Replay.hpp"
+
+/// Maximal number of messages in the queue of a reader thread
+static const size_t QUEUE_MAX = 64;
+/// Maximal duration of a single wait for the time of the next message (in nanoseconds)
+static const uint64_t PACE_WAIT_MAX = 100000000ULL;
+/// Maximal jump of Export Time back in time that doesn't restart pacing (in seconds)
+static const int64_t PACE_BACK_MAX = 60;
+
+Replay::Replay(ipx_ctx_t *ctx, const fds_config *cfg, std::vector<std::string> files)
+    : m_ctx(ctx), m_cfg(cfg), m_files(std::move(files))
+{
+    // There is no reason to start more threads than files
+    size_t cnt = std::min<size_t>(m_cfg->threads, m_files.size());
+
+    try {
+        for (size_t i = 0; i < cnt; ++i) {
+            std::unique_ptr<Worker> worker(new Worker);
+            Worker *ptr = worker.get();
+            m_workers.push_back(std::move(worker));
+            ptr->thread = std::thread(&Replay::worker_main, this, ptr);
+        }
+    } catch (const std::system_error &ex) {
+        threads_stop();
+        throw FDS_exception("Failed to start a reader thread: " + std::string(ex.what()));
+    }
+
+    IPX_CTX_INFO(m_ctx, "Reading %zu file(s) by %zu thread(s)...", m_files.size(), cnt);
+}
+
+Replay::~Replay()
+{
+    threads_stop();
+}
+
+/**
+ * @brief Stop all reader threads
+ *
+ * Messages that haven't been passed yet are dropped. Only successfully started threads
+ * are joined.
+ */
+void
+Replay::threads_stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_lock);
+        m_stop = true;
+    }
+    m_cond_space.notify_all();
+
+    for (auto &worker : m_workers) {
+        if (worker->thread.joinable()) {
+            worker->thread.join();
+        }
+    }
+
+    // Drop messages that haven't been passed
+    for (auto &worker : m_workers) {
+        for (const auto &msg : worker->queue) {
+            drop(msg);
+        }
+        worker->queue.clear();
+    }
+    m_workers.clear();
+}
+
+/**
+ * @brief Drop a message generated by a reader thread
+ *
+ * @note
+ *   Garbage Messages are not destroyed, because they also destroy the Transport Session,
+ *   which can be still used by other plugins further in the pipeline.
+ * @param[in] msg Message to drop
+ */
+void
+Replay::drop(const ReaderMsg &msg)
+{
+    if (!msg.msg) {
+        ipx_utils_buf_free(msg.raw);
+        return;
+    }
+
+    if (ipx_msg_get_type(msg.msg) != IPX_MSG_GARBAGE) {
+        ipx_msg_destroy(msg.msg);
+    }
+}
+
+/**
+ * @brief Get the next file to read
+ * @param[out] path Path of the file
+ * @return True on success
+ * @return False if there are no more files to read
+ */
+bool
+Replay::worker_file(std::string &path)
+{
+    std::lock_guard<std::mutex> lock(m_lock);
+    if (m_next_file >= m_files.size()) {
+        return false;
+    }
+
+    path = m_files[m_next_file++];
+    return true;
+}
+
+/**
+ * @brief Insert a message generated by a reader thread into its queue
+ *
+ * If the queue is full, the function blocks until the instance thread takes a message.
+ * If the threads should terminate, the message is dropped.
+ * @param[in] worker Reader thread
+ * @param[in] msg    Message
+ */
+void
+Replay::worker_push(Worker *worker, const ReaderMsg &msg)
+{
+    std::unique_lock<std::mutex> lock(m_lock);
+    m_cond_space.wait(lock, [&]() {
+        return m_stop || worker->queue.size() < QUEUE_MAX;
+    });
+
+    if (m_stop) {
+        lock.unlock();
+        drop(msg);
+        return;
+    }
+
+    worker->queue.push_back(msg);
+    const bool notify = (worker->queue.size() == 1);
+    lock.unlock();
+
+    // The instance thread can wait only if a queue it needs is empty
+    if (notify) {
+        m_cond_data.notify_one();
+    }
+}
+
+/**
+ * @brief Main function of a reader thread
+ *
+ * The thread reads files from the list until all files are processed. Files that cannot
+ * be opened are skipped.
+ * @param[in] worker Reader thread
+ */
+void
+Replay::worker_main(Worker *worker)
+{
+    msg_pass_cb pass = [this, worker](const ReaderMsg &msg) {
+        worker_push(worker, msg);
+    };
+
+    try {
+        std::string path;
+        while (!m_stop && worker_file(path)) {
+            std::unique_ptr<Reader> reader;
+            try {
+                reader.reset(new Reader(m_ctx, m_cfg, path.c_str(), pass));
+            } catch (const FDS_exception &ex) {
+                IPX_CTX_ERROR(m_ctx, "%s", ex.what());
+                continue;
+            }
+
+            IPX_CTX_INFO(m_ctx, "Reading from file '%s'...", path.c_str());
+            while (!m_stop && reader->send_batch() == IPX_OK) {
+                // Messages are inserted into the queue by the callback
+            }
+        }
+    } catch (const std::exception &ex) {
+        std::lock_guard<std::mutex> lock(m_lock);
+        if (m_error.empty()) {
+            m_error = ex.what();
+        }
+    } catch (...) {
+        std::lock_guard<std::mutex> lock(m_lock);
+        if (m_error.empty()) {
+            m_error = "Unknown error has occurred in a reader thread!";
+        }
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_lock);
+        worker->done = true;
+    }
+    m_cond_data.notify_one();
+}
+
+/**
+ * @brief Select a reader thread with a message to pass (per-file order)
+ *
+ * Threads with ready messages are selected in a round-robin fashion.
+ * @warning The lock MUST be held by the caller.
+ * @param[out] eof Set to true, if all threads have finished and there are no more messages
+ * @return Selected thread or nullptr (no message is ready)
+ */
+Replay::Worker *
+Replay::select_file(bool &eof)
+{
+    const size_t cnt = m_workers.size();
+    eof = true;
+
+    for (size_t i = 0; i < cnt; ++i) {
+        Worker *worker = m_workers[(m_worker_idx + i) % cnt].get();
+        if (!worker->queue.empty()) {
+            m_worker_idx = (m_worker_idx + i + 1) % cnt;
+            eof = false;
+            return worker;
+        }
+
+        if (!worker->done) {
+            eof = false;
+        }
+    }
+
+    return nullptr;
+}
+
+/**
+ * @brief Select a reader thread with a message to pass (global time order)
+ *
+ * The thread with the oldest IPFIX Message (by its Export Time) at the head of its queue is
+ * selected. Since the decision must consider all threads, it cannot be made until each
+ * running thread has at least one message in its queue. Other messages (e.g. Transport
+ * Session notifications) are selected immediately as they don't have any timestamp.
+ * @warning The lock MUST be held by the caller.
+ * @param[out] eof Set to true, if all threads have finished and there are no more messages
+ * @return Selected thread or nullptr (no message is ready)
+ */
+Replay::Worker *
+Replay::select_time(bool &eof)
+{
+    Worker *result = nullptr;
+    uint32_t result_time = 0;
+    eof = true;
+
+    for (auto &worker : m_workers) {
+        if (worker->queue.empty()) {
+            if (!worker->done) {
+                // Wait for the next message of the thread
+                eof = false;
+                return nullptr;
+            }
+            continue;
+        }
+
+        eof = false;
+        const ReaderMsg &head = worker->queue.front();
+        if (head.msg) {
+            return worker.get();
+        }
+
+        auto hdr = reinterpret_cast<const struct fds_ipfix_msg_hdr *>(head.raw);
+        uint32_t exp_time = ntohl(hdr->export_time);
+        if (!result || exp_time < result_time) {
+            result = worker.get();
+            result_time = exp_time;
+        }
+    }
+
+    return result;
+}
+
+/**
+ * @brief Get remaining time before a message can be passed (rate-paced replay)
+ *
+ * IPFIX Messages are paced by their Export Time relative to the reference message scaled by
+ * the configured replay speed. If the Export Time jumps significantly back in time (e.g.
+ * a new file), the message becomes the new reference. Other messages are never delayed.
+ * @param[in] msg Message to pass
+ * @return Remaining time (in nanoseconds) or 0, if the message can be passed right now
+ */
+uint64_t
+Replay::pace(const ReaderMsg &msg)
+{
+    if (m_cfg->speed <= 0 || msg.msg) {
+        return 0;
+    }
+
+    auto hdr = reinterpret_cast<const struct fds_ipfix_msg_hdr *>(msg.raw);
+    const uint32_t exp_time = ntohl(hdr->export_time);
+    const uint64_t now = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+
+    if (m_pace_mono == 0 || int64_t(exp_time) + PACE_BACK_MAX < int64_t(m_pace_last)) {
+        m_pace_etime = exp_time;
+        m_pace_mono = now;
+    }
+
+    double offset = (double(exp_time) - double(m_pace_etime)) * 1e9 / m_cfg->speed;
+    double target = double(m_pace_mono) + offset;
+    if (target > double(now)) {
+        return uint64_t(target - double(now)) + 1;
+    }
+
+    m_pace_last = exp_time;
+    return 0;
+}
+
+/**
+ * @brief Pass a message generated by a reader thread to the pipeline
+ * @param[in] msg Message to pass (the function takes responsibility for it)
+ * @throw FDS_exception in case of failure
+ */
+void
+Replay::pass(const ReaderMsg &msg)
+{
+    if (msg.msg) {
+        if (ipx_ctx_msg_pass(m_ctx, msg.msg) != IPX_OK) {
+            drop(msg);
+            throw FDS_exception("Failed to pass a message!");
+        }
+        return;
+    }
+
+    uint16_t msg_size = ntohs(reinterpret_cast<fds_ipfix_msg_hdr *>(msg.raw)->length);
+    ipx_msg_ipfix_t *msg_ptr;
+    struct ipx_msg_ctx msg_ctx;
+
+    msg_ctx.session = msg.session;
+    msg_ctx.odid = msg.odid;
+    msg_ctx.stream = 0; // stream is not stored in the file
+
+    msg_ptr = ipx_msg_ipfix_create(m_ctx, &msg_ctx, msg.raw, msg_size);
+    if (!msg_ptr) {
+        ipx_utils_buf_free(msg.raw);
+        throw FDS_exception("Failed to allocate an IPFIX Message!");
+    }
+
+    if (ipx_ctx_msg_pass(m_ctx, ipx_msg_ipfix2base(msg_ptr)) != IPX_OK) {
+        ipx_msg_ipfix_destroy(msg_ptr);
+        throw FDS_exception("Failed to pass an IPFIX Message!");
+    }
+}
+
+int
+Replay::pass_next()
+{
+    std::deque<ReaderMsg> batch;
+
+    {
+        std::unique_lock<std::mutex> lock(m_lock);
+        while (true) {
+            if (!m_error.empty()) {
+                throw FDS_exception(m_error);
+            }
+
+            bool eof;
+            Worker *worker = (m_cfg->order == FDS_ORDER_TIME)
+                ? select_time(eof) : select_file(eof);
+
+            if (worker && (m_cfg->order == FDS_ORDER_TIME || m_cfg->speed > 0)) {
+                // Only the head of the queue can be passed
+                uint64_t delay = pace(worker->queue.front());
+                if (delay > 0) {
+                    // Wait only for a while, so the plugin can be terminated anytime
+                    lock.unlock();
+                    delay = std::min(delay, PACE_WAIT_MAX);
+                    std::this_thread::sleep_for(std::chrono::nanoseconds(delay));
+                    return IPX_OK;
+                }
+
+                batch.push_back(worker->queue.front());
+                worker->queue.pop_front();
+                break;
+            } else if (worker) {
+                // Take all messages of the file(s) at once
+                batch.swap(worker->queue);
+                break;
+            }
+
+            if (eof) {
+                return IPX_ERR_EOF;
+            }
+
+            m_cond_data.wait(lock);
+        }
+    }
+
+    m_cond_space.notify_all();
+
+    while (!batch.empty()) {
+        ReaderMsg msg = batch.front();
+        batch.pop_front();
+
+        try {
+            pass(msg);
+        } catch (...) {
+            for (const auto &item : batch) {
+                drop(item);
+            }
+            throw;
+        }
+    }
+
+    return IPX_OK;
+}
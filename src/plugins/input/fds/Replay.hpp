@@ -0,0 +1,156 @@
+/**
+ * \file src/plugins/input/fds/Replay.hpp
+ * \author agent <agent@local>
+ * \brief Parallel replay of multiple FDS files
+ * \date 2026
+ */
+
+/* Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is'', and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#ifndef FDS_REPLAY_HPP
+#define FDS_REPLAY_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "config.h"
+#include "Reader.hpp"
+
+/**
+ * @brief Parallel replay of FDS files
+ *
+ * Reader threads take files from the list one by one and convert them to messages. Each thread
+ * has its own bounded queue of messages, which are passed to the pipeline by the instance
+ * thread in the configured order (see #fds_order), optionally paced by their Export Time
+ * (see the replay speed). Since each file has its own Transport
+ * Sessions, messages of different files can be processed by different parser threads.
+ */
+class Replay {
+public:
+    /**
+     * @brief Start reader threads
+     * @param[in] ctx   Plugin context (for log and message passing)
+     * @param[in] cfg   Parsed plugin configuration
+     * @param[in] files List of files to read
+     * @throw FDS_exception if the threads cannot be started
+     */
+    Replay(ipx_ctx_t *ctx, const fds_config *cfg, std::vector<std::string> files);
+    /**
+     * @brief Stop reader threads
+     * @note Messages that haven't been passed yet are dropped.
+     */
+    ~Replay();
+
+    /**
+     * @brief Pass the next message(s) to the pipeline
+     *
+     * If no message is ready, the function waits until a reader thread generates it.
+     * @return #IPX_OK on success
+     * @return #IPX_ERR_EOF if all files have been processed
+     * @throw FDS_exception in case of a failure (e.g. a reader thread failed)
+     */
+    int
+    pass_next();
+
+private:
+    /// Reader thread
+    struct Worker {
+        /// Thread
+        std::thread thread;
+        /// Generated messages (protected by the lock of the replay)
+        std::deque<ReaderMsg> queue;
+        /// All files have been processed by the thread (the queue can still be non-empty)
+        bool done = false;
+    };
+
+    /// Plugin context (log and passing messages)
+    ipx_ctx_t *m_ctx;
+    /// Plugin configuration
+    const fds_config *m_cfg;
+    /// List of files to read
+    std::vector<std::string> m_files;
+    /// Index of the next file to read (protected by the lock)
+    size_t m_next_file = 0;
+
+    /// Reader threads
+    std::vector<std::unique_ptr<Worker>> m_workers;
+    /// Index of the next thread to check (per-file order only)
+    size_t m_worker_idx = 0;
+    /// Protection of queues, the list of files and the error message
+    std::mutex m_lock;
+    /// Signalized when a queue is not full anymore or the threads should terminate
+    std::condition_variable m_cond_space;
+    /// Signalized when a message has been added to a queue or a thread has finished
+    std::condition_variable m_cond_data;
+    /// Terminate reader threads
+    std::atomic<bool> m_stop = {false};
+    /// Error message of a failed reader thread (empty, if there is no failure)
+    std::string m_error;
+
+    /// Export Time of the reference message of pacing (in seconds)
+    uint32_t m_pace_etime = 0;
+    /// Monotonic time of passing the reference message (in nanoseconds, 0 = not defined)
+    uint64_t m_pace_mono = 0;
+    /// Export Time of the last paced message (in seconds)
+    uint32_t m_pace_last = 0;
+
+    void
+    threads_stop();
+    void
+    worker_main(Worker *worker);
+    void
+    worker_push(Worker *worker, const ReaderMsg &msg);
+    bool
+    worker_file(std::string &path);
+
+    Worker *
+    select_file(bool &eof);
+    Worker *
+    select_time(bool &eof);
+    uint64_t
+    pace(const ReaderMsg &msg);
+    void
+    pass(const ReaderMsg &msg);
+    static void
+    drop(const ReaderMsg &msg);
+};
+
+#endif // FDS_REPLAY_HPP
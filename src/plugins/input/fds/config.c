@@ -39,15 +39,28 @@
  *
  */
 
+#define _GNU_SOURCE // strptime(), timegm()
+#include <errno.h>
+#include <inttypes.h>
 #include <stdlib.h>
 #include <limits.h>
+#include <math.h>
 #include <string.h>
+#include <strings.h>
+#include <time.h>
 #include "config.h"
 
 /*
  * <params>
  *  <path>...</path>      // required, exactly once
- *  <bufferSize>...</bufferSize>      // optional
+ *  <msgSize>...</msgSize>            // optional
+ *  <asyncIO>...</asyncIO>            // optional
+ *  <readerThreads>...</readerThreads> // optional
+ *  <order>...</order>                // optional
+ *  <timeFrom>...</timeFrom>          // optional
+ *  <timeTo>...</timeTo>              // optional
+ *  <odid>...</odid>                  // optional, multiple times
+ *  <replaySpeed>...</replaySpeed>    // optional
  * </params>
  */
 
@@ -55,12 +68,20 @@
 #define MSG_SIZE_DEF (32768U)
 /** Minimal message size */
 #define MSG_SIZE_MIN   (512U)
+/** Maximal number of reader threads */
+#define THREADS_MAX     (64U)
 
 /** XML nodes */
 enum params_xml_nodes {
     NODE_PATH = 1,
     NODE_MSIZE,
-    NODE_ASYNCIO
+    NODE_ASYNCIO,
+    NODE_THREADS,
+    NODE_ORDER,
+    NODE_TIME_FROM,
+    NODE_TIME_TO,
+    NODE_ODID,
+    NODE_SPEED
 };
 
 /** Definition of the \<params\> node  */
@@ -69,9 +90,111 @@ static const struct fds_xml_args args_params[] = {
     FDS_OPTS_ELEM(NODE_PATH,    "path",    FDS_OPTS_T_STRING, 0),
     FDS_OPTS_ELEM(NODE_MSIZE,   "msgSize", FDS_OPTS_T_UINT, FDS_OPTS_P_OPT),
     FDS_OPTS_ELEM(NODE_ASYNCIO, "asyncIO", FDS_OPTS_T_BOOL, FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM(NODE_THREADS, "readerThreads", FDS_OPTS_T_UINT, FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM(NODE_ORDER,   "order",   FDS_OPTS_T_STRING, FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM(NODE_TIME_FROM, "timeFrom", FDS_OPTS_T_STRING, FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM(NODE_TIME_TO,   "timeTo",   FDS_OPTS_T_STRING, FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM(NODE_ODID,    "odid",    FDS_OPTS_T_UINT, FDS_OPTS_P_OPT | FDS_OPTS_P_MULTI),
+    FDS_OPTS_ELEM(NODE_SPEED,   "replaySpeed", FDS_OPTS_T_STRING, FDS_OPTS_P_OPT),
     FDS_OPTS_END
 };
 
+/**
+ * \brief Parse a timestamp
+ *
+ * The timestamp is expected to be in UTC and in one of the following formats:
+ * "YYYY-MM-DD HH:MM:SS", "YYYY-MM-DD HH:MM", "YYYY-MM-DD", or number of seconds since
+ * UNIX epoch.
+ * \param[in]  str  String to parse
+ * \param[out] time Parsed timestamp (seconds since UNIX epoch)
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_FORMAT if the format is not valid
+ */
+static int
+config_parse_time(const char *str, uint32_t *time)
+{
+    static const char *formats[] = {"%Y-%m-%d %H:%M:%S", "%Y-%m-%d %H:%M", "%Y-%m-%d"};
+    struct tm tm;
+    char *end;
+
+    // Seconds since UNIX epoch
+    errno = 0;
+    unsigned long long value = strtoull(str, &end, 10);
+    if (end != str && *end == '\0' && errno == 0 && str[0] != '-') {
+        if (value > UINT32_MAX) {
+            return IPX_ERR_FORMAT;
+        }
+        *time = (uint32_t) value;
+        return IPX_OK;
+    }
+
+    for (size_t i = 0; i < sizeof(formats) / sizeof(formats[0]); ++i) {
+        memset(&tm, 0, sizeof(tm));
+        end = strptime(str, formats[i], &tm);
+        if (!end || *end != '\0') {
+            continue;
+        }
+
+        time_t value_tm = timegm(&tm);
+        if (value_tm < 0 || (unsigned long long) value_tm > UINT32_MAX) {
+            return IPX_ERR_FORMAT;
+        }
+        *time = (uint32_t) value_tm;
+        return IPX_OK;
+    }
+
+    return IPX_ERR_FORMAT;
+}
+
+/**
+ * \brief Parse replay speed
+ * \param[in]  str   String to parse ("max" or a positive number)
+ * \param[out] speed Parsed speed (0 for "max")
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_FORMAT if the format is not valid
+ */
+static int
+config_parse_speed(const char *str, double *speed)
+{
+    char *end;
+
+    if (strcasecmp(str, "max") == 0) {
+        *speed = 0;
+        return IPX_OK;
+    }
+
+    errno = 0;
+    double value = strtod(str, &end);
+    if (end == str || *end != '\0' || errno != 0 || !isfinite(value) || value <= 0) {
+        return IPX_ERR_FORMAT;
+    }
+
+    *speed = value;
+    return IPX_OK;
+}
+
+/**
+ * \brief Add an allowed Observation Domain ID
+ * \param[in] cfg  Configuration
+ * \param[in] odid Observation Domain ID
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_NOMEM on memory allocation error
+ */
+static int
+config_add_odid(struct fds_config *cfg, uint32_t odid)
+{
+    size_t alloc_size = (cfg->filter.odids_cnt + 1) * sizeof(*cfg->filter.odids);
+    uint32_t *new_odids = realloc(cfg->filter.odids, alloc_size);
+    if (!new_odids) {
+        return IPX_ERR_NOMEM;
+    }
+
+    new_odids[cfg->filter.odids_cnt] = odid;
+    cfg->filter.odids_cnt++;
+    cfg->filter.odids = new_odids;
+    return IPX_OK;
+}
+
 /**
  * \brief Process \<params\> node
  * \param[in] ctx  Plugin context
@@ -108,6 +231,57 @@ config_parser_root(ipx_ctx_t *ctx, fds_xml_ctx_t *root, struct fds_config *cfg)
             assert(content->type == FDS_OPTS_T_BOOL);
             cfg->async = content->val_bool;
             break;
+        case NODE_THREADS:
+            assert(content->type == FDS_OPTS_T_UINT);
+            if (content->val_uint < 1 || content->val_uint > THREADS_MAX) {
+                IPX_CTX_ERROR(ctx, "Number of reader threads must be between 1 and %u!",
+                    THREADS_MAX);
+                return IPX_ERR_FORMAT;
+            }
+            cfg->threads = (unsigned int) content->val_uint;
+            break;
+        case NODE_ORDER:
+            assert(content->type == FDS_OPTS_T_STRING);
+            if (strcasecmp(content->ptr_string, "file") == 0) {
+                cfg->order = FDS_ORDER_FILE;
+            } else if (strcasecmp(content->ptr_string, "time") == 0) {
+                cfg->order = FDS_ORDER_TIME;
+            } else {
+                IPX_CTX_ERROR(ctx, "Unknown order of messages '%s' (expected 'file' or 'time')!",
+                    content->ptr_string);
+                return IPX_ERR_FORMAT;
+            }
+            break;
+        case NODE_TIME_FROM:
+        case NODE_TIME_TO:
+            assert(content->type == FDS_OPTS_T_STRING);
+            if (config_parse_time(content->ptr_string, (content->id == NODE_TIME_FROM)
+                    ? &cfg->filter.time_from : &cfg->filter.time_to) != IPX_OK) {
+                IPX_CTX_ERROR(ctx, "Invalid timestamp '%s' (expected 'YYYY-MM-DD HH:MM:SS' in "
+                    "UTC or number of seconds since UNIX epoch)!", content->ptr_string);
+                return IPX_ERR_FORMAT;
+            }
+            break;
+        case NODE_ODID:
+            assert(content->type == FDS_OPTS_T_UINT);
+            if (content->val_uint > UINT32_MAX) {
+                IPX_CTX_ERROR(ctx, "Observation Domain ID must be at most %" PRIu32 "!",
+                    UINT32_MAX);
+                return IPX_ERR_FORMAT;
+            }
+            if (config_add_odid(cfg, (uint32_t) content->val_uint) != IPX_OK) {
+                IPX_CTX_ERROR(ctx, "Memory allocation error (%s:%d)", __FILE__, __LINE__);
+                return IPX_ERR_FORMAT;
+            }
+            break;
+        case NODE_SPEED:
+            assert(content->type == FDS_OPTS_T_STRING);
+            if (config_parse_speed(content->ptr_string, &cfg->speed) != IPX_OK) {
+                IPX_CTX_ERROR(ctx, "Invalid replay speed '%s' (expected 'max' or a positive "
+                    "number)!", content->ptr_string);
+                return IPX_ERR_FORMAT;
+            }
+            break;
         default:
             // Internal error
             assert(false);
@@ -119,6 +293,12 @@ config_parser_root(ipx_ctx_t *ctx, fds_xml_ctx_t *root, struct fds_config *cfg)
         return IPX_ERR_FORMAT;
     }
 
+    if (cfg->filter.time_from > cfg->filter.time_to) {
+        IPX_CTX_ERROR(ctx, "The beginning of the time range (timeFrom) must not be after its end "
+            "(timeTo)!", '\0');
+        return IPX_ERR_FORMAT;
+    }
+
     return IPX_OK;
 }
 
@@ -132,6 +312,13 @@ config_default_set(struct fds_config *cfg)
     cfg->path = NULL;
     cfg->msize = MSG_SIZE_DEF;
     cfg->async = true;
+    cfg->threads = 1;
+    cfg->order = FDS_ORDER_FILE;
+    cfg->speed = 0;
+    cfg->filter.time_from = 0;
+    cfg->filter.time_to = UINT32_MAX;
+    cfg->filter.odids = NULL;
+    cfg->filter.odids_cnt = 0;
 }
 
 struct fds_config *
@@ -183,6 +370,7 @@ config_parse(ipx_ctx_t *ctx, const char *params)
 void
 config_destroy(struct fds_config *cfg)
 {
+    free(cfg->filter.odids);
     free(cfg->path);
     free(cfg);
 }
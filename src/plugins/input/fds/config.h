@@ -44,11 +44,20 @@
 
 #include <ipfixcol2.h>
 #include "stdint.h"
+#include <stddef.h>
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+/** Order of messages of files read by multiple threads                                          */
+enum fds_order {
+    /** Messages of each file are passed in the original order, files are interleaved          */
+    FDS_ORDER_FILE,
+    /** Messages of all files being read are merged by their Export Time                        */
+    FDS_ORDER_TIME
+};
+
 /** Configuration of a instance of the IPFIX plugin                                              */
 struct fds_config {
     /** File pattern                                                                             */
@@ -57,6 +66,23 @@ struct fds_config {
     uint16_t msize;
     /** Enable asynchronous I/O                                                                  */
     bool async;
+    /** Number of reader threads (1 = files are read by the instance thread)                     */
+    unsigned int threads;
+    /** Order of messages (only for multiple reader threads)                                     */
+    enum fds_order order;
+    /** Replay speed as a multiple of Export Time (0 = as fast as possible)                     */
+    double speed;
+
+    struct {
+        /** Minimal Export Time of records (inclusive, seconds since UNIX epoch)                 */
+        uint32_t time_from;
+        /** Maximal Export Time of records (inclusive, seconds since UNIX epoch)                 */
+        uint32_t time_to;
+        /** Array of allowed Observation Domain IDs (NULL, if all ODIDs are allowed)             */
+        uint32_t *odids;
+        /** Number of allowed Observation Domain IDs                                             */
+        size_t odids_cnt;
+    } filter; /**< Filter of records to read                                                     */
 };
 
 /**
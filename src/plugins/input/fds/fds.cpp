@@ -49,10 +49,12 @@
 #include <memory>
 #include <netinet/in.h>
 #include <string>
+#include <vector>
 
 #include "config.h"
 #include "Exception.hpp"
 #include "Reader.hpp"
+#include "Replay.hpp"
 
 /// Plugin description
 IPX_API struct ipx_plugin_info ipx_plugin_info = {
@@ -84,6 +86,8 @@ struct Instance {
 
     // Current file reader
     std::unique_ptr<Reader> m_file = nullptr;
+    // Parallel replay of files (only if multiple reader threads are configured)
+    std::unique_ptr<Replay> m_replay = nullptr;
 };
 
 /**
@@ -155,6 +159,28 @@ file_list_clean(Instance *inst)
     globfree(&inst->m_list);
 }
 
+/**
+ * @brief Start parallel replay of all files in the list
+ *
+ * @param[in] inst Plugin instance
+ * @throw FDS_exception in case of a failure
+ */
+static void
+file_replay_init(Instance *inst)
+{
+    std::vector<std::string> files;
+
+    for (size_t i = 0; i < inst->m_list.gl_pathc; ++i) {
+        const char *filename = inst->m_list.gl_pathv[i];
+        if (file_is_dir(filename)) {
+            continue;
+        }
+        files.emplace_back(filename);
+    }
+
+    inst->m_replay.reset(new Replay(inst->m_ctx, inst->m_cfg.get(), std::move(files)));
+}
+
 /**
  * Open the next file for reading
  *
@@ -223,6 +249,15 @@ ipx_plugin_init(ipx_ctx_t *ctx, const char *params)
             throw FDS_exception("Failed to parse the instance configuration!");
         }
         file_list_init(inst.get(), inst->m_cfg->path);
+        if (inst->m_cfg->threads > 1 || inst->m_cfg->speed > 0) {
+            // Pacing is done by the instance thread, files are read by reader thread(s)
+            try {
+                file_replay_init(inst.get());
+            } catch (...) {
+                file_list_clean(inst.get());
+                throw;
+            }
+        }
         // Everything seems OK
         ipx_ctx_private_set(ctx, inst.release());
     } catch (const FDS_exception &ex) {
@@ -244,6 +279,7 @@ ipx_plugin_destroy(ipx_ctx_t *ctx, void *cfg)
 {
     try {
         auto *inst = reinterpret_cast<Instance *>(cfg);
+        inst->m_replay.reset();
         file_list_clean(inst);
         delete inst;
     } catch (...) {
@@ -257,6 +293,10 @@ ipx_plugin_get(ipx_ctx_t *ctx, void *cfg)
     // The plugin MUST NOT throw any exception!
     try {
         auto inst = reinterpret_cast<Instance *>(cfg);
+        if (inst->m_replay) {
+            // Files are read by reader threads
+            return inst->m_replay->pass_next();
+        }
 
         while (true) {
             // Try to send an IPFIX Message with batch of Data Records
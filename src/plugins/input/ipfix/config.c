@@ -39,26 +39,44 @@
  *
  */
 
+#include <errno.h>
+#include <math.h>
 #include <stdlib.h>
 #include <limits.h>
 #include <string.h>
+#include <strings.h>
 #include "config.h"
+#include "../../output/ipfix/block_reader.h"
 
 /*
  * <params>
  *  <path>...</path>      // required, exactly once
  *  <bufferSize>...</bufferSize>      // optional
+ *  <mmap>...</mmap>                  // optional
+ *  <prefetch>...</prefetch>          // optional
+ *  <replaySpeed>...</replaySpeed>    // optional
+ *  <timeFrom>...</timeFrom>          // optional
+ *  <timeTo>...</timeTo>              // optional
+ *  <decompressThreads>...</decompressThreads> // optional
  * </params>
  */
 
 /** Default buffer size */
 #define BSIZE_DEF (1048576U)
 #define BSIZE_MIN  (131072U)
+/** Default number of decompression threads */
+#define THREADS_DEF (2U)
 
 /** XML nodes */
 enum params_xml_nodes {
     NODE_PATH = 1,
-    NODE_BSIZE
+    NODE_BSIZE,
+    NODE_MMAP,
+    NODE_PREFETCH,
+    NODE_SPEED,
+    NODE_TIME_FROM,
+    NODE_TIME_TO,
+    NODE_THREADS
 };
 
 /** Definition of the \<params\> node  */
@@ -66,9 +84,42 @@ static const struct fds_xml_args args_params[] = {
     FDS_OPTS_ROOT("params"),
     FDS_OPTS_ELEM(NODE_PATH, "path", FDS_OPTS_T_STRING, 0),
     FDS_OPTS_ELEM(NODE_BSIZE, "bufferSize", FDS_OPTS_T_UINT, FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM(NODE_MMAP, "mmap", FDS_OPTS_T_BOOL, FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM(NODE_PREFETCH, "prefetch", FDS_OPTS_T_BOOL, FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM(NODE_SPEED, "replaySpeed", FDS_OPTS_T_STRING, FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM(NODE_TIME_FROM, "timeFrom", FDS_OPTS_T_UINT, FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM(NODE_TIME_TO, "timeTo", FDS_OPTS_T_UINT, FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM(NODE_THREADS, "decompressThreads", FDS_OPTS_T_UINT, FDS_OPTS_P_OPT),
     FDS_OPTS_END
 };
 
+/**
+ * \brief Parse replay speed
+ * \param[in]  str   String to parse ("max" or a positive number)
+ * \param[out] speed Parsed speed (0 for "max")
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_FORMAT if the format is not valid
+ */
+static int
+config_parse_speed(const char *str, double *speed)
+{
+    char *end;
+
+    if (strcasecmp(str, "max") == 0) {
+        *speed = 0;
+        return IPX_OK;
+    }
+
+    errno = 0;
+    double value = strtod(str, &end);
+    if (end == str || *end != '\0' || errno != 0 || !isfinite(value) || value <= 0) {
+        return IPX_ERR_FORMAT;
+    }
+
+    *speed = value;
+    return IPX_OK;
+}
+
 /**
  * \brief Process \<params\> node
  * \param[in] ctx  Plugin context
@@ -92,6 +143,45 @@ config_parser_root(ipx_ctx_t *ctx, fds_xml_ctx_t *root, struct ipfix_config *cfg
             assert(content->type == FDS_OPTS_T_UINT);
             cfg->bsize = content->val_uint;
             break;
+        case NODE_MMAP:
+            assert(content->type == FDS_OPTS_T_BOOL);
+            cfg->mmap = content->val_bool;
+            break;
+        case NODE_PREFETCH:
+            assert(content->type == FDS_OPTS_T_BOOL);
+            cfg->prefetch = content->val_bool;
+            break;
+        case NODE_SPEED:
+            assert(content->type == FDS_OPTS_T_STRING);
+            if (config_parse_speed(content->ptr_string, &cfg->speed) != IPX_OK) {
+                IPX_CTX_ERROR(ctx, "Invalid replay speed '%s' (expected 'max' or a positive "
+                    "number)!", content->ptr_string);
+                return IPX_ERR_FORMAT;
+            }
+            break;
+        case NODE_TIME_FROM:
+        case NODE_TIME_TO:
+            assert(content->type == FDS_OPTS_T_UINT);
+            if (content->val_uint > UINT32_MAX) {
+                IPX_CTX_ERROR(ctx, "Export Time range must be in seconds (32-bit unsigned)!",
+                    '\0');
+                return IPX_ERR_FORMAT;
+            }
+            if (content->id == NODE_TIME_FROM) {
+                cfg->time_from = (uint32_t) content->val_uint;
+            } else {
+                cfg->time_to = (uint32_t) content->val_uint;
+            }
+            break;
+        case NODE_THREADS:
+            assert(content->type == FDS_OPTS_T_UINT);
+            if (content->val_uint > BLOCK_READER_THREADS_MAX) {
+                IPX_CTX_ERROR(ctx, "Number of decompression threads must be at most %u!",
+                    (unsigned int) BLOCK_READER_THREADS_MAX);
+                return IPX_ERR_FORMAT;
+            }
+            cfg->threads = (unsigned int) content->val_uint;
+            break;
         default:
             // Internal error
             assert(false);
@@ -108,6 +198,11 @@ config_parser_root(ipx_ctx_t *ctx, fds_xml_ctx_t *root, struct ipfix_config *cfg
         return IPX_ERR_FORMAT;
     }
 
+    if (cfg->time_from > cfg->time_to) {
+        IPX_CTX_ERROR(ctx, "Start of the Export Time range is after its end!", '\0');
+        return IPX_ERR_FORMAT;
+    }
+
     return IPX_OK;
 }
 
@@ -120,6 +215,12 @@ config_default_set(struct ipfix_config *cfg)
 {
     cfg->path = NULL;
     cfg->bsize = BSIZE_DEF;
+    cfg->mmap = false;
+    cfg->prefetch = false;
+    cfg->speed = 0;
+    cfg->time_from = 0;
+    cfg->time_to = UINT32_MAX;
+    cfg->threads = THREADS_DEF;
 }
 
 struct ipfix_config *
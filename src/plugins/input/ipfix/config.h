@@ -52,6 +52,18 @@ struct ipfix_config {
     char *path;
     /** Read buffer size                                                                         */
     uint64_t bsize;
+    /** Map files into memory instead of reading them into the buffer                           */
+    bool mmap;
+    /** Prefetch the next file in the list into the page cache                                  */
+    bool prefetch;
+    /** Replay speed as a multiple of Export Time (0 = as fast as possible)                     */
+    double speed;
+    /** First Export Time of IPFIX Messages to read (inclusive, in seconds)                     */
+    uint32_t time_from;
+    /** Last Export Time of IPFIX Messages to read (inclusive, in seconds)                      */
+    uint32_t time_to;
+    /** Number of threads decompressing blocks of compressed files (0 = the plugin thread)     */
+    unsigned int threads;
 };
 
 /**
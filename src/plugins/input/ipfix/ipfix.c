@@ -40,12 +40,16 @@
  */
 
 #include <errno.h>
+#include <fcntl.h>
 #include <glob.h>
 #include <ipfixcol2.h>
 #include <stdlib.h>
 #include <stdio.h>  // fopen, fclose
+#include <time.h>
+#include <unistd.h>
 
 #include "config.h"
+#include "../../output/ipfix/block_reader.h"
 
 /// Plugin description
 IPX_API struct ipx_plugin_info ipx_plugin_info = {
@@ -63,6 +67,11 @@ IPX_API struct ipx_plugin_info ipx_plugin_info = {
     .ipx_min = "2.2.0"
 };
 
+/// Maximal duration of a single wait for the time of the next message (in nanoseconds)
+#define REPLAY_WAIT_MAX (100000000ULL)
+/// Maximal jump of Export Time back in time that doesn't restart pacing (in seconds)
+#define REPLAY_BACK_MAX (60)
+
 /// Plugin instance data
 struct plugin_data {
     /// Plugin context (log only!)
@@ -90,6 +99,27 @@ struct plugin_data {
     size_t buffer_valid;
     /// Position of the reader in the buffer
     size_t buffer_offset;
+
+    /// Mapping of the current file (NULL, if the file is read into the buffer)
+    ipx_utils_fmap_t *map;
+    /// Size of the mapping
+    size_t map_size;
+    /// Position of the reader in the mapping
+    size_t map_offset;
+
+    /// Reader of the current block-compressed file (NULL, if the file is not compressed)
+    block_reader_t *blocks;
+
+    struct {
+        /// Message waiting for its time to be passed (NULL, if none)
+        ipx_msg_ipfix_t *pending;
+        /// Export Time of the reference message (in seconds)
+        uint32_t ref_etime;
+        /// Monotonic time of passing the reference message (in nanoseconds, 0 = not defined)
+        uint64_t ref_mono;
+        /// Export Time of the last passed message (in seconds)
+        uint32_t last_etime;
+    } replay; ///< Pacing of messages (only if replay speed is limited)
 };
 
 /**
@@ -266,6 +296,33 @@ session_close(ipx_ctx_t *ctx, struct ipx_session *session)
     }
 }
 
+/**
+ * @brief Prefetch the next file in the list into the page cache
+ *
+ * The kernel is asked to start asynchronous reading of the whole file, so the file is
+ * (at least partly) ready when the plugin opens it. Failures are silently ignored.
+ * @param[in] data Plugin data
+ */
+static void
+file_prefetch(struct plugin_data *data)
+{
+    for (size_t idx = data->file_next_idx; idx < data->file_list.gl_pathc; ++idx) {
+        const char *name = data->file_list.gl_pathv[idx];
+        if (filename_is_dir(name)) {
+            continue;
+        }
+
+        int fd = open(name, O_RDONLY);
+        if (fd == -1) {
+            return;
+        }
+
+        (void) posix_fadvise(fd, 0, 0, POSIX_FADV_WILLNEED);
+        close(fd);
+        return;
+    }
+}
+
 /**
  * @brief Open the next file for reading
  *
@@ -291,10 +348,16 @@ next_file(struct plugin_data *data)
     size_t idx_max = data->file_list.gl_pathc;
     FILE *file_new = NULL;
     const char *name_new = NULL;
+    block_reader_t *blocks_new = NULL;
 
     // Signalize close of the current Transport Session
     session_close(data->ctx, data->current_ts);
     data->current_ts = NULL;
+    // Messages can still refer to the mapping, it's released after the last of them
+    ipx_utils_fmap_destroy(data->map);
+    data->map = NULL;
+    block_reader_close(data->blocks);
+    data->blocks = NULL;
     if (data->current_file) {
         fclose(data->current_file);
         data->current_file = NULL;
@@ -316,6 +379,21 @@ next_file(struct plugin_data *data)
             continue;
         }
 
+        if (block_reader_detect(fileno(file_new))) {
+            // Compressed by the IPFIX output plugin, blocks are selected by the seek index
+            const char *err_str = NULL;
+            blocks_new = block_reader_open(fileno(file_new), data->cfg->time_from,
+                data->cfg->time_to, data->cfg->threads, &err_str);
+            if (!blocks_new) {
+                IPX_CTX_ERROR(data->ctx, "Skipping compressed file '%s' (%s)", name_new, err_str);
+                fclose(file_new);
+                file_new = NULL;
+                continue;
+            }
+
+            break;
+        }
+
         struct fds_ipfix_msg_hdr ipfix_hdr;
         if (fread(&ipfix_hdr, FDS_IPFIX_MSG_HDR_LEN, 1, file_new) != 1
                 || ntohs(ipfix_hdr.version) != FDS_IPFIX_VERSION
@@ -339,6 +417,7 @@ next_file(struct plugin_data *data)
     // Signalize open of the new Transport Session
     data->current_ts = session_open(data->ctx, name_new);
     if (!data->current_ts) {
+        block_reader_close(blocks_new);
         fclose(file_new);
         return IPX_ERR_NOMEM;
     }
@@ -349,6 +428,36 @@ next_file(struct plugin_data *data)
 
     data->buffer_valid = 0;
     data->buffer_offset = 0;
+
+    if (blocks_new) {
+        size_t blocks_selected, blocks_total;
+        bool indexed;
+
+        block_reader_blocks(blocks_new, &blocks_selected, &blocks_total, &indexed);
+        if (indexed) {
+            IPX_CTX_INFO(data->ctx, "%zu of %zu compressed block(s) selected by the seek index",
+                blocks_selected, blocks_total);
+        } else {
+            IPX_CTX_WARNING(data->ctx, "File '%s' has no seek index (not properly closed?), "
+                "all %zu compressed block(s) will be read", name_new, blocks_total);
+        }
+
+        data->blocks = blocks_new;
+    } else if (data->cfg->mmap) {
+        data->map = ipx_utils_fmap_create(fileno(file_new), &data->map_size);
+        data->map_offset = 0;
+        if (!data->map) {
+            const char *err_str;
+            ipx_strerror(errno, err_str);
+            IPX_CTX_WARNING(data->ctx, "Unable to map '%s' into memory (%s), the file will be "
+                "read into the buffer.", name_new, err_str);
+        }
+    }
+
+    if (data->cfg->prefetch) {
+        file_prefetch(data);
+    }
+
     return IPX_OK;
 }
 
@@ -416,30 +525,23 @@ next_chunk(struct plugin_data *data, uint8_t *out, uint16_t out_size)
 }
 
 /**
- * @brief Get the next IPFIX Message from currently opened file
+ * @brief Get the next raw IPFIX Message from the file read into the buffer
  *
  * @param[in]  data Plugin data
- * @param[out] msg  IPFIX Message extracted from the file
+ * @param[out] raw  Copy of the IPFIX Message (allocated by ipx_utils_buf_alloc())
  * @return #IPX_OK on success
  * @return #IPX_ERR_EOF if the end-of-file has been reached
  * @return #IPX_ERR_FORMAT if the file is malformed
  * @return #IPX_ERR_NOMEM in case of a memory allocation error
  */
 static int
-next_message(struct plugin_data *data, ipx_msg_ipfix_t **msg)
+next_raw_read(struct plugin_data *data, uint8_t **raw)
 {
     struct fds_ipfix_msg_hdr ipfix_hdr;
     uint16_t ipfix_size;
     uint8_t *ipfix_data = NULL;
-
-    struct ipx_msg_ctx ipfix_ctx;
-    ipx_msg_ipfix_t *ipfix_msg;
     int ret;
 
-    if (!data->current_file) {
-        return IPX_ERR_EOF;
-    }
-
     // Get the IPFIX Message header
     ret = next_chunk(data, (uint8_t *) &ipfix_hdr, FDS_IPFIX_MSG_HDR_LEN);
     if (ret != IPX_OK) {
@@ -458,7 +560,7 @@ next_message(struct plugin_data *data, ipx_msg_ipfix_t **msg)
         return IPX_ERR_FORMAT;
     }
 
-    ipfix_data = malloc(ipfix_size);
+    ipfix_data = ipx_utils_buf_alloc(ipfix_size);
     if (!ipfix_data) {
         IPX_CTX_ERROR(data->ctx, "Memory allocation failed! (%s:%d)", __FILE__, __LINE__);
         return IPX_ERR_NOMEM;
@@ -473,21 +575,160 @@ next_message(struct plugin_data *data, ipx_msg_ipfix_t **msg)
         if (next_chunk(data, data_ptr, size_remain) != IPX_OK) {
             IPX_CTX_ERROR(data->ctx, "File '%s' is corrupted (unexpected end of file)!",
                 data->current_name);
-            free(ipfix_data);
+            ipx_utils_buf_free(ipfix_data);
             return IPX_ERR_FORMAT;
         }
     }
 
-    // Wrap the IPFIX Message
+    *raw = ipfix_data;
+    return IPX_OK;
+}
+
+/**
+ * @brief Get the next raw IPFIX Message from the mapped file
+ *
+ * The message is not copied, it's a slice of the mapping instead.
+ * @param[in]  data Plugin data
+ * @param[out] raw  IPFIX Message (slice of the mapping, must be released by ipx_utils_buf_free())
+ * @return #IPX_OK on success
+ * @return #IPX_ERR_EOF if the end-of-file has been reached
+ * @return #IPX_ERR_FORMAT if the file is malformed
+ */
+static int
+next_raw_map(struct plugin_data *data, uint8_t **raw)
+{
+    const uint8_t *msg_ptr = ipx_utils_fmap_data(data->map) + data->map_offset;
+    size_t avail = data->map_size - data->map_offset;
+    struct fds_ipfix_msg_hdr ipfix_hdr;
+    uint16_t ipfix_size;
+
+    if (avail == 0) {
+        return IPX_ERR_EOF;
+    }
+
+    if (avail < FDS_IPFIX_MSG_HDR_LEN) {
+        IPX_CTX_ERROR(data->ctx, "File '%s' is corrupted (unexpected end of file)!",
+            data->current_name);
+        return IPX_ERR_FORMAT;
+    }
+
+    // The header might not be aligned
+    memcpy(&ipfix_hdr, msg_ptr, FDS_IPFIX_MSG_HDR_LEN);
+    ipfix_size = ntohs(ipfix_hdr.length);
+    if (ntohs(ipfix_hdr.version) != FDS_IPFIX_VERSION
+            || ipfix_size < FDS_IPFIX_MSG_HDR_LEN) {
+        IPX_CTX_ERROR(data->ctx, "File '%s' is corrupted (unexpected data)!", data->current_name);
+        return IPX_ERR_FORMAT;
+    }
+
+    if (ipfix_size > avail) {
+        IPX_CTX_ERROR(data->ctx, "File '%s' is corrupted (unexpected end of file)!",
+            data->current_name);
+        return IPX_ERR_FORMAT;
+    }
+
+    *raw = ipx_utils_fmap_slice(data->map, msg_ptr);
+    data->map_offset += ipfix_size;
+    return IPX_OK;
+}
+
+/**
+ * @brief Get the next raw IPFIX Message from the block-compressed file
+ *
+ * Blocks are decompressed ahead by threads of the block reader, the message is copied from
+ * the decompressed block.
+ * @param[in]  data Plugin data
+ * @param[out] raw  Copy of the IPFIX Message (allocated by ipx_utils_buf_alloc())
+ * @return #IPX_OK on success
+ * @return #IPX_ERR_EOF if the end-of-file has been reached
+ * @return #IPX_ERR_FORMAT if the file is malformed
+ * @return #IPX_ERR_NOMEM in case of a memory allocation error
+ */
+static int
+next_raw_blocks(struct plugin_data *data, uint8_t **raw)
+{
+    const uint8_t *msg_ptr;
+    uint16_t msg_size;
+    const char *err_str = NULL;
+
+    switch (block_reader_next(data->blocks, &msg_ptr, &msg_size, &err_str)) {
+    case BLOCK_READER_OK:
+        break;
+    case BLOCK_READER_EOF:
+        return IPX_ERR_EOF;
+    default:
+        IPX_CTX_ERROR(data->ctx, "File '%s' is corrupted (%s)!", data->current_name, err_str);
+        return IPX_ERR_FORMAT;
+    }
+
+    uint8_t *ipfix_data = ipx_utils_buf_alloc(msg_size);
+    if (!ipfix_data) {
+        IPX_CTX_ERROR(data->ctx, "Memory allocation failed! (%s:%d)", __FILE__, __LINE__);
+        return IPX_ERR_NOMEM;
+    }
+
+    memcpy(ipfix_data, msg_ptr, msg_size);
+    *raw = ipfix_data;
+    return IPX_OK;
+}
+
+/**
+ * @brief Get the next IPFIX Message from currently opened file
+ *
+ * @param[in]  data Plugin data
+ * @param[out] msg  IPFIX Message extracted from the file
+ * @return #IPX_OK on success
+ * @return #IPX_ERR_EOF if the end-of-file has been reached
+ * @return #IPX_ERR_FORMAT if the file is malformed
+ * @return #IPX_ERR_NOMEM in case of a memory allocation error
+ */
+static int
+next_message(struct plugin_data *data, ipx_msg_ipfix_t **msg)
+{
+    uint8_t *ipfix_data = NULL;
+    struct fds_ipfix_msg_hdr ipfix_hdr;
+    struct ipx_msg_ctx ipfix_ctx;
+    ipx_msg_ipfix_t *ipfix_msg;
+    int ret;
+
+    if (!data->current_file) {
+        return IPX_ERR_EOF;
+    }
+
+    while (true) {
+        if (data->blocks != NULL) {
+            ret = next_raw_blocks(data, &ipfix_data);
+        } else if (data->map != NULL) {
+            ret = next_raw_map(data, &ipfix_data);
+        } else {
+            ret = next_raw_read(data, &ipfix_data);
+        }
+
+        if (ret != IPX_OK) {
+            return ret;
+        }
+
+        // Skip messages out of the Export Time range (the block reader skips them itself)
+        memcpy(&ipfix_hdr, ipfix_data, FDS_IPFIX_MSG_HDR_LEN);
+        uint32_t etime = ntohl(ipfix_hdr.export_time);
+        if (data->blocks != NULL
+                || (etime >= data->cfg->time_from && etime <= data->cfg->time_to)) {
+            break;
+        }
+
+        ipx_utils_buf_free(ipfix_data);
+    }
+
+    // Wrap the IPFIX Message (a message in the mapping might not be aligned)
     memset(&ipfix_ctx, 0, sizeof(ipfix_ctx));
     ipfix_ctx.session = data->current_ts;
     ipfix_ctx.odid = ntohl(ipfix_hdr.odid);
     ipfix_ctx.stream = 0;
 
-    ipfix_msg = ipx_msg_ipfix_create(data->ctx, &ipfix_ctx, ipfix_data, ipfix_size);
+    ipfix_msg = ipx_msg_ipfix_create(data->ctx, &ipfix_ctx, ipfix_data, ntohs(ipfix_hdr.length));
     if (!ipfix_msg) {
         IPX_CTX_ERROR(data->ctx, "Memory allocation failed! (%s:%d)", __FILE__, __LINE__);
-        free(ipfix_data);
+        ipx_utils_buf_free(ipfix_data);
         return IPX_ERR_NOMEM;
     }
 
@@ -495,6 +736,45 @@ next_message(struct plugin_data *data, ipx_msg_ipfix_t **msg)
     return IPX_OK;
 }
 
+/**
+ * @brief Get remaining time before a message can be passed (rate-paced replay)
+ *
+ * Messages are paced by their Export Time relative to the reference message scaled by the
+ * configured replay speed. If the Export Time jumps significantly back in time (e.g. a new
+ * file), the message becomes the new reference.
+ * @param[in] data Plugin data
+ * @param[in] msg  IPFIX Message to pass
+ * @return Remaining time (in nanoseconds) or 0, if the message can be passed right now
+ */
+static uint64_t
+replay_delay(struct plugin_data *data, ipx_msg_ipfix_t *msg)
+{
+    struct fds_ipfix_msg_hdr ipfix_hdr;
+    struct timespec ts;
+    uint64_t now;
+    uint32_t etime;
+
+    memcpy(&ipfix_hdr, ipx_msg_ipfix_get_packet(msg), FDS_IPFIX_MSG_HDR_LEN);
+    etime = ntohl(ipfix_hdr.export_time);
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    now = (uint64_t) ts.tv_sec * 1000000000ULL + (uint64_t) ts.tv_nsec;
+
+    if (data->replay.ref_mono == 0
+            || (int64_t) etime + REPLAY_BACK_MAX < (int64_t) data->replay.last_etime) {
+        data->replay.ref_etime = etime;
+        data->replay.ref_mono = now;
+    }
+
+    double offset = ((double) etime - (double) data->replay.ref_etime) * 1e9 / data->cfg->speed;
+    double target = (double) data->replay.ref_mono + offset;
+    if (target > (double) now) {
+        return (uint64_t) (target - (double) now) + 1;
+    }
+
+    data->replay.last_etime = etime;
+    return 0;
+}
+
 // -------------------------------------------------------------------------------------------------
 
 int
@@ -541,7 +821,12 @@ ipx_plugin_destroy(ipx_ctx_t *ctx, void *cfg)
     struct plugin_data *data = (struct plugin_data *) cfg;
 
     // Close the current session and file
+    if (data->replay.pending) {
+        ipx_msg_ipfix_destroy(data->replay.pending);
+    }
     session_close(ctx, data->current_ts);
+    ipx_utils_fmap_destroy(data->map);
+    block_reader_close(data->blocks);
     if (data->current_file) {
         fclose(data->current_file);
     }
@@ -560,9 +845,30 @@ ipx_plugin_get(ipx_ctx_t *ctx, void *cfg)
     ipx_msg_ipfix_t *msg2send;
 
     while (true) {
-        // Get a new message from the currently opened file
-        switch (next_message(data, &msg2send)) {
+        // Get a new message from the currently opened file (or the one waiting for its time)
+        int ret = IPX_OK;
+        msg2send = data->replay.pending;
+        data->replay.pending = NULL;
+        if (!msg2send) {
+            ret = next_message(data, &msg2send);
+        }
+
+        switch (ret) {
         case IPX_OK:
+            if (data->cfg->speed > 0) {
+                uint64_t delay = replay_delay(data, msg2send);
+                if (delay > 0) {
+                    // Wait only for a while, so the plugin can be terminated anytime
+                    struct timespec ts;
+                    delay = (delay < REPLAY_WAIT_MAX) ? delay : REPLAY_WAIT_MAX;
+                    ts.tv_sec = (time_t) (delay / 1000000000ULL);
+                    ts.tv_nsec = (long) (delay % 1000000000ULL);
+                    data->replay.pending = msg2send;
+                    nanosleep(&ts, NULL);
+                    return IPX_OK;
+                }
+            }
+
             ipx_ctx_msg_pass(ctx, ipx_msg_ipfix2base(msg2send));
             return IPX_OK;
         case IPX_ERR_EOF:
@@ -598,8 +904,14 @@ ipx_plugin_session_close(ipx_ctx_t *ctx, void *cfg, const struct ipx_session *se
         return;
     }
 
-    // Close the current session and file
+    // Close the current session and file (the waiting message belongs to the session)
+    if (data->replay.pending) {
+        ipx_msg_ipfix_destroy(data->replay.pending);
+        data->replay.pending = NULL;
+    }
     session_close(ctx, data->current_ts);
+    ipx_utils_fmap_destroy(data->map);
+    block_reader_close(data->blocks);
     if (data->current_file) {
         fclose(data->current_file);
     }
@@ -607,4 +919,6 @@ ipx_plugin_session_close(ipx_ctx_t *ctx, void *cfg, const struct ipx_session *se
     data->current_ts = NULL;
     data->current_file = NULL;
     data->current_name = NULL;
+    data->map = NULL;
+    data->blocks = NULL;
 }
\ No newline at end of file
@@ -0,0 +1,243 @@
+/**
+ * \file src/plugins/input/sctp/config.c
+ * \author agent <agent@local>
+ * \brief Configuration parser of SCTP input plugin (source file)
+ * \date 2026
+ */
+
+/* Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is'', and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <arpa/inet.h>
+#include "config.h"
+
+/** Default maximum number of messages received at once                                         */
+#define BATCH_SIZE_DEF (32)
+/** Maximum number of messages received at once                                                 */
+#define BATCH_SIZE_MAX (1024)
+
+/*
+ * <params>
+ *  <localPort>...</localPort>                    <!-- optional                  -->
+ *  <localIPAddress>...</localIPAddress>          <!-- optional, multiple times  -->
+ *  <streams>...</streams>                        <!-- optional                  -->
+ *  <batchSize>...</batchSize>                    <!-- optional                  -->
+ * </params>
+ */
+
+/** XML nodes */
+enum params_xml_nodes {
+    NODE_PORT = 1,
+    NODE_IPADDR,
+    NODE_STREAMS,
+    NODE_BATCH
+};
+
+/** Definition of the \<params\> node  */
+static const struct fds_xml_args args_params[] = {
+    FDS_OPTS_ROOT("params"),
+    FDS_OPTS_ELEM(NODE_PORT,    "localPort",      FDS_OPTS_T_UINT,   FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM(NODE_IPADDR,  "localIPAddress", FDS_OPTS_T_STRING, FDS_OPTS_P_OPT | FDS_OPTS_P_MULTI),
+    FDS_OPTS_ELEM(NODE_STREAMS, "streams",        FDS_OPTS_T_UINT,   FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM(NODE_BATCH,   "batchSize",      FDS_OPTS_T_UINT,   FDS_OPTS_P_OPT),
+    FDS_OPTS_END
+};
+
+/**
+ * \brief Add a local IP address
+ *
+ * \note An empty address is ignored and success is returned!
+ * \param[in] ctx  Instance context
+ * \param[in] cfg  Configuration
+ * \param[in] addr IPv4/IPv6 address to add
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_FORMAT if the address is malformed
+ */
+static int
+config_add_addr(ipx_ctx_t *ctx, struct sctp_config *cfg, const char *addr)
+{
+    struct sctp_ipaddr_rec rec;
+
+    if (strlen(addr) == 0) {
+        return IPX_OK;
+    }
+
+    // Try to convert IP address
+    if (inet_pton(AF_INET, addr, &rec.ipv4) == 1) {
+        rec.ip_ver = AF_INET;
+    } else if (inet_pton(AF_INET6, addr, &rec.ipv6) == 1) {
+        rec.ip_ver = AF_INET6;
+    } else {
+        IPX_CTX_ERROR(ctx, "'%s' is not a valid IPv4/IPv6 address!", addr);
+        return IPX_ERR_FORMAT;
+    }
+
+    // Add the record
+    size_t alloc_size = (cfg->local_addrs.cnt + 1) * sizeof(struct sctp_ipaddr_rec);
+    struct sctp_ipaddr_rec *new_addrs = realloc(cfg->local_addrs.addrs, alloc_size);
+    if (!new_addrs) {
+        IPX_CTX_ERROR(ctx, "Memory allocation failed! (%s:%d)", __FILE__, __LINE__);
+        return IPX_ERR_FORMAT;
+    }
+
+    new_addrs[cfg->local_addrs.cnt] = rec;
+    cfg->local_addrs.cnt++;
+    cfg->local_addrs.addrs = new_addrs;
+    return IPX_OK;
+}
+
+/**
+ * \brief Process \<params\> node
+ * \param[in] ctx  Plugin context
+ * \param[in] root XML context to process
+ * \param[in] cfg  Parsed configuration
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_FORMAT in case of failure
+ */
+static int
+config_parser_root(ipx_ctx_t *ctx, fds_xml_ctx_t *root, struct sctp_config *cfg)
+{
+    const struct fds_xml_cont *content;
+    while (fds_xml_next(root, &content) != FDS_EOC) {
+        switch (content->id) {
+        case NODE_PORT:
+            // Local port
+            assert(content->type == FDS_OPTS_T_UINT);
+            if (content->val_uint > UINT16_MAX) {
+                IPX_CTX_ERROR(ctx, "Local port value must be between 0..65535", '\0');
+                return IPX_ERR_FORMAT;
+            }
+            cfg->local_port = (uint16_t) content->val_uint;
+            break;
+        case NODE_IPADDR:
+            // Local IP address
+            assert(content->type == FDS_OPTS_T_STRING);
+            if (config_add_addr(ctx, cfg, content->ptr_string) != IPX_OK) {
+                return IPX_ERR_FORMAT;
+            }
+            break;
+        case NODE_STREAMS:
+            // Maximum number of inbound streams
+            assert(content->type == FDS_OPTS_T_UINT);
+            if (content->val_uint < 1 || content->val_uint > UINT16_MAX) {
+                IPX_CTX_ERROR(ctx, "Number of streams must be between 1..65535", '\0');
+                return IPX_ERR_FORMAT;
+            }
+            cfg->streams = (uint16_t) content->val_uint;
+            break;
+        case NODE_BATCH:
+            // Maximum number of messages received at once
+            assert(content->type == FDS_OPTS_T_UINT);
+            if (content->val_uint < 1 || content->val_uint > BATCH_SIZE_MAX) {
+                IPX_CTX_ERROR(ctx, "Batch size must be between 1..%u", (unsigned) BATCH_SIZE_MAX);
+                return IPX_ERR_FORMAT;
+            }
+            cfg->batch_size = (uint16_t) content->val_uint;
+            break;
+        default:
+            // Internal error
+            assert(false);
+        }
+    }
+
+    return IPX_OK;
+}
+
+/**
+ * \brief Set default parameters of the configuration
+ * \param[in] cfg Configuration
+ */
+static void
+config_default_set(struct sctp_config *cfg)
+{
+    cfg->local_port = 4739; // Default port
+    cfg->local_addrs.cnt = 0;
+    cfg->streams = 0;
+    cfg->batch_size = BATCH_SIZE_DEF;
+}
+
+struct sctp_config *
+config_parse(ipx_ctx_t *ctx, const char *params)
+{
+    struct sctp_config *cfg = calloc(1, sizeof(*cfg));
+    if (!cfg) {
+        IPX_CTX_ERROR(ctx, "Memory allocation error (%s:%d)", __FILE__, __LINE__);
+        return NULL;
+    }
+
+    // Set default parameters
+    config_default_set(cfg);
+
+    // Create an XML parser
+    fds_xml_t *parser = fds_xml_create();
+    if (!parser) {
+        IPX_CTX_ERROR(ctx, "Memory allocation error (%s:%d)", __FILE__, __LINE__);
+        config_destroy(cfg);
+        return NULL;
+    }
+
+    if (fds_xml_set_args(parser, args_params) != IPX_OK) {
+        IPX_CTX_ERROR(ctx, "Failed to parse the description of an XML document!", '\0');
+        fds_xml_destroy(parser);
+        config_destroy(cfg);
+        return NULL;
+    }
+
+    fds_xml_ctx_t *params_ctx = fds_xml_parse_mem(parser, params, true);
+    if (params_ctx == NULL) {
+        IPX_CTX_ERROR(ctx, "Failed to parse the configuration: %s", fds_xml_last_err(parser));
+        fds_xml_destroy(parser);
+        config_destroy(cfg);
+        return NULL;
+    }
+
+    // Parse parameters
+    int rc = config_parser_root(ctx, params_ctx, cfg);
+    fds_xml_destroy(parser);
+    if (rc != IPX_OK) {
+        config_destroy(cfg);
+        return NULL;
+    }
+
+    return cfg;
+}
+
+void
+config_destroy(struct sctp_config *cfg)
+{
+    free(cfg->local_addrs.addrs);
+    free(cfg);
+}
@@ -0,0 +1,909 @@
+/**
+ * \file src/plugins/input/sctp/sctp.c
+ * \author agent <agent@local>
+ * \brief SCTP input plugin for IPFIXcol
+ * \date 2026
+ */
+
+/* Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is'', and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#define _GNU_SOURCE
+#include <ipfixcol2.h>
+
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <linux/sctp.h>
+#include <poll.h>
+#include <unistd.h>
+
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <inttypes.h>
+#include "config.h"
+
+/** Identification of an invalid socket descriptor                                               */
+#define INVALID_FD        (-1)
+/** Number of outstanding associations in the socket's listen queue                             */
+#define LISTEN_BACKLOG    (SOMAXCONN)
+/** Timeout for a getter operation - i.e. poll timeout (in milliseconds)                         */
+#define GETTER_TIMEOUT    (10)
+/** Size of a receive buffer (i.e. max. size of an IPFIX Message)                                */
+#define BATCH_SLOT_SIZE   (UINT16_MAX)
+/** Size of a buffer for control messages of a received message                                 */
+#define BATCH_CTRL_SIZE   (CMSG_SPACE(sizeof(struct sctp_sndrcvinfo)))
+/** Size of a buffer for addresses of an association                                             */
+#define ADDRS_BUFFER_SIZE (1024U)
+
+/** Plugin description */
+IPX_API struct ipx_plugin_info ipx_plugin_info = {
+    // Plugin type
+    .type = IPX_PT_INPUT,
+    // Plugin identification name
+    .name = "sctp",
+    // Brief description of plugin
+    .dsc = "Input plugin for IPFIX/NetFlow v9 over Stream Control Transmission Protocol.",
+    // Configuration flags (reserved for future use)
+    .flags = 0,
+    // Plugin version string (like "1.2.3")
+    .version = "2.0.0",
+    // Minimal IPFIXcol version string (like "1.2.3")
+    .ipx_min = "2.0.0"
+};
+
+/** Association with an exporter                                                                 */
+struct sctp_assoc {
+    /** Identification of the association (assigned by the kernel)                               */
+    sctp_assoc_t id;
+    /** Description of the Transport Session                                                     */
+    struct ipx_session *session;
+    /** No message has been received from the Session yet                                        */
+    bool new_connection;
+    /** The rest of a message that doesn't fit into a receive buffer is being skipped           */
+    bool skip;
+};
+
+/** Batch of receive buffers (i.e. messages received by one recvmmsg() call)                     */
+struct sctp_batch {
+    /** Number of slots                                                                          */
+    unsigned int cnt;
+    /** Message headers                                                                          */
+    struct mmsghdr *hdrs;
+    /** Data buffers of the slots                                                                */
+    struct iovec *iovs;
+    /** Buffers for control messages (i.e. stream and association of a message)                  */
+    uint8_t *ctrl;
+};
+
+/** Instance data                                                                                */
+struct sctp_data {
+    /** Instance context                                                                         */
+    ipx_ctx_t *ctx;
+    /** Parsed configuration                                                                     */
+    struct sctp_config *config;
+    /** Listening one-to-many socket (i.e. all associations are received by this socket)         */
+    int sd;
+    /** Receive buffers                                                                          */
+    struct sctp_batch batch;
+
+    struct {
+        /** Number of active associations                                                        */
+        size_t cnt;
+        /** Array of active associations                                                         */
+        struct sctp_assoc *arr;
+    } assocs; /**< Active associations                                                           */
+};
+
+/**
+ * \brief Initialize receive buffers
+ * \param[in] data Instance data
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_NOMEM on a memory allocation error
+ */
+static int
+batch_init(struct sctp_data *data)
+{
+    struct sctp_batch *batch = &data->batch;
+    const unsigned int cnt = data->config->batch_size;
+
+    batch->cnt = cnt;
+    batch->hdrs = calloc(cnt, sizeof(*batch->hdrs));
+    batch->iovs = calloc(cnt, sizeof(*batch->iovs));
+    batch->ctrl = calloc(cnt, BATCH_CTRL_SIZE);
+    if (!batch->hdrs || !batch->iovs || !batch->ctrl) {
+        IPX_CTX_ERROR(data->ctx, "Memory allocation failed! (%s:%d)", __FILE__, __LINE__);
+        return IPX_ERR_NOMEM;
+    }
+
+    for (unsigned int i = 0; i < cnt; ++i) {
+        batch->iovs[i].iov_base = malloc(BATCH_SLOT_SIZE);
+        if (!batch->iovs[i].iov_base) {
+            IPX_CTX_ERROR(data->ctx, "Memory allocation failed! (%s:%d)", __FILE__, __LINE__);
+            return IPX_ERR_NOMEM;
+        }
+
+        struct msghdr *msg = &batch->hdrs[i].msg_hdr;
+        msg->msg_iov = &batch->iovs[i];
+        msg->msg_iovlen = 1;
+        msg->msg_control = &batch->ctrl[i * BATCH_CTRL_SIZE];
+    }
+
+    return IPX_OK;
+}
+
+/**
+ * \brief Destroy receive buffers
+ * \param[in] data Instance data
+ */
+static void
+batch_destroy(struct sctp_data *data)
+{
+    struct sctp_batch *batch = &data->batch;
+    if (batch->iovs != NULL) {
+        for (unsigned int i = 0; i < batch->cnt; ++i) {
+            free(batch->iovs[i].iov_base);
+        }
+    }
+
+    free(batch->hdrs);
+    free(batch->iovs);
+    free(batch->ctrl);
+    memset(batch, 0, sizeof(*batch));
+}
+
+/**
+ * \brief Receive messages into the batch
+ *
+ * Up to the number of slots of the batch is received by a single recvmmsg() call.
+ * \param[in] data Instance data
+ * \return Number of received messages (zero, if nothing has been received or on failure)
+ */
+static unsigned int
+batch_recv(struct sctp_data *data)
+{
+    struct sctp_batch *batch = &data->batch;
+
+    // Reset lengths of the buffers (modified by the previous call)
+    for (unsigned int i = 0; i < batch->cnt; ++i) {
+        struct msghdr *msg = &batch->hdrs[i].msg_hdr;
+        msg->msg_controllen = BATCH_CTRL_SIZE;
+        msg->msg_flags = 0;
+        batch->iovs[i].iov_len = BATCH_SLOT_SIZE;
+    }
+
+    int ret = recvmmsg(data->sd, batch->hdrs, batch->cnt, MSG_DONTWAIT, NULL);
+    if (ret == -1) {
+        if (errno == EAGAIN || errno == EWOULDBLOCK) {
+            return 0;
+        }
+
+        const char *err_str;
+        ipx_strerror(errno, err_str);
+        IPX_CTX_ERROR(data->ctx, "Failed to read messages. recvmmsg() failed: %s", err_str);
+        return 0;
+    }
+
+    return (unsigned int) ret;
+}
+
+/**
+ * \brief Get the first address of an association
+ * \param[in]  sd     Socket descriptor
+ * \param[in]  opt    SCTP_GET_PEER_ADDRS or SCTP_GET_LOCAL_ADDRS
+ * \param[in]  id     Identification of the association
+ * \param[out] addr   Address
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_NOTFOUND if the address is not available (errno might be set)
+ */
+static int
+assoc_addr_get(int sd, int opt, sctp_assoc_t id, struct sockaddr_storage *addr)
+{
+    union {
+        struct sctp_getaddrs hdr;
+        uint8_t raw[ADDRS_BUFFER_SIZE];
+    } buffer;
+    socklen_t size = sizeof(buffer);
+
+    memset(&buffer, 0, sizeof(buffer));
+    buffer.hdr.assoc_id = id;
+    if (getsockopt(sd, IPPROTO_SCTP, opt, &buffer, &size) == -1 || buffer.hdr.addr_num == 0) {
+        return IPX_ERR_NOTFOUND;
+    }
+
+    // Addresses are packed, i.e. the size of the first one is given by its family
+    const struct sockaddr *first = (const struct sockaddr *) buffer.hdr.addrs;
+    switch (first->sa_family) {
+    case AF_INET:
+        memcpy(addr, first, sizeof(struct sockaddr_in));
+        return IPX_OK;
+    case AF_INET6:
+        memcpy(addr, first, sizeof(struct sockaddr_in6));
+        return IPX_OK;
+    default:
+        return IPX_ERR_NOTFOUND;
+    }
+}
+
+/**
+ * \brief Fill addresses and ports of a Transport Session description
+ * \param[out] net Description of the session
+ * \param[in]  src Remote address
+ * \param[in]  dst Local address
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_FORMAT if families of the addresses are not supported
+ */
+static int
+assoc_net_fill(struct ipx_session_net *net, const struct sockaddr_storage *src,
+    const struct sockaddr_storage *dst)
+{
+    memset(net, 0, sizeof(*net));
+
+    // Convert IPv4 addresses mapped into IPv6 (e.g. a local wildcard address)
+    struct sockaddr_storage addrs[2] = {*src, *dst};
+    for (size_t i = 0; i < 2; ++i) {
+        const struct sockaddr_in6 *addr_v6 = (const struct sockaddr_in6 *) &addrs[i];
+        if (addrs[i].ss_family != AF_INET6 || !IN6_IS_ADDR_V4MAPPED(&addr_v6->sin6_addr)) {
+            continue;
+        }
+
+        struct sockaddr_in addr_v4;
+        memset(&addr_v4, 0, sizeof(addr_v4));
+        addr_v4.sin_family = AF_INET;
+        addr_v4.sin_port = addr_v6->sin6_port;
+        memcpy(&addr_v4.sin_addr, ((const uint8_t *) &addr_v6->sin6_addr) + 12, 4);
+        memcpy(&addrs[i], &addr_v4, sizeof(addr_v4));
+    }
+
+    net->l3_proto = addrs[0].ss_family;
+    if (net->l3_proto == AF_INET) {
+        const struct sockaddr_in *src_v4 = (const struct sockaddr_in *) &addrs[0];
+        net->port_src = ntohs(src_v4->sin_port);
+        net->addr_src.ipv4 = src_v4->sin_addr;
+    } else if (net->l3_proto == AF_INET6) {
+        const struct sockaddr_in6 *src_v6 = (const struct sockaddr_in6 *) &addrs[0];
+        net->port_src = ntohs(src_v6->sin6_port);
+        net->addr_src.ipv6 = src_v6->sin6_addr;
+    } else {
+        return IPX_ERR_FORMAT;
+    }
+
+    // The local address is informative only, i.e. it might be unknown or of another family
+    if (addrs[1].ss_family == AF_INET) {
+        const struct sockaddr_in *dst_v4 = (const struct sockaddr_in *) &addrs[1];
+        net->port_dst = ntohs(dst_v4->sin_port);
+        if (net->l3_proto == AF_INET) {
+            net->addr_dst.ipv4 = dst_v4->sin_addr;
+        }
+    } else if (addrs[1].ss_family == AF_INET6) {
+        const struct sockaddr_in6 *dst_v6 = (const struct sockaddr_in6 *) &addrs[1];
+        net->port_dst = ntohs(dst_v6->sin6_port);
+        if (net->l3_proto == AF_INET6) {
+            net->addr_dst.ipv6 = dst_v6->sin6_addr;
+        }
+    }
+
+    return IPX_OK;
+}
+
+/**
+ * \brief Find an active association
+ * \param[in] data Instance data
+ * \param[in] id   Identification of the association
+ * \return Pointer to the association or NULL, if not found
+ */
+static struct sctp_assoc *
+assoc_find(struct sctp_data *data, sctp_assoc_t id)
+{
+    for (size_t i = 0; i < data->assocs.cnt; ++i) {
+        if (data->assocs.arr[i].id == id) {
+            return &data->assocs.arr[i];
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * \brief Add a new association
+ *
+ * A new Transport Session is created, however, information about it is passed to other plugins
+ * together with its first message.
+ * \param[in] data Instance data
+ * \param[in] id   Identification of the association
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_DENIED if the association cannot be added (it should be aborted)
+ */
+static int
+assoc_add(struct sctp_data *data, sctp_assoc_t id)
+{
+    struct sockaddr_storage src_addr, dst_addr;
+    memset(&dst_addr, 0, sizeof(dst_addr));
+
+    if (assoc_addr_get(data->sd, SCTP_GET_PEER_ADDRS, id, &src_addr) != IPX_OK) {
+        IPX_CTX_ERROR(data->ctx, "Failed to get the remote IP address of a new association! "
+            "Association rejected.", '\0');
+        return IPX_ERR_DENIED;
+    }
+    // The local address is not mandatory (only informative)
+    (void) assoc_addr_get(data->sd, SCTP_GET_LOCAL_ADDRS, id, &dst_addr);
+
+    struct ipx_session_net net;
+    if (assoc_net_fill(&net, &src_addr, &dst_addr) != IPX_OK) {
+        IPX_CTX_ERROR(data->ctx, "New association with an unsupported IP address family "
+            "rejected (family ID: %u)!", (unsigned) src_addr.ss_family);
+        return IPX_ERR_DENIED;
+    }
+
+    char src_addr_str[INET6_ADDRSTRLEN] = {0};
+    inet_ntop(net.l3_proto, &net.addr_src, src_addr_str, INET6_ADDRSTRLEN);
+
+    size_t new_size = (data->assocs.cnt + 1) * sizeof(*data->assocs.arr);
+    struct sctp_assoc *new_arr = realloc(data->assocs.arr, new_size);
+    if (!new_arr) {
+        IPX_CTX_ERROR(data->ctx, "Memory allocation failed! (%s:%d)", __FILE__, __LINE__);
+        return IPX_ERR_DENIED;
+    }
+    data->assocs.arr = new_arr;
+
+    struct ipx_session *session = ipx_session_new_sctp(&net);
+    if (!session) {
+        IPX_CTX_ERROR(data->ctx, "Failed to add internal information about a new Transport "
+            "Session from '%s'! Association rejected.", src_addr_str);
+        return IPX_ERR_DENIED;
+    }
+
+    struct sctp_assoc *assoc = &data->assocs.arr[data->assocs.cnt++];
+    assoc->id = id;
+    assoc->session = session;
+    assoc->new_connection = true;
+    assoc->skip = false;
+
+    IPX_CTX_INFO(data->ctx, "New exporter connected from '%s'.", src_addr_str);
+    return IPX_OK;
+}
+
+/**
+ * \brief Remove an active association
+ *
+ * If at least one message of the association has been passed, a Session message (close event)
+ * is passed and the Transport Session is destroyed later. The association itself must be
+ * already closed or aborted.
+ * \param[in] data  Instance data
+ * \param[in] assoc Association to remove
+ */
+static void
+assoc_remove(struct sctp_data *data, struct sctp_assoc *assoc)
+{
+    IPX_CTX_INFO(data->ctx, "Closing a connection from '%s'.", assoc->session->ident);
+
+    if (assoc->new_connection) {
+        // No messages with a reference to the session -> destroy it immediately
+        ipx_session_destroy(assoc->session);
+    } else {
+        // Generate a Session message (order of the messages MUST be preserved)
+        ipx_msg_session_t *msg_sess = ipx_msg_session_create(assoc->session, IPX_MSG_SESSION_CLOSE);
+        if (!msg_sess) {
+            IPX_CTX_WARNING(data->ctx, "Failed to create a Session message! Instances of plugins "
+                "will not be informed about the closed Transport Session '%s' (%s:%d)",
+                assoc->session->ident, __FILE__, __LINE__);
+            // Do not free the session structure because it still can be used by other plugins
+        } else {
+            // Pass the message and put the Session into the garbage
+            ipx_ctx_msg_pass(data->ctx, ipx_msg_session2base(msg_sess));
+
+            ipx_msg_garbage_cb cb = (ipx_msg_garbage_cb) &ipx_session_destroy;
+            ipx_msg_garbage_t *msg_garbage = ipx_msg_garbage_create(assoc->session, cb);
+            if (!msg_garbage) {
+                IPX_CTX_ERROR(data->ctx, "Memory allocation failed! (%s:%d)", __FILE__, __LINE__);
+            } else {
+                ipx_ctx_msg_pass(data->ctx, ipx_msg_garbage2base(msg_garbage));
+            }
+        }
+    }
+
+    // Replace it with the last one
+    size_t idx = (size_t) (assoc - data->assocs.arr);
+    assert(idx < data->assocs.cnt);
+    data->assocs.arr[idx] = data->assocs.arr[data->assocs.cnt - 1];
+    data->assocs.cnt--;
+}
+
+/**
+ * \brief Abort an association (i.e. send ABORT chunk to the exporter)
+ * \param[in] data Instance data
+ * \param[in] id   Identification of the association
+ */
+static void
+assoc_abort(struct sctp_data *data, sctp_assoc_t id)
+{
+    union {
+        struct cmsghdr hdr;
+        uint8_t raw[CMSG_SPACE(sizeof(struct sctp_sndrcvinfo))];
+    } ctrl;
+    memset(&ctrl, 0, sizeof(ctrl));
+
+    struct msghdr msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_control = &ctrl;
+    msg.msg_controllen = sizeof(ctrl);
+
+    struct cmsghdr *cmsg = CMSG_FIRSTHDR(&msg);
+    cmsg->cmsg_level = IPPROTO_SCTP;
+    cmsg->cmsg_type = SCTP_SNDRCV;
+    cmsg->cmsg_len = CMSG_LEN(sizeof(struct sctp_sndrcvinfo));
+
+    struct sctp_sndrcvinfo *info = (struct sctp_sndrcvinfo *) CMSG_DATA(cmsg);
+    info->sinfo_flags = SCTP_ABORT;
+    info->sinfo_assoc_id = id;
+
+    if (sendmsg(data->sd, &msg, 0) == -1) {
+        const char *err_str;
+        ipx_strerror(errno, err_str);
+        IPX_CTX_WARNING(data->ctx, "Failed to abort an association: %s", err_str);
+    }
+}
+
+/**
+ * \brief Process a notification about a change of an association
+ * \param[in] data Instance data
+ * \param[in] buf  Notification
+ * \param[in] size Size of the notification
+ */
+static void
+notification_process(struct sctp_data *data, const uint8_t *buf, size_t size)
+{
+    const union sctp_notification *notif = (const union sctp_notification *) buf;
+    if (size < sizeof(notif->sn_header)) {
+        return;
+    }
+
+    if (notif->sn_header.sn_type == SCTP_SHUTDOWN_EVENT) {
+        // The association will be removed after the shutdown is complete (SCTP_SHUTDOWN_COMP)
+        IPX_CTX_DEBUG(data->ctx, "An exporter has initiated shutdown of its association.", '\0');
+        return;
+    }
+
+    if (notif->sn_header.sn_type != SCTP_ASSOC_CHANGE || size < sizeof(notif->sn_assoc_change)) {
+        return;
+    }
+
+    const struct sctp_assoc_change *change = &notif->sn_assoc_change;
+    struct sctp_assoc *assoc = assoc_find(data, change->sac_assoc_id);
+
+    switch (change->sac_state) {
+    case SCTP_RESTART:
+        // The exporter has been restarted -> start a new Transport Session
+        if (assoc != NULL) {
+            assoc_remove(data, assoc);
+        }
+        // fall through
+    case SCTP_COMM_UP:
+        if (assoc_add(data, change->sac_assoc_id) != IPX_OK) {
+            assoc_abort(data, change->sac_assoc_id);
+            return;
+        }
+        IPX_CTX_DEBUG(data->ctx, "Association established (inbound streams: %" PRIu16 ").",
+            change->sac_inbound_streams);
+        break;
+    case SCTP_COMM_LOST:
+    case SCTP_SHUTDOWN_COMP:
+        if (assoc != NULL) {
+            assoc_remove(data, assoc);
+        }
+        break;
+    default:
+        // SCTP_CANT_STR_ASSOC or unknown state
+        break;
+    }
+}
+
+/**
+ * \brief Get stream and association of a received message
+ * \param[in] msg Message header
+ * \return Pointer to the information or NULL, if not available
+ */
+static const struct sctp_sndrcvinfo *
+msg_info_get(struct msghdr *msg)
+{
+    for (struct cmsghdr *cmsg = CMSG_FIRSTHDR(msg); cmsg != NULL; cmsg = CMSG_NXTHDR(msg, cmsg)) {
+        if (cmsg->cmsg_level == IPPROTO_SCTP && cmsg->cmsg_type == SCTP_SNDRCV) {
+            return (const struct sctp_sndrcvinfo *) CMSG_DATA(cmsg);
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * \brief Process a received message (i.e. pass it or process a notification)
+ * \param[in] data Instance data
+ * \param[in] idx  Index of the message in the batch
+ */
+static void
+msg_process(struct sctp_data *data, unsigned int idx)
+{
+    struct mmsghdr *hdr = &data->batch.hdrs[idx];
+    const uint8_t *buf = data->batch.iovs[idx].iov_base;
+    const size_t size = hdr->msg_len;
+
+    if ((hdr->msg_hdr.msg_flags & MSG_NOTIFICATION) != 0) {
+        notification_process(data, buf, size);
+        return;
+    }
+
+    const struct sctp_sndrcvinfo *info = msg_info_get(&hdr->msg_hdr);
+    struct sctp_assoc *assoc = (info != NULL) ? assoc_find(data, info->sinfo_assoc_id) : NULL;
+    if (!assoc) {
+        IPX_CTX_WARNING(data->ctx, "Received a message of an unknown association! Ignoring.",
+            '\0');
+        return;
+    }
+
+    const bool complete = (hdr->msg_hdr.msg_flags & MSG_EOR) != 0;
+    if (assoc->skip) {
+        // The rest of a message which is too long
+        assoc->skip = !complete;
+        return;
+    }
+
+    if (!complete) {
+        // The message doesn't fit into the buffer, i.e. it's not a valid IPFIX Message
+        IPX_CTX_WARNING(data->ctx, "Received a message from '%s' longer than %u bytes! Ignoring.",
+            assoc->session->ident, (unsigned int) BATCH_SLOT_SIZE);
+        assoc->skip = true;
+        return;
+    }
+
+    if (size < FDS_IPFIX_MSG_HDR_LEN) {
+        IPX_CTX_WARNING(data->ctx, "Received an invalid message from '%s' (%zu bytes long)! "
+            "Ignoring.", assoc->session->ident, size);
+        return;
+    }
+
+    if (assoc->new_connection) {
+        // Send information about the new Transport Session
+        ipx_msg_session_t *msg = ipx_msg_session_create(assoc->session, IPX_MSG_SESSION_OPEN);
+        if (!msg) {
+            IPX_CTX_ERROR(data->ctx, "Memory allocation failed! (%s:%d)", __FILE__, __LINE__);
+            return;
+        }
+
+        ipx_ctx_msg_pass(data->ctx, ipx_msg_session2base(msg));
+        assoc->new_connection = false;
+    }
+
+    uint8_t *msg_data = ipx_utils_buf_alloc(size);
+    if (!msg_data) {
+        IPX_CTX_ERROR(data->ctx, "Memory allocation failed! (%s:%d)", __FILE__, __LINE__);
+        return;
+    }
+    memcpy(msg_data, buf, size);
+
+    // Each SCTP stream has its own context (e.g. sequence numbers) in the parser
+    struct ipx_msg_ctx msg_ctx;
+    msg_ctx.session = assoc->session;
+    msg_ctx.odid = ntohl(((const struct fds_ipfix_msg_hdr *) msg_data)->odid);
+    msg_ctx.stream = info->sinfo_stream;
+
+    ipx_msg_ipfix_t *msg = ipx_msg_ipfix_create(data->ctx, &msg_ctx, msg_data, (uint16_t) size);
+    if (!msg) {
+        IPX_CTX_ERROR(data->ctx, "Memory allocation failed! (%s:%d)", __FILE__, __LINE__);
+        ipx_utils_buf_free(msg_data);
+        return;
+    }
+
+    ipx_ctx_msg_pass(data->ctx, ipx_msg_ipfix2base(msg));
+}
+
+/**
+ * \brief Bind the socket to local addresses
+ *
+ * If no local address is configured, the socket is bound to the IPv6 wildcard address (i.e. the
+ * socket must be IPv6). Otherwise, all addresses are bound to the socket, so exporters can use
+ * any of them (SCTP multihoming).
+ * \param[in] data Instance data
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_DENIED on failure
+ */
+static int
+socket_bind(struct sctp_data *data)
+{
+    const struct sctp_config *cfg = data->config;
+    const size_t cnt = (cfg->local_addrs.cnt > 0) ? cfg->local_addrs.cnt : 1;
+    const char *err_str;
+
+    // Addresses are packed (i.e. IPv4 addresses are shorter than IPv6 ones)
+    uint8_t *addrs = calloc(cnt, sizeof(struct sockaddr_in6));
+    if (!addrs) {
+        IPX_CTX_ERROR(data->ctx, "Memory allocation failed! (%s:%d)", __FILE__, __LINE__);
+        return IPX_ERR_DENIED;
+    }
+
+    size_t size = 0;
+    if (cfg->local_addrs.cnt == 0) {
+        struct sockaddr_in6 addr_v6;
+        memset(&addr_v6, 0, sizeof(addr_v6));
+        addr_v6.sin6_family = AF_INET6;
+        addr_v6.sin6_port = htons(cfg->local_port);
+        addr_v6.sin6_addr = in6addr_any;
+        memcpy(addrs, &addr_v6, sizeof(addr_v6));
+        size = sizeof(addr_v6);
+    }
+
+    for (size_t i = 0; i < cfg->local_addrs.cnt; ++i) {
+        const struct sctp_ipaddr_rec *rec = &cfg->local_addrs.addrs[i];
+        if (rec->ip_ver == AF_INET) {
+            struct sockaddr_in addr_v4;
+            memset(&addr_v4, 0, sizeof(addr_v4));
+            addr_v4.sin_family = AF_INET;
+            addr_v4.sin_port = htons(cfg->local_port);
+            addr_v4.sin_addr = rec->ipv4;
+            memcpy(addrs + size, &addr_v4, sizeof(addr_v4));
+            size += sizeof(addr_v4);
+        } else {
+            struct sockaddr_in6 addr_v6;
+            memset(&addr_v6, 0, sizeof(addr_v6));
+            addr_v6.sin6_family = AF_INET6;
+            addr_v6.sin6_port = htons(cfg->local_port);
+            addr_v6.sin6_addr = rec->ipv6;
+            memcpy(addrs + size, &addr_v6, sizeof(addr_v6));
+            size += sizeof(addr_v6);
+        }
+    }
+
+    // Equivalent of sctp_bindx(SCTP_BINDX_ADD_ADDR) without dependency on libsctp
+    int ret = setsockopt(data->sd, IPPROTO_SCTP, SCTP_SOCKOPT_BINDX_ADD, addrs, (socklen_t) size);
+    free(addrs);
+    if (ret == -1) {
+        ipx_strerror(errno, err_str);
+        IPX_CTX_ERROR(data->ctx, "Cannot bind to local addresses (port %" PRIu16 "): %s",
+            cfg->local_port, err_str);
+        return IPX_ERR_DENIED;
+    }
+
+    for (size_t i = 0; i < cfg->local_addrs.cnt; ++i) {
+        char addr_str[INET6_ADDRSTRLEN] = {0};
+        inet_ntop(cfg->local_addrs.addrs[i].ip_ver, &cfg->local_addrs.addrs[i].ipv4, addr_str,
+            INET6_ADDRSTRLEN);
+        IPX_CTX_INFO(data->ctx, "Listening on %s (port %" PRIu16 ")", addr_str,
+            cfg->local_port);
+    }
+    if (cfg->local_addrs.cnt == 0) {
+        IPX_CTX_INFO(data->ctx, "Listening on all local IP addresses (port %" PRIu16 ")",
+            cfg->local_port);
+    }
+
+    return IPX_OK;
+}
+
+/**
+ * \brief Create the listening socket
+ *
+ * The socket is one-to-many style, i.e. messages of all associations are received by the same
+ * socket together with identification of their association and stream.
+ * \param[in] data Instance data
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_DENIED on failure
+ */
+static int
+socket_init(struct sctp_data *data)
+{
+    const struct sctp_config *cfg = data->config;
+    const char *err_str;
+    int on = 1, off = 0;
+
+    // IPv6 socket accepts also IPv4 associations, unless only IPv4 addresses are configured
+    int family = (cfg->local_addrs.cnt > 0) ? AF_INET : AF_INET6;
+    for (size_t i = 0; i < cfg->local_addrs.cnt; ++i) {
+        if (cfg->local_addrs.addrs[i].ip_ver == AF_INET6) {
+            family = AF_INET6;
+        }
+    }
+
+    data->sd = socket(family, SOCK_SEQPACKET, IPPROTO_SCTP);
+    if (data->sd == INVALID_FD) {
+        ipx_strerror(errno, err_str);
+        IPX_CTX_ERROR(data->ctx, "Failed to create an SCTP socket (is the 'sctp' kernel module "
+            "available?): %s", err_str);
+        return IPX_ERR_DENIED;
+    }
+
+    if (setsockopt(data->sd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on)) == -1) {
+        ipx_strerror(errno, err_str);
+        IPX_CTX_WARNING(data->ctx, "Cannot turn on socket reuse option. It may take a while "
+            "before the port can be used again. (error: %s)", err_str);
+    }
+
+    if (family == AF_INET6
+            && setsockopt(data->sd, IPPROTO_IPV6, IPV6_V6ONLY, &off, sizeof(off)) == -1) {
+        ipx_strerror(errno, err_str);
+        IPX_CTX_WARNING(data->ctx, "Cannot turn off socket option IPV6_V6ONLY. Plugin may not "
+            "accept IPv4 associations. (error: %s)", err_str);
+    }
+
+    if (cfg->streams != 0) {
+        struct sctp_initmsg init;
+        memset(&init, 0, sizeof(init));
+        init.sinit_max_instreams = cfg->streams;
+        if (setsockopt(data->sd, IPPROTO_SCTP, SCTP_INITMSG, &init, sizeof(init)) == -1) {
+            ipx_strerror(errno, err_str);
+            IPX_CTX_WARNING(data->ctx, "Cannot set the maximum number of inbound streams. "
+                "The default value of the kernel is used. (error: %s)", err_str);
+        }
+    }
+
+    /* Receive stream and association of messages and changes of associations. Only the oldest
+     * part of the structure is used, so older kernels don't refuse it.
+     */
+    struct sctp_event_subscribe events;
+    memset(&events, 0, sizeof(events));
+    events.sctp_data_io_event = 1;
+    events.sctp_association_event = 1;
+    events.sctp_shutdown_event = 1;
+    socklen_t events_size = offsetof(struct sctp_event_subscribe, sctp_partial_delivery_event);
+    if (setsockopt(data->sd, IPPROTO_SCTP, SCTP_EVENTS, &events, events_size) == -1) {
+        ipx_strerror(errno, err_str);
+        IPX_CTX_ERROR(data->ctx, "Cannot subscribe to SCTP events: %s", err_str);
+        close(data->sd);
+        return IPX_ERR_DENIED;
+    }
+
+    if (socket_bind(data) != IPX_OK) {
+        close(data->sd);
+        return IPX_ERR_DENIED;
+    }
+
+    if (listen(data->sd, LISTEN_BACKLOG) == -1) {
+        ipx_strerror(errno, err_str);
+        IPX_CTX_ERROR(data->ctx, "Cannot listen on a socket: %s", err_str);
+        close(data->sd);
+        return IPX_ERR_DENIED;
+    }
+
+    return IPX_OK;
+}
+
+int
+ipx_plugin_init(ipx_ctx_t *ctx, const char *params)
+{
+    struct sctp_data *data = calloc(1, sizeof(*data));
+    if (!data) {
+        IPX_CTX_ERROR(ctx, "Memory allocation failed! (%s:%d)", __FILE__, __LINE__);
+        return IPX_ERR_DENIED;
+    }
+    data->ctx = ctx;
+    data->sd = INVALID_FD;
+
+    // Parse configuration
+    data->config = config_parse(ctx, params);
+    if (!data->config) {
+        free(data);
+        return IPX_ERR_DENIED;
+    }
+
+    if (batch_init(data) != IPX_OK) {
+        batch_destroy(data);
+        config_destroy(data->config);
+        free(data);
+        return IPX_ERR_DENIED;
+    }
+
+    if (socket_init(data) != IPX_OK) {
+        batch_destroy(data);
+        config_destroy(data->config);
+        free(data);
+        return IPX_ERR_DENIED;
+    }
+
+    ipx_ctx_private_set(ctx, data);
+    return IPX_OK;
+}
+
+void
+ipx_plugin_destroy(ipx_ctx_t *ctx, void *cfg)
+{
+    (void) ctx;
+    struct sctp_data *data = (struct sctp_data *) cfg;
+
+    // Close the socket (i.e. all associations) and all Transport Sessions
+    close(data->sd);
+    while (data->assocs.cnt > 0) {
+        assoc_remove(data, &data->assocs.arr[data->assocs.cnt - 1]);
+    }
+
+    free(data->assocs.arr);
+    batch_destroy(data);
+    config_destroy(data->config);
+    free(data);
+}
+
+int
+ipx_plugin_get(ipx_ctx_t *ctx, void *cfg)
+{
+    struct sctp_data *data = (struct sctp_data *) cfg;
+    const char *err_str;
+
+    struct pollfd pfd = {.fd = data->sd, .events = POLLIN, .revents = 0};
+    int ret = poll(&pfd, 1, GETTER_TIMEOUT);
+    if (ret == -1) {
+        int error_code = errno;
+        ipx_strerror(error_code, err_str);
+        IPX_CTX_ERROR(ctx, "poll() failed: %s", err_str);
+        if (error_code == EINTR) {
+            return IPX_OK;
+        }
+        // Fatal error -> stop the plugin
+        return IPX_ERR_DENIED;
+    }
+
+    if (ret == 0) {
+        // Timeout
+        return IPX_OK;
+    }
+
+    // Messages of all streams are processed in order of their delivery
+    unsigned int cnt = batch_recv(data);
+    for (unsigned int i = 0; i < cnt; ++i) {
+        msg_process(data, i);
+    }
+
+    return IPX_OK;
+}
+
+void
+ipx_plugin_session_close(ipx_ctx_t *ctx, void *cfg, const struct ipx_session *session)
+{
+    struct sctp_data *data = (struct sctp_data *) cfg;
+    // Do NOT dereference the session pointer because it can be already freed!
+
+    for (size_t i = 0; i < data->assocs.cnt; ++i) {
+        struct sctp_assoc *assoc = &data->assocs.arr[i];
+        if (assoc->session != session) {
+            continue;
+        }
+
+        assoc_abort(data, assoc->id);
+        assoc_remove(data, assoc);
+        return;
+    }
+
+    /* The session is not present in the list, probably because we already removed it
+     * before the parser send the request to close the session
+     */
+    IPX_CTX_WARNING(ctx, "Received a request to close a unknown Transport Session!", '\0');
+}
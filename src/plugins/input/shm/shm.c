@@ -0,0 +1,647 @@
+/**
+ * \file src/plugins/input/shm/shm.c
+ * \author agent <agent@local>
+ * \brief Shared memory input plugin (source file)
+ * \date 2026
+ */
+
+/* Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is'', and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#include <ipfixcol2.h>
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <unistd.h>
+
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <inttypes.h>
+#include <time.h>
+#include "config.h"
+#include "../../output/shm/shm_ring.h"
+
+/** Identification of an invalid file descriptor                                                 */
+#define INVALID_FD        (-1)
+/** Delay between attempts to attach to the shared memory object (in milliseconds)              */
+#define ATTACH_DELAY      (100)
+/** Delay if there are no records in the ring (in microseconds)                                 */
+#define IDLE_DELAY        (1000)
+/** Number of consecutive idle getter calls between checks of the writer (~1 second)             */
+#define IDLE_CHECK        (1000)
+/** Maximum number of records processed by one getter call                                       */
+#define BATCH_SIZE        (64)
+
+/** Plugin description */
+IPX_API struct ipx_plugin_info ipx_plugin_info = {
+    // Plugin type
+    .type = IPX_PT_INPUT,
+    // Plugin identification name
+    .name = "shm",
+    // Brief description of plugin
+    .dsc = "Input plugin for IPFIX Messages passed by another collector via shared memory.",
+    // Configuration flags (reserved for future use)
+    .flags = 0,
+    // Plugin version string (like "1.2.3")
+    .version = "2.0.0",
+    // Minimal IPFIXcol version string (like "1.2.3")
+    .ipx_min = "2.0.0"
+};
+
+/** Transport Session received from the writer                                                   */
+struct shm_session {
+    /** Identification of the session in the shared memory                                       */
+    uint32_t id;
+    /** Description of the Transport Session                                                     */
+    struct ipx_session *session;
+    /** No message has been passed from the Session yet                                          */
+    bool new_connection;
+};
+
+/** Instance data                                                                                */
+struct shm_data {
+    /** Instance context                                                                         */
+    ipx_ctx_t *ctx;
+    /** Parsed configuration                                                                     */
+    struct shm_config *config;
+    /** File descriptor of the shared memory object (only if attached)                           */
+    int fd;
+    /** Mapped shared memory object (NULL, if not attached)                                      */
+    struct shm_ring_hdr *hdr;
+    /** Size of the mapped object                                                                */
+    size_t map_size;
+    /** Data area of the ring                                                                    */
+    uint8_t *ring;
+    /** Size of the data area                                                                    */
+    uint64_t ring_size;
+    /** Position of the reader (local copy of the tail)                                          */
+    uint64_t tail;
+    /** Number of consecutive getter calls without any record                                    */
+    unsigned int idle_cnt;
+    /** A failed attempt to attach has been reported                                             */
+    bool attach_warned;
+
+    struct {
+        /** Number of sessions                                                                   */
+        size_t cnt;
+        /** Array of sessions                                                                    */
+        struct shm_session *arr;
+    } sessions; /**< Active Transport Sessions                                                   */
+};
+
+/**
+ * \brief Find a Transport Session by its identification
+ * \param[in] data Instance data
+ * \param[in] id   Identification of the session in the shared memory
+ * \return Pointer to the session or NULL
+ */
+static struct shm_session *
+session_find(struct shm_data *data, uint32_t id)
+{
+    for (size_t i = 0; i < data->sessions.cnt; ++i) {
+        if (data->sessions.arr[i].id == id) {
+            return &data->sessions.arr[i];
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * \brief Remove a Transport Session
+ *
+ * If at least one message of the session has been passed, a Session message (close event)
+ * is passed and the Transport Session is destroyed later.
+ * \param[in] data Instance data
+ * \param[in] sess Session to remove
+ */
+static void
+session_remove(struct shm_data *data, struct shm_session *sess)
+{
+    IPX_CTX_INFO(data->ctx, "Closing a Transport Session '%s'.", sess->session->ident);
+
+    if (sess->new_connection) {
+        // No messages with a reference to the session -> destroy it immediately
+        ipx_session_destroy(sess->session);
+    } else {
+        // Generate a Session message (order of the messages MUST be preserved)
+        ipx_msg_session_t *msg_sess = ipx_msg_session_create(sess->session, IPX_MSG_SESSION_CLOSE);
+        if (!msg_sess) {
+            IPX_CTX_WARNING(data->ctx, "Failed to create a Session message! Instances of plugins "
+                "will not be informed about the closed Transport Session '%s' (%s:%d)",
+                sess->session->ident, __FILE__, __LINE__);
+            // Do not free the session structure because it still can be used by other plugins
+        } else {
+            // Pass the message and put the Session into the garbage
+            ipx_ctx_msg_pass(data->ctx, ipx_msg_session2base(msg_sess));
+
+            ipx_msg_garbage_cb cb = (ipx_msg_garbage_cb) &ipx_session_destroy;
+            ipx_msg_garbage_t *msg_garbage = ipx_msg_garbage_create(sess->session, cb);
+            if (!msg_garbage) {
+                IPX_CTX_ERROR(data->ctx, "Memory allocation failed! (%s:%d)", __FILE__, __LINE__);
+            } else {
+                ipx_ctx_msg_pass(data->ctx, ipx_msg_garbage2base(msg_garbage));
+            }
+        }
+    }
+
+    // Replace it with the last one
+    size_t idx = (size_t) (sess - data->sessions.arr);
+    assert(idx < data->sessions.cnt);
+    data->sessions.arr[idx] = data->sessions.arr[data->sessions.cnt - 1];
+    data->sessions.cnt--;
+}
+
+/**
+ * \brief Create a Transport Session described by the writer
+ * \param[in] data    Instance data
+ * \param[in] payload Payload of the record (description of the session)
+ * \param[in] len     Size of the payload
+ * \return Pointer to the session or NULL (invalid description or memory allocation error)
+ */
+static struct ipx_session *
+session_create(struct shm_data *data, const uint8_t *payload, uint32_t len)
+{
+    struct shm_session_desc desc;
+    if (len < sizeof(desc)) {
+        IPX_CTX_WARNING(data->ctx, "Ignoring a malformed description of a Transport Session.",
+            '\0');
+        return NULL;
+    }
+    memcpy(&desc, payload, sizeof(desc));
+
+    if (desc.type == FDS_SESSION_FILE) {
+        const char *path = (const char *) payload + sizeof(desc);
+        const uint32_t path_len = len - (uint32_t) sizeof(desc);
+        if (path_len == 0 || path[path_len - 1] != '\0') {
+            IPX_CTX_WARNING(data->ctx, "Ignoring a malformed description of a Transport Session.",
+                '\0');
+            return NULL;
+        }
+        return ipx_session_new_file(path);
+    }
+
+    if (desc.l3_proto != AF_INET && desc.l3_proto != AF_INET6) {
+        IPX_CTX_WARNING(data->ctx, "Ignoring a malformed description of a Transport Session.",
+            '\0');
+        return NULL;
+    }
+
+    struct ipx_session_net net;
+    memset(&net, 0, sizeof(net));
+    net.l3_proto = (uint8_t) desc.l3_proto;
+    net.port_src = desc.port_src;
+    net.port_dst = desc.port_dst;
+    size_t addr_len = (desc.l3_proto == AF_INET) ? 4 : 16;
+    memcpy(&net.addr_src, desc.addr_src, addr_len);
+    memcpy(&net.addr_dst, desc.addr_dst, addr_len);
+
+    switch (desc.type) {
+    case FDS_SESSION_UDP:
+        return ipx_session_new_udp(&net, desc.lifetime_tmplts, desc.lifetime_opts);
+    case FDS_SESSION_TCP:
+        return ipx_session_new_tcp(&net);
+    case FDS_SESSION_SCTP:
+        return ipx_session_new_sctp(&net);
+    default:
+        IPX_CTX_WARNING(data->ctx, "Ignoring a Transport Session of an unknown type (%u).",
+            (unsigned) desc.type);
+        return NULL;
+    }
+}
+
+/**
+ * \brief Add a new Transport Session
+ * \param[in] data    Instance data
+ * \param[in] id      Identification of the session in the shared memory
+ * \param[in] payload Payload of the record (description of the session)
+ * \param[in] len     Size of the payload
+ */
+static void
+session_add(struct shm_data *data, uint32_t id, const uint8_t *payload, uint32_t len)
+{
+    struct shm_session *sess = session_find(data, id);
+    if (sess != NULL) {
+        // The writer doesn't reuse identifications, i.e. the old session is obsolete
+        session_remove(data, sess);
+    }
+
+    size_t alloc_size = (data->sessions.cnt + 1) * sizeof(struct shm_session);
+    struct shm_session *new_arr = realloc(data->sessions.arr, alloc_size);
+    if (!new_arr) {
+        IPX_CTX_ERROR(data->ctx, "Memory allocation failed! (%s:%d)", __FILE__, __LINE__);
+        return;
+    }
+    data->sessions.arr = new_arr;
+
+    struct ipx_session *session = session_create(data, payload, len);
+    if (!session) {
+        return;
+    }
+
+    sess = &data->sessions.arr[data->sessions.cnt++];
+    sess->id = id;
+    sess->session = session;
+    sess->new_connection = true;
+    IPX_CTX_INFO(data->ctx, "New Transport Session '%s'.", session->ident);
+}
+
+/**
+ * \brief Pass an IPFIX Message to the collector
+ * \param[in] data    Instance data
+ * \param[in] rec     Header of the record
+ * \param[in] payload Payload of the record (the IPFIX Message)
+ */
+static void
+msg_process(struct shm_data *data, const struct shm_rec *rec, const uint8_t *payload)
+{
+    struct shm_session *sess = session_find(data, rec->session);
+    if (!sess) {
+        // Messages written before the reader has been attached
+        return;
+    }
+
+    if (rec->len < FDS_IPFIX_MSG_HDR_LEN || rec->len > UINT16_MAX) {
+        IPX_CTX_WARNING(data->ctx, "Ignoring a malformed message of the Transport Session '%s'.",
+            sess->session->ident);
+        return;
+    }
+
+    if (sess->new_connection) {
+        // Send information about the new Transport Session
+        ipx_msg_session_t *msg = ipx_msg_session_create(sess->session, IPX_MSG_SESSION_OPEN);
+        if (!msg) {
+            IPX_CTX_ERROR(data->ctx, "Memory allocation failed! (%s:%d)", __FILE__, __LINE__);
+            return;
+        }
+
+        ipx_ctx_msg_pass(data->ctx, ipx_msg_session2base(msg));
+        sess->new_connection = false;
+    }
+
+    // The record is released right after processing, i.e. the message must be copied
+    uint8_t *msg_data = ipx_utils_buf_alloc(rec->len);
+    if (!msg_data) {
+        IPX_CTX_ERROR(data->ctx, "Memory allocation failed! (%s:%d)", __FILE__, __LINE__);
+        return;
+    }
+    memcpy(msg_data, payload, rec->len);
+
+    struct ipx_msg_ctx msg_ctx;
+    msg_ctx.session = sess->session;
+    msg_ctx.odid = rec->odid;
+    msg_ctx.stream = rec->stream;
+
+    ipx_msg_ipfix_t *msg = ipx_msg_ipfix_create(data->ctx, &msg_ctx, msg_data, (uint16_t) rec->len);
+    if (!msg) {
+        IPX_CTX_ERROR(data->ctx, "Memory allocation failed! (%s:%d)", __FILE__, __LINE__);
+        ipx_utils_buf_free(msg_data);
+        return;
+    }
+
+    ipx_ctx_msg_pass(data->ctx, ipx_msg_ipfix2base(msg));
+}
+
+/**
+ * \brief Detach from the shared memory object
+ *
+ * All Transport Sessions are closed.
+ * \param[in] data Instance data
+ */
+static void
+shm_detach(struct shm_data *data)
+{
+    while (data->sessions.cnt > 0) {
+        session_remove(data, &data->sessions.arr[data->sessions.cnt - 1]);
+    }
+
+    uint32_t pid = (uint32_t) getpid();
+    __atomic_compare_exchange_n(&data->hdr->reader_pid, &pid, 0, false, __ATOMIC_RELEASE,
+        __ATOMIC_RELAXED);
+
+    munmap(data->hdr, data->map_size);
+    close(data->fd);
+    data->hdr = NULL;
+    data->fd = INVALID_FD;
+    IPX_CTX_INFO(data->ctx, "Detached from the shared memory object '%s'.", data->config->name);
+}
+
+/**
+ * \brief Check whether a process exists
+ * \param[in] pid Process ID
+ * \return True or false
+ */
+static bool
+process_exists(uint32_t pid)
+{
+    return pid != 0 && (kill((pid_t) pid, 0) == 0 || errno != ESRCH);
+}
+
+/**
+ * \brief Try to attach to the shared memory object
+ *
+ * On success, all records already in the ring are skipped and the writer is informed that
+ * Transport Sessions and (Options) Templates must be passed again.
+ * \param[in] data Instance data
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_NOTFOUND if the object doesn't exist or it is not ready or usable yet
+ */
+static int
+shm_attach(struct shm_data *data)
+{
+    const char *name = data->config->name;
+    const char *err_str;
+
+    int fd = shm_open(name, O_RDWR, 0);
+    if (fd == INVALID_FD) {
+        if (!data->attach_warned) {
+            ipx_strerror(errno, err_str);
+            IPX_CTX_INFO(data->ctx, "Waiting for the shared memory object '%s' (%s).", name,
+                err_str);
+            data->attach_warned = true;
+        }
+        return IPX_ERR_NOTFOUND;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) == -1 || st.st_size < (off_t) SHM_RING_HDR_SIZE) {
+        // Not initialized yet
+        close(fd);
+        return IPX_ERR_NOTFOUND;
+    }
+
+    size_t map_size = (size_t) st.st_size;
+    void *addr = mmap(NULL, map_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (addr == MAP_FAILED) {
+        if (!data->attach_warned) {
+            ipx_strerror(errno, err_str);
+            IPX_CTX_WARNING(data->ctx, "Failed to map the shared memory object '%s': %s", name,
+                err_str);
+            data->attach_warned = true;
+        }
+        close(fd);
+        return IPX_ERR_NOTFOUND;
+    }
+
+    struct shm_ring_hdr *hdr = (struct shm_ring_hdr *) addr;
+    const char *reason = NULL;
+    uint32_t pid_old = __atomic_load_n(&hdr->reader_pid, __ATOMIC_ACQUIRE);
+    uint32_t pid_new = (uint32_t) getpid();
+
+    if (__atomic_load_n(&hdr->magic, __ATOMIC_ACQUIRE) != SHM_RING_MAGIC) {
+        reason = "not initialized";
+    } else if (hdr->version != SHM_RING_VERSION) {
+        reason = "unsupported version";
+    } else if (hdr->size == 0 || (hdr->size & (hdr->size - 1)) != 0
+            || SHM_RING_HDR_SIZE + hdr->size != map_size) {
+        reason = "invalid size";
+    } else if (__atomic_load_n(&hdr->closed, __ATOMIC_ACQUIRE)) {
+        reason = "closed by the writer";
+    } else if (!process_exists(hdr->writer_pid)) {
+        reason = "the writer doesn't exist anymore";
+    } else if (pid_old != 0 && process_exists(pid_old)) {
+        reason = "used by another reader";
+    } else if (!__atomic_compare_exchange_n(&hdr->reader_pid, &pid_old, pid_new, false,
+            __ATOMIC_ACQ_REL, __ATOMIC_RELAXED)) {
+        reason = "used by another reader";
+    }
+
+    if (reason != NULL) {
+        if (!data->attach_warned) {
+            IPX_CTX_WARNING(data->ctx, "Unable to attach to the shared memory object '%s' (%s).",
+                name, reason);
+            data->attach_warned = true;
+        }
+        munmap(addr, map_size);
+        close(fd);
+        return IPX_ERR_NOTFOUND;
+    }
+
+    // Skip all existing records and ask the writer to announce sessions and templates again
+    data->fd = fd;
+    data->hdr = hdr;
+    data->map_size = map_size;
+    data->ring = shm_ring_data(hdr);
+    data->ring_size = hdr->size;
+    data->tail = __atomic_load_n(&hdr->head, __ATOMIC_ACQUIRE);
+    data->idle_cnt = 0;
+    data->attach_warned = false;
+    __atomic_store_n(&hdr->tail, data->tail, __ATOMIC_RELEASE);
+    __atomic_add_fetch(&hdr->reader_gen, 1, __ATOMIC_RELEASE);
+
+    IPX_CTX_INFO(data->ctx, "Attached to the shared memory object '%s' (writer PID %" PRIu32
+        ").", name, hdr->writer_pid);
+    return IPX_OK;
+}
+
+/**
+ * \brief Process records in the ring
+ * \param[in] data Instance data
+ * \return Number of processed records
+ * \return -1 if the ring is corrupted
+ */
+static int
+ring_process(struct shm_data *data)
+{
+    const uint64_t mask = data->ring_size - 1;
+    int cnt = 0;
+
+    while (cnt < BATCH_SIZE) {
+        const uint64_t head = __atomic_load_n(&data->hdr->head, __ATOMIC_ACQUIRE);
+        if (data->tail == head) {
+            break;
+        }
+
+        // Not enough space for a header up to the end of the data area
+        uint64_t skip = shm_ring_skip(data->tail, data->ring_size, sizeof(struct shm_rec));
+        if (skip > 0) {
+            data->tail += skip;
+            continue;
+        }
+
+        // The record cannot be modified by the writer until the tail is moved
+        const uint8_t *ptr = data->ring + (data->tail & mask);
+        struct shm_rec rec;
+        memcpy(&rec, ptr, sizeof(rec));
+
+        if (rec.size < sizeof(rec) || rec.size % SHM_RING_ALIGN != 0
+                || rec.size > data->ring_size - (data->tail & mask)
+                || rec.len > rec.size - sizeof(rec) || rec.size > head - data->tail) {
+            IPX_CTX_ERROR(data->ctx, "The shared memory object '%s' is corrupted!",
+                data->config->name);
+            return -1;
+        }
+
+        const uint8_t *payload = ptr + sizeof(rec);
+        switch (rec.type) {
+        case SHM_REC_SESSION_OPEN:
+            session_add(data, rec.session, payload, rec.len);
+            break;
+        case SHM_REC_SESSION_CLOSE: {
+            struct shm_session *sess = session_find(data, rec.session);
+            if (sess != NULL) {
+                session_remove(data, sess);
+            }
+            } break;
+        case SHM_REC_MESSAGE:
+            msg_process(data, &rec, payload);
+            break;
+        default:
+            // Padding or unknown records are skipped
+            break;
+        }
+
+        // Release the record
+        data->tail += rec.size;
+        __atomic_store_n(&data->hdr->tail, data->tail, __ATOMIC_RELEASE);
+        cnt++;
+    }
+
+    __atomic_store_n(&data->hdr->tail, data->tail, __ATOMIC_RELEASE);
+    return cnt;
+}
+
+int
+ipx_plugin_init(ipx_ctx_t *ctx, const char *params)
+{
+    struct shm_data *data = calloc(1, sizeof(*data));
+    if (!data) {
+        IPX_CTX_ERROR(ctx, "Memory allocation failed! (%s:%d)", __FILE__, __LINE__);
+        return IPX_ERR_DENIED;
+    }
+    data->ctx = ctx;
+    data->fd = INVALID_FD;
+
+    // Parse configuration
+    data->config = config_parse(ctx, params);
+    if (!data->config) {
+        free(data);
+        return IPX_ERR_DENIED;
+    }
+
+    // The writer might not exist yet, i.e. attach later
+    shm_attach(data);
+
+    ipx_ctx_private_set(ctx, data);
+    return IPX_OK;
+}
+
+void
+ipx_plugin_destroy(ipx_ctx_t *ctx, void *cfg)
+{
+    (void) ctx;
+    struct shm_data *data = (struct shm_data *) cfg;
+
+    if (data->hdr != NULL) {
+        shm_detach(data);
+    }
+
+    free(data->sessions.arr);
+    config_destroy(data->config);
+    free(data);
+}
+
+int
+ipx_plugin_get(ipx_ctx_t *ctx, void *cfg)
+{
+    (void) ctx;
+    struct shm_data *data = (struct shm_data *) cfg;
+
+    if (data->hdr == NULL && shm_attach(data) != IPX_OK) {
+        const struct timespec delay = {0, ATTACH_DELAY * 1000000L};
+        nanosleep(&delay, NULL);
+        return IPX_OK;
+    }
+
+    int cnt = ring_process(data);
+    if (cnt < 0) {
+        shm_detach(data);
+        return IPX_OK;
+    }
+
+    if (cnt > 0) {
+        data->idle_cnt = 0;
+        return IPX_OK;
+    }
+
+    // The ring is empty, check if the writer still exists
+    const struct shm_ring_hdr *hdr = data->hdr;
+    if (__atomic_load_n(&hdr->closed, __ATOMIC_ACQUIRE)) {
+        if (__atomic_load_n(&hdr->head, __ATOMIC_ACQUIRE) == data->tail) {
+            IPX_CTX_INFO(ctx, "The writer closed the shared memory object '%s'.",
+                data->config->name);
+            shm_detach(data);
+        }
+        return IPX_OK;
+    }
+
+    if (++data->idle_cnt >= IDLE_CHECK) {
+        data->idle_cnt = 0;
+        if (!process_exists(hdr->writer_pid)) {
+            IPX_CTX_WARNING(ctx, "The writer (PID %" PRIu32 ") of the shared memory object '%s' "
+                "doesn't exist anymore.", hdr->writer_pid, data->config->name);
+            shm_detach(data);
+            return IPX_OK;
+        }
+    }
+
+    const struct timespec delay = {0, IDLE_DELAY * 1000L};
+    nanosleep(&delay, NULL);
+    return IPX_OK;
+}
+
+void
+ipx_plugin_session_close(ipx_ctx_t *ctx, void *cfg, const struct ipx_session *session)
+{
+    (void) ctx;
+    struct shm_data *data = (struct shm_data *) cfg;
+    // Do NOT dereference the session pointer because it can be already freed!
+
+    for (size_t i = 0; i < data->sessions.cnt; ++i) {
+        struct shm_session *sess = &data->sessions.arr[i];
+        if (sess->session != session) {
+            continue;
+        }
+
+        // Following messages of the session are dropped (the writer announces it again only to
+        // a newly attached reader)
+        session_remove(data, sess);
+        break;
+    }
+}
@@ -44,17 +44,36 @@
 #include <string.h>
 #include "config.h"
 
+/** Maximum number of receiver threads                                                          */
+#define THREADS_MAX (64)
+/** Default budget of a connection per round of reading (in bytes)                              */
+#define BUDGET_DEF  (256U * 1024U)
+/** Minimal budget of a connection per round of reading (in bytes)                              */
+#define BUDGET_MIN  (4096U)
+/** Maximal budget of a connection per round of reading (in bytes)                              */
+#define BUDGET_MAX  (64U * 1024U * 1024U)
+
 /*
  * <params>
  *  <localPort>...</localPort>                    <!-- optional        -->
  *  <localIPAddress>...</localIPAddress>          <!-- optional, multiple times -->
+ *  <threads>...</threads>                        <!-- optional        -->
+ *  <connectionBudget>...</connectionBudget>      <!-- optional        -->
+ *  <tlsCertificate>...</tlsCertificate>          <!-- optional        -->
+ *  <tlsPrivateKey>...</tlsPrivateKey>            <!-- optional        -->
+ *  <tlsCAFile>...</tlsCAFile>                    <!-- optional        -->
  * </params>
  */
 
 /** XML nodes */
 enum params_xml_nodes {
     NODE_PORT = 1,
-    NODE_IPADDR
+    NODE_IPADDR,
+    NODE_THREADS,
+    NODE_BUDGET,
+    NODE_TLS_CERT,
+    NODE_TLS_KEY,
+    NODE_TLS_CA
 };
 
 /** Definition of the \<params\> node  */
@@ -62,6 +81,11 @@ static const struct fds_xml_args args_params[] = {
     FDS_OPTS_ROOT("params"),
     FDS_OPTS_ELEM(NODE_PORT,   "localPort",      FDS_OPTS_T_UINT,   FDS_OPTS_P_OPT),
     FDS_OPTS_ELEM(NODE_IPADDR, "localIPAddress", FDS_OPTS_T_STRING, FDS_OPTS_P_OPT | FDS_OPTS_P_MULTI),
+    FDS_OPTS_ELEM(NODE_THREADS, "threads",       FDS_OPTS_T_UINT,   FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM(NODE_BUDGET, "connectionBudget", FDS_OPTS_T_UINT,   FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM(NODE_TLS_CERT, "tlsCertificate", FDS_OPTS_T_STRING, FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM(NODE_TLS_KEY,  "tlsPrivateKey",  FDS_OPTS_T_STRING, FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM(NODE_TLS_CA,   "tlsCAFile",      FDS_OPTS_T_STRING, FDS_OPTS_P_OPT),
     FDS_OPTS_END
 };
 
@@ -109,6 +133,33 @@ config_add_addr(ipx_ctx_t *ctx, struct tcp_config *cfg, const char *addr)
     return IPX_OK;
 }
 
+/**
+ * \brief Replace a path of a TLS file
+ *
+ * \note An empty path is ignored and success is returned!
+ * \param[in]  ctx  Instance context
+ * \param[out] dst  Path to replace
+ * \param[in]  path New path
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_FORMAT on a memory allocation error
+ */
+static int
+config_set_path(ipx_ctx_t *ctx, char **dst, const char *path)
+{
+    free(*dst);
+    *dst = NULL;
+    if (strlen(path) == 0) {
+        return IPX_OK;
+    }
+
+    *dst = strdup(path);
+    if (!*dst) {
+        IPX_CTX_ERROR(ctx, "Memory allocation failed! (%s:%d)", __FILE__, __LINE__);
+        return IPX_ERR_FORMAT;
+    }
+    return IPX_OK;
+}
+
 /**
  * \brief Process \<params\> node
  * \param[in] ctx  Plugin context
@@ -139,12 +190,59 @@ config_parser_root(ipx_ctx_t *ctx, fds_xml_ctx_t *root, struct tcp_config *cfg)
                 return IPX_ERR_FORMAT;
             }
             break;
+        case NODE_THREADS:
+            // Number of receiver threads
+            assert(content->type == FDS_OPTS_T_UINT);
+            if (content->val_uint < 1 || content->val_uint > THREADS_MAX) {
+                IPX_CTX_ERROR(ctx, "Number of threads must be between 1..%u",
+                    (unsigned) THREADS_MAX);
+                return IPX_ERR_FORMAT;
+            }
+            cfg->threads = (uint16_t) content->val_uint;
+            break;
+        case NODE_BUDGET:
+            // Budget of a connection per round of reading
+            assert(content->type == FDS_OPTS_T_UINT);
+            if (content->val_uint < BUDGET_MIN || content->val_uint > BUDGET_MAX) {
+                IPX_CTX_ERROR(ctx, "Connection budget must be between %u..%u bytes",
+                    BUDGET_MIN, BUDGET_MAX);
+                return IPX_ERR_FORMAT;
+            }
+            cfg->budget = (uint32_t) content->val_uint;
+            break;
+        case NODE_TLS_CERT:
+            // Certificate of the collector (enables TLS)
+            assert(content->type == FDS_OPTS_T_STRING);
+            if (config_set_path(ctx, &cfg->tls.cert, content->ptr_string) != IPX_OK) {
+                return IPX_ERR_FORMAT;
+            }
+            break;
+        case NODE_TLS_KEY:
+            // Private key of the certificate
+            assert(content->type == FDS_OPTS_T_STRING);
+            if (config_set_path(ctx, &cfg->tls.key, content->ptr_string) != IPX_OK) {
+                return IPX_ERR_FORMAT;
+            }
+            break;
+        case NODE_TLS_CA:
+            // CA certificates to verify exporters
+            assert(content->type == FDS_OPTS_T_STRING);
+            if (config_set_path(ctx, &cfg->tls.ca_file, content->ptr_string) != IPX_OK) {
+                return IPX_ERR_FORMAT;
+            }
+            break;
         default:
             // Internal error
             assert(false);
         }
     }
 
+    if (cfg->tls.cert == NULL && (cfg->tls.key != NULL || cfg->tls.ca_file != NULL)) {
+        IPX_CTX_ERROR(ctx, "TLS parameters require a certificate of the collector "
+            "(see <tlsCertificate>)!", '\0');
+        return IPX_ERR_FORMAT;
+    }
+
     return IPX_OK;
 }
 
@@ -157,6 +255,8 @@ config_default_set(struct tcp_config *cfg)
 {
     cfg->local_port = 4739; // Default port
     cfg->local_addrs.cnt = 0;
+    cfg->threads = 1;
+    cfg->budget = BUDGET_DEF;
 }
 
 struct tcp_config *
@@ -209,5 +309,8 @@ void
 config_destroy(struct tcp_config *cfg)
 {
     free(cfg->local_addrs.addrs);
+    free(cfg->tls.cert);
+    free(cfg->tls.key);
+    free(cfg->tls.ca_file);
     free(cfg);
 }
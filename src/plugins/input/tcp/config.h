@@ -60,6 +60,19 @@ struct tcp_ipaddr_rec {
 struct tcp_config {
     /** Local port                                                                               */
     uint16_t local_port;
+    /** Number of receiver threads (i.e. threads reading active connections)                     */
+    uint16_t threads;
+    /** Bytes read from a connection per round before other connections are served             */
+    uint32_t budget;
+
+    struct {
+        /** Certificate chain of the collector in PEM format (NULL, if TLS is disabled)         */
+        char *cert;
+        /** Private key of the certificate in PEM format                                         */
+        char *key;
+        /** CA certificates to verify exporters in PEM format (NULL, if not verified)             */
+        char *ca_file;
+    } tls; /**< Transport Layer Security                                                         */
 
     struct {
         /** Size of the array                                                                    */
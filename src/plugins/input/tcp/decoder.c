@@ -0,0 +1,255 @@
+/**
+ * \file src/plugins/input/tcp/decoder.c
+ * \author agent <agent@local>
+ * \brief Decompression of TCP streams (source file)
+ * \date 2026
+ */
+
+/* Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is'', and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "decoder.h"
+
+#ifdef HAVE_LZ4
+#include <lz4frame.h>
+#endif
+#ifdef HAVE_ZSTD
+#include <zstd.h>
+#endif
+
+/** Size of the input buffer of a decoder                                                        */
+#define DECODER_BUFFER_SIZE (64U * 1024U)
+/** Magic number of a LZ4 frame (little endian)                                                  */
+#define DECODER_LZ4_MAGIC  (0x184D2204UL)
+/** Magic number of a Zstandard frame (little endian)                                            */
+#define DECODER_ZSTD_MAGIC (0xFD2FB528UL)
+
+struct tcp_decoder {
+    /** Instance context (for log messages)                                                      */
+    ipx_ctx_t *ctx;
+    /** Type of the stream                                                                       */
+    enum decoder_type type;
+    union {
+#ifdef HAVE_LZ4
+        /** LZ4 decompression context                                                            */
+        LZ4F_dctx *lz4;
+#endif
+#ifdef HAVE_ZSTD
+        /** Zstandard decompression context                                                      */
+        ZSTD_DStream *zstd;
+#endif
+        /** Placeholder if no method is supported                                                */
+        void *none;
+    };
+
+    /** Start of compressed data that haven't been decompressed yet                              */
+    size_t in_start;
+    /** End of compressed data                                                                   */
+    size_t in_end;
+    /** Input buffer (compressed data)                                                           */
+    uint8_t in[DECODER_BUFFER_SIZE];
+};
+
+enum decoder_type
+decoder_detect(const uint8_t *data, size_t size)
+{
+    if (size < DECODER_MAGIC_LEN) {
+        return DECODER_UNKNOWN;
+    }
+
+    const uint32_t magic = (uint32_t) data[0] | ((uint32_t) data[1] << 8)
+        | ((uint32_t) data[2] << 16) | ((uint32_t) data[3] << 24);
+    switch (magic) {
+    case DECODER_LZ4_MAGIC:
+        return DECODER_LZ4;
+    case DECODER_ZSTD_MAGIC:
+        return DECODER_ZSTD;
+    default:
+        return DECODER_PLAIN;
+    }
+}
+
+tcp_decoder_t *
+decoder_create(ipx_ctx_t *ctx, enum decoder_type type, const char *ident)
+{
+    const char *name = (type == DECODER_LZ4) ? "LZ4" : "Zstandard";
+    assert(type == DECODER_LZ4 || type == DECODER_ZSTD);
+
+    tcp_decoder_t *dec = calloc(1, sizeof(*dec));
+    if (!dec) {
+        IPX_CTX_ERROR(ctx, "Memory allocation failed! (%s:%d)", __FILE__, __LINE__);
+        return NULL;
+    }
+
+    dec->ctx = ctx;
+    dec->type = type;
+    bool supported = false;
+    bool created = false;
+
+    switch (type) {
+#ifdef HAVE_LZ4
+    case DECODER_LZ4:
+        supported = true;
+        created = !LZ4F_isError(LZ4F_createDecompressionContext(&dec->lz4, LZ4F_VERSION));
+        break;
+#endif
+#ifdef HAVE_ZSTD
+    case DECODER_ZSTD:
+        supported = true;
+        dec->zstd = ZSTD_createDStream();
+        created = (dec->zstd != NULL) && !ZSTD_isError(ZSTD_initDStream(dec->zstd));
+        if (!created) {
+            ZSTD_freeDStream(dec->zstd);
+        }
+        break;
+#endif
+    default:
+        break;
+    }
+
+    if (!supported) {
+        IPX_CTX_ERROR(ctx, "Connection with '%s' is compressed by %s, which is not supported "
+            "by this build of the plugin.", ident, name);
+        free(dec);
+        return NULL;
+    }
+
+    if (!created) {
+        IPX_CTX_ERROR(ctx, "Failed to create a %s decoder of the connection with '%s'.",
+            name, ident);
+        free(dec);
+        return NULL;
+    }
+
+    IPX_CTX_INFO(ctx, "Connection with '%s' is compressed by %s.", ident, name);
+    return dec;
+}
+
+void
+decoder_destroy(tcp_decoder_t *dec)
+{
+    if (!dec) {
+        return;
+    }
+
+    switch (dec->type) {
+#ifdef HAVE_LZ4
+    case DECODER_LZ4:
+        LZ4F_freeDecompressionContext(dec->lz4);
+        break;
+#endif
+#ifdef HAVE_ZSTD
+    case DECODER_ZSTD:
+        ZSTD_freeDStream(dec->zstd);
+        break;
+#endif
+    default:
+        break;
+    }
+
+    free(dec);
+}
+
+uint8_t *
+decoder_in_space(tcp_decoder_t *dec, size_t *size)
+{
+    if (dec->in_start > 0) {
+        // Move the rest of compressed data to the beginning
+        memmove(dec->in, &dec->in[dec->in_start], dec->in_end - dec->in_start);
+        dec->in_end -= dec->in_start;
+        dec->in_start = 0;
+    }
+
+    *size = DECODER_BUFFER_SIZE - dec->in_end;
+    return &dec->in[dec->in_end];
+}
+
+void
+decoder_in_commit(tcp_decoder_t *dec, size_t len)
+{
+    assert(dec->in_end + len <= DECODER_BUFFER_SIZE);
+    dec->in_end += len;
+}
+
+bool
+decoder_pending(const tcp_decoder_t *dec)
+{
+    return dec->in_start != dec->in_end;
+}
+
+int
+decoder_run(tcp_decoder_t *dec, uint8_t *out, size_t *size)
+{
+    const uint8_t *in = &dec->in[dec->in_start];
+    size_t in_size = dec->in_end - dec->in_start;
+    size_t out_size = *size;
+    bool failed = true;
+    (void) in; // Unused if no method is supported by the build
+    (void) out;
+
+    switch (dec->type) {
+#ifdef HAVE_LZ4
+    case DECODER_LZ4: {
+        // Concatenated frames are processed too (the context is reset after the end of a frame)
+        size_t ret = LZ4F_decompress(dec->lz4, out, &out_size, in, &in_size, NULL);
+        failed = LZ4F_isError(ret);
+        }
+        break;
+#endif
+#ifdef HAVE_ZSTD
+    case DECODER_ZSTD: {
+        ZSTD_inBuffer in_buf = {in, in_size, 0};
+        ZSTD_outBuffer out_buf = {out, out_size, 0};
+        size_t ret = ZSTD_decompressStream(dec->zstd, &out_buf, &in_buf);
+        failed = ZSTD_isError(ret);
+        in_size = in_buf.pos;
+        out_size = out_buf.pos;
+        }
+        break;
+#endif
+    default:
+        break;
+    }
+
+    if (failed) {
+        *size = 0;
+        return IPX_ERR_FORMAT;
+    }
+
+    dec->in_start += in_size;
+    *size = out_size;
+    return IPX_OK;
+}
@@ -0,0 +1,133 @@
+/**
+ * \file src/plugins/input/tcp/decoder.h
+ * \author agent <agent@local>
+ * \brief Decompression of TCP streams (header file)
+ * \date 2026
+ */
+
+/* Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is'', and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#ifndef DECODER_H
+#define DECODER_H
+
+#include <ipfixcol2.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/** Number of bytes at the start of a stream necessary to detect its type                        */
+#define DECODER_MAGIC_LEN (4U)
+
+/** Type of a stream                                                                             */
+enum decoder_type {
+    /** Not enough data to detect the type                                                       */
+    DECODER_UNKNOWN,
+    /** Uncompressed stream (or a stream that is not compressed by a supported method)          */
+    DECODER_PLAIN,
+    /** LZ4 frames                                                                               */
+    DECODER_LZ4,
+    /** Zstandard frames                                                                         */
+    DECODER_ZSTD
+};
+
+/** Decoder of a compressed stream                                                               */
+typedef struct tcp_decoder tcp_decoder_t;
+
+/**
+ * \brief Detect the type of a stream by magic numbers at its start
+ * \param[in] data Start of the stream
+ * \param[in] size Size of the data
+ * \return Type of the stream (#DECODER_UNKNOWN if less than #DECODER_MAGIC_LEN bytes are given)
+ */
+enum decoder_type
+decoder_detect(const uint8_t *data, size_t size);
+
+/**
+ * \brief Create a decoder
+ * \param[in] ctx   Instance context (for log messages)
+ * \param[in] type  Type of the stream (#DECODER_LZ4 or #DECODER_ZSTD)
+ * \param[in] ident Identification of the exporter (for log messages)
+ * \return Pointer to the decoder on success
+ * \return NULL on failure (a memory allocation error or the method is not supported by the build)
+ */
+tcp_decoder_t *
+decoder_create(ipx_ctx_t *ctx, enum decoder_type type, const char *ident);
+
+/**
+ * \brief Destroy a decoder
+ * \param[in] dec Decoder (can be NULL)
+ */
+void
+decoder_destroy(tcp_decoder_t *dec);
+
+/**
+ * \brief Get free space of the input buffer of a decoder (for compressed data)
+ * \param[in]  dec  Decoder
+ * \param[out] size Size of the free space
+ * \return Pointer to the free space
+ */
+uint8_t *
+decoder_in_space(tcp_decoder_t *dec, size_t *size);
+
+/**
+ * \brief Add compressed data written into the free space of the input buffer
+ * \param[in] dec Decoder
+ * \param[in] len Number of bytes
+ */
+void
+decoder_in_commit(tcp_decoder_t *dec, size_t len);
+
+/**
+ * \brief Check if the input buffer of a decoder contains data that haven't been decompressed
+ * \param[in] dec Decoder
+ * \return True or false
+ */
+bool
+decoder_pending(const tcp_decoder_t *dec);
+
+/**
+ * \brief Decompress data from the input buffer
+ *
+ * Decompression stops if the input buffer is empty or the output buffer is full.
+ * \param[in]     dec  Decoder
+ * \param[in]     out  Output buffer
+ * \param[in,out] size Size of the output buffer (in) and number of decompressed bytes (out)
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_FORMAT if the stream is corrupted
+ */
+int
+decoder_run(tcp_decoder_t *dec, uint8_t *out, size_t *size);
+
+#endif // DECODER_H
@@ -44,6 +44,7 @@
 #include <sys/types.h>
 #include <sys/socket.h>
 #include <sys/epoll.h>
+#include <sys/eventfd.h>
 #include <arpa/inet.h>
 #include <netinet/in.h>
 #include <unistd.h>
@@ -53,7 +54,11 @@
 #include <pthread.h>
 #include <errno.h>
 #include <inttypes.h>
+#include <time.h>
 #include "config.h"
+#include "tls.h"
+#include "decoder.h"
+#include "../../../core/latency.h"
 
 /** Identification of an invalid socket descriptor                                               */
 #define INVALID_FD        (-1)
@@ -63,6 +68,29 @@
 #define GETTER_TIMEOUT    (10)
 /** Max sockets events processed in the getter - i.e. epoll_wait array size                      */
 #define GETTER_MAX_EVENTS (16)
+/** Timeout of a receiver thread - i.e. max. delay of its termination [in milliseconds]          */
+#define WORKER_TIMEOUT    (100)
+/** Capacity of the queue of received messages (multiple of events per receiver thread)          */
+#define WORKER_QUEUE_MUL  (4)
+/** Size of a buffer for reading of a connection (i.e. size of a chunk)                          */
+#define BUFFER_SIZE       (256U * 1024U)
+/** Number of chunks shared by connections of an instance                                        */
+#define BUFFER_CHUNKS     (128U)
+/** Min. free space of a buffer before reading (otherwise, unprocessed data are moved)           */
+#define BUFFER_MIN_FREE   (UINT16_MAX)
+
+#ifndef SOL_TLS
+/** Socket level of kernel TLS                                                                   */
+#define SOL_TLS              (282)
+#endif
+#ifndef TLS_GET_RECORD_TYPE
+/** Control message with the type of a TLS record received by kernel TLS                         */
+#define TLS_GET_RECORD_TYPE  (2)
+#endif
+/** Type of a TLS record with application data                                                   */
+#define TLS_RECORD_DATA      (23)
+/** Type of a TLS record with an alert (e.g. close_notify)                                       */
+#define TLS_RECORD_ALERT     (21)
 
 /** Plugin description */
 IPX_API struct ipx_plugin_info ipx_plugin_info = {
@@ -80,6 +108,8 @@ IPX_API struct ipx_plugin_info ipx_plugin_info = {
     .ipx_min = "2.0.0"
 };
 
+struct tcp_worker;
+
 /** Auxiliary combination of a file descriptor and corresponding Transport Session               */
 struct tcp_pair {
     /** File descriptor of the Transport Session                                                 */
@@ -89,12 +119,106 @@ struct tcp_pair {
     /** No message has been received from the Session yet                                        */
     bool new_connection;
 
-    /** Partly received message that waits for completition                                      */
+    /** Buffer of received data (a chunk or, if no chunk has been available, a private buffer)  */
+    uint8_t *buf;
+    /** The buffer is a chunk, i.e. messages are passed as its slices without copying            */
+    bool buf_chunk;
+    /** Start of received data that haven't been processed yet                                   */
+    size_t buf_start;
+    /** End of received data                                                                     */
+    size_t buf_end;
+
+    /** Time of reception of the data at <em>buf_start</em> by the kernel (or zero)             */
+    struct timespec ts_first;
+    /** Time of reception of the data since <em>ts_offset</em> by the kernel (or zero)           */
+    struct timespec ts_last;
+    /** Offset of the data received by the last read                                             */
+    size_t ts_offset;
+
+    /** TLS state of the connection decrypted by the plugin (NULL, if not used)                  */
+    tcp_tls_conn_t *tls;
+    /** Type of the stream has been already detected (i.e. compressed or not)                    */
+    bool stream_detected;
+    /** Decoder of the compressed stream (NULL, if the stream is not compressed)                 */
+    tcp_decoder_t *decoder;
+    /** Receiver thread of the connection (NULL, if the connection is read by the instance)      */
+    struct tcp_worker *worker;
+
+    /** Remaining budget of the connection in the current round (deficit round-robin)           */
+    int64_t deficit;
+    /** The last round of reading in which the connection has been served                       */
+    uint64_t round;
+    /** The connection is in the backlog of its reading thread (see struct tcp_backlog)         */
+    bool backlog;
+    /** Previous connection in the backlog                                                       */
+    struct tcp_pair *backlog_prev;
+    /** Next connection in the backlog                                                           */
+    struct tcp_pair *backlog_next;
+
+    struct {
+        /** Time of the connection (monotonic clock)                                             */
+        struct timespec start;
+        /** Received bytes (after decompression)                                                 */
+        uint64_t bytes;
+        /** Received IPFIX Messages                                                              */
+        uint64_t msgs;
+    } stats; /**< Throughput statistics of the connection                                        */
+};
+
+/**
+ * Connections that have exhausted their budget while decompressed data are still pending
+ *
+ * Such data don't trigger any epoll event, therefore, the connections are served in the next
+ * round of reading regardless of events.
+ */
+struct tcp_backlog {
+    /** The first connection                                                                     */
+    struct tcp_pair *head;
+    /** The last connection                                                                      */
+    struct tcp_pair *tail;
+    /** Number of connections                                                                    */
+    size_t cnt;
+};
+
+/**
+ * Message received by a receiver thread and waiting for processing by the instance thread
+ *
+ * If the message is NULL, the connection has been closed (or it is broken) and the receiver
+ * thread doesn't read it anymore, i.e. the instance thread should remove it.
+ */
+struct tcp_item {
+    /** Connection of the message                                                                */
+    struct tcp_pair *pair;
+    /** Message (allocated by ipx_utils_buf_alloc()) or NULL                                     */
     uint8_t *msg;
-    /** Allocated size of the partly received <em>msg</em> message                               */
+    /** Size of the message                                                                      */
     uint16_t msg_size;
-    /** Already receive part of the <em>msg</em> message                                         */
-    uint16_t msg_offset;
+    /** Time of reception of the beginning of the message by the kernel (or zero)                */
+    struct timespec msg_ts;
+};
+
+struct tcp_data;
+
+/** Receiver thread (reads messages from connections assigned to it)                             */
+struct tcp_worker {
+    /** Instance data                                                                            */
+    struct tcp_data *instance;
+    /** Index of the thread                                                                      */
+    size_t id;
+    /** Thread identification                                                                    */
+    pthread_t thread;
+    /** Epoll file descriptor (connections served by the thread)                                 */
+    int epoll_fd;
+    /** Number of connections assigned to the thread (protected by the lock of the connections) */
+    size_t conn_cnt;
+    /** Messages received during the last wakeup waiting for insertion into the queue           */
+    struct tcp_item items[GETTER_MAX_EVENTS];
+    /** Number of messages in the array of messages                                              */
+    size_t items_cnt;
+    /** Connections to be served in the next round regardless of events                         */
+    struct tcp_backlog backlog;
+    /** Current round of reading                                                                 */
+    uint64_t round;
 };
 
 /** Instance data                                                                                */
@@ -103,6 +227,8 @@ struct tcp_data {
     struct tcp_config *config;
     /** Reference to the plugin context                                                          */
     ipx_ctx_t *ctx;
+    /** TLS context (NULL, if TLS is disabled)                                                   */
+    tcp_tls_t *tls;
 
     struct {
         /** Size of the array                                                                    */
@@ -124,27 +250,133 @@ struct tcp_data {
         /** Protection of the array modification (adding/removing)                               */
         pthread_mutex_t lock;
 
-        /** Epoll file descriptor                                                                */
+        /** Epoll file descriptor (connections or the event descriptor of receiver threads)     */
         int epoll_fd;
+        /** Chunks for reading of connections without copying (NULL, if not available)           */
+        ipx_utils_chunks_t *chunks;
+        /** Connections to be served in the next round regardless of events (instance thread)   */
+        struct tcp_backlog backlog;
+        /** Current round of reading (instance thread)                                           */
+        uint64_t round;
     } active; /**< Active connections                                                            */
+
+    struct {
+        /** Number of receiver threads (zero, if connections are read by the instance thread)    */
+        size_t cnt;
+        /** Array of receiver threads                                                            */
+        struct tcp_worker *workers;
+
+        /** Protection of the queue and the termination flag                                     */
+        pthread_mutex_t lock;
+        /** Signalized when the queue is not full anymore or the threads should terminate       */
+        pthread_cond_t cond;
+        /** Event descriptor to notify the instance thread about new messages in the queue       */
+        int event_fd;
+        /** Terminate receiver threads                                                           */
+        bool stop;
+
+        /** Capacity of the queues                                                               */
+        size_t queue_max;
+        /** Number of received messages in the queue                                             */
+        size_t queue_cnt;
+        /** Queue of received messages (filled by receiver threads)                              */
+        struct tcp_item *queue;
+        /** Queue of messages being processed by the instance thread (swapped with the queue)    */
+        struct tcp_item *queue_proc;
+    } threads; /**< Receiver threads (only if multiple threads are configured)                   */
 };
 
+/**
+ * \brief Release the buffer of received data of a connection
+ *
+ * Slices of a chunk that have been already passed as messages are not affected.
+ * \param[in] pair Connection pair
+ */
+static void
+socket_buf_release(struct tcp_pair *pair)
+{
+    if (pair->buf_chunk) {
+        ipx_utils_buf_free(pair->buf);
+    } else {
+        free(pair->buf);
+    }
+
+    pair->buf = NULL;
+    pair->buf_chunk = false;
+}
+
+/**
+ * \brief Append a connection to a backlog (if not already present)
+ * \param[in] backlog Backlog
+ * \param[in] pair    Connection pair
+ */
+static void
+backlog_push(struct tcp_backlog *backlog, struct tcp_pair *pair)
+{
+    if (pair->backlog) {
+        return;
+    }
+
+    pair->backlog = true;
+    pair->backlog_prev = backlog->tail;
+    pair->backlog_next = NULL;
+    if (backlog->tail != NULL) {
+        backlog->tail->backlog_next = pair;
+    } else {
+        backlog->head = pair;
+    }
+    backlog->tail = pair;
+    backlog->cnt++;
+}
+
+/**
+ * \brief Remove a connection from a backlog (if present)
+ * \param[in] backlog Backlog
+ * \param[in] pair    Connection pair
+ */
+static void
+backlog_remove(struct tcp_backlog *backlog, struct tcp_pair *pair)
+{
+    if (!pair->backlog) {
+        return;
+    }
+
+    if (pair->backlog_prev != NULL) {
+        pair->backlog_prev->backlog_next = pair->backlog_next;
+    } else {
+        backlog->head = pair->backlog_next;
+    }
+    if (pair->backlog_next != NULL) {
+        pair->backlog_next->backlog_prev = pair->backlog_prev;
+    } else {
+        backlog->tail = pair->backlog_prev;
+    }
+
+    pair->backlog = false;
+    pair->backlog_prev = NULL;
+    pair->backlog_next = NULL;
+    backlog->cnt--;
+}
+
 /**
  * \brief Add a session into a list of active Transport Session
  *
  * The function creates for a file descriptor and a Transport Session new pair that is inserted
  * into the list of active sessions. The file descriptor is also registered on epoll instance
- * of active connections.
+ * of active connections or, if receiver threads are used, on epoll instance of the thread with
+ * the lowest number of connections.
  *
  * \param[in] data    Instance data
  * \param[in] sd      Socket descriptor of the Transport Session
  * \param[in] session Description of the Transport Session
+ * \param[in] tls     TLS state of the Transport Session (can be NULL)
  * \return #IPX_OK on success (the pair is added and the socket is registered)
  * \return #IPX_ERR_NOMEM in case of a memory allocation error
  * \return #IPX_ERR_DENIED if the epoll failed to register the socket and the pair is not added
  */
 static int
-active_session_add(struct tcp_data *data, int sd, struct ipx_session *session)
+active_session_add(struct tcp_data *data, int sd, struct ipx_session *session,
+    tcp_tls_conn_t *tls)
 {
     // Create a new pair
     struct tcp_pair *pair = calloc(1, sizeof(*pair));
@@ -155,6 +387,8 @@ active_session_add(struct tcp_data *data, int sd, struct ipx_session *session)
     pair->fd = sd;
     pair->session = session;
     pair->new_connection = true;
+    pair->tls = tls;
+    clock_gettime(CLOCK_MONOTONIC, &pair->stats.start);
 
     pthread_mutex_lock(&data->active.lock);
 
@@ -172,11 +406,25 @@ active_session_add(struct tcp_data *data, int sd, struct ipx_session *session)
     data->active.pairs = new_pairs;
     data->active.cnt++;
 
+    int epoll_fd = data->active.epoll_fd;
+    if (data->threads.cnt > 0) {
+        // Assign the connection to the least loaded receiver thread
+        struct tcp_worker *worker = &data->threads.workers[0];
+        for (size_t i = 1; i < data->threads.cnt; ++i) {
+            if (data->threads.workers[i].conn_cnt < worker->conn_cnt) {
+                worker = &data->threads.workers[i];
+            }
+        }
+
+        pair->worker = worker;
+        epoll_fd = worker->epoll_fd;
+    }
+
     // Add the session to the poll
     struct epoll_event ev;
     ev.events = EPOLLIN;
     ev.data.ptr = pair; // Pointer to the pair instead of FD
-    if (epoll_ctl(data->active.epoll_fd, EPOLL_CTL_ADD, sd, &ev) == -1) {
+    if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, sd, &ev) == -1) {
         // Failed to register the socket
         const char *err_str;
         ipx_strerror(errno, err_str);
@@ -188,6 +436,10 @@ active_session_add(struct tcp_data *data, int sd, struct ipx_session *session)
         return IPX_ERR_DENIED;
     }
 
+    if (pair->worker != NULL) {
+        pair->worker->conn_cnt++;
+    }
+
     pthread_mutex_unlock(&data->active.lock);
     return IPX_OK;
 }
@@ -199,6 +451,8 @@ active_session_add(struct tcp_data *data, int sd, struct ipx_session *session)
  * a Session Message - connect event (if necessary), close the socket and remove the corresponding
  * pair (defined by an index) from the list.
  * \warning The list MUST be locked before calling this function!
+ * \warning If the connection is served by a receiver thread, the thread MUST NOT read it anymore
+ *   (i.e. it has already deregistered the connection or the thread is not running)!
  * \param[in] data Instance data
  * \param[in] idx  Index of the pair (socket descriptor and session) to remove
  */
@@ -207,10 +461,20 @@ active_session_remove_aux(struct tcp_data *data, size_t idx)
 {
     assert(idx < data->active.cnt);
     struct tcp_pair *pair = data->active.pairs[idx];
-    IPX_CTX_INFO(data->ctx, "Closing a connection from '%s'.", pair->session->ident);
 
-    // Remove from poll
-    if (epoll_ctl(data->active.epoll_fd, EPOLL_CTL_DEL, pair->fd, NULL) == -1) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    double duration = (double) (now.tv_sec - pair->stats.start.tv_sec)
+        + (double) (now.tv_nsec - pair->stats.start.tv_nsec) / 1e9;
+    double rate = (duration > 0.0) ? ((double) pair->stats.bytes * 8.0 / duration / 1e6) : 0.0;
+    IPX_CTX_INFO(data->ctx, "Closing a connection from '%s' (%" PRIu64 " messages, %" PRIu64
+        " bytes in %.1f seconds, i.e. %.3f Mbps on average).", pair->session->ident,
+        pair->stats.msgs, pair->stats.bytes, duration, rate);
+
+    // Remove from poll (receiver threads deregister their connections by themselves)
+    if (pair->worker != NULL) {
+        pair->worker->conn_cnt--;
+    } else if (epoll_ctl(data->active.epoll_fd, EPOLL_CTL_DEL, pair->fd, NULL) == -1) {
         const char *err_str;
         ipx_strerror(errno, err_str);
         IPX_CTX_WARNING(data->ctx, "Failed to deregister the Transport Session of %s. "
@@ -247,9 +511,13 @@ active_session_remove_aux(struct tcp_data *data, size_t idx)
     }
 
     // Free internal structures and remove the pair from the list (do NOT free SESSION)
-    if (pair->msg) {
-        free(pair->msg);
+    if (pair->worker == NULL) {
+        // Backlogs of receiver threads are not used anymore when their connections are removed
+        backlog_remove(&data->active.backlog, pair);
     }
+    socket_buf_release(pair);
+    tls_conn_free(pair->tls);
+    decoder_destroy(pair->decoder);
 
     close(pair->fd);
     free(pair);
@@ -301,11 +569,42 @@ active_session_remove_by_session(struct tcp_data *data, const struct ipx_session
     return IPX_OK;
 }
 
+/**
+ * \brief Request closing of a Transport Session served by a receiver thread
+ *
+ * The connection is shut down, therefore, its receiver thread detects the end of the connection
+ * and lets the instance thread remove it after all its already received messages.
+ * \param[in] data    Instance data
+ * \param[in] session Session to close
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_NOTFOUND if the session is not present in the list
+ */
+static int
+active_session_shutdown(struct tcp_data *data, const struct ipx_session *session)
+{
+    int rc = IPX_ERR_NOTFOUND;
+
+    pthread_mutex_lock(&data->active.lock);
+    for (size_t i = 0; i < data->active.cnt; ++i) {
+        struct tcp_pair *pair = data->active.pairs[i];
+        if (pair->session != session) {
+            continue;
+        }
+
+        shutdown(pair->fd, SHUT_RDWR);
+        rc = IPX_OK;
+        break;
+    }
+    pthread_mutex_unlock(&data->active.lock);
+    return rc;
+}
+
 /**
  * \brief Add a new connection
  *
- * Socket parameters are configured for the socket (such as receive timeout), the connection
- * is inserted into active connections and registered on the epoll instance of active connections.
+ * Socket parameters are configured for the socket (such as receive timeout), TLS handshake is
+ * performed (if enabled), the connection is inserted into active connections and registered on
+ * the epoll instance of active connections.
  * \param[in] data Instance data
  * \param[in] sd   Socket descriptor to add
  * \return #IPX_OK on success
@@ -317,21 +616,14 @@ listener_add_connection(struct tcp_data *data, int sd)
     assert(sd >= 0);
     const char *err_str;
 
-    // Set non-blocking mode on the socket
-    int flags = fcntl(sd, F_GETFL, 0);
-    if (flags == -1) {
-        ipx_strerror(errno, err_str);
-        IPX_CTX_WARNING(data->ctx, "Listener: Failed to set non-blocking mode: fcntl() failed: %s",
-            err_str);
-        return IPX_ERR_DENIED;
-    }
-
-    flags |= O_NONBLOCK;
-    if (fcntl(sd, F_SETFL, flags) == -1) {
+    // Get the time of reception by the kernel with received data (only for latency measurement)
+    const int on = 1;
+    if (ipx_latency_enabled()
+            && setsockopt(sd, SOL_SOCKET, SO_TIMESTAMPNS, &on, sizeof(on)) == -1) {
         ipx_strerror(errno, err_str);
-        IPX_CTX_WARNING(data->ctx, "Listener: Failed to set non-blocking mode: fcntl() failed: %s",
+        IPX_CTX_WARNING(data->ctx, "Listener: Cannot turn on socket option SO_TIMESTAMPNS. "
+            "Latency of messages is measured since they're processed by the plugin. (error: %s)",
             err_str);
-        return IPX_ERR_DENIED;
     }
 
     // Get the description of the remove address
@@ -396,14 +688,40 @@ listener_add_connection(struct tcp_data *data, int sd)
     char src_addr_str[INET6_ADDRSTRLEN] = {0};
     inet_ntop(net.l3_proto, &net.addr_src, src_addr_str, INET6_ADDRSTRLEN);
 
+    // TLS handshake (in blocking mode, so readers of active connections are never blocked)
+    tcp_tls_conn_t *tls = NULL;
+    if (data->tls != NULL && tls_accept(data->tls, sd, src_addr_str, &tls) != IPX_OK) {
+        return IPX_ERR_DENIED;
+    }
+
+    // Set non-blocking mode on the socket
+    int flags = fcntl(sd, F_GETFL, 0);
+    if (flags == -1) {
+        ipx_strerror(errno, err_str);
+        IPX_CTX_WARNING(data->ctx, "Listener: Failed to set non-blocking mode: fcntl() failed: %s",
+            err_str);
+        tls_conn_free(tls);
+        return IPX_ERR_DENIED;
+    }
+
+    flags |= O_NONBLOCK;
+    if (fcntl(sd, F_SETFL, flags) == -1) {
+        ipx_strerror(errno, err_str);
+        IPX_CTX_WARNING(data->ctx, "Listener: Failed to set non-blocking mode: fcntl() failed: %s",
+            err_str);
+        tls_conn_free(tls);
+        return IPX_ERR_DENIED;
+    }
+
     struct ipx_session *session = ipx_session_new_tcp(&net);
-    if (!session || active_session_add(data, sd, session) != IPX_OK) {
+    if (!session || active_session_add(data, sd, session, tls) != IPX_OK) {
         // Failed to add the session
         IPX_CTX_ERROR(data->ctx, "Listener: Failed to add internal information about a new "
             "Transport Session from '%s'! Connection rejected.", src_addr_str);
         if (session != NULL) {
             ipx_session_destroy(session);
         }
+        tls_conn_free(tls);
         return IPX_ERR_DENIED;
     }
 
@@ -766,7 +1084,7 @@ listener_destroy(struct tcp_data *instance)
 /**
  * \brief Initialize the active structure of the instance
  *
- * Initialize empty epoll and lock of the active connections.
+ * Initialize empty epoll, lock and shared buffers (chunks) of the active connections.
  * \param[in] ctx      Instance context
  * \param[in] instance Instance data
  * \return #IPX_OK on success
@@ -796,13 +1114,20 @@ active_init(ipx_ctx_t *ctx, struct tcp_data *instance)
     instance->active.cnt = 0;
     instance->active.pairs = NULL;
     instance->active.epoll_fd = epoll_fd;
+
+    // Chunks are optional, messages can be also copied from private buffers of connections
+    instance->active.chunks = ipx_utils_chunks_create(BUFFER_SIZE, BUFFER_CHUNKS);
+    if (!instance->active.chunks) {
+        IPX_CTX_WARNING(ctx, "Failed to create shared buffers of connections. Received messages "
+            "will be copied.", '\0');
+    }
     return IPX_OK;
 }
 
 /**
  * \brief Destroy the active structure of the instance
  *
- * Send Session messages that all connection were closed, destroy the lock and epoll.
+ * Send Session messages that all connection were closed, destroy the lock, epoll and chunks.
  * \warning Make sure that acceptor thread is not running!
  * \param[in] ctx      Instance context
  * \param[in] instance Instance data
@@ -822,190 +1147,390 @@ active_destroy(ipx_ctx_t *ctx, struct tcp_data *instance)
     close(instance->active.epoll_fd);
     free(instance->active.pairs);
     instance->active.cnt = 0;
+
+    // Chunks are released after the last message that refers to them
+    ipx_utils_chunks_destroy(instance->active.chunks);
+    instance->active.chunks = NULL;
 }
 
 /**
- * \brief Try to read an IPFIX Message header
- *
- * The whole header might not be available right now. In that case, the function
- * will only read and store available part and it will successfully return. When
- * this happens, the allocated message is smaller that IPFIX Message header. The
- * next call of this function will tried to read the rest.
+ * \brief Receive data from a socket and get the time of their reception by the kernel
  *
- * If the whole header is available, the function will allocate message buffer
- * sufficient for the rest of the message.
+ * The timestamp is available only if the SO_TIMESTAMPNS option is enabled on the socket.
+ * If data are decrypted by kernel TLS, only application data are accepted. An alert (e.g.
+ * close_notify) is reported as a closed connection and other records as a protocol error.
+ * \param[in]  fd     Socket descriptor
+ * \param[in]  buffer Output buffer
+ * \param[in]  size   Size of the output buffer
+ * \param[out] ts     Timestamp (realtime clock, zero if not available)
+ * \return The same as recv()
+ */
+static ssize_t
+socket_recv_stamp(int fd, void *buffer, size_t size, struct timespec *ts)
+{
+    union {
+        struct cmsghdr hdr; // Only for alignment
+        uint8_t data[CMSG_SPACE(sizeof(struct timespec)) + CMSG_SPACE(sizeof(uint8_t))];
+    } ctrl;
+    struct iovec iov = {.iov_base = buffer, .iov_len = size};
+    struct msghdr msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = ctrl.data;
+    msg.msg_controllen = sizeof(ctrl.data);
+    memset(ts, 0, sizeof(*ts));
+
+    ssize_t len = recvmsg(fd, &msg, 0);
+    if (len <= 0) {
+        return len;
+    }
+
+    for (struct cmsghdr *cmsg = CMSG_FIRSTHDR(&msg); cmsg; cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+        if (cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_TIMESTAMPNS) {
+            memcpy(ts, CMSG_DATA(cmsg), sizeof(*ts));
+            continue;
+        }
+
+        if (cmsg->cmsg_level != SOL_TLS || cmsg->cmsg_type != TLS_GET_RECORD_TYPE) {
+            continue;
+        }
+
+        const uint8_t type = *CMSG_DATA(cmsg);
+        if (type == TLS_RECORD_ALERT) {
+            return 0;
+        }
+        if (type != TLS_RECORD_DATA) {
+            // Other records (e.g. key update) cannot be processed by the kernel
+            errno = EPROTO;
+            return -1;
+        }
+    }
+
+    return len;
+}
+
+/**
+ * \brief Make sure that the buffer of a connection has enough free space for reading
  *
- * \param[in] ctx  Instance data (necessary for passing messages)
- * \param[in] pair Connection pair (socket descriptor and session) to receive from
+ * If the free space at the end of the buffer is too small, unprocessed data (i.e. the beginning
+ * of an incomplete message) are moved to the beginning of a new chunk. If no chunk is available,
+ * a private buffer of the connection is used instead and messages are copied out of it.
+ * \param[in] data Instance data
+ * \param[in] pair Connection pair
  * \return #IPX_OK on success
- * \return #IPX_ERR_EOF if the socket has been closed
- * \return #IPX_ERR_FORMAT if the message (or stream) is malformed and the connection MUST be closed
  * \return #IPX_ERR_NOMEM on a memory allocation error and the connection MUST be closed
  */
 static int
-socket_process_receive_header(ipx_ctx_t *ctx, struct tcp_pair *pair)
+socket_buf_prepare(struct tcp_data *data, struct tcp_pair *pair)
 {
-    struct fds_ipfix_msg_hdr hdr = {0};
-    uint8_t *hdr_raw = (uint8_t *) &hdr;
+    if (pair->buf != NULL && !pair->buf_chunk && pair->buf_start == pair->buf_end) {
+        // Nothing refers to the private buffer, read from its beginning
+        pair->buf_start = 0;
+        pair->buf_end = 0;
+        pair->ts_offset = 0;
+    }
 
-    uint16_t remains = FDS_IPFIX_MSG_HDR_LEN;
-    uint16_t offset = 0;
-    ssize_t len;
+    if (pair->buf != NULL && BUFFER_SIZE - pair->buf_end >= BUFFER_MIN_FREE) {
+        return IPX_OK;
+    }
 
-    uint8_t *msg_buffer;
-    uint16_t msg_version;
-    uint16_t msg_size;
+    const size_t rest = pair->buf_end - pair->buf_start;
+    uint8_t *new_buf = NULL;
+    if (data->active.chunks != NULL) {
+        new_buf = ipx_utils_chunks_take(data->active.chunks);
+    }
 
-    assert(!pair->msg || pair->msg_offset < FDS_IPFIX_MSG_HDR_LEN);
+    const bool new_chunk = (new_buf != NULL);
+    if (!new_chunk && pair->buf != NULL && !pair->buf_chunk) {
+        // Reuse the private buffer
+        memmove(pair->buf, &pair->buf[pair->buf_start], rest);
+    } else {
+        if (!new_chunk && (new_buf = malloc(BUFFER_SIZE)) == NULL) {
+            IPX_CTX_ERROR(data->ctx,
+                "Connection with '%s' closed due to memory allocation failure! (%s:%d).",
+                pair->session->ident, __FILE__, __LINE__);
+            return IPX_ERR_NOMEM;
+        }
 
-    if (pair->msg) {
-        // Fill the header with previously received data
-        offset = pair->msg_offset;
-        remains = FDS_IPFIX_MSG_HDR_LEN - offset;
+        if (pair->buf != NULL) {
+            // Slices of the previous chunk are not affected
+            memcpy(new_buf, &pair->buf[pair->buf_start], rest);
+            socket_buf_release(pair);
+        }
 
-        memcpy(hdr_raw, pair->msg, offset);
+        pair->buf = new_buf;
+        pair->buf_chunk = new_chunk;
     }
 
-    len = recv(pair->fd, &hdr_raw[offset], remains, 0);
-    if (len == 0) {
-        // Connection has been closed
-        if (offset > 0) {
-            IPX_CTX_WARNING(ctx, "Connection with '%s' has been unexpectly closed",
-                pair->session->ident);
-            return IPX_ERR_FORMAT;
-        } else {
-            IPX_CTX_INFO(ctx, "Connection with '%s' closed.", pair->session->ident);
-            return IPX_ERR_EOF;
-        }
+    pair->ts_offset = (pair->ts_offset > pair->buf_start) ? pair->ts_offset - pair->buf_start : 0;
+    pair->buf_start = 0;
+    pair->buf_end = rest;
+    return IPX_OK;
+}
+
+/**
+ * \brief Read data from a socket (decrypted, if TLS is decrypted by the plugin)
+ * \param[in]  pair   Connection pair
+ * \param[in]  buffer Output buffer
+ * \param[in]  size   Size of the output buffer
+ * \param[out] ts     Time of reception by the kernel (zero if not available)
+ * \return The same as recv()
+ */
+static inline ssize_t
+socket_read(struct tcp_pair *pair, uint8_t *buffer, size_t size, struct timespec *ts)
+{
+    if (pair->tls != NULL) {
+        memset(ts, 0, sizeof(*ts));
+        return tls_recv(pair->tls, buffer, size);
     }
 
-    if (len < 0) {
-        // Something went wrong
-        const char *err_str;
+    return socket_recv_stamp(pair->fd, buffer, size, ts);
+}
 
-        if (errno == EWOULDBLOCK || errno == EAGAIN) {
-            return IPX_OK;
-        }
+/**
+ * \brief Detect compression of a stream by the first bytes of the stream
+ *
+ * If the stream is compressed, the received bytes are moved into the input of a new decoder.
+ * \param[in] data Instance data
+ * \param[in] pair Connection pair
+ * \return #IPX_OK on success (even if more data are necessary)
+ * \return #IPX_ERR_FORMAT if the compression is not supported and the connection MUST be closed
+ */
+static int
+socket_stream_detect(struct tcp_data *data, struct tcp_pair *pair)
+{
+    const uint8_t *start = &pair->buf[pair->buf_start];
+    const size_t size = pair->buf_end - pair->buf_start;
+    const enum decoder_type type = decoder_detect(start, size);
 
-        ipx_strerror(errno, err_str);
-        IPX_CTX_WARNING(ctx, "Connection with '%s' failed: %s",
-            pair->session->ident, err_str);
+    switch (type) {
+    case DECODER_UNKNOWN:
+        // Not enough data, try it later...
+        return IPX_OK;
+    case DECODER_PLAIN:
+        pair->stream_detected = true;
+        return IPX_OK;
+    default:
+        break;
+    }
+
+    pair->decoder = decoder_create(data->ctx, type, pair->session->ident);
+    if (!pair->decoder) {
         return IPX_ERR_FORMAT;
     }
 
-    offset += len;
+    size_t in_size;
+    uint8_t *in = decoder_in_space(pair->decoder, &in_size);
+    assert(in_size >= size);
+    memcpy(in, start, size);
+    decoder_in_commit(pair->decoder, size);
+    pair->buf_end = pair->buf_start;
+    pair->stream_detected = true;
+    return IPX_OK;
+}
 
-    if (offset < FDS_IPFIX_MSG_HDR_LEN) {
-        // We don't have whole IPFIX Message header
-        uint8_t *ptr = realloc(pair->msg, offset);
-        if (!ptr) {
-            IPX_CTX_ERROR(ctx,
-                "Connection with '%s' closed due to memory allocation failure! (%s:%d).",
-                pair->session->ident, __FILE__, __LINE__);
-            return IPX_ERR_NOMEM;
+/**
+ * \brief Check if a connection has data that have been received but not processed yet
+ *
+ * This happens if the decompressed data haven't fit into the buffer of the connection. Since the
+ * socket might not be readable anymore, the data MUST be processed without waiting for a new
+ * event (see socket_process_receive()).
+ * \param[in] pair Connection pair
+ * \return True or false
+ */
+static inline bool
+socket_pending(const struct tcp_pair *pair)
+{
+    return pair->decoder != NULL && decoder_pending(pair->decoder);
+}
+
+/**
+ * \brief Receive available data from a socket into the buffer of a connection
+ *
+ * Up to the whole free space of the buffer is read at once, therefore, the data can contain
+ * multiple messages. Complete messages are taken by socket_msg_next(). If the stream is
+ * compressed, received data are decompressed into the buffer. If compressed data haven't been
+ * fully decompressed yet (see socket_pending()), the function only continues with their
+ * decompression.
+ * \param[in] data Instance data
+ * \param[in] pair Connection pair (socket descriptor and session) to receive from
+ * \return #IPX_OK on success (even if no data are available right now)
+ * \return #IPX_ERR_EOF if the socket has been closed
+ * \return #IPX_ERR_FORMAT if the stream is broken and the connection MUST be closed
+ * \return #IPX_ERR_NOMEM on a memory allocation error and the connection MUST be closed
+ */
+static int
+socket_process_receive(struct tcp_data *data, struct tcp_pair *pair)
+{
+    ipx_ctx_t *ctx = data->ctx;
+    int ret = socket_buf_prepare(data, pair);
+    if (ret != IPX_OK) {
+        return ret;
+    }
+
+    struct timespec ts = pair->ts_last;
+    ssize_t len = 0;
+    if (!socket_pending(pair)) {
+        uint8_t *buf_free;
+        size_t size_free;
+        if (pair->decoder != NULL) {
+            buf_free = decoder_in_space(pair->decoder, &size_free);
+        } else if (!pair->stream_detected) {
+            // Read only the beginning of the stream to detect its compression
+            buf_free = &pair->buf[pair->buf_end];
+            size_free = DECODER_MAGIC_LEN - (pair->buf_end - pair->buf_start);
+        } else {
+            buf_free = &pair->buf[pair->buf_end];
+            size_free = BUFFER_SIZE - pair->buf_end;
         }
 
-        memcpy(ptr, hdr_raw, offset);
-        pair->msg = ptr;
-        pair->msg_offset = offset;
-        pair->msg_size = offset;
+        len = socket_read(pair, buf_free, size_free, &ts);
+        if (len == 0) {
+            // Connection has been closed
+            if (pair->buf_start != pair->buf_end) {
+                IPX_CTX_WARNING(ctx, "Connection with '%s' has been unexpectly closed",
+                    pair->session->ident);
+                return IPX_ERR_FORMAT;
+            } else {
+                IPX_CTX_INFO(ctx, "Connection with '%s' closed.", pair->session->ident);
+                return IPX_ERR_EOF;
+            }
+        }
 
-        return IPX_OK;
-    }
+        if (len < 0) {
+            // Something went wrong
+            const char *err_str;
 
-    // Check the IPFIX Message header
-    msg_version = ntohs(hdr.version);
-    msg_size = ntohs(hdr.length);
+            if (errno == EWOULDBLOCK || errno == EAGAIN) {
+                return IPX_OK;
+            }
 
-    if (msg_version != FDS_IPFIX_VERSION || msg_size < FDS_IPFIX_MSG_HDR_LEN) {
-        // Invalid header version
-        IPX_CTX_WARNING(ctx,
-            "Connection with '%s' closed due to invalid IPFIX Message header.",
-            pair->session->ident);
-        return IPX_ERR_FORMAT;
+            ipx_strerror(errno, err_str);
+            IPX_CTX_WARNING(ctx, "Connection with '%s' failed: %s",
+                pair->session->ident, err_str);
+            return IPX_ERR_FORMAT;
+        }
+
+        if (pair->decoder != NULL) {
+            decoder_in_commit(pair->decoder, (size_t) len);
+        }
     }
 
-    // Preallocated buffer for the rest of the IPFIX Message body
-    msg_buffer = realloc(pair->msg, msg_size);
-    if (!msg_buffer) {
-        IPX_CTX_ERROR(ctx,
-            "Connection with '%s' closed due to memory allocation failure! (%s:%d).",
-            pair->session->ident, __FILE__, __LINE__);
-        return IPX_ERR_NOMEM;
+    if (pair->decoder != NULL) {
+        // Decompress into the buffer
+        size_t out_size = BUFFER_SIZE - pair->buf_end;
+        if (decoder_run(pair->decoder, &pair->buf[pair->buf_end], &out_size) != IPX_OK) {
+            IPX_CTX_WARNING(ctx, "Connection with '%s' closed due to a corrupted compressed "
+                "stream.", pair->session->ident);
+            return IPX_ERR_FORMAT;
+        }
+        len = (ssize_t) out_size;
+    }
+
+    if (len == 0) {
+        return IPX_OK;
     }
 
-    memcpy(msg_buffer, hdr_raw, FDS_IPFIX_MSG_HDR_LEN);
-    pair->msg = msg_buffer;
-    pair->msg_offset = FDS_IPFIX_MSG_HDR_LEN;
-    pair->msg_size = msg_size;
+    pair->stats.bytes += (uint64_t) len;
+    pair->deficit -= (int64_t) len;
 
-    return IPX_OK;
+    if (pair->buf_start == pair->buf_end) {
+        // The beginning of a new message
+        pair->ts_first = ts;
+    }
+
+    pair->ts_offset = pair->buf_end;
+    pair->ts_last = ts;
+    pair->buf_end += (size_t) len;
+    return pair->stream_detected ? IPX_OK : socket_stream_detect(data, pair);
 }
 
 /**
- * \brief Try to read an IPFIX Message body
+ * \brief Take the next complete IPFIX Message from the buffer of a connection
  *
- * The whole body might not be available right now. In that case, the function
- * will only read and store available part and it will successfully return. When
- * this happens, the message offset is smaller that the message size. The next call
- * of this function will tried to read the rest.
- *
- * \param[in] ctx  Instance data (necessary for passing messages)
- * \param[in] pair Connection pair (socket descriptor and session) to receive from
+ * If the buffer is a chunk, the message is a slice of the chunk. Otherwise, it is copied into
+ * a new buffer.
+ * \param[in]  data Instance data
+ * \param[in]  pair Connection pair
+ * \param[out] item Message (allocated by ipx_utils_buf_alloc() or a slice of a chunk)
  * \return #IPX_OK on success
+ * \return #IPX_ERR_NOTFOUND if no complete message is available
  * \return #IPX_ERR_FORMAT if the message (or stream) is malformed and the connection MUST be closed
  * \return #IPX_ERR_NOMEM on a memory allocation error and the connection MUST be closed
  */
 static int
-socket_process_receive_body(ipx_ctx_t *ctx, struct tcp_pair *pair)
+socket_msg_next(struct tcp_data *data, struct tcp_pair *pair, struct tcp_item *item)
 {
-    const uint16_t remains = pair->msg_size - pair->msg_offset;
-    assert(pair->msg && pair->msg_offset >= FDS_IPFIX_MSG_HDR_LEN);
-
-    if (remains == 0) {
-        // This is an IPFIX Message without body...
-        return IPX_OK;
+    const size_t avail = pair->buf_end - pair->buf_start;
+    if (avail < FDS_IPFIX_MSG_HDR_LEN) {
+        return IPX_ERR_NOTFOUND;
     }
 
-    ssize_t len = recv(pair->fd, &pair->msg[pair->msg_offset], remains, 0);
-    if (len == 0) {
-        // Connection closed
-        IPX_CTX_WARNING(ctx, "Connection from '%s' has been unexpectly closed",
+    // Check the IPFIX Message header (the message is not aligned in the stream)
+    uint8_t *msg_start = &pair->buf[pair->buf_start];
+    struct fds_ipfix_msg_hdr hdr;
+    memcpy(&hdr, msg_start, FDS_IPFIX_MSG_HDR_LEN);
+    const uint16_t msg_version = ntohs(hdr.version);
+    const uint16_t msg_size = ntohs(hdr.length);
+
+    if (msg_version != FDS_IPFIX_VERSION || msg_size < FDS_IPFIX_MSG_HDR_LEN) {
+        // Invalid header version
+        IPX_CTX_WARNING(data->ctx,
+            "Connection with '%s' closed due to invalid IPFIX Message header.",
             pair->session->ident);
         return IPX_ERR_FORMAT;
     }
 
-    if (len < 0) {
-        // Something went wrong
-        const char *err_str;
+    if (avail < msg_size) {
+        // Incomplete IPFIX Message, read the rest later...
+        return IPX_ERR_NOTFOUND;
+    }
 
-        if (errno == EWOULDBLOCK || errno == EAGAIN) {
-            return IPX_OK;
+    uint8_t *msg;
+    if (pair->buf_chunk) {
+        msg = ipx_utils_chunks_slice(data->active.chunks, msg_start);
+    } else {
+        msg = ipx_utils_buf_alloc(msg_size);
+        if (!msg) {
+            IPX_CTX_ERROR(data->ctx,
+                "Connection with '%s' closed due to memory allocation failure! (%s:%d).",
+                pair->session->ident, __FILE__, __LINE__);
+            return IPX_ERR_NOMEM;
         }
-
-        ipx_strerror(errno, err_str);
-        IPX_CTX_WARNING(ctx, "Connection with '%s' failed: %s",
-            pair->session->ident, err_str);
-        return IPX_ERR_FORMAT;
+        memcpy(msg, msg_start, msg_size);
     }
 
-    pair->msg_offset += (uint16_t) len;
+    item->pair = pair;
+    item->msg = msg;
+    item->msg_size = msg_size;
+    item->msg_ts = (pair->buf_start >= pair->ts_offset) ? pair->ts_last : pair->ts_first;
+
+    pair->stats.msgs++;
+    pair->buf_start += msg_size;
+    if (pair->buf_start >= pair->ts_offset) {
+        // The next message starts in data of the last read
+        pair->ts_first = pair->ts_last;
+    }
     return IPX_OK;
 }
 
 /**
  * \brief Try to pass fully received IPFIX Message to the collector.
  *
- * \param[in] ctx  Instance data (necessary for passing messages)
- * \param[in] pair Connection pair (socket descriptor and session)
+ * \note The message is always consumed (i.e. passed or freed).
+ * \param[in] ctx      Instance data (necessary for passing messages)
+ * \param[in] pair     Connection pair (socket descriptor and session) of the message
+ * \param[in] msg_data Message (allocated by ipx_utils_buf_alloc())
+ * \param[in] msg_size Size of the message
+ * \param[in] msg_ts   Time of reception of the beginning of the message by the kernel (or zero)
  * \return #IPX_OK on success
  * \return #IPX_ERR_NOMEM on a memory allocation error and the connection MUST be closed
  */
 static int
-socket_process_pass_msg(ipx_ctx_t *ctx, struct tcp_pair *pair)
+socket_pass_msg(ipx_ctx_t *ctx, struct tcp_pair *pair, uint8_t *msg_data, uint16_t msg_size,
+    const struct timespec *msg_ts)
 {
-    assert(pair->msg && pair->msg_offset == pair->msg_size && "Partly received message");
-
     if (pair->new_connection) {
         // Send information about the new Transport Session
         ipx_msg_session_t *msg = ipx_msg_session_create(pair->session, IPX_MSG_SESSION_OPEN);
@@ -1013,6 +1538,7 @@ socket_process_pass_msg(ipx_ctx_t *ctx, struct tcp_pair *pair)
             IPX_CTX_ERROR(ctx,
                 "Connection with '%s' closed due to memory allocation failure! (%s:%d).",
                 pair->session->ident, __FILE__, __LINE__);
+            ipx_utils_buf_free(msg_data);
             return IPX_ERR_NOMEM;
         }
 
@@ -1023,67 +1549,475 @@ socket_process_pass_msg(ipx_ctx_t *ctx, struct tcp_pair *pair)
     // Create a message wrapper and pass the message
     struct ipx_msg_ctx msg_ctx;
     msg_ctx.session = pair->session;
-    msg_ctx.odid = ntohl(((struct fds_ipfix_msg_hdr *) pair->msg)->odid);
+    msg_ctx.odid = ntohl(((struct fds_ipfix_msg_hdr *) msg_data)->odid);
     msg_ctx.stream = 0; // Streams are not supported over TCP
 
-    ipx_msg_ipfix_t *msg = ipx_msg_ipfix_create(ctx, &msg_ctx, pair->msg, pair->msg_size);
+    ipx_msg_ipfix_t *msg = ipx_msg_ipfix_create(ctx, &msg_ctx, msg_data, msg_size);
     if (!msg) {
         IPX_CTX_ERROR(ctx,
             "Connection with '%s' closed due to memory allocation failure! (%s:%d).",
             pair->session->ident, __FILE__, __LINE__);
+        ipx_utils_buf_free(msg_data);
         return IPX_ERR_NOMEM;
     }
 
-    ipx_ctx_msg_pass(ctx, ipx_msg_ipfix2base(msg));
-
-    pair->msg = NULL;
-    pair->msg_offset = 0;
-    pair->msg_size = 0;
+    struct ipx_msg_ctx *ctx_ptr = ipx_msg_ipfix_get_ctx(msg);
+    if ((msg_ts->tv_sec != 0 || msg_ts->tv_nsec != 0) && ctx_ptr->ingress_ts != 0) {
+        // Measure latency since the arrival of the message, not since its processing
+        ctx_ptr->ingress_ts = ipx_latency_from_realtime(msg_ts);
+    }
 
+    ipx_ctx_msg_pass(ctx, ipx_msg_ipfix2base(msg));
     return IPX_OK;
 }
 
 /**
- * \brief Get an IPFIX message from a socket and pass it
+ * \brief Pass a message received by the instance thread (callback of socket_process())
+ * \param[in] arg  Plugin context
+ * \param[in] item Message
+ * \return The same as socket_pass_msg()
+ */
+static int
+socket_pass_item(void *arg, struct tcp_item *item)
+{
+    return socket_pass_msg((ipx_ctx_t *) arg, item->pair, item->msg, item->msg_size,
+        &item->msg_ts);
+}
+
+/**
+ * \brief Callback for each complete message taken by socket_process()
+ * \note The message MUST be always consumed (i.e. passed or freed) by the callback.
+ * \return #IPX_OK to continue, other codes stop processing of the connection
+ */
+typedef int (*socket_item_cb)(void *arg, struct tcp_item *item);
+
+/**
+ * \brief Get IPFIX messages from a socket within the budget of the connection
  *
- * \param[in] ctx  Instance data (necessary for passing messages)
- * \param[in] pair Connection pair (socket descriptor and session) to receive from
+ * Connections are served by deficit round-robin, so an exporter with a huge backlog cannot
+ * monopolize the reading thread while kernel buffers of other connections overflow. In each
+ * round, the budget (see the configuration) is added to the deficit of the connection and data
+ * are received until the deficit is exhausted or no more data are available right now. In the
+ * latter case, the rest of the deficit is dropped. Since a single read can exceed the deficit,
+ * the overdraft is subtracted from the next round.
+ *
+ * If the deficit has been exhausted while decompressed data are still pending, the connection
+ * is appended to the backlog, because such data don't trigger any epoll event.
+ * \param[in] data    Instance data
+ * \param[in] pair    Connection pair (socket descriptor and session) to receive from
+ * \param[in] backlog Backlog of the thread reading the connection
+ * \param[in] cb      Callback for each complete message
+ * \param[in] cb_arg  Argument of the callback
  * \return #IPX_OK on success
  * \return #IPX_ERR_EOF if the socket is closed
  * \return #IPX_ERR_FORMAT if the message (or stream) is malformed and the connection MUST be closed
  * \return #IPX_ERR_NOMEM on a memory allocation error and the connection MUST be closed
+ * \return Other codes returned by the callback
  */
 static int
-socket_process(ipx_ctx_t *ctx, struct tcp_pair *pair)
+socket_process(struct tcp_data *data, struct tcp_pair *pair, struct tcp_backlog *backlog,
+    socket_item_cb cb, void *cb_arg)
 {
-    int ret;
+    pair->deficit += data->config->budget;
 
-    if (!pair->msg || pair->msg_offset < FDS_IPFIX_MSG_HDR_LEN) {
-        // Try to receive IPFIX Message header first
-        ret = socket_process_receive_header(ctx, pair);
+    while (pair->deficit > 0) {
+        const uint64_t bytes_prev = pair->stats.bytes;
+        int ret = socket_process_receive(data, pair);
         if (ret != IPX_OK) {
             return ret;
         }
 
-        if (pair->msg_offset < FDS_IPFIX_MSG_HDR_LEN) {
-            // Incomplete IPFIX Message header, read the rest later...
+        // Pass all complete messages
+        struct tcp_item item;
+        while ((ret = socket_msg_next(data, pair, &item)) == IPX_OK) {
+            ret = cb(cb_arg, &item);
+            if (ret != IPX_OK) {
+                return ret;
+            }
+        }
+
+        if (ret != IPX_ERR_NOTFOUND) {
+            return ret;
+        }
+
+        if (pair->stats.bytes == bytes_prev && !socket_pending(pair)) {
+            // No more data right now (incomplete IPFIX Message, read the rest later...)
+            pair->deficit = 0;
             return IPX_OK;
         }
     }
 
-    // Receive rest of the message body
-    ret = socket_process_receive_body(ctx, pair);
-    if (ret != IPX_OK) {
-        return ret;
+    if (socket_pending(pair)) {
+        backlog_push(backlog, pair);
+    }
+    return IPX_OK;
+}
+
+/**
+ * \brief Pass messages received by a receiver thread to the instance thread
+ *
+ * If the queue is full, the function blocks until the instance thread takes all messages.
+ * \param[in] worker Receiver thread
+ * \param[in] cnt    Number of messages prepared by the thread
+ * \return True on success
+ * \return False if the thread should terminate (messages are dropped)
+ */
+static bool
+worker_push(struct tcp_worker *worker, size_t cnt)
+{
+    struct tcp_data *instance = worker->instance;
+    if (cnt == 0) {
+        return true;
+    }
+
+    pthread_mutex_lock(&instance->threads.lock);
+    while (!instance->threads.stop
+            && instance->threads.queue_cnt + cnt > instance->threads.queue_max) {
+        pthread_cond_wait(&instance->threads.cond, &instance->threads.lock);
+    }
+
+    const bool stop = instance->threads.stop;
+    const bool notify = (instance->threads.queue_cnt == 0);
+    if (!stop) {
+        struct tcp_item *dst = &instance->threads.queue[instance->threads.queue_cnt];
+        memcpy(dst, worker->items, cnt * sizeof(*dst));
+        instance->threads.queue_cnt += cnt;
+    }
+    pthread_mutex_unlock(&instance->threads.lock);
+
+    if (stop) {
+        // Closed connections are removed by the instance during its destruction
+        for (size_t i = 0; i < cnt; ++i) {
+            ipx_utils_buf_free(worker->items[i].msg);
+        }
+        return false;
     }
 
-    if (pair->msg_offset < pair->msg_size) {
-        // Incomplete IPFIX Message body, read the rest later...
+    // Wake up the instance thread only if it's not already aware of messages in the queue
+    const uint64_t value = 1;
+    if (notify && write(instance->threads.event_fd, &value, sizeof(value)) == -1) {
+        const char *err_str;
+        ipx_strerror(errno, err_str);
+        IPX_CTX_WARNING(instance->ctx, "Failed to notify the instance thread: %s", err_str);
+    }
+
+    return true;
+}
+
+/**
+ * \brief Add a message to the array of messages of a receiver thread (callback of socket_process())
+ *
+ * If the array is full, all messages are passed to the instance thread.
+ * \param[in] arg  Receiver thread
+ * \param[in] item Message (or a notification about a closed connection)
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_DENIED if the thread should terminate (messages are dropped)
+ */
+static int
+worker_item_add(void *arg, struct tcp_item *item)
+{
+    struct tcp_worker *worker = (struct tcp_worker *) arg;
+    worker->items[worker->items_cnt++] = *item;
+    if (worker->items_cnt < GETTER_MAX_EVENTS) {
         return IPX_OK;
     }
 
-    // Pass the message
-    return socket_process_pass_msg(ctx, pair);
+    const bool run = worker_push(worker, worker->items_cnt);
+    worker->items_cnt = 0;
+    return run ? IPX_OK : IPX_ERR_DENIED;
+}
+
+/**
+ * \brief Main function of a receiver thread
+ *
+ * The thread receives messages from its connections and passes them to the instance thread
+ * until termination is requested. If a connection is closed or broken, the thread stops reading
+ * it and lets the instance thread remove it.
+ * \param[in] arg Receiver thread (struct tcp_worker)
+ * \return Always NULL
+ */
+static void *
+worker_thread(void *arg)
+{
+    struct tcp_worker *worker = (struct tcp_worker *) arg;
+    struct tcp_data *instance = worker->instance;
+    struct epoll_event ev[GETTER_MAX_EVENTS];
+    bool run = true;
+
+    while (run) {
+        // Connections in the backlog are served without waiting for events
+        const int timeout = (worker->backlog.cnt > 0) ? 0 : WORKER_TIMEOUT;
+        int ev_valid = epoll_wait(worker->epoll_fd, ev, GETTER_MAX_EVENTS, timeout);
+        if (ev_valid == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+
+            const char *err_str;
+            ipx_strerror(errno, err_str);
+            IPX_CTX_ERROR(instance->ctx, "epoll_wait() failed: %s. Receiver thread %zu has "
+                "been terminated!", err_str, worker->id);
+            break;
+        }
+
+        if (ev_valid == 0 && worker->backlog.cnt == 0) {
+            // Timeout
+            pthread_mutex_lock(&instance->threads.lock);
+            run = !instance->threads.stop;
+            pthread_mutex_unlock(&instance->threads.lock);
+            continue;
+        }
+
+        // A new round: connections from the backlog first, then connections with events
+        const uint64_t round = ++worker->round;
+        const size_t backlog_cnt = worker->backlog.cnt;
+        for (size_t i = 0; i < backlog_cnt + (size_t) ev_valid && run; ++i) {
+            struct tcp_pair *pair;
+            if (i < backlog_cnt) {
+                pair = worker->backlog.head;
+                backlog_remove(&worker->backlog, pair);
+            } else {
+                pair = (struct tcp_pair *) ev[i - backlog_cnt].data.ptr;
+            }
+
+            if (pair->round == round) {
+                // Already served in this round
+                continue;
+            }
+            pair->round = round;
+
+            int ret = socket_process(instance, pair, &worker->backlog, &worker_item_add, worker);
+            if (ret == IPX_OK) {
+                continue;
+            }
+            if (ret == IPX_ERR_DENIED) {
+                // Termination
+                run = false;
+                break;
+            }
+
+            // The connection is broken -> stop reading it and let the instance remove it
+            epoll_ctl(worker->epoll_fd, EPOLL_CTL_DEL, pair->fd, NULL);
+            struct tcp_item item;
+            item.pair = pair;
+            item.msg = NULL;
+            run = (worker_item_add(worker, &item) == IPX_OK);
+        }
+
+        if (run) {
+            run = worker_push(worker, worker->items_cnt);
+            worker->items_cnt = 0;
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * \brief Stop all receiver threads
+ *
+ * Messages that haven't been processed yet are dropped. Only successfully started threads
+ * (see the counter of threads) are joined.
+ * \param[in] instance Instance data
+ */
+static void
+threads_stop(struct tcp_data *instance)
+{
+    if (instance->threads.workers == NULL) {
+        // Not initialized
+        return;
+    }
+
+    pthread_mutex_lock(&instance->threads.lock);
+    instance->threads.stop = true;
+    pthread_cond_broadcast(&instance->threads.cond);
+    pthread_mutex_unlock(&instance->threads.lock);
+
+    for (size_t i = 0; i < instance->threads.cnt; ++i) {
+        int rc = pthread_join(instance->threads.workers[i].thread, NULL);
+        if (rc != 0) {
+            const char *err_str;
+            ipx_strerror(rc, err_str);
+            IPX_CTX_ERROR(instance->ctx, "Failed to join receiver thread %zu! (%s)", i, err_str);
+        }
+    }
+
+    for (size_t i = 0; i < instance->threads.queue_cnt; ++i) {
+        ipx_utils_buf_free(instance->threads.queue[i].msg);
+    }
+    instance->threads.queue_cnt = 0;
+}
+
+/**
+ * \brief Destroy receiver threads and the queue of received messages
+ * \warning Threads MUST be already stopped (see threads_stop()) and all their connections
+ *   MUST be already removed!
+ * \param[in] instance Instance data
+ */
+static void
+threads_destroy(struct tcp_data *instance)
+{
+    if (instance->threads.workers == NULL) {
+        // Not initialized
+        return;
+    }
+
+    for (size_t i = 0; i < instance->threads.cnt; ++i) {
+        close(instance->threads.workers[i].epoll_fd);
+    }
+
+    epoll_ctl(instance->active.epoll_fd, EPOLL_CTL_DEL, instance->threads.event_fd, NULL);
+    close(instance->threads.event_fd);
+    pthread_cond_destroy(&instance->threads.cond);
+    pthread_mutex_destroy(&instance->threads.lock);
+    free(instance->threads.queue);
+    free(instance->threads.queue_proc);
+    free(instance->threads.workers);
+    memset(&instance->threads, 0, sizeof(instance->threads));
+}
+
+/**
+ * \brief Start receiver threads
+ *
+ * Received messages are passed to the instance thread via a shared queue. The instance thread
+ * is notified by an event descriptor added to the epoll instance of active connections.
+ * \warning The function MUST be called before the acceptor thread is started!
+ * \param[in] instance Instance data
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_DENIED on failure
+ */
+static int
+threads_init(struct tcp_data *instance)
+{
+    const char *err_str;
+    const size_t cnt = instance->config->threads;
+    const size_t queue_max = WORKER_QUEUE_MUL * cnt * GETTER_MAX_EVENTS;
+    assert(cnt > 1);
+
+    struct tcp_worker *workers = calloc(cnt, sizeof(*workers));
+    struct tcp_item *queue = malloc(queue_max * sizeof(*queue));
+    struct tcp_item *queue_proc = malloc(queue_max * sizeof(*queue_proc));
+    if (!workers || !queue || !queue_proc) {
+        IPX_CTX_ERROR(instance->ctx, "Memory allocation failed! (%s:%d)", __FILE__, __LINE__);
+        free(workers);
+        free(queue);
+        free(queue_proc);
+        return IPX_ERR_DENIED;
+    }
+
+    int event_fd = eventfd(0, EFD_NONBLOCK);
+    if (event_fd == INVALID_FD) {
+        ipx_strerror(errno, err_str);
+        IPX_CTX_ERROR(instance->ctx, "Failed to create an event descriptor. eventfd() failed: %s",
+            err_str);
+        free(workers);
+        free(queue);
+        free(queue_proc);
+        return IPX_ERR_DENIED;
+    }
+
+    struct epoll_event ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.events = EPOLLIN;
+    ev.data.ptr = NULL; // Not a connection pair
+    if (epoll_ctl(instance->active.epoll_fd, EPOLL_CTL_ADD, event_fd, &ev) == -1) {
+        ipx_strerror(errno, err_str);
+        IPX_CTX_ERROR(instance->ctx, "Failed to add an event descriptor to epoll: %s", err_str);
+        close(event_fd);
+        free(workers);
+        free(queue);
+        free(queue_proc);
+        return IPX_ERR_DENIED;
+    }
+
+    pthread_mutex_init(&instance->threads.lock, NULL);
+    pthread_cond_init(&instance->threads.cond, NULL);
+    instance->threads.workers = workers;
+    instance->threads.event_fd = event_fd;
+    instance->threads.stop = false;
+    instance->threads.queue_max = queue_max;
+    instance->threads.queue_cnt = 0;
+    instance->threads.queue = queue;
+    instance->threads.queue_proc = queue_proc;
+
+    for (size_t i = 0; i < cnt; ++i) {
+        struct tcp_worker *worker = &workers[i];
+        worker->instance = instance;
+        worker->id = i;
+        worker->conn_cnt = 0;
+        worker->epoll_fd = epoll_create(1);
+        if (worker->epoll_fd == INVALID_FD) {
+            ipx_strerror(errno, err_str);
+            IPX_CTX_ERROR(instance->ctx, "epoll() failed: %s", err_str);
+            break;
+        }
+
+        int rc = pthread_create(&worker->thread, NULL, &worker_thread, worker);
+        if (rc != 0) {
+            ipx_strerror(rc, err_str);
+            IPX_CTX_ERROR(instance->ctx, "Failed to create receiver thread %zu! (%s)", i, err_str);
+            close(worker->epoll_fd);
+            break;
+        }
+
+        instance->threads.cnt++;
+    }
+
+    if (instance->threads.cnt != cnt) {
+        // Stop already running threads (no connections have been accepted yet)
+        threads_stop(instance);
+        threads_destroy(instance);
+        return IPX_ERR_DENIED;
+    }
+
+    IPX_CTX_INFO(instance->ctx, "Connections are read by %zu threads.", cnt);
+    return IPX_OK;
+}
+
+/**
+ * \brief Process messages received by receiver threads
+ *
+ * All messages in the queue are taken at once and passed. Connections closed by receiver
+ * threads are removed.
+ * \param[in] instance Instance data
+ */
+static void
+process_queue(struct tcp_data *instance)
+{
+    // Reset the notification (the descriptor is non-blocking)
+    uint64_t value;
+    if (read(instance->threads.event_fd, &value, sizeof(value)) == -1 && errno != EAGAIN) {
+        const char *err_str;
+        ipx_strerror(errno, err_str);
+        IPX_CTX_WARNING(instance->ctx, "Failed to read a notification of receiver threads: %s",
+            err_str);
+    }
+
+    // Swap the queues, so receiver threads can continue immediately
+    pthread_mutex_lock(&instance->threads.lock);
+    struct tcp_item *items = instance->threads.queue;
+    size_t items_cnt = instance->threads.queue_cnt;
+    instance->threads.queue = instance->threads.queue_proc;
+    instance->threads.queue_proc = items;
+    instance->threads.queue_cnt = 0;
+    pthread_cond_broadcast(&instance->threads.cond);
+    pthread_mutex_unlock(&instance->threads.lock);
+
+    // Messages of each connection precede the notification about its closing
+    for (size_t i = 0; i < items_cnt; ++i) {
+        struct tcp_item *item = &items[i];
+        if (item->msg == NULL) {
+            active_session_remove_by_session(instance, item->pair->session);
+            // From this point the pair doesn't exists, and the session is probably destroyed
+            continue;
+        }
+
+        if (socket_pass_msg(instance->ctx, item->pair, item->msg, item->msg_size,
+                &item->msg_ts) != IPX_OK) {
+            // Let the receiver thread stop reading the connection
+            shutdown(item->pair->fd, SHUT_RDWR);
+        }
+    }
 }
 
 // -------------------------------------------------------------------------------------------------
@@ -1105,8 +2039,17 @@ ipx_plugin_init(ipx_ctx_t *ctx, const char *params)
         return IPX_ERR_DENIED;
     }
 
+    // Load the certificate and the key of the collector
+    if (data->config->tls.cert != NULL
+            && (data->tls = tls_create(ctx, data->config)) == NULL) {
+        config_destroy(data->config);
+        free(data);
+        return IPX_ERR_DENIED;
+    }
+
     // Initialize structures of the listener (and bind to the local addresses)
     if (listener_init(ctx, data) != IPX_OK) {
+        tls_destroy(data->tls);
         config_destroy(data->config);
         free(data);
         return IPX_ERR_DENIED;
@@ -1115,6 +2058,17 @@ ipx_plugin_init(ipx_ctx_t *ctx, const char *params)
     // Initialize structures of active connections
     if (active_init(ctx, data) != IPX_OK) {
         listener_destroy(data);
+        tls_destroy(data->tls);
+        config_destroy(data->config);
+        free(data);
+        return IPX_ERR_DENIED;
+    }
+
+    // Start receiver threads (before any connection is accepted)
+    if (data->config->threads > 1 && threads_init(data) != IPX_OK) {
+        active_destroy(ctx, data);
+        listener_destroy(data);
+        tls_destroy(data->tls);
         config_destroy(data->config);
         free(data);
         return IPX_ERR_DENIED;
@@ -1122,8 +2076,11 @@ ipx_plugin_init(ipx_ctx_t *ctx, const char *params)
 
     // Start the acceptor thread
     if (listener_start(ctx, data) != IPX_OK) {
+        threads_stop(data);
+        threads_destroy(data);
         active_destroy(ctx, data);
         listener_destroy(data);
+        tls_destroy(data->tls);
         config_destroy(data->config);
         free(data);
         return IPX_ERR_DENIED;
@@ -1142,10 +2099,15 @@ ipx_plugin_destroy(ipx_ctx_t *ctx, void *cfg)
     listener_stop(ctx, data);
     listener_destroy(data);
 
+    // Stop receiver threads, so nobody reads active connections anymore
+    threads_stop(data);
+
     // Close all Transport Session (this generates Session messages per each active Session)
     active_destroy(ctx, data);
+    threads_destroy(data);
 
     // Final cleanup
+    tls_destroy(data->tls);
     config_destroy(data->config);
     free(data);
 }
@@ -1156,9 +2118,10 @@ ipx_plugin_get(ipx_ctx_t *ctx, void *cfg)
     struct tcp_data *data = (struct tcp_data *) cfg;
     const char *err_str;
 
-    // Process messages from up to 16 sockets
+    // Process messages from up to 16 sockets (connections in the backlog don't wait for events)
     struct epoll_event ev[GETTER_MAX_EVENTS];
-    int ev_valid = epoll_wait(data->active.epoll_fd, ev, GETTER_MAX_EVENTS, GETTER_TIMEOUT);
+    const int timeout = (data->active.backlog.cnt > 0) ? 0 : GETTER_TIMEOUT;
+    int ev_valid = epoll_wait(data->active.epoll_fd, ev, GETTER_MAX_EVENTS, timeout);
     if (ev_valid == -1) {
         // Failed
         int error_code = errno;
@@ -1171,16 +2134,38 @@ ipx_plugin_get(ipx_ctx_t *ctx, void *cfg)
         return IPX_ERR_DENIED;
     }
 
-    if (ev_valid == 0) {
+    if (ev_valid == 0 && data->active.backlog.cnt == 0) {
         // Timeout
         return IPX_OK;
     }
 
-    // Process all events
-    assert(ev_valid > 0 && ev_valid <= GETTER_MAX_EVENTS);
-    for (int i = 0; i < ev_valid; ++i) {
-        struct tcp_pair *pair = (struct tcp_pair *) ev[i].data.ptr;
-        if (socket_process(ctx, pair) == IPX_OK) {
+    // A new round: connections from the backlog first, then all events
+    assert(ev_valid >= 0 && ev_valid <= GETTER_MAX_EVENTS);
+    const uint64_t round = ++data->active.round;
+    const size_t backlog_cnt = data->active.backlog.cnt;
+    for (size_t i = 0; i < backlog_cnt + (size_t) ev_valid; ++i) {
+        struct tcp_pair *pair;
+        if (i < backlog_cnt) {
+            pair = data->active.backlog.head;
+            backlog_remove(&data->active.backlog, pair);
+        } else {
+            pair = (struct tcp_pair *) ev[i - backlog_cnt].data.ptr;
+        }
+
+        if (pair == NULL) {
+            // Messages received by receiver threads
+            process_queue(data);
+            continue;
+        }
+
+        if (pair->round == round) {
+            // Already served in this round
+            continue;
+        }
+        pair->round = round;
+
+        const int rc = socket_process(data, pair, &data->active.backlog, &socket_pass_item, ctx);
+        if (rc == IPX_OK) {
             // Success
             continue;
         }
@@ -1199,7 +2184,11 @@ ipx_plugin_session_close(ipx_ctx_t *ctx, void *cfg, const struct ipx_session *se
     struct tcp_data *data = (struct tcp_data *) cfg;
     // Do NOT dereference the session pointer because it can be already freed!
 
-    if (active_session_remove_by_session(data, session) != IPX_OK) {
+    // Connections served by receiver threads are removed after they stop reading them
+    const int rc = (data->threads.cnt > 0)
+        ? active_session_shutdown(data, session)
+        : active_session_remove_by_session(data, session);
+    if (rc != IPX_OK) {
         /* The session is not present in the buffer, probably because we already removed it
          * before the parser send the request to close the session
          */
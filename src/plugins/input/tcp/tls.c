@@ -0,0 +1,302 @@
+/**
+ * \file src/plugins/input/tcp/tls.c
+ * \author agent <agent@local>
+ * \brief Transport Layer Security of TCP input plugin (source file)
+ * \date 2026
+ */
+
+/* Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is'', and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#include <errno.h>
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "tls.h"
+
+#ifdef HAVE_OPENSSL
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <openssl/err.h>
+#include <openssl/ssl.h>
+
+/** Timeout of a TLS handshake (in seconds)                                                      */
+#define HANDSHAKE_TIMEOUT (5)
+
+struct tcp_tls {
+    /** Instance context (for log messages)                                                      */
+    ipx_ctx_t *ctx;
+    /** OpenSSL context                                                                          */
+    SSL_CTX *ssl_ctx;
+};
+
+struct tcp_tls_conn {
+    /** OpenSSL connection                                                                       */
+    SSL *ssl;
+};
+
+/**
+ * \brief Get a description of the last OpenSSL error of the thread
+ * \param[out] buffer Output buffer
+ * \param[in]  size   Size of the buffer
+ * \return Pointer to the buffer
+ */
+static const char *
+tls_error(char *buffer, size_t size)
+{
+    unsigned long code = ERR_get_error();
+    if (code == 0) {
+        snprintf(buffer, size, "unknown error");
+    } else {
+        ERR_error_string_n(code, buffer, size);
+    }
+
+    ERR_clear_error();
+    return buffer;
+}
+
+/**
+ * \brief Set the send and receive timeout of a socket
+ * \param[in] sd      Socket descriptor
+ * \param[in] timeout Timeout in seconds (0 = no timeout)
+ */
+static void
+tls_socket_timeout(int sd, time_t timeout)
+{
+    struct timeval tv = {.tv_sec = timeout, .tv_usec = 0};
+    setsockopt(sd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    setsockopt(sd, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
+}
+
+tcp_tls_t *
+tls_create(ipx_ctx_t *ctx, const struct tcp_config *cfg)
+{
+    char err_str[256];
+    assert(cfg->tls.cert != NULL);
+
+    tcp_tls_t *tls = calloc(1, sizeof(*tls));
+    if (!tls) {
+        IPX_CTX_ERROR(ctx, "Memory allocation failed! (%s:%d)", __FILE__, __LINE__);
+        return NULL;
+    }
+    tls->ctx = ctx;
+
+    tls->ssl_ctx = SSL_CTX_new(TLS_server_method());
+    if (!tls->ssl_ctx) {
+        IPX_CTX_ERROR(ctx, "Failed to create a TLS context: %s",
+            tls_error(err_str, sizeof(err_str)));
+        free(tls);
+        return NULL;
+    }
+
+    // Decryption of received data by the kernel (if supported by the kernel and the cipher)
+    SSL_CTX_set_min_proto_version(tls->ssl_ctx, TLS1_2_VERSION);
+    SSL_CTX_set_options(tls->ssl_ctx, SSL_OP_ENABLE_KTLS);
+
+    // The private key can be also stored in the file of the certificate
+    const char *key = (cfg->tls.key != NULL) ? cfg->tls.key : cfg->tls.cert;
+    if (SSL_CTX_use_certificate_chain_file(tls->ssl_ctx, cfg->tls.cert) != 1) {
+        IPX_CTX_ERROR(ctx, "Failed to load the TLS certificate '%s': %s", cfg->tls.cert,
+            tls_error(err_str, sizeof(err_str)));
+        tls_destroy(tls);
+        return NULL;
+    }
+
+    if (SSL_CTX_use_PrivateKey_file(tls->ssl_ctx, key, SSL_FILETYPE_PEM) != 1
+            || SSL_CTX_check_private_key(tls->ssl_ctx) != 1) {
+        IPX_CTX_ERROR(ctx, "Failed to load the TLS private key '%s': %s", key,
+            tls_error(err_str, sizeof(err_str)));
+        tls_destroy(tls);
+        return NULL;
+    }
+
+    if (cfg->tls.ca_file != NULL) {
+        // Only exporters with a certificate signed by the CA are accepted
+        if (SSL_CTX_load_verify_locations(tls->ssl_ctx, cfg->tls.ca_file, NULL) != 1) {
+            IPX_CTX_ERROR(ctx, "Failed to load the TLS CA certificates '%s': %s",
+                cfg->tls.ca_file, tls_error(err_str, sizeof(err_str)));
+            tls_destroy(tls);
+            return NULL;
+        }
+        SSL_CTX_set_verify(tls->ssl_ctx, SSL_VERIFY_PEER | SSL_VERIFY_FAIL_IF_NO_PEER_CERT, NULL);
+    }
+
+    IPX_CTX_INFO(ctx, "TLS enabled (certificate: %s)", cfg->tls.cert);
+    return tls;
+}
+
+void
+tls_destroy(tcp_tls_t *tls)
+{
+    if (!tls) {
+        return;
+    }
+
+    SSL_CTX_free(tls->ssl_ctx);
+    free(tls);
+}
+
+int
+tls_accept(tcp_tls_t *tls, int sd, const char *ident, tcp_tls_conn_t **conn)
+{
+    char err_str[256];
+    *conn = NULL;
+
+    SSL *ssl = SSL_new(tls->ssl_ctx);
+    if (!ssl || SSL_set_fd(ssl, sd) != 1) {
+        IPX_CTX_ERROR(tls->ctx, "Failed to create a TLS connection with '%s': %s", ident,
+            tls_error(err_str, sizeof(err_str)));
+        SSL_free(ssl);
+        return IPX_ERR_DENIED;
+    }
+
+    // Slow or malicious exporters must not block the acceptor for a long time
+    tls_socket_timeout(sd, HANDSHAKE_TIMEOUT);
+    ERR_clear_error();
+    int ret = SSL_accept(ssl);
+    tls_socket_timeout(sd, 0);
+    if (ret != 1) {
+        IPX_CTX_WARNING(tls->ctx, "TLS handshake with '%s' failed: %s", ident,
+            tls_error(err_str, sizeof(err_str)));
+        SSL_free(ssl);
+        return IPX_ERR_DENIED;
+    }
+
+    if (BIO_get_ktls_recv(SSL_get_rbio(ssl))) {
+        // The kernel decrypts received data, the connection is read as a regular socket
+        IPX_CTX_INFO(tls->ctx, "TLS connection with '%s' established (%s, %s, kernel offload).",
+            ident, SSL_get_version(ssl), SSL_get_cipher_name(ssl));
+        SSL_free(ssl); // Doesn't send anything and doesn't close the socket
+        return IPX_OK;
+    }
+
+    struct tcp_tls_conn *new_conn = malloc(sizeof(*new_conn));
+    if (!new_conn) {
+        IPX_CTX_ERROR(tls->ctx, "Memory allocation failed! (%s:%d)", __FILE__, __LINE__);
+        SSL_free(ssl);
+        return IPX_ERR_DENIED;
+    }
+
+    IPX_CTX_INFO(tls->ctx, "TLS connection with '%s' established (%s, %s). Kernel offload is "
+        "not available, data are decrypted by the plugin.", ident, SSL_get_version(ssl),
+        SSL_get_cipher_name(ssl));
+    new_conn->ssl = ssl;
+    *conn = new_conn;
+    return IPX_OK;
+}
+
+ssize_t
+tls_recv(tcp_tls_conn_t *conn, void *buffer, size_t size)
+{
+    // At most one TLS record (i.e. 16 KiB) is returned by a call
+    ERR_clear_error();
+    int ret = SSL_read(conn->ssl, buffer, (size > INT_MAX) ? INT_MAX : (int) size);
+    if (ret > 0) {
+        return ret;
+    }
+
+    switch (SSL_get_error(conn->ssl, ret)) {
+    case SSL_ERROR_WANT_READ:
+    case SSL_ERROR_WANT_WRITE:
+        errno = EAGAIN;
+        return -1;
+    case SSL_ERROR_ZERO_RETURN:
+        // Closed by the exporter (close_notify)
+        return 0;
+    case SSL_ERROR_SYSCALL:
+        if (errno == 0) {
+            errno = ECONNRESET;
+        }
+        return -1;
+    default:
+        errno = EPROTO;
+        return -1;
+    }
+}
+
+void
+tls_conn_free(tcp_tls_conn_t *conn)
+{
+    if (!conn) {
+        return;
+    }
+
+    SSL_free(conn->ssl);
+    free(conn);
+}
+
+#else // HAVE_OPENSSL
+
+tcp_tls_t *
+tls_create(ipx_ctx_t *ctx, const struct tcp_config *cfg)
+{
+    (void) cfg;
+    IPX_CTX_ERROR(ctx, "TLS is not supported. The plugin has been built without OpenSSL.", '\0');
+    return NULL;
+}
+
+void
+tls_destroy(tcp_tls_t *tls)
+{
+    (void) tls;
+}
+
+int
+tls_accept(tcp_tls_t *tls, int sd, const char *ident, tcp_tls_conn_t **conn)
+{
+    (void) tls;
+    (void) sd;
+    (void) ident;
+    *conn = NULL;
+    return IPX_ERR_DENIED;
+}
+
+ssize_t
+tls_recv(tcp_tls_conn_t *conn, void *buffer, size_t size)
+{
+    (void) conn;
+    (void) buffer;
+    (void) size;
+    errno = ENOTSUP;
+    return -1;
+}
+
+void
+tls_conn_free(tcp_tls_conn_t *conn)
+{
+    (void) conn;
+}
+
+#endif // HAVE_OPENSSL
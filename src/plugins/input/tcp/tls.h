@@ -0,0 +1,113 @@
+/**
+ * \file src/plugins/input/tcp/tls.h
+ * \author agent <agent@local>
+ * \brief Transport Layer Security of TCP input plugin (header file)
+ * \date 2026
+ */
+
+/* Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is'', and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#ifndef TLS_H
+#define TLS_H
+
+#include <ipfixcol2.h>
+#include <sys/types.h>
+#include "config.h"
+
+/** TLS context of an instance (i.e. configuration shared by all connections)                    */
+typedef struct tcp_tls tcp_tls_t;
+/** TLS state of a connection decrypted in the user space                                        */
+typedef struct tcp_tls_conn tcp_tls_conn_t;
+
+/**
+ * \brief Create a TLS context of an instance
+ *
+ * The certificate, the private key and (optionally) CA certificates are loaded.
+ * \param[in] ctx Instance context
+ * \param[in] cfg Configuration of the instance (TLS MUST be enabled)
+ * \return Pointer to the context on success
+ * \return NULL on failure (e.g. invalid files or the plugin has been built without TLS support)
+ */
+tcp_tls_t *
+tls_create(ipx_ctx_t *ctx, const struct tcp_config *cfg);
+
+/**
+ * \brief Destroy a TLS context of an instance
+ * \warning All connections of the context MUST be already freed!
+ * \param[in] tls TLS context
+ */
+void
+tls_destroy(tcp_tls_t *tls);
+
+/**
+ * \brief Perform a TLS handshake on a new connection
+ *
+ * The socket MUST be in blocking mode and the handshake is limited by a timeout. If the
+ * kernel TLS offload (kTLS) of received data has been enabled, decryption runs in the kernel
+ * and the connection is read as a regular socket, i.e. \p conn is NULL. Otherwise, received data
+ * MUST be read by tls_recv().
+ * \param[in]  tls   TLS context
+ * \param[in]  sd    Socket descriptor of the connection
+ * \param[in]  ident Identification of the exporter (for log messages)
+ * \param[out] conn  TLS state of the connection (or NULL)
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_DENIED if the handshake failed and the connection should be closed
+ */
+int
+tls_accept(tcp_tls_t *tls, int sd, const char *ident, tcp_tls_conn_t **conn);
+
+/**
+ * \brief Receive decrypted data of a connection
+ *
+ * The function has the same semantics as recv() on a non-blocking socket, i.e. if no data
+ * are available, -1 is returned and errno is set to EAGAIN.
+ * \param[in] conn   TLS state of the connection
+ * \param[in] buffer Output buffer
+ * \param[in] size   Size of the output buffer
+ * \return The same as recv()
+ */
+ssize_t
+tls_recv(tcp_tls_conn_t *conn, void *buffer, size_t size);
+
+/**
+ * \brief Free a TLS state of a connection
+ *
+ * The socket is not closed.
+ * \param[in] conn TLS state of the connection (can be NULL)
+ */
+void
+tls_conn_free(tcp_tls_conn_t *conn);
+
+#endif // TLS_H
@@ -53,6 +53,22 @@
 #define LIFETIME_DATA_DEF (1800)
 /** Default Options Template Lifetime                                                            */
 #define LIFETIME_OPTS_DEF (1800)
+/** Default maximum number of datagrams received from a socket per wakeup                       */
+#define BATCH_SIZE_DEF (32)
+/** Maximum number of datagrams received from a socket per wakeup                               */
+#define BATCH_SIZE_MAX (1024)
+/** Maximum number of receiver threads                                                          */
+#define THREADS_MAX (64)
+/** Maximum rate limit of an exporter [datagrams per second]                                     */
+#define RATE_LIMIT_MAX (10000000)
+/** Maximum number of receive queues served by AF_XDP sockets                                   */
+#define XDP_QUEUES_MAX (64)
+/** Default number of AF_XDP frames per receive queue                                           */
+#define XDP_FRAMES_DEF (4096)
+/** Minimum number of AF_XDP frames per receive queue                                           */
+#define XDP_FRAMES_MIN (64)
+/** Maximum number of AF_XDP frames per receive queue                                           */
+#define XDP_FRAMES_MAX (262144)
 
 /*
  * <params>
@@ -61,6 +77,16 @@
  *  <templateLifeTime>...</templateLifeTime>      <!-- optional                  -->
  *  <optionsTemplateLifeTime>...</optionsTemplateLifeTime> <!-- optional         -->
  *  <connectionTimeout>...</connectionTimeout>    <!-- optional                  -->
+ *  <ioUring>...</ioUring>                        <!-- optional                  -->
+ *  <batchSize>...</batchSize>                    <!-- optional                  -->
+ *  <threads>...</threads>                        <!-- optional                  -->
+ *  <xdpInterface>...</xdpInterface>              <!-- optional                  -->
+ *  <xdpQueues>...</xdpQueues>                    <!-- optional                  -->
+ *  <xdpFrames>...</xdpFrames>                    <!-- optional                  -->
+ *  <rateLimit>...</rateLimit>                    <!-- optional                  -->
+ *  <rateBurst>...</rateBurst>                    <!-- optional                  -->
+ *  <odidOnly>...</odidOnly>                      <!-- optional                  -->
+ *  <odidExcept>...</odidExcept>                  <!-- optional                  -->
  * </params>
  */
 
@@ -70,7 +96,17 @@ enum params_xml_nodes {
     NODE_IPADDR,
     NODE_LT_DATA,
     NODE_LT_OPTS,
-    NODE_TIMEOUT
+    NODE_TIMEOUT,
+    NODE_URING,
+    NODE_BATCH,
+    NODE_THREADS,
+    NODE_XDP_IFACE,
+    NODE_XDP_QUEUES,
+    NODE_XDP_FRAMES,
+    NODE_RATE_LIMIT,
+    NODE_RATE_BURST,
+    NODE_ODID_ONLY,
+    NODE_ODID_EXCEPT
 };
 
 /** Definition of the \<params\> node  */
@@ -81,6 +117,16 @@ static const struct fds_xml_args args_params[] = {
     FDS_OPTS_ELEM(NODE_LT_DATA, "templateLifeTime",        FDS_OPTS_T_UINT,   FDS_OPTS_P_OPT),
     FDS_OPTS_ELEM(NODE_LT_OPTS, "optionsTemplateLifeTime", FDS_OPTS_T_UINT,   FDS_OPTS_P_OPT),
     FDS_OPTS_ELEM(NODE_TIMEOUT, "connectionTimeout",       FDS_OPTS_T_UINT,   FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM(NODE_URING,   "ioUring",                 FDS_OPTS_T_BOOL,   FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM(NODE_BATCH,   "batchSize",               FDS_OPTS_T_UINT,   FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM(NODE_THREADS, "threads",                 FDS_OPTS_T_UINT,   FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM(NODE_XDP_IFACE,  "xdpInterface",         FDS_OPTS_T_STRING, FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM(NODE_XDP_QUEUES, "xdpQueues",            FDS_OPTS_T_UINT,   FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM(NODE_XDP_FRAMES, "xdpFrames",            FDS_OPTS_T_UINT,   FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM(NODE_RATE_LIMIT, "rateLimit",            FDS_OPTS_T_UINT,   FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM(NODE_RATE_BURST, "rateBurst",            FDS_OPTS_T_UINT,   FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM(NODE_ODID_ONLY,   "odidOnly",            FDS_OPTS_T_STRING, FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM(NODE_ODID_EXCEPT, "odidExcept",          FDS_OPTS_T_STRING, FDS_OPTS_P_OPT),
     FDS_OPTS_END
 };
 
@@ -128,6 +174,48 @@ config_add_addr(ipx_ctx_t *ctx, struct udp_config *cfg, const char *addr)
     return IPX_OK;
 }
 
+/**
+ * \brief Parse a filter of ODIDs and add it to the configuration
+ *
+ * \param[in] ctx  Instance context
+ * \param[in] cfg  Configuration
+ * \param[in] expr Filter expression (e.g. "1-5, 7, 10-")
+ * \param[in] type Type of the filter
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_FORMAT if the expression is not valid or the filter is already defined
+ * \return #IPX_ERR_NOMEM if a memory allocation error has occurred
+ */
+static int
+config_add_odid(ipx_ctx_t *ctx, struct udp_config *cfg, const char *expr,
+    enum ipx_odid_filter_type type)
+{
+    if (cfg->odid.type != IPX_ODID_FILTER_NONE) {
+        IPX_CTX_ERROR(ctx, "Multiple definitions of <odidExcept>/<odidOnly>!", '\0');
+        return IPX_ERR_FORMAT;
+    }
+
+    ipx_orange_t *range = ipx_orange_create();
+    if (!range) {
+        IPX_CTX_ERROR(ctx, "Memory allocation error (%s:%d)", __FILE__, __LINE__);
+        return IPX_ERR_NOMEM;
+    }
+
+    int rc = ipx_orange_parse(range, expr);
+    if (rc != IPX_OK) {
+        if (rc == IPX_ERR_FORMAT) {
+            IPX_CTX_ERROR(ctx, "Invalid ODID filter expression '%s'", expr);
+        } else {
+            IPX_CTX_ERROR(ctx, "Memory allocation error (%s:%d)", __FILE__, __LINE__);
+        }
+        ipx_orange_destroy(range);
+        return rc;
+    }
+
+    cfg->odid.type = type;
+    cfg->odid.range = range;
+    return IPX_OK;
+}
+
 /**
  * \brief Process \<params\> node
  * \param[in] ctx  Plugin context
@@ -140,6 +228,8 @@ static int
 config_parser_root(ipx_ctx_t *ctx, fds_xml_ctx_t *root, struct udp_config *cfg)
 {
     const struct fds_xml_cont *content;
+    int rc;
+
     while (fds_xml_next(root, &content) != FDS_EOC) {
         switch (content->id) {
         case NODE_PORT:
@@ -187,6 +277,92 @@ config_parser_root(ipx_ctx_t *ctx, fds_xml_ctx_t *root, struct udp_config *cfg)
             }
             cfg->timeout_conn = (uint16_t) content->val_uint;
             break;
+        case NODE_URING:
+            // Receive datagrams using io_uring
+            assert(content->type == FDS_OPTS_T_BOOL);
+            cfg->io_uring = content->val_bool;
+            break;
+        case NODE_BATCH:
+            // Maximum number of datagrams received from a socket per wakeup
+            assert(content->type == FDS_OPTS_T_UINT);
+            if (content->val_uint < 1 || content->val_uint > BATCH_SIZE_MAX) {
+                IPX_CTX_ERROR(ctx, "Batch size must be between 1..%u", (unsigned) BATCH_SIZE_MAX);
+                return IPX_ERR_FORMAT;
+            }
+            cfg->batch_size = (uint16_t) content->val_uint;
+            break;
+        case NODE_THREADS:
+            // Number of receiver threads
+            assert(content->type == FDS_OPTS_T_UINT);
+            if (content->val_uint < 1 || content->val_uint > THREADS_MAX) {
+                IPX_CTX_ERROR(ctx, "Number of threads must be between 1..%u",
+                    (unsigned) THREADS_MAX);
+                return IPX_ERR_FORMAT;
+            }
+            cfg->threads = (uint16_t) content->val_uint;
+            break;
+        case NODE_XDP_IFACE:
+            // Network interface for AF_XDP receiving (empty = disabled)
+            assert(content->type == FDS_OPTS_T_STRING);
+            free(cfg->xdp.ifname);
+            cfg->xdp.ifname = NULL;
+            if (strlen(content->ptr_string) == 0) {
+                break;
+            }
+            cfg->xdp.ifname = strdup(content->ptr_string);
+            if (!cfg->xdp.ifname) {
+                IPX_CTX_ERROR(ctx, "Memory allocation error (%s:%d)", __FILE__, __LINE__);
+                return IPX_ERR_NOMEM;
+            }
+            break;
+        case NODE_XDP_QUEUES:
+            // Number of receive queues of the interface
+            assert(content->type == FDS_OPTS_T_UINT);
+            if (content->val_uint < 1 || content->val_uint > XDP_QUEUES_MAX) {
+                IPX_CTX_ERROR(ctx, "Number of XDP queues must be between 1..%u",
+                    (unsigned) XDP_QUEUES_MAX);
+                return IPX_ERR_FORMAT;
+            }
+            cfg->xdp.queues = (uint16_t) content->val_uint;
+            break;
+        case NODE_XDP_FRAMES:
+            // Number of frames per receive queue
+            assert(content->type == FDS_OPTS_T_UINT);
+            if (content->val_uint < XDP_FRAMES_MIN || content->val_uint > XDP_FRAMES_MAX) {
+                IPX_CTX_ERROR(ctx, "Number of XDP frames must be between %u..%u",
+                    (unsigned) XDP_FRAMES_MIN, (unsigned) XDP_FRAMES_MAX);
+                return IPX_ERR_FORMAT;
+            }
+            cfg->xdp.frames = (uint32_t) content->val_uint;
+            break;
+        case NODE_RATE_LIMIT:
+            // Maximum rate of datagrams per exporter (0 = unlimited)
+            assert(content->type == FDS_OPTS_T_UINT);
+            if (content->val_uint > RATE_LIMIT_MAX) {
+                IPX_CTX_ERROR(ctx, "Rate limit must be between 0..%u", (unsigned) RATE_LIMIT_MAX);
+                return IPX_ERR_FORMAT;
+            }
+            cfg->rate.limit = (uint32_t) content->val_uint;
+            break;
+        case NODE_RATE_BURST:
+            // Maximum burst of datagrams per exporter
+            assert(content->type == FDS_OPTS_T_UINT);
+            if (content->val_uint < 1 || content->val_uint > RATE_LIMIT_MAX) {
+                IPX_CTX_ERROR(ctx, "Rate burst must be between 1..%u", (unsigned) RATE_LIMIT_MAX);
+                return IPX_ERR_FORMAT;
+            }
+            cfg->rate.burst = (uint32_t) content->val_uint;
+            break;
+        case NODE_ODID_ONLY:
+        case NODE_ODID_EXCEPT:
+            // Filter of ODIDs
+            assert(content->type == FDS_OPTS_T_STRING);
+            rc = config_add_odid(ctx, cfg, content->ptr_string, (content->id == NODE_ODID_ONLY)
+                ? IPX_ODID_FILTER_ONLY : IPX_ODID_FILTER_EXCEPT);
+            if (rc != IPX_OK) {
+                return rc;
+            }
+            break;
         default:
             // Internal error
             assert(false);
@@ -208,6 +384,16 @@ config_default_set(struct udp_config *cfg)
     cfg->timeout_conn = CONN_TIMEOUT_DEF;
     cfg->lifetime_data = LIFETIME_DATA_DEF;
     cfg->lifetime_opts = LIFETIME_OPTS_DEF;
+    cfg->io_uring = false;
+    cfg->batch_size = BATCH_SIZE_DEF;
+    cfg->threads = 1;
+    cfg->xdp.ifname = NULL;
+    cfg->xdp.queues = 1;
+    cfg->xdp.frames = XDP_FRAMES_DEF;
+    cfg->rate.limit = 0; // Unlimited
+    cfg->rate.burst = 0; // Same as the limit
+    cfg->odid.type = IPX_ODID_FILTER_NONE;
+    cfg->odid.range = NULL;
 }
 
 struct udp_config *
@@ -253,6 +439,11 @@ config_parse(ipx_ctx_t *ctx, const char *params)
         return NULL;
     }
 
+    if (cfg->rate.burst == 0) {
+        // By default, an exporter can send datagrams of one second at once
+        cfg->rate.burst = (cfg->rate.limit > 0) ? cfg->rate.limit : 1;
+    }
+
     return cfg;
 }
 
@@ -260,5 +451,9 @@ void
 config_destroy(struct udp_config *cfg)
 {
     free(cfg->local_addrs.addrs);
+    free(cfg->xdp.ifname);
+    if (cfg->odid.range) {
+        ipx_orange_destroy(cfg->odid.range);
+    }
     free(cfg);
 }
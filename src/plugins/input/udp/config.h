@@ -44,6 +44,7 @@
 
 #include <ipfixcol2.h>
 #include "stdint.h"
+#include "../../../core/odid_range.h"
 
 /** Parsed IP address */
 struct udp_ipaddr_rec {
@@ -67,6 +68,12 @@ struct udp_config {
     uint16_t lifetime_opts;
     /** Connection timeout                                                                       */
     uint16_t timeout_conn;
+    /** Receive datagrams using io_uring (if available)                                          */
+    bool io_uring;
+    /** Maximum number of datagrams received from a socket per wakeup (epoll only)               */
+    uint16_t batch_size;
+    /** Number of receiver threads (i.e. reusable sockets per local address)                     */
+    uint16_t threads;
 
     struct {
         /** Size of the array                                                                    */
@@ -74,6 +81,29 @@ struct udp_config {
         /** Array of local IP addresses                                                          */
         struct udp_ipaddr_rec *addrs;
     } local_addrs; /**< Local addresses                                                          */
+
+    struct {
+        /** Name of the network interface (NULL, if AF_XDP is not used)                          */
+        char *ifname;
+        /** Number of receive queues of the interface (one AF_XDP socket per queue)              */
+        uint16_t queues;
+        /** Number of frames per receive queue (i.e. max. number of unprocessed datagrams)       */
+        uint32_t frames;
+    } xdp; /**< Receiving using AF_XDP sockets                                                   */
+
+    struct {
+        /** Maximum rate of datagrams per exporter [datagrams per second] (0 = unlimited)        */
+        uint32_t limit;
+        /** Maximum number of datagrams per exporter received at once (i.e. bucket size)         */
+        uint32_t burst;
+    } rate; /**< Rate limit of exporters (token bucket per Transport Session)                   */
+
+    struct {
+        /** Type of the filter (IPX_ODID_FILTER_NONE, if all ODIDs are accepted)                 */
+        enum ipx_odid_filter_type type;
+        /** Range of ODIDs (NULL, if the filter is not used)                                     */
+        ipx_orange_t *range;
+    } odid; /**< Filter of ODIDs applied to datagrams before they are passed to the parser     */
 };
 
 /**
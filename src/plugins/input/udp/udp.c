@@ -39,6 +39,7 @@
  *
  */
 
+#define _GNU_SOURCE
 #include <ipfixcol2.h>
 
 #include <sys/types.h>
@@ -47,24 +48,49 @@
 #include <arpa/inet.h>
 #include <netinet/in.h>
 #include <sys/timerfd.h>
+#include <sys/eventfd.h>
+#include <linux/filter.h>
+#include <linux/sock_diag.h>
 #include <unistd.h>
+#include <stdio.h>
 #include <stdlib.h>
+#include <time.h>
 #include <pthread.h>
 #include <errno.h>
 #include <inttypes.h>
-#include <sys/ioctl.h>
 #include "config.h"
+#include "../../../core/latency.h"
 
 /** Identification of an invalid socket descriptor                                               */
 #define INVALID_FD        (-1)
 /** Timeout for a getter operation - i.e. epoll_wait timeout [in milliseconds]                   */
 #define GETTER_TIMEOUT    (10)
 /** Max sockets events processed in the getter - i.e. epoll_wait array size                      */
-#define GETTER_MAX_EVENTS (16)
+#define GETTER_MAX_EVENTS (64)
 /** Number of seconds between timer events [seconds]                                             */
 #define TIMER_INTERVAL    (2)
 /** Required minimal size of receive buffer size [bytes] (otherwise produces a warning message)  */
 #define UDP_RMEM_REQ      (1024*1024)
+/** Number of io_uring receive buffers (also max. number of events processed in the getter)      */
+#define URING_BUF_CNT     (64)
+/** User data of the io_uring request to read the timer                                          */
+#define URING_TIMER_ID    (UINT64_MAX)
+/** Size of a receive slot of a batch (i.e. max. size of an UDP datagram) [bytes]                */
+#define BATCH_SLOT_SIZE   (UINT16_MAX)
+/** Size of a control buffer of a receive slot of a batch (SO_RXQ_OVFL and SO_TIMESTAMPNS data) */
+#define BATCH_CTRL_SIZE   (CMSG_SPACE(sizeof(uint32_t)) + CMSG_SPACE(sizeof(struct timespec)))
+/** Timeout of a receiver thread - i.e. max. delay of its termination [in milliseconds]          */
+#define WORKER_TIMEOUT    (100)
+/** Capacity of the queue of received datagrams (multiple of the number of all batch slots)      */
+#define WORKER_QUEUE_MUL  (2)
+/** Initial number of buckets of the hash table of active sources (power of two)                 */
+#define ACTIVE_TABLE_INIT (64)
+/** Maximum number of datagrams taken from an AF_XDP socket per wakeup                          */
+#define XDP_BATCH_SIZE    (64)
+/** Min. number of timer events between reports of datagrams dropped by the kernel               */
+#define STATS_REPORT_TICKS (30)
+/** Tokens of the rate limiter consumed by a datagram (i.e. tokens are nanoseconds * rate)      */
+#define LIMIT_COST        (1000000000ULL)
 
 /** Plugin description */
 IPX_API struct ipx_plugin_info ipx_plugin_info = {
@@ -138,6 +164,15 @@ struct __attribute__((__packed__)) nf9_msg_hdr {
 /** Length of NetFlow v9 header (in bytes)                                                       */
 #define NF9_HDR_LEN       (sizeof(struct nf9_msg_hdr))
 
+/** Version identification in sFlow header (32-bit value, i.e. the first 16 bits are zero)       */
+#define SFLOW_HDR_VERSION (5)
+/** Minimal length of sFlow v5 header (with an IPv4 agent address, in bytes)                     */
+#define SFLOW_HDR_LEN_MIN (28)
+/** Offset of the agent address type in sFlow v5 header                                          */
+#define SFLOW_HDR_ADDR_TYPE (4)
+/** Type of an IPv6 agent address in sFlow v5 header                                             */
+#define SFLOW_ADDR_IPV6   (2)
+
 
 /** Description of a UDP Transport Session                                                       */
 struct udp_source {
@@ -149,12 +184,98 @@ struct udp_source {
     /** Description of  the Transport Session                                                    */
     struct ipx_session *session;
 
-    /** Timestamp of check when the source was last seen                                         */
-    time_t last_seen;
-    /** Number of received messages since last check                                             */
-    uint32_t msg_cnt;
+    /** Timer tick when the source was last seen                                                 */
+    uint64_t last_seen;
     /** No message has been received from the Session yet                                        */
     bool new_connection;
+
+    /** Tokens of the rate limiter (see #LIMIT_COST)                                             */
+    uint64_t limit_tokens;
+    /** Time of the previous refill of tokens [nanoseconds, monotonic clock]                     */
+    uint64_t limit_ts;
+    /** Number of datagrams dropped by the rate limiter                                          */
+    uint64_t limit_dropped;
+    /** Number of dropped datagrams at the time of the previous report                           */
+    uint64_t limit_reported;
+
+    /** Next source in the same bucket of the hash table                                         */
+    struct udp_source *hash_next;
+    /** Next source in the same slot of the timer wheel                                          */
+    struct udp_source *wheel_next;
+};
+
+/** Preallocated buffers for receiving multiple datagrams by one system call                    */
+struct udp_batch {
+    /** Number of slots (i.e. max. number of datagrams received by one recvmmsg() call)          */
+    unsigned int cnt;
+    /** Message headers (one per slot)                                                           */
+    struct mmsghdr *hdrs;
+    /** I/O vectors pointing to the receive slots                                                */
+    struct iovec *iovs;
+    /** Source addresses of received datagrams                                                   */
+    struct sockaddr_storage *addrs;
+    /** Receive slots (the array of "cnt" slots of #BATCH_SLOT_SIZE bytes)                       */
+    uint8_t *slots;
+    /** Control buffers (the array of "cnt" buffers of #BATCH_CTRL_SIZE bytes)                   */
+    uint8_t *ctrls;
+};
+
+/**
+ * Runtime statistics of a socket
+ * \warning Counters are read by other threads! Therefore, modification MUST be always atomic.
+ */
+struct udp_sock_stats {
+    /** Local IP address and port of the socket (for reports)                                    */
+    char name[INET6_ADDRSTRLEN + 16];
+    /** Number of received datagrams (updated by the thread receiving from the socket)           */
+    uint64_t packets;
+    /** Datagrams dropped by the kernel (the last value of SO_RXQ_OVFL ancillary data)           */
+    uint32_t ovfl;
+    /** Datagrams dropped by the kernel (SO_MEMINFO, updated on timer events)                   */
+    uint32_t drops;
+    /** Bytes waiting in the receive queue (SO_MEMINFO, updated on timer events)                */
+    uint32_t queue;
+    /** Size of the receive buffer (SO_MEMINFO, updated on timer events)                        */
+    uint32_t rcvbuf;
+
+    /** Dropped datagrams at the time of the previous report (only the instance thread)          */
+    uint32_t reported;
+    /** Received datagrams at the time of the previous call of stats_print() (only the callback) */
+    uint64_t packets_prev;
+    /** Received datagrams at the time of the current call of stats_print() (only the callback)  */
+    uint64_t packets_now;
+};
+
+/** Datagram received by a receiver thread and waiting for processing                            */
+struct udp_item {
+    /** File descriptor of the socket                                                            */
+    int sd;
+    /** Size of the datagram                                                                     */
+    int size;
+    /** Datagram (allocated by ipx_utils_buf_alloc())                                            */
+    uint8_t *buffer;
+    /** Source address of the datagram                                                           */
+    struct sockaddr_storage addr;
+    /** Time of reception by the kernel (zero, if not available)                                 */
+    struct timespec rx_ts;
+};
+
+struct udp_data;
+
+/** Receiver thread                                                                              */
+struct udp_worker {
+    /** Instance data                                                                            */
+    struct udp_data *instance;
+    /** Index of the thread (i.e. index of its socket in each group of reusable sockets)         */
+    size_t id;
+    /** Thread identification                                                                    */
+    pthread_t thread;
+    /** Epoll file descriptor (sockets served by the thread)                                     */
+    int epoll_fd;
+    /** Preallocated buffers for batched receiving                                               */
+    struct udp_batch batch;
+    /** Datagrams of the last batch waiting for insertion into the queue (one per slot)          */
+    struct udp_item *items;
 };
 
 /** Instance data                                                                                */
@@ -176,14 +297,91 @@ struct udp_data {
         int epoll_fd;
         /** Timer file descriptor (#INVALID_FD if not valid)                                     */
         int timer_fd;
+
+        /** io_uring instance replacing epoll (NULL, if not used)                                */
+        ipx_uring_t *uring;
+        /** Output buffer of the io_uring request to read the timer                              */
+        uint64_t uring_timer;
+
+        /** AF_XDP sockets of the network interface (NULL, if not used)                          */
+        ipx_xdp_t *xdp;
+
+        /** Statistics of sockets (the same order as the array of sockets)                      */
+        struct udp_sock_stats *stats;
+        /** Timer tick of the previous report of datagrams dropped by the kernel                 */
+        uint64_t stats_tick;
+        /** Time of the previous call of stats_print() (only the callback)                      */
+        struct timespec stats_ts;
     } listen; /**< Sockets to listen for data                                                    */
 
+    /** Preallocated buffers for batched receiving (epoll and a single thread only)            */
+    struct udp_batch batch;
+
     struct {
-        /** Size of the array                                                                    */
+        /** Number of receiver threads (zero, if datagrams are received by the instance thread)  */
+        size_t cnt;
+        /** Array of receiver threads                                                            */
+        struct udp_worker *workers;
+
+        /** Protection of the queue and the termination flag                                     */
+        pthread_mutex_t lock;
+        /** Signalized when the queue is not full anymore or the threads should terminate       */
+        pthread_cond_t cond;
+        /** Event descriptor to notify the instance thread about new datagrams in the queue      */
+        int event_fd;
+        /** Terminate receiver threads                                                           */
+        bool stop;
+
+        /** Capacity of the queues                                                               */
+        size_t queue_max;
+        /** Number of received datagrams in the queue                                            */
+        size_t queue_cnt;
+        /** Queue of received datagrams (filled by receiver threads)                             */
+        struct udp_item *queue;
+        /** Queue of datagrams being processed by the instance thread (swapped with the queue)   */
+        struct udp_item *queue_proc;
+    } threads; /**< Receiver threads (only if multiple threads are configured)                   */
+
+    struct {
+        /** Number of active sources                                                             */
         size_t cnt;
-        /** Array of active sources (identification and corresponding Transport Session)         */
-        struct udp_source **sources;
+        /** Number of buckets of the hash table (power of two)                                   */
+        size_t table_size;
+        /** Hash table of active sources (identification and corresponding Transport Session)    */
+        struct udp_source **table;
+
+        /** Number of slots of the timer wheel (one slot per timer tick)                          */
+        size_t wheel_size;
+        /** Timer wheel (lists of sources by the timer tick of their expected expiration)        */
+        struct udp_source **wheel;
+        /** Number of timer ticks since the start of the instance                                */
+        uint64_t tick;
     } active; /**< Active connections                                                            */
+
+    struct {
+        /** Tokens of a full bucket (zero, if rate limiting is disabled)                          */
+        uint64_t capacity;
+        /** Datagrams dropped by the rate limiter (read by other threads, i.e. updated atomically) */
+        uint64_t dropped;
+    } limit; /**< Rate limiting of exporters                                                     */
+
+    /** Datagrams dropped by the ODID filter (read by other threads, i.e. updated atomically)     */
+    uint64_t odid_dropped;
+
+    struct {
+        /** All metrics are registered                                                           */
+        bool en;
+        /** Datagrams received on all sockets                                                    */
+        struct ipx_metric *received;
+        /** Datagrams dropped by the kernel on all sockets                                       */
+        struct ipx_metric *kernel_drops;
+        /** Bytes waiting in receive queues of all sockets                                       */
+        struct ipx_metric *queue;
+        /** Datagrams dropped by the rate limiter                                                */
+        struct ipx_metric *limit_dropped;
+        /** Datagrams dropped by the ODID filter                                                 */
+        struct ipx_metric *odid_dropped;
+    } metrics; /**< Runtime metrics (updated by the instance thread on timer events)             */
 };
 
 // -------------------------------------------------------------------------------------------------
@@ -197,11 +395,12 @@ struct udp_data {
  * \param[in] addrlen  Size of the address
  * \param[in] ipv6only Accept only IPv6 addresses (only for AF_INET6 and the wildcard address)
  * \param[in] rbuffer  Change the receive buffer size (ignored, if zero or negative)
+ * \param[in] reuseport Allow multiple sockets to bind to the same address (SO_REUSEPORT)
  * \return On failure returns #INVALID_FD. Otherwise returns valid socket descriptor.
  */
 static int
 address_bind(ipx_ctx_t *ctx, const struct sockaddr *addr, socklen_t addrlen, bool ipv6only,
-    int rbuffer)
+    int rbuffer, bool reuseport)
 {
     sa_family_t family = addr->sa_family;
     assert(family == AF_INET || family == AF_INET6);
@@ -223,6 +422,29 @@ address_bind(ipx_ctx_t *ctx, const struct sockaddr *addr, socklen_t addrlen, boo
             "the port can be used again. (error: %s)", err_str);
     }
 
+    // Share the address among multiple sockets (the kernel distributes datagrams among them)
+    if (reuseport && setsockopt(sd, SOL_SOCKET, SO_REUSEPORT, &on, sizeof(on)) == -1) {
+        ipx_strerror(errno, err_str);
+        IPX_CTX_ERROR(ctx, "Cannot turn on socket option SO_REUSEPORT: %s", err_str);
+        close(sd);
+        return INVALID_FD;
+    }
+
+    // Get the number of datagrams dropped by the kernel with each datagram
+    if (setsockopt(sd, SOL_SOCKET, SO_RXQ_OVFL, &on, sizeof(on)) == -1) {
+        ipx_strerror(errno, err_str);
+        IPX_CTX_WARNING(ctx, "Cannot turn on socket option SO_RXQ_OVFL. Datagrams dropped by "
+            "the kernel are detected only periodically. (error: %s)", err_str);
+    }
+
+    // Get the time of reception by the kernel with each datagram (only for latency measurement)
+    if (ipx_latency_enabled()
+            && setsockopt(sd, SOL_SOCKET, SO_TIMESTAMPNS, &on, sizeof(on)) == -1) {
+        ipx_strerror(errno, err_str);
+        IPX_CTX_WARNING(ctx, "Cannot turn on socket option SO_TIMESTAMPNS. Latency of messages is "
+            "measured since they're processed by the plugin. (error: %s)", err_str);
+    }
+
     // Make sure that IPv6 only is disabled
     if (family == AF_INET6) {
         if (!ipv6only && setsockopt(sd, IPPROTO_IPV6, IPV6_V6ONLY, &off, sizeof(off)) == -1) {
@@ -289,13 +511,66 @@ address_bind(ipx_ctx_t *ctx, const struct sockaddr *addr, socklen_t addrlen, boo
     return sd;
 }
 
+/**
+ * \brief Keep datagrams from the same exporter on the same socket of a reusable group
+ *
+ * By default, the kernel selects a socket of the group by a hash of the source and destination
+ * IP address and port. However, some exporters change their source port from time to time, which
+ * would spread their Transport Session between multiple threads. The attached (classic) BPF
+ * program selects the socket only by the source IP address of the datagram.
+ * \note On failure, only a warning is printed as the default distribution is used instead.
+ * \param[in] ctx        Instance context
+ * \param[in] sd         Socket of the group
+ * \param[in] group_size Number of sockets in the group
+ */
+static void
+reuseport_attach(ipx_ctx_t *ctx, int sd, unsigned int group_size)
+{
+#ifdef SO_ATTACH_REUSEPORT_CBPF
+    struct sock_filter code[] = {
+        // A = version of IP protocol
+        BPF_STMT(BPF_LD  | BPF_B   | BPF_ABS, SKF_NET_OFF),
+        BPF_STMT(BPF_ALU | BPF_RSH | BPF_K,   4),
+        BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K,   4, 0, 2),
+        // IPv4: A = source IP address
+        BPF_STMT(BPF_LD  | BPF_W   | BPF_ABS, SKF_NET_OFF + 12),
+        BPF_JUMP(BPF_JMP | BPF_JA,            1, 0, 0),
+        // IPv6: A = the last 32 bits of the source IP address
+        BPF_STMT(BPF_LD  | BPF_W   | BPF_ABS, SKF_NET_OFF + 20),
+        // Return index of the socket
+        BPF_STMT(BPF_ALU | BPF_MOD | BPF_K,   group_size),
+        BPF_STMT(BPF_RET | BPF_A,             0),
+    };
+    struct sock_fprog prog = {
+        .len = sizeof(code) / sizeof(code[0]),
+        .filter = code
+    };
+
+    if (setsockopt(sd, SOL_SOCKET, SO_ATTACH_REUSEPORT_CBPF, &prog, sizeof(prog)) == 0) {
+        return;
+    }
+
+    const char *err_str;
+    ipx_strerror(errno, err_str);
+    IPX_CTX_WARNING(ctx, "Unable to pin exporters to threads by their IP address. Datagrams "
+        "are distributed by their source port too. setsockopt() failed: %s", err_str);
+#else
+    (void) sd;
+    (void) group_size;
+    IPX_CTX_WARNING(ctx, "Unable to pin exporters to threads by their IP address (not supported "
+        "by the system). Datagrams are distributed by their source port too.", '\0');
+#endif
+}
+
 /**
  * \brief Bind on all local IP address specified in parsed configuration
  *
  * If the no local IP address is defined, the function create one wildcard socket to listen on
  * all local interfaces. Otherwise for each specified address create a separated socket.
- * All sockets are stored into the array of the instance configuration and epoll with added
- * socket is created.
+ * If multiple threads are configured, a group of reusable sockets (one per thread) is created
+ * for each address instead, i.e. the socket of the thread \f$t\f$ for the address \f$a\f$ is
+ * stored at index \f$a * threads + t\f$. All sockets are stored into the array of the instance
+ * configuration. Sockets are added to the epoll of the instance only if a single thread is used.
  *
  * \param[in] instance Instance data
  * \return #IPX_OK on success
@@ -306,47 +581,18 @@ listener_bind(struct udp_data *instance)
 {
     // Create a poll and new array of binded sockets
     const char *err_str;
-    const size_t socket_cnt = instance->config->local_addrs.cnt;
-    int *sockets = malloc(sizeof(*sockets) * ((socket_cnt == 0) ? 1 : socket_cnt));
-    if (!sockets) {
+    const size_t addr_cnt = instance->config->local_addrs.cnt;
+    const size_t group_size = instance->config->threads;
+    const size_t socket_cnt = ((addr_cnt == 0) ? 1 : addr_cnt) * group_size;
+    int *sockets = malloc(sizeof(*sockets) * socket_cnt);
+    struct udp_sock_stats *stats = calloc(socket_cnt, sizeof(*stats));
+    if (!sockets || !stats) {
         IPX_CTX_ERROR(instance->ctx, "Memory allocation failed! (%s:%d)", __FILE__, __LINE__);
+        free(sockets);
+        free(stats);
         return IPX_ERR_DENIED;
     }
 
-    if (socket_cnt == 0) {
-        // Wildcard (i.e. bind to all IPv4 and IPv6 addresses)
-        struct sockaddr_in6 addr;
-        memset(&addr, 0, sizeof(addr));
-        addr.sin6_family = AF_INET6;
-        addr.sin6_port = htons(instance->config->local_port);
-        addr.sin6_addr = in6addr_any;
-
-        int sd = address_bind(instance->ctx, (struct sockaddr *) &addr, sizeof(addr), false,
-            instance->listen.rmem_size);
-        if (sd == INVALID_FD) {
-            free(sockets);
-            return IPX_ERR_DENIED;
-        }
-
-        // Add the socket to the poll
-        struct epoll_event ev;
-        memset(&ev, 0, sizeof(ev));
-        ev.events = EPOLLIN;
-        ev.data.fd = sd;
-        if (epoll_ctl(instance->listen.epoll_fd, EPOLL_CTL_ADD, sd, &ev) == -1) {
-            ipx_strerror(errno, err_str);
-            IPX_CTX_ERROR(instance->ctx, "Failed to add a socket to epoll: %s", err_str);
-            close(sd);
-            free(sockets);
-            return IPX_ERR_DENIED;
-        }
-
-        sockets[0] = sd;
-        instance->listen.sockets = sockets;
-        instance->listen.cnt = 1; // Only this one
-        return IPX_OK;
-    }
-
     // Bind to selected local addresses
     size_t idx;
     for (idx = 0; idx < socket_cnt; ++idx) {
@@ -359,8 +605,18 @@ listener_bind(struct udp_data *instance)
         socklen_t addrlen;
         bool ipv6only;
 
-        const struct udp_ipaddr_rec *rec = &instance->config->local_addrs.addrs[idx];
-        if (rec->ip_ver == AF_INET) { // IPv4
+        const struct udp_ipaddr_rec *rec = NULL;
+        if (addr_cnt != 0) {
+            rec = &instance->config->local_addrs.addrs[idx / group_size];
+        }
+
+        if (rec == NULL) { // Wildcard (i.e. bind to all IPv4 and IPv6 addresses)
+            addr_helper.v6.sin6_family = AF_INET6;
+            addr_helper.v6.sin6_port = htons(instance->config->local_port);
+            addr_helper.v6.sin6_addr = in6addr_any;
+            addrlen = sizeof(addr_helper.v6);
+            ipv6only = false;
+        } else if (rec->ip_ver == AF_INET) { // IPv4
             addr_helper.v4.sin_family = AF_INET;
             addr_helper.v4.sin_port = htons(instance->config->local_port);
             addr_helper.v4.sin_addr = rec->ipv4;
@@ -375,12 +631,35 @@ listener_bind(struct udp_data *instance)
         }
 
         int sd = address_bind(instance->ctx, (struct sockaddr *) &addr_helper, addrlen, ipv6only,
-            instance->listen.rmem_size);
+            instance->listen.rmem_size, group_size > 1);
         if (sd == INVALID_FD) {
             // Failed
             break;
         }
 
+        // Name of the socket for reports (e.g. "[::]:4739" or "10.0.0.1:4739#2")
+        char addr_str[INET6_ADDRSTRLEN] = {0};
+        struct udp_sock_stats *stat = &stats[idx];
+        const void *addr_ptr = (addr_helper.v4.sin_family == AF_INET)
+            ? (const void *) &addr_helper.v4.sin_addr : (const void *) &addr_helper.v6.sin6_addr;
+        inet_ntop(addr_helper.v4.sin_family, addr_ptr, addr_str, INET6_ADDRSTRLEN);
+        int name_len = snprintf(stat->name, sizeof(stat->name),
+            (addr_helper.v4.sin_family == AF_INET) ? "%s:%" PRIu16 : "[%s]:%" PRIu16, addr_str,
+            instance->config->local_port);
+        if (group_size > 1 && name_len > 0 && (size_t) name_len < sizeof(stat->name)) {
+            snprintf(&stat->name[name_len], sizeof(stat->name) - name_len, "#%zu",
+                idx % group_size);
+        }
+
+        if (group_size > 1) {
+            // Receiver threads add sockets to their own epoll
+            if (idx % group_size == 0) {
+                reuseport_attach(instance->ctx, sd, (unsigned int) group_size);
+            }
+            sockets[idx] = sd;
+            continue;
+        }
+
         // Add the socket to the poll
         struct epoll_event ev;
         memset(&ev, 0, sizeof(ev));
@@ -402,10 +681,12 @@ listener_bind(struct udp_data *instance)
             close(sockets[rev]);
         }
         free(sockets);
+        free(stats);
         return IPX_ERR_DENIED;
     }
 
     instance->listen.sockets = sockets;
+    instance->listen.stats = stats;
     instance->listen.cnt = socket_cnt;
     return IPX_OK;
 }
@@ -427,7 +708,9 @@ listener_unbind(struct udp_data *instance)
     }
 
     free(instance->listen.sockets);
+    free(instance->listen.stats);
     instance->listen.sockets = NULL;
+    instance->listen.stats = NULL;
     instance->listen.cnt = 0;
 }
 
@@ -527,249 +810,1344 @@ listener_init(struct udp_data *instance)
 }
 
 /**
- * \brief Destroy the listener structure of the instance
+ * \brief Replace epoll with io_uring (if possible)
  *
- * All acceptor sockets are closed and unregistered from epoll which is also destroyed. The timer
- * is disarmed and destroyed too.
+ * A multishot receive request is armed for each socket and a read request for the timer.
+ * If io_uring is not available, the instance keeps using epoll.
  * \param[in] instance Instance data
  */
 static void
-listener_destroy(struct udp_data *instance)
+listener_uring_init(struct udp_data *instance)
 {
-    // Close all sockets
-    listener_unbind(instance);
-    // Destroy the timer and epoll
-    close(instance->listen.epoll_fd);
-    close(instance->listen.timer_fd);
+    const char *err_str;
+    const unsigned int depth = (unsigned int) instance->listen.cnt + 1;
+
+    ipx_uring_t *uring = ipx_uring_create(depth, URING_BUF_CNT, UINT16_MAX);
+    if (!uring) {
+        ipx_strerror(errno, err_str);
+        IPX_CTX_WARNING(instance->ctx, "Unable to use io_uring (%s). Using epoll instead.",
+            err_str);
+        return;
+    }
+
+    for (size_t i = 0; i < instance->listen.cnt; ++i) {
+        if (ipx_uring_recv_multishot(uring, instance->listen.sockets[i], i) != IPX_OK) {
+            goto error;
+        }
+    }
+
+    uint64_t *timer = &instance->listen.uring_timer;
+    if (ipx_uring_read(uring, instance->listen.timer_fd, timer, sizeof(*timer),
+            URING_TIMER_ID) != IPX_OK || ipx_uring_submit(uring) != IPX_OK) {
+        goto error;
+    }
+
+    IPX_CTX_INFO(instance->ctx, "Datagrams are received using io_uring.", '\0');
+    instance->listen.uring = uring;
+    return;
+
+error:
+    ipx_strerror(errno, err_str);
+    IPX_CTX_WARNING(instance->ctx, "Failed to submit io_uring requests (%s). Using epoll "
+        "instead.", err_str);
+    ipx_uring_destroy(uring);
 }
 
 /**
- * \brief Add a new record of a Transport Session
+ * \brief Receive datagrams from a network interface using AF_XDP sockets (if possible)
  *
- * New record is added into the list of active connections.
+ * Sockets of all receive queues are added to epoll. Regular sockets remain bound, so datagrams
+ * from other interfaces are still received. If AF_XDP is not available, the instance uses
+ * regular sockets only.
  * \param[in] instance Instance data
- * \param[in] src_fd   Socket descriptor of local address on which the source data come
- * \param[in] src_addr Remote IPv4/IPv6 address to add
- * \return Pointer to the newly added record or NULL (memory allocation error)
  */
-static struct udp_source *
-active_add(struct udp_data *instance, int src_fd, const struct sockaddr *src_addr)
+static void
+listener_xdp_init(struct udp_data *instance)
 {
-    socklen_t src_addrlen;
-
-    // Get the description of the local address
-    struct sockaddr_storage dst_addr;
-    socklen_t dst_addrlen = sizeof(dst_addr);
-    memset(&dst_addr, 0, sizeof(dst_addr));
+    const char *err_str;
+    const struct udp_config *cfg = instance->config;
 
-    if (getsockname(src_fd, (struct sockaddr *) &dst_addr, &dst_addrlen) == -1) {
-        const char *err_str;
+    ipx_xdp_t *xdp = ipx_xdp_create(cfg->xdp.ifname, cfg->xdp.queues, &cfg->local_port, 1,
+        cfg->xdp.frames);
+    if (!xdp) {
         ipx_strerror(errno, err_str);
-        IPX_CTX_ERROR(instance->ctx, "Failed to get the local IP address. getsockname() failed: %s",
-            err_str);
-        return NULL;
-    }
-
-    if (src_addr->sa_family != dst_addr.ss_family) {
-        IPX_CTX_WARNING(instance->ctx, "New connection has different family of local and "
-            "remote IP addresses!", '\0');
+        IPX_CTX_WARNING(instance->ctx, "Unable to use AF_XDP on the interface '%s' (%s). Using "
+            "regular sockets only.", cfg->xdp.ifname, err_str);
+        return;
     }
 
-    // Create a new Transport Session
-    struct ipx_session_net net;
-    memset(&net, 0, sizeof(net));
-
-    net.l3_proto = src_addr->sa_family;
-    if (net.l3_proto == AF_INET) { // IPv4
-        src_addrlen = sizeof(struct sockaddr_in);
-        const struct sockaddr_in *src_v4 = (struct sockaddr_in *) src_addr;
-        const struct sockaddr_in *dst_v4 = (struct sockaddr_in *) &dst_addr;
-        net.port_src = ntohs(src_v4->sin_port);
-        net.port_dst = ntohs(dst_v4->sin_port);
-        net.addr_src.ipv4 = src_v4->sin_addr;
-        net.addr_dst.ipv4 = dst_v4->sin_addr;
-    } else if (net.l3_proto == AF_INET6) { // IPv6
-        src_addrlen = sizeof(struct sockaddr_in6);
-        const struct sockaddr_in6 *src_v6 = (struct sockaddr_in6 *) src_addr;
-        const struct sockaddr_in6 *dst_v6 = (struct sockaddr_in6 *) &dst_addr;
-        net.port_src = ntohs(src_v6->sin6_port);
-        net.port_dst = ntohs(dst_v6->sin6_port);
-        if (IN6_IS_ADDR_V4MAPPED(&src_v6->sin6_addr)) {
-            // IPv4 mapped into IPv6
-            net.l3_proto = AF_INET; // Overwrite family type!
-            net.addr_src.ipv4 = *(const struct in_addr *) (((uint8_t *) &src_v6->sin6_addr) + 12);
-            net.addr_dst.ipv4 = *(const struct in_addr *) (((uint8_t *) &dst_v6->sin6_addr) + 12);
-        } else {
-            net.addr_src.ipv6 = src_v6->sin6_addr;
-            net.addr_dst.ipv6 = dst_v6->sin6_addr;
+    for (unsigned int i = 0; i < cfg->xdp.queues; ++i) {
+        struct epoll_event ev;
+        memset(&ev, 0, sizeof(ev));
+        ev.events = EPOLLIN;
+        ev.data.fd = ipx_xdp_fd(xdp, i);
+        if (epoll_ctl(instance->listen.epoll_fd, EPOLL_CTL_ADD, ev.data.fd, &ev) == -1) {
+            ipx_strerror(errno, err_str);
+            IPX_CTX_WARNING(instance->ctx, "Failed to add an AF_XDP socket to epoll (%s). Using "
+                "regular sockets only.", err_str);
+            ipx_xdp_destroy(xdp);
+            return;
         }
-    } else {
-        // Unknown address type
-        IPX_CTX_ERROR(instance->ctx, "New connection has an unsupported IP address family "
-            "(family ID: %u)!", (unsigned) src_addr->sa_family);
-        return NULL;
     }
 
-    char src_addr_str[INET6_ADDRSTRLEN] = {0};
-    inet_ntop(net.l3_proto, &net.addr_src, src_addr_str, INET6_ADDRSTRLEN);
+    IPX_CTX_INFO(instance->ctx, "Datagrams from the interface '%s' are received using AF_XDP "
+        "(%s mode).", cfg->xdp.ifname, ipx_xdp_zerocopy(xdp) ? "zero-copy" : "copy");
+    instance->listen.xdp = xdp;
+}
 
-    const struct udp_config *cfg = instance->config;
-    struct ipx_session *session = ipx_session_new_udp(&net, cfg->lifetime_data, cfg->lifetime_opts);
-    if (!session) {
-        IPX_CTX_ERROR(instance->ctx, "Failed to create a Transport Session description of %s.",
-            src_addr_str);
-        return NULL;
+/**
+ * \brief Get the receive queue of an AF_XDP socket
+ * \param[in] instance Instance data
+ * \param[in] fd       File descriptor
+ * \return Index of the queue or -1 (not an AF_XDP socket)
+ */
+static int
+listener_xdp_queue(const struct udp_data *instance, int fd)
+{
+    if (instance->listen.xdp == NULL) {
+        return -1;
     }
 
-    // Create a new record
-    struct udp_source *rec2add = calloc(1, sizeof(*rec2add));
-    if (!rec2add) {
-        IPX_CTX_ERROR(instance->ctx, "Memory allocation failed! (%s:%d)", __FILE__, __LINE__);
-        ipx_session_destroy(session);
-        return NULL;
+    for (unsigned int i = 0; i < instance->config->xdp.queues; ++i) {
+        if (ipx_xdp_fd(instance->listen.xdp, i) == fd) {
+            return (int) i;
+        }
     }
 
-    rec2add->local_fd = src_fd;
-    memcpy(&rec2add->src_addr, src_addr, src_addrlen);
-    rec2add->session = session;
-    rec2add->last_seen = time(NULL); // now!
-    rec2add->msg_cnt = 0;
-    rec2add->new_connection = true; // Session Message hasn't been send yet
+    return -1;
+}
 
-    // Append the list of active connections
-    const size_t new_size = (instance->active.cnt + 1) * sizeof(struct udp_source *);
-    struct udp_source **new_sources = realloc(instance->active.sources, new_size);
-    if (!new_sources) {
-        IPX_CTX_ERROR(instance->ctx, "Memory allocation failed! (%s:%d)", __FILE__, __LINE__);
-        free(rec2add);
-        ipx_session_destroy(session);
-        return NULL;
-    }
+/**
+ * \brief Destroy the listener structure of the instance
+ *
+ * All acceptor sockets are closed and unregistered from epoll which is also destroyed. The timer
+ * is disarmed and destroyed too.
+ * \param[in] instance Instance data
+ */
+static void
+listener_destroy(struct udp_data *instance)
+{
+    // Cancel all io_uring requests (if any)
+    ipx_uring_destroy(instance->listen.uring);
+    instance->listen.uring = NULL;
+    // Detach the XDP program (frames of unprocessed messages are released later)
+    ipx_xdp_destroy(instance->listen.xdp);
+    instance->listen.xdp = NULL;
+    // Close all sockets
+    listener_unbind(instance);
+    // Destroy the timer and epoll
+    close(instance->listen.epoll_fd);
+    close(instance->listen.timer_fd);
+}
 
-    IPX_CTX_INFO(instance->ctx, "New exporter connected from '%s'.", src_addr_str);
-    new_sources[instance->active.cnt] = rec2add;
-    instance->active.sources = new_sources;
-    instance->active.cnt++;
-    return rec2add;
+/**
+ * \brief Get the current time of the rate limiter
+ * \return Monotonic time [nanoseconds]
+ */
+static inline uint64_t
+limit_now()
+{
+    // Coarse clock is good enough and much cheaper (tokens are refilled less often)
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC_COARSE, &ts);
+    return (uint64_t) ts.tv_sec * 1000000000ULL + (uint64_t) ts.tv_nsec;
 }
 
 /**
- * \brief Remove an active Transport Session with a given index
+ * \brief Check the rate limit of an exporter (token bucket)
  *
- * Generate and pass a Session Message - connect event (if necessary) and remove the corresponding
- * session (defined by an index) from the list.
- * \note After removing of the Session the array of active Transport Sessions is not order by
- *   activity anymore.
+ * Tokens are refilled according to the time elapsed since the previous datagram (up to the size
+ * of the bucket) and each accepted datagram consumes #LIMIT_COST tokens.
  * \param[in] instance Instance data
- * \param[in] idx      Index of the instance to remove
+ * \param[in] src      Source of the datagram
+ * \return True if the datagram should be accepted
+ * \return False if the datagram exceeds the limit (it's counted as dropped)
  */
-static void
-active_remove_by_id(struct udp_data *instance, size_t idx)
+static inline bool
+limit_accept(struct udp_data *instance, struct udp_source *src)
 {
-    struct udp_source *src = instance->active.sources[idx];
-    IPX_CTX_INFO(instance->ctx, "Transport Session '%s' closed!", src->session->ident);
+    const uint64_t capacity = instance->limit.capacity;
+    if (capacity == 0) {
+        return true;
+    }
 
-    // Have we received at least one valid record?
-    if (src->new_connection) {
-        // No messages have been passed with a reference to this session -> destroy immediately
-        ipx_session_destroy(src->session);
-    } else {
-        // Generate a Session message (order of the messages MUST be preserved)
-        ipx_msg_session_t *msg_sess = ipx_msg_session_create(src->session, IPX_MSG_SESSION_CLOSE);
-        if (!msg_sess) {
-            IPX_CTX_WARNING(instance->ctx, "Failed to create a Session message! Instances of "
-                "plugins will not be informed about the closed Transport Session '%s' (%s:%d)",
-                src->session->ident, __FILE__, __LINE__);
-            /* Do not pass and definitely do NOT free the session structure because it still can be
-             * used by other plugins. Remove it only from the local table!
-             * NO RETURN HERE!
-             */
-        } else {
-            // Pass the message and put the Session into the garbage
-            ipx_ctx_msg_pass(instance->ctx, ipx_msg_session2base(msg_sess));
+    const uint64_t rate = instance->config->rate.limit;
+    const uint64_t now = limit_now();
+    const uint64_t elapsed = now - src->limit_ts;
+    src->limit_ts = now;
 
-            ipx_msg_garbage_cb cb = (ipx_msg_garbage_cb) &ipx_session_destroy;
-            ipx_msg_garbage_t *msg_garbage = ipx_msg_garbage_create(src->session, cb);
-            if (!msg_garbage) {
-                IPX_CTX_ERROR(instance->ctx, "Memory allocation failed! (%s:%d)", __FILE__, __LINE__);
-            } else {
-                ipx_ctx_msg_pass(instance->ctx, ipx_msg_garbage2base(msg_garbage));
-            }
+    if (elapsed >= capacity / rate) {
+        // Enough time to fill the whole bucket (it also prevents an overflow)
+        src->limit_tokens = capacity;
+    } else {
+        src->limit_tokens += elapsed * rate;
+        if (src->limit_tokens > capacity) {
+            src->limit_tokens = capacity;
         }
     }
 
-    // Now we can free the wrapper
-    free(src);
-    if (idx == instance->active.cnt - 1) {
-        // The last element in the array
-        instance->active.cnt--;
-    } else {
-        // Replace it with the last one
-        instance->active.sources[idx] = instance->active.sources[instance->active.cnt - 1];
-        instance->active.cnt--;
+    if (src->limit_tokens < LIMIT_COST) {
+        src->limit_dropped++;
+        __atomic_add_fetch(&instance->limit.dropped, 1U, __ATOMIC_RELAXED);
+        return false;
     }
+
+    src->limit_tokens -= LIMIT_COST;
+    return true;
 }
 
 /**
- * \brief Find a record of an active Transport Session
+ * \brief Check whether a datagram with the given ODID passes the ODID filter
  *
+ * Datagrams which don't pass are counted as dropped.
  * \param[in] instance Instance data
- * \param[in] src_fd   Socket descriptor of local address on which the source data come
- * \param[in] addr     Remote IPv4/IPv6 Address to find
- * \return Pointer to the record or NULL (the record doesn't exist)
+ * \param[in] odid     Observation Domain ID (or Source ID) of the datagram
+ * \return True if the datagram should be accepted
  */
-static struct udp_source *
-active_find(struct udp_data *instance, int src_fd, const struct sockaddr *addr)
+static inline bool
+odid_accept(struct udp_data *instance, uint32_t odid)
 {
-    size_t idx;
+    const struct udp_config *cfg = instance->config;
+    if (cfg->odid.type == IPX_ODID_FILTER_NONE) {
+        return true;
+    }
+
+    const bool match = ipx_orange_in(cfg->odid.range, odid);
+    if (match == (cfg->odid.type == IPX_ODID_FILTER_ONLY)) {
+        return true;
+    }
+
+    __atomic_add_fetch(&instance->odid_dropped, 1U, __ATOMIC_RELAXED);
+    return false;
+}
+
+/**
+ * \brief Report datagrams of exporters dropped by the rate limiter since the previous report
+ * \param[in] instance Instance data
+ */
+static void
+limit_report(struct udp_data *instance)
+{
+    if (instance->limit.capacity == 0) {
+        return;
+    }
+
+    for (size_t i = 0; i < instance->active.table_size; ++i) {
+        for (struct udp_source *src = instance->active.table[i]; src; src = src->hash_next) {
+            if (src->limit_dropped == src->limit_reported) {
+                continue;
+            }
+
+            IPX_CTX_WARNING(instance->ctx, "Exporter '%s' exceeded the rate limit (%" PRIu32
+                " datagrams/s). %" PRIu64 " datagrams dropped since the previous report.",
+                src->session->ident, instance->config->rate.limit,
+                src->limit_dropped - src->limit_reported);
+            src->limit_reported = src->limit_dropped;
+        }
+    }
+}
+
+/**
+ * \brief Find statistics of a socket
+ * \param[in] instance Instance data
+ * \param[in] sd       File descriptor of the socket
+ * \return Pointer to the statistics or NULL (unknown socket)
+ */
+static struct udp_sock_stats *
+stats_find(struct udp_data *instance, int sd)
+{
+    for (size_t i = 0; i < instance->listen.cnt; ++i) {
+        if (instance->listen.sockets[i] == sd) {
+            return &instance->listen.stats[i];
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * \brief Get the number of datagrams dropped by the kernel on a socket
+ * \param[in] stats Statistics of the socket
+ */
+static inline uint32_t
+stats_drops(const struct udp_sock_stats *stats)
+{
+    // Both counters have the same source, but they are updated at different times
+    const uint32_t ovfl = __atomic_load_n(&stats->ovfl, __ATOMIC_RELAXED);
+    const uint32_t drops = __atomic_load_n(&stats->drops, __ATOMIC_RELAXED);
+    return ((int32_t) (ovfl - drops) > 0) ? ovfl : drops;
+}
+
+/**
+ * \brief Register runtime metrics of the instance
+ *
+ * If any metric cannot be registered, runtime metrics are disabled.
+ * \param[in] instance Instance data
+ */
+static void
+metrics_register(struct udp_data *instance)
+{
+    ipx_ctx_t *ctx = instance->ctx;
+    instance->metrics.received = ipx_ctx_metric_register(ctx, IPX_METRIC_COUNTER,
+        "udp_received_datagrams_total", "Number of datagrams received on all sockets");
+    instance->metrics.kernel_drops = ipx_ctx_metric_register(ctx, IPX_METRIC_COUNTER,
+        "udp_kernel_dropped_datagrams_total", "Number of datagrams dropped by the kernel");
+    instance->metrics.queue = ipx_ctx_metric_register(ctx, IPX_METRIC_GAUGE,
+        "udp_receive_queue_bytes", "Number of bytes in receive queues of all sockets");
+    instance->metrics.limit_dropped = ipx_ctx_metric_register(ctx, IPX_METRIC_COUNTER,
+        "udp_rate_limit_dropped_datagrams_total", "Number of datagrams dropped by the rate limit");
+    instance->metrics.odid_dropped = ipx_ctx_metric_register(ctx, IPX_METRIC_COUNTER,
+        "udp_odid_dropped_datagrams_total", "Number of datagrams dropped by the ODID filter");
+
+    instance->metrics.en = instance->metrics.received != NULL
+        && instance->metrics.kernel_drops != NULL && instance->metrics.queue != NULL
+        && instance->metrics.limit_dropped != NULL && instance->metrics.odid_dropped != NULL;
+    if (!instance->metrics.en) {
+        IPX_CTX_WARNING(ctx, "Runtime metrics of the instance are not available.", '\0');
+    }
+}
+
+/**
+ * \brief Update runtime metrics of the instance (on timer events)
+ * \param[in] instance Instance data
+ */
+static void
+metrics_update(struct udp_data *instance)
+{
+    if (!instance->metrics.en) {
+        return;
+    }
+
+    uint64_t received = 0;
+    uint64_t drops = 0;
+    uint64_t queue = 0;
+    for (size_t i = 0; i < instance->listen.cnt; ++i) {
+        const struct udp_sock_stats *stats = &instance->listen.stats[i];
+        received += __atomic_load_n(&stats->packets, __ATOMIC_RELAXED);
+        drops += stats_drops(stats);
+        queue += __atomic_load_n(&stats->queue, __ATOMIC_RELAXED);
+    }
+
+    ipx_metric_set(instance->metrics.received, received);
+    ipx_metric_set(instance->metrics.kernel_drops, drops);
+    ipx_metric_set(instance->metrics.queue, queue);
+    ipx_metric_set(instance->metrics.limit_dropped,
+        __atomic_load_n(&instance->limit.dropped, __ATOMIC_RELAXED));
+    ipx_metric_set(instance->metrics.odid_dropped,
+        __atomic_load_n(&instance->odid_dropped, __ATOMIC_RELAXED));
+}
+
+/**
+ * \brief Update memory statistics of all sockets and report datagrams dropped by the kernel
+ *
+ * The function should be called on each timer event. Drops are reported at most once per
+ * #STATS_REPORT_TICKS timer events.
+ * \param[in] instance Instance data
+ */
+static void
+stats_check(struct udp_data *instance)
+{
+    for (size_t i = 0; i < instance->listen.cnt; ++i) {
+        struct udp_sock_stats *stats = &instance->listen.stats[i];
+#ifdef SO_MEMINFO
+        uint32_t mem[SK_MEMINFO_VARS];
+        socklen_t mem_len = sizeof(mem);
+        if (getsockopt(instance->listen.sockets[i], SOL_SOCKET, SO_MEMINFO, mem, &mem_len) == -1
+                || mem_len < sizeof(mem)) {
+            continue;
+        }
+
+        __atomic_store_n(&stats->queue, mem[SK_MEMINFO_RMEM_ALLOC], __ATOMIC_RELAXED);
+        __atomic_store_n(&stats->rcvbuf, mem[SK_MEMINFO_RCVBUF], __ATOMIC_RELAXED);
+        __atomic_store_n(&stats->drops, mem[SK_MEMINFO_DROPS], __ATOMIC_RELAXED);
+#else
+        (void) stats;
+#endif
+    }
+
+    metrics_update(instance);
+
+    if (instance->active.tick - instance->listen.stats_tick < STATS_REPORT_TICKS) {
+        return;
+    }
+
+    instance->listen.stats_tick = instance->active.tick;
+    for (size_t i = 0; i < instance->listen.cnt; ++i) {
+        struct udp_sock_stats *stats = &instance->listen.stats[i];
+        const uint32_t drops = stats_drops(stats);
+        if (drops == stats->reported) {
+            continue;
+        }
+
+        IPX_CTX_WARNING(instance->ctx, "The kernel dropped %" PRIu32 " datagrams received on "
+            "%s since the previous report (receive queue %" PRIu32 "/%" PRIu32 " bytes). "
+            "The receive buffer is too small or the collector is overloaded!",
+            drops - stats->reported, stats->name,
+            __atomic_load_n(&stats->queue, __ATOMIC_RELAXED),
+            __atomic_load_n(&stats->rcvbuf, __ATOMIC_RELAXED));
+        stats->reported = drops;
+    }
+
+    limit_report(instance);
+}
+
+/**
+ * \brief Print runtime statistics of all sockets (callback of ipx_ctx_stats_cb_set())
+ *
+ * A line per socket with the number of received datagrams (and the rate since the previous
+ * call), datagrams dropped by the kernel and the current depth of the receive queue.
+ * \param[in]  data   Instance data
+ * \param[out] buffer Output buffer
+ * \param[in]  size   Size of the output buffer
+ * \return Same as snprintf()
+ */
+static int
+stats_print(void *data, char *buffer, size_t size)
+{
+    struct udp_data *instance = (struct udp_data *) data;
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    const struct timespec *prev = &instance->listen.stats_ts;
+    double interval = (double) (now.tv_sec - prev->tv_sec)
+        + (double) (now.tv_nsec - prev->tv_nsec) / 1000000000.0;
+    if (interval <= 0.0) {
+        interval = 1.0;
+    }
+
+    size_t len = 0;
+    for (size_t i = 0; i < instance->listen.cnt; ++i) {
+        struct udp_sock_stats *stats = &instance->listen.stats[i];
+        stats->packets_now = __atomic_load_n(&stats->packets, __ATOMIC_RELAXED);
+        const double rate = (double) (stats->packets_now - stats->packets_prev) / interval;
+
+        int ret = snprintf(&buffer[(len < size) ? len : size], (len < size) ? size - len : 0,
+            "socket %s: received %" PRIu64 " datagrams (%.0f datagrams/s), dropped by the "
+            "kernel %" PRIu32 " datagrams, receive queue %" PRIu32 "/%" PRIu32 " bytes\n",
+            stats->name, stats->packets_now, rate, stats_drops(stats),
+            __atomic_load_n(&stats->queue, __ATOMIC_RELAXED),
+            __atomic_load_n(&stats->rcvbuf, __ATOMIC_RELAXED));
+        if (ret < 0) {
+            return ret;
+        }
+        len += (size_t) ret;
+    }
+
+    if (instance->limit.capacity > 0) {
+        int ret = snprintf(&buffer[(len < size) ? len : size], (len < size) ? size - len : 0,
+            "rate limit: dropped %" PRIu64 " datagrams of exporters in total\n",
+            __atomic_load_n(&instance->limit.dropped, __ATOMIC_RELAXED));
+        if (ret < 0) {
+            return ret;
+        }
+        len += (size_t) ret;
+    }
+
+    if (instance->config->odid.type != IPX_ODID_FILTER_NONE) {
+        int ret = snprintf(&buffer[(len < size) ? len : size], (len < size) ? size - len : 0,
+            "ODID filter: dropped %" PRIu64 " datagrams in total\n",
+            __atomic_load_n(&instance->odid_dropped, __ATOMIC_RELAXED));
+        if (ret < 0) {
+            return ret;
+        }
+        len += (size_t) ret;
+    }
+
+    if (len < size) {
+        // The output is complete, the next rates are calculated since now
+        for (size_t i = 0; i < instance->listen.cnt; ++i) {
+            struct udp_sock_stats *stats = &instance->listen.stats[i];
+            stats->packets_prev = stats->packets_now;
+        }
+        instance->listen.stats_ts = now;
+    }
+
+    return (int) len;
+}
+
+/**
+ * \brief Prepare buffers for batched receiving of datagrams
+ *
+ * Each slot of the batch is able to hold a datagram of the maximum size, therefore, received
+ * datagrams are never truncated and no size query is required before reading.
+ * \param[in] ctx   Instance context
+ * \param[in] batch Batch to initialize
+ * \param[in] cnt   Number of slots
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_NOMEM if a memory allocation has failed
+ */
+static int
+batch_init(ipx_ctx_t *ctx, struct udp_batch *batch, unsigned int cnt)
+{
+    assert(cnt > 0);
+
+    batch->cnt = cnt;
+    batch->hdrs = calloc(cnt, sizeof(*batch->hdrs));
+    batch->iovs = calloc(cnt, sizeof(*batch->iovs));
+    batch->addrs = calloc(cnt, sizeof(*batch->addrs));
+    batch->slots = malloc((size_t) cnt * BATCH_SLOT_SIZE);
+    batch->ctrls = calloc(cnt, BATCH_CTRL_SIZE);
+    if (!batch->hdrs || !batch->iovs || !batch->addrs || !batch->slots || !batch->ctrls) {
+        IPX_CTX_ERROR(ctx, "Memory allocation failed! (%s:%d)", __FILE__, __LINE__);
+        free(batch->hdrs);
+        free(batch->iovs);
+        free(batch->addrs);
+        free(batch->slots);
+        free(batch->ctrls);
+        memset(batch, 0, sizeof(*batch));
+        return IPX_ERR_NOMEM;
+    }
+
+    for (unsigned int i = 0; i < cnt; ++i) {
+        batch->iovs[i].iov_base = &batch->slots[(size_t) i * BATCH_SLOT_SIZE];
+        struct msghdr *msg = &batch->hdrs[i].msg_hdr;
+        msg->msg_name = &batch->addrs[i];
+        msg->msg_iov = &batch->iovs[i];
+        msg->msg_iovlen = 1;
+        msg->msg_control = &batch->ctrls[(size_t) i * BATCH_CTRL_SIZE];
+    }
+
+    return IPX_OK;
+}
+
+/**
+ * \brief Destroy buffers for batched receiving of datagrams
+ * \param[in] batch Batch to destroy
+ */
+static void
+batch_destroy(struct udp_batch *batch)
+{
+    free(batch->hdrs);
+    free(batch->iovs);
+    free(batch->addrs);
+    free(batch->slots);
+    free(batch->ctrls);
+    memset(batch, 0, sizeof(*batch));
+}
+
+/**
+ * \brief Receive datagrams from a socket into a batch
+ *
+ * Up to the number of slots of the batch is received by a single recvmmsg() call.
+ * \param[in] ctx   Instance context
+ * \param[in] batch Batch
+ * \param[in] sd    File descriptor of the socket
+ * \return Number of received datagrams (zero, if nothing has been received or on failure)
+ */
+static unsigned int
+batch_recv(ipx_ctx_t *ctx, struct udp_batch *batch, int sd)
+{
+    // Reset lengths of the buffers (modified by the previous call)
+    for (unsigned int i = 0; i < batch->cnt; ++i) {
+        struct msghdr *msg = &batch->hdrs[i].msg_hdr;
+        msg->msg_namelen = sizeof(batch->addrs[i]);
+        msg->msg_controllen = BATCH_CTRL_SIZE;
+        msg->msg_flags = 0;
+        batch->iovs[i].iov_len = BATCH_SLOT_SIZE;
+    }
+
+    int ret = recvmmsg(sd, batch->hdrs, batch->cnt, MSG_DONTWAIT, NULL);
+    if (ret == -1) {
+        if (errno == EAGAIN || errno == EWOULDBLOCK) {
+            // Nothing to read (e.g. the datagram has been dropped due to an invalid checksum)
+            return 0;
+        }
+
+        const char *err_str;
+        ipx_strerror(errno, err_str);
+        IPX_CTX_ERROR(ctx, "Failed to read datagrams. recvmmsg() failed: %s", err_str);
+        return 0;
+    }
+
+    return (unsigned int) ret;
+}
+
+/**
+ * \brief Get a copy of a received datagram from a batch
+ * \param[in]  ctx   Instance context
+ * \param[in]  batch Batch
+ * \param[in]  idx   Index of the datagram in the batch
+ * \param[out] size  Size of the datagram
+ * \return Pointer to the datagram (allocated by ipx_utils_buf_alloc())
+ * \return NULL if the datagram is malformed or a memory allocation error has occurred
+ */
+static uint8_t *
+batch_copy(ipx_ctx_t *ctx, const struct udp_batch *batch, unsigned int idx, int *size)
+{
+    const struct mmsghdr *hdr = &batch->hdrs[idx];
+    const size_t msg_size = hdr->msg_len;
+
+    if (msg_size < sizeof(uint16_t) || (hdr->msg_hdr.msg_flags & MSG_TRUNC) != 0) {
+        IPX_CTX_WARNING(ctx, "Received an invalid datagram (%zu bytes long)", msg_size);
+        return NULL;
+    }
+
+    uint8_t *buffer = ipx_utils_buf_alloc(msg_size * sizeof(uint8_t));
+    if (!buffer) {
+        IPX_CTX_ERROR(ctx, "Memory allocation failed! (%s:%d)", __FILE__, __LINE__);
+        return NULL;
+    }
+
+    memcpy(buffer, batch->iovs[idx].iov_base, msg_size);
+    *size = (int) msg_size;
+    return buffer;
+}
+
+/**
+ * \brief Update statistics of a socket with datagrams received into a batch
+ *
+ * The kernel attaches the number of datagrams dropped on the socket so far (SO_RXQ_OVFL) to
+ * received datagrams, if any datagram has been dropped.
+ * \param[in]     batch Batch
+ * \param[in]     cnt   Number of received datagrams in the batch
+ * \param[in,out] stats Statistics of the socket (can be NULL)
+ */
+static void
+batch_stats(struct udp_batch *batch, unsigned int cnt, struct udp_sock_stats *stats)
+{
+    if (stats == NULL || cnt == 0) {
+        return;
+    }
+
+    uint32_t ovfl = __atomic_load_n(&stats->ovfl, __ATOMIC_RELAXED);
+    for (unsigned int i = 0; i < cnt; ++i) {
+        struct msghdr *msg = &batch->hdrs[i].msg_hdr;
+        for (struct cmsghdr *cmsg = CMSG_FIRSTHDR(msg); cmsg; cmsg = CMSG_NXTHDR(msg, cmsg)) {
+            if (cmsg->cmsg_level != SOL_SOCKET || cmsg->cmsg_type != SO_RXQ_OVFL) {
+                continue;
+            }
+
+            uint32_t value;
+            memcpy(&value, CMSG_DATA(cmsg), sizeof(value));
+            if ((int32_t) (value - ovfl) > 0) { // The counter can wrap around
+                ovfl = value;
+            }
+        }
+    }
+
+    __atomic_store_n(&stats->ovfl, ovfl, __ATOMIC_RELAXED);
+    __atomic_add_fetch(&stats->packets, cnt, __ATOMIC_RELAXED);
+}
+
+/**
+ * \brief Get the time of reception of a datagram in a batch by the kernel
+ *
+ * The timestamp is available only if the SO_TIMESTAMPNS option is enabled on the socket.
+ * \param[in]  batch Batch
+ * \param[in]  idx   Index of the datagram in the batch
+ * \param[out] ts    Timestamp (realtime clock)
+ * \return True if the timestamp is available
+ */
+static bool
+batch_stamp(const struct udp_batch *batch, unsigned int idx, struct timespec *ts)
+{
+    struct msghdr *msg = (struct msghdr *) &batch->hdrs[idx].msg_hdr;
+    for (struct cmsghdr *cmsg = CMSG_FIRSTHDR(msg); cmsg; cmsg = CMSG_NXTHDR(msg, cmsg)) {
+        if (cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_TIMESTAMPNS) {
+            memcpy(ts, CMSG_DATA(cmsg), sizeof(*ts));
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/**
+ * \brief Pass datagrams received by a receiver thread to the instance thread
+ *
+ * If the queue is full, the function blocks until the instance thread takes all datagrams.
+ * \param[in] worker Receiver thread
+ * \param[in] sd     File descriptor of the socket
+ * \param[in] cnt    Number of datagrams in the batch of the thread
+ * \return True on success
+ * \return False if the thread should terminate (datagrams are dropped)
+ */
+static bool
+worker_push(struct udp_worker *worker, int sd, unsigned int cnt)
+{
+    struct udp_data *instance = worker->instance;
+    size_t items_cnt = 0;
+
+    // Copy datagrams before locking the queue
+    for (unsigned int i = 0; i < cnt; ++i) {
+        struct udp_item *item = &worker->items[items_cnt];
+        item->buffer = batch_copy(instance->ctx, &worker->batch, i, &item->size);
+        if (!item->buffer) {
+            continue;
+        }
+
+        item->sd = sd;
+        memcpy(&item->addr, &worker->batch.addrs[i], sizeof(item->addr));
+        if (!batch_stamp(&worker->batch, i, &item->rx_ts)) {
+            memset(&item->rx_ts, 0, sizeof(item->rx_ts));
+        }
+        items_cnt++;
+    }
+
+    if (items_cnt == 0) {
+        return true;
+    }
+
+    pthread_mutex_lock(&instance->threads.lock);
+    while (!instance->threads.stop
+            && instance->threads.queue_cnt + items_cnt > instance->threads.queue_max) {
+        pthread_cond_wait(&instance->threads.cond, &instance->threads.lock);
+    }
+
+    const bool stop = instance->threads.stop;
+    const bool notify = (instance->threads.queue_cnt == 0);
+    if (!stop) {
+        struct udp_item *dst = &instance->threads.queue[instance->threads.queue_cnt];
+        memcpy(dst, worker->items, items_cnt * sizeof(*dst));
+        instance->threads.queue_cnt += items_cnt;
+    }
+    pthread_mutex_unlock(&instance->threads.lock);
+
+    if (stop) {
+        for (size_t i = 0; i < items_cnt; ++i) {
+            ipx_utils_buf_free(worker->items[i].buffer);
+        }
+        return false;
+    }
+
+    // Wake up the instance thread only if it's not already aware of datagrams in the queue
+    const uint64_t value = 1;
+    if (notify && write(instance->threads.event_fd, &value, sizeof(value)) == -1) {
+        const char *err_str;
+        ipx_strerror(errno, err_str);
+        IPX_CTX_WARNING(instance->ctx, "Failed to notify the instance thread: %s", err_str);
+    }
+
+    return true;
+}
+
+/**
+ * \brief Main function of a receiver thread
+ *
+ * The thread receives datagrams from its sockets and passes them to the instance thread until
+ * termination is requested.
+ * \param[in] arg Receiver thread (struct udp_worker)
+ * \return Always NULL
+ */
+static void *
+worker_thread(void *arg)
+{
+    struct udp_worker *worker = (struct udp_worker *) arg;
+    struct udp_data *instance = worker->instance;
+    struct epoll_event ev[GETTER_MAX_EVENTS];
+    bool run = true;
+
+    while (run) {
+        int ev_valid = epoll_wait(worker->epoll_fd, ev, GETTER_MAX_EVENTS, WORKER_TIMEOUT);
+        if (ev_valid == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+
+            const char *err_str;
+            ipx_strerror(errno, err_str);
+            IPX_CTX_ERROR(instance->ctx, "epoll_wait() failed: %s. Receiver thread %zu has "
+                "been terminated!", err_str, worker->id);
+            break;
+        }
+
+        if (ev_valid == 0) {
+            // Timeout
+            pthread_mutex_lock(&instance->threads.lock);
+            run = !instance->threads.stop;
+            pthread_mutex_unlock(&instance->threads.lock);
+            continue;
+        }
+
+        for (int i = 0; i < ev_valid && run; ++i) {
+            int sd = ev[i].data.fd;
+            const unsigned int cnt = batch_recv(instance->ctx, &worker->batch, sd);
+            batch_stats(&worker->batch, cnt, stats_find(instance, sd));
+            run = worker_push(worker, sd, cnt);
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * \brief Prepare a receiver thread (without starting it)
+ *
+ * The socket of the thread from each group of reusable sockets is added to its epoll.
+ * \param[in] instance Instance data
+ * \param[in] worker   Receiver thread
+ * \param[in] id       Index of the thread
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_DENIED on failure
+ */
+static int
+worker_init(struct udp_data *instance, struct udp_worker *worker, size_t id)
+{
+    const char *err_str;
+    const size_t group_size = instance->config->threads;
+    const unsigned int batch_size = instance->config->batch_size;
+
+    worker->instance = instance;
+    worker->id = id;
+    worker->epoll_fd = epoll_create(1);
+    if (worker->epoll_fd == INVALID_FD) {
+        ipx_strerror(errno, err_str);
+        IPX_CTX_ERROR(instance->ctx, "epoll() failed: %s", err_str);
+        return IPX_ERR_DENIED;
+    }
+
+    worker->items = malloc(batch_size * sizeof(*worker->items));
+    if (!worker->items || batch_init(instance->ctx, &worker->batch, batch_size) != IPX_OK) {
+        IPX_CTX_ERROR(instance->ctx, "Memory allocation failed! (%s:%d)", __FILE__, __LINE__);
+        free(worker->items);
+        close(worker->epoll_fd);
+        return IPX_ERR_DENIED;
+    }
+
+    for (size_t idx = id; idx < instance->listen.cnt; idx += group_size) {
+        int sd = instance->listen.sockets[idx];
+        struct epoll_event ev;
+        memset(&ev, 0, sizeof(ev));
+        ev.events = EPOLLIN;
+        ev.data.fd = sd;
+        if (epoll_ctl(worker->epoll_fd, EPOLL_CTL_ADD, sd, &ev) == -1) {
+            ipx_strerror(errno, err_str);
+            IPX_CTX_ERROR(instance->ctx, "Failed to add a socket to epoll: %s", err_str);
+            batch_destroy(&worker->batch);
+            free(worker->items);
+            close(worker->epoll_fd);
+            return IPX_ERR_DENIED;
+        }
+    }
+
+    return IPX_OK;
+}
+
+/**
+ * \brief Stop all receiver threads and destroy the queue of received datagrams
+ *
+ * Datagrams that haven't been processed yet are dropped. Only successfully started threads
+ * (see the counter of threads) are joined.
+ * \param[in] instance Instance data
+ */
+static void
+threads_destroy(struct udp_data *instance)
+{
+    if (instance->threads.workers == NULL) {
+        // Not initialized
+        return;
+    }
+
+    pthread_mutex_lock(&instance->threads.lock);
+    instance->threads.stop = true;
+    pthread_cond_broadcast(&instance->threads.cond);
+    pthread_mutex_unlock(&instance->threads.lock);
+
+    for (size_t i = 0; i < instance->threads.cnt; ++i) {
+        struct udp_worker *worker = &instance->threads.workers[i];
+        int rc = pthread_join(worker->thread, NULL);
+        if (rc != 0) {
+            const char *err_str;
+            ipx_strerror(rc, err_str);
+            IPX_CTX_ERROR(instance->ctx, "Failed to join receiver thread %zu! (%s)", i, err_str);
+        }
+
+        close(worker->epoll_fd);
+        batch_destroy(&worker->batch);
+        free(worker->items);
+    }
+
+    for (size_t i = 0; i < instance->threads.queue_cnt; ++i) {
+        ipx_utils_buf_free(instance->threads.queue[i].buffer);
+    }
+
+    epoll_ctl(instance->listen.epoll_fd, EPOLL_CTL_DEL, instance->threads.event_fd, NULL);
+    close(instance->threads.event_fd);
+    pthread_cond_destroy(&instance->threads.cond);
+    pthread_mutex_destroy(&instance->threads.lock);
+    free(instance->threads.queue);
+    free(instance->threads.queue_proc);
+    free(instance->threads.workers);
+    memset(&instance->threads, 0, sizeof(instance->threads));
+}
+
+/**
+ * \brief Start receiver threads (one per socket of each group of reusable sockets)
+ *
+ * Received datagrams are passed to the instance thread via a shared queue. The instance thread
+ * is notified by an event descriptor added to its epoll.
+ * \param[in] instance Instance data
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_DENIED on failure
+ */
+static int
+threads_init(struct udp_data *instance)
+{
+    const char *err_str;
+    const size_t cnt = instance->config->threads;
+    const size_t queue_max = WORKER_QUEUE_MUL * cnt * instance->config->batch_size;
+    assert(cnt > 1);
+
+    struct udp_worker *workers = calloc(cnt, sizeof(*workers));
+    struct udp_item *queue = malloc(queue_max * sizeof(*queue));
+    struct udp_item *queue_proc = malloc(queue_max * sizeof(*queue_proc));
+    if (!workers || !queue || !queue_proc) {
+        IPX_CTX_ERROR(instance->ctx, "Memory allocation failed! (%s:%d)", __FILE__, __LINE__);
+        free(workers);
+        free(queue);
+        free(queue_proc);
+        return IPX_ERR_DENIED;
+    }
+
+    int event_fd = eventfd(0, EFD_NONBLOCK);
+    if (event_fd == INVALID_FD) {
+        ipx_strerror(errno, err_str);
+        IPX_CTX_ERROR(instance->ctx, "Failed to create an event descriptor. eventfd() failed: %s",
+            err_str);
+        free(workers);
+        free(queue);
+        free(queue_proc);
+        return IPX_ERR_DENIED;
+    }
+
+    struct epoll_event ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.events = EPOLLIN;
+    ev.data.fd = event_fd;
+    if (epoll_ctl(instance->listen.epoll_fd, EPOLL_CTL_ADD, event_fd, &ev) == -1) {
+        ipx_strerror(errno, err_str);
+        IPX_CTX_ERROR(instance->ctx, "Failed to add an event descriptor to epoll: %s", err_str);
+        close(event_fd);
+        free(workers);
+        free(queue);
+        free(queue_proc);
+        return IPX_ERR_DENIED;
+    }
+
+    pthread_mutex_init(&instance->threads.lock, NULL);
+    pthread_cond_init(&instance->threads.cond, NULL);
+    instance->threads.workers = workers;
+    instance->threads.event_fd = event_fd;
+    instance->threads.stop = false;
+    instance->threads.queue_max = queue_max;
+    instance->threads.queue_cnt = 0;
+    instance->threads.queue = queue;
+    instance->threads.queue_proc = queue_proc;
+
+    for (size_t i = 0; i < cnt; ++i) {
+        struct udp_worker *worker = &workers[i];
+        if (worker_init(instance, worker, i) != IPX_OK) {
+            break;
+        }
 
-    // The array is not sorted, we have to go through
-    for (idx = 0; idx < instance->active.cnt; ++idx) {
-        struct udp_source *src = instance->active.sources[idx];
-        if (src->local_fd != src_fd) {
-            continue; // Different local socket
+        int rc = pthread_create(&worker->thread, NULL, &worker_thread, worker);
+        if (rc != 0) {
+            ipx_strerror(rc, err_str);
+            IPX_CTX_ERROR(instance->ctx, "Failed to create receiver thread %zu! (%s)", i, err_str);
+            close(worker->epoll_fd);
+            batch_destroy(&worker->batch);
+            free(worker->items);
+            break;
         }
 
-        if (src->src_addr.ss_family != addr->sa_family) {
-            continue; // Different IP address family (IPv4 vs IPv6)
+        instance->threads.cnt++;
+    }
+
+    if (instance->threads.cnt != cnt) {
+        // Stop already running threads
+        threads_destroy(instance);
+        return IPX_ERR_DENIED;
+    }
+
+    IPX_CTX_INFO(instance->ctx, "Datagrams are received by %zu threads.", cnt);
+    return IPX_OK;
+}
+
+/**
+ * \brief Mix a 32-bit value into a hash of a source
+ * \param[in] hash  Current hash value
+ * \param[in] value Value to add
+ * \return New hash value
+ */
+static inline uint32_t
+active_hash_mix(uint32_t hash, uint32_t value)
+{
+    hash ^= value;
+    hash *= 0x9E3779B1U; // Golden ratio (multiplicative hashing)
+    return hash ^ (hash >> 15);
+}
+
+/**
+ * \brief Get a hash of a source identification
+ * \param[in] src_fd Socket descriptor of local address on which the source data come
+ * \param[in] addr   Remote IPv4/IPv6 address and port
+ * \return Hash value
+ */
+static uint32_t
+active_hash(int src_fd, const struct sockaddr *addr)
+{
+    uint32_t hash = active_hash_mix(0, (uint32_t) src_fd);
+    uint32_t words[4];
+
+    if (addr->sa_family == AF_INET) {
+        const struct sockaddr_in *addr_v4 = (const struct sockaddr_in *) addr;
+        hash = active_hash_mix(hash, addr_v4->sin_port);
+        return active_hash_mix(hash, addr_v4->sin_addr.s_addr);
+    }
+
+    assert(addr->sa_family == AF_INET6);
+    const struct sockaddr_in6 *addr_v6 = (const struct sockaddr_in6 *) addr;
+    memcpy(words, &addr_v6->sin6_addr, sizeof(words));
+    hash = active_hash_mix(hash, addr_v6->sin6_port);
+    for (size_t i = 0; i < sizeof(words) / sizeof(words[0]); ++i) {
+        hash = active_hash_mix(hash, words[i]);
+    }
+    return hash;
+}
+
+/**
+ * \brief Check if a source matches the identification
+ * \param[in] src    Source
+ * \param[in] src_fd Socket descriptor of local address on which the source data come
+ * \param[in] addr   Remote IPv4/IPv6 address and port
+ * \return True or false
+ */
+static bool
+active_match(const struct udp_source *src, int src_fd, const struct sockaddr *addr)
+{
+    if (src->local_fd != src_fd) {
+        return false; // Different local socket
+    }
+
+    if (src->src_addr.ss_family != addr->sa_family) {
+        return false; // Different IP address family (IPv4 vs IPv6)
+    }
+
+    if (addr->sa_family == AF_INET) {
+        // IPv4 addresses
+        const struct sockaddr_in *to_find = (const struct sockaddr_in *) addr;
+        const struct sockaddr_in *to_cmp = (const struct sockaddr_in *) &src->src_addr;
+        return to_find->sin_port == to_cmp->sin_port
+            && memcmp(&to_find->sin_addr, &to_cmp->sin_addr, sizeof(struct in_addr)) == 0;
+    }
+
+    // IPv6 addresses
+    assert(addr->sa_family == AF_INET6);
+    const struct sockaddr_in6 *to_find = (const struct sockaddr_in6 *) addr;
+    const struct sockaddr_in6 *to_cmp = (const struct sockaddr_in6 *) &src->src_addr;
+    return to_find->sin6_port == to_cmp->sin6_port
+        && memcmp(&to_find->sin6_addr, &to_cmp->sin6_addr, sizeof(struct in6_addr)) == 0;
+}
+
+/**
+ * \brief Get the bucket of the hash table for a source
+ * \param[in] instance Instance data
+ * \param[in] src_fd   Socket descriptor of local address on which the source data come
+ * \param[in] addr     Remote IPv4/IPv6 address and port
+ * \return Pointer to the head of the bucket
+ */
+static inline struct udp_source **
+active_bucket(struct udp_data *instance, int src_fd, const struct sockaddr *addr)
+{
+    const size_t idx = active_hash(src_fd, addr) & (instance->active.table_size - 1);
+    return &instance->active.table[idx];
+}
+
+/**
+ * \brief Schedule expiration of a source
+ *
+ * The source is inserted into the slot of the timer wheel that corresponds to the timer tick
+ * when the source expires, if no other message is received in the meantime.
+ * \param[in] instance Instance data
+ * \param[in] src      Source
+ */
+static void
+active_schedule(struct udp_data *instance, struct udp_source *src)
+{
+    // The wheel has one more slot than the timeout, so the current slot is never selected
+    const uint64_t expire = src->last_seen + (instance->active.wheel_size - 1);
+    struct udp_source **slot = &instance->active.wheel[expire % instance->active.wheel_size];
+    src->wheel_next = *slot;
+    *slot = src;
+}
+
+/**
+ * \brief Double the number of buckets of the hash table
+ * \note On failure, the original table is preserved (i.e. only lookup is slower).
+ * \param[in] instance Instance data
+ */
+static void
+active_table_grow(struct udp_data *instance)
+{
+    const size_t old_size = instance->active.table_size;
+    struct udp_source **old_table = instance->active.table;
+    struct udp_source **new_table = calloc(2 * old_size, sizeof(*new_table));
+    if (!new_table) {
+        IPX_CTX_WARNING(instance->ctx, "Memory allocation failed! (%s:%d)", __FILE__, __LINE__);
+        return;
+    }
+
+    instance->active.table = new_table;
+    instance->active.table_size = 2 * old_size;
+
+    for (size_t i = 0; i < old_size; ++i) {
+        struct udp_source *src = old_table[i];
+        while (src != NULL) {
+            struct udp_source *next = src->hash_next;
+            struct udp_source **bucket = active_bucket(instance, src->local_fd,
+                (const struct sockaddr *) &src->src_addr);
+            src->hash_next = *bucket;
+            *bucket = src;
+            src = next;
+        }
+    }
+
+    free(old_table);
+}
+
+/**
+ * \brief Initialize the table of active Transport Sessions
+ *
+ * The timer wheel has a slot for each timer tick of the connection timeout.
+ * \param[in] instance Instance data
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_NOMEM if a memory allocation has failed
+ */
+static int
+active_init(struct udp_data *instance)
+{
+    const size_t timeout = instance->config->timeout_conn;
+    const size_t wheel_size = (timeout + TIMER_INTERVAL - 1) / TIMER_INTERVAL + 1;
+
+    instance->active.cnt = 0;
+    instance->active.tick = 0;
+    instance->active.table_size = ACTIVE_TABLE_INIT;
+    instance->active.table = calloc(ACTIVE_TABLE_INIT, sizeof(*instance->active.table));
+    instance->active.wheel_size = wheel_size;
+    instance->active.wheel = calloc(wheel_size, sizeof(*instance->active.wheel));
+    if (!instance->active.table || !instance->active.wheel) {
+        IPX_CTX_ERROR(instance->ctx, "Memory allocation failed! (%s:%d)", __FILE__, __LINE__);
+        free(instance->active.table);
+        free(instance->active.wheel);
+        return IPX_ERR_NOMEM;
+    }
+
+    return IPX_OK;
+}
+
+/**
+ * \brief Add a new record of a Transport Session
+ *
+ * New record is added into the hash table of active connections and scheduled for expiration
+ * in the timer wheel.
+ * \param[in] instance Instance data
+ * \param[in] src_fd   Socket descriptor of local address on which the source data come
+ * \param[in] src_addr Remote IPv4/IPv6 address to add
+ * \param[in] dst_hint Local IPv4/IPv6 address (if NULL, it's determined from the socket)
+ * \return Pointer to the newly added record or NULL (memory allocation error)
+ */
+static struct udp_source *
+active_add(struct udp_data *instance, int src_fd, const struct sockaddr *src_addr,
+    const struct sockaddr *dst_hint)
+{
+    socklen_t src_addrlen;
+
+    // Get the description of the local address
+    struct sockaddr_storage dst_addr;
+    socklen_t dst_addrlen = sizeof(dst_addr);
+    memset(&dst_addr, 0, sizeof(dst_addr));
+
+    if (dst_hint != NULL) {
+        // Sockets bound to a network interface (AF_XDP) don't have any local IP address
+        memcpy(&dst_addr, dst_hint, (dst_hint->sa_family == AF_INET6)
+            ? sizeof(struct sockaddr_in6) : sizeof(struct sockaddr_in));
+    } else if (getsockname(src_fd, (struct sockaddr *) &dst_addr, &dst_addrlen) == -1) {
+        const char *err_str;
+        ipx_strerror(errno, err_str);
+        IPX_CTX_ERROR(instance->ctx, "Failed to get the local IP address. getsockname() failed: %s",
+            err_str);
+        return NULL;
+    }
+
+    if (src_addr->sa_family != dst_addr.ss_family) {
+        IPX_CTX_WARNING(instance->ctx, "New connection has different family of local and "
+            "remote IP addresses!", '\0');
+    }
+
+    // Create a new Transport Session
+    struct ipx_session_net net;
+    memset(&net, 0, sizeof(net));
+
+    net.l3_proto = src_addr->sa_family;
+    if (net.l3_proto == AF_INET) { // IPv4
+        src_addrlen = sizeof(struct sockaddr_in);
+        const struct sockaddr_in *src_v4 = (struct sockaddr_in *) src_addr;
+        const struct sockaddr_in *dst_v4 = (struct sockaddr_in *) &dst_addr;
+        net.port_src = ntohs(src_v4->sin_port);
+        net.port_dst = ntohs(dst_v4->sin_port);
+        net.addr_src.ipv4 = src_v4->sin_addr;
+        net.addr_dst.ipv4 = dst_v4->sin_addr;
+    } else if (net.l3_proto == AF_INET6) { // IPv6
+        src_addrlen = sizeof(struct sockaddr_in6);
+        const struct sockaddr_in6 *src_v6 = (struct sockaddr_in6 *) src_addr;
+        const struct sockaddr_in6 *dst_v6 = (struct sockaddr_in6 *) &dst_addr;
+        net.port_src = ntohs(src_v6->sin6_port);
+        net.port_dst = ntohs(dst_v6->sin6_port);
+        if (IN6_IS_ADDR_V4MAPPED(&src_v6->sin6_addr)) {
+            // IPv4 mapped into IPv6
+            net.l3_proto = AF_INET; // Overwrite family type!
+            net.addr_src.ipv4 = *(const struct in_addr *) (((uint8_t *) &src_v6->sin6_addr) + 12);
+            net.addr_dst.ipv4 = *(const struct in_addr *) (((uint8_t *) &dst_v6->sin6_addr) + 12);
+        } else {
+            net.addr_src.ipv6 = src_v6->sin6_addr;
+            net.addr_dst.ipv6 = dst_v6->sin6_addr;
+        }
+    } else {
+        // Unknown address type
+        IPX_CTX_ERROR(instance->ctx, "New connection has an unsupported IP address family "
+            "(family ID: %u)!", (unsigned) src_addr->sa_family);
+        return NULL;
+    }
+
+    char src_addr_str[INET6_ADDRSTRLEN] = {0};
+    inet_ntop(net.l3_proto, &net.addr_src, src_addr_str, INET6_ADDRSTRLEN);
+
+    const struct udp_config *cfg = instance->config;
+    struct ipx_session *session = ipx_session_new_udp(&net, cfg->lifetime_data, cfg->lifetime_opts);
+    if (!session) {
+        IPX_CTX_ERROR(instance->ctx, "Failed to create a Transport Session description of %s.",
+            src_addr_str);
+        return NULL;
+    }
+
+    // Create a new record
+    struct udp_source *rec2add = calloc(1, sizeof(*rec2add));
+    if (!rec2add) {
+        IPX_CTX_ERROR(instance->ctx, "Memory allocation failed! (%s:%d)", __FILE__, __LINE__);
+        ipx_session_destroy(session);
+        return NULL;
+    }
+
+    rec2add->local_fd = src_fd;
+    memcpy(&rec2add->src_addr, src_addr, src_addrlen);
+    rec2add->session = session;
+    rec2add->last_seen = instance->active.tick; // now!
+    rec2add->new_connection = true; // Session Message hasn't been send yet
+    rec2add->limit_tokens = instance->limit.capacity; // Full bucket
+    rec2add->limit_ts = (instance->limit.capacity > 0) ? limit_now() : 0;
+
+    // Insert into the table of active connections and schedule its expiration
+    if (instance->active.cnt >= instance->active.table_size) {
+        active_table_grow(instance);
+    }
+
+    struct udp_source **bucket = active_bucket(instance, src_fd, src_addr);
+    rec2add->hash_next = *bucket;
+    *bucket = rec2add;
+    active_schedule(instance, rec2add);
+    instance->active.cnt++;
+
+    IPX_CTX_INFO(instance->ctx, "New exporter connected from '%s'.", src_addr_str);
+    return rec2add;
+}
+
+/**
+ * \brief Remove an active Transport Session
+ *
+ * Generate and pass a Session Message - connect event (if necessary) and remove the corresponding
+ * session from the hash table.
+ * \warning The source MUST NOT be present in the timer wheel (i.e. the caller is responsible
+ *   for its removal), unless the whole wheel is going to be destroyed.
+ * \param[in] instance Instance data
+ * \param[in] src      Source to remove
+ */
+static void
+active_remove(struct udp_data *instance, struct udp_source *src)
+{
+    IPX_CTX_INFO(instance->ctx, "Transport Session '%s' closed!", src->session->ident);
+    if (src->limit_dropped != src->limit_reported) {
+        IPX_CTX_WARNING(instance->ctx, "Exporter '%s' exceeded the rate limit. %" PRIu64
+            " datagrams dropped since the previous report.", src->session->ident,
+            src->limit_dropped - src->limit_reported);
+    }
+    // Have we received at least one valid record?
+    if (src->new_connection) {
+        // No messages have been passed with a reference to this session -> destroy immediately
+        ipx_session_destroy(src->session);
+    } else {
+        // Generate a Session message (order of the messages MUST be preserved)
+        ipx_msg_session_t *msg_sess = ipx_msg_session_create(src->session, IPX_MSG_SESSION_CLOSE);
+        if (!msg_sess) {
+            IPX_CTX_WARNING(instance->ctx, "Failed to create a Session message! Instances of "
+                "plugins will not be informed about the closed Transport Session '%s' (%s:%d)",
+                src->session->ident, __FILE__, __LINE__);
+            /* Do not pass and definitely do NOT free the session structure because it still can be
+             * used by other plugins. Remove it only from the local table!
+             * NO RETURN HERE!
+             */
+        } else {
+            // Pass the message and put the Session into the garbage
+            ipx_ctx_msg_pass(instance->ctx, ipx_msg_session2base(msg_sess));
+
+            ipx_msg_garbage_cb cb = (ipx_msg_garbage_cb) &ipx_session_destroy;
+            ipx_msg_garbage_t *msg_garbage = ipx_msg_garbage_create(src->session, cb);
+            if (!msg_garbage) {
+                IPX_CTX_ERROR(instance->ctx, "Memory allocation failed! (%s:%d)", __FILE__, __LINE__);
+            } else {
+                ipx_ctx_msg_pass(instance->ctx, ipx_msg_garbage2base(msg_garbage));
+            }
         }
+    }
 
-        if (addr->sa_family == AF_INET) {
-            // IPv4 addresses
-            const struct sockaddr_in *to_find = (const struct sockaddr_in *) addr;
-            const struct sockaddr_in *to_cmp = (const struct sockaddr_in *) &src->src_addr;
-            if (to_find->sin_port != to_cmp->sin_port) {
-                continue; // Different ports
-            }
+    // Remove from the hash table and free the wrapper
+    struct udp_source **ptr = active_bucket(instance, src->local_fd,
+        (const struct sockaddr *) &src->src_addr);
+    while (*ptr != src) {
+        assert(*ptr != NULL);
+        ptr = &(*ptr)->hash_next;
+    }
 
-            if (memcmp(&to_find->sin_addr, &to_cmp->sin_addr, sizeof(struct in_addr)) != 0) {
-                continue;
-            }
-            // Found
-            break;
-        } else {
-            // IPv6 addresses
-            assert(addr->sa_family == AF_INET6);
-            const struct sockaddr_in6 *to_find = (const struct sockaddr_in6 *) addr;
-            const struct sockaddr_in6 *to_cmp = (const struct sockaddr_in6 *) &src->src_addr;
-            if (to_find->sin6_port != to_cmp->sin6_port) {
-                continue; // Different ports
-            }
+    *ptr = src->hash_next;
+    free(src);
+    instance->active.cnt--;
+}
 
-            if (memcmp(&to_find->sin6_addr, &to_cmp->sin6_addr, sizeof(struct in6_addr)) != 0) {
-                continue;
-            }
-            // Found
-            break;
+/**
+ * \brief Remove all active Transport Sessions and destroy the table
+ * \param[in] instance Instance data
+ */
+static void
+active_destroy(struct udp_data *instance)
+{
+    for (size_t i = 0; i < instance->active.table_size; ++i) {
+        while (instance->active.table[i] != NULL) {
+            active_remove(instance, instance->active.table[i]);
         }
     }
 
-    if (idx == instance->active.cnt) {
-        // Not found
-        return NULL;
+    free(instance->active.table);
+    free(instance->active.wheel);
+    instance->active.table = NULL;
+    instance->active.wheel = NULL;
+}
+
+/**
+ * \brief Find a record of an active Transport Session
+ *
+ * \param[in] instance Instance data
+ * \param[in] src_fd   Socket descriptor of local address on which the source data come
+ * \param[in] addr     Remote IPv4/IPv6 Address to find
+ * \return Pointer to the record or NULL (the record doesn't exist)
+ */
+static struct udp_source *
+active_find(struct udp_data *instance, int src_fd, const struct sockaddr *addr)
+{
+    struct udp_source *src = *active_bucket(instance, src_fd, addr);
+    while (src != NULL && !active_match(src, src_fd, addr)) {
+        src = src->hash_next;
     }
 
-    return instance->active.sources[idx];
+    return src;
 }
 
 /**
@@ -780,10 +2158,12 @@ active_find(struct udp_data *instance, int src_fd, const struct sockaddr *addr)
  * \param[in] instance Instance data
  * \param[in] src_fd   Socket descriptor to which is the Session connected
  * \param[in] addr     Remove IPv4/IPv6 address (and port) of the session
+ * \param[in] local    Local IPv4/IPv6 address (if NULL, it's determined from the socket)
  * \return Pointer to the Session or NULL (typically memory allocation error)
  */
 static struct udp_source *
-active_get(struct udp_data *instance, int src_fd, const struct sockaddr *addr)
+active_get(struct udp_data *instance, int src_fd, const struct sockaddr *addr,
+    const struct sockaddr *local)
 {
     // Try to find
     struct udp_source *src = active_find(instance, src_fd, addr);
@@ -792,78 +2172,54 @@ active_get(struct udp_data *instance, int src_fd, const struct sockaddr *addr)
     }
 
     // Not found, add a new record
-    return active_add(instance, src_fd, addr);
+    return active_add(instance, src_fd, addr, local);
 }
 
 /**
- * \brief Compare 2 active Transport Session by activity
+ * \brief Check activity of Transport Sessions
  *
- * \note The sessions are primary sorted by number of messages received since the last reset of
- * counters. Secondary, if the both counters are zero, the sessions are sorted by the timestamp
- * of their last occurrence.
- * \param p1 First Transport Session
- * \param p2 Second Transport Session
- * \return
- *   The comparison function returns an integer less than, equal to, or greater than zero if the
- *   first Session is considered to be respectively more, equal to, or less active than the
- *   second.
+ * For each timer tick, only sources in the corresponding slot of the timer wheel are checked.
+ * Sources that have been seen in the meantime are scheduled again and inactive ones are closed.
+ * \param[in] instance Instance data
+ * \param[in] ticks    Number of timer ticks since the previous check
  */
-static int
-active_cmp_activity(const void *p1, const void *p2)
+static void
+active_check(struct udp_data *instance, uint64_t ticks)
 {
-    const struct udp_source *left =  *(const struct udp_source **) p1;
-    const struct udp_source *right = *(const struct udp_source **) p2;
-
-    // Primary, compare by number of messages since the last reset of counter
-    if (left->msg_cnt != right->msg_cnt) {
-        return (left->msg_cnt > right->msg_cnt) ? (-1) : 1; // Sort in descending order
-    }
+    const size_t wheel_size = instance->active.wheel_size;
+    const uint64_t timeout = wheel_size - 1;
 
-    if (left->msg_cnt != 0) {
-        // Both have the same non-zero value of counters,
-        return 0;
-    }
-
-    assert(left->msg_cnt == 0 && right->msg_cnt == 0);
-    // Secondary, compare by the last seen timestamps
-    if (left->last_seen == right->last_seen) {
-        return 0;
+    // If the check has been delayed by more than one revolution, visit each slot only once
+    if (ticks > wheel_size) {
+        instance->active.tick += ticks - wheel_size;
+        ticks = wheel_size;
     }
 
-    return (left->last_seen > right->last_seen) ? (-1) : 1;
-}
-
-/**
- * \brief Sort all active Transport Session by activity and reset activity counters
- *
- * The most active Transport Session go to the front. Activity is compared by number of received
- * IPFIX Messages since the last restart of counters.
- * \param[in] instance Instance data
- */
-static void
-active_sort_and_reset(struct udp_data *instance)
-{
-    const size_t rec_size = sizeof(*instance->active.sources);
-    qsort(instance->active.sources, instance->active.cnt, rec_size, &active_cmp_activity);
-
-    time_t now = time(NULL);
-    for (size_t i = 0; i < instance->active.cnt; ++i) {
-        struct udp_source *src = instance->active.sources[i];
-        if (src->msg_cnt == 0) {
-            // No new messages since the last check
-            continue;
+    while (ticks-- > 0) {
+        const uint64_t now = ++instance->active.tick;
+        struct udp_source **slot = &instance->active.wheel[now % wheel_size];
+        struct udp_source *src = *slot;
+        *slot = NULL;
+
+        while (src != NULL) {
+            struct udp_source *next = src->wheel_next;
+            if (src->last_seen + timeout > now) {
+                // Still active
+                active_schedule(instance, src);
+            } else {
+                // Remove and generate Session message - close event, if necessary
+                active_remove(instance, src);
+            }
+            src = next;
         }
-
-        src->last_seen = now;
-        src->msg_cnt = 0;
     }
+
+    IPX_CTX_DEBUG(instance->ctx, "The instance holds information about %zu active session(s).",
+        instance->active.cnt);
 }
 
 /**
  * \brief Process a timer event
- *
- * Sort all sources by their activity (number of messages sent between timer events) and
- * close inactive Transport Sessions.
  * \param[in] instance Instance data
  * \param[in] fd       File descriptor of a timer
  */
@@ -882,94 +2238,38 @@ process_timer(struct udp_data *instance, int fd)
         return;
     }
 
-    // The inactive Transport Sessions will be at the end of the (sorted) array
-    active_sort_and_reset(instance);
-
-    time_t now = time(NULL);
-    size_t idx;
-    for (idx = 0; idx < instance->active.cnt; ++idx) {
-        if (instance->active.sources[idx]->last_seen + instance->config->timeout_conn >= now) {
-            continue;
-        }
-
-        // Close this Session and all that follows
-        break;
-    }
-
-    while (idx < instance->active.cnt) {
-        // Remove and generate Session message - close event, if necessary
-        assert(instance->active.sources[idx]->last_seen + instance->config->timeout_conn < now);
-        active_remove_by_id(instance, idx);
-    }
-
-    IPX_CTX_DEBUG(instance->ctx, "The instance holds information about %zu active session(s).",
-        instance->active.cnt);
+    active_check(instance, event_cnt);
+    stats_check(instance);
 }
 
 /**
- * \brief Get an IPFIX/NetFlow message from a socket and pass it
+ * \brief Process a received IPFIX/NetFlow message and pass it
+ *
+ * \note The buffer is always consumed (i.e. passed or freed).
  * \param[in] instance Instance data
  * \param[in] sd       File descriptor of the socket
+ * \param[in] addr     Source address of the message
+ * \param[in] local    Destination address of the message (if NULL, the address of the socket)
+ * \param[in] rx_ts    Time of reception by the kernel (if NULL, not available)
+ * \param[in] buffer   Message (allocated by ipx_utils_buf_alloc() or owned by a registered
+ *   buffer region)
+ * \param[in] msg_size Size of the message
  */
 static void
-process_socket(struct udp_data *instance, int sd)
+process_datagram(struct udp_data *instance, int sd, const struct sockaddr *addr,
+    const struct sockaddr *local, const struct timespec *rx_ts, uint8_t *buffer, int msg_size)
 {
-    const char *err_str;
-
-    // Get size of the message
-    int msg_size;
-    if (ioctl(sd, FIONREAD, &msg_size) == -1) {
-        ipx_strerror(errno, err_str);
-        IPX_CTX_ERROR(instance->ctx, "Unable to get size of a next datagram. ioctl() failed: %s",
-            err_str);
-        return;
-    }
-
-    if (msg_size < (int) sizeof(uint16_t) || msg_size > UINT16_MAX) {
-        // Remove the malformed message from the buffer
-        uint16_t mini_buffer;
-        ssize_t ret = recvfrom(sd, &mini_buffer, sizeof(mini_buffer), 0, NULL, NULL);
-        if (ret == -1) {
-            ipx_strerror(errno, err_str);
-            IPX_CTX_WARNING(instance->ctx, "An error has occurred during reading a malformed "
-                "message. recvfrom() failed: %s", err_str);
-            return;
-        }
-
-        IPX_CTX_WARNING(instance->ctx, "Received an invalid datagram (%d bytes long)", msg_size);
-        return;
-    }
-
-    // Allocate the buffer
-    uint8_t *buffer = malloc(msg_size * sizeof(uint8_t));
-    if (!buffer) {
-        IPX_CTX_ERROR(instance->ctx, "Memory allocation failed! (%s:%d)", __FILE__, __LINE__);
-        return;
-    }
-
-    // Get the message
-    struct sockaddr_storage addr;
-    socklen_t addr_len = sizeof(addr);
-    ssize_t ret = recvfrom(sd, buffer, (size_t) msg_size, 0, (struct sockaddr *) &addr, &addr_len);
-    if (ret == -1) {
-        // Failed
-        ipx_strerror(errno, err_str);
-        IPX_CTX_ERROR(instance->ctx, "Failed to read a datagram. recvfrom() failed %s", err_str);
-        free(buffer);
-        return;
-    }
-
-    if (ret != msg_size) {
-        IPX_CTX_ERROR(instance->ctx, "Read operation failed! Got %zu of %zu bytes!",
-            (size_t) ret, (size_t) msg_size);
-        free(buffer);
+    // Find the source
+    struct udp_source *source = active_get(instance, sd, addr, local);
+    if (!source) { // Memory allocation error!
+        ipx_utils_buf_free(buffer);
         return;
     }
 
-    // Find the source
-    struct udp_source *source = active_get(instance, sd, (struct sockaddr *) &addr);
-    if (!source) { // Memory allocation error!
-        free(buffer);
+    if (!limit_accept(instance, source)) {
+        // Drop excess traffic of the exporter before anything else (the exporter is still alive)
+        source->last_seen = instance->active.tick;
+        ipx_utils_buf_free(buffer);
         return;
     }
 
@@ -1004,15 +2304,40 @@ process_socket(struct udp_data *instance, int sd)
         // Source ID is not available in NetFlow v5 -> always 0
         msg_odid = 0;
         break;
+    case 0: { // sFlow v5 (32-bit version number)
+        if (msg_size < SFLOW_HDR_LEN_MIN || ntohs(*(uint16_t *) &buffer[2]) != SFLOW_HDR_VERSION) {
+            is_len_ok = false;
+            break;
+        }
+
+        // Sub-agent ID follows the agent address (IPv4 or IPv6)
+        const uint32_t addr_type = ntohl(*(uint32_t *) &buffer[SFLOW_HDR_ADDR_TYPE]);
+        const int addr_size = (addr_type == SFLOW_ADDR_IPV6) ? 16 : 4;
+        if (msg_size < SFLOW_HDR_LEN_MIN - 4 + addr_size) {
+            is_len_ok = false;
+            break;
+        }
+
+        msg_odid = ntohl(*(uint32_t *) &buffer[SFLOW_HDR_ADDR_TYPE + 4 + addr_size]);
+        }
+        break;
     default:
         is_len_ok = false;
         break;
     }
 
     if (!is_len_ok) {
-        IPX_CTX_ERROR(instance->ctx, "Receiver an invalid NetFlow/IPFIX Message header from '%s'. "
-            "The message will be dropped!", source->session->ident);
-        free(buffer);
+        IPX_CTX_ERROR(instance->ctx, "Receiver an invalid NetFlow/IPFIX/sFlow Message header from "
+            "'%s'. The message will be dropped!", source->session->ident);
+        ipx_utils_buf_free(buffer);
+        return;
+    }
+
+    if (!odid_accept(instance, msg_odid)) {
+        // Drop unwanted ODIDs before the parser creates any state (i.e. a stream context) of them.
+        // If all ODIDs of the exporter are filtered, the Transport Session is never announced.
+        source->last_seen = instance->active.tick;
+        ipx_utils_buf_free(buffer);
         return;
     }
 
@@ -1038,12 +2363,191 @@ process_socket(struct udp_data *instance, int sd)
     ipx_msg_ipfix_t *msg = ipx_msg_ipfix_create(instance->ctx, &msg_ctx, buffer, (uint16_t) msg_size);
     if (!msg) {
         IPX_CTX_ERROR(instance->ctx, "Memory allocation failed! (%s:%d)", __FILE__, __LINE__);
-        free(buffer);
+        ipx_utils_buf_free(buffer);
         return;
     }
 
+    struct ipx_msg_ctx *ctx_ptr = ipx_msg_ipfix_get_ctx(msg);
+    if (rx_ts != NULL && ctx_ptr->ingress_ts != 0) {
+        // Measure latency since the arrival of the datagram, not since its processing
+        ctx_ptr->ingress_ts = ipx_latency_from_realtime(rx_ts);
+    }
+
     ipx_ctx_msg_pass(instance->ctx, ipx_msg_ipfix2base(msg));
-    source->msg_cnt++;
+    source->last_seen = instance->active.tick;
+}
+
+/**
+ * \brief Get IPFIX/NetFlow messages from a socket and pass them
+ *
+ * Up to the configured number of datagrams is received by a single recvmmsg() call into the
+ * preallocated slots. Each datagram is then copied into a buffer of exact size.
+ * \param[in] instance Instance data
+ * \param[in] sd       File descriptor of the socket
+ */
+static void
+process_socket(struct udp_data *instance, int sd)
+{
+    struct udp_batch *batch = &instance->batch;
+    const unsigned int cnt = batch_recv(instance->ctx, batch, sd);
+    batch_stats(batch, cnt, stats_find(instance, sd));
+
+    for (unsigned int i = 0; i < cnt; ++i) {
+        int msg_size;
+        uint8_t *buffer = batch_copy(instance->ctx, batch, i, &msg_size);
+        if (!buffer) {
+            continue;
+        }
+
+        struct timespec rx_ts;
+        const bool rx_valid = batch_stamp(batch, i, &rx_ts);
+        process_datagram(instance, sd, (const struct sockaddr *) &batch->addrs[i], NULL,
+            rx_valid ? &rx_ts : NULL, buffer, msg_size);
+    }
+}
+
+/**
+ * \brief Process datagrams received by receiver threads
+ *
+ * All datagrams in the queue are taken at once and passed.
+ * \param[in] instance Instance data
+ * \param[in] fd       Event descriptor of the queue
+ */
+static void
+process_queue(struct udp_data *instance, int fd)
+{
+    // Reset the notification (the descriptor is non-blocking)
+    uint64_t value;
+    if (read(fd, &value, sizeof(value)) == -1 && errno != EAGAIN) {
+        const char *err_str;
+        ipx_strerror(errno, err_str);
+        IPX_CTX_WARNING(instance->ctx, "Failed to read a notification of receiver threads: %s",
+            err_str);
+    }
+
+    // Swap the queues, so receiver threads can continue immediately
+    pthread_mutex_lock(&instance->threads.lock);
+    struct udp_item *items = instance->threads.queue;
+    size_t items_cnt = instance->threads.queue_cnt;
+    instance->threads.queue = instance->threads.queue_proc;
+    instance->threads.queue_proc = items;
+    instance->threads.queue_cnt = 0;
+    pthread_cond_broadcast(&instance->threads.cond);
+    pthread_mutex_unlock(&instance->threads.lock);
+
+    for (size_t i = 0; i < items_cnt; ++i) {
+        struct udp_item *item = &items[i];
+        const bool rx_valid = (item->rx_ts.tv_sec != 0 || item->rx_ts.tv_nsec != 0);
+        process_datagram(instance, item->sd, (const struct sockaddr *) &item->addr, NULL,
+            rx_valid ? &item->rx_ts : NULL, item->buffer, item->size);
+    }
+}
+
+/**
+ * \brief Get IPFIX/NetFlow messages from an AF_XDP socket and pass them
+ *
+ * Datagrams are passed without copying, i.e. each message keeps its frame of the memory shared
+ * with the kernel until it's destroyed.
+ * \param[in] instance Instance data
+ * \param[in] queue    Index of the receive queue
+ */
+static void
+process_xdp(struct udp_data *instance, unsigned int queue)
+{
+    struct ipx_xdp_packet pkts[XDP_BATCH_SIZE];
+    const int sd = ipx_xdp_fd(instance->listen.xdp, queue);
+    const unsigned int cnt = ipx_xdp_recv(instance->listen.xdp, queue, pkts, XDP_BATCH_SIZE);
+
+    for (unsigned int i = 0; i < cnt; ++i) {
+        struct ipx_xdp_packet *pkt = &pkts[i];
+        if (pkt->size < 2U) {
+            IPX_CTX_WARNING(instance->ctx, "Received an invalid datagram (%zu bytes long)",
+                pkt->size);
+            ipx_utils_buf_free(pkt->data);
+            continue;
+        }
+
+        process_datagram(instance, sd, (const struct sockaddr *) &pkt->src,
+            (const struct sockaddr *) &pkt->dst, NULL, pkt->data, (int) pkt->size);
+    }
+}
+
+/**
+ * \brief Process io_uring events
+ * \param[in] instance Instance data
+ * \param[in] events   Array of events
+ * \param[in] cnt      Number of events
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_DENIED if a request cannot be rearmed
+ */
+static int
+process_uring(struct udp_data *instance, const struct ipx_uring_event *events, int cnt)
+{
+    const char *err_str;
+    ipx_uring_t *uring = instance->listen.uring;
+
+    for (int i = 0; i < cnt; ++i) {
+        const struct ipx_uring_event *ev = &events[i];
+        if (ev->user_data == URING_TIMER_ID) {
+            // Timer event
+            if (ev->res != (int) sizeof(instance->listen.uring_timer)) {
+                ipx_strerror((ev->res < 0) ? -ev->res : EINTR, err_str);
+                IPX_CTX_ERROR(instance->ctx, "Unable to get status of a timer: %s", err_str);
+            } else {
+                active_check(instance, instance->listen.uring_timer);
+                stats_check(instance);
+            }
+
+            uint64_t *timer = &instance->listen.uring_timer;
+            if (ipx_uring_read(uring, instance->listen.timer_fd, timer, sizeof(*timer),
+                    URING_TIMER_ID) != IPX_OK) {
+                IPX_CTX_ERROR(instance->ctx, "Failed to rearm the timer request.", '\0');
+                return IPX_ERR_DENIED;
+            }
+            continue;
+        }
+
+        assert(ev->user_data < instance->listen.cnt);
+        int sd = instance->listen.sockets[ev->user_data];
+        if (ev->res >= 0) {
+            __atomic_add_fetch(&instance->listen.stats[ev->user_data].packets, 1U,
+                __ATOMIC_RELAXED);
+        }
+        if (!ev->more) {
+            // The kernel run out of free buffers or an error has occurred
+            if (ipx_uring_recv_multishot(uring, sd, ev->user_data) != IPX_OK) {
+                IPX_CTX_ERROR(instance->ctx, "Failed to rearm a receive request.", '\0');
+                return IPX_ERR_DENIED;
+            }
+        }
+
+        if (ev->res < 0) {
+            if (ev->res != -ENOBUFS) {
+                ipx_strerror(-ev->res, err_str);
+                IPX_CTX_ERROR(instance->ctx, "Failed to read a datagram: %s", err_str);
+            }
+            continue;
+        }
+
+        if (ev->truncated || ev->size < sizeof(uint16_t) || ev->size > UINT16_MAX) {
+            IPX_CTX_WARNING(instance->ctx, "Received an invalid datagram (%zu bytes long)",
+                ev->size);
+            continue;
+        }
+
+        // The receive buffer is given back to the kernel, so the datagram must be copied
+        uint8_t *buffer = ipx_utils_buf_alloc(ev->size);
+        if (!buffer) {
+            IPX_CTX_ERROR(instance->ctx, "Memory allocation failed! (%s:%d)", __FILE__, __LINE__);
+            continue;
+        }
+
+        memcpy(buffer, ev->data, ev->size);
+        process_datagram(instance, sd, (const struct sockaddr *) &ev->addr, NULL, NULL, buffer,
+            (int) ev->size);
+    }
+
+    return IPX_OK;
 }
 
 // -------------------------------------------------------------------------------------------------
@@ -1058,8 +2562,6 @@ ipx_plugin_init(ipx_ctx_t *ctx, const char *params)
     }
 
     data->ctx = ctx;
-    data->active.cnt = 0;
-    data->active.sources = NULL;
 
     // Parse configuration
     data->config = config_parse(ctx, params);
@@ -1068,13 +2570,70 @@ ipx_plugin_init(ipx_ctx_t *ctx, const char *params)
         return IPX_ERR_DENIED;
     }
 
+    // Size of the bucket of the rate limiter (zero, if disabled)
+    data->limit.capacity = (data->config->rate.limit > 0)
+        ? (uint64_t) data->config->rate.burst * LIMIT_COST : 0;
+
+    if (active_init(data) != IPX_OK) {
+        config_destroy(data->config);
+        free(data);
+        return IPX_ERR_DENIED;
+    }
+
     // Bind to local addresses and arm a timer
     if (listener_init(data) != IPX_OK) {
+        active_destroy(data);
         config_destroy(data->config);
         free(data);
         return IPX_ERR_DENIED;
     }
 
+    if (data->config->xdp.ifname != NULL) {
+        // Optional, regular sockets are used as a fallback
+        listener_xdp_init(data);
+    }
+
+    if (data->config->io_uring && data->listen.xdp != NULL) {
+        IPX_CTX_WARNING(ctx, "io_uring cannot be combined with AF_XDP. Using epoll instead.",
+            '\0');
+        data->config->io_uring = false;
+    }
+
+    if (data->config->threads > 1) {
+        // Receiver threads
+        if (data->config->io_uring) {
+            IPX_CTX_WARNING(ctx, "io_uring cannot be combined with multiple threads. Using epoll "
+                "instead.", '\0');
+        }
+
+        if (threads_init(data) != IPX_OK) {
+            listener_destroy(data);
+            active_destroy(data);
+            config_destroy(data->config);
+            free(data);
+            return IPX_ERR_DENIED;
+        }
+    } else {
+        if (data->config->io_uring) {
+            // Optional, epoll is used as a fallback
+            listener_uring_init(data);
+        }
+
+        if (data->listen.uring == NULL
+                && batch_init(ctx, &data->batch, data->config->batch_size) != IPX_OK) {
+            listener_destroy(data);
+            active_destroy(data);
+            config_destroy(data->config);
+            free(data);
+            return IPX_ERR_DENIED;
+        }
+    }
+
+    // Runtime statistics of sockets (removed by the collector before the instance is destroyed)
+    clock_gettime(CLOCK_MONOTONIC, &data->listen.stats_ts);
+    ipx_ctx_stats_cb_set(ctx, &stats_print, data);
+    metrics_register(data);
+
     ipx_ctx_private_set(ctx, data);
     return IPX_OK;
 }
@@ -1084,14 +2643,13 @@ ipx_plugin_destroy(ipx_ctx_t *ctx, void *cfg)
 {
     (void) ctx;
     struct udp_data *data = (struct udp_data *) cfg;
-    // Unbind all local IP addresses and disarm the timer
+    // Stop receiver threads (if any), unbind all local IP addresses and disarm the timer
+    threads_destroy(data);
     listener_destroy(data);
+    batch_destroy(&data->batch);
 
     // Close all Transport Session (this generates Session messages per each active Session)
-    while (data->active.cnt > 0) {
-        active_remove_by_id(data, 0);
-    }
-    free(data->active.sources);
+    active_destroy(data);
 
     config_destroy(data->config);
     free(data);
@@ -1102,8 +2660,21 @@ ipx_plugin_get(ipx_ctx_t *ctx, void *cfg)
 {
     struct udp_data *data = (struct udp_data *) cfg;
 
+    if (data->listen.uring != NULL) {
+        // Process completed requests (i.e. datagrams and the timer), rearm and submit in one call
+        struct ipx_uring_event ev[URING_BUF_CNT];
+        int ev_valid = ipx_uring_wait(data->listen.uring, ev, URING_BUF_CNT, GETTER_TIMEOUT);
+        if (ev_valid < 0) {
+            const char *err_str;
+            ipx_strerror(errno, err_str);
+            IPX_CTX_ERROR(ctx, "Failed to wait for io_uring events: %s", err_str);
+            return IPX_ERR_DENIED;
+        }
+
+        return (process_uring(data, ev, ev_valid) == IPX_OK) ? IPX_OK : IPX_ERR_DENIED;
+    }
 
-    // Process messages from up to 16 sockets (including the timer)
+    // Process messages from up to 64 sockets (including the timer)
     struct epoll_event ev[GETTER_MAX_EVENTS];
     int ev_valid = epoll_wait(data->listen.epoll_fd, ev, GETTER_MAX_EVENTS, GETTER_TIMEOUT);
     if (ev_valid == -1) {
@@ -1135,6 +2706,19 @@ ipx_plugin_get(ipx_ctx_t *ctx, void *cfg)
             continue;
         }
 
+        if (data->threads.cnt > 0 && sd == data->threads.event_fd) {
+            // Datagrams from receiver threads
+            process_queue(data, sd);
+            continue;
+        }
+
+        int xdp_queue = listener_xdp_queue(data, sd);
+        if (xdp_queue >= 0) {
+            // Datagrams from the network interface
+            process_xdp(data, (unsigned int) xdp_queue);
+            continue;
+        }
+
         process_socket(data, sd);
     }
 
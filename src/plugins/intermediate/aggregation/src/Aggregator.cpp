@@ -0,0 +1,424 @@
+/**
+ * \file src/plugins/intermediate/aggregation/src/Aggregator.cpp
+ * \author agent <agent@local>
+ * \brief Aggregation of flow records (source file)
+ * \date 2026
+ *
+ * Copyright(c) 2026 CESNET z.s.p.o.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include "Aggregator.hpp"
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+
+/// Offset of a field that must be found by fds_drec_find() (e.g. after a variable-length field)
+static const uint16_t OFFSET_FIND = UINT16_MAX;
+/// Offset of a field that is not present in a Template
+static const uint16_t OFFSET_MISSING = UINT16_MAX - 1;
+
+/// IANA Information Element "deltaFlowCount"
+static const uint16_t IANA_DELTA_FLOW_COUNT = 3;
+/// IANA Information Element "flowStartSeconds"
+static const uint16_t IANA_FLOW_START_SEC = 150;
+/// IANA Information Element "flowEndSeconds"
+static const uint16_t IANA_FLOW_END_SEC = 151;
+
+Aggregator::Aggregator(const Config &cfg, const fds_iemgr_t *iemgr)
+    : m_tcache(nullptr, &ipx_tcache_destroy)
+{
+    uint16_t offset = 0;
+    for (const auto &name : cfg.m_keys) {
+        field def = field_create(iemgr, name);
+        def.offset = offset;
+        offset += def.size;
+        m_keys.push_back(def);
+    }
+
+    for (const auto &value : cfg.m_values) {
+        field def = field_create(iemgr, value.name);
+        def.fn = value.fn;
+        if (def.type == vtype::RAW) {
+            throw std::runtime_error("Field '" + value.name + "' cannot be aggregated (not an "
+                "integer or a timestamp)!");
+        }
+        if (def.fn == Config::func::SUM) {
+            const fds_iemgr_elem *elem = fds_iemgr_elem_find_name(iemgr, value.name.c_str());
+            if (elem->data_type == FDS_ET_DATE_TIME_SECONDS
+                    || elem->data_type == FDS_ET_DATE_TIME_MILLISECONDS) {
+                throw std::runtime_error("Timestamp '" + value.name + "' cannot be summed!");
+            }
+        }
+        m_values.push_back(def);
+    }
+
+    // Fields of aggregated records
+    uint32_t rec_size = 0;
+    for (const auto &def : m_keys) {
+        m_tfields.push_back({def.pen, def.id, def.size});
+    }
+    m_tfields.push_back({0, IANA_DELTA_FLOW_COUNT, 8});
+    for (const auto &def : m_values) {
+        m_tfields.push_back({def.pen, def.id, def.size});
+    }
+    m_tfields.push_back({0, IANA_FLOW_START_SEC, 4});
+    m_tfields.push_back({0, IANA_FLOW_END_SEC, 4});
+
+    for (const auto &tfield : m_tfields) {
+        rec_size += tfield.size;
+    }
+    m_rec_size = static_cast<uint16_t>(rec_size);
+
+    // Counters are aligned to 8 bytes (records of the table are allocated in multiples of 8)
+    m_key_size = (offset + 7U) & ~size_t(7U);
+    m_key.resize(m_key_size, 0);
+    const size_t value_size = (1 + m_values.size()) * sizeof(uint64_t);
+    m_table.reset(new fdsdump::aggregator::HashTable(m_key_size, value_size));
+
+    const size_t loc_size = (m_keys.size() + m_values.size()) * sizeof(location);
+    m_tcache.reset(ipx_tcache_create(loc_size, 0));
+    if (!m_tcache) {
+        throw std::bad_alloc();
+    }
+}
+
+/**
+ * @brief Create a description of a key field or an aggregated field
+ * @param[in] iemgr Manager of Information Elements
+ * @param[in] name  Name of the Information Element
+ * @return Description
+ * @throw runtime_error if the field is not known or its data type is not supported
+ */
+Aggregator::field
+Aggregator::field_create(const fds_iemgr_t *iemgr, const std::string &name)
+{
+    const fds_iemgr_elem *elem = fds_iemgr_elem_find_name(iemgr, name.c_str());
+    if (!elem) {
+        throw std::runtime_error("Unknown field '" + name + "'!");
+    }
+
+    field def;
+    def.pen = elem->scope->pen;
+    def.id = elem->id;
+    def.offset = 0;
+    def.fn = Config::func::SUM;
+
+    if (def.pen == 0 && (def.id == IANA_DELTA_FLOW_COUNT || def.id == IANA_FLOW_START_SEC
+            || def.id == IANA_FLOW_END_SEC)) {
+        throw std::runtime_error("Field '" + name + "' is always added to aggregated records!");
+    }
+
+    switch (elem->data_type) {
+    case FDS_ET_UNSIGNED_8:
+        def.type = vtype::UINT; def.size = 1; break;
+    case FDS_ET_UNSIGNED_16:
+        def.type = vtype::UINT; def.size = 2; break;
+    case FDS_ET_UNSIGNED_32:
+    case FDS_ET_DATE_TIME_SECONDS:
+        def.type = vtype::UINT; def.size = 4; break;
+    case FDS_ET_UNSIGNED_64:
+    case FDS_ET_DATE_TIME_MILLISECONDS:
+        def.type = vtype::UINT; def.size = 8; break;
+    case FDS_ET_SIGNED_8:
+        def.type = vtype::INT; def.size = 1; break;
+    case FDS_ET_SIGNED_16:
+        def.type = vtype::INT; def.size = 2; break;
+    case FDS_ET_SIGNED_32:
+        def.type = vtype::INT; def.size = 4; break;
+    case FDS_ET_SIGNED_64:
+        def.type = vtype::INT; def.size = 8; break;
+    case FDS_ET_BOOLEAN:
+        def.type = vtype::RAW; def.size = 1; break;
+    case FDS_ET_IPV4_ADDRESS:
+        def.type = vtype::RAW; def.size = 4; break;
+    case FDS_ET_MAC_ADDRESS:
+        def.type = vtype::RAW; def.size = 6; break;
+    case FDS_ET_IPV6_ADDRESS:
+        def.type = vtype::RAW; def.size = 16; break;
+    default:
+        throw std::runtime_error("Data type of field '" + name + "' is not supported (variable "
+            "length, floating point or NTP timestamp)!");
+    }
+
+    return def;
+}
+
+/**
+ * @brief Find position of a field in records of a Template
+ * @param[in] tmplt Template
+ * @param[in] def   Field
+ * @return Position
+ */
+Aggregator::location
+Aggregator::location_find(const struct fds_template *tmplt, const field &def)
+{
+    const struct fds_tfield *tfield = fds_template_cfind(tmplt, def.pen, def.id);
+    if (!tfield) {
+        return {OFFSET_MISSING, 0};
+    }
+
+    if (tfield->offset == FDS_IPFIX_VAR_IE_LEN || tfield->length == FDS_IPFIX_VAR_IE_LEN) {
+        return {OFFSET_FIND, 0};
+    }
+
+    return {tfield->offset, tfield->length};
+}
+
+/**
+ * @brief Get value of a field of a record
+ * @param[in]  rec  Data Record
+ * @param[in]  loc  Position of the field in the record
+ * @param[in]  def  Field
+ * @param[out] data Value
+ * @param[out] size Size of the value
+ * @return True if the field is present, false otherwise
+ */
+bool
+Aggregator::location_get(struct fds_drec &rec, const location &loc, const field &def,
+    const uint8_t *&data, uint16_t &size)
+{
+    if (loc.offset == OFFSET_MISSING) {
+        return false;
+    }
+
+    if (loc.offset != OFFSET_FIND) {
+        data = &rec.data[loc.offset];
+        size = loc.size;
+        return true;
+    }
+
+    struct fds_drec_field drec_field;
+    if (fds_drec_find(&rec, def.pen, def.id, &drec_field) == FDS_EOC) {
+        return false;
+    }
+
+    data = drec_field.data;
+    size = drec_field.size;
+    return true;
+}
+
+/**
+ * @brief Get positions of fields in records of a Template (cached)
+ * @param[in] tmplt Template
+ * @return Positions of key fields followed by positions of aggregated fields
+ * @throw bad_alloc in case of a memory allocation error
+ */
+const Aggregator::location *
+Aggregator::tcache_get(const struct fds_template *tmplt)
+{
+    auto *locs = static_cast<location *>(ipx_tcache_find(m_tcache.get(), tmplt));
+    if (locs) {
+        return locs;
+    }
+
+    locs = static_cast<location *>(ipx_tcache_add(m_tcache.get(), tmplt));
+    if (!locs) {
+        throw std::bad_alloc();
+    }
+
+    location *pos = locs;
+    for (const auto &def : m_keys) {
+        *pos++ = location_find(tmplt, def);
+    }
+    for (const auto &def : m_values) {
+        *pos++ = location_find(tmplt, def);
+    }
+
+    return locs;
+}
+
+/**
+ * @brief Initialize counters of a new aggregated record
+ * @param[out] values Counters (the number of records and aggregated fields)
+ */
+void
+Aggregator::values_init(uint64_t *values) const
+{
+    values[0] = 0;
+
+    for (size_t i = 0; i < m_values.size(); ++i) {
+        const field &def = m_values[i];
+        uint64_t &value = values[i + 1];
+
+        switch (def.fn) {
+        case Config::func::SUM:
+            value = 0;
+            break;
+        case Config::func::MIN:
+            value = (def.type == vtype::INT)
+                ? static_cast<uint64_t>(std::numeric_limits<int64_t>::max())
+                : std::numeric_limits<uint64_t>::max();
+            break;
+        case Config::func::MAX:
+            value = (def.type == vtype::INT)
+                ? static_cast<uint64_t>(std::numeric_limits<int64_t>::min())
+                : 0;
+            break;
+        }
+    }
+}
+
+void
+Aggregator::process_msg(ipx_msg_ipfix_t *msg)
+{
+    const uint32_t rec_cnt = ipx_msg_ipfix_get_drec_cnt(msg);
+    ipx_tcache_clear(m_tcache.get());
+
+    for (uint32_t i = 0; i < rec_cnt; ++i) {
+        struct fds_drec &rec = ipx_msg_ipfix_get_drec(msg, i)->rec;
+        if (rec.tmplt->type != FDS_TYPE_TEMPLATE) {
+            // Skip records based on Options Template
+            continue;
+        }
+
+        process_record(rec);
+    }
+}
+
+/**
+ * @brief Add a flow record to the aggregated record with the same key
+ *
+ * Key fields that are not present in the record are zeroed. Missing aggregated fields are
+ * ignored.
+ * @param[in] rec Data Record
+ */
+void
+Aggregator::process_record(struct fds_drec &rec)
+{
+    const location *locs = tcache_get(rec.tmplt);
+    uint8_t *key = m_key.data();
+    const uint8_t *data;
+    uint16_t size;
+
+    // Fill the key (integers are converted to full size, i.e. reduced-size encoding is removed)
+    memset(key, 0, m_key_size);
+    for (size_t i = 0; i < m_keys.size(); ++i) {
+        const field &def = m_keys[i];
+        if (!location_get(rec, locs[i], def, data, size)) {
+            continue;
+        }
+
+        uint8_t *dst = key + def.offset;
+        uint64_t val_uint;
+        int64_t val_int;
+
+        switch (def.type) {
+        case vtype::UINT:
+            if (fds_get_uint_be(data, size, &val_uint) == FDS_OK) {
+                fds_set_uint_be(dst, def.size, val_uint);
+            }
+            break;
+        case vtype::INT:
+            if (fds_get_int_be(data, size, &val_int) == FDS_OK) {
+                fds_set_int_be(dst, def.size, val_int);
+            }
+            break;
+        case vtype::RAW:
+            if (size == def.size) {
+                memcpy(dst, data, size);
+            }
+            break;
+        }
+    }
+
+    uint8_t *item;
+    if (!m_table->find_or_create(key, item)) {
+        values_init(reinterpret_cast<uint64_t *>(item + m_key_size));
+    }
+
+    // Merge values (as the aggregator of fdsdump)
+    uint64_t *values = reinterpret_cast<uint64_t *>(item + m_key_size);
+    values[0]++;
+
+    for (size_t i = 0; i < m_values.size(); ++i) {
+        const field &def = m_values[i];
+        uint64_t &value = values[i + 1];
+        if (!location_get(rec, locs[m_keys.size() + i], def, data, size)) {
+            continue;
+        }
+
+        if (def.type == vtype::UINT) {
+            uint64_t val;
+            if (fds_get_uint_be(data, size, &val) != FDS_OK) {
+                continue;
+            }
+
+            switch (def.fn) {
+            case Config::func::SUM:
+                value += val;
+                break;
+            case Config::func::MIN:
+                value = std::min(value, val);
+                break;
+            case Config::func::MAX:
+                value = std::max(value, val);
+                break;
+            }
+        } else {
+            int64_t val;
+            if (fds_get_int_be(data, size, &val) != FDS_OK) {
+                continue;
+            }
+
+            const int64_t current = static_cast<int64_t>(value);
+            switch (def.fn) {
+            case Config::func::SUM:
+                value = static_cast<uint64_t>(current + val);
+                break;
+            case Config::func::MIN:
+                value = static_cast<uint64_t>(std::min(current, val));
+                break;
+            case Config::func::MAX:
+                value = static_cast<uint64_t>(std::max(current, val));
+                break;
+            }
+        }
+    }
+}
+
+void
+Aggregator::record_write(const uint8_t *rec, uint32_t bin_start, uint32_t bin_end,
+    uint8_t *out) const
+{
+    const uint64_t *values = reinterpret_cast<const uint64_t *>(rec + m_key_size);
+    uint8_t *pos = out;
+
+    // Key fields
+    for (const auto &def : m_keys) {
+        memcpy(pos, rec + def.offset, def.size);
+        pos += def.size;
+    }
+
+    // Number of records
+    fds_set_uint_be(pos, 8, values[0]);
+    pos += 8;
+
+    // Aggregated fields (sums are saturated, min/max of fields not present in any record are 0)
+    for (size_t i = 0; i < m_values.size(); ++i) {
+        const field &def = m_values[i];
+        uint64_t value = values[i + 1];
+
+        if (def.type == vtype::UINT) {
+            if (def.fn == Config::func::MIN && value == std::numeric_limits<uint64_t>::max()) {
+                value = 0;
+            }
+            fds_set_uint_be(pos, def.size, value);
+        } else {
+            int64_t val_int = static_cast<int64_t>(value);
+            if ((def.fn == Config::func::MIN && val_int == std::numeric_limits<int64_t>::max())
+                    || (def.fn == Config::func::MAX
+                        && val_int == std::numeric_limits<int64_t>::min())) {
+                val_int = 0;
+            }
+            fds_set_int_be(pos, def.size, val_int);
+        }
+        pos += def.size;
+    }
+
+    // Time bin
+    fds_set_uint_be(pos, 4, bin_start);
+    pos += 4;
+    fds_set_uint_be(pos, 4, bin_end);
+}
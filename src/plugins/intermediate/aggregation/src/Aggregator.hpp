@@ -0,0 +1,146 @@
+/**
+ * \file src/plugins/intermediate/aggregation/src/Aggregator.hpp
+ * \author agent <agent@local>
+ * \brief Aggregation of flow records (header file)
+ * \date 2026
+ *
+ * Copyright(c) 2026 CESNET z.s.p.o.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef IPFIXCOL2_AGGREGATION_AGGREGATOR_HPP
+#define IPFIXCOL2_AGGREGATION_AGGREGATOR_HPP
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include <ipfixcol2.h>
+#include <libfds.h>
+
+#include "Config.hpp"
+#include "aggregator/hashTable.hpp"
+
+/**
+ * @brief Aggregator of flow records of a time bin
+ *
+ * Records with the same values of key fields are merged into one aggregated record, which
+ * consists of the key fields, number of merged records (deltaFlowCount), aggregated fields
+ * and boundaries of the time bin (flowStartSeconds, flowEndSeconds). Merge semantics are the
+ * same as of the aggregator of fdsdump (i.e. sum, min, max).
+ *
+ * Aggregated records are stored in a hash table. Each record of the table consists of the key
+ * (all key fields, each in its full size, padded to 8 bytes) followed by 64-bit counters (the
+ * number of records and values of aggregated fields).
+ */
+class Aggregator {
+public:
+    /// Field of aggregated records (i.e. of their Template)
+    struct tfield {
+        uint32_t pen;  ///< Private Enterprise Number
+        uint16_t id;   ///< Information Element ID
+        uint16_t size; ///< Size of the field
+    };
+
+    /**
+     * @brief Create an aggregator
+     * @param[in] cfg   Configuration of the plugin
+     * @param[in] iemgr Manager of Information Elements
+     * @throw runtime_error if a field is not known or its data type is not supported
+     * @throw bad_alloc in case of a memory allocation error
+     */
+    Aggregator(const Config &cfg, const fds_iemgr_t *iemgr);
+    ~Aggregator() = default;
+
+    /**
+     * @brief Add all flow records (based on Templates) of an IPFIX Message
+     * @param[in] msg IPFIX Message
+     */
+    void
+    process_msg(ipx_msg_ipfix_t *msg);
+
+    /// Get the number of aggregated records
+    size_t
+    count() { return m_table->items().size(); }
+    /// Get aggregated records
+    const std::vector<uint8_t *> &
+    records() { return m_table->items(); }
+    /// Remove all aggregated records (memory is reused)
+    void
+    clear() { m_table->retain(0); }
+
+    /// Get fields of aggregated records (in the order of record_write())
+    const std::vector<tfield> &
+    fields() const { return m_tfields; }
+    /// Get size of an aggregated record (see record_write())
+    uint16_t
+    record_size() const { return m_rec_size; }
+
+    /**
+     * @brief Write an aggregated record in the IPFIX format
+     * @param[in]  rec       Aggregated record (see records())
+     * @param[in]  bin_start Start of the time bin (seconds since UNIX epoch)
+     * @param[in]  bin_end   End of the time bin (seconds since UNIX epoch)
+     * @param[out] out       Output buffer (at least record_size() bytes)
+     */
+    void
+    record_write(const uint8_t *rec, uint32_t bin_start, uint32_t bin_end, uint8_t *out) const;
+
+private:
+    /// Type of the value of a field
+    enum class vtype {
+        UINT, ///< Unsigned integer (also date and time in seconds/milliseconds)
+        INT,  ///< Signed integer
+        RAW   ///< Other (fixed size) types
+    };
+
+    /// Key field or aggregated field
+    struct field {
+        uint32_t     pen;    ///< Private Enterprise Number
+        uint16_t     id;     ///< Information Element ID
+        uint16_t     size;   ///< Size of the field in aggregated records
+        uint16_t     offset; ///< Offset in the key (key fields only)
+        vtype        type;   ///< Type of the value
+        Config::func fn;     ///< Aggregation function (aggregated fields only)
+    };
+
+    /// Position of a field in records of a Template
+    struct location {
+        uint16_t offset; ///< Offset of the field in a record (FIND, MISSING or a real offset)
+        uint16_t size;   ///< Size of the field in a record
+    };
+
+
+    /// Key fields
+    std::vector<field> m_keys;
+    /// Aggregated fields
+    std::vector<field> m_values;
+    /// Fields of aggregated records
+    std::vector<tfield> m_tfields;
+    /// Size of the key (padded)
+    size_t m_key_size;
+    /// Size of an aggregated record in the IPFIX format
+    uint16_t m_rec_size;
+    /// Key of the processed record
+    std::vector<uint8_t> m_key;
+    /// Positions of key fields followed by aggregated fields in Templates of the processed message
+    std::unique_ptr<ipx_tcache_t, decltype(&ipx_tcache_destroy)> m_tcache;
+    /// Table of aggregated records
+    std::unique_ptr<fdsdump::aggregator::HashTable> m_table;
+
+    static field
+    field_create(const fds_iemgr_t *iemgr, const std::string &name);
+    static location
+    location_find(const struct fds_template *tmplt, const field &def);
+    static bool
+    location_get(struct fds_drec &rec, const location &loc, const field &def,
+        const uint8_t *&data, uint16_t &size);
+
+    const location *
+    tcache_get(const struct fds_template *tmplt);
+    void
+    process_record(struct fds_drec &rec);
+    void
+    values_init(uint64_t *values) const;
+};
+
+#endif // IPFIXCOL2_AGGREGATION_AGGREGATOR_HPP
@@ -0,0 +1,242 @@
+/**
+ * \file src/plugins/intermediate/aggregation/src/Config.cpp
+ * \author agent <agent@local>
+ * \brief Parser of XML configuration (source file)
+ * \date 2026
+ *
+ * Copyright(c) 2026 CESNET z.s.p.o.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include "Config.hpp"
+#include <cassert>
+#include <memory>
+#include <stdexcept>
+
+/*
+ * <params>
+ *   <interval>...</interval>            <!-- optional -->
+ *   <odid>...</odid>                    <!-- optional -->
+ *   <keepOriginal>...</keepOriginal>    <!-- optional -->
+ *   <maxKeys>...</maxKeys>              <!-- optional -->
+ *   <key>
+ *     <field>...</field>                <!-- multiple -->
+ *   </key>
+ *   <values>                            <!-- optional -->
+ *     <sum>...</sum>                    <!-- optional, multiple -->
+ *     <min>...</min>                    <!-- optional, multiple -->
+ *     <max>...</max>                    <!-- optional, multiple -->
+ *   </values>
+ * </params>
+ */
+
+/// XML nodes
+enum params_xml_nodes {
+    NODE_INTERVAL = 1,
+    NODE_ODID,
+    NODE_KEEP,
+    NODE_MAX_KEYS,
+    NODE_KEY,
+    NODE_VALUES,
+
+    KEY_FIELD,
+
+    VALUES_SUM,
+    VALUES_MIN,
+    VALUES_MAX
+};
+
+/// Definition of the \<key\> node
+static const struct fds_xml_args args_key[] = {
+    FDS_OPTS_ELEM(KEY_FIELD,     "field",        FDS_OPTS_T_STRING, FDS_OPTS_P_MULTI),
+    FDS_OPTS_END
+};
+
+/// Definition of the \<values\> node
+static const struct fds_xml_args args_values[] = {
+    FDS_OPTS_ELEM(VALUES_SUM,    "sum",          FDS_OPTS_T_STRING, FDS_OPTS_P_OPT | FDS_OPTS_P_MULTI),
+    FDS_OPTS_ELEM(VALUES_MIN,    "min",          FDS_OPTS_T_STRING, FDS_OPTS_P_OPT | FDS_OPTS_P_MULTI),
+    FDS_OPTS_ELEM(VALUES_MAX,    "max",          FDS_OPTS_T_STRING, FDS_OPTS_P_OPT | FDS_OPTS_P_MULTI),
+    FDS_OPTS_END
+};
+
+/// Definition of the \<params\> node
+static const struct fds_xml_args args_params[] = {
+    FDS_OPTS_ROOT("params"),
+    FDS_OPTS_ELEM(NODE_INTERVAL, "interval",     FDS_OPTS_T_UINT,   FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM(NODE_ODID,     "odid",         FDS_OPTS_T_UINT,   FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM(NODE_KEEP,     "keepOriginal", FDS_OPTS_T_BOOL,   FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM(NODE_MAX_KEYS, "maxKeys",      FDS_OPTS_T_UINT,   FDS_OPTS_P_OPT),
+    FDS_OPTS_NESTED(NODE_KEY,    "key",          args_key,          0),
+    FDS_OPTS_NESTED(NODE_VALUES, "values",       args_values,       FDS_OPTS_P_OPT),
+    FDS_OPTS_END
+};
+
+Config::Config(const char *params)
+{
+    set_default();
+
+    // Create XML parser
+    std::unique_ptr<fds_xml_t, decltype(&fds_xml_destroy)> xml(fds_xml_create(), &fds_xml_destroy);
+    if (!xml) {
+        throw std::runtime_error("Failed to create an XML parser!");
+    }
+
+    if (fds_xml_set_args(xml.get(), args_params) != FDS_OK) {
+        throw std::runtime_error("Failed to parse the description of an XML document!");
+    }
+
+    fds_xml_ctx_t *params_ctx = fds_xml_parse_mem(xml.get(), params, true);
+    if (!params_ctx) {
+        std::string err = fds_xml_last_err(xml.get());
+        throw std::runtime_error("Failed to parse the configuration: " + err);
+    }
+
+    // Parse parameters and check configuration
+    try {
+        parse_root(params_ctx);
+        validate();
+    } catch (std::exception &ex) {
+        throw std::runtime_error("Failed to parse the configuration: " + std::string(ex.what()));
+    }
+}
+
+/**
+ * @brief Set default parameters
+ */
+void
+Config::set_default()
+{
+    m_interval = INTERVAL_DEF;
+    m_odid = 0;
+    m_keep_original = false;
+    m_max_keys = 0;
+    m_keys.clear();
+    m_values.clear();
+}
+
+/**
+ * @brief Check if the configuration is valid
+ * @throw runtime_error if the configuration breaks some rules
+ */
+void
+Config::validate()
+{
+    if (m_interval == 0) {
+        throw std::runtime_error("Interval must be greater than zero!");
+    }
+
+    if (m_keys.empty()) {
+        throw std::runtime_error("At least one key field must be specified!");
+    }
+
+    if (m_values.empty()) {
+        // By default, sum bytes and packets
+        m_values.push_back({func::SUM, "iana:octetDeltaCount"});
+        m_values.push_back({func::SUM, "iana:packetDeltaCount"});
+    }
+
+    if (m_keys.size() > FIELDS_MAX || m_values.size() > FIELDS_MAX) {
+        throw std::runtime_error("Too many key or aggregated fields (max. "
+            + std::to_string(FIELDS_MAX) + " of each)!");
+    }
+}
+
+/**
+ * @brief Process \<params\> node
+ * @param[in] ctx XML context to process
+ * @throw runtime_error if the parser fails
+ */
+void
+Config::parse_root(fds_xml_ctx_t *ctx)
+{
+    const struct fds_xml_cont *content;
+    while (fds_xml_next(ctx, &content) != FDS_EOC) {
+        switch (content->id) {
+        case NODE_INTERVAL:
+            assert(content->type == FDS_OPTS_T_UINT);
+            if (content->val_uint > UINT32_MAX) {
+                throw std::runtime_error("Interval is too long!");
+            }
+            m_interval = static_cast<uint32_t>(content->val_uint);
+            break;
+        case NODE_ODID:
+            assert(content->type == FDS_OPTS_T_UINT);
+            if (content->val_uint > UINT32_MAX) {
+                throw std::runtime_error("ODID must be between 0 and " + std::to_string(UINT32_MAX)
+                    + "!");
+            }
+            m_odid = static_cast<uint32_t>(content->val_uint);
+            break;
+        case NODE_KEEP:
+            assert(content->type == FDS_OPTS_T_BOOL);
+            m_keep_original = content->val_bool;
+            break;
+        case NODE_MAX_KEYS:
+            assert(content->type == FDS_OPTS_T_UINT);
+            m_max_keys = content->val_uint;
+            break;
+        case NODE_KEY:
+            assert(content->type == FDS_OPTS_T_CONTEXT);
+            parse_key(content->ptr_ctx);
+            break;
+        case NODE_VALUES:
+            assert(content->type == FDS_OPTS_T_CONTEXT);
+            parse_values(content->ptr_ctx);
+            break;
+        default:
+            // Internal error
+            throw std::runtime_error("Unknown XML node");
+        }
+    }
+}
+
+/**
+ * @brief Auxiliary function for parsing \<key\> options
+ * @param[in] ctx XML context to process
+ * @throw runtime_error if the parser fails
+ */
+void
+Config::parse_key(fds_xml_ctx_t *ctx)
+{
+    const struct fds_xml_cont *content;
+    while (fds_xml_next(ctx, &content) != FDS_EOC) {
+        switch (content->id) {
+        case KEY_FIELD:
+            assert(content->type == FDS_OPTS_T_STRING);
+            m_keys.emplace_back(content->ptr_string);
+            break;
+        default:
+            // Internal error
+            throw std::runtime_error("Unknown XML node");
+        }
+    }
+}
+
+/**
+ * @brief Auxiliary function for parsing \<values\> options
+ * @param[in] ctx XML context to process
+ * @throw runtime_error if the parser fails
+ */
+void
+Config::parse_values(fds_xml_ctx_t *ctx)
+{
+    const struct fds_xml_cont *content;
+    while (fds_xml_next(ctx, &content) != FDS_EOC) {
+        assert(content->type == FDS_OPTS_T_STRING);
+        switch (content->id) {
+        case VALUES_SUM:
+            m_values.push_back({func::SUM, content->ptr_string});
+            break;
+        case VALUES_MIN:
+            m_values.push_back({func::MIN, content->ptr_string});
+            break;
+        case VALUES_MAX:
+            m_values.push_back({func::MAX, content->ptr_string});
+            break;
+        default:
+            // Internal error
+            throw std::runtime_error("Unknown XML node");
+        }
+    }
+}
@@ -0,0 +1,77 @@
+/**
+ * \file src/plugins/intermediate/aggregation/src/Config.hpp
+ * \author agent <agent@local>
+ * \brief Parser of XML configuration (header file)
+ * \date 2026
+ *
+ * Copyright(c) 2026 CESNET z.s.p.o.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef IPFIXCOL2_AGGREGATION_CONFIG_HPP
+#define IPFIXCOL2_AGGREGATION_CONFIG_HPP
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <libfds.h>
+
+/**
+ * @brief Plugin configuration parser
+ */
+class Config {
+public:
+    /**
+     * @brief Parse configuration of the plugin
+     * @param[in] params XML parameters to parse
+     * @throw runtime_exception on error
+     */
+    Config(const char *params);
+    ~Config() = default;
+
+    /// Aggregation function
+    enum class func {
+        SUM, ///< Sum of values
+        MIN, ///< Minimal value
+        MAX  ///< Maximal value
+    };
+
+    /// Aggregated field
+    struct value {
+        func        fn;   ///< Aggregation function
+        std::string name; ///< Name of the Information Element
+    };
+
+    /// Size of time bins (in seconds)
+    uint32_t m_interval;
+    /// Observation Domain ID of aggregated records
+    uint32_t m_odid;
+    /// Pass the original IPFIX Messages too
+    bool m_keep_original;
+    /// Maximum number of keys held in memory (0 = unlimited)
+    uint64_t m_max_keys;
+    /// Names of Information Elements of the key
+    std::vector<std::string> m_keys;
+    /// Aggregated fields
+    std::vector<value> m_values;
+
+private:
+    /// Default size of time bins
+    static const uint32_t INTERVAL_DEF = 60U;
+    /// Maximum number of key fields and aggregated fields
+    static const size_t FIELDS_MAX = 64U;
+
+    void
+    set_default();
+    void
+    validate();
+
+    void
+    parse_root(fds_xml_ctx_t *ctx);
+    void
+    parse_key(fds_xml_ctx_t *ctx);
+    void
+    parse_values(fds_xml_ctx_t *ctx);
+};
+
+#endif // IPFIXCOL2_AGGREGATION_CONFIG_HPP
@@ -0,0 +1,249 @@
+/**
+ * \file src/plugins/intermediate/aggregation/src/Exporter.cpp
+ * \author agent <agent@local>
+ * \brief Exporter of aggregated records (source file)
+ * \date 2026
+ *
+ * Copyright(c) 2026 CESNET z.s.p.o.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include "Exporter.hpp"
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <arpa/inet.h>
+
+/// Maximum size of an IPFIX Message
+static const size_t MSG_MAX_SIZE = UINT16_MAX;
+
+Exporter::Exporter(ipx_ctx_t *ctx, const Aggregator &aggr, uint32_t odid)
+    : m_ctx(ctx), m_session(nullptr), m_tmgr(nullptr), m_snap(nullptr),
+      m_rec_size(aggr.record_size()), m_odid(odid), m_seq_num(0), m_opened(false)
+{
+    // Identification of the Transport Session (shown by outputs, e.g. in file names)
+    const std::string name = std::string("aggregation:") + ipx_ctx_name_get(ctx);
+    m_session = ipx_session_new_file(name.c_str());
+    if (!m_session) {
+        throw std::runtime_error("Failed to create a Transport Session!");
+    }
+
+    try {
+        tmplt_create(aggr);
+    } catch (...) {
+        if (m_tmgr) {
+            fds_tmgr_destroy(m_tmgr);
+        }
+        ipx_session_destroy(m_session);
+        throw;
+    }
+}
+
+Exporter::~Exporter()
+{
+    if (m_opened) {
+        // Other plugins might still use them, see close()
+        return;
+    }
+
+    fds_tmgr_destroy(m_tmgr);
+    ipx_session_destroy(m_session);
+}
+
+/**
+ * @brief Create the Template of aggregated records and a Template manager with it
+ * @param[in] aggr Aggregator
+ * @throw runtime_error on failure
+ */
+void
+Exporter::tmplt_create(const Aggregator &aggr)
+{
+    const auto &fields = aggr.fields();
+
+    // Template Set with one Template
+    m_tset.resize(FDS_IPFIX_SET_HDR_LEN + 4U);
+    for (const auto &field : fields) {
+        const uint16_t id = htons(field.id | ((field.pen != 0) ? 0x8000U : 0U));
+        const uint16_t len = htons(field.size);
+        const uint8_t *id_ptr = reinterpret_cast<const uint8_t *>(&id);
+        const uint8_t *len_ptr = reinterpret_cast<const uint8_t *>(&len);
+        m_tset.insert(m_tset.end(), id_ptr, id_ptr + 2);
+        m_tset.insert(m_tset.end(), len_ptr, len_ptr + 2);
+
+        if (field.pen != 0) {
+            const uint32_t pen = htonl(field.pen);
+            const uint8_t *pen_ptr = reinterpret_cast<const uint8_t *>(&pen);
+            m_tset.insert(m_tset.end(), pen_ptr, pen_ptr + 4);
+        }
+    }
+
+    auto *set_hdr = reinterpret_cast<struct fds_ipfix_set_hdr *>(m_tset.data());
+    set_hdr->flowset_id = htons(FDS_IPFIX_SET_TMPLT);
+    set_hdr->length = htons(static_cast<uint16_t>(m_tset.size()));
+    auto *trec = reinterpret_cast<struct fds_ipfix_trec *>(m_tset.data() + FDS_IPFIX_SET_HDR_LEN);
+    trec->template_id = htons(TMPLT_ID);
+    trec->count = htons(static_cast<uint16_t>(fields.size()));
+
+    // Template manager (Information Elements are defined by the manager)
+    m_tmgr = fds_tmgr_create(FDS_SESSION_FILE);
+    if (!m_tmgr) {
+        throw std::runtime_error("Failed to create a Template manager!");
+    }
+
+    struct fds_template *tmplt;
+    uint16_t tmplt_len = static_cast<uint16_t>(m_tset.size() - FDS_IPFIX_SET_HDR_LEN);
+    if (fds_tmgr_set_iemgr(m_tmgr, ipx_ctx_iemgr_get(m_ctx)) != FDS_OK
+            || fds_tmgr_set_time(m_tmgr, 0) != FDS_OK
+            || fds_template_parse(FDS_TYPE_TEMPLATE, trec, &tmplt_len, &tmplt) != FDS_OK) {
+        throw std::runtime_error("Failed to create the Template of aggregated records!");
+    }
+
+    if (fds_tmgr_template_add(m_tmgr, tmplt) != FDS_OK) {
+        fds_template_destroy(tmplt);
+        throw std::runtime_error("Failed to add the Template of aggregated records!");
+    }
+
+    if (fds_tmgr_snapshot_get(m_tmgr, &m_snap) != FDS_OK
+            || fds_tsnapshot_template_get(m_snap, TMPLT_ID) == nullptr) {
+        throw std::runtime_error("Failed to get a Template snapshot!");
+    }
+}
+
+/**
+ * @brief Create an IPFIX Message with aggregated records
+ * @param[in] aggr      Aggregator
+ * @param[in] idx       Index of the first record (see Aggregator::records())
+ * @param[in] cnt       Number of records
+ * @param[in] tset      Add the Template Set
+ * @param[in] bin_start Start of the time bin
+ * @param[in] bin_end   End of the time bin (also Export Time of the message)
+ * @return IPFIX Message (with references to its Sets and Data Records)
+ * @throw bad_alloc in case of a memory allocation error
+ */
+ipx_msg_ipfix_t *
+Exporter::msg_create(Aggregator &aggr, size_t idx, size_t cnt, bool tset, uint32_t bin_start,
+    uint32_t bin_end)
+{
+    const size_t tset_size = tset ? m_tset.size() : 0;
+    const size_t dset_size = FDS_IPFIX_SET_HDR_LEN + cnt * m_rec_size;
+    const size_t msg_size = FDS_IPFIX_MSG_HDR_LEN + tset_size + dset_size;
+    assert(msg_size <= MSG_MAX_SIZE);
+
+    uint8_t *buffer = static_cast<uint8_t *>(ipx_utils_buf_alloc(msg_size));
+    if (!buffer) {
+        throw std::bad_alloc();
+    }
+
+    // Message header
+    auto *hdr = reinterpret_cast<struct fds_ipfix_msg_hdr *>(buffer);
+    hdr->version = htons(FDS_IPFIX_VERSION);
+    hdr->length = htons(static_cast<uint16_t>(msg_size));
+    hdr->export_time = htonl(bin_end);
+    hdr->seq_num = htonl(m_seq_num);
+    hdr->odid = htonl(m_odid);
+
+    uint8_t *pos = buffer + FDS_IPFIX_MSG_HDR_LEN;
+    if (tset) {
+        memcpy(pos, m_tset.data(), tset_size);
+        pos += tset_size;
+    }
+
+    auto *dset_hdr = reinterpret_cast<struct fds_ipfix_set_hdr *>(pos);
+    dset_hdr->flowset_id = htons(TMPLT_ID);
+    dset_hdr->length = htons(static_cast<uint16_t>(dset_size));
+    pos += FDS_IPFIX_SET_HDR_LEN;
+
+    const auto &recs = aggr.records();
+    for (size_t i = 0; i < cnt; ++i) {
+        aggr.record_write(recs[idx + i], bin_start, bin_end, pos + i * m_rec_size);
+    }
+
+    // Wrap the message and describe its content
+    struct ipx_msg_ctx msg_ctx;
+    memset(&msg_ctx, 0, sizeof(msg_ctx));
+    msg_ctx.session = m_session;
+    msg_ctx.odid = m_odid;
+    msg_ctx.stream = 0;
+
+    ipx_msg_ipfix_t *msg = ipx_msg_ipfix_wrap(m_ctx, &msg_ctx, buffer, m_snap);
+    if (!msg) {
+        ipx_utils_buf_free(buffer);
+        throw std::bad_alloc();
+    }
+
+    // The Template never changes
+    ipx_msg_ipfix_get_ctx(msg)->snap_gen = 1;
+
+    m_seq_num += static_cast<uint32_t>(cnt);
+    return msg;
+}
+
+void
+Exporter::send(Aggregator &aggr, uint32_t bin_start, uint32_t bin_end)
+{
+    const size_t rec_total = aggr.count();
+    if (rec_total == 0) {
+        return;
+    }
+
+    if (!m_opened) {
+        // Inform other plugins about the new Transport Session
+        ipx_msg_session_t *msg = ipx_msg_session_create(m_session, IPX_MSG_SESSION_OPEN);
+        if (!msg) {
+            throw std::bad_alloc();
+        }
+        ipx_ctx_msg_pass(m_ctx, ipx_msg_session2base(msg));
+        m_opened = true;
+    }
+
+    // The Template is refreshed in the first message of each time bin
+    const size_t space = MSG_MAX_SIZE - FDS_IPFIX_MSG_HDR_LEN - FDS_IPFIX_SET_HDR_LEN;
+    size_t idx = 0;
+    bool tset = true;
+
+    while (idx < rec_total) {
+        const size_t rec_max = (space - (tset ? m_tset.size() : 0)) / m_rec_size;
+        const size_t cnt = std::min(rec_total - idx, rec_max);
+
+        ipx_msg_ipfix_t *msg = msg_create(aggr, idx, cnt, tset, bin_start, bin_end);
+        ipx_ctx_msg_pass(m_ctx, ipx_msg_ipfix2base(msg));
+        idx += cnt;
+        tset = false;
+    }
+}
+
+void
+Exporter::close()
+{
+    if (!m_opened) {
+        return;
+    }
+
+    // Inform other plugins that the Transport Session is closed
+    ipx_msg_session_t *close_event = ipx_msg_session_create(m_session, IPX_MSG_SESSION_CLOSE);
+    if (close_event) {
+        ipx_ctx_msg_pass(m_ctx, ipx_msg_session2base(close_event));
+    }
+
+    /* The session and the Template cannot be freed because other plugins still have access to
+     * them. Send them as garbage messages after the Transport Session close event.
+     */
+    ipx_msg_garbage_cb session_cb = (ipx_msg_garbage_cb) &ipx_session_destroy;
+    ipx_msg_garbage_cb tmgr_cb = (ipx_msg_garbage_cb) &fds_tmgr_destroy;
+    ipx_msg_garbage_t *session_garbage = ipx_msg_garbage_create(m_session, session_cb);
+    ipx_msg_garbage_t *tmgr_garbage = ipx_msg_garbage_create(m_tmgr, tmgr_cb);
+
+    // If a garbage message cannot be created, its object is leaked (others might still use it)
+    if (session_garbage) {
+        ipx_ctx_msg_pass(m_ctx, ipx_msg_garbage2base(session_garbage));
+    }
+    if (tmgr_garbage) {
+        ipx_ctx_msg_pass(m_ctx, ipx_msg_garbage2base(tmgr_garbage));
+    }
+    if (!session_garbage || !tmgr_garbage) {
+        IPX_CTX_ERROR(m_ctx, "Memory allocation error (%s:%d)", __FILE__, __LINE__);
+    }
+}
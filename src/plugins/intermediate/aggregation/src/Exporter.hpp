@@ -0,0 +1,100 @@
+/**
+ * \file src/plugins/intermediate/aggregation/src/Exporter.hpp
+ * \author agent <agent@local>
+ * \brief Exporter of aggregated records (header file)
+ * \date 2026
+ *
+ * Copyright(c) 2026 CESNET z.s.p.o.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef IPFIXCOL2_AGGREGATION_EXPORTER_HPP
+#define IPFIXCOL2_AGGREGATION_EXPORTER_HPP
+
+#include <cstdint>
+#include <vector>
+#include <ipfixcol2.h>
+#include <libfds.h>
+
+#include "Aggregator.hpp"
+
+/**
+ * @brief Exporter of aggregated records
+ *
+ * Aggregated records are passed to the next plugins as IPFIX Messages of a Transport Session
+ * of the exporter (i.e. not of any real exporter), so (Options) Templates of real exporters
+ * cannot collide with the Template of aggregated records. Messages are already parsed, i.e.
+ * references to their Sets and Data Records are filled as if they were processed by the parser.
+ */
+class Exporter {
+public:
+    /**
+     * @brief Create an exporter
+     *
+     * The Transport Session is opened when the first records are exported.
+     * @param[in] ctx   Plugin context
+     * @param[in] aggr  Aggregator (defines the Template of records)
+     * @param[in] odid  Observation Domain ID of IPFIX Messages
+     * @throw runtime_error if the Template or the Transport Session cannot be created
+     */
+    Exporter(ipx_ctx_t *ctx, const Aggregator &aggr, uint32_t odid);
+    /**
+     * @brief Destroy the exporter
+     * @note If the Transport Session is open, close() must be called before.
+     */
+    ~Exporter();
+
+    // Disable copy constructors
+    Exporter(const Exporter &other) = delete;
+    Exporter &operator=(const Exporter &other) = delete;
+
+    /**
+     * @brief Pass all aggregated records to the next plugins
+     * @param[in] aggr      Aggregator
+     * @param[in] bin_start Start of the time bin (seconds since UNIX epoch)
+     * @param[in] bin_end   End of the time bin (seconds since UNIX epoch)
+     * @throw bad_alloc in case of a memory allocation error
+     */
+    void
+    send(Aggregator &aggr, uint32_t bin_start, uint32_t bin_end);
+
+    /**
+     * @brief Close the Transport Session
+     *
+     * Other plugins are informed that the Transport Session has been closed and the session
+     * and the Template are passed as garbage.
+     */
+    void
+    close();
+
+private:
+    /// ID of the Template of aggregated records
+    static const uint16_t TMPLT_ID = 256;
+
+    /// Plugin context
+    ipx_ctx_t *m_ctx;
+    /// Transport Session of aggregated records
+    struct ipx_session *m_session;
+    /// Template manager of the Transport Session
+    fds_tmgr_t *m_tmgr;
+    /// Template snapshot (with the only Template)
+    const fds_tsnapshot_t *m_snap;
+    /// Template Set with the Template (sent in the first message of each time bin)
+    std::vector<uint8_t> m_tset;
+    /// Size of an aggregated record
+    uint16_t m_rec_size;
+    /// Observation Domain ID
+    uint32_t m_odid;
+    /// Sequence number (i.e. total number of exported Data Records)
+    uint32_t m_seq_num;
+    /// The Transport Session has been opened
+    bool m_opened;
+
+    void
+    tmplt_create(const Aggregator &aggr);
+    ipx_msg_ipfix_t *
+    msg_create(Aggregator &aggr, size_t idx, size_t cnt, bool tset, uint32_t bin_start,
+        uint32_t bin_end);
+};
+
+#endif // IPFIXCOL2_AGGREGATION_EXPORTER_HPP
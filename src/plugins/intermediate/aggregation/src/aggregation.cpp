@@ -0,0 +1,150 @@
+/**
+ * \file src/plugins/intermediate/aggregation/src/aggregation.cpp
+ * \author agent <agent@local>
+ * \brief Aggregation of flow records (intermediate plugin)
+ * \date 2026
+ *
+ * Copyright(c) 2026 CESNET z.s.p.o.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include <cinttypes>
+#include <memory>
+#include <stdexcept>
+#include <arpa/inet.h>
+#include <ipfixcol2.h>
+
+#include "Aggregator.hpp"
+#include "Config.hpp"
+#include "Exporter.hpp"
+
+/// Plugin description
+IPX_API struct ipx_plugin_info ipx_plugin_info = {
+    // Plugin identification name
+    "aggregation",
+    // Brief description of plugin
+    "Aggregation of flow records over time bins",
+    // Plugin type
+    IPX_PT_INTERMEDIATE,
+    // Configuration flags (reserved for future use)
+    0,
+    // Plugin version string (like "1.2.3")
+    "2.0.0",
+    // Minimal IPFIXcol version string (like "1.2.3")
+    "2.0.0"
+};
+
+/// Instance
+struct Instance {
+    /// Parsed configuration
+    std::unique_ptr<Config> config_ptr = nullptr;
+    /// Aggregated records of the current time bin
+    std::unique_ptr<Aggregator> aggr_ptr = nullptr;
+    /// Exporter of aggregated records
+    std::unique_ptr<Exporter> exporter_ptr = nullptr;
+    /// Start of the current time bin (valid only if bin_valid is true)
+    uint32_t bin_start = 0;
+    /// The current time bin has been started
+    bool bin_valid = false;
+
+    /// Number of processed flow records
+    uint64_t recs_in = 0;
+    /// Number of aggregated records
+    uint64_t recs_out = 0;
+};
+
+/**
+ * @brief Pass all aggregated records of the current time bin and remove them
+ * @param[in] inst Instance
+ */
+static void
+bin_flush(struct Instance &inst)
+{
+    const uint32_t bin_end = inst.bin_start + inst.config_ptr->m_interval;
+    inst.recs_out += inst.aggr_ptr->count();
+    inst.exporter_ptr->send(*inst.aggr_ptr, inst.bin_start, bin_end);
+    inst.aggr_ptr->clear();
+}
+
+int
+ipx_plugin_init(ipx_ctx_t *ctx, const char *params)
+{
+    try {
+        std::unique_ptr<Instance> instance(new Instance);
+        instance->config_ptr.reset(new Config(params));
+        instance->aggr_ptr.reset(new Aggregator(*instance->config_ptr, ipx_ctx_iemgr_get(ctx)));
+        instance->exporter_ptr.reset(new Exporter(ctx, *instance->aggr_ptr,
+            instance->config_ptr->m_odid));
+        ipx_ctx_private_set(ctx, instance.release());
+    } catch (const std::exception &ex) {
+        IPX_CTX_ERROR(ctx, "Initialization failed: %s", ex.what());
+        return IPX_ERR_DENIED;
+    } catch (...) {
+        IPX_CTX_ERROR(ctx, "Unknown error has occurred!", '\0');
+        return IPX_ERR_DENIED;
+    }
+
+    return IPX_OK;
+}
+
+void
+ipx_plugin_destroy(ipx_ctx_t *ctx, void *cfg)
+{
+    auto inst = reinterpret_cast<Instance *>(cfg);
+
+    try {
+        // Pass records of the last time bin
+        if (inst->bin_valid) {
+            bin_flush(*inst);
+        }
+    } catch (const std::exception &ex) {
+        IPX_CTX_ERROR(ctx, "Failed to pass records of the last time bin: %s", ex.what());
+    }
+
+    inst->exporter_ptr->close();
+    IPX_CTX_INFO(ctx, "Aggregated %" PRIu64 " flow records into %" PRIu64 " records",
+        inst->recs_in, inst->recs_out);
+    delete inst;
+}
+
+int
+ipx_plugin_process(ipx_ctx_t *ctx, void *cfg, ipx_msg_t *msg)
+{
+    auto inst = reinterpret_cast<Instance *>(cfg);
+    const Config &config = *inst->config_ptr;
+    ipx_msg_ipfix_t *msg_ipfix = ipx_msg_base2ipfix(msg);
+
+    try {
+        // Time bin of the message is given by its Export Time
+        const auto *hdr = reinterpret_cast<fds_ipfix_msg_hdr *>(ipx_msg_ipfix_get_packet(msg_ipfix));
+        const uint32_t exp_time = ntohl(hdr->export_time);
+        const uint32_t bin = exp_time - (exp_time % config.m_interval);
+
+        if (!inst->bin_valid) {
+            inst->bin_start = bin;
+            inst->bin_valid = true;
+        } else if (bin > inst->bin_start) {
+            // A new time bin (late records of older bins are added to the current one)
+            bin_flush(*inst);
+            inst->bin_start = bin;
+        }
+
+        inst->recs_in += ipx_msg_ipfix_get_drec_cnt(msg_ipfix);
+        inst->aggr_ptr->process_msg(msg_ipfix);
+
+        if (config.m_max_keys != 0 && inst->aggr_ptr->count() >= config.m_max_keys) {
+            // Too many keys, pass the records early
+            bin_flush(*inst);
+        }
+    } catch (const std::exception &ex) {
+        IPX_CTX_ERROR(ctx, "Failed to aggregate records: %s", ex.what());
+    }
+
+    if (config.m_keep_original) {
+        ipx_ctx_msg_pass(ctx, msg);
+    } else {
+        ipx_msg_ipfix_destroy(msg_ipfix);
+    }
+
+    return IPX_OK;
+}
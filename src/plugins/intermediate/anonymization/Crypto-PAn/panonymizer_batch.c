@@ -0,0 +1,543 @@
+/**
+ * \file src/plugins/intermediate/anonymization/Crypto-PAn/panonymizer_batch.c
+ * \author agent <agent@local>
+ * \brief Crypto-PAn anonymization of batches of addresses accelerated by AES-NI
+ * \date 2026
+ */
+
+/* Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is'', and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include "panonymizer_batch.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <wmmintrin.h> // AES-NI
+#include <emmintrin.h> // SSE2
+
+/** Number of AES blocks encrypted at once (hides latency of AES-NI instructions) */
+#define PIPE_BLOCKS (8)
+
+/** Number of records in a set of the prefix cache                                     */
+#define CACHE_WAYS  (4U)
+/** Length of a cached IPv4 prefix (in bits)                                            */
+#define PREFIX_V4   (24)
+/** Length of a cached IPv6 prefix (in bits)                                            */
+#define PREFIX_V6   (64)
+
+/** Cached one-time pad of an IPv4 prefix */
+struct cache_v4_rec {
+    /** Prefix (the most significant bits of the address in host byte order)          */
+    uint32_t prefix;
+    /** Bits of the one-time pad that depend only on the prefix                        */
+    uint32_t otp;
+    /** Frequency of usage (used for replacement)                                      */
+    uint16_t freq;
+    /** The record is valid                                                            */
+    bool valid;
+};
+
+/** Cached one-time pad of an IPv6 prefix */
+struct cache_v6_rec {
+    /** Prefix (the first 8 bytes of the address)                                      */
+    uint64_t prefix;
+    /** Bits of the one-time pad that depend only on the prefix (the first 8 bytes)    */
+    uint64_t otp;
+    /** Frequency of usage (used for replacement)                                      */
+    uint16_t freq;
+    /** The record is valid                                                            */
+    bool valid;
+};
+
+/** Batch anonymizer */
+struct panon_batch {
+    /** Expanded AES-128 key (round keys)                                           */
+    __m128i round_keys[11];
+    /** Encrypted pad                                                               */
+    __m128i pad;
+    /** Encrypted pad (the first 4 bytes as a host byte order integer)             */
+    uint32_t pad_v4;
+    /** Masks of bits of an IPv6 address used in the input block of each position  */
+    __m128i v6_mask[128];
+    /** Bits of the pad used in the input block of each position                    */
+    __m128i v6_pad[128];
+
+    /** Prefix cache (set-associative, NULL if disabled)                            */
+    struct cache_v4_rec *cache_v4;
+    /** Prefix cache (set-associative, NULL if disabled)                            */
+    struct cache_v6_rec *cache_v6;
+    /** Mask of the index of a set in the cache (number of sets - 1)                */
+    uint32_t cache_mask;
+    /** Statistics of the cache                                                     */
+    struct panon_batch_stats stats;
+};
+
+/** Single step of AES-128 key expansion */
+#define KEY_EXP(prev, rcon) \
+    key_exp_step((prev), _mm_aeskeygenassist_si128((prev), (rcon)))
+
+__attribute__((target("aes,sse2")))
+static inline __m128i
+key_exp_step(__m128i key, __m128i gen)
+{
+    gen = _mm_shuffle_epi32(gen, 0xFF);
+    key = _mm_xor_si128(key, _mm_slli_si128(key, 4));
+    key = _mm_xor_si128(key, _mm_slli_si128(key, 4));
+    key = _mm_xor_si128(key, _mm_slli_si128(key, 4));
+    return _mm_xor_si128(key, gen);
+}
+
+/**
+ * \brief Encrypt multiple blocks at once
+ *
+ * Instructions of independent blocks are interleaved, so the CPU can process them in
+ * a pipeline.
+ * \param[in]     rk     Round keys
+ * \param[in,out] blocks Blocks to encrypt
+ */
+__attribute__((target("aes,sse2")))
+static inline void
+aes_encrypt_pipe(const __m128i *rk, __m128i *blocks)
+{
+    for (int i = 0; i < PIPE_BLOCKS; ++i) {
+        blocks[i] = _mm_xor_si128(blocks[i], rk[0]);
+    }
+    for (int r = 1; r < 10; ++r) {
+        for (int i = 0; i < PIPE_BLOCKS; ++i) {
+            blocks[i] = _mm_aesenc_si128(blocks[i], rk[r]);
+        }
+    }
+    for (int i = 0; i < PIPE_BLOCKS; ++i) {
+        blocks[i] = _mm_aesenclast_si128(blocks[i], rk[10]);
+    }
+}
+
+/**
+ * \brief Get the most significant bit of the first byte of an encrypted block
+ * \param[in] block Encrypted block
+ * \return 0 or 1
+ */
+__attribute__((target("sse2")))
+static inline uint32_t
+block_bit(__m128i block)
+{
+    return ((uint32_t) _mm_cvtsi128_si32(block) >> 7) & 0x1U;
+}
+
+__attribute__((target("aes,sse2")))
+static void
+panon_batch_init(panon_batch_t *anon, const uint8_t *key)
+{
+    __m128i *rk = anon->round_keys;
+    rk[0] = _mm_loadu_si128((const __m128i *) key);
+    rk[1] = KEY_EXP(rk[0], 0x01);
+    rk[2] = KEY_EXP(rk[1], 0x02);
+    rk[3] = KEY_EXP(rk[2], 0x04);
+    rk[4] = KEY_EXP(rk[3], 0x08);
+    rk[5] = KEY_EXP(rk[4], 0x10);
+    rk[6] = KEY_EXP(rk[5], 0x20);
+    rk[7] = KEY_EXP(rk[6], 0x40);
+    rk[8] = KEY_EXP(rk[7], 0x80);
+    rk[9] = KEY_EXP(rk[8], 0x1B);
+    rk[10] = KEY_EXP(rk[9], 0x36);
+
+    // The pad is the second half of the key encrypted by the first half
+    __m128i pad = _mm_loadu_si128((const __m128i *) (key + 16));
+    pad = _mm_xor_si128(pad, rk[0]);
+    for (int r = 1; r < 10; ++r) {
+        pad = _mm_aesenc_si128(pad, rk[r]);
+    }
+    anon->pad = _mm_aesenclast_si128(pad, rk[10]);
+
+    uint8_t pad_bytes[16];
+    _mm_storeu_si128((__m128i *) pad_bytes, anon->pad);
+    anon->pad_v4 = ((uint32_t) pad_bytes[0] << 24) | ((uint32_t) pad_bytes[1] << 16)
+        | ((uint32_t) pad_bytes[2] << 8) | (uint32_t) pad_bytes[3];
+
+    /* Input blocks of IPv6 addresses are composed exactly as in anonymize_v6() i.e. bytes
+     * before the current one are taken from the address, the current byte is composed of
+     * the most significant bits of the address and the whole byte of the pad and remaining
+     * bytes are taken from the pad. */
+    for (int pos = 0; pos < 128; ++pos) {
+        const int bit_num = pos & 0x7;
+        const int left_byte = pos >> 3;
+        uint8_t mask[16];
+        uint8_t pad_part[16];
+
+        for (int i = 0; i < 16; ++i) {
+            if (i < left_byte) {
+                mask[i] = 0xFF;
+                pad_part[i] = 0;
+            } else if (i == left_byte) {
+                mask[i] = (uint8_t) (0xFFU << (7 - bit_num));
+                pad_part[i] = pad_bytes[i];
+            } else {
+                mask[i] = 0;
+                pad_part[i] = pad_bytes[i];
+            }
+        }
+
+        anon->v6_mask[pos] = _mm_loadu_si128((const __m128i *) mask);
+        anon->v6_pad[pos] = _mm_loadu_si128((const __m128i *) pad_part);
+    }
+}
+
+/**
+ * \brief Get the index of the first record of a cache set
+ * \param[in] anon Batch anonymizer
+ * \param[in] hash Hash of a prefix
+ * \return Index
+ */
+static inline size_t
+cache_set(const panon_batch_t *anon, uint64_t hash)
+{
+    // Fibonacci hashing (the most significant bits are well mixed)
+    hash *= UINT64_C(0x9E3779B97F4A7C15);
+    return ((size_t) (hash >> 32) & anon->cache_mask) * CACHE_WAYS;
+}
+
+/**
+ * \brief Select a record of a cache set to replace
+ *
+ * An invalid record is preferred. Otherwise the least frequently used record is selected
+ * and frequencies of other records are decreased, so prefixes that are no longer used can
+ * be replaced later.
+ * \param[in] freqs Frequencies of records of the set (0 for invalid records)
+ * \return Index of the record in the set
+ */
+static inline unsigned int
+cache_victim(uint16_t *freqs[CACHE_WAYS])
+{
+    unsigned int victim = 0;
+    for (unsigned int i = 1; i < CACHE_WAYS; ++i) {
+        if (*freqs[i] < *freqs[victim]) {
+            victim = i;
+        }
+    }
+
+    for (unsigned int i = 0; i < CACHE_WAYS; ++i) {
+        if (i != victim && *freqs[i] > 0) {
+            (*freqs[i])--;
+        }
+    }
+
+    return victim;
+}
+
+panon_batch_t *
+panon_batch_create(const uint8_t *key, size_t cache_size)
+{
+    __builtin_cpu_init();
+    if (!__builtin_cpu_supports("aes") || !__builtin_cpu_supports("sse2")) {
+        return NULL;
+    }
+
+    panon_batch_t *anon = aligned_alloc(16, sizeof(*anon));
+    if (!anon) {
+        return NULL;
+    }
+
+    panon_batch_init(anon, key);
+    memset(&anon->stats, 0, sizeof(anon->stats));
+    anon->cache_v4 = NULL;
+    anon->cache_v6 = NULL;
+    anon->cache_mask = 0;
+
+    if (cache_size == 0) {
+        return anon;
+    }
+
+    // Number of sets is rounded up to a power of two
+    size_t sets = 1;
+    while (sets * CACHE_WAYS < cache_size && sets < (UINT32_C(1) << 31)) {
+        sets <<= 1;
+    }
+
+    anon->cache_v4 = calloc(sets * CACHE_WAYS, sizeof(*anon->cache_v4));
+    anon->cache_v6 = calloc(sets * CACHE_WAYS, sizeof(*anon->cache_v6));
+    if (!anon->cache_v4 || !anon->cache_v6) {
+        panon_batch_destroy(anon);
+        return NULL;
+    }
+
+    anon->cache_mask = (uint32_t) (sets - 1);
+    return anon;
+}
+
+void
+panon_batch_destroy(panon_batch_t *anon)
+{
+    if (!anon) {
+        return;
+    }
+
+    free(anon->cache_v4);
+    free(anon->cache_v6);
+    free(anon);
+}
+
+void
+panon_batch_stats_get(const panon_batch_t *anon, struct panon_batch_stats *stats)
+{
+    *stats = anon->stats;
+}
+
+/**
+ * \brief Compute bits of the one-time pad of an IPv4 address
+ * \param[in] anon     Batch anonymizer
+ * \param[in] orig     Address (host byte order)
+ * \param[in] pos_from First position (multiple of #PIPE_BLOCKS)
+ * \param[in] pos_to   Last position + 1 (multiple of #PIPE_BLOCKS)
+ * \return Bits of the pad (other bits are zeros)
+ */
+__attribute__((target("aes,sse2")))
+static inline uint32_t
+v4_otp(const panon_batch_t *anon, uint32_t orig, int pos_from, int pos_to)
+{
+    const uint32_t pad4 = anon->pad_v4;
+    __m128i blocks[PIPE_BLOCKS];
+    uint32_t result = 0;
+
+    // All encryptions of the address are independent
+    for (int pos_base = pos_from; pos_base < pos_to; pos_base += PIPE_BLOCKS) {
+        for (int i = 0; i < PIPE_BLOCKS; ++i) {
+            const int pos = pos_base + i;
+            uint32_t first4 = pad4;
+            if (pos != 0) {
+                first4 = ((orig >> (32 - pos)) << (32 - pos)) | ((pad4 << pos) >> pos);
+            }
+            // Replace the first 4 bytes of the pad (stored in network byte order)
+            const uint32_t diff = __builtin_bswap32(first4 ^ pad4);
+            blocks[i] = _mm_xor_si128(anon->pad, _mm_cvtsi32_si128((int) diff));
+        }
+
+        aes_encrypt_pipe(anon->round_keys, blocks);
+        for (int i = 0; i < PIPE_BLOCKS; ++i) {
+            result |= block_bit(blocks[i]) << (31 - (pos_base + i));
+        }
+    }
+
+    return result;
+}
+
+/**
+ * \brief Get bits of the one-time pad of an IPv4 address that depend only on its prefix
+ * \param[in] anon Batch anonymizer
+ * \param[in] orig Address (host byte order)
+ * \return Bits of the pad
+ */
+__attribute__((target("aes,sse2")))
+static inline uint32_t
+v4_otp_prefix(panon_batch_t *anon, uint32_t orig)
+{
+    const uint32_t prefix = orig >> (32 - PREFIX_V4);
+    struct cache_v4_rec *set = &anon->cache_v4[cache_set(anon, prefix)];
+    uint16_t *freqs[CACHE_WAYS];
+
+    for (unsigned int i = 0; i < CACHE_WAYS; ++i) {
+        struct cache_v4_rec *rec = &set[i];
+        if (rec->valid && rec->prefix == prefix) {
+            if (rec->freq < UINT16_MAX) {
+                rec->freq++;
+            }
+            anon->stats.v4_hits++;
+            return rec->otp;
+        }
+        freqs[i] = &rec->freq;
+    }
+
+    anon->stats.v4_misses++;
+    struct cache_v4_rec *rec = &set[cache_victim(freqs)];
+    rec->prefix = prefix;
+    rec->otp = v4_otp(anon, orig, 0, PREFIX_V4);
+    rec->freq = 1;
+    rec->valid = true;
+    return rec->otp;
+}
+
+__attribute__((target("aes,sse2")))
+void
+panon_batch_v4(panon_batch_t *anon, uint8_t * const *addrs, size_t cnt)
+{
+    for (size_t idx = 0; idx < cnt; ++idx) {
+        uint8_t *ptr = addrs[idx];
+        const uint32_t orig = ((uint32_t) ptr[0] << 24) | ((uint32_t) ptr[1] << 16)
+            | ((uint32_t) ptr[2] << 8) | (uint32_t) ptr[3];
+        uint32_t result;
+
+        if (anon->cache_v4 != NULL) {
+            result = v4_otp_prefix(anon, orig) | v4_otp(anon, orig, PREFIX_V4, 32);
+        } else {
+            result = v4_otp(anon, orig, 0, 32);
+        }
+
+        result ^= orig;
+        ptr[0] = (uint8_t) (result >> 24);
+        ptr[1] = (uint8_t) (result >> 16);
+        ptr[2] = (uint8_t) (result >> 8);
+        ptr[3] = (uint8_t) result;
+    }
+}
+
+/**
+ * \brief Compute bits of the one-time pad of an IPv6 address
+ * \param[in]     anon     Batch anonymizer
+ * \param[in]     orig     Address
+ * \param[in]     pos_from First position (multiple of #PIPE_BLOCKS)
+ * \param[in]     pos_to   Last position + 1 (multiple of #PIPE_BLOCKS)
+ * \param[in,out] result   Pad (computed bits are added)
+ */
+__attribute__((target("aes,sse2")))
+static inline void
+v6_otp(const panon_batch_t *anon, __m128i orig, int pos_from, int pos_to, uint8_t result[16])
+{
+    __m128i blocks[PIPE_BLOCKS];
+
+    // All encryptions of the address are independent
+    for (int pos_base = pos_from; pos_base < pos_to; pos_base += PIPE_BLOCKS) {
+        for (int i = 0; i < PIPE_BLOCKS; ++i) {
+            const int pos = pos_base + i;
+            blocks[i] = _mm_or_si128(_mm_and_si128(orig, anon->v6_mask[pos]),
+                anon->v6_pad[pos]);
+        }
+
+        aes_encrypt_pipe(anon->round_keys, blocks);
+        for (int i = 0; i < PIPE_BLOCKS; ++i) {
+            const int pos = pos_base + i;
+            // The same (unusual) order of bits as in anonymize_v6()
+            result[pos >> 3] |= (uint8_t) (block_bit(blocks[i]) << (pos & 0x7));
+        }
+    }
+}
+
+/**
+ * \brief Get bits of the one-time pad of an IPv6 address that depend only on its prefix
+ * \param[in]     anon   Batch anonymizer
+ * \param[in]     ptr    Address
+ * \param[in]     orig   Address (loaded)
+ * \param[in,out] result Pad (the first 8 bytes are filled)
+ */
+__attribute__((target("aes,sse2")))
+static inline void
+v6_otp_prefix(panon_batch_t *anon, const uint8_t *ptr, __m128i orig, uint8_t result[16])
+{
+    uint64_t prefix;
+    memcpy(&prefix, ptr, sizeof(prefix));
+    struct cache_v6_rec *set = &anon->cache_v6[cache_set(anon, prefix)];
+    uint16_t *freqs[CACHE_WAYS];
+
+    for (unsigned int i = 0; i < CACHE_WAYS; ++i) {
+        struct cache_v6_rec *rec = &set[i];
+        if (rec->valid && rec->prefix == prefix) {
+            if (rec->freq < UINT16_MAX) {
+                rec->freq++;
+            }
+            anon->stats.v6_hits++;
+            memcpy(result, &rec->otp, sizeof(rec->otp));
+            return;
+        }
+        freqs[i] = &rec->freq;
+    }
+
+    anon->stats.v6_misses++;
+    struct cache_v6_rec *rec = &set[cache_victim(freqs)];
+    v6_otp(anon, orig, 0, PREFIX_V6, result);
+    rec->prefix = prefix;
+    memcpy(&rec->otp, result, sizeof(rec->otp));
+    rec->freq = 1;
+    rec->valid = true;
+}
+
+__attribute__((target("aes,sse2")))
+void
+panon_batch_v6(panon_batch_t *anon, uint8_t * const *addrs, size_t cnt)
+{
+    for (size_t idx = 0; idx < cnt; ++idx) {
+        uint8_t *ptr = addrs[idx];
+        const __m128i orig = _mm_loadu_si128((const __m128i *) ptr);
+        uint8_t result[16] = {0};
+
+        if (anon->cache_v6 != NULL) {
+            v6_otp_prefix(anon, ptr, orig, result);
+            v6_otp(anon, orig, PREFIX_V6, 128, result);
+        } else {
+            v6_otp(anon, orig, 0, 128, result);
+        }
+
+        const __m128i anon_addr = _mm_xor_si128(orig, _mm_loadu_si128((const __m128i *) result));
+        _mm_storeu_si128((__m128i *) ptr, anon_addr);
+    }
+}
+
+#else // Other architectures are not supported
+
+panon_batch_t *
+panon_batch_create(const uint8_t *key, size_t cache_size)
+{
+    (void) key;
+    (void) cache_size;
+    return NULL;
+}
+
+void
+panon_batch_destroy(panon_batch_t *anon)
+{
+    (void) anon;
+}
+
+void
+panon_batch_stats_get(const panon_batch_t *anon, struct panon_batch_stats *stats)
+{
+    (void) anon;
+    memset(stats, 0, sizeof(*stats));
+}
+
+void
+panon_batch_v4(panon_batch_t *anon, uint8_t * const *addrs, size_t cnt)
+{
+    (void) anon;
+    (void) addrs;
+    (void) cnt;
+}
+
+void
+panon_batch_v6(panon_batch_t *anon, uint8_t * const *addrs, size_t cnt)
+{
+    (void) anon;
+    (void) addrs;
+    (void) cnt;
+}
+
+#endif
@@ -0,0 +1,115 @@
+/**
+ * \file src/plugins/intermediate/anonymization/Crypto-PAn/panonymizer_batch.h
+ * \author agent <agent@local>
+ * \brief Crypto-PAn anonymization of batches of addresses accelerated by AES-NI (header file)
+ * \date 2026
+ */
+
+/* Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is'', and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+#ifndef PANONYMIZER_BATCH_H
+#define PANONYMIZER_BATCH_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * \brief Internal structure of the batch anonymizer
+ *
+ * The results are identical to anonymize() and anonymize_v6() (see panonymizer.h) with the
+ * same key. However, all encryptions of each address are independent, therefore, they are
+ * processed by AES-NI instructions in a pipeline of multiple blocks at once.
+ */
+typedef struct panon_batch panon_batch_t;
+
+/** Statistics of the prefix cache */
+struct panon_batch_stats {
+    /** Number of IPv4 addresses with a cached /24 prefix                   */
+    uint64_t v4_hits;
+    /** Number of IPv4 addresses without a cached /24 prefix                */
+    uint64_t v4_misses;
+    /** Number of IPv6 addresses with a cached /64 prefix                   */
+    uint64_t v6_hits;
+    /** Number of IPv6 addresses without a cached /64 prefix                */
+    uint64_t v6_misses;
+};
+
+/**
+ * \brief Create a batch anonymizer
+ *
+ * Bits of the one-time pad of an address that depend only on its prefix (/24 for IPv4, /64
+ * for IPv6) are stored in a bounded cache. Therefore, only the remaining bits are computed for
+ * addresses with a cached prefix. Frequently used prefixes are preferred when a record of the
+ * cache is replaced.
+ * \param[in] key        256-bit key (the first half is the AES key, the second half is the pad)
+ * \param[in] cache_size Maximum number of cached prefixes of each address family (0 = disabled)
+ * \return Pointer or NULL (the CPU doesn't support AES-NI or a memory allocation error)
+ */
+panon_batch_t *
+panon_batch_create(const uint8_t *key, size_t cache_size);
+
+/**
+ * \brief Destroy a batch anonymizer
+ * \param[in] anon Batch anonymizer
+ */
+void
+panon_batch_destroy(panon_batch_t *anon);
+
+/**
+ * \brief Get statistics of the prefix cache
+ * \param[in]  anon  Batch anonymizer
+ * \param[out] stats Statistics
+ */
+void
+panon_batch_stats_get(const panon_batch_t *anon, struct panon_batch_stats *stats);
+
+/**
+ * \brief Anonymize IPv4 addresses (in place)
+ * \param[in] anon  Batch anonymizer
+ * \param[in] addrs Array of pointers to addresses (4 bytes, network byte order, unaligned)
+ * \param[in] cnt   Number of addresses
+ */
+void
+panon_batch_v4(panon_batch_t *anon, uint8_t * const *addrs, size_t cnt);
+
+/**
+ * \brief Anonymize IPv6 addresses (in place)
+ * \param[in] anon  Batch anonymizer
+ * \param[in] addrs Array of pointers to addresses (16 bytes, network byte order, unaligned)
+ * \param[in] cnt   Number of addresses
+ */
+void
+panon_batch_v6(panon_batch_t *anon, uint8_t * const *addrs, size_t cnt);
+
+#endif // PANONYMIZER_BATCH_H
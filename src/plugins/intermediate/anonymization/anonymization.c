@@ -43,9 +43,11 @@
 #include <stdlib.h>
 #include <unistd.h>
 #include <inttypes.h>
+#include <pthread.h>
 
 #include "config.h"
 #include "Crypto-PAn/panonymizer.h"
+#include "Crypto-PAn/panonymizer_batch.h"
 
 /** Plugin description */
 IPX_API struct ipx_plugin_info ipx_plugin_info = {
@@ -63,52 +65,339 @@ IPX_API struct ipx_plugin_info ipx_plugin_info = {
     .ipx_min = "2.0.0"
 };
 
+/** Maximum number of different Templates cached per message                            */
+#define TCACHE_SIZE  (16U)
+/** Maximum number of address fields of a cached Template                               */
+#define TCACHE_ADDRS (32U)
+/** Default number of gathered addresses of each type                                   */
+#define BATCH_DEF    (256U)
+
+/**
+ * Key of the generic Crypto-PAn implementation
+ *
+ * The implementation has a global state shared by all instances (e.g. replicas of the same
+ * instance running in multiple threads), therefore, it can be initialized only once and all
+ * instances that use it must share the same key.
+ */
+static struct {
+    /** Lock of the initialization                                                  */
+    pthread_mutex_t lock;
+    /** The implementation has been initialized                                     */
+    bool ready;
+    /** The key of the implementation                                               */
+    char key[ANON_KEY_LEN];
+} generic_key = {PTHREAD_MUTEX_INITIALIZER, false, {0}};
+
+/** Address fields of a Template */
+struct tcache_rec {
+    /**
+     * Offsets of address fields are not known (i.e. an address is placed after
+     * a variable-length field or the Template has too many addresses) and records must be
+     * processed by an iterator.
+     */
+    bool use_iter;
+    /** Number of address fields                                                        */
+    uint16_t cnt;
+    /** Offsets of address fields from the start of a record                            */
+    uint16_t offsets[TCACHE_ADDRS];
+    /** Sizes of address fields (4 or 16 bytes)                                         */
+    uint8_t sizes[TCACHE_ADDRS];
+};
+
+/** Array of pointers to gathered addresses */
+struct addr_batch {
+    /** Array of pointers                                                               */
+    uint8_t **addrs;
+    /** Number of valid pointers                                                        */
+    size_t cnt;
+    /** Size of the array                                                               */
+    size_t alloc;
+};
+
 /** Instance */
 struct instance_data {
-    /** Parsed configuration of the instance  */
+    /** Parsed configuration of the instance                                            */
     struct anon_config *config;
+    /** Crypto-PAn accelerated by AES-NI (NULL, if not supported by the CPU)            */
+    panon_batch_t *panon;
+
+    /** Address fields of Templates of the processed message (see struct tcache_rec)    */
+    ipx_tcache_t *tcache;
+
+    /** Gathered IPv4 addresses of the processed message                                */
+    struct addr_batch batch_v4;
+    /** Gathered IPv6 addresses of the processed message                                */
+    struct addr_batch batch_v6;
 };
 
 /**
  * \brief Anonymize an IPv4/IPv6 address by setting lower half of the address to be zeros
- * \param field IPFIX field with an address to anonymize
+ * \param[in] addr Address to anonymize
+ * \param[in] size Size of the address (4 or 16 bytes)
  */
 static void
-anonymize_trunc(struct fds_drec_field *field)
+anonymize_trunc(uint8_t *addr, uint16_t size)
 {
     // IP addresses are stored in Network byte order
-    if (field->size == 4) {
-        memset(&field->data[2], 0, 2);
+    if (size == 4) {
+        memset(&addr[2], 0, 2);
         return;
     }
 
-    if (field->size == 16) {
-        memset(&field->data[8], 0, 8);
+    if (size == 16) {
+        memset(&addr[8], 0, 8);
         return;
     }
 }
 
 /**
  * \brief Anonymize an IPv4/IPV6 address using Crypto-PAn anonymization technique
- * \param[in] field IPFIX field with an address to anonymize
+ * \param[in] addr Address to anonymize
+ * \param[in] size Size of the address (4 or 16 bytes)
  */
 static void
-anonymize_cryptopan(struct fds_drec_field *field)
+anonymize_cryptopan(uint8_t *addr, uint16_t size)
 {
-    if (field->size == 4) {
-        uint32_t *mem = (uint32_t *) field->data;
-        (*mem) = htonl(anonymize(ntohl(*mem)));
+    if (size == 4) {
+        uint32_t mem;
+        memcpy(&mem, addr, sizeof(mem));
+        mem = htonl(anonymize(ntohl(mem)));
+        memcpy(addr, &mem, sizeof(mem));
         return;
     }
 
-    if (field->size == 16) {
+    if (size == 16) {
         uint64_t addr_orig[2];
         uint64_t addr_anon[2];
-        memcpy(addr_orig, field->data, field->size);
+        memcpy(addr_orig, addr, size);
         anonymize_v6(addr_orig, addr_anon);
-        memcpy(field->data, addr_anon, field->size);
+        memcpy(addr, addr_anon, size);
+        return;
+    }
+}
+
+/**
+ * \brief Add an address to a batch
+ * \param[in] batch Batch
+ * \param[in] addr  Address
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_NOMEM if a memory allocation error has occurred
+ */
+static int
+batch_add(struct addr_batch *batch, uint8_t *addr)
+{
+    if (batch->cnt == batch->alloc) {
+        const size_t alloc_new = (batch->alloc == 0) ? BATCH_DEF : 2 * batch->alloc;
+        uint8_t **addrs_new = realloc(batch->addrs, alloc_new * sizeof(*addrs_new));
+        if (!addrs_new) {
+            return IPX_ERR_NOMEM;
+        }
+
+        batch->addrs = addrs_new;
+        batch->alloc = alloc_new;
+    }
+
+    batch->addrs[batch->cnt++] = addr;
+    return IPX_OK;
+}
+
+/**
+ * \brief Anonymize all gathered addresses
+ * \param[in] data Instance data
+ */
+static void
+addr_flush(struct instance_data *data)
+{
+    if (data->batch_v4.cnt > 0) {
+        panon_batch_v4(data->panon, data->batch_v4.addrs, data->batch_v4.cnt);
+        data->batch_v4.cnt = 0;
+    }
+
+    if (data->batch_v6.cnt > 0) {
+        panon_batch_v6(data->panon, data->batch_v6.addrs, data->batch_v6.cnt);
+        data->batch_v6.cnt = 0;
+    }
+}
+
+/**
+ * \brief Anonymize an address or add it to a batch
+ *
+ * Addresses are truncated immediately. Addresses anonymized by Crypto-PAn are gathered,
+ * if AES-NI is supported (see addr_flush()).
+ * \param[in] data Instance data
+ * \param[in] addr Address
+ * \param[in] size Size of the address (4 or 16 bytes)
+ */
+static inline void
+addr_process(struct instance_data *data, uint8_t *addr, uint16_t size)
+{
+    if (data->config->mode == AN_TRUNC) {
+        anonymize_trunc(addr, size);
         return;
     }
+
+    if (data->panon == NULL) {
+        // AES-NI is not available
+        anonymize_cryptopan(addr, size);
+        return;
+    }
+
+    struct addr_batch *batch = (size == 4U) ? &data->batch_v4 : &data->batch_v6;
+    if (batch_add(batch, addr) != IPX_OK) {
+        // The batch cannot be extended, anonymize all gathered addresses to make space
+        addr_flush(data);
+        batch_add(batch, addr);
+    }
+}
+
+/**
+ * \brief Check if a field of a Template is an IPv4/IPv6 address
+ * \param[in] ctx   Plugin context (only for log)
+ * \param[in] field Template field
+ * \param[in] size  Size of the field in a record
+ * \return True or false
+ */
+static inline bool
+field_is_addr(ipx_ctx_t *ctx, const struct fds_tfield *field, uint16_t size)
+{
+    if (field->def == NULL) {
+        // Skip unknown fields
+        return false;
+    }
+
+    const enum fds_iemgr_element_type type = field->def->data_type;
+    if (type != FDS_ET_IPV4_ADDRESS && type != FDS_ET_IPV6_ADDRESS) {
+        // Not an IPv4/IPv6 address
+        return false;
+    }
+
+    if (size != 4U && size != 16U) {
+        IPX_CTX_DEBUG(ctx, "Unable to anonymize an IP address with invalid size "
+            "(%" PRIu16 "bytes)!", size);
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * \brief Find address fields of a Template in the cache or add them
+ * \param[in] ctx   Plugin context (only for log)
+ * \param[in] data  Instance data
+ * \param[in] tmplt Template
+ * \return Cached record or NULL (the cache is full or memory allocation error)
+ */
+static const struct tcache_rec *
+tcache_get(ipx_ctx_t *ctx, struct instance_data *data, const struct fds_template *tmplt)
+{
+    struct tcache_rec *rec = ipx_tcache_find(data->tcache, tmplt);
+    if (rec != NULL) {
+        return rec;
+    }
+
+    if ((rec = ipx_tcache_add(data->tcache, tmplt)) == NULL) {
+        return NULL;
+    }
+
+    for (uint16_t i = 0; i < tmplt->fields_cnt_total; ++i) {
+        const struct fds_tfield *field = &tmplt->fields[i];
+        if (!field_is_addr(ctx, field, field->length)) {
+            continue;
+        }
+
+        if (field->offset == FDS_IPFIX_VAR_IE_LEN || rec->cnt == TCACHE_ADDRS) {
+            // The address cannot be found without an iterator
+            rec->use_iter = true;
+            break;
+        }
+
+        rec->offsets[rec->cnt] = field->offset;
+        rec->sizes[rec->cnt] = (uint8_t) field->length;
+        rec->cnt++;
+    }
+
+    return rec;
+}
+
+/**
+ * \brief Process all addresses of a record using an iterator
+ * \param[in] ctx  Plugin context (only for log)
+ * \param[in] data Instance data
+ * \param[in] rec  Data Record
+ */
+static void
+record_iter(ipx_ctx_t *ctx, struct instance_data *data, struct fds_drec *rec)
+{
+    struct fds_drec_iter it;
+    fds_drec_iter_init(&it, rec, 0);
+
+    while (fds_drec_iter_next(&it) != FDS_EOC) {
+        if (!field_is_addr(ctx, it.field.info, it.field.size)) {
+            continue;
+        }
+
+        addr_process(data, it.field.data, it.field.size);
+    }
+}
+
+/**
+ * \brief Initialize the generic Crypto-PAn implementation
+ * \param[in] ctx Plugin context (only for log)
+ * \param[in] key Key
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_DENIED if the implementation has been initialized with a different key
+ */
+static int
+generic_init(ipx_ctx_t *ctx, const char *key)
+{
+    int rc = IPX_OK;
+
+    pthread_mutex_lock(&generic_key.lock);
+    if (!generic_key.ready) {
+        memcpy(generic_key.key, key, ANON_KEY_LEN);
+        PAnonymizer_Init((uint8_t *) generic_key.key);
+        generic_key.ready = true;
+    } else if (memcmp(generic_key.key, key, ANON_KEY_LEN) != 0) {
+        IPX_CTX_ERROR(ctx, "Multiple anonymization instances with different keys are not "
+            "supported without AES-NI instructions!", '\0');
+        rc = IPX_ERR_DENIED;
+    }
+    pthread_mutex_unlock(&generic_key.lock);
+
+    return rc;
+}
+
+/**
+ * \brief Initialize Crypto-PAn anonymization of an instance
+ *
+ * The implementation accelerated by AES-NI is preferred. If not available, the generic
+ * implementation is used.
+ * \param[in] ctx  Plugin context (only for log)
+ * \param[in] data Instance data
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_DENIED on failure
+ */
+static int
+cryptopan_init(ipx_ctx_t *ctx, struct instance_data *data)
+{
+    const char *key = data->config->crypto_key;
+
+    data->panon = panon_batch_create((const uint8_t *) key, data->config->cache_size);
+    if (data->panon == NULL) {
+        IPX_CTX_INFO(ctx, "AES-NI instructions are not available, Crypto-PAn will not "
+            "be accelerated.", '\0');
+        return generic_init(ctx, key);
+    }
+
+    // Batches must always have space for at least one address (see addr_process())
+    if (batch_add(&data->batch_v4, NULL) != IPX_OK || batch_add(&data->batch_v6, NULL) != IPX_OK) {
+        IPX_CTX_ERROR(ctx, "Memory allocation error (%s:%d)", __FILE__, __LINE__);
+        return IPX_ERR_DENIED;
+    }
+
+    data->batch_v4.cnt = 0;
+    data->batch_v6.cnt = 0;
+    return IPX_OK;
 }
 
 // -------------------------------------------------------------------------------------------------
@@ -127,8 +416,16 @@ ipx_plugin_init(ipx_ctx_t *ctx, const char *params)
         return IPX_ERR_DENIED;
     }
 
-    if (data->config->mode == AN_CRYPTOPAN) {
-        PAnonymizer_Init((uint8_t *)data->config->crypto_key);
+    data->tcache = ipx_tcache_create(sizeof(struct tcache_rec), TCACHE_SIZE);
+    if (!data->tcache) {
+        IPX_CTX_ERROR(ctx, "Memory allocation failed! (%s:%d)", __FILE__, __LINE__);
+        ipx_plugin_destroy(ctx, data);
+        return IPX_ERR_DENIED;
+    }
+
+    if (data->config->mode == AN_CRYPTOPAN && cryptopan_init(ctx, data) != IPX_OK) {
+        ipx_plugin_destroy(ctx, data);
+        return IPX_ERR_DENIED;
     }
 
     ipx_ctx_private_set(ctx, data);
@@ -138,9 +435,20 @@ ipx_plugin_init(ipx_ctx_t *ctx, const char *params)
 void
 ipx_plugin_destroy(ipx_ctx_t *ctx, void *cfg)
 {
-    (void) ctx; // Suppress warnings
     struct instance_data *data = (struct instance_data *) cfg;
 
+    if (data->panon != NULL && data->config->cache_size > 0) {
+        struct panon_batch_stats stats;
+        panon_batch_stats_get(data->panon, &stats);
+        IPX_CTX_INFO(ctx, "Prefix cache statistics: IPv4 (hits: %" PRIu64 ", misses: %" PRIu64
+            "), IPv6 (hits: %" PRIu64 ", misses: %" PRIu64 ")", stats.v4_hits, stats.v4_misses,
+            stats.v6_hits, stats.v6_misses);
+    }
+
+    panon_batch_destroy(data->panon);
+    free(data->batch_v4.addrs);
+    free(data->batch_v6.addrs);
+    ipx_tcache_destroy(data->tcache);
     config_destroy(data->config);
     free(data);
 }
@@ -149,46 +457,34 @@ int
 ipx_plugin_process(ipx_ctx_t *ctx, void *cfg, ipx_msg_t *msg)
 {
     struct instance_data *data = (struct instance_data *) cfg;
+    ipx_tcache_clear(data->tcache);
 
-    // Process all data records in the IPFIX message
+    // Addresses are modified in place, i.e. the message must not be shared with other branches
     ipx_msg_ipfix_t *ipfix_msg = ipx_msg_base2ipfix(msg);
+    if (ipx_msg_ipfix_writable(ipfix_msg) != IPX_OK) {
+        IPX_CTX_ERROR(ctx, "Memory allocation failed! (%s:%d)", __FILE__, __LINE__);
+        return IPX_ERR_NOMEM;
+    }
+
+    // Gather all IPv4/IPv6 addresses in the IPFIX message
     const uint32_t rec_cnt = ipx_msg_ipfix_get_drec_cnt(ipfix_msg);
     for (uint32_t i = 0; i < rec_cnt; ++i) {
         struct ipx_ipfix_record *rec = ipx_msg_ipfix_get_drec(ipfix_msg, i);
+        const struct tcache_rec *addrs = tcache_get(ctx, data, rec->rec.tmplt);
 
-        // Go through the record and anonymize all IPv4/IPv6 addresses
-        struct fds_drec_iter it;
-        fds_drec_iter_init(&it, &rec->rec, 0);
-
-        while (fds_drec_iter_next(&it) != FDS_EOC) {
-            const struct fds_tfield *info = it.field.info;
-            if (info->def == NULL) {
-                // Skip unknown fields
-                continue;
-            }
-
-            const enum fds_iemgr_element_type type = info->def->data_type;
-            if (type != FDS_ET_IPV4_ADDRESS && type != FDS_ET_IPV6_ADDRESS) {
-                // Not an IPv4/IPv6 address
-                continue;
-            }
-
-            if (it.field.size != 4U && it.field.size != 16U) {
-                IPX_CTX_DEBUG(ctx, "Unable to anonymize an IP address with invalid size "
-                    "(%" PRIu16 "bytes)!", it.field.size);
-                continue;
-            }
-
-            if (data->config->mode == AN_TRUNC) {
-                // Truncate the address
-                anonymize_trunc(&it.field);
-            } else {
-                // Crypto-PAn
-                anonymize_cryptopan(&it.field);
-            }
+        if (addrs == NULL || addrs->use_iter) {
+            record_iter(ctx, data, &rec->rec);
+            continue;
+        }
+
+        for (uint16_t idx = 0; idx < addrs->cnt; ++idx) {
+            addr_process(data, &rec->rec.data[addrs->offsets[idx]], addrs->sizes[idx]);
         }
     }
 
+    // Anonymize gathered addresses at once
+    addr_flush(data);
+
     // Always pass the message
     ipx_ctx_msg_pass(ctx, msg);
     return IPX_OK;
@@ -40,19 +40,34 @@
  */
 
 #include <stdlib.h>
+#include <stdio.h>
 #include <limits.h>
+#include <pthread.h>
 #include "config.h"
 
+/** Random key shared by all instances without a key (e.g. replicas of the same instance) */
+static struct {
+    /** Lock of the key                                                             */
+    pthread_mutex_t lock;
+    /** The key has been generated                                                  */
+    bool ready;
+    /** The key                                                                     */
+    char key[ANON_KEY_LEN];
+} random_key = {PTHREAD_MUTEX_INITIALIZER, false, {0}};
+
 /*
  * <params>
- *  <delay>...</delay>          <!-- in microseconds -->
+ *  <type>...</type>                <!-- CryptoPAn/Truncation -->
+ *  <key>...</key>                  <!-- optional -->
+ *  <prefixCache>...</prefixCache>  <!-- optional, number of cached prefixes -->
  * </params>
  */
 
 /** XML nodes */
 enum params_xml_nodes {
     ANON_TYPE = 1,
-    ANON_KEY
+    ANON_KEY,
+    ANON_CACHE
 };
 
 /** Definition of the \<params\> node  */
@@ -60,6 +75,7 @@ static const struct fds_xml_args args_params[] = {
     FDS_OPTS_ROOT("params"),
     FDS_OPTS_ELEM(ANON_TYPE, "type", FDS_OPTS_T_STRING, 0),
     FDS_OPTS_ELEM(ANON_KEY,  "key",  FDS_OPTS_T_STRING, FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM(ANON_CACHE, "prefixCache", FDS_OPTS_T_UINT, FDS_OPTS_P_OPT),
     FDS_OPTS_END
 };
 
@@ -111,6 +127,14 @@ config_parser_root(ipx_ctx_t *ctx, fds_xml_ctx_t *root, struct anon_config *cfg)
                 return IPX_ERR_FORMAT;
             }
             break;
+        case ANON_CACHE:
+            assert(content->type == FDS_OPTS_T_UINT);
+            if (content->val_uint > UINT32_MAX) {
+                IPX_CTX_ERROR(ctx, "Size of the prefix cache is too large!", '\0');
+                return IPX_ERR_FORMAT;
+            }
+            cfg->cache_size = (size_t) content->val_uint;
+            break;
         default:
             // Internal error
             assert(false);
@@ -138,17 +162,25 @@ config_check(ipx_ctx_t *ctx, struct anon_config *cfg)
             return IPX_ERR_FORMAT;
         }
 
-        const char *key_src = "/dev/urandom";
-        FILE *file = fopen(key_src, "rb");
-        if (file == NULL || fread(key, ANON_KEY_LEN, 1, file) != 1) {
-            IPX_CTX_ERROR(ctx, "Failed to get random key from '%s'!", key_src);
-            free(key);
-            if (file != NULL) {
-                fclose(file);
+        // The key is generated only once, so replicas of the instance use the same key
+        pthread_mutex_lock(&random_key.lock);
+        if (!random_key.ready) {
+            const char *key_src = "/dev/urandom";
+            FILE *file = fopen(key_src, "rb");
+            if (file == NULL || fread(random_key.key, ANON_KEY_LEN, 1, file) != 1) {
+                pthread_mutex_unlock(&random_key.lock);
+                IPX_CTX_ERROR(ctx, "Failed to get random key from '%s'!", key_src);
+                free(key);
+                if (file != NULL) {
+                    fclose(file);
+                }
+                return IPX_ERR_FORMAT;
             }
-            return IPX_ERR_FORMAT;
+            fclose(file);
+            random_key.ready = true;
         }
-        fclose(file);
+        memcpy(key, random_key.key, ANON_KEY_LEN);
+        pthread_mutex_unlock(&random_key.lock);
 
         key[ANON_KEY_LEN] = '\0';
         cfg->crypto_key = key;
@@ -172,6 +204,7 @@ config_parse(ipx_ctx_t *ctx, const char *params)
 
     // Set default parameters
     cfg->crypto_key = NULL;
+    cfg->cache_size = ANON_CACHE_DEF;
 
     // Create an XML parser
     fds_xml_t *parser = fds_xml_create();
@@ -208,6 +241,7 @@ config_parse(ipx_ctx_t *ctx, const char *params)
     // Check validity of configuration
     if (config_check(ctx, cfg) != IPX_OK) {
         config_destroy(cfg);
+        return NULL;
     }
 
     return cfg;
@@ -47,6 +47,8 @@
 
 /** Length of anonymization key                          */
 #define ANON_KEY_LEN 32
+/** Default number of cached prefixes of each family     */
+#define ANON_CACHE_DEF 65536U
 
 /** Supported anonymization techniques                   */
 enum anon_mode {
@@ -62,7 +64,8 @@ struct anon_config {
     enum anon_mode mode;
     /** CryptoPan key (can be NULL, if not set)          */
     char *crypto_key;
-
+    /** Number of cached prefixes of each family (0 = off) */
+    size_t cache_size;
 };
 
 /**
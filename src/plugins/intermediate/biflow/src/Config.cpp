@@ -0,0 +1,133 @@
+/**
+ * \file src/plugins/intermediate/biflow/src/Config.cpp
+ * \author agent <agent@local>
+ * \brief Parser of XML configuration (source file)
+ * \date 2026
+ *
+ * Copyright(c) 2026 CESNET z.s.p.o.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include "Config.hpp"
+#include <cassert>
+#include <memory>
+#include <stdexcept>
+#include <string>
+
+/*
+ * <params>
+ *   <timeout>...</timeout>              <!-- optional -->
+ *   <odid>...</odid>                    <!-- optional -->
+ *   <maxFlows>...</maxFlows>            <!-- optional -->
+ * </params>
+ */
+
+/// XML nodes
+enum params_xml_nodes {
+    NODE_TIMEOUT = 1,
+    NODE_ODID,
+    NODE_MAX_FLOWS
+};
+
+/// Definition of the \<params\> node
+static const struct fds_xml_args args_params[] = {
+    FDS_OPTS_ROOT("params"),
+    FDS_OPTS_ELEM(NODE_TIMEOUT,   "timeout",  FDS_OPTS_T_UINT, FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM(NODE_ODID,      "odid",     FDS_OPTS_T_UINT, FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM(NODE_MAX_FLOWS, "maxFlows", FDS_OPTS_T_UINT, FDS_OPTS_P_OPT),
+    FDS_OPTS_END
+};
+
+Config::Config(const char *params)
+{
+    set_default();
+
+    // Create XML parser
+    std::unique_ptr<fds_xml_t, decltype(&fds_xml_destroy)> xml(fds_xml_create(), &fds_xml_destroy);
+    if (!xml) {
+        throw std::runtime_error("Failed to create an XML parser!");
+    }
+
+    if (fds_xml_set_args(xml.get(), args_params) != FDS_OK) {
+        throw std::runtime_error("Failed to parse the description of an XML document!");
+    }
+
+    fds_xml_ctx_t *params_ctx = fds_xml_parse_mem(xml.get(), params, true);
+    if (!params_ctx) {
+        std::string err = fds_xml_last_err(xml.get());
+        throw std::runtime_error("Failed to parse the configuration: " + err);
+    }
+
+    // Parse parameters and check configuration
+    try {
+        parse_root(params_ctx);
+        validate();
+    } catch (std::exception &ex) {
+        throw std::runtime_error("Failed to parse the configuration: " + std::string(ex.what()));
+    }
+}
+
+/**
+ * @brief Set default parameters
+ */
+void
+Config::set_default()
+{
+    m_timeout = TIMEOUT_DEF;
+    m_odid = 0;
+    m_max_flows = MAX_FLOWS_DEF;
+}
+
+/**
+ * @brief Check if the configuration is valid
+ * @throw runtime_error if the configuration breaks some rules
+ */
+void
+Config::validate()
+{
+    if (m_timeout == 0 || m_timeout > TIMEOUT_MAX) {
+        throw std::runtime_error("Timeout must be between 1 and " + std::to_string(TIMEOUT_MAX)
+            + " seconds!");
+    }
+
+    if (m_max_flows == 0) {
+        throw std::runtime_error("Maximum number of flows must be greater than zero!");
+    }
+}
+
+/**
+ * @brief Process \<params\> node
+ * @param[in] ctx XML context to process
+ * @throw runtime_error if the parser fails
+ */
+void
+Config::parse_root(fds_xml_ctx_t *ctx)
+{
+    const struct fds_xml_cont *content;
+    while (fds_xml_next(ctx, &content) != FDS_EOC) {
+        switch (content->id) {
+        case NODE_TIMEOUT:
+            assert(content->type == FDS_OPTS_T_UINT);
+            if (content->val_uint > UINT32_MAX) {
+                throw std::runtime_error("Timeout is too long!");
+            }
+            m_timeout = static_cast<uint32_t>(content->val_uint);
+            break;
+        case NODE_ODID:
+            assert(content->type == FDS_OPTS_T_UINT);
+            if (content->val_uint > UINT32_MAX) {
+                throw std::runtime_error("ODID must be between 0 and " + std::to_string(UINT32_MAX)
+                    + "!");
+            }
+            m_odid = static_cast<uint32_t>(content->val_uint);
+            break;
+        case NODE_MAX_FLOWS:
+            assert(content->type == FDS_OPTS_T_UINT);
+            m_max_flows = content->val_uint;
+            break;
+        default:
+            // Internal error
+            throw std::runtime_error("Unknown XML node");
+        }
+    }
+}
@@ -0,0 +1,54 @@
+/**
+ * \file src/plugins/intermediate/biflow/src/Config.hpp
+ * \author agent <agent@local>
+ * \brief Parser of XML configuration (header file)
+ * \date 2026
+ *
+ * Copyright(c) 2026 CESNET z.s.p.o.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef IPFIXCOL2_BIFLOW_CONFIG_HPP
+#define IPFIXCOL2_BIFLOW_CONFIG_HPP
+
+#include <cstdint>
+#include <libfds.h>
+
+/**
+ * @brief Plugin configuration parser
+ */
+class Config {
+public:
+    /**
+     * @brief Parse configuration of the plugin
+     * @param[in] params XML parameters to parse
+     * @throw runtime_exception on error
+     */
+    Config(const char *params);
+    ~Config() = default;
+
+    /// Maximum time to wait for the opposite direction of a flow (in seconds)
+    uint32_t m_timeout;
+    /// Observation Domain ID of biflow records
+    uint32_t m_odid;
+    /// Maximum number of flows waiting for the opposite direction
+    uint64_t m_max_flows;
+
+private:
+    /// Default timeout
+    static const uint32_t TIMEOUT_DEF = 30U;
+    /// Maximum timeout
+    static const uint32_t TIMEOUT_MAX = 3600U;
+    /// Default maximum number of waiting flows
+    static const uint64_t MAX_FLOWS_DEF = 1000000U;
+
+    void
+    set_default();
+    void
+    validate();
+
+    void
+    parse_root(fds_xml_ctx_t *ctx);
+};
+
+#endif // IPFIXCOL2_BIFLOW_CONFIG_HPP
@@ -0,0 +1,363 @@
+/**
+ * \file src/plugins/intermediate/biflow/src/Exporter.cpp
+ * \author agent <agent@local>
+ * \brief Exporter of biflow records (source file)
+ * \date 2026
+ *
+ * Copyright(c) 2026 CESNET z.s.p.o.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include "Exporter.hpp"
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <iterator>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <arpa/inet.h>
+
+/// Maximum size of an IPFIX Message
+static const size_t MSG_MAX_SIZE = UINT16_MAX;
+/// Private Enterprise Number of reverse Information Elements (RFC 5103)
+static const uint32_t PEN_REVERSE = 29305;
+
+/// Field of a Template
+struct tfield {
+    uint32_t pen;  ///< Private Enterprise Number
+    uint16_t id;   ///< Information Element ID
+    uint16_t size; ///< Size of the field
+};
+
+/// Addresses of the Template of records with IPv4 addresses
+static const tfield fields_ip4[] = {
+    {0, 8, 4},   // sourceIPv4Address
+    {0, 12, 4},  // destinationIPv4Address
+};
+
+/// Addresses of the Template of records with IPv6 addresses
+static const tfield fields_ip6[] = {
+    {0, 27, 16}, // sourceIPv6Address
+    {0, 28, 16}, // destinationIPv6Address
+};
+
+/// Other fields of both Templates (in the order of Exporter::record_write())
+static const tfield fields_common[] = {
+    {0, 7, 2},             // sourceTransportPort
+    {0, 11, 2},            // destinationTransportPort
+    {0, 4, 1},             // protocolIdentifier
+    {0, 6, 2},             // tcpControlBits
+    {0, 152, 8},           // flowStartMilliseconds
+    {0, 153, 8},           // flowEndMilliseconds
+    {0, 1, 8},             // octetDeltaCount
+    {0, 2, 8},             // packetDeltaCount
+    {PEN_REVERSE, 6, 2},   // reverseTcpControlBits
+    {PEN_REVERSE, 152, 8}, // reverseFlowStartMilliseconds
+    {PEN_REVERSE, 153, 8}, // reverseFlowEndMilliseconds
+    {PEN_REVERSE, 1, 8},   // reverseOctetDeltaCount
+    {PEN_REVERSE, 2, 8},   // reversePacketDeltaCount
+};
+
+/**
+ * @brief Append a Template record to a Template Set
+ * @param[in] tset   Template Set
+ * @param[in] id     Template ID
+ * @param[in] addrs  Fields of addresses
+ * @return Size of a Data Record of the Template
+ */
+static uint16_t
+tmplt_append(std::vector<uint8_t> &tset, uint16_t id, const tfield (&addrs)[2])
+{
+    std::vector<tfield> fields(std::begin(addrs), std::end(addrs));
+    fields.insert(fields.end(), std::begin(fields_common), std::end(fields_common));
+
+    const uint16_t hdr[2] = {htons(id), htons(static_cast<uint16_t>(fields.size()))};
+    const uint8_t *hdr_ptr = reinterpret_cast<const uint8_t *>(hdr);
+    tset.insert(tset.end(), hdr_ptr, hdr_ptr + sizeof(hdr));
+
+    uint16_t rec_size = 0;
+    for (const auto &field : fields) {
+        const uint16_t id_len[2] = {
+            htons(field.id | ((field.pen != 0) ? 0x8000U : 0U)),
+            htons(field.size)
+        };
+        const uint8_t *id_len_ptr = reinterpret_cast<const uint8_t *>(id_len);
+        tset.insert(tset.end(), id_len_ptr, id_len_ptr + sizeof(id_len));
+
+        if (field.pen != 0) {
+            const uint32_t pen = htonl(field.pen);
+            const uint8_t *pen_ptr = reinterpret_cast<const uint8_t *>(&pen);
+            tset.insert(tset.end(), pen_ptr, pen_ptr + 4);
+        }
+        rec_size += field.size;
+    }
+
+    return rec_size;
+}
+
+Exporter::Exporter(ipx_ctx_t *ctx, uint32_t odid)
+    : m_ctx(ctx), m_session(nullptr), m_tmgr(nullptr), m_snap(nullptr),
+      m_rec_size{0, 0}, m_odid(odid), m_seq_num(0), m_opened(false)
+{
+    // Identification of the Transport Session (shown by outputs, e.g. in file names)
+    const std::string name = std::string("biflow:") + ipx_ctx_name_get(ctx);
+    m_session = ipx_session_new_file(name.c_str());
+    if (!m_session) {
+        throw std::runtime_error("Failed to create a Transport Session!");
+    }
+
+    try {
+        tmplt_create();
+    } catch (...) {
+        if (m_tmgr) {
+            fds_tmgr_destroy(m_tmgr);
+        }
+        ipx_session_destroy(m_session);
+        throw;
+    }
+}
+
+Exporter::~Exporter()
+{
+    if (m_opened) {
+        // Other plugins might still use them, see close()
+        return;
+    }
+
+    fds_tmgr_destroy(m_tmgr);
+    ipx_session_destroy(m_session);
+}
+
+/**
+ * @brief Create Templates of biflow records and a Template manager with them
+ * @throw runtime_error on failure
+ */
+void
+Exporter::tmplt_create()
+{
+    // Template Set with both Templates
+    m_tset.resize(FDS_IPFIX_SET_HDR_LEN);
+    const size_t offset_ip6 = m_tset.size();
+    m_rec_size[1] = tmplt_append(m_tset, TMPLT_ID_IP6, fields_ip6);
+    const size_t offset_ip4 = m_tset.size();
+    m_rec_size[0] = tmplt_append(m_tset, TMPLT_ID_IP4, fields_ip4);
+
+    auto *set_hdr = reinterpret_cast<struct fds_ipfix_set_hdr *>(m_tset.data());
+    set_hdr->flowset_id = htons(FDS_IPFIX_SET_TMPLT);
+    set_hdr->length = htons(static_cast<uint16_t>(m_tset.size()));
+
+    // Template manager (Information Elements are defined by the manager)
+    m_tmgr = fds_tmgr_create(FDS_SESSION_FILE);
+    if (!m_tmgr) {
+        throw std::runtime_error("Failed to create a Template manager!");
+    }
+
+    if (fds_tmgr_set_iemgr(m_tmgr, ipx_ctx_iemgr_get(m_ctx)) != FDS_OK
+            || fds_tmgr_set_time(m_tmgr, 0) != FDS_OK) {
+        throw std::runtime_error("Failed to configure the Template manager!");
+    }
+
+    const size_t offsets[] = {offset_ip6, offset_ip4, m_tset.size()};
+    for (size_t i = 0; i < 2; ++i) {
+        auto *trec = reinterpret_cast<struct fds_ipfix_trec *>(m_tset.data() + offsets[i]);
+        uint16_t tmplt_len = static_cast<uint16_t>(offsets[i + 1] - offsets[i]);
+        struct fds_template *tmplt;
+
+        if (fds_template_parse(FDS_TYPE_TEMPLATE, trec, &tmplt_len, &tmplt) != FDS_OK) {
+            throw std::runtime_error("Failed to create a Template of biflow records!");
+        }
+
+        if (fds_tmgr_template_add(m_tmgr, tmplt) != FDS_OK) {
+            fds_template_destroy(tmplt);
+            throw std::runtime_error("Failed to add a Template of biflow records!");
+        }
+    }
+
+    if (fds_tmgr_snapshot_get(m_tmgr, &m_snap) != FDS_OK
+            || fds_tsnapshot_template_get(m_snap, TMPLT_ID_IP4) == nullptr
+            || fds_tsnapshot_template_get(m_snap, TMPLT_ID_IP6) == nullptr) {
+        throw std::runtime_error("Failed to get a Template snapshot!");
+    }
+}
+
+size_t
+Exporter::msg_capacity() const
+{
+    const size_t space = MSG_MAX_SIZE - FDS_IPFIX_MSG_HDR_LEN - FDS_IPFIX_SET_HDR_LEN;
+    return (space - m_tset.size()) / std::max(m_rec_size[0], m_rec_size[1]);
+}
+
+/**
+ * @brief Write a biflow record in the IPFIX format (see fields of Templates)
+ * @param[in]  rec Biflow record
+ * @param[out] out Output buffer (at least the size of a record of the Template)
+ */
+void
+Exporter::record_write(const Biflow &rec, uint8_t *out)
+{
+    const size_t addr_size = rec.ip6 ? 16U : 4U;
+    memcpy(out, rec.src_ip, addr_size);
+    out += addr_size;
+    memcpy(out, rec.dst_ip, addr_size);
+    out += addr_size;
+
+    fds_set_uint_be(out, 2, rec.src_port);
+    fds_set_uint_be(out + 2, 2, rec.dst_port);
+    out[4] = rec.proto;
+    out += 5;
+
+    for (const FlowCounters *cnt : {&rec.fwd, &rec.rev}) {
+        fds_set_uint_be(out, 2, cnt->tcp_flags);
+        fds_set_uint_be(out + 2, 8, cnt->start);
+        fds_set_uint_be(out + 10, 8, cnt->end);
+        fds_set_uint_be(out + 18, 8, cnt->octets);
+        fds_set_uint_be(out + 26, 8, cnt->packets);
+        out += 34;
+    }
+}
+
+/**
+ * @brief Create an IPFIX Message with biflow records
+ * @param[in] recs     Biflow records (of the same address family)
+ * @param[in] idx      Index of the first record
+ * @param[in] cnt      Number of records
+ * @param[in] ip6      Records have IPv6 addresses
+ * @param[in] tset     Add the Template Set
+ * @param[in] exp_time Export Time of the message
+ * @return IPFIX Message (with references to its Sets and Data Records)
+ * @throw bad_alloc in case of a memory allocation error
+ */
+ipx_msg_ipfix_t *
+Exporter::msg_create(const std::vector<const Biflow *> &recs, size_t idx, size_t cnt, bool ip6,
+    bool tset, uint32_t exp_time)
+{
+    const uint16_t rec_size = m_rec_size[ip6];
+    const size_t tset_size = tset ? m_tset.size() : 0;
+    const size_t dset_size = FDS_IPFIX_SET_HDR_LEN + cnt * rec_size;
+    const size_t msg_size = FDS_IPFIX_MSG_HDR_LEN + tset_size + dset_size;
+    assert(msg_size <= MSG_MAX_SIZE);
+
+    uint8_t *buffer = static_cast<uint8_t *>(ipx_utils_buf_alloc(msg_size));
+    if (!buffer) {
+        throw std::bad_alloc();
+    }
+
+    // Message header
+    auto *hdr = reinterpret_cast<struct fds_ipfix_msg_hdr *>(buffer);
+    hdr->version = htons(FDS_IPFIX_VERSION);
+    hdr->length = htons(static_cast<uint16_t>(msg_size));
+    hdr->export_time = htonl(exp_time);
+    hdr->seq_num = htonl(m_seq_num);
+    hdr->odid = htonl(m_odid);
+
+    uint8_t *pos = buffer + FDS_IPFIX_MSG_HDR_LEN;
+    if (tset) {
+        memcpy(pos, m_tset.data(), tset_size);
+        pos += tset_size;
+    }
+
+    auto *dset_hdr = reinterpret_cast<struct fds_ipfix_set_hdr *>(pos);
+    dset_hdr->flowset_id = htons(ip6 ? TMPLT_ID_IP6 : TMPLT_ID_IP4);
+    dset_hdr->length = htons(static_cast<uint16_t>(dset_size));
+    pos += FDS_IPFIX_SET_HDR_LEN;
+
+    for (size_t i = 0; i < cnt; ++i) {
+        record_write(*recs[idx + i], pos + i * rec_size);
+    }
+
+    // Wrap the message and describe its content
+    struct ipx_msg_ctx msg_ctx;
+    memset(&msg_ctx, 0, sizeof(msg_ctx));
+    msg_ctx.session = m_session;
+    msg_ctx.odid = m_odid;
+    msg_ctx.stream = 0;
+
+    ipx_msg_ipfix_t *msg = ipx_msg_ipfix_wrap(m_ctx, &msg_ctx, buffer, m_snap);
+    if (!msg) {
+        ipx_utils_buf_free(buffer);
+        throw std::bad_alloc();
+    }
+
+    // Templates never change
+    ipx_msg_ipfix_get_ctx(msg)->snap_gen = 1;
+
+    m_seq_num += static_cast<uint32_t>(cnt);
+    return msg;
+}
+
+void
+Exporter::send(const std::vector<Biflow> &recs, uint32_t exp_time)
+{
+    if (recs.empty()) {
+        return;
+    }
+
+    if (!m_opened) {
+        // Inform other plugins about the new Transport Session
+        ipx_msg_session_t *msg = ipx_msg_session_create(m_session, IPX_MSG_SESSION_OPEN);
+        if (!msg) {
+            throw std::bad_alloc();
+        }
+        ipx_ctx_msg_pass(m_ctx, ipx_msg_session2base(msg));
+        m_opened = true;
+    }
+
+    // Each Data Set contains records of one Template (i.e. address family)
+    std::vector<const Biflow *> groups[2];
+    for (const auto &rec : recs) {
+        groups[rec.ip6].push_back(&rec);
+    }
+
+    // Templates are refreshed in the first message
+    const size_t space = MSG_MAX_SIZE - FDS_IPFIX_MSG_HDR_LEN - FDS_IPFIX_SET_HDR_LEN;
+    bool tset = true;
+
+    for (size_t ip6 = 0; ip6 < 2; ++ip6) {
+        const auto &group = groups[ip6];
+        size_t idx = 0;
+
+        while (idx < group.size()) {
+            const size_t rec_max = (space - (tset ? m_tset.size() : 0)) / m_rec_size[ip6];
+            const size_t cnt = std::min(group.size() - idx, rec_max);
+
+            ipx_msg_ipfix_t *msg = msg_create(group, idx, cnt, ip6 != 0, tset, exp_time);
+            ipx_ctx_msg_pass(m_ctx, ipx_msg_ipfix2base(msg));
+            idx += cnt;
+            tset = false;
+        }
+    }
+}
+
+void
+Exporter::close()
+{
+    if (!m_opened) {
+        return;
+    }
+
+    // Inform other plugins that the Transport Session is closed
+    ipx_msg_session_t *close_event = ipx_msg_session_create(m_session, IPX_MSG_SESSION_CLOSE);
+    if (close_event) {
+        ipx_ctx_msg_pass(m_ctx, ipx_msg_session2base(close_event));
+    }
+
+    /* The session and the Templates cannot be freed because other plugins still have access to
+     * them. Send them as garbage messages after the Transport Session close event.
+     */
+    ipx_msg_garbage_cb session_cb = (ipx_msg_garbage_cb) &ipx_session_destroy;
+    ipx_msg_garbage_cb tmgr_cb = (ipx_msg_garbage_cb) &fds_tmgr_destroy;
+    ipx_msg_garbage_t *session_garbage = ipx_msg_garbage_create(m_session, session_cb);
+    ipx_msg_garbage_t *tmgr_garbage = ipx_msg_garbage_create(m_tmgr, tmgr_cb);
+
+    // If a garbage message cannot be created, its object is leaked (others might still use it)
+    if (session_garbage) {
+        ipx_ctx_msg_pass(m_ctx, ipx_msg_garbage2base(session_garbage));
+    }
+    if (tmgr_garbage) {
+        ipx_ctx_msg_pass(m_ctx, ipx_msg_garbage2base(tmgr_garbage));
+    }
+    if (!session_garbage || !tmgr_garbage) {
+        IPX_CTX_ERROR(m_ctx, "Memory allocation error (%s:%d)", __FILE__, __LINE__);
+    }
+}
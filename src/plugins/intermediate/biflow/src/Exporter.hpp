@@ -0,0 +1,109 @@
+/**
+ * \file src/plugins/intermediate/biflow/src/Exporter.hpp
+ * \author agent <agent@local>
+ * \brief Exporter of biflow records (header file)
+ * \date 2026
+ *
+ * Copyright(c) 2026 CESNET z.s.p.o.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef IPFIXCOL2_BIFLOW_EXPORTER_HPP
+#define IPFIXCOL2_BIFLOW_EXPORTER_HPP
+
+#include <cstdint>
+#include <vector>
+#include <ipfixcol2.h>
+#include <libfds.h>
+
+#include "Stitcher.hpp"
+
+/**
+ * @brief Exporter of biflow records
+ *
+ * Biflow records are passed to the next plugins as IPFIX Messages of a Transport Session
+ * of the exporter (i.e. not of any real exporter), so (Options) Templates of real exporters
+ * cannot collide with Templates of biflow records. Messages are already parsed, i.e.
+ * references to their Sets and Data Records are filled as if they were processed by the parser.
+ *
+ * There are two Templates (IPv4 and IPv6 addresses) with the same fields otherwise, reverse
+ * fields are defined by RFC 5103.
+ */
+class Exporter {
+public:
+    /**
+     * @brief Create an exporter
+     *
+     * The Transport Session is opened when the first records are exported.
+     * @param[in] ctx   Plugin context
+     * @param[in] odid  Observation Domain ID of IPFIX Messages
+     * @throw runtime_error if the Templates or the Transport Session cannot be created
+     */
+    Exporter(ipx_ctx_t *ctx, uint32_t odid);
+    /**
+     * @brief Destroy the exporter
+     * @note If the Transport Session is open, close() must be called before.
+     */
+    ~Exporter();
+
+    // Disable copy constructors
+    Exporter(const Exporter &other) = delete;
+    Exporter &operator=(const Exporter &other) = delete;
+
+    /**
+     * @brief Pass biflow records to the next plugins
+     * @param[in] recs     Biflow records
+     * @param[in] exp_time Export Time of IPFIX Messages (seconds since UNIX epoch)
+     * @throw bad_alloc in case of a memory allocation error
+     */
+    void
+    send(const std::vector<Biflow> &recs, uint32_t exp_time);
+
+    /**
+     * @brief Close the Transport Session
+     *
+     * Other plugins are informed that the Transport Session has been closed and the session
+     * and the Templates are passed as garbage.
+     */
+    void
+    close();
+
+    /// Get the maximum number of records in one IPFIX Message
+    size_t
+    msg_capacity() const;
+
+private:
+    /// ID of the Template of biflow records with IPv4 addresses
+    static const uint16_t TMPLT_ID_IP4 = 256;
+    /// ID of the Template of biflow records with IPv6 addresses
+    static const uint16_t TMPLT_ID_IP6 = 257;
+
+    /// Plugin context
+    ipx_ctx_t *m_ctx;
+    /// Transport Session of biflow records
+    struct ipx_session *m_session;
+    /// Template manager of the Transport Session
+    fds_tmgr_t *m_tmgr;
+    /// Template snapshot (with both Templates)
+    const fds_tsnapshot_t *m_snap;
+    /// Template Set with both Templates (sent in the first message of each call of send())
+    std::vector<uint8_t> m_tset;
+    /// Size of a biflow record (IPv4, IPv6)
+    uint16_t m_rec_size[2];
+    /// Observation Domain ID
+    uint32_t m_odid;
+    /// Sequence number (i.e. total number of exported Data Records)
+    uint32_t m_seq_num;
+    /// The Transport Session has been opened
+    bool m_opened;
+
+    void
+    tmplt_create();
+    static void
+    record_write(const Biflow &rec, uint8_t *out);
+    ipx_msg_ipfix_t *
+    msg_create(const std::vector<const Biflow *> &recs, size_t idx, size_t cnt, bool ip6,
+        bool tset, uint32_t exp_time);
+};
+
+#endif // IPFIXCOL2_BIFLOW_EXPORTER_HPP
@@ -0,0 +1,390 @@
+/**
+ * \file src/plugins/intermediate/biflow/src/Stitcher.cpp
+ * \author agent <agent@local>
+ * \brief Pairing of uniflow records into biflow records (source file)
+ * \date 2026
+ *
+ * Copyright(c) 2026 CESNET z.s.p.o.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include "Stitcher.hpp"
+#include <algorithm>
+#include <cstring>
+#include <arpa/inet.h>
+
+/// Offset of a field that must be found by fds_drec_find() (e.g. after a variable-length field)
+static const uint16_t OFFSET_FIND = UINT16_MAX;
+/// Offset of a field that is not present in a Template
+static const uint16_t OFFSET_MISSING = UINT16_MAX - 1;
+
+/// IANA Information Elements of uniflow records (in the order of Stitcher::Field)
+static const uint16_t field_ids[] = {
+    8,   // sourceIPv4Address
+    12,  // destinationIPv4Address
+    27,  // sourceIPv6Address
+    28,  // destinationIPv6Address
+    7,   // sourceTransportPort
+    11,  // destinationTransportPort
+    4,   // protocolIdentifier
+    6,   // tcpControlBits
+    152, // flowStartMilliseconds
+    153, // flowEndMilliseconds
+    150, // flowStartSeconds
+    151, // flowEndSeconds
+    1,   // octetDeltaCount
+    2,   // packetDeltaCount
+};
+
+size_t
+Stitcher::KeyHash::operator()(const Key &key) const
+{
+    const uint8_t *data = reinterpret_cast<const uint8_t *>(&key);
+    uint64_t hash = 14695981039346656037ULL;
+
+    for (size_t i = 0; i < sizeof(key); ++i) {
+        hash ^= data[i];
+        hash *= 1099511628211ULL;
+    }
+
+    return static_cast<size_t>(hash);
+}
+
+bool
+Stitcher::KeyEqual::operator()(const Key &lhs, const Key &rhs) const
+{
+    return memcmp(&lhs, &rhs, sizeof(Key)) == 0;
+}
+
+Stitcher::Stitcher(const Config &cfg)
+    : m_timeout(cfg.m_timeout), m_max_flows(cfg.m_max_flows),
+      m_tcache(ipx_tcache_create(sizeof(tcache_rec), 0), &ipx_tcache_destroy)
+{
+    static_assert(sizeof(field_ids) / sizeof(field_ids[0]) == F_CNT, "Invalid fields");
+    if (!m_tcache) {
+        throw std::bad_alloc();
+    }
+
+    // Expiration times are always less than "timeout" seconds ahead, i.e. one lap is enough
+    m_wheel.resize(m_timeout + 1U, nullptr);
+}
+
+/**
+ * @brief Get positions of fields in records of a Template (cached)
+ * @param[in] tmplt Template
+ * @return Positions of fields
+ * @throw bad_alloc in case of a memory allocation error
+ */
+const Stitcher::tcache_rec &
+Stitcher::tcache_get(const struct fds_template *tmplt)
+{
+    auto *cached = static_cast<tcache_rec *>(ipx_tcache_find(m_tcache.get(), tmplt));
+    if (cached) {
+        return *cached;
+    }
+
+    cached = static_cast<tcache_rec *>(ipx_tcache_add(m_tcache.get(), tmplt));
+    if (!cached) {
+        throw std::bad_alloc();
+    }
+
+    tcache_rec &rec = *cached;
+    for (size_t i = 0; i < F_CNT; ++i) {
+        const struct fds_tfield *tfield = fds_template_cfind(tmplt, 0, field_ids[i]);
+        if (!tfield) {
+            rec.fields[i] = {OFFSET_MISSING, 0};
+        } else if (tfield->offset == FDS_IPFIX_VAR_IE_LEN
+                || tfield->length == FDS_IPFIX_VAR_IE_LEN) {
+            rec.fields[i] = {OFFSET_FIND, 0};
+        } else {
+            rec.fields[i] = {tfield->offset, tfield->length};
+        }
+    }
+
+    // Only uniflow records with IP addresses can be paired
+    const bool ip4 = rec.fields[F_SRC_IP4].offset != OFFSET_MISSING
+        && rec.fields[F_DST_IP4].offset != OFFSET_MISSING;
+    const bool ip6 = rec.fields[F_SRC_IP6].offset != OFFSET_MISSING
+        && rec.fields[F_DST_IP6].offset != OFFSET_MISSING;
+    rec.ignore = tmplt->type != FDS_TYPE_TEMPLATE || (tmplt->flags & FDS_TEMPLATE_BIFLOW) != 0
+        || (!ip4 && !ip6);
+
+    return rec;
+}
+
+/**
+ * @brief Convert a Data Record into a (forward only) biflow record
+ *
+ * Missing counters are zeroed.
+ * @param[in]  rec  Data Record
+ * @param[out] flow Biflow record
+ * @return True on success, false if the record cannot be paired (i.e. it's not a uniflow record)
+ */
+bool
+Stitcher::record_parse(struct fds_drec &rec, Biflow &flow)
+{
+    const tcache_rec &cache = tcache_get(rec.tmplt);
+    if (cache.ignore) {
+        return false;
+    }
+
+    const uint8_t *data[F_CNT];
+    uint16_t size[F_CNT];
+
+    for (size_t i = 0; i < F_CNT; ++i) {
+        const location &loc = cache.fields[i];
+        size[i] = 0;
+
+        if (loc.offset == OFFSET_MISSING) {
+            continue;
+        }
+
+        if (loc.offset != OFFSET_FIND) {
+            data[i] = &rec.data[loc.offset];
+            size[i] = loc.size;
+            continue;
+        }
+
+        struct fds_drec_field field;
+        if (fds_drec_find(&rec, 0, field_ids[i], &field) != FDS_EOC) {
+            data[i] = field.data;
+            size[i] = field.size;
+        }
+    }
+
+    memset(&flow, 0, sizeof(flow));
+    if (size[F_SRC_IP4] == 4U && size[F_DST_IP4] == 4U) {
+        memcpy(flow.src_ip, data[F_SRC_IP4], 4U);
+        memcpy(flow.dst_ip, data[F_DST_IP4], 4U);
+        flow.ip6 = false;
+    } else if (size[F_SRC_IP6] == 16U && size[F_DST_IP6] == 16U) {
+        memcpy(flow.src_ip, data[F_SRC_IP6], 16U);
+        memcpy(flow.dst_ip, data[F_DST_IP6], 16U);
+        flow.ip6 = true;
+    } else {
+        return false;
+    }
+
+    auto get_uint = [&](Field idx, uint64_t def) -> uint64_t {
+        uint64_t value;
+        if (size[idx] == 0 || fds_get_uint_be(data[idx], size[idx], &value) != FDS_OK) {
+            return def;
+        }
+        return value;
+    };
+    auto get_time = [&](Field idx_ms, Field idx_sec) -> uint64_t {
+        uint64_t value;
+        if (size[idx_ms] != 0 && fds_get_datetime_lp_be(data[idx_ms], size[idx_ms],
+                FDS_ET_DATE_TIME_MILLISECONDS, &value) == FDS_OK) {
+            return value;
+        }
+        if (size[idx_sec] != 0 && fds_get_datetime_lp_be(data[idx_sec], size[idx_sec],
+                FDS_ET_DATE_TIME_SECONDS, &value) == FDS_OK) {
+            return value;
+        }
+        return 0;
+    };
+
+    flow.src_port = static_cast<uint16_t>(get_uint(F_SRC_PORT, 0));
+    flow.dst_port = static_cast<uint16_t>(get_uint(F_DST_PORT, 0));
+    flow.proto = static_cast<uint8_t>(get_uint(F_PROTO, 0));
+    flow.fwd.tcp_flags = static_cast<uint16_t>(get_uint(F_TCP_FLAGS, 0));
+    flow.fwd.octets = get_uint(F_OCTETS, 0);
+    flow.fwd.packets = get_uint(F_PACKETS, 0);
+    flow.fwd.start = get_time(F_START_MS, F_START_SEC);
+    flow.fwd.end = get_time(F_END_MS, F_END_SEC);
+    return true;
+}
+
+/**
+ * @brief Pair a uniflow record with a waiting record of the opposite direction or let it wait
+ * @param[in] flow    Uniflow record (i.e. the forward direction only)
+ * @param[in] session Transport Session of the record
+ * @param[in] odid    Observation Domain ID of the record
+ * @throw bad_alloc in case of a memory allocation error (the stitcher is not modified)
+ */
+void
+Stitcher::record_add(const Biflow &flow, const void *session, uint32_t odid)
+{
+    // Canonical key, i.e. the same for both directions
+    Key key;
+    memset(&key, 0, sizeof(key));
+    key.session = session;
+    key.odid = odid;
+    key.proto = flow.proto;
+    key.ip6 = flow.ip6;
+
+    const int cmp = memcmp(flow.src_ip, flow.dst_ip, sizeof(flow.src_ip));
+    const bool lo_src = (cmp < 0) || (cmp == 0 && flow.src_port <= flow.dst_port);
+    memcpy(key.lo_ip, lo_src ? flow.src_ip : flow.dst_ip, sizeof(key.lo_ip));
+    memcpy(key.hi_ip, lo_src ? flow.dst_ip : flow.src_ip, sizeof(key.hi_ip));
+    key.lo_port = lo_src ? flow.src_port : flow.dst_port;
+    key.hi_port = lo_src ? flow.dst_port : flow.src_port;
+
+    auto it = m_table.find(key);
+    if (it != m_table.end()) {
+        Entry &entry = it->second;
+        const bool loop = (cmp == 0 && flow.src_port == flow.dst_port);
+
+        if (entry.lo_src != lo_src || loop) {
+            // The opposite direction
+            Biflow biflow = entry.flow;
+            biflow.rev = flow.fwd;
+            m_ready.push_back(biflow);
+            m_stat_paired += 2;
+
+            wheel_remove(&entry);
+            m_table.erase(it);
+            return;
+        }
+
+        // The same direction again (e.g. an active timeout of the exporter), pass the older one
+        m_ready.push_back(entry.flow);
+        m_stat_unpaired++;
+
+        wheel_remove(&entry);
+        entry.flow = flow;
+        entry.expire = m_time + m_timeout;
+        wheel_insert(&entry);
+        return;
+    }
+
+    if (m_table.size() >= m_max_flows) {
+        // Too many waiting flows, pass the record without the opposite direction
+        m_ready.push_back(flow);
+        m_stat_unpaired++;
+        return;
+    }
+
+    auto res = m_table.emplace(key, Entry());
+    Entry &entry = res.first->second;
+    entry.flow = flow;
+    entry.lo_src = lo_src;
+    entry.expire = m_time + m_timeout;
+    entry.key = &res.first->first;
+    wheel_insert(&entry);
+}
+
+uint32_t
+Stitcher::process_msg(ipx_msg_ipfix_t *msg, uint8_t *keep)
+{
+    const uint32_t rec_cnt = ipx_msg_ipfix_get_drec_cnt(msg);
+    const struct ipx_msg_ctx *msg_ctx = ipx_msg_ipfix_get_ctx(msg);
+    ipx_tcache_clear(m_tcache.get());
+
+    // Records are kept until they are added (i.e. the remaining ones are kept on failure)
+    std::fill(keep, keep + rec_cnt, 1);
+
+    // Time of the wheel is given by Export Time of messages
+    const auto *hdr = reinterpret_cast<fds_ipfix_msg_hdr *>(ipx_msg_ipfix_get_packet(msg));
+    time_advance(ntohl(hdr->export_time));
+
+    uint32_t kept = rec_cnt;
+    for (uint32_t i = 0; i < rec_cnt; ++i) {
+        struct fds_drec &rec = ipx_msg_ipfix_get_drec(msg, i)->rec;
+        Biflow flow;
+
+        if (!record_parse(rec, flow)) {
+            continue;
+        }
+
+        record_add(flow, msg_ctx->session, msg_ctx->odid);
+        keep[i] = 0;
+        kept--;
+    }
+
+    return kept;
+}
+
+/**
+ * @brief Move the time of the timer wheel and expire all entries in the skipped slots
+ *
+ * The time never goes back, i.e. records of late messages wait a bit longer.
+ * @param[in] now Current time (seconds since UNIX epoch)
+ * @throw bad_alloc in case of a memory allocation error
+ */
+void
+Stitcher::time_advance(uint32_t now)
+{
+    if (!m_time_valid) {
+        m_time = now;
+        m_time_valid = true;
+        return;
+    }
+
+    if (now <= m_time) {
+        return;
+    }
+
+    // Each slot is processed at most once (i.e. a long gap expires all entries)
+    const uint64_t slots = m_wheel.size();
+    const uint64_t steps = std::min<uint64_t>(now - m_time, slots);
+    for (uint64_t i = 1; i <= steps; ++i) {
+        Entry *&head = m_wheel[(m_time + i) % slots];
+        while (head != nullptr) {
+            entry_expire(head);
+        }
+    }
+
+    m_time = now;
+}
+
+void
+Stitcher::expire_all()
+{
+    for (auto &head : m_wheel) {
+        while (head != nullptr) {
+            entry_expire(head);
+        }
+    }
+}
+
+/**
+ * @brief Pass a waiting flow without the opposite direction and remove it
+ * @param[in] entry Entry to remove
+ * @throw bad_alloc in case of a memory allocation error (the entry is not removed)
+ */
+void
+Stitcher::entry_expire(Entry *entry)
+{
+    m_ready.push_back(entry->flow);
+    m_stat_unpaired++;
+
+    wheel_remove(entry);
+    const Key key = *entry->key;
+    m_table.erase(key);
+}
+
+/**
+ * @brief Add an entry to the slot of its expiration time
+ * @param[in] entry Entry
+ */
+void
+Stitcher::wheel_insert(Entry *entry)
+{
+    Entry *&head = m_wheel[entry->expire % m_wheel.size()];
+    entry->prev = nullptr;
+    entry->next = head;
+    if (head != nullptr) {
+        head->prev = entry;
+    }
+    head = entry;
+}
+
+/**
+ * @brief Remove an entry from its slot
+ * @param[in] entry Entry
+ */
+void
+Stitcher::wheel_remove(Entry *entry)
+{
+    if (entry->prev != nullptr) {
+        entry->prev->next = entry->next;
+    } else {
+        m_wheel[entry->expire % m_wheel.size()] = entry->next;
+    }
+
+    if (entry->next != nullptr) {
+        entry->next->prev = entry->prev;
+    }
+}
@@ -0,0 +1,194 @@
+/**
+ * \file src/plugins/intermediate/biflow/src/Stitcher.hpp
+ * \author agent <agent@local>
+ * \brief Pairing of uniflow records into biflow records (header file)
+ * \date 2026
+ *
+ * Copyright(c) 2026 CESNET z.s.p.o.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef IPFIXCOL2_BIFLOW_STITCHER_HPP
+#define IPFIXCOL2_BIFLOW_STITCHER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+#include <ipfixcol2.h>
+#include <libfds.h>
+
+#include "Config.hpp"
+
+/// Counters of one direction of a flow
+struct FlowCounters {
+    uint64_t start;     ///< Start of the flow (milliseconds since UNIX epoch)
+    uint64_t end;       ///< End of the flow (milliseconds since UNIX epoch)
+    uint64_t octets;    ///< Number of octets
+    uint64_t packets;   ///< Number of packets
+    uint16_t tcp_flags; ///< Cumulative TCP flags
+};
+
+/**
+ * @brief Biflow record (RFC 5103)
+ *
+ * The forward direction is the direction of the first received uniflow. If the opposite
+ * direction has not been received, reverse counters are zeros.
+ */
+struct Biflow {
+    uint8_t src_ip[16];   ///< Source address (IPv4 in the first 4 bytes)
+    uint8_t dst_ip[16];   ///< Destination address (IPv4 in the first 4 bytes)
+    uint16_t src_port;    ///< Source port
+    uint16_t dst_port;    ///< Destination port
+    uint8_t proto;        ///< Protocol
+    bool ip6;             ///< IPv6 (true) or IPv4 (false) addresses
+    FlowCounters fwd;     ///< Counters of the forward direction
+    FlowCounters rev;     ///< Counters of the reverse direction
+};
+
+/**
+ * @brief Pairing of uniflow records into biflow records
+ *
+ * Uniflow records wait in a hash table (keyed on the canonical 5-tuple, i.e. the same for
+ * both directions, and the exporter) for records of the opposite direction. Expiration of
+ * waiting records is driven by a timer wheel with one slot per second, whose time is given
+ * by Export Time of processed messages. Paired records and expired records (without the
+ * reverse direction) are collected as biflow records, see ready().
+ */
+class Stitcher {
+public:
+    /**
+     * @brief Create a stitcher
+     * @param[in] cfg Configuration of the plugin
+     * @throw bad_alloc in case of a memory allocation error
+     */
+    Stitcher(const Config &cfg);
+    ~Stitcher() = default;
+
+    // Disable copy constructors
+    Stitcher(const Stitcher &other) = delete;
+    Stitcher &operator=(const Stitcher &other) = delete;
+
+    /**
+     * @brief Process all Data Records of an IPFIX Message
+     *
+     * Records that are not uniflow records (e.g. without IP addresses, biflow records
+     * or Options records) are not processed and should be passed as they are.
+     * @param[in]  msg  IPFIX Message
+     * @param[out] keep Flags of records to keep in the message (at least as many as records),
+     *   valid even if an exception is thrown
+     * @return Number of records to keep
+     * @throw bad_alloc in case of a memory allocation error
+     */
+    uint32_t
+    process_msg(ipx_msg_ipfix_t *msg, uint8_t *keep);
+
+    /**
+     * @brief Expire all waiting flows (i.e. they become biflow records without the reverse)
+     * @throw bad_alloc in case of a memory allocation error
+     */
+    void
+    expire_all();
+
+    /// Get the current time of the timer wheel (seconds since UNIX epoch)
+    uint32_t
+    time() const { return m_time; }
+    /// Get biflow records ready to be passed
+    const std::vector<Biflow> &
+    ready() const { return m_ready; }
+    /// Remove biflow records ready to be passed
+    void
+    ready_clear() { m_ready.clear(); }
+
+    /// Number of paired uniflow records (i.e. twice the number of biflow records)
+    uint64_t m_stat_paired = 0;
+    /// Number of uniflow records without the opposite direction
+    uint64_t m_stat_unpaired = 0;
+
+private:
+    /// Key of a waiting flow (canonical 5-tuple, i.e. the lower endpoint first)
+    struct Key {
+        const void *session;  ///< Transport Session (identification only)
+        uint32_t odid;        ///< Observation Domain ID
+        uint8_t lo_ip[16];    ///< Address of the lower endpoint
+        uint8_t hi_ip[16];    ///< Address of the higher endpoint
+        uint16_t lo_port;     ///< Port of the lower endpoint
+        uint16_t hi_port;     ///< Port of the higher endpoint
+        uint8_t proto;        ///< Protocol
+        uint8_t ip6;          ///< IPv6 addresses
+    };
+
+    /// Hash of a key (64-bit FNV-1a of all bytes, the key is zeroed before use)
+    struct KeyHash {
+        size_t operator()(const Key &key) const;
+    };
+    /// Comparison of keys
+    struct KeyEqual {
+        bool operator()(const Key &lhs, const Key &rhs) const;
+    };
+
+    /// Waiting flow
+    struct Entry {
+        Biflow flow;          ///< The received direction (reverse counters are unused)
+        bool lo_src;          ///< The source of the flow is the lower endpoint
+        uint32_t expire;      ///< Expiration time (seconds since UNIX epoch)
+        const Key *key;       ///< Key of the entry in the table
+        Entry *prev;          ///< Previous entry in the slot of the timer wheel
+        Entry *next;          ///< Next entry in the slot of the timer wheel
+    };
+
+    /// Fields of uniflow records (indexes into positions of fields in a Template)
+    enum Field {
+        F_SRC_IP4, F_DST_IP4, F_SRC_IP6, F_DST_IP6, F_SRC_PORT, F_DST_PORT, F_PROTO,
+        F_TCP_FLAGS, F_START_MS, F_END_MS, F_START_SEC, F_END_SEC, F_OCTETS, F_PACKETS,
+        F_CNT
+    };
+
+    /// Position of a field in records of a Template
+    struct location {
+        uint16_t offset; ///< Offset of the field in a record (FIND, MISSING or a real offset)
+        uint16_t size;   ///< Size of the field in a record
+    };
+
+    /// Positions of fields in records of a Template
+    struct tcache_rec {
+        bool ignore;            ///< Records of the Template are not uniflows
+        location fields[F_CNT]; ///< Positions of fields
+    };
+
+    /// Maximum time to wait for the opposite direction
+    uint32_t m_timeout;
+    /// Maximum number of waiting flows
+    uint64_t m_max_flows;
+    /// Current time of the timer wheel (valid only if m_time_valid is true)
+    uint32_t m_time = 0;
+    /// The timer wheel has been started
+    bool m_time_valid = false;
+    /// Waiting flows
+    std::unordered_map<Key, Entry, KeyHash, KeyEqual> m_table;
+    /// Timer wheel (heads of lists of entries expiring in the same second)
+    std::vector<Entry *> m_wheel;
+    /// Biflow records ready to be passed
+    std::vector<Biflow> m_ready;
+    /// Positions of fields in Templates of the processed message (see tcache_rec)
+    std::unique_ptr<ipx_tcache_t, decltype(&ipx_tcache_destroy)> m_tcache;
+
+    const tcache_rec &
+    tcache_get(const struct fds_template *tmplt);
+    bool
+    record_parse(struct fds_drec &rec, Biflow &flow);
+    void
+    record_add(const Biflow &flow, const void *session, uint32_t odid);
+
+    void
+    time_advance(uint32_t now);
+    void
+    wheel_insert(Entry *entry);
+    void
+    wheel_remove(Entry *entry);
+    void
+    entry_expire(Entry *entry);
+};
+
+#endif // IPFIXCOL2_BIFLOW_STITCHER_HPP
@@ -0,0 +1,150 @@
+/**
+ * \file src/plugins/intermediate/biflow/src/biflow.cpp
+ * \author agent <agent@local>
+ * \brief Pairing of uniflow records into biflow records (intermediate plugin)
+ * \date 2026
+ *
+ * Copyright(c) 2026 CESNET z.s.p.o.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include <algorithm>
+#include <cinttypes>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+#include <ipfixcol2.h>
+
+#include "Config.hpp"
+#include "Exporter.hpp"
+#include "Stitcher.hpp"
+
+/// Plugin description
+IPX_API struct ipx_plugin_info ipx_plugin_info = {
+    // Plugin identification name
+    "biflow",
+    // Brief description of plugin
+    "Pairing of uniflow records into biflow records (RFC 5103)",
+    // Plugin type
+    IPX_PT_INTERMEDIATE,
+    // Configuration flags (reserved for future use)
+    0,
+    // Plugin version string (like "1.2.3")
+    "2.0.0",
+    // Minimal IPFIXcol version string (like "1.2.3")
+    "2.0.0"
+};
+
+/// Instance
+struct Instance {
+    /// Parsed configuration
+    std::unique_ptr<Config> config_ptr = nullptr;
+    /// Pairing of uniflow records
+    std::unique_ptr<Stitcher> stitcher_ptr = nullptr;
+    /// Exporter of biflow records
+    std::unique_ptr<Exporter> exporter_ptr = nullptr;
+    /// Flags of records of the processed message to keep
+    std::vector<uint8_t> keep;
+    /// Time of the last pass of biflow records
+    uint32_t flush_time = 0;
+};
+
+/**
+ * @brief Pass all biflow records that are ready and remove them
+ * @param[in] inst Instance
+ */
+static void
+flush(struct Instance &inst)
+{
+    Stitcher &stitcher = *inst.stitcher_ptr;
+    inst.flush_time = stitcher.time();
+
+    try {
+        inst.exporter_ptr->send(stitcher.ready(), stitcher.time());
+    } catch (...) {
+        // Records might have been partly passed, don't pass them again
+        stitcher.ready_clear();
+        throw;
+    }
+    stitcher.ready_clear();
+}
+
+int
+ipx_plugin_init(ipx_ctx_t *ctx, const char *params)
+{
+    try {
+        std::unique_ptr<Instance> instance(new Instance);
+        instance->config_ptr.reset(new Config(params));
+        instance->stitcher_ptr.reset(new Stitcher(*instance->config_ptr));
+        instance->exporter_ptr.reset(new Exporter(ctx, instance->config_ptr->m_odid));
+        ipx_ctx_private_set(ctx, instance.release());
+    } catch (const std::exception &ex) {
+        IPX_CTX_ERROR(ctx, "Initialization failed: %s", ex.what());
+        return IPX_ERR_DENIED;
+    } catch (...) {
+        IPX_CTX_ERROR(ctx, "Unknown error has occurred!", '\0');
+        return IPX_ERR_DENIED;
+    }
+
+    return IPX_OK;
+}
+
+void
+ipx_plugin_destroy(ipx_ctx_t *ctx, void *cfg)
+{
+    auto inst = reinterpret_cast<Instance *>(cfg);
+    const Stitcher &stitcher = *inst->stitcher_ptr;
+
+    try {
+        // Pass flows still waiting for the opposite direction
+        inst->stitcher_ptr->expire_all();
+        flush(*inst);
+    } catch (const std::exception &ex) {
+        IPX_CTX_ERROR(ctx, "Failed to pass waiting flow records: %s", ex.what());
+    }
+
+    inst->exporter_ptr->close();
+    IPX_CTX_INFO(ctx, "Paired %" PRIu64 " uniflow records, %" PRIu64 " records without the "
+        "opposite direction", stitcher.m_stat_paired, stitcher.m_stat_unpaired);
+    delete inst;
+}
+
+int
+ipx_plugin_process(ipx_ctx_t *ctx, void *cfg, ipx_msg_t *msg)
+{
+    auto inst = reinterpret_cast<Instance *>(cfg);
+    Stitcher &stitcher = *inst->stitcher_ptr;
+    ipx_msg_ipfix_t *msg_ipfix = ipx_msg_base2ipfix(msg);
+    const uint32_t rec_cnt = ipx_msg_ipfix_get_drec_cnt(msg_ipfix);
+    uint32_t kept = rec_cnt;
+
+    try {
+        inst->keep.resize(rec_cnt);
+        kept = stitcher.process_msg(msg_ipfix, inst->keep.data());
+    } catch (const std::exception &ex) {
+        IPX_CTX_ERROR(ctx, "Failed to pair records: %s", ex.what());
+        if (inst->keep.size() >= rec_cnt) {
+            kept = static_cast<uint32_t>(std::count(inst->keep.begin(),
+                inst->keep.begin() + rec_cnt, 1));
+        }
+    }
+
+    // Records that are waiting or paired are removed from the message, others are passed
+    if (kept != rec_cnt) {
+        ipx_msg_ipfix_drec_compact(msg_ipfix, inst->keep.data());
+    }
+    ipx_ctx_msg_pass(ctx, msg);
+
+    // Biflow records are passed in full messages or at least once per second
+    const size_t ready = stitcher.ready().size();
+    if (ready > 0 && (ready >= inst->exporter_ptr->msg_capacity()
+            || stitcher.time() != inst->flush_time)) {
+        try {
+            flush(*inst);
+        } catch (const std::exception &ex) {
+            IPX_CTX_ERROR(ctx, "Failed to pass biflow records: %s", ex.what());
+        }
+    }
+
+    return IPX_OK;
+}
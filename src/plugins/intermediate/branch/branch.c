@@ -0,0 +1,193 @@
+/**
+ * \file src/plugins/intermediate/branch/branch.c
+ * \author agent <agent@local>
+ * \brief Copy-on-write branches of the pipeline for IPFIXcol2
+ * \date 2026
+ */
+
+
+/* Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is'', and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#include <ipfixcol2.h>
+#include <stdlib.h>
+#include <inttypes.h>
+
+/** Plugin description */
+IPX_API struct ipx_plugin_info ipx_plugin_info = {
+    // Plugin type
+    .type = IPX_PT_INTERMEDIATE,
+    // Plugin identification name
+    .name = "branch",
+    // Brief description of plugin
+    .dsc = "Copy-on-write branches of the pipeline",
+    // Configuration flags (reserved for future use)
+    .flags = 0,
+    // Plugin version string (like "1.2.3")
+    .version = "2.0.0",
+    // Minimal IPFIXcol version string (like "1.2.3")
+    .ipx_min = "2.0.0"
+};
+
+/*
+ * <params>
+ *  <id>...</id>            <!-- identification of the new branch -->
+ * </params>
+ */
+
+/** XML nodes */
+enum params_xml_nodes {
+    BRANCH_ID = 1
+};
+
+/** Definition of the \<params\> node  */
+static const struct fds_xml_args args_params[] = {
+    FDS_OPTS_ROOT("params"),
+    FDS_OPTS_ELEM(BRANCH_ID, "id", FDS_OPTS_T_UINT, 0),
+    FDS_OPTS_END
+};
+
+/** Instance data */
+struct instance_data {
+    /** Identification of the new branch  */
+    uint16_t id;
+    /** Number of created copies          */
+    uint64_t copies;
+    /** Number of failed copies           */
+    uint64_t failed;
+};
+
+/**
+ * \brief Parse configuration of the plugin
+ * \param[in] ctx    Instance context
+ * \param[in] params XML parameters
+ * \param[in] data   Instance data to fill
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_FORMAT if arguments are not valid or if a memory allocation error has occurred
+ */
+static int
+config_parse(ipx_ctx_t *ctx, const char *params, struct instance_data *data)
+{
+    fds_xml_t *parser = fds_xml_create();
+    if (!parser) {
+        IPX_CTX_ERROR(ctx, "Memory allocation error (%s:%d)", __FILE__, __LINE__);
+        return IPX_ERR_FORMAT;
+    }
+
+    if (fds_xml_set_args(parser, args_params) != IPX_OK) {
+        IPX_CTX_ERROR(ctx, "Failed to parse the description of an XML document!", '\0');
+        fds_xml_destroy(parser);
+        return IPX_ERR_FORMAT;
+    }
+
+    fds_xml_ctx_t *params_ctx = fds_xml_parse_mem(parser, params, true);
+    if (params_ctx == NULL) {
+        IPX_CTX_ERROR(ctx, "Failed to parse the configuration: %s", fds_xml_last_err(parser));
+        fds_xml_destroy(parser);
+        return IPX_ERR_FORMAT;
+    }
+
+    int rc = IPX_OK;
+    const struct fds_xml_cont *content;
+    while (fds_xml_next(params_ctx, &content) != FDS_EOC) {
+        assert(content->id == BRANCH_ID && content->type == FDS_OPTS_T_UINT);
+        if (content->val_uint == 0 || content->val_uint > UINT16_MAX) {
+            // Branch 0 is the main branch of the pipeline
+            IPX_CTX_ERROR(ctx, "Branch <id> must be between 1..%u!", UINT16_MAX);
+            rc = IPX_ERR_FORMAT;
+            break;
+        }
+        data->id = (uint16_t) content->val_uint;
+    }
+
+    fds_xml_destroy(parser);
+    return rc;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+int
+ipx_plugin_init(ipx_ctx_t *ctx, const char *params)
+{
+    // Create a private data
+    struct instance_data *data = calloc(1, sizeof(*data));
+    if (!data) {
+        return IPX_ERR_DENIED;
+    }
+
+    if (config_parse(ctx, params, data) != IPX_OK) {
+        free(data);
+        return IPX_ERR_DENIED;
+    }
+
+    ipx_ctx_private_set(ctx, data);
+    return IPX_OK;
+}
+
+void
+ipx_plugin_destroy(ipx_ctx_t *ctx, void *cfg)
+{
+    struct instance_data *data = (struct instance_data *) cfg;
+
+    IPX_CTX_INFO(ctx, "%" PRIu64 " IPFIX Messages have been passed to the branch %" PRIu16,
+        data->copies, data->id);
+    if (data->failed > 0) {
+        IPX_CTX_WARNING(ctx, "%" PRIu64 " IPFIX Messages have not been passed to the branch %"
+            PRIu16 " due to memory allocation errors", data->failed, data->id);
+    }
+
+    free(data);
+}
+
+int
+ipx_plugin_process(ipx_ctx_t *ctx, void *cfg, ipx_msg_t *msg)
+{
+    struct instance_data *data = (struct instance_data *) cfg;
+    ipx_msg_ipfix_t *ipfix_msg = ipx_msg_base2ipfix(msg);
+
+    // The copy shares the raw packet, i.e. it must be created before the original is passed
+    ipx_msg_ipfix_t *copy = ipx_msg_ipfix_branch_create(ipfix_msg, data->id);
+    ipx_ctx_msg_pass(ctx, msg);
+
+    if (!copy) {
+        // The original branch is not affected
+        IPX_CTX_ERROR(ctx, "Memory allocation error (%s:%d)", __FILE__, __LINE__);
+        data->failed++;
+        return IPX_OK;
+    }
+
+    ipx_ctx_msg_pass(ctx, ipx_msg_ipfix2base(copy));
+    data->copies++;
+    return IPX_OK;
+}
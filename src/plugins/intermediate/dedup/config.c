@@ -0,0 +1,198 @@
+/**
+ * \file src/plugins/intermediate/dedup/config.c
+ * \author agent <agent@local>
+ * \brief Configuration parser of deduplication plugin
+ * \date 2026
+ */
+
+/* Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is'', and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <inttypes.h>
+#include "config.h"
+
+/*
+ * <params>
+ *  <mode>...</mode>        <!-- optional, drop/mark -->
+ *  <window>...</window>    <!-- optional, time window (seconds) -->
+ *  <tolerance>...</tolerance> <!-- optional, difference of timestamps (milliseconds) -->
+ *  <capacity>...</capacity>   <!-- optional, unique records per window -->
+ * </params>
+ */
+
+/** Default time window (seconds)                  */
+#define DEF_WINDOW    (10U)
+/** Default tolerance of timestamps (milliseconds) */
+#define DEF_TOLERANCE (1000U)
+/** Default capacity (records per window)          */
+#define DEF_CAPACITY  (1000000U)
+/** Maximum capacity (records per window)          */
+#define MAX_CAPACITY  (1ULL << 32)
+
+/** XML nodes */
+enum params_xml_nodes {
+    DEDUP_MODE = 1,
+    DEDUP_WINDOW,
+    DEDUP_TOLERANCE,
+    DEDUP_CAPACITY
+};
+
+/** Definition of the \<params\> node  */
+static const struct fds_xml_args args_params[] = {
+    FDS_OPTS_ROOT("params"),
+    FDS_OPTS_ELEM(DEDUP_MODE, "mode", FDS_OPTS_T_STRING, FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM(DEDUP_WINDOW, "window", FDS_OPTS_T_UINT, FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM(DEDUP_TOLERANCE, "tolerance", FDS_OPTS_T_UINT, FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM(DEDUP_CAPACITY, "capacity", FDS_OPTS_T_UINT, FDS_OPTS_P_OPT),
+    FDS_OPTS_END
+};
+
+/**
+ * \brief Process \<params\> node
+ * \param[in] ctx  Plugin context
+ * \param[in] root XML context to process
+ * \param[in] cfg  Parsed configuration
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_FORMAT in case of failure
+ */
+static int
+config_parser_root(ipx_ctx_t *ctx, fds_xml_ctx_t *root, struct dedup_config *cfg)
+{
+    const struct fds_xml_cont *content;
+    while (fds_xml_next(root, &content) != FDS_EOC) {
+        switch (content->id) {
+        case DEDUP_MODE:
+            assert(content->type == FDS_OPTS_T_STRING);
+            if (strcasecmp(content->ptr_string, "drop") == 0) {
+                cfg->mode = DEDUP_DROP;
+            } else if (strcasecmp(content->ptr_string, "mark") == 0) {
+                cfg->mode = DEDUP_MARK;
+            } else {
+                IPX_CTX_ERROR(ctx, "Unrecognized <mode> of deduplication (drop/mark expected).",
+                    '\0');
+                return IPX_ERR_FORMAT;
+            }
+            break;
+        case DEDUP_WINDOW:
+            assert(content->type == FDS_OPTS_T_UINT);
+            if (content->val_uint == 0 || content->val_uint > 3600) {
+                IPX_CTX_ERROR(ctx, "Time <window> must be between 1..3600 seconds!", '\0');
+                return IPX_ERR_FORMAT;
+            }
+            cfg->window = (uint32_t) content->val_uint;
+            break;
+        case DEDUP_TOLERANCE:
+            assert(content->type == FDS_OPTS_T_UINT);
+            if (content->val_uint == 0 || content->val_uint > 60000) {
+                IPX_CTX_ERROR(ctx, "Timestamp <tolerance> must be between 1..60000 "
+                    "milliseconds!", '\0');
+                return IPX_ERR_FORMAT;
+            }
+            cfg->tolerance = (uint32_t) content->val_uint;
+            break;
+        case DEDUP_CAPACITY:
+            assert(content->type == FDS_OPTS_T_UINT);
+            if (content->val_uint == 0 || content->val_uint > MAX_CAPACITY) {
+                IPX_CTX_ERROR(ctx, "<capacity> must be between 1..%" PRIu64 " records!",
+                    (uint64_t) MAX_CAPACITY);
+                return IPX_ERR_FORMAT;
+            }
+            cfg->capacity = content->val_uint;
+            break;
+        default:
+            // Internal error
+            assert(false);
+        }
+    }
+
+    return IPX_OK;
+}
+
+struct dedup_config *
+config_parse(ipx_ctx_t *ctx, const char *params)
+{
+    struct dedup_config *cfg = calloc(1, sizeof(*cfg));
+    if (!cfg) {
+        IPX_CTX_ERROR(ctx, "Memory allocation error (%s:%d)", __FILE__, __LINE__);
+        return NULL;
+    }
+
+    // Set default parameters
+    cfg->mode = DEDUP_DROP;
+    cfg->window = DEF_WINDOW;
+    cfg->tolerance = DEF_TOLERANCE;
+    cfg->capacity = DEF_CAPACITY;
+
+    // Create an XML parser
+    fds_xml_t *parser = fds_xml_create();
+    if (!parser) {
+        IPX_CTX_ERROR(ctx, "Memory allocation error (%s:%d)", __FILE__, __LINE__);
+        free(cfg);
+        return NULL;
+    }
+
+    if (fds_xml_set_args(parser, args_params) != IPX_OK) {
+        IPX_CTX_ERROR(ctx, "Failed to parse the description of an XML document!", '\0');
+        fds_xml_destroy(parser);
+        free(cfg);
+        return NULL;
+    }
+
+    fds_xml_ctx_t *params_ctx = fds_xml_parse_mem(parser, params, true);
+    if (params_ctx == NULL) {
+        IPX_CTX_ERROR(ctx, "Failed to parse the configuration: %s", fds_xml_last_err(parser));
+        fds_xml_destroy(parser);
+        free(cfg);
+        return NULL;
+    }
+
+    // Parse parameters
+    int rc = config_parser_root(ctx, params_ctx, cfg);
+    fds_xml_destroy(parser);
+    if (rc != IPX_OK) {
+        config_destroy(cfg);
+        return NULL;
+    }
+
+    return cfg;
+}
+
+void
+config_destroy(struct dedup_config *cfg)
+{
+    free(cfg);
+}
@@ -0,0 +1,738 @@
+/**
+ * \file src/plugins/intermediate/dedup/dedup.c
+ * \author agent <agent@local>
+ * \brief Cross-exporter deduplication of flow records for IPFIXcol2
+ * \date 2026
+ */
+
+/* Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is'', and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#include <ipfixcol2.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#include <time.h>
+
+#include "config.h"
+
+/** Plugin description */
+IPX_API struct ipx_plugin_info ipx_plugin_info = {
+    // Plugin type
+    .type = IPX_PT_INTERMEDIATE,
+    // Plugin identification name
+    .name = "dedup",
+    // Brief description of plugin
+    .dsc = "Detection of flow records exported by multiple exporters",
+    // Configuration flags (reserved for future use)
+    .flags = 0,
+    // Plugin version string (like "1.2.3")
+    .version = "2.0.0",
+    // Minimal IPFIXcol version string (like "1.2.3")
+    .ipx_min = "2.0.0"
+};
+
+/** Type of the extension with flags of duplicate records (1 byte per record, non-zero = dup.) */
+#define DEDUP_EXT_TYPE "dedup-v1"
+/** Name of the extension with flags of duplicate records                                */
+#define DEDUP_EXT_NAME "duplicate"
+
+/** Maximum number of different Templates cached per message                            */
+#define TCACHE_SIZE  (16U)
+
+/** Number of time slices of the window (the oldest one is cleared on rotation)          */
+#define SLICE_CNT    (4U)
+/** Number of entries in a bucket of a cuckoo filter                                     */
+#define BUCKET_SIZE  (4U)
+/** Maximum number of relocations of entries during an insertion                         */
+#define MAX_KICKS    (500U)
+/** Maximum expected load factor of a cuckoo filter (percent)                            */
+#define MAX_LOAD     (90U)
+/** Maximum load factor of a cuckoo filter (percent), a fuller slice doesn't accept entries */
+#define FULL_LOAD    (95U)
+
+/** Fields of the flow key (indexes into the cache of a Template) */
+enum key_fields {
+    KEY_SRC_IP4,
+    KEY_DST_IP4,
+    KEY_SRC_IP6,
+    KEY_DST_IP6,
+    KEY_SRC_PORT,
+    KEY_DST_PORT,
+    KEY_PROTO,
+    KEY_START_MS,
+    KEY_START_SEC,
+    KEY_CNT
+};
+
+/** Information Elements of the flow key (in the order of ::key_fields, all IANA) */
+static const uint16_t key_ids[KEY_CNT] = {
+    8,   // sourceIPv4Address
+    12,  // destinationIPv4Address
+    27,  // sourceIPv6Address
+    28,  // destinationIPv6Address
+    7,   // sourceTransportPort
+    11,  // destinationTransportPort
+    4,   // protocolIdentifier
+    152, // flowStartMilliseconds
+    150, // flowStartSeconds
+};
+
+/** Key fields of a Template */
+struct tcache_rec {
+    /** Offsets of fields are not known (i.e. a field is placed after a variable-length
+     *  field) and key fields must be found by fds_drec_find()                          */
+    bool use_find;
+    /** Offsets of key fields from the start of a record                                */
+    uint16_t offsets[KEY_CNT];
+    /** Sizes of key fields (0 == not present)                                          */
+    uint16_t sizes[KEY_CNT];
+};
+
+/**
+ * \brief Normalized flow key
+ *
+ * IPv4 addresses are stored as IPv4-mapped IPv6 addresses, missing fields are zeros.
+ */
+struct flow_key {
+    /** Source address                                                                  */
+    uint8_t src_ip[16];
+    /** Destination address                                                             */
+    uint8_t dst_ip[16];
+    /** Source port                                                                     */
+    uint16_t src_port;
+    /** Destination port                                                                */
+    uint16_t dst_port;
+    /** Protocol                                                                        */
+    uint8_t proto;
+};
+
+/**
+ * \brief Time slice of the window (cuckoo filter)
+ *
+ * Each entry consists of a fingerprint of a flow key (upper 32 bits, never zero) and a tag
+ * of the Transport Session and ODID which exported the record (lower 32 bits). Zero entries
+ * are empty.
+ */
+struct slice {
+    /** Entries (buckets of BUCKET_SIZE entries)                                        */
+    uint64_t *entries;
+    /** Number of occupied entries                                                      */
+    uint64_t used;
+};
+
+/** Instance */
+struct instance_data {
+    /** Parsed configuration of the instance                                            */
+    struct dedup_config *config;
+    /** Extension with flags of duplicate records (mark mode only)                      */
+    ipx_ctx_ext_t *ext;
+
+    /** Time slices of the window                                                       */
+    struct slice slices[SLICE_CNT];
+    /** Index of the current slice (new entries are inserted here)                      */
+    unsigned int slice_cur;
+    /** Number of buckets of each slice (power of 2)                                    */
+    uint64_t bucket_cnt;
+    /** Maximum number of entries of a slice                                            */
+    uint64_t slice_max;
+    /** Duration of a slice (milliseconds)                                              */
+    uint64_t slice_dur;
+    /** Monotonic start of the current slice (milliseconds)                             */
+    uint64_t slice_start;
+    /** State of the generator of pseudo-random numbers (victims of relocations)        */
+    uint64_t rnd_state;
+
+    /** Key fields of Templates of the processed message (see struct tcache_rec)        */
+    ipx_tcache_t *tcache;
+
+    /** Flags of Data Records of the processed message (drop mode only)                 */
+    struct ipx_drec_flags keep;
+
+    /** Number of processed Data Records                                                */
+    uint64_t recs_total;
+    /** Number of duplicate Data Records                                                */
+    uint64_t recs_dup;
+    /** Number of Data Records without a flow key (never duplicates)                    */
+    uint64_t recs_nokey;
+    /** Number of entries lost due to a full filter                                     */
+    uint64_t lost;
+};
+
+/**
+ * \brief Hash a flow key (64-bit FNV-1a)
+ * \param[in] key Flow key
+ * \return Hash
+ */
+static inline uint64_t
+hash_key(const struct flow_key *key)
+{
+    const uint8_t *parts[] = {key->src_ip, key->dst_ip};
+    uint64_t hash = 14695981039346656037ULL;
+
+    for (size_t p = 0; p < sizeof(parts) / sizeof(parts[0]); ++p) {
+        for (size_t i = 0; i < 16U; ++i) {
+            hash ^= parts[p][i];
+            hash *= 1099511628211ULL;
+        }
+    }
+
+    const uint64_t rest = ((uint64_t) key->src_port << 24) | ((uint64_t) key->dst_port << 8)
+        | key->proto;
+    return ipx_utils_hash_mix(hash ^ rest);
+}
+
+/**
+ * \brief Get the current monotonic time
+ * \return Time in milliseconds
+ */
+static inline uint64_t
+time_now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC_COARSE, &ts);
+    return ((uint64_t) ts.tv_sec * 1000U) + ((uint64_t) ts.tv_nsec / 1000000U);
+}
+
+/**
+ * \brief Rotate time slices of the window
+ *
+ * Slices older than the window are cleared, i.e. the window is shifted by the slices.
+ * \param[in] data Instance data
+ * \param[in] now  Current monotonic time (milliseconds)
+ */
+static void
+slices_rotate(struct instance_data *data, uint64_t now)
+{
+    if (now - data->slice_start < data->slice_dur) {
+        return;
+    }
+
+    uint64_t shift = (now - data->slice_start) / data->slice_dur;
+    data->slice_start += shift * data->slice_dur;
+    if (shift > SLICE_CNT) {
+        shift = SLICE_CNT;
+    }
+
+    const size_t slice_size = data->bucket_cnt * BUCKET_SIZE * sizeof(uint64_t);
+    for (uint64_t i = 0; i < shift; ++i) {
+        data->slice_cur = (data->slice_cur + 1) % SLICE_CNT;
+        struct slice *slice = &data->slices[data->slice_cur];
+        memset(slice->entries, 0, slice_size);
+        slice->used = 0;
+    }
+}
+
+/**
+ * \brief Get the alternative bucket of an entry
+ * \param[in] data   Instance data
+ * \param[in] bucket Index of a bucket
+ * \param[in] fp     Fingerprint (i.e. the upper half of the entry)
+ * \return Index of the other bucket
+ */
+static inline uint64_t
+bucket_alt(const struct instance_data *data, uint64_t bucket, uint32_t fp)
+{
+    return (bucket ^ ipx_utils_hash_mix(fp)) & (data->bucket_cnt - 1);
+}
+
+/** Result of a lookup of a flow key */
+enum lookup_result {
+    /** The key has not been seen                                      */
+    LOOKUP_NONE,
+    /** The key has been seen only from the same exporter              */
+    LOOKUP_SAME,
+    /** The key has been seen from another exporter (i.e. duplicate)   */
+    LOOKUP_OTHER
+};
+
+/**
+ * \brief Look for a fingerprint in a bucket of all slices
+ * \param[in] data   Instance data
+ * \param[in] bucket Index of the bucket
+ * \param[in] fp     Fingerprint
+ * \param[in] tag    Tag of the exporter
+ * \return Result of the lookup
+ */
+static enum lookup_result
+bucket_lookup(const struct instance_data *data, uint64_t bucket, uint32_t fp, uint32_t tag)
+{
+    enum lookup_result result = LOOKUP_NONE;
+
+    for (unsigned int s = 0; s < SLICE_CNT; ++s) {
+        const uint64_t *entries = &data->slices[s].entries[bucket * BUCKET_SIZE];
+        for (unsigned int i = 0; i < BUCKET_SIZE; ++i) {
+            if ((uint32_t) (entries[i] >> 32) != fp) {
+                continue;
+            }
+
+            if ((uint32_t) entries[i] != tag) {
+                return LOOKUP_OTHER;
+            }
+            result = LOOKUP_SAME;
+        }
+    }
+
+    return result;
+}
+
+/**
+ * \brief Try to insert an entry into a bucket of the current slice
+ * \param[in] slice  Current slice
+ * \param[in] bucket Index of the bucket
+ * \param[in] entry  Entry
+ * \return True on success, false if the bucket is full
+ */
+static inline bool
+bucket_insert(struct slice *slice, uint64_t bucket, uint64_t entry)
+{
+    uint64_t *entries = &slice->entries[bucket * BUCKET_SIZE];
+    for (unsigned int i = 0; i < BUCKET_SIZE; ++i) {
+        if (entries[i] == 0) {
+            entries[i] = entry;
+            slice->used++;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/**
+ * \brief Insert a fingerprint into the current slice
+ *
+ * If both buckets are full, entries are relocated to their alternative buckets. If the
+ * limit of relocations is reached or the slice is full, an entry is lost (i.e. memory is
+ * always bounded and the filter may only miss a duplicate).
+ * \param[in] data   Instance data
+ * \param[in] bucket Index of the primary bucket
+ * \param[in] fp     Fingerprint
+ * \param[in] tag    Tag of the exporter
+ */
+static void
+filter_insert(struct instance_data *data, uint64_t bucket, uint32_t fp, uint32_t tag)
+{
+    struct slice *slice = &data->slices[data->slice_cur];
+    uint64_t entry = ((uint64_t) fp << 32) | tag;
+
+    if (slice->used >= data->slice_max) {
+        // Don't waste time by relocations, the slice will be cleared by a rotation
+        data->lost++;
+        return;
+    }
+
+    if (bucket_insert(slice, bucket, entry)) {
+        return;
+    }
+    bucket = bucket_alt(data, bucket, fp);
+    if (bucket_insert(slice, bucket, entry)) {
+        return;
+    }
+
+    for (unsigned int kick = 0; kick < MAX_KICKS; ++kick) {
+        // Swap the entry with a random victim and move the victim to its other bucket
+        data->rnd_state ^= data->rnd_state << 13;
+        data->rnd_state ^= data->rnd_state >> 7;
+        data->rnd_state ^= data->rnd_state << 17;
+        uint64_t *victim = &slice->entries[bucket * BUCKET_SIZE + (data->rnd_state % BUCKET_SIZE)];
+        const uint64_t tmp = *victim;
+        *victim = entry;
+        entry = tmp;
+
+        bucket = bucket_alt(data, bucket, (uint32_t) (entry >> 32));
+        if (bucket_insert(slice, bucket, entry)) {
+            return;
+        }
+    }
+
+    data->lost++;
+}
+
+/**
+ * \brief Find key fields of a Template in the cache or add them
+ * \param[in] data  Instance data
+ * \param[in] tmplt Template
+ * \return Cached record or NULL (the cache is full or memory allocation error)
+ */
+static const struct tcache_rec *
+tcache_get(struct instance_data *data, const struct fds_template *tmplt)
+{
+    struct tcache_rec *rec = ipx_tcache_find(data->tcache, tmplt);
+    if (rec != NULL) {
+        return rec;
+    }
+
+    if ((rec = ipx_tcache_add(data->tcache, tmplt)) == NULL) {
+        return NULL;
+    }
+
+    for (unsigned int i = 0; i < KEY_CNT; ++i) {
+        rec->sizes[i] = 0;
+
+        const struct fds_tfield *field = fds_template_cfind(tmplt, 0, key_ids[i]);
+        if (field == NULL) {
+            continue;
+        }
+
+        if (field->offset == FDS_IPFIX_VAR_IE_LEN || field->length == FDS_IPFIX_VAR_IE_LEN) {
+            // The field cannot be found without a lookup
+            rec->use_find = true;
+            break;
+        }
+
+        rec->offsets[i] = field->offset;
+        rec->sizes[i] = field->length;
+    }
+
+    return rec;
+}
+
+/**
+ * \brief Copy an address into a normalized flow key
+ * \param[out] dst  Address of the key (16 bytes)
+ * \param[in]  src  Value of the field
+ * \param[in]  size Size of the field
+ * \return True on success, false if the field is not an IPv4/IPv6 address
+ */
+static inline bool
+key_addr(uint8_t *dst, const uint8_t *src, uint16_t size)
+{
+    if (size == 16U) {
+        memcpy(dst, src, 16U);
+        return true;
+    }
+
+    if (size == 4U) {
+        // IPv4-mapped IPv6 address (::ffff:a.b.c.d)
+        memset(dst, 0, 10U);
+        dst[10] = dst[11] = 0xFF;
+        memcpy(&dst[12], src, 4U);
+        return true;
+    }
+
+    return false;
+}
+
+/**
+ * \brief Create a normalized flow key of a Data Record
+ * \param[in]  data  Instance data
+ * \param[in]  rec   Data Record
+ * \param[out] key   Flow key
+ * \param[out] start Start of the flow (milliseconds since the epoch, 0 if unknown)
+ * \return True on success, false if the record doesn't have source and destination addresses
+ */
+static bool
+key_create(struct instance_data *data, struct fds_drec *rec, struct flow_key *key,
+    uint64_t *start)
+{
+    const struct tcache_rec *cache = tcache_get(data, rec->tmplt);
+    const uint8_t *values[KEY_CNT];
+    uint16_t sizes[KEY_CNT];
+
+    if (cache != NULL && !cache->use_find) {
+        for (unsigned int i = 0; i < KEY_CNT; ++i) {
+            values[i] = &rec->data[cache->offsets[i]];
+            sizes[i] = cache->sizes[i];
+        }
+    } else {
+        for (unsigned int i = 0; i < KEY_CNT; ++i) {
+            struct fds_drec_field field;
+            if (fds_drec_find(rec, 0, key_ids[i], &field) == FDS_EOC) {
+                sizes[i] = 0;
+                continue;
+            }
+
+            values[i] = field.data;
+            sizes[i] = field.size;
+        }
+    }
+
+    // Addresses (IPv4 or IPv6) are mandatory
+    memset(key, 0, sizeof(*key));
+    const bool ip4 = sizes[KEY_SRC_IP4] != 0 && sizes[KEY_DST_IP4] != 0;
+    const unsigned int idx_src = ip4 ? KEY_SRC_IP4 : KEY_SRC_IP6;
+    const unsigned int idx_dst = ip4 ? KEY_DST_IP4 : KEY_DST_IP6;
+    if (!key_addr(key->src_ip, values[idx_src], sizes[idx_src])
+            || !key_addr(key->dst_ip, values[idx_dst], sizes[idx_dst])) {
+        return false;
+    }
+
+    uint64_t value;
+    if (sizes[KEY_SRC_PORT] != 0 && fds_get_uint_be(values[KEY_SRC_PORT], sizes[KEY_SRC_PORT],
+            &value) == FDS_OK) {
+        key->src_port = (uint16_t) value;
+    }
+    if (sizes[KEY_DST_PORT] != 0 && fds_get_uint_be(values[KEY_DST_PORT], sizes[KEY_DST_PORT],
+            &value) == FDS_OK) {
+        key->dst_port = (uint16_t) value;
+    }
+    if (sizes[KEY_PROTO] != 0 && fds_get_uint_be(values[KEY_PROTO], sizes[KEY_PROTO],
+            &value) == FDS_OK) {
+        key->proto = (uint8_t) value;
+    }
+
+    *start = 0;
+    if (sizes[KEY_START_MS] != 0) {
+        fds_get_datetime_lp_be(values[KEY_START_MS], sizes[KEY_START_MS],
+            FDS_ET_DATE_TIME_MILLISECONDS, start);
+    } else if (sizes[KEY_START_SEC] != 0) {
+        fds_get_datetime_lp_be(values[KEY_START_SEC], sizes[KEY_START_SEC],
+            FDS_ET_DATE_TIME_SECONDS, start);
+    }
+
+    return true;
+}
+
+/**
+ * \brief Decide if a Data Record is a duplicate and remember it otherwise
+ *
+ * Start timestamps of records exported by different exporters slightly differ, therefore,
+ * the timestamp is rounded to the tolerance and neighbouring values are also checked.
+ * \param[in] data Instance data
+ * \param[in] rec  Data Record
+ * \param[in] tag  Tag of the exporter (Transport Session and ODID)
+ * \return True if the record is a duplicate
+ */
+static bool
+record_duplicate(struct instance_data *data, struct fds_drec *rec, uint32_t tag)
+{
+    struct flow_key key;
+    uint64_t start;
+    if (!key_create(data, rec, &key, &start)) {
+        data->recs_nokey++;
+        return false;
+    }
+
+    const uint64_t hash = hash_key(&key);
+    const uint64_t time_bin = start / data->config->tolerance;
+    bool found_same = false;
+
+    for (uint64_t bin = time_bin - 1; bin != time_bin + 2; ++bin) {
+        const uint64_t bin_hash = ipx_utils_hash_mix(hash ^ (bin * 0x9e3779b97f4a7c15ULL));
+        const uint32_t fp = ((uint32_t) (bin_hash >> 32)) | 1U; // never zero
+        const uint64_t bucket = bin_hash & (data->bucket_cnt - 1);
+
+        const enum lookup_result res[] = {
+            bucket_lookup(data, bucket, fp, tag),
+            bucket_lookup(data, bucket_alt(data, bucket, fp), fp, tag)
+        };
+
+        if (res[0] == LOOKUP_OTHER || res[1] == LOOKUP_OTHER) {
+            return true;
+        }
+        found_same |= (res[0] == LOOKUP_SAME || res[1] == LOOKUP_SAME);
+    }
+
+    if (!found_same) {
+        const uint64_t bin_hash = ipx_utils_hash_mix(hash ^ (time_bin * 0x9e3779b97f4a7c15ULL));
+        const uint32_t fp = ((uint32_t) (bin_hash >> 32)) | 1U;
+        filter_insert(data, bin_hash & (data->bucket_cnt - 1), fp, tag);
+    }
+
+    return false;
+}
+
+/**
+ * \brief Get a tag of the exporter of a message
+ * \param[in] msg IPFIX Message
+ * \return Tag (Transport Session and ODID)
+ */
+static inline uint32_t
+exporter_tag(ipx_msg_ipfix_t *msg)
+{
+    const struct ipx_msg_ctx *msg_ctx = ipx_msg_ipfix_get_ctx(msg);
+    const uint64_t hash = ipx_utils_hash_mix((uint64_t) (uintptr_t) msg_ctx->session
+        ^ ((uint64_t) msg_ctx->odid << 32));
+    return (uint32_t) hash;
+}
+
+/**
+ * \brief Allocate time slices of the window
+ *
+ * Each slice is dimensioned for its share of the capacity at the maximum load factor.
+ * \param[in] ctx  Plugin context
+ * \param[in] data Instance data
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_NOMEM if a memory allocation error has occurred
+ */
+static int
+slices_init(ipx_ctx_t *ctx, struct instance_data *data)
+{
+    const uint64_t per_slice = (data->config->capacity + SLICE_CNT - 1) / SLICE_CNT;
+    const uint64_t buckets = (per_slice * 100U / MAX_LOAD + BUCKET_SIZE - 1) / BUCKET_SIZE;
+
+    data->bucket_cnt = 1;
+    while (data->bucket_cnt < buckets) {
+        data->bucket_cnt *= 2U;
+    }
+
+    for (unsigned int i = 0; i < SLICE_CNT; ++i) {
+        data->slices[i].entries = calloc(data->bucket_cnt * BUCKET_SIZE, sizeof(uint64_t));
+        if (!data->slices[i].entries) {
+            return IPX_ERR_NOMEM;
+        }
+    }
+
+    data->slice_max = (data->bucket_cnt * BUCKET_SIZE * FULL_LOAD) / 100U;
+    const uint64_t mem = SLICE_CNT * data->bucket_cnt * BUCKET_SIZE * sizeof(uint64_t);
+    IPX_CTX_INFO(ctx, "Filter of %u slices (%" PRIu64 " entries each) allocated (%.1f MiB)",
+        SLICE_CNT, data->bucket_cnt * BUCKET_SIZE, (double) mem / (1024.0 * 1024.0));
+
+    data->slice_dur = ((uint64_t) data->config->window * 1000U) / SLICE_CNT;
+    if (data->slice_dur == 0) {
+        data->slice_dur = 1;
+    }
+    data->slice_start = time_now();
+    data->rnd_state = 0x2545F4914F6CDD1DULL;
+    return IPX_OK;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+int
+ipx_plugin_init(ipx_ctx_t *ctx, const char *params)
+{
+    // Create a private data
+    struct instance_data *data = calloc(1, sizeof(*data));
+    if (!data) {
+        return IPX_ERR_DENIED;
+    }
+
+    if ((data->config = config_parse(ctx, params)) == NULL) {
+        free(data);
+        return IPX_ERR_DENIED;
+    }
+
+    data->tcache = ipx_tcache_create(sizeof(struct tcache_rec), TCACHE_SIZE);
+    if (!data->tcache) {
+        IPX_CTX_ERROR(ctx, "Memory allocation failed! (%s:%d)", __FILE__, __LINE__);
+        ipx_plugin_destroy(ctx, data);
+        return IPX_ERR_DENIED;
+    }
+
+    int rc = slices_init(ctx, data);
+    if (rc == IPX_OK && data->config->mode == DEDUP_MARK) {
+        rc = ipx_ctx_ext_producer_columnar(ctx, DEDUP_EXT_TYPE, DEDUP_EXT_NAME, 1, &data->ext);
+    }
+
+    if (rc != IPX_OK) {
+        IPX_CTX_ERROR(ctx, "Failed to initialize the instance (code: %d)", rc);
+        ipx_plugin_destroy(ctx, data);
+        return IPX_ERR_DENIED;
+    }
+
+    ipx_ctx_private_set(ctx, data);
+    return IPX_OK;
+}
+
+void
+ipx_plugin_destroy(ipx_ctx_t *ctx, void *cfg)
+{
+    struct instance_data *data = (struct instance_data *) cfg;
+
+    if (data->recs_total > 0) {
+        IPX_CTX_INFO(ctx, "Found %" PRIu64 " duplicates of %" PRIu64 " Data Records (%.2f%%), "
+            "%" PRIu64 " records without a flow key",
+            data->recs_dup, data->recs_total,
+            100.0 * (double) data->recs_dup / (double) data->recs_total, data->recs_nokey);
+    }
+    if (data->lost > 0) {
+        IPX_CTX_WARNING(ctx, "%" PRIu64 " records were forgotten due to a full filter "
+            "(consider a larger <capacity>)", data->lost);
+    }
+
+    for (unsigned int i = 0; i < SLICE_CNT; ++i) {
+        free(data->slices[i].entries);
+    }
+    ipx_msg_ipfix_drec_flags_free(&data->keep);
+    ipx_tcache_destroy(data->tcache);
+    config_destroy(data->config);
+    free(data);
+}
+
+int
+ipx_plugin_process(ipx_ctx_t *ctx, void *cfg, ipx_msg_t *msg)
+{
+    struct instance_data *data = (struct instance_data *) cfg;
+    ipx_msg_ipfix_t *ipfix_msg = ipx_msg_base2ipfix(msg);
+    const uint32_t rec_cnt = ipx_msg_ipfix_get_drec_cnt(ipfix_msg);
+    ipx_tcache_clear(data->tcache);
+
+    // Flags of records (the column of the extension or the array of the drop mode)
+    uint8_t *flags;
+    if (data->config->mode == DEDUP_MARK) {
+        void *column;
+        size_t size;
+        if (ipx_ctx_ext_column_get(data->ext, ipfix_msg, &column, &size) != IPX_OK) {
+            // Consumers don't get the extension, i.e. they will not see any duplicate
+            IPX_CTX_ERROR(ctx, "Memory allocation error (%s:%d)", __FILE__, __LINE__);
+            ipx_ctx_msg_pass(ctx, msg);
+            return IPX_OK;
+        }
+        flags = column;
+    } else {
+        if ((flags = ipx_msg_ipfix_drec_flags(ipfix_msg, &data->keep)) == NULL) {
+            // Records cannot be dropped, pass them all rather than lose them
+            IPX_CTX_ERROR(ctx, "Memory allocation error (%s:%d)", __FILE__, __LINE__);
+            ipx_ctx_msg_pass(ctx, msg);
+            return IPX_OK;
+        }
+    }
+
+    slices_rotate(data, time_now());
+    const uint32_t tag = exporter_tag(ipfix_msg);
+    const bool mark = (data->config->mode == DEDUP_MARK);
+
+    uint32_t dups = 0;
+    for (uint32_t i = 0; i < rec_cnt; ++i) {
+        struct ipx_ipfix_record *rec = ipx_msg_ipfix_get_drec(ipfix_msg, i);
+        const bool dup = record_duplicate(data, &rec->rec, tag);
+        // Mark mode flags duplicates, drop mode flags records to keep
+        flags[i] = mark ? dup : !dup;
+        dups += dup;
+    }
+
+    if (mark) {
+        ipx_ctx_ext_column_set_filled(data->ext, ipfix_msg);
+    } else if (dups != 0) {
+        ipx_msg_ipfix_drec_compact(ipfix_msg, flags);
+    }
+
+    data->recs_total += rec_cnt;
+    data->recs_dup += dups;
+
+    // Always pass the message (Template Sets and remaining records)
+    ipx_ctx_msg_pass(ctx, msg);
+    return IPX_OK;
+}
@@ -0,0 +1,570 @@
+/**
+ * \file src/plugins/intermediate/enrichment/enrichment.c
+ * \author agent <agent@local>
+ * \brief Enrichment of flow records by prefix tables for IPFIXcol2
+ * \date 2026
+ */
+
+/* Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is'', and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#include <ipfixcol2.h>
+#include <errno.h>
+#include <inttypes.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <time.h>
+
+#include "config.h"
+#include "table.h"
+
+/** Plugin description */
+IPX_API struct ipx_plugin_info ipx_plugin_info = {
+    // Plugin type
+    .type = IPX_PT_INTERMEDIATE,
+    // Plugin identification name
+    .name = "enrichment",
+    // Brief description of plugin
+    .dsc = "Enrichment of flow records by ASN, country and tags of IP prefixes",
+    // Configuration flags (reserved for future use)
+    .flags = 0,
+    // Plugin version string (like "1.2.3")
+    .version = "2.0.0",
+    // Minimal IPFIXcol version string (like "1.2.3")
+    .ipx_min = "2.0.0"
+};
+
+/** Type of the extension with results of lookups (see struct enrich_ext)                */
+#define ENRICH_EXT_TYPE "enrichment-v1"
+/** Name of the extension with results of lookups                                        */
+#define ENRICH_EXT_NAME "prefix"
+
+/** Maximum number of different Templates cached per message                            */
+#define TCACHE_SIZE  (16U)
+
+/**
+ * \brief Value of the extension of a Data Record (zeros == unknown or no matching prefix)
+ *
+ * All values are in host byte order. Consumers must use the same structure.
+ */
+struct enrich_ext {
+    /** ASN of the source address                                                       */
+    uint32_t src_asn;
+    /** ASN of the destination address                                                  */
+    uint32_t dst_asn;
+    /** Tag of the source address                                                       */
+    uint32_t src_tag;
+    /** Tag of the destination address                                                  */
+    uint32_t dst_tag;
+    /** Country code of the source address                                              */
+    char src_country[2];
+    /** Country code of the destination address                                         */
+    char dst_country[2];
+};
+
+/** Fields of addresses (indexes into the cache of a Template) */
+enum addr_fields {
+    ADDR_SRC_IP4,
+    ADDR_DST_IP4,
+    ADDR_SRC_IP6,
+    ADDR_DST_IP6,
+    ADDR_CNT
+};
+
+/** Information Elements of addresses (in the order of ::addr_fields, all IANA) */
+static const uint16_t addr_ids[ADDR_CNT] = {
+    8,   // sourceIPv4Address
+    12,  // destinationIPv4Address
+    27,  // sourceIPv6Address
+    28,  // destinationIPv6Address
+};
+
+/** Addresses of a Template */
+struct tcache_rec {
+    /** Offsets of fields are not known (i.e. a field is placed after a variable-length
+     *  field) and addresses must be found by fds_drec_find()                           */
+    bool use_find;
+    /** Offsets of addresses from the start of a record                                 */
+    uint16_t offsets[ADDR_CNT];
+    /** Sizes of addresses (0 == not present)                                           */
+    uint16_t sizes[ADDR_CNT];
+};
+
+/** Identification of a version of the table file */
+struct file_version {
+    /** Inode (the file might be replaced by a rename)                                  */
+    ino_t ino;
+    /** Size                                                                            */
+    off_t size;
+    /** Time of the last modification                                                   */
+    struct timespec mtime;
+};
+
+/** Instance */
+struct instance_data {
+    /** Plugin context (for the reload thread)                                          */
+    ipx_ctx_t *ctx;
+    /** Parsed configuration of the instance                                            */
+    struct enrichment_config *config;
+    /** Extension with results of lookups                                               */
+    ipx_ctx_ext_t *ext;
+
+    /** Prefix table used for lookups (owned by the processing thread)                  */
+    struct table *table;
+    /**
+     * New prefix table loaded by the reload thread (atomic).
+     *
+     * The processing thread takes the table at the start of a message and frees the old
+     * one, i.e. the old table is never freed while a lookup is in progress.
+     */
+    struct table *table_new;
+
+    /** Reload thread                                                                   */
+    struct {
+        /** Thread                                                                      */
+        pthread_t thread;
+        /** The thread is running                                                       */
+        bool running;
+        /** Stop request                                                                */
+        bool stop;
+        /** Mutex of the stop request                                                   */
+        pthread_mutex_t mutex;
+        /** Condition variable of the stop request                                      */
+        pthread_cond_t cond;
+        /** Version of the loaded file                                                  */
+        struct file_version version;
+    } reload;
+
+    /** Addresses of Templates of the processed message (see struct tcache_rec)         */
+    ipx_tcache_t *tcache;
+
+    /** Number of processed Data Records                                                */
+    uint64_t recs_total;
+    /** Number of Data Records with at least one matching prefix                        */
+    uint64_t recs_matched;
+    /** Number of reloads of the table                                                  */
+    uint64_t reloads;
+};
+
+/**
+ * \brief Get the version of a file
+ * \param[in]  path    Path to the file
+ * \param[out] version Version
+ * \return True on success, false otherwise
+ */
+static bool
+file_version_get(const char *path, struct file_version *version)
+{
+    struct stat st;
+    if (stat(path, &st) != 0) {
+        return false;
+    }
+
+    version->ino = st.st_ino;
+    version->size = st.st_size;
+    version->mtime = st.st_mtim;
+    return true;
+}
+
+/**
+ * \brief Compare versions of a file
+ * \return True if the versions are the same
+ */
+static bool
+file_version_eq(const struct file_version *lhs, const struct file_version *rhs)
+{
+    return lhs->ino == rhs->ino && lhs->size == rhs->size
+        && lhs->mtime.tv_sec == rhs->mtime.tv_sec && lhs->mtime.tv_nsec == rhs->mtime.tv_nsec;
+}
+
+/**
+ * \brief Load the prefix table
+ * \param[in] ctx  Plugin context
+ * \param[in] data Instance data
+ * \return Loaded table or NULL
+ */
+static struct table *
+table_reload(ipx_ctx_t *ctx, struct instance_data *data)
+{
+    char err[256];
+    struct table *tbl = table_load(data->config->table, err, sizeof(err));
+    if (!tbl) {
+        IPX_CTX_ERROR(ctx, "Failed to load the prefix table: %s", err);
+        return NULL;
+    }
+
+    IPX_CTX_INFO(ctx, "Prefix table '%s' loaded (%" PRIu32 " prefixes, %.1f MiB)",
+        data->config->table, tbl->values_cnt - 1U, (double) tbl->mem_size / (1024.0 * 1024.0));
+    return tbl;
+}
+
+/**
+ * \brief Main function of the reload thread
+ *
+ * The thread periodically checks if the file with the table has been modified. If so, a new
+ * table is built and handed over to the processing thread.
+ * \param[in] arg Instance data
+ * \return Nothing
+ */
+static void *
+reload_main(void *arg)
+{
+    struct instance_data *data = arg;
+    ipx_ctx_t *ctx = data->ctx;
+
+    pthread_mutex_lock(&data->reload.mutex);
+    while (!data->reload.stop) {
+        struct timespec deadline;
+        clock_gettime(CLOCK_MONOTONIC, &deadline);
+        deadline.tv_sec += data->config->reload;
+        while (!data->reload.stop && pthread_cond_timedwait(&data->reload.cond,
+                &data->reload.mutex, &deadline) != ETIMEDOUT) {
+            // Spurious wake up or a stop request
+        }
+        if (data->reload.stop) {
+            break;
+        }
+        pthread_mutex_unlock(&data->reload.mutex);
+
+        struct file_version version;
+        if (file_version_get(data->config->table, &version)
+                && !file_version_eq(&version, &data->reload.version)) {
+            // A broken file (e.g. not completely written yet) is loaded again after the next change
+            data->reload.version = version;
+            struct table *tbl = table_reload(ctx, data);
+            if (tbl) {
+                // Hand over the table, replace the previous one if it has not been taken yet
+                struct table *old = __atomic_exchange_n(&data->table_new, tbl, __ATOMIC_ACQ_REL);
+                if (old) {
+                    table_destroy(old);
+                }
+            }
+        }
+
+        pthread_mutex_lock(&data->reload.mutex);
+    }
+    pthread_mutex_unlock(&data->reload.mutex);
+    return NULL;
+}
+
+/**
+ * \brief Start the reload thread
+ * \param[in] data Instance data
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_DENIED on failure
+ */
+static int
+reload_start(struct instance_data *data)
+{
+    pthread_condattr_t attr;
+    if (pthread_condattr_init(&attr) != 0) {
+        return IPX_ERR_DENIED;
+    }
+
+    // Deadlines are monotonic (changes of the system time don't matter)
+    int rc = pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    if (rc == 0) {
+        rc = pthread_cond_init(&data->reload.cond, &attr);
+    }
+    pthread_condattr_destroy(&attr);
+    if (rc != 0) {
+        return IPX_ERR_DENIED;
+    }
+
+    if (pthread_mutex_init(&data->reload.mutex, NULL) != 0) {
+        pthread_cond_destroy(&data->reload.cond);
+        return IPX_ERR_DENIED;
+    }
+
+    data->reload.stop = false;
+    if (pthread_create(&data->reload.thread, NULL, &reload_main, data) != 0) {
+        pthread_mutex_destroy(&data->reload.mutex);
+        pthread_cond_destroy(&data->reload.cond);
+        return IPX_ERR_DENIED;
+    }
+
+    data->reload.running = true;
+    return IPX_OK;
+}
+
+/**
+ * \brief Stop the reload thread (if running)
+ * \param[in] data Instance data
+ */
+static void
+reload_stop(struct instance_data *data)
+{
+    if (!data->reload.running) {
+        return;
+    }
+
+    pthread_mutex_lock(&data->reload.mutex);
+    data->reload.stop = true;
+    pthread_cond_signal(&data->reload.cond);
+    pthread_mutex_unlock(&data->reload.mutex);
+
+    pthread_join(data->reload.thread, NULL);
+    pthread_mutex_destroy(&data->reload.mutex);
+    pthread_cond_destroy(&data->reload.cond);
+    data->reload.running = false;
+}
+
+/**
+ * \brief Find addresses of a Template in the cache or add them
+ * \param[in] data  Instance data
+ * \param[in] tmplt Template
+ * \return Cached record or NULL (the cache is full or memory allocation error)
+ */
+static const struct tcache_rec *
+tcache_get(struct instance_data *data, const struct fds_template *tmplt)
+{
+    struct tcache_rec *rec = ipx_tcache_find(data->tcache, tmplt);
+    if (rec != NULL) {
+        return rec;
+    }
+
+    if ((rec = ipx_tcache_add(data->tcache, tmplt)) == NULL) {
+        return NULL;
+    }
+
+    for (unsigned int i = 0; i < ADDR_CNT; ++i) {
+        rec->sizes[i] = 0;
+
+        const struct fds_tfield *field = fds_template_cfind(tmplt, 0, addr_ids[i]);
+        if (field == NULL) {
+            continue;
+        }
+
+        if (field->offset == FDS_IPFIX_VAR_IE_LEN || field->length == FDS_IPFIX_VAR_IE_LEN) {
+            // The field cannot be found without a lookup
+            rec->use_find = true;
+            break;
+        }
+
+        rec->offsets[i] = field->offset;
+        rec->sizes[i] = field->length;
+    }
+
+    return rec;
+}
+
+/**
+ * \brief Find a prefix of an address
+ * \param[in] tbl  Prefix table
+ * \param[in] addr Address
+ * \param[in] size Size of the address (4 or 16 bytes, otherwise no prefix)
+ * \return Value of the prefix or NULL
+ */
+static inline const struct table_value *
+addr_lookup(const struct table *tbl, const uint8_t *addr, uint16_t size)
+{
+    if (size == 4U) {
+        return table_lookup4(tbl, addr);
+    } else if (size == 16U) {
+        return table_lookup6(tbl, addr);
+    }
+
+    return NULL;
+}
+
+/**
+ * \brief Fill the extension of a Data Record
+ * \param[in]  data Instance data
+ * \param[in]  rec  Data Record
+ * \param[out] ext  Value of the extension
+ * \return True if at least one address has a matching prefix
+ */
+static bool
+record_enrich(struct instance_data *data, struct fds_drec *rec, struct enrich_ext *ext)
+{
+    const struct tcache_rec *cache = tcache_get(data, rec->tmplt);
+    const uint8_t *values[ADDR_CNT];
+    uint16_t sizes[ADDR_CNT];
+
+    if (cache != NULL && !cache->use_find) {
+        for (unsigned int i = 0; i < ADDR_CNT; ++i) {
+            values[i] = &rec->data[cache->offsets[i]];
+            sizes[i] = cache->sizes[i];
+        }
+    } else {
+        for (unsigned int i = 0; i < ADDR_CNT; ++i) {
+            struct fds_drec_field field;
+            if (fds_drec_find(rec, 0, addr_ids[i], &field) == FDS_EOC) {
+                sizes[i] = 0;
+                continue;
+            }
+
+            values[i] = field.data;
+            sizes[i] = field.size;
+        }
+    }
+
+    const struct table_value *src;
+    const struct table_value *dst;
+    if (sizes[ADDR_SRC_IP4] != 0 || sizes[ADDR_DST_IP4] != 0) {
+        src = addr_lookup(data->table, values[ADDR_SRC_IP4], sizes[ADDR_SRC_IP4]);
+        dst = addr_lookup(data->table, values[ADDR_DST_IP4], sizes[ADDR_DST_IP4]);
+    } else {
+        src = addr_lookup(data->table, values[ADDR_SRC_IP6], sizes[ADDR_SRC_IP6]);
+        dst = addr_lookup(data->table, values[ADDR_DST_IP6], sizes[ADDR_DST_IP6]);
+    }
+
+    memset(ext, 0, sizeof(*ext));
+    if (src) {
+        ext->src_asn = src->asn;
+        ext->src_tag = src->tag;
+        memcpy(ext->src_country, src->country, sizeof(ext->src_country));
+    }
+    if (dst) {
+        ext->dst_asn = dst->asn;
+        ext->dst_tag = dst->tag;
+        memcpy(ext->dst_country, dst->country, sizeof(ext->dst_country));
+    }
+
+    return src != NULL || dst != NULL;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+int
+ipx_plugin_init(ipx_ctx_t *ctx, const char *params)
+{
+    // Create a private data
+    struct instance_data *data = calloc(1, sizeof(*data));
+    if (!data) {
+        return IPX_ERR_DENIED;
+    }
+
+    data->ctx = ctx;
+    if ((data->config = config_parse(ctx, params)) == NULL) {
+        free(data);
+        return IPX_ERR_DENIED;
+    }
+
+    data->tcache = ipx_tcache_create(sizeof(struct tcache_rec), TCACHE_SIZE);
+    if (!data->tcache) {
+        IPX_CTX_ERROR(ctx, "Memory allocation failed! (%s:%d)", __FILE__, __LINE__);
+        ipx_plugin_destroy(ctx, data);
+        return IPX_ERR_DENIED;
+    }
+
+    // The first version of the table is mandatory
+    file_version_get(data->config->table, &data->reload.version);
+    if ((data->table = table_reload(ctx, data)) == NULL) {
+        ipx_plugin_destroy(ctx, data);
+        return IPX_ERR_DENIED;
+    }
+
+    int rc = ipx_ctx_ext_producer_columnar(ctx, ENRICH_EXT_TYPE, ENRICH_EXT_NAME,
+        sizeof(struct enrich_ext), &data->ext);
+    if (rc != IPX_OK) {
+        IPX_CTX_ERROR(ctx, "Failed to register the extension (code: %d)", rc);
+        ipx_plugin_destroy(ctx, data);
+        return IPX_ERR_DENIED;
+    }
+
+    ipx_ctx_private_set(ctx, data);
+    if (data->config->reload > 0 && reload_start(data) != IPX_OK) {
+        IPX_CTX_ERROR(ctx, "Failed to start a thread for reloading of the table.", '\0');
+        ipx_plugin_destroy(ctx, data);
+        return IPX_ERR_DENIED;
+    }
+
+    return IPX_OK;
+}
+
+void
+ipx_plugin_destroy(ipx_ctx_t *ctx, void *cfg)
+{
+    struct instance_data *data = (struct instance_data *) cfg;
+    reload_stop(data);
+
+    if (data->recs_total > 0) {
+        IPX_CTX_INFO(ctx, "Enriched %" PRIu64 " of %" PRIu64 " Data Records (%.2f%%), "
+            "the table has been reloaded %" PRIu64 " times", data->recs_matched, data->recs_total,
+            100.0 * (double) data->recs_matched / (double) data->recs_total, data->reloads);
+    }
+
+    if (data->table_new) {
+        table_destroy(data->table_new);
+    }
+    if (data->table) {
+        table_destroy(data->table);
+    }
+    ipx_tcache_destroy(data->tcache);
+    config_destroy(data->config);
+    free(data);
+}
+
+int
+ipx_plugin_process(ipx_ctx_t *ctx, void *cfg, ipx_msg_t *msg)
+{
+    struct instance_data *data = (struct instance_data *) cfg;
+    ipx_msg_ipfix_t *ipfix_msg = ipx_msg_base2ipfix(msg);
+    const uint32_t rec_cnt = ipx_msg_ipfix_get_drec_cnt(ipfix_msg);
+    ipx_tcache_clear(data->tcache);
+
+    // Replace the table, if a new one has been loaded (nobody else uses the old one)
+    struct table *tbl_new = __atomic_exchange_n(&data->table_new, NULL, __ATOMIC_ACQ_REL);
+    if (tbl_new) {
+        table_destroy(data->table);
+        data->table = tbl_new;
+        data->reloads++;
+    }
+
+    void *column;
+    size_t size;
+    if (ipx_ctx_ext_column_get(data->ext, ipfix_msg, &column, &size) != IPX_OK) {
+        // Consumers don't get the extension
+        IPX_CTX_ERROR(ctx, "Memory allocation error (%s:%d)", __FILE__, __LINE__);
+        ipx_ctx_msg_pass(ctx, msg);
+        return IPX_OK;
+    }
+
+    struct enrich_ext *exts = column;
+    uint32_t matched = 0;
+    for (uint32_t i = 0; i < rec_cnt; ++i) {
+        struct ipx_ipfix_record *rec = ipx_msg_ipfix_get_drec(ipfix_msg, i);
+        matched += record_enrich(data, &rec->rec, &exts[i]);
+    }
+    ipx_ctx_ext_column_set_filled(data->ext, ipfix_msg);
+
+    data->recs_total += rec_cnt;
+    data->recs_matched += matched;
+
+    ipx_ctx_msg_pass(ctx, msg);
+    return IPX_OK;
+}
@@ -0,0 +1,501 @@
+/**
+ * \file src/plugins/intermediate/enrichment/table.c
+ * \author agent <agent@local>
+ * \brief Prefix tables with longest prefix match lookups
+ * \date 2026
+ */
+
+/* Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is'', and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#include <arpa/inet.h>
+#include <ctype.h>
+#include <errno.h>
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "table.h"
+
+/** Number of entries of the IPv4 main table (i.e. 24 bits of an address)                 */
+#define V4_TBL24_SIZE (1U << 24)
+/** Default number of allocated prefixes/groups                                             */
+#define ALLOC_DEF     (1024U)
+
+/** Parsed prefix */
+struct prefix {
+    /** Address (masked to the prefix length)                                              */
+    uint8_t addr[16];
+    /** Prefix length                                                                      */
+    uint8_t len;
+    /** IPv6 prefix                                                                        */
+    bool ip6;
+    /** Index of the value                                                                 */
+    uint32_t value;
+};
+
+/** Auxiliary structure for building a table */
+struct builder {
+    /** Table                                                                              */
+    struct table *tbl;
+    /** Number of allocated IPv4 groups                                                    */
+    uint32_t v4_alloc;
+    /** Number of allocated IPv6 groups                                                    */
+    uint32_t v6_alloc;
+};
+
+/**
+ * \brief Compare prefixes by their length (shorter first, the order of lines otherwise)
+ */
+static int
+prefix_cmp(const void *lhs, const void *rhs)
+{
+    const struct prefix *l = lhs;
+    const struct prefix *r = rhs;
+    if (l->len != r->len) {
+        return (l->len < r->len) ? -1 : 1;
+    }
+    return (l->value < r->value) ? -1 : (l->value > r->value);
+}
+
+/**
+ * \brief Parse a prefix (e.g. "192.0.2.0/24", "2001:db8::/32" or an address)
+ * \param[in]  str    String to parse (modified)
+ * \param[out] prefix Parsed prefix
+ * \return True on success, false otherwise
+ */
+static bool
+prefix_parse(char *str, struct prefix *prefix)
+{
+    unsigned long len = 0;
+    char *slash = strchr(str, '/');
+    if (slash) {
+        char *end;
+        *slash = '\0';
+        errno = 0;
+        len = strtoul(slash + 1, &end, 10);
+        if (errno != 0 || *end != '\0' || end == slash + 1) {
+            return false;
+        }
+    }
+
+    memset(prefix->addr, 0, sizeof(prefix->addr));
+    if (inet_pton(AF_INET, str, prefix->addr) == 1) {
+        prefix->ip6 = false;
+        len = slash ? len : 32U;
+        if (len > 32U) {
+            return false;
+        }
+    } else if (inet_pton(AF_INET6, str, prefix->addr) == 1) {
+        prefix->ip6 = true;
+        len = slash ? len : 128U;
+        if (len > 128U) {
+            return false;
+        }
+    } else {
+        return false;
+    }
+
+    // Clear bits after the prefix
+    prefix->len = (uint8_t) len;
+    for (unsigned int i = 0; i < sizeof(prefix->addr); ++i) {
+        const unsigned int bits = (len > i * 8U) ? (len - i * 8U) : 0;
+        if (bits < 8U) {
+            prefix->addr[i] &= (uint8_t) (0xFF00U >> bits);
+        }
+    }
+
+    return true;
+}
+
+/**
+ * \brief Parse a line of a table file
+ * \param[in]  line   Line (modified)
+ * \param[out] prefix Parsed prefix
+ * \param[out] value  Parsed value
+ * \return 1 on success, 0 if the line is empty, -1 if the line is malformed
+ */
+static int
+line_parse(char *line, struct prefix *prefix, struct table_value *value)
+{
+    char *save;
+    char *tokens[4] = {NULL, NULL, NULL, NULL};
+    unsigned int cnt = 0;
+
+    for (char *tok = strtok_r(line, " \t\r\n", &save); tok != NULL;
+            tok = strtok_r(NULL, " \t\r\n", &save)) {
+        if (cnt == 0 && tok[0] == '#') {
+            return 0;
+        }
+        if (cnt == 4) {
+            return -1;
+        }
+        tokens[cnt++] = tok;
+    }
+
+    if (cnt == 0) {
+        return 0;
+    }
+    if (cnt < 2 || !prefix_parse(tokens[0], prefix)) {
+        return -1;
+    }
+
+    char *end;
+    memset(value, 0, sizeof(*value));
+    errno = 0;
+    unsigned long long asn = strtoull(tokens[1], &end, 10);
+    if (errno != 0 || *end != '\0' || asn > UINT32_MAX) {
+        return -1;
+    }
+    value->asn = (uint32_t) asn;
+
+    if (tokens[2] != NULL && strcmp(tokens[2], "-") != 0) {
+        if (strlen(tokens[2]) != 2 || !isalpha(tokens[2][0]) || !isalpha(tokens[2][1])) {
+            return -1;
+        }
+        value->country[0] = (char) toupper(tokens[2][0]);
+        value->country[1] = (char) toupper(tokens[2][1]);
+    }
+
+    if (tokens[3] != NULL) {
+        errno = 0;
+        unsigned long long tag = strtoull(tokens[3], &end, 10);
+        if (errno != 0 || *end != '\0' || tag > UINT32_MAX) {
+            return -1;
+        }
+        value->tag = (uint32_t) tag;
+    }
+
+    return 1;
+}
+
+/**
+ * \brief Add a new IPv4 group filled with an entry
+ * \param[in] bld   Builder
+ * \param[in] entry Entry
+ * \return Index of the group or -1 (memory allocation error)
+ */
+static int64_t
+v4_group_new(struct builder *bld, uint32_t entry)
+{
+    struct table *tbl = bld->tbl;
+    if (tbl->v4_groups == bld->v4_alloc) {
+        const uint32_t alloc_new = (bld->v4_alloc > 0) ? 2U * bld->v4_alloc : ALLOC_DEF;
+        if (alloc_new >= TABLE_GROUP) {
+            return -1;
+        }
+        uint32_t *tbl8_new = realloc(tbl->v4_tbl8,
+            (size_t) alloc_new * TABLE_GROUP_SIZE * sizeof(*tbl8_new));
+        if (!tbl8_new) {
+            return -1;
+        }
+        tbl->v4_tbl8 = tbl8_new;
+        bld->v4_alloc = alloc_new;
+    }
+
+    uint32_t *group = &tbl->v4_tbl8[(size_t) tbl->v4_groups * TABLE_GROUP_SIZE];
+    for (unsigned int i = 0; i < TABLE_GROUP_SIZE; ++i) {
+        group[i] = entry;
+    }
+    return tbl->v4_groups++;
+}
+
+/**
+ * \brief Add an IPv4 prefix (prefixes must be added from the shortest one)
+ * \param[in] bld    Builder
+ * \param[in] prefix Prefix
+ * \return True on success, false (memory allocation error)
+ */
+static bool
+v4_insert(struct builder *bld, const struct prefix *prefix)
+{
+    struct table *tbl = bld->tbl;
+    const uint32_t idx = ((uint32_t) prefix->addr[0] << 16) | ((uint32_t) prefix->addr[1] << 8)
+        | prefix->addr[2];
+
+    if (prefix->len <= 24U) {
+        // Longer prefixes (i.e. groups) have not been added yet
+        const uint32_t cnt = 1U << (24U - prefix->len);
+        for (uint32_t i = 0; i < cnt; ++i) {
+            tbl->v4_tbl24[idx + i] = prefix->value;
+        }
+        return true;
+    }
+
+    uint32_t entry = tbl->v4_tbl24[idx];
+    if ((entry & TABLE_GROUP) == 0) {
+        const int64_t group = v4_group_new(bld, entry);
+        if (group < 0) {
+            return false;
+        }
+        entry = TABLE_GROUP | (uint32_t) group;
+        tbl->v4_tbl24[idx] = entry;
+    }
+
+    uint32_t *group = &tbl->v4_tbl8[(size_t) (entry & ~TABLE_GROUP) * TABLE_GROUP_SIZE];
+    const uint32_t cnt = 1U << (32U - prefix->len);
+    for (uint32_t i = 0; i < cnt; ++i) {
+        group[prefix->addr[3] + i] = prefix->value;
+    }
+    return true;
+}
+
+/**
+ * \brief Add a new IPv6 group filled with an entry
+ * \param[in] bld   Builder
+ * \param[in] entry Entry
+ * \return Index of the group or -1 (memory allocation error)
+ */
+static int64_t
+v6_group_new(struct builder *bld, uint32_t entry)
+{
+    struct table *tbl = bld->tbl;
+    if (tbl->v6_groups == bld->v6_alloc) {
+        const uint32_t alloc_new = 2U * bld->v6_alloc;
+        if (alloc_new >= TABLE_GROUP) {
+            return -1;
+        }
+        uint32_t *nodes_new = realloc(tbl->v6_nodes,
+            (TABLE_V6_ROOT + (size_t) alloc_new * TABLE_GROUP_SIZE) * sizeof(*nodes_new));
+        if (!nodes_new) {
+            return -1;
+        }
+        tbl->v6_nodes = nodes_new;
+        bld->v6_alloc = alloc_new;
+    }
+
+    uint32_t *group = &tbl->v6_nodes[TABLE_V6_ROOT + (size_t) tbl->v6_groups * TABLE_GROUP_SIZE];
+    for (unsigned int i = 0; i < TABLE_GROUP_SIZE; ++i) {
+        group[i] = entry;
+    }
+    return tbl->v6_groups++;
+}
+
+/**
+ * \brief Add an IPv6 prefix (prefixes must be added from the shortest one)
+ * \param[in] bld    Builder
+ * \param[in] prefix Prefix
+ * \return True on success, false (memory allocation error)
+ */
+static bool
+v6_insert(struct builder *bld, const struct prefix *prefix)
+{
+    struct table *tbl = bld->tbl;
+    // Position of the entry (nodes might be reallocated, therefore, no pointers)
+    size_t pos = ((size_t) prefix->addr[0] << 8) | prefix->addr[1];
+
+    if (prefix->len <= 16U) {
+        const uint32_t cnt = 1U << (16U - prefix->len);
+        for (uint32_t i = 0; i < cnt; ++i) {
+            tbl->v6_nodes[pos + i] = prefix->value;
+        }
+        return true;
+    }
+
+    for (unsigned int depth = 16U; ; depth += 8U) {
+        uint32_t entry = tbl->v6_nodes[pos];
+        if ((entry & TABLE_GROUP) == 0) {
+            const int64_t group = v6_group_new(bld, entry);
+            if (group < 0) {
+                return false;
+            }
+            entry = TABLE_GROUP | (uint32_t) group;
+            tbl->v6_nodes[pos] = entry;
+        }
+
+        const size_t base = TABLE_V6_ROOT + (size_t) (entry & ~TABLE_GROUP) * TABLE_GROUP_SIZE;
+        const uint8_t byte = prefix->addr[depth / 8U];
+        if (prefix->len <= depth + 8U) {
+            const uint32_t cnt = 1U << (depth + 8U - prefix->len);
+            for (uint32_t i = 0; i < cnt; ++i) {
+                tbl->v6_nodes[base + byte + i] = prefix->value;
+            }
+            return true;
+        }
+
+        pos = base + byte;
+    }
+}
+
+/**
+ * \brief Build lookup tables of prefixes
+ * \param[in] tbl      Table (with values)
+ * \param[in] prefixes Prefixes (will be sorted)
+ * \param[in] cnt      Number of prefixes
+ * \return True on success, false (memory allocation error)
+ */
+static bool
+table_build(struct table *tbl, struct prefix *prefixes, size_t cnt)
+{
+    struct builder bld = {tbl, 0, ALLOC_DEF};
+    bool has_v4 = false;
+    bool has_v6 = false;
+    for (size_t i = 0; i < cnt; ++i) {
+        has_v4 |= !prefixes[i].ip6;
+        has_v6 |= prefixes[i].ip6;
+    }
+
+    if (has_v4 && (tbl->v4_tbl24 = calloc(V4_TBL24_SIZE, sizeof(uint32_t))) == NULL) {
+        return false;
+    }
+    if (has_v6 && (tbl->v6_nodes = calloc(TABLE_V6_ROOT + (size_t) bld.v6_alloc
+            * TABLE_GROUP_SIZE, sizeof(uint32_t))) == NULL) {
+        return false;
+    }
+
+    // Longer prefixes overwrite expanded entries of shorter ones
+    qsort(prefixes, cnt, sizeof(*prefixes), prefix_cmp);
+    for (size_t i = 0; i < cnt; ++i) {
+        const bool ok = prefixes[i].ip6 ? v6_insert(&bld, &prefixes[i]) : v4_insert(&bld, &prefixes[i]);
+        if (!ok) {
+            return false;
+        }
+    }
+
+    tbl->mem_size = tbl->values_cnt * sizeof(*tbl->values);
+    if (has_v4) {
+        tbl->mem_size += (V4_TBL24_SIZE + (size_t) bld.v4_alloc * TABLE_GROUP_SIZE) * sizeof(uint32_t);
+    }
+    if (has_v6) {
+        tbl->mem_size += (TABLE_V6_ROOT + (size_t) bld.v6_alloc * TABLE_GROUP_SIZE) * sizeof(uint32_t);
+    }
+    return true;
+}
+
+struct table *
+table_load(const char *path, char *err, size_t err_len)
+{
+    FILE *file = fopen(path, "r");
+    if (!file) {
+        snprintf(err, err_len, "Failed to open '%s': %s", path, strerror(errno));
+        return NULL;
+    }
+
+    struct table *tbl = calloc(1, sizeof(*tbl));
+    struct prefix *prefixes = NULL;
+    size_t prefixes_cnt = 0;
+    size_t alloc = 0;
+    char *line = NULL;
+    size_t line_size = 0;
+    size_t line_no = 0;
+    bool ok = (tbl != NULL);
+
+    if (ok) {
+        // Index 0 means "no prefix"
+        tbl->values_cnt = 1;
+    }
+
+    while (ok && getline(&line, &line_size, file) != -1) {
+        line_no++;
+
+        struct prefix prefix;
+        struct table_value value;
+        const int rc = line_parse(line, &prefix, &value);
+        if (rc == 0) {
+            continue;
+        }
+        if (rc < 0) {
+            snprintf(err, err_len, "Malformed line %zu of '%s'", line_no, path);
+            ok = false;
+            break;
+        }
+
+        if (prefixes_cnt == alloc) {
+            // Values and prefixes are allocated together
+            const size_t alloc_new = (alloc > 0) ? 2U * alloc : ALLOC_DEF;
+            if (alloc_new + 1U >= TABLE_GROUP) {
+                snprintf(err, err_len, "Too many prefixes in '%s'", path);
+                ok = false;
+                break;
+            }
+
+            struct prefix *prefixes_new = realloc(prefixes, alloc_new * sizeof(*prefixes_new));
+            if (prefixes_new) {
+                prefixes = prefixes_new;
+            }
+            struct table_value *values_new = realloc(tbl->values,
+                (alloc_new + 1U) * sizeof(*values_new));
+            if (values_new) {
+                tbl->values = values_new;
+            }
+            if (!prefixes_new || !values_new) {
+                snprintf(err, err_len, "Memory allocation error (%s:%d)", __FILE__, __LINE__);
+                ok = false;
+                break;
+            }
+            alloc = alloc_new;
+        }
+
+        prefix.value = tbl->values_cnt;
+        tbl->values[tbl->values_cnt++] = value;
+        prefixes[prefixes_cnt++] = prefix;
+    }
+
+    if (!tbl) {
+        snprintf(err, err_len, "Memory allocation error (%s:%d)", __FILE__, __LINE__);
+    } else if (ok && ferror(file)) {
+        snprintf(err, err_len, "Failed to read '%s'", path);
+        ok = false;
+    }
+
+    if (ok && !table_build(tbl, prefixes, prefixes_cnt)) {
+        snprintf(err, err_len, "Memory allocation error (%s:%d)", __FILE__, __LINE__);
+        ok = false;
+    }
+
+    free(line);
+    free(prefixes);
+    fclose(file);
+
+    if (!ok) {
+        if (tbl) {
+            table_destroy(tbl);
+        }
+        return NULL;
+    }
+
+    return tbl;
+}
+
+void
+table_destroy(struct table *tbl)
+{
+    free(tbl->v4_tbl24);
+    free(tbl->v4_tbl8);
+    free(tbl->v6_nodes);
+    free(tbl->values);
+    free(tbl);
+}
@@ -0,0 +1,163 @@
+/**
+ * \file src/plugins/intermediate/enrichment/table.h
+ * \author agent <agent@local>
+ * \brief Prefix tables with longest prefix match lookups (header file)
+ * \date 2026
+ */
+
+/* Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is'', and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#ifndef TABLE_H
+#define TABLE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/** Entry of a lookup table refers to a group of the next level (otherwise, a value index)  */
+#define TABLE_GROUP   (0x80000000U)
+/** Number of entries of a group of the next level (i.e. 8 bits of an address)              */
+#define TABLE_GROUP_SIZE (256U)
+/** Number of entries of the root of the IPv6 table (i.e. 16 bits of an address)          */
+#define TABLE_V6_ROOT (65536U)
+
+/** Value of a prefix                                                                      */
+struct table_value {
+    /** Autonomous System Number (0 == unknown)                                            */
+    uint32_t asn;
+    /** Tag (e.g. a customer ID, 0 == unknown)                                             */
+    uint32_t tag;
+    /** ISO 3166-1 alpha-2 country code (zeros == unknown)                                 */
+    char country[2];
+};
+
+/**
+ * \brief Prefix table
+ *
+ * IPv4 prefixes are stored in a DIR-24-8 table, i.e. the first 24 bits of an address select
+ * an entry of the main table (2^24 entries) and, only if a longer prefix is present, the last
+ * 8 bits select an entry of a group of 256 entries. IPv6 prefixes are stored in a multibit trie
+ * with the same encoding of entries, i.e. the first 16 bits select an entry of the root and
+ * each next byte of an address selects an entry of a group of the next level.
+ *
+ * Prefixes are expanded into all covered entries (i.e. a lookup never backtracks), therefore,
+ * the lookup of an IPv4 address takes 1 or 2 memory accesses. An entry is either zero (no
+ * prefix), an index of a value (1..N) or TABLE_GROUP | index of a group.
+ *
+ * The table is immutable after it's loaded, so a new table can be built while the old one is
+ * still in use and then replaced by a pointer swap.
+ */
+struct table {
+    /** IPv4 main table (2^24 entries, NULL if there are no IPv4 prefixes)                 */
+    uint32_t *v4_tbl24;
+    /** IPv4 groups of the last 8 bits                                                     */
+    uint32_t *v4_tbl8;
+    /** Number of IPv4 groups                                                              */
+    uint32_t v4_groups;
+    /** IPv6 root (TABLE_V6_ROOT entries) followed by groups (NULL if there are no prefixes) */
+    uint32_t *v6_nodes;
+    /** Number of IPv6 groups                                                              */
+    uint32_t v6_groups;
+    /** Values of prefixes (index 0 is unused)                                             */
+    struct table_value *values;
+    /** Number of values (including the unused one)                                        */
+    uint32_t values_cnt;
+    /** Total size of lookup tables (bytes)                                                */
+    size_t mem_size;
+};
+
+/**
+ * \brief Load a prefix table from a file
+ *
+ * Each line of the file contains a prefix (IPv4 or IPv6 address and an optional prefix
+ * length), an ASN and an optional country code and tag separated by white spaces. Empty lines
+ * and lines starting with '#' are ignored.
+ * \param[in]  path    Path to the file
+ * \param[out] err     Buffer for an error message
+ * \param[in]  err_len Size of the buffer
+ * \return Pointer to the table or NULL (see the error message)
+ */
+struct table *
+table_load(const char *path, char *err, size_t err_len);
+
+/**
+ * \brief Destroy a prefix table
+ * \param[in] tbl Table
+ */
+void
+table_destroy(struct table *tbl);
+
+/**
+ * \brief Find the longest prefix of an IPv4 address
+ * \param[in] tbl  Table
+ * \param[in] addr Address (network byte order)
+ * \return Value of the prefix or NULL
+ */
+static inline const struct table_value *
+table_lookup4(const struct table *tbl, const uint8_t *addr)
+{
+    if (tbl->v4_tbl24 == NULL) {
+        return NULL;
+    }
+
+    uint32_t entry = tbl->v4_tbl24[((uint32_t) addr[0] << 16) | ((uint32_t) addr[1] << 8) | addr[2]];
+    if (entry & TABLE_GROUP) {
+        entry = tbl->v4_tbl8[(entry & ~TABLE_GROUP) * TABLE_GROUP_SIZE + addr[3]];
+    }
+
+    return (entry != 0) ? &tbl->values[entry] : NULL;
+}
+
+/**
+ * \brief Find the longest prefix of an IPv6 address
+ * \param[in] tbl  Table
+ * \param[in] addr Address (network byte order)
+ * \return Value of the prefix or NULL
+ */
+static inline const struct table_value *
+table_lookup6(const struct table *tbl, const uint8_t *addr)
+{
+    if (tbl->v6_nodes == NULL) {
+        return NULL;
+    }
+
+    uint32_t entry = tbl->v6_nodes[((uint32_t) addr[0] << 8) | addr[1]];
+    for (unsigned int i = 2; (entry & TABLE_GROUP) != 0 && i < 16U; ++i) {
+        entry = tbl->v6_nodes[TABLE_V6_ROOT + (entry & ~TABLE_GROUP) * TABLE_GROUP_SIZE + addr[i]];
+    }
+
+    return (entry != 0) ? &tbl->values[entry] : NULL;
+}
+
+#endif // TABLE_H
@@ -0,0 +1,180 @@
+/**
+ * \file src/plugins/intermediate/filter/filter.c
+ * \author agent <agent@local>
+ * \brief Filter of flow records for IPFIXcol2
+ * \date 2026
+ */
+
+/* Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is'', and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#include <ipfixcol2.h>
+#include <stdlib.h>
+#include <inttypes.h>
+
+#include "config.h"
+
+/** Plugin description */
+IPX_API struct ipx_plugin_info ipx_plugin_info = {
+    // Plugin type
+    .type = IPX_PT_INTERMEDIATE,
+    // Plugin identification name
+    .name = "filter",
+    // Brief description of plugin
+    .dsc = "Filter of flow records",
+    // Configuration flags (reserved for future use)
+    .flags = 0,
+    // Plugin version string (like "1.2.3")
+    .version = "2.0.0",
+    // Minimal IPFIXcol version string (like "1.2.3")
+    .ipx_min = "2.0.0"
+};
+
+/** Instance */
+struct instance_data {
+    /** Parsed configuration of the instance                                            */
+    struct filter_config *config;
+    /** Compiled filter expression                                                      */
+    fds_ipfix_filter_t *filter;
+
+    /** Flags of Data Records of the processed message (non-zero == matched)            */
+    struct ipx_drec_flags keep;
+
+    /** Number of processed Data Records                                                */
+    uint64_t recs_total;
+    /** Number of passed Data Records                                                   */
+    uint64_t recs_passed;
+};
+
+/**
+ * \brief Evaluate the filter on a Data Record
+ *
+ * A biflow record matches if the filter matches at least one of its directions.
+ * \param[in] filter Compiled filter
+ * \param[in] rec    Data Record
+ * \return True or false
+ */
+static inline bool
+record_match(fds_ipfix_filter_t *filter, struct fds_drec *rec)
+{
+    if ((rec->tmplt->flags & FDS_TEMPLATE_BIFLOW) == 0) {
+        return fds_ipfix_filter_eval(filter, rec);
+    }
+
+    return fds_ipfix_filter_eval_biflow(filter, rec) != FDS_IPFIX_FILTER_NO_MATCH;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+int
+ipx_plugin_init(ipx_ctx_t *ctx, const char *params)
+{
+    // Create a private data
+    struct instance_data *data = calloc(1, sizeof(*data));
+    if (!data) {
+        return IPX_ERR_DENIED;
+    }
+
+    if ((data->config = config_parse(ctx, params)) == NULL) {
+        free(data);
+        return IPX_ERR_DENIED;
+    }
+
+    // Compile the expression (each instance and replica has its own filter)
+    const fds_iemgr_t *iemgr = ipx_ctx_iemgr_get(ctx);
+    if (fds_ipfix_filter_create(&data->filter, iemgr, data->config->expr) != FDS_OK) {
+        const char *err_msg = (data->filter != NULL)
+            ? fds_ipfix_filter_get_error(data->filter)
+            : "memory allocation error";
+        IPX_CTX_ERROR(ctx, "Failed to compile the filter expression: %s", err_msg);
+        ipx_plugin_destroy(ctx, data);
+        return IPX_ERR_DENIED;
+    }
+
+    ipx_ctx_private_set(ctx, data);
+    return IPX_OK;
+}
+
+void
+ipx_plugin_destroy(ipx_ctx_t *ctx, void *cfg)
+{
+    struct instance_data *data = (struct instance_data *) cfg;
+
+    if (data->recs_total > 0) {
+        IPX_CTX_INFO(ctx, "Passed %" PRIu64 " of %" PRIu64 " Data Records (%.1f%%)",
+            data->recs_passed, data->recs_total,
+            100.0 * (double) data->recs_passed / (double) data->recs_total);
+    }
+
+    fds_ipfix_filter_destroy(data->filter);
+    ipx_msg_ipfix_drec_flags_free(&data->keep);
+    config_destroy(data->config);
+    free(data);
+}
+
+int
+ipx_plugin_process(ipx_ctx_t *ctx, void *cfg, ipx_msg_t *msg)
+{
+    struct instance_data *data = (struct instance_data *) cfg;
+    ipx_msg_ipfix_t *ipfix_msg = ipx_msg_base2ipfix(msg);
+    const uint32_t rec_cnt = ipx_msg_ipfix_get_drec_cnt(ipfix_msg);
+
+    uint8_t *keep = ipx_msg_ipfix_drec_flags(ipfix_msg, &data->keep);
+    if (!keep) {
+        // Records cannot be filtered, pass them all rather than lose them
+        IPX_CTX_ERROR(ctx, "Memory allocation error (%s:%d)", __FILE__, __LINE__);
+        ipx_ctx_msg_pass(ctx, msg);
+        return IPX_OK;
+    }
+
+    // Evaluate all records first, references are compacted at once
+    uint32_t matches = 0;
+    for (uint32_t i = 0; i < rec_cnt; ++i) {
+        struct ipx_ipfix_record *rec = ipx_msg_ipfix_get_drec(ipfix_msg, i);
+        const bool match = record_match(data->filter, &rec->rec);
+        keep[i] = match;
+        matches += match;
+    }
+
+    if (matches != rec_cnt) {
+        ipx_msg_ipfix_drec_compact(ipfix_msg, keep);
+    }
+
+    data->recs_total += rec_cnt;
+    data->recs_passed += matches;
+
+    // Always pass the message (Template Sets and remaining records)
+    ipx_ctx_msg_pass(ctx, msg);
+    return IPX_OK;
+}
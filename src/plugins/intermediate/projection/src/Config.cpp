@@ -0,0 +1,144 @@
+/**
+ * \file src/plugins/intermediate/projection/src/Config.cpp
+ * \author agent <agent@local>
+ * \brief Parser of XML configuration (source file)
+ * \date 2026
+ *
+ * Copyright(c) 2026 CESNET z.s.p.o.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include "Config.hpp"
+#include <cassert>
+#include <memory>
+#include <stdexcept>
+
+/*
+ * <params>
+ *   <fields>
+ *     <field>...</field>                <!-- multiple -->
+ *   </fields>
+ *   <keepOptions>...</keepOptions>      <!-- optional -->
+ * </params>
+ */
+
+/// XML nodes
+enum params_xml_nodes {
+    NODE_FIELDS = 1,
+    NODE_KEEP_OPTS,
+
+    FIELDS_FIELD
+};
+
+/// Definition of the \<fields\> node
+static const struct fds_xml_args args_fields[] = {
+    FDS_OPTS_ELEM(FIELDS_FIELD,   "field",       FDS_OPTS_T_STRING, FDS_OPTS_P_MULTI),
+    FDS_OPTS_END
+};
+
+/// Definition of the \<params\> node
+static const struct fds_xml_args args_params[] = {
+    FDS_OPTS_ROOT("params"),
+    FDS_OPTS_NESTED(NODE_FIELDS,  "fields",      args_fields,       0),
+    FDS_OPTS_ELEM(NODE_KEEP_OPTS, "keepOptions", FDS_OPTS_T_BOOL,   FDS_OPTS_P_OPT),
+    FDS_OPTS_END
+};
+
+Config::Config(const char *params)
+{
+    set_default();
+
+    // Create XML parser
+    std::unique_ptr<fds_xml_t, decltype(&fds_xml_destroy)> xml(fds_xml_create(), &fds_xml_destroy);
+    if (!xml) {
+        throw std::runtime_error("Failed to create an XML parser!");
+    }
+
+    if (fds_xml_set_args(xml.get(), args_params) != FDS_OK) {
+        throw std::runtime_error("Failed to parse the description of an XML document!");
+    }
+
+    fds_xml_ctx_t *params_ctx = fds_xml_parse_mem(xml.get(), params, true);
+    if (!params_ctx) {
+        std::string err = fds_xml_last_err(xml.get());
+        throw std::runtime_error("Failed to parse the configuration: " + err);
+    }
+
+    // Parse parameters and check configuration
+    try {
+        parse_root(params_ctx);
+        validate();
+    } catch (std::exception &ex) {
+        throw std::runtime_error("Failed to parse the configuration: " + std::string(ex.what()));
+    }
+}
+
+/**
+ * @brief Set default parameters
+ */
+void
+Config::set_default()
+{
+    m_fields.clear();
+    m_keep_options = true;
+}
+
+/**
+ * @brief Check if the configuration is valid
+ * @throw runtime_error if the configuration breaks some rules
+ */
+void
+Config::validate()
+{
+    if (m_fields.empty()) {
+        throw std::runtime_error("At least one field must be specified!");
+    }
+}
+
+/**
+ * @brief Process \<params\> node
+ * @param[in] ctx XML context to process
+ * @throw runtime_error if the parser fails
+ */
+void
+Config::parse_root(fds_xml_ctx_t *ctx)
+{
+    const struct fds_xml_cont *content;
+    while (fds_xml_next(ctx, &content) != FDS_EOC) {
+        switch (content->id) {
+        case NODE_FIELDS:
+            assert(content->type == FDS_OPTS_T_CONTEXT);
+            parse_fields(content->ptr_ctx);
+            break;
+        case NODE_KEEP_OPTS:
+            assert(content->type == FDS_OPTS_T_BOOL);
+            m_keep_options = content->val_bool;
+            break;
+        default:
+            // Internal error
+            throw std::runtime_error("Unknown XML node");
+        }
+    }
+}
+
+/**
+ * @brief Auxiliary function for parsing \<fields\> options
+ * @param[in] ctx XML context to process
+ * @throw runtime_error if the parser fails
+ */
+void
+Config::parse_fields(fds_xml_ctx_t *ctx)
+{
+    const struct fds_xml_cont *content;
+    while (fds_xml_next(ctx, &content) != FDS_EOC) {
+        switch (content->id) {
+        case FIELDS_FIELD:
+            assert(content->type == FDS_OPTS_T_STRING);
+            m_fields.emplace_back(content->ptr_string);
+            break;
+        default:
+            // Internal error
+            throw std::runtime_error("Unknown XML node");
+        }
+    }
+}
@@ -0,0 +1,48 @@
+/**
+ * \file src/plugins/intermediate/projection/src/Config.hpp
+ * \author agent <agent@local>
+ * \brief Parser of XML configuration (header file)
+ * \date 2026
+ *
+ * Copyright(c) 2026 CESNET z.s.p.o.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef IPFIXCOL2_PROJECTION_CONFIG_HPP
+#define IPFIXCOL2_PROJECTION_CONFIG_HPP
+
+#include <string>
+#include <vector>
+#include <libfds.h>
+
+/**
+ * @brief Plugin configuration parser
+ */
+class Config {
+public:
+    /**
+     * @brief Parse configuration of the plugin
+     * @param[in] params XML parameters to parse
+     * @throw runtime_exception on error
+     */
+    Config(const char *params);
+    ~Config() = default;
+
+    /// Names of Information Elements to keep
+    std::vector<std::string> m_fields;
+    /// Pass records of Options Templates unchanged (otherwise they are dropped)
+    bool m_keep_options;
+
+private:
+    void
+    set_default();
+    void
+    validate();
+
+    void
+    parse_root(fds_xml_ctx_t *ctx);
+    void
+    parse_fields(fds_xml_ctx_t *ctx);
+};
+
+#endif // IPFIXCOL2_PROJECTION_CONFIG_HPP
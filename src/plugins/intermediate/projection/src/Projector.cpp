@@ -0,0 +1,544 @@
+/**
+ * \file src/plugins/intermediate/projection/src/Projector.cpp
+ * \author agent <agent@local>
+ * \brief Projection of records to selected fields (source file)
+ * \date 2026
+ *
+ * Copyright(c) 2026 CESNET z.s.p.o.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include "Projector.hpp"
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <arpa/inet.h>
+
+/// Maximum size of an IPFIX Message
+static const size_t MSG_MAX_SIZE = UINT16_MAX;
+/// Size of a header of a Template record
+static const size_t TREC_HDR_LEN = 4U;
+/// Size of a header of an Options Template record
+static const size_t OPTS_TREC_HDR_LEN = 6U;
+/// Size of a field specifier of a Template (without Enterprise Number)
+static const size_t FIELD_SPEC_LEN = 4U;
+/// Size of an Enterprise Number of a field specifier
+static const size_t FIELD_PEN_LEN = 4U;
+
+/**
+ * @brief Get a key of a field
+ * @param[in] pen Private Enterprise Number
+ * @param[in] id  Information Element ID
+ */
+static inline uint64_t
+field_key(uint32_t pen, uint16_t id)
+{
+    return (uint64_t(pen) << 16) | id;
+}
+
+Projector::Projector(ipx_ctx_t *ctx, const Config &cfg)
+    : m_ctx(ctx), m_keep_options(cfg.m_keep_options)
+{
+    const fds_iemgr_t *iemgr = ipx_ctx_iemgr_get(ctx);
+    if (!iemgr) {
+        throw std::runtime_error("Definitions of Information Elements are not available!");
+    }
+
+    for (const auto &name : cfg.m_fields) {
+        const fds_iemgr_elem *elem = fds_iemgr_elem_find_name(iemgr, name.c_str());
+        if (!elem) {
+            throw std::runtime_error("Unknown field '" + name + "'!");
+        }
+
+        m_fields.insert(field_key(elem->scope->pen, elem->id));
+    }
+}
+
+Projector::~Projector()
+{
+    for (auto &it : m_domains) {
+        garbage_pass(it.second.tmgr, (ipx_msg_garbage_cb) &fds_tmgr_destroy);
+    }
+}
+
+/**
+ * @brief Pass an object to destroy as garbage
+ *
+ * If a garbage message cannot be created, the object is leaked (others might still use it).
+ * @param[in] obj Object
+ * @param[in] cb  Destructor of the object
+ */
+void
+Projector::garbage_pass(void *obj, ipx_msg_garbage_cb cb)
+{
+    ipx_msg_garbage_t *garbage = ipx_msg_garbage_create(obj, cb);
+    if (!garbage) {
+        IPX_CTX_ERROR(m_ctx, "Memory allocation error (%s:%d)", __FILE__, __LINE__);
+        return;
+    }
+
+    ipx_ctx_msg_pass(m_ctx, ipx_msg_garbage2base(garbage));
+}
+
+void
+Projector::session_close(const struct ipx_session *session)
+{
+    auto it = m_domains.lower_bound(std::make_tuple(session, 0U, uint16_t(0)));
+    while (it != m_domains.end() && std::get<0>(it->first) == session) {
+        garbage_pass(it->second.tmgr, (ipx_msg_garbage_cb) &fds_tmgr_destroy);
+        it = m_domains.erase(it);
+    }
+}
+
+/**
+ * @brief Prepare the projection of records of an (Options) Template
+ *
+ * The derived Template contains selected fields of the original Template in the same order.
+ * It is added to the Template manager of the domain, but the snapshot is not updated.
+ * @param[in]  domain Domain of the Template
+ * @param[in]  tmplt  Original (Options) Template
+ * @param[out] plan   Projection
+ * @throw runtime_error if the derived Template cannot be created
+ */
+void
+Projector::plan_create(Domain &domain, const struct fds_template *tmplt, Plan &plan)
+{
+    plan.raw.assign(tmplt->raw.data, tmplt->raw.data + tmplt->raw.length);
+    plan.tmplt = nullptr;
+    plan.var = false;
+    plan.copy.clear();
+    plan.keep.assign(tmplt->fields_cnt_total, false);
+    plan.size = 0;
+    plan.announce = false;
+
+    const bool opts = (tmplt->type == FDS_TYPE_TEMPLATE_OPTS);
+    if (opts && !m_keep_options) {
+        // Records are dropped
+        return;
+    }
+
+    // Header of the derived Template (the number of fields is filled later)
+    const size_t hdr_len = opts ? OPTS_TREC_HDR_LEN : TREC_HDR_LEN;
+    std::vector<uint8_t> raw(tmplt->raw.data, tmplt->raw.data + hdr_len);
+    const uint8_t *spec = tmplt->raw.data + hdr_len;
+    uint16_t kept = 0;
+
+    for (uint16_t i = 0; i < tmplt->fields_cnt_total; ++i) {
+        const struct fds_tfield &field = tmplt->fields[i];
+        const size_t spec_len = FIELD_SPEC_LEN + ((field.en != 0) ? FIELD_PEN_LEN : 0);
+
+        // All fields of Options Templates are kept (i.e. records are passed unchanged)
+        if (opts || m_fields.count(field_key(field.en, field.id)) != 0) {
+            plan.keep[i] = true;
+            raw.insert(raw.end(), spec, spec + spec_len);
+            kept++;
+
+            if (field.length == FDS_IPFIX_VAR_IE_LEN || field.offset == FDS_IPFIX_VAR_IE_LEN) {
+                // The position of the field is not fixed
+                plan.var = true;
+            } else if (!plan.copy.empty()
+                    && plan.copy.back().offset + plan.copy.back().size == field.offset) {
+                // Adjacent fields are copied at once
+                plan.copy.back().size += field.length;
+            } else {
+                plan.copy.push_back({field.offset, field.length});
+            }
+            if (!plan.var) {
+                plan.size += field.length;
+            }
+        }
+        spec += spec_len;
+    }
+
+    if (kept == 0) {
+        // Records don't have any selected field -> dropped
+        return;
+    }
+
+    // Number of fields of the derived Template
+    auto *trec = reinterpret_cast<struct fds_ipfix_trec *>(raw.data());
+    trec->count = htons(kept);
+
+    struct fds_template *derived;
+    uint16_t raw_len = static_cast<uint16_t>(raw.size());
+    const enum fds_template_type type = opts ? FDS_TYPE_TEMPLATE_OPTS : FDS_TYPE_TEMPLATE;
+    if (fds_template_parse(type, raw.data(), &raw_len, &derived) != FDS_OK) {
+        throw std::runtime_error("Failed to create a derived Template (ID "
+            + std::to_string(tmplt->id) + ")!");
+    }
+
+    if (fds_tmgr_template_add(domain.tmgr, derived) != FDS_OK) {
+        fds_template_destroy(derived);
+        throw std::runtime_error("Failed to add a derived Template (ID "
+            + std::to_string(tmplt->id) + ")!");
+    }
+
+    // The pointer is replaced by the one from the next snapshot
+    plan.tmplt = derived;
+    plan.announce = true;
+    m_stat_tmplts++;
+}
+
+/**
+ * @brief Get the projection of records of an (Options) Template
+ *
+ * Plans are identified by Template IDs. A plan is prepared again if the Template has been
+ * redefined (i.e. its definition is different).
+ * If the plan has been prepared, the domain is marked as changed.
+ * @param[in] domain Domain of the Template
+ * @param[in] tmplt  Original (Options) Template
+ * @return Projection
+ * @throw runtime_error if the derived Template cannot be created
+ */
+Projector::Plan *
+Projector::plan_get(Domain &domain, const struct fds_template *tmplt)
+{
+    for (const auto &it : m_cache) {
+        if (it.first == tmplt) {
+            return it.second;
+        }
+    }
+
+    // Check the definition only once per message
+    Plan &plan = domain.plans[tmplt->id];
+    if (plan.raw.size() != tmplt->raw.length
+            || memcmp(plan.raw.data(), tmplt->raw.data, tmplt->raw.length) != 0) {
+        domain.changed = true;
+        try {
+            plan_create(domain, tmplt, plan);
+        } catch (...) {
+            // Try again next time
+            plan.raw.clear();
+            plan.tmplt = nullptr;
+            throw;
+        }
+    }
+
+    m_cache.emplace_back(tmplt, &plan);
+    return &plan;
+}
+
+/**
+ * @brief Update the snapshot of derived Templates after their changes
+ *
+ * Replaced Templates and old snapshots are passed as garbage after the current message.
+ * @param[in] domain Domain
+ * @throw runtime_error if the snapshot is not available
+ */
+void
+Projector::snapshot_update(Domain &domain)
+{
+    if (fds_tmgr_snapshot_get(domain.tmgr, &domain.snap) != FDS_OK) {
+        throw std::runtime_error("Failed to get a Template snapshot!");
+    }
+    domain.snap_gen++;
+
+    for (auto &it : domain.plans) {
+        Plan &plan = it.second;
+        if (plan.announce) {
+            plan.tmplt = fds_tsnapshot_template_get(domain.snap, it.first);
+        }
+    }
+}
+
+/**
+ * @brief Copy selected fields of a Data Record
+ * @param[in]  plan Projection of the record
+ * @param[in]  rec  Original Data Record
+ * @param[out] out  Output buffer (at least the size of the original record)
+ * @return Size of the projected record
+ */
+uint16_t
+Projector::record_project(const Plan &plan, const struct fds_drec &rec, uint8_t *out) const
+{
+    if (!plan.var) {
+        uint8_t *pos = out;
+        for (const Copy &part : plan.copy) {
+            memcpy(pos, rec.data + part.offset, part.size);
+            pos += part.size;
+        }
+        return plan.size;
+    }
+
+    // Variable-length fields must be walked through (their encoding is kept)
+    const struct fds_template *tmplt = rec.tmplt;
+    uint16_t rec_pos = 0;
+    uint16_t out_pos = 0;
+
+    for (uint16_t i = 0; i < tmplt->fields_cnt_total; ++i) {
+        uint32_t size = tmplt->fields[i].length;
+        if (size == FDS_IPFIX_VAR_IE_LEN) {
+            if (rec_pos + 1U > rec.size) {
+                break;
+            }
+
+            size = rec.data[rec_pos];
+            if (size < 255U) {
+                size += 1U;
+            } else if (rec_pos + 3U <= rec.size) {
+                size = 3U + ((uint32_t(rec.data[rec_pos + 1]) << 8) | rec.data[rec_pos + 2]);
+            } else {
+                break;
+            }
+        }
+
+        if (rec_pos + size > rec.size) {
+            // Malformed record (should be already checked by the parser)
+            break;
+        }
+
+        if (plan.keep[i]) {
+            memcpy(out + out_pos, rec.data + rec_pos, size);
+            out_pos += size;
+        }
+        rec_pos += size;
+    }
+
+    return out_pos;
+}
+
+/**
+ * @brief Create Template Sets with derived Templates to announce
+ * @param[in] domain Domain
+ * @return Template Sets (empty if there is nothing to announce)
+ */
+std::vector<uint8_t>
+Projector::tsets_create(Domain &domain) const
+{
+    std::vector<uint8_t> tsets;
+
+    for (enum fds_template_type type : {FDS_TYPE_TEMPLATE, FDS_TYPE_TEMPLATE_OPTS}) {
+        const size_t set_start = tsets.size();
+
+        for (auto &it : domain.plans) {
+            const Plan &plan = it.second;
+            if (!plan.announce || plan.tmplt == nullptr || plan.tmplt->type != type) {
+                continue;
+            }
+
+            if (tsets.size() == set_start) {
+                tsets.resize(set_start + FDS_IPFIX_SET_HDR_LEN);
+            }
+            tsets.insert(tsets.end(), plan.tmplt->raw.data,
+                plan.tmplt->raw.data + plan.tmplt->raw.length);
+        }
+
+        if (tsets.size() == set_start) {
+            continue;
+        }
+
+        auto *set_hdr = reinterpret_cast<struct fds_ipfix_set_hdr *>(tsets.data() + set_start);
+        set_hdr->flowset_id = htons((type == FDS_TYPE_TEMPLATE)
+            ? FDS_IPFIX_SET_TMPLT : FDS_IPFIX_SET_OPTS_TMPLT);
+        set_hdr->length = htons(static_cast<uint16_t>(tsets.size() - set_start));
+    }
+
+    if (tsets.size() + FDS_IPFIX_MSG_HDR_LEN > MSG_MAX_SIZE) {
+        throw std::runtime_error("Derived Templates don't fit into an IPFIX Message!");
+    }
+
+    for (auto &it : domain.plans) {
+        it.second.announce = false;
+    }
+
+    return tsets;
+}
+
+/**
+ * @brief Create an IPFIX Message with projected records
+ * @param[in] domain Domain of the message
+ * @param[in] orig   Original IPFIX Message
+ * @param[in] tsets  Template Sets to add (can be empty)
+ * @param[in] idx    Index of the first projected record
+ * @param[in] cnt    Number of projected records
+ * @param[in] size   Size of the message
+ * @return IPFIX Message (with references to its Sets and Data Records)
+ * @throw bad_alloc in case of a memory allocation error
+ */
+ipx_msg_ipfix_t *
+Projector::msg_create(Domain &domain, ipx_msg_ipfix_t *orig, const std::vector<uint8_t> &tsets,
+    size_t idx, size_t cnt, size_t size)
+{
+    assert(size <= MSG_MAX_SIZE);
+    uint8_t *buffer = static_cast<uint8_t *>(ipx_utils_buf_alloc(size));
+    if (!buffer) {
+        throw std::bad_alloc();
+    }
+
+    // Message header (Export Time and ODID of the original message)
+    memcpy(buffer, ipx_msg_ipfix_get_packet(orig), FDS_IPFIX_MSG_HDR_LEN);
+    auto *hdr = reinterpret_cast<struct fds_ipfix_msg_hdr *>(buffer);
+    hdr->version = htons(FDS_IPFIX_VERSION);
+    hdr->length = htons(static_cast<uint16_t>(size));
+    hdr->seq_num = htonl(domain.seq_num);
+
+    uint8_t *pos = buffer + FDS_IPFIX_MSG_HDR_LEN;
+    memcpy(pos, tsets.data(), tsets.size());
+    pos += tsets.size();
+
+    // Data Sets (consecutive records of the same Template share a Set)
+    struct fds_ipfix_set_hdr *dset_hdr = nullptr;
+    const Plan *dset_plan = nullptr;
+
+    for (size_t i = idx; i < idx + cnt; ++i) {
+        const Rec &rec = m_recs[i];
+        if (rec.plan != dset_plan) {
+            dset_hdr = reinterpret_cast<struct fds_ipfix_set_hdr *>(pos);
+            dset_hdr->flowset_id = htons(rec.plan->tmplt->id);
+            dset_hdr->length = htons(FDS_IPFIX_SET_HDR_LEN);
+            dset_plan = rec.plan;
+            pos += FDS_IPFIX_SET_HDR_LEN;
+        }
+
+        memcpy(pos, m_buffer.data() + rec.offset, rec.size);
+        dset_hdr->length = htons(static_cast<uint16_t>(ntohs(dset_hdr->length) + rec.size));
+        pos += rec.size;
+    }
+    assert(pos == buffer + size);
+
+    // Wrap the message and describe its content
+    const struct ipx_msg_ctx *orig_ctx = ipx_msg_ipfix_get_ctx(orig);
+    struct ipx_msg_ctx msg_ctx;
+    memset(&msg_ctx, 0, sizeof(msg_ctx));
+    msg_ctx.session = orig_ctx->session;
+    msg_ctx.odid = orig_ctx->odid;
+    msg_ctx.stream = orig_ctx->stream;
+
+    ipx_msg_ipfix_t *msg = ipx_msg_ipfix_wrap(m_ctx, &msg_ctx, buffer, domain.snap);
+    if (!msg) {
+        ipx_utils_buf_free(buffer);
+        throw std::bad_alloc();
+    }
+
+    struct ipx_msg_ctx *new_ctx = ipx_msg_ipfix_get_ctx(msg);
+    new_ctx->ingress_ts = orig_ctx->ingress_ts;
+    new_ctx->snap_gen = domain.snap_gen;
+    ipx_msg_ipfix_branch_set(msg, ipx_msg_ipfix_branch_get(orig));
+
+    domain.seq_num += static_cast<uint32_t>(cnt);
+    return msg;
+}
+
+/**
+ * @brief Pass projected records of the current message in IPFIX Messages
+ *
+ * Records are split into multiple messages if they don't fit into one.
+ * @param[in] domain Domain of the messages
+ * @param[in] orig   Original IPFIX Message
+ * @param[in] tsets  Template Sets to add to the first message (can be empty)
+ * @throw bad_alloc in case of a memory allocation error
+ */
+void
+Projector::msgs_send(Domain &domain, ipx_msg_ipfix_t *orig, const std::vector<uint8_t> &tsets)
+{
+    const std::vector<uint8_t> none;
+    const std::vector<uint8_t> *msg_tsets = &tsets;
+    size_t idx = 0;
+
+    do {
+        // Add as many records as possible
+        size_t size = FDS_IPFIX_MSG_HDR_LEN + msg_tsets->size();
+        size_t cnt = 0;
+        const Plan *dset_plan = nullptr;
+
+        while (idx + cnt < m_recs.size()) {
+            const Rec &rec = m_recs[idx + cnt];
+            size_t rec_size = rec.size;
+            if (rec.plan != dset_plan) {
+                rec_size += FDS_IPFIX_SET_HDR_LEN;
+            }
+            if (size + rec_size > MSG_MAX_SIZE) {
+                break;
+            }
+
+            size += rec_size;
+            dset_plan = rec.plan;
+            cnt++;
+        }
+
+        ipx_msg_ipfix_t *msg = msg_create(domain, orig, *msg_tsets, idx, cnt, size);
+        ipx_ctx_msg_pass(m_ctx, ipx_msg_ipfix2base(msg));
+        idx += cnt;
+        msg_tsets = &none;
+    } while (idx < m_recs.size());
+}
+
+void
+Projector::process(ipx_msg_ipfix_t *msg)
+{
+    // The original message is always destroyed
+    std::unique_ptr<ipx_msg_ipfix_t, decltype(&ipx_msg_ipfix_destroy)> msg_ptr(msg,
+        &ipx_msg_ipfix_destroy);
+    const struct ipx_msg_ctx *msg_ctx = ipx_msg_ipfix_get_ctx(msg);
+    const uint32_t rec_cnt = ipx_msg_ipfix_get_drec_cnt(msg);
+
+    // Domain of the message
+    auto domain_key = std::make_tuple(msg_ctx->session, msg_ctx->odid,
+        ipx_msg_ipfix_branch_get(msg));
+    auto domain_it = m_domains.find(domain_key);
+    if (domain_it == m_domains.end()) {
+        fds_tmgr_t *tmgr = fds_tmgr_create(FDS_SESSION_FILE);
+        if (!tmgr) {
+            throw std::bad_alloc();
+        }
+        if (fds_tmgr_set_iemgr(tmgr, ipx_ctx_iemgr_get(m_ctx)) != FDS_OK
+                || fds_tmgr_set_time(tmgr, 0) != FDS_OK) {
+            fds_tmgr_destroy(tmgr);
+            throw std::runtime_error("Failed to configure a Template manager!");
+        }
+
+        domain_it = m_domains.emplace(domain_key, Domain()).first;
+        domain_it->second.tmgr = tmgr;
+    }
+    Domain &domain = domain_it->second;
+
+    // Project records (derived Templates are prepared first)
+    m_cache.clear();
+    m_recs.clear();
+    m_buffer.clear();
+
+    for (uint32_t i = 0; i < rec_cnt; ++i) {
+        struct ipx_ipfix_record *rec = ipx_msg_ipfix_get_drec(msg, i);
+        m_stat_recs_in++;
+        m_stat_bytes_in += rec->rec.size;
+
+        const Plan *plan = plan_get(domain, rec->rec.tmplt);
+        if (plan->tmplt == nullptr) {
+            continue;
+        }
+
+        const size_t offset = m_buffer.size();
+        m_buffer.resize(offset + rec->rec.size);
+        const uint16_t size = record_project(*plan, rec->rec, m_buffer.data() + offset);
+        m_buffer.resize(offset + size);
+        m_recs.push_back({plan, offset, size});
+
+        m_stat_recs_out++;
+        m_stat_bytes_out += size;
+    }
+
+    // Update the snapshot (also after changes by a previous message that has failed)
+    const bool changed = domain.changed;
+    std::vector<uint8_t> tsets;
+    if (changed) {
+        snapshot_update(domain);
+        tsets = tsets_create(domain);
+        domain.changed = false;
+    }
+
+    // Replace the original message
+    if (!m_recs.empty() || !tsets.empty()) {
+        msgs_send(domain, msg, tsets);
+    }
+    msg_ptr.reset();
+
+    // Old Templates and snapshots can be freed after all messages that refer to them
+    fds_tgarbage_t *garbage;
+    if (changed && fds_tmgr_garbage_get(domain.tmgr, &garbage) == FDS_OK && garbage != nullptr) {
+        garbage_pass(garbage, (ipx_msg_garbage_cb) &fds_tmgr_garbage_destroy);
+    }
+}
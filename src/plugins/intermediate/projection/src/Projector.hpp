@@ -0,0 +1,173 @@
+/**
+ * \file src/plugins/intermediate/projection/src/Projector.hpp
+ * \author agent <agent@local>
+ * \brief Projection of records to selected fields (header file)
+ * \date 2026
+ *
+ * Copyright(c) 2026 CESNET z.s.p.o.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef IPFIXCOL2_PROJECTION_PROJECTOR_HPP
+#define IPFIXCOL2_PROJECTION_PROJECTOR_HPP
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <tuple>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+#include <ipfixcol2.h>
+#include <libfds.h>
+
+#include "Config.hpp"
+
+/**
+ * @brief Projection of Data Records to selected fields
+ *
+ * For each (Options) Template of an exporter, a derived Template with only the selected fields
+ * and a copy plan of its records are prepared when the Template is seen for the first time
+ * (or redefined). IPFIX Messages are then rebuilt, i.e. Data Records are copied into new
+ * IPFIX Messages of the same Transport Session and ODID without the other fields.
+ *
+ * Derived Templates have the same IDs as the original ones and are kept by a Template manager
+ * of each Transport Session and ODID. They are added to the first IPFIX Message after they have
+ * been (re)defined, so outputs that store raw messages (e.g. IPFIX File) get them too.
+ */
+class Projector {
+public:
+    /**
+     * @brief Create a projector
+     * @param[in] ctx Plugin context
+     * @param[in] cfg Configuration
+     * @throw runtime_error if a field is not known
+     */
+    Projector(ipx_ctx_t *ctx, const Config &cfg);
+    /**
+     * @brief Destroy the projector
+     *
+     * Template managers are passed as garbage (other plugins might still use their Templates).
+     */
+    ~Projector();
+
+    // Disable copy constructors
+    Projector(const Projector &other) = delete;
+    Projector &operator=(const Projector &other) = delete;
+
+    /**
+     * @brief Replace an IPFIX Message with projected IPFIX Message(s)
+     *
+     * The original message is destroyed and the projected ones are passed to the next plugins.
+     * @param[in] msg IPFIX Message
+     * @throw runtime_error if a derived Template cannot be created
+     * @throw bad_alloc in case of a memory allocation error
+     */
+    void
+    process(ipx_msg_ipfix_t *msg);
+
+    /**
+     * @brief Remove derived Templates of a closed Transport Session
+     *
+     * Must be called after the Transport Session message has been passed. Template managers
+     * of the Session are passed as garbage.
+     * @param[in] session Transport Session
+     */
+    void
+    session_close(const struct ipx_session *session);
+
+    /// Number of received Data Records
+    uint64_t m_stat_recs_in = 0;
+    /// Number of passed Data Records
+    uint64_t m_stat_recs_out = 0;
+    /// Total size of received Data Records
+    uint64_t m_stat_bytes_in = 0;
+    /// Total size of passed Data Records
+    uint64_t m_stat_bytes_out = 0;
+    /// Number of derived (Options) Templates
+    uint64_t m_stat_tmplts = 0;
+
+private:
+    /// Part of a record to copy
+    struct Copy {
+        uint16_t offset; ///< Offset from the start of the original record
+        uint16_t size;   ///< Size of the part
+    };
+
+    /// Projection of records of an (Options) Template
+    struct Plan {
+        /// Definition of the original (Options) Template (to detect redefinitions)
+        std::vector<uint8_t> raw;
+        /// Derived (Options) Template (nullptr == records are dropped)
+        const struct fds_template *tmplt = nullptr;
+        /// Positions of selected fields are not fixed (i.e. the copy plan cannot be used)
+        bool var = false;
+        /// Parts of records to copy (only for fields with fixed positions)
+        std::vector<Copy> copy;
+        /// Flags of fields to keep
+        std::vector<bool> keep;
+        /// Size of a projected record (only for fields with fixed positions)
+        uint16_t size = 0;
+        /// The derived Template must be added to the next IPFIX Message
+        bool announce = false;
+    };
+
+    /// Transport Session and ODID
+    struct Domain {
+        /// Template manager of derived Templates
+        fds_tmgr_t *tmgr = nullptr;
+        /// Current snapshot of derived Templates
+        const fds_tsnapshot_t *snap = nullptr;
+        /// Generation of the snapshot (changed whenever the snapshot is changed)
+        uint32_t snap_gen = 1;
+        /// Derived Templates have been changed since the last update of the snapshot
+        bool changed = false;
+        /// Sequence number (i.e. total number of passed Data Records)
+        uint32_t seq_num = 0;
+        /// Projections of (Options) Templates (Template ID -> plan)
+        std::unordered_map<uint16_t, Plan> plans;
+    };
+
+    /// Projected Data Record of the current message
+    struct Rec {
+        const Plan *plan; ///< Projection of the record
+        size_t offset;    ///< Offset of the projected record in the buffer
+        uint16_t size;    ///< Size of the projected record
+    };
+
+    /// Plugin context
+    ipx_ctx_t *m_ctx;
+    /// Pass records of Options Templates unchanged
+    bool m_keep_options;
+    /// Fields to keep (PEN << 16 | ID)
+    std::unordered_set<uint64_t> m_fields;
+    /// Domains (Transport Session, ODID, branch of the pipeline)
+    std::map<std::tuple<const struct ipx_session *, uint32_t, uint16_t>, Domain> m_domains;
+    /// Plans of Templates of the current message (Template -> plan)
+    std::vector<std::pair<const struct fds_template *, Plan *>> m_cache;
+    /// Projected records of the current message
+    std::vector<Rec> m_recs;
+    /// Buffer with projected records of the current message
+    std::vector<uint8_t> m_buffer;
+
+    Plan *
+    plan_get(Domain &domain, const struct fds_template *tmplt);
+    void
+    plan_create(Domain &domain, const struct fds_template *tmplt, Plan &plan);
+    void
+    snapshot_update(Domain &domain);
+    uint16_t
+    record_project(const Plan &plan, const struct fds_drec &rec, uint8_t *out) const;
+    std::vector<uint8_t>
+    tsets_create(Domain &domain) const;
+    void
+    msgs_send(Domain &domain, ipx_msg_ipfix_t *orig, const std::vector<uint8_t> &tsets);
+    ipx_msg_ipfix_t *
+    msg_create(Domain &domain, ipx_msg_ipfix_t *orig, const std::vector<uint8_t> &tsets,
+        size_t idx, size_t cnt, size_t size);
+    void
+    garbage_pass(void *obj, ipx_msg_garbage_cb cb);
+};
+
+#endif // IPFIXCOL2_PROJECTION_PROJECTOR_HPP
@@ -0,0 +1,108 @@
+/**
+ * \file src/plugins/intermediate/projection/src/projection.cpp
+ * \author agent <agent@local>
+ * \brief Projection of flow records to selected fields (intermediate plugin)
+ * \date 2026
+ *
+ * Copyright(c) 2026 CESNET z.s.p.o.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include <cinttypes>
+#include <memory>
+#include <stdexcept>
+#include <ipfixcol2.h>
+
+#include "Config.hpp"
+#include "Projector.hpp"
+
+/// Plugin description
+IPX_API struct ipx_plugin_info ipx_plugin_info = {
+    // Plugin identification name
+    "projection",
+    // Brief description of plugin
+    "Projection of flow records to selected fields",
+    // Plugin type
+    IPX_PT_INTERMEDIATE,
+    // Configuration flags (reserved for future use)
+    0,
+    // Plugin version string (like "1.2.3")
+    "2.0.0",
+    // Minimal IPFIXcol version string (like "1.2.3")
+    "2.0.0"
+};
+
+/// Instance
+struct Instance {
+    /// Parsed configuration
+    std::unique_ptr<Config> config_ptr = nullptr;
+    /// Projection of records
+    std::unique_ptr<Projector> projector_ptr = nullptr;
+};
+
+int
+ipx_plugin_init(ipx_ctx_t *ctx, const char *params)
+{
+    try {
+        std::unique_ptr<Instance> instance(new Instance);
+        instance->config_ptr.reset(new Config(params));
+        instance->projector_ptr.reset(new Projector(ctx, *instance->config_ptr));
+        ipx_ctx_private_set(ctx, instance.release());
+    } catch (const std::exception &ex) {
+        IPX_CTX_ERROR(ctx, "Initialization failed: %s", ex.what());
+        return IPX_ERR_DENIED;
+    } catch (...) {
+        IPX_CTX_ERROR(ctx, "Unknown error has occurred!", '\0');
+        return IPX_ERR_DENIED;
+    }
+
+    // Derived Templates of closed Transport Sessions must be removed
+    ipx_msg_mask_t mask = IPX_MSG_IPFIX | IPX_MSG_SESSION;
+    ipx_ctx_subscribe(ctx, &mask, nullptr);
+    return IPX_OK;
+}
+
+void
+ipx_plugin_destroy(ipx_ctx_t *ctx, void *cfg)
+{
+    auto inst = reinterpret_cast<Instance *>(cfg);
+    const Projector &projector = *inst->projector_ptr;
+
+    if (projector.m_stat_recs_in > 0) {
+        IPX_CTX_INFO(ctx, "Passed %" PRIu64 " of %" PRIu64 " Data Records, %" PRIu64 " of %"
+            PRIu64 " bytes (%.1f%%), %" PRIu64 " derived Templates", projector.m_stat_recs_out,
+            projector.m_stat_recs_in, projector.m_stat_bytes_out, projector.m_stat_bytes_in,
+            100.0 * double(projector.m_stat_bytes_out) / double(projector.m_stat_bytes_in),
+            projector.m_stat_tmplts);
+    }
+
+    delete inst;
+}
+
+int
+ipx_plugin_process(ipx_ctx_t *ctx, void *cfg, ipx_msg_t *msg)
+{
+    auto inst = reinterpret_cast<Instance *>(cfg);
+
+    if (ipx_msg_get_type(msg) == IPX_MSG_SESSION) {
+        // Pass the notification first, the derived Templates might be still used by others
+        ipx_msg_session_t *msg_session = ipx_msg_base2session(msg);
+        const struct ipx_session *session = ipx_msg_session_get_session(msg_session);
+        const bool closed = (ipx_msg_session_get_event(msg_session) == IPX_MSG_SESSION_CLOSE);
+        ipx_ctx_msg_pass(ctx, msg);
+
+        if (closed) {
+            inst->projector_ptr->session_close(session);
+        }
+        return IPX_OK;
+    }
+
+    try {
+        // The original message is replaced
+        inst->projector_ptr->process(ipx_msg_base2ipfix(msg));
+    } catch (const std::exception &ex) {
+        IPX_CTX_ERROR(ctx, "Failed to project records (records dropped): %s", ex.what());
+    }
+
+    return IPX_OK;
+}
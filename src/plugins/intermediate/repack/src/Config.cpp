@@ -0,0 +1,121 @@
+/**
+ * \file src/plugins/intermediate/repack/src/Config.cpp
+ * \author agent <agent@local>
+ * \brief Parser of XML configuration (source file)
+ * \date 2026
+ *
+ * Copyright(c) 2026 CESNET z.s.p.o.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include "Config.hpp"
+#include <cassert>
+#include <memory>
+#include <stdexcept>
+#include <string>
+
+/*
+ * <params>
+ *   <maxSize>...</maxSize>              <!-- optional -->
+ *   <maxDelay>...</maxDelay>            <!-- optional -->
+ * </params>
+ */
+
+/// XML nodes
+enum params_xml_nodes {
+    NODE_MAX_SIZE = 1,
+    NODE_MAX_DELAY
+};
+
+/// Definition of the \<params\> node
+static const struct fds_xml_args args_params[] = {
+    FDS_OPTS_ROOT("params"),
+    FDS_OPTS_ELEM(NODE_MAX_SIZE,  "maxSize",  FDS_OPTS_T_UINT, FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM(NODE_MAX_DELAY, "maxDelay", FDS_OPTS_T_UINT, FDS_OPTS_P_OPT),
+    FDS_OPTS_END
+};
+
+Config::Config(const char *params)
+{
+    set_default();
+
+    // Create XML parser
+    std::unique_ptr<fds_xml_t, decltype(&fds_xml_destroy)> xml(fds_xml_create(), &fds_xml_destroy);
+    if (!xml) {
+        throw std::runtime_error("Failed to create an XML parser!");
+    }
+
+    if (fds_xml_set_args(xml.get(), args_params) != FDS_OK) {
+        throw std::runtime_error("Failed to parse the description of an XML document!");
+    }
+
+    fds_xml_ctx_t *params_ctx = fds_xml_parse_mem(xml.get(), params, true);
+    if (!params_ctx) {
+        std::string err = fds_xml_last_err(xml.get());
+        throw std::runtime_error("Failed to parse the configuration: " + err);
+    }
+
+    // Parse parameters and check configuration
+    try {
+        parse_root(params_ctx);
+        validate();
+    } catch (std::exception &ex) {
+        throw std::runtime_error("Failed to parse the configuration: " + std::string(ex.what()));
+    }
+}
+
+/**
+ * @brief Set default parameters
+ */
+void
+Config::set_default()
+{
+    m_max_size = MAX_SIZE_DEF;
+    m_max_delay = MAX_DELAY_DEF;
+}
+
+/**
+ * @brief Check if the configuration is valid
+ * @throw runtime_error if the configuration breaks some rules
+ */
+void
+Config::validate()
+{
+    if (m_max_size < MAX_SIZE_MIN || m_max_size > MAX_SIZE_MAX) {
+        throw std::runtime_error("Maximum size of a message must be between "
+            + std::to_string(MAX_SIZE_MIN) + " and " + std::to_string(MAX_SIZE_MAX) + "!");
+    }
+
+    if (m_max_delay > MAX_DELAY_MAX) {
+        throw std::runtime_error("Maximum delay must be between 0 and "
+            + std::to_string(MAX_DELAY_MAX) + "!");
+    }
+}
+
+/**
+ * @brief Process \<params\> node
+ * @param[in] ctx XML context to process
+ * @throw runtime_error if the parser fails
+ */
+void
+Config::parse_root(fds_xml_ctx_t *ctx)
+{
+    const struct fds_xml_cont *content;
+    while (fds_xml_next(ctx, &content) != FDS_EOC) {
+        switch (content->id) {
+        case NODE_MAX_SIZE:
+            assert(content->type == FDS_OPTS_T_UINT);
+            m_max_size = (content->val_uint > UINT32_MAX)
+                ? UINT32_MAX : static_cast<uint32_t>(content->val_uint);
+            break;
+        case NODE_MAX_DELAY:
+            assert(content->type == FDS_OPTS_T_UINT);
+            m_max_delay = (content->val_uint > UINT32_MAX)
+                ? UINT32_MAX : static_cast<uint32_t>(content->val_uint);
+            break;
+        default:
+            // Internal error
+            throw std::runtime_error("Unknown XML node");
+        }
+    }
+}
@@ -0,0 +1,56 @@
+/**
+ * \file src/plugins/intermediate/repack/src/Config.hpp
+ * \author agent <agent@local>
+ * \brief Parser of XML configuration (header file)
+ * \date 2026
+ *
+ * Copyright(c) 2026 CESNET z.s.p.o.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef IPFIXCOL2_REPACK_CONFIG_HPP
+#define IPFIXCOL2_REPACK_CONFIG_HPP
+
+#include <cstdint>
+#include <libfds.h>
+
+/**
+ * @brief Plugin configuration parser
+ */
+class Config {
+public:
+    /**
+     * @brief Parse configuration of the plugin
+     * @param[in] params XML parameters to parse
+     * @throw runtime_exception on error
+     */
+    Config(const char *params);
+    ~Config() = default;
+
+    /// Maximum size of a merged IPFIX Message (in bytes)
+    uint32_t m_max_size;
+    /// Maximum time a message can be held (in milliseconds)
+    uint32_t m_max_delay;
+
+private:
+    /// Default maximum size of a merged message
+    static const uint32_t MAX_SIZE_DEF = 16384U;
+    /// Minimum of the maximum size of a merged message
+    static const uint32_t MAX_SIZE_MIN = 512U;
+    /// Maximum size of an IPFIX Message
+    static const uint32_t MAX_SIZE_MAX = UINT16_MAX;
+    /// Default maximum delay
+    static const uint32_t MAX_DELAY_DEF = 100U;
+    /// Maximum of the maximum delay
+    static const uint32_t MAX_DELAY_MAX = 10000U;
+
+    void
+    set_default();
+    void
+    validate();
+
+    void
+    parse_root(fds_xml_ctx_t *ctx);
+};
+
+#endif // IPFIXCOL2_REPACK_CONFIG_HPP
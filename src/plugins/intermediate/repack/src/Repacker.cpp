@@ -0,0 +1,268 @@
+/**
+ * \file src/plugins/intermediate/repack/src/Repacker.cpp
+ * \author agent <agent@local>
+ * \brief Merging of small IPFIX Messages (source file)
+ * \date 2026
+ *
+ * Copyright(c) 2026 CESNET z.s.p.o.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include "Repacker.hpp"
+#include <cassert>
+#include <cstring>
+#include <new>
+#include <ctime>
+#include <arpa/inet.h>
+
+/**
+ * @brief Get the current monotonic timestamp
+ * @return Timestamp in milliseconds
+ */
+static uint64_t
+now_ms()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC_COARSE, &ts);
+    return uint64_t(ts.tv_sec) * 1000U + uint64_t(ts.tv_nsec) / 1000000U;
+}
+
+/**
+ * @brief Get the IPFIX Message header of a message
+ * @param[in] msg IPFIX Message
+ * @return Header
+ */
+static inline const struct fds_ipfix_msg_hdr *
+msg_hdr(ipx_msg_ipfix_t *msg)
+{
+    return reinterpret_cast<const struct fds_ipfix_msg_hdr *>(ipx_msg_ipfix_get_packet(msg));
+}
+
+Repacker::Repacker(ipx_ctx_t *ctx, const Config &cfg)
+    : m_ctx(ctx), m_max_size(cfg.m_max_size), m_max_delay(cfg.m_max_delay)
+{
+}
+
+/**
+ * @brief Pass an IPFIX Message to the next plugins
+ * @param[in] msg IPFIX Message
+ */
+void
+Repacker::msg_pass(ipx_msg_ipfix_t *msg)
+{
+    ipx_ctx_msg_pass(m_ctx, ipx_msg_ipfix2base(msg));
+    m_stat_msgs_out++;
+}
+
+/**
+ * @brief Merge held IPFIX Messages of a domain into a new IPFIX Message
+ *
+ * The header is taken from the first message (i.e. the Sequence Number is the same), Sets of
+ * all messages are copied one after another and references to the Sets and Data Records are
+ * moved to the new buffer. Extensions of Data Records are not preserved.
+ * @param[in] domain Domain with at least two held messages
+ * @return New IPFIX Message
+ * @return nullptr if a Data Record is not part of its message (the messages cannot be merged)
+ * @throw bad_alloc in case of a memory allocation error
+ */
+ipx_msg_ipfix_t *
+Repacker::merge(const Domain &domain)
+{
+    assert(domain.msgs.size() > 1 && domain.size <= UINT16_MAX);
+    uint8_t *buffer = reinterpret_cast<uint8_t *>(ipx_utils_buf_alloc(domain.size));
+    if (!buffer) {
+        throw std::bad_alloc();
+    }
+
+    ipx_msg_ipfix_t *first = domain.msgs.front();
+    memcpy(buffer, msg_hdr(first), FDS_IPFIX_MSG_HDR_LEN);
+    auto *hdr = reinterpret_cast<struct fds_ipfix_msg_hdr *>(buffer);
+    hdr->length = htons(static_cast<uint16_t>(domain.size));
+
+    const struct ipx_msg_ctx *first_ctx = ipx_msg_ipfix_get_ctx(first);
+    ipx_msg_ipfix_t *msg = ipx_msg_ipfix_create(m_ctx, first_ctx, buffer,
+        static_cast<uint16_t>(domain.size));
+    if (!msg) {
+        ipx_utils_buf_free(buffer);
+        throw std::bad_alloc();
+    }
+
+    struct ipx_msg_ctx *msg_ctx = ipx_msg_ipfix_get_ctx(msg);
+    msg_ctx->ingress_ts = first_ctx->ingress_ts;
+    msg_ctx->snap_gen = domain.snap_gen;
+    ipx_msg_ipfix_branch_set(msg, ipx_msg_ipfix_branch_get(first));
+
+    uint8_t *pos = buffer + FDS_IPFIX_MSG_HDR_LEN;
+    for (ipx_msg_ipfix_t *orig : domain.msgs) {
+        const uint8_t *body = ipx_msg_ipfix_get_packet(orig) + FDS_IPFIX_MSG_HDR_LEN;
+        const size_t body_len = ntohs(msg_hdr(orig)->length) - FDS_IPFIX_MSG_HDR_LEN;
+        memcpy(pos, body, body_len);
+
+        struct ipx_ipfix_set *sets;
+        size_t sets_cnt;
+        ipx_msg_ipfix_get_sets(orig, &sets, &sets_cnt);
+        for (size_t i = 0; i < sets_cnt; ++i) {
+            struct ipx_ipfix_set *set_ref = ipx_msg_ipfix_add_set_ref(msg);
+            if (!set_ref) {
+                ipx_msg_ipfix_destroy(msg);
+                throw std::bad_alloc();
+            }
+
+            const uint8_t *set_ptr = reinterpret_cast<const uint8_t *>(sets[i].ptr);
+            assert(set_ptr >= body && set_ptr < body + body_len);
+            set_ref->ptr = reinterpret_cast<struct fds_ipfix_set_hdr *>(pos + (set_ptr - body));
+            set_ref->snap = sets[i].snap;
+            set_ref->drec_cnt = sets[i].drec_cnt;
+        }
+
+        const uint32_t rec_cnt = ipx_msg_ipfix_get_drec_cnt(orig);
+        for (uint32_t i = 0; i < rec_cnt; ++i) {
+            const struct fds_drec &rec = ipx_msg_ipfix_get_drec(orig, i)->rec;
+            if (rec.data < body || rec.data + rec.size > body + body_len) {
+                // The record has been modified by a previous plugin
+                ipx_msg_ipfix_destroy(msg);
+                return nullptr;
+            }
+
+            struct ipx_ipfix_record *rec_ref = ipx_msg_ipfix_add_drec_ref(&msg);
+            if (!rec_ref) {
+                ipx_msg_ipfix_destroy(msg);
+                throw std::bad_alloc();
+            }
+
+            rec_ref->rec.data = pos + (rec.data - body);
+            rec_ref->rec.size = rec.size;
+            rec_ref->rec.tmplt = rec.tmplt;
+            rec_ref->rec.snap = rec.snap;
+        }
+
+        pos += body_len;
+    }
+
+    assert(pos == buffer + domain.size);
+    return msg;
+}
+
+/**
+ * @brief Pass held messages of a domain
+ *
+ * A single message is passed as it is. Otherwise, the messages are replaced by the merged
+ * message. If they cannot be merged, they are passed one by one.
+ * @param[in] domain Domain
+ */
+void
+Repacker::flush(Domain &domain)
+{
+    if (domain.msgs.empty()) {
+        return;
+    }
+
+    ipx_msg_ipfix_t *merged = nullptr;
+    if (domain.msgs.size() > 1) {
+        try {
+            merged = merge(domain);
+        } catch (const std::bad_alloc &) {
+            IPX_CTX_ERROR(m_ctx, "Memory allocation error (%s:%d)", __FILE__, __LINE__);
+        }
+    }
+
+    if (merged != nullptr) {
+        for (ipx_msg_ipfix_t *msg : domain.msgs) {
+            ipx_msg_ipfix_destroy(msg);
+        }
+        msg_pass(merged);
+    } else {
+        for (ipx_msg_ipfix_t *msg : domain.msgs) {
+            msg_pass(msg);
+        }
+    }
+
+    domain.msgs.clear();
+    domain.size = 0;
+}
+
+/**
+ * @brief Pass held messages of domains with expired delay
+ * @param[in] now Current monotonic timestamp (in milliseconds)
+ */
+void
+Repacker::timeouts_check(uint64_t now)
+{
+    while (!m_timeouts.empty()) {
+        const auto &group = m_timeouts.front();
+        auto it = m_domains.find(group.first);
+        if (it == m_domains.end() || it->second.group != group.second
+                || it->second.msgs.empty()) {
+            // Already passed
+            m_timeouts.pop_front();
+            continue;
+        }
+
+        Domain &domain = it->second;
+        if (now - domain.since < m_max_delay) {
+            // Groups are ordered by the time of creation
+            break;
+        }
+
+        flush(domain);
+        m_timeouts.pop_front();
+    }
+}
+
+void
+Repacker::process(ipx_msg_ipfix_t *msg)
+{
+    const uint64_t now = now_ms();
+    const struct ipx_msg_ctx *msg_ctx = ipx_msg_ipfix_get_ctx(msg);
+    const struct fds_ipfix_msg_hdr *hdr = msg_hdr(msg);
+    const size_t msg_size = ntohs(hdr->length);
+    const uint32_t export_time = ntohl(hdr->export_time);
+    m_stat_msgs_in++;
+
+    Key key(msg_ctx->session, msg_ctx->odid, msg_ctx->stream, ipx_msg_ipfix_branch_get(msg));
+    Domain &domain = m_domains[key];
+
+    // Only messages with the same content interpretation can be merged
+    if (!domain.msgs.empty() && (domain.snap_gen != msg_ctx->snap_gen
+            || domain.export_time != export_time
+            || domain.size + (msg_size - FDS_IPFIX_MSG_HDR_LEN) > m_max_size)) {
+        flush(domain);
+    }
+
+    if (msg_size >= m_max_size) {
+        msg_pass(msg);
+    } else {
+        if (domain.msgs.empty()) {
+            domain.size = FDS_IPFIX_MSG_HDR_LEN;
+            domain.export_time = export_time;
+            domain.snap_gen = msg_ctx->snap_gen;
+            domain.since = now;
+            domain.group = m_group_next++;
+            m_timeouts.emplace_back(key, domain.group);
+        }
+
+        domain.msgs.push_back(msg);
+        domain.size += msg_size - FDS_IPFIX_MSG_HDR_LEN;
+    }
+
+    timeouts_check(now);
+}
+
+void
+Repacker::session_close(const struct ipx_session *session)
+{
+    auto it = m_domains.lower_bound(Key(session, 0, 0, 0));
+    while (it != m_domains.end() && std::get<0>(it->first) == session) {
+        flush(it->second);
+        it = m_domains.erase(it);
+    }
+}
+
+void
+Repacker::flush_all()
+{
+    for (auto &it : m_domains) {
+        flush(it.second);
+    }
+    m_timeouts.clear();
+}
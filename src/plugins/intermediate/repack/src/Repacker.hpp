@@ -0,0 +1,127 @@
+/**
+ * \file src/plugins/intermediate/repack/src/Repacker.hpp
+ * \author agent <agent@local>
+ * \brief Merging of small IPFIX Messages (header file)
+ * \date 2026
+ *
+ * Copyright(c) 2026 CESNET z.s.p.o.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef IPFIXCOL2_REPACK_REPACKER_HPP
+#define IPFIXCOL2_REPACK_REPACKER_HPP
+
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <tuple>
+#include <utility>
+#include <vector>
+#include <ipfixcol2.h>
+
+#include "Config.hpp"
+
+/**
+ * @brief Merging of small IPFIX Messages of the same Transport Session, ODID and Stream
+ *
+ * IPFIX Messages are held until the merged message would exceed the maximum size, or until
+ * the maximum delay has expired. Only consecutive messages with the same Export Time and
+ * the same snapshot of Templates are merged, so the content of the merged message is
+ * interpreted exactly as the content of the original messages.
+ *
+ * There is no timer in intermediate plugins, therefore, the delay is checked only when a
+ * message is received. Held messages are also passed before any garbage message (it might
+ * destroy Templates they refer to) and before a Transport Session is closed.
+ */
+class Repacker {
+public:
+    /**
+     * @brief Create a repacker
+     * @param[in] ctx Plugin context
+     * @param[in] cfg Configuration
+     */
+    Repacker(ipx_ctx_t *ctx, const Config &cfg);
+    /**
+     * @brief Destroy the repacker
+     * @warning Held messages must be passed by flush_all() before!
+     */
+    ~Repacker() = default;
+
+    // Disable copy constructors
+    Repacker(const Repacker &other) = delete;
+    Repacker &operator=(const Repacker &other) = delete;
+
+    /**
+     * @brief Process an IPFIX Message
+     *
+     * The message is passed (immediately or merged with others) or held.
+     * @param[in] msg IPFIX Message
+     * @throw bad_alloc in case of a memory allocation error
+     */
+    void
+    process(ipx_msg_ipfix_t *msg);
+
+    /**
+     * @brief Pass held messages of a closed Transport Session
+     *
+     * Must be called before the Transport Session message is passed.
+     * @param[in] session Transport Session
+     */
+    void
+    session_close(const struct ipx_session *session);
+
+    /**
+     * @brief Pass all held messages
+     */
+    void
+    flush_all();
+
+    /// Number of received IPFIX Messages
+    uint64_t m_stat_msgs_in = 0;
+    /// Number of passed IPFIX Messages
+    uint64_t m_stat_msgs_out = 0;
+
+private:
+    /// Transport Session, ODID, Stream and branch of the pipeline
+    using Key = std::tuple<const struct ipx_session *, uint32_t, ipx_stream_t, uint16_t>;
+
+    /// Held IPFIX Messages of a Transport Session, ODID, Stream and branch
+    struct Domain {
+        /// Held messages (in order of reception)
+        std::vector<ipx_msg_ipfix_t *> msgs;
+        /// Size of the merged message (header + Sets of all held messages)
+        size_t size = 0;
+        /// Export Time of held messages
+        uint32_t export_time = 0;
+        /// Generation of the snapshot of Templates of held messages
+        uint32_t snap_gen = 0;
+        /// Monotonic timestamp of reception of the first held message (in milliseconds)
+        uint64_t since = 0;
+        /// Identification of the current group of held messages (see m_timeouts)
+        uint64_t group = 0;
+    };
+
+    /// Plugin context
+    ipx_ctx_t *m_ctx;
+    /// Maximum size of a merged IPFIX Message
+    size_t m_max_size;
+    /// Maximum delay of a held message (in milliseconds)
+    uint64_t m_max_delay;
+    /// Domains
+    std::map<Key, Domain> m_domains;
+    /// Groups of held messages in order of creation (might refer to already passed groups)
+    std::deque<std::pair<Key, uint64_t>> m_timeouts;
+    /// Identification of the next group of held messages
+    uint64_t m_group_next = 0;
+
+    void
+    timeouts_check(uint64_t now);
+    void
+    flush(Domain &domain);
+    ipx_msg_ipfix_t *
+    merge(const Domain &domain);
+    void
+    msg_pass(ipx_msg_ipfix_t *msg);
+};
+
+#endif // IPFIXCOL2_REPACK_REPACKER_HPP
@@ -0,0 +1,114 @@
+/**
+ * \file src/plugins/intermediate/repack/src/repack.cpp
+ * \author agent <agent@local>
+ * \brief Merging of small IPFIX Messages (intermediate plugin)
+ * \date 2026
+ *
+ * Copyright(c) 2026 CESNET z.s.p.o.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include <cinttypes>
+#include <memory>
+#include <stdexcept>
+#include <ipfixcol2.h>
+
+#include "Config.hpp"
+#include "Repacker.hpp"
+
+/// Plugin description
+IPX_API struct ipx_plugin_info ipx_plugin_info = {
+    // Plugin identification name
+    "repack",
+    // Brief description of plugin
+    "Merging of small IPFIX Messages of the same Transport Session",
+    // Plugin type
+    IPX_PT_INTERMEDIATE,
+    // Configuration flags (reserved for future use)
+    0,
+    // Plugin version string (like "1.2.3")
+    "2.0.0",
+    // Minimal IPFIXcol version string (like "1.2.3")
+    "2.0.0"
+};
+
+/// Instance
+struct Instance {
+    /// Parsed configuration
+    std::unique_ptr<Config> config_ptr = nullptr;
+    /// Merging of messages
+    std::unique_ptr<Repacker> repacker_ptr = nullptr;
+};
+
+int
+ipx_plugin_init(ipx_ctx_t *ctx, const char *params)
+{
+    // Held messages must be passed before garbage and closed Transport Sessions
+    ipx_msg_mask_t mask = IPX_MSG_IPFIX | IPX_MSG_SESSION | IPX_MSG_GARBAGE;
+    if (ipx_ctx_subscribe(ctx, &mask, nullptr) != IPX_OK) {
+        IPX_CTX_ERROR(ctx, "Failed to subscribe to garbage messages!", '\0');
+        return IPX_ERR_DENIED;
+    }
+
+    try {
+        std::unique_ptr<Instance> instance(new Instance);
+        instance->config_ptr.reset(new Config(params));
+        instance->repacker_ptr.reset(new Repacker(ctx, *instance->config_ptr));
+        ipx_ctx_private_set(ctx, instance.release());
+    } catch (const std::exception &ex) {
+        IPX_CTX_ERROR(ctx, "Initialization failed: %s", ex.what());
+        return IPX_ERR_DENIED;
+    } catch (...) {
+        IPX_CTX_ERROR(ctx, "Unknown error has occurred!", '\0');
+        return IPX_ERR_DENIED;
+    }
+
+    return IPX_OK;
+}
+
+void
+ipx_plugin_destroy(ipx_ctx_t *ctx, void *cfg)
+{
+    auto inst = reinterpret_cast<Instance *>(cfg);
+    Repacker &repacker = *inst->repacker_ptr;
+    repacker.flush_all();
+
+    if (repacker.m_stat_msgs_in > 0) {
+        IPX_CTX_INFO(ctx, "Passed %" PRIu64 " of %" PRIu64 " IPFIX Messages (%.1f%%)",
+            repacker.m_stat_msgs_out, repacker.m_stat_msgs_in,
+            100.0 * double(repacker.m_stat_msgs_out) / double(repacker.m_stat_msgs_in));
+    }
+
+    delete inst;
+}
+
+int
+ipx_plugin_process(ipx_ctx_t *ctx, void *cfg, ipx_msg_t *msg)
+{
+    auto inst = reinterpret_cast<Instance *>(cfg);
+
+    switch (ipx_msg_get_type(msg)) {
+    case IPX_MSG_IPFIX:
+        try {
+            inst->repacker_ptr->process(ipx_msg_base2ipfix(msg));
+        } catch (const std::exception &ex) {
+            IPX_CTX_ERROR(ctx, "Failed to process an IPFIX Message: %s", ex.what());
+        }
+        break;
+    case IPX_MSG_SESSION: {
+        ipx_msg_session_t *msg_session = ipx_msg_base2session(msg);
+        if (ipx_msg_session_get_event(msg_session) == IPX_MSG_SESSION_CLOSE) {
+            inst->repacker_ptr->session_close(ipx_msg_session_get_session(msg_session));
+        }
+        ipx_ctx_msg_pass(ctx, msg);
+        break;
+    }
+    default:
+        // Garbage might destroy Templates of held messages
+        inst->repacker_ptr->flush_all();
+        ipx_ctx_msg_pass(ctx, msg);
+        break;
+    }
+
+    return IPX_OK;
+}
@@ -0,0 +1,220 @@
+/**
+ * \file src/plugins/intermediate/sampling/config.c
+ * \author agent <agent@local>
+ * \brief Configuration parser of sampling plugin
+ * \date 2026
+ */
+
+/* Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is'', and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <inttypes.h>
+#include "config.h"
+
+/*
+ * <params>
+ *  <rate>...</rate>        <!-- 1 of N records is selected -->
+ *  <mode>...</mode>        <!-- optional, mark/drop -->
+ *  <seed>...</seed>        <!-- optional, seed of the hash function -->
+ *  <key>                   <!-- optional, the default is 5-tuple -->
+ *   <field>...</field>     <!-- one or more names of Information Elements -->
+ *  </key>
+ * </params>
+ */
+
+/** XML nodes */
+enum params_xml_nodes {
+    SAMPLING_RATE = 1,
+    SAMPLING_MODE,
+    SAMPLING_SEED,
+    SAMPLING_KEY,
+    KEY_FIELD
+};
+
+/** Definition of the \<key\> node  */
+static const struct fds_xml_args args_key[] = {
+    FDS_OPTS_ELEM(KEY_FIELD, "field", FDS_OPTS_T_STRING, FDS_OPTS_P_MULTI),
+    FDS_OPTS_END
+};
+
+/** Definition of the \<params\> node  */
+static const struct fds_xml_args args_params[] = {
+    FDS_OPTS_ROOT("params"),
+    FDS_OPTS_ELEM(SAMPLING_RATE, "rate", FDS_OPTS_T_UINT, 0),
+    FDS_OPTS_ELEM(SAMPLING_MODE, "mode", FDS_OPTS_T_STRING, FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM(SAMPLING_SEED, "seed", FDS_OPTS_T_UINT, FDS_OPTS_P_OPT),
+    FDS_OPTS_NESTED(SAMPLING_KEY, "key", args_key, FDS_OPTS_P_OPT),
+    FDS_OPTS_END
+};
+
+/**
+ * \brief Process \<key\> node
+ * \param[in] ctx  Plugin context
+ * \param[in] key  XML context to process
+ * \param[in] cfg  Parsed configuration
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_FORMAT in case of failure
+ */
+static int
+config_parser_key(ipx_ctx_t *ctx, fds_xml_ctx_t *key, struct sampling_config *cfg)
+{
+    const struct fds_xml_cont *content;
+    while (fds_xml_next(key, &content) != FDS_EOC) {
+        assert(content->id == KEY_FIELD && content->type == FDS_OPTS_T_STRING);
+        if (cfg->fields_cnt == SAMPLING_FIELDS_MAX) {
+            IPX_CTX_ERROR(ctx, "Too many key fields (max. %u)!", SAMPLING_FIELDS_MAX);
+            return IPX_ERR_FORMAT;
+        }
+
+        char *name = strdup(content->ptr_string);
+        if (!name) {
+            IPX_CTX_ERROR(ctx, "Memory allocation error (%s:%d)", __FILE__, __LINE__);
+            return IPX_ERR_FORMAT;
+        }
+        cfg->fields[cfg->fields_cnt++] = name;
+    }
+
+    return IPX_OK;
+}
+
+/**
+ * \brief Process \<params\> node
+ * \param[in] ctx  Plugin context
+ * \param[in] root XML context to process
+ * \param[in] cfg  Parsed configuration
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_FORMAT in case of failure
+ */
+static int
+config_parser_root(ipx_ctx_t *ctx, fds_xml_ctx_t *root, struct sampling_config *cfg)
+{
+    const struct fds_xml_cont *content;
+    while (fds_xml_next(root, &content) != FDS_EOC) {
+        switch (content->id) {
+        case SAMPLING_RATE:
+            assert(content->type == FDS_OPTS_T_UINT);
+            if (content->val_uint == 0 || content->val_uint > UINT32_MAX) {
+                IPX_CTX_ERROR(ctx, "Sampling <rate> must be between 1..%" PRIu32 "!", UINT32_MAX);
+                return IPX_ERR_FORMAT;
+            }
+            cfg->rate = (uint32_t) content->val_uint;
+            break;
+        case SAMPLING_MODE:
+            assert(content->type == FDS_OPTS_T_STRING);
+            if (strcasecmp(content->ptr_string, "mark") == 0) {
+                cfg->mode = SAMPLING_MARK;
+            } else if (strcasecmp(content->ptr_string, "drop") == 0) {
+                cfg->mode = SAMPLING_DROP;
+            } else {
+                IPX_CTX_ERROR(ctx, "Unrecognized <mode> of sampling (mark/drop expected).", '\0');
+                return IPX_ERR_FORMAT;
+            }
+            break;
+        case SAMPLING_SEED:
+            assert(content->type == FDS_OPTS_T_UINT);
+            cfg->seed = content->val_uint;
+            break;
+        case SAMPLING_KEY:
+            assert(content->type == FDS_OPTS_T_CONTEXT);
+            if (config_parser_key(ctx, content->ptr_ctx, cfg) != IPX_OK) {
+                return IPX_ERR_FORMAT;
+            }
+            break;
+        default:
+            // Internal error
+            assert(false);
+        }
+    }
+
+    return IPX_OK;
+}
+
+struct sampling_config *
+config_parse(ipx_ctx_t *ctx, const char *params)
+{
+    struct sampling_config *cfg = calloc(1, sizeof(*cfg));
+    if (!cfg) {
+        IPX_CTX_ERROR(ctx, "Memory allocation error (%s:%d)", __FILE__, __LINE__);
+        return NULL;
+    }
+
+    // Set default parameters
+    cfg->mode = SAMPLING_MARK;
+    cfg->seed = 0;
+
+    // Create an XML parser
+    fds_xml_t *parser = fds_xml_create();
+    if (!parser) {
+        IPX_CTX_ERROR(ctx, "Memory allocation error (%s:%d)", __FILE__, __LINE__);
+        free(cfg);
+        return NULL;
+    }
+
+    if (fds_xml_set_args(parser, args_params) != IPX_OK) {
+        IPX_CTX_ERROR(ctx, "Failed to parse the description of an XML document!", '\0');
+        fds_xml_destroy(parser);
+        free(cfg);
+        return NULL;
+    }
+
+    fds_xml_ctx_t *params_ctx = fds_xml_parse_mem(parser, params, true);
+    if (params_ctx == NULL) {
+        IPX_CTX_ERROR(ctx, "Failed to parse the configuration: %s", fds_xml_last_err(parser));
+        fds_xml_destroy(parser);
+        free(cfg);
+        return NULL;
+    }
+
+    // Parse parameters
+    int rc = config_parser_root(ctx, params_ctx, cfg);
+    fds_xml_destroy(parser);
+    if (rc != IPX_OK) {
+        config_destroy(cfg);
+        return NULL;
+    }
+
+    return cfg;
+}
+
+void
+config_destroy(struct sampling_config *cfg)
+{
+    for (unsigned int i = 0; i < cfg->fields_cnt; ++i) {
+        free(cfg->fields[i]);
+    }
+    free(cfg);
+}
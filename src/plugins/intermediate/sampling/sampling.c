@@ -0,0 +1,387 @@
+/**
+ * \file src/plugins/intermediate/sampling/sampling.c
+ * \author agent <agent@local>
+ * \brief Deterministic (hash-based) sampling of flow records for IPFIXcol2
+ * \date 2026
+ */
+
+/* Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is'', and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#include <ipfixcol2.h>
+#include <stdlib.h>
+#include <inttypes.h>
+
+#include "config.h"
+
+/** Plugin description */
+IPX_API struct ipx_plugin_info ipx_plugin_info = {
+    // Plugin type
+    .type = IPX_PT_INTERMEDIATE,
+    // Plugin identification name
+    .name = "sampling",
+    // Brief description of plugin
+    .dsc = "Deterministic (hash-based) sampling of flow records",
+    // Configuration flags (reserved for future use)
+    .flags = 0,
+    // Plugin version string (like "1.2.3")
+    .version = "2.0.0",
+    // Minimal IPFIXcol version string (like "1.2.3")
+    .ipx_min = "2.0.0"
+};
+
+/** Type of the extension with flags of selected records (1 byte per record, non-zero = selected) */
+#define SAMPLING_EXT_TYPE "sampling-v1"
+/** Name of the extension with flags of selected records                                 */
+#define SAMPLING_EXT_NAME "selected"
+
+/** Maximum number of different Templates cached per message                            */
+#define TCACHE_SIZE  (16U)
+
+/** Default key (Private Enterprise Number, Information Element ID), i.e. 5-tuple */
+static const struct {
+    uint32_t pen;
+    uint16_t id;
+} key_default[] = {
+    {0,   4}, // protocolIdentifier
+    {0,   7}, // sourceTransportPort
+    {0,   8}, // sourceIPv4Address
+    {0,  11}, // destinationTransportPort
+    {0,  12}, // destinationIPv4Address
+    {0,  27}, // sourceIPv6Address
+    {0,  28}, // destinationIPv6Address
+};
+
+/** Key field */
+struct key_field {
+    /** Private Enterprise Number                                                       */
+    uint32_t pen;
+    /** Information Element ID                                                          */
+    uint16_t id;
+};
+
+/** Key fields of a Template */
+struct tcache_rec {
+    /** Offsets of fields are not known (i.e. a field is placed after a variable-length
+     *  field) and key fields must be found by fds_drec_find()                          */
+    bool use_find;
+    /** Number of key fields in the Template                                            */
+    uint16_t cnt;
+    /** Offsets of key fields from the start of a record                                */
+    uint16_t offsets[SAMPLING_FIELDS_MAX];
+    /** Sizes of key fields                                                             */
+    uint16_t sizes[SAMPLING_FIELDS_MAX];
+};
+
+/** Instance */
+struct instance_data {
+    /** Parsed configuration of the instance                                            */
+    struct sampling_config *config;
+    /** Extension with flags of selected records (mark mode only)                       */
+    ipx_ctx_ext_t *ext;
+
+    /** Key fields                                                                      */
+    struct key_field fields[SAMPLING_FIELDS_MAX];
+    /** Number of key fields                                                            */
+    unsigned int fields_cnt;
+
+    /** Key fields of Templates of the processed message (see struct tcache_rec)        */
+    ipx_tcache_t *tcache;
+
+    /** Flags of Data Records of the processed message (drop mode only)                 */
+    struct ipx_drec_flags keep;
+
+    /** Number of processed Data Records                                                */
+    uint64_t recs_total;
+    /** Number of selected Data Records                                                 */
+    uint64_t recs_selected;
+};
+
+/**
+ * \brief Hash a value of a field (64-bit FNV-1a)
+ * \param[in] data Value
+ * \param[in] size Size of the value
+ * \return Hash
+ */
+static inline uint64_t
+hash_value(const uint8_t *data, uint16_t size)
+{
+    uint64_t hash = 14695981039346656037ULL;
+    for (uint16_t i = 0; i < size; ++i) {
+        hash ^= data[i];
+        hash *= 1099511628211ULL;
+    }
+
+    // Final mixing, so sums of hashes are well distributed
+    return ipx_utils_hash_mix(hash);
+}
+
+/**
+ * \brief Decide if a record with a given key hash is selected
+ *
+ * Hashes of key fields are summed, i.e. the key doesn't depend on the order of fields.
+ * Therefore, both directions of a flow (source and destination fields are swapped) have
+ * the same key and the same decision is made by all collectors with the same configuration.
+ * \param[in] data Instance data
+ * \param[in] sum  Sum of hashes of key fields
+ * \return True or false
+ */
+static inline bool
+key_selected(const struct instance_data *data, uint64_t sum)
+{
+    uint64_t hash = sum ^ data->config->seed;
+    hash ^= hash >> 33;
+    hash *= 0xff51afd7ed558ccdULL;
+    hash ^= hash >> 33;
+    return (hash % data->config->rate) == 0;
+}
+
+/**
+ * \brief Find key fields of a Template in the cache or add them
+ * \param[in] data  Instance data
+ * \param[in] tmplt Template
+ * \return Cached record or NULL (the cache is full or memory allocation error)
+ */
+static const struct tcache_rec *
+tcache_get(struct instance_data *data, const struct fds_template *tmplt)
+{
+    struct tcache_rec *rec = ipx_tcache_find(data->tcache, tmplt);
+    if (rec != NULL) {
+        return rec;
+    }
+
+    if ((rec = ipx_tcache_add(data->tcache, tmplt)) == NULL) {
+        return NULL;
+    }
+
+    for (unsigned int i = 0; i < data->fields_cnt; ++i) {
+        const struct fds_tfield *field = fds_template_cfind(tmplt, data->fields[i].pen,
+            data->fields[i].id);
+        if (field == NULL) {
+            continue;
+        }
+
+        if (field->offset == FDS_IPFIX_VAR_IE_LEN || field->length == FDS_IPFIX_VAR_IE_LEN) {
+            // The field cannot be found without a lookup
+            rec->use_find = true;
+            break;
+        }
+
+        rec->offsets[rec->cnt] = field->offset;
+        rec->sizes[rec->cnt] = field->length;
+        rec->cnt++;
+    }
+
+    return rec;
+}
+
+/**
+ * \brief Decide if a Data Record is selected
+ * \param[in] data Instance data
+ * \param[in] rec  Data Record
+ * \return True or false
+ */
+static bool
+record_selected(struct instance_data *data, struct fds_drec *rec)
+{
+    const struct tcache_rec *cache = tcache_get(data, rec->tmplt);
+    uint64_t sum = 0;
+
+    if (cache != NULL && !cache->use_find) {
+        for (uint16_t i = 0; i < cache->cnt; ++i) {
+            sum += hash_value(&rec->data[cache->offsets[i]], cache->sizes[i]);
+        }
+
+        return key_selected(data, sum);
+    }
+
+    for (unsigned int i = 0; i < data->fields_cnt; ++i) {
+        struct fds_drec_field field;
+        if (fds_drec_find(rec, data->fields[i].pen, data->fields[i].id, &field) == FDS_EOC) {
+            continue;
+        }
+
+        sum += hash_value(field.data, field.size);
+    }
+
+    return key_selected(data, sum);
+}
+
+/**
+ * \brief Resolve key fields of the configuration
+ * \param[in] ctx  Plugin context
+ * \param[in] data Instance data
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_DENIED if a field is not known
+ */
+static int
+fields_init(ipx_ctx_t *ctx, struct instance_data *data)
+{
+    const struct sampling_config *cfg = data->config;
+
+    if (cfg->fields_cnt == 0) {
+        for (size_t i = 0; i < sizeof(key_default) / sizeof(key_default[0]); ++i) {
+            data->fields[i].pen = key_default[i].pen;
+            data->fields[i].id = key_default[i].id;
+        }
+        data->fields_cnt = sizeof(key_default) / sizeof(key_default[0]);
+        return IPX_OK;
+    }
+
+    const fds_iemgr_t *iemgr = ipx_ctx_iemgr_get(ctx);
+    for (unsigned int i = 0; i < cfg->fields_cnt; ++i) {
+        const struct fds_iemgr_elem *elem = fds_iemgr_elem_find_name(iemgr, cfg->fields[i]);
+        if (elem == NULL) {
+            IPX_CTX_ERROR(ctx, "Unknown key field '%s'!", cfg->fields[i]);
+            return IPX_ERR_DENIED;
+        }
+
+        data->fields[i].pen = elem->scope->pen;
+        data->fields[i].id = elem->id;
+    }
+
+    data->fields_cnt = cfg->fields_cnt;
+    return IPX_OK;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+int
+ipx_plugin_init(ipx_ctx_t *ctx, const char *params)
+{
+    // Create a private data
+    struct instance_data *data = calloc(1, sizeof(*data));
+    if (!data) {
+        return IPX_ERR_DENIED;
+    }
+
+    if ((data->config = config_parse(ctx, params)) == NULL) {
+        free(data);
+        return IPX_ERR_DENIED;
+    }
+
+    data->tcache = ipx_tcache_create(sizeof(struct tcache_rec), TCACHE_SIZE);
+    if (!data->tcache) {
+        IPX_CTX_ERROR(ctx, "Memory allocation failed! (%s:%d)", __FILE__, __LINE__);
+        ipx_plugin_destroy(ctx, data);
+        return IPX_ERR_DENIED;
+    }
+
+    if (fields_init(ctx, data) != IPX_OK) {
+        ipx_plugin_destroy(ctx, data);
+        return IPX_ERR_DENIED;
+    }
+
+    int rc = IPX_OK;
+    if (data->config->mode == SAMPLING_MARK) {
+        rc = ipx_ctx_ext_producer_columnar(ctx, SAMPLING_EXT_TYPE, SAMPLING_EXT_NAME, 1, &data->ext);
+    }
+
+    if (rc != IPX_OK) {
+        IPX_CTX_ERROR(ctx, "Failed to initialize the instance (code: %d)", rc);
+        ipx_plugin_destroy(ctx, data);
+        return IPX_ERR_DENIED;
+    }
+
+    ipx_ctx_private_set(ctx, data);
+    return IPX_OK;
+}
+
+void
+ipx_plugin_destroy(ipx_ctx_t *ctx, void *cfg)
+{
+    struct instance_data *data = (struct instance_data *) cfg;
+
+    if (data->recs_total > 0) {
+        IPX_CTX_INFO(ctx, "Selected %" PRIu64 " of %" PRIu64 " Data Records (%.2f%%)",
+            data->recs_selected, data->recs_total,
+            100.0 * (double) data->recs_selected / (double) data->recs_total);
+    }
+
+    ipx_msg_ipfix_drec_flags_free(&data->keep);
+    ipx_tcache_destroy(data->tcache);
+    config_destroy(data->config);
+    free(data);
+}
+
+int
+ipx_plugin_process(ipx_ctx_t *ctx, void *cfg, ipx_msg_t *msg)
+{
+    struct instance_data *data = (struct instance_data *) cfg;
+    ipx_msg_ipfix_t *ipfix_msg = ipx_msg_base2ipfix(msg);
+    const uint32_t rec_cnt = ipx_msg_ipfix_get_drec_cnt(ipfix_msg);
+    ipx_tcache_clear(data->tcache);
+
+    // Flags of records (the column of the extension or the array of the drop mode)
+    uint8_t *flags;
+    if (data->config->mode == SAMPLING_MARK) {
+        void *column;
+        size_t size;
+        if (ipx_ctx_ext_column_get(data->ext, ipfix_msg, &column, &size) != IPX_OK) {
+            // Consumers don't get the extension, i.e. they will not see any selected record
+            IPX_CTX_ERROR(ctx, "Memory allocation error (%s:%d)", __FILE__, __LINE__);
+            ipx_ctx_msg_pass(ctx, msg);
+            return IPX_OK;
+        }
+        flags = column;
+    } else {
+        if ((flags = ipx_msg_ipfix_drec_flags(ipfix_msg, &data->keep)) == NULL) {
+            // Records cannot be dropped, pass them all rather than lose them
+            IPX_CTX_ERROR(ctx, "Memory allocation error (%s:%d)", __FILE__, __LINE__);
+            ipx_ctx_msg_pass(ctx, msg);
+            return IPX_OK;
+        }
+    }
+
+    uint32_t selected = 0;
+    for (uint32_t i = 0; i < rec_cnt; ++i) {
+        struct ipx_ipfix_record *rec = ipx_msg_ipfix_get_drec(ipfix_msg, i);
+        const bool match = record_selected(data, &rec->rec);
+        flags[i] = match;
+        selected += match;
+    }
+
+    if (data->config->mode == SAMPLING_MARK) {
+        ipx_ctx_ext_column_set_filled(data->ext, ipfix_msg);
+    } else if (selected != rec_cnt) {
+        ipx_msg_ipfix_drec_compact(ipfix_msg, flags);
+    }
+
+    data->recs_total += rec_cnt;
+    data->recs_selected += selected;
+
+    // Always pass the message (Template Sets and remaining records)
+    ipx_ctx_msg_pass(ctx, msg);
+    return IPX_OK;
+}
@@ -0,0 +1,351 @@
+/**
+ * \file src/plugins/output/clickhouse/src/Block.cpp
+ * \author agent <agent@local>
+ * \brief Columnar block of flow records (source file)
+ * \date 2026
+ *
+ * Copyright(c) 2026 CESNET z.s.p.o.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include <cassert>
+#include <cstring>
+#include <memory>
+#include <netinet/in.h>
+#include "Block.hpp"
+
+using clickhouse::ColumnRef;
+using clickhouse::ColumnUInt8;
+using clickhouse::ColumnUInt16;
+using clickhouse::ColumnUInt32;
+using clickhouse::ColumnUInt64;
+using clickhouse::ColumnInt8;
+using clickhouse::ColumnInt16;
+using clickhouse::ColumnInt32;
+using clickhouse::ColumnInt64;
+using clickhouse::ColumnFloat32;
+using clickhouse::ColumnFloat64;
+using clickhouse::ColumnIPv4;
+using clickhouse::ColumnIPv6;
+using clickhouse::ColumnFixedString;
+using clickhouse::ColumnDateTime64;
+using clickhouse::ColumnString;
+using clickhouse::Int64;
+
+/**
+ * @brief Append a value to a typed column
+ * @param[in] ref   Column
+ * @param[in] value Value to append
+ */
+template <typename C, typename T>
+static inline void
+typed_append(const ColumnRef &ref, const T &value)
+{
+    static_cast<C *>(ref.get())->Append(value);
+}
+
+Block::Block(const std::vector<Column_def> &defs, size_t rows_max)
+    : m_defs(defs), m_rows_max(rows_max)
+{
+    for (const Column_def &def : m_defs) {
+        struct column col;
+
+        switch (def.type) {
+        case FDS_ET_UNSIGNED_8:
+            col.type = kind::UINT8;
+            col.ref = std::make_shared<ColumnUInt8>();
+            break;
+        case FDS_ET_UNSIGNED_16:
+            col.type = kind::UINT16;
+            col.ref = std::make_shared<ColumnUInt16>();
+            break;
+        case FDS_ET_UNSIGNED_32:
+            col.type = kind::UINT32;
+            col.ref = std::make_shared<ColumnUInt32>();
+            break;
+        case FDS_ET_UNSIGNED_64:
+            col.type = kind::UINT64;
+            col.ref = std::make_shared<ColumnUInt64>();
+            break;
+        case FDS_ET_SIGNED_8:
+            col.type = kind::INT8;
+            col.ref = std::make_shared<ColumnInt8>();
+            break;
+        case FDS_ET_SIGNED_16:
+            col.type = kind::INT16;
+            col.ref = std::make_shared<ColumnInt16>();
+            break;
+        case FDS_ET_SIGNED_32:
+            col.type = kind::INT32;
+            col.ref = std::make_shared<ColumnInt32>();
+            break;
+        case FDS_ET_SIGNED_64:
+            col.type = kind::INT64;
+            col.ref = std::make_shared<ColumnInt64>();
+            break;
+        case FDS_ET_FLOAT_32:
+            col.type = kind::FLOAT32;
+            col.ref = std::make_shared<ColumnFloat32>();
+            break;
+        case FDS_ET_FLOAT_64:
+            col.type = kind::FLOAT64;
+            col.ref = std::make_shared<ColumnFloat64>();
+            break;
+        case FDS_ET_BOOLEAN:
+            col.type = kind::BOOL;
+            col.ref = std::make_shared<ColumnUInt8>();
+            break;
+        case FDS_ET_IPV4_ADDRESS:
+            col.type = kind::IPV4;
+            col.ref = std::make_shared<ColumnIPv4>();
+            break;
+        case FDS_ET_IPV6_ADDRESS:
+            col.type = kind::IPV6;
+            col.ref = std::make_shared<ColumnIPv6>();
+            break;
+        case FDS_ET_MAC_ADDRESS:
+            col.type = kind::MAC;
+            col.ref = std::make_shared<ColumnFixedString>(6);
+            break;
+        case FDS_ET_DATE_TIME_SECONDS:
+        case FDS_ET_DATE_TIME_MILLISECONDS:
+            col.type = kind::TIME_MS;
+            col.ref = std::make_shared<ColumnDateTime64>(3);
+            break;
+        case FDS_ET_DATE_TIME_MICROSECONDS:
+        case FDS_ET_DATE_TIME_NANOSECONDS:
+            col.type = kind::TIME_NS;
+            col.ref = std::make_shared<ColumnDateTime64>(9);
+            break;
+        default:
+            // Strings, octet arrays and structured data types
+            col.type = kind::STRING;
+            col.ref = std::make_shared<ColumnString>();
+            break;
+        }
+
+        col.ref->Reserve(m_rows_max);
+        m_columns.push_back(std::move(col));
+    }
+
+    m_values.resize(m_defs.size());
+}
+
+Plan
+Block::plan_create(const struct fds_template *tmplt, const std::vector<Column_def> &defs)
+{
+    Plan plan;
+    plan.fixed = (tmplt->flags & FDS_TEMPLATE_DYNAMIC) == 0;
+    plan.fields.assign(defs.size(), -1);
+
+    for (size_t col_idx = 0; col_idx < defs.size(); ++col_idx) {
+        const Column_def &def = defs[col_idx];
+        for (uint16_t i = 0; i < tmplt->fields_cnt_total; ++i) {
+            const struct fds_tfield &field = tmplt->fields[i];
+            if (field.en != def.en || field.id != def.id
+                    || (field.flags & FDS_TFIELD_REVERSE) != 0) {
+                continue;
+            }
+
+            plan.fields[col_idx] = i;
+            break;
+        }
+    }
+
+    if (!plan.fixed) {
+        // Records must be iterated, so prepare the mapping of fields to columns
+        plan.map.assign(tmplt->fields_cnt_total, -1);
+        for (size_t col_idx = 0; col_idx < defs.size(); ++col_idx) {
+            if (plan.fields[col_idx] >= 0) {
+                plan.map[plan.fields[col_idx]] = static_cast<int>(col_idx);
+            }
+        }
+    }
+
+    return plan;
+}
+
+void
+Block::append(struct fds_drec &rec, const Plan &plan)
+{
+    assert(m_rows < m_rows_max && "The block is full");
+    const size_t cols = m_columns.size();
+
+    if (plan.fixed) {
+        // Values are on the same position in all records
+        for (size_t i = 0; i < cols; ++i) {
+            const int field_idx = plan.fields[i];
+            if (field_idx < 0) {
+                m_values[i] = {nullptr, 0};
+                continue;
+            }
+
+            const struct fds_tfield &field = rec.tmplt->fields[field_idx];
+            m_values[i] = {rec.data + field.offset, field.length};
+        }
+    } else {
+        for (size_t i = 0; i < cols; ++i) {
+            m_values[i] = {nullptr, 0};
+        }
+
+        struct fds_drec_iter iter;
+        int idx;
+
+        fds_drec_iter_init(&iter, &rec, 0);
+        while ((idx = fds_drec_iter_next(&iter)) != FDS_EOC) {
+            const int col_idx = plan.map[idx];
+            if (col_idx < 0) {
+                continue;
+            }
+
+            m_values[col_idx] = {iter.field.data, iter.field.size};
+        }
+    }
+
+    for (size_t i = 0; i < cols; ++i) {
+        column_append(m_columns[i], m_defs[i].type, m_values[i]);
+    }
+
+    if (m_rows++ == 0) {
+        clock_gettime(CLOCK_MONOTONIC, &m_start);
+    }
+}
+
+/**
+ * @brief Append a value to a column
+ *
+ * If the value is missing or cannot be converted (e.g. invalid size), the default value of
+ * the column type (i.e. zero, empty string, etc.) is appended.
+ * @param[in] col  Column
+ * @param[in] type Data type of the source Information Element
+ * @param[in] val  Value to append
+ */
+void
+Block::column_append(struct column &col, enum fds_iemgr_element_type type,
+    const struct value &val)
+{
+    const bool valid = (val.data != nullptr);
+
+    switch (col.type) {
+    case kind::UINT8:
+    case kind::UINT16:
+    case kind::UINT32:
+    case kind::UINT64: {
+        uint64_t value = 0;
+        if (valid && fds_get_uint_be(val.data, val.size, &value) != FDS_OK) {
+            value = 0;
+        }
+        switch (col.type) {
+        case kind::UINT8:  typed_append<ColumnUInt8>(col.ref, static_cast<uint8_t>(value)); break;
+        case kind::UINT16: typed_append<ColumnUInt16>(col.ref, static_cast<uint16_t>(value)); break;
+        case kind::UINT32: typed_append<ColumnUInt32>(col.ref, static_cast<uint32_t>(value)); break;
+        default:           typed_append<ColumnUInt64>(col.ref, value); break;
+        }
+        }
+        break;
+    case kind::INT8:
+    case kind::INT16:
+    case kind::INT32:
+    case kind::INT64: {
+        int64_t value = 0;
+        if (valid && fds_get_int_be(val.data, val.size, &value) != FDS_OK) {
+            value = 0;
+        }
+        switch (col.type) {
+        case kind::INT8:  typed_append<ColumnInt8>(col.ref, static_cast<int8_t>(value)); break;
+        case kind::INT16: typed_append<ColumnInt16>(col.ref, static_cast<int16_t>(value)); break;
+        case kind::INT32: typed_append<ColumnInt32>(col.ref, static_cast<int32_t>(value)); break;
+        default:          typed_append<ColumnInt64>(col.ref, value); break;
+        }
+        }
+        break;
+    case kind::FLOAT32:
+    case kind::FLOAT64: {
+        double value = 0.0;
+        if (valid && fds_get_float_be(val.data, val.size, &value) != FDS_OK) {
+            value = 0.0;
+        }
+        if (col.type == kind::FLOAT32) {
+            typed_append<ColumnFloat32>(col.ref, static_cast<float>(value));
+        } else {
+            typed_append<ColumnFloat64>(col.ref, value);
+        }
+        }
+        break;
+    case kind::BOOL: {
+        bool value = false;
+        if (valid && fds_get_bool(val.data, val.size, &value) != FDS_OK) {
+            value = false;
+        }
+        typed_append<ColumnUInt8>(col.ref, static_cast<uint8_t>(value ? 1 : 0));
+        }
+        break;
+    case kind::IPV4: {
+        struct in_addr addr;
+        addr.s_addr = 0;
+        if (valid && val.size == sizeof(addr.s_addr)) {
+            memcpy(&addr.s_addr, val.data, sizeof(addr.s_addr));
+        }
+        typed_append<ColumnIPv4>(col.ref, addr);
+        }
+        break;
+    case kind::IPV6: {
+        struct in6_addr addr;
+        memset(&addr, 0, sizeof(addr));
+        if (valid && val.size == sizeof(addr)) {
+            memcpy(&addr, val.data, sizeof(addr));
+        }
+        static_cast<ColumnIPv6 *>(col.ref.get())->Append(&addr);
+        }
+        break;
+    case kind::MAC: {
+        static const char mac_zero[6] = {0};
+        const char *mac = (valid && val.size == 6)
+            ? reinterpret_cast<const char *>(val.data) : mac_zero;
+        typed_append<ColumnFixedString>(col.ref, std::string_view(mac, 6));
+        }
+        break;
+    case kind::TIME_MS: {
+        uint64_t value = 0;
+        if (valid && fds_get_datetime_lp_be(val.data, val.size, type, &value) != FDS_OK) {
+            value = 0;
+        }
+        typed_append<ColumnDateTime64>(col.ref, static_cast<Int64>(value));
+        }
+        break;
+    case kind::TIME_NS: {
+        struct timespec ts = {0, 0};
+        if (valid && fds_get_datetime_hp_be(val.data, val.size, type, &ts) != FDS_OK) {
+            ts = {0, 0};
+        }
+        const Int64 value = static_cast<Int64>(ts.tv_sec) * INT64_C(1000000000) + ts.tv_nsec;
+        typed_append<ColumnDateTime64>(col.ref, value);
+        }
+        break;
+    case kind::STRING: {
+        const char *str = reinterpret_cast<const char *>(val.data);
+        typed_append<ColumnString>(col.ref, valid ? std::string_view(str, val.size)
+            : std::string_view());
+        }
+        break;
+    }
+}
+
+void
+Block::fill(clickhouse::Block &block) const
+{
+    for (size_t i = 0; i < m_columns.size(); ++i) {
+        block.AppendColumn(m_defs[i].name, m_columns[i].ref);
+    }
+}
+
+void
+Block::clear()
+{
+    // Capacity of columns is kept
+    for (struct column &col : m_columns) {
+        col.ref->Clear();
+    }
+
+    m_rows = 0;
+}
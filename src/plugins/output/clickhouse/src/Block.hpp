@@ -0,0 +1,166 @@
+/**
+ * \file src/plugins/output/clickhouse/src/Block.hpp
+ * \author agent <agent@local>
+ * \brief Columnar block of flow records (header file)
+ * \date 2026
+ *
+ * Copyright(c) 2026 CESNET z.s.p.o.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef IPFIXCOL2_CLICKHOUSE_BLOCK_HPP
+#define IPFIXCOL2_CLICKHOUSE_BLOCK_HPP
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <time.h>
+#include <libfds.h>
+
+#include <clickhouse/client.h>
+
+/// Definition of a column of the table
+struct Column_def {
+    /// Name of the column
+    std::string name;
+    /// Enterprise Number of the source Information Element
+    uint32_t en;
+    /// ID of the source Information Element
+    uint16_t id;
+    /// Data type of the source Information Element
+    enum fds_iemgr_element_type type;
+};
+
+/**
+ * @brief Mapping of a Template to columns of the table
+ *
+ * For each column, the plan holds an index of the Template field which is stored into the
+ * column (the first non-reverse occurrence of the source Information Element) or -1, if the
+ * Template doesn't contain the field.
+ */
+struct Plan {
+    /// All fields have fixed offset in records (i.e. no variable-length fields)
+    bool fixed;
+    /// Index of the Template field of each column (-1 == missing field)
+    std::vector<int> fields;
+    /// Column of each Template field (-1 == not stored, only if the Template is not fixed)
+    std::vector<int> map;
+};
+
+/**
+ * @brief Block of flow records
+ *
+ * Records are appended directly into typed columns of the ClickHouse client, which
+ * are reserved for the maximum number of records in the block and reused after the block
+ * is inserted (i.e. the capacity of columns is kept).
+ */
+class Block {
+public:
+    /**
+     * @brief Create an empty block
+     * @param[in] defs     Definitions of columns (must exist until the block is destroyed)
+     * @param[in] rows_max Maximum number of records in the block
+     */
+    Block(const std::vector<Column_def> &defs, size_t rows_max);
+    ~Block() = default;
+
+    // Disable copy constructors
+    Block(const Block &other) = delete;
+    Block &operator=(const Block &other) = delete;
+
+    /**
+     * @brief Prepare a plan of a Template
+     * @param[in] tmplt Template
+     * @param[in] defs  Definitions of columns
+     * @return Plan
+     */
+    static Plan
+    plan_create(const struct fds_template *tmplt, const std::vector<Column_def> &defs);
+
+    /**
+     * @brief Append a Data Record
+     *
+     * Columns of fields missing in the record are filled with default values of their types.
+     * @param[in] rec  Data Record
+     * @param[in] plan Plan of the Template of the record
+     */
+    void
+    append(struct fds_drec &rec, const Plan &plan);
+
+    /**
+     * @brief Fill a ClickHouse block with columns of the block
+     * @param[out] block ClickHouse block (must be empty)
+     */
+    void
+    fill(clickhouse::Block &block) const;
+
+    /**
+     * @brief Remove all records from the block
+     */
+    void
+    clear();
+
+    /**
+     * @brief Get number of records in the block
+     */
+    size_t
+    rows() const {return m_rows;};
+
+    /**
+     * @brief Check if the block is full
+     */
+    bool
+    is_full() const {return m_rows >= m_rows_max;};
+
+    /**
+     * @brief Get time of insertion of the first record (monotonic clock)
+     */
+    const struct timespec &
+    start() const {return m_start;};
+
+private:
+    /// Type of a column
+    enum class kind {
+        UINT8, UINT16, UINT32, UINT64,
+        INT8, INT16, INT32, INT64,
+        FLOAT32, FLOAT64,
+        BOOL,
+        IPV4, IPV6, MAC,
+        TIME_MS, TIME_NS,
+        STRING
+    };
+
+    /// Column of the block
+    struct column {
+        /// Type of the column
+        kind type;
+        /// Column of the ClickHouse client
+        clickhouse::ColumnRef ref;
+    };
+
+    /// Value of a field of the current record
+    struct value {
+        /// Pointer to the value (nullptr == missing field)
+        const uint8_t *data;
+        /// Size of the value
+        uint16_t size;
+    };
+
+    /// Definitions of columns
+    const std::vector<Column_def> &m_defs;
+    /// Columns
+    std::vector<struct column> m_columns;
+    /// Values of the current record (auxiliary buffer)
+    std::vector<struct value> m_values;
+    /// Number of records in the block
+    size_t m_rows = 0;
+    /// Maximum number of records in the block
+    size_t m_rows_max;
+    /// Time of insertion of the first record
+    struct timespec m_start = {0, 0};
+
+    static void
+    column_append(struct column &col, enum fds_iemgr_element_type type, const struct value &val);
+};
+
+#endif // IPFIXCOL2_CLICKHOUSE_BLOCK_HPP
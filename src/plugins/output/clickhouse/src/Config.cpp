@@ -0,0 +1,354 @@
+/**
+ * \file src/plugins/output/clickhouse/src/Config.cpp
+ * \author agent <agent@local>
+ * \brief Parser of XML configuration (source file)
+ * \date 2026
+ *
+ * Copyright(c) 2026 CESNET z.s.p.o.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include "Config.hpp"
+#include <cassert>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <strings.h>
+
+/*
+ * <params>
+ *   <connection>
+ *     <host>...</host>
+ *     <port>...</port>                   <!-- optional -->
+ *     <user>...</user>                   <!-- optional -->
+ *     <password>...</password>           <!-- optional -->
+ *     <database>...</database>           <!-- optional -->
+ *   </connection>
+ *   <table>...</table>
+ *   <columns>
+ *     <column>                           <!-- multiple -->
+ *       <name>...</name>
+ *       <source>...</source>
+ *     </column>
+ *   </columns>
+ *   <compression>...</compression>       <!-- optional -->
+ *   <blockSize>...</blockSize>           <!-- optional -->
+ *   <flushInterval>...</flushInterval>   <!-- optional -->
+ *   <queueSize>...</queueSize>           <!-- optional -->
+ * </params>
+ */
+
+/// XML nodes
+enum params_xml_nodes {
+    NODE_CONN = 1,
+    NODE_TABLE,
+    NODE_COLUMNS,
+    NODE_COMPRESS,
+    NODE_BLOCK,
+    NODE_FLUSH,
+    NODE_QUEUE,
+
+    CONN_HOST,
+    CONN_PORT,
+    CONN_USER,
+    CONN_PASS,
+    CONN_DB,
+
+    COLUMNS_COLUMN,
+    COLUMN_NAME,
+    COLUMN_SOURCE
+};
+
+/// Definition of the \<connection\> node
+static const struct fds_xml_args args_conn[] = {
+    FDS_OPTS_ELEM(CONN_HOST,    "host",                FDS_OPTS_T_STRING, 0),
+    FDS_OPTS_ELEM(CONN_PORT,    "port",                FDS_OPTS_T_UINT,   FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM(CONN_USER,    "user",                FDS_OPTS_T_STRING, FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM(CONN_PASS,    "password",            FDS_OPTS_T_STRING, FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM(CONN_DB,      "database",            FDS_OPTS_T_STRING, FDS_OPTS_P_OPT),
+    FDS_OPTS_END
+};
+
+/// Definition of the \<column\> node
+static const struct fds_xml_args args_column[] = {
+    FDS_OPTS_ELEM(COLUMN_NAME,   "name",               FDS_OPTS_T_STRING, 0),
+    FDS_OPTS_ELEM(COLUMN_SOURCE, "source",             FDS_OPTS_T_STRING, 0),
+    FDS_OPTS_END
+};
+
+/// Definition of the \<columns\> node
+static const struct fds_xml_args args_columns[] = {
+    FDS_OPTS_NESTED(COLUMNS_COLUMN, "column",          args_column,       FDS_OPTS_P_MULTI),
+    FDS_OPTS_END
+};
+
+/// Definition of the \<params\> node
+static const struct fds_xml_args args_params[] = {
+    FDS_OPTS_ROOT("params"),
+    FDS_OPTS_NESTED(NODE_CONN,   "connection",         args_conn,         0),
+    FDS_OPTS_ELEM(NODE_TABLE,    "table",              FDS_OPTS_T_STRING, 0),
+    FDS_OPTS_NESTED(NODE_COLUMNS, "columns",           args_columns,      0),
+    FDS_OPTS_ELEM(NODE_COMPRESS, "compression",        FDS_OPTS_T_STRING, FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM(NODE_BLOCK,    "blockSize",          FDS_OPTS_T_UINT,   FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM(NODE_FLUSH,    "flushInterval",      FDS_OPTS_T_UINT,   FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM(NODE_QUEUE,    "queueSize",          FDS_OPTS_T_UINT,   FDS_OPTS_P_OPT),
+    FDS_OPTS_END
+};
+
+Config::Config(const char *params)
+{
+    set_default();
+
+    // Create XML parser
+    std::unique_ptr<fds_xml_t, decltype(&fds_xml_destroy)> xml(fds_xml_create(), &fds_xml_destroy);
+    if (!xml) {
+        throw std::runtime_error("Failed to create an XML parser!");
+    }
+
+    if (fds_xml_set_args(xml.get(), args_params) != FDS_OK) {
+        throw std::runtime_error("Failed to parse the description of an XML document!");
+    }
+
+    fds_xml_ctx_t *params_ctx = fds_xml_parse_mem(xml.get(), params, true);
+    if (!params_ctx) {
+        std::string err = fds_xml_last_err(xml.get());
+        throw std::runtime_error("Failed to parse the configuration: " + err);
+    }
+
+    // Parse parameters and check configuration
+    try {
+        parse_root(params_ctx);
+        validate();
+    } catch (std::exception &ex) {
+        throw std::runtime_error("Failed to parse the configuration: " + std::string(ex.what()));
+    }
+}
+
+/**
+ * @brief Set default parameters
+ */
+void
+Config::set_default()
+{
+    m_conn.host.clear();
+    m_conn.port = PORT_DEF;
+    m_conn.user = "default";
+    m_conn.password.clear();
+    m_conn.database = "default";
+
+    m_table.clear();
+    m_columns.clear();
+    m_calg = calg::LZ4;
+    m_block_size = BLOCK_DEF;
+    m_flush = FLUSH_DEF;
+    m_queue = QUEUE_DEF;
+}
+
+/**
+ * @brief Check if the configuration is valid
+ * @throw runtime_error if the configuration breaks some rules
+ */
+void
+Config::validate()
+{
+    if (m_conn.host.empty()) {
+        throw std::runtime_error("Host cannot be empty!");
+    }
+
+    if (m_table.empty()) {
+        throw std::runtime_error("Table name cannot be empty!");
+    }
+
+    if (m_columns.empty()) {
+        throw std::runtime_error("At least one column must be defined!");
+    }
+
+    for (size_t i = 0; i < m_columns.size(); ++i) {
+        for (size_t j = i + 1; j < m_columns.size(); ++j) {
+            if (m_columns[i].name == m_columns[j].name) {
+                throw std::runtime_error("Column '" + m_columns[i].name
+                    + "' is defined multiple times!");
+            }
+        }
+    }
+
+    if (m_block_size == 0 || m_block_size > BLOCK_MAX) {
+        throw std::runtime_error("Block size must be between 1 and "
+            + std::to_string(BLOCK_MAX) + "!");
+    }
+
+    if (m_flush == 0) {
+        throw std::runtime_error("Flush interval cannot be zero!");
+    }
+
+    if (m_queue == 0 || m_queue > QUEUE_MAX) {
+        throw std::runtime_error("Queue size must be between 1 and "
+            + std::to_string(QUEUE_MAX) + "!");
+    }
+}
+
+/**
+ * @brief Process \<params\> node
+ * @param[in] ctx XML context to process
+ * @throw runtime_error if the parser fails
+ */
+void
+Config::parse_root(fds_xml_ctx_t *ctx)
+{
+    const struct fds_xml_cont *content;
+    while (fds_xml_next(ctx, &content) != FDS_EOC) {
+        switch (content->id) {
+        case NODE_CONN:
+            // Connection parameters
+            assert(content->type == FDS_OPTS_T_CONTEXT);
+            parse_conn(content->ptr_ctx);
+            break;
+        case NODE_TABLE:
+            // Table name
+            assert(content->type == FDS_OPTS_T_STRING);
+            m_table = content->ptr_string;
+            break;
+        case NODE_COLUMNS:
+            // Columns of the table
+            assert(content->type == FDS_OPTS_T_CONTEXT);
+            parse_columns(content->ptr_ctx);
+            break;
+        case NODE_COMPRESS:
+            // Compression method
+            assert(content->type == FDS_OPTS_T_STRING);
+            if (strcasecmp(content->ptr_string, "none") == 0) {
+                m_calg = calg::NONE;
+            } else if (strcasecmp(content->ptr_string, "lz4") == 0) {
+                m_calg = calg::LZ4;
+            } else {
+                const std::string inv_str = content->ptr_string;
+                throw std::runtime_error("Unknown compression algorithm '" + inv_str + "'");
+            }
+            break;
+        case NODE_BLOCK:
+            // Size of blocks
+            assert(content->type == FDS_OPTS_T_UINT);
+            if (content->val_uint > BLOCK_MAX) {
+                throw std::runtime_error("Block size is too big!");
+            }
+            m_block_size = static_cast<uint32_t>(content->val_uint);
+            break;
+        case NODE_FLUSH:
+            // Flush interval
+            assert(content->type == FDS_OPTS_T_UINT);
+            if (content->val_uint > UINT32_MAX) {
+                throw std::runtime_error("Flush interval is too long!");
+            }
+            m_flush = static_cast<uint32_t>(content->val_uint);
+            break;
+        case NODE_QUEUE:
+            // Number of waiting blocks
+            assert(content->type == FDS_OPTS_T_UINT);
+            if (content->val_uint > QUEUE_MAX) {
+                throw std::runtime_error("Queue size is too big!");
+            }
+            m_queue = static_cast<uint32_t>(content->val_uint);
+            break;
+        default:
+            // Internal error
+            throw std::runtime_error("Unknown XML node");
+        }
+    }
+}
+
+/**
+ * @brief Auxiliary function for parsing \<connection\> options
+ * @param[in] ctx XML context to process
+ * @throw runtime_error if the parser fails
+ */
+void
+Config::parse_conn(fds_xml_ctx_t *ctx)
+{
+    const struct fds_xml_cont *content;
+    while(fds_xml_next(ctx, &content) != FDS_EOC) {
+        switch (content->id) {
+        case CONN_HOST:
+            assert(content->type == FDS_OPTS_T_STRING);
+            m_conn.host = content->ptr_string;
+            break;
+        case CONN_PORT:
+            assert(content->type == FDS_OPTS_T_UINT);
+            if (content->val_uint == 0 || content->val_uint > UINT16_MAX) {
+                throw std::runtime_error("Invalid port number!");
+            }
+            m_conn.port = static_cast<uint16_t>(content->val_uint);
+            break;
+        case CONN_USER:
+            assert(content->type == FDS_OPTS_T_STRING);
+            m_conn.user = content->ptr_string;
+            break;
+        case CONN_PASS:
+            assert(content->type == FDS_OPTS_T_STRING);
+            m_conn.password = content->ptr_string;
+            break;
+        case CONN_DB:
+            assert(content->type == FDS_OPTS_T_STRING);
+            m_conn.database = content->ptr_string;
+            break;
+        default:
+            // Internal error
+            throw std::runtime_error("Unknown XML node");
+        }
+    }
+}
+
+/**
+ * @brief Auxiliary function for parsing \<columns\> options
+ * @param[in] ctx XML context to process
+ * @throw runtime_error if the parser fails
+ */
+void
+Config::parse_columns(fds_xml_ctx_t *ctx)
+{
+    const struct fds_xml_cont *content;
+    while(fds_xml_next(ctx, &content) != FDS_EOC) {
+        switch (content->id) {
+        case COLUMNS_COLUMN:
+            assert(content->type == FDS_OPTS_T_CONTEXT);
+            parse_column(content->ptr_ctx);
+            break;
+        default:
+            // Internal error
+            throw std::runtime_error("Unknown XML node");
+        }
+    }
+}
+
+/**
+ * @brief Auxiliary function for parsing \<column\> options
+ * @param[in] ctx XML context to process
+ * @throw runtime_error if the parser fails
+ */
+void
+Config::parse_column(fds_xml_ctx_t *ctx)
+{
+    struct column col;
+
+    const struct fds_xml_cont *content;
+    while(fds_xml_next(ctx, &content) != FDS_EOC) {
+        switch (content->id) {
+        case COLUMN_NAME:
+            assert(content->type == FDS_OPTS_T_STRING);
+            col.name = content->ptr_string;
+            break;
+        case COLUMN_SOURCE:
+            assert(content->type == FDS_OPTS_T_STRING);
+            col.source = content->ptr_string;
+            break;
+        default:
+            // Internal error
+            throw std::runtime_error("Unknown XML node");
+        }
+    }
+
+    if (col.name.empty() || col.source.empty()) {
+        throw std::runtime_error("Name and source of a column cannot be empty!");
+    }
+
+    m_columns.push_back(std::move(col));
+}
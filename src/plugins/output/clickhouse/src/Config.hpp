@@ -0,0 +1,95 @@
+/**
+ * \file src/plugins/output/clickhouse/src/Config.hpp
+ * \author agent <agent@local>
+ * \brief Parser of XML configuration (header file)
+ * \date 2026
+ *
+ * Copyright(c) 2026 CESNET z.s.p.o.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef IPFIXCOL2_CLICKHOUSE_CONFIG_HPP
+#define IPFIXCOL2_CLICKHOUSE_CONFIG_HPP
+
+#include <string>
+#include <vector>
+#include <libfds.h>
+
+/**
+ * @brief Plugin configuration parser
+ */
+class Config {
+public:
+    /**
+     * @brief Parse configuration of the plugin
+     * @param[in] params XML parameters to parse
+     * @throw runtime_exception on error
+     */
+    Config(const char *params);
+    ~Config() = default;
+
+    enum class calg {
+        NONE,   ///< Do not use compression
+        LZ4     ///< LZ4 compression
+    };
+
+    /// Column of the table
+    struct column {
+        /// Name of the column
+        std::string name;
+        /// Name of the source Information Element (e.g. "iana:octetDeltaCount")
+        std::string source;
+    };
+
+    struct {
+        std::string host;      ///< Hostname or IP address of the server
+        uint16_t    port;      ///< Port of the native protocol
+        std::string user;      ///< User name
+        std::string password;  ///< Password
+        std::string database;  ///< Database
+    } m_conn;    ///< Connection parameters
+
+    /// Name of the table
+    std::string m_table;
+    /// Columns of the table
+    std::vector<struct column> m_columns;
+    /// Compression of blocks
+    calg m_calg;
+    /// Maximum number of records in a block
+    uint32_t m_block_size;
+    /// Maximum age of a non-empty block before it's inserted (milliseconds)
+    uint32_t m_flush;
+    /// Maximum number of blocks waiting for insertion
+    uint32_t m_queue;
+
+private:
+    /// Default port of the native protocol
+    static const uint16_t PORT_DEF = 9000U;
+    /// Default number of records in a block
+    static const uint32_t BLOCK_DEF = 65536U;
+    /// Maximum number of records in a block
+    static const uint32_t BLOCK_MAX = 1048576U;
+    /// Default flush interval (milliseconds)
+    static const uint32_t FLUSH_DEF = 1000U;
+    /// Default number of blocks waiting for insertion
+    static const uint32_t QUEUE_DEF = 4U;
+    /// Maximum number of blocks waiting for insertion
+    static const uint32_t QUEUE_MAX = 64U;
+
+    void
+    set_default();
+    void
+    validate();
+
+    void
+    parse_root(fds_xml_ctx_t *ctx);
+    void
+    parse_conn(fds_xml_ctx_t *ctx);
+    void
+    parse_columns(fds_xml_ctx_t *ctx);
+    void
+    parse_column(fds_xml_ctx_t *ctx);
+};
+
+
+#endif // IPFIXCOL2_CLICKHOUSE_CONFIG_HPP
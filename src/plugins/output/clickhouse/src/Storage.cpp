@@ -0,0 +1,283 @@
+/**
+ * \file src/plugins/output/clickhouse/src/Storage.cpp
+ * \author agent <agent@local>
+ * \brief ClickHouse flow storage (source file)
+ * \date 2026
+ *
+ * Copyright(c) 2026 CESNET z.s.p.o.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cinttypes>
+#include <system_error>
+#include "Storage.hpp"
+
+/// Maximum number of prepared plans (all plans are dropped if exceeded)
+static const size_t PLANS_MAX = 1024U;
+/// Maximum period of checking the age of the block being filled (milliseconds)
+static const uint32_t CHECK_PERIOD = 100U;
+
+Storage::Storage(ipx_ctx_t *ctx, const Config &cfg, const fds_iemgr_t *iemgr)
+    : m_ctx(ctx), m_cfg(cfg)
+{
+    // Resolve sources of columns
+    for (const Config::column &col : m_cfg.m_columns) {
+        const struct fds_iemgr_elem *elem = nullptr;
+        if (iemgr != nullptr) {
+            elem = fds_iemgr_elem_find_name(iemgr, col.source.c_str());
+        }
+        if (!elem) {
+            throw ClickHouse_exception("Unknown Information Element '" + col.source
+                + "' of column '" + col.name + "'");
+        }
+
+        m_defs.push_back({col.name, elem->scope->pen, elem->id, elem->data_type});
+    }
+
+    for (uint32_t i = 0; i < m_cfg.m_queue; ++i) {
+        m_blocks.emplace_back(new Block(m_defs, m_cfg.m_block_size));
+        m_free.push_back(m_blocks.back().get());
+    }
+
+    try {
+        m_thread = std::thread(&Storage::thread_main, this);
+    } catch (const std::system_error &ex) {
+        throw ClickHouse_exception("Failed to start an insertion thread: "
+            + std::string(ex.what()));
+    }
+}
+
+Storage::~Storage()
+{
+    {
+        // Insert remaining records
+        std::lock_guard<std::mutex> cur_lock(m_cur_mutex);
+        if (m_current != nullptr && m_current->rows() > 0) {
+            block_pass(m_current);
+            m_current = nullptr;
+        }
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_cv_ready.notify_one();
+    m_thread.join();
+}
+
+void
+Storage::process_msg(ipx_msg_ipfix_t *msg)
+{
+    std::lock_guard<std::mutex> cur_lock(m_cur_mutex);
+
+    // Templates are valid only during processing of the message
+    m_msg_plans.clear();
+    const struct fds_template *last_tmplt = nullptr;
+    const Plan *last_plan = nullptr;
+
+    const uint32_t rec_cnt = ipx_msg_ipfix_get_drec_cnt(msg);
+    for (uint32_t i = 0; i < rec_cnt; ++i) {
+        ipx_ipfix_record *rec_ptr = ipx_msg_ipfix_get_drec(msg, i);
+
+        // Consecutive records usually share the same Template
+        if (rec_ptr->rec.tmplt != last_tmplt) {
+            last_tmplt = rec_ptr->rec.tmplt;
+            last_plan = &plan_get(last_tmplt);
+        }
+
+        if (m_current == nullptr) {
+            m_current = block_acquire();
+        }
+
+        m_current->append(rec_ptr->rec, *last_plan);
+        if (m_current->is_full()) {
+            block_pass(m_current);
+            m_current = nullptr;
+        }
+    }
+
+    if (m_current != nullptr && block_expired(*m_current)) {
+        block_pass(m_current);
+        m_current = nullptr;
+    }
+}
+
+/**
+ * @brief Find or prepare a plan of a Template
+ * @param[in] tmplt Template
+ * @return Plan
+ */
+const Plan &
+Storage::plan_get(const struct fds_template *tmplt)
+{
+    for (const auto &msg_plan : m_msg_plans) {
+        if (msg_plan.first == tmplt) {
+            return *msg_plan.second;
+        }
+    }
+
+    std::string id(reinterpret_cast<const char *>(tmplt->raw.data), tmplt->raw.length);
+    id.push_back(static_cast<char>(tmplt->type));
+
+    auto it = m_plans.find(id);
+    if (it == m_plans.end()) {
+        if (m_plans.size() >= PLANS_MAX) {
+            // Previous plans of the current message are not used anymore
+            m_msg_plans.clear();
+            m_plans.clear();
+        }
+
+        std::unique_ptr<Plan> plan(new Plan(Block::plan_create(tmplt, m_defs)));
+        it = m_plans.emplace(std::move(id), std::move(plan)).first;
+    }
+
+    const Plan *plan = it->second.get();
+    m_msg_plans.emplace_back(tmplt, plan);
+    return *plan;
+}
+
+/**
+ * @brief Get an empty block
+ *
+ * If all blocks are waiting for insertion, wait until a block is released.
+ * @return Block
+ */
+Block *
+Storage::block_acquire()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_cv_free.wait(lock, [this]() {return !m_free.empty();});
+    Block *block = m_free.front();
+    m_free.pop_front();
+    return block;
+}
+
+/**
+ * @brief Pass a block to the insertion thread
+ * @param[in] block Block
+ */
+void
+Storage::block_pass(Block *block)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_ready.push_back(block);
+    }
+    m_cv_ready.notify_one();
+}
+
+/**
+ * @brief Check if a non-empty block is older than the flush interval
+ * @param[in] block Block
+ * @return True or false
+ */
+bool
+Storage::block_expired(const Block &block) const
+{
+    if (block.rows() == 0) {
+        return false;
+    }
+
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    const int64_t age = (now.tv_sec - block.start().tv_sec) * INT64_C(1000)
+        + (now.tv_nsec - block.start().tv_nsec) / 1000000;
+    return age >= static_cast<int64_t>(m_cfg.m_flush);
+}
+
+/**
+ * @brief Pass the block being filled to the insertion thread if it's expired
+ *
+ * Nothing happens if records are just being appended into the block.
+ */
+void
+Storage::flush_expired()
+{
+    std::unique_lock<std::mutex> cur_lock(m_cur_mutex, std::try_to_lock);
+    if (!cur_lock.owns_lock()) {
+        return;
+    }
+
+    if (m_current != nullptr && block_expired(*m_current)) {
+        block_pass(m_current);
+        m_current = nullptr;
+    }
+}
+
+/**
+ * @brief Main function of the insertion thread
+ *
+ * Waiting blocks are inserted in the order in which they were passed. If there is no waiting
+ * block, the block being filled is periodically checked and passed if it's expired.
+ */
+void
+Storage::thread_main()
+{
+    const auto period = std::chrono::milliseconds(std::min(m_cfg.m_flush, CHECK_PERIOD));
+    std::unique_lock<std::mutex> lock(m_mutex);
+
+    while (true) {
+        if (m_ready.empty()) {
+            if (m_stop) {
+                break;
+            }
+
+            m_cv_ready.wait_for(lock, period);
+            if (m_ready.empty()) {
+                lock.unlock();
+                flush_expired();
+                lock.lock();
+                continue;
+            }
+        }
+
+        Block *block = m_ready.front();
+        m_ready.pop_front();
+        lock.unlock();
+
+        insert(*block);
+        block->clear();
+
+        lock.lock();
+        m_free.push_back(block);
+        m_cv_free.notify_one();
+    }
+}
+
+/**
+ * @brief Insert a block into the table (called by the insertion thread)
+ *
+ * If the insertion fails, records of the block are dropped and the connection is established
+ * again before the next insertion.
+ * @param[in] block Block to insert
+ */
+void
+Storage::insert(Block &block)
+{
+    try {
+        if (!m_client) {
+            clickhouse::ClientOptions opts;
+            opts.SetHost(m_cfg.m_conn.host)
+                .SetPort(m_cfg.m_conn.port)
+                .SetUser(m_cfg.m_conn.user)
+                .SetPassword(m_cfg.m_conn.password)
+                .SetDefaultDatabase(m_cfg.m_conn.database)
+                .SetCompressionMethod((m_cfg.m_calg == Config::calg::LZ4)
+                    ? clickhouse::CompressionMethod::LZ4 : clickhouse::CompressionMethod::None);
+            m_client.reset(new clickhouse::Client(opts));
+            IPX_CTX_INFO(m_ctx, "Connected to the ClickHouse server '%s:%" PRIu16 "'",
+                m_cfg.m_conn.host.c_str(), m_cfg.m_conn.port);
+        }
+
+        clickhouse::Block ch_block;
+        block.fill(ch_block);
+        m_client->Insert(m_cfg.m_table, ch_block);
+    } catch (const std::exception &ex) {
+        IPX_CTX_ERROR(m_ctx, "Failed to insert %zu records into the table '%s': %s",
+            block.rows(), m_cfg.m_table.c_str(), ex.what());
+        m_client.reset();
+    }
+}
@@ -0,0 +1,119 @@
+/**
+ * \file src/plugins/output/clickhouse/src/Storage.hpp
+ * \author agent <agent@local>
+ * \brief ClickHouse flow storage (header file)
+ * \date 2026
+ *
+ * Copyright(c) 2026 CESNET z.s.p.o.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef IPFIXCOL2_CLICKHOUSE_STORAGE_HPP
+#define IPFIXCOL2_CLICKHOUSE_STORAGE_HPP
+
+#include <ipfixcol2.h>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include <libfds.h>
+
+#include "Block.hpp"
+#include "Config.hpp"
+#include "Exception.hpp"
+
+/**
+ * @brief Flow storage in a ClickHouse table
+ *
+ * Records are appended into blocks of columns according to plans of their Templates.
+ * Full blocks (or blocks older than the flush interval) are passed to a background thread,
+ * which inserts them into the table over the native protocol. Therefore, conversion of
+ * records is not blocked by the network unless all blocks are waiting for insertion.
+ */
+class Storage {
+public:
+    /**
+     * @brief Create a flow storage
+     *
+     * @param[in] ctx   Plugin context (only for log)
+     * @param[in] cfg   Configuration (must exist until the storage is destroyed)
+     * @param[in] iemgr Information Element manager (only to resolve sources of columns)
+     * @throw ClickHouse_exception if a source of a column is unknown or the thread cannot
+     *   be started
+     */
+    Storage(ipx_ctx_t *ctx, const Config &cfg, const fds_iemgr_t *iemgr);
+    virtual ~Storage();
+
+    // Disable copy constructors
+    Storage(const Storage &other) = delete;
+    Storage &operator=(const Storage &other) = delete;
+
+    /**
+     * @brief Process IPFIX message
+     *
+     * Append all IPFIX Data Records in the message into blocks.
+     * @param[in] msg Message to process
+     */
+    void
+    process_msg(ipx_msg_ipfix_t *msg);
+
+private:
+    /// Plugin context only for logging!
+    ipx_ctx_t *m_ctx;
+    /// Configuration
+    const Config &m_cfg;
+    /// Definitions of columns
+    std::vector<Column_def> m_defs;
+
+    /// Plans of Templates (raw Templates are keys)
+    std::unordered_map<std::string, std::unique_ptr<Plan>> m_plans;
+    /// Plans of Templates of the current message
+    std::vector<std::pair<const struct fds_template *, const Plan *>> m_msg_plans;
+
+    /// All blocks
+    std::vector<std::unique_ptr<Block>> m_blocks;
+    /// Block being filled (nullptr == not acquired yet, protected by m_cur_mutex)
+    Block *m_current = nullptr;
+    /// Mutex of the block being filled
+    std::mutex m_cur_mutex;
+
+    /// Empty blocks (protected by m_mutex)
+    std::deque<Block *> m_free;
+    /// Blocks waiting for insertion (protected by m_mutex)
+    std::deque<Block *> m_ready;
+    /// Request to stop the thread (protected by m_mutex)
+    bool m_stop = false;
+    /// Mutex of queues
+    std::mutex m_mutex;
+    /// A block has been released
+    std::condition_variable m_cv_free;
+    /// A block is waiting for insertion or the thread should stop
+    std::condition_variable m_cv_ready;
+    /// Insertion thread
+    std::thread m_thread;
+    /// Client of the server (used only by the thread, nullptr == not connected)
+    std::unique_ptr<clickhouse::Client> m_client;
+
+    const Plan &
+    plan_get(const struct fds_template *tmplt);
+    Block *
+    block_acquire();
+    void
+    block_pass(Block *block);
+    bool
+    block_expired(const Block &block) const;
+    void
+    flush_expired();
+
+    void
+    thread_main();
+    void
+    insert(Block &block);
+};
+
+#endif // IPFIXCOL2_CLICKHOUSE_STORAGE_HPP
@@ -0,0 +1,95 @@
+/**
+ * \file src/plugins/output/clickhouse/src/clickhouse.cpp
+ * \author agent <agent@local>
+ * \brief ClickHouse output plugin for IPFIXcol 2
+ * \date 2026
+ *
+ * Copyright(c) 2026 CESNET z.s.p.o.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include <ipfixcol2.h>
+#include <memory>
+
+#include "Config.hpp"
+#include "Storage.hpp"
+
+/// Plugin description
+IPX_API struct ipx_plugin_info ipx_plugin_info = {
+    // Plugin identification name
+    "clickhouse",
+    // Brief description of plugin
+    "Output plugin inserting flow records into ClickHouse over the native protocol",
+    // Plugin type
+    IPX_PT_OUTPUT,
+    // Configuration flags (reserved for future use)
+    0,
+    // Plugin version string (like "1.2.3")
+    "2.0.0",
+    // Minimal IPFIXcol version string (like "1.2.3")
+    "2.1.0"
+};
+
+/// Instance
+struct Instance {
+    /// Parsed configuration
+    std::unique_ptr<Config> config_ptr = nullptr;
+    /// Flow storage
+    std::unique_ptr<Storage> storage_ptr = nullptr;
+};
+
+int
+ipx_plugin_init(ipx_ctx_t *ctx, const char *params)
+{
+    try {
+        // Parse configuration and prepare the storage
+        std::unique_ptr<Instance> instance(new Instance);
+        instance->config_ptr.reset(new Config(params));
+        instance->storage_ptr.reset(new Storage(ctx, *instance->config_ptr,
+            ipx_ctx_iemgr_get(ctx)));
+        // Everything seems OK
+        ipx_ctx_private_set(ctx, instance.release());
+    } catch (const std::exception &ex) {
+        IPX_CTX_ERROR(ctx, "Initialization failed: %s", ex.what());
+        return IPX_ERR_DENIED;
+    } catch (...) {
+        IPX_CTX_ERROR(ctx, "Unknown error has occurred!", '\0');
+        return IPX_ERR_DENIED;
+    }
+
+    return IPX_OK;
+}
+
+void
+ipx_plugin_destroy(ipx_ctx_t *ctx, void *cfg)
+{
+    (void) ctx; // Suppress warnings
+
+    try {
+        auto inst = reinterpret_cast<Instance *>(cfg);
+        inst->storage_ptr.reset();
+        inst->config_ptr.reset();
+        delete inst;
+    } catch (...) {
+        IPX_CTX_ERROR(ctx, "Something bad happened during plugin destruction", '\0');
+    }
+}
+
+int
+ipx_plugin_process(ipx_ctx_t *ctx, void *cfg, ipx_msg_t *msg)
+{
+    auto *inst = reinterpret_cast<Instance *>(cfg);
+
+    try {
+        ipx_msg_ipfix_t *msg_ipfix = ipx_msg_base2ipfix(msg);
+        inst->storage_ptr->process_msg(msg_ipfix);
+    } catch (const ClickHouse_exception &ex) {
+        IPX_CTX_ERROR(ctx, "%s", ex.what());
+    } catch (std::exception &ex) {
+        IPX_CTX_ERROR(ctx, "Unexpected error has occurred: %s", ex.what());
+    } catch (...) {
+        IPX_CTX_ERROR(ctx, "Unknown error has occurred!", '\0');
+    }
+
+    return IPX_OK;
+}
@@ -45,14 +45,23 @@
 
 /*
  * <params>
- *  <delay>...</delay>          <!-- in microseconds -->
+ *  <delay>...</delay>                  <!-- in microseconds -->
+ *  <stats>...</stats>                  <!-- optional, true/false -->
+ *  <statsInterval>...</statsInterval>  <!-- optional, in seconds -->
+ *  <touchRecords>...</touchRecords>    <!-- optional, true/false -->
+ *  <iterateFields>...</iterateFields>  <!-- optional, true/false -->
+ *  <latencyProbes>...</latencyProbes>  <!-- optional, true/false -->
  * </params>
  */
 
 /** XML nodes */
 enum params_xml_nodes {
     NODE_DELAY = 1,
-    NODE_STATS
+    NODE_STATS,
+    NODE_STATS_INTERVAL,
+    NODE_TOUCH,
+    NODE_ITER,
+    NODE_LATENCY
 };
 
 /** Definition of the \<params\> node  */
@@ -60,6 +69,10 @@ static const struct fds_xml_args args_params[] = {
     FDS_OPTS_ROOT("params"),
     FDS_OPTS_ELEM(NODE_DELAY, "delay", FDS_OPTS_T_UINT, 0),
     FDS_OPTS_ELEM(NODE_STATS, "stats", FDS_OPTS_T_BOOL, FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM(NODE_STATS_INTERVAL, "statsInterval", FDS_OPTS_T_UINT, FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM(NODE_TOUCH, "touchRecords", FDS_OPTS_T_BOOL, FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM(NODE_ITER, "iterateFields", FDS_OPTS_T_BOOL, FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM(NODE_LATENCY, "latencyProbes", FDS_OPTS_T_BOOL, FDS_OPTS_P_OPT),
     FDS_OPTS_END
 };
 
@@ -74,8 +87,6 @@ static const struct fds_xml_args args_params[] = {
 static int
 config_parser_root(ipx_ctx_t *ctx, fds_xml_ctx_t *root, struct instance_config *cfg)
 {
-    (void) ctx;
-
     const struct fds_xml_cont *content;
     while(fds_xml_next(root, &content) != FDS_EOC) {
         switch (content->id) {
@@ -89,6 +100,27 @@ config_parser_root(ipx_ctx_t *ctx, fds_xml_ctx_t *root, struct instance_config *
             assert(content->type == FDS_OPTS_T_BOOL);
             cfg->en_stats = content->val_bool;
             break;
+        case NODE_STATS_INTERVAL:
+            // Interval of throughput statistics [seconds]
+            assert(content->type == FDS_OPTS_T_UINT);
+            if (content->val_uint > UINT32_MAX) {
+                IPX_CTX_ERROR(ctx, "Interval of statistics is too long!", '\0');
+                return IPX_ERR_FORMAT;
+            }
+            cfg->stats_interval = (uint32_t) content->val_uint;
+            break;
+        case NODE_TOUCH:
+            assert(content->type == FDS_OPTS_T_BOOL);
+            cfg->en_touch = content->val_bool;
+            break;
+        case NODE_ITER:
+            assert(content->type == FDS_OPTS_T_BOOL);
+            cfg->en_iter = content->val_bool;
+            break;
+        case NODE_LATENCY:
+            assert(content->type == FDS_OPTS_T_BOOL);
+            cfg->en_latency = content->val_bool;
+            break;
         default:
             // Internal error
             assert(false);
@@ -108,6 +140,10 @@ config_default_set(struct instance_config *cfg)
     cfg->sleep_time.tv_sec = 0;
     cfg->sleep_time.tv_nsec = 100000000LL; // 100ms between messages
     cfg->en_stats = false;
+    cfg->stats_interval = 0;
+    cfg->en_touch = false;
+    cfg->en_iter = false;
+    cfg->en_latency = false;
 }
 
 struct instance_config *
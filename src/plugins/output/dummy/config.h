@@ -51,6 +51,14 @@ struct instance_config {
     struct timespec sleep_time;
     /** Enable statistics                                */
     bool en_stats;
+    /** Interval of throughput statistics (sec, 0 == disabled) */
+    uint32_t stats_interval;
+    /** Read all bytes of each Data Record               */
+    bool en_touch;
+    /** Iterate over all fields of each Data Record      */
+    bool en_iter;
+    /** Measure latency of probes sent by ipfixsend      */
+    bool en_latency;
 };
 
 /**
@@ -40,9 +40,13 @@
  */
 
 #include <ipfixcol2.h>
+#include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <unistd.h>
 #include <inttypes.h>
+#include <time.h>
+#include <arpa/inet.h>
 
 #include "config.h"
 
@@ -51,6 +55,24 @@
 #define IE_ID_BYTES  1
 #define IE_ID_PKTS   2
 
+/** Enterprise Number of latency probes of ipfixsend (Documentation Use, RFC 5612) */
+#define PROBE_PEN     32473
+/** Time of sending of a probe (unsigned64, nanoseconds since UNIX epoch) */
+#define PROBE_ID_TIME 1
+
+/** Number of sub-buckets of each power of two of the latency histogram (~3% precision) */
+#define LAT_SUB_BITS  6
+#define LAT_SUB_CNT   (1U << LAT_SUB_BITS)
+/** Number of buckets of the latency histogram (covers the whole uint64_t range) */
+#define LAT_BUCKETS   ((64 - LAT_SUB_BITS + 1) * (LAT_SUB_CNT / 2) + LAT_SUB_CNT / 2)
+
+/** Histogram of latencies (log-linear buckets of nanoseconds) */
+struct lat_hist {
+    uint64_t cnt;                   /**< Number of samples      */
+    uint64_t max;                   /**< Maximal latency        */
+    uint64_t buckets[LAT_BUCKETS];  /**< Number of samples per bucket */
+};
+
 /** Plugin description */
 IPX_API struct ipx_plugin_info ipx_plugin_info = {
     // Plugin type
@@ -59,8 +81,8 @@ IPX_API struct ipx_plugin_info ipx_plugin_info = {
     .name = "dummy",
     // Brief description of plugin
     .dsc = "Example output plugin.",
-    // Configuration flags (reserved for future use)
-    .flags = 0,
+    // Configuration flags (the plugin is able to process batches of IPFIX messages)
+    .flags = IPX_PF_BATCH,
     // Plugin version string (like "1.2.3")
     .version = "2.2.0",
     // Minimal IPFIXcol version string (like "1.2.3")
@@ -80,6 +102,33 @@ struct instance_data {
     uint64_t cnt_bytes;
     /** Total number of packets in Data Records */
     uint64_t cnt_pkts;
+
+    /** Throughput statistics of the current interval */
+    struct {
+        /** Start of the interval (monotonic clock) */
+        struct timespec start;
+        /** Number of IPFIX Messages                */
+        uint64_t msgs;
+        /** Number of Data Records                  */
+        uint64_t recs;
+        /** Total size of IPFIX Messages (bytes)    */
+        uint64_t bytes;
+    } rate;
+
+    /** Checksum of processed data (prevents the compiler from optimizing out the workload) */
+    uint64_t checksum;
+
+    /** Latency of probes */
+    struct {
+        /** Template of the last checked record */
+        const struct fds_template *tmplt;
+        /** The template contains the time of a probe */
+        bool is_probe;
+        /** Latencies of the current interval   */
+        struct lat_hist interval;
+        /** Latencies since the start           */
+        struct lat_hist total;
+    } latency;
 };
 
 /**
@@ -155,6 +204,213 @@ stats_print(const struct instance_data *inst)
     printf("- total packets:   %10" PRIu64 "\n", inst->cnt_pkts);
 }
 
+/**
+ * @brief Simulate processing of all Data Records of an IPFIX Message
+ *
+ * Based on the configuration, each byte of each record is read (i.e. memory bandwidth cost)
+ * and/or all fields of each record are iterated (i.e. typical cost of parsing).
+ * @param[in] inst Plugin instance
+ * @param[in] msg  IPFIX Message
+ */
+static void
+workload_apply(struct instance_data *inst, ipx_msg_ipfix_t *msg)
+{
+    const bool en_touch = inst->config->en_touch;
+    const bool en_iter = inst->config->en_iter;
+    uint32_t rec_cnt = ipx_msg_ipfix_get_drec_cnt(msg);
+    uint64_t checksum = 0;
+
+    for (uint32_t i = 0; i < rec_cnt; ++i) {
+        struct ipx_ipfix_record *rec_ptr = ipx_msg_ipfix_get_drec(msg, i);
+
+        if (en_touch) {
+            const uint8_t *data = rec_ptr->rec.data;
+            for (uint16_t j = 0; j < rec_ptr->rec.size; ++j) {
+                checksum += data[j];
+            }
+        }
+
+        if (en_iter) {
+            struct fds_drec_iter it;
+            fds_drec_iter_init(&it, &rec_ptr->rec, 0);
+            while (fds_drec_iter_next(&it) != FDS_EOC) {
+                checksum += it.field.size;
+            }
+        }
+    }
+
+    inst->checksum += checksum;
+}
+
+/**
+ * @brief Get the bucket of a latency
+ * @param[in] value Latency [ns]
+ * @return Index of the bucket
+ */
+static unsigned int
+lat_bucket(uint64_t value)
+{
+    if (value < LAT_SUB_CNT) {
+        return (unsigned int) value;
+    }
+
+    // Keep LAT_SUB_BITS most significant bits
+    const unsigned int shift = (63U - (unsigned int) __builtin_clzll(value)) - (LAT_SUB_BITS - 1);
+    return shift * (LAT_SUB_CNT / 2) + (unsigned int) (value >> shift);
+}
+
+/**
+ * @brief Get the middle value of a bucket
+ * @param[in] idx Index of the bucket
+ * @return Latency [ns]
+ */
+static uint64_t
+lat_value(unsigned int idx)
+{
+    if (idx < LAT_SUB_CNT) {
+        return idx;
+    }
+
+    const unsigned int shift = idx / (LAT_SUB_CNT / 2) - 1;
+    const uint64_t base = (uint64_t) (idx - shift * (LAT_SUB_CNT / 2)) << shift;
+    return base + ((1ULL << shift) / 2);
+}
+
+/**
+ * @brief Get a percentile of a histogram
+ * @param[in] hist Histogram
+ * @param[in] pct  Percentile (0..100)
+ * @return Latency [ns]
+ */
+static uint64_t
+lat_percentile(const struct lat_hist *hist, double pct)
+{
+    uint64_t target = (uint64_t) (pct / 100.0 * (double) hist->cnt + 0.5);
+    uint64_t sum = 0;
+
+    if (target == 0) {
+        target = 1;
+    }
+
+    for (unsigned int i = 0; i < LAT_BUCKETS; ++i) {
+        sum += hist->buckets[i];
+        if (sum >= target) {
+            const uint64_t value = lat_value(i);
+            return (value < hist->max) ? value : hist->max;
+        }
+    }
+
+    return hist->max;
+}
+
+/**
+ * @brief Print percentiles of a histogram
+ * @param[in] name Name of the histogram
+ * @param[in] hist Histogram
+ */
+static void
+lat_print(const char *name, const struct lat_hist *hist)
+{
+    if (hist->cnt == 0) {
+        return;
+    }
+
+    printf("%s %8" PRIu64 " probes, p50 %10.1f us, p90 %10.1f us, p99 %10.1f us, "
+        "max %10.1f us\n", name, hist->cnt,
+        lat_percentile(hist, 50.0) / 1e3, lat_percentile(hist, 90.0) / 1e3,
+        lat_percentile(hist, 99.0) / 1e3, hist->max / 1e3);
+}
+
+/**
+ * @brief Find latency probes in an IPFIX Message and add their latency to the histograms
+ *
+ * A probe is a Data Record with the time of sending (see ipfixsend). Its latency is the
+ * difference between the current time and the time of sending. Clocks of the sender and
+ * the collector must be synchronized (ideally, run both on the same host).
+ * @param[in] inst Plugin instance
+ * @param[in] msg  IPFIX Message
+ */
+static void
+latency_update(struct instance_data *inst, ipx_msg_ipfix_t *msg)
+{
+    uint32_t rec_cnt = ipx_msg_ipfix_get_drec_cnt(msg);
+    struct timespec now;
+    bool now_valid = false;
+
+    for (uint32_t i = 0; i < rec_cnt; ++i) {
+        struct ipx_ipfix_record *rec_ptr = ipx_msg_ipfix_get_drec(msg, i);
+        const struct fds_template *tmplt = rec_ptr->rec.tmplt;
+        struct fds_drec_field field;
+        uint64_t sent;
+
+        // Avoid field lookup in regular records
+        if (tmplt != inst->latency.tmplt) {
+            inst->latency.tmplt = tmplt;
+            inst->latency.is_probe = (fds_template_cfind(tmplt, PROBE_PEN, PROBE_ID_TIME) != NULL);
+        }
+
+        if (!inst->latency.is_probe
+                || fds_drec_find(&rec_ptr->rec, PROBE_PEN, PROBE_ID_TIME, &field) == FDS_EOC
+                || fds_get_uint_be(field.data, field.size, &sent) != FDS_OK) {
+            continue;
+        }
+
+        if (!now_valid) {
+            clock_gettime(CLOCK_REALTIME, &now);
+            now_valid = true;
+        }
+
+        const uint64_t recv = (uint64_t) now.tv_sec * 1000000000ULL + (uint64_t) now.tv_nsec;
+        const uint64_t latency = (recv > sent) ? recv - sent : 0;
+        const unsigned int idx = lat_bucket(latency);
+
+        struct lat_hist *hists[] = {&inst->latency.interval, &inst->latency.total};
+        for (size_t h = 0; h < sizeof(hists) / sizeof(hists[0]); ++h) {
+            hists[h]->cnt++;
+            hists[h]->buckets[idx]++;
+            if (latency > hists[h]->max) {
+                hists[h]->max = latency;
+            }
+        }
+    }
+}
+
+/**
+ * @brief Update throughput statistics and print them at the end of each interval
+ * @param[in] inst Plugin instance
+ * @param[in] msg  IPFIX Message
+ */
+static void
+rate_update(struct instance_data *inst, ipx_msg_ipfix_t *msg)
+{
+    const struct fds_ipfix_msg_hdr *hdr = (const struct fds_ipfix_msg_hdr *)
+        ipx_msg_ipfix_get_packet(msg);
+    inst->rate.msgs++;
+    inst->rate.recs += ipx_msg_ipfix_get_drec_cnt(msg);
+    inst->rate.bytes += ntohs(hdr->length);
+
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC_COARSE, &now);
+    const double elapsed = (double) (now.tv_sec - inst->rate.start.tv_sec)
+        + (now.tv_nsec - inst->rate.start.tv_nsec) / 1e9;
+    if (elapsed < (double) inst->config->stats_interval) {
+        return;
+    }
+
+    printf("Rate: %12.0f msg/s, %12.0f rec/s, %10.2f MB/s\n", inst->rate.msgs / elapsed,
+        inst->rate.recs / elapsed, inst->rate.bytes / elapsed / 1e6);
+    if (inst->config->en_latency) {
+        lat_print("Latency:", &inst->latency.interval);
+        memset(&inst->latency.interval, 0, sizeof(inst->latency.interval));
+    }
+    fflush(stdout);
+
+    inst->rate.start = now;
+    inst->rate.msgs = 0;
+    inst->rate.recs = 0;
+    inst->rate.bytes = 0;
+}
+
 int
 ipx_plugin_init(ipx_ctx_t *ctx, const char *params)
 {
@@ -169,6 +425,7 @@ ipx_plugin_init(ipx_ctx_t *ctx, const char *params)
         return IPX_ERR_DENIED;
     }
 
+    clock_gettime(CLOCK_MONOTONIC_COARSE, &data->rate.start);
     ipx_ctx_private_set(ctx, data);
 
     // Subscribe to receive IPFIX messages and Transport Session events
@@ -187,10 +444,61 @@ ipx_plugin_destroy(ipx_ctx_t *ctx, void *cfg)
         stats_print(data);
     }
 
+    if (data->config->en_latency) {
+        lat_print("Latency (total):", &data->latency.total);
+    }
+
+    if (data->config->en_touch || data->config->en_iter) {
+        IPX_CTX_DEBUG(ctx, "Checksum of processed data: %" PRIu64, data->checksum);
+    }
+
     config_destroy(data->config);
     free(data);
 }
 
+/**
+ * @brief Wait for the configured delay between processing of two consecutive messages
+ * @param[in] inst Plugin instance
+ */
+static void
+delay_apply(const struct instance_data *inst)
+{
+    const struct timespec *delay = &inst->config->sleep_time;
+    if (delay->tv_sec != 0 || delay->tv_nsec != 0) {
+        nanosleep(delay, NULL);
+    }
+}
+
+/**
+ * @brief Process an IPFIX message
+ *
+ * @param[in] ctx       Plugin context
+ * @param[in] inst      Plugin instance
+ * @param[in] ipfix_msg IPFIX Message
+ */
+static void
+process_ipfix(ipx_ctx_t *ctx, struct instance_data *inst, ipx_msg_ipfix_t *ipfix_msg)
+{
+    const struct ipx_msg_ctx *ipfix_ctx = ipx_msg_ipfix_get_ctx(ipfix_msg);
+    IPX_CTX_INFO(ctx, "[ODID: %" PRIu32 "] Received an IPFIX message", ipfix_ctx->odid);
+
+    if (inst->config->en_stats) {
+        stats_update(inst, ipfix_msg);
+    }
+
+    if (inst->config->en_latency) {
+        latency_update(inst, ipfix_msg);
+    }
+
+    if (inst->config->en_touch || inst->config->en_iter) {
+        workload_apply(inst, ipfix_msg);
+    }
+
+    if (inst->config->stats_interval > 0) {
+        rate_update(inst, ipfix_msg);
+    }
+}
+
 int
 ipx_plugin_process(ipx_ctx_t *ctx, void *cfg, ipx_msg_t *msg)
 {
@@ -199,13 +507,18 @@ ipx_plugin_process(ipx_ctx_t *ctx, void *cfg, ipx_msg_t *msg)
     int type = ipx_msg_get_type(msg);
     if (type == IPX_MSG_IPFIX) {
         // Process IPFIX message
-        ipx_msg_ipfix_t *ipfix_msg = ipx_msg_base2ipfix(msg);
-        const struct ipx_msg_ctx *ipfix_ctx = ipx_msg_ipfix_get_ctx(ipfix_msg);
-        IPX_CTX_INFO(ctx, "[ODID: %" PRIu32 "] Received an IPFIX message", ipfix_ctx->odid);
+        process_ipfix(ctx, data, ipx_msg_base2ipfix(msg));
+    }
 
-        if (data->config->en_stats) {
-            stats_update(data, ipfix_msg);
+    if (type == IPX_MSG_BATCH) {
+        // Process all IPFIX messages in the batch (the delay is applied to each of them)
+        ipx_msg_batch_t *batch_msg = ipx_msg_base2batch(msg);
+        uint32_t msg_cnt = ipx_msg_batch_get_cnt(batch_msg);
+        for (uint32_t i = 0; i < msg_cnt; ++i) {
+            process_ipfix(ctx, data, ipx_msg_batch_get(batch_msg, i));
+            delay_apply(data);
         }
+        return IPX_OK;
     }
 
     if (type == IPX_MSG_SESSION) {
@@ -217,10 +530,6 @@ ipx_plugin_process(ipx_ctx_t *ctx, void *cfg, ipx_msg_t *msg)
         IPX_CTX_INFO(ctx, "Transport Session '%s' %s", session->ident, status_msg);
     }
 
-    const struct timespec *delay = &data->config->sleep_time;
-    if (delay->tv_sec != 0 || delay->tv_nsec != 0) {
-        nanosleep(delay, NULL);
-    }
-
+    delay_apply(data);
     return IPX_OK;
 }
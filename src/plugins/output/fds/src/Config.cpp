@@ -9,8 +9,10 @@
  */
 
 #include "Config.hpp"
+#include <cassert>
 #include <memory>
 #include <stdexcept>
+#include <strings.h>
 
 /*
  * <params>
@@ -21,6 +23,19 @@
  *     <align>...</align>                 <!-- optional -->
  *   </dumpInterval>
  *   <asyncIO>...</asyncIO>               <!-- optional -->
+ *   <writers>...</writers>               <!-- optional -->
+ *   <shardBy>...</shardBy>               <!-- optional -->
+ *   <index>                              <!-- optional -->
+ *     <enabled>...</enabled>             <!-- optional -->
+ *     <blockSize>...</blockSize>         <!-- optional -->
+ *     <bloomFPP>...</bloomFPP>           <!-- optional -->
+ *   </index>
+ *   <recompress>                         <!-- optional -->
+ *     <enabled>...</enabled>             <!-- optional -->
+ *     <nice>...</nice>                   <!-- optional -->
+ *     <idleIO>...</idleIO>               <!-- optional -->
+ *     <rateLimit>...</rateLimit>         <!-- optional -->
+ *   </recompress>
  * </params>
  */
 
@@ -30,9 +45,22 @@ enum params_xml_nodes {
     NODE_COMPRESS,
     NODE_DUMP,
     NODE_ASYNCIO,
+    NODE_WRITERS,
+    NODE_SHARD,
+    NODE_INDEX,
+    NODE_RECOMPRESS,
 
     DUMP_WINDOW,
-    DUMP_ALIGN
+    DUMP_ALIGN,
+
+    INDEX_ENABLED,
+    INDEX_BLOCK,
+    INDEX_FPP,
+
+    RECOMP_ENABLED,
+    RECOMP_NICE,
+    RECOMP_IDLEIO,
+    RECOMP_RATE
 };
 
 /// Definition of the \<dumpInterval\> node
@@ -42,6 +70,23 @@ static const struct fds_xml_args args_dump[] = {
     FDS_OPTS_END
 };
 
+/// Definition of the \<index\> node
+static const struct fds_xml_args args_index[] = {
+    FDS_OPTS_ELEM(INDEX_ENABLED, "enabled",            FDS_OPTS_T_BOOL,   FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM(INDEX_BLOCK,   "blockSize",          FDS_OPTS_T_UINT,   FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM(INDEX_FPP,     "bloomFPP",           FDS_OPTS_T_DOUBLE, FDS_OPTS_P_OPT),
+    FDS_OPTS_END
+};
+
+/// Definition of the \<recompress\> node
+static const struct fds_xml_args args_recompress[] = {
+    FDS_OPTS_ELEM(RECOMP_ENABLED, "enabled",           FDS_OPTS_T_BOOL,   FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM(RECOMP_NICE,    "nice",              FDS_OPTS_T_INT,    FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM(RECOMP_IDLEIO,  "idleIO",            FDS_OPTS_T_BOOL,   FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM(RECOMP_RATE,    "rateLimit",         FDS_OPTS_T_UINT,   FDS_OPTS_P_OPT),
+    FDS_OPTS_END
+};
+
 /// Definition of the \<params\> node
 static const struct fds_xml_args args_params[] = {
     FDS_OPTS_ROOT("params"),
@@ -49,6 +94,10 @@ static const struct fds_xml_args args_params[] = {
     FDS_OPTS_ELEM(NODE_COMPRESS, "compression",        FDS_OPTS_T_STRING, FDS_OPTS_P_OPT),
     FDS_OPTS_NESTED(NODE_DUMP,   "dumpInterval",       args_dump,         FDS_OPTS_P_OPT),
     FDS_OPTS_ELEM(NODE_ASYNCIO,  "asyncIO",            FDS_OPTS_T_BOOL,   FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM(NODE_WRITERS,  "writers",            FDS_OPTS_T_UINT,   FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM(NODE_SHARD,    "shardBy",            FDS_OPTS_T_STRING, FDS_OPTS_P_OPT),
+    FDS_OPTS_NESTED(NODE_INDEX,  "index",              args_index,        FDS_OPTS_P_OPT),
+    FDS_OPTS_NESTED(NODE_RECOMPRESS, "recompress",     args_recompress,   FDS_OPTS_P_OPT),
     FDS_OPTS_END
 };
 
@@ -90,9 +139,20 @@ Config::set_default()
     m_path.clear();
     m_calg = calg::NONE;
     m_async = true;
+    m_writers = 1;
+    m_shard = shard::SESSION;
 
     m_window.align = true;
     m_window.size = WINDOW_SIZE;
+
+    m_index.enabled = false;
+    m_index.block = INDEX_BLOCK;
+    m_index.fpp = 0.01;
+
+    m_recompress.enabled = false;
+    m_recompress.nice = RECOMPRESS_NICE;
+    m_recompress.idle_io = true;
+    m_recompress.rate = 0;
 }
 
 /**
@@ -109,6 +169,28 @@ Config::validate()
     if (m_window.size == 0) {
         throw std::runtime_error("Window size cannot be zero!");
     }
+
+    if (m_writers == 0 || m_writers > WRITERS_MAX) {
+        throw std::runtime_error("Number of writers must be between 1 and "
+            + std::to_string(WRITERS_MAX) + "!");
+    }
+
+    if (m_index.block == 0) {
+        throw std::runtime_error("Block size of indexes cannot be zero!");
+    }
+
+    if (!(m_index.fpp > 0.0 && m_index.fpp < 1.0)) {
+        throw std::runtime_error("False positive probability of indexes must be in range (0, 1)!");
+    }
+
+    if (m_recompress.enabled && m_calg == calg::ZSTD) {
+        throw std::runtime_error("Recompression is useless if files are already ZSTD compressed!");
+    }
+
+    if (m_recompress.enabled && m_index.enabled) {
+        // Records might be reordered by the recompression, i.e. blocks of indexes would not match
+        throw std::runtime_error("Recompression cannot be combined with secondary indexes!");
+    }
 }
 
 /**
@@ -146,11 +228,41 @@ Config::parse_root(fds_xml_ctx_t *ctx)
             assert(content->type == FDS_OPTS_T_BOOL);
             m_async = content->val_bool;
             break;
+        case NODE_WRITERS:
+            // Number of writers
+            assert(content->type == FDS_OPTS_T_UINT);
+            if (content->val_uint > WRITERS_MAX) {
+                throw std::runtime_error("Number of writers is too big!");
+            }
+            m_writers = static_cast<uint32_t>(content->val_uint);
+            break;
+        case NODE_SHARD:
+            // Distribution of records among writers
+            assert(content->type == FDS_OPTS_T_STRING);
+            if (strcasecmp(content->ptr_string, "session") == 0) {
+                m_shard = shard::SESSION;
+            } else if (strcasecmp(content->ptr_string, "odid") == 0) {
+                m_shard = shard::ODID;
+            } else {
+                const std::string inv_str = content->ptr_string;
+                throw std::runtime_error("Unknown sharding method '" + inv_str + "'");
+            }
+            break;
         case NODE_DUMP:
             // Dump window
             assert(content->type == FDS_OPTS_T_CONTEXT);
             parse_dump(content->ptr_ctx);
             break;
+        case NODE_INDEX:
+            // Secondary indexes
+            assert(content->type == FDS_OPTS_T_CONTEXT);
+            parse_index(content->ptr_ctx);
+            break;
+        case NODE_RECOMPRESS:
+            // Background recompression
+            assert(content->type == FDS_OPTS_T_CONTEXT);
+            parse_recompress(content->ptr_ctx);
+            break;
         default:
             // Internal error
             throw std::runtime_error("Unknown XML node");
@@ -187,4 +299,81 @@ Config::parse_dump(fds_xml_ctx_t *ctx)
             throw std::runtime_error("Unknown XML node");
         }
     }
-}
\ No newline at end of file
+}
+
+/**
+ * @brief Auxiliary function for parsing \<index\> options
+ * @param[in] ctx XML context to process
+ * @throw runtime_error if the parser fails
+ */
+void
+Config::parse_index(fds_xml_ctx_t *ctx)
+{
+    const struct fds_xml_cont *content;
+    while(fds_xml_next(ctx, &content) != FDS_EOC) {
+        switch (content->id) {
+        case INDEX_ENABLED:
+            // Enable/disable indexes
+            assert(content->type == FDS_OPTS_T_BOOL);
+            m_index.enabled = content->val_bool;
+            break;
+        case INDEX_BLOCK:
+            // Records per block
+            assert(content->type == FDS_OPTS_T_UINT);
+            if (content->val_uint > INDEX_BLOCK_MAX) {
+                throw std::runtime_error("Block size of indexes is too big!");
+            }
+            m_index.block = static_cast<uint32_t>(content->val_uint);
+            break;
+        case INDEX_FPP:
+            // False positive probability
+            assert(content->type == FDS_OPTS_T_DOUBLE);
+            m_index.fpp = content->val_double;
+            break;
+        default:
+            // Internal error
+            throw std::runtime_error("Unknown XML node");
+        }
+    }
+}
+
+/**
+ * @brief Auxiliary function for parsing \<recompress\> options
+ * @param[in] ctx XML context to process
+ * @throw runtime_error if the parser fails
+ */
+void
+Config::parse_recompress(fds_xml_ctx_t *ctx)
+{
+    const struct fds_xml_cont *content;
+    while(fds_xml_next(ctx, &content) != FDS_EOC) {
+        switch (content->id) {
+        case RECOMP_ENABLED:
+            // Enable/disable recompression
+            assert(content->type == FDS_OPTS_T_BOOL);
+            m_recompress.enabled = content->val_bool;
+            break;
+        case RECOMP_NICE:
+            // Nice value of the thread
+            assert(content->type == FDS_OPTS_T_INT);
+            if (content->val_int < 0 || content->val_int > 19) {
+                throw std::runtime_error("Nice value of recompression must be between 0 and 19!");
+            }
+            m_recompress.nice = static_cast<int>(content->val_int);
+            break;
+        case RECOMP_IDLEIO:
+            // Idle I/O scheduling class
+            assert(content->type == FDS_OPTS_T_BOOL);
+            m_recompress.idle_io = content->val_bool;
+            break;
+        case RECOMP_RATE:
+            // Rate limit
+            assert(content->type == FDS_OPTS_T_UINT);
+            m_recompress.rate = content->val_uint;
+            break;
+        default:
+            // Internal error
+            throw std::runtime_error("Unknown XML node");
+        }
+    }
+}
@@ -33,21 +33,51 @@ public:
         ZSTD  ///< ZSTD compression
     };
 
+    enum class shard {
+        SESSION, ///< Records of a Transport Session are stored by the same writer
+        ODID     ///< Records of an ODID are stored by the same writer
+    };
+
     /// Storage path
     std::string m_path;
     /// Compression algorithm
     calg m_calg;
     /// Asynchronous I/O enabled
     bool m_async;
+    /// Number of writers (i.e. output files per window)
+    uint32_t m_writers;
+    /// Distribution of records among writers
+    shard m_shard;
 
     struct {
         bool     align;   ///< Enable/disable window alignment
         uint32_t size;    ///< Time window size
     } m_window;   ///< Window alignment
 
+    struct {
+        bool     enabled; ///< Enable/disable secondary indexes
+        uint32_t block;   ///< Number of records per block of an index
+        double   fpp;     ///< False positive probability of Bloom filters
+    } m_index;    ///< Secondary indexes
+
+    struct {
+        bool     enabled; ///< Enable/disable recompression of closed files
+        int      nice;    ///< Nice value of the recompression thread
+        bool     idle_io; ///< Use the idle I/O scheduling class
+        uint64_t rate;    ///< Maximum bytes of Data Records per second (0 == unlimited)
+    } m_recompress; ///< Background recompression of closed files
+
 private:
     /// Default window size
     static const uint32_t WINDOW_SIZE = 300U;
+    /// Maximum number of writers
+    static const uint32_t WRITERS_MAX = 64U;
+    /// Default number of records per block of an index
+    static const uint32_t INDEX_BLOCK = 65536U;
+    /// Maximum number of records per block of an index
+    static const uint32_t INDEX_BLOCK_MAX = 16777216U;
+    /// Default nice value of the recompression thread
+    static const int RECOMPRESS_NICE = 19;
 
     void
     set_default();
@@ -58,6 +88,10 @@ private:
     parse_root(fds_xml_ctx_t *ctx);
     void
     parse_dump(fds_xml_ctx_t *ctx);
+    void
+    parse_index(fds_xml_ctx_t *ctx);
+    void
+    parse_recompress(fds_xml_ctx_t *ctx);
 };
 
 
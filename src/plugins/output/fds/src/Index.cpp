@@ -0,0 +1,303 @@
+/**
+ * \file src/plugins/output/fds/src/Index.cpp
+ * \author agent <agent@local>
+ * \brief Secondary index of an FDS file (source file)
+ * \date 2026
+ *
+ * Copyright(c) 2026 CESNET z.s.p.o.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include <algorithm>
+#include <cassert>
+#include <cerrno>
+#include <cmath>
+#include <cstring>
+#include <endian.h>
+#include <arpa/inet.h>
+#include "Index.hpp"
+
+/// Suffix of files that are being written
+static const std::string TMP_SUFFIX = ".tmp";
+/// Magic bytes of the file
+static const char INDEX_MAGIC[4] = {'F', 'D', 'S', 'I'};
+/// Version of the file format
+static const uint16_t INDEX_VERSION = 1;
+/// Size of a port bitmap (bytes)
+static const size_t PORTS_SIZE = 65536U / 8U;
+
+/// IANA identifiers of indexed Information Elements
+enum index_ie : uint16_t {
+    IE_SRC_PORT = 7,
+    IE_SRC_IP4 = 8,
+    IE_DST_PORT = 11,
+    IE_DST_IP4 = 12,
+    IE_SRC_IP6 = 27,
+    IE_DST_IP6 = 28,
+    IE_START_SEC = 150,
+    IE_END_SEC = 151,
+    IE_START_MSEC = 152,
+    IE_END_MSEC = 153,
+    IE_START_USEC = 154,
+    IE_END_USEC = 155,
+    IE_START_NSEC = 156,
+    IE_END_NSEC = 157
+};
+
+/**
+ * @brief Set a bit of a bitmap
+ * @param[in] bitmap Bitmap
+ * @param[in] idx    Index of the bit
+ */
+static inline void
+bit_set(std::vector<uint8_t> &bitmap, uint32_t idx)
+{
+    bitmap[idx / 8U] |= static_cast<uint8_t>(0x80U >> (idx % 8U));
+}
+
+Index::Index(uint32_t block_size, double fpp) : m_block_size(block_size)
+{
+    assert(block_size > 0 && "Block size must be positive");
+    assert(fpp > 0.0 && fpp < 1.0 && "Invalid false positive probability");
+
+    // Optimal parameters of the Bloom filter (each record has up to 2 addresses)
+    const double items = 2.0 * block_size;
+    const double bits = std::ceil(-items * std::log(fpp) / (M_LN2 * M_LN2));
+    const double bits_max = static_cast<double>(UINT32_MAX - 7U);
+    m_bits = static_cast<uint32_t>(std::min(bits, bits_max) + 7U) & ~UINT32_C(7);
+    m_hashes = std::max<uint32_t>(1U, static_cast<uint32_t>(std::lround(m_bits / items * M_LN2)));
+
+    m_bloom.resize(m_bits / 8U);
+    m_sports.resize(PORTS_SIZE);
+    m_dports.resize(PORTS_SIZE);
+    block_clear();
+}
+
+Index::~Index()
+{
+    // Only delete an incomplete file
+    if (m_file) {
+        m_file.reset();
+        std::remove(m_file_name.c_str());
+    }
+}
+
+void
+Index::open(const std::string &path)
+{
+    assert(!m_file && "The file is already opened");
+    const std::string file_name = path + TMP_SUFFIX;
+
+    std::unique_ptr<FILE, decltype(&fclose)> file(fopen(file_name.c_str(), "wb"), &fclose);
+    if (!file) {
+        throw FDS_exception("Failed to create index file '" + file_name + "': "
+            + std::string(strerror(errno)));
+    }
+
+    // Header
+    uint8_t hdr[20];
+    const uint16_t version = htons(INDEX_VERSION);
+    const uint32_t params[] = {htonl(m_block_size), htonl(m_bits), htonl(m_hashes)};
+    memcpy(&hdr[0], INDEX_MAGIC, sizeof(INDEX_MAGIC));
+    memcpy(&hdr[4], &version, sizeof(version));
+    memset(&hdr[6], 0, 2U);
+    memcpy(&hdr[8], params, sizeof(params));
+
+    if (fwrite(hdr, sizeof(hdr), 1, file.get()) != 1) {
+        file.reset();
+        std::remove(file_name.c_str());
+        throw FDS_exception("Failed to write index file '" + file_name + "'");
+    }
+
+    m_file = std::move(file);
+    m_file_name = file_name;
+    block_clear();
+}
+
+void
+Index::close()
+{
+    if (!m_file) {
+        return;
+    }
+
+    std::string err_msg;
+    try {
+        if (m_records > 0) {
+            block_write();
+        }
+    } catch (const FDS_exception &ex) {
+        err_msg = ex.what();
+    }
+
+    if (fclose(m_file.release()) != 0 && err_msg.empty()) {
+        err_msg = "Failed to close index file '" + m_file_name + "'";
+    }
+
+    const std::string new_file_name(m_file_name, 0, m_file_name.size() - TMP_SUFFIX.size());
+    if (!err_msg.empty()) {
+        // Incomplete index would make readers skip matching records
+        std::remove(m_file_name.c_str());
+    } else if (std::rename(m_file_name.c_str(), new_file_name.c_str()) != 0) {
+        err_msg = "Failed to rename index file '" + m_file_name + "'";
+    }
+    m_file_name.clear();
+
+    if (!err_msg.empty()) {
+        throw FDS_exception(err_msg);
+    }
+}
+
+void
+Index::add(struct fds_drec &rec)
+{
+    struct fds_drec_iter iter;
+    fds_drec_iter_init(&iter, &rec, 0);
+
+    // All indexed fields are defined by IANA (i.e. reverse fields are ignored)
+    while (fds_drec_iter_next(&iter) != FDS_EOC) {
+        const struct fds_drec_field &field = iter.field;
+        if (field.info->en != 0) {
+            continue;
+        }
+
+        uint64_t port;
+        switch (field.info->id) {
+        case IE_SRC_PORT:
+        case IE_DST_PORT:
+            if (fds_get_uint_be(field.data, field.size, &port) != FDS_OK || port > UINT16_MAX) {
+                break;
+            }
+            bit_set((field.info->id == IE_SRC_PORT) ? m_sports : m_dports,
+                static_cast<uint32_t>(port));
+            break;
+        case IE_SRC_IP4:
+        case IE_DST_IP4:
+        case IE_SRC_IP6:
+        case IE_DST_IP6:
+            addr_add(field.data, field.size);
+            break;
+        case IE_START_SEC:
+        case IE_END_SEC:
+            time_add(field, FDS_ET_DATE_TIME_SECONDS);
+            break;
+        case IE_START_MSEC:
+        case IE_END_MSEC:
+            time_add(field, FDS_ET_DATE_TIME_MILLISECONDS);
+            break;
+        case IE_START_USEC:
+        case IE_END_USEC:
+            time_add(field, FDS_ET_DATE_TIME_MICROSECONDS);
+            break;
+        case IE_START_NSEC:
+        case IE_END_NSEC:
+            time_add(field, FDS_ET_DATE_TIME_NANOSECONDS);
+            break;
+        default:
+            break;
+        }
+    }
+
+    if (++m_records == m_block_size) {
+        block_write();
+    }
+}
+
+uint64_t
+Index::hash(const uint8_t addr[16])
+{
+    // FNV-1a
+    uint64_t value = UINT64_C(14695981039346656037);
+    for (size_t i = 0; i < 16U; ++i) {
+        value ^= addr[i];
+        value *= UINT64_C(1099511628211);
+    }
+
+    return value;
+}
+
+/**
+ * @brief Add an IP address to the Bloom filter of the current block
+ * @param[in] data Address
+ * @param[in] size Size of the address (addresses of invalid size are ignored)
+ */
+void
+Index::addr_add(const uint8_t *data, uint16_t size)
+{
+    uint8_t addr[16];
+    if (size == 4U) {
+        // IPv4-mapped IPv6 address
+        memset(addr, 0, 10U);
+        addr[10] = addr[11] = 0xFF;
+        memcpy(&addr[12], data, 4U);
+    } else if (size == 16U) {
+        memcpy(addr, data, 16U);
+    } else {
+        return;
+    }
+
+    const uint64_t value = hash(addr);
+    const uint32_t lo = static_cast<uint32_t>(value);
+    const uint32_t hi = static_cast<uint32_t>(value >> 32);
+    for (uint32_t i = 0; i < m_hashes; ++i) {
+        bit_set(m_bloom, static_cast<uint32_t>((lo + static_cast<uint64_t>(i) * hi) % m_bits));
+    }
+}
+
+/**
+ * @brief Extend the time range of the current block by a timestamp
+ * @param[in] field Field with the timestamp
+ * @param[in] type  Data type of the timestamp
+ */
+void
+Index::time_add(const struct fds_drec_field &field, enum fds_iemgr_element_type type)
+{
+    uint64_t ts;
+    if (fds_get_datetime_lp_be(field.data, field.size, type, &ts) != FDS_OK) {
+        return;
+    }
+
+    m_time_min = std::min(m_time_min, ts);
+    m_time_max = std::max(m_time_max, ts);
+}
+
+/**
+ * @brief Clear the current block
+ */
+void
+Index::block_clear()
+{
+    m_records = 0;
+    m_time_min = UINT64_MAX;
+    m_time_max = 0;
+    std::fill(m_bloom.begin(), m_bloom.end(), 0);
+    std::fill(m_sports.begin(), m_sports.end(), 0);
+    std::fill(m_dports.begin(), m_dports.end(), 0);
+}
+
+/**
+ * @brief Write the current block to the file and clear it
+ * @throw FDS_exception if the block cannot be written
+ */
+void
+Index::block_write()
+{
+    assert(m_file && "The file must be opened");
+
+    uint8_t hdr[24];
+    const uint32_t records = htonl(m_records);
+    const uint64_t times[] = {htobe64(m_time_min), htobe64(m_time_max)};
+    memcpy(&hdr[0], &records, sizeof(records));
+    memset(&hdr[4], 0, 4U);
+    memcpy(&hdr[8], times, sizeof(times));
+
+    FILE *file = m_file.get();
+    if (fwrite(hdr, sizeof(hdr), 1, file) != 1
+            || fwrite(m_bloom.data(), m_bloom.size(), 1, file) != 1
+            || fwrite(m_sports.data(), m_sports.size(), 1, file) != 1
+            || fwrite(m_dports.data(), m_dports.size(), 1, file) != 1) {
+        throw FDS_exception("Failed to write index file '" + m_file_name + "'");
+    }
+
+    block_clear();
+}
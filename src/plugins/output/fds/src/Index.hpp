@@ -0,0 +1,131 @@
+/**
+ * \file src/plugins/output/fds/src/Index.hpp
+ * \author agent <agent@local>
+ * \brief Secondary index of an FDS file (header file)
+ * \date 2026
+ *
+ * Copyright(c) 2026 CESNET z.s.p.o.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef IPFIXCOL2_FDS_INDEX_HPP
+#define IPFIXCOL2_FDS_INDEX_HPP
+
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+#include <libfds.h>
+
+#include "Exception.hpp"
+
+/**
+ * @brief Secondary index of an FDS file
+ *
+ * Data Records of the file are split into blocks of consecutive records (in the order in which
+ * they are written into the file). For each block, the index contains the range of flow
+ * timestamps, a Bloom filter of source and destination IP addresses and bitmaps of source and
+ * destination ports. Therefore, a reader can skip blocks (or whole files) that cannot contain
+ * matching records.
+ *
+ * The index is written into a sidecar file, which is created with a temporary suffix and
+ * renamed after it's closed. Blocks are written as soon as they are full.
+ *
+ * Format of the file (all numbers are in network byte order):
+ * - Header: magic "FDSI", version (uint16), reserved (uint16), records per block (uint32),
+ *   size of the Bloom filter in bits (uint32), number of hash functions (uint32)
+ * - Blocks: number of records (uint32), reserved (uint32), the minimal and the maximal flow
+ *   timestamp in milliseconds (uint64 each, UINT64_MAX and 0 if unknown), the Bloom filter
+ *   and bitmaps of source and destination ports (65536 bits each)
+ *
+ * Bit N of a bitmap (or the Bloom filter) is the bit (0x80 >> (N % 8)) of the byte N / 8.
+ */
+class Index {
+public:
+    /**
+     * @brief Create an index
+     * @param[in] block_size Number of records per block
+     * @param[in] fpp        False positive probability of the Bloom filter (0 < fpp < 1)
+     */
+    Index(uint32_t block_size, double fpp);
+    ~Index();
+
+    // Disable copy constructors
+    Index(const Index &other) = delete;
+    Index &operator=(const Index &other) = delete;
+
+    /**
+     * @brief Open a new index file
+     * @note A previously opened file must be closed.
+     * @param[in] path Path of the file
+     * @throw FDS_exception if the file cannot be created
+     */
+    void
+    open(const std::string &path);
+
+    /**
+     * @brief Write the last block and close the file (if opened)
+     * @throw FDS_exception if the file cannot be written (the file is closed anyway)
+     */
+    void
+    close();
+
+    /**
+     * @brief Add a Data Record to the index
+     * @param[in] rec Data Record
+     * @throw FDS_exception if a full block cannot be written
+     */
+    void
+    add(struct fds_drec &rec);
+
+    /**
+     * @brief Hash an IP address for the Bloom filter
+     *
+     * IPv4 addresses are hashed as IPv4-mapped IPv6 addresses, therefore, readers can always
+     * hash 16 bytes. Positions of bits are derived from the 64-bit FNV-1a hash of the address
+     * as (lo + i * hi) % bits for i = 0, ..., hashes - 1, where lo and hi are the lower and
+     * higher 32 bits of the hash.
+     * @param[in] addr IPv6 (or IPv4-mapped) address
+     * @return Hash
+     */
+    static uint64_t
+    hash(const uint8_t addr[16]);
+
+private:
+    /// Number of records per block
+    uint32_t m_block_size;
+    /// Size of the Bloom filter (bits)
+    uint32_t m_bits;
+    /// Number of hash functions of the Bloom filter
+    uint32_t m_hashes;
+
+    /// Output file (nullptr == closed)
+    std::unique_ptr<FILE, decltype(&fclose)> m_file = {nullptr, &fclose};
+    /// Output file name (with the temporary suffix)
+    std::string m_file_name;
+
+    /// Number of records in the current block
+    uint32_t m_records;
+    /// The minimal flow timestamp of the current block (milliseconds)
+    uint64_t m_time_min;
+    /// The maximal flow timestamp of the current block (milliseconds)
+    uint64_t m_time_max;
+    /// Bloom filter of the current block
+    std::vector<uint8_t> m_bloom;
+    /// Bitmap of source ports of the current block
+    std::vector<uint8_t> m_sports;
+    /// Bitmap of destination ports of the current block
+    std::vector<uint8_t> m_dports;
+
+    void
+    block_clear();
+    void
+    block_write();
+    void
+    addr_add(const uint8_t *data, uint16_t size);
+    void
+    time_add(const struct fds_drec_field &field, enum fds_iemgr_element_type type);
+};
+
+#endif // IPFIXCOL2_FDS_INDEX_HPP
@@ -0,0 +1,284 @@
+/**
+ * \file src/plugins/output/fds/src/Recompressor.cpp
+ * \author agent <agent@local>
+ * \brief Background recompression of closed FDS files (source file)
+ * \date 2026
+ *
+ * Copyright(c) 2026 CESNET z.s.p.o.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <system_error>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include "Recompressor.hpp"
+
+/// Suffix of files that are being recompressed
+static const std::string TMP_SUFFIX = ".zstd.tmp";
+/// Number of Data Records between checks of the rate limit and stop requests
+static const uint32_t CHECK_RECS = 1024U;
+
+// I/O priorities (see ioprio_set(2), not exported by glibc)
+#define IOPRIO_WHO_PROCESS  1
+#define IOPRIO_CLASS_IDLE   3
+#define IOPRIO_CLASS_SHIFT  13
+
+Recompressor::Recompressor(ipx_ctx_t *ctx, int nice, bool idle_io, uint64_t rate)
+    : m_ctx(ctx), m_nice(nice), m_idle_io(idle_io), m_rate(rate)
+{
+    try {
+        m_thread = std::thread(&Recompressor::thread_main, this);
+    } catch (const std::system_error &ex) {
+        throw FDS_exception("Failed to start a recompression thread: " + std::string(ex.what()));
+    }
+}
+
+Recompressor::~Recompressor()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_cv.notify_one();
+    m_thread.join();
+
+    if (!m_queue.empty()) {
+        IPX_CTX_INFO(m_ctx, "%zu file(s) left without recompression.", m_queue.size());
+    }
+}
+
+void
+Recompressor::add(const std::string &path)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_queue.push_back(path);
+    }
+    m_cv.notify_one();
+}
+
+/**
+ * @brief Main function of the thread
+ */
+void
+Recompressor::thread_main()
+{
+    priority_set();
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (true) {
+        m_cv.wait(lock, [this]() {return m_stop || !m_queue.empty();});
+        if (m_stop) {
+            break;
+        }
+
+        const std::string path = m_queue.front();
+        m_queue.pop_front();
+        lock.unlock();
+        recompress(path);
+        lock.lock();
+    }
+}
+
+/**
+ * @brief Lower CPU and I/O priority of the thread (called by the thread)
+ *
+ * On Linux, both priorities are properties of the thread, therefore, other threads of the
+ * collector are not affected. Failures are not fatal.
+ */
+void
+Recompressor::priority_set()
+{
+    const pid_t tid = static_cast<pid_t>(syscall(SYS_gettid));
+
+    if (m_nice != 0 && setpriority(PRIO_PROCESS, static_cast<id_t>(tid), m_nice) != 0) {
+        const char *err_str;
+        ipx_strerror(errno, err_str);
+        IPX_CTX_WARNING(m_ctx, "Failed to set nice value of the recompression thread: %s",
+            err_str);
+    }
+
+    const int ioprio = IOPRIO_CLASS_IDLE << IOPRIO_CLASS_SHIFT;
+    if (m_idle_io && syscall(SYS_ioprio_set, IOPRIO_WHO_PROCESS, tid, ioprio) != 0) {
+        const char *err_str;
+        ipx_strerror(errno, err_str);
+        IPX_CTX_WARNING(m_ctx, "Failed to set I/O priority of the recompression thread: %s",
+            err_str);
+    }
+}
+
+/**
+ * @brief Recompress a file and replace the original one (called by the thread)
+ * @param[in] path Path of the file
+ */
+void
+Recompressor::recompress(const std::string &path)
+{
+    const std::string tmp_name = path + TMP_SUFFIX;
+    using file_ptr = std::unique_ptr<fds_file_t, decltype(&fds_file_close)>;
+    file_ptr src(fds_file_init(), &fds_file_close);
+    file_ptr dst(fds_file_init(), &fds_file_close);
+
+    try {
+        if (!src || !dst) {
+            throw FDS_exception("Failed to create FDS file handler!");
+        }
+
+        if (fds_file_open(src.get(), path.c_str(), FDS_FILE_READ | FDS_FILE_NOASYNC) != FDS_OK) {
+            throw FDS_exception("Failed to open the file: "
+                + std::string(fds_file_error(src.get())));
+        }
+
+        const uint32_t flags = FDS_FILE_WRITE | FDS_FILE_ZSTD | FDS_FILE_NOASYNC;
+        if (fds_file_open(dst.get(), tmp_name.c_str(), flags) != FDS_OK) {
+            throw FDS_exception("Failed to create file '" + tmp_name + "': "
+                + std::string(fds_file_error(dst.get())));
+        }
+
+        copy(src.get(), dst.get());
+
+        // Remaining records are written when the file is closed
+        src.reset();
+        dst.reset();
+        if (std::rename(tmp_name.c_str(), path.c_str()) != 0) {
+            throw FDS_exception("Failed to rename file '" + tmp_name + "'");
+        }
+    } catch (const FDS_exception &ex) {
+        dst.reset();
+        std::remove(tmp_name.c_str());
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_stop) {
+            IPX_CTX_ERROR(m_ctx, "Failed to recompress file '%s': %s", path.c_str(), ex.what());
+        }
+        return;
+    }
+
+    IPX_CTX_DEBUG(m_ctx, "File '%s' has been recompressed.", path.c_str());
+}
+
+/**
+ * @brief Copy content of a file to another one (called by the thread)
+ *
+ * Transport Sessions are defined before their first Data Record and Templates are (re)defined
+ * whenever a Data Record refers to a Template that is not defined in the output file yet or
+ * its definition differs.
+ * @param[in] src Input file
+ * @param[in] dst Output file
+ * @throw FDS_exception if a read or write fails or the thread should stop
+ */
+void
+Recompressor::copy(fds_file_t *src, fds_file_t *dst)
+{
+    std::map<fds_file_sid_t, fds_file_sid_t> sids;
+    struct fds_file_read_ctx last_ctx = {0, 0, 0};
+    bool last_valid = false;
+    const struct fds_template *last_tmplt = nullptr;
+
+    struct fds_drec rec;
+    struct fds_file_read_ctx rec_ctx;
+    uint64_t bytes = 0;
+    uint32_t recs = 0;
+    int rc;
+
+    m_period = std::chrono::steady_clock::now();
+    m_period_bytes = 0;
+
+    while ((rc = fds_file_read_rec(src, &rec, &rec_ctx)) == FDS_OK) {
+        if (!last_valid || rec_ctx.sid != last_ctx.sid || rec_ctx.odid != last_ctx.odid
+                || rec_ctx.exp_time != last_ctx.exp_time) {
+            auto sid_it = sids.find(rec_ctx.sid);
+            if (sid_it == sids.end()) {
+                const struct fds_file_session *desc;
+                fds_file_sid_t sid;
+                if (fds_file_session_get(src, rec_ctx.sid, &desc) != FDS_OK
+                        || fds_file_session_add(dst, desc, &sid) != FDS_OK) {
+                    throw FDS_exception("Failed to copy a Transport Session: "
+                        + std::string(fds_file_error(dst)));
+                }
+                sid_it = sids.emplace(rec_ctx.sid, sid).first;
+            }
+
+            if (fds_file_write_ctx(dst, sid_it->second, rec_ctx.odid, rec_ctx.exp_time) != FDS_OK) {
+                throw FDS_exception("Failed to configure the writer: "
+                    + std::string(fds_file_error(dst)));
+            }
+
+            last_ctx = rec_ctx;
+            last_valid = true;
+            last_tmplt = nullptr;
+        }
+
+        if (rec.tmplt != last_tmplt) {
+            // Define the Template only if it's missing or different in the output file
+            const struct fds_template *tmplt = rec.tmplt;
+            enum fds_template_type type;
+            const uint8_t *data;
+            uint16_t size;
+            rc = fds_file_write_tmplt_get(dst, tmplt->id, &type, &data, &size);
+            if (rc != FDS_OK || type != tmplt->type || size != tmplt->raw.length
+                    || memcmp(data, tmplt->raw.data, size) != 0) {
+                rc = fds_file_write_tmplt_add(dst, tmplt->type, tmplt->raw.data,
+                    tmplt->raw.length);
+                if (rc != FDS_OK) {
+                    throw FDS_exception("fds_file_write_tmplt_add() failed: "
+                        + std::string(fds_file_error(dst)));
+                }
+            }
+            last_tmplt = tmplt;
+        }
+
+        if (fds_file_write_rec(dst, rec.tmplt->id, rec.data, rec.size) != FDS_OK) {
+            throw FDS_exception("Failed to add a Data Record: " + std::string(fds_file_error(dst)));
+        }
+
+        bytes += rec.size;
+        if (++recs == CHECK_RECS) {
+            if (!throttle(bytes)) {
+                throw FDS_exception("Interrupted");
+            }
+            bytes = 0;
+            recs = 0;
+        }
+    }
+
+    if (rc != FDS_EOC) {
+        throw FDS_exception("Failed to read a Data Record: " + std::string(fds_file_error(src)));
+    }
+}
+
+/**
+ * @brief Account processed data and sleep if the rate limit has been exceeded
+ * @param[in] bytes Size of Data Records processed since the previous call
+ * @return False if the thread should stop, true otherwise
+ */
+bool
+Recompressor::throttle(uint64_t bytes)
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    if (m_rate == 0 || m_stop) {
+        return !m_stop;
+    }
+
+    m_period_bytes += bytes;
+    const auto now = std::chrono::steady_clock::now();
+    const std::chrono::microseconds expected(m_period_bytes * 1000000U / m_rate);
+    const auto deadline = m_period + expected;
+    if (deadline <= now) {
+        if (now - deadline > std::chrono::seconds(1)) {
+            // Do not compensate a long period without processing (e.g. slow reads) by a burst
+            m_period = now;
+            m_period_bytes = 0;
+        }
+        return true;
+    }
+
+    m_cv.wait_until(lock, deadline, [this]() {return m_stop;});
+    return !m_stop;
+}
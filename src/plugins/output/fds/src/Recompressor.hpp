@@ -0,0 +1,105 @@
+/**
+ * \file src/plugins/output/fds/src/Recompressor.hpp
+ * \author agent <agent@local>
+ * \brief Background recompression of closed FDS files (header file)
+ * \date 2026
+ *
+ * Copyright(c) 2026 CESNET z.s.p.o.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef IPFIXCOL2_FDS_RECOMPRESSOR_HPP
+#define IPFIXCOL2_FDS_RECOMPRESSOR_HPP
+
+#include <ipfixcol2.h>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <libfds.h>
+
+#include "Exception.hpp"
+
+/**
+ * @brief Low-priority recompression of closed files
+ *
+ * Files are written with fast compression (usually LZ4) to keep up with the incoming flows.
+ * Once a file is closed, it is passed to the recompressor, which rewrites all its Transport
+ * Sessions, Templates and Data Records into a new ZSTD compressed file by a background thread.
+ * The new file is created with a temporary suffix and atomically renamed over the original file
+ * after it's successfully closed, therefore, readers always see a complete file.
+ *
+ * The thread lowers its own CPU priority (nice) and can use the idle I/O scheduling class, so it
+ * runs only when the system is otherwise idle. The amount of processed data per second can be
+ * limited too.
+ *
+ * @note Files that are still queued when the recompressor is destroyed are left untouched.
+ * @note Errors are reported to the log and the original file is preserved.
+ */
+class Recompressor {
+public:
+    /**
+     * @brief Create a recompressor and start its thread
+     * @param[in] ctx     Plugin context (only for log)
+     * @param[in] nice    Nice value of the thread (0 == do not change)
+     * @param[in] idle_io Use the idle I/O scheduling class
+     * @param[in] rate    Maximum number of bytes of Data Records per second (0 == unlimited)
+     * @throw FDS_exception if the thread cannot be started
+     */
+    Recompressor(ipx_ctx_t *ctx, int nice, bool idle_io, uint64_t rate);
+    ~Recompressor();
+
+    // Disable copy constructors
+    Recompressor(const Recompressor &other) = delete;
+    Recompressor &operator=(const Recompressor &other) = delete;
+
+    /**
+     * @brief Add a closed file to the queue
+     * @note The function is thread-safe (i.e. it can be called by threads of writers).
+     * @param[in] path Path of the file
+     */
+    void
+    add(const std::string &path);
+
+private:
+    /// Plugin context only for logging!
+    ipx_ctx_t *m_ctx;
+    /// Nice value of the thread
+    int m_nice;
+    /// Use the idle I/O scheduling class
+    bool m_idle_io;
+    /// Maximum number of bytes of Data Records per second (0 == unlimited)
+    uint64_t m_rate;
+
+    /// Thread
+    std::thread m_thread;
+    /// Synchronization of the thread
+    std::mutex m_mutex;
+    /// Notification about a new file or a stop request
+    std::condition_variable m_cv;
+    /// Files to recompress
+    std::deque<std::string> m_queue;
+    /// Request to stop the thread
+    bool m_stop = false;
+
+    /// Start of the current throttling period
+    std::chrono::steady_clock::time_point m_period;
+    /// Bytes processed in the current throttling period
+    uint64_t m_period_bytes = 0;
+
+    void
+    thread_main();
+    void
+    priority_set();
+    void
+    recompress(const std::string &path);
+    void
+    copy(fds_file_t *src, fds_file_t *dst);
+    bool
+    throttle(uint64_t bytes);
+};
+
+#endif // IPFIXCOL2_FDS_RECOMPRESSOR_HPP
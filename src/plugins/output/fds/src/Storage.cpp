@@ -17,9 +17,8 @@
 #include <libgen.h>
 #include "Storage.hpp"
 
-const std::string TMP_SUFFIX = ".tmp";
-
-Storage::Storage(ipx_ctx_t *ctx, const Config &cfg) : m_ctx(ctx), m_path(cfg.m_path)
+Storage::Storage(ipx_ctx_t *ctx, const Config &cfg)
+    : m_ctx(ctx), m_path(cfg.m_path), m_shard(cfg.m_shard)
 {
     // Check if the directory exists
     struct stat file_info;
@@ -29,23 +28,35 @@ Storage::Storage(ipx_ctx_t *ctx, const Config &cfg) : m_ctx(ctx), m_path(cfg.m_p
     }
 
     // Prepare flags for FDS file
-    m_flags = 0;
+    uint32_t flags = 0;
     switch (cfg.m_calg) {
     case Config::calg::LZ4:
-        m_flags |= FDS_FILE_LZ4;
+        flags |= FDS_FILE_LZ4;
         break;
     case Config::calg::ZSTD:
-        m_flags |= FDS_FILE_ZSTD;
+        flags |= FDS_FILE_ZSTD;
         break;
     default:
         break;
     }
 
     if (!cfg.m_async) {
-        m_flags |= FDS_FILE_NOASYNC;
+        flags |= FDS_FILE_NOASYNC;
+    }
+
+    flags |= FDS_FILE_APPEND;
+
+    if (cfg.m_recompress.enabled) {
+        m_recomp.reset(new Recompressor(m_ctx, cfg.m_recompress.nice, cfg.m_recompress.idle_io,
+            cfg.m_recompress.rate));
     }
 
-    m_flags |= FDS_FILE_APPEND;
+    for (uint32_t i = 0; i < cfg.m_writers; ++i) {
+        m_writers.emplace_back(new Writer(m_ctx, flags, m_recomp.get()));
+        if (cfg.m_index.enabled) {
+            m_indexes.emplace_back(new Index(cfg.m_index.block, cfg.m_index.fpp));
+        }
+    }
 }
 
 Storage::~Storage()
@@ -59,9 +70,8 @@ Storage::window_new(time_t ts)
     // Close the current window if exists
     window_close();
 
-    // Open new file
-    const std::string new_file = filename_gen(ts) + TMP_SUFFIX;
-    m_file_name = new_file;
+    // Open new files (all files are in the same directory)
+    const std::string new_file = filename_gen(ts, 0);
     std::unique_ptr<char, decltype(&free)> new_file_cpy(strdup(new_file.c_str()), &free);
 
     char *dir2create;
@@ -73,54 +83,81 @@ Storage::window_new(time_t ts)
         throw FDS_exception("Failed to create directory '" + std::string(dir2create) + "'");
     }
 
-    m_file.reset(fds_file_init());
-    if (!m_file) {
-        throw FDS_exception("Failed to create FDS file handler!");
-    }
-
-    if (fds_file_open(m_file.get(), new_file.c_str(), m_flags) != FDS_OK) {
-        std::string err_msg = fds_file_error(m_file.get());
-        m_file.reset();
-        throw FDS_exception("Failed to create/append file '" + new_file + "': " + err_msg);
+    m_opened = true;
+    for (size_t i = 0; i < m_writers.size(); ++i) {
+        const std::string file_name = filename_gen(ts, i);
+        m_writers[i]->open(file_name);
+        if (!m_indexes.empty()) {
+            m_indexes[i]->open(file_name + ".idx");
+        }
     }
 }
 
 void
 Storage::window_close()
 {
-    bool file_opened = (m_file.get() != nullptr);
-    m_file.reset();
+    m_opened = false;
+    m_last = {nullptr, 0, nullptr, nullptr};
     m_session2params.clear();
-    if (file_opened) {
-        std::string new_file_name(m_file_name.begin(), m_file_name.end() - TMP_SUFFIX.size());
-        std::rename(m_file_name.c_str(), new_file_name.c_str());
-        m_file_name.clear();
+    m_session_next = 0;
+
+    // Files are finalized by threads of writers (i.e. a new window can be opened immediately)
+    for (auto &writer : m_writers) {
+        writer->close_async();
+    }
+
+    for (auto &index : m_indexes) {
+        try {
+            index->close();
+        } catch (const FDS_exception &ex) {
+            IPX_CTX_ERROR(m_ctx, "%s", ex.what());
+        }
     }
 }
 
 void
 Storage::process_msg(ipx_msg_ipfix_t *msg)
 {
-    if (!m_file) {
+    if (!m_opened) {
         IPX_CTX_DEBUG(m_ctx, "Ignoring IPFIX Message due to undefined output file!", '\0');
         return;
     }
 
-    // Specify a Transport Session context
+    // Specify a Transport Session context and its writer
     struct ipx_msg_ctx *msg_ctx = ipx_msg_ipfix_get_ctx(msg);
-    session_ctx &file_ctx = session_get(msg_ctx->session);
+    if (m_last.session != msg_ctx->session || m_last.odid != msg_ctx->odid) {
+        m_last.session = nullptr; // in case of an exception
+        m_last.params = &session_get(msg_ctx->session);
+        m_last.snap = &m_last.params->odid2snap[msg_ctx->odid];
+        m_last.session = msg_ctx->session;
+        m_last.odid = msg_ctx->odid;
+    }
+
+    session_ctx &file_ctx = *m_last.params;
+    const size_t writer_idx = (m_shard == Config::shard::SESSION)
+        ? file_ctx.writer : (msg_ctx->odid % m_writers.size());
+    Writer &writer = *m_writers[writer_idx];
+    Index *index = m_indexes.empty() ? nullptr : m_indexes[writer_idx].get();
+
+    if (!file_ctx.defined[writer_idx]) {
+        writer.session_add(file_ctx.id, file_ctx.desc);
+        file_ctx.defined[writer_idx] = true;
+    }
 
     auto hdr_ptr = reinterpret_cast<fds_ipfix_msg_hdr *>(ipx_msg_ipfix_get_packet(msg));
     assert(ntohs(hdr_ptr->version) == FDS_IPFIX_VERSION && "Unexpected packet version");
     const uint32_t exp_time = ntohl(hdr_ptr->export_time);
-
-    if (fds_file_write_ctx(m_file.get(), file_ctx.id, msg_ctx->odid, exp_time) != FDS_OK) {
-        const char *err_msg = fds_file_error(m_file.get());
-        throw FDS_exception("Failed to configure the writer: " + std::string(err_msg));
-    }
+    writer.context(file_ctx.id, msg_ctx->odid, exp_time);
 
     // Get info about the last seen Template snapshot
-    struct snap_info &snap_last = file_ctx.odid2snap[msg_ctx->odid];
+    struct snap_info &snap_last = *m_last.snap;
+    // If the generation is the same, all records refer to the last seen snapshot
+    const bool snap_check = (snap_last.ptr == nullptr || snap_last.gen != msg_ctx->snap_gen);
+    if (snap_check) {
+        // The address of the last snapshot might have been reused by the new one
+        snap_last.ptr = nullptr;
+        snap_last.gen = msg_ctx->snap_gen;
+    }
 
     // For each Data Record in the file
     const uint32_t rec_cnt = ipx_msg_ipfix_get_drec_cnt(msg);
@@ -128,25 +165,24 @@ Storage::process_msg(ipx_msg_ipfix_t *msg)
         ipx_ipfix_record *rec_ptr = ipx_msg_ipfix_get_drec(msg, i);
 
         // Check if the templates has been changed (detected by change of template snapshots)
-        if (rec_ptr->rec.snap != snap_last.ptr) {
+        if (snap_check && rec_ptr->rec.snap != snap_last.ptr) {
             const char *session_name = msg_ctx->session->ident;
             uint32_t session_odid = msg_ctx->odid;
             IPX_CTX_DEBUG(m_ctx, "Template snapshot of '%s' [ODID %" PRIu32 "] has been changed. "
                 "Updating template definitions...", session_name, session_odid);
 
-            tmplts_update(snap_last, rec_ptr->rec.snap);
+            tmplts_update(writer, snap_last, rec_ptr->rec.snap);
         }
 
         // Write the Data Record
-        const uint8_t *rec_data = rec_ptr->rec.data;
-        uint16_t rec_size = rec_ptr->rec.size;
-        uint16_t tmplt_id = rec_ptr->rec.tmplt->id;
-
-        if (fds_file_write_rec(m_file.get(), tmplt_id, rec_data, rec_size) != FDS_OK) {
-            const char *err_msg = fds_file_error(m_file.get());
-            throw FDS_exception("Failed to add a Data Record: " + std::string(err_msg));
+        writer.rec_add(rec_ptr->rec.tmplt->id, rec_ptr->rec.data, rec_ptr->rec.size);
+        if (index != nullptr) {
+            index->add(rec_ptr->rec);
         }
     }
+
+    // Pass the records to the thread of the writer (if suitable)
+    writer.submit();
 }
 
 /// Auxiliary data structure used in the snapshot iterator
@@ -156,10 +192,12 @@ struct tmplt_update_data {
     /// Plugin context (only for log!)
     ipx_ctx_t *ctx;
 
-    /// FDS file with specified context
-    fds_file_t *file;
-    /// Set of processed Templates in the snapshot
-    std::set<uint16_t> ids;
+    /// Writer of the FDS file with specified context
+    Writer *writer;
+    /// Templates defined in the file (updated)
+    std::map<uint16_t, Storage::tmplt_def> *tmplts;
+    /// Identification of the current update
+    uint32_t update;
 };
 
 /**
@@ -167,7 +205,7 @@ struct tmplt_update_data {
  *
  * The function checks if the same Template is already defined in the current context of the file.
  * If the Template is not present or it's different, the new Template definition is added to the
- * file.
+ * file. In any case, the Template is marked as seen in the current update.
  * @param[in] tmplt Template to process
  * @param[in] data  Auxiliary data structure \ref tmplt_update_data
  * @return On success returns true. Otherwise returns false.
@@ -175,48 +213,25 @@ struct tmplt_update_data {
 static bool
 tmplt_update_cb(const struct fds_template *tmplt, void *data)
 {
-    // Template type, raw data and size
-    enum fds_template_type t_type;
-    const uint8_t *t_data;
-    uint16_t t_size;
-
     auto info = reinterpret_cast<tmplt_update_data *>(data);
 
     // No exceptions can be thrown in the C callback!
     try {
         uint16_t t_id = tmplt->id;
-        info->ids.emplace(t_id);
-
-        // Get definition of the Template specified in the file
-        int res = fds_file_write_tmplt_get(info->file, t_id, &t_type, &t_data, &t_size);
-
-        if (res != FDS_OK && res != FDS_ERR_NOTFOUND) {
-            // Something bad happened
-            const char *err_msg = fds_file_error(info->file);
-            throw FDS_exception("fds_file_write_tmplt_get() failed: " + std::string(err_msg));
-        }
+        Storage::tmplt_def &def = (*info->tmplts)[t_id];
+        def.update = info->update;
 
-        // Should we add/redefine the definition of the Template
-        if (res == FDS_OK
-                && tmplt->type == t_type
-                && tmplt->raw.length == t_size
-                && memcmp(tmplt->raw.data, t_data, t_size) == 0) {
-            // The same -> nothing to do
-            return info->is_ok;
+        // Unchanged Templates are only compared (no copies)
+        if (def.type == tmplt->type && def.raw.size() == tmplt->raw.length
+                && memcmp(def.raw.data(), tmplt->raw.data, tmplt->raw.length) == 0) {
+            return true;
         }
 
         // Add the definition (i.e. templates are different or the template hasn't been defined)
         IPX_CTX_DEBUG(info->ctx, "Adding/updating definition of Template ID %" PRIu16, t_id);
-
-        t_type = tmplt->type;
-        t_data = tmplt->raw.data;
-        t_size = tmplt->raw.length;
-
-        if (fds_file_write_tmplt_add(info->file, t_type, t_data, t_size) != FDS_OK) {
-            const char *err_msg = fds_file_error(info->file);
-            throw FDS_exception("fds_file_write_tmplt_add() failed: " + std::string(err_msg));
-        }
-
+        info->writer->tmplt_add(tmplt->type, tmplt->raw.data, tmplt->raw.length);
+        def.type = tmplt->type;
+        def.raw.assign(reinterpret_cast<const char *>(tmplt->raw.data), tmplt->raw.length);
     } catch (std::exception &ex) {
         // Exceptions
         IPX_CTX_ERROR(info->ctx, "Failure during update of Template ID %" PRIu16 ": %s", tmplt->id,
@@ -239,16 +254,19 @@ tmplt_update_cb(const struct fds_template *tmplt, void *data)
  * previously undefined Template, its definition is added or updated. Definitions of Templates
  * that were available in the previous snapshot but not available in the new one are removed.
  *
- * Finally, information (pointer, IDs) in \p info are updated to reflect the performed update.
+ * Templates seen in the new snapshot are marked by a new value of the update counter,
+ * therefore, unchanged Templates are neither copied nor redefined and Templates that haven't
+ * been marked are removed.
  * @warning
  *   Template definitions are always unique for a combination of Transport Session and ODID,
- *   therefore, appropriate file writer context MUST already set using fds_file_writer_ctx().
+ *   therefore, appropriate context of the \p writer MUST already set using Writer::context().
  *   Parameters \p info and \p snap MUST also belong the same unique combination.
- * @param[in] info Information about the last update of Templates (old snapshot ref. + list of IDs)
- * @param[in] snap New Template snapshot with all valid Template definitions
+ * @param[in] writer Writer of the file with the combination
+ * @param[in] info   Information about the last update of Templates (old snapshot ref. + Templates)
+ * @param[in] snap   New Template snapshot with all valid Template definitions
  */
 void
-Storage::tmplts_update(struct snap_info &info, const fds_tsnapshot_t *snap)
+Storage::tmplts_update(Writer &writer, struct snap_info &info, const fds_tsnapshot_t *snap)
 {
     assert(info.ptr != snap && "Snapshots should be different");
 
@@ -256,8 +274,9 @@ Storage::tmplts_update(struct snap_info &info, const fds_tsnapshot_t *snap)
     struct tmplt_update_data data;
     data.is_ok = true;
     data.ctx = m_ctx;
-    data.file = m_file.get();
-    data.ids.clear();
+    data.writer = &writer;
+    data.tmplts = &info.tmplts;
+    data.update = ++info.update;
 
     // Update templates
     fds_tsnapshot_for(snap, &tmplt_update_cb, &data);
@@ -267,51 +286,37 @@ Storage::tmplts_update(struct snap_info &info, const fds_tsnapshot_t *snap)
         throw FDS_exception("Failed to update Template definitions");
     }
 
-    // Check if there are any Template IDs that have been removed
-    std::set<uint16_t> &ids_old = info.tmplt_ids;
-    std::set<uint16_t> &ids_new = data.ids;
-    std::set<uint16_t> ids2remove;
-    // Old Template IDs - New Templates IDs = Template IDs to remove
-    std::set_difference(ids_old.begin(), ids_old.end(), ids_new.begin(), ids_new.end(),
-        std::inserter(ids2remove, ids2remove.begin()));
-
     // Remove old templates that are not available in the new snapshot
-    for (uint16_t tid : ids2remove) {
-        IPX_CTX_DEBUG(m_ctx, "Removing definition of Template ID %" PRIu16, tid);
-
-        int rc = fds_file_write_tmplt_remove(m_file.get(), tid);
-        if (rc == FDS_OK) {
+    for (auto it = info.tmplts.begin(); it != info.tmplts.end();) {
+        if (it->second.update == data.update) {
+            ++it;
             continue;
         }
 
-        // Something bad happened
-        if (rc != FDS_ERR_NOTFOUND) {
-            std::string err_msg = fds_file_error(m_file.get());
-            throw FDS_exception("fds_file_write_tmplt_remove() failed: " + err_msg);
-        }
-
-        // Weird, but not critical
-        IPX_CTX_WARNING(m_ctx, "Failed to remove undefined Template ID %" PRIu16 ". "
-            "Weird, this should not happen.", tid);
+        const uint16_t tid = it->first;
+        IPX_CTX_DEBUG(m_ctx, "Removing definition of Template ID %" PRIu16, tid);
+        writer.tmplt_remove(tid);
+        it = info.tmplts.erase(it);
     }
 
     // Update information about the last update of Templates
     info.ptr = snap;
-    std::swap(info.tmplt_ids, data.ids);
 }
 
 /**
  * @brief Create a filename based for a user defined timestamp
  * @note The timestamp will be expressed in Coordinated Universal Time (UTC)
  *
- * @param[in] ts Timestamp of the file
+ * If there are multiple writers, the index of the writer is a part of the filename.
+ * @param[in] ts  Timestamp of the file
+ * @param[in] idx Index of the writer
  * @return New filename
  * @throw FDS_exception if formatting functions fail.
  */
 std::string
-Storage::filename_gen(const time_t &ts)
+Storage::filename_gen(const time_t &ts, size_t idx)
 {
-    const char pattern[] = "%Y/%m/%d/flows.%Y%m%d%H%M%S.fds";
+    const char pattern[] = "%Y/%m/%d/flows.%Y%m%d%H%M%S";
     constexpr size_t buffer_size = 64;
     char buffer_data[buffer_size];
 
@@ -329,7 +334,12 @@ Storage::filename_gen(const time_t &ts)
         new_path += '/';
     }
 
-    return new_path + buffer_data;
+    new_path += buffer_data;
+    if (m_writers.size() > 1) {
+        new_path += "." + std::to_string(idx);
+    }
+
+    return new_path + ".fds";
 }
 
 /**
@@ -351,12 +361,13 @@ Storage::ipv4toipv6(const uint8_t *in, uint8_t *out)
 /**
  * @brief Get file identification of a Transport Session
  *
- * If the identification doesn't exist, the function will add it to the file and create
- * a new internal record for it.
+ * If the identification doesn't exist, the function will create a new internal record for it.
+ * The Transport Session is defined in a file when the first record of the session is passed
+ * to the writer of the file.
  *
  * @param[in] sptr Transport Session to find
  * @return Internal description
- * @throw FDS_exception if the function failed to add a new Transport Session
+ * @throw FDS_exception if the Transport Session cannot be described in the file
  */
 struct Storage::session_ctx &
 Storage::session_get(const struct ipx_session *sptr)
@@ -367,22 +378,21 @@ Storage::session_get(const struct ipx_session *sptr)
         return res_it->second;
     }
 
-    // Not found -> register a new session
-    assert(m_file != nullptr && "File must be opened!");
-
+    // Not found -> create a new session (writers are assigned to sessions in turn)
     struct fds_file_session new_session;
-    fds_file_sid_t new_sid;
-
-    session_ipx2fds(sptr, &new_session);
-    if (fds_file_session_add(m_file.get(), &new_session, &new_sid) != FDS_OK) {
-        const char *err_msg = fds_file_error(m_file.get());
+    try {
+        session_ipx2fds(sptr, &new_session);
+    } catch (const FDS_exception &ex) {
         throw FDS_exception("Failed to register Transport Session '" + std::string(sptr->ident)
-            + "': " + err_msg);
+            + "': " + ex.what());
     }
 
-    // Create a new session
+    const uint32_t new_id = m_session_next++;
     struct session_ctx &ctx = m_session2params[sptr];
-    ctx.id = new_sid;
+    ctx.id = new_id;
+    ctx.desc = new_session;
+    ctx.writer = new_id % m_writers.size();
+    ctx.defined.assign(m_writers.size(), false);
     return ctx;
 }
 
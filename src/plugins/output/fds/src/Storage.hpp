@@ -14,26 +14,48 @@
 #include <ipfixcol2.h>
 #include <map>
 #include <memory>
-#include <set>
 #include <string>
+#include <unordered_map>
+#include <vector>
 #include <libfds.h>
 
 #include "Exception.hpp"
 #include "Config.hpp"
+#include "Index.hpp"
+#include "Recompressor.hpp"
+#include "Writer.hpp"
 
-/// Flow storage file
+/**
+ * @brief Flow storage files
+ *
+ * Each window consists of one or more files. Each file is written by its own writer (i.e.
+ * a background thread) and Data Records are distributed among writers by their Transport
+ * Session or ODID. Templates of each combination of a Transport Session and ODID are
+ * defined only in the file of its writer.
+ */
 class Storage {
 public:
+    /// Definition of a Template in a file
+    struct tmplt_def {
+        /// Type of the Template
+        enum fds_template_type type = FDS_TYPE_TEMPLATE;
+        /// Raw Template
+        std::string raw;
+        /// Last update of Templates in which the Template has been seen
+        uint32_t update = 0;
+    };
+
     /**
-     * @brief Create a flow storage file
+     * @brief Create a flow storage
      *
      * @note
-     *   Output file for the current window MUST be specified using new_window() function.
+     *   Output files for the current window MUST be specified using new_window() function.
      *   Otherwise, no flow records are stored.
      *
      * @param[in] ctx  Plugin context (only for log)
      * @param[in] cfg  Configuration
-     * @throw FDS_exception if @p path directory doesn't exist in the system
+     * @throw FDS_exception if @p path directory doesn't exist in the system or writers cannot
+     *   be created
      */
     Storage(ipx_ctx_t *ctx, const Config &cfg);
     virtual ~Storage();
@@ -59,6 +81,8 @@ public:
      *   records to the file.
      * @note
      *   No more Data Records will be added until a new window is created!
+     * @note
+     *   Files are finalized by threads of writers, i.e. the function doesn't wait for it.
      */
     void
     window_close();
@@ -66,7 +90,8 @@ public:
     /**
      * @brief Process IPFIX message
      *
-     * Process all IPFIX Data Records in the message and store them to the file.
+     * Process all IPFIX Data Records in the message and pass them to the writer of the
+     * Transport Session or ODID of the message.
      * @note If a time window is not opened, no Data Records are stored and no exception is thrown.
      * @param[in] msg Message to process
      * @throw FDS_exception if processing fails
@@ -79,39 +104,71 @@ private:
     struct snap_info {
         /// Last seen snapshot (might be already freed, do NOT dereference!)
         const fds_tsnapshot_t *ptr;
-        /// Set of Template IDs in the snapshot
-        std::set<uint16_t> tmplt_ids;
+        /// Generation of the last seen snapshot (see ipx_msg_ctx::snap_gen)
+        uint32_t gen;
+        /// Templates defined in the file (Template ID -> definition)
+        std::map<uint16_t, struct tmplt_def> tmplts;
+        /// Counter of updates of Templates
+        uint32_t update;
 
         snap_info() {
             ptr = nullptr;
-            tmplt_ids.clear();
+            gen = 0;
+            tmplts.clear();
+            update = 0;
         }
     };
 
     /// Description parameters of a Transport Session
     struct session_ctx {
-        /// Session ID used in the FDS file
-        fds_file_sid_t id;
+        /// Identification of the session in files of writers
+        uint32_t id;
+        /// Description of the session in FDS files
+        struct fds_file_session desc;
+        /// Writer of all records of the session (only if sharded by Transport Sessions)
+        size_t writer;
+        /// The session has been defined in the file of a writer (index == writer)
+        std::vector<bool> defined;
         /// Last seen snapshot for a specific ODID of the Transport Session
-        std::map<uint32_t, struct snap_info> odid2snap;
+        std::unordered_map<uint32_t, struct snap_info> odid2snap;
+    };
+
+    /// The last processed combination of a Transport Session and ODID
+    struct last_ctx {
+        /// Transport Session (nullptr == invalid)
+        const struct ipx_session *session;
+        /// Observation Domain ID
+        uint32_t odid;
+        /// Description parameters of the Transport Session
+        struct session_ctx *params;
+        /// Information about Templates of the combination
+        struct snap_info *snap;
     };
 
     /// Plugin context only for logging!
     ipx_ctx_t *m_ctx;
     /// Storage path
     std::string m_path;
-    /// Flags for opening file
-    uint32_t m_flags;
-
-    /// Output FDS file
-    std::unique_ptr<fds_file_t, decltype(&fds_file_close)> m_file = {nullptr, &fds_file_close};
-    /// Output FDS file name
-    std::string m_file_name;
+    /// Distribution of records among writers
+    Config::shard m_shard;
+
+    /// Recompressor of closed files (nullptr == disabled, must outlive writers)
+    std::unique_ptr<Recompressor> m_recomp;
+    /// Writers of files
+    std::vector<std::unique_ptr<Writer>> m_writers;
+    /// Secondary indexes of files (index == writer, empty if disabled)
+    std::vector<std::unique_ptr<Index>> m_indexes;
+    /// Files of the current window are opened
+    bool m_opened = false;
     /// Mapping of Transport Sessions to FDS specific parameters
-    std::map<const struct ipx_session *, struct session_ctx> m_session2params;
+    std::unordered_map<const struct ipx_session *, struct session_ctx> m_session2params;
+    /// Cache of the last lookup (consecutive messages usually belong to the same combination)
+    struct last_ctx m_last = {nullptr, 0, nullptr, nullptr};
+    /// Identification of the next new Transport Session
+    uint32_t m_session_next = 0;
 
     std::string
-    filename_gen(const time_t &ts);
+    filename_gen(const time_t &ts, size_t idx);
     static void
     ipv4toipv6(const uint8_t *in, uint8_t *out);
     struct session_ctx &
@@ -119,7 +176,7 @@ private:
     void
     session_ipx2fds(const struct ipx_session *ipx_desc, struct fds_file_session *fds_desc);
     void
-    tmplts_update(struct snap_info &info, const fds_tsnapshot_t *snap);
+    tmplts_update(Writer &writer, struct snap_info &info, const fds_tsnapshot_t *snap);
 };
 
 
@@ -0,0 +1,395 @@
+/**
+ * \file src/plugins/output/fds/src/Writer.cpp
+ * \author agent <agent@local>
+ * \brief FDS file writer with a background thread (source file)
+ * \date 2026
+ *
+ * Copyright(c) 2026 CESNET z.s.p.o.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include <cassert>
+#include <cinttypes>
+#include <cstdio>
+#include <cstring>
+#include <system_error>
+#include "Writer.hpp"
+
+/// Suffix of files that are being written
+static const std::string TMP_SUFFIX = ".tmp";
+/// Size of accumulated commands that are always passed to the thread
+static const size_t BUFFER_SIZE = 4U * 1024U * 1024U;
+
+/// Types of commands
+enum cmd_type : uint8_t {
+    CMD_SESSION,   ///< Definition of a Transport Session
+    CMD_CTX,       ///< Selection of a Transport Session and ODID
+    CMD_TMPLT_ADD, ///< Definition of a Template
+    CMD_TMPLT_REM, ///< Removal of a Template
+    CMD_REC        ///< Data Record
+};
+
+/**
+ * @brief Read a value of a command
+ * @param[in,out] pos Position in the buffer (moved behind the value)
+ * @return Value
+ */
+template <typename T>
+static inline T
+cmd_get(const uint8_t *&pos)
+{
+    T value;
+    memcpy(&value, pos, sizeof(value));
+    pos += sizeof(value);
+    return value;
+}
+
+Writer::Writer(ipx_ctx_t *ctx, uint32_t flags, Recompressor *recomp)
+    : m_ctx(ctx), m_flags(flags), m_recomp(recomp)
+{
+    m_job.cmds = nullptr;
+    m_job.file = nullptr;
+    m_job.file_new = false;
+    m_job.busy = false;
+    m_job.stop = false;
+
+    for (std::vector<uint8_t> &buffer : m_buffers) {
+        buffer.reserve(BUFFER_SIZE + UINT16_MAX);
+    }
+    m_current = &m_buffers[0];
+
+    try {
+        m_thread = std::thread(&Writer::thread_main, this);
+    } catch (const std::system_error &ex) {
+        throw FDS_exception("Failed to start a writer thread: " + std::string(ex.what()));
+    }
+}
+
+Writer::~Writer()
+{
+    close();
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_job.stop = true;
+    }
+    m_cv_job.notify_one();
+    m_thread.join();
+}
+
+void
+Writer::open(const std::string &path)
+{
+    assert(!m_file && "The file is already opened");
+    const std::string file_name = path + TMP_SUFFIX;
+
+    std::unique_ptr<fds_file_t, decltype(&fds_file_close)> file(fds_file_init(), &fds_file_close);
+    if (!file) {
+        throw FDS_exception("Failed to create FDS file handler!");
+    }
+
+    if (fds_file_open(file.get(), file_name.c_str(), m_flags) != FDS_OK) {
+        std::string err_msg = fds_file_error(file.get());
+        throw FDS_exception("Failed to create/append file '" + file_name + "': " + err_msg);
+    }
+
+    // The thread might still finalize the previous file
+    m_file = std::move(file);
+    m_file_name = file_name;
+    m_file_new = true;
+    m_current->clear();
+}
+
+void
+Writer::close_async()
+{
+    if (!m_file) {
+        return;
+    }
+
+    // The file (with remaining commands) is handed over to the thread
+    pass(true);
+    m_file_name.clear();
+}
+
+void
+Writer::close()
+{
+    close_async();
+    wait_idle();
+}
+
+/**
+ * @brief Append a value to the buffer of commands
+ * @param[in] value Value
+ */
+template <typename T>
+void
+Writer::cmd_put(const T &value)
+{
+    const uint8_t *ptr = reinterpret_cast<const uint8_t *>(&value);
+    m_current->insert(m_current->end(), ptr, ptr + sizeof(value));
+}
+
+void
+Writer::session_add(uint32_t id, const struct fds_file_session &desc)
+{
+    cmd_put(CMD_SESSION);
+    cmd_put(id);
+    cmd_put(desc);
+}
+
+void
+Writer::context(uint32_t id, uint32_t odid, uint32_t exp_time)
+{
+    cmd_put(CMD_CTX);
+    cmd_put(id);
+    cmd_put(odid);
+    cmd_put(exp_time);
+}
+
+void
+Writer::tmplt_add(enum fds_template_type type, const uint8_t *data, uint16_t size)
+{
+    cmd_put(CMD_TMPLT_ADD);
+    cmd_put(type);
+    cmd_put(size);
+    m_current->insert(m_current->end(), data, data + size);
+}
+
+void
+Writer::tmplt_remove(uint16_t id)
+{
+    cmd_put(CMD_TMPLT_REM);
+    cmd_put(id);
+}
+
+void
+Writer::rec_add(uint16_t tmplt_id, const uint8_t *data, uint16_t size)
+{
+    cmd_put(CMD_REC);
+    cmd_put(tmplt_id);
+    cmd_put(size);
+    m_current->insert(m_current->end(), data, data + size);
+}
+
+void
+Writer::submit(bool force)
+{
+    bool idle;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_job.error.empty()) {
+            std::string err_msg;
+            std::swap(err_msg, m_job.error);
+            throw FDS_exception(err_msg);
+        }
+        idle = !m_job.busy;
+    }
+
+    if (m_current->empty() || (!idle && !force && m_current->size() < BUFFER_SIZE)) {
+        return;
+    }
+
+    pass(false);
+}
+
+/**
+ * @brief Pass the added commands to the thread
+ *
+ * If the thread is still processing previous commands, wait until it's finished.
+ * @param[in] close Finalize the file after the commands are written
+ */
+void
+Writer::pass(bool close)
+{
+    assert(m_file && "The file must be opened");
+
+    wait_idle();
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_job.cmds = m_current;
+        m_job.file = m_file.get();
+        m_job.file_new = m_file_new;
+        if (close) {
+            m_job.close_file = std::move(m_file);
+            m_job.close_name = m_file_name;
+        }
+        m_job.busy = true;
+    }
+    m_cv_job.notify_one();
+    m_file_new = false;
+
+    // The other buffer is not used by the thread anymore
+    m_current = (m_current == &m_buffers[0]) ? &m_buffers[1] : &m_buffers[0];
+    m_current->clear();
+}
+
+/**
+ * @brief Wait until the thread is idle
+ */
+void
+Writer::wait_idle()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_cv_done.wait(lock, [this]() {return !m_job.busy;});
+}
+
+/**
+ * @brief Main function of the thread
+ */
+void
+Writer::thread_main()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (true) {
+        m_cv_job.wait(lock, [this]() {return m_job.stop || m_job.busy;});
+        if (!m_job.busy) {
+            // Stop request
+            break;
+        }
+
+        const bool failed = !m_job.error.empty();
+        lock.unlock();
+
+        if (m_job.file_new) {
+            m_sids.clear();
+        }
+
+        std::string err_msg;
+        if (!failed) {
+            // Commands after a failure are dropped until the file is closed
+            try {
+                replay(m_job.file, *m_job.cmds);
+            } catch (const FDS_exception &ex) {
+                err_msg = ex.what();
+            }
+        }
+
+        lock.lock();
+        if (!err_msg.empty()) {
+            m_job.error = err_msg;
+        }
+
+        if (m_job.close_file) {
+            lock.unlock();
+            finalize();
+            lock.lock();
+        }
+        m_job.busy = false;
+        m_cv_done.notify_one();
+    }
+}
+
+/**
+ * @brief Replay commands into the file (called by the thread)
+ * @param[in] file File
+ * @param[in] cmds Commands
+ * @throw FDS_exception if a command fails
+ */
+void
+Writer::replay(fds_file_t *file, const std::vector<uint8_t> &cmds)
+{
+    const uint8_t *pos = cmds.data();
+    const uint8_t *end = pos + cmds.size();
+
+    while (pos < end) {
+        switch (cmd_get<cmd_type>(pos)) {
+        case CMD_REC: {
+            const uint16_t tmplt_id = cmd_get<uint16_t>(pos);
+            const uint16_t size = cmd_get<uint16_t>(pos);
+            if (fds_file_write_rec(file, tmplt_id, pos, size) != FDS_OK) {
+                const char *err_msg = fds_file_error(file);
+                throw FDS_exception("Failed to add a Data Record: " + std::string(err_msg));
+            }
+            pos += size;
+            }
+            break;
+        case CMD_CTX: {
+            const uint32_t id = cmd_get<uint32_t>(pos);
+            const uint32_t odid = cmd_get<uint32_t>(pos);
+            const uint32_t exp_time = cmd_get<uint32_t>(pos);
+            assert(id < m_sids.size() && "Undefined Transport Session");
+            if (fds_file_write_ctx(file, m_sids[id], odid, exp_time) != FDS_OK) {
+                const char *err_msg = fds_file_error(file);
+                throw FDS_exception("Failed to configure the writer: " + std::string(err_msg));
+            }
+            }
+            break;
+        case CMD_TMPLT_ADD: {
+            const auto type = cmd_get<enum fds_template_type>(pos);
+            const uint16_t size = cmd_get<uint16_t>(pos);
+            if (fds_file_write_tmplt_add(file, type, pos, size) != FDS_OK) {
+                const char *err_msg = fds_file_error(file);
+                throw FDS_exception("fds_file_write_tmplt_add() failed: " + std::string(err_msg));
+            }
+            pos += size;
+            }
+            break;
+        case CMD_TMPLT_REM: {
+            const uint16_t tid = cmd_get<uint16_t>(pos);
+            int rc = fds_file_write_tmplt_remove(file, tid);
+            if (rc == FDS_ERR_NOTFOUND) {
+                // Weird, but not critical
+                IPX_CTX_WARNING(m_ctx, "Failed to remove undefined Template ID %" PRIu16 ". "
+                    "Weird, this should not happen.", tid);
+            } else if (rc != FDS_OK) {
+                std::string err_msg = fds_file_error(file);
+                throw FDS_exception("fds_file_write_tmplt_remove() failed: " + err_msg);
+            }
+            }
+            break;
+        case CMD_SESSION: {
+            const uint32_t id = cmd_get<uint32_t>(pos);
+            const auto desc = cmd_get<struct fds_file_session>(pos);
+            fds_file_sid_t sid;
+            if (fds_file_session_add(file, &desc, &sid) != FDS_OK) {
+                const char *err_msg = fds_file_error(file);
+                throw FDS_exception("Failed to register a Transport Session: "
+                    + std::string(err_msg));
+            }
+            if (m_sids.size() <= id) {
+                m_sids.resize(id + 1);
+            }
+            m_sids[id] = sid;
+            }
+            break;
+        default:
+            assert(false && "Unexpected command");
+            return;
+        }
+    }
+}
+
+/**
+ * @brief Finalize the file of the job (called by the thread)
+ *
+ * Remaining records are written, the file is closed and renamed. Any error of the file is
+ * reported to the log and cleared, so it doesn't affect the next file. Only complete files
+ * are passed to the recompressor (if any).
+ */
+void
+Writer::finalize()
+{
+    std::string err_msg;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        std::swap(err_msg, m_job.error);
+    }
+
+    // Remaining records are written when the file is closed
+    const std::string &file_name = m_job.close_name;
+    m_job.close_file.reset();
+
+    const std::string new_file_name(file_name, 0, file_name.size() - TMP_SUFFIX.size());
+    if (std::rename(file_name.c_str(), new_file_name.c_str()) != 0 && err_msg.empty()) {
+        err_msg = "Failed to rename file '" + file_name + "'";
+    }
+
+    if (!err_msg.empty()) {
+        IPX_CTX_ERROR(m_ctx, "Failed to write file '%s': %s", new_file_name.c_str(),
+            err_msg.c_str());
+    } else if (m_recomp != nullptr) {
+        m_recomp->add(new_file_name);
+    }
+}
@@ -0,0 +1,213 @@
+/**
+ * \file src/plugins/output/fds/src/Writer.hpp
+ * \author agent <agent@local>
+ * \brief FDS file writer with a background thread (header file)
+ * \date 2026
+ *
+ * Copyright(c) 2026 CESNET z.s.p.o.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef IPFIXCOL2_FDS_WRITER_HPP
+#define IPFIXCOL2_FDS_WRITER_HPP
+
+#include <ipfixcol2.h>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <libfds.h>
+
+#include "Exception.hpp"
+#include "Recompressor.hpp"
+
+/**
+ * @brief Writer of an FDS file
+ *
+ * Operations with the file (i.e. definitions of Transport Sessions and Templates, and Data
+ * Records) are serialized into a buffer of commands. Filled buffers are replayed by a background
+ * thread, which calls the FDS library (i.e. the thread performs the compression too). While the
+ * thread is writing one buffer, the other one is filled. The file is also finalized (i.e. flushed,
+ * closed and renamed) by the thread, therefore, a new file can be opened immediately.
+ *
+ * @note Commands are processed by the thread in the same order as they were added. Errors
+ *   detected by the thread are reported by the next call of submit(). Errors detected during
+ *   finalization of a file are reported by the thread to the log.
+ * @note The writer is not thread-safe, all functions must be called by the same thread.
+ * @note If a recompressor is given, successfully finalized files are passed to it.
+ */
+class Writer {
+public:
+    /**
+     * @brief Create a writer
+     * @param[in] ctx   Plugin context (only for log)
+     * @param[in] flags Flags for opening files (see fds_file_open())
+     * @param[in] recomp Recompressor of finalized files (nullptr == disabled)
+     * @throw FDS_exception if the thread cannot be started
+     */
+    Writer(ipx_ctx_t *ctx, uint32_t flags, Recompressor *recomp = nullptr);
+    ~Writer();
+
+    // Disable copy constructors
+    Writer(const Writer &other) = delete;
+    Writer &operator=(const Writer &other) = delete;
+
+    /**
+     * @brief Open a new file
+     *
+     * The file is created with a temporary suffix and renamed after it's closed.
+     * @note A previously opened file must be closed.
+     * @param[in] path Path of the file
+     * @throw FDS_exception if the file cannot be opened
+     */
+    void
+    open(const std::string &path);
+
+    /**
+     * @brief Write all remaining commands and close the file (if opened)
+     *
+     * The file is finalized by the thread. The function doesn't wait for it, unless the thread
+     * is still processing previous commands.
+     * @note Any previous error of the file is reported to the log.
+     */
+    void
+    close_async();
+
+    /**
+     * @brief Write all remaining commands and close the file (if opened)
+     *
+     * Same as close_async() but the function waits until the file is finalized.
+     */
+    void
+    close();
+
+    /**
+     * @brief Check if a file is opened
+     * @return True or false
+     */
+    bool
+    is_open() const {return m_file != nullptr;};
+
+    /**
+     * @brief Add a definition of a Transport Session
+     * @param[in] id   Identification of the session (unique within the file)
+     * @param[in] desc Description of the session
+     */
+    void
+    session_add(uint32_t id, const struct fds_file_session &desc);
+
+    /**
+     * @brief Select a Transport Session and ODID of following Templates and Data Records
+     * @param[in] id       Identification of the session (see session_add())
+     * @param[in] odid     Observation Domain ID
+     * @param[in] exp_time Export time
+     */
+    void
+    context(uint32_t id, uint32_t odid, uint32_t exp_time);
+
+    /**
+     * @brief Add or redefine a Template in the current context
+     * @param[in] type Type of the Template
+     * @param[in] data Raw Template
+     * @param[in] size Size of the raw Template
+     */
+    void
+    tmplt_add(enum fds_template_type type, const uint8_t *data, uint16_t size);
+
+    /**
+     * @brief Remove a Template from the current context
+     * @param[in] id Template ID
+     */
+    void
+    tmplt_remove(uint16_t id);
+
+    /**
+     * @brief Add a Data Record to the current context
+     * @param[in] tmplt_id Template ID
+     * @param[in] data     Data Record
+     * @param[in] size     Size of the Data Record
+     */
+    void
+    rec_add(uint16_t tmplt_id, const uint8_t *data, uint16_t size);
+
+    /**
+     * @brief Pass the added commands to the thread (if suitable)
+     *
+     * Commands are passed if the thread is idle or too many commands have been accumulated.
+     * In the latter case, the function waits until the thread finishes its current job.
+     * @param[in] force Always pass the commands
+     * @throw FDS_exception if the thread has failed to write previous commands
+     */
+    void
+    submit(bool force = false);
+
+private:
+    /// Plugin context only for logging!
+    ipx_ctx_t *m_ctx;
+    /// Flags for opening files
+    uint32_t m_flags;
+    /// Recompressor of finalized files (nullptr == disabled)
+    Recompressor *m_recomp;
+
+    /// Output FDS file (accessed only by the thread while it's busy)
+    std::unique_ptr<fds_file_t, decltype(&fds_file_close)> m_file = {nullptr, &fds_file_close};
+    /// Output FDS file name (with the temporary suffix)
+    std::string m_file_name;
+    /// No commands of the file have been passed to the thread yet
+    bool m_file_new = false;
+    /// Session IDs in the file (index == identification of the session, used only by the thread)
+    std::vector<fds_file_sid_t> m_sids;
+
+    /// Buffers of commands (one filled by the caller, one replayed by the thread)
+    std::vector<uint8_t> m_buffers[2];
+    /// Buffer being filled
+    std::vector<uint8_t> *m_current;
+
+    /// Thread
+    std::thread m_thread;
+    /// Synchronization of the thread
+    std::mutex m_mutex;
+    /// Notification about a new job of the thread
+    std::condition_variable m_cv_job;
+    /// Notification about a finished job
+    std::condition_variable m_cv_done;
+
+    struct {
+        /// Commands to replay
+        const std::vector<uint8_t> *cmds;
+        /// File to write
+        fds_file_t *file;
+        /// The commands are the first commands of the file
+        bool file_new;
+        /// File to finalize after the commands are written (nullptr == none)
+        std::unique_ptr<fds_file_t, decltype(&fds_file_close)> close_file =
+            {nullptr, &fds_file_close};
+        /// Name of the file to finalize (with the temporary suffix)
+        std::string close_name;
+        /// The thread is processing the job
+        bool busy;
+        /// Request to stop the thread
+        bool stop;
+        /// Error message of a failed job (empty == no error)
+        std::string error;
+    } m_job;
+
+    template <typename T>
+    void
+    cmd_put(const T &value);
+    void
+    pass(bool close);
+    void
+    wait_idle();
+    void
+    thread_main();
+    void
+    replay(fds_file_t *file, const std::vector<uint8_t> &cmds);
+    void
+    finalize();
+};
+
+#endif // IPFIXCOL2_FDS_WRITER_HPP
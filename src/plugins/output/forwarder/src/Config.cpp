@@ -43,6 +43,7 @@
 
 #include <memory>
 #include <cctype>
+#include <climits>
 #include <cstring>
 #include <netdb.h>
 #include <unistd.h>
@@ -63,7 +64,16 @@ enum {
     NAME,
     ADDRESS,
     PORT,
-    PREMADE_CONNECTIONS
+    PREMADE_CONNECTIONS,
+    CONNECTOR_THREAD,
+    BATCH_SIZE,
+    BATCH_TIMEOUT,
+    SPLIT_KEY,
+    SPLIT_PREFIX4,
+    SPLIT_PREFIX6,
+    SPOOL_MEM_SIZE,
+    SPOOL_FILE_SIZE,
+    SPOOL_DIR
 };
 
 static fds_xml_args host_schema[] = {
@@ -86,6 +96,15 @@ static fds_xml_args params_schema[] = {
     FDS_OPTS_ELEM  (TEMPLATES_RESEND_PKTS, "templatesResendPkts", FDS_OPTS_T_UINT  , FDS_OPTS_P_OPT),
     FDS_OPTS_ELEM  (RECONNECT_SECS       , "reconnectSecs"      , FDS_OPTS_T_UINT  , FDS_OPTS_P_OPT),
     FDS_OPTS_ELEM  (PREMADE_CONNECTIONS  , "premadeConnections" , FDS_OPTS_T_UINT  , FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM  (CONNECTOR_THREAD     , "connectorThread"    , FDS_OPTS_T_BOOL  , FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM  (BATCH_SIZE           , "batchSize"          , FDS_OPTS_T_UINT  , FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM  (BATCH_TIMEOUT        , "batchTimeout"       , FDS_OPTS_T_UINT  , FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM  (SPLIT_KEY            , "splitKey"           , FDS_OPTS_T_STRING, FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM  (SPLIT_PREFIX4        , "splitPrefixV4"      , FDS_OPTS_T_UINT  , FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM  (SPLIT_PREFIX6        , "splitPrefixV6"      , FDS_OPTS_T_UINT  , FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM  (SPOOL_MEM_SIZE       , "spoolMemSize"       , FDS_OPTS_T_UINT  , FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM  (SPOOL_FILE_SIZE      , "spoolFileSize"      , FDS_OPTS_T_UINT  , FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM  (SPOOL_DIR            , "spoolDir"           , FDS_OPTS_T_STRING, FDS_OPTS_P_OPT),
     FDS_OPTS_NESTED(HOSTS                , "hosts"              , hosts_schema     , 0             ),
     FDS_OPTS_END
 };
@@ -142,8 +161,14 @@ Config::parse_params(fds_xml_ctx_t *params_ctx)
             } else if (strcasecmp(content->ptr_string, "all") == 0) {
                 this->forward_mode = ForwardMode::SENDTOALL;
 
+            } else if (strcasecmp(content->ptr_string, "hash") == 0) {
+                this->forward_mode = ForwardMode::HASH;
+
+            } else if (strcasecmp(content->ptr_string, "split") == 0) {
+                this->forward_mode = ForwardMode::SPLIT;
+
             } else {
-                throw std::invalid_argument("mode must be one of: 'RoundRobin', 'All'");
+                throw std::invalid_argument("mode must be one of: 'RoundRobin', 'All', 'Hash', 'Split'");
 
             }
             break;
@@ -181,6 +206,75 @@ Config::parse_params(fds_xml_ctx_t *params_ctx)
             this->nb_premade_connections = content->val_uint;
             break;
 
+        case CONNECTOR_THREAD:
+            this->connector_thread = content->val_bool;
+            break;
+
+        case SPLIT_KEY:
+            if (strcasecmp(content->ptr_string, "srcip") == 0) {
+                this->split_key = SplitKey::SRC_IP;
+
+            } else if (strcasecmp(content->ptr_string, "dstip") == 0) {
+                this->split_key = SplitKey::DST_IP;
+
+            } else {
+                throw std::invalid_argument("splitKey must be one of: 'SrcIP', 'DstIP'");
+
+            }
+            break;
+
+        case SPLIT_PREFIX4:
+            if (content->val_uint > 32) {
+                throw std::invalid_argument("splitPrefixV4 must be between 0 and 32");
+            }
+
+            this->split_prefix4 = static_cast<unsigned int>(content->val_uint);
+            break;
+
+        case SPLIT_PREFIX6:
+            if (content->val_uint > 128) {
+                throw std::invalid_argument("splitPrefixV6 must be between 0 and 128");
+            }
+
+            this->split_prefix6 = static_cast<unsigned int>(content->val_uint);
+            break;
+
+        case SPOOL_MEM_SIZE:
+            if (content->val_uint > SIZE_MAX / (1024 * 1024)) {
+                throw std::invalid_argument("invalid spoolMemSize " + std::to_string(content->val_uint));
+            }
+
+            this->spool.mem_size = content->val_uint * 1024 * 1024;
+            break;
+
+        case SPOOL_FILE_SIZE:
+            if (content->val_uint > SIZE_MAX / (1024 * 1024)) {
+                throw std::invalid_argument("invalid spoolFileSize " + std::to_string(content->val_uint));
+            }
+
+            this->spool.file_size = content->val_uint * 1024 * 1024;
+            break;
+
+        case SPOOL_DIR:
+            this->spool.dir = std::string(content->ptr_string);
+            break;
+
+        case BATCH_SIZE:
+            if (content->val_uint < 1 || content->val_uint > BATCH_SIZE_MAX) {
+                throw std::invalid_argument("batchSize must be between 1 and " + std::to_string(BATCH_SIZE_MAX));
+            }
+
+            this->batch_size = static_cast<unsigned int>(content->val_uint);
+            break;
+
+        case BATCH_TIMEOUT:
+            if (content->val_uint > UINT_MAX) {
+                throw std::invalid_argument("invalid batchTimeout " + std::to_string(content->val_uint));
+            }
+
+            this->batch_timeout_us = static_cast<unsigned int>(content->val_uint);
+            break;
+
         default: assert(0);
         }
     }
@@ -244,11 +338,24 @@ Config::set_defaults()
     this->tmplts_resend_pkts = 5000;
     this->reconnect_secs = 10;
     this->nb_premade_connections = 5;
+    this->connector_thread = true;
+    this->batch_size = 1;
+    this->batch_timeout_us = 1000;
+    this->split_key = SplitKey::SRC_IP;
+    this->split_prefix4 = 24;
+    this->split_prefix6 = 64;
+    this->spool.mem_size = 0;
+    this->spool.file_size = 0;
+    this->spool.dir = "/tmp";
 }
 
 void
 Config::ensure_valid()
 {
+    if (spool.file_size > 0 && access(spool.dir.c_str(), W_OK | X_OK) != 0) {
+        throw std::invalid_argument("spoolDir " + spool.dir + " is not a writable directory");
+    }
+
     for (auto &host : hosts) {
 
         if (!can_resolve_host(host)) {
@@ -47,11 +47,22 @@
 
 #include "common.h"
 
+/// The maximal number of messages in a batch (the limit of one sendmmsg call)
+constexpr unsigned int BATCH_SIZE_MAX = 1024;
+
 /// The forwarding mode
 enum class ForwardMode {
     UNASSIGNED,
     SENDTOALL, /// Every message is forwarded to all of the hosts
-    ROUNDROBIN /// Only one host receives each message, next host is selected every message
+    ROUNDROBIN, /// Only one host receives each message, next host is selected every message
+    HASH, /// Messages of each session and ODID are sent to the same host selected by consistent hashing
+    SPLIT /// Records of each message are split among the hosts by consistent hashing of a key field
+};
+
+/// The field records are split by
+enum class SplitKey {
+    SRC_IP, /// Prefix of the source IP address
+    DST_IP  /// Prefix of the destination IP address
 };
 
 struct HostConfig {
@@ -63,6 +74,19 @@ struct HostConfig {
     uint16_t port;
 };
 
+/// Limits of the spool of messages waiting for a connection
+struct SpoolConfig {
+    /// The maximal size of messages kept in memory per connection (bytes)
+    size_t mem_size;
+    /// The size of the file for messages exceeding the memory limit per connection (bytes, 0 = no file)
+    size_t file_size;
+    /// The directory to create the files in
+    std::string dir;
+
+    /// Check if the spool is enabled
+    bool enabled() const { return mem_size > 0 || file_size > 0; }
+};
+
 /// The config to be passed to the forwarder
 class Config
 {
@@ -81,6 +105,20 @@ public:
     unsigned int reconnect_secs;
     /// Number of premade connections to keep
     unsigned int nb_premade_connections;
+    /// Establish connections on a separate thread (otherwise by the thread of the plugin)
+    bool connector_thread;
+    /// The maximal number of messages sent together by one system call (1 = no batching)
+    unsigned int batch_size;
+    /// The maximal number of microseconds a message can wait in an unfinished batch
+    unsigned int batch_timeout_us;
+    /// The field records are split by (split mode only)
+    SplitKey split_key;
+    /// The length of IPv4 prefixes records are split by (split mode only)
+    unsigned int split_prefix4;
+    /// The length of IPv6 prefixes records are split by (split mode only)
+    unsigned int split_prefix6;
+    /// The spool of messages waiting for a connection
+    SpoolConfig spool;
 
     Config() {};
 
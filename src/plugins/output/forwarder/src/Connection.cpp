@@ -52,6 +52,7 @@
 #include <netdb.h>
 #include <unistd.h>
 #include <arpa/inet.h>
+#include <sys/socket.h>
 
 #include <libfds.h>
 
@@ -59,14 +60,20 @@
 
 Connection::Connection(const std::string &ident, ConnectionParams con_params, ipx_ctx_t *log_ctx,
                        unsigned int tmplts_resend_pkts, unsigned int tmplts_resend_secs,
-                       Connector &connector) :
+                       unsigned int batch_size, unsigned int batch_timeout_us,
+                       const SpoolConfig &spool_config, Connector &connector) :
     m_ident(ident),
     m_con_params(con_params),
     m_log_ctx(log_ctx),
     m_tmplts_resend_pkts(tmplts_resend_pkts),
     m_tmplts_resend_secs(tmplts_resend_secs),
+    m_batch_size(batch_size),
+    m_batch_timeout(batch_timeout_us),
     m_connector(connector)
 {
+    if (spool_config.enabled()) {
+        m_spool.reset(new Spool(spool_config.mem_size, spool_config.file_size, spool_config.dir));
+    }
 }
 
 void
@@ -77,26 +84,119 @@ Connection::connect()
 }
 
 void
-Connection::forward_message(ipx_msg_ipfix_t *msg)
+Connection::forward_message(ipx_msg_ipfix_t *msg, const DrecSelection *sel)
 {
     assert(check_connected());
 
     Sender &sender = get_or_create_sender(msg);
     try {
-        sender.process_message(msg);
+        sender.process_message(msg, sel);
 
     } catch (const ConnectionError &err) {
         // In case connection was lost, we have to resend templates when it reconnects
         sender.clear_templates();
         throw err;
     }
+
+    clear_templates_if_dropped();
 }
 
 void
-Connection::lose_message(ipx_msg_ipfix_t *msg)
+Connection::lose_message(ipx_msg_ipfix_t *msg, const DrecSelection *sel)
 {
     Sender &sender = get_or_create_sender(msg);
-    sender.lose_message(msg);
+    sender.lose_message(msg, sel);
+}
+
+void
+Connection::store_message(ipx_msg_ipfix_t *msg, const DrecSelection *sel)
+{
+    assert(m_spool);
+
+    Sender &sender = get_or_create_sender(msg);
+
+    // The emitted messages cannot throw as they are not sent
+    m_spool_forced = true;
+    sender.process_message(msg, sel);
+    m_spool_forced = false;
+
+    clear_templates_if_dropped();
+}
+
+void
+Connection::flush_batch()
+{
+    const size_t msg_cnt = m_batch.lengths.size();
+    if (msg_cnt == 0) {
+        return;
+    }
+
+    // Messages are batched only when there are no waiting transfers
+    assert(m_transfers.empty());
+
+    if (m_con_params.protocol == Protocol::UDP) {
+        // One datagram per message
+        std::vector<mmsghdr> hdrs(msg_cnt);
+        std::vector<iovec> parts(msg_cnt);
+        uint8_t *data = m_batch.data.data();
+
+        for (size_t i = 0; i < msg_cnt; i++) {
+            parts[i].iov_base = data;
+            parts[i].iov_len = m_batch.lengths[i];
+            memset(&hdrs[i], 0, sizeof(hdrs[i]));
+            hdrs[i].msg_hdr.msg_iov = &parts[i];
+            hdrs[i].msg_hdr.msg_iovlen = 1;
+            data += m_batch.lengths[i];
+        }
+
+        int ret = sendmmsg(m_sockfd.get(), hdrs.data(), static_cast<unsigned int>(msg_cnt), MSG_DONTWAIT | MSG_NOSIGNAL);
+
+        check_socket_error(ret);
+
+        size_t sent = std::max<int>(0, ret);
+
+        IPX_CTX_DEBUG(m_log_ctx, "Sent %zu/%zu messages to %s", sent, msg_cnt, m_ident.c_str());
+
+        // The datagrams that couldn't be sent have to be sent one by one
+        for (size_t i = sent; i < msg_cnt; i++) {
+            const uint8_t *msg_data = static_cast<const uint8_t *>(parts[i].iov_base);
+
+            Transfer transfer;
+            transfer.data.assign(msg_data, msg_data + parts[i].iov_len);
+            transfer.offset = 0;
+            m_transfers.push_back(std::move(transfer));
+        }
+
+    } else {
+        // The stream doesn't preserve message boundaries, so everything can be sent at once
+        ssize_t ret = send(m_sockfd.get(), m_batch.data.data(), m_batch.data.size(),
+                           MSG_DONTWAIT | MSG_NOSIGNAL);
+
+        check_socket_error(ret);
+
+        size_t sent = std::max<ssize_t>(0, ret);
+
+        IPX_CTX_DEBUG(m_log_ctx, "Sent %zu/%zu B (%zu messages) to %s", sent, m_batch.data.size(),
+                      msg_cnt, m_ident.c_str());
+
+        if (sent < m_batch.data.size()) {
+            Transfer transfer;
+            transfer.data.assign(m_batch.data.begin() + sent, m_batch.data.end());
+            transfer.offset = 0;
+            m_transfers.push_back(std::move(transfer));
+        }
+    }
+
+    m_batch.data.clear();
+    m_batch.lengths.clear();
+}
+
+void
+Connection::flush_expired(std::chrono::steady_clock::time_point now)
+{
+    if (!m_batch.lengths.empty() && now - m_batch.since >= m_batch_timeout) {
+        flush_batch();
+    }
 }
 
 void
@@ -110,8 +210,6 @@ Connection::advance_transfers()
 
         Transfer &transfer = *it;
 
-        assert(transfer.data.size() <= UINT16_MAX); // The transfer consists of one IPFIX message which cannot be larger
-
         ssize_t ret = send(m_sockfd.get(), &transfer.data[transfer.offset],
                            transfer.data.size() - transfer.offset, MSG_DONTWAIT | MSG_NOSIGNAL);
 
@@ -132,6 +230,41 @@ Connection::advance_transfers()
             break;
         }
     }
+
+    if (m_spool && m_transfers.empty()) {
+        drain_spool();
+    }
+}
+
+void
+Connection::drain_spool()
+{
+    while (m_transfers.empty() && !m_spool->empty()) {
+        uint16_t length;
+        const uint8_t *data = m_spool->front(length);
+
+        ssize_t ret = send(m_sockfd.get(), data, length, MSG_DONTWAIT | MSG_NOSIGNAL);
+
+        check_socket_error(ret);
+
+        size_t sent = std::max<ssize_t>(0, ret);
+        if (sent == 0) {
+            break;
+        }
+
+        IPX_CTX_DEBUG(m_log_ctx, "Sent %zu/%" PRIu16 " B of a spooled message to %s", sent, length, m_ident.c_str());
+
+        if (sent < length) {
+            Transfer transfer;
+            transfer.data.assign(data + sent, data + length);
+            transfer.offset = 0;
+            m_transfers.push_back(std::move(transfer));
+        }
+
+        // The rest of the spool depends on the templates that have just been sent
+        m_spool->pop();
+        m_spool_synced = false;
+    }
 }
 
 bool
@@ -197,12 +330,23 @@ Connection::store_unfinished_transfer(Message &msg, uint16_t offset)
 void
 Connection::send_message(Message &msg)
 {
+    // Messages wait in the spool while the connection is not available and until the spool is drained
+    if (m_spool && (m_spool_forced || m_sockfd.get() < 0 || !m_transfers.empty() || !m_spool->empty())) {
+        spool_message(msg);
+        return;
+    }
+
     // All waiting transfers have to be sent first
     if (!m_transfers.empty()) {
         store_unfinished_transfer(msg, 0);
         return;
     }
 
+    if (m_batch_size > 1) {
+        batch_message(msg);
+        return;
+    }
+
     std::vector<iovec> &parts = msg.parts();
 
     msghdr hdr;
@@ -223,25 +367,91 @@ Connection::send_message(Message &msg)
     }
 }
 
+void
+Connection::batch_message(Message &msg)
+{
+    if (m_batch.lengths.empty()) {
+        m_batch.since = std::chrono::steady_clock::now();
+    }
+
+    // The message parts only live until the message is rebuilt, so the data has to be copied
+    for (const iovec &part : msg.parts()) {
+        const uint8_t *data = static_cast<const uint8_t *>(part.iov_base);
+        m_batch.data.insert(m_batch.data.end(), data, data + part.iov_len);
+    }
+
+    m_batch.lengths.push_back(msg.length());
+
+    if (m_batch.lengths.size() >= m_batch_size || m_batch.data.size() >= BATCH_MAX_BYTES) {
+        flush_batch();
+    }
+}
+
+void
+Connection::spool_message(Message &msg)
+{
+    if (m_spool->empty()) {
+        // Templates of all senders are cleared once the connection is lost, so the spool started while
+        // the connection is not available begins with templates and can be sent through a new connection
+        m_spool_synced = (m_sockfd.get() < 0);
+    }
+
+    bool stored;
+    try {
+        stored = m_spool->push(msg.parts(), msg.length());
+
+    } catch (const std::runtime_error &ex) {
+        IPX_CTX_ERROR(m_log_ctx, "Failed to spool a message to %s: %s", m_ident.c_str(), ex.what());
+        stored = false;
+    }
+
+    if (!stored) {
+        IPX_CTX_DEBUG(m_log_ctx, "Spool of connection to %s is full, dropping a message", m_ident.c_str());
+        m_spool_dropped = true;
+    }
+}
+
+void
+Connection::clear_templates_if_dropped()
+{
+    // The dropped message might have contained templates, the templates cannot be cleared while the sender
+    // is processing a message as it would set them again
+    if (!m_spool_dropped) {
+        return;
+    }
+
+    for (auto &p : m_senders) {
+        p.second->clear_templates();
+    }
+
+    m_spool_dropped = false;
+}
+
 Sender &
 Connection::get_or_create_sender(ipx_msg_ipfix_t *msg)
 {
     uint32_t odid = ipx_msg_ipfix_get_ctx(msg)->odid;
 
-    if (m_senders.find(odid) == m_senders.end()) {
-        m_senders.emplace(odid,
-            std::unique_ptr<Sender>(new Sender(
-                [&](Message &msg) {
-                    send_message(msg);
-                },
-                m_con_params.protocol == Protocol::TCP,
-                m_tmplts_resend_pkts,
-                m_tmplts_resend_secs)));
+    // Consecutive messages usually belong to the same ODID
+    if (m_last_sender && m_last_odid == odid) {
+        return *m_last_sender;
+    }
+
+    std::unique_ptr<Sender> &sender = m_senders[odid];
+    if (!sender) {
+        sender.reset(new Sender(
+            [&](Message &msg) {
+                send_message(msg);
+            },
+            m_con_params.protocol == Protocol::TCP,
+            m_tmplts_resend_pkts,
+            m_tmplts_resend_secs));
     }
 
-    Sender &sender = *m_senders[odid].get();
+    m_last_odid = odid;
+    m_last_sender = sender.get();
 
-    return sender;
+    return *sender;
 }
 
 void
@@ -256,6 +466,21 @@ Connection::check_socket_error(ssize_t sock_ret)
 
         // All state from the previous connection is lost once new one is estabilished
         m_transfers.clear();
+        m_batch.data.clear();
+        m_batch.lengths.clear();
+
+        // The spool can be sent through a new connection only if it doesn't depend on the templates
+        // sent through the lost one
+        if (m_spool && !m_spool->empty() && !m_spool_synced) {
+            IPX_CTX_WARNING(m_log_ctx, "Dropping %zu spooled messages to %s as they depend on the lost connection",
+                            m_spool->size(), m_ident.c_str());
+            m_spool->clear();
+        }
+
+        // The lost data might have contained templates of any ODID
+        for (auto &p : m_senders) {
+            p.second->clear_templates();
+        }
 
         throw ConnectionError(errbuf);
     }
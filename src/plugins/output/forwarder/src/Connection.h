@@ -45,12 +45,15 @@
 #include <unordered_map>
 #include <memory>
 #include <atomic>
+#include <chrono>
 
 #include <ipfixcol2.h>
 
 #include "common.h"
 #include "connector/Connector.h"
 #include "Sender.h"
+#include "Spool.h"
+#include "Config.h"
 
 class Connection;
 
@@ -75,12 +78,25 @@ private:
     std::shared_ptr<Connection> *m_connection;
 };
 
+/// The maximal number of bytes of messages in a batch, the batch is sent once it is exceeded
+constexpr size_t BATCH_MAX_BYTES = 256 * 1024;
+
 /// A transfer to be sent through the connection
 struct Transfer {
-    /// The data to send
+    /// The data to send (one message for UDP, possibly more messages for TCP)
     std::vector<uint8_t> data;
     /// The offset to send from, i.e. the amount of data that was already sent
-    uint16_t offset;
+    size_t offset;
+};
+
+/// Messages waiting to be sent together
+struct Batch {
+    /// The data of the messages stored one after another
+    std::vector<uint8_t> data;
+    /// The lengths of the messages
+    std::vector<uint16_t> lengths;
+    /// The time the first message was added
+    std::chrono::steady_clock::time_point since;
 };
 
 /// A class representing one of the connections to the subcollector
@@ -94,10 +110,14 @@ public:
      * \param log_ctx             The logging context
      * \param tmplts_resend_pkts  Interval in packets after which templates are resend (UDP only)
      * \param tmplts_resend_secs  Interval in seconds after which templates are resend (UDP only)
+     * \param batch_size          The maximal number of messages sent together (1 = no batching)
+     * \param batch_timeout_us    The maximal time a message can wait in the batch (microseconds)
+     * \param spool_config        The limits of the spool of messages waiting for the connection
      */
     Connection(const std::string &ident, ConnectionParams con_params, ipx_ctx_t *log_ctx,
                unsigned int tmplts_resend_pkts, unsigned int tmplts_resend_secs,
-               Connector &connector);
+               unsigned int batch_size, unsigned int batch_timeout_us,
+               const SpoolConfig &spool_config, Connector &connector);
 
     /// Do not permit copying or moving as the connection holds a raw socket that is closed in the destructor
     /// (we could instead implement proper moving and copying behavior, but we don't really need it at the moment)
@@ -114,17 +134,46 @@ public:
     /**
      * \brief Forward an IPFIX message
      * \param msg  The IPFIX message
+     * \param sel  The data records to forward (nullptr = all)
      */
     void
-    forward_message(ipx_msg_ipfix_t *msg);
+    forward_message(ipx_msg_ipfix_t *msg, const DrecSelection *sel = nullptr);
 
     /**
      * \brief Lose an IPFIX message, i.e. update the internal state as if it has been forwarded
      *        even though it is not being sent
      * \param msg  The IPFIX message
+     * \param sel  The data records that were not forwarded (nullptr = all)
+     */
+    void
+    lose_message(ipx_msg_ipfix_t *msg, const DrecSelection *sel = nullptr);
+
+    /**
+     * \brief Store an IPFIX message in the spool to be forwarded once the connection is available
+     * \param msg  The IPFIX message
+     * \param sel  The data records to store (nullptr = all)
+     * \warning The spool MUST be enabled
+     */
+    void
+    store_message(ipx_msg_ipfix_t *msg, const DrecSelection *sel = nullptr);
+
+    /**
+     * \brief Send the batched messages
+     *
+     * UDP messages are sent by one sendmmsg call, TCP messages by one send call. The part that
+     * couldn't be sent is stored as unfinished transfers.
+     * \throw ConnectionError if the connection was lost
+     */
+    void
+    flush_batch();
+
+    /**
+     * \brief Send the batched messages if the oldest of them has waited for too long
+     * \param now  The current time
+     * \throw ConnectionError if the connection was lost
      */
     void
-    lose_message(ipx_msg_ipfix_t *msg);
+    flush_expired(std::chrono::steady_clock::time_point now);
 
     /**
      * \brief Advance the unfinished transfers
@@ -144,6 +193,24 @@ public:
      */
     size_t waiting_transfers_cnt() const { return m_transfers.size(); }
 
+    /**
+     * \brief Get number of messages waiting in the batch
+     * \return The number of batched messages
+     */
+    size_t batched_messages_cnt() const { return m_batch.lengths.size(); }
+
+    /**
+     * \brief Check if the spool of messages waiting for the connection is enabled
+     * \return true or false
+     */
+    bool spool_enabled() const { return m_spool != nullptr; }
+
+    /**
+     * \brief Get number of messages waiting in the spool
+     * \return The number of spooled messages
+     */
+    size_t spooled_messages_cnt() const { return m_spool ? m_spool->size() : 0; }
+
     /**
      * \brief The identification of the connection
      */
@@ -160,14 +227,38 @@ private:
 
     unsigned int m_tmplts_resend_secs;
 
+    unsigned int m_batch_size;
+
+    std::chrono::microseconds m_batch_timeout;
+
     UniqueFd m_sockfd;
 
     std::shared_ptr<FutureSocket> m_future_socket;
 
     std::unordered_map<uint32_t, std::unique_ptr<Sender>> m_senders;
 
+    /// The ODID of the last used sender
+    uint32_t m_last_odid = 0;
+
+    /// The last used sender (senders are never removed, so the pointer stays valid)
+    Sender *m_last_sender = nullptr;
+
     std::vector<Transfer> m_transfers;
 
+    Batch m_batch;
+
+    /// Messages waiting for the connection (nullptr = disabled)
+    std::unique_ptr<Spool> m_spool;
+
+    /// The spool starts with templates, i.e. it doesn't depend on the state of the connection
+    bool m_spool_synced = false;
+
+    /// Store the emitted messages in the spool even if they could be sent
+    bool m_spool_forced = false;
+
+    /// A spooled message has been dropped, so the templates have to be sent again
+    bool m_spool_dropped = false;
+
     Connector &m_connector;
 
     void
@@ -176,6 +267,18 @@ private:
     void
     send_message(Message &msg);
 
+    void
+    batch_message(Message &msg);
+
+    void
+    spool_message(Message &msg);
+
+    void
+    drain_spool();
+
+    void
+    clear_templates_if_dropped();
+
     Sender &
     get_or_create_sender(ipx_msg_ipfix_t *msg);
 
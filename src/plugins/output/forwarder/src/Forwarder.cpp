@@ -41,6 +41,25 @@
 
 #include "Forwarder.h"
 
+#include <algorithm>
+#include <cinttypes>
+#include <cstring>
+
+/// The number of points on the hash ring per host, more points distribute the load more evenly
+static constexpr unsigned int RING_POINTS_PER_HOST = 128;
+/// The index of no host on the hash ring
+static constexpr size_t NO_HOST = SIZE_MAX;
+/// The target of a data record that couldn't be forwarded to any host (split mode only)
+static constexpr size_t DROPPED = SIZE_MAX - 1;
+
+/// IANA identifiers of the Information Elements records can be split by
+enum split_ie : uint16_t {
+    IE_SRC_IP4 = 8,
+    IE_DST_IP4 = 12,
+    IE_SRC_IP6 = 27,
+    IE_DST_IP6 = 28
+};
+
 Forwarder::Forwarder(Config config, ipx_ctx_t *log_ctx) :
     m_config(config),
     m_log_ctx(log_ctx)
@@ -52,7 +71,7 @@ Forwarder::Forwarder(Config config, ipx_ctx_t *log_ctx) :
     }
 
     m_connector.reset(new Connector(con_params, m_config.nb_premade_connections,
-                                    m_config.reconnect_secs, m_log_ctx));
+                                    m_config.reconnect_secs, m_log_ctx, m_config.connector_thread));
 
     // Set up hosts
     for (const auto &host_config : m_config.hosts) {
@@ -63,9 +82,36 @@ Forwarder::Forwarder(Config config, ipx_ctx_t *log_ctx) :
                      m_config.tmplts_resend_pkts,
                      m_config.tmplts_resend_secs,
                      m_config.forward_mode == ForwardMode::SENDTOALL,
+                     m_config.batch_size,
+                     m_config.batch_timeout_us,
+                     m_config.spool,
                      *m_connector.get()));
 
     }
+
+    if (m_config.forward_mode == ForwardMode::HASH || m_config.forward_mode == ForwardMode::SPLIT) {
+        build_ring();
+    }
+}
+
+void
+Forwarder::build_ring()
+{
+    // The points depend only on the address and port, so the hosts keep their positions
+    // regardless of their order and of the other hosts in the configuration
+    for (size_t i = 0; i < m_config.hosts.size(); i++) {
+        const HostConfig &host_config = m_config.hosts[i];
+        const std::string key = host_config.address + ":" + std::to_string(host_config.port);
+        const uint64_t host_hash = hash_fnv1a(key.data(), key.size());
+
+        for (uint32_t point = 0; point < RING_POINTS_PER_HOST; point++) {
+            m_ring.emplace_back(hash_fnv1a(&point, sizeof(point), host_hash), i);
+        }
+    }
+
+    std::sort(m_ring.begin(), m_ring.end());
+    m_ring_failed.resize(m_hosts.size());
+    m_split_counts.resize(m_hosts.size());
 }
 
 void Forwarder::handle_session_message(ipx_msg_session_t *msg)
@@ -87,6 +133,8 @@ void Forwarder::handle_session_message(ipx_msg_session_t *msg)
         }
         break;
     }
+
+    advance_connections();
 }
 
 void Forwarder::handle_ipfix_message(ipx_msg_ipfix_t *msg)
@@ -101,8 +149,36 @@ void Forwarder::handle_ipfix_message(ipx_msg_ipfix_t *msg)
         forward_round_robin(msg);
         break;
 
+    case ForwardMode::HASH:
+        forward_hash(msg);
+        break;
+
+    case ForwardMode::SPLIT:
+        forward_split(msg);
+        break;
+
     default: assert(0);
     }
+
+    advance_connections();
+}
+
+void
+Forwarder::advance_connections()
+{
+    // There is no timer, so the connections, batches and spools are checked whenever the plugin receives a message
+    if (!m_config.connector_thread) {
+        m_connector->advance();
+    }
+
+    if (m_config.batch_size <= 1 && !m_config.spool.enabled()) {
+        return;
+    }
+
+    const auto now = std::chrono::steady_clock::now();
+    for (auto &host : m_hosts) {
+        host->advance_connections(now);
+    }
 }
 
 void
@@ -117,6 +193,7 @@ void
 Forwarder::forward_round_robin(ipx_msg_ipfix_t *msg)
 {
     bool ok = false;
+    size_t first_idx = m_rr_index;
 
     for (size_t i = 0; i < m_hosts.size(); i++) {
         auto &host = m_hosts[m_rr_index];
@@ -127,7 +204,210 @@ Forwarder::forward_round_robin(ipx_msg_ipfix_t *msg)
         }
     }
 
-    if (!ok) {
+    // Keep the message until the host is available
+    if (!ok && !m_hosts[first_idx]->store_message(msg)) {
         IPX_CTX_WARNING(m_log_ctx, "Couldn't forward to any of the hosts, dropping message!", 0);
     }
 }
+
+/**
+ * \brief Find the host of a key on the hash ring, i.e. the first host clockwise from the key that hasn't failed
+ * \param key  The key
+ * \return The index of the host or NO_HOST if all the hosts have failed
+ */
+size_t
+Forwarder::ring_lookup(uint64_t key) const
+{
+    auto it = std::lower_bound(m_ring.begin(), m_ring.end(), std::make_pair(key, size_t(0)));
+
+    for (size_t i = 0; i < m_ring.size(); i++, it++) {
+        if (it == m_ring.end()) {
+            it = m_ring.begin();
+        }
+
+        if (!m_ring_failed[it->second]) {
+            return it->second;
+        }
+    }
+
+    return NO_HOST;
+}
+
+/**
+ * \brief Get the key of a message for the hash ring
+ * \param msg  The IPFIX message
+ * \return The hash of the session identification and the ODID
+ */
+static uint64_t
+session_key(ipx_msg_ipfix_t *msg)
+{
+    const ipx_msg_ctx *ctx = ipx_msg_ipfix_get_ctx(msg);
+    const char *ident = ctx->session->ident;
+    const uint32_t odid = ctx->odid;
+
+    uint64_t key = hash_fnv1a(ident, strlen(ident));
+    return hash_fnv1a(&odid, sizeof(odid), key);
+}
+
+void
+Forwarder::forward_hash(ipx_msg_ipfix_t *msg)
+{
+    const uint64_t key = session_key(msg);
+
+    // If the host of the key is not available, the following hosts on the ring are tried, so only
+    // the messages of the unavailable host are redistributed (and they return once the host is
+    // available again)
+    std::fill(m_ring_failed.begin(), m_ring_failed.end(), false);
+    const size_t first_idx = ring_lookup(key);
+    size_t host_idx;
+
+    while ((host_idx = ring_lookup(key)) != NO_HOST) {
+        if (m_hosts[host_idx]->forward_message(msg)) {
+            return;
+        }
+
+        m_ring_failed[host_idx] = true;
+    }
+
+    // Keep the message until the host is available
+    if (first_idx != NO_HOST && m_hosts[first_idx]->store_message(msg)) {
+        return;
+    }
+
+    IPX_CTX_WARNING(m_log_ctx, "Couldn't forward to any of the hosts, dropping message!", 0);
+}
+
+/**
+ * \brief Get the hash of the split key of a data record
+ * \param rec       The data record
+ * \param fallback  The hash to use if the record doesn't contain the key
+ * \return The hash of the IP address prefix
+ */
+uint64_t
+Forwarder::split_key(fds_drec &rec, uint64_t fallback) const
+{
+    const bool src = (m_config.split_key == SplitKey::SRC_IP);
+    fds_drec_field field;
+    unsigned int prefix;
+
+    if (fds_drec_find(&rec, 0, src ? IE_SRC_IP4 : IE_DST_IP4, &field) != FDS_EOC && field.size == 4) {
+        prefix = m_config.split_prefix4;
+
+    } else if (fds_drec_find(&rec, 0, src ? IE_SRC_IP6 : IE_DST_IP6, &field) != FDS_EOC && field.size == 16) {
+        prefix = m_config.split_prefix6;
+
+    } else {
+        return fallback;
+    }
+
+    // Mask the address and hash the prefix (the size distinguishes IPv4 and IPv6 prefixes)
+    uint8_t addr[16] = {0};
+    memcpy(addr, field.data, prefix / 8);
+    if (prefix % 8 != 0) {
+        addr[prefix / 8] = field.data[prefix / 8] & (uint8_t) (0xFF << (8 - prefix % 8));
+    }
+
+    uint64_t key = hash_fnv1a(&field.size, sizeof(field.size));
+    return hash_fnv1a(addr, field.size, key);
+}
+
+void
+Forwarder::forward_split(ipx_msg_ipfix_t *msg)
+{
+    const uint32_t drec_cnt = ipx_msg_ipfix_get_drec_cnt(msg);
+    const uint64_t fallback = session_key(msg);
+
+    m_split_keys.resize(drec_cnt);
+    m_split_targets.resize(drec_cnt);
+    std::fill(m_ring_failed.begin(), m_ring_failed.end(), false);
+
+    for (uint32_t i = 0; i < drec_cnt; i++) {
+        m_split_keys[i] = split_key(ipx_msg_ipfix_get_drec(msg, i)->rec, fallback);
+        m_split_targets[i] = ring_lookup(m_split_keys[i]);
+    }
+
+    // Records of hosts that couldn't receive them are moved to the next hosts on the ring and sent again
+    uint32_t pending = drec_cnt;
+    uint32_t dropped = 0;
+
+    while (pending > 0) {
+        bool failed = false;
+        split_count();
+
+        for (size_t host_idx = 0; host_idx < m_hosts.size(); host_idx++) {
+            if (m_split_counts[host_idx] == 0) {
+                continue;
+            }
+
+            DrecSelection sel{&m_split_targets, host_idx, m_split_counts[host_idx]};
+            if (!m_hosts[host_idx]->forward_message(msg, &sel)) {
+                m_ring_failed[host_idx] = true;
+                failed = true;
+            }
+        }
+
+        pending = 0;
+        for (uint32_t i = 0; i < drec_cnt; i++) {
+            size_t &target = m_split_targets[i];
+            if (target == NO_HOST || target == DROPPED) {
+                continue;
+            }
+
+            if (!failed || !m_ring_failed[target]) {
+                // Delivered
+                target = NO_HOST;
+                continue;
+            }
+
+            target = ring_lookup(m_split_keys[i]);
+            if (target == NO_HOST) {
+                target = DROPPED;
+                dropped++;
+            } else {
+                pending++;
+            }
+        }
+    }
+
+    if (dropped > 0 && m_config.spool.enabled()) {
+        // Keep the records until their hosts are available
+        std::fill(m_ring_failed.begin(), m_ring_failed.end(), false);
+
+        for (uint32_t i = 0; i < drec_cnt; i++) {
+            if (m_split_targets[i] == DROPPED) {
+                m_split_targets[i] = ring_lookup(m_split_keys[i]);
+            }
+        }
+
+        split_count();
+
+        for (size_t host_idx = 0; host_idx < m_hosts.size(); host_idx++) {
+            if (m_split_counts[host_idx] > 0) {
+                DrecSelection sel{&m_split_targets, host_idx, m_split_counts[host_idx]};
+                m_hosts[host_idx]->store_message(msg, &sel);
+            }
+        }
+
+        dropped = 0;
+    }
+
+    if (dropped > 0) {
+        IPX_CTX_WARNING(m_log_ctx, "Couldn't forward %" PRIu32 " records to any of the hosts, dropping them!",
+                        dropped);
+    }
+}
+
+/**
+ * \brief Count the data records of the current message per target host (split mode only)
+ */
+void
+Forwarder::split_count()
+{
+    std::fill(m_split_counts.begin(), m_split_counts.end(), 0);
+
+    for (size_t target : m_split_targets) {
+        if (target < m_hosts.size()) {
+            m_split_counts[target]++;
+        }
+    }
+}
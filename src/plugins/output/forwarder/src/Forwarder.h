@@ -94,6 +94,21 @@ private:
 
     size_t m_rr_index = 0;
 
+    /// The hash ring of the hosts, i.e. pairs of a point on the ring and an index of the host sorted by the points
+    std::vector<std::pair<uint64_t, size_t>> m_ring;
+
+    /// Flags of the hosts that failed to receive the current message, they are skipped on the ring
+    std::vector<bool> m_ring_failed;
+
+    /// The hash of the split key of each data record of the current message (split mode only)
+    std::vector<uint64_t> m_split_keys;
+
+    /// The index of the target host of each data record of the current message (split mode only)
+    std::vector<size_t> m_split_targets;
+
+    /// The number of data records of the current message per target host (split mode only)
+    std::vector<uint32_t> m_split_counts;
+
     std::unique_ptr<Connector> m_connector;
 
     void
@@ -101,4 +116,25 @@ private:
 
     void
     forward_round_robin(ipx_msg_ipfix_t *msg);
+
+    void
+    forward_hash(ipx_msg_ipfix_t *msg);
+
+    void
+    forward_split(ipx_msg_ipfix_t *msg);
+
+    void
+    split_count();
+
+    void
+    build_ring();
+
+    size_t
+    ring_lookup(uint64_t key) const;
+
+    uint64_t
+    split_key(fds_drec &rec, uint64_t fallback) const;
+
+    void
+    advance_connections();
 };
\ No newline at end of file
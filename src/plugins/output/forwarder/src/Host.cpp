@@ -44,6 +44,7 @@
 
 Host::Host(const std::string &ident, ConnectionParams con_params, ipx_ctx_t *log_ctx,
            unsigned int tmplts_resend_pkts, unsigned int tmplts_resend_secs, bool indicate_lost_msgs,
+           unsigned int batch_size, unsigned int batch_timeout_us, const SpoolConfig &spool_config,
            Connector &connector) :
     m_ident(ident),
     m_con_params(con_params),
@@ -51,6 +52,9 @@ Host::Host(const std::string &ident, ConnectionParams con_params, ipx_ctx_t *log
     m_tmplts_resend_pkts(tmplts_resend_pkts),
     m_tmplts_resend_secs(tmplts_resend_secs),
     m_indicate_lost_msgs(indicate_lost_msgs),
+    m_batch_size(batch_size),
+    m_batch_timeout_us(batch_timeout_us),
+    m_spool_config(spool_config),
     m_connector(connector)
 {
 }
@@ -71,6 +75,9 @@ Host::setup_connection(const ipx_session *session)
             m_log_ctx,
             m_tmplts_resend_pkts,
             m_tmplts_resend_secs,
+            m_batch_size,
+            m_batch_timeout_us,
+            m_spool_config,
             m_connector)));
     m_session_to_connection[session]->connect();
 }
@@ -88,6 +95,7 @@ Host::finish_connection(const ipx_session *session)
     if (connection->check_connected()) {
 
         try {
+            connection->flush_batch();
             connection->advance_transfers();
 
         } catch (const ConnectionError &) {
@@ -100,20 +108,25 @@ Host::finish_connection(const ipx_session *session)
                         connection->waiting_transfers_cnt());
     }
 
+    if (connection->spooled_messages_cnt() > 0) {
+        IPX_CTX_WARNING(m_log_ctx, "Dropping %zu spooled messages when finishing connection",
+                        connection->spooled_messages_cnt());
+    }
+
     IPX_CTX_INFO(m_log_ctx, "Connection to %s finished", m_ident.c_str());
 
     m_session_to_connection.erase(session);
 }
 
 bool
-Host::forward_message(ipx_msg_ipfix_t *msg)
+Host::forward_message(ipx_msg_ipfix_t *msg, const DrecSelection *sel)
 {
     const ipx_session *session = ipx_msg_ipfix_get_ctx(msg)->session;
     Connection &connection = *m_session_to_connection[session].get();
 
     if (!connection.check_connected()) {
         if (m_indicate_lost_msgs) {
-            connection.lose_message(msg);
+            lose_message(connection, msg, sel);
         }
         return false;
     }
@@ -121,17 +134,17 @@ Host::forward_message(ipx_msg_ipfix_t *msg)
     try {
         connection.advance_transfers();
 
-        if (connection.waiting_transfers_cnt() > 0) {
+        if (connection.waiting_transfers_cnt() > 0 || connection.spooled_messages_cnt() > 0) {
             IPX_CTX_DEBUG(m_log_ctx, "Message to %s not forwarded because there are unsent transfers\n", m_ident.c_str());
             if (m_indicate_lost_msgs) {
-                connection.lose_message(msg);
+                lose_message(connection, msg, sel);
             }
             return false;
         }
 
         IPX_CTX_DEBUG(m_log_ctx, "Forwarding message to %s\n", m_ident.c_str());
 
-        connection.forward_message(msg);
+        connection.forward_message(msg, sel);
 
     } catch (const ConnectionError &err) {
         IPX_CTX_ERROR(m_log_ctx, "Lost connection while forwarding: %s", err.what());
@@ -142,6 +155,51 @@ Host::forward_message(ipx_msg_ipfix_t *msg)
     return true;
 }
 
+bool
+Host::store_message(ipx_msg_ipfix_t *msg, const DrecSelection *sel)
+{
+    if (!m_spool_config.enabled()) {
+        return false;
+    }
+
+    const ipx_session *session = ipx_msg_ipfix_get_ctx(msg)->session;
+    m_session_to_connection[session]->store_message(msg, sel);
+    return true;
+}
+
+void
+Host::lose_message(Connection &connection, ipx_msg_ipfix_t *msg, const DrecSelection *sel)
+{
+    if (connection.spool_enabled()) {
+        connection.store_message(msg, sel);
+    } else {
+        connection.lose_message(msg, sel);
+    }
+}
+
+void
+Host::advance_connections(std::chrono::steady_clock::time_point now)
+{
+    for (auto &p : m_session_to_connection) {
+        Connection &connection = *p.second.get();
+
+        // Messages are only batched while the connection is connected
+        if (connection.batched_messages_cnt() == 0
+                && (connection.spooled_messages_cnt() == 0 || !connection.check_connected())) {
+            continue;
+        }
+
+        try {
+            connection.flush_expired(now);
+            connection.advance_transfers();
+
+        } catch (const ConnectionError &err) {
+            IPX_CTX_ERROR(m_log_ctx, "Lost connection while forwarding: %s", err.what());
+            connection.connect();
+        }
+    }
+}
+
 Host::~Host()
 {
     for (auto &p : m_session_to_connection) {
@@ -151,6 +209,7 @@ Host::~Host()
         if (connection->check_connected()) {
 
             try {
+                connection->flush_batch();
                 connection->advance_transfers();
 
             } catch (const ConnectionError &) {
@@ -162,6 +221,11 @@ Host::~Host()
             IPX_CTX_WARNING(m_log_ctx, "Dropping %zu transfers when closing connection %s",
                             connection->waiting_transfers_cnt(), connection->ident().c_str());
         }
+
+        if (connection->spooled_messages_cnt() > 0) {
+            IPX_CTX_WARNING(m_log_ctx, "Dropping %zu spooled messages when closing connection %s",
+                            connection->spooled_messages_cnt(), connection->ident().c_str());
+        }
     }
 
     IPX_CTX_INFO(m_log_ctx, "All connections to %s closed", m_ident.c_str());
@@ -43,6 +43,7 @@
 
 #include <unordered_map>
 #include <memory>
+#include <chrono>
 #include <ipfixcol2.h>
 #include "common.h"
 #include "Config.h"
@@ -61,9 +62,14 @@ public:
      * \param tmplts_resend_secs         Interval in seconds after which templates are resend (UDP only)
      * \param indicate_lost_msgs         Indicate that the message has been lost if it couldn't be forwarded
      *                                   by increasing the sequence numbers
+     * \param batch_size                 The maximal number of messages sent together (1 = no batching)
+     * \param batch_timeout_us           The maximal time a message can wait in a batch (microseconds)
+     * \param spool_config               The limits of the spool of messages waiting for a connection,
+     *                                   lost messages are stored in the spool instead if it's enabled
      */
     Host(const std::string &ident, ConnectionParams con_params, ipx_ctx_t *log_ctx,
          unsigned int tmplts_resend_pkts, unsigned int tmplts_resend_secs, bool indicate_lost_msgs,
+         unsigned int batch_size, unsigned int batch_timeout_us, const SpoolConfig &spool_config,
          Connector &connector);
 
     /**
@@ -94,11 +100,29 @@ public:
     /**
      * \brief Forward an IPFIX message to this host
      * \param msg  The IPFIX message
+     * \param sel  The data records to forward (nullptr = all)
      * \return true on success, false on failure
      * \throw ConnectionError when the connection fails
      */
     bool
-    forward_message(ipx_msg_ipfix_t *msg);
+    forward_message(ipx_msg_ipfix_t *msg, const DrecSelection *sel = nullptr);
+
+    /**
+     * \brief Store an IPFIX message in the spool to be forwarded to this host once it's available
+     * \param msg  The IPFIX message
+     * \param sel  The data records to store (nullptr = all)
+     * \return true on success, false if the spool is not enabled
+     */
+    bool
+    store_message(ipx_msg_ipfix_t *msg, const DrecSelection *sel = nullptr);
+
+    /**
+     * \brief Send the batched messages of connections where they have waited for too long and the
+     *        spooled messages of connections that are available
+     * \param now  The current time
+     */
+    void
+    advance_connections(std::chrono::steady_clock::time_point now);
 
 private:
     const std::string &m_ident;
@@ -113,7 +137,16 @@ private:
 
     bool m_indicate_lost_msgs;
 
+    unsigned int m_batch_size;
+
+    unsigned int m_batch_timeout_us;
+
+    SpoolConfig m_spool_config;
+
     Connector &m_connector;
 
     std::unordered_map<const ipx_session *, std::unique_ptr<Connection>> m_session_to_connection;
+
+    void
+    lose_message(Connection &connection, ipx_msg_ipfix_t *msg, const DrecSelection *sel);
 };
\ No newline at end of file
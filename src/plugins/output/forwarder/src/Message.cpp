@@ -68,6 +68,24 @@ Message::add_set(const fds_ipfix_set_hdr *set)
     m_current_set_hdr = nullptr;
 }
 
+void
+Message::add_record(uint16_t set_id, const uint8_t *data, uint16_t length)
+{
+    require_set(set_id);
+
+    iovec *last = &m_parts.back();
+    if (!m_last_part_from_buffer && (const uint8_t *) last->iov_base + last->iov_len == data) {
+        // The record directly follows the previous one
+        last->iov_len += length;
+        m_length += length;
+
+    } else {
+        add_part((uint8_t *) data, length);
+    }
+
+    m_current_set_hdr->length += length;
+}
+
 void
 Message::add_template(const fds_template *tmplt)
 {
@@ -72,6 +72,17 @@ public:
     void
     add_set(const fds_ipfix_set_hdr *set);
 
+    /**
+     * \brief Add a data record to a data set
+     * \param set_id  The ID of the data set (i.e. the template ID)
+     * \param data    Pointer to the record
+     * \param length  The length of the record
+     * \warning No data is copied, the pointer is stored directly (records following each other in memory
+     *          are merged into one part)
+     */
+    void
+    add_record(uint16_t set_id, const uint8_t *data, uint16_t length);
+
     /**
      * \brief Add a template
      * \param tmplt  The template
@@ -42,52 +42,26 @@
 #include "Sender.h"
 #include <libfds.h>
 
-class DrecsForwardIterator {
-public:
-    DrecsForwardIterator(ipx_msg_ipfix_t *msg) : m_msg(msg) {}
-
-    ipx_ipfix_record *
-    get_drec_after_set(fds_ipfix_set_hdr *set_hdr)
-    {
-        uint32_t drec_cnt = ipx_msg_ipfix_get_drec_cnt(m_msg);
-        uint8_t *set_end = (uint8_t *) set_hdr + ntohs(set_hdr->length);
-
-        for (; m_idx < drec_cnt; m_idx++) {
-            ipx_ipfix_record *drec = ipx_msg_ipfix_get_drec(m_msg, m_idx);
-            if (drec->rec.data > set_end) {
-                return drec;
-            }
-        }
-
-        return nullptr;
-    }
-
-    ipx_ipfix_record *
-    get_drec_in_set(fds_ipfix_set_hdr *set_hdr)
-    {
-        uint32_t drec_cnt = ipx_msg_ipfix_get_drec_cnt(m_msg);
-        uint8_t *set_start = (uint8_t *) set_hdr;
-        uint8_t *set_end = (uint8_t *) set_hdr + ntohs(set_hdr->length);
-
-        for (; m_idx < drec_cnt; m_idx++) {
-            ipx_ipfix_record *drec = ipx_msg_ipfix_get_drec(m_msg, m_idx);
-            if (drec->rec.data >= set_end) {
-                return nullptr;
-            }
-            if (drec->rec.data >= set_start) {
-                return drec;
-            }
+/**
+ * \brief Find the template snapshot of the first set with parsed data records
+ *
+ * \param sets      The sets of the message
+ * \param num_sets  The number of the sets
+ * \param start     The index of the set to start from
+ *
+ * \return The template snapshot or nullptr if there is no such set
+ */
+static const fds_tsnapshot_t *
+find_tsnap(const ipx_ipfix_set *sets, size_t num_sets, size_t start)
+{
+    for (size_t i = start; i < num_sets; i++) {
+        if (sets[i].drec_cnt > 0) {
+            return sets[i].snap;
         }
-
-        return nullptr;
     }
 
-    uint32_t idx() const { return m_idx; }
-
-private:
-    ipx_msg_ipfix_t *m_msg;
-    uint32_t m_idx = 0;
-};
+    return nullptr;
+}
 
 Sender::Sender(std::function<void(Message &)> emit_callback, bool do_withdrawals,
                unsigned int tmplts_resend_pkts, unsigned int tmplts_resend_secs) :
@@ -99,7 +73,7 @@ Sender::Sender(std::function<void(Message &)> emit_callback, bool do_withdrawals
 }
 
 void
-Sender::process_message(ipx_msg_ipfix_t *msg)
+Sender::process_message(ipx_msg_ipfix_t *msg, const DrecSelection *sel)
 {
     // Get current real time
     timespec realtime_ts;
@@ -117,71 +91,82 @@ Sender::process_message(ipx_msg_ipfix_t *msg)
     // Get current time
     time_t now = get_monotonic_time();
 
-    // Send templates update if necessary and possible
-    ipx_ipfix_record *drec = ipx_msg_ipfix_get_drec(msg, 0);
+    // Get sets from the message, the number of data records and the template snapshot of each set
+    // is available even if references to the data records are not (i.e. in relay mode)
+    ipx_ipfix_set *sets;
+    size_t num_sets;
+    ipx_msg_ipfix_get_sets(msg, &sets, &num_sets);
 
-    if (drec) {
+    // Send templates update if necessary and possible
+    const fds_tsnapshot_t *first_tsnap = find_tsnap(sets, num_sets, 0);
 
-        const fds_tsnapshot_t *tsnap = drec->rec.snap;
+    if (first_tsnap) {
 
         // If templates changed or any of the resend intervals elapsed
-        if (m_tsnap != tsnap
+        if (m_tsnap != first_tsnap
                 || (m_tmplts_resend_pkts != 0 && m_pkts_since_tmplts_sent >= m_tmplts_resend_pkts)
                 || (m_tmplts_resend_secs != 0 && now - m_last_tmplts_sent_time >= m_tmplts_resend_secs)) {
 
-            process_templates(tsnap, m_seq_num);
+            process_templates(first_tsnap, m_seq_num);
         }
     }
 
-    // Get sets from the message
-    ipx_ipfix_set *sets;
-    size_t num_sets;
-    ipx_msg_ipfix_get_sets(msg, &sets, &num_sets);
+    // The index of the first data record of the current set
+    uint32_t drec_idx = 0;
 
-    // For walking through the parsed ipfix records of the message to get a parsed ipfix record
-    // belonging to a set to retieve e.g. a template snapshot from it
-    DrecsForwardIterator drecs_iter(msg);
+    // The number of data records added to the message
+    uint32_t drecs_added = 0;
 
     for (size_t i = 0; i < num_sets; i++) {
 
         fds_ipfix_set_hdr *set_hdr = sets[i].ptr;
         uint16_t set_id = ntohs(set_hdr->flowset_id);
+        uint32_t set_drec_cnt = sets[i].drec_cnt;
 
         // If it's not a template set, add the set as is
         if (set_id != FDS_IPFIX_SET_TMPLT && set_id != FDS_IPFIX_SET_OPTS_TMPLT) {
 
-            ipx_ipfix_record *drec = drecs_iter.get_drec_in_set(set_hdr);
-
-            if (!drec) {
+            if (set_drec_cnt == 0) {
                 // No parsed data record belonging to the set means we don't have a template
                 // Skip the data set
                 continue;
             }
 
-            m_message.add_set(set_hdr);
+            if (!sel) {
+                m_message.add_set(set_hdr);
+                drec_idx += set_drec_cnt;
+                continue;
+            }
+
+            // Add only the selected records of the set, the records themselves are not copied
+            for (uint32_t idx = drec_idx; idx < drec_idx + set_drec_cnt; idx++) {
+                if (sel->selected(idx)) {
+                    ipx_ipfix_record *drec = ipx_msg_ipfix_get_drec(msg, idx);
+                    m_message.add_record(set_id, drec->rec.data, drec->rec.size);
+                    drecs_added++;
+                }
+            }
+            drec_idx += set_drec_cnt;
             continue;
         }
 
         // It is a template set...
 
-        // Find first data record after the template set
-        ipx_ipfix_record *drec = drecs_iter.get_drec_after_set(set_hdr);
+        // Get template snapshot from the first data set after the template set
+        const fds_tsnapshot_t *tsnap = find_tsnap(sets, num_sets, i + 1);
 
         // The template set is at the end, we'll have to wait for next message to grab the template snapshot
-        if (!drec) {
+        if (!tsnap) {
             break;
         }
 
-        // Get template snapshot from the data record after template set
-        const fds_tsnapshot_t *tsnap = drec->rec.snap;
-
         // In case the template set is at the start of the message and we already sent the templates
         if (m_tsnap == tsnap) {
             continue;
         }
 
         // The next sequence number in case we'll need to start another message
-        uint32_t next_seq_num = m_seq_num + drecs_iter.idx();
+        uint32_t next_seq_num = m_seq_num + (sel ? drecs_added : drec_idx);
 
         process_templates(tsnap, next_seq_num);
     }
@@ -192,15 +177,26 @@ Sender::process_message(ipx_msg_ipfix_t *msg)
         emit_message();
     }
 
-    m_seq_num += ipx_msg_ipfix_get_drec_cnt(msg);
+    m_seq_num += sel ? sel->count : drec_idx;
     m_pkts_since_tmplts_sent++;
 }
 
 
 void
-Sender::lose_message(ipx_msg_ipfix_t *msg)
+Sender::lose_message(ipx_msg_ipfix_t *msg, const DrecSelection *sel)
 {
-    m_seq_num += ipx_msg_ipfix_get_drec_cnt(msg);
+    if (sel) {
+        m_seq_num += sel->count;
+        return;
+    }
+
+    ipx_ipfix_set *sets;
+    size_t num_sets;
+    ipx_msg_ipfix_get_sets(msg, &sets, &num_sets);
+
+    for (size_t i = 0; i < num_sets; i++) {
+        m_seq_num += sets[i].drec_cnt;
+    }
 }
 
 void
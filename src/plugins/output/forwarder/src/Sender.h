@@ -42,12 +42,26 @@
 #pragma once
 
 #include <functional>
+#include <vector>
 #include "Message.h"
 #include "common.h"
 #include <ipfixcol2.h>
 
 constexpr size_t TMPLTMSG_MAX_LENGTH = 2500; //NOTE: Maybe this should be configurable from the XML?
 
+/// A selection of data records of an IPFIX message to be forwarded to one of the hosts
+struct DrecSelection {
+    /// The index of the target host of each data record of the message
+    const std::vector<size_t> *targets;
+    /// The index of the host the records are selected for
+    size_t target;
+    /// The number of the selected records
+    uint32_t count;
+
+    /// Check if the data record with the index is selected
+    bool selected(uint32_t idx) const { return (*targets)[idx] == target; }
+};
+
 /// A class to emit the messages to be sent through the connection in the process of forwarding a message
 /// Each connection contains one sender per ODID
 class Sender {
@@ -65,17 +79,19 @@ public:
     /**
      * \brief Receive an IPFIX message and emit messages to be sent to the receiving host
      * \param msg  The IPFIX message
+     * \param sel  The data records to forward (nullptr = all)
      */
     void
-    process_message(ipx_msg_ipfix_t *msg);
+    process_message(ipx_msg_ipfix_t *msg, const DrecSelection *sel = nullptr);
 
     /**
      * \brief Lose an IPFIX message, i.e. update the internal state as if it has been forwarded
      *        even though it is not being sent
      * \param msg  The IPFIX message
+     * \param sel  The data records that were not forwarded (nullptr = all)
      */
     void
-    lose_message(ipx_msg_ipfix_t *msg);
+    lose_message(ipx_msg_ipfix_t *msg, const DrecSelection *sel = nullptr);
 
     /**
      * \brief Clear the templates state, i.e. force the templates to resend the next round
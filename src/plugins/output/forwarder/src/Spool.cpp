@@ -0,0 +1,229 @@
+/**
+ * \file src/plugins/output/forwarder/src/Spool.cpp
+ * \author agent <agent@local>
+ * \brief Spool class implementation
+ * \date 2026
+ */
+
+/* Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is'', and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#include "Spool.h"
+
+#include <cassert>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+/// Size of the length preceding each message in the file
+static constexpr size_t LENGTH_SIZE = sizeof(uint16_t);
+
+Spool::Spool(size_t mem_limit, size_t file_limit, const std::string &file_dir) :
+    m_mem_limit(mem_limit),
+    m_file_limit(file_limit),
+    m_file_dir(file_dir)
+{
+}
+
+Spool::~Spool()
+{
+    if (m_file_data) {
+        munmap(m_file_data, m_file_limit);
+    }
+}
+
+bool
+Spool::push(const std::vector<iovec> &parts, uint16_t length)
+{
+    uint8_t *dst;
+
+    // Messages are kept in memory unless there are already some messages in the file
+    if (m_file_cnt == 0 && m_mem_bytes + length <= m_mem_limit) {
+        m_mem.emplace_back(length);
+        m_mem_bytes += length;
+        dst = m_mem.back().data();
+
+    } else {
+        dst = file_reserve(LENGTH_SIZE + length);
+        if (!dst) {
+            return false;
+        }
+
+        memcpy(dst, &length, LENGTH_SIZE);
+        dst += LENGTH_SIZE;
+        m_file_cnt++;
+    }
+
+    for (const iovec &part : parts) {
+        memcpy(dst, part.iov_base, part.iov_len);
+        dst += part.iov_len;
+    }
+
+    return true;
+}
+
+const uint8_t *
+Spool::front(uint16_t &length) const
+{
+    assert(!empty());
+
+    if (!m_mem.empty()) {
+        length = m_mem.front().size();
+        return m_mem.front().data();
+    }
+
+    memcpy(&length, &m_file_data[m_file_head], LENGTH_SIZE);
+    return &m_file_data[m_file_head + LENGTH_SIZE];
+}
+
+void
+Spool::pop()
+{
+    assert(!empty());
+
+    if (!m_mem.empty()) {
+        m_mem_bytes -= m_mem.front().size();
+        m_mem.pop_front();
+        return;
+    }
+
+    uint16_t length;
+    memcpy(&length, &m_file_data[m_file_head], LENGTH_SIZE);
+    m_file_head += LENGTH_SIZE + length;
+    m_file_cnt--;
+
+    if (m_file_cnt == 0) {
+        m_file_head = 0;
+        m_file_tail = 0;
+        return;
+    }
+
+    // Skip the unused end of the file
+    uint16_t next_length = 0;
+    if (m_file_limit - m_file_head >= LENGTH_SIZE) {
+        memcpy(&next_length, &m_file_data[m_file_head], LENGTH_SIZE);
+    }
+
+    if (next_length == 0) {
+        m_file_head = 0;
+    }
+}
+
+void
+Spool::clear()
+{
+    m_mem.clear();
+    m_mem_bytes = 0;
+    m_file_cnt = 0;
+    m_file_head = 0;
+    m_file_tail = 0;
+}
+
+/**
+ * \brief Create and map the file
+ * \throw std::runtime_error on failure
+ */
+void
+Spool::file_map()
+{
+    std::string path = m_file_dir + "/ipfixcol2-forwarder-XXXXXX";
+    std::vector<char> path_buf(path.begin(), path.end());
+    path_buf.push_back('\0');
+
+    UniqueFd fd(mkstemp(path_buf.data()));
+    if (fd.get() < 0) {
+        throw errno_runtime_error(errno, "mkstemp");
+    }
+
+    // The file is only accessed through the mapping
+    unlink(path_buf.data());
+
+    if (ftruncate(fd.get(), m_file_limit) != 0) {
+        throw errno_runtime_error(errno, "ftruncate");
+    }
+
+    void *data = mmap(nullptr, m_file_limit, PROT_READ | PROT_WRITE, MAP_SHARED, fd.get(), 0);
+    if (data == MAP_FAILED) {
+        throw errno_runtime_error(errno, "mmap");
+    }
+
+    m_file_fd = std::move(fd);
+    m_file_data = static_cast<uint8_t *>(data);
+}
+
+/**
+ * \brief Reserve space for a message at the tail of the file
+ * \param size  The size of the message including its length
+ * \return Pointer to the space or nullptr if the file is full
+ * \throw std::runtime_error if the file couldn't be created
+ */
+uint8_t *
+Spool::file_reserve(size_t size)
+{
+    if (size > m_file_limit) {
+        return nullptr;
+    }
+
+    if (!m_file_data) {
+        file_map();
+    }
+
+    size_t pos = m_file_tail;
+
+    if (m_file_cnt == 0 || m_file_tail > m_file_head) {
+        // The free space is at the end and at the start of the file
+        if (m_file_limit - m_file_tail < size) {
+            if (m_file_cnt > 0 && m_file_head < size) {
+                return nullptr;
+            }
+
+            // Mark the unused end of the file and wrap around
+            if (m_file_limit - m_file_tail >= LENGTH_SIZE) {
+                memset(&m_file_data[m_file_tail], 0, LENGTH_SIZE);
+            }
+            pos = 0;
+        }
+
+    } else if (m_file_head - m_file_tail < size) {
+        // The free space is between the newest and the oldest message
+        return nullptr;
+    }
+
+    m_file_tail = pos + size;
+    return &m_file_data[pos];
+}
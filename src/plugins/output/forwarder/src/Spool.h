@@ -0,0 +1,149 @@
+/**
+ * \file src/plugins/output/forwarder/src/Spool.h
+ * \author agent <agent@local>
+ * \brief Spool class header
+ * \date 2026
+ */
+
+/* Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is'', and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#pragma once
+
+#include <deque>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <sys/uio.h>
+
+#include "common.h"
+
+/// A bounded FIFO of messages waiting to be sent through a connection
+///
+/// Messages are kept in memory until the memory limit is reached, further messages are spilled to
+/// a ring in a memory mapped file. Once anything is spilled, all following messages are spilled
+/// too (until the file is drained), so the order of the messages is kept.
+class Spool {
+public:
+    /**
+     * \brief The constructor
+     * \param mem_limit   The maximal number of bytes of messages kept in memory
+     * \param file_limit  The size of the file for spilled messages (0 = no file)
+     * \param file_dir    The directory to create the file in (the file is created once needed and
+     *                    it's unlinked immediately, so it's removed once the spool is destroyed)
+     */
+    Spool(size_t mem_limit, size_t file_limit, const std::string &file_dir);
+
+    /// Do not permit copying or moving as the spool holds the mapping of the file
+    Spool(const Spool &) = delete;
+    Spool(Spool &&) = delete;
+
+    /**
+     * \brief The destructor
+     */
+    ~Spool();
+
+    /**
+     * \brief Append a message
+     * \param parts   The message parts
+     * \param length  The total length of the message
+     * \return true on success, false if the spool is full
+     * \throw std::runtime_error if the file couldn't be created
+     */
+    bool
+    push(const std::vector<iovec> &parts, uint16_t length);
+
+    /**
+     * \brief Access the oldest message
+     * \param[out] length  The length of the message
+     * \return Pointer to the message, valid until the message is popped
+     * \warning The spool MUST NOT be empty
+     */
+    const uint8_t *
+    front(uint16_t &length) const;
+
+    /**
+     * \brief Remove the oldest message
+     * \warning The spool MUST NOT be empty
+     */
+    void
+    pop();
+
+    /**
+     * \brief Remove all messages
+     */
+    void
+    clear();
+
+    /**
+     * \brief Get the number of messages in the spool
+     * \return The number of messages
+     */
+    size_t size() const { return m_mem.size() + m_file_cnt; }
+
+    /**
+     * \brief Check if the spool is empty
+     * \return true or false
+     */
+    bool empty() const { return size() == 0; }
+
+private:
+    size_t m_mem_limit;
+
+    size_t m_mem_bytes = 0;
+
+    std::deque<std::vector<uint8_t>> m_mem;
+
+    size_t m_file_limit;
+
+    std::string m_file_dir;
+
+    UniqueFd m_file_fd;
+
+    uint8_t *m_file_data = nullptr;
+
+    /// Position of the oldest message in the file
+    size_t m_file_head = 0;
+
+    /// Position after the newest message in the file
+    size_t m_file_tail = 0;
+
+    size_t m_file_cnt = 0;
+
+    void
+    file_map();
+
+    uint8_t *
+    file_reserve(size_t size);
+};
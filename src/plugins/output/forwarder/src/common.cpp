@@ -89,6 +89,19 @@ get_monotonic_time()
     return ts.tv_sec;
 }
 
+uint64_t
+hash_fnv1a(const void *data, size_t size, uint64_t hash)
+{
+    const uint8_t *bytes = static_cast<const uint8_t *>(data);
+
+    for (size_t i = 0; i < size; i++) {
+        hash ^= bytes[i];
+        hash *= UINT64_C(1099511628211);
+    }
+
+    return hash;
+}
+
 std::runtime_error
 errno_runtime_error(int errno_, const std::string &func_name)
 {
@@ -147,6 +147,19 @@ tsnapshot_for_each(const fds_tsnapshot_t *tsnap, std::function<void(const fds_te
 time_t
 get_monotonic_time();
 
+/// The initial value of the FNV-1a hash
+constexpr uint64_t FNV1A_INIT = UINT64_C(14695981039346656037);
+
+/**
+ * \brief Compute the 64-bit FNV-1a hash of data
+ * \param data  The data
+ * \param size  The size of the data
+ * \param hash  The hash to continue from (FNV1A_INIT to start a new one)
+ * \return The hash
+ */
+uint64_t
+hash_fnv1a(const void *data, size_t size, uint64_t hash = FNV1A_INIT);
+
 /**
  * \brief Create runtime error from errno
  * \param errno_     The errno
@@ -49,7 +49,7 @@
 #include <poll.h>
 
 Connector::Connector(const std::vector<ConnectionParams> &hosts, unsigned int nb_premade_connections,
-                     unsigned int reconnect_secs, ipx_ctx_t *log_ctx) :
+                     unsigned int reconnect_secs, ipx_ctx_t *log_ctx, bool threaded) :
     m_reconnect_secs(reconnect_secs),
     m_log_ctx(log_ctx),
     m_nb_premade_connections(nb_premade_connections)
@@ -65,11 +65,17 @@ Connector::Connector(const std::vector<ConnectionParams> &hosts, unsigned int nb
     }
 
     // Start the worker thread
-    m_thread = std::thread([this](){ this->run(); });
+    if (threaded) {
+        m_thread = std::thread([this](){ this->run(); });
+    }
 }
 
 Connector::~Connector()
 {
+    if (!m_thread.joinable()) {
+        return;
+    }
+
     // Let the worker thread know that we're stopping
     m_stop_flag = true;
     m_statpipe.poke(false);
@@ -83,11 +89,79 @@ Connector::get(const ConnectionParams &host)
 
     std::shared_ptr<FutureSocket> future(std::make_shared<FutureSocket>());
     m_new_requests.emplace_back(Request{host, future});
-    m_statpipe.poke();
+    if (m_thread.joinable()) {
+        m_statpipe.poke();
+    }
 
     return future;
 }
 
+void
+Connector::advance()
+{
+    assert(!m_thread.joinable());
+
+    if (!has_pending_work()) {
+        return;
+    }
+
+    process_requests();
+
+    start_tasks();
+
+    cleanup_tasks();
+
+    setup_pollfds();
+
+    // Only check the sockets, don't wait
+    if (poll(m_pollfds.data(), m_pollfds.size(), 0) < 0) {
+        char *errbuf;
+        ipx_strerror(errno, errbuf);
+        IPX_CTX_ERROR(m_log_ctx, "poll() failed: %s", errbuf);
+        return;
+    }
+
+    process_poll_events();
+}
+
+/**
+ * Check if there are new requests, connections being established or tasks that should be started
+ */
+bool
+Connector::has_pending_work()
+{
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        if (!m_new_requests.empty()) {
+            return true;
+        }
+    }
+
+    time_t now = 0;
+    for (const auto &task : m_tasks) {
+        if (task.state == Task::State::Connecting || task.state == Task::State::ToBeDeleted) {
+            return true;
+        }
+
+        if (task.state != Task::State::NotStarted) {
+            continue;
+        }
+
+        if (task.start_time == 0) {
+            return true;
+        }
+
+        if (now == 0) {
+            now = get_monotonic_time();
+        }
+        if (task.start_time <= now) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
 /**
  * Advance execution of tasks where a poll event occured
  */
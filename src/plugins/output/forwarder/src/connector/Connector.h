@@ -59,6 +59,10 @@
 
 /**
  * \brief  A connector class that handles socket connections on a separate thread
+ *
+ * Optionally, the connections can be handled without the thread by the thread of the caller,
+ * which has to call advance() regularly (e.g. whenever it processes a message). Then no status
+ * changes have to cross threads and no pipe wakeups are needed.
  */
 class Connector {
 public:
@@ -70,9 +74,10 @@ public:
      * \param nb_premade_connections  Number of extra open connections to keep
      * \param reconnect_secs          The reconnect interval
      * \param log_ctx                 The logging context
+     * \param threaded                Handle the connections on a separate thread (otherwise advance() must be called)
      */
     Connector(const std::vector<ConnectionParams> &hosts, unsigned int nb_premade_connections,
-              unsigned int reconnect_secs, ipx_ctx_t *log_ctx);
+              unsigned int reconnect_secs, ipx_ctx_t *log_ctx, bool threaded = true);
 
     // No copying or moving
     Connector(const Connector&) = delete;
@@ -87,6 +92,17 @@ public:
     std::shared_ptr<FutureSocket>
     get(const ConnectionParams &host);
 
+    /**
+     * \brief  Advance the connections without waiting (only if the connector has no thread)
+     *
+     * New connections are started and the started ones are checked by a single poll() call. If there is
+     * nothing to do (i.e. no requests, no connections being established and no reconnects due), no system
+     * calls are made. Broken premade connections are therefore detected only together with other work or
+     * once they are used.
+     */
+    void
+    advance();
+
     /**
      * \brief  The destructor
      */
@@ -128,7 +144,7 @@ private:
     std::vector<Task> m_tasks;
     // Pipe to notify for status changes
     Pipe m_statpipe;
-    // The worker thread
+    // The worker thread (not running if the connections are advanced by the caller)
     std::thread m_thread;
     // Stop flag for the worker thread
     std::atomic<bool> m_stop_flag{false};
@@ -142,6 +158,9 @@ private:
     void
     wait_for_poll_event();
 
+    bool
+    has_pending_work();
+
     void
     cleanup_tasks();
 
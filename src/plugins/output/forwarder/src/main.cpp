@@ -61,10 +61,13 @@ int
 ipx_plugin_init(ipx_ctx_t *ctx, const char *xml_config)
 {
     std::unique_ptr<Forwarder> forwarder;
+    bool relay;
 
     try {
         Config config(xml_config);
         forwarder.reset(new Forwarder(config, ctx));
+        // Only the split mode needs to access individual data records
+        relay = (config.forward_mode != ForwardMode::SPLIT);
 
     } catch (const std::invalid_argument &ex) {
         IPX_CTX_ERROR(ctx, "%s", ex.what());
@@ -89,6 +92,7 @@ ipx_plugin_init(ipx_ctx_t *ctx, const char *xml_config)
 
     ipx_msg_mask_t mask = IPX_MSG_IPFIX | IPX_MSG_SESSION;
     ipx_ctx_subscribe(ctx, &mask, NULL);
+    ipx_ctx_relay_set(ctx, relay);
     ipx_ctx_private_set(ctx, forwarder.release());
 
     return IPX_OK;
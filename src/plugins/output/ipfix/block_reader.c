@@ -0,0 +1,816 @@
+/**
+ * \file src/plugins/output/ipfix/block_reader.c
+ * \author agent <agent@local>
+ * \brief Reader of block-compressed IPFIX Files (source file)
+ * \date 2026
+ */
+
+
+/* Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is'', and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#include <endian.h>
+#include <errno.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <arpa/inet.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#ifdef HAVE_ZSTD
+#include <zstd.h>
+#endif
+#ifdef HAVE_LZ4
+#include <lz4frame.h>
+#endif
+
+#include "block_reader.h"
+
+/** Magic number of a Zstandard frame                                        */
+#define MAGIC_ZSTD (0xFD2FB528U)
+/** Magic number of an LZ4 frame                                             */
+#define MAGIC_LZ4  (0x184D2204U)
+/** Magic number of a skippable frame (the lowest 4 bits are arbitrary)      */
+#define MAGIC_SKIP (0x184D2A50U)
+/** Magic number of the skippable frame with the seek index                  */
+#define MAGIC_INDEX (0x184D2A5EU)
+/** Magic bytes of the seek index                                            */
+#define INDEX_MAGIC "IPXI"
+/** Supported version of the seek index                                      */
+#define INDEX_VERSION (1U)
+/** Size of the index header (magic, version, number of blocks)              */
+#define INDEX_HDR_SIZE (12U)
+/** Size of an index entry                                                   */
+#define INDEX_ENTRY_SIZE (24U)
+/** Size of the header of a skippable frame                                  */
+#define SKIP_HDR_SIZE (8U)
+/** Maximal size of a decompressed block (protection against malformed files) */
+#define BLOCK_SIZE_MAX (256U * 1024U * 1024U)
+/** Size of an IPFIX Message header                                          */
+#define MSG_HDR_SIZE (16U)
+/** Version of IPFIX Message                                                 */
+#define MSG_VERSION (10U)
+
+/** Block (i.e. frame) of the file                                           */
+struct block_info {
+    uint64_t offset;    /**< Offset of the frame in the file                 */
+    uint32_t size;      /**< Size of the frame                               */
+    uint32_t size_orig; /**< Size of the decompressed block (0 = unknown)    */
+};
+
+/** Decompressed block                                                       */
+struct block_slot {
+    uint8_t *data;      /**< Decompressed block                              */
+    size_t capacity;    /**< Size of the allocated buffer                    */
+    size_t size;        /**< Size of the decompressed block                  */
+    bool done;          /**< The block is ready (or failed)                  */
+    const char *err;    /**< Decompression failure (NULL on success)         */
+};
+
+struct block_reader {
+    const uint8_t *map;         /**< Mapping of the file                     */
+    size_t map_size;            /**< Size of the mapping                     */
+    uint32_t time_from;         /**< First Export Time to read               */
+    uint32_t time_to;           /**< Last Export Time to read                */
+
+    struct block_info *blocks;  /**< Blocks to read                          */
+    size_t block_cnt;           /**< Number of blocks to read                */
+    size_t block_total;         /**< Number of all blocks in the file        */
+    bool indexed;               /**< Blocks have been selected by the index  */
+
+    /** Ring of decompressed blocks (the block N uses the slot N % slot_cnt) */
+    struct block_slot *slots;
+    size_t slot_cnt;
+    /** Index of the next block to decompress                                */
+    size_t next_job;
+    /** Index of the block read by the caller                                */
+    size_t current;
+    /** The caller reads messages of the current block                       */
+    bool acquired;
+    /** Position of the next message in the current block                   */
+    const uint8_t *msg_pos;
+    /** Remaining size of the current block                                  */
+    size_t msg_remain;
+
+    pthread_t *threads;         /**< Decompression threads                   */
+    unsigned int thread_cnt;    /**< Number of running threads               */
+    bool stop;                  /**< Stop request of the threads             */
+    pthread_mutex_t mutex;      /**< Mutex of the ring                       */
+    pthread_cond_t cond_job;    /**< A block can be decompressed             */
+    pthread_cond_t cond_done;   /**< A block has been decompressed           */
+};
+
+/**
+ * \brief Read a little endian 32-bit number
+ * \param[in] ptr Pointer to the number (might not be aligned)
+ */
+static inline uint32_t
+get_le32(const uint8_t *ptr)
+{
+    uint32_t value;
+    memcpy(&value, ptr, sizeof(value));
+    return le32toh(value);
+}
+
+/**
+ * \brief Read a big endian 32-bit number
+ * \param[in] ptr Pointer to the number (might not be aligned)
+ */
+static inline uint32_t
+get_be32(const uint8_t *ptr)
+{
+    uint32_t value;
+    memcpy(&value, ptr, sizeof(value));
+    return ntohl(value);
+}
+
+/**
+ * \brief Read a big endian 64-bit number
+ * \param[in] ptr Pointer to the number (might not be aligned)
+ */
+static inline uint64_t
+get_be64(const uint8_t *ptr)
+{
+    uint64_t value;
+    memcpy(&value, ptr, sizeof(value));
+    return be64toh(value);
+}
+
+/**
+ * \brief Check whether a magic number belongs to a skippable frame
+ * \param[in] magic Magic number
+ */
+static inline bool
+magic_is_skippable(uint32_t magic)
+{
+    return (magic & 0xFFFFFFF0U) == MAGIC_SKIP;
+}
+
+bool
+block_reader_detect(int fd)
+{
+    uint8_t buffer[4];
+
+    if (pread(fd, buffer, sizeof(buffer), 0) != (ssize_t) sizeof(buffer)) {
+        return false;
+    }
+
+    const uint32_t magic = get_le32(buffer);
+    return magic == MAGIC_ZSTD || magic == MAGIC_LZ4 || magic_is_skippable(magic);
+}
+
+/**
+ * \brief Select blocks by the seek index at the end of the file
+ * \param[in] reader Reader
+ * \return #BLOCK_READER_OK on success
+ * \return #BLOCK_READER_EOF if the file doesn't end with the index
+ * \return #BLOCK_READER_ERROR on a memory allocation failure
+ */
+static enum BLOCK_READER_STATUS
+blocks_from_index(struct block_reader *reader)
+{
+    const size_t size_min = SKIP_HDR_SIZE + INDEX_HDR_SIZE + 4U;
+    if (reader->map_size < size_min) {
+        return BLOCK_READER_EOF;
+    }
+
+    // The last 4 bytes are the size of the whole skippable frame
+    const uint32_t frame_size = get_be32(reader->map + reader->map_size - 4U);
+    if (frame_size < size_min || frame_size > reader->map_size) {
+        return BLOCK_READER_EOF;
+    }
+
+    const size_t frame_offset = reader->map_size - frame_size;
+    const uint8_t *frame = reader->map + frame_offset;
+    const uint8_t *index = frame + SKIP_HDR_SIZE;
+    if (get_le32(frame) != MAGIC_INDEX || get_le32(frame + 4U) != frame_size - SKIP_HDR_SIZE
+            || memcmp(index, INDEX_MAGIC, 4U) != 0
+            || (get_be32(index + 4U) >> 16) != INDEX_VERSION) {
+        return BLOCK_READER_EOF;
+    }
+
+    const uint32_t entry_cnt = get_be32(index + 8U);
+    if ((uint64_t) entry_cnt * INDEX_ENTRY_SIZE != frame_size - size_min) {
+        return BLOCK_READER_EOF;
+    }
+
+    reader->blocks = calloc(entry_cnt > 0 ? entry_cnt : 1, sizeof(*reader->blocks));
+    if (!reader->blocks) {
+        return BLOCK_READER_ERROR;
+    }
+
+    const uint8_t *entry = index + INDEX_HDR_SIZE;
+    for (uint32_t i = 0; i < entry_cnt; ++i, entry += INDEX_ENTRY_SIZE) {
+        const uint32_t time_first = get_be32(entry);
+        const uint32_t time_last = get_be32(entry + 4U);
+        struct block_info info = {
+            .offset = get_be64(entry + 8U),
+            .size = get_be32(entry + 16U),
+            .size_orig = get_be32(entry + 20U)
+        };
+
+        if (info.offset > frame_offset || info.size > frame_offset - info.offset) {
+            // Not a valid index (e.g. the file has been truncated and appended)
+            free(reader->blocks);
+            reader->blocks = NULL;
+            return BLOCK_READER_EOF;
+        }
+
+        if (time_last < reader->time_from || time_first > reader->time_to) {
+            continue;
+        }
+
+        reader->blocks[reader->block_cnt++] = info;
+    }
+
+    reader->block_total = entry_cnt;
+    reader->indexed = true;
+    return BLOCK_READER_OK;
+}
+
+/**
+ * \brief Get the size of an LZ4 frame by walking its blocks
+ * \param[in]  ptr       Start of the frame
+ * \param[in]  avail     Available data
+ * \param[out] size_orig Content size, if present in the frame header (otherwise 0)
+ * \return Size of the frame or 0 if the frame is incomplete
+ */
+static size_t
+lz4_frame_size(const uint8_t *ptr, size_t avail, uint32_t *size_orig)
+{
+    // Magic number, FLG and BD bytes, [content size], [dictionary ID], header checksum
+    if (avail < 7U) {
+        return 0;
+    }
+
+    const uint8_t flg = ptr[4];
+    const bool block_csum = (flg & 0x10U) != 0;
+    const bool content_csum = (flg & 0x04U) != 0;
+    size_t pos = 6U;
+
+    *size_orig = 0;
+    if (flg & 0x08U) {
+        if (avail < pos + 8U) {
+            return 0;
+        }
+
+        uint64_t content_size;
+        memcpy(&content_size, ptr + pos, sizeof(content_size));
+        content_size = le64toh(content_size);
+        *size_orig = (content_size <= BLOCK_SIZE_MAX) ? (uint32_t) content_size : 0;
+        pos += 8U;
+    }
+    pos += (flg & 0x01U) ? 5U : 1U;
+
+    while (true) {
+        if (avail < pos + 4U) {
+            return 0;
+        }
+
+        const uint32_t block = get_le32(ptr + pos);
+        pos += 4U;
+        if (block == 0) {
+            // End mark
+            break;
+        }
+
+        // The highest bit indicates an uncompressed block
+        const size_t block_size = (block & 0x7FFFFFFFU) + (block_csum ? 4U : 0U);
+        if (avail - pos < block_size) {
+            return 0;
+        }
+        pos += block_size;
+    }
+
+    pos += content_csum ? 4U : 0U;
+    return (pos <= avail) ? pos : 0;
+}
+
+/**
+ * \brief Find all complete frames of a file without the seek index
+ * \param[in]  reader Reader
+ * \param[out] err    Description of the failure
+ * \return #BLOCK_READER_OK on success
+ * \return #BLOCK_READER_ERROR on failure
+ */
+static enum BLOCK_READER_STATUS
+blocks_from_frames(struct block_reader *reader, const char **err)
+{
+    size_t block_max = 64;
+    size_t pos = 0;
+
+    reader->blocks = calloc(block_max, sizeof(*reader->blocks));
+    if (!reader->blocks) {
+        *err = "memory allocation failed";
+        return BLOCK_READER_ERROR;
+    }
+
+    while (reader->map_size - pos >= 8U) {
+        const uint8_t *ptr = reader->map + pos;
+        const size_t avail = reader->map_size - pos;
+        const uint32_t magic = get_le32(ptr);
+        struct block_info info = {.offset = pos, .size = 0, .size_orig = 0};
+        size_t frame_size;
+
+        if (magic_is_skippable(magic)) {
+            frame_size = SKIP_HDR_SIZE + (size_t) get_le32(ptr + 4U);
+            if (frame_size > avail) {
+                break;
+            }
+
+            pos += frame_size;
+            continue;
+        } else if (magic == MAGIC_LZ4) {
+            frame_size = lz4_frame_size(ptr, avail, &info.size_orig);
+        } else if (magic == MAGIC_ZSTD) {
+#ifdef HAVE_ZSTD
+            frame_size = ZSTD_findFrameCompressedSize(ptr, avail);
+            if (ZSTD_isError(frame_size)) {
+                frame_size = 0;
+            } else {
+                unsigned long long content_size = ZSTD_getFrameContentSize(ptr, avail);
+                if (content_size <= BLOCK_SIZE_MAX) {
+                    info.size_orig = (uint32_t) content_size;
+                }
+            }
+#else
+            *err = "Zstandard decompression is not supported (built without libzstd)";
+            return BLOCK_READER_ERROR;
+#endif
+        } else {
+            *err = "unknown frame (not a block-compressed IPFIX File)";
+            return BLOCK_READER_ERROR;
+        }
+
+        if (frame_size == 0 || frame_size > UINT32_MAX) {
+            // Incomplete frame at the end of the file (e.g. the writer has been killed)
+            break;
+        }
+
+        if (reader->block_cnt == block_max) {
+            struct block_info *new_blocks;
+            new_blocks = realloc(reader->blocks, 2 * block_max * sizeof(*reader->blocks));
+            if (!new_blocks) {
+                *err = "memory allocation failed";
+                return BLOCK_READER_ERROR;
+            }
+
+            reader->blocks = new_blocks;
+            block_max *= 2;
+        }
+
+        info.size = (uint32_t) frame_size;
+        reader->blocks[reader->block_cnt++] = info;
+        pos += frame_size;
+    }
+
+    reader->block_total = reader->block_cnt;
+    reader->indexed = false;
+    return BLOCK_READER_OK;
+}
+
+/**
+ * \brief Make sure that a buffer of a slot has at least the given capacity
+ * \param[in] slot     Slot
+ * \param[in] capacity Required capacity
+ * \return True on success, false on a memory allocation failure
+ */
+static bool
+slot_reserve(struct block_slot *slot, size_t capacity)
+{
+    if (slot->capacity >= capacity) {
+        return true;
+    }
+
+    uint8_t *new_data = realloc(slot->data, capacity);
+    if (!new_data) {
+        return false;
+    }
+
+    slot->data = new_data;
+    slot->capacity = capacity;
+    return true;
+}
+
+/**
+ * \brief Decompress a block
+ *
+ * Only the slot is modified, therefore, blocks can be decompressed by multiple threads.
+ * \param[in] reader Reader
+ * \param[in] block  Block to decompress
+ * \param[in] slot   Slot of the decompressed block
+ * \return NULL on success, otherwise a description of the failure
+ */
+static const char *
+block_decompress(const struct block_reader *reader, const struct block_info *block,
+    struct block_slot *slot)
+{
+    const uint8_t *src = reader->map + block->offset;
+    const uint32_t magic = (block->size >= 4U) ? get_le32(src) : 0;
+
+    if (block->size_orig > BLOCK_SIZE_MAX) {
+        return "block is too big";
+    }
+
+    slot->size = 0;
+    switch (magic) {
+    case MAGIC_ZSTD: {
+#ifdef HAVE_ZSTD
+        if (block->size_orig > 0) {
+            if (!slot_reserve(slot, block->size_orig)) {
+                return "memory allocation failed";
+            }
+
+            size_t rc = ZSTD_decompress(slot->data, block->size_orig, src, block->size);
+            if (ZSTD_isError(rc) || rc != block->size_orig) {
+                return "failed to decompress a Zstandard frame";
+            }
+
+            slot->size = rc;
+            return NULL;
+        }
+
+        // The size of the block is unknown, the buffer grows as needed
+        ZSTD_DCtx *dctx = ZSTD_createDCtx();
+        ZSTD_inBuffer in = {src, block->size, 0};
+        size_t rc = 1;
+
+        if (!dctx) {
+            return "failed to create a Zstandard decompression context";
+        }
+
+        while (rc != 0) {
+            if (slot->size == slot->capacity) {
+                const size_t capacity = (slot->capacity > 0)
+                    ? 2U * slot->capacity : 4U * (size_t) block->size;
+                if (slot->capacity >= BLOCK_SIZE_MAX || !slot_reserve(slot, capacity)) {
+                    ZSTD_freeDCtx(dctx);
+                    return "memory allocation failed";
+                }
+            }
+
+            ZSTD_outBuffer out = {slot->data, slot->capacity, slot->size};
+            const size_t in_pos = in.pos;
+            rc = ZSTD_decompressStream(dctx, &out, &in);
+            if (ZSTD_isError(rc) || (rc != 0 && in.pos == in_pos && out.pos == slot->size)) {
+                // Failure or an incomplete frame (no progress)
+                rc = 1;
+                break;
+            }
+            slot->size = out.pos;
+        }
+
+        ZSTD_freeDCtx(dctx);
+        if (rc != 0) {
+            return "failed to decompress a Zstandard frame";
+        }
+        return NULL;
+#else
+        return "Zstandard decompression is not supported (built without libzstd)";
+#endif
+        }
+    case MAGIC_LZ4: {
+#ifdef HAVE_LZ4
+        LZ4F_dctx *dctx;
+        size_t src_pos = 0;
+        size_t rc = 1;
+
+        // The size of the block might be unknown, the buffer grows as needed
+        size_t capacity = (block->size_orig > 0) ? block->size_orig : 4U * (size_t) block->size;
+        if (!slot_reserve(slot, capacity > 0 ? capacity : 1U)) {
+            return "memory allocation failed";
+        }
+
+        if (LZ4F_isError(LZ4F_createDecompressionContext(&dctx, LZ4F_VERSION))) {
+            return "failed to create an LZ4 decompression context";
+        }
+
+        while (src_pos < block->size && rc != 0) {
+            if (slot->size == slot->capacity) {
+                if (slot->capacity >= BLOCK_SIZE_MAX
+                        || !slot_reserve(slot, 2U * slot->capacity)) {
+                    LZ4F_freeDecompressionContext(dctx);
+                    return "memory allocation failed";
+                }
+            }
+
+            size_t src_size = block->size - src_pos;
+            size_t dst_size = slot->capacity - slot->size;
+            rc = LZ4F_decompress(dctx, slot->data + slot->size, &dst_size, src + src_pos,
+                &src_size, NULL);
+            if (LZ4F_isError(rc)) {
+                break;
+            }
+
+            src_pos += src_size;
+            slot->size += dst_size;
+        }
+
+        LZ4F_freeDecompressionContext(dctx);
+        if (rc != 0) {
+            // Failure or an incomplete frame
+            return "failed to decompress an LZ4 frame";
+        }
+        return NULL;
+#else
+        return "LZ4 decompression is not supported (built without liblz4)";
+#endif
+        }
+    default:
+        return "unknown frame (malformed seek index?)";
+    }
+}
+
+/**
+ * \brief Main function of a decompression thread
+ *
+ * Blocks are taken in order as long as they fit into the ring of slots ahead of the block
+ * read by the caller.
+ * \param[in] arg Reader
+ * \return Always NULL
+ */
+static void *
+block_thread_main(void *arg)
+{
+    struct block_reader *reader = (struct block_reader *) arg;
+
+    pthread_mutex_lock(&reader->mutex);
+    while (true) {
+        while (!reader->stop && (reader->next_job >= reader->block_cnt
+                || reader->next_job >= reader->current + reader->slot_cnt)) {
+            pthread_cond_wait(&reader->cond_job, &reader->mutex);
+        }
+
+        if (reader->stop) {
+            break;
+        }
+
+        const size_t idx = reader->next_job++;
+        struct block_slot *slot = &reader->slots[idx % reader->slot_cnt];
+        pthread_mutex_unlock(&reader->mutex);
+
+        const char *err = block_decompress(reader, &reader->blocks[idx], slot);
+
+        pthread_mutex_lock(&reader->mutex);
+        slot->err = err;
+        slot->done = true;
+        pthread_cond_broadcast(&reader->cond_done);
+    }
+    pthread_mutex_unlock(&reader->mutex);
+    return NULL;
+}
+
+block_reader_t *
+block_reader_open(int fd, uint32_t time_from, uint32_t time_to, unsigned int threads,
+    const char **err)
+{
+    struct stat file_info;
+    enum BLOCK_READER_STATUS status;
+
+    if (threads > BLOCK_READER_THREADS_MAX) {
+        threads = BLOCK_READER_THREADS_MAX;
+    }
+
+    if (fstat(fd, &file_info) != 0 || file_info.st_size <= 0) {
+        *err = "unable to get the size of the file (or the file is empty)";
+        return NULL;
+    }
+
+    struct block_reader *reader = calloc(1, sizeof(*reader));
+    if (!reader) {
+        *err = "memory allocation failed";
+        return NULL;
+    }
+
+    reader->time_from = time_from;
+    reader->time_to = time_to;
+    reader->map_size = (size_t) file_info.st_size;
+    void *map = mmap(NULL, reader->map_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (map == MAP_FAILED) {
+        *err = "unable to map the file into memory";
+        free(reader);
+        return NULL;
+    }
+    reader->map = map;
+
+    status = blocks_from_index(reader);
+    if (status == BLOCK_READER_EOF) {
+        status = blocks_from_frames(reader, err);
+    } else if (status == BLOCK_READER_ERROR) {
+        *err = "memory allocation failed";
+    }
+
+    if (status != BLOCK_READER_OK) {
+        free(reader->blocks);
+        munmap((void *) reader->map, reader->map_size);
+        free(reader);
+        return NULL;
+    }
+
+    // Blocks are read sequentially, but decompressed ahead by the threads
+    (void) madvise((void *) reader->map, reader->map_size, MADV_SEQUENTIAL);
+
+    reader->slot_cnt = (threads > 0) ? 2U * threads : 1U;
+    reader->slots = calloc(reader->slot_cnt, sizeof(*reader->slots));
+    if (!reader->slots) {
+        *err = "memory allocation failed";
+        block_reader_close(reader);
+        return NULL;
+    }
+
+    if (threads == 0) {
+        return reader;
+    }
+
+    reader->threads = calloc(threads, sizeof(*reader->threads));
+    if (!reader->threads) {
+        *err = "memory allocation failed";
+        block_reader_close(reader);
+        return NULL;
+    }
+
+    pthread_mutex_init(&reader->mutex, NULL);
+    pthread_cond_init(&reader->cond_job, NULL);
+    pthread_cond_init(&reader->cond_done, NULL);
+    for (unsigned int i = 0; i < threads; ++i) {
+        if (pthread_create(&reader->threads[i], NULL, &block_thread_main, reader) != 0) {
+            *err = "failed to start a decompression thread";
+            block_reader_close(reader);
+            return NULL;
+        }
+        reader->thread_cnt++;
+    }
+
+    return reader;
+}
+
+void
+block_reader_close(block_reader_t *reader)
+{
+    if (!reader) {
+        return;
+    }
+
+    if (reader->threads) {
+        pthread_mutex_lock(&reader->mutex);
+        reader->stop = true;
+        pthread_cond_broadcast(&reader->cond_job);
+        pthread_mutex_unlock(&reader->mutex);
+
+        for (unsigned int i = 0; i < reader->thread_cnt; ++i) {
+            pthread_join(reader->threads[i], NULL);
+        }
+
+        pthread_cond_destroy(&reader->cond_done);
+        pthread_cond_destroy(&reader->cond_job);
+        pthread_mutex_destroy(&reader->mutex);
+        free(reader->threads);
+    }
+
+    for (size_t i = 0; reader->slots && i < reader->slot_cnt; ++i) {
+        free(reader->slots[i].data);
+    }
+
+    free(reader->slots);
+    free(reader->blocks);
+    munmap((void *) reader->map, reader->map_size);
+    free(reader);
+}
+
+/**
+ * \brief Get the next decompressed block
+ *
+ * The current block (if any) is released and the next one is decompressed by the caller or
+ * the reader waits until it's decompressed by a thread.
+ * \param[in]  reader Reader
+ * \param[out] err    Description of the failure
+ * \return #BLOCK_READER_OK, #BLOCK_READER_EOF or #BLOCK_READER_ERROR
+ */
+static enum BLOCK_READER_STATUS
+block_next(struct block_reader *reader, const char **err)
+{
+    struct block_slot *slot;
+
+    if (reader->threads) {
+        pthread_mutex_lock(&reader->mutex);
+        if (reader->acquired) {
+            // The slot can be reused by a thread
+            reader->slots[reader->current % reader->slot_cnt].done = false;
+            reader->current++;
+            pthread_cond_broadcast(&reader->cond_job);
+        }
+
+        slot = &reader->slots[reader->current % reader->slot_cnt];
+        while (reader->current < reader->block_cnt && !slot->done) {
+            pthread_cond_wait(&reader->cond_done, &reader->mutex);
+        }
+        pthread_mutex_unlock(&reader->mutex);
+    } else {
+        if (reader->acquired) {
+            reader->current++;
+        }
+
+        slot = &reader->slots[0];
+        if (reader->current < reader->block_cnt) {
+            slot->err = block_decompress(reader, &reader->blocks[reader->current], slot);
+        }
+    }
+
+    reader->acquired = false;
+    if (reader->current >= reader->block_cnt) {
+        return BLOCK_READER_EOF;
+    }
+
+    if (slot->err) {
+        *err = slot->err;
+        return BLOCK_READER_ERROR;
+    }
+
+    reader->acquired = true;
+    reader->msg_pos = slot->data;
+    reader->msg_remain = slot->size;
+    return BLOCK_READER_OK;
+}
+
+enum BLOCK_READER_STATUS
+block_reader_next(block_reader_t *reader, const uint8_t **msg, uint16_t *size,
+    const char **err)
+{
+    while (true) {
+        if (!reader->acquired || reader->msg_remain == 0) {
+            enum BLOCK_READER_STATUS status = block_next(reader, err);
+            if (status != BLOCK_READER_OK) {
+                return status;
+            }
+            continue;
+        }
+
+        // Blocks consist of whole IPFIX Messages
+        const uint8_t *ptr = reader->msg_pos;
+        if (reader->msg_remain < MSG_HDR_SIZE) {
+            *err = "malformed block (incomplete IPFIX Message header)";
+            return BLOCK_READER_ERROR;
+        }
+
+        const uint16_t version = (uint16_t) ((ptr[0] << 8) | ptr[1]);
+        const uint16_t length = (uint16_t) ((ptr[2] << 8) | ptr[3]);
+        if (version != MSG_VERSION || length < MSG_HDR_SIZE || length > reader->msg_remain) {
+            *err = "malformed block (invalid IPFIX Message header)";
+            return BLOCK_READER_ERROR;
+        }
+
+        reader->msg_pos += length;
+        reader->msg_remain -= length;
+
+        const uint32_t export_time = get_be32(ptr + 4U);
+        if (export_time < reader->time_from || export_time > reader->time_to) {
+            continue;
+        }
+
+        *msg = ptr;
+        *size = length;
+        return BLOCK_READER_OK;
+    }
+}
+
+void
+block_reader_blocks(const block_reader_t *reader, size_t *selected, size_t *total,
+    bool *indexed)
+{
+    *selected = reader->block_cnt;
+    *total = reader->block_total;
+    *indexed = reader->indexed;
+}
@@ -0,0 +1,148 @@
+/**
+ * \file src/plugins/output/ipfix/block_reader.h
+ * \author agent <agent@local>
+ * \brief Reader of block-compressed IPFIX Files (header file)
+ * \date 2026
+ */
+
+
+/* Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is'', and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#ifndef BLOCK_READER_H
+#define BLOCK_READER_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * \file
+ * \brief Reader of files written by the IPFIX output plugin with compression enabled
+ *
+ * Such file is a stream of independent Zstandard or LZ4 frames, each of them holds a block of
+ * whole IPFIX Messages, followed by a seek index in a skippable frame (see README.rst of the
+ * output plugin). The reader maps the file into memory, selects blocks by the Export Time range
+ * of the index and decompresses them by a pool of threads ahead of the caller, while IPFIX
+ * Messages are returned in the original order. Files without the index (i.e. not properly
+ * closed) are read from the beginning up to the last complete frame.
+ *
+ * The reader is shared by the IPFIX input plugin and ipfixsend, therefore, it depends only on
+ * the C library, POSIX threads and the compression libraries (HAVE_ZSTD, HAVE_LZ4).
+ */
+
+/** Maximal number of decompression threads */
+#define BLOCK_READER_THREADS_MAX (64U)
+
+/** Return codes of the reader */
+enum BLOCK_READER_STATUS {
+    BLOCK_READER_OK,    /**< Success                                  */
+    BLOCK_READER_EOF,   /**< No more IPFIX Messages                   */
+    BLOCK_READER_ERROR  /**< Malformed file or decompression failure  */
+};
+
+/** Reader of a block-compressed file */
+typedef struct block_reader block_reader_t;
+
+/**
+ * \brief Check whether a file is block-compressed
+ *
+ * The position in the file is not changed.
+ * \param[in] fd File descriptor
+ * \return True, if the file starts with a Zstandard, LZ4 or skippable frame
+ */
+bool
+block_reader_detect(int fd);
+
+/**
+ * \brief Open a block-compressed file
+ *
+ * Only blocks that might contain IPFIX Messages with Export Time in the range are decompressed
+ * (all blocks, if the file has no index) and the remaining messages out of the range are
+ * skipped.
+ * \param[in]  fd        File descriptor (the reader doesn't close it)
+ * \param[in]  time_from First Export Time to read (inclusive, in seconds)
+ * \param[in]  time_to   Last Export Time to read (inclusive, in seconds)
+ * \param[in]  threads   Number of decompression threads (0 = decompress by the caller)
+ * \param[out] err       Description of the failure (static string)
+ * \return Pointer to the reader or NULL on failure
+ */
+block_reader_t *
+block_reader_open(int fd, uint32_t time_from, uint32_t time_to, unsigned int threads,
+    const char **err);
+
+/**
+ * \brief Destroy the reader (stops its threads and unmaps the file)
+ * \param[in] reader Reader (can be NULL)
+ */
+void
+block_reader_close(block_reader_t *reader);
+
+/**
+ * \brief Get the next IPFIX Message
+ *
+ * The message is a part of the decompressed block, i.e. it might not be aligned and it's
+ * valid only until the next call of the function or destruction of the reader.
+ * \param[in]  reader Reader
+ * \param[out] msg    Pointer to the IPFIX Message
+ * \param[out] size   Size of the IPFIX Message
+ * \param[out] err    Description of the failure (static string)
+ * \return #BLOCK_READER_OK on success
+ * \return #BLOCK_READER_EOF if there are no more messages
+ * \return #BLOCK_READER_ERROR if a block is malformed or it cannot be decompressed
+ */
+enum BLOCK_READER_STATUS
+block_reader_next(block_reader_t *reader, const uint8_t **msg, uint16_t *size,
+    const char **err);
+
+/**
+ * \brief Get the number of blocks to read and the number of all blocks in the file
+ * \param[in]  reader   Reader
+ * \param[out] selected Blocks to read
+ * \param[out] total    All blocks (with the index) or found blocks (without the index)
+ * \param[out] indexed  True, if the seek index has been used
+ */
+void
+block_reader_blocks(const block_reader_t *reader, size_t *selected, size_t *total,
+    bool *indexed);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // BLOCK_READER_H
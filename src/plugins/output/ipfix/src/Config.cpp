@@ -43,6 +43,17 @@
 
 #include <stdexcept>
 #include <memory>
+#include <string>
+#include <strings.h>
+
+/// Default Zstandard compression level
+static const int ZSTD_LEVEL_DEF = 3;
+/// Default LZ4 compression level
+static const int LZ4_LEVEL_DEF = 0;
+/// Default size of blocks (MiB)
+static const uint64_t BLOCK_SIZE_DEF = 4;
+/// Maximal size of blocks (MiB)
+static const uint64_t BLOCK_SIZE_MAX = 64;
 
 /// XML nodes
 enum params_xml_nodes {
@@ -51,7 +62,11 @@ enum params_xml_nodes {
     PARAM_WINDOW_SIZE,
     PARAM_ALIGN_WINDOWS,
     PARAM_PRESERVE_ORIGINAL,
-    PARAM_SPLIT_ON_EXPORT_TIME
+    PARAM_SPLIT_ON_EXPORT_TIME,
+    PARAM_COMPRESSION,
+    PARAM_COMPRESSION_LEVEL,
+    PARAM_BLOCK_SIZE,
+    PARAM_SPLIT_BY
 };
 
 /// Description of XML document
@@ -63,6 +78,10 @@ static const struct fds_xml_args args_params[] = {
     FDS_OPTS_ELEM(PARAM_ALIGN_WINDOWS, "alignWindows", FDS_OPTS_T_BOOL, FDS_OPTS_P_OPT),
     FDS_OPTS_ELEM(PARAM_PRESERVE_ORIGINAL,    "preserveOriginal",   FDS_OPTS_T_BOOL, FDS_OPTS_P_OPT),
     FDS_OPTS_ELEM(PARAM_SPLIT_ON_EXPORT_TIME, "rotateOnExportTime", FDS_OPTS_T_BOOL, FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM(PARAM_COMPRESSION,          "compression",        FDS_OPTS_T_STRING, FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM(PARAM_COMPRESSION_LEVEL,    "compressionLevel",   FDS_OPTS_T_UINT, FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM(PARAM_BLOCK_SIZE,           "blockSize",          FDS_OPTS_T_UINT, FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM(PARAM_SPLIT_BY,             "splitBy",            FDS_OPTS_T_STRING, FDS_OPTS_P_OPT),
     FDS_OPTS_END
 };
 
@@ -73,6 +92,10 @@ void Config::set_defaults() {
     align_windows = true;
     preserve_original = false;
     split_on_export_time = false;
+    compression = calg::NONE;
+    compression_level = -1; // i.e. default level of the algorithm
+    block_size = BLOCK_SIZE_DEF * 1024 * 1024;
+    split_by = split::NONE;
 }
 
 void Config::parse_params(fds_xml_ctx_t *params)
@@ -104,6 +127,47 @@ void Config::parse_params(fds_xml_ctx_t *params)
             assert(content->type == FDS_OPTS_T_BOOL);
             split_on_export_time = content->val_bool;
             break;
+        case PARAM_COMPRESSION:
+            assert(content->type == FDS_OPTS_T_STRING);
+            if (strcasecmp(content->ptr_string, "none") == 0) {
+                compression = calg::NONE;
+            } else if (strcasecmp(content->ptr_string, "zstd") == 0) {
+                compression = calg::ZSTD;
+            } else if (strcasecmp(content->ptr_string, "lz4") == 0) {
+                compression = calg::LZ4;
+            } else {
+                const std::string inv_str = content->ptr_string;
+                throw std::invalid_argument("Unknown compression algorithm '" + inv_str + "'");
+            }
+            break;
+        case PARAM_COMPRESSION_LEVEL:
+            assert(content->type == FDS_OPTS_T_UINT);
+            if (content->val_uint > 22) {
+                throw std::invalid_argument("Compression level is too high!");
+            }
+            compression_level = int(content->val_uint);
+            break;
+        case PARAM_BLOCK_SIZE:
+            assert(content->type == FDS_OPTS_T_UINT);
+            if (content->val_uint == 0 || content->val_uint > BLOCK_SIZE_MAX) {
+                throw std::invalid_argument("Block size must be between 1 and "
+                    + std::to_string(BLOCK_SIZE_MAX) + " MiB!");
+            }
+            block_size = uint32_t(content->val_uint * 1024 * 1024);
+            break;
+        case PARAM_SPLIT_BY:
+            assert(content->type == FDS_OPTS_T_STRING);
+            if (strcasecmp(content->ptr_string, "none") == 0) {
+                split_by = split::NONE;
+            } else if (strcasecmp(content->ptr_string, "odid") == 0) {
+                split_by = split::ODID;
+            } else if (strcasecmp(content->ptr_string, "exporter") == 0) {
+                split_by = split::EXPORTER;
+            } else {
+                const std::string inv_str = content->ptr_string;
+                throw std::invalid_argument("Unknown splitting of files '" + inv_str + "'");
+            }
+            break;
         default:
             throw std::invalid_argument("Unexpected element within <params>!");
         }
@@ -116,6 +180,25 @@ Config::check_validity()
     if (filename.empty()) {
         throw std::invalid_argument("Filename cannot be empty!");
     }
+
+    switch (compression) {
+    case calg::ZSTD:
+        if (compression_level < 0) {
+            compression_level = ZSTD_LEVEL_DEF;
+        } else if (compression_level < 1) {
+            throw std::invalid_argument("Zstandard compression level must be between 1 and 22!");
+        }
+        break;
+    case calg::LZ4:
+        if (compression_level < 0) {
+            compression_level = LZ4_LEVEL_DEF;
+        } else if (compression_level > 12) {
+            throw std::invalid_argument("LZ4 compression level must be between 0 and 12!");
+        }
+        break;
+    default:
+        break;
+    }
 }
 
 Config::Config(const char *params)
@@ -66,6 +66,20 @@ private:
     void check_validity();
 
 public:
+    /// Compression algorithms
+    enum class calg {
+        NONE, ///< Do not use compression
+        ZSTD, ///< Zstandard compression
+        LZ4   ///< LZ4 compression
+    };
+
+    /// Splitting of output files
+    enum class split {
+        NONE,     ///< All IPFIX Messages are written to one file
+        ODID,     ///< One file per Observation Domain ID
+        EXPORTER  ///< One file per exporter (i.e. source IP address of Transport Sessions)
+    };
+
     /// Output file pattern
     std::string filename;
     /// Use local time instead of UTC time
@@ -78,6 +92,14 @@ public:
     bool preserve_original;
     /// Split on IPFIX Export Time instead on system time
     bool split_on_export_time;
+    /// Compression algorithm of blocks
+    calg compression;
+    /// Compression level
+    int compression_level;
+    /// Size of blocks (uncompressed, in bytes)
+    uint32_t block_size;
+    /// Splitting of output files within each time window
+    split split_by;
 
     /**
      * @brief Parse configuration of the IPFIX plugin
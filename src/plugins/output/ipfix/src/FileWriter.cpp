@@ -0,0 +1,463 @@
+/**
+ * \file src/plugins/output/ipfix/src/FileWriter.cpp
+ * \author agent <agent@local>
+ * \brief Buffered file writer with a background flush thread
+ * \date 2026
+ */
+
+/* Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is'', and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#include "FileWriter.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+#include <system_error>
+
+#include <arpa/inet.h>
+#include <endian.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#ifdef HAVE_ZSTD
+#include <zstd.h>
+#endif
+#ifdef HAVE_LZ4
+#include <lz4frame.h>
+#endif
+
+/// Alignment of buffers
+static constexpr size_t BUFFER_ALIGN = 4096U;
+/// Magic number of the skippable frame with the seek index (common for Zstandard and LZ4)
+static constexpr uint32_t INDEX_FRAME_MAGIC = 0x184D2A5EU;
+/// Magic bytes of the seek index
+static const char INDEX_MAGIC[4] = {'I', 'P', 'X', 'I'};
+/// Version of the seek index
+static constexpr uint16_t INDEX_VERSION = 1;
+
+constexpr size_t FileWriter::BUFFER_SIZE;
+
+/// Compression context of the thread
+class FileWriter::Codec {
+public:
+    /**
+     * \brief Prepare the compression context
+     * \param[in] alg   Compression algorithm
+     * \param[in] level Compression level
+     * \throws runtime_error if the algorithm is not supported or the context cannot be created
+     */
+    Codec(Config::calg alg, int level) : alg(alg), level(level)
+    {
+        switch (alg) {
+        case Config::calg::ZSTD:
+#ifdef HAVE_ZSTD
+            zstd = ZSTD_createCCtx();
+            if (!zstd) {
+                throw std::runtime_error("Failed to initialize Zstandard compression");
+            }
+            break;
+#else
+            throw std::runtime_error("Zstandard compression is not supported (the plugin has "
+                "been built without libzstd)");
+#endif
+        case Config::calg::LZ4:
+#ifdef HAVE_LZ4
+            break;
+#else
+            throw std::runtime_error("LZ4 compression is not supported (the plugin has been "
+                "built without liblz4)");
+#endif
+        default:
+            throw std::runtime_error("Unsupported compression algorithm");
+        }
+    }
+
+    /// Destroy the compression context
+    ~Codec()
+    {
+#ifdef HAVE_ZSTD
+        if (zstd) {
+            ZSTD_freeCCtx(zstd);
+        }
+#endif
+    }
+
+    /**
+     * \brief Compress data as an independent frame
+     * \param[in] data Data to compress
+     * \param[in] size Size of the data
+     * \return Size of the frame in the output buffer or 0 on failure
+     */
+    size_t
+    compress(const uint8_t *data, size_t size)
+    {
+        switch (alg) {
+#ifdef HAVE_ZSTD
+        case Config::calg::ZSTD: {
+            out.resize(ZSTD_compressBound(size));
+            size_t rc = ZSTD_compressCCtx(zstd, out.data(), out.size(), data, size, level);
+            return ZSTD_isError(rc) ? 0 : rc;
+            }
+#endif
+#ifdef HAVE_LZ4
+        case Config::calg::LZ4: {
+            LZ4F_preferences_t prefs;
+            std::memset(&prefs, 0, sizeof(prefs));
+            prefs.compressionLevel = level;
+            prefs.frameInfo.contentSize = size;
+            out.resize(LZ4F_compressFrameBound(size, &prefs));
+            size_t rc = LZ4F_compressFrame(out.data(), out.size(), data, size, &prefs);
+            return LZ4F_isError(rc) ? 0 : rc;
+            }
+#endif
+        default:
+            (void) data;
+            (void) size;
+            return 0;
+        }
+    }
+
+    /// Output buffer of the last compressed frame
+    std::vector<uint8_t> out;
+
+private:
+    /// Compression algorithm
+    Config::calg alg;
+    /// Compression level
+    int level;
+#ifdef HAVE_ZSTD
+    /// Zstandard context
+    ZSTD_CCtx *zstd = nullptr;
+#endif
+};
+
+FileWriter::FileWriter(const ipx_ctx *ctx, Config::calg alg, int level, size_t buffer_size)
+    : plugin_context(ctx), buffer_size(buffer_size)
+{
+    if (alg != Config::calg::NONE) {
+        codec.reset(new Codec(alg, level));
+    }
+
+    for (auto &buffer : buffers) {
+        void *ptr = nullptr;
+        if (posix_memalign(&ptr, BUFFER_ALIGN, buffer_size) != 0) {
+            throw std::runtime_error("Memory allocation failed");
+        }
+        buffer.reset(static_cast<uint8_t *>(ptr));
+    }
+
+    try {
+        thread = std::thread(&FileWriter::thread_main, this);
+    } catch (const std::system_error &ex) {
+        throw std::runtime_error("Failed to start a flush thread: " + std::string(ex.what()));
+    }
+}
+
+FileWriter::~FileWriter()
+{
+    try {
+        close();
+    } catch (std::exception &ex) {
+        IPX_CTX_ERROR(plugin_context, "%s", ex.what());
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        job.stop = true;
+    }
+    cv_job.notify_one();
+    thread.join();
+}
+
+void
+FileWriter::open(const std::string &name)
+{
+    assert(fd < 0 && "The file is already opened");
+
+    fd = ::open(name.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        const char *err_str;
+        ipx_strerror(errno, err_str);
+        throw std::runtime_error("Failed to create file '" + name + "': " + std::string(err_str));
+    }
+
+    // The thread is idle (i.e. it doesn't use the index)
+    filename = name;
+    file_offset = 0;
+    index.clear();
+    current_size = 0;
+}
+
+void
+FileWriter::close()
+{
+    if (fd < 0) {
+        return;
+    }
+
+    // Write the remaining data
+    if (current_size > 0) {
+        pass();
+    }
+    wait_idle();
+
+    int error;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        error = job.error;
+        job.error = 0;
+    }
+
+    if (codec && error == 0) {
+        error = write_index();
+    }
+
+    if (::close(fd) != 0 && error == 0) {
+        error = errno;
+    }
+    fd = -1;
+
+    if (error != 0) {
+        const char *err_str;
+        ipx_strerror(error, err_str);
+        throw std::runtime_error("Failed to write file '" + filename + "': "
+            + std::string(err_str));
+    }
+}
+
+void
+FileWriter::write(const struct iovec *iov, int cnt, uint32_t exp_time)
+{
+    assert(fd >= 0 && "The file must be opened");
+    check_error();
+
+    size_t size = 0;
+    for (int i = 0; i < cnt; ++i) {
+        size += iov[i].iov_len;
+    }
+
+    assert(size <= buffer_size && "Data cannot exceed the size of the buffer");
+    if (current_size + size > buffer_size) {
+        pass();
+    }
+
+    uint8_t *pos = buffers[current].get() + current_size;
+    for (int i = 0; i < cnt; ++i) {
+        std::memcpy(pos, iov[i].iov_base, iov[i].iov_len);
+        pos += iov[i].iov_len;
+    }
+
+    if (current_size == 0) {
+        current_first = current_last = exp_time;
+    } else {
+        current_first = std::min(current_first, exp_time);
+        current_last = std::max(current_last, exp_time);
+    }
+    current_size += size;
+
+    if (current_size == buffer_size) {
+        pass();
+    }
+}
+
+/**
+ * \brief Pass the buffer being filled to the thread
+ *
+ * If the thread is still writing the other buffer, wait until it's finished.
+ */
+void
+FileWriter::pass()
+{
+    wait_idle();
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        job.data = buffers[current].get();
+        job.size = current_size;
+        job.time_first = current_first;
+        job.time_last = current_last;
+        job.busy = true;
+    }
+    cv_job.notify_one();
+
+    // The other buffer is not used by the thread anymore
+    current ^= 1;
+    current_size = 0;
+}
+
+/**
+ * \brief Wait until the thread is idle
+ */
+void
+FileWriter::wait_idle()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    cv_done.wait(lock, [this]() { return !job.busy; });
+}
+
+/**
+ * \brief Report an error of the thread (if any)
+ * \throws runtime_error if the thread has failed to write previous data
+ */
+void
+FileWriter::check_error()
+{
+    int error;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        error = job.error;
+        job.error = 0;
+    }
+
+    if (error == 0) {
+        return;
+    }
+
+    const char *err_str;
+    ipx_strerror(error, err_str);
+    throw std::runtime_error("Failed to write file '" + filename + "': " + std::string(err_str));
+}
+
+/**
+ * \brief Write the whole data to the file (even if interrupted)
+ * \param[in] data Data
+ * \param[in] size Size of the data
+ * \return 0 on success, otherwise an error code
+ */
+int
+FileWriter::write_all(const uint8_t *data, size_t size)
+{
+    while (size > 0) {
+        ssize_t ret = ::write(fd, data, size);
+        if (ret < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return errno;
+        }
+
+        data += ret;
+        size -= size_t(ret);
+        file_offset += uint64_t(ret);
+    }
+
+    return 0;
+}
+
+/**
+ * \brief Append the seek index to the file as a skippable frame
+ * \note The thread must be idle.
+ * \return 0 on success, otherwise an error code
+ */
+int
+FileWriter::write_index()
+{
+    const size_t content_size = 12U + index.size() * 24U + 4U;
+    std::vector<uint8_t> frame(8U + content_size);
+    uint8_t *pos = frame.data();
+
+    auto put32 = [&pos](uint32_t value) { std::memcpy(pos, &value, 4U); pos += 4U; };
+    auto put64 = [&pos](uint64_t value) { std::memcpy(pos, &value, 8U); pos += 8U; };
+
+    // Header of the skippable frame (little endian)
+    put32(htole32(INDEX_FRAME_MAGIC));
+    put32(htole32(uint32_t(content_size)));
+
+    // Seek index (network byte order)
+    std::memcpy(pos, INDEX_MAGIC, sizeof(INDEX_MAGIC));
+    pos += sizeof(INDEX_MAGIC);
+    put32(htonl(uint32_t(INDEX_VERSION) << 16));
+    put32(htonl(uint32_t(index.size())));
+    for (const auto &entry : index) {
+        put32(htonl(entry.time_first));
+        put32(htonl(entry.time_last));
+        put64(htobe64(entry.offset));
+        put32(htonl(entry.size));
+        put32(htonl(entry.size_orig));
+    }
+    put32(htonl(uint32_t(frame.size())));
+    assert(pos == frame.data() + frame.size());
+
+    return write_all(frame.data(), frame.size());
+}
+
+/**
+ * \brief Main function of the thread
+ */
+void
+FileWriter::thread_main()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        cv_job.wait(lock, [this]() { return job.stop || job.busy; });
+        if (!job.busy) {
+            // Stop request
+            break;
+        }
+
+        const uint8_t *data = job.data;
+        size_t size = job.size;
+        const struct index_entry entry = {job.time_first, job.time_last, file_offset, 0,
+            uint32_t(size)};
+        lock.unlock();
+
+        int error = 0;
+        if (codec) {
+            // Compress the block as an independent frame
+            size = codec->compress(data, size);
+            data = codec->out.data();
+            if (size == 0) {
+                error = EIO;
+            }
+        }
+
+        if (error == 0) {
+            error = write_all(data, size);
+        }
+
+        if (codec && error == 0) {
+            index.push_back(entry);
+            index.back().size = uint32_t(size);
+        }
+
+        lock.lock();
+        if (error != 0) {
+            job.error = error;
+        }
+        job.busy = false;
+        cv_done.notify_one();
+    }
+}
@@ -0,0 +1,226 @@
+/**
+ * \file src/plugins/output/ipfix/src/FileWriter.hpp
+ * \author agent <agent@local>
+ * \brief Buffered file writer with a background flush thread (header file)
+ * \date 2026
+ */
+
+/* Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is'', and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#ifndef FILEWRITER_HPP
+#define FILEWRITER_HPP
+
+#include "Config.hpp"
+
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <sys/uio.h>
+#include <ipfixcol2.h>
+
+/**
+ * \brief Buffered file writer with a background flush thread
+ *
+ * Data are gathered into one of two large page-aligned buffers. When the buffer is full, it's
+ * passed to a background thread, which writes it to the file while the other buffer is being
+ * filled. Therefore, the caller is blocked only if both buffers are full.
+ *
+ * If compression is enabled, each buffer (i.e. block) is compressed by the thread as an
+ * independent Zstandard or LZ4 frame. When the file is closed, a seek index with the range of
+ * Export Times and position of each frame is appended as a skippable frame. The file remains
+ * a standard compressed stream (see README for the description of the index).
+ *
+ * \note Errors detected by the thread are reported by the next call of write() or close().
+ * \note The writer is not thread-safe, all functions must be called by the same thread.
+ */
+class FileWriter {
+private:
+    class Codec;
+
+    /// Entry of the seek index
+    struct index_entry {
+        uint32_t time_first;  ///< The lowest Export Time in the block
+        uint32_t time_last;   ///< The highest Export Time in the block
+        uint64_t offset;      ///< Position of the frame in the file
+        uint32_t size;        ///< Size of the frame
+        uint32_t size_orig;   ///< Size of the uncompressed block
+    };
+
+    /// Plugin context (only for log!)
+    const ipx_ctx *plugin_context;
+    /// Size of each buffer
+    size_t buffer_size;
+    /// Compression codec (nullptr == disabled, used only by the thread)
+    std::unique_ptr<Codec> codec;
+
+    /// File descriptor of the current file (-1 == closed)
+    int fd = -1;
+    /// Name of the current file
+    std::string filename;
+    /// Current position in the file (used only by the thread)
+    uint64_t file_offset = 0;
+    /// Seek index of the current file (used only by the thread)
+    std::vector<struct index_entry> index;
+
+    /// Buffers (one filled by the caller, one written by the thread)
+    std::unique_ptr<uint8_t, decltype(&free)> buffers[2] = {{nullptr, &free}, {nullptr, &free}};
+    /// Index of the buffer being filled
+    int current = 0;
+    /// Size of valid data in the buffer being filled
+    size_t current_size = 0;
+    /// The lowest Export Time in the buffer being filled
+    uint32_t current_first = 0;
+    /// The highest Export Time in the buffer being filled
+    uint32_t current_last = 0;
+
+    /// Thread
+    std::thread thread;
+    /// Synchronization of the thread
+    std::mutex mutex;
+    /// Notification about a new job of the thread
+    std::condition_variable cv_job;
+    /// Notification about a finished job
+    std::condition_variable cv_done;
+
+    struct {
+        /// Data to write
+        const uint8_t *data = nullptr;
+        /// Size of the data
+        size_t size = 0;
+        /// The lowest Export Time in the data
+        uint32_t time_first = 0;
+        /// The highest Export Time in the data
+        uint32_t time_last = 0;
+        /// The thread is processing the job
+        bool busy = false;
+        /// Request to stop the thread
+        bool stop = false;
+        /// Error code of a failed job (0 == no error)
+        int error = 0;
+    } job;
+
+    void
+    pass();
+    void
+    wait_idle();
+    void
+    check_error();
+    void
+    thread_main();
+    int
+    write_all(const uint8_t *data, size_t size);
+    int
+    write_index();
+
+public:
+    /// Default size of each buffer
+    static constexpr size_t BUFFER_SIZE = 4U * 1024U * 1024U;
+
+    /**
+     * \brief Constructor
+     * \param[in] ctx         Plugin context (for log only!)
+     * \param[in] alg         Compression algorithm of blocks
+     * \param[in] level       Compression level
+     * \param[in] buffer_size Size of each buffer (i.e. uncompressed block)
+     * \throws runtime_error if the buffers cannot be allocated, the compression is not supported
+     *   or the thread cannot be started
+     */
+    FileWriter(const ipx_ctx *ctx, Config::calg alg = Config::calg::NONE, int level = 0,
+        size_t buffer_size = BUFFER_SIZE);
+    /// Destructor (the current file is closed)
+    ~FileWriter();
+
+    // Disable copy constructors
+    FileWriter(const FileWriter &other) = delete;
+    FileWriter &operator=(const FileWriter &other) = delete;
+
+    /**
+     * \brief Create a new file
+     * \note A previously opened file must be closed.
+     * \param[in] name Name of the file
+     * \throws runtime_error if the file cannot be created
+     */
+    void
+    open(const std::string &name);
+
+    /**
+     * \brief Write all buffered data (and the seek index) and close the file (if opened)
+     * \throws runtime_error if the data cannot be written (the file is closed anyway)
+     */
+    void
+    close();
+
+    /**
+     * \brief Check if a file is opened
+     * \return true or false
+     */
+    bool
+    is_open() const { return fd >= 0; }
+
+    /**
+     * \brief Gather and append data to the file
+     *
+     * Data of all vectors are always stored in the same buffer (i.e. they are written to the
+     * file at once and they are never split among compressed blocks). The total size of the
+     * data cannot exceed the size of the buffer.
+     * \param[in] iov      Vectors of data
+     * \param[in] cnt      Number of vectors
+     * \param[in] exp_time Export Time of the data (for the seek index)
+     * \throws runtime_error if the thread has failed to write previous data
+     */
+    void
+    write(const struct iovec *iov, int cnt, uint32_t exp_time);
+
+    /**
+     * \brief Append data to the file
+     * \param[in] data     Data
+     * \param[in] size     Size of the data (cannot exceed the size of the buffer)
+     * \param[in] exp_time Export Time of the data (for the seek index)
+     * \throws runtime_error if the thread has failed to write previous data
+     */
+    void
+    write(const void *data, size_t size, uint32_t exp_time)
+    {
+        struct iovec iov = {const_cast<void *>(data), size};
+        write(&iov, 1, exp_time);
+    }
+};
+
+#endif // FILEWRITER_HPP
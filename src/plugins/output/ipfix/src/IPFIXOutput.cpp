@@ -43,6 +43,7 @@
 #include "IPFIXOutput.hpp"
 
 #include <stdexcept>
+#include <exception>
 #include <algorithm>
 #include <iterator>
 #include <cstring>
@@ -66,7 +67,7 @@
 bool
 IPFIXOutput::should_start_new_file(std::time_t current_time)
 {
-    if (!output_file) {
+    if (!window_started) {
         return true;
     }
 
@@ -78,18 +79,21 @@ IPFIXOutput::should_start_new_file(std::time_t current_time)
 }
 
 /**
- * \brief Create a new output file
+ * \brief Start a new time window
+ *
+ * Files of the previous window are closed and files of the new window are opened when the first
+ * IPFIX Message of the file arrives (see open_file()).
  * \param[in] current_time Current export time
- * \throw runtime_error if the file cannot be created
+ * \throw runtime_error if the file name or the directory cannot be created
  */
 void
 IPFIXOutput::new_file(const std::time_t current_time)
 {
-    // Require (Options) Templates definitions to be added (only if this is not the first file)
-    bool add_tmplts = (output_file != nullptr);
+    // Require (Options) Templates definitions to be added (only if this is not the first window)
+    bool add_tmplts = window_started;
 
-    // Close the previous file, if exists
-    close_file();
+    // Close the previous files, if exist
+    close_files();
 
     // Get the timestamp of the file to create
     if (config->window_size > 0 && config->align_windows) {
@@ -135,45 +139,93 @@ IPFIXOutput::new_file(const std::time_t current_time)
             + "':" + std::string(err_str));
     }
 
-    // Open the file for writing
-    output_file = std::fopen(filename, "w");
-    if (!output_file) {
-        const char *err_str;
-        ipx_strerror(errno, err_str);
-        throw std::runtime_error("Failed to create file '" + std::string(filename)
-            + "': " + std::string(err_str));
+    file_name = filename;
+    window_started = true;
+
+    // Consider all Templates as undefined and forget files without any ODID
+    auto it = outputs.begin();
+    while (it != outputs.end()) {
+        if (it->second.odid_contexts.empty()) {
+            it = outputs.erase(it);
+            continue;
+        }
+
+        for (auto &odid_pair : it->second.odid_contexts) {
+            odid_pair.second.needs_to_write_templates = add_tmplts;
+        }
+        it++;
     }
+}
+
+/**
+ * \brief Insert a key of a file before the extension of a file name
+ *
+ * For example, "/tmp/ipfix/202001011200.ipfix" and key "10" -> "/tmp/ipfix/202001011200.10.ipfix"
+ * \param[in] name File name
+ * \param[in] key  Key of the file
+ * \return New file name
+ */
+static std::string
+filename_with_key(const std::string &name, const std::string &key)
+{
+    const size_t base = name.find_last_of('/');
+    const size_t base_start = (base == std::string::npos) ? 0 : base + 1;
+    const size_t dot = name.find_last_of('.');
 
-    // Consider all Templates as undefined
-    for (auto &odid_pair : odid_contexts) {
-        odid_pair.second.needs_to_write_templates = add_tmplts;
+    if (dot == std::string::npos || dot <= base_start) {
+        return name + "." + key;
     }
 
-    IPX_CTX_INFO(plugin_context, "New output file created: %s", filename);
+    return name.substr(0, dot) + "." + key + name.substr(dot);
 }
 
 /**
- * \brief Close current output file
+ * \brief Open a file of the current time window
+ * \param[in] output Output file to open
+ * \throw runtime_error if the file cannot be created
  */
 void
-IPFIXOutput::close_file()
+IPFIXOutput::open_file(output_s &output)
 {
-    if (!output_file) {
-        return;
-    }
+    const std::string filename = output.key.empty()
+        ? file_name
+        : filename_with_key(file_name, output.key);
 
-    int return_code = std::fclose(output_file);
-    if (return_code != 0) {
-        IPX_CTX_WARNING(plugin_context, "Error closing output file", '\0');
+    if (!output.file) {
+        output.file.reset(new FileWriter(plugin_context, config->compression,
+            config->compression_level, config->block_size));
     }
 
-    output_file = nullptr;
-    IPX_CTX_INFO(plugin_context, "Closed output file", '\0');
+    // Open the file for writing
+    output.file->open(filename);
+    IPX_CTX_INFO(plugin_context, "New output file created: %s", filename.c_str());
+}
+
+/**
+ * \brief Close all output files
+ */
+void
+IPFIXOutput::close_files()
+{
+    for (auto &output_pair : outputs) {
+        FileWriter *file = output_pair.second.file.get();
+        if (!file || !file->is_open()) {
+            continue;
+        }
+
+        try {
+            file->close();
+        } catch (std::exception &ex) {
+            IPX_CTX_WARNING(plugin_context, "Error closing output file: %s", ex.what());
+        }
+
+        IPX_CTX_INFO(plugin_context, "Closed output file", '\0');
+    }
 }
 
 /// Auxiliary data structure for callback function
 struct write_templates_aux {
-    std::FILE *file;                   ///< Output file
+    FileWriter *file;                  ///< Output file
 
     uint32_t msg_odid;                 ///< IPFIX Message - ODID
     uint32_t msg_etime;                ///< IPFIX Message - Export Time
@@ -185,6 +237,8 @@ struct write_templates_aux {
     struct fds_ipfix_set_hdr *set_ptr; ///< Pointer to the current IPFIX Set
     enum fds_template_type set_type;   ///< Type of the templates in the current IPFIX Set
     uint16_t set_size;                 ///< Size of the current IPFIX Set
+
+    std::exception_ptr error;          ///< Exception thrown during writing (if any)
 };
 
 /**
@@ -205,16 +259,17 @@ write_template_dump(struct write_templates_aux &ctx)
     ctx.set_ptr->length = htons(ctx.set_size);
 
     // Write the message to the file
-    std::fwrite(ctx.buffer, ctx.mem_used, 1, ctx.file);
+    ctx.file->write(ctx.buffer, ctx.mem_used, ctx.msg_etime);
 }
 
 /**
  * \brief Auxiliary callback function that stores (Options) Template to an IPFIX Message
  *
  * \warning This function is called through C callback i.e. no exception can be thrown!
+ *   If writing to the file fails, the iteration is stopped and the exception is stored.
  * \param[in] tmplt IPFIX (Options) Template to store
  * \param[in] data  Callback data (file, message buffer, etc.)
- * \return Always returns true
+ * \return True on success, false if writing to the file has failed
  */
 static bool
 write_templates_cb(const struct fds_template *tmplt, void *data)
@@ -234,7 +289,12 @@ write_templates_cb(const struct fds_template *tmplt, void *data)
     size_needed += tmplt_size;
     if (ctx->mem_used != 0 && ctx->mem_used + size_needed > MSG_SIZE) {
         // Update the header(s) and write the IPFIX Message to the file
-        write_template_dump(*ctx);
+        try {
+            write_template_dump(*ctx);
+        } catch (...) {
+            ctx->error = std::current_exception();
+            return false;
+        }
         ctx->mem_used = 0;
     }
 
@@ -283,17 +343,18 @@ write_templates_cb(const struct fds_template *tmplt, void *data)
  *
  * The function goes through all (Options) Templates, creates valid IPFIX Messages with
  * these (Options) Templates and writes them to the file.
+ * \param[in] file     Output file
  * \param[in] snap     Template snapshot with all (Options) Templates to store
  * \param[in] odid     Observation Domain ID to which the (Options) Templates belong
  * \param[in] exp_time Export Time of the IPFIX Messages
  * \param[in] seq_num  Sequence number of the IPFIX Messages
  */
 void
-IPFIXOutput::write_templates(const fds_tsnapshot_t *snap, uint32_t odid, uint32_t exp_time,
-    uint32_t seq_num)
+IPFIXOutput::write_templates(FileWriter &file, const fds_tsnapshot_t *snap, uint32_t odid,
+    uint32_t exp_time, uint32_t seq_num)
 {
     struct write_templates_aux cb_data;
-    cb_data.file = output_file;
+    cb_data.file = &file;
     cb_data.msg_odid = odid;
     cb_data.msg_etime = exp_time;
     cb_data.msg_seqnum = seq_num;
@@ -305,6 +366,9 @@ IPFIXOutput::write_templates(const fds_tsnapshot_t *snap, uint32_t odid, uint32_
 
     // Iterate over all valid (Options) Templates and write them to the file as IPFIX Messages
     fds_tsnapshot_for(snap, &write_templates_cb, (void *)&cb_data);
+    if (cb_data.error) {
+        std::rethrow_exception(cb_data.error);
+    }
 
     // Write the last message to the file
     write_template_dump(cb_data);
@@ -313,14 +377,15 @@ IPFIXOutput::write_templates(const fds_tsnapshot_t *snap, uint32_t odid, uint32_
 /**
  * \brief Get a context of a given Observation Domain ID
  * \note A new context is created if the context doesn't exist.
+ * \param[in] output  Output file of the ODID
  * \param[in] odid    Observation Domain ID
  * \param[in] session Transport Session that wants to write to the file
  * \return Pointer or nullptr (the Transport Session doesn't have right to write into the file)
  */
 struct IPFIXOutput::odid_context_s *
-IPFIXOutput::get_odid(uint32_t odid, const ipx_session *session)
+IPFIXOutput::get_odid(output_s &output, uint32_t odid, const ipx_session *session)
 {
-    auto *odid_ctx = &odid_contexts[odid];
+    auto *odid_ctx = &output.odid_contexts[odid];
     if (odid_ctx->session == nullptr) {
         // Grant this Transport Session access to write into the file with the given ODID...
         odid_ctx->session = session;
@@ -352,6 +417,77 @@ IPFIXOutput::get_odid(uint32_t odid, const ipx_session *session)
     return nullptr;
 }
 
+/**
+ * \brief Get an identification of the exporter of a Transport Session
+ *
+ * The source IP address is used for network sessions and the name of the file otherwise.
+ * \param[in] session Transport Session
+ * \return Identification
+ */
+static std::string
+exporter_key(const struct ipx_session *session)
+{
+    const struct ipx_session_net *net;
+    switch (session->type) {
+    case FDS_SESSION_TCP:
+        net = &session->tcp.net;
+        break;
+    case FDS_SESSION_UDP:
+        net = &session->udp.net;
+        break;
+    case FDS_SESSION_SCTP:
+        net = &session->sctp.net;
+        break;
+    default:
+        return session->ident;
+    }
+
+    char addr[INET6_ADDRSTRLEN];
+    const void *addr_src = (net->l3_proto == AF_INET)
+        ? static_cast<const void *>(&net->addr_src.ipv4)
+        : static_cast<const void *>(&net->addr_src.ipv6);
+    if (inet_ntop(net->l3_proto, addr_src, addr, sizeof(addr)) == nullptr) {
+        return session->ident;
+    }
+
+    return addr;
+}
+
+/**
+ * \brief Get an output file of a given ODID and Transport Session
+ * \note A new output is created if the output doesn't exist. The file itself is not opened.
+ * \param[in] odid    Observation Domain ID
+ * \param[in] session Transport Session
+ * \return Output file
+ */
+struct IPFIXOutput::output_s &
+IPFIXOutput::get_output(uint32_t odid, const ipx_session *session)
+{
+    std::string key;
+    switch (config->split_by) {
+    case Config::split::ODID:
+        key = std::to_string(odid);
+        break;
+    case Config::split::EXPORTER: {
+        auto it = session_keys.find(session);
+        if (it == session_keys.end()) {
+            it = session_keys.emplace(session, exporter_key(session)).first;
+        }
+        key = it->second;
+        }
+        break;
+    default:
+        break;
+    }
+
+    auto it = outputs.find(key);
+    if (it == outputs.end()) {
+        it = outputs.emplace(key, output_s()).first;
+        it->second.key = key;
+    }
+    return it->second;
+}
+
 /**
  * \brief Processes an incoming IPFIX message from the collector
  * \param[in] message  The IPFIX message
@@ -369,8 +505,9 @@ IPFIXOutput::on_ipfix_message(ipx_msg_ipfix *message)
     const uint32_t msg_odid = ntohl(msg_hdr->odid);
     const uint16_t msg_size = ntohs(msg_hdr->length);
 
-    // Find context corresponding to the ODID
-    odid_context_s *odid_context = get_odid(msg_odid, msg_ctx->session);
+    // Find the output file and context corresponding to the ODID
+    output_s &output = get_output(msg_odid, msg_ctx->session);
+    odid_context_s *odid_context = get_odid(output, msg_odid, msg_ctx->session);
     if (!odid_context) {
         // The session is in collision with another session -> drop the message
         return;
@@ -386,39 +523,48 @@ IPFIXOutput::on_ipfix_message(ipx_msg_ipfix *message)
         new_file(time_now); // This will make sure that templates will be written to the file
     }
 
-    // We need a templates snapshot from a Data Record, so at least one is needed!
-    const uint32_t drec_cnt = ipx_msg_ipfix_get_drec_cnt(message);
+    if (!output.file || !output.file->is_open()) {
+        open_file(output);
+    }
+    FileWriter &output_file = *output.file;
+
+    // We need a templates snapshot of a Data Set with at least one known Data Record
+    // (available also in relay mode, i.e. without references to Data Records)
+    struct ipx_ipfix_set *sets_data;
+    size_t sets_count;
     const fds_tsnapshot_t *tsnap = nullptr;
-    if (drec_cnt > 0) {
-        const auto *drec = ipx_msg_ipfix_get_drec(message, 0);
-        tsnap = drec->rec.snap;
+    ipx_msg_ipfix_get_sets(message, &sets_data, &sets_count);
+    for (size_t i = 0; i < sets_count && tsnap == nullptr; ++i) {
+        if (sets_data[i].drec_cnt > 0) {
+            tsnap = sets_data[i].snap;
+        }
     }
 
     // Write all (Options) Templates, if required
     if (tsnap != nullptr && odid_context->needs_to_write_templates) {
         uint32_t new_sn = (config->preserve_original) ? msg_seq : odid_context->sequence_number;
-        write_templates(tsnap, msg_odid, msg_etime, new_sn);
+        write_templates(output_file, tsnap, msg_odid, msg_etime, new_sn);
         odid_context->needs_to_write_templates = false;
     }
 
     // If we don't have to look for unknown Data Sets, just copy the whole message -> FAST PATH
     if (config->preserve_original) {
-        std::fwrite(msg_hdr, msg_size, 1, output_file);
+        output_file.write(msg_hdr, msg_size, msg_etime);
         return;
     }
 
     // SLOW PATH - check if the IPFIX Message is fully known and modify it, if necessary
 
-    // Copy the IPFIX Message header to the buffer
+    // Copy the IPFIX Message header to the buffer (IPFIX Sets are only referenced)
     auto *new_hdr = reinterpret_cast<struct fds_ipfix_msg_hdr *>(buffer.get());
     std::memcpy(buffer.get(), msg_hdr, FDS_IPFIX_MSG_HDR_LEN);
     uint16_t new_pos = FDS_IPFIX_MSG_HDR_LEN;
 
-    // Iterate over all IPFIX Sets in the IPFIX Message
-    struct ipx_ipfix_set *sets_data;
-    size_t sets_count;
-    ipx_msg_ipfix_get_sets(message, &sets_data, &sets_count);
+    msg_parts.clear();
+    msg_parts.push_back({buffer.get(), FDS_IPFIX_MSG_HDR_LEN});
 
+    // Iterate over all IPFIX Sets in the IPFIX Message
+    const uint32_t drec_cnt = ipx_msg_ipfix_get_drec_cnt(message);
     for (size_t i = 0; i < sets_count; ++i) {
         const struct fds_ipfix_set_hdr *set = sets_data[i].ptr;
         const uint16_t set_id = ntohs(set->flowset_id);
@@ -426,7 +572,7 @@ IPFIXOutput::on_ipfix_message(ipx_msg_ipfix *message)
 
         if (set_id < FDS_IPFIX_SET_MIN_DSET) {
             // Not a Data Sets -> just copy
-            std::memcpy(buffer.get() + new_pos, set, set_len);
+            msg_parts.push_back({const_cast<fds_ipfix_set_hdr *>(set), set_len});
             new_pos += set_len;
             continue;
         }
@@ -456,7 +602,7 @@ IPFIXOutput::on_ipfix_message(ipx_msg_ipfix *message)
 
         if (found) {
             // Copy the Data Set
-            std::memcpy(buffer.get() + new_pos, set, set_len);
+            msg_parts.push_back({const_cast<fds_ipfix_set_hdr *>(set), set_len});
             new_pos += set_len;
         } else {
             // Skip the Data Set
@@ -470,7 +616,7 @@ IPFIXOutput::on_ipfix_message(ipx_msg_ipfix *message)
     new_hdr->seq_num = htonl(odid_context->sequence_number);
     odid_context->sequence_number += drec_cnt;
 
-    std::fwrite(buffer.get(), new_pos, 1, output_file);
+    output_file.write(msg_parts.data(), int(msg_parts.size()), msg_etime);
 }
 
 /**
@@ -480,6 +626,22 @@ IPFIXOutput::on_ipfix_message(ipx_msg_ipfix *message)
  */
 void
 IPFIXOutput::remove_session(const struct ipx_session *session)
+{
+    session_keys.erase(session);
+    for (auto &output_pair : outputs) {
+        remove_session(output_pair.second.odid_contexts, session);
+    }
+}
+
+/**
+ * \brief Remove a Transport Session from ODID contexts of an output file
+ *
+ * \param[in] odid_contexts ODID contexts of the file
+ * \param[in] session       Transport Session to remove
+ */
+void
+IPFIXOutput::remove_session(std::map<uint32_t, odid_context_s> &odid_contexts,
+    const struct ipx_session *session)
 {
     auto it = odid_contexts.begin();
     while (it != odid_contexts.end()) {
@@ -534,5 +696,5 @@ IPFIXOutput::IPFIXOutput(const Config *config, const ipx_ctx *ctx) : plugin_cont
 
 IPFIXOutput::~IPFIXOutput()
 {
-    close_file();
+    close_files();
 }
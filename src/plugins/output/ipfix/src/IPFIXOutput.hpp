@@ -42,14 +42,18 @@
 #define IPFIXOUTPUT_HPP
 
 #include "Config.hpp"
+#include "FileWriter.hpp"
 
 #include <set>
 #include <map>
 #include <memory>
+#include <string>
+#include <unordered_map>
 #include <vector>
-#include <cstdio>
 #include <ctime>
 
+#include <sys/uio.h>
+
 #include <ipfixcol2.h>
 #include <libfds.h>
 
@@ -73,27 +77,51 @@ private:
         uint32_t sequence_number = 0;
     };
 
+    /// Output file (one per ODID or exporter, if files are split)
+    struct output_s {
+        /// Key of the file (ODID or exporter, empty if files are not split)
+        std::string key;
+        /// Output file writer (with its own flush thread)
+        std::unique_ptr<FileWriter> file = nullptr;
+        /// Map of known Observation Domain IDs (ODIDs) written to the file
+        std::map<uint32_t, odid_context_s> odid_contexts;
+    };
+
     /// Memory for editing IPFIX Messages
     std::unique_ptr<uint8_t[]> buffer = nullptr;
-    /// Map of known Observation Domain IDs (ODIDs)
-    std::map<uint32_t, odid_context_s> odid_contexts;
-    /// Current output file
-    std::FILE *output_file = nullptr;
-    /// Start time of the current file
+    /// Parts of an edited IPFIX Message (header and IPFIX Sets to write)
+    std::vector<struct iovec> msg_parts;
+    /// Output files (key -> file, the key is empty if files are not split)
+    std::map<std::string, output_s> outputs;
+    /// Keys of output files of Transport Sessions (only if split by exporters)
+    std::unordered_map<const ipx_session *, std::string> session_keys;
+    /// The current time window has been started
+    bool window_started = false;
+    /// Start time of the current time window
     std::time_t file_start_time = 0;
+    /// Name of files of the current time window (before adding the key of a file)
+    std::string file_name;
 
     struct odid_context_s *
-    get_odid(uint32_t odid, const ipx_session *session);
+    get_odid(output_s &output, uint32_t odid, const ipx_session *session);
+    output_s &
+    get_output(uint32_t odid, const ipx_session *session);
     void
     remove_session(const struct ipx_session *session);
+    void
+    remove_session(std::map<uint32_t, odid_context_s> &odid_contexts,
+        const struct ipx_session *session);
     bool
     should_start_new_file(std::time_t current_time);
     void
     new_file(const std::time_t current_time);
     void
-    close_file();
+    open_file(output_s &output);
+    void
+    close_files();
     void
-    write_templates(const fds_tsnapshot_t *snap, uint32_t odid, uint32_t exp_time, uint32_t seq_num);
+    write_templates(FileWriter &file, const fds_tsnapshot_t *snap, uint32_t odid,
+        uint32_t exp_time, uint32_t seq_num);
 
 public:
     /**
@@ -88,6 +88,8 @@ ipx_plugin_init(ipx_ctx_t *ctx, const char *params)
         instance->config = config.release();
         instance->ipfix_output = ipfix_output.release();
         ipx_ctx_private_set(ctx, instance);
+        // Original IPFIX Messages are stored as they are (i.e. Data Records are not needed)
+        ipx_ctx_relay_set(ctx, instance->config->preserve_original);
 
     } catch (std::exception &ex) {
         IPX_CTX_ERROR(ctx, "%s", ex.what());
@@ -39,10 +39,10 @@
  *
  */
 
+#include <algorithm>
 #include <cstdio>
 #include <memory>
 #include <set>
-#include <sstream>
 #include <stdexcept>
 
 #include <libfds.h>
@@ -52,6 +52,13 @@
 
 #include "Config.hpp"
 
+/** Default maximum number of records in a batch       */
+#define BATCH_RECS_DEF 256
+/** Upper limit of the number of conversion threads    */
+#define THREADS_MAX 64
+/** Upper limit of the number of Kafka producer shards */
+#define KAFKA_SHARDS_MAX 64
+
 /** XML nodes */
 enum params_xml_nodes {
     // Formatting parameters
@@ -66,6 +73,11 @@ enum params_xml_nodes {
     FMT_BFSPLIT,       /**< Split biflow                    */
     FMT_DETAILEDINFO,  /**< Detailed information            */
     FMT_TMPLTINFO,     /**< Template records                */
+    FMT_SAMPLED,       /**< Sampled records only            */
+    FMT_ENRICH,        /**< Values of IP prefixes           */
+    THREADS,           /**< Number of conversion threads    */
+    FMT_ENCODING,      /**< Encoding of records             */
+    FMT_REGISTRY,      /**< URL of the schema registry      */
     // Common output
     OUTPUT_LIST,       /**< List of output types            */
     OUTPUT_KAFKA,      /**< Store to Kafka                  */
@@ -77,6 +89,10 @@ enum params_xml_nodes {
     KAFKA_BVERSION,    /**< Broker fallback version         */
     KAFKA_BLOCKING,    /**< Block when queue is full        */
     KAFKA_PERF_TUN,    /**< Add performance tuning options  */
+    KAFKA_PACK_SIZE,   /**< Size of packs of records        */
+    KAFKA_PACK_TIME,   /**< Timeout of packs of records     */
+    KAFKA_KEY,         /**< Type of message keys            */
+    KAFKA_SHARDS,      /**< Number of producer shards       */
     KAFKA_PROPERTY,    /**< Additional librdkafka property  */
     KAFKA_PROP_KEY,    /**< Property key                    */
     KAFKA_PROP_VALUE,  /**< Property value                  */
@@ -98,6 +114,10 @@ static const struct fds_xml_args args_kafka[] = {
     FDS_OPTS_ELEM(KAFKA_BVERSION,   "brokerVersion", FDS_OPTS_T_STRING, FDS_OPTS_P_OPT),
     FDS_OPTS_ELEM(KAFKA_BLOCKING,   "blocking",      FDS_OPTS_T_BOOL,   FDS_OPTS_P_OPT),
     FDS_OPTS_ELEM(KAFKA_PERF_TUN,   "performanceTuning", FDS_OPTS_T_BOOL, FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM(KAFKA_PACK_SIZE,  "packSize",      FDS_OPTS_T_UINT,   FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM(KAFKA_PACK_TIME,  "packTimeout",   FDS_OPTS_T_UINT,   FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM(KAFKA_KEY,        "partitionKey",  FDS_OPTS_T_STRING, FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM(KAFKA_SHARDS,     "shards",        FDS_OPTS_T_UINT,   FDS_OPTS_P_OPT),
     FDS_OPTS_NESTED(KAFKA_PROPERTY, "property", args_kafka_prop, FDS_OPTS_P_OPT | FDS_OPTS_P_MULTI),
     FDS_OPTS_END
 };
@@ -122,6 +142,11 @@ static const struct fds_xml_args args_params[] = {
     FDS_OPTS_ELEM(FMT_BFSPLIT,   "splitBiflow",      FDS_OPTS_T_BOOL, FDS_OPTS_P_OPT),
     FDS_OPTS_ELEM(FMT_DETAILEDINFO,  "detailedInfo", FDS_OPTS_T_BOOL, FDS_OPTS_P_OPT),
     FDS_OPTS_ELEM(FMT_TMPLTINFO, "templateInfo", FDS_OPTS_T_BOOL, FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM(FMT_SAMPLED,   "sampledOnly",  FDS_OPTS_T_BOOL, FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM(FMT_ENRICH,    "enrichment",   FDS_OPTS_T_BOOL, FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM(THREADS,       "threads",      FDS_OPTS_T_UINT, FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM(FMT_ENCODING,  "encoding",     FDS_OPTS_T_STRING, FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM(FMT_REGISTRY,  "schemaRegistry", FDS_OPTS_T_STRING, FDS_OPTS_P_OPT),
     FDS_OPTS_NESTED(OUTPUT_LIST, "outputs",   args_outputs, 0),
     FDS_OPTS_END
 };
@@ -218,6 +243,10 @@ Config::parse_kafka(fds_xml_ctx_t *kafka)
     output.partition = RD_KAFKA_PARTITION_UA;
     output.blocking = false;
     output.perf_tuning = true;
+    output.pack_size = 0;
+    output.pack_timeout = 0;
+    output.key = part_key::NONE;
+    output.shards = 1;
 
     // For partition parser
     int32_t value;
@@ -262,6 +291,46 @@ Config::parse_kafka(fds_xml_ctx_t *kafka)
             assert(content->type == FDS_OPTS_T_BOOL);
             output.perf_tuning = content->val_bool;
             break;
+        case KAFKA_PACK_SIZE:
+            assert(content->type == FDS_OPTS_T_UINT);
+            if (content->val_uint > UINT32_MAX) {
+                throw std::invalid_argument("Pack size of a <kafka> output is too big!");
+            }
+            output.pack_size = static_cast<uint32_t>(content->val_uint);
+            break;
+        case KAFKA_PACK_TIME:
+            assert(content->type == FDS_OPTS_T_UINT);
+            if (content->val_uint > UINT32_MAX) {
+                throw std::invalid_argument("Pack timeout of a <kafka> output is too big!");
+            }
+            output.pack_timeout = static_cast<uint32_t>(content->val_uint);
+            break;
+        case KAFKA_KEY:
+            assert(content->type == FDS_OPTS_T_STRING);
+            if (strcasecmp(content->ptr_string, "none") == 0) {
+                output.key = part_key::NONE;
+            } else if (strcasecmp(content->ptr_string, "odid") == 0) {
+                output.key = part_key::ODID;
+            } else if (strcasecmp(content->ptr_string, "exporter") == 0) {
+                output.key = part_key::EXPORTER;
+            } else if (strcasecmp(content->ptr_string, "srcIP") == 0) {
+                output.key = part_key::SRC_IP;
+            } else if (strcasecmp(content->ptr_string, "flow") == 0) {
+                output.key = part_key::FLOW;
+            } else {
+                const std::string inv_str = content->ptr_string;
+                throw std::invalid_argument("Unknown partition key '" + inv_str + "' of a <kafka> "
+                    "output!");
+            }
+            break;
+        case KAFKA_SHARDS:
+            assert(content->type == FDS_OPTS_T_UINT);
+            if (content->val_uint == 0 || content->val_uint > KAFKA_SHARDS_MAX) {
+                throw std::invalid_argument("Number of shards of a <kafka> output must be between "
+                    "1.." + std::to_string(KAFKA_SHARDS_MAX) + "!");
+            }
+            output.shards = static_cast<uint32_t>(content->val_uint);
+            break;
         case KAFKA_PROPERTY:
             assert(content->type == FDS_OPTS_T_CONTEXT);
             parse_kafka_property(output, content->ptr_ctx);
@@ -285,6 +354,10 @@ Config::parse_kafka(fds_xml_ctx_t *kafka)
             throw std::invalid_argument("Broker version of a <kafka> output is not invalid!");
         }
     }
+    if (output.shards > 1 && output.partition != RD_KAFKA_PARTITION_UA) {
+        throw std::invalid_argument("Multiple shards and fixed partition of a <kafka> output "
+            "cannot be combined!");
+    }
 
     outputs.kafkas.push_back(output);
 }
@@ -368,6 +441,31 @@ Config::parse_params(fds_xml_ctx_t *params)
             assert(content->type == FDS_OPTS_T_BOOL);
             format.template_info = content->val_bool;
             break;
+        case FMT_SAMPLED: // Convert only sampled records
+            assert(content->type == FDS_OPTS_T_BOOL);
+            format.sampled_only = content->val_bool;
+            break;
+        case FMT_ENRICH: // Add values of IP prefixes
+            assert(content->type == FDS_OPTS_T_BOOL);
+            format.enrichment = content->val_bool;
+            break;
+        case THREADS: // Number of conversion threads
+            assert(content->type == FDS_OPTS_T_UINT);
+            if (content->val_uint == 0 || content->val_uint > THREADS_MAX) {
+                throw std::invalid_argument("Number of threads must be between 1.."
+                    + std::to_string(THREADS_MAX) + "!");
+            }
+            format.threads = static_cast<uint32_t>(content->val_uint);
+            break;
+        case FMT_ENCODING: // Encoding of records
+            assert(content->type == FDS_OPTS_T_STRING);
+            format.encoding = check_or("encoding", content->ptr_string, "avro", "json")
+                ? rec_encoding::AVRO : rec_encoding::JSON;
+            break;
+        case FMT_REGISTRY: // URL of the schema registry
+            assert(content->type == FDS_OPTS_T_STRING);
+            format.schema_registry = content->ptr_string;
+            break;
         case OUTPUT_LIST: // List of output plugin
             assert(content->type == FDS_OPTS_T_CONTEXT);
             parse_outputs(content->ptr_ctx);
@@ -395,6 +493,16 @@ Config::default_set()
     format.split_biflow = false;
     format.detailed_info = false;
     format.template_info = false;
+    format.sampled_only = false;
+    format.enrichment = false;
+    format.batch_recs = BATCH_RECS_DEF;
+    format.batch_timeout = 0;
+    format.threads = 0; // i.e. based on the number of producer shards
+    format.key = part_key::NONE;
+    format.fields_sel = field_sel::ALL;
+    format.fields.clear();
+    format.encoding = rec_encoding::JSON;
+    format.schema_registry.clear();
 
     outputs.kafkas.clear();
 }
@@ -424,6 +532,51 @@ Config::check_validity()
     for (const auto &kafka : outputs.kafkas) {
         check_and_add(kafka.name);
     }
+
+    // Keys of records are calculated only once, so all outputs must use the same type
+    for (const auto &kafka : outputs.kafkas) {
+        if (kafka.key == part_key::NONE) {
+            continue;
+        }
+        if (format.key != part_key::NONE && format.key != kafka.key) {
+            throw std::invalid_argument("All <kafka> outputs must use the same type of "
+                "partition key!");
+        }
+        if (kafka.partition != RD_KAFKA_PARTITION_UA) {
+            throw std::invalid_argument("Partition key and fixed partition of a <kafka> output "
+                "cannot be combined!");
+        }
+        if (kafka.pack_size != 0) {
+            throw std::invalid_argument("Partition key and packing of records of a <kafka> "
+                "output cannot be combined!");
+        }
+        format.key = kafka.key;
+    }
+
+    // Binary records are not separated by new-line characters and have a schema of their own
+    if (format.encoding == rec_encoding::AVRO) {
+        if (format.schema_registry.empty()) {
+            throw std::invalid_argument("Avro encoding requires <schemaRegistry>!");
+        }
+        if (format.template_info || format.detailed_info || format.enrichment) {
+            throw std::invalid_argument("Avro encoding cannot be combined with <templateInfo>, "
+                "<detailedInfo> and <enrichment>!");
+        }
+        for (const auto &kafka : outputs.kafkas) {
+            if (kafka.pack_size != 0) {
+                throw std::invalid_argument("Avro encoding cannot be combined with packing of "
+                    "records of a <kafka> output!");
+            }
+        }
+    }
+
+    // By default, records are converted by as many threads as the producer shards
+    if (format.threads == 0) {
+        format.threads = 1;
+        for (const auto &kafka : outputs.kafkas) {
+            format.threads = std::max(format.threads, kafka.shards);
+        }
+    }
 }
 
 Config::Config(const char *params)
@@ -459,34 +612,3 @@ Config::~Config()
 {
     // Nothing to do
 }
-
-int
-parse_version(const std::string &str, int version[4])
-{
-    static const int FIELDS_MIN = 2;
-    static const int FIELDS_MAX = 4;
-
-    // Parse the required version
-    std::istringstream parser(str);
-    for (int i = 0; i < FIELDS_MAX; ++i) {
-        version[i] = 0;
-    }
-
-    int idx;
-    for (idx = 0; idx < FIELDS_MAX && !parser.eof(); idx++) {
-        if (idx != 0 && parser.get() != '.') {
-            return IPX_ERR_FORMAT;
-        }
-
-        parser >> version[idx];
-        if (parser.fail() || version[idx] < 0) {
-            return IPX_ERR_FORMAT;
-        }
-    }
-
-    if (!parser.eof() || idx < FIELDS_MIN) {
-        return IPX_ERR_FORMAT;
-    }
-
-    return IPX_OK;
-}
@@ -42,61 +42,11 @@
 #ifndef JSON_CONFIG_H
 #define JSON_CONFIG_H
 
-#include <map>
 #include <string>
 #include <vector>
 #include <ipfixcol2.h>
 
-/** Configuration of output format                                                               */
-struct cfg_format {
-    /** TCP flags format - true (formatted), false (raw)                                         */
-    bool tcp_flags;
-    /** Timestamp format - true (formatted), false (UNIX)                                        */
-    bool timestamp;
-    /** Protocol format  - true (formatted), false (raw)                                         */
-    bool proto;
-    /** Skip unknown elements                                                                    */
-    bool ignore_unknown;
-    /** Converter octetArray type as unsigned integer (only if field size <= 8)                  */
-    bool octets_as_uint;
-    /** Convert white spaces in string (do not skip)                                             */
-    bool white_spaces;
-    /** Add detailed information about each record                                               */
-    bool detailed_info;
-    /** Ignore Options Template records                                                          */
-    bool ignore_options;
-    /** Use only numeric identifiers of Information Elements                                     */
-    bool numeric_names;
-    /** Split biflow records                                                                     */
-    bool split_biflow;
-    /** Add template records                                                                     */
-    bool template_info;
-};
-
-/** Output configuration base structure                                                          */
-struct cfg_output {
-    /** Plugin identification                                                                    */
-    std::string name;
-};
-
-/** Configuration of kafka output                                                                */
-struct cfg_kafka : cfg_output {
-    /// Comma separated list of IP[:Port]
-    std::string brokers;
-    /// Produced topic
-    std::string topic;
-    /// Partition to which data should be send
-    int32_t partition;
-    /// Broker version fallback (empty or X.X.X.X)
-    std::string broker_fallback;
-    /// Block conversion if sender buffer is full
-    bool blocking;
-    /// Add default properties for librdkafka
-    bool perf_tuning;
-
-    /// Additional librdkafka properties (might overwrite common parameters)
-    std::map<std::string, std::string> properties;
-};
+#include "Options.hpp"
 
 /** Parsed configuration of an instance                                                          */
 class Config {
@@ -132,16 +82,4 @@ public:
     ~Config();
 };
 
-/**
- * \brief Parse application version (i.e. A.B.C.D)
- *
- * \note At least major and minor version must be specified. Undefined sub-versions are set to zero.
- * \param[in]  str     Version string
- * \param[out] version Parsed version
- * \return #IPX_OK on success
- * \return #IPX_ERR_FORMAT if the version string is malformed
- */
-int
-parse_version(const std::string &str, int version[4]);
-
 #endif // JSON_CONFIG_H
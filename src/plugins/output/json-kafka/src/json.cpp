@@ -46,6 +46,7 @@
 #include "Config.hpp"
 #include "Storage.hpp"
 #include "Kafka.hpp"
+#include "KafkaShards.hpp"
 
 /** Plugin description */
 IPX_API struct ipx_plugin_info ipx_plugin_info = {
@@ -84,7 +85,11 @@ static void
 outputs_initialize(ipx_ctx_t *ctx, Storage *storage, Config *cfg)
 {
     for (const auto &kafka : cfg->outputs.kafkas) {
-        storage->output_add(new Kafka(kafka, ctx));
+        if (kafka.shards > 1) {
+            storage->output_add(new KafkaShards(kafka, ctx));
+        } else {
+            storage->output_add(new Kafka(kafka, ctx));
+        }
     }
 }
 
@@ -97,6 +102,12 @@ ipx_plugin_init(ipx_ctx_t *ctx, const char *params)
         std::unique_ptr<Instance> ptr(new Instance);
         std::unique_ptr<Config> cfg(new Config(params));
         std::unique_ptr<Storage> storage(new Storage(ctx, cfg.get()->format));
+        if (cfg->format.sampled_only) {
+            storage->sampling_enable(ctx);
+        }
+        if (cfg->format.enrichment) {
+            storage->enrichment_enable(ctx);
+        }
 
         // Initialize outputs
         outputs_initialize(ctx, storage.get(), cfg.get());
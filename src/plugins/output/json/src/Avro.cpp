@@ -0,0 +1,529 @@
+/**
+ * \file src/plugins/output/json/src/Avro.cpp
+ * \author agent <agent@local>
+ * \brief Template-compiled Avro encoder (source file)
+ * \date 2026
+ */
+
+/* Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is'', and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#include <algorithm>
+#include <cctype>
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <stdexcept>
+#include <endian.h>
+
+#include "Avro.hpp"
+#include "Serializer.hpp"
+
+/** Maximum number of prepared plans (all plans are dropped if exceeded)                      */
+#define PLANS_MAX        1024U
+/** Size of the header of the wire format (magic byte and identifier of the schema)          */
+#define WIRE_HDR_SIZE    5U
+/** Magic byte of the wire format                                                             */
+#define WIRE_MAGIC       0U
+/** Maximum size of an encoded integer (zig-zag variable-length encoding)                     */
+#define VARINT_MAX       10U
+/** Namespace of record schemas                                                               */
+#define SCHEMA_NAMESPACE "ipfix"
+
+/** Encoding of a value */
+enum class avro_enc : uint8_t {
+    UINT,      ///< Unsigned integer as "int" or "long"
+    INT,       ///< Signed integer as "int" or "long"
+    FLOAT,     ///< Float as "float"
+    DOUBLE,    ///< Float as "double"
+    BOOL,      ///< Boolean as "boolean"
+    BYTES,     ///< Raw value as "bytes" or "string"
+    TS_MILLIS, ///< Timestamp as "long" (milliseconds since the UNIX epoch)
+    TS_MICROS  ///< Timestamp as "long" (microseconds since the UNIX epoch)
+};
+
+/** Field of the record schema */
+struct Avro::Field {
+    /** Encoding of values                                                                    */
+    avro_enc enc;
+    /** Data type of the Information Element (timestamps only)                                */
+    enum fds_iemgr_element_type type;
+    /** Indexes of values of the field in the record (multiple occurrences form an array)     */
+    std::vector<uint16_t> values;
+};
+
+/** Encoding plan of a Template structure */
+struct Avro::Plan {
+    /** Fields of the record schema (in the order of the schema)                              */
+    std::vector<Field> fields;
+    /** Iterator flags of records                                                             */
+    uint16_t flags;
+    /** Header of the wire format (magic byte and identifier of the schema)                   */
+    uint8_t hdr[WIRE_HDR_SIZE];
+};
+
+/**
+ * \brief Reserve memory of an output buffer
+ * \param[in,out] str  Output buffer (can be reallocated)
+ * \param[in,out] size Size of the output buffer
+ * \param[in]     need Minimal size of the buffer
+ * \throw bad_alloc in case of a memory allocation error
+ */
+static inline void
+buffer_reserve(char **str, size_t *size, size_t need)
+{
+    if (need <= *size) {
+        return;
+    }
+
+    const size_t new_size = std::max(need, 2 * (*size));
+    char *new_str = static_cast<char *>(realloc(*str, new_size));
+    if (!new_str) {
+        throw std::bad_alloc();
+    }
+
+    *str = new_str;
+    *size = new_size;
+}
+
+/**
+ * \brief Encode an integer (zig-zag variable-length encoding of "int" and "long")
+ * \param[in] pos   Output position
+ * \param[in] value Value
+ * \return Position after the encoded value
+ */
+static inline uint8_t *
+avro_long(uint8_t *pos, int64_t value)
+{
+    uint64_t n = (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63);
+    while (n >= 0x80U) {
+        *pos++ = static_cast<uint8_t>(n | 0x80U);
+        n >>= 7;
+    }
+    *pos++ = static_cast<uint8_t>(n);
+    return pos;
+}
+
+/**
+ * \brief Get the name of a field usable in an Avro schema
+ *
+ * Names consist of the scope and the name of the Information Element (e.g.
+ * "iana_octetDeltaCount") or its numeric identification (e.g. "en0_id1"). Characters not
+ * allowed in Avro names are replaced by an underscore.
+ * \param[in] tfield  Field of a Template
+ * \param[in] numeric Use only the numeric identification
+ * \return Name
+ */
+static std::string
+field_name(const struct fds_tfield &tfield, bool numeric)
+{
+    std::string name;
+    if (!numeric && tfield.def != nullptr && tfield.def->scope != nullptr) {
+        name = std::string(tfield.def->scope->name) + "_" + tfield.def->name;
+    } else {
+        name = "en" + std::to_string(tfield.en) + "_id" + std::to_string(tfield.id);
+    }
+
+    for (char &c : name) {
+        if (!isalnum(static_cast<unsigned char>(c)) && c != '_') {
+            c = '_';
+        }
+    }
+    if (isdigit(static_cast<unsigned char>(name[0]))) {
+        name.insert(0, "_");
+    }
+    return name;
+}
+
+/**
+ * \brief Get the Avro type and encoding of a field
+ * \param[in]  tfield Field of a Template
+ * \param[out] enc    Encoding of values
+ * \return Avro type (JSON)
+ */
+static const char *
+field_type(const struct fds_tfield &tfield, avro_enc &enc)
+{
+    if (tfield.def == nullptr) {
+        enc = avro_enc::BYTES;
+        return "\"bytes\"";
+    }
+
+    switch (tfield.def->data_type) {
+    case FDS_ET_UNSIGNED_8:
+    case FDS_ET_UNSIGNED_16:
+        enc = avro_enc::UINT;
+        return "\"int\"";
+    case FDS_ET_UNSIGNED_32:
+    case FDS_ET_UNSIGNED_64:
+        enc = avro_enc::UINT;
+        return "\"long\"";
+    case FDS_ET_SIGNED_8:
+    case FDS_ET_SIGNED_16:
+    case FDS_ET_SIGNED_32:
+        enc = avro_enc::INT;
+        return "\"int\"";
+    case FDS_ET_SIGNED_64:
+        enc = avro_enc::INT;
+        return "\"long\"";
+    case FDS_ET_FLOAT_32:
+        enc = avro_enc::FLOAT;
+        return "\"float\"";
+    case FDS_ET_FLOAT_64:
+        enc = avro_enc::DOUBLE;
+        return "\"double\"";
+    case FDS_ET_BOOLEAN:
+        enc = avro_enc::BOOL;
+        return "\"boolean\"";
+    case FDS_ET_STRING:
+        enc = avro_enc::BYTES;
+        return "\"string\"";
+    case FDS_ET_DATE_TIME_SECONDS:
+    case FDS_ET_DATE_TIME_MILLISECONDS:
+        enc = avro_enc::TS_MILLIS;
+        return "{\"type\":\"long\",\"logicalType\":\"timestamp-millis\"}";
+    case FDS_ET_DATE_TIME_MICROSECONDS:
+    case FDS_ET_DATE_TIME_NANOSECONDS:
+        enc = avro_enc::TS_MICROS;
+        return "{\"type\":\"long\",\"logicalType\":\"timestamp-micros\"}";
+    default:
+        // Addresses, octetArrays, structured data types, etc.
+        enc = avro_enc::BYTES;
+        return "\"bytes\"";
+    }
+}
+
+Avro::Avro(const struct cfg_format &fmt, Registry &registry)
+    : m_registry(registry), m_sel(fmt.fields_sel), m_sel_names(fmt.fields)
+{
+    m_flags = 0;
+    if (fmt.ignore_unknown) {
+        m_flags |= FDS_DREC_UNKNOWN_SKIP;
+    }
+    if (fmt.split_biflow) {
+        m_flags |= FDS_DREC_REVERSE_SKIP;
+    }
+    m_numeric = fmt.numeric_names;
+
+    // Names of elements are resolved by msg_begin() as soon as the manager is known
+    for (const auto &name : m_sel_names) {
+        Serializer::field_ids(nullptr, name, m_sel_ids);
+    }
+    std::sort(m_sel_ids.begin(), m_sel_ids.end());
+    m_sel_ids.erase(std::unique(m_sel_ids.begin(), m_sel_ids.end()), m_sel_ids.end());
+}
+
+Avro::~Avro() = default;
+
+void
+Avro::msg_begin(const fds_iemgr_t *iemgr)
+{
+    m_msg_plans[0].clear();
+    m_msg_plans[1].clear();
+
+    // Plans must be prepared again if definitions of Information Elements have changed
+    if (iemgr != m_iemgr || m_plans.size() > PLANS_MAX) {
+        m_plans.clear();
+    }
+
+    if (iemgr != m_iemgr) {
+        // Resolve names of selected fields (unknown elements are ignored)
+        m_iemgr = iemgr;
+        m_sel_ids.clear();
+        for (const auto &name : m_sel_names) {
+            Serializer::field_ids(m_iemgr, name, m_sel_ids);
+        }
+        std::sort(m_sel_ids.begin(), m_sel_ids.end());
+        m_sel_ids.erase(std::unique(m_sel_ids.begin(), m_sel_ids.end()), m_sel_ids.end());
+    }
+}
+
+/**
+ * \brief Check if a field is selected (see cfg_format::fields_sel)
+ * \param[in] tfield Field of a Template
+ * \return True or false
+ */
+bool
+Avro::field_selected(const struct fds_tfield &tfield) const
+{
+    if (m_sel == field_sel::ALL) {
+        return true;
+    }
+
+    const bool listed = std::binary_search(m_sel_ids.begin(), m_sel_ids.end(),
+        std::make_pair(tfield.en, tfield.id));
+    return (m_sel == field_sel::INCLUDE) ? listed : !listed;
+}
+
+/**
+ * \brief Get a plan of the Template of a record
+ *
+ * Plans are prepared on demand and shared by all Templates with the same structure.
+ * \param[in] rec     Data Record
+ * \param[in] reverse Reverse point of view
+ * \return Pointer to the plan
+ */
+Avro::Plan *
+Avro::plan_get(const struct fds_drec &rec, bool reverse)
+{
+    auto &msg_plans = m_msg_plans[reverse ? 1 : 0];
+    for (const auto &msg_plan : msg_plans) {
+        if (msg_plan.first == rec.tmplt) {
+            return msg_plan.second;
+        }
+    }
+
+    std::string id(reinterpret_cast<const char *>(rec.tmplt->raw.data), rec.tmplt->raw.length);
+    id.push_back(static_cast<char>(rec.tmplt->type));
+    id.push_back(reverse ? 'R' : 'F');
+
+    auto it = m_plans.find(id);
+    if (it == m_plans.end()) {
+        it = m_plans.emplace(std::move(id), plan_create(rec, reverse)).first;
+    }
+
+    Plan *plan = it->second.get();
+    msg_plans.emplace_back(rec.tmplt, plan);
+    return plan;
+}
+
+/**
+ * \brief Prepare a plan of the Template of a record
+ *
+ * Fields are visited in the same way as during encoding of records. The record schema is
+ * registered in the schema registry under the subject equal to the full name of the record
+ * (i.e. RecordNameStrategy). The name is derived from the content of the schema, therefore,
+ * each Template structure has its own subject and schemas are never in conflict.
+ * \param[in] rec     Data Record
+ * \param[in] reverse Reverse point of view
+ * \return The plan
+ * \throw runtime_error if the schema cannot be registered
+ */
+std::unique_ptr<Avro::Plan>
+Avro::plan_create(const struct fds_drec &rec, bool reverse)
+{
+    std::unique_ptr<Plan> plan(new Plan);
+    plan->flags = m_flags;
+    if (reverse) {
+        plan->flags |= FDS_DREC_BIFLOW_REV;
+    }
+
+    // Group occurrences of the same field (the order of the first occurrences is kept)
+    std::vector<const struct fds_tfield *> tfields;
+    struct fds_drec_iter it;
+    fds_drec_iter_init(&it, const_cast<struct fds_drec *>(&rec), plan->flags);
+    uint16_t idx = 0;
+    while (fds_drec_iter_next(&it) != FDS_EOC) {
+        const struct fds_tfield &tfield = *it.field.info;
+        const uint16_t value_idx = idx++;
+        if (!field_selected(tfield)) {
+            continue;
+        }
+
+        size_t i;
+        for (i = 0; i < tfields.size(); ++i) {
+            if (tfields[i]->en == tfield.en && tfields[i]->id == tfield.id) {
+                break;
+            }
+        }
+        if (i == tfields.size()) {
+            tfields.push_back(&tfield);
+            plan->fields.emplace_back();
+            field_type(tfield, plan->fields.back().enc);
+            plan->fields.back().type = (tfield.def != nullptr)
+                ? tfield.def->data_type : FDS_ET_OCTET_ARRAY;
+        }
+        plan->fields[i].values.push_back(value_idx);
+    }
+
+    // Record schema
+    std::string fields;
+    for (size_t i = 0; i < tfields.size(); ++i) {
+        avro_enc enc;
+        const char *type = field_type(*tfields[i], enc);
+        fields += (i == 0) ? "{\"name\":\"" : ",{\"name\":\"";
+        fields += field_name(*tfields[i], m_numeric);
+        fields += "\",\"type\":";
+        if (plan->fields[i].values.size() > 1) {
+            fields += "{\"type\":\"array\",\"items\":";
+            fields += type;
+            fields += "}";
+        } else {
+            fields += type;
+        }
+        fields += "}";
+    }
+
+    // Name of the record (FNV-1a hash of fields)
+    uint64_t hash = UINT64_C(14695981039346656037);
+    for (char c : fields) {
+        hash = (hash ^ static_cast<uint8_t>(c)) * UINT64_C(1099511628211);
+    }
+    char name[24];
+    snprintf(name, sizeof(name), "r%016" PRIx64, hash);
+
+    const std::string schema = "{\"type\":\"record\",\"name\":\"" + std::string(name)
+        + "\",\"namespace\":\"" SCHEMA_NAMESPACE "\",\"fields\":[" + fields + "]}";
+    const std::string subject = SCHEMA_NAMESPACE "." + std::string(name);
+    const uint32_t schema_id = htobe32(m_registry.schema_id(subject, schema));
+
+    plan->hdr[0] = WIRE_MAGIC;
+    memcpy(&plan->hdr[1], &schema_id, sizeof(schema_id));
+    return plan;
+}
+
+/**
+ * \brief Encode a value of a field
+ *
+ * Invalid values (e.g. integers of unexpected size) are encoded as zeros.
+ * \param[in] pos   Output position (there must be enough space for the value)
+ * \param[in] field Field of the plan
+ * \param[in] data  Value of the field
+ * \param[in] size  Size of the value
+ * \return Position after the encoded value
+ */
+uint8_t *
+Avro::field_encode(uint8_t *pos, const Field &field, const uint8_t *data, uint16_t size)
+{
+    switch (field.enc) {
+    case avro_enc::UINT: {
+        uint64_t value;
+        if (fds_get_uint_be(data, size, &value) != FDS_OK) {
+            value = 0;
+        }
+        return avro_long(pos, static_cast<int64_t>(value));
+    }
+    case avro_enc::INT: {
+        int64_t value;
+        if (fds_get_int_be(data, size, &value) != FDS_OK) {
+            value = 0;
+        }
+        return avro_long(pos, value);
+    }
+    case avro_enc::FLOAT: {
+        double value;
+        if (fds_get_float_be(data, size, &value) != FDS_OK) {
+            value = 0;
+        }
+        const float value_flt = static_cast<float>(value);
+        uint32_t bits;
+        memcpy(&bits, &value_flt, sizeof(bits));
+        bits = htole32(bits);
+        memcpy(pos, &bits, sizeof(bits));
+        return pos + sizeof(bits);
+    }
+    case avro_enc::DOUBLE: {
+        double value;
+        if (fds_get_float_be(data, size, &value) != FDS_OK) {
+            value = 0;
+        }
+        uint64_t bits;
+        memcpy(&bits, &value, sizeof(bits));
+        bits = htole64(bits);
+        memcpy(pos, &bits, sizeof(bits));
+        return pos + sizeof(bits);
+    }
+    case avro_enc::BOOL: {
+        bool value;
+        if (fds_get_bool(data, size, &value) != FDS_OK) {
+            value = false;
+        }
+        *pos++ = value ? 1U : 0U;
+        return pos;
+    }
+    case avro_enc::TS_MILLIS: {
+        uint64_t value;
+        if (fds_get_datetime_lp_be(data, size, field.type, &value) != FDS_OK) {
+            value = 0;
+        }
+        return avro_long(pos, static_cast<int64_t>(value));
+    }
+    case avro_enc::TS_MICROS: {
+        struct timespec ts;
+        if (fds_get_datetime_hp_be(data, size, field.type, &ts) != FDS_OK) {
+            ts.tv_sec = 0;
+            ts.tv_nsec = 0;
+        }
+        return avro_long(pos, int64_t(ts.tv_sec) * 1000000 + ts.tv_nsec / 1000);
+    }
+    case avro_enc::BYTES:
+    default:
+        pos = avro_long(pos, size);
+        memcpy(pos, data, size);
+        return pos + size;
+    }
+}
+
+size_t
+Avro::convert(const struct fds_drec &rec, bool reverse, char **str, size_t *size)
+{
+    Plan *plan = plan_get(rec, reverse);
+
+    // Values of all fields in the order of the iterator
+    m_values.clear();
+    struct fds_drec_iter it;
+    fds_drec_iter_init(&it, const_cast<struct fds_drec *>(&rec), plan->flags);
+    while (fds_drec_iter_next(&it) != FDS_EOC) {
+        m_values.emplace_back(it.field.data, it.field.size);
+    }
+
+    // Each value takes at most its size and an integer (length or number)
+    const size_t size_max = WIRE_HDR_SIZE + rec.size + m_values.size() * VARINT_MAX
+        + plan->fields.size() * (VARINT_MAX + 1);
+    buffer_reserve(str, size, size_max);
+    uint8_t *start = reinterpret_cast<uint8_t *>(*str);
+    uint8_t *pos = start;
+    memcpy(pos, plan->hdr, WIRE_HDR_SIZE);
+    pos += WIRE_HDR_SIZE;
+
+    for (const Field &field : plan->fields) {
+        if (field.values.size() == 1) {
+            const auto &value = m_values[field.values[0]];
+            pos = field_encode(pos, field, value.first, value.second);
+            continue;
+        }
+
+        // Multiple occurrences (array of one block)
+        pos = avro_long(pos, static_cast<int64_t>(field.values.size()));
+        for (uint16_t idx : field.values) {
+            const auto &value = m_values[idx];
+            pos = field_encode(pos, field, value.first, value.second);
+        }
+        *pos++ = 0; // End of the array
+    }
+
+    return static_cast<size_t>(pos - start);
+}
@@ -0,0 +1,145 @@
+/**
+ * \file src/plugins/output/json/src/Avro.hpp
+ * \author agent <agent@local>
+ * \brief Template-compiled Avro encoder (header file)
+ * \date 2026
+ */
+
+/* Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is'', and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#ifndef JSON_AVRO_H
+#define JSON_AVRO_H
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include <libfds.h>
+
+#include "Options.hpp"
+#include "Registry.hpp"
+
+/**
+ * \brief Template-compiled Avro encoder
+ *
+ * For each structure of a (Options) Template, an Avro record schema is derived from its
+ * fields and registered in the schema registry. Records are encoded directly from the fields
+ * of IPFIX records (i.e. without conversion to JSON) in the Confluent wire format, i.e.
+ * a magic byte (0), the identifier of the schema (4 bytes, network byte order) and the Avro
+ * binary encoding of the record.
+ *
+ * Fields are mapped to Avro types by data types of Information Elements: integers to "int"
+ * or "long" (unsigned64 values above the range of "long" wrap around), floats to "float" or
+ * "double", booleans to "boolean", strings to "string", timestamps to "long" with logical
+ * type "timestamp-millis" or "timestamp-micros" and all other fields (e.g. addresses,
+ * octetArrays, structured data and unknown fields) to "bytes" with the raw value. Multiple
+ * occurrences of the same field are encoded as an array.
+ */
+class Avro {
+public:
+    /**
+     * \brief Constructor
+     * \param[in] fmt      Conversion specifier (selection of fields, unknown fields, biflow)
+     * \param[in] registry Schema registry (shared by all encoders)
+     */
+    Avro(const struct cfg_format &fmt, Registry &registry);
+    /** Destructor */
+    ~Avro();
+
+    /**
+     * \brief Prepare the encoder for records of a new message
+     *
+     * Templates are identified by pointers only while the message that refers to them exists.
+     * \param[in] iemgr Information Element manager (can be NULL)
+     */
+    void
+    msg_begin(const fds_iemgr_t *iemgr);
+
+    /**
+     * \brief Encode a Data Record
+     * \param[in]     rec     Data Record
+     * \param[in]     reverse Encode from reverse point of view (affects only biflow records)
+     * \param[in,out] str     Output buffer (can be reallocated)
+     * \param[in,out] size    Size of the output buffer
+     * \return Length of the encoded record
+     * \throw bad_alloc in case of a memory allocation error
+     * \throw runtime_error if the schema cannot be registered
+     */
+    size_t
+    convert(const struct fds_drec &rec, bool reverse, char **str, size_t *size);
+
+private:
+    struct Field;
+    struct Plan;
+
+    /** Iterator flags of forward records                                                     */
+    uint16_t m_flags;
+    /** Use only numeric identifiers of Information Elements in names of fields               */
+    bool m_numeric;
+    /** Schema registry                                                                       */
+    Registry &m_registry;
+    /** Information Element manager used to prepare plans                                     */
+    const fds_iemgr_t *m_iemgr = nullptr;
+    /** Plans of Template structures (raw Templates and directions are keys)                  */
+    std::unordered_map<std::string, std::unique_ptr<Plan>> m_plans;
+    /** Plans of Templates of the current message                                             */
+    std::vector<std::pair<const struct fds_template *, Plan *>> m_msg_plans[2];
+    /** Values of fields of the current record (in the order of the iterator)                 */
+    std::vector<std::pair<const uint8_t *, uint16_t>> m_values;
+
+    /** Type of the selection of fields                                                       */
+    field_sel m_sel;
+    /** Names of listed Information Elements                                                  */
+    std::vector<std::string> m_sel_names;
+    /** Sorted identifiers of listed Information Elements (resolved by the current manager)   */
+    std::vector<std::pair<uint32_t, uint16_t>> m_sel_ids;
+
+    // Find or prepare a plan of a Template
+    Plan *
+    plan_get(const struct fds_drec &rec, bool reverse);
+    // Prepare a plan of a Template
+    std::unique_ptr<Plan>
+    plan_create(const struct fds_drec &rec, bool reverse);
+    // Check if a field is selected
+    bool
+    field_selected(const struct fds_tfield &tfield) const;
+    // Encode a value of a field
+    static uint8_t *
+    field_encode(uint8_t *pos, const Field &field, const uint8_t *data, uint16_t size);
+};
+
+#endif // JSON_AVRO_H
@@ -0,0 +1,401 @@
+/**
+ * \file src/plugins/output/json/src/Compressor.cpp
+ * \author agent <agent@local>
+ * \brief Block compressor of output files (source file)
+ * \date 2026
+ */
+
+/* Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is'', and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+#include <cstring>
+#include <functional>
+#include <stdexcept>
+#include <system_error>
+#include <zlib.h>
+#ifdef HAVE_ZSTD
+#include <zstd.h>
+#endif
+#ifdef HAVE_LZ4
+#include <lz4frame.h>
+#endif
+
+#include "Compressor.hpp"
+
+/** Size of uncompressed data in a block                                */
+#define BLOCK_SIZE (1024U * 1024U)
+/** Maximum age of the current block when the output is flushed (sec.)  */
+#define BLOCK_MAX_AGE 1
+
+/** Compression context of a single thread                                                       */
+class Compressor::Codec {
+public:
+    /**
+     * \brief Prepare the compression context
+     * \param[in] alg   Compression algorithm
+     * \param[in] level Compression level
+     * \throw runtime_error if the algorithm is not supported or the context cannot be created
+     */
+    Codec(calg alg, int level) : m_alg(alg), m_level(level)
+    {
+        switch (alg) {
+        case calg::GZIP:
+            std::memset(&m_zs, 0, sizeof(m_zs));
+            // Window bits + 16 == GZIP header and trailer
+            if (deflateInit2(&m_zs, level, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+                throw std::runtime_error("(File output) Failed to initialize GZIP compression");
+            }
+            break;
+        case calg::ZSTD:
+#ifdef HAVE_ZSTD
+            m_zstd = ZSTD_createCCtx();
+            if (!m_zstd) {
+                throw std::runtime_error("(File output) Failed to initialize Zstandard "
+                    "compression");
+            }
+            break;
+#else
+            throw std::runtime_error("(File output) Zstandard compression is not supported "
+                "(the plugin has been built without libzstd)");
+#endif
+        case calg::LZ4:
+#ifdef HAVE_LZ4
+            break;
+#else
+            throw std::runtime_error("(File output) LZ4 compression is not supported "
+                "(the plugin has been built without liblz4)");
+#endif
+        default:
+            throw std::runtime_error("(File output) Unsupported compression algorithm");
+        }
+    }
+
+    /** \brief Destroy the compression context                                                   */
+    ~Codec()
+    {
+        if (m_alg == calg::GZIP) {
+            deflateEnd(&m_zs);
+        }
+#ifdef HAVE_ZSTD
+        if (m_zstd) {
+            ZSTD_freeCCtx(m_zstd);
+        }
+#endif
+    }
+
+    /**
+     * \brief Compress data as an independent frame
+     * \param[in]  in  Data to compress
+     * \param[out] out Compressed frame
+     * \return True on success, false otherwise.
+     */
+    bool
+    compress(const std::string &in, std::string &out)
+    {
+        switch (m_alg) {
+        case calg::GZIP: {
+            deflateReset(&m_zs);
+            out.resize(deflateBound(&m_zs, in.size()));
+            m_zs.next_in = (Bytef *) in.data();
+            m_zs.avail_in = static_cast<uInt>(in.size());
+            m_zs.next_out = (Bytef *) &out[0];
+            m_zs.avail_out = static_cast<uInt>(out.size());
+            if (deflate(&m_zs, Z_FINISH) != Z_STREAM_END) {
+                return false;
+            }
+            out.resize(out.size() - m_zs.avail_out);
+            return true;
+            }
+#ifdef HAVE_ZSTD
+        case calg::ZSTD: {
+            out.resize(ZSTD_compressBound(in.size()));
+            size_t rc = ZSTD_compressCCtx(m_zstd, &out[0], out.size(), in.data(), in.size(),
+                m_level);
+            if (ZSTD_isError(rc)) {
+                return false;
+            }
+            out.resize(rc);
+            return true;
+            }
+#endif
+#ifdef HAVE_LZ4
+        case calg::LZ4: {
+            LZ4F_preferences_t prefs;
+            std::memset(&prefs, 0, sizeof(prefs));
+            prefs.compressionLevel = m_level;
+            out.resize(LZ4F_compressFrameBound(in.size(), &prefs));
+            size_t rc = LZ4F_compressFrame(&out[0], out.size(), in.data(), in.size(), &prefs);
+            if (LZ4F_isError(rc)) {
+                return false;
+            }
+            out.resize(rc);
+            return true;
+            }
+#endif
+        default:
+            return false;
+        }
+    }
+
+private:
+    /** Compression algorithm                                                                    */
+    calg m_alg;
+    /** Compression level                                                                        */
+    int m_level;
+    /** GZIP context                                                                             */
+    z_stream m_zs;
+#ifdef HAVE_ZSTD
+    /** Zstandard context                                                                        */
+    ZSTD_CCtx *m_zstd = nullptr;
+#endif
+};
+
+Compressor::Compressor(ipx_ctx_t *ctx, calg alg, int level, unsigned int threads)
+    : m_ctx(ctx)
+{
+    m_current_ts = {0, 0};
+
+    // Prepare compression contexts
+    const unsigned int codec_cnt = (threads == 0) ? 1 : threads;
+    for (unsigned int i = 0; i < codec_cnt; ++i) {
+        m_codecs.emplace_back(new Codec(alg, level));
+    }
+
+    if (threads == 0) {
+        // Blocks are compressed by the caller
+        return;
+    }
+
+    try {
+        for (unsigned int i = 0; i < threads; ++i) {
+            m_threads.emplace_back(&Compressor::worker_main, this, std::ref(*m_codecs[i]));
+        }
+    } catch (std::system_error &ex) {
+        workers_stop();
+        throw std::runtime_error("(File output) Failed to start compression threads: "
+            + std::string(ex.what()));
+    }
+}
+
+Compressor::~Compressor()
+{
+    workers_stop();
+}
+
+/**
+ * \brief Stop and join all compression threads
+ *
+ * Blocks already passed to the threads are still compressed.
+ */
+void
+Compressor::workers_stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_cv_work.notify_all();
+
+    for (std::thread &thread : m_threads) {
+        thread.join();
+    }
+    m_threads.clear();
+}
+
+/**
+ * \brief Main function of a compression thread
+ * \param[in] codec Compression context of the thread
+ */
+void
+Compressor::worker_main(Codec &codec)
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (true) {
+        m_cv_work.wait(lock, [this]() {return m_stop || !m_queue.empty();});
+        if (m_queue.empty()) {
+            // Stop request
+            break;
+        }
+
+        Block *block = m_queue.front();
+        m_queue.pop_front();
+
+        lock.unlock();
+        bool failed;
+        try {
+            failed = !codec.compress(block->in, block->out);
+        } catch (std::bad_alloc &ex) {
+            failed = true;
+        }
+        lock.lock();
+
+        block->failed = failed;
+        block->done = true;
+        m_cv_done.notify_all();
+    }
+}
+
+const char *
+Compressor::suffix(calg alg)
+{
+    switch (alg) {
+    case calg::GZIP:
+        return ".gz";
+    case calg::ZSTD:
+        return ".zst";
+    case calg::LZ4:
+        return ".lz4";
+    default:
+        return "";
+    }
+}
+
+void
+Compressor::begin(Writer *writer)
+{
+    m_writer = writer;
+}
+
+void
+Compressor::write(const char *data, size_t len)
+{
+    if (!m_current) {
+        if (m_unused.empty()) {
+            m_current.reset(new Block);
+            m_current->in.reserve(BLOCK_SIZE);
+        } else {
+            m_current = std::move(m_unused.back());
+            m_unused.pop_back();
+        }
+    }
+
+    if (m_current->in.empty()) {
+        clock_gettime(CLOCK_MONOTONIC_COARSE, &m_current_ts);
+    }
+
+    m_current->in.append(data, len);
+    if (m_current->in.size() >= BLOCK_SIZE) {
+        submit();
+    }
+}
+
+void
+Compressor::flush()
+{
+    if (m_current && !m_current->in.empty()) {
+        struct timespec now;
+        clock_gettime(CLOCK_MONOTONIC_COARSE, &now);
+        if (now.tv_sec - m_current_ts.tv_sec >= BLOCK_MAX_AGE) {
+            submit();
+        }
+    }
+
+    // Pass only blocks that are already compressed
+    store(SIZE_MAX);
+}
+
+void
+Compressor::finish()
+{
+    if (m_current && !m_current->in.empty()) {
+        submit();
+    }
+
+    store(0);
+    m_writer = nullptr;
+}
+
+/**
+ * \brief Compress the current block
+ *
+ * If compression threads are available, the block is passed to them. Otherwise, it's
+ * compressed immediately. To limit memory usage, the function waits for the oldest blocks,
+ * if too many blocks are waiting to be written.
+ */
+void
+Compressor::submit()
+{
+    Block *block = m_current.get();
+    block->done = false;
+    block->failed = false;
+    m_blocks.push_back(std::move(m_current));
+
+    if (m_threads.empty()) {
+        block->failed = !m_codecs[0]->compress(block->in, block->out);
+        block->done = true;
+    } else {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_queue.push_back(block);
+        }
+        m_cv_work.notify_one();
+    }
+
+    // Keep each thread busy with up to two blocks
+    store(2 * m_threads.size());
+}
+
+/**
+ * \brief Pass compressed blocks to the writer
+ *
+ * Blocks are passed in the original order. Blocks that are not compressed yet are waited for,
+ * while more than \p pending blocks remain. Passed blocks are kept for reuse.
+ * \param[in] pending Maximum number of blocks that can remain waiting
+ */
+void
+Compressor::store(size_t pending)
+{
+    while (!m_blocks.empty()) {
+        Block &block = *m_blocks.front();
+        if (!m_threads.empty()) {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            if (m_blocks.size() > pending) {
+                m_cv_done.wait(lock, [&block]() {return block.done;});
+            } else if (!block.done) {
+                break;
+            }
+        }
+
+        if (block.failed) {
+            IPX_CTX_ERROR(m_ctx, "(File output) Failed to compress a block of records. "
+                "%zu bytes of records have been lost!", block.in.size());
+        } else if (m_writer) {
+            m_writer->write(block.out.data(), block.out.size());
+        }
+
+        block.in.clear();
+        block.out.clear();
+        m_unused.push_back(std::move(m_blocks.front()));
+        m_blocks.pop_front();
+    }
+}
@@ -0,0 +1,180 @@
+/**
+ * \file src/plugins/output/json/src/Compressor.hpp
+ * \author agent <agent@local>
+ * \brief Block compressor of output files (header file)
+ * \date 2026
+ */
+
+/* Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is'', and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+#ifndef JSON_COMPRESSOR_H
+#define JSON_COMPRESSOR_H
+
+#include <condition_variable>
+#include <ctime>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <ipfixcol2.h>
+#include "Config.hpp"
+#include "Writer.hpp"
+
+/**
+ * \brief Block compressor of output files
+ *
+ * Written data are split into blocks and each block is compressed as an independent
+ * frame (a GZIP member, a Zstandard frame or a LZ4 frame) of the selected algorithm.
+ * Concatenated frames form a standard compressed file, which can be decompressed by common
+ * tools. Blocks are compressed in parallel by a pool of threads and compressed blocks
+ * are passed to the writer of the file in the original order by the caller.
+ *
+ * \note The compressor is not thread-safe, all functions must be called by the same thread
+ *   (or under the same lock).
+ */
+class Compressor {
+public:
+    /**
+     * \brief Constructor
+     * \param[in] ctx     Instance context (only for log!)
+     * \param[in] alg     Compression algorithm (must not be calg::NONE)
+     * \param[in] level   Compression level
+     * \param[in] threads Number of compression threads (0 == compress by the caller)
+     * \throw runtime_error if the algorithm is not supported or the threads cannot be started
+     */
+    Compressor(ipx_ctx_t *ctx, calg alg, int level, unsigned int threads);
+    /** \brief Destructor (pending blocks are discarded, see finish())                           */
+    ~Compressor();
+
+    // Disable copy constructors
+    Compressor(const Compressor &other) = delete;
+    Compressor &operator=(const Compressor &other) = delete;
+
+    /**
+     * \brief Start to write compressed data to a file
+     * \param[in] writer Writer of an opened file (the caller is still responsible for closing)
+     */
+    void
+    begin(Writer *writer);
+    /**
+     * \brief Append data to the file
+     *
+     * Data are compressed as soon as the current block is full.
+     * \param[in] data Data to write
+     * \param[in] len  Length of the data
+     */
+    void
+    write(const char *data, size_t len);
+    /**
+     * \brief Pass already compressed blocks to the writer
+     *
+     * The current block is compressed, if it has not been filled for a while.
+     */
+    void
+    flush();
+    /**
+     * \brief Compress all remaining data and pass them to the writer
+     *
+     * The function waits until all blocks are compressed. Afterwards, the file can be closed
+     * by the caller.
+     */
+    void
+    finish();
+
+    /**
+     * \brief Get a file name suffix of a compression algorithm
+     * \param[in] alg Compression algorithm
+     * \return Suffix (e.g. ".gz") or an empty string
+     */
+    static const char *
+    suffix(calg alg);
+
+private:
+    class Codec;
+
+    /** Block of data                                                                            */
+    struct Block {
+        /** Uncompressed data                                                                    */
+        std::string in;
+        /** Compressed data                                                                      */
+        std::string out;
+        /** Compression has been finished (protected by the mutex)                               */
+        bool done;
+        /** Compression has failed                                                               */
+        bool failed;
+    };
+
+    /** Instance context (only for log!)                                                         */
+    ipx_ctx_t *m_ctx;
+    /** Writer of the output file                                                                */
+    Writer *m_writer = nullptr;
+    /** Compression contexts (one per thread or one for the caller)                              */
+    std::vector<std::unique_ptr<Codec>> m_codecs;
+    /** Compression threads                                                                      */
+    std::vector<std::thread> m_threads;
+
+    /** Block being filled (can be nullptr)                                                      */
+    std::unique_ptr<Block> m_current;
+    /** Time when the first data were added to the current block                                 */
+    struct timespec m_current_ts;
+    /** Blocks waiting to be written to the file (in the original order)                         */
+    std::deque<std::unique_ptr<Block>> m_blocks;
+    /** Unused blocks ready to be reused                                                         */
+    std::vector<std::unique_ptr<Block>> m_unused;
+
+    /** Synchronization of compression threads                                                   */
+    std::mutex m_mutex;
+    /** Notification about new blocks to compress                                                */
+    std::condition_variable m_cv_work;
+    /** Notification about compressed blocks                                                     */
+    std::condition_variable m_cv_done;
+    /** Blocks waiting to be compressed (protected by the mutex)                                 */
+    std::deque<Block *> m_queue;
+    /** Stop flag of compression threads (protected by the mutex)                                */
+    bool m_stop = false;
+
+    // Compress the current block (or pass it to the threads)
+    void submit();
+    // Pass compressed blocks to the writer
+    void store(size_t pending);
+    // Main function of a compression thread
+    void worker_main(Codec &codec);
+    // Stop and join all compression threads
+    void workers_stop();
+};
+
+#endif // JSON_COMPRESSOR_H
@@ -40,10 +40,10 @@
  */
 
 #include <algorithm>
+#include <climits>
 #include <cstdio>
 #include <memory>
 #include <set>
-#include <sstream>
 #include <stdexcept>
 
 #include <libfds.h>
@@ -63,6 +63,52 @@
 
 #define SYSLOG_APPNAME_MAX_LEN 48
 
+#define SYSLOG_BATCH_MIN 1
+#define SYSLOG_BATCH_MAX 1024
+#define SYSLOG_BATCH_DEF 64
+
+/** Default port of an Elasticsearch/OpenSearch node   */
+#define ELASTIC_PORT_DEF 9200
+/** Default number of concurrent bulk requests         */
+#define ELASTIC_CONN_DEF 2
+/** Upper limit of the number of concurrent requests   */
+#define ELASTIC_CONN_MAX 64
+/** Default size of a bulk request (bytes)             */
+#define ELASTIC_BULK_DEF (5U * 1024U * 1024U)
+/** Minimal size of a bulk request (bytes)             */
+#define ELASTIC_BULK_MIN (64U * 1024U)
+/** Upper limit of the size of a bulk request (bytes)  */
+#define ELASTIC_BULK_MAX (100U * 1024U * 1024U)
+/** Default flush interval of a bulk (milliseconds)    */
+#define ELASTIC_FLUSH_DEF 1000
+/** Default number of retries of rejected documents    */
+#define ELASTIC_RETRIES_DEF 3
+
+/** Default size of a client buffer of a server (bytes) */
+#define SERVER_BUFFER_DEF (8U * 1024U * 1024U)
+/** Minimal size of a client buffer of a server (bytes) */
+#define SERVER_BUFFER_MIN (64U * 1024U)
+
+/** Default GZIP compression level                     */
+#define FILE_GZIP_LEVEL_DEF 6
+/** Default Zstandard compression level                */
+#define FILE_ZSTD_LEVEL_DEF 3
+/** Default LZ4 compression level                      */
+#define FILE_LZ4_LEVEL_DEF 0
+/** Upper limit of the number of compression threads   */
+#define FILE_THREADS_MAX 64
+/** Upper limit of the number of Kafka producer shards */
+#define KAFKA_SHARDS_MAX 64
+
+/** Default maximum number of records in a batch       */
+#define BATCH_RECS_DEF 256
+/** Upper limit of the maximum number of records in a batch */
+#define BATCH_RECS_MAX 65536
+/** Upper limit of the timeout of a batch (microseconds) */
+#define BATCH_TIMEOUT_MAX 10000000
+/** Upper limit of the number of conversion threads    */
+#define THREADS_MAX 64
+
 /** XML nodes */
 enum params_xml_nodes {
     // Formatting parameters
@@ -77,6 +123,15 @@ enum params_xml_nodes {
     FMT_BFSPLIT,       /**< Split biflow                    */
     FMT_DETAILEDINFO,  /**< Detailed information            */
     FMT_TMPLTINFO,     /**< Template records                */
+    FMT_SAMPLED,       /**< Sampled records only            */
+    FMT_ENRICH,        /**< Values of IP prefixes           */
+    FMT_INCLUDE,       /**< Fields to convert               */
+    FMT_EXCLUDE,       /**< Fields to skip                  */
+    FMT_FIELD,         /**< Name of a field                 */
+    // Batching
+    BATCH_RECS,        /**< Maximum records in a batch      */
+    BATCH_TIMEOUT,     /**< Maximum age of a batch          */
+    THREADS,           /**< Number of conversion threads    */
     // Common output
     OUTPUT_LIST,       /**< List of output types            */
     OUTPUT_PRINT,      /**< Print to standard output        */
@@ -85,6 +140,7 @@ enum params_xml_nodes {
     OUTPUT_FILE,       /**< Store to file                   */
     OUTPUT_KAFKA,      /**< Store to Kafka                  */
     OUTPUT_SYSLOG,     /**< Store to syslog                 */
+    OUTPUT_ELASTIC,    /**< Store to Elasticsearch          */
     // Standard output
     PRINT_NAME,        /**< Printer name                    */
     // Send output
@@ -97,6 +153,8 @@ enum params_xml_nodes {
     SERVER_NAME,       /**< Server name                     */
     SERVER_PORT,       /**< Server port                     */
     SERVER_BLOCK,      /**< Blocking connection             */
+    SERVER_SLOW,       /**< Policy for slow clients         */
+    SERVER_BUFFER,     /**< Size of a client buffer         */
     // FIle output
     FILE_NAME,         /**< File storage name               */
     FILE_PATH,         /**< Path specification format       */
@@ -104,6 +162,10 @@ enum params_xml_nodes {
     FILE_WINDOW,       /**< Window interval                 */
     FILE_ALIGN,        /**< Window alignment                */
     FILE_COMPRESS,     /**< Compression                     */
+    FILE_LEVEL,        /**< Compression level               */
+    FILE_THREADS,      /**< Compression threads             */
+    FILE_DIRECT,       /**< Direct I/O                      */
+    FILE_SYNC,         /**< Synchronization policy          */
     // Kafka output
     KAFKA_NAME,        /**< Name of the output              */
     KAFKA_BROKERS,     /**< List of brokers                 */
@@ -112,6 +174,10 @@ enum params_xml_nodes {
     KAFKA_BVERSION,    /**< Broker fallback version         */
     KAFKA_BLOCKING,    /**< Block when queue is full        */
     KAFKA_PERF_TUN,    /**< Add performance tuning options  */
+    KAFKA_PACK_SIZE,   /**< Size of packs of records        */
+    KAFKA_PACK_TIME,   /**< Timeout of packs of records     */
+    KAFKA_KEY,         /**< Type of message keys            */
+    KAFKA_SHARDS,      /**< Number of producer shards       */
     KAFKA_PROPERTY,    /**< Additional librdkafka property  */
     KAFKA_PROP_KEY,    /**< Property key                    */
     KAFKA_PROP_VALUE,  /**< Property value                  */
@@ -123,6 +189,8 @@ enum params_xml_nodes {
     SYSLOG_HOSTNAME,   /**< Hostname                        */
     SYSLOG_PROGRAM,    /**< Application name                */
     SYSLOG_PROCID,     /**< Application PID                 */
+    SYSLOG_BATCH,      /**< Batch size                      */
+    SYSLOG_FLUSH,      /**< Flush interval                  */
     SYSLOG_TRANSPORT,  /**< Transport configuration         */
     SYSLOG_TCP,        /**< TCP socket configuration        */
     SYSLOG_TCP_HOST,   /**< Destination host (TCP)          */
@@ -131,6 +199,19 @@ enum params_xml_nodes {
     SYSLOG_UDP,        /**< UDP socket configuration        */
     SYSLOG_UDP_HOST,   /**< Destination host (UDP)          */
     SYSLOG_UDP_PORT,   /**< Destination port (UDP)          */
+    // Elasticsearch output
+    ELASTIC_NAME,      /**< Name of the output              */
+    ELASTIC_HOST,      /**< Hostname of a node              */
+    ELASTIC_PORT,      /**< Port of a node                  */
+    ELASTIC_INDEX,     /**< Target index                    */
+    ELASTIC_USER,      /**< User name                       */
+    ELASTIC_PASSWORD,  /**< Password                        */
+    ELASTIC_GZIP,      /**< Compression of requests         */
+    ELASTIC_CONN,      /**< Number of concurrent requests   */
+    ELASTIC_BULK,      /**< Size of bulk requests           */
+    ELASTIC_FLUSH,     /**< Flush interval                  */
+    ELASTIC_RETRIES,   /**< Retries of rejected documents   */
+    ELASTIC_BLOCK,     /**< Block when connections are busy */
 };
 
 /** Definition of the \<print\> node  */
@@ -144,6 +225,8 @@ static const struct fds_xml_args args_server[] = {
     FDS_OPTS_ELEM(SERVER_NAME,  "name",     FDS_OPTS_T_STRING, 0),
     FDS_OPTS_ELEM(SERVER_PORT,  "port",     FDS_OPTS_T_UINT,   0),
     FDS_OPTS_ELEM(SERVER_BLOCK, "blocking", FDS_OPTS_T_BOOL,   0),
+    FDS_OPTS_ELEM(SERVER_SLOW,  "slowClient",   FDS_OPTS_T_STRING, FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM(SERVER_BUFFER, "clientBuffer", FDS_OPTS_T_UINT,  FDS_OPTS_P_OPT),
     FDS_OPTS_END
 };
 
@@ -165,6 +248,10 @@ static const struct fds_xml_args args_file[] = {
     FDS_OPTS_ELEM(FILE_WINDOW, "timeWindow",    FDS_OPTS_T_UINT,   0),
     FDS_OPTS_ELEM(FILE_ALIGN,  "timeAlignment", FDS_OPTS_T_BOOL,   0),
     FDS_OPTS_ELEM(FILE_COMPRESS, "compression", FDS_OPTS_T_STRING, FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM(FILE_LEVEL,    "compressionLevel",   FDS_OPTS_T_UINT, FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM(FILE_THREADS,  "compressionThreads", FDS_OPTS_T_UINT, FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM(FILE_DIRECT,   "directIO",      FDS_OPTS_T_BOOL,   FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM(FILE_SYNC,     "sync",          FDS_OPTS_T_STRING, FDS_OPTS_P_OPT),
     FDS_OPTS_END
 };
 
@@ -184,6 +271,10 @@ static const struct fds_xml_args args_kafka[] = {
     FDS_OPTS_ELEM(KAFKA_BVERSION,   "brokerVersion", FDS_OPTS_T_STRING, FDS_OPTS_P_OPT),
     FDS_OPTS_ELEM(KAFKA_BLOCKING,   "blocking",      FDS_OPTS_T_BOOL,   FDS_OPTS_P_OPT),
     FDS_OPTS_ELEM(KAFKA_PERF_TUN,   "performanceTuning", FDS_OPTS_T_BOOL, FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM(KAFKA_PACK_SIZE,  "packSize",      FDS_OPTS_T_UINT,   FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM(KAFKA_PACK_TIME,  "packTimeout",   FDS_OPTS_T_UINT,   FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM(KAFKA_KEY,        "partitionKey",  FDS_OPTS_T_STRING, FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM(KAFKA_SHARDS,     "shards",        FDS_OPTS_T_UINT,   FDS_OPTS_P_OPT),
     FDS_OPTS_NESTED(KAFKA_PROPERTY, "property", args_kafka_prop, FDS_OPTS_P_OPT | FDS_OPTS_P_MULTI),
     FDS_OPTS_END
 };
@@ -223,11 +314,30 @@ static const struct fds_xml_args args_syslog[] = {
     FDS_OPTS_ELEM(SYSLOG_HOSTNAME,    "hostname",  FDS_OPTS_T_STRING,     FDS_OPTS_P_OPT),
     FDS_OPTS_ELEM(SYSLOG_PROGRAM,     "program",   FDS_OPTS_T_STRING,     FDS_OPTS_P_OPT),
     FDS_OPTS_ELEM(SYSLOG_PROCID,      "procId",    FDS_OPTS_T_BOOL,       FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM(SYSLOG_BATCH,       "batchSize", FDS_OPTS_T_UINT,       FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM(SYSLOG_FLUSH,   "flushInterval", FDS_OPTS_T_UINT,       FDS_OPTS_P_OPT),
     FDS_OPTS_NESTED(SYSLOG_PRI,       "priority",  args_syslog_priority,  FDS_OPTS_P_OPT),
     FDS_OPTS_NESTED(SYSLOG_TRANSPORT, "transport", args_syslog_transport, 0),
     FDS_OPTS_END
 };
 
+/** Definition of the \<elastic\> node  */
+static const struct fds_xml_args args_elastic[] = {
+    FDS_OPTS_ELEM(ELASTIC_NAME,     "name",          FDS_OPTS_T_STRING, 0),
+    FDS_OPTS_ELEM(ELASTIC_HOST,     "host",          FDS_OPTS_T_STRING, 0),
+    FDS_OPTS_ELEM(ELASTIC_PORT,     "port",          FDS_OPTS_T_UINT,   FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM(ELASTIC_INDEX,    "index",         FDS_OPTS_T_STRING, 0),
+    FDS_OPTS_ELEM(ELASTIC_USER,     "user",          FDS_OPTS_T_STRING, FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM(ELASTIC_PASSWORD, "password",      FDS_OPTS_T_STRING, FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM(ELASTIC_GZIP,     "gzip",          FDS_OPTS_T_BOOL,   FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM(ELASTIC_CONN,     "connections",   FDS_OPTS_T_UINT,   FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM(ELASTIC_BULK,     "bulkSize",      FDS_OPTS_T_UINT,   FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM(ELASTIC_FLUSH,    "flushInterval", FDS_OPTS_T_UINT,   FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM(ELASTIC_RETRIES,  "retries",       FDS_OPTS_T_UINT,   FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM(ELASTIC_BLOCK,    "blocking",      FDS_OPTS_T_BOOL,   FDS_OPTS_P_OPT),
+    FDS_OPTS_END
+};
+
 /** Definition of the \<outputs\> node  */
 static const struct fds_xml_args args_outputs[] = {
     FDS_OPTS_NESTED(OUTPUT_PRINT,  "print",  args_print,  FDS_OPTS_P_OPT | FDS_OPTS_P_MULTI),
@@ -236,6 +346,13 @@ static const struct fds_xml_args args_outputs[] = {
     FDS_OPTS_NESTED(OUTPUT_FILE,   "file",   args_file,   FDS_OPTS_P_OPT | FDS_OPTS_P_MULTI),
     FDS_OPTS_NESTED(OUTPUT_KAFKA,  "kafka",  args_kafka,  FDS_OPTS_P_OPT | FDS_OPTS_P_MULTI),
     FDS_OPTS_NESTED(OUTPUT_SYSLOG, "syslog", args_syslog, FDS_OPTS_P_OPT | FDS_OPTS_P_MULTI),
+    FDS_OPTS_NESTED(OUTPUT_ELASTIC, "elastic", args_elastic, FDS_OPTS_P_OPT | FDS_OPTS_P_MULTI),
+    FDS_OPTS_END
+};
+
+/** Definition of the \<includeFields\> and \<excludeFields\> nodes  */
+static const struct fds_xml_args args_fields[] = {
+    FDS_OPTS_ELEM(FMT_FIELD, "field", FDS_OPTS_T_STRING, FDS_OPTS_P_MULTI),
     FDS_OPTS_END
 };
 
@@ -253,6 +370,13 @@ static const struct fds_xml_args args_params[] = {
     FDS_OPTS_ELEM(FMT_BFSPLIT,   "splitBiflow",      FDS_OPTS_T_BOOL, FDS_OPTS_P_OPT),
     FDS_OPTS_ELEM(FMT_DETAILEDINFO,  "detailedInfo", FDS_OPTS_T_BOOL, FDS_OPTS_P_OPT),
     FDS_OPTS_ELEM(FMT_TMPLTINFO, "templateInfo", FDS_OPTS_T_BOOL, FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM(FMT_SAMPLED,   "sampledOnly",  FDS_OPTS_T_BOOL, FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM(FMT_ENRICH,    "enrichment",   FDS_OPTS_T_BOOL, FDS_OPTS_P_OPT),
+    FDS_OPTS_NESTED(FMT_INCLUDE, "includeFields", args_fields, FDS_OPTS_P_OPT),
+    FDS_OPTS_NESTED(FMT_EXCLUDE, "excludeFields", args_fields, FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM(BATCH_RECS,    "batchRecords", FDS_OPTS_T_UINT, FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM(BATCH_TIMEOUT, "batchTimeout", FDS_OPTS_T_UINT, FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM(THREADS,       "threads",      FDS_OPTS_T_UINT, FDS_OPTS_P_OPT),
     FDS_OPTS_NESTED(OUTPUT_LIST, "outputs",   args_outputs, 0),
     FDS_OPTS_END
 };
@@ -352,6 +476,8 @@ Config::parse_server(fds_xml_ctx_t *server)
     struct cfg_server output;
     output.port = 0;
     output.blocking = false;
+    output.slow = slow_policy::DROP;
+    output.client_buffer = SERVER_BUFFER_DEF;
 
     const struct fds_xml_cont *content;
     while (fds_xml_next(server, &content) != FDS_EOC) {
@@ -372,6 +498,25 @@ Config::parse_server(fds_xml_ctx_t *server)
             assert(content->type == FDS_OPTS_T_BOOL);
             output.blocking = content->val_bool;
             break;
+        case SERVER_SLOW:
+            assert(content->type == FDS_OPTS_T_STRING);
+            if (strcasecmp(content->ptr_string, "drop") == 0) {
+                output.slow = slow_policy::DROP;
+            } else if (strcasecmp(content->ptr_string, "disconnect") == 0) {
+                output.slow = slow_policy::DISCONNECT;
+            } else {
+                const std::string inv_str = content->ptr_string;
+                throw std::invalid_argument("Unknown policy for slow clients '" + inv_str + "'");
+            }
+            break;
+        case SERVER_BUFFER:
+            assert(content->type == FDS_OPTS_T_UINT);
+            if (content->val_uint < SERVER_BUFFER_MIN) {
+                throw std::invalid_argument("Size of a client buffer of a <server> output must "
+                    "be at least " + std::to_string(SERVER_BUFFER_MIN) + " bytes!");
+            }
+            output.client_buffer = content->val_uint;
+            break;
         default:
             throw std::invalid_argument("Unexpected element within <server>!");
         }
@@ -459,6 +604,10 @@ Config::parse_file(fds_xml_ctx_t *file)
     output.window_align = true;
     output.window_size = 300;
     output.m_calg = calg::NONE;
+    output.level = -1;
+    output.threads = 1;
+    output.direct_io = false;
+    output.sync = sync_policy::NONE;
 
     const struct fds_xml_cont *content;
     while (fds_xml_next(file, &content) != FDS_EOC) {
@@ -495,11 +644,48 @@ Config::parse_file(fds_xml_ctx_t *file)
                 output.m_calg = calg::NONE;
             } else if (strcasecmp(content->ptr_string, "gzip") == 0) {
                 output.m_calg = calg::GZIP;
+            } else if (strcasecmp(content->ptr_string, "zstd") == 0) {
+                output.m_calg = calg::ZSTD;
+            } else if (strcasecmp(content->ptr_string, "lz4") == 0) {
+                output.m_calg = calg::LZ4;
             } else {
                 const std::string inv_str = content->ptr_string;
                 throw std::invalid_argument("Unknown compression algorithm '" + inv_str + "'");
             }
             break;
+        case FILE_LEVEL:
+            // Compression level (checked later, depends on the algorithm)
+            assert(content->type == FDS_OPTS_T_UINT);
+            output.level = static_cast<int>(std::min<uint64_t>(content->val_uint, INT_MAX));
+            break;
+        case FILE_THREADS:
+            // Number of compression threads
+            assert(content->type == FDS_OPTS_T_UINT);
+            if (content->val_uint > FILE_THREADS_MAX) {
+                throw std::invalid_argument("Number of compression threads must be between 0.."
+                    + std::to_string(FILE_THREADS_MAX) + "!");
+            }
+            output.threads = static_cast<uint32_t>(content->val_uint);
+            break;
+        case FILE_DIRECT:
+            // Bypass the page cache
+            assert(content->type == FDS_OPTS_T_BOOL);
+            output.direct_io = content->val_bool;
+            break;
+        case FILE_SYNC:
+            // Synchronization policy
+            assert(content->type == FDS_OPTS_T_STRING);
+            if (strcasecmp(content->ptr_string, "none") == 0) {
+                output.sync = sync_policy::NONE;
+            } else if (strcasecmp(content->ptr_string, "close") == 0) {
+                output.sync = sync_policy::CLOSE;
+            } else if (strcasecmp(content->ptr_string, "buffer") == 0) {
+                output.sync = sync_policy::BUFFER;
+            } else {
+                const std::string inv_str = content->ptr_string;
+                throw std::invalid_argument("Unknown synchronization policy '" + inv_str + "'");
+            }
+            break;
         default:
             throw std::invalid_argument("Unexpected element within <file>!");
         }
@@ -514,6 +700,40 @@ Config::parse_file(fds_xml_ctx_t *file)
             + "' must be defined!");
     }
 
+    // Check the compression level
+    int level_min = 0;
+    int level_max = 0;
+    int level_def = 0;
+    switch (output.m_calg) {
+    case calg::GZIP:
+        level_min = 1;
+        level_max = 9;
+        level_def = FILE_GZIP_LEVEL_DEF;
+        break;
+    case calg::ZSTD:
+        level_min = 1;
+        level_max = 22;
+        level_def = FILE_ZSTD_LEVEL_DEF;
+        break;
+    case calg::LZ4:
+        level_min = 0;
+        level_max = 12;
+        level_def = FILE_LZ4_LEVEL_DEF;
+        break;
+    default:
+        // Not used
+        level_max = INT_MAX;
+        break;
+    }
+
+    if (output.level < 0) {
+        output.level = level_def;
+    } else if (output.level < level_min || output.level > level_max) {
+        throw std::invalid_argument("Compression level of the output '" + output.name
+            + "' must be between " + std::to_string(level_min) + ".."
+            + std::to_string(level_max) + "!");
+    }
+
     outputs.files.push_back(output);
 }
 
@@ -567,6 +787,10 @@ Config::parse_kafka(fds_xml_ctx_t *kafka)
     output.partition = RD_KAFKA_PARTITION_UA;
     output.blocking = false;
     output.perf_tuning = true;
+    output.pack_size = 0;
+    output.pack_timeout = 0;
+    output.key = part_key::NONE;
+    output.shards = 1;
 
     // For partition parser
     int32_t value;
@@ -611,6 +835,46 @@ Config::parse_kafka(fds_xml_ctx_t *kafka)
             assert(content->type == FDS_OPTS_T_BOOL);
             output.perf_tuning = content->val_bool;
             break;
+        case KAFKA_PACK_SIZE:
+            assert(content->type == FDS_OPTS_T_UINT);
+            if (content->val_uint > UINT32_MAX) {
+                throw std::invalid_argument("Pack size of a <kafka> output is too big!");
+            }
+            output.pack_size = static_cast<uint32_t>(content->val_uint);
+            break;
+        case KAFKA_PACK_TIME:
+            assert(content->type == FDS_OPTS_T_UINT);
+            if (content->val_uint > UINT32_MAX) {
+                throw std::invalid_argument("Pack timeout of a <kafka> output is too big!");
+            }
+            output.pack_timeout = static_cast<uint32_t>(content->val_uint);
+            break;
+        case KAFKA_KEY:
+            assert(content->type == FDS_OPTS_T_STRING);
+            if (strcasecmp(content->ptr_string, "none") == 0) {
+                output.key = part_key::NONE;
+            } else if (strcasecmp(content->ptr_string, "odid") == 0) {
+                output.key = part_key::ODID;
+            } else if (strcasecmp(content->ptr_string, "exporter") == 0) {
+                output.key = part_key::EXPORTER;
+            } else if (strcasecmp(content->ptr_string, "srcIP") == 0) {
+                output.key = part_key::SRC_IP;
+            } else if (strcasecmp(content->ptr_string, "flow") == 0) {
+                output.key = part_key::FLOW;
+            } else {
+                const std::string inv_str = content->ptr_string;
+                throw std::invalid_argument("Unknown partition key '" + inv_str + "' of a <kafka> "
+                    "output!");
+            }
+            break;
+        case KAFKA_SHARDS:
+            assert(content->type == FDS_OPTS_T_UINT);
+            if (content->val_uint == 0 || content->val_uint > KAFKA_SHARDS_MAX) {
+                throw std::invalid_argument("Number of shards of a <kafka> output must be between "
+                    "1.." + std::to_string(KAFKA_SHARDS_MAX) + "!");
+            }
+            output.shards = static_cast<uint32_t>(content->val_uint);
+            break;
         case KAFKA_PROPERTY:
             assert(content->type == FDS_OPTS_T_CONTEXT);
             parse_kafka_property(output, content->ptr_ctx);
@@ -634,6 +898,10 @@ Config::parse_kafka(fds_xml_ctx_t *kafka)
             throw std::invalid_argument("Broker version of a <kafka> output is not invalid!");
         }
     }
+    if (output.shards > 1 && output.partition != RD_KAFKA_PARTITION_UA) {
+        throw std::invalid_argument("Multiple shards and fixed partition of a <kafka> output "
+            "cannot be combined!");
+    }
 
     outputs.kafkas.push_back(output);
 }
@@ -791,6 +1059,8 @@ Config::parse_syslog(fds_xml_ctx_t *syslog)
     output.priority.severity = SYSLOG_SEVERITY_DEF;
     output.hostname = syslog_hostname::NONE;
     output.proc_id = false;
+    output.batch_size = SYSLOG_BATCH_DEF;
+    output.flush_interval = 0;
 
     const struct fds_xml_cont *content;
     while (fds_xml_next(syslog, &content) != FDS_EOC) {
@@ -818,6 +1088,22 @@ Config::parse_syslog(fds_xml_ctx_t *syslog)
             assert(content->type == FDS_OPTS_T_BOOL);
             output.proc_id = content->val_bool;
             break;
+        case SYSLOG_BATCH:
+            assert(content->type == FDS_OPTS_T_UINT);
+            if (content->val_uint < SYSLOG_BATCH_MIN || content->val_uint > SYSLOG_BATCH_MAX) {
+                throw std::invalid_argument("Syslog batch size must be between "
+                    + std::to_string(SYSLOG_BATCH_MIN) + " and "
+                    + std::to_string(SYSLOG_BATCH_MAX) + "!");
+            }
+            output.batch_size = static_cast<uint32_t>(content->val_uint);
+            break;
+        case SYSLOG_FLUSH:
+            assert(content->type == FDS_OPTS_T_UINT);
+            if (content->val_uint > UINT32_MAX) {
+                throw std::invalid_argument("Syslog flush interval is too big!");
+            }
+            output.flush_interval = static_cast<uint32_t>(content->val_uint);
+            break;
         case SYSLOG_PRI:
             assert(content->type == FDS_OPTS_T_CONTEXT);
             parse_syslog_priority(output, content->ptr_ctx);
@@ -846,6 +1132,120 @@ Config::parse_syslog(fds_xml_ctx_t *syslog)
     outputs.syslogs.emplace_back(std::move(output));
 }
 
+/**
+ * \brief Parse "elastic" output parameters
+ *
+ * Successfully parsed output is added to the vector of outputs
+ * \param[in] elastic Parsed XML context
+ * \throw invalid_argument or runtime_error
+ */
+void
+Config::parse_elastic(fds_xml_ctx_t *elastic)
+{
+    // Prepare default values
+    struct cfg_elastic output;
+    output.port = ELASTIC_PORT_DEF;
+    output.gzip = true;
+    output.connections = ELASTIC_CONN_DEF;
+    output.bulk_size = ELASTIC_BULK_DEF;
+    output.flush_interval = ELASTIC_FLUSH_DEF;
+    output.retries = ELASTIC_RETRIES_DEF;
+    output.blocking = true;
+
+    const struct fds_xml_cont *content;
+    while (fds_xml_next(elastic, &content) != FDS_EOC) {
+        switch (content->id) {
+        case ELASTIC_NAME:
+            assert(content->type == FDS_OPTS_T_STRING);
+            output.name = content->ptr_string;
+            break;
+        case ELASTIC_HOST:
+            assert(content->type == FDS_OPTS_T_STRING);
+            output.host = content->ptr_string;
+            break;
+        case ELASTIC_PORT:
+            assert(content->type == FDS_OPTS_T_UINT);
+            if (content->val_uint > UINT16_MAX || content->val_uint == 0) {
+                throw std::invalid_argument("Invalid port number of an <elastic> output!");
+            }
+            output.port = static_cast<uint16_t>(content->val_uint);
+            break;
+        case ELASTIC_INDEX:
+            assert(content->type == FDS_OPTS_T_STRING);
+            output.index = content->ptr_string;
+            break;
+        case ELASTIC_USER:
+            assert(content->type == FDS_OPTS_T_STRING);
+            output.user = content->ptr_string;
+            break;
+        case ELASTIC_PASSWORD:
+            assert(content->type == FDS_OPTS_T_STRING);
+            output.password = content->ptr_string;
+            break;
+        case ELASTIC_GZIP:
+            assert(content->type == FDS_OPTS_T_BOOL);
+            output.gzip = content->val_bool;
+            break;
+        case ELASTIC_CONN:
+            assert(content->type == FDS_OPTS_T_UINT);
+            if (content->val_uint == 0 || content->val_uint > ELASTIC_CONN_MAX) {
+                throw std::invalid_argument("Number of connections of an <elastic> output must "
+                    "be between 1 and " + std::to_string(ELASTIC_CONN_MAX) + "!");
+            }
+            output.connections = static_cast<uint32_t>(content->val_uint);
+            break;
+        case ELASTIC_BULK:
+            assert(content->type == FDS_OPTS_T_UINT);
+            if (content->val_uint < ELASTIC_BULK_MIN || content->val_uint > ELASTIC_BULK_MAX) {
+                throw std::invalid_argument("Bulk size of an <elastic> output must be between "
+                    + std::to_string(ELASTIC_BULK_MIN) + " and "
+                    + std::to_string(ELASTIC_BULK_MAX) + " bytes!");
+            }
+            output.bulk_size = static_cast<uint32_t>(content->val_uint);
+            break;
+        case ELASTIC_FLUSH:
+            assert(content->type == FDS_OPTS_T_UINT);
+            if (content->val_uint > UINT32_MAX) {
+                throw std::invalid_argument("Flush interval of an <elastic> output is too big!");
+            }
+            output.flush_interval = static_cast<uint32_t>(content->val_uint);
+            break;
+        case ELASTIC_RETRIES:
+            assert(content->type == FDS_OPTS_T_UINT);
+            if (content->val_uint > UINT32_MAX) {
+                throw std::invalid_argument("Number of retries of an <elastic> output is too "
+                    "big!");
+            }
+            output.retries = static_cast<uint32_t>(content->val_uint);
+            break;
+        case ELASTIC_BLOCK:
+            assert(content->type == FDS_OPTS_T_BOOL);
+            output.blocking = content->val_bool;
+            break;
+        default:
+            throw std::invalid_argument("Unexpected element within <elastic>!");
+        }
+    }
+
+    if (output.name.empty()) {
+        throw std::runtime_error("Name of an <elastic> output must be defined!");
+    }
+
+    if (output.host.empty()) {
+        throw std::runtime_error("Host of the output <elastic> '" + output.name
+            + "' must be defined!");
+    }
+
+    // The index is a part of the URL of requests
+    if (output.index.empty() || output.index[0] == '_'
+            || output.index.find_first_of(" \"#%*,/<>?\\|") != std::string::npos) {
+        throw std::runtime_error("Value of the element <index> of the output <elastic> '"
+            + output.name + "' is not a valid index name!");
+    }
+
+    outputs.elastics.push_back(output);
+}
+
 /**
  * \brief Parse list of outputs
  * \param[in] outputs Parsed XML context
@@ -876,12 +1276,46 @@ Config::parse_outputs(fds_xml_ctx_t *outputs)
         case OUTPUT_SYSLOG:
             parse_syslog(content->ptr_ctx);
             break;
+        case OUTPUT_ELASTIC:
+            parse_elastic(content->ptr_ctx);
+            break;
         default:
             throw std::invalid_argument("Unexpected element within <outputs>!");
         }
     }
 }
 
+/**
+ * \brief Parse a list of fields to convert (or to skip)
+ * \param[in] fields XML context of the list
+ * \param[in] sel    Type of the selection
+ * \throw invalid_argument if the list is not valid
+ */
+void
+Config::parse_fields(fds_xml_ctx_t *fields, field_sel sel)
+{
+    if (format.fields_sel != field_sel::ALL) {
+        throw std::invalid_argument("<includeFields> and <excludeFields> cannot be combined!");
+    }
+
+    const struct fds_xml_cont *content;
+    while (fds_xml_next(fields, &content) != FDS_EOC) {
+        switch (content->id) {
+        case FMT_FIELD:
+            assert(content->type == FDS_OPTS_T_STRING);
+            if (content->ptr_string[0] == '\0') {
+                throw std::invalid_argument("Name of a <field> cannot be empty!");
+            }
+            format.fields.emplace_back(content->ptr_string);
+            break;
+        default:
+            throw std::invalid_argument("Unexpected element within a list of fields!");
+        }
+    }
+
+    format.fields_sel = sel;
+}
+
 /**
  * \brief Parse all parameters
  *
@@ -940,6 +1374,46 @@ Config::parse_params(fds_xml_ctx_t *params)
             assert(content->type == FDS_OPTS_T_BOOL);
             format.template_info = content->val_bool;
             break;
+        case FMT_SAMPLED: // Convert only sampled records
+            assert(content->type == FDS_OPTS_T_BOOL);
+            format.sampled_only = content->val_bool;
+            break;
+        case FMT_ENRICH: // Add values of IP prefixes
+            assert(content->type == FDS_OPTS_T_BOOL);
+            format.enrichment = content->val_bool;
+            break;
+        case FMT_INCLUDE: // Convert only listed fields
+            assert(content->type == FDS_OPTS_T_CONTEXT);
+            parse_fields(content->ptr_ctx, field_sel::INCLUDE);
+            break;
+        case FMT_EXCLUDE: // Convert all fields except listed fields
+            assert(content->type == FDS_OPTS_T_CONTEXT);
+            parse_fields(content->ptr_ctx, field_sel::EXCLUDE);
+            break;
+        case BATCH_RECS: // Maximum number of records in a batch
+            assert(content->type == FDS_OPTS_T_UINT);
+            if (content->val_uint == 0 || content->val_uint > BATCH_RECS_MAX) {
+                throw std::invalid_argument("Number of records in a batch must be between 1.."
+                    + std::to_string(BATCH_RECS_MAX) + "!");
+            }
+            format.batch_recs = static_cast<uint32_t>(content->val_uint);
+            break;
+        case BATCH_TIMEOUT: // Maximum age of a batch
+            assert(content->type == FDS_OPTS_T_UINT);
+            if (content->val_uint > BATCH_TIMEOUT_MAX) {
+                throw std::invalid_argument("Timeout of a batch must be between 0.."
+                    + std::to_string(BATCH_TIMEOUT_MAX) + " microseconds!");
+            }
+            format.batch_timeout = static_cast<uint32_t>(content->val_uint);
+            break;
+        case THREADS: // Number of conversion threads
+            assert(content->type == FDS_OPTS_T_UINT);
+            if (content->val_uint == 0 || content->val_uint > THREADS_MAX) {
+                throw std::invalid_argument("Number of threads must be between 1.."
+                    + std::to_string(THREADS_MAX) + "!");
+            }
+            format.threads = static_cast<uint32_t>(content->val_uint);
+            break;
         case OUTPUT_LIST: // List of output plugin
             assert(content->type == FDS_OPTS_T_CONTEXT);
             parse_outputs(content->ptr_ctx);
@@ -967,6 +1441,15 @@ Config::default_set()
     format.split_biflow = false;
     format.detailed_info = false;
     format.template_info = false;
+    format.sampled_only = false;
+    format.enrichment = false;
+    format.batch_recs = BATCH_RECS_DEF;
+    format.batch_timeout = 0;
+    format.threads = 1;
+    format.key = part_key::NONE;
+    format.fields_sel = field_sel::ALL;
+    format.encoding = rec_encoding::JSON;
+    format.fields.clear();
 
     outputs.prints.clear();
     outputs.files.clear();
@@ -974,6 +1457,7 @@ Config::default_set()
     outputs.sends.clear();
     outputs.kafkas.clear();
     outputs.syslogs.clear();
+    outputs.elastics.clear();
 }
 
 /**
@@ -990,6 +1474,7 @@ Config::check_validity()
     output_cnt += outputs.files.size();
     output_cnt += outputs.kafkas.size();
     output_cnt += outputs.syslogs.size();
+    output_cnt += outputs.elastics.size();
     if (output_cnt == 0) {
         throw std::invalid_argument("At least one output must be defined!");
     }
@@ -1021,9 +1506,32 @@ Config::check_validity()
     for (const auto &kafka : outputs.kafkas) {
         check_and_add(kafka.name);
     }
+
+    // Keys of records are calculated only once, so all outputs must use the same type
+    for (const auto &kafka : outputs.kafkas) {
+        if (kafka.key == part_key::NONE) {
+            continue;
+        }
+        if (format.key != part_key::NONE && format.key != kafka.key) {
+            throw std::invalid_argument("All <kafka> outputs must use the same type of "
+                "partition key!");
+        }
+        if (kafka.partition != RD_KAFKA_PARTITION_UA) {
+            throw std::invalid_argument("Partition key and fixed partition of a <kafka> output "
+                "cannot be combined!");
+        }
+        if (kafka.pack_size != 0) {
+            throw std::invalid_argument("Partition key and packing of records of a <kafka> "
+                "output cannot be combined!");
+        }
+        format.key = kafka.key;
+    }
     for (const auto &syslog : outputs.syslogs) {
         check_and_add(syslog.name);
     }
+    for (const auto &elastic : outputs.elastics) {
+        check_and_add(elastic.name);
+    }
 }
 
 Config::Config(const char *params)
@@ -1059,34 +1567,3 @@ Config::~Config()
 {
     // Nothing to do
 }
-
-int
-parse_version(const std::string &str, int version[4])
-{
-    static const int FIELDS_MIN = 2;
-    static const int FIELDS_MAX = 4;
-
-    // Parse the required version
-    std::istringstream parser(str);
-    for (int i = 0; i < FIELDS_MAX; ++i) {
-        version[i] = 0;
-    }
-
-    int idx;
-    for (idx = 0; idx < FIELDS_MAX && !parser.eof(); idx++) {
-        if (idx != 0 && parser.get() != '.') {
-            return IPX_ERR_FORMAT;
-        }
-
-        parser >> version[idx];
-        if (parser.fail() || version[idx] < 0) {
-            return IPX_ERR_FORMAT;
-        }
-    }
-
-    if (!parser.eof() || idx < FIELDS_MIN) {
-        return IPX_ERR_FORMAT;
-    }
-
-    return IPX_OK;
-}
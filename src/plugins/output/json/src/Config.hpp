@@ -48,40 +48,9 @@
 #include <vector>
 #include <ipfixcol2.h>
 
+#include "Options.hpp"
 #include "SyslogSocket.hpp"
 
-/** Configuration of output format                                                               */
-struct cfg_format {
-    /** TCP flags format - true (formatted), false (raw)                                         */
-    bool tcp_flags;
-    /** Timestamp format - true (formatted), false (UNIX)                                        */
-    bool timestamp;
-    /** Protocol format  - true (formatted), false (raw)                                         */
-    bool proto;
-    /** Skip unknown elements                                                                    */
-    bool ignore_unknown;
-    /** Converter octetArray type as unsigned integer (only if field size <= 8)                  */
-    bool octets_as_uint;
-    /** Convert white spaces in string (do not skip)                                             */
-    bool white_spaces;
-    /** Add detailed information about each record                                               */
-    bool detailed_info;
-    /** Ignore Options Template records                                                          */
-    bool ignore_options;
-    /** Use only numeric identifiers of Information Elements                                     */
-    bool numeric_names;
-    /** Split biflow records                                                                     */
-    bool split_biflow;
-    /** Add template records                                                                     */
-    bool template_info;
-};
-
-/** Output configuration base structure                                                          */
-struct cfg_output {
-    /** Plugin identification                                                                    */
-    std::string name;
-};
-
 /** Configuration of printer to standard output                                                  */
 struct cfg_print : cfg_output {
     // Nothing more
@@ -102,17 +71,36 @@ struct cfg_send : cfg_output {
     } proto; /**< Communication protocol                                                         */
 };
 
+/** Policy of TCP server for clients that are not able to receive records fast enough            */
+enum class slow_policy {
+    DROP,      ///< Drop new records of the client
+    DISCONNECT ///< Disconnect the client
+};
+
 /** Configuration of TCP server                                                                  */
 struct cfg_server : cfg_output {
     /** Destination port                                                                         */
     uint16_t port;
     /** Blocking communication                                                                   */
     bool blocking;
+    /** Policy for slow clients (only if blocking is disabled)                                   */
+    slow_policy slow;
+    /** Maximum size of records waiting to be sent to a client (in bytes)                        */
+    uint64_t client_buffer;
 };
 
 enum class calg {
     NONE, ///< Do not use compression
-    GZIP  ///< GZIP compression
+    GZIP, ///< GZIP compression
+    ZSTD, ///< Zstandard compression
+    LZ4   ///< LZ4 compression
+};
+
+/** Synchronization policy of written files                                                      */
+enum class sync_policy {
+    NONE,  ///< Leave synchronization to the operating system
+    CLOSE, ///< Synchronize a file before it's closed
+    BUFFER ///< Synchronize a file after each written buffer
 };
 
 /** Configuration of file writer                                                                 */
@@ -127,25 +115,14 @@ struct cfg_file : cfg_output {
     bool window_align;
     /** Compression algorithm                                                                    */
     calg m_calg;
-};
-
-/** Configuration of kafka output                                                                */
-struct cfg_kafka : cfg_output {
-    /// Comma separated list of IP[:Port]
-    std::string brokers;
-    /// Produced topic
-    std::string topic;
-    /// Partition to which data should be send
-    int32_t partition;
-    /// Broker version fallback (empty or X.X.X.X)
-    std::string broker_fallback;
-    /// Block conversion if sender buffer is full
-    bool blocking;
-    /// Add default properties for librdkafka
-    bool perf_tuning;
-
-    /// Additional librdkafka properties (might overwrite common parameters)
-    std::map<std::string, std::string> properties;
+    /** Compression level (-1 == default level of the algorithm)                                 */
+    int level;
+    /** Number of compression threads (0 == compress by the output thread)                       */
+    uint32_t threads;
+    /** Bypass the page cache (O_DIRECT)                                                         */
+    bool direct_io;
+    /** Synchronization policy                                                                   */
+    sync_policy sync;
 };
 
 /** Configuration of syslog hostname                                                             */
@@ -170,10 +147,40 @@ struct cfg_syslog : cfg_output {
     std::string program;
     /// Whether or not report process ID
     bool proc_id;
+    /// Maximum number of messages sent together
+    uint32_t batch_size;
+    /// Maximum time for which messages can wait to be sent (milliseconds, 0 = end of each message)
+    uint32_t flush_interval;
     /// Transport configuration
     std::unique_ptr<SyslogSocket> transport;
 };
 
+/** Configuration of Elasticsearch/OpenSearch output                                            */
+struct cfg_elastic : cfg_output {
+    /** Hostname or IPv4/IPv6 address of a node                                                  */
+    std::string host;
+    /** Port of the HTTP interface of the node                                                   */
+    uint16_t port;
+    /** Target index or data stream                                                              */
+    std::string index;
+    /** User name (HTTP Basic authentication, empty == disabled)                                 */
+    std::string user;
+    /** Password (HTTP Basic authentication)                                                     */
+    std::string password;
+    /** Compress bodies of requests by GZIP                                                      */
+    bool gzip;
+    /** Maximum number of concurrent requests (i.e. connections)                                 */
+    uint32_t connections;
+    /** Maximum size of a body of a request before compression (bytes)                           */
+    uint32_t bulk_size;
+    /** Maximum time for which records can wait to be sent (milliseconds)                        */
+    uint32_t flush_interval;
+    /** Maximum number of retries of rejected documents                                          */
+    uint32_t retries;
+    /** Block conversion if all connections are busy                                             */
+    bool blocking;
+};
+
 /** Parsed configuration of an instance                                                          */
 class Config {
 private:
@@ -194,7 +201,9 @@ private:
     void parse_syslog_transport(struct cfg_syslog &syslog, fds_xml_ctx_t *transport);
     std::unique_ptr<TcpSyslogSocket> parse_syslog_tcp(fds_xml_ctx_t *socket);
     std::unique_ptr<UdpSyslogSocket> parse_syslog_udp(fds_xml_ctx_t *socket);
+    void parse_elastic(fds_xml_ctx_t *elastic);
     void parse_outputs(fds_xml_ctx_t *outputs);
+    void parse_fields(fds_xml_ctx_t *fields, field_sel sel);
     void parse_params(fds_xml_ctx_t *params);
 
 public:
@@ -214,6 +223,8 @@ public:
         std::vector<struct cfg_kafka> kafkas;
         /** Syslogs                                                                              */
         std::vector<struct cfg_syslog> syslogs;
+        /** Elasticsearch/OpenSearch outputs                                                     */
+        std::vector<struct cfg_elastic> elastics;
     } outputs; /**< Outputs                                                                      */
 
     /**
@@ -228,16 +239,4 @@ public:
     ~Config();
 };
 
-/**
- * \brief Parse application version (i.e. A.B.C.D)
- *
- * \note At least major and minor version must be specified. Undefined sub-versions are set to zero.
- * \param[in]  str     Version string
- * \param[out] version Parsed version
- * \return #IPX_OK on success
- * \return #IPX_ERR_FORMAT if the version string is malformed
- */
-int
-parse_version(const std::string &str, int version[4]);
-
 #endif // JSON_CONFIG_H
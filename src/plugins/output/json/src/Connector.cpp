@@ -0,0 +1,259 @@
+/**
+ * \file src/plugins/output/json/src/Connector.cpp
+ * \author agent <agent@local>
+ * \brief Background connector of network outputs (source file)
+ * \date 2026
+ */
+
+/* Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is'', and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#include "Connector.hpp"
+
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#include <chrono>
+#include <stdexcept>
+#include <system_error>
+
+#include <sys/types.h>
+#include <sys/socket.h>
+
+Connector::Connector(const std::string &host, uint16_t port, int sock_type, unsigned int delay,
+        ipx_ctx_t *ctx, const std::string &prefix)
+    : m_host(host), m_port(port), m_sock_type(sock_type), m_delay(delay), m_ctx(ctx),
+      m_prefix(prefix)
+{
+    m_desc = host + ":" + std::to_string(port);
+
+    if (pipe2(m_pipe, O_CLOEXEC | O_NONBLOCK) != 0) {
+        throw std::runtime_error("pipe2() failed");
+    }
+
+    try {
+        m_thread = std::thread(&Connector::thread_main, this);
+    } catch (const std::system_error &ex) {
+        close(m_pipe[0]);
+        close(m_pipe[1]);
+        throw std::runtime_error("Failed to start a connector thread: " + std::string(ex.what()));
+    }
+}
+
+Connector::~Connector()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+
+    // Wake up the thread (even if it is waiting for a reply of the remote side)
+    const char stop = 's';
+    if (write(m_pipe[1], &stop, 1) != 1) {
+        IPX_CTX_ERROR(m_ctx, "%s Failed to interrupt the connector thread!", m_prefix.c_str());
+    }
+    m_cv.notify_all();
+    m_thread.join();
+
+    if (m_fd >= 0) {
+        close(m_fd);
+    }
+    close(m_pipe[0]);
+    close(m_pipe[1]);
+}
+
+int
+Connector::get()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    if (m_fd >= 0) {
+        const int fd = m_fd;
+        m_fd = -1;
+        return fd;
+    }
+
+    if (!m_requested) {
+        m_requested = true;
+        m_cv.notify_all();
+    }
+
+    return -1;
+}
+
+/**
+ * \brief Main function of the thread
+ *
+ * The thread waits for a request, tries to connect and, if the attempt fails, repeats it after
+ * the reconnection delay until the socket is created.
+ */
+void
+Connector::thread_main()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+
+    while (true) {
+        m_cv.wait(lock, [this]() {return m_stop || m_requested;});
+        if (m_stop) {
+            return;
+        }
+
+        lock.unlock();
+        const int ret = connect();
+        lock.lock();
+
+        if (m_stop) {
+            if (ret >= 0) {
+                close(ret);
+            }
+            return;
+        }
+
+        if (ret >= 0) {
+            IPX_CTX_INFO(m_ctx, "%s Connected to '%s'.", m_prefix.c_str(), m_desc.c_str());
+            m_fd = ret;
+            m_requested = false;
+            continue;
+        }
+
+        const char *err_str;
+        ipx_strerror(-ret, err_str);
+        IPX_CTX_WARNING(m_ctx, "%s Unable to connect to '%s': %s. Trying again in %u seconds.",
+            m_prefix.c_str(), m_desc.c_str(), err_str, m_delay);
+        m_cv.wait_for(lock, std::chrono::seconds(m_delay), [this]() {return m_stop;});
+    }
+}
+
+/**
+ * \brief Try to connect to all addresses of the destination
+ * \return Connected socket (in blocking mode)
+ * \return Negative errno-like code on failure
+ */
+int
+Connector::connect()
+{
+    const std::string port_str = std::to_string(m_port);
+    struct addrinfo hints;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = m_sock_type;
+    hints.ai_protocol = 0;
+    hints.ai_flags = AI_NUMERICSERV;
+
+    struct addrinfo *result;
+    if (getaddrinfo(m_host.c_str(), port_str.c_str(), &hints, &result) != 0) {
+        return -EHOSTUNREACH;
+    }
+
+    int ret = -EHOSTUNREACH;
+    for (struct addrinfo *ptr = result; ptr != nullptr; ptr = ptr->ai_next) {
+        ret = connect_addr(ptr);
+        if (ret >= 0 || ret == -ECANCELED) {
+            break;
+        }
+    }
+
+    freeaddrinfo(result);
+    return ret;
+}
+
+/**
+ * \brief Try to connect to a single address
+ *
+ * The socket is connected in non-blocking mode, so the attempt can be interrupted by the pipe
+ * of the connector. On success, the socket is switched to blocking mode.
+ * \param[in] addr Address of the destination
+ * \return Connected socket
+ * \return -ECANCELED if the attempt has been interrupted
+ * \return Other negative errno-like code on failure
+ */
+int
+Connector::connect_addr(const struct addrinfo *addr)
+{
+    const int fd = socket(addr->ai_family, addr->ai_socktype | SOCK_NONBLOCK | SOCK_CLOEXEC,
+        addr->ai_protocol);
+    if (fd < 0) {
+        return -errno;
+    }
+
+    int ret = 1; // 1 == connected, 0 == in progress, negative == failed
+    if (::connect(fd, addr->ai_addr, addr->ai_addrlen) != 0) {
+        ret = (errno == EINPROGRESS) ? 0 : -errno;
+    }
+
+    while (ret == 0) {
+        struct pollfd fds[2];
+        fds[0].fd = fd;
+        fds[0].events = POLLOUT;
+        fds[1].fd = m_pipe[0];
+        fds[1].events = POLLIN;
+
+        const int events = poll(fds, 2, CONNECT_TIMEOUT);
+        if (events < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            ret = -errno;
+        } else if (events == 0) {
+            ret = -ETIMEDOUT;
+        } else if (fds[1].revents != 0) {
+            ret = -ECANCELED;
+        } else {
+            int error = 0;
+            socklen_t error_len = sizeof(error);
+            if (getsockopt(fd, SOL_SOCKET, SO_ERROR, &error, &error_len) != 0) {
+                error = errno;
+            }
+            ret = (error != 0) ? -error : 1;
+        }
+    }
+
+    if (ret < 0) {
+        close(fd);
+        return ret;
+    }
+
+    // Return to blocking mode (non-blocking sends are requested by the MSG_DONTWAIT flag)
+    const int flags = fcntl(fd, F_GETFL);
+    if (flags < 0 || fcntl(fd, F_SETFL, flags & ~O_NONBLOCK) != 0) {
+        ret = -errno;
+        close(fd);
+        return ret;
+    }
+
+    return fd;
+}
@@ -0,0 +1,143 @@
+/**
+ * \file src/plugins/output/json/src/Connector.hpp
+ * \author agent <agent@local>
+ * \brief Background connector of network outputs (header file)
+ * \date 2026
+ */
+
+/* Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is'', and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#ifndef JSON_CONNECTOR_H
+#define JSON_CONNECTOR_H
+
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <netdb.h>
+
+#include <ipfixcol2.h>
+
+/**
+ * \brief Connector of a remote destination running in a background thread
+ *
+ * Name resolution and connection attempts (including waiting for a reply of the remote side)
+ * are performed by the thread of the connector, so the caller never waits for them. The caller
+ * regularly asks for a connected socket by get(). If there is no socket yet, a connection
+ * attempt is started (unless one is already in progress) and the caller continues without it.
+ * Failed attempts are repeated after a reconnection delay until a socket is retrieved.
+ *
+ * Retrieved sockets are in blocking mode and the caller is responsible for closing them.
+ */
+class Connector {
+public:
+    /**
+     * \brief Constructor (the first connection attempt is started immediately)
+     * \param[in] host      Hostname or IP address of the destination
+     * \param[in] port      Port of the destination
+     * \param[in] sock_type Type of the socket (SOCK_STREAM or SOCK_DGRAM)
+     * \param[in] delay     Delay between connection attempts (seconds)
+     * \param[in] ctx       Instance context (only for log!)
+     * \param[in] prefix    Prefix of log messages (e.g. "(Send output)")
+     * \throw runtime_error if the thread cannot be started
+     */
+    Connector(const std::string &host, uint16_t port, int sock_type, unsigned int delay,
+        ipx_ctx_t *ctx, const std::string &prefix);
+    /** \brief Destructor (a connection attempt in progress is interrupted)                     */
+    ~Connector();
+
+    // Disable copy constructors
+    Connector(const Connector &other) = delete;
+    Connector &operator=(const Connector &other) = delete;
+
+    /**
+     * \brief Get a connected socket (never blocks)
+     *
+     * If no socket is available, a new connection attempt is started in the background
+     * (unless one is already in progress).
+     * \return File descriptor of the socket (the caller becomes its owner)
+     * \return -1 if the socket is not available yet
+     */
+    int
+    get();
+
+    /** \brief Get a description of the destination (e.g. "127.0.0.1:4739")                      */
+    const std::string &
+    description() const {return m_desc;};
+
+private:
+    /** Timeout of a single connection attempt (milliseconds)                                    */
+    static const int CONNECT_TIMEOUT = 10000;
+
+    /** Hostname or IP address of the destination                                                */
+    std::string m_host;
+    /** Port of the destination                                                                  */
+    uint16_t m_port;
+    /** Type of the socket                                                                       */
+    int m_sock_type;
+    /** Delay between connection attempts (seconds)                                              */
+    unsigned int m_delay;
+    /** Instance context (only for log!)                                                         */
+    ipx_ctx_t *m_ctx;
+    /** Prefix of log messages                                                                   */
+    std::string m_prefix;
+    /** Description of the destination                                                           */
+    std::string m_desc;
+
+    /** Synchronization of the thread                                                            */
+    std::mutex m_mutex;
+    /** Notification about requests and the stop flag                                            */
+    std::condition_variable m_cv;
+    /** A connection attempt has been requested (protected by the mutex)                         */
+    bool m_requested = true;
+    /** Connected socket waiting to be retrieved (protected by the mutex)                        */
+    int m_fd = -1;
+    /** Stop flag of the thread (protected by the mutex)                                         */
+    bool m_stop = false;
+    /** Pipe that interrupts a connection attempt in progress (read and write end)               */
+    int m_pipe[2] = {-1, -1};
+    /** Thread of the connector                                                                  */
+    std::thread m_thread;
+
+    // Main function of the thread
+    void thread_main();
+    // Try to connect to the destination (returns a socket or a negative errno-like code)
+    int connect();
+    // Try to connect to a single address
+    int connect_addr(const struct addrinfo *addr);
+};
+
+#endif // JSON_CONNECTOR_H
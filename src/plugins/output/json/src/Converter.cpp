@@ -0,0 +1,357 @@
+/**
+ * \file src/plugins/output/json/src/Converter.cpp
+ * \author agent <agent@local>
+ * \brief Converter of IPFIX records to JSON strings (source file)
+ * \date 2026
+ */
+
+/* Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is'', and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#include <cassert>
+#include <cstring>
+#include <new>
+#include <stdexcept>
+#include <arpa/inet.h>
+#include <libfds.h>
+
+#include "Converter.hpp"
+#include "Format.hpp"
+
+/** Base size of the conversion buffer                 */
+#define BUFFER_BASE   4096
+
+Converter::Converter(const struct cfg_format &fmt, Registry *registry)
+    : m_format(fmt)
+{
+    // Prepare the buffer
+    m_record.buffer = nullptr;
+    m_record.size_used = 0;
+    m_record.size_alloc = 0;
+
+    // Prepare conversion flags
+    m_flags = FDS_CD2J_ALLOW_REALLOC; // Allow automatic reallocation of the buffer
+    if (m_format.tcp_flags) {
+        m_flags |= FDS_CD2J_FORMAT_TCPFLAGS;
+    }
+    if (m_format.timestamp) {
+        m_flags |= FDS_CD2J_TS_FORMAT_MSEC;
+    }
+    if (m_format.proto) {
+        m_flags |= FDS_CD2J_FORMAT_PROTO;
+    }
+    if (m_format.ignore_unknown) {
+        m_flags |= FDS_CD2J_IGNORE_UNKNOWN;
+    }
+    if (!m_format.white_spaces) {
+        m_flags |= FDS_CD2J_NON_PRINTABLE;
+    }
+    if (m_format.numeric_names) {
+        m_flags |= FDS_CD2J_NUMERIC_ID;
+    }
+    if (m_format.split_biflow) {
+        m_flags |= FDS_CD2J_REVERSE_SKIP;
+    }
+    if (!m_format.octets_as_uint) {
+        m_flags |= FDS_CD2J_OCTETS_NOINT;
+    }
+
+    m_serializer.reset(new Serializer(m_flags));
+    m_serializer->fields_select(m_format.fields_sel, m_format.fields);
+
+    if (m_format.encoding == rec_encoding::AVRO) {
+        if (!registry) {
+            throw std::invalid_argument("Avro encoding requires a schema registry!");
+        }
+        m_avro.reset(new Avro(m_format, *registry));
+    }
+}
+
+Converter::~Converter()
+{
+    free(m_record.buffer);
+}
+
+void
+Converter::msg_begin(const fds_iemgr_t *iemgr, const char *src_addr)
+{
+    m_serializer->msg_begin(iemgr);
+    if (m_avro) {
+        m_avro->msg_begin(iemgr);
+    }
+    m_iemgr = iemgr;
+    m_src_addr = src_addr;
+}
+
+/**
+ * \brief Reserve memory of the conversion buffer
+ *
+ * Requests that the string capacity be adapted to a planned change in size to a length of up
+ * to n characters.
+ * \param[in] n Minimal size of the buffer
+ * \throws bad_alloc in case of a memory allocation error
+ */
+void
+Converter::buffer_reserve(size_t n)
+{
+    if (n <= buffer_alloc()) {
+        // Nothing to do
+        return;
+    }
+
+    // Prepare a new buffer and copy the content
+    const size_t new_size = ((n / BUFFER_BASE) + 1) * BUFFER_BASE;
+    char *new_buffer = (char *) realloc(m_record.buffer, new_size * sizeof(char));
+    if (!new_buffer) {
+        throw std::bad_alloc();
+    }
+
+    m_record.buffer = new_buffer;
+    m_record.size_alloc = new_size;
+}
+
+/**
+ * \brief Append the conversion buffer
+ * \note
+ *   If the buffer length is not sufficient enough, it is automatically reallocated to fit
+ *   the string.
+ * \param[in] str String to add
+ * \throws bad_alloc in case of a memory allocation error
+ */
+void
+Converter::buffer_append(const char *str)
+{
+    const size_t len = std::strlen(str) + 1; // "\0"
+    buffer_reserve(buffer_used() + len);
+    memcpy(m_record.buffer + buffer_used(), str, len);
+    m_record.size_used += len - 1;
+}
+
+/**
+ * \brief Append the conversion buffer with a key and an unsigned integer value
+ * \note
+ *   If the buffer length is not sufficient enough, it is automatically reallocated to fit
+ *   the string.
+ * \param[in] key   Key including separators (e.g. ",\"ipfix:odid\":")
+ * \param[in] value Value to add
+ * \throws bad_alloc in case of a memory allocation error
+ */
+void
+Converter::buffer_append_uint(const char *key, uint64_t value)
+{
+    const size_t len = std::strlen(key);
+    buffer_reserve(buffer_used() + len + FMT_LEN_UINT + 1); // "\0"
+    char *pos = m_record.buffer + buffer_used();
+    memcpy(pos, key, len);
+    pos = fmt_uint(pos + len, value);
+    *pos = '\0';
+    m_record.size_used = static_cast<size_t>(pos - m_record.buffer);
+}
+
+void
+Converter::convert_tmplt_rec(struct fds_tset_iter *tset_iter, uint16_t set_id,
+    const struct fds_ipfix_msg_hdr *hdr)
+{
+    // Buffer is empty
+    m_record.size_used = 0;
+
+    enum fds_template_type type;
+    void *ptr;
+    if (set_id == FDS_IPFIX_SET_TMPLT) {
+        buffer_append("{\"@type\":\"ipfix.template\",");
+        type = FDS_TYPE_TEMPLATE;
+        ptr = tset_iter->ptr.trec;
+    } else {
+        assert(set_id == FDS_IPFIX_SET_OPTS_TMPLT);
+        buffer_append("{\"@type\":\"ipfix.optionsTemplate\",");
+        type = FDS_TYPE_TEMPLATE_OPTS;
+        ptr = tset_iter->ptr.opts_trec;
+    }
+
+    // Filling the template structure with data from raw packet
+    uint16_t tmplt_size = tset_iter->size;
+    struct fds_template *tmplt;
+    int rc;
+    rc = fds_template_parse(type, ptr, &tmplt_size, &tmplt);
+    if (rc != FDS_OK) {
+        throw std::runtime_error("Parsing failed due to memory allocation error or the format of template is invalid!");
+    }
+
+    // Printing out the header
+    buffer_append_uint("\"ipfix:templateId\":", tmplt->id);
+    if (set_id == FDS_IPFIX_SET_OPTS_TMPLT) {
+        buffer_append_uint(",\"ipfix:scopeCount\":", tmplt->fields_cnt_scope);
+    }
+
+    // Add detailed info to record
+    if (m_format.detailed_info) {
+        addDetailedInfo(hdr);
+    }
+
+    buffer_append(",\"ipfix:fields\":[");
+
+    // Iteration through the fields and converting them to JSON string
+    for (uint16_t i = 0; i < tmplt->fields_cnt_total; i++) {
+        struct fds_tfield current = tmplt->fields[i];
+        if (i != 0) { // Not first field
+            buffer_append(",");
+        }
+        buffer_append_uint("{\"ipfix:elementId\":", current.id);
+        buffer_append_uint(",\"ipfix:enterpriseId\":", current.en);
+        buffer_append_uint(",\"ipfix:fieldLength\":", current.length);
+        buffer_append("}");
+    }
+    buffer_append("]}\n");
+
+    // Free allocated memory
+    fds_template_destroy(tmplt);
+}
+
+/**
+ * \brief Add fields with detailed info (export time, sequence number, ODID, message length) to record
+ *
+ * For each record, add detailed information if detailedInfo is enabled.
+ * @param[in] hdr   Message header of IPFIX record
+ */
+void
+Converter::addDetailedInfo(const struct fds_ipfix_msg_hdr *hdr)
+{
+    buffer_append_uint(",\"ipfix:exportTime\":", ntohl(hdr->export_time));
+    buffer_append_uint(",\"ipfix:seqNumber\":", ntohl(hdr->seq_num));
+    buffer_append_uint(",\"ipfix:odid\":", ntohl(hdr->odid));
+    buffer_append_uint(",\"ipfix:msgLength\":", ntohs(hdr->length));
+
+    if (m_src_addr) {
+        buffer_append(",\"ipfix:srcAddr\":\"");
+        buffer_append(m_src_addr);
+        buffer_append("\"");
+    }
+}
+
+/**
+ * \brief Add known values of IP prefixes to JSON string
+ * \param[in] values  Values of IP prefixes of the record
+ * \param[in] reverse Source and destination are swapped (reverse point of view)
+ * \throws bad_alloc in case of a memory allocation error
+ */
+void
+Converter::addEnrichment(const struct enrich_values *values, bool reverse)
+{
+    const uint32_t src_asn = reverse ? values->dst_asn : values->src_asn;
+    const uint32_t dst_asn = reverse ? values->src_asn : values->dst_asn;
+    const uint32_t src_tag = reverse ? values->dst_tag : values->src_tag;
+    const uint32_t dst_tag = reverse ? values->src_tag : values->dst_tag;
+    const char *src_country = reverse ? values->dst_country : values->src_country;
+    const char *dst_country = reverse ? values->src_country : values->dst_country;
+
+    if (src_asn != 0) {
+        buffer_append_uint(",\"enrich:srcAsn\":", src_asn);
+    }
+    if (dst_asn != 0) {
+        buffer_append_uint(",\"enrich:dstAsn\":", dst_asn);
+    }
+    if (src_country[0] != '\0') {
+        const char str[] = {src_country[0], src_country[1], '\0'};
+        buffer_append(",\"enrich:srcCountry\":\"");
+        buffer_append(str);
+        buffer_append("\"");
+    }
+    if (dst_country[0] != '\0') {
+        const char str[] = {dst_country[0], dst_country[1], '\0'};
+        buffer_append(",\"enrich:dstCountry\":\"");
+        buffer_append(str);
+        buffer_append("\"");
+    }
+    if (src_tag != 0) {
+        buffer_append_uint(",\"enrich:srcTag\":", src_tag);
+    }
+    if (dst_tag != 0) {
+        buffer_append_uint(",\"enrich:dstTag\":", dst_tag);
+    }
+}
+
+void
+Converter::convert(struct fds_drec &rec, const struct fds_ipfix_msg_hdr *hdr, bool reverse,
+    const struct enrich_values *enrich)
+{
+    if (m_avro) {
+        // Binary record (detailed information and values of IP prefixes are not available)
+        m_record.size_used = m_avro->convert(rec, reverse, &m_record.buffer,
+            &m_record.size_alloc);
+        buffer_append("\n");
+        return;
+    }
+
+    int rc = Serializer::NO_PLAN;
+    if (!reverse) {
+        // Try the plan of the Template first
+        rc = m_serializer->convert(rec, &m_record.buffer, &m_record.size_alloc);
+    }
+
+    if (rc == Serializer::NO_PLAN) {
+        // Convert the record
+        uint32_t flags = m_flags;
+        flags |= reverse ? FDS_CD2J_BIFLOW_REVERSE : 0;
+        rc = m_serializer->convert_generic(rec, flags, &m_record.buffer, &m_record.size_alloc);
+    }
+
+    if (rc < 0) {
+        throw std::runtime_error("Conversion to JSON failed (probably a memory allocation error)!");
+    }
+
+    m_record.size_used = size_t(rc);
+
+    if (m_format.detailed_info || enrich != nullptr) {
+        // Remove '}' parenthesis at the end of the record
+        m_record.size_used--;
+
+        if (m_format.detailed_info) {
+            // Add detailed info to JSON string
+            addDetailedInfo(hdr);
+
+            // Add template ID to JSON string
+            buffer_append_uint(",\"ipfix:templateId\":", rec.tmplt->id);
+        }
+
+        if (enrich != nullptr) {
+            addEnrichment(enrich, reverse);
+        }
+
+        // Append the record with '}' parenthesis removed before
+        buffer_append("}");
+    }
+
+    // Append the record with end of line character
+    buffer_append("\n");
+}
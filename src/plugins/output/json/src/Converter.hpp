@@ -0,0 +1,167 @@
+/**
+ * \file src/plugins/output/json/src/Converter.hpp
+ * \author agent <agent@local>
+ * \brief Converter of IPFIX records to JSON strings (header file)
+ * \date 2026
+ */
+
+/* Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is'', and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+#ifndef JSON_CONVERTER_H
+#define JSON_CONVERTER_H
+
+#include <memory>
+#include <ipfixcol2.h>
+#include "Options.hpp"
+#include "Serializer.hpp"
+#include "Avro.hpp"
+
+/**
+ * \brief Values of IP prefixes attached to a record by the enrichment plugin
+ *
+ * The layout must match the extension ``enrichment-v1``/``prefix`` of the plugin, i.e. values
+ * are in host byte order and zeros mean unknown values.
+ */
+struct enrich_values {
+    uint32_t src_asn;        /**< ASN of the source address                                  */
+    uint32_t dst_asn;        /**< ASN of the destination address                             */
+    uint32_t src_tag;        /**< Tag of the source address                                  */
+    uint32_t dst_tag;        /**< Tag of the destination address                             */
+    char src_country[2];     /**< Country code of the source address                         */
+    char dst_country[2];     /**< Country code of the destination address                    */
+};
+
+/**
+ * \brief Converter of IPFIX records to JSON strings
+ *
+ * The converter holds its own conversion buffer and Template-compiled serializer, therefore,
+ * multiple converters can convert records of the same message in parallel. If Avro encoding
+ * is configured, Data records are encoded by the Template-compiled Avro encoder instead.
+ */
+class Converter {
+private:
+    /** Formatting options                                                                       */
+    struct cfg_format m_format;
+    /** Conversion flags for libfds converter                                                    */
+    uint32_t m_flags;
+    /** Template-compiled converter (libfds converter is used if not applicable)                 */
+    std::unique_ptr<Serializer> m_serializer;
+    /** Template-compiled Avro encoder (only if Avro encoding is configured)                     */
+    std::unique_ptr<Avro> m_avro;
+    /** Information Element manager of the current message (can be nullptr)                      */
+    const fds_iemgr_t *m_iemgr = nullptr;
+    /** IPv4/IPv6 exporter address of the current message (can be nullptr)                       */
+    const char *m_src_addr = nullptr;
+
+    struct {
+        char *buffer;
+        size_t size_alloc;
+        size_t size_used;
+    } m_record; /**< Converted JSON record                                                       */
+
+    // Total size of allocated buffer
+    size_t buffer_alloc() const {return m_record.size_alloc;};
+    // Used buffer size
+    size_t buffer_used() const {return m_record.size_used;};
+    // Append append a string
+    void buffer_append(const char *str);
+    // Append a key and an unsigned integer value
+    void buffer_append_uint(const char *key, uint64_t value);
+    // Reserve memory for a JSON string
+    void buffer_reserve(size_t n);
+    // Add detailed info (templateId, ODID, seqNum, exportTime) to JSON string
+    void addDetailedInfo(const struct fds_ipfix_msg_hdr *hdr);
+    // Add known values of IP prefixes to JSON string
+    void addEnrichment(const struct enrich_values *values, bool reverse);
+public:
+    /**
+     * \brief Constructor
+     * \param[in] fmt      Conversion specifier
+     * \param[in] registry Schema registry (required only by Avro encoding)
+     * \throw invalid_argument if the schema registry is required but missing
+     */
+    explicit Converter(const struct cfg_format &fmt, Registry *registry = nullptr);
+    /** Destructor */
+    ~Converter();
+
+    // Disable copy constructors
+    Converter(const Converter &other) = delete;
+    Converter &operator=(const Converter &other) = delete;
+
+    /**
+     * \brief Get the size of the conversion buffer (for memory accounting)
+     */
+    size_t
+    mem_size() const {return m_record.size_alloc;};
+
+    /**
+     * \brief Prepare the converter for records of a new IPFIX Message
+     * \param[in] iemgr    Information Element manager (can be NULL)
+     * \param[in] src_addr IPv4/IPv6 address of the exporter (can be NULL)
+     */
+    void
+    msg_begin(const fds_iemgr_t *iemgr, const char *src_addr);
+
+    /**
+     * \brief Convert an IPFIX Data record to a JSON string (or an Avro encoded record)
+     * \param[in] rec     IPFIX record to convert
+     * \param[in] hdr     Message header of the IPFIX record
+     * \param[in] reverse Convert from reverse point of view (affects only biflow records)
+     * \param[in] enrich  Values of IP prefixes of the record (can be nullptr)
+     * \throw runtime_error if the JSON converter fails or an Avro schema cannot be registered
+     */
+    void
+    convert(struct fds_drec &rec, const struct fds_ipfix_msg_hdr *hdr, bool reverse = false,
+        const struct enrich_values *enrich = nullptr);
+
+    /**
+     * \brief Convert an (Options) Template record to a JSON string
+     * \param[in] tset_iter (Options) Template Set iterator pointing to the record to convert
+     * \param[in] set_id    Id of the Template Set
+     * \param[in] hdr       Message header of the IPFIX record
+     * \throw runtime_error if the template parser fails
+     */
+    void
+    convert_tmplt_rec(struct fds_tset_iter *tset_iter, uint16_t set_id,
+        const struct fds_ipfix_msg_hdr *hdr);
+
+    /** \brief Get the last converted record (ends with a new-line character)                    */
+    const char *
+    data() const {return m_record.buffer;};
+    /** \brief Get the length of the last converted record                                       */
+    size_t
+    size() const {return m_record.size_used;};
+};
+
+#endif // JSON_CONVERTER_H
@@ -0,0 +1,968 @@
+/**
+ * \file src/plugins/output/json/src/Elastic.cpp
+ * \author agent <agent@local>
+ * \brief Elasticsearch/OpenSearch bulk output (source file)
+ * \date 2026
+ */
+
+/* Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is'', and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#include "Elastic.hpp"
+
+#include <inttypes.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <netdb.h>
+
+/** Value of invalid file (socket) descriptor                             */
+#define INVALID_FD (-1)
+/** Delay between reconnection attempts (seconds)                         */
+#define RECONN_DELAY (5)
+/** Delay between stats reports (seconds)                                 */
+#define STATS_DELAY (1)
+/** Delay before the first retry of rejected documents (milliseconds)     */
+#define RETRY_DELAY (500)
+/** Upper limit of the delay before a retry (milliseconds)                */
+#define RETRY_DELAY_MAX (30000)
+/** Timeout of waiting for a free connection (milliseconds)               */
+#define WAIT_TIMEOUT (100)
+/** Maximum time to send remaining documents during shutdown (seconds)    */
+#define CLOSE_TIMEOUT (5)
+/** Maximum length of a reported reason of a rejected document            */
+#define REASON_MAX (256)
+
+/** Action line of each document (IDs are generated by the cluster)       */
+static const char ACTION_LINE[] = "{\"create\":{}}\n";
+/** Only these parts of responses are required (i.e. much smaller responses) */
+static const char FILTER_PATH[] = "filter_path=errors,items.*.status,items.*.error.reason";
+
+/**
+ * \brief Get the difference between two timestamps in milliseconds
+ * \param[in] from Older timestamp
+ * \param[in] to   Newer timestamp
+ */
+static int64_t
+time_diff(const struct timespec &from, const struct timespec &to)
+{
+    return (to.tv_sec - from.tv_sec) * INT64_C(1000) + (to.tv_nsec - from.tv_nsec) / 1000000;
+}
+
+/**
+ * \brief Encode a string by Base64 (for HTTP Basic authentication)
+ * \param[in] in String to encode
+ * \return Encoded string
+ */
+static std::string
+base64_encode(const std::string &in)
+{
+    static const char table[] =
+        "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    std::string out;
+    out.reserve(((in.size() + 2) / 3) * 4);
+
+    size_t i = 0;
+    for (; i + 2 < in.size(); i += 3) {
+        const uint32_t val = (uint8_t(in[i]) << 16) | (uint8_t(in[i + 1]) << 8)
+            | uint8_t(in[i + 2]);
+        out.push_back(table[(val >> 18) & 0x3F]);
+        out.push_back(table[(val >> 12) & 0x3F]);
+        out.push_back(table[(val >> 6) & 0x3F]);
+        out.push_back(table[val & 0x3F]);
+    }
+
+    if (i < in.size()) {
+        uint32_t val = uint8_t(in[i]) << 16;
+        if (i + 1 < in.size()) {
+            val |= uint8_t(in[i + 1]) << 8;
+        }
+        out.push_back(table[(val >> 18) & 0x3F]);
+        out.push_back(table[(val >> 12) & 0x3F]);
+        out.push_back((i + 1 < in.size()) ? table[(val >> 6) & 0x3F] : '=');
+        out.push_back('=');
+    }
+
+    return out;
+}
+
+/**
+ * \brief Class constructor
+ * \param[in] cfg Output configuration
+ * \param[in] ctx Instance context
+ * \throw runtime_error if the compression cannot be initialized
+ */
+Elastic::Elastic(const struct cfg_elastic &cfg, ipx_ctx_t *ctx) : Output(cfg.name, ctx), m_cfg(cfg)
+{
+    m_cnt_sent = 0;
+    m_cnt_retried = 0;
+    m_cnt_dropped = 0;
+    m_current_time.tv_sec = 0;
+    m_current_time.tv_nsec = 0;
+    prepare_hdr();
+
+    std::memset(&m_zs, 0, sizeof(m_zs));
+    // Window bits + 16 == GZIP header and trailer
+    if (m_cfg.gzip && deflateInit2(&m_zs, Z_BEST_SPEED, Z_DEFLATED, 15 + 16, 8,
+            Z_DEFAULT_STRATEGY) != Z_OK) {
+        throw std::runtime_error("(Elastic output) Failed to initialize GZIP compression");
+    }
+
+    m_conns.resize(m_cfg.connections);
+    m_pfds.resize(m_cfg.connections);
+    for (auto &conn : m_conns) {
+        conn.sd = INVALID_FD;
+        conn.state = conn_state::CLOSED;
+        conn.out_sent = 0;
+        conn.conn_time.tv_sec = 0;
+        conn.conn_time.tv_nsec = 0;
+    }
+
+    // Try to connect in advance (i.e. report an unreachable node as soon as possible)
+    clock_gettime(CLOCK_MONOTONIC, &m_stats_time);
+    conn_open(m_conns[0], m_stats_time);
+}
+
+/**
+ * \brief Destructor
+ *
+ * Waiting documents are sent and the output waits (for a limited time) for responses.
+ */
+Elastic::~Elastic()
+{
+    if (m_current) {
+        m_queue.push_back(std::move(m_current));
+    }
+
+    struct timespec start, now;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    now = start;
+    while (pending() > 0 && time_diff(start, now) < CLOSE_TIMEOUT * 1000) {
+        progress(WAIT_TIMEOUT);
+        clock_gettime(CLOCK_MONOTONIC, &now);
+    }
+
+    // Unsent documents are lost
+    for (const auto &bulk : m_queue) {
+        m_cnt_dropped += bulk->ends.size();
+    }
+    for (auto &conn : m_conns) {
+        if (conn.bulk) {
+            m_cnt_dropped += conn.bulk->ends.size();
+        }
+        if (conn.sd != INVALID_FD) {
+            close(conn.sd);
+        }
+    }
+
+    m_stats_time.tv_sec = 0;
+    report_stats(now);
+
+    if (m_cfg.gzip) {
+        deflateEnd(&m_zs);
+    }
+}
+
+int
+Elastic::process(const char *str, size_t len)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    report_stats(now);
+
+    append(str, len);
+    progress(0);
+    return IPX_OK;
+}
+
+/**
+ * \brief Add a batch of records to the current bulk
+ * \param[in] batch Batch of JSON records
+ * \return Always #IPX_OK
+ */
+int
+Elastic::process_batch(const struct Batch &batch)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    report_stats(now);
+
+    size_t start = 0;
+    for (size_t i = 0; i < batch.cnt; ++i) {
+        append(batch.data + start, batch.ends[i] - start);
+        start = batch.ends[i];
+    }
+
+    progress(0);
+    return IPX_OK;
+}
+
+/**
+ * \brief Send the current bulk if the oldest document is waiting for too long
+ *
+ * If the flush interval is zero, the bulk is always sent. Received responses are
+ * processed too.
+ */
+void
+Elastic::flush()
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    report_stats(now);
+
+    if (m_current && time_diff(m_current_time, now) >= m_cfg.flush_interval) {
+        submit();
+    }
+
+    progress(0);
+}
+
+/**
+ * \brief Prepare common request headers
+ */
+void
+Elastic::prepare_hdr()
+{
+    // IPv6 addresses must be enclosed in brackets
+    const bool ipv6 = (m_cfg.host.find(':') != std::string::npos);
+    m_desc = ipv6 ? "[" + m_cfg.host + "]" : m_cfg.host;
+    m_desc += ":" + std::to_string(m_cfg.port);
+
+    m_hdr = "POST /" + m_cfg.index + "/_bulk?" + FILTER_PATH + " HTTP/1.1\r\n";
+    m_hdr += "Host: " + m_desc + "\r\n";
+    m_hdr += "Content-Type: application/x-ndjson\r\n";
+    if (!m_cfg.user.empty()) {
+        m_hdr += "Authorization: Basic " + base64_encode(m_cfg.user + ":" + m_cfg.password);
+        m_hdr += "\r\n";
+    }
+}
+
+/**
+ * \brief Get an empty bulk (unused bulks are reused)
+ */
+std::unique_ptr<Elastic::Bulk>
+Elastic::bulk_get()
+{
+    std::unique_ptr<Bulk> bulk;
+    if (!m_unused.empty()) {
+        bulk = std::move(m_unused.back());
+        m_unused.pop_back();
+    } else {
+        bulk.reset(new Bulk);
+        bulk->body.reserve(m_cfg.bulk_size);
+    }
+
+    bulk->body.clear();
+    bulk->ends.clear();
+    bulk->attempt = 0;
+    bulk->not_before.tv_sec = 0;
+    bulk->not_before.tv_nsec = 0;
+    return bulk;
+}
+
+/**
+ * \brief Return a bulk which is not required anymore
+ * \param[in] bulk Bulk
+ */
+void
+Elastic::bulk_put(std::unique_ptr<Bulk> bulk)
+{
+    // Keep only buffers that will be probably used again
+    if (m_unused.size() <= m_conns.size()) {
+        m_unused.push_back(std::move(bulk));
+    }
+}
+
+/**
+ * \brief Add a record to the current bulk
+ *
+ * If the size of the bulk reaches the limit, the bulk is submitted.
+ * \param[in] str JSON record
+ * \param[in] len Length of the record
+ */
+void
+Elastic::append(const char *str, size_t len)
+{
+    if (!m_current) {
+        m_current = bulk_get();
+        clock_gettime(CLOCK_MONOTONIC, &m_current_time);
+    }
+
+    Bulk &bulk = *m_current;
+    bulk.body.append(ACTION_LINE, sizeof(ACTION_LINE) - 1);
+    bulk.body.append(str, len);
+    if (len == 0 || str[len - 1] != '\n') {
+        bulk.body.push_back('\n');
+    }
+    bulk.ends.push_back(bulk.body.size());
+
+    if (bulk.body.size() >= m_cfg.bulk_size) {
+        submit();
+    }
+}
+
+/**
+ * \brief Pass the current bulk to the queue of bulks to send
+ *
+ * If too many bulks are waiting for a free connection, the function waits in the blocking
+ * mode. Otherwise, the oldest waiting bulk is dropped.
+ */
+void
+Elastic::submit()
+{
+    if (!m_current) {
+        return;
+    }
+
+    m_queue.push_back(std::move(m_current));
+    progress(0);
+
+    while (m_queue.size() > m_conns.size()) {
+        if (m_cfg.blocking) {
+            progress(WAIT_TIMEOUT);
+            continue;
+        }
+
+        m_cnt_dropped += m_queue.front()->ends.size();
+        bulk_put(std::move(m_queue.front()));
+        m_queue.pop_front();
+    }
+}
+
+/**
+ * \brief Send documents of a bulk again later
+ *
+ * If the maximum number of retries has been reached, the documents are dropped.
+ * \param[in] bulk Bulk with documents to send again
+ * \param[in] now  Current time
+ */
+void
+Elastic::retry(std::unique_ptr<Bulk> bulk, const struct timespec &now)
+{
+    if (bulk->attempt >= m_cfg.retries) {
+        m_cnt_dropped += bulk->ends.size();
+        bulk_put(std::move(bulk));
+        return;
+    }
+
+    // Exponential backoff
+    const uint32_t shift = std::min<uint32_t>(bulk->attempt, 16U);
+    const int64_t delay = std::min<int64_t>(int64_t(RETRY_DELAY) << shift, RETRY_DELAY_MAX);
+    const int64_t nsec = now.tv_nsec + (delay % 1000) * 1000000;
+    bulk->not_before.tv_sec = now.tv_sec + delay / 1000 + nsec / 1000000000;
+    bulk->not_before.tv_nsec = nsec % 1000000000;
+    bulk->attempt++;
+
+    m_cnt_retried += bulk->ends.size();
+    m_queue.push_back(std::move(bulk));
+}
+
+/**
+ * \brief Get the number of bulks waiting for a connection or a response
+ */
+size_t
+Elastic::pending() const
+{
+    size_t cnt = m_queue.size();
+    for (const auto &conn : m_conns) {
+        if (conn.bulk) {
+            cnt++;
+        }
+    }
+    return cnt;
+}
+
+/**
+ * \brief Pass waiting bulks to free connections and process events of connections
+ * \param[in] timeout Maximum time to wait for an event (milliseconds)
+ */
+void
+Elastic::progress(int timeout)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    dispatch(now);
+
+    for (size_t i = 0; i < m_conns.size(); ++i) {
+        const Connection &conn = m_conns[i];
+        struct pollfd &pfd = m_pfds[i];
+        pfd.fd = conn.sd;
+        pfd.revents = 0;
+        switch (conn.state) {
+        case conn_state::CONNECTING:
+        case conn_state::SENDING:
+            pfd.events = POLLOUT;
+            break;
+        case conn_state::IDLE:      // Detection of a connection closed by the node
+        case conn_state::RECEIVING:
+            pfd.events = POLLIN;
+            break;
+        default:
+            pfd.fd = INVALID_FD;    // Ignored by poll()
+            pfd.events = 0;
+            break;
+        }
+    }
+
+    if (poll(m_pfds.data(), m_pfds.size(), timeout) <= 0) {
+        return;
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    for (size_t i = 0; i < m_conns.size(); ++i) {
+        Connection &conn = m_conns[i];
+        if (m_pfds[i].fd == INVALID_FD || m_pfds[i].revents == 0) {
+            continue;
+        }
+
+        switch (conn.state) {
+        case conn_state::CONNECTING: {
+            int err = 0;
+            socklen_t err_len = sizeof(err);
+            if (getsockopt(conn.sd, SOL_SOCKET, SO_ERROR, &err, &err_len) == -1) {
+                err = errno;
+            }
+            if (err != 0) {
+                char buffer[128];
+                const char *err_str = strerror_r(err, buffer, 128);
+                IPX_CTX_WARNING(_ctx, "(Elastic output) Unable to connect to '%s': %s. "
+                    "Trying again in %d seconds.", m_desc.c_str(), err_str, int(RECONN_DELAY));
+                conn_close(conn, now);
+                break;
+            }
+
+            IPX_CTX_DEBUG(_ctx, "(Elastic output) Connected to '%s'.", m_desc.c_str());
+            conn.state = conn_state::IDLE;
+            if (conn.bulk) {
+                conn.state = conn_state::SENDING;
+                conn_send(conn, now);
+            }
+            break;
+        }
+        case conn_state::SENDING:
+            conn_send(conn, now);
+            break;
+        case conn_state::RECEIVING:
+            conn_recv(conn, now);
+            break;
+        case conn_state::IDLE:
+            // Closed by the node (e.g. keep-alive timeout)
+            conn_close(conn, now);
+            break;
+        default:
+            break;
+        }
+    }
+
+    // Connections might have been released
+    dispatch(now);
+}
+
+/**
+ * \brief Pass waiting bulks to free connections
+ *
+ * Closed connections are opened again, if necessary.
+ * \param[in] now Current time
+ */
+void
+Elastic::dispatch(const struct timespec &now)
+{
+    auto it = m_queue.begin();
+    while (it != m_queue.end()) {
+        if (time_diff((*it)->not_before, now) < 0) {
+            // Retry of the bulk is postponed
+            ++it;
+            continue;
+        }
+
+        auto conn = std::find_if(m_conns.begin(), m_conns.end(), [](const Connection &c) {
+            return c.state == conn_state::IDLE;
+        });
+        if (conn == m_conns.end()) {
+            conn = std::find_if(m_conns.begin(), m_conns.end(), [&](Connection &c) {
+                return c.state == conn_state::CLOSED && conn_open(c, now);
+            });
+        }
+        if (conn == m_conns.end()) {
+            // No free connection
+            return;
+        }
+
+        std::unique_ptr<Bulk> bulk = std::move(*it);
+        it = m_queue.erase(it);
+        conn_request(*conn, std::move(bulk), now);
+    }
+}
+
+/**
+ * \brief Open a connection to the node (non-blocking)
+ *
+ * Only one connection attempt per #RECONN_DELAY seconds is made.
+ * \param[in] conn Closed connection
+ * \param[in] now  Current time
+ * \return True if the connection is established or in progress, false otherwise
+ */
+bool
+Elastic::conn_open(Connection &conn, const struct timespec &now)
+{
+    if (conn.conn_time.tv_sec != 0 && conn.conn_time.tv_sec + RECONN_DELAY > now.tv_sec) {
+        return false;
+    }
+    conn.conn_time = now;
+
+    std::string port_str = std::to_string(m_cfg.port);
+    struct addrinfo hints;
+    std::memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    hints.ai_flags = AI_NUMERICSERV;
+
+    struct addrinfo *result, *ptr;
+    int rc;
+    if ((rc = getaddrinfo(m_cfg.host.c_str(), port_str.c_str(), &hints, &result)) != 0) {
+        IPX_CTX_WARNING(_ctx, "(Elastic output) getaddrinfo() failed: %s", gai_strerror(rc));
+        return false;
+    }
+
+    for (ptr = result; ptr != nullptr; ptr = ptr->ai_next) {
+        conn.sd = socket(ptr->ai_family, ptr->ai_socktype | SOCK_NONBLOCK | SOCK_CLOEXEC,
+            ptr->ai_protocol);
+        if (conn.sd == INVALID_FD) {
+            continue;
+        }
+
+        if (::connect(conn.sd, ptr->ai_addr, ptr->ai_addrlen) == 0) {
+            conn.state = conn_state::IDLE;
+            break;
+        }
+        if (errno == EINPROGRESS) {
+            conn.state = conn_state::CONNECTING;
+            break;
+        }
+
+        close(conn.sd);
+        conn.sd = INVALID_FD;
+    }
+
+    freeaddrinfo(result);
+    if (ptr == nullptr) {
+        IPX_CTX_WARNING(_ctx, "(Elastic output) Unable to connect to '%s'! "
+            "Trying again in %d seconds.", m_desc.c_str(), int(RECONN_DELAY));
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * \brief Close a connection
+ *
+ * The request in flight (if any) is sent again by another connection. If the request has not
+ * been sent at all, it's not considered as a retry.
+ * \param[in] conn Connection
+ * \param[in] now  Current time
+ */
+void
+Elastic::conn_close(Connection &conn, const struct timespec &now)
+{
+    if (conn.state != conn_state::CONNECTING) {
+        // The connection was established, so the node can be connected again immediately
+        conn.conn_time.tv_sec = 0;
+        conn.conn_time.tv_nsec = 0;
+    }
+
+    if (conn.sd != INVALID_FD) {
+        close(conn.sd);
+        conn.sd = INVALID_FD;
+    }
+    conn.state = conn_state::CLOSED;
+    conn.in.clear();
+    conn.out.clear();
+
+    if (conn.bulk) {
+        if (conn.out_sent == 0) {
+            m_queue.push_front(std::move(conn.bulk));
+        } else {
+            retry(std::move(conn.bulk), now);
+        }
+    }
+    conn.out_sent = 0;
+}
+
+/**
+ * \brief Prepare a request with a bulk and start to send it
+ * \param[in] conn Connection (connected or connecting)
+ * \param[in] bulk Bulk to send
+ * \param[in] now  Current time
+ */
+void
+Elastic::conn_request(Connection &conn, std::unique_ptr<Bulk> bulk, const struct timespec &now)
+{
+    const std::string *body = &bulk->body;
+    bool compressed = false;
+
+    if (m_cfg.gzip) {
+        deflateReset(&m_zs);
+        m_zbody.resize(deflateBound(&m_zs, body->size()));
+        m_zs.next_in = (Bytef *) body->data();
+        m_zs.avail_in = static_cast<uInt>(body->size());
+        m_zs.next_out = (Bytef *) &m_zbody[0];
+        m_zs.avail_out = static_cast<uInt>(m_zbody.size());
+        if (deflate(&m_zs, Z_FINISH) == Z_STREAM_END) {
+            m_zbody.resize(m_zbody.size() - m_zs.avail_out);
+            body = &m_zbody;
+            compressed = true;
+        }
+    }
+
+    conn.out = m_hdr;
+    if (compressed) {
+        conn.out += "Content-Encoding: gzip\r\n";
+    }
+    conn.out += "Content-Length: " + std::to_string(body->size()) + "\r\n\r\n";
+    conn.out += *body;
+    conn.out_sent = 0;
+    conn.in.clear();
+    conn.bulk = std::move(bulk);
+
+    if (conn.state == conn_state::IDLE) {
+        conn.state = conn_state::SENDING;
+        conn_send(conn, now);
+    }
+}
+
+/**
+ * \brief Send (the rest of) a request
+ *
+ * If the request has been sent completely, the connection waits for a response.
+ * \param[in] conn Connection
+ * \param[in] now  Current time
+ */
+void
+Elastic::conn_send(Connection &conn, const struct timespec &now)
+{
+    while (conn.out_sent < conn.out.size()) {
+        ssize_t ret = send(conn.sd, conn.out.data() + conn.out_sent,
+            conn.out.size() - conn.out_sent, MSG_NOSIGNAL | MSG_DONTWAIT);
+        if (ret == -1) {
+            if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR) {
+                return;
+            }
+
+            char buffer[128];
+            const char *err_str = strerror_r(errno, buffer, 128);
+            IPX_CTX_INFO(_ctx, "(Elastic output) Node '%s' disconnected: %s",
+                m_desc.c_str(), err_str);
+            conn_close(conn, now);
+            return;
+        }
+
+        conn.out_sent += static_cast<size_t>(ret);
+    }
+
+    conn.state = conn_state::RECEIVING;
+}
+
+/**
+ * \brief Receive (a part of) a response
+ *
+ * If the response is complete, it's processed and the connection is ready for another request.
+ * \param[in] conn Connection
+ * \param[in] now  Current time
+ */
+void
+Elastic::conn_recv(Connection &conn, const struct timespec &now)
+{
+    char buffer[16384];
+    bool eof = false;
+
+    while (true) {
+        ssize_t ret = recv(conn.sd, buffer, sizeof(buffer), MSG_DONTWAIT);
+        if (ret > 0) {
+            conn.in.append(buffer, static_cast<size_t>(ret));
+            continue;
+        }
+        if (ret == -1 && errno == EINTR) {
+            continue;
+        }
+
+        // End of the stream or a broken connection
+        eof = (ret == 0 || (errno != EAGAIN && errno != EWOULDBLOCK));
+        break;
+    }
+
+    Response resp;
+    if (!response_parse(conn.in, eof, resp)) {
+        if (eof) {
+            IPX_CTX_INFO(_ctx, "(Elastic output) Node '%s' closed the connection without "
+                "a complete response.", m_desc.c_str());
+            conn_close(conn, now);
+        }
+        return;
+    }
+
+    std::unique_ptr<Bulk> bulk = std::move(conn.bulk);
+    conn.state = conn_state::IDLE;
+    conn.in.clear();
+    conn.out.clear();
+    conn.out_sent = 0;
+    if (eof || resp.close) {
+        conn_close(conn, now);
+    }
+
+    response_handle(std::move(bulk), resp, now);
+}
+
+/**
+ * \brief Parse a received HTTP response
+ *
+ * Both bodies with Content-Length and chunked bodies are supported. Bodies without them end
+ * with the end of the connection.
+ * \param[in]  in   Received data
+ * \param[in]  eof  The connection has been closed (no more data will be received)
+ * \param[out] resp Parsed response
+ * \return True if the response is complete, false otherwise
+ */
+bool
+Elastic::response_parse(const std::string &in, bool eof, Response &resp)
+{
+    const size_t hdr_end = in.find("\r\n\r\n");
+    if (hdr_end == std::string::npos) {
+        return false;
+    }
+
+    // Status line (i.e. "HTTP/1.1 200 OK")
+    resp.status = 0;
+    resp.close = (in.compare(0, 8, "HTTP/1.1") != 0);
+    resp.body.clear();
+    const size_t status_pos = in.find(' ');
+    if (in.compare(0, 5, "HTTP/") == 0 && status_pos < hdr_end) {
+        resp.status = std::atoi(in.c_str() + status_pos + 1);
+    }
+
+    // Headers
+    int64_t length = -1;
+    bool chunked = false;
+    size_t pos = in.find("\r\n") + 2;
+    while (pos < hdr_end) {
+        const size_t eol = in.find("\r\n", pos);
+        const size_t colon = in.find(':', pos);
+        if (colon < eol) {
+            std::string name = in.substr(pos, colon - pos);
+            std::string value = in.substr(colon + 1, eol - colon - 1);
+            std::transform(name.begin(), name.end(), name.begin(), ::tolower);
+            std::transform(value.begin(), value.end(), value.begin(), ::tolower);
+            value.erase(0, value.find_first_not_of(" \t"));
+
+            if (name == "content-length") {
+                length = std::strtoll(value.c_str(), nullptr, 10);
+            } else if (name == "transfer-encoding") {
+                chunked = (value.find("chunked") != std::string::npos);
+            } else if (name == "connection") {
+                resp.close = (value.compare(0, 5, "close") == 0);
+            }
+        }
+        pos = eol + 2;
+    }
+
+    pos = hdr_end + 4;
+    if (chunked) {
+        while (true) {
+            const size_t eol = in.find("\r\n", pos);
+            if (eol == std::string::npos) {
+                return false;
+            }
+
+            const size_t size = std::strtoul(in.c_str() + pos, nullptr, 16);
+            pos = eol + 2;
+            if (size == 0) {
+                // The last chunk is followed by optional trailers and an empty line
+                if (in.size() < pos + 2) {
+                    return false;
+                }
+                return in.compare(pos, 2, "\r\n") == 0
+                    || in.find("\r\n\r\n", pos) != std::string::npos;
+            }
+
+            if (in.size() < pos + size + 2) {
+                return false;
+            }
+            resp.body.append(in, pos, size);
+            pos += size + 2;
+        }
+    }
+
+    if (length >= 0) {
+        if (in.size() - pos < static_cast<uint64_t>(length)) {
+            return false;
+        }
+        resp.body.assign(in, pos, static_cast<size_t>(length));
+        return true;
+    }
+
+    if (!eof) {
+        return false;
+    }
+    resp.body.assign(in, pos, std::string::npos);
+    resp.close = true;
+    return true;
+}
+
+/**
+ * \brief Process a response to a bulk request
+ *
+ * If the whole request has been rejected due to overload or a failure of the node, all
+ * documents are sent again. Otherwise, only documents rejected due to overload (429) or
+ * a failure of a shard (5xx) are sent again and other rejected documents are dropped.
+ * \param[in] bulk Bulk of the request
+ * \param[in] resp Response
+ * \param[in] now  Current time
+ */
+void
+Elastic::response_handle(std::unique_ptr<Bulk> bulk, const Response &resp,
+    const struct timespec &now)
+{
+    auto retryable = [](int status) {
+        return status == 0 || status == 429 || status >= 500;
+    };
+
+    if (resp.status < 200 || resp.status >= 300) {
+        if (retryable(resp.status)) {
+            retry(std::move(bulk), now);
+            return;
+        }
+
+        const int len = static_cast<int>(std::min<size_t>(resp.body.size(), REASON_MAX));
+        IPX_CTX_ERROR(_ctx, "(Elastic output) Bulk request rejected by '%s' (HTTP %d): %.*s",
+            m_desc.c_str(), resp.status, len, resp.body.c_str());
+        m_cnt_dropped += bulk->ends.size();
+        bulk_put(std::move(bulk));
+        return;
+    }
+
+    const std::string &body = resp.body;
+    const size_t items = body.find("\"items\"");
+    const size_t errors = body.find("\"errors\":true");
+    if (errors == std::string::npos || errors > items) {
+        // All documents have been accepted
+        m_cnt_sent += bulk->ends.size();
+        bulk_put(std::move(bulk));
+        return;
+    }
+
+    // Check status of each document (items are in the same order as the documents)
+    std::unique_ptr<Bulk> again;
+    size_t pos = items;
+    size_t start = 0;
+    for (size_t i = 0; i < bulk->ends.size(); ++i) {
+        const size_t end = bulk->ends[i];
+        int status = 0;
+        if (pos != std::string::npos) {
+            pos = body.find("\"status\":", pos);
+        }
+        if (pos != std::string::npos) {
+            pos += strlen("\"status\":");
+            status = std::atoi(body.c_str() + pos);
+        }
+
+        if (status >= 200 && status < 300) {
+            m_cnt_sent++;
+        } else if (retryable(status) && bulk->attempt < m_cfg.retries) {
+            if (!again) {
+                again = bulk_get();
+                again->attempt = bulk->attempt;
+            }
+            again->body.append(bulk->body, start, end - start);
+            again->ends.push_back(again->body.size());
+        } else {
+            m_cnt_dropped++;
+            // Remember the reason (only for the stats report)
+            const size_t next = (pos != std::string::npos)
+                ? body.find("\"status\":", pos) : std::string::npos;
+            const size_t reason = (pos != std::string::npos)
+                ? body.find("\"reason\":\"", pos) : std::string::npos;
+            if (m_last_error.empty() && reason < next) {
+                const size_t r_start = reason + strlen("\"reason\":\"");
+                size_t r_end = r_start;
+                while (r_end < body.size() && body[r_end] != '"') {
+                    r_end += (body[r_end] == '\\') ? 2 : 1;
+                }
+                m_last_error.assign(body, r_start, std::min<size_t>(r_end - r_start, REASON_MAX));
+                m_last_error = "(HTTP " + std::to_string(status) + ") " + m_last_error;
+            }
+        }
+
+        start = end;
+    }
+
+    bulk_put(std::move(bulk));
+    if (again) {
+        retry(std::move(again), now);
+    }
+}
+
+/**
+ * \brief Report statistics of documents (once per #STATS_DELAY seconds)
+ * \param[in] now Current time
+ */
+void
+Elastic::report_stats(const struct timespec &now)
+{
+    if (m_stats_time.tv_sec + STATS_DELAY > now.tv_sec) {
+        return;
+    }
+
+    m_stats_time = now;
+
+    IPX_CTX_INFO(_ctx, "(Elastic output) STATS: sent: %" PRIu64 ", retried: %" PRIu64
+        ", dropped: %" PRIu64, m_cnt_sent, m_cnt_retried, m_cnt_dropped);
+    if (!m_last_error.empty()) {
+        IPX_CTX_WARNING(_ctx, "(Elastic output) Document rejected by '%s': %s", m_desc.c_str(),
+            m_last_error.c_str());
+        m_last_error.clear();
+    }
+
+    m_cnt_sent = 0;
+    m_cnt_retried = 0;
+    m_cnt_dropped = 0;
+}
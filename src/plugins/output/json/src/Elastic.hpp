@@ -0,0 +1,183 @@
+/**
+ * \file src/plugins/output/json/src/Elastic.hpp
+ * \author agent <agent@local>
+ * \brief Elasticsearch/OpenSearch bulk output (header file)
+ * \date 2026
+ */
+
+/* Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is'', and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#ifndef JSON_ELASTIC_H
+#define JSON_ELASTIC_H
+
+#include <ctime>
+#include <deque>
+#include <memory>
+#include <string>
+#include <vector>
+#include <poll.h>
+#include <zlib.h>
+#include "Config.hpp"
+#include "Storage.hpp"
+
+/**
+ * \brief Elasticsearch/OpenSearch output (Bulk API over HTTP)
+ *
+ * Records are collected into bulks (NDJSON bodies of _bulk requests), which are sent over
+ * persistent (keep-alive) HTTP/1.1 connections. Each connection carries at most one request
+ * at a time, so the number of connections is also the number of requests in flight.
+ * Documents rejected by the cluster due to overload (e.g. 429 Too Many Requests) are sent
+ * again in a later bulk, other rejected documents are dropped.
+ */
+class Elastic : public Output {
+public:
+    // Constructor
+    Elastic(const struct cfg_elastic &cfg, ipx_ctx_t *ctx);
+    // Destructor
+    ~Elastic();
+
+    // Processing records
+    int process(const char *str, size_t len);
+    // Processing a batch of records
+    int process_batch(const struct Batch &batch);
+    // Send records waiting for too long and process responses
+    void flush();
+
+private:
+    /** Bulk of documents (i.e. a body of a request)                              */
+    struct Bulk {
+        /** Action and source lines of documents                                  */
+        std::string body;
+        /** Offsets of ends of documents in the body                              */
+        std::vector<size_t> ends;
+        /** Number of previous attempts to send the documents                     */
+        uint32_t attempt;
+        /** The bulk cannot be sent before this time (retries only)               */
+        struct timespec not_before;
+    };
+
+    /** State of a connection                                                     */
+    enum class conn_state {
+        CLOSED,     ///< Not connected
+        CONNECTING, ///< Waiting for a non-blocking connect
+        IDLE,       ///< Connected, no request in flight
+        SENDING,    ///< Sending a request
+        RECEIVING   ///< Waiting for a response
+    };
+
+    /** Connection to the node                                                    */
+    struct Connection {
+        /** File descriptor of the socket                                         */
+        int sd;
+        /** State of the connection                                               */
+        conn_state state;
+        /** Bulk of the request in flight (nullptr, if none)                      */
+        std::unique_ptr<Bulk> bulk;
+        /** Serialized request (headers and a possibly compressed body)           */
+        std::string out;
+        /** Number of already sent bytes of the request                           */
+        size_t out_sent;
+        /** Received part of the response                                         */
+        std::string in;
+        /** Time of the last connection attempt                                   */
+        struct timespec conn_time;
+    };
+
+    /** Parsed HTTP response                                                      */
+    struct Response {
+        /** Status code                                                           */
+        int status;
+        /** Body (decoded, if chunked)                                            */
+        std::string body;
+        /** The server is going to close the connection                           */
+        bool close;
+    };
+
+    /** Configuration parameters of the output                                    */
+    struct cfg_elastic m_cfg;
+    /** Common part of request headers (i.e. everything except Content-Length)    */
+    std::string m_hdr;
+    /** Description of the node (only for log)                                    */
+    std::string m_desc;
+    /** GZIP compression context (only if enabled)                                */
+    z_stream m_zs;
+    /** Compressed body of the last request                                       */
+    std::string m_zbody;
+
+    /** Bulk being filled (nullptr, if empty)                                     */
+    std::unique_ptr<Bulk> m_current;
+    /** Time of the oldest document of the current bulk                           */
+    struct timespec m_current_time;
+    /** Bulks waiting for a free connection (including retries)                   */
+    std::deque<std::unique_ptr<Bulk>> m_queue;
+    /** Unused bulks ready to be reused                                           */
+    std::vector<std::unique_ptr<Bulk>> m_unused;
+    /** Connections                                                               */
+    std::vector<Connection> m_conns;
+    /** Poll descriptors of connections (indexes match)                           */
+    std::vector<struct pollfd> m_pfds;
+
+    /** Number of documents accepted by the cluster                               */
+    uint64_t m_cnt_sent;
+    /** Number of documents sent again                                            */
+    uint64_t m_cnt_retried;
+    /** Number of dropped documents                                               */
+    uint64_t m_cnt_dropped;
+    /** Reason of the last dropped document (reported together with stats)       */
+    std::string m_last_error;
+    /** Time of the last stats report                                             */
+    struct timespec m_stats_time;
+
+    void prepare_hdr();
+    std::unique_ptr<Bulk> bulk_get();
+    void bulk_put(std::unique_ptr<Bulk> bulk);
+    void append(const char *str, size_t len);
+    void submit();
+    void retry(std::unique_ptr<Bulk> bulk, const struct timespec &now);
+    size_t pending() const;
+    void progress(int timeout);
+    void dispatch(const struct timespec &now);
+    bool conn_open(Connection &conn, const struct timespec &now);
+    void conn_close(Connection &conn, const struct timespec &now);
+    void conn_request(Connection &conn, std::unique_ptr<Bulk> bulk, const struct timespec &now);
+    void conn_send(Connection &conn, const struct timespec &now);
+    void conn_recv(Connection &conn, const struct timespec &now);
+    static bool response_parse(const std::string &in, bool eof, Response &resp);
+    void response_handle(std::unique_ptr<Bulk> bulk, const Response &resp,
+        const struct timespec &now);
+    void report_stats(const struct timespec &now);
+};
+
+#endif // JSON_ELASTIC_H
@@ -52,7 +52,6 @@
 #include <sys/stat.h>
 #include <unistd.h>
 #include <climits>
-#include <zlib.h>
 
 /**
  * \brief Class constructor
@@ -63,7 +62,6 @@ File::File(const struct cfg_file &cfg, ipx_ctx_t *ctx) : Output(cfg.name, ctx)
 {
     // Prepare a configuration of the thread for changing time windows
     _thread = new thread_ctx_t;
-    _thread->file = nullptr;
     _thread->stop = false;
 
     _thread->ctx = ctx;
@@ -74,10 +72,21 @@ File::File(const struct cfg_file &cfg, ipx_ctx_t *ctx) : Output(cfg.name, ctx)
     time(&_thread->window_time);
 
     if (cfg.window_size < _WINDOW_MIN_SIZE) {
+        delete _thread;
         throw std::runtime_error("(File output) Window size is too small (min. size: "
             + std::to_string(_WINDOW_MIN_SIZE) + ")");
     }
 
+    try {
+        _thread->writer.reset(new Writer(ctx, cfg.direct_io, cfg.sync));
+        if (cfg.m_calg != calg::NONE) {
+            _thread->comp.reset(new Compressor(ctx, cfg.m_calg, cfg.level, cfg.threads));
+        }
+    } catch (...) {
+        delete _thread;
+        throw;
+    }
+
     // Make sure the path ends with '/' character
     if (_thread->storage_path.back() != '/') {
         _thread->storage_path += '/';
@@ -90,43 +99,32 @@ File::File(const struct cfg_file &cfg, ipx_ctx_t *ctx) : Output(cfg.name, ctx)
     }
 
     // Create directory & first file
-    void *new_file = file_create(ctx, _thread->storage_path, _thread->file_prefix,
-        _thread->window_time, _thread->m_calg);
-    if (!new_file) {
+    if (file_create(ctx, _thread->storage_path, _thread->file_prefix, _thread->window_time,
+            _thread->m_calg, *_thread->writer) != 0) {
         delete _thread;
         throw std::runtime_error("(File output) Failed to create a time window file.");
     }
 
-    _thread->file = new_file;
+    if (_thread->comp) {
+        _thread->comp->begin(_thread->writer.get());
+    }
 
     pthread_rwlockattr_t attr;
     if (pthread_rwlockattr_init(&attr) != 0) {
-        if (_thread->m_calg == calg::GZIP) {
-            gzclose((gzFile)_thread->file);
-        } else {
-            fclose((FILE *)_thread->file);
-        }
+        file_close(_thread);
         delete _thread;
         throw std::runtime_error("(File output) Rwlockattr initialization failed!");
     }
 
     if (pthread_rwlockattr_setkind_np(&attr, PTHREAD_RWLOCK_PREFER_WRITER_NONRECURSIVE_NP) != 0) {
-        if (_thread->m_calg == calg::GZIP) {
-            gzclose((gzFile)_thread->file);
-        } else {
-            fclose((FILE *)_thread->file);
-        }
+        file_close(_thread);
         pthread_rwlockattr_destroy(&attr);
         delete _thread;
         throw std::runtime_error("(File output) Rwlockattr setkind failed!");
     }
 
     if (pthread_rwlock_init(&_thread->rwlock, &attr) != 0) {
-        if (_thread->m_calg == calg::GZIP) {
-            gzclose((gzFile)_thread->file);
-        } else {
-            fclose((FILE *)_thread->file);
-        }
+        file_close(_thread);
         pthread_rwlockattr_destroy(&attr);
         delete _thread;
         throw std::runtime_error("(File output) Rwlock initialization failed!");
@@ -134,11 +132,7 @@ File::File(const struct cfg_file &cfg, ipx_ctx_t *ctx) : Output(cfg.name, ctx)
 
     pthread_rwlockattr_destroy(&attr);
     if (pthread_create(&_thread->thread, NULL, &File::thread_window, _thread) != 0) {
-        if (_thread->m_calg == calg::GZIP) {
-            gzclose((gzFile)_thread->file);
-        } else {
-            fclose((FILE *)_thread->file);
-        }
+        file_close(_thread);
         pthread_rwlock_destroy(&_thread->rwlock);
         delete _thread;
         throw std::runtime_error("(File output) Failed to start a thread for changing time "
@@ -158,13 +152,7 @@ File::~File()
         pthread_join(_thread->thread, NULL);
         pthread_rwlock_destroy(&_thread->rwlock);
 
-        if (_thread->file) {
-            if (_thread->m_calg == calg::GZIP) {
-                gzclose((gzFile)_thread->file);
-            } else {
-                fclose((FILE *)_thread->file);
-            }
-        }
+        file_close(_thread);
 
         delete _thread;
     }
@@ -198,23 +186,16 @@ File::thread_window(void *context)
 
         // New time window
         pthread_rwlock_wrlock(&data->rwlock);
-        if (data->file) {
-            if (data->m_calg == calg::GZIP) {
-                gzclose((gzFile)data->file);
-            } else {
-                fclose((FILE *)data->file);
-            }
-            data->file = nullptr;
-        }
+        file_close(data);
 
         data->window_time += data->window_size;
-        void *file = file_create(data->ctx, data->storage_path, data->file_prefix, data->window_time, data->m_calg);
-        if (!file) {
+        if (file_create(data->ctx, data->storage_path, data->file_prefix, data->window_time,
+                data->m_calg, *data->writer) != 0) {
+            // Closed file is also valid...
             IPX_CTX_ERROR(data->ctx, "(File output) Failed to create a time window file.", '\0');
+        } else if (data->comp) {
+            data->comp->begin(data->writer.get());
         }
-
-        // Null pointer is also valid...
-        data->file = file;
         pthread_rwlock_unlock(&data->rwlock);
     }
 
@@ -233,28 +214,41 @@ int
 File::process(const char *str, size_t len)
 {
     pthread_rwlock_rdlock(&_thread->rwlock);
-    if (_thread->file) {
+    if (_thread->writer->is_open()) {
         // Store the record
-        if (_thread->m_calg == calg::GZIP) {
-            gzwrite((gzFile)_thread->file, str, len);
+        if (_thread->comp) {
+            _thread->comp->write(str, len);
         } else {
-            fwrite(str, len, 1, (FILE *)_thread->file);
+            _thread->writer->write(str, len);
         }
     }
     pthread_rwlock_unlock(&_thread->rwlock);
     return IPX_OK;
 }
 
+/**
+ * \brief Store a batch of records to a file
+ *
+ * All records are written at once.
+ * \param[in] batch Batch of JSON records
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_DENIED in case of a fatal error (the output cannot continue)
+ */
+int
+File::process_batch(const struct Batch &batch)
+{
+    return process(batch.data, batch.len);
+}
+
 void
 File::flush()
 {
     pthread_rwlock_rdlock(&_thread->rwlock);
-    if (_thread->file) {
-        if (_thread->m_calg == calg::GZIP) {
-            gzflush((gzFile)_thread->file, Z_SYNC_FLUSH);
-        } else {
-            fflush((FILE *)_thread->file);
+    if (_thread->writer->is_open()) {
+        if (_thread->comp) {
+            _thread->comp->flush();
         }
+        _thread->writer->flush();
     }
     pthread_rwlock_unlock(&_thread->rwlock);
 }
@@ -374,11 +368,13 @@ File::dir_create(ipx_ctx_t *ctx, const std::string &path)
  * \param[in] tmplt  Output path template
  * \param[in] prefix File prefix
  * \param[in] tm     Timestamp
- * \return On success returns pointer to the file, Otherwise returns NULL.
+ * \param[in] m_calg Compression algorithm (affects the file suffix)
+ * \param[in] writer Writer to open the file with
+ * \return On success returns 0. Otherwise returns non-zero value.
  */
-void *
+int
 File::file_create(ipx_ctx_t *ctx, const std::string &tmplt, const std::string &prefix,
-    const time_t &tm, calg m_calg)
+    const time_t &tm, calg m_calg, Writer &writer)
 {
     char file_fmt[20];
 
@@ -386,42 +382,52 @@ File::file_create(ipx_ctx_t *ctx, const std::string &tmplt, const std::string &p
     struct tm gm;
     if (gmtime_r(&tm, &gm) == NULL) {
         IPX_CTX_ERROR(ctx, "(File output) Failed to convert time to UTC.", '\0');
-        return NULL;
+        return 1;
     }
 
     // Convert time template to a string
     if (strftime(file_fmt, sizeof(file_fmt), "%Y%m%d%H%M", &gm) == 0) {
         IPX_CTX_ERROR(ctx, "(File output) Failed to create a name of a flow file.", '\0');
-        return NULL;
+        return 1;
     }
 
     // Check/create a directory
     std::string directory;
     if (dir_name(tm, tmplt, directory) != 0) {
         IPX_CTX_ERROR(ctx, "(File output) Failed to process output path pattern!", '\0');
-        return NULL;
+        return 1;
     }
 
     if (dir_create(ctx, directory) != 0) {
-        return NULL;
+        return 1;
     }
 
-    std::string file_name;
-    void *file;
-    if (m_calg == calg::GZIP) {
-        file_name = directory + prefix + file_fmt + ".gz";
-        file = gzopen(file_name.c_str(), "a9");
-    } else {
-        file_name = directory + prefix + file_fmt;
-        file = fopen(file_name.c_str(), "a");
-    }
-    if (!file) {
+    // Records (or compressed frames) are appended to an existing file too
+    const std::string file_name = directory + prefix + file_fmt + Compressor::suffix(m_calg);
+    if (!writer.open(file_name)) {
         // Failed to create a flow file
-        char buffer[128];
-        const char *err_str = strerror_r(errno, buffer, 128);
-        IPX_CTX_ERROR(ctx, "Failed to create a flow file '%s' (%s).", file_name.c_str(), err_str);
-        return NULL;
+        return 1;
+    }
+
+    return 0;
+}
+
+/**
+ * \brief Close the file of a time window
+ *
+ * All remaining records are compressed (if enabled) and written before the file is closed.
+ * \param[in,out] data Thread configuration
+ */
+void
+File::file_close(thread_ctx_t *data)
+{
+    if (!data->writer->is_open()) {
+        return;
+    }
+
+    if (data->comp) {
+        data->comp->finish();
     }
 
-    return file;
+    data->writer->close();
 }
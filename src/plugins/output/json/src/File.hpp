@@ -43,12 +43,15 @@
 #define JSON_FILE_H
 
 #include <atomic>
+#include <memory>
 #include <string>
 #include <ctime>
 
 #include <pthread.h>
+#include "Compressor.hpp"
 #include "Storage.hpp"
 #include "Config.hpp"
+#include "Writer.hpp"
 
 /**
  * \brief The class for file output interface
@@ -61,6 +64,8 @@ public:
 
     // Store a record to the file
     int process(const char *str, size_t len);
+    // Store a batch of records to the file
+    int process_batch(const struct Batch &batch);
 
     void flush();
 private:
@@ -79,8 +84,9 @@ private:
         std::string storage_path;    /**< Storage path (template)    */
         std::string file_prefix;     /**< File prefix                */
         calg m_calg;                 /**< Compression                */
+        std::unique_ptr<Compressor> comp; /**< Block compressor (can be nullptr) */
 
-        void *file;                  /**< File descriptor            */
+        std::unique_ptr<Writer> writer;   /**< Writer of the current file        */
     } thread_ctx_t;
 
     /** Thread for changing time windows */
@@ -92,8 +98,10 @@ private:
     // Create a directory for a time window
     static int dir_create(ipx_ctx_t *ctx, const std::string &path);
     // Create a file for a time window
-    static void *file_create(ipx_ctx_t *ctx, const std::string &tmplt, const std::string &prefix,
-        const time_t &tm, calg m_calg);
+    static int file_create(ipx_ctx_t *ctx, const std::string &tmplt, const std::string &prefix,
+        const time_t &tm, calg m_calg, Writer &writer);
+    // Close the file of a time window
+    static void file_close(thread_ctx_t *data);
     // Window changer
     static void *thread_window(void *context);
 };
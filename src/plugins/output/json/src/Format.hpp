@@ -0,0 +1,459 @@
+/**
+ * \file src/plugins/output/json/src/Format.hpp
+ * \author agent <agent@local>
+ * \brief Formatters of numbers, addresses and timestamps (header file)
+ * \date 2026
+ */
+
+/* Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is'', and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#ifndef JSON_FORMAT_H
+#define JSON_FORMAT_H
+
+#include <cstdint>
+#include <cstring>
+
+/*
+ * Branch-light text formatters of values that dominate the JSON output. The formatters are
+ * shared by the JSON and JSON-Kafka output plugins. Each function writes the text to the
+ * output position (without a terminating null byte) and returns the position after the text.
+ * The caller is responsible for the output buffer to be large enough (see FMT_LEN_* constants).
+ */
+
+/** Maximum length of a formatted unsigned integer                                            */
+#define FMT_LEN_UINT     20U
+/** Maximum length of a formatted signed integer                                              */
+#define FMT_LEN_INT      21U
+/** Minimum size of the output buffer of an IPv4 address (the text is at most 15 bytes long)  */
+#define FMT_LEN_IPV4     16U
+/** Maximum length of a formatted IPv6 address                                                */
+#define FMT_LEN_IPV6     45U
+/** Length of a formatted timestamp (e.g. "2018-01-22T09:29:57.828Z")                         */
+#define FMT_LEN_TIME     24U
+/** Maximum number of seconds since UNIX epoch of a formatted timestamp (9999-12-31T23:59:59) */
+#define FMT_TIME_SEC_MAX UINT64_C(253402300799)
+
+/** Pairs of decimal digits                                                                   */
+static const char FMT_DIGIT_PAIRS[] =
+    "00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+    "40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+    "8081828384858687888990919293949596979899";
+
+/** Powers of 10 used to count digits (the first item is zero on purpose)                     */
+static const uint64_t FMT_POW10[20] = {
+    0U, UINT64_C(10), UINT64_C(100), UINT64_C(1000), UINT64_C(10000), UINT64_C(100000),
+    UINT64_C(1000000), UINT64_C(10000000), UINT64_C(100000000), UINT64_C(1000000000),
+    UINT64_C(10000000000), UINT64_C(100000000000), UINT64_C(1000000000000),
+    UINT64_C(10000000000000), UINT64_C(100000000000000), UINT64_C(1000000000000000),
+    UINT64_C(10000000000000000), UINT64_C(100000000000000000), UINT64_C(1000000000000000000),
+    UINT64_C(10000000000000000000)
+};
+
+/** Text of an octet of an IPv4 address followed by a dot                                     */
+struct fmt_octet {
+    /** Digits and the dot                                                                    */
+    char text[4];
+    /** Number of digits                                                                      */
+    uint8_t len;
+};
+
+/** Texts of all octets of an IPv4 address                                                    */
+static const struct fmt_octet FMT_OCTETS[256] = {
+    {{'0', '.'}, 1}, {{'1', '.'}, 1}, {{'2', '.'}, 1}, {{'3', '.'}, 1}, {{'4', '.'}, 1},
+    {{'5', '.'}, 1}, {{'6', '.'}, 1}, {{'7', '.'}, 1}, {{'8', '.'}, 1}, {{'9', '.'}, 1},
+    {{'1', '0', '.'}, 2}, {{'1', '1', '.'}, 2}, {{'1', '2', '.'}, 2}, {{'1', '3', '.'}, 2},
+    {{'1', '4', '.'}, 2}, {{'1', '5', '.'}, 2}, {{'1', '6', '.'}, 2}, {{'1', '7', '.'}, 2},
+    {{'1', '8', '.'}, 2}, {{'1', '9', '.'}, 2}, {{'2', '0', '.'}, 2}, {{'2', '1', '.'}, 2},
+    {{'2', '2', '.'}, 2}, {{'2', '3', '.'}, 2}, {{'2', '4', '.'}, 2}, {{'2', '5', '.'}, 2},
+    {{'2', '6', '.'}, 2}, {{'2', '7', '.'}, 2}, {{'2', '8', '.'}, 2}, {{'2', '9', '.'}, 2},
+    {{'3', '0', '.'}, 2}, {{'3', '1', '.'}, 2}, {{'3', '2', '.'}, 2}, {{'3', '3', '.'}, 2},
+    {{'3', '4', '.'}, 2}, {{'3', '5', '.'}, 2}, {{'3', '6', '.'}, 2}, {{'3', '7', '.'}, 2},
+    {{'3', '8', '.'}, 2}, {{'3', '9', '.'}, 2}, {{'4', '0', '.'}, 2}, {{'4', '1', '.'}, 2},
+    {{'4', '2', '.'}, 2}, {{'4', '3', '.'}, 2}, {{'4', '4', '.'}, 2}, {{'4', '5', '.'}, 2},
+    {{'4', '6', '.'}, 2}, {{'4', '7', '.'}, 2}, {{'4', '8', '.'}, 2}, {{'4', '9', '.'}, 2},
+    {{'5', '0', '.'}, 2}, {{'5', '1', '.'}, 2}, {{'5', '2', '.'}, 2}, {{'5', '3', '.'}, 2},
+    {{'5', '4', '.'}, 2}, {{'5', '5', '.'}, 2}, {{'5', '6', '.'}, 2}, {{'5', '7', '.'}, 2},
+    {{'5', '8', '.'}, 2}, {{'5', '9', '.'}, 2}, {{'6', '0', '.'}, 2}, {{'6', '1', '.'}, 2},
+    {{'6', '2', '.'}, 2}, {{'6', '3', '.'}, 2}, {{'6', '4', '.'}, 2}, {{'6', '5', '.'}, 2},
+    {{'6', '6', '.'}, 2}, {{'6', '7', '.'}, 2}, {{'6', '8', '.'}, 2}, {{'6', '9', '.'}, 2},
+    {{'7', '0', '.'}, 2}, {{'7', '1', '.'}, 2}, {{'7', '2', '.'}, 2}, {{'7', '3', '.'}, 2},
+    {{'7', '4', '.'}, 2}, {{'7', '5', '.'}, 2}, {{'7', '6', '.'}, 2}, {{'7', '7', '.'}, 2},
+    {{'7', '8', '.'}, 2}, {{'7', '9', '.'}, 2}, {{'8', '0', '.'}, 2}, {{'8', '1', '.'}, 2},
+    {{'8', '2', '.'}, 2}, {{'8', '3', '.'}, 2}, {{'8', '4', '.'}, 2}, {{'8', '5', '.'}, 2},
+    {{'8', '6', '.'}, 2}, {{'8', '7', '.'}, 2}, {{'8', '8', '.'}, 2}, {{'8', '9', '.'}, 2},
+    {{'9', '0', '.'}, 2}, {{'9', '1', '.'}, 2}, {{'9', '2', '.'}, 2}, {{'9', '3', '.'}, 2},
+    {{'9', '4', '.'}, 2}, {{'9', '5', '.'}, 2}, {{'9', '6', '.'}, 2}, {{'9', '7', '.'}, 2},
+    {{'9', '8', '.'}, 2}, {{'9', '9', '.'}, 2}, {{'1', '0', '0', '.'}, 3},
+    {{'1', '0', '1', '.'}, 3}, {{'1', '0', '2', '.'}, 3}, {{'1', '0', '3', '.'}, 3},
+    {{'1', '0', '4', '.'}, 3}, {{'1', '0', '5', '.'}, 3}, {{'1', '0', '6', '.'}, 3},
+    {{'1', '0', '7', '.'}, 3}, {{'1', '0', '8', '.'}, 3}, {{'1', '0', '9', '.'}, 3},
+    {{'1', '1', '0', '.'}, 3}, {{'1', '1', '1', '.'}, 3}, {{'1', '1', '2', '.'}, 3},
+    {{'1', '1', '3', '.'}, 3}, {{'1', '1', '4', '.'}, 3}, {{'1', '1', '5', '.'}, 3},
+    {{'1', '1', '6', '.'}, 3}, {{'1', '1', '7', '.'}, 3}, {{'1', '1', '8', '.'}, 3},
+    {{'1', '1', '9', '.'}, 3}, {{'1', '2', '0', '.'}, 3}, {{'1', '2', '1', '.'}, 3},
+    {{'1', '2', '2', '.'}, 3}, {{'1', '2', '3', '.'}, 3}, {{'1', '2', '4', '.'}, 3},
+    {{'1', '2', '5', '.'}, 3}, {{'1', '2', '6', '.'}, 3}, {{'1', '2', '7', '.'}, 3},
+    {{'1', '2', '8', '.'}, 3}, {{'1', '2', '9', '.'}, 3}, {{'1', '3', '0', '.'}, 3},
+    {{'1', '3', '1', '.'}, 3}, {{'1', '3', '2', '.'}, 3}, {{'1', '3', '3', '.'}, 3},
+    {{'1', '3', '4', '.'}, 3}, {{'1', '3', '5', '.'}, 3}, {{'1', '3', '6', '.'}, 3},
+    {{'1', '3', '7', '.'}, 3}, {{'1', '3', '8', '.'}, 3}, {{'1', '3', '9', '.'}, 3},
+    {{'1', '4', '0', '.'}, 3}, {{'1', '4', '1', '.'}, 3}, {{'1', '4', '2', '.'}, 3},
+    {{'1', '4', '3', '.'}, 3}, {{'1', '4', '4', '.'}, 3}, {{'1', '4', '5', '.'}, 3},
+    {{'1', '4', '6', '.'}, 3}, {{'1', '4', '7', '.'}, 3}, {{'1', '4', '8', '.'}, 3},
+    {{'1', '4', '9', '.'}, 3}, {{'1', '5', '0', '.'}, 3}, {{'1', '5', '1', '.'}, 3},
+    {{'1', '5', '2', '.'}, 3}, {{'1', '5', '3', '.'}, 3}, {{'1', '5', '4', '.'}, 3},
+    {{'1', '5', '5', '.'}, 3}, {{'1', '5', '6', '.'}, 3}, {{'1', '5', '7', '.'}, 3},
+    {{'1', '5', '8', '.'}, 3}, {{'1', '5', '9', '.'}, 3}, {{'1', '6', '0', '.'}, 3},
+    {{'1', '6', '1', '.'}, 3}, {{'1', '6', '2', '.'}, 3}, {{'1', '6', '3', '.'}, 3},
+    {{'1', '6', '4', '.'}, 3}, {{'1', '6', '5', '.'}, 3}, {{'1', '6', '6', '.'}, 3},
+    {{'1', '6', '7', '.'}, 3}, {{'1', '6', '8', '.'}, 3}, {{'1', '6', '9', '.'}, 3},
+    {{'1', '7', '0', '.'}, 3}, {{'1', '7', '1', '.'}, 3}, {{'1', '7', '2', '.'}, 3},
+    {{'1', '7', '3', '.'}, 3}, {{'1', '7', '4', '.'}, 3}, {{'1', '7', '5', '.'}, 3},
+    {{'1', '7', '6', '.'}, 3}, {{'1', '7', '7', '.'}, 3}, {{'1', '7', '8', '.'}, 3},
+    {{'1', '7', '9', '.'}, 3}, {{'1', '8', '0', '.'}, 3}, {{'1', '8', '1', '.'}, 3},
+    {{'1', '8', '2', '.'}, 3}, {{'1', '8', '3', '.'}, 3}, {{'1', '8', '4', '.'}, 3},
+    {{'1', '8', '5', '.'}, 3}, {{'1', '8', '6', '.'}, 3}, {{'1', '8', '7', '.'}, 3},
+    {{'1', '8', '8', '.'}, 3}, {{'1', '8', '9', '.'}, 3}, {{'1', '9', '0', '.'}, 3},
+    {{'1', '9', '1', '.'}, 3}, {{'1', '9', '2', '.'}, 3}, {{'1', '9', '3', '.'}, 3},
+    {{'1', '9', '4', '.'}, 3}, {{'1', '9', '5', '.'}, 3}, {{'1', '9', '6', '.'}, 3},
+    {{'1', '9', '7', '.'}, 3}, {{'1', '9', '8', '.'}, 3}, {{'1', '9', '9', '.'}, 3},
+    {{'2', '0', '0', '.'}, 3}, {{'2', '0', '1', '.'}, 3}, {{'2', '0', '2', '.'}, 3},
+    {{'2', '0', '3', '.'}, 3}, {{'2', '0', '4', '.'}, 3}, {{'2', '0', '5', '.'}, 3},
+    {{'2', '0', '6', '.'}, 3}, {{'2', '0', '7', '.'}, 3}, {{'2', '0', '8', '.'}, 3},
+    {{'2', '0', '9', '.'}, 3}, {{'2', '1', '0', '.'}, 3}, {{'2', '1', '1', '.'}, 3},
+    {{'2', '1', '2', '.'}, 3}, {{'2', '1', '3', '.'}, 3}, {{'2', '1', '4', '.'}, 3},
+    {{'2', '1', '5', '.'}, 3}, {{'2', '1', '6', '.'}, 3}, {{'2', '1', '7', '.'}, 3},
+    {{'2', '1', '8', '.'}, 3}, {{'2', '1', '9', '.'}, 3}, {{'2', '2', '0', '.'}, 3},
+    {{'2', '2', '1', '.'}, 3}, {{'2', '2', '2', '.'}, 3}, {{'2', '2', '3', '.'}, 3},
+    {{'2', '2', '4', '.'}, 3}, {{'2', '2', '5', '.'}, 3}, {{'2', '2', '6', '.'}, 3},
+    {{'2', '2', '7', '.'}, 3}, {{'2', '2', '8', '.'}, 3}, {{'2', '2', '9', '.'}, 3},
+    {{'2', '3', '0', '.'}, 3}, {{'2', '3', '1', '.'}, 3}, {{'2', '3', '2', '.'}, 3},
+    {{'2', '3', '3', '.'}, 3}, {{'2', '3', '4', '.'}, 3}, {{'2', '3', '5', '.'}, 3},
+    {{'2', '3', '6', '.'}, 3}, {{'2', '3', '7', '.'}, 3}, {{'2', '3', '8', '.'}, 3},
+    {{'2', '3', '9', '.'}, 3}, {{'2', '4', '0', '.'}, 3}, {{'2', '4', '1', '.'}, 3},
+    {{'2', '4', '2', '.'}, 3}, {{'2', '4', '3', '.'}, 3}, {{'2', '4', '4', '.'}, 3},
+    {{'2', '4', '5', '.'}, 3}, {{'2', '4', '6', '.'}, 3}, {{'2', '4', '7', '.'}, 3},
+    {{'2', '4', '8', '.'}, 3}, {{'2', '4', '9', '.'}, 3}, {{'2', '5', '0', '.'}, 3},
+    {{'2', '5', '1', '.'}, 3}, {{'2', '5', '2', '.'}, 3}, {{'2', '5', '3', '.'}, 3},
+    {{'2', '5', '4', '.'}, 3}, {{'2', '5', '5', '.'}, 3},
+};
+
+/**
+ * \brief Get the number of decimal digits of an unsigned integer
+ *
+ * The number is estimated from the position of the most significant bit and corrected by
+ * a single comparison.
+ * \param[in] value Value
+ * \return Number of digits (1 - 20)
+ */
+static inline unsigned int
+fmt_digits(uint64_t value)
+{
+    const unsigned int bits = 64U - static_cast<unsigned int>(__builtin_clzll(value | 1U));
+    const unsigned int approx = (bits * 1233U) >> 12;
+    return approx + 1U - (value < FMT_POW10[approx]);
+}
+
+/**
+ * \brief Format an unsigned integer
+ *
+ * The length is known in advance, so digits are written (two at a time) directly to their
+ * final positions.
+ * \param[in] pos   Output position (at least #FMT_LEN_UINT bytes)
+ * \param[in] value Value
+ * \return Position after the formatted value
+ */
+static inline char *
+fmt_uint(char *pos, uint64_t value)
+{
+    char *end = pos + fmt_digits(value);
+    char *ptr = end;
+
+    while (value >= 100) {
+        const unsigned int idx = static_cast<unsigned int>(value % 100) * 2;
+        value /= 100;
+        *--ptr = FMT_DIGIT_PAIRS[idx + 1];
+        *--ptr = FMT_DIGIT_PAIRS[idx];
+    }
+
+    if (value >= 10) {
+        const unsigned int idx = static_cast<unsigned int>(value) * 2;
+        *--ptr = FMT_DIGIT_PAIRS[idx + 1];
+        *--ptr = FMT_DIGIT_PAIRS[idx];
+    } else {
+        *--ptr = static_cast<char>('0' + value);
+    }
+
+    return end;
+}
+
+/**
+ * \brief Format a signed integer
+ * \param[in] pos   Output position (at least #FMT_LEN_INT bytes)
+ * \param[in] value Value
+ * \return Position after the formatted value
+ */
+static inline char *
+fmt_int(char *pos, int64_t value)
+{
+    if (value >= 0) {
+        return fmt_uint(pos, static_cast<uint64_t>(value));
+    }
+
+    *pos++ = '-';
+    return fmt_uint(pos, ~static_cast<uint64_t>(value) + 1U);
+}
+
+/**
+ * \brief Format a number with a fixed number of digits (with leading zeros)
+ * \param[in] pos    Output position
+ * \param[in] value  Value
+ * \param[in] digits Number of digits
+ * \return Position after the formatted value
+ */
+static inline char *
+fmt_fixed(char *pos, unsigned int value, unsigned int digits)
+{
+    for (unsigned int i = digits; i > 0; --i) {
+        pos[i - 1] = static_cast<char>('0' + (value % 10));
+        value /= 10;
+    }
+    return pos + digits;
+}
+
+/**
+ * \brief Format an IPv4 address in dotted-decimal notation
+ *
+ * Each octet is copied from a table as 4 bytes (i.e. digits and the dot) at once, therefore,
+ * up to 3 bytes after the text can be overwritten.
+ * \param[in] pos  Output position (at least #FMT_LEN_IPV4 bytes)
+ * \param[in] addr Address (4 bytes in network byte order)
+ * \return Position after the formatted value
+ */
+static inline char *
+fmt_ipv4(char *pos, const uint8_t *addr)
+{
+    for (unsigned int i = 0; i < 3; ++i) {
+        const struct fmt_octet &octet = FMT_OCTETS[addr[i]];
+        memcpy(pos, octet.text, sizeof(octet.text));
+        pos += octet.len + 1U;
+    }
+
+    const struct fmt_octet &octet = FMT_OCTETS[addr[3]];
+    memcpy(pos, octet.text, sizeof(octet.text));
+    return pos + octet.len;
+}
+
+/**
+ * \brief Format a 16-bit group of an IPv6 address (lowercase, without leading zeros)
+ * \param[in] pos   Output position
+ * \param[in] value Group
+ * \return Position after the formatted value
+ */
+static inline char *
+fmt_ipv6_group(char *pos, unsigned int value)
+{
+    static const char digits[] = "0123456789abcdef";
+    const unsigned int cnt = (value >= 0x1000U) + (value >= 0x100U) + (value >= 0x10U) + 1U;
+
+    switch (cnt) {
+    case 4: *pos++ = digits[(value >> 12) & 0xFU]; // fall through
+    case 3: *pos++ = digits[(value >> 8) & 0xFU];  // fall through
+    case 2: *pos++ = digits[(value >> 4) & 0xFU];  // fall through
+    default: *pos++ = digits[value & 0xFU];
+    }
+    return pos;
+}
+
+/**
+ * \brief Format an IPv6 address
+ *
+ * The output is the same as the output of inet_ntop() of the GNU C Library, i.e. the longest
+ * run of at least two zero groups is compressed (RFC 5952) and IPv4-compatible and
+ * IPv4-mapped addresses end with an IPv4 address in dotted-decimal notation.
+ * \param[in] pos  Output position (at least #FMT_LEN_IPV6 bytes)
+ * \param[in] addr Address (16 bytes in network byte order)
+ * \return Position after the formatted value
+ */
+static inline char *
+fmt_ipv6(char *pos, const uint8_t *addr)
+{
+    unsigned int groups[8];
+    int best_base = -1;
+    int best_len = 0;
+    int cur_base = -1;
+    int cur_len = 0;
+
+    // Find the longest run of zero groups (the first one wins)
+    for (int i = 0; i < 8; ++i) {
+        groups[i] = (static_cast<unsigned int>(addr[2 * i]) << 8) | addr[2 * i + 1];
+        if (groups[i] == 0) {
+            if (cur_base == -1) {
+                cur_base = i;
+                cur_len = 0;
+            }
+            ++cur_len;
+            continue;
+        }
+
+        if (cur_base != -1 && cur_len > best_len) {
+            best_base = cur_base;
+            best_len = cur_len;
+        }
+        cur_base = -1;
+    }
+
+    if (cur_base != -1 && cur_len > best_len) {
+        best_base = cur_base;
+        best_len = cur_len;
+    }
+    if (best_len < 2) {
+        best_base = -1;
+    }
+
+    for (int i = 0; i < 8; ++i) {
+        if (best_base != -1 && i >= best_base && i < best_base + best_len) {
+            if (i == best_base) {
+                *pos++ = ':';
+            }
+            continue;
+        }
+
+        if (i != 0) {
+            *pos++ = ':';
+        }
+
+        // IPv4-compatible or IPv4-mapped address
+        if (i == 6 && best_base == 0
+                && (best_len == 6 || (best_len == 5 && groups[5] == 0xFFFFU))) {
+            return fmt_ipv4(pos, addr + 12);
+        }
+
+        pos = fmt_ipv6_group(pos, groups[i]);
+    }
+
+    if (best_base != -1 && best_base + best_len == 8) {
+        *pos++ = ':';
+    }
+    return pos;
+}
+
+/**
+ * \brief Formatter of timestamps in ISO 8601 format (e.g. "2018-01-22T09:29:57.828Z")
+ *
+ * Timestamps of records of the same message are usually very close to each other. Therefore,
+ * the formatted date and time (up to seconds) of the last timestamp is cached and only
+ * milliseconds are formatted if the next timestamp is within the same second. If only the
+ * time of day is different, the date is reused too.
+ */
+class TimeFormatter {
+public:
+    /**
+     * \brief Format a timestamp
+     * \note The value MUST NOT be greater than #FMT_TIME_SEC_MAX seconds.
+     * \param[in] pos   Output position (at least #FMT_LEN_TIME bytes)
+     * \param[in] value Milliseconds since UNIX epoch
+     * \return Position after the formatted value
+     */
+    char *
+    format(char *pos, uint64_t value)
+    {
+        const uint64_t secs = value / 1000;
+        if (secs != m_secs) {
+            prefix_update(secs);
+        }
+
+        memcpy(pos, m_prefix, PREFIX_LEN);
+        pos += PREFIX_LEN;
+        *pos++ = '.';
+        pos = fmt_fixed(pos, static_cast<unsigned int>(value % 1000), 3);
+        *pos++ = 'Z';
+        return pos;
+    }
+
+private:
+    /** Length of the cached prefix (i.e. "YYYY-MM-DDTHH:MM:SS")                              */
+    static constexpr size_t PREFIX_LEN = 19;
+
+    /** Seconds since UNIX epoch of the cached prefix                                         */
+    uint64_t m_secs = UINT64_MAX;
+    /** Days since UNIX epoch of the cached date                                              */
+    uint64_t m_days = UINT64_MAX;
+    /** Cached prefix                                                                         */
+    char m_prefix[PREFIX_LEN];
+
+    /**
+     * \brief Update the cached prefix
+     * \param[in] secs Seconds since UNIX epoch
+     */
+    void
+    prefix_update(uint64_t secs)
+    {
+        const uint64_t days = secs / 86400;
+        const unsigned int day_secs = static_cast<unsigned int>(secs % 86400);
+
+        if (days != m_days) {
+            // Conversion of days since epoch to a civil date (proleptic Gregorian calendar)
+            const int64_t shifted = static_cast<int64_t>(days) + 719468;
+            const int64_t era = shifted / 146097;
+            const unsigned int doe = static_cast<unsigned int>(shifted - era * 146097);
+            const unsigned int yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+            const unsigned int doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+            const unsigned int mp = (5 * doy + 2) / 153;
+            const unsigned int day = doy - (153 * mp + 2) / 5 + 1;
+            const unsigned int month = (mp < 10) ? mp + 3 : mp - 9;
+            const unsigned int year = static_cast<unsigned int>(yoe + era * 400) + (month <= 2);
+
+            char *pos = m_prefix;
+            pos = fmt_fixed(pos, year, 4);
+            *pos++ = '-';
+            pos = fmt_fixed(pos, month, 2);
+            *pos++ = '-';
+            pos = fmt_fixed(pos, day, 2);
+            *pos++ = 'T';
+            m_days = days;
+        }
+
+        char *pos = m_prefix + 11;
+        pos = fmt_fixed(pos, day_secs / 3600, 2);
+        *pos++ = ':';
+        pos = fmt_fixed(pos, (day_secs / 60) % 60, 2);
+        *pos++ = ':';
+        fmt_fixed(pos, day_secs % 60, 2);
+        m_secs = secs;
+    }
+};
+
+#endif // JSON_FORMAT_H
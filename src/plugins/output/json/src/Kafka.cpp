@@ -39,8 +39,13 @@
  *
  */
 
-#include "Config.hpp"
+#include "Options.hpp"
 #include "Kafka.hpp"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <endian.h>
+#include <new>
 #include <pthread.h>
 #include <stdexcept>
 
@@ -51,10 +56,14 @@
 
 /**
  * \brief Class constructor
- * \param[in] cfg Kafka configuration
- * \param[in] ctx Instance context
+ *
+ * If the configuration defines multiple producer shards, the producer sends messages only
+ * to the partitions of the given shard (see shard_partitioner()).
+ * \param[in] cfg   Kafka configuration
+ * \param[in] ctx   Instance context
+ * \param[in] shard Index of the producer shard
  */
-Kafka::Kafka(const struct cfg_kafka &cfg, ipx_ctx_t *ctx)
+Kafka::Kafka(const struct cfg_kafka &cfg, ipx_ctx_t *ctx, uint32_t shard)
     : Output(cfg.name, ctx), m_partition(cfg.partition)
 {
     IPX_CTX_DEBUG(_ctx, "Initialization of Kafka connector in progress...", '\0');
@@ -67,11 +76,15 @@ Kafka::Kafka(const struct cfg_kafka &cfg, ipx_ctx_t *ctx)
     clock_gettime(CLOCK_MONOTONIC, &m_err_ts);
     m_thread.reset(new thread_ctx_t);
 
-    m_produce_flags = RD_KAFKA_MSG_F_COPY;
+    m_produce_flags = 0;
     if (cfg.blocking) {
         m_produce_flags |= RD_KAFKA_MSG_F_BLOCK;
     }
 
+    m_pack_size = cfg.pack_size;
+    m_pack_timeout = cfg.pack_timeout;
+    m_pack_ts = m_err_ts;
+
     // Prepare Kafka configuration object
     kafka_cfg.reset(rd_kafka_conf_new());
     if (!kafka_cfg) {
@@ -84,7 +97,9 @@ Kafka::Kafka(const struct cfg_kafka &cfg, ipx_ctx_t *ctx)
         rd_kafka_conf_res_t res;
         const char *p_name = param.first.c_str();
         const char *p_value = param.second.c_str();
-        IPX_CTX_INFO(ctx, "Setting Kafka parameter: '%s'='%s'", p_name, p_value);
+        if (shard == 0) {
+            IPX_CTX_INFO(ctx, "Setting Kafka parameter: '%s'='%s'", p_name, p_value);
+        }
 
         res = rd_kafka_conf_set(kafka_cfg.get(), p_name, p_value, err_str, err_size);
         if (res != RD_KAFKA_CONF_OK) {
@@ -107,11 +122,27 @@ Kafka::Kafka(const struct cfg_kafka &cfg, ipx_ctx_t *ctx)
     }
     kafka_cfg.release(); // Ownership has been successfully passed to the kafka
 
-    // Create the topic
-    m_topic.reset(rd_kafka_topic_new(m_kafka.get(), cfg.topic.c_str(), nullptr));
+    // Create the topic (each shard uses only its subset of partitions)
+    rd_kafka_topic_conf_t *topic_cfg = nullptr;
+    m_shard.idx = shard;
+    m_shard.cnt = cfg.shards;
+    m_shard.next = 0;
+    if (cfg.shards > 1) {
+        topic_cfg = rd_kafka_topic_conf_new();
+        if (!topic_cfg) {
+            throw std::runtime_error("rd_kafka_topic_conf_new() failed!");
+        }
+        rd_kafka_topic_conf_set_partitioner_cb(topic_cfg, shard_partitioner);
+        rd_kafka_topic_conf_set_opaque(topic_cfg, &m_shard);
+    }
+
+    m_topic.reset(rd_kafka_topic_new(m_kafka.get(), cfg.topic.c_str(), topic_cfg));
     if (!m_topic) {
         rd_kafka_resp_err_t err_code = rd_kafka_last_error();
         const char *err_msg = rd_kafka_err2str(err_code);
+        if (topic_cfg) {
+            rd_kafka_topic_conf_destroy(topic_cfg);
+        }
         throw std::runtime_error("rd_kafka_topic_new() failed: " + std::string(err_msg));
     }
 
@@ -119,6 +150,13 @@ Kafka::Kafka(const struct cfg_kafka &cfg, ipx_ctx_t *ctx)
     m_thread->stop = false;
     m_thread->ctx = ctx;
     m_thread->kafka = m_kafka.get();
+    // Runtime metrics are optional (i.e. NULL on failure) and shared by all Kafka outputs
+    m_thread->m_queue = ipx_ctx_metric_register(ctx, IPX_METRIC_GAUGE, "kafka_queue_messages",
+        "Number of messages waiting in the producer queue (incl. unacknowledged ones)");
+    m_thread->m_delivered = ipx_ctx_metric_register(ctx, IPX_METRIC_COUNTER,
+        "kafka_delivered_messages_total", "Number of successfully delivered messages");
+    m_thread->m_failed = ipx_ctx_metric_register(ctx, IPX_METRIC_COUNTER,
+        "kafka_failed_messages_total", "Number of messages that failed to be delivered");
     if (pthread_create(&m_thread->thread, nullptr, &thread_polling, m_thread.get()) != 0) {
         throw std::runtime_error("Failed to start polling thread for Kafka events");
     }
@@ -131,6 +169,9 @@ Kafka::~Kafka()
 {
     IPX_CTX_DEBUG(_ctx, "Destruction of Kafka connector in progress...", '\0');
 
+    // Produce the rest of records
+    pack_produce();
+
     // Stop poller thread
     m_thread->stop = true;
     int rc = pthread_join(m_thread->thread, nullptr);
@@ -154,6 +195,9 @@ Kafka::~Kafka()
 
 /**
  * \brief Send a JSON record
+ *
+ * If packing is enabled, the record is added to the pack. Otherwise, the record is copied
+ * by the producer and sent as a separate message.
  * \param[in] str JSON Record to send
  * \param[in] len Size of the record
  * \return Always #IPX_OK
@@ -161,16 +205,168 @@ Kafka::~Kafka()
 int
 Kafka::process(const char *str, size_t len)
 {
-    int rc = rd_kafka_produce(m_topic.get(), m_partition, m_produce_flags,
+    if (m_pack_size != 0) {
+        pack_append(str, len);
+        return IPX_OK;
+    }
+
+    // Payload and length (without tailing new-line character)
+    produce(const_cast<char *>(str), len - 1, nullptr, m_produce_flags | RD_KAFKA_MSG_F_COPY,
+        nullptr);
+    return IPX_OK;
+}
+
+/**
+ * \brief Send a batch of JSON records
+ *
+ * If packing is enabled, records are added to the pack. Otherwise, each record is a separate
+ * Kafka message. The batch is copied only once into a shared buffer that is referenced by
+ * all messages (i.e. the producer doesn't copy the records) and released after delivery
+ * of the last message. All records are enqueued by a single call of the producer. In blocking
+ * mode, records are enqueued one by one as the batch producer doesn't support blocking.
+ * If the batch contains partition keys, they are used as keys of messages (the producer copies
+ * them).
+ * \param[in] batch Batch of JSON records
+ * \return Always #IPX_OK
+ */
+int
+Kafka::process_batch(const struct Batch &batch)
+{
+    if (m_pack_size != 0) {
+        size_t start = 0;
+        for (size_t i = 0; i < batch.cnt; ++i) {
+            pack_append(batch.data + start, batch.ends[i] - start);
+            start = batch.ends[i];
+        }
+        return IPX_OK;
+    }
+
+    // One extra reference is held until all messages are enqueued
+    shared_buf *buf = buf_create(batch.data, batch.len, batch.cnt + 1);
+
+    if ((m_produce_flags & RD_KAFKA_MSG_F_BLOCK) != 0) {
+        size_t start = 0;
+        for (size_t i = 0; i < batch.cnt; ++i) {
+            // Payload and length (without tailing new-line character)
+            const uint64_t *key = (batch.keys != nullptr) ? &batch.keys[i] : nullptr;
+            if (!produce(buf->data() + start, batch.ends[i] - start - 1, key, m_produce_flags,
+                    buf)) {
+                buf_release(buf);
+            }
+            start = batch.ends[i];
+        }
+
+        buf_release(buf);
+        return IPX_OK;
+    }
+
+    m_batch_msgs.resize(batch.cnt);
+    size_t start = 0;
+    for (size_t i = 0; i < batch.cnt; ++i) {
+        rd_kafka_message_t &msg = m_batch_msgs[i];
+        memset(&msg, 0, sizeof(msg));
         // Payload and length (without tailing new-line character)
-        reinterpret_cast<void *>(const_cast<char *>(str)), len - 1,
-        NULL, 0,  // Optional key and its length
-        NULL);    // Message opaque
-    if (rc == 0 && m_err_cnt == 0) {
+        msg.payload = buf->data() + start;
+        msg.len = batch.ends[i] - start - 1;
+        msg._private = buf;
+        if (batch.keys != nullptr) {
+            msg.key = const_cast<uint64_t *>(&batch.keys[i]);
+            msg.key_len = sizeof(batch.keys[i]);
+        }
+        start = batch.ends[i];
+    }
+
+    const int cnt = static_cast<int>(batch.cnt);
+    int rc = rd_kafka_produce_batch(m_topic.get(), m_partition, m_produce_flags,
+        m_batch_msgs.data(), cnt);
+    if (rc == cnt && m_err_cnt == 0) {
         // No error and previous errors
+        buf_release(buf);
         return IPX_OK;
     }
 
+    // The following code aggregates produce() errors
+    struct timespec ts_now;
+    clock_gettime(CLOCK_MONOTONIC, &ts_now);
+
+    if (rc != cnt) {
+        for (const rd_kafka_message_t &msg : m_batch_msgs) {
+            if (msg.err == RD_KAFKA_RESP_ERR_NO_ERROR) {
+                continue;
+            }
+
+            // The message has not been enqueued
+            buf_release(buf);
+
+            if (msg.err != m_err_type) {
+                // Different error then previously - print the previous one now
+                produce_error(ts_now);
+                m_err_type = msg.err;
+            }
+
+            m_err_cnt++;
+        }
+    }
+
+    buf_release(buf);
+
+    if (difftime(ts_now.tv_sec, m_err_ts.tv_sec) >= 1.0) {
+        produce_error(ts_now);
+    }
+
+    return IPX_OK;
+}
+
+/**
+ * \brief Produce the pack of records if it is waiting for too long
+ *
+ * If the timeout of packs is zero, the pack is always produced.
+ */
+void
+Kafka::flush()
+{
+    if (m_pack_used == 0) {
+        return;
+    }
+
+    if (m_pack_timeout != 0) {
+        struct timespec ts_now;
+        clock_gettime(CLOCK_MONOTONIC, &ts_now);
+
+        const int64_t age = (ts_now.tv_sec - m_pack_ts.tv_sec) * INT64_C(1000)
+            + (ts_now.tv_nsec - m_pack_ts.tv_nsec) / 1000000;
+        if (age < static_cast<int64_t>(m_pack_timeout)) {
+            return;
+        }
+    }
+
+    pack_produce();
+}
+
+/**
+ * \brief Produce a message
+ *
+ * Errors of the producer are aggregated and regularly printed.
+ * \param[in] payload Payload of the message
+ * \param[in] len     Length of the payload
+ * \param[in] key     Key of the message (can be nullptr)
+ * \param[in] flags   Producer flags
+ * \param[in] opaque  Message opaque (shared buffer of the payload or nullptr)
+ * \return True if the message has been enqueued
+ */
+bool
+Kafka::produce(void *payload, size_t len, const uint64_t *key, int flags, void *opaque)
+{
+    const size_t key_len = (key != nullptr) ? sizeof(*key) : 0;
+    int rc = rd_kafka_produce(m_topic.get(), m_partition, flags,
+        payload, len, // Payload and length
+        key, key_len, // Optional key and its length
+        opaque);      // Message opaque
+    if (rc == 0 && m_err_cnt == 0) {
+        // No error and previous errors
+        return true;
+    }
+
     // Get the error (it probably uses errno so it should go first)
     rd_kafka_resp_err_t err_code = rd_kafka_last_error();
 
@@ -193,7 +389,111 @@ Kafka::process(const char *str, size_t len)
         produce_error(ts_now);
     }
 
-    return IPX_OK;
+    return rc == 0;
+}
+
+/**
+ * \brief Add a record to the pack of records
+ *
+ * Records in the pack are separated by new-line characters. If the size of the pack reaches
+ * its limit, the pack is produced as a single Kafka message.
+ * \param[in] str JSON record (including tailing new-line character)
+ * \param[in] len Size of the record
+ * \throw bad_alloc if a memory allocation failed
+ */
+void
+Kafka::pack_append(const char *str, size_t len)
+{
+    if (m_pack_used > 0 && m_pack_used + len > m_pack_size) {
+        pack_produce();
+    }
+
+    if (m_pack_used == 0) {
+        clock_gettime(CLOCK_MONOTONIC, &m_pack_ts);
+    }
+
+    if (m_pack_used + len > m_pack_alloc) {
+        const size_t new_alloc = std::max(m_pack_size, m_pack_used + len);
+        char *new_pack = static_cast<char *>(realloc(m_pack, new_alloc));
+        if (!new_pack) {
+            throw std::bad_alloc();
+        }
+
+        m_pack = new_pack;
+        m_pack_alloc = new_alloc;
+    }
+
+    memcpy(m_pack + m_pack_used, str, len);
+    m_pack_used += len;
+
+    if (m_pack_used >= m_pack_size) {
+        pack_produce();
+    }
+}
+
+/**
+ * \brief Produce the pack of records as a single Kafka message
+ *
+ * The ownership of the pack is passed to the producer (i.e. it's not copied) and the pack
+ * is freed by the producer after delivery.
+ */
+void
+Kafka::pack_produce()
+{
+    if (m_pack_used == 0) {
+        return;
+    }
+
+    // Payload and length (without tailing new-line character)
+    const int flags = m_produce_flags | RD_KAFKA_MSG_F_FREE;
+    if (!produce(m_pack, m_pack_used - 1, nullptr, flags, nullptr)) {
+        // The producer took no ownership
+        free(m_pack);
+    }
+
+    m_pack = nullptr;
+    m_pack_used = 0;
+    m_pack_alloc = 0;
+}
+
+/**
+ * \brief Create a shared copy of records
+ * \param[in] data Records
+ * \param[in] len  Size of the records
+ * \param[in] refs Initial number of references
+ * \return Pointer to the copy
+ * \throw bad_alloc if a memory allocation failed
+ */
+Kafka::shared_buf *
+Kafka::buf_create(const char *data, size_t len, size_t refs)
+{
+    void *mem = malloc(sizeof(shared_buf) + len);
+    if (!mem) {
+        throw std::bad_alloc();
+    }
+
+    shared_buf *buf = new (mem) shared_buf;
+    buf->refs = refs;
+    memcpy(buf->data(), data, len);
+    return buf;
+}
+
+/**
+ * \brief Remove a reference to a shared copy of records
+ *
+ * The copy is freed after the last reference is removed.
+ * \note The function can be called by multiple threads concurrently.
+ * \param[in] buf Shared copy
+ */
+void
+Kafka::buf_release(shared_buf *buf)
+{
+    if (buf->refs.fetch_sub(1) != 1) {
+        return;
+    }
+
+    buf->~shared_buf();
+    free(buf);
 }
 
 /**
@@ -299,6 +599,9 @@ Kafka::thread_polling(void *context)
 
     while (!data->stop) {
         rd_kafka_poll(data->kafka, POLLER_TIMEOUT);
+        if (data->m_queue) {
+            ipx_metric_set(data->m_queue, (uint64_t) rd_kafka_outq_len(data->kafka));
+        }
 
         // Print statistics
         struct timespec ts_now;
@@ -318,6 +621,48 @@ Kafka::thread_polling(void *context)
     return nullptr;
 }
 
+/**
+ * @brief Partitioner of a producer shard
+ *
+ * The shard owns partitions whose index modulo the number of shards is equal to the index
+ * of the shard. A message with a key (i.e. a partition key of the record) is always sent to
+ * the same partition of the subset. As the key also selects the shard (the key modulo the number
+ * of shards), the rest of the key (i.e. the key divided by the number of shards) is used.
+ * Messages without a key are distributed round-robin among the partitions of the subset.
+ * If the topic has less partitions than shards, shards share partitions.
+ * @param[in] rkt           Topic
+ * @param[in] keydata       Key of the message (partition key in network byte order)
+ * @param[in] keylen        Length of the key
+ * @param[in] partition_cnt Number of partitions of the topic
+ * @param[in] rkt_opaque    Subset of partitions of the shard
+ * @param[in] msg_opaque    Message opaque (unused)
+ * @return Partition
+ */
+int32_t
+Kafka::shard_partitioner(const rd_kafka_topic_t *rkt, const void *keydata, size_t keylen,
+    int32_t partition_cnt, void *rkt_opaque, void *msg_opaque)
+{
+    (void) rkt;
+    (void) msg_opaque;
+    auto *shard = reinterpret_cast<shard_info *>(rkt_opaque);
+
+    uint64_t value;
+    if (keylen == sizeof(value)) {
+        memcpy(&value, keydata, sizeof(value));
+        value = be64toh(value) / shard->cnt;
+    } else {
+        // Only the thread of the shard produces messages
+        value = shard->next++;
+    }
+
+    const uint32_t total = static_cast<uint32_t>(partition_cnt);
+    const uint32_t subset = (total + shard->cnt - 1 - shard->idx) / shard->cnt;
+    if (subset == 0) {
+        return static_cast<int32_t>(value % total);
+    }
+    return static_cast<int32_t>(shard->idx + shard->cnt * (value % subset));
+}
+
 /**
  * @brief Message delivery callback for Kafka messages
  *
@@ -334,7 +679,18 @@ Kafka::thread_cb_delivery(rd_kafka_t *rk, const rd_kafka_message_t *rkmessage, v
     if (rkmessage->err) {
         IPX_CTX_WARNING(data->ctx, "Message delivery failed: %s", rd_kafka_err2str(rkmessage->err));
         data->cnt_failed++;
+        if (data->m_failed) {
+            ipx_metric_add(data->m_failed, 1);
+        }
     } else {
         data->cnt_delivered++;
+        if (data->m_delivered) {
+            ipx_metric_add(data->m_delivered, 1);
+        }
+    }
+
+    if (rkmessage->_private) {
+        // The record is not needed anymore
+        buf_release(reinterpret_cast<shared_buf *>(rkmessage->_private));
     }
 }
\ No newline at end of file
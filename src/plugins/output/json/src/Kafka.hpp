@@ -47,18 +47,23 @@
 #include <atomic>
 #include <ctime>
 #include <memory>
+#include <vector>
 #include <librdkafka/rdkafka.h>
 
 /** JSON kafka connector */
 class Kafka : public Output {
 public:
     // Constructor
-    Kafka(const struct cfg_kafka &cfg, ipx_ctx_t *ctx);
+    Kafka(const struct cfg_kafka &cfg, ipx_ctx_t *ctx, uint32_t shard = 0);
     // Destructor
     ~Kafka();
 
     // Processing records
     int process(const char *str, size_t len);
+    // Processing batches of records
+    int process_batch(const struct Batch &batch);
+    // Produce a pack of records waiting for too long
+    void flush();
 
 private:
     using uniq_kafka = std::unique_ptr<rd_kafka_t, decltype(&rd_kafka_destroy)>;
@@ -73,6 +78,14 @@ private:
     /// Information about librdkafka version used during build of this plugin
     static const int BUILD_VERSION = RD_KAFKA_VERSION;
 
+    /// Shared copy of records referenced by Kafka messages (released after the last delivery)
+    struct shared_buf {
+        /// Number of references (i.e. undelivered messages)
+        std::atomic<size_t> refs;
+        /// Records (stored right after the structure)
+        char *data() { return reinterpret_cast<char *>(this + 1); }
+    };
+
     /// Polling thread for Kafka events
     typedef struct thread_ctx_s {
         ipx_ctx_t *ctx;         ///< Plugin context (for log only!)
@@ -82,10 +95,23 @@ private:
 
         uint64_t cnt_delivered; ///< Number of successful deliveries
         uint64_t cnt_failed;    ///< Number of failed deliveries
+
+        struct ipx_metric *m_queue;     ///< Runtime metric: messages in the producer queue
+        struct ipx_metric *m_delivered; ///< Runtime metric: successful deliveries
+        struct ipx_metric *m_failed;    ///< Runtime metric: failed deliveries
     } thread_ctx_t;
 
+    /// Subset of partitions of a producer shard (see KafkaShards)
+    struct shard_info {
+        uint32_t idx;  ///< Index of the shard
+        uint32_t cnt;  ///< Number of shards
+        uint64_t next; ///< Counter for distribution of messages without a key
+    };
+
     /// Configuration
     map_params m_params;
+    /// Partitions of the shard (used only if there are multiple shards)
+    shard_info m_shard;
     /// Kafka object
     uniq_kafka m_kafka = {nullptr, &rd_kafka_destroy};
     /// Topic object
@@ -103,6 +129,21 @@ private:
     rd_kafka_resp_err_t m_err_type = RD_KAFKA_RESP_ERR_NO_ERROR;
     /// Number of produce errors of the given type since the last print
     uint64_t m_err_cnt = 0;
+    /// Messages of a batch to produce
+    std::vector<rd_kafka_message_t> m_batch_msgs;
+
+    /// Maximum size of a pack of records (0 = packing is disabled)
+    size_t m_pack_size;
+    /// Maximum time for which a pack can wait to be produced (milliseconds)
+    uint32_t m_pack_timeout;
+    /// Pack of records (allocated by malloc(), the ownership is passed to the producer)
+    char *m_pack = nullptr;
+    /// Used size of the pack
+    size_t m_pack_used = 0;
+    /// Allocated size of the pack
+    size_t m_pack_alloc = 0;
+    /// Time of the oldest record in the pack
+    struct timespec m_pack_ts;
 
     // Prepare parameters for Kafka
     void
@@ -110,9 +151,28 @@ private:
     /// Print aggregation of produce errors
     void
     produce_error(struct timespec ts_now);
+    // Produce a message
+    bool
+    produce(void *payload, size_t len, const uint64_t *key, int flags, void *opaque);
+    // Add a record to the pack of records
+    void
+    pack_append(const char *str, size_t len);
+    // Produce the pack of records
+    void
+    pack_produce();
+    // Create a shared copy of records
+    static shared_buf *
+    buf_create(const char *data, size_t len, size_t refs);
+    // Remove a reference to a shared copy of records
+    static void
+    buf_release(shared_buf *buf);
     // Pooling thread function
     static void *
     thread_polling(void *context);
+    // Partitioner of a producer shard
+    static int32_t
+    shard_partitioner(const rd_kafka_topic_t *rkt, const void *keydata, size_t keylen,
+        int32_t partition_cnt, void *rkt_opaque, void *msg_opaque);
     // Kafka messagage delivery callback
     static void
     thread_cb_delivery(rd_kafka_t *rk, const rd_kafka_message_t *rkmessage, void *opaque);
@@ -0,0 +1,287 @@
+/**
+ * \file src/plugins/output/json/src/KafkaShards.cpp
+ * \author agent <agent@local>
+ * \brief Kafka output with multiple producer shards (source file)
+ * \date 2026
+ */
+
+/* Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is'', and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#include "KafkaShards.hpp"
+
+#include <endian.h>
+#include <stdexcept>
+
+/**
+ * \brief Class constructor
+ *
+ * Producers of all shards are created and threads of the shards are started.
+ * \param[in] cfg Kafka configuration
+ * \param[in] ctx Instance context
+ * \throw runtime_error if a producer cannot be created
+ */
+KafkaShards::KafkaShards(const struct cfg_kafka &cfg, ipx_ctx_t *ctx) : Output(cfg.name, ctx)
+{
+    for (uint32_t i = 0; i < cfg.shards; ++i) {
+        std::unique_ptr<Shard> shard(new Shard);
+        shard->kafka.reset(new Kafka(cfg, ctx, i));
+        m_shards.push_back(std::move(shard));
+    }
+
+    try {
+        for (auto &shard : m_shards) {
+            shard->thread = std::thread(&KafkaShards::shard_main, shard.get());
+        }
+    } catch (...) {
+        shards_stop();
+        throw;
+    }
+
+    IPX_CTX_INFO(_ctx, "Kafka output '%s' uses %u producer shards.", _name.c_str(),
+        unsigned(cfg.shards));
+}
+
+/**
+ * \brief Destructor
+ *
+ * Waiting records are produced and all producers are destroyed (i.e. they wait for outstanding
+ * messages).
+ */
+KafkaShards::~KafkaShards()
+{
+    for (auto &shard : m_shards) {
+        try {
+            part_submit(*shard, true);
+        } catch (std::exception &ex) {
+            IPX_CTX_ERROR(_ctx, "%s", ex.what());
+        }
+    }
+
+    shards_stop();
+}
+
+int
+KafkaShards::process(const char *str, size_t len)
+{
+    const size_t end = len;
+    const struct Batch batch = {str, len, &end, 1, nullptr};
+    return process_batch(batch);
+}
+
+/**
+ * \brief Pass records of a batch to the shards
+ *
+ * Records with a partition key are passed to the shard selected by the key (the key modulo
+ * the number of shards). Batches without keys are passed to shards round-robin. The function
+ * waits if the selected shards are not able to process the records fast enough.
+ * \param[in] batch Batch of JSON records
+ * \return Always #IPX_OK
+ * \throw runtime_error or bad_alloc if a shard has failed
+ */
+int
+KafkaShards::process_batch(const struct Batch &batch)
+{
+    if (batch.keys == nullptr) {
+        Shard &shard = *m_shards[m_next];
+        m_next = (m_next + 1) % m_shards.size();
+
+        Part &part = part_current(shard);
+        const size_t offset = part.data.size();
+        part.data.append(batch.data, batch.len);
+        for (size_t i = 0; i < batch.cnt; ++i) {
+            part.ends.push_back(batch.ends[i] + offset);
+        }
+        part_submit(shard, false);
+        return IPX_OK;
+    }
+
+    size_t start = 0;
+    for (size_t i = 0; i < batch.cnt; ++i) {
+        const size_t idx = be64toh(batch.keys[i]) % m_shards.size();
+        Part &part = part_current(*m_shards[idx]);
+        part.data.append(batch.data + start, batch.ends[i] - start);
+        part.ends.push_back(part.data.size());
+        part.keys.push_back(batch.keys[i]);
+        start = batch.ends[i];
+    }
+
+    for (auto &shard : m_shards) {
+        if (shard->current) {
+            part_submit(*shard, false);
+        }
+    }
+
+    return IPX_OK;
+}
+
+/**
+ * \brief Flush producers of shards that received records since the last flush
+ */
+void
+KafkaShards::flush()
+{
+    for (auto &shard : m_shards) {
+        if (shard->unflushed) {
+            part_submit(*shard, true);
+        }
+    }
+}
+
+/**
+ * \brief Get the part being filled of a shard (an unused part is prepared, if necessary)
+ * \param[in] shard Shard
+ * \return Part
+ */
+KafkaShards::Part &
+KafkaShards::part_current(Shard &shard)
+{
+    if (shard.current) {
+        return *shard.current;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        if (!shard.unused.empty()) {
+            shard.current = std::move(shard.unused.back());
+            shard.unused.pop_back();
+        }
+    }
+    if (!shard.current) {
+        shard.current.reset(new Part);
+    }
+
+    shard.current->data.clear();
+    shard.current->ends.clear();
+    shard.current->keys.clear();
+    shard.current->flush = false;
+    return *shard.current;
+}
+
+/**
+ * \brief Pass the part being filled to the thread of a shard
+ *
+ * If too many parts are waiting for the shard, the function waits.
+ * \param[in] shard Shard
+ * \param[in] flush Flush the producer of the shard after the records of the part
+ * \throw runtime_error or bad_alloc if the thread of the shard has failed
+ */
+void
+KafkaShards::part_submit(Shard &shard, bool flush)
+{
+    part_current(shard).flush = flush;
+    std::unique_ptr<Part> part = std::move(shard.current);
+    shard.unflushed = !flush;
+
+    std::unique_lock<std::mutex> lock(shard.mutex);
+    shard.cv_done.wait(lock, [&shard]() {
+        return shard.queue.size() < QUEUE_MAX || shard.error;
+    });
+    if (shard.error) {
+        std::exception_ptr error = shard.error;
+        shard.error = nullptr;
+        std::rethrow_exception(error);
+    }
+
+    shard.queue.push_back(std::move(part));
+    shard.cv_work.notify_one();
+}
+
+/**
+ * \brief Main function of the thread of a shard
+ *
+ * Parts are produced in the original order. The thread terminates after all waiting parts
+ * have been produced and the stop flag is set.
+ * \param[in] shard Shard
+ */
+void
+KafkaShards::shard_main(Shard *shard)
+{
+    std::unique_lock<std::mutex> lock(shard->mutex);
+    while (true) {
+        shard->cv_work.wait(lock, [shard]() {
+            return shard->stop || !shard->queue.empty();
+        });
+        if (shard->queue.empty()) {
+            break;
+        }
+
+        std::unique_ptr<Part> part = std::move(shard->queue.front());
+        shard->queue.pop_front();
+        lock.unlock();
+
+        std::exception_ptr error;
+        try {
+            if (!part->ends.empty()) {
+                const uint64_t *keys = part->keys.empty() ? nullptr : part->keys.data();
+                const struct Batch batch = {part->data.data(), part->data.size(),
+                    part->ends.data(), part->ends.size(), keys};
+                if (shard->kafka->process_batch(batch) != IPX_OK) {
+                    throw std::runtime_error("Failed to produce records of a shard");
+                }
+            }
+            if (part->flush) {
+                shard->kafka->flush();
+            }
+        } catch (...) {
+            error = std::current_exception();
+        }
+
+        lock.lock();
+        if (error && !shard->error) {
+            shard->error = error;
+        }
+        shard->unused.push_back(std::move(part));
+        shard->cv_done.notify_one();
+    }
+}
+
+/**
+ * \brief Stop and join all threads (waiting parts are produced before)
+ */
+void
+KafkaShards::shards_stop()
+{
+    for (auto &shard : m_shards) {
+        std::lock_guard<std::mutex> lock(shard->mutex);
+        shard->stop = true;
+        shard->cv_work.notify_one();
+    }
+
+    for (auto &shard : m_shards) {
+        if (shard->thread.joinable()) {
+            shard->thread.join();
+        }
+    }
+}
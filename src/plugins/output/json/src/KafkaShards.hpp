@@ -0,0 +1,141 @@
+/**
+ * \file src/plugins/output/json/src/KafkaShards.hpp
+ * \author agent <agent@local>
+ * \brief Kafka output with multiple producer shards (header file)
+ * \date 2026
+ */
+
+/* Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is'', and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#ifndef JSON_KAFKA_SHARDS_H
+#define JSON_KAFKA_SHARDS_H
+
+#include "Kafka.hpp"
+#include "Storage.hpp"
+
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * \brief Kafka output with multiple independent producers (shards)
+ *
+ * Each shard has its own Kafka producer, thread and subset of partitions of the topic.
+ * Records with a partition key are routed to shards by the key, therefore, records with
+ * the same key are always produced by the same shard to the same partition (i.e. their
+ * order is kept). Batches of records without keys are distributed round-robin.
+ */
+class KafkaShards : public Output {
+public:
+    // Constructor
+    KafkaShards(const struct cfg_kafka &cfg, ipx_ctx_t *ctx);
+    // Destructor
+    ~KafkaShards();
+
+    // Processing records
+    int process(const char *str, size_t len);
+    // Processing batches of records
+    int process_batch(const struct Batch &batch);
+    // Flush all shards
+    void flush();
+
+private:
+    /// Maximum number of parts waiting for a shard (the plugin waits for the shard otherwise)
+    static constexpr size_t QUEUE_MAX = 4;
+
+    /// Part of batches for a shard
+    struct Part {
+        /// Records (each record ends with a new-line character)
+        std::string data;
+        /// Offsets of ends of records in the data
+        std::vector<size_t> ends;
+        /// Partition keys of records (empty, if keys are not available)
+        std::vector<uint64_t> keys;
+        /// Flush the producer after the records
+        bool flush;
+    };
+
+    /// Producer shard
+    struct Shard {
+        /// Kafka producer (used only by the thread of the shard)
+        std::unique_ptr<Kafka> kafka;
+        /// Thread of the shard
+        std::thread thread;
+        /// Part being filled by the thread of the plugin (nullptr, if none)
+        std::unique_ptr<Part> current;
+        /// Records have been added since the last flush
+        bool unflushed = false;
+
+        /// Synchronization of the thread
+        std::mutex mutex;
+        /// Notification about new parts
+        std::condition_variable cv_work;
+        /// Notification about processed parts
+        std::condition_variable cv_done;
+        /// Parts waiting to be produced (protected by the mutex)
+        std::deque<std::unique_ptr<Part>> queue;
+        /// Unused parts ready to be reused (protected by the mutex)
+        std::vector<std::unique_ptr<Part>> unused;
+        /// Failure of the thread (rethrown by the thread of the plugin)
+        std::exception_ptr error;
+        /// Stop flag of the thread (protected by the mutex)
+        bool stop = false;
+    };
+
+    /// Producer shards
+    std::vector<std::unique_ptr<Shard>> m_shards;
+    /// Shard of the next batch without keys
+    size_t m_next = 0;
+
+    // Get the part being filled of a shard
+    Part &
+    part_current(Shard &shard);
+    // Pass the part being filled to the thread of a shard
+    void
+    part_submit(Shard &shard, bool flush);
+    // Main function of the thread of a shard
+    static void
+    shard_main(Shard *shard);
+    // Stop and join all threads
+    void
+    shards_stop();
+};
+
+#endif // JSON_KAFKA_SHARDS_H
@@ -0,0 +1,162 @@
+/**
+ * \file src/plugins/output/json/src/Options.hpp
+ * \author agent <agent@local>
+ * \brief Options of the conversion engine shared by JSON plugins (header file)
+ * \date 2026
+ */
+
+/* Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is'', and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+#ifndef JSON_OPTIONS_H
+#define JSON_OPTIONS_H
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+/** Type of a partition key of records                                                          */
+enum class part_key {
+    NONE,     ///< No key
+    ODID,     ///< Observation Domain ID
+    EXPORTER, ///< IP address of the exporter
+    SRC_IP,   ///< Source IP address
+    FLOW      ///< 5-tuple (the same key for both directions of a flow)
+};
+
+/** Selection of fields of records                                                              */
+enum class field_sel {
+    ALL,      ///< All fields
+    INCLUDE,  ///< Only listed fields
+    EXCLUDE   ///< All fields except listed fields
+};
+
+/** Encoding of records                                                                          */
+enum class rec_encoding {
+    JSON,     ///< JSON (one record per line)
+    AVRO      ///< Avro binary encoding (schemas are registered in a schema registry)
+};
+
+/** Configuration of output format                                                               */
+struct cfg_format {
+    /** TCP flags format - true (formatted), false (raw)                                         */
+    bool tcp_flags;
+    /** Timestamp format - true (formatted), false (UNIX)                                        */
+    bool timestamp;
+    /** Protocol format  - true (formatted), false (raw)                                         */
+    bool proto;
+    /** Skip unknown elements                                                                    */
+    bool ignore_unknown;
+    /** Converter octetArray type as unsigned integer (only if field size <= 8)                  */
+    bool octets_as_uint;
+    /** Convert white spaces in string (do not skip)                                             */
+    bool white_spaces;
+    /** Add detailed information about each record                                               */
+    bool detailed_info;
+    /** Ignore Options Template records                                                          */
+    bool ignore_options;
+    /** Use only numeric identifiers of Information Elements                                     */
+    bool numeric_names;
+    /** Split biflow records                                                                     */
+    bool split_biflow;
+    /** Add template records                                                                     */
+    bool template_info;
+    /** Convert only records selected by the sampling plugin                                     */
+    bool sampled_only;
+    /** Add values of IP prefixes attached by the enrichment plugin                              */
+    bool enrichment;
+    /** Maximum number of records in a batch passed to outputs at once                           */
+    uint32_t batch_recs;
+    /** Maximum age of a batch (in microseconds, 0 == each message is passed immediately)        */
+    uint32_t batch_timeout;
+    /** Number of conversion threads                                                            */
+    uint32_t threads;
+    /** Type of partition keys of records (required by outputs)                                  */
+    part_key key;
+    /** Selection of fields of records                                                           */
+    field_sel fields_sel = field_sel::ALL;
+    /** Names of listed Information Elements (see #fields_sel)                                   */
+    std::vector<std::string> fields;
+    /** Encoding of records                                                                      */
+    rec_encoding encoding;
+    /** URL of the schema registry (Avro encoding only)                                          */
+    std::string schema_registry;
+};
+
+/** Output configuration base structure                                                          */
+struct cfg_output {
+    /** Plugin identification                                                                    */
+    std::string name;
+};
+
+/** Configuration of kafka output                                                                */
+struct cfg_kafka : cfg_output {
+    /// Comma separated list of IP[:Port]
+    std::string brokers;
+    /// Produced topic
+    std::string topic;
+    /// Partition to which data should be send
+    int32_t partition;
+    /// Broker version fallback (empty or X.X.X.X)
+    std::string broker_fallback;
+    /// Block conversion if sender buffer is full
+    bool blocking;
+    /// Add default properties for librdkafka
+    bool perf_tuning;
+    /// Pack records into Kafka messages of the given size (bytes, 0 = one record per message)
+    uint32_t pack_size;
+    /// Maximum time for which a pack can wait to be produced (milliseconds, 0 = end of message)
+    uint32_t pack_timeout;
+    /// Type of the message key (i.e. partition key)
+    part_key key;
+    /// Number of independent producers (each with its own thread and subset of partitions)
+    uint32_t shards;
+
+    /// Additional librdkafka properties (might overwrite common parameters)
+    std::map<std::string, std::string> properties;
+};
+
+/**
+ * \brief Parse application version (i.e. A.B.C.D)
+ *
+ * \note At least major and minor version must be specified. Undefined sub-versions are set to zero.
+ * \param[in]  str     Version string
+ * \param[out] version Parsed version
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_FORMAT if the version string is malformed
+ */
+int
+parse_version(const std::string &str, int version[4]);
+
+#endif // JSON_OPTIONS_H
@@ -0,0 +1,207 @@
+/**
+ * \file src/plugins/output/json/src/PartKey.cpp
+ * \author agent <agent@local>
+ * \brief Partition keys of flow records (source file)
+ * \date 2026
+ */
+
+/* Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is'', and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+#include <cstring>
+#include <utility>
+#include <endian.h>
+
+#include "PartKey.hpp"
+
+/** IANA identifiers of fields of the 5-tuple                                                    */
+enum {
+    IANA_PROTO = 4,   ///< protocolIdentifier
+    IANA_SPORT = 7,   ///< sourceTransportPort
+    IANA_SRC4 = 8,    ///< sourceIPv4Address
+    IANA_DPORT = 11,  ///< destinationTransportPort
+    IANA_DST4 = 12,   ///< destinationIPv4Address
+    IANA_SRC6 = 27,   ///< sourceIPv6Address
+    IANA_DST6 = 28    ///< destinationIPv6Address
+};
+
+/**
+ * \brief Mix a 64-bit value into a hash
+ * \param[in] hash  Hash
+ * \param[in] value Value
+ * \return New hash
+ */
+static inline uint64_t
+hash_mix(uint64_t hash, uint64_t value)
+{
+    hash ^= value * UINT64_C(0x9E3779B97F4A7C15);
+    hash = (hash ^ (hash >> 32)) * UINT64_C(0xD6E8FEB86659FD93);
+    return hash ^ (hash >> 32);
+}
+
+/**
+ * \brief Mix a memory block into a hash
+ * \param[in] hash Hash
+ * \param[in] data Memory block
+ * \param[in] size Size of the block
+ * \return New hash
+ */
+static uint64_t
+hash_data(uint64_t hash, const uint8_t *data, size_t size)
+{
+    while (size >= sizeof(uint64_t)) {
+        uint64_t value;
+        memcpy(&value, data, sizeof(value));
+        hash = hash_mix(hash, value);
+        data += sizeof(value);
+        size -= sizeof(value);
+    }
+
+    if (size > 0) {
+        uint64_t value = 0;
+        memcpy(&value, data, size);
+        hash = hash_mix(hash, value);
+    }
+
+    return hash_mix(hash, size);
+}
+
+/**
+ * \brief Mix a field of a record into a hash
+ *
+ * If the field is not present, only the missing value is mixed.
+ * \param[in] hash Hash
+ * \param[in] rec  Data record
+ * \param[in] id   IANA identifier of the field
+ * \return New hash
+ */
+static uint64_t
+hash_field(uint64_t hash, struct fds_drec &rec, uint16_t id)
+{
+    struct fds_drec_field field;
+    if (fds_drec_find(&rec, 0, id, &field) == FDS_EOC) {
+        return hash_mix(hash, 0);
+    }
+
+    return hash_data(hash, field.data, field.size);
+}
+
+/**
+ * \brief Mix an IP address of a record into a hash
+ * \param[in] hash Hash
+ * \param[in] rec  Data record
+ * \param[in] id4  IANA identifier of the IPv4 address
+ * \param[in] id6  IANA identifier of the IPv6 address
+ * \return New hash
+ */
+static uint64_t
+hash_addr(uint64_t hash, struct fds_drec &rec, uint16_t id4, uint16_t id6)
+{
+    struct fds_drec_field field;
+    if (fds_drec_find(&rec, 0, id4, &field) != FDS_EOC
+            || fds_drec_find(&rec, 0, id6, &field) != FDS_EOC) {
+        return hash_data(hash, field.data, field.size);
+    }
+
+    return hash_mix(hash, 0);
+}
+
+uint64_t
+PartKey::msg_key(const struct fds_ipfix_msg_hdr *hdr, const struct ipx_session *session) const
+{
+    switch (m_type) {
+    case part_key::ODID:
+        return hash_mix(0, ntohl(hdr->odid));
+    case part_key::EXPORTER:
+        break;
+    default:
+        return 0;
+    }
+
+    if (!session) {
+        return 0;
+    }
+
+    const struct ipx_session_net *net;
+    switch (session->type) {
+    case FDS_SESSION_UDP:
+        net = &session->udp.net;
+        break;
+    case FDS_SESSION_TCP:
+        net = &session->tcp.net;
+        break;
+    case FDS_SESSION_SCTP:
+        net = &session->sctp.net;
+        break;
+    default:
+        // No IP address (e.g. a file), use its name instead
+        return hash_data(0, reinterpret_cast<const uint8_t *>(session->ident),
+            strlen(session->ident));
+    }
+
+    if (net->l3_proto == AF_INET) {
+        return hash_data(0, reinterpret_cast<const uint8_t *>(&net->addr_src.ipv4),
+            sizeof(net->addr_src.ipv4));
+    } else {
+        return hash_data(0, reinterpret_cast<const uint8_t *>(&net->addr_src.ipv6),
+            sizeof(net->addr_src.ipv6));
+    }
+}
+
+uint64_t
+PartKey::rec_key(struct fds_drec &rec, uint64_t msg_key) const
+{
+    uint64_t key;
+
+    switch (m_type) {
+    case part_key::SRC_IP:
+        key = hash_addr(0, rec, IANA_SRC4, IANA_SRC6);
+        break;
+    case part_key::FLOW: {
+        // Endpoints are hashed separately and combined in order independent way
+        uint64_t src = hash_field(hash_addr(0, rec, IANA_SRC4, IANA_SRC6), rec, IANA_SPORT);
+        uint64_t dst = hash_field(hash_addr(0, rec, IANA_DST4, IANA_DST6), rec, IANA_DPORT);
+        if (src > dst) {
+            std::swap(src, dst);
+        }
+        key = hash_field(hash_mix(hash_mix(0, src), dst), rec, IANA_PROTO);
+        }
+        break;
+    default:
+        // The key depends only on the message
+        key = msg_key;
+        break;
+    }
+
+    return htobe64(key);
+}
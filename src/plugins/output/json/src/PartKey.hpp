@@ -0,0 +1,95 @@
+/**
+ * \file src/plugins/output/json/src/PartKey.hpp
+ * \author agent <agent@local>
+ * \brief Partition keys of flow records (header file)
+ * \date 2026
+ */
+
+/* Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is'', and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+#ifndef JSON_PARTKEY_H
+#define JSON_PARTKEY_H
+
+#include <cstdint>
+#include <ipfixcol2.h>
+#include <libfds.h>
+
+#include "Options.hpp"
+
+/**
+ * \brief Calculator of partition keys of flow records
+ *
+ * A key is a 64-bit hash of selected fields of a record (or its message) calculated directly
+ * from the IPFIX record, i.e. before conversion to JSON. Records with the same values of the
+ * fields always get the same key, so they can be sent to the same partition.
+ * \note The calculator doesn't have any internal state, so it can be used by multiple threads.
+ */
+class PartKey {
+public:
+    /**
+     * \brief Create a calculator
+     * \param[in] type Type of keys
+     */
+    explicit PartKey(part_key type) : m_type(type) {};
+
+    /**
+     * \brief Calculate the common part of keys of all records in a message
+     *
+     * The value depends only on the message (i.e. ODID or exporter) and it must be passed to
+     * rec_key() for each record of the message.
+     * \param[in] hdr     Header of the IPFIX Message
+     * \param[in] session Transport Session of the message (can be NULL)
+     * \return Key of the message
+     */
+    uint64_t
+    msg_key(const struct fds_ipfix_msg_hdr *hdr, const struct ipx_session *session) const;
+
+    /**
+     * \brief Calculate the key of a record
+     *
+     * Missing fields are considered to be empty. Both directions of a biflow record get
+     * the same key.
+     * \param[in] rec     Data record
+     * \param[in] msg_key Key of the message of the record (see msg_key())
+     * \return Key in network byte order (i.e. ready to be used as a message key)
+     */
+    uint64_t
+    rec_key(struct fds_drec &rec, uint64_t msg_key) const;
+
+private:
+    /** Type of keys                                                                             */
+    part_key m_type;
+};
+
+#endif // JSON_PARTKEY_H
@@ -0,0 +1,266 @@
+/**
+ * \file src/plugins/output/json/src/Registry.cpp
+ * \author agent <agent@local>
+ * \brief Client of a schema registry (source file)
+ * \date 2026
+ */
+
+/* Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is'', and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#include "Registry.hpp"
+
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <netdb.h>
+
+/** Default port of the registry                        */
+#define REGISTRY_PORT_DEF "8081"
+/** Timeout of socket operations (seconds)              */
+#define REGISTRY_TIMEOUT 5
+/** Maximum size of a response                          */
+#define REGISTRY_RESP_MAX (1024 * 1024)
+
+/**
+ * \brief Escape a string to be used as a JSON string value
+ * \param[in] in String to escape
+ * \return Escaped string (without quotation marks)
+ */
+static std::string
+json_escape(const std::string &in)
+{
+    std::string out;
+    out.reserve(in.size() + in.size() / 4);
+    for (char c : in) {
+        if (c == '"' || c == '\\') {
+            out.push_back('\\');
+        }
+        out.push_back(c);
+    }
+    return out;
+}
+
+Registry::Registry(const std::string &url)
+{
+    std::string rest = url;
+    const std::string scheme = "http://";
+    if (rest.compare(0, scheme.size(), scheme) == 0) {
+        rest.erase(0, scheme.size());
+    } else if (rest.find("://") != std::string::npos) {
+        throw std::invalid_argument("Unsupported scheme of the schema registry '" + url
+            + "' (only plain HTTP is supported)!");
+    }
+
+    const size_t slash = rest.find('/');
+    if (slash != std::string::npos) {
+        m_path = rest.substr(slash);
+        rest.erase(slash);
+        while (!m_path.empty() && m_path.back() == '/') {
+            m_path.pop_back();
+        }
+    }
+
+    // IPv6 addresses are enclosed in brackets (e.g. [::1]:8081)
+    size_t colon = std::string::npos;
+    if (!rest.empty() && rest.front() == '[') {
+        const size_t end = rest.find(']');
+        if (end == std::string::npos) {
+            throw std::invalid_argument("Invalid address of the schema registry '" + url + "'!");
+        }
+        m_host = rest.substr(1, end - 1);
+        if (end + 1 < rest.size()) {
+            if (rest[end + 1] != ':') {
+                throw std::invalid_argument("Invalid address of the schema registry '"
+                    + url + "'!");
+            }
+            colon = end + 1;
+        }
+    } else {
+        colon = rest.find(':');
+        m_host = rest.substr(0, colon);
+    }
+
+    m_port = (colon != std::string::npos) ? rest.substr(colon + 1) : REGISTRY_PORT_DEF;
+    if (m_host.empty() || m_port.empty()) {
+        throw std::invalid_argument("Invalid address of the schema registry '" + url + "'!");
+    }
+}
+
+uint32_t
+Registry::schema_id(const std::string &subject, const std::string &schema)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    std::string key = subject;
+    key.push_back('\n');
+    key.append(schema);
+    auto it = m_ids.find(key);
+    if (it != m_ids.end()) {
+        return it->second;
+    }
+
+    // Register the schema (the registry returns the existing identifier if already registered)
+    const std::string path = m_path + "/subjects/" + subject + "/versions";
+    const std::string body = "{\"schema\":\"" + json_escape(schema) + "\"}";
+    int status;
+    const std::string resp = request(path, body, status);
+    if (status != 200) {
+        throw std::runtime_error("Schema registry refused the schema of subject '" + subject
+            + "' (status " + std::to_string(status) + "): " + resp);
+    }
+
+    // Response: {"id":<number>}
+    size_t pos = resp.find("\"id\"");
+    if (pos != std::string::npos) {
+        pos = resp.find(':', pos);
+    }
+    char *end = nullptr;
+    const unsigned long id = (pos != std::string::npos)
+        ? strtoul(resp.c_str() + pos + 1, &end, 10) : 0;
+    if (end == nullptr || end == resp.c_str() + pos + 1 || id > UINT32_MAX) {
+        throw std::runtime_error("Unexpected response of the schema registry: " + resp);
+    }
+
+    m_ids.emplace(std::move(key), static_cast<uint32_t>(id));
+    return static_cast<uint32_t>(id);
+}
+
+/**
+ * \brief Send a POST request to the registry and receive the response
+ *
+ * A new connection is used for each request (HTTP/1.0), i.e. the response ends when the
+ * registry closes the connection.
+ * \param[in]  path   Path of the request
+ * \param[in]  body   Body of the request (JSON)
+ * \param[out] status Status code of the response
+ * \return Body of the response
+ * \throw runtime_error if the request fails
+ */
+std::string
+Registry::request(const std::string &path, const std::string &body, int &status)
+{
+    struct addrinfo hints;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+
+    struct addrinfo *result;
+    int rc;
+    if ((rc = getaddrinfo(m_host.c_str(), m_port.c_str(), &hints, &result)) != 0) {
+        throw std::runtime_error("Failed to resolve the schema registry '" + m_host + "': "
+            + gai_strerror(rc));
+    }
+    std::unique_ptr<struct addrinfo, decltype(&freeaddrinfo)> ai_list(result, &freeaddrinfo);
+
+    // Timeouts of all operations (including connect())
+    struct timeval timeout = {REGISTRY_TIMEOUT, 0};
+    int sd = -1;
+    for (struct addrinfo *ptr = result; ptr != nullptr; ptr = ptr->ai_next) {
+        sd = socket(ptr->ai_family, ptr->ai_socktype | SOCK_CLOEXEC, ptr->ai_protocol);
+        if (sd == -1) {
+            continue;
+        }
+        setsockopt(sd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+        setsockopt(sd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+        if (::connect(sd, ptr->ai_addr, ptr->ai_addrlen) == 0) {
+            break;
+        }
+        close(sd);
+        sd = -1;
+    }
+    if (sd == -1) {
+        throw std::runtime_error("Failed to connect to the schema registry '" + m_host + ":"
+            + m_port + "'");
+    }
+    std::unique_ptr<int, void (*)(int *)> sd_guard(&sd, [](int *fd) {close(*fd);});
+
+    std::string req = "POST " + path + " HTTP/1.0\r\n";
+    req += "Host: " + m_host + ":" + m_port + "\r\n";
+    req += "Content-Type: application/vnd.schemaregistry.v1+json\r\n";
+    req += "Accept: application/vnd.schemaregistry.v1+json, application/json\r\n";
+    req += "Content-Length: " + std::to_string(body.size()) + "\r\n";
+    req += "Connection: close\r\n\r\n";
+    req += body;
+
+    size_t sent = 0;
+    while (sent < req.size()) {
+        ssize_t ret = send(sd, req.data() + sent, req.size() - sent, MSG_NOSIGNAL);
+        if (ret == -1 && errno == EINTR) {
+            continue;
+        }
+        if (ret <= 0) {
+            throw std::runtime_error("Failed to send a request to the schema registry: "
+                + std::string(strerror(errno)));
+        }
+        sent += static_cast<size_t>(ret);
+    }
+
+    std::string resp;
+    char buffer[4096];
+    while (true) {
+        ssize_t ret = recv(sd, buffer, sizeof(buffer), 0);
+        if (ret == -1 && errno == EINTR) {
+            continue;
+        }
+        if (ret < 0) {
+            throw std::runtime_error("Failed to receive a response of the schema registry: "
+                + std::string(strerror(errno)));
+        }
+        if (ret == 0) {
+            break;
+        }
+        resp.append(buffer, static_cast<size_t>(ret));
+        if (resp.size() > REGISTRY_RESP_MAX) {
+            throw std::runtime_error("Response of the schema registry is too long!");
+        }
+    }
+
+    // Status line (e.g. "HTTP/1.1 200 OK") and body
+    const size_t hdr_end = resp.find("\r\n\r\n");
+    if (resp.compare(0, 5, "HTTP/") != 0 || hdr_end == std::string::npos) {
+        throw std::runtime_error("Malformed response of the schema registry!");
+    }
+    const size_t space = resp.find(' ');
+    status = (space < hdr_end) ? atoi(resp.c_str() + space + 1) : 0;
+    return resp.substr(hdr_end + 4);
+}
@@ -0,0 +1,96 @@
+/**
+ * \file src/plugins/output/json/src/Registry.hpp
+ * \author agent <agent@local>
+ * \brief Client of a schema registry (header file)
+ * \date 2026
+ */
+
+/* Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is'', and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#ifndef JSON_REGISTRY_H
+#define JSON_REGISTRY_H
+
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+
+/**
+ * \brief Client of a Confluent compatible schema registry
+ *
+ * Schemas are registered over the REST API of the registry (plain HTTP) and their identifiers
+ * are cached, therefore, each schema is registered only once. The client can be shared by
+ * multiple threads.
+ */
+class Registry {
+public:
+    /**
+     * \brief Constructor
+     * \param[in] url URL of the registry (i.e. [http://]host[:port][/path])
+     * \throw invalid_argument if the URL is malformed
+     */
+    explicit Registry(const std::string &url);
+
+    /**
+     * \brief Get the identifier of a schema (the schema is registered, if necessary)
+     *
+     * The function blocks until the registry responds.
+     * \param[in] subject Subject under which the schema is registered
+     * \param[in] schema  Avro schema (JSON)
+     * \return Identifier of the schema
+     * \throw runtime_error if the schema cannot be registered
+     */
+    uint32_t
+    schema_id(const std::string &subject, const std::string &schema);
+
+private:
+    /** Hostname of the registry                                                                 */
+    std::string m_host;
+    /** Port of the registry                                                                     */
+    std::string m_port;
+    /** Path prefix of the REST API (without the trailing slash)                                 */
+    std::string m_path;
+
+    /** Synchronization of the cache and requests                                                */
+    std::mutex m_mutex;
+    /** Identifiers of registered schemas (subject and schema are keys)                          */
+    std::map<std::string, uint32_t> m_ids;
+
+    // Send a request and receive the response
+    std::string
+    request(const std::string &path, const std::string &body, int &status);
+};
+
+#endif // JSON_REGISTRY_H
@@ -45,9 +45,12 @@
 #include <unistd.h>
 #include <inttypes.h>
 
+#include <algorithm>
+#include <cstring>
+
 #include <sys/types.h>
 #include <sys/socket.h>
-#include <netdb.h>
+#include <sys/uio.h>
 
 /** Value of invalid file (socket) descriptor      */
 #define INVALID_FD (-1)
@@ -56,17 +59,22 @@
 
 /**
  * \brief Class constructor
+ *
+ * The connection is established in the background, i.e. records are dropped until
+ * the destination is connected.
  * \param[in] cfg Sender configuration
  * \param[in] ctx Instance context
+ * \throw runtime_error if the connector cannot be started
  */
 Sender::Sender(const struct cfg_send &cfg, ipx_ctx_t *ctx) : Output(cfg.name, ctx)
 {
     params = cfg;
     sd = INVALID_FD;
-    clock_gettime(CLOCK_MONOTONIC, &connection_time);
+    m_dropped = 0;
 
-    // Create a new connection
-    connect();
+    const int sock_type = (params.proto == cfg_send::SEND_PROTO_TCP) ? SOCK_STREAM : SOCK_DGRAM;
+    m_connector.reset(new Connector(params.addr, params.port, sock_type, RECONN_DELAY, ctx,
+        "(Send output)"));
 }
 
 /** Destructor */
@@ -77,6 +85,33 @@ Sender::~Sender()
     }
 }
 
+/**
+ * \brief Check the connection and pick up a new one if not connected
+ *
+ * Connections are established by the background connector, so the function never waits
+ * for the destination.
+ * \return True if connected, false otherwise
+ */
+bool
+Sender::ready()
+{
+    if (sd != INVALID_FD) {
+        return true;
+    }
+
+    sd = m_connector->get();
+    if (sd == INVALID_FD) {
+        return false;
+    }
+
+    if (m_dropped != 0) {
+        IPX_CTX_INFO(_ctx, "(Send output) %" PRIu64 " records to '%s:%" PRIu16 "' have been "
+            "dropped while disconnected.", m_dropped, params.addr.c_str(), params.port);
+        m_dropped = 0;
+    }
+    return true;
+}
+
 /**
  * \brief Send a JSON record
  * \param[in] str JSON Record to send
@@ -86,142 +121,109 @@ Sender::~Sender()
 int
 Sender::process(const char *str, size_t len)
 {
-    if (sd == INVALID_FD) {
-        // Not connected -> try to reconnect
-        struct timespec now;
-        clock_gettime(CLOCK_MONOTONIC, &now);
-
-        // Try only one reconnection per second
-        if (connection_time.tv_sec + RECONN_DELAY > now.tv_sec) {
-            return IPX_OK;
-        }
-
-        connection_time = now;
-        if (connect() != IPX_OK) {
-            IPX_CTX_WARNING(_ctx, "(Send output) Reconnection to '%s:%" PRIu16 "' failed! "
-                "Trying again in %d seconds.", params.addr.c_str(), params.port, int(RECONN_DELAY));
-            return IPX_OK;
-        } else {
-            IPX_CTX_INFO(_ctx, "(Send output) Successfully connected to '%s:%" PRIu16 "'.",
-                params.addr.c_str(), params.port);
-        }
+    if (!ready()) {
+        m_dropped++;
+        return IPX_OK;
     }
 
-    // Send not previously send data (only for non-blocking mode)
-    enum Send_status status;
-    if (!params.blocking && !msg_rest.empty()) {
-        status = send(msg_rest.c_str(), msg_rest.size());
-        switch (status) {
-        case SEND_OK:
-            msg_rest.clear();
-            break;
-        case SEND_WOULDBLOCK:
-            // Nothing to send
-            return IPX_OK;
-        case SEND_FAILED:
-            close(sd);
-            sd = INVALID_FD;
-            return IPX_OK;
-        }
-    }
-
-    // Send new data
-    status = send(str, len);
-    switch (status) {
-    case SEND_OK:
-    case SEND_WOULDBLOCK:
-        // Nothing to do
-        break;
-    case SEND_FAILED:
+    // Send new data (together with not previously sent data in non-blocking mode)
+    if (send(str, len) == SEND_FAILED) {
         close(sd);
         sd = INVALID_FD;
-        break;
     }
 
     return IPX_OK;
 }
 
 /**
- * \brief Create a new connection to the destination
- * \return #IPX_OK on success
- * \return #IPX_ERR_DENIED in case of connection failure
+ * \brief Send a batch of JSON records
+ *
+ * Over TCP, the whole batch is sent at once. Over UDP, each record is sent as a separate
+ * datagram, but all datagrams are passed to the kernel by a single system call.
+ * \param[in] batch Batch of JSON records
+ * \return Always #IPX_OK
  */
 int
-Sender::connect()
+Sender::process_batch(const struct Batch &batch)
 {
-    if (sd != INVALID_FD) {
-        close(sd);
-        sd = INVALID_FD;
+    if (!ready()) {
+        m_dropped += batch.cnt;
+        return IPX_OK;
     }
 
-    // Create a new socket
-    std::string port_str = std::to_string(params.port);
-    struct addrinfo hints;
-    memset(&hints, 0, sizeof(hints));
-    hints.ai_family = AF_UNSPEC;
-    hints.ai_socktype = (params.proto == cfg_send::SEND_PROTO_TCP) ? SOCK_STREAM : SOCK_DGRAM;
-    hints.ai_protocol = 0;
-    hints.ai_flags = AI_NUMERICSERV;
-
-    struct addrinfo *result, *ptr;
-    int rc;
-    if ((rc = getaddrinfo(params.addr.c_str(), port_str.c_str(), &hints, &result)) != 0) {
-        IPX_CTX_ERROR(_ctx, "(Send output) getaddrinfo() failed: %s", gai_strerror(rc));
-        return IPX_ERR_DENIED;
+    enum Send_status status;
+    if (params.proto == cfg_send::SEND_PROTO_UDP) {
+        status = send_datagrams(batch);
+    } else {
+        status = send(batch.data, batch.len);
     }
 
-    for (ptr = result; ptr != nullptr; ptr = ptr->ai_next) {
-        // Try to create a new socket and connect
-        sd = socket(ptr->ai_family, ptr->ai_socktype, ptr->ai_protocol);
-        if (sd == INVALID_FD) {
-            continue;
-        }
+    if (status == SEND_FAILED) {
+        close(sd);
+        sd = INVALID_FD;
+    }
 
-        if (::connect(sd, ptr->ai_addr, ptr->ai_addrlen) == -1) {
-            close(sd);
-            continue;
-        }
+    return IPX_OK;
+}
 
-        // Success
-        break;
+/**
+ * \brief Skip already sent data of a message to send
+ * \param[in,out] msg  Message (its vector of parts is modified)
+ * \param[in]     sent Number of sent bytes
+ */
+static void
+iov_advance(struct msghdr &msg, size_t sent)
+{
+    while (msg.msg_iovlen > 0 && sent >= msg.msg_iov[0].iov_len) {
+        sent -= msg.msg_iov[0].iov_len;
+        msg.msg_iov++;
+        msg.msg_iovlen--;
     }
 
-    freeaddrinfo(result);
-    if (ptr == nullptr) {
-        IPX_CTX_ERROR(_ctx, "(Send output) Unable to connect to '%s:%" PRIu16 "'!",
-            params.addr.c_str(), params.port);
-        sd = INVALID_FD;
-        return IPX_ERR_DENIED;
+    if (msg.msg_iovlen > 0) {
+        msg.msg_iov[0].iov_base = static_cast<char *>(msg.msg_iov[0].iov_base) + sent;
+        msg.msg_iov[0].iov_len -= sent;
     }
-
-    return IPX_OK;
 }
 
 /**
- * \brief Send a JSON record
+ * \brief Send JSON data
  *
- * If non-blocking mode is enabled and only part of the record is sent, the rest is stored
- * into a buffer.
- * \param[in] str The record to send
- * \param[in] len Length of the record
+ * The rest of the last partly sent data (only in non-blocking mode) and the new data are sent
+ * together by a single system call. If only part of the data is sent, the rest is stored into
+ * a buffer. If the rest of the last data cannot be sent completely, the new data are skipped.
+ * \param[in] str The data to send (one or more records)
+ * \param[in] len Length of the data
  * \return #SEND_OK on success
- * \return #SEND_WOULDBLOCK if a part or nothing of the message was sent
+ * \return #SEND_WOULDBLOCK if a part or nothing of the data was sent
  * \return #SEND_FAILED in case of broken connection
  */
 enum Sender::Send_status
 Sender::send(const char *str, size_t len)
 {
-    ssize_t now;
-    size_t todo = len;
-    const char *ptr = str;
+    const size_t rest_len = msg_rest.size();
+    const size_t total = rest_len + len;
+    size_t sent = 0;
+
+    struct iovec parts[2];
+    parts[0].iov_base = const_cast<char *>(msg_rest.data());
+    parts[0].iov_len = rest_len;
+    parts[1].iov_base = const_cast<char *>(str);
+    parts[1].iov_len = len;
+
+    struct msghdr msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = parts;
+    msg.msg_iovlen = 2;
+    iov_advance(msg, 0); // Skip the empty rest
 
     int flags = MSG_NOSIGNAL;
     if (!params.blocking) {
         flags |= MSG_DONTWAIT;
     }
 
-    while (todo > 0) {
-        now = ::send(sd, ptr, todo, flags);
+    while (sent < total) {
+        ssize_t now = sendmsg(sd, &msg, flags);
         if (now == -1) {
             if (!params.blocking && (errno == EAGAIN || errno == EWOULDBLOCK)) {
                 // Non-blocking mode
@@ -233,28 +235,87 @@ Sender::send(const char *str, size_t len)
             const char *err_str = strerror_r(errno, buffer, 128);
             IPX_CTX_INFO(_ctx, "(Send output) Destination '%s:%" PRIu16 "' disconnected: %s",
                 params.addr.c_str(), params.port, err_str);
+            msg_rest.clear();
             return SEND_FAILED;
         }
 
-        ptr  += now;
-        todo -= now;
+        sent += static_cast<size_t>(now);
+        iov_advance(msg, static_cast<size_t>(now));
     }
 
-    if (todo == 0) {
+    if (sent == total) {
+        msg_rest.clear();
         return SEND_OK;
     }
 
-    // Non-blocking mode - (partly) failed to sent the message
-    if (todo == len) {
-        // No part of the message was sent
+    // Non-blocking mode - (partly) failed to sent the data
+    if (sent < rest_len) {
+        // The rest of the last data is still not sent -> skip the new data
+        msg_rest.erase(0, sent);
         return SEND_WOULDBLOCK;
     }
 
     /*
-     * Partly sent. Store the rest of the message for the next transmission to
+     * Partly sent. Store the rest of the data for the next transmission to
      * avoid invalid JSON format.
      */
-    std::string tmp(ptr, todo);
-    msg_rest.assign(tmp);
+    msg_rest.assign(str + (sent - rest_len), total - sent);
     return SEND_WOULDBLOCK;
-}
\ No newline at end of file
+}
+
+/**
+ * \brief Send each record of a batch as a separate datagram
+ *
+ * All datagrams are passed to the kernel by sendmmsg(). Records that cannot be sent
+ * in non-blocking mode are skipped.
+ * \param[in] batch Batch of JSON records
+ * \return #SEND_OK on success
+ * \return #SEND_WOULDBLOCK if some records were skipped
+ * \return #SEND_FAILED in case of a broken connection
+ */
+enum Sender::Send_status
+Sender::send_datagrams(const struct Batch &batch)
+{
+    m_iovs.resize(batch.cnt);
+    m_msgs.resize(batch.cnt);
+    memset(m_msgs.data(), 0, batch.cnt * sizeof(struct mmsghdr));
+
+    size_t start = 0;
+    for (size_t i = 0; i < batch.cnt; ++i) {
+        m_iovs[i].iov_base = const_cast<char *>(batch.data + start);
+        m_iovs[i].iov_len = batch.ends[i] - start;
+        m_msgs[i].msg_hdr.msg_iov = &m_iovs[i];
+        m_msgs[i].msg_hdr.msg_iovlen = 1;
+        start = batch.ends[i];
+    }
+
+    int flags = MSG_NOSIGNAL;
+    if (!params.blocking) {
+        flags |= MSG_DONTWAIT;
+    }
+
+    size_t done = 0;
+    while (done < batch.cnt) {
+        // The number of messages per call is limited by the kernel (UIO_MAXIOV)
+        const unsigned int cnt = static_cast<unsigned int>(std::min<size_t>(batch.cnt - done,
+            UIO_MAXIOV));
+        int now = sendmmsg(sd, &m_msgs[done], cnt, flags);
+        if (now == -1) {
+            if (!params.blocking && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+                // Non-blocking mode
+                return SEND_WOULDBLOCK;
+            }
+
+            // Connection failed
+            char buffer[128];
+            const char *err_str = strerror_r(errno, buffer, 128);
+            IPX_CTX_INFO(_ctx, "(Send output) Destination '%s:%" PRIu16 "' disconnected: %s",
+                params.addr.c_str(), params.port, err_str);
+            return SEND_FAILED;
+        }
+
+        done += static_cast<size_t>(now);
+    }
+
+    return SEND_OK;
+}
@@ -42,6 +42,12 @@
 #ifndef JSON_SENDER_H
 #define JSON_SENDER_H
 
+#include <memory>
+#include <vector>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include "Config.hpp"
+#include "Connector.hpp"
 #include "Storage.hpp"
 
 /** JSON sender (over TCP or UDP)                                                 */
@@ -54,6 +60,8 @@ public:
 
     // Processing records
     int process(const char *str, size_t len);
+    // Processing batches of records
+    int process_batch(const struct Batch &batch);
 
 private:
     /** Transmission status */
@@ -69,11 +77,18 @@ private:
     int sd;
     /** Configuration parameters of the output                                    */
     struct cfg_send params;
-    /** Time of the last connection attempt                                       */
-    struct timespec connection_time;
+    /** Background connector of the destination                                   */
+    std::unique_ptr<Connector> m_connector;
+    /** Number of records dropped while disconnected                              */
+    uint64_t m_dropped;
+    /** Parts of datagrams of a batch (UDP only)                                  */
+    std::vector<struct iovec> m_iovs;
+    /** Datagrams of a batch (UDP only)                                           */
+    std::vector<struct mmsghdr> m_msgs;
 
-    int connect();
+    bool ready();
     enum Send_status send(const char *str, size_t len);
+    enum Send_status send_datagrams(const struct Batch &batch);
 };
 
 #endif // JSON_SENDER_H
@@ -0,0 +1,1079 @@
+/**
+ * \file src/plugins/output/json/src/Serializer.cpp
+ * \author agent <agent@local>
+ * \brief Template-compiled JSON serializer (source file)
+ * \date 2026
+ */
+
+/* Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is'', and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+#include <arpa/inet.h>
+#include <endian.h>
+
+#include "Serializer.hpp"
+
+/** Maximum number of prepared plans (all plans are dropped if exceeded)                      */
+#define PLANS_MAX        1024U
+/** Maximum length of a formatted unsigned/signed integer                                      */
+#define LEN_INT          FMT_LEN_INT
+/** Maximum length of a formatted IPv4 address (including quotes)                              */
+#define LEN_IPV4         (FMT_LEN_IPV4 + 2U)
+/** Maximum length of a formatted IPv6 address (including quotes)                              */
+#define LEN_IPV6         (FMT_LEN_IPV6 + 2U)
+/** Maximum length of a formatted MAC address (including quotes)                               */
+#define LEN_MAC          19U
+/** Maximum length of a formatted timestamp (including quotes)                                  */
+#define LEN_TIME         (FMT_LEN_TIME + 2U)
+/** IANA Information Element ID of protocolIdentifier                                           */
+#define IANA_PROTO       4U
+/** IANA Information Element ID of tcpControlBits                                               */
+#define IANA_TCPFLAGS    6U
+/** Difference between NTP and UNIX epoch (in seconds)                                         */
+#define NTP_EPOCH_DIFF   UINT64_C(2208988800)
+
+/** Type of a formatter of a field                                                            */
+enum class FieldKind {
+    UINT,      /**< Unsigned integer                                                           */
+    INT,       /**< Signed integer                                                             */
+    IPV4,      /**< IPv4 address                                                               */
+    IPV6,      /**< IPv6 address                                                               */
+    MAC,       /**< MAC address                                                                */
+    TIME_NUM,  /**< Timestamp as a number of milliseconds since UNIX epoch                     */
+    TIME_STR,  /**< Timestamp in ISO 8601 format                                               */
+    MEMO       /**< Value rendered by the generic converter and remembered                     */
+};
+
+/**
+ * \brief Renderer of a single field by the generic converter
+ *
+ * The field is converted as the only field of an auxiliary Template with the same
+ * definition of the field.
+ */
+class Serializer::FieldRender {
+public:
+    /**
+     * \brief Prepare the renderer
+     * \param[in] tfield Field of the original Template
+     * \param[in] type   Type of the original Template
+     * \param[in] iemgr  Information Element manager (can be NULL)
+     * \param[in] flags  Conversion flags of the generic converter
+     * \throw runtime_error if the auxiliary Template cannot be created
+     */
+    FieldRender(const struct fds_tfield &tfield, enum fds_template_type type,
+        const fds_iemgr_t *iemgr, uint32_t flags);
+    /** Destructor */
+    ~FieldRender() { free(m_buffer); }
+    // Disable copy
+    FieldRender(const FieldRender &) = delete;
+    FieldRender &operator=(const FieldRender &) = delete;
+
+    /**
+     * \brief Render the field
+     * \param[in]  data  Value of the field
+     * \param[out] head  Beginning of the record (i.e. "@type" key and value without '{')
+     * \param[out] key   Key of the field (e.g. "iana:octetDeltaCount": with quotes and colon)
+     * \param[out] value Value of the field
+     * \return True or false (the field is omitted by the converter)
+     * \throw runtime_error if the conversion fails
+     */
+    bool
+    render(const uint8_t *data, std::string &head, std::string &key, std::string &value);
+
+    /**
+     * \brief Render only value of the field
+     * \param[in]  data  Value of the field
+     * \param[out] value Value of the field
+     * \throw runtime_error if the conversion fails
+     */
+    void
+    render(const uint8_t *data, std::string &value);
+
+private:
+    /** Auxiliary Template                                                                     */
+    std::unique_ptr<struct fds_template, decltype(&fds_template_destroy)> m_tmplt;
+    /** Information Element manager                                                            */
+    const fds_iemgr_t *m_iemgr;
+    /** Conversion flags                                                                       */
+    uint32_t m_flags;
+    /** Copy of the value of the field                                                         */
+    std::vector<uint8_t> m_data;
+    /** Output buffer of the converter                                                         */
+    char *m_buffer = nullptr;
+    /** Size of the output buffer                                                              */
+    size_t m_buffer_size = 0;
+};
+
+/** Field of a serialization plan                                                              */
+struct Serializer::Field {
+    /** Type of the formatter                                                                  */
+    FieldKind kind;
+    /** Offset of the field in a record                                                        */
+    uint16_t offset;
+    /** Size of the field                                                                      */
+    uint16_t size;
+    /** Data type of the field (only for timestamps)                                            */
+    enum fds_iemgr_element_type type;
+    /** Format MAC addresses with uppercase hexadecimal digits                                  */
+    bool upper;
+    /** Pre-rendered key of the field (i.e. ,"scope:name":)                                     */
+    std::string key;
+    /** Renderer of the generic converter (only for MEMO and TIME_* kinds)                     */
+    std::unique_ptr<FieldRender> render;
+    /** Remembered values of fields with 1 byte (only for MEMO kind)                           */
+    std::vector<std::string> memo_u8;
+    /** Remembered values of fields with 2 bytes (only for MEMO kind)                          */
+    std::unordered_map<uint16_t, std::string> memo_u16;
+};
+
+/** Serialization plan of a Template                                                          */
+struct Serializer::Plan {
+    /** Beginning of a record (i.e. {"@type":"ipfix.entry")                                    */
+    std::string head;
+    /** Fields to convert                                                                      */
+    std::vector<Field> fields;
+    /** Upper bound of the size of the converted record (including the terminating null byte)  */
+    size_t size_max;
+};
+
+/** Projection of a Template to selected fields (for the generic converter)                   */
+struct Serializer::Projection {
+    /** Auxiliary Template of selected fields (nullptr, if no field is selected)               */
+    std::unique_ptr<struct fds_template, decltype(&fds_template_destroy)> tmplt {
+        nullptr, &fds_template_destroy};
+    /** Selected fields of the original Template (indexed by the position of a field)          */
+    std::vector<bool> selected;
+    /** Records of an Options Template without selected scope fields are not Options records   */
+    bool opts_head = false;
+};
+
+/** Beginning of a Data Record of a Template converted by the generic converter               */
+static const char JSON_HEAD_ENTRY[] = "{\"@type\":\"ipfix.entry\"";
+/** Beginning of a Data Record of an Options Template converted by the generic converter      */
+static const char JSON_HEAD_OPTS[] = "{\"@type\":\"ipfix.optionsEntry\"";
+
+// -------------------------------------------------------------------------------------------------
+
+/**
+ * \brief Read an unsigned integer in network byte order
+ * \param[in] data Field
+ * \param[in] size Size of the field (1 - 8 bytes)
+ * \return Value
+ */
+static inline uint64_t
+read_uint(const uint8_t *data, uint16_t size)
+{
+    switch (size) {
+    case 1:
+        return data[0];
+    case 2: {
+        uint16_t value;
+        memcpy(&value, data, sizeof(value));
+        return be16toh(value);
+    }
+    case 4: {
+        uint32_t value;
+        memcpy(&value, data, sizeof(value));
+        return be32toh(value);
+    }
+    case 8: {
+        uint64_t value;
+        memcpy(&value, data, sizeof(value));
+        return be64toh(value);
+    }
+    default:
+        uint64_t value = 0;
+        for (uint16_t i = 0; i < size; ++i) {
+            value = (value << 8) | data[i];
+        }
+        return value;
+    }
+}
+
+/**
+ * \brief Read a signed integer in network byte order
+ * \param[in] data Field
+ * \param[in] size Size of the field (1 - 8 bytes)
+ * \return Value
+ */
+static inline int64_t
+read_int(const uint8_t *data, uint16_t size)
+{
+    const unsigned int shift = 64U - 8U * size;
+    return static_cast<int64_t>(read_uint(data, size) << shift) >> shift;
+}
+
+/**
+ * \brief Format a MAC address (including quotes)
+ * \param[in] pos   Output position
+ * \param[in] data  Field (6 bytes)
+ * \param[in] upper Use uppercase hexadecimal digits
+ * \return Position after the formatted value
+ */
+static inline char *
+fmt_mac(char *pos, const uint8_t *data, bool upper)
+{
+    const char *digits = upper ? "0123456789ABCDEF" : "0123456789abcdef";
+
+    *pos++ = '"';
+    for (unsigned int i = 0; i < 6; ++i) {
+        if (i != 0) {
+            *pos++ = ':';
+        }
+        *pos++ = digits[data[i] >> 4];
+        *pos++ = digits[data[i] & 0x0F];
+    }
+    *pos++ = '"';
+    return pos;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+Serializer::FieldRender::FieldRender(const struct fds_tfield &tfield, enum fds_template_type type,
+    const fds_iemgr_t *iemgr, uint32_t flags)
+    : m_tmplt(nullptr, &fds_template_destroy), m_iemgr(iemgr), m_flags(flags),
+    m_data(tfield.length, 0)
+{
+    // Raw (Options) Template with only one field
+    uint8_t raw[14];
+    size_t raw_len = 0;
+    const uint16_t tmplt_id = htons(FDS_IPFIX_SET_MIN_DSET);
+    const uint16_t fields_cnt = htons(1);
+    const uint16_t field_id = htons(tfield.id | ((tfield.en != 0) ? 0x8000 : 0));
+    const uint16_t field_len = htons(tfield.length);
+    const uint32_t field_en = htonl(tfield.en);
+
+    memcpy(&raw[raw_len], &tmplt_id, sizeof(tmplt_id));
+    raw_len += sizeof(tmplt_id);
+    memcpy(&raw[raw_len], &fields_cnt, sizeof(fields_cnt));
+    raw_len += sizeof(fields_cnt);
+    if (type == FDS_TYPE_TEMPLATE_OPTS) {
+        // The field is also the only scope field
+        memcpy(&raw[raw_len], &fields_cnt, sizeof(fields_cnt));
+        raw_len += sizeof(fields_cnt);
+    }
+    memcpy(&raw[raw_len], &field_id, sizeof(field_id));
+    raw_len += sizeof(field_id);
+    memcpy(&raw[raw_len], &field_len, sizeof(field_len));
+    raw_len += sizeof(field_len);
+    if (tfield.en != 0) {
+        memcpy(&raw[raw_len], &field_en, sizeof(field_en));
+        raw_len += sizeof(field_en);
+    }
+
+    struct fds_template *tmplt;
+    uint16_t tmplt_len = static_cast<uint16_t>(raw_len);
+    if (fds_template_parse(type, raw, &tmplt_len, &tmplt) != FDS_OK) {
+        throw std::runtime_error("Failed to create an auxiliary Template");
+    }
+
+    // The same definition as the original field
+    tmplt->fields[0].def = tfield.def;
+    m_tmplt.reset(tmplt);
+}
+
+bool
+Serializer::FieldRender::render(const uint8_t *data, std::string &head, std::string &key,
+    std::string &value)
+{
+    std::copy(data, data + m_data.size(), m_data.begin());
+
+    struct fds_drec rec;
+    rec.data = m_data.data();
+    rec.size = static_cast<uint16_t>(m_data.size());
+    rec.tmplt = m_tmplt.get();
+    rec.snap = nullptr;
+
+    const uint32_t flags = m_flags | FDS_CD2J_ALLOW_REALLOC;
+    int rc = fds_drec2json(&rec, flags, m_iemgr, &m_buffer, &m_buffer_size);
+    if (rc < 0) {
+        throw std::runtime_error("Conversion to JSON failed (probably a memory allocation error)!");
+    }
+
+    // Expected format: {"@type":"ipfix.entry","key":value}
+    const std::string out(m_buffer, static_cast<size_t>(rc));
+    const size_t head_end = out.find("\",");
+    if (head_end == std::string::npos) {
+        // The field has been omitted
+        return false;
+    }
+
+    const size_t key_end = out.find("\":", head_end + 2);
+    if (key_end == std::string::npos || out.back() != '}') {
+        throw std::runtime_error("Unexpected output of the JSON converter");
+    }
+
+    head = out.substr(0, head_end + 1);
+    key = out.substr(head_end + 2, key_end + 2 - (head_end + 2));
+    value = out.substr(key_end + 2, out.size() - 1 - (key_end + 2));
+    return true;
+}
+
+void
+Serializer::FieldRender::render(const uint8_t *data, std::string &value)
+{
+    std::string head;
+    std::string key;
+    if (!render(data, head, key, value)) {
+        value.clear();
+    }
+}
+
+// -------------------------------------------------------------------------------------------------
+
+Serializer::Serializer(uint32_t flags) : m_flags(flags & ~FDS_CD2J_BIFLOW_REVERSE)
+{
+}
+
+Serializer::~Serializer() = default;
+
+void
+Serializer::msg_begin(const fds_iemgr_t *iemgr)
+{
+    m_msg_plans.clear();
+    m_msg_projs.clear();
+
+    // Plans must be prepared again if definitions of Information Elements have changed
+    if (iemgr != m_iemgr || m_plans.size() > PLANS_MAX || m_projs.size() > PLANS_MAX) {
+        m_plans.clear();
+        m_projs.clear();
+    }
+
+    if (iemgr != m_iemgr) {
+        // Resolve names of selected fields (unknown elements are ignored)
+        m_iemgr = iemgr;
+        m_sel_ids.clear();
+        for (const auto &name : m_sel_names) {
+            field_ids(m_iemgr, name, m_sel_ids);
+        }
+        std::sort(m_sel_ids.begin(), m_sel_ids.end());
+        m_sel_ids.erase(std::unique(m_sel_ids.begin(), m_sel_ids.end()), m_sel_ids.end());
+    }
+}
+
+void
+Serializer::fields_select(field_sel sel, const std::vector<std::string> &names)
+{
+    m_sel = sel;
+    m_sel_names = names;
+    m_plans.clear();
+    m_projs.clear();
+
+    // Names are resolved by the next message
+    m_iemgr = nullptr;
+    m_sel_ids.clear();
+    for (const auto &name : m_sel_names) {
+        field_ids(nullptr, name, m_sel_ids);
+    }
+    std::sort(m_sel_ids.begin(), m_sel_ids.end());
+}
+
+bool
+Serializer::field_ids(const fds_iemgr_t *iemgr, const std::string &name,
+    std::vector<std::pair<uint32_t, uint16_t>> &ids)
+{
+    const struct fds_iemgr_elem *elem = nullptr;
+    if (iemgr != nullptr) {
+        elem = fds_iemgr_elem_find_name(iemgr, name.c_str());
+    }
+
+    if (elem != nullptr) {
+        ids.emplace_back(elem->scope->pen, elem->id);
+        const struct fds_iemgr_elem *rev = elem->reverse_elem;
+        if (rev != nullptr) {
+            ids.emplace_back(rev->scope->pen, rev->id);
+        }
+        return true;
+    }
+
+    // Numeric identification (the same as keys of numericNames)
+    uint32_t en;
+    uint16_t id;
+    int end = -1;
+    if (sscanf(name.c_str(), "en%" SCNu32 ":id%" SCNu16 "%n", &en, &id, &end) == 2
+            && end == static_cast<int>(name.size())) {
+        ids.emplace_back(en, id);
+        return true;
+    }
+
+    return false;
+}
+
+/**
+ * \brief Check if a field is selected (see fields_select())
+ * \param[in] tfield Field of a Template
+ * \return True or false
+ */
+bool
+Serializer::field_selected(const struct fds_tfield &tfield) const
+{
+    if (m_sel == field_sel::ALL) {
+        return true;
+    }
+
+    const bool listed = std::binary_search(m_sel_ids.begin(), m_sel_ids.end(),
+        std::make_pair(tfield.en, tfield.id));
+    return (m_sel == field_sel::INCLUDE) ? listed : !listed;
+}
+
+/**
+ * \brief Get a plan of a Template
+ *
+ * Plans are prepared on demand and shared by all Templates with the same structure.
+ * \param[in] tmplt Template
+ * \return Pointer to the plan or nullptr (the Template cannot be processed by a plan)
+ */
+Serializer::Plan *
+Serializer::plan_get(const struct fds_template *tmplt)
+{
+    for (const auto &msg_plan : m_msg_plans) {
+        if (msg_plan.first == tmplt) {
+            return msg_plan.second;
+        }
+    }
+
+    std::string id(reinterpret_cast<const char *>(tmplt->raw.data), tmplt->raw.length);
+    id.push_back(static_cast<char>(tmplt->type));
+
+    auto it = m_plans.find(id);
+    if (it == m_plans.end()) {
+        it = m_plans.emplace(std::move(id), plan_create(tmplt)).first;
+    }
+
+    Plan *plan = it->second.get();
+    m_msg_plans.emplace_back(tmplt, plan);
+    return plan;
+}
+
+/**
+ * \brief Prepare a plan of a Template
+ * \param[in] tmplt Template
+ * \return Pointer to the plan or nullptr (the Template cannot be processed by a plan)
+ */
+std::unique_ptr<Serializer::Plan>
+Serializer::plan_create(const struct fds_template *tmplt)
+{
+    if ((tmplt->flags & FDS_TEMPLATE_BIFLOW) != 0) {
+        // Biflow fields are not supported
+        return nullptr;
+    }
+
+    // Only selected fields are part of the plan
+    std::vector<const struct fds_tfield *> fields;
+    for (uint16_t i = 0; i < tmplt->fields_cnt_total; ++i) {
+        const struct fds_tfield &tfield = tmplt->fields[i];
+        if (!field_selected(tfield)) {
+            continue;
+        }
+        if (tfield.length == FDS_IPFIX_VAR_IE_LEN || tfield.offset == FDS_IPFIX_VAR_IE_LEN) {
+            // Variable-length fields (and fields after them) are not supported
+            return nullptr;
+        }
+        fields.push_back(&tfield);
+    }
+
+    // Multiple occurrences of the same field are converted to an array
+    std::vector<std::pair<uint32_t, uint16_t>> ids;
+    for (const struct fds_tfield *tfield : fields) {
+        ids.emplace_back(tfield->en, tfield->id);
+    }
+    std::sort(ids.begin(), ids.end());
+    if (std::adjacent_find(ids.begin(), ids.end()) != ids.end()) {
+        return nullptr;
+    }
+
+    std::unique_ptr<Plan> plan(new Plan);
+    plan->head = (tmplt->type == FDS_TYPE_TEMPLATE_OPTS)
+        ? "{\"@type\":\"ipfix.optionsEntry\"" : "{\"@type\":\"ipfix.entry\"";
+    plan->size_max = plan->head.size() + 2; // '}' + '\0'
+
+    try {
+        for (const struct fds_tfield *tfield : fields) {
+            if (!field_create(*tfield, tmplt->type, *plan)) {
+                return nullptr;
+            }
+        }
+    } catch (const std::runtime_error &) {
+        // The generic converter will be used (and it will probably report the failure)
+        return nullptr;
+    }
+
+    return plan;
+}
+
+/**
+ * \brief Get samples of values to verify a formatter
+ * \param[in] kind Type of the formatter
+ * \param[in] type Data type of the field
+ * \param[in] size Size of the field
+ * \return Samples
+ */
+static std::vector<std::vector<uint8_t>>
+field_samples(FieldKind kind, enum fds_iemgr_element_type type, uint16_t size)
+{
+    std::vector<std::vector<uint8_t>> samples;
+
+    if (size == 1 && kind != FieldKind::TIME_NUM && kind != FieldKind::TIME_STR) {
+        // All values
+        for (unsigned int i = 0; i <= UINT8_MAX; ++i) {
+            samples.emplace_back(1, static_cast<uint8_t>(i));
+        }
+        return samples;
+    }
+
+    if (kind != FieldKind::TIME_NUM && kind != FieldKind::TIME_STR) {
+        std::vector<uint8_t> pattern(size);
+        for (uint16_t i = 0; i < size; ++i) {
+            pattern[i] = static_cast<uint8_t>(0x1B + 0x37 * i);
+        }
+
+        samples.emplace_back(size, 0x00);
+        samples.emplace_back(size, 0xFF);
+        samples.emplace_back(std::move(pattern));
+        return samples;
+    }
+
+    // Timestamps (milliseconds since UNIX epoch)
+    for (uint64_t msecs : {UINT64_C(1526067869006), UINT64_C(1600000000999)}) {
+        std::vector<uint8_t> sample(size);
+        uint64_t value;
+        uint32_t secs;
+        switch (type) {
+        case FDS_ET_DATE_TIME_SECONDS:
+            secs = htobe32(static_cast<uint32_t>(msecs / 1000));
+            memcpy(sample.data(), &secs, sizeof(secs));
+            break;
+        case FDS_ET_DATE_TIME_MILLISECONDS:
+            value = htobe64(msecs);
+            memcpy(sample.data(), &value, 8);
+            break;
+        default:
+            // NTP timestamp (seconds and fraction)
+            value = (((msecs / 1000) + NTP_EPOCH_DIFF) << 32) | (((msecs % 1000) << 32) / 1000);
+            value = htobe64(value);
+            memcpy(sample.data(), &value, 8);
+            break;
+        }
+        samples.emplace_back(std::move(sample));
+    }
+
+    return samples;
+}
+
+/**
+ * \brief Select a formatter of a field
+ * \param[in]  tfield Field of a Template
+ * \param[in]  flags  Conversion flags
+ * \param[out] kind   Type of the formatter
+ * \return True on success, false if there is no specialized formatter for the field
+ */
+static bool
+field_kind(const struct fds_tfield &tfield, uint32_t flags, FieldKind &kind)
+{
+    const uint16_t size = tfield.length;
+    const enum fds_iemgr_element_type type = (tfield.def != nullptr)
+        ? tfield.def->data_type : FDS_ET_OCTET_ARRAY;
+
+    if (tfield.en == 0 && (tfield.id == IANA_PROTO || tfield.id == IANA_TCPFLAGS)) {
+        // Only some values might be formatted differently (e.g. protocol names)
+        return false;
+    }
+
+    switch (type) {
+    case FDS_ET_UNSIGNED_8:
+    case FDS_ET_UNSIGNED_16:
+    case FDS_ET_UNSIGNED_32:
+    case FDS_ET_UNSIGNED_64:
+        kind = FieldKind::UINT;
+        return size >= 1 && size <= 8;
+    case FDS_ET_OCTET_ARRAY:
+        // Short octet arrays can be converted to unsigned integers
+        kind = FieldKind::UINT;
+        return (flags & FDS_CD2J_OCTETS_NOINT) == 0 && size >= 1 && size <= 8;
+    case FDS_ET_SIGNED_8:
+    case FDS_ET_SIGNED_16:
+    case FDS_ET_SIGNED_32:
+    case FDS_ET_SIGNED_64:
+        kind = FieldKind::INT;
+        return size >= 1 && size <= 8;
+    case FDS_ET_IPV4_ADDRESS:
+        kind = FieldKind::IPV4;
+        return size == 4;
+    case FDS_ET_IPV6_ADDRESS:
+        kind = FieldKind::IPV6;
+        return size == 16;
+    case FDS_ET_MAC_ADDRESS:
+        kind = FieldKind::MAC;
+        return size == 6;
+    case FDS_ET_DATE_TIME_SECONDS:
+        kind = (flags & FDS_CD2J_TS_FORMAT_MSEC) ? FieldKind::TIME_STR : FieldKind::TIME_NUM;
+        return size == 4;
+    case FDS_ET_DATE_TIME_MILLISECONDS:
+    case FDS_ET_DATE_TIME_MICROSECONDS:
+    case FDS_ET_DATE_TIME_NANOSECONDS:
+        kind = (flags & FDS_CD2J_TS_FORMAT_MSEC) ? FieldKind::TIME_STR : FieldKind::TIME_NUM;
+        return size == 8;
+    default:
+        return false;
+    }
+}
+
+/**
+ * \brief Get the maximum length of a value formatted by a specialized formatter
+ * \param[in] kind Type of the formatter (MEMO kind is not supported)
+ * \return Length
+ */
+static size_t
+field_len_max(FieldKind kind)
+{
+    switch (kind) {
+    case FieldKind::INT:
+        return LEN_INT;
+    case FieldKind::IPV4:
+        return LEN_IPV4;
+    case FieldKind::IPV6:
+        return LEN_IPV6;
+    case FieldKind::MAC:
+        return LEN_MAC;
+    case FieldKind::TIME_STR:
+        return LEN_TIME;
+    default:
+        return LEN_INT;
+    }
+}
+
+/**
+ * \brief Verify a specialized formatter of a field against the generic converter
+ * \param[in] field  Field of a plan (MEMO kind is not supported)
+ * \param[in] render Renderer of the field
+ * \return True if both produce the same values, false otherwise
+ */
+bool
+Serializer::field_verify(const Field &field, FieldRender &render)
+{
+    std::string value;
+
+    for (const auto &sample : field_samples(field.kind, field.type, field.size)) {
+        char buffer[LEN_IPV6 + LEN_INT];
+        const char *end = field_format(buffer, field, sample.data());
+        render.render(sample.data(), value);
+        if (!end || value != std::string(buffer, static_cast<size_t>(end - buffer))) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * \brief Prepare a field of a plan
+ * \param[in]     tfield Field of the Template
+ * \param[in]     type   Type of the Template
+ * \param[in,out] plan   Plan
+ * \return True on success, false if the field cannot be processed by a plan
+ */
+bool
+Serializer::field_create(const struct fds_tfield &tfield, enum fds_template_type type, Plan &plan)
+{
+    std::unique_ptr<FieldRender> render(new FieldRender(tfield, type, m_iemgr, m_flags));
+    std::vector<uint8_t> zeros(tfield.length, 0);
+    std::string head;
+    std::string key;
+    std::string value;
+
+    if (!render->render(zeros.data(), head, key, value)) {
+        // The field is omitted by the converter (e.g. unknown fields)
+        return true;
+    }
+
+    if (head != plan.head) {
+        // Unexpected format of the output
+        return false;
+    }
+
+    Field field;
+    field.offset = tfield.offset;
+    field.size = tfield.length;
+    field.type = (tfield.def != nullptr) ? tfield.def->data_type : FDS_ET_OCTET_ARRAY;
+    field.upper = false;
+    field.key = "," + key;
+
+    // Verify the specialized formatter (if any), MAC addresses can use both letter cases
+    bool valid = false;
+    if (field_kind(tfield, m_flags, field.kind)) {
+        const unsigned int variants = (field.kind == FieldKind::MAC) ? 2 : 1;
+        for (unsigned int variant = 0; !valid && variant < variants; ++variant) {
+            field.upper = (variant == 1);
+            valid = field_verify(field, *render);
+        }
+    }
+
+    size_t value_max = 0;
+    if (valid) {
+        value_max = field_len_max(field.kind);
+    } else if (field.size <= 2) {
+        // Values are rendered by the generic converter and remembered
+        field.kind = FieldKind::MEMO;
+        if (field.size < 2) {
+            field.memo_u8.resize(1U << (8U * field.size));
+        }
+    } else {
+        return false;
+    }
+
+    if (field.kind == FieldKind::MEMO || field.kind == FieldKind::TIME_NUM
+            || field.kind == FieldKind::TIME_STR) {
+        // Renderer is used for values out of range of the formatter
+        field.render = std::move(render);
+    }
+
+    plan.size_max += field.key.size() + value_max;
+    plan.fields.push_back(std::move(field));
+    return true;
+}
+
+/**
+ * \brief Format a value of a field by its specialized formatter
+ *
+ * \note Timestamps out of range of the formatter are not formatted.
+ * \param[in] pos   Output position
+ * \param[in] field Field of a plan (MEMO kind is not supported)
+ * \param[in] data  Value of the field
+ * \return Position after the formatted value or nullptr (not formatted)
+ */
+inline char *
+Serializer::field_format(char *pos, const Field &field, const uint8_t *data)
+{
+    uint64_t msecs;
+
+    switch (field.kind) {
+    case FieldKind::UINT:
+        return fmt_uint(pos, read_uint(data, field.size));
+    case FieldKind::INT:
+        return fmt_int(pos, read_int(data, field.size));
+    case FieldKind::IPV4:
+        *pos++ = '"';
+        pos = fmt_ipv4(pos, data);
+        *pos++ = '"';
+        return pos;
+    case FieldKind::IPV6:
+        *pos++ = '"';
+        pos = fmt_ipv6(pos, data);
+        *pos++ = '"';
+        return pos;
+    case FieldKind::MAC:
+        return fmt_mac(pos, data, field.upper);
+    case FieldKind::TIME_NUM:
+        if (fds_get_datetime_lp_be(data, field.size, field.type, &msecs) != FDS_OK) {
+            return nullptr;
+        }
+        return fmt_uint(pos, msecs);
+    case FieldKind::TIME_STR:
+        if (fds_get_datetime_lp_be(data, field.size, field.type, &msecs) != FDS_OK
+                || msecs / 1000 > FMT_TIME_SEC_MAX) {
+            return nullptr;
+        }
+        *pos++ = '"';
+        pos = m_time.format(pos, msecs);
+        *pos++ = '"';
+        return pos;
+    default:
+        return nullptr;
+    }
+}
+
+/**
+ * \brief Get a value of a field rendered by the generic converter
+ *
+ * Values of MEMO fields are remembered.
+ * \param[in] field Field of a plan (MEMO or TIME_* kind)
+ * \param[in] data  Value of the field
+ * \return Rendered value (valid until the next call)
+ */
+const std::string &
+Serializer::field_value(Field &field, const uint8_t *data)
+{
+    std::string *value;
+
+    if (field.kind != FieldKind::MEMO) {
+        value = &m_value;
+    } else if (field.size < 2) {
+        value = &field.memo_u8[(field.size == 0) ? 0 : data[0]];
+    } else {
+        value = &field.memo_u16[static_cast<uint16_t>(read_uint(data, 2))];
+    }
+
+    if (field.kind != FieldKind::MEMO || value->empty()) {
+        // The generic converter never returns an empty value
+        field.render->render(data, *value);
+    }
+
+    return *value;
+}
+
+/**
+ * \brief Reserve memory of an output buffer
+ * \param[in,out] str  Output buffer (can be reallocated)
+ * \param[in,out] size Size of the output buffer
+ * \param[in]     need Minimal size of the buffer
+ * \throw bad_alloc in case of a memory allocation error
+ */
+static inline void
+buffer_reserve(char **str, size_t *size, size_t need)
+{
+    if (need <= *size) {
+        return;
+    }
+
+    const size_t new_size = std::max(need, 2 * (*size));
+    char *new_str = static_cast<char *>(realloc(*str, new_size));
+    if (!new_str) {
+        throw std::bad_alloc();
+    }
+
+    *str = new_str;
+    *size = new_size;
+}
+
+int
+Serializer::convert(const struct fds_drec &rec, char **str, size_t *size)
+{
+    Plan *plan = plan_get(rec.tmplt);
+    if (!plan) {
+        return NO_PLAN;
+    }
+
+    buffer_reserve(str, size, plan->size_max);
+    char *pos = *str;
+    memcpy(pos, plan->head.data(), plan->head.size());
+    pos += plan->head.size();
+
+    for (Field &field : plan->fields) {
+        memcpy(pos, field.key.data(), field.key.size());
+        pos += field.key.size();
+
+        const uint8_t *data = rec.data + field.offset;
+        char *end = field_format(pos, field, data);
+        if (end != nullptr) {
+            pos = end;
+            continue;
+        }
+
+        // The value is rendered by the generic converter (the upper bound doesn't include it)
+        const std::string &value = field_value(field, data);
+        const size_t used = static_cast<size_t>(pos - *str);
+        buffer_reserve(str, size, used + value.size() + plan->size_max);
+        pos = *str + used;
+        memcpy(pos, value.data(), value.size());
+        pos += value.size();
+    }
+
+    *pos++ = '}';
+    *pos = '\0';
+    return static_cast<int>(pos - *str);
+}
+
+/**
+ * \brief Get a projection of a Template
+ *
+ * Projections are prepared on demand and shared by all Templates with the same structure.
+ * \param[in] tmplt Template
+ * \return Pointer to the projection
+ * \throw runtime_error if the auxiliary Template cannot be created
+ */
+Serializer::Projection *
+Serializer::proj_get(const struct fds_template *tmplt)
+{
+    for (const auto &msg_proj : m_msg_projs) {
+        if (msg_proj.first == tmplt) {
+            return msg_proj.second;
+        }
+    }
+
+    std::string id(reinterpret_cast<const char *>(tmplt->raw.data), tmplt->raw.length);
+    id.push_back(static_cast<char>(tmplt->type));
+
+    auto it = m_projs.find(id);
+    if (it == m_projs.end()) {
+        it = m_projs.emplace(std::move(id), proj_create(tmplt)).first;
+    }
+
+    Projection *proj = it->second.get();
+    m_msg_projs.emplace_back(tmplt, proj);
+    return proj;
+}
+
+/**
+ * \brief Prepare a projection of a Template
+ *
+ * The auxiliary Template consists of selected fields in the original order. If no scope field
+ * of an Options Template is selected, the auxiliary Template is a Template.
+ * \param[in] tmplt Template
+ * \return Projection
+ * \throw runtime_error if the auxiliary Template cannot be created
+ */
+std::unique_ptr<Serializer::Projection>
+Serializer::proj_create(const struct fds_template *tmplt)
+{
+    std::unique_ptr<Projection> proj(new Projection);
+    proj->selected.resize(tmplt->fields_cnt_total, false);
+
+    // Field Specifiers of selected fields
+    std::vector<uint8_t> specs;
+    uint16_t fields_cnt = 0;
+    uint16_t scope_cnt = 0;
+    for (uint16_t i = 0; i < tmplt->fields_cnt_total; ++i) {
+        const struct fds_tfield &tfield = tmplt->fields[i];
+        if (!field_selected(tfield)) {
+            continue;
+        }
+
+        proj->selected[i] = true;
+        fields_cnt++;
+        if (i < tmplt->fields_cnt_scope) {
+            scope_cnt++;
+        }
+
+        const uint16_t field_id = htons(tfield.id | ((tfield.en != 0) ? 0x8000 : 0));
+        const uint16_t field_len = htons(tfield.length);
+        const uint32_t field_en = htonl(tfield.en);
+        const uint8_t *ptr = reinterpret_cast<const uint8_t *>(&field_id);
+        specs.insert(specs.end(), ptr, ptr + sizeof(field_id));
+        ptr = reinterpret_cast<const uint8_t *>(&field_len);
+        specs.insert(specs.end(), ptr, ptr + sizeof(field_len));
+        if (tfield.en != 0) {
+            ptr = reinterpret_cast<const uint8_t *>(&field_en);
+            specs.insert(specs.end(), ptr, ptr + sizeof(field_en));
+        }
+    }
+
+    const bool opts = (tmplt->type == FDS_TYPE_TEMPLATE_OPTS);
+    proj->opts_head = opts && scope_cnt == 0;
+    if (fields_cnt == 0) {
+        return proj;
+    }
+
+    // Raw (Options) Template
+    std::vector<uint8_t> raw;
+    const uint16_t hdr[3] = {htons(FDS_IPFIX_SET_MIN_DSET), htons(fields_cnt), htons(scope_cnt)};
+    const uint8_t *hdr_ptr = reinterpret_cast<const uint8_t *>(hdr);
+    raw.insert(raw.end(), hdr_ptr, hdr_ptr + ((opts && scope_cnt > 0) ? 6U : 4U));
+    raw.insert(raw.end(), specs.begin(), specs.end());
+
+    const enum fds_template_type type = (opts && scope_cnt > 0)
+        ? FDS_TYPE_TEMPLATE_OPTS : FDS_TYPE_TEMPLATE;
+    struct fds_template *aux;
+    uint16_t aux_len = static_cast<uint16_t>(raw.size());
+    if (fds_template_parse(type, raw.data(), &aux_len, &aux) != FDS_OK) {
+        throw std::runtime_error("Failed to create an auxiliary Template");
+    }
+    proj->tmplt.reset(aux);
+
+    if (m_iemgr != nullptr && fds_template_ies_define(aux, m_iemgr, false) != FDS_OK) {
+        throw std::runtime_error("Failed to define fields of an auxiliary Template");
+    }
+
+    return proj;
+}
+
+int
+Serializer::convert_generic(const struct fds_drec &rec, uint32_t flags, char **str, size_t *size)
+{
+    if (m_sel == field_sel::ALL) {
+        return fds_drec2json(&rec, flags, m_iemgr, str, size);
+    }
+
+    Projection *proj = proj_get(rec.tmplt);
+    const bool opts = (rec.tmplt->type == FDS_TYPE_TEMPLATE_OPTS);
+    if (!proj->tmplt) {
+        // No field is selected
+        const char *head = opts ? JSON_HEAD_OPTS : JSON_HEAD_ENTRY;
+        const size_t len = strlen(head);
+        buffer_reserve(str, size, len + 2);
+        memcpy(*str, head, len);
+        (*str)[len] = '}';
+        (*str)[len + 1] = '\0';
+        return static_cast<int>(len + 1);
+    }
+
+    // Copy selected fields into an auxiliary record
+    struct fds_drec_iter it;
+    fds_drec_iter_init(&it, const_cast<struct fds_drec *>(&rec), FDS_DREC_PADDING_SHOW);
+    m_proj_data.clear();
+    while (fds_drec_iter_next(&it) != FDS_EOC) {
+        const size_t idx = static_cast<size_t>(it.field.info - rec.tmplt->fields);
+        if (!proj->selected[idx]) {
+            continue;
+        }
+
+        const uint16_t len = it.field.size;
+        if (it.field.info->length == FDS_IPFIX_VAR_IE_LEN) {
+            // Variable-length field
+            if (len < 255U) {
+                m_proj_data.push_back(static_cast<uint8_t>(len));
+            } else {
+                m_proj_data.push_back(255U);
+                m_proj_data.push_back(static_cast<uint8_t>(len >> 8));
+                m_proj_data.push_back(static_cast<uint8_t>(len & 0xFFU));
+            }
+        }
+        m_proj_data.insert(m_proj_data.end(), it.field.data, it.field.data + len);
+    }
+
+    struct fds_drec proj_rec;
+    proj_rec.data = m_proj_data.data();
+    proj_rec.size = static_cast<uint16_t>(m_proj_data.size());
+    proj_rec.tmplt = proj->tmplt.get();
+    proj_rec.snap = rec.snap;
+
+    int rc = fds_drec2json(&proj_rec, flags, m_iemgr, str, size);
+    if (rc < 0 || !proj->opts_head) {
+        return rc;
+    }
+
+    // Records of the auxiliary Template are not Options records (fix the beginning)
+    const size_t entry_len = sizeof(JSON_HEAD_ENTRY) - 1;
+    const size_t opts_len = sizeof(JSON_HEAD_OPTS) - 1;
+    const size_t used = static_cast<size_t>(rc);
+    buffer_reserve(str, size, used + (opts_len - entry_len) + 1);
+    memmove(*str + opts_len, *str + entry_len, used - entry_len + 1);
+    memcpy(*str, JSON_HEAD_OPTS, opts_len);
+    return static_cast<int>(used + (opts_len - entry_len));
+}
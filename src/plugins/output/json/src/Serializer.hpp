@@ -0,0 +1,216 @@
+/**
+ * \file src/plugins/output/json/src/Serializer.hpp
+ * \author agent <agent@local>
+ * \brief Template-compiled JSON serializer (header file)
+ * \date 2026
+ */
+
+/* Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is'', and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#ifndef JSON_SERIALIZER_H
+#define JSON_SERIALIZER_H
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include <libfds.h>
+
+#include "Format.hpp"
+#include "Options.hpp"
+
+/**
+ * \brief Template-compiled JSON serializer
+ *
+ * For each structure of a (Options) Template, a serialization plan is prepared. The plan
+ * consists of pre-rendered keys of fields (e.g. ,"iana:octetDeltaCount":), type specialized
+ * formatters of values and an upper bound of the size of the output. Therefore, a conversion
+ * of a record is only a sequence of copies of keys and formatting of integers, addresses
+ * and timestamps.
+ *
+ * Keys and values are rendered by the generic libfds converter (fds_drec2json()) when the plan
+ * is prepared and the specialized formatters are verified against it, so the output is
+ * identical. Values of short fields formatted differently (e.g. TCP flags, protocols, booleans)
+ * are rendered by the generic converter on their first occurrence and remembered. If the
+ * Template contains fields that cannot be processed this way (e.g. strings, structured data
+ * types, variable-length fields, multiple occurrences of the same field or biflow fields),
+ * the plan is not available and the caller should use the generic converter instead.
+ *
+ * If only selected fields should be converted (see fields_select()), other fields are not
+ * part of plans at all. Therefore, they don't prevent preparation of a plan either (e.g.
+ * a string after the selected fields). If the plan is not available, convert_generic() passes
+ * only selected fields (copied into an auxiliary record) to the generic converter.
+ */
+class Serializer {
+public:
+    /**
+     * \brief Constructor
+     * \param[in] flags Conversion flags of the generic converter (see fds_drec2json())
+     */
+    explicit Serializer(uint32_t flags);
+    /** Destructor */
+    ~Serializer();
+
+    /**
+     * \brief Prepare the serializer for records of a new message
+     *
+     * Templates are identified by pointers only while the message that refers to them exists.
+     * \param[in] iemgr Information Element manager (can be NULL)
+     */
+    void
+    msg_begin(const fds_iemgr_t *iemgr);
+
+    /**
+     * \brief Convert a Data Record to JSON
+     *
+     * The interface is the same as the interface of fds_drec2json() with automatic
+     * reallocation of the buffer.
+     * \param[in]     rec  Data Record
+     * \param[in,out] str  Output buffer (can be reallocated)
+     * \param[in,out] size Size of the output buffer
+     * \return Length of the JSON string (excluding the terminating null byte)
+     * \return #NO_PLAN if the plan of the Template is not available
+     * \throw bad_alloc in case of a memory allocation error
+     */
+    int
+    convert(const struct fds_drec &rec, char **str, size_t *size);
+
+    /**
+     * \brief Convert a Data Record to JSON by the generic converter
+     *
+     * Only selected fields are converted (see fields_select()).
+     * \param[in]     rec   Data Record
+     * \param[in]     flags Conversion flags (see fds_drec2json())
+     * \param[in,out] str   Output buffer (can be reallocated)
+     * \param[in,out] size  Size of the output buffer
+     * \return The same as fds_drec2json()
+     * \throw bad_alloc or runtime_error in case of a memory allocation error
+     */
+    int
+    convert_generic(const struct fds_drec &rec, uint32_t flags, char **str, size_t *size);
+
+    /**
+     * \brief Select fields to convert
+     *
+     * Names of Information Elements are resolved by the Information Element manager of each
+     * message (see msg_begin()). Reverse fields of selected Biflow fields are selected too.
+     * \param[in] sel   Type of the selection
+     * \param[in] names Names of listed Information Elements (see field_ids())
+     */
+    void
+    fields_select(field_sel sel, const std::vector<std::string> &names);
+
+    /**
+     * \brief Get identifiers of an Information Element
+     *
+     * The name is either a name of a known Information Element (e.g. "iana:octetDeltaCount")
+     * or an identifier in the form "en<PEN>:id<ID>" (see numericNames). If the element has
+     * a reverse element (Biflow), its identifier is added too.
+     * \param[in]  iemgr Information Element manager (can be NULL)
+     * \param[in]  name  Name of the Information Element
+     * \param[out] ids   Identifiers (Private Enterprise Number, ID) to append
+     * \return True on success, false if the element is unknown
+     */
+    static bool
+    field_ids(const fds_iemgr_t *iemgr, const std::string &name,
+        std::vector<std::pair<uint32_t, uint16_t>> &ids);
+
+    /** Return code of convert() if the record must be converted by the generic converter */
+    static constexpr int NO_PLAN = -1;
+
+private:
+    class FieldRender;
+    struct Field;
+    struct Plan;
+    struct Projection;
+
+    /** Conversion flags of the generic converter                                            */
+    uint32_t m_flags;
+    /** Information Element manager used to prepare plans                                    */
+    const fds_iemgr_t *m_iemgr = nullptr;
+    /** Plans of Template structures (raw Templates are keys)                                */
+    std::unordered_map<std::string, std::unique_ptr<Plan>> m_plans;
+    /** Plans of Templates of the current message                                            */
+    std::vector<std::pair<const struct fds_template *, Plan *>> m_msg_plans;
+    /** Value rendered by the generic converter                                              */
+    std::string m_value;
+    /** Formatter of timestamps (caches the date and time of the last timestamp)             */
+    TimeFormatter m_time;
+
+    /** Type of the selection of fields                                                      */
+    field_sel m_sel = field_sel::ALL;
+    /** Names of listed Information Elements                                                 */
+    std::vector<std::string> m_sel_names;
+    /** Sorted identifiers of listed Information Elements (resolved by the current manager)  */
+    std::vector<std::pair<uint32_t, uint16_t>> m_sel_ids;
+    /** Projections of Template structures for the generic converter (raw Templates are keys) */
+    std::unordered_map<std::string, std::unique_ptr<Projection>> m_projs;
+    /** Projections of Templates of the current message                                      */
+    std::vector<std::pair<const struct fds_template *, Projection *>> m_msg_projs;
+    /** Data of the projected record                                                         */
+    std::vector<uint8_t> m_proj_data;
+
+    // Find or prepare a plan of a Template
+    Plan *
+    plan_get(const struct fds_template *tmplt);
+    // Prepare a plan of a Template
+    std::unique_ptr<Plan>
+    plan_create(const struct fds_template *tmplt);
+    // Prepare a field of a plan
+    bool
+    field_create(const struct fds_tfield &tfield, enum fds_template_type type, Plan &plan);
+    // Verify a specialized formatter of a field against the generic converter
+    bool
+    field_verify(const Field &field, FieldRender &render);
+    // Format a value of a field by its specialized formatter
+    char *
+    field_format(char *pos, const Field &field, const uint8_t *data);
+    // Get a value of a field rendered by the generic converter
+    const std::string &
+    field_value(Field &field, const uint8_t *data);
+    // Check if a field is selected
+    bool
+    field_selected(const struct fds_tfield &tfield) const;
+    // Find or prepare a projection of a Template
+    Projection *
+    proj_get(const struct fds_template *tmplt);
+    // Prepare a projection of a Template
+    std::unique_ptr<Projection>
+    proj_create(const struct fds_template *tmplt);
+};
+
+#endif // JSON_SERIALIZER_H
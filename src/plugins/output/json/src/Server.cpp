@@ -39,31 +39,43 @@
 
 #include "Server.hpp"
 #include <stdexcept>
+#include <cerrno>
+#include <cinttypes>
 #include <cstring>
 
+#include <fcntl.h>
 #include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
 #include <sys/types.h>
 #include <sys/socket.h>
-#include <sys/time.h>
+#include <sys/uio.h>
 #include <netdb.h>
 #include <arpa/inet.h>
 
 /** How many pending connections queue will hold */
 #define BACKLOG (10)
+/** Maximum number of chunks sent to a client by a single system call */
+#define IOV_CNT (64)
+/** Maximum number of events processed by a single call of epoll_wait() */
+#define EVENTS_CNT (64)
+/** Interval of statistics about slow clients (milliseconds) */
+#define STATS_INTERVAL (1000)
 
 /**
  * \brief Class constructor
  *
  * \param[in] cfg Configuration
  * \param[in] ctx Instance context
- * Parse configuration, create and bind server's socket and create acceptor's
- * thread
+ * Parse configuration, create and bind server's socket and create the I/O thread
  */
-Server::Server(const struct cfg_server &cfg, ipx_ctx_t *ctx) : Output(cfg.name, ctx)
+Server::Server(const struct cfg_server &cfg, ipx_ctx_t *ctx) : Output(cfg.name, ctx),
+    _stop(false), _clients_cnt(0)
 {
     std::string port = std::to_string(cfg.port);
     _non_blocking = !cfg.blocking;
-    _acceptor = NULL;
+    _slow = cfg.slow;
+    _buffer_max = cfg.client_buffer;
 
     int serv_fd;
     int ret_val;
@@ -84,7 +96,8 @@ Server::Server(const struct cfg_server &cfg, ipx_ctx_t *ctx) : Output(cfg.name,
     }
 
     for (iter = servinfo; iter != NULL; iter = iter->ai_next) {
-        serv_fd = socket(iter->ai_family, iter->ai_socktype, iter->ai_protocol);
+        serv_fd = socket(iter->ai_family, iter->ai_socktype | SOCK_NONBLOCK | SOCK_CLOEXEC,
+            iter->ai_protocol);
         if ((serv_fd) == -1) {
             continue;
         }
@@ -117,261 +130,521 @@ Server::Server(const struct cfg_server &cfg, ipx_ctx_t *ctx) : Output(cfg.name,
         close(serv_fd);
         throw std::runtime_error("(Server output) Failed to initialize server (listen() failed).");
     }
+    _listen_fd = serv_fd;
+
+    // Prepare event notification of the I/O thread
+    struct epoll_event ev;
+    memset(&ev, 0, sizeof(ev));
+    _event_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    _epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    bool epoll_ok = (_event_fd != -1 && _epoll_fd != -1);
+
+    if (epoll_ok) {
+        ev.events = EPOLLIN;
+        ev.data.ptr = &_listen_fd;
+        epoll_ok = (epoll_ctl(_epoll_fd, EPOLL_CTL_ADD, _listen_fd, &ev) == 0);
+    }
 
-    // Create thread
-    _acceptor = new acceptor_t;
-    _acceptor->ctx = ctx; // Only for log
-    _acceptor->socket_fd = serv_fd;
-    _acceptor->new_clients_ready = false;
-    _acceptor->stop = false;
-
-    if (pthread_mutex_init(&_acceptor->mutex, NULL) != 0) {
-        delete _acceptor;
-        close(serv_fd);
-        throw std::runtime_error("(Server output) Mutex initialization failed!");
+    if (epoll_ok) {
+        ev.events = EPOLLIN;
+        ev.data.ptr = &_event_fd;
+        epoll_ok = (epoll_ctl(_epoll_fd, EPOLL_CTL_ADD, _event_fd, &ev) == 0);
     }
 
-    if (pthread_create(&_acceptor->thread, NULL, &Server::thread_accept,_acceptor) != 0) {
-        pthread_mutex_destroy(&_acceptor->mutex);
-        delete _acceptor;
-        close(serv_fd);
-        throw std::runtime_error("(Server output) Acceptor thread failed");
+    if (!epoll_ok) {
+        const char *err_str;
+        ipx_strerror(errno, err_str);
+        const std::string err_msg = err_str;
+        if (_epoll_fd != -1) {
+            close(_epoll_fd);
+        }
+        if (_event_fd != -1) {
+            close(_event_fd);
+        }
+        close(_listen_fd);
+        throw std::runtime_error("(Server output) Failed to initialize event notification ("
+            + err_msg + ")");
+    }
+
+    // Create thread
+    try {
+        _thread = std::thread(&Server::thread_io, this);
+    } catch (const std::system_error &ex) {
+        close(_epoll_fd);
+        close(_event_fd);
+        close(_listen_fd);
+        throw std::runtime_error("(Server output) I/O thread failed");
     }
 }
 
 /**
  * \brief Class destructor
  *
- * Close all sockets and stop and destroy the acceptor.
+ * Stop the I/O thread and close all sockets.
  */
 Server::~Server()
 {
-    // Disconnect connected clients
-    for (auto &client : _clients) {
-        close(client.socket);
-    }
-
-    // Stop and destroy acceptor's thread
-    if (_acceptor) {
-        _acceptor->stop = true;
-        pthread_join(_acceptor->thread, NULL);
-        pthread_mutex_destroy(&_acceptor->mutex);
+    _stop = true;
+    wakeup();
+    _thread.join(); // All clients are disconnected by the thread
 
-        close(_acceptor->socket_fd);
-
-        for (auto &client : _acceptor->new_clients) {
-            close(client.socket);
-        }
+    close(_epoll_fd);
+    close(_event_fd);
+    close(_listen_fd);
+}
 
-        delete _acceptor;
+/**
+ * \brief Wake up the I/O thread
+ */
+void
+Server::wakeup()
+{
+    const uint64_t value = 1;
+    if (write(_event_fd, &value, sizeof(value)) == -1 && errno != EAGAIN) {
+        const char *err_str;
+        ipx_strerror(errno, err_str);
+        IPX_CTX_ERROR(_ctx, "(Server output) Failed to wake up the I/O thread (%s)", err_str);
     }
 }
 
 /**
- * \brief Acceptor's thread function
+ * \brief I/O thread function
  *
- * Wait for new clients and accept them.
- * \param[in,out] context Acceptor's structure with configured server socket
- * \return Nothing
+ * Accept new clients and send queued records to connected clients. A client socket is
+ * watched for writability only if the last transmission was incomplete, otherwise new
+ * records are sent when the thread is woken up by the thread of the instance.
  */
-void *
-Server::thread_accept(void *context)
+void
+Server::thread_io()
 {
-    acceptor_t *acc = (acceptor_t *) context;
-    int ret_val;
-    struct timeval tv;
-    fd_set rfds;
-
-    IPX_CTX_INFO(acc->ctx, "(Server output) Waiting for connections...", '\0');
-
-    while(!acc->stop) {
-        struct sockaddr_storage client_addr;
-        socklen_t sin_size = sizeof(client_addr);
-        int new_fd;
+    struct epoll_event events[EVENTS_CNT];
+    clock::time_point stats_next = clock::now() + std::chrono::milliseconds(STATS_INTERVAL);
 
-        // "select()" configuration
-        FD_ZERO(&rfds);
-        FD_SET(acc->socket_fd, &rfds);
-        tv.tv_sec = 0;
-        tv.tv_usec = 100000;
+    IPX_CTX_INFO(_ctx, "(Server output) Waiting for connections...", '\0');
 
-        ret_val = select(acc->socket_fd + 1, &rfds, NULL, NULL, &tv);
+    while (!_stop) {
+        int ret_val = epoll_wait(_epoll_fd, events, EVENTS_CNT, STATS_INTERVAL);
         if (ret_val == -1) {
             if (errno == EINTR) { // Just interrupted
                 continue;
             }
 
-            char buffer[128];
-            const char *err_str = strerror_r(errno, buffer, 128);
-            IPX_CTX_ERROR(acc->ctx, "(Server output) select() - failed (%s)", err_str);
+            const char *err_str;
+            ipx_strerror(errno, err_str);
+            IPX_CTX_ERROR(_ctx, "(Server output) epoll_wait() - failed (%s)", err_str);
             break;
         }
 
-        if (!FD_ISSET(acc->socket_fd, &rfds)) {
-            // Timeout
-            continue;
+        for (int i = 0; i < ret_val; ++i) {
+            const struct epoll_event &ev = events[i];
+            if (ev.data.ptr == &_listen_fd) {
+                clients_accept();
+                continue;
+            }
+
+            if (ev.data.ptr == &_event_fd) {
+                uint64_t value;
+                if (read(_event_fd, &value, sizeof(value)) == -1 && errno != EAGAIN) {
+                    const char *err_str;
+                    ipx_strerror(errno, err_str);
+                    IPX_CTX_ERROR(_ctx, "(Server output) read() - failed (%s)", err_str);
+                }
+                continue;
+            }
+
+            // Clients are processed below
+            Client *client = static_cast<Client *>(ev.data.ptr);
+            if (ev.events & (EPOLLERR | EPOLLHUP)) {
+                client->failed = true;
+            } else if (ev.events & EPOLLOUT) {
+                client->writable = true;
+            }
         }
 
-        new_fd = accept(acc->socket_fd, (struct sockaddr *) &client_addr, &sin_size);
-        if (new_fd == -1) {
-            char buffer[128];
-            const char *err_str = strerror_r(errno, buffer, 128);
-            IPX_CTX_ERROR(acc->ctx, "(Server output) accept() - failed (%s)", err_str);
-            continue;
+        // Send new records and remove disconnected clients
+        size_t idx = 0;
+        while (idx < _clients.size()) {
+            std::unique_ptr<Client> &client = _clients[idx];
+            bool kill;
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+                kill = client->kill;
+            }
+
+            std::string reason;
+            if (client->failed) {
+                reason = "connection failed";
+            } else if (kill) {
+                reason = "too slow";
+            } else if (!client->armed || client->writable) {
+                // Armed clients wait until the socket is writable
+                client->writable = false;
+                switch (client_send(*client)) {
+                case SEND_OK:
+                    client_arm(*client, false);
+                    break;
+                case SEND_WOULDBLOCK:
+                    client_arm(*client, true);
+                    break;
+                case SEND_FAILED: {
+                    const char *err_str;
+                    ipx_strerror(errno, err_str);
+                    reason = err_str;
+                    }
+                    break;
+                }
+            }
+
+            if (reason.empty()) {
+                ++idx;
+                continue;
+            }
+
+            client_close(*client, reason.c_str());
+            std::lock_guard<std::mutex> lock(_mutex);
+            _clients.erase(_clients.begin() + idx);
+            _clients_cnt = _clients.size();
+            _cv_space.notify_all();
         }
 
-        IPX_CTX_INFO(acc->ctx, "(Server output) Client connected: %s",
-            get_client_desc(client_addr).c_str());
+        const clock::time_point now = clock::now();
+        if (now >= stats_next) {
+            clients_stats();
+            stats_next = now + std::chrono::milliseconds(STATS_INTERVAL);
+        }
+    }
+
+    // Clients cannot be served anymore
+    const char *reason = _stop ? "the output has been stopped" : "the I/O thread has failed";
+    std::lock_guard<std::mutex> lock(_mutex);
+    for (auto &client : _clients) {
+        client_close(*client, reason);
+    }
+    _clients.clear();
+    _clients_cnt = 0;
+    _cv_space.notify_all();
+
+    IPX_CTX_INFO(_ctx, "(Server output) I/O thread terminated.", '\0');
+}
+
+/**
+ * \brief Accept all pending connections
+ *
+ * Further receptions from new sockets are disallowed and the sockets are registered
+ * (without any requested events) into the epoll instance to detect failures.
+ */
+void
+Server::clients_accept()
+{
+    while (true) {
+        std::unique_ptr<Client> client(new Client());
+        socklen_t sin_size = sizeof(client->info);
+
+        client->socket = accept4(_listen_fd, (struct sockaddr *) &client->info, &sin_size,
+            SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (client->socket == -1) {
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                return;
+            }
+            if (errno == EINTR || errno == ECONNABORTED) {
+                continue;
+            }
+
+            const char *err_str;
+            ipx_strerror(errno, err_str);
+            IPX_CTX_ERROR(_ctx, "(Server output) accept() - failed (%s)", err_str);
+            return;
+        }
 
+        client->desc = get_client_desc(client->info);
         // Further receptions from the socket will be disallowed
-        shutdown(new_fd, SHUT_RD);
-        // Add new client to the array of new clients
-        pthread_mutex_lock(&acc->mutex);
-        client_t new_client {client_addr, new_fd, ""};
-        acc->new_clients.push_back(new_client);
-        acc->new_clients_ready = true;
-        pthread_mutex_unlock(&acc->mutex);
+        shutdown(client->socket, SHUT_RD);
+
+        struct epoll_event ev;
+        memset(&ev, 0, sizeof(ev));
+        ev.events = 0;
+        ev.data.ptr = client.get();
+        if (epoll_ctl(_epoll_fd, EPOLL_CTL_ADD, client->socket, &ev) == -1) {
+            const char *err_str;
+            ipx_strerror(errno, err_str);
+            IPX_CTX_ERROR(_ctx, "(Server output) Failed to register client %s (%s)",
+                client->desc.c_str(), err_str);
+            close(client->socket);
+            continue;
+        }
+
+        IPX_CTX_INFO(_ctx, "(Server output) Client connected: %s", client->desc.c_str());
+
+        std::lock_guard<std::mutex> lock(_mutex);
+        _clients.push_back(std::move(client));
+        _clients_cnt = _clients.size();
     }
+}
 
-    IPX_CTX_INFO(acc->ctx, "(Server output) Connection acceptor terminated.", '\0');
-    return NULL;
+/**
+ * \brief Enable/disable notification about writability of a client socket
+ * \param[in] client Client
+ * \param[in] enable Enable/disable
+ */
+void
+Server::client_arm(Client &client, bool enable)
+{
+    if (client.armed == enable) {
+        return;
+    }
+
+    struct epoll_event ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.events = enable ? static_cast<uint32_t>(EPOLLOUT) : 0U;
+    ev.data.ptr = &client;
+
+    if (epoll_ctl(_epoll_fd, EPOLL_CTL_MOD, client.socket, &ev) == -1) {
+        const char *err_str;
+        ipx_strerror(errno, err_str);
+        IPX_CTX_ERROR(_ctx, "(Server output) Failed to modify events of client %s (%s)",
+            client.desc.c_str(), err_str);
+        client.failed = true;
+        return;
+    }
+
+    client.armed = enable;
 }
 
 /**
- * \brief Send a message to a client
+ * \brief Send queued data to a client
  *
- * Sends the message to the client using prepared socket. When non-blocking mode
- * is enabled and only part of the message was sent, the rest of the message is
- * stored in the client's profile.
- * \param[in] data   The message
- * \param[in] len    The length of the message
+ * Queued chunks are sent by a single system call (up to #IOV_CNT chunks at once) until
+ * the queue is empty or the socket is full. Data are sent outside of the critical section,
+ * so the thread of the instance can add new chunks in the meantime.
  * \param[in] client Client
- * \return Transmission status
+ * \return Transmission status (on failure, errno is set appropriately)
  */
 enum Server::Send_status
-Server::msg_send(const char *data, ssize_t len, client_t &client)
+Server::client_send(Client &client)
 {
-    ssize_t now;
-    ssize_t todo = len;
-    const char *ptr = data;
+    struct iovec parts[IOV_CNT];
+
+    while (true) {
+        size_t cnt = 0;
+        {
+            // Chunks are removed only by this thread, so they stay valid after unlocking
+            std::lock_guard<std::mutex> lock(_mutex);
+            size_t offset = client.offset;
+            for (const auto &chunk : client.queue) {
+                if (cnt == IOV_CNT) {
+                    break;
+                }
+                parts[cnt].iov_base = const_cast<char *>(chunk->data.data() + offset);
+                parts[cnt].iov_len = chunk->data.size() - offset;
+                offset = 0;
+                ++cnt;
+            }
+        }
 
-    int flags = MSG_NOSIGNAL;
-    if (_non_blocking) {
-        flags |= MSG_DONTWAIT;
-    }
+        if (cnt == 0) {
+            return SEND_OK;
+        }
 
-    while (todo > 0) {
-        now = send(client.socket, ptr, todo, flags);
+        struct msghdr msg;
+        memset(&msg, 0, sizeof(msg));
+        msg.msg_iov = parts;
+        msg.msg_iovlen = cnt;
 
-        if (now == -1) {
-            if (_non_blocking && (errno == EAGAIN || errno == EWOULDBLOCK)) {
-                // Non-blocking mode
+        ssize_t ret = sendmsg(client.socket, &msg, MSG_NOSIGNAL | MSG_DONTWAIT);
+        if (ret == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                return SEND_WOULDBLOCK;
+            }
+            return SEND_FAILED;
+        }
+
+        // Remove sent chunks
+        std::lock_guard<std::mutex> lock(_mutex);
+        size_t sent = static_cast<size_t>(ret);
+        client.queued -= sent;
+        client.sent_bytes += sent;
+        while (sent > 0) {
+            const size_t rest = client.queue.front()->data.size() - client.offset;
+            if (sent < rest) {
+                client.offset += sent;
                 break;
             }
 
-            // Connection failed
-            char buffer[128];
-            const char *err_str = strerror_r(errno, buffer, 128);
-            IPX_CTX_INFO(_ctx, "(Server output) Client disconnected: %s (%s)",
-                get_client_desc(client.info).c_str(), err_str);
-            return SEND_FAILED;
+            sent -= rest;
+            client.offset = 0;
+            client.queue.pop_front();
         }
 
-        ptr  += now;
-        todo -= now;
+        if (!_non_blocking) {
+            _cv_space.notify_all();
+        }
     }
+}
 
-    if (todo <= 0) {
-        return SEND_OK;
-    }
+/**
+ * \brief Disconnect a client
+ *
+ * Close the socket of the client and print a summary of its statistics.
+ * \param[in] client Client
+ * \param[in] reason Reason of the disconnection
+ */
+void
+Server::client_close(Client &client, const char *reason)
+{
+    IPX_CTX_INFO(_ctx, "(Server output) Client disconnected: %s (%s) - sent %" PRIu64 " bytes, "
+        "dropped %" PRIu64 " records (%" PRIu64 " bytes), max. queued %" PRIu64 " bytes",
+        client.desc.c_str(), reason, client.sent_bytes, client.dropped_recs,
+        client.dropped_bytes, client.max_queued);
+    close(client.socket);
+}
 
-    // Non-blocking mode - (partly) failed to sent the message
-    if (todo == len) {
-        // No part of the message was sent
-        return SEND_WOULDBLOCK;
-    }
+/**
+ * \brief Print statistics of clients with queued records
+ *
+ * The lag of a client is the age of the oldest record that hasn't been sent yet.
+ */
+void
+Server::clients_stats()
+{
+    const clock::time_point now = clock::now();
+    std::lock_guard<std::mutex> lock(_mutex);
 
-    /*
-     * Partly sent. Store the rest of the message for the next transmission to
-     * avoid invalid JSON format. Temporary string should be here, because it is
-     * possible to "data == rest.c_str()".
-     */
-    std::string tmp(ptr, todo);
-    client.msg_rest.assign(tmp);
-    return SEND_WOULDBLOCK;
+    for (const auto &client : _clients) {
+        if (client->queue.empty()) {
+            continue;
+        }
+
+        const auto lag = std::chrono::duration_cast<std::chrono::milliseconds>(
+            now - client->queue.front()->ts);
+        IPX_CTX_DEBUG(_ctx, "(Server output) Client %s: %" PRIu64 " bytes queued, lag %"
+            PRIu64 " ms, dropped %" PRIu64 " records", client->desc.c_str(), client->queued,
+            static_cast<uint64_t>(lag.count()), client->dropped_recs);
+    }
 }
 
 /**
- * \brief Send record to all connected clients
+ * \brief Queue a chunk of records for all connected clients
  *
- * \param[in] str JSON Record
- * \param[in] len Length of the record
+ * The data are copied only once and the chunk is shared by all clients. If there is not
+ * enough space in the queue of a client, the thread waits in blocking mode. In non-blocking
+ * mode, the chunk is dropped for the client or the client is disconnected (based on
+ * the configured policy). Records are never split, so clients always receive valid JSON.
+ * \param[in] data    Records
+ * \param[in] len     Length of the records
+ * \param[in] records Number of the records
  * \return Always #IPX_OK
  */
-int Server::process(const char *str, size_t len)
+int
+Server::push(const char *data, size_t len, size_t records)
 {
-    const char *data = str;
-    ssize_t length = len;
+    if (_clients_cnt == 0 || len == 0) {
+        return IPX_OK;
+    }
 
-    // Are there new clients?
-    if (_acceptor->new_clients_ready) {
-        pthread_mutex_lock(&_acceptor->mutex);
+    std::shared_ptr<Chunk> chunk = std::make_shared<Chunk>();
+    chunk->data.assign(data, len);
+    chunk->records = records;
+
+    std::unique_lock<std::mutex> lock(_mutex);
+    if (!_non_blocking) {
+        // Wait until there is enough space for the chunk in queues of all clients
+        _cv_space.wait(lock, [this, len]() {
+            for (const auto &client : _clients) {
+                if (!client->kill && client->queued > 0 && client->queued + len > _buffer_max) {
+                    return false;
+                }
+            }
+            return true;
+        });
+    }
 
-        _clients.insert(_clients.end(), _acceptor->new_clients.begin(),
-            _acceptor->new_clients.end());
-        _acceptor->new_clients.clear();
+    chunk->ts = clock::now();
+    bool notify = false;
 
-        _acceptor->new_clients_ready = false;
-        pthread_mutex_unlock(&_acceptor->mutex);
-    }
+    for (auto &client : _clients) {
+        if (client->kill) {
+            continue;
+        }
 
-    // Send the message to all clients
-    std::vector<client_t>::iterator iter = _clients.begin();
-    while (iter != _clients.end()) {
-        client_t &client = *iter;
-        enum Send_status ret_val;
-
-        // Send the rest part of the last partly sent message
-        if (_non_blocking && !client.msg_rest.empty()) {
-            std::string &rest = client.msg_rest;
-
-            ret_val = msg_send(rest.c_str(), rest.size(), client);
-            switch (ret_val) {
-            case SEND_OK:
-                // The rest of the message successfully sent
-                rest.clear();
-                break;
-            case SEND_WOULDBLOCK:
-                // Skip, next client...
-                ++iter;
-                continue;
-            case SEND_FAILED:
-                // Close socket and remove client
-                close(client.socket);
-                iter = _clients.erase(iter); // The iterator has new location...
+        if (client->queued > 0 && client->queued + len > _buffer_max) {
+            // Non-blocking mode only
+            const auto lag = std::chrono::duration_cast<std::chrono::milliseconds>(
+                chunk->ts - client->queue.front()->ts);
+
+            if (_slow == slow_policy::DISCONNECT) {
+                IPX_CTX_WARNING(_ctx, "(Server output) Client %s is too slow (%" PRIu64 " bytes "
+                    "queued, lag %" PRIu64 " ms) and it will be disconnected.",
+                    client->desc.c_str(), client->queued, static_cast<uint64_t>(lag.count()));
+                client->kill = true;
+                notify = true;
                 continue;
             }
+
+            if (!client->dropping) {
+                IPX_CTX_WARNING(_ctx, "(Server output) Client %s is too slow (%" PRIu64 " bytes "
+                    "queued, lag %" PRIu64 " ms), new records will be dropped.",
+                    client->desc.c_str(), client->queued, static_cast<uint64_t>(lag.count()));
+                client->dropping = true;
+            }
+            client->dropped_recs += records;
+            client->dropped_bytes += len;
+            continue;
         }
 
-        // Send new message
-        ret_val = msg_send(data, length, client);
-        switch (ret_val) {
-        case SEND_OK:
-        case SEND_WOULDBLOCK:
-            // Next client
-            ++iter;
-            break;
-        case SEND_FAILED:
-            // Close socket and remove client's info
-            close(client.socket);
-            iter = _clients.erase(iter); // The iterator has new location...
-            break;
+        if (client->dropping) {
+            IPX_CTX_INFO(_ctx, "(Server output) Client %s has caught up, %" PRIu64 " records "
+                "dropped so far.", client->desc.c_str(), client->dropped_recs);
+            client->dropping = false;
+        }
+
+        // Wake up the I/O thread only if the client has been idle
+        if (client->queue.empty()) {
+            notify = true;
+        }
+
+        client->queue.push_back(chunk);
+        client->queued += len;
+        if (client->queued > client->max_queued) {
+            client->max_queued = client->queued;
         }
     }
 
+    lock.unlock();
+    if (notify) {
+        wakeup();
+    }
+
     return IPX_OK;
 }
 
+/**
+ * \brief Send record to all connected clients
+ *
+ * \param[in] str JSON Record
+ * \param[in] len Length of the record
+ * \return Always #IPX_OK
+ */
+int Server::process(const char *str, size_t len)
+{
+    return push(str, len, 1);
+}
+
+/**
+ * \brief Send a batch of records to all connected clients
+ *
+ * Records of the batch are stored one after another, therefore, the whole batch is queued
+ * as a single chunk.
+ * \param[in] batch Batch of JSON records
+ * \return Always #IPX_OK
+ */
+int Server::process_batch(const struct Batch &batch)
+{
+    return push(batch.data, batch.len, batch.cnt);
+}
+
 /**
  * \brief Get a brief description about connected client
  * \param[in] client Client network info
@@ -41,15 +41,28 @@
 #define JSON_SERVER_H
 
 #include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <thread>
 #include <vector>
-#include <pthread.h>
 #include <sys/socket.h>
 
+#include "Config.hpp"
 #include "Storage.hpp"
 
 /**
  * \brief The class for server output interface
+ *
+ * Records are sent to connected clients by a dedicated I/O thread. Each batch of records is
+ * copied only once into a shared (reference counted) chunk that is queued for all clients
+ * and every client has its own cursor in the queue. Therefore, a slow client doesn't hold up
+ * the others and the thread of the instance doesn't wait for the network (except in blocking
+ * mode, when it waits until there is enough space in queues of all clients).
  */
 class Server : public Output
 {
@@ -59,47 +72,103 @@ public:
 
     // Send a record to connected clients
     int process(const char *str, size_t len);
+    // Send a batch of records to connected clients
+    int process_batch(const struct Batch &batch);
 private:
+    using clock = std::chrono::steady_clock;
+
     /** Transmission status */
     enum Send_status {
-        SEND_OK,               /**< Successfully sent                             */
-        SEND_WOULDBLOCK,       /**< Message skipped or partly sent                */
+        SEND_OK,               /**< Everything has been sent                      */
+        SEND_WOULDBLOCK,       /**< Partly sent (the socket is full)              */
         SEND_FAILED            /**< Failed                                        */
     };
 
-    /** Structure for connected client */
-    typedef struct client_s {
-        struct sockaddr_storage info; /**< Info about client (IP, port)           */
-        int socket;                   /**< Client's socket                        */
-        std::string msg_rest;         /**< Rest of a message in non-blocking mode */
-    } client_t;
-
-    /** Configuration of acceptor thread */
-    typedef struct acceptor_s {
-        ipx_ctx_t *ctx;                     /**< Instance context (for log only ) */
-        pthread_t thread;					/**< Thread                           */
-        pthread_mutex_t mutex;              /**< Mutex for the array              */
-        std::atomic<bool> stop;             /**< Stop flag for terminating        */
-
-        int socket_fd;                      /**< Server socket                    */
-        std::atomic<bool> new_clients_ready; /**< New clients flag                 */
-        std::vector<client_t> new_clients;  /**< Array of new clients             */
-    } acceptor_t;
-
-    /** Connected client */
-    std::vector<client_t> _clients;
+    /** Shared chunk of records (the same for all clients)                                       */
+    struct Chunk {
+        /** Records                                                                              */
+        std::string data;
+        /** Number of records                                                                    */
+        size_t records;
+        /** Time of the insertion into queues                                                    */
+        clock::time_point ts;
+    };
+
+    /** Connected client                                                                         */
+    struct Client {
+        struct sockaddr_storage info; /**< Info about client (IP, port)                          */
+        int socket;                   /**< Client's socket                                       */
+        std::string desc;             /**< Description of the client (for log only)              */
+
+        /** Chunks to send (protected by the mutex)                                              */
+        std::deque<std::shared_ptr<const Chunk>> queue;
+        /** Number of already sent bytes of the first chunk in the queue                         */
+        size_t offset;
+        /** Total number of queued and not yet sent bytes (protected by the mutex)               */
+        uint64_t queued;
+        /** The client is waiting for the socket to be writable (i.e. EPOLLOUT is registered)    */
+        bool armed;
+        /** The socket is writable (reported by epoll)                                           */
+        bool writable;
+        /** The connection failed (reported by epoll)                                            */
+        bool failed;
+        /** The client is too slow and new records are dropped (protected by the mutex)          */
+        bool dropping;
+        /** The client is too slow and must be disconnected (protected by the mutex)             */
+        bool kill;
+
+        uint64_t sent_bytes;          /**< Number of sent bytes                                  */
+        uint64_t dropped_recs;        /**< Number of dropped records                             */
+        uint64_t dropped_bytes;       /**< Number of dropped bytes                               */
+        uint64_t max_queued;          /**< Maximum number of queued bytes                        */
+    };
+
     /** Socket state */
     bool _non_blocking;
-    /** Acceptor of new clients */
-    acceptor_t *_acceptor;
+    /** Policy for slow clients (non-blocking mode only)                                         */
+    slow_policy _slow;
+    /** Maximum number of queued bytes per client                                                */
+    uint64_t _buffer_max;
+
+    /** Server socket                                                                            */
+    int _listen_fd = -1;
+    /** Event descriptor for waking up the I/O thread                                           */
+    int _event_fd = -1;
+    /** Epoll instance of the I/O thread                                                         */
+    int _epoll_fd = -1;
+
+    /** I/O thread (accepts new clients and sends queued records)                                */
+    std::thread _thread;
+    /** Stop flag of the I/O thread                                                              */
+    std::atomic<bool> _stop;
+    /** Mutex protecting the array of clients and their queues                                   */
+    std::mutex _mutex;
+    /** Condition variable signalled when records have been sent (blocking mode only)            */
+    std::condition_variable _cv_space;
+    /** Connected clients (added and removed only by the I/O thread)                             */
+    std::vector<std::unique_ptr<Client>> _clients;
+    /** Number of connected clients                                                              */
+    std::atomic<size_t> _clients_cnt;
 
     // Brief description of a client
     static std::string get_client_desc(const struct sockaddr_storage &client);
-    // Send data to the client
-    enum Send_status msg_send(const char *data, ssize_t len, client_t &client);
+    // Queue a chunk of records for all clients
+    int push(const char *data, size_t len, size_t records);
+    // Wake up the I/O thread
+    void wakeup();
 
-    // Acceptor's thread function
-    static void *thread_accept(void *context);
+    // I/O thread function
+    void thread_io();
+    // Accept all pending connections
+    void clients_accept();
+    // Send queued data to a client
+    enum Send_status client_send(Client &client);
+    // Enable/disable notification about writability of a client socket
+    void client_arm(Client &client, bool enable);
+    // Disconnect a client
+    void client_close(Client &client, const char *reason);
+    // Print statistics of clients with queued records
+    void clients_stats();
 };
 
 #endif // JSON_SERVER_H
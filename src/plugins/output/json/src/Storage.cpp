@@ -39,113 +39,100 @@
  *
  */
 
+#include <algorithm>
 #include <stdexcept>
 #include <cstring>
 #include <inttypes.h>
+#include <endian.h>
 
 using namespace std;
 #include "Storage.hpp"
 #include <libfds.h>
 
-/** Base size of the conversion buffer                 */
-#define BUFFER_BASE   4096
-/** Size of local conversion buffers (for snprintf)    */
-#define LOCAL_BSIZE   64
+/** Minimal number of Data records of a message converted by a thread  */
+#define SLICE_RECS_MIN 16
 
 Storage::Storage(const ipx_ctx_t *ctx, const struct cfg_format &fmt)
-    : m_ctx(ctx), m_format(fmt)
+    : m_ctx(ctx), m_format(fmt), m_key(fmt.key), m_msg_key(0), m_sampling(nullptr),
+      m_selected(nullptr), m_enrichment(nullptr), m_enrich_values(nullptr)
 {
-    // Prepare the buffer
-    m_record.buffer = nullptr;
-    m_record.size_used = 0;
-    m_record.size_alloc = 0;
-
-    // Prepare conversion flags
-    m_flags = FDS_CD2J_ALLOW_REALLOC; // Allow automatic reallocation of the buffer
-    if (m_format.tcp_flags) {
-        m_flags |= FDS_CD2J_FORMAT_TCPFLAGS;
-    }
-    if (m_format.timestamp) {
-        m_flags |= FDS_CD2J_TS_FORMAT_MSEC;
-    }
-    if (m_format.proto) {
-        m_flags |= FDS_CD2J_FORMAT_PROTO;
-    }
-    if (m_format.ignore_unknown) {
-        m_flags |= FDS_CD2J_IGNORE_UNKNOWN;
+    // Prepare the batch
+    m_batch.ends.reserve(m_format.batch_recs);
+    m_batch.start = {0, 0};
+    m_batch.unflushed = false;
+
+    // Prepare converters and conversion threads
+    m_workers.job_id = 0;
+    m_workers.job_slices = 0;
+    m_workers.pending = 0;
+    m_workers.stop = false;
+    m_workers.msg = nullptr;
+    m_workers.iemgr = nullptr;
+    m_workers.src_addr = nullptr;
+
+    if (m_format.encoding == rec_encoding::AVRO) {
+        m_registry.reset(new Registry(m_format.schema_registry));
     }
-    if (!m_format.white_spaces) {
-        m_flags |= FDS_CD2J_NON_PRINTABLE;
-    }
-    if (m_format.numeric_names) {
-        m_flags |= FDS_CD2J_NUMERIC_ID;
-    }
-    if (m_format.split_biflow) {
-        m_flags |= FDS_CD2J_REVERSE_SKIP;
+
+    for (uint32_t i = 0; i < m_format.threads; ++i) {
+        m_slices.emplace_back(new Slice(m_format, m_registry.get()));
     }
-    if (!m_format.octets_as_uint) {
-        m_flags |= FDS_CD2J_OCTETS_NOINT;
+
+    try {
+        for (size_t i = 1; i < m_slices.size(); ++i) {
+            m_workers.threads.emplace_back(&Storage::worker_main, this, i);
+        }
+    } catch (...) {
+        workers_stop();
+        throw;
     }
 }
 
 Storage::~Storage()
 {
+    workers_stop();
+
+    // Pass remaining records to outputs
+    try {
+        batch_close(true);
+    } catch (...) {
+        IPX_CTX_ERROR(m_ctx, "Failed to pass the last batch of records to outputs!", '\0');
+    }
+
     // Destroy all outputs
     for (Output *output : m_outputs) {
         delete output;
     }
 
-    free(m_record.buffer);
+    ipx_ctx_mem_sub(m_ctx, m_mem);
 }
 
-/**
- * \brief Reserve memory of the conversion buffer
- *
- * Requests that the string capacity be adapted to a planned change in size to a length of up
- * to n characters.
- * \param[in] n Minimal size of the buffer
- * \throws bad_alloc in case of a memory allocation error
- */
 void
-Storage::buffer_reserve(size_t n)
+Storage::output_add(Output *output)
 {
-    if (n <= buffer_alloc()) {
-        // Nothing to do
-        return;
-    }
-
-    // Prepare a new buffer and copy the content
-    const size_t new_size = ((n / BUFFER_BASE) + 1) * BUFFER_BASE;
-    char *new_buffer = (char *) realloc(m_record.buffer, new_size * sizeof(char));
-    if (!new_buffer) {
-        throw std::bad_alloc();
-    }
-
-    m_record.buffer = new_buffer;
-    m_record.size_alloc = new_size;
+    m_outputs.push_back(output);
 }
 
-/**
- * \brief Append the conversion buffer
- * \note
- *   If the buffer length is not sufficient enough, it is automatically reallocated to fit
- *   the string.
- * \param[in] str String to add
- * \throws bad_alloc in case of a memory allocation error
- */
 void
-Storage::buffer_append(const char *str)
+Storage::sampling_enable(ipx_ctx_t *ctx)
 {
-    const size_t len = std::strlen(str) + 1; // "\0"
-    buffer_reserve(buffer_used() + len);
-    memcpy(m_record.buffer + buffer_used(), str, len);
-    m_record.size_used += len - 1;
+    int rc = ipx_ctx_ext_consumer(ctx, "sampling-v1", "selected", &m_sampling);
+    if (rc != IPX_OK) {
+        m_sampling = nullptr;
+        throw std::runtime_error("Failed to register dependency on flags of sampled records "
+            "(code: " + std::to_string(rc) + ")");
+    }
 }
 
 void
-Storage::output_add(Output *output)
+Storage::enrichment_enable(ipx_ctx_t *ctx)
 {
-    m_outputs.push_back(output);
+    int rc = ipx_ctx_ext_consumer(ctx, "enrichment-v1", "prefix", &m_enrichment);
+    if (rc != IPX_OK) {
+        m_enrichment = nullptr;
+        throw std::runtime_error("Failed to register dependency on values of IP prefixes "
+            "(code: " + std::to_string(rc) + ")");
+    }
 }
 
 /**
@@ -185,74 +172,156 @@ Storage::session_src_addr(const struct ipx_session *ipx_desc, char *src_addr, so
     return ret;
 }
 
+
 /**
- * \brief Convert template record to JSON string
+ * \brief Add a converted record to the batch
  *
- * \param[in] tset_iter  (Options) Template Set structure to convert
- * \param[in] set_id     Id of the Template Set
- * \param[in] hdr        Message header of IPFIX record
- * \throw runtime_error  If template parser failed
+ * If the batch reaches the maximum number of records, it's passed to all outputs.
+ * \param[in] data Converted record (ends with a new-line character)
+ * \param[in] len  Length of the record
+ * \param[in] key  Partition key of the record (ignored, if keys are not required)
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_DENIED if an output fails to store the batch
+ * \throws bad_alloc in case of a memory allocation error
  */
-void
-Storage::convert_tmplt_rec(struct fds_tset_iter *tset_iter, uint16_t set_id, const struct fds_ipfix_msg_hdr *hdr)
+int
+Storage::batch_add(const char *data, size_t len, uint64_t key)
 {
-    enum fds_template_type type;
-    void *ptr;
-    if (set_id == FDS_IPFIX_SET_TMPLT) {
-        buffer_append("{\"@type\":\"ipfix.template\",");
-        type = FDS_TYPE_TEMPLATE;
-        ptr = tset_iter->ptr.trec;
-    } else {
-        assert(set_id == FDS_IPFIX_SET_OPTS_TMPLT);
-        buffer_append("{\"@type\":\"ipfix.optionsTemplate\",");
-        type = FDS_TYPE_TEMPLATE_OPTS;
-        ptr = tset_iter->ptr.opts_trec;
+    if (m_batch.ends.empty() && m_format.batch_timeout != 0) {
+        clock_gettime(CLOCK_MONOTONIC, &m_batch.start);
     }
 
-    // Filling the template structure with data from raw packet
-    uint16_t tmplt_size = tset_iter->size;
-    struct fds_template *tmplt;
-    int rc;
-    rc = fds_template_parse(type, ptr, &tmplt_size, &tmplt);
-    if (rc != FDS_OK) {
-        throw std::runtime_error("Parsing failed due to memory allocation error or the format of template is invalid!");
+    m_batch.data.append(data, len);
+    m_batch.ends.push_back(m_batch.data.size());
+    if (m_format.key != part_key::NONE) {
+        m_batch.keys.push_back(key);
+    }
+    if (m_batch.ends.size() < m_format.batch_recs) {
+        return IPX_OK;
     }
 
-    // Printing out the header
-    char field[LOCAL_BSIZE];
-    snprintf(field, LOCAL_BSIZE, "\"ipfix:templateId\":%" PRIu16, tmplt->id);
-    buffer_append(field);
-    if (set_id == FDS_IPFIX_SET_OPTS_TMPLT) {
-        snprintf(field, LOCAL_BSIZE, ",\"ipfix:scopeCount\":%" PRIu16, tmplt->fields_cnt_scope);
-        buffer_append(field);
+    return batch_send();
+}
+
+/**
+ * \brief Add all converted records of a slice to the batch
+ *
+ * Records are added in the original order. Every time the batch reaches the maximum number
+ * of records, it's passed to all outputs.
+ * \param[in] slice Converted slice
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_DENIED if an output fails to store the batch
+ * \throws bad_alloc in case of a memory allocation error
+ */
+int
+Storage::batch_append(const Slice &slice)
+{
+    size_t idx = 0;
+    size_t start = 0;
+
+    while (idx < slice.ends.size()) {
+        if (m_batch.ends.empty() && m_format.batch_timeout != 0) {
+            clock_gettime(CLOCK_MONOTONIC, &m_batch.start);
+        }
+
+        // Copy as many records as the batch can hold
+        const size_t space = m_format.batch_recs - m_batch.ends.size();
+        const size_t cnt = std::min(space, slice.ends.size() - idx);
+        const size_t end = slice.ends[idx + cnt - 1];
+        const size_t offset = m_batch.data.size() - start;
+
+        m_batch.data.append(slice.data, start, end - start);
+        for (size_t i = idx; i < idx + cnt; ++i) {
+            m_batch.ends.push_back(slice.ends[i] + offset);
+        }
+        if (m_format.key != part_key::NONE) {
+            m_batch.keys.insert(m_batch.keys.end(), slice.keys.begin() + idx,
+                slice.keys.begin() + idx + cnt);
+        }
+
+        idx += cnt;
+        start = end;
+        if (m_batch.ends.size() < m_format.batch_recs) {
+            break;
+        }
+
+        if (batch_send() != IPX_OK) {
+            return IPX_ERR_DENIED;
+        }
     }
 
-    // Add detailed info to record
-    if (m_format.detailed_info) {
-        addDetailedInfo(hdr);
+    return IPX_OK;
+}
+
+/**
+ * \brief Pass the batch to all outputs
+ *
+ * The batch is emptied even if an output fails.
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_DENIED if an output fails to store the batch
+ */
+int
+Storage::batch_send()
+{
+    if (m_batch.ends.empty()) {
+        return IPX_OK;
     }
 
-    buffer_append(",\"ipfix:fields\":[");
+    const uint64_t *keys = (m_format.key != part_key::NONE) ? m_batch.keys.data() : nullptr;
+    const struct Batch batch = {m_batch.data.data(), m_batch.data.size(), m_batch.ends.data(),
+        m_batch.ends.size(), keys};
+    int ret = IPX_OK;
+    for (Output *output : m_outputs) {
+        if (output->process_batch(batch) != IPX_OK) {
+            ret = IPX_ERR_DENIED;
+            break;
+        }
+    }
+
+    m_batch.data.clear();
+    m_batch.ends.clear();
+    m_batch.keys.clear();
+    m_batch.unflushed = true;
+    return ret;
+}
+
+/**
+ * \brief Close processing of a message
+ *
+ * If the timeout of the batch is disabled or expired, the batch is passed to all outputs.
+ * Outputs that received a batch since the last flush are flushed.
+ * \param[in] force Pass the batch regardless of its age
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_DENIED if an output fails to store the batch
+ */
+int
+Storage::batch_close(bool force)
+{
+    int ret = IPX_OK;
+
+    if (!m_batch.ends.empty()) {
+        bool expired = force || m_format.batch_timeout == 0;
+        if (!expired) {
+            struct timespec now;
+            clock_gettime(CLOCK_MONOTONIC, &now);
+            const int64_t age = (now.tv_sec - m_batch.start.tv_sec) * INT64_C(1000000)
+                + (now.tv_nsec - m_batch.start.tv_nsec) / 1000;
+            expired = age >= static_cast<int64_t>(m_format.batch_timeout);
+        }
+
+        if (expired) {
+            ret = batch_send();
+        }
+    }
 
-    // Iteration through the fields and converting them to JSON string
-    for (uint16_t i = 0; i < tmplt->fields_cnt_total; i++) {
-        struct fds_tfield current = tmplt->fields[i];
-        if (i != 0) { // Not first field
-            buffer_append(",");
+    if (m_batch.unflushed) {
+        for (Output *output : m_outputs) {
+            output->flush();
         }
-        buffer_append("{");
-        snprintf(field, LOCAL_BSIZE, "\"ipfix:elementId\":%" PRIu16, current.id);
-        buffer_append(field);
-        snprintf(field, LOCAL_BSIZE, ",\"ipfix:enterpriseId\":%" PRIu32, current.en);
-        buffer_append(field);
-        snprintf(field, LOCAL_BSIZE, ",\"ipfix:fieldLength\":%" PRIu16, current.length);
-        buffer_append(field);
-        buffer_append("}");
-    }
-    buffer_append("]}\n");
-
-    // Free allocated memory
-    fds_template_destroy(tmplt);
+        m_batch.unflushed = false;
+    }
+
+    return ret;
 }
 
 /**
@@ -276,181 +345,318 @@ Storage::convert_tset(struct ipx_ipfix_set *set, const struct fds_ipfix_msg_hdr
 
     // Iteration through all (Options) Templates in the Set
     while (fds_tset_iter_next(&tset_iter) == FDS_OK) {
-        // Buffer is empty
-        m_record.size_used = 0;
-
         // Read and print single template
-        convert_tmplt_rec(&tset_iter, set_id, hdr);
+        Converter &conv = m_slices[0]->conv;
+        conv.convert_tmplt_rec(&tset_iter, set_id, hdr);
 
-        // Store it
-        for (Output *output : m_outputs) {
-            if (output->process(m_record.buffer, m_record.size_used) != IPX_OK) {
-                return IPX_ERR_DENIED;
-            }
+        // Store it (the key depends only on the message)
+        if (batch_add(conv.data(), conv.size(), htobe64(m_msg_key)) != IPX_OK) {
+            return IPX_ERR_DENIED;
         }
     }
 
     return IPX_OK;
 }
 
-int
-Storage::records_store(ipx_msg_ipfix_t *msg, const fds_iemgr_t *iemgr)
+/**
+ * \brief Convert Data records of a slice
+ *
+ * Converted records are stored into the slice in the original order.
+ * \note The converter of the slice must be already prepared for the message.
+ * \param[in] slice Slice to convert
+ * \param[in] msg   IPFIX Message of the records
+ * \throws runtime_error if the JSON converter fails
+ * \throws bad_alloc in case of a memory allocation error
+ */
+void
+Storage::convert_slice(Slice &slice, ipx_msg_ipfix_t *msg)
 {
     const auto hdr = (fds_ipfix_msg_hdr*) ipx_msg_ipfix_get_packet(msg);
-    const uint32_t rec_cnt = ipx_msg_ipfix_get_drec_cnt(msg);
-    bool flush = false;
-    int ret = IPX_OK;
-
-    // Extract IPv4/IPv6 address of the exporter, if required
-    m_src_addr = nullptr;
-    char src_addr[INET6_ADDRSTRLEN];
-    if (m_format.detailed_info) {
-        const struct ipx_msg_ctx *msg_ctx = ipx_msg_ipfix_get_ctx(msg);
-        m_src_addr = session_src_addr(msg_ctx->session, src_addr, INET6_ADDRSTRLEN);
-    }
-
-    // Process (Options) Template records if enabled
-    if (m_format.template_info) {
-        struct ipx_ipfix_set *sets;
-        size_t set_cnt;
-        ipx_msg_ipfix_get_sets(msg, &sets, &set_cnt);
+    Converter &conv = slice.conv;
 
-        // Iteration through all sets
-        for (uint32_t i = 0; i < set_cnt; i++) {
-            uint16_t set_id = ntohs(sets[i].ptr->flowset_id);
-            if (set_id != FDS_IPFIX_SET_TMPLT && set_id != FDS_IPFIX_SET_OPTS_TMPLT) {
-                // Skip non-template sets
-                continue;
-            }
+    const bool keys = (m_format.key != part_key::NONE);
 
-            flush = true;
-            if (convert_tset(&sets[i], hdr) != IPX_OK) {
-                ret = IPX_ERR_DENIED;
-                goto endloop;
-            }
-        }
-    }
+    slice.data.clear();
+    slice.ends.clear();
+    slice.keys.clear();
 
-    // Process all data records
-    for (uint32_t i = 0; i < rec_cnt; ++i) {
+    for (uint32_t i = slice.first; i < slice.last; ++i) {
         ipx_ipfix_record *ipfix_rec = ipx_msg_ipfix_get_drec(msg, i);
 
-        // Convert the record
         if (m_format.ignore_options && ipfix_rec->rec.tmplt->type == FDS_TYPE_TEMPLATE_OPTS) {
             // Skip records based on Options Template
             continue;
         }
 
-        flush = true;
+        if (m_sampling != nullptr && (m_selected == nullptr || m_selected[i] == 0)) {
+            // Skip records not selected by the sampling plugin
+            continue;
+        }
 
-        // Convert the record
-        convert(ipfix_rec->rec, iemgr, hdr, false);
+        // Calculate the key before conversion (both directions share the same key)
+        uint64_t key = 0;
+        if (keys) {
+            key = m_key.rec_key(ipfix_rec->rec, m_msg_key);
+            slice.keys.push_back(key);
+        }
 
-        // Store it
-        for (Output *output : m_outputs) {
-            if (output->process(m_record.buffer, m_record.size_used) != IPX_OK) {
-                ret = IPX_ERR_DENIED;
-                goto endloop;
-            }
+        // Values of IP prefixes, if available
+        const struct enrich_values *enrich = nullptr;
+        if (m_enrich_values != nullptr) {
+            enrich = &m_enrich_values[i];
         }
 
+        // Convert the record
+        conv.convert(ipfix_rec->rec, hdr, false, enrich);
+        slice.data.append(conv.data(), conv.size());
+        slice.ends.push_back(slice.data.size());
+
         if (!m_format.split_biflow || (ipfix_rec->rec.tmplt->flags & FDS_TEMPLATE_BIFLOW) == 0) {
             // Record splitting is disabled or it is not a biflow record -> continue
             continue;
         }
 
         // Convert the record from reverse point of view
-        convert(ipfix_rec->rec, iemgr, hdr, true);
-
-        // Store it
-        for (Output *output : m_outputs) {
-            if (output->process(m_record.buffer, m_record.size_used) != IPX_OK) {
-                ret = IPX_ERR_DENIED;
-                goto endloop;
-            }
+        conv.convert(ipfix_rec->rec, hdr, true, enrich);
+        slice.data.append(conv.data(), conv.size());
+        slice.ends.push_back(slice.data.size());
+        if (keys) {
+            slice.keys.push_back(key);
         }
     }
+}
 
-endloop:
-    if (flush) {
-        for (Output *output : m_outputs) {
-            output->flush();
+/**
+ * \brief Main function of a conversion thread
+ *
+ * The thread waits for a new job and converts its slice of the message, if the message
+ * has been split into enough slices.
+ * \param[in] idx Index of the slice of the thread
+ */
+void
+Storage::worker_main(size_t idx)
+{
+    Slice &slice = *m_slices[idx];
+    uint64_t job_id = 0;
+
+    std::unique_lock<std::mutex> lock(m_workers.mutex);
+    while (true) {
+        m_workers.cv_start.wait(lock, [&]() {
+            return m_workers.stop || m_workers.job_id != job_id;
+        });
+        if (m_workers.stop) {
+            break;
+        }
+
+        job_id = m_workers.job_id;
+        if (idx >= m_workers.job_slices) {
+            // Not needed for this message
+            continue;
+        }
+
+        lock.unlock();
+        slice.error = nullptr;
+        try {
+            slice.conv.msg_begin(m_workers.iemgr, m_workers.src_addr);
+            convert_slice(slice, m_workers.msg);
+        } catch (...) {
+            slice.error = std::current_exception();
+        }
+        lock.lock();
+
+        if (--m_workers.pending == 0) {
+            m_workers.cv_done.notify_one();
         }
     }
+}
 
-    return ret;
+/**
+ * \brief Stop and join all conversion threads
+ */
+void
+Storage::workers_stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_workers.mutex);
+        m_workers.stop = true;
+    }
+    m_workers.cv_start.notify_all();
+
+    for (std::thread &thread : m_workers.threads) {
+        thread.join();
+    }
+    m_workers.threads.clear();
 }
 
 /**
- * \brief Add fields with detailed info (export time, sequence number, ODID, message length) to record
+ * \brief Convert Data records of a message and add them to the batch
  *
- * For each record, add detailed information if detailedInfo is enabled.
- * @param[in] hdr   Message header of IPFIX record
+ * If the message is large enough, the records are split into continuous slices converted
+ * in parallel by conversion threads. The thread of the plugin converts the first slice and
+ * after all threads have finished, slices are added to the batch in the original order.
+ * \note The first converter must be already prepared for the message.
+ * \param[in] msg      IPFIX Message to convert
+ * \param[in] iemgr    Information Element manager (can be NULL)
+ * \param[in] src_addr IPv4/IPv6 address of the exporter (can be NULL)
+ * \return Number of converted slices
+ * \throws runtime_error if the JSON converter fails
+ * \throws bad_alloc in case of a memory allocation error
  */
-void
-Storage::addDetailedInfo(const struct fds_ipfix_msg_hdr *hdr)
+size_t
+Storage::convert_drecs(ipx_msg_ipfix_t *msg, const fds_iemgr_t *iemgr, const char *src_addr)
 {
-    // Array for formatting detailed info fields
-    char field[LOCAL_BSIZE];
-    snprintf(field, LOCAL_BSIZE, ",\"ipfix:exportTime\":%" PRIu32, ntohl(hdr->export_time));
-    buffer_append(field);
+    const uint32_t rec_cnt = ipx_msg_ipfix_get_drec_cnt(msg);
+    const size_t slice_cnt = std::max<size_t>(1,
+        std::min<size_t>(m_slices.size(), rec_cnt / SLICE_RECS_MIN));
 
-    snprintf(field, LOCAL_BSIZE, ",\"ipfix:seqNumber\":%" PRIu32, ntohl(hdr->seq_num));
-    buffer_append(field);
+    for (size_t i = 0; i < slice_cnt; ++i) {
+        m_slices[i]->first = static_cast<uint32_t>(uint64_t(rec_cnt) * i / slice_cnt);
+        m_slices[i]->last = static_cast<uint32_t>(uint64_t(rec_cnt) * (i + 1) / slice_cnt);
+    }
 
-    snprintf(field, LOCAL_BSIZE, ",\"ipfix:odid\":%" PRIu32, ntohl(hdr->odid));
-    buffer_append(field);
+    if (slice_cnt > 1) {
+        // Wake up conversion threads
+        {
+            std::lock_guard<std::mutex> lock(m_workers.mutex);
+            m_workers.msg = msg;
+            m_workers.iemgr = iemgr;
+            m_workers.src_addr = src_addr;
+            m_workers.job_slices = slice_cnt;
+            m_workers.pending = slice_cnt - 1;
+            m_workers.job_id++;
+        }
+        m_workers.cv_start.notify_all();
+    }
+
+    Slice &first = *m_slices[0];
+    first.error = nullptr;
+    try {
+        convert_slice(first, msg);
+    } catch (...) {
+        first.error = std::current_exception();
+    }
 
-    snprintf(field, LOCAL_BSIZE, ",\"ipfix:msgLength\":%" PRIu16, ntohs(hdr->length));
-    buffer_append(field);
+    if (slice_cnt > 1) {
+        // The message must not be released before all threads are done
+        std::unique_lock<std::mutex> lock(m_workers.mutex);
+        m_workers.cv_done.wait(lock, [&]() {return m_workers.pending == 0;});
+    }
 
-    if (m_src_addr) {
-        buffer_append(",\"ipfix:srcAddr\":\"");
-        buffer_append(m_src_addr);
-        buffer_append("\"");
+    for (size_t i = 0; i < slice_cnt; ++i) {
+        if (m_slices[i]->error) {
+            std::rethrow_exception(m_slices[i]->error);
+        }
     }
+
+    return slice_cnt;
 }
 
 /**
- * \brief Convert an IPFIX record to JSON string
+ * \brief Report the size of conversion buffers and the batch to memory accounting
  *
- * For each field in the record, try to convert it into JSON format. The record is stored
- * into the local buffer.
- * \param[in] rec     IPFIX record to convert
- * \param[in] iemgr   Manager of Information Elements
- * \param[in] reverse Convert from reverse point of view (affects only biflow records)
- * \throw runtime_error if the JSON converter fails
+ * Buffers only grow, so the size is updated after each message instead of each reallocation.
  */
 void
-Storage::convert(struct fds_drec &rec, const fds_iemgr_t *iemgr, fds_ipfix_msg_hdr *hdr, bool reverse)
+Storage::mem_update()
 {
-    // Convert the record
-    uint32_t flags = m_flags;
-    flags |= reverse ? FDS_CD2J_BIFLOW_REVERSE : 0;
+    size_t total = m_batch.data.capacity() + m_batch.ends.capacity() * sizeof(size_t)
+        + m_batch.keys.capacity() * sizeof(uint64_t);
+    for (const auto &slice : m_slices) {
+        total += slice->conv.mem_size() + slice->data.capacity()
+            + slice->ends.capacity() * sizeof(size_t) + slice->keys.capacity() * sizeof(uint64_t);
+    }
 
-    int rc = fds_drec2json(&rec, flags, iemgr, &m_record.buffer, &m_record.size_alloc);
-    if (rc < 0) {
-        throw std::runtime_error("Conversion to JSON failed (probably a memory allocation error)!");
+    if (total > m_mem) {
+        ipx_ctx_mem_add(m_ctx, total - m_mem);
+    } else if (total < m_mem) {
+        ipx_ctx_mem_sub(m_ctx, m_mem - total);
     }
+    m_mem = total;
+}
 
-    m_record.size_used = size_t(rc);
+int
+Storage::records_store(ipx_msg_ipfix_t *msg, const fds_iemgr_t *iemgr)
+{
+    const auto hdr = (fds_ipfix_msg_hdr*) ipx_msg_ipfix_get_packet(msg);
+    size_t slice_cnt;
+    int ret = IPX_OK;
 
+    // Extract IPv4/IPv6 address of the exporter, if required
+    const char *src_ptr = nullptr;
+    char src_addr[INET6_ADDRSTRLEN];
     if (m_format.detailed_info) {
-        // Remove '}' parenthesis at the end of the record
-        m_record.size_used--;
+        const struct ipx_msg_ctx *msg_ctx = ipx_msg_ipfix_get_ctx(msg);
+        src_ptr = session_src_addr(msg_ctx->session, src_addr, INET6_ADDRSTRLEN);
+    }
+
+    m_slices[0]->conv.msg_begin(iemgr, src_ptr);
+
+    // Common part of partition keys of all records of the message, if required
+    if (m_format.key != part_key::NONE) {
+        const struct ipx_msg_ctx *msg_ctx = ipx_msg_ipfix_get_ctx(msg);
+        m_msg_key = m_key.msg_key(hdr, msg_ctx->session);
+    }
+
+    // Process (Options) Template records if enabled
+    if (m_format.template_info) {
+        struct ipx_ipfix_set *sets;
+        size_t set_cnt;
+        ipx_msg_ipfix_get_sets(msg, &sets, &set_cnt);
+
+        // Iteration through all sets
+        for (uint32_t i = 0; i < set_cnt; i++) {
+            uint16_t set_id = ntohs(sets[i].ptr->flowset_id);
+            if (set_id != FDS_IPFIX_SET_TMPLT && set_id != FDS_IPFIX_SET_OPTS_TMPLT) {
+                // Skip non-template sets
+                continue;
+            }
+
+            if (convert_tset(&sets[i], hdr) != IPX_OK) {
+                ret = IPX_ERR_DENIED;
+                goto endloop;
+            }
+        }
+    }
+
+    // Flags of records selected by the sampling plugin, if required
+    if (m_sampling != nullptr) {
+        void *column;
+        size_t size;
+        if (ipx_ctx_ext_column_get(m_sampling, msg, &column, &size) == IPX_OK) {
+            m_selected = static_cast<const uint8_t *>(column);
+        } else {
+            // The flags haven't been filled, i.e. no record is selected
+            m_selected = nullptr;
+        }
+    }
 
-        // Add detailed info to JSON string
-        addDetailedInfo(hdr);
+    // Values of IP prefixes, if required
+    if (m_enrichment != nullptr) {
+        void *column;
+        size_t size;
+        if (ipx_ctx_ext_column_get(m_enrichment, msg, &column, &size) == IPX_OK
+                && size == sizeof(struct enrich_values)) {
+            m_enrich_values = static_cast<const struct enrich_values *>(column);
+        } else {
+            // The values haven't been filled, i.e. records are converted without them
+            m_enrich_values = nullptr;
+        }
+    }
 
-        // Add template ID to JSON string
-        char field[LOCAL_BSIZE];
-        snprintf(field, LOCAL_BSIZE, ",\"ipfix:templateId\":%" PRIu16, rec.tmplt->id);
-        buffer_append(field);
+    // Process all data records
+    slice_cnt = convert_drecs(msg, iemgr, src_ptr);
+    for (size_t i = 0; i < slice_cnt; ++i) {
+        if (batch_append(*m_slices[i]) != IPX_OK) {
+            ret = IPX_ERR_DENIED;
+            goto endloop;
+        }
+    }
 
-        // Append the record with '}' parenthesis removed before
-        buffer_append("}");
+endloop:
+    if (batch_close(false) != IPX_OK) {
+        ret = IPX_ERR_DENIED;
     }
 
-     // Append the record with end of line character
-     buffer_append("\n");
+    mem_update();
+    return ret;
 }
@@ -42,11 +42,34 @@
 #ifndef JSON_STORAGE_H
 #define JSON_STORAGE_H
 
+#include <condition_variable>
+#include <ctime>
+#include <exception>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <thread>
 #include <vector>
 #include <arpa/inet.h>
 #include <ipfixcol2.h>
-#include "Config.hpp"
+#include "Options.hpp"
+#include "Converter.hpp"
+#include "PartKey.hpp"
+#include "Registry.hpp"
+
+/** Batch of converted JSON records                                                             */
+struct Batch {
+    /** Records (each record ends with a new-line character, not NULL terminated)               */
+    const char *data;
+    /** Total length of all records                                                              */
+    size_t len;
+    /** Offsets of ends of records in the data (i.e. positions after new-line characters)        */
+    const size_t *ends;
+    /** Number of records                                                                        */
+    size_t cnt;
+    /** Partition keys of records in network byte order (NULL, if keys are not required)         */
+    const uint64_t *keys;
+};
 
 /** Base class                                                                                   */
 class Output {
@@ -76,6 +99,28 @@ public:
     virtual int
     process(const char *str, size_t len) = 0;
 
+    /**
+     * \brief Process a batch of converted JSON records
+     *
+     * By default, each record is processed separately by process(). Outputs should
+     * override the function to store or send the whole batch at once.
+     * \param[in] batch Batch of records
+     * \return #IPX_OK on success
+     * \return #IPX_ERR_DENIED in case of a fatal error (the output cannot continue)
+     */
+    virtual int
+    process_batch(const struct Batch &batch)
+    {
+        size_t start = 0;
+        for (size_t i = 0; i < batch.cnt; ++i) {
+            if (process(batch.data + start, batch.ends[i] - start) != IPX_OK) {
+                return IPX_ERR_DENIED;
+            }
+            start = batch.ends[i];
+        }
+        return IPX_OK;
+    };
+
     /**
      * \brief Flush buffered records
      */
@@ -92,36 +137,90 @@ private:
     std::vector<Output *> m_outputs;
     /** Formatting options                                                                       */
     struct cfg_format m_format;
-    /** Conversion flags for libfds converter                                                    */
-    uint32_t m_flags;
-    /** IPv4/IPv6 exporter address of the current message (can be nullptr)                       */
-    const char *m_src_addr = nullptr;
+
+    /** Slice of Data records of a message converted by one thread                               */
+    struct Slice {
+        /** Converter of the thread                                                              */
+        Converter conv;
+        /** Converted records (each record ends with a new-line character)                       */
+        std::string data;
+        /** Offsets of ends of records in the data                                               */
+        std::vector<size_t> ends;
+        /** Partition keys of records (only if required)                                         */
+        std::vector<uint64_t> keys;
+        /** Index of the first Data record of the slice                                          */
+        uint32_t first;
+        /** Index of the Data record after the last record of the slice                          */
+        uint32_t last;
+        /** Conversion failure (rethrown by the thread of the plugin)                            */
+        std::exception_ptr error;
+
+        Slice(const struct cfg_format &fmt, Registry *registry)
+            : conv(fmt, registry), first(0), last(0) {};
+    };
+
+    /** Schema registry shared by converters (only if Avro encoding is configured)             */
+    std::unique_ptr<Registry> m_registry;
+    /** Slices of the current message (the first one is converted by the thread of the plugin)  */
+    std::vector<std::unique_ptr<Slice>> m_slices;
+    /** Calculator of partition keys of records                                                  */
+    PartKey m_key;
+    /** Common part of partition keys of records in the current message                          */
+    uint64_t m_msg_key;
+    /** Extension with flags of records selected by the sampling plugin (NULL, if not required)  */
+    ipx_ctx_ext_t *m_sampling;
+    /** Flags of selected records of the current message (NULL, if no record is selected)       */
+    const uint8_t *m_selected;
+    /** Extension with values of IP prefixes attached by the enrichment plugin (NULL, if not
+     *  required)                                                                              */
+    ipx_ctx_ext_t *m_enrichment;
+    /** Values of IP prefixes of the current message (NULL, if not available)                   */
+    const struct enrich_values *m_enrich_values;
+    /** Size of buffers reported to memory accounting (see ipx_ctx_mem_add())                   */
+    size_t m_mem = 0;
 
     struct {
-        char *buffer;
-        size_t size_alloc;
-        size_t size_used;
-    } m_record; /**< Converted JSON record                                                       */
-
-    // Convert an IPFIX record to a JSON string
-    void convert(struct fds_drec &rec, const fds_iemgr_t *iemgr, struct fds_ipfix_msg_hdr *hdr, bool reverse = false);
-
-    // Remaining buffer size
-    size_t buffer_remain() const {return m_record.size_alloc - m_record.size_used;};
-    // Total size of allocated buffer
-    size_t buffer_alloc() const {return m_record.size_alloc;};
-    // Used buffer size
-    size_t buffer_used() const {return m_record.size_used;};
-    // Append append a string
-    void buffer_append(const char *str);
-    // Reserve memory for a JSON string
-    void buffer_reserve(size_t n);
+        std::vector<std::thread> threads;
+        std::mutex mutex;
+        std::condition_variable cv_start;
+        std::condition_variable cv_done;
+        uint64_t job_id;
+        size_t job_slices;
+        size_t pending;
+        bool stop;
+        ipx_msg_ipfix_t *msg;
+        const fds_iemgr_t *iemgr;
+        const char *src_addr;
+    } m_workers; /**< Conversion threads and description of the current job                    */
+
+    struct {
+        std::string data;
+        std::vector<size_t> ends;
+        std::vector<uint64_t> keys;
+        struct timespec start;
+        bool unflushed;
+    } m_batch; /**< Records waiting to be passed to outputs                                       */
+
+    // Add a converted record to the batch
+    int batch_add(const char *data, size_t len, uint64_t key);
+    // Add all converted records of a slice to the batch
+    int batch_append(const Slice &slice);
+    // Pass the batch to all outputs
+    int batch_send();
+    // Pass the batch to all outputs and flush them, if the batch is old enough
+    int batch_close(bool force);
     // Convert set to JSON string
     int convert_tset(struct ipx_ipfix_set *set, const struct fds_ipfix_msg_hdr *hdr);
-    // Convert template record to a JSON string
-    void convert_tmplt_rec(struct fds_tset_iter *tset_iter, uint16_t set_id, const struct fds_ipfix_msg_hdr *hdr);
-    // Add detailed info (templateId, ODID, seqNum, exportTime) to JSON string
-    void addDetailedInfo(const struct fds_ipfix_msg_hdr *hdr);
+    // Convert Data records of a slice
+    void convert_slice(Slice &slice, ipx_msg_ipfix_t *msg);
+    // Convert Data records of a message by all threads
+    size_t convert_drecs(ipx_msg_ipfix_t *msg, const fds_iemgr_t *iemgr, const char *src_addr);
+    // Main function of a conversion thread
+    void worker_main(size_t idx);
+    // Stop and join all conversion threads
+    void workers_stop();
+    // Report the size of conversion buffers and the batch to memory accounting
+    void mem_update();
     // Get src_addr from IPFIX session
     static const char *session_src_addr(const struct ipx_session *ipx_desc, char *src_addr, socklen_t size);
 public:
@@ -145,6 +244,31 @@ public:
     void
     output_add(Output *output);
 
+    /**
+     * \brief Convert only records selected by the sampling plugin
+     *
+     * Registers dependency on flags of selected records (extension "sampling-v1/selected")
+     * attached by the sampling plugin in the mark mode. Other records are skipped.
+     * \note Can be called only during initialization of the plugin.
+     * \param[in] ctx Plugin context
+     * \throws runtime_error if the dependency cannot be registered
+     */
+    void
+    sampling_enable(ipx_ctx_t *ctx);
+
+    /**
+     * \brief Add values of IP prefixes to converted records
+     *
+     * Registers dependency on values of IP prefixes (extension "enrichment-v1/prefix")
+     * attached by the enrichment plugin. Known values are added to records as "enrich:*"
+     * fields.
+     * \note Can be called only during initialization of the plugin.
+     * \param[in] ctx Plugin context
+     * \throws runtime_error if the dependency cannot be registered
+     */
+    void
+    enrichment_enable(ipx_ctx_t *ctx);
+
     /**
      * \brief Process IPFIX Message records
      *
@@ -134,15 +134,23 @@ Syslog::Syslog(struct cfg_syslog &cfg, ipx_ctx_t *ctx)
 {
     timespec now;
 
-    m_connection_time.tv_sec = 0;
-    m_connection_time.tv_nsec = 0;
     m_is_stream = (m_socket->type() == SyslogType::STREAM);
     m_cnt_sent = 0;
     m_cnt_dropped = 0;
+    m_batch_size = cfg.batch_size;
+    m_flush_interval = cfg.flush_interval;
+    m_pending_time.tv_sec = 0;
+    m_pending_time.tv_nsec = 0;
+    m_pending.reserve(m_batch_size * 1024);
+    m_pending_ends.reserve(m_batch_size);
 
     prepare_hdr(cfg);
     get_time(now);
-    connect(now);
+
+    // The connection is established in the background (records are dropped until then)
+    const int sock_type = m_is_stream ? SOCK_STREAM : SOCK_DGRAM;
+    m_connector.reset(new Connector(m_socket->hostname(), m_socket->port(), sock_type,
+        RECONN_DELAY, ctx, "(Syslog output)"));
 
     m_stats_time = now;
 }
@@ -150,48 +158,90 @@ Syslog::Syslog(struct cfg_syslog &cfg, ipx_ctx_t *ctx)
 /** Destructor */
 Syslog::~Syslog()
 {
+    // Try to send the rest of messages
+    send();
 }
 
 int
 Syslog::process(const char *str, size_t len)
 {
     timespec now;
-    int ret;
+    char timestamp[128];
 
     get_time(now);
     report_stats(now);
 
-    if (!m_socket->is_ready()) {
-        // Not connected -> try to reconnect
-        ret = connect(now);
-        if (ret != IPX_READY) {
-            // Just ignore the record and reconnect later
-            ++m_cnt_dropped;
-            return IPX_OK;
-        }
+    if (!ready()) {
+        // Just ignore the record and reconnect later
+        ++m_cnt_dropped;
+        return IPX_OK;
     }
 
-    ret = send(now, str, len);
-    if (ret < 0) {
-        std::string description = m_socket->description();
-        const char *err_str;
-        ipx_strerror(-ret, err_str);
+    get_timestamp(now, timestamp, sizeof(timestamp));
+    append(timestamp, str, len);
+    return IPX_OK;
+}
 
-        IPX_CTX_ERROR(
-            _ctx,
-            "Connection to '%s' has failed: %s (%d)",
-            description.c_str(),
-            err_str,
-            -ret);
-    } else if (ret == 0) {
-        ++m_cnt_dropped;
-    } else if (ret > 0) {
-        ++m_cnt_sent;
+/**
+ * \brief Process a batch of records
+ *
+ * All records of the batch share the same timestamp and they are sent together with
+ * other waiting messages (up to the batch size per system call).
+ * \param[in] batch Batch of JSON records
+ * \return Always #IPX_OK
+ */
+int
+Syslog::process_batch(const struct Batch &batch)
+{
+    timespec now;
+    char timestamp[128];
+
+    get_time(now);
+    report_stats(now);
+
+    if (!ready()) {
+        // Just ignore the records and reconnect later
+        m_cnt_dropped += batch.cnt;
+        return IPX_OK;
+    }
+
+    get_timestamp(now, timestamp, sizeof(timestamp));
+
+    size_t start = 0;
+    for (size_t i = 0; i < batch.cnt; ++i) {
+        append(timestamp, batch.data + start, batch.ends[i] - start);
+        start = batch.ends[i];
     }
 
     return IPX_OK;
 }
 
+/**
+ * \brief Send waiting messages if the oldest one is waiting for too long
+ *
+ * If the flush interval is zero, messages are always sent.
+ */
+void
+Syslog::flush()
+{
+    if (m_pending_ends.empty()) {
+        return;
+    }
+
+    if (m_flush_interval != 0) {
+        timespec now;
+        get_time(now);
+
+        const int64_t age = (now.tv_sec - m_pending_time.tv_sec) * INT64_C(1000)
+            + (now.tv_nsec - m_pending_time.tv_nsec) / 1000000;
+        if (age < static_cast<int64_t>(m_flush_interval)) {
+            return;
+        }
+    }
+
+    send();
+}
+
 void
 Syslog::prepare_hdr(const struct cfg_syslog &cfg)
 {
@@ -213,78 +263,55 @@ Syslog::prepare_hdr(const struct cfg_syslog &cfg)
     m_hdr_rest += " \xEF\xBB\xBF"; // "BOM" (for UTF-8 string)
 }
 
-int
-Syslog::connect(const timespec &now)
+/**
+ * \brief Check that the socket is connected (pick up a new connection if necessary)
+ *
+ * Connections are established by the background connector, so the function never waits
+ * for the syslog.
+ * \return True if the socket is ready
+ */
+bool
+Syslog::ready()
 {
-    const std::string description = m_socket->description();
-    int ret;
-
-    // Try only one reconnection per second
-    if (m_connection_time.tv_sec + RECONN_DELAY > now.tv_sec) {
-        return IPX_ERR_LIMIT;
+    if (m_socket->is_ready()) {
+        return true;
     }
 
-    m_connection_time = now;
+    // Not connected -> waiting messages are lost
+    m_cnt_dropped += m_pending_ends.size();
+    m_pending.clear();
+    m_pending_ends.clear();
 
-    ret = m_socket->open();
-    if (ret < 0) {
-        const char *err_str;
-        ipx_strerror(-ret, err_str);
-        IPX_CTX_WARNING(
-            _ctx,
-            "(Syslog output) Unable to connect to '%s': %s. Trying again in %d seconds.",
-            description.c_str(),
-            err_str,
-            int(RECONN_DELAY));
-        return IPX_OK;
+    const int fd = m_connector->get();
+    if (fd < 0) {
+        return false;
     }
 
-    IPX_CTX_INFO(_ctx, "(Syslog output) Connected to '%s'.", description.c_str());
-    return IPX_READY;
+    m_socket->attach(fd);
+    return true;
 }
 
-int
-Syslog::send(const timespec &now, const char *str, size_t len)
+/**
+ * \brief Add a message to the waiting messages
+ *
+ * If the number of waiting messages reaches the batch size, all of them are sent.
+ * \param[in] timestamp Syslog timestamp of the message
+ * \param[in] str       JSON record
+ * \param[in] len       Length of the record
+ */
+void
+Syslog::append(const char *timestamp, const char *str, size_t len)
 {
-    char timestamp[128];
-    char length[32];
-    struct msghdr msg;
-    struct iovec iovec[8];
-    int iovec_idx = 0;
+    const size_t ts_len = strlen(timestamp);
 
-    memset(&msg, 0, sizeof(msg));
-    get_timestamp(now, timestamp, sizeof(timestamp));
-
-    if (m_is_stream) {
-        // Add syslog message length before syslog header (will be filled later)
-        iovec[iovec_idx].iov_base = length;
-        iovec_idx++;
+    if (m_pending_ends.empty()) {
+        get_time(m_pending_time);
     }
 
-    iovec[iovec_idx].iov_base = (void *) m_hdr_prio.data();
-    iovec[iovec_idx].iov_len = m_hdr_prio.size();
-    iovec_idx++;
-
-    iovec[iovec_idx].iov_base = timestamp;
-    iovec[iovec_idx].iov_len = strlen(timestamp);
-    iovec_idx++;
-
-    iovec[iovec_idx].iov_base = (void *) m_hdr_rest.data();
-    iovec[iovec_idx].iov_len = m_hdr_rest.size();
-    iovec_idx++;
-
-    iovec[iovec_idx].iov_base = (void *) str;
-    iovec[iovec_idx].iov_len = len;
-    iovec_idx++;
-
     if (m_is_stream) {
-        // Fill real syslog message length
-        size_t length_size;
-        uint32_t sum = 0;
-
-        for (int i = 1; i < iovec_idx; ++i) {
-            sum += iovec[i].iov_len;
-        }
+        // Add syslog message length before syslog header
+        char length[32];
+        uint32_t sum = m_hdr_prio.size() + ts_len + m_hdr_rest.size() + len;
 
         // Convert number to string using very fast libfds function
         sum = htonl(sum);
@@ -292,15 +319,53 @@ Syslog::send(const timespec &now, const char *str, size_t len)
             throw "fds_uint2str_be() has failed";
         }
 
-        length_size = strlen(length);
-        length[length_size++] = ' ';
-        iovec[0].iov_len = length_size;
+        m_pending.append(length);
+        m_pending.push_back(' ');
     }
 
-    msg.msg_iov = iovec;
-    msg.msg_iovlen = iovec_idx;
+    m_pending.append(m_hdr_prio);
+    m_pending.append(timestamp, ts_len);
+    m_pending.append(m_hdr_rest);
+    m_pending.append(str, len);
+    m_pending_ends.push_back(m_pending.size());
+
+    if (m_pending_ends.size() >= m_batch_size) {
+        send();
+    }
+}
+
+/**
+ * \brief Send all waiting messages
+ */
+void
+Syslog::send()
+{
+    const size_t cnt = m_pending_ends.size();
+    if (cnt == 0) {
+        return;
+    }
+
+    int ret = m_socket->write(m_pending.data(), m_pending_ends.data(), cnt);
+    m_pending.clear();
+    m_pending_ends.clear();
+
+    if (ret < 0) {
+        std::string description = m_socket->description();
+        const char *err_str;
+        ipx_strerror(-ret, err_str);
+
+        IPX_CTX_ERROR(
+            _ctx,
+            "Connection to '%s' has failed: %s (%d)",
+            description.c_str(),
+            err_str,
+            -ret);
+        m_cnt_dropped += cnt;
+        return;
+    }
 
-    return m_socket->write(&msg);
+    m_cnt_sent += static_cast<uint64_t>(ret);
+    m_cnt_dropped += cnt - static_cast<size_t>(ret);
 }
 
 void
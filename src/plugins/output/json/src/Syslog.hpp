@@ -42,6 +42,8 @@
 #ifndef JSON_SYSLOG_H
 #define JSON_SYSLOG_H
 
+#include "Config.hpp"
+#include "Connector.hpp"
 #include "Storage.hpp"
 #include "SyslogSocket.hpp"
 
@@ -55,12 +57,16 @@ public:
 
     // Processing records
     int process(const char *str, size_t len);
+    // Processing a batch of records
+    int process_batch(const struct Batch &batch);
+    // Send messages waiting for too long
+    void flush();
 
 private:
     /** Syslog socket                                                             */
     std::unique_ptr<SyslogSocket> m_socket;
-    /** Time of the last connection attempt                                       */
-    struct timespec m_connection_time;
+    /** Background connector of the syslog                                        */
+    std::unique_ptr<Connector> m_connector;
     /** Identification whether connection is stream (i.e. not a datagram)         */
     bool m_is_stream;
     /** Syslog header priority (i.e. part before timestamp)                       */
@@ -68,6 +74,17 @@ private:
     /** Syslog header rest (i.e. after timestamp)                                 */
     std::string m_hdr_rest;
 
+    /** Maximum number of messages sent together                                  */
+    size_t m_batch_size;
+    /** Maximum time for which messages can wait to be sent (milliseconds)        */
+    uint32_t m_flush_interval;
+    /** Messages waiting to be sent (stored one after another)                    */
+    std::string m_pending;
+    /** Offsets of ends of the waiting messages                                   */
+    std::vector<size_t> m_pending_ends;
+    /** Time of the oldest waiting message                                        */
+    struct timespec m_pending_time;
+
     /** Number of sent records                                                    */
     uint64_t m_cnt_sent;
     /** Number of dropped records                                                 */
@@ -76,8 +93,9 @@ private:
     struct timespec m_stats_time;
 
     void prepare_hdr(const struct cfg_syslog &cfg);
-    int connect(const timespec &now);
-    int send(const timespec &now, const char *str, size_t len);
+    bool ready();
+    void append(const char *timestamp, const char *str, size_t len);
+    void send();
     void report_stats(const timespec &now);
 };
 
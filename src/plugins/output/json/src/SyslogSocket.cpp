@@ -39,10 +39,11 @@
  *
  */
 
+#include <algorithm>
 #include <cassert>
+#include <cstring>
 #include <stdexcept>
 
-#include <netdb.h>
 #include <netinet/in.h>
 #include <netinet/tcp.h>
 #include <netinet/udp.h>
@@ -52,47 +53,6 @@
 
 #include "SyslogSocket.hpp"
 
-static int
-inet_socket(const std::string hostname, uint16_t port, int sock_type, int sock_proto)
-{
-    const std::string port_str = std::to_string(port);
-    struct addrinfo *result;
-    struct addrinfo hints;
-    int ret;
-    int fd = -1;
-
-    memset(&hints, 0, sizeof(hints));
-    hints.ai_family = AF_UNSPEC;
-    hints.ai_socktype = sock_type;
-    hints.ai_protocol = sock_proto;
-    hints.ai_flags = AI_NUMERICSERV;
-
-    ret = getaddrinfo(hostname.c_str(), port_str.c_str(), &hints, &result);
-    if (ret != 0) {
-        return -EHOSTUNREACH;
-    }
-
-    for (struct addrinfo *ptr = result; ptr != nullptr; ptr = ptr->ai_next) {
-        // Try to create a new socket and connect
-        fd = socket(ptr->ai_family, ptr->ai_socktype, ptr->ai_protocol);
-        if (fd < 0) {
-            continue;
-        }
-
-        if (::connect(fd, ptr->ai_addr, ptr->ai_addrlen) < 0) {
-            ::close(fd);
-            fd = -1;
-            continue;
-        }
-
-        // Success
-        break;
-    }
-
-    freeaddrinfo(result);
-    return (fd < 0) ? -EHOSTUNREACH : fd;
-}
-
 static size_t
 msghdr_size(const struct msghdr *msg)
 {
@@ -279,18 +239,33 @@ send_stream_blocking(int fd, struct msghdr *msg)
 }
 
 static int
-send_datagram_nonblocking(int fd, struct msghdr *msg)
+send_datagrams_nonblocking(int fd, struct mmsghdr *msgs, size_t cnt)
 {
-    ssize_t ret = sendmsg(fd, msg, MSG_NOSIGNAL | MSG_DONTWAIT);
-    if (ret < 0) {
-        if (errno == EWOULDBLOCK || errno == EAGAIN) {
-            return 0;
+    size_t done = 0;
+
+    while (done < cnt) {
+        // The number of messages per call is limited by the kernel
+        const unsigned int now = static_cast<unsigned int>(std::min<size_t>(cnt - done,
+            UIO_MAXIOV));
+        int ret = sendmmsg(fd, &msgs[done], now, MSG_NOSIGNAL | MSG_DONTWAIT);
+        if (ret < 0) {
+            if (errno == EWOULDBLOCK || errno == EAGAIN) {
+                break;
+            }
+
+            return -errno;
         }
 
-        return -errno;
+        done += static_cast<size_t>(ret);
     }
 
-    return 1;
+    return static_cast<int>(done);
+}
+
+SyslogSocket::SyslogSocket(const std::string &hostname, uint16_t port)
+    : m_hostname(hostname)
+    , m_port(port)
+{
 }
 
 SyslogSocket::~SyslogSocket()
@@ -298,6 +273,18 @@ SyslogSocket::~SyslogSocket()
     close();
 }
 
+void SyslogSocket::attach(int fd) noexcept
+{
+    close();
+    m_fd = fd;
+}
+
+std::string
+SyslogSocket::description() const
+{
+    return m_hostname + ":" + std::to_string(m_port);
+}
+
 void SyslogSocket::close() noexcept
 {
     if (m_fd < 0) {
@@ -309,83 +296,62 @@ void SyslogSocket::close() noexcept
 }
 
 TcpSyslogSocket::TcpSyslogSocket(const std::string &hostname, uint16_t port, bool blocking)
-    : SyslogSocket()
-    , m_hostname(hostname)
-    , m_port(port)
+    : SyslogSocket(hostname, port)
     , m_blocking(blocking)
 {
 }
 
-int
-TcpSyslogSocket::open()
+void
+TcpSyslogSocket::attach(int fd) noexcept
 {
-    int ret;
-
+    // The rest of a partly sent message belongs to the previous connection
     m_buffer.clear();
-    close();
-
-    ret = inet_socket(m_hostname, m_port, SOCK_STREAM, 0);
-    if (ret < 0) {
-        return ret;
-    }
-
-    m_fd = ret;
-    return 0;
+    SyslogSocket::attach(fd);
 }
 
 int
-TcpSyslogSocket::write(struct msghdr *msg)
+TcpSyslogSocket::write(const char *data, const size_t *ends, size_t cnt)
 {
+    struct iovec iovec;
+    struct msghdr msg;
     int ret = -EINVAL;
 
     if (!is_ready()) {
         return ret;
     }
 
+    if (cnt == 0) {
+        return 0;
+    }
+
+    // Messages are stored one after another, so they are sent together
+    memset(&msg, 0, sizeof(msg));
+    iovec.iov_base = (void *) data;
+    iovec.iov_len = ends[cnt - 1];
+    msg.msg_iov = &iovec;
+    msg.msg_iovlen = 1;
+
     if (m_blocking) {
-        ret = send_stream_blocking(m_fd, msg);
+        ret = send_stream_blocking(m_fd, &msg);
     } else {
-        ret = send_stream_nonblocking(m_fd, m_buffer, msg);
+        ret = send_stream_nonblocking(m_fd, m_buffer, &msg);
     }
 
     if (ret < 0) {
         close();
+        return ret;
     }
 
-    return ret;
-}
-
-std::string
-TcpSyslogSocket::description()
-{
-    return m_hostname + ":" + std::to_string(m_port);
+    return (ret > 0) ? static_cast<int>(cnt) : 0;
 }
 
 UdpSyslogSocket::UdpSyslogSocket(const std::string &hostname, uint16_t port)
-    : SyslogSocket()
-    , m_hostname(hostname)
-    , m_port(port)
-{
-}
-
-int
-UdpSyslogSocket::open()
+    : SyslogSocket(hostname, port)
 {
-    int ret;
-
-    close();
-
-    ret = inet_socket(m_hostname, m_port, SOCK_DGRAM, 0);
-    if (ret < 0) {
-        return ret;
-    }
-
-    m_fd = ret;
-    return 0;
 }
 
 int
-UdpSyslogSocket::write(struct msghdr *msg)
+UdpSyslogSocket::write(const char *data, const size_t *ends, size_t cnt)
 {
     int ret = -EINVAL;
 
@@ -393,16 +359,24 @@ UdpSyslogSocket::write(struct msghdr *msg)
         return ret;
     }
 
-    ret = send_datagram_nonblocking(m_fd, msg);
+    // Each message is sent as a separate datagram
+    m_iovs.resize(cnt);
+    m_msgs.resize(cnt);
+    memset(m_msgs.data(), 0, cnt * sizeof(struct mmsghdr));
+
+    size_t start = 0;
+    for (size_t i = 0; i < cnt; ++i) {
+        m_iovs[i].iov_base = (void *) (data + start);
+        m_iovs[i].iov_len = ends[i] - start;
+        m_msgs[i].msg_hdr.msg_iov = &m_iovs[i];
+        m_msgs[i].msg_hdr.msg_iovlen = 1;
+        start = ends[i];
+    }
+
+    ret = send_datagrams_nonblocking(m_fd, m_msgs.data(), cnt);
     if (ret < 0) {
         close();
     }
 
     return ret;
 }
-
-std::string
-UdpSyslogSocket::description()
-{
-    return m_hostname + ":" + std::to_string(m_port);
-}
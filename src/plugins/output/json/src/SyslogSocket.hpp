@@ -44,6 +44,10 @@
 
 #include <cstdint>
 #include <string>
+#include <vector>
+
+#include <sys/socket.h>
+#include <sys/uio.h>
 
 /**
  * \brief Syslog connection type.
@@ -56,7 +60,7 @@ enum class SyslogType {
 /** \brief Base class of syslog connection. */
 class SyslogSocket {
 public:
-    SyslogSocket() = default;
+    SyslogSocket(const std::string &hostname, uint16_t port);
     virtual ~SyslogSocket();
 
     SyslogSocket(const SyslogSocket &other) = delete;
@@ -73,33 +77,48 @@ public:
      */
     virtual SyslogType type() const noexcept = 0;
     /**
-     * \brief Open socket and connect to the syslog
-     * \return 0 on success. Otherwise returns a negative errno-like code.
+     * \brief Use a new socket connected to the syslog
+     *
+     * The previous socket (if any) is closed. Sockets are connected by a connector of
+     * the output (see Connector), so a dead syslog doesn't block the caller.
+     * \param[in] fd Connected socket (the object becomes its owner)
      */
-    virtual int open() = 0;
+    virtual void attach(int fd) noexcept;
     /**
      * \brief Close socket.
      * \note No action is performed, if the socket is already closed.
      */
     void close() noexcept;
     /**
-     * \brief Write a message to the syslog socket.
+     * \brief Write messages to the syslog socket.
      *
-     * The function might change \p msg by updating msg_iov, iov_base and iov_len
-     * variables.
+     * Messages are stored one after another in \p data and they are sent by as few
+     * system calls as possible.
      *
-     * \param[in] msg Vector of message parts to send.
-     * \return 1 if the message has been send (might be still partly stored in buffer);
-     * \return 0 if the connection would block and the message cannot be sent.
+     * \param[in] data Messages to send
+     * \param[in] ends Offsets of ends of messages in the data
+     * \param[in] cnt  Number of messages
+     * \return Number of sent messages (might be still partly stored in buffer). If the
+     *   connection would block, the rest of messages cannot be sent.
      * \return a negative errno-like code if the connection is broken.
      */
-    virtual int write(struct msghdr *msg) = 0;
+    virtual int write(const char *data, const size_t *ends, size_t cnt) = 0;
     /**
      * \brief Get connection description (for logging)
      */
-    virtual std::string description() = 0;
+    std::string description() const;
+    /**
+     * \brief Get hostname or IP address of the syslog
+     */
+    const std::string &hostname() const noexcept { return m_hostname; };
+    /**
+     * \brief Get port of the syslog
+     */
+    uint16_t port() const noexcept { return m_port; };
 
 protected:
+    std::string m_hostname;
+    uint16_t m_port;
     int m_fd = -1;
 };
 
@@ -110,13 +129,10 @@ public:
     ~TcpSyslogSocket() = default;
 
     SyslogType type() const noexcept override { return SyslogType::STREAM; };
-    int open() override;
-    int write(struct msghdr *msg) override;
-    std::string description() override;
+    void attach(int fd) noexcept override;
+    int write(const char *data, const size_t *ends, size_t cnt) override;
 
 private:
-    std::string m_hostname;
-    uint16_t m_port;
     std::string m_buffer;
     bool m_blocking;
 };
@@ -128,13 +144,11 @@ public:
     ~UdpSyslogSocket() = default;
 
     SyslogType type() const noexcept override { return SyslogType::DATAGRAM; };
-    int open() override;
-    int write(struct msghdr *msg) override;
-    std::string description() override;
+    int write(const char *data, const size_t *ends, size_t cnt) override;
 
 private:
-    std::string m_hostname;
-    uint16_t m_port;
+    std::vector<struct iovec> m_iovs;
+    std::vector<struct mmsghdr> m_msgs;
 };
 
 #endif // JSON_SYSLOG_SOCKET_H
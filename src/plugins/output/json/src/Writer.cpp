@@ -0,0 +1,345 @@
+/**
+ * \file src/plugins/output/json/src/Writer.cpp
+ * \author agent <agent@local>
+ * \brief Buffered file writer with a background I/O thread (source file)
+ * \date 2026
+ */
+
+/* Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is'', and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <stdexcept>
+#include <system_error>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "Writer.hpp"
+
+/** Size of a buffer                                                    */
+#define WRITER_BUFFER_SIZE (4U * 1024U * 1024U)
+/** Alignment of buffers, file offsets and sizes of direct writes       */
+#define WRITER_ALIGN 4096U
+/** Maximum age of the current buffer when the output is flushed (sec.) */
+#define WRITER_MAX_AGE 1
+
+Writer::Writer(ipx_ctx_t *ctx, bool direct, sync_policy sync)
+    : m_ctx(ctx), m_direct(direct), m_sync(sync)
+{
+    m_current_ts = {0, 0};
+    m_job.data = nullptr;
+    m_job.len = 0;
+    m_job.offset = 0;
+    m_job.busy = false;
+    m_job.stop = false;
+
+    m_buffers[0].data = m_buffers[1].data = nullptr;
+    for (Buffer &buffer : m_buffers) {
+        void *mem;
+        if (posix_memalign(&mem, WRITER_ALIGN, WRITER_BUFFER_SIZE) != 0) {
+            free(m_buffers[0].data);
+            throw std::bad_alloc();
+        }
+        buffer.data = static_cast<char *>(mem);
+        buffer.len = 0;
+    }
+    m_current = &m_buffers[0];
+
+    try {
+        m_thread = std::thread(&Writer::thread_main, this);
+    } catch (std::system_error &ex) {
+        free(m_buffers[0].data);
+        free(m_buffers[1].data);
+        throw std::runtime_error("(File output) Failed to start an I/O thread: "
+            + std::string(ex.what()));
+    }
+}
+
+Writer::~Writer()
+{
+    close();
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_job.stop = true;
+    }
+    m_cv_job.notify_one();
+    m_thread.join();
+
+    free(m_buffers[0].data);
+    free(m_buffers[1].data);
+}
+
+bool
+Writer::open(const std::string &path)
+{
+    const char *err_str;
+    int flags = O_WRONLY | O_CREAT | O_CLOEXEC;
+    if (m_direct) {
+        flags |= O_DIRECT;
+    }
+
+    int fd = ::open(path.c_str(), flags, S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH);
+    if (fd < 0 && m_direct && errno == EINVAL) {
+        // The file system doesn't support direct I/O
+        IPX_CTX_WARNING(m_ctx, "(File output) Direct I/O is not supported for '%s', "
+            "the file is written through the page cache.", path.c_str());
+        flags &= ~O_DIRECT;
+        fd = ::open(path.c_str(), flags, S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH);
+    }
+    if (fd < 0) {
+        ipx_strerror(errno, err_str);
+        IPX_CTX_ERROR(m_ctx, "Failed to create a flow file '%s' (%s).", path.c_str(), err_str);
+        return false;
+    }
+
+    // New data are appended to the end of the file
+    struct stat info;
+    if (fstat(fd, &info) != 0) {
+        ipx_strerror(errno, err_str);
+        IPX_CTX_ERROR(m_ctx, "Failed to get the size of a flow file '%s' (%s).", path.c_str(),
+            err_str);
+        ::close(fd);
+        return false;
+    }
+
+    m_fd = fd;
+    m_fd_direct = (flags & O_DIRECT) != 0;
+    m_path = path;
+    m_offset = static_cast<uint64_t>(info.st_size);
+
+    if (m_fd_direct && (m_offset % WRITER_ALIGN) != 0) {
+        // Direct writes must start at an aligned offset, copy the unaligned end of the file
+        const size_t tail = m_offset % WRITER_ALIGN;
+        const off_t start = static_cast<off_t>(m_offset - tail);
+        const int rfd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        ssize_t rc = -1;
+        if (rfd >= 0) {
+            rc = pread(rfd, m_current->data, tail, start);
+            ::close(rfd);
+        }
+
+        if (rc != static_cast<ssize_t>(tail)) {
+            // Fall back to the page cache
+            fcntl(m_fd, F_SETFL, fcntl(m_fd, F_GETFL) & ~O_DIRECT);
+            m_fd_direct = false;
+        } else {
+            m_current->len = tail;
+            m_offset -= tail;
+        }
+    }
+
+    return true;
+}
+
+void
+Writer::write(const char *data, size_t len)
+{
+    if (m_fd < 0) {
+        return;
+    }
+
+    while (len > 0) {
+        if (m_current->len == 0) {
+            clock_gettime(CLOCK_MONOTONIC_COARSE, &m_current_ts);
+        }
+
+        const size_t size = std::min<size_t>(len, WRITER_BUFFER_SIZE - m_current->len);
+        memcpy(m_current->data + m_current->len, data, size);
+        m_current->len += size;
+        data += size;
+        len -= size;
+
+        if (m_current->len == WRITER_BUFFER_SIZE) {
+            submit(false);
+        }
+    }
+}
+
+void
+Writer::flush()
+{
+    if (m_fd < 0 || m_current->len == 0) {
+        return;
+    }
+
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC_COARSE, &now);
+    if (now.tv_sec - m_current_ts.tv_sec >= WRITER_MAX_AGE) {
+        submit(false);
+    }
+}
+
+void
+Writer::close()
+{
+    if (m_fd < 0) {
+        return;
+    }
+
+    if (m_current->len > 0 && m_fd_direct && (m_current->len % WRITER_ALIGN) != 0) {
+        // The end of the file is not aligned, write the rest through the page cache
+        submit(false);
+        wait_idle();
+        fcntl(m_fd, F_SETFL, fcntl(m_fd, F_GETFL) & ~O_DIRECT);
+        m_fd_direct = false;
+    }
+
+    submit(true);
+    wait_idle();
+
+    if (m_sync != sync_policy::NONE && fdatasync(m_fd) != 0) {
+        const char *err_str;
+        ipx_strerror(errno, err_str);
+        IPX_CTX_ERROR(m_ctx, "(File output) Failed to synchronize a flow file '%s' (%s).",
+            m_path.c_str(), err_str);
+    }
+
+    ::close(m_fd);
+    m_fd = -1;
+    m_fd_direct = false;
+}
+
+/**
+ * \brief Wait until the I/O thread is idle
+ */
+void
+Writer::wait_idle()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_cv_done.wait(lock, [this]() {return !m_job.busy;});
+}
+
+/**
+ * \brief Pass the current buffer to the I/O thread
+ *
+ * The function waits until the previous buffer is written and the other buffer becomes
+ * the current one. In case of direct I/O, only the aligned part of the buffer is written
+ * (unless it's the last one) and the rest is moved to the new current buffer.
+ * \param[in] last No more data will be written (i.e. the file will be closed)
+ */
+void
+Writer::submit(bool last)
+{
+    Buffer *buffer = m_current;
+    size_t len = buffer->len;
+    if (m_fd_direct && !last) {
+        len -= len % WRITER_ALIGN;
+    }
+    if (len == 0) {
+        return;
+    }
+
+    wait_idle();
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_job.data = buffer->data;
+        m_job.len = len;
+        m_job.offset = m_offset;
+        m_job.busy = true;
+    }
+    m_cv_job.notify_one();
+    m_offset += len;
+
+    // The other buffer is not used by the I/O thread anymore
+    m_current = (buffer == &m_buffers[0]) ? &m_buffers[1] : &m_buffers[0];
+    m_current->len = buffer->len - len;
+    memcpy(m_current->data, buffer->data + len, m_current->len);
+    buffer->len = 0;
+}
+
+/**
+ * \brief Main function of the I/O thread
+ */
+void
+Writer::thread_main()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (true) {
+        m_cv_job.wait(lock, [this]() {return m_job.stop || m_job.busy;});
+        if (!m_job.busy) {
+            // Stop request
+            break;
+        }
+
+        lock.unlock();
+        write_data(m_job.data, m_job.len, m_job.offset);
+        lock.lock();
+
+        m_job.busy = false;
+        m_cv_done.notify_one();
+    }
+}
+
+/**
+ * \brief Write data to the file (called by the I/O thread)
+ *
+ * If required by the synchronization policy, the data are synchronized too.
+ * \param[in] data   Data to write
+ * \param[in] len    Length of the data
+ * \param[in] offset Offset in the file
+ */
+void
+Writer::write_data(const char *data, size_t len, uint64_t offset)
+{
+    const char *err_str;
+
+    while (len > 0) {
+        ssize_t rc = pwrite(m_fd, data, len, static_cast<off_t>(offset));
+        if (rc < 0 && errno == EINTR) {
+            continue;
+        }
+        if (rc <= 0) {
+            ipx_strerror(rc < 0 ? errno : EIO, err_str);
+            IPX_CTX_ERROR(m_ctx, "(File output) Failed to write to a flow file '%s' (%s). "
+                "%zu bytes of records have been lost!", m_path.c_str(), err_str, len);
+            return;
+        }
+
+        data += rc;
+        len -= static_cast<size_t>(rc);
+        offset += static_cast<uint64_t>(rc);
+    }
+
+    if (m_sync == sync_policy::BUFFER && fdatasync(m_fd) != 0) {
+        ipx_strerror(errno, err_str);
+        IPX_CTX_ERROR(m_ctx, "(File output) Failed to synchronize a flow file '%s' (%s).",
+            m_path.c_str(), err_str);
+    }
+}
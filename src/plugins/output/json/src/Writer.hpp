@@ -0,0 +1,182 @@
+/**
+ * \file src/plugins/output/json/src/Writer.hpp
+ * \author agent <agent@local>
+ * \brief Buffered file writer with a background I/O thread (header file)
+ * \date 2026
+ */
+
+/* Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is'', and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+#ifndef JSON_WRITER_H
+#define JSON_WRITER_H
+
+#include <condition_variable>
+#include <cstdint>
+#include <ctime>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include <ipfixcol2.h>
+#include "Config.hpp"
+
+/**
+ * \brief Buffered file writer with a background I/O thread
+ *
+ * Data are collected into large aligned buffers. A full buffer is passed to the I/O thread,
+ * which writes it to the file, while the caller fills the other buffer. Therefore, the caller
+ * waits for the disk only if the I/O thread is not able to write a buffer before the other
+ * one is filled.
+ *
+ * If direct I/O is enabled, the file is opened with O_DIRECT flag (i.e. bypassing the page
+ * cache) and only aligned parts of buffers are written. The unaligned remainder is written
+ * without the flag when the file is closed.
+ *
+ * \note The writer is not thread-safe, all functions must be called by the same thread
+ *   (or under the same lock).
+ */
+class Writer {
+public:
+    /**
+     * \brief Constructor
+     * \param[in] ctx    Instance context (only for log!)
+     * \param[in] direct Use direct I/O (O_DIRECT)
+     * \param[in] sync   Synchronization policy of written data
+     * \throw bad_alloc if buffers cannot be allocated
+     * \throw runtime_error if the I/O thread cannot be started
+     */
+    Writer(ipx_ctx_t *ctx, bool direct, sync_policy sync);
+    /** \brief Destructor (the file is closed, if opened)                                        */
+    ~Writer();
+
+    // Disable copy constructors
+    Writer(const Writer &other) = delete;
+    Writer &operator=(const Writer &other) = delete;
+
+    /**
+     * \brief Open a file for appending
+     * \note A previously opened file must be closed.
+     * \param[in] path Path to the file
+     * \return True on success, false otherwise (an error message is logged).
+     */
+    bool
+    open(const std::string &path);
+    /**
+     * \brief Append data to the file
+     * \param[in] data Data to write
+     * \param[in] len  Length of the data
+     */
+    void
+    write(const char *data, size_t len);
+    /**
+     * \brief Pass the current buffer to the I/O thread, if it has not been filled for a while
+     */
+    void
+    flush();
+    /**
+     * \brief Write all remaining data and close the file
+     *
+     * The function waits until all data are written (and synchronized, if required).
+     */
+    void
+    close();
+    /** \brief Check if a file is opened                                                         */
+    bool
+    is_open() const {return m_fd >= 0;};
+
+private:
+    /** Buffer of data                                                                           */
+    struct Buffer {
+        /** Aligned memory                                                                       */
+        char *data;
+        /** Used size                                                                            */
+        size_t len;
+    };
+
+    /** Instance context (only for log!)                                                         */
+    ipx_ctx_t *m_ctx;
+    /** Use direct I/O                                                                           */
+    bool m_direct;
+    /** Synchronization policy                                                                   */
+    sync_policy m_sync;
+
+    /** File descriptor (-1 == closed)                                                           */
+    int m_fd = -1;
+    /** Path of the file (only for log!)                                                         */
+    std::string m_path;
+    /** The file descriptor has O_DIRECT flag                                                    */
+    bool m_fd_direct = false;
+    /** Offset of the current buffer in the file                                                 */
+    uint64_t m_offset = 0;
+
+    /** Buffers (one filled by the caller, one written by the I/O thread)                        */
+    Buffer m_buffers[2];
+    /** Buffer being filled                                                                      */
+    Buffer *m_current;
+    /** Time when the first data were added to the current buffer                                */
+    struct timespec m_current_ts;
+
+    /** I/O thread                                                                               */
+    std::thread m_thread;
+    /** Synchronization of the I/O thread                                                        */
+    std::mutex m_mutex;
+    /** Notification about a new job of the I/O thread                                           */
+    std::condition_variable m_cv_job;
+    /** Notification about a finished job                                                        */
+    std::condition_variable m_cv_done;
+
+    struct {
+        /** Data to write                                                                        */
+        const char *data;
+        /** Length of the data                                                                   */
+        size_t len;
+        /** Offset in the file                                                                   */
+        uint64_t offset;
+        /** The I/O thread is writing the data (protected by the mutex)                          */
+        bool busy;
+        /** Stop flag of the I/O thread (protected by the mutex)                                 */
+        bool stop;
+    } m_job; /**< Job of the I/O thread                                                          */
+
+    // Pass the current buffer to the I/O thread
+    void submit(bool last);
+    // Wait until the I/O thread is idle
+    void wait_idle();
+    // Main function of the I/O thread
+    void thread_main();
+    // Write data to the file
+    void write_data(const char *data, size_t len, uint64_t offset);
+};
+
+#endif // JSON_WRITER_H
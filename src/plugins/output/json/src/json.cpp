@@ -45,12 +45,15 @@
 
 #include "Config.hpp"
 #include "Storage.hpp"
+#include "Serializer.hpp"
 #include "Printer.hpp"
 #include "File.hpp"
 #include "Server.hpp"
 #include "Sender.hpp"
 #include "Kafka.hpp"
+#include "KafkaShards.hpp"
 #include "Syslog.hpp"
+#include "Elastic.hpp"
 
 /** Plugin description */
 IPX_API struct ipx_plugin_info ipx_plugin_info = {
@@ -105,12 +108,20 @@ outputs_initialize(ipx_ctx_t *ctx, Storage *storage, Config *cfg)
     }
 
     for (const auto &kafka : cfg->outputs.kafkas) {
-        storage->output_add(new Kafka(kafka, ctx));
+        if (kafka.shards > 1) {
+            storage->output_add(new KafkaShards(kafka, ctx));
+        } else {
+            storage->output_add(new Kafka(kafka, ctx));
+        }
     }
 
     for (auto &syslog : cfg->outputs.syslogs) {
         storage->output_add(new Syslog(syslog, ctx));
     }
+
+    for (const auto &elastic : cfg->outputs.elastics) {
+        storage->output_add(new Elastic(elastic, ctx));
+    }
 }
 
 int
@@ -121,7 +132,19 @@ ipx_plugin_init(ipx_ctx_t *ctx, const char *params)
         // Create and parse the configuration
         std::unique_ptr<Instance> ptr(new Instance);
         std::unique_ptr<Config> cfg(new Config(params));
+        for (const auto &name : cfg->format.fields) {
+            std::vector<std::pair<uint32_t, uint16_t>> ids;
+            if (!Serializer::field_ids(ipx_ctx_iemgr_get(ctx), name, ids)) {
+                throw std::invalid_argument("Unknown Information Element '" + name + "'");
+            }
+        }
         std::unique_ptr<Storage> storage(new Storage(ctx, cfg.get()->format));
+        if (cfg->format.sampled_only) {
+            storage->sampling_enable(ctx);
+        }
+        if (cfg->format.enrichment) {
+            storage->enrichment_enable(ctx);
+        }
 
         // Initialize outputs
         outputs_initialize(ctx, storage.get(), cfg.get());
@@ -0,0 +1,72 @@
+/**
+ * \file src/plugins/output/parquet/src/Config.hpp
+ * \author agent <agent@local>
+ * \brief Parser of XML configuration (header file)
+ * \date 2026
+ *
+ * Copyright(c) 2026 CESNET z.s.p.o.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef IPFIXCOL2_PARQUET_CONFIG_HPP
+#define IPFIXCOL2_PARQUET_CONFIG_HPP
+
+#include <string>
+#include <libfds.h>
+
+/**
+ * @brief Plugin configuration parser
+ */
+class Config {
+public:
+    /**
+     * @brief Parse configuration of the plugin
+     * @param[in] params XML parameters to parse
+     * @throw runtime_exception on error
+     */
+    Config(const char *params);
+    ~Config() = default;
+
+    enum class calg {
+        NONE,   ///< Do not use compression
+        SNAPPY, ///< Snappy compression
+        GZIP,   ///< GZIP compression
+        LZ4,    ///< LZ4 compression
+        ZSTD    ///< ZSTD compression
+    };
+
+    /// Storage path
+    std::string m_path;
+    /// Compression algorithm
+    calg m_calg;
+    /// Maximum number of records in a record batch (i.e. a row group)
+    uint32_t m_rows;
+    /// Dictionary encoding of low-cardinality fields enabled
+    bool m_dict;
+
+    struct {
+        bool     align;   ///< Enable/disable window alignment
+        uint32_t size;    ///< Time window size
+    } m_window;   ///< Window alignment
+
+private:
+    /// Default window size
+    static const uint32_t WINDOW_SIZE = 300U;
+    /// Default number of records in a record batch
+    static const uint32_t ROWS_DEF = 65536U;
+    /// Maximum number of records in a record batch
+    static const uint32_t ROWS_MAX = 1048576U;
+
+    void
+    set_default();
+    void
+    validate();
+
+    void
+    parse_root(fds_xml_ctx_t *ctx);
+    void
+    parse_dump(fds_xml_ctx_t *ctx);
+};
+
+
+#endif // IPFIXCOL2_PARQUET_CONFIG_HPP
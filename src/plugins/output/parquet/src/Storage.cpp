@@ -0,0 +1,190 @@
+/**
+ * \file src/plugins/output/parquet/src/Storage.cpp
+ * \author agent <agent@local>
+ * \brief Parquet file storage (source file)
+ * \date 2026
+ *
+ * Copyright(c) 2026 CESNET z.s.p.o.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include <cinttypes>
+#include <cstdio>
+#include <cstring>
+#include <sys/stat.h>
+#include <ipfixcol2.h>
+#include <libgen.h>
+#include "Storage.hpp"
+
+/**
+ * @brief Calculate FNV-1a hash of a string
+ * @param[in] str String
+ * @return Hash
+ */
+static uint64_t
+hash_fnv1a(const std::string &str)
+{
+    uint64_t hash = UINT64_C(14695981039346656037);
+    for (const char c : str) {
+        hash ^= static_cast<uint8_t>(c);
+        hash *= UINT64_C(1099511628211);
+    }
+
+    return hash;
+}
+
+Storage::Storage(ipx_ctx_t *ctx, const Config &cfg) : m_ctx(ctx), m_cfg(cfg)
+{
+    // Check if the directory exists
+    struct stat file_info;
+    memset(&file_info, 0, sizeof(file_info));
+    if (stat(m_cfg.m_path.c_str(), &file_info) != 0 || !S_ISDIR(file_info.st_mode)) {
+        throw Parquet_exception("Directory '" + m_cfg.m_path
+            + "' doesn't exist or search permission is denied");
+    }
+}
+
+Storage::~Storage()
+{
+    window_close();
+}
+
+void
+Storage::window_new(time_t ts)
+{
+    // Close the current window if exists
+    window_close();
+
+    const std::string new_window = filename_gen(ts);
+    std::unique_ptr<char, decltype(&free)> new_window_cpy(strdup(new_window.c_str()), &free);
+
+    char *dir2create;
+    if (!new_window_cpy || (dir2create = dirname(new_window_cpy.get())) == nullptr) {
+        throw Parquet_exception("Failed to generate name of an output directory!");
+    }
+
+    if (ipx_utils_mkdir(dir2create, IPX_UTILS_MKDIR_DEF) != FDS_OK) {
+        throw Parquet_exception("Failed to create directory '" + std::string(dir2create) + "'");
+    }
+
+    // Files are created when the first record of the table is stored
+    m_window = new_window;
+}
+
+void
+Storage::window_close()
+{
+    m_cache.clear();
+    m_window.clear();
+
+    auto it = m_tables.begin();
+    while (it != m_tables.end()) {
+        Table &table = *it->second;
+        if (!table.is_open()) {
+            // No records in the window, release the table
+            it = m_tables.erase(it);
+            continue;
+        }
+
+        try {
+            table.close();
+        } catch (const Parquet_exception &ex) {
+            IPX_CTX_ERROR(m_ctx, "%s", ex.what());
+        }
+        ++it;
+    }
+}
+
+void
+Storage::process_msg(ipx_msg_ipfix_t *msg)
+{
+    if (m_window.empty()) {
+        IPX_CTX_DEBUG(m_ctx, "Ignoring IPFIX Message due to undefined output file!", '\0');
+        return;
+    }
+
+    // Templates are valid only during processing of the message
+    m_cache.clear();
+    const struct fds_template *last_tmplt = nullptr;
+    Table *last_table = nullptr;
+
+    const uint32_t rec_cnt = ipx_msg_ipfix_get_drec_cnt(msg);
+    for (uint32_t i = 0; i < rec_cnt; ++i) {
+        ipx_ipfix_record *rec_ptr = ipx_msg_ipfix_get_drec(msg, i);
+
+        // Consecutive records usually share the same Template
+        if (rec_ptr->rec.tmplt != last_tmplt) {
+            last_tmplt = rec_ptr->rec.tmplt;
+            last_table = &table_get(last_tmplt);
+        }
+
+        last_table->append(rec_ptr->rec);
+    }
+}
+
+/**
+ * @brief Get a table of records of a Template
+ *
+ * If the table doesn't exist, it's created. If the file of the table is not opened in the
+ * current window, it's opened.
+ * @param[in] tmplt Template
+ * @return Table
+ * @throw Parquet_exception if the file of the table cannot be opened
+ */
+Table &
+Storage::table_get(const struct fds_template *tmplt)
+{
+    for (const auto &item : m_cache) {
+        if (item.first == tmplt) {
+            return *item.second;
+        }
+    }
+
+    const std::string sig = Table::signature(tmplt);
+    auto it = m_tables.find(sig);
+    if (it == m_tables.end()) {
+        std::unique_ptr<Table> table(new Table(tmplt, m_cfg));
+        it = m_tables.emplace(sig, std::move(table)).first;
+    }
+
+    Table &table = *it->second;
+    if (!table.is_open()) {
+        // Files of different tables are distinguished by the hash of the signature
+        char suffix[32];
+        snprintf(suffix, sizeof(suffix), ".%016" PRIx64 ".parquet", hash_fnv1a(sig));
+        table.open(m_window + suffix);
+    }
+
+    m_cache.emplace_back(tmplt, &table);
+    return table;
+}
+
+/**
+ * @brief Generate a common prefix of output files of a window
+ * @param[in] ts Timestamp of the window
+ * @return Prefix of files
+ * @throw Parquet_exception if the prefix cannot be generated
+ */
+std::string
+Storage::filename_gen(const time_t &ts)
+{
+    const char pattern[] = "%Y/%m/%d/flows.%Y%m%d%H%M%S";
+    constexpr size_t buffer_size = 64;
+    char buffer_data[buffer_size];
+
+    struct tm utc_time;
+    if (!gmtime_r(&ts, &utc_time)) {
+        throw Parquet_exception("gmtime_r() failed");
+    }
+
+    if (strftime(buffer_data, buffer_size, pattern, &utc_time) == 0) {
+        throw Parquet_exception("strftime() failed");
+    }
+
+    std::string new_path = m_cfg.m_path;
+    if (new_path.back() != '/') {
+        new_path += '/';
+    }
+
+    return new_path + buffer_data;
+}
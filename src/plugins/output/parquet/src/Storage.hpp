@@ -0,0 +1,98 @@
+/**
+ * \file src/plugins/output/parquet/src/Storage.hpp
+ * \author agent <agent@local>
+ * \brief Parquet file storage (header file)
+ * \date 2026
+ *
+ * Copyright(c) 2026 CESNET z.s.p.o.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef IPFIXCOL2_PARQUET_STORAGE_HPP
+#define IPFIXCOL2_PARQUET_STORAGE_HPP
+
+#include <ipfixcol2.h>
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+#include <libfds.h>
+
+#include "Config.hpp"
+#include "Exception.hpp"
+#include "Table.hpp"
+
+/// Flow storage of Parquet files
+class Storage {
+public:
+    /**
+     * @brief Create a flow storage
+     *
+     * @note
+     *   Output files for the current window MUST be specified using new_window() function.
+     *   Otherwise, no flow records are stored.
+     *
+     * @param[in] ctx  Plugin context (only for log)
+     * @param[in] cfg  Configuration (must exist until the storage is destroyed)
+     * @throw Parquet_exception if @p path directory doesn't exist in the system
+     */
+    Storage(ipx_ctx_t *ctx, const Config &cfg);
+    virtual ~Storage();
+
+    // Disable copy constructors
+    Storage(const Storage &other) = delete;
+    Storage &operator=(const Storage &other) = delete;
+
+    /**
+     * @brief Create a new time window
+     *
+     * @note Previous window is automatically closed, if exists.
+     * @param[in] ts Timestamp of the window
+     * @throw Parquet_exception if the new window cannot be created
+     */
+    void
+    window_new(time_t ts);
+
+    /**
+     * @brief Close the current time window
+     *
+     * All files of the window are closed. Tables that haven't received any record in the window
+     * are released.
+     * @note
+     *   No more Data Records will be added until a new window is created!
+     */
+    void
+    window_close();
+
+    /**
+     * @brief Process IPFIX message
+     *
+     * Process all IPFIX Data Records in the message and store them to files.
+     * @note If a time window is not opened, no Data Records are stored and no exception is thrown.
+     * @param[in] msg Message to process
+     * @throw Parquet_exception if processing fails
+     */
+    void
+    process_msg(ipx_msg_ipfix_t *msg);
+
+private:
+    /// Plugin context only for logging!
+    ipx_ctx_t *m_ctx;
+    /// Configuration
+    const Config &m_cfg;
+    /// Common prefix of output files of the current window (empty if the window is closed)
+    std::string m_window;
+    /// Tables of records (Template signature -> table)
+    std::map<std::string, std::unique_ptr<Table>> m_tables;
+    /// Tables of Templates of the current message (valid only during processing of the message)
+    std::vector<std::pair<const struct fds_template *, Table *>> m_cache;
+
+    std::string
+    filename_gen(const time_t &ts);
+    Table &
+    table_get(const struct fds_template *tmplt);
+};
+
+
+#endif // IPFIXCOL2_PARQUET_STORAGE_HPP
@@ -0,0 +1,571 @@
+/**
+ * \file src/plugins/output/parquet/src/Table.cpp
+ * \author agent <agent@local>
+ * \brief Columnar table of flow records (source file)
+ * \date 2026
+ *
+ * Copyright(c) 2026 CESNET z.s.p.o.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include <cassert>
+#include <cinttypes>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <unistd.h>
+#include "Table.hpp"
+
+/// Suffix of files that are being written
+static const std::string TMP_SUFFIX = ".tmp";
+/// Private Enterprise Number and ID of paddingOctets (never shown by the record iterator)
+static const uint32_t PADDING_EN = 0;
+static const uint16_t PADDING_ID = 210;
+
+/**
+ * @brief Store a value of a fixed size column
+ * @param[out] dst   Position of the value in the column buffer
+ * @param[in]  value Value to store
+ */
+template <typename T>
+static inline void
+value_store(uint8_t *dst, T value)
+{
+    memcpy(dst, &value, sizeof(value));
+}
+
+/**
+ * @brief Check if dictionary encoding is suitable for a field
+ *
+ * Only strings and short identifiers and flags (e.g. protocols, ports, interfaces, TCP flags)
+ * usually have low cardinality. Counters and timestamps are never encoded by a dictionary.
+ * @param[in] def   Definition of the Information Element
+ * @param[in] width Size of values of the column (0 for variable length columns)
+ * @return True or false
+ */
+static bool
+dict_suitable(const struct fds_iemgr_elem *def, uint16_t width)
+{
+    switch (def->data_semantic) {
+    case FDS_ES_QUANTITY:
+    case FDS_ES_TOTAL_COUNTER:
+    case FDS_ES_DELTA_COUNTER:
+    case FDS_ES_SNMP_COUNTER:
+    case FDS_ES_SNMP_GAUGE:
+        return false;
+    case FDS_ES_IDENTIFIER:
+    case FDS_ES_FLAGS:
+        return width <= 4 && def->data_type != FDS_ET_IPV4_ADDRESS;
+    default:
+        break;
+    }
+
+    if (def->data_type == FDS_ET_STRING) {
+        return true;
+    }
+
+    return (def->data_type >= FDS_ET_UNSIGNED_8 && def->data_type <= FDS_ET_SIGNED_64)
+        && width <= 2;
+}
+
+Table::Table(const struct fds_template *tmplt, const Config &cfg) : m_rows_max(cfg.m_rows)
+{
+    std::vector<std::shared_ptr<arrow::Field>> fields;
+    parquet::WriterProperties::Builder props;
+
+    switch (cfg.m_calg) {
+    case Config::calg::SNAPPY:
+        props.compression(arrow::Compression::SNAPPY);
+        break;
+    case Config::calg::GZIP:
+        props.compression(arrow::Compression::GZIP);
+        break;
+    case Config::calg::LZ4:
+        props.compression(arrow::Compression::LZ4);
+        break;
+    case Config::calg::ZSTD:
+        props.compression(arrow::Compression::ZSTD);
+        break;
+    default:
+        props.compression(arrow::Compression::UNCOMPRESSED);
+        break;
+    }
+
+    // Dictionary encoding is enabled only for selected columns
+    props.disable_dictionary();
+    props.max_row_group_length(static_cast<int64_t>(m_rows_max));
+
+    m_map.resize(tmplt->fields_cnt_total, -1);
+    for (uint16_t i = 0; i < tmplt->fields_cnt_total; ++i) {
+        const struct fds_tfield &field = tmplt->fields[i];
+        if ((field.flags & FDS_TFIELD_LAST_IE) == 0) {
+            // Only the last occurrence of the same Information Element is stored
+            continue;
+        }
+        if (field.en == PADDING_EN && field.id == PADDING_ID) {
+            continue;
+        }
+
+        m_map[i] = static_cast<int>(m_columns.size());
+        column_add(field, cfg, fields, props);
+    }
+
+    m_schema = arrow::schema(fields);
+    m_props = props.build();
+}
+
+Table::~Table()
+{
+    try {
+        close();
+    } catch (...) {
+        // Nothing to do
+    }
+}
+
+std::string
+Table::signature(const struct fds_template *tmplt)
+{
+    std::string sig;
+    char buffer[32];
+
+    for (uint16_t i = 0; i < tmplt->fields_cnt_total; ++i) {
+        const struct fds_tfield &field = tmplt->fields[i];
+        const bool last = (field.flags & FDS_TFIELD_LAST_IE) != 0;
+        snprintf(buffer, sizeof(buffer), "%" PRIu32 ":%" PRIu16 "%s,", field.en, field.id,
+            last ? "" : "!");
+        sig += buffer;
+    }
+
+    return sig;
+}
+
+/**
+ * @brief Add a column for a Template field
+ *
+ * The type of the column is based on the definition of the Information Element. Fields without
+ * the definition are stored as binary data. Buffers of the column are preallocated for the
+ * maximum number of records in a batch.
+ * @param[in]     field  Template field
+ * @param[in]     cfg    Configuration
+ * @param[in,out] fields Fields of the schema
+ * @param[in,out] props  Parquet writer properties
+ */
+void
+Table::column_add(const struct fds_tfield &field, const Config &cfg,
+    std::vector<std::shared_ptr<arrow::Field>> &fields,
+    parquet::WriterProperties::Builder &props)
+{
+    const struct fds_iemgr_elem *def = field.def;
+    struct column col;
+    std::shared_ptr<arrow::DataType> type;
+    std::string name;
+
+    col.ie_type = (def != nullptr) ? def->data_type : FDS_ET_OCTET_ARRAY;
+    col.width = 0;
+    col.nulls = 0;
+
+    switch (col.ie_type) {
+    case FDS_ET_UNSIGNED_8:
+        col.type = kind::UINT;
+        col.width = 1;
+        type = arrow::uint8();
+        break;
+    case FDS_ET_UNSIGNED_16:
+        col.type = kind::UINT;
+        col.width = 2;
+        type = arrow::uint16();
+        break;
+    case FDS_ET_UNSIGNED_32:
+        col.type = kind::UINT;
+        col.width = 4;
+        type = arrow::uint32();
+        break;
+    case FDS_ET_UNSIGNED_64:
+        col.type = kind::UINT;
+        col.width = 8;
+        type = arrow::uint64();
+        break;
+    case FDS_ET_SIGNED_8:
+        col.type = kind::INT;
+        col.width = 1;
+        type = arrow::int8();
+        break;
+    case FDS_ET_SIGNED_16:
+        col.type = kind::INT;
+        col.width = 2;
+        type = arrow::int16();
+        break;
+    case FDS_ET_SIGNED_32:
+        col.type = kind::INT;
+        col.width = 4;
+        type = arrow::int32();
+        break;
+    case FDS_ET_SIGNED_64:
+        col.type = kind::INT;
+        col.width = 8;
+        type = arrow::int64();
+        break;
+    case FDS_ET_FLOAT_32:
+        col.type = kind::FLOAT32;
+        col.width = 4;
+        type = arrow::float32();
+        break;
+    case FDS_ET_FLOAT_64:
+        col.type = kind::FLOAT64;
+        col.width = 8;
+        type = arrow::float64();
+        break;
+    case FDS_ET_BOOLEAN:
+        col.type = kind::BOOL;
+        type = arrow::boolean();
+        break;
+    case FDS_ET_MAC_ADDRESS:
+        col.type = kind::FIXED;
+        col.width = 6;
+        type = arrow::fixed_size_binary(6);
+        break;
+    case FDS_ET_IPV4_ADDRESS:
+        col.type = kind::FIXED;
+        col.width = 4;
+        type = arrow::fixed_size_binary(4);
+        break;
+    case FDS_ET_IPV6_ADDRESS:
+        col.type = kind::FIXED;
+        col.width = 16;
+        type = arrow::fixed_size_binary(16);
+        break;
+    case FDS_ET_DATE_TIME_SECONDS:
+    case FDS_ET_DATE_TIME_MILLISECONDS:
+        col.type = kind::TIME_MS;
+        col.width = 8;
+        type = arrow::timestamp(arrow::TimeUnit::MILLI);
+        break;
+    case FDS_ET_DATE_TIME_MICROSECONDS:
+    case FDS_ET_DATE_TIME_NANOSECONDS:
+        col.type = kind::TIME_NS;
+        col.width = 8;
+        type = arrow::timestamp(arrow::TimeUnit::NANO);
+        break;
+    case FDS_ET_STRING:
+        col.type = kind::BINARY;
+        type = arrow::large_utf8();
+        break;
+    default:
+        // Octet arrays, structured data types and unknown fields
+        col.type = kind::BINARY;
+        type = arrow::large_binary();
+        break;
+    }
+
+    // Preallocate buffers for the maximum number of records in a batch
+    const size_t bitmap_size = (m_rows_max + 7) / 8;
+    col.valid.assign(bitmap_size, 0);
+    if (col.type == kind::BOOL) {
+        col.values.assign(bitmap_size, 0);
+    } else if (col.type == kind::BINARY) {
+        col.offsets.assign(m_rows_max + 1, 0);
+    } else {
+        col.values.assign(m_rows_max * col.width, 0);
+    }
+
+    // Name of the column (the same format as the JSON output)
+    if (def != nullptr) {
+        name = std::string(def->scope->name) + ":" + def->name;
+    } else {
+        name = "en" + std::to_string(field.en) + ":id" + std::to_string(field.id);
+    }
+
+    if (cfg.m_dict && def != nullptr && dict_suitable(def, col.width)) {
+        props.enable_dictionary(name);
+    }
+
+    fields.push_back(arrow::field(name, type));
+    m_columns.push_back(std::move(col));
+}
+
+void
+Table::open(const std::string &path)
+{
+    assert(!m_writer && "The file is already opened");
+    const std::string file_name = path + TMP_SUFFIX;
+
+    auto sink = arrow::io::FileOutputStream::Open(file_name);
+    if (!sink.ok()) {
+        throw Parquet_exception("Failed to create file '" + file_name + "': "
+            + sink.status().ToString());
+    }
+
+    auto writer = parquet::arrow::FileWriter::Open(*m_schema, arrow::default_memory_pool(),
+        *sink, m_props);
+    if (!writer.ok()) {
+        (void) (*sink)->Close();
+        unlink(file_name.c_str());
+        throw Parquet_exception("Failed to create a Parquet writer of '" + file_name + "': "
+            + writer.status().ToString());
+    }
+
+    m_sink = std::move(sink).ValueOrDie();
+    m_writer = std::move(writer).ValueOrDie();
+    m_file_name = file_name;
+}
+
+void
+Table::close()
+{
+    if (!m_writer) {
+        return;
+    }
+
+    std::string err_msg;
+    try {
+        flush();
+    } catch (const Parquet_exception &ex) {
+        err_msg = ex.what();
+    }
+
+    arrow::Status status = m_writer->Close();
+    if (!status.ok() && err_msg.empty()) {
+        err_msg = "Failed to finish file '" + m_file_name + "': " + status.ToString();
+    }
+    status = m_sink->Close();
+    if (!status.ok() && err_msg.empty()) {
+        err_msg = "Failed to close file '" + m_file_name + "': " + status.ToString();
+    }
+
+    m_writer.reset();
+    m_sink.reset();
+
+    // Remove the temporary suffix
+    const std::string new_file_name(m_file_name, 0, m_file_name.size() - TMP_SUFFIX.size());
+    if (std::rename(m_file_name.c_str(), new_file_name.c_str()) != 0 && err_msg.empty()) {
+        err_msg = "Failed to rename file '" + m_file_name + "'";
+    }
+    m_file_name.clear();
+
+    if (!err_msg.empty()) {
+        throw Parquet_exception(err_msg);
+    }
+}
+
+void
+Table::append(struct fds_drec &rec)
+{
+    assert(m_writer && "The file is not opened");
+    assert(rec.tmplt->fields_cnt_total == m_map.size() && "Unexpected Template");
+
+    struct fds_drec_iter iter;
+    int idx;
+
+    fds_drec_iter_init(&iter, &rec, 0);
+    while ((idx = fds_drec_iter_next(&iter)) != FDS_EOC) {
+        const int col_idx = m_map[idx];
+        if (col_idx < 0) {
+            continue;
+        }
+
+        column_append(m_columns[col_idx], iter.field);
+    }
+
+    if (++m_rows == m_rows_max) {
+        flush();
+    }
+}
+
+/**
+ * @brief Append a field to a column
+ *
+ * The value is converted into the position of the current record in the preallocated buffer.
+ * If the value cannot be converted (e.g. invalid size), it's marked as invalid (i.e. null).
+ * @param[in] col   Column
+ * @param[in] field Field of the record
+ */
+void
+Table::column_append(struct column &col, const struct fds_drec_field &field)
+{
+    uint8_t *dst = col.values.data() + m_rows * col.width;
+    bool ok = false;
+
+    switch (col.type) {
+    case kind::UINT: {
+        uint64_t value;
+        if (fds_get_uint_be(field.data, field.size, &value) != FDS_OK) {
+            break;
+        }
+        switch (col.width) {
+        case 1: value_store(dst, static_cast<uint8_t>(value)); break;
+        case 2: value_store(dst, static_cast<uint16_t>(value)); break;
+        case 4: value_store(dst, static_cast<uint32_t>(value)); break;
+        default: value_store(dst, value); break;
+        }
+        ok = true;
+        }
+        break;
+    case kind::INT: {
+        int64_t value;
+        if (fds_get_int_be(field.data, field.size, &value) != FDS_OK) {
+            break;
+        }
+        switch (col.width) {
+        case 1: value_store(dst, static_cast<int8_t>(value)); break;
+        case 2: value_store(dst, static_cast<int16_t>(value)); break;
+        case 4: value_store(dst, static_cast<int32_t>(value)); break;
+        default: value_store(dst, value); break;
+        }
+        ok = true;
+        }
+        break;
+    case kind::FLOAT32:
+    case kind::FLOAT64: {
+        double value;
+        if (fds_get_float_be(field.data, field.size, &value) != FDS_OK) {
+            break;
+        }
+        if (col.type == kind::FLOAT32) {
+            value_store(dst, static_cast<float>(value));
+        } else {
+            value_store(dst, value);
+        }
+        ok = true;
+        }
+        break;
+    case kind::BOOL: {
+        bool value;
+        if (fds_get_bool(field.data, field.size, &value) != FDS_OK) {
+            break;
+        }
+        if (value) {
+            col.values[m_rows >> 3] |= static_cast<uint8_t>(1U << (m_rows & 7));
+        }
+        ok = true;
+        }
+        break;
+    case kind::FIXED:
+        if (field.size != col.width) {
+            memset(dst, 0, col.width);
+            break;
+        }
+        memcpy(dst, field.data, col.width);
+        ok = true;
+        break;
+    case kind::TIME_MS: {
+        uint64_t value;
+        if (fds_get_datetime_lp_be(field.data, field.size, col.ie_type, &value) != FDS_OK) {
+            break;
+        }
+        value_store(dst, static_cast<int64_t>(value));
+        ok = true;
+        }
+        break;
+    case kind::TIME_NS: {
+        struct timespec ts;
+        if (fds_get_datetime_hp_be(field.data, field.size, col.ie_type, &ts) != FDS_OK) {
+            break;
+        }
+        value_store(dst, static_cast<int64_t>(ts.tv_sec) * INT64_C(1000000000) + ts.tv_nsec);
+        ok = true;
+        }
+        break;
+    case kind::BINARY:
+        // Variable length values are concatenated (the buffer keeps its capacity among batches)
+        col.values.insert(col.values.end(), field.data, field.data + field.size);
+        col.offsets[m_rows + 1] = static_cast<int64_t>(col.values.size());
+        ok = true;
+        break;
+    }
+
+    if (ok) {
+        col.valid[m_rows >> 3] |= static_cast<uint8_t>(1U << (m_rows & 7));
+    } else {
+        col.nulls++;
+    }
+}
+
+/**
+ * @brief Create an Arrow array of a column
+ *
+ * The array refers to the column buffers (i.e. no copy is made), therefore, the buffers
+ * must not be modified until the array is written.
+ * @param[in] col  Column
+ * @param[in] type Arrow data type of the column
+ * @return Array
+ */
+std::shared_ptr<arrow::Array>
+Table::column_finish(const struct column &col, const std::shared_ptr<arrow::DataType> &type)
+{
+    const int64_t rows = static_cast<int64_t>(m_rows);
+    const int64_t bitmap_size = (rows + 7) / 8;
+    std::vector<std::shared_ptr<arrow::Buffer>> buffers;
+
+    // Validity bitmap is not required if all values are valid
+    if (col.nulls != 0) {
+        buffers.push_back(std::make_shared<arrow::Buffer>(col.valid.data(), bitmap_size));
+    } else {
+        buffers.push_back(nullptr);
+    }
+
+    switch (col.type) {
+    case kind::BOOL:
+        buffers.push_back(std::make_shared<arrow::Buffer>(col.values.data(), bitmap_size));
+        break;
+    case kind::BINARY:
+        buffers.push_back(std::make_shared<arrow::Buffer>(
+            reinterpret_cast<const uint8_t *>(col.offsets.data()),
+            (rows + 1) * static_cast<int64_t>(sizeof(int64_t))));
+        buffers.push_back(std::make_shared<arrow::Buffer>(col.values.data(),
+            static_cast<int64_t>(col.values.size())));
+        break;
+    default:
+        buffers.push_back(std::make_shared<arrow::Buffer>(col.values.data(), rows * col.width));
+        break;
+    }
+
+    const int64_t nulls = static_cast<int64_t>(col.nulls);
+    return arrow::MakeArray(arrow::ArrayData::Make(type, rows, std::move(buffers), nulls));
+}
+
+/**
+ * @brief Write the current record batch as a new row group
+ *
+ * Buffers of columns are reset even if the batch cannot be written.
+ * @throw Parquet_exception if the batch cannot be written
+ */
+void
+Table::flush()
+{
+    if (m_rows == 0) {
+        return;
+    }
+
+    std::vector<std::shared_ptr<arrow::Array>> arrays;
+    arrays.reserve(m_columns.size());
+    for (size_t i = 0; i < m_columns.size(); ++i) {
+        arrays.push_back(column_finish(m_columns[i], m_schema->field(i)->type()));
+    }
+
+    const int64_t rows = static_cast<int64_t>(m_rows);
+    auto batch = arrow::RecordBatch::Make(m_schema, rows, std::move(arrays));
+    arrow::Status status = m_writer->NewBufferedRowGroup();
+    if (status.ok()) {
+        status = m_writer->WriteRecordBatch(*batch);
+    }
+    batch.reset();
+
+    // Reset buffers (capacity of buffers is preserved)
+    const size_t bitmap_size = (m_rows + 7) / 8;
+    for (auto &col : m_columns) {
+        memset(col.valid.data(), 0, bitmap_size);
+        col.nulls = 0;
+        if (col.type == kind::BOOL) {
+            memset(col.values.data(), 0, bitmap_size);
+        } else if (col.type == kind::BINARY) {
+            col.values.clear();
+        }
+    }
+    m_rows = 0;
+
+    if (!status.ok()) {
+        throw Parquet_exception("Failed to write a record batch into '" + m_file_name + "': "
+            + status.ToString());
+    }
+}
@@ -0,0 +1,158 @@
+/**
+ * \file src/plugins/output/parquet/src/Table.hpp
+ * \author agent <agent@local>
+ * \brief Columnar table of flow records (header file)
+ * \date 2026
+ *
+ * Copyright(c) 2026 CESNET z.s.p.o.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef IPFIXCOL2_PARQUET_TABLE_HPP
+#define IPFIXCOL2_PARQUET_TABLE_HPP
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include <libfds.h>
+
+#include <arrow/api.h>
+#include <arrow/io/file.h>
+#include <parquet/arrow/writer.h>
+#include <parquet/properties.h>
+
+#include "Config.hpp"
+#include "Exception.hpp"
+
+/**
+ * @brief Table of flow records of the same structure stored in a Parquet file
+ *
+ * Columns of the table correspond to fields of an (Options) Template. Records are appended
+ * directly into preallocated column buffers (i.e. without any dynamic allocation per record)
+ * and the buffers are written to the file as an Arrow record batch (i.e. a row group), when
+ * the batch is full or the file is closed.
+ */
+class Table {
+public:
+    /**
+     * @brief Create a table for records of a Template
+     *
+     * @note The file must be opened by open() before records are appended.
+     * @param[in] tmplt Template of records (all Templates with the same signature() can be used)
+     * @param[in] cfg   Configuration
+     */
+    Table(const struct fds_template *tmplt, const Config &cfg);
+    ~Table();
+
+    // Disable copy constructors
+    Table(const Table &other) = delete;
+    Table &operator=(const Table &other) = delete;
+
+    /**
+     * @brief Get signature of a Template
+     *
+     * Templates with the same signature share the same table.
+     * @param[in] tmplt Template
+     * @return Signature
+     */
+    static std::string
+    signature(const struct fds_template *tmplt);
+
+    /**
+     * @brief Open a new output file
+     *
+     * The file is created with a temporary suffix and renamed after it's closed.
+     * @param[in] path Path of the file
+     * @throw Parquet_exception if the file cannot be created
+     */
+    void
+    open(const std::string &path);
+
+    /**
+     * @brief Write remaining records and close the output file (if opened)
+     * @throw Parquet_exception if the records cannot be written (the file is closed anyway)
+     */
+    void
+    close();
+
+    /**
+     * @brief Check if the output file is opened
+     * @return True or false
+     */
+    bool
+    is_open() const {return m_writer != nullptr;};
+
+    /**
+     * @brief Append a Data Record
+     * @param[in] rec Data Record (its Template must have the same signature as the table)
+     * @throw Parquet_exception if a full record batch cannot be written
+     */
+    void
+    append(struct fds_drec &rec);
+
+private:
+    /// Type of a column
+    enum class kind {
+        UINT,    ///< Unsigned integer
+        INT,     ///< Signed integer
+        FLOAT32, ///< Floating point number
+        FLOAT64, ///< Floating point number (double precision)
+        BOOL,    ///< Boolean (bitmap)
+        FIXED,   ///< Fixed size binary (addresses)
+        TIME_MS, ///< Timestamp (milliseconds)
+        TIME_NS, ///< Timestamp (nanoseconds)
+        BINARY   ///< Variable length string or binary data
+    };
+
+    /// Column buffers
+    struct column {
+        /// Type of the column
+        kind type;
+        /// IPFIX data type of the field
+        enum fds_iemgr_element_type ie_type;
+        /// Size of a value (in bytes, only fixed size columns)
+        uint16_t width;
+        /// Values (fixed size columns) or concatenated values (variable length columns)
+        std::vector<uint8_t> values;
+        /// Offsets of values (only variable length columns)
+        std::vector<int64_t> offsets;
+        /// Validity bitmap
+        std::vector<uint8_t> valid;
+        /// Number of invalid values
+        size_t nulls;
+    };
+
+    /// Schema of the table
+    std::shared_ptr<arrow::Schema> m_schema;
+    /// Parquet writer properties (compression, dictionary encoding, etc.)
+    std::shared_ptr<parquet::WriterProperties> m_props;
+    /// Columns
+    std::vector<struct column> m_columns;
+    /// Mapping of Template fields to columns (-1 == the field is not stored)
+    std::vector<int> m_map;
+    /// Number of records in the current batch
+    size_t m_rows = 0;
+    /// Maximum number of records in a batch
+    size_t m_rows_max;
+
+    /// Output file stream
+    std::shared_ptr<arrow::io::FileOutputStream> m_sink;
+    /// Parquet writer
+    std::unique_ptr<parquet::arrow::FileWriter> m_writer;
+    /// Name of the output file (with the temporary suffix)
+    std::string m_file_name;
+
+    void
+    column_add(const struct fds_tfield &field, const Config &cfg,
+        std::vector<std::shared_ptr<arrow::Field>> &fields,
+        parquet::WriterProperties::Builder &props);
+    void
+    column_append(struct column &col, const struct fds_drec_field &field);
+    std::shared_ptr<arrow::Array>
+    column_finish(const struct column &col, const std::shared_ptr<arrow::DataType> &type);
+    void
+    flush();
+};
+
+#endif // IPFIXCOL2_PARQUET_TABLE_HPP
@@ -0,0 +1,178 @@
+/**
+ * \file src/plugins/output/recent/src/Config.cpp
+ * \author agent <agent@local>
+ * \brief Parser of XML configuration (source file)
+ * \date 2026
+ *
+ * Copyright(c) 2026 CESNET z.s.p.o.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include "Config.hpp"
+#include <cassert>
+#include <memory>
+#include <stdexcept>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+/*
+ * <params>
+ *   <socket>...</socket>
+ *   <window>...</window>                <!-- optional -->
+ *   <slice>...</slice>                  <!-- optional -->
+ *   <memLimit>...</memLimit>            <!-- optional -->
+ *   <queryThreads>...</queryThreads>    <!-- optional -->
+ *   <queryLimit>...</queryLimit>        <!-- optional -->
+ * </params>
+ */
+
+/// XML nodes
+enum params_xml_nodes {
+    NODE_SOCKET = 1,
+    NODE_WINDOW,
+    NODE_SLICE,
+    NODE_MEM_LIMIT,
+    NODE_THREADS,
+    NODE_LIMIT
+};
+
+/// Definition of the \<params\> node
+static const struct fds_xml_args args_params[] = {
+    FDS_OPTS_ROOT("params"),
+    FDS_OPTS_ELEM(NODE_SOCKET,    "socket",       FDS_OPTS_T_STRING, 0),
+    FDS_OPTS_ELEM(NODE_WINDOW,    "window",       FDS_OPTS_T_UINT,   FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM(NODE_SLICE,     "slice",        FDS_OPTS_T_UINT,   FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM(NODE_MEM_LIMIT, "memLimit",     FDS_OPTS_T_UINT,   FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM(NODE_THREADS,   "queryThreads", FDS_OPTS_T_UINT,   FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM(NODE_LIMIT,     "queryLimit",   FDS_OPTS_T_UINT,   FDS_OPTS_P_OPT),
+    FDS_OPTS_END
+};
+
+Config::Config(const char *params)
+{
+    set_default();
+
+    // Create XML parser
+    std::unique_ptr<fds_xml_t, decltype(&fds_xml_destroy)> xml(fds_xml_create(), &fds_xml_destroy);
+    if (!xml) {
+        throw std::runtime_error("Failed to create an XML parser!");
+    }
+
+    if (fds_xml_set_args(xml.get(), args_params) != FDS_OK) {
+        throw std::runtime_error("Failed to parse the description of an XML document!");
+    }
+
+    fds_xml_ctx_t *params_ctx = fds_xml_parse_mem(xml.get(), params, true);
+    if (!params_ctx) {
+        std::string err = fds_xml_last_err(xml.get());
+        throw std::runtime_error("Failed to parse the configuration: " + err);
+    }
+
+    // Parse parameters and check configuration
+    try {
+        parse_root(params_ctx);
+        validate();
+    } catch (std::exception &ex) {
+        throw std::runtime_error("Failed to parse the configuration: " + std::string(ex.what()));
+    }
+}
+
+/**
+ * @brief Set default parameters
+ */
+void
+Config::set_default()
+{
+    m_socket.clear();
+    m_window = WINDOW_DEF;
+    m_slice = SLICE_DEF;
+    m_mem_limit = MEM_LIMIT_DEF * 1024U * 1024U;
+    m_threads = THREADS_DEF;
+    m_limit = LIMIT_DEF;
+}
+
+/**
+ * @brief Check if the configuration is valid
+ * @throw runtime_error if the configuration breaks some rules
+ */
+void
+Config::validate()
+{
+    if (m_socket.empty()) {
+        throw std::runtime_error("Path of the socket cannot be empty!");
+    }
+
+    if (m_socket.size() >= sizeof(((struct sockaddr_un *) nullptr)->sun_path)) {
+        throw std::runtime_error("Path of the socket is too long!");
+    }
+
+    if (m_window == 0 || m_slice == 0) {
+        throw std::runtime_error("Window and slice must be greater than zero!");
+    }
+
+    if (m_slice > m_window) {
+        throw std::runtime_error("Slice cannot be longer than the window!");
+    }
+
+    if (m_mem_limit == 0) {
+        throw std::runtime_error("Memory limit must be greater than zero!");
+    }
+
+    if (m_threads == 0) {
+        throw std::runtime_error("Number of query threads must be greater than zero!");
+    }
+}
+
+/**
+ * @brief Process \<params\> node
+ * @param[in] ctx XML context to process
+ * @throw runtime_error if the parser fails
+ */
+void
+Config::parse_root(fds_xml_ctx_t *ctx)
+{
+    const struct fds_xml_cont *content;
+    while (fds_xml_next(ctx, &content) != FDS_EOC) {
+        switch (content->id) {
+        case NODE_SOCKET:
+            assert(content->type == FDS_OPTS_T_STRING);
+            m_socket = content->ptr_string;
+            break;
+        case NODE_WINDOW:
+            assert(content->type == FDS_OPTS_T_UINT);
+            if (content->val_uint > UINT32_MAX) {
+                throw std::runtime_error("Window is too long!");
+            }
+            m_window = static_cast<uint32_t>(content->val_uint);
+            break;
+        case NODE_SLICE:
+            assert(content->type == FDS_OPTS_T_UINT);
+            if (content->val_uint > UINT32_MAX) {
+                throw std::runtime_error("Slice is too long!");
+            }
+            m_slice = static_cast<uint32_t>(content->val_uint);
+            break;
+        case NODE_MEM_LIMIT:
+            assert(content->type == FDS_OPTS_T_UINT);
+            if (content->val_uint > (UINT64_MAX >> 20)) {
+                throw std::runtime_error("Memory limit is too large!");
+            }
+            m_mem_limit = content->val_uint * 1024U * 1024U;
+            break;
+        case NODE_THREADS:
+            assert(content->type == FDS_OPTS_T_UINT);
+            if (content->val_uint > 1024U) {
+                throw std::runtime_error("Too many query threads (max. 1024)!");
+            }
+            m_threads = static_cast<unsigned int>(content->val_uint);
+            break;
+        case NODE_LIMIT:
+            assert(content->type == FDS_OPTS_T_UINT);
+            m_limit = content->val_uint;
+            break;
+        default:
+            // Internal error
+            throw std::runtime_error("Unknown XML node");
+        }
+    }
+}
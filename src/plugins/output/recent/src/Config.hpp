@@ -0,0 +1,65 @@
+/**
+ * \file src/plugins/output/recent/src/Config.hpp
+ * \author agent <agent@local>
+ * \brief Parser of XML configuration (header file)
+ * \date 2026
+ *
+ * Copyright(c) 2026 CESNET z.s.p.o.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef IPFIXCOL2_RECENT_CONFIG_HPP
+#define IPFIXCOL2_RECENT_CONFIG_HPP
+
+#include <cstdint>
+#include <string>
+#include <libfds.h>
+
+/**
+ * @brief Plugin configuration parser
+ */
+class Config {
+public:
+    /**
+     * @brief Parse configuration of the plugin
+     * @param[in] params XML parameters to parse
+     * @throw runtime_exception on error
+     */
+    Config(const char *params);
+    ~Config() = default;
+
+    /// Path of the Unix socket of queries
+    std::string m_socket;
+    /// Length of the history held in memory (in seconds)
+    uint32_t m_window;
+    /// Length of time slices of the history (in seconds)
+    uint32_t m_slice;
+    /// Maximum amount of memory of stored records (in bytes)
+    uint64_t m_mem_limit;
+    /// Number of threads of a query
+    unsigned int m_threads;
+    /// Default maximum number of records returned by a query
+    uint64_t m_limit;
+
+private:
+    /// Default length of the history (15 minutes)
+    static const uint32_t WINDOW_DEF = 900U;
+    /// Default length of time slices
+    static const uint32_t SLICE_DEF = 60U;
+    /// Default memory limit (in MiB)
+    static const uint64_t MEM_LIMIT_DEF = 1024U;
+    /// Default number of threads of a query
+    static const unsigned int THREADS_DEF = 4U;
+    /// Default maximum number of returned records
+    static const uint64_t LIMIT_DEF = 100U;
+
+    void
+    set_default();
+    void
+    validate();
+
+    void
+    parse_root(fds_xml_ctx_t *ctx);
+};
+
+#endif // IPFIXCOL2_RECENT_CONFIG_HPP
@@ -0,0 +1,265 @@
+/**
+ * \file src/plugins/output/recent/src/Query.cpp
+ * \author agent <agent@local>
+ * \brief Queries over recent flow records (source file)
+ * \date 2026
+ *
+ * Copyright(c) 2026 CESNET z.s.p.o.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include <algorithm>
+#include <cstdlib>
+#include <stdexcept>
+
+#include "aggregator/aggregator.hpp"
+#include "aggregator/jsonPrinter.hpp"
+#include "aggregator/sort.hpp"
+#include "aggregator/view.hpp"
+#include "common/flowProvider.hpp"
+#include "Query.hpp"
+
+using namespace fdsdump;
+
+/*
+ * Description of a query (one "key=value" pair per line):
+ *
+ *   mode=list|aggregate   <!-- optional, default: list -->
+ *   filter=EXPR           <!-- optional, filter of fdsdump -->
+ *   keys=KEYS             <!-- aggregation keys of fdsdump (aggregate only) -->
+ *   values=VALUES         <!-- optional, aggregated values of fdsdump (aggregate only) -->
+ *   order=FIELDS          <!-- optional, order of fdsdump (aggregate only) -->
+ *   limit=NUM             <!-- optional, 0 == unlimited -->
+ *   last=DURATION         <!-- optional, e.g. 300, 5m or 1h -->
+ */
+Query::Query(const std::string &request, uint64_t limit)
+    : m_limit(limit)
+{
+    for (std::string line : string_split(request, "\n")) {
+        string_trim(line);
+        if (line.empty()) {
+            continue;
+        }
+
+        const size_t pos = line.find('=');
+        if (pos == std::string::npos) {
+            throw std::invalid_argument("Invalid line \"" + line + "\" (expected key=value)");
+        }
+
+        const std::string key = string_trim_copy(line.substr(0, pos));
+        const std::string value = string_trim_copy(line.substr(pos + 1));
+
+        if (key == "mode") {
+            if (value == "list") {
+                m_mode = mode::LIST;
+            } else if (value == "aggregate") {
+                m_mode = mode::AGGREGATE;
+            } else {
+                throw std::invalid_argument("Invalid mode \"" + value + "\"");
+            }
+        } else if (key == "filter") {
+            m_filter = value;
+        } else if (key == "keys") {
+            m_keys = value;
+        } else if (key == "values") {
+            m_values = value;
+        } else if (key == "order") {
+            m_order = value;
+        } else if (key == "limit") {
+            char *end;
+            m_limit = strtoull(value.c_str(), &end, 10);
+            if (value.empty() || *end != '\0') {
+                throw std::invalid_argument("Invalid limit \"" + value + "\"");
+            }
+        } else if (key == "last") {
+            const uint64_t msec = aggregator::parse_duration(value);
+            if (msec == 0) {
+                throw std::invalid_argument("Invalid duration \"" + value + "\"");
+            }
+            m_last = (msec + 999U) / 1000U;
+        } else {
+            throw std::invalid_argument("Unknown key \"" + key + "\"");
+        }
+    }
+
+    if (m_mode == mode::AGGREGATE && m_keys.empty()) {
+        throw std::invalid_argument("Aggregation keys must be specified");
+    }
+}
+
+void
+Query::run(Store &store, const shared_iemgr &iemgr, unsigned int threads, time_t now,
+    std::ostream &out)
+{
+    const time_t since = (m_last != 0) ? now - static_cast<time_t>(m_last) : 0;
+    const block_list blocks = store.snapshot(since);
+
+    switch (m_mode) {
+    case mode::LIST:
+        run_list(blocks, iemgr, out);
+        break;
+    case mode::AGGREGATE:
+        run_aggregate(blocks, iemgr, threads, out);
+        break;
+    }
+}
+
+/**
+ * @brief Prepare a provider of records of the store
+ * @param[in] flows  The provider
+ * @param[in] filter Filter expression (can be empty)
+ */
+static void
+flows_prepare(FlowProvider &flows, const std::string &filter)
+{
+    flows.set_biflow_autoignore(true);
+    if (!filter.empty()) {
+        flows.set_filter(filter);
+    }
+}
+
+/**
+ * @brief Print the newest records as JSON objects (one per line)
+ *
+ * Records are processed by a single thread from the newest block, so the query usually stops
+ * after a few blocks.
+ */
+void
+Query::run_list(const block_list &blocks, const shared_iemgr &iemgr, std::ostream &out)
+{
+    FlowProvider flows {iemgr};
+    size_t block_idx = blocks.size();
+    size_t rec_idx = 0;
+
+    flows_prepare(flows, m_filter);
+    flows.set_source([&](struct fds_drec &rec) {
+        while (block_idx > 0) {
+            const Block &block = *blocks[block_idx - 1];
+            if (rec_idx < block.recs.size()) {
+                block.get(block.recs.size() - ++rec_idx, rec);
+                return true;
+            }
+
+            block_idx--;
+            rec_idx = 0;
+        }
+        return false;
+    });
+
+    const uint32_t base_flags =
+        FDS_CD2J_ALLOW_REALLOC | FDS_CD2J_OCTETS_NOINT | FDS_CD2J_TS_FORMAT_MSEC;
+    std::unique_ptr<char, decltype(&free)> buffer(nullptr, &free);
+    size_t buffer_size = 0;
+    uint64_t printed = 0;
+
+    auto print = [&](struct fds_drec *rec, uint32_t flags) {
+        char *buffer_ptr = buffer.release();
+        int ret = fds_drec2json(rec, base_flags | flags, iemgr.get(), &buffer_ptr, &buffer_size);
+        buffer.reset(buffer_ptr);
+        if (ret < 0) {
+            throw std::runtime_error("JSON conversion failed: " + std::to_string(ret));
+        }
+
+        out.write(buffer.get(), ret);
+        out.put('\n');
+        printed++;
+    };
+
+    while (m_limit == 0 || printed < m_limit) {
+        Flow *flow = flows.next_record();
+        if (!flow) {
+            break;
+        }
+
+        // Both directions of a biflow record are printed separately
+        if (flow->dir & DIRECTION_FWD) {
+            print(&flow->rec, 0);
+        }
+        if ((flow->dir & DIRECTION_REV) && (m_limit == 0 || printed < m_limit)) {
+            print(&flow->rec, FDS_CD2J_BIFLOW_REVERSE);
+        }
+    }
+}
+
+/**
+ * @brief Aggregate records of all blocks and print them as a JSON array
+ *
+ * Blocks are split among threads in a round-robin fashion, so each thread processes a part of
+ * each time slice.
+ */
+void
+Query::run_aggregate(const block_list &blocks, const shared_iemgr &iemgr, unsigned int threads,
+    std::ostream &out)
+{
+    using aggregator::Aggregator;
+
+    aggregator::ViewDefinition view_def = aggregator::make_view_def(m_keys, m_values,
+        iemgr.get());
+    std::vector<aggregator::SortField> sort_fields = aggregator::make_sort_def(view_def, m_order);
+
+    const size_t workers = std::max<size_t>(1, std::min<size_t>(threads, blocks.size()));
+    std::vector<std::unique_ptr<Aggregator>> aggrs;
+    std::vector<shared_iemgr> iemgrs;
+    for (size_t i = 0; i < workers; ++i) {
+        // The manager is not thread-safe, therefore, each worker uses its own copy for filters
+        shared_iemgr copy {fds_iemgr_copy(iemgr.get()), &fds_iemgr_destroy};
+        if (!copy) {
+            throw std::runtime_error("fds_iemgr_copy() has failed");
+        }
+
+        iemgrs.push_back(copy);
+        aggrs.emplace_back(new Aggregator(view_def));
+    }
+
+    run_parallel(workers, [&](size_t i) {
+        FlowProvider flows {iemgrs[i]};
+        size_t block_idx = i;
+        size_t rec_idx = 0;
+
+        flows_prepare(flows, m_filter);
+        flows.set_source([&](struct fds_drec &rec) {
+            while (block_idx < blocks.size()) {
+                const Block &block = *blocks[block_idx];
+                if (rec_idx < block.recs.size()) {
+                    block.get(rec_idx++, rec);
+                    return true;
+                }
+
+                block_idx += workers;
+                rec_idx = 0;
+            }
+            return false;
+        });
+
+        while (true) {
+            Flow *flow = flows.next_record();
+            if (!flow) {
+                break;
+            }
+
+            aggrs[i]->process_record(*flow);
+        }
+    });
+
+    Aggregator &aggr = *aggrs[0];
+    for (size_t i = 1; i < workers; ++i) {
+        aggr.merge(*aggrs[i]);
+        aggrs[i].reset();
+    }
+
+    sort_records(aggr.items(), sort_fields, view_def, m_limit);
+
+    aggregator::JSONPrinter printer(view_def, out);
+    uint64_t printed = 0;
+
+    printer.print_prologue();
+    for (uint8_t *record : aggr.items()) {
+        if (m_limit != 0 && printed >= m_limit) {
+            break;
+        }
+
+        printer.print_record(record);
+        printed++;
+    }
+    printer.print_epilogue();
+}
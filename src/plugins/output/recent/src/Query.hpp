@@ -0,0 +1,91 @@
+/**
+ * \file src/plugins/output/recent/src/Query.hpp
+ * \author agent <agent@local>
+ * \brief Queries over recent flow records (header file)
+ * \date 2026
+ *
+ * Copyright(c) 2026 CESNET z.s.p.o.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef IPFIXCOL2_RECENT_QUERY_HPP
+#define IPFIXCOL2_RECENT_QUERY_HPP
+
+#include <cstdint>
+#include <ctime>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "common/common.hpp"
+#include "Store.hpp"
+
+/**
+ * @brief Query over records of the store
+ *
+ * A query is described by lines of "key=value" pairs (see parse()). Records are processed by
+ * the engines of fdsdump, i.e. filtered by FlowProvider (including the biflow autoignore
+ * heuristic) and aggregated by Aggregator. Listed records are printed as JSON objects (one per
+ * line, newest first) and aggregated records as a JSON array, the same way as by
+ * "fdsdump -o json-raw" and "fdsdump -o json".
+ */
+class Query {
+public:
+    /**
+     * @brief Parse a query
+     * @param[in] request Description of the query
+     * @param[in] limit   Default maximum number of returned records
+     * @throw invalid_argument if the description is not valid
+     */
+    Query(const std::string &request, uint64_t limit);
+    ~Query() = default;
+
+    /**
+     * @brief Run the query
+     *
+     * Aggregation of blocks is split among threads, each with its own aggregator, which are
+     * merged at the end.
+     * @param[in] store   Store of records
+     * @param[in] iemgr   Manager of Information Elements of the store
+     * @param[in] threads Maximum number of threads
+     * @param[in] now     Current time
+     * @param[in] out     Output stream
+     * @throw runtime_error or invalid_argument if the query fails
+     */
+    void
+    run(Store &store, const fdsdump::shared_iemgr &iemgr, unsigned int threads, time_t now,
+        std::ostream &out);
+
+private:
+    /// Type of the query
+    enum class mode {
+        LIST,     ///< List records
+        AGGREGATE ///< Aggregate records
+    };
+
+    /// Type of the query
+    mode m_mode = mode::LIST;
+    /// Filter expression (empty == all records)
+    std::string m_filter;
+    /// Aggregation keys (in the syntax of fdsdump)
+    std::string m_keys;
+    /// Aggregated values (in the syntax of fdsdump)
+    std::string m_values = "flows,packets,bytes";
+    /// Order of aggregated records (in the syntax of fdsdump)
+    std::string m_order;
+    /// Maximum number of returned records (0 == unlimited)
+    uint64_t m_limit;
+    /// Length of the history to process (in seconds, 0 == everything)
+    uint64_t m_last = 0;
+
+    using block_list = std::vector<std::shared_ptr<const Block>>;
+
+    void
+    run_list(const block_list &blocks, const fdsdump::shared_iemgr &iemgr, std::ostream &out);
+    void
+    run_aggregate(const block_list &blocks, const fdsdump::shared_iemgr &iemgr,
+        unsigned int threads, std::ostream &out);
+};
+
+#endif // IPFIXCOL2_RECENT_QUERY_HPP
@@ -0,0 +1,284 @@
+/**
+ * \file src/plugins/output/recent/src/Server.cpp
+ * \author agent <agent@local>
+ * \brief Server of queries over a Unix socket (source file)
+ * \date 2026
+ *
+ * Copyright(c) 2026 CESNET z.s.p.o.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <sstream>
+#include <stdexcept>
+#include <system_error>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "Query.hpp"
+#include "Server.hpp"
+
+Server::Server(ipx_ctx_t *ctx, const Config &cfg, Store &store, fdsdump::shared_iemgr iemgr)
+    : m_ctx(ctx), m_cfg(cfg), m_store(store), m_iemgr(std::move(iemgr))
+{
+    const char *path = m_cfg.m_socket.c_str();
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strncpy(addr.sun_path, path, sizeof(addr.sun_path) - 1);
+
+    // Remove a socket left by a previous instance (but never other files)
+    struct stat st;
+    if (lstat(path, &st) == 0 && S_ISSOCK(st.st_mode)) {
+        unlink(path);
+    }
+
+    try {
+        if (pipe2(m_pipe, O_CLOEXEC) != 0) {
+            throw std::runtime_error("pipe2() failed");
+        }
+
+        m_fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if (m_fd < 0) {
+            throw std::runtime_error("socket() failed");
+        }
+
+        if (bind(m_fd, reinterpret_cast<struct sockaddr *>(&addr), sizeof(addr)) != 0) {
+            throw std::runtime_error("Failed to bind socket '" + m_cfg.m_socket + "'");
+        }
+        m_bound = true;
+
+        if (listen(m_fd, SOMAXCONN) != 0) {
+            throw std::runtime_error("listen() failed");
+        }
+    } catch (const std::runtime_error &ex) {
+        const char *err_str;
+        ipx_strerror(errno, err_str);
+        close_all();
+        throw std::runtime_error(std::string(ex.what()) + ": " + err_str);
+    }
+
+    try {
+        m_thread = std::thread(&Server::thread_main, this);
+    } catch (const std::system_error &ex) {
+        close_all();
+        throw std::runtime_error("Failed to start a thread of the server: "
+            + std::string(ex.what()));
+    }
+}
+
+Server::~Server()
+{
+    // Wake up the thread (it finishes the current query first)
+    const char stop = 's';
+    if (write(m_pipe[1], &stop, 1) != 1) {
+        IPX_CTX_ERROR(m_ctx, "Failed to stop the thread of the server!", '\0');
+    }
+    m_thread.join();
+    close_all();
+}
+
+/**
+ * @brief Close the socket and the pipe and remove the socket file
+ */
+void
+Server::close_all()
+{
+    if (m_fd >= 0) {
+        close(m_fd);
+        m_fd = -1;
+    }
+
+    if (m_bound) {
+        unlink(m_cfg.m_socket.c_str());
+        m_bound = false;
+    }
+
+    for (int &fd : m_pipe) {
+        if (fd >= 0) {
+            close(fd);
+            fd = -1;
+        }
+    }
+}
+
+/**
+ * @brief Main function of the thread
+ */
+void
+Server::thread_main()
+{
+    struct pollfd fds[2];
+    fds[0].fd = m_fd;
+    fds[0].events = POLLIN;
+    fds[1].fd = m_pipe[0];
+    fds[1].events = POLLIN;
+
+    while (true) {
+        if (poll(fds, 2, -1) < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+
+            const char *err_str;
+            ipx_strerror(errno, err_str);
+            IPX_CTX_ERROR(m_ctx, "poll() failed: %s (the server is stopped)", err_str);
+            return;
+        }
+
+        if (fds[1].revents != 0) {
+            // Stop request
+            return;
+        }
+
+        if ((fds[0].revents & POLLIN) == 0) {
+            continue;
+        }
+
+        const int client = accept4(m_fd, nullptr, nullptr, SOCK_CLOEXEC);
+        if (client < 0) {
+            const char *err_str;
+            ipx_strerror(errno, err_str);
+            IPX_CTX_WARNING(m_ctx, "Failed to accept a client: %s", err_str);
+            continue;
+        }
+
+        client_handle(client);
+        close(client);
+    }
+}
+
+/**
+ * @brief Escape a string for JSON
+ */
+static std::string
+json_escape(const std::string &str)
+{
+    std::string result;
+    for (char c : str) {
+        switch (c) {
+        case '"':  result += "\\\""; break;
+        case '\\': result += "\\\\"; break;
+        case '\n': result += "\\n";  break;
+        case '\r': result += "\\r";  break;
+        case '\t': result += "\\t";  break;
+        default:
+            if (static_cast<unsigned char>(c) < 0x20) {
+                char buffer[8];
+                snprintf(buffer, sizeof(buffer), "\\u%04x", c);
+                result += buffer;
+            } else {
+                result += c;
+            }
+        }
+    }
+    return result;
+}
+
+/**
+ * @brief Read a query of a client, run it and send the result
+ * @param[in] fd Socket of the client
+ */
+void
+Server::client_handle(int fd)
+{
+    struct timeval tv_recv = {RECV_TIMEOUT, 0};
+    struct timeval tv_send = {SEND_TIMEOUT, 0};
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv_recv, sizeof(tv_recv));
+    setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &tv_send, sizeof(tv_send));
+
+    std::string request;
+    if (!request_read(fd, request)) {
+        return;
+    }
+
+    std::ostringstream out;
+    try {
+        Query query(request, m_cfg.m_limit);
+        query.run(m_store, m_iemgr, m_cfg.m_threads, time(nullptr), out);
+    } catch (const std::exception &ex) {
+        IPX_CTX_INFO(m_ctx, "Query failed: %s", ex.what());
+        out.str("");
+        out << "{\"error\":\"" << json_escape(ex.what()) << "\"}\n";
+    }
+
+    if (!response_send(fd, out.str())) {
+        const char *err_str;
+        ipx_strerror(errno, err_str);
+        IPX_CTX_WARNING(m_ctx, "Failed to send a result of a query: %s", err_str);
+    }
+}
+
+/**
+ * @brief Read a description of a query
+ *
+ * The description ends with an empty line or when the client closes its side of the connection.
+ * @param[in]  fd      Socket of the client
+ * @param[out] request The description
+ * @return False if the description cannot be read (an error is logged)
+ */
+bool
+Server::request_read(int fd, std::string &request)
+{
+    char buffer[4096];
+
+    while (request.find("\n\n") == std::string::npos) {
+        const ssize_t ret = recv(fd, buffer, sizeof(buffer), 0);
+        if (ret == 0) {
+            break;
+        }
+
+        if (ret < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+
+            const char *err_str;
+            ipx_strerror(errno, err_str);
+            IPX_CTX_WARNING(m_ctx, "Failed to receive a query: %s", err_str);
+            return false;
+        }
+
+        request.append(buffer, static_cast<size_t>(ret));
+        if (request.size() > REQUEST_MAX) {
+            IPX_CTX_WARNING(m_ctx, "Description of a query is too long (max. %zu bytes)",
+                REQUEST_MAX);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * @brief Send a result to a client
+ * @param[in] fd       Socket of the client
+ * @param[in] response The result
+ * @return False on failure (errno is set)
+ */
+bool
+Server::response_send(int fd, const std::string &response)
+{
+    size_t sent = 0;
+
+    while (sent < response.size()) {
+        const ssize_t ret = send(fd, response.data() + sent, response.size() - sent,
+            MSG_NOSIGNAL);
+        if (ret < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        sent += static_cast<size_t>(ret);
+    }
+
+    return true;
+}
@@ -0,0 +1,92 @@
+/**
+ * \file src/plugins/output/recent/src/Server.hpp
+ * \author agent <agent@local>
+ * \brief Server of queries over a Unix socket (header file)
+ * \date 2026
+ *
+ * Copyright(c) 2026 CESNET z.s.p.o.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef IPFIXCOL2_RECENT_SERVER_HPP
+#define IPFIXCOL2_RECENT_SERVER_HPP
+
+#include <string>
+#include <thread>
+#include <ipfixcol2.h>
+
+#include "common/common.hpp"
+#include "Config.hpp"
+#include "Store.hpp"
+
+/**
+ * @brief Server of queries over a Unix socket
+ *
+ * A client connects to the socket, sends a description of a query (see Query) terminated by
+ * an empty line (or by closing its side of the connection) and receives the result. The
+ * connection is closed by the server after the result is sent. Clients are served one by one
+ * by a thread of the server, while each query can use multiple threads.
+ *
+ * If the query fails, the result is a JSON object with the description of the error, e.g.
+ * {"error":"..."}.
+ */
+class Server {
+public:
+    /**
+     * @brief Create the socket and start the thread of the server
+     * @note An existing socket of the same path (e.g. of a crashed instance) is replaced.
+     * @param[in] ctx   Plugin context (only for log)
+     * @param[in] cfg   Configuration of the plugin
+     * @param[in] store Store of records
+     * @param[in] iemgr Manager of Information Elements of the store
+     * @throw runtime_error if the socket cannot be created or the thread cannot be started
+     */
+    Server(ipx_ctx_t *ctx, const Config &cfg, Store &store, fdsdump::shared_iemgr iemgr);
+    /**
+     * @brief Stop the thread and remove the socket
+     */
+    ~Server();
+
+    // Disable copy constructors
+    Server(const Server &other) = delete;
+    Server &operator=(const Server &other) = delete;
+
+private:
+    /// Maximum size of a description of a query
+    static const size_t REQUEST_MAX = 64U * 1024U;
+    /// Timeout of receiving a description of a query (in seconds)
+    static const int RECV_TIMEOUT = 5;
+    /// Timeout of sending of a result (in seconds)
+    static const int SEND_TIMEOUT = 30;
+
+    /// Plugin context only for logging!
+    ipx_ctx_t *m_ctx;
+    /// Configuration of the plugin
+    const Config &m_cfg;
+    /// Store of records
+    Store &m_store;
+    /// Manager of Information Elements of the store
+    fdsdump::shared_iemgr m_iemgr;
+
+    /// Listening socket
+    int m_fd = -1;
+    /// The socket file has been created
+    bool m_bound = false;
+    /// Pipe for stop requests (read and write end)
+    int m_pipe[2] = {-1, -1};
+    /// Thread
+    std::thread m_thread;
+
+    void
+    close_all();
+    void
+    thread_main();
+    void
+    client_handle(int fd);
+    bool
+    request_read(int fd, std::string &request);
+    bool
+    response_send(int fd, const std::string &response);
+};
+
+#endif // IPFIXCOL2_RECENT_SERVER_HPP
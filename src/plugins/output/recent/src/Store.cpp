@@ -0,0 +1,179 @@
+/**
+ * \file src/plugins/output/recent/src/Store.cpp
+ * \author agent <agent@local>
+ * \brief In-memory store of recent flow records (source file)
+ * \date 2026
+ *
+ * Copyright(c) 2026 CESNET z.s.p.o.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include <cstdint>
+#include <new>
+#include "Store.hpp"
+
+Store::Store(const fds_iemgr_t *iemgr, uint32_t window, uint32_t slice, uint64_t mem_limit)
+    : m_iemgr(iemgr), m_window(window), m_slice(slice), m_mem_limit(mem_limit)
+{
+}
+
+void
+Store::add(ipx_msg_ipfix_t *msg, time_t now)
+{
+    const time_t slice = now - (now % m_slice);
+    const uint32_t rec_cnt = ipx_msg_ipfix_get_drec_cnt(msg);
+    // Templates of the message remain valid until the message is destroyed
+    const struct fds_template *last_tmplt = nullptr;
+    uint16_t last_idx = 0;
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    for (uint32_t i = 0; i < rec_cnt; ++i) {
+        const struct fds_drec &rec = ipx_msg_ipfix_get_drec(msg, i)->rec;
+        if (rec.tmplt->type != FDS_TYPE_TEMPLATE) {
+            // Options Templates don't describe flows
+            continue;
+        }
+
+        if (m_active && (m_active->slice != slice
+                || m_active->data.size() + rec.size > BLOCK_SIZE
+                || (rec.tmplt != last_tmplt && m_active->tmplts.size() == UINT16_MAX))) {
+            seal();
+        }
+
+        if (!m_active) {
+            m_active = std::make_shared<Block>();
+            m_active->slice = slice;
+            m_active->data.reserve(BLOCK_SIZE);
+            last_tmplt = nullptr;
+        }
+
+        if (rec.tmplt != last_tmplt) {
+            last_idx = tmplt_get(rec.tmplt);
+            last_tmplt = rec.tmplt;
+        }
+
+        Block &block = *m_active;
+        block.recs.push_back({static_cast<uint32_t>(block.data.size()), rec.size, last_idx});
+        block.data.insert(block.data.end(), rec.data, rec.data + rec.size);
+    }
+
+    expire(now);
+}
+
+std::vector<std::shared_ptr<const Block>>
+Store::snapshot(time_t since)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    seal();
+
+    std::vector<std::shared_ptr<const Block>> blocks;
+    for (const auto &block : m_blocks) {
+        if (block->slice + static_cast<time_t>(m_slice) > since) {
+            blocks.push_back(block);
+        }
+    }
+    return blocks;
+}
+
+/**
+ * @brief Get the index of a Template in the active block
+ *
+ * The Template is copied (or an existing copy of an identical Template is used) and added to
+ * the block, if it's not there yet.
+ * @param[in] tmplt Template of a Data Record of the processed message
+ * @throw bad_alloc if memory allocation fails
+ */
+uint16_t
+Store::tmplt_get(const struct fds_template *tmplt)
+{
+    std::string key(1, static_cast<char>(tmplt->type));
+    key.append(reinterpret_cast<const char *>(tmplt->raw.data), tmplt->raw.length);
+
+    auto cache_it = m_tmplts.find(key);
+    if (cache_it == m_tmplts.end()) {
+        shared_tmplt copy(fds_template_copy(tmplt), &fds_template_destroy);
+        if (!copy) {
+            throw std::bad_alloc();
+        }
+        // Definitions of the collector might be freed when its configuration is reloaded
+        if (fds_template_ies_define(copy.get(), m_iemgr, false) != FDS_OK) {
+            throw std::bad_alloc();
+        }
+        cache_it = m_tmplts.emplace(std::move(key), std::move(copy)).first;
+    }
+
+    Block &block = *m_active;
+    const struct fds_template *copy = cache_it->second.get();
+    auto idx_it = block.tmplt_idx.find(copy);
+    if (idx_it != block.tmplt_idx.end()) {
+        return idx_it->second;
+    }
+
+    const uint16_t idx = static_cast<uint16_t>(block.tmplts.size());
+    block.tmplts.push_back(cache_it->second);
+    block.tmplt_idx.emplace(copy, idx);
+    return idx;
+}
+
+/**
+ * @brief Seal the active block (if any), i.e. make it visible to queries
+ */
+void
+Store::seal()
+{
+    if (!m_active) {
+        return;
+    }
+
+    if (!m_active->recs.empty()) {
+        m_active->data.shrink_to_fit();
+        m_active->recs.shrink_to_fit();
+        m_memory += m_active->memory();
+        m_blocks.push_back(std::move(m_active));
+    }
+
+    m_active.reset();
+}
+
+/**
+ * @brief Remove blocks of expired time slices and the oldest blocks over the memory limit
+ * @param[in] now Current time
+ */
+void
+Store::expire(time_t now)
+{
+    const time_t oldest = now - static_cast<time_t>(m_window);
+    const uint64_t active = m_active ? m_active->memory() : 0;
+    bool removed = false;
+
+    while (!m_blocks.empty()) {
+        const Block &block = *m_blocks.front();
+        const bool expired = block.slice + static_cast<time_t>(m_slice) <= oldest;
+        if (!expired && m_memory + active <= m_mem_limit) {
+            break;
+        }
+
+        if (!expired) {
+            m_dropped += block.recs.size();
+        }
+
+        // Queries that still refer to the block keep it until they finish
+        m_memory -= block.memory();
+        m_blocks.pop_front();
+        removed = true;
+    }
+
+    if (!removed) {
+        return;
+    }
+
+    // Remove copies of Templates that are not used by any block anymore
+    for (auto it = m_tmplts.begin(); it != m_tmplts.end(); ) {
+        if (it->second.use_count() == 1) {
+            it = m_tmplts.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
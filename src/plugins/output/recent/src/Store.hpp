@@ -0,0 +1,160 @@
+/**
+ * \file src/plugins/output/recent/src/Store.hpp
+ * \author agent <agent@local>
+ * \brief In-memory store of recent flow records (header file)
+ * \date 2026
+ *
+ * Copyright(c) 2026 CESNET z.s.p.o.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef IPFIXCOL2_RECENT_STORE_HPP
+#define IPFIXCOL2_RECENT_STORE_HPP
+
+#include <cstdint>
+#include <ctime>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <ipfixcol2.h>
+#include <libfds.h>
+
+/// Template shared by blocks (a private copy, see Store)
+using shared_tmplt = std::shared_ptr<struct fds_template>;
+
+/**
+ * @brief Block of Data Records of a time slice
+ *
+ * Data Records are stored back-to-back in their original (IPFIX) form, so the filter and the
+ * aggregator of fdsdump can process them in place. A block is immutable once it's sealed by
+ * the store, therefore, it can be scanned by queries without any locking.
+ */
+struct Block {
+    /// Position of a Data Record in the block
+    struct record {
+        uint32_t offset; ///< Offset of the record in data
+        uint16_t size;   ///< Size of the record
+        uint16_t tmplt;  ///< Index of the Template in tmplts
+    };
+
+    /// Start of the time slice (seconds since UNIX epoch)
+    time_t slice;
+    /// Raw Data Records
+    std::vector<uint8_t> data;
+    /// Positions of Data Records
+    std::vector<record> recs;
+    /// Templates of Data Records
+    std::vector<shared_tmplt> tmplts;
+    /// Indexes of Templates in tmplts
+    std::unordered_map<const struct fds_template *, uint16_t> tmplt_idx;
+
+    /// Get the amount of memory occupied by the block (in bytes)
+    size_t
+    memory() const
+    {
+        return sizeof(*this) + data.capacity() + recs.capacity() * sizeof(record);
+    }
+
+    /**
+     * @brief Get a Data Record
+     * @param[in]  idx Index of the record
+     * @param[out] rec The record
+     */
+    void
+    get(size_t idx, struct fds_drec &rec) const
+    {
+        const record &pos = recs[idx];
+        rec.data = const_cast<uint8_t *>(data.data() + pos.offset);
+        rec.size = pos.size;
+        rec.tmplt = tmplts[pos.tmplt].get();
+        rec.snap = nullptr;
+    }
+};
+
+/**
+ * @brief Time-partitioned ring of blocks of recent flow records
+ *
+ * Records are assigned to time slices by the time of their arrival. Blocks of slices older than
+ * the window are removed, as well as the oldest blocks whenever the memory limit is exceeded.
+ * Records are appended to the active block, which is sealed (i.e. made visible to queries)
+ * when it's full, when a new time slice starts or when a query takes a snapshot of the store.
+ *
+ * Templates are copied and their Information Elements are defined by the manager of the store,
+ * so records remain valid after Templates of their exporters are withdrawn or the collector
+ * reloads its configuration. Copies of identical Templates are shared by all blocks.
+ */
+class Store {
+public:
+    /**
+     * @brief Create an empty store
+     * @param[in] iemgr     Manager of Information Elements of stored records
+     * @param[in] window    Length of the history (in seconds)
+     * @param[in] slice     Length of time slices (in seconds)
+     * @param[in] mem_limit Maximum amount of memory of stored records (in bytes)
+     */
+    Store(const fds_iemgr_t *iemgr, uint32_t window, uint32_t slice, uint64_t mem_limit);
+    ~Store() = default;
+
+    // Disable copy constructors
+    Store(const Store &other) = delete;
+    Store &operator=(const Store &other) = delete;
+
+    /**
+     * @brief Add all Data Records of an IPFIX Message
+     * @param[in] msg IPFIX Message
+     * @param[in] now Time of arrival
+     */
+    void
+    add(ipx_msg_ipfix_t *msg, time_t now);
+
+    /**
+     * @brief Get blocks with records of recent time slices (the oldest first)
+     *
+     * The active block is sealed, so the snapshot contains all records added so far.
+     * @param[in] since Skip time slices that end before this time
+     */
+    std::vector<std::shared_ptr<const Block>>
+    snapshot(time_t since);
+
+    /// Get the number of removed Data Records due to the memory limit
+    uint64_t
+    dropped() const { return m_dropped; }
+
+private:
+    /// Maximum size of data of a block
+    static const size_t BLOCK_SIZE = 4U * 1024U * 1024U;
+
+    /// Manager of Information Elements of stored records
+    const fds_iemgr_t *m_iemgr;
+    /// Length of the history (in seconds)
+    uint32_t m_window;
+    /// Length of time slices (in seconds)
+    uint32_t m_slice;
+    /// Maximum amount of memory of stored records (in bytes)
+    uint64_t m_mem_limit;
+
+    /// Synchronization of writers and queries
+    std::mutex m_mutex;
+    /// Sealed blocks (the oldest first)
+    std::deque<std::shared_ptr<Block>> m_blocks;
+    /// Active block (can be null)
+    std::shared_ptr<Block> m_active;
+    /// Amount of memory of sealed blocks
+    uint64_t m_memory = 0;
+    /// Number of removed Data Records due to the memory limit
+    uint64_t m_dropped = 0;
+    /// Copies of Templates (identified by their type and raw definition)
+    std::unordered_map<std::string, shared_tmplt> m_tmplts;
+
+    uint16_t
+    tmplt_get(const struct fds_template *tmplt);
+    void
+    seal();
+    void
+    expire(time_t now);
+};
+
+#endif // IPFIXCOL2_RECENT_STORE_HPP
@@ -0,0 +1,103 @@
+/**
+ * \file src/plugins/output/recent/src/recent.cpp
+ * \author agent <agent@local>
+ * \brief In-memory store of recent flow records (output plugin)
+ * \date 2026
+ *
+ * Copyright(c) 2026 CESNET z.s.p.o.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include <cinttypes>
+#include <ctime>
+#include <memory>
+#include <stdexcept>
+#include <ipfixcol2.h>
+
+#include "Config.hpp"
+#include "Server.hpp"
+#include "Store.hpp"
+
+/// Plugin description
+IPX_API struct ipx_plugin_info ipx_plugin_info = {
+    // Plugin identification name
+    "recent",
+    // Brief description of plugin
+    "In-memory store of recent flow records with queries over a Unix socket",
+    // Plugin type
+    IPX_PT_OUTPUT,
+    // Configuration flags (reserved for future use)
+    0,
+    // Plugin version string (like "1.2.3")
+    "2.0.0",
+    // Minimal IPFIXcol version string (like "1.2.3")
+    "2.0.0"
+};
+
+/// Instance
+struct Instance {
+    /// Parsed configuration
+    std::unique_ptr<Config> config_ptr = nullptr;
+    /// Manager of Information Elements of stored records
+    fdsdump::shared_iemgr iemgr;
+    /// Store of records
+    std::unique_ptr<Store> store_ptr = nullptr;
+    /// Server of queries (must be destroyed before the store)
+    std::unique_ptr<Server> server_ptr = nullptr;
+};
+
+int
+ipx_plugin_init(ipx_ctx_t *ctx, const char *params)
+{
+    try {
+        std::unique_ptr<Instance> instance(new Instance);
+        instance->config_ptr.reset(new Config(params));
+        const Config &cfg = *instance->config_ptr;
+
+        // Private copy, the manager of the collector might be replaced
+        instance->iemgr.reset(fds_iemgr_copy(ipx_ctx_iemgr_get(ctx)), &fds_iemgr_destroy);
+        if (!instance->iemgr) {
+            throw std::runtime_error("Failed to copy the manager of Information Elements!");
+        }
+
+        instance->store_ptr.reset(new Store(instance->iemgr.get(), cfg.m_window, cfg.m_slice,
+            cfg.m_mem_limit));
+        instance->server_ptr.reset(new Server(ctx, cfg, *instance->store_ptr, instance->iemgr));
+        ipx_ctx_private_set(ctx, instance.release());
+    } catch (const std::exception &ex) {
+        IPX_CTX_ERROR(ctx, "Initialization failed: %s", ex.what());
+        return IPX_ERR_DENIED;
+    } catch (...) {
+        IPX_CTX_ERROR(ctx, "Unknown error has occurred!", '\0');
+        return IPX_ERR_DENIED;
+    }
+
+    return IPX_OK;
+}
+
+void
+ipx_plugin_destroy(ipx_ctx_t *ctx, void *cfg)
+{
+    auto inst = reinterpret_cast<Instance *>(cfg);
+
+    inst->server_ptr.reset();
+    if (inst->store_ptr->dropped() != 0) {
+        IPX_CTX_INFO(ctx, "%" PRIu64 " flow records have been removed before the end of the "
+            "window due to the memory limit", inst->store_ptr->dropped());
+    }
+    delete inst;
+}
+
+int
+ipx_plugin_process(ipx_ctx_t *ctx, void *cfg, ipx_msg_t *msg)
+{
+    auto inst = reinterpret_cast<Instance *>(cfg);
+
+    try {
+        inst->store_ptr->add(ipx_msg_base2ipfix(msg), time(nullptr));
+    } catch (const std::exception &ex) {
+        IPX_CTX_ERROR(ctx, "Failed to store flow records: %s", ex.what());
+    }
+
+    return IPX_OK;
+}
@@ -0,0 +1,221 @@
+/**
+ * \file src/plugins/output/shm/config.c
+ * \author agent <agent@local>
+ * \brief Configuration parser of the shared memory output plugin (source file)
+ * \date 2026
+ */
+
+/* Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is'', and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <inttypes.h>
+#include "config.h"
+
+/** Default size of the data area (in MiB)                                                       */
+#define SIZE_DEF (64U)
+/** Maximum size of the data area (in MiB)                                                       */
+#define SIZE_MAX_MIB (65536U)
+/** Maximum length of the name of a shared memory object (without the leading '/')               */
+#define NAME_MAX_LEN (200U)
+
+/*
+ * <params>
+ *  <name>...</name>                              <!-- mandatory                 -->
+ *  <size>...</size>                              <!-- optional                  -->
+ * </params>
+ */
+
+/** XML nodes */
+enum params_xml_nodes {
+    NODE_NAME = 1,
+    NODE_SIZE
+};
+
+/** Definition of the \<params\> node  */
+static const struct fds_xml_args args_params[] = {
+    FDS_OPTS_ROOT("params"),
+    FDS_OPTS_ELEM(NODE_NAME, "name", FDS_OPTS_T_STRING, 0),
+    FDS_OPTS_ELEM(NODE_SIZE, "size", FDS_OPTS_T_UINT,   FDS_OPTS_P_OPT),
+    FDS_OPTS_END
+};
+
+/**
+ * \brief Set the name of the shared memory object
+ *
+ * The leading '/' is optional in the configuration, but the name must not contain any other '/'.
+ * \param[in] ctx  Plugin context
+ * \param[in] cfg  Configuration
+ * \param[in] name Name of the object
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_FORMAT in case of failure
+ */
+static int
+config_set_name(ipx_ctx_t *ctx, struct shm_config *cfg, const char *name)
+{
+    if (name[0] == '/') {
+        name++;
+    }
+
+    size_t len = strlen(name);
+    if (len == 0 || len > NAME_MAX_LEN || strchr(name, '/') != NULL) {
+        IPX_CTX_ERROR(ctx, "Invalid name of the shared memory object '%s' (must be a non-empty "
+            "string of at most %u characters without '/')", name, NAME_MAX_LEN);
+        return IPX_ERR_FORMAT;
+    }
+
+    free(cfg->name);
+    cfg->name = malloc(len + 2);
+    if (!cfg->name) {
+        IPX_CTX_ERROR(ctx, "Memory allocation error (%s:%d)", __FILE__, __LINE__);
+        return IPX_ERR_FORMAT;
+    }
+
+    snprintf(cfg->name, len + 2, "/%s", name);
+    return IPX_OK;
+}
+
+/**
+ * \brief Process \<params\> node
+ * \param[in] ctx  Plugin context
+ * \param[in] root XML context to process
+ * \param[in] cfg  Parsed configuration
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_FORMAT in case of failure
+ */
+static int
+config_parser_root(ipx_ctx_t *ctx, fds_xml_ctx_t *root, struct shm_config *cfg)
+{
+    const struct fds_xml_cont *content;
+    while (fds_xml_next(root, &content) != FDS_EOC) {
+        switch (content->id) {
+        case NODE_NAME:
+            // Name of the shared memory object
+            assert(content->type == FDS_OPTS_T_STRING);
+            if (config_set_name(ctx, cfg, content->ptr_string) != IPX_OK) {
+                return IPX_ERR_FORMAT;
+            }
+            break;
+        case NODE_SIZE:
+            // Size of the data area (in MiB)
+            assert(content->type == FDS_OPTS_T_UINT);
+            if (content->val_uint < 1 || content->val_uint > SIZE_MAX_MIB) {
+                IPX_CTX_ERROR(ctx, "Size must be between 1..%u MiB", (unsigned) SIZE_MAX_MIB);
+                return IPX_ERR_FORMAT;
+            }
+            cfg->size = content->val_uint;
+            break;
+        default:
+            // Internal error
+            assert(false);
+        }
+    }
+
+    // Round the size up to a power of two (i.e. positions can be masked)
+    uint64_t size = 1;
+    while (size < cfg->size) {
+        size <<= 1;
+    }
+    if (size != cfg->size) {
+        IPX_CTX_INFO(ctx, "Size of the shared memory rounded up to %" PRIu64 " MiB", size);
+    }
+    cfg->size = size * 1024U * 1024U;
+    return IPX_OK;
+}
+
+/**
+ * \brief Set default parameters of the configuration
+ * \param[in] cfg Configuration
+ */
+static void
+config_default_set(struct shm_config *cfg)
+{
+    cfg->name = NULL;
+    cfg->size = SIZE_DEF;
+}
+
+struct shm_config *
+config_parse(ipx_ctx_t *ctx, const char *params)
+{
+    struct shm_config *cfg = calloc(1, sizeof(*cfg));
+    if (!cfg) {
+        IPX_CTX_ERROR(ctx, "Memory allocation error (%s:%d)", __FILE__, __LINE__);
+        return NULL;
+    }
+
+    // Set default parameters
+    config_default_set(cfg);
+
+    // Create an XML parser
+    fds_xml_t *parser = fds_xml_create();
+    if (!parser) {
+        IPX_CTX_ERROR(ctx, "Memory allocation error (%s:%d)", __FILE__, __LINE__);
+        config_destroy(cfg);
+        return NULL;
+    }
+
+    if (fds_xml_set_args(parser, args_params) != IPX_OK) {
+        IPX_CTX_ERROR(ctx, "Failed to parse the description of an XML document!", '\0');
+        fds_xml_destroy(parser);
+        config_destroy(cfg);
+        return NULL;
+    }
+
+    fds_xml_ctx_t *params_ctx = fds_xml_parse_mem(parser, params, true);
+    if (params_ctx == NULL) {
+        IPX_CTX_ERROR(ctx, "Failed to parse the configuration: %s", fds_xml_last_err(parser));
+        fds_xml_destroy(parser);
+        config_destroy(cfg);
+        return NULL;
+    }
+
+    // Parse parameters
+    int rc = config_parser_root(ctx, params_ctx, cfg);
+    fds_xml_destroy(parser);
+    if (rc != IPX_OK) {
+        config_destroy(cfg);
+        return NULL;
+    }
+
+    return cfg;
+}
+
+void
+config_destroy(struct shm_config *cfg)
+{
+    free(cfg->name);
+    free(cfg);
+}
@@ -0,0 +1,748 @@
+/**
+ * \file src/plugins/output/shm/shm.c
+ * \author agent <agent@local>
+ * \brief Shared memory output plugin (source file)
+ * \date 2026
+ */
+
+/* Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is'', and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#include <ipfixcol2.h>
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <sys/uio.h>
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <unistd.h>
+
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <inttypes.h>
+#include <time.h>
+#include "config.h"
+#include "shm_ring.h"
+
+/** Identification of an invalid file descriptor                                                 */
+#define INVALID_FD        (-1)
+/** Delay between checks of free space while waiting for the reader (in microseconds)           */
+#define WAIT_DELAY        (100)
+
+/** Plugin description */
+IPX_API struct ipx_plugin_info ipx_plugin_info = {
+    // Plugin type
+    .type = IPX_PT_OUTPUT,
+    // Plugin identification name
+    .name = "shm",
+    // Brief description of plugin
+    .dsc = "Output plugin for passing IPFIX Messages to another collector via shared memory.",
+    // Configuration flags (only raw IPFIX Messages are passed)
+    .flags = IPX_PF_RAW,
+    // Plugin version string (like "1.2.3")
+    .version = "2.0.0",
+    // Minimal IPFIXcol version string (like "1.2.3")
+    .ipx_min = "2.0.0"
+};
+
+/** Transport Session forwarded to the reader                                                    */
+struct shm_session {
+    /** Transport Session                                                                        */
+    const struct ipx_session *session;
+    /** Identification of the session in the shared memory                                       */
+    uint32_t id;
+    /** The session has been announced to the reader of the generation #gen                      */
+    bool announced;
+    /** Generation of the reader to which the session has been announced                         */
+    uint64_t gen;
+
+    struct {
+        /** Number of ODIDs                                                                      */
+        size_t cnt;
+        /** Array of ODIDs                                                                       */
+        uint32_t *arr;
+    } odids; /**< ODIDs whose (Options) Templates have been passed to the reader                 */
+};
+
+/** Instance data                                                                                */
+struct shm_data {
+    /** Instance context                                                                         */
+    ipx_ctx_t *ctx;
+    /** Parsed configuration                                                                     */
+    struct shm_config *config;
+    /** File descriptor of the shared memory object                                              */
+    int fd;
+    /** Mapped shared memory object                                                              */
+    struct shm_ring_hdr *hdr;
+    /** Data area of the ring                                                                    */
+    uint8_t *ring;
+    /** Position of the writer (local copy of the head)                                          */
+    uint64_t head;
+    /** Last known generation of the reader                                                      */
+    uint64_t reader_gen;
+    /** Process ID of a reader that has been found dead                                          */
+    uint32_t reader_dead;
+    /** Identification of the next Transport Session                                             */
+    uint32_t session_next;
+    /** Buffer for IPFIX Messages with (Options) Templates                                       */
+    uint8_t *tmplt_buffer;
+
+    struct {
+        /** Number of sessions                                                                   */
+        size_t cnt;
+        /** Array of sessions                                                                    */
+        struct shm_session *arr;
+    } sessions; /**< Known Transport Sessions                                                    */
+
+    /** Number of IPFIX Messages dropped due to lack of space                                    */
+    uint64_t dropped;
+};
+
+/** Auxiliary data for building IPFIX Messages with (Options) Templates                          */
+struct tmplt_aux {
+    /** Instance data                                                                            */
+    struct shm_data *data;
+    /** Transport Session                                                                        */
+    struct shm_session *sess;
+    /** Template of the IPFIX Message header (i.e. ODID, Sequence Number, Export Time)          */
+    struct fds_ipfix_msg_hdr hdr;
+    /** Stream ID of the IPFIX Messages                                                          */
+    uint16_t stream;
+    /** Size of the IPFIX Message being built                                                    */
+    uint16_t size;
+    /** All messages have been written                                                           */
+    bool ok;
+};
+
+/**
+ * \brief Check whether the attached reader is able to consume records
+ *
+ * Liveness of the reader is checked only if the ring is full, so a reader that crashes is
+ * detected only by the writer that waits for free space.
+ * \param[in] data Instance data
+ * \return True, if the reader is attached and its process exists
+ */
+static bool
+reader_alive(struct shm_data *data)
+{
+    uint32_t pid = __atomic_load_n(&data->hdr->reader_pid, __ATOMIC_ACQUIRE);
+    if (pid == 0 || pid == data->reader_dead) {
+        return false;
+    }
+
+    if (kill((pid_t) pid, 0) == -1 && errno == ESRCH) {
+        IPX_CTX_WARNING(data->ctx, "Reader (PID %" PRIu32 ") of the shared memory object '%s' "
+            "doesn't exist anymore. Messages will be dropped until a new reader is attached.",
+            pid, data->config->name);
+        data->reader_dead = pid;
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * \brief Write a record to the ring
+ *
+ * If there is not enough free space and the reader is alive, the function waits until the
+ * reader consumes older records. Otherwise the record is dropped.
+ * \param[in] data   Instance data
+ * \param[in] rec    Header of the record (size and length are filled by the function)
+ * \param[in] iov    Parts of the payload
+ * \param[in] iovcnt Number of parts of the payload
+ * \return True, if the record has been written
+ */
+static bool
+ring_write(struct shm_data *data, struct shm_rec *rec, const struct iovec *iov, int iovcnt)
+{
+    const uint64_t ring_size = data->config->size;
+    uint64_t len = 0;
+    for (int i = 0; i < iovcnt; ++i) {
+        len += iov[i].iov_len;
+    }
+
+    if (len > ring_size / 2) {
+        return false;
+    }
+
+    rec->len = (uint32_t) len;
+    rec->size = shm_rec_size(rec->len);
+    rec->reserved = 0;
+
+    // A record is never split, i.e. the rest of the data area is skipped if necessary
+    const uint64_t skip = shm_ring_skip(data->head, ring_size, rec->size);
+    const uint64_t need = skip + rec->size;
+
+    uint64_t tail = __atomic_load_n(&data->hdr->tail, __ATOMIC_ACQUIRE);
+    while (data->head + need - tail > ring_size) {
+        if (!reader_alive(data)) {
+            return false;
+        }
+
+        const struct timespec delay = {0, WAIT_DELAY * 1000L};
+        nanosleep(&delay, NULL);
+        tail = __atomic_load_n(&data->hdr->tail, __ATOMIC_ACQUIRE);
+    }
+
+    if (skip >= sizeof(struct shm_rec)) {
+        struct shm_rec pad;
+        memset(&pad, 0, sizeof(pad));
+        pad.size = (uint32_t) skip;
+        pad.type = SHM_REC_PAD;
+        memcpy(data->ring + (data->head & (ring_size - 1)), &pad, sizeof(pad));
+    }
+
+    uint8_t *ptr = data->ring + ((data->head + skip) & (ring_size - 1));
+    memcpy(ptr, rec, sizeof(*rec));
+    ptr += sizeof(*rec);
+    for (int i = 0; i < iovcnt; ++i) {
+        memcpy(ptr, iov[i].iov_base, iov[i].iov_len);
+        ptr += iov[i].iov_len;
+    }
+
+    // Publish the record
+    data->head += need;
+    __atomic_store_n(&data->hdr->head, data->head, __ATOMIC_RELEASE);
+    return true;
+}
+
+/**
+ * \brief Find a Transport Session
+ * \param[in] data    Instance data
+ * \param[in] session Transport Session
+ * \return Pointer to the session or NULL
+ */
+static struct shm_session *
+session_find(struct shm_data *data, const struct ipx_session *session)
+{
+    for (size_t i = 0; i < data->sessions.cnt; ++i) {
+        if (data->sessions.arr[i].session == session) {
+            return &data->sessions.arr[i];
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * \brief Add a new Transport Session
+ * \param[in] data    Instance data
+ * \param[in] session Transport Session
+ * \return Pointer to the session or NULL (memory allocation error)
+ */
+static struct shm_session *
+session_add(struct shm_data *data, const struct ipx_session *session)
+{
+    size_t alloc_size = (data->sessions.cnt + 1) * sizeof(struct shm_session);
+    struct shm_session *new_arr = realloc(data->sessions.arr, alloc_size);
+    if (!new_arr) {
+        IPX_CTX_ERROR(data->ctx, "Memory allocation failed! (%s:%d)", __FILE__, __LINE__);
+        return NULL;
+    }
+    data->sessions.arr = new_arr;
+
+    struct shm_session *sess = &data->sessions.arr[data->sessions.cnt++];
+    memset(sess, 0, sizeof(*sess));
+    sess->session = session;
+    sess->id = data->session_next++;
+    return sess;
+}
+
+/**
+ * \brief Remove a Transport Session
+ *
+ * If the session has been announced to the current reader, the reader is informed.
+ * \param[in] data Instance data
+ * \param[in] sess Session to remove
+ */
+static void
+session_remove(struct shm_data *data, struct shm_session *sess)
+{
+    if (sess->announced && sess->gen == data->reader_gen) {
+        struct shm_rec rec;
+        memset(&rec, 0, sizeof(rec));
+        rec.type = SHM_REC_SESSION_CLOSE;
+        rec.session = sess->id;
+        ring_write(data, &rec, NULL, 0);
+    }
+
+    free(sess->odids.arr);
+    size_t idx = (size_t) (sess - data->sessions.arr);
+    data->sessions.arr[idx] = data->sessions.arr[data->sessions.cnt - 1];
+    data->sessions.cnt--;
+}
+
+/**
+ * \brief Announce a Transport Session to the reader
+ * \param[in] data Instance data
+ * \param[in] sess Session
+ * \return True on success
+ */
+static bool
+session_announce(struct shm_data *data, struct shm_session *sess)
+{
+    const struct ipx_session *session = sess->session;
+    const struct ipx_session_net *net = NULL;
+    struct shm_session_desc desc;
+    memset(&desc, 0, sizeof(desc));
+    desc.type = (uint16_t) session->type;
+
+    struct iovec iov[2];
+    int iovcnt = 1;
+    iov[0].iov_base = &desc;
+    iov[0].iov_len = sizeof(desc);
+
+    switch (session->type) {
+    case FDS_SESSION_UDP:
+        net = &session->udp.net;
+        desc.lifetime_tmplts = session->udp.lifetime.tmplts;
+        desc.lifetime_opts = session->udp.lifetime.opts_tmplts;
+        break;
+    case FDS_SESSION_TCP:
+        net = &session->tcp.net;
+        break;
+    case FDS_SESSION_SCTP:
+        net = &session->sctp.net;
+        break;
+    case FDS_SESSION_FILE:
+        iov[1].iov_base = session->file.file_path;
+        iov[1].iov_len = strlen(session->file.file_path) + 1;
+        iovcnt = 2;
+        break;
+    default:
+        return false;
+    }
+
+    if (net != NULL) {
+        desc.l3_proto = net->l3_proto;
+        desc.port_src = net->port_src;
+        desc.port_dst = net->port_dst;
+        size_t addr_len = (net->l3_proto == AF_INET) ? 4 : 16;
+        memcpy(desc.addr_src, &net->addr_src, addr_len);
+        memcpy(desc.addr_dst, &net->addr_dst, addr_len);
+    }
+
+    struct shm_rec rec;
+    memset(&rec, 0, sizeof(rec));
+    rec.type = SHM_REC_SESSION_OPEN;
+    rec.session = sess->id;
+    if (!ring_write(data, &rec, iov, iovcnt)) {
+        return false;
+    }
+
+    sess->announced = true;
+    sess->gen = data->reader_gen;
+    sess->odids.cnt = 0;
+    return true;
+}
+
+/**
+ * \brief Write the IPFIX Message with (Options) Templates being built
+ * \param[in] aux Auxiliary data
+ */
+static void
+tmplt_flush(struct tmplt_aux *aux)
+{
+    if (aux->size <= FDS_IPFIX_MSG_HDR_LEN) {
+        return;
+    }
+
+    struct fds_ipfix_msg_hdr *hdr = (struct fds_ipfix_msg_hdr *) aux->data->tmplt_buffer;
+    *hdr = aux->hdr;
+    hdr->length = htons(aux->size);
+
+    struct shm_rec rec;
+    memset(&rec, 0, sizeof(rec));
+    rec.type = SHM_REC_MESSAGE;
+    rec.session = aux->sess->id;
+    rec.odid = ntohl(aux->hdr.odid);
+    rec.stream = aux->stream;
+
+    struct iovec iov = {.iov_base = hdr, .iov_len = aux->size};
+    if (!ring_write(aux->data, &rec, &iov, 1)) {
+        aux->ok = false;
+    }
+    aux->size = FDS_IPFIX_MSG_HDR_LEN;
+}
+
+/**
+ * \brief Add an (Options) Template to the IPFIX Message being built (callback)
+ * \param[in] tmplt (Options) Template
+ * \param[in] cb    Auxiliary data
+ * \return Always true (i.e. continue)
+ */
+static bool
+tmplt_add_cb(const struct fds_template *tmplt, void *cb)
+{
+    struct tmplt_aux *aux = (struct tmplt_aux *) cb;
+    const size_t set_size = FDS_IPFIX_SET_HDR_LEN + tmplt->raw.length;
+
+    if (aux->size + set_size > UINT16_MAX) {
+        tmplt_flush(aux);
+    }
+    if (aux->size + set_size > UINT16_MAX) {
+        // Cannot be a part of a valid IPFIX Message
+        aux->ok = false;
+        return true;
+    }
+
+    // Each (Options) Template is stored in its own Set
+    uint8_t *ptr = aux->data->tmplt_buffer + aux->size;
+    struct fds_ipfix_set_hdr *set = (struct fds_ipfix_set_hdr *) ptr;
+    set->flowset_id = htons((tmplt->type == FDS_TYPE_TEMPLATE_OPTS)
+        ? FDS_IPFIX_SET_OPTS_TMPLT : FDS_IPFIX_SET_TMPLT);
+    set->length = htons((uint16_t) set_size);
+    memcpy(ptr + FDS_IPFIX_SET_HDR_LEN, tmplt->raw.data, tmplt->raw.length);
+    aux->size += (uint16_t) set_size;
+    return true;
+}
+
+/**
+ * \brief Pass all (Options) Templates of an Observation Domain to the reader
+ *
+ * The reader attaches at an arbitrary moment, so the (Options) Templates defined before are
+ * unknown to it. Templates are written as IPFIX Messages with the header of the following
+ * message (i.e. the Sequence Number is preserved because they don't contain Data Records).
+ * \param[in] data   Instance data
+ * \param[in] sess   Session
+ * \param[in] msg    IPFIX Message
+ * \param[in] stream Stream ID
+ * \return True, if the (Options) Templates have been written
+ */
+static bool
+tmplt_sync(struct shm_data *data, struct shm_session *sess, ipx_msg_ipfix_t *msg,
+    uint16_t stream)
+{
+    // Find the Template snapshot of the first Data Set (available also without parsed records)
+    struct ipx_ipfix_set *sets;
+    size_t sets_cnt;
+    const fds_tsnapshot_t *snap = NULL;
+    ipx_msg_ipfix_get_sets(msg, &sets, &sets_cnt);
+    for (size_t i = 0; i < sets_cnt && snap == NULL; ++i) {
+        if (sets[i].drec_cnt > 0) {
+            snap = sets[i].snap;
+        }
+    }
+
+    if (snap == NULL) {
+        // Nothing to synchronize yet
+        return false;
+    }
+
+    struct tmplt_aux aux;
+    aux.data = data;
+    aux.sess = sess;
+    memcpy(&aux.hdr, ipx_msg_ipfix_get_packet(msg), FDS_IPFIX_MSG_HDR_LEN);
+    aux.stream = stream;
+    aux.size = FDS_IPFIX_MSG_HDR_LEN;
+    aux.ok = true;
+
+    fds_tsnapshot_for(snap, &tmplt_add_cb, &aux);
+    tmplt_flush(&aux);
+    return aux.ok;
+}
+
+/**
+ * \brief Check whether (Options) Templates of an Observation Domain have been passed
+ * \param[in] sess Session
+ * \param[in] odid Observation Domain ID
+ * \return True or false
+ */
+static bool
+odid_synced(const struct shm_session *sess, uint32_t odid)
+{
+    for (size_t i = 0; i < sess->odids.cnt; ++i) {
+        if (sess->odids.arr[i] == odid) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/**
+ * \brief Remember that (Options) Templates of an Observation Domain have been passed
+ * \param[in] data Instance data
+ * \param[in] sess Session
+ * \param[in] odid Observation Domain ID
+ */
+static void
+odid_add(struct shm_data *data, struct shm_session *sess, uint32_t odid)
+{
+    size_t alloc_size = (sess->odids.cnt + 1) * sizeof(uint32_t);
+    uint32_t *new_arr = realloc(sess->odids.arr, alloc_size);
+    if (!new_arr) {
+        // Templates will be passed again with the next message
+        IPX_CTX_ERROR(data->ctx, "Memory allocation failed! (%s:%d)", __FILE__, __LINE__);
+        return;
+    }
+
+    new_arr[sess->odids.cnt++] = odid;
+    sess->odids.arr = new_arr;
+}
+
+/**
+ * \brief Pass an IPFIX Message to the reader
+ * \param[in] data Instance data
+ * \param[in] msg  IPFIX Message
+ */
+static void
+process_ipfix(struct shm_data *data, ipx_msg_ipfix_t *msg)
+{
+    // Skip messages if no reader is attached (the reader discards older records anyway)
+    if (!__atomic_load_n(&data->hdr->reader_pid, __ATOMIC_ACQUIRE)) {
+        return;
+    }
+
+    data->reader_gen = __atomic_load_n(&data->hdr->reader_gen, __ATOMIC_ACQUIRE);
+
+    const struct ipx_msg_ctx *msg_ctx = ipx_msg_ipfix_get_ctx(msg);
+    struct shm_session *sess = session_find(data, msg_ctx->session);
+    if (!sess && (sess = session_add(data, msg_ctx->session)) == NULL) {
+        return;
+    }
+
+    if ((!sess->announced || sess->gen != data->reader_gen) && !session_announce(data, sess)) {
+        data->dropped++;
+        return;
+    }
+
+    if (!odid_synced(sess, msg_ctx->odid) && tmplt_sync(data, sess, msg, msg_ctx->stream)) {
+        odid_add(data, sess, msg_ctx->odid);
+    }
+
+    uint8_t *packet = ipx_msg_ipfix_get_packet(msg);
+    const uint16_t size = ntohs(((struct fds_ipfix_msg_hdr *) packet)->length);
+
+    struct shm_rec rec;
+    memset(&rec, 0, sizeof(rec));
+    rec.type = SHM_REC_MESSAGE;
+    rec.session = sess->id;
+    rec.odid = msg_ctx->odid;
+    rec.stream = msg_ctx->stream;
+
+    struct iovec iov = {.iov_base = packet, .iov_len = size};
+    if (!ring_write(data, &rec, &iov, 1)) {
+        data->dropped++;
+    }
+}
+
+/**
+ * \brief Process a Transport Session event
+ * \param[in] data Instance data
+ * \param[in] msg  Session message
+ */
+static void
+process_session(struct shm_data *data, ipx_msg_session_t *msg)
+{
+    if (ipx_msg_session_get_event(msg) != IPX_MSG_SESSION_CLOSE) {
+        // New sessions are announced with their first IPFIX Message
+        return;
+    }
+
+    struct shm_session *sess = session_find(data, ipx_msg_session_get_session(msg));
+    if (sess != NULL) {
+        session_remove(data, sess);
+    }
+}
+
+/**
+ * \brief Create the shared memory object
+ *
+ * A stale object of the same name (e.g. of a crashed collector) is replaced. An already attached
+ * reader detects that the original writer doesn't exist anymore.
+ * \param[in] data Instance data
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_DENIED on failure
+ */
+static int
+shm_init(struct shm_data *data)
+{
+    const struct shm_config *cfg = data->config;
+    const size_t total = SHM_RING_HDR_SIZE + cfg->size;
+    const char *err_str;
+
+    shm_unlink(cfg->name);
+    data->fd = shm_open(cfg->name, O_RDWR | O_CREAT | O_EXCL, 0600);
+    if (data->fd == INVALID_FD) {
+        ipx_strerror(errno, err_str);
+        IPX_CTX_ERROR(data->ctx, "Failed to create the shared memory object '%s': %s",
+            cfg->name, err_str);
+        return IPX_ERR_DENIED;
+    }
+
+    if (ftruncate(data->fd, (off_t) total) == -1) {
+        ipx_strerror(errno, err_str);
+        IPX_CTX_ERROR(data->ctx, "Failed to resize the shared memory object '%s': %s",
+            cfg->name, err_str);
+        close(data->fd);
+        shm_unlink(cfg->name);
+        return IPX_ERR_DENIED;
+    }
+
+    void *addr = mmap(NULL, total, PROT_READ | PROT_WRITE, MAP_SHARED, data->fd, 0);
+    if (addr == MAP_FAILED) {
+        ipx_strerror(errno, err_str);
+        IPX_CTX_ERROR(data->ctx, "Failed to map the shared memory object '%s': %s",
+            cfg->name, err_str);
+        close(data->fd);
+        shm_unlink(cfg->name);
+        return IPX_ERR_DENIED;
+    }
+
+    // The object is zeroed by ftruncate(), the magic is set last
+    data->hdr = (struct shm_ring_hdr *) addr;
+    data->ring = shm_ring_data(data->hdr);
+    data->hdr->version = SHM_RING_VERSION;
+    data->hdr->size = cfg->size;
+    data->hdr->writer_pid = (uint32_t) getpid();
+    __atomic_store_n(&data->hdr->magic, SHM_RING_MAGIC, __ATOMIC_RELEASE);
+
+    IPX_CTX_INFO(data->ctx, "Shared memory object '%s' (%" PRIu64 " MiB) created.", cfg->name,
+        cfg->size / (1024U * 1024U));
+    return IPX_OK;
+}
+
+/**
+ * \brief Close and remove the shared memory object
+ *
+ * The reader is informed that no more records will be added. The object is removed only if it
+ * hasn't been replaced by another writer in the meantime.
+ * \param[in] data Instance data
+ */
+static void
+shm_destroy(struct shm_data *data)
+{
+    __atomic_store_n(&data->hdr->closed, 1, __ATOMIC_RELEASE);
+
+    struct stat st_own, st_cur;
+    int fd = shm_open(data->config->name, O_RDONLY, 0);
+    if (fd != INVALID_FD) {
+        if (fstat(data->fd, &st_own) == 0 && fstat(fd, &st_cur) == 0
+                && st_own.st_dev == st_cur.st_dev && st_own.st_ino == st_cur.st_ino) {
+            shm_unlink(data->config->name);
+        }
+        close(fd);
+    }
+
+    munmap(data->hdr, SHM_RING_HDR_SIZE + data->config->size);
+    close(data->fd);
+}
+
+int
+ipx_plugin_init(ipx_ctx_t *ctx, const char *params)
+{
+    struct shm_data *data = calloc(1, sizeof(*data));
+    if (!data) {
+        IPX_CTX_ERROR(ctx, "Memory allocation failed! (%s:%d)", __FILE__, __LINE__);
+        return IPX_ERR_DENIED;
+    }
+    data->ctx = ctx;
+    data->fd = INVALID_FD;
+
+    // Parse configuration
+    data->config = config_parse(ctx, params);
+    if (!data->config) {
+        free(data);
+        return IPX_ERR_DENIED;
+    }
+
+    data->tmplt_buffer = malloc(UINT16_MAX);
+    if (!data->tmplt_buffer) {
+        IPX_CTX_ERROR(ctx, "Memory allocation failed! (%s:%d)", __FILE__, __LINE__);
+        config_destroy(data->config);
+        free(data);
+        return IPX_ERR_DENIED;
+    }
+
+    if (shm_init(data) != IPX_OK) {
+        free(data->tmplt_buffer);
+        config_destroy(data->config);
+        free(data);
+        return IPX_ERR_DENIED;
+    }
+
+    ipx_ctx_private_set(ctx, data);
+
+    // Subscribe to receive IPFIX messages and Transport Session events
+    uint16_t new_mask = IPX_MSG_IPFIX | IPX_MSG_SESSION;
+    ipx_ctx_subscribe(ctx, &new_mask, NULL);
+    return IPX_OK;
+}
+
+void
+ipx_plugin_destroy(ipx_ctx_t *ctx, void *cfg)
+{
+    struct shm_data *data = (struct shm_data *) cfg;
+
+    if (data->dropped > 0) {
+        IPX_CTX_WARNING(ctx, "%" PRIu64 " IPFIX Message(s) dropped due to lack of space in the "
+            "shared memory.", data->dropped);
+    }
+
+    // Inform the reader about closed sessions
+    data->reader_gen = __atomic_load_n(&data->hdr->reader_gen, __ATOMIC_ACQUIRE);
+    while (data->sessions.cnt > 0) {
+        session_remove(data, &data->sessions.arr[data->sessions.cnt - 1]);
+    }
+
+    shm_destroy(data);
+    free(data->sessions.arr);
+    free(data->tmplt_buffer);
+    config_destroy(data->config);
+    free(data);
+}
+
+int
+ipx_plugin_process(ipx_ctx_t *ctx, void *cfg, ipx_msg_t *msg)
+{
+    (void) ctx;
+    struct shm_data *data = (struct shm_data *) cfg;
+
+    switch (ipx_msg_get_type(msg)) {
+    case IPX_MSG_IPFIX:
+        process_ipfix(data, ipx_msg_base2ipfix(msg));
+        break;
+    case IPX_MSG_SESSION:
+        process_session(data, ipx_msg_base2session(msg));
+        break;
+    default:
+        break;
+    }
+
+    return IPX_OK;
+}
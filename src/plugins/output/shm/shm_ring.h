@@ -0,0 +1,191 @@
+/**
+ * \file src/plugins/output/shm/shm_ring.h
+ * \author agent <agent@local>
+ * \brief Shared memory ring buffer of the shm plugins (header file)
+ * \date 2026
+ */
+
+/* Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is'', and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#ifndef SHM_RING_H
+#define SHM_RING_H
+
+#include <stdalign.h>
+#include <stdint.h>
+
+/**
+ * \file
+ * \brief Layout of the shared memory object shared by the output (writer) and input (reader)
+ *   plugin
+ *
+ * The object consists of a header (#SHM_RING_HDR_SIZE bytes) and a data area. The data area is
+ * a single-producer single-consumer ring buffer of variable size records. Each record starts
+ * with struct shm_rec and is aligned to #SHM_RING_ALIGN bytes. A record is never split at the
+ * end of the data area, i.e. a padding record is added instead and the record starts at the
+ * beginning of the data area. If the remaining space is smaller than the header of a record,
+ * it is skipped without a padding record.
+ *
+ * Positions of the writer (head) and the reader (tail) are monotonically increasing counters of
+ * bytes. The writer publishes records by an update of the head (release) and the reader frees
+ * space by an update of the tail (release). Both sides run on the same host, i.e. all values
+ * are in host byte order.
+ */
+
+/** Identification of the shared memory object ("IPXS")                                          */
+#define SHM_RING_MAGIC    (0x49505853U)
+/** Version of the layout                                                                        */
+#define SHM_RING_VERSION  (1U)
+/** Size of the header (i.e. offset of the data area)                                            */
+#define SHM_RING_HDR_SIZE (4096U)
+/** Alignment of records                                                                         */
+#define SHM_RING_ALIGN    (8U)
+/** Size of a cache line (i.e. separation of variables of the writer and the reader)             */
+#define SHM_RING_LINE     (64U)
+
+/** Header of the shared memory object                                                           */
+struct shm_ring_hdr {
+    /** Identification of the object (written last by the writer, i.e. after initialization)    */
+    uint32_t magic;
+    /** Version of the layout                                                                    */
+    uint32_t version;
+    /** Size of the data area (power of two)                                                     */
+    uint64_t size;
+    /** Process ID of the writer                                                                 */
+    uint32_t writer_pid;
+    /** The writer has been stopped, i.e. no more records will be added                          */
+    uint32_t closed;
+
+    /** Position of the writer (written only by the writer)                                      */
+    alignas(SHM_RING_LINE) uint64_t head;
+
+    /** Position of the reader (written only by the reader)                                      */
+    alignas(SHM_RING_LINE) uint64_t tail;
+    /** Generation of the reader (incremented by each newly attached reader)                    */
+    uint64_t reader_gen;
+    /** Process ID of the attached reader (0, if no reader is attached)                          */
+    uint32_t reader_pid;
+};
+
+/** Types of records                                                                             */
+enum shm_rec_type {
+    /** Padding up to the end of the data area (the next record is at the beginning)            */
+    SHM_REC_PAD = 0,
+    /** New Transport Session (payload: struct shm_session_desc)                                 */
+    SHM_REC_SESSION_OPEN,
+    /** Closed Transport Session (no payload)                                                    */
+    SHM_REC_SESSION_CLOSE,
+    /** IPFIX Message (payload: the message)                                                     */
+    SHM_REC_MESSAGE
+};
+
+/** Header of a record                                                                           */
+struct shm_rec {
+    /** Size of the record including the header and alignment                                    */
+    uint32_t size;
+    /** Size of the payload                                                                      */
+    uint32_t len;
+    /** Type of the record (see #shm_rec_type)                                                   */
+    uint16_t type;
+    /** Stream ID of the message (SHM_REC_MESSAGE only)                                          */
+    uint16_t stream;
+    /** Identification of the Transport Session (unique within the writer)                      */
+    uint32_t session;
+    /** Observation Domain ID of the message (SHM_REC_MESSAGE only)                              */
+    uint32_t odid;
+    /** Reserved (zero)                                                                          */
+    uint32_t reserved;
+};
+
+/**
+ * \brief Description of a Transport Session
+ *
+ * For FILE sessions, the path of the file (NUL terminated) follows the structure.
+ */
+struct shm_session_desc {
+    /** Type of the session (see #fds_session_type)                                              */
+    uint16_t type;
+    /** Version of IP addresses (AF_INET or AF_INET6)                                            */
+    uint16_t l3_proto;
+    /** Source port                                                                              */
+    uint16_t port_src;
+    /** Destination port                                                                         */
+    uint16_t port_dst;
+    /** Source IP address (IPv4 addresses occupy the first 4 bytes)                              */
+    uint8_t addr_src[16];
+    /** Destination IP address (IPv4 addresses occupy the first 4 bytes)                         */
+    uint8_t addr_dst[16];
+    /** Template lifetime (UDP only)                                                             */
+    uint16_t lifetime_tmplts;
+    /** Options Template lifetime (UDP only)                                                     */
+    uint16_t lifetime_opts;
+};
+
+/**
+ * \brief Get the total size of a record with a payload of the given size
+ * \param[in] len Size of the payload
+ */
+static inline uint32_t
+shm_rec_size(uint32_t len)
+{
+    uint32_t size = (uint32_t) sizeof(struct shm_rec) + len;
+    return (size + SHM_RING_ALIGN - 1U) & ~(SHM_RING_ALIGN - 1U);
+}
+
+/**
+ * \brief Get the data area of the shared memory object
+ * \param[in] hdr Header of the object
+ */
+static inline uint8_t *
+shm_ring_data(struct shm_ring_hdr *hdr)
+{
+    return ((uint8_t *) hdr) + SHM_RING_HDR_SIZE;
+}
+
+/**
+ * \brief Get the space up to the end of the data area which must be skipped before a record
+ *
+ * \param[in] pos  Position in the ring (i.e. head or tail)
+ * \param[in] size Size of the data area
+ * \param[in] need Minimal contiguous space (i.e. header of a record or the whole record)
+ * \return Number of bytes to skip (0, if the space is sufficient)
+ */
+static inline uint64_t
+shm_ring_skip(uint64_t pos, uint64_t size, uint64_t need)
+{
+    uint64_t left = size - (pos & (size - 1));
+    return (left < need) ? left : 0;
+}
+
+#endif // SHM_RING_H
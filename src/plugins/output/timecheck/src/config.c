@@ -52,7 +52,8 @@
 /** XML nodes */
 enum params_xml_nodes {
     DEV_PAST = 1,
-    DEV_FUTURE
+    DEV_FUTURE,
+    SUMMARY_INTERVAL
 };
 
 /** Definition of the \<params\> node  */
@@ -60,6 +61,7 @@ static const struct fds_xml_args args_params[] = {
     FDS_OPTS_ROOT("params"),
     FDS_OPTS_ELEM(DEV_PAST,   "devPast",   FDS_OPTS_T_UINT, 0),
     FDS_OPTS_ELEM(DEV_FUTURE, "devFuture", FDS_OPTS_T_UINT, FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM(SUMMARY_INTERVAL, "summaryInterval", FDS_OPTS_T_UINT, FDS_OPTS_P_OPT),
     FDS_OPTS_END
 };
 
@@ -87,6 +89,10 @@ config_parser_root(ipx_ctx_t *ctx, fds_xml_ctx_t *root, struct instance_config *
             assert(content->type == FDS_OPTS_T_UINT);
             cfg->dev_future = content->val_uint;
             break;
+        case SUMMARY_INTERVAL:
+            assert(content->type == FDS_OPTS_T_UINT);
+            cfg->summary_interval = content->val_uint;
+            break;
         default:
             // Internal error
             assert(false);
@@ -105,6 +111,7 @@ config_default_set(struct instance_config *cfg)
 {
     cfg->dev_past = 0;
     cfg->dev_future = 0;
+    cfg->summary_interval = 0;
 }
 
 /**
@@ -122,6 +129,11 @@ config_validate(ipx_ctx_t *ctx, const struct instance_config *cfg)
         return IPX_ERR_FORMAT;
     }
 
+    if (cfg->summary_interval > UINT32_MAX) {
+        IPX_CTX_ERROR(ctx, "Summary interval is too long!", '\0');
+        return IPX_ERR_FORMAT;
+    }
+
     if (cfg->dev_past < 300) {
         IPX_CTX_WARNING(ctx, "The configuration might cause many false warnings!", '\0');
     }
@@ -51,6 +51,8 @@ struct instance_config {
     uint64_t dev_past;
     /** Maximum allowed deviation between the current time and timestamps from the future (sec) */
     uint64_t dev_future;
+    /** Interval of aggregated summary reports (sec, 0 == report each violation)                */
+    uint64_t summary_interval;
 };
 
 /**
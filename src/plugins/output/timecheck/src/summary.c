@@ -0,0 +1,273 @@
+/**
+ * \file src/plugins/output/timecheck/src/summary.c
+ * \author agent <agent@local>
+ * \brief Aggregated statistics of timestamps per exporter (source file)
+ * \date 2026
+ */
+
+/* Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is'', and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "summary.h"
+
+/** Upper bounds of buckets of the histogram (skew of flow end timestamps in seconds) */
+static const int64_t hist_bounds[SUMMARY_BUCKETS - 1U] = {
+    -3600, -60, 0, 60, 300, 600, 3600, 86400
+};
+/** Labels of buckets of the histogram */
+static const char *hist_labels[SUMMARY_BUCKETS] = {
+    "<-1h", "-1h..-1m", "-1m..0s", "0s..1m", "1m..5m", "5m..10m", "10m..1h", "1h..1d", ">1d"
+};
+
+/** Default number of preallocated exporters */
+#define SUMMARY_DEF_SIZE 16U
+
+struct summary {
+    /** Maximum allowed deviation of timestamps from the past (sec) */
+    uint64_t dev_past;
+    /** Statistics of exporters                                     */
+    struct summary_exp *exps;
+    /** Number of valid exporters                                   */
+    size_t exps_cnt;
+    /** Number of preallocated exporters                            */
+    size_t exps_size;
+    /** Index of the last used exporter                             */
+    size_t exps_last;
+};
+
+summary_t *
+summary_create(uint64_t dev_past)
+{
+    summary_t *sum = calloc(1, sizeof(*sum));
+    if (!sum) {
+        return NULL;
+    }
+
+    sum->exps = calloc(SUMMARY_DEF_SIZE, sizeof(*sum->exps));
+    if (!sum->exps) {
+        free(sum);
+        return NULL;
+    }
+
+    sum->exps_size = SUMMARY_DEF_SIZE;
+    sum->dev_past = dev_past;
+    return sum;
+}
+
+void
+summary_destroy(summary_t *sum)
+{
+    free(sum->exps);
+    free(sum);
+}
+
+struct summary_exp *
+summary_get(summary_t *sum, const struct ipx_session *session, uint32_t odid)
+{
+    // Usually, Data Records of the same exporter are received in bursts
+    if (sum->exps_last < sum->exps_cnt) {
+        struct summary_exp *exp = &sum->exps[sum->exps_last];
+        if (exp->session == session && exp->odid == odid) {
+            return exp;
+        }
+    }
+
+    for (size_t i = 0; i < sum->exps_cnt; ++i) {
+        struct summary_exp *exp = &sum->exps[i];
+        if (exp->session == session && exp->odid == odid) {
+            sum->exps_last = i;
+            return exp;
+        }
+    }
+
+    // Not found -> create new statistics
+    if (sum->exps_cnt == sum->exps_size) {
+        const size_t new_size = 2U * sum->exps_size;
+        struct summary_exp *new_exps = realloc(sum->exps, new_size * sizeof(*new_exps));
+        if (!new_exps) {
+            return NULL;
+        }
+
+        sum->exps = new_exps;
+        sum->exps_size = new_size;
+    }
+
+    struct summary_exp *exp = &sum->exps[sum->exps_cnt];
+    memset(exp, 0, sizeof(*exp));
+    exp->session = session;
+    exp->odid = odid;
+    sum->exps_last = sum->exps_cnt++;
+    return exp;
+}
+
+/**
+ * \brief Get the index of a bucket of the histogram
+ * \param[in] skew Skew of a flow end timestamp (sec)
+ * \return Index
+ */
+static inline size_t
+summary_bucket(int64_t skew)
+{
+    size_t idx = 0;
+    while (idx < SUMMARY_BUCKETS - 1U && skew >= hist_bounds[idx]) {
+        idx++;
+    }
+
+    return idx;
+}
+
+void
+summary_add(const summary_t *sum, struct summary_exp *exp, uint64_t now,
+    const struct summary_rec *rec)
+{
+    exp->recs++;
+    if (!rec->has_start && !rec->has_end) {
+        return;
+    }
+
+    exp->recs_ts++;
+    exp->viol_past += rec->viol_past;
+    exp->viol_future += rec->viol_future;
+    if (rec->dev_past > exp->dev_past) {
+        exp->dev_past = rec->dev_past;
+    }
+    if (rec->dev_future > exp->dev_future) {
+        exp->dev_future = rec->dev_future;
+    }
+
+    if (rec->has_end) {
+        // Positive skew == the flow ended in the past
+        const int64_t skew = (int64_t) now - (int64_t) (rec->ts_end / 1000U);
+        exp->hist[summary_bucket(skew)]++;
+    }
+
+    if (!rec->has_start || !rec->has_end) {
+        return;
+    }
+
+    if (rec->ts_end < rec->ts_start) {
+        exp->dur_negative++;
+        return;
+    }
+
+    const uint64_t duration = rec->ts_end - rec->ts_start;
+    if (duration / 1000U > sum->dev_past) {
+        exp->dur_long++;
+    }
+    if (duration > exp->dur_max) {
+        exp->dur_max = duration;
+    }
+}
+
+/**
+ * \brief Print statistics of an exporter
+ * \param[in] exp Statistics of the exporter
+ */
+static void
+summary_print_exp(const struct summary_exp *exp)
+{
+    printf("%s [ODID: %"PRIu32"]: records: %"PRIu64" (with timestamps: %"PRIu64"), "
+        "violations: %"PRIu64" past (max. %"PRIu64" s), %"PRIu64" future (max. %"PRIu64" s)\n",
+        exp->session->ident, exp->odid, exp->recs, exp->recs_ts,
+        exp->viol_past, exp->dev_past, exp->viol_future, exp->dev_future);
+
+    printf("\tflow end skew:");
+    for (size_t i = 0; i < SUMMARY_BUCKETS; ++i) {
+        printf(" %s: %"PRIu64"%s", hist_labels[i], exp->hist[i],
+            (i + 1U < SUMMARY_BUCKETS) ? "," : "\n");
+    }
+
+    printf("\tflow duration: %"PRIu64" negative, %"PRIu64" over devPast, max. %"PRIu64" ms\n",
+        exp->dur_negative, exp->dur_long, exp->dur_max);
+}
+
+void
+summary_print(summary_t *sum, uint64_t interval)
+{
+    bool header = false;
+
+    for (size_t i = 0; i < sum->exps_cnt; ++i) {
+        struct summary_exp *exp = &sum->exps[i];
+        if (exp->recs == 0) {
+            continue;
+        }
+
+        if (!header) {
+            printf("Time check summary of the last %"PRIu64" seconds:\n", interval);
+            header = true;
+        }
+
+        summary_print_exp(exp);
+
+        // Clear the statistics (but keep the exporter)
+        const struct ipx_session *session = exp->session;
+        const uint32_t odid = exp->odid;
+        memset(exp, 0, sizeof(*exp));
+        exp->session = session;
+        exp->odid = odid;
+    }
+
+    if (header) {
+        fflush(stdout);
+    }
+}
+
+void
+summary_session_close(summary_t *sum, const struct ipx_session *session)
+{
+    size_t idx = 0;
+    while (idx < sum->exps_cnt) {
+        struct summary_exp *exp = &sum->exps[idx];
+        if (exp->session != session) {
+            idx++;
+            continue;
+        }
+
+        if (exp->recs > 0) {
+            printf("Time check summary of the closed session:\n");
+            summary_print_exp(exp);
+            fflush(stdout);
+        }
+
+        // Replace the exporter with the last one
+        sum->exps[idx] = sum->exps[--sum->exps_cnt];
+    }
+
+    sum->exps_last = 0;
+}
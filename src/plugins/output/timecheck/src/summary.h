@@ -0,0 +1,159 @@
+/**
+ * \file src/plugins/output/timecheck/src/summary.h
+ * \author agent <agent@local>
+ * \brief Aggregated statistics of timestamps per exporter (header file)
+ * \date 2026
+ */
+
+/* Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is'', and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#ifndef TIMECHECK_SUMMARY_H
+#define TIMECHECK_SUMMARY_H
+
+#include <ipfixcol2.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+/** Number of buckets of the histogram of flow end timestamp skew */
+#define SUMMARY_BUCKETS 9U
+
+/** Timestamp information of a Data Record */
+struct summary_rec {
+    /** Number of timestamps from the distant past            */
+    uint32_t viol_past;
+    /** Number of timestamps from the future                  */
+    uint32_t viol_future;
+    /** Maximal deviation of timestamps from the past (sec)   */
+    uint64_t dev_past;
+    /** Maximal deviation of timestamps from the future (sec) */
+    uint64_t dev_future;
+
+    /** Flow start timestamp is available                     */
+    bool has_start;
+    /** Flow end timestamp is available                       */
+    bool has_end;
+    /** Flow start timestamp (milliseconds since the Epoch)   */
+    uint64_t ts_start;
+    /** Flow end timestamp (milliseconds since the Epoch)     */
+    uint64_t ts_end;
+};
+
+/** Statistics of a single exporter (i.e. Transport Session and ODID) */
+struct summary_exp {
+    /** Transport Session                                                   */
+    const struct ipx_session *session;
+    /** Observation Domain ID                                               */
+    uint32_t odid;
+
+    /** Number of Data Records                                              */
+    uint64_t recs;
+    /** Number of Data Records with at least one timestamp                  */
+    uint64_t recs_ts;
+    /** Number of timestamps from the distant past                          */
+    uint64_t viol_past;
+    /** Number of timestamps from the future                                */
+    uint64_t viol_future;
+    /** Maximal deviation of timestamps from the past (sec)                 */
+    uint64_t dev_past;
+    /** Maximal deviation of timestamps from the future (sec)               */
+    uint64_t dev_future;
+    /** Histogram of the skew of flow end timestamps (see summary_print())  */
+    uint64_t hist[SUMMARY_BUCKETS];
+    /** Number of flows with the end timestamp before the start timestamp  */
+    uint64_t dur_negative;
+    /** Number of flows longer than the maximum allowed deviation (devPast) */
+    uint64_t dur_long;
+    /** Maximal flow duration (milliseconds)                                */
+    uint64_t dur_max;
+};
+
+/** Internal summary structure */
+typedef struct summary summary_t;
+
+/**
+ * \brief Create a summary
+ * \param[in] dev_past Maximum allowed deviation of timestamps from the past (sec)
+ * \return Pointer to the summary or NULL (memory allocation error)
+ */
+summary_t *
+summary_create(uint64_t dev_past);
+
+/**
+ * \brief Destroy a summary
+ * \param[in] sum Summary
+ */
+void
+summary_destroy(summary_t *sum);
+
+/**
+ * \brief Get statistics of an exporter
+ *
+ * If the statistics don't exist, they are created.
+ * \param[in] sum     Summary
+ * \param[in] session Transport Session
+ * \param[in] odid    Observation Domain ID
+ * \return Pointer to the statistics or NULL (memory allocation error)
+ */
+struct summary_exp *
+summary_get(summary_t *sum, const struct ipx_session *session, uint32_t odid);
+
+/**
+ * \brief Add timestamp information of a Data Record to statistics of an exporter
+ * \param[in] sum Summary
+ * \param[in] exp Statistics of the exporter
+ * \param[in] now Current time (seconds since the Epoch)
+ * \param[in] rec Timestamp information of the Data Record
+ */
+void
+summary_add(const summary_t *sum, struct summary_exp *exp, uint64_t now,
+    const struct summary_rec *rec);
+
+/**
+ * \brief Print statistics of all exporters with at least one Data Record and clear them
+ * \param[in] sum      Summary
+ * \param[in] interval Length of the reported interval (sec)
+ */
+void
+summary_print(summary_t *sum, uint64_t interval);
+
+/**
+ * \brief Print and remove statistics of all exporters of a closed Transport Session
+ * \param[in] sum     Summary
+ * \param[in] session Transport Session
+ */
+void
+summary_session_close(summary_t *sum, const struct ipx_session *session);
+
+#endif // TIMECHECK_SUMMARY_H
@@ -43,15 +43,24 @@
 #include <stdlib.h>
 #include <unistd.h>
 #include <inttypes.h>
+#include <stdio.h>
+#include <string.h>
 #include <time.h>
 
 #include "config.h"
+#include "summary.h"
 #include "../../../../core/message_ipfix.h"
 
 /** Private Enterprise Number of standard IEs from IANA         */
 #define PEN_IANA 0
 /** Private Enterprise Number of Standard reverse IEs from IANA */
 #define PEN_IANA_REV 29305
+/** The first timestamp IE (flowStartSeconds)                   */
+#define TS_ID_FIRST 150U
+/** Number of timestamp IEs (flowStartSeconds ... flowEndNanoseconds) per PEN */
+#define TS_ID_CNT 8U
+/** Number of checked timestamp IEs (forward and reverse)      */
+#define TS_COLS (2U * TS_ID_CNT)
 
 /** Plugin description */
 IPX_API struct ipx_plugin_info ipx_plugin_info = {
@@ -75,15 +84,36 @@ struct instance_data {
     struct instance_config *config;
     /** Current time (seconds since the Epoch) */
     uint64_t ts_now;
+    /** Aggregated statistics (NULL == report each violation) */
+    summary_t *summary;
+    /** Start of the current summary interval (seconds since the Epoch, 0 == not started) */
+    uint64_t ts_interval;
 
     /** Context reference (only for log!)      */
     ipx_ctx_t *ctx;
 };
 
-// Function prototype
+/** Timestamps of a run of Data Records with the same Template (see ts_fields_get()) */
+struct ts_columns {
+    /** Views of timestamp IEs (forward IEs first, ordered by ID) */
+    struct ipx_ipfix_column cols[TS_COLS];
+    /** Return codes of ipx_msg_ipfix_column_view() of each view   */
+    int rcs[TS_COLS];
+    /** Index of the first record of the run                      */
+    uint32_t start;
+    /** Number of records in the run (0 = not initialized)        */
+    uint32_t cnt;
+};
+
+// Function prototypes
+static unsigned int
+ts_fields_get(struct ts_columns *ts, ipx_msg_ipfix_t *msg, uint32_t idx,
+    struct fds_drec_field *fields);
 static void
 timestamp_check(const struct instance_data *inst, ipx_msg_ipfix_t *msg,
     const struct fds_drec_field *field);
+static void
+timestamp_aggregate(struct instance_data *inst, ipx_msg_ipfix_t *msg);
 
 int
 ipx_plugin_init(ipx_ctx_t *ctx, const char *params)
@@ -99,6 +129,20 @@ ipx_plugin_init(ipx_ctx_t *ctx, const char *params)
         return IPX_ERR_DENIED;
     }
 
+    if (data->config->summary_interval > 0) {
+        // Aggregated mode
+        if ((data->summary = summary_create(data->config->dev_past)) == NULL) {
+            IPX_CTX_ERROR(ctx, "Memory allocation error (%s:%d)", __FILE__, __LINE__);
+            config_destroy(data->config);
+            free(data);
+            return IPX_ERR_DENIED;
+        }
+
+        // Statistics of closed Transport Sessions must be removed
+        ipx_msg_mask_t mask = IPX_MSG_IPFIX | IPX_MSG_SESSION;
+        ipx_ctx_subscribe(ctx, &mask, NULL);
+    }
+
     data->ctx = ctx;
     ipx_ctx_private_set(ctx, data);
     return IPX_OK;
@@ -110,6 +154,14 @@ ipx_plugin_destroy(ipx_ctx_t *ctx, void *cfg)
     (void) ctx; // Suppress warnings
 
     struct instance_data *data = (struct instance_data *) cfg;
+    if (data->summary != NULL) {
+        // Report the remaining statistics
+        const uint64_t ts_now = (uint64_t) time(NULL);
+        if (data->ts_interval != 0 && ts_now >= data->ts_interval) {
+            summary_print(data->summary, ts_now - data->ts_interval);
+        }
+        summary_destroy(data->summary);
+    }
     config_destroy(data->config);
     free(data);
 }
@@ -119,36 +171,35 @@ ipx_plugin_process(ipx_ctx_t *ctx, void *cfg, ipx_msg_t *msg)
 {
     (void) ctx; // Suppress warnings
     struct instance_data *data = (struct instance_data *) cfg;
+    if (ipx_msg_get_type(msg) == IPX_MSG_SESSION) {
+        ipx_msg_session_t *session_msg = ipx_msg_base2session(msg);
+        if (ipx_msg_session_get_event(session_msg) == IPX_MSG_SESSION_CLOSE) {
+            summary_session_close(data->summary, ipx_msg_session_get_session(session_msg));
+        }
+        return IPX_OK;
+    }
+
     ipx_msg_ipfix_t *ipfix_msg = ipx_msg_base2ipfix(msg);
 
     // Update the current UTC time
     data->ts_now = (uint64_t) time(NULL);
 
+    if (data->summary != NULL) {
+        timestamp_aggregate(data, ipfix_msg);
+        return IPX_OK;
+    }
+
     // For each Data Record in the message
+    struct ts_columns ts;
+    memset(&ts, 0, sizeof(ts));
     uint32_t rec_cnt = ipx_msg_ipfix_get_drec_cnt(ipfix_msg);
     for (uint32_t i = 0; i < rec_cnt; ++i) {
-        // For each field in the Data Record
-        struct ipx_ipfix_record *rec = ipx_msg_ipfix_get_drec(ipfix_msg, i);
-        struct fds_drec_iter it;
-
-        fds_drec_iter_init(&it, &rec->rec, 0);
-        while (fds_drec_iter_next(&it) != FDS_EOC) {
-            // Is it a timestamp?
-            const uint16_t field_id = it.field.info->id;
-            const uint32_t field_en = it.field.info->en;
-
-            if (field_en != PEN_IANA && field_en != PEN_IANA_REV) {
-                // We don't check non-standard fields
-                continue;
-            }
-
-            if (field_id < 150U || field_id > 157U) {
-                // We want to check only IE elements within the range 150 - 157
-                continue;
-            }
-
+        // For each timestamp in the Data Record
+        struct fds_drec_field fields[TS_COLS];
+        const unsigned int fields_cnt = ts_fields_get(&ts, ipfix_msg, i, fields);
+        for (unsigned int f = 0; f < fields_cnt; ++f) {
             // Check if the value doesn't violate rules
-            timestamp_check(data, ipfix_msg, &it.field);
+            timestamp_check(data, ipfix_msg, &fields[f]);
         }
     }
 
@@ -156,16 +207,73 @@ ipx_plugin_process(ipx_ctx_t *ctx, void *cfg, ipx_msg_t *msg)
 }
 
 /**
- * \brief Timestamp check function
+ * \brief Get timestamps of a Data Record
+ *
+ * Only IANA fields flowStart... and flowEnd... (forward and reverse) are returned. Views of
+ * the fields are shared by the whole run of records with the same Template (see
+ * ipx_msg_ipfix_column_view()), i.e. the Template is searched only once per run. Fields
+ * without a fixed offset (i.e. after a variable-length field) are found by fds_drec_find().
+ * \note Records must be processed in ascending order.
+ * \param[in,out] ts     Views of the current run of records (zeroed before the first record
+ *   of a message)
+ * \param[in]     msg    IPFIX Message
+ * \param[in]     idx    Index of the Data Record
+ * \param[out]    fields Timestamps of the record (at least #TS_COLS items)
+ * \return Number of timestamps
+ */
+static unsigned int
+ts_fields_get(struct ts_columns *ts, ipx_msg_ipfix_t *msg, uint32_t idx,
+    struct fds_drec_field *fields)
+{
+    if (ts->cnt == 0 || idx - ts->start >= ts->cnt) {
+        // The first record of a new run
+        for (unsigned int c = 0; c < TS_COLS; ++c) {
+            const uint32_t pen = (c < TS_ID_CNT) ? PEN_IANA : PEN_IANA_REV;
+            const uint16_t id = (uint16_t) (TS_ID_FIRST + (c % TS_ID_CNT));
+            ts->rcs[c] = ipx_msg_ipfix_column_view(msg, idx, pen, id, &ts->cols[c]);
+        }
+        ts->start = idx;
+        ts->cnt = ts->cols[0].cnt;
+    }
+
+    const uint32_t pos = idx - ts->start;
+    unsigned int cnt = 0;
+    for (unsigned int c = 0; c < TS_COLS; ++c) {
+        const struct ipx_ipfix_column *col = &ts->cols[c];
+        if (ts->rcs[c] == IPX_OK) {
+            // Fixed offset
+            fields[cnt].data = (uint8_t *) col->data + pos * col->stride;
+            fields[cnt].size = col->size;
+            fields[cnt].info = col->field;
+            cnt++;
+            continue;
+        }
+
+        if (col->field == NULL) {
+            // Not present in the Template
+            continue;
+        }
+
+        struct ipx_ipfix_record *rec = ipx_msg_ipfix_get_drec(msg, idx);
+        if (fds_drec_find(&rec->rec, col->field->en, col->field->id, &fields[cnt]) != FDS_EOC) {
+            cnt++;
+        }
+    }
+
+    return cnt;
+}
+
+/**
+ * \brief Get the value of a timestamp
  *
  * Only IANA fields flowStart... and flowEnd... are supported!
- * \param[in] inst  Plugin instance parameters
- * \param[in] msg   IPFIX Message from which the timestamp comes from
- * \param[in] field The timestamp to check
+ * \param[in]  field The timestamp
+ * \param[out] value Value (milliseconds since the Epoch)
+ * \return #FDS_OK on success
+ * \return #FDS_ERR_ARG if the value cannot be converted
  */
-void
-timestamp_check(const struct instance_data *inst, ipx_msg_ipfix_t *msg,
-    const struct fds_drec_field *field)
+static int
+timestamp_get(const struct fds_drec_field *field, uint64_t *value)
 {
     assert((field->info->en == PEN_IANA || field->info->en == PEN_IANA_REV) && "Non-IANA PEN!");
     enum fds_iemgr_element_type elem_type;
@@ -189,12 +297,27 @@ timestamp_check(const struct instance_data *inst, ipx_msg_ipfix_t *msg,
         break;
     default:
         assert(false && "Unhandled switch option!");
-        return;
+        return FDS_ERR_ARG;
     }
 
+    return fds_get_datetime_lp_be(field->data, field->size, elem_type, value);
+}
+
+/**
+ * \brief Timestamp check function
+ *
+ * Only IANA fields flowStart... and flowEnd... are supported!
+ * \param[in] inst  Plugin instance parameters
+ * \param[in] msg   IPFIX Message from which the timestamp comes from
+ * \param[in] field The timestamp to check
+ */
+void
+timestamp_check(const struct instance_data *inst, ipx_msg_ipfix_t *msg,
+    const struct fds_drec_field *field)
+{
     // Get the value
     uint64_t ts_value;
-    int ret_code = fds_get_datetime_lp_be(field->data, field->size, elem_type, &ts_value);
+    int ret_code = timestamp_get(field, &ts_value);
     if (ret_code != FDS_OK) {
         IPX_CTX_WARNING(inst->ctx, "Timestamp conversion failed! Skipping...", '\0');
         return;
@@ -239,4 +362,83 @@ timestamp_check(const struct instance_data *inst, ipx_msg_ipfix_t *msg,
         s_name, s_odid, field->info->en, field->info->id,
         ts_diff, diff_hrs, diff_mins, diff_secs, violation_type,
         inst->ts_now, ts_value);
-}
\ No newline at end of file
+}
+/**
+ * \brief Add timestamps of all Data Records of an IPFIX Message to aggregated statistics
+ *
+ * Violations are not reported immediately. Instead, statistics of all exporters are printed
+ * periodically.
+ * \param[in] inst Plugin instance parameters
+ * \param[in] msg  IPFIX Message
+ */
+void
+timestamp_aggregate(struct instance_data *inst, ipx_msg_ipfix_t *msg)
+{
+    if (inst->ts_interval == 0 || inst->ts_now < inst->ts_interval) {
+        // The first message (or the system time has been changed)
+        inst->ts_interval = inst->ts_now;
+    } else if (inst->ts_now - inst->ts_interval >= inst->config->summary_interval) {
+        summary_print(inst->summary, inst->ts_now - inst->ts_interval);
+        inst->ts_interval = inst->ts_now;
+    }
+
+    const struct ipx_msg_ctx *msg_ctx = ipx_msg_ipfix_get_ctx(msg);
+    struct summary_exp *exp = summary_get(inst->summary, msg_ctx->session, msg_ctx->odid);
+    if (!exp) {
+        IPX_CTX_ERROR(inst->ctx, "Memory allocation error (%s:%d)", __FILE__, __LINE__);
+        return;
+    }
+
+    // For each Data Record in the message
+    struct ts_columns ts;
+    memset(&ts, 0, sizeof(ts));
+    uint32_t rec_cnt = ipx_msg_ipfix_get_drec_cnt(msg);
+    for (uint32_t i = 0; i < rec_cnt; ++i) {
+        struct fds_drec_field fields[TS_COLS];
+        const unsigned int fields_cnt = ts_fields_get(&ts, msg, i, fields);
+        struct summary_rec info;
+
+        memset(&info, 0, sizeof(info));
+        for (unsigned int f = 0; f < fields_cnt; ++f) {
+            const uint16_t field_id = fields[f].info->id;
+            const uint32_t field_en = fields[f].info->en;
+
+            uint64_t ts_value;
+            if (timestamp_get(&fields[f], &ts_value) != FDS_OK) {
+                continue;
+            }
+
+            // Check the deviation
+            const uint64_t ts_secs = ts_value / 1000U;
+            if (ts_secs <= inst->ts_now) {
+                const uint64_t ts_diff = inst->ts_now - ts_secs;
+                if (ts_diff > inst->config->dev_past) {
+                    info.viol_past++;
+                    info.dev_past = (ts_diff > info.dev_past) ? ts_diff : info.dev_past;
+                }
+            } else {
+                const uint64_t ts_diff = ts_secs - inst->ts_now;
+                if (ts_diff > inst->config->dev_future) {
+                    info.viol_future++;
+                    info.dev_future = (ts_diff > info.dev_future) ? ts_diff : info.dev_future;
+                }
+            }
+
+            if (field_en != PEN_IANA) {
+                // Duration and skew are based on forward timestamps only
+                continue;
+            }
+
+            // Even IDs are flowStart..., odd IDs are flowEnd...
+            if ((field_id % 2U) == 0 && !info.has_start) {
+                info.has_start = true;
+                info.ts_start = ts_value;
+            } else if ((field_id % 2U) != 0 && !info.has_end) {
+                info.has_end = true;
+                info.ts_end = ts_value;
+            }
+        }
+
+        summary_add(inst->summary, exp, inst->ts_now, &info);
+    }
+}
@@ -41,12 +41,48 @@
 
 #include <inttypes.h>
 #include <stdio.h>
+#include <time.h>
 #include <libfds.h>
 #include "Reader.h"
 #include <ipfixcol2.h>
 
+/**
+ * \brief Select Data Records of an IPFIX Message to print
+ * \param[in] sel     Selection of Data Records
+ * \param[in] rec_cnt Number of Data Records in the message
+ * \return True if at least one record is selected, false otherwise
+ */
+static bool
+read_select(struct reader_select *sel, uint32_t rec_cnt)
+{
+    struct timespec now = {0, 0};
+    if (sel->rate_limit > 0) {
+        // All records of the message are received at the same time
+        clock_gettime(CLOCK_MONOTONIC_COARSE, &now);
+        if (now.tv_sec != sel->rate_sec) {
+            sel->rate_sec = now.tv_sec;
+            sel->rate_cnt = 0;
+        }
+    }
+
+    bool any = false;
+    for (uint32_t i = 0; i < rec_cnt && i < READER_RECS_MAX; ++i) {
+        bool print = (sel->sampling <= 1 || (sel->rec_seen++ % sel->sampling) == 0);
+        if (print && sel->rate_limit > 0) {
+            print = (sel->rate_cnt < sel->rate_limit);
+            sel->rate_cnt += print ? 1 : 0;
+        }
+
+        sel->rec_print[i] = print;
+        any |= print;
+    }
+
+    return any;
+}
+
 void
-read_packet(ipx_msg_ipfix_t *msg, const fds_iemgr_t *iemgr)
+read_packet(writer_t *out, ipx_msg_ipfix_t *msg, const fds_iemgr_t *iemgr,
+    struct reader_select *sel)
 {
     const struct fds_ipfix_msg_hdr *ipfix_msg_hdr;
     ipfix_msg_hdr = (const struct fds_ipfix_msg_hdr*)ipx_msg_ipfix_get_packet(msg);
@@ -55,38 +91,84 @@ read_packet(ipx_msg_ipfix_t *msg, const fds_iemgr_t *iemgr)
         return;
     }
 
-    // Print packet header
-    printf("--------------------------------------------------------------------------------\n");
-    printf("IPFIX Message header:\n");
-    printf("\tVersion:      %"PRIu16"\n",ntohs(ipfix_msg_hdr->version));
-    printf("\tLength:       %"PRIu16"\n",ntohs(ipfix_msg_hdr->length));
-    printf("\tExport time:  %"PRIu32"\n",ntohl(ipfix_msg_hdr->export_time));
-    printf("\tSequence no.: %"PRIu32"\n",ntohl(ipfix_msg_hdr->seq_num));
-    printf("\tODID:         %"PRIu32"\n", ntohl(ipfix_msg_hdr->odid));
-
     // Get number of sets
     struct ipx_ipfix_set *sets;
     size_t set_cnt;
     ipx_msg_ipfix_get_sets(msg, &sets, &set_cnt);
 
+    const bool *rec_print = NULL;
+    if (sel->sampling > 1 || sel->rate_limit > 0) {
+        // Skip the message if there is nothing to print (i.e. no selected records or templates)
+        bool print = read_select(sel, ipx_msg_ipfix_get_drec_cnt(msg));
+        for (size_t i = 0; i < set_cnt && !print; ++i) {
+            print = ntohs(sets[i].ptr->flowset_id) < FDS_IPFIX_SET_MIN_DSET;
+        }
+
+        if (!print) {
+            return;
+        }
+        rec_print = sel->rec_print;
+    }
+
+    writer_msg_begin(out);
+
+    // Print packet header
+    writer_printf(out, "--------------------------------------------------------------------------------\n");
+    writer_printf(out, "IPFIX Message header:\n");
+    writer_printf(out, "\tVersion:      %"PRIu16"\n",ntohs(ipfix_msg_hdr->version));
+    writer_printf(out, "\tLength:       %"PRIu16"\n",ntohs(ipfix_msg_hdr->length));
+    writer_printf(out, "\tExport time:  %"PRIu32"\n",ntohl(ipfix_msg_hdr->export_time));
+    writer_printf(out, "\tSequence no.: %"PRIu32"\n",ntohl(ipfix_msg_hdr->seq_num));
+    writer_printf(out, "\tODID:         %"PRIu32"\n", ntohl(ipfix_msg_hdr->odid));
+
     // Record counter of total records in IPFIX message
     uint32_t rec_i = 0;
 
     // Iteration through all the sets
     for (uint32_t i = 0; i < set_cnt; ++i){
-        read_set(&sets[i], msg, iemgr, &rec_i);
+        read_set(out, &sets[i], msg, iemgr, &rec_i, rec_print);
     }
 
-    fflush(stdout);
+    // The text is written to the output in the background
+    writer_msg_end(out);
+}
+
+/**
+ * \brief Check if a Data Record is selected to print
+ * \param[in] rec_print Selected records (NULL == all)
+ * \param[in] rec_i     Index of the record in the IPFIX Message
+ * \return True or false
+ */
+static inline bool
+read_is_selected(const bool *rec_print, uint32_t rec_i)
+{
+    return rec_print == NULL || (rec_i < READER_RECS_MAX && rec_print[rec_i]);
 }
 
 void
-read_set(struct ipx_ipfix_set *set, ipx_msg_ipfix_t *msg, const fds_iemgr_t *iemgr, uint32_t *rec_i)
+read_set(writer_t *out, struct ipx_ipfix_set *set, ipx_msg_ipfix_t *msg, const fds_iemgr_t *iemgr,
+    uint32_t *rec_i, const bool *rec_print)
 {
     uint8_t *set_end = (uint8_t *)set->ptr + ntohs(set->ptr->length);
     uint16_t set_id = ntohs(set->ptr->flowset_id);
 
     const uint32_t rec_cnt = ipx_msg_ipfix_get_drec_cnt(msg);
+    if (rec_print != NULL && set_id >= FDS_IPFIX_SET_MIN_DSET) {
+        // Skip the Data Set if none of its records is selected
+        bool print = false;
+        uint32_t idx = *rec_i;
+        struct ipx_ipfix_record *ipfix_rec;
+        while (idx < rec_cnt && (ipfix_rec = ipx_msg_ipfix_get_drec(msg, idx)) != NULL
+                && ipfix_rec->rec.data < set_end) {
+            print |= read_is_selected(rec_print, idx++);
+        }
+
+        if (!print) {
+            *rec_i = idx;
+            return;
+        }
+    }
+
     const char *set_type = "<unknown>";
     if (set_id == FDS_IPFIX_SET_TMPLT) {
         set_type = "Template Set";
@@ -96,10 +178,10 @@ read_set(struct ipx_ipfix_set *set, ipx_msg_ipfix_t *msg, const fds_iemgr_t *iem
         set_type = "Data Set";
     }
 
-    printf("\n");
-    printf("Set Header:\n");
-    printf("\tSet ID: %"PRIu16" (%s)\n", set_id, set_type);
-    printf("\tLength: %"PRIu16"\n", ntohs(set->ptr->length));
+    writer_printf(out, "\n");
+    writer_printf(out, "Set Header:\n");
+    writer_printf(out, "\tSet ID: %"PRIu16" (%s)\n", set_id, set_type);
+    writer_printf(out, "\tLength: %"PRIu16"\n", ntohs(set->ptr->length));
 
     if (set_id == FDS_IPFIX_SET_TMPLT || set_id == FDS_IPFIX_SET_OPTS_TMPLT) {
         // Template set
@@ -113,9 +195,9 @@ read_set(struct ipx_ipfix_set *set, ipx_msg_ipfix_t *msg, const fds_iemgr_t *iem
         // Iteration through all templates in the set
         while (fds_tset_iter_next(&tset_iter) == FDS_OK){
             // Read and print single template
-            printf(rec_fmt, ++rec_cnt);
-            read_template_set(&tset_iter, set_id,iemgr);
-            putchar('\n');
+            writer_printf(out, rec_fmt, ++rec_cnt);
+            read_template_set(out, &tset_iter, set_id,iemgr);
+            writer_putc(out, '\n');
         }
         return;
     }
@@ -126,16 +208,25 @@ read_set(struct ipx_ipfix_set *set, ipx_msg_ipfix_t *msg, const fds_iemgr_t *iem
         if (ipfix_rec == NULL) return;
 
         // All the records in the set has same template id, so we extract it from the first record and print it
-        printf("\tTemplate ID: %"PRIu16"\n", ipfix_rec->rec.tmplt->id);
+        writer_printf(out, "\tTemplate ID: %"PRIu16"\n", ipfix_rec->rec.tmplt->id);
         unsigned int iter_cnt = 0;
 
         // Iteration through the records which belongs to the current set
         while ((ipfix_rec != NULL) && (ipfix_rec->rec.data < set_end) && (*rec_i < rec_cnt)) {
+            ++iter_cnt;
+            if (!read_is_selected(rec_print, *rec_i)) {
+                // Skip the record
+                (*rec_i)++;
+                ipfix_rec = ipx_msg_ipfix_get_drec(msg, *rec_i);
+                continue;
+            }
+
             // Print record header
-            printf("- Data Record (#%u) [Length: %"PRIu16"]:\n", ++iter_cnt, ipfix_rec->rec.size);
+            writer_printf(out, "- Data Record (#%u) [Length: %"PRIu16"]:\n", iter_cnt,
+                ipfix_rec->rec.size);
             // Get the specific record and read all the fields
-            read_record(&ipfix_rec->rec, 1, iemgr);
-            putchar('\n');
+            read_record(out, &ipfix_rec->rec, 1, iemgr);
+            writer_putc(out, '\n');
 
             // Get the next record
             (*rec_i)++;
@@ -145,11 +236,12 @@ read_set(struct ipx_ipfix_set *set, ipx_msg_ipfix_t *msg, const fds_iemgr_t *iem
     }
 
     //Unknown set ID
-    printf("\t<Unknown set ID>\n");
+    writer_printf(out, "\t<Unknown set ID>\n");
 }
 
 void
-read_template_set(struct fds_tset_iter *tset_iter, uint16_t set_id, const fds_iemgr_t *iemgr)
+read_template_set(writer_t *out, struct fds_tset_iter *tset_iter, uint16_t set_id,
+    const fds_iemgr_t *iemgr)
 {
     enum fds_template_type type;
     void *ptr;
@@ -163,27 +255,27 @@ read_template_set(struct fds_tset_iter *tset_iter, uint16_t set_id, const fds_ie
             ptr = tset_iter->ptr.opts_trec;
             break;
         default:
-            printf("\t<Undefined template>\n");
+            writer_printf(out, "\t<Undefined template>\n");
             return;
     }
     // Filling the template structure with data from raw packet
     uint16_t tmplt_size = tset_iter->size;
     struct fds_template *tmplt;
     if (fds_template_parse(type, ptr, &tmplt_size, &tmplt) != FDS_OK){
-        printf("*Template parsing error*\n");
+        writer_printf(out, "*Template parsing error*\n");
         return;
     }
 
     // Printing out the header
-    printf("\tTemplate ID: %"PRIu16"\n", tmplt->id);
-    printf("\tField Count: %"PRIu16"\n", tmplt->fields_cnt_total);
+    writer_printf(out, "\tTemplate ID: %"PRIu16"\n", tmplt->id);
+    writer_printf(out, "\tField Count: %"PRIu16"\n", tmplt->fields_cnt_total);
     if (type == FDS_TYPE_TEMPLATE_OPTS) {
-        printf("\tScope Field Count: %"PRIu16"\n", tmplt->fields_cnt_scope);
+        writer_printf(out, "\tScope Field Count: %"PRIu16"\n", tmplt->fields_cnt_scope);
     }
 
     // Using IEManager to fill the definitions of the fields in the template
     if(fds_template_ies_define(tmplt, iemgr , false) != FDS_OK){
-        printf("*Error while assigning element definitions in template*\n");
+        writer_printf(out, "*Error while assigning element definitions in template*\n");
         fds_template_destroy(tmplt);
         return;
     }
@@ -191,14 +283,14 @@ read_template_set(struct fds_tset_iter *tset_iter, uint16_t set_id, const fds_ie
     // Iteration through the fields and printing them out
     for (uint16_t i = 0; i < tmplt->fields_cnt_total ; ++i) {
         struct fds_tfield current = tmplt->fields[i];
-        printf("\t");
-        printf("EN: %-*"PRIu32" ", WRITER_EN_SPACE, current.en);
-        printf("ID: %-*"PRIu16" ", WRITER_ID_SPACE, current.id);
-        printf("Size: ");
+        writer_printf(out, "\t");
+        writer_printf(out, "EN: %-*"PRIu32" ", WRITER_EN_SPACE, current.en);
+        writer_printf(out, "ID: %-*"PRIu16" ", WRITER_ID_SPACE, current.id);
+        writer_printf(out, "Size: ");
         // In case of variable length print keyword "var"
         current.length == FDS_IPFIX_VAR_IE_LEN
-            ? printf("%-*s ", WRITER_SIZE_SPACE, "var.")
-            : printf("%-*"PRIu16" ", WRITER_SIZE_SPACE, current.length);
+            ? writer_printf(out, "%-*s ", WRITER_SIZE_SPACE, "var.")
+            : writer_printf(out, "%-*"PRIu16" ", WRITER_SIZE_SPACE, current.length);
 
         const char *pen_name = "<unknown>";
         const char *field_name = "<unknown>";
@@ -214,25 +306,25 @@ read_template_set(struct fds_tset_iter *tset_iter, uint16_t set_id, const fds_ie
             }
         }
 
-        printf("| %*s:%s", WRITER_ORG_NAME_SPACE, pen_name, field_name);
+        writer_printf(out, "| %*s:%s", WRITER_ORG_NAME_SPACE, pen_name, field_name);
         if ((current.flags & FDS_TFIELD_SCOPE) != 0) {
-            printf(" (scope)");
+            writer_printf(out, " (scope)");
         }
-        putchar('\n');
+        writer_putc(out, '\n');
     }
     fds_template_destroy(tmplt);
 }
 
 void
-print_indent(unsigned int n)
+print_indent(writer_t *out, unsigned int n)
 {
     for (unsigned int i = 0; i < n; i++){
-        putchar('\t');
+        writer_putc(out, '\t');
     }
 }
 
 void
-read_record(struct fds_drec *rec, unsigned int indent, const fds_iemgr_t *iemgr)
+read_record(writer_t *out, struct fds_drec *rec, unsigned int indent, const fds_iemgr_t *iemgr)
 {
     // Iterate through all the fields in record
     struct fds_drec_iter iter;
@@ -240,7 +332,7 @@ read_record(struct fds_drec *rec, unsigned int indent, const fds_iemgr_t *iemgr)
 
     while (fds_drec_iter_next(&iter) != FDS_EOC) {
         struct fds_drec_field field = iter.field;
-        read_field(&field, indent, iemgr, rec->snap);
+        read_field(out, &field, indent, iemgr, rec->snap);
     }
 }
 
@@ -264,12 +356,12 @@ fds_semantic2str(enum fds_ipfix_list_semantics semantic)
 }
 
 void
-read_field(struct fds_drec_field *field, unsigned int indent, const fds_iemgr_t *iemgr,
-        const fds_tsnapshot_t *snap)
+read_field(writer_t *out, struct fds_drec_field *field, unsigned int indent,
+    const fds_iemgr_t *iemgr, const fds_tsnapshot_t *snap)
 {
     // Write info from header about field
-    print_indent(indent);
-    printf("EN: %-*"PRIu32" ID: %-*"PRIu16" ", WRITER_EN_SPACE, field->info->en,
+    print_indent(out, indent);
+    writer_printf(out, "EN: %-*"PRIu32" ID: %-*"PRIu16" ", WRITER_EN_SPACE, field->info->en,
         WRITER_ID_SPACE, field->info->id);
 
     enum fds_iemgr_element_type type;
@@ -302,29 +394,30 @@ read_field(struct fds_drec_field *field, unsigned int indent, const fds_iemgr_t
 
     if (fds_iemgr_is_type_list(type)) {
         // Process lists
-        printf("%*s:%s", WRITER_ORG_NAME_SPACE, org, field_name);
+        writer_printf(out, "%*s:%s", WRITER_ORG_NAME_SPACE, org, field_name);
         switch (type) {
         case FDS_ET_BASIC_LIST:
             // Note: header description will be complete in the function
-            read_list_basic(field, indent, iemgr, snap);
+            read_list_basic(out, field, indent, iemgr, snap);
             break;
         case FDS_ET_SUB_TEMPLATE_LIST:
-            printf(" (subTemplateList, see below)\n");
-            read_list_stl(field, indent, iemgr, snap);
+            writer_printf(out, " (subTemplateList, see below)\n");
+            read_list_stl(out, field, indent, iemgr, snap);
             break;
         case FDS_ET_SUB_TEMPLATE_MULTILIST:
-            printf(" (subTemplateMultiList, see below)\n");
-            read_list_stml(field, indent, iemgr, snap);
+            writer_printf(out, " (subTemplateMultiList, see below)\n");
+            read_list_stml(out, field, indent, iemgr, snap);
             break;
         default:
-            printf("*Unsupported list type*\n");
+            writer_printf(out, "*Unsupported list type*\n");
             break;
         }
 
         return;
     }
 
-    printf("%*s:%-*s : ", WRITER_ORG_NAME_SPACE, org, WRITER_FIELD_NAME_SPACE, field_name);
+writer_printf(out, "%*s:%-*s : ",
+        WRITER_ORG_NAME_SPACE, org, WRITER_FIELD_NAME_SPACE, field_name);
     // Read and write the data from the field
     char buffer[1024];
     int res = fds_field2str_be(field->data, field->size, type, buffer, sizeof(buffer));
@@ -332,37 +425,37 @@ read_field(struct fds_drec_field *field, unsigned int indent, const fds_iemgr_t
     if(res >= 0){
         // Conversion was successful
         if (type == FDS_ET_STRING) {
-            printf("\"%s\"", buffer);
+            writer_printf(out, "\"%s\"", buffer);
         } else if (type == FDS_ET_OCTET_ARRAY) {
-            printf("0x%s",buffer);
+            writer_printf(out, "0x%s",buffer);
         } else {
-            printf("%s", buffer);
+            writer_printf(out, "%s", buffer);
         }
 
         if (*unit != 0) {
-            printf(" %s", unit);
+            writer_printf(out, " %s", unit);
         }
-        putchar('\n');
+        writer_putc(out, '\n');
 
         return;
     }
     else if (res == FDS_ERR_BUFFER) {
         // Buffer too small
-        printf("<Data is too long to show>\n");
+        writer_printf(out, "<Data is too long to show>\n");
         return;
     }
     else {
         // Any other error
-        printf("*Invalid value*\n");
+        writer_printf(out, "*Invalid value*\n");
         return;
     }
 }
 
 void
-read_list_basic(struct fds_drec_field *field, unsigned int indent, const fds_iemgr_t *iemgr,
-    const fds_tsnapshot_t *snap)
+read_list_basic(writer_t *out, struct fds_drec_field *field, unsigned int indent,
+    const fds_iemgr_t *iemgr, const fds_tsnapshot_t *snap)
 {
-    printf(" (basicList");
+    writer_printf(out, " (basicList");
 
     struct fds_blist_iter it;
     fds_blist_iter_init(&it, field, iemgr);
@@ -371,9 +464,9 @@ read_list_basic(struct fds_drec_field *field, unsigned int indent, const fds_iem
     int rc = fds_blist_iter_next(&it);
     if (rc != FDS_EOC && rc != FDS_OK) {
         // Malformed
-        printf(")\n");
-        print_indent(indent);
-        printf("  *Malformed data structure: %s*\n", fds_blist_iter_err(&it));
+        writer_printf(out, ")\n");
+        print_indent(out, indent);
+        writer_printf(out, "  *Malformed data structure: %s*\n", fds_blist_iter_err(&it));
         return;
     }
 
@@ -393,9 +486,9 @@ read_list_basic(struct fds_drec_field *field, unsigned int indent, const fds_iem
         }
     }
 
-    printf(", List Semantic: %s)\n", fds_semantic2str(it.semantic));
-    //print_indent(indent);
-    //printf("> List fields: EN:%*"PRIu32" ID:%*"PRIu16" %*s:%-*s\n",
+    writer_printf(out, ", List Semantic: %s)\n", fds_semantic2str(it.semantic));
+    //print_indent(out, indent);
+    //writer_printf(out, "> List fields: EN:%*"PRIu32" ID:%*"PRIu16" %*s:%-*s\n",
     //    WRITER_EN_SPACE, ie_en, WRITER_ID_SPACE, ie_id,
     //    WRITER_ORG_NAME_SPACE, name_scope, WRITER_FIELD_NAME_SPACE, name_field);
 
@@ -413,33 +506,37 @@ read_list_basic(struct fds_drec_field *field, unsigned int indent, const fds_iem
             more_values = false;
             continue;
         case FDS_ERR_FORMAT: // Something is wrong with the record
-            printf("*Unable to continue due to malformed data: %s*\n", fds_blist_iter_err(&it));
+writer_printf(out, "*Unable to continue due to malformed data: %s*\n",
+                fds_blist_iter_err(&it));
             return;
         default:
-            printf("*Internal error: fds_blist_iter_next(): unexpected return code*\n");
+            writer_printf(out, "*Internal error: fds_blist_iter_next(): unexpected return code*\n");
             return;
         }
 
-        read_field(&it.field, indent + 1, iemgr, snap);
+        read_field(out, &it.field, indent + 1, iemgr, snap);
         cnt_value++;
     }
 
     if (cnt_value == 0) {
-        print_indent(indent + 1);
-        printf("EN: %-*"PRIu32" ID: %-*"PRIu16" ", WRITER_EN_SPACE, ie_en, WRITER_ID_SPACE, ie_id);
-        printf("%*s:%-*s : ", WRITER_ORG_NAME_SPACE, name_scope, WRITER_FIELD_NAME_SPACE, name_field);
-        printf("<empty>\n");
+        print_indent(out, indent + 1);
+writer_printf(out, "EN: %-*"PRIu32" ID: %-*"PRIu16" ",
+            WRITER_EN_SPACE, ie_en, WRITER_ID_SPACE, ie_id);
+writer_printf(out, "%*s:%-*s : ",
+            WRITER_ORG_NAME_SPACE, name_scope, WRITER_FIELD_NAME_SPACE, name_field);
+        writer_printf(out, "<empty>\n");
     }
 }
 
 void
-read_list_stl(struct fds_drec_field *field, unsigned int indent, const fds_iemgr_t *iemgr,
-    const fds_tsnapshot_t *snap)
+read_list_stl(writer_t *out, struct fds_drec_field *field, unsigned int indent,
+    const fds_iemgr_t *iemgr, const fds_tsnapshot_t *snap)
 {
     struct fds_stlist_iter it;
     fds_stlist_iter_init(&it, field, snap, FDS_STL_REPORT);
-    print_indent(indent);
-    printf("> List semantic: %s, Template ID: %"PRIu16")\n", fds_semantic2str(it.semantic), it.tid);
+    print_indent(out, indent);
+writer_printf(out, "> List semantic: %s, Template ID: %"PRIu16")\n",
+        fds_semantic2str(it.semantic), it.tid);
 
     unsigned int cnt_rec = 0;
     bool more_records = true;
@@ -453,38 +550,39 @@ read_list_stl(struct fds_drec_field *field, unsigned int indent, const fds_iemgr
             more_records = false;
             continue;
         case FDS_ERR_NOTFOUND: // Template is not available
-            print_indent(indent);
-            printf("  *Template not available - unable to decode*\n");
+            print_indent(out, indent);
+            writer_printf(out, "  *Template not available - unable to decode*\n");
             return;
         case FDS_ERR_FORMAT:   // Something is wrong with the record
-            print_indent(indent);
-            printf("*Unable to continue due to malformed data: %s*\n", fds_stlist_iter_err(&it));
+            print_indent(out, indent);
+writer_printf(out, "*Unable to continue due to malformed data: %s*\n",
+                fds_stlist_iter_err(&it));
             return;
         default:
-            print_indent(indent);
-            printf("*Internal error: fds_stlist_iter_next(): unexpected return code*\n");
+            print_indent(out, indent);
+            writer_printf(out, "*Internal error: fds_stlist_iter_next(): unexpected return code*\n");
             return;
         }
 
-        print_indent(indent);
-        printf("  - Data Record (#%u) [Length: %"PRIu16"]\n", ++cnt_rec, it.rec.size);
-        read_record(&it.rec, indent + 1, iemgr);
+        print_indent(out, indent);
+        writer_printf(out, "  - Data Record (#%u) [Length: %"PRIu16"]\n", ++cnt_rec, it.rec.size);
+        read_record(out, &it.rec, indent + 1, iemgr);
     }
 
     if (cnt_rec == 0) {
-        print_indent(indent + 1);
-        printf(" <empty>\n");
+        print_indent(out, indent + 1);
+        writer_printf(out, " <empty>\n");
     }
 }
 
 void
-read_list_stml(struct fds_drec_field *field, unsigned int indent, const fds_iemgr_t *iemgr,
-    const fds_tsnapshot_t *snap)
+read_list_stml(writer_t *out, struct fds_drec_field *field, unsigned int indent,
+    const fds_iemgr_t *iemgr, const fds_tsnapshot_t *snap)
 {
     struct fds_stmlist_iter it;
     fds_stmlist_iter_init(&it, field, snap, FDS_STL_REPORT);
-    print_indent(indent);
-    printf("> List semantic: %s\n", fds_semantic2str(it.semantic));
+    print_indent(out, indent);
+    writer_printf(out, "> List semantic: %s\n", fds_semantic2str(it.semantic));
 
     unsigned int cnt_block = 0;
     bool more_blocks = true;
@@ -501,20 +599,22 @@ read_list_stml(struct fds_drec_field *field, unsigned int indent, const fds_iemg
         case FDS_ERR_NOTFOUND: // Unable to read this block -> skip it
             break;
         case FDS_ERR_FORMAT:   // Something is wrong with the block
-            print_indent(indent);
-            printf("*Unable to continue due to malformed data: %s*\n", fds_stmlist_iter_err(&it));
+            print_indent(out, indent);
+writer_printf(out, "*Unable to continue due to malformed data: %s*\n",
+                fds_stmlist_iter_err(&it));
             return;
         default:
-            print_indent(indent);
-            printf("*Internal error: fds_stmlist_iter_next_block(): unexpected return code*\n");
+            print_indent(out, indent);
+            writer_printf(out, "*Internal error: fds_stmlist_iter_next_block(): unexpected return code*\n");
             return;
         }
 
-        print_indent(indent);
-        printf("- Top-level list header (#%u) [Template ID: %"PRIu16"]\n", ++cnt_block, it.tid);
+        print_indent(out, indent);
+writer_printf(out, "- Top-level list header (#%u) [Template ID: %"PRIu16"]\n",
+            ++cnt_block, it.tid);
         if (rc_block == FDS_ERR_NOTFOUND) {
-            print_indent(indent);
-            printf("  *Template not available - unable to decode*\n");
+            print_indent(out, indent);
+            writer_printf(out, "  *Template not available - unable to decode*\n");
             continue;
         }
 
@@ -530,28 +630,30 @@ read_list_stml(struct fds_drec_field *field, unsigned int indent, const fds_iemg
                 more_recs = false;
                 continue;
             case FDS_ERR_FORMAT: // Something is wrong with the record
-                print_indent(indent);
-                printf("*Unable to continue due to malformed data: %s*\n", fds_stmlist_iter_err(&it));
+                print_indent(out, indent);
+writer_printf(out, "*Unable to continue due to malformed data: %s*\n",
+                    fds_stmlist_iter_err(&it));
                 return;
             default:
-                print_indent(indent);
-                printf("*Internal error: fds_stmlist_iter_next_rec(): unexpected return code*\n");
+                print_indent(out, indent);
+                writer_printf(out, "*Internal error: fds_stmlist_iter_next_rec(): unexpected return code*\n");
                 return;
             }
 
-            print_indent(indent);
-            printf("  - Data Record (#%u) [Length: %"PRIu16"]\n", ++cnt_rec, it.rec.size);
-            read_record(&it.rec, indent + 1, iemgr);
+            print_indent(out, indent);
+writer_printf(out, "  - Data Record (#%u) [Length: %"PRIu16"]\n",
+                ++cnt_rec, it.rec.size);
+            read_record(out, &it.rec, indent + 1, iemgr);
         }
 
         if (cnt_rec == 0) {
-            print_indent(indent + 1);
-            printf(" <empty>\n");
+            print_indent(out, indent + 1);
+            writer_printf(out, " <empty>\n");
         }
     }
 
     if (cnt_block == 0) {
-        print_indent(indent);
-        printf(" <empty>\n");
+        print_indent(out, indent);
+        writer_printf(out, " <empty>\n");
     }
 }
\ No newline at end of file
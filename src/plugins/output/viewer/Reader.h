@@ -40,7 +40,10 @@
 #ifndef IPFIXCOL_READER_H
 #define IPFIXCOL_READER_H
 
+#include <stdbool.h>
+#include <time.h>
 #include <ipfixcol2.h>
+#include "Writer.h"
 
 /**
  * \brief spaces in output for Enterprise number field
@@ -62,6 +65,32 @@
  * \brief Spaces in output for Organization name
  */
 #define WRITER_ORG_NAME_SPACE 12
+/**
+ * \brief Maximal number of Data Records in an IPFIX Message
+ */
+#define READER_RECS_MAX UINT16_MAX
+
+/**
+ * \brief Selection of Data Records to print
+ *
+ * If enabled, only 1 in N Data Records is printed and at most M Data Records per second.
+ * Data Sets without selected records are skipped. IPFIX Messages without selected records
+ * are also skipped, unless they contain (Options) Template Sets.
+ */
+struct reader_select {
+    /** Print 1 in N Data Records (0 or 1 == all)                           */
+    uint32_t sampling;
+    /** Maximal number of printed Data Records per second (0 == unlimited) */
+    uint32_t rate_limit;
+    /** Number of seen Data Records                                        */
+    uint64_t rec_seen;
+    /** Second of the rate limiter (monotonic clock)                       */
+    time_t rate_sec;
+    /** Number of printed Data Records in the second                       */
+    uint32_t rate_cnt;
+    /** Selected Data Records of the current IPFIX Message                 */
+    bool rec_print[READER_RECS_MAX];
+};
 
 /**
  * \brief Print all data of an IPFIX Message
@@ -69,22 +98,26 @@
  * Function reads and prints the header of the packet and then iterates through the Sets and their
  * records. Information printed from the header of the packet are:
  * version, length, export time, sequence number and Observation Domain ID
+ * \param[in] out   Output writer
  * \param[in] msg   IPFIX message which will be printed
  * \param[in] iemgr Information Element manager
+ * \param[in] sel   Selection of Data Records to print
  */
 void
-read_packet(ipx_msg_ipfix_t *msg, const fds_iemgr_t *iemgr);
+read_packet(writer_t *out, ipx_msg_ipfix_t *msg, const fds_iemgr_t *iemgr,
+    struct reader_select *sel);
 
 /**
  * \brief Print all values inside the single Data Record of an IPFIX message
  *
  * Reads and prints the header of the Data Record and then iterates through its fields.
+ * \param[in] out    Output writer
  * \param[in] rec    Record which will be printed
  * \param[in] indent Additional output indentation
  * \param[in] iemgr  Information Element manager
  */
 void
-read_record(struct fds_drec *rec, unsigned int indent, const fds_iemgr_t *iemgr);
+read_record(writer_t *out, struct fds_drec *rec, unsigned int indent, const fds_iemgr_t *iemgr);
 
 /**
  * \brief Print the value of the Data Record field
@@ -92,65 +125,71 @@ read_record(struct fds_drec *rec, unsigned int indent, const fds_iemgr_t *iemgr)
  * Reads and prints all information about the data in the field. If the detailed definition is
  * known, value is printed in human readable format. Otherwise data are printed in the raw
  * format (hexadecimal). In both cases Enterprise number and ID will be printed.
+ * \param[in] out    Output writer
  * \param[in] field  Field which will be printed
  * \param[in] indent Additional output indentation
  * \param[in] iemgr  Information Element manager
  * \param[in] snap   Template snapshot of the Data Record
  */
 void
-read_field(struct fds_drec_field *field, unsigned int indent, const fds_iemgr_t *iemgr,
-    const fds_tsnapshot_t *snap);
+read_field(writer_t *out, struct fds_drec_field *field, unsigned int indent,
+    const fds_iemgr_t *iemgr, const fds_tsnapshot_t *snap);
 
 /**
  * \brief Print the content of basicList data type
  *
  * Iterates through the list and prints all values.
+ * \param[in] out    Output writer
  * \param[in] field  Field which will be printed
  * \param[in] indent Additional output indentation
  * \param[in] iemgr  Information Element manager
  * \param[in] snap   Template snapshot of the Data Record
  */
 void
-read_list_basic(struct fds_drec_field *field, unsigned int indent, const fds_iemgr_t *iemgr,
-    const fds_tsnapshot_t *snap);
+read_list_basic(writer_t *out, struct fds_drec_field *field, unsigned int indent,
+    const fds_iemgr_t *iemgr, const fds_tsnapshot_t *snap);
 
 /**
  * \brief Print the content of subTemplateList data type
  *
  * Iterates through the list and prints all Data Records.
+ * \param[in] out    Output writer
  * \param[in] field  Field which will be printed
  * \param[in] indent Additional output indentation
  * \param[in] iemgr  Information Element manager
  * \param[in] snap   Template snapshot of the Data Record
  */
 void
-read_list_stl(struct fds_drec_field *field, unsigned int indent, const fds_iemgr_t *iemgr,
-    const fds_tsnapshot_t *snap);
+read_list_stl(writer_t *out, struct fds_drec_field *field, unsigned int indent,
+    const fds_iemgr_t *iemgr, const fds_tsnapshot_t *snap);
 
 /**
  * \brief Print the content of subTemplateMultiList data type
  *
  * Iterates through the list and prints all top-level lists and their content i.e. Data Records.
+ * \param[in] out    Output writer
  * \param[in] field  Field which will be printed
  * \param[in] indent Additional output indentation
  * \param[in] iemgr  Information Element manager
  * \param[in] snap   Template snapshot of the Data Record
  */
 void
-read_list_stml(struct fds_drec_field *field, unsigned int indent, const fds_iemgr_t *iemgr,
-    const fds_tsnapshot_t *snap);
+read_list_stml(writer_t *out, struct fds_drec_field *field, unsigned int indent,
+    const fds_iemgr_t *iemgr, const fds_tsnapshot_t *snap);
 
 /**
  * \brief Print the (Options) Template Record
  *
  * Reads and prints content of the (Options) Template Record. Uses Information Element manager
  * for determine description of present Information Elements.
+ * \param[in] out       Output writer
  * \param[in] tset_iter Template iterator
  * \param[in] set_id    ID of the Set to which the record belongs
  * \param[in] iemgr     Information Element manager
  */
 void
-read_template_set(struct fds_tset_iter *tset_iter, uint16_t set_id, const fds_iemgr_t *iemgr);
+read_template_set(writer_t *out, struct fds_tset_iter *tset_iter, uint16_t set_id,
+    const fds_iemgr_t *iemgr);
 
 /**
  * \brief Print the IPFIX Set and its content
@@ -158,12 +197,15 @@ read_template_set(struct fds_tset_iter *tset_iter, uint16_t set_id, const fds_ie
  * Reads and prints single IPFIX Set and determines what kind of IPFIX Set it is and which
  * read_xxx function to use for reading its content.
  *
+ * \param[in]     out       Output writer
  * \param[in]     sets_iter Sets iterator
  * \param[in]     msg       IPFIX message
  * \param[in]     iemgr     Information Element manager
  * \param[in/out] rec_i     Number of processed Data Records
+ * \param[in]     rec_print Data Records of the message to print (NULL == all)
  */
 void
-read_set(struct ipx_ipfix_set *set, ipx_msg_ipfix_t *msg, const fds_iemgr_t *iemgr, uint32_t *rec_i);
+read_set(writer_t *out, struct ipx_ipfix_set *set, ipx_msg_ipfix_t *msg, const fds_iemgr_t *iemgr,
+    uint32_t *rec_i, const bool *rec_print);
 
 #endif //IPFIXCOL_READER_H
@@ -0,0 +1,324 @@
+/**
+ * \file src/plugins/output/viewer/Writer.c
+ * \author agent <agent@local>
+ * \brief Viewer - buffered output with a background thread (source file)
+ * \date 2026
+ */
+/* Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is'', and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#include <inttypes.h>
+#include <pthread.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "Writer.h"
+
+/** Size of a buffer (bytes)                                       */
+#define WRITER_BUFFER_SIZE (4U * 1024U * 1024U)
+
+/** Buffer of formatted text                                       */
+struct writer_buffer {
+    /** Text (not NULL terminated)                                 */
+    char *data;
+    /** Length of the text                                         */
+    size_t len;
+};
+
+struct writer {
+    /** Plugin context (only for log)                              */
+    ipx_ctx_t *ctx;
+    /** Drop messages instead of waiting for the thread            */
+    bool non_blocking;
+
+    /** Buffers (one filled by the caller, one written by the thread) */
+    struct writer_buffer buffers[2];
+    /** Buffer being filled                                        */
+    struct writer_buffer *current;
+    /** Position of the beginning of the current message           */
+    size_t msg_start;
+    /** The current message doesn't fit into the buffer            */
+    bool msg_overflow;
+    /** Number of dropped messages (not reported yet)              */
+    uint64_t msg_dropped;
+
+    /** Thread                                                     */
+    pthread_t thread;
+    /** Synchronization of the thread                              */
+    pthread_mutex_t mutex;
+    /** Notification about a new job of the thread                 */
+    pthread_cond_t cond_job;
+    /** Notification about a finished job                          */
+    pthread_cond_t cond_done;
+
+    struct {
+        /** Buffer to write (NULL == idle)                         */
+        struct writer_buffer *buffer;
+        /** Request to stop the thread                             */
+        bool stop;
+    } job;
+};
+
+/**
+ * \brief Main function of the thread
+ * \param[in] arg Writer
+ * \return Nothing
+ */
+static void *
+writer_thread(void *arg)
+{
+    writer_t *wrt = (writer_t *) arg;
+
+    pthread_mutex_lock(&wrt->mutex);
+    while (true) {
+        while (!wrt->job.stop && !wrt->job.buffer) {
+            pthread_cond_wait(&wrt->cond_job, &wrt->mutex);
+        }
+
+        if (!wrt->job.buffer) {
+            // Stop request
+            break;
+        }
+
+        struct writer_buffer *buffer = wrt->job.buffer;
+        pthread_mutex_unlock(&wrt->mutex);
+
+        if (fwrite(buffer->data, 1, buffer->len, stdout) != buffer->len || fflush(stdout) != 0) {
+            clearerr(stdout);
+        }
+
+        pthread_mutex_lock(&wrt->mutex);
+        wrt->job.buffer = NULL;
+        pthread_cond_signal(&wrt->cond_done);
+    }
+    pthread_mutex_unlock(&wrt->mutex);
+
+    return NULL;
+}
+
+writer_t *
+writer_create(ipx_ctx_t *ctx, bool non_blocking)
+{
+    writer_t *wrt = calloc(1, sizeof(*wrt));
+    if (!wrt) {
+        IPX_CTX_ERROR(ctx, "Memory allocation failed! (%s:%d)", __FILE__, __LINE__);
+        return NULL;
+    }
+
+    wrt->ctx = ctx;
+    wrt->non_blocking = non_blocking;
+    wrt->buffers[0].data = malloc(WRITER_BUFFER_SIZE);
+    wrt->buffers[1].data = malloc(WRITER_BUFFER_SIZE);
+    wrt->current = &wrt->buffers[0];
+    if (!wrt->buffers[0].data || !wrt->buffers[1].data) {
+        IPX_CTX_ERROR(ctx, "Memory allocation failed! (%s:%d)", __FILE__, __LINE__);
+        free(wrt->buffers[0].data);
+        free(wrt->buffers[1].data);
+        free(wrt);
+        return NULL;
+    }
+
+    pthread_mutex_init(&wrt->mutex, NULL);
+    pthread_cond_init(&wrt->cond_job, NULL);
+    pthread_cond_init(&wrt->cond_done, NULL);
+
+    int rc = pthread_create(&wrt->thread, NULL, writer_thread, wrt);
+    if (rc != 0) {
+        IPX_CTX_ERROR(ctx, "Failed to start a writer thread: %s", strerror(rc));
+        pthread_cond_destroy(&wrt->cond_done);
+        pthread_cond_destroy(&wrt->cond_job);
+        pthread_mutex_destroy(&wrt->mutex);
+        free(wrt->buffers[0].data);
+        free(wrt->buffers[1].data);
+        free(wrt);
+        return NULL;
+    }
+
+    return wrt;
+}
+
+/**
+ * \brief Check if the thread is idle
+ * \param[in] wrt Writer
+ * \return True or false
+ */
+static bool
+writer_is_idle(writer_t *wrt)
+{
+    pthread_mutex_lock(&wrt->mutex);
+    const bool idle = (wrt->job.buffer == NULL);
+    pthread_mutex_unlock(&wrt->mutex);
+    return idle;
+}
+
+/**
+ * \brief Pass the filled buffer to the thread
+ *
+ * If the thread is still writing the previous buffer, wait until it's finished.
+ * \param[in] wrt Writer
+ */
+static void
+writer_pass(writer_t *wrt)
+{
+    pthread_mutex_lock(&wrt->mutex);
+    while (wrt->job.buffer != NULL) {
+        pthread_cond_wait(&wrt->cond_done, &wrt->mutex);
+    }
+
+    wrt->job.buffer = wrt->current;
+    pthread_cond_signal(&wrt->cond_job);
+    pthread_mutex_unlock(&wrt->mutex);
+
+    // The other buffer is not used by the thread anymore
+    wrt->current = (wrt->current == &wrt->buffers[0]) ? &wrt->buffers[1] : &wrt->buffers[0];
+    wrt->current->len = 0;
+    wrt->msg_start = 0;
+}
+
+void
+writer_destroy(writer_t *wrt)
+{
+    if (wrt->current->len > 0) {
+        writer_pass(wrt);
+    }
+
+    pthread_mutex_lock(&wrt->mutex);
+    wrt->job.stop = true;
+    pthread_cond_signal(&wrt->cond_job);
+    pthread_mutex_unlock(&wrt->mutex);
+    pthread_join(wrt->thread, NULL);
+
+    pthread_cond_destroy(&wrt->cond_done);
+    pthread_cond_destroy(&wrt->cond_job);
+    pthread_mutex_destroy(&wrt->mutex);
+    free(wrt->buffers[0].data);
+    free(wrt->buffers[1].data);
+    free(wrt);
+}
+
+void
+writer_msg_begin(writer_t *wrt)
+{
+    wrt->msg_start = wrt->current->len;
+    wrt->msg_overflow = false;
+
+    if (wrt->msg_dropped > 0) {
+        writer_printf(wrt, "--------------------------------------------------------------------------------\n");
+        writer_printf(wrt, "*%" PRIu64 " IPFIX Message(s) dropped - output is too slow*\n",
+            wrt->msg_dropped);
+        wrt->msg_dropped = 0;
+    }
+}
+
+void
+writer_msg_end(writer_t *wrt)
+{
+    if (wrt->msg_overflow) {
+        // Drop the whole message
+        wrt->current->len = wrt->msg_start;
+        wrt->msg_overflow = false;
+        wrt->msg_dropped++;
+    }
+
+    wrt->msg_start = wrt->current->len;
+    if (wrt->current->len > 0 && writer_is_idle(wrt)) {
+        writer_pass(wrt);
+    }
+}
+
+/**
+ * \brief Make space in the buffer (the current text doesn't fit)
+ * \param[in] wrt Writer
+ * \return True if the buffer has been replaced by an empty one, false otherwise.
+ */
+static bool
+writer_make_space(writer_t *wrt)
+{
+    if (wrt->non_blocking) {
+        // The rest of the message is ignored
+        wrt->msg_overflow = true;
+        return false;
+    }
+
+    if (wrt->current->len == 0) {
+        // The text is larger than the whole buffer
+        return false;
+    }
+
+    writer_pass(wrt);
+    return true;
+}
+
+void
+writer_printf(writer_t *wrt, const char *fmt, ...)
+{
+    while (!wrt->msg_overflow) {
+        struct writer_buffer *buffer = wrt->current;
+        const size_t size = WRITER_BUFFER_SIZE - buffer->len;
+
+        va_list ap;
+        va_start(ap, fmt);
+        int rc = vsnprintf(buffer->data + buffer->len, size, fmt, ap);
+        va_end(ap);
+
+        if (rc < 0) {
+            return;
+        }
+
+        if ((size_t) rc < size) {
+            // Note: the terminating null byte is not part of the text
+            buffer->len += (size_t) rc;
+            return;
+        }
+
+        if (!writer_make_space(wrt)) {
+            return;
+        }
+    }
+}
+
+void
+writer_putc(writer_t *wrt, char c)
+{
+    if (wrt->msg_overflow) {
+        return;
+    }
+
+    if (wrt->current->len == WRITER_BUFFER_SIZE && !writer_make_space(wrt)) {
+        return;
+    }
+
+    wrt->current->data[wrt->current->len++] = c;
+}
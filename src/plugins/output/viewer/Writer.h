@@ -0,0 +1,108 @@
+/**
+ * \file src/plugins/output/viewer/Writer.h
+ * \author agent <agent@local>
+ * \brief Viewer - buffered output with a background thread (header file)
+ * \date 2026
+ */
+/* Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is'', and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#ifndef IPFIXCOL_VIEWER_WRITER_H
+#define IPFIXCOL_VIEWER_WRITER_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <ipfixcol2.h>
+
+/** Internal writer structure */
+typedef struct writer writer_t;
+
+/**
+ * \brief Create a writer to the standard output
+ *
+ * Formatted text is stored into a buffer and written to the standard output by a background
+ * thread. While the thread is writing one buffer, the other one is filled. A buffer is passed
+ * to the thread at the end of an IPFIX Message (see writer_msg_end()) if the thread is idle.
+ *
+ * If the thread cannot keep up with incoming messages (e.g. slow terminal) and the buffer is
+ * full, the writer either waits for the thread (blocking mode) or drops the whole IPFIX Message
+ * (non-blocking mode). In the latter case, the number of dropped messages is printed instead.
+ * \param[in] ctx          Plugin context (only for log)
+ * \param[in] non_blocking Drop messages instead of waiting for the thread
+ * \return Pointer to the writer or NULL (memory allocation error or failed to start the thread)
+ */
+writer_t *
+writer_create(ipx_ctx_t *ctx, bool non_blocking);
+
+/**
+ * \brief Write all remaining text and destroy the writer
+ * \param[in] wrt Writer
+ */
+void
+writer_destroy(writer_t *wrt);
+
+/**
+ * \brief Start a new IPFIX Message
+ * \param[in] wrt Writer
+ */
+void
+writer_msg_begin(writer_t *wrt);
+
+/**
+ * \brief Finish the IPFIX Message
+ *
+ * If the message doesn't fit into the buffer in the non-blocking mode, it is dropped.
+ * The buffer is passed to the thread if it's idle.
+ * \param[in] wrt Writer
+ */
+void
+writer_msg_end(writer_t *wrt);
+
+/**
+ * \brief Append a formatted string
+ * \param[in] wrt Writer
+ * \param[in] fmt Format string (see printf())
+ */
+void
+writer_printf(writer_t *wrt, const char *fmt, ...) __attribute__((format(printf, 2, 3)));
+
+/**
+ * \brief Append a character
+ * \param[in] wrt Writer
+ * \param[in] c   Character
+ */
+void
+writer_putc(writer_t *wrt, char c);
+
+#endif //IPFIXCOL_VIEWER_WRITER_H
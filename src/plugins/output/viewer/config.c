@@ -39,24 +39,34 @@
  *
  */
 
+#include <assert.h>
+#include <inttypes.h>
 #include <stdlib.h>
 #include <limits.h>
 #include "config.h"
 
 /*
  * <params>
- *  <delay>...</delay>          <!-- in microseconds -->
+ *  <sampling>...</sampling>       <!-- optional, print 1 in N Data Records -->
+ *  <rateLimit>...</rateLimit>     <!-- optional, max. Data Records per second -->
+ *  <nonBlocking>...</nonBlocking> <!-- optional, drop messages if output is too slow -->
  * </params>
  */
 
 /** XML nodes */
 enum params_xml_nodes {
-    NODE_DELAY = 1
+    NODE_DELAY = 1,
+    NODE_SAMPLING,
+    NODE_RATE_LIMIT,
+    NODE_NON_BLOCKING
 };
 
 /** Definition of the \<params\> node  */
 static const struct fds_xml_args args_params[] = {
     FDS_OPTS_ROOT("params"),
+    FDS_OPTS_ELEM(NODE_SAMPLING,     "sampling",    FDS_OPTS_T_UINT, FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM(NODE_RATE_LIMIT,   "rateLimit",   FDS_OPTS_T_UINT, FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM(NODE_NON_BLOCKING, "nonBlocking", FDS_OPTS_T_BOOL, FDS_OPTS_P_OPT),
     FDS_OPTS_END
 };
 
@@ -71,8 +81,6 @@ static const struct fds_xml_args args_params[] = {
 static int
 config_parser_root(ipx_ctx_t *ctx, fds_xml_ctx_t *root, struct instance_config *cfg)
 {
-    (void) ctx;
-
     const struct fds_xml_cont *content;
     while(fds_xml_next(root, &content) != FDS_EOC) {
         switch (content->id) {
@@ -82,6 +90,29 @@ config_parser_root(ipx_ctx_t *ctx, fds_xml_ctx_t *root, struct instance_config *
             cfg->sleep_time.tv_nsec = (content->val_uint % 1000000LL) * 1000LL;
             cfg->sleep_time.tv_sec  = content->val_uint / 1000000LL;
             break;
+        case NODE_SAMPLING:
+            // Print 1 in N Data Records
+            assert(content->type == FDS_OPTS_T_UINT);
+            if (content->val_uint == 0 || content->val_uint > UINT32_MAX) {
+                IPX_CTX_ERROR(ctx, "Sampling must be in range 1..%" PRIu32 "!", UINT32_MAX);
+                return IPX_ERR_FORMAT;
+            }
+            cfg->sampling = (uint32_t) content->val_uint;
+            break;
+        case NODE_RATE_LIMIT:
+            // Maximal number of Data Records per second
+            assert(content->type == FDS_OPTS_T_UINT);
+            if (content->val_uint > UINT32_MAX) {
+                IPX_CTX_ERROR(ctx, "Rate limit must be in range 0..%" PRIu32 "!", UINT32_MAX);
+                return IPX_ERR_FORMAT;
+            }
+            cfg->rate_limit = (uint32_t) content->val_uint;
+            break;
+        case NODE_NON_BLOCKING:
+            // Drop messages instead of waiting for the output
+            assert(content->type == FDS_OPTS_T_BOOL);
+            cfg->non_blocking = content->val_bool;
+            break;
         default:
             // Internal error
             assert(false);
@@ -99,7 +130,9 @@ config_parser_root(ipx_ctx_t *ctx, fds_xml_ctx_t *root, struct instance_config *
 static void
 config_default_set(struct instance_config *cfg)
 {
-    (void) cfg;
+    cfg->sampling = 1;
+    cfg->rate_limit = 0;
+    cfg->non_blocking = false;
 }
 
 struct instance_config *
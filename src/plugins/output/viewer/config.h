@@ -44,11 +44,18 @@
 
 #include <ipfixcol2.h>
 #include "stdint.h"
+#include <stdbool.h>
 
 /** Configuration of a instance of the dummy plugin      */
 struct instance_config {
     /** Sleep time                                       */
     struct timespec sleep_time;
+    /** Print 1 in N Data Records                        */
+    uint32_t sampling;
+    /** Maximal number of Data Records per second (0 == unlimited) */
+    uint32_t rate_limit;
+    /** Drop IPFIX Messages if the output is too slow    */
+    bool non_blocking;
 };
 
 /**
@@ -69,6 +69,10 @@ IPX_API struct ipx_plugin_info ipx_plugin_info = {
 struct instance_data {
     /** Parsed configuration of the instance  */
     struct instance_config *config;
+    /** Buffered output                       */
+    writer_t *writer;
+    /** Selection of Data Records to print    */
+    struct reader_select select;
 };
 
 int
@@ -85,6 +89,14 @@ ipx_plugin_init(ipx_ctx_t *ctx, const char *params)
         return IPX_ERR_DENIED;
     }
 
+    if ((data->writer = writer_create(ctx, data->config->non_blocking)) == NULL) {
+        config_destroy(data->config);
+        free(data);
+        return IPX_ERR_DENIED;
+    }
+
+    data->select.sampling = data->config->sampling;
+    data->select.rate_limit = data->config->rate_limit;
     ipx_ctx_private_set(ctx, data);
 
     // Subscribe to receive IPFIX messages and Transport Session events
@@ -99,6 +111,7 @@ ipx_plugin_destroy(ipx_ctx_t *ctx, void *cfg)
     (void) ctx; // Suppress warnings
 
     struct instance_data *data = (struct instance_data *) cfg;
+    writer_destroy(data->writer); // Remaining output is written
     config_destroy(data->config);
     free(data);
 }
@@ -106,7 +119,7 @@ ipx_plugin_destroy(ipx_ctx_t *ctx, void *cfg)
 int
 ipx_plugin_process(ipx_ctx_t *ctx, void *cfg, ipx_msg_t *msg)
 {
-    (void) cfg;
+    struct instance_data *data = (struct instance_data *) cfg;
     //Check of the type
     int type = ipx_msg_get_type(msg);
     if (type != IPX_MSG_IPFIX) {
@@ -117,7 +130,7 @@ ipx_plugin_process(ipx_ctx_t *ctx, void *cfg, ipx_msg_t *msg)
 
     //Convert the message to the IPFIX message and read it
     ipx_msg_ipfix_t *ipfix_msg = ipx_msg_base2ipfix(msg);
-    read_packet(ipfix_msg, iemgr);
+    read_packet(data->writer, ipfix_msg, iemgr, &data->select);
 
     return IPX_OK;
 }
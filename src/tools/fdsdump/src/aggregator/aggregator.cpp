@@ -8,46 +8,58 @@
 #include "aggregator.hpp"
 
 #include <algorithm>
+#include <cstdlib>
 #include <cstring>
+#include <fstream>
 #include <iostream>
 #include <functional>
 
+#include <unistd.h>
+
 #include "3rd_party/xxhash/xxhash.h"
 #include "common/common.hpp"
 #include "common/fieldView.hpp"
 
 #include "binaryHeap.hpp"
+#include "hyperLogLog.hpp"
 #include "informationElements.hpp"
+#include "keyDictionary.hpp"
 #include "sort.hpp"
 
 namespace fdsdump {
 namespace aggregator {
 
-static int
-fds_drec_find(
-    fds_drec *drec,
-    uint32_t pen,
-    uint16_t id,
-    uint16_t flags,
-    fds_drec_field *field)
-{
-    if (flags == 0) {
-        return fds_drec_find(drec, pen, id, field);
-
-    } else {
-        fds_drec_iter iter;
-        fds_drec_iter_init(&iter, drec, flags);
+/// Magic bytes of a partial result
+static const char PARTIAL_MAGIC[4] = {'F', 'D', 'S', 'P'};
+/// Version of the partial result format
+static const uint32_t PARTIAL_VERSION = 2;
+/// Value to detect a partial result of a different byte order
+static const uint32_t PARTIAL_BYTE_ORDER = 0x01020304;
 
-        int ret = fds_drec_iter_find(&iter, pen, id);
-        if (ret != FDS_EOC) {
-            *field = iter.field;
-        }
+/// Number of bits of the key hash selecting the partition of a spilled record
+static const unsigned int SPILL_PARTITION_BITS = 6;
+/// Number of partitions of spilled records
+static const size_t SPILL_PARTITIONS = size_t(1) << SPILL_PARTITION_BITS;
+/// Number of records read from a run file at once
+static const size_t SPILL_READ_RECORDS = 4096;
 
-        assert(ret == FDS_EOC || field->data != nullptr);
-
-        return ret;
-    }
-}
+/**
+ * @brief Header of a partial result
+ *
+ * The header is followed by the signature, values of dictionary-coded keys
+ * (for each such key, the number of values and the values zero-padded to
+ * 128 bytes) and the records.
+ */
+struct PartialHeader {
+    char magic[4];
+    uint32_t version;
+    uint32_t byte_order;
+    uint32_t signature_size;
+    uint64_t keys_size;
+    uint64_t values_size;
+    uint64_t error;
+    uint64_t record_count;
+};
 
 static void
 init_value(const ViewField &field, ViewValue &value)
@@ -115,6 +127,10 @@ init_value(const ViewField &field, ViewValue &value)
 
         break;
 
+    case ViewFieldKind::DistinctCountAggregate:
+        hll_init((uint8_t *) &value, field.extra.hll_precision);
+        break;
+
     default:
         memset((uint8_t *) &value, 0, field.size);
         break;
@@ -162,6 +178,10 @@ load_view_value(const ViewField &view_field, fds_drec_field &drec_field, ViewVal
         break;
     case DataType::String128B:
     case DataType::Octets128B:
+        if (view_field.dictionary) {
+            value.u32 = view_field.dictionary->encode(drec_field.data, drec_field.size);
+            break;
+        }
         memset(value.str, 0, 128);
         memcpy(value.str, drec_field.data, std::min<int>(drec_field.size, 128));
         break;
@@ -275,6 +295,10 @@ merge_value(const ViewField &aggregate_field, ViewValue &value, ViewValue &other
         value.u64 += other_value.u64;
         break;
 
+    case ViewFieldKind::DistinctCountAggregate:
+        hll_merge((uint8_t *) &value, (const uint8_t *) &other_value, aggregate_field.extra.hll_precision);
+        break;
+
     default: assert(0);
 
     }
@@ -294,7 +318,7 @@ merge_records(const ViewDefinition &def, uint8_t *record, uint8_t *other_record)
 }
 
 bool
-build_key(const ViewDefinition &view_def, fds_drec &drec, uint8_t *key_buffer, ViewDirection direction, uint16_t drec_find_flags)
+build_key(const ViewDefinition &view_def, FieldFinder &finder, fds_drec &drec, uint8_t *key_buffer, ViewDirection direction, uint16_t drec_find_flags)
 {
     ViewValue *key_value = reinterpret_cast<ViewValue *>(key_buffer);
     fds_drec_field drec_field;
@@ -303,7 +327,7 @@ build_key(const ViewDefinition &view_def, fds_drec &drec, uint8_t *key_buffer, V
 
         switch (view_field.kind) {
         case ViewFieldKind::VerbatimKey:
-            if (fds_drec_find(&drec, view_field.pen, view_field.id, drec_find_flags, &drec_field) == FDS_EOC) {
+            if (finder.find(&drec, view_field.pen, view_field.id, drec_find_flags, &drec_field) == FDS_EOC) {
                 return false;
             }
 
@@ -311,20 +335,20 @@ build_key(const ViewDefinition &view_def, fds_drec &drec, uint8_t *key_buffer, V
             break;
 
         case ViewFieldKind::SourceIPAddressKey:
-            if (fds_drec_find(&drec, IPFIX::iana, IPFIX::sourceIPv4Address, drec_find_flags, &drec_field) != FDS_EOC) {
-                key_value->ip = make_ipv4_address(drec_field.data);
-            } else if (fds_drec_find(&drec, IPFIX::iana, IPFIX::sourceIPv6Address, drec_find_flags, &drec_field) != FDS_EOC) {
-                key_value->ip = make_ipv6_address(drec_field.data);
+            if (finder.find(&drec, IPFIX::iana, IPFIX::sourceIPv4Address, drec_find_flags, &drec_field) != FDS_EOC) {
+                key_value->ip = make_ipv4_address(drec_field.data, view_field.extra.prefix_length);
+            } else if (finder.find(&drec, IPFIX::iana, IPFIX::sourceIPv6Address, drec_find_flags, &drec_field) != FDS_EOC) {
+                key_value->ip = make_ipv6_address(drec_field.data, view_field.extra.prefix_length6);
             } else {
                 return false;
             }
             break;
 
         case ViewFieldKind::DestinationIPAddressKey:
-            if (fds_drec_find(&drec, IPFIX::iana, IPFIX::destinationIPv4Address, drec_find_flags, &drec_field) != FDS_EOC) {
-                key_value->ip = make_ipv4_address(drec_field.data);
-            } else if (fds_drec_find(&drec, IPFIX::iana, IPFIX::destinationIPv6Address, drec_find_flags, &drec_field) != FDS_EOC) {
-                key_value->ip = make_ipv6_address(drec_field.data);
+            if (finder.find(&drec, IPFIX::iana, IPFIX::destinationIPv4Address, drec_find_flags, &drec_field) != FDS_EOC) {
+                key_value->ip = make_ipv4_address(drec_field.data, view_field.extra.prefix_length);
+            } else if (finder.find(&drec, IPFIX::iana, IPFIX::destinationIPv6Address, drec_find_flags, &drec_field) != FDS_EOC) {
+                key_value->ip = make_ipv6_address(drec_field.data, view_field.extra.prefix_length6);
             } else {
                 return false;
             }
@@ -333,19 +357,19 @@ build_key(const ViewDefinition &view_def, fds_drec &drec, uint8_t *key_buffer, V
         case ViewFieldKind::BidirectionalIPAddressKey:
             switch (direction) {
             case ViewDirection::Out:
-                if (fds_drec_find(&drec, IPFIX::iana, IPFIX::sourceIPv4Address, drec_find_flags, &drec_field) != FDS_EOC) {
-                    key_value->ip = make_ipv4_address(drec_field.data);
-                } else if (fds_drec_find(&drec, IPFIX::iana, IPFIX::sourceIPv6Address, drec_find_flags, &drec_field) != FDS_EOC) {
-                    key_value->ip = make_ipv6_address(drec_field.data);
+                if (finder.find(&drec, IPFIX::iana, IPFIX::sourceIPv4Address, drec_find_flags, &drec_field) != FDS_EOC) {
+                    key_value->ip = make_ipv4_address(drec_field.data, view_field.extra.prefix_length);
+                } else if (finder.find(&drec, IPFIX::iana, IPFIX::sourceIPv6Address, drec_find_flags, &drec_field) != FDS_EOC) {
+                    key_value->ip = make_ipv6_address(drec_field.data, view_field.extra.prefix_length6);
                 } else {
                     return false;
                 }
                 break;
             case ViewDirection::In:
-                if (fds_drec_find(&drec, IPFIX::iana, IPFIX::destinationIPv4Address, drec_find_flags, &drec_field) != FDS_EOC) {
-                    key_value->ip = make_ipv4_address(drec_field.data);
-                } else if (fds_drec_find(&drec, IPFIX::iana, IPFIX::destinationIPv6Address, drec_find_flags, &drec_field) != FDS_EOC) {
-                    key_value->ip = make_ipv6_address(drec_field.data);
+                if (finder.find(&drec, IPFIX::iana, IPFIX::destinationIPv4Address, drec_find_flags, &drec_field) != FDS_EOC) {
+                    key_value->ip = make_ipv4_address(drec_field.data, view_field.extra.prefix_length);
+                } else if (finder.find(&drec, IPFIX::iana, IPFIX::destinationIPv6Address, drec_find_flags, &drec_field) != FDS_EOC) {
+                    key_value->ip = make_ipv6_address(drec_field.data, view_field.extra.prefix_length6);
                 } else {
                     return false;
                 }
@@ -357,14 +381,14 @@ build_key(const ViewDefinition &view_def, fds_drec &drec, uint8_t *key_buffer, V
         case ViewFieldKind::BidirectionalPortKey:
             switch (direction) {
             case ViewDirection::Out:
-                if (fds_drec_find(&drec, IPFIX::iana, IPFIX::sourceTransportPort, drec_find_flags, &drec_field) != FDS_EOC) {
+                if (finder.find(&drec, IPFIX::iana, IPFIX::sourceTransportPort, drec_find_flags, &drec_field) != FDS_EOC) {
                     key_value->u16 = FieldView(drec_field).as_uint();
                 } else {
                     return false;
                 }
                 break;
             case ViewDirection::In:
-                if (fds_drec_find(&drec, IPFIX::iana, IPFIX::destinationTransportPort, drec_find_flags, &drec_field) != FDS_EOC) {
+                if (finder.find(&drec, IPFIX::iana, IPFIX::destinationTransportPort, drec_find_flags, &drec_field) != FDS_EOC) {
                     key_value->u16 = FieldView(drec_field).as_uint();
                 } else {
                     return false;
@@ -375,14 +399,14 @@ build_key(const ViewDefinition &view_def, fds_drec &drec, uint8_t *key_buffer, V
             break;
 
         case ViewFieldKind::IPv4SubnetKey:
-            if (fds_drec_find(&drec, view_field.pen, view_field.id, drec_find_flags, &drec_field) == FDS_EOC) {
+            if (finder.find(&drec, view_field.pen, view_field.id, drec_find_flags, &drec_field) == FDS_EOC) {
                 return false;
             }
             memcpy_bits(key_value->ipv4, drec_field.data, view_field.extra.prefix_length);
             break;
 
         case ViewFieldKind::IPv6SubnetKey:
-            if (fds_drec_find(&drec, view_field.pen, view_field.id, drec_find_flags, &drec_field) == FDS_EOC) {
+            if (finder.find(&drec, view_field.pen, view_field.id, drec_find_flags, &drec_field) == FDS_EOC) {
                 return false;
             }
             memcpy_bits(key_value->ipv6, drec_field.data, view_field.extra.prefix_length);
@@ -391,12 +415,12 @@ build_key(const ViewDefinition &view_def, fds_drec &drec, uint8_t *key_buffer, V
         case ViewFieldKind::BidirectionalIPv4SubnetKey:
             switch (direction) {
             case ViewDirection::Out:
-                if (fds_drec_find(&drec, IPFIX::iana, IPFIX::sourceIPv4Address, drec_find_flags, &drec_field) == FDS_EOC) {
+                if (finder.find(&drec, IPFIX::iana, IPFIX::sourceIPv4Address, drec_find_flags, &drec_field) == FDS_EOC) {
                     return false;
                 }
                 break;
             case ViewDirection::In:
-                if (fds_drec_find(&drec, IPFIX::iana, IPFIX::destinationIPv4Address, drec_find_flags, &drec_field) == FDS_EOC) {
+                if (finder.find(&drec, IPFIX::iana, IPFIX::destinationIPv4Address, drec_find_flags, &drec_field) == FDS_EOC) {
                     return false;
                 }
                 break;
@@ -408,12 +432,12 @@ build_key(const ViewDefinition &view_def, fds_drec &drec, uint8_t *key_buffer, V
         case ViewFieldKind::BidirectionalIPv6SubnetKey:
             switch (direction) {
             case ViewDirection::Out:
-                if (fds_drec_find(&drec, IPFIX::iana, IPFIX::sourceIPv6Address, drec_find_flags, &drec_field) == FDS_EOC) {
+                if (finder.find(&drec, IPFIX::iana, IPFIX::sourceIPv6Address, drec_find_flags, &drec_field) == FDS_EOC) {
                     return false;
                 }
                 break;
             case ViewDirection::In:
-                if (fds_drec_find(&drec, IPFIX::iana, IPFIX::destinationIPv6Address, drec_find_flags, &drec_field) == FDS_EOC) {
+                if (finder.find(&drec, IPFIX::iana, IPFIX::destinationIPv6Address, drec_find_flags, &drec_field) == FDS_EOC) {
                     return false;
                 }
                 break;
@@ -422,6 +446,14 @@ build_key(const ViewDefinition &view_def, fds_drec &drec, uint8_t *key_buffer, V
             memcpy_bits(key_value->ipv6, drec_field.data, view_field.extra.prefix_length);
             break;
 
+        case ViewFieldKind::TimeBinKey:
+            if (finder.find(&drec, view_field.pen, view_field.id, drec_find_flags, &drec_field) == FDS_EOC) {
+                return false;
+            }
+            key_value->ts_millisecs = FieldView(drec_field).as_datetime_ms();
+            key_value->ts_millisecs -= key_value->ts_millisecs % view_field.extra.bin_width;
+            break;
+
         case ViewFieldKind::BiflowDirectionKey:
             if (drec_find_flags & FDS_DREC_BIFLOW_FWD) {
                 key_value->u8 = 1;
@@ -444,7 +476,7 @@ build_key(const ViewDefinition &view_def, fds_drec &drec, uint8_t *key_buffer, V
 
 
 static void
-aggregate_value(const ViewField &aggregate_field, fds_drec &drec, ViewValue *value, ViewDirection direction, uint16_t drec_find_flags)
+aggregate_value(const ViewField &aggregate_field, FieldFinder &finder, fds_drec &drec, ViewValue *value, ViewDirection direction, uint16_t drec_find_flags)
 {
     if (aggregate_field.direction != ViewDirection::Unassigned && direction != aggregate_field.direction) {
         return;
@@ -455,7 +487,7 @@ aggregate_value(const ViewField &aggregate_field, fds_drec &drec, ViewValue *val
     switch (aggregate_field.kind) {
 
     case ViewFieldKind::SumAggregate:
-        if (fds_drec_find(&drec, aggregate_field.pen, aggregate_field.id, drec_find_flags, &drec_field) == FDS_EOC) {
+        if (finder.find(&drec, aggregate_field.pen, aggregate_field.id, drec_find_flags, &drec_field) == FDS_EOC) {
             return;
         }
 
@@ -472,7 +504,7 @@ aggregate_value(const ViewField &aggregate_field, fds_drec &drec, ViewValue *val
         break;
 
     case ViewFieldKind::MinAggregate:
-        if (fds_drec_find(&drec, aggregate_field.pen, aggregate_field.id, drec_find_flags, &drec_field) == FDS_EOC) {
+        if (finder.find(&drec, aggregate_field.pen, aggregate_field.id, drec_find_flags, &drec_field) == FDS_EOC) {
             return;
         }
 
@@ -510,7 +542,7 @@ aggregate_value(const ViewField &aggregate_field, fds_drec &drec, ViewValue *val
         break;
 
     case ViewFieldKind::MaxAggregate:
-        if (fds_drec_find(&drec, aggregate_field.pen, aggregate_field.id, drec_find_flags, &drec_field) == FDS_EOC) {
+        if (finder.find(&drec, aggregate_field.pen, aggregate_field.id, drec_find_flags, &drec_field) == FDS_EOC) {
             return;
         }
 
@@ -551,64 +583,158 @@ aggregate_value(const ViewField &aggregate_field, fds_drec &drec, ViewValue *val
         value->u64++;
         break;
 
+    case ViewFieldKind::DistinctCountAggregate:
+        if (finder.find(&drec, aggregate_field.pen, aggregate_field.id, drec_find_flags, &drec_field) == FDS_EOC
+                && (aggregate_field.extra.alt_id == 0
+                    || finder.find(&drec, IPFIX::iana, aggregate_field.extra.alt_id, drec_find_flags, &drec_field) == FDS_EOC)) {
+            return;
+        }
+
+        hll_add((uint8_t *) value, aggregate_field.extra.hll_precision, drec_field.data, drec_field.size);
+        break;
+
     default: assert(0);
 
     }
 }
 
-Aggregator::Aggregator(ViewDefinition view_def) :
-    m_table(view_def.keys_size, view_def.values_size),
-    m_view_def(view_def),
-    m_key_buffer(view_def.keys_size)
+Aggregator::Aggregator(ViewDefinition view_def, std::size_t expected_keys) :
+    m_table(view_def.keys_size, view_def.values_size, expected_keys),
+    m_view_def(view_def)
 {
+    for (auto &pending : m_pending) {
+        pending.key.resize(view_def.keys_size);
+    }
+}
+
+Aggregator::~Aggregator()
+{
+    profile_add_table(m_table.get_stats());
 }
 
 void
 Aggregator::process_record(Flow &flow)
 {
-    if ((flow.dir & DIRECTION_FWD) != 0) {
-        if (!m_view_def.bidirectional) {
-            aggregate(flow.rec, ViewDirection::Unassigned, FDS_DREC_BIFLOW_FWD);
-        } else {
-            aggregate(flow.rec, ViewDirection::In, FDS_DREC_BIFLOW_FWD);
-            aggregate(flow.rec, ViewDirection::Out, FDS_DREC_BIFLOW_FWD);
+    static const uint16_t flags[2] = {FDS_DREC_BIFLOW_FWD, FDS_DREC_BIFLOW_REV};
+    static const Direction dirs[2] = {DIRECTION_FWD, DIRECTION_REV};
+    static const ViewDirection unidirectional[1] = {ViewDirection::Unassigned};
+    static const ViewDirection bidirectional[2] = {ViewDirection::In, ViewDirection::Out};
+
+    const ViewDirection *view_dirs = m_view_def.bidirectional ? bidirectional : unidirectional;
+    const size_t view_dirs_cnt = m_view_def.bidirectional ? 2 : 1;
+    size_t count = 0;
+
+    uint64_t start = profile_start();
+
+    // Keys of both biflow directions are built in one pass over the cached
+    // positions of fields of the template
+    m_finder.select(flow.rec.tmplt);
+
+    for (size_t i = 0; i < 2; i++) {
+        if ((flow.dir & dirs[i]) == 0) {
+            continue;
         }
-    }
 
-    if ((flow.dir & DIRECTION_REV) != 0) {
-        if (!m_view_def.bidirectional) {
-            aggregate(flow.rec, ViewDirection::Unassigned, FDS_DREC_BIFLOW_REV);
-        } else {
-            aggregate(flow.rec, ViewDirection::In, FDS_DREC_BIFLOW_REV);
-            aggregate(flow.rec, ViewDirection::Out, FDS_DREC_BIFLOW_REV);
+        for (size_t j = 0; j < view_dirs_cnt; j++) {
+            PendingKey &pending = m_pending[count];
+
+            if (!build_key(m_view_def, m_finder, flow.rec, &pending.key[0], view_dirs[j], flags[i])) {
+                continue;
+            }
+
+            pending.direction = view_dirs[j];
+            pending.drec_find_flags = flags[i];
+            pending.hash = m_table.hash(&pending.key[0]);
+            m_table.prefetch(pending.hash);
+            count++;
         }
     }
+
+    start = m_profile.stop(ProfileStage::keys, start, count, flow.rec.size);
+
+    // Blocks of all keys are being fetched in parallel by now
+    for (size_t i = 0; i < count; i++) {
+        aggregate(flow.rec, m_pending[i], start);
+    }
 }
 
 void
-Aggregator::aggregate(fds_drec &drec, ViewDirection direction, uint16_t drec_find_flags)
+Aggregator::aggregate(fds_drec &drec, const PendingKey &pending, uint64_t &start)
 {
-    if (!build_key(m_view_def, drec, &m_key_buffer[0], direction, drec_find_flags)) {
-        return;
-    }
-
     uint8_t *record;
+    bool created = false;
 
-    if (!m_table.find_or_create(&m_key_buffer[0], record)) {
+    if (!m_table.find_or_create(const_cast<uint8_t *>(&pending.key[0]), pending.hash, record)) {
         init_values(m_view_def, record + m_view_def.keys_size);
+        created = true;
     }
 
+    start = m_profile.stop(ProfileStage::hash, start);
+
     ViewValue *value = reinterpret_cast<ViewValue *>(record + m_view_def.keys_size);
     for (const auto &aggregate_field : m_view_def.value_fields) {
-        aggregate_value(aggregate_field, drec, value, direction, drec_find_flags);
+        aggregate_value(aggregate_field, m_finder, drec, value, pending.direction, pending.drec_find_flags);
         advance_value_ptr(value, aggregate_field.size);
     }
+
+    start = m_profile.stop(ProfileStage::values, start);
+
+    if (created) {
+        spill_if_full();
+    }
+
+    if (created && m_capacity != 0) {
+        // The key might have been dropped before, assume the worst case
+        counter(record) += m_error;
+
+        if (m_table.items().size() >= 2 * m_capacity) {
+            prune();
+        }
+    }
+}
+
+void
+Aggregator::set_capacity(std::size_t max_items, const ViewField &field)
+{
+    assert(field.kind == ViewFieldKind::SumAggregate || field.kind == ViewFieldKind::CountAggregate);
+    assert(field.data_type == DataType::Unsigned64);
+
+    m_capacity = max_items;
+    m_counter_offset = field.offset;
+}
+
+void
+Aggregator::prune()
+{
+    std::vector<uint8_t *> &items = m_table.items();
+
+    if (items.size() <= m_capacity) {
+        return;
+    }
+
+    std::nth_element(items.begin(), items.begin() + m_capacity, items.end(),
+        [this](uint8_t *a, uint8_t *b) { return counter(a) > counter(b); });
+
+    for (auto it = items.begin() + m_capacity; it != items.end(); it++) {
+        m_error = std::max(m_error, counter(*it));
+    }
+
+    m_table.retain(m_capacity);
 }
 
 void
 Aggregator::merge(Aggregator &other, unsigned int max_num_items)
 {
+    const uint64_t error = m_error;
     unsigned int n = 0;
+
+    if (m_capacity != 0) {
+        // Keys missing in the other aggregator might have been dropped by it
+        for (uint8_t *record : items()) {
+            counter(record) += other.m_error;
+        }
+    }
+
     for (uint8_t *other_record : other.items()) {
         if (max_num_items != 0 && n == max_num_items) {
             break;
@@ -619,12 +745,302 @@ Aggregator::merge(Aggregator &other, unsigned int max_num_items)
         if (!m_table.find_or_create(other_record, record)) {
             //TODO: this copy is unnecessary, we could just take the already allocated record from the other table instead
             memcpy(record, other_record, m_view_def.keys_size + m_view_def.values_size);
+            if (m_capacity != 0) {
+                counter(record) += error;
+            }
+            spill_if_full();
         } else {
             merge_records(m_view_def, record, other_record);
+            if (m_capacity != 0) {
+                counter(record) -= other.m_error;
+            }
         }
 
         n++;
     }
+
+    // Partitions of the runs are the same, they are aggregated again by finish()
+    m_runs.insert(m_runs.end(), other.m_runs.begin(), other.m_runs.end());
+
+    if (m_capacity != 0) {
+        m_error += other.m_error;
+        if (m_table.items().size() >= 2 * m_capacity) {
+            prune();
+        }
+    }
+}
+
+void
+Aggregator::save(std::ostream &out, const std::string &signature)
+{
+    const size_t record_size = m_view_def.keys_size + m_view_def.values_size;
+    PartialHeader hdr = {};
+
+    memcpy(hdr.magic, PARTIAL_MAGIC, sizeof(hdr.magic));
+    hdr.version = PARTIAL_VERSION;
+    hdr.byte_order = PARTIAL_BYTE_ORDER;
+    hdr.signature_size = signature.size();
+    hdr.keys_size = m_view_def.keys_size;
+    hdr.values_size = m_view_def.values_size;
+    hdr.error = m_error;
+    hdr.record_count = items().size();
+    for (const auto &run : m_runs) {
+        hdr.record_count += run->offsets.back();
+    }
+
+    out.write(reinterpret_cast<const char *>(&hdr), sizeof(hdr));
+    out.write(signature.data(), signature.size());
+
+    for (const auto &field : m_view_def.key_fields) {
+        if (!field.dictionary) {
+            continue;
+        }
+
+        const uint64_t value_count = field.dictionary->size();
+        out.write(reinterpret_cast<const char *>(&value_count), sizeof(value_count));
+        for (uint64_t code = 0; code < value_count; code++) {
+            out.write(field.dictionary->decode(code).str, sizeof(ViewValue::str));
+        }
+    }
+
+    for (uint8_t *record : items()) {
+        out.write(reinterpret_cast<const char *>(record), record_size);
+    }
+
+    // Records of a key in multiple runs are merged by load()
+    for (const auto &run : m_runs) {
+        std::ifstream in(run->path, std::ios::binary);
+        if (!in) {
+            throw std::runtime_error("Failed to open run file '" + run->path + "'");
+        }
+
+        out << in.rdbuf();
+    }
+
+    out.flush();
+    if (!out) {
+        throw std::runtime_error("Failed to write a partial result");
+    }
+}
+
+void
+Aggregator::load(std::istream &in, const std::string &signature)
+{
+    const size_t record_size = m_view_def.keys_size + m_view_def.values_size;
+    PartialHeader hdr;
+
+    if (!in.read(reinterpret_cast<char *>(&hdr), sizeof(hdr))
+            || memcmp(hdr.magic, PARTIAL_MAGIC, sizeof(hdr.magic)) != 0) {
+        throw std::runtime_error("Not a partial result");
+    }
+
+    if (hdr.version != PARTIAL_VERSION || hdr.byte_order != PARTIAL_BYTE_ORDER) {
+        throw std::runtime_error("Unsupported version or byte order of a partial result");
+    }
+
+    std::string other_signature(hdr.signature_size, '\0');
+    if (!in.read(&other_signature[0], other_signature.size())) {
+        throw std::runtime_error("Truncated partial result");
+    }
+
+    if (other_signature != signature
+            || hdr.keys_size != m_view_def.keys_size
+            || hdr.values_size != m_view_def.values_size) {
+        throw std::runtime_error("Partial result of a different aggregation (keys and values must match)");
+    }
+
+    // Codes of dictionary-coded keys are translated to codes of our dictionaries
+    std::vector<std::pair<const ViewField *, std::vector<uint32_t>>> codes;
+    for (const auto &field : m_view_def.key_fields) {
+        if (!field.dictionary) {
+            continue;
+        }
+
+        uint64_t value_count;
+        ViewValue value;
+        std::vector<uint32_t> field_codes;
+
+        if (!in.read(reinterpret_cast<char *>(&value_count), sizeof(value_count))) {
+            throw std::runtime_error("Truncated partial result");
+        }
+
+        for (uint64_t code = 0; code < value_count; code++) {
+            if (!in.read(value.str, sizeof(value.str))) {
+                throw std::runtime_error("Truncated partial result");
+            }
+            field_codes.push_back(field.dictionary->encode(
+                reinterpret_cast<const uint8_t *>(value.str), sizeof(value.str)));
+        }
+
+        codes.emplace_back(&field, std::move(field_codes));
+    }
+
+    // Records are merged as a whole so the error bound of approximate mode is respected
+    Aggregator other(m_view_def);
+    other.m_error = hdr.error;
+    other.set_memory_limit(m_memory_limit, m_spill_dir);
+
+    std::vector<uint8_t> buffer(record_size);
+    for (uint64_t i = 0; i < hdr.record_count; i++) {
+        uint8_t *record;
+
+        if (!in.read(reinterpret_cast<char *>(buffer.data()), record_size)) {
+            throw std::runtime_error("Truncated partial result");
+        }
+
+        for (const auto &field_codes : codes) {
+            ViewValue *value = reinterpret_cast<ViewValue *>(&buffer[field_codes.first->offset]);
+            if (value->u32 >= field_codes.second.size()) {
+                throw std::runtime_error("Malformed partial result (unknown value of a key)");
+            }
+            value->u32 = field_codes.second[value->u32];
+        }
+
+        if (!other.m_table.find_or_create(buffer.data(), record)) {
+            memcpy(record, buffer.data(), record_size);
+            other.spill_if_full();
+        } else {
+            merge_records(m_view_def, record, buffer.data());
+        }
+    }
+
+    merge(other);
+}
+
+Aggregator::RunFile::~RunFile()
+{
+    unlink(path.c_str());
+}
+
+void
+Aggregator::set_memory_limit(std::size_t max_bytes, const std::string &dir)
+{
+    m_memory_limit = max_bytes;
+    m_spill_dir = dir;
+}
+
+void
+Aggregator::spill()
+{
+    const size_t record_size = m_view_def.keys_size + m_view_def.values_size;
+    std::vector<uint8_t *> &items = m_table.items();
+
+    if (items.empty()) {
+        return;
+    }
+
+    // Counting sort of the records by their partition
+    std::vector<uint8_t> partitions(items.size());
+    std::vector<uint64_t> offsets(SPILL_PARTITIONS + 1, 0);
+
+    for (size_t i = 0; i < items.size(); i++) {
+        partitions[i] = m_table.hash(items[i]) >> (64 - SPILL_PARTITION_BITS);
+        offsets[partitions[i] + 1]++;
+    }
+
+    for (size_t partition = 0; partition < SPILL_PARTITIONS; partition++) {
+        offsets[partition + 1] += offsets[partition];
+    }
+
+    std::vector<uint64_t> next(offsets.begin(), offsets.end() - 1);
+    std::vector<uint8_t *> ordered(items.size());
+
+    for (size_t i = 0; i < items.size(); i++) {
+        ordered[next[partitions[i]]++] = items[i];
+    }
+
+    std::string path = m_spill_dir + "/fdsdump-spill-XXXXXX";
+    int fd = mkstemp(&path[0]);
+    if (fd < 0) {
+        throw std::runtime_error("Failed to create a run file in '" + m_spill_dir + "'");
+    }
+    close(fd);
+
+    std::shared_ptr<RunFile> run = std::make_shared<RunFile>();
+    run->path = path;
+    run->offsets = std::move(offsets);
+
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    for (uint8_t *record : ordered) {
+        out.write(reinterpret_cast<const char *>(record), record_size);
+    }
+
+    out.close();
+    if (!out) {
+        throw std::runtime_error("Failed to write run file '" + path + "'");
+    }
+
+    m_runs.push_back(std::move(run));
+    m_table.retain(0);
+
+    if (m_table.memory_usage() > m_memory_limit) {
+        throw std::runtime_error("The memory limit is lower than the size of the empty hash table");
+    }
+}
+
+void
+Aggregator::load_partition(const RunFile &run, std::size_t partition)
+{
+    const size_t record_size = m_view_def.keys_size + m_view_def.values_size;
+    const uint64_t end = run.offsets[partition + 1];
+    uint64_t pos = run.offsets[partition];
+    std::vector<uint8_t> buffer;
+
+    if (pos == end) {
+        return;
+    }
+
+    std::ifstream in(run.path, std::ios::binary);
+    in.seekg(pos * record_size);
+
+    while (pos < end) {
+        const size_t count = std::min<uint64_t>(end - pos, SPILL_READ_RECORDS);
+
+        buffer.resize(count * record_size);
+        if (!in.read(reinterpret_cast<char *>(buffer.data()), buffer.size())) {
+            throw std::runtime_error("Failed to read run file '" + run.path + "'");
+        }
+
+        for (size_t i = 0; i < count; i++) {
+            uint8_t *other_record = &buffer[i * record_size];
+            uint8_t *record;
+
+            if (!m_table.find_or_create(other_record, record)) {
+                memcpy(record, other_record, record_size);
+            } else {
+                merge_records(m_view_def, record, other_record);
+            }
+        }
+
+        pos += count;
+    }
+}
+
+void
+Aggregator::finish(const std::function<std::size_t(std::vector<uint8_t *> &)> &select)
+{
+    if (m_runs.empty()) {
+        select(items());
+        return;
+    }
+
+    // Records in memory are spilled too, so each key is in one partition only
+    spill();
+
+    for (size_t partition = 0; partition < SPILL_PARTITIONS; partition++) {
+        for (const auto &run : m_runs) {
+            load_partition(*run, partition);
+        }
+
+        m_table.retain(select(items()));
+
+        if (m_table.memory_usage() > m_memory_limit) {
+            throw std::runtime_error("The selected records exceed the memory limit "
+                "(limit the number of printed records)");
+        }
+    }
+
+    m_runs.clear();
 }
 
 } // aggregator
@@ -6,12 +6,18 @@
 #pragma once
 
 #include <array>
+#include <functional>
+#include <istream>
+#include <memory>
+#include <ostream>
+#include <string>
 #include <vector>
 #include <cstdint>
 
 #include <libfds.h>
 
 #include "common/flowProvider.hpp"
+#include "fieldFinder.hpp"
 #include "hashTable.hpp"
 #include "sort.hpp"
 
@@ -25,9 +31,16 @@ class Aggregator {
 public:
     /**
      * @brief Constructs a new instance.
-     * @param view_def  The view definition
+     * @param view_def       The view definition
+     * @param expected_keys  Expected number of keys to size the hash table up front (0 = unknown)
      */
-    Aggregator(ViewDefinition view_def);
+    Aggregator(ViewDefinition view_def, std::size_t expected_keys = 0);
+
+    /**
+     * @brief Destroys the instance, statistics of the hash table are added
+     *   to the profile report (if enabled).
+     */
+    ~Aggregator();
 
     /**
      * @brief Process a data record.
@@ -43,6 +56,77 @@ public:
     void
     merge(Aggregator &other, unsigned int max_num_items = 0);
 
+    /**
+     * @brief Limit the number of keys held in memory (approximate mode).
+     *
+     * The aggregator keeps at most 2 * max_items keys. When the limit is reached, only
+     * max_items keys with the highest value of the counter field are kept (as in the
+     * Space-Saving algorithm). A key that appears after it has been dropped starts with the
+     * highest value of the counter ever dropped, therefore, the counter of any key is never
+     * underestimated and it's overestimated at most by get_error_bound(). Other aggregated
+     * values of such key only cover records processed since the key has been added again.
+     * @param[in] max_items  Number of keys to keep (0 = unlimited)
+     * @param[in] field      The counter field (unsigned 64-bit sum or count)
+     */
+    void
+    set_capacity(std::size_t max_items, const ViewField &field);
+
+    /**
+     * @brief Get the maximal overestimation of the counter field in approximate mode.
+     * @return The error bound (0 if no key has been dropped)
+     */
+    uint64_t get_error_bound() const { return m_error; }
+
+    /**
+     * @brief Limit the memory held by the aggregated records (exact mode).
+     *
+     * When the records in memory exceed the limit, they are split into partitions by the hash
+     * of their key and written to a run file, and the hash table is emptied. Records of one key
+     * might be spread over several runs, they are aggregated again by finish(). Runs of merged
+     * aggregators are taken over.
+     * @param[in] max_bytes  The memory limit (0 = unlimited)
+     * @param[in] dir        Directory of the run files
+     */
+    void
+    set_memory_limit(std::size_t max_bytes, const std::string &dir);
+
+    /**
+     * @brief Aggregate the spilled records again and keep only the selected records.
+     *
+     * Partitions are disjoint sets of keys, therefore, they are aggregated one by one together
+     * with the records selected so far. After each partition, @p select reorders items() so
+     * that the records to keep are at its beginning and returns their number. Without spilled
+     * records, @p select is called once and the other records are not dropped.
+     * @param[in] select  Selection of the records (e.g. a partial sort up to the output limit)
+     * @throw std::runtime_error if a run file cannot be read or the selected records exceed
+     *   the memory limit
+     */
+    void
+    finish(const std::function<std::size_t(std::vector<uint8_t *> &)> &select);
+
+    /**
+     * @brief Write the aggregated records in a binary form (a partial result).
+     *
+     * The records are written as they are held in memory (i.e. in the native
+     * byte order), together with the error bound of approximate mode. Spilled
+     * records are copied from the run files as they are.
+     * @param[in] out        The output stream
+     * @param[in] signature  Description of the view (e.g. keys and values in
+     *   a text form) that must match when the result is loaded
+     * @throw std::runtime_error if the result cannot be written
+     */
+    void
+    save(std::ostream &out, const std::string &signature);
+
+    /**
+     * @brief Merge a partial result written by save() into this aggregator.
+     * @param[in] in         The input stream
+     * @param[in] signature  Description of the view (see save())
+     * @throw std::runtime_error if the result is malformed or incompatible
+     */
+    void
+    load(std::istream &in, const std::string &signature);
+
     /**
      * @brief The underlying hash table.
      * @warning If modified from outside, behavior of further calls to process_record and
@@ -61,10 +145,62 @@ public:
 
 private:
     ViewDefinition m_view_def;
-    std::vector<uint8_t> m_key_buffer;
+    FieldFinder m_finder;
+
+    std::size_t m_capacity = 0;
+    std::size_t m_counter_offset = 0;
+    uint64_t m_error = 0;
+
+    /** @brief File of spilled records ordered by partition, removed when not used anymore */
+    struct RunFile {
+        std::string path;
+        std::vector<uint64_t> offsets; ///< Index of the first record of each partition + end
+
+        ~RunFile();
+    };
+
+    std::size_t m_memory_limit = 0;
+    std::string m_spill_dir;
+    std::vector<std::shared_ptr<RunFile>> m_runs;
+
+    /** @brief Key of a record waiting for its lookup in the hash table */
+    struct PendingKey {
+        std::vector<uint8_t> key;
+        uint64_t hash;
+        ViewDirection direction;
+        uint16_t drec_find_flags;
+    };
+
+    /** Keys of the processed record (2 biflow directions x 2 view directions at most) */
+    std::array<PendingKey, 4> m_pending;
+
+    ProfileCounters m_profile;
+
+    void
+    aggregate(fds_drec &drec, const PendingKey &pending, uint64_t &start);
+
+    uint64_t &
+    counter(uint8_t *record)
+    {
+        return reinterpret_cast<ViewValue *>(record + m_counter_offset)->u64;
+    }
+
+    void
+    prune();
+
+    void
+    spill_if_full()
+    {
+        if (m_memory_limit != 0 && m_table.memory_usage() > m_memory_limit) {
+            spill();
+        }
+    }
+
+    void
+    spill();
 
     void
-    aggregate(fds_drec &drec, ViewDirection direction, uint16_t drec_find_flags);
+    load_partition(const RunFile &run, std::size_t partition);
 };
 
 } // aggregator
@@ -0,0 +1,180 @@
+/**
+ * @file
+ * @brief Printer of aggregated records into an Arrow or Parquet file
+ */
+#include <cstring>
+
+#include "arrowPrinter.hpp"
+
+namespace fdsdump {
+namespace aggregator {
+
+/**
+ * @brief Get the size of a zero-padded string or octet array value
+ */
+static size_t
+value_length(const ViewValue &value)
+{
+    size_t length = sizeof(value.str);
+    while (length > 0 && value.str[length - 1] == 0) {
+        length--;
+    }
+    return length;
+}
+
+ArrowPrinter::ArrowPrinter(ViewDefinition view_def, ColumnWriter::Format format)
+    : m_view_def(view_def), m_writer(format)
+{
+    for (const auto &field : m_view_def.key_fields) {
+        add_column(field);
+    }
+
+    for (const auto &field : m_view_def.value_fields) {
+        add_column(field);
+    }
+}
+
+void
+ArrowPrinter::add_column(const ViewField &field)
+{
+    switch (field.data_type) {
+    case DataType::Unsigned8:
+        m_writer.add_column(field.name, ColumnType::uint8);
+        break;
+    case DataType::Unsigned16:
+        m_writer.add_column(field.name, ColumnType::uint16);
+        break;
+    case DataType::Unsigned32:
+        m_writer.add_column(field.name, ColumnType::uint32);
+        break;
+    case DataType::Unsigned64:
+        m_writer.add_column(field.name, ColumnType::uint64);
+        break;
+    case DataType::Signed8:
+        m_writer.add_column(field.name, ColumnType::int8);
+        break;
+    case DataType::Signed16:
+        m_writer.add_column(field.name, ColumnType::int16);
+        break;
+    case DataType::Signed32:
+        m_writer.add_column(field.name, ColumnType::int32);
+        break;
+    case DataType::Signed64:
+        m_writer.add_column(field.name, ColumnType::int64);
+        break;
+    case DataType::IPAddress:
+    case DataType::IPv6Address:
+        m_writer.add_column(field.name, ColumnType::fixed, 16);
+        break;
+    case DataType::IPv4Address:
+        m_writer.add_column(field.name, ColumnType::fixed, 4);
+        break;
+    case DataType::MacAddress:
+        m_writer.add_column(field.name, ColumnType::fixed, 6);
+        break;
+    case DataType::DateTime:
+        m_writer.add_column(field.name, ColumnType::timestamp);
+        break;
+    case DataType::String128B:
+        m_writer.add_column(field.name, ColumnType::string);
+        break;
+    case DataType::Octets128B:
+    case DataType::Unassigned:
+        m_writer.add_column(field.name, ColumnType::binary);
+        break;
+    }
+}
+
+void
+ArrowPrinter::print_prologue()
+{
+    m_writer.open();
+}
+
+void
+ArrowPrinter::print_record(uint8_t *record)
+{
+    ViewValue *value = (ViewValue *) record;
+
+    for (const auto &field : m_view_def.key_fields) {
+        append_value(field, *value);
+        advance_value_ptr(value, field.size);
+    }
+
+    for (const auto &field : m_view_def.value_fields) {
+        append_value(field, *value);
+        advance_value_ptr(value, field.size);
+    }
+
+    m_writer.end_row();
+}
+
+void
+ArrowPrinter::print_epilogue()
+{
+    m_writer.close();
+}
+
+void
+ArrowPrinter::append_value(const ViewField &field, const ViewValue &value)
+{
+    switch (field.data_type) {
+    case DataType::Unsigned8:
+        m_writer.append_uint(value.u8);
+        return;
+    case DataType::Unsigned16:
+        m_writer.append_uint(value.u16);
+        return;
+    case DataType::Unsigned32:
+        m_writer.append_uint(value.u32);
+        return;
+    case DataType::Unsigned64:
+        m_writer.append_uint(value.u64);
+        return;
+    case DataType::Signed8:
+        m_writer.append_int(value.i8);
+        return;
+    case DataType::Signed16:
+        m_writer.append_int(value.i16);
+        return;
+    case DataType::Signed32:
+        m_writer.append_int(value.i32);
+        return;
+    case DataType::Signed64:
+        m_writer.append_int(value.i64);
+        return;
+    case DataType::IPAddress:
+        if (value.ip.length == 4) {
+            uint8_t mapped[16] = {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0xFF, 0xFF};
+            memcpy(&mapped[12], value.ip.address, 4);
+            m_writer.append_bytes(mapped, sizeof(mapped));
+        } else {
+            m_writer.append_bytes(value.ip.address, sizeof(value.ip.address));
+        }
+        return;
+    case DataType::IPv4Address:
+        m_writer.append_bytes(value.ipv4, sizeof(value.ipv4));
+        return;
+    case DataType::IPv6Address:
+        m_writer.append_bytes(value.ipv6, sizeof(value.ipv6));
+        return;
+    case DataType::MacAddress:
+        m_writer.append_bytes(value.mac, sizeof(value.mac));
+        return;
+    case DataType::DateTime:
+        m_writer.append_timestamp(value.ts_millisecs);
+        return;
+    case DataType::String128B:
+    case DataType::Octets128B: {
+        const ViewValue &decoded = decode_value(field, value);
+        m_writer.append_bytes(reinterpret_cast<const uint8_t *>(decoded.str), value_length(decoded));
+        return;
+    }
+    case DataType::Unassigned:
+        m_writer.append_null();
+        return;
+    }
+}
+
+} // aggregator
+} // fdsdump
@@ -0,0 +1,46 @@
+/**
+ * @file
+ * @brief Printer of aggregated records into an Arrow or Parquet file
+ */
+#pragma once
+
+#include <common/columnWriter.hpp>
+
+#include "printer.hpp"
+
+namespace fdsdump {
+namespace aggregator {
+
+/**
+ * @brief Printer of aggregated records into an Apache Arrow or Parquet file.
+ *
+ * Keys and values are stored as typed columns (i.e. without conversion to
+ * text). IP addresses are stored as 16 bytes, IPv4 addresses of fields that
+ * can hold both versions are IPv4-mapped.
+ */
+class ArrowPrinter : public Printer
+{
+public:
+    ArrowPrinter(ViewDefinition view_def, ColumnWriter::Format format);
+
+    ~ArrowPrinter() override = default;
+
+    void
+    print_prologue() override;
+
+    void
+    print_record(uint8_t *record) override;
+
+    void
+    print_epilogue() override;
+
+private:
+    void add_column(const ViewField &field);
+    void append_value(const ViewField &field, const ViewValue &value);
+
+    ViewDefinition m_view_def;
+    ColumnWriter m_writer;
+};
+
+} // aggregator
+} // fdsdump
@@ -0,0 +1,143 @@
+/**
+ * @file
+ * @brief Cached lookup of fields in data records
+ */
+
+#include <cassert>
+#include <cstring>
+
+#include "fieldFinder.hpp"
+
+namespace fdsdump {
+namespace aggregator {
+
+void
+FieldFinder::select(const fds_template *tmplt)
+{
+    m_selected = nullptr;
+    get_plan(tmplt);
+    m_selected = tmplt;
+}
+
+int
+FieldFinder::find(fds_drec *drec, uint32_t pen, uint16_t id, uint16_t flags, fds_drec_field *field)
+{
+    Plan &plan = (drec->tmplt == m_selected) ? *m_last_plan : get_plan(drec->tmplt);
+
+    if (plan.dynamic) {
+        return lookup(drec, pen, id, flags, field);
+    }
+
+    const size_t dir = (flags & FDS_DREC_BIFLOW_REV) ? 2 : ((flags & FDS_DREC_BIFLOW_FWD) ? 1 : 0);
+    const size_t slot = get_slot(pen, id);
+    std::vector<Location> &locations = plan.locations[dir];
+
+    if (locations.size() <= slot) {
+        locations.resize(m_slots.size());
+    }
+
+    Location &loc = locations[slot];
+
+    if (!loc.resolved) {
+        int ret = lookup(drec, pen, id, flags, field);
+
+        loc.resolved = true;
+        loc.found = (ret != FDS_EOC);
+        if (loc.found) {
+            loc.offset = field->data - drec->data;
+            loc.size = field->size;
+            loc.info = field->info;
+        }
+
+        return ret;
+    }
+
+    if (!loc.found) {
+        return FDS_EOC;
+    }
+
+    field->data = drec->data + loc.offset;
+    field->size = loc.size;
+    field->info = loc.info;
+    return FDS_OK;
+}
+
+/**
+ * @brief Get the plan of a template (create a new one if not known)
+ */
+FieldFinder::Plan &
+FieldFinder::get_plan(const fds_template *tmplt)
+{
+    if (tmplt == m_last_tmplt
+            && m_last_plan->raw.size() == tmplt->raw.length
+            && memcmp(m_last_plan->raw.data(), tmplt->raw.data, tmplt->raw.length) == 0) {
+        return *m_last_plan;
+    }
+
+    Plan &plan = m_plans[tmplt];
+
+    if (plan.raw.size() != tmplt->raw.length
+            || memcmp(plan.raw.data(), tmplt->raw.data, tmplt->raw.length) != 0) {
+        // A new template (or a different template on the same address)
+        plan.raw.assign(tmplt->raw.data, tmplt->raw.data + tmplt->raw.length);
+        plan.dynamic = (tmplt->flags & FDS_TEMPLATE_DYNAMIC) != 0;
+        for (auto &locations : plan.locations) {
+            locations.clear();
+        }
+    }
+
+    m_last_tmplt = tmplt;
+    m_last_plan = &plan;
+    m_selected = nullptr;
+    return plan;
+}
+
+/**
+ * @brief Get the slot of a field in plans (the number of requested fields is small)
+ */
+size_t
+FieldFinder::get_slot(uint32_t pen, uint16_t id)
+{
+    const uint64_t key = (uint64_t(pen) << 16) | id;
+
+    for (size_t i = 0; i < m_slots.size(); i++) {
+        if (m_slots[i] == key) {
+            return i;
+        }
+    }
+
+    m_slots.push_back(key);
+    return m_slots.size() - 1;
+}
+
+/**
+ * @brief Find a field in a data record without the cache
+ */
+int
+FieldFinder::lookup(
+    fds_drec *drec,
+    uint32_t pen,
+    uint16_t id,
+    uint16_t flags,
+    fds_drec_field *field)
+{
+    if (flags == 0) {
+        return fds_drec_find(drec, pen, id, field);
+
+    } else {
+        fds_drec_iter iter;
+        fds_drec_iter_init(&iter, drec, flags);
+
+        int ret = fds_drec_iter_find(&iter, pen, id);
+        if (ret != FDS_EOC) {
+            *field = iter.field;
+        }
+
+        assert(ret == FDS_EOC || field->data != nullptr);
+
+        return ret;
+    }
+}
+
+} // aggregator
+} // fdsdump
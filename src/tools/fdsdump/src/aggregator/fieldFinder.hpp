@@ -0,0 +1,93 @@
+/**
+ * @file
+ * @brief Cached lookup of fields in data records
+ */
+#pragma once
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include <libfds.h>
+
+namespace fdsdump {
+namespace aggregator {
+
+/**
+ * @brief Lookup of fields in data records with cached positions of fields.
+ *
+ * Fields of records of a template without variable-length fields are always
+ * on the same position. Therefore, the position of each requested field is
+ * found only once per template (and direction flags), and further lookups
+ * are just an offset into the record. Records of other templates are
+ * searched as usual.
+ *
+ * Template pointers might be reused by a different template after the
+ * original one is freed, so the raw template is compared too. To do it only
+ * once per record, the template of a record can be selected before its fields
+ * are looked up (see select()).
+ */
+class FieldFinder {
+public:
+    /**
+     * @brief Select the template of a record whose fields are looked up next.
+     *
+     * The template is validated against the cached plan just once, further
+     * lookups in records of the template skip the validation. Therefore, the
+     * template must be selected again for every record.
+     * @param[in] tmplt The template
+     */
+    void
+    select(const fds_template *tmplt);
+
+    /**
+     * @brief Find a field in a data record.
+     * @param[in]  drec  The data record
+     * @param[in]  pen   Private Enterprise Number of the field
+     * @param[in]  id    Information Element ID of the field
+     * @param[in]  flags Biflow direction flags (see fds_drec_iter_init(), 0 = none)
+     * @param[out] field The field
+     * @return FDS_EOC if not found, other value otherwise
+     */
+    int
+    find(fds_drec *drec, uint32_t pen, uint16_t id, uint16_t flags, fds_drec_field *field);
+
+private:
+    /** Position of a field in records of a template */
+    struct Location {
+        bool resolved = false;
+        bool found = false;
+        uint16_t offset = 0;
+        uint16_t size = 0;
+        const fds_tfield *info = nullptr;
+    };
+
+    /** Positions of fields in records of a template */
+    struct Plan {
+        std::vector<uint8_t> raw;
+        bool dynamic;
+        /** Locations for each direction flags (none, forward, reverse) and requested field */
+        std::vector<Location> locations[3];
+    };
+
+    /** Requested fields (PEN and ID), index is the slot of the field in a plan */
+    std::vector<uint64_t> m_slots;
+    std::unordered_map<const fds_template *, Plan> m_plans;
+
+    const fds_template *m_last_tmplt = nullptr;
+    Plan *m_last_plan = nullptr;
+    /** Template selected by select() (its plan is m_last_plan) */
+    const fds_template *m_selected = nullptr;
+
+    Plan &
+    get_plan(const fds_template *tmplt);
+
+    size_t
+    get_slot(uint32_t pen, uint16_t id);
+
+    static int
+    lookup(fds_drec *drec, uint32_t pen, uint16_t id, uint16_t flags, fds_drec_field *field);
+};
+
+} // aggregator
+} // fdsdump
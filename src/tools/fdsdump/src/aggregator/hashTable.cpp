@@ -6,21 +6,126 @@
 
 #define XXH_INLINE_ALL
 
-#include <xmmintrin.h>
+#include <endian.h>
+#include <sys/mman.h>
 
 #include "hashTable.hpp"
 #include "3rd_party/xxhash/xxhash.h"
 
+// Tags of a block are compared by vector instructions if available. Define
+// FDSDUMP_HASH_TABLE_SCALAR to force the portable version (e.g. for comparison).
+#if defined(__SSE2__) && !defined(FDSDUMP_HASH_TABLE_SCALAR)
+#include <emmintrin.h>
+#define HASH_TABLE_SSE2 1
+#elif (defined(__ARM_NEON) || defined(__ARM_NEON__)) && !defined(FDSDUMP_HASH_TABLE_SCALAR)
+#include <arm_neon.h>
+#define HASH_TABLE_NEON 1
+#endif
+
 namespace fdsdump {
 namespace aggregator {
 
 static constexpr double EXPAND_WHEN_THIS_FULL = 0.95;
 static constexpr unsigned int EXPAND_WITH_FACTOR_OF = 2;
 static constexpr uint8_t EMPTY_BIT = 0x80;
+static constexpr std::size_t HUGE_PAGE_SIZE = 2 * 1024 * 1024;
+
+#if defined(HASH_TABLE_NEON)
+/// Number of bits representing a tag in a match mask
+static constexpr unsigned int MATCH_BITS_PER_TAG = 4;
+#else
+/// Number of bits representing a tag in a match mask
+static constexpr unsigned int MATCH_BITS_PER_TAG = 1;
+#endif
+
+/**
+ * @brief Find the tags of a block equal to a value.
+ *
+ * Tag i is represented by bit (i * MATCH_BITS_PER_TAG) of the result, other bits are zero,
+ * therefore, matching tags can be iterated by clearing the lowest set bit.
+ * @param[in] tags   The tags of a block (16 bytes, aligned)
+ * @param[in] value  The value
+ * @return The match mask
+ */
+static inline uint64_t
+match_tags(const uint8_t *tags, uint8_t value)
+{
+#if defined(HASH_TABLE_SSE2)
+    __m128i block_tags = _mm_load_si128(reinterpret_cast<const __m128i *>(tags));
+    __m128i value_mask = _mm_set1_epi8(value);
+    return static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(block_tags, value_mask)));
+#elif defined(HASH_TABLE_NEON)
+    // NEON has no movemask, narrow the comparison result to a nibble per tag instead
+    uint8x16_t equal = vceqq_u8(vld1q_u8(tags), vdupq_n_u8(value));
+    uint8x8_t nibbles = vshrn_n_u16(vreinterpretq_u16_u8(equal), 4);
+    return vget_lane_u64(vreinterpret_u64_u8(nibbles), 0) & UINT64_C(0x1111111111111111);
+#else
+    // Compare 8 tags at once, a byte of the difference is zero if the tag matches
+    const uint64_t low_bits = UINT64_C(0x7F7F7F7F7F7F7F7F);
+    uint64_t mask = 0;
+
+    for (unsigned int i = 0; i < 2; i++) {
+        uint64_t word;
+        memcpy(&word, tags + 8 * i, sizeof(word));
+        word ^= UINT64_C(0x0101010101010101) * value;
+
+        // The highest bit of each zero byte is set, other bits are cleared
+        uint64_t zero = ~(((word & low_bits) + low_bits) | word | low_bits);
+        // Gather the highest bits of the bytes (in memory order) into 8 bits
+        zero = (le64toh(zero) >> 7) * UINT64_C(0x0102040810204080) >> 56;
+        mask |= zero << (8 * i);
+    }
+
+    return mask;
+#endif
+}
+
+/**
+ * @brief Get index of the first tag of a match mask.
+ * @param[in] mask  The match mask (non-zero)
+ */
+static inline unsigned int
+first_match(uint64_t mask)
+{
+    return __builtin_ctzll(mask) / MATCH_BITS_PER_TAG;
+}
+
+/**
+ * @brief Advise the kernel to back memory by transparent huge pages.
+ *
+ * Lookups access blocks randomly, so fewer TLB misses are caused by a large table.
+ * Only the huge pages that are whole within the memory are affected.
+ * @param[in] addr  Start of the memory
+ * @param[in] size  Size of the memory
+ */
+static void
+advise_huge_pages(void *addr, std::size_t size)
+{
+#ifdef MADV_HUGEPAGE
+    uintptr_t begin = reinterpret_cast<uintptr_t>(addr);
+    uintptr_t end = begin + size;
+
+    begin = (begin + HUGE_PAGE_SIZE - 1) & ~(HUGE_PAGE_SIZE - 1);
+    end &= ~(HUGE_PAGE_SIZE - 1);
+
+    if (begin < end) {
+        // Just a hint, failure is not an error
+        madvise(reinterpret_cast<void *>(begin), end - begin, MADV_HUGEPAGE);
+    }
+#else
+    (void) addr;
+    (void) size;
+#endif
+}
 
-HashTable::HashTable(std::size_t key_size, std::size_t value_size) :
+HashTable::HashTable(std::size_t key_size, std::size_t value_size, std::size_t expected_items) :
     m_key_size(key_size), m_value_size(value_size)
 {
+    // Smallest power of two number of blocks that stays below the expansion threshold
+    while (double(expected_items) / (16 * double(m_block_count)) >= EXPAND_WHEN_THIS_FULL) {
+        m_block_count *= 2;
+    }
+
     init_blocks();
 }
 
@@ -34,50 +139,51 @@ HashTable::init_blocks()
         zeroed_block.tags[i] |= EMPTY_BIT; // Indicate that the spot is empty
     }
 
-    m_blocks.resize(m_block_count);
-    for (auto &block : m_blocks) {
-        block = zeroed_block;
+    if (!m_blocks || m_blocks_allocated != m_block_count) {
+        // Old blocks are not needed anymore, release them before the new ones are allocated.
+        // The new memory is left untouched until the kernel is advised about it.
+        m_blocks.reset();
+        m_blocks.reset(new HashTableBlock[m_block_count]);
+        m_blocks_allocated = m_block_count;
+        advise_huge_pages(m_blocks.get(), m_block_count * sizeof(HashTableBlock));
+    }
+
+    for (std::size_t i = 0; i < m_block_count; i++) {
+        m_blocks[i] = zeroed_block;
     }
 }
 
 bool
-HashTable::lookup(uint8_t *key, uint8_t *&item, bool create_if_not_found)
+HashTable::lookup(uint8_t *key, uint64_t hash, uint8_t *&item, bool create_if_not_found)
 {
-    uint64_t hash = XXH3_64bits(key, m_key_size); // The hash of the key
     uint64_t index = (hash >> 7) & (m_block_count - 1); // The starting block index
+    uint64_t probe = 1; // Number of visited blocks
 
     for (;;) {
         HashTableBlock &block = m_blocks[index];
 
         uint8_t item_tag = (hash & 0xFF) & ~EMPTY_BIT; // Get item tag from part of the hash with the empty bit cleared
-        auto block_tags = _mm_load_si128(reinterpret_cast<__m128i *>(block.tags)); // Load the current block metadata (16B)
-        auto hash_mask = _mm_set1_epi8(item_tag); // Repeat the item tag 16 times
-        auto empty_mask = _mm_set1_epi8(EMPTY_BIT); // Repeat the empty tag 16 times
 
-        auto hash_match = _mm_movemask_epi8(_mm_cmpeq_epi8(block_tags, hash_mask)); // Check if any of the metadata matched our item tag
-        auto empty_match = _mm_movemask_epi8(_mm_cmpeq_epi8(block_tags, empty_mask)); // Check if any of the metadata matched an empty spot
-
-        int item_index = 0;
+        uint64_t hash_match = match_tags(block.tags, item_tag); // Check if any of the metadata matched our item tag
+        uint64_t empty_match = match_tags(block.tags, EMPTY_BIT); // Check if any of the metadata matched an empty spot
 
         while (hash_match) { // While there are any set bits indicating that the tag of the item we're looking for matched
-            auto one_index = __builtin_ctz(hash_match); // Get index of the set bit, i.e. the index of the item in the block
-            item_index += one_index;
-
-            uint8_t *record = block.items[item_index]; // The record whose item tag matched
+            uint8_t *record = block.items[first_match(hash_match)]; // The record whose item tag matched
             if (memcmp(record, key, m_key_size) == 0) { // Does the key match as well or was it just a hash collision?
                 item = record;
+                count_lookup(probe);
                 return true; // We found the item
             }
 
             // Move on to the next set bit
-            hash_match >>= one_index + 1;
-            item_index += 1;
+            hash_match &= hash_match - 1;
         }
 
         // If we got here we didn't match, but we found an empty spot in the block which
         // indicates that we're done with the search. The item cannot be in the next block
         // if the current block contains an empty spot
         if (empty_match) {
+            count_lookup(probe);
 
             if (!create_if_not_found) {
                 // If we're just looking for the item and we haven't found it, we're done
@@ -85,10 +191,17 @@ HashTable::lookup(uint8_t *key, uint8_t *&item, bool create_if_not_found)
             }
 
             // Create a new record
-            auto empty_index = __builtin_ctz(empty_match);
+            auto empty_index = first_match(empty_match);
             block.tags[empty_index] = item_tag;
 
-            uint8_t *record = m_allocator.allocate(m_key_size + m_value_size);
+            uint8_t *record;
+            if (!m_free.empty()) {
+                // Reuse memory of a dropped record
+                record = m_free.back();
+                m_free.pop_back();
+            } else {
+                record = m_allocator.allocate(m_key_size + m_value_size);
+            }
             block.items[empty_index] = record;
             m_items.push_back(record);
             m_record_count++;
@@ -105,12 +218,15 @@ HashTable::lookup(uint8_t *key, uint8_t *&item, bool create_if_not_found)
         }
 
         index = (index + 1) & (m_block_count - 1); // Move on to the next block
+        probe++;
     }
 }
 
 void
 HashTable::expand()
 {
+    m_expansions++;
+
     // Grow the amount of blocks by a specified factor
     m_block_count *= EXPAND_WITH_FACTOR_OF;
 
@@ -119,40 +235,95 @@ HashTable::expand()
 
     // Reassign all the items to the newly initialized blocks
     for (uint8_t *item : m_items) {
-        uint64_t hash = XXH3_64bits(item, m_key_size);
-        uint64_t index = (hash >> 7) & (m_block_count - 1);
-        uint8_t item_tag = (hash & 0xFF) & ~EMPTY_BIT;
-
-        // Find a spot for the item and insert it
-        for (;;) {
-            HashTableBlock &block = m_blocks[index];
-
-            auto block_tags = _mm_load_si128(reinterpret_cast<__m128i *>(block.tags));
-            auto empty_mask = _mm_set1_epi8(EMPTY_BIT);
-            auto empty_match = _mm_movemask_epi8(_mm_cmpeq_epi8(block_tags, empty_mask));
-            if (empty_match) { // Does this black have an empty spot for our item?
-                auto empty_index = __builtin_ctz(empty_match);
-                block.tags[empty_index] = item_tag;
-                block.items[empty_index] = item;
-                break;
-            }
+        place(item);
+    }
+}
+
+void
+HashTable::retain(std::size_t count)
+{
+    if (count >= m_items.size()) {
+        return;
+    }
+
+    m_free.insert(m_free.end(), m_items.begin() + count, m_items.end());
+    m_items.resize(count);
+    m_record_count = count;
+
+    // Rebuild the blocks from the remaining items
+    init_blocks();
+
+    for (uint8_t *item : m_items) {
+        place(item);
+    }
+}
+
+void
+HashTable::place(uint8_t *item)
+{
+    uint64_t hash = XXH3_64bits(item, m_key_size);
+    uint64_t index = (hash >> 7) & (m_block_count - 1);
+    uint8_t item_tag = (hash & 0xFF) & ~EMPTY_BIT;
+
+    // Find a spot for the item and insert it
+    for (;;) {
+        HashTableBlock &block = m_blocks[index];
 
-            index = (index + 1) & (m_block_count - 1);
+        uint64_t empty_match = match_tags(block.tags, EMPTY_BIT);
+        if (empty_match) { // Does this black have an empty spot for our item?
+            auto empty_index = first_match(empty_match);
+            block.tags[empty_index] = item_tag;
+            block.items[empty_index] = item;
+            break;
         }
 
+        index = (index + 1) & (m_block_count - 1);
     }
 }
 
+std::size_t
+HashTable::memory_usage() const
+{
+    return m_record_count * (m_key_size + m_value_size + sizeof(uint8_t *))
+        + m_blocks_allocated * sizeof(HashTableBlock);
+}
+
+ProfileTableStats
+HashTable::get_stats() const
+{
+    ProfileTableStats stats;
+
+    stats.records = m_record_count;
+    stats.slots = 16 * m_block_count;
+    stats.lookups = m_lookups;
+    stats.probes = m_probes;
+    stats.max_probe = m_max_probe;
+    stats.expansions = m_expansions;
+    return stats;
+}
+
+uint64_t
+HashTable::hash(const uint8_t *key) const
+{
+    return XXH3_64bits(key, m_key_size);
+}
+
 bool
 HashTable::find(uint8_t *key, uint8_t *&item)
 {
-    return lookup(key, item, false);
+    return lookup(key, hash(key), item, false);
 }
 
 bool
 HashTable::find_or_create(uint8_t *key, uint8_t *&item)
 {
-    return lookup(key, item, true);
+    return lookup(key, hash(key), item, true);
+}
+
+bool
+HashTable::find_or_create(uint8_t *key, uint64_t hash, uint8_t *&item)
+{
+    return lookup(key, hash, item, true);
 }
 
 } // aggregator
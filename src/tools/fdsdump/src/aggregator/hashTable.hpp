@@ -6,8 +6,11 @@
 #pragma once
 
 #include <cstdint>
+#include <memory>
 #include <vector>
 
+#include "common/profiler.hpp"
+
 #include "arenaAllocator.hpp"
 
 namespace fdsdump {
@@ -30,10 +33,12 @@ class HashTable {
 public:
     /**
      * @brief Constructs a new instance.
-     * @param[in]  key_size    Number of bytes of the key portion of the record
-     * @param[in]  value_size  Number of bytes of the value portion of the record
+     * @param[in]  key_size        Number of bytes of the key portion of the record
+     * @param[in]  value_size      Number of bytes of the value portion of the record
+     * @param[in]  expected_items  Expected number of records (0 = unknown). The table is
+     *   sized up front so that it doesn't have to be expanded until this number is reached.
      */
-    HashTable(std::size_t key_size, std::size_t value_size);
+    HashTable(std::size_t key_size, std::size_t value_size, std::size_t expected_items = 0);
 
     /**
      * @brief Find a record corresponding to the provided key
@@ -55,6 +60,33 @@ public:
     bool
     find_or_create(uint8_t *key, uint8_t *&item);
 
+    /**
+     * @brief Same as find_or_create(uint8_t *, uint8_t *&) with the hash of
+     *   the key computed by hash() beforehand.
+     */
+    bool
+    find_or_create(uint8_t *key, uint64_t hash, uint8_t *&item);
+
+    /**
+     * @brief Compute the hash of a key.
+     * @param key  The key
+     */
+    uint64_t
+    hash(const uint8_t *key) const;
+
+    /**
+     * @brief Prefetch the first block of a lookup of a key into the cache.
+     *
+     * Lookups of multiple keys can overlap their cache misses if the blocks of
+     * all the keys are prefetched first.
+     * @param hash  The hash of the key (see hash())
+     */
+    void
+    prefetch(uint64_t hash) const
+    {
+        __builtin_prefetch(&m_blocks[(hash >> 7) & (m_block_count - 1)]);
+    }
+
     /**
      * @brief Access the stored records.
      * @warning
@@ -64,25 +96,70 @@ public:
      */
     std::vector<uint8_t *> &items() { return m_items; }
 
+    /**
+     * @brief Keep only the first records of items() and drop the rest.
+     *
+     * The caller is expected to reorder items() first so the records to keep are at its
+     * beginning. Memory of the dropped records is reused by the following insertions, therefore,
+     * pointers to them must not be used anymore.
+     * @param[in] count  Number of records to keep
+     */
+    void
+    retain(std::size_t count);
+
+    /**
+     * @brief Get the approximate number of bytes held by the stored records and the blocks.
+     *
+     * Memory of dropped records that waits for reuse is not included.
+     */
+    std::size_t
+    memory_usage() const;
+
+    /**
+     * @brief Get statistics of the table (load, probe lengths, expansions).
+     */
+    ProfileTableStats
+    get_stats() const;
+
 private:
     std::size_t m_block_count = 4096;
+    std::size_t m_blocks_allocated = 0;
     std::size_t m_record_count = 0;
     std::size_t m_key_size;
     std::size_t m_value_size;
 
-    std::vector<HashTableBlock> m_blocks;
+    std::uint64_t m_lookups = 0;
+    std::uint64_t m_probes = 0;
+    std::uint64_t m_max_probe = 0;
+    std::uint64_t m_expansions = 0;
+
+    std::unique_ptr<HashTableBlock[]> m_blocks;
     std::vector<uint8_t *> m_items;
+    std::vector<uint8_t *> m_free;
 
     ArenaAllocator m_allocator;
 
     bool
-    lookup(uint8_t *key, uint8_t *&item, bool create_if_not_found);
+    lookup(uint8_t *key, uint64_t hash, uint8_t *&item, bool create_if_not_found);
+
+    void
+    count_lookup(std::uint64_t probe)
+    {
+        m_lookups++;
+        m_probes += probe;
+        if (probe > m_max_probe) {
+            m_max_probe = probe;
+        }
+    }
 
     void
     init_blocks();
 
     void
     expand();
+
+    void
+    place(uint8_t *item);
 };
 
 } // aggregator
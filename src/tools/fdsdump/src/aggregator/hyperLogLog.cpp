@@ -0,0 +1,111 @@
+/**
+ * @file
+ * @brief HyperLogLog sketches of distinct count aggregates
+ */
+#define XXH_INLINE_ALL
+
+#include "hyperLogLog.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#include "3rd_party/xxhash/xxhash.h"
+
+namespace fdsdump {
+namespace aggregator {
+
+static inline HyperLogLog *
+header(uint8_t *sketch)
+{
+    return reinterpret_cast<HyperLogLog *>(sketch);
+}
+
+static inline uint8_t *
+registers(uint8_t *sketch)
+{
+    return sketch + sizeof(HyperLogLog);
+}
+
+/**
+ * @brief Update the estimate of a sketch from its harmonic sum and zero registers
+ */
+static void
+update_estimate(HyperLogLog *hll, unsigned int precision)
+{
+    const double m = double(uint64_t(1) << precision);
+    double alpha;
+
+    switch (precision) {
+    case 4: alpha = 0.673; break;
+    case 5: alpha = 0.697; break;
+    case 6: alpha = 0.709; break;
+    default: alpha = 0.7213 / (1.0 + 1.079 / m); break;
+    }
+
+    double estimate = alpha * m * m / hll->inv_sum;
+    if (estimate <= 2.5 * m && hll->zeros != 0) {
+        // Linear counting is more precise for small cardinalities
+        estimate = m * std::log(m / double(hll->zeros));
+    }
+
+    hll->estimate = uint64_t(std::llround(estimate));
+}
+
+void
+hll_init(uint8_t *sketch, unsigned int precision)
+{
+    const uint32_t m = uint32_t(1) << precision;
+    HyperLogLog *hll = header(sketch);
+
+    hll->estimate = 0;
+    hll->inv_sum = double(m);
+    hll->zeros = m;
+    hll->reserved = 0;
+    memset(registers(sketch), 0, m);
+}
+
+void
+hll_add(uint8_t *sketch, unsigned int precision, const uint8_t *data, size_t size)
+{
+    const uint64_t hash = XXH3_64bits(data, size);
+    const uint64_t index = hash >> (64 - precision);
+    const uint64_t rest = hash << precision;
+    const uint8_t rank = rest ? uint8_t(__builtin_clzll(rest) + 1) : uint8_t(64 - precision + 1);
+
+    uint8_t &reg = registers(sketch)[index];
+    if (rank <= reg) {
+        return;
+    }
+
+    HyperLogLog *hll = header(sketch);
+    hll->inv_sum += std::ldexp(1.0, -int(rank)) - std::ldexp(1.0, -int(reg));
+    if (reg == 0) {
+        hll->zeros--;
+    }
+    reg = rank;
+    update_estimate(hll, precision);
+}
+
+void
+hll_merge(uint8_t *sketch, const uint8_t *other, unsigned int precision)
+{
+    const uint32_t m = uint32_t(1) << precision;
+    uint8_t *regs = registers(sketch);
+    const uint8_t *other_regs = other + sizeof(HyperLogLog);
+    HyperLogLog *hll = header(sketch);
+
+    // The sum is recomputed to get rid of rounding errors accumulated by hll_add()
+    hll->inv_sum = 0.0;
+    hll->zeros = 0;
+    for (uint32_t i = 0; i < m; i++) {
+        regs[i] = std::max(regs[i], other_regs[i]);
+        hll->inv_sum += std::ldexp(1.0, -int(regs[i]));
+        hll->zeros += (regs[i] == 0);
+    }
+
+    update_estimate(hll, precision);
+}
+
+} // aggregator
+} // fdsdump
@@ -0,0 +1,81 @@
+/**
+ * @file
+ * @brief HyperLogLog sketches of distinct count aggregates
+ */
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace fdsdump {
+namespace aggregator {
+
+/** Minimal precision of a sketch (16 registers) */
+static constexpr unsigned int HLL_PRECISION_MIN = 4;
+/** Maximal precision of a sketch (256 KiB of registers) */
+static constexpr unsigned int HLL_PRECISION_MAX = 18;
+/** Default precision of a sketch (1 KiB of registers, standard error ~3.3%) */
+static constexpr unsigned int HLL_PRECISION_DEF = 10;
+
+/**
+ * @brief Header of a HyperLogLog sketch, followed by 2^precision 8-bit registers.
+ *
+ * Sketches are stored in place of aggregated values, i.e. they have a fixed
+ * size given by the precision. The estimate is the first member, so the
+ * aggregated value can be printed and sorted as an ordinary unsigned 64-bit
+ * value (ViewValue::u64). It's kept up to date whenever a register changes,
+ * which happens rarely compared to the number of added values.
+ *
+ * Values are hashed by 64-bit XXH3, therefore, no large range correction is
+ * needed. Small cardinalities are estimated by linear counting.
+ */
+struct HyperLogLog {
+    /** Estimated number of distinct values */
+    uint64_t estimate;
+    /** Sum of 2^-register over all registers */
+    double inv_sum;
+    /** Number of zero registers */
+    uint32_t zeros;
+    /** Reserved (alignment of registers) */
+    uint32_t reserved;
+};
+
+/**
+ * @brief Get the size of a sketch (including the header)
+ * @param precision  The precision (number of index bits)
+ */
+static inline size_t
+hll_size(unsigned int precision)
+{
+    return sizeof(HyperLogLog) + (size_t(1) << precision);
+}
+
+/**
+ * @brief Initialize an empty sketch
+ * @param sketch     The sketch (hll_size() bytes)
+ * @param precision  The precision
+ */
+void
+hll_init(uint8_t *sketch, unsigned int precision);
+
+/**
+ * @brief Add a value to a sketch
+ * @param sketch     The sketch
+ * @param precision  The precision
+ * @param data       The value
+ * @param size       Size of the value
+ */
+void
+hll_add(uint8_t *sketch, unsigned int precision, const uint8_t *data, size_t size);
+
+/**
+ * @brief Merge other sketch of the same precision into a sketch
+ * @param sketch     The sketch
+ * @param other      The other sketch
+ * @param precision  The precision
+ */
+void
+hll_merge(uint8_t *sketch, const uint8_t *other, unsigned int precision);
+
+} // aggregator
+} // fdsdump
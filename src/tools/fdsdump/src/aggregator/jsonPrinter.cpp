@@ -6,8 +6,8 @@
 namespace fdsdump {
 namespace aggregator {
 
-JSONPrinter::JSONPrinter(ViewDefinition view_def)
-    : m_view_def(view_def)
+JSONPrinter::JSONPrinter(ViewDefinition view_def, std::ostream &out)
+    : m_view_def(view_def), m_out(out)
 {
     m_buffer.reserve(1024);
 }
@@ -19,7 +19,7 @@ JSONPrinter::~JSONPrinter()
 void
 JSONPrinter::print_prologue()
 {
-    std::cout << "[";
+    m_out << "[";
 }
 
 void
@@ -50,14 +50,14 @@ JSONPrinter::print_record(uint8_t *record)
     }
 
     m_buffer.push_back('}');
-    std::cout << ((m_rec_printed++ > 0) ? ",\n " : "\n ");
-    std::cout << m_buffer;
+    m_out << ((m_rec_printed++ > 0) ? ",\n " : "\n ");
+    m_out << m_buffer;
 }
 
 void
 JSONPrinter::print_epilogue()
 {
-    std::cout << "\n]\n";
+    m_out << "\n]\n";
 }
 
 void
@@ -97,12 +97,12 @@ JSONPrinter::append_value(const ViewField &field, ViewValue *value)
         return;
     case DataType::String128B:
         m_buffer.push_back('"');
-        append_string_value(value);
+        append_string_value(&decode_value(field, *value));
         m_buffer.push_back('"');
         return;
     case DataType::Octets128B:
         m_buffer.push_back('"');
-        append_octet_value(value);
+        append_octet_value(&decode_value(field, *value));
         m_buffer.push_back('"');
         return;
     case DataType::Unassigned:
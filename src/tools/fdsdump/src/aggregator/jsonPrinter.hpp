@@ -1,5 +1,6 @@
 #pragma once
 
+#include <iostream>
 #include <string>
 
 #include "printer.hpp"
@@ -10,7 +11,12 @@ namespace aggregator {
 class JSONPrinter : public Printer
 {
 public:
-    JSONPrinter(ViewDefinition view_def);
+    /**
+     * @brief Create a printer.
+     * @param view_def  The view definition
+     * @param out       The output stream
+     */
+    JSONPrinter(ViewDefinition view_def, std::ostream &out = std::cout);
 
     ~JSONPrinter() override;
 
@@ -30,6 +36,7 @@ private:
     void append_octet_value(const ViewValue *value);
 
     ViewDefinition m_view_def;
+    std::ostream &m_out;
     std::string m_buffer;
     size_t m_rec_printed = 0;
 };
@@ -0,0 +1,69 @@
+/**
+ * @file
+ * @brief Dictionary of string and octet array aggregation keys
+ */
+#define XXH_INLINE_ALL
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <stdexcept>
+
+#include "3rd_party/xxhash/xxhash.h"
+
+#include "keyDictionary.hpp"
+
+namespace fdsdump {
+namespace aggregator {
+
+uint32_t
+KeyDictionary::encode(const uint8_t *data, size_t size)
+{
+    ViewValue value;
+
+    // Trailing zeros are not distinguished from the padding
+    size = std::min<size_t>(size, sizeof(value.str));
+    while (size > 0 && data[size - 1] == 0) {
+        size--;
+    }
+
+    memset(value.str, 0, sizeof(value.str));
+    memcpy(value.str, data, size);
+
+    const uint64_t hash = XXH3_64bits(data, size);
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    auto range = m_codes.equal_range(hash);
+    for (auto it = range.first; it != range.second; it++) {
+        if (memcmp(m_values[it->second].str, value.str, sizeof(value.str)) == 0) {
+            return it->second;
+        }
+    }
+
+    if (m_values.size() > UINT32_MAX) {
+        throw std::runtime_error("Too many distinct values of string keys");
+    }
+
+    const uint32_t code = m_values.size();
+    m_values.push_back(value);
+    m_codes.emplace(hash, code);
+    return code;
+}
+
+const ViewValue &
+KeyDictionary::decode(uint32_t code) const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    assert(code < m_values.size());
+    return m_values[code];
+}
+
+size_t
+KeyDictionary::size() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_values.size();
+}
+
+} // aggregator
+} // fdsdump
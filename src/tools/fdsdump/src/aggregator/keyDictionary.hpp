@@ -0,0 +1,63 @@
+/**
+ * @file
+ * @brief Dictionary of string and octet array aggregation keys
+ */
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <unordered_map>
+
+#include "view.hpp"
+
+namespace fdsdump {
+namespace aggregator {
+
+/**
+ * @brief Dictionary mapping string and octet array keys to 32-bit codes.
+ *
+ * String and octet array keys are held as 128-byte values. Instead, the hash
+ * table holds just the code of the value and the value itself is stored once
+ * in the dictionary. Values are stored zero-padded to 128 bytes (i.e. as
+ * ViewValue::str), so they are compared and printed as before.
+ *
+ * The dictionary is shared by all aggregators of a view (codes must be the
+ * same in all of them to merge their records), therefore, it's thread-safe.
+ */
+class KeyDictionary {
+public:
+    /**
+     * @brief Get the code of a value, add the value if not present.
+     * @param[in] data  The value (truncated to 128 bytes)
+     * @param[in] size  Size of the value
+     * @return The code.
+     */
+    uint32_t
+    encode(const uint8_t *data, size_t size);
+
+    /**
+     * @brief Get a value by its code.
+     * @param[in] code  The code returned by encode()
+     * @return The value (zero-padded to 128 bytes).
+     */
+    const ViewValue &
+    decode(uint32_t code) const;
+
+    /**
+     * @brief Get the number of values in the dictionary.
+     */
+    size_t
+    size() const;
+
+private:
+    /** Values, the index is the code */
+    std::deque<ViewValue> m_values;
+    /** Codes by hashes of values */
+    std::unordered_multimap<uint64_t, uint32_t> m_codes;
+    mutable std::mutex m_mutex;
+};
+
+} // aggregator
+} // fdsdump
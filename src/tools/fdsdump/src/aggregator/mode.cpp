@@ -1,7 +1,30 @@
 
+#define XXH_INLINE_ALL
+
+#include <algorithm>
+#include <chrono>
+#include <cinttypes>
+#include <climits>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <exception>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <utility>
 #include <vector>
 
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "3rd_party/xxhash/xxhash.h"
 #include "common/flowProvider.hpp"
+#include "common/profiler.hpp"
 
 #include "aggregator.hpp"
 #include "mode.hpp"
@@ -12,32 +35,56 @@
 namespace fdsdump {
 namespace aggregator {
 
-void
-mode_aggregate(const shared_iemgr &iemgr, const Options &opts)
+/**
+ * @brief Create an aggregator configured according to the command line options.
+ * @param[in] opts         Command line options
+ * @param[in] view_def     View definition
+ * @param[in] sort_fields  Sort definition (the first field is the counter of approximate mode)
+ * @return The aggregator
+ */
+static std::unique_ptr<Aggregator>
+make_aggregator(
+    const Options &opts,
+    const ViewDefinition &view_def,
+    const std::vector<SortField> &sort_fields)
 {
-    ViewDefinition view_def = make_view_def(
-            opts.get_aggregation_keys(),
-            opts.get_aggregation_values(),
-            iemgr.get());
-    std::vector<SortField> sort_fields = make_sort_def(
-            view_def,
-            opts.get_order_by());
-    std::unique_ptr<Printer> printer = printer_factory(
-            view_def,
-            opts.get_output_specifier());
-    FlowProvider flows {iemgr};
-    Aggregator aggr(view_def);
+    std::unique_ptr<Aggregator> aggr(new Aggregator(view_def, opts.get_expected_keys()));
 
-    const size_t rec_limit = opts.get_output_limit();
-    size_t rec_printed = 0;
+    if (opts.get_approx_keys() != 0) {
+        aggr->set_capacity(opts.get_approx_keys(), *sort_fields[0].field);
+    }
+
+    if (opts.get_memory_limit() != 0) {
+        aggr->set_memory_limit(opts.get_memory_limit(), opts.get_spill_dir());
+    }
+
+    return aggr;
+}
+
+/**
+ * @brief Read records of files and aggregate them.
+ * @param[in] iemgr  Information Element manager (a private copy of the worker)
+ * @param[in] opts   Command line options
+ * @param[in] files  Files to read
+ * @param[in] aggr   The aggregator
+ */
+static void
+read_files(
+    const shared_iemgr &iemgr,
+    const Options &opts,
+    const std::vector<std::string> &files,
+    Aggregator &aggr)
+{
+    FlowProvider flows {iemgr};
 
     flows.set_biflow_autoignore(opts.get_biflow_autoignore());
+    flows.set_prefetch(opts.get_prefetch());
 
     if (!opts.get_input_filter().empty()) {
         flows.set_filter(opts.get_input_filter());
     }
 
-    for (const auto &it : opts.get_input_files()) {
+    for (const auto &it : files) {
         flows.add_file(it);
     }
 
@@ -50,8 +97,272 @@ mode_aggregate(const shared_iemgr &iemgr, const Options &opts)
 
         aggr.process_record(*flow);
     }
+}
+
+/**
+ * @brief Get a description of the aggregation that partial results must share.
+ * @param[in] opts Command line options
+ */
+static std::string
+partial_signature(const Options &opts)
+{
+    return opts.get_aggregation_keys() + "\n" + opts.get_aggregation_values()
+        + (opts.get_ipv4_only() ? "\nipv4-only" : "");
+}
+
+/**
+ * @brief Get a description of the partial result of a file in the result cache.
+ *
+ * Besides the aggregation, the description covers everything the result depends
+ * on, i.e. the file (identified by its path, modification time and size) and
+ * options affecting which records are aggregated.
+ * @param[in] opts Command line options
+ * @param[in] file Path of the file
+ * @return The description or an empty string if the file cannot be examined
+ */
+static std::string
+cache_signature(const Options &opts, const std::string &file)
+{
+    struct stat info;
+    char real_path[PATH_MAX];
+
+    if (stat(file.c_str(), &info) != 0 || realpath(file.c_str(), real_path) == nullptr) {
+        return "";
+    }
+
+    return partial_signature(opts)
+        + "\n" + opts.get_input_filter()
+        + "\n" + std::to_string(opts.get_approx_keys())
+        + (opts.get_approx_keys() != 0 ? "/" + opts.get_order_by() : "")
+        + "\n" + (opts.get_biflow_autoignore() ? "1" : "0")
+        + "\n" + real_path
+        + "\n" + std::to_string(info.st_mtim.tv_sec) + "." + std::to_string(info.st_mtim.tv_nsec)
+        + "\n" + std::to_string(info.st_size);
+}
+
+/**
+ * @brief Get path of the partial result of a file in the result cache.
+ * @param[in] opts      Command line options
+ * @param[in] signature Description of the partial result (see cache_signature())
+ */
+static std::string
+cache_path(const Options &opts, const std::string &signature)
+{
+    char name[32];
+
+    snprintf(name, sizeof(name), "%016" PRIx64 ".part",
+        static_cast<uint64_t>(XXH3_64bits(signature.data(), signature.size())));
+    return opts.get_cache_dir() + "/" + name;
+}
+
+/**
+ * @brief Aggregate records of files processed by one worker.
+ *
+ * If the result cache is enabled, partial results of files found in the cache
+ * are merged instead of reading the files. Other files are aggregated one by
+ * one and their partial results are stored to the cache.
+ * @param[in] iemgr        Information Element manager (a private copy of the worker)
+ * @param[in] opts         Command line options
+ * @param[in] view_def     View definition
+ * @param[in] sort_fields  Sort definition
+ * @param[in] files        Files of the worker
+ * @param[in] aggr         Aggregator of the worker
+ */
+static void
+aggregate_files(
+    const shared_iemgr &iemgr,
+    const Options &opts,
+    const ViewDefinition &view_def,
+    const std::vector<SortField> &sort_fields,
+    const std::vector<std::string> &files,
+    Aggregator &aggr)
+{
+    if (opts.get_cache_dir().empty()) {
+        read_files(iemgr, opts, files, aggr);
+        return;
+    }
+
+    for (const auto &file : files) {
+        const std::string signature = cache_signature(opts, file);
+
+        if (signature.empty()) {
+            read_files(iemgr, opts, {file}, aggr);
+            continue;
+        }
+
+        const std::string path = cache_path(opts, signature);
+        std::ifstream in(path, std::ios::binary);
+
+        if (in) {
+            try {
+                aggr.load(in, signature);
+                continue;
+            } catch (const std::runtime_error &) {
+                // Malformed or colliding entry, replace it
+            }
+        }
+
+        std::unique_ptr<Aggregator> partial = make_aggregator(opts, view_def, sort_fields);
+        read_files(iemgr, opts, {file}, *partial);
+
+        // The entry is renamed when complete, so concurrent readers never see a part of it
+        const std::string tmp_path = path + "." + std::to_string(getpid()) + ".tmp";
+        std::ofstream out(tmp_path, std::ios::binary | std::ios::trunc);
+
+        try {
+            if (!out) {
+                throw std::runtime_error("Failed to create '" + tmp_path + "'");
+            }
+
+            partial->save(out, signature);
+            out.close();
+
+            if (std::rename(tmp_path.c_str(), path.c_str()) != 0) {
+                throw std::runtime_error("Failed to rename '" + tmp_path + "'");
+            }
+        } catch (const std::runtime_error &ex) {
+            // The cache is only an optimization
+            std::remove(tmp_path.c_str());
+            std::cerr << "Failed to store a cached result: " << ex.what() << std::endl;
+        }
+
+        aggr.merge(*partial);
+    }
+}
+
+/**
+ * @brief Aggregate records of all input files using multiple workers.
+ *
+ * Input files are split among workers in a round-robin fashion. Each worker reads its files
+ * by its own FlowProvider and aggregates them into its private aggregator. Finally, the
+ * aggregators are merged pairwise in parallel (i.e. in log2(N) rounds).
+ * @param[in] iemgr   Information Element manager
+ * @param[in] opts    Command line options
+ * @param[in] view_def View definition
+ * @param[in] sort_fields Sort definition
+ * @return Aggregator with all records
+ */
+static std::unique_ptr<Aggregator>
+aggregate_parallel(
+    const shared_iemgr &iemgr,
+    const Options &opts,
+    const ViewDefinition &view_def,
+    const std::vector<SortField> &sort_fields)
+{
+    const std::vector<std::string> files(
+        opts.get_input_files().begin(),
+        opts.get_input_files().end());
+    const size_t workers = std::max<size_t>(1, std::min<size_t>(opts.get_threads(), files.size()));
+
+    std::vector<std::vector<std::string>> partitions(workers);
+    for (size_t i = 0; i < files.size(); ++i) {
+        partitions[i % workers].push_back(files[i]);
+    }
+
+    std::vector<std::unique_ptr<Aggregator>> aggrs;
+    std::vector<shared_iemgr> iemgrs;
+    for (size_t i = 0; i < workers; ++i) {
+        // The manager is not thread-safe, therefore, each worker uses its own copy
+        shared_iemgr copy {fds_iemgr_copy(iemgr.get()), &fds_iemgr_destroy};
+        if (!copy) {
+            throw std::runtime_error("fds_iemgr_copy() has failed");
+        }
+
+        iemgrs.push_back(copy);
+        aggrs.push_back(make_aggregator(opts, view_def, sort_fields));
+    }
+
+    run_parallel(workers, [&](size_t i) {
+        aggregate_files(iemgrs[i], opts, view_def, sort_fields, partitions[i], *aggrs[i]);
+    });
+
+    for (size_t step = 1; step < workers; step *= 2) {
+        const size_t pairs = (workers - step + (2 * step - 1)) / (2 * step);
+
+        run_parallel(pairs, [&](size_t pair) {
+            const size_t dst = pair * 2 * step;
+            const size_t src = dst + step;
+            aggrs[dst]->merge(*aggrs[src]);
+            aggrs[src].reset();
+        });
+    }
+
+    return std::move(aggrs[0]);
+}
+
+/**
+ * @brief Merge partial results of other instances (e.g. on other nodes) into an aggregator.
+ * @param[in] opts Command line options
+ * @param[in] aggr The aggregator
+ */
+static void
+merge_partials(const Options &opts, Aggregator &aggr)
+{
+    for (const auto &path : opts.get_partial_inputs()) {
+        std::ifstream in(path, std::ios::binary);
+        if (!in) {
+            throw std::runtime_error("Failed to open partial result '" + path + "'");
+        }
+
+        try {
+            aggr.load(in, partial_signature(opts));
+        } catch (const std::runtime_error &ex) {
+            throw std::runtime_error("'" + path + "': " + ex.what());
+        }
+    }
+}
+
+/**
+ * @brief Write the aggregated records as a partial result instead of printing them.
+ * @param[in] opts Command line options
+ * @param[in] aggr The aggregator
+ */
+static void
+save_partial(const Options &opts, Aggregator &aggr)
+{
+    const std::string &path = opts.get_partial_output();
+
+    if (path == "-") {
+        aggr.save(std::cout, partial_signature(opts));
+        return;
+    }
 
-    sort_records(aggr.items(), sort_fields, view_def);
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out) {
+        throw std::runtime_error("Failed to create partial result '" + path + "'");
+    }
+
+    aggr.save(out, partial_signature(opts));
+}
+
+/**
+ * @brief Sort, limit and print the aggregated records.
+ * @param[in] opts         Command line options
+ * @param[in] view_def     View definition
+ * @param[in] sort_fields  Sort definition
+ * @param[in] aggr         The aggregator
+ */
+static void
+print_records(
+    const Options &opts,
+    const ViewDefinition &view_def,
+    const std::vector<SortField> &sort_fields,
+    Aggregator &aggr)
+{
+    std::unique_ptr<Printer> printer = printer_factory(
+            view_def,
+            opts.get_output_specifier());
+    const size_t rec_limit = opts.get_output_limit();
+    size_t rec_printed = 0;
+    ProfileCounters profile;
+    uint64_t start = profile_start();
+
+    // Records spilled to disk are aggregated again and only the printed ones are kept
+    aggr.finish([&](std::vector<uint8_t *> &items) {
+        sort_records(items, sort_fields, view_def, rec_limit);
+        return rec_limit != 0 ? std::min(rec_limit, items.size()) : items.size();
+    });
+    start = profile.stop(ProfileStage::sort, start, aggr.items().size());
 
     printer->print_prologue();
 
@@ -65,6 +376,194 @@ mode_aggregate(const shared_iemgr &iemgr, const Options &opts)
     }
 
     printer->print_epilogue();
+    profile.stop(ProfileStage::print, start, rec_printed);
+
+    if (opts.get_approx_keys() != 0) {
+        std::cerr << "Approximate results: values of \"" << sort_fields[0].field->name
+            << "\" are overestimated by at most " << aggr.get_error_bound() << std::endl;
+    }
+}
+
+/**
+ * @brief Aggregated records of one followed file (i.e. one closed time window).
+ */
+struct FollowWindow {
+    std::string path;
+    time_t closed;
+    std::unique_ptr<Aggregator> aggr;
+};
+
+/**
+ * @brief Find files matching the input patterns that have been closed.
+ * @param[in] opts Command line options
+ * @return Paths of the files
+ */
+static std::vector<std::string>
+find_closed_files(const Options &opts)
+{
+    static const std::string tmp_suffix = ".tmp";
+    std::vector<std::string> files;
+    FileList list;
+
+    for (const auto &pattern : opts.get_input_patterns()) {
+        list.add_files(pattern);
+    }
+
+    for (const auto &file : list) {
+        // Files are written with a temporary suffix and renamed when closed
+        if (file.size() >= tmp_suffix.size()
+                && file.compare(file.size() - tmp_suffix.size(), tmp_suffix.size(), tmp_suffix) == 0) {
+            continue;
+        }
+        files.push_back(file);
+    }
+
+    return files;
+}
+
+/**
+ * @brief Keep aggregates of the last periods of followed files up to date.
+ *
+ * Input patterns are periodically expanded again. Each newly closed file (i.e.
+ * a time window of the storage) is aggregated once and its aggregator is kept
+ * as long as the file was closed within the longest period. Whenever a window
+ * is added or retired, the windows of each period are merged and printed, so
+ * no file is ever read again. The function never returns.
+ * @param[in] iemgr        Information Element manager
+ * @param[in] opts         Command line options
+ * @param[in] view_def     View definition
+ * @param[in] sort_fields  Sort definition
+ */
+static void
+follow_files(
+    const shared_iemgr &iemgr,
+    const Options &opts,
+    const ViewDefinition &view_def,
+    const std::vector<SortField> &sort_fields)
+{
+    std::vector<std::pair<std::string, time_t>> periods;
+    time_t longest = 0;
+
+    for (auto period : string_split(opts.get_follow_periods(), ",")) {
+        string_trim(period);
+        const uint64_t msecs = parse_duration(period);
+        if (msecs < 1000) {
+            throw std::invalid_argument("Invalid follow period \"" + period + "\"");
+        }
+
+        periods.emplace_back(period, msecs / 1000);
+        longest = std::max<time_t>(longest, msecs / 1000);
+    }
+
+    std::vector<FollowWindow> windows;
+
+    while (true) {
+        const time_t now = time(nullptr);
+        bool changed = false;
+
+        // Retire expired windows
+        const size_t window_count = windows.size();
+        windows.erase(std::remove_if(windows.begin(), windows.end(),
+            [&](const FollowWindow &window) { return now - window.closed > longest; }),
+            windows.end());
+        changed |= windows.size() != window_count;
+
+        // Add new windows, files closed before the longest period are not read at all
+        for (const auto &file : find_closed_files(opts)) {
+            struct stat info;
+
+            if (stat(file.c_str(), &info) != 0 || now - info.st_mtime > longest) {
+                continue;
+            }
+
+            auto known = std::find_if(windows.begin(), windows.end(),
+                [&](const FollowWindow &window) { return window.path == file; });
+            if (known != windows.end()) {
+                continue;
+            }
+
+            FollowWindow window;
+            window.path = file;
+            window.closed = info.st_mtime;
+            window.aggr = make_aggregator(opts, view_def, sort_fields);
+            aggregate_files(iemgr, opts, view_def, sort_fields, {file}, *window.aggr);
+            windows.push_back(std::move(window));
+            changed = true;
+        }
+
+        if (changed) {
+            for (const auto &period : periods) {
+                std::unique_ptr<Aggregator> aggr = make_aggregator(opts, view_def, sort_fields);
+                size_t merged = 0;
+
+                for (const auto &window : windows) {
+                    if (now - window.closed <= period.second) {
+                        aggr->merge(*window.aggr);
+                        merged++;
+                    }
+                }
+
+                std::cout << "Last " << period.first << " (" << merged << " files):" << std::endl;
+                print_records(opts, view_def, sort_fields, *aggr);
+            }
+            std::cout.flush();
+        }
+
+        std::this_thread::sleep_for(std::chrono::seconds(1));
+    }
+}
+
+void
+mode_aggregate(const shared_iemgr &iemgr, const Options &opts)
+{
+    ViewDefinition view_def = make_view_def(
+            opts.get_aggregation_keys(),
+            opts.get_aggregation_values(),
+            iemgr.get(),
+            opts.get_ipv4_only());
+    std::vector<SortField> sort_fields = make_sort_def(
+            view_def,
+            opts.get_order_by());
+    std::unique_ptr<Aggregator> aggr_ptr;
+
+    if (opts.get_approx_keys() != 0) {
+        // The first sort field is the counter by which the keys are kept
+        const ViewField &field = *sort_fields[0].field;
+        if ((field.kind != ViewFieldKind::SumAggregate && field.kind != ViewFieldKind::CountAggregate)
+                || field.data_type != DataType::Unsigned64
+                || sort_fields[0].dir != SortDir::Descending) {
+            throw std::invalid_argument("Approximate aggregation requires the first order field "
+                "to be a descending unsigned sum or count");
+        }
+    }
+
+    if (!opts.get_follow_periods().empty()) {
+        follow_files(iemgr, opts, view_def, sort_fields);
+        return;
+    }
+
+    if (opts.get_threads() > 1 && opts.get_input_files().length() > 1) {
+        aggr_ptr = aggregate_parallel(iemgr, opts, view_def, sort_fields);
+    } else {
+        std::vector<std::string> files(
+            opts.get_input_files().begin(),
+            opts.get_input_files().end());
+
+        aggr_ptr = make_aggregator(opts, view_def, sort_fields);
+        aggregate_files(iemgr, opts, view_def, sort_fields, files, *aggr_ptr);
+    }
+
+    Aggregator &aggr = *aggr_ptr;
+
+    merge_partials(opts, aggr);
+
+    if (!opts.get_partial_output().empty()) {
+        // Sorted and limited by the instance that merges the partial results
+        save_partial(opts, aggr);
+        return;
+    }
+
+    print_records(opts, view_def, sort_fields, aggr);
 }
 
 } // aggregator
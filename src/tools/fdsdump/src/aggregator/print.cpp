@@ -239,10 +239,10 @@ print_value(const ViewField &field, ViewValue &value, std::string &buffer)
         buffer.append(mac_to_str(value.mac));
         break;
     case DataType::String128B:
-        buffer.append(string_to_str(value.str));
+        buffer.append(string_to_str(decode_value(field, value).str));
         break;
     case DataType::Octets128B:
-        buffer.append(octetarray_to_str(value.str));
+        buffer.append(octetarray_to_str(decode_value(field, value).str));
         break;
     case DataType::DateTime:
         buffer.append(datetime_to_str(value.ts_millisecs));
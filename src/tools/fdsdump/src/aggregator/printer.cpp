@@ -5,6 +5,9 @@
 #include <stdexcept>
 
 #include "printer.hpp"
+#ifdef FDSDUMP_ARROW
+#include "arrowPrinter.hpp"
+#endif
 #include "jsonPrinter.hpp"
 #include "tablePrinter.hpp"
 
@@ -17,6 +20,14 @@ struct PrinterFactory {
 };
 
 static const std::vector<struct PrinterFactory> g_printers {
+#ifdef FDSDUMP_ARROW
+    {"arrow", [](ViewDefinition view_def) {
+        return new ArrowPrinter(view_def, ColumnWriter::Format::arrow); }
+    },
+    {"parquet", [](ViewDefinition view_def) {
+        return new ArrowPrinter(view_def, ColumnWriter::Format::parquet); }
+    },
+#endif
     {"json", [](ViewDefinition view_def) {
         return new JSONPrinter(view_def); }
     },
@@ -46,6 +46,13 @@ make_sort_def(ViewDefinition &def, const std::string &sort_fields_str)
     std::vector<SortField> sort_fields;
 
     if (sort_fields_str.empty()) {
+        // Time series are emitted bin by bin
+        for (auto &field : def.key_fields) {
+            if (field.kind == ViewFieldKind::TimeBinKey) {
+                sort_fields.push_back({&field, SortDir::Ascending});
+                break;
+            }
+        }
         return sort_fields;
     }
 
@@ -211,18 +218,174 @@ make_comparer(
     return compare;
 }
 
+/**
+ * @brief A record with a precomputed key, records are ordered by ascending keys.
+ */
+struct SortKey {
+    uint64_t key;
+    uint8_t *record;
+};
+
+/** Minimal number of records for which radix sort is used instead of std::sort */
+static constexpr size_t RADIX_SORT_THRESHOLD = 4096;
+
+/**
+ * @brief Check whether records can be ordered by a precomputed integer key
+ * @param sort_fields  The sort definition
+ * @return true if there is a single field of an integer type
+ */
+static bool
+has_integer_key(const std::vector<SortField> &sort_fields)
+{
+    if (sort_fields.size() != 1) {
+        return false;
+    }
+
+    switch (sort_fields[0].field->data_type) {
+    case DataType::Unsigned8:
+    case DataType::Unsigned16:
+    case DataType::Unsigned32:
+    case DataType::Unsigned64:
+    case DataType::Signed8:
+    case DataType::Signed16:
+    case DataType::Signed32:
+    case DataType::Signed64:
+    case DataType::DateTime:
+        return true;
+    default:
+        return false;
+    }
+}
+
+/**
+ * @brief Make an integer key of a record
+ *
+ * Signed values are shifted to the unsigned range and the key is inverted for the descending
+ * order, so the records are always ordered by ascending keys.
+ * @param sort_field  The field to sort on (of an integer type)
+ * @param record      The record
+ * @return The key
+ */
+static uint64_t
+make_integer_key(const SortField &sort_field, uint8_t *record)
+{
+    const ViewValue &value = *(ViewValue *) (record + sort_field.field->offset);
+    const uint64_t sign = uint64_t(1) << 63;
+    uint64_t key;
+
+    switch (sort_field.field->data_type) {
+    case DataType::Unsigned8:  key = value.u8; break;
+    case DataType::Unsigned16: key = value.u16; break;
+    case DataType::Unsigned32: key = value.u32; break;
+    case DataType::Unsigned64: key = value.u64; break;
+    case DataType::DateTime:   key = value.ts_millisecs; break;
+    case DataType::Signed8:    key = uint64_t(int64_t(value.i8)) ^ sign; break;
+    case DataType::Signed16:   key = uint64_t(int64_t(value.i16)) ^ sign; break;
+    case DataType::Signed32:   key = uint64_t(int64_t(value.i32)) ^ sign; break;
+    case DataType::Signed64:   key = uint64_t(value.i64) ^ sign; break;
+    default: assert(0); key = 0;
+    }
+
+    return (sort_field.dir == SortDir::Descending) ? ~key : key;
+}
+
+/**
+ * @brief Sort records by their keys using LSD radix sort
+ *
+ * Passes over bytes that are the same for all the keys are skipped.
+ * @param[inout] items  The records with keys
+ */
+static void
+radix_sort(std::vector<SortKey> &items)
+{
+    std::vector<SortKey> buffer(items.size());
+
+    for (unsigned int shift = 0; shift < 64; shift += 8) {
+        size_t offsets[256] = {};
+
+        for (const auto &item : items) {
+            offsets[(item.key >> shift) & 0xFF]++;
+        }
+
+        if (offsets[(items[0].key >> shift) & 0xFF] == items.size()) {
+            continue;
+        }
+
+        size_t sum = 0;
+        for (size_t &offset : offsets) {
+            size_t count = offset;
+            offset = sum;
+            sum += count;
+        }
+
+        for (const auto &item : items) {
+            buffer[offsets[(item.key >> shift) & 0xFF]++] = item;
+        }
+
+        items.swap(buffer);
+    }
+}
+
+/**
+ * @brief Sort records of a single integer field by precomputed keys
+ * @param[inout] records     The view records
+ * @param[in]    sort_field  The field to sort on
+ * @param[in]    limit       Number of records to sort
+ */
+static void
+sort_by_integer_key(std::vector<uint8_t *> &records, const SortField &sort_field, size_t limit)
+{
+    std::vector<SortKey> items;
+    auto compare = [](const SortKey &a, const SortKey &b) { return a.key < b.key; };
+
+    items.reserve(records.size());
+    for (uint8_t *record : records) {
+        items.push_back({make_integer_key(sort_field, record), record});
+    }
+
+    if (limit < items.size()) {
+        std::nth_element(items.begin(), items.begin() + limit, items.end(), compare);
+        std::sort(items.begin(), items.begin() + limit, compare);
+    } else if (items.size() >= RADIX_SORT_THRESHOLD) {
+        radix_sort(items);
+    } else {
+        std::sort(items.begin(), items.end(), compare);
+    }
+
+    for (size_t i = 0; i < items.size(); i++) {
+        records[i] = items[i].record;
+    }
+}
+
 void
 sort_records(
     std::vector<uint8_t *> &records,
     const std::vector<SortField> &sort_fields,
-    const ViewDefinition &def)
+    const ViewDefinition &def,
+    size_t limit)
 {
-    if (sort_fields.empty()) {
+    if (sort_fields.empty() || records.empty()) {
+        return;
+    }
+
+    if (limit == 0 || limit > records.size()) {
+        limit = records.size();
+    }
+
+    if (has_integer_key(sort_fields)) {
+        sort_by_integer_key(records, sort_fields[0], limit);
         return;
     }
 
     std::function<bool(uint8_t *, uint8_t *)> compare = make_comparer(sort_fields, def);
-    std::sort(records.begin(), records.end(), compare);
+
+    if (limit < records.size()) {
+        // Select the first records and sort only them
+        std::nth_element(records.begin(), records.begin() + limit, records.end(), compare);
+        std::sort(records.begin(), records.begin() + limit, compare);
+    } else {
+        std::sort(records.begin(), records.end(), compare);
+    }
 }
 
 } // aggregator
@@ -89,15 +89,20 @@ make_comparer(
 
 /**
  * @brief Sort view records
+ *
+ * If a limit is specified, only the first records are put in order (partial sort) and the
+ * order of the rest of the records is unspecified.
  * @param[inout] records      The view records
  * @param[in]    sort_fields  The fields to sort on
  * @param[in]    def          The view definition
+ * @param[in]    limit        Number of records to sort (0 = all)
  */
 void
 sort_records(
     std::vector<uint8_t *> &records,
     const std::vector<SortField> &sort_fields,
-    const ViewDefinition &def);
+    const ViewDefinition &def,
+    size_t limit = 0);
 
 } // aggregator
 } // fdsdump
@@ -4,10 +4,13 @@
  * @brief View definitions
  */
 
+#include <algorithm>
 #include <stdexcept>
 
 #include "common/common.hpp"
+#include "hyperLogLog.hpp"
 #include "informationElements.hpp"
+#include "keyDictionary.hpp"
 #include "view.hpp"
 
 namespace fdsdump {
@@ -31,6 +34,12 @@ find_field(ViewDefinition &def, const std::string &name)
     return nullptr;
 }
 
+const ViewValue &
+decode_value(const ViewField &field, const ViewValue &value)
+{
+    return field.dictionary ? field.dictionary->decode(value.u32) : value;
+}
+
 static void
 add_ipfix_field(ViewDefinition &view_def, const fds_iemgr_elem *elem)
 {
@@ -79,11 +88,13 @@ add_ipfix_field(ViewDefinition &view_def, const fds_iemgr_elem *elem)
         break;
     case FDS_ET_STRING:
         field.data_type = DataType::String128B;
-        field.size = 128;
+        field.size = sizeof(ViewValue::u32);
+        field.dictionary = std::make_shared<KeyDictionary>();
         break;
     case FDS_ET_OCTET_ARRAY:
         field.data_type = DataType::Octets128B;
-        field.size = 128;
+        field.size = sizeof(ViewValue::u32);
+        field.dictionary = std::make_shared<KeyDictionary>();
         break;
     case FDS_ET_DATE_TIME_MILLISECONDS:
     case FDS_ET_DATE_TIME_MICROSECONDS:
@@ -109,15 +120,215 @@ add_ipfix_field(ViewDefinition &view_def, const fds_iemgr_elem *elem)
     view_def.key_fields.push_back(field);
 }
 
+/**
+ * @brief Split aggregation keys by commas that are not enclosed in parentheses
+ * @param options The aggregation keys specified in a text form
+ * @return The keys
+ */
+static std::vector<std::string>
+split_keys(const std::string &options)
+{
+    std::vector<std::string> keys;
+    std::string key;
+    int depth = 0;
+
+    for (char c : options) {
+        if (c == '(') {
+            depth++;
+        } else if (c == ')') {
+            depth--;
+        } else if (c == ',' && depth == 0) {
+            keys.push_back(key);
+            key.clear();
+            continue;
+        }
+        key.push_back(c);
+    }
+
+    keys.push_back(key);
+    return keys;
+}
+
+uint64_t
+parse_duration(const std::string &width)
+{
+    size_t pos = 0;
+    unsigned long long value;
+
+    try {
+        value = std::stoull(width, &pos);
+    } catch (const std::exception &) {
+        return 0;
+    }
+
+    const std::string unit = width.substr(pos);
+    uint64_t multiplier;
+
+    if (unit == "ms") {
+        multiplier = 1;
+    } else if (unit.empty() || unit == "s") {
+        multiplier = 1000;
+    } else if (unit == "m") {
+        multiplier = 60 * 1000;
+    } else if (unit == "h") {
+        multiplier = 60 * 60 * 1000;
+    } else if (unit == "d") {
+        multiplier = 24 * 60 * 60 * 1000;
+    } else {
+        return 0;
+    }
+
+    if (width[0] == '-' || value > UINT64_MAX / multiplier) {
+        return 0;
+    }
+
+    return value * multiplier;
+}
+
+/**
+ * @brief Parse prefix lengths of a generic IP address key, e.g. "24" or "24/64"
+ *
+ * A single prefix length applies to both IPv4 (at most 32) and IPv6 addresses.
+ *
+ * @param key     The aggregation key (for error messages)
+ * @param lengths The prefix lengths
+ * @param ipv4    The prefix length of IPv4 addresses
+ * @param ipv6    The prefix length of IPv6 addresses
+ */
+static void
+parse_ip_prefixes(const std::string &key, const std::string &lengths, uint8_t &ipv4, uint8_t &ipv6)
+{
+    std::vector<std::string> pieces = string_split(lengths, "/");
+    unsigned long values[2];
+
+    if (pieces.size() > 2) {
+        throw std::invalid_argument("Invalid aggregation key \"" + key + "\" (invalid format)");
+    }
+
+    for (size_t i = 0; i < pieces.size(); i++) {
+        size_t pos = 0;
+        try {
+            values[i] = std::stoul(pieces[i], &pos);
+        } catch (const std::exception &) {
+            pos = 0;
+        }
+
+        if (pos == 0 || pos != pieces[i].size()) {
+            throw std::invalid_argument("Invalid aggregation key \"" + key + "\" (invalid prefix length \"" + pieces[i] + "\")");
+        }
+    }
+
+    if (pieces.size() == 1) {
+        values[1] = values[0];
+        values[0] = std::min<unsigned long>(values[0], 32);
+    }
+
+    if (values[0] == 0 || values[0] > 32) {
+        throw std::invalid_argument("Invalid aggregation key \"" + key + "\" (invalid prefix length " + std::to_string(values[0]) + " for IPv4 address)");
+    }
+
+    if (values[1] == 0 || values[1] > 128) {
+        throw std::invalid_argument("Invalid aggregation key \"" + key + "\" (invalid prefix length " + std::to_string(values[1]) + " for IPv6 address)");
+    }
+
+    ipv4 = values[0];
+    ipv6 = values[1];
+}
+
 static void
-configure_keys(const std::string &options, ViewDefinition &view_def, fds_iemgr_t *iemgr)
+configure_keys(const std::string &options, ViewDefinition &view_def, fds_iemgr_t *iemgr, bool ipv4_only)
 {
     //NOTE: This isn't perfect and there is some unnecessary repetition and certain parts could be split into seperate functions,
     //      but it's still a work in progress and it's simple and flexible
 
-    for (const auto &key : string_split(options, ",")) {
+    for (const auto &key : split_keys(options)) {
         ViewField field = {};
 
+        if (key.compare(0, 4, "bin(") == 0) {
+            // Time bin, e.g. bin(flowStartMilliseconds,5m)
+            if (key.back() != ')') {
+                throw std::invalid_argument("Invalid aggregation key \"" + key + "\" (invalid format)");
+            }
+
+            std::vector<std::string> args = string_split(key.substr(4, key.size() - 5), ",");
+            if (args.size() != 2) {
+                throw std::invalid_argument("Invalid aggregation key \"" + key + "\" (expected element and bin width)");
+            }
+
+            string_trim(args[0]);
+            string_trim(args[1]);
+
+            const fds_iemgr_elem *elem = fds_iemgr_elem_find_name(iemgr, args[0].c_str());
+            if (!elem) {
+                throw std::invalid_argument("Invalid aggregation key \"" + key + "\" (element not found)");
+            }
+
+            if (elem->data_type != FDS_ET_DATE_TIME_SECONDS
+                    && elem->data_type != FDS_ET_DATE_TIME_MILLISECONDS
+                    && elem->data_type != FDS_ET_DATE_TIME_MICROSECONDS
+                    && elem->data_type != FDS_ET_DATE_TIME_NANOSECONDS) {
+                throw std::invalid_argument("Invalid aggregation key \"" + key + "\" (not a timestamp but bin is specified)");
+            }
+
+            field.extra.bin_width = parse_duration(args[1]);
+            if (field.extra.bin_width == 0) {
+                throw std::invalid_argument("Invalid aggregation key \"" + key + "\" (invalid bin width \"" + args[1] + "\")");
+            }
+
+            field.pen = elem->scope->pen;
+            field.id = elem->id;
+            field.name = key;
+            field.data_type = DataType::DateTime;
+            field.kind = ViewFieldKind::TimeBinKey;
+            field.size = sizeof(ViewValue::ts_millisecs);
+            field.offset = view_def.keys_size;
+            view_def.keys_size += field.size;
+            view_def.key_fields.push_back(field);
+            continue;
+        }
+
+        const size_t slash = key.find('/');
+        const std::string generic_name = key.substr(0, slash);
+        if (slash != std::string::npos && (generic_name == "srcip" || generic_name == "dstip" || generic_name == "ip")) {
+            // Subnet of a generic IP address, e.g. srcip/24 or srcip/24/64
+            uint8_t prefix_ipv4;
+            uint8_t prefix_ipv6;
+            parse_ip_prefixes(key, key.substr(slash + 1), prefix_ipv4, prefix_ipv6);
+
+            field.name = key;
+            field.extra.prefix_length = prefix_ipv4;
+            field.extra.prefix_length6 = prefix_ipv6;
+
+            if (ipv4_only) {
+                field.data_type = DataType::IPv4Address;
+                field.size = sizeof(ViewValue::ipv4);
+                if (generic_name == "ip") {
+                    field.kind = ViewFieldKind::BidirectionalIPv4SubnetKey;
+                    view_def.bidirectional = true;
+                } else {
+                    field.pen = IPFIX::iana;
+                    field.id = (generic_name == "srcip") ? IPFIX::sourceIPv4Address : IPFIX::destinationIPv4Address;
+                    field.kind = ViewFieldKind::IPv4SubnetKey;
+                }
+            } else {
+                field.data_type = DataType::IPAddress;
+                field.size = sizeof(ViewValue::ip);
+                if (generic_name == "ip") {
+                    field.kind = ViewFieldKind::BidirectionalIPAddressKey;
+                    view_def.bidirectional = true;
+                } else if (generic_name == "srcip") {
+                    field.kind = ViewFieldKind::SourceIPAddressKey;
+                } else {
+                    field.kind = ViewFieldKind::DestinationIPAddressKey;
+                }
+            }
+
+            field.offset = view_def.keys_size;
+            view_def.keys_size += field.size;
+            view_def.key_fields.push_back(field);
+            continue;
+        }
+
         //std::regex subnet_regex{"([a-zA-Z0-9:]+)/(\\d+)"};
         //std::smatch m;
         std::vector<std::string> pieces = string_split_right(key, "/", 2);
@@ -202,10 +413,45 @@ configure_keys(const std::string &options, ViewDefinition &view_def, fds_iemgr_t
             view_def.keys_size += field.size;
             view_def.key_fields.push_back(field);
 
+        } else if (key == "srcip" && ipv4_only) {
+            field.pen = IPFIX::iana;
+            field.id = IPFIX::sourceIPv4Address;
+            field.data_type = DataType::IPv4Address;
+            field.kind = ViewFieldKind::VerbatimKey;
+            field.name = "srcip";
+            field.size = sizeof(ViewValue::ipv4);
+            field.offset = view_def.keys_size;
+            view_def.keys_size += sizeof(ViewValue::ipv4);
+            view_def.key_fields.push_back(field);
+
+        } else if (key == "dstip" && ipv4_only) {
+            field.pen = IPFIX::iana;
+            field.id = IPFIX::destinationIPv4Address;
+            field.data_type = DataType::IPv4Address;
+            field.kind = ViewFieldKind::VerbatimKey;
+            field.name = "dstip";
+            field.size = sizeof(ViewValue::ipv4);
+            field.offset = view_def.keys_size;
+            view_def.keys_size += sizeof(ViewValue::ipv4);
+            view_def.key_fields.push_back(field);
+
+        } else if (key == "ip" && ipv4_only) {
+            field.data_type = DataType::IPv4Address;
+            field.kind = ViewFieldKind::BidirectionalIPv4SubnetKey;
+            field.name = "ip";
+            field.size = sizeof(ViewValue::ipv4);
+            field.extra.prefix_length = 32;
+            field.offset = view_def.keys_size;
+            view_def.keys_size += sizeof(ViewValue::ipv4);
+            view_def.bidirectional = true;
+            view_def.key_fields.push_back(field);
+
         } else if (key == "srcip") {
             field.data_type = DataType::IPAddress;
             field.kind = ViewFieldKind::SourceIPAddressKey;
             field.name = "srcip";
+            field.extra.prefix_length = 32;
+            field.extra.prefix_length6 = 128;
             field.size = sizeof(ViewValue::ip);
             field.offset = view_def.keys_size;
             view_def.keys_size += sizeof(ViewValue::ip);
@@ -215,6 +461,8 @@ configure_keys(const std::string &options, ViewDefinition &view_def, fds_iemgr_t
             field.data_type = DataType::IPAddress;
             field.kind = ViewFieldKind::DestinationIPAddressKey;
             field.name = "dstip";
+            field.extra.prefix_length = 32;
+            field.extra.prefix_length6 = 128;
             field.size = sizeof(ViewValue::ip);
             field.offset = view_def.keys_size;
             view_def.keys_size += sizeof(ViewValue::ip);
@@ -257,6 +505,8 @@ configure_keys(const std::string &options, ViewDefinition &view_def, fds_iemgr_t
             field.data_type = DataType::IPAddress;
             field.kind = ViewFieldKind::BidirectionalIPAddressKey;
             field.name = "ip";
+            field.extra.prefix_length = 32;
+            field.extra.prefix_length6 = 128;
             field.size = sizeof(ViewValue::ip);
             field.offset = view_def.keys_size;
             view_def.keys_size += sizeof(ViewValue::ip);
@@ -332,6 +582,7 @@ configure_keys(const std::string &options, ViewDefinition &view_def, fds_iemgr_t
             field.size = sizeof(ViewValue::ipv4);
             field.kind = ViewFieldKind::BidirectionalIPv4SubnetKey;
             field.name = "ipv4";
+            field.extra.prefix_length = 32;
             view_def.bidirectional = true;
             field.offset = view_def.keys_size;
             view_def.keys_size += sizeof(ViewValue::ipv4);
@@ -342,6 +593,7 @@ configure_keys(const std::string &options, ViewDefinition &view_def, fds_iemgr_t
             field.size = sizeof(ViewValue::ipv6);
             field.kind = ViewFieldKind::BidirectionalIPv6SubnetKey;
             field.name = "ipv6";
+            field.extra.prefix_length = 128;
             view_def.bidirectional = true;
             field.offset = view_def.keys_size;
             view_def.keys_size += sizeof(ViewValue::ipv6);
@@ -358,6 +610,49 @@ configure_keys(const std::string &options, ViewDefinition &view_def, fds_iemgr_t
     }
 }
 
+/**
+ * @brief Parse precision of a distinct count aggregate, e.g. "distinct" or "distinct(12)"
+ * @param value     The aggregation value (for error messages)
+ * @param func      The aggregation function
+ * @param precision The precision of the sketch
+ * @return true if the function is a distinct count, false otherwise
+ */
+static bool
+parse_distinct(const std::string &value, const std::string &func, uint8_t &precision)
+{
+    static const std::string name = "distinct";
+
+    if (func.compare(0, name.size(), name) != 0) {
+        return false;
+    }
+
+    if (func.size() == name.size()) {
+        precision = HLL_PRECISION_DEF;
+        return true;
+    }
+
+    if (func[name.size()] != '(' || func.back() != ')') {
+        return false;
+    }
+
+    const std::string arg = func.substr(name.size() + 1, func.size() - name.size() - 2);
+    unsigned long number = 0;
+    size_t pos = 0;
+    try {
+        number = std::stoul(arg, &pos);
+    } catch (const std::exception &) {
+        pos = 0;
+    }
+
+    if (pos == 0 || pos != arg.size() || number < HLL_PRECISION_MIN || number > HLL_PRECISION_MAX) {
+        throw std::invalid_argument("Invalid aggregation value \"" + value + "\" (precision must be between "
+            + std::to_string(HLL_PRECISION_MIN) + " and " + std::to_string(HLL_PRECISION_MAX) + ")");
+    }
+
+    precision = number;
+    return true;
+}
+
 static void
 configure_values(const std::string &options, ViewDefinition &view_def, fds_iemgr_t *iemgr)
 {
@@ -467,6 +762,32 @@ configure_values(const std::string &options, ViewDefinition &view_def, fds_iemgr
             field.offset = view_def.keys_size + view_def.values_size;
             view_def.values_size += sizeof(field.size);
 
+        } else if (pieces.size() == 2 && parse_distinct(value, pieces[1], field.extra.hll_precision)) {
+            // Approximate number of distinct values of a field (HyperLogLog sketch)
+            const std::string &field_name = pieces[0];
+
+            if (field_name == "srcip" || field_name == "dstip") {
+                const bool src = (field_name == "srcip");
+                field.pen = IPFIX::iana;
+                field.id = src ? IPFIX::sourceIPv4Address : IPFIX::destinationIPv4Address;
+                field.extra.alt_id = src ? IPFIX::sourceIPv6Address : IPFIX::destinationIPv6Address;
+            } else {
+                const fds_iemgr_elem *elem = fds_iemgr_elem_find_name(iemgr, field_name.c_str());
+                if (!elem) {
+                    throw std::invalid_argument("Invalid aggregation value \"" + value + "\" (element not found)");
+                }
+
+                field.pen = elem->scope->pen;
+                field.id = elem->id;
+            }
+
+            field.data_type = DataType::Unsigned64;
+            field.kind = ViewFieldKind::DistinctCountAggregate;
+            field.name = value;
+            field.size = hll_size(field.extra.hll_precision);
+            field.offset = view_def.keys_size + view_def.values_size;
+            view_def.values_size += field.size;
+
         } else if (value == "packets") {
             field.data_type = DataType::Unsigned64;
             field.pen = IPFIX::iana;
@@ -565,11 +886,11 @@ configure_values(const std::string &options, ViewDefinition &view_def, fds_iemgr
 }
 
 ViewDefinition
-make_view_def(const std::string &keys, const std::string &values, fds_iemgr_t *iemgr)
+make_view_def(const std::string &keys, const std::string &values, fds_iemgr_t *iemgr, bool ipv4_only)
 {
     ViewDefinition def = {};
 
-    configure_keys(keys, def, iemgr);
+    configure_keys(keys, def, iemgr, ipv4_only);
     configure_values(values, def, iemgr);
 
     return def;
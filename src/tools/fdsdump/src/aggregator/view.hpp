@@ -6,15 +6,21 @@
 
 #pragma once
 
+#include <memory>
 #include <string>
 #include <vector>
 #include <cstdint>
+#include <cstring>
 
 #include <libfds.h>
 
+#include "common/common.hpp"
+
 namespace fdsdump {
 namespace aggregator {
 
+class KeyDictionary;
+
 /**
  * @brief A representation of an IP address that can hold both an IPv4 or
  * an IPv6 address.
@@ -75,10 +81,12 @@ enum class ViewFieldKind {
     BidirectionalIPAddressKey,
     BidirectionalPortKey,
     BiflowDirectionKey,
+    TimeBinKey,
     SumAggregate,
     MinAggregate,
     MaxAggregate,
     CountAggregate,
+    DistinctCountAggregate,
 };
 
 /** @brief The direction in case of a bidirectional field. */
@@ -100,7 +108,16 @@ struct ViewField {
     ViewDirection direction;
     struct {
         uint8_t prefix_length;
+        /** Prefix length of IPv6 addresses of generic IP address keys (srcip, dstip, ip) */
+        uint8_t prefix_length6;
+        uint64_t bin_width;
+        /** Precision of the HyperLogLog sketch of a distinct count aggregate */
+        uint8_t hll_precision;
+        /** IANA element used if the element of a distinct count aggregate is missing (0 = none) */
+        uint16_t alt_id;
     } extra;
+    /** Dictionary of values if the key holds their codes (ViewValue::u32) instead */
+    std::shared_ptr<KeyDictionary> dictionary;
 };
 
 /** @brief The view definition */
@@ -117,13 +134,36 @@ struct ViewDefinition {
 /**
  * @brief Make a view definition
  *
- * @param keys   The aggregation keys specified in a text form
- * @param values The aggregation values specified in a text
- * @param iemgr  The iemgr instance
+ * String and octet array keys are dictionary-coded, i.e. only a 32-bit code
+ * of the value is part of the key (see KeyDictionary).
+ *
+ * @param keys      The aggregation keys specified in a text form
+ * @param values    The aggregation values specified in a text
+ * @param iemgr     The iemgr instance
+ * @param ipv4_only Use IPv4 addresses for generic IP address keys (srcip,
+ *   dstip, ip), so they take 4 instead of 17 bytes. Records without IPv4
+ *   addresses are not aggregated.
  * @return The view definition.
  */
 ViewDefinition
-make_view_def(const std::string &keys, const std::string &values, fds_iemgr_t *iemgr);
+make_view_def(const std::string &keys, const std::string &values, fds_iemgr_t *iemgr, bool ipv4_only = false);
+
+/**
+ * @brief Parse a duration, e.g. "300", "5m" or "1h"
+ * @param width The duration with an optional unit (ms, s, m, h, d; seconds by default)
+ * @return The duration in milliseconds or 0 if the duration is invalid.
+ */
+uint64_t
+parse_duration(const std::string &width);
+
+/**
+ * @brief Get a view value of a dictionary-coded field as it was before encoding
+ * @param field The view field
+ * @param value The view value
+ * @return The decoded value or the value itself if the field is not dictionary-coded.
+ */
+const ViewValue &
+decode_value(const ViewField &field, const ViewValue &value);
 
 /**
  * @brief Find a field in a view definition by its name
@@ -147,29 +187,39 @@ advance_value_ptr(ViewValue *&value, size_t value_size)
 
 /**
  * @brief Consturct an IPv4 address
- * @param address The address bytes
+ * @param address       The address bytes
+ * @param prefix_length The number of leading bits to keep (the rest is zeroed)
  * @return The IPAddress instance
  */
 static inline IPAddress
-make_ipv4_address(uint8_t *address)
+make_ipv4_address(uint8_t *address, uint8_t prefix_length = 32)
 {
     IPAddress ip = {};
     ip.length = 4;
-    memcpy(ip.address, address, 4);
+    if (prefix_length >= 32) {
+        memcpy(ip.address, address, 4);
+    } else {
+        memcpy_bits(ip.address, address, prefix_length);
+    }
     return ip;
 }
 
 /**
  * @brief Construct an IPv6 address
- * @param address  The address bytes
+ * @param address       The address bytes
+ * @param prefix_length The number of leading bits to keep (the rest is zeroed)
  * @return The IPAddress instance
  */
 static inline IPAddress
-make_ipv6_address(uint8_t *address)
+make_ipv6_address(uint8_t *address, uint8_t prefix_length = 128)
 {
     IPAddress ip = {};
     ip.length = 16;
-    memcpy(ip.address, address, 16);
+    if (prefix_length >= 128) {
+        memcpy(ip.address, address, 16);
+    } else {
+        memcpy_bits(ip.address, address, prefix_length);
+    }
     return ip;
 }
 
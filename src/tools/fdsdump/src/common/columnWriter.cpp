@@ -0,0 +1,320 @@
+
+#include <cassert>
+#include <stdexcept>
+#include <vector>
+
+#include <unistd.h>
+
+#include <arrow/api.h>
+#include <arrow/io/file.h>
+#include <arrow/ipc/writer.h>
+#include <parquet/arrow/writer.h>
+
+#include "columnWriter.hpp"
+
+namespace fdsdump {
+
+struct ColumnWriter::Impl {
+    Format format;
+    size_t batch_rows;
+
+    std::vector<std::shared_ptr<arrow::Field>> fields;
+    std::vector<ColumnType> types;
+    std::vector<std::unique_ptr<arrow::ArrayBuilder>> builders;
+    std::shared_ptr<arrow::Schema> schema;
+
+    /** Index of the column of the next value */
+    size_t column = 0;
+    /** Number of rows in the current batch */
+    size_t rows = 0;
+
+    std::shared_ptr<arrow::io::FileOutputStream> sink;
+    std::shared_ptr<arrow::ipc::RecordBatchWriter> ipc_writer;
+    std::unique_ptr<parquet::arrow::FileWriter> parquet_writer;
+
+    arrow::ArrayBuilder *
+    next(ColumnType &type)
+    {
+        assert(column < builders.size() && "Too many values in a row");
+        type = types[column];
+        return builders[column++].get();
+    }
+
+    void
+    flush();
+};
+
+static void
+check(const arrow::Status &status, const char *what)
+{
+    if (!status.ok()) {
+        throw std::runtime_error(std::string(what) + ": " + status.ToString());
+    }
+}
+
+/**
+ * @brief Append a value to a numeric builder of any width.
+ */
+template <typename T>
+static void
+append_number(arrow::ArrayBuilder *builder, ColumnType type, T value)
+{
+    arrow::Status status;
+
+    switch (type) {
+    case ColumnType::uint8:
+        status = static_cast<arrow::UInt8Builder *>(builder)->Append(value);
+        break;
+    case ColumnType::uint16:
+        status = static_cast<arrow::UInt16Builder *>(builder)->Append(value);
+        break;
+    case ColumnType::uint32:
+        status = static_cast<arrow::UInt32Builder *>(builder)->Append(value);
+        break;
+    case ColumnType::uint64:
+        status = static_cast<arrow::UInt64Builder *>(builder)->Append(value);
+        break;
+    case ColumnType::int8:
+        status = static_cast<arrow::Int8Builder *>(builder)->Append(value);
+        break;
+    case ColumnType::int16:
+        status = static_cast<arrow::Int16Builder *>(builder)->Append(value);
+        break;
+    case ColumnType::int32:
+        status = static_cast<arrow::Int32Builder *>(builder)->Append(value);
+        break;
+    case ColumnType::int64:
+        status = static_cast<arrow::Int64Builder *>(builder)->Append(value);
+        break;
+    case ColumnType::float64:
+        status = static_cast<arrow::DoubleBuilder *>(builder)->Append(value);
+        break;
+    case ColumnType::timestamp:
+        status = static_cast<arrow::TimestampBuilder *>(builder)->Append(value);
+        break;
+    default:
+        assert(false && "Not a numeric column");
+        status = builder->AppendNull();
+        break;
+    }
+
+    check(status, "Failed to append a value");
+}
+
+ColumnWriter::ColumnWriter(Format format, size_t batch_rows) :
+    m_impl(new Impl())
+{
+    if (isatty(STDOUT_FILENO)) {
+        throw std::runtime_error("Binary output cannot be written to a terminal, redirect it to a file");
+    }
+
+    m_impl->format = format;
+    m_impl->batch_rows = batch_rows;
+}
+
+ColumnWriter::~ColumnWriter()
+{
+    try {
+        close();
+    } catch (const std::runtime_error &) {
+        // Nothing to report to
+    }
+}
+
+void
+ColumnWriter::add_column(const std::string &name, ColumnType type, size_t width)
+{
+    assert(!m_impl->schema && "The output is already opened");
+    std::shared_ptr<arrow::DataType> data_type;
+
+    switch (type) {
+    case ColumnType::uint8:     data_type = arrow::uint8(); break;
+    case ColumnType::uint16:    data_type = arrow::uint16(); break;
+    case ColumnType::uint32:    data_type = arrow::uint32(); break;
+    case ColumnType::uint64:    data_type = arrow::uint64(); break;
+    case ColumnType::int8:      data_type = arrow::int8(); break;
+    case ColumnType::int16:     data_type = arrow::int16(); break;
+    case ColumnType::int32:     data_type = arrow::int32(); break;
+    case ColumnType::int64:     data_type = arrow::int64(); break;
+    case ColumnType::float64:   data_type = arrow::float64(); break;
+    case ColumnType::boolean:   data_type = arrow::boolean(); break;
+    case ColumnType::timestamp: data_type = arrow::timestamp(arrow::TimeUnit::MILLI); break;
+    case ColumnType::fixed:     data_type = arrow::fixed_size_binary(width); break;
+    case ColumnType::string:    data_type = arrow::utf8(); break;
+    case ColumnType::binary:    data_type = arrow::binary(); break;
+    }
+
+    auto builder = arrow::MakeBuilder(data_type);
+    check(builder.status(), "Failed to create a column");
+
+    m_impl->fields.push_back(arrow::field(name, data_type));
+    m_impl->types.push_back(type);
+    m_impl->builders.push_back(std::move(builder).ValueOrDie());
+    check(m_impl->builders.back()->Reserve(m_impl->batch_rows), "Failed to create a column");
+}
+
+void
+ColumnWriter::open()
+{
+    assert(!m_impl->schema && "The output is already opened");
+    m_impl->schema = arrow::schema(m_impl->fields);
+
+    auto sink = arrow::io::FileOutputStream::Open(STDOUT_FILENO);
+    check(sink.status(), "Failed to open the output");
+    m_impl->sink = std::move(sink).ValueOrDie();
+
+    if (m_impl->format == Format::arrow) {
+        auto writer = arrow::ipc::MakeFileWriter(m_impl->sink, m_impl->schema);
+        check(writer.status(), "Failed to create an Arrow writer");
+        m_impl->ipc_writer = std::move(writer).ValueOrDie();
+    } else {
+        auto writer = parquet::arrow::FileWriter::Open(*m_impl->schema,
+            arrow::default_memory_pool(), m_impl->sink);
+        check(writer.status(), "Failed to create a Parquet writer");
+        m_impl->parquet_writer = std::move(writer).ValueOrDie();
+    }
+}
+
+void
+ColumnWriter::append_uint(uint64_t value)
+{
+    ColumnType type;
+    arrow::ArrayBuilder *builder = m_impl->next(type);
+    append_number(builder, type, value);
+}
+
+void
+ColumnWriter::append_int(int64_t value)
+{
+    ColumnType type;
+    arrow::ArrayBuilder *builder = m_impl->next(type);
+    append_number(builder, type, value);
+}
+
+void
+ColumnWriter::append_float(double value)
+{
+    ColumnType type;
+    arrow::ArrayBuilder *builder = m_impl->next(type);
+    append_number(builder, type, value);
+}
+
+void
+ColumnWriter::append_timestamp(uint64_t msecs)
+{
+    ColumnType type;
+    arrow::ArrayBuilder *builder = m_impl->next(type);
+    append_number(builder, type, static_cast<int64_t>(msecs));
+}
+
+void
+ColumnWriter::append_bool(bool value)
+{
+    ColumnType type;
+    arrow::ArrayBuilder *builder = m_impl->next(type);
+    assert(type == ColumnType::boolean);
+    check(static_cast<arrow::BooleanBuilder *>(builder)->Append(value),
+        "Failed to append a value");
+}
+
+void
+ColumnWriter::append_bytes(const uint8_t *data, size_t size)
+{
+    ColumnType type;
+    arrow::ArrayBuilder *builder = m_impl->next(type);
+    arrow::Status status;
+
+    switch (type) {
+    case ColumnType::fixed:
+        assert(static_cast<arrow::FixedSizeBinaryBuilder *>(builder)->byte_width()
+            == static_cast<int32_t>(size));
+        status = static_cast<arrow::FixedSizeBinaryBuilder *>(builder)->Append(data);
+        break;
+    case ColumnType::string:
+        status = static_cast<arrow::StringBuilder *>(builder)->Append(data, size);
+        break;
+    case ColumnType::binary:
+        status = static_cast<arrow::BinaryBuilder *>(builder)->Append(data, size);
+        break;
+    default:
+        assert(false && "Not a binary column");
+        status = builder->AppendNull();
+        break;
+    }
+
+    check(status, "Failed to append a value");
+}
+
+void
+ColumnWriter::append_null()
+{
+    ColumnType type;
+    arrow::ArrayBuilder *builder = m_impl->next(type);
+    check(builder->AppendNull(), "Failed to append a value");
+}
+
+void
+ColumnWriter::end_row()
+{
+    assert(m_impl->column == m_impl->builders.size() && "Missing values in a row");
+    m_impl->column = 0;
+
+    if (++m_impl->rows == m_impl->batch_rows) {
+        m_impl->flush();
+    }
+}
+
+void
+ColumnWriter::close()
+{
+    if (!m_impl->sink) {
+        return;
+    }
+
+    std::shared_ptr<arrow::io::FileOutputStream> sink = std::move(m_impl->sink);
+    m_impl->flush();
+
+    if (m_impl->ipc_writer) {
+        check(m_impl->ipc_writer->Close(), "Failed to finish the output");
+        m_impl->ipc_writer.reset();
+    }
+    if (m_impl->parquet_writer) {
+        check(m_impl->parquet_writer->Close(), "Failed to finish the output");
+        m_impl->parquet_writer.reset();
+    }
+
+    // The standard output itself is not closed
+    check(sink->Flush(), "Failed to write the output");
+}
+
+/**
+ * @brief Write rows appended so far as a record batch.
+ */
+void
+ColumnWriter::Impl::flush()
+{
+    if (rows == 0) {
+        return;
+    }
+
+    std::vector<std::shared_ptr<arrow::Array>> arrays;
+    arrays.reserve(builders.size());
+    for (auto &builder : builders) {
+        std::shared_ptr<arrow::Array> array;
+        check(builder->Finish(&array), "Failed to finish a record batch");
+        check(builder->Reserve(batch_rows), "Failed to finish a record batch");
+        arrays.push_back(std::move(array));
+    }
+
+    auto batch = arrow::RecordBatch::Make(schema, static_cast<int64_t>(rows), std::move(arrays));
+    rows = 0;
+
+    if (ipc_writer) {
+        check(ipc_writer->WriteRecordBatch(*batch), "Failed to write a record batch");
+    } else {
+        check(parquet_writer->NewBufferedRowGroup(), "Failed to write a record batch");
+        check(parquet_writer->WriteRecordBatch(*batch), "Failed to write a record batch");
+    }
+}
+
+} // fdsdump
@@ -0,0 +1,123 @@
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+namespace fdsdump {
+
+/**
+ * @brief Type of a column of the columnar output.
+ */
+enum class ColumnType {
+    uint8,          ///< Unsigned 8-bit integer
+    uint16,         ///< Unsigned 16-bit integer
+    uint32,         ///< Unsigned 32-bit integer
+    uint64,         ///< Unsigned 64-bit integer
+    int8,           ///< Signed 8-bit integer
+    int16,          ///< Signed 16-bit integer
+    int32,          ///< Signed 32-bit integer
+    int64,          ///< Signed 64-bit integer
+    float64,        ///< Floating point number (double precision)
+    boolean,        ///< Boolean
+    timestamp,      ///< Timestamp (milliseconds since UNIX epoch)
+    fixed,          ///< Fixed size binary (e.g. addresses)
+    string,         ///< Variable length UTF-8 string
+    binary,         ///< Variable length binary data
+};
+
+/**
+ * @brief Writer of typed columns into an Apache Arrow IPC file or an Apache
+ *   Parquet file on the standard output.
+ *
+ * Columns are defined by add_column() before the first row is appended.
+ * Each row is appended by calling exactly one append function for each column
+ * (in the order of the columns) followed by end_row(). Rows are accumulated
+ * and written as record batches (row groups in case of Parquet).
+ *
+ * The interface doesn't expose Arrow headers (they require C++17), so printers
+ * can use it without them.
+ */
+class ColumnWriter {
+public:
+    /** @brief Format of the output file */
+    enum class Format {
+        arrow,      ///< Arrow IPC file (aka Feather V2)
+        parquet,    ///< Parquet file
+    };
+
+    /**
+     * @brief Create a writer.
+     * @param[in] format      Output format
+     * @param[in] batch_rows  Maximum number of rows of a record batch
+     * @throw std::runtime_error if the standard output is a terminal
+     */
+    ColumnWriter(Format format, size_t batch_rows = 65536);
+    ~ColumnWriter();
+
+    ColumnWriter(const ColumnWriter &) = delete;
+    ColumnWriter &operator=(const ColumnWriter &) = delete;
+
+    /**
+     * @brief Define a new column.
+     * @param[in] name   Name of the column
+     * @param[in] type   Type of the column
+     * @param[in] width  Size of values (only ColumnType::fixed)
+     */
+    void
+    add_column(const std::string &name, ColumnType type, size_t width = 0);
+
+    /**
+     * @brief Start writing the output (i.e. no more columns can be added).
+     * @throw std::runtime_error if the output cannot be written
+     */
+    void
+    open();
+
+    /** @brief Append a value to an integer column. */
+    void
+    append_uint(uint64_t value);
+    /** @brief Append a value to an integer column. */
+    void
+    append_int(int64_t value);
+    /** @brief Append a value to a float64 column. */
+    void
+    append_float(double value);
+    /** @brief Append a value to a boolean column. */
+    void
+    append_bool(bool value);
+    /** @brief Append a value to a timestamp column. */
+    void
+    append_timestamp(uint64_t msecs);
+    /**
+     * @brief Append a value to a fixed, string or binary column.
+     * @note Size of values of a fixed column must match its width.
+     */
+    void
+    append_bytes(const uint8_t *data, size_t size);
+    /** @brief Append a missing value to a column of any type. */
+    void
+    append_null();
+
+    /**
+     * @brief Finish the row, write a record batch if it is full.
+     * @throw std::runtime_error if the batch cannot be written
+     */
+    void
+    end_row();
+
+    /**
+     * @brief Write remaining rows and finish the output file.
+     * @throw std::runtime_error if the output cannot be written
+     */
+    void
+    close();
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> m_impl;
+};
+
+} // fdsdump
@@ -1,5 +1,8 @@
 
 #include <algorithm>
+#include <exception>
+#include <mutex>
+#include <thread>
 
 #include "common.hpp"
 
@@ -115,4 +118,34 @@ memcpy_bits(uint8_t *dst, uint8_t *src, unsigned int n_bits)
     }
 }
 
+void
+run_parallel(size_t count, const std::function<void(size_t)> &func)
+{
+    std::vector<std::thread> threads;
+    std::exception_ptr error;
+    std::mutex error_mutex;
+
+    threads.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        threads.emplace_back([&, i]() {
+            try {
+                func(i);
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(error_mutex);
+                if (!error) {
+                    error = std::current_exception();
+                }
+            }
+        });
+    }
+
+    for (auto &thread : threads) {
+        thread.join();
+    }
+
+    if (error) {
+        std::rethrow_exception(error);
+    }
+}
+
 } // fdsdump
@@ -7,6 +7,7 @@
 
 #pragma once
 
+#include <functional>
 #include <memory>
 #include <string>
 #include <vector>
@@ -71,4 +72,14 @@ string_trim_copy(std::string str);
 void
 memcpy_bits(uint8_t *dst, uint8_t *src, unsigned int n_bits);
 
+/**
+ * @brief Run a function for each index in parallel (one thread per index).
+ *
+ * The first exception thrown by any of the threads is rethrown after all threads finish.
+ * @param[in] count Number of indexes
+ * @param[in] func  Function to run
+ */
+void
+run_parallel(size_t count, const std::function<void(size_t)> &func);
+
 } // fdsdump
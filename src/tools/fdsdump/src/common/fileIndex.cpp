@@ -0,0 +1,294 @@
+
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+
+#include <arpa/inet.h>
+#include <endian.h>
+
+#include "common.hpp"
+#include "fileIndex.hpp"
+
+namespace fdsdump {
+
+/// Magic bytes of an index file
+static const char INDEX_MAGIC[4] = {'F', 'D', 'S', 'I'};
+/// Supported version of the index file format
+static const uint16_t INDEX_VERSION = 1;
+/// Size of a port bitmap (bytes)
+static const size_t PORTS_SIZE = 65536U / 8U;
+
+static bool
+bit_test(const std::vector<uint8_t> &bitmap, uint32_t idx)
+{
+    return (bitmap[idx / 8U] & (0x80U >> (idx % 8U))) != 0;
+}
+
+static bool
+is_number(const std::string &str)
+{
+    return !str.empty() && std::all_of(str.begin(), str.end(),
+        [](unsigned char c) { return std::isdigit(c); });
+}
+
+static std::string
+to_lower(std::string str)
+{
+    std::transform(str.begin(), str.end(), str.begin(),
+        [](unsigned char c) { return std::tolower(c); });
+    return str;
+}
+
+/**
+ * @brief Add a constraint of a single term of a conjunction (if recognized)
+ * @param[in]  tokens Tokens of the term (separated by whitespaces)
+ * @param[out] query  The query
+ */
+static void
+add_term(const std::vector<std::string> &tokens, IndexQuery &query)
+{
+    std::string field;
+    size_t idx = 0;
+
+    if (idx < tokens.size() && (tokens[idx] == "src" || tokens[idx] == "dst")) {
+        idx++;
+    }
+
+    if (idx >= tokens.size()) {
+        return;
+    }
+
+    field = tokens[idx++];
+    if (field == "srcport" || field == "dstport") {
+        field = "port";
+    } else if (field == "srcip" || field == "dstip") {
+        field = "ip";
+    }
+
+    if (idx < tokens.size() && (tokens[idx] == "==" || tokens[idx] == "=")) {
+        idx++;
+    }
+
+    if (idx + 1 != tokens.size()) {
+        return;
+    }
+
+    const std::string &value = tokens[idx];
+
+    if (field == "port") {
+        if (!is_number(value) || value.size() > 5) {
+            return;
+        }
+
+        const unsigned long port = std::stoul(value);
+        if (port <= UINT16_MAX) {
+            query.ports.push_back(static_cast<uint16_t>(port));
+        }
+
+    } else if (field == "ip") {
+        try {
+            query.addrs.emplace_back(value);
+        } catch (const std::invalid_argument &) {
+            // Not a plain address (e.g. a prefix)
+        }
+    }
+}
+
+IndexQuery
+IndexQuery::from_filter(const std::string &expr)
+{
+    IndexQuery query;
+    std::vector<std::string> term;
+
+    const std::string str = to_lower(expr);
+    if (str.find_first_of("()!|") != std::string::npos) {
+        return {};
+    }
+
+    for (std::string &token : string_split(str, " ")) {
+        string_trim(token);
+        if (token.empty()) {
+            continue;
+        }
+
+        if (token == "or" || token == "not") {
+            return {};
+        }
+
+        if (token == "and" || token == "&&") {
+            add_term(term, query);
+            term.clear();
+            continue;
+        }
+
+        term.push_back(token);
+    }
+
+    add_term(term, query);
+    return query;
+}
+
+FileIndex::FileIndex(const std::string &path)
+{
+    std::unique_ptr<FILE, decltype(&fclose)> file(fopen(path.c_str(), "rb"), &fclose);
+    if (!file) {
+        throw std::runtime_error("Failed to open index file '" + path + "': "
+            + std::string(strerror(errno)));
+    }
+
+    uint8_t hdr[20];
+    if (fread(hdr, sizeof(hdr), 1, file.get()) != 1
+            || memcmp(hdr, INDEX_MAGIC, sizeof(INDEX_MAGIC)) != 0) {
+        throw std::runtime_error("Invalid index file '" + path + "'");
+    }
+
+    uint16_t version;
+    uint32_t params[3];
+    memcpy(&version, &hdr[4], sizeof(version));
+    memcpy(params, &hdr[8], sizeof(params));
+
+    if (ntohs(version) != INDEX_VERSION) {
+        throw std::runtime_error("Unsupported version of index file '" + path + "'");
+    }
+
+    m_bits = ntohl(params[1]);
+    m_hashes = ntohl(params[2]);
+    if (m_bits == 0 || m_bits % 8U != 0) {
+        throw std::runtime_error("Invalid index file '" + path + "'");
+    }
+
+    while (true) {
+        uint8_t block_hdr[24];
+        if (fread(block_hdr, sizeof(block_hdr), 1, file.get()) != 1) {
+            break;
+        }
+
+        uint32_t records;
+        memcpy(&records, &block_hdr[0], sizeof(records));
+
+        Block block;
+        block.records = ntohl(records);
+        block.bloom.resize(m_bits / 8U);
+        block.sports.resize(PORTS_SIZE);
+        block.dports.resize(PORTS_SIZE);
+
+        if (fread(block.bloom.data(), block.bloom.size(), 1, file.get()) != 1
+                || fread(block.sports.data(), PORTS_SIZE, 1, file.get()) != 1
+                || fread(block.dports.data(), PORTS_SIZE, 1, file.get()) != 1) {
+            throw std::runtime_error("Truncated index file '" + path + "'");
+        }
+
+        m_blocks.push_back(std::move(block));
+    }
+}
+
+std::vector<std::pair<uint32_t, bool>>
+FileIndex::evaluate(const IndexQuery &query) const
+{
+    std::vector<std::pair<uint32_t, bool>> result;
+
+    result.reserve(m_blocks.size());
+    for (const auto &block : m_blocks) {
+        result.emplace_back(block.records, block_match(block, query));
+    }
+
+    return result;
+}
+
+bool
+FileIndex::block_match(const Block &block, const IndexQuery &query) const
+{
+    for (uint16_t port : query.ports) {
+        if (!bit_test(block.sports, port) && !bit_test(block.dports, port)) {
+            return false;
+        }
+    }
+
+    for (const auto &addr : query.addrs) {
+        if (!bloom_contains(block, addr)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * @brief Check whether an IP address might be present in a block
+ *
+ * The address is hashed as an IPv4-mapped IPv6 address by 64-bit FNV-1a,
+ * the same way as by the writer of the index.
+ */
+bool
+FileIndex::bloom_contains(const Block &block, const IPAddr &addr) const
+{
+    uint64_t hash = UINT64_C(14695981039346656037);
+    for (size_t i = 0; i < 16U; ++i) {
+        hash ^= addr.u8[i];
+        hash *= UINT64_C(1099511628211);
+    }
+
+    const uint32_t lo = static_cast<uint32_t>(hash);
+    const uint32_t hi = static_cast<uint32_t>(hash >> 32);
+    for (uint32_t i = 0; i < m_hashes; ++i) {
+        const uint64_t pos = (lo + static_cast<uint64_t>(i) * hi) % m_bits;
+        if (!bit_test(block.bloom, static_cast<uint32_t>(pos))) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool
+BlockFilter::open(const std::string &file, const IndexQuery &query)
+{
+    m_blocks.clear();
+    m_block_idx = 0;
+    m_block_pos = 0;
+
+    if (query.empty()) {
+        return true;
+    }
+
+    try {
+        FileIndex index {FileIndex::path_of(file)};
+        m_blocks = index.evaluate(query);
+    } catch (const std::exception &) {
+        // Missing or invalid index, all records must be processed
+        return true;
+    }
+
+    for (const auto &block : m_blocks) {
+        if (block.second) {
+            return true;
+        }
+    }
+
+    // Records beyond the indexed blocks (if any) are unknown
+    return m_blocks.empty();
+}
+
+bool
+BlockFilter::skip_next()
+{
+    // Skip empty blocks and move to the block of the record
+    while (m_block_idx < m_blocks.size() && m_block_pos >= m_blocks[m_block_idx].first) {
+        m_block_idx++;
+        m_block_pos = 0;
+    }
+
+    if (m_block_idx >= m_blocks.size()) {
+        // Not covered by the index
+        return false;
+    }
+
+    m_block_pos++;
+    return !m_blocks[m_block_idx].second;
+}
+
+} // fdsdump
@@ -0,0 +1,121 @@
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "ipaddr.hpp"
+
+namespace fdsdump {
+
+/**
+ * @brief Constraints of a flow filter that can be checked against a file index.
+ *
+ * Only conjunctions of simple terms such as "port 53", "dst port 53",
+ * "ip 10.0.0.1" or "src ip 2001:db8::1" are recognized. Other terms of the
+ * conjunction are ignored (i.e. they can only make the filter more selective).
+ * If the expression contains a disjunction, negation or parentheses, no
+ * constraints are extracted, so nothing can be skipped.
+ *
+ * Source and destination ports are not distinguished because the reverse
+ * direction of a biflow record swaps them.
+ */
+struct IndexQuery {
+    /** @brief Ports that must be present in a block (either source or destination) */
+    std::vector<uint16_t> ports;
+    /** @brief IP addresses that must be present in a block */
+    std::vector<IPAddr> addrs;
+
+    /**
+     * @brief Extract constraints from a filter expression.
+     * @param[in] expr Filtration expression
+     */
+    static IndexQuery
+    from_filter(const std::string &expr);
+
+    /** @brief Check whether there are no constraints */
+    bool empty() const { return ports.empty() && addrs.empty(); };
+};
+
+/**
+ * @brief Sidecar index of an FDS file (see the FDS output plugin)
+ *
+ * Records of the file are split into blocks of consecutive records. For each
+ * block, the index contains a Bloom filter of IP addresses and bitmaps of
+ * source and destination ports. It can be used to find out which blocks
+ * cannot contain records matching a query.
+ */
+class FileIndex {
+public:
+    /**
+     * @brief Load the index of a file.
+     * @param[in] path Path to the index file
+     * @throw std::runtime_error if the index cannot be loaded
+     */
+    FileIndex(const std::string &path);
+
+    /**
+     * @brief Evaluate a query against all blocks.
+     * @param[in] query The query
+     * @return For each block, the number of its records and whether it might contain matching ones
+     */
+    std::vector<std::pair<uint32_t, bool>>
+    evaluate(const IndexQuery &query) const;
+
+    /**
+     * @brief Get the path of the index of a file.
+     * @param[in] file Path to the FDS file
+     */
+    static std::string
+    path_of(const std::string &file) { return file + ".idx"; };
+
+private:
+    struct Block {
+        uint32_t records;
+        std::vector<uint8_t> bloom;
+        std::vector<uint8_t> sports;
+        std::vector<uint8_t> dports;
+    };
+
+    uint32_t m_bits;
+    uint32_t m_hashes;
+    std::vector<Block> m_blocks;
+
+    bool block_match(const Block &block, const IndexQuery &query) const;
+    bool bloom_contains(const Block &block, const IPAddr &addr) const;
+};
+
+/**
+ * @brief Sequential filter of records of a file based on its sidecar index.
+ */
+class BlockFilter {
+public:
+    /**
+     * @brief Prepare the filter for a file.
+     *
+     * If the file has no (valid) index or the query is empty, no records are skipped.
+     * @param[in] file  Path to the FDS file
+     * @param[in] query The query
+     * @return False if no record of the file can match the query, true otherwise.
+     */
+    bool
+    open(const std::string &file, const IndexQuery &query);
+
+    /**
+     * @brief Check whether the next record of the file should be skipped.
+     * @note Must be called exactly once for each record read from the file.
+     */
+    bool
+    skip_next();
+
+private:
+    /** Blocks of the file (number of records, might match) */
+    std::vector<std::pair<uint32_t, bool>> m_blocks;
+    /** Index of the current block */
+    size_t m_block_idx = 0;
+    /** Number of records of the current block already read */
+    uint32_t m_block_pos = 0;
+};
+
+} // fdsdump
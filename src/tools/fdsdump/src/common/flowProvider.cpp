@@ -30,6 +30,12 @@ FlowProvider::add_file(const std::string &file)
     m_remains.push_back(file);
 }
 
+void
+FlowProvider::set_source(RecordSource source)
+{
+    m_source = std::move(source);
+}
+
 void
 FlowProvider::set_filter(const std::string &expr)
 {
@@ -43,6 +49,8 @@ FlowProvider::set_filter(const std::string &expr)
         const std::string err_msg = fds_ipfix_filter_get_error(filter);
         throw std::runtime_error("fds_ipfix_filter_create() has failed: " + err_msg);
     }
+
+    m_query = IndexQuery::from_filter(expr);
 }
 
 void
@@ -51,6 +59,18 @@ FlowProvider::set_biflow_autoignore(bool enable)
     m_biflow_autoignore = enable;
 }
 
+void
+FlowProvider::set_prefetch(unsigned int threads)
+{
+    m_prefetch = threads;
+}
+
+void
+FlowProvider::set_stable_records(bool enable)
+{
+    m_stable_records = enable;
+}
+
 bool
 FlowProvider::prepare_next_file()
 {
@@ -75,6 +95,12 @@ FlowProvider::prepare_next_file()
             continue;
         }
 
+        if (!m_block_filter.open(*next_file, m_query)) {
+            // No record of the file can match the filter
+            m_remains.pop_front();
+            continue;
+        }
+
         m_remains.pop_front();
         return true;
     }
@@ -127,43 +153,65 @@ FlowProvider::filter_record(struct fds_drec *rec)
     }
 }
 
-bool
-FlowProvider::field_has_only_zero_value(struct fds_drec *rec, uint16_t id, bool reverse)
+/**
+ * @brief Find out which directions of a biflow record are not empty.
+ *
+ * A direction is empty if its octet and packet counters are present and zero.
+ * Both directions are checked by a single pass over fields of the record, where
+ * forward counters are IANA elements and reverse counters are their reverse
+ * counterparts (see RFC 5103).
+ * @return Non-empty directions
+ */
+enum Direction
+FlowProvider::biflow_directions(struct fds_drec *rec)
 {
-    const uint16_t flags = reverse ? FDS_DREC_BIFLOW_REV : FDS_DREC_BIFLOW_FWD;
+    const uint32_t IANA_PEN = 0;
+    const uint32_t IANA_REVERSE_PEN = 29305;
+    const uint16_t IPFIX_OCTET_DELTA = 1;
+    const uint16_t IPFIX_PACKET_DELTA = 2;
+
+    // Bit of a counter (octets, packets) of a direction (forward, reverse)
+    unsigned int found = 0;
+    unsigned int nonzero = 0;
     struct fds_drec_iter iter;
-    int found = false;
 
-    fds_drec_iter_init(&iter, rec, flags);
+    fds_drec_iter_init(&iter, rec, 0);
 
-    while (fds_drec_iter_find(&iter, 0, id) != FDS_EOC) {
-        FieldView field(iter.field);
+    while (fds_drec_iter_next(&iter) != FDS_EOC) {
+        const struct fds_tfield *info = iter.field.info;
+        unsigned int bit;
 
-        found = true;
+        if (info->id != IPFIX_OCTET_DELTA && info->id != IPFIX_PACKET_DELTA) {
+            continue;
+        }
 
-        if (field.as_uint() != 0) {
-            return false;
+        if (info->en == IANA_PEN) {
+            bit = 1U << (info->id - 1);
+        } else if (info->en == IANA_REVERSE_PEN) {
+            bit = 1U << (info->id + 1);
+        } else {
+            continue;
         }
-    }
 
-    return found;
-}
+        found |= bit;
+        if (FieldView(iter.field).as_uint() != 0) {
+            nonzero |= bit;
+        }
+    }
 
-bool
-FlowProvider::direction_is_empty(struct fds_drec *rec, bool reverse)
-{
-    const uint16_t IPFIX_OCTET_DELTA = 1;
-    const uint16_t IPFIX_PACKET_DELTA = 2;
+    // Only a direction with both counters found and zero is empty
+    const unsigned int empty = found & ~nonzero;
+    int result = 0;
 
-    if (!field_has_only_zero_value(rec, IPFIX_OCTET_DELTA, reverse)) {
-        return false;
+    if ((empty & 0x3U) != 0x3U) {
+        result |= DIRECTION_FWD;
     }
 
-    if (!field_has_only_zero_value(rec, IPFIX_PACKET_DELTA, reverse)) {
-        return false;
+    if ((empty & 0xCU) != 0xCU) {
+        result |= DIRECTION_REV;
     }
 
-    return true;
+    return static_cast<enum Direction>(result);
 }
 
 enum Direction
@@ -171,7 +219,6 @@ FlowProvider::biflow_autoignore(struct fds_drec *rec)
 {
     const fds_template_flag_t tflags = rec->tmplt->flags;
     const bool is_biflow = (tflags & FDS_TEMPLATE_BIFLOW) != 0;
-    int result = 0;
 
     if (!m_biflow_autoignore) {
         // Disabled
@@ -182,27 +229,45 @@ FlowProvider::biflow_autoignore(struct fds_drec *rec)
         return DIRECTION_FWD;
     }
 
-    if (!direction_is_empty(rec, false)) {
-        result |= DIRECTION_FWD;
-    }
+    return biflow_directions(rec);
+}
 
-    if (!direction_is_empty(rec, true)) {
-        result |= DIRECTION_REV;
+/**
+ * @brief Read the next record (from the source, the prefetcher or the current file).
+ * @return False if there are no more records
+ */
+bool
+FlowProvider::read_record()
+{
+    if (m_source) {
+        return m_source(m_flow.rec);
     }
 
-    return static_cast<enum Direction>(result);
-}
+    if (m_prefetch > 0) {
+        if (!m_prefetcher) {
+            std::vector<std::string> files(m_remains.begin(), m_remains.end());
+            m_remains.clear();
+            m_prefetcher.reset(new Prefetcher(m_iemgr, std::move(files), m_query, m_prefetch));
 
-Flow *
-FlowProvider::next_record()
-{
-    int dir;
+            if (m_stable_records) {
+                m_prefetcher->retain_records();
+            }
+        }
+
+        struct fds_drec *rec = m_prefetcher->next_record();
+        if (!rec) {
+            return false;
+        }
+
+        m_flow.rec = *rec;
+        return true;
+    }
 
     while (true) {
         if (!m_file_ready) {
             if (!prepare_next_file()) {
                 // No more file, no more records
-                return nullptr;
+                return false;
             }
 
             m_file_ready = true;
@@ -213,12 +278,37 @@ FlowProvider::next_record()
             continue;
         }
 
-        dir = filter_record(&m_flow.rec);
-        if (dir == DIRECTION_NONE) {
+        if (m_block_filter.skip_next()) {
             continue;
         }
 
-        dir &= biflow_autoignore(&m_flow.rec);
+        return true;
+    }
+}
+
+Flow *
+FlowProvider::next_record()
+{
+    int dir;
+
+    while (true) {
+        uint64_t start = profile_start();
+
+        if (!read_record()) {
+            return nullptr;
+        }
+
+        // Records read ahead are already read and decompressed by other threads
+        const ProfileStage read_stage = (m_prefetch > 0) ? ProfileStage::wait : ProfileStage::read;
+        start = m_profile.stop(read_stage, start, 1, m_flow.rec.size);
+
+        dir = filter_record(&m_flow.rec);
+        if (dir != DIRECTION_NONE) {
+            dir &= biflow_autoignore(&m_flow.rec);
+        }
+
+        m_profile.stop(ProfileStage::filter, start, 1, m_flow.rec.size);
+
         if (dir == DIRECTION_NONE) {
             continue;
         }
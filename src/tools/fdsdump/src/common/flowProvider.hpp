@@ -1,6 +1,7 @@
 
 #pragma once
 
+#include <functional>
 #include <memory>
 #include <string>
 #include <list>
@@ -8,12 +9,23 @@
 #include <libfds.h>
 
 #include "common.hpp" // unique_file, unique_iemgr
+#include "fileIndex.hpp"
 #include "flow.hpp"
+#include "prefetcher.hpp"
+#include "profiler.hpp"
 
 namespace fdsdump {
 
 class FlowProvider {
 public:
+    /**
+     * @brief Source of data records held in memory (see set_source()).
+     *
+     * The function fills the next record and returns true, or returns false
+     * if there are no more records.
+     */
+    using RecordSource = std::function<bool(struct fds_drec &rec)>;
+
     FlowProvider(const shared_iemgr &iemgr);
     ~FlowProvider() = default;
 
@@ -27,8 +39,24 @@ public:
     void
     add_file(const std::string &file);
 
+    /**
+     * @brief Read records from memory instead of files.
+     *
+     * Records of the source are filtered and processed the same way as
+     * records of files. Their data and templates must remain valid as long
+     * as the provider exists. Files added by add_file() are ignored.
+     * @note Must be called before the first record is read.
+     * @param[in] source The source of records
+     */
+    void
+    set_source(RecordSource source);
+
     /**
      * @brief Set a flow filter.
+     *
+     * If a file has a sidecar index (see FileIndex), blocks of records (or the
+     * whole file) that cannot match simple constraints of the filter are skipped
+     * without evaluation of the filter.
      * @param[in] expr Filtration expression.
      */
     void
@@ -47,6 +75,40 @@ public:
     void
     set_biflow_autoignore(bool enable);
 
+    /**
+     * @brief Read files ahead by a pool of threads.
+     *
+     * Files are opened and their records are decompressed by the threads,
+     * while the caller only filters and processes them (see Prefetcher).
+     * @note Must be called before the first record is read.
+     * @param[in] threads Number of threads (0 = read by the caller)
+     */
+    void
+    set_prefetch(unsigned int threads);
+
+    /**
+     * @brief Keep all read records in memory.
+     *
+     * If files are read ahead (see set_prefetch()), data records (and their
+     * templates) of flows returned by next_record() then remain valid as long
+     * as the provider exists, so they can be referred to instead of copied.
+     * Otherwise, the option has no effect.
+     * @note Must be called before the first record is read.
+     * @param[in] enable True/false
+     */
+    void
+    set_stable_records(bool enable);
+
+    /**
+     * @brief Check if data records of returned flows remain valid as long as
+     * the provider exists (see set_stable_records() and set_source()).
+     */
+    bool
+    has_stable_records() const
+    {
+        return (m_stable_records && m_prefetch > 0) || m_source;
+    };
+
     /**
      * @brief Get the next flow record
      * @return Pointer or NULL (no more records to process)
@@ -57,20 +119,27 @@ public:
 private:
     bool prepare_next_file();
     bool prepare_next_record();
+    bool read_record();
     enum Direction filter_record(struct fds_drec *rec);
     enum Direction biflow_autoignore(struct fds_drec *rec);
-
-    bool field_has_only_zero_value(struct fds_drec *rec, uint16_t id, bool reverse);
-    bool direction_is_empty(struct fds_drec *rec, bool reverse);
+    enum Direction biflow_directions(struct fds_drec *rec);
 
     std::list<std::string> m_remains;
+    RecordSource m_source;
 
     shared_iemgr m_iemgr;
     unique_filter m_filter {nullptr, &fds_ipfix_filter_destroy};
+    IndexQuery m_query;
     unique_file m_file {nullptr, &fds_file_close};
     bool m_file_ready = false;
     bool m_biflow_autoignore = false;
+    BlockFilter m_block_filter;
+
+    unsigned int m_prefetch = 0;
+    bool m_stable_records = false;
+    std::unique_ptr<Prefetcher> m_prefetcher;
 
+    ProfileCounters m_profile;
     Flow m_flow;
 };
 
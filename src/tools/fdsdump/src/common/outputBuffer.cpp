@@ -0,0 +1,106 @@
+
+#include <stdexcept>
+
+#include "outputBuffer.hpp"
+
+namespace fdsdump {
+
+OutputBuffer::OutputBuffer(FILE *file, size_t size) :
+    m_file(file),
+    m_size(size)
+{
+    // Formatting of a record might slightly overflow the limit
+    m_data.reserve(m_size + m_size / 4);
+    m_pending.reserve(m_size + m_size / 4);
+
+    m_thread = std::thread(&OutputBuffer::thread_main, this);
+}
+
+OutputBuffer::~OutputBuffer()
+{
+    try {
+        flush();
+    } catch (const std::runtime_error &) {
+        // Nothing to report to
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_cv_job.notify_one();
+    m_thread.join();
+}
+
+void
+OutputBuffer::flush()
+{
+    if (!m_data.empty()) {
+        pass();
+    }
+
+    wait_idle();
+    fflush(m_file);
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_error) {
+        m_error = false;
+        throw std::runtime_error("Failed to write the output");
+    }
+}
+
+/**
+ * @brief Hand the filled buffer over to the thread and start filling the other one.
+ *
+ * If the thread is still writing the previous buffer, wait until it's finished.
+ */
+void
+OutputBuffer::pass()
+{
+    wait_idle();
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_error) {
+            m_error = false;
+            throw std::runtime_error("Failed to write the output");
+        }
+
+        m_data.swap(m_pending);
+        m_busy = true;
+    }
+    m_cv_job.notify_one();
+
+    m_data.clear();
+}
+
+void
+OutputBuffer::wait_idle()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_cv_done.wait(lock, [this]() { return !m_busy; });
+}
+
+void
+OutputBuffer::thread_main()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+
+    while (true) {
+        m_cv_job.wait(lock, [this]() { return m_stop || m_busy; });
+        if (!m_busy) {
+            // Stop request
+            break;
+        }
+
+        lock.unlock();
+        const bool failed = fwrite(m_pending.data(), 1, m_pending.size(), m_file) != m_pending.size();
+        lock.lock();
+
+        m_error |= failed;
+        m_busy = false;
+        m_cv_done.notify_one();
+    }
+}
+
+} // fdsdump
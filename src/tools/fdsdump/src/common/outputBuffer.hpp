@@ -0,0 +1,84 @@
+
+#pragma once
+
+#include <condition_variable>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace fdsdump {
+
+/**
+ * @brief Buffered output written by a background thread.
+ *
+ * Printers append formatted records to data() and call commit() after each
+ * record. When the buffer is full, it's handed over to the thread, which
+ * writes it by fwrite(), while the printer fills the other buffer. Therefore,
+ * formatting runs in parallel with writing the output.
+ *
+ * Nothing is written until a buffer is full or flush() is called. Text written
+ * to the same file by other means must be preceded by flush().
+ */
+class OutputBuffer {
+public:
+    /**
+     * @brief Start the writing thread.
+     * @param[in] file  Output file
+     * @param[in] size  Size of a buffer to hand over to the thread
+     */
+    OutputBuffer(FILE *file = stdout, size_t size = 1024 * 1024);
+    ~OutputBuffer();
+
+    OutputBuffer(const OutputBuffer &) = delete;
+    OutputBuffer &operator=(const OutputBuffer &) = delete;
+
+    /**
+     * @brief Get the buffer to append text to.
+     * @note The reference remains valid as long as the object exists.
+     */
+    std::string &
+    data() { return m_data; };
+
+    /**
+     * @brief Hand the buffer over to the thread if it's full.
+     * @throw std::runtime_error if previous output could not be written
+     */
+    void
+    commit()
+    {
+        if (m_data.size() >= m_size) {
+            pass();
+        }
+    };
+
+    /**
+     * @brief Write all text appended so far and wait until it's written.
+     * @throw std::runtime_error if the output could not be written
+     */
+    void
+    flush();
+
+private:
+    FILE *m_file;
+    size_t m_size;
+
+    /** Buffer being filled */
+    std::string m_data;
+    /** Buffer being written by the thread */
+    std::string m_pending;
+
+    std::thread m_thread;
+    std::mutex m_mutex;
+    std::condition_variable m_cv_job;
+    std::condition_variable m_cv_done;
+    bool m_busy = false;
+    bool m_stop = false;
+    bool m_error = false;
+
+    void pass();
+    void wait_idle();
+    void thread_main();
+};
+
+} // fdsdump
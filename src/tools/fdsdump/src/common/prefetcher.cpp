@@ -0,0 +1,301 @@
+
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+#include <system_error>
+
+#include "prefetcher.hpp"
+#include "profiler.hpp"
+
+namespace fdsdump {
+
+/// Size of record data of a batch
+static constexpr size_t BATCH_SIZE = 1024 * 1024;
+/// Maximal number of batches of a file waiting for the consumer
+static constexpr size_t BATCHES_MAX = 4;
+
+/**
+ * @brief Copies of records read from a file
+ */
+struct Prefetcher::Batch {
+    /** Data of the records (never reallocated) */
+    std::unique_ptr<uint8_t[]> data {new uint8_t[BATCH_SIZE]};
+    /** Used size of the data */
+    size_t used = 0;
+    /** The records referring to the data */
+    std::vector<struct fds_drec> records;
+    /** Template snapshots referred by the records */
+    std::vector<shared_tsnapshot> snapshots;
+    /** Position of the next record to consume */
+    size_t pos = 0;
+};
+
+Prefetcher::Prefetcher(
+    const shared_iemgr &iemgr,
+    std::vector<std::string> files,
+    const IndexQuery &query,
+    unsigned int threads)
+    : m_files(std::move(files)), m_query(query), m_slots(m_files.size())
+{
+    for (unsigned int i = 0; i < threads; ++i) {
+        // The manager is not thread-safe, therefore, each thread uses its own copy
+        shared_iemgr copy {fds_iemgr_copy(iemgr.get()), &fds_iemgr_destroy};
+        if (!copy) {
+            throw std::runtime_error("fds_iemgr_copy() has failed");
+        }
+
+        unique_file file {fds_file_init(), &fds_file_close};
+        if (!file) {
+            throw std::runtime_error("fds_file_init() has failed");
+        }
+
+        int ret = fds_file_set_iemgr(file.get(), copy.get());
+        if (ret != FDS_OK) {
+            throw std::runtime_error("fds_file_set_iemgr() has failed: " + std::to_string(ret));
+        }
+
+        m_iemgrs.push_back(copy);
+        m_readers.push_back(std::move(file));
+    }
+
+    try {
+        for (unsigned int i = 0; i < threads; ++i) {
+            m_threads.emplace_back(&Prefetcher::thread_main, this, i);
+        }
+    } catch (const std::system_error &ex) {
+        stop();
+        throw std::runtime_error("Failed to start a reading thread: " + std::string(ex.what()));
+    }
+}
+
+Prefetcher::~Prefetcher()
+{
+    stop();
+}
+
+/**
+ * @brief Stop and join all threads
+ */
+void
+Prefetcher::stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+
+    m_cv_space.notify_all();
+
+    for (auto &thread : m_threads) {
+        thread.join();
+    }
+
+    m_threads.clear();
+}
+
+struct fds_drec *
+Prefetcher::next_record()
+{
+    while (true) {
+        if (m_batch && m_batch->pos < m_batch->records.size()) {
+            return &m_batch->records[m_batch->pos++];
+        }
+
+        std::unique_lock<std::mutex> lock(m_mutex);
+
+        while (true) {
+            if (m_slot_idx >= m_slots.size()) {
+                return nullptr;
+            }
+
+            Slot &slot = m_slots[m_slot_idx];
+
+            if (!slot.batches.empty()) {
+                if (m_retain && m_batch) {
+                    m_retained.push_back(std::move(m_batch));
+                }
+
+                // The previous batch is not used anymore (unless retained)
+                m_batch = std::move(slot.batches.front());
+                slot.batches.pop_front();
+                m_cv_space.notify_all();
+                break;
+            }
+
+            if (slot.done) {
+                m_slot_idx++;
+
+                if (slot.error) {
+                    std::exception_ptr error = slot.error;
+                    slot.error = nullptr;
+                    std::rethrow_exception(error);
+                }
+                continue;
+            }
+
+            m_cv_data.wait(lock);
+        }
+    }
+}
+
+/**
+ * @brief Main function of a reading thread
+ * @param[in] idx Index of the thread
+ */
+void
+Prefetcher::thread_main(size_t idx)
+{
+    fds_file_t *file = m_readers[idx].get();
+
+    while (true) {
+        size_t file_idx;
+        std::exception_ptr error;
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (m_stop || m_next_file >= m_files.size()) {
+                break;
+            }
+
+            file_idx = m_next_file++;
+        }
+
+        try {
+            read_file(file, file_idx);
+        } catch (...) {
+            error = std::current_exception();
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_slots[file_idx].done = true;
+            m_slots[file_idx].error = error;
+        }
+
+        m_cv_data.notify_all();
+    }
+}
+
+/**
+ * @brief Read records of a file and pass them to the consumer (called by a thread)
+ * @param[in] file     File handler
+ * @param[in] file_idx Index of the file
+ */
+void
+Prefetcher::read_file(fds_file_t *file, size_t file_idx)
+{
+    const std::string &path = m_files[file_idx];
+    BlockFilter block_filter;
+    shared_tsnapshot snapshot;
+    struct fds_drec rec;
+    int ret;
+
+    ret = fds_file_open(file, path.c_str(), FDS_FILE_READ);
+    if (ret != FDS_OK) {
+        const std::string err_msg = fds_file_error(file);
+        std::cerr << "fds_file_open('" << path << "') failed: " << err_msg << std::endl;
+        return;
+    }
+
+    if (!block_filter.open(path, m_query)) {
+        // No record of the file can match the filter
+        return;
+    }
+
+    std::unique_ptr<Batch> batch {new Batch};
+    ProfileCounters profile;
+    uint64_t start = profile_start();
+
+    while ((ret = fds_file_read_rec(file, &rec, NULL)) == FDS_OK) {
+        if (block_filter.skip_next()) {
+            continue;
+        }
+
+        if (BATCH_SIZE - batch->used < rec.size) {
+            // Waiting for the consumer is not a part of reading
+            profile.stop(ProfileStage::read, start, 0);
+            if (!push_batch(file_idx, batch)) {
+                return;
+            }
+            start = profile_start();
+        }
+
+        // Consecutive records usually share the same snapshot
+        const struct fds_template *tmplt = rec.tmplt;
+        const struct fds_template *cached = nullptr;
+
+        if (snapshot) {
+            cached = fds_tsnapshot_template_get(snapshot.get(), tmplt->id);
+        }
+
+        if (!cached
+                || cached->raw.length != tmplt->raw.length
+                || std::memcmp(cached->raw.data, tmplt->raw.data, tmplt->raw.length) != 0) {
+            snapshot = shared_tsnapshot{
+                fds_tsnapshot_deep_copy(rec.snap),
+                &fds_tsnapshot_destroy};
+
+            if (!snapshot) {
+                throw std::runtime_error("fds_tsnapshot_deep_copy() has failed");
+            }
+
+            cached = fds_tsnapshot_template_get(snapshot.get(), tmplt->id);
+        }
+
+        if (batch->snapshots.empty() || batch->snapshots.back() != snapshot) {
+            batch->snapshots.push_back(snapshot);
+        }
+
+        uint8_t *data = batch->data.get() + batch->used;
+        std::memcpy(data, rec.data, rec.size);
+        batch->used += rec.size;
+
+        rec.data = data;
+        rec.tmplt = cached;
+        rec.snap = snapshot.get();
+        batch->records.push_back(rec);
+
+        start = profile.stop(ProfileStage::read, start, 1, rec.size);
+    }
+
+    if (ret != FDS_EOC) {
+        throw std::runtime_error("fds_file_read_rec() has failed: " + std::to_string(ret));
+    }
+
+    if (!batch->records.empty()) {
+        push_batch(file_idx, batch);
+    }
+}
+
+/**
+ * @brief Pass a batch to the consumer and replace it with an empty one
+ *
+ * If the queue of the file is full, wait until the consumer takes a batch.
+ * @param[in]    file_idx Index of the file
+ * @param[inout] batch    The batch
+ * @return False if the prefetcher is being stopped
+ */
+bool
+Prefetcher::push_batch(size_t file_idx, std::unique_ptr<Batch> &batch)
+{
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        Slot &slot = m_slots[file_idx];
+
+        m_cv_space.wait(lock, [&]() {
+            return m_stop || slot.batches.size() < BATCHES_MAX;
+        });
+
+        if (m_stop) {
+            return false;
+        }
+
+        slot.batches.push_back(std::move(batch));
+    }
+
+    m_cv_data.notify_all();
+    batch.reset(new Batch);
+    return true;
+}
+
+} // fdsdump
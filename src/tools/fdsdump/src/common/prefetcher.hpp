@@ -0,0 +1,114 @@
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <libfds.h>
+
+#include "common.hpp"
+#include "fileIndex.hpp"
+#include "flow.hpp"
+
+namespace fdsdump {
+
+/**
+ * @brief Read-ahead of flow records of multiple files by a pool of threads.
+ *
+ * Each thread takes the next unprocessed file, reads (i.e. decompresses) its
+ * records and copies them into batches, which are passed to the consumer by
+ * a bounded queue of the file. Records are returned in the same order as if
+ * the files were read sequentially.
+ *
+ * Copies of records refer to private copies of template snapshots. By default,
+ * a batch is released when its records have been consumed, see retain_records().
+ */
+class Prefetcher {
+public:
+    /**
+     * @brief Start reading files.
+     * @param[in] iemgr   Information Element manager (copied for each thread)
+     * @param[in] files   Files to read
+     * @param[in] query   Query to skip blocks of files based on their index
+     * @param[in] threads Number of reading threads
+     */
+    Prefetcher(
+        const shared_iemgr &iemgr,
+        std::vector<std::string> files,
+        const IndexQuery &query,
+        unsigned int threads);
+    ~Prefetcher();
+
+    Prefetcher(const Prefetcher &) = delete;
+    Prefetcher &operator=(const Prefetcher &) = delete;
+
+    /**
+     * @brief Keep batches of consumed records.
+     *
+     * Records returned by next_record() then remain valid as long as the
+     * prefetcher exists, so the consumer can refer to them instead of making
+     * its own copies. Memory of all read records (including the ones rejected
+     * by the consumer) is held.
+     * @note Must be called before the first record is read.
+     */
+    void
+    retain_records() { m_retain = true; };
+
+    /**
+     * @brief Get the next record.
+     *
+     * The record remains valid until the next call (or as long as the
+     * prefetcher exists, see retain_records()).
+     * @return Pointer to the record or nullptr (no more records)
+     * @throw std::runtime_error if a file cannot be read
+     */
+    struct fds_drec *
+    next_record();
+
+private:
+    struct Batch;
+
+    /** @brief Batches of a file */
+    struct Slot {
+        std::deque<std::unique_ptr<Batch>> batches;
+        bool done = false;
+        std::exception_ptr error;
+    };
+
+    std::vector<std::string> m_files;
+    IndexQuery m_query;
+
+    std::vector<shared_iemgr> m_iemgrs;
+    std::vector<unique_file> m_readers;
+    std::vector<std::thread> m_threads;
+
+    std::mutex m_mutex;
+    std::condition_variable m_cv_data;
+    std::condition_variable m_cv_space;
+    std::vector<Slot> m_slots;
+    size_t m_next_file = 0;
+    bool m_stop = false;
+
+    /** Index of the file being consumed */
+    size_t m_slot_idx = 0;
+    /** Batch being consumed */
+    std::unique_ptr<Batch> m_batch;
+    /** Keep consumed batches */
+    bool m_retain = false;
+    /** Consumed batches */
+    std::vector<std::unique_ptr<Batch>> m_retained;
+
+    void stop();
+    void thread_main(size_t idx);
+    void read_file(fds_file_t *file, size_t file_idx);
+    bool push_batch(size_t file_idx, std::unique_ptr<Batch> &batch);
+};
+
+} // fdsdump
@@ -0,0 +1,146 @@
+
+#include <algorithm>
+#include <cstdio>
+#include <mutex>
+
+#include "profiler.hpp"
+
+namespace fdsdump {
+
+bool g_profile_enabled = false;
+
+/** Accumulated counters of destroyed components and hash tables */
+static struct {
+    std::mutex mutex;
+    uint64_t ticks[PROFILE_STAGES] = {};
+    uint64_t records[PROFILE_STAGES] = {};
+    uint64_t bytes[PROFILE_STAGES] = {};
+
+    size_t tables = 0;
+    ProfileTableStats table_sum;
+    ProfileTableStats table_largest;
+
+    uint64_t start_ticks;
+    std::chrono::steady_clock::time_point start_time;
+} g_profile;
+
+static const char *const g_stage_names[PROFILE_STAGES] = {
+    "read",
+    "wait (read-ahead)",
+    "filter",
+    "keys",
+    "hash",
+    "values",
+    "sort",
+    "print",
+};
+
+void
+profile_enable()
+{
+    g_profile.start_ticks = profile_ticks();
+    g_profile.start_time = std::chrono::steady_clock::now();
+    g_profile_enabled = true;
+}
+
+ProfileCounters::~ProfileCounters()
+{
+    if (!g_profile_enabled) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(g_profile.mutex);
+    for (size_t i = 0; i < PROFILE_STAGES; ++i) {
+        g_profile.ticks[i] += m_counters[i].ticks;
+        g_profile.records[i] += m_counters[i].records;
+        g_profile.bytes[i] += m_counters[i].bytes;
+    }
+}
+
+void
+profile_add_table(const ProfileTableStats &stats)
+{
+    if (!g_profile_enabled) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(g_profile.mutex);
+    ProfileTableStats &sum = g_profile.table_sum;
+
+    g_profile.tables++;
+    sum.records += stats.records;
+    sum.slots += stats.slots;
+    sum.lookups += stats.lookups;
+    sum.probes += stats.probes;
+    sum.max_probe = std::max(sum.max_probe, stats.max_probe);
+    sum.expansions += stats.expansions;
+
+    if (stats.records >= g_profile.table_largest.records) {
+        g_profile.table_largest = stats;
+    }
+}
+
+void
+profile_report(std::ostream &out)
+{
+    std::lock_guard<std::mutex> lock(g_profile.mutex);
+    char line[256];
+
+    const std::chrono::duration<double> wall = std::chrono::steady_clock::now() - g_profile.start_time;
+    const uint64_t wall_ticks = profile_ticks() - g_profile.start_ticks;
+    const double ticks_per_sec = (wall.count() > 0) ? wall_ticks / wall.count() : 1.0;
+
+    uint64_t total_ticks = 0;
+    for (size_t i = 0; i < PROFILE_STAGES; ++i) {
+        total_ticks += g_profile.ticks[i];
+    }
+
+    out << "Profile (wall time " << wall.count() << " s, times summed over threads):\n";
+    snprintf(line, sizeof(line), "  %-18s %10s %6s %14s %14s %12s\n",
+        "Stage", "Time [s]", "Share", "Records", "Records/s", "MB/s");
+    out << line;
+
+    for (size_t i = 0; i < PROFILE_STAGES; ++i) {
+        if (g_profile.ticks[i] == 0 && g_profile.records[i] == 0) {
+            continue;
+        }
+
+        const double secs = g_profile.ticks[i] / ticks_per_sec;
+        const double share = (total_ticks > 0) ? 100.0 * g_profile.ticks[i] / total_ticks : 0.0;
+        const double rps = (secs > 0) ? g_profile.records[i] / secs : 0.0;
+        const double mbps = (secs > 0) ? g_profile.bytes[i] / secs / 1e6 : 0.0;
+
+        snprintf(line, sizeof(line), "  %-18s %10.3f %5.1f%% %14llu %14.0f %12.1f\n",
+            g_stage_names[i], secs, share,
+            static_cast<unsigned long long>(g_profile.records[i]), rps, mbps);
+        out << line;
+    }
+
+    if (g_profile.tables == 0) {
+        out.flush();
+        return;
+    }
+
+    const ProfileTableStats &sum = g_profile.table_sum;
+    const ProfileTableStats &largest = g_profile.table_largest;
+
+    out << "Hash tables: " << g_profile.tables << "\n";
+    snprintf(line, sizeof(line), "  load factor:       %.3f (%llu records in %llu slots of the largest table)\n",
+        (largest.slots > 0) ? double(largest.records) / largest.slots : 0.0,
+        static_cast<unsigned long long>(largest.records),
+        static_cast<unsigned long long>(largest.slots));
+    out << line;
+    snprintf(line, sizeof(line), "  lookups:           %llu\n",
+        static_cast<unsigned long long>(sum.lookups));
+    out << line;
+    snprintf(line, sizeof(line), "  probe length:      %.3f blocks on average, %llu at most\n",
+        (sum.lookups > 0) ? double(sum.probes) / sum.lookups : 0.0,
+        static_cast<unsigned long long>(sum.max_probe));
+    out << line;
+    snprintf(line, sizeof(line), "  resizes:           %llu\n",
+        static_cast<unsigned long long>(sum.expansions));
+    out << line;
+    out.flush();
+}
+
+} // fdsdump
@@ -0,0 +1,152 @@
+
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+namespace fdsdump {
+
+/**
+ * @brief Stages of a query measured by the profiler (see --profile).
+ */
+enum class ProfileStage {
+    read,       ///< Reading and decompression of records
+    wait,       ///< Waiting for records read ahead by other threads
+    filter,     ///< Evaluation of the filter and biflow autoignore
+    keys,       ///< Building of aggregation keys
+    hash,       ///< Lookup of aggregation keys in the hash table
+    values,     ///< Update of aggregated values
+    sort,       ///< Sorting of records
+    print,      ///< Formatting and output of records
+};
+
+/** @brief Number of profile stages */
+static constexpr size_t PROFILE_STAGES = 8;
+
+/**
+ * @brief Statistics of a hash table of the aggregator.
+ */
+struct ProfileTableStats {
+    uint64_t records = 0;       ///< Number of stored records
+    uint64_t slots = 0;         ///< Number of slots (i.e. record capacity)
+    uint64_t lookups = 0;       ///< Number of lookups
+    uint64_t probes = 0;        ///< Number of blocks visited by lookups
+    uint64_t max_probe = 0;     ///< Maximal number of blocks visited by a lookup
+    uint64_t expansions = 0;    ///< Number of expansions (resizes) of the table
+};
+
+/** @brief Profiling is enabled (do not modify, see profile_enable()) */
+extern bool g_profile_enabled;
+
+/**
+ * @brief Enable profiling (before any measurement).
+ */
+void
+profile_enable();
+
+/**
+ * @brief Read a cheap monotonic tick counter.
+ *
+ * The time stamp counter is used on x86, the virtual counter on AArch64 and
+ * a steady clock (in nanoseconds) elsewhere. Ticks are converted to seconds
+ * when the report is printed.
+ */
+static inline uint64_t
+profile_ticks()
+{
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#elif defined(__aarch64__)
+    uint64_t value;
+    __asm__ __volatile__ ("mrs %0, cntvct_el0" : "=r"(value));
+    return value;
+#else
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+/**
+ * @brief Get the start of a measurement.
+ * @return Current ticks or 0 if profiling is disabled.
+ */
+static inline uint64_t
+profile_start()
+{
+    return g_profile_enabled ? profile_ticks() : 0;
+}
+
+/**
+ * @brief Profile counters of one component (e.g. a flow provider).
+ *
+ * The counters are private to their owner (i.e. a single thread), so they are
+ * updated without any synchronization. They are added to the report when the
+ * object is destroyed.
+ */
+class ProfileCounters {
+public:
+    ProfileCounters() = default;
+    ~ProfileCounters();
+
+    ProfileCounters(const ProfileCounters &) = delete;
+    ProfileCounters &operator=(const ProfileCounters &) = delete;
+
+    /**
+     * @brief Finish a measurement of a stage.
+     *
+     * Does nothing if profiling is disabled.
+     * @param[in] stage    The stage
+     * @param[in] start    Start of the measurement (see profile_start())
+     * @param[in] records  Number of processed records
+     * @param[in] bytes    Number of processed bytes
+     * @return Current ticks, i.e. the start of the next measurement.
+     */
+    uint64_t
+    stop(ProfileStage stage, uint64_t start, uint64_t records = 1, uint64_t bytes = 0)
+    {
+        if (!g_profile_enabled) {
+            return 0;
+        }
+
+        const uint64_t now = profile_ticks();
+        Counter &counter = m_counters[static_cast<size_t>(stage)];
+        counter.ticks += now - start;
+        counter.records += records;
+        counter.bytes += bytes;
+        return now;
+    }
+
+private:
+    struct Counter {
+        uint64_t ticks = 0;
+        uint64_t records = 0;
+        uint64_t bytes = 0;
+    };
+
+    Counter m_counters[PROFILE_STAGES];
+};
+
+/**
+ * @brief Add statistics of a hash table to the report.
+ * @param[in] stats  The statistics
+ */
+void
+profile_add_table(const ProfileTableStats &stats);
+
+/**
+ * @brief Print the profile report.
+ *
+ * Times of stages are summed over all threads, records/s and bytes/s are
+ * throughputs of a stage on a single thread.
+ * @param[in] out  Output stream
+ */
+void
+profile_report(std::ostream &out);
+
+} // fdsdump
@@ -0,0 +1,229 @@
+
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+#include <common/common.hpp>
+
+#include "arrowPrinter.hpp"
+
+namespace fdsdump {
+namespace lister {
+
+ArrowPrinter::ArrowPrinter(
+    const shared_iemgr &iemgr,
+    const std::string &args,
+    ColumnWriter::Format format) :
+    m_name((format == ColumnWriter::Format::arrow) ? "Arrow" : "Parquet"),
+    m_writer(format)
+{
+    std::string args_fields;
+    std::string args_opts;
+    size_t delim_pos;
+
+    delim_pos = args.find(';');
+    args_fields = args.substr(0, delim_pos);
+    args_opts = (delim_pos != std::string::npos)
+        ? args.substr(delim_pos + 1, std::string::npos)
+        : "";
+
+    parse_fields(args_fields, iemgr);
+    parse_opts(args_opts);
+}
+
+void
+ArrowPrinter::parse_fields(const std::string &str, const shared_iemgr &iemgr)
+{
+    if (str.empty()) {
+        throw std::invalid_argument(m_name + " output: no output fields defined");
+    }
+
+    for (const std::string &name : string_split(str, ",")) {
+        m_fields.emplace_back(name, iemgr);
+        const Field &field = m_fields.back();
+
+        switch (field.get_type()) {
+        case FieldType::num_unsigned:
+            m_writer.add_column(name, ColumnType::uint64);
+            break;
+        case FieldType::num_signed:
+            m_writer.add_column(name, ColumnType::int64);
+            break;
+        case FieldType::num_float:
+            m_writer.add_column(name, ColumnType::float64);
+            break;
+        case FieldType::boolean:
+            m_writer.add_column(name, ColumnType::boolean);
+            break;
+        case FieldType::datetime:
+            m_writer.add_column(name, ColumnType::timestamp);
+            break;
+        case FieldType::macaddr:
+            m_writer.add_column(name, ColumnType::fixed, 6);
+            break;
+        case FieldType::ipaddr:
+            m_writer.add_column(name, ColumnType::fixed, 16);
+            break;
+        case FieldType::string:
+            m_writer.add_column(name, ColumnType::string);
+            break;
+        default:
+            // Octet arrays, lists and fields of unknown type
+            m_writer.add_column(name, ColumnType::binary);
+            break;
+        }
+    }
+}
+
+void
+ArrowPrinter::parse_opts(const std::string &str)
+{
+    if (str.empty()) {
+        return;
+    }
+
+    for (const std::string &opt_raw : string_split(str, ",")) {
+        std::string opt = string_trim_copy(opt_raw);
+
+        if (strcasecmp(opt.c_str(), "no-biflow-split") == 0) {
+            m_biflow_split = false;
+        } else {
+            throw std::invalid_argument(m_name + " output: unknown option '" + opt + "'");
+        }
+    }
+}
+
+void
+ArrowPrinter::print_prologue()
+{
+    m_writer.open();
+}
+
+void
+ArrowPrinter::print_record(struct fds_drec *rec, bool reverse)
+{
+    for (auto &field : m_fields) {
+        const FieldType type = field.get_type();
+        unsigned int count = 0;
+
+        auto cb = [this, &count, type](const struct fds_drec_field &drec_field) -> void {
+            if (count++ == 0) {
+                append_value(drec_field, type);
+            }
+        };
+
+        field.for_each(rec, cb, reverse);
+
+        if (count == 0) {
+            // Not found
+            m_writer.append_null();
+        }
+    }
+
+    m_writer.end_row();
+}
+
+unsigned int
+ArrowPrinter::print_record(Flow *flow)
+{
+    switch (flow->dir) {
+    case DIRECTION_NONE:
+        return 0;
+    case DIRECTION_FWD:
+        print_record(&flow->rec, false);
+        return 1;
+    case DIRECTION_REV:
+        print_record(&flow->rec, true);
+        return 1;
+    case DIRECTION_BOTH:
+        if (m_biflow_split) {
+            print_record(&flow->rec, false);
+            print_record(&flow->rec, true);
+            return 2;
+        } else {
+            print_record(&flow->rec, false);
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+void
+ArrowPrinter::print_epilogue()
+{
+    m_writer.close();
+}
+
+void
+ArrowPrinter::append_value(const struct fds_drec_field &field, FieldType type)
+{
+    switch (type) {
+    case FieldType::num_unsigned: {
+        uint64_t value;
+        if (fds_get_uint_be(field.data, field.size, &value) != FDS_OK) {
+            break;
+        }
+        m_writer.append_uint(value);
+        return;
+    }
+    case FieldType::num_signed: {
+        int64_t value;
+        if (fds_get_int_be(field.data, field.size, &value) != FDS_OK) {
+            break;
+        }
+        m_writer.append_int(value);
+        return;
+    }
+    case FieldType::num_float: {
+        double value;
+        if (fds_get_float_be(field.data, field.size, &value) != FDS_OK) {
+            break;
+        }
+        m_writer.append_float(value);
+        return;
+    }
+    case FieldType::boolean: {
+        bool value;
+        if (fds_get_bool(field.data, field.size, &value) != FDS_OK) {
+            break;
+        }
+        m_writer.append_bool(value);
+        return;
+    }
+    case FieldType::datetime: {
+        uint64_t value;
+        if (fds_get_datetime_lp_be(field.data, field.size, field.info->def->data_type, &value) != FDS_OK) {
+            break;
+        }
+        m_writer.append_timestamp(value);
+        return;
+    }
+    case FieldType::macaddr:
+        if (field.size != 6) {
+            break;
+        }
+        m_writer.append_bytes(field.data, field.size);
+        return;
+    case FieldType::ipaddr:
+        if (field.size == 16) {
+            m_writer.append_bytes(field.data, field.size);
+            return;
+        } else if (field.size == 4) {
+            uint8_t mapped[16] = {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0xFF, 0xFF};
+            memcpy(&mapped[12], field.data, 4);
+            m_writer.append_bytes(mapped, sizeof(mapped));
+            return;
+        }
+        break;
+    default:
+        m_writer.append_bytes(field.data, field.size);
+        return;
+    }
+
+    // Invalid value
+    m_writer.append_null();
+}
+
+} // lister
+} // fdsdump
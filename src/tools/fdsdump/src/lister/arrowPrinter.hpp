@@ -0,0 +1,51 @@
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include <common/columnWriter.hpp>
+#include <common/field.hpp>
+
+#include "printer.hpp"
+
+namespace fdsdump {
+namespace lister {
+
+/**
+ * @brief Printer of selected fields into an Apache Arrow or Parquet file.
+ *
+ * Values are stored as typed columns (i.e. without conversion to text).
+ * IP addresses are stored as 16 bytes, IPv4 addresses are IPv4-mapped.
+ */
+class ArrowPrinter : public Printer {
+public:
+    ArrowPrinter(const shared_iemgr &iemgr, const std::string &args, ColumnWriter::Format format);
+
+    virtual
+    ~ArrowPrinter() = default;
+
+    virtual void
+    print_prologue() override;
+
+    virtual unsigned int
+    print_record(Flow *flow) override;
+
+    virtual void
+    print_epilogue() override;
+
+private:
+    void parse_fields(const std::string &str, const shared_iemgr &iemgr);
+    void parse_opts(const std::string &str);
+
+    void print_record(struct fds_drec *rec, bool reverse);
+    void append_value(const struct fds_drec_field &field, FieldType type);
+
+    std::string m_name;
+    std::vector<Field> m_fields;
+    ColumnWriter m_writer;
+    bool m_biflow_split = true;
+};
+
+} // lister
+} // fdsdump
@@ -25,8 +25,6 @@ CsvPrinter::CsvPrinter(const shared_iemgr &iemgr, const std::string &args)
 
     parse_fields(args_fields, iemgr);
     parse_opts(args_opts);
-
-    m_buffer.reserve(1024);
 }
 
 CsvPrinter::~CsvPrinter()
@@ -99,13 +97,14 @@ CsvPrinter::print_prologue()
 
     for (const auto &field_info : m_fields) {
         if (field_cnt > 0) {
-            std::cout << ",";
+            m_buffer.push_back(',');
         }
-        std::cout << field_info.m_name;
+        m_buffer.append(field_info.m_name);
         field_cnt++;
     }
 
-    std::cout << '\n';
+    m_buffer.push_back('\n');
+    m_output.commit();
 }
 
 void
@@ -113,8 +112,6 @@ CsvPrinter::print_record(struct fds_drec *rec, bool reverse)
 {
     unsigned int field_cnt = 0;
 
-    m_buffer.clear();
-
     for (auto &field_info : m_fields) {
         if (field_cnt > 0) {
             m_buffer.push_back(',');
@@ -125,8 +122,8 @@ CsvPrinter::print_record(struct fds_drec *rec, bool reverse)
         field_cnt++;
     }
 
-
-    std::cout << m_buffer << '\n';
+    m_buffer.push_back('\n');
+    m_output.commit();
 }
 
 unsigned int
@@ -158,6 +155,7 @@ CsvPrinter::print_record(Flow *flow)
 void
 CsvPrinter::print_epilogue()
 {
+    m_output.flush();
 }
 
 void
@@ -259,31 +257,33 @@ CsvPrinter::append_octet_array(const fds_drec_field &field)
 void
 CsvPrinter::append_uint(const fds_drec_field &field)
 {
-    char buffer[32];
-    int ret;
+    uint64_t value;
 
-    ret = fds_uint2str_be(field.data, field.size, buffer, sizeof(buffer));
-    if (ret < 0) {
+    if (fds_get_uint_be(field.data, field.size, &value) != FDS_OK) {
         append_invalid();
         return;
     }
 
-    m_buffer.append(buffer);
+    const size_t pos = m_buffer.size();
+    m_buffer.resize(pos + FMT_LEN_UINT);
+    char *end = fmt_uint(&m_buffer[pos], value);
+    m_buffer.resize(end - &m_buffer[0]);
 }
 
 void
 CsvPrinter::append_int(const fds_drec_field &field)
 {
-    char buffer[32];
-    int ret;
+    int64_t value;
 
-    ret = fds_int2str_be(field.data, field.size, buffer, sizeof(buffer));
-    if (ret < 0) {
+    if (fds_get_int_be(field.data, field.size, &value) != FDS_OK) {
         append_invalid();
         return;
     }
 
-    m_buffer.append(buffer);
+    const size_t pos = m_buffer.size();
+    m_buffer.resize(pos + FMT_LEN_INT);
+    char *end = fmt_int(&m_buffer[pos], value);
+    m_buffer.resize(end - &m_buffer[0]);
 }
 
 void
@@ -323,8 +323,24 @@ CsvPrinter::append_boolean(const fds_drec_field &field)
 void
 CsvPrinter::append_timestamp(const fds_drec_field &field)
 {
-    if (m_format_timestamp) {
-        // Convert to formatted string
+    uint64_t time;
+    if (fds_get_datetime_lp_be(field.data, field.size, field.info->def->data_type, &time) != FDS_OK) {
+        append_invalid();
+        return;
+    }
+
+    const size_t pos = m_buffer.size();
+
+    if (!m_format_timestamp) {
+        // UNIX timestamp (in milliseconds)
+        m_buffer.resize(pos + FMT_LEN_UINT);
+        char *end = fmt_uint(&m_buffer[pos], time);
+        m_buffer.resize(end - &m_buffer[0]);
+        return;
+    }
+
+    if (time / 1000 > FMT_TIME_SEC_MAX) {
+        // Out of range of the fast formatter
         char buffer[FDS_CONVERT_STRLEN_DATE];
         int ret;
 
@@ -341,24 +357,12 @@ CsvPrinter::append_timestamp(const fds_drec_field &field)
         }
 
         m_buffer.append(buffer);
-
-    } else {
-        // Convert to UNIX timestamp (in milliseconds)
-        uint64_t time;
-        if (fds_get_datetime_lp_be(field.data, field.size, field.info->def->data_type, &time) != FDS_OK) {
-            append_invalid();
-            return;
-        }
-
-        time = htobe64(time); // Convert to network byte order and use fast libfds converter
-        char buffer[32];
-        if (fds_uint2str_be(&time, sizeof(time), buffer, sizeof(buffer)) < 0) {
-            append_invalid();
-            return;
-        }
-
-        m_buffer.append(buffer);
+        return;
     }
+
+    m_buffer.resize(pos + FMT_LEN_TIME);
+    char *end = m_time_formatter.format(&m_buffer[pos], time);
+    m_buffer.resize(end - &m_buffer[0]);
 }
 
 void
@@ -399,16 +403,24 @@ CsvPrinter::append_mac(const fds_drec_field &field)
 void
 CsvPrinter::append_ip(const fds_drec_field &field)
 {
-    char buffer[FDS_CONVERT_STRLEN_IP];
-    int ret;
+    const size_t pos = m_buffer.size();
+    char *end;
 
-    ret = fds_ip2str(field.data, field.size, buffer, sizeof(buffer));
-    if (ret < 0) {
+    switch (field.size) {
+    case 4U:
+        m_buffer.resize(pos + FMT_LEN_IPV4);
+        end = fmt_ipv4(&m_buffer[pos], field.data);
+        break;
+    case 16U:
+        m_buffer.resize(pos + FMT_LEN_IPV6);
+        end = fmt_ipv6(&m_buffer[pos], field.data);
+        break;
+    default:
         append_invalid();
         return;
     }
 
-    m_buffer.append(buffer);
+    m_buffer.resize(end - &m_buffer[0]);
 }
 
 void
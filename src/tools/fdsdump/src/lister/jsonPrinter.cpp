@@ -25,8 +25,6 @@ JsonPrinter::JsonPrinter(const shared_iemgr &iemgr, const std::string &args)
 
     parse_fields(args_fields, iemgr);
     parse_opts(args_opts);
-
-    m_buffer.reserve(1024);
 }
 
 JsonPrinter::~JsonPrinter()
@@ -95,7 +93,8 @@ JsonPrinter::parse_opts(const std::string &str)
 void
 JsonPrinter::print_prologue()
 {
-    std::cout << "[";
+    m_buffer.push_back('[');
+    m_output.commit();
 }
 
 void
@@ -103,7 +102,7 @@ JsonPrinter::print_record(struct fds_drec *rec, bool reverse)
 {
     unsigned int field_cnt = 0;
 
-    m_buffer.clear();
+    m_buffer.append((m_rec_printed++ > 0) ? ",\n " : "\n ");
     m_buffer.push_back('{');
 
     for (auto &field : m_fields) {
@@ -121,9 +120,7 @@ JsonPrinter::print_record(struct fds_drec *rec, bool reverse)
     }
 
     m_buffer.push_back('}');
-
-    std::cout << ((m_rec_printed++ > 0) ? ",\n " : "\n ");
-    std::cout << m_buffer;
+    m_output.commit();
 }
 
 unsigned int
@@ -155,7 +152,8 @@ JsonPrinter::print_record(Flow *flow)
 void
 JsonPrinter::print_epilogue()
 {
-    std::cout << "\n]\n";
+    m_buffer.append("\n]\n");
+    m_output.flush();
 }
 
 void
@@ -263,31 +261,33 @@ JsonPrinter::append_octet_array(const fds_drec_field &field)
 void
 JsonPrinter::append_uint(const fds_drec_field &field)
 {
-    char buffer[32];
-    int ret;
+    uint64_t value;
 
-    ret = fds_uint2str_be(field.data, field.size, buffer, sizeof(buffer));
-    if (ret < 0) {
+    if (fds_get_uint_be(field.data, field.size, &value) != FDS_OK) {
         append_invalid();
         return;
     }
 
-    m_buffer.append(buffer);
+    const size_t pos = m_buffer.size();
+    m_buffer.resize(pos + FMT_LEN_UINT);
+    char *end = fmt_uint(&m_buffer[pos], value);
+    m_buffer.resize(end - &m_buffer[0]);
 }
 
 void
 JsonPrinter::append_int(const fds_drec_field &field)
 {
-    char buffer[32];
-    int ret;
+    int64_t value;
 
-    ret = fds_int2str_be(field.data, field.size, buffer, sizeof(buffer));
-    if (ret < 0) {
+    if (fds_get_int_be(field.data, field.size, &value) != FDS_OK) {
         append_invalid();
         return;
     }
 
-    m_buffer.append(buffer);
+    const size_t pos = m_buffer.size();
+    m_buffer.resize(pos + FMT_LEN_INT);
+    char *end = fmt_int(&m_buffer[pos], value);
+    m_buffer.resize(end - &m_buffer[0]);
 }
 
 void
@@ -327,8 +327,24 @@ JsonPrinter::append_boolean(const fds_drec_field &field)
 void
 JsonPrinter::append_timestamp(const fds_drec_field &field)
 {
-    if (m_format_timestamp) {
-        // Convert to formatted string
+    uint64_t time;
+    if (fds_get_datetime_lp_be(field.data, field.size, field.info->def->data_type, &time) != FDS_OK) {
+        append_invalid();
+        return;
+    }
+
+    const size_t pos = m_buffer.size();
+
+    if (!m_format_timestamp) {
+        // UNIX timestamp (in milliseconds)
+        m_buffer.resize(pos + FMT_LEN_UINT);
+        char *end = fmt_uint(&m_buffer[pos], time);
+        m_buffer.resize(end - &m_buffer[0]);
+        return;
+    }
+
+    if (time / 1000 > FMT_TIME_SEC_MAX) {
+        // Out of range of the fast formatter
         char buffer[FDS_CONVERT_STRLEN_DATE];
         int ret;
 
@@ -347,25 +363,14 @@ JsonPrinter::append_timestamp(const fds_drec_field &field)
         m_buffer.push_back('"');
         m_buffer.append(buffer);
         m_buffer.push_back('"');
-
-
-    } else {
-        // Convert to UNIX timestamp (in milliseconds)
-        uint64_t time;
-        if (fds_get_datetime_lp_be(field.data, field.size, field.info->def->data_type, &time) != FDS_OK) {
-            append_invalid();
-            return;
-        }
-
-        time = htobe64(time); // Convert to network byte order and use fast libfds converter
-        char buffer[32];
-        if (fds_uint2str_be(&time, sizeof(time), buffer, sizeof(buffer)) < 0) {
-            append_invalid();
-            return;
-        }
-
-        m_buffer.append(buffer);
+        return;
     }
+
+    m_buffer.resize(pos + 1 + FMT_LEN_TIME + 1);
+    m_buffer[pos] = '"';
+    char *end = m_time_formatter.format(&m_buffer[pos + 1], time);
+    *end++ = '"';
+    m_buffer.resize(end - &m_buffer[0]);
 }
 
 void
@@ -432,18 +437,27 @@ JsonPrinter::append_mac(const fds_drec_field &field)
 void
 JsonPrinter::append_ip(const fds_drec_field &field)
 {
-    char buffer[FDS_CONVERT_STRLEN_IP];
-    int ret;
-
-    ret = fds_ip2str(field.data, field.size, buffer, sizeof(buffer));
-    if (ret < 0) {
+    const size_t pos = m_buffer.size();
+    char *end;
+
+    switch (field.size) {
+    case 4U:
+        m_buffer.resize(pos + 1 + FMT_LEN_IPV4 + 1);
+        m_buffer[pos] = '"';
+        end = fmt_ipv4(&m_buffer[pos + 1], field.data);
+        break;
+    case 16U:
+        m_buffer.resize(pos + 1 + FMT_LEN_IPV6 + 1);
+        m_buffer[pos] = '"';
+        end = fmt_ipv6(&m_buffer[pos + 1], field.data);
+        break;
+    default:
         append_invalid();
         return;
     }
 
-    m_buffer.push_back('"');
-    m_buffer.append(buffer);
-    m_buffer.push_back('"');
+    *end++ = '"';
+    m_buffer.resize(end - &m_buffer[0]);
 }
 
 void
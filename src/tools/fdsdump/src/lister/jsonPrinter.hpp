@@ -4,6 +4,8 @@
 #include <string>
 
 #include <common/field.hpp>
+#include <common/outputBuffer.hpp>
+#include <plugins/output/json/src/Format.hpp>
 
 #include "printer.hpp"
 
@@ -50,7 +52,9 @@ private:
     void append_unsupported();
 
     std::vector<Field> m_fields;
-    std::string m_buffer;
+    OutputBuffer m_output;
+    std::string &m_buffer = m_output.data();
+    TimeFormatter m_time_formatter;
     unsigned int m_rec_printed = 0;
     bool m_biflow_split = true;
     bool m_format_timestamp = true;
@@ -61,7 +61,10 @@ JsonRawPrinter::print_record(struct fds_drec *rec, uint32_t flags)
         throw std::runtime_error("JSON conversion failed: " + std::to_string(ret));
     }
 
-    std::cout << m_buffer << "\n";
+    std::string &output = m_output.data();
+    output.append(m_buffer, ret);
+    output.push_back('\n');
+    m_output.commit();
 }
 
 unsigned int
@@ -96,5 +99,11 @@ JsonRawPrinter::print_record(Flow *flow)
     return 0;
 }
 
+void
+JsonRawPrinter::print_epilogue()
+{
+    m_output.flush();
+}
+
 } // lister
 } // fdsdump
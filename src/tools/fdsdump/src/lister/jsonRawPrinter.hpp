@@ -3,6 +3,8 @@
 
 #include <string>
 
+#include <common/outputBuffer.hpp>
+
 #include "printer.hpp"
 
 namespace fdsdump {
@@ -22,7 +24,7 @@ public:
     print_record(Flow *flow) override;
 
     virtual void
-    print_epilogue() override {};
+    print_epilogue() override;
 
 private:
     void print_record(struct fds_drec *rec, uint32_t flags);
@@ -30,6 +32,7 @@ private:
     shared_iemgr m_iemgr {};
     char *m_buffer = nullptr;
     size_t m_buffer_size = 0;
+    OutputBuffer m_output;
 
     bool m_biflow_split = true;
     bool m_biflow_hide_reverse = false;
@@ -1,3 +1,5 @@
+#include <common/profiler.hpp>
+
 #include "lister.hpp"
 #include "printer.hpp"
 #include "storageSorted.hpp"
@@ -11,6 +13,7 @@ mode_list_unordered(const shared_iemgr &iemgr, const Options &opts, FlowProvider
     auto printer = printer_factory(iemgr, opts.get_output_specifier());
     const size_t rec_limit = opts.get_output_limit();
     size_t rec_printed = 0;
+    ProfileCounters profile;
 
     printer->print_prologue();
 
@@ -21,17 +24,22 @@ mode_list_unordered(const shared_iemgr &iemgr, const Options &opts, FlowProvider
             break;
         }
 
-        rec_printed += printer->print_record(flow);
+        const uint64_t start = profile_start();
+        const unsigned int printed = printer->print_record(flow);
+        profile.stop(ProfileStage::print, start, printed);
+        rec_printed += printed;
     }
 
+    const uint64_t start = profile_start();
     printer->print_epilogue();
+    profile.stop(ProfileStage::print, start, 0);
 }
 
 static void
 mode_list_ordered(const shared_iemgr &iemgr, const Options &opts, FlowProvider &flows)
 {
     StorageSorter sorter {opts.get_order_by(), iemgr};
-    StorageSorted storage {sorter, opts.get_output_limit()};
+    StorageSorted storage {sorter, opts.get_output_limit(), flows.has_stable_records()};
     auto printer = printer_factory(iemgr, opts.get_output_specifier());
 
     while (true) {
@@ -44,14 +52,22 @@ mode_list_ordered(const shared_iemgr &iemgr, const Options &opts, FlowProvider &
         storage.insert(flow);
     }
 
+    ProfileCounters profile;
+    uint64_t start = profile_start();
+    size_t rec_printed = 0;
+
+    storage.sort();
+    start = profile.stop(ProfileStage::sort, start, storage.size());
+
     printer->print_prologue();
 
     for (const auto &rec : storage) {
         const Flow *flow = &rec.get_flow_const();
-        printer->print_record(const_cast<Flow *>(flow));
+        rec_printed += printer->print_record(const_cast<Flow *>(flow));
     }
 
     printer->print_epilogue();
+    profile.stop(ProfileStage::print, start, rec_printed);
 }
 
 void
@@ -60,6 +76,7 @@ mode_list(const shared_iemgr &iemgr, const Options &opts)
     FlowProvider flows {iemgr};
 
     flows.set_biflow_autoignore(opts.get_biflow_autoignore());
+    flows.set_prefetch(opts.get_prefetch());
 
     if (!opts.get_input_filter().empty()) {
         flows.set_filter(opts.get_input_filter());
@@ -69,6 +86,12 @@ mode_list(const shared_iemgr &iemgr, const Options &opts)
         flows.add_file(it);
     }
 
+    if (!opts.get_order_by().empty() && opts.get_output_limit() == 0
+            && opts.get_input_filter().empty()) {
+        // All records are stored, so records read ahead are kept instead of copied
+        flows.set_stable_records(true);
+    }
+
     if (opts.get_order_by().empty()) {
         mode_list_unordered(iemgr, opts, flows);
     } else {
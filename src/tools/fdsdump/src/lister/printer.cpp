@@ -8,6 +8,9 @@
 #include <common/common.hpp>
 
 #include "printer.hpp"
+#ifdef FDSDUMP_ARROW
+#include "arrowPrinter.hpp"
+#endif
 #include "csvPrinter.hpp"
 #include "jsonPrinter.hpp"
 #include "jsonRawPrinter.hpp"
@@ -22,6 +25,14 @@ struct PrinterFactory {
 };
 
 static const std::vector<struct PrinterFactory> g_printers {
+#ifdef FDSDUMP_ARROW
+    {"arrow", [](const shared_iemgr &iemgr, const std::string &args) {
+        return new ArrowPrinter(iemgr, args, ColumnWriter::Format::arrow); }
+    },
+    {"parquet", [](const shared_iemgr &iemgr, const std::string &args) {
+        return new ArrowPrinter(iemgr, args, ColumnWriter::Format::parquet); }
+    },
+#endif
     {"csv", [](const shared_iemgr &iemgr, const std::string &args) {
         return new CsvPrinter(iemgr, args); }
     },
@@ -25,13 +25,38 @@ public:
      * @param rec      Flow data record to be stored
      * @param dir      Direction of the record to be considered.
      * @param snapshot Template snapshot that should be used
+     * @param buffer   Memory for the copy of the record (owned by the caller)
+     * @param capacity Size of the memory (at least the size of the record)
      */
     StorageRecord(
         const struct fds_drec &rec,
         enum Direction dir,
-        const shared_tsnapshot &snapshot);
+        const shared_tsnapshot &snapshot,
+        uint8_t *buffer,
+        size_t capacity);
+
+    /**
+     * @brief Create a storage record referring to an IPFIX Data Record
+     * without making a copy.
+     *
+     * @param rec Flow data record (must remain valid, including its template
+     *   snapshot, as long as the storage record exists)
+     * @param dir Direction of the record to be considered.
+     */
+    StorageRecord(const struct fds_drec &rec, enum Direction dir);
     ~StorageRecord() = default;
 
+    StorageRecord(StorageRecord &&) = default;
+    StorageRecord &operator=(StorageRecord &&) = default;
+
+    /** @brief Get memory holding the copy of the record (or the referred record). */
+    uint8_t *
+    get_buffer() const { return m_flow.rec.data; };
+
+    /** @brief Get size of the memory holding the copy of the record (0 = not a copy). */
+    size_t
+    get_capacity() const { return m_capacity; };
+
     Flow &
     get_flow() { return m_flow; };
 
@@ -39,7 +64,7 @@ public:
     get_flow_const() const { return m_flow; };
 
 private:
-    std::unique_ptr<uint8_t[]> m_data;
+    size_t m_capacity;
     shared_tsnapshot m_snapshot;
     Flow m_flow;
 };
@@ -1,15 +1,40 @@
 
+#include <algorithm>
 #include <cassert>
-#include <iterator>
+#include <cstring>
+#include <stdexcept>
 
 #include "storageSorted.hpp"
 
 namespace fdsdump {
 namespace lister {
 
-StorageSorted::StorageSorted(StorageSorter sorter, size_t capacity)
-    : m_sorter{sorter}, m_records{m_sorter}, m_capacity{capacity}
+/**
+ * @brief Round size of a record buffer up to the nearest power of two.
+ *
+ * Buffers of records dropped from a full heap are reused by new records,
+ * rounding makes it more likely that the new record fits.
+ */
+static size_t
+buffer_capacity(size_t size)
 {
+    size_t capacity = 64;
+
+    while (capacity < size) {
+        capacity *= 2;
+    }
+
+    return capacity;
+}
+
+StorageSorted::StorageSorted(StorageSorter sorter, size_t capacity, bool in_place)
+    : m_sorter{sorter}, m_capacity{capacity}, m_in_place{in_place}
+{
+    assert((!m_in_place || m_capacity == 0) && "Records of a heap must be copied");
+
+    if (m_capacity != 0) {
+        m_records.reserve(m_capacity);
+    }
 }
 
 void
@@ -30,41 +55,105 @@ StorageSorted::insert(struct Flow *flow)
     flow->dir = dir_backup;
 }
 
+void
+StorageSorted::sort()
+{
+    auto cmp = [this](const StorageRecord &lhs, const StorageRecord &rhs) {
+        return m_sorter(lhs, rhs);
+    };
+
+    if (m_capacity != 0) {
+        std::sort_heap(m_records.begin(), m_records.end(), cmp);
+    } else {
+        std::stable_sort(m_records.begin(), m_records.end(), cmp);
+    }
+}
+
 void
 StorageSorted::insert_single_direction(struct Flow *flow)
 {
     // Exactly single direction must be specified
     assert(flow->dir == DIRECTION_FWD || flow->dir == DIRECTION_REV);
 
+    auto cmp = [this](const StorageRecord &lhs, const StorageRecord &rhs) {
+        return m_sorter(lhs, rhs);
+    };
+
+    if (m_in_place) {
+        m_records.emplace_back(flow->rec, flow->dir);
+        return;
+    }
+
     if (m_capacity == 0 || m_records.size() < m_capacity) {
-        insert_storage_record(flow);
+        const size_t capacity = buffer_capacity(flow->rec.size);
+        insert_storage_record(flow, m_allocator.allocate(capacity), capacity);
+
+        if (m_capacity != 0) {
+            std::push_heap(m_records.begin(), m_records.end(), cmp);
+        }
         return;
     }
 
-    const auto last_iter = std::prev(m_records.end());
-    const Flow &last_rec = last_iter->get_flow_const();
+    // The last record (based on the sorter) is on the top of the heap
+    const Flow &last_rec = m_records.front().get_flow_const();
 
     if (!m_sorter(*flow, last_rec)) {
         // Don't insert the record as it should be placed after the last one
         return;
     }
 
-    m_records.erase(last_iter);
-    insert_storage_record(flow);
+    std::pop_heap(m_records.begin(), m_records.end(), cmp);
+
+    uint8_t *buffer = m_records.back().get_buffer();
+    size_t capacity = m_records.back().get_capacity();
+    m_records.pop_back();
+
+    if (capacity < flow->rec.size) {
+        capacity = buffer_capacity(flow->rec.size);
+        buffer = m_allocator.allocate(capacity);
+    }
+
+    insert_storage_record(flow, buffer, capacity);
+    std::push_heap(m_records.begin(), m_records.end(), cmp);
 }
 
 void
-StorageSorted::insert_storage_record(struct Flow *flow)
+StorageSorted::insert_storage_record(struct Flow *flow, uint8_t *buffer, size_t capacity)
 {
-    shared_tsnapshot snapshot{
+    m_records.emplace_back(flow->rec, flow->dir, get_snapshot(flow), buffer, capacity);
+}
+
+/**
+ * @brief Get a copy of the template snapshot of a flow record.
+ *
+ * Consecutive records usually share the same snapshot, so the last copy is
+ * reused as long as it contains the same template as the record.
+ */
+const shared_tsnapshot &
+StorageSorted::get_snapshot(struct Flow *flow)
+{
+    const struct fds_template *tmplt = flow->rec.tmplt;
+    const struct fds_template *cached = nullptr;
+
+    if (m_snapshot) {
+        cached = fds_tsnapshot_template_get(m_snapshot.get(), tmplt->id);
+    }
+
+    if (cached
+            && cached->raw.length == tmplt->raw.length
+            && std::memcmp(cached->raw.data, tmplt->raw.data, tmplt->raw.length) == 0) {
+        return m_snapshot;
+    }
+
+    m_snapshot = shared_tsnapshot{
         fds_tsnapshot_deep_copy(flow->rec.snap),
         &fds_tsnapshot_destroy};
 
-    if (!snapshot) {
+    if (!m_snapshot) {
         throw std::runtime_error("fds_tsnapshot_deep_copy() has failed");
     }
 
-    m_records.emplace(flow->rec, flow->dir, snapshot);
+    return m_snapshot;
 }
 
 } // lister
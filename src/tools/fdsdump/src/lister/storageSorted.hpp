@@ -1,7 +1,9 @@
 
 #pragma once
 
-#include <set>
+#include <vector>
+
+#include <aggregator/arenaAllocator.hpp>
 
 #include "storageRecord.hpp"
 #include "storageSorter.hpp"
@@ -12,10 +14,17 @@ namespace lister {
 
 /**
  * @brief Sorted storage of flow records
+ *
+ * Copies of records are placed in an arena. If the capacity is limited, the
+ * records form a binary heap with the last record (based on the sorter) on
+ * the top, so a record that would be placed after it can be rejected
+ * immediately. Otherwise, the records are simply appended (or only referred
+ * to, if they remain valid for the lifetime of the storage). In both cases,
+ * the records are put in order by sort().
  */
 class StorageSorted {
 public:
-    using Storage = std::multiset<StorageRecord, StorageSorter>;
+    using Storage = std::vector<StorageRecord>;
 
     /**
      * @brief Create a storage for Flow Data records where the records are
@@ -24,12 +33,15 @@ public:
      * @param[in] sorter   Sorter of Flow Record
      * @param[in] capacity Maximal capacity of the storage. If zero, the
      *   storage capacity is not limited.
+     * @param[in] in_place Refer to inserted records instead of copying them.
+     *   The records must remain valid as long as the storage exists (see
+     *   FlowProvider::has_stable_records()). Only allowed if the capacity is
+     *   not limited.
      */
-    StorageSorted(StorageSorter sorter, size_t capacity = 0);
+    StorageSorted(StorageSorter sorter, size_t capacity = 0, bool in_place = false);
 
     /**
-     * @brief Insert a Flow Data record to the storage and place it based
-     * on the order given by the sorter.
+     * @brief Insert a Flow Data record to the storage.
      *
      * If the capacity has been reached and the new record would be placed
      * (based on the sorter) after the last record in the storage, no action
@@ -39,24 +51,39 @@ public:
      */
     void insert(struct Flow *flow);
 
+    /**
+     * @brief Put the stored records in order given by the sorter.
+     * @note Must be called after all records are inserted and before iteration.
+     */
+    void sort();
+
     /**
      * @brief Get an iterator to the first element of the storage.
      * @return Constant iterator
      */
-    Storage::iterator begin() const { return m_records.begin(); };
+    Storage::const_iterator begin() const { return m_records.begin(); };
     /**
      * @brief Get an iterator to the element following the last element the storage.
      * @return Constant iterator
      */
-    Storage::iterator end() const { return m_records.end(); };
+    Storage::const_iterator end() const { return m_records.end(); };
+    /**
+     * @brief Get the number of stored records.
+     */
+    size_t size() const { return m_records.size(); };
 
 private:
     StorageSorter m_sorter;
     Storage m_records;
     size_t m_capacity;
+    bool m_in_place;
+
+    aggregator::ArenaAllocator m_allocator;
+    shared_tsnapshot m_snapshot;
 
     void insert_single_direction(struct Flow *flow);
-    void insert_storage_record(struct Flow *flow);
+    void insert_storage_record(struct Flow *flow, uint8_t *buffer, size_t capacity);
+    const shared_tsnapshot &get_snapshot(struct Flow *flow);
 };
 
 } // lister
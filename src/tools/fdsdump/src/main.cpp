@@ -8,6 +8,7 @@
 
 #include <common/common.hpp>
 #include <common/filelist.hpp>
+#include <common/profiler.hpp>
 #include <lister/lister.hpp>
 #include <aggregator/mode.hpp>
 #include <statistics/mode.hpp>
@@ -49,6 +50,10 @@ main(int argc, char *argv[])
 
         iemgr = iemgr_prepare(std::string(fds_api_cfg_dir()));
 
+        if (options.get_profile()) {
+            profile_enable();
+        }
+
         switch (options.get_mode()) {
         case Options::Mode::list:
             lister::mode_list(iemgr, options);
@@ -62,6 +67,10 @@ main(int argc, char *argv[])
         default:
             throw std::runtime_error("Invalid mode");
         }
+
+        if (options.get_profile()) {
+            profile_report(std::cerr);
+        }
     } catch (const std::exception &ex) {
         std::cerr << "ERROR: " << ex.what() << std::endl;
         return EXIT_FAILURE;
@@ -1,11 +1,47 @@
 
+#include <algorithm>
+#include <cstdlib>
+#include <thread>
+
 #include <getopt.h>
+#include <strings.h>
 #include <unistd.h>
 
 #include "options.hpp"
 
 namespace fdsdump {
 
+/**
+ * @brief Parse a size in bytes with an optional unit (K, M or G, powers of 1024).
+ * @param[in] str The size
+ * @throw OptionsException if the size is malformed
+ */
+static size_t
+parse_size(const std::string &str)
+{
+    size_t pos = 0;
+    size_t value;
+
+    try {
+        value = std::stoull(str, &pos);
+    } catch (const std::logic_error &) {
+        throw OptionsException("invalid size '" + str + "'");
+    }
+
+    const std::string unit = str.substr(pos);
+    if (unit.empty()) {
+        return value;
+    } else if (strcasecmp(unit.c_str(), "K") == 0) {
+        return value << 10;
+    } else if (strcasecmp(unit.c_str(), "M") == 0) {
+        return value << 20;
+    } else if (strcasecmp(unit.c_str(), "G") == 0) {
+        return value << 30;
+    }
+
+    throw OptionsException("invalid size '" + str + "'");
+}
+
 Options::Options()
 {
     reset();
@@ -23,6 +59,7 @@ void Options::reset()
     m_mode = Mode::undefined;
 
     m_input_files.clear();
+    m_input_patterns.clear();
     m_input_filter.clear();
 
     m_output_limit = 0;
@@ -33,6 +70,20 @@ void Options::reset()
 
     m_biflow_autoignore = true;
 
+    m_threads = 1;
+    m_prefetch = 0;
+    m_approx_keys = 0;
+    m_memory_limit = 0;
+    m_spill_dir.clear();
+    m_expected_keys = 0;
+    m_ipv4_only = false;
+
+    m_partial_output.clear();
+    m_partial_inputs.clear();
+    m_cache_dir.clear();
+    m_follow_periods.clear();
+    m_profile = false;
+
     m_order_by.clear();
 }
 
@@ -48,6 +99,18 @@ void Options::parse(int argc, char *argv[])
 {
     enum long_opts_vals {
         OPT_BIFLOW_AUTOIGNORE_OFF = 256, // Value that cannot colide with chars
+        OPT_THREADS,
+        OPT_APPROX,
+        OPT_PREFETCH,
+        OPT_SAVE_PARTIAL,
+        OPT_MERGE_PARTIAL,
+        OPT_CACHE,
+        OPT_EXPECTED_KEYS,
+        OPT_IPV4_ONLY,
+        OPT_FOLLOW,
+        OPT_PROFILE,
+        OPT_MEMORY_LIMIT,
+        OPT_SPILL_DIR,
     };
     const struct option long_opts[] = {
         {"filter",               required_argument, NULL, 'F'},
@@ -55,6 +118,18 @@ void Options::parse(int argc, char *argv[])
         {"order",                required_argument, NULL, 'O'},
         {"limit",                required_argument, NULL, 'c'},
         {"no-biflow-autoignore", no_argument,       NULL, OPT_BIFLOW_AUTOIGNORE_OFF},
+        {"threads",              required_argument, NULL, OPT_THREADS},
+        {"approx",               required_argument, NULL, OPT_APPROX},
+        {"prefetch",             required_argument, NULL, OPT_PREFETCH},
+        {"save-partial",         required_argument, NULL, OPT_SAVE_PARTIAL},
+        {"merge-partial",        required_argument, NULL, OPT_MERGE_PARTIAL},
+        {"cache",                required_argument, NULL, OPT_CACHE},
+        {"expected-keys",        required_argument, NULL, OPT_EXPECTED_KEYS},
+        {"ipv4-only",            no_argument,       NULL, OPT_IPV4_ONLY},
+        {"follow",               optional_argument, NULL, OPT_FOLLOW},
+        {"profile",              no_argument,       NULL, OPT_PROFILE},
+        {"memory-limit",         required_argument, NULL, OPT_MEMORY_LIMIT},
+        {"spill-dir",            required_argument, NULL, OPT_SPILL_DIR},
         {0, 0, 0, 0},
     };
     const char *short_opts = "r:c:o:O:F:A:S:I";
@@ -64,6 +139,7 @@ void Options::parse(int argc, char *argv[])
         switch (opt) {
         case 'r':
             m_input_files.add_files(optarg);
+            m_input_patterns.push_back(optarg);
             break;
         case 'c':
             m_output_limit = std::stoull(optarg);
@@ -89,6 +165,45 @@ void Options::parse(int argc, char *argv[])
         case OPT_BIFLOW_AUTOIGNORE_OFF:
             m_biflow_autoignore = false;
             break;
+        case OPT_THREADS:
+            m_threads = std::stoul(optarg);
+            if (m_threads == 0) {
+                m_threads = std::max(1U, std::thread::hardware_concurrency());
+            }
+            break;
+        case OPT_APPROX:
+            m_approx_keys = std::stoull(optarg);
+            break;
+        case OPT_PREFETCH:
+            m_prefetch = std::stoul(optarg);
+            break;
+        case OPT_SAVE_PARTIAL:
+            m_partial_output = optarg;
+            break;
+        case OPT_MERGE_PARTIAL:
+            m_partial_inputs.add_files(optarg);
+            break;
+        case OPT_CACHE:
+            m_cache_dir = optarg;
+            break;
+        case OPT_EXPECTED_KEYS:
+            m_expected_keys = std::stoull(optarg);
+            break;
+        case OPT_IPV4_ONLY:
+            m_ipv4_only = true;
+            break;
+        case OPT_FOLLOW:
+            m_follow_periods = optarg ? optarg : "5m,15m,1h";
+            break;
+        case OPT_PROFILE:
+            m_profile = true;
+            break;
+        case OPT_MEMORY_LIMIT:
+            m_memory_limit = parse_size(optarg);
+            break;
+        case OPT_SPILL_DIR:
+            m_spill_dir = optarg;
+            break;
         case '?':
             throw OptionsException("invalid command line option(s)");
         default:
@@ -118,6 +233,35 @@ void Options::validate()
             m_output_specifier = "json";
         }
 
+        if (m_approx_keys != 0 && m_order_by.empty()) {
+            throw OptionsException("approximate aggregation requires an order field");
+        }
+
+        if (m_approx_keys != 0 && m_memory_limit != 0) {
+            throw OptionsException("approximate aggregation cannot be combined with a memory limit");
+        }
+
+        if (m_spill_dir.empty()) {
+            const char *tmp_dir = getenv("TMPDIR");
+            m_spill_dir = (tmp_dir && *tmp_dir) ? tmp_dir : "/tmp";
+        }
+
+        if (!m_follow_periods.empty() && (!m_partial_output.empty() || m_partial_inputs.length() != 0)) {
+            throw OptionsException("following files cannot be combined with partial results");
+        }
+
+        if (!m_follow_periods.empty()
+                && (strcasecmp(m_output_specifier.c_str(), "arrow") == 0
+                    || strcasecmp(m_output_specifier.c_str(), "parquet") == 0)) {
+            throw OptionsException("following files requires a text output");
+        }
+
+    } else if (!m_partial_output.empty() || m_partial_inputs.length() != 0) {
+        throw OptionsException("partial results require aggregation keys");
+
+    } else if (!m_follow_periods.empty()) {
+        throw OptionsException("following files requires aggregation keys");
+
     } else {
         // Record listing
         m_mode = Mode::list;
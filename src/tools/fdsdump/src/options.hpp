@@ -4,6 +4,7 @@
 #include <cstddef>
 #include <string>
 #include <stdexcept>
+#include <vector>
 
 #include <common/filelist.hpp>
 
@@ -55,6 +56,8 @@ public:
 
     /** @brief Get list of files to process.             */
     const FileList &get_input_files() const { return m_input_files; };
+    /** @brief Get patterns of files to process as specified (see get_input_files()) */
+    const std::vector<std::string> &get_input_patterns() const { return m_input_patterns; };
     /** @brief Get input flow filter.                    */
     const std::string &get_input_filter() const { return m_input_filter; };
 
@@ -74,10 +77,41 @@ public:
     /** @brief Get output order specificiation           */
     const std::string &get_order_by() const { return m_order_by; };
 
+    /** @brief Get number of threads used for aggregation */
+    unsigned int get_threads() const { return m_threads; };
+
+    /** @brief Get number of threads reading input files ahead (0 = disabled) */
+    unsigned int get_prefetch() const { return m_prefetch; };
+
+    /** @brief Get maximal number of keys held by approximate aggregation (0 = exact) */
+    size_t get_approx_keys() const { return m_approx_keys; };
+
+    /** @brief Get memory limit of aggregated records of each thread in bytes (0 = unlimited) */
+    size_t get_memory_limit() const { return m_memory_limit; };
+    /** @brief Get directory of records spilled when the memory limit is reached */
+    const std::string &get_spill_dir() const { return m_spill_dir; };
+
+    /** @brief Get expected number of aggregation keys (0 = unknown) */
+    size_t get_expected_keys() const { return m_expected_keys; };
+    /** @brief Check whether generic IP address keys hold only IPv4 addresses */
+    bool get_ipv4_only() const { return m_ipv4_only; };
+
+    /** @brief Get file to write a partial aggregation result to (empty = print the result) */
+    const std::string &get_partial_output() const { return m_partial_output; };
+    /** @brief Get files of partial aggregation results to merge */
+    const FileList &get_partial_inputs() const { return m_partial_inputs; };
+    /** @brief Get directory of cached partial results of input files (empty = disabled) */
+    const std::string &get_cache_dir() const { return m_cache_dir; };
+    /** @brief Get periods of sliding aggregates over followed files (empty = disabled) */
+    const std::string &get_follow_periods() const { return m_follow_periods; };
+    /** @brief Check if the query should be profiled                  */
+    bool get_profile() const { return m_profile; };
+
 private:
     Mode m_mode;
 
     FileList    m_input_files;
+    std::vector<std::string> m_input_patterns;
     std::string m_input_filter;
 
     size_t      m_output_limit;
@@ -90,6 +124,20 @@ private:
 
     bool        m_biflow_autoignore;
 
+    unsigned int m_threads;
+    unsigned int m_prefetch;
+    size_t       m_approx_keys;
+    size_t       m_memory_limit;
+    std::string  m_spill_dir;
+    size_t       m_expected_keys;
+    bool         m_ipv4_only;
+
+    std::string m_partial_output;
+    FileList    m_partial_inputs;
+    std::string m_cache_dir;
+    std::string m_follow_periods;
+    bool        m_profile;
+
     void parse(int argc, char *argv[]);
     void validate();
 };
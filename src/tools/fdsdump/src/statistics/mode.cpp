@@ -1,5 +1,8 @@
 
+#include <algorithm>
 #include <iostream>
+#include <string>
+#include <vector>
 
 #include "common/flowProvider.hpp"
 
@@ -36,13 +39,17 @@ static void stats_merge(
     dst.pkts_other += src.pkts_other;
 }
 
-void
-mode_statistics(const shared_iemgr &iemgr, const Options &opts)
+/**
+ * @brief Sum statistics of files.
+ *
+ * Files that cannot be opened or don't contain statistics are reported and skipped.
+ * @param[in]  file_names Files
+ * @param[out] stats      Statistics to add to
+ */
+static void
+stats_collect(const std::vector<std::string> &file_names, fds_file_stats &stats)
 {
-    auto printer = printer_factory(opts.get_output_specifier());
-    const FileList &file_names = opts.get_input_files();
     unique_file file {nullptr, &fds_file_close};
-    fds_file_stats stats {};
 
     file.reset(fds_file_init());
     if (!file) {
@@ -57,18 +64,46 @@ mode_statistics(const shared_iemgr &iemgr, const Options &opts)
         ret = fds_file_open(file.get(), file_name.c_str(), flags);
         if (ret != FDS_OK) {
             const std::string err_msg = fds_file_error(file.get());
-            std::cerr << "fds_file_open('" << file_name << "') failed: " << err_msg << std::endl;
+            // Whole lines are written, workers report errors concurrently
+            std::cerr << "fds_file_open('" + file_name + "') failed: " + err_msg + "\n";
             continue;
         }
 
         file_stats = fds_file_stats_get(file.get());
         if (!file_stats) {
-            std::cerr << "fds_file_stats_get('" << file_name << "') failed" << std::endl;
+            std::cerr << "fds_file_stats_get('" + file_name + "') failed\n";
             continue;
         }
 
         stats_merge(stats, *file_stats);
     }
+}
+
+void
+mode_statistics(const shared_iemgr &iemgr, const Options &opts)
+{
+    auto printer = printer_factory(opts.get_output_specifier());
+    const std::vector<std::string> file_names(
+        opts.get_input_files().begin(),
+        opts.get_input_files().end());
+    const size_t workers = std::max<size_t>(1, std::min<size_t>(opts.get_threads(), file_names.size()));
+    fds_file_stats stats {};
+
+    // Files are split among workers in a round-robin fashion, each one sums its files
+    std::vector<std::vector<std::string>> partitions(workers);
+    for (size_t i = 0; i < file_names.size(); ++i) {
+        partitions[i % workers].push_back(file_names[i]);
+    }
+
+    std::vector<fds_file_stats> partial_stats(workers, fds_file_stats {});
+
+    run_parallel(workers, [&](size_t i) {
+        stats_collect(partitions[i], partial_stats[i]);
+    });
+
+    for (const auto &partial : partial_stats) {
+        stats_merge(stats, partial);
+    }
 
     printer->print_prologue();
     printer->print_stats(stats);
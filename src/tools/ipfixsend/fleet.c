@@ -0,0 +1,500 @@
+/**
+ * \file ipfixsend/fleet.c
+ * \author agent <agent@local>
+ * \brief Emulation of many exporters sending the same file
+ *
+ * Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is, and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#define _GNU_SOURCE
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <arpa/inet.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+
+#include "fleet.h"
+#include "sender.h"
+#include "siso.h"
+
+/** Maximum IPFIX message size                                               */
+#define MAX_PACKET_SIZE 65535
+/** IPFIX Set ID of Template Sets                                            */
+#define SET_ID_TMPLT 2
+/** IPFIX Set ID of Options Template Sets                                    */
+#define SET_ID_OPTS_TMPLT 3
+/** 1 second in nanoseconds                                                  */
+#define NANO_SEC 1000000000LL
+
+/** Virtual exporter                                                         */
+struct fleet_session {
+    union {
+        struct in_addr v4;    /**< IPv4 source address                       */
+        struct in6_addr v6;   /**< IPv6 source address                       */
+    } src;
+    uint32_t odid;            /**< Observation Domain ID                     */
+    long long next_refresh;   /**< Time of the next template refresh [ns]    */
+};
+
+/** Control message with the source address of a datagram                    */
+union fleet_cmsg {
+    char v4[CMSG_SPACE(sizeof(struct in_pktinfo))];
+    char v6[CMSG_SPACE(sizeof(struct in6_pktinfo))];
+    struct cmsghdr align;
+};
+
+struct fleet_s {
+    int sockfd;                       /**< Socket (UDP, not connected)       */
+    int family;                       /**< Address family                    */
+    struct sockaddr_storage dst;      /**< Destination address               */
+    socklen_t dst_len;                /**< Size of the destination address   */
+    bool src_set;                     /**< Source addresses are defined      */
+
+    struct fleet_session *sessions;   /**< Sessions                          */
+    unsigned int sessions_cnt;        /**< Number of sessions                */
+    bool odid_rewrite;                /**< Rewrite ODID                      */
+    long long refresh;                /**< Template refresh interval [ns]    */
+    struct timespec start;            /**< Start of the fleet (monotonic)    */
+
+    /** Template Sets of the file (IPFIX Message, NULL if unknown)           */
+    struct fds_ipfix_msg_hdr *tmplt;
+
+    struct {
+        uint8_t *data;                /**< Messages one after another        */
+        size_t size;                  /**< Used size of the buffer           */
+        unsigned int cnt;             /**< Number of messages                */
+        unsigned int max;             /**< Max. number of messages           */
+        size_t lengths[SISO_BATCH_MAX];     /**< Size of each message        */
+        unsigned int session[SISO_BATCH_MAX]; /**< Sender of each message    */
+        struct mmsghdr msgs[SISO_BATCH_MAX];
+        struct iovec iovs[SISO_BATCH_MAX];
+        union fleet_cmsg cmsgs[SISO_BATCH_MAX];
+    } batch;                          /**< Messages to send                  */
+
+    struct sender_pacer pacer;        /**< packets/s limit                   */
+};
+
+/**
+ * \brief Get the address of the n-th session
+ * \param[in]  family Address family
+ * \param[in]  base   First address
+ * \param[in]  idx    Index of the session
+ * \param[out] out    Address of the session
+ */
+static void
+fleet_addr_add(int family, const void *base, uint32_t idx, struct fleet_session *out)
+{
+    if (family == AF_INET) {
+        const struct in_addr *addr = base;
+        out->src.v4.s_addr = htonl(ntohl(addr->s_addr) + idx);
+        return;
+    }
+
+    // IPv6: increase the last 32 bits
+    uint32_t last;
+    out->src.v6 = *(const struct in6_addr *) base;
+    memcpy(&last, &out->src.v6.s6_addr[12], sizeof(last));
+    last = htonl(ntohl(last) + idx);
+    memcpy(&out->src.v6.s6_addr[12], &last, sizeof(last));
+}
+
+/**
+ * \brief Create a socket and resolve the destination
+ * \param[in] fleet Fleet
+ * \param[in] cfg   Configuration
+ * \return On success returns 0. Otherwise returns nonzero value.
+ */
+static int
+fleet_socket(fleet_t *fleet, const struct fleet_cfg *cfg)
+{
+    struct addrinfo hints, *info;
+    uint8_t src[sizeof(struct in6_addr)];
+    int ret;
+
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_DGRAM;
+    hints.ai_protocol = IPPROTO_UDP;
+
+    if (cfg->src != NULL) {
+        if (inet_pton(AF_INET, cfg->src, src) == 1) {
+            hints.ai_family = AF_INET;
+        } else if (inet_pton(AF_INET6, cfg->src, src) == 1) {
+            hints.ai_family = AF_INET6;
+        } else {
+            fprintf(stderr, "Invalid source IP address '%s'\n", cfg->src);
+            return 1;
+        }
+    }
+
+    ret = getaddrinfo(cfg->ip, cfg->port, &hints, &info);
+    if (ret != 0) {
+        fprintf(stderr, "Unable to resolve the destination: %s\n", gai_strerror(ret));
+        return 1;
+    }
+
+    fleet->family = info->ai_family;
+    fleet->dst_len = info->ai_addrlen;
+    memcpy(&fleet->dst, info->ai_addr, info->ai_addrlen);
+    freeaddrinfo(info);
+
+    fleet->sockfd = socket(fleet->family, SOCK_DGRAM, IPPROTO_UDP);
+    if (fleet->sockfd == -1) {
+        fprintf(stderr, "Unable to create a socket: %s\n", strerror(errno));
+        return 1;
+    }
+
+    if (cfg->src != NULL) {
+        // Try to allow non-local source addresses (requires CAP_NET_ADMIN)
+        int on = 1;
+        if (fleet->family == AF_INET) {
+            setsockopt(fleet->sockfd, IPPROTO_IP, IP_FREEBIND, &on, sizeof(on));
+            setsockopt(fleet->sockfd, IPPROTO_IP, IP_TRANSPARENT, &on, sizeof(on));
+        } else {
+            setsockopt(fleet->sockfd, IPPROTO_IPV6, IPV6_FREEBIND, &on, sizeof(on));
+            setsockopt(fleet->sockfd, IPPROTO_IPV6, IPV6_TRANSPARENT, &on, sizeof(on));
+        }
+    }
+
+    for (unsigned int i = 0; i < fleet->sessions_cnt; ++i) {
+        struct fleet_session *session = &fleet->sessions[i];
+        if (cfg->src != NULL) {
+            fleet_addr_add(fleet->family, src, cfg->first + i, session);
+        }
+    }
+
+    fleet->src_set = (cfg->src != NULL);
+    return 0;
+}
+
+fleet_t *
+fleet_create(const struct fleet_cfg *cfg)
+{
+    fleet_t *fleet = calloc(1, sizeof(*fleet));
+    if (!fleet) {
+        fprintf(stderr, "Unable to allocate memory (%s:%d)!\n", __FILE__, __LINE__);
+        return NULL;
+    }
+
+    fleet->sockfd = -1;
+    fleet->sessions_cnt = cfg->sessions;
+    fleet->sessions = calloc(cfg->sessions, sizeof(*fleet->sessions));
+    fleet->batch.max = sender_batch_limit(cfg->packets_s, cfg->batch);
+    fleet->batch.data = malloc(fleet->batch.max * MAX_PACKET_SIZE);
+    if (!fleet->sessions || !fleet->batch.data) {
+        fprintf(stderr, "Unable to allocate memory (%s:%d)!\n", __FILE__, __LINE__);
+        fleet_destroy(fleet);
+        return NULL;
+    }
+
+    if (fleet_socket(fleet, cfg) != 0) {
+        fleet_destroy(fleet);
+        return NULL;
+    }
+
+    fleet->odid_rewrite = cfg->odid_rewrite;
+    fleet->refresh = cfg->refresh * NANO_SEC;
+    for (unsigned int i = 0; i < fleet->sessions_cnt; ++i) {
+        struct fleet_session *session = &fleet->sessions[i];
+        session->odid = cfg->odid + cfg->first + i;
+        // Spread refreshes of sessions over the interval
+        session->next_refresh = fleet->refresh * (i + 1) / fleet->sessions_cnt;
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &fleet->start);
+    sender_pacer_init(&fleet->pacer, cfg->packets_s);
+    return fleet;
+}
+
+void
+fleet_destroy(fleet_t *fleet)
+{
+    if (!fleet) {
+        return;
+    }
+
+    if (fleet->sockfd != -1) {
+        close(fleet->sockfd);
+    }
+
+    free(fleet->tmplt);
+    free(fleet->batch.data);
+    free(fleet->sessions);
+    free(fleet);
+}
+
+/**
+ * \brief Append (Options) Template Sets of a message to the template message
+ * \param[in] tmplt Template message
+ * \param[in] msg   IPFIX Message
+ * \return On success returns 0. If the template message is full, returns
+ *   nonzero value.
+ */
+static int
+fleet_templates_add(struct fds_ipfix_msg_hdr *tmplt, const struct fds_ipfix_msg_hdr *msg)
+{
+    const uint8_t *ptr = (const uint8_t *) msg + FDS_IPFIX_MSG_HDR_LEN;
+    const uint8_t *end = (const uint8_t *) msg + ntohs(msg->length);
+
+    while (ptr + FDS_IPFIX_SET_HDR_LEN <= end) {
+        const struct fds_ipfix_set_hdr *set = (const struct fds_ipfix_set_hdr *) ptr;
+        uint16_t set_id = ntohs(set->flowset_id);
+        uint16_t set_len = ntohs(set->length);
+
+        if (set_len < FDS_IPFIX_SET_HDR_LEN || ptr + set_len > end) {
+            // Malformed message
+            break;
+        }
+
+        ptr += set_len;
+        if (set_id != SET_ID_TMPLT && set_id != SET_ID_OPTS_TMPLT) {
+            continue;
+        }
+
+        // Template Withdrawals (i.e. zero field count) are not refreshed
+        const uint8_t *rec = (const uint8_t *) set + FDS_IPFIX_SET_HDR_LEN;
+        if (set_len >= FDS_IPFIX_SET_HDR_LEN + 4U && rec[2] == 0 && rec[3] == 0) {
+            continue;
+        }
+
+        uint16_t tmplt_len = ntohs(tmplt->length);
+        if ((size_t) tmplt_len + set_len > MAX_PACKET_SIZE) {
+            return 1;
+        }
+
+        memcpy((uint8_t *) tmplt + tmplt_len, set, set_len);
+        tmplt->length = htons(tmplt_len + set_len);
+    }
+
+    return 0;
+}
+
+int
+fleet_templates_load(fleet_t *fleet, reader_t *reader)
+{
+    struct fds_ipfix_msg_hdr *msg;
+    enum READER_STATUS status;
+
+    struct fds_ipfix_msg_hdr *tmplt = calloc(1, MAX_PACKET_SIZE);
+    if (!tmplt) {
+        fprintf(stderr, "Unable to allocate memory (%s:%d)!\n", __FILE__, __LINE__);
+        return 1;
+    }
+
+    tmplt->version = htons(FDS_IPFIX_VERSION);
+    tmplt->length = htons(FDS_IPFIX_MSG_HDR_LEN);
+
+    reader_rewind(reader);
+    while ((status = reader_get_next_packet(reader, &msg, NULL)) == READER_OK) {
+        if (fleet_templates_add(tmplt, msg) != 0) {
+            fprintf(stderr, "Template Sets of the file don't fit into a single "
+                "IPFIX Message, templates will not be refreshed.\n");
+            free(tmplt);
+            reader_rewind(reader);
+            return 0;
+        }
+    }
+
+    reader_rewind(reader);
+    if (status != READER_EOF) {
+        free(tmplt);
+        return 1;
+    }
+
+    if (ntohs(tmplt->length) == FDS_IPFIX_MSG_HDR_LEN) {
+        // No templates
+        free(tmplt);
+        tmplt = NULL;
+    }
+
+    free(fleet->tmplt);
+    fleet->tmplt = tmplt;
+    return 0;
+}
+
+int
+fleet_flush(fleet_t *fleet)
+{
+    unsigned int cnt = fleet->batch.cnt;
+    const uint8_t *ptr = fleet->batch.data;
+
+    if (cnt == 0) {
+        return 0;
+    }
+
+    for (unsigned int i = 0; i < cnt; ++i) {
+        struct mmsghdr *mmsg = &fleet->batch.msgs[i];
+        struct iovec *iov = &fleet->batch.iovs[i];
+        const struct fleet_session *session = &fleet->sessions[fleet->batch.session[i]];
+
+        iov->iov_base = (void *) ptr;
+        iov->iov_len = fleet->batch.lengths[i];
+        ptr += fleet->batch.lengths[i];
+
+        memset(mmsg, 0, sizeof(*mmsg));
+        mmsg->msg_hdr.msg_name = &fleet->dst;
+        mmsg->msg_hdr.msg_namelen = fleet->dst_len;
+        mmsg->msg_hdr.msg_iov = iov;
+        mmsg->msg_hdr.msg_iovlen = 1;
+
+        if (!fleet->src_set) {
+            continue;
+        }
+
+        // Source address of the session
+        union fleet_cmsg *ctrl = &fleet->batch.cmsgs[i];
+        memset(ctrl, 0, sizeof(*ctrl));
+        mmsg->msg_hdr.msg_control = ctrl;
+
+        if (fleet->family == AF_INET) {
+            mmsg->msg_hdr.msg_controllen = sizeof(ctrl->v4);
+            struct cmsghdr *cmsg = CMSG_FIRSTHDR(&mmsg->msg_hdr);
+            cmsg->cmsg_level = IPPROTO_IP;
+            cmsg->cmsg_type = IP_PKTINFO;
+            cmsg->cmsg_len = CMSG_LEN(sizeof(struct in_pktinfo));
+            struct in_pktinfo *info = (struct in_pktinfo *) CMSG_DATA(cmsg);
+            info->ipi_spec_dst = session->src.v4;
+        } else {
+            mmsg->msg_hdr.msg_controllen = sizeof(ctrl->v6);
+            struct cmsghdr *cmsg = CMSG_FIRSTHDR(&mmsg->msg_hdr);
+            cmsg->cmsg_level = IPPROTO_IPV6;
+            cmsg->cmsg_type = IPV6_PKTINFO;
+            cmsg->cmsg_len = CMSG_LEN(sizeof(struct in6_pktinfo));
+            struct in6_pktinfo *info = (struct in6_pktinfo *) CMSG_DATA(cmsg);
+            info->ipi6_addr = session->src.v6;
+        }
+    }
+
+    unsigned int done = 0;
+    while (done < cnt) {
+        int ret = sendmmsg(fleet->sockfd, &fleet->batch.msgs[done], cnt - done, 0);
+        if (ret == -1) {
+            if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR) {
+                // Probably a signal occurred. Try again.
+                continue;
+            }
+
+            fprintf(stderr, "Network error: %s\n", strerror(errno));
+            return 1;
+        }
+
+        done += ret;
+    }
+
+    fleet->batch.cnt = 0;
+    fleet->batch.size = 0;
+    sender_pacer_wait(&fleet->pacer, cnt);
+    return 0;
+}
+
+/**
+ * \brief Add a message of a session to the batch
+ * \param[in] fleet   Fleet
+ * \param[in] session Index of the session
+ * \param[in] msg     IPFIX Message
+ * \return On success returns 0. Otherwise returns nonzero value.
+ */
+static int
+fleet_enqueue(fleet_t *fleet, unsigned int session, const struct fds_ipfix_msg_hdr *msg)
+{
+    const uint16_t msg_len = ntohs(msg->length);
+
+    if (fleet->batch.cnt == fleet->batch.max
+            || fleet->batch.size + msg_len > (size_t) fleet->batch.max * MAX_PACKET_SIZE) {
+        if (fleet_flush(fleet) != 0) {
+            return 1;
+        }
+    }
+
+    struct fds_ipfix_msg_hdr *copy;
+    copy = (struct fds_ipfix_msg_hdr *) (fleet->batch.data + fleet->batch.size);
+    memcpy(copy, msg, msg_len);
+    if (fleet->odid_rewrite) {
+        copy->odid = htonl(fleet->sessions[session].odid);
+    }
+
+    fleet->batch.lengths[fleet->batch.cnt] = msg_len;
+    fleet->batch.session[fleet->batch.cnt] = session;
+    fleet->batch.cnt++;
+    fleet->batch.size += msg_len;
+    return 0;
+}
+
+int
+fleet_send(fleet_t *fleet, const struct fds_ipfix_msg_hdr *msg)
+{
+    const bool refresh = (fleet->tmplt != NULL && fleet->refresh > 0);
+    long long now = 0;
+
+    if (refresh) {
+        struct timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        now = (ts.tv_sec - fleet->start.tv_sec) * NANO_SEC
+            + (ts.tv_nsec - fleet->start.tv_nsec);
+
+        // Templates precede data of the message, i.e. they share its time
+        fleet->tmplt->export_time = msg->export_time;
+    }
+
+    for (unsigned int i = 0; i < fleet->sessions_cnt; ++i) {
+        struct fleet_session *session = &fleet->sessions[i];
+
+        if (refresh && now >= session->next_refresh) {
+            // Template refresh (doesn't change the Sequence Number)
+            fleet->tmplt->odid = msg->odid;
+            fleet->tmplt->seq_num = msg->seq_num;
+            if (fleet_enqueue(fleet, i, fleet->tmplt) != 0) {
+                return 1;
+            }
+
+            session->next_refresh += fleet->refresh;
+            if (session->next_refresh <= now) {
+                session->next_refresh = now + fleet->refresh;
+            }
+        }
+
+        if (fleet_enqueue(fleet, i, msg) != 0) {
+            return 1;
+        }
+    }
+
+    return 0;
+}
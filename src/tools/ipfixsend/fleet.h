@@ -0,0 +1,129 @@
+/**
+ * \file ipfixsend/fleet.h
+ * \author agent <agent@local>
+ * \brief Emulation of many exporters sending the same file
+ *
+ * Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is, and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#ifndef FLEET_H
+#define FLEET_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <libfds.h>
+
+#include "reader.h"
+
+/**
+ * \brief Fleet of virtual exporters
+ *
+ * Each IPFIX Message is sent by all virtual exporters (i.e. sessions) of the
+ * fleet. Sessions share a single UDP socket and differ by their source IP
+ * address (optional) and Observation Domain ID (optional). Template Sets of
+ * the file can be periodically resent by each session (see fleet_templates_load()).
+ */
+typedef struct fleet_s fleet_t;
+
+/** Configuration of a fleet */
+struct fleet_cfg {
+    const char *ip;        /**< Destination IP address                          */
+    const char *port;      /**< Destination port                                */
+    /**
+     * First source IP address (can be NULL). The session N uses the address
+     * increased by N. Addresses must be local unless the process is allowed
+     * to use non-local addresses (CAP_NET_ADMIN).
+     */
+    const char *src;
+    unsigned int sessions; /**< Number of sessions                              */
+    unsigned int first;    /**< Index of the first session (source address, ODID) */
+    bool odid_rewrite;     /**< Rewrite ODID (the session N uses odid + N)      */
+    uint32_t odid;         /**< ODID of the session 0                           */
+    unsigned int refresh;  /**< Template refresh interval [s] (0 = disabled)    */
+    int packets_s;         /**< packets/s limit of the fleet (0 = no limit)     */
+    unsigned int batch;    /**< Max. number of packets sent at once             */
+};
+
+/**
+ * \brief Create a fleet and its socket
+ * \param[in] cfg Configuration
+ * \return On success returns a pointer to the fleet. Otherwise prints an error
+ *   message and returns NULL.
+ */
+fleet_t *
+fleet_create(const struct fleet_cfg *cfg);
+
+/**
+ * \brief Destroy a fleet
+ * \param[in] fleet Fleet
+ */
+void
+fleet_destroy(fleet_t *fleet);
+
+/**
+ * \brief Collect Template Sets of a file for template refresh
+ *
+ * All (Options) Template Sets of the file, except Template Withdrawals, are
+ * merged into a single IPFIX Message, which is sent by each session every
+ * refresh interval. The start of the intervals is spread over the sessions.
+ * Therefore, definitions of templates should not change within the file.
+ * \note The reader is rewound.
+ * \param[in] fleet  Fleet
+ * \param[in] reader Input file
+ * \return On success returns 0. Otherwise returns nonzero value.
+ */
+int
+fleet_templates_load(fleet_t *fleet, reader_t *reader);
+
+/**
+ * \brief Send an IPFIX Message by all sessions of the fleet
+ *
+ * The message is copied, so the original is not modified. Messages are sent
+ * in batches and paced by the packets/s limit.
+ * \param[in] fleet Fleet
+ * \param[in] msg   IPFIX Message
+ * \return On success returns 0. Otherwise returns nonzero value.
+ */
+int
+fleet_send(fleet_t *fleet, const struct fds_ipfix_msg_hdr *msg);
+
+/**
+ * \brief Send all batched messages
+ * \param[in] fleet Fleet
+ * \return On success returns 0. Otherwise returns nonzero value.
+ */
+int
+fleet_flush(fleet_t *fleet);
+
+#endif /* FLEET_H */
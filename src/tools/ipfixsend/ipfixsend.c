@@ -44,7 +44,10 @@
 #include <string.h>
 #include <signal.h>
 #include <stdbool.h>
+#include <strings.h>
 #include <errno.h>
+#include <pthread.h>
+#include <sys/prctl.h>
 #include <sys/ioctl.h>
 #include <linux/sockios.h>
 #include <time.h>
@@ -52,6 +55,7 @@
 #include "siso.h"
 #include "reader.h"
 #include "sender.h"
+#include "../../plugins/output/ipfix/block_reader.h"
 
 /** Default destination IP                 */
 #define DEFAULT_IP "127.0.0.1"
@@ -61,6 +65,8 @@
 #define DEFAULT_TYPE "UDP"
 /** By default, send data in infinite loop */
 #define INFINITY_LOOPS (-1)
+/** Default number of threads decompressing compressed files */
+#define DEFAULT_DECOMPRESS_THREADS 2
 /**
  * Timeout for waiting until all queued messages have been sent before close()
  * (in nanoseconds)
@@ -70,6 +76,33 @@
 /** Global stop signal                     */
 static volatile sig_atomic_t stop = 0;
 
+/** Configuration shared by all sending threads */
+struct send_cfg {
+    const char *ip;         /**< Destination IP address                     */
+    const char *port;       /**< Destination port                           */
+    const char *type;       /**< Transport protocol                         */
+    const char *speed;      /**< Max. data sending speed (can be NULL)      */
+    int loops;              /**< Number of replays of the file              */
+    int packets_s;          /**< Speed limit in packets/s (0 = unlimited)   */
+    double realtime_s;      /**< Real-time speed-up (0 = disabled)          */
+    unsigned int batch;     /**< Max. packets passed to the kernel at once  */
+    bool odid_rewrite;      /**< Rewrite ODID                               */
+    uint32_t odid;          /**< New ODID of the first thread               */
+    unsigned int sessions;  /**< Virtual exporters per thread (0 = disabled) */
+    const char *src;        /**< First source IP of the exporters (or NULL) */
+    unsigned int refresh;   /**< Template refresh interval of the exporters */
+    unsigned int probe_ms;  /**< Interval of latency probes (0 = disabled)  */
+};
+
+/** Sending thread (i.e. a Transport Session) */
+struct send_thread {
+    const struct send_cfg *cfg; /**< Shared configuration                   */
+    unsigned int id;            /**< Index of the thread                    */
+    reader_t *reader;           /**< Input file                             */
+    pthread_t thread;           /**< Thread identifier                      */
+    int ret;                    /**< Return code (0 on success)             */
+};
+
 /** \brief Print usage                     */
 void usage()
 {
@@ -88,6 +121,29 @@ void usage()
     printf("  -R num     Real-time sending\n");
     printf("             Allow speed-up sending 'num' times (realtime: 1.0)\n");
     printf("  -O num     Rewrite Observation Domain ID (ODID)\n");
+    printf("             The thread N uses ODID 'num' + N (counted from 0)\n");
+    printf("  -T num     Number of sending threads (default: 1)\n");
+    printf("             Each thread sends the file over its own connection\n");
+    printf("             Speed limits (-s, -S, -R) apply to each thread\n");
+    printf("  -b num     Max. packets passed to the kernel at once (1 .. %d)\n",
+        SISO_BATCH_MAX);
+    printf("             (default: 1)\n");
+    printf("  -E num     Emulate 'num' exporters per thread (UDP only)\n");
+    printf("             Each packet is sent by all exporters, the exporter N uses\n");
+    printf("             source address 'addr' + N (see -A) and ODID 'num' + N (see -O)\n");
+    printf("  -A addr    First source IP address of the emulated exporters\n");
+    printf("             (must be local, e.g. 127.0.0.1, unless CAP_NET_ADMIN)\n");
+    printf("  -r sec     Template refresh interval of the emulated exporters\n");
+    printf("             (default: 0, i.e. templates are sent only as in the file)\n");
+    printf("  -L ms      Send a latency probe every 'ms' milliseconds\n");
+    printf("             (ODID %" PRIu32 ", send time in nanoseconds as IE %u:%u)\n",
+        (uint32_t) SENDER_PROBE_ODID, SENDER_PROBE_PEN, SENDER_PROBE_IE_TIME);
+    printf("  -F sec     Skip packets with Export Time before 'sec' (UNIX timestamp)\n");
+    printf("  -U sec     Skip packets with Export Time after 'sec' (UNIX timestamp)\n");
+    printf("  -D num     Threads decompressing blocks of compressed files (1 .. %u)\n",
+        BLOCK_READER_THREADS_MAX);
+    printf("             (default: %d, compressed files are always precached)\n",
+        DEFAULT_DECOMPRESS_THREADS);
     printf("\n");
 }
 
@@ -102,6 +158,144 @@ void handler(int signal)
     stop = 1;
 }
 
+/**
+ * \brief Send the file by a fleet of virtual exporters
+ *
+ * \param[in] ctx Sending thread
+ * \return On success returns 0. Otherwise returns nonzero value.
+ */
+int send_fleet(struct send_thread *ctx)
+{
+    const struct send_cfg *cfg = ctx->cfg;
+    reader_t *reader = ctx->reader;
+    const struct fleet_cfg fleet_cfg = {
+        .ip = cfg->ip,
+        .port = cfg->port,
+        .src = cfg->src,
+        .sessions = cfg->sessions,
+        .first = ctx->id * cfg->sessions,
+        .odid_rewrite = cfg->odid_rewrite,
+        .odid = cfg->odid,
+        .refresh = cfg->refresh,
+        .packets_s = cfg->packets_s,
+        .batch = cfg->batch,
+    };
+
+    fleet_t *fleet = fleet_create(&fleet_cfg);
+    if (!fleet) {
+        return 1;
+    }
+
+    if (fleet_templates_load(fleet, reader) != 0) {
+        fleet_destroy(fleet);
+        return 1;
+    }
+
+    if (cfg->loops != 1) {
+        reader_header_autoupdate(reader, true);
+    }
+
+    int i;
+    for (i = 0; !stop && (cfg->loops == INFINITY_LOOPS || i < cfg->loops); ++i) {
+        reader_rewind(reader);
+        if (send_packets_fleet(fleet, reader) != 0) {
+            break;
+        }
+    }
+
+    fleet_destroy(fleet);
+    return 0;
+}
+
+/**
+ * \brief Send the file over a new connection
+ *
+ * \param[in] arg Sending thread (struct send_thread)
+ * \return Always NULL, result is stored in the thread structure
+ */
+void *send_main(void *arg)
+{
+    struct send_thread *ctx = (struct send_thread *) arg;
+    const struct send_cfg *cfg = ctx->cfg;
+    reader_t *reader = ctx->reader;
+
+    // Wake up as close to pacing deadlines as possible
+    prctl(PR_SET_TIMERSLACK, 1UL, 0, 0, 0);
+
+    if (cfg->sessions > 0) {
+        ctx->ret = send_fleet(ctx);
+        return NULL;
+    }
+
+    ctx->ret = 1;
+
+    // Get collector's address
+    sisoconf *sender = siso_create();
+    if (!sender) {
+        fprintf(stderr, "Memory allocation error\n");
+        return NULL;
+    }
+
+    if (cfg->odid_rewrite) {
+        reader_odid_rewrite(reader, cfg->odid + ctx->id);
+    }
+
+    if (cfg->loops != 1) {
+        reader_header_autoupdate(reader, true);
+    }
+
+    // Create connection (each connection gets its own source port)
+    int ret = siso_create_connection(sender, cfg->ip, cfg->port, cfg->type);
+    if (ret != SISO_OK) {
+        fprintf(stderr, "Network error: %s\n", siso_get_last_err(sender));
+        siso_destroy(sender);
+        return NULL;
+    }
+
+    // Set max. speed
+    if (cfg->speed) {
+        siso_set_speed_str(sender, cfg->speed);
+    }
+
+    // Send packets
+    struct sender_probe probe;
+    sender_probe_init(&probe, cfg->probe_ms);
+
+    int i;
+    for (i = 0; !stop && (cfg->loops == INFINITY_LOOPS || i < cfg->loops); ++i) {
+        reader_rewind(reader);
+        if (cfg->realtime_s > 0.0) {
+            // Real-time sending
+            ret = send_packets_realtime(sender, reader, cfg->realtime_s, cfg->batch, &probe);
+        } else {
+            // Speed limitation sending
+            ret = send_packets_limit(sender, reader, cfg->packets_s, cfg->batch, &probe);
+        }
+
+        if (ret != 0) {
+            // Error
+            break;
+        }
+    }
+
+    // Make sure that all packets are delivered before socket closes
+    int socket_fd = siso_get_socket(sender);
+    int not_sent = 0;
+    while (!stop && ioctl(socket_fd, SIOCOUTQ, &not_sent) != -1) {
+        if (not_sent <= 0) {
+            break;
+        }
+
+        // Wait
+        struct timespec sleep_time = {0, FLUSHER_TIME};
+        nanosleep(&sleep_time, NULL);
+    }
+
+    siso_destroy(sender);
+    ctx->ret = 0;
+    return NULL;
+}
+
 /**
  * \brief Main function
  * \param[in] argc Number of arguments
@@ -109,19 +303,34 @@ void handler(int signal)
  */
 int main(int argc, char** argv)
 {
-    char   *ip =   DEFAULT_IP;
-    char   *port = DEFAULT_PORT;
-    char   *type = DEFAULT_TYPE;
+    struct send_cfg cfg = {
+        .ip = DEFAULT_IP,
+        .port = DEFAULT_PORT,
+        .type = DEFAULT_TYPE,
+        .speed = NULL,
+        .loops = INFINITY_LOOPS,
+        .packets_s = 0,
+        .realtime_s = 0.0,
+        .batch = 1,
+        .odid_rewrite = false,
+        .odid = 0,
+        .sessions = 0,
+        .src = NULL,
+        .refresh = 0,
+        .probe_ms = 0,
+    };
 
     char   *input = NULL;
-    char   *speed = NULL;
-    int     loops =   INFINITY_LOOPS;
-    int     packets_s = 0;
-    double  realtime_s = 0.0;
     bool    precache = false;
-
-    bool    odid_rewrite = false;
-    long    odid_new;
+    long    odid_new = 0;
+    int     threads = 1;
+    int     batch = 1;
+    int     sessions = 0;
+    int     refresh = 0;
+    int     probe_ms = 0;
+    long long time_from = 0;
+    long long time_to = UINT32_MAX;
+    int     decompress_threads = DEFAULT_DECOMPRESS_THREADS;
 
     if (argc == 1) {
         usage();
@@ -130,7 +339,7 @@ int main(int argc, char** argv)
 
     // Parse parameters
     int c;
-    while ((c = getopt(argc, argv, "hci:d:p:t:n:s:S:R:O:")) != -1) {
+    while ((c = getopt(argc, argv, "hci:d:p:t:n:s:S:R:O:T:b:E:A:r:L:F:U:D:")) != -1) {
         switch (c) {
         case 'h':
             usage();
@@ -139,33 +348,60 @@ int main(int argc, char** argv)
             input = optarg;
             break;
         case 'd':
-            ip = optarg;
+            cfg.ip = optarg;
             break;
         case 'p':
-            port = optarg;
+            cfg.port = optarg;
             break;
         case 't':
-            type = optarg;
+            cfg.type = optarg;
             break;
         case 'c':
             precache = true;
             break;
         case 'n':
-            loops = atoi(optarg);
+            cfg.loops = atoi(optarg);
             break;
         case 's':
-            speed = optarg;
+            cfg.speed = optarg;
             break;
         case 'S':
-            packets_s = atoi(optarg);
+            cfg.packets_s = atoi(optarg);
             break;
         case 'R':
-            realtime_s = atof(optarg);
+            cfg.realtime_s = atof(optarg);
             break;
         case 'O':
-            odid_rewrite = true;
+            cfg.odid_rewrite = true;
             odid_new = atol(optarg);
             break;
+        case 'T':
+            threads = atoi(optarg);
+            break;
+        case 'b':
+            batch = atoi(optarg);
+            break;
+        case 'E':
+            sessions = atoi(optarg);
+            break;
+        case 'A':
+            cfg.src = optarg;
+            break;
+        case 'r':
+            refresh = atoi(optarg);
+            break;
+        case 'L':
+            probe_ms = atoi(optarg);
+            break;
+        case 'F':
+            time_from = atoll(optarg);
+            break;
+        case 'U':
+            time_to = atoll(optarg);
+            break;
+        case 'D':
+            decompress_threads = atoi(optarg);
+            break;
         default:
             fprintf(stderr, "Unknown option.\n");
             return 1;
@@ -173,111 +409,149 @@ int main(int argc, char** argv)
     }
 
     // Parameters check
-    if (loops < 0 && loops != INFINITY_LOOPS) {
+    if (cfg.loops < 0 && cfg.loops != INFINITY_LOOPS) {
         fprintf(stderr, "Invalid value of replay loops\n");
         return 1;
     }
 
-    if (packets_s < 0) {
+    if (cfg.packets_s < 0) {
         fprintf(stderr, "Invalid value of the packet speed limitation.\n");
         return 1;
     }
 
-    if (realtime_s < 0.0) {
+    if (cfg.realtime_s < 0.0) {
         fprintf(stderr, "Invalid value of the real-time sending.\n");
         return 1;
     }
 
-    if ((speed != NULL || packets_s != 0) && realtime_s > 0) {
+    if ((cfg.speed != NULL || cfg.packets_s != 0) && cfg.realtime_s > 0) {
         fprintf(stderr, "Combination of real-time sending and speed limitation "
             "is not permitted.\n");
         return 1;
     }
 
-    if (odid_rewrite && (odid_new < 0 || odid_new > UINT32_MAX)) {
-        fprintf(stderr, "Invalid ODID value. Must be in range (0 .. %" PRIu32 ")\n",
-            UINT32_MAX);
+    if (threads < 1) {
+        fprintf(stderr, "Invalid number of threads.\n");
         return 1;
     }
 
-    // Check whether everything is set
-    if (!input) {
-        fprintf(stderr, "Input file must be set!\n");
+    if (batch < 1 || batch > SISO_BATCH_MAX) {
+        fprintf(stderr, "Invalid batch size. Must be in range (1 .. %d)\n",
+            SISO_BATCH_MAX);
         return 1;
     }
+    cfg.batch = (unsigned int) batch;
 
-    signal(SIGINT, handler);
+    if (sessions < 0 || refresh < 0) {
+        fprintf(stderr, "Invalid number of exporters or template refresh interval.\n");
+        return 1;
+    }
+    cfg.sessions = (unsigned int) sessions;
+    cfg.refresh = (unsigned int) refresh;
 
-    // Get collector's address
-    sisoconf *sender = siso_create();
-    if (!sender) {
-        fprintf(stderr, "Memory allocation error\n");
+    if (cfg.sessions > 0 && (strcasecmp(cfg.type, "UDP") != 0
+            || cfg.speed != NULL || cfg.realtime_s > 0)) {
+        fprintf(stderr, "Emulation of exporters supports only UDP without real-time "
+            "sending and data speed limitation.\n");
         return 1;
     }
 
-    // Prepare an input file
-    reader_t *reader = reader_create(input, precache);
-    if (!reader) {
-        siso_destroy(sender);
+    if (probe_ms < 0 || (probe_ms > 0 && cfg.sessions > 0)) {
+        fprintf(stderr, "Invalid interval of latency probes (not available for "
+            "emulation of exporters).\n");
         return 1;
     }
+    cfg.probe_ms = (unsigned int) probe_ms;
 
-    if (odid_rewrite) {
-        reader_odid_rewrite(reader, (uint32_t) odid_new);
+    if ((cfg.src != NULL || cfg.refresh > 0) && cfg.sessions == 0) {
+        fprintf(stderr, "Source address and template refresh require emulation "
+            "of exporters (-E).\n");
+        return 1;
     }
 
-    if (loops != 1) {
-        reader_header_autoupdate(reader, true);
+    // Number of different ODIDs
+    const long long odid_cnt = (long long) threads * (cfg.sessions > 0 ? cfg.sessions : 1);
+    if (cfg.odid_rewrite
+            && (odid_new < 0 || odid_new > (long long) UINT32_MAX - (odid_cnt - 1))) {
+        fprintf(stderr, "Invalid ODID value. Must be in range (0 .. %lld)\n",
+            (long long) UINT32_MAX - (odid_cnt - 1));
+        return 1;
     }
+    cfg.odid = (uint32_t) odid_new;
 
-    // Create connection
-    int ret = siso_create_connection(sender, ip, port, type);
-    if (ret != SISO_OK) {
-        fprintf(stderr, "Network error: %s\n", siso_get_last_err(sender));
-        siso_destroy(sender);
-        reader_destroy(reader);
+    if (time_from < 0 || time_to > UINT32_MAX || time_from > time_to) {
+        fprintf(stderr, "Invalid Export Time range. Must be in range (0 .. %" PRIu32 ")\n",
+            UINT32_MAX);
         return 1;
     }
 
-    // Set max. speed
-    if (speed) {
-        siso_set_speed_str(sender, speed);
+    if (decompress_threads < 1 || decompress_threads > (int) BLOCK_READER_THREADS_MAX) {
+        fprintf(stderr, "Invalid number of decompression threads. Must be in range (1 .. %u)\n",
+            BLOCK_READER_THREADS_MAX);
+        return 1;
     }
 
-    // Send packets
-    int i;
-    for (i = 0; !stop && (loops == INFINITY_LOOPS || i < loops); ++i) {
-        reader_rewind(reader);
-        if (realtime_s > 0.0) {
-            // Real-time sending
-            ret = send_packets_realtime(sender, reader, realtime_s);
-        } else {
-            // Speed limitation sending
-            ret = send_packets_limit(sender, reader, packets_s);
-        }
+    const struct reader_range range = {
+        .time_from = (uint32_t) time_from,
+        .time_to = (uint32_t) time_to,
+        .threads = (unsigned int) decompress_threads,
+    };
 
-        if (ret != 0) {
-            // Error
+    // Check whether everything is set
+    if (!input) {
+        fprintf(stderr, "Input file must be set!\n");
+        return 1;
+    }
+
+    signal(SIGINT, handler);
+
+    struct send_thread *ctxs = calloc(threads, sizeof(*ctxs));
+    if (!ctxs) {
+        fprintf(stderr, "Memory allocation error\n");
+        return 1;
+    }
+
+    // Prepare an input file (preloaded packets are shared by all threads)
+    int i;
+    int ret = 0;
+    for (i = 0; i < threads; ++i) {
+        ctxs[i].cfg = &cfg;
+        ctxs[i].id = (unsigned int) i;
+        ctxs[i].reader = (i == 0)
+            ? reader_create(input, precache, &range)
+            : reader_clone(ctxs[0].reader);
+        if (!ctxs[i].reader) {
+            ret = 1;
             break;
         }
     }
 
-    // Free resources
-    reader_destroy(reader);
+    if (ret == 0 && threads == 1) {
+        send_main(&ctxs[0]);
+        ret = ctxs[0].ret;
+    } else if (ret == 0) {
+        int started;
+        for (started = 0; started < threads; ++started) {
+            if (pthread_create(&ctxs[started].thread, NULL, send_main, &ctxs[started]) != 0) {
+                fprintf(stderr, "Failed to start a sending thread\n");
+                sender_stop();
+                stop = 1;
+                ret = 1;
+                break;
+            }
+        }
 
-    // Make sure that all packets are delivered before socket closes
-    int socket_fd = siso_get_socket(sender);
-    int not_sent = 0;
-    while (!stop && ioctl(socket_fd, SIOCOUTQ, &not_sent) != -1) {
-        if (not_sent <= 0) {
-            break;
+        for (i = 0; i < started; ++i) {
+            pthread_join(ctxs[i].thread, NULL);
+            ret |= ctxs[i].ret;
         }
+    }
 
-        // Wait
-        struct timespec sleep_time = {0, FLUSHER_TIME};
-        nanosleep(&sleep_time, NULL);
+    // Free resources (clones before the original reader)
+    for (i = threads - 1; i >= 0; --i) {
+        reader_destroy(ctxs[i].reader);
     }
 
-    siso_destroy(sender);
-    return 0;
+    free(ctxs);
+    return ret;
 }
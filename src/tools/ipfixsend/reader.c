@@ -48,6 +48,7 @@
 #include <string.h>
 
 #include "reader.h"
+#include "../../plugins/output/ipfix/block_reader.h"
 
 /** Maximum IPFIX packet size (2^16) */
 #define MAX_PACKET_SIZE 65536
@@ -70,8 +71,12 @@ struct reader_autoupdate {
 /** Internal representation of the packet reader                             */
 struct reader_internal {
     FILE *file;          /**< Input file                                     */
+    char *path;          /**< Path to the input file                         */
     size_t next_id;      /**< Index of next packet                           */
     bool is_preloaded;   /**< Is the whole file preloaded                    */
+    bool is_clone;       /**< Preloaded packets belong to another reader     */
+    struct reader_range range; /**< Selection of packets                     */
+    block_reader_t *blocks; /**< Compressed file (only while preloading)     */
 
     struct fds_ipfix_msg_hdr **packets_preload;  /**< Preloaded packets      */
     uint8_t packet_single[MAX_PACKET_SIZE];      /**< Internal buffer        */
@@ -102,7 +107,7 @@ reader_free_preloaded_packets(struct fds_ipfix_msg_hdr **packets);
 
 // Create a new packet reader
 reader_t *
-reader_create(const char *file, bool preload)
+reader_create(const char *file, bool preload, const struct reader_range *range)
 {
     reader_t *new_reader = calloc(1, sizeof(*new_reader));
     if (!new_reader) {
@@ -110,19 +115,47 @@ reader_create(const char *file, bool preload)
         return NULL;
     }
 
+    new_reader->path = strdup(file);
+    if (!new_reader->path) {
+        fprintf(stderr, "Unable to allocate memory (%s:%d)!\n", __FILE__, __LINE__);
+        free(new_reader);
+        return NULL;
+    }
+
     new_reader->file = fopen(file, "rb");
     if (!new_reader->file) {
         fprintf(stderr, "Unable to open input file '%s': %s\n", file,
             strerror(errno));
+        free(new_reader->path);
         free(new_reader);
         return NULL;
     }
 
+    new_reader->range = *range;
+    if (block_reader_detect(fileno(new_reader->file))) {
+        // Compressed by the IPFIX output plugin, blocks can be decompressed only as a whole
+        const char *err = NULL;
+        new_reader->blocks = block_reader_open(fileno(new_reader->file), range->time_from,
+            range->time_to, range->threads, &err);
+        if (!new_reader->blocks) {
+            fprintf(stderr, "Unable to read compressed file '%s': %s\n", file, err);
+            fclose(new_reader->file);
+            free(new_reader->path);
+            free(new_reader);
+            return NULL;
+        }
+
+        preload = true;
+    }
+
     new_reader->is_preloaded = preload;
     if (preload) {
         new_reader->packets_preload = reader_preload_packets(new_reader);
+        block_reader_close(new_reader->blocks);
+        new_reader->blocks = NULL;
         if (new_reader->packets_preload == NULL) {
             fclose(new_reader->file);
+            free(new_reader->path);
             free(new_reader);
             return NULL;
         }
@@ -135,6 +168,33 @@ reader_create(const char *file, bool preload)
     return new_reader;
 }
 
+// Create a new packet reader of the same file
+reader_t *
+reader_clone(const reader_t *reader)
+{
+    if (!reader->is_preloaded) {
+        return reader_create(reader->path, false, &reader->range);
+    }
+
+    reader_t *new_reader = calloc(1, sizeof(*new_reader));
+    if (!new_reader) {
+        fprintf(stderr, "Unable to allocate memory (%s:%d)!\n", __FILE__, __LINE__);
+        return NULL;
+    }
+
+    new_reader->path = strdup(reader->path);
+    if (!new_reader->path) {
+        fprintf(stderr, "Unable to allocate memory (%s:%d)!\n", __FILE__, __LINE__);
+        free(new_reader);
+        return NULL;
+    }
+
+    new_reader->range = reader->range;
+    new_reader->is_preloaded = true;
+    new_reader->is_clone = true;
+    new_reader->packets_preload = reader->packets_preload;
+    return new_reader;
+}
 
 // Destroy a packet reader
 void
@@ -144,7 +204,7 @@ reader_destroy(reader_t *reader)
         return;
     }
 
-    if (reader->is_preloaded) {
+    if (reader->is_preloaded && !reader->is_clone) {
         reader_free_preloaded_packets(reader->packets_preload);
     }
 
@@ -152,6 +212,7 @@ reader_destroy(reader_t *reader)
         fclose(reader->file);
     }
 
+    free(reader->path);
     free(reader);
 }
 
@@ -179,6 +240,18 @@ reader_u32_cmp(uint32_t t1, uint32_t t2)
     }
 }
 
+/**
+ * \brief Check whether Export Time of a packet is within the selected range
+ * \param[in] reader Pointer to the reader
+ * \param[in] header IPFIX header
+ */
+static inline bool
+reader_time_match(const reader_t *reader, const struct fds_ipfix_msg_hdr *header)
+{
+    uint32_t export_time = ntohl(header->export_time);
+    return export_time >= reader->range.time_from && export_time <= reader->range.time_to;
+}
+
 /**
  * \brief Read the the IPFIX header from a file
  * \param[in]  reader Pointer to the reader
@@ -316,10 +389,50 @@ reader_load_packet_alloc(reader_t *reader, struct fds_ipfix_msg_hdr **packet_dat
     return READER_OK;
 }
 
+/**
+ * \brief Allocate a memory large enough and copy the next packet of
+ *   a compressed file into it
+ *
+ * User MUST manually free the packet later.
+ * \param[in]  reader       Pointer to the packet reader
+ * \param[out] packet_data  Pointer to newly allocated packet
+ * \return On success returns #READER_OK and fills the \p packet_data. When
+ *   end-of-file occurs, returns #READER_EOF. Otherwise (i.e. malformed block,
+ *   memory allocation error) returns #READER_ERROR.
+ */
+static enum READER_STATUS
+reader_load_block_packet(reader_t *reader, struct fds_ipfix_msg_hdr **packet_data)
+{
+    const uint8_t *packet;
+    uint16_t packet_size;
+    const char *err = NULL;
+
+    switch (block_reader_next(reader->blocks, &packet, &packet_size, &err)) {
+    case BLOCK_READER_OK:
+        break;
+    case BLOCK_READER_EOF:
+        return READER_EOF;
+    default:
+        fprintf(stderr, "Unable to read a compressed block: %s\n", err);
+        return READER_ERROR;
+    }
+
+    uint8_t *result = malloc(packet_size);
+    if (!result) {
+        fprintf(stderr, "Unable to allocate memory (%s:%d)!\n", __FILE__, __LINE__);
+        return READER_ERROR;
+    }
+
+    memcpy(result, packet, packet_size);
+    *packet_data = (struct fds_ipfix_msg_hdr *) result;
+    return READER_OK;
+}
+
 /**
  * \brief Read packets from IPFIX file and store them into memory
  *
  * Result represents a NULL-terminated array of pointers to the packets.
+ * Packets out of the selected Export Time range are skipped.
  * \param[in] reader  Pointer to the packet reader
  * \return On success returns a pointer to the array. Otherwise returns NULL.
  */
@@ -338,7 +451,9 @@ reader_preload_packets(reader_t *reader)
 
     while (1) {
         // Read packet
-        status = reader_load_packet_alloc(reader, &packets[pkt_cnt], NULL);
+        status = (reader->blocks != NULL)
+            ? reader_load_block_packet(reader, &packets[pkt_cnt])
+            : reader_load_packet_alloc(reader, &packets[pkt_cnt], NULL);
         if (status == READER_EOF) {
             break;
         }
@@ -353,6 +468,11 @@ reader_preload_packets(reader_t *reader)
             return NULL;
         }
 
+        if (!reader_time_match(reader, packets[pkt_cnt])) {
+            free(packets[pkt_cnt]);
+            continue;
+        }
+
         // Move array index to next packet - resize array if needed
         pkt_cnt++;
         if (pkt_cnt < pkt_max) {
@@ -521,19 +641,21 @@ reader_get_next_packet(reader_t *reader, struct fds_ipfix_msg_hdr **output, uint
         memcpy(buffer, packet, ntohs(packet->length));
         ++reader->next_id;
     } else {
-        // Read from the file
-        size_t b_size = MAX_PACKET_SIZE;
+        // Read from the file (skip packets out of the range)
         enum READER_STATUS ret;
 
-        ret = reader_load_packet_buffer(reader, (uint8_t *) buffer, &b_size);
-        if (ret == READER_EOF) {
-            return READER_EOF;
-        }
+        do {
+            size_t b_size = MAX_PACKET_SIZE;
+            ret = reader_load_packet_buffer(reader, (uint8_t *) buffer, &b_size);
+            if (ret == READER_EOF) {
+                return READER_EOF;
+            }
 
-        if (ret != READER_OK) {
-            // Buffer should be big enough, so only an error can occur
-            return READER_ERROR;
-        }
+            if (ret != READER_OK) {
+                // Buffer should be big enough, so only an error can occur
+                return READER_ERROR;
+            }
+        } while (!reader_time_match(reader, buffer));
     }
 
     reader_header_update(reader, buffer);
@@ -563,21 +685,23 @@ reader_get_next_header(reader_t *reader, struct fds_ipfix_msg_hdr **header)
         memcpy(header_buffer, packet, FDS_IPFIX_MSG_HDR_LEN);
         ++reader->next_id;
     } else {
-        // Read from the file
-        enum READER_STATUS status;
-        status = reader_load_packet_header(reader, header_buffer);
-        if (status != READER_OK) {
-            return status;
-        }
+        // Read from the file (skip packets out of the range)
+        do {
+            enum READER_STATUS status;
+            status = reader_load_packet_header(reader, header_buffer);
+            if (status != READER_OK) {
+                return status;
+            }
 
-        // Seek to the next header
-        uint16_t packet_size = ntohs(header_buffer->length);
-        uint16_t body_size = packet_size - FDS_IPFIX_MSG_HDR_LEN;
+            // Seek to the next header
+            uint16_t packet_size = ntohs(header_buffer->length);
+            uint16_t body_size = packet_size - FDS_IPFIX_MSG_HDR_LEN;
 
-        if (fseek(reader->file, (long) body_size, SEEK_CUR)) {
-            fprintf(stderr, "fseek error: %s\n", strerror(errno));
-            return READER_ERROR;
-        }
+            if (fseek(reader->file, (long) body_size, SEEK_CUR)) {
+                fprintf(stderr, "fseek error: %s\n", strerror(errno));
+                return READER_ERROR;
+            }
+        } while (!reader_time_match(reader, header_buffer));
     }
 
     reader_header_update(reader, header_buffer);
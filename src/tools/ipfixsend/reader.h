@@ -57,15 +57,41 @@ enum READER_STATUS {
 /** Data type of the packet reader                                         */
 typedef struct reader_internal reader_t;
 
+/** Selection of packets to read                                           */
+struct reader_range {
+    uint32_t time_from;   /**< First Export Time (inclusive, in seconds)    */
+    uint32_t time_to;     /**< Last Export Time (inclusive, in seconds)     */
+    unsigned int threads; /**< Threads decompressing compressed files       */
+};
+
 /**
  * \brief Create a new packet reader
+ *
+ * Only packets with Export Time within the range are read. Files compressed by
+ * the IPFIX output plugin are always preloaded. Their blocks are selected by
+ * the seek index and decompressed in parallel.
  * \param[in] file     Path to the IPFIX file
  * \param[in] preload  Preload all IPFIX record to an internal buffer
+ * \param[in] range    Selection of packets
+ * \return On success returns a new pointer to instance of the reader. Otherwise
+ *   returns NULL.
+ */
+reader_t *
+reader_create(const char *file, bool preload, const struct reader_range *range);
+
+/**
+ * \brief Create a new packet reader of the same file
+ *
+ * The new reader is independent on the original one (i.e. it has its own
+ * position in the file and header rewriting), however, preloaded packets are
+ * shared. Therefore, the original reader MUST NOT be destroyed before its
+ * clones. Rewriting parameters are not copied.
+ * \param[in] reader Pointer to the original packet reader
  * \return On success returns a new pointer to instance of the reader. Otherwise
  *   returns NULL.
  */
 reader_t *
-reader_create(const char *file, bool preload);
+reader_clone(const reader_t *reader);
 
 /**
  * \brief Destroy a packet reader
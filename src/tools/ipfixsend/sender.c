@@ -38,7 +38,9 @@
  *
  */
 
+#include <endian.h>
 #include <errno.h>
+#include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <netdb.h>
@@ -49,20 +51,27 @@
 #include <sys/types.h>
 #include <netinet/in.h>
 
-#include <sys/time.h>
 #include <signal.h>
 
 #include "sender.h"
 #include "reader.h"
 #include "siso.h"
 
-/** 1 second in microseconds     */
-#define MICRO_SEC 1000000L
 /** 1 second in nanoseconds      */
 #define NANO_SEC 1000000000L
+/** Size of the buffer of batched packets */
+#define BATCH_BUFFER_SIZE (1024 * 1024)
 /** Global termination flag      */
 static volatile sig_atomic_t stop_sending = 0;
 
+/** Packets to be sent at once   */
+struct sender_batch {
+    char *data;                      /**< Packets one after another  */
+    size_t size;                     /**< Used size of the buffer    */
+    size_t lengths[SISO_BATCH_MAX];  /**< Size of each packet        */
+    unsigned int cnt;                /**< Number of packets          */
+};
+
 /** \brief Interrupt sending     */
 void sender_stop()
 {
@@ -80,86 +89,326 @@ int send_packet(sisoconf *sender, const struct fds_ipfix_msg_hdr *packet)
     return siso_send(sender, (const char *) packet, size);
 }
 
+/**
+ * \brief Send all batched packets
+ * \param[in] sender SISO instance
+ * \param[in] batch  Batch of packets
+ */
+static int send_batch(sisoconf *sender, struct sender_batch *batch)
+{
+    if (batch->cnt == 0) {
+        return SISO_OK;
+    }
+
+    int ret = siso_send_batch(sender, batch->data, batch->lengths, batch->cnt);
+    batch->size = 0;
+    batch->cnt = 0;
+    return ret;
+}
+
+/**
+ * \brief Send a packet or add it to the batch
+ *
+ * The batch is sent when it is full.
+ * \param[in] sender SISO instance
+ * \param[in] pkts   Batch of packets (used only if \p batch > 1)
+ * \param[in] batch  Max. number of packets in the batch
+ * \param[in] packet Packet to send
+ */
+static int send_queued(sisoconf *sender, struct sender_batch *pkts, unsigned int batch,
+    const struct fds_ipfix_msg_hdr *packet)
+{
+    if (batch == 1) {
+        return send_packet(sender, packet);
+    }
+
+    const size_t size = ntohs(packet->length);
+    if (pkts->size + size > BATCH_BUFFER_SIZE && send_batch(sender, pkts) != SISO_OK) {
+        return SISO_ERR;
+    }
+
+    memcpy(pkts->data + pkts->size, packet, size);
+    pkts->size += size;
+    pkts->lengths[pkts->cnt++] = size;
+    return (pkts->cnt < batch) ? SISO_OK : send_batch(sender, pkts);
+}
+
+/**
+ * \brief Prepare a batch of packets
+ * \param[in] pkts   Batch of packets
+ * \param[in] batch  Max. number of packets in the batch
+ * \return On success returns 0. Otherwise returns nonzero value.
+ */
+static int batch_init(struct sender_batch *pkts, unsigned int batch)
+{
+    memset(pkts, 0, sizeof(*pkts));
+    if (batch == 1) {
+        return 0;
+    }
+
+    pkts->data = malloc(BATCH_BUFFER_SIZE);
+    if (!pkts->data) {
+        fprintf(stderr, "Unable to allocate memory (%s:%d)!\n", __FILE__, __LINE__);
+        return 1;
+    }
+
+    return 0;
+}
+
 /**
  * \brief Calculate time difference
  * \param[in] start First timestamp
  * \param[in] end Second timestamp
- * \return Number of microseconds between timestamps
+ * \return Number of nanoseconds between timestamps
+ */
+static long long timespec_diff(const struct timespec *start, const struct timespec *end)
+{
+    return (end->tv_sec - start->tv_sec) * (long long) NANO_SEC
+        + (end->tv_nsec - start->tv_nsec);
+}
+
+/**
+ * \brief Sleep until a deadline
+ *
+ * Absolute deadlines are used so that inaccuracy of the sleep doesn't
+ * accumulate over time.
+ * \param[in] start  Reference timestamp (CLOCK_MONOTONIC)
+ * \param[in] offset Deadline relative to the reference timestamp (in nanoseconds)
+ */
+static void sleep_until(const struct timespec *start, long long offset)
+{
+    struct timespec wakeup = *start;
+    wakeup.tv_sec += offset / NANO_SEC;
+    wakeup.tv_nsec += offset % NANO_SEC;
+    if (wakeup.tv_nsec >= NANO_SEC) {
+        wakeup.tv_sec++;
+        wakeup.tv_nsec -= NANO_SEC;
+    }
+
+    while (stop_sending == 0
+        && clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &wakeup, NULL) == EINTR);
+}
+
+void sender_pacer_init(struct sender_pacer *pacer, int packets_s)
+{
+    pacer->cnt = 0;
+    pacer->time_per_pkt = (packets_s > 0) ? (double) NANO_SEC / packets_s : 0.0;
+    clock_gettime(CLOCK_MONOTONIC, &pacer->begin);
+}
+
+void sender_pacer_wait(struct sender_pacer *pacer, unsigned int packets)
+{
+    pacer->cnt += packets;
+    if (pacer->time_per_pkt == 0.0) {
+        // Limit for packets/s is not enabled
+        return;
+    }
+
+    // Calculate expected time of sending next packet
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    long long elapsed = timespec_diff(&pacer->begin, &now);
+    long long next_start = pacer->cnt * pacer->time_per_pkt;
+
+    if (elapsed - next_start > NANO_SEC) {
+        // Too late, don't try to catch up
+        pacer->begin = now;
+        pacer->cnt = 0;
+        return;
+    }
+
+    // Sleep
+    if (next_start > elapsed) {
+        sleep_until(&pacer->begin, next_start);
+    }
+}
+
+unsigned int sender_batch_limit(int packets_s, unsigned int batch)
+{
+    // Don't send more than 1 ms worth of packets at once
+    if (packets_s > 0 && batch > (unsigned int) packets_s / 1000U) {
+        batch = (unsigned int) packets_s / 1000U;
+    }
+
+    if (batch > SISO_BATCH_MAX) {
+        batch = SISO_BATCH_MAX;
+    }
+
+    return (batch > 1) ? batch : 1;
+}
+
+void sender_probe_init(struct sender_probe *probe, unsigned int interval_ms)
+{
+    probe->interval = interval_ms * 1000000LL;
+    probe->cnt = 0;
+    clock_gettime(CLOCK_MONOTONIC, &probe->next);
+}
+
+/**
+ * \brief Check if a latency probe should be sent
+ * \param[in] probe Probes (can be NULL)
+ * \return True if the probe should be sent now
+ */
+static bool probe_due(struct sender_probe *probe)
+{
+    if (probe == NULL || probe->interval == 0) {
+        return false;
+    }
+
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    long long diff = timespec_diff(&probe->next, &now);
+    if (diff < 0) {
+        return false;
+    }
+
+    // Plan the next probe (skip missed ones)
+    long long offset = (diff / probe->interval + 1) * probe->interval;
+    probe->next.tv_sec += offset / NANO_SEC;
+    probe->next.tv_nsec += offset % NANO_SEC;
+    if (probe->next.tv_nsec >= NANO_SEC) {
+        probe->next.tv_sec++;
+        probe->next.tv_nsec -= NANO_SEC;
+    }
+
+    return true;
+}
+
+/**
+ * \brief Send a latency probe
+ *
+ * Batched packets are sent first so the probe doesn't overtake them.
+ * \param[in] sender SISO instance
+ * \param[in] pkts   Batch of packets
+ * \param[in] probe  Probes
  */
-long timeval_diff(const struct timeval *start, const struct timeval *end)
+static int send_probe(sisoconf *sender, struct sender_batch *pkts, struct sender_probe *probe)
 {
-    return (end->tv_sec - start->tv_sec) * MICRO_SEC
-        + (end->tv_usec - start->tv_usec);
+    // Template Set (2 enterprise fields) and Data Set (2 x unsigned64)
+    const uint16_t tset_len = FDS_IPFIX_SET_HDR_LEN + 4 + 2 * 8;
+    const uint16_t dset_len = FDS_IPFIX_SET_HDR_LEN + 2 * 8;
+    const uint16_t msg_len = FDS_IPFIX_MSG_HDR_LEN + tset_len + dset_len;
+    const uint16_t tmplt_id = 256;
+    uint8_t msg[FDS_IPFIX_MSG_HDR_LEN + FDS_IPFIX_SET_HDR_LEN * 2 + 4 + 4 * 8];
+    uint8_t *ptr = msg;
+
+    if (send_batch(sender, pkts) != SISO_OK) {
+        return SISO_ERR;
+    }
+
+    struct fds_ipfix_msg_hdr *hdr = (struct fds_ipfix_msg_hdr *) ptr;
+    hdr->version = htons(FDS_IPFIX_VERSION);
+    hdr->length = htons(msg_len);
+    hdr->seq_num = htonl((uint32_t) probe->cnt);
+    hdr->odid = htonl(SENDER_PROBE_ODID);
+    ptr += FDS_IPFIX_MSG_HDR_LEN;
+
+    const uint16_t tset[] = {
+        htons(FDS_IPFIX_SET_TMPLT), htons(tset_len), htons(tmplt_id), htons(2),
+        htons(SENDER_PROBE_IE_TIME | 0x8000), htons(8),
+        htons(SENDER_PROBE_PEN >> 16), htons(SENDER_PROBE_PEN & 0xFFFF),
+        htons(SENDER_PROBE_IE_SEQ | 0x8000), htons(8),
+        htons(SENDER_PROBE_PEN >> 16), htons(SENDER_PROBE_PEN & 0xFFFF),
+    };
+    memcpy(ptr, tset, sizeof(tset));
+    ptr += sizeof(tset);
+
+    const uint16_t dset[] = {htons(tmplt_id), htons(dset_len)};
+    memcpy(ptr, dset, sizeof(dset));
+    ptr += sizeof(dset);
+
+    // Timestamp as close to sending as possible
+    struct timespec now;
+    clock_gettime(CLOCK_REALTIME, &now);
+    hdr->export_time = htonl((uint32_t) now.tv_sec);
+
+    const uint64_t values[] = {
+        htobe64((uint64_t) now.tv_sec * NANO_SEC + (uint64_t) now.tv_nsec),
+        htobe64(probe->cnt),
+    };
+    memcpy(ptr, values, sizeof(values));
+
+    probe->cnt++;
+    return siso_send(sender, (const char *) msg, msg_len);
 }
 
 /**
  * \brief Send all packets from array with speed limitation
  */
-int send_packets_limit(sisoconf *sender, reader_t *reader, int packets_s)
+int send_packets_limit(sisoconf *sender, reader_t *reader, int packets_s,
+    unsigned int batch, struct sender_probe *probe)
 {
     enum READER_STATUS status;
     struct fds_ipfix_msg_hdr *pkt_data;
-    struct timeval begin, end;
-    struct timespec sleep_time = {0};
+    struct sender_pacer pacer;
+    struct sender_batch pkts;
+    unsigned int pending = 0; // packets sent since the last pacing
+    int ret = 0;
 
-    // These must be static variables - local would be rewritten with each call of send_packets
-    int pkts_from_begin = 0;
-    double time_per_pkt; // [ms]
+    batch = sender_batch_limit(packets_s, batch);
+    if (batch_init(&pkts, batch) != 0) {
+        return 1;
+    }
 
     // Absolutely first packet
-    gettimeofday(&begin, NULL);
-    time_per_pkt = 1000000.0 / packets_s; // [micro seconds]
+    sender_pacer_init(&pacer, packets_s);
 
     while (stop_sending == 0) {
         status = reader_get_next_packet(reader, &pkt_data, NULL);
         if (status == READER_EOF) {
             break;
         } else if (status == READER_ERROR) {
-            return 1;
+            ret = 1;
+            break;
         }
 
-        // send packet
-        int ret = send_packet(sender, pkt_data);
-        if (ret != SISO_OK) {
+        // send packet(s)
+        if ((probe_due(probe) && send_probe(sender, &pkts, probe) != SISO_OK)
+                || send_queued(sender, &pkts, batch, pkt_data) != SISO_OK) {
             fprintf(stderr, "Network error: %s\n", siso_get_last_err(sender));
-            return 1;
+            ret = 1;
+            break;
         }
 
-        pkts_from_begin++;
-        if (packets_s <= 0) {
-            // Limit for packets/s is not enabled
-            continue;
+        pending++;
+        if (pkts.cnt == 0) {
+            // Everything has been sent
+            sender_pacer_wait(&pacer, pending);
+            pending = 0;
         }
+    };
 
-        // Calculate expected time of sending next packet
-        gettimeofday(&end, NULL);
-        long elapsed = timeval_diff(&begin, &end);
-        if (elapsed < 0) {
-            // Should be never negative. Just for sure...
-            elapsed = pkts_from_begin * time_per_pkt;
-        }
+    if (ret == 0 && send_batch(sender, &pkts) != SISO_OK) {
+        fprintf(stderr, "Network error: %s\n", siso_get_last_err(sender));
+        ret = 1;
+    }
 
-        long next_start = pkts_from_begin * time_per_pkt;
-        long diff = next_start - elapsed;
+    free(pkts.data);
+    return ret;
+}
 
-        if (diff >= MICRO_SEC) {
-            diff = MICRO_SEC - 1;
-        }
+/**
+ * \brief Send all packets from array by a fleet of exporters
+ */
+int send_packets_fleet(fleet_t *fleet, reader_t *reader)
+{
+    enum READER_STATUS status;
+    struct fds_ipfix_msg_hdr *pkt_data;
 
-        // Sleep
-        if (diff > 0) {
-            sleep_time.tv_nsec = diff * 1000L;
-            nanosleep(&sleep_time, NULL);
+    while (stop_sending == 0) {
+        status = reader_get_next_packet(reader, &pkt_data, NULL);
+        if (status == READER_EOF) {
+            break;
+        } else if (status == READER_ERROR) {
+            return 1;
         }
 
-        if (pkts_from_begin >= packets_s) {
-            // Restart counter
-            gettimeofday(&begin, NULL);
-            pkts_from_begin = 0;
+        if (fleet_send(fleet, pkt_data) != 0) {
+            return 1;
         }
-    };
+    }
 
-    return 0;
+    return fleet_flush(fleet);
 }
 
 /**
@@ -236,16 +485,26 @@ int ts_grp_cnt(reader_t *reader)
 
 /**
  * \brief Send all packets from array with real-time simulation
+ *
+ * Packets are replayed on a single timeline, which starts with the first packet.
+ * A packet of a group with the same export time (see ts_grp_cnt()) is expected
+ * at (export time - first export time + index in group / group size) / speed,
+ * i.e. packets of each second are spread evenly over the second. Deadlines are
+ * absolute, so inaccurate sleeping doesn't accumulate. If the sender cannot keep
+ * up, packets are sent immediately (in batches) until it catches up.
  */
-int send_packets_realtime(sisoconf *sender, reader_t *reader, double speed)
+int send_packets_realtime(sisoconf *sender, reader_t *reader, double speed,
+    unsigned int batch, struct sender_probe *probe)
 {
     int grp_cnt = 0; // Number of packets in a group with same timestamp
     int grp_id = 0;  // Index of the packet in the group
     uint32_t grp_ts_prev = 0;
     uint32_t grp_ts_now;
-    double time_per_pkt = 0.0;
-    struct timeval group_ts_start, end;
+    double grp_start = 0.0; // Start of the group since the first group [s]
+    struct timespec begin, now;
     struct fds_ipfix_msg_hdr *new_packet = NULL;
+    struct sender_batch pkts;
+    int ret = 0;
 
     if (reader_position_push(reader) != READER_OK) {
         return 1;
@@ -260,6 +519,13 @@ int send_packets_realtime(sisoconf *sender, reader_t *reader, double speed)
         return 1;
     }
 
+    batch = sender_batch_limit(0, batch);
+    if (batch_init(&pkts, batch) != 0) {
+        return 1;
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &begin);
+
     while (stop_sending == 0) {
         if (grp_cnt == grp_id) {
             // New group
@@ -272,65 +538,65 @@ int send_packets_realtime(sisoconf *sender, reader_t *reader, double speed)
 
             if (grp_cnt < 0) {
                 // Error
-                return 1;
+                ret = 1;
+                break;
             }
 
             // Prepare a new packet
             if (reader_get_next_packet(reader, &new_packet, NULL) != READER_OK) {
                 // This can not be EOF -> it must be error
-                return 1;
+                ret = 1;
+                break;
             }
 
             grp_ts_prev = grp_ts_now;
             grp_ts_now = ntohl(new_packet->export_time);
-            time_per_pkt = 1000000.0 / (grp_cnt * speed); // [micro seconds]
-
-            // Sleep between time groups only when difference > 1 second
-            if (ts_cmp(grp_ts_now, grp_ts_prev + 1) > 0) {
-                double  seconds_diff = (grp_ts_now - grp_ts_prev - 1) / speed;
-                struct timespec sleep_time;
-                sleep_time.tv_sec = (int) seconds_diff;
-                sleep_time.tv_nsec = (seconds_diff - (int) seconds_diff) * NANO_SEC;
-                nanosleep(&sleep_time, NULL);
-            }
 
-            gettimeofday(&group_ts_start, NULL);
+            // The timeline never goes back (late packets belong to the current group)
+            if (ts_cmp(grp_ts_now, grp_ts_prev) > 0) {
+                grp_start += (uint32_t) (grp_ts_now - grp_ts_prev);
+            } else {
+                grp_ts_now = grp_ts_prev;
+            }
         } else {
             // Prepare a new packet
             if (reader_get_next_packet(reader, &new_packet, NULL) != READER_OK) {
                 // This can not be EOF -> it must be error
-                return 1;
+                ret = 1;
+                break;
             }
         }
 
-        // Send the packet
-        int ret = send_packet(sender, new_packet);
-        if (ret != SISO_OK) {
-            fprintf(stderr, "Network error: %s\n", siso_get_last_err(sender));
-            return 1;
-        }
-
+        // Expected time of sending the packet
+        long long deadline = (grp_start + (double) grp_id / grp_cnt) * NANO_SEC / speed;
         ++grp_id;
 
-        // Calculate expected time of sending next packet
-        gettimeofday(&end, NULL);
-        long elapsed = timeval_diff(&group_ts_start, &end);
-        if (elapsed < 0) {
-            // Should be never negative. Just for sure...
-            elapsed = grp_id * time_per_pkt;
-        }
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        if (deadline > timespec_diff(&begin, &now)) {
+            // Ahead of time, send batched packets and wait
+            if (send_batch(sender, &pkts) != SISO_OK) {
+                fprintf(stderr, "Network error: %s\n", siso_get_last_err(sender));
+                ret = 1;
+                break;
+            }
 
-        long next_start = grp_id * time_per_pkt;
-        long diff = next_start - elapsed;
+            sleep_until(&begin, deadline);
+        }
 
-        // Sleep between packets in the group
-        if (diff > 0) {
-            struct timespec sleep_time;
-            sleep_time.tv_sec = diff / MICRO_SEC;
-            sleep_time.tv_nsec = (diff % MICRO_SEC) * 1000L;
-            nanosleep(&sleep_time, NULL);
+        // Send the packet
+        if ((probe_due(probe) && send_probe(sender, &pkts, probe) != SISO_OK)
+                || send_queued(sender, &pkts, batch, new_packet) != SISO_OK) {
+            fprintf(stderr, "Network error: %s\n", siso_get_last_err(sender));
+            ret = 1;
+            break;
         }
     }
 
-    return 0;
+    if (ret == 0 && send_batch(sender, &pkts) != SISO_OK) {
+        fprintf(stderr, "Network error: %s\n", siso_get_last_err(sender));
+        ret = 1;
+    }
+
+    free(pkts.data);
+    return ret;
 }
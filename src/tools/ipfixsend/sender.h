@@ -42,28 +42,122 @@
 #define	SENDER_H
 
 #include <netdb.h>
+#include <time.h>
 #include "siso.h"
 #include "reader.h"
+#include "fleet.h"
+
+/**
+ * \brief Pacing of sent packets (packets/s limit)
+ *
+ * The n-th packet is not sent before begin + n / rate. Absolute deadlines are
+ * used so that inaccuracy of sleeping doesn't accumulate over time.
+ */
+struct sender_pacer {
+    struct timespec begin; /**< Beginning of pacing (CLOCK_MONOTONIC)        */
+    long long cnt;         /**< Packets sent since the beginning             */
+    double time_per_pkt;   /**< Interval between packets [ns] (0 = no limit) */
+};
+
+/**
+ * \brief Start pacing
+ * \param[in] pacer     Pacer
+ * \param[in] packets_s packets/s limit (0 = no limit)
+ */
+void sender_pacer_init(struct sender_pacer *pacer, int packets_s);
+
+/**
+ * \brief Account sent packets and wait until the next packet can be sent
+ *
+ * If the sender has fallen behind for more than a second (e.g. the process
+ * was suspended), pacing is restarted instead of trying to catch up.
+ * \param[in] pacer   Pacer
+ * \param[in] packets Number of packets sent since the previous call
+ */
+void sender_pacer_wait(struct sender_pacer *pacer, unsigned int packets);
+
+/**
+ * \brief Get the max. number of packets sent at once
+ *
+ * To avoid bursts, the batch is reduced when the packets/s limit is low, so
+ * that each batch represents at most 1 millisecond of sending.
+ * \param[in] packets_s packets/s limit (0 = no limit)
+ * \param[in] batch     Requested batch size
+ * \return Batch size (1 .. #SISO_BATCH_MAX)
+ */
+unsigned int sender_batch_limit(int packets_s, unsigned int batch);
+
+/**
+ * \brief Latency probes
+ *
+ * A probe is an IPFIX Message with a single Data Record, which contains the time
+ * of sending (unsigned64, nanoseconds since UNIX epoch, #SENDER_PROBE_IE_TIME)
+ * and the sequence number of the probe (unsigned64, #SENDER_PROBE_IE_SEQ).
+ * Both fields are defined by the Enterprise Number for Documentation Use
+ * (RFC 5612). The template is sent in each probe. Probes use their own ODID
+ * (#SENDER_PROBE_ODID), so sequence numbers of other messages are unaffected.
+ */
+struct sender_probe {
+    long long interval;    /**< Interval between probes [ns] (0 = disabled)  */
+    struct timespec next;  /**< Time of the next probe (CLOCK_MONOTONIC)     */
+    uint64_t cnt;          /**< Number of sent probes                        */
+};
+
+/** Private Enterprise Number of probe fields (Documentation Use, RFC 5612)  */
+#define SENDER_PROBE_PEN 32473U
+/** Information Element ID of the time of sending                            */
+#define SENDER_PROBE_IE_TIME 1U
+/** Information Element ID of the sequence number of the probe               */
+#define SENDER_PROBE_IE_SEQ 2U
+/** ODID of probes                                                           */
+#define SENDER_PROBE_ODID UINT32_MAX
+
+/**
+ * \brief Prepare latency probes
+ * \param[in] probe       Probes
+ * \param[in] interval_ms Interval between probes [ms] (0 = disabled)
+ */
+void sender_probe_init(struct sender_probe *probe, unsigned int interval_ms);
 
 /**
  * \brief Send all packets from array with speed limitation
  *
+ * Up to \p batch packets are passed to the network stack at once (see
+ * siso_send_batch() and sender_batch_limit()).
  * \param[in] sender    sisoconf object
  * \param[in] reader    Input file
  * \param[in] packets_s packets/s limit
+ * \param[in] batch     max. number of packets sent at once (1 .. #SISO_BATCH_MAX)
+ * \param[in] probe     Latency probes inserted between packets (can be NULL)
  * \return On success returns 0. Otherwise returns nonzero value.
  */
-int send_packets_limit(sisoconf *sender, reader_t *reader, int packets_s);
+int send_packets_limit(sisoconf *sender, reader_t *reader, int packets_s,
+    unsigned int batch, struct sender_probe *probe);
 
 /**
  * \brief Send all packets from array with real-time simulation
  *
+ * Packets with the same export time are spread evenly over the second.
+ * If the sender is late, up to \p batch packets are sent at once.
  * \param[in] sender sisoconf object
  * \param[in] reader Input file
  * \param[in] speed  Speed-up compared to real-time (multiples)
+ * \param[in] batch  max. number of packets sent at once (1 .. #SISO_BATCH_MAX)
+ * \param[in] probe  Latency probes inserted between packets (can be NULL)
+ * \return On success returns 0. Otherwise returns nonzero value.
+ */
+int send_packets_realtime(sisoconf *sender, reader_t *reader, double speed,
+    unsigned int batch, struct sender_probe *probe);
+
+/**
+ * \brief Send all packets from array by a fleet of exporters
+ *
+ * Each packet is sent by all sessions of the fleet (see fleet_send()).
+ * \param[in] fleet  Fleet
+ * \param[in] reader Input file
  * \return On success returns 0. Otherwise returns nonzero value.
  */
-int send_packets_realtime(sisoconf *sender, reader_t *reader, double speed);
+int send_packets_fleet(fleet_t *fleet, reader_t *reader);
 
 /**
  * \brief Stop sending data
@@ -37,6 +37,7 @@
  *
  */
 
+#define _GNU_SOURCE
 #include "siso.h"
 
 #include <stdbool.h>
@@ -48,8 +49,8 @@
 #include <unistd.h>
 #include <sys/types.h>
 #include <sys/socket.h>
+#include <sys/uio.h>
 
-#include <sys/time.h>
 #include <time.h>
 
 #include <fcntl.h>
@@ -79,6 +80,8 @@
  * \return Minimum
  */
 #define SISO_MIN(frst, scnd) ((frst) > (scnd) ? (scnd) : (frst))
+/** 1 second in nanoseconds                                                 */
+#define SISO_NANO_SEC 1000000000LL
 
 /** Accepted connection types                */
 enum siso_conn_type {
@@ -120,8 +123,8 @@ struct sisoconf_s {
     struct addrinfo *servinfo;  /**< server information */
     int sockfd;                 /**< socket descriptor */
     uint64_t max_speed;         /**< max sending speed */
-    uint64_t act_speed;         /**< actual speed */
-    struct timeval begin, end;  /**< start/end time for limited transfers */
+    uint64_t act_speed;         /**< bytes sent since the beginning of limited transfer */
+    struct timespec begin;      /**< beginning of limited transfer */
 };
 
 /**
@@ -362,6 +365,57 @@ int siso_reconnect(sisoconf *conf)
     return siso_create_socket(conf);
 }
 
+/**
+ * \brief Apply the speed limit after sending data
+ *
+ * Sending is paced by absolute deadlines (i.e. n-th byte is not sent before
+ * begin + n / max_speed) so the rate doesn't drift due to inaccurate sleeping.
+ * If the sender has fallen behind for more than a second, the pacing is
+ * restarted instead of sending a burst.
+ * \param[in] conf sisoconf configuration
+ * \param[in] sent number of sent bytes
+ */
+static void siso_speed_limit(sisoconf *conf, size_t sent)
+{
+    if (!conf->max_speed) {
+        return;
+    }
+
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    if (conf->begin.tv_sec == 0 && conf->begin.tv_nsec == 0) {
+        conf->begin = now;
+    }
+
+    conf->act_speed += sent;
+
+    // Expected time of the next byte (relative to the beginning)
+    long long deadline = (long long) ((double) conf->act_speed * SISO_NANO_SEC / conf->max_speed);
+    long long elapsed = (now.tv_sec - conf->begin.tv_sec) * SISO_NANO_SEC
+        + (now.tv_nsec - conf->begin.tv_nsec);
+
+    if (elapsed - deadline > SISO_NANO_SEC) {
+        // Too late, start again
+        conf->begin = now;
+        conf->act_speed = 0;
+        return;
+    }
+
+    if (deadline <= elapsed) {
+        return;
+    }
+
+    struct timespec wakeup = conf->begin;
+    wakeup.tv_sec += deadline / SISO_NANO_SEC;
+    wakeup.tv_nsec += deadline % SISO_NANO_SEC;
+    if (wakeup.tv_nsec >= SISO_NANO_SEC) {
+        wakeup.tv_sec++;
+        wakeup.tv_nsec -= SISO_NANO_SEC;
+    }
+
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &wakeup, NULL) == EINTR);
+}
+
 /**
  * \brief Send data
  */
@@ -411,22 +465,84 @@ int siso_send(sisoconf *conf, const char *data, ssize_t length)
         todo -= sent_now;
 
         // check speed limit
-        conf->act_speed += sent_now;
-        if (conf->max_speed && conf->act_speed >= conf->max_speed) {
-            gettimeofday(&(conf->end), NULL);
-
-            // Should sleep?
-            double elapsed = conf->end.tv_usec - conf->begin.tv_usec;
-            if (elapsed < 1000000.0) {
-                usleep(1000000.0 - elapsed);
-                gettimeofday(&(conf->end), NULL);
+        siso_speed_limit(conf, sent_now);
+    }
+
+    return SISO_OK;
+}
+
+/**
+ * \brief Send a batch of messages
+ */
+int siso_send_batch(sisoconf *conf, const char *data, const size_t *lengths,
+    unsigned int count)
+{
+    CHECK_PTR(conf);
+
+    struct mmsghdr msgs[SISO_BATCH_MAX];
+    struct iovec iovs[SISO_BATCH_MAX];
+    size_t total = 0;
+    unsigned int i;
+
+    if (count > SISO_BATCH_MAX) {
+        count = SISO_BATCH_MAX;
+    }
+
+    for (i = 0; i < count; ++i) {
+        total += lengths[i];
+    }
+
+    if (conf->type != SC_UDP) {
+        // Stream protocols don't preserve message boundaries anyway
+        return siso_send(conf, data, total);
+    }
+
+    const char *ptr = data;
+    for (i = 0; i < count; ++i) {
+        if (lengths[i] > SISO_UDP_MAX) {
+            // Too long message is split by siso_send()
+            break;
+        }
+
+        iovs[i].iov_base = (void *) ptr;
+        iovs[i].iov_len = lengths[i];
+        memset(&msgs[i], 0, sizeof(msgs[i]));
+        msgs[i].msg_hdr.msg_iov = &iovs[i];
+        msgs[i].msg_hdr.msg_iovlen = 1;
+        ptr += lengths[i];
+    }
+
+    if (i != count) {
+        // Fallback, send the messages one by one
+        for (i = 0; i < count; ++i) {
+            CHECK_RETVAL(siso_send(conf, data, lengths[i]));
+            data += lengths[i];
+        }
+        return SISO_OK;
+    }
+
+    unsigned int done = 0;
+    while (done < count) {
+        int sent_now = sendmmsg(conf->sockfd, &msgs[done], count - done, MSG_NOSIGNAL);
+        if (sent_now == -1) {
+            if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+                // Connection broken, close...
+                conf->last_error = PERROR_LAST;
+                siso_close_connection(conf);
+                return SISO_ERR;
             }
 
-            // reinit values
-            conf->begin = conf->end;
-            conf->act_speed = 0;
+            // Probably a signal occurred. Try again.
+            continue;
+        }
+
+        size_t sent_bytes = 0;
+        for (i = done; i < done + (unsigned int) sent_now; ++i) {
+            sent_bytes += lengths[i];
         }
 
+        done += sent_now;
+        siso_speed_limit(conf, sent_bytes);
     }
 
     return SISO_OK;
@@ -57,6 +57,11 @@ extern "C" {
  * \brief Status code for failure
  */
 #define SISO_ERR 1
+/**
+ * \def SISO_BATCH_MAX
+ * \brief Maximum number of messages sent by siso_send_batch()
+ */
+#define SISO_BATCH_MAX 64
 
 /**
  * \brief Main structure
@@ -194,6 +199,25 @@ int siso_reconnect(sisoconf *conf);
  */
 int siso_send(sisoconf *conf, const char *data, ssize_t length);
 
+/**
+ * \brief Send a batch of messages
+ *
+ * The messages are stored one after another in the \p data buffer. UDP messages
+ * are sent as separate datagrams by as few system calls (sendmmsg) as possible.
+ * Messages of stream protocols are sent at once. Speed limit is applied in
+ * the same way as by siso_send().
+ *
+ * When the #SISO_ERR is returned, than the connection is broken and must
+ * be reinitialized using siso_reconnect()
+ * \param[in] conf    sisoconf configuration
+ * \param[in] data    messages to be sent
+ * \param[in] lengths length of each message
+ * \param[in] count   number of messages (max. #SISO_BATCH_MAX)
+ * \return #SISO_OK or #SISO_ERR and sets error message (see siso_get_last_err() for details)
+ */
+int siso_send_batch(sisoconf *conf, const char *data, const size_t *lengths,
+    unsigned int count);
+
 #ifdef	__cplusplus
 }
 #endif
@@ -0,0 +1,209 @@
+
+#include <cstring>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "captureFile.hpp"
+
+namespace pcap2ipfix {
+
+static constexpr uint32_t PCAP_MAGIC_USEC = 0xA1B2C3D4;
+static constexpr uint32_t PCAP_MAGIC_NSEC = 0xA1B23C4D;
+static constexpr size_t PCAP_HDR_LEN = 24;
+static constexpr size_t PCAP_REC_HDR_LEN = 16;
+
+static constexpr uint32_t PCAPNG_SHB = 0x0A0D0D0A;
+static constexpr uint32_t PCAPNG_IDB = 0x00000001;
+static constexpr uint32_t PCAPNG_PB = 0x00000002;
+static constexpr uint32_t PCAPNG_SPB = 0x00000003;
+static constexpr uint32_t PCAPNG_EPB = 0x00000006;
+static constexpr uint32_t PCAPNG_BYTE_ORDER = 0x1A2B3C4D;
+
+static uint32_t
+bswap32(uint32_t value)
+{
+    return __builtin_bswap32(value);
+}
+
+CaptureFile::CaptureFile(const std::string &path)
+{
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error("Unable to open '" + path + "': " + strerror(errno));
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        const std::string err = strerror(errno);
+        close(fd);
+        throw std::runtime_error("Unable to get size of '" + path + "': " + err);
+    }
+
+    m_size = static_cast<size_t>(st.st_size);
+    if (m_size < PCAP_HDR_LEN) {
+        close(fd);
+        throw std::runtime_error("'" + path + "' is not a PCAP/PCAPng file");
+    }
+
+    void *data = mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) {
+        throw std::runtime_error("Unable to map '" + path + "': " + strerror(errno));
+    }
+
+    madvise(data, m_size, MADV_SEQUENTIAL);
+    m_data = static_cast<const uint8_t *>(data);
+
+    uint32_t magic;
+    std::memcpy(&magic, m_data, sizeof(magic));
+
+    if (magic == PCAP_MAGIC_USEC || magic == PCAP_MAGIC_NSEC) {
+        m_swapped = false;
+    } else if (bswap32(magic) == PCAP_MAGIC_USEC || bswap32(magic) == PCAP_MAGIC_NSEC) {
+        m_swapped = true;
+    } else if (magic == PCAPNG_SHB) {
+        // Byte order is determined by each Section Header Block
+        m_pcapng = true;
+        return;
+    } else {
+        munmap(data, m_size);
+        throw std::runtime_error("'" + path + "' is not a PCAP/PCAPng file");
+    }
+
+    m_linktype = static_cast<uint16_t>(read32(20));
+    m_pos = PCAP_HDR_LEN;
+}
+
+CaptureFile::~CaptureFile()
+{
+    munmap(const_cast<uint8_t *>(m_data), m_size);
+}
+
+uint32_t
+CaptureFile::read32(size_t offset) const
+{
+    uint32_t value;
+    std::memcpy(&value, m_data + offset, sizeof(value));
+    return m_swapped ? bswap32(value) : value;
+}
+
+uint16_t
+CaptureFile::read16(size_t offset) const
+{
+    uint16_t value;
+    std::memcpy(&value, m_data + offset, sizeof(value));
+    return m_swapped ? __builtin_bswap16(value) : value;
+}
+
+bool
+CaptureFile::next(Packet &pkt)
+{
+    return m_pcapng ? next_pcapng(pkt) : next_pcap(pkt);
+}
+
+bool
+CaptureFile::next_pcap(Packet &pkt)
+{
+    if (m_pos + PCAP_REC_HDR_LEN > m_size) {
+        // End of file (a truncated record header is ignored)
+        return false;
+    }
+
+    const uint32_t caplen = read32(m_pos + 8);
+    const size_t data_pos = m_pos + PCAP_REC_HDR_LEN;
+    if (caplen > m_size - data_pos) {
+        // Truncated capture (e.g. interrupted capturing)
+        m_pos = m_size;
+        return false;
+    }
+
+    pkt.data = m_data + data_pos;
+    pkt.caplen = caplen;
+    pkt.linktype = m_linktype;
+    m_pos = data_pos + caplen;
+    return true;
+}
+
+bool
+CaptureFile::next_pcapng(Packet &pkt)
+{
+    while (m_pos + 12 <= m_size) {
+        uint32_t type;
+        std::memcpy(&type, m_data + m_pos, sizeof(type));
+
+        if (type == PCAPNG_SHB) {
+            // New section, determine its byte order
+            uint32_t order;
+            std::memcpy(&order, m_data + m_pos + 8, sizeof(order));
+            if (order == PCAPNG_BYTE_ORDER) {
+                m_swapped = false;
+            } else if (bswap32(order) == PCAPNG_BYTE_ORDER) {
+                m_swapped = true;
+            } else {
+                throw std::runtime_error("Malformed PCAPng Section Header Block");
+            }
+            m_interfaces.clear();
+        } else {
+            type = m_swapped ? bswap32(type) : type;
+        }
+
+        const uint32_t len = read32(m_pos + 4);
+        if (len < 12 || len % 4 != 0) {
+            throw std::runtime_error("Malformed PCAPng block");
+        }
+        if (len > m_size - m_pos) {
+            // Truncated capture
+            m_pos = m_size;
+            return false;
+        }
+
+        const size_t body = m_pos + 8;
+        const size_t body_len = len - 12;
+        m_pos += len;
+
+        switch (type) {
+        case PCAPNG_IDB:
+            if (body_len < 8) {
+                throw std::runtime_error("Malformed PCAPng Interface Description Block");
+            }
+            m_interfaces.push_back(read16(body));
+            break;
+        case PCAPNG_EPB:
+        case PCAPNG_PB: {
+            if (body_len < 20) {
+                throw std::runtime_error("Malformed PCAPng Packet Block");
+            }
+            const uint32_t iface = (type == PCAPNG_EPB) ? read32(body) : read16(body);
+            const uint32_t caplen = read32(body + 12);
+            if (iface >= m_interfaces.size() || caplen > body_len - 20) {
+                throw std::runtime_error("Malformed PCAPng Packet Block");
+            }
+            pkt.data = m_data + body + 20;
+            pkt.caplen = caplen;
+            pkt.linktype = m_interfaces[iface];
+            return true;
+        }
+        case PCAPNG_SPB: {
+            if (body_len < 4 || m_interfaces.empty()) {
+                throw std::runtime_error("Malformed PCAPng Simple Packet Block");
+            }
+            const uint32_t origlen = read32(body);
+            pkt.data = m_data + body + 4;
+            pkt.caplen = static_cast<uint32_t>(std::min<size_t>(origlen, body_len - 4));
+            pkt.linktype = m_interfaces[0];
+            return true;
+        }
+        default:
+            // Other blocks (statistics, name resolution, etc.) are skipped
+            break;
+        }
+    }
+
+    return false;
+}
+
+} // pcap2ipfix
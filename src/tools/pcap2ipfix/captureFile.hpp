@@ -0,0 +1,78 @@
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace pcap2ipfix {
+
+/**
+ * @brief Captured packet.
+ *
+ * The data point directly into the memory mapped capture file.
+ */
+struct Packet {
+    const uint8_t *data;   ///< Captured data
+    uint32_t caplen;       ///< Size of captured data
+    uint16_t linktype;     ///< Link-layer header type (LINKTYPE_*)
+};
+
+/**
+ * @brief Sequential reader of a PCAP or PCAPng file.
+ *
+ * The file is mapped into memory, so packets are not copied. Both byte orders
+ * and both timestamp resolutions of PCAP are supported. In case of PCAPng,
+ * Enhanced, Simple and (obsolete) Packet Blocks of all sections are read.
+ */
+class CaptureFile {
+public:
+    /**
+     * @brief Open and map a capture file.
+     * @param[in] path  Path to the file
+     * @throw std::runtime_error if the file cannot be opened or it is not
+     *   a PCAP/PCAPng file
+     */
+    explicit CaptureFile(const std::string &path);
+    ~CaptureFile();
+
+    CaptureFile(const CaptureFile &) = delete;
+    CaptureFile &operator=(const CaptureFile &) = delete;
+
+    /**
+     * @brief Get the next packet.
+     * @param[out] pkt  Packet
+     * @return False at the end of the file.
+     * @throw std::runtime_error if the file is malformed
+     */
+    bool
+    next(Packet &pkt);
+
+    /** @brief Get the size of the file. */
+    size_t
+    size() const { return m_size; }
+
+private:
+    const uint8_t *m_data = nullptr;
+    size_t m_size = 0;
+    size_t m_pos = 0;
+
+    bool m_pcapng = false;
+    bool m_swapped = false;
+    uint16_t m_linktype = 0;
+    /// Link-layer types of interfaces of the current PCAPng section
+    std::vector<uint16_t> m_interfaces;
+
+    uint32_t
+    read32(size_t offset) const;
+    uint16_t
+    read16(size_t offset) const;
+
+    bool
+    next_pcap(Packet &pkt);
+    bool
+    next_pcapng(Packet &pkt);
+};
+
+} // pcap2ipfix
@@ -0,0 +1,434 @@
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <future>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include <netinet/in.h>
+#include <unistd.h>
+
+#include "captureFile.hpp"
+#include "packetDecoder.hpp"
+#include "tcpStream.hpp"
+
+using namespace pcap2ipfix;
+
+/** Number of packets decoded as one job */
+static constexpr size_t CHUNK_PACKETS = 16384;
+/** Size of the buffer of an output file */
+static constexpr size_t OUTPUT_BUFFER = 4U << 20;
+
+/**
+ * @brief Configuration of the conversion.
+ */
+struct Config {
+    std::string input;
+    std::string output;
+    /// Only sessions with this source or destination port (0 = all)
+    uint16_t port = 0;
+    /// Write each transport session to a separate file
+    bool split = false;
+    unsigned threads = 0;
+};
+
+/**
+ * @brief Payloads of a chunk of packets and results of their decoding.
+ */
+struct Chunk {
+    std::vector<Payload> payloads;
+    uint64_t results[DECODE_RESULTS] = {};
+};
+
+/**
+ * @brief Output file with IPFIX Messages.
+ */
+class Output {
+public:
+    explicit Output(const std::string &path) :
+        m_path(path),
+        m_file(fopen(path.c_str(), "wb"))
+    {
+        if (!m_file) {
+            throw std::runtime_error("Unable to create '" + path + "': " + strerror(errno));
+        }
+        setvbuf(m_file, nullptr, _IOFBF, OUTPUT_BUFFER);
+    }
+
+    ~Output()
+    {
+        if (m_file) {
+            fclose(m_file);
+        }
+    }
+
+    Output(const Output &) = delete;
+    Output &operator=(const Output &) = delete;
+
+    void
+    write(const uint8_t *data, size_t size)
+    {
+        if (fwrite(data, 1, size, m_file) != size) {
+            throw std::runtime_error("Failed to write '" + m_path + "'");
+        }
+        m_bytes += size;
+    }
+
+    void
+    close()
+    {
+        FILE *file = m_file;
+        m_file = nullptr;
+        if (fclose(file) != 0) {
+            throw std::runtime_error("Failed to write '" + m_path + "'");
+        }
+    }
+
+    uint64_t
+    bytes() const { return m_bytes; }
+
+private:
+    std::string m_path;
+    FILE *m_file;
+    uint64_t m_bytes = 0;
+};
+
+/**
+ * @brief Transport session of an exporter.
+ */
+struct Session {
+    size_t id;                          ///< Sequence number of the session (from 0)
+    Output *output;                     ///< Output file of the session
+    std::unique_ptr<Output> own;        ///< Output file (split mode only)
+    std::unique_ptr<TcpStream> stream;  ///< Reassembler (TCP only)
+    uint64_t messages = 0;              ///< Written IPFIX Messages
+};
+
+/**
+ * @brief Converter of payloads into IPFIX files.
+ *
+ * Payloads must be processed in the order of their packets in the capture.
+ */
+class Converter {
+public:
+    explicit Converter(const Config &cfg) :
+        m_cfg(cfg)
+    {
+        if (!cfg.split) {
+            m_output.reset(new Output(cfg.output));
+        }
+    }
+
+    void
+    process(const Chunk &chunk)
+    {
+        for (size_t i = 0; i < DECODE_RESULTS; ++i) {
+            m_results[i] += chunk.results[i];
+        }
+        for (const Payload &payload : chunk.payloads) {
+            process(payload);
+        }
+    }
+
+    void
+    finish();
+
+private:
+    const Config &m_cfg;
+    std::unique_ptr<Output> m_output;
+    std::unordered_map<SessionKey, Session, SessionKeyHash> m_sessions;
+
+    uint64_t m_results[DECODE_RESULTS] = {};
+    uint64_t m_udp_messages = 0;
+    uint64_t m_udp_netflow = 0;
+    uint64_t m_udp_invalid = 0;
+
+    Session &
+    session_get(const SessionKey &key);
+    void
+    process(const Payload &payload);
+};
+
+Session &
+Converter::session_get(const SessionKey &key)
+{
+    auto it = m_sessions.find(key);
+    if (it != m_sessions.end()) {
+        return it->second;
+    }
+
+    Session &session = m_sessions[key];
+    session.id = m_sessions.size() - 1;
+    if (m_cfg.split) {
+        session.own.reset(new Output(m_cfg.output + "." + std::to_string(session.id)));
+        session.output = session.own.get();
+    } else {
+        session.output = m_output.get();
+    }
+    if (key.protocol == IPPROTO_TCP) {
+        session.stream.reset(new TcpStream());
+    }
+
+    return session;
+}
+
+void
+Converter::process(const Payload &payload)
+{
+    if (payload.key.protocol == IPPROTO_UDP) {
+        if (payload.size < 2) {
+            m_udp_invalid++;
+            return;
+        }
+
+        const size_t msg_len = ipfix_msg_check(payload.data, payload.size);
+        if (msg_len == 0) {
+            const uint16_t version = (payload.data[0] << 8) | payload.data[1];
+            if (version == 5 || version == 9) {
+                m_udp_netflow++;
+            } else {
+                m_udp_invalid++;
+            }
+            return;
+        }
+
+        Session &session = session_get(payload.key);
+        session.output->write(payload.data, msg_len);
+        session.messages++;
+        m_udp_messages++;
+        return;
+    }
+
+    Session &session = session_get(payload.key);
+    session.stream->add(payload.tcp_seq, payload.tcp_flags, payload.data, payload.size,
+        [&session](const uint8_t *data, size_t size) {
+            session.output->write(data, size);
+            session.messages++;
+        });
+}
+
+void
+Converter::finish()
+{
+    uint64_t tcp_messages = 0;
+    uint64_t tcp_gaps = 0;
+    uint64_t tcp_skipped = 0;
+    uint64_t bytes = m_output ? m_output->bytes() : 0;
+    size_t active = 0;
+
+    for (auto &it : m_sessions) {
+        Session &session = it.second;
+        if (session.stream) {
+            session.stream->finish([&session](const uint8_t *data, size_t size) {
+                session.output->write(data, size);
+                session.messages++;
+            });
+
+            const TcpStream::Stats &stats = session.stream->stats();
+            tcp_messages += stats.messages;
+            tcp_gaps += stats.gaps;
+            tcp_skipped += stats.skipped + session.stream->pending();
+        }
+        if (session.own) {
+            bytes += session.own->bytes();
+            session.own->close();
+        }
+        if (session.messages > 0) {
+            active++;
+        }
+    }
+
+    if (m_output) {
+        m_output->close();
+    }
+
+    const auto count = [](uint64_t value) { return static_cast<unsigned long long>(value); };
+    fprintf(stderr, "Packets:            %llu\n", count(
+        m_results[0] + m_results[1] + m_results[2] + m_results[3] + m_results[4]));
+    fprintf(stderr, "  not IP:           %llu\n",
+        count(m_results[static_cast<size_t>(DecodeResult::not_ip)]));
+    fprintf(stderr, "  IP fragments:     %llu (skipped)\n",
+        count(m_results[static_cast<size_t>(DecodeResult::fragment)]));
+    fprintf(stderr, "  not TCP/UDP:      %llu\n",
+        count(m_results[static_cast<size_t>(DecodeResult::not_transport)]));
+    fprintf(stderr, "  truncated:        %llu\n",
+        count(m_results[static_cast<size_t>(DecodeResult::truncated)]));
+    fprintf(stderr, "IPFIX over UDP:     %llu messages\n", count(m_udp_messages));
+    fprintf(stderr, "  NetFlow v5/v9:    %llu (skipped)\n", count(m_udp_netflow));
+    fprintf(stderr, "  not IPFIX:        %llu\n", count(m_udp_invalid));
+    fprintf(stderr, "IPFIX over TCP:     %llu messages\n", count(tcp_messages));
+    fprintf(stderr, "  gaps:             %llu\n", count(tcp_gaps));
+    fprintf(stderr, "  skipped bytes:    %llu\n", count(tcp_skipped));
+    fprintf(stderr, "Sessions:           %zu with IPFIX data\n", active);
+    fprintf(stderr, "Written:            %llu bytes\n", count(bytes));
+
+    if (!m_cfg.split && active > 1) {
+        fprintf(stderr, "WARNING: Messages of multiple transport sessions were merged into one "
+            "file, templates of exporters with the same ODID can collide (see -s)\n");
+    }
+}
+
+/**
+ * @brief Decode a chunk of packets.
+ */
+static Chunk
+decode_chunk(const std::vector<Packet> &packets, uint16_t port)
+{
+    Chunk chunk;
+    chunk.payloads.reserve(packets.size());
+
+    for (const Packet &pkt : packets) {
+        Payload payload;
+        const DecodeResult ret = decode_packet(pkt, payload);
+        chunk.results[static_cast<size_t>(ret)]++;
+        if (ret != DecodeResult::ok) {
+            continue;
+        }
+        if (port != 0 && payload.key.src_port != port && payload.key.dst_port != port) {
+            continue;
+        }
+        chunk.payloads.push_back(payload);
+    }
+
+    return chunk;
+}
+
+/**
+ * @brief Convert the capture.
+ *
+ * Boundaries of packets are found sequentially, chunks of packets are decoded
+ * in parallel and their payloads are processed in the original order.
+ */
+static void
+convert(const Config &cfg)
+{
+    CaptureFile file(cfg.input);
+    Converter converter(cfg);
+
+    const std::launch policy = (cfg.threads > 1) ? std::launch::async : std::launch::deferred;
+    const size_t queue_max = (cfg.threads > 1) ? 2 * cfg.threads : 1;
+    std::deque<std::future<Chunk>> queue;
+
+    // Packet lists of pending jobs must stay alive until the jobs are finished
+    std::deque<std::unique_ptr<std::vector<Packet>>> lists;
+    std::unique_ptr<std::vector<Packet>> list(new std::vector<Packet>());
+    list->reserve(CHUNK_PACKETS);
+
+    const auto submit = [&]() {
+        const std::vector<Packet> *ptr = list.get();
+        queue.push_back(std::async(policy, decode_chunk, std::cref(*ptr), cfg.port));
+        lists.push_back(std::move(list));
+        list.reset(new std::vector<Packet>());
+        list->reserve(CHUNK_PACKETS);
+    };
+    const auto consume = [&]() {
+        converter.process(queue.front().get());
+        queue.pop_front();
+        lists.pop_front();
+    };
+
+    Packet pkt;
+    while (file.next(pkt)) {
+        list->push_back(pkt);
+        if (list->size() < CHUNK_PACKETS) {
+            continue;
+        }
+
+        submit();
+        if (queue.size() >= queue_max) {
+            consume();
+        }
+    }
+
+    if (!list->empty()) {
+        submit();
+    }
+    while (!queue.empty()) {
+        consume();
+    }
+
+    converter.finish();
+}
+
+static void
+usage()
+{
+    printf("Convert IPFIX Messages captured in a PCAP/PCAPng file into an IPFIX file\n");
+    printf("Usage: pcap2ipfix [options] -i FILE -o FILE\n");
+    printf("  -h         Show this help\n");
+    printf("  -i FILE    Input PCAP/PCAPng file\n");
+    printf("  -o FILE    Output IPFIX file\n");
+    printf("  -p PORT    Only sessions with this source or destination port\n");
+    printf("  -s         Write each transport session to a separate file FILE.<N>\n");
+    printf("  -t NUM     Number of decoding threads (default: number of CPUs)\n");
+}
+
+int
+main(int argc, char *argv[])
+{
+    Config cfg;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "hi:o:p:st:")) != -1) {
+        switch (opt) {
+        case 'h':
+            usage();
+            return EXIT_SUCCESS;
+        case 'i':
+            cfg.input = optarg;
+            break;
+        case 'o':
+            cfg.output = optarg;
+            break;
+        case 'p': {
+            const long port = atol(optarg);
+            if (port <= 0 || port > UINT16_MAX) {
+                std::cerr << "ERROR: Invalid port number '" << optarg << "'" << std::endl;
+                return EXIT_FAILURE;
+            }
+            cfg.port = static_cast<uint16_t>(port);
+            break;
+        }
+        case 's':
+            cfg.split = true;
+            break;
+        case 't': {
+            const long threads = atol(optarg);
+            if (threads <= 0 || threads > 1024) {
+                std::cerr << "ERROR: Invalid number of threads '" << optarg << "'" << std::endl;
+                return EXIT_FAILURE;
+            }
+            cfg.threads = static_cast<unsigned>(threads);
+            break;
+        }
+        default:
+            usage();
+            return EXIT_FAILURE;
+        }
+    }
+
+    if (cfg.input.empty() || cfg.output.empty()) {
+        std::cerr << "ERROR: Input and output files must be specified (see -h)" << std::endl;
+        return EXIT_FAILURE;
+    }
+    if (cfg.threads == 0) {
+        cfg.threads = std::max(1U, std::thread::hardware_concurrency());
+    }
+
+    try {
+        convert(cfg);
+    } catch (const std::exception &ex) {
+        std::cerr << "ERROR: " << ex.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,224 @@
+
+#include <algorithm>
+
+#include <netinet/in.h>
+
+#include "packetDecoder.hpp"
+
+namespace pcap2ipfix {
+
+static constexpr uint16_t LINKTYPE_NULL = 0;
+static constexpr uint16_t LINKTYPE_ETHERNET = 1;
+static constexpr uint16_t LINKTYPE_RAW_OLD = 12;
+static constexpr uint16_t LINKTYPE_RAW_OPENBSD = 14;
+static constexpr uint16_t LINKTYPE_RAW = 101;
+static constexpr uint16_t LINKTYPE_LOOP = 108;
+static constexpr uint16_t LINKTYPE_LINUX_SLL = 113;
+static constexpr uint16_t LINKTYPE_IPV4 = 228;
+static constexpr uint16_t LINKTYPE_IPV6 = 229;
+static constexpr uint16_t LINKTYPE_LINUX_SLL2 = 276;
+
+static constexpr uint16_t ETHERTYPE_IPV4 = 0x0800;
+static constexpr uint16_t ETHERTYPE_IPV6 = 0x86DD;
+static constexpr uint16_t ETHERTYPE_VLAN = 0x8100;
+static constexpr uint16_t ETHERTYPE_QINQ = 0x88A8;
+static constexpr uint16_t ETHERTYPE_QINQ_OLD = 0x9100;
+
+static inline uint16_t
+read16(const uint8_t *data)
+{
+    return static_cast<uint16_t>((data[0] << 8) | data[1]);
+}
+
+static inline uint32_t
+read32(const uint8_t *data)
+{
+    return (static_cast<uint32_t>(read16(data)) << 16) | read16(data + 2);
+}
+
+size_t
+SessionKeyHash::operator()(const SessionKey &key) const
+{
+    // FNV-1a, sessions are looked up only once per packet
+    const uint8_t *data = reinterpret_cast<const uint8_t *>(&key);
+    uint64_t hash = 14695981039346656037ULL;
+
+    for (size_t i = 0; i < sizeof(key); ++i) {
+        hash = (hash ^ data[i]) * 1099511628211ULL;
+    }
+
+    return static_cast<size_t>(hash);
+}
+
+/**
+ * @brief Get the EtherType of the network layer and skip the link layer header.
+ * @return EtherType or 0 if unknown.
+ */
+static uint16_t
+skip_link(const Packet &pkt, size_t &offset)
+{
+    const uint8_t *data = pkt.data;
+    const uint32_t len = pkt.caplen;
+    uint16_t type;
+
+    switch (pkt.linktype) {
+    case LINKTYPE_ETHERNET:
+        if (len < 14) {
+            return 0;
+        }
+        type = read16(data + 12);
+        offset = 14;
+        while (type == ETHERTYPE_VLAN || type == ETHERTYPE_QINQ || type == ETHERTYPE_QINQ_OLD) {
+            if (len < offset + 4) {
+                return 0;
+            }
+            type = read16(data + offset + 2);
+            offset += 4;
+        }
+        return type;
+    case LINKTYPE_LINUX_SLL:
+        if (len < 16) {
+            return 0;
+        }
+        offset = 16;
+        return read16(data + 14);
+    case LINKTYPE_LINUX_SLL2:
+        if (len < 20) {
+            return 0;
+        }
+        offset = 20;
+        return read16(data);
+    case LINKTYPE_NULL:
+    case LINKTYPE_LOOP:
+        // Address family in an unknown byte order, determine the version from the header
+        offset = 4;
+        break;
+    case LINKTYPE_RAW:
+    case LINKTYPE_RAW_OLD:
+    case LINKTYPE_RAW_OPENBSD:
+    case LINKTYPE_IPV4:
+    case LINKTYPE_IPV6:
+        offset = 0;
+        break;
+    default:
+        return 0;
+    }
+
+    if (len <= offset) {
+        return 0;
+    }
+
+    switch (data[offset] >> 4) {
+    case 4:  return ETHERTYPE_IPV4;
+    case 6:  return ETHERTYPE_IPV6;
+    default: return 0;
+    }
+}
+
+DecodeResult
+decode_packet(const Packet &pkt, Payload &payload)
+{
+    size_t offset = 0;
+    const uint16_t type = skip_link(pkt, offset);
+    const uint8_t *data = pkt.data + offset;
+    // End of the IP packet (without link layer padding)
+    size_t end;
+    uint8_t proto;
+
+    std::memset(&payload.key, 0, sizeof(payload.key));
+
+    if (type == ETHERTYPE_IPV4) {
+        if (pkt.caplen < offset + 20 || (data[0] >> 4) != 4) {
+            return (pkt.caplen < offset + 20) ? DecodeResult::truncated : DecodeResult::not_ip;
+        }
+
+        const size_t hdr_len = (data[0] & 0x0F) * 4U;
+        const size_t total_len = read16(data + 2);
+        const uint16_t frag = read16(data + 6);
+        if (hdr_len < 20 || total_len < hdr_len) {
+            return DecodeResult::not_ip;
+        }
+        if ((frag & 0x3FFF) != 0) {
+            // More fragments flag or non-zero fragment offset
+            return DecodeResult::fragment;
+        }
+
+        payload.key.ip_version = 4;
+        std::memcpy(payload.key.src_addr, data + 12, 4);
+        std::memcpy(payload.key.dst_addr, data + 16, 4);
+        proto = data[9];
+        end = offset + total_len;
+        offset += hdr_len;
+    } else if (type == ETHERTYPE_IPV6) {
+        if (pkt.caplen < offset + 40 || (data[0] >> 4) != 6) {
+            return (pkt.caplen < offset + 40) ? DecodeResult::truncated : DecodeResult::not_ip;
+        }
+
+        payload.key.ip_version = 6;
+        std::memcpy(payload.key.src_addr, data + 8, 16);
+        std::memcpy(payload.key.dst_addr, data + 24, 16);
+        proto = data[6];
+        end = offset + 40 + read16(data + 4);
+        offset += 40;
+
+        // Skip extension headers
+        bool ext = true;
+        while (ext) {
+            switch (proto) {
+            case IPPROTO_HOPOPTS:
+            case IPPROTO_ROUTING:
+            case IPPROTO_DSTOPTS:
+                if (pkt.caplen < offset + 8) {
+                    return DecodeResult::truncated;
+                }
+                proto = pkt.data[offset];
+                offset += (pkt.data[offset + 1] + 1U) * 8U;
+                break;
+            case IPPROTO_FRAGMENT:
+                return DecodeResult::fragment;
+            default:
+                ext = false;
+                break;
+            }
+        }
+    } else {
+        return DecodeResult::not_ip;
+    }
+
+    // Ignore link layer padding, but respect truncated captures
+    end = std::min<size_t>(end, pkt.caplen);
+    data = pkt.data + offset;
+
+    if (proto == IPPROTO_UDP) {
+        if (end < offset + 8) {
+            return DecodeResult::truncated;
+        }
+        payload.key.src_port = read16(data);
+        payload.key.dst_port = read16(data + 2);
+        payload.tcp_seq = 0;
+        payload.tcp_flags = 0;
+        offset += 8;
+    } else if (proto == IPPROTO_TCP) {
+        if (end < offset + 20) {
+            return DecodeResult::truncated;
+        }
+        const size_t hdr_len = (data[12] >> 4) * 4U;
+        if (hdr_len < 20 || end < offset + hdr_len) {
+            return DecodeResult::truncated;
+        }
+        payload.key.src_port = read16(data);
+        payload.key.dst_port = read16(data + 2);
+        payload.tcp_seq = read32(data + 4);
+        payload.tcp_flags = data[13];
+        offset += hdr_len;
+    } else {
+        return DecodeResult::not_transport;
+    }
+
+    payload.key.protocol = proto;
+    payload.data = pkt.data + offset;
+    payload.size = static_cast<uint32_t>(end - offset);
+    return DecodeResult::ok;
+}
+
+} // pcap2ipfix
@@ -0,0 +1,81 @@
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+
+#include "captureFile.hpp"
+
+namespace pcap2ipfix {
+
+/**
+ * @brief Identification of a transport session (one direction of a connection).
+ */
+struct SessionKey {
+    uint8_t src_addr[16];   ///< Source IP address (IPv4 addresses are zero padded)
+    uint8_t dst_addr[16];   ///< Destination IP address
+    uint16_t src_port;      ///< Source port (host byte order)
+    uint16_t dst_port;      ///< Destination port (host byte order)
+    uint8_t ip_version;     ///< 4 or 6
+    uint8_t protocol;       ///< IPPROTO_UDP or IPPROTO_TCP
+    uint8_t padding[2];     ///< Always zero (the key is compared bytewise)
+
+    bool
+    operator==(const SessionKey &other) const
+    {
+        return std::memcmp(this, &other, sizeof(*this)) == 0;
+    }
+};
+
+/** @brief Hash of a session key */
+struct SessionKeyHash {
+    size_t
+    operator()(const SessionKey &key) const;
+};
+
+/**
+ * @brief Transport payload of a packet.
+ */
+struct Payload {
+    SessionKey key;         ///< Transport session
+    uint32_t tcp_seq;       ///< Sequence number (TCP only)
+    uint8_t tcp_flags;      ///< Flags (TCP only)
+    const uint8_t *data;    ///< Payload
+    uint32_t size;          ///< Size of the payload
+};
+
+/**
+ * @brief Result of decoding of a packet.
+ */
+enum class DecodeResult {
+    ok,             ///< Payload of a TCP or UDP segment
+    not_ip,         ///< Not an IPv4/IPv6 packet (or unsupported link type)
+    fragment,       ///< IP fragment (not reassembled)
+    not_transport,  ///< Neither TCP nor UDP
+    truncated,      ///< Headers exceed the captured data
+};
+
+/** @brief Number of decoding results */
+static constexpr size_t DECODE_RESULTS = 5;
+
+/** @brief TCP flags */
+static constexpr uint8_t TCP_FIN = 0x01;
+static constexpr uint8_t TCP_SYN = 0x02;
+static constexpr uint8_t TCP_RST = 0x04;
+
+/**
+ * @brief Decode link, network and transport headers of a packet.
+ *
+ * Ethernet (including VLAN tags), Linux cooked capture (v1 and v2), BSD
+ * loopback and raw IP link types are supported. The function is stateless,
+ * so it can be called from multiple threads.
+ * @param[in]  pkt      Packet
+ * @param[out] payload  Transport payload (valid only if DecodeResult::ok)
+ * @return Result of decoding.
+ */
+DecodeResult
+decode_packet(const Packet &pkt, Payload &payload);
+
+} // pcap2ipfix
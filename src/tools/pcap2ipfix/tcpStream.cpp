@@ -0,0 +1,188 @@
+
+#include <cassert>
+
+#include "packetDecoder.hpp"
+#include "tcpStream.hpp"
+
+namespace pcap2ipfix {
+
+static inline uint16_t
+read16(const uint8_t *data)
+{
+    return static_cast<uint16_t>((data[0] << 8) | data[1]);
+}
+
+size_t
+ipfix_msg_check(const uint8_t *data, size_t size)
+{
+    if (size < IPFIX_HDR_LEN || read16(data) != 10) {
+        return 0;
+    }
+
+    const size_t msg_len = read16(data + 2);
+    if (msg_len < IPFIX_HDR_LEN || msg_len > size) {
+        return 0;
+    }
+
+    size_t pos = IPFIX_HDR_LEN;
+    while (pos < msg_len) {
+        if (msg_len - pos < IPFIX_SET_HDR_LEN) {
+            return 0;
+        }
+
+        // Set ID 2 (Template), 3 (Options Template) or >= 256 (Data)
+        const uint16_t set_id = read16(data + pos);
+        const size_t set_len = read16(data + pos + 2);
+        if ((set_id != 2 && set_id != 3 && set_id < 256)
+                || set_len < IPFIX_SET_HDR_LEN || set_len > msg_len - pos) {
+            return 0;
+        }
+        pos += set_len;
+    }
+
+    return msg_len;
+}
+
+void
+TcpStream::add(uint32_t seq, uint8_t flags, const uint8_t *data, size_t size, const MsgCallback &cb)
+{
+    if (!m_init && (flags & TCP_SYN)) {
+        // Data start right after SYN
+        m_next = static_cast<uint64_t>(seq) + 1;
+        m_init = true;
+    } else if (!m_init && size > 0) {
+        // Capture started in the middle of the connection
+        m_next = seq;
+        m_init = true;
+    }
+
+    if (size == 0) {
+        return;
+    }
+    if (flags & TCP_SYN) {
+        // SYN occupies one sequence number in front of the data
+        seq++;
+    }
+
+    // Extend the sequence number to a stream offset nearest to the expected one
+    const int32_t diff = static_cast<int32_t>(seq - static_cast<uint32_t>(m_next));
+    if (diff < 0 && static_cast<uint64_t>(-static_cast<int64_t>(diff)) > m_next) {
+        // Data before the start of the stream
+        return;
+    }
+    const uint64_t offset = m_next + diff;
+
+    if (offset > m_next) {
+        // Out-of-order segment, keep the longest data at the same offset
+        std::vector<uint8_t> &segment = m_ooo[offset];
+        if (segment.size() < size) {
+            m_ooo_size += size - segment.size();
+            segment.assign(data, data + size);
+        }
+        if (m_ooo_size > m_ooo_limit) {
+            skip_gap();
+        }
+    } else {
+        append(offset, data, size);
+        drain();
+    }
+
+    extract(cb);
+}
+
+void
+TcpStream::finish(const MsgCallback &cb)
+{
+    while (!m_ooo.empty()) {
+        skip_gap();
+        extract(cb);
+    }
+}
+
+/**
+ * @brief Append data starting at the given stream offset (at most the expected one).
+ *
+ * Already received (i.e. retransmitted) data are ignored.
+ */
+void
+TcpStream::append(uint64_t offset, const uint8_t *data, size_t size)
+{
+    assert(offset <= m_next);
+    const uint64_t dup = m_next - offset;
+    if (dup >= size) {
+        return;
+    }
+
+    m_buffer.insert(m_buffer.end(), data + dup, data + size);
+    m_next += size - dup;
+}
+
+/**
+ * @brief Append out-of-order segments that follow the expected offset.
+ */
+void
+TcpStream::drain()
+{
+    while (!m_ooo.empty() && m_ooo.begin()->first <= m_next) {
+        auto it = m_ooo.begin();
+        append(it->first, it->second.data(), it->second.size());
+        m_ooo_size -= it->second.size();
+        m_ooo.erase(it);
+    }
+}
+
+/**
+ * @brief Give up waiting for missing data and continue with the first
+ *   out-of-order segment.
+ */
+void
+TcpStream::skip_gap()
+{
+    assert(!m_ooo.empty());
+    m_stats.gaps++;
+    m_stats.skipped += m_buffer.size();
+    m_buffer.clear();
+    m_next = m_ooo.begin()->first;
+    drain();
+}
+
+/**
+ * @brief Pass complete IPFIX Messages in the buffer to the callback.
+ *
+ * Bytes that don't start a well-formed IPFIX Message (e.g. after a gap or if
+ * the capture started in the middle of a connection) are skipped.
+ */
+void
+TcpStream::extract(const MsgCallback &cb)
+{
+    const uint8_t *data = m_buffer.data();
+    const size_t size = m_buffer.size();
+    size_t pos = 0;
+
+    while (size - pos >= IPFIX_HDR_LEN) {
+        const size_t msg_len = read16(data + pos + 2);
+        if (read16(data + pos) != 10 || msg_len < IPFIX_HDR_LEN) {
+            // Not an IPFIX Message header
+            m_stats.skipped++;
+            pos++;
+            continue;
+        }
+        if (msg_len > size - pos) {
+            // Incomplete message
+            break;
+        }
+        if (ipfix_msg_check(data + pos, msg_len) == 0) {
+            m_stats.skipped++;
+            pos++;
+            continue;
+        }
+
+        cb(data + pos, msg_len);
+        m_stats.messages++;
+        pos += msg_len;
+    }
+
+    m_buffer.erase(m_buffer.begin(), m_buffer.begin() + pos);
+}
+
+} // pcap2ipfix
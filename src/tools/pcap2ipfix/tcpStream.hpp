@@ -0,0 +1,107 @@
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <vector>
+
+namespace pcap2ipfix {
+
+/** @brief Size of the IPFIX Message header */
+static constexpr size_t IPFIX_HDR_LEN = 16;
+/** @brief Size of an IPFIX Set header */
+static constexpr size_t IPFIX_SET_HDR_LEN = 4;
+
+/**
+ * @brief Check that data start with a well-formed IPFIX Message.
+ *
+ * The version and the length of the Message must be valid and the Sets must
+ * exactly cover the rest of the Message.
+ * @param[in] data  Data
+ * @param[in] size  Size of the data
+ * @return Size of the Message or 0 if the data don't start with a complete
+ *   and well-formed IPFIX Message.
+ */
+size_t
+ipfix_msg_check(const uint8_t *data, size_t size);
+
+/** @brief Callback for IPFIX Messages extracted from a stream */
+using MsgCallback = std::function<void(const uint8_t *data, size_t size)>;
+
+/**
+ * @brief Reassembler of IPFIX Messages sent over one direction of a TCP
+ *   connection.
+ *
+ * Segments are placed by their sequence numbers extended to 64-bit stream
+ * offsets, so wrapping of sequence numbers doesn't matter. Retransmitted
+ * data are ignored and out-of-order segments are kept until the missing data
+ * arrive. If the amount of kept data exceeds a limit (i.e. the data were
+ * never captured), the gap is skipped and the stream is resynchronized on the
+ * next well-formed IPFIX Message header.
+ */
+class TcpStream {
+public:
+    /** @brief Statistics of the stream */
+    struct Stats {
+        uint64_t messages = 0;      ///< Extracted IPFIX Messages
+        uint64_t gaps = 0;          ///< Skipped gaps of missing data
+        uint64_t skipped = 0;       ///< Bytes skipped during resynchronization
+    };
+
+    /**
+     * @brief Create a stream.
+     * @param[in] ooo_limit  Maximum amount of out-of-order data [bytes]
+     */
+    explicit TcpStream(size_t ooo_limit = 8U << 20) : m_ooo_limit(ooo_limit) {}
+
+    /**
+     * @brief Add a segment to the stream.
+     * @param[in] seq    Sequence number
+     * @param[in] flags  TCP flags
+     * @param[in] data   Payload
+     * @param[in] size   Size of the payload
+     * @param[in] cb     Callback for complete IPFIX Messages
+     */
+    void
+    add(uint32_t seq, uint8_t flags, const uint8_t *data, size_t size, const MsgCallback &cb);
+
+    /**
+     * @brief Process all remaining out-of-order data (skip gaps).
+     * @param[in] cb  Callback for complete IPFIX Messages
+     */
+    void
+    finish(const MsgCallback &cb);
+
+    /** @brief Get statistics of the stream */
+    const Stats &
+    stats() const { return m_stats; }
+
+    /** @brief Get the size of unprocessed data (incomplete message and out-of-order data) */
+    size_t
+    pending() const { return m_buffer.size() + m_ooo_size; }
+
+private:
+    size_t m_ooo_limit;
+    bool m_init = false;
+    /// Stream offset of the next expected byte
+    uint64_t m_next = 0;
+    /// Data of incomplete IPFIX Message(s)
+    std::vector<uint8_t> m_buffer;
+    /// Out-of-order segments (stream offset → data)
+    std::map<uint64_t, std::vector<uint8_t>> m_ooo;
+    size_t m_ooo_size = 0;
+    Stats m_stats;
+
+    void
+    append(uint64_t offset, const uint8_t *data, size_t size);
+    void
+    drain();
+    void
+    skip_gap();
+    void
+    extract(const MsgCallback &cb);
+};
+
+} // pcap2ipfix
@@ -0,0 +1,1037 @@
+/**
+ * \file tests/bench/bench.cpp
+ * \brief Microbenchmarks of the collector pipeline
+ *
+ * Synthetic IPFIX and NetFlow Messages (see MsgGen tools of unit tests) are passed through
+ * ring buffers, the IPFIX parser, NetFlow to IPFIX converters and selected output plugins
+ * in-process. Text formatters of JSON output plugins and the hash table of fdsdump aggregator
+ * are measured separately. For each component, throughput and processing time per record are
+ * reported.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <arpa/inet.h>
+#include <getopt.h>
+#include <ipfixcol2.h>
+#include <libfds.h>
+
+#include "../unit/core/parser/tools/MsgGen.h"
+#include "../unit/core/netflow/tools/MsgGen.h"
+
+#include <core/configurator/configurator.hpp>
+#include <core/configurator/instance_output.hpp>
+#include <plugins/output/json/src/Format.hpp>
+#include <tools/fdsdump/src/aggregator/hashTable.hpp>
+
+extern "C" {
+#include <build_config.h>
+#include <core/context.h>
+#include <core/message_base.h>
+#include <core/message_terminate.h>
+#include <core/parser.h>
+#include <core/ring.h>
+#include <core/verbose.h>
+#include <core/netflow2ipfix/netflow2ipfix.h>
+#include <core/netflow2ipfix/netflow_structs.h>
+}
+
+using bench_clock = std::chrono::steady_clock;
+
+/** Observation Domain ID of generated messages                                                 */
+static const uint32_t BENCH_ODID = 1;
+/** Template ID of generated messages                                                           */
+static const uint16_t BENCH_TID = 256;
+/** Number of messages prepared before each measured round                                      */
+static const size_t BENCH_ROUND = 256;
+/** Maximum number of parsed messages repeatedly passed to an output instance                   */
+static const size_t BENCH_OUTPUT_POOL = 1024;
+/** Number of messages pushed into a ring buffer at once (see the context of an instance)        */
+static const uint32_t BENCH_RING_BULK = 32;
+/** Number of prepared values of formatter benchmarks (must be a power of two)                  */
+static const size_t BENCH_FMT_VALUES = 4096;
+/** Size of the output buffer of formatter benchmarks                                           */
+static const size_t BENCH_FMT_BSIZE = 64;
+/** Number of distinct keys of the hash table benchmark (must be a power of two)                */
+static const size_t BENCH_HASH_KEYS = 1U << 20;
+/** Size of a key of the hash table benchmark (e.g. two IPv6 addresses and two ports)           */
+static const size_t BENCH_HASH_KEY_SIZE = 36;
+/** Verbosity of benchmarked components                                                         */
+static const enum ipx_verb_level BENCH_VERB = IPX_VERB_ERROR;
+
+/** Result of a benchmark                                                                       */
+struct bench_result {
+    /** Name of the component                                                                   */
+    std::string name;
+    /** Number of processed messages                                                            */
+    uint64_t msgs = 0;
+    /** Number of processed records (0 if not applicable)                                       */
+    uint64_t recs = 0;
+    /** Time spent by processing (in seconds)                                                   */
+    double secs = 0.0;
+};
+
+/** Configuration of benchmarks                                                                 */
+struct bench_cfg {
+    /** Number of messages processed by each component                                          */
+    uint64_t msg_cnt = 100000;
+    /** Number of Data Records in each message                                                  */
+    uint16_t rec_cnt = 30;
+    /** Selected components                                                                     */
+    std::vector<std::string> components;
+    /** Output plugins and their parameters                                                     */
+    std::vector<std::pair<std::string, std::string>> outputs;
+    /** Plugin search paths                                                                     */
+    std::vector<std::string> plugin_paths;
+    /** Directory with definitions of Information Elements                                      */
+    std::string ie_dir;
+    /** Print results as JSON objects (one per line)                                            */
+    bool json = false;
+};
+
+/** Shared environment of benchmarks                                                            */
+struct bench_env {
+    /** Fake plugin context of an input instance (i.e. creator of IPFIX Messages)               */
+    ipx_ctx_t *ctx = nullptr;
+    /** Transport Session of all messages                                                       */
+    struct ipx_session *session = nullptr;
+    /** Manager of Information Elements                                                         */
+    fds_iemgr_t *iemgr = nullptr;
+
+    bench_env(const std::string &ie_dir)
+    {
+        ctx = ipx_ctx_create("Benchmark", nullptr);
+        iemgr = fds_iemgr_create();
+        if (!ctx || !iemgr) {
+            throw std::runtime_error("Failed to create the benchmark environment!");
+        }
+
+        if (fds_iemgr_read_dir(iemgr, ie_dir.c_str()) != FDS_OK) {
+            throw std::runtime_error("Failed to load Information Elements: "
+                + std::string(fds_iemgr_last_err(iemgr)));
+        }
+
+        struct ipx_session_net net_cfg;
+        memset(&net_cfg, 0, sizeof(net_cfg));
+        net_cfg.l3_proto = AF_INET;
+        net_cfg.port_src = 60000;
+        net_cfg.port_dst = 4739;
+        inet_pton(AF_INET, "192.168.0.2", &net_cfg.addr_src.ipv4);
+        inet_pton(AF_INET, "192.168.0.1", &net_cfg.addr_dst.ipv4);
+        session = ipx_session_new_udp(&net_cfg, 0, 0);
+        if (!session) {
+            throw std::runtime_error("Failed to create a Transport Session!");
+        }
+    }
+
+    ~bench_env()
+    {
+        ipx_session_destroy(session);
+        fds_iemgr_destroy(iemgr);
+        ipx_ctx_destroy(ctx);
+    }
+
+    /**
+     * \brief Create an IPFIX Message wrapper of a copy of a raw message
+     * \param[in] raw Raw message
+     */
+    ipx_msg_ipfix_t *
+    wrap(const std::vector<uint8_t> &raw)
+    {
+        uint8_t *data = static_cast<uint8_t *>(malloc(raw.size()));
+        if (!data) {
+            throw std::bad_alloc();
+        }
+        memcpy(data, raw.data(), raw.size());
+
+        struct ipx_msg_ctx msg_ctx;
+        memset(&msg_ctx, 0, sizeof(msg_ctx));
+        msg_ctx.session = session;
+        msg_ctx.odid = BENCH_ODID;
+        ipx_msg_ipfix_t *msg = ipx_msg_ipfix_create(ctx, &msg_ctx, data,
+            static_cast<uint16_t>(raw.size()));
+        if (!msg) {
+            free(data);
+            throw std::bad_alloc();
+        }
+        return msg;
+    }
+};
+
+/** Get time elapsed since a timestamp (in seconds)                                             */
+static double
+elapsed(bench_clock::time_point start)
+{
+    return std::chrono::duration<double>(bench_clock::now() - start).count();
+}
+
+/** Copy a released message of a generator and free the original                               */
+static std::vector<uint8_t>
+raw_copy(void *data, size_t size)
+{
+    std::vector<uint8_t> raw(static_cast<uint8_t *>(data), static_cast<uint8_t *>(data) + size);
+    free(data);
+    return raw;
+}
+
+/**
+ * \brief Generate an IPFIX Message with flow records
+ * \param[in] recs       Number of Data Records
+ * \param[in] with_tmplt Add a Template Set with the Template of the records
+ */
+static std::vector<uint8_t>
+gen_ipfix(uint16_t recs, bool with_tmplt)
+{
+    ipfix_msg msg;
+    msg.set_odid(BENCH_ODID);
+    msg.set_exp(1562857357U);
+
+    if (with_tmplt) {
+        ipfix_trec trec(BENCH_TID);
+        trec.add_field(8, 4);   // sourceIPv4Address
+        trec.add_field(12, 4);  // destinationIPv4Address
+        trec.add_field(7, 2);   // sourceTransportPort
+        trec.add_field(11, 2);  // destinationTransportPort
+        trec.add_field(4, 1);   // protocolIdentifier
+        trec.add_field(6, 1);   // tcpControlBits
+        trec.add_field(1, 8);   // octetDeltaCount
+        trec.add_field(2, 8);   // packetDeltaCount
+        trec.add_field(152, 8); // flowStartMilliseconds
+        trec.add_field(153, 8); // flowEndMilliseconds
+
+        ipfix_set tset(FDS_IPFIX_SET_TMPLT);
+        tset.add_rec(trec);
+        msg.add_set(tset);
+    }
+
+    ipfix_set dset(BENCH_TID);
+    for (uint16_t i = 0; i < recs; ++i) {
+        ipfix_drec drec;
+        drec.append_ip("10.0.0." + std::to_string(i % 250));
+        drec.append_ip("192.168.1." + std::to_string((i * 7) % 250));
+        drec.append_uint(1024U + i, 2);
+        drec.append_uint(443, 2);
+        drec.append_uint(6, 1);
+        drec.append_uint(0x12, 1);
+        drec.append_uint(1500U * (i + 1U), 8);
+        drec.append_uint(i + 1U, 8);
+        drec.append_uint(1562857357000ULL + i, 8);
+        drec.append_uint(1562857358000ULL + i, 8);
+        dset.add_rec(drec);
+    }
+    msg.add_set(dset);
+
+    const size_t size = msg.size();
+    return raw_copy(msg.release(), size);
+}
+
+/**
+ * \brief Generate a NetFlow v5 Message with flow records
+ * \param[in] recs Number of records (at most 30)
+ */
+static std::vector<uint8_t>
+gen_nf5(uint16_t recs)
+{
+    std::vector<uint8_t> raw(sizeof(struct ipx_nf5_hdr) + recs * sizeof(struct ipx_nf5_rec), 0);
+    auto hdr = reinterpret_cast<struct ipx_nf5_hdr *>(raw.data());
+    hdr->version = htons(IPX_NF5_VERSION);
+    hdr->count = htons(recs);
+    hdr->sys_uptime = htonl(10001U);
+    hdr->unix_sec = htonl(1562857357U);
+
+    auto rec = reinterpret_cast<struct ipx_nf5_rec *>(raw.data() + sizeof(*hdr));
+    for (uint16_t i = 0; i < recs; ++i, ++rec) {
+        rec->addr_src = htonl(0x0A000000U + i);
+        rec->addr_dst = htonl(0xC0A80100U + i);
+        rec->delta_pkts = htonl(i + 1U);
+        rec->delta_octets = htonl(1500U * (i + 1U));
+        rec->ts_first = htonl(6501U);
+        rec->ts_last = htonl(9000U);
+        rec->port_src = htons(1024U + i);
+        rec->port_dst = htons(443U);
+        rec->tcp_flags = 0x12;
+        rec->proto = 6;
+    }
+    return raw;
+}
+
+/**
+ * \brief Generate a NetFlow v9 Message with flow records
+ * \param[in] recs       Number of records
+ * \param[in] with_tmplt Add a Template FlowSet with the Template of the records
+ */
+static std::vector<uint8_t>
+gen_nf9(uint16_t recs, bool with_tmplt)
+{
+    nf9_msg msg;
+    msg.set_odid(BENCH_ODID);
+    msg.set_time_unix(1562857357U);
+    msg.set_time_uptime(10001U);
+
+    if (with_tmplt) {
+        nf9_trec trec(BENCH_TID);
+        trec.add_field(IPX_NF9_IE_IPV4_SRC_ADDR, 4);
+        trec.add_field(IPX_NF9_IE_IPV4_DST_ADDR, 4);
+        trec.add_field(IPX_NF9_IE_L4_SRC_PORT, 2);
+        trec.add_field(IPX_NF9_IE_L4_DST_PORT, 2);
+        trec.add_field(IPX_NF9_IE_PROTOCOL, 1);
+        trec.add_field(IPX_NF9_IE_TCP_FLAGS, 1);
+        trec.add_field(IPX_NF9_IE_IN_BYTES, 4);
+        trec.add_field(IPX_NF9_IE_IN_PKTS, 4);
+        trec.add_field(IPX_NF9_IE_FIRST_SWITCHED, 4);
+        trec.add_field(IPX_NF9_IE_LAST_SWITCHED, 4);
+
+        nf9_set tset(IPX_NF9_SET_TMPLT);
+        tset.add_rec(trec);
+        msg.add_set(tset);
+    }
+
+    nf9_set dset(BENCH_TID);
+    for (uint16_t i = 0; i < recs; ++i) {
+        const uint32_t addr_src = htonl(0x0A000000U + i);
+        const uint32_t addr_dst = htonl(0xC0A80100U + i);
+        nf9_drec drec;
+        drec.append_octets(&addr_src, 4);
+        drec.append_octets(&addr_dst, 4);
+        drec.append_uint(1024U + i, 2);
+        drec.append_uint(443, 2);
+        drec.append_uint(6, 1);
+        drec.append_uint(0x12, 1);
+        drec.append_uint(1500U * (i + 1U), 4);
+        drec.append_uint(i + 1U, 4);
+        drec.append_uint(6501U, 4);
+        drec.append_uint(9000U, 4);
+        dset.add_rec(drec);
+    }
+    msg.add_set(dset);
+
+    const size_t size = msg.size();
+    return raw_copy(msg.release(), size);
+}
+
+/**
+ * \brief Change the sequence number of an IPFIX or NetFlow Message
+ * \param[in] msg Message wrapper
+ * \param[in] seq New sequence number
+ */
+static void
+seq_set(ipx_msg_ipfix_t *msg, uint32_t seq)
+{
+    uint8_t *pkt = ipx_msg_ipfix_get_packet(msg);
+    switch (ntohs(*reinterpret_cast<uint16_t *>(pkt))) {
+    case IPX_NF5_VERSION:
+        reinterpret_cast<struct ipx_nf5_hdr *>(pkt)->flow_seq = htonl(seq);
+        break;
+    case IPX_NF9_VERSION:
+        reinterpret_cast<struct ipx_nf9_msg_hdr *>(pkt)->seq_number = htonl(seq);
+        break;
+    default:
+        reinterpret_cast<struct fds_ipfix_msg_hdr *>(pkt)->seq_num = htonl(seq);
+        break;
+    }
+}
+
+/**
+ * \brief Benchmark a ring buffer (a single writer and a single reader thread)
+ * \param[in] name Name of the component
+ * \param[in] type Type of the ring buffer
+ * \param[in] cnt  Number of messages
+ */
+static bench_result
+bench_ring(const std::string &name, enum ipx_ring_type type, uint64_t cnt)
+{
+    std::unique_ptr<ipx_ring_t, decltype(&ipx_ring_destroy)> ring(
+        ipx_ring_init_type(ipx_configurator::RING_DEF_SIZE, false, type), &ipx_ring_destroy);
+    if (!ring) {
+        throw std::runtime_error("Failed to create a ring buffer!");
+    }
+
+    bench_clock::time_point start = bench_clock::now();
+    std::thread reader([&ring, cnt]() {
+        ipx_msg_t *batch[BENCH_RING_BULK];
+        uint64_t recv = 0;
+        while (recv < cnt) {
+            recv += ipx_ring_pop_bulk(ring.get(), batch, BENCH_RING_BULK);
+        }
+    });
+
+    // Messages are never dereferenced, therefore, fake non-NULL pointers are used
+    ipx_msg_t *batch[BENCH_RING_BULK];
+    for (uint64_t sent = 0; sent < cnt; ) {
+        const uint32_t bulk = static_cast<uint32_t>(std::min<uint64_t>(BENCH_RING_BULK,
+            cnt - sent));
+        for (uint32_t i = 0; i < bulk; ++i) {
+            batch[i] = reinterpret_cast<ipx_msg_t *>(static_cast<uintptr_t>(sent + i + 1));
+        }
+        ipx_ring_push_bulk(ring.get(), batch, bulk);
+        sent += bulk;
+    }
+
+    reader.join();
+    bench_result res;
+    res.name = name;
+    res.msgs = cnt;
+    res.secs = elapsed(start);
+    return res;
+}
+
+/** Converter of messages (NetFlow to IPFIX or the IPFIX parser)                                */
+using bench_conv_fn = int (*)(void *conv, ipx_msg_ipfix_t **msg, std::vector<ipx_msg_garbage_t *> &gc);
+
+/**
+ * \brief Benchmark a converter of messages
+ *
+ * Messages are prepared in rounds and only processing of the messages is measured.
+ * \param[in] env     Environment
+ * \param[in] name    Name of the component
+ * \param[in] conv    Converter instance
+ * \param[in] conv_fn Processing function of the converter
+ * \param[in] first   The first message (e.g. with templates)
+ * \param[in] next    Following messages
+ * \param[in] seq_inc Increment of the sequence number after each message
+ * \param[in] cnt     Number of messages
+ * \param[in] recs    Number of records in each message
+ */
+static bench_result
+bench_conv(bench_env &env, const std::string &name, void *conv, bench_conv_fn conv_fn,
+    const std::vector<uint8_t> &first, const std::vector<uint8_t> &next, uint32_t seq_inc,
+    uint64_t cnt, uint16_t recs)
+{
+    bench_result res;
+    res.name = name;
+
+    std::vector<ipx_msg_ipfix_t *> round;
+    std::vector<ipx_msg_garbage_t *> garbage;
+    round.reserve(BENCH_ROUND);
+    uint32_t seq = 0;
+
+    for (uint64_t done = 0; done < cnt; ) {
+        const size_t round_cnt = static_cast<size_t>(std::min<uint64_t>(BENCH_ROUND, cnt - done));
+        for (size_t i = 0; i < round_cnt; ++i) {
+            ipx_msg_ipfix_t *msg = env.wrap((done + i == 0) ? first : next);
+            seq_set(msg, seq);
+            seq += seq_inc;
+            round.push_back(msg);
+        }
+
+        bench_clock::time_point start = bench_clock::now();
+        for (auto &msg : round) {
+            if (conv_fn(conv, &msg, garbage) != IPX_OK) {
+                throw std::runtime_error(name + ": failed to process a message!");
+            }
+        }
+        res.secs += elapsed(start);
+
+        for (auto msg : round) {
+            ipx_msg_ipfix_destroy(msg);
+        }
+        for (auto msg : garbage) {
+            ipx_msg_garbage_destroy(msg);
+        }
+        round.clear();
+        garbage.clear();
+        done += round_cnt;
+    }
+
+    res.msgs = cnt;
+    res.recs = cnt * recs;
+    return res;
+}
+
+/** Processing function of the IPFIX parser                                                     */
+static int
+conv_parser(void *conv, ipx_msg_ipfix_t **msg, std::vector<ipx_msg_garbage_t *> &gc)
+{
+    ipx_msg_garbage_t *garbage = nullptr;
+    int rc = ipx_parser_process(static_cast<ipx_parser_t *>(conv), msg, &garbage);
+    if (garbage != nullptr) {
+        gc.push_back(garbage);
+    }
+    return rc;
+}
+
+/** Processing function of the NetFlow v5 converter                                             */
+static int
+conv_nf5(void *conv, ipx_msg_ipfix_t **msg, std::vector<ipx_msg_garbage_t *> &gc)
+{
+    (void) gc;
+    return ipx_nf5_conv_process(static_cast<ipx_nf5_conv_t *>(conv), *msg);
+}
+
+/** Processing function of the NetFlow v9 converter                                             */
+static int
+conv_nf9(void *conv, ipx_msg_ipfix_t **msg, std::vector<ipx_msg_garbage_t *> &gc)
+{
+    (void) gc;
+    return ipx_nf9_conv_process(static_cast<ipx_nf9_conv_t *>(conv), *msg);
+}
+
+/** Create an IPFIX parser with definitions of Information Elements                            */
+static std::unique_ptr<ipx_parser_t, decltype(&ipx_parser_destroy)>
+parser_create(bench_env &env, const std::string &name)
+{
+    std::unique_ptr<ipx_parser_t, decltype(&ipx_parser_destroy)> parser(
+        ipx_parser_create(name.c_str(), BENCH_VERB), &ipx_parser_destroy);
+    if (!parser) {
+        throw std::runtime_error("Failed to create the IPFIX parser!");
+    }
+
+    ipx_msg_garbage_t *garbage = nullptr;
+    if (ipx_parser_ie_source(parser.get(), env.iemgr, &garbage) != IPX_OK) {
+        throw std::runtime_error("Failed to set definitions of IEs of the parser!");
+    }
+    if (garbage != nullptr) {
+        ipx_msg_garbage_destroy(garbage);
+    }
+    return parser;
+}
+
+static bench_result
+bench_parser(bench_env &env, const bench_cfg &cfg)
+{
+    auto parser = parser_create(env, "parser");
+    return bench_conv(env, "parser", parser.get(), &conv_parser,
+        gen_ipfix(cfg.rec_cnt, true), gen_ipfix(cfg.rec_cnt, false), cfg.rec_cnt,
+        cfg.msg_cnt, cfg.rec_cnt);
+}
+
+static bench_result
+bench_nf5(bench_env &env, const bench_cfg &cfg, const std::string &name, bool simd)
+{
+    // NetFlow v5 Message can hold at most 30 records
+    const uint16_t recs = std::min<uint16_t>(cfg.rec_cnt, 30U);
+    std::unique_ptr<ipx_nf5_conv_t, decltype(&ipx_nf5_conv_destroy)> conv(
+        ipx_nf5_conv_init(name.c_str(), BENCH_VERB, 0, BENCH_ODID), &ipx_nf5_conv_destroy);
+    if (!conv) {
+        throw std::runtime_error("Failed to create the NetFlow v5 converter!");
+    }
+    ipx_nf5_conv_simd(conv.get(), simd);
+
+    const std::vector<uint8_t> raw = gen_nf5(recs);
+    return bench_conv(env, name, conv.get(), &conv_nf5, raw, raw, recs, cfg.msg_cnt, recs);
+}
+
+static bench_result
+bench_nf9(bench_env &env, const bench_cfg &cfg)
+{
+    std::unique_ptr<ipx_nf9_conv_t, decltype(&ipx_nf9_conv_destroy)> conv(
+        ipx_nf9_conv_init("nf9", BENCH_VERB), &ipx_nf9_conv_destroy);
+    if (!conv) {
+        throw std::runtime_error("Failed to create the NetFlow v9 converter!");
+    }
+
+    // Sequence numbers of NetFlow v9 count messages
+    return bench_conv(env, "nf9", conv.get(), &conv_nf9, gen_nf9(cfg.rec_cnt, true),
+        gen_nf9(cfg.rec_cnt, false), 1, cfg.msg_cnt, cfg.rec_cnt);
+}
+
+/** Sink of formatted values (prevents the compiler from removing the formatting)             */
+static volatile uint64_t bench_fmt_sink;
+
+/**
+ * \brief Benchmark a text formatter of values
+ *
+ * Each message is represented by formatting of one value per record. Values are taken from
+ * a table of #BENCH_FMT_VALUES prepared values.
+ * \param[in] cfg  Configuration of benchmarks
+ * \param[in] name Name of the component
+ * \param[in] fn   Formatter (arguments: output buffer, index of the value; returns the end)
+ */
+template <typename Fn>
+static bench_result
+bench_fmt_run(const bench_cfg &cfg, const std::string &name, Fn fn)
+{
+    char buffer[BENCH_FMT_BSIZE];
+    uint64_t sink = 0;
+    size_t idx = 0;
+
+    bench_clock::time_point start = bench_clock::now();
+    for (uint64_t msg = 0; msg < cfg.msg_cnt; ++msg) {
+        for (uint16_t rec = 0; rec < cfg.rec_cnt; ++rec) {
+            const char *end = fn(buffer, idx);
+            sink += static_cast<uint64_t>(end - buffer) + static_cast<uint8_t>(buffer[0]);
+            idx = (idx + 1) & (BENCH_FMT_VALUES - 1);
+        }
+    }
+
+    bench_result res;
+    res.name = name;
+    res.msgs = cfg.msg_cnt;
+    res.recs = cfg.msg_cnt * cfg.rec_cnt;
+    res.secs = elapsed(start);
+    bench_fmt_sink = sink;
+    return res;
+}
+
+/**
+ * \brief Generate pseudo-random values for formatter benchmarks
+ * \return Values of various magnitudes (i.e. number of digits)
+ */
+static std::vector<uint64_t>
+gen_fmt_values()
+{
+    std::vector<uint64_t> values(BENCH_FMT_VALUES);
+    uint64_t state = 1;
+    for (auto &value : values) {
+        state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+        value = state >> (state >> 58);
+    }
+    return values;
+}
+
+/**
+ * \brief Benchmark formatting of unsigned integers
+ * \param[in] cfg  Configuration of benchmarks
+ * \param[in] name Name of the component
+ * \param[in] libc Use snprintf() instead of the formatter of JSON output plugins
+ */
+static bench_result
+bench_fmt_uint(const bench_cfg &cfg, const std::string &name, bool libc)
+{
+    const std::vector<uint64_t> values = gen_fmt_values();
+    if (libc) {
+        return bench_fmt_run(cfg, name, [&values](char *buffer, size_t idx) {
+            return buffer + snprintf(buffer, BENCH_FMT_BSIZE, "%" PRIu64, values[idx]);
+        });
+    }
+
+    return bench_fmt_run(cfg, name, [&values](char *buffer, size_t idx) {
+        return fmt_uint(buffer, values[idx]);
+    });
+}
+
+/**
+ * \brief Benchmark formatting of IPv4 or IPv6 addresses
+ * \param[in] cfg  Configuration of benchmarks
+ * \param[in] name Name of the component
+ * \param[in] ipv6 Format IPv6 addresses instead of IPv4 addresses
+ * \param[in] libc Use inet_ntop() instead of the formatter of JSON output plugins
+ */
+static bench_result
+bench_fmt_ip(const bench_cfg &cfg, const std::string &name, bool ipv6, bool libc)
+{
+    // Addresses of various forms (e.g. with compressible runs of zero groups)
+    const std::vector<uint64_t> values = gen_fmt_values();
+    std::vector<uint8_t> addrs(BENCH_FMT_VALUES * 16U, 0);
+    for (size_t i = 0; i < BENCH_FMT_VALUES; ++i) {
+        uint8_t *addr = &addrs[i * 16U];
+        const uint64_t value = values[i];
+        if (!ipv6) {
+            memcpy(addr, &value, 4);
+            continue;
+        }
+
+        addr[0] = 0x20;
+        addr[1] = 0x01;
+        addr[2] = 0x07;
+        addr[3] = 0x18;
+        memcpy(addr + ((value & 0x1U) ? 8U : 4U), &value, sizeof(value));
+    }
+
+    const int family = ipv6 ? AF_INET6 : AF_INET;
+    if (libc) {
+        return bench_fmt_run(cfg, name, [&addrs, family](char *buffer, size_t idx) {
+            inet_ntop(family, &addrs[idx * 16U], buffer, BENCH_FMT_BSIZE);
+            return buffer + strlen(buffer);
+        });
+    }
+
+    if (ipv6) {
+        return bench_fmt_run(cfg, name, [&addrs](char *buffer, size_t idx) {
+            return fmt_ipv6(buffer, &addrs[idx * 16U]);
+        });
+    }
+
+    return bench_fmt_run(cfg, name, [&addrs](char *buffer, size_t idx) {
+        return fmt_ipv4(buffer, &addrs[idx * 16U]);
+    });
+}
+
+/**
+ * \brief Benchmark formatting of timestamps in ISO 8601 format
+ *
+ * Timestamps are increasing and close to each other, similarly to timestamps of records of
+ * the same message.
+ * \param[in] cfg  Configuration of benchmarks
+ * \param[in] name Name of the component
+ * \param[in] libc Use gmtime_r() and strftime() instead of the formatter of JSON output plugins
+ */
+static bench_result
+bench_fmt_time(const bench_cfg &cfg, const std::string &name, bool libc)
+{
+    std::vector<uint64_t> values(BENCH_FMT_VALUES);
+    for (size_t i = 0; i < BENCH_FMT_VALUES; ++i) {
+        values[i] = 1562857357000ULL + i * 7U;
+    }
+
+    if (libc) {
+        return bench_fmt_run(cfg, name, [&values](char *buffer, size_t idx) {
+            const time_t secs = static_cast<time_t>(values[idx] / 1000);
+            struct tm tm;
+            gmtime_r(&secs, &tm);
+            size_t len = strftime(buffer, BENCH_FMT_BSIZE, "%Y-%m-%dT%H:%M:%S", &tm);
+            len += snprintf(buffer + len, BENCH_FMT_BSIZE - len, ".%03uZ",
+                static_cast<unsigned int>(values[idx] % 1000));
+            return buffer + len;
+        });
+    }
+
+    TimeFormatter formatter;
+    return bench_fmt_run(cfg, name, [&values, &formatter](char *buffer, size_t idx) {
+        return formatter.format(buffer, values[idx]);
+    });
+}
+
+/**
+ * \brief Benchmark the hash table of fdsdump aggregator
+ *
+ * Each record is represented by a lookup of a key (a new record is created, if missing) and
+ * an update of its value. Keys are taken from a table of #BENCH_HASH_KEYS pseudo-random keys
+ * in a scattered order, so the table is mostly larger than caches. Tags of blocks of the
+ * table are compared by SSE2 or NEON instructions, if available at compile time (define
+ * FDSDUMP_HASH_TABLE_SCALAR to measure the portable version).
+ * \param[in] cfg  Configuration of benchmarks
+ * \param[in] name Name of the component
+ */
+static bench_result
+bench_aggr_hash(const bench_cfg &cfg, const std::string &name)
+{
+    std::vector<uint8_t> keys(BENCH_HASH_KEYS * BENCH_HASH_KEY_SIZE);
+    uint64_t state = 1;
+    for (size_t i = 0; i < keys.size(); i += sizeof(state)) {
+        state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+        memcpy(&keys[i], &state, std::min(sizeof(state), keys.size() - i));
+    }
+
+    fdsdump::aggregator::HashTable table(BENCH_HASH_KEY_SIZE, sizeof(uint64_t));
+    uint64_t sink = 0;
+    size_t idx = 0;
+
+    bench_clock::time_point start = bench_clock::now();
+    for (uint64_t msg = 0; msg < cfg.msg_cnt; ++msg) {
+        for (uint16_t rec = 0; rec < cfg.rec_cnt; ++rec) {
+            uint8_t *record;
+            uint64_t value = 0;
+            if (table.find_or_create(&keys[idx * BENCH_HASH_KEY_SIZE], record)) {
+                memcpy(&value, record + BENCH_HASH_KEY_SIZE, sizeof(value));
+            }
+            value++;
+            memcpy(record + BENCH_HASH_KEY_SIZE, &value, sizeof(value));
+            sink += value;
+            // Odd step, i.e. all keys are visited before any of them is repeated
+            idx = (idx + 0x9E3779B1U) & (BENCH_HASH_KEYS - 1);
+        }
+    }
+
+    bench_result res;
+    res.name = name;
+    res.msgs = cfg.msg_cnt;
+    res.recs = cfg.msg_cnt * cfg.rec_cnt;
+    res.secs = elapsed(start);
+    bench_fmt_sink = sink;
+    return res;
+}
+
+/**
+ * \brief Push a control message (it is destroyed by the output instance)
+ * \param[in] ring Input ring of the output instance
+ * \param[in] msg  Message
+ */
+static void
+push_ctrl(ipx_ring_t *ring, ipx_msg_t *msg)
+{
+    if (!msg) {
+        throw std::bad_alloc();
+    }
+    ipx_msg_header_cnt_set(msg, 1);
+    ipx_ring_push(ring, msg);
+}
+
+/**
+ * \brief Benchmark an output instance
+ *
+ * A pool of parsed IPFIX Messages is repeatedly passed to an output instance running in its
+ * own thread (i.e. the same way as in the pipeline). The measured time includes termination
+ * of the instance (e.g. flushing of buffers).
+ * \param[in] env    Environment
+ * \param[in] cfg    Configuration of benchmarks
+ * \param[in] mgr    Plugin manager
+ * \param[in] plugin Name of the output plugin
+ * \param[in] params XML parameters of the instance
+ */
+static bench_result
+bench_output(bench_env &env, const bench_cfg &cfg, ipx_plugin_mgr &mgr,
+    const std::string &plugin, const std::string &params)
+{
+    const std::string name = "output:" + plugin;
+    std::unique_ptr<ipx_instance_output> output(new ipx_instance_output(name,
+        mgr.plugin_get(IPX_PT_OUTPUT, plugin), ipx_configurator::RING_DEF_SIZE));
+    output->init(params, env.iemgr, BENCH_VERB);
+    ipx_ring_t *ring = std::get<0>(output->get_input());
+
+    // Parse the pool of messages (the parser must outlive the messages)
+    auto parser = parser_create(env, name + " (parser)");
+    const std::vector<uint8_t> first = gen_ipfix(cfg.rec_cnt, true);
+    const std::vector<uint8_t> next = gen_ipfix(cfg.rec_cnt, false);
+    const size_t pool_cnt = static_cast<size_t>(std::min<uint64_t>(BENCH_OUTPUT_POOL, cfg.msg_cnt));
+    std::vector<ipx_msg_ipfix_t *> pool;
+    std::vector<ipx_msg_garbage_t *> garbage;
+    uint64_t recs = 0;
+
+    for (size_t i = 0; i < pool_cnt; ++i) {
+        ipx_msg_ipfix_t *msg = env.wrap((i == 0) ? first : next);
+        seq_set(msg, static_cast<uint32_t>(i * cfg.rec_cnt));
+        if (conv_parser(parser.get(), &msg, garbage) != IPX_OK) {
+            ipx_msg_ipfix_destroy(msg);
+            throw std::runtime_error(name + ": failed to parse a message!");
+        }
+
+        // The instance only decrements references, the pool is destroyed at the end
+        const uint64_t passes = cfg.msg_cnt / pool_cnt + ((i < cfg.msg_cnt % pool_cnt) ? 1 : 0);
+        ipx_msg_header_cnt_set(ipx_msg_ipfix2base(msg), static_cast<unsigned int>(passes + 1));
+        pool.push_back(msg);
+    }
+
+    bench_clock::time_point start = bench_clock::now();
+    output->start();
+    push_ctrl(ring, ipx_msg_session2base(
+        ipx_msg_session_create(env.session, IPX_MSG_SESSION_OPEN)));
+    for (uint64_t i = 0; i < cfg.msg_cnt; ++i) {
+        ipx_msg_ipfix_t *msg = pool[i % pool_cnt];
+        ipx_ring_push(ring, ipx_msg_ipfix2base(msg));
+        recs += ipx_msg_ipfix_get_drec_cnt(msg);
+    }
+    push_ctrl(ring, ipx_msg_session2base(
+        ipx_msg_session_create(env.session, IPX_MSG_SESSION_CLOSE)));
+    push_ctrl(ring, ipx_msg_terminate2base(
+        ipx_msg_terminate_create(IPX_MSG_TERMINATE_INSTANCE)));
+    output.reset(); // Wait for termination of the thread
+
+    bench_result res;
+    res.name = name;
+    res.msgs = cfg.msg_cnt;
+    res.recs = recs;
+    res.secs = elapsed(start);
+
+    for (auto msg : pool) {
+        ipx_msg_ipfix_destroy(msg);
+    }
+    for (auto msg : garbage) {
+        ipx_msg_garbage_destroy(msg);
+    }
+    return res;
+}
+
+/**
+ * \brief Print a result
+ * \param[in] res  Result
+ * \param[in] json Print as a JSON object
+ */
+static void
+result_print(const bench_result &res, bool json)
+{
+    const double secs = (res.secs > 0.0) ? res.secs : 1e-9;
+    const double msgs_rate = static_cast<double>(res.msgs) / secs;
+    const double recs_rate = static_cast<double>(res.recs) / secs;
+    const double ns_msg = (res.msgs > 0) ? (secs * 1e9 / static_cast<double>(res.msgs)) : 0.0;
+    const double ns_rec = (res.recs > 0) ? (secs * 1e9 / static_cast<double>(res.recs)) : 0.0;
+    char ns_rec_str[32] = "null";
+    if (res.recs > 0) {
+        snprintf(ns_rec_str, sizeof(ns_rec_str), "%.2f", ns_rec);
+    }
+
+    if (json) {
+        printf("{\"version\":\"%s\",\"component\":\"%s\",\"msgs\":%" PRIu64 ",\"records\":%"
+            PRIu64 ",\"seconds\":%.6f,\"msgs_per_s\":%.0f,\"records_per_s\":%.0f,"
+            "\"ns_per_msg\":%.2f,\"ns_per_record\":%s}\n", IPX_BUILD_VERSION_FULL_STR,
+            res.name.c_str(), res.msgs, res.recs, res.secs, msgs_rate, recs_rate, ns_msg,
+            ns_rec_str);
+    } else {
+        printf("%-24s %12" PRIu64 " msgs %14.0f msgs/s %14.0f recs/s %10.2f ns/msg %10s ns/rec\n",
+            res.name.c_str(), res.msgs, msgs_rate, recs_rate, ns_msg,
+            (res.recs > 0) ? ns_rec_str : "-");
+    }
+    fflush(stdout);
+}
+
+/** Read content of a file                                                                      */
+static std::string
+file_read(const std::string &path)
+{
+    std::ifstream file(path);
+    if (!file) {
+        throw std::runtime_error("Failed to open file '" + path + "'");
+    }
+    std::stringstream buffer;
+    buffer << file.rdbuf();
+    return buffer.str();
+}
+
+static void
+print_help()
+{
+    std::cout
+        << "Microbenchmarks of the IPFIXcol2 pipeline\n"
+        << "Usage: ipfixcol2-bench [-n MSGS] [-r RECS] [-c LIST] [-o NAME[:FILE]] [-p PATH] "
+           "[-e DIR] [-jh]\n"
+        << "  -n MSGS        Number of messages processed by each component (default: 100000)\n"
+        << "  -r RECS        Number of Data Records in each message (default: 30)\n"
+        << "  -c LIST        Comma separated list of components to benchmark\n"
+        << "                 (ring, ring-lockfree, parser, nf5, nf5-scalar, nf9, fmt-uint,\n"
+           "                 fmt-uint-libc, fmt-ipv4, fmt-ipv4-libc, fmt-ipv6, fmt-ipv6-libc,\n"
+           "                 fmt-time, fmt-time-libc, aggr-hash, default: all)\n"
+        << "  -o NAME[:FILE] Benchmark an output plugin (can be used multiple times)\n"
+        << "                 FILE contains XML parameters of the instance (\"<params>...\")\n"
+        << "  -p PATH        Add path to a directory with plugins or to a file\n"
+        << "                 (default: " << IPX_DEFAULT_PLUGINS_DIR << ")\n"
+        << "  -e DIR         Path to a directory with definitions of IPFIX Information Elements\n"
+        << "                 (default: " << fds_api_cfg_dir() << ")\n"
+        << "  -j             Print results as JSON objects (one per line)\n"
+        << "  -h             Show this help message and exit\n";
+}
+
+/** Is a component selected?                                                                    */
+static bool
+selected(const bench_cfg &cfg, const std::string &name)
+{
+    return cfg.components.empty()
+        || std::find(cfg.components.begin(), cfg.components.end(), name) != cfg.components.end();
+}
+
+int
+main(int argc, char *argv[])
+{
+    bench_cfg cfg;
+    cfg.ie_dir = fds_api_cfg_dir();
+
+    int opt;
+    try {
+        while ((opt = getopt(argc, argv, "n:r:c:o:p:e:jh")) != -1) {
+            switch (opt) {
+            case 'n':
+                cfg.msg_cnt = std::stoull(optarg);
+                break;
+            case 'r':
+                cfg.rec_cnt = static_cast<uint16_t>(std::stoul(optarg));
+                break;
+            case 'c': {
+                std::stringstream list(optarg);
+                std::string item;
+                while (std::getline(list, item, ',')) {
+                    cfg.components.push_back(item);
+                }
+                }
+                break;
+            case 'o': {
+                std::string arg = optarg;
+                size_t pos = arg.find(':');
+                if (pos == std::string::npos) {
+                    cfg.outputs.emplace_back(arg, "<params/>");
+                } else {
+                    cfg.outputs.emplace_back(arg.substr(0, pos), file_read(arg.substr(pos + 1)));
+                }
+                }
+                break;
+            case 'p':
+                cfg.plugin_paths.push_back(optarg);
+                break;
+            case 'e':
+                cfg.ie_dir = optarg;
+                break;
+            case 'j':
+                cfg.json = true;
+                break;
+            case 'h':
+                print_help();
+                return EXIT_SUCCESS;
+            default:
+                return EXIT_FAILURE;
+            }
+        }
+    } catch (std::exception &ex) {
+        std::cerr << "Invalid arguments: " << ex.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    // Size of a message is limited to 65535 bytes (46 bytes per record)
+    if (cfg.msg_cnt == 0 || cfg.rec_cnt == 0 || cfg.rec_cnt > 1400) {
+        std::cerr << "Number of messages must be positive and number of records must be in "
+            "range 1..1400!" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    ipx_verb_level_set(BENCH_VERB);
+    try {
+        bench_env env(cfg.ie_dir);
+
+        if (selected(cfg, "ring")) {
+            result_print(bench_ring("ring", IPX_RING_TYPE_BLOCK, cfg.msg_cnt), cfg.json);
+        }
+        if (selected(cfg, "ring-lockfree")) {
+            result_print(bench_ring("ring-lockfree", IPX_RING_TYPE_LOCKFREE, cfg.msg_cnt),
+                cfg.json);
+        }
+        if (selected(cfg, "parser")) {
+            result_print(bench_parser(env, cfg), cfg.json);
+        }
+        if (selected(cfg, "nf5")) {
+            result_print(bench_nf5(env, cfg, "nf5", true), cfg.json);
+        }
+        if (selected(cfg, "nf5-scalar")) {
+            result_print(bench_nf5(env, cfg, "nf5-scalar", false), cfg.json);
+        }
+        if (selected(cfg, "nf9")) {
+            result_print(bench_nf9(env, cfg), cfg.json);
+        }
+        for (bool libc : {false, true}) {
+            const std::string suffix = libc ? "-libc" : "";
+            if (selected(cfg, "fmt-uint" + suffix)) {
+                result_print(bench_fmt_uint(cfg, "fmt-uint" + suffix, libc), cfg.json);
+            }
+            if (selected(cfg, "fmt-ipv4" + suffix)) {
+                result_print(bench_fmt_ip(cfg, "fmt-ipv4" + suffix, false, libc), cfg.json);
+            }
+            if (selected(cfg, "fmt-ipv6" + suffix)) {
+                result_print(bench_fmt_ip(cfg, "fmt-ipv6" + suffix, true, libc), cfg.json);
+            }
+            if (selected(cfg, "fmt-time" + suffix)) {
+                result_print(bench_fmt_time(cfg, "fmt-time" + suffix, libc), cfg.json);
+            }
+        }
+
+        if (selected(cfg, "aggr-hash")) {
+            result_print(bench_aggr_hash(cfg, "aggr-hash"), cfg.json);
+        }
+
+        if (!cfg.outputs.empty()) {
+            ipx_plugin_mgr mgr;
+            for (const auto &path : cfg.plugin_paths) {
+                mgr.path_add(path);
+            }
+            mgr.path_add(IPX_DEFAULT_PLUGINS_DIR);
+
+            for (const auto &output : cfg.outputs) {
+                result_print(bench_output(env, cfg, mgr, output.first, output.second), cfg.json);
+            }
+        }
+    } catch (std::exception &ex) {
+        std::cerr << "Benchmark failed: " << ex.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
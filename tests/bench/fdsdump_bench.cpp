@@ -0,0 +1,691 @@
+/**
+ * \file tests/bench/fdsdump_bench.cpp
+ * \brief Benchmark of fdsdump queries over synthetic FDS files
+ *
+ * A dataset of flow records with configurable cardinalities of addresses and ports, a mix of
+ * IPv4, IPv6 and variable-length Templates and a ratio of biflow records is generated into FDS
+ * files (by libfds). Standard fdsdump queries (listing, sorting, aggregation and statistics) are
+ * executed over the dataset as child processes and their throughput, peak memory usage and
+ * statistics of aggregation hash tables (reported by "fdsdump --profile") are printed.
+ */
+
+#include <cerrno>
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <getopt.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <libfds.h>
+
+#include "../unit/core/parser/tools/MsgGen.h"
+
+extern "C" {
+#include <build_config.h>
+}
+
+using bench_clock = std::chrono::steady_clock;
+
+/** Observation Domain ID of generated records                                                  */
+static const uint32_t BENCH_ODID = 1;
+/** Export Time of generated records (and start of the first flow, in seconds)                  */
+static const uint32_t BENCH_EXP_TIME = 1767225600U;
+/** Template ID of the first Template (IPv4 uniflow)                                            */
+static const uint16_t BENCH_TID = 256;
+/** Number of Template kinds (IPv4, IPv6, IPv4 with a variable-length field)                    */
+static const unsigned BENCH_KINDS = 3;
+/** Private Enterprise Number of reverse Information Elements of biflow records                 */
+static const uint32_t BENCH_REV_PEN = 29305;
+/** Name of a file which marks a complete dataset                                               */
+static const char *BENCH_DONE_FILE = ".complete";
+
+/** Template kinds                                                                              */
+enum bench_kind {
+    BENCH_KIND_IPV4 = 0,
+    BENCH_KIND_IPV6 = 1,
+    BENCH_KIND_VARLEN = 2
+};
+
+/** Configuration of the benchmark                                                              */
+struct bench_cfg {
+    /** Number of generated Data Records                                                        */
+    uint64_t rec_cnt = 1000000;
+    /** Number of generated FDS files (records are split evenly among them)                     */
+    unsigned file_cnt = 1;
+    /** Number of distinct source and destination addresses                                     */
+    uint32_t addr_cnt = 65536;
+    /** Number of distinct source and destination ports                                         */
+    uint32_t port_cnt = 1024;
+    /** Weights of Template kinds (see bench_kind)                                              */
+    unsigned mix[BENCH_KINDS] = {80, 15, 5};
+    /** Ratio of biflow records (0.0 - 1.0)                                                     */
+    double biflow = 0.0;
+    /** Compression of FDS files ("none", "lz4" or "zstd")                                      */
+    std::string compression = "lz4";
+    /** Directory of generated datasets                                                         */
+    std::string work_dir = ".";
+    /** Path of the fdsdump executable                                                          */
+    std::string fdsdump = FDSDUMP_BENCH_PATH;
+    /** Number of threads of fdsdump (0 == default)                                             */
+    unsigned threads = 0;
+    /** Selected queries                                                                        */
+    std::vector<std::string> queries;
+    /** Print results as JSON objects (one per line)                                            */
+    bool json = false;
+};
+
+/** Standard query of fdsdump                                                                   */
+struct bench_query {
+    /** Name of the query                                                                       */
+    const char *name;
+    /** Arguments of fdsdump (except input files and common options)                            */
+    std::vector<std::string> args;
+};
+
+/** Standard queries                                                                            */
+static const std::vector<bench_query> BENCH_QUERIES = {
+    {"list",      {"-o", "json-raw"}},
+    {"sort",      {"-o", "json:srcip,dstip,srcport,dstport,bytes", "-O", "bytes/desc"}},
+    {"aggr-flow", {"-A", "srcip,dstip,srcport,dstport,proto", "-S", "packets,bytes,flows",
+                   "-O", "bytes/desc", "-c", "10"}},
+    {"aggr-ip",   {"-A", "srcip", "-S", "packets,bytes,flows", "-O", "flows/desc", "-c", "10"}},
+    {"stats",     {"-I"}},
+};
+
+/** Result of a query                                                                           */
+struct bench_result {
+    /** Name of the query                                                                       */
+    std::string name;
+    /** Number of Data Records in the dataset                                                   */
+    uint64_t recs = 0;
+    /** Wall time of the query (in seconds)                                                     */
+    double secs = 0.0;
+    /** Peak resident set size of fdsdump (in KiB)                                              */
+    long max_rss = 0;
+    /** Statistics of hash tables are valid (i.e. the query aggregates records)                 */
+    bool table_valid = false;
+    /** Load factor of the largest hash table                                                   */
+    double load_factor = 0.0;
+    /** Average probe length (in blocks)                                                        */
+    double probe_avg = 0.0;
+    /** Maximal probe length (in blocks)                                                        */
+    uint64_t probe_max = 0;
+    /** Number of resizes of hash tables                                                        */
+    uint64_t resizes = 0;
+};
+
+/**
+ * \brief Pseudo-random number generator (SplitMix64)
+ *
+ * The dataset must be the same for all runs and hosts, therefore, the generator of the standard
+ * library (whose distributions are implementation specific) is not used.
+ */
+class bench_rand {
+public:
+    explicit bench_rand(uint64_t seed) : m_state(seed) {}
+
+    uint64_t
+    next()
+    {
+        uint64_t z = (m_state += 0x9E3779B97F4A7C15ULL);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        return z ^ (z >> 31);
+    }
+
+    /** Get a number in range 0..max-1                                                          */
+    uint32_t
+    below(uint32_t max)
+    {
+        return static_cast<uint32_t>((next() >> 32) * max >> 32);
+    }
+
+    /** Get a number in range 0.0 - 1.0                                                         */
+    double
+    unit()
+    {
+        return static_cast<double>(next() >> 11) * (1.0 / 9007199254740992.0);
+    }
+
+private:
+    uint64_t m_state;
+};
+
+/** Get time elapsed since a timestamp (in seconds)                                             */
+static double
+elapsed(bench_clock::time_point start)
+{
+    return std::chrono::duration<double>(bench_clock::now() - start).count();
+}
+
+/**
+ * \brief Create a Template of a kind
+ * \param[in] kind   Template kind
+ * \param[in] biflow Add reverse counters
+ */
+static ipfix_trec
+gen_tmplt(enum bench_kind kind, bool biflow)
+{
+    ipfix_trec trec(BENCH_TID + kind + (biflow ? BENCH_KINDS : 0));
+    if (kind == BENCH_KIND_IPV6) {
+        trec.add_field(27, 16); // sourceIPv6Address
+        trec.add_field(28, 16); // destinationIPv6Address
+    } else {
+        trec.add_field(8, 4);   // sourceIPv4Address
+        trec.add_field(12, 4);  // destinationIPv4Address
+    }
+    trec.add_field(7, 2);       // sourceTransportPort
+    trec.add_field(11, 2);      // destinationTransportPort
+    trec.add_field(4, 1);       // protocolIdentifier
+    trec.add_field(6, 1);       // tcpControlBits
+    trec.add_field(1, 8);       // octetDeltaCount
+    trec.add_field(2, 8);       // packetDeltaCount
+    trec.add_field(152, 8);     // flowStartMilliseconds
+    trec.add_field(153, 8);     // flowEndMilliseconds
+    if (kind == BENCH_KIND_VARLEN) {
+        trec.add_field(82, FDS_IPFIX_VAR_IE_LEN); // interfaceName
+    }
+    if (biflow) {
+        trec.add_field(1, 8, BENCH_REV_PEN);      // reverse octetDeltaCount
+        trec.add_field(2, 8, BENCH_REV_PEN);      // reverse packetDeltaCount
+    }
+    return trec;
+}
+
+/**
+ * \brief Append an address of a given index to a Data Record
+ * \param[in] drec Data Record
+ * \param[in] kind Template kind
+ * \param[in] net  Network of the address (0 == sources, 1 == destinations)
+ * \param[in] idx  Index of the address
+ */
+static void
+gen_addr(ipfix_drec &drec, enum bench_kind kind, uint8_t net, uint32_t idx)
+{
+    if (kind == BENCH_KIND_IPV6) {
+        // 2001:db8:N::IDX
+        uint8_t addr[16] = {0x20, 0x01, 0x0d, 0xb8, 0, net};
+        addr[12] = static_cast<uint8_t>(idx >> 24);
+        addr[13] = static_cast<uint8_t>(idx >> 16);
+        addr[14] = static_cast<uint8_t>(idx >> 8);
+        addr[15] = static_cast<uint8_t>(idx);
+        drec.append_octets(addr, sizeof(addr), false);
+    } else {
+        // 10.0.0.0/8 (sources) and 172.16.0.0/12 (destinations) wrap around on overflow
+        const uint32_t addr = (net == 0)
+            ? (0x0A000000U | (idx & 0x00FFFFFFU))
+            : (0xAC100000U | (idx & 0x000FFFFFU));
+        drec.append_uint(addr, 4);
+    }
+}
+
+/**
+ * \brief Generate a Data Record
+ * \param[in] rnd  Pseudo-random number generator
+ * \param[in] cfg  Configuration
+ * \param[in] kind Template kind
+ * \param[in] biflow Add reverse counters
+ * \param[in] time Start of the flow (milliseconds since the epoch)
+ */
+static ipfix_drec
+gen_drec(bench_rand &rnd, const bench_cfg &cfg, enum bench_kind kind, bool biflow, uint64_t time)
+{
+    static const char *ifc_names[] = {"eth0", "eth1", "bond0.100", "enp65s0f0", "enp65s0f1"};
+    static const uint8_t protos[] = {6, 6, 6, 17, 17, 1};
+
+    ipfix_drec drec;
+    const uint8_t proto = protos[rnd.below(sizeof(protos))];
+    const uint64_t pkts = 1U + rnd.below(64);
+
+    gen_addr(drec, kind, 0, rnd.below(cfg.addr_cnt));
+    gen_addr(drec, kind, 1, rnd.below(cfg.addr_cnt));
+    drec.append_uint(1024U + rnd.below(cfg.port_cnt), 2);
+    drec.append_uint((proto == 1) ? 0 : rnd.below(cfg.port_cnt), 2);
+    drec.append_uint(proto, 1);
+    drec.append_uint((proto == 6) ? 0x1B : 0, 1);
+    drec.append_uint(pkts * (40U + rnd.below(1460)), 8);
+    drec.append_uint(pkts, 8);
+    drec.append_uint(time, 8);
+    drec.append_uint(time + rnd.below(60000), 8);
+    if (kind == BENCH_KIND_VARLEN) {
+        const size_t ifc_cnt = sizeof(ifc_names) / sizeof(ifc_names[0]);
+        drec.append_string(ifc_names[rnd.below(ifc_cnt)]);
+    }
+    if (biflow) {
+        const uint64_t rev_pkts = 1U + rnd.below(64);
+        drec.append_uint(rev_pkts * (40U + rnd.below(1460)), 8);
+        drec.append_uint(rev_pkts, 8);
+    }
+    return drec;
+}
+
+/** Select a Template kind by weights of the mix                                                */
+static enum bench_kind
+gen_kind(bench_rand &rnd, const bench_cfg &cfg)
+{
+    const unsigned total = cfg.mix[0] + cfg.mix[1] + cfg.mix[2];
+    unsigned value = rnd.below(total);
+    for (unsigned i = 0; i < BENCH_KINDS; ++i) {
+        if (value < cfg.mix[i]) {
+            return static_cast<enum bench_kind>(i);
+        }
+        value -= cfg.mix[i];
+    }
+    return BENCH_KIND_IPV4;
+}
+
+/**
+ * \brief Generate an FDS file
+ * \param[in] cfg   Configuration
+ * \param[in] path  Path of the file
+ * \param[in] idx   Index of the file (seed of the generator)
+ * \param[in] recs  Number of Data Records
+ */
+static void
+gen_file(const bench_cfg &cfg, const std::string &path, unsigned idx, uint64_t recs)
+{
+    uint32_t flags = FDS_FILE_WRITE;
+    if (cfg.compression == "lz4") {
+        flags |= FDS_FILE_LZ4;
+    } else if (cfg.compression == "zstd") {
+        flags |= FDS_FILE_ZSTD;
+    }
+
+    std::unique_ptr<fds_file_t, decltype(&fds_file_close)> file(fds_file_init(), &fds_file_close);
+    if (!file) {
+        throw std::bad_alloc();
+    }
+    if (fds_file_open(file.get(), path.c_str(), flags) != FDS_OK) {
+        throw std::runtime_error("Failed to create file '" + path + "': "
+            + std::string(fds_file_error(file.get())));
+    }
+
+    struct fds_file_session session;
+    memset(&session, 0, sizeof(session));
+    session.ip_src[10] = session.ip_src[11] = 0xFF; // IPv4-mapped 192.168.0.2
+    session.ip_src[12] = 192;
+    session.ip_src[13] = 168;
+    session.ip_src[15] = 2;
+    session.port_src = 60000;
+    session.port_dst = 4739;
+    session.proto = FDS_FILE_SESSION_UDP;
+
+    fds_file_sid_t sid;
+    const uint32_t exp_time = BENCH_EXP_TIME + idx * 300U;
+    if (fds_file_session_add(file.get(), &session, &sid) != FDS_OK
+            || fds_file_write_ctx(file.get(), sid, BENCH_ODID, exp_time) != FDS_OK) {
+        throw std::runtime_error("Failed to add a Transport Session: "
+            + std::string(fds_file_error(file.get())));
+    }
+
+    for (bool biflow : {false, true}) {
+        for (unsigned kind = 0; kind < BENCH_KINDS; ++kind) {
+            const ipfix_trec trec = gen_tmplt(static_cast<enum bench_kind>(kind), biflow);
+            if (fds_file_write_tmplt_add(file.get(), FDS_TYPE_TEMPLATE, trec.front(),
+                    static_cast<uint16_t>(trec.size())) != FDS_OK) {
+                throw std::runtime_error("Failed to add a Template: "
+                    + std::string(fds_file_error(file.get())));
+            }
+        }
+    }
+
+    bench_rand rnd(0x5EED0000ULL + idx);
+    const uint64_t time_base = uint64_t(exp_time) * 1000U;
+    for (uint64_t i = 0; i < recs; ++i) {
+        const enum bench_kind kind = gen_kind(rnd, cfg);
+        const bool biflow = rnd.unit() < cfg.biflow;
+        // Flows of a file start within 5 minutes
+        const uint64_t time = time_base + (i * 300000U) / recs;
+        const ipfix_drec drec = gen_drec(rnd, cfg, kind, biflow, time);
+
+        const uint16_t tid = BENCH_TID + kind + (biflow ? BENCH_KINDS : 0);
+        if (fds_file_write_rec(file.get(), tid, drec.front(),
+                static_cast<uint16_t>(drec.size())) != FDS_OK) {
+            throw std::runtime_error("Failed to add a Data Record: "
+                + std::string(fds_file_error(file.get())));
+        }
+    }
+}
+
+/**
+ * \brief Generate a dataset (or reuse a previously generated one)
+ *
+ * Each combination of parameters has its own directory, which is reused by subsequent runs.
+ * \param[in] cfg Configuration
+ * \return Paths of FDS files of the dataset
+ */
+static std::vector<std::string>
+gen_dataset(const bench_cfg &cfg)
+{
+    std::ostringstream name;
+    name << cfg.work_dir << "/fdsdump-bench-n" << cfg.rec_cnt << "-f" << cfg.file_cnt
+        << "-a" << cfg.addr_cnt << "-p" << cfg.port_cnt
+        << "-m" << cfg.mix[0] << "." << cfg.mix[1] << "." << cfg.mix[2]
+        << "-b" << static_cast<unsigned>(cfg.biflow * 1000.0 + 0.5) << "-" << cfg.compression;
+    const std::string dir = name.str();
+
+    std::vector<std::string> paths;
+    for (unsigned i = 0; i < cfg.file_cnt; ++i) {
+        paths.push_back(dir + "/flows-" + std::to_string(i) + ".fds");
+    }
+
+    const std::string done = dir + "/" + BENCH_DONE_FILE;
+    if (access(done.c_str(), F_OK) == 0) {
+        return paths;
+    }
+
+    if (mkdir(dir.c_str(), 0755) != 0 && errno != EEXIST) {
+        throw std::runtime_error("Failed to create directory '" + dir + "': " + strerror(errno));
+    }
+
+    std::cerr << "Generating " << cfg.rec_cnt << " records into '" << dir << "'..." << std::endl;
+    const auto start = bench_clock::now();
+    for (unsigned i = 0; i < cfg.file_cnt; ++i) {
+        const uint64_t recs = cfg.rec_cnt / cfg.file_cnt + (i < cfg.rec_cnt % cfg.file_cnt);
+        gen_file(cfg, paths[i], i, recs);
+    }
+    std::cerr << "Dataset generated in " << elapsed(start) << " s" << std::endl;
+
+    std::ofstream(done).put('\n');
+    return paths;
+}
+
+/**
+ * \brief Parse statistics of hash tables from a profile of fdsdump
+ * \param[in]  profile Profile (the standard error output of "fdsdump --profile")
+ * \param[out] res     Result
+ */
+static void
+profile_parse(const std::string &profile, bench_result &res)
+{
+    std::istringstream lines(profile);
+    std::string line;
+    while (std::getline(lines, line)) {
+        unsigned long long a = 0;
+        double d = 0.0;
+        if (sscanf(line.c_str(), " load factor: %lf", &d) == 1) {
+            res.load_factor = d;
+            res.table_valid = true;
+        } else if (sscanf(line.c_str(), " probe length: %lf blocks on average, %llu",
+                &d, &a) == 2) {
+            res.probe_avg = d;
+            res.probe_max = a;
+        } else if (sscanf(line.c_str(), " resizes: %llu", &a) == 1) {
+            res.resizes = a;
+        }
+    }
+}
+
+/**
+ * \brief Run a query by fdsdump
+ *
+ * The standard output of fdsdump is discarded and its standard error output (i.e. the profile)
+ * is stored into a temporary file of the work directory.
+ * \param[in] cfg   Configuration
+ * \param[in] query Query
+ * \param[in] paths Input files
+ */
+static bench_result
+bench_run(const bench_cfg &cfg, const bench_query &query, const std::vector<std::string> &paths)
+{
+    std::vector<std::string> args = {cfg.fdsdump, "--profile"};
+    for (const auto &path : paths) {
+        args.push_back("-r");
+        args.push_back(path);
+    }
+    if (cfg.threads != 0) {
+        args.push_back("--threads");
+        args.push_back(std::to_string(cfg.threads));
+    }
+    args.insert(args.end(), query.args.begin(), query.args.end());
+
+    std::vector<char *> argv;
+    for (auto &arg : args) {
+        argv.push_back(&arg[0]);
+    }
+    argv.push_back(nullptr);
+
+    const std::string err_path = cfg.work_dir + "/fdsdump-bench-" + query.name + ".err";
+    const auto start = bench_clock::now();
+    const pid_t pid = fork();
+    if (pid < 0) {
+        throw std::runtime_error("fork() failed: " + std::string(strerror(errno)));
+    }
+    if (pid == 0) {
+        const int out_fd = open("/dev/null", O_WRONLY);
+        const int err_fd = open(err_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (out_fd < 0 || err_fd < 0 || dup2(out_fd, STDOUT_FILENO) < 0
+                || dup2(err_fd, STDERR_FILENO) < 0) {
+            _exit(127);
+        }
+        execv(argv[0], argv.data());
+        _exit(127);
+    }
+
+    int status;
+    struct rusage usage;
+    if (wait4(pid, &status, 0, &usage) != pid) {
+        throw std::runtime_error("wait4() failed: " + std::string(strerror(errno)));
+    }
+
+    bench_result res;
+    res.name = query.name;
+    res.recs = cfg.rec_cnt;
+    res.secs = elapsed(start);
+    res.max_rss = usage.ru_maxrss;
+
+    std::ifstream err_file(err_path);
+    std::stringstream profile;
+    profile << err_file.rdbuf();
+    unlink(err_path.c_str());
+
+    if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+        throw std::runtime_error("Query '" + res.name + "' failed (" + cfg.fdsdump + "):\n"
+            + profile.str());
+    }
+
+    profile_parse(profile.str(), res);
+    return res;
+}
+
+/** Print a result                                                                              */
+static void
+result_print(const bench_result &res, bool json)
+{
+    const double secs = (res.secs > 0.0) ? res.secs : 1e-9;
+    const double recs_rate = static_cast<double>(res.recs) / secs;
+
+    if (json) {
+        char table[160] = "null";
+        if (res.table_valid) {
+            snprintf(table, sizeof(table), "{\"load_factor\":%.3f,\"probe_avg\":%.3f,"
+                "\"probe_max\":%" PRIu64 ",\"resizes\":%" PRIu64 "}",
+                res.load_factor, res.probe_avg, res.probe_max, res.resizes);
+        }
+        printf("{\"version\":\"%s\",\"query\":\"%s\",\"records\":%" PRIu64 ",\"seconds\":%.6f,"
+            "\"records_per_s\":%.0f,\"max_rss_kib\":%ld,\"hash_table\":%s}\n",
+            IPX_BUILD_VERSION_FULL_STR, res.name.c_str(), res.recs, res.secs, recs_rate,
+            res.max_rss, table);
+    } else {
+        printf("%-12s %12" PRIu64 " recs %10.3f s %14.0f recs/s %10ld KiB RSS", res.name.c_str(),
+            res.recs, res.secs, recs_rate, res.max_rss);
+        if (res.table_valid) {
+            printf("   load %.3f, probe %.3f avg / %" PRIu64 " max, %" PRIu64 " resizes",
+                res.load_factor, res.probe_avg, res.probe_max, res.resizes);
+        }
+        printf("\n");
+    }
+    fflush(stdout);
+}
+
+/** Parse weights of Template kinds ("IPV4:IPV6:VARLEN")                                        */
+static void
+mix_parse(bench_cfg &cfg, const std::string &arg)
+{
+    std::stringstream list(arg);
+    std::string item;
+    unsigned i = 0;
+    while (std::getline(list, item, ':')) {
+        if (i == BENCH_KINDS) {
+            throw std::invalid_argument("too many weights of the template mix");
+        }
+        cfg.mix[i++] = static_cast<unsigned>(std::stoul(item));
+    }
+    if (i != BENCH_KINDS || cfg.mix[0] + cfg.mix[1] + cfg.mix[2] == 0) {
+        throw std::invalid_argument("invalid template mix");
+    }
+}
+
+static void
+print_help()
+{
+    std::cout
+        << "Benchmark of fdsdump queries over synthetic FDS files\n"
+        << "Usage: fdsdump-bench [options]\n"
+        << "  -n NUM         Number of generated flow records (default: 1000000)\n"
+        << "  -f NUM         Number of generated FDS files (default: 1)\n"
+        << "  -a NUM         Number of distinct source/destination addresses (default: 65536)\n"
+        << "  -p NUM         Number of distinct source/destination ports (default: 1024)\n"
+        << "  -m V4:V6:VAR   Weights of IPv4, IPv6 and variable-length templates\n"
+        << "                 (default: 80:15:5)\n"
+        << "  -b RATIO       Ratio of biflow records, 0.0 - 1.0 (default: 0.0)\n"
+        << "  -z TYPE        Compression of files: none, lz4 or zstd (default: lz4)\n"
+        << "  -w DIR         Directory of generated datasets (default: .)\n"
+        << "  -x PATH        Path of the fdsdump executable\n"
+        << "                 (default: " << FDSDUMP_BENCH_PATH << ")\n"
+        << "  -t NUM         Number of threads of fdsdump (default: fdsdump default)\n"
+        << "  -q LIST        Comma separated list of queries (default: all)\n"
+        << "                 Queries: list, sort, aggr-flow, aggr-ip, stats\n"
+        << "  -j             Print results as JSON objects (one per line)\n"
+        << "  -h             Show this help message and exit\n";
+}
+
+/** Is a query selected?                                                                        */
+static bool
+selected(const bench_cfg &cfg, const std::string &name)
+{
+    if (cfg.queries.empty()) {
+        return true;
+    }
+    for (const auto &query : cfg.queries) {
+        if (query == name) {
+            return true;
+        }
+    }
+    return false;
+}
+
+int
+main(int argc, char *argv[])
+{
+    bench_cfg cfg;
+
+    int opt;
+    try {
+        while ((opt = getopt(argc, argv, "n:f:a:p:m:b:z:w:x:t:q:jh")) != -1) {
+            switch (opt) {
+            case 'n':
+                cfg.rec_cnt = std::stoull(optarg);
+                break;
+            case 'f':
+                cfg.file_cnt = static_cast<unsigned>(std::stoul(optarg));
+                break;
+            case 'a':
+                cfg.addr_cnt = static_cast<uint32_t>(std::stoul(optarg));
+                break;
+            case 'p':
+                cfg.port_cnt = static_cast<uint32_t>(std::stoul(optarg));
+                break;
+            case 'm':
+                mix_parse(cfg, optarg);
+                break;
+            case 'b':
+                cfg.biflow = std::stod(optarg);
+                break;
+            case 'z':
+                cfg.compression = optarg;
+                break;
+            case 'w':
+                cfg.work_dir = optarg;
+                break;
+            case 'x':
+                cfg.fdsdump = optarg;
+                break;
+            case 't':
+                cfg.threads = static_cast<unsigned>(std::stoul(optarg));
+                break;
+            case 'q': {
+                std::stringstream list(optarg);
+                std::string item;
+                while (std::getline(list, item, ',')) {
+                    cfg.queries.push_back(item);
+                }
+                }
+                break;
+            case 'j':
+                cfg.json = true;
+                break;
+            case 'h':
+                print_help();
+                return EXIT_SUCCESS;
+            default:
+                return EXIT_FAILURE;
+            }
+        }
+    } catch (std::exception &ex) {
+        std::cerr << "Invalid arguments: " << ex.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    if (cfg.rec_cnt == 0 || cfg.file_cnt == 0 || cfg.addr_cnt == 0 || cfg.port_cnt == 0
+            || cfg.port_cnt > 64512) {
+        std::cerr << "Number of records, files and addresses must be positive and number of "
+            "ports must be in range 1..64512!" << std::endl;
+        return EXIT_FAILURE;
+    }
+    if (cfg.biflow < 0.0 || cfg.biflow > 1.0) {
+        std::cerr << "Ratio of biflow records must be in range 0.0 - 1.0!" << std::endl;
+        return EXIT_FAILURE;
+    }
+    if (cfg.compression != "none" && cfg.compression != "lz4" && cfg.compression != "zstd") {
+        std::cerr << "Unknown compression '" << cfg.compression << "'!" << std::endl;
+        return EXIT_FAILURE;
+    }
+    for (const auto &name : cfg.queries) {
+        bool found = false;
+        for (const auto &query : BENCH_QUERIES) {
+            found |= (name == query.name);
+        }
+        if (!found) {
+            std::cerr << "Unknown query '" << name << "'!" << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+
+    try {
+        const std::vector<std::string> paths = gen_dataset(cfg);
+        for (const auto &query : BENCH_QUERIES) {
+            if (selected(cfg, query.name)) {
+                result_print(bench_run(cfg, query, paths), cfg.json);
+            }
+        }
+    } catch (std::exception &ex) {
+        std::cerr << "Benchmark failed: " << ex.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
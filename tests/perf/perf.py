@@ -0,0 +1,456 @@
+#!/usr/bin/env python3
+
+"""
+Performance regression tests of IPFIXcol2 pipelines.
+
+Each test runs a standard pipeline on a fixed (deterministically generated)
+dataset, measures its throughput and latency and compares the results with
+a baseline. The test fails if a result is worse than the baseline by more
+than a threshold. See README.rst for details.
+
+Copyright(c) 2026 CESNET z.s.p.o.
+SPDX-License-Identifier: BSD-3-Clause
+"""
+
+import argparse
+import glob
+import json
+import os
+import platform
+import random
+import re
+import signal
+import socket
+import statistics
+import struct
+import subprocess
+import sys
+import time
+
+# Version of the dataset (increment on any change of the generator)
+DATASET_VERSION = 1
+# Number of Data Records in each IPFIX Message of the dataset
+DATASET_RECS = 30
+# Template is repeated every N messages (i.e. also for UDP)
+DATASET_TMPLT_REFRESH = 1000
+# Export Time of the first message of the dataset
+DATASET_START = 1600000000
+
+# Template of the dataset (IANA elements: id, length)
+TEMPLATE_ID = 256
+TEMPLATE_FIELDS = [
+    (8, 4),     # sourceIPv4Address
+    (12, 4),    # destinationIPv4Address
+    (7, 2),     # sourceTransportPort
+    (11, 2),    # destinationTransportPort
+    (4, 1),     # protocolIdentifier
+    (6, 2),     # tcpControlBits
+    (2, 8),     # packetDeltaCount
+    (1, 8),     # octetDeltaCount
+    (152, 8),   # flowStartMilliseconds
+    (153, 8),   # flowEndMilliseconds
+    (10, 4),    # ingressInterface
+]
+RECORD_FMT = "!IIHHBHQQQQI"
+
+# Metrics where a lower value is better (others are higher is better)
+LOWER_IS_BETTER = ("latency_p50_us", "latency_p99_us", "ns_per_record")
+
+
+class PerfError(Exception):
+    """Failure of a test (not a regression)."""
+
+
+def dataset_ipfix(args):
+    """
+    Generate the IPFIX File of the dataset (if it doesn't exist yet).
+
+    :return: Path to the file and the number of Data Records in it.
+    :rtype: (str, int)
+    """
+    path = os.path.join(args.work_dir, "data",
+        "flows-v{}-{}.ipfix".format(DATASET_VERSION, args.messages))
+    records = args.messages * DATASET_RECS
+    if os.path.exists(path):
+        return path, records
+
+    os.makedirs(os.path.dirname(path), exist_ok=True)
+    rnd = random.Random(DATASET_VERSION)
+
+    tmplt = struct.pack("!HH", TEMPLATE_ID, len(TEMPLATE_FIELDS))
+    tmplt += b"".join(struct.pack("!HH", ie_id, ie_len) for ie_id, ie_len in TEMPLATE_FIELDS)
+    tmplt_set = struct.pack("!HH", 2, 4 + len(tmplt)) + tmplt
+
+    tmp_path = path + ".tmp"
+    with open(tmp_path, "wb") as out:
+        for i in range(args.messages):
+            export_time = DATASET_START + i // DATASET_TMPLT_REFRESH
+            recs = []
+            for _ in range(DATASET_RECS):
+                start = export_time * 1000 - rnd.randrange(60000)
+                pkts = rnd.randrange(1, 1000)
+                recs.append(struct.pack(RECORD_FMT,
+                    0x0A000000 | rnd.randrange(1 << 16), 0xC0A80000 | rnd.randrange(1 << 16),
+                    rnd.randrange(1024, 65536), rnd.choice((53, 80, 443, 8080)),
+                    rnd.choice((6, 17)), rnd.randrange(64), pkts, pkts * rnd.randrange(40, 1500),
+                    start, start + rnd.randrange(60000), rnd.randrange(16)))
+            data = b"".join(recs)
+            body = struct.pack("!HH", TEMPLATE_ID, 4 + len(data)) + data
+            if i % DATASET_TMPLT_REFRESH == 0:
+                body = tmplt_set + body
+            out.write(struct.pack("!HHIII", 10, 16 + len(body), export_time,
+                i * DATASET_RECS, 1))
+            out.write(body)
+
+    os.rename(tmp_path, path)
+    return path, records
+
+
+def dataset_fds(args):
+    """
+    Convert the dataset into FDS File(s) by the collector (if not converted yet).
+
+    :return: Glob pattern of the files and the number of Data Records in them.
+    :rtype: (str, int)
+    """
+    ipfix_path, records = dataset_ipfix(args)
+    storage = os.path.splitext(ipfix_path)[0] + "-fds"
+    pattern = os.path.join(storage, "*", "*", "*", "*.fds")
+    if glob.glob(pattern):
+        return pattern, records
+
+    os.makedirs(storage, exist_ok=True)
+    run_collector(args, "ipfix-fds.xml", {"PATH": ipfix_path, "STORAGE": storage + "/"})
+    if not glob.glob(pattern):
+        raise PerfError("Conversion of the dataset into FDS Files has failed")
+    return pattern, records
+
+
+def config_create(args, name, variables):
+    """
+    Create a startup configuration from a template in the directory of configurations.
+
+    :param name: Name of the template
+    :param variables: Values of @VARIABLES@ in the template
+    :return: Path to the configuration
+    """
+    with open(os.path.join(args.configs, name)) as f:
+        content = f.read()
+    for key, value in variables.items():
+        content = content.replace("@{}@".format(key), str(value))
+
+    path = os.path.join(args.work_dir, "startup-" + name)
+    with open(path, "w") as f:
+        f.write(content)
+    return path
+
+
+def collector_cmd(args, config):
+    """Get the command line of the collector."""
+    cmd = [args.collector, "-c", config]
+    for plugin in args.plugin:
+        cmd += ["-p", plugin]
+    return cmd
+
+
+def run_collector(args, name, variables, stdout=subprocess.DEVNULL):
+    """
+    Run the collector until it terminates by itself (i.e. file inputs).
+
+    :return: Wall time of the run in seconds and the standard output (if captured).
+    """
+    config = config_create(args, name, variables)
+    start = time.monotonic()
+    ret = subprocess.run(collector_cmd(args, config), stdout=stdout,
+        stderr=subprocess.PIPE, timeout=args.timeout)
+    elapsed = time.monotonic() - start
+    if ret.returncode != 0:
+        raise PerfError("Collector has failed ({}): {}".format(
+            name, ret.stderr.decode(errors="replace").strip()))
+    return elapsed, ret.stdout
+
+
+def free_udp_port():
+    """Find an unused local UDP port."""
+    with socket.socket(socket.AF_INET, socket.SOCK_DGRAM) as sock:
+        sock.bind(("127.0.0.1", 0))
+        return sock.getsockname()[1]
+
+
+def run_udp(args, probes, sender_args):
+    """
+    Start the collector with UDP input, send the dataset and stop the collector.
+
+    :param probes: Enable latency probes of the dummy output
+    :param sender_args: Additional arguments of ipfixsend2
+    :return: Duration of sending in seconds and the output of the collector.
+    """
+    port = free_udp_port()
+    ipfix_path, _ = dataset_ipfix(args)
+    config = config_create(args, "udp-dummy.xml",
+        {"PORT": port, "PROBES": "true" if probes else "false"})
+
+    collector = subprocess.Popen(collector_cmd(args, config), stdout=subprocess.PIPE,
+        stderr=subprocess.PIPE)
+    try:
+        # Wait until the collector is listening
+        time.sleep(args.startup)
+        if collector.poll() is not None:
+            raise PerfError("Collector has failed: "
+                + collector.stderr.read().decode(errors="replace").strip())
+
+        cmd = [args.ipfixsend, "-i", ipfix_path, "-d", "127.0.0.1", "-p", str(port),
+            "-t", "UDP", "-c"] + sender_args
+        start = time.monotonic()
+        ret = subprocess.run(cmd, stdout=subprocess.DEVNULL, stderr=subprocess.PIPE,
+            timeout=args.timeout)
+        elapsed = time.monotonic() - start
+        if ret.returncode != 0:
+            raise PerfError("ipfixsend2 has failed: "
+                + ret.stderr.decode(errors="replace").strip())
+
+        # Let the collector process remaining messages
+        time.sleep(args.startup)
+        collector.send_signal(signal.SIGINT)
+        out, err = collector.communicate(timeout=args.timeout)
+    finally:
+        if collector.poll() is None:
+            collector.kill()
+            collector.wait()
+
+    if collector.returncode != 0:
+        raise PerfError("Collector has failed: " + err.decode(errors="replace").strip())
+    return elapsed, out.decode(errors="replace")
+
+
+def dummy_records(output):
+    """Get the number of Data Records from statistics of the dummy output."""
+    match = re.search(r"- data records:\s+(\d+)", output)
+    if not match:
+        raise PerfError("Statistics of the dummy output not found")
+    return int(match.group(1))
+
+
+def test_udp_dummy(args):
+    """UDP input -> parser -> dummy output (throughput at the maximum rate, latency at a fixed rate)."""
+    _, records = dataset_ipfix(args)
+
+    elapsed, output = run_udp(args, False, ["-n", str(args.loops)])
+    received = dummy_records(output)
+    sent = records * args.loops
+    result = {
+        "records_per_s": received / elapsed,
+        "loss": 1.0 - received / sent,
+    }
+
+    _, output = run_udp(args, True, ["-n", "1", "-S", str(args.udp_rate), "-L", "10"])
+    match = re.search(r"Latency \(total\):\s+\d+ probes, p50\s+([\d.]+) us, "
+        r"p90\s+[\d.]+ us, p99\s+([\d.]+) us", output)
+    if not match:
+        raise PerfError("Latency of probes not found in the output of the dummy output")
+    result["latency_p50_us"] = float(match.group(1))
+    result["latency_p99_us"] = float(match.group(2))
+    return result
+
+
+def test_ipfix_dummy(args):
+    """IPFIX File input -> parser -> dummy output."""
+    ipfix_path, records = dataset_ipfix(args)
+    pattern = links_create(args, [ipfix_path], "ipfix")
+    elapsed, output = run_collector(args, "ipfix-dummy.xml", {"PATH": pattern},
+        stdout=subprocess.PIPE)
+    if dummy_records(output.decode(errors="replace")) != records * args.loops:
+        raise PerfError("Unexpected number of processed Data Records")
+    return {"records_per_s": records * args.loops / elapsed}
+
+
+def test_fds_json(args):
+    """FDS File input -> parser -> JSON output (standard output)."""
+    fds_pattern, records = dataset_fds(args)
+    pattern = links_create(args, sorted(glob.glob(fds_pattern)), "fds")
+    elapsed, _ = run_collector(args, "fds-json.xml", {"PATH": pattern})
+    return {"records_per_s": records * args.loops / elapsed}
+
+
+def test_nf9(args):
+    """NetFlow v9 to IPFIX conversion (in-process, see ipfixcol2-bench)."""
+    ret = subprocess.run([args.bench, "-c", "nf9", "-j", "-n", str(args.messages),
+        "-r", str(DATASET_RECS)], stdout=subprocess.PIPE, stderr=subprocess.PIPE,
+        timeout=args.timeout)
+    if ret.returncode != 0:
+        raise PerfError("ipfixcol2-bench has failed: "
+            + ret.stderr.decode(errors="replace").strip())
+
+    result = json.loads(ret.stdout.decode().splitlines()[0])
+    return {
+        "records_per_s": result["records_per_s"],
+        "ns_per_record": result["ns_per_record"],
+    }
+
+
+def links_create(args, paths, name):
+    """
+    Create a directory with the files linked repeatedly (see --loops).
+
+    :return: Glob pattern matching the links.
+    """
+    directory = os.path.join(args.work_dir, "links-" + name)
+    os.makedirs(directory, exist_ok=True)
+    for old in glob.glob(os.path.join(directory, "*")):
+        os.remove(old)
+    for i in range(args.loops):
+        for j, path in enumerate(paths):
+            os.symlink(os.path.abspath(path),
+                os.path.join(directory, "{:04d}-{:02d}".format(i, j)))
+    return os.path.join(directory, "*")
+
+
+TESTS = {
+    "udp-dummy": test_udp_dummy,
+    "ipfix-dummy": test_ipfix_dummy,
+    "fds-json": test_fds_json,
+    "nf9": test_nf9,
+}
+
+
+def measure(args):
+    """
+    Run the test repeatedly and get the median of each metric.
+
+    :return: Dictionary with metrics.
+    """
+    runs = [TESTS[args.test](args) for _ in range(args.repeat)]
+    return {key: statistics.median(run[key] for run in runs) for key in runs[0]}
+
+
+def compare(args, result, baseline):
+    """
+    Compare results with the baseline.
+
+    :return: List of regressions (descriptions).
+    """
+    regressions = []
+
+    if result.get("loss", 0.0) > args.max_loss:
+        regressions.append("loss {:.2%} exceeds {:.2%}".format(result["loss"], args.max_loss))
+
+    for key, value in sorted(result.items()):
+        if key == "loss" or key not in baseline:
+            continue
+        base = baseline[key]
+        if key.startswith("latency_"):
+            threshold = args.latency_threshold
+        else:
+            threshold = args.threshold
+
+        if key in LOWER_IS_BETTER:
+            worse = value > base * (1.0 + threshold)
+        else:
+            worse = value < base * (1.0 - threshold)
+        if worse:
+            regressions.append("{} {:.6g} (baseline {:.6g}, threshold {:.0%})".format(
+                key, value, base, threshold))
+
+    return regressions
+
+
+def json_load(path):
+    """Load a JSON file (or an empty dictionary, if it doesn't exist)."""
+    try:
+        with open(path) as f:
+            return json.load(f)
+    except FileNotFoundError:
+        return {}
+
+
+def json_store(path, content):
+    """Store a JSON file atomically."""
+    tmp_path = path + ".tmp"
+    with open(tmp_path, "w") as f:
+        json.dump(content, f, indent=2, sort_keys=True)
+        f.write("\n")
+    os.rename(tmp_path, path)
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Performance regression tests of IPFIXcol2")
+    parser.add_argument("--test", required=True, choices=sorted(TESTS),
+        help="Test to run")
+    parser.add_argument("--collector", required=True, help="Path to ipfixcol2")
+    parser.add_argument("--ipfixsend", help="Path to ipfixsend2")
+    parser.add_argument("--bench", help="Path to ipfixcol2-bench")
+    parser.add_argument("--plugin", action="append", default=[],
+        help="Path to a plugin (can be used multiple times)")
+    parser.add_argument("--configs", required=True,
+        help="Directory with templates of startup configurations")
+    parser.add_argument("--work-dir", required=True,
+        help="Directory for datasets, temporary files and results")
+    parser.add_argument("--baseline", required=True, help="Baseline (JSON file)")
+    parser.add_argument("--update", action="store_true",
+        default=os.environ.get("PERF_UPDATE", "") not in ("", "0"),
+        help="Store results as the new baseline (also if PERF_UPDATE=1)")
+    parser.add_argument("--training", action="store_true",
+        default=os.environ.get("PERF_TRAINING", "") not in ("", "0"),
+        help="Training run of profile-guided optimization, i.e. run the test once and don't "
+            "compare or store results (also if PERF_TRAINING=1)")
+    parser.add_argument("--threshold", type=float, default=0.2,
+        help="Maximum relative regression of throughput (default: 0.2)")
+    parser.add_argument("--latency-threshold", type=float, default=0.5,
+        help="Maximum relative regression of latency (default: 0.5)")
+    parser.add_argument("--max-loss", type=float, default=0.01,
+        help="Maximum loss ratio of UDP tests (default: 0.01)")
+    parser.add_argument("--messages", type=int, default=20000,
+        help="Number of IPFIX Messages of the dataset (default: 20000)")
+    parser.add_argument("--loops", type=int, default=10,
+        help="How many times the dataset is processed by a run (default: 10)")
+    parser.add_argument("--repeat", type=int, default=3,
+        help="Number of runs, the median is compared (default: 3)")
+    parser.add_argument("--udp-rate", type=int, default=10000,
+        help="Rate of messages for UDP latency measurement (default: 10000)")
+    parser.add_argument("--startup", type=float, default=1.0,
+        help="Time to wait for the start of the collector in seconds (default: 1)")
+    parser.add_argument("--timeout", type=float, default=300.0,
+        help="Timeout of each process in seconds (default: 300)")
+    args = parser.parse_args()
+
+    os.makedirs(args.work_dir, exist_ok=True)
+    if args.training:
+        args.repeat = 1
+    try:
+        result = measure(args)
+    except (PerfError, subprocess.TimeoutExpired, OSError) as ex:
+        print("ERROR: {}".format(ex), file=sys.stderr)
+        return 1
+
+    host = platform.node()
+    print("{}: {}".format(args.test, json.dumps(result, sort_keys=True)))
+    if args.training:
+        # Results of instrumented binaries are meaningless
+        return 0
+
+    # All results of the last run (e.g. for archiving by CI)
+    results_path = os.path.join(args.work_dir, "results.json")
+    results = json_load(results_path)
+    results[args.test] = dict(result, host=host, time=int(time.time()))
+    json_store(results_path, results)
+
+    baselines = json_load(args.baseline)
+    baseline = baselines.get(args.test)
+    if args.update or baseline is None:
+        baselines[args.test] = dict(result, host=host)
+        json_store(args.baseline, baselines)
+        print("Baseline of '{}' has been stored to '{}'".format(args.test, args.baseline))
+        return 0
+
+    if baseline.get("host") != host:
+        print("WARNING: The baseline has been measured on a different host ({})".format(
+            baseline.get("host")))
+
+    regressions = compare(args, result, baseline)
+    for msg in regressions:
+        print("REGRESSION: {}".format(msg))
+    return 1 if regressions else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,233 @@
+#include <gtest/gtest.h>
+#include <thread>
+#include <vector>
+#include <cstdint>
+#include <cstring>
+
+#include <ipfixcol2.h>
+#include <unistd.h>
+
+int main(int argc, char **argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
+
+// Released buffers must be reused
+TEST(BufPool, reuse)
+{
+    void *buffer = ipx_utils_buf_alloc(1500);
+    ASSERT_NE(buffer, nullptr);
+    // The whole buffer must be writable
+    memset(buffer, 0xAB, 1500);
+    ipx_utils_buf_free(buffer);
+
+    // Another buffer of the same size class
+    void *again = ipx_utils_buf_alloc(1200);
+    EXPECT_EQ(again, buffer);
+    ipx_utils_buf_free(again);
+}
+
+// Buffers of the maximum size of an IPFIX Message must be supported
+TEST(BufPool, maxSize)
+{
+    void *buffer = ipx_utils_buf_alloc(UINT16_MAX);
+    ASSERT_NE(buffer, nullptr);
+    memset(buffer, 0xCD, UINT16_MAX);
+    ipx_utils_buf_free(buffer);
+
+    // Too large buffers are allocated by the system allocator
+    buffer = ipx_utils_buf_alloc(1U << 20);
+    ASSERT_NE(buffer, nullptr);
+    memset(buffer, 0xCD, 1U << 20);
+    ipx_utils_buf_free(buffer);
+}
+
+// Content must be preserved when a buffer is enlarged
+TEST(BufPool, realloc)
+{
+    uint8_t *buffer = (uint8_t *) ipx_utils_buf_realloc(nullptr, 10);
+    ASSERT_NE(buffer, nullptr);
+    for (unsigned int i = 0; i < 10; ++i) {
+        buffer[i] = (uint8_t) i;
+    }
+
+    buffer = (uint8_t *) ipx_utils_buf_realloc(buffer, 16);
+    ASSERT_NE(buffer, nullptr);
+    buffer = (uint8_t *) ipx_utils_buf_realloc(buffer, 40000);
+    ASSERT_NE(buffer, nullptr);
+    for (unsigned int i = 0; i < 10; ++i) {
+        EXPECT_EQ(buffer[i], (uint8_t) i);
+    }
+    memset(buffer, 0, 40000);
+    ipx_utils_buf_free(buffer);
+}
+
+// Memory allocated by malloc() and NULL must be also accepted
+TEST(BufPool, systemMemory)
+{
+    ipx_utils_buf_free(nullptr);
+
+    uint8_t *buffer = (uint8_t *) malloc(100);
+    ASSERT_NE(buffer, nullptr);
+    buffer[99] = 0x12;
+    buffer = (uint8_t *) ipx_utils_buf_realloc(buffer, 200);
+    ASSERT_NE(buffer, nullptr);
+    EXPECT_EQ(buffer[99], 0x12);
+    ipx_utils_buf_free(buffer);
+}
+
+// Buffers allocated by one thread and released by others (i.e. input -> output)
+TEST(BufPool, multiThread)
+{
+    constexpr unsigned int THREADS = 4;
+    constexpr unsigned int ROUNDS = 20000;
+
+    std::vector<std::thread> threads;
+    for (unsigned int t = 0; t < THREADS; ++t) {
+        threads.emplace_back([t]() {
+            std::vector<uint8_t *> buffers;
+            for (unsigned int i = 0; i < ROUNDS; ++i) {
+                size_t size = 64 + ((i * 131 + t) % 9000);
+                uint8_t *buffer = (uint8_t *) ipx_utils_buf_alloc(size);
+                ASSERT_NE(buffer, nullptr);
+                memset(buffer, (int) t, size);
+                buffers.push_back(buffer);
+
+                if (buffers.size() >= 32) {
+                    for (uint8_t *it : buffers) {
+                        ASSERT_EQ(it[0], (uint8_t) t);
+                        ipx_utils_buf_free(it);
+                    }
+                    buffers.clear();
+                }
+            }
+            for (uint8_t *it : buffers) {
+                ipx_utils_buf_free(it);
+            }
+        });
+    }
+
+    for (auto &it : threads) {
+        it.join();
+    }
+}
+
+// Buffers of a registered region must be returned to their owner
+TEST(BufPool, region)
+{
+    static uint8_t memory[4096];
+    std::vector<void *> released;
+    ipx_utils_buf_release_cb cb = [](void *ptr, void *arg) {
+        static_cast<std::vector<void *> *>(arg)->push_back(ptr);
+    };
+
+    EXPECT_EQ(ipx_utils_buf_region_add(nullptr, sizeof(memory), cb, &released), IPX_ERR_ARG);
+    EXPECT_EQ(ipx_utils_buf_region_add(memory, sizeof(memory), nullptr, &released), IPX_ERR_ARG);
+    ASSERT_EQ(ipx_utils_buf_region_add(memory, sizeof(memory), cb, &released), IPX_OK);
+
+    // Release
+    ipx_utils_buf_free(&memory[100]);
+    ASSERT_EQ(released.size(), 1U);
+    EXPECT_EQ(released[0], &memory[100]);
+
+    // Resize (the content must be moved into a new buffer, even close to the end of the region)
+    memory[4000] = 0xAB;
+    memory[4095] = 0xCD;
+    uint8_t *buffer = (uint8_t *) ipx_utils_buf_realloc(&memory[4000], 2000);
+    ASSERT_NE(buffer, nullptr);
+    ASSERT_EQ(released.size(), 2U);
+    EXPECT_EQ(released[1], &memory[4000]);
+    EXPECT_EQ(buffer[0], 0xAB);
+    EXPECT_EQ(buffer[95], 0xCD);
+    ipx_utils_buf_free(buffer);
+    EXPECT_EQ(released.size(), 2U);
+
+    // After removal, the region is not recognized anymore
+    ipx_utils_buf_region_remove(memory);
+    uint8_t *other = (uint8_t *) malloc(16);
+    ASSERT_NE(other, nullptr);
+    ipx_utils_buf_free(other);
+    EXPECT_EQ(released.size(), 2U);
+}
+
+// Chunks must be reused only after their owner and all their slices are released
+TEST(BufPool, chunks)
+{
+    constexpr size_t CHUNK_SIZE = 1024;
+    ipx_utils_chunks_t *chunks = ipx_utils_chunks_create(CHUNK_SIZE, 2);
+    ASSERT_NE(chunks, nullptr);
+
+    uint8_t *first = (uint8_t *) ipx_utils_chunks_take(chunks);
+    uint8_t *second = (uint8_t *) ipx_utils_chunks_take(chunks);
+    ASSERT_NE(first, nullptr);
+    ASSERT_NE(second, nullptr);
+    EXPECT_EQ(ipx_utils_chunks_take(chunks), nullptr);
+    memset(first, 0x12, CHUNK_SIZE);
+
+    // Slices are released by other threads
+    uint8_t *slice_a = (uint8_t *) ipx_utils_chunks_slice(chunks, &first[0]);
+    uint8_t *slice_b = (uint8_t *) ipx_utils_chunks_slice(chunks, &first[700]);
+    EXPECT_EQ(slice_b, &first[700]);
+    ipx_utils_buf_free(first);
+    std::thread([slice_a]() {ipx_utils_buf_free(slice_a);}).join();
+    EXPECT_EQ(ipx_utils_chunks_take(chunks), nullptr);
+
+    // A resized slice is moved out of the chunk
+    slice_b = (uint8_t *) ipx_utils_buf_realloc(slice_b, 2000);
+    ASSERT_NE(slice_b, nullptr);
+    EXPECT_EQ(slice_b[0], 0x12);
+    EXPECT_EQ(slice_b[323], 0x12);
+    EXPECT_EQ(ipx_utils_chunks_take(chunks), first);
+    ipx_utils_buf_free(slice_b);
+
+    // The memory is released after the last chunk in use
+    ipx_utils_chunks_destroy(chunks);
+    second[CHUNK_SIZE - 1] = 0x34;
+    ipx_utils_buf_free(second);
+    ipx_utils_buf_free(first);
+}
+
+// Slices of a mapped file are valid until the last one is released
+TEST(BufPool, fileMap)
+{
+    char path[] = "/tmp/ipx_fmap_XXXXXX";
+    int fd = mkstemp(path);
+    ASSERT_NE(fd, -1);
+    unlink(path);
+
+    std::vector<uint8_t> content(10000);
+    for (size_t i = 0; i < content.size(); ++i) {
+        content[i] = (uint8_t) i;
+    }
+    ASSERT_EQ(write(fd, content.data(), content.size()), (ssize_t) content.size());
+
+    size_t size = 0;
+    ipx_utils_fmap_t *map = ipx_utils_fmap_create(fd, &size);
+    close(fd);
+    ASSERT_NE(map, nullptr);
+    ASSERT_EQ(size, content.size());
+    const uint8_t *data = ipx_utils_fmap_data(map);
+    EXPECT_EQ(memcmp(data, content.data(), size), 0);
+
+    uint8_t *slice_a = (uint8_t *) ipx_utils_fmap_slice(map, &data[0]);
+    uint8_t *slice_b = (uint8_t *) ipx_utils_fmap_slice(map, &data[5000]);
+    ipx_utils_buf_free(slice_a);
+
+    // Modifications are private
+    slice_b[0] = 0xFF;
+    EXPECT_EQ(data[5000], 0xFF);
+
+    // The mapping is released by the last slice (in another thread)
+    ipx_utils_fmap_destroy(map);
+    EXPECT_EQ(slice_b[1], (uint8_t) 5001);
+    std::thread([slice_b]() {ipx_utils_buf_free(slice_b);}).join();
+
+    // Empty files cannot be mapped
+    char path_empty[] = "/tmp/ipx_fmap_XXXXXX";
+    fd = mkstemp(path_empty);
+    ASSERT_NE(fd, -1);
+    unlink(path_empty);
+    EXPECT_EQ(ipx_utils_fmap_create(fd, &size), nullptr);
+    close(fd);
+}
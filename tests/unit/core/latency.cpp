@@ -0,0 +1,143 @@
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+
+extern "C" {
+#include <core/latency.h>
+}
+
+int main(int argc, char **argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
+
+/** Create an empty histogram */
+static std::unique_ptr<ipx_latency_hist>
+hist_new()
+{
+    std::unique_ptr<ipx_latency_hist> hist(new ipx_latency_hist);
+    memset(hist.get(), 0, sizeof(*hist));
+    return hist;
+}
+
+// Small values have their own buckets, the rest is split into linear sub-buckets
+TEST(Latency, buckets)
+{
+    for (uint64_t i = 0; i < IPX_LATENCY_SUB_CNT; ++i) {
+        EXPECT_EQ(ipx_latency_bucket(i), i);
+    }
+
+    unsigned int prev = ipx_latency_bucket(0);
+    for (uint64_t value = 1; value < (1ULL << 20); value += 7) {
+        const unsigned int idx = ipx_latency_bucket(value);
+        EXPECT_GE(idx, prev);
+        prev = idx;
+    }
+
+    EXPECT_LT(ipx_latency_bucket(UINT64_MAX), IPX_LATENCY_BUCKETS);
+}
+
+// The highest value of the bucket is never lower and its relative error is bounded
+TEST(Latency, percentileAccuracy)
+{
+    const uint64_t values[] = {1, 15, 16, 17, 100, 1000, 12345, 999999, 123456789ULL,
+        (1ULL << 40) + 12345, UINT64_MAX};
+
+    for (uint64_t value : values) {
+        auto hist = hist_new();
+        ipx_latency_record(hist.get(), value);
+        ASSERT_EQ(hist->cnt, 1U);
+
+        const uint64_t result = ipx_latency_percentile(hist.get(), 50.0);
+        EXPECT_GE(result, value);
+        EXPECT_LE(result - value, value / IPX_LATENCY_SUB_CNT);
+    }
+}
+
+TEST(Latency, percentiles)
+{
+    auto hist = hist_new();
+    EXPECT_EQ(ipx_latency_percentile(hist.get(), 99.0), 0U);
+
+    // Values 1..1000
+    for (uint64_t i = 1; i <= 1000; ++i) {
+        ipx_latency_record(hist.get(), i);
+    }
+
+    const uint64_t p50 = ipx_latency_percentile(hist.get(), 50.0);
+    const uint64_t p99 = ipx_latency_percentile(hist.get(), 99.0);
+    const uint64_t max = ipx_latency_percentile(hist.get(), 100.0);
+    EXPECT_GE(p50, 500U);
+    EXPECT_LE(p50, 500U + 500U / IPX_LATENCY_SUB_CNT);
+    EXPECT_GE(p99, 990U);
+    EXPECT_LE(p99, 990U + 990U / IPX_LATENCY_SUB_CNT);
+    EXPECT_GE(max, 1000U);
+    EXPECT_LE(max, 1000U + 1000U / IPX_LATENCY_SUB_CNT);
+    EXPECT_EQ(ipx_latency_percentile(hist.get(), 0.0), 1U);
+
+    // Out of range percentiles are clamped
+    EXPECT_EQ(ipx_latency_percentile(hist.get(), 150.0), max);
+    EXPECT_EQ(ipx_latency_percentile(hist.get(), -1.0), 1U);
+}
+
+// Difference of snapshots contains only values recorded in the meantime
+TEST(Latency, snapshotSub)
+{
+    auto hist = hist_new();
+    auto prev = hist_new();
+    auto now = hist_new();
+
+    for (unsigned int i = 0; i < 100; ++i) {
+        ipx_latency_record(hist.get(), 10);
+    }
+    ipx_latency_snapshot(hist.get(), prev.get());
+    EXPECT_EQ(prev->cnt, 100U);
+
+    for (unsigned int i = 0; i < 10; ++i) {
+        ipx_latency_record(hist.get(), 1000000);
+    }
+    ipx_latency_snapshot(hist.get(), now.get());
+    EXPECT_EQ(now->cnt, 110U);
+
+    ipx_latency_sub(now.get(), prev.get());
+    EXPECT_EQ(now->cnt, 10U);
+    const uint64_t p = ipx_latency_percentile(now.get(), 1.0);
+    EXPECT_GE(p, 1000000U);
+    EXPECT_LE(p, 1000000U + 1000000U / IPX_LATENCY_SUB_CNT);
+}
+
+TEST(Latency, enable)
+{
+    EXPECT_FALSE(ipx_latency_enabled());
+    ipx_latency_enable(true);
+    EXPECT_TRUE(ipx_latency_enabled());
+    ipx_latency_enable(false);
+    EXPECT_FALSE(ipx_latency_enabled());
+
+    const uint64_t t1 = ipx_latency_now();
+    const uint64_t t2 = ipx_latency_now();
+    EXPECT_GE(t2, t1);
+}
+
+// Realtime timestamps are moved to the monotonic clock, the future is clamped to the present
+TEST(Latency, fromRealtime)
+{
+    struct timespec real;
+    ASSERT_EQ(clock_gettime(CLOCK_REALTIME, &real), 0);
+
+    struct timespec past = real;
+    past.tv_sec -= 2;
+    const uint64_t before = ipx_latency_now();
+    const uint64_t ts_past = ipx_latency_from_realtime(&past);
+    const uint64_t after = ipx_latency_now();
+    EXPECT_LE(ts_past, after - 2000000000ULL);
+    EXPECT_GE(ts_past + 2100000000ULL, before);
+
+    struct timespec future = real;
+    future.tv_sec += 60;
+    const uint64_t ts_future = ipx_latency_from_realtime(&future);
+    EXPECT_GE(ts_future, after);
+    EXPECT_LE(ts_future, ipx_latency_now());
+}
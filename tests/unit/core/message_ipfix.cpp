@@ -0,0 +1,660 @@
+#include <gtest/gtest.h>
+#include <arpa/inet.h>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+extern "C" {
+#include <core/context.h>
+#include <core/message_ipfix.h>
+}
+
+int main(int argc, char **argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
+
+/** Size of a record with an extension (a record ID) */
+static const size_t REC_SIZE = IPX_MSG_IPFIX_BASE_REC_SIZE + sizeof(uint32_t);
+
+/**
+ * Create an empty wrapper (without a raw message) with Data Sets of given sizes. The record
+ * data pointer, the record extension and the value of a column are set to the index of the
+ * record.
+ */
+static ipx_msg_ipfix_t *
+msg_create(const std::vector<uint32_t> &set_recs)
+{
+    ipx_msg_ipfix_t *msg = (ipx_msg_ipfix_t *) calloc(1, ipx_msg_ipfix_size(REC_DEF_CNT, REC_SIZE));
+    if (!msg) {
+        return nullptr;
+    }
+
+    msg->sets.cnt_alloc = SET_DEF_CNT;
+    msg->rec_info.cnt_alloc = REC_DEF_CNT;
+    msg->rec_info.rec_size = REC_SIZE;
+
+    uint32_t total = 0;
+    for (uint32_t cnt : set_recs) {
+        struct ipx_ipfix_set *set = ipx_msg_ipfix_add_set_ref(msg);
+        set->ptr = nullptr;
+        set->snap = nullptr;
+        set->drec_cnt = cnt;
+        for (uint32_t i = 0; i < cnt; ++i, ++total) {
+            struct ipx_ipfix_record *rec = ipx_msg_ipfix_add_drec_ref(&msg);
+            memset(&rec->rec, 0, sizeof(rec->rec));
+            rec->rec.data = (uint8_t *) (uintptr_t) total;
+            rec->ext_mask = 1;
+            memcpy(rec->ext, &total, sizeof(total));
+        }
+    }
+
+    uint32_t *column = (uint32_t *) malloc((total > 0 ? total : 1) * sizeof(uint32_t));
+    for (uint32_t i = 0; i < total; ++i) {
+        column[i] = i;
+    }
+    msg->ext_cols.data[0] = (uint8_t *) column;
+    msg->ext_cols.rows[0] = total;
+    msg->ext_cols.sizes[0] = sizeof(uint32_t);
+    return msg;
+}
+
+static void
+msg_destroy(ipx_msg_ipfix_t *msg)
+{
+    free(msg->sets.extended);
+    free(msg->ext_cols.data[0]);
+    free(msg);
+}
+
+// Only selected records (with their extensions) remain in the original order
+TEST(MsgIpfix, compact)
+{
+    ipx_msg_ipfix_t *msg = msg_create({3, 0, 4});
+    ASSERT_NE(msg, nullptr);
+    ASSERT_EQ(ipx_msg_ipfix_get_drec_cnt(msg), 7U);
+
+    const uint8_t keep[] = {1, 0, 1, 0, 0, 1, 1};
+    const std::vector<uint32_t> expected = {0, 2, 5, 6};
+    EXPECT_EQ(ipx_msg_ipfix_drec_compact(msg, keep), expected.size());
+    ASSERT_EQ(ipx_msg_ipfix_get_drec_cnt(msg), expected.size());
+
+    const uint32_t *column = (const uint32_t *) msg->ext_cols.data[0];
+    EXPECT_EQ(msg->ext_cols.rows[0], expected.size());
+    for (uint32_t i = 0; i < expected.size(); ++i) {
+        struct ipx_ipfix_record *rec = ipx_msg_ipfix_get_drec(msg, i);
+        uint32_t ext_value;
+        memcpy(&ext_value, rec->ext, sizeof(ext_value));
+
+        EXPECT_EQ((uintptr_t) rec->rec.data, expected[i]);
+        EXPECT_EQ(ext_value, expected[i]);
+        EXPECT_EQ(rec->ext_mask, 1U);
+        EXPECT_EQ(column[i], expected[i]);
+    }
+
+    struct ipx_ipfix_set *sets;
+    size_t set_cnt;
+    ipx_msg_ipfix_get_sets(msg, &sets, &set_cnt);
+    ASSERT_EQ(set_cnt, 3U);
+    EXPECT_EQ(sets[0].drec_cnt, 2U);
+    EXPECT_EQ(sets[1].drec_cnt, 0U);
+    EXPECT_EQ(sets[2].drec_cnt, 2U);
+    msg_destroy(msg);
+}
+
+// Removal of all or no records
+TEST(MsgIpfix, compactAllOrNothing)
+{
+    ipx_msg_ipfix_t *msg = msg_create({5});
+    ASSERT_NE(msg, nullptr);
+
+    const uint8_t keep_all[] = {1, 1, 1, 1, 1};
+    EXPECT_EQ(ipx_msg_ipfix_drec_compact(msg, keep_all), 5U);
+    for (uint32_t i = 0; i < 5; ++i) {
+        EXPECT_EQ((uintptr_t) ipx_msg_ipfix_get_drec(msg, i)->rec.data, i);
+    }
+
+    const uint8_t keep_none[] = {0, 0, 0, 0, 0};
+    EXPECT_EQ(ipx_msg_ipfix_drec_compact(msg, keep_none), 0U);
+    EXPECT_EQ(ipx_msg_ipfix_get_drec_cnt(msg), 0U);
+    EXPECT_EQ(ipx_msg_ipfix_get_drec(msg, 0), nullptr);
+
+    struct ipx_ipfix_set *sets;
+    size_t set_cnt;
+    ipx_msg_ipfix_get_sets(msg, &sets, &set_cnt);
+    ASSERT_EQ(set_cnt, 1U);
+    EXPECT_EQ(sets[0].drec_cnt, 0U);
+    msg_destroy(msg);
+}
+
+// The array of flags is reused and enlarged only when needed
+TEST(MsgIpfix, drecFlags)
+{
+    struct ipx_drec_flags flags = {nullptr, 0};
+    ipx_msg_ipfix_t *msg = msg_create({3, 4});
+    ASSERT_NE(msg, nullptr);
+
+    uint8_t *keep = ipx_msg_ipfix_drec_flags(msg, &flags);
+    ASSERT_NE(keep, nullptr);
+    EXPECT_GE(flags.alloc, 7U);
+    EXPECT_EQ(ipx_msg_ipfix_drec_flags(msg, &flags), keep);
+
+    const uint8_t expected[] = {0, 1, 0, 1, 0, 1, 0};
+    memcpy(keep, expected, sizeof(expected));
+    EXPECT_EQ(ipx_msg_ipfix_drec_compact(msg, keep), 3U);
+    msg_destroy(msg);
+
+    // A larger message
+    const uint32_t large = flags.alloc + 1;
+    msg = msg_create({large});
+    ASSERT_NE(msg, nullptr);
+    ASSERT_NE(ipx_msg_ipfix_drec_flags(msg, &flags), nullptr);
+    EXPECT_GE(flags.alloc, large);
+    memset(flags.data, 1, large);
+    EXPECT_EQ(ipx_msg_ipfix_drec_compact(msg, flags.data), large);
+    msg_destroy(msg);
+
+    ipx_msg_ipfix_drec_flags_free(&flags);
+    EXPECT_EQ(flags.data, nullptr);
+    EXPECT_EQ(flags.alloc, 0U);
+}
+
+// Information about Templates is found until the cache is cleared
+TEST(MsgIpfix, tcache)
+{
+    struct info {
+        uint32_t value;
+    };
+
+    ipx_tcache_t *cache = ipx_tcache_create(sizeof(info), 2);
+    ASSERT_NE(cache, nullptr);
+
+    const auto *t1 = reinterpret_cast<const struct fds_template *>(uintptr_t(0x10));
+    const auto *t2 = reinterpret_cast<const struct fds_template *>(uintptr_t(0x20));
+    const auto *t3 = reinterpret_cast<const struct fds_template *>(uintptr_t(0x30));
+    EXPECT_EQ(ipx_tcache_find(cache, t1), nullptr);
+
+    auto *i1 = static_cast<info *>(ipx_tcache_add(cache, t1));
+    ASSERT_NE(i1, nullptr);
+    EXPECT_EQ(i1->value, 0U);
+    i1->value = 1;
+    auto *i2 = static_cast<info *>(ipx_tcache_add(cache, t2));
+    ASSERT_NE(i2, nullptr);
+    i2->value = 2;
+
+    // The cache is full
+    EXPECT_EQ(ipx_tcache_add(cache, t3), nullptr);
+    EXPECT_EQ(static_cast<info *>(ipx_tcache_find(cache, t1))->value, 1U);
+    EXPECT_EQ(static_cast<info *>(ipx_tcache_find(cache, t2))->value, 2U);
+    EXPECT_EQ(ipx_tcache_find(cache, t3), nullptr);
+
+    // Records of removed Templates are zeroed when reused
+    ipx_tcache_clear(cache);
+    EXPECT_EQ(ipx_tcache_find(cache, t1), nullptr);
+    auto *i3 = static_cast<info *>(ipx_tcache_add(cache, t3));
+    ASSERT_NE(i3, nullptr);
+    EXPECT_EQ(i3->value, 0U);
+    EXPECT_EQ(ipx_tcache_find(cache, t3), i3);
+    ipx_tcache_destroy(cache);
+}
+
+// The unlimited cache grows
+TEST(MsgIpfix, tcacheUnlimited)
+{
+    ipx_tcache_t *cache = ipx_tcache_create(sizeof(uint32_t), 0);
+    ASSERT_NE(cache, nullptr);
+
+    for (uint32_t i = 1; i <= 100; ++i) {
+        const auto *tmplt = reinterpret_cast<const struct fds_template *>(uintptr_t(i));
+        auto *value = static_cast<uint32_t *>(ipx_tcache_add(cache, tmplt));
+        ASSERT_NE(value, nullptr);
+        *value = i;
+    }
+
+    for (uint32_t i = 1; i <= 100; ++i) {
+        const auto *tmplt = reinterpret_cast<const struct fds_template *>(uintptr_t(i));
+        auto *value = static_cast<uint32_t *>(ipx_tcache_find(cache, tmplt));
+        ASSERT_NE(value, nullptr);
+        EXPECT_EQ(*value, i);
+    }
+
+    ipx_tcache_destroy(cache);
+}
+
+/** Append a 16-bit value in network byte order */
+static void
+put16(std::vector<uint8_t> &buf, uint16_t value)
+{
+    buf.push_back(uint8_t(value >> 8));
+    buf.push_back(uint8_t(value & 0xFF));
+}
+
+/**
+ * Create a raw IPFIX Message with a Template Set (Template 256 with two 4-byte fields) and
+ * Data Sets of given IDs, each with \p recs records.
+ */
+static uint8_t *
+raw_create(const std::vector<uint16_t> &dset_ids, uint16_t recs)
+{
+    std::vector<uint8_t> buf(16, 0);
+    put16(buf, 2);                   // Template Set
+    put16(buf, 4 + 4 + 2 * 4);
+    put16(buf, 256);                 // Template ID
+    put16(buf, 2);                   // Field count
+    put16(buf, 8);  put16(buf, 4);   // sourceIPv4Address
+    put16(buf, 12); put16(buf, 4);   // destinationIPv4Address
+
+    for (uint16_t id : dset_ids) {
+        put16(buf, id);
+        put16(buf, 4 + recs * 8);
+        for (uint16_t i = 0; i < recs * 8; ++i) {
+            buf.push_back(uint8_t(i));
+        }
+    }
+
+    auto *hdr = reinterpret_cast<struct fds_ipfix_msg_hdr *>(buf.data());
+    hdr->version = htons(FDS_IPFIX_VERSION);
+    hdr->length = htons(uint16_t(buf.size()));
+
+    uint8_t *raw = static_cast<uint8_t *>(ipx_utils_buf_alloc(buf.size()));
+    memcpy(raw, buf.data(), buf.size());
+    return raw;
+}
+
+/** Template manager with a snapshot of the Template 256 (see raw_create()) */
+class MsgIpfixWrap : public ::testing::Test {
+protected:
+    ipx_ctx_t *ctx = nullptr;
+    fds_tmgr_t *tmgr = nullptr;
+    const fds_tsnapshot_t *snap = nullptr;
+    struct ipx_msg_ctx msg_ctx;
+
+    void SetUp() override {
+        ctx = ipx_ctx_create("wrap", nullptr);
+        tmgr = fds_tmgr_create(FDS_SESSION_FILE);
+        ASSERT_NE(ctx, nullptr);
+        ASSERT_NE(tmgr, nullptr);
+        ASSERT_EQ(fds_tmgr_set_time(tmgr, 0), FDS_OK);
+
+        uint8_t *raw = raw_create({}, 0);
+        uint16_t len = 4 + 2 * 4;
+        struct fds_template *tmplt;
+        ASSERT_EQ(fds_template_parse(FDS_TYPE_TEMPLATE, raw + 20, &len, &tmplt), FDS_OK);
+        ipx_utils_buf_free(raw);
+        ASSERT_EQ(fds_tmgr_template_add(tmgr, tmplt), FDS_OK);
+        ASSERT_EQ(fds_tmgr_snapshot_get(tmgr, &snap), FDS_OK);
+
+        memset(&msg_ctx, 0, sizeof(msg_ctx));
+        msg_ctx.odid = 1;
+    }
+
+    void TearDown() override {
+        fds_tmgr_destroy(tmgr);
+        ipx_ctx_destroy(ctx);
+    }
+};
+
+// Sets and Data Records of a raw message are described as by the parser
+TEST_F(MsgIpfixWrap, describe)
+{
+    uint8_t *raw = raw_create({256, 256}, 3);
+    ipx_msg_ipfix_t *msg = ipx_msg_ipfix_wrap(ctx, &msg_ctx, raw, snap);
+    ASSERT_NE(msg, nullptr);
+    EXPECT_EQ(ipx_msg_ipfix_get_packet(msg), raw);
+    EXPECT_EQ(ipx_msg_ipfix_get_ctx(msg)->odid, 1U);
+
+    struct ipx_ipfix_set *sets;
+    size_t set_cnt;
+    ipx_msg_ipfix_get_sets(msg, &sets, &set_cnt);
+    ASSERT_EQ(set_cnt, 3U);
+    EXPECT_EQ((uint8_t *) sets[0].ptr, raw + 16);
+    EXPECT_EQ(sets[0].snap, nullptr);
+    EXPECT_EQ(sets[0].drec_cnt, 0U);
+    for (size_t i = 1; i < 3; ++i) {
+        EXPECT_EQ(sets[i].snap, snap);
+        EXPECT_EQ(sets[i].drec_cnt, 3U);
+    }
+
+    ASSERT_EQ(ipx_msg_ipfix_get_drec_cnt(msg), 6U);
+    const uint8_t *dset = raw + 16 + 4 + 4 + 2 * 4;
+    for (uint32_t i = 0; i < 6; ++i) {
+        const struct fds_drec &rec = ipx_msg_ipfix_get_drec(msg, i)->rec;
+        const size_t set_offset = (i / 3) * (4 + 3 * 8) + 4;
+        EXPECT_EQ(rec.data, dset + set_offset + (i % 3) * 8);
+        EXPECT_EQ(rec.size, 8U);
+        ASSERT_NE(rec.tmplt, nullptr);
+        EXPECT_EQ(rec.tmplt->id, 256U);
+        EXPECT_EQ(rec.snap, snap);
+    }
+
+    ipx_msg_ipfix_destroy(msg);
+}
+
+// A Data Set of an unknown Template is refused and the raw message is kept
+TEST_F(MsgIpfixWrap, unknownTemplate)
+{
+    uint8_t *raw = raw_create({256, 300}, 2);
+    EXPECT_EQ(ipx_msg_ipfix_wrap(ctx, &msg_ctx, raw, snap), nullptr);
+    ipx_utils_buf_free(raw);
+}
+
+// A branch shares the raw packet and has its own description of Sets and Data Records
+TEST_F(MsgIpfixWrap, branchShared)
+{
+    uint8_t *raw = raw_create({256, 256}, 2);
+    ipx_msg_ipfix_t *msg = ipx_msg_ipfix_wrap(ctx, &msg_ctx, raw, snap);
+    ASSERT_NE(msg, nullptr);
+
+    ipx_msg_ipfix_t *branch = ipx_msg_ipfix_branch_create(msg, 3);
+    ASSERT_NE(branch, nullptr);
+    EXPECT_EQ(ipx_msg_ipfix_branch_get(msg), 0U);
+    EXPECT_EQ(ipx_msg_ipfix_branch_get(branch), 3U);
+    EXPECT_EQ(ipx_msg_ipfix_get_packet(branch), raw);
+    EXPECT_EQ(ipx_msg_ipfix_get_ctx(branch)->odid, 1U);
+    ASSERT_NE(msg->share, nullptr);
+    EXPECT_EQ(branch->share, msg->share);
+
+    ASSERT_EQ(ipx_msg_ipfix_get_drec_cnt(branch), 4U);
+    for (uint32_t i = 0; i < 4; ++i) {
+        EXPECT_EQ(ipx_msg_ipfix_get_drec(branch, i)->rec.data,
+            ipx_msg_ipfix_get_drec(msg, i)->rec.data);
+    }
+
+    // Removal of records of the branch doesn't affect the original message
+    const uint8_t keep[] = {0, 1, 0, 1};
+    EXPECT_EQ(ipx_msg_ipfix_drec_compact(branch, keep), 2U);
+    EXPECT_EQ(ipx_msg_ipfix_get_drec_cnt(msg), 4U);
+
+    ipx_msg_ipfix_destroy(branch);
+    EXPECT_EQ(ipx_msg_ipfix_get_drec(msg, 0)->rec.data, raw + 16 + 4 + 4 + 2 * 4 + 4);
+    ipx_msg_ipfix_destroy(msg);
+}
+
+// A writable branch gets a copy of the packet with rebased Sets and Data Records
+TEST_F(MsgIpfixWrap, branchWritable)
+{
+    uint8_t *raw = raw_create({256, 256}, 2);
+    const uint16_t raw_size = ntohs(reinterpret_cast<fds_ipfix_msg_hdr *>(raw)->length);
+    ipx_msg_ipfix_t *msg = ipx_msg_ipfix_wrap(ctx, &msg_ctx, raw, snap);
+    ASSERT_NE(msg, nullptr);
+    ipx_msg_ipfix_t *branch = ipx_msg_ipfix_branch_create(msg, 1);
+    ASSERT_NE(branch, nullptr);
+
+    // A record replaced by a plugin (i.e. outside of the packet) is left alone
+    uint8_t replaced[8] = {0};
+    ipx_msg_ipfix_get_drec(branch, 1)->rec.data = replaced;
+
+    ASSERT_EQ(ipx_msg_ipfix_writable(branch), IPX_OK);
+    uint8_t *copy = ipx_msg_ipfix_get_packet(branch);
+    ASSERT_NE(copy, raw);
+    EXPECT_EQ(memcmp(copy, raw, raw_size), 0);
+    EXPECT_EQ(branch->share, nullptr);
+    EXPECT_NE(msg->share, nullptr);
+
+    struct ipx_ipfix_set *sets, *sets_orig;
+    size_t set_cnt, set_cnt_orig;
+    ipx_msg_ipfix_get_sets(branch, &sets, &set_cnt);
+    ipx_msg_ipfix_get_sets(msg, &sets_orig, &set_cnt_orig);
+    ASSERT_EQ(set_cnt, set_cnt_orig);
+    for (size_t i = 0; i < set_cnt; ++i) {
+        EXPECT_EQ((uint8_t *) sets[i].ptr - copy, (uint8_t *) sets_orig[i].ptr - raw);
+    }
+
+    for (uint32_t i = 0; i < 4; ++i) {
+        const uint8_t *data = ipx_msg_ipfix_get_drec(branch, i)->rec.data;
+        const uint8_t *data_orig = ipx_msg_ipfix_get_drec(msg, i)->rec.data;
+        if (i == 1) {
+            EXPECT_EQ(data, replaced);
+        } else {
+            EXPECT_EQ(data - copy, data_orig - raw);
+        }
+    }
+
+    // Modifications are not visible in the original message
+    ipx_msg_ipfix_get_drec(branch, 0)->rec.data[0] ^= 0xFF;
+    EXPECT_NE(memcmp(copy, raw, raw_size), 0);
+
+    // The last reference -> the original message takes the ownership of the packet
+    ASSERT_EQ(ipx_msg_ipfix_writable(msg), IPX_OK);
+    EXPECT_EQ(ipx_msg_ipfix_get_packet(msg), raw);
+    EXPECT_EQ(msg->share, nullptr);
+    EXPECT_EQ(ipx_msg_ipfix_get_drec(msg, 0)->rec.data, raw + 16 + 4 + 4 + 2 * 4 + 4);
+
+    // Already writable messages are not copied again
+    ASSERT_EQ(ipx_msg_ipfix_writable(branch), IPX_OK);
+    EXPECT_EQ(ipx_msg_ipfix_get_packet(branch), copy);
+
+    ipx_msg_ipfix_destroy(msg);
+    ipx_msg_ipfix_destroy(branch);
+}
+
+// The shared packet is freed with the last branch, regardless of the order of destruction
+TEST_F(MsgIpfixWrap, branchDestroy)
+{
+    for (bool orig_first : {true, false}) {
+        uint8_t *raw = raw_create({256}, 1);
+        ipx_msg_ipfix_t *msg = ipx_msg_ipfix_wrap(ctx, &msg_ctx, raw, snap);
+        ASSERT_NE(msg, nullptr);
+        ipx_msg_ipfix_t *branch1 = ipx_msg_ipfix_branch_create(msg, 1);
+        ASSERT_NE(branch1, nullptr);
+        ipx_msg_ipfix_t *branch2 = ipx_msg_ipfix_branch_create(branch1, 2);
+        ASSERT_NE(branch2, nullptr);
+        EXPECT_EQ(branch2->share, msg->share);
+
+        ipx_msg_ipfix_t *first = orig_first ? msg : branch2;
+        ipx_msg_ipfix_t *last = orig_first ? branch2 : msg;
+        ipx_msg_ipfix_destroy(first);
+        ipx_msg_ipfix_destroy(branch1);
+
+        // The packet is still valid
+        auto *hdr = reinterpret_cast<fds_ipfix_msg_hdr *>(ipx_msg_ipfix_get_packet(last));
+        EXPECT_EQ(ntohs(hdr->version), FDS_IPFIX_VERSION);
+        EXPECT_EQ(ipx_msg_ipfix_get_drec(last, 0)->rec.data[0], 0U);
+        ipx_msg_ipfix_destroy(last);
+    }
+}
+
+/** Append a 32-bit value in network byte order */
+static void
+put32(std::vector<uint8_t> &buf, uint32_t value)
+{
+    put16(buf, uint16_t(value >> 16));
+    put16(buf, uint16_t(value & 0xFFFF));
+}
+
+/**
+ * Message with Data Sets of the Template 256 (2 records), 257 (2 records) and 256 (1 record).
+ * The Template 257 consists of destinationIPv4Address, interfaceName (variable-length) and
+ * sourceIPv4Address, i.e. the source address doesn't have a fixed offset. Source and
+ * destination addresses of the i-th record are (SRC_BASE + i) and (DST_BASE + i).
+ */
+class MsgIpfixColumn : public MsgIpfixWrap {
+protected:
+    static const uint32_t SRC_BASE = 0x0A000000;
+    static const uint32_t DST_BASE = 0xC0000000;
+    ipx_msg_ipfix_t *msg = nullptr;
+
+    void SetUp() override {
+        MsgIpfixWrap::SetUp();
+
+        std::vector<uint8_t> tmplt;
+        put16(tmplt, 257);               // Template ID
+        put16(tmplt, 3);                 // Field count
+        put16(tmplt, 12); put16(tmplt, 4);     // destinationIPv4Address
+        put16(tmplt, 82); put16(tmplt, 65535); // interfaceName
+        put16(tmplt, 8);  put16(tmplt, 4);     // sourceIPv4Address
+
+        uint16_t len = uint16_t(tmplt.size());
+        struct fds_template *tmplt_parsed;
+        ASSERT_EQ(fds_template_parse(FDS_TYPE_TEMPLATE, tmplt.data(), &len, &tmplt_parsed),
+            FDS_OK);
+        ASSERT_EQ(fds_tmgr_template_add(tmgr, tmplt_parsed), FDS_OK);
+        ASSERT_EQ(fds_tmgr_snapshot_get(tmgr, &snap), FDS_OK);
+
+        std::vector<uint8_t> buf(16, 0);
+        uint32_t rec_id = 0;
+        for (const auto &dset : std::vector<std::pair<uint16_t, uint16_t>>{{256, 2}, {257, 2},
+                {256, 1}}) {
+            const size_t set_start = buf.size();
+            put16(buf, dset.first);
+            put16(buf, 0);
+            for (uint16_t i = 0; i < dset.second; ++i, ++rec_id) {
+                if (dset.first == 256) {
+                    put32(buf, SRC_BASE + rec_id);
+                    put32(buf, DST_BASE + rec_id);
+                    continue;
+                }
+
+                put32(buf, DST_BASE + rec_id);
+                buf.push_back(4);
+                buf.insert(buf.end(), {'e', 't', 'h', uint8_t('0' + rec_id)});
+                put32(buf, SRC_BASE + rec_id);
+            }
+
+            const uint16_t set_len = htons(uint16_t(buf.size() - set_start));
+            memcpy(&buf[set_start + 2], &set_len, sizeof(set_len));
+        }
+
+        auto *hdr = reinterpret_cast<struct fds_ipfix_msg_hdr *>(buf.data());
+        hdr->version = htons(FDS_IPFIX_VERSION);
+        hdr->length = htons(uint16_t(buf.size()));
+
+        uint8_t *raw = static_cast<uint8_t *>(ipx_utils_buf_alloc(buf.size()));
+        memcpy(raw, buf.data(), buf.size());
+        msg = ipx_msg_ipfix_wrap(ctx, &msg_ctx, raw, snap);
+        ASSERT_NE(msg, nullptr);
+        ASSERT_EQ(ipx_msg_ipfix_get_drec_cnt(msg), 5U);
+    }
+
+    void TearDown() override {
+        if (msg != nullptr) {
+            ipx_msg_ipfix_destroy(msg);
+        }
+        MsgIpfixWrap::TearDown();
+    }
+
+    /** Get a 32-bit value in network byte order */
+    static uint32_t
+    get32(const uint8_t *data)
+    {
+        uint32_t value;
+        memcpy(&value, data, sizeof(value));
+        return ntohl(value);
+    }
+};
+
+// Runs end at a change of the Template and the cached position of the field is updated
+TEST_F(MsgIpfixColumn, viewRuns)
+{
+    struct ipx_ipfix_column col;
+    memset(&col, 0, sizeof(col));
+
+    ASSERT_EQ(ipx_msg_ipfix_column_view(msg, 0, 0, 12, &col), IPX_OK);
+    EXPECT_EQ(col.cnt, 2U);
+    EXPECT_EQ(col.stride, 8U);
+    EXPECT_EQ(col.size, 4U);
+    for (uint32_t i = 0; i < col.cnt; ++i) {
+        EXPECT_EQ(get32(col.data + i * col.stride), DST_BASE + i);
+    }
+
+    // Records of the Template 257 have the same size, so they form a run too
+    ASSERT_EQ(ipx_msg_ipfix_column_view(msg, 2, 0, 12, &col), IPX_OK);
+    EXPECT_EQ(col.cnt, 2U);
+    EXPECT_EQ(col.stride, 4U + 1U + 4U + 4U);
+    for (uint32_t i = 0; i < col.cnt; ++i) {
+        EXPECT_EQ(get32(col.data + i * col.stride), DST_BASE + 2 + i);
+    }
+
+    // The last Data Set (the same Template as the first one, but not adjacent)
+    ASSERT_EQ(ipx_msg_ipfix_column_view(msg, 4, 0, 12, &col), IPX_OK);
+    EXPECT_EQ(col.cnt, 1U);
+    EXPECT_EQ(col.stride, 8U);
+    EXPECT_EQ(get32(col.data), DST_BASE + 4);
+
+    // A run can start in the middle of a Data Set
+    ASSERT_EQ(ipx_msg_ipfix_column_view(msg, 1, 0, 8, &col), IPX_OK);
+    EXPECT_EQ(col.cnt, 1U);
+    EXPECT_EQ(get32(col.data), SRC_BASE + 1);
+
+    EXPECT_EQ(ipx_msg_ipfix_column_view(msg, 5, 0, 8, &col), IPX_ERR_ARG);
+}
+
+// Fields without a fixed offset and missing fields are not available in a view
+TEST_F(MsgIpfixColumn, viewNotFound)
+{
+    struct ipx_ipfix_column col;
+    memset(&col, 0, sizeof(col));
+
+    // The field follows a variable-length field
+    EXPECT_EQ(ipx_msg_ipfix_column_view(msg, 2, 0, 8, &col), IPX_ERR_NOTFOUND);
+    EXPECT_EQ(col.cnt, 2U);
+    EXPECT_EQ(col.data, nullptr);
+
+    // The variable-length field itself
+    EXPECT_EQ(ipx_msg_ipfix_column_view(msg, 2, 0, 82, &col), IPX_ERR_NOTFOUND);
+    EXPECT_EQ(col.cnt, 2U);
+
+    // The field is not present in the Template
+    EXPECT_EQ(ipx_msg_ipfix_column_view(msg, 0, 0, 82, &col), IPX_ERR_NOTFOUND);
+    EXPECT_EQ(col.cnt, 2U);
+    EXPECT_EQ(col.data, nullptr);
+    EXPECT_EQ(ipx_msg_ipfix_column_view(msg, 0, 10, 12, &col), IPX_ERR_NOTFOUND);
+}
+
+// Values of fields with fixed and variable offsets are gathered in the order of records
+TEST_F(MsgIpfixColumn, gather)
+{
+    uint32_t values[5];
+    uint8_t present[5];
+    EXPECT_EQ(ipx_msg_ipfix_column_gather(msg, 0, 5, 0, 8, 4, values, present), 5U);
+    for (uint32_t i = 0; i < 5; ++i) {
+        EXPECT_EQ(ntohl(values[i]), SRC_BASE + i);
+        EXPECT_EQ(present[i], 1U);
+    }
+
+    // Records out of range are ignored
+    memset(values, 0xFF, sizeof(values));
+    EXPECT_EQ(ipx_msg_ipfix_column_gather(msg, 3, 10, 0, 12, 4, values, nullptr), 2U);
+    EXPECT_EQ(ntohl(values[0]), DST_BASE + 3);
+    EXPECT_EQ(ntohl(values[1]), DST_BASE + 4);
+    EXPECT_EQ(values[2], 0xFFFFFFFFU);
+    EXPECT_EQ(ipx_msg_ipfix_column_gather(msg, 5, 1, 0, 12, 4, values, nullptr), 0U);
+}
+
+// Missing fields and fields of a different size are zeroed
+TEST_F(MsgIpfixColumn, gatherMissing)
+{
+    uint32_t values[5];
+    uint8_t present[5];
+
+    // The variable-length field is present only in records of the Template 257
+    memset(values, 0xFF, sizeof(values));
+    EXPECT_EQ(ipx_msg_ipfix_column_gather(msg, 0, 5, 0, 82, 4, values, present), 2U);
+    const uint8_t expected[] = {0, 0, 1, 1, 0};
+    for (uint32_t i = 0; i < 5; ++i) {
+        EXPECT_EQ(present[i], expected[i]);
+        if (expected[i]) {
+            EXPECT_EQ(memcmp(&values[i], "eth", 3), 0);
+        } else {
+            EXPECT_EQ(values[i], 0U);
+        }
+    }
+
+    // Not present at all
+    memset(values, 0xFF, sizeof(values));
+    EXPECT_EQ(ipx_msg_ipfix_column_gather(msg, 0, 5, 0, 1, 4, values, present), 0U);
+    for (uint32_t i = 0; i < 5; ++i) {
+        EXPECT_EQ(values[i], 0U);
+        EXPECT_EQ(present[i], 0U);
+    }
+
+    // Different size
+    uint16_t short_values[5];
+    EXPECT_EQ(ipx_msg_ipfix_column_gather(msg, 0, 5, 0, 8, 2, short_values, present), 0U);
+    for (uint32_t i = 0; i < 5; ++i) {
+        EXPECT_EQ(short_values[i], 0U);
+        EXPECT_EQ(present[i], 0U);
+    }
+}
@@ -0,0 +1,143 @@
+#include <gtest/gtest.h>
+#include <thread>
+#include <vector>
+#include <cstdint>
+
+extern "C" {
+#include <core/message_pool.h>
+#include <core/message_ipfix.h>
+}
+
+int main(int argc, char **argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
+
+static constexpr size_t HDR_SIZE = 128;
+static constexpr size_t REC_SIZE = 64;
+
+// Returned blocks must be reused by the owner
+TEST(MsgPool, reuse)
+{
+    ipx_msg_pool_t *pool = ipx_msg_pool_create(HDR_SIZE, REC_SIZE, IPX_MSG_POOL_FIXED);
+    ASSERT_NE(pool, nullptr);
+
+    uint32_t cap = 0;
+    void *block = ipx_msg_pool_alloc(pool, &cap);
+    ASSERT_NE(block, nullptr);
+    EXPECT_EQ(cap, uint32_t(REC_DEF_CNT));
+    // The whole block must be writable
+    memset(block, 0xAB, HDR_SIZE + cap * REC_SIZE);
+
+    ipx_msg_pool_free(pool, block, cap, 10);
+    void *again = ipx_msg_pool_alloc(pool, &cap);
+    EXPECT_EQ(again, block);
+    EXPECT_EQ(cap, uint32_t(REC_DEF_CNT));
+
+    ipx_msg_pool_free(pool, again, cap, 10);
+    ipx_msg_pool_release(pool);
+}
+
+// Blocks enlarged by realloc() are returned into a larger size class or freed
+TEST(MsgPool, reallocated)
+{
+    ipx_msg_pool_t *pool = ipx_msg_pool_create(HDR_SIZE, REC_SIZE, IPX_MSG_POOL_FIXED);
+    ASSERT_NE(pool, nullptr);
+
+    uint32_t cap = 0;
+    void *block = ipx_msg_pool_alloc(pool, &cap);
+    ASSERT_NE(block, nullptr);
+    uint32_t cap_new = 2 * cap;
+    block = realloc(block, HDR_SIZE + cap_new * REC_SIZE);
+    ASSERT_NE(block, nullptr);
+    ipx_msg_pool_free(pool, block, cap_new, cap_new);
+
+    // A capacity that doesn't match any class
+    block = ipx_msg_pool_alloc(pool, &cap);
+    ASSERT_NE(block, nullptr);
+    block = realloc(block, HDR_SIZE + (cap + 1) * REC_SIZE);
+    ASSERT_NE(block, nullptr);
+    ipx_msg_pool_free(pool, block, cap + 1, cap + 1);
+
+    ipx_msg_pool_release(pool);
+}
+
+// The pool must stay valid until all blocks are returned
+TEST(MsgPool, releaseBeforeReturn)
+{
+    ipx_msg_pool_t *pool = ipx_msg_pool_create(HDR_SIZE, REC_SIZE, IPX_MSG_POOL_FIXED);
+    ASSERT_NE(pool, nullptr);
+
+    std::vector<std::pair<void *, uint32_t>> blocks;
+    for (int i = 0; i < 16; ++i) {
+        uint32_t cap;
+        void *block = ipx_msg_pool_alloc(pool, &cap);
+        ASSERT_NE(block, nullptr);
+        blocks.emplace_back(block, cap);
+    }
+
+    ipx_msg_pool_release(pool);
+    for (auto &it : blocks) {
+        ipx_msg_pool_free(pool, it.first, it.second, 0);
+    }
+}
+
+// In the adaptive mode, the capacity follows the observed number of records
+TEST(MsgPool, adaptive)
+{
+    ipx_msg_pool_t *pool = ipx_msg_pool_create(HDR_SIZE, REC_SIZE, IPX_MSG_POOL_ADAPTIVE);
+    ASSERT_NE(pool, nullptr);
+
+    const uint32_t observed = 3 * REC_DEF_CNT;
+    uint32_t cap = 0;
+    for (int i = 0; i < 100; ++i) {
+        void *block = ipx_msg_pool_alloc(pool, &cap);
+        ASSERT_NE(block, nullptr);
+        ipx_msg_pool_free(pool, block, cap, observed);
+    }
+
+    void *block = ipx_msg_pool_alloc(pool, &cap);
+    ASSERT_NE(block, nullptr);
+    EXPECT_GE(cap, observed);
+    EXPECT_LT(cap, 2 * observed);
+    ipx_msg_pool_free(pool, block, cap, observed);
+    ipx_msg_pool_release(pool);
+}
+
+// Blocks returned by multiple threads must be safely collected by the owner
+TEST(MsgPool, multiThreadReturn)
+{
+    constexpr int thread_cnt = 4;
+    constexpr int block_cnt = 20000;
+    ipx_msg_pool_t *pool = ipx_msg_pool_create(HDR_SIZE, REC_SIZE, IPX_MSG_POOL_FIXED);
+    ASSERT_NE(pool, nullptr);
+
+    std::vector<std::thread> threads;
+    std::vector<std::vector<void *>> blocks(thread_cnt);
+    uint32_t cap = 0;
+    for (int round = 0; round < 4; ++round) {
+        for (auto &vec : blocks) {
+            vec.clear();
+            for (int i = 0; i < block_cnt / thread_cnt; ++i) {
+                void *block = ipx_msg_pool_alloc(pool, &cap);
+                ASSERT_NE(block, nullptr);
+                vec.push_back(block);
+            }
+        }
+
+        for (auto &vec : blocks) {
+            threads.emplace_back([pool, cap, &vec]() {
+                for (void *block : vec) {
+                    ipx_msg_pool_free(pool, block, cap, 1);
+                }
+            });
+        }
+        for (auto &thread : threads) {
+            thread.join();
+        }
+        threads.clear();
+    }
+
+    ipx_msg_pool_release(pool);
+}
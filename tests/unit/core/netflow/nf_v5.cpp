@@ -1,6 +1,8 @@
 #include <arpa/inet.h>
 #include <gtest/gtest.h>
 #include <memory>
+#include <vector>
+#include <cstring>
 
 #include <ipfixcol2.h>
 #include <libfds/ipfix_parsers.h>
@@ -620,6 +622,49 @@ TEST_F(MsgBase, multipleRecordsPerMessage)
     EXPECT_EQ(fds_sets_iter_next(&it_sets), FDS_EOC);
 }
 
+// Conversion using SIMD instructions (if supported) and the portable version must be the same
+TEST_F(MsgBase, simdConversion)
+{
+    uint8_t *msg_data = nullptr;
+    uint16_t msg_size = 0;
+    struct ipx_msg_ctx msg_ctx = {m_session.get(), 0, 0};
+
+    // Records with different timestamps (also before the start of the exporter) and values
+    struct msg_data_hdr HDR_DATA;
+    HDR_DATA.sampling_int = (0x1 << 14) | 0x3FF;
+    msg_create(&msg_data, &msg_size, HDR_DATA);
+    for (uint32_t i = 0; i < 30; ++i) {
+        struct msg_data_rec rec_data;
+        rec_data.ts_first = i * 1000U;
+        rec_data.ts_last = UINT32_MAX - i;
+        rec_data.delta_pkts = i;
+        rec_data.port_src = static_cast<uint16_t>(1024U + i);
+        rec_data.mask_dst = static_cast<uint8_t>(i);
+        msg_rec_add(&msg_data, &msg_size, rec_data);
+    }
+
+    std::vector<uint8_t> converted[2];
+    for (bool simd : {false, true}) {
+        SCOPED_TRACE(std::string("SIMD: ") + (simd ? "enabled" : "disabled"));
+        converter_create();
+        ipx_nf5_conv_simd(m_conv.get(), simd);
+
+        uint8_t *copy = static_cast<uint8_t *>(malloc(msg_size));
+        ASSERT_NE(copy, nullptr);
+        memcpy(copy, msg_data, msg_size);
+        prepare_msg(&msg_ctx, copy, msg_size);
+        ASSERT_EQ(ipx_nf5_conv_process(m_conv.get(), m_msg.get()), IPX_OK);
+
+        uint8_t *ipx_data = ipx_msg_ipfix_get_packet(m_msg.get());
+        auto ipx_hdr = reinterpret_cast<fds_ipfix_msg_hdr *>(ipx_data);
+        converted[simd].assign(ipx_data, ipx_data + ntohs(ipx_hdr->length));
+    }
+    free(msg_data);
+
+    ASSERT_FALSE(converted[0].empty());
+    EXPECT_EQ(converted[0], converted[1]);
+}
+
 // Automatic Template refresh
 TEST_F(MsgBase, templateRefresh)                    // - 4 packets (3. with the same timestamp as 2.)
 {
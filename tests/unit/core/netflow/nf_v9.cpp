@@ -827,6 +827,144 @@ TEST_F(MsgBase, oneTemplateOneDataRecord)
     }
 }
 
+// Conversion of multiple Data Records in the same Data FlowSet
+TEST_F(MsgBase, manyDataRecords)
+{
+    const uint32_t VALUE_EXPORT = 1562857357U; // 2019-07-11T15:02:37+00:00
+    const uint32_t VALUE_UPTIME = 10001;
+    const uint32_t VALUE_ODID = 10;
+    const unsigned int REC_CNT = 100;
+    struct ipx_msg_ctx msg_ctx = {m_session.get(), VALUE_ODID, 0};
+
+    // Records without timestamps are just copied, others must be converted
+    uint16_t tid = IPX_NF9_SET_MIN_DSET;
+    Rec_norm_basic r_basic(tid);
+    Rec_norm_multi r_multi(tid);
+    Rec_norm_nots r_nots(tid);
+    Rec_norm_onlyts r_onlyts(tid);
+
+    int i = 0;
+    for (Rec_base *rec_ptr : {
+            dynamic_cast<Rec_base *>(&r_basic),
+            dynamic_cast<Rec_base *>(&r_multi),
+            dynamic_cast<Rec_base *>(&r_nots),
+            dynamic_cast<Rec_base *>(&r_onlyts)}) {
+        SCOPED_TRACE("Record index: " + std::to_string(i++));
+
+        nf9_set nf9_tset(IPX_NF9_SET_TMPLT);
+        nf9_tset.add_rec(rec_ptr->get_nf9_template());
+        nf9_set nf9_dset(tid);
+        for (unsigned int cnt = 0; cnt < REC_CNT; ++cnt) {
+            nf9_dset.add_rec(rec_ptr->get_nf9_record());
+        }
+        nf9_dset.add_padding(1);
+        nf9_msg nf9;
+        nf9.set_odid(VALUE_ODID);
+        nf9.set_time_unix(VALUE_EXPORT);
+        nf9.set_time_uptime(VALUE_UPTIME);
+        nf9.add_set(nf9_tset);
+        nf9.add_set(nf9_dset);
+
+        converter_create(IPX_VERB_DEBUG);
+        uint16_t msg_size = nf9.size();
+        uint8_t *msg_data = (uint8_t *) nf9.release();
+        prepare_msg(&msg_ctx, msg_data, msg_size);
+        ASSERT_EQ(ipx_nf9_conv_process(m_conv.get(), m_msg.get()), IPX_OK);
+
+        msg_data = ipx_msg_ipfix_get_packet(m_msg.get());
+        auto *ipfix_hdr = reinterpret_cast<struct fds_ipfix_msg_hdr*>(msg_data);
+        struct fds_sets_iter it_set;
+        fds_sets_iter_init(&it_set, ipfix_hdr);
+
+        // Template Set
+        ASSERT_EQ(fds_sets_iter_next(&it_set), FDS_OK);
+        ASSERT_EQ(ntohs(it_set.set->flowset_id), FDS_IPFIX_SET_TMPLT);
+        fds_tset_iter it_tset;
+        fds_tset_iter_init(&it_tset, it_set.set);
+        ASSERT_EQ(fds_tset_iter_next(&it_tset), FDS_OK);
+        auto tmplt = parse_template(it_tset, FDS_TYPE_TEMPLATE);
+        rec_ptr->compare_template(tmplt.get());
+
+        // Data Set with all records (padding is not copied)
+        ASSERT_EQ(fds_sets_iter_next(&it_set), FDS_OK);
+        ASSERT_EQ(ntohs(it_set.set->flowset_id), tid);
+        EXPECT_EQ(ntohs(it_set.set->length), FDS_IPFIX_SET_HDR_LEN + REC_CNT * tmplt->data_length);
+        struct fds_dset_iter it_dset;
+        fds_dset_iter_init(&it_dset, it_set.set, tmplt.get());
+        for (unsigned int cnt = 0; cnt < REC_CNT; ++cnt) {
+            SCOPED_TRACE("Data Record: " + std::to_string(cnt));
+            ASSERT_EQ(fds_dset_iter_next(&it_dset), FDS_OK);
+            struct fds_drec drec = {it_dset.rec, it_dset.size, tmplt.get(), nullptr};
+            rec_ptr->compare_data(&drec, VALUE_EXPORT, VALUE_UPTIME);
+        }
+
+        EXPECT_EQ(fds_dset_iter_next(&it_dset), FDS_EOC);
+        EXPECT_EQ(fds_sets_iter_next(&it_set), FDS_EOC);
+    }
+}
+
+// Convert messages of different sizes by the same converter (the buffer is reserved in advance)
+TEST_F(MsgBase, varyingMessageSizes)
+{
+    const uint32_t VALUE_EXPORT = 1562857357U; // 2019-07-11T15:02:37+00:00
+    const uint32_t VALUE_UPTIME = 10001;
+    const uint32_t VALUE_ODID = 10;
+    struct ipx_msg_ctx msg_ctx = {m_session.get(), VALUE_ODID, 0};
+
+    // Size of converted records is doubled
+    uint16_t tid = IPX_NF9_SET_MIN_DSET;
+    Rec_norm_onlyts rec(tid);
+    converter_create(IPX_VERB_DEBUG);
+
+    for (unsigned int i = 0; i < 200; ++i) {
+        SCOPED_TRACE("Message index: " + std::to_string(i));
+        const unsigned int rec_cnt = (i % 3 == 0) ? 150 : 1;
+
+        nf9_set nf9_tset(IPX_NF9_SET_TMPLT);
+        nf9_tset.add_rec(rec.get_nf9_template());
+        nf9_set nf9_dset(tid);
+        for (unsigned int cnt = 0; cnt < rec_cnt; ++cnt) {
+            nf9_dset.add_rec(rec.get_nf9_record());
+        }
+        nf9_msg nf9;
+        nf9.set_odid(VALUE_ODID);
+        nf9.set_seq(i);
+        nf9.set_time_unix(VALUE_EXPORT);
+        nf9.set_time_uptime(VALUE_UPTIME);
+        nf9.add_set(nf9_tset);
+        nf9.add_set(nf9_dset);
+
+        uint16_t msg_size = nf9.size();
+        uint8_t *msg_data = (uint8_t *) nf9.release();
+        prepare_msg(&msg_ctx, msg_data, msg_size);
+        ASSERT_EQ(ipx_nf9_conv_process(m_conv.get(), m_msg.get()), IPX_OK);
+
+        msg_data = ipx_msg_ipfix_get_packet(m_msg.get());
+        auto *ipfix_hdr = reinterpret_cast<struct fds_ipfix_msg_hdr*>(msg_data);
+        struct fds_sets_iter it_set;
+        fds_sets_iter_init(&it_set, ipfix_hdr);
+
+        ASSERT_EQ(fds_sets_iter_next(&it_set), FDS_OK);
+        fds_tset_iter it_tset;
+        fds_tset_iter_init(&it_tset, it_set.set);
+        ASSERT_EQ(fds_tset_iter_next(&it_tset), FDS_OK);
+        auto tmplt = parse_template(it_tset, FDS_TYPE_TEMPLATE);
+
+        ASSERT_EQ(fds_sets_iter_next(&it_set), FDS_OK);
+        EXPECT_EQ(ntohs(it_set.set->length), FDS_IPFIX_SET_HDR_LEN + rec_cnt * tmplt->data_length);
+        struct fds_dset_iter it_dset;
+        fds_dset_iter_init(&it_dset, it_set.set, tmplt.get());
+        for (unsigned int cnt = 0; cnt < rec_cnt; ++cnt) {
+            ASSERT_EQ(fds_dset_iter_next(&it_dset), FDS_OK);
+            struct fds_drec drec = {it_dset.rec, it_dset.size, tmplt.get(), nullptr};
+            rec.compare_data(&drec, VALUE_EXPORT, VALUE_UPTIME);
+        }
+
+        EXPECT_EQ(fds_dset_iter_next(&it_dset), FDS_EOC);
+        EXPECT_EQ(fds_sets_iter_next(&it_set), FDS_EOC);
+    }
+}
+
 // Try to convert NetFlow message with a single Options Template and single Data Record
 TEST_F(MsgBase, oneOptionsTemplateOneDataRecord)
 {
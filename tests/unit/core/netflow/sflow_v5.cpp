@@ -0,0 +1,482 @@
+#include <arpa/inet.h>
+#include <gtest/gtest.h>
+#include <memory>
+#include <vector>
+#include <cstring>
+#include <ctime>
+
+#include <ipfixcol2.h>
+#include <libfds/ipfix_parsers.h>
+
+extern "C" {
+#include <core/netflow2ipfix/netflow2ipfix.h>
+#include <core/netflow2ipfix/netflow_structs.h>
+#include <core/context.h>
+}
+
+// Number of fields in each sFlow Template
+constexpr size_t SFLOW_FIELD_CNT = 18U;
+
+class ThrowListener : public testing::EmptyTestEventListener {
+    void OnTestPartResult(const testing::TestPartResult& result) override {
+        if (result.type() == testing::TestPartResult::kFatalFailure) {
+            throw testing::AssertionException(result);
+        }
+    }
+};
+
+int main(int argc, char **argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    ::testing::UnitTest::GetInstance()->listeners().Append(new ThrowListener);
+    return RUN_ALL_TESTS();
+}
+
+/// Generator of XDR encoded sFlow v5 Datagrams
+class sflow_msg {
+public:
+    /**
+     * @brief Create a Datagram header (with an IPv4 agent address)
+     * @param[in] sub_agent Sub-agent ID
+     * @param[in] seq       Sequence number
+     */
+    sflow_msg(uint32_t sub_agent = 7, uint32_t seq = 100)
+    {
+        u32(IPX_SFLOW_VERSION);
+        u32(IPX_SFLOW_ADDR_IPV4);
+        u32(0x0A000001); // 10.0.0.1
+        u32(sub_agent);
+        u32(seq);
+        u32(5000); // uptime
+        m_cnt_pos = m_data.size();
+        u32(0);
+    }
+
+    /// Add an unsigned 32-bit value
+    void
+    u32(uint32_t value)
+    {
+        for (int i = 3; i >= 0; --i) {
+            m_data.push_back((uint8_t) (value >> (8 * i)));
+        }
+    }
+
+    /// Add an opaque value (with padding)
+    void
+    opaque(const uint8_t *data, size_t size)
+    {
+        m_data.insert(m_data.end(), data, data + size);
+        while (m_data.size() % 4 != 0) {
+            m_data.push_back(0);
+        }
+    }
+
+    /// Start a sample or a flow record (its size will be filled by end())
+    void
+    begin(uint32_t format)
+    {
+        u32(format);
+        m_len_pos.push_back(m_data.size());
+        u32(0);
+    }
+
+    /// Finish the last sample or flow record
+    void
+    end()
+    {
+        size_t pos = m_len_pos.back();
+        m_len_pos.pop_back();
+        uint32_t len = htonl((uint32_t) (m_data.size() - pos - 4));
+        memcpy(&m_data[pos], &len, sizeof(len));
+    }
+
+    /// Increment the number of samples
+    void
+    sample_added()
+    {
+        uint32_t cnt;
+        memcpy(&cnt, &m_data[m_cnt_pos], sizeof(cnt));
+        cnt = htonl(ntohl(cnt) + 1);
+        memcpy(&m_data[m_cnt_pos], &cnt, sizeof(cnt));
+    }
+
+    /// Get a copy of the Datagram (allocated by malloc)
+    uint8_t *
+    release(uint16_t &size)
+    {
+        size = (uint16_t) m_data.size();
+        uint8_t *res = (uint8_t *) malloc(size);
+        memcpy(res, m_data.data(), size);
+        return res;
+    }
+
+private:
+    std::vector<uint8_t> m_data;
+    size_t m_cnt_pos;
+    std::vector<size_t> m_len_pos;
+};
+
+// Base TestCase fixture
+class MsgBase : public ::testing::Test {
+protected:
+    /// Before each Test case
+    void SetUp() override
+    {
+        const ::testing::TestInfo* const test_info =
+            ::testing::UnitTest::GetInstance()->current_test_info();
+        m_ctx.reset(ipx_ctx_create(test_info->name(), nullptr));
+        ASSERT_NE(m_ctx, nullptr);
+
+        ipx_session_net net_cfg;
+        net_cfg.l3_proto = AF_INET;
+        net_cfg.port_src = 60000;
+        net_cfg.port_dst = 6343; // Typical sFlow collector port
+        ASSERT_EQ(inet_pton(AF_INET, "192.168.0.2", &net_cfg.addr_src.ipv4), 1);
+        ASSERT_EQ(inet_pton(AF_INET, "192.168.0.1", &net_cfg.addr_dst.ipv4), 1);
+        m_session.reset(ipx_session_new_udp(&net_cfg, 0, 0));
+        ASSERT_NE(m_session, nullptr);
+    }
+
+    /**
+     * @brief Create the sFlow v5 to IPFIX converter
+     * @param[in] odid      Observation Domain ID of generated IPFIX Messages
+     * @param[in] tmplt_ref Template Refresh interval (in seconds)
+     */
+    void
+    converter_create(uint32_t odid = 0, uint32_t tmplt_ref = 0)
+    {
+        m_conv.reset(ipx_sflow_conv_init("sFlow -> IPFIX converter", IPX_VERB_DEBUG, tmplt_ref,
+            odid));
+        ASSERT_NE(m_conv, nullptr);
+    }
+
+    /// Convert the Datagram and return the IPFIX Message
+    struct fds_ipfix_msg_hdr *
+    convert(sflow_msg &msg, uint32_t odid, int exp_rc = IPX_OK)
+    {
+        uint16_t msg_size;
+        uint8_t *msg_data = msg.release(msg_size);
+        struct ipx_msg_ctx msg_ctx = {m_session.get(), odid, 0};
+        m_msg.reset(ipx_msg_ipfix_create(m_ctx.get(), &msg_ctx, msg_data, msg_size));
+        EXPECT_NE(m_msg, nullptr);
+        EXPECT_EQ(ipx_sflow_conv_process(m_conv.get(), m_msg.get()), exp_rc);
+        return reinterpret_cast<struct fds_ipfix_msg_hdr *>(ipx_msg_ipfix_get_packet(m_msg.get()));
+    }
+
+    /// Add a flow sample with a raw Ethernet header of an IPv4 TCP packet
+    void
+    add_flow_ipv4_header(sflow_msg &msg)
+    {
+        uint8_t pkt[58] = {
+            0x11, 0x11, 0x11, 0x11, 0x11, 0x11, // Destination MAC
+            0x22, 0x22, 0x22, 0x22, 0x22, 0x22, // Source MAC
+            0x81, 0x00, 0x00, 0x64,             // VLAN 100
+            0x08, 0x00,                         // IPv4
+            0x45, 0x10, 0x00, 0x28, 0x00, 0x00, 0x00, 0x00, 0x40, 0x06, 0x00, 0x00,
+            192, 168, 0, 1,                     // Source IPv4
+            192, 168, 0, 2,                     // Destination IPv4
+            0x30, 0x39, 0x00, 0x50,             // Ports 12345 -> 80
+            0, 0, 0, 0, 0, 0, 0, 0, 0x50, 0x12, // TCP flags SYN + ACK
+            0, 0, 0, 0, 0, 0
+        };
+
+        msg.begin(IPX_SFLOW_SAMPLE_FLOW);
+        msg.u32(1);      // sequence number
+        msg.u32(3);      // source ID
+        msg.u32(512);    // sampling rate
+        msg.u32(1000);   // sample pool
+        msg.u32(0);      // drops
+        msg.u32(10);     // input
+        msg.u32(20);     // output
+        msg.u32(1);      // number of records
+        msg.begin(IPX_SFLOW_FLOW_HEADER);
+        msg.u32(IPX_SFLOW_HDR_ETHERNET);
+        msg.u32(1522);   // frame length
+        msg.u32(4);      // stripped
+        msg.u32(sizeof(pkt));
+        msg.opaque(pkt, sizeof(pkt));
+        msg.end();
+        msg.end();
+        msg.sample_added();
+    }
+
+    /// Add an expanded flow sample with IPv6 data
+    void
+    add_flow_ipv6_data(sflow_msg &msg)
+    {
+        uint8_t addr_src[16], addr_dst[16];
+        ASSERT_EQ(inet_pton(AF_INET6, "2001:db8::1", addr_src), 1);
+        ASSERT_EQ(inet_pton(AF_INET6, "2001:db8::2", addr_dst), 1);
+
+        msg.begin(IPX_SFLOW_SAMPLE_FLOW_EXP);
+        msg.u32(2);      // sequence number
+        msg.u32(0);      // source ID type
+        msg.u32(5);      // source ID index
+        msg.u32(100);    // sampling rate
+        msg.u32(0);      // sample pool
+        msg.u32(0);      // drops
+        msg.u32(0);      // input format
+        msg.u32(3);      // input
+        msg.u32(0);      // output format
+        msg.u32(4);      // output
+        msg.u32(1);      // number of records
+        msg.begin(IPX_SFLOW_FLOW_IPV6);
+        msg.u32(1280);   // length
+        msg.u32(17);     // protocol
+        msg.opaque(addr_src, 16);
+        msg.opaque(addr_dst, 16);
+        msg.u32(53);     // source port
+        msg.u32(4242);   // destination port
+        msg.u32(0);      // TCP flags
+        msg.u32(7);      // priority
+        msg.end();
+        msg.end();
+        msg.sample_added();
+    }
+
+    /// Add a counter sample
+    void
+    add_counters(sflow_msg &msg)
+    {
+        msg.begin(IPX_SFLOW_SAMPLE_CNTR);
+        msg.u32(1); // sequence number
+        msg.u32(3); // source ID
+        msg.u32(0); // number of records
+        msg.end();
+        msg.sample_added();
+    }
+
+    /// Parse both Templates of the Template Set
+    void
+    parse_tset(struct fds_sets_iter &it_sets)
+    {
+        struct fds_tset_iter it_tset;
+        ASSERT_EQ(fds_sets_iter_next(&it_sets), FDS_OK);
+        ASSERT_EQ(ntohs(it_sets.set->flowset_id), FDS_IPFIX_SET_TMPLT);
+        fds_tset_iter_init(&it_tset, it_sets.set);
+
+        for (auto tmplt : {&m_tmplt4, &m_tmplt6}) {
+            ASSERT_EQ(fds_tset_iter_next(&it_tset), FDS_OK);
+            EXPECT_EQ(it_tset.field_cnt, SFLOW_FIELD_CNT);
+
+            struct fds_template *tmplt_parsed = nullptr;
+            uint16_t tmplt_size = it_tset.size;
+            ASSERT_EQ(fds_template_parse(FDS_TYPE_TEMPLATE, it_tset.ptr.trec, &tmplt_size,
+                &tmplt_parsed), FDS_OK);
+            tmplt->reset(tmplt_parsed);
+        }
+
+        EXPECT_EQ(fds_tset_iter_next(&it_tset), FDS_EOC);
+        EXPECT_EQ(m_tmplt4->id, FDS_IPFIX_SET_MIN_DSET);
+        EXPECT_EQ(m_tmplt6->id, FDS_IPFIX_SET_MIN_DSET + 1);
+    }
+
+    /// Get the only record of the next Data Set
+    struct fds_drec
+    parse_dset(struct fds_sets_iter &it_sets, const struct fds_template *tmplt)
+    {
+        struct fds_dset_iter it_dset;
+        EXPECT_EQ(fds_sets_iter_next(&it_sets), FDS_OK);
+        EXPECT_EQ(ntohs(it_sets.set->flowset_id), tmplt->id);
+        fds_dset_iter_init(&it_dset, it_sets.set, tmplt);
+        EXPECT_EQ(fds_dset_iter_next(&it_dset), FDS_OK);
+        struct fds_drec drec = {it_dset.rec, it_dset.size, tmplt, nullptr};
+        EXPECT_EQ(fds_dset_iter_next(&it_dset), FDS_EOC);
+        return drec;
+    }
+
+    /// Get an unsigned value of a field
+    uint64_t
+    get_uint(struct fds_drec &drec, uint16_t id)
+    {
+        struct fds_drec_field field;
+        uint64_t value = 0;
+        EXPECT_NE(fds_drec_find(&drec, 0, id, &field), FDS_EOC) << "ID: " << id;
+        EXPECT_EQ(fds_get_uint_be(field.data, field.size, &value), FDS_OK);
+        return value;
+    }
+
+    /// Get a raw value of a field
+    std::vector<uint8_t>
+    get_raw(struct fds_drec &drec, uint16_t id)
+    {
+        struct fds_drec_field field;
+        EXPECT_NE(fds_drec_find(&drec, 0, id, &field), FDS_EOC) << "ID: " << id;
+        return std::vector<uint8_t>(field.data, field.data + field.size);
+    }
+
+    // Transport Session
+    std::unique_ptr<struct ipx_session, decltype(&ipx_session_destroy)>
+        m_session = {nullptr, &ipx_session_destroy};
+    // Plugin context (necessary for building IPFIX Messages)
+    std::unique_ptr<ipx_ctx_t, decltype(&ipx_ctx_destroy)>
+        m_ctx = {nullptr, &ipx_ctx_destroy};
+    // sFlow Datagram to convert / converted IPFIX Message
+    std::unique_ptr<ipx_msg_ipfix_t, decltype(&ipx_msg_ipfix_destroy)>
+        m_msg = {nullptr, &ipx_msg_ipfix_destroy};
+    // sFlow to IPFIX converter
+    std::unique_ptr<ipx_sflow_conv_t, decltype(&ipx_sflow_conv_destroy)>
+        m_conv = {nullptr, &ipx_sflow_conv_destroy};
+    // Parsed Templates (IPv4 and IPv6 flows)
+    std::unique_ptr<struct fds_template, decltype(&fds_template_destroy)>
+        m_tmplt4 = {nullptr, &fds_template_destroy};
+    std::unique_ptr<struct fds_template, decltype(&fds_template_destroy)>
+        m_tmplt6 = {nullptr, &fds_template_destroy};
+};
+
+// Convert a flow sample with a raw packet header
+TEST_F(MsgBase, rawPacketHeader)
+{
+    const uint32_t VALUE_ODID = 7;
+    converter_create(VALUE_ODID);
+
+    sflow_msg msg(VALUE_ODID);
+    add_flow_ipv4_header(msg);
+    const uint32_t time_before = (uint32_t) time(NULL);
+    auto *hdr = convert(msg, VALUE_ODID);
+    const uint32_t time_after = (uint32_t) time(NULL);
+
+    EXPECT_EQ(ntohs(hdr->version), FDS_IPFIX_VERSION);
+    EXPECT_EQ(ntohl(hdr->odid), VALUE_ODID);
+    EXPECT_EQ(ntohl(hdr->seq_num), 0U);
+    EXPECT_GE(ntohl(hdr->export_time), time_before);
+    EXPECT_LE(ntohl(hdr->export_time), time_after);
+
+    struct fds_sets_iter it_sets;
+    fds_sets_iter_init(&it_sets, hdr);
+    parse_tset(it_sets);
+    struct fds_drec drec = parse_dset(it_sets, m_tmplt4.get());
+    EXPECT_EQ(fds_sets_iter_next(&it_sets), FDS_EOC);
+
+    EXPECT_EQ(get_raw(drec, 8), std::vector<uint8_t>({192, 168, 0, 1}));
+    EXPECT_EQ(get_raw(drec, 12), std::vector<uint8_t>({192, 168, 0, 2}));
+    EXPECT_EQ(get_uint(drec, 10), 10U);
+    EXPECT_EQ(get_uint(drec, 14), 20U);
+    EXPECT_EQ(get_uint(drec, 2), 512U);
+    EXPECT_EQ(get_uint(drec, 1), 40U * 512U); // Length of the IPv4 packet x sampling rate
+    EXPECT_EQ(get_uint(drec, 7), 12345U);
+    EXPECT_EQ(get_uint(drec, 11), 80U);
+    EXPECT_EQ(get_uint(drec, 6), 0x12U);
+    EXPECT_EQ(get_uint(drec, 4), 6U);
+    EXPECT_EQ(get_uint(drec, 5), 0x10U);
+    EXPECT_EQ(get_uint(drec, 58), 100U);
+    EXPECT_EQ(get_uint(drec, 34), 512U);
+    EXPECT_EQ(get_uint(drec, 35), 2U);
+    EXPECT_EQ(get_raw(drec, 56), std::vector<uint8_t>(6, 0x22));
+    EXPECT_EQ(get_raw(drec, 80), std::vector<uint8_t>(6, 0x11));
+
+    uint64_t ts;
+    struct fds_drec_field field;
+    ASSERT_NE(fds_drec_find(&drec, 0, 152, &field), FDS_EOC);
+    ASSERT_EQ(fds_get_datetime_lp_be(field.data, field.size, FDS_ET_DATE_TIME_MILLISECONDS, &ts),
+        FDS_OK);
+    EXPECT_GE(ts / 1000U, time_before);
+    EXPECT_LE(ts / 1000U, time_after);
+}
+
+// Convert IPv4 and IPv6 flow samples (counter samples are ignored)
+TEST_F(MsgBase, mixedSamples)
+{
+    const uint32_t VALUE_ODID = 15;
+    converter_create(VALUE_ODID);
+
+    sflow_msg msg(VALUE_ODID);
+    add_flow_ipv6_data(msg);
+    add_counters(msg);
+    add_flow_ipv4_header(msg);
+    auto *hdr = convert(msg, VALUE_ODID);
+
+    struct fds_sets_iter it_sets;
+    fds_sets_iter_init(&it_sets, hdr);
+    parse_tset(it_sets);
+    struct fds_drec drec4 = parse_dset(it_sets, m_tmplt4.get());
+    struct fds_drec drec6 = parse_dset(it_sets, m_tmplt6.get());
+    EXPECT_EQ(fds_sets_iter_next(&it_sets), FDS_EOC);
+
+    EXPECT_EQ(get_uint(drec4, 7), 12345U);
+
+    uint8_t addr_src[16];
+    ASSERT_EQ(inet_pton(AF_INET6, "2001:db8::1", addr_src), 1);
+    EXPECT_EQ(get_raw(drec6, 27), std::vector<uint8_t>(addr_src, addr_src + 16));
+    EXPECT_EQ(get_uint(drec6, 10), 3U);
+    EXPECT_EQ(get_uint(drec6, 14), 4U);
+    EXPECT_EQ(get_uint(drec6, 2), 100U);
+    EXPECT_EQ(get_uint(drec6, 1), 1280U * 100U);
+    EXPECT_EQ(get_uint(drec6, 7), 53U);
+    EXPECT_EQ(get_uint(drec6, 11), 4242U);
+    EXPECT_EQ(get_uint(drec6, 4), 17U);
+    EXPECT_EQ(get_uint(drec6, 5), 7U);
+}
+
+// Templates are added only into the first message and sequence numbers count records
+TEST_F(MsgBase, multipleDatagrams)
+{
+    converter_create();
+
+    for (uint32_t i = 0; i < 5; ++i) {
+        SCOPED_TRACE("Datagram: " + std::to_string(i));
+        sflow_msg msg(0, 100 + i);
+        add_flow_ipv4_header(msg);
+        add_flow_ipv4_header(msg);
+        auto *hdr = convert(msg, 0);
+        EXPECT_EQ(ntohl(hdr->seq_num), 2U * i);
+
+        struct fds_sets_iter it_sets;
+        fds_sets_iter_init(&it_sets, hdr);
+        if (i == 0) {
+            parse_tset(it_sets);
+        }
+
+        ASSERT_EQ(fds_sets_iter_next(&it_sets), FDS_OK);
+        EXPECT_EQ(ntohs(it_sets.set->flowset_id), FDS_IPFIX_SET_MIN_DSET);
+        EXPECT_EQ(ntohs(it_sets.set->length), FDS_IPFIX_SET_HDR_LEN + 2U * m_tmplt4->data_length);
+        EXPECT_EQ(fds_sets_iter_next(&it_sets), FDS_EOC);
+    }
+
+    // Datagram without flow samples
+    sflow_msg msg(0, 105);
+    add_counters(msg);
+    auto *hdr = convert(msg, 0);
+    EXPECT_EQ(ntohs(hdr->length), FDS_IPFIX_MSG_HDR_LEN);
+    EXPECT_EQ(ntohl(hdr->seq_num), 10U);
+}
+
+// Malformed Datagrams are not converted and the original content is untouched
+TEST_F(MsgBase, malformedDatagrams)
+{
+    converter_create();
+
+    // Invalid version
+    sflow_msg msg_ver;
+    add_flow_ipv4_header(msg_ver);
+    uint16_t size;
+    std::unique_ptr<uint8_t, decltype(&free)> data(msg_ver.release(size), &free);
+    data.get()[3] = 4;
+    uint8_t *copy = (uint8_t *) malloc(size);
+    memcpy(copy, data.get(), size);
+    struct ipx_msg_ctx msg_ctx = {m_session.get(), 0, 0};
+    m_msg.reset(ipx_msg_ipfix_create(m_ctx.get(), &msg_ctx, copy, size));
+    ASSERT_NE(m_msg, nullptr);
+    EXPECT_EQ(ipx_sflow_conv_process(m_conv.get(), m_msg.get()), IPX_ERR_FORMAT);
+    EXPECT_EQ(memcmp(ipx_msg_ipfix_get_packet(m_msg.get()), data.get(), size), 0);
+
+    // Truncated sample
+    sflow_msg msg_trunc;
+    add_flow_ipv4_header(msg_trunc);
+    data.reset(msg_trunc.release(size));
+    copy = (uint8_t *) malloc(size - 8U);
+    memcpy(copy, data.get(), size - 8U);
+    m_msg.reset(ipx_msg_ipfix_create(m_ctx.get(), &msg_ctx, copy, size - 8U));
+    ASSERT_NE(m_msg, nullptr);
+    EXPECT_EQ(ipx_sflow_conv_process(m_conv.get(), m_msg.get()), IPX_ERR_FORMAT);
+    EXPECT_EQ(memcmp(ipx_msg_ipfix_get_packet(m_msg.get()), data.get(), size - 8U), 0);
+
+    // Empty sample counter but too short header
+    sflow_msg msg_short;
+    data.reset(msg_short.release(size));
+    copy = (uint8_t *) malloc(IPX_SFLOW_MSG_HDR_LEN_MIN - 4U);
+    memcpy(copy, data.get(), IPX_SFLOW_MSG_HDR_LEN_MIN - 4U);
+    m_msg.reset(ipx_msg_ipfix_create(m_ctx.get(), &msg_ctx, copy, IPX_SFLOW_MSG_HDR_LEN_MIN - 4U));
+    ASSERT_NE(m_msg, nullptr);
+    EXPECT_EQ(ipx_sflow_conv_process(m_conv.get(), m_msg.get()), IPX_ERR_FORMAT);
+}
@@ -1,3 +1,8 @@
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <thread>
+#include <vector>
 #include <gtest/gtest.h>
 #include <MsgGen.h>
 #include <ipfixcol2/session.h>
@@ -162,4 +167,927 @@ TEST_P(Common, simple)
 }
 
 
-// Max message (65000 records in one message)...
\ No newline at end of file
+// Max message (65000 records in one message)...
+
+// Many records of a fixed-length template followed by padding (shorter than a record)
+TEST_P(Common, fixedLengthPadding)
+{
+    const uint16_t tmplt_id = 256;
+    const uint16_t rec_cnt = 200; // more than pre-allocated references of the wrapper
+    ipfix_trec trec(tmplt_id);
+    trec.add_field(8, 4);  // SRC IPv4 address
+    trec.add_field(1, 8);  // bytes
+    trec.add_field(2, 4);  // packets
+
+    ipfix_set set_tmplts(2);
+    set_tmplts.add_rec(trec);
+
+    ipfix_set set_data(tmplt_id);
+    for (uint16_t i = 0; i < rec_cnt; ++i) {
+        ipfix_drec drec;
+        drec.append_ip("127.0.0.1");
+        drec.append_uint(1000U + i, 8);
+        drec.append_uint(i, 4);
+        set_data.add_rec(drec);
+    }
+    set_data.add_padding(3);
+
+    ipfix_msg msg;
+    msg.add_set(set_tmplts);
+    msg.add_set(set_data);
+
+    struct ipx_msg_ctx msg_ctx = {session, 1, 0};
+    uint16_t msg_size = msg.size();
+    uint8_t *msg_data = reinterpret_cast<uint8_t *>(msg.release());
+    ipx_msg_ipfix_t *ipfix_msg = ipx_msg_ipfix_create(ctx, &msg_ctx, msg_data, msg_size);
+    ASSERT_NE(ipfix_msg, nullptr);
+
+    ipx_msg_garbage *garbage;
+    ASSERT_EQ(ipx_parser_process(parser, &ipfix_msg, &garbage), IPX_OK);
+    ASSERT_EQ(ipx_msg_ipfix_get_drec_cnt(ipfix_msg), rec_cnt);
+
+    for (uint16_t i = 0; i < rec_cnt; ++i) {
+        ipx_ipfix_record *rec = ipx_msg_ipfix_get_drec(ipfix_msg, i);
+        ASSERT_NE(rec, nullptr);
+        EXPECT_EQ(rec->rec.size, 16U);
+
+        fds_drec_field field;
+        uint64_t value;
+        ASSERT_GE(fds_drec_find(&rec->rec, 0, 1, &field), 0); // bytes
+        ASSERT_EQ(fds_get_uint_be(field.data, field.size, &value), FDS_OK);
+        EXPECT_EQ(value, 1000U + i);
+        ASSERT_GE(fds_drec_find(&rec->rec, 0, 2, &field), 0); // packets
+        ASSERT_EQ(fds_get_uint_be(field.data, field.size, &value), FDS_OK);
+        EXPECT_EQ(value, i);
+    }
+
+    ipx_msg_ipfix_destroy(ipfix_msg);
+}
+
+// Records of a template with a variable-length field are still walked field by field
+TEST_P(Common, variableLength)
+{
+    const uint16_t tmplt_id = 256;
+    ipfix_trec trec(tmplt_id);
+    trec.add_field(1, 4);                      // bytes
+    trec.add_field(82, ipfix_trec::SIZE_VAR);  // interfaceName
+
+    ipfix_set set_tmplts(2);
+    set_tmplts.add_rec(trec);
+
+    const std::string names[] = {"eth0", "", "a very long interface name"};
+    ipfix_set set_data(tmplt_id);
+    for (const auto &name : names) {
+        ipfix_drec drec;
+        drec.append_uint(name.size(), 4);
+        drec.append_string(name);
+        set_data.add_rec(drec);
+    }
+
+    ipfix_msg msg;
+    msg.add_set(set_tmplts);
+    msg.add_set(set_data);
+
+    struct ipx_msg_ctx msg_ctx = {session, 1, 0};
+    uint16_t msg_size = msg.size();
+    uint8_t *msg_data = reinterpret_cast<uint8_t *>(msg.release());
+    ipx_msg_ipfix_t *ipfix_msg = ipx_msg_ipfix_create(ctx, &msg_ctx, msg_data, msg_size);
+    ASSERT_NE(ipfix_msg, nullptr);
+
+    ipx_msg_garbage *garbage;
+    ASSERT_EQ(ipx_parser_process(parser, &ipfix_msg, &garbage), IPX_OK);
+    ASSERT_EQ(ipx_msg_ipfix_get_drec_cnt(ipfix_msg), 3U);
+
+    for (uint32_t i = 0; i < 3; ++i) {
+        ipx_ipfix_record *rec = ipx_msg_ipfix_get_drec(ipfix_msg, i);
+        ASSERT_NE(rec, nullptr);
+
+        fds_drec_field field;
+        ASSERT_GE(fds_drec_find(&rec->rec, 0, 82, &field), 0);
+        EXPECT_EQ(std::string(reinterpret_cast<char *>(field.data), field.size), names[i]);
+    }
+
+    ipx_msg_ipfix_destroy(ipfix_msg);
+}
+
+// Multiple variable-length fields with short and long length prefixes between fixed fields
+TEST_P(Common, variableLengthMixed)
+{
+    const uint16_t tmplt_id = 256;
+    ipfix_trec trec(tmplt_id);
+    trec.add_field(1, 4);                      // bytes
+    trec.add_field(82, ipfix_trec::SIZE_VAR);  // interfaceName
+    trec.add_field(7, 2);                      // sourceTransportPort
+    trec.add_field(83, ipfix_trec::SIZE_VAR);  // interfaceDescription
+    trec.add_field(2, 4);                      // packets
+
+    ipfix_set set_tmplts(2);
+    set_tmplts.add_rec(trec);
+
+    const std::string names[] = {"eth0", std::string(300, 'x'), "", std::string(254, 'y')};
+    const std::string descs[] = {std::string(255, 'z'), "uplink", "", "a"};
+    const uint32_t rec_cnt = 4;
+    ipfix_set set_data(tmplt_id);
+    for (uint32_t i = 0; i < rec_cnt; ++i) {
+        ipfix_drec drec;
+        drec.append_uint(i, 4);
+        drec.append_string(names[i]);
+        drec.append_uint(1000 + i, 2);
+        if (i == 2) {
+            // Empty field with a long (3 bytes) prefix
+            drec.var_header(0, true);
+        } else {
+            drec.append_string(descs[i]);
+        }
+        drec.append_uint(2000 + i, 4);
+        set_data.add_rec(drec);
+    }
+
+    ipfix_msg msg;
+    msg.add_set(set_tmplts);
+    msg.add_set(set_data);
+
+    struct ipx_msg_ctx msg_ctx = {session, 1, 0};
+    uint16_t msg_size = msg.size();
+    uint8_t *msg_data = reinterpret_cast<uint8_t *>(msg.release());
+    ipx_msg_ipfix_t *ipfix_msg = ipx_msg_ipfix_create(ctx, &msg_ctx, msg_data, msg_size);
+    ASSERT_NE(ipfix_msg, nullptr);
+
+    ipx_msg_garbage *garbage;
+    ASSERT_EQ(ipx_parser_process(parser, &ipfix_msg, &garbage), IPX_OK);
+    ASSERT_EQ(ipx_msg_ipfix_get_drec_cnt(ipfix_msg), rec_cnt);
+
+    for (uint32_t i = 0; i < rec_cnt; ++i) {
+        ipx_ipfix_record *rec = ipx_msg_ipfix_get_drec(ipfix_msg, i);
+        ASSERT_NE(rec, nullptr);
+
+        fds_drec_field field;
+        uint64_t value;
+        ASSERT_GE(fds_drec_find(&rec->rec, 0, 82, &field), 0);
+        EXPECT_EQ(std::string(reinterpret_cast<char *>(field.data), field.size), names[i]);
+        ASSERT_GE(fds_drec_find(&rec->rec, 0, 83, &field), 0);
+        EXPECT_EQ(field.size, (i == 2) ? 0U : descs[i].size());
+        ASSERT_GE(fds_drec_find(&rec->rec, 0, 7, &field), 0);
+        ASSERT_EQ(fds_get_uint_be(field.data, field.size, &value), FDS_OK);
+        EXPECT_EQ(value, 1000U + i);
+        ASSERT_GE(fds_drec_find(&rec->rec, 0, 2, &field), 0);
+        ASSERT_EQ(fds_get_uint_be(field.data, field.size, &value), FDS_OK);
+        EXPECT_EQ(value, 2000U + i);
+    }
+
+    ipx_msg_ipfix_destroy(ipfix_msg);
+}
+
+// A variable-length field that exceeds the end of the Data Set
+TEST_P(Common, variableLengthMalformed)
+{
+    const uint16_t tmplt_id = 256;
+    ipfix_trec trec(tmplt_id);
+    trec.add_field(1, 4);                      // bytes
+    trec.add_field(82, ipfix_trec::SIZE_VAR);  // interfaceName
+
+    ipfix_set set_tmplts(2);
+    set_tmplts.add_rec(trec);
+
+    ipfix_set set_data(tmplt_id);
+    ipfix_drec drec_ok;
+    drec_ok.append_uint(1, 4);
+    drec_ok.append_string("eth0");
+    set_data.add_rec(drec_ok);
+
+    ipfix_drec drec_bad;
+    drec_bad.append_uint(2, 4);
+    drec_bad.var_header(100); // ... but the content is missing
+    drec_bad.append_uint(0, 4);
+    set_data.add_rec(drec_bad);
+
+    ipfix_msg msg;
+    msg.add_set(set_tmplts);
+    msg.add_set(set_data);
+
+    struct ipx_msg_ctx msg_ctx = {session, 1, 0};
+    uint16_t msg_size = msg.size();
+    uint8_t *msg_data = reinterpret_cast<uint8_t *>(msg.release());
+    ipx_msg_ipfix_t *ipfix_msg = ipx_msg_ipfix_create(ctx, &msg_ctx, msg_data, msg_size);
+    ASSERT_NE(ipfix_msg, nullptr);
+
+    ipx_msg_garbage *garbage;
+    EXPECT_EQ(ipx_parser_process(parser, &ipfix_msg, &garbage), IPX_ERR_FORMAT);
+    ipx_msg_ipfix_destroy(ipfix_msg);
+}
+
+// Relay mode, Data Records are only counted in Sets of fixed and variable-length Templates
+TEST_P(Common, relay)
+{
+    ipx_parser_relay_set(parser, true);
+
+    ipfix_trec trec_fixed(256);
+    trec_fixed.add_field(1, 4);                      // bytes
+    trec_fixed.add_field(2, 4);                      // packets
+    ipfix_trec trec_var(257);
+    trec_var.add_field(1, 4);                        // bytes
+    trec_var.add_field(82, ipfix_trec::SIZE_VAR);    // interfaceName
+
+    ipfix_set set_tmplts(2);
+    set_tmplts.add_rec(trec_fixed);
+    set_tmplts.add_rec(trec_var);
+
+    ipfix_set set_fixed(256);
+    for (uint32_t i = 0; i < 5; ++i) {
+        ipfix_drec drec;
+        drec.append_uint(i, 4);
+        drec.append_uint(i, 4);
+        set_fixed.add_rec(drec);
+    }
+
+    ipfix_set set_var(257);
+    const std::string names[] = {"eth0", "", std::string(300, 'x')};
+    for (const auto &name : names) {
+        ipfix_drec drec;
+        drec.append_uint(name.size(), 4);
+        drec.append_string(name);
+        set_var.add_rec(drec);
+    }
+
+    ipfix_set set_unknown(258);
+    ipfix_drec drec_unknown;
+    drec_unknown.append_uint(0, 4);
+    set_unknown.add_rec(drec_unknown);
+
+    ipfix_msg msg;
+    msg.add_set(set_tmplts);
+    msg.add_set(set_fixed);
+    msg.add_set(set_var);
+    msg.add_set(set_unknown);
+
+    struct ipx_msg_ctx msg_ctx = {session, 1, 0};
+    uint16_t msg_size = msg.size();
+    uint8_t *msg_data = reinterpret_cast<uint8_t *>(msg.release());
+    ipx_msg_ipfix_t *ipfix_msg = ipx_msg_ipfix_create(ctx, &msg_ctx, msg_data, msg_size);
+    ASSERT_NE(ipfix_msg, nullptr);
+
+    ipx_msg_garbage *garbage;
+    ASSERT_EQ(ipx_parser_process(parser, &ipfix_msg, &garbage), IPX_OK);
+    EXPECT_EQ(ipx_msg_ipfix_get_drec_cnt(ipfix_msg), 0U);
+
+    struct ipx_ipfix_set *sets;
+    size_t set_cnt;
+    ipx_msg_ipfix_get_sets(ipfix_msg, &sets, &set_cnt);
+    ASSERT_EQ(set_cnt, 4U);
+    EXPECT_EQ(sets[0].drec_cnt, 0U);
+    EXPECT_EQ(sets[0].snap, nullptr);
+    EXPECT_EQ(sets[1].drec_cnt, 5U);
+    ASSERT_NE(sets[1].snap, nullptr);
+    EXPECT_NE(fds_tsnapshot_template_get(sets[1].snap, 256), nullptr);
+    EXPECT_EQ(sets[2].drec_cnt, 3U);
+    EXPECT_EQ(sets[2].snap, sets[1].snap);
+    EXPECT_EQ(sets[3].drec_cnt, 0U);
+    EXPECT_EQ(sets[3].snap, nullptr);
+
+    // Sequence numbers are still checked
+    struct ipx_parser_seq_stats stats;
+    ASSERT_EQ(ipx_parser_seq_stats_get(parser, session, 1, &stats), IPX_OK);
+    EXPECT_EQ(stats.recs_received, 8U);
+
+    ipx_msg_ipfix_destroy(ipfix_msg);
+}
+
+// Many combinations of Transport Sessions and ODIDs processed in a different order
+TEST_P(Common, manySources)
+{
+    const uint16_t tmplt_id = 256;
+    const uint32_t odid_cnt = 100;
+
+    // Create a message with one data record (and optionally with its template)
+    auto msg_create = [&](ipx_session *ts, uint32_t odid, bool with_tmplt) -> ipx_msg_ipfix_t * {
+        ipfix_trec trec(tmplt_id);
+        trec.add_field(1, 4);  // bytes
+        ipfix_set set_tmplts(2);
+        set_tmplts.add_rec(trec);
+
+        ipfix_drec drec;
+        drec.append_uint(odid, 4);
+        ipfix_set set_data(tmplt_id);
+        set_data.add_rec(drec);
+
+        ipfix_msg msg;
+        if (with_tmplt) {
+            msg.add_set(set_tmplts);
+        }
+        msg.add_set(set_data);
+
+        struct ipx_msg_ctx msg_ctx = {ts, odid, 0};
+        uint16_t msg_size = msg.size();
+        uint8_t *msg_data = reinterpret_cast<uint8_t *>(msg.release());
+        return ipx_msg_ipfix_create(ctx, &msg_ctx, msg_data, msg_size);
+    };
+
+    // Check that a message has been processed using the template of its source
+    auto msg_check = [&](ipx_session *ts, uint32_t odid, bool with_tmplt) {
+        ipx_msg_ipfix_t *ipfix_msg = msg_create(ts, odid, with_tmplt);
+        ASSERT_NE(ipfix_msg, nullptr);
+
+        ipx_msg_garbage *garbage;
+        ASSERT_EQ(ipx_parser_process(parser, &ipfix_msg, &garbage), IPX_OK);
+        ASSERT_EQ(ipx_msg_ipfix_get_drec_cnt(ipfix_msg), 1U);
+
+        ipx_ipfix_record *rec = ipx_msg_ipfix_get_drec(ipfix_msg, 0);
+        fds_drec_field field;
+        uint64_t value;
+        ASSERT_GE(fds_drec_find(&rec->rec, 0, 1, &field), 0);
+        ASSERT_EQ(fds_get_uint_be(field.data, field.size, &value), FDS_OK);
+        EXPECT_EQ(value, odid);
+        ipx_msg_ipfix_destroy(ipfix_msg);
+    };
+
+    session_uniq other(ipx_session_new_file("other_file.data"), &ipx_session_destroy);
+    ASSERT_NE(other, nullptr);
+
+    for (uint32_t odid = 0; odid < odid_cnt; ++odid) {
+        msg_check(session, odid, true);
+        msg_check(other.get(), odid, true);
+    }
+
+    // Templates are known only within the original combination of the session and ODID
+    for (uint32_t odid = odid_cnt; odid-- > 0;) {
+        msg_check(session, odid, false);
+        msg_check(session, odid, false);
+        msg_check(other.get(), odid, false);
+    }
+
+    // Remove the other session, records of the first one must be still available
+    ipx_msg_garbage_t *garbage = nullptr;
+    ASSERT_EQ(ipx_parser_session_remove(parser, other.get(), &garbage), IPX_OK);
+    ASSERT_NE(garbage, nullptr);
+    ipx_msg_garbage_destroy(garbage);
+    EXPECT_EQ(ipx_parser_session_remove(parser, other.get(), &garbage), IPX_ERR_NOTFOUND);
+
+    for (uint32_t odid = 0; odid < odid_cnt; ++odid) {
+        msg_check(session, odid, false);
+    }
+}
+
+// The least recently used combination of the session and ODID is evicted if the limit is reached
+TEST_P(Common, sourceLimit)
+{
+    const uint16_t tmplt_id = 256;
+    const size_t limit = 4;
+    ipx_parser_limit_set(parser, limit);
+
+    // Process a message with one data record (and optionally with its template)
+    auto msg_process = [&](uint32_t odid, bool with_tmplt, uint32_t *rec_cnt,
+            ipx_msg_garbage_t **garbage) {
+        ipfix_trec trec(tmplt_id);
+        trec.add_field(1, 4);  // bytes
+        ipfix_set set_tmplts(2);
+        set_tmplts.add_rec(trec);
+
+        ipfix_drec drec;
+        drec.append_uint(odid, 4);
+        ipfix_set set_data(tmplt_id);
+        set_data.add_rec(drec);
+
+        ipfix_msg msg;
+        if (with_tmplt) {
+            msg.add_set(set_tmplts);
+        }
+        msg.add_set(set_data);
+
+        struct ipx_msg_ctx msg_ctx = {session, odid, 0};
+        uint16_t msg_size = msg.size();
+        uint8_t *msg_data = reinterpret_cast<uint8_t *>(msg.release());
+        ipx_msg_ipfix_t *ipfix_msg = ipx_msg_ipfix_create(ctx, &msg_ctx, msg_data, msg_size);
+        ASSERT_NE(ipfix_msg, nullptr);
+
+        ASSERT_EQ(ipx_parser_process(parser, &ipfix_msg, garbage), IPX_OK);
+        *rec_cnt = ipx_msg_ipfix_get_drec_cnt(ipfix_msg);
+        ipx_msg_ipfix_destroy(ipfix_msg);
+    };
+
+    uint32_t rec_cnt;
+    ipx_msg_garbage_t *garbage;
+    for (uint32_t odid = 0; odid < limit; ++odid) {
+        msg_process(odid, true, &rec_cnt, &garbage);
+        EXPECT_EQ(rec_cnt, 1U);
+        if (garbage != nullptr) {
+            ipx_msg_garbage_destroy(garbage);
+        }
+    }
+    EXPECT_EQ(ipx_parser_evictions(parser), 0U);
+
+    // Use the oldest combination again, i.e. the second one is the least recently used now
+    msg_process(0, false, &rec_cnt, &garbage);
+    EXPECT_EQ(rec_cnt, 1U);
+    EXPECT_EQ(garbage, nullptr);
+
+    // A new combination evicts the second one and its garbage is returned
+    msg_process(limit, true, &rec_cnt, &garbage);
+    EXPECT_EQ(rec_cnt, 1U);
+    ASSERT_NE(garbage, nullptr);
+    ipx_msg_garbage_destroy(garbage);
+    EXPECT_EQ(ipx_parser_evictions(parser), 1U);
+
+    struct ipx_parser_seq_stats stats;
+    EXPECT_EQ(ipx_parser_seq_stats_get(parser, session, 1, &stats), IPX_ERR_NOTFOUND);
+    EXPECT_EQ(ipx_parser_seq_stats_get(parser, session, 0, &stats), IPX_OK);
+
+    // Templates of the evicted combination are not available anymore (the third one is evicted)
+    msg_process(1, false, &rec_cnt, &garbage);
+    EXPECT_EQ(rec_cnt, 0U);
+    ASSERT_NE(garbage, nullptr);
+    ipx_msg_garbage_destroy(garbage);
+    EXPECT_EQ(ipx_parser_evictions(parser), 2U);
+    EXPECT_EQ(ipx_parser_seq_stats_get(parser, session, 2, &stats), IPX_ERR_NOTFOUND);
+
+    // The others are still available
+    for (uint32_t odid : {0U, 3U, 4U}) {
+        msg_process(odid, false, &rec_cnt, &garbage);
+        EXPECT_EQ(rec_cnt, 1U);
+        EXPECT_EQ(garbage, nullptr);
+    }
+    EXPECT_EQ(ipx_parser_evictions(parser), 2U);
+}
+
+// Generation of the Template snapshot changes only when (Options) Templates are changed
+TEST_P(Common, snapshotGeneration)
+{
+    const uint16_t tmplt_id = 256;
+
+    // Process a message with one data record (and optionally with a new template) and return
+    // the generation of the snapshot
+    auto msg_process = [&](bool with_tmplt, uint16_t field_id) -> uint32_t {
+        ipfix_trec trec(tmplt_id);
+        trec.add_field(field_id, 4);
+        ipfix_set set_tmplts(2);
+        set_tmplts.add_rec(trec);
+
+        ipfix_drec drec;
+        drec.append_uint(1, 4);
+        ipfix_set set_data(tmplt_id);
+        set_data.add_rec(drec);
+
+        ipfix_msg msg;
+        if (with_tmplt) {
+            msg.add_set(set_tmplts);
+        }
+        msg.add_set(set_data);
+
+        struct ipx_msg_ctx msg_ctx = {session, 1, 0};
+        uint16_t msg_size = msg.size();
+        uint8_t *msg_data = reinterpret_cast<uint8_t *>(msg.release());
+        ipx_msg_ipfix_t *ipfix_msg = ipx_msg_ipfix_create(ctx, &msg_ctx, msg_data, msg_size);
+        EXPECT_NE(ipfix_msg, nullptr);
+
+        ipx_msg_garbage *garbage;
+        EXPECT_EQ(ipx_parser_process(parser, &ipfix_msg, &garbage), IPX_OK);
+        EXPECT_EQ(ipx_msg_ipfix_get_drec_cnt(ipfix_msg), 1U);
+        const uint32_t gen = ipx_msg_ipfix_get_ctx(ipfix_msg)->snap_gen;
+        ipx_msg_ipfix_destroy(ipfix_msg);
+        if (garbage) {
+            ipx_msg_garbage_destroy(garbage);
+        }
+        return gen;
+    };
+
+    const uint32_t gen1 = msg_process(true, 1);
+    EXPECT_EQ(msg_process(false, 1), gen1);
+    EXPECT_EQ(msg_process(false, 1), gen1);
+
+    if (GetParam() != FDS_SESSION_UDP) {
+        // Byte-identical refresh of the template doesn't change anything
+        EXPECT_EQ(msg_process(true, 1), gen1);
+        EXPECT_EQ(msg_process(false, 1), gen1);
+    }
+
+    if (GetParam() == FDS_SESSION_FILE || GetParam() == FDS_SESSION_UDP) {
+        // Only these session types allow redefinition of a Template without its withdrawal
+        const uint32_t gen2 = msg_process(true, 2);
+        EXPECT_NE(gen2, gen1);
+        EXPECT_EQ(msg_process(false, 2), gen2);
+    }
+}
+
+// Lost, reordered and reset Sequence Numbers are counted instead of logged per message
+TEST_P(Common, sequenceStats)
+{
+    const uint16_t tmplt_id = 256;
+    const uint32_t odid = 5;
+
+    // Process a message with the given Sequence Number and number of Data Records
+    auto msg_process = [&](uint32_t seq, uint16_t rec_cnt) {
+        ipfix_trec trec(tmplt_id);
+        trec.add_field(1, 4);
+        ipfix_set set_tmplts(2);
+        set_tmplts.add_rec(trec);
+
+        ipfix_set set_data(tmplt_id);
+        for (uint16_t i = 0; i < rec_cnt; ++i) {
+            ipfix_drec drec;
+            drec.append_uint(i, 4);
+            set_data.add_rec(drec);
+        }
+
+        ipfix_msg msg;
+        msg.set_odid(odid);
+        msg.set_seq(seq);
+        msg.add_set(set_tmplts);
+        msg.add_set(set_data);
+
+        struct ipx_msg_ctx msg_ctx = {session, odid, 0};
+        uint16_t msg_size = msg.size();
+        uint8_t *msg_data = reinterpret_cast<uint8_t *>(msg.release());
+        ipx_msg_ipfix_t *ipfix_msg = ipx_msg_ipfix_create(ctx, &msg_ctx, msg_data, msg_size);
+        ASSERT_NE(ipfix_msg, nullptr);
+
+        ipx_msg_garbage *garbage;
+        ASSERT_EQ(ipx_parser_process(parser, &ipfix_msg, &garbage), IPX_OK);
+        ipx_msg_ipfix_destroy(ipfix_msg);
+        if (garbage) {
+            ipx_msg_garbage_destroy(garbage);
+        }
+    };
+
+    struct ipx_parser_seq_stats stats;
+    EXPECT_EQ(ipx_parser_seq_stats_get(parser, session, odid, &stats), IPX_ERR_NOTFOUND);
+
+    const uint32_t base = 3000000;
+    msg_process(base, 10);      // the first message, next expected "base + 10"
+    msg_process(base + 10, 10); // in-order, next expected "base + 20"
+    msg_process(base + 30, 10); // 10 records lost, next expected "base + 40"
+    msg_process(base + 20, 10); // late message
+    msg_process(0, 10);         // reset of the exporter (too far in the past), next expected 10
+    msg_process(10, 5);
+
+    ASSERT_EQ(ipx_parser_seq_stats_get(parser, session, odid, &stats), IPX_OK);
+    EXPECT_EQ(stats.recs_received, 55U);
+    EXPECT_EQ(stats.recs_expected, 55U);
+    EXPECT_EQ(stats.reorders, 1U);
+    EXPECT_EQ(stats.resets, 1U);
+
+    // Counters are cumulative, i.e. not affected by reports
+    ipx_parser_seq_report(parser);
+    msg_process(15, 1);
+    ASSERT_EQ(ipx_parser_seq_stats_get(parser, session, odid, &stats), IPX_OK);
+    EXPECT_EQ(stats.recs_received, 56U);
+    EXPECT_EQ(stats.recs_expected, 56U);
+}
+
+// Definitions of the same Template ID with different content in multiple sessions
+TEST_P(Common, templatesSharedId)
+{
+    const uint16_t tmplt_id = 256;
+    session_uniq other(ipx_session_new_file("other_file.data"), &ipx_session_destroy);
+    ASSERT_NE(other, nullptr);
+
+    // Process a message with a definition of a template with a single field and its record
+    auto msg_check = [&](ipx_session *ts, uint16_t field_id) {
+        ipfix_trec trec(tmplt_id);
+        trec.add_field(field_id, 4);
+        ipfix_set set_tmplts(2);
+        set_tmplts.add_rec(trec);
+
+        ipfix_drec drec;
+        drec.append_uint(field_id, 4);
+        ipfix_set set_data(tmplt_id);
+        set_data.add_rec(drec);
+
+        ipfix_msg msg;
+        msg.add_set(set_tmplts);
+        msg.add_set(set_data);
+
+        struct ipx_msg_ctx msg_ctx = {ts, 1, 0};
+        uint16_t msg_size = msg.size();
+        uint8_t *msg_data = reinterpret_cast<uint8_t *>(msg.release());
+        ipx_msg_ipfix_t *ipfix_msg = ipx_msg_ipfix_create(ctx, &msg_ctx, msg_data, msg_size);
+        ASSERT_NE(ipfix_msg, nullptr);
+
+        ipx_msg_garbage *garbage;
+        ASSERT_EQ(ipx_parser_process(parser, &ipfix_msg, &garbage), IPX_OK);
+        ASSERT_EQ(ipx_msg_ipfix_get_drec_cnt(ipfix_msg), 1U);
+
+        ipx_ipfix_record *rec = ipx_msg_ipfix_get_drec(ipfix_msg, 0);
+        fds_drec_field field;
+        uint64_t value;
+        ASSERT_GE(fds_drec_find(&rec->rec, 0, field_id, &field), 0);
+        ASSERT_EQ(fds_get_uint_be(field.data, field.size, &value), FDS_OK);
+        EXPECT_EQ(value, field_id);
+        ipx_msg_ipfix_destroy(ipfix_msg);
+        if (garbage) {
+            ipx_msg_garbage_destroy(garbage);
+        }
+    };
+
+    // Each definition is processed twice (i.e. the second one is the same as a previous one)
+    msg_check(session, 1);
+    msg_check(other.get(), 2);
+    msg_check(session, 1);
+    msg_check(other.get(), 2);
+}
+
+// Template Set with Templates of the given IDs (each of them with a single "bytes" field)
+static ipfix_set
+tset_create(std::initializer_list<uint16_t> tmplt_ids)
+{
+    ipfix_set set(2);
+    for (uint16_t tmplt_id : tmplt_ids) {
+        ipfix_trec trec(tmplt_id);
+        trec.add_field(1, 4); // bytes
+        set.add_rec(trec);
+    }
+    return set;
+}
+
+// Data Set of a Template created by tset_create() with one Data Record per value
+static ipfix_set
+dset_create(uint16_t tmplt_id, std::initializer_list<uint64_t> values)
+{
+    ipfix_set set(tmplt_id);
+    for (uint64_t value : values) {
+        ipfix_drec drec;
+        drec.append_uint(value, 4);
+        set.add_rec(drec);
+    }
+    return set;
+}
+
+// Process a message of a Transport Session and get values of "bytes" of its Data Records
+static std::vector<uint64_t>
+msg_values(ipx_parser_t *parser, ipx_ctx_t *ctx, ipx_session *session, ipfix_msg &msg)
+{
+    std::vector<uint64_t> values;
+    struct ipx_msg_ctx msg_ctx = {session, 0, 0};
+    uint16_t msg_size = msg.size();
+    uint8_t *msg_data = reinterpret_cast<uint8_t *>(msg.release());
+    ipx_msg_ipfix_t *ipfix_msg = ipx_msg_ipfix_create(ctx, &msg_ctx, msg_data, msg_size);
+    EXPECT_NE(ipfix_msg, nullptr);
+    if (!ipfix_msg) {
+        return values;
+    }
+
+    ipx_msg_garbage *garbage;
+    EXPECT_EQ(ipx_parser_process(parser, &ipfix_msg, &garbage), IPX_OK);
+    for (uint32_t i = 0; i < ipx_msg_ipfix_get_drec_cnt(ipfix_msg); ++i) {
+        ipx_ipfix_record *rec = ipx_msg_ipfix_get_drec(ipfix_msg, i);
+        fds_drec_field field;
+        uint64_t value = 0;
+        EXPECT_GE(fds_drec_find(&rec->rec, 0, 1, &field), 0);
+        EXPECT_EQ(fds_get_uint_be(field.data, field.size, &value), FDS_OK);
+        values.push_back(value);
+    }
+
+    ipx_msg_ipfix_destroy(ipfix_msg);
+    if (garbage) {
+        ipx_msg_garbage_destroy(garbage);
+    }
+    return values;
+}
+
+// Remove a Transport Session from a parser
+static void
+session_remove(ipx_parser_t *parser, ipx_session *session)
+{
+    ipx_msg_garbage *garbage;
+    ASSERT_EQ(ipx_parser_session_remove(parser, session, &garbage), IPX_OK);
+    if (garbage) {
+        ipx_msg_garbage_destroy(garbage);
+    }
+}
+
+// Templates of active and removed UDP flow sources are restored from a state file
+TEST_P(Common, stateRoundTrip)
+{
+    const std::string path = "parser_state_" + std::to_string(GetParam()) + ".bin";
+    const bool is_udp = (GetParam() == FDS_SESSION_UDP);
+    ipx_parser_state_keep(parser, true);
+
+    ipfix_msg msg1;
+    msg1.add_set(tset_create({256, 257}));
+    msg1.add_set(dset_create(256, {1}));
+    EXPECT_EQ(msg_values(parser, ctx, session, msg1), std::vector<uint64_t>({1}));
+
+    // Active flow source
+    ASSERT_EQ(ipx_parser_state_save(parser, path.c_str()), IPX_OK);
+    parser_uniq active(ipx_parser_create("Active parser", DEF_VERB), &ipx_parser_destroy);
+    ASSERT_EQ(ipx_parser_state_load(active.get(), path.c_str()), IPX_OK);
+
+    ipfix_msg msg2;
+    msg2.add_set(dset_create(256, {2}));
+    msg2.add_set(dset_create(257, {3}));
+    EXPECT_EQ(msg_values(active.get(), ctx, session, msg2),
+        is_udp ? std::vector<uint64_t>({2, 3}) : std::vector<uint64_t>());
+
+    // Removed flow source (i.e. kept by the parser until the next save)
+    session_remove(parser, session);
+    ASSERT_EQ(ipx_parser_state_save(parser, path.c_str()), IPX_OK);
+    parser_uniq removed(ipx_parser_create("Removed parser", DEF_VERB), &ipx_parser_destroy);
+    ASSERT_EQ(ipx_parser_state_load(removed.get(), path.c_str()), IPX_OK);
+
+    ipfix_msg msg3;
+    msg3.add_set(dset_create(257, {4}));
+    EXPECT_EQ(msg_values(removed.get(), ctx, session, msg3),
+        is_udp ? std::vector<uint64_t>({4}) : std::vector<uint64_t>());
+
+    // Restored templates remain available
+    ipfix_msg msg4;
+    msg4.add_set(dset_create(256, {5}));
+    EXPECT_EQ(msg_values(removed.get(), ctx, session, msg4),
+        is_udp ? std::vector<uint64_t>({5}) : std::vector<uint64_t>());
+    std::remove(path.c_str());
+}
+
+// Truncated or corrupted state files are ignored as a whole
+TEST_P(Common, stateCorrupted)
+{
+    const std::string path = "parser_state_" + std::to_string(GetParam()) + ".bin";
+    EXPECT_EQ(ipx_parser_state_load(parser, "non_existing_state.bin"), IPX_OK);
+
+    ipfix_msg msg1;
+    msg1.add_set(tset_create({256}));
+    msg1.add_set(dset_create(256, {1}));
+    EXPECT_EQ(msg_values(parser, ctx, session, msg1), std::vector<uint64_t>({1}));
+    ASSERT_EQ(ipx_parser_state_save(parser, path.c_str()), IPX_OK);
+
+    std::ifstream file_in(path, std::ios::binary);
+    const std::string content((std::istreambuf_iterator<char>(file_in)),
+        std::istreambuf_iterator<char>());
+    ASSERT_GE(content.size(), 8U);
+
+    // File header (8 bytes), header of the flow source (48 bytes), type of the first template
+    std::vector<std::string> variants = {
+        "",
+        content.substr(0, content.size() - 3),
+        "XXXX" + content.substr(4)
+    };
+    if (content.size() > 58) {
+        std::string wrong_type = content;
+        wrong_type[56] = wrong_type[57] = '\xFF';
+        variants.push_back(wrong_type);
+        variants.push_back(content.substr(0, 30));
+    }
+
+    for (const auto &variant : variants) {
+        std::ofstream file_out(path, std::ios::binary | std::ios::trunc);
+        file_out << variant;
+        file_out.close();
+
+        parser_uniq other(ipx_parser_create("Other parser", DEF_VERB), &ipx_parser_destroy);
+        EXPECT_EQ(ipx_parser_state_load(other.get(), path.c_str()), IPX_ERR_FORMAT);
+
+        ipfix_msg msg2;
+        msg2.add_set(dset_create(256, {2}));
+        EXPECT_EQ(msg_values(other.get(), ctx, session, msg2), std::vector<uint64_t>());
+    }
+    std::remove(path.c_str());
+}
+
+// Templates older than the template lifetime of a UDP Transport Session are not restored
+TEST_P(Common, stateExpired)
+{
+    if (GetParam() != FDS_SESSION_UDP) {
+        // Only templates of UDP Transport Sessions are saved
+        return;
+    }
+
+    const std::string path_active = "parser_state_active.bin";
+    const std::string path_removed = "parser_state_removed.bin";
+    session_uniq udp(ipx_session_new_udp(&session->udp.net, 1, 1), &ipx_session_destroy);
+    ASSERT_NE(udp, nullptr);
+    ipx_parser_state_keep(parser, true);
+
+    ipfix_msg msg1;
+    msg1.add_set(tset_create({256}));
+    msg1.add_set(dset_create(256, {1}));
+    EXPECT_EQ(msg_values(parser, ctx, udp.get(), msg1), std::vector<uint64_t>({1}));
+    ASSERT_EQ(ipx_parser_state_save(parser, path_active.c_str()), IPX_OK);
+    session_remove(parser, udp.get());
+
+    std::this_thread::sleep_for(std::chrono::seconds(2));
+    ASSERT_EQ(ipx_parser_state_save(parser, path_removed.c_str()), IPX_OK);
+
+    for (const auto &path : {path_active, path_removed}) {
+        parser_uniq other(ipx_parser_create("Other parser", DEF_VERB), &ipx_parser_destroy);
+        ASSERT_EQ(ipx_parser_state_load(other.get(), path.c_str()), IPX_OK);
+
+        ipfix_msg msg2;
+        msg2.add_set(dset_create(256, {2}));
+        EXPECT_EQ(msg_values(other.get(), ctx, udp.get(), msg2), std::vector<uint64_t>());
+        std::remove(path.c_str());
+    }
+}
+
+// Data Sets received before their Templates are recovered in the original order
+TEST_P(Common, pendingRecovered)
+{
+    const bool is_udp = (GetParam() == FDS_SESSION_UDP);
+    ipx_parser_pending_set(parser, 32768, 10);
+
+    ipfix_msg msg1;
+    msg1.add_set(dset_create(256, {1, 2}));
+    msg1.add_set(dset_create(257, {3}));
+    EXPECT_EQ(msg_values(parser, ctx, session, msg1), std::vector<uint64_t>());
+
+    ipfix_msg msg2;
+    msg2.add_set(dset_create(258, {4}));
+    EXPECT_EQ(msg_values(parser, ctx, session, msg2), std::vector<uint64_t>());
+
+    // Own Sets first, then buffered Sets with known templates (the rest remains waiting)
+    ipfix_msg msg3;
+    msg3.add_set(tset_create({256, 258}));
+    msg3.add_set(dset_create(256, {5}));
+    EXPECT_EQ(msg_values(parser, ctx, session, msg3),
+        is_udp ? std::vector<uint64_t>({5, 1, 2, 4}) : std::vector<uint64_t>({5}));
+
+    ipfix_msg msg4;
+    msg4.add_set(tset_create({257}));
+    EXPECT_EQ(msg_values(parser, ctx, session, msg4),
+        is_udp ? std::vector<uint64_t>({3}) : std::vector<uint64_t>());
+
+    struct ipx_parser_pending_stats stats;
+    ipx_parser_pending_stats_get(parser, &stats);
+    EXPECT_EQ(stats.buffered, is_udp ? 3U : 0U);
+    EXPECT_EQ(stats.recovered, is_udp ? 3U : 0U);
+    EXPECT_EQ(stats.expired, 0U);
+}
+
+// Buffered Data Sets older than the timeout (based on Export Time) are dropped
+TEST_P(Common, pendingExpired)
+{
+    const bool is_udp = (GetParam() == FDS_SESSION_UDP);
+    const uint32_t exp_time = 1000000;
+    ipx_parser_pending_set(parser, 32768, 10);
+
+    ipfix_msg msg1;
+    msg1.set_exp(exp_time);
+    msg1.add_set(dset_create(256, {1}));
+    EXPECT_EQ(msg_values(parser, ctx, session, msg1), std::vector<uint64_t>());
+
+    ipfix_msg msg2;
+    msg2.set_exp(exp_time + 5);
+    msg2.add_set(dset_create(256, {2}));
+    EXPECT_EQ(msg_values(parser, ctx, session, msg2), std::vector<uint64_t>());
+
+    ipfix_msg msg3;
+    msg3.set_exp(exp_time + 12);
+    msg3.add_set(tset_create({256}));
+    EXPECT_EQ(msg_values(parser, ctx, session, msg3),
+        is_udp ? std::vector<uint64_t>({2}) : std::vector<uint64_t>());
+
+    struct ipx_parser_pending_stats stats;
+    ipx_parser_pending_stats_get(parser, &stats);
+    EXPECT_EQ(stats.buffered, is_udp ? 2U : 0U);
+    EXPECT_EQ(stats.recovered, is_udp ? 1U : 0U);
+    EXPECT_EQ(stats.expired, is_udp ? 1U : 0U);
+}
+
+// Buffered Data Sets are attached only while the message fits into the maximum size
+TEST_P(Common, pendingSizeLimit)
+{
+    const bool is_udp = (GetParam() == FDS_SESSION_UDP);
+    const uint16_t tmplt_id = 256;
+    ipx_parser_pending_set(parser, 100000, 10);
+
+    ipfix_trec trec(tmplt_id);
+    trec.add_field(1, 4);                      // bytes
+    trec.add_field(82, ipfix_trec::SIZE_VAR);  // interfaceName
+    ipfix_set set_tmplts(2);
+    set_tmplts.add_rec(trec);
+
+    // Data Set with a single Data Record of approx. 40 kB
+    auto dset_large = [&](uint64_t value) {
+        ipfix_drec drec;
+        drec.append_uint(value, 4);
+        drec.append_string(std::string(40000, 'x'));
+        ipfix_set set(tmplt_id);
+        set.add_rec(drec);
+        return set;
+    };
+
+    for (uint64_t value : {1, 2}) {
+        ipfix_msg msg;
+        msg.add_set(dset_large(value));
+        EXPECT_EQ(msg_values(parser, ctx, session, msg), std::vector<uint64_t>());
+    }
+
+    // Both waiting Sets don't fit into a single message
+    ipfix_drec drec;
+    drec.append_uint(3, 4);
+    drec.append_string("eth0");
+    ipfix_set set_small(tmplt_id);
+    set_small.add_rec(drec);
+
+    ipfix_msg msg3;
+    msg3.add_set(set_tmplts);
+    msg3.add_set(set_small);
+    EXPECT_EQ(msg_values(parser, ctx, session, msg3),
+        is_udp ? std::vector<uint64_t>({3, 1}) : std::vector<uint64_t>({3}));
+
+    ipfix_msg msg4;
+    msg4.add_set(set_small);
+    EXPECT_EQ(msg_values(parser, ctx, session, msg4),
+        is_udp ? std::vector<uint64_t>({3, 2}) : std::vector<uint64_t>({3}));
+
+    struct ipx_parser_pending_stats stats;
+    ipx_parser_pending_stats_get(parser, &stats);
+    EXPECT_EQ(stats.recovered, is_udp ? 2U : 0U);
+    EXPECT_EQ(stats.expired, 0U);
+}
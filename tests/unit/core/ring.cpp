@@ -0,0 +1,620 @@
+#include <gtest/gtest.h>
+#include <thread>
+#include <vector>
+#include <cstdint>
+#include <chrono>
+#include <tuple>
+#include <atomic>
+
+extern "C" {
+#include <core/ring.h>
+}
+
+int main(int argc, char **argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
+
+/** Encode identification of a writer and a sequence number as a fake message pointer */
+static ipx_msg_t *
+fake_msg(uint64_t writer, uint64_t seq)
+{
+    return reinterpret_cast<ipx_msg_t *>(static_cast<uintptr_t>((writer << 32) | seq));
+}
+
+class Ring : public ::testing::TestWithParam<enum ipx_ring_type> {};
+
+INSTANTIATE_TEST_CASE_P(Types, Ring, ::testing::Values(IPX_RING_TYPE_BLOCK,
+    IPX_RING_TYPE_LOCKFREE));
+
+// Messages from a single writer must be received in the same order
+TEST_P(Ring, singleWriter)
+{
+    constexpr uint32_t ring_size = 128;
+    constexpr uint64_t msg_cnt = 100000;
+
+    ipx_ring_t *ring = ipx_ring_init_type(ring_size, false, GetParam());
+    ASSERT_NE(ring, nullptr);
+    EXPECT_EQ(ipx_ring_type_get(ring), GetParam());
+
+    std::thread writer([ring]() {
+        for (uint64_t i = 1; i <= msg_cnt; ++i) {
+            ipx_ring_push(ring, fake_msg(0, i));
+        }
+    });
+
+    for (uint64_t i = 1; i <= msg_cnt; ++i) {
+        ASSERT_EQ(ipx_ring_pop(ring), fake_msg(0, i));
+    }
+
+    writer.join();
+    ipx_ring_destroy(ring);
+}
+
+// Messages from multiple writers must preserve order of each writer
+TEST_P(Ring, multiWriter)
+{
+    constexpr uint32_t ring_size = 256;
+    constexpr uint64_t writer_cnt = 4;
+    constexpr uint64_t msg_cnt = 50000;
+
+    ipx_ring_t *ring = ipx_ring_init_type(ring_size, true, GetParam());
+    ASSERT_NE(ring, nullptr);
+
+    std::vector<std::thread> writers;
+    for (uint64_t w = 0; w < writer_cnt; ++w) {
+        writers.emplace_back([ring, w]() {
+            for (uint64_t i = 1; i <= msg_cnt; ++i) {
+                ipx_ring_push(ring, fake_msg(w, i));
+            }
+        });
+    }
+
+    std::vector<uint64_t> last(writer_cnt, 0);
+    for (uint64_t i = 0; i < writer_cnt * msg_cnt; ++i) {
+        uintptr_t value = reinterpret_cast<uintptr_t>(ipx_ring_pop(ring));
+        uint64_t w = value >> 32;
+        uint64_t seq = value & UINT32_MAX;
+        ASSERT_LT(w, writer_cnt);
+        ASSERT_EQ(seq, last[w] + 1);
+        last[w] = seq;
+    }
+
+    for (auto &writer : writers) {
+        writer.join();
+    }
+    ipx_ring_destroy(ring);
+}
+
+// Bulk operations must preserve order of messages of each writer
+TEST_P(Ring, bulkMultiWriter)
+{
+    constexpr uint32_t ring_size = 256;
+    constexpr uint64_t writer_cnt = 3;
+    constexpr uint64_t msg_cnt = 60000;
+    constexpr uint32_t batch_size = 50;
+
+    ipx_ring_t *ring = ipx_ring_init_type(ring_size, true, GetParam());
+    ASSERT_NE(ring, nullptr);
+
+    std::vector<std::thread> writers;
+    for (uint64_t w = 0; w < writer_cnt; ++w) {
+        writers.emplace_back([ring, w]() {
+            ipx_msg_t *batch[batch_size];
+            uint64_t seq = 1;
+            while (seq <= msg_cnt) {
+                uint32_t cnt = 0;
+                while (cnt < batch_size && seq <= msg_cnt) {
+                    batch[cnt++] = fake_msg(w, seq++);
+                }
+                ipx_ring_push_bulk(ring, batch, cnt);
+            }
+        });
+    }
+
+    std::vector<uint64_t> last(writer_cnt, 0);
+    ipx_msg_t *batch[64];
+    uint64_t total = 0;
+    while (total < writer_cnt * msg_cnt) {
+        uint32_t cnt = ipx_ring_pop_bulk(ring, batch, 64);
+        ASSERT_GE(cnt, 1U);
+        ASSERT_LE(cnt, 64U);
+
+        for (uint32_t i = 0; i < cnt; ++i) {
+            uintptr_t value = reinterpret_cast<uintptr_t>(batch[i]);
+            uint64_t w = value >> 32;
+            uint64_t seq = value & UINT32_MAX;
+            ASSERT_LT(w, writer_cnt);
+            ASSERT_EQ(seq, last[w] + 1);
+            last[w] = seq;
+        }
+        total += cnt;
+    }
+
+    EXPECT_EQ(total, writer_cnt * msg_cnt);
+    for (auto &writer : writers) {
+        writer.join();
+    }
+    ipx_ring_destroy(ring);
+}
+
+// Bulk and single operations can be mixed
+TEST_P(Ring, bulkMixed)
+{
+    constexpr uint32_t ring_size = 128;
+    ipx_ring_t *ring = ipx_ring_init_type(ring_size, false, GetParam());
+    ASSERT_NE(ring, nullptr);
+
+    uint64_t seq_write = 1;
+    uint64_t seq_read = 1;
+    for (int round = 0; round < 100; ++round) {
+        ipx_msg_t *batch[16];
+        for (uint32_t i = 0; i < 10; ++i) {
+            batch[i] = fake_msg(0, seq_write++);
+        }
+        ipx_ring_push_bulk(ring, batch, 10);
+        ipx_ring_push(ring, fake_msg(0, seq_write++));
+
+        // Read everything back (mix single and bulk reads)
+        ASSERT_EQ(ipx_ring_pop(ring), fake_msg(0, seq_read++));
+        while (seq_read < seq_write) {
+            uint32_t cnt = ipx_ring_pop_bulk(ring, batch, 16);
+            for (uint32_t i = 0; i < cnt; ++i) {
+                ASSERT_EQ(batch[i], fake_msg(0, seq_read++));
+            }
+        }
+    }
+
+    ipx_ring_destroy(ring);
+}
+
+// Non-blocking writes fail only if the buffer is full
+TEST_P(Ring, tryPush)
+{
+    constexpr uint32_t ring_size = 64;
+    ipx_ring_t *ring = ipx_ring_init_type(ring_size, false, GetParam());
+    ASSERT_NE(ring, nullptr);
+
+    uint64_t seq_write = 1;
+    while (ipx_ring_try_push(ring, fake_msg(0, seq_write))) {
+        seq_write++;
+        ASSERT_LE(seq_write, 2 * ring_size);
+    }
+
+    // At least half of the buffer must be usable (a block ring holds the rest in its last block)
+    EXPECT_GE(seq_write - 1, ring_size / 2);
+    EXPECT_LE(seq_write - 1, ring_size);
+
+    // Read everything back and try again
+    uint64_t seq_read = 1;
+    while (seq_read < seq_write) {
+        ASSERT_EQ(ipx_ring_pop(ring), fake_msg(0, seq_read++));
+    }
+    EXPECT_TRUE(ipx_ring_try_push(ring, fake_msg(0, seq_write)));
+    ASSERT_EQ(ipx_ring_pop(ring), fake_msg(0, seq_write));
+
+    struct ipx_ring_stats stats;
+    ipx_ring_stats_get(ring, &stats);
+    EXPECT_EQ(stats.pushes, seq_write);
+    ipx_ring_destroy(ring);
+}
+
+// Size of a lock-free ring is rounded up, so it must accept at least the required amount
+TEST(RingLockFree, notPowerOfTwo)
+{
+    constexpr uint32_t ring_size = 200;
+    ipx_ring_t *ring = ipx_ring_init_type(ring_size, false, IPX_RING_TYPE_LOCKFREE);
+    ASSERT_NE(ring, nullptr);
+
+    for (uint64_t i = 1; i <= ring_size; ++i) {
+        ipx_ring_push(ring, fake_msg(0, i));
+    }
+    for (uint64_t i = 1; i <= ring_size; ++i) {
+        EXPECT_EQ(ipx_ring_pop(ring), fake_msg(0, i));
+    }
+
+    ipx_ring_destroy(ring);
+}
+
+class RingWait : public ::testing::TestWithParam<std::tuple<enum ipx_ring_type, enum ipx_ring_wait>> {};
+
+INSTANTIATE_TEST_CASE_P(Strategies, RingWait, ::testing::Combine(
+    ::testing::Values(IPX_RING_TYPE_BLOCK, IPX_RING_TYPE_LOCKFREE),
+    ::testing::Values(IPX_RING_WAIT_PARK, IPX_RING_WAIT_ADAPTIVE, IPX_RING_WAIT_SPIN)));
+
+// Default strategy depends on the type of the ring
+TEST(RingWaitDefault, defaults)
+{
+    ipx_ring_t *ring = ipx_ring_init_type(64, false, IPX_RING_TYPE_BLOCK);
+    ASSERT_NE(ring, nullptr);
+    EXPECT_EQ(ipx_ring_wait_get(ring), IPX_RING_WAIT_PARK);
+    ipx_ring_wait_set(ring, IPX_RING_WAIT_SPIN);
+    EXPECT_EQ(ipx_ring_wait_get(ring), IPX_RING_WAIT_SPIN);
+    ipx_ring_wait_set(ring, IPX_RING_WAIT_DEFAULT);
+    EXPECT_EQ(ipx_ring_wait_get(ring), IPX_RING_WAIT_PARK);
+    ipx_ring_destroy(ring);
+
+    ring = ipx_ring_init_type(64, false, IPX_RING_TYPE_LOCKFREE);
+    ASSERT_NE(ring, nullptr);
+    EXPECT_EQ(ipx_ring_wait_get(ring), IPX_RING_WAIT_ADAPTIVE);
+    ipx_ring_destroy(ring);
+}
+
+// Sparse messages from multiple writers must be delivered with all strategies
+TEST_P(RingWait, sparseMultiWriter)
+{
+    constexpr uint32_t ring_size = 64;
+    constexpr uint64_t writer_cnt = 2;
+    constexpr uint64_t msg_cnt = 2000;
+
+    ipx_ring_t *ring = ipx_ring_init_type(ring_size, true, std::get<0>(GetParam()));
+    ASSERT_NE(ring, nullptr);
+    ipx_ring_wait_set(ring, std::get<1>(GetParam()));
+    EXPECT_EQ(ipx_ring_wait_get(ring), std::get<1>(GetParam()));
+
+    std::vector<std::thread> writers;
+    for (uint64_t w = 0; w < writer_cnt; ++w) {
+        writers.emplace_back([ring, w]() {
+            for (uint64_t i = 1; i <= msg_cnt; ++i) {
+                ipx_ring_push(ring, fake_msg(w, i));
+                if (i % 100 == 0) {
+                    // Let the reader wait for a while
+                    std::this_thread::sleep_for(std::chrono::microseconds(200));
+                }
+            }
+        });
+    }
+
+    std::vector<uint64_t> last(writer_cnt, 0);
+    for (uint64_t i = 0; i < writer_cnt * msg_cnt; ++i) {
+        uintptr_t value = reinterpret_cast<uintptr_t>(ipx_ring_pop(ring));
+        uint64_t w = value >> 32;
+        uint64_t seq = value & UINT32_MAX;
+        ASSERT_LT(w, writer_cnt);
+        ASSERT_EQ(seq, last[w] + 1);
+        last[w] = seq;
+    }
+
+    for (auto &writer : writers) {
+        writer.join();
+    }
+    ipx_ring_destroy(ring);
+}
+
+// Statistics must count all pushed and popped messages
+TEST_P(Ring, stats)
+{
+    constexpr uint32_t ring_size = 128;
+    ipx_ring_t *ring = ipx_ring_init_type(ring_size, false, GetParam());
+    ASSERT_NE(ring, nullptr);
+
+    struct ipx_ring_stats stats;
+    ipx_ring_stats_get(ring, &stats);
+    EXPECT_EQ(stats.pushes, 0U);
+    EXPECT_EQ(stats.pops, 0U);
+    EXPECT_EQ(stats.usage, 0U);
+    EXPECT_EQ(stats.size, ring_size);
+
+    ipx_msg_t *batch[32];
+    for (uint32_t i = 0; i < 32; ++i) {
+        batch[i] = fake_msg(0, i + 1);
+    }
+    ipx_ring_push_bulk(ring, batch, 32);
+    ipx_ring_push(ring, fake_msg(0, 33));
+
+    ipx_ring_stats_get(ring, &stats);
+    EXPECT_EQ(stats.pushes, 33U);
+    EXPECT_EQ(stats.usage, 33U);
+
+    uint32_t cnt = 0;
+    while (cnt < 33) {
+        cnt += ipx_ring_pop_bulk(ring, batch, 32);
+    }
+
+    ipx_ring_stats_get(ring, &stats);
+    EXPECT_EQ(stats.pops, 33U);
+    EXPECT_EQ(stats.usage, 0U);
+    EXPECT_EQ(stats.high_water, 33U);
+    ipx_ring_destroy(ring);
+}
+
+// Placement on a NUMA node must not affect the content of the buffer
+TEST_P(Ring, nodePlacement)
+{
+    constexpr uint32_t ring_size = 128;
+    constexpr uint64_t msg_cnt = 10000;
+    ipx_ring_t *ring = ipx_ring_init_type(ring_size, false, GetParam());
+    ASSERT_NE(ring, nullptr);
+
+    // Node 0 always exists, but the kernel might not support NUMA policies (not fatal)
+    int rc = ipx_ring_node_set(ring, 0);
+    EXPECT_TRUE(rc == IPX_OK || rc == IPX_ERR_DENIED);
+
+    std::thread writer([ring]() {
+        for (uint64_t i = 1; i <= msg_cnt; ++i) {
+            ipx_ring_push(ring, fake_msg(0, i));
+        }
+    });
+
+    for (uint64_t i = 1; i <= msg_cnt; ++i) {
+        ASSERT_EQ(ipx_ring_pop(ring), fake_msg(0, i));
+    }
+
+    writer.join();
+    ipx_ring_destroy(ring);
+}
+
+// Each reader of a broadcast ring must receive all messages in the original order
+TEST(RingBroadcast, allReaders)
+{
+    constexpr uint32_t ring_size = 128;
+    constexpr uint32_t reader_cnt = 4;
+    constexpr uint64_t msg_cnt = 50000;
+
+    ipx_ring_t *ring = ipx_ring_init_type(ring_size, false, IPX_RING_TYPE_BROADCAST);
+    ASSERT_NE(ring, nullptr);
+    EXPECT_EQ(ipx_ring_type_get(ring), IPX_RING_TYPE_BROADCAST);
+
+    std::vector<ipx_ring_t *> views;
+    for (uint32_t i = 0; i < reader_cnt; ++i) {
+        ipx_ring_t *view = ipx_ring_bcast_reader_add(ring);
+        ASSERT_NE(view, nullptr);
+        views.push_back(view);
+    }
+
+    std::vector<std::thread> readers;
+    std::vector<uint64_t> received(reader_cnt, 0);
+    for (uint32_t r = 0; r < reader_cnt; ++r) {
+        readers.emplace_back([&views, &received, r]() {
+            ipx_msg_t *batch[16];
+            uint64_t expected = 1;
+            while (expected <= msg_cnt) {
+                // Mix single and bulk reads
+                uint32_t cnt = (expected % 2 == 0)
+                    ? ipx_ring_pop_bulk(views[r], batch, 16)
+                    : (batch[0] = ipx_ring_pop(views[r]), 1U);
+                for (uint32_t i = 0; i < cnt; ++i, ++expected) {
+                    if (batch[i] != fake_msg(0, expected)) {
+                        return;
+                    }
+                }
+            }
+            received[r] = expected - 1;
+        });
+    }
+
+    ipx_msg_t *batch[8];
+    for (uint64_t i = 1; i <= msg_cnt; ) {
+        if (i % 3 == 0 && i + 8 <= msg_cnt) {
+            for (uint32_t j = 0; j < 8; ++j) {
+                batch[j] = fake_msg(0, i + j);
+            }
+            ipx_ring_push_bulk(ring, batch, 8);
+            i += 8;
+        } else {
+            ipx_ring_push(ring, fake_msg(0, i++));
+        }
+    }
+
+    for (auto &reader : readers) {
+        reader.join();
+    }
+    for (uint32_t r = 0; r < reader_cnt; ++r) {
+        EXPECT_EQ(received[r], msg_cnt);
+    }
+
+    struct ipx_ring_stats stats;
+    ipx_ring_stats_get(views[0], &stats);
+    EXPECT_EQ(stats.pushes, msg_cnt);
+    EXPECT_EQ(stats.pops, msg_cnt);
+    EXPECT_EQ(stats.usage, 0U);
+    ipx_ring_stats_get(ring, &stats);
+    EXPECT_EQ(stats.usage, 0U);
+    ipx_ring_destroy(ring);
+}
+
+// The slowest reader gates the writer
+TEST(RingBroadcast, slowReader)
+{
+    constexpr uint32_t ring_size = 16;
+    ipx_ring_t *ring = ipx_ring_init_type(ring_size, false, IPX_RING_TYPE_BROADCAST);
+    ASSERT_NE(ring, nullptr);
+    ipx_ring_t *fast = ipx_ring_bcast_reader_add(ring);
+    ipx_ring_t *slow = ipx_ring_bcast_reader_add(ring);
+    ASSERT_NE(fast, nullptr);
+    ASSERT_NE(slow, nullptr);
+
+    // Fill the buffer and let the fast reader consume everything
+    for (uint32_t i = 1; i <= ring_size; ++i) {
+        ipx_ring_push(ring, fake_msg(0, i));
+    }
+    for (uint32_t i = 1; i <= ring_size; ++i) {
+        ASSERT_EQ(ipx_ring_pop(fast), fake_msg(0, i));
+    }
+
+    struct ipx_ring_stats stats;
+    ipx_ring_stats_get(ring, &stats);
+    EXPECT_EQ(stats.usage, ring_size);
+
+    // The writer must wait until the slow reader releases a slot
+    std::atomic<bool> pushed(false);
+    std::thread writer([ring, &pushed]() {
+        ipx_ring_push(ring, fake_msg(0, ring_size + 1));
+        pushed = true;
+    });
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    EXPECT_FALSE(pushed);
+    ASSERT_EQ(ipx_ring_pop(slow), fake_msg(0, 1));
+    writer.join();
+    EXPECT_TRUE(pushed);
+
+    ASSERT_EQ(ipx_ring_pop(fast), fake_msg(0, ring_size + 1));
+    for (uint32_t i = 2; i <= ring_size + 1; ++i) {
+        ASSERT_EQ(ipx_ring_pop(slow), fake_msg(0, i));
+    }
+
+    ipx_ring_destroy(ring);
+}
+
+// Non-blocking writes are limited by the slowest reader
+TEST(RingBroadcast, tryPush)
+{
+    constexpr uint32_t ring_size = 16;
+    ipx_ring_t *ring = ipx_ring_init_type(ring_size, false, IPX_RING_TYPE_BROADCAST);
+    ASSERT_NE(ring, nullptr);
+    ipx_ring_t *reader = ipx_ring_bcast_reader_add(ring);
+    ASSERT_NE(reader, nullptr);
+
+    for (uint32_t i = 1; i <= ring_size; ++i) {
+        ASSERT_TRUE(ipx_ring_try_push(ring, fake_msg(0, i)));
+    }
+    EXPECT_FALSE(ipx_ring_try_push(ring, fake_msg(0, ring_size + 1)));
+
+    ASSERT_EQ(ipx_ring_pop(reader), fake_msg(0, 1));
+    EXPECT_TRUE(ipx_ring_try_push(ring, fake_msg(0, ring_size + 1)));
+    for (uint32_t i = 2; i <= ring_size + 1; ++i) {
+        ASSERT_EQ(ipx_ring_pop(reader), fake_msg(0, i));
+    }
+
+    ipx_ring_destroy(ring);
+}
+
+// Only broadcast ring buffers can have readers
+TEST(RingBroadcast, invalidType)
+{
+    ipx_ring_t *ring = ipx_ring_init_type(16, false, IPX_RING_TYPE_BLOCK);
+    ASSERT_NE(ring, nullptr);
+    EXPECT_EQ(ipx_ring_bcast_reader_add(ring), nullptr);
+    ipx_ring_destroy(ring);
+}
+
+// A full adaptive buffer grows after repeated waits and keeps order of messages
+TEST(RingAdaptive, grow)
+{
+    constexpr uint32_t ring_size = 16;
+    constexpr uint32_t ring_max = 64;
+    ipx_ring_t *ring = ipx_ring_init_type(ring_size, false, IPX_RING_TYPE_BLOCK);
+    ASSERT_NE(ring, nullptr);
+    ASSERT_EQ(ipx_ring_adaptive_set(ring, ring_max), IPX_OK);
+
+    // Each unsuccessful attempt counts as a wait of the writer
+    uint32_t pushed = 0;
+    uint32_t failed = 0;
+    while (pushed < 4 * ring_size) {
+        if (ipx_ring_try_push(ring, fake_msg(0, pushed + 1))) {
+            pushed++;
+        } else {
+            failed++;
+        }
+    }
+
+    struct ipx_ring_stats stats;
+    ipx_ring_stats_get(ring, &stats);
+    EXPECT_EQ(stats.size, ring_max);
+    EXPECT_EQ(stats.resizes, 2U);
+    EXPECT_EQ(stats.usage, 4 * ring_size);
+    EXPECT_GT(failed, 0U);
+    EXPECT_FALSE(ipx_ring_try_push(ring, fake_msg(0, pushed + 1)));
+
+    // Bulk reads must not cross boundaries of memory segments
+    ipx_msg_t *batch[ring_max];
+    uint32_t popped = 0;
+    while (popped < pushed) {
+        uint32_t cnt = ipx_ring_pop_bulk(ring, batch, ring_max);
+        for (uint32_t i = 0; i < cnt; ++i) {
+            ASSERT_EQ(batch[i], fake_msg(0, ++popped));
+        }
+    }
+
+    ipx_ring_destroy(ring);
+}
+
+// Messages from multiple writers must preserve order of each writer while the buffer grows
+TEST(RingAdaptive, slowReader)
+{
+    constexpr uint32_t ring_size = 32;
+    constexpr uint32_t ring_max = 1024;
+    constexpr uint64_t writer_cnt = 4;
+    constexpr uint64_t msg_cnt = 20000;
+
+    ipx_ring_t *ring = ipx_ring_init_type(ring_size, true, IPX_RING_TYPE_BLOCK);
+    ASSERT_NE(ring, nullptr);
+    ASSERT_EQ(ipx_ring_adaptive_set(ring, ring_max), IPX_OK);
+
+    std::vector<std::thread> writers;
+    for (uint64_t w = 0; w < writer_cnt; ++w) {
+        writers.emplace_back([ring, w]() {
+            ipx_msg_t *batch[8];
+            for (uint64_t i = 1; i <= msg_cnt; i += 8) {
+                for (uint64_t j = 0; j < 8; ++j) {
+                    batch[j] = fake_msg(w, i + j);
+                }
+                ipx_ring_push_bulk(ring, batch, 8);
+            }
+        });
+    }
+
+    std::vector<uint64_t> last(writer_cnt, 0);
+    ipx_msg_t *batch[16];
+    uint64_t total = 0;
+    while (total < writer_cnt * msg_cnt) {
+        uint32_t cnt = ipx_ring_pop_bulk(ring, batch, 16);
+        for (uint32_t i = 0; i < cnt; ++i) {
+            uintptr_t value = reinterpret_cast<uintptr_t>(batch[i]);
+            uint64_t w = value >> 32;
+            uint64_t seq = value & UINT32_MAX;
+            ASSERT_LT(w, writer_cnt);
+            ASSERT_EQ(seq, last[w] + 1);
+            last[w] = seq;
+        }
+
+        total += cnt;
+        if (total % 1024 < cnt) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+
+    for (auto &writer : writers) {
+        writer.join();
+    }
+
+    struct ipx_ring_stats stats;
+    ipx_ring_stats_get(ring, &stats);
+    EXPECT_GT(stats.size, ring_size);
+    EXPECT_LE(stats.size, ring_max);
+    EXPECT_GT(stats.resizes, 0U);
+    ipx_ring_destroy(ring);
+}
+
+// Adaptive capacity is supported only by the block synchronization within valid bounds
+TEST(RingAdaptive, invalid)
+{
+    ipx_ring_t *ring = ipx_ring_init_type(16, false, IPX_RING_TYPE_LOCKFREE);
+    ASSERT_NE(ring, nullptr);
+    EXPECT_EQ(ipx_ring_adaptive_set(ring, 64), IPX_ERR_ARG);
+    ipx_ring_destroy(ring);
+
+    ring = ipx_ring_init_type(16, false, IPX_RING_TYPE_BLOCK);
+    ASSERT_NE(ring, nullptr);
+    EXPECT_EQ(ipx_ring_adaptive_set(ring, 8), IPX_ERR_ARG);
+    EXPECT_EQ(ipx_ring_adaptive_set(ring, 16), IPX_OK);
+
+    // Adaptation is disabled -> the capacity never changes
+    for (uint32_t i = 1; i <= 16; ++i) {
+        ASSERT_TRUE(ipx_ring_try_push(ring, fake_msg(0, i)));
+    }
+    for (uint32_t i = 0; i < 8; ++i) {
+        EXPECT_FALSE(ipx_ring_try_push(ring, fake_msg(0, 17)));
+    }
+
+    struct ipx_ring_stats stats;
+    ipx_ring_stats_get(ring, &stats);
+    EXPECT_EQ(stats.size, 16U);
+    EXPECT_EQ(stats.resizes, 0U);
+    for (uint32_t i = 1; i <= 16; ++i) {
+        ASSERT_EQ(ipx_ring_pop(ring), fake_msg(0, i));
+    }
+    ipx_ring_destroy(ring);
+}
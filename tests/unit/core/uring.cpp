@@ -0,0 +1,198 @@
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <ipfixcol2.h>
+
+int main(int argc, char **argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
+
+/** Number of receive buffers of tested instances */
+static const unsigned int BUF_CNT = 8;
+/** Size of each receive buffer */
+static const size_t BUF_SIZE = 2048;
+
+class Uring : public ::testing::Test {
+protected:
+    ipx_uring_t *ring = nullptr;
+    int rx_sd = -1;
+    int tx_sd = -1;
+    struct sockaddr_in rx_addr;
+
+    void SetUp() override {
+        ring = ipx_uring_create(16, BUF_CNT, BUF_SIZE);
+        if (!ring) {
+            // Not supported by the build or by the running kernel
+            GTEST_SKIP();
+        }
+
+        // Receiver on a random port of the loopback
+        rx_sd = socket(AF_INET, SOCK_DGRAM, 0);
+        tx_sd = socket(AF_INET, SOCK_DGRAM, 0);
+        ASSERT_GE(rx_sd, 0);
+        ASSERT_GE(tx_sd, 0);
+
+        memset(&rx_addr, 0, sizeof(rx_addr));
+        rx_addr.sin_family = AF_INET;
+        rx_addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        ASSERT_EQ(bind(rx_sd, (struct sockaddr *) &rx_addr, sizeof(rx_addr)), 0);
+        socklen_t len = sizeof(rx_addr);
+        ASSERT_EQ(getsockname(rx_sd, (struct sockaddr *) &rx_addr, &len), 0);
+        ASSERT_EQ(connect(tx_sd, (struct sockaddr *) &rx_addr, sizeof(rx_addr)), 0);
+    }
+
+    void TearDown() override {
+        ipx_uring_destroy(ring);
+        if (rx_sd >= 0) {
+            close(rx_sd);
+        }
+        if (tx_sd >= 0) {
+            close(tx_sd);
+        }
+    }
+
+    // Wait until the required number of events is collected
+    std::vector<ipx_uring_event> collect(unsigned int cnt) {
+        std::vector<ipx_uring_event> result;
+        ipx_uring_event events[BUF_CNT];
+        for (int i = 0; i < 100 && result.size() < cnt; ++i) {
+            int ret = ipx_uring_wait(ring, events, BUF_CNT, 10);
+            EXPECT_GE(ret, 0);
+            for (int e = 0; e < ret; ++e) {
+                result.push_back(events[e]);
+            }
+        }
+        return result;
+    }
+};
+
+// Only a build without support can't create an instance
+TEST(UringSupport, create)
+{
+    ipx_uring_t *ring = ipx_uring_create(4, 0, 0);
+    if (!ipx_uring_supported()) {
+        EXPECT_EQ(ring, nullptr);
+    }
+    ipx_uring_destroy(ring);
+
+    // Invalid arguments
+    EXPECT_EQ(ipx_uring_create(0, 0, 0), nullptr);
+    EXPECT_EQ(ipx_uring_create(4, 4, 0), nullptr);
+}
+
+// One multishot request must receive multiple datagrams with their source
+TEST_F(Uring, recvMultishot)
+{
+    ASSERT_EQ(ipx_uring_recv_multishot(ring, rx_sd, 10), IPX_OK);
+    ASSERT_EQ(ipx_uring_submit(ring), IPX_OK);
+
+    const unsigned int cnt = 5;
+    for (unsigned int i = 0; i < cnt; ++i) {
+        uint8_t data[100];
+        memset(data, (int) i, sizeof(data));
+        ASSERT_EQ(send(tx_sd, data, 10 + i, 0), (ssize_t) (10 + i));
+    }
+
+    struct sockaddr_in tx_addr;
+    socklen_t len = sizeof(tx_addr);
+    ASSERT_EQ(getsockname(tx_sd, (struct sockaddr *) &tx_addr, &len), 0);
+
+    std::vector<ipx_uring_event> events = collect(cnt);
+    ASSERT_EQ(events.size(), cnt);
+    for (unsigned int i = 0; i < cnt; ++i) {
+        const ipx_uring_event &ev = events[i];
+        EXPECT_EQ(ev.user_data, 10U);
+        EXPECT_TRUE(ev.more);
+        EXPECT_FALSE(ev.truncated);
+        ASSERT_NE(ev.data, nullptr);
+        ASSERT_EQ(ev.size, 10U + i);
+        EXPECT_EQ(ev.data[0], (uint8_t) i);
+
+        const struct sockaddr_in *src = (const struct sockaddr_in *) &ev.addr;
+        EXPECT_EQ(src->sin_family, AF_INET);
+        EXPECT_EQ(src->sin_port, tx_addr.sin_port);
+    }
+}
+
+// Buffers must be given back, i.e. more datagrams than buffers can be received
+TEST_F(Uring, bufferRecycling)
+{
+    ASSERT_EQ(ipx_uring_recv_multishot(ring, rx_sd, 1), IPX_OK);
+    const unsigned int rounds = 4 * BUF_CNT;
+    unsigned int received = 0;
+
+    ipx_uring_event events[BUF_CNT];
+    for (unsigned int i = 0; i < rounds; ++i) {
+        uint32_t value = i;
+        ASSERT_EQ(send(tx_sd, &value, sizeof(value), 0), (ssize_t) sizeof(value));
+
+        int ret = 0;
+        for (int tries = 0; tries < 100 && ret == 0; ++tries) {
+            ret = ipx_uring_wait(ring, events, BUF_CNT, 10);
+            ASSERT_GE(ret, 0);
+        }
+
+        ASSERT_EQ(ret, 1);
+        ASSERT_EQ(events[0].size, sizeof(value));
+        EXPECT_EQ(memcmp(events[0].data, &value, sizeof(value)), 0);
+        if (!events[0].more) {
+            ASSERT_EQ(ipx_uring_recv_multishot(ring, rx_sd, 1), IPX_OK);
+        }
+        received++;
+    }
+
+    EXPECT_EQ(received, rounds);
+}
+
+// Too long datagrams must be reported as truncated
+TEST_F(Uring, truncated)
+{
+    ASSERT_EQ(ipx_uring_recv_multishot(ring, rx_sd, 2), IPX_OK);
+    std::vector<uint8_t> data(2 * BUF_SIZE, 0xAB);
+    ASSERT_EQ(send(tx_sd, data.data(), data.size(), 0), (ssize_t) data.size());
+
+    std::vector<ipx_uring_event> events = collect(1);
+    ASSERT_EQ(events.size(), 1U);
+    EXPECT_TRUE(events[0].truncated);
+    EXPECT_EQ(events[0].size, BUF_SIZE);
+}
+
+// Queued requests are submitted together and each one generates its own event
+TEST_F(Uring, sendAndRead)
+{
+    const char *msgs[] = {"first", "second", "third"};
+    for (unsigned int i = 0; i < 3; ++i) {
+        ASSERT_EQ(ipx_uring_send(ring, tx_sd, msgs[i], strlen(msgs[i]), MSG_NOSIGNAL, 100 + i),
+            IPX_OK);
+    }
+
+    std::vector<ipx_uring_event> events = collect(3);
+    ASSERT_EQ(events.size(), 3U);
+    for (const auto &ev : events) {
+        ASSERT_GE(ev.user_data, 100U);
+        ASSERT_LT(ev.user_data, 103U);
+        EXPECT_EQ(ev.res, (int) strlen(msgs[ev.user_data - 100]));
+        EXPECT_EQ(ev.data, nullptr);
+    }
+
+    // Datagrams are waiting in the socket, read them (without a source address)
+    char buffer[3][16];
+    for (unsigned int i = 0; i < 3; ++i) {
+        ASSERT_EQ(ipx_uring_read(ring, rx_sd, buffer[i], sizeof(buffer[i]), i), IPX_OK);
+    }
+
+    events = collect(3);
+    ASSERT_EQ(events.size(), 3U);
+    for (const auto &ev : events) {
+        ASSERT_LT(ev.user_data, 3U);
+        EXPECT_GT(ev.res, 0);
+    }
+}
@@ -13,3 +13,28 @@ TEST(Verbosity, global_set_and_get)
     enum ipx_verb_level level = ipx_verb_level_get();
     EXPECT_EQ(level, IPX_VERB_INFO);
 }
+
+// Only a limited number of messages of the same origin is printed
+TEST(Verbosity, rate_limit)
+{
+    const char *fmt = "WARNING: %s: Message %u\n";
+    const char *name = "Rate limited";
+
+    testing::internal::CaptureStdout();
+    for (unsigned int i = 0; i < 3 * IPX_VERB_RL_BURST; ++i) {
+        ipx_verb_print_rl(IPX_VERB_WARNING, name, fmt, name, i);
+    }
+    std::string output = testing::internal::GetCapturedStdout();
+
+    size_t lines = 0;
+    for (char c : output) {
+        lines += (c == '\n') ? 1 : 0;
+    }
+    EXPECT_EQ(lines, IPX_VERB_RL_BURST);
+
+    // Different origins are limited independently
+    testing::internal::CaptureStdout();
+    ipx_verb_print_rl(IPX_VERB_WARNING, "Another origin", fmt, name, 0U);
+    output = testing::internal::GetCapturedStdout();
+    EXPECT_EQ(output, "WARNING: Rate limited: Message 0\n");
+}
@@ -0,0 +1,101 @@
+#include <gtest/gtest.h>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <ipfixcol2.h>
+
+int main(int argc, char **argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
+
+// Invalid arguments are always refused
+TEST(XdpSupport, invalidArgs)
+{
+    const uint16_t port = 4739;
+    EXPECT_EQ(ipx_xdp_create(nullptr, 1, &port, 1, 64), nullptr);
+    EXPECT_EQ(ipx_xdp_create("lo", 0, &port, 1, 64), nullptr);
+    EXPECT_EQ(ipx_xdp_create("lo", 1, nullptr, 0, 64), nullptr);
+    EXPECT_EQ(ipx_xdp_create("lo", 1, &port, 1, 0), nullptr);
+    EXPECT_EQ(ipx_xdp_create("ipx-no-such-iface", 1, &port, 1, 64), nullptr);
+}
+
+// Only a build without support reports ENOSYS
+TEST(XdpSupport, create)
+{
+    const uint16_t port = 4739;
+    errno = 0;
+    ipx_xdp_t *xdp = ipx_xdp_create("lo", 1, &port, 1, 64);
+    if (!ipx_xdp_supported()) {
+        EXPECT_EQ(xdp, nullptr);
+        EXPECT_EQ(errno, ENOSYS);
+        return;
+    }
+
+    // Creation can still fail due to missing privileges or an old kernel
+    if (xdp) {
+        EXPECT_GE(ipx_xdp_fd(xdp, 0), 0);
+        EXPECT_EQ(ipx_xdp_fd(xdp, 1), -1);
+    }
+    ipx_xdp_destroy(xdp);
+}
+
+// Datagrams on the loopback are received and payloads stay valid after destruction
+TEST(Xdp, loopback)
+{
+    // Receiver on a random port of the loopback
+    int rx_sd = socket(AF_INET, SOCK_DGRAM, 0);
+    int tx_sd = socket(AF_INET, SOCK_DGRAM, 0);
+    ASSERT_GE(rx_sd, 0);
+    ASSERT_GE(tx_sd, 0);
+
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    ASSERT_EQ(bind(rx_sd, (struct sockaddr *) &addr, sizeof(addr)), 0);
+    socklen_t len = sizeof(addr);
+    ASSERT_EQ(getsockname(rx_sd, (struct sockaddr *) &addr, &len), 0);
+    ASSERT_EQ(connect(tx_sd, (struct sockaddr *) &addr, sizeof(addr)), 0);
+
+    const uint16_t port = ntohs(addr.sin_port);
+    ipx_xdp_t *xdp = ipx_xdp_create("lo", 1, &port, 1, 64);
+    if (!xdp) {
+        // Not supported by the build, the kernel or missing privileges
+        close(rx_sd);
+        close(tx_sd);
+        GTEST_SKIP();
+    }
+
+    const char msg[] = "hello XDP";
+    ASSERT_EQ(send(tx_sd, msg, sizeof(msg), 0), (ssize_t) sizeof(msg));
+
+    struct ipx_xdp_packet pkt;
+    unsigned int cnt = 0;
+    for (int i = 0; i < 100 && cnt == 0; ++i) {
+        struct pollfd pfd = {ipx_xdp_fd(xdp, 0), POLLIN, 0};
+        poll(&pfd, 1, 10);
+        cnt = ipx_xdp_recv(xdp, 0, &pkt, 1);
+    }
+
+    ASSERT_EQ(cnt, 1U);
+    ASSERT_EQ(pkt.size, sizeof(msg));
+    EXPECT_EQ(memcmp(pkt.data, msg, sizeof(msg)), 0);
+    EXPECT_EQ(pkt.src.ss_family, AF_INET);
+    EXPECT_EQ(((struct sockaddr_in *) &pkt.dst)->sin_port, addr.sin_port);
+
+    // The payload is owned by the caller until it's freed
+    ipx_xdp_destroy(xdp);
+    EXPECT_EQ(memcmp(pkt.data, msg, sizeof(msg)), 0);
+    ipx_utils_buf_free(pkt.data);
+
+    close(rx_sd);
+    close(tx_sd);
+}